@@ -12,6 +12,7 @@ set(CPP_FILES
   mitkMaskAndCutRoiImageFilter.cpp
   mitkMaskImageFilter.cpp
   mitkMovieGenerator.cpp
+  mitkMovieGeneratorFFmpeg.cpp
   mitkNonBlockingAlgorithm.cpp
   mitkPadImageFilter.cpp
   mitkPlaneFit.cpp
@@ -25,6 +25,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "MitkAlgorithmsExtExports.h"
 
 // STL
+#include <memory>
 #include <vector>
 
 // ITK
@@ -32,7 +33,6 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 // forward declarations
 class vtkPoints;
-class vtkKdTreePointLocator;
 
 namespace mitk
 {
@@ -60,7 +60,8 @@ namespace mitk
     * vertices. In addition vtkCleanPolyData can be used to ensure a correct
     * Surface representation.
     *
-    * \note The correspondence search is accelerated when OpenMP is enabled.
+    * \note The fixed surface is stored in a kd tree that is only rebuilt if the
+    * fixed surface changes. The correspondence search runs multi-threaded.
     *
     * \b Example:
     *
@@ -131,6 +132,9 @@ namespace mitk
     /** Definition of a list of correspondences.*/
     typedef std::vector<Correspondence> CorrespondenceList;
 
+    /** Kd tree of the fixed point set, defined in the implementation.*/
+    class FixedPointTree;
+
     AnisotropicIterativeClosestPointRegistration();
     ~AnisotropicIterativeClosestPointRegistration() override;
 
@@ -179,6 +183,9 @@ namespace mitk
     /** The computed 3x3 rotation matrix.*/
     Rotation m_Rotation;
 
+    /** Kd tree of the fixed surface, kept between calls of Update().*/
+    std::unique_ptr<FixedPointTree> m_FixedPointTree;
+
     /**
       * Method that computes the correspondences between the moving point set X
       * and the fixed point set Y. The distances between the points
@@ -192,7 +199,7 @@ namespace mitk
       *
       * @param X The moving point set.
       * @param Z The returned correspondences from the fixed point set.
-      * @param Y The fixed point set saved in a kd tree.
+      * @param Y The fixed point set saved in a kd tree. The tree must not be empty.
       * @param sigma_X Covariance matrices belonging to the moving point set.
       * @param sigma_Y Covariance matrices belonging to the fixed point set.
       * @param sigma_Z Covariance matrices belonging to the correspondences found.
@@ -203,7 +210,7 @@ namespace mitk
       */
     void ComputeCorrespondences(vtkPoints *X,
                                 vtkPoints *Z,
-                                vtkKdTreePointLocator *Y,
+                                const FixedPointTree &Y,
                                 const CovarianceMatrixList &sigma_X,
                                 const CovarianceMatrixList &sigma_Y,
                                 CovarianceMatrixList &sigma_Z,
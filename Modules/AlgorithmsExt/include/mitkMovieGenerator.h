@@ -21,10 +21,20 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "MitkAlgorithmsExtExports.h"
 #include "mitkBaseRenderer.h"
 #include "mitkCommon.h"
+#include "mitkRenderWindowFrameReader.h"
 #include "mitkStepper.h"
 
 namespace mitk
 {
+  /**
+   * \brief Records the frames rendered by a renderer into a movie.
+   *
+   * The frames are read back with a RenderWindowFrameReader, so the next step is rendered while
+   * the pixels of the previous one are still transferred. AddFrame() is called in the order of the
+   * frames, but possibly only when a later frame is read or the movie is finished.
+   *
+   * New() delivers a MovieGeneratorWin32 on Windows and a MovieGeneratorFFmpeg elsewhere.
+   */
   class MITKALGORITHMSEXT_EXPORT MovieGenerator : public itk::LightObject
   {
   public:
@@ -46,7 +56,7 @@ namespace mitk
     //   it adds a single frame to a movie each time the function is called
     //   Initialization is done with first function call; Renderer and Filename have to be set up properly before.
     virtual bool WriteCurrentFrameToMovie();
-    //!  releases a movie writer after usage of WriteCurrentFrameToMovie()
+    //!  releases a movie writer after usage of WriteCurrentFrameToMovie(), pending frames are added first
     virtual void ReleaseMovieWriter();
 
     virtual void SetFrameRate(unsigned int rate);
@@ -57,6 +67,9 @@ namespace mitk
     //!  default  constructor
     MovieGenerator();
 
+    //!  drops frames which are still read, AddFrame() can not be called anymore
+    ~MovieGenerator() override;
+
     //!  called directly  before the first frame is  added, determines  movie  size from  renderer
     virtual bool InitGenerator() = 0;
 
@@ -66,6 +79,12 @@ namespace mitk
     //!  called after the last  frame  is added
     virtual bool TerminateGenerator() = 0;
 
+    //!  starts reading the current frame of m_renderer, AddFrame() is called once the pixels arrived
+    void ReadFrame();
+
+    //!  adds all frames which are still read
+    void FlushFrames();
+
     //!  stores the movie filename
     char m_fileName[1024];
 
@@ -81,6 +100,8 @@ namespace mitk
     bool m_initialized;
 
     unsigned int m_FrameRate;
+
+    RenderWindowFrameReader::Pointer m_FrameReader;
   };
 
 } // namespace mitk
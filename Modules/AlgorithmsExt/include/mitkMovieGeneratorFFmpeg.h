@@ -0,0 +1,78 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MovieGeneratorFFmpeg_H_HEADER_INCLUDED
+#define MovieGeneratorFFmpeg_H_HEADER_INCLUDED
+
+#include "MitkAlgorithmsExtExports.h"
+#include "mitkMovieGenerator.h"
+
+#include <cstdio>
+#include <string>
+
+namespace mitk
+{
+  /**
+   * \brief Streams the frames into an FFmpeg process, which encodes them.
+   *
+   * The raw frames are written to the standard input of the encoder executable (see
+   * SetEncoderExecutable(), by default the MITK_FFMPEG_EXECUTABLE environment variable or "ffmpeg"
+   * from the PATH). Encoding runs in parallel to the rendering. The container is determined by the
+   * extension of the file name, the codec by SetVideoCodec(), which also selects hardware encoders
+   * such as "h264_nvenc" or "h264_vaapi" if the FFmpeg build supports them.
+   */
+  class MITKALGORITHMSEXT_EXPORT MovieGeneratorFFmpeg : public MovieGenerator
+  {
+  public:
+    mitkClassMacro(MovieGeneratorFFmpeg, MovieGenerator);
+    itkFactorylessNewMacro(Self) itkCloneMacro(Self)
+
+    //! path of the ffmpeg executable
+    void SetEncoderExecutable(const std::string &executable) { m_EncoderExecutable = executable; }
+    std::string GetEncoderExecutable() const { return m_EncoderExecutable; }
+
+    //! video codec passed to ffmpeg, default is "libx264"
+    void SetVideoCodec(const std::string &codec) { m_VideoCodec = codec; }
+    std::string GetVideoCodec() const { return m_VideoCodec; }
+
+    //! additional output options passed to ffmpeg, default is "-pix_fmt yuv420p"
+    void SetEncoderArguments(const std::string &arguments) { m_EncoderArguments = arguments; }
+    std::string GetEncoderArguments() const { return m_EncoderArguments; }
+
+  protected:
+    MovieGeneratorFFmpeg();
+    ~MovieGeneratorFFmpeg() override;
+
+    //! starts the encoder process
+    bool InitGenerator() override;
+
+    //! writes a frame to the encoder
+    bool AddFrame(void *data) override;
+
+    //! closes the input of the encoder and waits for it to finish the movie
+    bool TerminateGenerator() override;
+
+    std::string m_EncoderExecutable;
+    std::string m_VideoCodec;
+    std::string m_EncoderArguments;
+
+  private:
+    FILE *m_Encoder;
+  };
+
+} // namespace mitk
+
+#endif /* MovieGeneratorFFmpeg_H_HEADER_INCLUDED */
@@ -29,6 +29,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkProperties.h"
 #include "mitkPropertyList.h"
 #include "mitkSmartPointerProperty.h"
+#include "mitkTaskScheduler.h"
 #include "mitkWeakPointer.h"
 
 #include "mitkImage.h"
@@ -70,6 +71,8 @@ namespace mitk
       Invokes ResultsAvailable with each new result
 
       <b>done</b> centralize use of itk::MultiThreader in this class
+      <b>done</b> run on the shared mitk::TaskScheduler instead of an own thread. The computation reads the "Input"
+            parameter, so it waits for tasks writing that data.
       @todo do the property-handling in this class
       @todo process "incoming" events in this class
       @todo sollen segmentierungs-dinger von mitk::ImageSource erben? Ivo fragen, wie das mit AllocateOutputs, etc.
@@ -206,7 +209,15 @@ namespace mitk
     void StartAlgorithm();         // for those who want to trigger calculations on their own
                                    // --> need for an OPTION: manual/automatic starting
     void StartBlockingAlgorithm(); // for those who want to trigger calculations on their own
-    void StopAlgorithm();
+    void StopAlgorithm();          // waits for a running calculation to finish
+
+    /// Drops a calculation that did not start yet and asks a running one to stop, see
+    /// TaskScheduler::IsCurrentTaskCanceled(). No result event is sent for a calculation that did not start.
+    void CancelAlgorithm();
+
+    /// Priority of the calculation on the shared TaskScheduler, NormalPriority by default
+    itkSetMacro(Priority, TaskScheduler::Priority);
+    itkGetConstMacro(Priority, TaskScheduler::Priority);
 
     void TriggerParameterModified(const itk::EventObject &);
 
@@ -232,7 +243,7 @@ namespace mitk
     WeakPointer<DataStorage> m_DataStorage;
 
   private:
-    static ITK_THREAD_RETURN_TYPE StaticNonBlockingAlgorithmThread(void *param);
+    static void RunThreadedUpdates(NonBlockingAlgorithm::Pointer algorithm);
 
     typedef std::map<std::string, unsigned long> MapTypeStringUInt;
 
@@ -240,10 +251,10 @@ namespace mitk
 
     itk::FastMutexLock::Pointer m_ParameterListMutex;
 
-    int m_ThreadID;
     int m_UpdateRequests;
     ThreadParameters m_ThreadParameters;
-    itk::MultiThreader::Pointer m_MultiThreader;
+    TaskScheduler::TaskPointer m_Task;
+    TaskScheduler::Priority m_Priority;
 
     bool m_KillRequest;
   };
@@ -1,19 +1,3 @@
-/*===================================================================
-
-The Medical Imaging Interaction Toolkit (MITK)
-
-Copyright (c) German Cancer Research Center,
-Division of Medical and Biological Informatics.
-All rights reserved.
-
-This software is distributed WITHOUT ANY WARRANTY; without
-even the implied warranty of MERCHANTABILITY or FITNESS FOR
-A PARTICULAR PURPOSE.
-
-See LICENSE.txt or http://www.mitk.org for details.
-
-===================================================================*/
-
 #ifndef _MITK_POINT_LOCATOR__H__
 #define _MITK_POINT_LOCATOR__H__
 
@@ -24,20 +8,26 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <vtkPoints.h>
 
+#include <vector>
+
 // forward declarations
 class vtkPointSet;
-class ANNkd_tree;
 
 namespace mitk
 {
   /**
-   * Convenience wrapper around ANN to provide fast nearest neighbour searches.
+   * Convenience class to provide fast nearest neighbour searches.
    * Usage: set your points via SetPoints( vtkPointSet* Points ) or SetPoints(mitk::PointSet*).
    * Then, you may query the closest point to an arbitrary coordinate by FindClosestPoint().
    * There is no further call to update etc. needed.
-   * Currently only calls for 1 nearest neighbour are supported. Feel free to add functions
-   * for K nearest neighbours.
+   * Many query points are best searched at once by FindClosestPoints() or FindKClosestPoints(),
+   * which search in parallel.
    * NOTE: At least 1 point must be contained in the point set.
+   *
+   * The points are kept in an implicit, balanced k-d tree: they are reordered such that every
+   * subtree is a contiguous range of the point array, with the splitting point in its middle.
+   * No nodes or pointers are stored, and nearby points are nearby in memory. Queries do not
+   * modify the locator, so they may be run from several threads at once.
    */
 
   class MITKALGORITHMSEXT_EXPORT PointLocator : public itk::Object
@@ -55,6 +45,12 @@ namespace mitk
     typedef itk::DefaultStaticMeshTraits<PixelType, 3, 2, CoordRepType, CoordRepType, PixelType> MeshTraits;
     typedef itk::PointSet<PixelType, 3, MeshTraits> ITKPointSet;
 
+    //
+    // Definition of a vector of ids
+    //
+    typedef std::vector<IdType> IdVectorType;
+    typedef std::vector<DistanceType> DistanceVectorType;
+
     /**
      * Sets the point which will be used for nearest-neighbour searches. Note
      * there must be at least one point in the point set.
@@ -118,7 +114,7 @@ namespace mitk
      * no point is found, since as a precondition at least one point has to be contained
      * in the point set.
      * @param point the query point, for whom the minimal distance will be determined
-     * @returns the distance in world coordinates between the nearest point in point set and the given point
+     * @returns the squared distance in world coordinates between the nearest point in point set and the given point
      */
     DistanceType GetMinimalDistance(mitk::PointSet::PointType point);
 
@@ -134,25 +130,39 @@ namespace mitk
     */
     bool FindClosestPointAndDistance(mitk::PointSet::PointType point, IdType *id, DistanceType *dist);
 
-  protected:
-    //
-    // Definition of a vector of ids
-    //
-    typedef std::vector<IdType> IdVectorType;
+    /**
+     * Finds the k nearest neighbours of a point, ordered by increasing distance. Fewer ids are
+     * returned if the point set contains less than k points.
+     * @param point the query point
+     * @param k the number of neighbours
+     * @param ids the ids of the neighbours in the original point set
+     * @param squaredDistances the squared distances of the neighbours to the query point
+     */
+    void FindKClosestPoints(const double point[3],
+                            unsigned int k,
+                            IdVectorType &ids,
+                            DistanceVectorType &squaredDistances) const;
 
-    //
-    // ANN related typedefs, to prevent ANN from being in the global include path.
-    // Please note, that these line are prone to failure, if the point type in
-    // ANN changes. Please note also, that these typedefs are only used in the header
-    // file. The implementation always refers to the original types
-    //
-    typedef double *MyANNpoint;
-    typedef int MyANNidx;
-    typedef double MyANNdist;
-    typedef MyANNpoint *MyANNpointArray;
-    typedef MyANNidx *MyANNidxArray;
-    typedef MyANNdist *MyANNdistArray;
+    /**
+     * Finds the nearest neighbour of every query point. The queries are run in parallel.
+     * @param queryPoints the query points
+     * @param ids the id of the nearest neighbour for each query point
+     * @param squaredDistances the squared distance to the nearest neighbour for each query point,
+     * as returned by GetMinimalDistance()
+     */
+    void FindClosestPoints(vtkPoints *queryPoints, IdVectorType &ids, DistanceVectorType &squaredDistances) const;
+
+    /**
+     * Finds the k nearest neighbours of every query point, in parallel. The neighbours of query point i are
+     * stored at i * k to i * k + k - 1, ordered by increasing distance. If the point set contains less
+     * than k points, the missing ids are -1 and the missing distances are infinite.
+     */
+    void FindKClosestPoints(vtkPoints *queryPoints,
+                            unsigned int k,
+                            IdVectorType &ids,
+                            DistanceVectorType &squaredDistances) const;
 
+  protected:
     /**
      * constructor
      */
@@ -164,56 +174,43 @@ namespace mitk
     ~PointLocator() override;
 
     /**
-     * Initializes the ann search tree using previously defined points
+     * Builds the search tree from the points in m_Coordinates
      */
-    void InitANN();
+    void BuildTree();
 
     /**
-     * releases all memory occupied by the ann search tree and internal point set arrays
+     * Releases all memory occupied by the search tree
      */
-    void DestroyANN();
+    void ClearTree();
 
     /**
-     * Finds the nearest neighbour in the point set previously defined by SetPoints().
-     * The Id of the point is returned. Please note, that there is no case, in which
-     * no point is found, since as a precondition at least one point has to be contained
-     * in the point set.
-     * @param point the query point, for whom the nearest neighbour will be determined
-     * @returns the id of the nearest neighbour of the given point. The id corresponds to the id
-     * which is given in the original point set.
+     * Finds the k nearest neighbours of the given point. ids and squaredDistances have to provide
+     * space for k elements, they are filled ordered by increasing distance. Returns the number of
+     * found neighbours, which is less than k only if the tree contains less than k points.
      */
-    IdType FindClosestANNPoint(const MyANNpoint &point);
+    unsigned int SearchTree(const double point[3], unsigned int k, IdType *ids, DistanceType *squaredDistances) const;
 
     /**
      * Finds the minimal distance between the given point and a point in the previously defined point set.
-     * The distance is returned. Please note, that there is no case, in which
-     * no distance is found, since as a precondition at least one point has to be contained
-     * in the point set.
-     * @param point the query point, for whom the minimal distance to a point in the previously defined point set will
-     * be determined
-     * @returns the squared distance in world coordinates between the given point and the nearest neighbour.
+     * @returns the squared distance in world coordinates between the given point and the nearest neighbour,
+     * or -1 if there are no points.
      */
-    DistanceType GetMinimalDistance(const MyANNpoint &point);
+    DistanceType GetMinimalSquaredDistance(const double point[3]) const;
 
     bool m_SearchTreeInitialized;
 
-    IdVectorType m_IndexToPointIdContainer;
-
     vtkPoints *m_VtkPoints;
     mitk::PointSet *m_MitkPoints;
     ITKPointSet *m_ItkPoints;
+    unsigned long m_PointsMTime;
 
     //
-    // ANN related variables
+    // The implicit k-d tree: the coordinates of the points in tree order, the original id and,
+    // for the splitting point in the middle of each subtree, its splitting dimension
     //
-    unsigned int m_ANNK;
-    unsigned int m_ANNDimension;
-    double m_ANNEpsilon;
-    MyANNpointArray m_ANNDataPoints;
-    MyANNpoint m_ANNQueryPoint;
-    MyANNidxArray m_ANNPointIndexes;
-    MyANNdistArray m_ANNDistances;
-    ANNkd_tree *m_ANNTree;
+    std::vector<double> m_Coordinates;
+    IdVectorType m_IndexToPointIdContainer;
+    std::vector<unsigned char> m_SplitDimensions;
   };
 }
 
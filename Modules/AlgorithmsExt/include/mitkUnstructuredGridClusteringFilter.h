@@ -61,6 +61,13 @@ namespace mitk
   *             N = N joined with N'
   *         if P' is not yet member of any cluster
   *           add P' to cluster C
+  *
+  * The implementation finds the same clusters in near linear time: The region
+  * queries use a uniform grid with a cell size of eps, the core points are
+  * found in parallel and neighbouring core points are merged with a union-find
+  * structure. A border point reachable from several clusters is assigned to
+  * the cluster which contains the core point with the lowest id, i.e. the one
+  * the sequential algorithm would have found first.
   */
 
   class MITKALGORITHMSEXT_EXPORT UnstructuredGridClusteringFilter : public UnstructuredGridToUnstructuredGridFilter
@@ -98,9 +105,6 @@ namespace mitk
     void GenerateData() override;
 
   private:
-    /** Used for the DBSCAN algorithm to expand a cluster and add more points to it */
-    void ExpandCluster(int id, vtkIdList *pointIDs, vtkPoints *cluster, vtkPoints *inpPoints);
-
     /** The result main Cluster */
     mitk::UnstructuredGrid::Pointer m_UnstructGrid;
 
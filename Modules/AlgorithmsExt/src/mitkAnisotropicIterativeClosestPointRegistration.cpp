@@ -21,12 +21,15 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkProgressBar.h>
 #include <mitkSurface.h>
 // VTK
-#include <vtkIdList.h>
-#include <vtkKdTree.h>
-#include <vtkKdTreePointLocator.h>
 #include <vtkPoints.h>
 #include <vtkPolyData.h>
-// STL pair
+// STL
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <thread>
 #include <utility>
 
 /** \brief Comperator implementation used to sort the CorrespondenceList in the
@@ -39,6 +42,150 @@ struct AICPComperator
   bool operator()(const Correspondence &a, const Correspondence &b) { return (a.second < b.second); }
 } AICPComp;
 
+/** \brief Static kd tree of the fixed point set.
+  *
+  * The points are copied into the tree and split at the median of the axis
+  * with the largest extent. The tree is stored implicitly in the permutation
+  * of the point ids, so queries do not allocate and can be run concurrently.
+  */
+class mitk::AnisotropicIterativeClosestPointRegistration::FixedPointTree
+{
+public:
+  FixedPointTree() : m_DataSet(nullptr), m_MTime(0) {}
+
+  /** Builds the tree if the data set or its points changed since the last call.*/
+  void Update(vtkPolyData *dataSet)
+  {
+    vtkPoints *points = dataSet->GetPoints();
+    const vtkMTimeType mTime = std::max(dataSet->GetMTime(), points ? points->GetMTime() : vtkMTimeType(0));
+
+    if (dataSet == m_DataSet && mTime == m_MTime)
+    {
+      return;
+    }
+
+    const vtkIdType numberOfPoints = points ? points->GetNumberOfPoints() : 0;
+    m_Coordinates.resize(3 * numberOfPoints);
+    m_Ids.resize(numberOfPoints);
+    m_SplitAxes.assign(numberOfPoints, 0);
+
+    for (vtkIdType i = 0; i < numberOfPoints; ++i)
+    {
+      points->GetPoint(i, &m_Coordinates[3 * i]);
+      m_Ids[i] = i;
+    }
+
+    this->Build(0, numberOfPoints);
+
+    m_DataSet = dataSet;
+    m_MTime = mTime;
+  }
+
+  vtkIdType GetNumberOfPoints() const { return static_cast<vtkIdType>(m_Ids.size()); }
+
+  const double *GetPoint(vtkIdType id) const { return &m_Coordinates[3 * id]; }
+
+  /** Calls callback(id) for every point with an euclidean distance <= radius to p.*/
+  template <typename TCallback>
+  void FindPointsWithinRadius(double radius, const double p[3], TCallback callback) const
+  {
+    const double radius2 = radius * radius;
+
+    std::pair<vtkIdType, vtkIdType> stack[64];
+    int stackSize = 0;
+    stack[stackSize++] = std::make_pair(vtkIdType(0), this->GetNumberOfPoints());
+
+    while (stackSize > 0)
+    {
+      const vtkIdType begin = stack[stackSize - 1].first;
+      const vtkIdType end = stack[stackSize - 1].second;
+      --stackSize;
+
+      if (end - begin <= LeafSize)
+      {
+        for (vtkIdType i = begin; i < end; ++i)
+        {
+          this->CheckPoint(m_Ids[i], radius2, p, callback);
+        }
+        continue;
+      }
+
+      const vtkIdType mid = begin + (end - begin) / 2;
+      const vtkIdType id = m_Ids[mid];
+      const double d = p[m_SplitAxes[mid]] - m_Coordinates[3 * id + m_SplitAxes[mid]];
+
+      this->CheckPoint(id, radius2, p, callback);
+
+      if (d <= radius)
+      {
+        stack[stackSize++] = std::make_pair(begin, mid);
+      }
+      if (d >= -radius)
+      {
+        stack[stackSize++] = std::make_pair(mid + 1, end);
+      }
+    }
+  }
+
+private:
+  static const vtkIdType LeafSize = 8;
+
+  template <typename TCallback>
+  void CheckPoint(vtkIdType id, double radius2, const double p[3], TCallback &callback) const
+  {
+    const double *q = &m_Coordinates[3 * id];
+    const double dist2 = (p[0] - q[0]) * (p[0] - q[0]) + (p[1] - q[1]) * (p[1] - q[1]) + (p[2] - q[2]) * (p[2] - q[2]);
+    if (dist2 <= radius2)
+    {
+      callback(id);
+    }
+  }
+
+  void Build(vtkIdType begin, vtkIdType end)
+  {
+    if (end - begin <= LeafSize)
+    {
+      return;
+    }
+
+    double lower[3] = { std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max() };
+    double upper[3] = { std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest() };
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      const double *q = &m_Coordinates[3 * m_Ids[i]];
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        lower[axis] = std::min(lower[axis], q[axis]);
+        upper[axis] = std::max(upper[axis], q[axis]);
+      }
+    }
+
+    int splitAxis = 0;
+    for (int axis = 1; axis < 3; ++axis)
+    {
+      if (upper[axis] - lower[axis] > upper[splitAxis] - lower[splitAxis])
+      {
+        splitAxis = axis;
+      }
+    }
+
+    const vtkIdType mid = begin + (end - begin) / 2;
+    std::nth_element(m_Ids.begin() + begin, m_Ids.begin() + mid, m_Ids.begin() + end,
+      [this, splitAxis](vtkIdType a, vtkIdType b) { return m_Coordinates[3 * a + splitAxis] < m_Coordinates[3 * b + splitAxis]; });
+    m_SplitAxes[mid] = static_cast<unsigned char>(splitAxis);
+
+    this->Build(begin, mid);
+    this->Build(mid + 1, end);
+  }
+
+  std::vector<double> m_Coordinates;
+  std::vector<vtkIdType> m_Ids;
+  std::vector<unsigned char> m_SplitAxes;
+
+  vtkPolyData *m_DataSet;
+  vtkMTimeType m_MTime;
+};
+
 mitk::AnisotropicIterativeClosestPointRegistration::AnisotropicIterativeClosestPointRegistration()
   : m_MaxIterations(1000),
     m_Threshold(0.000001),
@@ -50,7 +197,8 @@ mitk::AnisotropicIterativeClosestPointRegistration::AnisotropicIterativeClosestP
     m_NumberOfIterations(0),
     m_MovingSurface(nullptr),
     m_FixedSurface(nullptr),
-    m_WeightedPointTransform(mitk::WeightedPointTransform::New())
+    m_WeightedPointTransform(mitk::WeightedPointTransform::New()),
+    m_FixedPointTree(new FixedPointTree)
 {
 }
 
@@ -60,7 +208,7 @@ mitk::AnisotropicIterativeClosestPointRegistration::~AnisotropicIterativeClosest
 
 void mitk::AnisotropicIterativeClosestPointRegistration::ComputeCorrespondences(vtkPoints *X,
                                                                                 vtkPoints *Z,
-                                                                                vtkKdTreePointLocator *Y,
+                                                                                const FixedPointTree &Y,
                                                                                 const CovarianceMatrixList &sigma_X,
                                                                                 const CovarianceMatrixList &sigma_Y,
                                                                                 CovarianceMatrixList &sigma_Z,
@@ -69,14 +217,15 @@ void mitk::AnisotropicIterativeClosestPointRegistration::ComputeCorrespondences(
 {
   typedef itk::Matrix<double, 3, 3> WeightMatrix;
 
-#pragma omp parallel for
-  for (vtkIdType i = 0; i < X->GetNumberOfPoints(); ++i)
+  const vtkIdType numberOfPoints = X->GetNumberOfPoints();
+  std::vector<vtkIdType> bestIds(numberOfPoints, 0);
+
+  auto searchCorrespondence = [&](vtkIdType i)
   {
-    vtkIdType bestIdx = 0;
+    vtkIdType bestIdx = -1;
     mitk::Vector3D x;
     mitk::Vector3D y;
     double bestDist = std::numeric_limits<double>::max();
-    vtkIdList *ids = vtkIdList::New();
     double r = radius;
     double p[3];
     // get point
@@ -86,49 +235,95 @@ void mitk::AnisotropicIterativeClosestPointRegistration::ComputeCorrespondences(
     x[1] = p[1];
     x[2] = p[2];
 
-    // double the radius till we find at least one point
-    while (ids->GetNumberOfIds() <= 0)
-    {
-      Y->FindPointsWithinRadius(r, p, ids);
-      r *= 2.0;
-    }
-
     // loop over the points in the sphere and find the point with the
     // minimal weighted squared distance
-    for (vtkIdType j = 0; j < ids->GetNumberOfIds(); ++j)
+    auto evaluate = [&](vtkIdType id)
     {
-      // get id
-      const vtkIdType id = ids->GetId(j);
       // compute weightmatrix
       WeightMatrix m = mitk::AnisotropicRegistrationCommon::CalculateWeightMatrix(sigma_X[i], sigma_Y[id]);
       // point of the fixed data set
-      Y->GetDataSet()->GetPoint(id, p);
+      const double *q = Y.GetPoint(id);
 
       // fill mitk vector
-      y[0] = p[0];
-      y[1] = p[1];
-      y[2] = p[2];
+      y[0] = q[0];
+      y[1] = q[1];
+      y[2] = q[2];
 
       const mitk::Vector3D res = m * (x - y);
 
       const double dist = res[0] * res[0] + res[1] * res[1] + res[2] * res[2];
 
-      if (dist < bestDist)
+      if (bestIdx < 0 || dist < bestDist)
       {
         bestDist = dist;
         bestIdx = id;
       }
+    };
+
+    // double the radius till we find at least one point
+    while (bestIdx < 0)
+    {
+      Y.FindPointsWithinRadius(r, p, evaluate);
+      r *= 2.0;
+    }
+
+    bestIds[i] = bestIdx;
+    correspondences[i] = Correspondence(i, bestDist);
+  };
+
+  // the moving points are processed in blocks by all cores
+  const vtkIdType blockSize = 256;
+  const vtkIdType numberOfBlocks = (numberOfPoints + blockSize - 1) / blockSize;
+  std::atomic<vtkIdType> nextBlock(0);
+  std::exception_ptr exception;
+  std::mutex exceptionMutex;
+
+  auto worker = [&]()
+  {
+    for (vtkIdType block = nextBlock++; block < numberOfBlocks; block = nextBlock++)
+    {
+      try
+      {
+        const vtkIdType end = std::min(numberOfPoints, (block + 1) * blockSize);
+        for (vtkIdType i = block * blockSize; i < end; ++i)
+        {
+          searchCorrespondence(i);
+        }
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(exceptionMutex);
+        if (!exception)
+          exception = std::current_exception();
+        nextBlock = numberOfBlocks;
+        return;
+      }
     }
+  };
 
-    // save correspondences of the fixed point set
-    Y->GetDataSet()->GetPoint(bestIdx, p);
-    Z->SetPoint(i, p);
-    sigma_Z[i] = sigma_Y[bestIdx];
+  const vtkIdType numberOfThreads =
+    std::max<vtkIdType>(1, std::min<vtkIdType>(std::max(1u, std::thread::hardware_concurrency()), numberOfBlocks));
+  std::vector<std::thread> threads;
+  for (vtkIdType t = 1; t < numberOfThreads; ++t)
+  {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
 
-    Correspondence _pair(i, bestDist);
-    correspondences[i] = _pair;
+  if (exception)
+  {
+    std::rethrow_exception(exception);
+  }
 
-    ids->Delete();
+  // save correspondences of the fixed point set
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+  {
+    Z->SetPoint(i, Y.GetPoint(bestIds[i]));
+    sigma_Z[i] = sigma_Y[bestIds[i]];
   }
 }
 
@@ -159,10 +354,14 @@ void mitk::AnisotropicIterativeClosestPointRegistration::Update()
   CovarianceMatrixList Sigma_X_sorted;
   CovarianceMatrixList Sigma_Z_sorted;
 
-  // create kdtree for correspondence search
-  vtkKdTreePointLocator *Y = vtkKdTreePointLocator::New();
-  Y->SetDataSet(m_FixedSurface->GetVtkPolyData());
-  Y->BuildLocator();
+  // (re)build the kdtree for correspondence search if the fixed surface changed
+  m_FixedPointTree->Update(m_FixedSurface->GetVtkPolyData());
+  const FixedPointTree &Y = *m_FixedPointTree;
+
+  if (Y.GetNumberOfPoints() == 0)
+  {
+    mitkThrow() << "Fixed surface contains no points";
+  }
 
   // initialize local variables
   // copy the moving pointset to prevent to modify it
@@ -224,7 +423,8 @@ void mitk::AnisotropicIterativeClosestPointRegistration::Update()
       // distance, if trimming is enabled
       if (m_TrimmFactor > 0.0)
       {
-        std::sort(distanceList.begin(), distanceList.end(), AICPComp);
+        // only the best correspondences are used, so only they need to be sorted
+        std::partial_sort(distanceList.begin(), distanceList.begin() + numberOfTrimmedPoints, distanceList.end(), AICPComp);
         // map correspondences to the data arrays
         for (unsigned int i = 0; i < numberOfTrimmedPoints; ++i)
         {
@@ -302,7 +502,6 @@ void mitk::AnisotropicIterativeClosestPointRegistration::Update()
     mitk::ProgressBar::GetInstance()->Progress(steps);
 
   // free memory
-  Y->Delete();
   Z->Delete();
   X->Delete();
   X_sorted->Delete();
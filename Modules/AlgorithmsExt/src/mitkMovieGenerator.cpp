@@ -16,20 +16,15 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkMovieGenerator.h"
 #include "mitkConfig.h"
+#include "mitkMovieGeneratorFFmpeg.h"
 #include <mitkRenderingManager.h>
-#include "vtk_glew.h"
 
 #if WIN32
 #ifndef __GNUC__
 //#if ! (_MSC_VER >= 1400)
 #include "mitkMovieGeneratorWin32.h"
 //#endif
-#else
-#include "GL/glext.h"
-#endif
 #endif
-#ifndef GL_BGR
-#define GL_BGR GL_BGR_EXT
 #endif
 
 mitk::MovieGenerator::MovieGenerator()
@@ -38,6 +33,12 @@ mitk::MovieGenerator::MovieGenerator()
   m_fileName[0] = 0;
 }
 
+mitk::MovieGenerator::~MovieGenerator()
+{
+  if (m_FrameReader.IsNotNull())
+    m_FrameReader->Discard();
+}
+
 mitk::MovieGenerator::Pointer mitk::MovieGenerator::New()
 {
   Pointer smartPtr;
@@ -51,6 +52,9 @@ mitk::MovieGenerator::Pointer mitk::MovieGenerator::New()
     return wp;
 //#endif
 #endif
+#else
+    mitk::MovieGenerator::Pointer fp = static_cast<mitk::MovieGenerator *>(mitk::MovieGeneratorFFmpeg::New());
+    return fp;
 #endif
   }
   smartPtr = rawPtr;
@@ -75,9 +79,7 @@ bool mitk::MovieGenerator::WriteMovie()
       TerminateGenerator();
       return false;
     }
-    int imgSize = 3 * m_width * m_height;
     printf("Video size = %i x %i\n", m_width, m_height);
-    auto *data = new GLbyte[imgSize];
 
     // duplicate steps if pingPong option is switched to on.
     unsigned int numOfSteps = m_stepper->GetSteps();
@@ -89,12 +91,11 @@ bool mitk::MovieGenerator::WriteMovie()
       if (m_renderer)
         m_renderer->GetRenderWindow()->MakeCurrent();
       RenderingManager::GetInstance()->ForceImmediateUpdate(m_renderer->GetRenderWindow());
-      glReadPixels(5, 5, m_width, m_height, GL_BGR, GL_UNSIGNED_BYTE, (void *)data);
-      AddFrame(data);
+      ReadFrame();
       m_stepper->Next();
     }
+    FlushFrames();
     ok = TerminateGenerator();
-    delete[] data;
   }
   return ok;
 }
@@ -115,19 +116,36 @@ bool mitk::MovieGenerator::WriteCurrentFrameToMovie()
       TerminateGenerator();
       return false;
     }
-    int imgSize = 3 * m_width * m_height;
-    auto *data = new GLbyte[imgSize];
-
     RenderingManager::GetInstance()->ForceImmediateUpdate(m_renderer->GetRenderWindow());
-    glReadPixels(5, 5, m_width, m_height, GL_BGR, GL_UNSIGNED_BYTE, (void *)data);
-    AddFrame(data);
-    delete[] data;
+    ReadFrame();
   }
   return true;
 }
 
+void mitk::MovieGenerator::ReadFrame()
+{
+  if (m_FrameReader.IsNull())
+  {
+    m_FrameReader = RenderWindowFrameReader::New();
+    m_FrameReader->SetPixelFormat(RenderWindowFrameReader::BGR);
+  }
+  m_FrameReader->SetRenderWindow(m_renderer->GetRenderWindow());
+
+  // the frame of 5 pixels around the render window is not recorded
+  m_FrameReader->ReadPixels(5, 5, m_width, m_height, [this](const unsigned char *pixels, int, int) {
+    this->AddFrame(const_cast<unsigned char *>(pixels));
+  });
+}
+
+void mitk::MovieGenerator::FlushFrames()
+{
+  if (m_FrameReader.IsNotNull())
+    m_FrameReader->Flush();
+}
+
 void mitk::MovieGenerator::ReleaseMovieWriter()
 {
+  FlushFrames();
   TerminateGenerator();
   m_initialized = false;
 }
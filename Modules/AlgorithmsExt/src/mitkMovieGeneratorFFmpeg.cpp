@@ -0,0 +1,116 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkMovieGeneratorFFmpeg.h"
+
+#include <mitkLogMacros.h>
+
+#include <vtkRenderWindow.h>
+
+#include <cstdlib>
+#include <sstream>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+mitk::MovieGeneratorFFmpeg::MovieGeneratorFFmpeg()
+  : m_EncoderExecutable("ffmpeg"), m_VideoCodec("libx264"), m_EncoderArguments("-pix_fmt yuv420p"), m_Encoder(nullptr)
+{
+  const char *executable = std::getenv("MITK_FFMPEG_EXECUTABLE");
+  if (executable != nullptr && executable[0] != 0)
+    m_EncoderExecutable = executable;
+}
+
+mitk::MovieGeneratorFFmpeg::~MovieGeneratorFFmpeg()
+{
+  if (m_Encoder != nullptr)
+    pclose(m_Encoder);
+}
+
+bool mitk::MovieGeneratorFFmpeg::InitGenerator()
+{
+  if (m_Encoder != nullptr)
+    this->TerminateGenerator();
+
+  m_width = m_renderer->GetRenderWindow()->GetSize()[0];
+  m_height = m_renderer->GetRenderWindow()->GetSize()[1];
+
+  m_width -= 10; // remove colored borders around render windows
+  m_height -= 10;
+
+  m_width -= m_width % 4; // some video codecs have prerequisites to the image dimensions
+  m_height -= m_height % 4;
+
+  if (m_width <= 0 || m_height <= 0)
+  {
+    MITK_ERROR << "Render window is too small to record a movie.";
+    return false;
+  }
+
+  // the frames arrive bottom row first, vflip turns them upright
+  std::ostringstream command;
+  command << "\"" << m_EncoderExecutable << "\" -y -loglevel error -f rawvideo -pix_fmt bgr24 -s " << m_width << "x"
+          << m_height << " -r " << m_FrameRate << " -i - -vf vflip -c:v " << m_VideoCodec << " " << m_EncoderArguments
+          << " \"" << m_fileName << "\"";
+
+#ifdef _WIN32
+  m_Encoder = popen(command.str().c_str(), "wb");
+#else
+  m_Encoder = popen(command.str().c_str(), "w");
+#endif
+
+  if (m_Encoder == nullptr)
+  {
+    MITK_ERROR << "Could not start the encoder: " << command.str();
+    return false;
+  }
+
+  return true;
+}
+
+bool mitk::MovieGeneratorFFmpeg::AddFrame(void *data)
+{
+  if (m_Encoder == nullptr)
+    return false;
+
+  const std::size_t size = 3 * static_cast<std::size_t>(m_width) * m_height;
+  if (fwrite(data, 1, size, m_Encoder) != size)
+  {
+    MITK_ERROR << "Writing a frame to the encoder failed.";
+    return false;
+  }
+
+  return true;
+}
+
+bool mitk::MovieGeneratorFFmpeg::TerminateGenerator()
+{
+  if (m_Encoder == nullptr)
+    return false;
+
+  const int status = pclose(m_Encoder);
+  m_Encoder = nullptr;
+
+  if (status != 0)
+  {
+    MITK_ERROR << "The encoder failed to write " << m_fileName << " (exit status " << status << ").";
+    return false;
+  }
+
+  return true;
+}
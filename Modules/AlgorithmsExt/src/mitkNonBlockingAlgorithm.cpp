@@ -21,11 +21,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 namespace mitk
 {
-  NonBlockingAlgorithm::NonBlockingAlgorithm() : m_ThreadID(-1), m_UpdateRequests(0), m_KillRequest(false)
+  NonBlockingAlgorithm::NonBlockingAlgorithm()
+    : m_UpdateRequests(0), m_Priority(TaskScheduler::NormalPriority), m_KillRequest(false)
   {
     m_ParameterListMutex = itk::FastMutexLock::New();
     m_Parameters = PropertyList::New();
-    m_MultiThreader = itk::MultiThreader::New();
   }
 
   NonBlockingAlgorithm::~NonBlockingAlgorithm() {}
@@ -97,43 +97,72 @@ namespace mitk
     m_ParameterListMutex->Lock();
     m_ThreadParameters.m_Algorithm = this;
     ++m_UpdateRequests;
-    m_ParameterListMutex->Unlock();
-    if (m_ThreadID != -1) // thread already running. But something obviously wants us to recalculate the output
+    if (m_Task != nullptr) // task already queued or running. But something obviously wants us to recalculate the output
     {
-      return; // thread already running
+      m_ParameterListMutex->Unlock();
+      return; // the running task picks up the request
     }
 
-    // spawn a thread that calls ThreadedUpdateFunction(), and ThreadedUpdateFinished() on us
-    itk::ThreadFunctionType fpointer = &StaticNonBlockingAlgorithmThread;
-    m_ThreadID = m_MultiThreader->SpawnThread(fpointer, &m_ThreadParameters);
+    // tasks writing the input are not run at the same time
+    std::vector<TaskScheduler::Resource> resources;
+    auto *input = dynamic_cast<SmartPointerProperty *>(m_Parameters->GetProperty("Input"));
+    if (input != nullptr && input->GetSmartPointer().IsNotNull())
+    {
+      resources.push_back(TaskScheduler::Resource(input->GetSmartPointer().GetPointer(), TaskScheduler::ReadAccess));
+    }
+
+    // run ThreadedUpdateFunction() and ThreadedUpdateFinished() on the shared scheduler
+    NonBlockingAlgorithm::Pointer algorithm = this;
+    m_Task =
+      TaskScheduler::GetInstance()->Submit([algorithm]() { RunThreadedUpdates(algorithm); }, m_Priority, resources);
+    m_ParameterListMutex->Unlock();
   }
 
   void NonBlockingAlgorithm::StopAlgorithm()
   {
-    if (m_ThreadID == -1)
-      return; // thread not running
+    m_ParameterListMutex->Lock();
+    TaskScheduler::TaskPointer task = m_Task;
+    m_ParameterListMutex->Unlock();
 
-    m_MultiThreader->TerminateThread(m_ThreadID); // waits for the thread to terminate on its own
+    if (task == nullptr)
+      return; // task not running
+
+    task->Wait(); // waits for the task to terminate on its own
   }
 
-  // a static function to call a member of NonBlockingAlgorithm from inside an ITK thread
-  ITK_THREAD_RETURN_TYPE NonBlockingAlgorithm::StaticNonBlockingAlgorithmThread(void *param)
+  void NonBlockingAlgorithm::CancelAlgorithm()
   {
-    // itk::MultiThreader provides an itk::MultiThreader::ThreadInfoStruct as parameter
-    auto *itkmttis = static_cast<itk::MultiThreader::ThreadInfoStruct *>(param);
+    m_ParameterListMutex->Lock();
+    m_UpdateRequests = 0;
+    TaskScheduler::TaskPointer task = m_Task;
+    m_ParameterListMutex->Unlock();
 
-    // we need the UserData part of that structure
-    auto *flsp = static_cast<ThreadParameters *>(itkmttis->UserData);
+    if (task == nullptr)
+      return;
 
-    NonBlockingAlgorithm::Pointer algorithm = flsp->m_Algorithm;
-    // this UserData tells us, which BubbleTool's method to call
+    if (task->Cancel())
+    {
+      // the task never ran, so no callback from the GUI thread resets it
+      m_ParameterListMutex->Lock();
+      if (m_Task == task)
+      {
+        m_Task = nullptr;
+        m_ThreadParameters.m_Algorithm = nullptr;
+      }
+      m_ParameterListMutex->Unlock();
+    }
+  }
+
+  // runs the requested updates of the algorithm on a thread of the TaskScheduler
+  void NonBlockingAlgorithm::RunThreadedUpdates(NonBlockingAlgorithm::Pointer algorithm)
+  {
     if (!algorithm)
     {
-      return ITK_THREAD_RETURN_VALUE;
+      return;
     }
 
     algorithm->m_ParameterListMutex->Lock();
-    while (algorithm->m_UpdateRequests > 0)
+    while (algorithm->m_UpdateRequests > 0 && !TaskScheduler::IsCurrentTaskCanceled())
     {
       algorithm->m_UpdateRequests = 0;
       algorithm->m_ParameterListMutex->Unlock();
@@ -159,8 +188,6 @@ namespace mitk
       algorithm->m_ParameterListMutex->Lock();
     }
     algorithm->m_ParameterListMutex->Unlock();
-
-    return ITK_THREAD_RETURN_VALUE;
   }
 
   void NonBlockingAlgorithm::TriggerParameterModified(const itk::EventObject &) { StartAlgorithm(); }
@@ -176,7 +203,7 @@ namespace mitk
     ThreadedUpdateSuccessful();
 
     m_ParameterListMutex->Lock();
-    m_ThreadID = -1; // tested before starting
+    m_Task = nullptr; // tested before starting
     m_ParameterListMutex->Unlock();
     m_ThreadParameters.m_Algorithm = nullptr;
   }
@@ -193,7 +220,7 @@ namespace mitk
     ThreadedUpdateFailed();
 
     m_ParameterListMutex->Lock();
-    m_ThreadID = -1; // tested before starting
+    m_Task = nullptr; // tested before starting
     m_ParameterListMutex->Unlock();
     m_ThreadParameters.m_Algorithm = nullptr; // delete
   }
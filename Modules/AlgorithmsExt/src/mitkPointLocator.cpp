@@ -15,29 +15,89 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "mitkPointLocator.h"
-#include <ANN/ANN.h>
+#include <mitkTaskScheduler.h>
 #include <vtkPointSet.h>
 
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+
+namespace
+{
+  // Subtrees with at most this many points are searched linearly
+  const std::size_t LeafSize = 8;
+
+  // Subtrees with more points are built by a task of their own
+  const std::size_t ParallelBuildSize = 1 << 16;
+
+  typedef mitk::PointLocator::IdType IdType;
+  typedef mitk::PointLocator::DistanceType DistanceType;
+
+  /** The k best candidates of a query, kept as a max-heap on the squared distance */
+  class Candidates
+  {
+  public:
+    Candidates(unsigned int k, std::pair<DistanceType, std::size_t> *storage) : m_K(k), m_Size(0), m_Heap(storage) {}
+
+    DistanceType GetWorstDistance() const
+    {
+      return m_Size < m_K ? std::numeric_limits<DistanceType>::infinity() : m_Heap[0].first;
+    }
+
+    void Insert(DistanceType distance, std::size_t index)
+    {
+      if (m_Size < m_K)
+      {
+        m_Heap[m_Size++] = std::make_pair(distance, index);
+        std::push_heap(m_Heap, m_Heap + m_Size);
+      }
+      else if (distance < m_Heap[0].first)
+      {
+        std::pop_heap(m_Heap, m_Heap + m_Size);
+        m_Heap[m_Size - 1] = std::make_pair(distance, index);
+        std::push_heap(m_Heap, m_Heap + m_Size);
+      }
+    }
+
+    unsigned int Sort()
+    {
+      std::sort_heap(m_Heap, m_Heap + m_Size);
+      return m_Size;
+    }
+
+  private:
+    unsigned int m_K;
+    unsigned int m_Size;
+    std::pair<DistanceType, std::size_t> *m_Heap;
+  };
+
+  void ParallelFor(std::size_t size, const std::function<void(std::size_t, std::size_t)> &function)
+  {
+    mitk::TaskScheduler *scheduler = mitk::TaskScheduler::GetInstance();
+    const std::size_t numberOfChunks =
+      std::max<std::size_t>(1, std::min<std::size_t>(size, 4 * scheduler->GetNumberOfThreads()));
+    const std::size_t chunkSize = (size + numberOfChunks - 1) / numberOfChunks;
+
+    std::vector<mitk::TaskScheduler::TaskPointer> tasks;
+    for (std::size_t begin = 0; begin < size; begin += chunkSize)
+    {
+      const std::size_t end = std::min(size, begin + chunkSize);
+      tasks.push_back(scheduler->Submit([&function, begin, end]() { function(begin, end); }));
+    }
+
+    for (const auto &task : tasks)
+      task->Wait();
+  }
+}
+
 mitk::PointLocator::PointLocator()
-  : m_SearchTreeInitialized(false),
-    m_VtkPoints(nullptr),
-    m_MitkPoints(nullptr),
-    m_ItkPoints(nullptr),
-    m_ANNK(1),
-    m_ANNDimension(3),
-    m_ANNEpsilon(0),
-    m_ANNDataPoints(nullptr),
-    m_ANNQueryPoint(nullptr),
-    m_ANNPointIndexes(nullptr),
-    m_ANNDistances(nullptr),
-    m_ANNTree(nullptr)
+  : m_SearchTreeInitialized(false), m_VtkPoints(nullptr), m_MitkPoints(nullptr), m_ItkPoints(nullptr), m_PointsMTime(0)
 {
 }
 
 mitk::PointLocator::~PointLocator()
 {
-  if (m_SearchTreeInitialized)
-    DestroyANN();
 }
 
 void mitk::PointLocator::SetPoints(vtkPointSet *pointSet)
@@ -48,31 +108,40 @@ void mitk::PointLocator::SetPoints(vtkPointSet *pointSet)
     return;
   }
   vtkPoints *points = pointSet->GetPoints();
+  if (points == nullptr)
+  {
+    // a point set without points
+    m_VtkPoints = nullptr;
+    m_MitkPoints = nullptr;
+    m_ItkPoints = nullptr;
+    m_Coordinates.clear();
+    m_IndexToPointIdContainer.clear();
+    ClearTree();
+    return;
+  }
 
   if (m_VtkPoints)
   {
-    if ((m_VtkPoints == points) && (m_VtkPoints->GetMTime() == points->GetMTime()))
+    if ((m_VtkPoints == points) && (m_PointsMTime == points->GetMTime()))
     {
       return; // no need to recalculate search tree
     }
   }
   m_VtkPoints = points;
+  m_MitkPoints = nullptr;
+  m_ItkPoints = nullptr;
+  m_PointsMTime = points->GetMTime();
 
   size_t size = points->GetNumberOfPoints();
-  if (m_ANNDataPoints != nullptr)
-    delete[] m_ANNDataPoints;
-  m_ANNDataPoints = annAllocPts(size, m_ANNDimension);
+  m_Coordinates.resize(3 * size);
   m_IndexToPointIdContainer.clear();
   m_IndexToPointIdContainer.resize(size);
   for (vtkIdType i = 0; (unsigned)i < size; ++i)
   {
-    double *currentPoint = points->GetPoint(i);
-    (m_ANNDataPoints[i])[0] = currentPoint[0];
-    (m_ANNDataPoints[i])[1] = currentPoint[1];
-    (m_ANNDataPoints[i])[2] = currentPoint[2];
+    points->GetPoint(i, &m_Coordinates[3 * i]);
     m_IndexToPointIdContainer[i] = i;
   }
-  InitANN();
+  BuildTree();
 }
 
 void mitk::PointLocator::SetPoints(mitk::PointSet *points)
@@ -85,17 +154,18 @@ void mitk::PointLocator::SetPoints(mitk::PointSet *points)
 
   if (m_MitkPoints)
   {
-    if ((m_MitkPoints == points) && (m_MitkPoints->GetMTime() == points->GetMTime()))
+    if ((m_MitkPoints == points) && (m_PointsMTime == points->GetMTime()))
     {
       return; // no need to recalculate search tree
     }
   }
   m_MitkPoints = points;
+  m_VtkPoints = nullptr;
+  m_ItkPoints = nullptr;
+  m_PointsMTime = points->GetMTime();
 
   size_t size = points->GetSize();
-  if (m_ANNDataPoints != nullptr)
-    delete[] m_ANNDataPoints;
-  m_ANNDataPoints = annAllocPts(size, m_ANNDimension);
+  m_Coordinates.resize(3 * size);
   m_IndexToPointIdContainer.clear();
   m_IndexToPointIdContainer.resize(size);
   size_t counter = 0;
@@ -107,12 +177,12 @@ void mitk::PointLocator::SetPoints(mitk::PointSet *points)
   {
     currentPoint = it->Value();
     currentId = it->Index();
-    (m_ANNDataPoints[counter])[0] = currentPoint[0];
-    (m_ANNDataPoints[counter])[1] = currentPoint[1];
-    (m_ANNDataPoints[counter])[2] = currentPoint[2];
+    m_Coordinates[3 * counter] = currentPoint[0];
+    m_Coordinates[3 * counter + 1] = currentPoint[1];
+    m_Coordinates[3 * counter + 2] = currentPoint[2];
     m_IndexToPointIdContainer[counter] = currentId;
   }
-  InitANN();
+  BuildTree();
 }
 
 void mitk::PointLocator::SetPoints(ITKPointSet *pointSet)
@@ -125,17 +195,18 @@ void mitk::PointLocator::SetPoints(ITKPointSet *pointSet)
 
   if (m_ItkPoints)
   {
-    if ((m_ItkPoints == pointSet) && (m_ItkPoints->GetMTime() == pointSet->GetMTime()))
+    if ((m_ItkPoints == pointSet) && (m_PointsMTime == pointSet->GetMTime()))
     {
       return; // no need to recalculate search tree
     }
   }
   m_ItkPoints = pointSet;
+  m_VtkPoints = nullptr;
+  m_MitkPoints = nullptr;
+  m_PointsMTime = pointSet->GetMTime();
 
   size_t size = pointSet->GetNumberOfPoints();
-  if (m_ANNDataPoints != nullptr)
-    delete[] m_ANNDataPoints;
-  m_ANNDataPoints = annAllocPts(size, m_ANNDimension);
+  m_Coordinates.resize(3 * size);
   m_IndexToPointIdContainer.clear();
   m_IndexToPointIdContainer.resize(size);
   size_t counter = 0;
@@ -147,99 +218,230 @@ void mitk::PointLocator::SetPoints(ITKPointSet *pointSet)
   {
     currentPoint = it->Value();
     currentId = it->Index();
-    (m_ANNDataPoints[counter])[0] = currentPoint[0];
-    (m_ANNDataPoints[counter])[1] = currentPoint[1];
-    (m_ANNDataPoints[counter])[2] = currentPoint[2];
+    m_Coordinates[3 * counter] = currentPoint[0];
+    m_Coordinates[3 * counter + 1] = currentPoint[1];
+    m_Coordinates[3 * counter + 2] = currentPoint[2];
     m_IndexToPointIdContainer[counter] = currentId;
   }
-  InitANN();
+  BuildTree();
 }
 
 mitk::PointLocator::IdType mitk::PointLocator::FindClosestPoint(const double point[3])
 {
-  m_ANNQueryPoint[0] = point[0];
-  m_ANNQueryPoint[1] = point[1];
-  m_ANNQueryPoint[2] = point[2];
-  return FindClosestANNPoint(m_ANNQueryPoint);
+  IdType id = -1;
+  DistanceType distance;
+  this->SearchTree(point, 1, &id, &distance);
+  return id;
 }
 
 mitk::PointLocator::IdType mitk::PointLocator::FindClosestPoint(double x, double y, double z)
 {
-  m_ANNQueryPoint[0] = x;
-  m_ANNQueryPoint[1] = y;
-  m_ANNQueryPoint[2] = z;
-  return FindClosestANNPoint(m_ANNQueryPoint);
+  const double point[3] = {x, y, z};
+  return FindClosestPoint(point);
 }
 
 mitk::PointLocator::IdType mitk::PointLocator::FindClosestPoint(mitk::PointSet::PointType point)
 {
-  m_ANNQueryPoint[0] = point[0];
-  m_ANNQueryPoint[1] = point[1];
-  m_ANNQueryPoint[2] = point[2];
-  return FindClosestANNPoint(m_ANNQueryPoint);
+  const double queryPoint[3] = {point[0], point[1], point[2]};
+  return FindClosestPoint(queryPoint);
+}
+
+mitk::PointLocator::DistanceType mitk::PointLocator::GetMinimalDistance(mitk::PointSet::PointType point)
+{
+  const double queryPoint[3] = {point[0], point[1], point[2]};
+  return GetMinimalSquaredDistance(queryPoint);
 }
 
-mitk::PointLocator::IdType mitk::PointLocator::FindClosestANNPoint(const ANNpoint &point)
+mitk::PointLocator::DistanceType mitk::PointLocator::GetMinimalSquaredDistance(const double point[3]) const
 {
-  if (!m_SearchTreeInitialized)
-    return -1;
-  m_ANNTree->annkSearch(point, m_ANNK, m_ANNPointIndexes, m_ANNDistances);
-  return m_IndexToPointIdContainer[m_ANNPointIndexes[0]];
+  IdType id;
+  DistanceType distance = -1;
+  this->SearchTree(point, 1, &id, &distance);
+  return distance;
 }
 
-mitk::PointLocator::DistanceType mitk::PointLocator::GetMinimalDistance(mitk::PointSet::PointType point)
+bool mitk::PointLocator::FindClosestPointAndDistance(mitk::PointSet::PointType point, IdType *id, DistanceType *dist)
+{
+  const double queryPoint[3] = {point[0], point[1], point[2]};
+  return this->SearchTree(queryPoint, 1, id, dist) == 1;
+}
+
+void mitk::PointLocator::FindKClosestPoints(const double point[3],
+                                            unsigned int k,
+                                            IdVectorType &ids,
+                                            DistanceVectorType &squaredDistances) const
+{
+  ids.resize(k);
+  squaredDistances.resize(k);
+  const unsigned int found = k > 0 ? this->SearchTree(point, k, ids.data(), squaredDistances.data()) : 0;
+  ids.resize(found);
+  squaredDistances.resize(found);
+}
+
+void mitk::PointLocator::FindClosestPoints(vtkPoints *queryPoints,
+                                           IdVectorType &ids,
+                                           DistanceVectorType &squaredDistances) const
 {
-  m_ANNQueryPoint[0] = point[0];
-  m_ANNQueryPoint[1] = point[1];
-  m_ANNQueryPoint[2] = point[2];
-  return GetMinimalDistance(m_ANNQueryPoint);
+  this->FindKClosestPoints(queryPoints, 1, ids, squaredDistances);
 }
 
-mitk::PointLocator::DistanceType mitk::PointLocator::GetMinimalDistance(const ANNpoint &point)
+void mitk::PointLocator::FindKClosestPoints(vtkPoints *queryPoints,
+                                            unsigned int k,
+                                            IdVectorType &ids,
+                                            DistanceVectorType &squaredDistances) const
 {
-  if (!m_SearchTreeInitialized)
-    return -1;
-  m_ANNTree->annkSearch(point, m_ANNK, m_ANNPointIndexes, m_ANNDistances);
-  return m_ANNDistances[0];
+  const std::size_t numberOfQueries = queryPoints != nullptr ? queryPoints->GetNumberOfPoints() : 0;
+  ids.assign(numberOfQueries * k, -1);
+  squaredDistances.assign(numberOfQueries * k, std::numeric_limits<DistanceType>::infinity());
+
+  if (k == 0)
+    return;
+
+  ParallelFor(numberOfQueries, [&](std::size_t begin, std::size_t end) {
+    double point[3];
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      queryPoints->GetPoint(static_cast<vtkIdType>(i), point);
+      this->SearchTree(point, k, &ids[i * k], &squaredDistances[i * k]);
+    }
+  });
 }
 
-void mitk::PointLocator::InitANN()
+void mitk::PointLocator::BuildTree()
 {
-  if (m_SearchTreeInitialized)
-    DestroyANN();
+  ClearTree();
+
+  const std::size_t size = m_IndexToPointIdContainer.size();
+  if (size == 0)
+    return;
+
+  std::vector<std::size_t> order(size);
+  std::iota(order.begin(), order.end(), 0);
+  m_SplitDimensions.assign(size, 0);
+
+  // Splits the range at its median along the dimension of largest extent and continues with both halves
+  std::function<void(std::size_t, std::size_t)> build = [&](std::size_t begin, std::size_t end) {
+    if (end - begin <= LeafSize)
+      return;
+
+    double lower[3], upper[3];
+    for (int d = 0; d < 3; ++d)
+    {
+      lower[d] = std::numeric_limits<double>::max();
+      upper[d] = std::numeric_limits<double>::lowest();
+    }
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      for (int d = 0; d < 3; ++d)
+      {
+        lower[d] = std::min(lower[d], m_Coordinates[3 * order[i] + d]);
+        upper[d] = std::max(upper[d], m_Coordinates[3 * order[i] + d]);
+      }
+    }
+
+    unsigned char dimension = 0;
+    for (unsigned char d = 1; d < 3; ++d)
+    {
+      if (upper[d] - lower[d] > upper[dimension] - lower[dimension])
+        dimension = d;
+    }
+
+    const std::size_t middle = begin + (end - begin) / 2;
+    std::nth_element(order.begin() + begin,
+                     order.begin() + middle,
+                     order.begin() + end,
+                     [this, dimension](std::size_t a, std::size_t b) {
+                       return m_Coordinates[3 * a + dimension] < m_Coordinates[3 * b + dimension];
+                     });
+    m_SplitDimensions[middle] = dimension;
+
+    if (end - begin > ParallelBuildSize)
+    {
+      mitk::TaskScheduler::TaskPointer left =
+        mitk::TaskScheduler::GetInstance()->Submit([&build, begin, middle]() { build(begin, middle); });
+      build(middle + 1, end);
+      left->Wait();
+    }
+    else
+    {
+      build(begin, middle);
+      build(middle + 1, end);
+    }
+  };
+  build(0, size);
 
-  m_ANNQueryPoint = annAllocPt(m_ANNDimension);
-  m_ANNPointIndexes = new ANNidx[m_ANNK];
-  m_ANNDistances = new ANNdist[m_ANNK];
-  m_ANNTree = new ANNkd_tree(m_ANNDataPoints, m_IndexToPointIdContainer.size(), m_ANNDimension);
+  // store the points in tree order
+  std::vector<double> coordinates(3 * size);
+  IdVectorType ids(size);
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    std::copy(&m_Coordinates[3 * order[i]], &m_Coordinates[3 * order[i]] + 3, &coordinates[3 * i]);
+    ids[i] = m_IndexToPointIdContainer[order[i]];
+  }
+  m_Coordinates.swap(coordinates);
+  m_IndexToPointIdContainer.swap(ids);
 
   m_SearchTreeInitialized = true;
 }
 
-void mitk::PointLocator::DestroyANN()
+void mitk::PointLocator::ClearTree()
 {
   m_SearchTreeInitialized = false;
-  if (m_ANNQueryPoint != nullptr)
-    annDeallocPt(m_ANNQueryPoint);
-  if (m_ANNDataPoints != nullptr)
-    annDeallocPts(m_ANNDataPoints);
-  if (m_ANNPointIndexes != nullptr)
-    delete[] m_ANNPointIndexes;
-  if (m_ANNDistances != nullptr)
-    delete[] m_ANNDistances;
-  if (m_ANNTree != nullptr)
-    delete m_ANNTree;
+  m_SplitDimensions.clear();
 }
 
-bool mitk::PointLocator::FindClosestPointAndDistance(mitk::PointSet::PointType point, IdType *id, DistanceType *dist)
+unsigned int mitk::PointLocator::SearchTree(const double point[3],
+                                            unsigned int k,
+                                            IdType *ids,
+                                            DistanceType *squaredDistances) const
 {
-  m_ANNQueryPoint[0] = point[0];
-  m_ANNQueryPoint[1] = point[1];
-  m_ANNQueryPoint[2] = point[2];
+  if (!m_SearchTreeInitialized || k == 0)
+    return 0;
+
+  std::vector<std::pair<DistanceType, std::size_t>> storage(std::min<std::size_t>(k, m_IndexToPointIdContainer.size()));
+  Candidates candidates(static_cast<unsigned int>(storage.size()), storage.data());
+
+  auto consider = [&](std::size_t i) {
+    const double *p = &m_Coordinates[3 * i];
+    const double dx = point[0] - p[0], dy = point[1] - p[1], dz = point[2] - p[2];
+    candidates.Insert(dx * dx + dy * dy + dz * dz, i);
+  };
+
+  std::function<void(std::size_t, std::size_t)> search = [&](std::size_t begin, std::size_t end) {
+    if (end - begin <= LeafSize)
+    {
+      for (std::size_t i = begin; i < end; ++i)
+        consider(i);
+      return;
+    }
+
+    const std::size_t middle = begin + (end - begin) / 2;
+    const unsigned char dimension = m_SplitDimensions[middle];
+    const double difference = point[dimension] - m_Coordinates[3 * middle + dimension];
 
-  m_ANNTree->annkSearch(m_ANNQueryPoint, m_ANNK, m_ANNPointIndexes, m_ANNDistances);
+    consider(middle);
+
+    // the side of the query point first, the other side only if it can contain closer points
+    if (difference < 0)
+    {
+      search(begin, middle);
+      if (difference * difference < candidates.GetWorstDistance())
+        search(middle + 1, end);
+    }
+    else
+    {
+      search(middle + 1, end);
+      if (difference * difference < candidates.GetWorstDistance())
+        search(begin, middle);
+    }
+  };
+  search(0, m_IndexToPointIdContainer.size());
 
-  *id = m_IndexToPointIdContainer[m_ANNPointIndexes[0]];
-  *dist = m_ANNDistances[0];
-  return true;
+  const unsigned int found = candidates.Sort();
+  for (unsigned int i = 0; i < found; ++i)
+  {
+    squaredDistances[i] = storage[i].first;
+    ids[i] = m_IndexToPointIdContainer[storage[i].second];
+  }
+  return found;
 }
@@ -16,19 +16,193 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mitkUnstructuredGridClusteringFilter.h>
 
+#include <mitkTaskScheduler.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
 #include <vector>
 
 #include <vtkDataArray.h>
 #include <vtkDelaunay3D.h>
 #include <vtkDoubleArray.h>
 #include <vtkPointData.h>
-#include <vtkPointLocator.h>
 #include <vtkPoints.h>
 #include <vtkPolyVertex.h>
 #include <vtkSmartPointer.h>
 #include <vtkUnstructuredGrid.h>
 #include <vtkVariant.h>
 
+namespace
+{
+  /** Uniform grid over the points for the region queries of DBSCAN */
+  class PointGrid
+  {
+  public:
+    PointGrid(vtkPoints *points, double eps) : m_Eps2(eps * eps)
+    {
+      const vtkIdType numberOfPoints = points->GetNumberOfPoints();
+      m_Coordinates.resize(3 * numberOfPoints);
+      for (vtkIdType i = 0; i < numberOfPoints; ++i)
+        points->GetPoint(i, &m_Coordinates[3 * i]);
+
+      double bounds[6];
+      points->GetBounds(bounds);
+      const double extent = std::max(bounds[1] - bounds[0], std::max(bounds[3] - bounds[2], bounds[5] - bounds[4]));
+
+      // cells larger than eps only cost time, but keep the cell coordinates within 21 bits each
+      m_CellSize = std::max(eps, extent / (1 << 20));
+      if (!(m_CellSize > 0.0))
+        m_CellSize = 1.0;
+      for (int i = 0; i < 3; ++i)
+        m_Origin[i] = bounds[2 * i];
+
+      // sort the points by cell, each cell is a range of m_SortedIds
+      std::vector<std::uint64_t> keys(numberOfPoints);
+      m_SortedIds.resize(numberOfPoints);
+      for (vtkIdType i = 0; i < numberOfPoints; ++i)
+      {
+        keys[i] = this->GetKey(&m_Coordinates[3 * i]);
+        m_SortedIds[i] = i;
+      }
+      std::sort(m_SortedIds.begin(), m_SortedIds.end(), [&keys](vtkIdType a, vtkIdType b) {
+        return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);
+      });
+
+      m_Cells.reserve(numberOfPoints);
+      for (vtkIdType i = 0; i < numberOfPoints;)
+      {
+        vtkIdType end = i + 1;
+        while (end < numberOfPoints && keys[m_SortedIds[end]] == keys[m_SortedIds[i]])
+          ++end;
+        m_Cells[keys[m_SortedIds[i]]] = std::make_pair(i, end);
+        i = end;
+      }
+    }
+
+    /** Calls visitor(id) for every point within eps of point id, including the point itself, until it returns false */
+    template <typename TVisitor>
+    void VisitNeighbours(vtkIdType id, TVisitor visitor) const
+    {
+      const double *p = &m_Coordinates[3 * id];
+      std::int64_t cell[3];
+      for (int i = 0; i < 3; ++i)
+        cell[i] = static_cast<std::int64_t>((p[i] - m_Origin[i]) / m_CellSize);
+
+      for (std::int64_t x = cell[0] - 1; x <= cell[0] + 1; ++x)
+      {
+        for (std::int64_t y = cell[1] - 1; y <= cell[1] + 1; ++y)
+        {
+          for (std::int64_t z = cell[2] - 1; z <= cell[2] + 1; ++z)
+          {
+            if (x < 0 || y < 0 || z < 0)
+              continue;
+
+            auto iter = m_Cells.find(MakeKey(x, y, z));
+            if (iter == m_Cells.end())
+              continue;
+
+            for (vtkIdType i = iter->second.first; i < iter->second.second; ++i)
+            {
+              const vtkIdType neighbour = m_SortedIds[i];
+              const double *q = &m_Coordinates[3 * neighbour];
+              const double dx = p[0] - q[0], dy = p[1] - q[1], dz = p[2] - q[2];
+              if (dx * dx + dy * dy + dz * dz <= m_Eps2 && !visitor(neighbour))
+                return;
+            }
+          }
+        }
+      }
+    }
+
+  private:
+    static std::uint64_t MakeKey(std::int64_t x, std::int64_t y, std::int64_t z)
+    {
+      return static_cast<std::uint64_t>(x) | (static_cast<std::uint64_t>(y) << 21) |
+             (static_cast<std::uint64_t>(z) << 42);
+    }
+
+    std::uint64_t GetKey(const double *p) const
+    {
+      return MakeKey(static_cast<std::int64_t>((p[0] - m_Origin[0]) / m_CellSize),
+                     static_cast<std::int64_t>((p[1] - m_Origin[1]) / m_CellSize),
+                     static_cast<std::int64_t>((p[2] - m_Origin[2]) / m_CellSize));
+    }
+
+    double m_Eps2;
+    double m_CellSize;
+    double m_Origin[3];
+    std::vector<double> m_Coordinates;
+    std::vector<vtkIdType> m_SortedIds;
+    std::unordered_map<std::uint64_t, std::pair<vtkIdType, vtkIdType>> m_Cells;
+  };
+
+  /** Union-find of the core points, safe for concurrent Union() calls. The root of a set is its lowest id. */
+  class ConcurrentUnionFind
+  {
+  public:
+    explicit ConcurrentUnionFind(vtkIdType size) : m_Parents(size)
+    {
+      for (vtkIdType i = 0; i < size; ++i)
+        m_Parents[i] = i;
+    }
+
+    vtkIdType Find(vtkIdType id) const
+    {
+      vtkIdType parent = m_Parents[id].load();
+      while (parent != id)
+      {
+        id = parent;
+        parent = m_Parents[id].load();
+      }
+      return id;
+    }
+
+    void Union(vtkIdType a, vtkIdType b)
+    {
+      for (;;)
+      {
+        a = this->Find(a);
+        b = this->Find(b);
+        if (a == b)
+          return;
+
+        // always link the higher root to the lower one, so no cycles can form
+        if (a < b)
+          std::swap(a, b);
+
+        vtkIdType expected = a;
+        if (m_Parents[a].compare_exchange_strong(expected, b))
+          return;
+      }
+    }
+
+  private:
+    std::vector<std::atomic<vtkIdType>> m_Parents;
+  };
+
+  void ParallelFor(vtkIdType size, const std::function<void(vtkIdType, vtkIdType)> &function)
+  {
+    mitk::TaskScheduler *scheduler = mitk::TaskScheduler::GetInstance();
+    const vtkIdType numberOfChunks =
+      std::max<vtkIdType>(1, std::min<vtkIdType>(size, 4 * scheduler->GetNumberOfThreads()));
+    const vtkIdType chunkSize = (size + numberOfChunks - 1) / numberOfChunks;
+
+    std::vector<mitk::TaskScheduler::TaskPointer> tasks;
+    for (vtkIdType begin = 0; begin < size; begin += chunkSize)
+    {
+      const vtkIdType end = std::min(size, begin + chunkSize);
+      tasks.push_back(scheduler->Submit([&function, begin, end]() { function(begin, end); }));
+    }
+
+    for (const auto &task : tasks)
+      task->Wait();
+  }
+}
+
 mitk::UnstructuredGridClusteringFilter::UnstructuredGridClusteringFilter()
   : m_eps(5.0), m_MinPts(4), m_Meshing(false), m_DistCalc(false)
 {
@@ -39,14 +213,6 @@ mitk::UnstructuredGridClusteringFilter::~UnstructuredGridClusteringFilter()
 {
 }
 
-std::map<int, bool> visited;
-std::map<int, bool> isNoise;
-std::map<int, bool> clusterMember;
-vtkSmartPointer<vtkPointLocator> pLocator;
-std::vector<vtkSmartPointer<vtkPoints>> clusterVector;
-
-std::vector<std::vector<int>> clustersPointsIDs;
-
 void mitk::UnstructuredGridClusteringFilter::GenerateOutputInformation()
 {
   m_UnstructGrid = this->GetOutput();
@@ -60,7 +226,8 @@ void mitk::UnstructuredGridClusteringFilter::GenerateData()
 
   vtkSmartPointer<vtkUnstructuredGrid> vtkInpGrid = inputGrid->GetVtkUnstructuredGrid();
   vtkSmartPointer<vtkPoints> inpPoints = vtkInpGrid->GetPoints();
-  pLocator = vtkSmartPointer<vtkPointLocator>::New();
+  if (inpPoints == nullptr)
+    return;
 
   vtkSmartPointer<vtkDoubleArray> distances = vtkSmartPointer<vtkDoubleArray>::New();
   if (inputGrid->GetVtkUnstructuredGrid()->GetPointData()->GetNumberOfArrays() > 0)
@@ -69,42 +236,97 @@ void mitk::UnstructuredGridClusteringFilter::GenerateData()
     distances = dynamic_cast<vtkDoubleArray *>(vtkInpGrid->GetPointData()->GetArray(0));
   }
 
-  pLocator->SetDataSet(vtkInpGrid);
-  pLocator->AutomaticOn();
-  pLocator->SetNumberOfPointsPerBucket(2);
-  pLocator->BuildLocator();
+  m_Clusters.clear();
+  m_DistanceArrays.clear();
 
-  // fill the visited map with false for checking
-  for (int i = 0; i < inpPoints->GetNumberOfPoints(); i++)
-  {
-    visited[i] = false;
-    isNoise[i] = false;
-    clusterMember[i] = false;
-  }
+  const vtkIdType numberOfPoints = inpPoints->GetNumberOfPoints();
+  const PointGrid grid(inpPoints, m_eps);
 
-  for (int i = 0; i < inpPoints->GetNumberOfPoints(); i++)
-  {
-    if (!visited[i])
+  // a point is a core point if it has at least MinPts neighbours, itself included
+  std::vector<char> isCore(numberOfPoints, 0);
+  ParallelFor(numberOfPoints, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType i = begin; i < end; ++i)
     {
-      visited[i] = true;                                                       // mark P as visited
-      vtkSmartPointer<vtkIdList> idList = vtkSmartPointer<vtkIdList>::New();   // represent N
-      pLocator->FindPointsWithinRadius(m_eps, inpPoints->GetPoint(i), idList); // N = D.regionQuery(P, eps)
-      if (idList->GetNumberOfIds() < m_MinPts)                                 // if sizeof(N) < MinPts
-      {
-        isNoise[i] = true; // mark P as NOISE
-      }
-      else
+      int numberOfNeighbours = 0;
+      grid.VisitNeighbours(i, [&](vtkIdType) { return ++numberOfNeighbours < m_MinPts; });
+      isCore[i] = numberOfNeighbours >= m_MinPts;
+    }
+  });
+
+  // core points within eps of each other belong to the same cluster
+  ConcurrentUnionFind coreSets(numberOfPoints);
+  ParallelFor(numberOfPoints, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      if (!isCore[i])
+        continue;
+
+      grid.VisitNeighbours(i, [&](vtkIdType neighbour) {
+        if (neighbour > i && isCore[neighbour])
+          coreSets.Union(i, neighbour);
+        return true;
+      });
+    }
+  });
+
+  // every point gets the root of its cluster, border points that of the first cluster reaching them, noise -1
+  std::vector<vtkIdType> roots(numberOfPoints, -1);
+  ParallelFor(numberOfPoints, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      if (isCore[i])
       {
-        vtkSmartPointer<vtkPoints> cluster = vtkSmartPointer<vtkPoints>::New(); // represent a cluster
-        clusterVector.push_back(cluster);                                       // C = next cluster
-        this->ExpandCluster(
-          i, idList, cluster, inpPoints); // expandCluster(P, N, C, eps, MinPts) mod. the parameter list
+        roots[i] = coreSets.Find(i);
+        continue;
       }
+
+      vtkIdType root = -1;
+      grid.VisitNeighbours(i, [&](vtkIdType neighbour) {
+        if (isCore[neighbour])
+        {
+          const vtkIdType neighbourRoot = coreSets.Find(neighbour);
+          if (root == -1 || neighbourRoot < root)
+            root = neighbourRoot;
+        }
+        return true;
+      });
+      roots[i] = root;
+    }
+  });
+
+  // the clusters are ordered by their lowest core point, as found by the sequential algorithm
+  std::vector<std::vector<int>> clustersPointsIDs;
+  std::vector<int> clusterOfRoot(numberOfPoints, -1);
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+  {
+    if (isCore[i] && roots[i] == i)
+    {
+      clusterOfRoot[i] = static_cast<int>(clustersPointsIDs.size());
+      clustersPointsIDs.push_back(std::vector<int>());
     }
   }
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+  {
+    if (roots[i] != -1)
+      clustersPointsIDs[clusterOfRoot[roots[i]]].push_back(static_cast<int>(i));
+  }
+
+  for (const auto &clusterPointIDs : clustersPointsIDs)
+  {
+    vtkSmartPointer<vtkPoints> cluster = vtkSmartPointer<vtkPoints>::New();
+    cluster->SetNumberOfPoints(static_cast<vtkIdType>(clusterPointIDs.size()));
+    for (std::size_t j = 0; j < clusterPointIDs.size(); ++j)
+      cluster->SetPoint(static_cast<vtkIdType>(j), inpPoints->GetPoint(clusterPointIDs[j]));
+    m_Clusters.push_back(cluster);
+  }
+
+  if (m_Clusters.empty())
+  {
+    m_UnstructGrid->SetVtkUnstructuredGrid(vtkSmartPointer<vtkUnstructuredGrid>::New());
+    return;
+  }
 
   // OUTPUT LOGIC
-  m_Clusters = clusterVector;
   int numberOfClusterPoints = 0;
   int IdOfBiggestCluster = 0;
 
@@ -174,55 +396,6 @@ void mitk::UnstructuredGridClusteringFilter::GenerateData()
     m_UnstructGrid->SetVtkUnstructuredGrid(biggestCluster);
   }
 
-  clusterVector.clear();
-  clustersPointsIDs.clear();
-}
-
-void mitk::UnstructuredGridClusteringFilter::ExpandCluster(int id,
-                                                           vtkIdList *pointIDs,
-                                                           vtkPoints *cluster,
-                                                           vtkPoints *inpPoints)
-{
-  std::vector<int> x;
-  x.push_back(id);
-  cluster->InsertNextPoint(inpPoints->GetPoint(id)); // add P to cluster C
-  clusterMember[id] = true;
-
-  vtkSmartPointer<vtkPoints> neighbours = vtkSmartPointer<vtkPoints>::New(); // same N as in other function
-  inpPoints->GetPoints(pointIDs, neighbours);
-
-  for (int i = 0; i < pointIDs->GetNumberOfIds(); i++) // for each point P' in N
-  {
-    if (!visited[pointIDs->GetId(i)]) // if P' is not visited
-    {
-      visited[pointIDs->GetId(i)] = true;                                    // mark P' as visited
-      vtkSmartPointer<vtkIdList> idList = vtkSmartPointer<vtkIdList>::New(); // represent N'
-      pLocator->FindPointsWithinRadius(
-        m_eps, inpPoints->GetPoint(pointIDs->GetId(i)), idList); // N' = D.regionQuery(P', eps)
-
-      if (idList->GetNumberOfIds() >= m_MinPts) // if sizeof(N') >= MinPts
-      {
-        for (int j = 0; j < idList->GetNumberOfIds(); j++) // N = N joined with N'
-        {
-          if (idList->GetId(j) < inpPoints->GetNumberOfPoints()) // a litte bit hacked ?!
-          {
-            pointIDs->InsertNextId(idList->GetId(j));
-          }
-        }
-      }
-    }
-    if (!clusterMember[pointIDs->GetId(i)]) // if P' is not yet member of any cluster
-    {
-      if (pointIDs->GetId(i) < inpPoints->GetNumberOfPoints())
-      {
-        clusterMember[pointIDs->GetId(i)] = true;
-        x.push_back(pointIDs->GetId(i));
-        cluster->InsertNextPoint(inpPoints->GetPoint(pointIDs->GetId(i))); // add P' to cluster C
-      }
-    }
-  }
-
-  clustersPointsIDs.push_back(x);
 }
 
 std::vector<mitk::UnstructuredGrid::Pointer> mitk::UnstructuredGridClusteringFilter::GetAllClusters()
@@ -3,6 +3,7 @@ set(MODULE_TESTS
   mitkBoundingObjectCutterTest.cpp
   mitkImageToUnstructuredGridFilterTest.cpp
   mitkPlaneFitTest.cpp
+  mitkPointLocatorTest.cpp
   mitkSimpleHistogramTest.cpp
   mitkCovarianceMatrixCalculatorTest.cpp
   mitkAnisotropicIterativeClosestPointRegistrationTest.cpp
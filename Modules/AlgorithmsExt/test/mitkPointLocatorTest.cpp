@@ -0,0 +1,189 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include <mitkPointLocator.h>
+#include <mitkPointSet.h>
+#include <mitkTestFixture.h>
+
+#include <vtkMath.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+#include <algorithm>
+#include <random>
+
+class mitkPointLocatorTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkPointLocatorTestSuite);
+  MITK_TEST(FindClosestPoint_VtkPoints_MatchesBruteForce);
+  MITK_TEST(FindClosestPoint_PointSet_ReturnsPointSetIds);
+  MITK_TEST(FindClosestPoints_Batch_MatchesSingleQueries);
+  MITK_TEST(FindKClosestPoints_Batch_MatchesBruteForce);
+  MITK_TEST(FindKClosestPoints_MoreThanNumberOfPoints_FillsMissingNeighbours);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  vtkSmartPointer<vtkPoints> m_Points;
+  vtkSmartPointer<vtkPolyData> m_PolyData;
+  vtkSmartPointer<vtkPoints> m_QueryPoints;
+
+  static vtkSmartPointer<vtkPoints> CreateRandomPoints(unsigned int numberOfPoints, unsigned int seed)
+  {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> distribution(-50.0, 50.0);
+
+    auto points = vtkSmartPointer<vtkPoints>::New();
+    for (unsigned int i = 0; i < numberOfPoints; ++i)
+      points->InsertNextPoint(distribution(generator), distribution(generator), distribution(generator));
+    return points;
+  }
+
+  std::vector<double> GetSortedSquaredDistances(const double queryPoint[3]) const
+  {
+    std::vector<double> distances;
+    for (vtkIdType i = 0; i < m_Points->GetNumberOfPoints(); ++i)
+      distances.push_back(vtkMath::Distance2BetweenPoints(queryPoint, m_Points->GetPoint(i)));
+    std::sort(distances.begin(), distances.end());
+    return distances;
+  }
+
+public:
+  void setUp() override
+  {
+    m_Points = CreateRandomPoints(2000, 1);
+    m_PolyData = vtkSmartPointer<vtkPolyData>::New();
+    m_PolyData->SetPoints(m_Points);
+    m_QueryPoints = CreateRandomPoints(200, 2);
+  }
+
+  void tearDown() override
+  {
+    m_Points = nullptr;
+    m_PolyData = nullptr;
+    m_QueryPoints = nullptr;
+  }
+
+  void FindClosestPoint_VtkPoints_MatchesBruteForce()
+  {
+    mitk::PointLocator::Pointer locator = mitk::PointLocator::New();
+    locator->SetPoints(m_PolyData);
+
+    for (vtkIdType i = 0; i < m_QueryPoints->GetNumberOfPoints(); ++i)
+    {
+      double queryPoint[3];
+      m_QueryPoints->GetPoint(i, queryPoint);
+
+      const mitk::PointLocator::IdType id = locator->FindClosestPoint(queryPoint);
+      CPPUNIT_ASSERT(id >= 0 && id < m_Points->GetNumberOfPoints());
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(GetSortedSquaredDistances(queryPoint).front(),
+                                   vtkMath::Distance2BetweenPoints(queryPoint, m_Points->GetPoint(id)),
+                                   mitk::eps);
+    }
+  }
+
+  void FindClosestPoint_PointSet_ReturnsPointSetIds()
+  {
+    mitk::PointSet::Pointer pointSet = mitk::PointSet::New();
+    for (int i = 0; i < 10; ++i)
+    {
+      mitk::Point3D point;
+      mitk::FillVector3D(point, i, 0, 0);
+      pointSet->InsertPoint(100 + i, point);
+    }
+
+    mitk::PointLocator::Pointer locator = mitk::PointLocator::New();
+    locator->SetPoints(pointSet);
+
+    mitk::Point3D queryPoint;
+    mitk::FillVector3D(queryPoint, 3.2, 1.0, 0.0);
+    CPPUNIT_ASSERT_EQUAL(103, locator->FindClosestPoint(queryPoint));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.04, locator->GetMinimalDistance(queryPoint), mitk::eps);
+  }
+
+  void FindClosestPoints_Batch_MatchesSingleQueries()
+  {
+    mitk::PointLocator::Pointer locator = mitk::PointLocator::New();
+    locator->SetPoints(m_PolyData);
+
+    mitk::PointLocator::IdVectorType ids;
+    mitk::PointLocator::DistanceVectorType distances;
+    locator->FindClosestPoints(m_QueryPoints, ids, distances);
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(m_QueryPoints->GetNumberOfPoints()), ids.size());
+    for (vtkIdType i = 0; i < m_QueryPoints->GetNumberOfPoints(); ++i)
+    {
+      double queryPoint[3];
+      m_QueryPoints->GetPoint(i, queryPoint);
+      CPPUNIT_ASSERT_EQUAL(locator->FindClosestPoint(queryPoint), ids[i]);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(GetSortedSquaredDistances(queryPoint).front(), distances[i], mitk::eps);
+    }
+  }
+
+  void FindKClosestPoints_Batch_MatchesBruteForce()
+  {
+    const unsigned int k = 6;
+
+    mitk::PointLocator::Pointer locator = mitk::PointLocator::New();
+    locator->SetPoints(m_PolyData);
+
+    mitk::PointLocator::IdVectorType ids;
+    mitk::PointLocator::DistanceVectorType distances;
+    locator->FindKClosestPoints(m_QueryPoints, k, ids, distances);
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(m_QueryPoints->GetNumberOfPoints() * k), distances.size());
+    for (vtkIdType i = 0; i < m_QueryPoints->GetNumberOfPoints(); ++i)
+    {
+      double queryPoint[3];
+      m_QueryPoints->GetPoint(i, queryPoint);
+      const std::vector<double> expected = GetSortedSquaredDistances(queryPoint);
+
+      for (unsigned int j = 0; j < k; ++j)
+      {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[j], distances[i * k + j], mitk::eps);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(
+          expected[j], vtkMath::Distance2BetweenPoints(queryPoint, m_Points->GetPoint(ids[i * k + j])), mitk::eps);
+      }
+    }
+  }
+
+  void FindKClosestPoints_MoreThanNumberOfPoints_FillsMissingNeighbours()
+  {
+    auto polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(CreateRandomPoints(3, 3));
+
+    mitk::PointLocator::Pointer locator = mitk::PointLocator::New();
+    locator->SetPoints(polyData);
+
+    mitk::PointLocator::IdVectorType ids;
+    mitk::PointLocator::DistanceVectorType distances;
+    locator->FindKClosestPoints(m_QueryPoints, 5, ids, distances);
+
+    for (vtkIdType i = 0; i < m_QueryPoints->GetNumberOfPoints(); ++i)
+    {
+      CPPUNIT_ASSERT(ids[i * 5 + 2] >= 0);
+      CPPUNIT_ASSERT_EQUAL(-1, ids[i * 5 + 3]);
+      CPPUNIT_ASSERT_EQUAL(-1, ids[i * 5 + 4]);
+    }
+
+    const double queryPoint[3] = {0.0, 0.0, 0.0};
+    locator->FindKClosestPoints(queryPoint, 5, ids, distances);
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(3), ids.size());
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkPointLocator)
@@ -20,6 +20,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "MitkAnnotationExports.h"
 #include "mitkAbstractAnnotationRenderer.h"
 
+#include <vector>
+
 namespace mitk
 {
   class BaseRenderer;
@@ -61,6 +63,7 @@ namespace mitk
 
     static LayoutAnnotationRenderer *GetAnnotationRenderer(const std::string &rendererID);
 
+    /** \brief Lays out the annotations again if the display size or the size or margin of an annotation changed */
     void OnRenderWindowModified() override;
 
     static void AddAnnotation(Annotation *annotation,
@@ -77,6 +80,7 @@ namespace mitk
                               double marginY = 5,
                               int priority = -1);
 
+    /** \brief Places all annotations according to their alignment, priority and margin */
     void PrepareLayout();
 
   private:
@@ -95,9 +99,13 @@ namespace mitk
 
     static double GetHeight(AnnotationRankedMap &annotations, BaseRenderer *renderer);
 
+    /** \brief Display size, followed by the size and margin of every annotation in layout order */
+    std::vector<double> GetLayoutInput();
+
     void OnAnnotationRenderersChanged() override;
     static const std::string ANNOTATIONRENDERER_ID;
     AnnotationLayouterContainerMap m_AnnotationContainerMap;
+    std::vector<double> m_LastLayoutInput;
     static void SetMargin2D(Annotation *annotation, const Point2D &OffsetVector);
     static Point2D GetMargin2D(Annotation *annotation);
   };
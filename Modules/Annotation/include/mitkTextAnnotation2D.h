@@ -48,6 +48,15 @@ namespace mitk
       /** \brief Timestamp of last update of stored data. */
       itk::TimeStamp m_LastUpdateTime;
 
+      /** \brief Size of m_TextActor on display, measured for m_SizeText, m_SizeTextPropertyTime and m_SizeDPI.
+       *
+       * Measuring lays out the text with the font renderer, so it is only repeated if one of these changed.
+       */
+      double m_Size[2];
+      std::string m_SizeText;
+      vtkMTimeType m_SizeTextPropertyTime;
+      int m_SizeDPI;
+
       /** \brief Default constructor of the local storage. */
       LocalStorage();
       /** \brief Default deconstructor of the local storage. */
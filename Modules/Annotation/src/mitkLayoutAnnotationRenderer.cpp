@@ -124,7 +124,36 @@ namespace mitk
     return result;
   }
 
-  void LayoutAnnotationRenderer::OnRenderWindowModified() { PrepareLayout(); }
+  void LayoutAnnotationRenderer::OnRenderWindowModified()
+  {
+    // the render window is modified far more often than the layout changes, e.g. on every interaction
+    if (!this->GetCurrentBaseRenderer() || this->GetLayoutInput() == m_LastLayoutInput)
+      return;
+    PrepareLayout();
+  }
+
+  std::vector<double> LayoutAnnotationRenderer::GetLayoutInput()
+  {
+    std::vector<double> input;
+    BaseRenderer *renderer = this->GetCurrentBaseRenderer();
+    const int *size = renderer->GetVtkRenderer()->GetSize();
+    input.push_back(size[0]);
+    input.push_back(size[1]);
+    for (auto alignmentIt = m_AnnotationContainerMap.cbegin(); alignmentIt != m_AnnotationContainerMap.cend();
+         ++alignmentIt)
+    {
+      for (auto it = alignmentIt->second.cbegin(); it != alignmentIt->second.cend(); ++it)
+      {
+        const Annotation::Bounds bounds = it->second->GetBoundsOnDisplay(renderer);
+        const Point2D margin = GetMargin2D(it->second);
+        input.push_back(bounds.Size[0]);
+        input.push_back(bounds.Size[1]);
+        input.push_back(margin[0]);
+        input.push_back(margin[1]);
+      }
+    }
+    return input;
+  }
   void LayoutAnnotationRenderer::AddAnnotation(Annotation *Annotation,
                                                const std::string &rendererID,
                                                Alignment alignment,
@@ -162,6 +191,7 @@ namespace mitk
     PrepareBottomRightLayout(size);
     PrepareLeftLayout(size);
     PrepareRightLayout(size);
+    m_LastLayoutInput = this->GetLayoutInput();
   }
   void LayoutAnnotationRenderer::PrepareTopLeftLayout(int *displaySize)
   {
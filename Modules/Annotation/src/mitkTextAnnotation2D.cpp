@@ -17,6 +17,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkTextAnnotation2D.h"
 #include "vtkUnicodeString.h"
 #include <vtkPropAssembly.h>
+#include <vtkRenderWindow.h>
 #include <vtkTextActor.h>
 #include <vtkTextProperty.h>
 
@@ -52,10 +53,17 @@ mitk::Annotation::Bounds mitk::TextAnnotation2D::GetBoundsOnDisplay(mitk::BaseRe
   mitk::Annotation::Bounds bounds;
   bounds.Position = ls->m_TextActor->GetPosition();
 
-  double size[2];
-  ls->m_TextActor->GetSize(renderer->GetVtkRenderer(), size);
-  bounds.Size[0] = size[0];
-  bounds.Size[1] = size[1];
+  const char *text = ls->m_TextActor->GetInput() != nullptr ? ls->m_TextActor->GetInput() : "";
+  const int dpi = renderer->GetRenderWindow()->GetDPI();
+  if (ls->m_SizeTextPropertyTime != ls->m_TextProp->GetMTime() || ls->m_SizeDPI != dpi || ls->m_SizeText != text)
+  {
+    ls->m_TextActor->GetSize(renderer->GetVtkRenderer(), ls->m_Size);
+    ls->m_SizeText = text;
+    ls->m_SizeTextPropertyTime = ls->m_TextProp->GetMTime();
+    ls->m_SizeDPI = dpi;
+  }
+  bounds.Size[0] = ls->m_Size[0];
+  bounds.Size[1] = ls->m_Size[1];
   return bounds;
 }
 
@@ -77,8 +85,9 @@ mitk::TextAnnotation2D::LocalStorage::~LocalStorage()
 {
 }
 
-mitk::TextAnnotation2D::LocalStorage::LocalStorage()
+mitk::TextAnnotation2D::LocalStorage::LocalStorage() : m_SizeTextPropertyTime(0), m_SizeDPI(0)
 {
+  m_Size[0] = m_Size[1] = 0;
   m_TextActor = vtkSmartPointer<vtkTextActor>::New();
   m_TextProp = vtkSmartPointer<vtkTextProperty>::New();
   m_STextActor = vtkSmartPointer<vtkTextActor>::New();
@@ -122,17 +131,20 @@ void mitk::TextAnnotation2D::UpdateVtkAnnotation2D(mitk::BaseRenderer *renderer)
 
     bool italicFont(false);
     GetBoolProperty("font.italic", italicFont);
-    ls->m_TextProp->SetBold(italicFont);
-    ls->m_STextProp->SetBold(italicFont);
+    ls->m_TextProp->SetItalic(italicFont);
+    ls->m_STextProp->SetItalic(italicFont);
 
-    bool drawShadow;
+    bool drawShadow(false);
     GetBoolProperty("drawShadow", drawShadow);
     ls->m_TextProp->SetShadow(false);
     ls->m_STextProp->SetShadow(false);
     ls->m_STextActor->SetVisibility(drawShadow);
 
-    ls->m_TextActor->SetInput(GetText().c_str());
-    ls->m_STextActor->SetInput(GetText().c_str());
+    // the actors keep their rendered text texture as long as the text and the font do not change, the setters
+    // above and SetInput() leave the actors untouched if called with the current values
+    const std::string text = GetText();
+    ls->m_TextActor->SetInput(text.c_str());
+    ls->m_STextActor->SetInput(text.c_str());
 
     mitk::Point2D posT, posS;
     posT[0] = GetPosition2D()[0] + GetOffsetVector()[0];
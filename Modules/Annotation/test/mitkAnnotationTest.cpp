@@ -23,11 +23,13 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkManualPlacementAnnotationRenderer.h"
 #include "mitkLayoutAnnotationRenderer.h"
+#include "mitkTextAnnotation2D.h"
 
 class mitkAnnotationTestSuite : public mitk::TestFixture
 {
   CPPUNIT_TEST_SUITE(mitkAnnotationTestSuite);
   MITK_TEST(AnnotationUtilsTest);
+  MITK_TEST(SetUnchangedProperty_AnnotationNotModified);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -54,6 +56,24 @@ public:
       (mitk::AbstractAnnotationRenderer *)ol1_test1 != (mitk::AbstractAnnotationRenderer *)ap1_test1);
   }
 
+  void SetUnchangedProperty_AnnotationNotModified()
+  {
+    mitk::TextAnnotation2D::Pointer annotation = mitk::TextAnnotation2D::New();
+    annotation->SetText("Text");
+    annotation->SetFontSize(12);
+    annotation->SetBoolProperty("font.bold", true);
+
+    const unsigned long time = annotation->GetMTime();
+    annotation->SetText("Text");
+    annotation->SetFontSize(12);
+    annotation->SetBoolProperty("font.bold", true);
+    CPPUNIT_ASSERT_MESSAGE("Testing if setting the current values leaves the annotation unmodified",
+                           annotation->GetMTime() == time);
+
+    annotation->SetText("Other text");
+    CPPUNIT_ASSERT_MESSAGE("Testing if setting a new text modifies the annotation", annotation->GetMTime() > time);
+  }
+
   void AnnotationTest() {}
 };
 MITK_TEST_SUITE_REGISTRATION(mitkAnnotation)
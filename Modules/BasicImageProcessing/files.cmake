@@ -1,6 +1,7 @@
 file(GLOB_RECURSE H_FILES RELATIVE "${CMAKE_CURRENT_SOURCE_DIR}" "${CMAKE_CURRENT_SOURCE_DIR}/include/*")
 
 set(CPP_FILES
+   mitkArithmeticExpression.cpp
    mitkArithmeticOperation.cpp
 )
 
@@ -0,0 +1,127 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkArithmeticExpression_h
+#define mitkArithmeticExpression_h
+
+#include <mitkImage.h>
+#include <MitkBasicImageProcessingExports.h>
+
+#include <memory>
+
+namespace mitk
+{
+  /** \brief Lazily evaluated voxel-wise expression of images and scalars
+  *
+  * Combining expressions with the usual operators only builds an expression tree, nothing is computed.
+  * Evaluate() computes the whole expression in one multi-threaded pass over the voxels into a single
+  * output image of the requested pixel type. Unlike chaining the functions of mitk::ArithmeticOperation,
+  * no intermediate images are allocated:
+  *
+  * \code
+  * mitk::ArithmeticExpression a(imageA), b(imageB);
+  * mitk::Image::Pointer ratio = ((a - b) / (a + b) * 100).Evaluate(mitk::MakeScalarPixelType<float>());
+  * \endcode
+  *
+  * All images of an expression must be scalar images with the same dimensions, the output gets the geometry
+  * of the first one. Any scalar pixel type is accepted as input. The computation uses double precision, the
+  * result is converted to the output pixel type per voxel, i.e. truncated for integer types.
+  */
+  class MITKBASICIMAGEPROCESSING_EXPORT ArithmeticExpression
+  {
+  public:
+    enum OperationsEnum
+    {
+      Constant,
+      Input,
+      Add,
+      Sub,
+      Mult,
+      Div,
+      Pow,
+      Neg,
+      Tan,
+      ATan,
+      Cos,
+      ACos,
+      Sin,
+      ASin,
+      Square,
+      Sqrt,
+      Abs,
+      Exp,
+      ExpNeg,
+      Log10
+    };
+
+    /** \brief The image is referenced, not copied, until the expression is destroyed */
+    explicit ArithmeticExpression(const Image *image);
+    ArithmeticExpression(double value);
+
+    /** \brief Computes the expression voxel by voxel, throws mitk::Exception if it contains no image */
+    Image::Pointer Evaluate(const PixelType &outputType = MakeScalarPixelType<double>()) const;
+
+    template <typename TPixel>
+    Image::Pointer Evaluate() const
+    {
+      return this->Evaluate(MakeScalarPixelType<TPixel>());
+    }
+
+    /** \brief Whether the expression contains no image, constant parts are folded while building */
+    bool IsConstant() const;
+
+    /** \brief The value of a constant expression */
+    double GetValue() const;
+
+    static ArithmeticExpression Unary(OperationsEnum operation, const ArithmeticExpression &operand);
+    static ArithmeticExpression Binary(OperationsEnum operation,
+                                       const ArithmeticExpression &left,
+                                       const ArithmeticExpression &right);
+
+    struct Node;
+
+  private:
+    explicit ArithmeticExpression(std::shared_ptr<const Node> node);
+
+    std::shared_ptr<const Node> m_Node;
+  };
+
+  MITKBASICIMAGEPROCESSING_EXPORT ArithmeticExpression operator+(const ArithmeticExpression &left,
+                                                                 const ArithmeticExpression &right);
+  MITKBASICIMAGEPROCESSING_EXPORT ArithmeticExpression operator-(const ArithmeticExpression &left,
+                                                                 const ArithmeticExpression &right);
+  MITKBASICIMAGEPROCESSING_EXPORT ArithmeticExpression operator*(const ArithmeticExpression &left,
+                                                                 const ArithmeticExpression &right);
+  MITKBASICIMAGEPROCESSING_EXPORT ArithmeticExpression operator/(const ArithmeticExpression &left,
+                                                                 const ArithmeticExpression &right);
+  MITKBASICIMAGEPROCESSING_EXPORT ArithmeticExpression operator-(const ArithmeticExpression &operand);
+
+  MITKBASICIMAGEPROCESSING_EXPORT ArithmeticExpression Pow(const ArithmeticExpression &base,
+                                                           const ArithmeticExpression &exponent);
+  MITKBASICIMAGEPROCESSING_EXPORT ArithmeticExpression Tan(const ArithmeticExpression &operand);
+  MITKBASICIMAGEPROCESSING_EXPORT ArithmeticExpression Atan(const ArithmeticExpression &operand);
+  MITKBASICIMAGEPROCESSING_EXPORT ArithmeticExpression Cos(const ArithmeticExpression &operand);
+  MITKBASICIMAGEPROCESSING_EXPORT ArithmeticExpression Acos(const ArithmeticExpression &operand);
+  MITKBASICIMAGEPROCESSING_EXPORT ArithmeticExpression Sin(const ArithmeticExpression &operand);
+  MITKBASICIMAGEPROCESSING_EXPORT ArithmeticExpression Asin(const ArithmeticExpression &operand);
+  MITKBASICIMAGEPROCESSING_EXPORT ArithmeticExpression Square(const ArithmeticExpression &operand);
+  MITKBASICIMAGEPROCESSING_EXPORT ArithmeticExpression Sqrt(const ArithmeticExpression &operand);
+  MITKBASICIMAGEPROCESSING_EXPORT ArithmeticExpression Abs(const ArithmeticExpression &operand);
+  MITKBASICIMAGEPROCESSING_EXPORT ArithmeticExpression Exp(const ArithmeticExpression &operand);
+  MITKBASICIMAGEPROCESSING_EXPORT ArithmeticExpression ExpNeg(const ArithmeticExpression &operand);
+  MITKBASICIMAGEPROCESSING_EXPORT ArithmeticExpression Log10(const ArithmeticExpression &operand);
+}
+#endif // mitkArithmeticExpression_h
@@ -26,6 +26,9 @@ namespace mitk
   *
   * All parameters of the arithmetic operations must be specified during construction.
   * The actual operation is executed when calling GetResult().
+  *
+  * Each call runs one filter and allocates a new image. For expressions of several operations, use
+  * mitk::ArithmeticExpression, which evaluates them in a single pass.
   */
   class MITKBASICIMAGEPROCESSING_EXPORT ArithmeticOperation {
   public:
@@ -0,0 +1,536 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkArithmeticExpression.h"
+
+#include <mitkExceptionMacro.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+#include <mitkTaskScheduler.h>
+
+#include <itkImageIOBase.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+struct mitk::ArithmeticExpression::Node
+{
+  OperationsEnum Operation = Constant;
+  double Value = 0.0;
+  Image::ConstPointer InputImage;
+  std::shared_ptr<const Node> Left;
+  std::shared_ptr<const Node> Right;
+};
+
+namespace
+{
+  typedef mitk::ArithmeticExpression::OperationsEnum OperationsEnum;
+
+  // Voxels evaluated at once, small enough for all intermediate values to stay in the cache
+  const std::size_t BlockSize = 1024;
+
+  struct AddFunctor { double operator()(double a, double b) const { return a + b; } };
+  struct SubFunctor { double operator()(double a, double b) const { return a - b; } };
+  struct MultFunctor { double operator()(double a, double b) const { return a * b; } };
+  struct DivFunctor { double operator()(double a, double b) const { return a / b; } };
+  struct PowFunctor { double operator()(double a, double b) const { return std::pow(a, b); } };
+
+  struct NegFunctor { double operator()(double a) const { return -a; } };
+  struct TanFunctor { double operator()(double a) const { return std::tan(a); } };
+  struct ATanFunctor { double operator()(double a) const { return std::atan(a); } };
+  struct CosFunctor { double operator()(double a) const { return std::cos(a); } };
+  struct ACosFunctor { double operator()(double a) const { return std::acos(a); } };
+  struct SinFunctor { double operator()(double a) const { return std::sin(a); } };
+  struct ASinFunctor { double operator()(double a) const { return std::asin(a); } };
+  struct SquareFunctor { double operator()(double a) const { return a * a; } };
+  struct SqrtFunctor { double operator()(double a) const { return std::sqrt(a); } };
+  struct AbsFunctor { double operator()(double a) const { return std::abs(a); } };
+  struct ExpFunctor { double operator()(double a) const { return std::exp(a); } };
+  struct ExpNegFunctor { double operator()(double a) const { return std::exp(-a); } };
+  struct Log10Functor { double operator()(double a) const { return std::log10(a); } };
+
+  /** An operand of the evaluation, either a block of values or a scalar which Data is nullptr */
+  struct Operand
+  {
+    const double *Data;
+    double Value;
+  };
+
+  template <typename TFunctor>
+  Operand ApplyUnary(TFunctor functor, const Operand &a, double *out, std::size_t n)
+  {
+    if (a.Data == nullptr)
+      return Operand{nullptr, functor(a.Value)};
+
+    // plain loops over contiguous blocks, which the compiler vectorizes
+    for (std::size_t i = 0; i < n; ++i)
+      out[i] = functor(a.Data[i]);
+    return Operand{out, 0.0};
+  }
+
+  template <typename TFunctor>
+  Operand ApplyBinary(TFunctor functor, const Operand &a, const Operand &b, double *out, std::size_t n)
+  {
+    if (a.Data == nullptr && b.Data == nullptr)
+      return Operand{nullptr, functor(a.Value, b.Value)};
+
+    if (a.Data == nullptr)
+    {
+      const double value = a.Value;
+      for (std::size_t i = 0; i < n; ++i)
+        out[i] = functor(value, b.Data[i]);
+    }
+    else if (b.Data == nullptr)
+    {
+      const double value = b.Value;
+      for (std::size_t i = 0; i < n; ++i)
+        out[i] = functor(a.Data[i], value);
+    }
+    else
+    {
+      for (std::size_t i = 0; i < n; ++i)
+        out[i] = functor(a.Data[i], b.Data[i]);
+    }
+    return Operand{out, 0.0};
+  }
+
+  Operand Apply(OperationsEnum operation, const Operand &a, const Operand &b, double *out, std::size_t n)
+  {
+    switch (operation)
+    {
+      case mitk::ArithmeticExpression::Add: return ApplyBinary(AddFunctor(), a, b, out, n);
+      case mitk::ArithmeticExpression::Sub: return ApplyBinary(SubFunctor(), a, b, out, n);
+      case mitk::ArithmeticExpression::Mult: return ApplyBinary(MultFunctor(), a, b, out, n);
+      case mitk::ArithmeticExpression::Div: return ApplyBinary(DivFunctor(), a, b, out, n);
+      case mitk::ArithmeticExpression::Pow: return ApplyBinary(PowFunctor(), a, b, out, n);
+      case mitk::ArithmeticExpression::Neg: return ApplyUnary(NegFunctor(), a, out, n);
+      case mitk::ArithmeticExpression::Tan: return ApplyUnary(TanFunctor(), a, out, n);
+      case mitk::ArithmeticExpression::ATan: return ApplyUnary(ATanFunctor(), a, out, n);
+      case mitk::ArithmeticExpression::Cos: return ApplyUnary(CosFunctor(), a, out, n);
+      case mitk::ArithmeticExpression::ACos: return ApplyUnary(ACosFunctor(), a, out, n);
+      case mitk::ArithmeticExpression::Sin: return ApplyUnary(SinFunctor(), a, out, n);
+      case mitk::ArithmeticExpression::ASin: return ApplyUnary(ASinFunctor(), a, out, n);
+      case mitk::ArithmeticExpression::Square: return ApplyUnary(SquareFunctor(), a, out, n);
+      case mitk::ArithmeticExpression::Sqrt: return ApplyUnary(SqrtFunctor(), a, out, n);
+      case mitk::ArithmeticExpression::Abs: return ApplyUnary(AbsFunctor(), a, out, n);
+      case mitk::ArithmeticExpression::Exp: return ApplyUnary(ExpFunctor(), a, out, n);
+      case mitk::ArithmeticExpression::ExpNeg: return ApplyUnary(ExpNegFunctor(), a, out, n);
+      case mitk::ArithmeticExpression::Log10: return ApplyUnary(Log10Functor(), a, out, n);
+      default:
+        mitkThrow() << "Operation " << operation << " is not supported by mitk::ArithmeticExpression";
+    }
+  }
+
+  bool IsUnary(OperationsEnum operation)
+  {
+    return operation >= mitk::ArithmeticExpression::Neg;
+  }
+
+  typedef void (*LoadFunction)(const void *data, std::size_t offset, std::size_t n, double *out);
+  typedef void (*StoreFunction)(const double *values, std::size_t n, void *data, std::size_t offset);
+
+  template <typename TPixel>
+  void Load(const void *data, std::size_t offset, std::size_t n, double *out)
+  {
+    const TPixel *pixels = static_cast<const TPixel *>(data) + offset;
+    for (std::size_t i = 0; i < n; ++i)
+      out[i] = static_cast<double>(pixels[i]);
+  }
+
+  template <typename TPixel>
+  void Store(const double *values, std::size_t n, void *data, std::size_t offset)
+  {
+    TPixel *pixels = static_cast<TPixel *>(data) + offset;
+    for (std::size_t i = 0; i < n; ++i)
+      pixels[i] = static_cast<TPixel>(values[i]);
+  }
+
+  template <template <typename> class TSelector, typename TFunction>
+  TFunction SelectByComponentType(const mitk::PixelType &pixelType)
+  {
+    if (pixelType.GetNumberOfComponents() != 1)
+    {
+      mitkThrow() << "mitk::ArithmeticExpression supports scalar images only, not " << pixelType.GetPixelTypeAsString()
+                  << " pixels";
+    }
+
+    switch (pixelType.GetComponentType())
+    {
+      case itk::ImageIOBase::UCHAR: return TSelector<unsigned char>::Get();
+      case itk::ImageIOBase::CHAR: return TSelector<char>::Get();
+      case itk::ImageIOBase::USHORT: return TSelector<unsigned short>::Get();
+      case itk::ImageIOBase::SHORT: return TSelector<short>::Get();
+      case itk::ImageIOBase::UINT: return TSelector<unsigned int>::Get();
+      case itk::ImageIOBase::INT: return TSelector<int>::Get();
+      case itk::ImageIOBase::ULONG: return TSelector<unsigned long>::Get();
+      case itk::ImageIOBase::LONG: return TSelector<long>::Get();
+      case itk::ImageIOBase::FLOAT: return TSelector<float>::Get();
+      case itk::ImageIOBase::DOUBLE: return TSelector<double>::Get();
+      default:
+        mitkThrow() << "Pixel type " << pixelType.GetComponentTypeAsString()
+                    << " is not supported by mitk::ArithmeticExpression";
+    }
+  }
+
+  template <typename TPixel>
+  struct LoadSelector
+  {
+    static LoadFunction Get() { return &Load<TPixel>; }
+  };
+
+  template <typename TPixel>
+  struct StoreSelector
+  {
+    static StoreFunction Get() { return &Store<TPixel>; }
+  };
+
+  struct Instruction
+  {
+    OperationsEnum Operation;
+    double Value;
+    std::size_t Input;
+  };
+
+  /** The expression tree in postfix order, evaluated with a stack of blocks */
+  struct Program
+  {
+    std::vector<Instruction> Instructions;
+    std::vector<const mitk::Image *> Inputs;
+    std::vector<const void *> InputData;
+    std::vector<LoadFunction> InputLoaders;
+    std::size_t StackSize = 0;
+
+    void Compile(const mitk::ArithmeticExpression::Node *node, std::size_t depth)
+    {
+      StackSize = std::max(StackSize, depth + 1);
+
+      Instruction instruction = {node->Operation, node->Value, 0};
+      if (node->Operation == mitk::ArithmeticExpression::Input)
+      {
+        // an image used several times is converted once per block
+        auto iter = std::find(Inputs.begin(), Inputs.end(), node->InputImage.GetPointer());
+        instruction.Input = static_cast<std::size_t>(iter - Inputs.begin());
+        if (iter == Inputs.end())
+          Inputs.push_back(node->InputImage.GetPointer());
+      }
+      else if (node->Operation != mitk::ArithmeticExpression::Constant)
+      {
+        this->Compile(node->Left.get(), depth);
+        if (!IsUnary(node->Operation))
+          this->Compile(node->Right.get(), depth + 1);
+      }
+      Instructions.push_back(instruction);
+    }
+
+    void Run(std::size_t begin, std::size_t end, void *output, StoreFunction store) const
+    {
+      std::vector<double> inputBlocks(Inputs.size() * BlockSize);
+      std::vector<double> stackBlocks(StackSize * BlockSize);
+      std::vector<Operand> stack;
+      stack.reserve(StackSize);
+
+      for (std::size_t offset = begin; offset < end; offset += BlockSize)
+      {
+        const std::size_t n = std::min(BlockSize, end - offset);
+
+        for (std::size_t i = 0; i < Inputs.size(); ++i)
+          InputLoaders[i](InputData[i], offset, n, &inputBlocks[i * BlockSize]);
+
+        stack.clear();
+        for (const auto &instruction : Instructions)
+        {
+          if (instruction.Operation == mitk::ArithmeticExpression::Constant)
+          {
+            stack.push_back(Operand{nullptr, instruction.Value});
+          }
+          else if (instruction.Operation == mitk::ArithmeticExpression::Input)
+          {
+            stack.push_back(Operand{&inputBlocks[instruction.Input * BlockSize], 0.0});
+          }
+          else
+          {
+            Operand right = Operand{nullptr, 0.0};
+            if (!IsUnary(instruction.Operation))
+            {
+              right = stack.back();
+              stack.pop_back();
+            }
+
+            // results overwrite the block of their left operand's stack slot, which is safe per voxel
+            double *out = &stackBlocks[(stack.size() - 1) * BlockSize];
+            stack.back() = Apply(instruction.Operation, stack.back(), right, out, n);
+          }
+        }
+
+        const Operand &result = stack.back();
+        if (result.Data != nullptr)
+        {
+          store(result.Data, n, output, offset);
+        }
+        else
+        {
+          double *out = &stackBlocks[0];
+          std::fill(out, out + n, result.Value);
+          store(out, n, output, offset);
+        }
+      }
+    }
+  };
+
+  std::shared_ptr<const mitk::ArithmeticExpression::Node> MakeConstant(double value)
+  {
+    auto node = std::make_shared<mitk::ArithmeticExpression::Node>();
+    node->Operation = mitk::ArithmeticExpression::Constant;
+    node->Value = value;
+    return node;
+  }
+}
+
+mitk::ArithmeticExpression::ArithmeticExpression(const Image *image)
+{
+  if (image == nullptr)
+  {
+    mitkThrow() << "mitk::ArithmeticExpression needs a valid image";
+  }
+
+  auto node = std::make_shared<Node>();
+  node->Operation = Input;
+  node->InputImage = image;
+  m_Node = node;
+}
+
+mitk::ArithmeticExpression::ArithmeticExpression(double value) : m_Node(MakeConstant(value))
+{
+}
+
+mitk::ArithmeticExpression::ArithmeticExpression(std::shared_ptr<const Node> node) : m_Node(node)
+{
+}
+
+bool mitk::ArithmeticExpression::IsConstant() const
+{
+  return m_Node->Operation == Constant;
+}
+
+double mitk::ArithmeticExpression::GetValue() const
+{
+  if (!this->IsConstant())
+  {
+    mitkThrow() << "The expression depends on images and has no single value";
+  }
+  return m_Node->Value;
+}
+
+mitk::ArithmeticExpression mitk::ArithmeticExpression::Unary(OperationsEnum operation,
+                                                             const ArithmeticExpression &operand)
+{
+  if (!IsUnary(operation))
+  {
+    mitkThrow() << "Operation " << operation << " is not a unary operation";
+  }
+
+  if (operand.IsConstant())
+  {
+    const Operand value = Apply(operation, Operand{nullptr, operand.m_Node->Value}, Operand{nullptr, 0.0}, nullptr, 0);
+    return ArithmeticExpression(value.Value);
+  }
+
+  auto node = std::make_shared<Node>();
+  node->Operation = operation;
+  node->Left = operand.m_Node;
+  return ArithmeticExpression(std::shared_ptr<const Node>(node));
+}
+
+mitk::ArithmeticExpression mitk::ArithmeticExpression::Binary(OperationsEnum operation,
+                                                              const ArithmeticExpression &left,
+                                                              const ArithmeticExpression &right)
+{
+  if (operation < Add || IsUnary(operation))
+  {
+    mitkThrow() << "Operation " << operation << " is not a binary operation";
+  }
+
+  if (left.IsConstant() && right.IsConstant())
+  {
+    const Operand value =
+      Apply(operation, Operand{nullptr, left.m_Node->Value}, Operand{nullptr, right.m_Node->Value}, nullptr, 0);
+    return ArithmeticExpression(value.Value);
+  }
+
+  auto node = std::make_shared<Node>();
+  node->Operation = operation;
+  node->Left = left.m_Node;
+  node->Right = right.m_Node;
+  return ArithmeticExpression(std::shared_ptr<const Node>(node));
+}
+
+mitk::Image::Pointer mitk::ArithmeticExpression::Evaluate(const PixelType &outputType) const
+{
+  Program program;
+  program.Compile(m_Node.get(), 0);
+
+  if (program.Inputs.empty())
+  {
+    mitkThrow() << "The expression contains no image, its value is " << m_Node->Value;
+  }
+
+  const Image *reference = program.Inputs.front();
+  for (const auto *input : program.Inputs)
+  {
+    bool sameSize = input->GetDimension() == reference->GetDimension();
+    for (unsigned int i = 0; sameSize && i < reference->GetDimension(); ++i)
+      sameSize = input->GetDimension(i) == reference->GetDimension(i);
+
+    if (!sameSize)
+    {
+      mitkThrow() << "Images have different sizes. This is not supported by mitk::ArithmeticExpression";
+    }
+  }
+
+  // the accessors lock the inputs against writers until the evaluation finished
+  std::vector<std::unique_ptr<ImageReadAccessor>> readAccessors;
+  for (const auto *input : program.Inputs)
+  {
+    readAccessors.emplace_back(new ImageReadAccessor(input));
+    program.InputData.push_back(readAccessors.back()->GetData());
+    program.InputLoaders.push_back(SelectByComponentType<LoadSelector, LoadFunction>(input->GetPixelType()));
+  }
+  const StoreFunction store = SelectByComponentType<StoreSelector, StoreFunction>(outputType);
+
+  Image::Pointer result = Image::New();
+  result->Initialize(outputType, reference->GetDimension(), reference->GetDimensions());
+  result->SetTimeGeometry(reference->GetTimeGeometry()->Clone());
+
+  std::size_t numberOfVoxels = 1;
+  for (unsigned int i = 0; i < reference->GetDimension(); ++i)
+    numberOfVoxels *= reference->GetDimension(i);
+
+  if (numberOfVoxels == 0)
+    return result;
+
+  ImageWriteAccessor writeAccessor(result);
+  void *output = writeAccessor.GetData();
+
+  // chunks of whole blocks, a few per thread so that busy threads do not delay the result
+  TaskScheduler *scheduler = TaskScheduler::GetInstance();
+  const std::size_t numberOfBlocks = (numberOfVoxels + BlockSize - 1) / BlockSize;
+  const std::size_t numberOfChunks = std::min<std::size_t>(numberOfBlocks, 4 * scheduler->GetNumberOfThreads());
+  const std::size_t blocksPerChunk = (numberOfBlocks + numberOfChunks - 1) / numberOfChunks;
+
+  std::vector<TaskScheduler::TaskPointer> tasks;
+  for (std::size_t begin = 0; begin < numberOfVoxels; begin += blocksPerChunk * BlockSize)
+  {
+    const std::size_t end = std::min(numberOfVoxels, begin + blocksPerChunk * BlockSize);
+    tasks.push_back(scheduler->Submit([&program, begin, end, output, store]() {
+      program.Run(begin, end, output, store);
+    }));
+  }
+  for (const auto &task : tasks)
+    task->Wait();
+
+  return result;
+}
+
+mitk::ArithmeticExpression mitk::operator+(const ArithmeticExpression &left, const ArithmeticExpression &right)
+{
+  return ArithmeticExpression::Binary(ArithmeticExpression::Add, left, right);
+}
+
+mitk::ArithmeticExpression mitk::operator-(const ArithmeticExpression &left, const ArithmeticExpression &right)
+{
+  return ArithmeticExpression::Binary(ArithmeticExpression::Sub, left, right);
+}
+
+mitk::ArithmeticExpression mitk::operator*(const ArithmeticExpression &left, const ArithmeticExpression &right)
+{
+  return ArithmeticExpression::Binary(ArithmeticExpression::Mult, left, right);
+}
+
+mitk::ArithmeticExpression mitk::operator/(const ArithmeticExpression &left, const ArithmeticExpression &right)
+{
+  return ArithmeticExpression::Binary(ArithmeticExpression::Div, left, right);
+}
+
+mitk::ArithmeticExpression mitk::operator-(const ArithmeticExpression &operand)
+{
+  return ArithmeticExpression::Unary(ArithmeticExpression::Neg, operand);
+}
+
+mitk::ArithmeticExpression mitk::Pow(const ArithmeticExpression &base, const ArithmeticExpression &exponent)
+{
+  return ArithmeticExpression::Binary(ArithmeticExpression::Pow, base, exponent);
+}
+
+mitk::ArithmeticExpression mitk::Tan(const ArithmeticExpression &operand)
+{
+  return ArithmeticExpression::Unary(ArithmeticExpression::Tan, operand);
+}
+
+mitk::ArithmeticExpression mitk::Atan(const ArithmeticExpression &operand)
+{
+  return ArithmeticExpression::Unary(ArithmeticExpression::ATan, operand);
+}
+
+mitk::ArithmeticExpression mitk::Cos(const ArithmeticExpression &operand)
+{
+  return ArithmeticExpression::Unary(ArithmeticExpression::Cos, operand);
+}
+
+mitk::ArithmeticExpression mitk::Acos(const ArithmeticExpression &operand)
+{
+  return ArithmeticExpression::Unary(ArithmeticExpression::ACos, operand);
+}
+
+mitk::ArithmeticExpression mitk::Sin(const ArithmeticExpression &operand)
+{
+  return ArithmeticExpression::Unary(ArithmeticExpression::Sin, operand);
+}
+
+mitk::ArithmeticExpression mitk::Asin(const ArithmeticExpression &operand)
+{
+  return ArithmeticExpression::Unary(ArithmeticExpression::ASin, operand);
+}
+
+mitk::ArithmeticExpression mitk::Square(const ArithmeticExpression &operand)
+{
+  return ArithmeticExpression::Unary(ArithmeticExpression::Square, operand);
+}
+
+mitk::ArithmeticExpression mitk::Sqrt(const ArithmeticExpression &operand)
+{
+  return ArithmeticExpression::Unary(ArithmeticExpression::Sqrt, operand);
+}
+
+mitk::ArithmeticExpression mitk::Abs(const ArithmeticExpression &operand)
+{
+  return ArithmeticExpression::Unary(ArithmeticExpression::Abs, operand);
+}
+
+mitk::ArithmeticExpression mitk::Exp(const ArithmeticExpression &operand)
+{
+  return ArithmeticExpression::Unary(ArithmeticExpression::Exp, operand);
+}
+
+mitk::ArithmeticExpression mitk::ExpNeg(const ArithmeticExpression &operand)
+{
+  return ArithmeticExpression::Unary(ArithmeticExpression::ExpNeg, operand);
+}
+
+mitk::ArithmeticExpression mitk::Log10(const ArithmeticExpression &operand)
+{
+  return ArithmeticExpression::Unary(ArithmeticExpression::Log10, operand);
+}
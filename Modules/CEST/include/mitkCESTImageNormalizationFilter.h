@@ -36,6 +36,9 @@ namespace mitk
    * The M0 images themselves will be transferred to the result without any processing.
    *
    * The output image will have the same geometry as the input image and a double pixel type.
+   *
+   * The normalization is done in one multi-threaded pass over blocks of voxels using the mitk::TaskScheduler.
+   * An exception is thrown if the image contains no M0 image.
    */
   class MITKCEST_EXPORT CESTImageNormalizationFilter : public ImageToImageFilter
   {
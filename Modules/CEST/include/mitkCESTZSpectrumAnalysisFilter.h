@@ -0,0 +1,91 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef __mitkCESTZSpectrumAnalysisFilter_h
+#define __mitkCESTZSpectrumAnalysisFilter_h
+
+#include <MitkCESTExports.h>
+
+// MITK
+#include "mitkImageToImageFilter.h"
+
+namespace mitk
+{
+  /** \brief Voxel-wise analysis of normalized CEST Z-spectra.
+   *
+   * The input has to be a normalized 4D CEST image, e.g. the output of mitk::CESTImageNormalizationFilter, with the
+   * property mitk::CustomTagParser::m_OffsetsPropertyName holding one offset (in ppm) per timestep. Timesteps with an
+   * offset greater than 299 or less than -299 (M0 images) are ignored.
+   *
+   * For every voxel the direct water saturation is fitted with a Lorentzian
+   * \f[ Z(\Delta) = 1 - A \frac{\Gamma^2/4}{(\Delta - \delta)^2 + \Gamma^2/4} \f]
+   * by a Levenberg-Marquardt least squares fit, initialized from the minimum of the spectrum. Only offsets with
+   * \f$|\Delta| \leq\f$ FitRange are used for the fit, a FitRange of 0 uses all offsets.
+   * The asymmetry \f$ MTR_{asym} = Z(\delta - \Delta_{asym}) - Z(\delta + \Delta_{asym}) \f$ is computed by linear
+   * interpolation of the measured spectrum at the AsymmetryOffset. Without B0 correction \f$\delta\f$ is 0.
+   *
+   * The filter has four 3D outputs of pixel type double with the geometry of the first timestep of the input:
+   * the asymmetry map (output 0), the B0 shift \f$\delta\f$ in ppm (output 1), the amplitude \f$A\f$ (output 2) and
+   * the full width at half maximum \f$\Gamma\f$ in ppm (output 3). Voxels whose fit fails keep a shift of 0 and an
+   * amplitude and width of 0.
+   *
+   * The voxels are processed in blocks in parallel using the mitk::TaskScheduler. Each block is transposed into one
+   * contiguous spectrum per voxel first, so the fit only works on contiguous memory.
+   */
+  class MITKCEST_EXPORT CESTZSpectrumAnalysisFilter : public ImageToImageFilter
+  {
+  public:
+    mitkClassMacro(CESTZSpectrumAnalysisFilter, ImageToImageFilter);
+    itkFactorylessNewMacro(Self) itkCloneMacro(Self)
+
+    /** Offset in ppm at which the asymmetry is computed, defaults to 3.5 (amide protons) */
+    itkSetMacro(AsymmetryOffset, double);
+    itkGetConstMacro(AsymmetryOffset, double);
+
+    /** Whether the asymmetry is computed relative to the fitted water resonance, defaults to true */
+    itkSetMacro(UseB0Correction, bool);
+    itkGetConstMacro(UseB0Correction, bool);
+    itkBooleanMacro(UseB0Correction);
+
+    /** Largest absolute offset in ppm used for the Lorentzian fit, 0 (default) uses all offsets */
+    itkSetMacro(FitRange, double);
+    itkGetConstMacro(FitRange, double);
+
+    itkSetMacro(MaximumNumberOfIterations, unsigned int);
+    itkGetConstMacro(MaximumNumberOfIterations, unsigned int);
+
+    Image *GetAsymmetryOutput() { return this->GetOutput(0); }
+    Image *GetB0ShiftOutput() { return this->GetOutput(1); }
+    Image *GetAmplitudeOutput() { return this->GetOutput(2); }
+    Image *GetWidthOutput() { return this->GetOutput(3); }
+
+  protected:
+    CESTZSpectrumAnalysisFilter();
+    ~CESTZSpectrumAnalysisFilter() override;
+
+    void GenerateOutputInformation() override;
+    void GenerateData() override;
+
+    template <typename TPixel, unsigned int VImageDimension>
+    void AnalyzeSpectra(const itk::Image<TPixel, VImageDimension> *image);
+
+    double m_AsymmetryOffset;
+    bool m_UseB0Correction;
+    double m_FitRange;
+    unsigned int m_MaximumNumberOfIterations;
+  };
+} // END mitk namespace
+#endif
@@ -21,9 +21,34 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkImageAccessByItk.h>
 #include <mitkImageCast.h>
 #include <mitkLocaleSwitch.h>
+#include <mitkTaskScheduler.h>
 
 #include <boost/algorithm/string.hpp>
 
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+  void ParallelFor(std::size_t size, const std::function<void(std::size_t, std::size_t)> &function)
+  {
+    mitk::TaskScheduler *scheduler = mitk::TaskScheduler::GetInstance();
+    const std::size_t numberOfChunks =
+      std::max<std::size_t>(1, std::min<std::size_t>(size, 4 * scheduler->GetNumberOfThreads()));
+    const std::size_t chunkSize = (size + numberOfChunks - 1) / numberOfChunks;
+
+    std::vector<mitk::TaskScheduler::TaskPointer> tasks;
+    for (std::size_t begin = 0; begin < size; begin += chunkSize)
+    {
+      const std::size_t end = std::min(size, begin + chunkSize);
+      tasks.push_back(scheduler->Submit([&function, begin, end]() { function(begin, end); }));
+    }
+
+    for (const auto &task : tasks)
+      task->Wait();
+  }
+}
+
 mitk::CESTImageNormalizationFilter::CESTImageNormalizationFilter()
 {
 }
@@ -97,25 +122,22 @@ void mitk::CESTImageNormalizationFilter::NormalizeTimeSteps(const itk::Image<TPi
   }
 
 
+  if (mZeroIndices.empty())
+  {
+    mitkThrow() << "mitk::CESTImageNormalizationFilter: the image contains no M0 image.";
+  }
+
   auto resultImage = OutputImageType::New();
   typename ImageType::RegionType targetEntireRegion = image->GetLargestPossibleRegion();
   targetEntireRegion.SetSize(3, m_NonM0Indices.size());
   resultImage->SetRegions(targetEntireRegion);
   resultImage->Allocate();
-  resultImage->FillBuffer(0);
-
-  unsigned int numberOfTimesteps = image->GetLargestPossibleRegion().GetSize(3);
-
-  typename ImageType::RegionType lowerMZeroRegion = image->GetLargestPossibleRegion();
-  lowerMZeroRegion.SetSize(3, 1);
-  typename ImageType::RegionType upperMZeroRegion = image->GetLargestPossibleRegion();
-  upperMZeroRegion.SetSize(3, 1);
-  typename ImageType::RegionType sourceRegion = image->GetLargestPossibleRegion();
-  sourceRegion.SetSize(3, 1);
-  typename OutputImageType::RegionType targetRegion = resultImage->GetLargestPossibleRegion();
-  targetRegion.SetSize(3, 1);
-  unsigned int targetTimestep = 0;
-  for (unsigned int sourceTimestep = 0; sourceTimestep < numberOfTimesteps; ++sourceTimestep)
+
+  // the M0 images and the weight of the lower one for every target timestep
+  std::vector<unsigned int> lowerMZeroIndices;
+  std::vector<unsigned int> upperMZeroIndices;
+  std::vector<double> weights;
+  for (const unsigned int sourceTimestep : m_NonM0Indices)
   {
     unsigned int lowerMZeroIndex = mZeroIndices[0];
     unsigned int upperMZeroIndex = mZeroIndices[0];
@@ -131,7 +153,6 @@ void mitk::CESTImageNormalizationFilter::NormalizeTimeSteps(const itk::Image<TPi
         break;
       }
     }
-    bool isMZero = (lowerMZeroIndex == sourceTimestep);
 
     double weight = 0.0;
     if (lowerMZeroIndex == upperMZeroIndex)
@@ -143,43 +164,34 @@ void mitk::CESTImageNormalizationFilter::NormalizeTimeSteps(const itk::Image<TPi
       weight = 1.0 - double(sourceTimestep - lowerMZeroIndex) / double(upperMZeroIndex - lowerMZeroIndex);
     }
 
+    lowerMZeroIndices.push_back(lowerMZeroIndex);
+    upperMZeroIndices.push_back(upperMZeroIndex);
+    weights.push_back(weight);
+  }
 
-    if (isMZero)
-    {
-      //do nothing
-    }
-    else
-    {
-      lowerMZeroRegion.SetIndex(3, lowerMZeroIndex);
-      upperMZeroRegion.SetIndex(3, upperMZeroIndex);
-      sourceRegion.SetIndex(3, sourceTimestep);
-      targetRegion.SetIndex(3, targetTimestep);
+  // Every timestep is a contiguous volume. The voxels are split into blocks, which are normalized for all
+  // timesteps at once in parallel, so each M0 volume is read once per block while it is in the cache.
+  const typename ImageType::SizeType &size = image->GetLargestPossibleRegion().GetSize();
+  const std::size_t numberOfVoxels = size[0] * size[1] * size[2];
+  const TPixel *sourceBuffer = image->GetBufferPointer();
+  double *targetBuffer = resultImage->GetBufferPointer();
 
-      itk::ImageRegionConstIterator<ImageType> lowerMZeroIterator(image, lowerMZeroRegion);
-      itk::ImageRegionConstIterator<ImageType> upperMZeroIterator(image, upperMZeroRegion);
-      itk::ImageRegionConstIterator<ImageType> sourceIterator(image, sourceRegion);
-      itk::ImageRegionIterator<OutputImageType> targetIterator(resultImage.GetPointer(), targetRegion);
+  ParallelFor(numberOfVoxels, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t targetTimestep = 0; targetTimestep < m_NonM0Indices.size(); ++targetTimestep)
+    {
+      const TPixel *source = sourceBuffer + m_NonM0Indices[targetTimestep] * numberOfVoxels;
+      const TPixel *lowerMZero = sourceBuffer + lowerMZeroIndices[targetTimestep] * numberOfVoxels;
+      const TPixel *upperMZero = sourceBuffer + upperMZeroIndices[targetTimestep] * numberOfVoxels;
+      double *target = targetBuffer + targetTimestep * numberOfVoxels;
+      const double weight = weights[targetTimestep];
 
-      while (!sourceIterator.IsAtEnd())
+      for (std::size_t voxel = begin; voxel < end; ++voxel)
       {
-        double normalizationFactor = weight * lowerMZeroIterator.Get() + (1.0 - weight) * upperMZeroIterator.Get();
-        if (mitk::Equal(normalizationFactor, 0))
-        {
-          targetIterator.Set(0);
-        }
-        else
-        {
-          targetIterator.Set(double(sourceIterator.Get()) / normalizationFactor);
-        }
-
-        ++lowerMZeroIterator;
-        ++upperMZeroIterator;
-        ++sourceIterator;
-        ++targetIterator;
+        const double normalizationFactor = weight * lowerMZero[voxel] + (1.0 - weight) * upperMZero[voxel];
+        target[voxel] = mitk::Equal(normalizationFactor, 0) ? 0.0 : double(source[voxel]) / normalizationFactor;
       }
-      ++targetTimestep;
     }
-  }
+  });
 
   // get  Pointer to output image
   mitk::Image::Pointer resultMitkImage = this->GetOutput();
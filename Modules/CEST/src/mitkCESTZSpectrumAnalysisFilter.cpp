@@ -0,0 +1,380 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkCESTZSpectrumAnalysisFilter.h"
+
+#include <mitkCustomTagParser.h>
+#include <mitkImageAccessByItk.h>
+#include <mitkImageWriteAccessor.h>
+#include <mitkLocaleSwitch.h>
+#include <mitkTaskScheduler.h>
+
+#include <boost/algorithm/string.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace
+{
+  void ParallelFor(std::size_t size, const std::function<void(std::size_t, std::size_t)> &function)
+  {
+    mitk::TaskScheduler *scheduler = mitk::TaskScheduler::GetInstance();
+    const std::size_t numberOfChunks =
+      std::max<std::size_t>(1, std::min<std::size_t>(size, 4 * scheduler->GetNumberOfThreads()));
+    const std::size_t chunkSize = (size + numberOfChunks - 1) / numberOfChunks;
+
+    std::vector<mitk::TaskScheduler::TaskPointer> tasks;
+    for (std::size_t begin = 0; begin < size; begin += chunkSize)
+    {
+      const std::size_t end = std::min(size, begin + chunkSize);
+      tasks.push_back(scheduler->Submit([&function, begin, end]() { function(begin, end); }));
+    }
+
+    for (const auto &task : tasks)
+      task->Wait();
+  }
+
+  /** Voxels transposed and analyzed together, 64 spectra of a few dozen offsets fit into the L1 cache */
+  const std::size_t BlockSize = 64;
+
+  struct Lorentzian
+  {
+    double Amplitude;
+    double Shift;
+    double Width;
+  };
+
+  double SumOfSquares(const double *offsets, const double *values, std::size_t size, const Lorentzian &lorentzian)
+  {
+    const double quarterWidthSquared = 0.25 * lorentzian.Width * lorentzian.Width;
+    double sum = 0.0;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      const double distance = offsets[i] - lorentzian.Shift;
+      const double residual =
+        values[i] - 1.0 + lorentzian.Amplitude * quarterWidthSquared / (distance * distance + quarterWidthSquared);
+      sum += residual * residual;
+    }
+    return sum;
+  }
+
+  /** Solves the symmetric 3x3 system by Cramer's rule, returns false if it is singular */
+  bool Solve(const double matrix[3][3], const double vector[3], double solution[3])
+  {
+    const double cofactor0 = matrix[1][1] * matrix[2][2] - matrix[1][2] * matrix[2][1];
+    const double cofactor1 = matrix[1][2] * matrix[2][0] - matrix[1][0] * matrix[2][2];
+    const double cofactor2 = matrix[1][0] * matrix[2][1] - matrix[1][1] * matrix[2][0];
+    const double determinant = matrix[0][0] * cofactor0 + matrix[0][1] * cofactor1 + matrix[0][2] * cofactor2;
+    if (!(std::abs(determinant) > 1e-300))
+      return false;
+
+    for (int column = 0; column < 3; ++column)
+    {
+      double replaced[3][3];
+      for (int row = 0; row < 3; ++row)
+        for (int c = 0; c < 3; ++c)
+          replaced[row][c] = (c == column) ? vector[row] : matrix[row][c];
+
+      solution[column] = (replaced[0][0] * (replaced[1][1] * replaced[2][2] - replaced[1][2] * replaced[2][1]) -
+                          replaced[0][1] * (replaced[1][0] * replaced[2][2] - replaced[1][2] * replaced[2][0]) +
+                          replaced[0][2] * (replaced[1][0] * replaced[2][1] - replaced[1][1] * replaced[2][0])) /
+                         determinant;
+    }
+    return true;
+  }
+
+  /** Levenberg-Marquardt fit of the Lorentzian to the spectrum with ascending offsets */
+  bool FitLorentzian(const double *offsets,
+                     const double *values,
+                     std::size_t size,
+                     unsigned int maximumNumberOfIterations,
+                     Lorentzian &lorentzian)
+  {
+    if (size < 4)
+      return false;
+
+    // start at the minimum, the width from the points below half of its depth
+    const std::size_t minimum = std::min_element(values, values + size) - values;
+    lorentzian.Amplitude = std::max(1.0 - values[minimum], 1e-3);
+    lorentzian.Shift = offsets[minimum];
+
+    const double halfDepth = 1.0 - 0.5 * lorentzian.Amplitude;
+    std::size_t lower = minimum;
+    std::size_t upper = minimum;
+    while (lower > 0 && values[lower - 1] < halfDepth)
+      --lower;
+    while (upper + 1 < size && values[upper + 1] < halfDepth)
+      ++upper;
+    lorentzian.Width = offsets[upper] - offsets[lower];
+    if (!(lorentzian.Width > 0.0))
+      lorentzian.Width = 0.5 * (offsets[size - 1] - offsets[0]) / (size - 1) + 1e-3;
+
+    double sumOfSquares = SumOfSquares(offsets, values, size, lorentzian);
+    double lambda = 1e-3;
+
+    for (unsigned int iteration = 0; iteration < maximumNumberOfIterations; ++iteration)
+    {
+      // normal equations of the linearized problem, derivatives of the model by amplitude, shift and width
+      double normalMatrix[3][3] = {{0.0, 0.0, 0.0}, {0.0, 0.0, 0.0}, {0.0, 0.0, 0.0}};
+      double gradient[3] = {0.0, 0.0, 0.0};
+      const double quarterWidthSquared = 0.25 * lorentzian.Width * lorentzian.Width;
+      for (std::size_t i = 0; i < size; ++i)
+      {
+        const double distance = offsets[i] - lorentzian.Shift;
+        const double denominator = 1.0 / (distance * distance + quarterWidthSquared);
+        const double shape = quarterWidthSquared * denominator;
+        const double residual = values[i] - 1.0 + lorentzian.Amplitude * shape;
+
+        const double derivatives[3] = {-shape,
+                                       -2.0 * lorentzian.Amplitude * shape * distance * denominator,
+                                       -0.5 * lorentzian.Amplitude * lorentzian.Width * distance * distance *
+                                         denominator * denominator};
+        for (int row = 0; row < 3; ++row)
+        {
+          gradient[row] += derivatives[row] * residual;
+          for (int column = 0; column <= row; ++column)
+            normalMatrix[row][column] += derivatives[row] * derivatives[column];
+        }
+      }
+      normalMatrix[0][1] = normalMatrix[1][0];
+      normalMatrix[0][2] = normalMatrix[2][0];
+      normalMatrix[1][2] = normalMatrix[2][1];
+
+      bool improved = false;
+      Lorentzian trial = lorentzian;
+      double trialSumOfSquares = sumOfSquares;
+      while (!improved && lambda < 1e10)
+      {
+        double dampedMatrix[3][3];
+        std::copy(&normalMatrix[0][0], &normalMatrix[0][0] + 9, &dampedMatrix[0][0]);
+        for (int i = 0; i < 3; ++i)
+          dampedMatrix[i][i] *= 1.0 + lambda;
+
+        double step[3];
+        if (Solve(dampedMatrix, gradient, step))
+        {
+          trial.Amplitude = lorentzian.Amplitude + step[0];
+          trial.Shift = lorentzian.Shift + step[1];
+          trial.Width = std::abs(lorentzian.Width + step[2]);
+          trialSumOfSquares = SumOfSquares(offsets, values, size, trial);
+          improved = trial.Width > 0.0 && trialSumOfSquares < sumOfSquares;
+        }
+
+        lambda = improved ? std::max(lambda * 0.1, 1e-12) : lambda * 10.0;
+      }
+
+      if (!improved)
+        break;
+
+      const double decrease = sumOfSquares - trialSumOfSquares;
+      lorentzian = trial;
+      sumOfSquares = trialSumOfSquares;
+      if (decrease <= 1e-12 * sumOfSquares + 1e-30)
+        break;
+    }
+
+    return std::isfinite(lorentzian.Amplitude) && std::isfinite(lorentzian.Shift) &&
+           std::isfinite(lorentzian.Width) && lorentzian.Shift >= offsets[0] && lorentzian.Shift <= offsets[size - 1];
+  }
+
+  /** Linear interpolation of the spectrum with ascending offsets, constant outside of them */
+  double Interpolate(const double *offsets, const double *values, std::size_t size, double offset)
+  {
+    if (offset <= offsets[0])
+      return values[0];
+    if (offset >= offsets[size - 1])
+      return values[size - 1];
+
+    const std::size_t upper = std::upper_bound(offsets, offsets + size, offset) - offsets;
+    const double weight = (offset - offsets[upper - 1]) / (offsets[upper] - offsets[upper - 1]);
+    return (1.0 - weight) * values[upper - 1] + weight * values[upper];
+  }
+}
+
+mitk::CESTZSpectrumAnalysisFilter::CESTZSpectrumAnalysisFilter()
+  : m_AsymmetryOffset(3.5), m_UseB0Correction(true), m_FitRange(0.0), m_MaximumNumberOfIterations(100)
+{
+  this->SetNumberOfRequiredOutputs(4);
+  this->SetNumberOfIndexedOutputs(4);
+  for (unsigned int index = 1; index < 4; ++index)
+  {
+    this->SetNthOutput(index, this->MakeOutput(index));
+  }
+}
+
+mitk::CESTZSpectrumAnalysisFilter::~CESTZSpectrumAnalysisFilter()
+{
+}
+
+void mitk::CESTZSpectrumAnalysisFilter::GenerateOutputInformation()
+{
+  mitk::Image::ConstPointer input = this->GetInput();
+  if (input->GetDimension() != 4)
+  {
+    mitkThrow() << "mitk::CESTZSpectrumAnalysisFilter works only with 4D images.";
+  }
+
+  for (unsigned int index = 0; index < 4; ++index)
+  {
+    this->GetOutput(index)->Initialize(mitk::MakeScalarPixelType<double>(), *input->GetGeometry(0));
+  }
+
+  itkDebugMacro(<< "GenerateOutputInformation()");
+}
+
+void mitk::CESTZSpectrumAnalysisFilter::GenerateData()
+{
+  mitk::Image::ConstPointer inputImage = this->GetInput(0);
+  if (inputImage->GetDimension() != 4)
+  {
+    mitkThrow() << "mitk::CESTZSpectrumAnalysisFilter:GenerateData works only with 4D images, sorry.";
+  }
+
+  AccessFixedDimensionByItk(inputImage, AnalyzeSpectra, 4);
+
+  for (unsigned int index = 0; index < 4; ++index)
+  {
+    this->GetOutput(index)->SetPropertyList(inputImage->GetPropertyList()->Clone());
+    this->GetOutput(index)->GetPropertyList()->DeleteProperty(mitk::CustomTagParser::m_OffsetsPropertyName.c_str());
+  }
+}
+
+template <typename TPixel, unsigned int VImageDimension>
+void mitk::CESTZSpectrumAnalysisFilter::AnalyzeSpectra(const itk::Image<TPixel, VImageDimension> *image)
+{
+  mitk::LocaleSwitch localeSwitch("C");
+
+  std::string offsetsString = "";
+  this->GetInput()->GetPropertyList()->GetStringProperty(mitk::CustomTagParser::m_OffsetsPropertyName.c_str(),
+                                                         offsetsString);
+  boost::algorithm::trim(offsetsString);
+
+  std::vector<std::string> parts;
+  boost::split(parts, offsetsString, boost::is_any_of(" "), boost::token_compress_on);
+
+  const typename itk::Image<TPixel, VImageDimension>::SizeType &size = image->GetLargestPossibleRegion().GetSize();
+  if (offsetsString.empty() || parts.size() != size[3])
+  {
+    mitkThrow() << "mitk::CESTZSpectrumAnalysisFilter: the number of offsets (" << (offsetsString.empty() ? 0 : parts.size())
+                << ") does not match the number of timesteps (" << size[3] << ").";
+  }
+
+  // the timesteps without M0 images in order of ascending offsets
+  std::vector<double> allOffsets;
+  std::vector<unsigned int> timesteps;
+  for (unsigned int index = 0; index < parts.size(); ++index)
+  {
+    const double offset = std::stod(parts[index]);
+    allOffsets.push_back(offset);
+    if (offset >= -299 && offset <= 299)
+    {
+      timesteps.push_back(index);
+    }
+  }
+  std::stable_sort(timesteps.begin(), timesteps.end(), [&allOffsets](unsigned int a, unsigned int b) {
+    return allOffsets[a] < allOffsets[b];
+  });
+
+  const std::size_t numberOfOffsets = timesteps.size();
+  if (numberOfOffsets < 2)
+  {
+    mitkThrow() << "mitk::CESTZSpectrumAnalysisFilter: the image needs at least two offsets besides the M0 images.";
+  }
+
+  std::vector<double> offsets(numberOfOffsets);
+  for (std::size_t i = 0; i < numberOfOffsets; ++i)
+  {
+    offsets[i] = allOffsets[timesteps[i]];
+  }
+
+  if (-m_AsymmetryOffset < offsets.front() || m_AsymmetryOffset > offsets.back())
+  {
+    mitkThrow() << "mitk::CESTZSpectrumAnalysisFilter: the asymmetry offset " << m_AsymmetryOffset
+                << " is not within the measured offsets.";
+  }
+
+  // the offsets are sorted, so the fit range is a contiguous part of each spectrum
+  std::size_t fitBegin = 0;
+  std::size_t fitEnd = numberOfOffsets;
+  if (m_FitRange > 0.0)
+  {
+    fitBegin = std::lower_bound(offsets.begin(), offsets.end(), -m_FitRange) - offsets.begin();
+    fitEnd = std::upper_bound(offsets.begin(), offsets.end(), m_FitRange) - offsets.begin();
+  }
+
+  const std::size_t numberOfVoxels = size[0] * size[1] * size[2];
+  const TPixel *inputBuffer = image->GetBufferPointer();
+
+  mitk::ImageWriteAccessor asymmetryAccessor(this->GetOutput(0));
+  mitk::ImageWriteAccessor shiftAccessor(this->GetOutput(1));
+  mitk::ImageWriteAccessor amplitudeAccessor(this->GetOutput(2));
+  mitk::ImageWriteAccessor widthAccessor(this->GetOutput(3));
+  double *asymmetryBuffer = static_cast<double *>(asymmetryAccessor.GetData());
+  double *shiftBuffer = static_cast<double *>(shiftAccessor.GetData());
+  double *amplitudeBuffer = static_cast<double *>(amplitudeAccessor.GetData());
+  double *widthBuffer = static_cast<double *>(widthAccessor.GetData());
+
+  const std::size_t numberOfBlocks = (numberOfVoxels + BlockSize - 1) / BlockSize;
+  ParallelFor(numberOfBlocks, [&](std::size_t beginBlock, std::size_t endBlock) {
+    std::vector<double> spectra(BlockSize * numberOfOffsets);
+
+    for (std::size_t block = beginBlock; block < endBlock; ++block)
+    {
+      const std::size_t firstVoxel = block * BlockSize;
+      const std::size_t count = std::min(BlockSize, numberOfVoxels - firstVoxel);
+
+      // transpose, every timestep is read contiguously and every spectrum is written contiguously
+      for (std::size_t i = 0; i < numberOfOffsets; ++i)
+      {
+        const TPixel *source = inputBuffer + timesteps[i] * numberOfVoxels + firstVoxel;
+        for (std::size_t voxel = 0; voxel < count; ++voxel)
+        {
+          spectra[voxel * numberOfOffsets + i] = source[voxel];
+        }
+      }
+
+      for (std::size_t voxel = 0; voxel < count; ++voxel)
+      {
+        const double *spectrum = spectra.data() + voxel * numberOfOffsets;
+        const std::size_t target = firstVoxel + voxel;
+
+        Lorentzian lorentzian;
+        if (FitLorentzian(offsets.data() + fitBegin,
+                          spectrum + fitBegin,
+                          fitEnd - fitBegin,
+                          m_MaximumNumberOfIterations,
+                          lorentzian))
+        {
+          shiftBuffer[target] = lorentzian.Shift;
+          amplitudeBuffer[target] = lorentzian.Amplitude;
+          widthBuffer[target] = lorentzian.Width;
+        }
+        else
+        {
+          shiftBuffer[target] = 0.0;
+          amplitudeBuffer[target] = 0.0;
+          widthBuffer[target] = 0.0;
+        }
+
+        const double center = m_UseB0Correction ? shiftBuffer[target] : 0.0;
+        asymmetryBuffer[target] =
+          Interpolate(offsets.data(), spectrum, numberOfOffsets, center - m_AsymmetryOffset) -
+          Interpolate(offsets.data(), spectrum, numberOfOffsets, center + m_AsymmetryOffset);
+      }
+    }
+  });
+}
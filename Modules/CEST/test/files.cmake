@@ -1,6 +1,7 @@
 set(MODULE_TESTS
   mitkCustomTagParserTest.cpp
   mitkCESTDICOMReaderServiceTest.cpp
+  mitkCESTZSpectrumAnalysisFilterTest.cpp
 )
 
 SET(MODULE_CUSTOM_TESTS
@@ -0,0 +1,245 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+// Testing
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+// MITK includes
+#include <mitkCESTImageNormalizationFilter.h>
+#include <mitkCESTZSpectrumAnalysisFilter.h>
+#include <mitkCustomTagParser.h>
+#include <mitkITKImageImport.h>
+#include <mitkImagePixelReadAccessor.h>
+#include <mitkImagePixelWriteAccessor.h>
+
+#include <itkImage.h>
+
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+class mitkCESTZSpectrumAnalysisFilterTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkCESTZSpectrumAnalysisFilterTestSuite);
+  MITK_TEST(Normalization_InterpolatesBetweenM0s);
+  MITK_TEST(Normalization_NoM0_Failure);
+  MITK_TEST(Analysis_FitsLorentzian);
+  MITK_TEST(Analysis_AsymmetryWithoutB0Correction);
+  MITK_TEST(Analysis_WrongNumberOfOffsets_Failure);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef itk::Image<double, 4> ImageType;
+
+  struct Parameters
+  {
+    double Amplitude;
+    double Shift;
+    double Width;
+    double CESTAmplitude;
+  };
+
+  std::vector<double> m_Offsets;
+  std::vector<Parameters> m_Parameters;
+
+  static double Spectrum(const Parameters &parameters, double offset)
+  {
+    const double quarterWidthSquared = 0.25 * parameters.Width * parameters.Width;
+    const double distance = offset - parameters.Shift;
+    const double cestDistance = offset - parameters.Shift - 3.5;
+    return 1.0 - parameters.Amplitude * quarterWidthSquared / (distance * distance + quarterWidthSquared) -
+           parameters.CESTAmplitude * std::exp(-cestDistance * cestDistance / 0.02);
+  }
+
+  /** Linear interpolation of the spectrum sampled at the offsets, which are 0.25 apart from -5 to 5 */
+  static double SampledSpectrum(const Parameters &parameters, double offset)
+  {
+    const double lower = std::floor(offset / 0.25) * 0.25;
+    const double weight = (offset - lower) / 0.25;
+    return (1.0 - weight) * Spectrum(parameters, lower) + weight * Spectrum(parameters, lower + 0.25);
+  }
+
+  /** 4D image with one timestep per value of the first voxel and the same values in all other voxels */
+  static mitk::Image::Pointer CreateImage(unsigned int numberOfVoxels,
+                                          unsigned int numberOfTimesteps,
+                                          const std::string &offsets)
+  {
+    ImageType::Pointer itkImage = ImageType::New();
+    ImageType::SizeType size = {{numberOfVoxels, 1, 1, numberOfTimesteps}};
+    ImageType::RegionType region;
+    region.SetSize(size);
+    itkImage->SetRegions(region);
+    itkImage->Allocate();
+    itkImage->FillBuffer(0.0);
+
+    mitk::Image::Pointer image = mitk::GrabItkImageMemory(itkImage);
+    image->GetPropertyList()->SetStringProperty(mitk::CustomTagParser::m_OffsetsPropertyName.c_str(), offsets.c_str());
+    return image;
+  }
+
+  static void SetValue(mitk::Image *image, unsigned int voxel, unsigned int timestep, double value)
+  {
+    mitk::ImagePixelWriteAccessor<double, 4> accessor(image);
+    itk::Index<4> index = {
+      {static_cast<itk::IndexValueType>(voxel), 0, 0, static_cast<itk::IndexValueType>(timestep)}};
+    accessor.SetPixelByIndex(index, value);
+  }
+
+  static double GetValue(mitk::Image *image, unsigned int voxel, unsigned int timestep = 0)
+  {
+    if (image->GetDimension() == 4)
+    {
+      mitk::ImagePixelReadAccessor<double, 4> accessor(image);
+      itk::Index<4> index = {
+        {static_cast<itk::IndexValueType>(voxel), 0, 0, static_cast<itk::IndexValueType>(timestep)}};
+      return accessor.GetPixelByIndex(index);
+    }
+
+    mitk::ImagePixelReadAccessor<double, 3> accessor(image);
+    itk::Index<3> index = {{static_cast<itk::IndexValueType>(voxel), 0, 0}};
+    return accessor.GetPixelByIndex(index);
+  }
+
+  mitk::Image::Pointer CreateSpectra()
+  {
+    std::stringstream offsets;
+    offsets << "-300";
+    for (const double offset : m_Offsets)
+    {
+      offsets << " " << offset;
+    }
+
+    mitk::Image::Pointer image = CreateImage(m_Parameters.size(), m_Offsets.size() + 1, offsets.str());
+    for (unsigned int voxel = 0; voxel < m_Parameters.size(); ++voxel)
+    {
+      SetValue(image, voxel, 0, 1.0);
+      for (unsigned int timestep = 0; timestep < m_Offsets.size(); ++timestep)
+      {
+        SetValue(image, voxel, timestep + 1, Spectrum(m_Parameters[voxel], m_Offsets[timestep]));
+      }
+    }
+    return image;
+  }
+
+public:
+  void setUp() override
+  {
+    // descending, interleaved offsets as acquired
+    m_Offsets.clear();
+    for (int step = 0; step <= 20; ++step)
+    {
+      m_Offsets.push_back(5.0 - 0.25 * step);
+      if (step != 20)
+      {
+        m_Offsets.push_back(-5.0 + 0.25 * step);
+      }
+    }
+
+    m_Parameters.clear();
+    m_Parameters.push_back({0.9, 0.0, 1.5, 0.0});
+    m_Parameters.push_back({0.8, 0.3, 2.0, 0.0});
+    m_Parameters.push_back({0.95, -0.45, 1.2, 0.05});
+    m_Parameters.push_back({0.7, 0.1, 2.5, 0.1});
+  }
+
+  void tearDown() override
+  {
+    m_Offsets.clear();
+    m_Parameters.clear();
+  }
+
+  void Normalization_InterpolatesBetweenM0s()
+  {
+    mitk::Image::Pointer image = CreateImage(2, 5, "-300 1 2 3 300");
+    for (unsigned int voxel = 0; voxel < 2; ++voxel)
+    {
+      SetValue(image, voxel, 0, 100.0);
+      SetValue(image, voxel, 1, 50.0);
+      SetValue(image, voxel, 2, 50.0);
+      SetValue(image, voxel, 3, 50.0);
+      SetValue(image, voxel, 4, 200.0);
+    }
+    SetValue(image, 1, 0, 0.0);
+    SetValue(image, 1, 4, 0.0);
+
+    auto filter = mitk::CESTImageNormalizationFilter::New();
+    filter->SetInput(image);
+    filter->Update();
+    mitk::Image::Pointer result = filter->GetOutput();
+
+    CPPUNIT_ASSERT_EQUAL(3u, result->GetDimension(3));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(50.0 / 125.0, GetValue(result, 0, 0), 1e-12);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(50.0 / 150.0, GetValue(result, 0, 1), 1e-12);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(50.0 / 175.0, GetValue(result, 0, 2), 1e-12);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, GetValue(result, 1, 1), 1e-12);
+  }
+
+  void Normalization_NoM0_Failure()
+  {
+    mitk::Image::Pointer image = CreateImage(1, 2, "1 2");
+
+    auto filter = mitk::CESTImageNormalizationFilter::New();
+    filter->SetInput(image);
+    CPPUNIT_ASSERT_THROW(filter->Update(), mitk::Exception);
+  }
+
+  void Analysis_FitsLorentzian()
+  {
+    auto filter = mitk::CESTZSpectrumAnalysisFilter::New();
+    filter->SetInput(CreateSpectra());
+    filter->SetFitRange(2.5);
+    filter->Update();
+
+    for (unsigned int voxel = 0; voxel < m_Parameters.size(); ++voxel)
+    {
+      const Parameters &parameters = m_Parameters[voxel];
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(parameters.Shift, GetValue(filter->GetB0ShiftOutput(), voxel), 1e-3);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(parameters.Amplitude, GetValue(filter->GetAmplitudeOutput(), voxel), 1e-3);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(parameters.Width, GetValue(filter->GetWidthOutput(), voxel), 1e-3);
+
+      const double expectedAsymmetry =
+        SampledSpectrum(parameters, parameters.Shift - 3.5) - SampledSpectrum(parameters, parameters.Shift + 3.5);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedAsymmetry, GetValue(filter->GetAsymmetryOutput(), voxel), 1e-3);
+    }
+  }
+
+  void Analysis_AsymmetryWithoutB0Correction()
+  {
+    auto filter = mitk::CESTZSpectrumAnalysisFilter::New();
+    filter->SetInput(CreateSpectra());
+    filter->UseB0CorrectionOff();
+    filter->SetAsymmetryOffset(3.0);
+    filter->Update();
+
+    for (unsigned int voxel = 0; voxel < m_Parameters.size(); ++voxel)
+    {
+      const double expectedAsymmetry = Spectrum(m_Parameters[voxel], -3.0) - Spectrum(m_Parameters[voxel], 3.0);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedAsymmetry, GetValue(filter->GetAsymmetryOutput(), voxel), 1e-12);
+    }
+  }
+
+  void Analysis_WrongNumberOfOffsets_Failure()
+  {
+    mitk::Image::Pointer image = CreateImage(1, 3, "1 2");
+
+    auto filter = mitk::CESTZSpectrumAnalysisFilter::New();
+    filter->SetInput(image);
+    CPPUNIT_ASSERT_THROW(filter->Update(), mitk::Exception);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkCESTZSpectrumAnalysisFilter)
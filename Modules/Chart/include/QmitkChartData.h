@@ -70,6 +70,9 @@ public:
   Q_INVOKABLE QVariant GetDataPointSize() const { return m_DataPointSize; };
   Q_INVOKABLE void SetDataPointSize(const QVariant& showDataPoints) {if (showDataPoints > 0 ) { m_DataPointSize = 3; } else { m_DataPointSize = 0; } emit SignalDataPointSizeChanged(showDataPoints); };
 
+  /** \brief Called from JavaScript when the user finished zooming, the range is the visible x range. */
+  Q_INVOKABLE void SetZoomRange(const QVariant& minX, const QVariant& maxX) { emit SignalZoomRangeChanged(minX, maxX); };
+
 signals:
   void SignalYAxisLabelChanged(const QVariant label);
   void SignalXAxisLabelChanged(const QVariant label);
@@ -80,6 +83,7 @@ signals:
   void SignalShowSubchartChanged(const QVariant showSubchart);
   void SignalUsePercentageInPieChartChanged(const QVariant usePercentageInPieChart);
   void SignalDataPointSizeChanged(const QVariant showDataPoints);
+  void SignalZoomRangeChanged(const QVariant minX, const QVariant maxX);
 
 private:
   QVariant m_xAxisLabel;
@@ -108,6 +108,22 @@ public:
   */
   void AddData2D(const std::map<double, double>& data2D, const std::string& label, ChartType chartType = ChartType::bar);
 
+  /*!
+  * \brief Appends 1D data to an existing data entry (identifier is previously assigned label)
+  * \details the x values continue after the existing number of points of the entry.
+  * \sa AppendData2D
+  */
+  void AppendData1D(const std::vector<double>& data1D, const std::string& label);
+
+  /*!
+  * \brief Appends 2D data to an existing data entry (identifier is previously assigned label)
+  * \details Meant for streaming data: only the new points are merged into the entry and, if the chart is
+  * already shown, the displayed series is updated without reloading the chart.
+  * Points with an already existing x value replace the old ones.
+  * \note If an unknown label is given, nothing happens.
+  */
+  void AppendData2D(const std::map<double, double>& data2D, const std::string& label);
+
   /*!
   * \brief Removes data from the widget, works for 1D and 2D Data
   * \param label the name of the data that is also used as identifier.
@@ -187,6 +203,16 @@ public:
   */
   void SetShowDataPoints(bool showDataPoints);
 
+  /*!
+  * \brief Enables (default) or disables the downsampling of large data entries.
+  * \details If enabled, each data entry is reduced to about two points per pixel of the widget width before it is
+  * displayed (bar charts keep minimum and maximum per bucket, other charts use largest-triangle-three-buckets).
+  * When zooming, the visible range is downsampled again from the full data, so details appear.
+  * Pie charts are never downsampled.
+  * \note Takes effect with the next call of Show().
+  */
+  void SetDownsampling(bool enabled);
+
   /*!
   * \brief Clears all data inside and resets the widget.
   */
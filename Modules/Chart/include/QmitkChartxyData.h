@@ -17,11 +17,19 @@ See LICENSE.txt or http://www.mitk.org for details.
 #ifndef QmitkC3xyData_h
 #define QmitkC3xyData_h
 
+#include <map>
+#include <vector>
+
 #include <QVariant>
 
 /** /brief This class holds the actual data for the chart generation with C3.
 * data can be loaded in constructor directly or with SetData
 * It is derived from QObject, because we need Q_PROPERTIES to send Data via QWebChannel to JavaScript.
+*
+* The full data set is kept on the C++ side, only m_XData and m_YData are sent to JavaScript. They are
+* downsampled to a maximum number of points (see SetMaximumNumberOfPoints()), bar charts by keeping minimum and
+* maximum of each bucket, all other chart types by largest-triangle-three-buckets (LTTB). If a display range is
+* set, the points inside that range are downsampled separately, so zooming in reveals the detail.
 */
 class QmitkChartxyData : public QObject
 {
@@ -39,11 +47,38 @@ public:
 
   void SetData(const QMap<QVariant, QVariant>& data);
 
+  /**
+  * \brief Adds data points to the existing ones and updates the displayed data.
+  * \details Points with an x value that already exists replace the old ones.
+  */
+  void AppendData(const std::map<double, double>& data);
+
+  std::size_t GetNumberOfPoints() const { return m_FullXData.size(); };
+
+  /**
+  * \brief Maximum number of points sent to JavaScript, 0 disables downsampling.
+  * \note The displayed data is updated with UpdateDisplayedData().
+  */
+  void SetMaximumNumberOfPoints(std::size_t maximumNumberOfPoints) { m_MaximumNumberOfPoints = maximumNumberOfPoints; };
+  std::size_t GetMaximumNumberOfPoints() const { return m_MaximumNumberOfPoints; };
+
+  /**
+  * \brief Sets the x range that is shown in full detail (up to the maximum number of points).
+  * \note The displayed data is updated with UpdateDisplayedData().
+  */
+  void SetDisplayRange(double minX, double maxX);
+  void ResetDisplayRange();
+
+  /**
+  * \brief Recomputes m_XData and m_YData from the full data set and emits their change signals.
+  */
+  void UpdateDisplayedData();
+
   Q_INVOKABLE QList<QVariant> GetYData() const { return m_YData; };
-  Q_INVOKABLE void SetYData(const QList<QVariant>& yData) { m_YData =yData; };
+  Q_INVOKABLE void SetYData(const QList<QVariant>& yData) { m_YData =yData; emit SignalYDataChanged(yData); };
 
   Q_INVOKABLE QList<QVariant> GetXData() const { return m_XData; };
-  Q_INVOKABLE void SetXData(const QList<QVariant>& xData) { m_XData =xData; };
+  Q_INVOKABLE void SetXData(const QList<QVariant>& xData) { m_XData =xData; emit SignalXDataChanged(xData); };
 
   Q_INVOKABLE QVariant GetChartType() const { return m_ChartType; };
   Q_INVOKABLE void SetChartType(const QVariant& chartType) { m_ChartType = chartType; };
@@ -74,6 +109,15 @@ signals:
   void SignalLineStyleChanged(const QVariant lineStyle);
 
 private:
+  std::vector<std::size_t> Downsample(std::size_t first, std::size_t last) const;
+
+  std::vector<double> m_FullXData;
+  std::vector<double> m_FullYData;
+  std::size_t      m_MaximumNumberOfPoints = 0;
+  bool             m_HasDisplayRange = false;
+  double           m_DisplayRangeMin = 0.0;
+  double           m_DisplayRangeMax = 0.0;
+
   QList<QVariant>  m_YData;
   QList<QVariant>  m_XData;
   QVariant         m_Label;
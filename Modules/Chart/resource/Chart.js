@@ -14,6 +14,7 @@ var xs = {};
 var dataColors = {};
 var chartTypes = {};
 var lineStyle = {};
+var zoomDomain;
 
 //Is executed when js is loaded first.
 //Extracts relevant information from chartData in variables
@@ -25,20 +26,12 @@ window.onload = function()
 	var count = 0;
 	for(var propertyName in channel.objects) {
 		if (propertyName != 'chartData'){
-			var xDataTemp = channel.objects[propertyName].m_XData
-			var yDataTemp = channel.objects[propertyName].m_YData
-			var dataLabelsTemp;
-			//add label to x array
-			xDataTemp.unshift('x'+count.toString())
-			dataLabelsTemp = channel.objects[propertyName].m_Label
+			var dataLabelsTemp = channel.objects[propertyName].m_Label
 
 			xs[dataLabelsTemp] = 'x'+count.toString()
-			
-			xDataTemp.push(null); //append null value, to make sure the last tick on x-axis is displayed correctly
-			yDataTemp.unshift(dataLabelsTemp)
-			yDataTemp.push(null); //append null value, to make sure the last tick on y-axis is displayed correctly
-			xValues[count] = xDataTemp
-			yValues[count] = yDataTemp
+			ExtractSeries(count, channel.objects[propertyName])
+			//the displayed data is replaced by C++ when appending data or after zooming (downsampling)
+			channel.objects[propertyName].SignalYDataChanged.connect(CreateSeriesUpdate(count, channel.objects[propertyName]))
 			dataColors[dataLabelsTemp] = channel.objects[propertyName].m_Color
 			chartTypes[dataLabelsTemp] = channel.objects[propertyName].m_ChartType
 
@@ -71,6 +64,41 @@ window.onresize = function () {
   });
 }
 
+//Copies the displayed data of one data entry into the c3 columns xValues[index] and yValues[index]
+function ExtractSeries(index, xyData)
+{
+  var xDataTemp = xyData.m_XData.slice()
+  var yDataTemp = xyData.m_YData.slice()
+  //add label to x array
+  xDataTemp.unshift('x'+index.toString())
+  xDataTemp.push(null); //append null value, to make sure the last tick on x-axis is displayed correctly
+  yDataTemp.unshift(xyData.m_Label)
+  yDataTemp.push(null); //append null value, to make sure the last tick on y-axis is displayed correctly
+  xValues[index] = xDataTemp
+  yValues[index] = yDataTemp
+}
+
+//Reloads only the changed data entry and restores the zoom, which c3 resets on load
+function CreateSeriesUpdate(index, xyData)
+{
+  return function() {
+    ExtractSeries(index, xyData)
+    if (chart === undefined) {
+      return;
+    }
+    var domain = zoomDomain;
+    chart.load({
+      xs: xs,
+      columns: [xValues[index], yValues[index]],
+      done: function() {
+        if (domain !== undefined) {
+          chart.zoom(domain);
+        }
+      }
+    });
+  };
+}
+
 function ReloadChart(showSubchart)
 { 
     chartData.m_ShowSubchart = showSubchart;
@@ -83,6 +111,7 @@ function setupChart(chartData)
   window.onresize();
 
   GenerateChart(chartData)
+  zoomDomain = undefined;
     
   chart.unload(); //unload data before loading new data
   
@@ -186,6 +215,13 @@ function GenerateChart(chartData)
 	},
     zoom: {
         enabled: true,
+        //lets C++ send the visible range in more detail if the data has been downsampled
+        onzoomend: function (domain) {
+          zoomDomain = domain;
+          if (chartData.SetZoomRange !== undefined) {
+            chartData.SetZoomRange(domain[0], domain[1]);
+          }
+        }
     },
     subchart: {
         show: chartData.m_ShowSubchart  //Shows a subchart that shows the region the primary chart is zoomed in to by overlay.
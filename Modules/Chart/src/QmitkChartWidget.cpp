@@ -14,6 +14,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 ===================================================================*/
 
+#include <algorithm>
 #include <regex>
 
 #include <QmitkChartWidget.h>
@@ -26,6 +27,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <QmitkChartxyData.h>
 #include "mitkExceptionMacro.h"
 
+namespace
+{
+  //below this, downsampling would remove detail that is visible even in a small widget
+  const std::size_t MinimumNumberOfDisplayedPoints = 500;
+}
+
 class QmitkChartWidget::Impl final
 {
 public:
@@ -38,6 +45,9 @@ public:
   void AddData1D(const std::vector<double>& data1D, const std::string& label, QmitkChartWidget::ChartType chartType);
   void AddData2D(const std::map<double, double>& data2D, const std::string& label, QmitkChartWidget::ChartType chartType);
 
+  void AppendData1D(const std::vector<double>& data1D, const std::string& label);
+  void AppendData2D(const std::map<double, double>& data2D, const std::string& label);
+
   void RemoveData(const std::string& label);
 
   void ClearData();
@@ -59,6 +69,8 @@ public:
 
   void SetShowDataPoints(bool showDataPoints = false);
 
+  void SetDownsampling(bool enabled);
+
   void Show(bool showSubChart);
 
   void SetChartType(QmitkChartWidget::ChartType chartType);
@@ -76,6 +88,8 @@ private:
   std::string GetUniqueLabelName(const QList<QVariant>& labelList, const std::string& label) const;
   QmitkChartxyData* GetDataElementByLabel(const std::string& label) const;
   QList<QVariant> GetDataLabels(const ChartxyDataVector& c3xyData) const;
+  std::size_t GetMaximumNumberOfDisplayedPoints() const;
+  void OnZoomRangeChanged(double minX, double maxX);
 
   QWebChannel* m_WebChannel;
   QWebEngineView* m_WebEngineView;
@@ -86,11 +100,13 @@ private:
   std::map<QmitkChartWidget::LegendPosition, std::string> m_LegendPositionToName;
   std::map<QmitkChartWidget::LineStyle, std::string> m_LineStyleToName;
   std::map<QmitkChartWidget::AxisScale, std::string> m_AxisScaleToName;
+  bool m_Downsampling;
 };
 
 QmitkChartWidget::Impl::Impl(QWidget* parent)
   : m_WebChannel(new QWebChannel(parent))
   , m_WebEngineView(new QWebEngineView(parent))
+  , m_Downsampling(true)
 {
   //disable context menu for QWebEngineView
   m_WebEngineView->setContextMenuPolicy(Qt::NoContextMenu);
@@ -101,6 +117,9 @@ QmitkChartWidget::Impl::Impl(QWidget* parent)
   m_WebEngineView->settings()->setAttribute(QWebEngineSettings::FocusOnNavigationEnabled, false);
 
   connect(m_WebEngineView, SIGNAL(loadFinished(bool)), parent, SLOT(OnLoadFinished(bool)));
+  connect(&m_C3Data, &QmitkChartData::SignalZoomRangeChanged, parent, [this](const QVariant& minX, const QVariant& maxX) {
+    OnZoomRangeChanged(minX.toDouble(), maxX.toDouble());
+  });
 
   auto layout = new QGridLayout(parent);
   layout->setMargin(0);
@@ -164,6 +183,32 @@ void QmitkChartWidget::Impl::AddData2D(const std::map<double, double>& data2D, c
   m_C3xyData.push_back(std::make_unique<QmitkChartxyData>(data2DConverted, QVariant(QString::fromStdString(uniqueLabel)), QVariant(QString::fromStdString(chartTypeName))));
 }
 
+void QmitkChartWidget::Impl::AppendData1D(const std::vector<double>& data1D, const std::string& label)
+{
+  auto element = GetDataElementByLabel(label);
+  if (element)
+  {
+    std::map<double, double> transformedData2D;
+    auto count = element->GetNumberOfPoints();
+    for (const auto& ele : data1D)
+    {
+      transformedData2D[count] = ele;
+      count++;
+    }
+    element->AppendData(transformedData2D);
+  }
+}
+
+void QmitkChartWidget::Impl::AppendData2D(const std::map<double, double>& data2D, const std::string& label)
+{
+  auto element = GetDataElementByLabel(label);
+  if (element)
+  {
+    //if the chart is shown, the change signals of the displayed data update the JavaScript chart
+    element->AppendData(data2D);
+  }
+}
+
 void QmitkChartWidget::Impl::RemoveData(const std::string& label)
 {
   for (ChartxyDataVector::iterator iter = m_C3xyData.begin(); iter != m_C3xyData.end(); ++iter)
@@ -288,6 +333,35 @@ void QmitkChartWidget::Impl::SetShowDataPoints(bool showDataPoints)
   }
 }
 
+void QmitkChartWidget::Impl::SetDownsampling(bool enabled)
+{
+  m_Downsampling = enabled;
+}
+
+std::size_t QmitkChartWidget::Impl::GetMaximumNumberOfDisplayedPoints() const
+{
+  if (!m_Downsampling)
+  {
+    return 0;
+  }
+  return std::max<std::size_t>(MinimumNumberOfDisplayedPoints, 2 * static_cast<std::size_t>(m_WebEngineView->width()));
+}
+
+void QmitkChartWidget::Impl::OnZoomRangeChanged(double minX, double maxX)
+{
+  const auto maximumNumberOfPoints = GetMaximumNumberOfDisplayedPoints();
+  for (auto& xyData : m_C3xyData)
+  {
+    //only downsampled data sets have more detail to show
+    if (maximumNumberOfPoints > 0 && xyData->GetNumberOfPoints() > maximumNumberOfPoints)
+    {
+      xyData->SetMaximumNumberOfPoints(maximumNumberOfPoints);
+      xyData->SetDisplayRange(minX, maxX);
+      xyData->UpdateDisplayedData();
+    }
+  }
+}
+
 void QmitkChartWidget::Impl::Show(bool showSubChart)
 {
   if (m_C3xyData.empty())
@@ -295,6 +369,14 @@ void QmitkChartWidget::Impl::Show(bool showSubChart)
     mitkThrow() << "no data available for display in chart";
   }
 
+  const auto maximumNumberOfPoints = GetMaximumNumberOfDisplayedPoints();
+  for (auto& xyData : m_C3xyData)
+  {
+    xyData->SetMaximumNumberOfPoints(maximumNumberOfPoints);
+    xyData->ResetDisplayRange();
+    xyData->UpdateDisplayedData();
+  }
+
   m_C3Data.SetAppearance(showSubChart, m_C3xyData.front()->GetChartType() == QVariant("pie"));
   InitializeJavaScriptChart();
 }
@@ -381,6 +463,16 @@ void QmitkChartWidget::AddData2D(const std::map<double, double>& data2D, const s
   m_Impl->AddData2D(data2D, label, type);
 }
 
+void QmitkChartWidget::AppendData1D(const std::vector<double>& data1D, const std::string& label)
+{
+  m_Impl->AppendData1D(data1D, label);
+}
+
+void QmitkChartWidget::AppendData2D(const std::map<double, double>& data2D, const std::string& label)
+{
+  m_Impl->AppendData2D(data2D, label);
+}
+
 void QmitkChartWidget::SetColor(const std::string& label, const std::string& colorName)
 {
   m_Impl->SetColor(label, colorName);
@@ -426,6 +518,11 @@ void QmitkChartWidget::SetShowDataPoints(bool showDataPoints)
   m_Impl->SetShowDataPoints(showDataPoints);
 }
 
+void QmitkChartWidget::SetDownsampling(bool enabled)
+{
+  m_Impl->SetDownsampling(enabled);
+}
+
 void QmitkChartWidget::SetChartTypeForAllDataAndReload(ChartType type)
 {
   m_Impl->SetChartType(type);
@@ -16,21 +16,245 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <QmitkChartxyData.h>
 
+#include <algorithm>
+#include <cmath>
+
 QmitkChartxyData::QmitkChartxyData(const QMap<QVariant, QVariant>& data, const QVariant& label, const QVariant& chartType) : m_Label(label), m_ChartType(chartType), m_Color(""), m_LineStyleName("solid") {
   SetData(data);
 }
 
 void QmitkChartxyData::SetData(const QMap<QVariant, QVariant>& data)
 {
+  m_FullXData.clear();
+  m_FullYData.clear();
+  m_FullXData.reserve(data.size());
+  m_FullYData.reserve(data.size());
 	for (const auto& entry : data.toStdMap())
 	{
-		m_XData.push_back(entry.first);
-		m_YData.push_back(entry.second);
+		m_FullXData.push_back(entry.first.toDouble());
+		m_FullYData.push_back(entry.second.toDouble());
 	}
+  UpdateDisplayedData();
+}
+
+void QmitkChartxyData::AppendData(const std::map<double, double>& data)
+{
+  if (data.empty())
+  {
+    return;
+  }
+
+  //streaming data usually continues after the last point, then appending is sufficient
+  if (m_FullXData.empty() || data.begin()->first > m_FullXData.back())
+  {
+    for (const auto& entry : data)
+    {
+      m_FullXData.push_back(entry.first);
+      m_FullYData.push_back(entry.second);
+    }
+  }
+  else
+  {
+    std::map<double, double> merged;
+    for (std::size_t i = 0; i < m_FullXData.size(); ++i)
+    {
+      merged.emplace_hint(merged.end(), m_FullXData[i], m_FullYData[i]);
+    }
+    for (const auto& entry : data)
+    {
+      merged[entry.first] = entry.second;
+    }
+
+    m_FullXData.clear();
+    m_FullYData.clear();
+    for (const auto& entry : merged)
+    {
+      m_FullXData.push_back(entry.first);
+      m_FullYData.push_back(entry.second);
+    }
+  }
+  UpdateDisplayedData();
+}
+
+void QmitkChartxyData::SetDisplayRange(double minX, double maxX)
+{
+  m_HasDisplayRange = true;
+  m_DisplayRangeMin = std::min(minX, maxX);
+  m_DisplayRangeMax = std::max(minX, maxX);
+}
+
+void QmitkChartxyData::ResetDisplayRange()
+{
+  m_HasDisplayRange = false;
+}
+
+void QmitkChartxyData::UpdateDisplayedData()
+{
+  const std::size_t numberOfPoints = m_FullXData.size();
+  std::vector<std::size_t> indices;
+
+  //pie charts sum up all values, they must never be downsampled
+  if (m_MaximumNumberOfPoints == 0 || numberOfPoints <= m_MaximumNumberOfPoints || m_ChartType == QVariant("pie"))
+  {
+    indices.resize(numberOfPoints);
+    for (std::size_t i = 0; i < numberOfPoints; ++i)
+    {
+      indices[i] = i;
+    }
+  }
+  else
+  {
+    //the overview keeps the extent of the data and is shown outside of the display range
+    indices = Downsample(0, numberOfPoints);
+
+    if (m_HasDisplayRange)
+    {
+      //one point beyond each end of the range, so that lines leave the visible area correctly
+      std::size_t first = std::lower_bound(m_FullXData.begin(), m_FullXData.end(), m_DisplayRangeMin) - m_FullXData.begin();
+      std::size_t last = std::upper_bound(m_FullXData.begin(), m_FullXData.end(), m_DisplayRangeMax) - m_FullXData.begin();
+      first = first > 0 ? first - 1 : 0;
+      last = std::min(last + 1, numberOfPoints);
+
+      if (first > 0 || last < numberOfPoints)
+      {
+        std::vector<std::size_t> detail = Downsample(first, last);
+        std::vector<std::size_t> merged;
+        merged.reserve(indices.size() + detail.size());
+        for (auto index : indices)
+        {
+          if (index < first) merged.push_back(index);
+        }
+        merged.insert(merged.end(), detail.begin(), detail.end());
+        for (auto index : indices)
+        {
+          if (index >= last) merged.push_back(index);
+        }
+        indices.swap(merged);
+      }
+    }
+  }
+
+  QList<QVariant> xData;
+  QList<QVariant> yData;
+  xData.reserve(static_cast<int>(indices.size()));
+  yData.reserve(static_cast<int>(indices.size()));
+  for (auto index : indices)
+  {
+    xData.push_back(m_FullXData[index]);
+    yData.push_back(m_FullYData[index]);
+  }
+
+  //x first: JavaScript updates the chart when the y data changes
+  SetXData(xData);
+  SetYData(yData);
+}
+
+std::vector<std::size_t> QmitkChartxyData::Downsample(std::size_t first, std::size_t last) const
+{
+  const std::size_t numberOfPoints = last - first;
+  const std::size_t threshold = std::max<std::size_t>(m_MaximumNumberOfPoints, 3);
+  std::vector<std::size_t> indices;
+
+  if (numberOfPoints <= threshold)
+  {
+    for (std::size_t i = first; i < last; ++i)
+    {
+      indices.push_back(i);
+    }
+    return indices;
+  }
+
+  indices.reserve(threshold);
+  indices.push_back(first);
+
+  if (m_ChartType == QVariant("bar"))
+  {
+    //min-max: every bucket contributes its lowest and highest bar, so no peak of e.g. a histogram gets lost
+    const std::size_t numberOfBuckets = std::max<std::size_t>((threshold - 2) / 2, 1);
+    const double bucketSize = static_cast<double>(numberOfPoints - 2) / numberOfBuckets;
+    for (std::size_t bucket = 0; bucket < numberOfBuckets; ++bucket)
+    {
+      const std::size_t begin = first + 1 + static_cast<std::size_t>(bucket * bucketSize);
+      const std::size_t end = std::min(first + 1 + static_cast<std::size_t>((bucket + 1) * bucketSize), last - 1);
+      if (begin >= end)
+      {
+        continue;
+      }
+
+      std::size_t minIndex = begin;
+      std::size_t maxIndex = begin;
+      for (std::size_t i = begin + 1; i < end; ++i)
+      {
+        if (m_FullYData[i] < m_FullYData[minIndex]) minIndex = i;
+        if (m_FullYData[i] > m_FullYData[maxIndex]) maxIndex = i;
+      }
+      indices.push_back(std::min(minIndex, maxIndex));
+      if (minIndex != maxIndex)
+      {
+        indices.push_back(std::max(minIndex, maxIndex));
+      }
+    }
+  }
+  else
+  {
+    //largest-triangle-three-buckets: per bucket, the point spanning the largest triangle with the previously
+    //selected point and the average of the next bucket is kept
+    const double bucketSize = static_cast<double>(numberOfPoints - 2) / (threshold - 2);
+    std::size_t selected = first;
+    for (std::size_t bucket = 0; bucket < threshold - 2; ++bucket)
+    {
+      const std::size_t begin = first + 1 + static_cast<std::size_t>(bucket * bucketSize);
+      const std::size_t end = std::min(first + 1 + static_cast<std::size_t>((bucket + 1) * bucketSize), last - 1);
+      const std::size_t nextEnd = std::min(first + 1 + static_cast<std::size_t>((bucket + 2) * bucketSize), last);
+
+      double averageX = 0.0;
+      double averageY = 0.0;
+      for (std::size_t i = end; i < nextEnd; ++i)
+      {
+        averageX += m_FullXData[i];
+        averageY += m_FullYData[i];
+      }
+      const std::size_t nextCount = nextEnd > end ? nextEnd - end : 0;
+      if (nextCount > 0)
+      {
+        averageX /= nextCount;
+        averageY /= nextCount;
+      }
+      else
+      {
+        averageX = m_FullXData[last - 1];
+        averageY = m_FullYData[last - 1];
+      }
+
+      double maxArea = -1.0;
+      std::size_t maxIndex = begin;
+      for (std::size_t i = begin; i < end; ++i)
+      {
+        const double area = std::abs((m_FullXData[selected] - averageX) * (m_FullYData[i] - m_FullYData[selected]) -
+          (m_FullXData[selected] - m_FullXData[i]) * (averageY - m_FullYData[selected]));
+        if (area > maxArea)
+        {
+          maxArea = area;
+          maxIndex = i;
+        }
+      }
+
+      if (begin < end)
+      {
+        indices.push_back(maxIndex);
+        selected = maxIndex;
+      }
+    }
+  }
+
+  indices.push_back(last - 1);
+  return indices;
 }
 
 void QmitkChartxyData::ClearData()
 {
+  m_FullXData.clear();
+  m_FullYData.clear();
   this->m_YData.clear();
   this->m_XData.clear();
 }
@@ -187,6 +187,15 @@ public:
   itkSetMacro(Quantifier, IntensityQuantifier::Pointer);
   itkGetMacro(Quantifier, IntensityQuantifier::Pointer);
 
+  /**
+  * \brief Cache of intensity ranges that is passed to every quantifier of this feature class.
+  *
+  * Sharing one cache across all feature classes of the same image and mask avoids that each one
+  * scans the image again to initialize its histogram.
+  */
+  itkSetMacro(IntensityRangeCache, IntensityRangeCache::Pointer);
+  itkGetConstMacro(IntensityRangeCache, IntensityRangeCache::Pointer);
+
   itkGetConstMacro(Direction, int);
 
   itkSetMacro(MinimumIntensity, double);
@@ -264,6 +273,7 @@ private:
 
   bool m_UseQuantifier = false;
   IntensityQuantifier::Pointer m_Quantifier;
+  IntensityRangeCache::Pointer m_IntensityRangeCache;
 
   double m_MinimumIntensity = 0;
   bool m_UseMinimumIntensity = false;
@@ -22,6 +22,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mitkBaseData.h>
 #include <mitkImage.h>
+#include <mitkIntensityRangeCache.h>
 
 namespace mitk
 {
@@ -61,6 +62,12 @@ public:
   itkGetConstMacro(Minimum, double);
   itkGetConstMacro(Maximum, double);
 
+  /**
+  * \brief Optional cache of image intensity ranges that is shared with other quantifiers.
+  */
+  itkSetMacro(RangeCache, IntensityRangeCache::Pointer);
+  itkGetConstMacro(RangeCache, IntensityRangeCache::Pointer);
+
 public:
 
 //#ifndef DOXYGEN_SKIP
@@ -83,11 +90,14 @@ public:
 
 
 private:
+  void GetIntensityRange(const mitk::Image::Pointer &image, const mitk::Image::Pointer &mask, double &minimum, double &maximum);
+
   bool m_Initialized;
   unsigned int m_Bins;
   double m_Binsize;
   double m_Minimum;
   double m_Maximum;
+  IntensityRangeCache::Pointer m_RangeCache;
 
 };
 }
@@ -0,0 +1,81 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#ifndef mitkIntensityRangeCache_h
+#define mitkIntensityRangeCache_h
+
+#include <MitkCLCoreExports.h>
+
+#include <mitkImage.h>
+
+#include <itkLightObject.h>
+
+#include <future>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace mitk
+{
+  /**
+  * \brief Thread safe cache of the intensity ranges of images and masked image regions.
+  *
+  * Every IntensityQuantifier that is initialized from an image needs the minimum and maximum
+  * intensity of the image or of the masked region. If several feature classes are calculated for
+  * the same image and mask, a shared cache ensures that each range is computed only once. The range
+  * is computed again if the image or the mask has been modified. If several threads request the same
+  * range at once, only the first one computes it while the others wait for its result.
+  */
+class MITKCLCORE_EXPORT IntensityRangeCache : public itk::LightObject
+{
+public:
+  mitkClassMacroItkParent(IntensityRangeCache, itk::LightObject)
+    itkFactorylessNewMacro(Self)
+
+  /**
+  * \brief Returns the range of all voxels of image, or of all voxels with a mask value greater than 0 if a mask is given.
+  */
+  void GetRange(const Image::Pointer &image, const Image::Pointer &mask, double &minimum, double &maximum);
+
+  /**
+  * \brief Removes all cached ranges and releases the referenced images.
+  */
+  void Clear();
+
+  /**
+  * \brief Computes the range without using a cache.
+  */
+  static void CalculateRange(const Image::Pointer &image, const Image::Pointer &mask, double &minimum, double &maximum);
+
+private:
+  typedef std::pair<double, double> RangeType;
+
+  struct CacheEntry
+  {
+    Image::Pointer Image;
+    Image::Pointer Mask;
+    itk::ModifiedTimeType ImageTime;
+    itk::ModifiedTimeType MaskTime;
+    std::shared_future<RangeType> Range;
+  };
+
+  std::mutex m_Mutex;
+  std::map<std::pair<const Image *, const Image *>, CacheEntry> m_Entries;
+};
+}
+
+#endif //mitkIntensityRangeCache_h
@@ -19,60 +19,6 @@ See LICENSE.txt or http://www.mitk.org for details.
 // STD
 #include <numeric>
 
-// ITK
-#include <itkImageRegionConstIterator.h>
-
-// MITK
-#include <mitkImageCast.h>
-#include <mitkImageAccessByItk.h>
-
-template<typename TPixel, unsigned int VImageDimension>
-static void
-CalculateImageMinMax(itk::Image<TPixel, VImageDimension>* itkImage, double &minimum, double &maximum)
-{
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
-
-  minimum = std::numeric_limits<TPixel>::max();
-  maximum = std::numeric_limits<TPixel>::lowest();
-
-  itk::ImageRegionConstIterator<ImageType> iter(itkImage, itkImage->GetLargestPossibleRegion());
-
-  while (!iter.IsAtEnd())
-  {
-    minimum = std::min<TPixel>(minimum, iter.Get());
-    maximum = std::max<TPixel>(maximum, iter.Get());
-    ++iter;
-  }
-}
-
-template<typename TPixel, unsigned int VImageDimension>
-static void
-CalculateImageRegionMinMax(itk::Image<TPixel, VImageDimension>* itkImage, mitk::Image::Pointer mask, double &minimum, double &maximum)
-{
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
-  typedef itk::Image<int, VImageDimension> MaskType;
-
-  typename MaskType::Pointer itkMask = MaskType::New();
-  mitk::CastToItkImage(mask, itkMask);
-
-  minimum = std::numeric_limits<TPixel>::max();
-  maximum = std::numeric_limits<TPixel>::lowest();
-
-  itk::ImageRegionConstIterator<ImageType> iter(itkImage, itkImage->GetLargestPossibleRegion());
-  itk::ImageRegionConstIterator<MaskType> maskIter(itkMask, itkMask->GetLargestPossibleRegion());
-
-  while (!iter.IsAtEnd())
-  {
-    if (maskIter.Get() > 0)
-    {
-      minimum = std::min<TPixel>(minimum, iter.Get());
-      maximum = std::max<TPixel>(maximum, iter.Get());
-    }
-    ++iter;
-    ++maskIter;
-  }
-}
-
 mitk::IntensityQuantifier::IntensityQuantifier() :
       m_Initialized(false),
       m_Bins(0),
@@ -81,6 +27,14 @@ mitk::IntensityQuantifier::IntensityQuantifier() :
       m_Maximum(0)
 {}
 
+void mitk::IntensityQuantifier::GetIntensityRange(const mitk::Image::Pointer &image, const mitk::Image::Pointer &mask, double &minimum, double &maximum)
+{
+  if (m_RangeCache.IsNotNull())
+    m_RangeCache->GetRange(image, mask, minimum, maximum);
+  else
+    IntensityRangeCache::CalculateRange(image, mask, minimum, maximum);
+}
+
 void mitk::IntensityQuantifier::InitializeByMinimumMaximum(double minimum, double maximum, unsigned int bins) {
   m_Minimum = minimum;
   m_Maximum = maximum;
@@ -107,73 +61,73 @@ void mitk::IntensityQuantifier::InitializeByBinsizeAndMaximum(double minimum, do
 
 void mitk::IntensityQuantifier::InitializeByImage(mitk::Image::Pointer image, unsigned int bins) {
   double minimum, maximum;
-  AccessByItk_2(image, CalculateImageMinMax, minimum, maximum);
+  GetIntensityRange(image, nullptr, minimum, maximum);
   InitializeByMinimumMaximum(minimum, maximum, bins);
 }
 
 void mitk::IntensityQuantifier::InitializeByImageAndMinimum(mitk::Image::Pointer image, double minimum, unsigned int bins) {
   double tmp, maximum;
-  AccessByItk_2(image, CalculateImageMinMax, tmp, maximum);
+  GetIntensityRange(image, nullptr, tmp, maximum);
   InitializeByMinimumMaximum(minimum, maximum, bins);
 }
 
 void mitk::IntensityQuantifier::InitializeByImageAndMaximum(mitk::Image::Pointer image, double maximum, unsigned int bins) {
   double minimum, tmp;
-  AccessByItk_2(image, CalculateImageMinMax, minimum, tmp);
+  GetIntensityRange(image, nullptr, minimum, tmp);
   InitializeByMinimumMaximum(minimum, maximum, bins);
 }
 
 void mitk::IntensityQuantifier::InitializeByImageRegion(mitk::Image::Pointer image, mitk::Image::Pointer mask, unsigned int bins) {
   double minimum, maximum;
-  AccessByItk_3(image, CalculateImageRegionMinMax, mask, minimum, maximum);
+  GetIntensityRange(image, mask, minimum, maximum);
   InitializeByMinimumMaximum(minimum, maximum, bins);
 }
 
 void mitk::IntensityQuantifier::InitializeByImageRegionAndMinimum(mitk::Image::Pointer image, mitk::Image::Pointer mask, double minimum, unsigned int bins) {
   double tmp, maximum;
-  AccessByItk_3(image, CalculateImageRegionMinMax, mask, tmp, maximum);
+  GetIntensityRange(image, mask, tmp, maximum);
   InitializeByMinimumMaximum(minimum, maximum, bins);
 }
 
 void mitk::IntensityQuantifier::InitializeByImageRegionAndMaximum(mitk::Image::Pointer image, mitk::Image::Pointer mask, double maximum, unsigned int bins) {
   double minimum, tmp;
-  AccessByItk_3(image, CalculateImageRegionMinMax, mask, minimum, tmp);
+  GetIntensityRange(image, mask, minimum, tmp);
   InitializeByMinimumMaximum(minimum, maximum, bins);
 }
 
 void mitk::IntensityQuantifier::InitializeByImageAndBinsize(mitk::Image::Pointer image, double binsize) {
   double minimum, maximum;
-  AccessByItk_2(image, CalculateImageMinMax, minimum, maximum);
+  GetIntensityRange(image, nullptr, minimum, maximum);
   InitializeByBinsizeAndMaximum(minimum, maximum, binsize);
 }
 
 void mitk::IntensityQuantifier::InitializeByImageAndBinsizeAndMinimum(mitk::Image::Pointer image, double minimum, double binsize) {
   double tmp, maximum;
-  AccessByItk_2(image, CalculateImageMinMax, tmp, maximum);
+  GetIntensityRange(image, nullptr, tmp, maximum);
   InitializeByBinsizeAndMaximum(minimum, maximum, binsize);
 }
 
 void mitk::IntensityQuantifier::InitializeByImageAndBinsizeAndMaximum(mitk::Image::Pointer image, double maximum, double binsize) {
   double minimum, tmp;
-  AccessByItk_2(image, CalculateImageMinMax, minimum, tmp);
+  GetIntensityRange(image, nullptr, minimum, tmp);
   InitializeByBinsizeAndMaximum(minimum, maximum, binsize);
 }
 
 void mitk::IntensityQuantifier::InitializeByImageRegionAndBinsize(mitk::Image::Pointer image, mitk::Image::Pointer mask, double binsize) {
   double minimum, maximum;
-  AccessByItk_3(image, CalculateImageRegionMinMax, mask, minimum, maximum);
+  GetIntensityRange(image, mask, minimum, maximum);
   InitializeByBinsizeAndMaximum(minimum, maximum, binsize);
 }
 
 void mitk::IntensityQuantifier::InitializeByImageRegionAndBinsizeAndMinimum(mitk::Image::Pointer image, mitk::Image::Pointer mask, double minimum, double binsize) {
   double tmp, maximum;
-  AccessByItk_3(image, CalculateImageRegionMinMax, mask, tmp, maximum);
+  GetIntensityRange(image, mask, tmp, maximum);
   InitializeByBinsizeAndMaximum(minimum, maximum, binsize);
 }
 
 void mitk::IntensityQuantifier::InitializeByImageRegionAndBinsizeAndMaximum(mitk::Image::Pointer image, mitk::Image::Pointer mask, double maximum, double binsize) {
   double minimum, tmp;
-  AccessByItk_3(image, CalculateImageRegionMinMax, mask, minimum, tmp);
+  GetIntensityRange(image, mask, minimum, tmp);
   InitializeByBinsizeAndMaximum(minimum, maximum, binsize);
 }
 
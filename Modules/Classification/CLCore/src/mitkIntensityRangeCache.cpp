@@ -0,0 +1,142 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkIntensityRangeCache.h>
+
+// STD
+#include <limits>
+
+// ITK
+#include <itkImageRegionConstIterator.h>
+
+// MITK
+#include <mitkImageCast.h>
+#include <mitkImageAccessByItk.h>
+
+template<typename TPixel, unsigned int VImageDimension>
+static void
+CalculateImageMinMax(itk::Image<TPixel, VImageDimension>* itkImage, double &minimum, double &maximum)
+{
+  typedef itk::Image<TPixel, VImageDimension> ImageType;
+
+  minimum = std::numeric_limits<TPixel>::max();
+  maximum = std::numeric_limits<TPixel>::lowest();
+
+  itk::ImageRegionConstIterator<ImageType> iter(itkImage, itkImage->GetLargestPossibleRegion());
+
+  while (!iter.IsAtEnd())
+  {
+    minimum = std::min<TPixel>(minimum, iter.Get());
+    maximum = std::max<TPixel>(maximum, iter.Get());
+    ++iter;
+  }
+}
+
+template<typename TPixel, unsigned int VImageDimension>
+static void
+CalculateImageRegionMinMax(itk::Image<TPixel, VImageDimension>* itkImage, mitk::Image::Pointer mask, double &minimum, double &maximum)
+{
+  typedef itk::Image<TPixel, VImageDimension> ImageType;
+  typedef itk::Image<int, VImageDimension> MaskType;
+
+  typename MaskType::Pointer itkMask = MaskType::New();
+  mitk::CastToItkImage(mask, itkMask);
+
+  minimum = std::numeric_limits<TPixel>::max();
+  maximum = std::numeric_limits<TPixel>::lowest();
+
+  itk::ImageRegionConstIterator<ImageType> iter(itkImage, itkImage->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<MaskType> maskIter(itkMask, itkMask->GetLargestPossibleRegion());
+
+  while (!iter.IsAtEnd())
+  {
+    if (maskIter.Get() > 0)
+    {
+      minimum = std::min<TPixel>(minimum, iter.Get());
+      maximum = std::max<TPixel>(maximum, iter.Get());
+    }
+    ++iter;
+    ++maskIter;
+  }
+}
+
+void mitk::IntensityRangeCache::CalculateRange(const Image::Pointer &image, const Image::Pointer &mask, double &minimum, double &maximum)
+{
+  if (mask.IsNull())
+  {
+    AccessByItk_2(image, CalculateImageMinMax, minimum, maximum);
+  }
+  else
+  {
+    AccessByItk_3(image, CalculateImageRegionMinMax, mask, minimum, maximum);
+  }
+}
+
+void mitk::IntensityRangeCache::GetRange(const Image::Pointer &image, const Image::Pointer &mask, double &minimum, double &maximum)
+{
+  const itk::ModifiedTimeType imageTime = image->GetMTime();
+  const itk::ModifiedTimeType maskTime = mask.IsNull() ? 0 : mask->GetMTime();
+
+  std::shared_future<RangeType> range;
+  std::promise<RangeType> promise;
+  bool calculate = false;
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    CacheEntry &entry = m_Entries[std::make_pair(image.GetPointer(), mask.GetPointer())];
+    if (!entry.Range.valid() || entry.ImageTime != imageTime || entry.MaskTime != maskTime)
+    {
+      // The entry keeps both images alive, so that their addresses cannot be reused by other images
+      entry.Image = image;
+      entry.Mask = mask;
+      entry.ImageTime = imageTime;
+      entry.MaskTime = maskTime;
+      entry.Range = promise.get_future().share();
+      calculate = true;
+    }
+    range = entry.Range;
+  }
+
+  if (calculate)
+  {
+    try
+    {
+      RangeType result;
+      CalculateRange(image, mask, result.first, result.second);
+      promise.set_value(result);
+    }
+    catch (...)
+    {
+      promise.set_exception(std::current_exception());
+
+      // Failed calculations are not cached, later requests try again
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      auto iter = m_Entries.find(std::make_pair(image.GetPointer(), mask.GetPointer()));
+      if (iter != m_Entries.end() && iter->second.ImageTime == imageTime && iter->second.MaskTime == maskTime)
+        m_Entries.erase(iter);
+    }
+  }
+
+  // Rethrows the exception of the thread that computed the range
+  const RangeType &result = range.get();
+  minimum = result.first;
+  maximum = result.second;
+}
+
+void mitk::IntensityRangeCache::Clear()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Entries.clear();
+}
@@ -65,12 +65,25 @@ namespace mitk
     void SetGamma(double val);
     void SetCoef0(double val);
 
+    /**
+    * \brief Predicts blocks of samples at once (default true).
+    *
+    * For the linear, polynomial, RBF and sigmoid kernel the kernel values of a block of samples and all
+    * support vectors are obtained from one matrix product, and the blocks are distributed over several
+    * threads. The results equal those of svm_predict up to rounding. Models with precomputed kernels
+    * are always predicted sample by sample.
+    */
+    void UseBatchedPrediction(bool val);
+
   private:
 
     void ReadXValues(LibSVM::svm_problem * problem, LibSVM::svm_node** xSpace, const Eigen::MatrixXd &X);
     void ReadYValues(LibSVM::svm_problem * problem, const Eigen::MatrixXi &Y);
     void ReadWValues(LibSVM::svm_problem * problem);
 
+    Eigen::MatrixXi PredictSampleWise(const Eigen::MatrixXd &X) const;
+    Eigen::MatrixXi PredictBatched(const Eigen::MatrixXd &X) const;
+
     LibSVM::svm_model* m_Model;
     LibSVM::svm_parameter * m_Parameter;
 
@@ -23,6 +23,29 @@ namespace LibSVM
 }
 #include <mitkExceptionMacro.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  // Same evaluation order as powi() of libsvm, so that polynomial kernels give identical values
+  double IntegerPower(double base, int times)
+  {
+    double tmp = base, ret = 1.0;
+    for (int t = times; t > 0; t /= 2)
+    {
+      if (t % 2 == 1) ret *= tmp;
+      tmp = tmp * tmp;
+    }
+    return ret;
+  }
+}
+
 mitk::LibSVMClassifier::LibSVMClassifier():
   m_Model(nullptr),m_Parameter(nullptr)
 {
@@ -76,6 +99,21 @@ Eigen::MatrixXi mitk::LibSVMClassifier::Predict(const Eigen::MatrixXd &X)
   {
     mitkThrow() << "No Model is trained. Train or load a model before predicting new values.";
   }
+
+  bool useBatchedPrediction = true;
+  this->GetPropertyList()->Get("classifier.svm.batched-prediction", useBatchedPrediction);
+
+  const int kernelType = m_Model->param.kernel_type;
+  if (useBatchedPrediction && (kernelType == LibSVM::LINEAR || kernelType == LibSVM::POLY ||
+                               kernelType == LibSVM::RBF || kernelType == LibSVM::SIGMOID))
+  {
+    return PredictBatched(X);
+  }
+  return PredictSampleWise(X);
+}
+
+Eigen::MatrixXi mitk::LibSVMClassifier::PredictSampleWise(const Eigen::MatrixXd &X) const
+{
   auto noOfPoints = static_cast<int>(X.rows());
   auto noOfFeatures = static_cast<int>(X.cols());
 
@@ -97,6 +135,159 @@ Eigen::MatrixXi mitk::LibSVMClassifier::Predict(const Eigen::MatrixXd &X)
   return result;
 }
 
+Eigen::MatrixXi mitk::LibSVMClassifier::PredictBatched(const Eigen::MatrixXd &X) const
+{
+  const LibSVM::svm_model * model = m_Model;
+  const LibSVM::svm_parameter & param = model->param;
+  const auto noOfPoints = static_cast<Eigen::Index>(X.rows());
+  const auto noOfFeatures = static_cast<Eigen::Index>(X.cols());
+  const int noOfSV = model->l;
+
+  // Dense copy of the support vectors. Components beyond the number of features are zero in every
+  // sample and only contribute to the squared norms of the support vectors.
+  Eigen::MatrixXd supportVectors = Eigen::MatrixXd::Zero(noOfSV, noOfFeatures);
+  Eigen::VectorXd supportVectorNorms = Eigen::VectorXd::Zero(noOfSV);
+  for (int sv = 0; sv < noOfSV; ++sv)
+  {
+    for (const LibSVM::svm_node * node = model->SV[sv]; node->index != -1; ++node)
+    {
+      if (node->index >= 1 && node->index <= noOfFeatures)
+        supportVectors(sv, node->index - 1) = node->value;
+      supportVectorNorms(sv) += node->value * node->value;
+    }
+  }
+
+  // The decision values of all one-against-one classifiers (or the single decision function of
+  // one-class and regression models) are a weighted sum of the kernel values, i.e. another product
+  const bool isClassification = param.svm_type == LibSVM::C_SVC || param.svm_type == LibSVM::NU_SVC;
+  const int noOfClasses = model->nr_class;
+  const int noOfDecisions = isClassification ? noOfClasses * (noOfClasses - 1) / 2 : 1;
+  Eigen::MatrixXd coefficients = Eigen::MatrixXd::Zero(noOfSV, noOfDecisions);
+  Eigen::RowVectorXd rho(noOfDecisions);
+  if (isClassification)
+  {
+    std::vector<int> start(noOfClasses, 0);
+    for (int i = 1; i < noOfClasses; ++i)
+      start[i] = start[i-1] + model->nSV[i-1];
+
+    int p = 0;
+    for (int i = 0; i < noOfClasses; ++i)
+    {
+      for (int j = i + 1; j < noOfClasses; ++j, ++p)
+      {
+        for (int k = 0; k < model->nSV[i]; ++k)
+          coefficients(start[i] + k, p) = model->sv_coef[j-1][start[i] + k];
+        for (int k = 0; k < model->nSV[j]; ++k)
+          coefficients(start[j] + k, p) = model->sv_coef[i][start[j] + k];
+        rho(p) = model->rho[p];
+      }
+    }
+  }
+  else
+  {
+    for (int sv = 0; sv < noOfSV; ++sv)
+      coefficients(sv, 0) = model->sv_coef[0][sv];
+    rho(0) = model->rho[0];
+  }
+
+  // Limit the kernel block of one thread to about 16 MB
+  const Eigen::Index blockSize = std::max<Eigen::Index>(32, std::min<Eigen::Index>(4096, (Eigen::Index(1) << 21) / std::max(noOfSV, 1)));
+  const Eigen::Index noOfBlocks = (noOfPoints + blockSize - 1) / blockSize;
+
+  Eigen::MatrixXi result(noOfPoints, 1);
+  std::atomic<Eigen::Index> nextBlock(0);
+  std::exception_ptr exception;
+  std::mutex exceptionMutex;
+
+  auto worker = [&]()
+  {
+    Eigen::MatrixXd kernel;
+    Eigen::MatrixXd decisions;
+    std::vector<int> vote(noOfClasses);
+    for (Eigen::Index block = nextBlock++; block < noOfBlocks; block = nextBlock++)
+    {
+      const Eigen::Index first = block * blockSize;
+      const Eigen::Index rows = std::min(blockSize, noOfPoints - first);
+      auto samples = X.middleRows(first, rows);
+
+      try
+      {
+        kernel.noalias() = samples * supportVectors.transpose();
+        switch (param.kernel_type)
+        {
+        case LibSVM::LINEAR:
+          break;
+        case LibSVM::POLY:
+          kernel = kernel.unaryExpr([&param](double dot) { return IntegerPower(param.gamma * dot + param.coef0, param.degree); });
+          break;
+        case LibSVM::RBF:
+        {
+          const Eigen::VectorXd sampleNorms = samples.rowwise().squaredNorm();
+          for (Eigen::Index sv = 0; sv < noOfSV; ++sv)
+          {
+            for (Eigen::Index i = 0; i < rows; ++i)
+            {
+              const double distance = std::max(0.0, sampleNorms(i) + supportVectorNorms(sv) - 2 * kernel(i, sv));
+              kernel(i, sv) = std::exp(-param.gamma * distance);
+            }
+          }
+          break;
+        }
+        case LibSVM::SIGMOID:
+          kernel = kernel.unaryExpr([&param](double dot) { return std::tanh(param.gamma * dot + param.coef0); });
+          break;
+        }
+
+        decisions.noalias() = kernel * coefficients;
+        decisions.rowwise() -= rho;
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(exceptionMutex);
+        if (!exception)
+          exception = std::current_exception();
+        nextBlock = noOfBlocks;
+        return;
+      }
+
+      for (Eigen::Index i = 0; i < rows; ++i)
+      {
+        if (!isClassification)
+        {
+          const double value = decisions(i, 0);
+          result(first + i, 0) = param.svm_type == LibSVM::ONE_CLASS ? (value > 0 ? 1 : -1) : static_cast<int>(value);
+          continue;
+        }
+
+        // Voting of the one-against-one classifiers as in svm_predict_values
+        std::fill(vote.begin(), vote.end(), 0);
+        int p = 0;
+        for (int c1 = 0; c1 < noOfClasses; ++c1)
+          for (int c2 = c1 + 1; c2 < noOfClasses; ++c2, ++p)
+            ++vote[decisions(i, p) > 0 ? c1 : c2];
+
+        int maxClass = 0;
+        for (int c = 1; c < noOfClasses; ++c)
+          if (vote[c] > vote[maxClass])
+            maxClass = c;
+        result(first + i, 0) = model->label[maxClass];
+      }
+    }
+  };
+
+  const Eigen::Index noOfThreads = std::max<Eigen::Index>(1, std::min<Eigen::Index>(noOfBlocks, std::thread::hardware_concurrency()));
+  std::vector<std::thread> threads;
+  for (Eigen::Index t = 1; t < noOfThreads; ++t)
+    threads.emplace_back(worker);
+  worker();
+  for (auto & thread : threads)
+    thread.join();
+
+  if (exception)
+    std::rethrow_exception(exception);
+  return result;
+}
+
 void  mitk::LibSVMClassifier::ConvertParameter()
 {
   // Get the proerty                                                                      // Some defaults
@@ -211,6 +402,11 @@ void mitk::LibSVMClassifier::SetCoef0(double val)
   this->GetPropertyList()->SetDoubleProperty("classifier.svm.coef0",val);
 }
 
+void mitk::LibSVMClassifier::UseBatchedPrediction(bool val)
+{
+  this->GetPropertyList()->SetBoolProperty("classifier.svm.batched-prediction",val);
+}
+
 void mitk::LibSVMClassifier::PrintParameter(std::ostream & str)
 {
   if(this->m_Parameter == nullptr)
@@ -299,14 +495,15 @@ void mitk::LibSVMClassifier::ReadXValues(LibSVM::svm_problem * problem, LibSVM::
 
   for (int row = 0; row < noOfPoints; ++row)
   {
+    // Every row needs features+1 nodes for the terminator, and libsvm indices start with 1 like in Predict
     for (int col = 0; col < features; ++col)
     {
-      (*xSpace)[row*features + col].index = col;
-      (*xSpace)[row*features + col].value = X(row,col);
+      (*xSpace)[row*(features+1) + col].index = col+1;
+      (*xSpace)[row*(features+1) + col].value = X(row,col);
     }
-    (*xSpace)[row*features + features].index = -1;
+    (*xSpace)[row*(features+1) + features].index = -1;
 
-    problem->x[row] = &((*xSpace)[row*features]);
+    problem->x[row] = &((*xSpace)[row*(features+1)]);
   }
 }
 
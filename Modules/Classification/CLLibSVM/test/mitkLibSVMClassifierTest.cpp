@@ -34,6 +34,7 @@ class mitkLibSVMClassifierTestSuite : public mitk::TestFixture
   CPPUNIT_TEST_SUITE(mitkLibSVMClassifierTestSuite);
   MITK_TEST(TrainSVMClassifier_MatlabDataSet_shouldReturnTrue);
   MITK_TEST(TrainSVMClassifier_BreastCancerDataSet_shouldReturnTrue);
+  MITK_TEST(BatchedPrediction_BreastCancerDataSet_MatchesSampleWisePrediction);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -306,6 +307,37 @@ public:
     MITK_TEST_CONDITION(isIntervall<int>(m_TestYPredict,classes,75,100),"Testvalue is in range.");
   }
 
+  /*
+  The batched prediction has to give the same labels as libsvm for every kernel
+  */
+  void BatchedPrediction_BreastCancerDataSet_MatchesSampleWisePrediction()
+  {
+    std::pair<MatrixDoubleType,MatrixDoubleType> matrixDouble;
+    matrixDouble = convertCSVToMatrix<double>(GetTestDataFilePath("Classification/FeaturematrixBreastcancer.csv"),';',0.5,true);
+    m_TrainingMatrixX = matrixDouble.first;
+    m_TestXPredict = matrixDouble.second;
+
+    std::pair<MatrixIntType,MatrixIntType> matrixInt;
+    matrixInt = convertCSVToMatrix<int>(GetTestDataFilePath("Classification/LabelmatrixBreastcancer.csv"),';',0.5,false);
+    m_TrainingLabelMatrixY = matrixInt.first;
+
+    for (int kernelType = 0; kernelType < 4; ++kernelType)
+    {
+      classifier = mitk::LibSVMClassifier::New();
+      classifier->SetGamma(1/(double)(m_TrainingMatrixX.cols()));
+      classifier->SetSvmType(0);
+      classifier->SetKernelType(kernelType);
+      classifier->Train(m_TrainingMatrixX,m_TrainingLabelMatrixY);
+
+      classifier->UseBatchedPrediction(false);
+      Eigen::MatrixXi expected = classifier->Predict(m_TestXPredict);
+      classifier->UseBatchedPrediction(true);
+      Eigen::MatrixXi classes = classifier->Predict(m_TestXPredict);
+
+      MITK_TEST_CONDITION(isEqual<int>(expected,classes),"Batched prediction matches libsvm for kernel " << kernelType);
+    }
+  }
+
   void TestThreadedDecisionForest()
   {
   }
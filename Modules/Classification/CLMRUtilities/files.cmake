@@ -3,6 +3,7 @@ file(GLOB_RECURSE H_FILES RELATIVE "${CMAKE_CURRENT_SOURCE_DIR}" "${CMAKE_CURREN
 set(CPP_FILES
   MRNormalization/mitkMRNormTwoRegionBasedFilter.cpp
   MRNormalization/mitkMRNormLinearStatisticBasedFilter.cpp
+  MRNormalization/mitkN4BiasFieldCorrectionFilter.cpp
 )
 
 set( TOOL_FILES
@@ -0,0 +1,107 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKN4BIASFIELDCORRECTIONFILTER_H
+#define MITKN4BIASFIELDCORRECTIONFILTER_H
+
+#include "mitkCommon.h"
+#include "MitkCLMRUtilitiesExports.h"
+#include "mitkImageToImageFilter.h"
+
+namespace mitk {
+  //##Documentation
+  //## @brief N4 bias field correction of 3D images, estimated on a shrunken image
+  //##
+  //## The bias field is estimated by itk::N4BiasFieldCorrectionImageFilter on a copy of the input (and of the
+  //## optional mask) that is shrunken by ShrinkFactor in each direction. The smooth field is then reconstructed at
+  //## the full resolution of the input from the B-spline control point lattice of N4, in one multi-threaded
+  //## evaluation pass. Output 0 is the corrected image, output 1 (GetBiasField()) the multiplicative bias field,
+  //## both with float pixels.
+  //##
+  //## If a bias field is set with SetBiasField(), e.g. the output 1 of a run on another image of the same session,
+  //## no estimation takes place and the input is only divided by it.
+  //##
+  //## ShrinkFactor 1 estimates at full resolution. The other parameters are passed to N4, their defaults are the
+  //## ITK defaults.
+  //## @ingroup Process
+  class MITKCLMRUTILITIES_EXPORT N4BiasFieldCorrectionFilter : public ImageToImageFilter
+  {
+  public:
+    mitkClassMacro(N4BiasFieldCorrectionFilter, ImageToImageFilter);
+
+    itkFactorylessNewMacro(Self);
+    itkCloneMacro(Self);
+
+    /** Voxels other than 0 are used for the estimation, all voxels if no mask is set */
+    void SetMask( const mitk::Image* mask );
+    const mitk::Image* GetMask() const;
+
+    /** Precomputed bias field with the geometry of the input, skips the estimation if set */
+    void SetBiasField( const mitk::Image* biasField );
+    const mitk::Image* GetPrecomputedBiasField() const;
+
+    /** The estimated (or the precomputed) bias field */
+    mitk::Image* GetBiasField();
+
+    itkGetConstMacro(ShrinkFactor, unsigned int);
+    itkSetMacro(ShrinkFactor, unsigned int);
+
+    itkGetConstMacro(NumberOfControlPoints, unsigned int);
+    itkSetMacro(NumberOfControlPoints, unsigned int);
+
+    itkGetConstMacro(NumberOfFittingLevels, unsigned int);
+    itkSetMacro(NumberOfFittingLevels, unsigned int);
+
+    itkGetConstMacro(NumberOfHistogramBins, unsigned int);
+    itkSetMacro(NumberOfHistogramBins, unsigned int);
+
+    itkGetConstMacro(SplineOrder, unsigned int);
+    itkSetMacro(SplineOrder, unsigned int);
+
+    itkGetConstMacro(WienerFilterNoise, double);
+    itkSetMacro(WienerFilterNoise, double);
+
+    /** Maximum number of iterations of every fitting level */
+    itkGetConstMacro(MaximumNumberOfIterations, unsigned int);
+    itkSetMacro(MaximumNumberOfIterations, unsigned int);
+
+    itkGetConstMacro(ConvergenceThreshold, double);
+    itkSetMacro(ConvergenceThreshold, double);
+
+  protected:
+    N4BiasFieldCorrectionFilter();
+
+    ~N4BiasFieldCorrectionFilter() override;
+
+    void GenerateInputRequestedRegion() override;
+
+    void GenerateOutputInformation() override;
+
+    void GenerateData() override;
+
+  private:
+    unsigned int m_ShrinkFactor;
+    unsigned int m_NumberOfControlPoints;
+    unsigned int m_NumberOfFittingLevels;
+    unsigned int m_NumberOfHistogramBins;
+    unsigned int m_SplineOrder;
+    double m_WienerFilterNoise;
+    unsigned int m_MaximumNumberOfIterations;
+    double m_ConvergenceThreshold;
+  };
+} // namespace mitk
+
+#endif /* MITKN4BIASFIELDCORRECTIONFILTER_H */
@@ -0,0 +1,236 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkN4BiasFieldCorrectionFilter.h"
+
+// MITK
+#include <mitkException.h>
+#include <mitkITKImageImport.h>
+#include <mitkImageCast.h>
+// ITK
+#include <itkBSplineControlPointImageFilter.h>
+#include <itkBinaryThresholdImageFilter.h>
+#include <itkImageRegionIterator.h>
+#include <itkN4BiasFieldCorrectionImageFilter.h>
+#include <itkShrinkImageFilter.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+  typedef itk::Image<float, 3> ImageType;
+  typedef itk::Image<unsigned char, 3> MaskImageType;
+  typedef itk::N4BiasFieldCorrectionImageFilter<ImageType, MaskImageType, ImageType> N4FilterType;
+  typedef itk::BSplineControlPointImageFilter<N4FilterType::BiasFieldControlPointLatticeType,
+                                              N4FilterType::ScalarImageType> BSplinerType;
+}
+
+mitk::N4BiasFieldCorrectionFilter::N4BiasFieldCorrectionFilter() :
+m_ShrinkFactor(4),
+m_NumberOfControlPoints(4),
+m_NumberOfFittingLevels(1),
+m_NumberOfHistogramBins(200),
+m_SplineOrder(3),
+m_WienerFilterNoise(0.01),
+m_MaximumNumberOfIterations(50),
+m_ConvergenceThreshold(0.001)
+{
+  this->SetNumberOfIndexedInputs(3);
+  this->SetNumberOfRequiredInputs(1);
+
+  this->SetNumberOfIndexedOutputs(2);
+  this->SetNthOutput(1, this->MakeOutput(1));
+}
+
+mitk::N4BiasFieldCorrectionFilter::~N4BiasFieldCorrectionFilter()
+{
+}
+
+void mitk::N4BiasFieldCorrectionFilter::SetMask( const mitk::Image* mask )
+{
+  // Process object is not const-correct so the const_cast is required here
+  auto* nonconstMask = const_cast< mitk::Image * >( mask );
+  this->SetNthInput(1, nonconstMask );
+}
+
+const mitk::Image* mitk::N4BiasFieldCorrectionFilter::GetMask() const
+{
+  return this->GetInput(1);
+}
+
+void mitk::N4BiasFieldCorrectionFilter::SetBiasField( const mitk::Image* biasField )
+{
+  auto* nonconstBiasField = const_cast< mitk::Image * >( biasField );
+  this->SetNthInput(2, nonconstBiasField );
+}
+
+const mitk::Image* mitk::N4BiasFieldCorrectionFilter::GetPrecomputedBiasField() const
+{
+  return this->GetInput(2);
+}
+
+mitk::Image* mitk::N4BiasFieldCorrectionFilter::GetBiasField()
+{
+  return this->GetOutput(1);
+}
+
+void mitk::N4BiasFieldCorrectionFilter::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  for (unsigned int i = 0; i < this->GetNumberOfInputs(); ++i)
+  {
+    mitk::Image* input = this->GetInput(i);
+    if (input != nullptr)
+      input->SetRequestedRegionToLargestPossibleRegion();
+  }
+}
+
+void mitk::N4BiasFieldCorrectionFilter::GenerateOutputInformation()
+{
+  mitk::Image::ConstPointer input = this->GetInput();
+
+  itkDebugMacro(<< "GenerateOutputInformation()");
+
+  for (unsigned int i = 0; i < 2; ++i)
+  {
+    mitk::Image::Pointer output = this->GetOutput(i);
+    output->Initialize(mitk::MakeScalarPixelType<float>(), *input->GetTimeGeometry());
+    output->SetPropertyList(input->GetPropertyList()->Clone());
+  }
+}
+
+void mitk::N4BiasFieldCorrectionFilter::GenerateData()
+{
+  mitk::Image::ConstPointer input = this->GetInput(0);
+  if (input->GetDimension() != 3)
+    mitkThrow() << "N4 bias field correction works only with 3D images.";
+
+  ImageType::Pointer itkImage;
+  mitk::CastToItkImage(input, itkImage);
+  const ImageType::RegionType region = itkImage->GetLargestPossibleRegion();
+
+  ImageType::Pointer biasField = ImageType::New();
+  biasField->CopyInformation(itkImage);
+  biasField->SetRegions(region);
+  biasField->Allocate();
+
+  const mitk::Image* precomputedBiasField = this->GetPrecomputedBiasField();
+  if (precomputedBiasField != nullptr)
+  {
+    ImageType::Pointer itkPrecomputedBiasField;
+    mitk::CastToItkImage(precomputedBiasField, itkPrecomputedBiasField);
+    if (itkPrecomputedBiasField->GetLargestPossibleRegion().GetSize() != region.GetSize())
+      mitkThrow() << "The bias field does not have the size of the input image.";
+
+    // copied, the input may share its memory with the image it was cast from
+    itk::ImageRegionConstIterator<ImageType> precomputedIter(itkPrecomputedBiasField,
+                                                             itkPrecomputedBiasField->GetLargestPossibleRegion());
+    itk::ImageRegionIterator<ImageType> fieldIter(biasField, region);
+    for (; !fieldIter.IsAtEnd(); ++precomputedIter, ++fieldIter)
+      fieldIter.Set(precomputedIter.Get());
+  }
+  else
+  {
+    const unsigned int shrinkFactor = std::max(1u, m_ShrinkFactor);
+
+    typedef itk::ShrinkImageFilter<ImageType, ImageType> ShrinkerType;
+    ShrinkerType::Pointer shrinker = ShrinkerType::New();
+    shrinker->SetInput(itkImage);
+    shrinker->SetShrinkFactors(shrinkFactor);
+
+    N4FilterType::Pointer n4 = N4FilterType::New();
+    n4->SetInput(shrinker->GetOutput());
+
+    MaskImageType::Pointer itkMask;
+    typedef itk::ShrinkImageFilter<MaskImageType, MaskImageType> MaskShrinkerType;
+    MaskShrinkerType::Pointer maskShrinker = MaskShrinkerType::New();
+    if (this->GetMask() != nullptr)
+    {
+      mitk::CastToItkImage(this->GetMask(), itkMask);
+      if (itkMask->GetLargestPossibleRegion().GetSize() != region.GetSize())
+        mitkThrow() << "The mask does not have the size of the input image.";
+
+      // N4 only uses the voxels with the mask label 1
+      typedef itk::BinaryThresholdImageFilter<MaskImageType, MaskImageType> ThresholdType;
+      ThresholdType::Pointer threshold = ThresholdType::New();
+      threshold->SetInput(itkMask);
+      threshold->SetLowerThreshold(0);
+      threshold->SetUpperThreshold(0);
+      threshold->SetInsideValue(0);
+      threshold->SetOutsideValue(1);
+
+      maskShrinker->SetInput(threshold->GetOutput());
+      maskShrinker->SetShrinkFactors(shrinkFactor);
+      maskShrinker->Update();
+      n4->SetMaskImage(maskShrinker->GetOutput());
+    }
+
+    N4FilterType::ArrayType numberOfControlPoints;
+    numberOfControlPoints.Fill(m_NumberOfControlPoints);
+    n4->SetNumberOfControlPoints(numberOfControlPoints);
+
+    N4FilterType::ArrayType numberOfFittingLevels;
+    numberOfFittingLevels.Fill(m_NumberOfFittingLevels);
+    n4->SetNumberOfFittingLevels(numberOfFittingLevels);
+
+    N4FilterType::VariableSizeArrayType maximumNumberOfIterations(m_NumberOfFittingLevels);
+    maximumNumberOfIterations.Fill(m_MaximumNumberOfIterations);
+    n4->SetMaximumNumberOfIterations(maximumNumberOfIterations);
+
+    n4->SetNumberOfHistogramBins(m_NumberOfHistogramBins);
+    n4->SetSplineOrder(m_SplineOrder);
+    n4->SetWienerFilterNoise(m_WienerFilterNoise);
+    n4->SetConvergenceThreshold(m_ConvergenceThreshold);
+    n4->Update();
+
+    // The control point lattice describes the log field over the whole image domain, so it can be
+    // evaluated on the full resolution grid directly. The evaluation is multi-threaded.
+    BSplinerType::Pointer bspliner = BSplinerType::New();
+    bspliner->SetInput(n4->GetLogBiasFieldControlPointLattice());
+    bspliner->SetSplineOrder(n4->GetSplineOrder());
+    bspliner->SetSize(region.GetSize());
+    bspliner->SetOrigin(itkImage->GetOrigin());
+    bspliner->SetSpacing(itkImage->GetSpacing());
+    bspliner->SetDirection(itkImage->GetDirection());
+    bspliner->Update();
+
+    N4FilterType::ScalarImageType* logField = bspliner->GetOutput();
+    itk::ImageRegionConstIterator<N4FilterType::ScalarImageType> logFieldIter(logField,
+                                                                              logField->GetLargestPossibleRegion());
+    itk::ImageRegionIterator<ImageType> fieldIter(biasField, region);
+    for (; !fieldIter.IsAtEnd(); ++logFieldIter, ++fieldIter)
+      fieldIter.Set(std::exp(logFieldIter.Get()[0]));
+  }
+
+  ImageType::Pointer corrected = ImageType::New();
+  corrected->CopyInformation(itkImage);
+  corrected->SetRegions(region);
+  corrected->Allocate();
+
+  itk::ImageRegionConstIterator<ImageType> inIter(itkImage, region);
+  itk::ImageRegionConstIterator<ImageType> fieldIter(biasField, region);
+  itk::ImageRegionIterator<ImageType> outIter(corrected, region);
+  for (; !outIter.IsAtEnd(); ++inIter, ++fieldIter, ++outIter)
+  {
+    const float field = fieldIter.Get();
+    outIter.Set(field != 0 ? inIter.Get() / field : 0);
+  }
+
+  mitk::GrabItkImageMemory(corrected, this->GetOutput(0), input->GetGeometry());
+  mitk::GrabItkImageMemory(biasField, this->GetOutput(1), input->GetGeometry());
+}
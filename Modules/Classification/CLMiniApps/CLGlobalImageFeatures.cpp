@@ -47,8 +47,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkConvert2Dto3DImageFilter.h>
 
 #include <mitkCLResultWritter.h>
+#include <mitkGlobalImageFeatureScheduler.h>
 #include <mitkVersion.h>
 
+#include <algorithm>
 #include <iostream>
 #include <locale>
 
@@ -415,6 +417,7 @@ int main(int argc, char* argv[])
   parser.addArgument("direction", "dir", mitkCommandLineParser::String, "Int", "Allows to specify the direction for Cooc and RL. 0: All directions, 1: Only single direction (Test purpose), 2,3,4... Without dimension 0,1,2... ", us::Any());
   parser.addArgument("slice-wise", "slice", mitkCommandLineParser::String, "Int", "Allows to specify if the image is processed slice-wise (number giving direction) ", us::Any());
   parser.addArgument("output-mode", "omode", mitkCommandLineParser::Int, "Int", "Defines if the results of an image / slice are written in a single row (0 , default) or column (1).");
+  parser.addArgument("threads", "threads", mitkCommandLineParser::Int, "Int", "Number of feature classes that are calculated in parallel. 0 (default) uses one thread per processor core.", us::Any());
 
   // Miniapp Infos
   parser.setCategory("Classification Tools");
@@ -496,6 +499,12 @@ int main(int argc, char* argv[])
     writeDirection = us::any_cast<int>(parsedArgs["output-mode"]);
   }
 
+  unsigned int numberOfThreads = 0;
+  if (parsedArgs.count("threads"))
+  {
+    numberOfThreads = std::max(0, us::any_cast<int>(parsedArgs["threads"]));
+  }
+
   log << " Check for Resolution -";
   if (param.resampleToFixIsotropic)
   {
@@ -635,6 +644,16 @@ int main(int argc, char* argv[])
 
   std::vector<mitk::AbstractGlobalImageFeature::FeatureListType> allStats;
 
+  // All slices are calculated as one batch, which allows the scheduler to
+  // calculate different feature classes for different slices at the same time.
+  mitk::cl::GlobalImageFeatureScheduler scheduler;
+  scheduler.SetNumberOfThreads(numberOfThreads);
+  for (auto cFeature : features)
+  {
+    log << " Calculating " << cFeature->GetFeatureClassName() << " -";
+    scheduler.AddFeatureClass(cFeature);
+  }
+
   log << " Begin Processing -";
   while (imageToProcess)
   {
@@ -664,14 +683,15 @@ int main(int argc, char* argv[])
       mitk::IOUtil::Save(cMask, param.analysisMaskPath);
     }
 
-    mitk::AbstractGlobalImageFeature::FeatureListType stats;
+    scheduler.AddCase(cImage, cMask, cMaskNoNaN, cMorphMask);
+    ++currentSlice;
+  }
 
-    for (auto cFeature : features)
-    {
-      log << " Calculating " << cFeature->GetFeatureClassName() << " -";
-      cFeature->SetMorphMask(cMorphMask);
-      cFeature->CalculateFeaturesUsingParameters(cImage, cMask, cMaskNoNaN, stats);
-    }
+  scheduler.Compute();
+
+  for (currentSlice = 0; currentSlice < scheduler.GetNumberOfCases(); ++currentSlice)
+  {
+    const mitk::AbstractGlobalImageFeature::FeatureListType &stats = scheduler.GetFeatures(currentSlice);
 
     for (std::size_t i = 0; i < stats.size(); ++i)
     {
@@ -689,7 +709,6 @@ int main(int argc, char* argv[])
     writer.AddResult(description, currentSlice, stats, param.useHeader, addDescription);
 
     allStats.push_back(stats);
-    ++currentSlice;
   }
 
   log << " Process Slicewise -";
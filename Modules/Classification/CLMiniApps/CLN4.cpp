@@ -16,18 +16,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkCommandLineParser.h"
 #include "mitkIOUtil.h"
-#include <mitkImageCast.h>
-#include "mitkCommandLineParser.h"
-#include <itkN4BiasFieldCorrectionImageFilter.h>
-
-#include <itkSTAPLEImageFilter.h>
+#include <mitkN4BiasFieldCorrectionFilter.h>
 
 int main(int argc, char* argv[])
 {
-  typedef itk::Image<unsigned char, 3> MaskImageType;
-  typedef itk::Image<float, 3> ImageType;
-  typedef itk::N4BiasFieldCorrectionImageFilter < ImageType, MaskImageType, ImageType > FilterType;
-
   mitkCommandLineParser parser;
   parser.setTitle("N4 Bias Field Correction");
   parser.setCategory("Classification Command Tools");
@@ -47,7 +39,9 @@ int main(int argc, char* argv[])
   parser.addArgument("spline-order", "so", mitkCommandLineParser::Int, "Parameter", "Define the spline order (default 3)", us::Any(), true);
   parser.addArgument("winer-filter-noise", "wfn", mitkCommandLineParser::Float, "Parameter", "Noise estimate defining the Wiener filter (default 0.01)", us::Any(), true);
   parser.addArgument("number-of-maximum-iterations", "nomi", mitkCommandLineParser::Int, "Parameter", "Spezifies the maximum number of iterations per run", us::Any(), true);
-  // ToDo: Number Of Maximum Iterations durchschleifen
+  parser.addArgument("shrink-factor", "sf", mitkCommandLineParser::Int, "Parameter", "Shrink factor of the image the bias field is estimated on (default 1, full resolution)", us::Any(), true);
+  parser.addArgument("bias-field", "bf", mitkCommandLineParser::InputFile, "Bias field:", "Precomputed bias field, e.g. of another image of the same session, is applied without estimation", us::Any(), true);
+  parser.addArgument("bias-field-output", "bfo", mitkCommandLineParser::OutputFile, "Bias field output:", "Destination of the bias field", us::Any(), true);
 
   std::map<std::string, us::Any> parsedArgs = parser.parseArguments(argc, argv);
 
@@ -58,23 +52,28 @@ int main(int argc, char* argv[])
     return EXIT_SUCCESS;
   }
 
-  MaskImageType::Pointer itkMsk = MaskImageType::New();
   mitk::Image::Pointer img = mitk::IOUtil::Load<mitk::Image>(parsedArgs["mask"].ToString());
-  mitk::CastToItkImage(img, itkMsk);
-
-  ImageType::Pointer itkImage = ImageType::New();
   mitk::Image::Pointer img2 = mitk::IOUtil::Load<mitk::Image>(parsedArgs["input"].ToString());
-  mitk::CastToItkImage(img2, itkImage);
-
-  FilterType::Pointer filter = FilterType::New();
-  filter->SetInput(itkImage);
-  filter->SetMaskImage(itkMsk);
-
 
+  mitk::N4BiasFieldCorrectionFilter::Pointer filter = mitk::N4BiasFieldCorrectionFilter::New();
+  filter->SetInput(img2);
+  filter->SetMask(img);
+  filter->SetShrinkFactor(1);
 
+  if (parsedArgs.count("shrink-factor") > 0)
+  {
+    int variable = us::any_cast<int>(parsedArgs["shrink-factor"]);
+    MITK_INFO << "Shrink factor: " << variable;
+    filter->SetShrinkFactor(variable);
+  }
+  if (parsedArgs.count("bias-field") > 0)
+  {
+    MITK_INFO << "Applying bias field " << parsedArgs["bias-field"].ToString();
+    filter->SetBiasField(mitk::IOUtil::Load<mitk::Image>(parsedArgs["bias-field"].ToString()));
+  }
   if (parsedArgs.count("number-of-controllpoints") > 0)
   {
-    int variable = us::any_cast<int>(parsedArgs["maximum-iterations"]);
+    int variable = us::any_cast<int>(parsedArgs["number-of-controllpoints"]);
     MITK_INFO << "Number of controll points: " << variable;
     filter->SetNumberOfControlPoints(variable);
   }
@@ -106,16 +105,15 @@ int main(int argc, char* argv[])
   {
     int variable = us::any_cast<int>(parsedArgs["number-of-maximum-iterations"]);
     MITK_INFO << "Number of Maximum Iterations: " << variable;
-    auto list = filter->GetMaximumNumberOfIterations();
-    list.Fill(variable);
-    filter->SetMaximumNumberOfIterations(list);
+    filter->SetMaximumNumberOfIterations(variable);
   }
 
   filter->Update();
-  auto out = filter->GetOutput();
-  mitk::Image::Pointer outImg = mitk::Image::New();
-  mitk::CastToMitkImage(out, outImg);
-  mitk::IOUtil::Save(outImg, parsedArgs["output"].ToString());
+  mitk::IOUtil::Save(filter->GetOutput(), parsedArgs["output"].ToString());
+  if (parsedArgs.count("bias-field-output") > 0)
+  {
+    mitk::IOUtil::Save(filter->GetBiasField(), parsedArgs["bias-field-output"].ToString());
+  }
 
   return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -26,10 +26,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkSplitParameterToVector.h>
 #include <mitkProperties.h>
 
-#include <QApplication>
+#include <mitkRenderingManager.h>
+#include <mitkRenderWindow.h>
 #include <mitkStandaloneDataStorage.h>
-#include "QmitkRegisterClasses.h"
-#include "QmitkRenderWindow.h"
 #include "vtkRenderLargeImage.h"
 #include "vtkPNGWriter.h"
 
@@ -51,8 +50,9 @@ void SaveSliceOrImageAsPNG(std::vector<std::string> listOfOutputs, std::string p
 
   // Create a Standalone Datastorage for the single purpose of saving screenshots..
   mitk::StandaloneDataStorage::Pointer ds = mitk::StandaloneDataStorage::New();
-  QmitkRenderWindow renderWindow;
-  renderWindow.GetRenderer()->SetDataStorage(ds);
+  // Rendered offscreen, no display or window system is needed (with an EGL or OSMesa build of VTK)
+  mitk::RenderWindow::Pointer renderWindow = mitk::RenderWindow::NewOffscreen(512, 512);
+  renderWindow->GetRenderer()->SetDataStorage(ds);
 
   int numberOfSegmentations = 0;
   bool isSegmentation = false;
@@ -77,7 +77,7 @@ void SaveSliceOrImageAsPNG(std::vector<std::string> listOfOutputs, std::string p
   auto geo = ds->ComputeBoundingGeometry3D(ds->GetAll());
   mitk::RenderingManager::GetInstance()->InitializeViews(geo);
 
-  mitk::SliceNavigationController::Pointer sliceNaviController = renderWindow.GetSliceNavigationController();
+  mitk::SliceNavigationController::Pointer sliceNaviController = renderWindow->GetSliceNavigationController();
   unsigned int numberOfSteps = 1;
   if (sliceNaviController)
   {
@@ -85,9 +85,6 @@ void SaveSliceOrImageAsPNG(std::vector<std::string> listOfOutputs, std::string p
     sliceNaviController->GetSlice()->SetPos(0);
   }
 
-  renderWindow.show();
-  renderWindow.resize(512, 512);
-
   for (unsigned int currentStep = 0; currentStep < numberOfSteps; ++currentStep)
   {
     if (sliceNaviController)
@@ -95,11 +92,9 @@ void SaveSliceOrImageAsPNG(std::vector<std::string> listOfOutputs, std::string p
       sliceNaviController->GetSlice()->SetPos(currentStep);
     }
 
-    renderWindow.GetRenderer()->PrepareRender();
+    renderWindow->GetRenderer()->PrepareRender();
 
-    vtkRenderWindow* renderWindow2 = renderWindow.GetVtkRenderWindow();
-    mitk::BaseRenderer* baserenderer = mitk::BaseRenderer::GetInstance(renderWindow2);
-    auto vtkRender = baserenderer->GetVtkRenderer();
+    auto vtkRender = renderWindow->GetRenderer()->GetVtkRenderer();
     vtkRender->GetRenderWindow()->WaitForCompletion();
 
     vtkRenderLargeImage* magnifier = vtkRenderLargeImage::New();
@@ -115,6 +110,7 @@ void SaveSliceOrImageAsPNG(std::vector<std::string> listOfOutputs, std::string p
     fileWriter->SetFileName(tmpImageName.c_str());
     fileWriter->Write();
     fileWriter->Delete();
+    magnifier->Delete();
   }
 }
 
@@ -157,12 +153,6 @@ int main(int argc, char* argv[])
 
   auto listOfFiles = mitk::cl::splitString(parsedArgs["image"].ToString(), ';');
 
-  // Create a QTApplication and a Datastorage
-  // This is necessary in order to save screenshots of
-  // each image / slice.
-  QApplication qtapplication(argc, argv);
-  QmitkRegisterClasses();
-
   SaveSliceOrImageAsPNG(listOfFiles, parsedArgs["output"].ToString());
 
   return 0;
@@ -62,6 +62,8 @@ int main(int argc, char* argv[])
   parser.addArgument("precision", "p", mitkCommandLineParser::Float, "Split precision.", "Precision.", mitk::eps,true);
   parser.addArgument("fraction", "f", mitkCommandLineParser::Float, "Fraction of samples per tree.", "Fraction of samples per tree.", 0.6f,true);
   parser.addArgument("replacment", "r", mitkCommandLineParser::Bool, "Sample with replacement.", "Sample with replacement.", true,true);
+  parser.addArgument("binned", "b", mitkCommandLineParser::Bool, "Binned split search.", "Search the splits on features quantized into histogram bins.", false,true);
+  parser.addArgument("bins", "nb", mitkCommandLineParser::Int, "Number of bins.", "Maximal number of bins per feature (at most 256).", 256,true);
 
   // Miniapp Infos
   parser.setCategory("Classification Tools");
@@ -84,6 +86,8 @@ int main(int argc, char* argv[])
   float precision = parsedArgs.count("precision") ? us::any_cast<float>(parsedArgs["precision"]) : mitk::eps;
   float fraction = parsedArgs.count("fraction") ? us::any_cast<float>(parsedArgs["fraction"]) : 0.6;
   bool withreplacement = parsedArgs.count("replacment") ? us::any_cast<float>(parsedArgs["replacment"]) : true;
+  bool binned = parsedArgs.count("binned") ? us::any_cast<bool>(parsedArgs["binned"]) : false;
+  int bins = parsedArgs.count("bins") ? us::any_cast<int>(parsedArgs["bins"]) : 256;
   std::string filt_select =/* parsedArgs.count("select") ? us::any_cast<std::string>(parsedArgs["select"]) :*/ "*.nrrd";
 
   QString filter(filt_select.c_str());
@@ -122,6 +126,8 @@ int main(int argc, char* argv[])
   classifier->SetPrecision(precision);
   classifier->SetSamplesPerTree(fraction);
   classifier->UseSampleWithReplacement(withreplacement);
+  classifier->UseBinnedSplitSearch(binned);
+  classifier->SetNumberOfBins(bins);
 
   classifier->PrintParameter();
   classifier->Train(X,Y);
@@ -3,11 +3,12 @@
 
 #include <itkLocalStatisticFilter.h>
 
-#include <itkNeighborhoodIterator.h>
 #include <itkImageRegionIterator.h>
 #include <itkImageIterator.h>
-#include "itkMinimumMaximumImageCalculator.h"
+#include <itkSeparableNeighborhoodFunctions.h>
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
 
 template< class TInputImageType, class TOuputImageType>
@@ -38,8 +39,7 @@ template< class TInputImageType, class TOuputImageType>
 void
 itk::LocalStatisticFilter<TInputImageType, TOuputImageType>::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, ThreadIdType /*threadId*/)
 {
-  typedef itk::ImageRegionIterator<TInputImageType> IteratorType;
-  typedef itk::ConstNeighborhoodIterator<TInputImageType> ConstIteratorType;
+  typedef itk::ImageRegionIterator<TOuputImageType> IteratorType;
 
   typename TInputImageType::SizeType size; size.Fill(m_Size);
   InputImagePointer input = this->GetInput(0);
@@ -49,6 +49,28 @@ itk::LocalStatisticFilter<TInputImageType, TOuputImageType>::ThreadedGenerateDat
     size[2] = 0;
   }
 
+  // Sums, minimum and maximum of the neighbourhood are separable and are calculated
+  // with one sliding window pass per axis instead of visiting every neighbour
+  std::vector<double> sum;
+  std::vector<std::size_t> shape;
+  itk::SeparableNeighborhood::FillPaddedBuffer(input.GetPointer(), outputRegionForThread, size, sum, shape,
+    [](typename TInputImageType::PixelType value) { return static_cast<double>(value); });
+  std::vector<double> squaredSum(sum.size());
+  std::transform(sum.begin(), sum.end(), squaredSum.begin(), [](double value) { return value*value; });
+  std::vector<double> minimum(sum);
+  std::vector<double> maximum(sum);
+
+  double numberOfNeighbours = 1;
+  for (unsigned int d = 0; d < TInputImageType::ImageDimension; ++d)
+  {
+    numberOfNeighbours *= 2 * size[d] + 1;
+    itk::SeparableNeighborhood::SlidingWindowAlongAxis(sum, shape, d, size[d], itk::SeparableNeighborhood::SumOperation());
+    itk::SeparableNeighborhood::SlidingWindowAlongAxis(squaredSum, shape, d, size[d], itk::SeparableNeighborhood::SumOperation());
+    itk::SeparableNeighborhood::SlidingWindowAlongAxis(minimum, shape, d, size[d], itk::SeparableNeighborhood::MinimumOperation());
+    itk::SeparableNeighborhood::SlidingWindowAlongAxis(maximum, shape, d, size[d], itk::SeparableNeighborhood::MaximumOperation());
+    shape[d] -= 2 * size[d];
+  }
+
 //  MITK_INFO << "Creating output iterator";
   std::vector<IteratorType> iterVector;
   for (int i = 0; i < m_Bins; ++i)
@@ -57,39 +79,22 @@ itk::LocalStatisticFilter<TInputImageType, TOuputImageType>::ThreadedGenerateDat
     iterVector.push_back(iter);
   }
 
-  ConstIteratorType inputIter(size, input, outputRegionForThread);
-  while (!inputIter.IsAtEnd())
+  // The buffers have the shape of the output region, with axis 0 running fastest like the iterators
+  for (std::size_t voxel = 0; voxel < sum.size(); ++voxel)
   {
-    for (int i = 0; i < m_Bins; ++i)
-    {
-      iterVector[i].Set(0);
-    }
-
-    double min = std::numeric_limits<double>::max();
-    double max = std::numeric_limits<double>::lowest();
-    double mean = 0;
-    double std = 0;
-
-    for (unsigned int i = 0; i < inputIter.Size(); ++i)
-    {
-      double value = inputIter.GetPixel(i);
-      min = std::min<double>(min, value);
-      max = std::max<double>(max, value);
-      mean += value / inputIter.Size();
-      std += (value*value) / inputIter.Size();
-    }
+    double mean = sum[voxel] / numberOfNeighbours;
+    double meanOfSquares = squaredSum[voxel] / numberOfNeighbours;
 
-    iterVector[0].Value() = min;
-    iterVector[1].Value() = max;
+    iterVector[0].Value() = minimum[voxel];
+    iterVector[1].Value() = maximum[voxel];
     iterVector[2].Value() = mean;
-    iterVector[3].Value() = std::sqrt(std - mean*mean);
-    iterVector[4].Value() = max-min;
+    iterVector[3].Value() = std::sqrt(std::max(0.0, meanOfSquares - mean*mean));
+    iterVector[4].Value() = maximum[voxel] - minimum[voxel];
 
     for (int i = 0; i < m_Bins; ++i)
     {
       ++(iterVector[i]);
     }
-    ++inputIter;
   }
 }
 
@@ -3,11 +3,13 @@
 
 #include <itkMultiHistogramFilter.h>
 
-#include <itkNeighborhoodIterator.h>
 #include <itkImageRegionIterator.h>
 #include <itkImageIterator.h>
+#include <itkSeparableNeighborhoodFunctions.h>
 #include "itkMinimumMaximumImageCalculator.h"
 
+#include <algorithm>
+
 template< class TInputImageType, class TOuputImageType>
 itk::MultiHistogramFilter<TInputImageType, TOuputImageType>::MultiHistogramFilter():
 m_Delta(0.6), m_Offset(-3.0), m_Bins(11), m_Size(5), m_UseImageIntensityRange(false)
@@ -51,44 +53,46 @@ itk::MultiHistogramFilter<TInputImageType, TOuputImageType>::ThreadedGenerateDat
 {
   double offset = m_Offset;// -3.0;
   double delta = m_Delta;// 0.6;
+  int bins = m_Bins;
 
-  typedef itk::ImageRegionIterator<TInputImageType> IteratorType;
-  typedef itk::ConstNeighborhoodIterator<TInputImageType> ConstIteratorType;
+  typedef itk::ImageRegionIterator<TOuputImageType> IteratorType;
 
   typename TInputImageType::SizeType size; size.Fill(m_Size);
   InputImagePointer input = this->GetInput(0);
 
-//  MITK_INFO << "Creating output iterator";
-  std::vector<IteratorType> iterVector;
-  for (int i = 0; i < m_Bins; ++i)
-  {
-    IteratorType iter(this->GetOutput(i), outputRegionForThread);
-    iterVector.push_back(iter);
-  }
+  // Every voxel is assigned to its bin once. The histogram of a neighbourhood then is the number
+  // of neighbours in each bin, which is a box sum of the indicator image of the bin and is updated
+  // with one sliding window pass per axis instead of counting all neighbours of every voxel.
+  std::vector<int> binOfVoxel;
+  std::vector<std::size_t> paddedShape;
+  itk::SeparableNeighborhood::FillPaddedBuffer(input.GetPointer(), outputRegionForThread, size, binOfVoxel, paddedShape,
+    [offset, delta, bins](typename TInputImageType::PixelType pixel)
+    {
+      double value = pixel;
+      value -= offset;
+      value /= delta;
+      auto pos = (int)(value);
+      return std::max(0, std::min(bins - 1, pos));
+    });
 
-  ConstIteratorType inputIter(size, input, outputRegionForThread);
-  while (!inputIter.IsAtEnd())
+  std::vector<int> count;
+  for (int bin = 0; bin < m_Bins; ++bin)
   {
-    for (int i = 0; i < m_Bins; ++i)
-    {
-      iterVector[i].Set(0);
-    }
+    count.resize(binOfVoxel.size());
+    std::transform(binOfVoxel.begin(), binOfVoxel.end(), count.begin(), [bin](int voxelBin) { return voxelBin == bin ? 1 : 0; });
 
-    for (unsigned int i = 0; i < inputIter.Size(); ++i)
+    std::vector<std::size_t> shape(paddedShape);
+    for (unsigned int d = 0; d < TInputImageType::ImageDimension; ++d)
     {
-      double value = inputIter.GetPixel(i);
-      value -=  offset;
-      value /= delta;
-      auto pos = (int)(value);
-      pos = std::max(0, std::min(m_Bins-1, pos));
-      iterVector[pos].Value() += 1;// (iterVector[pos].GetCenterPixel() + 1);
+      itk::SeparableNeighborhood::SlidingWindowAlongAxis(count, shape, d, size[d], itk::SeparableNeighborhood::SumOperation());
+      shape[d] -= 2 * size[d];
     }
 
-    for (int i = 0; i < m_Bins; ++i)
+    IteratorType iter(this->GetOutput(bin), outputRegionForThread);
+    for (std::size_t voxel = 0; voxel < count.size(); ++voxel, ++iter)
     {
-      ++(iterVector[i]);
+      iter.Set(count[voxel]);
     }
-    ++inputIter;
   }
 }
 
@@ -0,0 +1,188 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef itkSeparableNeighborhoodFunctions_h
+#define itkSeparableNeighborhoodFunctions_h
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace itk
+{
+  /**
+  * \brief Helpers to calculate box shaped neighbourhood statistics with one pass per image axis.
+  *
+  * Sums, minima and maxima over a box of (2*radius+1) voxels per axis are separable, so instead of
+  * visiting the whole neighbourhood of every voxel each axis is processed with a sliding window,
+  * which costs a constant number of operations per voxel and axis independent of the radius.
+  *
+  * The functions work on contiguous buffers in which axis 0 is the fastest running index. The
+  * input region is first copied with FillPaddedBuffer, which replicates the border voxels like
+  * itk::ZeroFluxNeumannBoundaryCondition, the default boundary condition of the neighbourhood
+  * iterators. After one call of SlidingWindowAlongAxis per axis, each followed by shrinking
+  * the shape along that axis by 2*radius, the buffer has the shape of the region again.
+  */
+  namespace SeparableNeighborhood
+  {
+    /**
+    * \brief Copies region, grown by radius, into buffer. Voxels outside of the buffered region of the
+    * image are replaced by the closest voxel inside. shape is set to the size of the grown region.
+    */
+    template<typename TImageType, typename TValueType, typename TConvertFunction>
+    void FillPaddedBuffer(const TImageType * image, const typename TImageType::RegionType & region,
+      const typename TImageType::SizeType & radius, std::vector<TValueType> & buffer,
+      std::vector<std::size_t> & shape, TConvertFunction convert)
+    {
+      const unsigned int dimension = TImageType::ImageDimension;
+      const typename TImageType::RegionType bufferedRegion = image->GetBufferedRegion();
+      const typename TImageType::PixelType * data = image->GetBufferPointer();
+      const typename TImageType::OffsetValueType * offsetTable = image->GetOffsetTable();
+
+      shape.resize(dimension);
+      std::size_t numberOfVoxels = 1;
+      for (unsigned int d = 0; d < dimension; ++d)
+      {
+        shape[d] = region.GetSize(d) + 2 * radius[d];
+        numberOfVoxels *= shape[d];
+      }
+      buffer.resize(numberOfVoxels);
+
+      const long firstBufferedX = bufferedRegion.GetIndex(0);
+      const long lastBufferedX = firstBufferedX + static_cast<long>(bufferedRegion.GetSize(0)) - 1;
+      const long firstX = region.GetIndex(0) - static_cast<long>(radius[0]);
+
+      // Position of the current line within the padded region, axis 0 is handled within the line
+      std::vector<std::size_t> position(dimension, 0);
+      for (std::size_t lineStart = 0; lineStart < numberOfVoxels; lineStart += shape[0])
+      {
+        typename TImageType::OffsetValueType lineOffset = 0;
+        for (unsigned int d = 1; d < dimension; ++d)
+        {
+          long index = region.GetIndex(d) - static_cast<long>(radius[d]) + static_cast<long>(position[d]);
+          index = std::max<long>(bufferedRegion.GetIndex(d), std::min<long>(index,
+            bufferedRegion.GetIndex(d) + static_cast<long>(bufferedRegion.GetSize(d)) - 1));
+          lineOffset += (index - bufferedRegion.GetIndex(d)) * offsetTable[d];
+        }
+
+        const typename TImageType::PixelType * line = data + lineOffset;
+        for (std::size_t x = 0; x < shape[0]; ++x)
+        {
+          const long index = std::max(firstBufferedX, std::min(firstX + static_cast<long>(x), lastBufferedX));
+          buffer[lineStart + x] = convert(line[index - firstBufferedX]);
+        }
+
+        for (unsigned int d = 1; d < dimension; ++d)
+        {
+          if (++position[d] < shape[d])
+            break;
+          position[d] = 0;
+        }
+      }
+    }
+
+    /** \brief Sum of the window, updated by adding the entering and subtracting the leaving value. */
+    struct SumOperation
+    {
+      template<typename TValueType>
+      void operator()(const std::vector<TValueType> & in, std::size_t radius, std::vector<TValueType> & out) const
+      {
+        const std::size_t windowSize = 2 * radius + 1;
+        TValueType sum = TValueType();
+        for (std::size_t i = 0; i < windowSize; ++i)
+          sum += in[i];
+        out[0] = sum;
+        for (std::size_t i = 1; i < out.size(); ++i)
+        {
+          sum += in[i + windowSize - 1];
+          sum -= in[i - 1];
+          out[i] = sum;
+        }
+      }
+    };
+
+    /** \brief Extremum of the window, using a monotonic queue of candidate positions. */
+    template<typename TCompare>
+    struct ExtremumOperation
+    {
+      template<typename TValueType>
+      void operator()(const std::vector<TValueType> & in, std::size_t radius, std::vector<TValueType> & out) const
+      {
+        const std::size_t windowSize = 2 * radius + 1;
+        TCompare compare;
+        std::deque<std::size_t> candidates;
+        for (std::size_t i = 0; i < in.size(); ++i)
+        {
+          while (!candidates.empty() && !compare(in[candidates.back()], in[i]))
+            candidates.pop_back();
+          candidates.push_back(i);
+          if (i + 1 < windowSize)
+            continue;
+          const std::size_t first = i + 1 - windowSize;
+          if (candidates.front() < first)
+            candidates.pop_front();
+          out[first] = in[candidates.front()];
+        }
+      }
+    };
+
+    typedef ExtremumOperation<std::less<double> > MinimumOperation;
+    typedef ExtremumOperation<std::greater<double> > MaximumOperation;
+
+    /**
+    * \brief Replaces buffer of the given shape by the result of operation over windows of 2*radius+1 voxels
+    * along axis. The buffer shrinks by 2*radius voxels along axis, which the caller has to apply to shape,
+    * so that several buffers of the same shape can be processed before.
+    */
+    template<typename TValueType, typename TOperation>
+    void SlidingWindowAlongAxis(std::vector<TValueType> & buffer, const std::vector<std::size_t> & shape,
+      unsigned int axis, std::size_t radius, TOperation operation)
+    {
+      if (radius == 0)
+        return;
+
+      std::size_t stride = 1;
+      for (unsigned int d = 0; d < axis; ++d)
+        stride *= shape[d];
+      const std::size_t inLength = shape[axis];
+      const std::size_t outLength = inLength - 2 * radius;
+      const std::size_t numberOfBlocks = buffer.size() / (stride * inLength);
+
+      std::vector<TValueType> result(numberOfBlocks * stride * outLength);
+      std::vector<TValueType> inLine(inLength);
+      std::vector<TValueType> outLine(outLength);
+      for (std::size_t block = 0; block < numberOfBlocks; ++block)
+      {
+        for (std::size_t offset = 0; offset < stride; ++offset)
+        {
+          const TValueType * in = &buffer[block * stride * inLength + offset];
+          for (std::size_t i = 0; i < inLength; ++i)
+            inLine[i] = in[i * stride];
+
+          operation(inLine, radius, outLine);
+
+          TValueType * out = &result[block * stride * outLength + offset];
+          for (std::size_t i = 0; i < outLength; ++i)
+            out[i * stride] = outLine[i];
+        }
+      }
+      buffer.swap(result);
+    }
+  }
+}
+
+#endif // itkSeparableNeighborhoodFunctions_h
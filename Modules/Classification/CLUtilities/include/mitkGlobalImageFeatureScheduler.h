@@ -0,0 +1,98 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkGlobalImageFeatureScheduler_h
+#define mitkGlobalImageFeatureScheduler_h
+
+#include "MitkCLUtilitiesExports.h"
+
+#include <vector>
+
+#include <mitkAbstractGlobalImageFeature.h>
+#include <mitkIntensityRangeCache.h>
+
+namespace mitk
+{
+  namespace cl
+  {
+    /**
+    * \brief Calculates several feature classes for a batch of image / mask pairs in parallel.
+    *
+    * Each case consists of an image, a mask, the mask without NaN voxels and an optional morphological
+    * mask, which are passed to AbstractGlobalImageFeature::CalculateFeaturesUsingParameters. All feature
+    * classes share one IntensityRangeCache, so the intensity range of each image and mask that is needed
+    * to initialize the quantifiers is computed only once instead of once per feature class.
+    *
+    * Compute() starts a pool of threads that take the feature classes one after another. A thread
+    * calculates its feature class for all cases in the order in which they were added, so different
+    * feature classes process different cases at the same time while no feature object is ever used by
+    * more than one thread. The feature objects have to be configured before Compute() is called. The
+    * result of each case lists the features in the order in which the feature classes were added,
+    * just as a sequential calculation would.
+    */
+    class MITKCLUTILITIES_EXPORT GlobalImageFeatureScheduler
+    {
+    public:
+      typedef mitk::AbstractGlobalImageFeature::FeatureListType FeatureListType;
+
+      GlobalImageFeatureScheduler();
+
+      /**
+      * \brief Number of threads used by Compute(). 0 (default) uses one thread per hardware thread.
+      */
+      void SetNumberOfThreads(unsigned int numberOfThreads);
+      unsigned int GetNumberOfThreads() const;
+
+      void AddFeatureClass(const mitk::AbstractGlobalImageFeature::Pointer &feature);
+
+      /**
+      * \brief Adds a case and returns its index. If no morphological mask is given, the mask is used.
+      */
+      std::size_t AddCase(const mitk::Image::Pointer &image, const mitk::Image::Pointer &mask,
+        const mitk::Image::Pointer &maskNoNaN, const mitk::Image::Pointer &morphMask = nullptr);
+
+      std::size_t GetNumberOfCases() const;
+
+      /**
+      * \brief Removes all cases and their results, but keeps the feature classes.
+      */
+      void ClearCases();
+
+      /**
+      * \brief Calculates all feature classes for all cases. Exceptions of a feature class are rethrown.
+      */
+      void Compute();
+
+      const FeatureListType &GetFeatures(std::size_t caseIndex) const;
+
+    private:
+      struct Case
+      {
+        mitk::Image::Pointer Image;
+        mitk::Image::Pointer Mask;
+        mitk::Image::Pointer MaskNoNaN;
+        mitk::Image::Pointer MorphMask;
+        FeatureListType Features;
+      };
+
+      unsigned int m_NumberOfThreads;
+      std::vector<mitk::AbstractGlobalImageFeature::Pointer> m_FeatureClasses;
+      std::vector<Case> m_Cases;
+    };
+  }
+}
+
+#endif //mitkGlobalImageFeatureScheduler_h
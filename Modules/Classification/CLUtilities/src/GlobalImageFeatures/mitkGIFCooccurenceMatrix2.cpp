@@ -7,12 +7,15 @@
 
 // ITK
 #include <itkEnhancedScalarImageToTextureFeaturesFilter.h>
-#include <itkShapedNeighborhoodIterator.h>
 #include <itkImageRegionConstIterator.h>
+#include <itkNeighborhood.h>
 
 // STL
+#include <algorithm>
 #include <sstream>
 #include <cmath>
+#include <thread>
+#include <vector>
 
 namespace mitk
 {
@@ -151,53 +154,148 @@ double mitk::CoocurenceMatrixHolder::IndexToMaxIntensity(int index)
   return m_MinimumRange + (index + 1) * m_Stepsize;
 }
 
+namespace
+{
+  /**
+  * Counts the co-occurrences of all offsets within lines [firstLine, endLine) along the first axis.
+  * bins contains the quantized intensity of every voxel in raster order, or -1 for voxels that
+  * are outside of the mask or NaN. Only the pair (center, neighbour) is counted, the symmetric
+  * pair is added when the counts are reduced.
+  */
+  template<unsigned int VImageDimension>
+  void CountCoOccurrences(const std::vector<int> &bins,
+                          const itk::Size<VImageDimension> &size,
+                          const std::vector<itk::Offset<VImageDimension> > &offsets,
+                          int numberOfBins,
+                          itk::SizeValueType firstLine,
+                          itk::SizeValueType endLine,
+                          std::vector<itk::SizeValueType> &counts)
+  {
+    const itk::OffsetValueType lineLength = size[0];
+    const std::size_t matrixSize = static_cast<std::size_t>(numberOfBins) * numberOfBins;
+
+    itk::OffsetValueType strides[VImageDimension];
+    strides[0] = 1;
+    for (unsigned int i = 1; i < VImageDimension; ++i)
+    {
+      strides[i] = strides[i - 1] * size[i - 1];
+    }
+
+    for (itk::SizeValueType line = firstLine; line < endLine; ++line)
+    {
+      itk::OffsetValueType coordinates[VImageDimension];
+      itk::SizeValueType remainder = line;
+      for (unsigned int i = 1; i < VImageDimension; ++i)
+      {
+        coordinates[i] = remainder % size[i];
+        remainder /= size[i];
+      }
+      const int *lineBins = bins.data() + line * lineLength;
+
+      for (std::size_t d = 0; d < offsets.size(); ++d)
+      {
+        const itk::Offset<VImageDimension> &offset = offsets[d];
+        bool lineIsInside = true;
+        itk::OffsetValueType neighbourShift = offset[0];
+        for (unsigned int i = 1; i < VImageDimension; ++i)
+        {
+          const itk::OffsetValueType neighbourCoordinate = coordinates[i] + offset[i];
+          lineIsInside = lineIsInside && neighbourCoordinate >= 0 && neighbourCoordinate < static_cast<itk::OffsetValueType>(size[i]);
+          neighbourShift += offset[i] * strides[i];
+        }
+        if (!lineIsInside)
+          continue;
+
+        const itk::OffsetValueType begin = std::max<itk::OffsetValueType>(0, -offset[0]);
+        const itk::OffsetValueType end = std::min<itk::OffsetValueType>(lineLength, lineLength - offset[0]);
+        itk::SizeValueType *matrix = counts.data() + d * matrixSize;
+        for (itk::OffsetValueType x = begin; x < end; ++x)
+        {
+          const int i = lineBins[x];
+          const int j = lineBins[x + neighbourShift];
+          if (i >= 0 && j >= 0)
+          {
+            ++matrix[i * numberOfBins + j];
+          }
+        }
+      }
+    }
+  }
+}
+
+/**
+* Calculates the co-occurrence matrices of all offsets in a single, parallel pass over the image.
+* The intensities are quantized once, and every thread accumulates the counts of a block of lines
+* in its own dense matrices which are added up at the end. Pairs are counted if both voxels are
+* inside of the image and the mask and not NaN, just like the neighbourhood iterator did before.
+*/
 template<typename TPixel, unsigned int VImageDimension>
 void
-CalculateCoOcMatrix(itk::Image<TPixel, VImageDimension>* itkImage,
-                    itk::Image<unsigned short, VImageDimension>* mask,
-                    itk::Offset<VImageDimension> offset,
-                    int range,
-                    mitk::CoocurenceMatrixHolder &holder)
+CalculateCoOcMatrices(itk::Image<TPixel, VImageDimension>* itkImage,
+                      itk::Image<unsigned short, VImageDimension>* mask,
+                      const std::vector<itk::Offset<VImageDimension> > &offsets,
+                      std::vector<mitk::CoocurenceMatrixHolder> &holders)
 {
   typedef itk::Image<TPixel, VImageDimension> ImageType;
   typedef itk::Image<unsigned short, VImageDimension> MaskImageType;
-  typedef itk::ShapedNeighborhoodIterator<ImageType> ShapeIterType;
-  typedef itk::ShapedNeighborhoodIterator<MaskImageType> ShapeMaskIterType;
-  typedef itk::ImageRegionConstIterator<ImageType> ConstIterType;
-  typedef itk::ImageRegionConstIterator<MaskImageType> ConstMaskIterType;
 
+  if (holders.empty())
+    return;
 
-  itk::Size<VImageDimension> radius;
-  radius.Fill(range+1);
-  ShapeIterType imageOffsetIter(radius, itkImage, itkImage->GetLargestPossibleRegion());
-  ShapeMaskIterType maskOffsetIter(radius, mask, mask->GetLargestPossibleRegion());
-  imageOffsetIter.ActivateOffset(offset);
-  maskOffsetIter.ActivateOffset(offset);
-  ConstIterType imageIter(itkImage, itkImage->GetLargestPossibleRegion());
-  ConstMaskIterType maskIter(mask, mask->GetLargestPossibleRegion());
-  //  iterator.GetIndex() + ci.GetNeighborhoodOffset()
-  auto region = mask->GetLargestPossibleRegion();
+  const auto region = mask->GetLargestPossibleRegion();
+  const auto size = region.GetSize();
+  const int numberOfBins = holders[0].m_NumberOfBins;
 
+  std::vector<int> bins(region.GetNumberOfPixels(), -1);
+  itk::ImageRegionConstIterator<ImageType> imageIter(itkImage, itkImage->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<MaskImageType> maskIter(mask, region);
+  for (std::size_t index = 0; !maskIter.IsAtEnd(); ++index, ++imageIter, ++maskIter)
+  {
+    const TPixel value = imageIter.Get();
+    if (maskIter.Value() > 0 && value == value)
+    {
+      bins[index] = holders[0].IntensityToIndex(value);
+    }
+  }
 
-  while (!maskIter.IsAtEnd())
+  const itk::SizeValueType numberOfLines = bins.size() / size[0];
+  const std::size_t matrixSize = static_cast<std::size_t>(numberOfBins) * numberOfBins;
+
+  // Each thread needs its own set of matrices, limit them to about 256 MB in total
+  const std::size_t bytesPerThread = std::max<std::size_t>(1, offsets.size() * matrixSize * sizeof(itk::SizeValueType));
+  std::size_t numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+  numberOfThreads = std::min<std::size_t>(numberOfThreads, (256u << 20) / bytesPerThread);
+  numberOfThreads = std::max<std::size_t>(1, std::min<std::size_t>(numberOfThreads, numberOfLines));
+
+  std::vector<std::vector<itk::SizeValueType> > counts(numberOfThreads, std::vector<itk::SizeValueType>(offsets.size() * matrixSize, 0));
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < numberOfThreads; ++t)
+  {
+    const itk::SizeValueType firstLine = numberOfLines * t / numberOfThreads;
+    const itk::SizeValueType endLine = numberOfLines * (t + 1) / numberOfThreads;
+    threads.emplace_back([&, t, firstLine, endLine]()
+    {
+      CountCoOccurrences<VImageDimension>(bins, size, offsets, numberOfBins, firstLine, endLine, counts[t]);
+    });
+  }
+  for (auto &thread : threads)
   {
-    auto ciMask = maskOffsetIter.Begin();
-    auto ciValue = imageOffsetIter.Begin();
-    if (maskIter.Value() > 0 &&
-      ciMask.Get() > 0 &&
-      imageIter.Get() == imageIter.Get() &&
-      ciValue.Get() == ciValue.Get() &&
-      region.IsInside(maskOffsetIter.GetIndex() + ciMask.GetNeighborhoodOffset()))
+    thread.join();
+  }
+
+  for (std::size_t d = 0; d < offsets.size(); ++d)
+  {
+    for (std::size_t t = 0; t < numberOfThreads; ++t)
     {
-      int i = holder.IntensityToIndex(imageIter.Get());
-      int j = holder.IntensityToIndex(ciValue.Get());
-      holder.m_Matrix(i, j) += 1;
-      holder.m_Matrix(j, i) += 1;
+      const itk::SizeValueType *matrix = counts[t].data() + d * matrixSize;
+      for (int i = 0; i < numberOfBins; ++i)
+      {
+        for (int j = 0; j < numberOfBins; ++j)
+        {
+          holders[d].m_Matrix(i, j) += matrix[i * numberOfBins + j] + matrix[j * numberOfBins + i];
+        }
+      }
     }
-    ++imageOffsetIter;
-    ++maskOffsetIter;
-    ++imageIter;
-    ++maskIter;
   }
 }
 
@@ -408,9 +506,7 @@ CalculateCoocurenceFeatures(itk::Image<TPixel, VImageDimension>* itkImage, mitk:
     offset[2] = 1;
   }
 
-  std::vector<mitk::CoocurenceMatrixFeatures> resultVector;
-  mitk::CoocurenceMatrixHolder holderOverall(rangeMin, rangeMax, numberOfBins);
-  mitk::CoocurenceMatrixFeatures overallFeature;
+  std::vector<itk::Offset<VImageDimension> > usedOffsets;
   for (std::size_t i = 0; i < offsetVector.size(); ++i)
   {
     if (config.direction > 1)
@@ -420,14 +516,19 @@ CalculateCoocurenceFeatures(itk::Image<TPixel, VImageDimension>* itkImage, mitk:
         continue;
       }
     }
+    usedOffsets.push_back(offsetVector[i]);
+  }
 
-
-    offset = offsetVector[i];
-    mitk::CoocurenceMatrixHolder holder(rangeMin, rangeMax, numberOfBins);
+  std::vector<mitk::CoocurenceMatrixFeatures> resultVector;
+  mitk::CoocurenceMatrixHolder holderOverall(rangeMin, rangeMax, numberOfBins);
+  mitk::CoocurenceMatrixFeatures overallFeature;
+  std::vector<mitk::CoocurenceMatrixHolder> holders(usedOffsets.size(), holderOverall);
+  CalculateCoOcMatrices<TPixel, VImageDimension>(itkImage, maskImage, usedOffsets, holders);
+  for (std::size_t i = 0; i < holders.size(); ++i)
+  {
     mitk::CoocurenceMatrixFeatures coocResults;
-    CalculateCoOcMatrix<TPixel, VImageDimension>(itkImage, maskImage, offset, config.range, holder);
-    holderOverall.m_Matrix += holder.m_Matrix;
-    CalculateFeatures(holder, coocResults);
+    holderOverall.m_Matrix += holders[i].m_Matrix;
+    CalculateFeatures(holders[i], coocResults);
     resultVector.push_back(coocResults);
   }
   CalculateFeatures(holderOverall, overallFeature);
@@ -0,0 +1,159 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkGlobalImageFeatureScheduler.h>
+
+#include <mitkExceptionMacro.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <thread>
+
+mitk::cl::GlobalImageFeatureScheduler::GlobalImageFeatureScheduler() :
+  m_NumberOfThreads(0)
+{
+}
+
+void mitk::cl::GlobalImageFeatureScheduler::SetNumberOfThreads(unsigned int numberOfThreads)
+{
+  m_NumberOfThreads = numberOfThreads;
+}
+
+unsigned int mitk::cl::GlobalImageFeatureScheduler::GetNumberOfThreads() const
+{
+  return m_NumberOfThreads;
+}
+
+void mitk::cl::GlobalImageFeatureScheduler::AddFeatureClass(const mitk::AbstractGlobalImageFeature::Pointer &feature)
+{
+  if (feature.IsNull())
+    mitkThrow() << "Feature class must not be null";
+  m_FeatureClasses.push_back(feature);
+}
+
+std::size_t mitk::cl::GlobalImageFeatureScheduler::AddCase(const mitk::Image::Pointer &image, const mitk::Image::Pointer &mask,
+  const mitk::Image::Pointer &maskNoNaN, const mitk::Image::Pointer &morphMask)
+{
+  if (image.IsNull() || mask.IsNull() || maskNoNaN.IsNull())
+    mitkThrow() << "Image, mask and mask without NaN of a case must not be null";
+
+  Case newCase;
+  newCase.Image = image;
+  newCase.Mask = mask;
+  newCase.MaskNoNaN = maskNoNaN;
+  newCase.MorphMask = morphMask.IsNull() ? mask : morphMask;
+  m_Cases.push_back(newCase);
+  return m_Cases.size() - 1;
+}
+
+std::size_t mitk::cl::GlobalImageFeatureScheduler::GetNumberOfCases() const
+{
+  return m_Cases.size();
+}
+
+void mitk::cl::GlobalImageFeatureScheduler::ClearCases()
+{
+  m_Cases.clear();
+}
+
+void mitk::cl::GlobalImageFeatureScheduler::Compute()
+{
+  const std::size_t numberOfFeatureClasses = m_FeatureClasses.size();
+  const std::size_t numberOfCases = m_Cases.size();
+
+  // results[feature class][case], concatenated in the order of the feature classes afterwards
+  std::vector<std::vector<FeatureListType>> results(numberOfFeatureClasses, std::vector<FeatureListType>(numberOfCases));
+
+  mitk::IntensityRangeCache::Pointer rangeCache = mitk::IntensityRangeCache::New();
+  for (auto &feature : m_FeatureClasses)
+  {
+    feature->SetIntensityRangeCache(rangeCache);
+  }
+
+  std::atomic<std::size_t> nextFeatureClass(0);
+  std::atomic<bool> failed(false);
+  std::exception_ptr exception;
+  std::mutex exceptionMutex;
+
+  auto worker = [&]()
+  {
+    for (std::size_t featureIndex = nextFeatureClass++; featureIndex < numberOfFeatureClasses && !failed; featureIndex = nextFeatureClass++)
+    {
+      mitk::AbstractGlobalImageFeature *feature = m_FeatureClasses[featureIndex];
+      try
+      {
+        for (std::size_t caseIndex = 0; caseIndex < numberOfCases && !failed; ++caseIndex)
+        {
+          const Case &currentCase = m_Cases[caseIndex];
+          feature->SetMorphMask(currentCase.MorphMask);
+          feature->CalculateFeaturesUsingParameters(currentCase.Image, currentCase.Mask, currentCase.MaskNoNaN, results[featureIndex][caseIndex]);
+        }
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(exceptionMutex);
+        if (!exception)
+          exception = std::current_exception();
+        failed = true;
+      }
+    }
+  };
+
+  std::size_t numberOfThreads = m_NumberOfThreads > 0 ? m_NumberOfThreads : std::max(1u, std::thread::hardware_concurrency());
+  numberOfThreads = std::max<std::size_t>(1, std::min(numberOfThreads, numberOfFeatureClasses));
+
+  std::vector<std::thread> threads;
+  for (std::size_t i = 1; i < numberOfThreads; ++i)
+  {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+
+  // The cache holds references to the images, which must not outlive the calculation
+  for (auto &feature : m_FeatureClasses)
+  {
+    feature->SetIntensityRangeCache(nullptr);
+  }
+  rangeCache->Clear();
+
+  if (exception)
+    std::rethrow_exception(exception);
+
+  for (std::size_t caseIndex = 0; caseIndex < numberOfCases; ++caseIndex)
+  {
+    FeatureListType &features = m_Cases[caseIndex].Features;
+    features.clear();
+    for (std::size_t featureIndex = 0; featureIndex < numberOfFeatureClasses; ++featureIndex)
+    {
+      const FeatureListType &featureClassResult = results[featureIndex][caseIndex];
+      std::copy(featureClassResult.begin(), featureClassResult.end(), std::back_inserter(features));
+    }
+  }
+}
+
+const mitk::cl::GlobalImageFeatureScheduler::FeatureListType &mitk::cl::GlobalImageFeatureScheduler::GetFeatures(std::size_t caseIndex) const
+{
+  if (caseIndex >= m_Cases.size())
+    mitkThrow() << "Case " << caseIndex << " does not exist, only " << m_Cases.size() << " cases were added";
+  return m_Cases[caseIndex].Features;
+}
@@ -0,0 +1,155 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+#include "mitkIOUtil.h"
+
+#include <mitkGlobalImageFeatureScheduler.h>
+#include <mitkIntensityRangeCache.h>
+#include <mitkGIFCooccurenceMatrix2.h>
+#include <mitkGIFFirstOrderHistogramStatistics.h>
+#include <mitkGIFFirstOrderStatistics.h>
+#include <mitkGIFGreyLevelSizeZone.h>
+#include <mitkGIFVolumetricStatistics.h>
+
+class mitkGlobalImageFeatureSchedulerTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkGlobalImageFeatureSchedulerTestSuite);
+
+  MITK_TEST(Scheduler_MatchesSequentialCalculation);
+  MITK_TEST(Scheduler_InvalidCase);
+  MITK_TEST(IntensityRangeCache_UpdatesModifiedImage);
+
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::Image::Pointer m_IBSI_Phantom_Image_Small;
+  mitk::Image::Pointer m_IBSI_Phantom_Image_Large;
+  mitk::Image::Pointer m_IBSI_Phantom_Mask_Small;
+  mitk::Image::Pointer m_IBSI_Phantom_Mask_Large;
+
+  std::vector<mitk::AbstractGlobalImageFeature::Pointer> CreateFeatureClasses()
+  {
+    std::vector<mitk::AbstractGlobalImageFeature::Pointer> features;
+    features.push_back(mitk::GIFVolumetricStatistics::New().GetPointer());
+    features.push_back(mitk::GIFFirstOrderStatistics::New().GetPointer());
+    features.push_back(mitk::GIFFirstOrderHistogramStatistics::New().GetPointer());
+    features.push_back(mitk::GIFCooccurenceMatrix2::New().GetPointer());
+    features.push_back(mitk::GIFGreyLevelSizeZone::New().GetPointer());
+
+    mitk::AbstractGlobalImageFeature::ParameterTypes parameter;
+    for (auto feature : features)
+    {
+      parameter[feature->GetLongName()] = us::Any(true);
+    }
+    parameter["bins"] = us::Any(6);
+    for (auto feature : features)
+    {
+      feature->SetParameter(parameter);
+    }
+    return features;
+  }
+
+  void CompareFeatureLists(const mitk::AbstractGlobalImageFeature::FeatureListType &expected,
+                           const mitk::AbstractGlobalImageFeature::FeatureListType &result)
+  {
+    CPPUNIT_ASSERT_EQUAL(expected.size(), result.size());
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL(expected[i].first, result[i].first);
+      if (expected[i].second == expected[i].second)
+      {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(expected[i].first, expected[i].second, result[i].second, 1e-9);
+      }
+      else
+      {
+        CPPUNIT_ASSERT_MESSAGE(expected[i].first, result[i].second != result[i].second);
+      }
+    }
+  }
+
+public:
+
+  void setUp(void) override
+  {
+    m_IBSI_Phantom_Image_Small = mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("Radiomics/IBSI_Phantom_Image_Small.nrrd"));
+    m_IBSI_Phantom_Image_Large = mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("Radiomics/IBSI_Phantom_Image_Large.nrrd"));
+    m_IBSI_Phantom_Mask_Small = mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("Radiomics/IBSI_Phantom_Mask_Small.nrrd"));
+    m_IBSI_Phantom_Mask_Large = mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("Radiomics/IBSI_Phantom_Mask_Large.nrrd"));
+  }
+
+  void Scheduler_MatchesSequentialCalculation()
+  {
+    std::vector<mitk::AbstractGlobalImageFeature::FeatureListType> expected(2);
+    for (auto feature : CreateFeatureClasses())
+    {
+      feature->CalculateFeaturesUsingParameters(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large, m_IBSI_Phantom_Mask_Large, expected[0]);
+      feature->CalculateFeaturesUsingParameters(m_IBSI_Phantom_Image_Small, m_IBSI_Phantom_Mask_Small, m_IBSI_Phantom_Mask_Small, expected[1]);
+    }
+    CPPUNIT_ASSERT_MESSAGE("Features are calculated", expected[0].size() > 0);
+
+    for (unsigned int numberOfThreads = 1; numberOfThreads < 5; numberOfThreads += 3)
+    {
+      mitk::cl::GlobalImageFeatureScheduler scheduler;
+      scheduler.SetNumberOfThreads(numberOfThreads);
+      for (auto feature : CreateFeatureClasses())
+      {
+        scheduler.AddFeatureClass(feature);
+      }
+      scheduler.AddCase(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large, m_IBSI_Phantom_Mask_Large);
+      scheduler.AddCase(m_IBSI_Phantom_Image_Small, m_IBSI_Phantom_Mask_Small, m_IBSI_Phantom_Mask_Small);
+      scheduler.Compute();
+
+      CPPUNIT_ASSERT_EQUAL(std::size_t(2), scheduler.GetNumberOfCases());
+      CompareFeatureLists(expected[0], scheduler.GetFeatures(0));
+      CompareFeatureLists(expected[1], scheduler.GetFeatures(1));
+    }
+  }
+
+  void Scheduler_InvalidCase()
+  {
+    mitk::cl::GlobalImageFeatureScheduler scheduler;
+    CPPUNIT_ASSERT_THROW(scheduler.AddCase(m_IBSI_Phantom_Image_Small, nullptr, m_IBSI_Phantom_Mask_Small), mitk::Exception);
+    CPPUNIT_ASSERT_THROW(scheduler.GetFeatures(0), mitk::Exception);
+  }
+
+  void IntensityRangeCache_UpdatesModifiedImage()
+  {
+    mitk::IntensityRangeCache::Pointer cache = mitk::IntensityRangeCache::New();
+
+    double expectedMinimum, expectedMaximum, minimum, maximum;
+    mitk::IntensityRangeCache::CalculateRange(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large, expectedMinimum, expectedMaximum);
+    cache->GetRange(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large, minimum, maximum);
+    CPPUNIT_ASSERT_EQUAL(expectedMinimum, minimum);
+    CPPUNIT_ASSERT_EQUAL(expectedMaximum, maximum);
+
+    // The whole image is a separate entry
+    mitk::IntensityRangeCache::CalculateRange(m_IBSI_Phantom_Image_Large, nullptr, expectedMinimum, expectedMaximum);
+    cache->GetRange(m_IBSI_Phantom_Image_Large, nullptr, minimum, maximum);
+    CPPUNIT_ASSERT_EQUAL(expectedMinimum, minimum);
+    CPPUNIT_ASSERT_EQUAL(expectedMaximum, maximum);
+
+    // A modified mask invalidates its entry, even if its content stays the same
+    m_IBSI_Phantom_Mask_Large->Modified();
+    cache->GetRange(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large, minimum, maximum);
+    mitk::IntensityRangeCache::CalculateRange(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large, expectedMinimum, expectedMaximum);
+    CPPUNIT_ASSERT_EQUAL(expectedMinimum, minimum);
+    CPPUNIT_ASSERT_EQUAL(expectedMaximum, maximum);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkGlobalImageFeatureScheduler)
@@ -0,0 +1,147 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+
+#include <itkConstNeighborhoodIterator.h>
+#include <itkImage.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+#include <itkLocalStatisticFilter.h>
+#include <itkMultiHistogramFilter.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+class mitkLocalVoxelFeatureFilterTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkLocalVoxelFeatureFilterTestSuite);
+
+  MITK_TEST(LocalStatisticFilter_MatchesNeighbourhoodIteration);
+  MITK_TEST(MultiHistogramFilter_MatchesNeighbourhoodIteration);
+
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef itk::Image<double, 3> ImageType;
+
+  ImageType::Pointer m_Image;
+
+public:
+
+  void setUp() override
+  {
+    // Odd sizes and a radius larger than the image along z test the replicated image borders
+    ImageType::SizeType size;
+    size[0] = 17;
+    size[1] = 13;
+    size[2] = 3;
+    m_Image = ImageType::New();
+    m_Image->SetRegions(ImageType::RegionType(size));
+    m_Image->Allocate();
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(-20, 20);
+    itk::ImageRegionIterator<ImageType> iter(m_Image, m_Image->GetLargestPossibleRegion());
+    for (; !iter.IsAtEnd(); ++iter)
+    {
+      iter.Set(distribution(generator) * 0.25);
+    }
+  }
+
+  void tearDown() override
+  {
+    m_Image = nullptr;
+  }
+
+  void LocalStatisticFilter_MatchesNeighbourhoodIteration()
+  {
+    const int radius = 4;
+    typedef itk::LocalStatisticFilter<ImageType, ImageType> FilterType;
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetInput(m_Image);
+    filter->SetSize(radius);
+    filter->Update();
+
+    ImageType::SizeType neighbourhood;
+    neighbourhood.Fill(radius);
+    neighbourhood[2] = 0;
+    itk::ConstNeighborhoodIterator<ImageType> iter(neighbourhood, m_Image, m_Image->GetLargestPossibleRegion());
+    for (; !iter.IsAtEnd(); ++iter)
+    {
+      double minimum = std::numeric_limits<double>::max();
+      double maximum = std::numeric_limits<double>::lowest();
+      double sum = 0;
+      double squaredSum = 0;
+      for (unsigned int i = 0; i < iter.Size(); ++i)
+      {
+        const double value = iter.GetPixel(i);
+        minimum = std::min(minimum, value);
+        maximum = std::max(maximum, value);
+        sum += value;
+        squaredSum += value * value;
+      }
+      const double mean = sum / iter.Size();
+      const double deviation = std::sqrt(std::max(0.0, squaredSum / iter.Size() - mean * mean));
+
+      const ImageType::IndexType index = iter.GetIndex();
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(minimum, filter->GetOutput(0)->GetPixel(index), 1e-9);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(maximum, filter->GetOutput(1)->GetPixel(index), 1e-9);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(mean, filter->GetOutput(2)->GetPixel(index), 1e-9);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(deviation, filter->GetOutput(3)->GetPixel(index), 1e-6);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(maximum - minimum, filter->GetOutput(4)->GetPixel(index), 1e-9);
+    }
+  }
+
+  void MultiHistogramFilter_MatchesNeighbourhoodIteration()
+  {
+    const int radius = 2;
+    const int bins = 11;
+    const double offset = -3.0;
+    const double delta = 0.6;
+    typedef itk::MultiHistogramFilter<ImageType, ImageType> FilterType;
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetInput(m_Image);
+    filter->SetSize(radius);
+    filter->SetOffset(offset);
+    filter->SetDelta(delta);
+    filter->Update();
+
+    ImageType::SizeType neighbourhood;
+    neighbourhood.Fill(radius);
+    itk::ConstNeighborhoodIterator<ImageType> iter(neighbourhood, m_Image, m_Image->GetLargestPossibleRegion());
+    for (; !iter.IsAtEnd(); ++iter)
+    {
+      std::vector<double> histogram(bins, 0);
+      for (unsigned int i = 0; i < iter.Size(); ++i)
+      {
+        int bin = static_cast<int>((iter.GetPixel(i) - offset) / delta);
+        histogram[std::max(0, std::min(bins - 1, bin))] += 1;
+      }
+
+      const ImageType::IndexType index = iter.GetIndex();
+      for (int bin = 0; bin < bins; ++bin)
+      {
+        CPPUNIT_ASSERT_EQUAL(histogram[bin], filter->GetOutput(bin)->GetPixel(index));
+      }
+    }
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkLocalVoxelFeatureFilter)
@@ -0,0 +1,51 @@
+#ifndef mitkBinnedFeatures_h
+#define mitkBinnedFeatures_h
+
+#include <MitkCLVigraRandomForestExports.h>
+
+#include <vigra/multi_array.hxx>
+
+#include <vector>
+
+namespace mitk
+{
+  /**
+  * \brief Feature matrix quantized into at most 256 bins per feature, for the histogram based split search.
+  *
+  * Each column is sorted once and cut at its quantiles, equal values always end up in the same bin. Columns with
+  * not more distinct values than bins get one bin per value, the binned split search then finds the same splits
+  * as the exhaustive one. The threshold between two bins lies in the middle between the largest value of the lower
+  * and the smallest value of the upper bin, so samples are separated by "feature < threshold" exactly like their
+  * bins. The bin indices are stored column-major as one byte per sample and feature and are shared read-only by
+  * all training threads. The features have to be finite.
+  */
+  class MITKCLVIGRARANDOMFOREST_EXPORT BinnedFeatures
+  {
+  public:
+    typedef unsigned char BinType;
+
+    /** numberOfThreads == 0 uses one thread per hardware core */
+    BinnedFeatures(const vigra::MultiArrayView<2, double> &features,
+                   int maximumNumberOfBins = 256,
+                   unsigned int numberOfThreads = 0);
+
+    int GetNumberOfSamples() const { return m_NumberOfSamples; }
+    int GetNumberOfFeatures() const { return static_cast<int>(m_Thresholds.size()); }
+    int GetNumberOfBins(int feature) const { return static_cast<int>(m_Thresholds[feature].size()) + 1; }
+
+    /** Bin index of every sample for the given feature */
+    const BinType *GetColumn(int feature) const { return m_Bins.data() + std::size_t(feature) * m_NumberOfSamples; }
+
+    /** Threshold that separates the bins 0..bin from the bins bin+1.. */
+    double GetThreshold(int feature, int bin) const { return m_Thresholds[feature][bin]; }
+
+  private:
+    void BinFeature(const vigra::MultiArrayView<2, double> &features, int feature, int maximumNumberOfBins);
+
+    int m_NumberOfSamples;
+    std::vector<BinType> m_Bins;
+    std::vector<std::vector<double> > m_Thresholds;
+  };
+}
+
+#endif //mitkBinnedFeatures_h
@@ -4,6 +4,9 @@
 #include <vigra/multi_array.hxx>
 #include <vigra/random_forest.hxx>
 #include <mitkAdditionalRFData.h>
+#include <mitkBinnedFeatures.h>
+
+#include <vector>
 
 namespace mitk
 {
@@ -44,6 +47,18 @@ namespace mitk
                       TDataIterator &end,
                       TArray const &regionResponse);
 
+      /** Same as operator(), but searches the thresholds between the bins of a binned feature.
+          The samples of the region are counted once per bin instead of being sorted. */
+      template <class TDataSourceLabel,
+                class TDataIterator,
+                class TArray>
+      void BinnedSearch(BinnedFeatures const &binnedFeatures,
+                        int column,
+                        TDataSourceLabel const &labels,
+                        TDataIterator &begin,
+                        TDataIterator &end,
+                        TArray const &regionResponse);
+
       template <class TDataSourceLabel,
                 class TDataIterator,
                 class TArray>
@@ -84,6 +99,9 @@ namespace mitk
       std::ptrdiff_t m_MinimumIndex;
       vigra::ProblemSpec<> m_ExtParameter;
       AdditionalRFDataAbstract* m_AdditionalData;
+      // Histogram of the binned search, kept to avoid reallocations
+      std::vector<double> m_BinCounts;
+      std::vector<int> m_BinSizes;
   };
 }
 
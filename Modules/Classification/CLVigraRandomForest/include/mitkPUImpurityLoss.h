@@ -38,6 +38,10 @@ namespace mitk
         template <class TDataIterator>
         double Decrement(TDataIterator begin, TDataIterator end);
 
+        /** Adds or removes the per class counts of a whole histogram bin, used by the binned split search */
+        double IncrementCounts(const double *counts);
+        double DecrementCounts(const double *counts);
+
         template <class TArray>
         double Init(TArray initCounts);
 
@@ -4,6 +4,7 @@
 #include <vigra/multi_array.hxx>
 #include <vigra/random_forest.hxx>
 #include <mitkAdditionalRFData.h>
+#include <mitkBinnedFeatures.h>
 
 namespace mitk
 {
@@ -35,6 +36,11 @@ namespace mitk
         void SetAdditionalData(AdditionalRFDataAbstract* data);
         AdditionalRFDataAbstract* GetAdditionalData() const;
 
+        /** Binned version of the training features, enables the histogram based split search if not null.
+            The splitter does not take ownership, the bins have to match the features passed to learn(). */
+        void SetBinnedFeatures(const BinnedFeatures *binnedFeatures);
+        const BinnedFeatures *GetBinnedFeatures() const;
+
         void SetWeights(vigra::MultiArrayView<2, double> weights);
         vigra::MultiArrayView<2, double> GetWeights() const;
 
@@ -68,6 +74,7 @@ namespace mitk
         int m_MaximumTreeDepth;
         TFeatureCalculator m_FeatureCalculator;
         vigra::MultiArrayView<2, double> m_Weights;
+        const BinnedFeatures *m_BinnedFeatures;
 
         // variabels to work with
         vigra::ArrayVector<vigra::Int32> splitColumns;
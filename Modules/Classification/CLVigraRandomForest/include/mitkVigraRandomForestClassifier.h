@@ -25,6 +25,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mitkBaseData.h>
 
+#include <vector>
+
 namespace mitk
 {
   class MITKCLVIGRARANDOMFOREST_EXPORT VigraRandomForestClassifier : public AbstractClassifier
@@ -61,6 +63,26 @@ namespace mitk
     void SetTreeCount(int);
     void SetWeightLambda(double);
 
+    /**
+    * \brief Train() searches the splits on a binned copy of the features (default false).
+    *
+    * Every feature is quantized once into at most SetNumberOfBins() bins (default 256), which are shared by all
+    * training threads. The split search of a node then counts its samples per bin instead of sorting them for each
+    * candidate feature. Features with not more distinct values than bins are trained exactly as without binning.
+    */
+    void UseBinnedSplitSearch(bool);
+    void SetNumberOfBins(int);
+
+    /**
+    * \brief Predict() and PredictWeighted() use a flattened copy of the trained forest (default false).
+    *
+    * The trees are copied breadth-first into one contiguous node array and each thread evaluates its samples
+    * in blocks, tree by tree, so that the nodes of a tree stay in the cache for the whole block. Predict()
+    * returns the same labels and probabilities as the vigra prediction. PredictWeighted() does not truncate
+    * the weighted votes and always normalizes by the sum of the weighted votes.
+    */
+    void UseCompiledPrediction(bool);
+
     void SetTreeWeights(Eigen::MatrixXd weights);
     void SetTreeWeight(int treeId, double weight);
     Eigen::MatrixXd GetTreeWeights() const;
@@ -68,6 +90,23 @@ namespace mitk
     void PrintParameter(std::ostream &str = std::cout);
 
   private:
+    /** Flattened decision tree node. Inner nodes send samples with features[Feature] < Threshold to the left child. Leaves are marked with Feature = -1 and store the offset of their class votes in Left. */
+    struct FlatNode
+    {
+      int Feature;
+      int Left;
+      int Right;
+      double Threshold;
+    };
+
+    void BuildFlatForest();  ///< copies m_RandomForest breadth-first into m_FlatNodes
+    void ClearFlatForest();  ///< has to be called whenever m_RandomForest changes
+
+    bool m_FlatForestBuilt;
+    std::vector<FlatNode> m_FlatNodes;        ///< nodes of all trees, the children of a node are stored next to each other
+    std::vector<int> m_FlatRoots;             ///< index of the root node of each tree in m_FlatNodes, empty if the forest could not be flattened
+    std::vector<double> m_FlatLeafWeights;    ///< per leaf: vote of each class, already multiplied by the leaf weight if the forest predicts weighted
+
     // *-------------------
     // * THREADING
     // *-------------------
@@ -87,6 +126,7 @@ namespace mitk
     static ITK_THREAD_RETURN_TYPE TrainTreesCallback(void *);
     static ITK_THREAD_RETURN_TYPE PredictCallback(void *);
     static ITK_THREAD_RETURN_TYPE PredictWeightedCallback(void *);
+    static void FlatPredict(PredictionData *data, vigra::MultiArrayView<2, double> & X, vigra::MultiArrayView<2, int> & Y, vigra::MultiArrayView<2, double> & P, bool useTreeWeights);
     static void VigraPredictWeighted(PredictionData *data, vigra::MultiArrayView<2, double> & X, vigra::MultiArrayView<2, int> & Y, vigra::MultiArrayView<2, double> & P);
   };
 }
@@ -22,6 +22,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vigra/tensorutilities.hxx>
 #include <vigra/convolution.hxx>
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 template< class TInputImageType, class TOutputImageType, class TMaskImageType>
 void itk::StructureTensorEigenvalueImageFilter<TInputImageType,TOutputImageType, TMaskImageType>::GenerateOutputInformation()
@@ -47,8 +53,6 @@ template< class TInputImageType, class TOutputImageType, class TMaskImageType>
 void itk::StructureTensorEigenvalueImageFilter<TInputImageType,TOutputImageType, TMaskImageType>::GenerateData()
 {
 
-
-
   typedef typename TInputImageType::PixelType InputPixelType;
 
   typename TInputImageType::RegionType region = this->GetInput()->GetLargestPossibleRegion();
@@ -56,51 +60,71 @@ void itk::StructureTensorEigenvalueImageFilter<TInputImageType,TOutputImageType,
   unsigned int ydim = region.GetSize(1);
   unsigned int zdim = region.GetSize(2);
 
-
-
   vigra::Shape3 shape(xdim,ydim,zdim);
   vigra::MultiArrayView<3, InputPixelType, vigra::StridedArrayTag > input_image_view(
         shape ,
         this->GetInput()->GetBufferPointer());
 
-  vigra::MultiArray<3, vigra::TinyVector<InputPixelType, 3> > structuretensor_image(shape);
-  vigra::MultiArray<3, vigra::TinyVector<InputPixelType, 3> > eigenvalues_image(shape);
+  // The slices are independent, so they are distributed over the available threads. Each
+  // thread writes the eigenvalues of its slices directly into the (contiguous) output buffers.
+  typedef typename TOutputImageType::PixelType OutputPixelType;
+  OutputPixelType * ev1_buffer = this->GetOutput(0)->GetBufferPointer();
+  OutputPixelType * ev2_buffer = this->GetOutput(1)->GetBufferPointer();
+  OutputPixelType * ev3_buffer = this->GetOutput(2)->GetBufferPointer();
+  const std::size_t slice_size = static_cast<std::size_t>(xdim) * ydim;
 
+  std::atomic<unsigned int> next_slice(0);
+  std::exception_ptr exception;
+  std::mutex exception_mutex;
 
-  for(unsigned int i = 0 ; i < zdim; ++i )
+  auto worker = [&]()
   {
     vigra::Shape2 slice_shape(xdim,ydim);
-    vigra::MultiArrayView<2, InputPixelType, vigra::StridedArrayTag > input_image_slice_view(
-          slice_shape,
-          input_image_view.data()+ (i*xdim*ydim));
+    vigra::MultiArray<2, vigra::TinyVector<InputPixelType, 3> > tensor_slice(slice_shape);
+    vigra::MultiArray<2, vigra::TinyVector<InputPixelType, 3> > eigenvalues_slice(slice_shape);
 
-    vigra::MultiArrayView<2, vigra::TinyVector<InputPixelType, 3> > structuretensor_image_slice_view(
-          slice_shape,
-          structuretensor_image.data() + (i*xdim*ydim));
-
-    vigra::structureTensor(input_image_slice_view, structuretensor_image_slice_view, m_InnerScale, m_OuterScale);
-
-    vigra::MultiArrayView<2, vigra::TinyVector<InputPixelType, 3> > eigenvalues_image_slice_view(
-          slice_shape,
-          eigenvalues_image.data() + (i*xdim*ydim));
-    vigra::tensorEigenRepresentation(structuretensor_image_slice_view, eigenvalues_image_slice_view);
-  }
+    for (unsigned int i = next_slice++; i < zdim; i = next_slice++)
+    {
+      try
+      {
+        vigra::MultiArrayView<2, InputPixelType, vigra::StridedArrayTag > image_slice(
+              slice_shape,
+              input_image_view.data()+ (i*slice_size));
 
-  vigra::MultiArrayView<3, InputPixelType, vigra::StridedArrayTag > ev1_image = eigenvalues_image.bindElementChannel(0);
-  vigra::MultiArrayView<3, InputPixelType, vigra::StridedArrayTag > ev2_image = eigenvalues_image.bindElementChannel(1);
-  vigra::MultiArrayView<3, InputPixelType, vigra::StridedArrayTag > ev3_image = eigenvalues_image.bindElementChannel(2);
+        vigra::structureTensor(image_slice, tensor_slice, m_InnerScale, m_OuterScale);
 
-  for(unsigned int x = 0 ; x < xdim; ++x)
-    for(unsigned int y = 0 ; y < ydim; ++y)
-      for(unsigned int z = 0 ; z < zdim; ++z)
+        vigra::tensorEigenRepresentation(tensor_slice, eigenvalues_slice);
+      }
+      catch (...)
       {
-        itk::Index<3> indx = {{x,y,z}};
-        this->GetOutput(0)->operator [](indx) = ev1_image(x,y,z);
-        this->GetOutput(1)->operator [](indx) = ev2_image(x,y,z);
-        this->GetOutput(2)->operator [](indx) = ev3_image(x,y,z);
+        std::lock_guard<std::mutex> lock(exception_mutex);
+        if (!exception)
+          exception = std::current_exception();
+        next_slice = zdim;
+        return;
       }
 
-
+      const vigra::TinyVector<InputPixelType, 3> * eigenvalues = eigenvalues_slice.data();
+      const std::size_t slice_offset = i * slice_size;
+      for (std::size_t j = 0; j < slice_size; ++j)
+      {
+        ev1_buffer[slice_offset + j] = eigenvalues[j][0];
+        ev2_buffer[slice_offset + j] = eigenvalues[j][1];
+        ev3_buffer[slice_offset + j] = eigenvalues[j][2];
+      }
+    }
+  };
+
+  const unsigned int number_of_threads = std::max(1u, std::min(zdim, std::thread::hardware_concurrency()));
+  std::vector<std::thread> threads;
+  for (unsigned int t = 1; t < number_of_threads; ++t)
+    threads.emplace_back(worker);
+  worker();
+  for (auto & thread : threads)
+    thread.join();
+
+  if (exception)
+    std::rethrow_exception(exception);
 }
 
 template< class TInputImageType, class TOutputImageType, class TMaskImageType>
@@ -127,6 +151,4 @@ itk::StructureTensorEigenvalueImageFilter<TInputImageType,TOutputImageType,TMask
 
 }
 
-
-
 #endif
@@ -17,6 +17,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 // MITK includes
 #include <mitkVigraRandomForestClassifier.h>
 #include <mitkThresholdSplit.h>
+#include <mitkBinnedFeatures.h>
 #include <mitkImpurityLoss.h>
 #include <mitkLinearSplitting.h>
 #include <mitkProperties.h>
@@ -30,6 +31,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkMultiThreader.h>
 #include <itkCommand.h>
 
+// STD includes
+#include <algorithm>
+#include <cmath>
+
 typedef mitk::ThresholdSplit<mitk::LinearSplitting< mitk::ImpurityLoss<> >,int,vigra::ClassificationTag> DefaultSplitType;
 
 struct mitk::VigraRandomForestClassifier::Parameter
@@ -38,6 +43,8 @@ struct mitk::VigraRandomForestClassifier::Parameter
   bool SampleWithReplacement;
   bool UseRandomSplit;
   bool UsePointBasedWeights;
+  bool UseBinnedSplitSearch;
+  int NumberOfBins;
   int TreeCount;
   int MinimumSplitNodeSize;
   int TreeDepth;
@@ -54,7 +61,7 @@ struct mitk::VigraRandomForestClassifier::TrainingData
     const vigra::MultiArrayView<2, double> refFeature,
     const vigra::MultiArrayView<2, int> refLabel,
     const Parameter parameter)
-    : m_ClassCount(0),
+    : m_ClassCount(refRF.class_count()),
     m_NumberOfTrees(numberOfTrees),
     m_RandomForest(refRF),
     m_Splitter(refSplitter),
@@ -87,7 +94,8 @@ struct mitk::VigraRandomForestClassifier::PredictionData
     m_Feature(refFeature),
     m_Label(refLabel),
     m_Probabilities(refProb),
-    m_TreeWeights(refTreeWeights)
+    m_TreeWeights(refTreeWeights),
+    m_CompiledForest(nullptr)
   {
   }
   const vigra::RandomForest<int> & m_RandomForest;
@@ -95,10 +103,12 @@ struct mitk::VigraRandomForestClassifier::PredictionData
   vigra::MultiArrayView<2, int> m_Label;
   vigra::MultiArrayView<2, double> m_Probabilities;
   vigra::MultiArrayView<2, double> m_TreeWeights;
+  const VigraRandomForestClassifier * m_CompiledForest; // flattened forest used instead of m_RandomForest if not null
 };
 
 mitk::VigraRandomForestClassifier::VigraRandomForestClassifier()
-  :m_Parameter(nullptr)
+  :m_FlatForestBuilt(false),
+  m_Parameter(nullptr)
 {
   itk::SimpleMemberCommand<mitk::VigraRandomForestClassifier>::Pointer command = itk::SimpleMemberCommand<mitk::VigraRandomForestClassifier>::New();
   command->SetCallbackFunction(this, &mitk::VigraRandomForestClassifier::ConvertParameter);
@@ -124,6 +134,7 @@ void mitk::VigraRandomForestClassifier::OnlineTrain(const Eigen::MatrixXd & X_in
   vigra::MultiArrayView<2, double> X(vigra::Shape2(X_in.rows(),X_in.cols()),X_in.data());
   vigra::MultiArrayView<2, int> Y(vigra::Shape2(Y_in.rows(),Y_in.cols()),Y_in.data());
   m_RandomForest.onlineLearn(X,Y,0,true);
+  this->ClearFlatForest();
 }
 
 void mitk::VigraRandomForestClassifier::Train(const Eigen::MatrixXd & X_in, const Eigen::MatrixXi &Y_in)
@@ -149,6 +160,14 @@ void mitk::VigraRandomForestClassifier::Train(const Eigen::MatrixXd & X_in, cons
   vigra::MultiArrayView<2, double> X(vigra::Shape2(X_in.rows(),X_in.cols()),X_in.data());
   vigra::MultiArrayView<2, int> Y(vigra::Shape2(Y_in.rows(),Y_in.cols()),Y_in.data());
 
+  // One binned copy of the column-major feature matrix, read by all threads
+  std::unique_ptr<BinnedFeatures> binnedFeatures;
+  if (m_Parameter->UseBinnedSplitSearch)
+  {
+    binnedFeatures.reset(new BinnedFeatures(X, m_Parameter->NumberOfBins));
+    splitter.SetBinnedFeatures(binnedFeatures.get());
+  }
+
   m_RandomForest.set_options().tree_count(1); // Number of trees that are calculated;
 
   m_RandomForest.set_options().use_stratification(m_Parameter->Stratification);
@@ -158,19 +177,23 @@ void mitk::VigraRandomForestClassifier::Train(const Eigen::MatrixXd & X_in, cons
 
   m_RandomForest.learn(X, Y,vigra::rf::visitors::VisitorBase(),splitter);
 
-  std::unique_ptr<TrainingData> data(new TrainingData(m_Parameter->TreeCount,m_RandomForest,splitter,X,Y, *m_Parameter));
+  // The tree learned above initializes the problem description and is kept, the threads learn the others
+  const int remainingTreeCount = std::max(0, m_Parameter->TreeCount - 1);
+  std::unique_ptr<TrainingData> data(new TrainingData(remainingTreeCount,m_RandomForest,splitter,X,Y, *m_Parameter));
 
   itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
   threader->SetSingleMethod(this->TrainTreesCallback,data.get());
   threader->SingleMethodExecute();
 
   // set result trees
-  m_RandomForest.set_options().tree_count(m_Parameter->TreeCount);
+  for (const auto & tree : data->trees_)
+    m_RandomForest.trees_.push_back(tree);
+  m_RandomForest.set_options().tree_count(static_cast<unsigned int>(m_RandomForest.trees_.size()));
   m_RandomForest.ext_param_.class_count_ = data->m_ClassCount;
-  m_RandomForest.trees_ = data->trees_;
+  this->ClearFlatForest();
 
   // Set Tree Weights to default
-  m_TreeWeights = Eigen::MatrixXd(m_Parameter->TreeCount,1);
+  m_TreeWeights = Eigen::MatrixXd(m_RandomForest.tree_count(),1);
   m_TreeWeights.fill(1.0);
 }
 
@@ -198,6 +221,15 @@ Eigen::MatrixXi mitk::VigraRandomForestClassifier::Predict(const Eigen::MatrixXd
   std::unique_ptr<PredictionData> data;
   data.reset(new PredictionData(m_RandomForest, X, Y, P, TW));
 
+  bool useCompiledPrediction = false;
+  this->GetPropertyList()->Get("usecompiledprediction", useCompiledPrediction);
+  if (useCompiledPrediction)
+  {
+    this->BuildFlatForest();
+    if (!m_FlatRoots.empty())
+      data->m_CompiledForest = this;
+  }
+
   itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
   threader->SetSingleMethod(this->PredictCallback, data.get());
   threader->SingleMethodExecute();
@@ -230,6 +262,15 @@ Eigen::MatrixXi mitk::VigraRandomForestClassifier::PredictWeighted(const Eigen::
   std::unique_ptr<PredictionData> data;
   data.reset( new PredictionData(m_RandomForest,X,Y,P,TW));
 
+  bool useCompiledPrediction = false;
+  this->GetPropertyList()->Get("usecompiledprediction", useCompiledPrediction);
+  if (useCompiledPrediction)
+  {
+    this->BuildFlatForest();
+    if (!m_FlatRoots.empty())
+      data->m_CompiledForest = this;
+  }
+
   itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
   threader->SetSingleMethod(this->PredictWeightedCallback,data.get());
   threader->SingleMethodExecute();
@@ -261,8 +302,8 @@ ITK_THREAD_RETURN_TYPE mitk::VigraRandomForestClassifier::TrainTreesCallback(voi
   // define the number of tress the forest have to calculate
   numberOfTreesToCalculate = data->m_NumberOfTrees / infoStruct->NumberOfThreads;
 
-  // the 0th thread takes the residuals
-  if(infoStruct->ThreadID == 0) numberOfTreesToCalculate += data->m_NumberOfTrees % infoStruct->NumberOfThreads;
+  // the residuals are spread over the first threads
+  if(infoStruct->ThreadID < data->m_NumberOfTrees % infoStruct->NumberOfThreads) ++numberOfTreesToCalculate;
 
   if(numberOfTreesToCalculate != 0){
     // Copy the Treestructure defined in userData
@@ -275,6 +316,7 @@ ITK_THREAD_RETURN_TYPE mitk::VigraRandomForestClassifier::TrainTreesCallback(voi
     splitter.SetPrecision(data->m_Splitter.GetPrecision());
     splitter.SetMaximumTreeDepth(data->m_Splitter.GetMaximumTreeDepth());
     splitter.SetWeights(data->m_Splitter.GetWeights());
+    splitter.SetBinnedFeatures(data->m_Splitter.GetBinnedFeatures());
 
     rf.trees_.clear();
     rf.set_options().tree_count(numberOfTreesToCalculate);
@@ -342,6 +384,12 @@ ITK_THREAD_RETURN_TYPE mitk::VigraRandomForestClassifier::PredictCallback(void *
     split_probability = data->m_Probabilities.subarray(lowerBound,upperBound);
   }
 
+  if (data->m_CompiledForest != nullptr)
+  {
+    FlatPredict(data, split_features, split_labels, split_probability, false);
+    return 0;
+  }
+
   data->m_RandomForest.predictLabels(split_features,split_labels);
   data->m_RandomForest.predictProbabilities(split_features, split_probability);
 
@@ -395,7 +443,10 @@ ITK_THREAD_RETURN_TYPE mitk::VigraRandomForestClassifier::PredictWeightedCallbac
     split_probability = data->m_Probabilities.subarray(lowerBound,upperBound);
   }
 
-  VigraPredictWeighted(data, split_features,split_labels,split_probability);
+  if (data->m_CompiledForest != nullptr)
+    FlatPredict(data, split_features, split_labels, split_probability, true);
+  else
+    VigraPredictWeighted(data, split_features,split_labels,split_probability);
 
   return 0;
 }
@@ -451,6 +502,163 @@ void mitk::VigraRandomForestClassifier::VigraPredictWeighted(PredictionData * da
   }
 }
 
+void mitk::VigraRandomForestClassifier::FlatPredict(PredictionData * data, vigra::MultiArrayView<2, double> & X, vigra::MultiArrayView<2, int> & Y, vigra::MultiArrayView<2, double> & P, bool useTreeWeights)
+{
+  // Samples are processed in blocks and the trees in the outer loop, so that the nodes
+  // of a tree are traversed for the whole block while they are in the cache
+  const int blockSize = 256;
+
+  const VigraRandomForestClassifier * forest = data->m_CompiledForest;
+  const int numberOfSamples = vigra::rowCount(X);
+  const int numberOfFeatures = vigra::columnCount(X);
+  const int numberOfClasses = data->m_RandomForest.ext_param_.class_count_;
+  const int numberOfTrees = static_cast<int>(forest->m_FlatRoots.size());
+  const FlatNode * nodes = forest->m_FlatNodes.data();
+  const double * leafWeights = forest->m_FlatLeafWeights.data();
+
+  std::vector<char> valid(blockSize);
+  std::vector<double> votes(blockSize * numberOfClasses);
+  std::vector<double> totalWeights(blockSize);
+
+  for (int blockStart = 0; blockStart < numberOfSamples; blockStart += blockSize)
+  {
+    const int blockEnd = std::min(blockStart + blockSize, numberOfSamples);
+    std::fill(votes.begin(), votes.end(), 0.0);
+    std::fill(totalWeights.begin(), totalWeights.end(), 0.0);
+
+    // Like vigra, samples with NaN features get no votes
+    for (int row = blockStart; row < blockEnd; ++row)
+    {
+      valid[row - blockStart] = 1;
+      for (int feature = 0; feature < numberOfFeatures; ++feature)
+      {
+        if (std::isnan(X(row, feature)))
+        {
+          valid[row - blockStart] = 0;
+          break;
+        }
+      }
+    }
+
+    for (int tree = 0; tree < numberOfTrees; ++tree)
+    {
+      const FlatNode * root = nodes + forest->m_FlatRoots[tree];
+      const double treeWeight = useTreeWeights ? data->m_TreeWeights(tree, 0) : 1.0;
+      for (int row = blockStart; row < blockEnd; ++row)
+      {
+        if (!valid[row - blockStart])
+          continue;
+
+        const FlatNode * node = root;
+        while (node->Feature >= 0)
+          node = nodes + (X(row, node->Feature) < node->Threshold ? node->Left : node->Right);
+
+        // Accumulated in the same order as vigra, so that the results are identical
+        const double * leaf = leafWeights + node->Left;
+        double * sampleVotes = &votes[(row - blockStart) * numberOfClasses];
+        double & totalWeight = totalWeights[row - blockStart];
+        for (int label = 0; label < numberOfClasses; ++label)
+        {
+          const double currentWeight = leaf[label] * treeWeight;
+          sampleVotes[label] += currentWeight;
+          totalWeight += currentWeight;
+        }
+      }
+    }
+
+    for (int row = blockStart; row < blockEnd; ++row)
+    {
+      const double * sampleVotes = &votes[(row - blockStart) * numberOfClasses];
+      const double totalWeight = totalWeights[row - blockStart];
+      int maxLabel = 0;
+      for (int label = 0; label < numberOfClasses; ++label)
+      {
+        P(row, label) = totalWeight > 0 ? sampleVotes[label] / totalWeight : 0.0;
+        if (P(row, label) > P(row, maxLabel))
+          maxLabel = label;
+      }
+      int classLabel;
+      data->m_RandomForest.ext_param_.to_classlabel(maxLabel, classLabel);
+      Y(row, 0) = classLabel;
+    }
+  }
+}
+
+void mitk::VigraRandomForestClassifier::BuildFlatForest()
+{
+  if (m_FlatForestBuilt)
+    return;
+
+  m_FlatNodes.clear();
+  m_FlatRoots.clear();
+  m_FlatLeafWeights.clear();
+  m_FlatForestBuilt = true;
+
+  const int numberOfClasses = m_RandomForest.ext_param_.class_count_;
+  const bool weighted = m_RandomForest.options_.predict_weighted_;
+
+  for (int tree = 0; tree < m_RandomForest.options_.tree_count_; ++tree)
+  {
+    const auto & topology = m_RandomForest.trees_[tree].topology_;
+    const auto & parameters = m_RandomForest.trees_[tree].parameters_;
+
+    // Breadth-first: pairs of vigra topology index and index of the corresponding flat node.
+    // The first two topology entries hold the column and class count.
+    std::vector<std::pair<int, int> > queue;
+    m_FlatRoots.push_back(static_cast<int>(m_FlatNodes.size()));
+    m_FlatNodes.push_back(FlatNode());
+    queue.push_back(std::make_pair(2, m_FlatRoots.back()));
+
+    for (std::size_t next = 0; next < queue.size(); ++next)
+    {
+      const int topologyIndex = queue[next].first;
+      const int flatIndex = queue[next].second;
+      const int type = topology[topologyIndex];
+      const int parameterAddress = topology[topologyIndex + 1];
+      FlatNode node;
+
+      if (type == vigra::e_ConstProbNode)
+      {
+        const double nodeWeight = weighted ? parameters[parameterAddress] : 1.0;
+        node.Feature = -1;
+        node.Left = static_cast<int>(m_FlatLeafWeights.size());
+        node.Right = -1;
+        node.Threshold = 0;
+        for (int label = 0; label < numberOfClasses; ++label)
+          m_FlatLeafWeights.push_back(parameters[parameterAddress + 1 + label] * nodeWeight);
+      }
+      else if (type == vigra::i_ThresholdNode)
+      {
+        node.Feature = topology[topologyIndex + 4];
+        node.Threshold = parameters[parameterAddress + 1];
+        node.Left = static_cast<int>(m_FlatNodes.size());
+        m_FlatNodes.push_back(FlatNode());
+        node.Right = static_cast<int>(m_FlatNodes.size());
+        m_FlatNodes.push_back(FlatNode());
+        queue.push_back(std::make_pair(topology[topologyIndex + 2], node.Left));
+        queue.push_back(std::make_pair(topology[topologyIndex + 3], node.Right));
+      }
+      else
+      {
+        MITK_WARN("VigraRandomForestClassifier") << "Random forest contains unsupported node type " << type << ". Using vigra for prediction.";
+        m_FlatNodes.clear();
+        m_FlatRoots.clear();
+        m_FlatLeafWeights.clear();
+        return;
+      }
+      m_FlatNodes[flatIndex] = node;
+    }
+  }
+}
+
+void mitk::VigraRandomForestClassifier::ClearFlatForest()
+{
+  m_FlatNodes.clear();
+  m_FlatRoots.clear();
+  m_FlatLeafWeights.clear();
+  m_FlatForestBuilt = false;
+}
+
 void  mitk::VigraRandomForestClassifier::ConvertParameter()
 {
   if(this->m_Parameter == nullptr)
@@ -460,6 +668,8 @@ void  mitk::VigraRandomForestClassifier::ConvertParameter()
   MITK_INFO("VigraRandomForestClassifier") << "Convert Parameter";
   if(!this->GetPropertyList()->Get("usepointbasedweight",this->m_Parameter->UsePointBasedWeights))      this->m_Parameter->UsePointBasedWeights = false;
   if(!this->GetPropertyList()->Get("userandomsplit",this->m_Parameter->UseRandomSplit))                 this->m_Parameter->UseRandomSplit = false;
+  if(!this->GetPropertyList()->Get("usebinnedsplitsearch",this->m_Parameter->UseBinnedSplitSearch))     this->m_Parameter->UseBinnedSplitSearch = false;
+  if(!this->GetPropertyList()->Get("numberofbins",this->m_Parameter->NumberOfBins))                     this->m_Parameter->NumberOfBins = 256;
   if(!this->GetPropertyList()->Get("treedepth",this->m_Parameter->TreeDepth))                           this->m_Parameter->TreeDepth = 20;
   if(!this->GetPropertyList()->Get("treecount",this->m_Parameter->TreeCount))                           this->m_Parameter->TreeCount = 100;
   if(!this->GetPropertyList()->Get("minimalsplitnodesize",this->m_Parameter->MinimumSplitNodeSize))     this->m_Parameter->MinimumSplitNodeSize = 5;
@@ -492,6 +702,16 @@ void mitk::VigraRandomForestClassifier::PrintParameter(std::ostream & str)
   else
     str << "userandomsplit\t" << this->m_Parameter->UseRandomSplit << "\n";
 
+  if(!this->GetPropertyList()->Get("usebinnedsplitsearch",this->m_Parameter->UseBinnedSplitSearch))
+    str << "usebinnedsplitsearch\tNOT SET (default " << this->m_Parameter->UseBinnedSplitSearch << ")" << "\n";
+  else
+    str << "usebinnedsplitsearch\t" << this->m_Parameter->UseBinnedSplitSearch << "\n";
+
+  if(!this->GetPropertyList()->Get("numberofbins",this->m_Parameter->NumberOfBins))
+    str << "numberofbins\t\tNOT SET (default " << this->m_Parameter->NumberOfBins << ")" << "\n";
+  else
+    str << "numberofbins\t\t" << this->m_Parameter->NumberOfBins << "\n";
+
   if(!this->GetPropertyList()->Get("treedepth",this->m_Parameter->TreeDepth))
     str << "treedepth\t\tNOT SET (default " << this->m_Parameter->TreeDepth << ")" << "\n";
   else
@@ -572,6 +792,21 @@ void mitk::VigraRandomForestClassifier::SetWeightLambda(double val)
   this->GetPropertyList()->SetDoubleProperty("lambda",val);
 }
 
+void mitk::VigraRandomForestClassifier::UseBinnedSplitSearch(bool val)
+{
+  this->GetPropertyList()->SetBoolProperty("usebinnedsplitsearch",val);
+}
+
+void mitk::VigraRandomForestClassifier::SetNumberOfBins(int val)
+{
+  this->GetPropertyList()->SetIntProperty("numberofbins",val);
+}
+
+void mitk::VigraRandomForestClassifier::UseCompiledPrediction(bool val)
+{
+  this->GetPropertyList()->SetBoolProperty("usecompiledprediction",val);
+}
+
 void mitk::VigraRandomForestClassifier::SetTreeWeight(int treeId, double weight)
 {
   m_TreeWeights(treeId,0) = weight;
@@ -585,6 +820,7 @@ void mitk::VigraRandomForestClassifier::SetRandomForest(const vigra::RandomFores
   this->SetSamplesPerTree(rf.options().training_set_proportion_);
   this->UseSampleWithReplacement(rf.options().sample_with_replacement_);
   this->m_RandomForest = rf;
+  this->ClearFlatForest();
 }
 
 const vigra::RandomForest<int> & mitk::VigraRandomForestClassifier::GetRandomForest() const
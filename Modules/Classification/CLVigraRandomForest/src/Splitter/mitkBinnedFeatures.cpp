@@ -0,0 +1,91 @@
+#include <mitkBinnedFeatures.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+mitk::BinnedFeatures::BinnedFeatures(const vigra::MultiArrayView<2, double> &features,
+                                     int maximumNumberOfBins,
+                                     unsigned int numberOfThreads)
+  : m_NumberOfSamples(static_cast<int>(features.shape(0))),
+    m_Bins(std::size_t(features.shape(0)) * features.shape(1)),
+    m_Thresholds(features.shape(1))
+{
+  maximumNumberOfBins = std::max(2, std::min(maximumNumberOfBins, 256));
+
+  const int numberOfFeatures = static_cast<int>(features.shape(1));
+  if (numberOfThreads == 0)
+    numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+  numberOfThreads = std::min<unsigned int>(numberOfThreads, std::max(1, numberOfFeatures));
+
+  // the features are independent, each thread takes the next unprocessed one
+  std::atomic<int> nextFeature(0);
+  auto binFeatures = [&]() {
+    for (int feature = nextFeature++; feature < numberOfFeatures; feature = nextFeature++)
+      this->BinFeature(features, feature, maximumNumberOfBins);
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned int t = 1; t < numberOfThreads; ++t)
+    threads.emplace_back(binFeatures);
+  binFeatures();
+  for (auto &thread : threads)
+    thread.join();
+}
+
+void mitk::BinnedFeatures::BinFeature(const vigra::MultiArrayView<2, double> &features,
+                                      int feature,
+                                      int maximumNumberOfBins)
+{
+  std::vector<double> sorted(m_NumberOfSamples);
+  for (int i = 0; i < m_NumberOfSamples; ++i)
+    sorted[i] = features(i, feature);
+  std::sort(sorted.begin(), sorted.end());
+
+  // distinct values and the number of samples up to and including each of them
+  std::vector<double> values;
+  std::vector<int> ends;
+  for (int i = 0; i < m_NumberOfSamples; ++i)
+  {
+    if (values.empty() || sorted[i] != values.back())
+    {
+      values.push_back(sorted[i]);
+      ends.push_back(i + 1);
+    }
+    else
+    {
+      ends.back() = i + 1;
+    }
+  }
+
+  std::vector<double> &thresholds = m_Thresholds[feature];
+  thresholds.clear();
+  if (values.size() <= std::size_t(maximumNumberOfBins))
+  {
+    for (std::size_t v = 0; v + 1 < values.size(); ++v)
+      thresholds.push_back((values[v] + values[v + 1]) / 2.0);
+  }
+  else
+  {
+    // cut after every binSize samples, a cut within a run of equal values is moved to its end
+    const double binSize = double(m_NumberOfSamples) / maximumNumberOfBins;
+    double nextCut = binSize;
+    for (std::size_t v = 0; v + 1 < values.size() && thresholds.size() + 1 < std::size_t(maximumNumberOfBins); ++v)
+    {
+      if (ends[v] >= nextCut)
+      {
+        thresholds.push_back((values[v] + values[v + 1]) / 2.0);
+        while (nextCut <= ends[v])
+          nextCut += binSize;
+      }
+    }
+  }
+
+  // same comparison as the tree nodes: samples with feature < threshold belong to the lower bins
+  BinType *bins = m_Bins.data() + std::size_t(feature) * m_NumberOfSamples;
+  for (int i = 0; i < m_NumberOfSamples; ++i)
+  {
+    bins[i] = static_cast<BinType>(std::upper_bound(thresholds.begin(), thresholds.end(), features(i, feature)) -
+                                   thresholds.begin());
+  }
+}
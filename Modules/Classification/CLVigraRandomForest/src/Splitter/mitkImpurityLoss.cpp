@@ -60,6 +60,30 @@ mitk::ImpurityLoss<TLossFunction, TLabelContainer, TWeightContainer>::Decrement(
     return m_LossFunction(m_Counts, m_ClassWeights, m_TotalCount);
 }
 
+template <class TLossFunction, class TLabelContainer, class TWeightContainer>
+double
+mitk::ImpurityLoss<TLossFunction, TLabelContainer, TWeightContainer>::IncrementCounts(const double *counts)
+{
+    for (std::size_t i = 0; i < m_Counts.size(); ++i)
+    {
+        m_Counts[i] += counts[i];
+        m_TotalCount += counts[i];
+    }
+    return m_LossFunction(m_Counts, m_ClassWeights, m_TotalCount);
+}
+
+template <class TLossFunction, class TLabelContainer, class TWeightContainer>
+double
+mitk::ImpurityLoss<TLossFunction, TLabelContainer, TWeightContainer>::DecrementCounts(const double *counts)
+{
+    for (std::size_t i = 0; i < m_Counts.size(); ++i)
+    {
+        m_Counts[i] -= counts[i];
+        m_TotalCount -= counts[i];
+    }
+    return m_LossFunction(m_Counts, m_ClassWeights, m_TotalCount);
+}
+
 template <class TLossFunction, class TLabelContainer, class TWeightContainer>
 template <class TArray>
 double
@@ -163,6 +163,87 @@ mitk::LinearSplitting<TLossAccumulator>::operator()(TDataSourceFeature const &co
     }
 }
 
+template<class TLossAccumulator>
+template <class TDataSourceLabel, class TDataIterator, class TArray>
+void
+mitk::LinearSplitting<TLossAccumulator>::BinnedSearch(BinnedFeatures const &binnedFeatures,
+                int column,
+                TDataSourceLabel const &labels,
+                TDataIterator &begin,
+                TDataIterator &end,
+                TArray const &regionResponse)
+{
+    typedef TLossAccumulator LineSearchLoss;
+    const int numberOfBins = binnedFeatures.GetNumberOfBins(column);
+    const int numberOfClasses = m_ExtParameter.class_count_;
+    const BinnedFeatures::BinType *bins = binnedFeatures.GetColumn(column);
+
+    m_BinCounts.assign(std::size_t(numberOfBins) * numberOfClasses, 0.0);
+    m_BinSizes.assign(numberOfBins, 0);
+    for (TDataIterator iter = begin; iter != end; ++iter)
+    {
+        double pointProbability = 1.0;
+        if (m_UsePointWeights)
+        {
+            pointProbability = m_PointWeights(*iter,0);
+        }
+        const int bin = bins[*iter];
+        m_BinCounts[bin * numberOfClasses + labels(*iter,0)] += pointProbability;
+        ++m_BinSizes[bin];
+    }
+
+    // the per point weights are already part of the histogram
+    LineSearchLoss left(labels, m_ExtParameter, m_AdditionalData);
+    LineSearchLoss right(labels, m_ExtParameter, m_AdditionalData);
+
+    m_MinimumLoss = right.Init(regionResponse);
+    m_MinimumThreshold = 0;
+    m_MinimumIndex = 0;
+
+    // candidate splits are the boundaries after each occupied bin but the last one
+    std::vector<int> candidates;
+    for (int bin = 0; bin < numberOfBins; ++bin)
+    {
+        if (m_BinSizes[bin] > 0)
+            candidates.push_back(bin);
+    }
+    if (candidates.size() < 2)
+        return;
+    candidates.pop_back();
+
+    std::size_t firstCandidate = 0;
+    std::ptrdiff_t leftSize = 0;
+    if (m_UseRandomSplit) // ExtraTree behaviour, a single random boundary
+    {
+        firstCandidate = rand() % candidates.size();
+        for (std::size_t i = 0; i < firstCandidate; ++i)
+        {
+            right.DecrementCounts(&m_BinCounts[candidates[i] * numberOfClasses]);
+            left.IncrementCounts(&m_BinCounts[candidates[i] * numberOfClasses]);
+            leftSize += m_BinSizes[candidates[i]];
+        }
+        candidates.resize(firstCandidate + 1);
+    }
+
+    for (std::size_t i = firstCandidate; i < candidates.size(); ++i)
+    {
+        const int bin = candidates[i];
+        double rightLoss = right.DecrementCounts(&m_BinCounts[bin * numberOfClasses]);
+        double leftLoss = left.IncrementCounts(&m_BinCounts[bin * numberOfClasses]);
+        double currentLoss = rightLoss + leftLoss;
+        leftSize += m_BinSizes[bin];
+
+        if (currentLoss < m_MinimumLoss)
+        {
+            m_BestCurrentCounts[0] = left.Response();
+            m_BestCurrentCounts[1] = right.Response();
+            m_MinimumLoss = currentLoss;
+            m_MinimumIndex = leftSize;
+            m_MinimumThreshold = binnedFeatures.GetThreshold(column, bin);
+        }
+    }
+}
+
 template<class TLossAccumulator>
 template <class TDataSourceLabel, class TDataIterator, class TArray>
 double
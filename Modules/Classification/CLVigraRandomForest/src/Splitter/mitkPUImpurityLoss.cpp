@@ -84,6 +84,32 @@ mitk::PUImpurityLoss<TLossFunction, TLabelContainer, TWeightContainer>::Decremen
     return m_LossFunction(m_PUCounts, m_ClassWeights, m_PUTotalCount);
 }
 
+template <class TLossFunction, class TLabelContainer, class TWeightContainer>
+double
+mitk::PUImpurityLoss<TLossFunction, TLabelContainer, TWeightContainer>::IncrementCounts(const double *counts)
+{
+    for (std::size_t i = 0; i < m_Counts.size(); ++i)
+    {
+        m_Counts[i] += counts[i];
+        m_TotalCount += counts[i];
+    }
+    UpdatePUCounts();
+    return m_LossFunction(m_PUCounts, m_ClassWeights, m_PUTotalCount);
+}
+
+template <class TLossFunction, class TLabelContainer, class TWeightContainer>
+double
+mitk::PUImpurityLoss<TLossFunction, TLabelContainer, TWeightContainer>::DecrementCounts(const double *counts)
+{
+    for (std::size_t i = 0; i < m_Counts.size(); ++i)
+    {
+        m_Counts[i] -= counts[i];
+        m_TotalCount -= counts[i];
+    }
+    UpdatePUCounts();
+    return m_LossFunction(m_PUCounts, m_ClassWeights, m_PUTotalCount);
+}
+
 template <class TLossFunction, class TLabelContainer, class TWeightContainer>
 template <class TArray>
 double
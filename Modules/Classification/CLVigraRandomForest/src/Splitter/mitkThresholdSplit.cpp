@@ -10,6 +10,7 @@ mitk::ThresholdSplit<TColumnDecisionFunctor, TFeatureCalculator, TTag>::Threshol
   m_UseRandomSplit(false),
   m_Precision(0.0),
   m_MaximumTreeDepth(1000),
+  m_BinnedFeatures(nullptr),
   m_AdditionalData(nullptr)
 {
 }
@@ -111,6 +112,20 @@ mitk::ThresholdSplit<TColumnDecisionFunctor, TFeatureCalculator, TTag>::GetMaxim
   return m_MaximumTreeDepth;
 }
 
+template<class TColumnDecisionFunctor, class TFeatureCalculator, class TTag>
+void
+mitk::ThresholdSplit<TColumnDecisionFunctor, TFeatureCalculator, TTag>::SetBinnedFeatures(const BinnedFeatures *binnedFeatures)
+{
+  m_BinnedFeatures = binnedFeatures;
+}
+
+template<class TColumnDecisionFunctor, class TFeatureCalculator, class TTag>
+const mitk::BinnedFeatures *
+mitk::ThresholdSplit<TColumnDecisionFunctor, TFeatureCalculator, TTag>::GetBinnedFeatures() const
+{
+  return m_BinnedFeatures;
+}
+
 template<class TColumnDecisionFunctor, class TFeatureCalculator, class TTag>
 void
 mitk::ThresholdSplit<TColumnDecisionFunctor, TFeatureCalculator, TTag>::SetWeights(vigra::MultiArrayView<2, double> weights)
@@ -231,10 +246,20 @@ mitk::ThresholdSplit<TColumnDecisionFunctor, TFeatureCalculator, TTag>::findBest
   int numberOfTrials = features.shape(1);
   for (int k = 0; k < numberOfTrials; ++k)
   {
-    bgfunc(columnVector(features, splitColumns[k]),
-           labels,
-           region.begin(), region.end(),
-           region.classCounts());
+    if (m_BinnedFeatures != nullptr)
+    {
+      bgfunc.BinnedSearch(*m_BinnedFeatures, splitColumns[k],
+                          labels,
+                          region.begin(), region.end(),
+                          region.classCounts());
+    }
+    else
+    {
+      bgfunc(columnVector(features, splitColumns[k]),
+             labels,
+             region.begin(), region.end(),
+             region.classCounts());
+    }
     min_gini_[k] = bgfunc.GetMinimumLoss();
     min_indices_[k] = bgfunc.GetMinimumIndex();
     min_thresholds_[k] = bgfunc.GetMinimumThreshold();
@@ -22,6 +22,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkCSVArray2DFileReader.h>
 #include <itkCSVArray2DDataObject.h>
 #include <mitkVigraRandomForestClassifier.h>
+#include <mitkBinnedFeatures.h>
 #include <itkLabelSampler.h>
 #include <itkAddImageFilter.h>
 #include <mitkImageCast.h>
@@ -39,6 +40,10 @@ class mitkVigraRandomForestTestSuite : public mitk::TestFixture
   MITK_TEST(TrainThreadedDecisionForest_MatlabDataSet_shouldReturnTrue);
   MITK_TEST(PredictWeightedDecisionForest_SetWeightsToZero_shouldReturnTrue);
   MITK_TEST(TrainThreadedDecisionForest_BreastCancerDataSet_shouldReturnTrue);
+  MITK_TEST(CompiledPrediction_BreastCancerDataSet_MatchesVigraPrediction);
+  MITK_TEST(BinnedFeatures_FewDistinctValues_OneBinPerValue);
+  MITK_TEST(BinnedFeatures_ManyDistinctValues_EqualValuesShareBin);
+  MITK_TEST(TrainBinnedDecisionForest_BreastCancerDataSet_shouldReturnTrue);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -176,6 +181,115 @@ public:
   }
 
 
+  // ------------------------------------------------------------------------------------------------------
+  // ------------------------------------------------------------------------------------------------------
+  /*
+  The flattened forest has to predict the same labels and probabilities as vigra
+  */
+  void CompiledPrediction_BreastCancerDataSet_MatchesVigraPrediction()
+  {
+    auto & Features_Training = FeatureData_Cancer.first;
+    auto & Features_Testing = FeatureData_Cancer.second;
+    auto & Labels_Training = LabelData_Cancer.first;
+
+    classifier->Train(Features_Training,Labels_Training);
+    Eigen::MatrixXi expectedClasses = classifier->Predict(Features_Testing);
+    Eigen::MatrixXd expectedProbabilities = classifier->GetPointWiseProbabilities();
+
+    classifier->UseCompiledPrediction(true);
+    Eigen::MatrixXi classes = classifier->Predict(Features_Testing);
+    Eigen::MatrixXd probabilities = classifier->GetPointWiseProbabilities();
+
+    CPPUNIT_ASSERT_EQUAL(expectedClasses.rows(), classes.rows());
+    CPPUNIT_ASSERT_EQUAL(expectedProbabilities.cols(), probabilities.cols());
+    for (int i = 0; i < classes.rows(); ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL(expectedClasses(i,0), classes(i,0));
+      for (int j = 0; j < probabilities.cols(); ++j)
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedProbabilities(i,j), probabilities(i,j), 1e-12);
+    }
+
+    // All weights zero: no votes, every sample gets the first class
+    Eigen::MatrixXd weights(classifier->GetRandomForest().tree_count(),1);
+    weights.fill(0);
+    classifier->SetTreeWeights(weights);
+    classes = classifier->PredictWeighted(Features_Testing);
+    int firstClass;
+    classifier->GetRandomForest().ext_param_.to_classlabel(0, firstClass);
+    for (int i = 0; i < classes.rows(); ++i)
+      CPPUNIT_ASSERT_EQUAL(firstClass, classes(i,0));
+  }
+
+  // ------------------------------------------------------------------------------------------------------
+  // ------------------------------------------------------------------------------------------------------
+
+  void BinnedFeatures_FewDistinctValues_OneBinPerValue()
+  {
+    MatrixDoubleType features(6,1);
+    features << 3, 1, 2, 1, 3, 3;
+    vigra::MultiArrayView<2, double> X(vigra::Shape2(features.rows(),features.cols()),features.data());
+
+    mitk::BinnedFeatures binnedFeatures(X, 256, 1);
+
+    CPPUNIT_ASSERT_EQUAL(3, binnedFeatures.GetNumberOfBins(0));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5, binnedFeatures.GetThreshold(0, 0), 1e-12);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(2.5, binnedFeatures.GetThreshold(0, 1), 1e-12);
+
+    const int expectedBins[] = {2, 0, 1, 0, 2, 2};
+    for (int i = 0; i < 6; ++i)
+      CPPUNIT_ASSERT_EQUAL(expectedBins[i], static_cast<int>(binnedFeatures.GetColumn(0)[i]));
+  }
+
+  void BinnedFeatures_ManyDistinctValues_EqualValuesShareBin()
+  {
+    // 1000 samples, half of them have the value 0, the others are distinct
+    MatrixDoubleType features(1000,2);
+    for (int i = 0; i < 1000; ++i)
+    {
+      features(i,0) = i < 500 ? 0.0 : i;
+      features(i,1) = 999 - i;
+    }
+    vigra::MultiArrayView<2, double> X(vigra::Shape2(features.rows(),features.cols()),features.data());
+
+    mitk::BinnedFeatures binnedFeatures(X, 16, 2);
+
+    CPPUNIT_ASSERT(binnedFeatures.GetNumberOfBins(0) <= 16);
+    CPPUNIT_ASSERT_EQUAL(16, binnedFeatures.GetNumberOfBins(1));
+    for (int feature = 0; feature < 2; ++feature)
+    {
+      const mitk::BinnedFeatures::BinType *bins = binnedFeatures.GetColumn(feature);
+      for (int i = 0; i < 1000; ++i)
+      {
+        // bins are ordered like the values and consistent with the thresholds
+        const int bin = bins[i];
+        if (bin > 0)
+          CPPUNIT_ASSERT(features(i,feature) >= binnedFeatures.GetThreshold(feature, bin - 1));
+        if (bin + 1 < binnedFeatures.GetNumberOfBins(feature))
+          CPPUNIT_ASSERT(features(i,feature) < binnedFeatures.GetThreshold(feature, bin));
+      }
+    }
+    CPPUNIT_ASSERT_EQUAL(0, static_cast<int>(binnedFeatures.GetColumn(0)[499]));
+    CPPUNIT_ASSERT(binnedFeatures.GetColumn(0)[500] > 0);
+  }
+
+  /*
+  The feature values of the breast cancer data set are integers, so the binned training is exact
+  */
+  void TrainBinnedDecisionForest_BreastCancerDataSet_shouldReturnTrue()
+  {
+    auto & Features_Training = FeatureData_Cancer.first;
+    auto & Features_Testing = FeatureData_Cancer.second;
+    auto & Labels_Training = LabelData_Cancer.first;
+    auto & Labels_Testing = LabelData_Cancer.second;
+
+    classifier->UseBinnedSplitSearch(true);
+    classifier->Train(Features_Training,Labels_Training);
+    Eigen::MatrixXi classes = classifier->Predict(Features_Testing);
+
+    CPPUNIT_ASSERT_EQUAL(100, static_cast<int>(classifier->GetRandomForest().tree_count()));
+    MITK_TEST_CONDITION(isIntervall<int>(Labels_Testing,classes,98,99),"Testvalue of cancer data set is in range.");
+  }
+
   // ------------------------------------------------------------------------------------------------------
   // ------------------------------------------------------------------------------------------------------
   /*Reading an file, which includes the trainingdataset and the testdataset, and convert the
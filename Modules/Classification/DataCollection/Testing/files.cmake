@@ -1,5 +1,6 @@
 SET(MODULE_TESTS
   mitkDataCollectionImageIteratorTest.cpp
+  mitkDataCollectionFeatureStoreTest.cpp
 )
 
 SET(MODULE_CUSTOM_TESTS
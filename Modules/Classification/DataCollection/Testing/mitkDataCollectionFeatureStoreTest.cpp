@@ -0,0 +1,126 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkTestingMacros.h>
+
+#include <mitkDataCollection.h>
+#include <mitkDataCollectionFeatureStore.h>
+#include <mitkDataCollectionImageIterator.h>
+#include <mitkDataCollectionUtilities.h>
+
+#include <mitkImageGenerator.h>
+#include <mitkIOUtil.h>
+
+#include <cstdio>
+#include <fstream>
+
+class mitkDataCollectionFeatureStoreTestClass
+{
+public:
+  mitk::DataCollection::Pointer m_Collection;
+  std::vector<std::string> m_Names;
+
+  mitk::DataCollection::Pointer CreateSubject(unsigned int size)
+  {
+    mitk::DataCollection::Pointer subject = mitk::DataCollection::New();
+    subject->AddData(mitk::ImageGenerator::GenerateRandomImage<double>(size, size, size, 1, 1, 1, 1, 100, 0).GetPointer(), "F1");
+    subject->AddData(mitk::ImageGenerator::GenerateRandomImage<double>(size, size, size, 1, 1, 1, 1, 100, 0).GetPointer(), "F2");
+    subject->AddData(mitk::ImageGenerator::GenerateRandomImage<unsigned char>(size, size, size, 1, 1, 1, 1, 2, 0).GetPointer(), "Mask");
+    subject->AddData(mitk::ImageGenerator::GenerateRandomImage<unsigned char>(size, size, size, 1, 1, 1, 1, 2, 0).GetPointer(), "Sample");
+    return subject;
+  }
+
+  void Init()
+  {
+    m_Collection = mitk::DataCollection::New();
+    m_Collection->AddData(CreateSubject(4).GetPointer(), "0001");
+    m_Collection->AddData(CreateSubject(5).GetPointer(), "0002");
+
+    m_Names.clear();
+    m_Names.push_back("F2");
+    m_Names.push_back("F1");
+  }
+
+  void StoreMatchesFeatureMatrix()
+  {
+    Init();
+    const std::string fileName = mitk::IOUtil::CreateTemporaryFile("featurestore_XXXXXX.bin");
+    mitk::DataCollectionFeatureStore::Write(m_Collection, m_Names, "Mask", fileName);
+
+    mitk::DataCollectionFeatureStore::Pointer store = mitk::DataCollectionFeatureStore::New();
+    store->Open(fileName);
+
+    Eigen::MatrixXd expected = mitk::DCUtilities::DC3dDToMatrixXd(m_Collection, m_Names, "Mask");
+    MITK_TEST_CONDITION_REQUIRED(expected.rows() > 0, "Mask contains voxels");
+    MITK_TEST_CONDITION_REQUIRED(store->GetNumberOfRows() == static_cast<std::size_t>(expected.rows()), "Number of rows matches the number of masked voxels");
+    MITK_TEST_CONDITION_REQUIRED(store->GetFeatureNames() == m_Names, "Feature names are stored");
+    MITK_TEST_CONDITION(store->GetMatrix(m_Names) == expected, "Stored features match the feature matrix");
+    MITK_TEST_CONDITION(store->GetImageIndex(0) == 0 && store->GetImageIndex(store->GetNumberOfRows() - 1) == 1, "Rows are assigned to their images");
+
+    // Select a subset of rows, like a sampler that adds its selection as mask
+    mitk::DataCollectionImageIterator<unsigned char, 3> maskIter(m_Collection, "Mask");
+    mitk::DataCollectionImageIterator<unsigned char, 3> sampleIter(m_Collection, "Sample");
+    std::vector<std::size_t> expectedRows;
+    std::size_t row = 0;
+    for (; !maskIter.IsAtEnd(); ++maskIter, ++sampleIter)
+    {
+      if (maskIter.GetVoxel() > 0)
+      {
+        if (sampleIter.GetVoxel() > 0)
+          expectedRows.push_back(row);
+        ++row;
+      }
+    }
+    std::vector<std::size_t> rows = store->FindRows(m_Collection, "Sample");
+    MITK_TEST_CONDITION(rows == expectedRows, "Rows of the sampled voxels are found");
+
+    std::vector<std::string> names(1, "F1");
+    Eigen::MatrixXd sampled = store->GetRows(rows, names);
+    bool equal = sampled.rows() == static_cast<int>(rows.size());
+    for (std::size_t i = 0; equal && i < rows.size(); ++i)
+      equal = sampled(i, 0) == expected(rows[i], 1);
+    MITK_TEST_CONDITION(equal, "Sampled rows contain the feature values");
+
+    MITK_TEST_FOR_EXCEPTION(mitk::Exception, store->GetFeatureIndex("F3"));
+
+    store->Close();
+    std::remove(fileName.c_str());
+  }
+
+  void InvalidFileIsRejected()
+  {
+    std::ofstream stream;
+    const std::string fileName = mitk::IOUtil::CreateTemporaryFile(stream, "featurestore_XXXXXX.bin");
+    stream << "This is not a feature store";
+    stream.close();
+
+    mitk::DataCollectionFeatureStore::Pointer store = mitk::DataCollectionFeatureStore::New();
+    MITK_TEST_FOR_EXCEPTION(mitk::Exception, store->Open(fileName));
+    MITK_TEST_CONDITION(!store->IsOpen(), "Store is not opened");
+    std::remove(fileName.c_str());
+  }
+};
+
+int mitkDataCollectionFeatureStoreTest(int, char* [])
+{
+  MITK_TEST_BEGIN("mitkDataCollectionFeatureStoreTest");
+
+  mitkDataCollectionFeatureStoreTestClass test;
+  test.StoreMatchesFeatureMatrix();
+  test.InvalidFileIsRejected();
+
+  MITK_TEST_END();
+}
@@ -0,0 +1,308 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkDataCollectionFeatureStore.h>
+
+#include <mitkDataCollectionImageIterator.h>
+#include <mitkDataCollectionUtilities.h>
+#include <mitkExceptionMacro.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+  // File layout, all integers are 64 bit:
+  //   magic, version, number of rows, number of features,
+  //   per feature: length of the name and the name, padded to a multiple of 8 bytes,
+  //   image index of every row, voxel index of every row,
+  //   per feature: the values of all rows
+  const char FileMagic[8] = { 'M', 'I', 'T', 'K', 'D', 'C', 'F', 'S' };
+  const std::uint64_t FileVersion = 1;
+
+  // Number of values that are collected before they are written
+  const std::size_t ChunkSize = 1 << 16;
+
+  void WriteUInt64(std::ofstream &stream, std::uint64_t value)
+  {
+    stream.write(reinterpret_cast<const char *>(&value), sizeof(value));
+  }
+
+  template <typename TValueType>
+  void WriteChunk(std::ofstream &stream, std::vector<TValueType> &chunk)
+  {
+    if (!chunk.empty())
+      stream.write(reinterpret_cast<const char *>(chunk.data()), chunk.size() * sizeof(TValueType));
+    chunk.clear();
+  }
+
+  std::size_t PaddedLength(std::size_t length)
+  {
+    return (length + 7) / 8 * 8;
+  }
+}
+
+void mitk::DataCollectionFeatureStore::Write(mitk::DataCollection::Pointer dc, const std::vector<std::string> &names, const std::string &mask, const std::string &fileName)
+{
+  typedef mitk::DataCollectionImageIterator<double, 3> DataIterType;
+  typedef mitk::DataCollectionImageIterator<unsigned char, 3> MaskIterType;
+
+  const std::uint64_t numberOfRows = DCUtilities::VoxelInMask(dc, mask);
+
+  std::ofstream stream(fileName.c_str(), std::ios::binary | std::ios::trunc);
+  if (!stream.is_open())
+    mitkThrow() << "Cannot open feature store " << fileName << " for writing";
+
+  stream.write(FileMagic, sizeof(FileMagic));
+  WriteUInt64(stream, FileVersion);
+  WriteUInt64(stream, numberOfRows);
+  WriteUInt64(stream, names.size());
+  for (const auto &name : names)
+  {
+    WriteUInt64(stream, name.size());
+    std::string paddedName(name);
+    paddedName.resize(PaddedLength(name.size()), '\0');
+    stream.write(paddedName.data(), paddedName.size());
+  }
+
+  // Mask index, the image indices and the voxel indices are written in two passes over the mask
+  std::vector<std::uint64_t> indexChunk;
+  indexChunk.reserve(ChunkSize);
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    std::uint64_t row = 0;
+    for (MaskIterType maskIter(dc, mask); !maskIter.IsAtEnd(); ++maskIter)
+    {
+      if (maskIter.GetVoxel() > 0)
+      {
+        indexChunk.push_back(pass == 0 ? maskIter.GetImageIndex() : maskIter.GetIndex());
+        ++row;
+        if (indexChunk.size() == ChunkSize)
+          WriteChunk(stream, indexChunk);
+      }
+    }
+    WriteChunk(stream, indexChunk);
+    if (row != numberOfRows)
+      mitkThrow() << "Mask " << mask << " changed while writing feature store " << fileName;
+  }
+
+  // One pass per feature, so that only the current feature is read
+  std::vector<double> valueChunk;
+  valueChunk.reserve(ChunkSize);
+  for (const auto &name : names)
+  {
+    std::uint64_t row = 0;
+    MaskIterType maskIter(dc, mask);
+    DataIterType dataIter(dc, name);
+    for (; !maskIter.IsAtEnd() && !dataIter.IsAtEnd(); ++maskIter, ++dataIter)
+    {
+      if (maskIter.GetVoxel() > 0)
+      {
+        valueChunk.push_back(dataIter.GetVoxel());
+        ++row;
+        if (valueChunk.size() == ChunkSize)
+          WriteChunk(stream, valueChunk);
+      }
+    }
+    WriteChunk(stream, valueChunk);
+    if (row != numberOfRows || !maskIter.IsAtEnd())
+      mitkThrow() << "Feature " << name << " does not cover mask " << mask << " in all images of the collection";
+  }
+
+  stream.close();
+  if (stream.fail())
+    mitkThrow() << "Writing feature store " << fileName << " failed";
+}
+
+mitk::DataCollectionFeatureStore::DataCollectionFeatureStore() :
+  m_NumberOfRows(0),
+  m_ImageIndex(nullptr),
+  m_VoxelIndex(nullptr),
+  m_Features(nullptr)
+{
+}
+
+mitk::DataCollectionFeatureStore::~DataCollectionFeatureStore()
+{
+}
+
+void mitk::DataCollectionFeatureStore::Open(const std::string &fileName)
+{
+  this->Close();
+
+  mitk::MemoryMappedFile::Pointer file = mitk::MemoryMappedFile::New();
+  file->Open(fileName);
+
+  const char *data = static_cast<const char *>(file->GetData());
+  const std::size_t size = file->GetSize();
+  std::size_t position = 0;
+
+  auto readUInt64 = [&]() -> std::uint64_t
+  {
+    if (size - position < sizeof(std::uint64_t))
+      mitkThrow() << "Feature store " << fileName << " is truncated";
+    std::uint64_t value;
+    std::memcpy(&value, data + position, sizeof(value));
+    position += sizeof(value);
+    return value;
+  };
+
+  if (size < sizeof(FileMagic) || std::memcmp(data, FileMagic, sizeof(FileMagic)) != 0)
+    mitkThrow() << fileName << " is not a feature store";
+  position += sizeof(FileMagic);
+  if (readUInt64() != FileVersion)
+    mitkThrow() << "Feature store " << fileName << " has an unsupported version";
+
+  const std::uint64_t numberOfRows = readUInt64();
+  const std::uint64_t numberOfFeatures = readUInt64();
+
+  std::vector<std::string> names;
+  for (std::uint64_t i = 0; i < numberOfFeatures; ++i)
+  {
+    const std::uint64_t length = readUInt64();
+    if (length > size - position || PaddedLength(length) > size - position)
+      mitkThrow() << "Feature store " << fileName << " is truncated";
+    names.push_back(std::string(data + position, length));
+    position += PaddedLength(length);
+  }
+
+  // The mapping starts at a page boundary and all sections have a multiple of 8 bytes, so the
+  // index and the values are properly aligned
+  const std::size_t expectedSize = position + numberOfRows * (2 * sizeof(std::uint64_t) + numberOfFeatures * sizeof(double));
+  if (size != expectedSize)
+    mitkThrow() << "Feature store " << fileName << " has " << size << " bytes instead of " << expectedSize;
+
+  m_File = file;
+  m_FeatureNames = names;
+  m_NumberOfRows = numberOfRows;
+  m_ImageIndex = reinterpret_cast<const std::uint64_t *>(data + position);
+  m_VoxelIndex = m_ImageIndex + numberOfRows;
+  m_Features = reinterpret_cast<const double *>(m_VoxelIndex + numberOfRows);
+}
+
+void mitk::DataCollectionFeatureStore::Close()
+{
+  m_File = nullptr;
+  m_FeatureNames.clear();
+  m_NumberOfRows = 0;
+  m_ImageIndex = nullptr;
+  m_VoxelIndex = nullptr;
+  m_Features = nullptr;
+}
+
+bool mitk::DataCollectionFeatureStore::IsOpen() const
+{
+  return m_File.IsNotNull();
+}
+
+std::size_t mitk::DataCollectionFeatureStore::GetNumberOfRows() const
+{
+  return m_NumberOfRows;
+}
+
+std::size_t mitk::DataCollectionFeatureStore::GetNumberOfFeatures() const
+{
+  return m_FeatureNames.size();
+}
+
+const std::vector<std::string> &mitk::DataCollectionFeatureStore::GetFeatureNames() const
+{
+  return m_FeatureNames;
+}
+
+std::size_t mitk::DataCollectionFeatureStore::GetFeatureIndex(const std::string &name) const
+{
+  for (std::size_t i = 0; i < m_FeatureNames.size(); ++i)
+  {
+    if (m_FeatureNames[i] == name)
+      return i;
+  }
+  mitkThrow() << "Feature " << name << " is not part of the feature store";
+}
+
+const double *mitk::DataCollectionFeatureStore::GetFeature(std::size_t column) const
+{
+  if (column >= m_FeatureNames.size())
+    mitkThrow() << "Feature store has no column " << column;
+  return m_Features + column * m_NumberOfRows;
+}
+
+std::uint64_t mitk::DataCollectionFeatureStore::GetImageIndex(std::size_t row) const
+{
+  if (row >= m_NumberOfRows)
+    mitkThrow() << "Feature store has no row " << row;
+  return m_ImageIndex[row];
+}
+
+std::uint64_t mitk::DataCollectionFeatureStore::GetVoxelIndex(std::size_t row) const
+{
+  if (row >= m_NumberOfRows)
+    mitkThrow() << "Feature store has no row " << row;
+  return m_VoxelIndex[row];
+}
+
+std::vector<std::size_t> mitk::DataCollectionFeatureStore::FindRows(mitk::DataCollection::Pointer dc, const std::string &mask) const
+{
+  std::vector<std::size_t> rows;
+
+  // Both the stored voxel indices and the iteration are in ascending order
+  std::size_t row = 0;
+  mitk::DataCollectionImageIterator<unsigned char, 3> maskIter(dc, mask);
+  for (; !maskIter.IsAtEnd() && row < m_NumberOfRows; ++maskIter)
+  {
+    if (maskIter.GetVoxel() > 0)
+    {
+      const std::uint64_t voxel = maskIter.GetIndex();
+      while (row < m_NumberOfRows && m_VoxelIndex[row] < voxel)
+        ++row;
+      if (row < m_NumberOfRows && m_VoxelIndex[row] == voxel)
+        rows.push_back(row);
+    }
+  }
+  return rows;
+}
+
+Eigen::MatrixXd mitk::DataCollectionFeatureStore::GetRows(const std::vector<std::size_t> &rows, const std::vector<std::string> &names) const
+{
+  for (auto row : rows)
+  {
+    if (row >= m_NumberOfRows)
+      mitkThrow() << "Feature store has no row " << row;
+  }
+
+  Eigen::MatrixXd result(rows.size(), names.size());
+  for (std::size_t col = 0; col < names.size(); ++col)
+  {
+    const double *feature = this->GetFeature(this->GetFeatureIndex(names[col]));
+    for (std::size_t i = 0; i < rows.size(); ++i)
+    {
+      result(i, col) = feature[rows[i]];
+    }
+  }
+  return result;
+}
+
+Eigen::MatrixXd mitk::DataCollectionFeatureStore::GetMatrix(const std::vector<std::string> &names) const
+{
+  Eigen::MatrixXd result(m_NumberOfRows, names.size());
+  for (std::size_t col = 0; col < names.size(); ++col)
+  {
+    const double *feature = this->GetFeature(this->GetFeatureIndex(names[col]));
+    std::copy(feature, feature + m_NumberOfRows, result.col(col).data());
+  }
+  return result;
+}
@@ -0,0 +1,124 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkDataCollectionFeatureStore_h
+#define mitkDataCollectionFeatureStore_h
+
+#include <MitkDataCollectionExports.h>
+
+#include <mitkDataCollection.h>
+#include <mitkMemoryMappedFile.h>
+
+#include <itkLightObject.h>
+
+#include <Eigen/Dense>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mitk
+{
+  /**
+  * \brief Memory mapped file with the feature values of all masked voxels of a DataCollection.
+  *
+  * Write() stores, for every voxel of the collection with a mask value greater than 0, the values of
+  * the given feature images in the order in which DCUtilities::DC3dDToMatrixXd() would create the rows
+  * of a feature matrix. The file contains one column per feature (all rows of a feature are stored
+  * contiguously) and a mask index that maps every row to the image and the voxel of the collection it
+  * originates from. The features are written one after another in chunks, so that neither all feature
+  * images nor the complete matrix have to be held in memory.
+  *
+  * After Open() the file is memory mapped and the operating system loads only the parts that are
+  * actually read. Training matrices for a subset of rows, e.g. voxels selected by a sampler such as
+  * mitk::RandomImageSampler or itk::LabelSampler that have been added as mask to the collection, are
+  * obtained with FindRows() and GetRows(). Stores can be reused between experiments as long as the
+  * collection and the mask are unchanged.
+  *
+  * The values are stored as double in the byte order of the writing machine.
+  */
+  class MITKDATACOLLECTION_EXPORT DataCollectionFeatureStore : public itk::LightObject
+  {
+  public:
+    mitkClassMacroItkParent(DataCollectionFeatureStore, itk::LightObject)
+      itkFactorylessNewMacro(Self)
+
+    /**
+    * \brief Writes the features names of all voxels within mask to fileName. Throws an mitk::Exception on failure.
+    */
+    static void Write(mitk::DataCollection::Pointer dc, const std::vector<std::string> &names, const std::string &mask, const std::string &fileName);
+
+    /**
+    * \brief Maps a file that has been created by Write(). Throws an mitk::Exception if the file is not valid.
+    */
+    void Open(const std::string &fileName);
+    void Close();
+    bool IsOpen() const;
+
+    std::size_t GetNumberOfRows() const;
+    std::size_t GetNumberOfFeatures() const;
+    const std::vector<std::string> &GetFeatureNames() const;
+
+    /**
+    * \brief Returns the column of the feature name. Throws an mitk::Exception if the feature is not stored.
+    */
+    std::size_t GetFeatureIndex(const std::string &name) const;
+
+    /**
+    * \brief Values of all rows of a feature. The pointer is valid until the store is closed.
+    */
+    const double *GetFeature(std::size_t column) const;
+
+    /** \brief Index of the image within the collection from which row originates. */
+    std::uint64_t GetImageIndex(std::size_t row) const;
+
+    /** \brief Voxel index of row in the iteration order of mitk::DataCollectionImageIterator. */
+    std::uint64_t GetVoxelIndex(std::size_t row) const;
+
+    /**
+    * \brief Returns the rows of the voxels with a value greater than 0 in mask. The mask has to be a subset
+    * of the mask the store has been written with, voxels outside of the stored mask are ignored.
+    */
+    std::vector<std::size_t> FindRows(mitk::DataCollection::Pointer dc, const std::string &mask) const;
+
+    /**
+    * \brief Copies the given rows of the features names into a matrix, in the order of rows and names.
+    */
+    Eigen::MatrixXd GetRows(const std::vector<std::size_t> &rows, const std::vector<std::string> &names) const;
+
+    /**
+    * \brief Copies all rows of the features names, like DCUtilities::DC3dDToMatrixXd().
+    */
+    Eigen::MatrixXd GetMatrix(const std::vector<std::string> &names) const;
+
+  protected:
+    DataCollectionFeatureStore();
+    ~DataCollectionFeatureStore() override;
+
+  private:
+    DataCollectionFeatureStore(const Self &) = delete;
+    Self &operator=(const Self &) = delete;
+
+    mitk::MemoryMappedFile::Pointer m_File;
+    std::vector<std::string> m_FeatureNames;
+    std::size_t m_NumberOfRows;
+    const std::uint64_t *m_ImageIndex;
+    const std::uint64_t *m_VoxelIndex;
+    const double *m_Features;
+  };
+}
+
+#endif //mitkDataCollectionFeatureStore_h
@@ -0,0 +1,332 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkImageToContourModelSetFilter.h"
+#include "mitkImageAccessByItk.h"
+#include "mitkImageTimeSelector.h"
+
+#include <itkContourExtractor2DImageFilter.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+  typedef std::vector<mitk::Point3D> PointListType;
+
+  // work items are handed out one by one, the number of contours per item varies too much for static chunks
+  template <typename TFunction>
+  void ParallelFor(std::size_t count, unsigned int numberOfThreads, const TFunction &function)
+  {
+    if (numberOfThreads <= 1)
+    {
+      for (std::size_t i = 0; i < count; ++i)
+        function(i);
+      return;
+    }
+
+    std::atomic<std::size_t> next(0);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < numberOfThreads; ++t)
+    {
+      threads.emplace_back([&]() {
+        try
+        {
+          for (std::size_t i = next++; i < count; i = next++)
+            function(i);
+        }
+        catch (...)
+        {
+          std::lock_guard<std::mutex> lock(errorMutex);
+          if (!error)
+            error = std::current_exception();
+          next = count;
+        }
+      });
+    }
+    for (auto &thread : threads)
+      thread.join();
+
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+  struct SliceLabel
+  {
+    unsigned int Slice;
+    mitk::ImageToContourModelSetFilter::LabelValueType Label;
+  };
+}
+
+mitk::ImageToContourModelSetFilter::ImageToContourModelSetFilter()
+  : m_SliceDimension(2), m_TimeStep(0), m_NumberOfThreads(0)
+{
+}
+
+mitk::ImageToContourModelSetFilter::~ImageToContourModelSetFilter()
+{
+}
+
+void mitk::ImageToContourModelSetFilter::SetInput(const mitk::ImageToContourModelSetFilter::InputType *input)
+{
+  if (input != static_cast<InputType *>(this->ProcessObject::GetInput(0)))
+  {
+    this->ProcessObject::SetNthInput(0, const_cast<InputType *>(input));
+    this->Modified();
+  }
+}
+
+const mitk::ImageToContourModelSetFilter::InputType *mitk::ImageToContourModelSetFilter::GetInput(void)
+{
+  if (this->GetNumberOfInputs() < 1)
+    return nullptr;
+  return static_cast<const mitk::ImageToContourModelSetFilter::InputType *>(this->ProcessObject::GetInput(0));
+}
+
+void mitk::ImageToContourModelSetFilter::SetLabels(const LabelVectorType &labels)
+{
+  LabelVectorType sortedLabels = labels;
+  std::sort(sortedLabels.begin(), sortedLabels.end());
+  sortedLabels.erase(std::unique(sortedLabels.begin(), sortedLabels.end()), sortedLabels.end());
+
+  if (sortedLabels != m_Labels)
+  {
+    m_Labels = sortedLabels;
+    this->Modified();
+  }
+}
+
+const mitk::ImageToContourModelSetFilter::LabelVectorType &mitk::ImageToContourModelSetFilter::GetLabels() const
+{
+  return m_Labels;
+}
+
+const mitk::ImageToContourModelSetFilter::LabelVectorType &mitk::ImageToContourModelSetFilter::GetOutputLabels() const
+{
+  return m_OutputLabels;
+}
+
+mitk::ContourModelSet *mitk::ImageToContourModelSetFilter::GetOutputForLabel(LabelValueType label)
+{
+  auto iter = std::lower_bound(m_OutputLabels.begin(), m_OutputLabels.end(), label);
+  if (iter == m_OutputLabels.end() || *iter != label)
+    return nullptr;
+  return this->GetOutput(static_cast<unsigned int>(iter - m_OutputLabels.begin()));
+}
+
+unsigned int mitk::ImageToContourModelSetFilter::GetNumberOfThreadsToUse(std::size_t numberOfTasks) const
+{
+  unsigned int numberOfThreads = m_NumberOfThreads;
+  if (numberOfThreads == 0)
+    numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+  return static_cast<unsigned int>(std::min<std::size_t>(numberOfThreads, numberOfTasks));
+}
+
+void mitk::ImageToContourModelSetFilter::GenerateData()
+{
+  mitk::Image::ConstPointer image = this->GetInput();
+
+  if (image.IsNull())
+  {
+    itkExceptionMacro("mitk::ImageToContourModelSetFilter: No input available. Please set the input!");
+  }
+
+  if (image->GetDimension() < 3 || image->GetDimension() > 4)
+  {
+    itkExceptionMacro("mitk::ImageToContourModelSetFilter::GenerateData() works only with 3D or 4D images.");
+  }
+
+  if (m_SliceDimension > 2)
+  {
+    itkExceptionMacro("mitk::ImageToContourModelSetFilter: Invalid slice dimension " << m_SliceDimension << ".");
+  }
+
+  if (m_TimeStep >= image->GetTimeSteps())
+  {
+    itkExceptionMacro("mitk::ImageToContourModelSetFilter: Invalid time step " << m_TimeStep << ".");
+  }
+
+  if (image->GetDimension() == 4)
+  {
+    mitk::ImageTimeSelector::Pointer timeSelector = mitk::ImageTimeSelector::New();
+    timeSelector->SetInput(image);
+    timeSelector->SetTimeNr(m_TimeStep);
+    timeSelector->UpdateLargestPossibleRegion();
+    image = timeSelector->GetOutput();
+  }
+
+  AccessFixedDimensionByItk_n(image, ItkContourExtraction, 3, (image->GetGeometry()));
+}
+
+template <typename TPixel, unsigned int VImageDimension>
+void mitk::ImageToContourModelSetFilter::ItkContourExtraction(const itk::Image<TPixel, VImageDimension> *image,
+                                                              const BaseGeometry *geometry)
+{
+  typedef itk::Image<TPixel, VImageDimension> ImageType;
+  typedef itk::Image<unsigned char, 2> MaskSliceType;
+  typedef itk::ContourExtractor2DImageFilter<MaskSliceType> ContourExtractorType;
+  typedef itk::PolyLineParametricPath<2>::VertexListType ContourPath;
+
+  const typename ImageType::RegionType region = image->GetBufferedRegion();
+  const unsigned int sliceDimension = m_SliceDimension;
+  const unsigned int dim0 = sliceDimension == 0 ? 1 : 0;
+  const unsigned int dim1 = sliceDimension == 2 ? 1 : 2;
+  const unsigned int numberOfSlices = static_cast<unsigned int>(region.GetSize(sliceDimension));
+
+  auto getSliceRegion = [&](unsigned int slice) {
+    typename ImageType::RegionType sliceRegion = region;
+    sliceRegion.SetIndex(sliceDimension, region.GetIndex(sliceDimension) + slice);
+    sliceRegion.SetSize(sliceDimension, 1);
+    return sliceRegion;
+  };
+
+  // Occupancy table: the sorted labels of each slice. Segmentations are mostly runs of equal values,
+  // the comparison with the previous pixel keeps the search in the label list out of the inner loop.
+  std::vector<LabelVectorType> occupancy(numberOfSlices);
+  ParallelFor(numberOfSlices, this->GetNumberOfThreadsToUse(numberOfSlices), [&](std::size_t slice) {
+    LabelVectorType &labels = occupancy[slice];
+    LabelValueType previous = 0;
+    itk::ImageRegionConstIterator<ImageType> iter(image, getSliceRegion(static_cast<unsigned int>(slice)));
+    for (iter.GoToBegin(); !iter.IsAtEnd(); ++iter)
+    {
+      const LabelValueType value = static_cast<LabelValueType>(iter.Get());
+      if (value == 0 || value == previous)
+        continue;
+      previous = value;
+
+      auto position = std::lower_bound(labels.begin(), labels.end(), value);
+      if (position == labels.end() || *position != value)
+        labels.insert(position, value);
+    }
+  });
+
+  // Tasks ordered by label and slice, so that the results can be appended to the outputs in order
+  LabelVectorType foundLabels;
+  for (const auto &labels : occupancy)
+  {
+    for (LabelValueType label : labels)
+    {
+      if (m_Labels.empty() || std::binary_search(m_Labels.begin(), m_Labels.end(), label))
+        foundLabels.push_back(label);
+    }
+  }
+  std::sort(foundLabels.begin(), foundLabels.end());
+  foundLabels.erase(std::unique(foundLabels.begin(), foundLabels.end()), foundLabels.end());
+
+  std::vector<SliceLabel> tasks;
+  for (LabelValueType label : foundLabels)
+  {
+    for (unsigned int slice = 0; slice < numberOfSlices; ++slice)
+    {
+      if (std::binary_search(occupancy[slice].begin(), occupancy[slice].end(), label))
+        tasks.push_back({slice, label});
+    }
+  }
+
+  // The 2D mask is padded by one pixel at each edge, the ITK contour extractor fails if the
+  // segmentation touches more than one image edge. Its index region starts at -1, so that the
+  // vertices are index coordinates of the volume.
+  MaskSliceType::IndexType maskIndex;
+  maskIndex[0] = region.GetIndex(dim0) - 1;
+  maskIndex[1] = region.GetIndex(dim1) - 1;
+  MaskSliceType::SizeType maskSize;
+  maskSize[0] = region.GetSize(dim0) + 2;
+  maskSize[1] = region.GetSize(dim1) + 2;
+  const MaskSliceType::RegionType maskRegion(maskIndex, maskSize);
+
+  // the slice region is traversed with dim0 running fastest, the same order as the inner mask region
+  MaskSliceType::IndexType innerIndex;
+  innerIndex[0] = region.GetIndex(dim0);
+  innerIndex[1] = region.GetIndex(dim1);
+  MaskSliceType::SizeType innerSize;
+  innerSize[0] = region.GetSize(dim0);
+  innerSize[1] = region.GetSize(dim1);
+  const MaskSliceType::RegionType innerRegion(innerIndex, innerSize);
+
+  std::vector<std::vector<PointListType>> results(tasks.size());
+  ParallelFor(tasks.size(), this->GetNumberOfThreadsToUse(tasks.size()), [&](std::size_t i) {
+    const SliceLabel &task = tasks[i];
+
+    MaskSliceType::Pointer mask = MaskSliceType::New();
+    mask->SetRegions(maskRegion);
+    mask->Allocate();
+    mask->FillBuffer(0);
+
+    itk::ImageRegionConstIterator<ImageType> imageIter(image, getSliceRegion(task.Slice));
+    itk::ImageRegionIterator<MaskSliceType> maskIter(mask, innerRegion);
+    for (; !imageIter.IsAtEnd(); ++imageIter, ++maskIter)
+    {
+      if (static_cast<LabelValueType>(imageIter.Get()) == task.Label)
+        maskIter.Set(1);
+    }
+
+    ContourExtractorType::Pointer contourExtractor = ContourExtractorType::New();
+    contourExtractor->SetInput(mask);
+    contourExtractor->SetContourValue(0.5);
+    contourExtractor->Update();
+
+    mitk::Point3D indexPoint;
+    indexPoint[sliceDimension] = region.GetIndex(sliceDimension) + task.Slice;
+
+    const unsigned int foundPaths = contourExtractor->GetNumberOfOutputs();
+    results[i].resize(foundPaths);
+    for (unsigned int j = 0; j < foundPaths; ++j)
+    {
+      const ContourPath *currentPath = contourExtractor->GetOutput(j)->GetVertexList();
+      PointListType &points = results[i][j];
+      points.resize(currentPath->Size());
+      for (unsigned int k = 0; k < currentPath->Size(); ++k)
+      {
+        indexPoint[dim0] = currentPath->ElementAt(k)[0];
+        indexPoint[dim1] = currentPath->ElementAt(k)[1];
+        geometry->IndexToWorld(indexPoint, points[k]);
+      }
+    }
+  });
+
+  // there is always at least one output, it stays empty if no label was found
+  m_OutputLabels = foundLabels;
+  const unsigned int numberOfOutputs = std::max<unsigned int>(1, static_cast<unsigned int>(foundLabels.size()));
+  this->SetNumberOfIndexedOutputs(numberOfOutputs);
+  for (unsigned int i = 0; i < numberOfOutputs; ++i)
+  {
+    if (this->GetOutput(i) == nullptr)
+      this->SetNthOutput(i, this->MakeOutput(i));
+    this->GetOutput(i)->Clear();
+  }
+
+  for (std::size_t i = 0; i < tasks.size(); ++i)
+  {
+    const auto labelIter = std::lower_bound(m_OutputLabels.begin(), m_OutputLabels.end(), tasks[i].Label);
+    mitk::ContourModelSet *output = this->GetOutput(static_cast<unsigned int>(labelIter - m_OutputLabels.begin()));
+
+    for (const PointListType &points : results[i])
+    {
+      mitk::ContourModel::Pointer contour = mitk::ContourModel::New();
+      for (const mitk::Point3D &point : points)
+        contour->AddVertex(point);
+      contour->Close();
+      output->AddContourModel(contour);
+    }
+  }
+}
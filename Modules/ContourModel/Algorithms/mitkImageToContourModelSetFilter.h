@@ -0,0 +1,103 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef _mitkImageToContourModelSetFilter_h__
+#define _mitkImageToContourModelSetFilter_h__
+
+#include "mitkCommon.h"
+#include "mitkContourModelSet.h"
+#include "mitkContourModelSetSource.h"
+#include <MitkContourModelExports.h>
+#include <mitkImage.h>
+
+#include <vector>
+
+namespace mitk
+{
+  /**
+  *
+  * \brief Extracts the contours of all labels of a 3D (multi-)label image, slice by slice
+  *
+  * The image is cut into slices perpendicular to the index axis SliceDimension (2, i.e. the axial
+  * slices of an unrotated image, by default). A single pass over the volume records which labels
+  * are present in which slice, only the non-empty (slice, label) pairs are then handed to
+  * itk::ContourExtractor2DImageFilter. These pairs are independent and are processed by
+  * NumberOfThreads threads (0, the default, uses one thread per hardware core).
+  *
+  * Every pixel value other than 0 is regarded as a label, SetLabels() restricts the extraction to
+  * the given values. There is one output per label that was found, holding the closed contours of
+  * that label in world coordinates, ordered by slice index. GetOutputLabels() tells the label of
+  * each output. 4D images are reduced to the time step TimeStep first.
+  *
+  * @ingroup MitkContourModelModule
+  */
+  class MITKCONTOURMODEL_EXPORT ImageToContourModelSetFilter : public ContourModelSetSource
+  {
+  public:
+    mitkClassMacro(ImageToContourModelSetFilter, ContourModelSetSource);
+    itkFactorylessNewMacro(Self) itkCloneMacro(Self)
+
+      typedef mitk::Image InputType;
+    typedef int LabelValueType;
+    typedef std::vector<LabelValueType> LabelVectorType;
+
+    using Superclass::SetInput;
+
+    virtual void SetInput(const InputType *input);
+
+    const InputType *GetInput(void);
+
+    itkSetMacro(SliceDimension, unsigned int);
+    itkGetConstMacro(SliceDimension, unsigned int);
+
+    itkSetMacro(TimeStep, unsigned int);
+    itkGetConstMacro(TimeStep, unsigned int);
+
+    itkSetMacro(NumberOfThreads, unsigned int);
+    itkGetConstMacro(NumberOfThreads, unsigned int);
+
+    /** Labels to extract, an empty vector (default) extracts every label of the image */
+    void SetLabels(const LabelVectorType &labels);
+    const LabelVectorType &GetLabels() const;
+
+    /** Label of each output of the last update, in ascending order */
+    const LabelVectorType &GetOutputLabels() const;
+
+    /** Output that holds the contours of label or nullptr if the label was not found */
+    ContourModelSet *GetOutputForLabel(LabelValueType label);
+
+  protected:
+    ImageToContourModelSetFilter();
+
+    ~ImageToContourModelSetFilter() override;
+
+    void GenerateData() override;
+
+    template <typename TPixel, unsigned int VImageDimension>
+    void ItkContourExtraction(const itk::Image<TPixel, VImageDimension> *image, const BaseGeometry *geometry);
+
+  private:
+    unsigned int GetNumberOfThreadsToUse(std::size_t numberOfTasks) const;
+
+    unsigned int m_SliceDimension;
+    unsigned int m_TimeStep;
+    unsigned int m_NumberOfThreads;
+    LabelVectorType m_Labels;
+    LabelVectorType m_OutputLabels;
+  };
+}
+
+#endif
@@ -31,6 +31,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkContourModel.h"
 #include "mitkTextAnnotation2D.h"
 
+#include <algorithm>
+
+namespace
+{
+  // vertices closer to the current plane are drawn
+  const mitk::ScalarType MaximumPlaneDistance = 0.25;
+}
+
 mitk::ContourModelGLMapper2DBase::ContourModelGLMapper2DBase(): m_Initialized(false)
 {
   m_PointNumbersAnnotation = mitk::TextAnnotation2D::New();
@@ -72,6 +80,121 @@ void mitk::ContourModelGLMapper2DBase::ApplyColorAndOpacityProperties(mitk::Base
 }
 
 void mitk::ContourModelGLMapper2DBase::DrawContour(mitk::ContourModel *renderingContour, mitk::BaseRenderer *renderer)
+{
+  InternalDrawContour(renderingContour, renderer);
+}
+
+void mitk::ContourModelGLMapper2DBase::InternalDrawContour(mitk::ContourModel *renderingContour,
+                                                           mitk::BaseRenderer *renderer)
+{
+  if (!renderingContour)
+    return;
+
+  // single contours are usually edited interactively, not all edits modify the contour
+  this->DrawContours(std::vector<mitk::ContourModel *>(1, renderingContour), renderer, false);
+}
+
+const mitk::ContourModelGLMapper2DBase::TransformedContour &mitk::ContourModelGLMapper2DBase::GetTransformedContour(
+  mitk::ContourModel *contour, unsigned int timestep, vtkLinearTransform *transform, bool useCache)
+{
+  TransformedContour &transformed = useCache ? m_ContourCache[std::make_pair(contour, timestep)] : m_UncachedContour;
+  transformed.Used = true;
+
+  const auto numberOfVertices = static_cast<std::size_t>(contour->GetNumberOfVertices(timestep));
+  if (useCache && transformed.ContourMTime == contour->GetMTime() &&
+      transformed.TransformMTime == transform->GetMTime() && transformed.Points.size() == numberOfVertices)
+  {
+    return transformed;
+  }
+
+  transformed.ContourMTime = contour->GetMTime();
+  transformed.TransformMTime = transform->GetMTime();
+  transformed.Closed = contour->IsClosed(timestep);
+  transformed.Points.clear();
+  transformed.IsControlPoint.clear();
+  transformed.Points.reserve(numberOfVertices);
+  transformed.IsControlPoint.reserve(numberOfVertices);
+
+  for (auto it = contour->IteratorBegin(timestep); it != contour->IteratorEnd(timestep); ++it)
+  {
+    double vtkp[3];
+    itk2vtk((*it)->Coordinates, vtkp);
+    transform->TransformPoint(vtkp, vtkp);
+
+    Point3D p;
+    vtk2itk(vtkp, p);
+    transformed.Points.push_back(p);
+    transformed.IsControlPoint.push_back((*it)->IsControlPoint);
+  }
+
+  if (!transformed.Points.empty())
+  {
+    transformed.BoundsMin = transformed.Points.front();
+    transformed.BoundsMax = transformed.Points.front();
+    for (const auto &p : transformed.Points)
+    {
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        transformed.BoundsMin[i] = std::min(transformed.BoundsMin[i], p[i]);
+        transformed.BoundsMax[i] = std::max(transformed.BoundsMax[i], p[i]);
+      }
+    }
+  }
+
+  return transformed;
+}
+
+bool mitk::ContourModelGLMapper2DBase::IsCloseToPlane(const TransformedContour &contour, const PlaneGeometry *plane)
+{
+  if (contour.Points.empty())
+    return false;
+
+  // the signed distance is linear, so the contour is far from the plane if all corners of its bounds are
+  bool allAbove = true;
+  bool allBelow = true;
+  for (unsigned int corner = 0; corner < 8; ++corner)
+  {
+    Point3D p;
+    p[0] = (corner & 1) ? contour.BoundsMax[0] : contour.BoundsMin[0];
+    p[1] = (corner & 2) ? contour.BoundsMax[1] : contour.BoundsMin[1];
+    p[2] = (corner & 4) ? contour.BoundsMax[2] : contour.BoundsMin[2];
+
+    const ScalarType distance = plane->SignedDistance(p);
+    allAbove = allAbove && distance >= MaximumPlaneDistance;
+    allBelow = allBelow && distance <= -MaximumPlaneDistance;
+  }
+
+  return !allAbove && !allBelow;
+}
+
+void mitk::ContourModelGLMapper2DBase::DrawPointMarker(const Point2D &point,
+                                                       float size,
+                                                       const double markerColor[3],
+                                                       const double pointColor[3])
+{
+  // a rectangle around the point with the marker color
+  float rectPts[8];
+  rectPts[0] = point[0] - size;
+  rectPts[1] = point[1];
+  rectPts[2] = point[0];
+  rectPts[3] = point[1] + size;
+  rectPts[4] = point[0] + size;
+  rectPts[5] = point[1];
+  rectPts[6] = point[0];
+  rectPts[7] = point[1] - size;
+
+  this->m_Context->GetPen()->SetColorF(markerColor[0], markerColor[1], markerColor[2]);
+  this->m_Context->GetPen()->SetWidth(1);
+  this->m_Context->DrawPolygon(rectPts, 4);
+
+  // the actual point in the specified color to see the usual color of the point
+  this->m_Context->GetPen()->SetColorF(pointColor[0], pointColor[1], pointColor[2]);
+  this->m_Context->DrawPoint(point[0], point[1]);
+}
+
+void mitk::ContourModelGLMapper2DBase::DrawContours(const std::vector<mitk::ContourModel *> &contours,
+                                                    mitk::BaseRenderer *renderer,
+                                                    bool useCache)
 {
   if (std::find(m_RendererList.begin(), m_RendererList.end(), renderer) == m_RendererList.end())
   {
@@ -84,14 +207,6 @@ void mitk::ContourModelGLMapper2DBase::DrawContour(mitk::ContourModel *rendering
   mitk::ManualPlacementAnnotationRenderer::AddAnnotation(m_ControlPointNumbersAnnotation.GetPointer(), renderer);
   m_ControlPointNumbersAnnotation->SetVisibility(false);
 
-  InternalDrawContour(renderingContour, renderer);
-}
-
-void mitk::ContourModelGLMapper2DBase::InternalDrawContour(mitk::ContourModel *renderingContour,
-                                                           mitk::BaseRenderer *renderer)
-{
-  if (!renderingContour)
-    return;
   if (!this->m_Initialized)
   {
     this->Initialize(renderer);
@@ -100,288 +215,229 @@ void mitk::ContourModelGLMapper2DBase::InternalDrawContour(mitk::ContourModel *r
     this->m_Context->GetDevice())->Begin(renderer->GetVtkRenderer());
 
   mitk::DataNode *dataNode = this->GetDataNode();
+  const unsigned int timestep = renderer->GetTimeStep();
 
-  renderingContour->UpdateOutputInformation();
+  // apply color and opacity read from the PropertyList
+  ApplyColorAndOpacityProperties(renderer);
 
-  unsigned int timestep = renderer->GetTimeStep();
+  mitk::ColorProperty::Pointer colorprop =
+    dynamic_cast<mitk::ColorProperty *>(dataNode->GetProperty("contour.color", renderer));
+  float opacity = 0.5;
+  dataNode->GetFloatProperty("opacity", opacity, renderer);
 
-  if (!renderingContour->IsEmptyTimeStep(timestep))
+  if (colorprop)
   {
-    // apply color and opacity read from the PropertyList
-    ApplyColorAndOpacityProperties(renderer);
+    // set the color of the contour
+    double red = colorprop->GetColor().GetRed();
+    double green = colorprop->GetColor().GetGreen();
+    double blue = colorprop->GetColor().GetBlue();
+    this->m_Context->GetPen()->SetColorF(red, green, blue, opacity);
+  }
 
-    mitk::ColorProperty::Pointer colorprop =
-      dynamic_cast<mitk::ColorProperty *>(dataNode->GetProperty("contour.color", renderer));
-    float opacity = 0.5;
-    dataNode->GetFloatProperty("opacity", opacity, renderer);
+  double lineColor[4];
+  this->m_Context->GetPen()->GetColorF(lineColor);
 
-    if (colorprop)
-    {
-      // set the color of the contour
-      double red = colorprop->GetColor().GetRed();
-      double green = colorprop->GetColor().GetGreen();
-      double blue = colorprop->GetColor().GetBlue();
-      this->m_Context->GetPen()->SetColorF(red, green, blue, opacity);
-    }
+  mitk::ColorProperty::Pointer selectedcolor =
+    dynamic_cast<mitk::ColorProperty *>(dataNode->GetProperty("contour.points.color", renderer));
+  if (!selectedcolor)
+  {
+    selectedcolor = mitk::ColorProperty::New(1.0, 0.0, 0.1);
+  }
 
-    mitk::ColorProperty::Pointer selectedcolor =
-      dynamic_cast<mitk::ColorProperty *>(dataNode->GetProperty("contour.points.color", renderer));
-    if (!selectedcolor)
-    {
-      selectedcolor = mitk::ColorProperty::New(1.0, 0.0, 0.1);
-    }
+  // the control point markers have always been drawn with green and blue swapped
+  const double controlPointColor[3] = {
+    selectedcolor->GetColor().GetRed(), selectedcolor->GetColor().GetBlue(), selectedcolor->GetColor().GetGreen()};
+  const double pointMarkerColor[3] = {0.0, 0.0, 0.0};
+  const double pointColor[3] = {lineColor[0], lineColor[1], lineColor[2]};
 
-    vtkLinearTransform *transform = dataNode->GetVtkTransform();
+  vtkLinearTransform *transform = dataNode->GetVtkTransform();
 
-    //    ContourModel::OutputType point;
-    mitk::Point3D point;
+  float lineWidth = 3.0;
 
-    mitk::Point3D p;
-    float vtkp[3];
-    float lineWidth = 3.0;
+  bool isHovering = false;
+  dataNode->GetBoolProperty("contour.hovering", isHovering);
 
-    bool drawit = false;
+  if (isHovering)
+    dataNode->GetFloatProperty("contour.hovering.width", lineWidth);
+  else
+    dataNode->GetFloatProperty("contour.width", lineWidth);
 
-    bool isHovering = false;
-    dataNode->GetBoolProperty("contour.hovering", isHovering);
+  bool showSegments = false;
+  dataNode->GetBoolProperty("contour.segments.show", showSegments);
 
-    if (isHovering)
-      dataNode->GetFloatProperty("contour.hovering.width", lineWidth);
-    else
-      dataNode->GetFloatProperty("contour.width", lineWidth);
+  bool showControlPoints = false;
+  dataNode->GetBoolProperty("contour.controlpoints.show", showControlPoints);
+
+  bool showPoints = false;
+  dataNode->GetBoolProperty("contour.points.show", showPoints);
 
-    bool showSegments = false;
-    dataNode->GetBoolProperty("contour.segments.show", showSegments);
+  bool showPointsNumbers = false;
+  dataNode->GetBoolProperty("contour.points.text", showPointsNumbers);
 
-    bool showControlPoints = false;
-    dataNode->GetBoolProperty("contour.controlpoints.show", showControlPoints);
+  bool showControlPointsNumbers = false;
+  dataNode->GetBoolProperty("contour.controlpoints.text", showControlPointsNumbers);
 
-    bool showPoints = false;
-    dataNode->GetBoolProperty("contour.points.show", showPoints);
+  bool projectmode = false;
+  dataNode->GetVisibility(projectmode, renderer, "contour.project-onto-plane");
 
-    bool showPointsNumbers = false;
-    dataNode->GetBoolProperty("contour.points.text", showPointsNumbers);
+  const PlaneGeometry *plane = renderer->GetCurrentWorldPlaneGeometry();
 
-    bool showControlPointsNumbers = false;
-    dataNode->GetBoolProperty("contour.controlpoints.text", showControlPointsNumbers);
+  // markers are drawn after the segments, so that they are not hidden by them
+  std::vector<std::pair<Point2D, bool>> markers;
+  m_SegmentBuffer.clear();
 
-    bool projectmode = false;
-    dataNode->GetVisibility(projectmode, renderer, "contour.project-onto-plane");
+  for (auto *renderingContour : contours)
+  {
+    if (!renderingContour)
+      continue;
+
+    renderingContour->UpdateOutputInformation();
 
-    auto pointsIt = renderingContour->IteratorBegin(timestep);
+    if (renderingContour->IsEmptyTimeStep(timestep))
+      continue;
+
+    const TransformedContour &transformed =
+      this->GetTransformedContour(renderingContour, timestep, transform, useCache);
+    if (!projectmode && !IsCloseToPlane(transformed, plane))
+      continue;
 
     Point2D pt2d; // projected_p in display coordinates
     Point2D lastPt2d;
-
+    bool drawit = false;
     int index = 0;
 
-    mitk::ScalarType maxDiff = 0.25;
-
-    while (pointsIt != renderingContour->IteratorEnd(timestep))
+    for (std::size_t i = 0; i < transformed.Points.size(); ++i)
     {
       lastPt2d = pt2d;
 
-      point = (*pointsIt)->Coordinates;
-
-      itk2vtk(point, vtkp);
-      transform->TransformPoint(vtkp, vtkp);
-      vtk2itk(vtkp, p);
-
+      const Point3D &p = transformed.Points[i];
       renderer->WorldToView(p, pt2d);
 
-      ScalarType scalardiff = fabs(renderer->GetCurrentWorldPlaneGeometry()->SignedDistance(p));
+      // project to plane or point is close enough to be drawn
+      drawit = projectmode || fabs(plane->SignedDistance(p)) < MaximumPlaneDistance;
+      if (!drawit)
+        continue;
 
-      // project to plane
-      if (projectmode)
+      // lastPt2d is not valid in first step
+      if (showSegments && i > 0)
       {
-        drawit = true;
+        m_SegmentBuffer.insert(m_SegmentBuffer.end(),
+                               {static_cast<float>(pt2d[0]),
+                                static_cast<float>(pt2d[1]),
+                                static_cast<float>(lastPt2d[0]),
+                                static_cast<float>(lastPt2d[1])});
       }
-      else if (scalardiff < maxDiff) // point is close enough to be drawn
-      {
-        drawit = true;
-      }
-      else
+
+      if (showControlPoints && transformed.IsControlPoint[i])
+        markers.emplace_back(pt2d, true);
+
+      if (showPoints)
+        markers.emplace_back(pt2d, false);
+
+      if (showPointsNumbers)
       {
-        drawit = false;
+        std::stringstream ss;
+        ss << index;
+
+        float rgb[3] = {0.0, 0.0, 0.0};
+        WriteTextWithAnnotation(m_PointNumbersAnnotation, ss.str().c_str(), rgb, pt2d, renderer);
       }
 
-      // draw line
-      if (drawit)
+      if (showControlPointsNumbers && transformed.IsControlPoint[i])
       {
-        if (showSegments)
-        {
-          // lastPt2d is not valid in first step
-          if (!(pointsIt == renderingContour->IteratorBegin(timestep)))
-          {
-            this->m_Context->GetPen()->SetWidth(lineWidth);
-            this->m_Context->DrawLine(pt2d[0], pt2d[1], lastPt2d[0], lastPt2d[1]);
-            this->m_Context->GetPen()->SetWidth(1);
-          }
-        }
-
-        if (showControlPoints)
-        {
-          // draw ontrol points
-          if ((*pointsIt)->IsControlPoint)
-          {
-            float pointsize = 4;
-            Point2D tmp;
-
-            Vector2D horz, vert;
-            horz[1] = 0;
-            vert[0] = 0;
-            horz[0] = pointsize;
-            vert[1] = pointsize;
-            this->m_Context->GetPen()->SetColorF(selectedcolor->GetColor().GetRed(),
-                                                 selectedcolor->GetColor().GetBlue(),
-                                                 selectedcolor->GetColor().GetGreen());
-            this->m_Context->GetPen()->SetWidth(1);
-            // a rectangle around the point with the selected color
-            auto* rectPts = new float[8];
-            tmp = pt2d - horz;
-            rectPts[0] = tmp[0];
-            rectPts[1] = tmp[1];
-            tmp = pt2d + vert;
-            rectPts[2] = tmp[0];
-            rectPts[3] = tmp[1];
-            tmp = pt2d + horz;
-            rectPts[4] = tmp[0];
-            rectPts[5] = tmp[1];
-            tmp = pt2d - vert;
-            rectPts[6] = tmp[0];
-            rectPts[7] = tmp[1];
-            this->m_Context->DrawPolygon(rectPts,4);
-            // the actual point in the specified color to see the usual color of the point
-            this->m_Context->GetPen()->SetColorF(
-              colorprop->GetColor().GetRed(), colorprop->GetColor().GetGreen(), colorprop->GetColor().GetBlue());
-            this->m_Context->DrawPoint(pt2d[0], pt2d[1]);
-          }
-        }
-
-        if (showPoints)
-        {
-          float pointsize = 3;
-          Point2D tmp;
-
-          Vector2D horz, vert;
-          horz[1] = 0;
-          vert[0] = 0;
-          horz[0] = pointsize;
-          vert[1] = pointsize;
-          this->m_Context->GetPen()->SetColorF(0.0, 0.0, 0.0);
-          this->m_Context->GetPen()->SetWidth(1);
-          // a rectangle around the point with the selected color
-          auto* rectPts = new float[8];
-          tmp = pt2d - horz;
-          rectPts[0] = tmp[0];
-          rectPts[1] = tmp[1];
-          tmp = pt2d + vert;
-          rectPts[2] = tmp[0];
-          rectPts[3] = tmp[1];
-          tmp = pt2d + horz;
-          rectPts[4] = tmp[0];
-          rectPts[5] = tmp[1];
-          tmp = pt2d - vert;
-          rectPts[6] = tmp[0];
-          rectPts[7] = tmp[1];
-          this->m_Context->DrawPolygon(rectPts, 4);
-          // the actual point in the specified color to see the usual color of the point
-          this->m_Context->GetPen()->SetColorF(
-            colorprop->GetColor().GetRed(), colorprop->GetColor().GetGreen(), colorprop->GetColor().GetBlue());
-          this->m_Context->DrawPoint(pt2d[0], pt2d[1]);
-        }
-
-        if (showPointsNumbers)
-        {
-          std::string l;
-          std::stringstream ss;
-          ss << index;
-          l.append(ss.str());
-
-          float rgb[3];
-          rgb[0] = 0.0;
-          rgb[1] = 0.0;
-          rgb[2] = 0.0;
-
-          WriteTextWithAnnotation(m_PointNumbersAnnotation, l.c_str(), rgb, pt2d, renderer);
-        }
-
-        if (showControlPointsNumbers && (*pointsIt)->IsControlPoint)
-        {
-          std::string l;
-          std::stringstream ss;
-          ss << index;
-          l.append(ss.str());
-
-          float rgb[3];
-          rgb[0] = 1.0;
-          rgb[1] = 1.0;
-          rgb[2] = 0.0;
-
-          WriteTextWithAnnotation(m_ControlPointNumbersAnnotation, l.c_str(), rgb, pt2d, renderer);
-        }
-
-        index++;
+        std::stringstream ss;
+        ss << index;
+
+        float rgb[3] = {1.0, 1.0, 0.0};
+        WriteTextWithAnnotation(m_ControlPointNumbersAnnotation, ss.str().c_str(), rgb, pt2d, renderer);
       }
 
-      pointsIt++;
-    } // end while iterate over controlpoints
+      index++;
+    }
 
     // close contour if necessary
-    if (renderingContour->IsClosed(timestep) && drawit && showSegments)
+    if (transformed.Closed && drawit && showSegments)
     {
       lastPt2d = pt2d;
-      point = renderingContour->GetVertexAt(0, timestep)->Coordinates;
-      itk2vtk(point, vtkp);
-      transform->TransformPoint(vtkp, vtkp);
-      vtk2itk(vtkp, p);
-      renderer->WorldToDisplay(p, pt2d);
-
-      this->m_Context->GetPen()->SetWidth(lineWidth);
-      this->m_Context->DrawLine(lastPt2d[0], lastPt2d[1], pt2d[0], pt2d[1]);
-      this->m_Context->GetPen()->SetWidth(1);
+      renderer->WorldToView(transformed.Points.front(), pt2d);
+      m_SegmentBuffer.insert(m_SegmentBuffer.end(),
+                             {static_cast<float>(lastPt2d[0]),
+                              static_cast<float>(lastPt2d[1]),
+                              static_cast<float>(pt2d[0]),
+                              static_cast<float>(pt2d[1])});
     }
 
     // draw selected vertex if exists
     if (renderingContour->GetSelectedVertex())
     {
       // transform selected vertex
-      point = renderingContour->GetSelectedVertex()->Coordinates;
-
-      itk2vtk(point, vtkp);
+      double vtkp[3];
+      itk2vtk(renderingContour->GetSelectedVertex()->Coordinates, vtkp);
       transform->TransformPoint(vtkp, vtkp);
-      vtk2itk(vtkp, p);
-
-      renderer->WorldToDisplay(p, pt2d);
 
-      ScalarType scalardiff = fabs(renderer->GetCurrentWorldPlaneGeometry()->SignedDistance(p));
-      //----------------------------------
+      Point3D p;
+      vtk2itk(vtkp, p);
 
       // draw point if close to plane
-      if (scalardiff < maxDiff)
+      if (fabs(plane->SignedDistance(p)) < MaximumPlaneDistance)
       {
-        float pointsize = 5;
-        Point2D tmp;
+        Point2D selected2d;
+        renderer->WorldToDisplay(p, selected2d);
 
-        this->m_Context->GetPen()->SetColorF(0.0, 1.0, 0.0);
-        this->m_Context->GetPen()->SetWidth(1);
-        // a rectangle around the point with the selected color
-        auto* rectPts = new float[8];
+        const float pointsize = 5;
         // a diamond around the point
         // begin from upper left corner and paint clockwise
-        rectPts[0] = pt2d[0] - pointsize;
-        rectPts[1] = pt2d[1] + pointsize;
-        rectPts[2] = pt2d[0] + pointsize;
-        rectPts[3] = pt2d[1] + pointsize;
-        rectPts[4] = pt2d[0] + pointsize;
-        rectPts[5] = pt2d[1] - pointsize;
-        rectPts[6] = pt2d[0] - pointsize;
-        rectPts[7] = pt2d[1] - pointsize;
+        float rectPts[8];
+        rectPts[0] = selected2d[0] - pointsize;
+        rectPts[1] = selected2d[1] + pointsize;
+        rectPts[2] = selected2d[0] + pointsize;
+        rectPts[3] = selected2d[1] + pointsize;
+        rectPts[4] = selected2d[0] + pointsize;
+        rectPts[5] = selected2d[1] - pointsize;
+        rectPts[6] = selected2d[0] - pointsize;
+        rectPts[7] = selected2d[1] - pointsize;
+
+        this->m_Context->GetPen()->SetColorF(0.0, 1.0, 0.0);
+        this->m_Context->GetPen()->SetWidth(1);
         this->m_Context->DrawPolygon(rectPts, 4);
       }
-      //------------------------------------
     }
   }
+
+  // all segments of all contours in one draw call
+  if (!m_SegmentBuffer.empty())
+  {
+    this->m_Context->GetPen()->SetColorF(lineColor[0], lineColor[1], lineColor[2], lineColor[3]);
+    this->m_Context->GetPen()->SetWidth(lineWidth);
+    this->m_Context->DrawLines(m_SegmentBuffer.data(), static_cast<int>(m_SegmentBuffer.size() / 2));
+    this->m_Context->GetPen()->SetWidth(1);
+  }
+
+  for (const auto &marker : markers)
+  {
+    if (marker.second)
+      this->DrawPointMarker(marker.first, 4, controlPointColor, pointColor);
+    else
+      this->DrawPointMarker(marker.first, 3, pointMarkerColor, pointColor);
+  }
+
+  // forget contours that are not drawn by this mapper anymore
+  if (useCache)
+  {
+    for (auto it = m_ContourCache.begin(); it != m_ContourCache.end();)
+    {
+      if (it->second.Used)
+      {
+        it->second.Used = false;
+        ++it;
+      }
+      else
+      {
+        it = m_ContourCache.erase(it);
+      }
+    }
+  }
+
   this->m_Context->GetDevice()->End();
 }
 
@@ -19,22 +19,33 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkCommon.h"
 #include "mitkMapper.h"
+#include "mitkNumericTypes.h"
 #include "mitkTextAnnotation2D.h"
 #include <MitkContourModelExports.h>
 #include "vtkNew.h"
+#include "vtkType.h"
+
+#include <map>
+#include <vector>
 
 class vtkContext2D;
+class vtkLinearTransform;
 class vtkPen;
 
 namespace mitk
 {
   class BaseRenderer;
   class ContourModel;
+  class PlaneGeometry;
 
   /**
   * @brief Base class for OpenGL based 2D mappers.
   * Provides functionality to draw a contour.
   *
+  * The segments of all contours drawn by one call of DrawContours() are collected and
+  * drawn with a single draw call. Contours whose bounds do not come close to the current
+  * plane are skipped without projecting their vertices.
+  *
   * @ingroup MitkContourModelModule
   */
   class MITKCONTOURMODEL_EXPORT ContourModelGLMapper2DBase : public Mapper
@@ -53,6 +64,15 @@ namespace mitk
 
     void DrawContour(mitk::ContourModel *contour, mitk::BaseRenderer *renderer);
 
+    /**
+    * @brief Draws all given contours in one pass.
+    *
+    * If useCache is true, the transformed vertices and the bounds of each contour are kept
+    * until the contour or the node transform is modified. This suits contours that are not
+    * edited vertex by vertex, e.g. the contours of a ContourModelSet.
+    */
+    void DrawContours(const std::vector<mitk::ContourModel *> &contours, mitk::BaseRenderer *renderer, bool useCache);
+
     void WriteTextWithAnnotation(
       TextAnnotationPointerType textAnnotation, const char *text, float rgb[3], Point2D pt2d, mitk::BaseRenderer *);
 
@@ -69,6 +89,34 @@ namespace mitk
     bool m_Initialized;
 
     vtkNew<vtkContext2D> m_Context;
+
+  private:
+    /** Vertices of one time step of a contour in world coordinates, i.e. after the node transform */
+    struct TransformedContour
+    {
+      itk::ModifiedTimeType ContourMTime = 0;
+      vtkMTimeType TransformMTime = 0;
+      std::vector<Point3D> Points;
+      std::vector<bool> IsControlPoint;
+      Point3D BoundsMin;
+      Point3D BoundsMax;
+      bool Closed = false;
+      bool Used = false;
+    };
+
+    const TransformedContour &GetTransformedContour(mitk::ContourModel *contour,
+                                                    unsigned int timestep,
+                                                    vtkLinearTransform *transform,
+                                                    bool useCache);
+
+    static bool IsCloseToPlane(const TransformedContour &contour, const PlaneGeometry *plane);
+
+    void DrawPointMarker(const Point2D &point, float size, const double markerColor[3], const double pointColor[3]);
+
+    typedef std::map<std::pair<const ContourModel *, unsigned int>, TransformedContour> ContourCacheType;
+    ContourCacheType m_ContourCache;
+    TransformedContour m_UncachedContour;
+    std::vector<float> m_SegmentBuffer;
   };
 
 } // namespace mitk
@@ -45,22 +45,15 @@ void mitk::ContourModelSetGLMapper2D::MitkRender(mitk::BaseRenderer *renderer, m
 
     mitk::ContourModelSet::Pointer input = this->GetInput();
 
-    auto centerOfViewPointZ = renderer->GetCurrentWorldPlaneGeometry()->GetCenter()[2];
-    auto it = input->Begin();
-
-    auto end = input->End();
-
-    while (it != end)
+    // contours far from the current plane are culled by their bounds, the segments of all
+    // others are drawn at once
+    std::vector<mitk::ContourModel *> contours;
+    contours.reserve(input->GetSize());
+    for (auto it = input->Begin(); it != input->End(); ++it)
     {
-        //we have the assumption that each contour model vertex has the same z coordinate
-        auto currentZValue = (*it)->GetVertexAt(0)->Coordinates[2];
-        double acceptedDeviationInMM = 5.0;
-        //only draw contour if it is visible
-        if (currentZValue - acceptedDeviationInMM < centerOfViewPointZ && currentZValue + acceptedDeviationInMM > centerOfViewPointZ){
-            this->DrawContour(it->GetPointer(), renderer);
-        }
-        ++it;
+        contours.push_back(it->GetPointer());
     }
+    this->DrawContours(contours, renderer, true);
 
     if (input->GetSize() < 1)
         return;
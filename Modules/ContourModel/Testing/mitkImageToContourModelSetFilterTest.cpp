@@ -0,0 +1,134 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkImageCast.h>
+#include <mitkImageToContourModelSetFilter.h>
+#include <mitkTestingMacros.h>
+
+#include <itkImage.h>
+
+typedef itk::Image<unsigned char, 3> LabelImageType;
+
+// 10x10x5 volume, label 1 is a square in the slices 1 and 2, label 3 a square in slice 3
+static mitk::Image::Pointer CreateLabelImage()
+{
+  LabelImageType::Pointer itkImage = LabelImageType::New();
+  LabelImageType::SizeType size;
+  size[0] = 10;
+  size[1] = 10;
+  size[2] = 5;
+  itkImage->SetRegions(size);
+  itkImage->Allocate();
+  itkImage->FillBuffer(0);
+
+  LabelImageType::IndexType index;
+  for (index[2] = 1; index[2] <= 3; ++index[2])
+  {
+    for (index[1] = 2; index[1] < 6; ++index[1])
+    {
+      for (index[0] = 2; index[0] < 6; ++index[0])
+        itkImage->SetPixel(index, index[2] == 3 ? 3 : 1);
+    }
+  }
+
+  mitk::Image::Pointer image;
+  mitk::CastToMitkImage(itkImage, image);
+  return image;
+}
+
+static void TestAllLabels(unsigned int numberOfThreads)
+{
+  mitk::ImageToContourModelSetFilter::Pointer filter = mitk::ImageToContourModelSetFilter::New();
+  filter->SetInput(CreateLabelImage());
+  filter->SetNumberOfThreads(numberOfThreads);
+  filter->Update();
+
+  const mitk::ImageToContourModelSetFilter::LabelVectorType &labels = filter->GetOutputLabels();
+  MITK_TEST_CONDITION_REQUIRED(labels.size() == 2 && labels[0] == 1 && labels[1] == 3, "Found labels 1 and 3");
+  MITK_TEST_CONDITION_REQUIRED(filter->GetNumberOfIndexedOutputs() == 2, "One output per label");
+
+  mitk::ContourModelSet *label1 = filter->GetOutputForLabel(1);
+  mitk::ContourModelSet *label3 = filter->GetOutputForLabel(3);
+  MITK_TEST_CONDITION_REQUIRED(label1 != nullptr && label3 != nullptr, "Outputs for the found labels");
+  MITK_TEST_CONDITION(filter->GetOutputForLabel(2) == nullptr, "No output for a missing label");
+  MITK_TEST_CONDITION_REQUIRED(label1->GetSize() == 2, "One contour per slice of label 1");
+  MITK_TEST_CONDITION_REQUIRED(label3->GetSize() == 1, "One contour for label 3");
+
+  // contours are ordered by slice and lie in their slice
+  MITK_TEST_CONDITION(mitk::Equal(label1->GetContourModelAt(0)->GetVertexAt(0)->Coordinates[2], 1.0),
+                      "First contour of label 1 in slice 1");
+  MITK_TEST_CONDITION(mitk::Equal(label1->GetContourModelAt(1)->GetVertexAt(0)->Coordinates[2], 2.0),
+                      "Second contour of label 1 in slice 2");
+  MITK_TEST_CONDITION(mitk::Equal(label3->GetContourModelAt(0)->GetVertexAt(0)->Coordinates[2], 3.0),
+                      "Contour of label 3 in slice 3");
+  MITK_TEST_CONDITION(label3->GetContourModelAt(0)->IsClosed(), "Contours are closed");
+}
+
+static void TestSelectedLabels()
+{
+  mitk::ImageToContourModelSetFilter::Pointer filter = mitk::ImageToContourModelSetFilter::New();
+  filter->SetInput(CreateLabelImage());
+  filter->SetLabels({3});
+  filter->Update();
+
+  MITK_TEST_CONDITION_REQUIRED(filter->GetOutputLabels().size() == 1, "Only the selected label is extracted");
+  MITK_TEST_CONDITION(filter->GetOutputForLabel(1) == nullptr, "No output for an unselected label");
+  MITK_TEST_CONDITION(filter->GetOutputForLabel(3)->GetSize() == 1, "Output for the selected label");
+}
+
+static void TestSliceDimension()
+{
+  mitk::ImageToContourModelSetFilter::Pointer filter = mitk::ImageToContourModelSetFilter::New();
+  filter->SetInput(CreateLabelImage());
+  filter->SetSliceDimension(0);
+  filter->Update();
+
+  // both labels cover the sagittal slices 2 to 5
+  MITK_TEST_CONDITION(filter->GetOutputForLabel(1)->GetSize() == 4, "Sagittal contours of label 1");
+  MITK_TEST_CONDITION(filter->GetOutputForLabel(3)->GetSize() == 4, "Sagittal contours of label 3");
+}
+
+static void TestEmptyImage()
+{
+  LabelImageType::Pointer itkImage = LabelImageType::New();
+  LabelImageType::SizeType size;
+  size.Fill(4);
+  itkImage->SetRegions(size);
+  itkImage->Allocate();
+  itkImage->FillBuffer(0);
+  mitk::Image::Pointer image;
+  mitk::CastToMitkImage(itkImage, image);
+
+  mitk::ImageToContourModelSetFilter::Pointer filter = mitk::ImageToContourModelSetFilter::New();
+  filter->SetInput(image);
+  filter->Update();
+
+  MITK_TEST_CONDITION(filter->GetOutputLabels().empty(), "No labels in an empty image");
+  MITK_TEST_CONDITION(filter->GetOutput()->IsEmpty(), "Empty output for an empty image");
+}
+
+int mitkImageToContourModelSetFilterTest(int /*argc*/, char * /*argv*/ [])
+{
+  MITK_TEST_BEGIN("mitkImageToContourModelSetFilterTest")
+
+  TestAllLabels(1);
+  TestAllLabels(4);
+  TestSelectedLabels();
+  TestSliceDimension();
+  TestEmptyImage();
+
+  MITK_TEST_END()
+}
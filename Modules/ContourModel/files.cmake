@@ -5,6 +5,7 @@ set(CPP_FILES
   Algorithms/mitkContourModelToPointSetFilter.cpp
   Algorithms/mitkContourModelToSurfaceFilter.cpp
   Algorithms/mitkImageToContourModelFilter.cpp
+  Algorithms/mitkImageToContourModelSetFilter.cpp
   Algorithms/mitkContourObjectFactory.cpp
   Algorithms/mitkContourModelUtils.cpp
   DataManagement/mitkContourModel.cpp
@@ -55,12 +55,24 @@ namespace mitk
   class MITKTESTINGHELPER_EXPORT InteractionTestHelper
   {
   public:
+    /**
+     * @brief Latency of one played back event, see PlaybackInteractionAndMeasureLatency.
+     */
+    struct EventLatency
+    {
+      std::string EventClass;
+      double Milliseconds;
+    };
+
+    typedef std::vector<EventLatency> EventLatencyListType;
+
     /**
      * @brief InteractionTestHelper set up all neseccary objects by calling Initialize.
      * @param interactionXmlFilePath path to xml file containing events and configuration information for the render
      * windows.
+     * @param offscreen if true, the render windows are created offscreen, so no display is needed.
      */
-    InteractionTestHelper(const std::string &interactionXmlFilePath);
+    InteractionTestHelper(const std::string &interactionXmlFilePath, bool offscreen = false);
 
     // unregisters all render windows and its renderers.
     virtual ~InteractionTestHelper();
@@ -80,6 +92,15 @@ namespace mitk
      */
     void PlaybackInteraction();
 
+    /**
+     * @brief Plays back the loaded interaction like PlaybackInteraction, but renders all render windows with pending
+     * update requests after each event.
+     *
+     * The minimum frame interval of the RenderingManager is disabled during playback, so every event gets its own frame.
+     * @return the time from passing each event to the dispatcher until the requested renderings completed.
+     */
+    EventLatencyListType PlaybackInteractionAndMeasureLatency();
+
     /**
      * @brief SetTimeStep Sets timesteps of all SliceNavigationControllers to given timestep.
      * @param newTimeStep new timestep
@@ -135,9 +156,16 @@ namespace mitk
      */
     void LoadInteraction();
 
+    /**
+     * @brief Initializes the views and renders all windows once, so the first played back event does
+     * not include the set-up of the mappers.
+     */
+    void PreparePlayback();
+
     mitk::XML2EventParser::EventContainerType m_Events; // List with loaded interaction events
 
     std::string m_InteractionFilePath;
+    bool m_Offscreen;
 
     RenderWindowListType m_RenderWindowList;
     mitk::DataStorage::Pointer m_DataStorage;
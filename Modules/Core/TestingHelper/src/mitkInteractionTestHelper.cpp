@@ -30,8 +30,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <tinyxml.h>
 
-mitk::InteractionTestHelper::InteractionTestHelper(const std::string &interactionXmlFilePath)
-  : m_InteractionFilePath(interactionXmlFilePath)
+#include <chrono>
+
+mitk::InteractionTestHelper::InteractionTestHelper(const std::string &interactionXmlFilePath, bool offscreen)
+  : m_InteractionFilePath(interactionXmlFilePath), m_Offscreen(offscreen)
 {
   this->Initialize(interactionXmlFilePath);
 }
@@ -96,7 +98,9 @@ void mitk::InteractionTestHelper::Initialize(const std::string &interactionXmlFi
 
       // create renderWindow, renderer and dispatcher
       mitk::RenderWindow::Pointer rw =
-        mitk::RenderWindow::New(nullptr, rendererName, rm); // VtkRenderWindow is created within constructor if nullptr
+        m_Offscreen ? mitk::RenderWindow::NewOffscreen(size[0] != 0 ? size[0] : 100, size[1] != 0 ? size[1] : 100,
+                                                       rendererName, rm)
+                    : mitk::RenderWindow::New(nullptr, rendererName, rm); // VtkRenderWindow is created within constructor if nullptr
 
       if (size[0] != 0 && size[1] != 0)
       {
@@ -211,7 +215,7 @@ void mitk::InteractionTestHelper::AddNodeToStorage(mitk::DataNode::Pointer node)
   this->Set3dCameraSettings();
 }
 
-void mitk::InteractionTestHelper::PlaybackInteraction()
+void mitk::InteractionTestHelper::PreparePlayback()
 {
   mitk::RenderingManager::GetInstance()->InitializeViewsByBoundingObjects(m_DataStorage);
   // load events if not loaded yet
@@ -235,6 +239,11 @@ void mitk::InteractionTestHelper::PlaybackInteraction()
     (*it)->GetVtkRenderWindow()->Render();
     (*it)->GetVtkRenderWindow()->WaitForCompletion();
   }
+}
+
+void mitk::InteractionTestHelper::PlaybackInteraction()
+{
+  this->PreparePlayback();
 
   // mitk::RenderingManager::GetInstance()->ForceImmediateUpdateAll();
   // playback all events in queue
@@ -243,11 +252,38 @@ void mitk::InteractionTestHelper::PlaybackInteraction()
     // let dispatcher of sending renderer process the event
     m_Events.at(i)->GetSender()->GetDispatcher()->ProcessEvent(m_Events.at(i));
   }
-  if (false)
+}
+
+mitk::InteractionTestHelper::EventLatencyListType mitk::InteractionTestHelper::PlaybackInteractionAndMeasureLatency()
+{
+  this->PreparePlayback();
+
+  mitk::RenderingManager *rm = mitk::RenderingManager::GetInstance();
+  const double minimumFrameInterval = rm->GetMinimumFrameInterval();
+  rm->SetMinimumFrameInterval(0.0);
+
+  EventLatencyListType latencies;
+  latencies.reserve(m_Events.size());
+  for (unsigned long i = 0; i < m_Events.size(); ++i)
   {
-    it--;
-    (*it)->GetVtkRenderWindow()->GetInteractor()->Start();
+    const auto start = std::chrono::steady_clock::now();
+
+    m_Events.at(i)->GetSender()->GetDispatcher()->ProcessEvent(m_Events.at(i));
+
+    // the testing rendering manager has no event loop, so the requested updates are executed here
+    rm->ExecutePendingRequests();
+    for (auto it = m_RenderWindowList.begin(); it != m_RenderWindowList.end(); ++it)
+      (*it)->GetVtkRenderWindow()->WaitForCompletion();
+
+    EventLatency latency;
+    latency.EventClass = m_Events.at(i)->GetNameOfClass();
+    latency.Milliseconds =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    latencies.push_back(latency);
   }
+
+  rm->SetMinimumFrameInterval(minimumFrameInterval);
+  return latencies;
 }
 
 void mitk::InteractionTestHelper::LoadInteraction()
@@ -0,0 +1,379 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkBenchmark.h"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <regex>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+  std::vector<std::unique_ptr<mitk::Benchmark>> &GetRegistry()
+  {
+    static std::vector<std::unique_ptr<mitk::Benchmark>> registry;
+    return registry;
+  }
+
+  struct Result
+  {
+    std::string Name;
+    std::size_t Iterations;
+    double RealTime; // nanoseconds per iteration
+    double CpuTime;
+    double BytesPerSecond;
+    double ItemsPerSecond;
+    std::string Label;
+    std::vector<std::pair<std::string, double>> Counters;
+    std::string Error;
+  };
+
+  std::string EscapeJson(const std::string &value)
+  {
+    std::string result;
+    for (char c : value)
+    {
+      if (c == '"' || c == '\\')
+        result += '\\';
+      result += c;
+    }
+    return result;
+  }
+
+  Result Run(const mitk::Benchmark &benchmark, const std::vector<long long> &args, double minTime)
+  {
+    Result result;
+    result.Name = benchmark.GetName();
+    for (long long arg : args)
+      result.Name += "/" + std::to_string(arg);
+
+    // grow the number of iterations until the run takes long enough, as Google Benchmark does
+    std::size_t iterations = 1;
+    for (;;)
+    {
+      mitk::BenchmarkState state(args, iterations);
+      try
+      {
+        benchmark.GetFunction()(state);
+      }
+      catch (const std::exception &e)
+      {
+        state.SkipWithError(e.what());
+      }
+
+      if (!state.GetError().empty() || state.GetRealTime() >= minTime || iterations >= 1000000000)
+      {
+        result.Iterations = state.GetIterations();
+        const double iterationCount = result.Iterations > 0 ? static_cast<double>(result.Iterations) : 1.0;
+        result.RealTime = state.GetRealTime() * 1e9 / iterationCount;
+        result.CpuTime = state.GetCpuTime() * 1e9 / iterationCount;
+        result.BytesPerSecond = state.GetRealTime() > 0 ? state.GetBytesProcessed() / state.GetRealTime() : 0;
+        result.ItemsPerSecond = state.GetRealTime() > 0 ? state.GetItemsProcessed() / state.GetRealTime() : 0;
+        result.Label = state.GetLabel();
+        result.Counters = state.GetCounters();
+        result.Error = state.GetError();
+        return result;
+      }
+
+      const double factor = state.GetRealTime() > 0 ? 1.4 * minTime / state.GetRealTime() : 10.0;
+      iterations = static_cast<std::size_t>(iterations * std::max(2.0, std::min(10.0, factor)));
+    }
+  }
+
+  void WriteJson(std::ostream &stream, const std::vector<Result> &results)
+  {
+    std::time_t now = std::time(nullptr);
+    char date[64];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    stream << "{\n  \"context\": {\n"
+           << "    \"date\": \"" << date << "\",\n"
+           << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef NDEBUG
+           << "    \"library_build_type\": \"release\"\n"
+#else
+           << "    \"library_build_type\": \"debug\"\n"
+#endif
+           << "  },\n  \"benchmarks\": [";
+
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+      const Result &result = results[i];
+      stream << (i == 0 ? "\n" : ",\n") << "    {\n"
+             << "      \"name\": \"" << EscapeJson(result.Name) << "\",\n"
+             << "      \"run_name\": \"" << EscapeJson(result.Name) << "\",\n"
+             << "      \"run_type\": \"iteration\",\n";
+      if (!result.Error.empty())
+      {
+        stream << "      \"error_occurred\": true,\n"
+               << "      \"error_message\": \"" << EscapeJson(result.Error) << "\",\n";
+      }
+      stream << "      \"iterations\": " << result.Iterations << ",\n"
+             << "      \"real_time\": " << std::setprecision(10) << result.RealTime << ",\n"
+             << "      \"cpu_time\": " << result.CpuTime << ",\n"
+             << "      \"time_unit\": \"ns\"";
+      if (result.BytesPerSecond > 0)
+        stream << ",\n      \"bytes_per_second\": " << result.BytesPerSecond;
+      if (result.ItemsPerSecond > 0)
+        stream << ",\n      \"items_per_second\": " << result.ItemsPerSecond;
+      if (!result.Label.empty())
+        stream << ",\n      \"label\": \"" << EscapeJson(result.Label) << "\"";
+      for (const auto &counter : result.Counters)
+        stream << ",\n      \"" << EscapeJson(counter.first) << "\": " << counter.second;
+      stream << "\n    }";
+    }
+    stream << "\n  ]\n}\n";
+  }
+
+  bool ParseOption(const char *arg, const char *name, std::string &value)
+  {
+    const std::size_t length = std::strlen(name);
+    if (std::strncmp(arg, name, length) != 0 || arg[length] != '=')
+      return false;
+    value = arg + length + 1;
+    return true;
+  }
+}
+
+mitk::BenchmarkState::BenchmarkState(const std::vector<long long> &args, std::size_t maxIterations)
+  : m_Args(args),
+    m_MaxIterations(maxIterations),
+    m_Iterations(0),
+    m_Started(false),
+    m_Running(false),
+    m_CpuStart(0),
+    m_RealTime(0),
+    m_CpuTime(0),
+    m_BytesProcessed(0),
+    m_ItemsProcessed(0)
+{
+}
+
+bool mitk::BenchmarkState::KeepRunning()
+{
+  if (!m_Started)
+  {
+    m_Started = true;
+    this->StartTimer();
+  }
+  else
+  {
+    ++m_Iterations;
+  }
+
+  if (m_Iterations < m_MaxIterations && m_Error.empty())
+    return true;
+
+  if (m_Running)
+    this->StopTimer();
+  return false;
+}
+
+void mitk::BenchmarkState::PauseTiming()
+{
+  if (m_Running)
+    this->StopTimer();
+}
+
+void mitk::BenchmarkState::ResumeTiming()
+{
+  if (!m_Running)
+    this->StartTimer();
+}
+
+long long mitk::BenchmarkState::range(std::size_t index) const
+{
+  return index < m_Args.size() ? m_Args[index] : 0;
+}
+
+void mitk::BenchmarkState::SetCounter(const std::string &name, double value)
+{
+  for (auto &counter : m_Counters)
+  {
+    if (counter.first == name)
+    {
+      counter.second = value;
+      return;
+    }
+  }
+  m_Counters.push_back(std::make_pair(name, value));
+}
+
+void mitk::BenchmarkState::SkipWithError(const std::string &message)
+{
+  m_Error = message;
+}
+
+void mitk::BenchmarkState::StartTimer()
+{
+  m_Running = true;
+  m_CpuStart = std::clock();
+  m_RealStart = std::chrono::steady_clock::now();
+}
+
+void mitk::BenchmarkState::StopTimer()
+{
+  m_RealTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - m_RealStart).count();
+  m_CpuTime += static_cast<double>(std::clock() - m_CpuStart) / CLOCKS_PER_SEC;
+  m_Running = false;
+}
+
+mitk::Benchmark::Benchmark(const std::string &name, const FunctionType &function) : m_Name(name), m_Function(function)
+{
+}
+
+mitk::Benchmark *mitk::Benchmark::Arg(long long arg)
+{
+  m_Args.push_back(std::vector<long long>(1, arg));
+  return this;
+}
+
+mitk::Benchmark *mitk::Benchmark::Args(const std::vector<long long> &args)
+{
+  m_Args.push_back(args);
+  return this;
+}
+
+mitk::Benchmark *mitk::RegisterBenchmark(const std::string &name, const Benchmark::FunctionType &function)
+{
+  GetRegistry().emplace_back(new Benchmark(name, function));
+  return GetRegistry().back().get();
+}
+
+int mitk::RunBenchmarks(int argc, char *argv[])
+{
+  std::string filter = ".";
+  std::string outFile;
+  double minTime = 0.5;
+  bool listOnly = false;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string value;
+    if (ParseOption(argv[i], "--benchmark_filter", value))
+    {
+      filter = value;
+    }
+    else if (ParseOption(argv[i], "--benchmark_out", value))
+    {
+      outFile = value;
+    }
+    else if (ParseOption(argv[i], "--benchmark_min_time", value))
+    {
+      std::istringstream stream(value);
+      if (!(stream >> minTime) || minTime < 0)
+      {
+        std::cerr << "Invalid minimum time: " << value << std::endl;
+        return 1;
+      }
+    }
+    else if (std::strcmp(argv[i], "--benchmark_list_tests") == 0)
+    {
+      listOnly = true;
+    }
+    else
+    {
+      std::cerr << "Unknown option: " << argv[i] << "\n"
+                << "Usage: " << argv[0]
+                << " [--benchmark_filter=<regex>] [--benchmark_min_time=<seconds>] [--benchmark_out=<file>]"
+                   " [--benchmark_list_tests]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  std::regex filterExpression;
+  try
+  {
+    filterExpression = std::regex(filter);
+  }
+  catch (const std::regex_error &e)
+  {
+    std::cerr << "Invalid filter " << filter << ": " << e.what() << std::endl;
+    return 1;
+  }
+
+  std::vector<Result> results;
+  bool failed = false;
+
+  std::cout << std::left << std::setw(50) << "Benchmark" << std::right << std::setw(15) << "Time [ns]"
+            << std::setw(15) << "CPU [ns]" << std::setw(13) << "Iterations" << "  Throughput\n"
+            << std::string(105, '-') << std::endl;
+
+  for (const auto &benchmark : GetRegistry())
+  {
+    std::vector<std::vector<long long>> argsList = benchmark->GetArgs();
+    if (argsList.empty())
+      argsList.push_back(std::vector<long long>());
+
+    for (const auto &args : argsList)
+    {
+      std::string name = benchmark->GetName();
+      for (long long arg : args)
+        name += "/" + std::to_string(arg);
+
+      if (!std::regex_search(name, filterExpression))
+        continue;
+
+      if (listOnly)
+      {
+        std::cout << name << std::endl;
+        continue;
+      }
+
+      Result result = Run(*benchmark, args, minTime);
+      std::cout << std::left << std::setw(50) << result.Name << std::right;
+      if (!result.Error.empty())
+      {
+        std::cout << "  ERROR: " << result.Error << std::endl;
+        failed = true;
+      }
+      else
+      {
+        std::cout << std::fixed << std::setprecision(0) << std::setw(15) << result.RealTime << std::setw(15)
+                  << result.CpuTime << std::setw(13) << result.Iterations;
+        if (result.BytesPerSecond > 0)
+          std::cout << "  " << std::setprecision(1) << result.BytesPerSecond / (1024 * 1024) << " MiB/s";
+        if (result.ItemsPerSecond > 0)
+          std::cout << "  " << std::setprecision(1) << result.ItemsPerSecond << " items/s";
+        if (!result.Label.empty())
+          std::cout << "  " << result.Label;
+        for (const auto &counter : result.Counters)
+          std::cout << "  " << counter.first << "=" << std::setprecision(1) << counter.second;
+        std::cout << std::endl;
+      }
+      results.push_back(result);
+    }
+  }
+
+  if (!outFile.empty())
+  {
+    std::ofstream stream(outFile.c_str());
+    WriteJson(stream, results);
+    if (!stream)
+    {
+      std::cerr << "Writing " << outFile << " failed" << std::endl;
+      return 1;
+    }
+  }
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,154 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKBENCHMARK_H
+#define MITKBENCHMARK_H
+
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mitk
+{
+  /**
+   * @brief Per run state of a micro benchmark, modelled after Google Benchmark.
+   *
+   * The benchmark function repeats the measured code while KeepRunning() returns true:
+   * \code
+   *   void BM_Something(mitk::BenchmarkState &state)
+   *   {
+   *     // set-up, not measured
+   *     while (state.KeepRunning())
+   *     {
+   *       // measured code
+   *     }
+   *     state.SetBytesProcessed(state.GetIterations() * bytes);
+   *   }
+   *   MITK_BENCHMARK(BM_Something)->Arg(64)->Arg(256);
+   * \endcode
+   */
+  class BenchmarkState
+  {
+  public:
+    BenchmarkState(const std::vector<long long> &args, std::size_t maxIterations);
+
+    bool KeepRunning();
+
+    /** @brief Excludes the following code from the measured time until ResumeTiming() */
+    void PauseTiming();
+    void ResumeTiming();
+
+    long long range(std::size_t index = 0) const;
+    std::size_t GetIterations() const { return m_Iterations; }
+
+    void SetBytesProcessed(long long bytes) { m_BytesProcessed = bytes; }
+    void SetItemsProcessed(long long items) { m_ItemsProcessed = items; }
+    void SetLabel(const std::string &label) { m_Label = label; }
+    /** @brief Reports an additional value, written as user counter to the JSON output */
+    void SetCounter(const std::string &name, double value);
+    void SkipWithError(const std::string &message);
+
+    double GetRealTime() const { return m_RealTime; }
+    double GetCpuTime() const { return m_CpuTime; }
+    long long GetBytesProcessed() const { return m_BytesProcessed; }
+    long long GetItemsProcessed() const { return m_ItemsProcessed; }
+    const std::string &GetLabel() const { return m_Label; }
+    const std::vector<std::pair<std::string, double>> &GetCounters() const { return m_Counters; }
+    const std::string &GetError() const { return m_Error; }
+
+  private:
+    void StartTimer();
+    void StopTimer();
+
+    std::vector<long long> m_Args;
+    std::size_t m_MaxIterations;
+    std::size_t m_Iterations;
+    bool m_Started;
+    bool m_Running;
+
+    std::chrono::steady_clock::time_point m_RealStart;
+    std::clock_t m_CpuStart;
+    double m_RealTime;
+    double m_CpuTime;
+
+    long long m_BytesProcessed;
+    long long m_ItemsProcessed;
+    std::string m_Label;
+    std::vector<std::pair<std::string, double>> m_Counters;
+    std::string m_Error;
+  };
+
+  class Benchmark
+  {
+  public:
+    typedef std::function<void(BenchmarkState &)> FunctionType;
+
+    Benchmark(const std::string &name, const FunctionType &function);
+
+    Benchmark *Arg(long long arg);
+    Benchmark *Args(const std::vector<long long> &args);
+
+    const std::string &GetName() const { return m_Name; }
+    const FunctionType &GetFunction() const { return m_Function; }
+    const std::vector<std::vector<long long>> &GetArgs() const { return m_Args; }
+
+  private:
+    std::string m_Name;
+    FunctionType m_Function;
+    std::vector<std::vector<long long>> m_Args;
+  };
+
+  Benchmark *RegisterBenchmark(const std::string &name, const Benchmark::FunctionType &function);
+
+  /**
+   * @brief Runs all registered benchmarks and prints a table to stdout.
+   *
+   * Understands the Google Benchmark options --benchmark_filter=<regex>,
+   * --benchmark_min_time=<seconds>, --benchmark_out=<file> and --benchmark_list_tests.
+   * The file written by --benchmark_out uses the Google Benchmark JSON layout, so the
+   * usual comparison tools can be used on it.
+   *
+   * @return 0 on success, 1 if an option was invalid or a benchmark reported an error.
+   */
+  int RunBenchmarks(int argc, char *argv[]);
+
+  /** @brief Prevents the compiler from optimizing away a computed value */
+  template <typename T>
+  inline void DoNotOptimize(const T &value)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile char sink;
+    sink = *reinterpret_cast<const volatile char *>(&value);
+#endif
+  }
+}
+
+#define MITK_BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define MITK_BENCHMARK_CONCAT(a, b) MITK_BENCHMARK_CONCAT_IMPL(a, b)
+
+#define MITK_BENCHMARK(function)                                                                                       \
+  static mitk::Benchmark *MITK_BENCHMARK_CONCAT(mitkBenchmark, __LINE__) = mitk::RegisterBenchmark(#function, function)
+
+#define MITK_BENCHMARK_TEMPLATE(function, type)                                                                        \
+  static mitk::Benchmark *MITK_BENCHMARK_CONCAT(mitkBenchmark, __LINE__) =                                             \
+    mitk::RegisterBenchmark(#function "<" #type ">", function<type>)
+
+#endif // MITKBENCHMARK_H
@@ -0,0 +1,28 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkBenchmark.h"
+
+/**
+ * Micro benchmarks of the hot paths in MitkCore.
+ *
+ * Run with --benchmark_out=results.json to get machine readable results in the
+ * Google Benchmark JSON layout, e.g. for comparing two builds.
+ */
+int main(int argc, char *argv[])
+{
+  return mitk::RunBenchmarks(argc, argv);
+}
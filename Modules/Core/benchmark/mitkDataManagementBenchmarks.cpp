@@ -0,0 +1,164 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkBenchmark.h"
+
+#include <mitkDataNode.h>
+#include <mitkNodePredicateAnd.h>
+#include <mitkNodePredicateDataType.h>
+#include <mitkNodePredicateProperty.h>
+#include <mitkPointSet.h>
+#include <mitkProperties.h>
+#include <mitkPropertyKey.h>
+#include <mitkPropertyList.h>
+#include <mitkStandaloneDataStorage.h>
+#include <mitkStringProperty.h>
+#include <mitkSurface.h>
+
+namespace
+{
+  // Every fourth node holds a surface and every tenth is tagged, typical for a study with derived data
+  mitk::StandaloneDataStorage::Pointer CreateDataStorage(long long numberOfNodes)
+  {
+    mitk::StandaloneDataStorage::Pointer storage = mitk::StandaloneDataStorage::New();
+    for (long long i = 0; i < numberOfNodes; ++i)
+    {
+      mitk::DataNode::Pointer node = mitk::DataNode::New();
+      if (i % 4 == 0)
+        node->SetData(mitk::Surface::New());
+      else
+        node->SetData(mitk::PointSet::New());
+      node->SetName("node" + std::to_string(i));
+      node->SetBoolProperty("benchmark.tagged", i % 10 == 0);
+      storage->Add(node);
+    }
+    return storage;
+  }
+
+  std::vector<std::string> CreatePropertyNames(long long numberOfProperties)
+  {
+    std::vector<std::string> names;
+    for (long long i = 0; i < numberOfProperties; ++i)
+      names.push_back("benchmark.group" + std::to_string(i % 7) + ".property" + std::to_string(i));
+    return names;
+  }
+
+  mitk::PropertyList::Pointer CreatePropertyList(const std::vector<std::string> &names)
+  {
+    mitk::PropertyList::Pointer list = mitk::PropertyList::New();
+    for (const auto &name : names)
+      list->SetProperty(name, mitk::IntProperty::New(1));
+    return list;
+  }
+}
+
+void BM_DataStorageGetSubsetDataType(mitk::BenchmarkState &state)
+{
+  mitk::StandaloneDataStorage::Pointer storage = CreateDataStorage(state.range(0));
+  mitk::NodePredicateDataType::Pointer predicate = mitk::NodePredicateDataType::New("Surface");
+  while (state.KeepRunning())
+  {
+    mitk::DataStorage::SetOfObjects::ConstPointer subset = storage->GetSubset(predicate);
+    mitk::DoNotOptimize(subset.GetPointer());
+  }
+  state.SetItemsProcessed(state.GetIterations() * state.range(0));
+}
+MITK_BENCHMARK(BM_DataStorageGetSubsetDataType)->Arg(100)->Arg(1000)->Arg(10000);
+
+void BM_DataStorageGetSubsetProperty(mitk::BenchmarkState &state)
+{
+  mitk::StandaloneDataStorage::Pointer storage = CreateDataStorage(state.range(0));
+  mitk::NodePredicateAnd::Pointer predicate =
+    mitk::NodePredicateAnd::New(mitk::NodePredicateDataType::New("PointSet"),
+                                mitk::NodePredicateProperty::New("benchmark.tagged", mitk::BoolProperty::New(true)));
+  while (state.KeepRunning())
+  {
+    mitk::DataStorage::SetOfObjects::ConstPointer subset = storage->GetSubset(predicate);
+    mitk::DoNotOptimize(subset.GetPointer());
+  }
+  state.SetItemsProcessed(state.GetIterations() * state.range(0));
+}
+MITK_BENCHMARK(BM_DataStorageGetSubsetProperty)->Arg(100)->Arg(1000)->Arg(10000);
+
+void BM_DataStorageGetNamedNode(mitk::BenchmarkState &state)
+{
+  mitk::StandaloneDataStorage::Pointer storage = CreateDataStorage(state.range(0));
+  const std::string name = "node" + std::to_string(state.range(0) - 1);
+  while (state.KeepRunning())
+  {
+    mitk::DoNotOptimize(storage->GetNamedNode(name));
+  }
+  state.SetItemsProcessed(state.GetIterations());
+}
+MITK_BENCHMARK(BM_DataStorageGetNamedNode)->Arg(100)->Arg(10000);
+
+void BM_PropertyListGetProperty(mitk::BenchmarkState &state)
+{
+  const std::vector<std::string> names = CreatePropertyNames(state.range(0));
+  mitk::PropertyList::Pointer list = CreatePropertyList(names);
+  while (state.KeepRunning())
+  {
+    for (const auto &name : names)
+      mitk::DoNotOptimize(list->GetProperty(name));
+  }
+  state.SetItemsProcessed(state.GetIterations() * names.size());
+}
+MITK_BENCHMARK(BM_PropertyListGetProperty)->Arg(10)->Arg(100)->Arg(1000);
+
+void BM_PropertyListGetPropertyByKey(mitk::BenchmarkState &state)
+{
+  const std::vector<std::string> names = CreatePropertyNames(state.range(0));
+  mitk::PropertyList::Pointer list = CreatePropertyList(names);
+  std::vector<mitk::PropertyKey> keys;
+  for (const auto &name : names)
+    keys.emplace_back(name);
+
+  while (state.KeepRunning())
+  {
+    for (const auto &key : keys)
+      mitk::DoNotOptimize(list->GetProperty(key));
+  }
+  state.SetItemsProcessed(state.GetIterations() * keys.size());
+}
+MITK_BENCHMARK(BM_PropertyListGetPropertyByKey)->Arg(10)->Arg(100)->Arg(1000);
+
+void BM_PropertyListGetMissingProperty(mitk::BenchmarkState &state)
+{
+  mitk::PropertyList::Pointer list = CreatePropertyList(CreatePropertyNames(state.range(0)));
+  while (state.KeepRunning())
+  {
+    mitk::DoNotOptimize(list->GetProperty("benchmark.not.there"));
+  }
+  state.SetItemsProcessed(state.GetIterations());
+}
+MITK_BENCHMARK(BM_PropertyListGetMissingProperty)->Arg(10)->Arg(1000);
+
+// The renderer specific lookup with fall back to the default list, done for every property a mapper reads
+void BM_DataNodeGetProperty(mitk::BenchmarkState &state)
+{
+  mitk::DataNode::Pointer node = mitk::DataNode::New();
+  const std::vector<std::string> names = CreatePropertyNames(state.range(0));
+  for (const auto &name : names)
+    node->SetIntProperty(name.c_str(), 1);
+
+  while (state.KeepRunning())
+  {
+    for (const auto &name : names)
+      mitk::DoNotOptimize(node->GetProperty(name.c_str()));
+  }
+  state.SetItemsProcessed(state.GetIterations() * names.size());
+}
+MITK_BENCHMARK(BM_DataNodeGetProperty)->Arg(10)->Arg(100);
@@ -0,0 +1,85 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkBenchmark.h"
+
+#include <mitkIOUtil.h>
+#include <mitkImageGenerator.h>
+
+#include <itksys/SystemTools.hxx>
+
+namespace
+{
+  // All temporary files of this translation unit go to one directory, so that they are removed even
+  // if a benchmark fails
+  class TemporaryDirectory
+  {
+  public:
+    TemporaryDirectory() : m_Path(mitk::IOUtil::CreateTemporaryDirectory("MitkCoreBenchmarks-XXXXXX")) {}
+    ~TemporaryDirectory() { itksys::SystemTools::RemoveADirectory(m_Path); }
+    std::string GetFilePath(const std::string &name) const { return m_Path + "/" + name; }
+
+  private:
+    std::string m_Path;
+  };
+
+  const TemporaryDirectory &GetTemporaryDirectory()
+  {
+    static TemporaryDirectory directory;
+    return directory;
+  }
+
+  template <typename TPixel>
+  mitk::Image::Pointer CreateCube(long long size)
+  {
+    const auto edge = static_cast<unsigned int>(size);
+    return mitk::ImageGenerator::GenerateRandomImage<TPixel>(edge, edge, edge, 1, 1, 1, 1, 100.0, 0.0);
+  }
+}
+
+// ItkImageIO is the reader/writer for all ITK supported image formats, nrrd being the default
+template <typename TPixel>
+void BM_ItkImageIOWrite(mitk::BenchmarkState &state)
+{
+  mitk::Image::Pointer image = CreateCube<TPixel>(state.range(0));
+  const std::string path = GetTemporaryDirectory().GetFilePath("write.nrrd");
+
+  while (state.KeepRunning())
+  {
+    mitk::IOUtil::Save(image, path);
+  }
+  state.SetBytesProcessed(state.GetIterations() * state.range(0) * state.range(0) * state.range(0) * sizeof(TPixel));
+}
+MITK_BENCHMARK_TEMPLATE(BM_ItkImageIOWrite, unsigned char)->Arg(64)->Arg(256);
+MITK_BENCHMARK_TEMPLATE(BM_ItkImageIOWrite, short)->Arg(64)->Arg(256);
+MITK_BENCHMARK_TEMPLATE(BM_ItkImageIOWrite, float)->Arg(64)->Arg(256);
+
+template <typename TPixel>
+void BM_ItkImageIORead(mitk::BenchmarkState &state)
+{
+  const std::string path = GetTemporaryDirectory().GetFilePath("read.nrrd");
+  mitk::IOUtil::Save(CreateCube<TPixel>(state.range(0)), path);
+
+  while (state.KeepRunning())
+  {
+    mitk::Image::Pointer image = mitk::IOUtil::Load<mitk::Image>(path);
+    mitk::DoNotOptimize(image.GetPointer());
+  }
+  state.SetBytesProcessed(state.GetIterations() * state.range(0) * state.range(0) * state.range(0) * sizeof(TPixel));
+}
+MITK_BENCHMARK_TEMPLATE(BM_ItkImageIORead, unsigned char)->Arg(64)->Arg(256);
+MITK_BENCHMARK_TEMPLATE(BM_ItkImageIORead, short)->Arg(64)->Arg(256);
+MITK_BENCHMARK_TEMPLATE(BM_ItkImageIORead, float)->Arg(64)->Arg(256);
@@ -0,0 +1,177 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkBenchmark.h"
+
+#include <mitkExtractSliceFilter.h>
+#include <mitkITKImageImport.h>
+#include <mitkImageCast.h>
+#include <mitkImageGenerator.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+#include <mitkInteractionConst.h>
+#include <mitkPlaneGeometry.h>
+#include <mitkRotationOperation.h>
+
+#include <itkImage.h>
+
+namespace
+{
+  template <typename TPixel>
+  mitk::Image::Pointer CreateCube(long long size)
+  {
+    const auto edge = static_cast<unsigned int>(size);
+    return mitk::ImageGenerator::GenerateRandomImage<TPixel>(edge, edge, edge, 1, 1, 1, 1, 100.0, 0.0);
+  }
+
+  template <typename TPixel>
+  long long GetCubeBytes(long long size)
+  {
+    return size * size * size * static_cast<long long>(sizeof(TPixel));
+  }
+}
+
+// Cost of the locking done by the accessors, independent of the amount of data touched
+template <typename TPixel>
+void BM_ImageReadAccessor(mitk::BenchmarkState &state)
+{
+  mitk::Image::Pointer image = CreateCube<TPixel>(state.range(0));
+  while (state.KeepRunning())
+  {
+    mitk::ImageReadAccessor accessor(image);
+    mitk::DoNotOptimize(accessor.GetData());
+  }
+  state.SetItemsProcessed(state.GetIterations());
+}
+MITK_BENCHMARK_TEMPLATE(BM_ImageReadAccessor, unsigned char)->Arg(32)->Arg(256);
+MITK_BENCHMARK_TEMPLATE(BM_ImageReadAccessor, float)->Arg(32)->Arg(256);
+
+template <typename TPixel>
+void BM_ImageWriteAccessor(mitk::BenchmarkState &state)
+{
+  mitk::Image::Pointer image = CreateCube<TPixel>(state.range(0));
+  while (state.KeepRunning())
+  {
+    mitk::ImageWriteAccessor accessor(image);
+    mitk::DoNotOptimize(accessor.GetData());
+  }
+  state.SetItemsProcessed(state.GetIterations());
+}
+MITK_BENCHMARK_TEMPLATE(BM_ImageWriteAccessor, float)->Arg(32)->Arg(256);
+
+// Reading one voxel per slice through a fresh accessor, the pattern of naive per-slice loops
+template <typename TPixel>
+void BM_ImageReadAccessorPerSlice(mitk::BenchmarkState &state)
+{
+  mitk::Image::Pointer image = CreateCube<TPixel>(state.range(0));
+  const auto slices = static_cast<unsigned int>(state.range(0));
+  while (state.KeepRunning())
+  {
+    for (unsigned int z = 0; z < slices; ++z)
+    {
+      mitk::ImageReadAccessor accessor(image, image->GetSliceData(z));
+      mitk::DoNotOptimize(*static_cast<const TPixel *>(accessor.GetData()));
+    }
+  }
+  state.SetItemsProcessed(state.GetIterations() * slices);
+}
+MITK_BENCHMARK_TEMPLATE(BM_ImageReadAccessorPerSlice, short)->Arg(64)->Arg(256);
+
+template <typename TPixel>
+void BM_ExtractSliceFilter(mitk::BenchmarkState &state)
+{
+  mitk::Image::Pointer image = CreateCube<TPixel>(state.range(0));
+  const bool oblique = state.range(1) != 0;
+
+  mitk::PlaneGeometry::Pointer plane = mitk::PlaneGeometry::New();
+  plane->InitializeStandardPlane(image->GetGeometry(), mitk::PlaneGeometry::Axial, state.range(0) / 2, true, false);
+  if (oblique)
+  {
+    mitk::Vector3D axis;
+    axis[0] = 1;
+    axis[1] = 1;
+    axis[2] = 0;
+    mitk::RotationOperation rotation(mitk::OpROTATE, plane->GetCenter(), axis, 30);
+    plane->ExecuteOperation(&rotation);
+  }
+
+  mitk::ExtractSliceFilter::Pointer slicer = mitk::ExtractSliceFilter::New();
+  slicer->SetInput(image);
+  slicer->SetWorldGeometry(plane);
+
+  while (state.KeepRunning())
+  {
+    // force a new extraction every iteration
+    slicer->Modified();
+    slicer->Update();
+    mitk::DoNotOptimize(slicer->GetOutput());
+  }
+  state.SetItemsProcessed(state.GetIterations());
+  state.SetLabel(oblique ? "oblique" : "axial");
+}
+MITK_BENCHMARK_TEMPLATE(BM_ExtractSliceFilter, unsigned char)->Args({256, 0})->Args({256, 1});
+MITK_BENCHMARK_TEMPLATE(BM_ExtractSliceFilter, short)->Args({128, 0})->Args({256, 0})->Args({256, 1});
+MITK_BENCHMARK_TEMPLATE(BM_ExtractSliceFilter, float)->Args({256, 0})->Args({256, 1});
+
+template <typename TPixel>
+void BM_CastToItkImage(mitk::BenchmarkState &state)
+{
+  mitk::Image::Pointer image = CreateCube<TPixel>(state.range(0));
+  typedef itk::Image<TPixel, 3> ItkImageType;
+  while (state.KeepRunning())
+  {
+    typename ItkImageType::Pointer itkImage;
+    mitk::CastToItkImage(image, itkImage);
+    mitk::DoNotOptimize(itkImage.GetPointer());
+  }
+  state.SetBytesProcessed(state.GetIterations() * GetCubeBytes<TPixel>(state.range(0)));
+}
+MITK_BENCHMARK_TEMPLATE(BM_CastToItkImage, unsigned char)->Arg(64)->Arg(256);
+MITK_BENCHMARK_TEMPLATE(BM_CastToItkImage, short)->Arg(64)->Arg(256);
+MITK_BENCHMARK_TEMPLATE(BM_CastToItkImage, float)->Arg(64)->Arg(256);
+
+// Casting to a different pixel type has to convert every voxel
+void BM_CastToItkImageConvert(mitk::BenchmarkState &state)
+{
+  mitk::Image::Pointer image = CreateCube<short>(state.range(0));
+  typedef itk::Image<float, 3> ItkImageType;
+  while (state.KeepRunning())
+  {
+    ItkImageType::Pointer itkImage;
+    mitk::CastToItkImage(image, itkImage);
+    mitk::DoNotOptimize(itkImage.GetPointer());
+  }
+  state.SetBytesProcessed(state.GetIterations() * GetCubeBytes<short>(state.range(0)));
+}
+MITK_BENCHMARK(BM_CastToItkImageConvert)->Arg(64)->Arg(256);
+
+template <typename TPixel>
+void BM_ImportItkImage(mitk::BenchmarkState &state)
+{
+  mitk::Image::Pointer image = CreateCube<TPixel>(state.range(0));
+  typedef itk::Image<TPixel, 3> ItkImageType;
+  typename ItkImageType::Pointer itkImage;
+  mitk::CastToItkImage(image, itkImage);
+
+  while (state.KeepRunning())
+  {
+    mitk::Image::Pointer imported = mitk::ImportItkImage(itkImage);
+    mitk::DoNotOptimize(imported.GetPointer());
+  }
+  state.SetBytesProcessed(state.GetIterations() * GetCubeBytes<TPixel>(state.range(0)));
+}
+MITK_BENCHMARK_TEMPLATE(BM_ImportItkImage, unsigned char)->Arg(64)->Arg(256);
+MITK_BENCHMARK_TEMPLATE(BM_ImportItkImage, float)->Arg(64)->Arg(256);
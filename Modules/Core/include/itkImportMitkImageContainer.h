@@ -60,10 +60,16 @@ namespace itk
     ///** Get the pointer from which the image data is imported. */
     // TElement *GetImportPointer() {return m_ImportPointer;};
 
-    /** \brief Set the mitk::ImageDataItem to be imported  */
-    // void SetImageDataItem(mitk::ImageDataItem* imageDataItem);
     void SetImageAccessor(mitk::ImageAccessorBase *imageAccess, size_t noBytes);
 
+    /** \brief Imports the memory of a shared mitk::ImageDataItem (see mitk::ImageDataItem::ShareData()).
+     *
+     * The container keeps the item and therefore the memory alive instead of locking the
+     * mitk::Image, so both images can be released in any order. \a data has to point to the
+     * memory of \a imageDataItem.
+     */
+    void SetImageDataItem(const mitk::ImageDataItem *imageDataItem, void *data, size_t noBytes);
+
   protected:
     ImportMitkImageContainer();
     ~ImportMitkImageContainer() override;
@@ -77,7 +83,7 @@ namespace itk
     ImportMitkImageContainer(const Self &); // purposely not implemented
     void operator=(const Self &);           // purposely not implemented
 
-    // mitk::ImageDataItem::Pointer m_ImageDataItem;
+    mitk::ImageDataItem::ConstPointer m_ImageDataItem;
     mitk::ImageAccessorBase *m_imageAccess;
   };
 
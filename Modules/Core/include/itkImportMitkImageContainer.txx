@@ -34,27 +34,24 @@ namespace itk
     m_imageAccess = nullptr;
   }
 
-  /*
   template <typename TElementIdentifier, typename TElement>
-  void
-  ImportMitkImageContainer< TElementIdentifier , TElement >
-  ::SetImageDataItem(mitk::ImageDataItem* imageDataItem)
+  void ImportMitkImageContainer<TElementIdentifier, TElement>::SetImageAccessor(mitk::ImageAccessorBase *imageAccess,
+                                                                                size_t noOfBytes)
   {
-    m_ImageDataItem = imageDataItem;
+    m_imageAccess = imageAccess;
 
-    this->SetImportPointer( (TElement*) m_ImageDataItem->GetData(), m_ImageDataItem->GetSize()/sizeof(Element), false);
+    this->SetImportPointer((TElement *)m_imageAccess->GetData(), noOfBytes / sizeof(Element), false);
 
     this->Modified();
   }
-  */
 
   template <typename TElementIdentifier, typename TElement>
-  void ImportMitkImageContainer<TElementIdentifier, TElement>::SetImageAccessor(mitk::ImageAccessorBase *imageAccess,
-                                                                                size_t noOfBytes)
+  void ImportMitkImageContainer<TElementIdentifier, TElement>::SetImageDataItem(
+    const mitk::ImageDataItem *imageDataItem, void *data, size_t noOfBytes)
   {
-    m_imageAccess = imageAccess;
+    m_ImageDataItem = imageDataItem;
 
-    this->SetImportPointer((TElement *)m_imageAccess->GetData(), noOfBytes / sizeof(Element), false);
+    this->SetImportPointer((TElement *)data, noOfBytes / sizeof(Element), false);
 
     this->Modified();
   }
@@ -65,6 +62,7 @@ namespace itk
     Superclass::PrintSelf(os, indent);
 
     os << indent << "ImageAccessor: " << m_imageAccess << std::endl;
+    os << indent << "ImageDataItem: " << m_ImageDataItem.GetPointer() << std::endl;
   }
 
 } // end namespace itk
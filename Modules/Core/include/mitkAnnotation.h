@@ -438,6 +438,9 @@ namespace mitk
 
     void SetUSProperty(const std::string &propertyKey, us::Any value);
 
+    /** \brief Sets the property and calls Modified() only if its value changed */
+    void SetPropertyIfChanged(const std::string &propertyKey, BaseProperty *property);
+
   private:
     /** \brief render this Annotation on a foreground renderer */
     bool m_ForceInForeground;
@@ -28,10 +28,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <usServiceReference.h>
 
 #include <cassert>
+#include <cstddef>
 
 namespace mitk
 {
   struct IMimeTypeProvider;
+  class IDataMemoryManager;
   class IPropertyAliases;
   class IPropertyDescriptions;
   class IPropertyExtensions;
@@ -55,6 +57,9 @@ namespace mitk
    * // Do something with shaderRepo
    * \endcode
    *
+   * The services are tracked per module context and interface, so repeated calls do not query the
+   * service registry again unless a service of that interface was registered, modified or unregistered.
+   *
    * @see CoreServicePointer
    */
   class MITKCORE_EXPORT CoreServices
@@ -103,6 +108,13 @@ namespace mitk
     */
     static IPropertyRelations *GetPropertyRelations(us::ModuleContext *context = us::GetModuleContext());
 
+    /**
+    * @brief Get an IDataMemoryManager instance.
+    * @param context The module context of the module getting the service.
+    * @return A non-nullptr IDataMemoryManager instance.
+    */
+    static IDataMemoryManager *GetDataMemoryManager(us::ModuleContext *context = us::GetModuleContext());
+
     /**
      * @brief Get an IMimeTypeProvider instance.
      * @param context The module context of the module getting the service.
@@ -110,6 +122,14 @@ namespace mitk
      */
     static IMimeTypeProvider *GetMimeTypeProvider(us::ModuleContext *context = us::GetModuleContext());
 
+    /**
+     * @brief Number of service registry lookups done by the getters so far, for profiling.
+     *
+     * A lookup is counted when a service tracker for a new module context and interface is opened
+     * and whenever a tracker acquires a newly registered service.
+     */
+    static std::size_t GetNumberOfRegistryLookups();
+
     /**
      * @brief Unget a previously acquired service instance.
      * @param service The service instance to be released.
@@ -18,6 +18,7 @@
 #define MITKDATAINTERACTOR_H_
 
 #include <MitkCoreExports.h>
+#include <mitkBaseGeometry.h>
 #include <mitkCommon.h>
 #include <mitkEventStateMachine.h>
 #include <mitkWeakPointer.h>
@@ -26,6 +27,7 @@
 namespace mitk
 {
   class DataNode;
+  class InteractionPositionEvent;
 
   itkEventMacro(DataInteractorEvent, itk::AnyEvent)
 
@@ -66,6 +68,17 @@ namespace mitk
 
     ProcessEventMode GetMode() const;
 
+    /**
+     * @brief Returns true and the world bounds outside of which mouse moves have no effect in the current state.
+     *
+     * The Dispatcher does not offer mouse move events with a position outside of these bounds to the interactor,
+     * so the conditions of interactors far away from the cursor are not evaluated. The bounds have to include
+     * every tolerance the conditions use. The default implementation returns false, i.e. mouse moves are offered
+     * regardless of their position.
+     */
+    virtual bool GetMouseMoveBounds(const InteractionPositionEvent *positionEvent,
+                                    BoundingBox::BoundsArrayType &bounds) const;
+
   protected:
     DataInteractor();
     ~DataInteractor() override;
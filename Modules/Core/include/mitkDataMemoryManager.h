@@ -0,0 +1,78 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#ifndef mitkDataMemoryManager_h
+#define mitkDataMemoryManager_h
+
+#include <mitkDataStorage.h>
+#include <mitkIDataMemoryManager.h>
+
+#include <itkCommand.h>
+#include <itkIntTypes.h>
+
+#include <map>
+#include <mutex>
+
+namespace mitk
+{
+  class DataNode;
+
+  class DataMemoryManager : public IDataMemoryManager
+  {
+  public:
+    DataMemoryManager();
+    ~DataMemoryManager() override;
+
+    void SetMemoryBudget(std::size_t bytes) override;
+    std::size_t GetMemoryBudget() const override;
+
+    void SetSwapDirectory(const std::string &path) override;
+    std::string GetSwapDirectory() const override;
+
+    std::size_t GetMemoryUsage(const BaseData *data) const override;
+    std::size_t GetMemoryUsage(const DataStorage *storage) const override;
+
+    std::size_t EnforceBudget(const DataStorage *storage) override;
+
+    void AddDataStorage(DataStorage *storage) override;
+    void RemoveDataStorage(DataStorage *storage) override;
+
+  private:
+    DataMemoryManager(const DataMemoryManager &);
+    DataMemoryManager &operator=(const DataMemoryManager &);
+
+    void OnNodeAdded(const DataNode *node);
+    void OnNodesAdded(const DataStorage::SetOfObjects *nodes);
+    void OnDataStorageDeleted(const itk::Object *caller, const itk::EventObject &event);
+
+    mutable std::mutex m_Mutex;
+    std::size_t m_MemoryBudget;
+    std::string m_SwapDirectory;
+
+    /** Modification times of the data seen by the last EnforceBudget() call */
+    std::map<const BaseData *, itk::ModifiedTimeType> m_CheckedMTimes;
+
+    /** Observed data storages and the tags of their delete observers */
+    std::map<DataStorage *, unsigned long> m_DataStorages;
+    bool m_Enforcing;
+  };
+
+  /**Creates an unmanaged (!) instance of DataMemoryManager for testing purposes.*/
+  MITKCORE_EXPORT IDataMemoryManager *CreateTestInstanceDataMemoryManager();
+}
+
+#endif
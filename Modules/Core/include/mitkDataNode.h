@@ -70,7 +70,7 @@ namespace mitk
   public:
     typedef mitk::Geometry3D::Pointer Geometry3DPointer;
     typedef std::vector<itk::SmartPointer<Mapper>> MapperVector;
-    typedef std::map<std::string, mitk::PropertyList::Pointer> MapOfPropertyLists;
+    typedef std::map<std::string, mitk::PropertyList::Pointer, std::less<>> MapOfPropertyLists;
     typedef std::vector<MapOfPropertyLists::key_type> PropertyListKeyNames;
     typedef std::set<std::string> GroupTagList;
 
@@ -242,6 +242,14 @@ namespace mitk
      */
     mitk::BaseProperty *GetProperty(const char *propertyKey, const mitk::BaseRenderer *renderer = nullptr, bool fallBackOnDataProperties = true) const;
 
+    /**
+     * \brief Same as above, but looks the property up by an interned key
+     *
+     * Use a static mitk::PropertyKey for properties that are queried very often
+     * (e.g. by mappers on every render pass).
+     */
+    mitk::BaseProperty *GetProperty(const PropertyKey &propertyKey, const mitk::BaseRenderer *renderer = nullptr, bool fallBackOnDataProperties = true) const;
+
     /**
      * \brief Get the property of type T with key \a propertyKey from the PropertyList
      * of the \a renderer, if available there, otherwise use the BaseRenderer-independent PropertyList.
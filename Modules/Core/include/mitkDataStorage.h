@@ -25,6 +25,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkMessage.h"
 #include <MitkCoreExports.h>
 #include <map>
+#include <vector>
 
 namespace mitk
 {
@@ -87,6 +88,57 @@ namespace mitk
     //##
     void Remove(const DataStorage::SetOfObjects *nodes);
 
+    //##Documentation
+    //## @brief Adds a set of nodes without parents to the DataStorage
+    //##
+    //## The nodes are added in one batch update (see BeginBatchUpdate()), i.e. a single AddNodesEvent
+    //## is emitted after all nodes have been added.
+    void Add(const DataStorage::SetOfObjects *nodes);
+
+    //##Documentation
+    //## @brief Starts a batch update of the DataStorage
+    //##
+    //## Nodes that are added or removed until the matching EndBatchUpdate() call are collected and
+    //## announced by a single AddNodesEvent and RemoveNodesEvent at the end of the batch. The per-node
+    //## AddNodeEvent and RemoveNodeEvent are still emitted, listeners that handle the aggregated events
+    //## should ignore them while IsBatchUpdateActive() returns true. Batch updates can be nested,
+    //## the aggregated events are emitted when the outermost batch ends.
+    void BeginBatchUpdate();
+
+    //##Documentation
+    //## @brief Ends a batch update and emits the aggregated events, see BeginBatchUpdate()
+    //##
+    //## Throws std::logic_error if no batch update is active.
+    void EndBatchUpdate();
+
+    //##Documentation
+    //## @brief Returns true between BeginBatchUpdate() and the matching EndBatchUpdate()
+    bool IsBatchUpdateActive() const;
+
+    //##Documentation
+    //## @brief Scope guard for a batch update, calls BeginBatchUpdate() in the constructor and
+    //## EndBatchUpdate() in the destructor
+    //##
+    //## \code
+    //## {
+    //##   mitk::DataStorage::BatchUpdate batch(dataStorage);
+    //##   for (auto node : nodes)
+    //##     dataStorage->Add(node);
+    //## } // AddNodesEvent is emitted here
+    //## \endcode
+    class MITKCORE_EXPORT BatchUpdate
+    {
+    public:
+      explicit BatchUpdate(DataStorage *storage);
+      ~BatchUpdate();
+
+    private:
+      BatchUpdate(const BatchUpdate &) = delete;
+      BatchUpdate &operator=(const BatchUpdate &) = delete;
+
+      DataStorage::Pointer m_Storage;
+    };
+
     //##Documentation
     //## @brief returns a set of data objects that meet the given condition(s)
     //##
@@ -102,7 +154,9 @@ namespace mitk
     //## (see definition of NodePredicateBase for details).
     //## The method returns a set of SmartPointers to the DataNodes that fulfill the
     //## conditions. A set of all objects can be retrieved with the GetAll() method;
-    SetOfObjects::ConstPointer GetSubset(const NodePredicateBase *condition) const;
+    //## Subclasses may override this method to answer the query from an index, the result
+    //## has to be the same as filtering GetAll() with the condition.
+    virtual SetOfObjects::ConstPointer GetSubset(const NodePredicateBase *condition) const;
 
     //##Documentation
     //## @brief returns a set of source objects for a given node that meet the given condition(s).
@@ -235,6 +289,22 @@ namespace mitk
     // a Message1 object which is thread safe
     DataStorageEvent RemoveNodeEvent;
 
+    typedef Message1<const SetOfObjects *> DataStorageSetEvent;
+    //##Documentation
+    //## @brief AddNodesEvent is emitted once at the end of a batch update with all nodes that have been
+    //## added during the batch and are still in the DataStorage.
+    //##
+    //## It is not emitted for nodes that are added outside of a batch update, use AddNodeEvent for these.
+    DataStorageSetEvent AddNodesEvent;
+
+    //##Documentation
+    //## @brief RemoveNodesEvent is emitted once at the end of a batch update with all nodes that have been
+    //## removed during the batch and have not been added again.
+    //##
+    //## In contrast to RemoveNodeEvent, the nodes are no longer in the DataStorage when it is emitted.
+    //## It is not emitted for nodes that are removed outside of a batch update.
+    DataStorageSetEvent RemoveNodesEvent;
+
     //##Documentation
     //## @brief ChangedEvent is emitted directly after a node was changed.
     //##
@@ -397,6 +467,13 @@ namespace mitk
     //## If the cast succeeds the ChangedNodeEvent is emitted with this node.
     void OnNodeModifiedOrDeleted(const itk::Object *caller, const itk::EventObject &event);
 
+    //##Documentation
+    //## @brief  Called for every modified event of a node in the DataStorage.
+    //##
+    //## In contrast to the ChangedNodeEvent, this method is also called while node modified events
+    //## are blocked. Subclasses can use it to keep their internal bookkeeping up to date.
+    virtual void NodeModified(const DataNode *) {}
+
     //##Documentation
     //## @brief  Adds a Modified-Listener to the given Node.
     void AddListeners(const DataNode *_Node);
@@ -420,6 +497,13 @@ namespace mitk
     //## to suppress NodeChangedEvent to be emitted.
     bool m_BlockNodeModifiedEvents;
 
+    //##Documentation
+    //## @brief Nesting depth of batch updates and the nodes added or removed during the current batch
+    unsigned int m_BatchUpdateDepth;
+    std::vector<DataNode::ConstPointer> m_BatchAddedNodes;
+    std::vector<DataNode::ConstPointer> m_BatchRemovedNodes;
+    mutable itk::SimpleFastMutexLock m_BatchUpdateMutex;
+
     //##Documentation
     //## @brief Standard Constructor for ::New() instantiation
     DataStorage();
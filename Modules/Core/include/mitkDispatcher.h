@@ -26,6 +26,7 @@
 #include <MitkCoreExports.h>
 #include <list>
 #include <mitkWeakPointer.h>
+#include <vector>
 
 namespace mitk
 {
@@ -41,6 +42,8 @@ namespace mitk
   * The order in which DataInteractors are offered to handle an event is determined by layer of their associated
   * DataNode.
   * Higher layers are preferred.
+  * Mouse moves are not offered to DataInteractors that report the position to be outside of their
+  * DataInteractor::GetMouseMoveBounds().
   *
   * \ingroup Interaction
   */
@@ -113,6 +116,16 @@ namespace mitk
 
     void SetEventProcessingMode(DataInteractor *);
 
+    /**
+     * Sorts m_Interactors by layer (descending), reading the layer property only once per interactor.
+     */
+    void SortInteractorsByLayer();
+
+    /**
+     * Refreshes the cached InteractionEventObservers if the ServiceTracker reports a change of the tracked services.
+     */
+    void UpdateEventObservers();
+
     /**
      * Function to handle special internal events,
      * such as events that are directed at a specific DataInteractor,
@@ -125,6 +138,13 @@ namespace mitk
      * InteractionEvents
      */
     us::ServiceTracker<InteractionEventObserver> *m_EventObserverTracker;
+
+    /**
+     * Observers tracked at m_EventObserverTrackingCount, so the registry is not queried for every event.
+     */
+    std::vector<us::ServiceReference<InteractionEventObserver>> m_EventObserverReferences;
+    std::vector<InteractionEventObserver *> m_EventObservers;
+    int m_EventObserverTrackingCount;
   };
 
 } /* namespace mitk */
@@ -145,6 +145,31 @@ namespace mitk
     * GetVtkOutput(). Otherwise the output is empty for the first update step.
     */
     void SetVtkOutputRequest(bool isRequested) { m_VtkOutputRequested = isRequested; }
+    /** \brief Only set up the reslice axes, the output spacing and the output extent.
+    * The slice itself is not extracted, which is useful if the caller samples the image
+    * in another way (e.g. on the GPU) but needs the geometry of the slice.
+    */
+    void SetResliceGeometryOnly(bool geometryOnly) { m_ResliceGeometryOnly = geometryOnly; }
+    /** \brief Make the reslicer independent of the input image and its geometry.
+    * Call it after an update with SetResliceGeometryOnly(true). The reslicer then reads a shallow copy of the
+    * volume and uses a copy of the reslice transform, so ResliceDetached() can run on a worker thread while
+    * other filters slice the same image. The caller has to keep the volume alive meanwhile, e.g. by an
+    * ImageReadAccessor. Returns false if the volume is not set or the reslice transform is not linear.
+    */
+    bool DetachReslicer();
+    /** \brief Extract the slice with the reslicer prepared by DetachReslicer(), the slice is in GetVtkOutput(). */
+    void ResliceDetached();
+    /** \brief Sample the slice with the registered IImageProcessingAccelerator service (e.g. on the GPU).
+    * Only planar slices of single component images with nearest neighbor or linear interpolation
+    * and an output dimension of 2 are supported. The filter falls back to vtkImageReslice if
+    * there is no accelerator or the slice is not supported. The output is written to the
+    * output of the reslicer, so GetVtkOutput() works as well.
+    * Note: do not use it with reslicers writing to the input, like mitkVtkImageOverwrite in overwrite mode.
+    * Default is false.
+    */
+    void SetUseAccelerator(bool useAccelerator) { m_UseAccelerator = useAccelerator; }
+    bool GetUseAccelerator() const { return m_UseAccelerator; }
+
     /** \brief Get the reslices axis matrix.
     * Note: the axis are recalculated when calling SetResliceTransformByGeometry.
     */
@@ -170,6 +195,11 @@ namespace mitk
     void GenerateOutputInformation() override;
     void GenerateInputRequestedRegion() override;
 
+    /** \brief Sample the slice with the IImageProcessingAccelerator into the output of the reslicer.
+    * Expects the reslicer to be set up. Returns false if the slice could not be sampled this way.
+    */
+    bool ResliceOnAccelerator(const int outputExtent[6]);
+
     const PlaneGeometry *m_WorldGeometry;
     vtkSmartPointer<vtkImageReslice> m_Reslicer;
 
@@ -193,6 +223,9 @@ namespace mitk
 
     bool m_VtkOutputRequested;
 
+    bool m_ResliceGeometryOnly;
+    bool m_UseAccelerator;
+
     double m_BackgroundLevel;
 
     unsigned int m_Component;
@@ -31,6 +31,11 @@ namespace mitk
    * If a pixel of the 2-d output image isn't located within the bounds of the
    * 3-d input image, it is set to the lowest possible pixel value.
    *
+   * The input index is advanced by a constant step along each output row and
+   * every row is clipped to the span that lies within the input image once,
+   * so there are no per pixel geometry transforms or bounds checks. Nearest
+   * neighbor and linear interpolation read the input buffer directly.
+   *
    * Cubic interpolation is considerably slow on the first update for a newly
    * set input image. Subsequent filter updates with cubic interpolation are
    * faster by several orders of magnitude as long as the input image was
@@ -38,8 +43,7 @@ namespace mitk
    *
    * This filter is completely based on ITK compared to the VTK-based
    * mitk::ExtractSliceFilter. It is more robust, easy to use, and produces
-   * an mitk::Image with valid geometry. Generally it is not as fast as
-   * mitk::ExtractSliceFilter, though.
+   * an mitk::Image with valid geometry.
    */
   class MITKCORE_EXPORT ExtractSliceFilter2 final : public ImageToImageFilter
   {
@@ -0,0 +1,78 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#ifndef mitkIDataMemoryManager_h
+#define mitkIDataMemoryManager_h
+
+#include <MitkCoreExports.h>
+#include <mitkServiceInterface.h>
+
+#include <cstddef>
+#include <string>
+
+namespace mitk
+{
+  class BaseData;
+  class DataStorage;
+
+  /**
+   * \ingroup MicroServices_Interfaces
+   * \brief Interface of the data memory manager service.
+   *
+   * The service accounts the bytes of pixel and poly data held by the nodes of data storages
+   * and enforces a memory budget: if the budget is exceeded, the pixel data of the least
+   * recently used images that were not modified since the previous check is swapped out to
+   * disk (see Image::SwapOutData()). Swapped out images stay fully usable, their data is paged
+   * in again by the operating system on access.
+   *
+   * Data storages added with AddDataStorage() are checked whenever a node is added to them,
+   * EnforceBudget() can be called at any time, e.g. after a large computation.
+   */
+  class MITKCORE_EXPORT IDataMemoryManager
+  {
+  public:
+    virtual ~IDataMemoryManager();
+
+    /** \brief Set the memory budget in bytes. A budget of 0 disables swapping. */
+    virtual void SetMemoryBudget(std::size_t bytes) = 0;
+    virtual std::size_t GetMemoryBudget() const = 0;
+
+    /** \brief Directory for swap files. Empty means the default temporary directory. */
+    virtual void SetSwapDirectory(const std::string &path) = 0;
+    virtual std::string GetSwapDirectory() const = 0;
+
+    /** \brief Bytes of pixel or poly data \a data keeps in main memory. */
+    virtual std::size_t GetMemoryUsage(const BaseData *data) const = 0;
+
+    /** \brief Bytes of pixel or poly data all nodes of \a storage keep in main memory. */
+    virtual std::size_t GetMemoryUsage(const DataStorage *storage) const = 0;
+
+    /**
+     * \brief Swaps out least recently used, unmodified images of \a storage until the memory budget is met.
+     * \return The number of bytes released from main memory.
+     */
+    virtual std::size_t EnforceBudget(const DataStorage *storage) = 0;
+
+    /** \brief Enforce the budget on \a storage whenever a node is added to it. */
+    virtual void AddDataStorage(DataStorage *storage) = 0;
+    virtual void RemoveDataStorage(DataStorage *storage) = 0;
+  };
+}
+
+MITK_DECLARE_SERVICE_INTERFACE(mitk::IDataMemoryManager, "org.mitk.IDataMemoryManager")
+
+#endif
@@ -0,0 +1,89 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkIImageProcessingAccelerator_h
+#define mitkIImageProcessingAccelerator_h
+
+#include <MitkCoreExports.h>
+#include <mitkImage.h>
+#include <mitkServiceInterface.h>
+
+class vtkImageData;
+class vtkMatrix4x4;
+
+namespace mitk
+{
+  class BaseGeometry;
+
+  /**
+   * \ingroup MicroServices_Interfaces
+   * \brief Interface of a service that runs common image operations on a compute device, e.g. a GPU.
+   *
+   * The service is optional: it is registered by modules providing a device implementation (e.g. MitkOpenCL)
+   * and algorithms only use it if the caller opted in (see ExtractSliceFilter::SetUseAccelerator()).
+   * Every method returns an empty result if the input is not supported by the implementation, in this case
+   * the caller falls back to its CPU implementation.
+   */
+  class MITKCORE_EXPORT IImageProcessingAccelerator
+  {
+  public:
+    virtual ~IImageProcessingAccelerator();
+
+    /**
+     * \brief Smooth a 3D image with a Gaussian kernel, separably along the three axes.
+     *
+     * \param[in] sigma Standard deviation per axis in mm. Image borders are replicated.
+     * \return The smoothed image with pixel type float, or nullptr if the input is not supported.
+     */
+    virtual Image::Pointer GaussianSmooth(const Image *input, unsigned int timeStep, const double sigma[3]) = 0;
+
+    /**
+     * \brief Resample a 3D image to the voxel grid of \a targetGeometry.
+     *
+     * \param[in] linear Trilinear interpolation if true, nearest neighbor otherwise.
+     * \param[in] defaultValue Value of voxels outside of the input.
+     * \return The resampled image with the pixel type of the input and the geometry of \a targetGeometry,
+     *         or nullptr if the input is not supported.
+     */
+    virtual Image::Pointer Resample(const Image *input,
+                                    unsigned int timeStep,
+                                    const BaseGeometry *targetGeometry,
+                                    bool linear,
+                                    double defaultValue) = 0;
+
+    /**
+     * \brief Sample a 2D slice of a 3D image, like vtkImageReslice does for ExtractSliceFilter.
+     *
+     * \param[in] outputToInputIndex Maps the index (i, j, 0) of an output pixel, relative to the first pixel
+     *            of \a output, to the continuous index of the input.
+     * \param[in] linear Bilinear interpolation if true, nearest neighbor otherwise. Rounding and the handling
+     *            of the input border follow vtkImageReslice.
+     * \param[in] backgroundLevel Value of pixels outside of the input.
+     * \param[in,out] output Allocated single component slice, its scalar type has to match the input.
+     * \return False if the input is not supported, \a output is not modified in this case.
+     */
+    virtual bool Reslice(const Image *input,
+                         unsigned int timeStep,
+                         vtkMatrix4x4 *outputToInputIndex,
+                         bool linear,
+                         double backgroundLevel,
+                         vtkImageData *output) = 0;
+  };
+}
+
+MITK_DECLARE_SERVICE_INTERFACE(mitk::IImageProcessingAccelerator, "org.mitk.IImageProcessingAccelerator")
+
+#endif
@@ -29,6 +29,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkIFileWriter.h>
 
 #include <fstream>
+#include <future>
 
 namespace us
 {
@@ -317,6 +318,36 @@ namespace mitk
     static std::vector<BaseData::Pointer> Load(const std::vector<std::string> &paths,
                                                const ReaderOptionsFunctorBase *optionsCallback = nullptr);
 
+    /**
+     * @brief Loads a list of file paths into the given DataStorage using a pool of worker threads.
+     *
+     * Mime-type detection and reading of the files run concurrently, while reader selection,
+     * the \c optionsCallback and adding the nodes to \c storage happen on the calling thread.
+     * The nodes are added in the order of \c paths, independent of the order in which the
+     * files finish loading. Progress is reported through mitk::ProgressBar.
+     *
+     * Different reader instances are used from several threads at the same time, so this
+     * must only be used for file types whose readers are safe to run in parallel. As readers
+     * are selected before anything is read, the \c optionsCallback may also be called for
+     * entries which are skipped later because a previous entry already read them, e.g. as
+     * part of a series.
+     *
+     * @param paths A list of absolute file names including the file extension.
+     * @param storage A DataStorage object to which the loaded data will be added.
+     * @param optionsCallback Pointer to a callback instance, see Load(const std::vector<std::string>&, DataStorage&, const ReaderOptionsFunctorBase*).
+     * @param numberOfThreads The maximum number of worker threads, 0 uses the number of hardware threads.
+     * @return The set of added DataNode objects.
+     * @throws mitk::Exception if an entry in \c paths could not be loaded.
+     */
+    static DataStorage::SetOfObjects::Pointer LoadConcurrently(const std::vector<std::string> &paths,
+                                                               DataStorage &storage,
+                                                               const ReaderOptionsFunctorBase *optionsCallback = nullptr,
+                                                               unsigned int numberOfThreads = 0);
+
+    static std::vector<BaseData::Pointer> LoadConcurrently(const std::vector<std::string> &paths,
+                                                           const ReaderOptionsFunctorBase *optionsCallback = nullptr,
+                                                           unsigned int numberOfThreads = 0);
+
     /**
      * @brief Loads the contents of a us::ModuleResource and returns the corresponding mitk::BaseData
      * @param usResource a ModuleResource, representing a BaseData object
@@ -408,12 +439,41 @@ namespace mitk
      */
     static void Save(std::vector<SaveInfo> &saveInfos, bool setPathProperty = false);
 
+    /**
+     * @brief Save a mitk::BaseData instance in a background thread.
+     *
+     * The data is cloned before this method returns. Images share their voxels with
+     * the clone until one of them is modified (copy-on-write), so the snapshot is cheap
+     * and \c data may be changed or deleted while it is written. The writer is selected
+     * and configured with \c options in the calling thread. No progress is reported.
+     *
+     * @param data The data to save.
+     * @param path The path to the file including file name and file extension.
+     * @param options The IFileWriter options to use for the selected writer.
+     * @return A future that becomes ready when writing is done and rethrows the
+     *         mitk::Exception if the writer failed.
+     * @throws mitk::Exception if \c data is null or empty or if no writer is available.
+     *
+     * @note Like all writers the background write may switch the global locale
+     *       temporarily (see LocaleSwitch).
+     */
+    static std::future<void> SaveAsync(const mitk::BaseData *data,
+                                       const std::string &path,
+                                       const IFileWriter::Options &options = IFileWriter::Options());
+
   protected:
     static std::string Load(std::vector<LoadInfo> &loadInfos,
                             DataStorage::SetOfObjects *nodeResult,
                             DataStorage *ds,
                             const ReaderOptionsFunctorBase *optionsCallback);
 
+    static std::string LoadConcurrently(const std::vector<std::string> &paths,
+                                        std::vector<LoadInfo> &loadInfos,
+                                        DataStorage::SetOfObjects *nodeResult,
+                                        DataStorage *ds,
+                                        const ReaderOptionsFunctorBase *optionsCallback,
+                                        unsigned int numberOfThreads);
+
     static std::string Save(const BaseData *data,
                             const std::string &mimeType,
                             const std::string &path,
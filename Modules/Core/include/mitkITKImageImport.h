@@ -194,6 +194,32 @@ namespace mitk
                                     const BaseGeometry *geometry = nullptr,
                                     bool update = true);
 
+  /**
+  * @brief Imports an itk::Image (with a specific type) as an mitk::Image
+  * that shares the memory of the itk::Image.
+  * @ingroup Adaptor
+  *
+  * No data is copied and no memory management flags of the itk::Image are
+  * changed. The mitk::Image keeps the pixel container of the itk::Image
+  * alive, so both images can be released in any order, e.g. when an image
+  * computed inside of an AccessByItk function is handed back. Writes to the
+  * itk::Image are visible in the mitk::Image. The first write access to the
+  * mitk::Image copies the data if the itk::Image still exists
+  * (copy-on-write, see ImageDataItem::ShareData()).
+  *
+  * \warning Re-allocating the itk::Image with a different size frees the
+  * shared memory. Do not re-run the pipeline of the itk::Image as long as
+  * the mitk::Image is in use.
+  *
+  * \param update: if \a true, Update() is called on the itk::Image first.
+  * \sa GrabItkImageMemory
+  * \sa ShareMitkImageMemory
+  */
+  template <typename ItkOutputImageType>
+  Image::Pointer ShareItkImageMemory(ItkOutputImageType *itkimage,
+                                     const BaseGeometry *geometry = nullptr,
+                                     bool update = true);
+
 } // namespace mitk
 
 #ifndef MITK_MANUAL_INSTANTIATION
@@ -188,4 +188,21 @@ mitk::Image::Pointer mitk::GrabItkImageMemory(ItkOutputImageType *itkimage,
   return resultImage;
 }
 
+template <typename ItkOutputImageType>
+mitk::Image::Pointer mitk::ShareItkImageMemory(ItkOutputImageType *itkimage, const BaseGeometry *geometry, bool update)
+{
+  if (update)
+    itkimage->Update();
+
+  mitk::Image::Pointer resultImage = mitk::Image::New();
+  resultImage->InitializeByItk(itkimage);
+  resultImage->SetImportChannel(itkimage->GetBufferPointer(), 0, Image::ReferenceMemory);
+  resultImage->GetChannelData(0)->SetMemoryHolder(itkimage->GetPixelContainer());
+
+  if (geometry != nullptr)
+    resultImage->SetGeometry(static_cast<mitk::BaseGeometry *>(geometry->Clone().GetPointer()));
+
+  return resultImage;
+}
+
 #endif //__mitkITKImageImport_txx
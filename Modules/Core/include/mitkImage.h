@@ -21,6 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkImageAccessorBase.h"
 #include "mitkImageDataItem.h"
 #include "mitkImageDescriptor.h"
+#include "mitkImageRegionProvider.h"
 #include "mitkImageVtkAccessor.h"
 #include "mitkLevelWindow.h"
 #include "mitkPlaneGeometry.h"
@@ -165,6 +166,28 @@ namespace mitk
     virtual vtkImageData *GetVtkImageData(int t = 0, int n = 0);
     virtual const vtkImageData *GetVtkImageData(int t = 0, int n = 0) const;
 
+    //##Documentation
+    //## @brief Number of bytes of pixel data this image keeps in main memory.
+    //##
+    //## Memory mapped (file backed) data is not counted, memory shared with other
+    //## images (see ImageDataItem::ShareData()) is counted by each of them.
+    size_t GetDataMemorySize() const;
+
+    //##Documentation
+    //## @brief Time stamp of the last request of a slice, volume or channel of this image.
+    //##
+    //## Can be compared to other time stamps to find the least recently used images.
+    itk::ModifiedTimeType GetDataAccessTime() const { return m_DataAccessTime.GetMTime(); }
+
+    //##Documentation
+    //## @brief Moves the pixel data held in main memory to temporary files in @a path and maps them back.
+    //##
+    //## The image stays fully usable: the operating system pages the data in again on access
+    //## and may drop it again under memory pressure. The files are removed when the data is
+    //## released. Nothing is done while image accessors are active.
+    //## @return true if any data was swapped out.
+    bool SwapOutData(const std::string &path = std::string());
+
     //##Documentation
     //## @brief Get the complete image, i.e., all channels linked together, as a @a mitkIpPicDescriptor.
     //##
@@ -646,6 +669,17 @@ namespace mitk
       new \a ImageStatisticsHolder object.
       */
     StatisticsHolderPointer GetStatistics() const { return m_ImageStatistics; }
+
+    /**
+      \brief Sets an object that provides the voxels of arbitrary regions on request.
+
+      The provider backs all volumes that are not held in memory when they are accessed via
+      ImageRegionReadAccessor, e.g. for images that are read from a file region by region
+      (see ImageFileRegionProvider). Volumes that are set in memory always take precedence.
+      */
+    void SetRegionProvider(ImageRegionProvider *provider);
+    ImageRegionProvider *GetRegionProvider() const;
+
   protected:
     mitkCloneMacro(Self);
 
@@ -698,6 +732,8 @@ namespace mitk
 
     ImageDescriptor::Pointer m_ImageDescriptor;
 
+    itk::SmartPointer<ImageRegionProvider> m_RegionProvider;
+
     size_t *m_OffsetTable;
     ImageDataItemPointer m_CompleteData;
 
@@ -730,6 +766,34 @@ namespace mitk
     bool IsVolumeSet_unlocked(int t, int n) const;
     bool IsChannelSet_unlocked(int n) const;
 
+    /**
+     * @brief Copies all data that is still shared with other images (see ImageDataItem::ShareData()).
+     *
+     * Called before the data of the image is written, i.e. when an ImageWriteAccessor is created
+     * or data is imported. Items referencing the copied memory and the address ranges of the
+     * registered accessors (including @a accessor) are moved to the new memory.
+     */
+    void DetachSharedData(ImageAccessorBase *accessor = nullptr);
+
+    /** Describes the move of the memory of a top level item to a new address */
+    struct DataMove
+    {
+      const ImageDataItem *root;
+      const unsigned char *oldBegin;
+      unsigned char *newBegin;
+      size_t size;
+    };
+
+    static unsigned char *RebaseAddress(const std::vector<DataMove> &moves,
+                                        const ImageDataItem *root,
+                                        const void *address);
+
+    /** Moves the sub items of the moved top level items to the new memory */
+    void MoveItemData_unlocked(const std::vector<DataMove> &moves);
+
+    /** Updated whenever a slice, volume or channel item is requested */
+    mutable itk::TimeStamp m_DataAccessTime;
+
     /** Stores all existing ImageReadAccessors */
     mutable std::vector<ImageAccessorBase *> m_Readers;
     /** Stores all existing ImageWriteAccessors */
@@ -737,6 +801,9 @@ namespace mitk
     /** Stores all existing ImageVtkAccessors */
     mutable std::vector<ImageAccessorBase *> m_VtkReaders;
 
+    /** Keeps memory alive that was detached while accessors of this image were still using it */
+    mutable std::vector<itk::LightObject::ConstPointer> m_RetiredDataHolders;
+
     /** A mutex, which needs to be locked to manage m_Readers and m_Writers */
     itk::SimpleFastMutexLock m_ReadWriteLock;
     /** A mutex, which needs to be locked to manage m_VtkReaders */
@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkCastImageFilter.h>
 #include <mitkImageToItk.h>
 #include <mitkPPArgCount.h>
+#include <mitkTracer.h>
 #include <boost/preprocessor/expand.hpp>
 #include <boost/preprocessor/seq/for_each.hpp>
 #include <boost/preprocessor/seq/for_each_product.hpp>
@@ -318,6 +319,7 @@ namespace mitk
 #define AccessFixedTypeByItk(mitkImage, itkImageTypeFunction, pixelTypeSeq, dimSeq)                                    \
                                                                                                                        \
   {                                                                                                                    \
+    MITK_TRACE_SCOPE("AccessByItk", BOOST_PP_STRINGIZE(itkImageTypeFunction));                                         \
     const mitk::PixelType &pixelType = mitkImage->GetPixelType();                                                      \
     _checkSpecificDimension(mitkImage, dimSeq);                                                                        \
     _accessFixedTypeByItk(itkImageTypeFunction, mitkImage, pixelTypeSeq, dimSeq)                                       \
@@ -558,6 +560,7 @@ namespace mitk
 #define AccessFixedTypeByItk_n(mitkImage, itkImageTypeFunction, pixelTypeSeq, dimSeq, va_tuple)                        \
                                                                                                                        \
   {                                                                                                                    \
+    MITK_TRACE_SCOPE("AccessByItk", BOOST_PP_STRINGIZE(itkImageTypeFunction));                                         \
     const mitk::PixelType &pixelType = mitkImage->GetPixelType();                                                      \
     _checkSpecificDimension(mitkImage, dimSeq);                                                                        \
     _accessFixedTypeByItk_n(itkImageTypeFunction, mitkImage, pixelTypeSeq, dimSeq, va_tuple)                           \
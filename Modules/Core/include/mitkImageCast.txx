@@ -20,10 +20,88 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkCastImageFilter.h>
 #include <itkImage.h>
 
+#include <algorithm>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
 namespace mitk
 {
 #ifndef DOXYGEN_SKIP
 
+  /** Converts a contiguous pixel buffer. The loop is kept trivial so that compilers
+   *  vectorize the common integer <-> floating point conversions. */
+  template <typename TInputPixel, typename TOutputPixel>
+  void _ConvertPixelBuffer(const TInputPixel *input, TOutputPixel *output, std::size_t count)
+  {
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      output[i] = static_cast<TOutputPixel>(input[i]);
+    }
+  }
+
+  /** Converts a contiguous pixel buffer with one chunk per core. Small buffers are
+   *  converted in the calling thread. */
+  template <typename TInputPixel, typename TOutputPixel>
+  void _ConvertPixelBufferParallel(const TInputPixel *input, TOutputPixel *output, std::size_t count)
+  {
+    const std::size_t minimumChunkSize = 1 << 16;
+    const std::size_t numberOfChunks =
+      std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), count / minimumChunkSize);
+
+    if (numberOfChunks < 2)
+    {
+      _ConvertPixelBuffer(input, output, count);
+      return;
+    }
+
+    // Chunks start at multiples of 64 pixels, which keeps every thread on its own cache lines
+    const std::size_t chunkSize = ((count + numberOfChunks - 1) / numberOfChunks + 63) / 64 * 64;
+
+    std::vector<std::thread> threads;
+    for (std::size_t begin = chunkSize; begin < count; begin += chunkSize)
+    {
+      const std::size_t size = std::min(chunkSize, count - begin);
+      threads.emplace_back([input, output, begin, size]() { _ConvertPixelBuffer(input + begin, output + begin, size); });
+    }
+    _ConvertPixelBuffer(input, output, std::min(chunkSize, count));
+
+    for (auto &thread : threads)
+    {
+      thread.join();
+    }
+  }
+
+  /** Converts scalar images without a pipeline. Returns false if the input is not
+   *  completely buffered, in which case itk::CastImageFilter is used. */
+  template <typename TPixel, unsigned int VImageDimension, class ItkOutputImageType>
+  bool _DirectCastToItkImage(const itk::Image<TPixel, VImageDimension> *itkInputImage,
+                             itk::SmartPointer<ItkOutputImageType> &itkOutputImage,
+                             std::true_type)
+  {
+    const auto &region = itkInputImage->GetBufferedRegion();
+    if (region != itkInputImage->GetLargestPossibleRegion())
+      return false;
+
+    typename ItkOutputImageType::Pointer output = ItkOutputImageType::New();
+    output->CopyInformation(itkInputImage);
+    output->SetBufferedRegion(region);
+    output->SetRequestedRegion(region);
+    output->Allocate();
+
+    _ConvertPixelBufferParallel(itkInputImage->GetBufferPointer(), output->GetBufferPointer(), region.GetNumberOfPixels());
+    itkOutputImage = output;
+    return true;
+  }
+
+  template <typename TPixel, unsigned int VImageDimension, class ItkOutputImageType>
+  bool _DirectCastToItkImage(const itk::Image<TPixel, VImageDimension> *,
+                             itk::SmartPointer<ItkOutputImageType> &,
+                             std::false_type)
+  {
+    return false;
+  }
+
   template <typename ItkOutputImageType>
   void CastToItkImage(const mitk::Image *mitkImage, itk::SmartPointer<ItkOutputImageType> &itkOutputImage)
   {
@@ -47,6 +125,14 @@ namespace mitk
       itkOutputImage = const_cast<ItkOutputImageType *>(reinterpret_cast<const ItkOutputImageType *>(itkInputImage));
       return;
     }
+
+    typedef std::integral_constant<bool,
+                                   std::is_arithmetic<TPixel>::value &&
+                                     std::is_arithmetic<typename ItkOutputImageType::PixelType>::value>
+      IsScalarConversion;
+    if (_DirectCastToItkImage(itkInputImage, itkOutputImage, IsScalarConversion()))
+      return;
+
     typedef itk::CastImageFilter<ItkInputImageType, ItkOutputImageType> CastImageFilterType;
     typename CastImageFilterType::Pointer castImageFilter = CastImageFilterType::New();
     castImageFilter->SetInput(itkInputImage);
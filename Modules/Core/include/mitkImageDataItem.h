@@ -129,6 +129,31 @@ namespace mitk
 
     // Returns if image data should be deleted on destruction of ImageDataItem.
     bool GetManageMemory() const { return m_ManageMemory; }
+
+    /**
+     * @brief Keeps an external owner of the referenced memory alive as long as this item exists.
+     *
+     * Used for items that reference memory which is neither copied nor managed by the item itself,
+     * e.g. a memory mapped file (see mitk::MemoryMappedFile). Sub-items keep their parent and
+     * therefore the holder alive as well.
+     */
+    void SetMemoryHolder(const itk::LightObject *holder) { m_MemoryHolder = holder; }
+    const itk::LightObject *GetMemoryHolder() const { return m_MemoryHolder.GetPointer(); }
+
+    /**
+     * @brief Returns a new top level item that references the memory of this item without copying it.
+     *
+     * The memory is shared copy-on-write: the first ImageWriteAccessor that is requested for an image
+     * holding a shared item copies the data (see Image::DetachSharedData()). Returns nullptr if the
+     * memory can not be shared safely, i.e. it is neither managed by the item nor kept alive by a
+     * memory holder.
+     */
+    ImageDataItem::Pointer ShareData() const;
+
+    /**
+     * @brief Returns true if the memory of this item is currently referenced by another top level item.
+     */
+    bool IsDataShared() const;
     virtual void ConstructVtkImageData(ImageConstPointer) const;
 
     size_t GetSize() const { return m_Size; }
@@ -153,8 +178,24 @@ namespace mitk
   private:
     void ComputeItemSize(const unsigned int *dimensions, unsigned int dimension);
 
+    const ImageDataItem *GetRoot() const;
+
+    /**
+     * @brief Gives a top level item exclusive ownership of its memory again.
+     *
+     * Copies the data if it is still shared, otherwise takes the memory back from an unshared holder.
+     * The holder that referenced the memory before is returned in @a previousHolder.
+     * @return true if the data was copied and m_Data changed.
+     */
+    bool DetachData(itk::LightObject::ConstPointer &previousHolder);
+
+    /** @brief Moves m_Data to @a data, keeping an existing vtkImageData in sync. */
+    void SetDataPointer(unsigned char *data);
+
     ImageDataItem::ConstPointer m_Parent;
 
+    itk::LightObject::ConstPointer m_MemoryHolder;
+
     unsigned int m_Dimension;
 
     unsigned int m_Dimensions[MAX_IMAGE_DIMENSIONS];
@@ -0,0 +1,70 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkImageFileRegionProvider_h
+#define mitkImageFileRegionProvider_h
+
+#include <mitkImage.h>
+#include <mitkImageRegionProvider.h>
+
+#include <itkImageIOBase.h>
+#include <itkSimpleFastMutexLock.h>
+
+namespace mitk
+{
+  /**
+    \brief Region provider that reads the requested sub-boxes directly from an image file.
+
+    ITK image IOs that support streamed reading (e.g. uncompressed NRRD, MetaImage or NIfTI)
+    only read the requested region from disk. For all other files the complete volume of the
+    requested time step is decoded and the region is extracted from it.
+
+    Use CreateImage() to get an mitk::Image with the geometry of the file that does not hold
+    any voxels in memory and is backed by this provider. Combine it with ImageRegionReadAccessor
+    to process images tile by tile that do not fit into memory.
+  */
+  class MITKCORE_EXPORT ImageFileRegionProvider : public ImageRegionProvider
+  {
+  public:
+    mitkClassMacro(ImageFileRegionProvider, ImageRegionProvider);
+    itkFactorylessNewMacro(Self);
+
+    /** \brief Sets the file and reads its header. Throws an mitk::Exception if the file cannot be read. */
+    void SetFileName(const std::string &fileName);
+    itkGetStringMacro(FileName);
+
+    /** \brief Returns true if only the requested regions are read from the file */
+    bool CanStreamRead() const;
+
+    /** \brief Creates an image without voxels in memory that uses this provider for its data */
+    Image::Pointer CreateImage();
+
+    void ReadRegion(const RegionType &region, unsigned int t, void *buffer) const override;
+
+  protected:
+    ImageFileRegionProvider();
+    ~ImageFileRegionProvider() override;
+
+  private:
+    std::string m_FileName;
+    itk::ImageIOBase::Pointer m_ImageIO;
+
+    /** ITK image IOs are not thread safe */
+    mutable itk::SimpleFastMutexLock m_ImageIOMutex;
+  };
+}
+
+#endif
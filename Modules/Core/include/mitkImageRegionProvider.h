@@ -0,0 +1,61 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkImageRegionProvider_h
+#define mitkImageRegionProvider_h
+
+#include <MitkCoreExports.h>
+#include <mitkCommon.h>
+
+#include <itkImageRegion.h>
+#include <itkObject.h>
+
+namespace mitk
+{
+  /**
+    \brief Interface for objects that deliver the voxels of an arbitrary sub-box of an image on request.
+
+    A region provider can be attached to an mitk::Image (see Image::SetRegionProvider()) to back
+    volumes that are not held in memory, e.g. because they live in a file or a compressed store.
+    ImageRegionReadAccessor uses the provider for all volumes that are not set in memory.
+
+    Implementations have to be thread safe.
+
+    \sa ImageFileRegionProvider, ImageRegionReadAccessor
+  */
+  class MITKCORE_EXPORT ImageRegionProvider : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(ImageRegionProvider, itk::Object);
+
+    typedef itk::ImageRegion<3> RegionType;
+
+    /**
+      \brief Copies the voxels of region at time step t into buffer.
+
+      The buffer is contiguous with x as the fastest running index and holds
+      region.GetNumberOfPixels() pixels of the image's pixel type.
+      \throws mitk::Exception if the region cannot be provided
+    */
+    virtual void ReadRegion(const RegionType &region, unsigned int t, void *buffer) const = 0;
+
+  protected:
+    ImageRegionProvider() {}
+    ~ImageRegionProvider() override {}
+  };
+}
+
+#endif
@@ -0,0 +1,139 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkImageRegionReadAccessor_h
+#define mitkImageRegionReadAccessor_h
+
+#include <mitkImage.h>
+#include <mitkImageRegionProvider.h>
+
+#include <itkImage.h>
+#include <itkImportImageContainer.h>
+
+#include <vector>
+
+namespace mitk
+{
+  /**
+   * @brief Read access to an arbitrary sub-box of one volume of an image.
+   *
+   * In contrast to ImageReadAccessor, which locks complete ImageDataItems, this accessor copies
+   * only the requested region into a contiguous buffer owned by the accessor. If the volume is
+   * not held in memory and the image has an ImageRegionProvider, the region is requested from the
+   * provider, so the complete volume is never materialized. Memory mapped images (see
+   * ItkImageIO::OPTION_MEMORY_MAPPED()) only page in the touched rows.
+   *
+   * Together with GenerateTiles() and GetItkImage() this allows running ITK code on images that
+   * do not fit into memory, tile by tile:
+   * \code
+   * for (const auto &tile : mitk::ImageRegionReadAccessor::GenerateTiles(image, tileSize))
+   * {
+   *   mitk::ImageRegionReadAccessor accessor(image, tile);
+   *   MyItkFunction(accessor.GetItkImage<short>().GetPointer());
+   * }
+   * \endcode
+   *
+   * @ingroup Data
+   */
+  class MITKCORE_EXPORT ImageRegionReadAccessor
+  {
+  public:
+    typedef ImageRegionProvider::RegionType RegionType;
+    typedef Image::ConstPointer ImageConstPointer;
+
+    /**
+     * \brief Reads region of time step t of the given image.
+     * \throws mitk::Exception if the region is not inside of the image or cannot be read
+     */
+    ImageRegionReadAccessor(const Image *image, const RegionType &region, unsigned int t = 0);
+
+    ~ImageRegionReadAccessor();
+
+    /** \brief Contiguous pixels of the region, x is the fastest running index */
+    const void *GetData() const { return m_Buffer.data(); }
+    size_t GetSize() const { return m_Buffer.size(); }
+
+    const RegionType &GetRegion() const { return m_Region; }
+    unsigned int GetTimeStep() const { return m_TimeStep; }
+
+    /** \brief Returns the largest possible region of a volume of image */
+    static RegionType GetLargestPossibleRegion(const Image *image);
+
+    /** \brief Splits the largest possible region of image into tiles of at most tileSize */
+    static std::vector<RegionType> GenerateTiles(const Image *image, const RegionType::SizeType &tileSize);
+
+    /**
+     * \brief Returns an itk::Image that references the region buffer.
+     *
+     * Buffered and largest possible region of the returned image are the accessed region, and
+     * origin, spacing and direction are those of the mitk::Image, so physical coordinates and
+     * indices match the complete image.
+     * \warning The returned image references memory of this accessor and must not be used after
+     * the accessor was destroyed.
+     * \throws mitk::Exception if TPixel does not match the pixel type of the image
+     */
+    template <typename TPixel>
+    typename itk::Image<TPixel, 3>::Pointer GetItkImage() const
+    {
+      typedef itk::Image<TPixel, 3> ItkImageType;
+
+      if (!(m_Image->GetPixelType() == MakePixelType<ItkImageType>()))
+      {
+        mitkThrow() << "Invalid ImageRegionReadAccessor: pixel types of image and requested itk::Image differ";
+      }
+
+      typename ItkImageType::Pointer itkImage = ItkImageType::New();
+      itkImage->SetRegions(m_Region);
+
+      const BaseGeometry *geometry = m_Image->GetGeometry(m_TimeStep);
+      typename ItkImageType::SpacingType spacing;
+      typename ItkImageType::PointType origin;
+      typename ItkImageType::DirectionType direction;
+      const auto &matrix = geometry->GetIndexToWorldTransform()->GetMatrix();
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        spacing[i] = geometry->GetSpacing()[i];
+        origin[i] = geometry->GetOrigin()[i];
+        for (unsigned int j = 0; j < 3; ++j)
+          direction[i][j] = matrix[i][j] / spacing[j];
+      }
+      itkImage->SetSpacing(spacing);
+      itkImage->SetOrigin(origin);
+      itkImage->SetDirection(direction);
+
+      typedef itk::ImportImageContainer<itk::SizeValueType, TPixel> ContainerType;
+      typename ContainerType::Pointer container = ContainerType::New();
+      container->SetImportPointer(
+        const_cast<TPixel *>(reinterpret_cast<const TPixel *>(m_Buffer.data())), m_Region.GetNumberOfPixels(), false);
+      itkImage->SetPixelContainer(container);
+
+      return itkImage;
+    }
+
+  private:
+    ImageRegionReadAccessor(const ImageRegionReadAccessor &) = delete;
+    ImageRegionReadAccessor &operator=(const ImageRegionReadAccessor &) = delete;
+
+    void CopyRegionFromVolume();
+
+    ImageConstPointer m_Image;
+    RegionType m_Region;
+    unsigned int m_TimeStep;
+    std::vector<char> m_Buffer;
+  };
+}
+
+#endif
@@ -81,12 +81,27 @@ namespace mitk
     itkSetMacro(Options, int);
     itkGetMacro(Options, int);
 
+    /** \brief Share the memory with the mitk::Image instead of locking it (default \a false).
+     *
+     * The output references the memory through a shared mitk::ImageDataItem (see
+     * ImageDataItem::ShareData()), so the mitk::Image is not locked and both images can be
+     * released in any order. Writes through one image are seen by the other until the
+     * mitk::Image is written, which copies its data first (copy-on-write). Falls back to
+     * locking if the memory cannot be shared. Ignored if CopyMemFlag is set.
+     */
+    itkSetMacro(ShareMemFlag, bool);
+    itkGetMacro(ShareMemFlag, bool);
+    itkBooleanMacro(ShareMemFlag);
+
   protected:
     using itk::ProcessObject::SetInput;
     mitk::Image *GetInput(void);
     const mitk::Image *GetInput() const;
 
-    ImageToItk() : m_CopyMemFlag(false), m_Channel(0), m_Options(mitk::ImageAccessorBase::DefaultBehavior) {}
+    ImageToItk()
+      : m_CopyMemFlag(false), m_ShareMemFlag(false), m_Channel(0), m_Options(mitk::ImageAccessorBase::DefaultBehavior)
+    {
+    }
     ~ImageToItk() override {}
     void PrintSelf(std::ostream &os, itk::Indent indent) const override;
 
@@ -96,6 +111,7 @@ namespace mitk
 
   private:
     bool m_CopyMemFlag;
+    bool m_ShareMemFlag;
     int m_Channel;
     int m_Options;
 
@@ -177,6 +193,37 @@ namespace mitk
     return imagetoitk->GetOutput();
   }
 
+  /**
+   * @brief Convert a MITK image to an ITK image that shares the image memory.
+   *
+   * Neither copies the data nor locks the MITK image. The returned itk::Image keeps the
+   * memory alive, so it may outlive the MITK image and vice versa. Writes to the itk::Image
+   * are visible in the MITK image until the MITK image is written itself, which first copies
+   * its data (copy-on-write). If the memory cannot be shared, e.g. because the MITK image
+   * only references external memory, the MITK image is locked like by
+   * ImageToItkImage(const mitk::Image*).
+   *
+   * @throws mitk::Exception if the pixel type or dimension does not match the MITK image type.
+   *
+   * @sa ShareItkImageMemory
+   *
+   * @ingroup Adaptor
+   */
+  template <typename TPixel, unsigned int VDimension>
+  typename ImageTypeTrait<TPixel, VDimension>::ImageType::Pointer ShareMitkImageMemory(const mitk::Image *mitkImage)
+  {
+    typedef typename ImageTypeTrait<TPixel, VDimension>::ImageType ImageType;
+    typedef mitk::ImageToItk<ImageType> ImageToItkType;
+    itk::SmartPointer<ImageToItkType> imagetoitk = ImageToItkType::New();
+    imagetoitk->SetInput(mitkImage);
+    imagetoitk->ShareMemFlagOn();
+    imagetoitk->Update();
+
+    typename ImageType::Pointer itkImage = imagetoitk->GetOutput();
+    itkImage->DisconnectPipeline();
+    return itkImage;
+  }
+
 } // end namespace mitk
 
 #ifndef ITK_MANUAL_INSTANTIATION
@@ -152,8 +152,23 @@ void mitk::ImageToItk<TOutputImage>::GenerateData()
     import->Initialize();
 
     itkDebugMacro(<< "size of container = " << import->Size());
-    // import->SetImageDataItem(m_ImageDataItem);
-    import->SetImageAccessor(imageAccess.release(), sizeof(InternalPixelType) * noBytes);
+
+    // sharing the channel keeps the memory alive without holding the accessor's lock
+    mitk::ImageDataItem::Pointer sharedItem;
+    if (m_ShareMemFlag && input->IsChannelSet(0))
+    {
+      sharedItem = input->GetChannelData(0)->ShareData();
+    }
+
+    if (sharedItem.IsNotNull())
+    {
+      import->SetImageDataItem(sharedItem, imageAccess->GetData(), sizeof(InternalPixelType) * noBytes);
+      imageAccess.reset();
+    }
+    else
+    {
+      import->SetImageAccessor(imageAccess.release(), sizeof(InternalPixelType) * noBytes);
+    }
 
     output->SetPixelContainer(import);
     itkDebugMacro(<< "size of container = " << import->Size());
@@ -34,7 +34,9 @@ namespace mitk
   /**
   * @brief Converts pixel data to surface data by using a threshold
   * The mitkImageToSurfaceFilter is used to create a new surface out of an mitk image. The filter
-  * uses a threshold to define the surface. It is based on the vtkMarchingCube algorithm. By default
+  * uses a threshold to define the surface. It is based on the vtkFlyingEdges3D algorithm, a faster equivalent
+  * of marching cubes. The extraction is restricted to the bounding box of all voxels at or above the threshold,
+  * which is split into slabs that are processed by up to GetNumberOfThreads() threads. By default
   * a vtkPolyData surface based on an input threshold for the input image will be created. Optional
   * it is possible to reduce the number of triangles/polygones [SetDecimate(mitk::ImageToSurfaceFilter::DecimatePro) and
   * SetTargetReduction (float _arg)]
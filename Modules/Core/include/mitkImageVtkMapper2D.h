@@ -29,6 +29,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkPropAssembly.h>
 #include <vtkSmartPointer.h>
 
+#include <future>
+#include <list>
+#include <memory>
+
 class vtkActor;
 class vtkPolyDataMapper;
 class vtkPlaneSource;
@@ -42,9 +46,13 @@ class vtkMitkThickSlicesFilter;
 class vtkPolyData;
 class vtkMitkApplyLevelWindowToRGBFilter;
 class vtkMitkLevelWindowFilter;
+class vtkMitkGPUResliceMapper;
+class vtkMatrix4x4;
 
 namespace mitk
 {
+  class ImageReadAccessor;
+
   /** \brief Mapper to resample and display 2D slices of a 3D image.
    *
    * The following image gives a brief overview of the mapping and the involved parts.
@@ -92,6 +100,14 @@ namespace mitk
    *   - \b "texture interpolation": (BoolProperty) texture interpolation of the image
    *   - \b "reslice interpolation": (VtkResliceInterpolationProperty) reslice interpolation of the image
    *   - \b "in plane resample extent by geometry": (BoolProperty) Do it or not
+   *   - \b "Image Rendering.GPU Reslicing": (BoolProperty) Sample the volume as 3D texture on the GPU instead
+            of reslicing it on the CPU. Only used for single component, non-binary images on plane geometries
+            that are rendered with a lookup table.
+   *   - \b "Image Rendering.Accelerated Reslicing": (BoolProperty) Let ExtractSliceFilter sample the slice with the
+            registered IImageProcessingAccelerator service (e.g. OpenCL) if GPU reslicing is not used.
+   *   - \b "Image Rendering.Prefetch Time Steps": (IntProperty) Number of upcoming time steps whose slices are
+            resliced on worker threads while the current one is shown, for smooth playback of time series.
+            Only used for CPU reslicing of plane geometries without thick slices.
    *   - \b "bounding box": (BoolProperty) Is the Bounding Box of the image shown or not
    *   - \b "layer": (IntProperty) Layer of the image
    *   - \b "volume annotation color": (ColorProperty) color of the volume annotation, TODO has to be reimplemented
@@ -107,6 +123,9 @@ namespace mitk
    *   - \b "texture interpolation", mitk::BoolProperty::New( false ) )
    *   - \b "reslice interpolation", mitk::VtkResliceInterpolationProperty::New() )
    *   - \b "in plane resample extent by geometry", mitk::BoolProperty::New( false ) )
+   *   - \b "Image Rendering.GPU Reslicing", mitk::BoolProperty::New( false ) )
+   *   - \b "Image Rendering.Accelerated Reslicing", mitk::BoolProperty::New( false ) )
+   *   - \b "Image Rendering.Prefetch Time Steps", mitk::IntProperty::New( 0 ) )
    *   - \b "bounding box", mitk::BoolProperty::New( false ) )
    *   - \b "layer", mitk::IntProperty::New(10), renderer, overwrite)
    *   - \b "Image Rendering.Transfer Function":  Default color transfer function for CTs
@@ -190,6 +209,66 @@ namespace mitk
       /** \brief This filter is used to apply the level window to Grayvalue and RBG(A) images. */
       vtkSmartPointer<vtkMitkLevelWindowFilter> m_LevelWindowFilter;
 
+      /** \brief A resliced image together with the parameters it was resliced with. */
+      struct SliceCacheEntry
+      {
+        /** \brief True if the other entry was resliced from the same image with the same parameters. */
+        bool HasSameReslicing(const SliceCacheEntry &other) const;
+
+        unsigned long ImageMTime;
+        const BaseGeometry *ImageGeometry;
+        unsigned long ImageGeometryMTime;
+        const BaseGeometry *ReferenceGeometry;
+        unsigned long ReferenceGeometryMTime;
+        AffineTransform3D::MatrixType PlaneMatrix;
+        AffineTransform3D::OutputVectorType PlaneOffset;
+        BoundingBox::BoundsArrayType PlaneBounds;
+        int TimeStep;
+        int InterpolationMode;
+        bool InPlaneResampleExtentByGeometry;
+        int ThickSlicesMode;
+        int ThickSlicesNum;
+
+        vtkSmartPointer<vtkImageData> ReslicedImage;
+        double ClippedPlaneBounds[6];
+        mitk::ScalarType Spacing[3];
+        vtkSmartPointer<vtkMatrix4x4> ResliceAxes;
+      };
+
+      /** \brief Recently resliced images, most recently used first. Scrolling back to
+        * one of these slices does not need to reslice the image again. */
+      std::list<SliceCacheEntry> m_SliceCache;
+
+      /** \brief Maximum number of entries in m_SliceCache, 0 disables the cache. */
+      unsigned int m_SliceCacheSize;
+
+      /** \brief Slice of an upcoming time step that is resliced on a worker thread. */
+      struct PrefetchJob
+      {
+        /** \brief Reslicing parameters and geometry of the slice, ReslicedImage is set once it is done. */
+        SliceCacheEntry Slice;
+        ExtractSliceFilter::Pointer Reslicer;
+        /** \brief Keeps the volume of the time step from being changed or released while it is resliced. */
+        std::shared_ptr<ImageReadAccessor> VolumeAccessor;
+        /** \brief Declared last, so that it waits for the worker before the members above are destroyed. */
+        std::future<void> Done;
+      };
+
+      /** \brief Prefetched slices that are not yet moved to m_SliceCache. */
+      std::list<PrefetchJob> m_PrefetchJobs;
+
+      /** \brief Reslice axes of the current slice, used to transform the actor. */
+      vtkSmartPointer<vtkMatrix4x4> m_ResliceAxes;
+
+      /** \brief Spacing of the current slice, m_mmPerPixel points to it. */
+      mitk::ScalarType m_SliceSpacing[3];
+
+      /** \brief Mapper sampling the volume on the GPU, replaces m_Mapper in GPU reslicing mode. */
+      vtkSmartPointer<vtkMitkGPUResliceMapper> m_GPUResliceMapper;
+
+      /** \brief Modification time of the image that was last passed to m_GPUResliceMapper. */
+      unsigned long m_GPUVolumeMTime;
+
       /** \brief Default constructor of the local storage. */
       LocalStorage();
       /** \brief Default deconstructor of the local storage. */
@@ -259,6 +338,29 @@ namespace mitk
       */
     void GenerateDataForRenderer(mitk::BaseRenderer *renderer) override;
 
+    /** \brief Checks the "Image Rendering.GPU Reslicing" property and whether the image and the
+      * current world geometry can be rendered by the GPU reslice mapper. */
+    bool UseGPUReslicing(mitk::BaseRenderer *renderer);
+
+    /** \brief Counterpart of GenerateDataForRenderer for the GPU reslicing mode.
+      * Only the geometry of the slice is computed on the CPU, the volume is kept on the
+      * GPU and sampled there by vtkMitkGPUResliceMapper.
+      */
+    void GenerateGPUSliceForRenderer(mitk::BaseRenderer *renderer,
+                                     bool interpolate,
+                                     int thickSlicesMode,
+                                     int thickSlicesNum);
+
+    /** \brief Moves the finished prefetched slices into the slice cache and drops the outdated ones.
+      * Waits for the prefetch of the requested slice if it is still running. */
+    void CollectPrefetchedSlices(LocalStorage *localStorage, const LocalStorage::SliceCacheEntry &requestedSlice);
+
+    /** \brief Starts reslicing the slices of the "Image Rendering.Prefetch Time Steps" time steps following
+      * the current one on worker threads, unless they are cached or being resliced already. */
+    void PrefetchTimeSteps(mitk::BaseRenderer *renderer,
+                           LocalStorage *localStorage,
+                           const LocalStorage::SliceCacheEntry &currentSlice);
+
     /** \brief This method uses the vtkCamera clipping range and the layer property
       * to calcualte the depth of the object (e.g. image or contour). The depth is used
       * to keep the correct order for the final VTK rendering.*/
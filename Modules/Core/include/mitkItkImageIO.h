@@ -30,6 +30,12 @@ namespace mitk
    * Instantiating this class with a given itk::ImageIOBase instance
    * will register corresponding MITK reader/writer services for that
    * ITK ImageIO object.
+   *
+   * The reader option OPTION_MEMORY_MAPPED() enables lazy loading: uncompressed
+   * scalar NRRD (.nrrd), MetaImage (.mha) and NIfTI (.nii) files in native byte
+   * order are memory mapped instead of read. Voxels are then paged in by the
+   * operating system on first access, e.g. through an ImageReadAccessor, and the
+   * mapping lives as long as the image data. All other files are read as usual.
    */
   class MITKCORE_EXPORT ItkImageIO : public AbstractFileIO
   {
@@ -37,6 +43,8 @@ namespace mitk
     ItkImageIO(itk::ImageIOBase::Pointer imageIO);
     ItkImageIO(const CustomMimeType &mimeType, itk::ImageIOBase::Pointer imageIO, int rank);
 
+    static std::string OPTION_MEMORY_MAPPED();
+
     // -------------- AbstractFileReader -------------
 
     using AbstractFileReader::Read;
@@ -56,6 +64,13 @@ namespace mitk
     // Fills the m_DefaultMetaDataKeys vector with default values
     virtual void InitializeDefaultMetaDataKeys();
 
+    /**
+     * Returns the offset of the raw voxel data inside of the file that is currently
+     * set at the ImageIO, if the data is stored uncompressed in exactly the
+     * layout mitk::Image expects. Returns false otherwise.
+     */
+    virtual bool GetUncompressedDataOffset(size_t fileSize, size_t &offset) const;
+
   private:
     ItkImageIO(const ItkImageIO &other);
 
@@ -100,6 +100,16 @@ namespace mitk
       */
     void DataStorageRemovedNode(const DataNode *removedNode = nullptr);
 
+    /** @brief This method is called once at the end of a batch update of the data storage with all added nodes.
+      *        The per-node notifications are ignored during batch updates.
+      */
+    void DataStorageAddedNodes(const DataStorage::SetOfObjects *nodes);
+
+    /** @brief This method is called once at the end of a batch update of the data storage with all removed nodes,
+      *        which are no longer in the data storage.
+      */
+    void DataStorageRemovedNodes(const DataStorage::SetOfObjects *nodes);
+
     /** @brief change notifications from mitkLevelWindowProperty */
     void OnPropertyModified(const itk::EventObject &e);
 
@@ -103,6 +103,21 @@ namespace mitk
     //## @param limit the maximum number of items on the stack
     void SetUndoLimit(std::size_t limit) override;
 
+    //##Documentation
+    //## @brief Gets the limit on the memory of undo and redo stack in bytes (0 = no limit).
+    std::size_t GetMemoryLimit() const override;
+
+    //##Documentation
+    //## @brief Sets a limit on the memory of undo and redo stack in bytes.
+    //## If the limit is exceeded, the oldest undo items will be dropped from the
+    //## bottom of the undo stack until the limit is met, but the most recent
+    //## undo item is always kept. The 0 value means that there is no limit.
+    void SetMemoryLimit(std::size_t limit) override;
+
+    //##Documentation
+    //## @brief Returns the approximate memory in bytes held by undo and redo stack
+    std::size_t GetMemorySize() const override;
+
     //##Documentation
     //## @brief Returns the ObjectEventId of the
     //## top element in the OperationHistory
@@ -131,6 +146,9 @@ namespace mitk
     //## elements in the list and to clear the list
     void ClearList(UndoContainer *list);
 
+    //## @brief Drops the oldest undo items until count and memory limit are met
+    void EnforceLimits();
+
     UndoContainer m_UndoList;
 
     UndoContainer m_RedoList;
@@ -139,6 +157,7 @@ namespace mitk
     int FirstObjectEventIdOfCurrentGroup(UndoContainer &stack);
 
     std::size_t m_UndoLimit;
+    std::size_t m_MemoryLimit;
 
   };
 
@@ -95,9 +95,50 @@ namespace mitk
      */
     static void CatchLogFileCommandLineParameter(int &argc, char **argv);
 
+    /** @brief Switches between synchronous and asynchronous output.
+     *         In asynchronous mode the logging thread only copies the message into a lock-free
+     *         queue. A dedicated writer thread drains the queue, formats the messages and writes
+     *         them to the console, the log file and the output window. Fatal messages
+     *         are always written synchronously, together with everything queued before them.
+     *         Pending messages are flushed when switching back, on Unregister() and at exit.
+     *         Coloured console output on Windows is only available in synchronous mode.
+     */
+    static void SetAsynchronous(bool async);
+
+    static bool IsAsynchronous();
+
+    /** @brief Synchronously writes all pending messages of the asynchronous mode and flushes
+     *         the console and the log file. Does nothing harmful in synchronous mode.
+     */
+    static void Flush();
+
+    /** @brief Limits the number of info, warning and debug messages that a single logging
+     *         site (file and line) may emit per second. Messages exceeding the limit are
+     *         dropped and summarized once the next message of that site passes again.
+     *         Errors and fatal messages are never dropped.
+     *  @param messagesPerSecond Maximum number of messages per site and second, 0 (default) disables the limit.
+     */
+    static void SetMessageRateLimit(unsigned int messagesPerSecond);
+
+    static unsigned int GetMessageRateLimit();
+
+    /** @return Returns the total number of messages dropped by the rate limit since startup.
+     */
+    static unsigned long long GetNumberOfSuppressedMessages();
+
     mbilog::OutputType GetOutputType() const override;
 
   protected:
+    /** \brief Writes a single message to the console, the log file and the output window.
+     *         The caller has to hold the log mutex.
+     */
+    void WriteMessage(const mbilog::LogMessage &l, int threadID, bool colouredConsole);
+
+    /** \brief Writes all messages queued in asynchronous mode in their original order.
+     *         The caller has to hold the log mutex.
+     */
+    void WriteQueuedMessages();
+
     /** Checks if a file exists.
      *  @return Returns true if the file exists, false if not.
      */
@@ -0,0 +1,77 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkMemoryMappedFile_h
+#define mitkMemoryMappedFile_h
+
+#include <MitkCoreExports.h>
+#include <mitkCommon.h>
+
+#include <itkLightObject.h>
+
+#include <string>
+
+namespace mitk
+{
+  /**
+    \brief Read-only, copy-on-write memory mapping of a complete file.
+
+    The file content is not read on Open(). The operating system pages the
+    mapped data in on first access, so only the parts of a file that are
+    actually touched occupy memory. Writing to the mapped memory is allowed
+    but never changes the file (private mapping).
+
+    The mapping is released on Close() or when the object is destroyed.
+    Instances can be attached to an mitk::ImageDataItem via
+    ImageDataItem::SetMemoryHolder() to keep the mapping alive as long as an
+    image references it.
+  */
+  class MITKCORE_EXPORT MemoryMappedFile : public itk::LightObject
+  {
+  public:
+    mitkClassMacroItkParent(MemoryMappedFile, itk::LightObject);
+    itkFactorylessNewMacro(Self);
+
+    /** \brief Maps the given file. Throws an mitk::Exception on failure. */
+    void Open(const std::string &path);
+    void Close();
+
+    bool IsOpen() const { return m_Data != nullptr; }
+
+    void *GetData() const { return m_Data; }
+    size_t GetSize() const { return m_Size; }
+    const std::string &GetFileName() const { return m_FileName; }
+
+    /** \brief If set, the file is deleted after the mapping is released (e.g. for swap files). */
+    void SetRemoveFileOnClose(bool remove) { m_RemoveFileOnClose = remove; }
+    bool GetRemoveFileOnClose() const { return m_RemoveFileOnClose; }
+
+  protected:
+    MemoryMappedFile();
+    ~MemoryMappedFile() override;
+
+  private:
+    MemoryMappedFile(const MemoryMappedFile &) = delete;
+    MemoryMappedFile &operator=(const MemoryMappedFile &) = delete;
+
+    void *m_Data;
+    size_t m_Size;
+    std::string m_FileName;
+    bool m_RemoveFileOnClose;
+  };
+}
+
+#endif
@@ -0,0 +1,60 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#ifndef MITKMODULEACTIVATIONPROFILE_H
+#define MITKMODULEACTIVATIONPROFILE_H
+
+#include <MitkCoreExports.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace mitk
+{
+  /**
+   * @brief Startup profile listing how long the activator of each loaded module took.
+   *
+   * The times are recorded by CppMicroServices in the module.activation_time property.
+   * Modules with "module.activation_policy": "lazy" in their manifest.json are listed as
+   * pending until one of the services named in "module.lazy_services" is looked up for
+   * the first time.
+   *
+   * Setting the environment variable MITK_PRINT_MODULE_ACTIVATION_PROFILE makes the
+   * org.mitk.core.services plug-in log this report on startup.
+   */
+  class MITKCORE_EXPORT ModuleActivationProfile
+  {
+  public:
+    struct Entry
+    {
+      std::string ModuleName;
+      bool Lazy;
+      bool Pending;
+      /** @brief Duration of ModuleActivator::Load() in milliseconds, 0 if pending */
+      double ActivationTime;
+    };
+
+    /** @brief Returns one entry per loaded module, the slowest activation first. */
+    static std::vector<Entry> GetEntries();
+
+    /** @brief Prints the entries as a table followed by the total activation time. */
+    static void Print(std::ostream &os);
+  };
+}
+
+#endif
@@ -44,6 +44,10 @@ namespace mitk
     //## @brief Checks, if the nodes data object is of a specific data type
     bool CheckNode(const mitk::DataNode *node) const override;
 
+    //##Documentation
+    //## @brief Returns the class name of the data that is checked for
+    const std::string &GetValidDataType() const { return m_ValidDataType; }
+
   protected:
     //##Documentation
     //## @brief Protected constructor, use static instantiation functions instead
@@ -45,6 +45,12 @@ namespace mitk
     //## @brief Checks, if m_BaseNode is a source node of childNode  (e.g. if childNode "was created from" m_BaseNode)
     bool CheckNode(const mitk::DataNode *childNode) const override;
 
+    //##Documentation
+    //## @brief Accessors for the query parameters, used e.g. by DataStorage implementations to answer queries from an index
+    mitk::DataNode::Pointer GetBaseNode() const { return m_BaseNode.Lock(); }
+    bool GetSearchAllSources() const { return m_SearchAllSources; }
+    mitk::DataStorage::Pointer GetDataStorage() const { return m_DataStorage.Lock(); }
+
   protected:
     //##Documentation
     //## @brief Constructor - This class can either search only for direct source objects or for all source objects
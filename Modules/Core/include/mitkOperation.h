@@ -43,6 +43,12 @@ namespace mitk
 
     OperationType GetOperationType();
 
+    //##Documentation
+    //## @brief Approximate number of bytes held by this operation.
+    //## Used by undo models to limit the memory of the undo history;
+    //## operations that store large data (e.g. images) should override it.
+    virtual std::size_t GetMemorySize() const;
+
   protected:
     OperationType m_OperationType;
   };
@@ -31,8 +31,13 @@ class vtkPolyData;
 class vtkPolyDataMapper;
 class vtkGlyphSource2D;
 class vtkGlyph3D;
+class vtkGlyph3DMapper;
 class vtkFloatArray;
 class vtkCellArray;
+class vtkLookupTable;
+class vtkTransform;
+class vtkTransformFilter;
+class vtkUnsignedCharArray;
 
 namespace mitk
 {
@@ -93,6 +98,8 @@ namespace mitk
   * "Circle",
   *       8 = "Diamond", 9 = "Arrow", 10 = "ThickArrow", 11 = "HookedArrow", 12 = "Cross"
   *   - \b "PointSet.2D.fill shape": (BoolProperty false)     // fill or do not fill the glyph shape
+  *   - \b "Pointset.instanced rendering": (BoolProperty false) // render the glyphs of all points with a single
+  * instanced glyph mapper, meant for large point sets
   *   - \b "Pointset.2D.distance to plane": (FloatProperty 4.0) //In the 2D render window, points are rendered which lie
   * within a certain distance
   *                                                             to the current plane. They are projected on the current
@@ -188,6 +195,18 @@ namespace mitk
 
       // propassembly
       vtkSmartPointer<vtkPropAssembly> m_PropAssembly;
+
+      // instanced rendering ("Pointset.instanced rendering"): the unselected and selected points
+      // in one polydata, the selection state chooses the glyph and its color
+      vtkSmartPointer<vtkPolyData> m_InstancePolyData;
+      vtkSmartPointer<vtkUnsignedCharArray> m_InstanceSelection;
+      vtkSmartPointer<vtkFloatArray> m_InstanceScales;
+      vtkSmartPointer<vtkTransform> m_InstanceGlyphTransform;
+      vtkSmartPointer<vtkTransformFilter> m_InstanceUnselectedGlyphTransformFilter;
+      vtkSmartPointer<vtkTransformFilter> m_InstanceSelectedGlyphTransformFilter;
+      vtkSmartPointer<vtkGlyph3DMapper> m_InstanceMapper;
+      vtkSmartPointer<vtkLookupTable> m_InstanceLookupTable;
+      vtkSmartPointer<vtkActor> m_InstanceActor;
     };
 
     /** \brief The LocalStorageHandler holds all (three) LocalStorages for the three 2D render windows. */
@@ -219,6 +238,11 @@ namespace mitk
    * PlaneGeometry is applied to the orienation of the glyphs. */
     virtual void CreateVTKRenderObjects(mitk::BaseRenderer *renderer);
 
+    /* \brief Copies the unselected and selected points of the local storage into the instance arrays.
+   * Only entries which changed are written, the arrays are not marked as modified (and thus not uploaded
+   * again) if nothing changed. */
+    virtual void UpdateInstancedPoints(LocalStorage *ls);
+
     // member variables holding the current value of the properties used in this mapper
     bool m_ShowContour;           // "show contour" property
     bool m_CloseContour;          // "close contour" property
@@ -233,6 +257,7 @@ namespace mitk
     int m_IDShapeProperty;        // ID for mitkPointSetShape Enumeration Property "Pointset.2D.shape"
     bool m_FillShape;             // "Pointset.2D.fill shape" property
     float m_DistanceToPlane;      // "Pointset.2D.distance to plane" property
+    bool m_UseInstancedRendering; // "Pointset.instanced rendering" property
   };
 
 } // namespace mitk
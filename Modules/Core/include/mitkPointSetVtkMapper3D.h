@@ -26,10 +26,13 @@ class vtkActor;
 class vtkCellArray;
 class vtkPropAssembly;
 class vtkAppendPolyData;
+class vtkGlyph3DMapper;
+class vtkLookupTable;
 class vtkPolyData;
 class vtkTubeFilter;
 class vtkPolyDataMapper;
 class vtkTransformPolyDataFilter;
+class vtkUnsignedCharArray;
 
 namespace mitk
 {
@@ -62,6 +65,8 @@ namespace mitk
   *   - \b "Opacity": (FloatProperty) Opacity of the point set
   *   - \b "show contour": (BoolProperty) If the contour of the points are visible
   *   - \b "contourSizeProp":(FloatProperty) Contour size of the points
+  *   - \b "Pointset.instanced rendering": (BoolProperty) Render all points with a single instanced glyph mapper
+  *       instead of one glyph source per point, meant for large point sets. Labels are not rendered in this mode.
 
 
   The default properties are:
@@ -76,6 +81,7 @@ namespace mitk
   *   - \b "close contour": (BoolProperty::New(false), renderer, overwrite )
   *   - \b "show points": (BoolProperty::New(true), renderer, overwrite )
   *   - \b "updateDataOnRender": (BoolProperty::New(true), renderer, overwrite )
+  *   - \b "Pointset.instanced rendering": (BoolProperty::New(false), renderer, overwrite )
 
 
 
@@ -127,6 +133,14 @@ namespace mitk
     virtual void CreateContour(vtkPoints *points, vtkCellArray *connections);
     virtual void CreateVTKRenderObjects();
 
+    /**
+    * \brief Updates the instance arrays of the instanced glyph mapper from m_WorldPositions.
+    *
+    * Only entries of points which moved or changed their selection state or type are rewritten,
+    * the arrays are not marked as modified (and thus not uploaded again) if nothing changed.
+    */
+    virtual void UpdateInstancedPoints();
+
     /// All point positions, already in world coordinates
     vtkSmartPointer<vtkPoints> m_WorldPositions;
     /// All connections between two points (used for contour drawing)
@@ -152,6 +166,17 @@ namespace mitk
     // help for contour between points
     vtkSmartPointer<vtkAppendPolyData> m_vtkTextList;
 
+    /// instanced rendering of the points, see property "Pointset.instanced rendering"
+    bool m_UseInstancedRendering;
+    vtkSmartPointer<vtkPolyData> m_InstancePolyData;
+    /// 1 for selected points, mapped to the selected color by m_InstanceLookupTable
+    vtkSmartPointer<vtkUnsignedCharArray> m_InstanceSelection;
+    /// index of the glyph source of a point, depends on the point type
+    vtkSmartPointer<vtkUnsignedCharArray> m_InstanceGlyphIndices;
+    vtkSmartPointer<vtkGlyph3DMapper> m_InstanceMapper;
+    vtkSmartPointer<vtkLookupTable> m_InstanceLookupTable;
+    vtkSmartPointer<vtkActor> m_InstanceActor;
+
     // variables to be able to log, how many inputs have been added to PolyDatas
     unsigned int m_NumberOfSelectedAdded;
     unsigned int m_NumberOfUnselectedAdded;
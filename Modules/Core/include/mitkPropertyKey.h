@@ -0,0 +1,118 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#ifndef mitkPropertyKey_h
+#define mitkPropertyKey_h
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <MitkCoreExports.h>
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif
+
+namespace mitk
+{
+  class BaseProperty;
+
+  /** @brief Interned property key.
+   *
+   * A PropertyKey is created once for a property name (typically as a static
+   * object next to the code that queries the property over and over again) and
+   * carries the hash of the name and a pointer to a process wide copy of it.
+   * Looking up a property by a PropertyKey therefore neither allocates a
+   * std::string nor rehashes the name. Two keys of the same name always refer
+   * to the same interned string.
+   *
+   * @code
+   * static const mitk::PropertyKey visibleKey("visible");
+   * mitk::BaseProperty *visible = propertyList->GetProperty(visibleKey);
+   * @endcode
+   *
+   * @ingroup DataManagement
+   */
+  class MITKCORE_EXPORT PropertyKey
+  {
+  public:
+    explicit PropertyKey(const std::string &name);
+    explicit PropertyKey(const char *name);
+
+    const std::string &GetName() const { return *m_Name; }
+    std::size_t GetHash() const { return m_Hash; }
+
+    bool operator==(const PropertyKey &other) const { return m_Name == other.m_Name; }
+    bool operator!=(const PropertyKey &other) const { return m_Name != other.m_Name; }
+    bool operator<(const PropertyKey &other) const { return *m_Name < *other.m_Name; }
+
+    /** @brief Hash function used for all property names (FNV-1a). */
+    static std::size_t Hash(const char *name, std::size_t length);
+
+  private:
+    void Intern(const char *name, std::size_t length);
+
+    const std::string *m_Name;
+    std::size_t m_Hash;
+  };
+
+  /** @brief Flat open addressing index of the properties of a PropertyList.
+   *
+   * The index does not own anything: it stores the name hash, a pointer to the
+   * key of the owning map node (std::map keys never move) and the raw property
+   * pointer. It is kept in sync with the map by PropertyList, which remains the
+   * authoritative (and ordered) storage used for iteration.
+   */
+  class MITKCORE_EXPORT PropertyKeyIndex
+  {
+  public:
+    PropertyKeyIndex();
+
+    BaseProperty *Find(const PropertyKey &key) const;
+    BaseProperty *Find(const char *name, std::size_t length) const;
+    BaseProperty *Find(const std::string &name) const { return this->Find(name.c_str(), name.size()); }
+
+    /** @brief Adds or updates the entry for @a name. @a name must outlive the entry. */
+    void Insert(const std::string *name, BaseProperty *property);
+    void Erase(const std::string &name);
+    void Clear();
+
+    std::size_t GetSize() const { return m_Size; }
+
+  private:
+    struct Entry
+    {
+      std::size_t hash;
+      const std::string *name;
+      BaseProperty *property;
+    };
+
+    std::size_t FindSlot(const char *name, std::size_t length, std::size_t hash) const;
+    void Rehash(std::size_t capacity);
+
+    std::vector<Entry> m_Entries;
+    std::size_t m_Size;
+  };
+}
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#endif
@@ -21,6 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkGenericProperty.h"
 #include "mitkUIDGenerator.h"
 #include "mitkIPropertyOwner.h"
+#include "mitkPropertyKey.h"
 #include <MitkCoreExports.h>
 
 #include <itkObjectFactory.h>
@@ -97,6 +98,17 @@ namespace mitk
      */
     mitk::BaseProperty *GetProperty(const std::string &propertyKey) const;
 
+    /**
+     * @brief Get a property by its name without creating a temporary std::string.
+     */
+    mitk::BaseProperty *GetProperty(const char *propertyKey) const;
+
+    /**
+     * @brief Get a property by an interned key. This is the fastest way to query
+     * properties that are looked up repeatedly, e.g. during rendering.
+     */
+    mitk::BaseProperty *GetProperty(const PropertyKey &propertyKey) const;
+
     /**
      * @brief Set a property object in the list/map by reference.
      *
@@ -249,6 +261,12 @@ namespace mitk
     PropertyMap m_Properties;
 
   private:
+    /**
+     * @brief Hash index into m_Properties, used to answer GetProperty() without
+     * walking the tree. It is updated by every method that modifies the map.
+     */
+    PropertyKeyIndex m_PropertyIndex;
+
     itk::LightObject::Pointer InternalClone() const override;
   };
 
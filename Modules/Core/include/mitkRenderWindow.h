@@ -29,6 +29,12 @@ namespace mitk
    * \brief mitkRenderWindow integrates the MITK rendering mechanism into VTK and
    * is NOT QT dependent
    *
+   * A render window created by NewOffscreen() renders into an offscreen buffer and never opens a
+   * window. Together with a VTK built for EGL or OSMesa (VTK_OPENGL_HAS_EGL / VTK_OPENGL_HAS_OSMESA)
+   * this does not need an X server, e.g. for batch screenshots on compute nodes. Every offscreen
+   * render window has its own OpenGL context.
+   *
+   * \sa RenderWindowFrameReader
    *
    * \ingroup Renderer
    */
@@ -42,8 +48,22 @@ namespace mitk
     mitkNewMacro4Param(
       Self, vtkRenderWindow *, const char *, mitk::RenderingManager *, mitk::BaseRenderer::RenderingMode::Type);
 
+    /**
+    * \brief Creates a render window which renders offscreen.
+    *
+    * The window uses a vtkGenericRenderWindowInteractor, which does not need a display connection.
+    */
+    static Pointer NewOffscreen(int width,
+                                int height,
+                                const char *name = "unnamed renderer",
+                                mitk::RenderingManager *rm = nullptr,
+                                mitk::BaseRenderer::RenderingMode::Type rmtype = mitk::BaseRenderer::RenderingMode::Standard);
+
     ~RenderWindow() override;
 
+    /** \brief True if the vtkRenderWindow renders into an offscreen buffer. */
+    bool IsOffscreen();
+
     vtkRenderWindow *GetVtkRenderWindow() override;
     vtkRenderWindowInteractor *GetVtkRenderWindowInteractor() override;
 
@@ -0,0 +1,105 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkRenderWindowFrameReader_h
+#define mitkRenderWindowFrameReader_h
+
+#include <MitkCoreExports.h>
+
+#include <itkObject.h>
+#include <mitkCommon.h>
+
+#include <functional>
+#include <memory>
+
+class vtkRenderWindow;
+
+namespace mitk
+{
+  /**
+   * \brief Reads the pixels of a render window asynchronously through OpenGL pixel buffer objects.
+   *
+   * ReadPixels() only starts the transfer of the current frame buffer into a pixel buffer and
+   * returns, so the next frame can be rendered while the previous one is still copied. The callback
+   * of a frame is called once its transfer is complete: when a later ReadPixels() finds it
+   * finished, when all NumberOfBuffers buffers are in use, or on Flush(). Callbacks are called in
+   * the order of the ReadPixels() calls, the pixels are passed bottom row first and are only valid
+   * during the call. The callbacks must not render.
+   *
+   * The pixel buffers belong to the OpenGL context of the render window, use one reader per
+   * window. Pending frames are completed when the reader is deleted. If the context does not
+   * support pixel buffer objects and fences, the pixels are read synchronously.
+   *
+   * \ingroup Renderer
+   */
+  class MITKCORE_EXPORT RenderWindowFrameReader : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(RenderWindowFrameReader, itk::Object);
+    itkFactorylessNewMacro(Self);
+
+    enum PixelFormat
+    {
+      RGB,
+      BGR,
+      RGBA
+    };
+
+    typedef std::function<void(const unsigned char *pixels, int width, int height)> FrameCallback;
+
+    /** \brief The window to read from, pending frames of the previous window are completed first. */
+    void SetRenderWindow(vtkRenderWindow *renderWindow);
+    vtkRenderWindow *GetRenderWindow() const;
+
+    /** \brief Format of the pixels passed to the callbacks, default is RGB. */
+    itkSetMacro(PixelFormat, PixelFormat);
+    itkGetConstMacro(PixelFormat, PixelFormat);
+
+    /** \brief Maximum number of frames in flight, at least one. Default is 3. */
+    void SetNumberOfBuffers(unsigned int numberOfBuffers);
+    itkGetConstMacro(NumberOfBuffers, unsigned int);
+
+    /** \brief Starts reading the given region of the frame buffer. Throws if no render window is set. */
+    void ReadPixels(int x, int y, int width, int height, const FrameCallback &callback);
+
+    /** \brief Starts reading the whole frame buffer. */
+    void ReadPixels(const FrameCallback &callback);
+
+    /** \brief Waits for all pending frames and calls their callbacks. */
+    void Flush();
+
+    /** \brief Drops all pending frames without calling their callbacks. */
+    void Discard();
+
+    unsigned int GetNumberOfPendingFrames() const;
+
+    /** \brief True if the last ReadPixels() could use pixel buffer objects. */
+    bool IsAsynchronous() const;
+
+  protected:
+    RenderWindowFrameReader();
+    ~RenderWindowFrameReader() override;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> d;
+
+    PixelFormat m_PixelFormat;
+    unsigned int m_NumberOfBuffers;
+  };
+}
+
+#endif
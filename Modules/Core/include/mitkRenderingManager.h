@@ -23,6 +23,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <itkObject.h>
 #include <itkObjectFactory.h>
+#include <chrono>
+#include <map>
 #include <string>
 
 #include "mitkProperties.h"
@@ -72,6 +74,13 @@ namespace mitk
    * appropriate event issueing for controlling the update execution process.
    * See method documentation for a description of how this can be done.
    *
+   * Requested updates are limited to one frame per #MinimumFrameInterval if
+   * the platform specific implementation supports delayed request events:
+   * requests arriving earlier are coalesced into the next frame. The rendering
+   * time of every RenderWindow is tracked; windows with LOD enabled mappers
+   * whose full quality frame exceeds the #RenderingTimeBudget are rendered at
+   * the interaction LOD until the requests stop.
+   *
    * \sa TestingRenderingManager An "empty" RenderingManager implementation which
    * can be used in tests etc.
    *
@@ -224,6 +233,25 @@ namespace mitk
     /** En-/Disable LOD abort mechanism. */
     itkBooleanMacro(LODAbortMechanismEnabled);
 
+    /** Minimum time in milliseconds between two frames executing requested updates.
+     * Requests arriving earlier are executed together with the next frame,
+     * 0 disables the limit. Defaults to one frame at 60 Hz. */
+    itkSetMacro(MinimumFrameInterval, double);
+    itkGetMacro(MinimumFrameInterval, double);
+
+    /** Rendering time in milliseconds a RenderWindow with LOD enabled mappers may
+     * spend on a full quality frame. If it takes longer, the window is rendered
+     * at the interaction LOD until no more updates are requested. 0 always uses
+     * the interaction LOD during interaction. Defaults to one frame at 60 Hz. */
+    itkSetMacro(RenderingTimeBudget, double);
+    itkGetMacro(RenderingTimeBudget, double);
+
+    /** Duration of the last rendering of the RenderWindow in milliseconds, 0 if it was not rendered yet. */
+    double GetLastRenderingTime(vtkRenderWindow *renderWindow) const;
+
+    /** Moving average of the rendering times of the RenderWindow in milliseconds. */
+    double GetAverageRenderingTime(vtkRenderWindow *renderWindow) const;
+
     /** Force a sub-class to start a timer for a pending hires-rendering request */
     virtual void StartOrResetTimer(){};
 
@@ -306,6 +334,12 @@ namespace mitk
      * request. This method is called whenever an update is requested */
     virtual void GenerateRenderingRequestEvent() = 0;
 
+    /** Platform specific method for generating a rendering request event after
+     * the given delay, used to coalesce requests into the next frame. Returns
+     * false if the platform cannot delay events; the pending requests are
+     * executed immediately then. */
+    virtual bool GenerateDelayedRenderingRequestEvent(unsigned int /*milliseconds*/) { return false; }
+
     virtual void InitializePropertyList();
 
     bool m_UpdatePending;
@@ -338,6 +372,26 @@ namespace mitk
     RenderWindowList m_RenderWindowList;
     RenderWindowVector m_AllRenderWindows;
 
+    typedef std::chrono::steady_clock Clock;
+
+    struct RenderingTime
+    {
+      RenderingTime() : Last(0.0), Average(0.0) {}
+      Clock::time_point Start;
+      double Last;
+      double Average;
+    };
+
+    typedef std::map<vtkRenderWindow *, RenderingTime> RenderingTimeMap;
+
+    RenderingTimeMap m_RenderingTimes;
+
+    double m_MinimumFrameInterval;
+
+    double m_RenderingTimeBudget;
+
+    Clock::time_point m_LastFrameTime;
+
     struct RenderWindowCallbacks
     {
       vtkCallbackCommand *commands[3u];
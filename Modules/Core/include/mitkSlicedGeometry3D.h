@@ -97,6 +97,27 @@ namespace mitk
   * \deprecatedSince{2014_10} Please use GetPlaneGeometry
   */
     DEPRECATED(const PlaneGeometry *GetGeometry2D(int s)) { return GetPlaneGeometry(s); }
+
+    /**
+    * \brief Computes the origin of slice (\a s) without creating a PlaneGeometry.
+    *
+    * For evenly spaced stacks the origin is derived analytically from the
+    * first slice, so stepping through the slices neither clones nor caches
+    * plane geometries. Stored slices are queried directly.
+    *
+    * \return false if \a s is invalid or no geometry can be derived for it.
+    */
+    bool GetSliceOrigin(int s, Point3D &origin) const;
+
+    /**
+    * \brief Computes the index-to-world matrix and offset of slice (\a s)
+    * without creating a PlaneGeometry.
+    *
+    * \sa GetSliceOrigin
+    */
+    bool GetSliceIndexToWorldTransform(int s,
+                                       AffineTransform3D::MatrixType &matrix,
+                                       AffineTransform3D::OutputVectorType &offset) const;
     /**
     * \deprecatedSince{2014_10} Please use SetPlaneGeometry
     */
@@ -282,6 +303,13 @@ namespace mitk
     */
     mitk::Vector3D AdjustNormal(const mitk::Vector3D &normal) const;
 
+    /**
+    * Refreshes the cached transform of the first slice and the vector between
+    * two slices if the first slice, its transform or this geometry changed.
+    * Returns false if slices cannot be derived from the first one.
+    */
+    bool UpdateSliceStepCache() const;
+
     /**
     * Container for the 2D-geometries contained within this SliceGeometry3D.
     */
@@ -306,6 +334,14 @@ namespace mitk
     */
     mutable mitk::Vector3D m_DirectionVector;
 
+    /** Cached data of the evenly spaced fast path, see UpdateSliceStepCache(). */
+    mutable const PlaneGeometry *m_SliceStepCachePlane;
+    mutable itk::ModifiedTimeType m_SliceStepCachePlaneMTime;
+    mutable itk::ModifiedTimeType m_SliceStepCacheMTime;
+    mutable AffineTransform3D::MatrixType m_FirstSliceMatrix;
+    mutable Point3D m_FirstSliceOrigin;
+    mutable Vector3D m_SliceStep;
+
     /** Number of slices this SliceGeometry3D is descibing. */
     unsigned int m_Slices;
 
@@ -21,6 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkDataStorage.h"
 #include "mitkMessage.h"
 #include <map>
+#include <set>
 
 namespace mitk
 {
@@ -91,6 +92,18 @@ namespace mitk
     //##
     SetOfObjects::ConstPointer GetAll() const override;
 
+    //##Documentation
+    //## @brief returns a set of data objects that meet the given condition(s)
+    //##
+    //## Queries for the data type (NodePredicateDataType), the data UID (NodePredicateDataUID),
+    //## the "name" string property (NodePredicateProperty without renderer) and sources
+    //## (NodePredicateSource on this storage), as well as conjunctions and disjunctions of them,
+    //## are answered from indices that are maintained when nodes are added, removed or modified.
+    //## Only the indexed candidates are checked against the condition, all other queries scan GetAll().
+    //## Name and data type changes are tracked through the modified event of the node, which is
+    //## emitted by DataNode::SetName(), SetProperty() and SetData().
+    SetOfObjects::ConstPointer GetSubset(const NodePredicateBase *condition) const override;
+
     /*ITK Mutex */
     mutable itk::SimpleFastMutexLock m_Mutex;
 
@@ -99,6 +112,24 @@ namespace mitk
     //## @brief noncyclical directed graph data structure to store the nodes with their relation
     typedef std::map<mitk::DataNode::ConstPointer, SetOfObjects::ConstPointer> AdjacencyList;
 
+    //##Documentation
+    //## @brief set of nodes ordered like the nodes in m_SourceNodes, i.e. like the result of GetAll()
+    typedef std::set<const mitk::DataNode *> NodeSet;
+    typedef std::map<std::string, NodeSet> NodeIndex;
+
+    //##Documentation
+    //## @brief the keys under which a node is currently stored in the indices
+    struct IndexKeys
+    {
+      IndexKeys() : HasName(false), HasData(false) {}
+
+      bool HasName;
+      std::string Name;
+      bool HasData;
+      std::string DataType;
+      std::string DataUID;
+    };
+
     //##Documentation
     //## @brief Standard Constructor for ::New() instantiation
     StandaloneDataStorage();
@@ -121,6 +152,23 @@ namespace mitk
     //## @brief deletes all references to a node in a given relation (used in Remove() and TreeListener)
     void RemoveFromRelation(const mitk::DataNode *node, AdjacencyList &relation);
 
+    //##Documentation
+    //## @brief marks the index entries of a node as outdated, they are refreshed on the next GetSubset() call
+    void NodeModified(const mitk::DataNode *node) override;
+
+    //##Documentation
+    //## @brief (re)inserts node into the name, data type and data UID indices (m_Mutex must be locked)
+    void UpdateIndex(const mitk::DataNode *node) const;
+
+    //##Documentation
+    //## @brief removes node from the name, data type and data UID indices (m_Mutex must be locked)
+    void RemoveFromIndex(const mitk::DataNode *node) const;
+
+    //##Documentation
+    //## @brief collects the nodes that possibly fulfill condition (m_Mutex must be locked)
+    //## @return false if the condition can not be answered from the indices
+    bool GetIndexCandidates(const NodePredicateBase *condition, NodeSet &candidates) const;
+
     //##Documentation
     //## @brief Prints the contents of the StandaloneDataStorage to os. Do not call directly, call ->Print() instead
     void PrintSelf(std::ostream &os, itk::Indent indent) const override;
@@ -131,6 +179,22 @@ namespace mitk
     //##Documentation
     //## @brief Nodes are stored in reverse relation for easier traversal in the opposite direction of the relation
     AdjacencyList m_DerivedNodes;
+
+    //##Documentation
+    //## @brief Indices for GetSubset(), updated lazily for modified nodes
+    mutable NodeIndex m_NameIndex;
+    mutable NodeIndex m_DataTypeIndex;
+    mutable NodeIndex m_DataUIDIndex;
+    //##Documentation
+    //## @brief nodes without a "name" in their own property list, they might inherit one of their data
+    mutable NodeSet m_UnnamedNodes;
+    mutable std::map<const mitk::DataNode *, IndexKeys> m_IndexKeys;
+
+    //##Documentation
+    //## @brief Nodes that were modified since the last index update, guarded by m_OutdatedNodesMutex
+    //## which is never held while calling other code, so it can be locked from within event handlers
+    mutable NodeSet m_OutdatedNodes;
+    mutable itk::SimpleFastMutexLock m_OutdatedNodesMutex;
   };
 } // namespace mitk
 #endif /* MITKSTANDALONEDATASTORAGE_H_HEADER_INCLUDED_ */
@@ -54,6 +54,9 @@ namespace mitk
     void SetSliceItem(mitk::Image::ImageDataItemPointer dataItem, int s = 0, int t = 0, int n = 0);
     void SetVolumeItem(mitk::Image::ImageDataItemPointer dataItem, int t = 0, int n = 0);
     void SetChannelItem(mitk::Image::ImageDataItemPointer dataItem, int n = 0);
+
+    /** @brief Returns an item sharing the memory of @a dataItem copy-on-write, or @a dataItem itself if that is not possible. */
+    static mitk::Image::ImageDataItemPointer ShareItem(mitk::Image::ImageDataItemPointer dataItem);
   };
 
 } // namespace mitk
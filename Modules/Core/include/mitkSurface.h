@@ -21,12 +21,22 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkBaseData.h"
 #include <vtkSmartPointer.h>
 
+class vtkDataArray;
+class vtkPoints;
 class vtkPolyData;
 
 namespace mitk
 {
   /**
     * \brief Class for storing surfaces (vtkPolyData).
+    *
+    * Each time step holds its own vtkPolyData. For dynamic surfaces with fixed connectivity
+    * the time steps can share the topology of time step 0, see SetVtkPolyDataWithSharedTopology()
+    * and ShareTopology(): the poly datas of these time steps reference the cell arrays and cell
+    * data of time step 0 and only own their points and point data. They are ordinary vtkPolyData
+    * objects for all users of GetVtkPolyData(), but must not be modified in their cells, as this
+    * would change all time steps.
+    *
     * \ingroup Data
     */
   class MITKCORE_EXPORT Surface : public BaseData
@@ -53,6 +63,28 @@ namespace mitk
     virtual void SetRequestedRegion(Surface::RegionType *region);
     void SetRequestedRegionToLargestPossibleRegion() override;
     virtual void SetVtkPolyData(vtkPolyData *polydata, unsigned int t = 0);
+
+    /**
+     * \brief Sets time step t to the given points with the cells of time step 0.
+     *
+     * The number of points has to match time step 0. If scalars are given, they become the
+     * point scalars of time step t. Throws mitk::Exception if time step 0 is not set.
+     */
+    void SetVtkPolyDataWithSharedTopology(vtkPoints *points, unsigned int t, vtkDataArray *scalars = nullptr);
+
+    /**
+     * \brief Lets all time steps with the same points count and cells as time step 0 share its topology.
+     *
+     * Can be used to reduce the memory footprint of 3D+t surfaces that were read or created per time step.
+     * \return The number of time steps that share the topology of time step 0 afterwards, including time step 0.
+     */
+    unsigned int ShareTopology();
+
+    /** \brief True if there is more than one time step and all time steps share the topology of time step 0. */
+    bool HasSharedTopology() const;
+
+    /** \brief True if time step t shares the topology of time step 0, i.e. references the same cell arrays. */
+    bool IsTopologyShared(unsigned int t) const;
     virtual void Swap(Surface &other);
     void Update() override;
     void UpdateOutputInformation() override;
@@ -71,6 +103,9 @@ namespace mitk
     void InitializeEmpty() override;
 
   private:
+    /** Lets the copied time steps share the copied topology wherever the time steps of other do */
+    void RestoreSharedTopology(const Surface &other);
+
     std::vector<vtkSmartPointer<vtkPolyData>> m_PolyDatas;
     mutable RegionType m_LargestPossibleRegion;
     mutable RegionType m_RequestedRegion;
@@ -22,6 +22,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkImageSource.h"
 #include "mitkSurface.h"
 
+#include <vtkSmartPointer.h>
+#include <vtkType.h>
+
+class vtkImageData;
+class vtkImageStencilData;
 class vtkPolyData;
 
 namespace mitk
@@ -44,6 +49,13 @@ namespace mitk
    * unsigned char images, etc.) to produce a correct binary image
    * representation of the surface in MakeOutputBinary mode.
    *
+   * The surface is voxelized in slabs along the z axis of the image, one
+   * slab per thread (see itk::ProcessObject::SetNumberOfThreads()). If
+   * ReuseStencil is on, the voxelization of each time step is kept and
+   * reused as long as surface, geometries and tolerance do not change, e.g.
+   * when the same surface is stamped into several images sharing one
+   * geometry.
+   *
    * @ingroup SurfaceFilters
    * @ingroup Process
    */
@@ -67,6 +79,10 @@ namespace mitk
     itkGetConstMacro(Tolerance, double);
     itkSetMacro(Tolerance, double);
 
+    itkSetMacro(ReuseStencil, bool);
+    itkGetConstMacro(ReuseStencil, bool);
+    itkBooleanMacro(ReuseStencil);
+
     void GenerateInputRequestedRegion() override;
 
     void GenerateOutputInformation() override;
@@ -89,11 +105,35 @@ namespace mitk
 
     void Stencil3DImage(int time = 0);
 
+    /** Voxelizes the polydata, which has to be given in index coordinates of
+     *  \a image, in parallel slabs and returns the merged stencil. */
+    vtkSmartPointer<vtkImageStencilData> ComputeStencil(vtkPolyData *polydata, vtkImageData *image) const;
+
+    /** Voxelization of a time step together with everything it depends on. */
+    struct CachedStencil
+    {
+      vtkSmartPointer<vtkImageStencilData> Stencil;
+      const vtkPolyData *PolyData = nullptr;
+      vtkMTimeType PolyDataMTime = 0;
+      double Transform[16];
+      int Extent[6];
+      double Tolerance = 0.0;
+
+      bool Matches(const vtkPolyData *polydata,
+                   vtkMTimeType polyDataMTime,
+                   const double transform[16],
+                   const int extent[6],
+                   double tolerance) const;
+    };
+
+    std::vector<CachedStencil> m_CachedStencils;
+
     bool m_MakeOutputBinary;
     bool m_UShortBinaryPixelType;
 
     float m_BackgroundValue;
     double m_Tolerance;
+    bool m_ReuseStencil;
   };
 
 } // namespace mitk
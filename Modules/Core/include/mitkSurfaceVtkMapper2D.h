@@ -25,9 +25,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 // VTK
 #include <vtkSmartPointer.h>
 class vtkAssembly;
-class vtkCutter;
-class vtkPlane;
 class vtkLookupTable;
+class vtkMitkIndexedPlaneCutter;
+class vtkTransformPolyDataFilter;
 class vtkGlyph3D;
 class vtkArrowSource;
 class vtkReverseSense;
@@ -39,10 +39,12 @@ namespace mitk
   /**
     * @brief Vtk-based mapper for cutting 2D slices out of Surfaces.
     *
-    * The mapper uses a vtkCutter filter to cut out slices (contours) of the 3D
+    * The mapper uses a vtkMitkIndexedPlaneCutter filter to cut out slices (contours) of the 3D
     * volume and render these slices as vtkPolyData. The data is transformed
     * according to its geometry before cutting, to support the geometry concept
-    * of MITK.
+    * of MITK. The cutter indexes the cells of the surface along the normal of the
+    * slice and caches recent cuts, so scrolling through large meshes only cuts
+    * the cells near the slice.
     *
     * Properties:
     * \b Surface.2D.Line Width: Thickness of the rendered lines in 2D.
@@ -104,13 +106,15 @@ namespace mitk
          */
       vtkSmartPointer<vtkPolyDataMapper> m_Mapper;
       /**
-         * @brief m_Cutter Filter to cut out the 2D slice.
+         * @brief m_TransformFilter Transforms the surface according to its geometry.
+         *
+         * Kept between updates, so the surface is only transformed again if it or its geometry changed.
          */
-      vtkSmartPointer<vtkCutter> m_Cutter;
+      vtkSmartPointer<vtkTransformPolyDataFilter> m_TransformFilter;
       /**
-         * @brief m_CuttingPlane The plane where to cut off the 2D slice.
+         * @brief m_Cutter Filter to cut out the 2D slice.
          */
-      vtkSmartPointer<vtkPlane> m_CuttingPlane;
+      vtkSmartPointer<vtkMitkIndexedPlaneCutter> m_Cutter;
 
       /**
        * @brief m_NormalMapper Mapper for the normals.
@@ -156,7 +160,7 @@ namespace mitk
      *
      * The base class transforms the actor according to the respective
      * geometry which is correct for most cases. This mapper, however,
-     * uses a vtkCutter to cut out a contour. To cut out the correct
+     * uses a vtkMitkIndexedPlaneCutter to cut out a contour. To cut out the correct
      * contour, the data has to be transformed beforehand. Else the
      * current plane geometry will point the cutter to en empty location
      * (if the surface does have a geometry, which is a rather rare case).
@@ -118,6 +118,11 @@ namespace mitk
       vtkSmartPointer<vtkPolyDataNormals> m_VtkPolyDataNormals;
       vtkSmartPointer<vtkPlaneCollection> m_ClippingPlaneCollection;
       vtkSmartPointer<vtkDepthSortPolyData> m_DepthSort;
+      /** Normals filter and mapper input for surfaces whose time steps share one topology. The
+          normals are computed without splitting and attached to the shared cells, so that time
+          step changes only update the vertex buffers and not the index buffers of the mapper. */
+      vtkSmartPointer<vtkPolyDataNormals> m_SharedTopologyNormals;
+      vtkSmartPointer<vtkPolyData> m_SharedTopologyFrame;
       itk::TimeStamp m_ShaderTimestampUpdate;
 
       LocalStorage()
@@ -130,6 +135,12 @@ namespace mitk
         m_Actor->SetMapper(m_VtkPolyDataMapper);
 
         m_DepthSort = vtkSmartPointer<vtkDepthSortPolyData>::New();
+
+        m_SharedTopologyNormals = vtkSmartPointer<vtkPolyDataNormals>::New();
+        m_SharedTopologyNormals->SplittingOff();
+        m_SharedTopologyNormals->ConsistencyOff();
+        m_SharedTopologyNormals->ComputeCellNormalsOff();
+        m_SharedTopologyFrame = vtkSmartPointer<vtkPolyData>::New();
       }
 
       ~LocalStorage() override {}
@@ -0,0 +1,171 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKTASKSCHEDULER_H
+#define MITKTASKSCHEDULER_H
+
+#include <MitkCoreExports.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mitk
+{
+  class TaskScheduler;
+
+  /**
+   * @brief A unit of work run by a TaskScheduler, returned by TaskScheduler::Submit().
+   *
+   * A task which did not start yet can be canceled and will not run at all. A running task is
+   * only asked to stop, it has to check TaskScheduler::IsCurrentTaskCanceled() itself.
+   */
+  class MITKCORE_EXPORT Task
+  {
+  public:
+    enum State
+    {
+      Queued,
+      Running,
+      Finished,
+      Canceled
+    };
+
+    State GetState() const { return m_State.load(); }
+    bool IsCanceled() const { return m_CancelRequested.load(); }
+    bool IsDone() const;
+
+    /**
+     * @brief Removes the task from the queue, or asks the running task to stop.
+     * @return true if the task did not start and will not run any more
+     */
+    bool Cancel();
+
+    /**
+     * @brief Blocks until the task finished or was canceled.
+     *
+     * Called from a thread of the scheduler, other tasks are run meanwhile, so waiting for a
+     * subtask never blocks a worker.
+     */
+    void Wait();
+
+  private:
+    friend class TaskScheduler;
+
+    Task() = default;
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+
+    void SetDone(State state);
+
+    std::function<void()> m_Function;
+    int m_Priority = 0;
+    std::vector<std::pair<const void *, bool>> m_Resources;
+    TaskScheduler *m_Scheduler = nullptr;
+
+    std::atomic<State> m_State{Queued};
+    std::atomic<bool> m_CancelRequested{false};
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_Done;
+  };
+
+  /**
+   * @brief Shared pool of worker threads for background computations.
+   *
+   * Algorithms which used to spawn their own threads submit their work here instead, so that
+   * concurrent computations share the cores instead of oversubscribing them. Every worker keeps its
+   * own queue per priority, tasks submitted by a task go to the queue of its worker and idle
+   * workers steal from the others. Tasks of a higher priority always run first.
+   *
+   * Tasks can declare the data they access. Tasks writing the same data, or reading data another
+   * task writes, are never run at the same time; the later one waits until the data is released,
+   * without occupying a worker. Any address identifies data, usually the mitk::BaseData or
+   * mitk::DataNode a task works on.
+   *
+   * GetInstance() returns the scheduler shared by the application, which uses one thread per core.
+   */
+  class MITKCORE_EXPORT TaskScheduler
+  {
+  public:
+    enum Priority
+    {
+      /** @brief Results the user is waiting for, e.g. previews while interacting */
+      InteractivePriority = 0,
+      NormalPriority,
+      /** @brief Precomputations which may be needed later */
+      BackgroundPriority,
+      NumberOfPriorities
+    };
+
+    enum AccessMode
+    {
+      ReadAccess,
+      WriteAccess
+    };
+
+    struct Resource
+    {
+      Resource(const void *data, AccessMode mode = WriteAccess) : Data(data), Mode(mode) {}
+
+      const void *Data;
+      AccessMode Mode;
+    };
+
+    typedef std::shared_ptr<Task> TaskPointer;
+
+    static TaskScheduler *GetInstance();
+
+    /** @param numberOfThreads number of worker threads, 0 uses the number of hardware threads */
+    explicit TaskScheduler(unsigned int numberOfThreads = 0);
+
+    /** @brief Cancels the queued tasks and waits for the running ones. */
+    ~TaskScheduler();
+
+    /**
+     * @brief Queues a function to run on a worker thread.
+     *
+     * Exceptions thrown by the function are logged and otherwise ignored.
+     */
+    TaskPointer Submit(const std::function<void()> &function,
+                       Priority priority = NormalPriority,
+                       const std::vector<Resource> &resources = std::vector<Resource>());
+
+    unsigned int GetNumberOfThreads() const;
+
+    /** @brief Whether the task running on the calling thread was asked to stop. False outside of tasks. */
+    static bool IsCurrentTaskCanceled();
+
+  private:
+    friend class Task;
+
+    TaskScheduler(const TaskScheduler &) = delete;
+    TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+    /** @brief Runs one queued task on the calling worker, returns false if there was none. */
+    bool RunPendingTask();
+
+    bool IsWorkerThread() const;
+
+    class Impl;
+    std::unique_ptr<Impl> d;
+  };
+}
+
+#endif
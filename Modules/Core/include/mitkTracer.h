@@ -0,0 +1,158 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKTRACER_H
+#define MITKTRACER_H
+
+#include <MitkCoreExports.h>
+#include <mitkConfig.h>
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace mitk
+{
+  class BaseData;
+
+  /**
+   * @brief Collects begin/end events of pipeline stages to find out where the time goes.
+   *
+   * Events are recorded by the MITK_TRACE_* macros below, which are only compiled in if
+   * MITK_ENABLE_TRACING is switched on in CMake. Otherwise they expand to nothing and cost
+   * nothing. Recording additionally has to be enabled at runtime, either with SetEnabled()
+   * or by setting the environment variable MITK_TRACE_FILE to a file name. In the latter
+   * case the trace is written to that file when the application exits.
+   *
+   * Sources (GenerateData), mappers (GenerateDataForRenderer), IOUtil reads and the
+   * AccessByItk dispatch are instrumented. WriteChromeTrace() exports the events in the
+   * trace event format that chrome://tracing and the Perfetto UI understand.
+   */
+  class MITKCORE_EXPORT Tracer
+  {
+  public:
+    struct Event
+    {
+      std::string Category;
+      std::string Name;
+      std::string NodeName;
+      std::size_t DataSize;
+      unsigned int ThreadId;
+      /** @brief Begin and duration in microseconds, see GetTimeStamp() */
+      long long Begin;
+      long long Duration;
+    };
+
+    static Tracer *GetInstance();
+
+    void SetEnabled(bool enabled);
+    bool IsEnabled() const { return m_Enabled.load(std::memory_order_relaxed); }
+
+    /** @brief Events beyond this number are dropped, defaults to one million */
+    void SetMaximumNumberOfEvents(std::size_t maximum);
+    std::size_t GetMaximumNumberOfEvents() const;
+
+    void Record(const Event &event);
+
+    std::vector<Event> GetEvents() const;
+    std::size_t GetNumberOfDroppedEvents() const;
+    void Clear();
+
+    void WriteChromeTrace(std::ostream &stream) const;
+
+    /** @throws mitk::Exception if the file cannot be written */
+    void WriteChromeTrace(const std::string &fileName) const;
+
+    /** @brief Microseconds of a monotonic clock */
+    static long long GetTimeStamp();
+
+    /** @brief Small sequential id of the calling thread */
+    static unsigned int GetCurrentThreadId();
+
+    /** @brief Resident bytes of images and surfaces, 0 for other data */
+    static std::size_t GetDataSize(const BaseData *data);
+
+  private:
+    Tracer();
+    ~Tracer();
+
+    Tracer(const Tracer &) = delete;
+    Tracer &operator=(const Tracer &) = delete;
+
+    std::atomic<bool> m_Enabled;
+    std::string m_TraceFile;
+
+    mutable std::mutex m_Mutex;
+    std::vector<Event> m_Events;
+    std::size_t m_MaximumNumberOfEvents;
+    std::size_t m_DroppedEvents;
+  };
+
+  /**
+   * @brief Records one Tracer event for the lifetime of the object, if tracing is enabled.
+   */
+  class MITKCORE_EXPORT TraceScope
+  {
+  public:
+    TraceScope(const char *category, const char *name);
+    ~TraceScope();
+
+    bool IsActive() const { return m_Active; }
+
+    void SetDataSize(std::size_t size);
+    void SetNodeName(const std::string &nodeName);
+
+  private:
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+    bool m_Active;
+    Tracer::Event m_Event;
+  };
+}
+
+#define MITK_TRACE_CONCAT_IMPL(a, b) a##b
+#define MITK_TRACE_CONCAT(a, b) MITK_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef MITK_ENABLE_TRACING
+/** @brief Traces the enclosing scope */
+#define MITK_TRACE_SCOPE(category, name) mitk::TraceScope MITK_TRACE_CONCAT(mitkTraceScope, __LINE__)(category, name)
+/** @brief Traces the enclosing scope with a scope object that can be annotated */
+#define MITK_TRACE_NAMED_SCOPE(scope, category, name) mitk::TraceScope scope(category, name)
+/** @brief Annotates a named scope, the argument is only evaluated if tracing is enabled at runtime */
+#define MITK_TRACE_SET_DATA_SIZE(scope, size)                                                                          \
+  do                                                                                                                   \
+  {                                                                                                                    \
+    if (scope.IsActive())                                                                                              \
+      scope.SetDataSize(size);                                                                                         \
+  } while (false)
+#define MITK_TRACE_SET_NODE_NAME(scope, nodeName)                                                                      \
+  do                                                                                                                   \
+  {                                                                                                                    \
+    if (scope.IsActive())                                                                                              \
+      scope.SetNodeName(nodeName);                                                                                     \
+  } while (false)
+#else
+#define MITK_TRACE_SCOPE(category, name)
+#define MITK_TRACE_NAMED_SCOPE(scope, category, name)
+#define MITK_TRACE_SET_DATA_SIZE(scope, size)
+#define MITK_TRACE_SET_NODE_NAME(scope, nodeName)
+#endif
+
+#endif // MITKTRACER_H
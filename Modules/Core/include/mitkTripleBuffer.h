@@ -0,0 +1,77 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKTRIPLEBUFFER_H_HEADER_INCLUDED_
+#define MITKTRIPLEBUFFER_H_HEADER_INCLUDED_
+
+#include <atomic>
+
+namespace mitk
+{
+  /**Documentation
+  * \brief Lock-free handoff of complete values from one producer thread to one consumer thread.
+  *
+  * The producer fills the buffer returned by GetWriteBuffer() and calls Publish(). The consumer calls
+  * Acquire() and reads GetReadBuffer(). Neither side ever blocks or waits for the other: the producer
+  * always has a free buffer to write to, and the consumer always sees the most recent published value
+  * as a whole, never a partially written one. Values which are published faster than they are acquired
+  * are overwritten by newer ones.
+  *
+  * The producer side and the consumer side must each be used from a single thread at a time.
+  *
+  * \ingroup DataManagement
+  */
+  template <class T>
+  class TripleBuffer
+  {
+  public:
+    TripleBuffer() : m_WriteIndex(0), m_Middle(1), m_ReadIndex(2) {}
+
+    /** \brief Returns the buffer the producer may write to. */
+    T& GetWriteBuffer() { return m_Buffers[m_WriteIndex]; }
+
+    /** \brief Makes the content of the write buffer available to the consumer. */
+    void Publish()
+    {
+      m_WriteIndex = m_Middle.exchange(m_WriteIndex | FreshBit, std::memory_order_acq_rel) & IndexMask;
+    }
+
+    /**
+    * \brief Takes over the most recently published value, if there is one that was not acquired yet.
+    * \return true if GetReadBuffer() now holds a new value
+    */
+    bool Acquire()
+    {
+      if ((m_Middle.load(std::memory_order_relaxed) & FreshBit) == 0)
+        return false;
+      m_ReadIndex = m_Middle.exchange(m_ReadIndex, std::memory_order_acq_rel) & IndexMask;
+      return true;
+    }
+
+    /** \brief Returns the buffer holding the last acquired value. */
+    const T& GetReadBuffer() const { return m_Buffers[m_ReadIndex]; }
+
+  private:
+    enum { IndexMask = 3, FreshBit = 4 };
+
+    T m_Buffers[3];
+    unsigned int m_WriteIndex;            ///< owned by the producer
+    std::atomic<unsigned int> m_Middle;   ///< index of the buffer in between, plus FreshBit if it holds an unread value
+    unsigned int m_ReadIndex;             ///< owned by the consumer
+  };
+} // namespace mitk
+
+#endif /* MITKTRIPLEBUFFER_H_HEADER_INCLUDED_ */
@@ -114,6 +114,14 @@ namespace mitk
     //## corresponding to the given value; if nothing found, then returns nullptr
     OperationEvent *GetLastOfType(OperationActor *destination, OperationType opType);
 
+    //##Documentation
+    //## @brief Limits the memory of the undo history of the current UndoModel (in bytes, 0 = no limit).
+    //##
+    //## If the limit is exceeded, the oldest undo items are dropped.
+    //## Keeps memory flat over long sessions with large operations, e.g. segmentation slices.
+    void SetMemoryLimit(std::size_t limit);
+    std::size_t GetMemoryLimit() const;
+
     //##Documentation
     //## @brief gives access to the currently used UndoModel
     //## Introduced to access special functions of more specific UndoModels,
@@ -75,6 +75,22 @@ namespace mitk
     //## @param limit the maximum number of items on the stack
     virtual void SetUndoLimit(std::size_t limit) = 0;
 
+    //##Documentation
+    //## @brief Gets the limit on the memory of the undo history in bytes.
+    //## The 0 value means that there is no limit.
+    virtual std::size_t GetMemoryLimit() const = 0;
+
+    //##Documentation
+    //## @brief Sets a limit on the memory of the undo history in bytes.
+    //## If the memory of all stored items exceeds the limit, the oldest undo items
+    //## will be dropped from the bottom of the undo stack. The most recent item is
+    //## always kept. The 0 value means that there is no limit.
+    virtual void SetMemoryLimit(std::size_t limit) = 0;
+
+    //##Documentation
+    //## @brief Returns the approximate memory in bytes held by the undo history
+    virtual std::size_t GetMemorySize() const = 0;
+
     //##Documentation
     //## @brief returns the ObjectEventId of the
     //## top Element in the OperationHistory of the selected
@@ -24,7 +24,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkRenderingManager.h>
 
 #include <map>
+#include <memory>
 #include <utility>
+#include <vector>
 
 class vtkRenderWindow;
 class vtkLight;
@@ -109,18 +111,24 @@ namespace mitk
     {
       WorldPointPicking,
       PointPicking,
-      CellPicking
+      CellPicking,
+      HardwarePicking
     };
     /** \brief  Set the picking mode.
     This method is used to set the picking mode for 3D object picking. The user can select one of
-    the three options WorldPointPicking, PointPicking and CellPicking. The first option uses the zBuffer
+    the options WorldPointPicking, PointPicking, CellPicking and HardwarePicking. The first option uses the zBuffer
     from graphics rendering, the second uses the 3D points from the closest surface mesh, and the third
-    option uses the cells   of that mesh. The last option is the slowest, the first one the fastest.
+    option uses the cells   of that mesh. The third option is the slowest, the first one the fastest.
     However, the first option cannot use transparent data object and the tolerance of the picked position
     to the selected point should be considered. PointPicking also need a tolerance around the picking
     position to select the closest point in the mesh. The CellPicker performs very well, if the
     foreground surface part (i.e. the surfacepart that is closest to the scene's cameras) needs to be
-    picked. */
+    picked. Cell picking uses cell locators for large meshes, which are kept until the mesh is modified.
+    HardwarePicking makes PickObject() render the pickable objects once into an ID buffer
+    (vtkHardwareSelector) that is reused until the camera, the window size or one of the objects changes.
+    The picked object is looked up in this buffer and only its mesh is intersected with the picking ray.
+    If the selection cannot be rendered, cell picking is used instead. For PickWorldPoint(),
+    HardwarePicking behaves like WorldPointPicking. */
     itkSetEnumMacro(PickingMode, PickingMode);
     itkGetEnumMacro(PickingMode, PickingMode);
 
@@ -226,6 +234,21 @@ namespace mitk
 
     PickingMode m_PickingMode;
 
+    typedef std::vector<std::pair<const DataNode *, vtkProp *>> PickablePropsType;
+    /** \brief Nodes with "pickable" set to true and the vtkProp of their mapper in this renderer. */
+    PickablePropsType GetPickableProps() const;
+    /** \brief Registers cached cell locators of the meshes of the given props with the cell picker. */
+    void UpdatePickLocators(const PickablePropsType &props) const;
+    /** \brief Looks up the prop at the display position in the ID buffer, which is rendered if outdated.
+    Returns false if no ID buffer is available, pickedProp is nullptr if no prop is at that position. */
+    bool PickPropFromSelectionBuffers(const PickablePropsType &props,
+                                      const Point2D &displayPosition,
+                                      vtkProp *&pickedProp) const;
+
+    // cell locators and ID buffer, defined in the implementation to keep the VTK includes out of the header
+    struct PickingCache;
+    std::unique_ptr<PickingCache> m_PickingCache;
+
     // Explicit use of SmartPointer to avoid circular #includes
     itk::SmartPointer<mitk::Mapper> m_CurrentWorldPlaneGeometryMapper;
 
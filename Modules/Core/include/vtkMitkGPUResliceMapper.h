@@ -0,0 +1,140 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#ifndef vtkMitkGPUResliceMapper_h
+#define vtkMitkGPUResliceMapper_h
+
+#include <MitkCoreExports.h>
+
+#include <vtkOpenGLPolyDataMapper.h>
+#include <vtkSmartPointer.h>
+
+#include <vector>
+
+class vtkImageData;
+class vtkMatrix4x4;
+class vtkOpenGLRenderWindow;
+class vtkScalarsToColors;
+class vtkTextureObject;
+
+/**
+  \brief Renders a slice of a volume by sampling it as a 3D texture in the fragment shader.
+
+  The polydata (usually the plane of the ImageVtkMapper2D) is only used to rasterize the
+  slice. Every fragment is mapped to continuous voxel indices by the model to index matrix,
+  the volume is sampled there (optionally several times along the slab step for thick
+  slices) and the result is mapped through the color table.
+
+  The volume is uploaded once and kept on the GPU until it is modified, so changing the
+  slice, the level window or the thick slice parameters does not touch the voxels again.
+  Volumes exceeding the maximum 3D texture size are split into bricks which are drawn
+  one after the other; bricks not touched by the slab are skipped.
+
+  Only single component scalars are supported.
+
+  \sa ImageVtkMapper2D
+*/
+class MITKCORE_EXPORT vtkMitkGPUResliceMapper : public vtkOpenGLPolyDataMapper
+{
+public:
+  static vtkMitkGPUResliceMapper *New();
+  vtkTypeMacro(vtkMitkGPUResliceMapper, vtkOpenGLPolyDataMapper);
+
+  /** \brief Thick slice modes, same order as in vtkMitkThickSlicesFilter. */
+  enum
+  {
+    MIP = 0,
+    SUM,
+    WEIGHTED,
+    MINIP,
+    MEAN
+  };
+
+  /** \brief The volume to sample. Its origin and spacing are ignored, the model to index matrix
+   * has to map into its index coordinates. */
+  void SetVolume(vtkImageData *volume);
+  vtkImageData *GetVolume();
+
+  /** \brief Maps the model coordinates of the rendered polydata to continuous voxel indices. */
+  void SetModelToIndexMatrix(vtkMatrix4x4 *matrix);
+
+  /** \brief Thick slices: the volume is sampled numberOfSlices times on both sides of the slice
+   * with the given step (in index coordinates). numberOfSlices = 0 renders a thin slice. */
+  void SetThickSlices(int mode, int numberOfSlices, const double indexStep[3]);
+
+  /** \brief Maps the scalars to colors, it is sampled over its range. */
+  void SetColorTable(vtkScalarsToColors *colorTable);
+
+  vtkSetMacro(Interpolate, bool);
+  vtkGetMacro(Interpolate, bool);
+  vtkBooleanMacro(Interpolate, bool);
+
+  /** \brief Upper limit for the size of a brick, 0 uses the limit of the graphics card. */
+  vtkSetMacro(MaximumBrickSize, int);
+  vtkGetMacro(MaximumBrickSize, int);
+
+  void RenderPiece(vtkRenderer *ren, vtkActor *act) override;
+  void ReleaseGraphicsResources(vtkWindow *window) override;
+
+protected:
+  vtkMitkGPUResliceMapper();
+  ~vtkMitkGPUResliceMapper() override;
+
+  void SetMapperShaderParameters(vtkOpenGLHelper &cellBO, vtkRenderer *ren, vtkActor *act) override;
+
+  /** \brief A part of the volume that fits into a single 3D texture. */
+  struct Brick
+  {
+    /** \brief Voxels this brick is responsible for */
+    int CoreBegin[3];
+    int CoreEnd[3];
+    /** \brief Voxels stored in the texture: the core plus one voxel of overlap for interpolation */
+    int TextureBegin[3];
+    int TextureEnd[3];
+    vtkSmartPointer<vtkTextureObject> Texture;
+  };
+
+  void UpdateVolumeTextures(vtkOpenGLRenderWindow *renderWindow);
+  void UpdateColorTexture(vtkOpenGLRenderWindow *renderWindow);
+  bool BrickIntersectsSlab(const Brick &brick) const;
+
+  vtkSmartPointer<vtkImageData> Volume;
+  vtkMTimeType VolumeUploadTime;
+  /** \brief Maps the texture values back to the scalar values (normalized integer formats) */
+  double ScalarScale;
+  std::vector<Brick> Bricks;
+  const Brick *CurrentBrick;
+
+  vtkSmartPointer<vtkScalarsToColors> ColorTable;
+  vtkSmartPointer<vtkTextureObject> ColorTexture;
+  vtkMTimeType ColorUploadTime;
+  double ColorRange[2];
+
+  vtkSmartPointer<vtkMatrix4x4> ModelToIndex;
+  int ThickSliceMode;
+  int NumberOfThickSlices;
+  double ThickSliceStep[3];
+
+  bool Interpolate;
+  int MaximumBrickSize;
+
+private:
+  vtkMitkGPUResliceMapper(const vtkMitkGPUResliceMapper &); // Not implemented.
+  void operator=(const vtkMitkGPUResliceMapper &);          // Not implemented.
+};
+
+#endif
@@ -0,0 +1,116 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef __vtkMitkIndexedPlaneCutter_h
+#define __vtkMitkIndexedPlaneCutter_h
+
+#include <MitkCoreExports.h>
+
+#include <vtkPolyDataAlgorithm.h>
+#include <vtkSmartPointer.h>
+
+#include <list>
+#include <utility>
+#include <vector>
+
+class vtkCutter;
+class vtkPlane;
+
+/**
+  \brief Cuts polydata with a plane, using an index of the input cells along the plane normal.
+
+  For every cell the range of its points along the normal is computed. The ranges are sorted into
+  buckets of equal width over the extent of the input, so a cut only touches the cells of a single
+  bucket instead of all cells. The candidate cells are copied into a small polydata which is cut by
+  a vtkCutter, the output equals the output of a vtkCutter applied to the whole input.
+
+  The index is built again if the input or the direction of the normal changes. Moving the plane
+  along its normal (i.e. scrolling through slices) reuses it. Additionally the last CacheSize cuts
+  are kept, keyed by the distance of the plane from the origin, so returning to a recent slice does
+  not cut again. The cache is cleared together with the index.
+
+  \sa mitk::SurfaceVtkMapper2D
+*/
+class MITKCORE_EXPORT vtkMitkIndexedPlaneCutter : public vtkPolyDataAlgorithm
+{
+public:
+  static vtkMitkIndexedPlaneCutter *New();
+  vtkTypeMacro(vtkMitkIndexedPlaneCutter, vtkPolyDataAlgorithm);
+  void PrintSelf(ostream &os, vtkIndent indent) override;
+
+  // Description:
+  // A point of the cutting plane.
+  vtkSetVector3Macro(Origin, double);
+  vtkGetVector3Macro(Origin, double);
+
+  // Description:
+  // Normal of the cutting plane, it is normalized internally.
+  vtkSetVector3Macro(Normal, double);
+  vtkGetVector3Macro(Normal, double);
+
+  // Description:
+  // Number of cuts kept for reuse, 0 disables the cache. Default is 16.
+  void SetCacheSize(int cacheSize);
+  vtkGetMacro(CacheSize, int);
+
+  // Description:
+  // Statistics, mainly for testing: how often the index was built, how many
+  // executions were answered by the cache and how many candidate cells were
+  // cut in the last execution.
+  vtkGetMacro(NumberOfIndexBuilds, unsigned long);
+  vtkGetMacro(NumberOfCacheHits, unsigned long);
+  vtkGetMacro(NumberOfCandidateCells, vtkIdType);
+
+protected:
+  vtkMitkIndexedPlaneCutter();
+  ~vtkMitkIndexedPlaneCutter() override;
+
+  int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *) override;
+
+  void BuildIndex(vtkPolyData *input, const double normal[3]);
+  void CollectCandidateCells(double offset, std::vector<vtkIdType> &cellIds) const;
+  void Cut(vtkPolyData *input, const std::vector<vtkIdType> &cellIds, vtkPolyData *output);
+
+  double Origin[3];
+  double Normal[3];
+  int CacheSize;
+
+  unsigned long NumberOfIndexBuilds;
+  unsigned long NumberOfCacheHits;
+  vtkIdType NumberOfCandidateCells;
+
+  // index over the cell ranges along IndexNormal
+  double IndexNormal[3];
+  vtkMTimeType IndexInputMTime;
+  vtkPolyData *IndexInput; // only compared, not referenced
+  double IndexMinimum;
+  double IndexBucketWidth;
+  std::vector<double> CellRanges;       // minimum and maximum per cell
+  std::vector<vtkIdType> BucketOffsets; // start of every bucket in BucketCells, one more than buckets
+  std::vector<vtkIdType> BucketCells;
+
+  // the most recently used cut is at the front
+  std::list<std::pair<double, vtkSmartPointer<vtkPolyData>>> Cache;
+
+  vtkSmartPointer<vtkPlane> Plane;
+  vtkSmartPointer<vtkCutter> Cutter;
+
+private:
+  vtkMitkIndexedPlaneCutter(const vtkMitkIndexedPlaneCutter &); // Not implemented.
+  void operator=(const vtkMitkIndexedPlaneCutter &);            // Not implemented.
+};
+
+#endif
@@ -50,6 +50,19 @@ public:
   vtkGetMacro(HandleBoundaries, int);
   vtkBooleanMacro(HandleBoundaries, int);
 
+  // Description:
+  // Wall clock time in seconds of the last execution, summed up over all
+  // executions and the number of executions. Useful for profiling large slabs.
+  vtkGetMacro(LastExecutionTime, double);
+  vtkGetMacro(TotalExecutionTime, double);
+  vtkGetMacro(NumberOfExecutions, unsigned long);
+  void ResetExecutionTimes()
+  {
+    this->LastExecutionTime = 0.0;
+    this->TotalExecutionTime = 0.0;
+    this->NumberOfExecutions = 0;
+  }
+
   enum
   {
     MIP = 0,
@@ -66,6 +79,10 @@ protected:
   int HandleBoundaries;
   int Dimensionality;
 
+  double LastExecutionTime;
+  double TotalExecutionTime;
+  unsigned long NumberOfExecutions;
+
   int RequestInformation(vtkInformation *, vtkInformationVector **, vtkInformationVector *) override;
   int RequestUpdateExtent(vtkInformation *, vtkInformationVector **, vtkInformationVector *) override;
   int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *) override;
@@ -16,9 +16,74 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkBaseDataSource.h"
 #include "mitkBaseData.h"
+#include "mitkTracer.h"
+
+#ifdef MITK_ENABLE_TRACING
+#include <itkCommand.h>
+
+namespace
+{
+  /** Records the time between the StartEvent and EndEvent that ProcessObject::UpdateOutputData()
+      invokes around GenerateData() */
+  class GenerateDataTraceCommand : public itk::Command
+  {
+  public:
+    typedef GenerateDataTraceCommand Self;
+    typedef itk::SmartPointer<Self> Pointer;
+    itkNewMacro(Self);
+
+    void Execute(itk::Object *caller, const itk::EventObject &event) override
+    {
+      this->Execute(static_cast<const itk::Object *>(caller), event);
+    }
+
+    void Execute(const itk::Object *caller, const itk::EventObject &event) override
+    {
+      mitk::Tracer *tracer = mitk::Tracer::GetInstance();
+      if (!tracer->IsEnabled())
+        return;
+
+      if (itk::StartEvent().CheckEvent(&event))
+      {
+        m_Begin = mitk::Tracer::GetTimeStamp();
+        m_ThreadId = mitk::Tracer::GetCurrentThreadId();
+      }
+      else if (m_Begin >= 0 && itk::EndEvent().CheckEvent(&event))
+      {
+        auto source = static_cast<const mitk::BaseDataSource *>(caller);
+
+        mitk::Tracer::Event traceEvent;
+        traceEvent.Category = "GenerateData";
+        traceEvent.Name = source->GetNameOfClass();
+        traceEvent.DataSize = 0;
+        for (unsigned int i = 0; i < source->GetNumberOfIndexedOutputs(); ++i)
+        {
+          traceEvent.DataSize += mitk::Tracer::GetDataSize(source->GetOutput(i));
+        }
+        traceEvent.ThreadId = m_ThreadId;
+        traceEvent.Begin = m_Begin;
+        traceEvent.Duration = mitk::Tracer::GetTimeStamp() - m_Begin;
+        tracer->Record(traceEvent);
+        m_Begin = -1;
+      }
+    }
+
+  private:
+    GenerateDataTraceCommand() : m_Begin(-1), m_ThreadId(0) {}
+
+    long long m_Begin;
+    unsigned int m_ThreadId;
+  };
+}
+#endif
 
 mitk::BaseDataSource::BaseDataSource()
 {
+#ifdef MITK_ENABLE_TRACING
+  GenerateDataTraceCommand::Pointer traceCommand = GenerateDataTraceCommand::New();
+  this->AddObserver(itk::StartEvent(), traceCommand);
+  this->AddObserver(itk::EndEvent(), traceCommand);
+#endif
 }
 
 mitk::BaseDataSource::~BaseDataSource()
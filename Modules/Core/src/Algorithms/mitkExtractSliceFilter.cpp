@@ -17,8 +17,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkExtractSliceFilter.h"
 
 #include <mitkAbstractTransformGeometry.h>
+#include <mitkIImageProcessingAccelerator.h>
 #include <mitkPlaneClipping.h>
 
+#include <usGetModuleContext.h>
+#include <usModuleContext.h>
+
 #include <vtkGeneralTransform.h>
 #include <vtkImageChangeInformation.h>
 #include <vtkImageData.h>
@@ -47,6 +51,8 @@ mitk::ExtractSliceFilter::ExtractSliceFilter(vtkImageReslice *reslicer)
   m_ZMin = 0;
   m_ZMax = 0;
   m_VtkOutputRequested = false;
+  m_ResliceGeometryOnly = false;
+  m_UseAccelerator = false;
   m_BackgroundLevel = -32768.0;
   m_Component = 0;
 }
@@ -341,20 +347,33 @@ void mitk::ExtractSliceFilter::GenerateData()
   // xMax and yMax are one after the last pixel. so they have to be decremented by 1.
   // In case we have a 2D image, xMax or yMax might be 0. in this case, do not decrement, but take 0.
 
-  m_Reslicer->SetOutputExtent(xMin, std::max(0, xMax - 1), yMin, std::max(0, yMax - 1), m_ZMin, m_ZMax);
+  int outputExtent[6] = {xMin, std::max(0, xMax - 1), yMin, std::max(0, yMax - 1), m_ZMin, m_ZMax};
+  m_Reslicer->SetOutputExtent(outputExtent);
   /*========== END setup extent of the slice ==========*/
 
   m_Reslicer->SetOutputOrigin(0.0, 0.0, 0.0);
 
   m_Reslicer->SetOutputSpacing(m_OutPutSpacing[0], m_OutPutSpacing[1], m_ZSpacing);
 
-  // TODO check the following lines, they are responsible whether vtk error outputs appear or not
-  m_Reslicer->UpdateWholeExtent(); // this produces a bad allocation error for 2D images
-  // m_Reslicer->GetOutput()->UpdateInformation();
-  // m_Reslicer->GetOutput()->SetUpdateExtentToWholeExtent();
+  if (m_ResliceGeometryOnly)
+  {
+    // the caller only needs the reslice axes, spacing and extent
+    return;
+  }
 
-  // start the pipeline
-  m_Reslicer->Update();
+  // planar slices can be sampled by an accelerator instead, which writes to the output of the reslicer
+  const bool acceleratorSupportsSlice = abstractGeometry == nullptr && m_OutputDimension == 2 && m_ZMin == 0 &&
+                                        m_ZMax == 0 && m_InterpolationMode != RESLICE_CUBIC;
+  if (!m_UseAccelerator || !acceleratorSupportsSlice || !this->ResliceOnAccelerator(outputExtent))
+  {
+    // TODO check the following lines, they are responsible whether vtk error outputs appear or not
+    m_Reslicer->UpdateWholeExtent(); // this produces a bad allocation error for 2D images
+    // m_Reslicer->GetOutput()->UpdateInformation();
+    // m_Reslicer->GetOutput()->SetUpdateExtentToWholeExtent();
+
+    // start the pipeline
+    m_Reslicer->Update();
+  }
   /*================ #END setup vtkImageReslice properties================*/
 
   if (m_VtkOutputRequested)
@@ -461,6 +480,112 @@ void mitk::ExtractSliceFilter::GenerateData()
   }
 }
 
+bool mitk::ExtractSliceFilter::ResliceOnAccelerator(const int outputExtent[6])
+{
+  mitk::Image *input = this->GetInput();
+  if (input->GetDimension() < 3 || input->GetPixelType().GetNumberOfComponents() != 1)
+    return false;
+
+  us::ModuleContext *context = us::GetModuleContext();
+  us::ServiceReference<IImageProcessingAccelerator> reference =
+    context->GetServiceReference<IImageProcessingAccelerator>();
+  if (!reference)
+    return false;
+
+  IImageProcessingAccelerator *accelerator = context->GetService(reference);
+  if (accelerator == nullptr)
+    return false;
+
+  vtkImageData *inputData = input->GetVtkImageData(m_TimeStep);
+
+  // output index -> output coordinates, relative to the first pixel of the extent (the output origin is 0)
+  auto outputIndexToOutput = vtkSmartPointer<vtkMatrix4x4>::New();
+  outputIndexToOutput->SetElement(0, 0, m_OutPutSpacing[0]);
+  outputIndexToOutput->SetElement(1, 1, m_OutPutSpacing[1]);
+  outputIndexToOutput->SetElement(2, 2, m_ZSpacing);
+  outputIndexToOutput->SetElement(0, 3, outputExtent[0] * m_OutPutSpacing[0]);
+  outputIndexToOutput->SetElement(1, 3, outputExtent[2] * m_OutPutSpacing[1]);
+  outputIndexToOutput->SetElement(2, 3, outputExtent[4] * m_ZSpacing);
+
+  // output coordinates -> input coordinates, as done by vtkImageReslice
+  auto outputToInputIndex = vtkSmartPointer<vtkMatrix4x4>::New();
+  vtkMatrix4x4::Multiply4x4(m_Reslicer->GetResliceAxes(), outputIndexToOutput, outputToInputIndex);
+
+  double inputSpacing[3];
+  inputData->GetSpacing(inputSpacing);
+  if (m_ResliceTransform.IsNotNull())
+  {
+    vtkMatrix4x4::Multiply4x4(
+      m_ResliceTransform->GetVtkTransform()->GetLinearInverse()->GetMatrix(), outputToInputIndex, outputToInputIndex);
+
+    // the input is resliced with unit spacing in this case (see GenerateData())
+    inputSpacing[0] = inputSpacing[1] = inputSpacing[2] = 1.0;
+  }
+
+  // input coordinates -> continuous input index
+  auto inputToIndex = vtkSmartPointer<vtkMatrix4x4>::New();
+  for (int i = 0; i < 3; ++i)
+  {
+    inputToIndex->SetElement(i, i, 1.0 / inputSpacing[i]);
+    inputToIndex->SetElement(i, 3, -inputData->GetOrigin()[i] / inputSpacing[i]);
+  }
+  vtkMatrix4x4::Multiply4x4(inputToIndex, outputToInputIndex, outputToInputIndex);
+
+  auto slice = vtkSmartPointer<vtkImageData>::New();
+  slice->SetExtent(
+    outputExtent[0], outputExtent[1], outputExtent[2], outputExtent[3], outputExtent[4], outputExtent[5]);
+  slice->SetSpacing(m_OutPutSpacing[0], m_OutPutSpacing[1], m_ZSpacing);
+  slice->SetOrigin(0.0, 0.0, 0.0);
+  slice->AllocateScalars(inputData->GetScalarType(), 1);
+
+  const bool sliced = accelerator->Reslice(
+    input, m_TimeStep, outputToInputIndex, m_InterpolationMode == RESLICE_LINEAR, m_BackgroundLevel, slice);
+  context->UngetService(reference);
+
+  if (!sliced)
+    return false;
+
+  m_Reslicer->GetOutput()->ShallowCopy(slice);
+  return true;
+}
+
+bool mitk::ExtractSliceFilter::DetachReslicer()
+{
+  mitk::Image *input = this->GetInput();
+  if (input == nullptr || !input->IsVolumeSet(m_TimeStep))
+    return false;
+
+  // the transform of the input geometry is updated lazily, which must not happen on several threads at once
+  vtkAbstractTransform *resliceTransform = m_Reslicer->GetResliceTransform();
+  if (resliceTransform != nullptr)
+  {
+    auto *linearTransform = vtkLinearTransform::SafeDownCast(resliceTransform);
+    if (linearTransform == nullptr)
+      return false;
+
+    auto transform = vtkSmartPointer<vtkTransform>::New();
+    transform->SetMatrix(linearTransform->GetMatrix());
+    m_Reslicer->SetResliceTransform(transform);
+  }
+
+  // a shallow copy shares the voxels, but not the pipeline information of the vtkImageData of the image
+  auto volume = vtkSmartPointer<vtkImageData>::New();
+  volume->ShallowCopy(input->GetVtkImageData(m_TimeStep));
+  if (m_ResliceTransform.IsNotNull())
+  {
+    // replaces the unit spacing filter of GenerateData()
+    volume->SetSpacing(1.0, 1.0, 1.0);
+  }
+  m_Reslicer->SetInputData(volume);
+  return true;
+}
+
+void mitk::ExtractSliceFilter::ResliceDetached()
+{
+  m_Reslicer->UpdateWholeExtent();
+  m_Reslicer->Update();
+}
+
 bool mitk::ExtractSliceFilter::GetClippedPlaneBounds(double bounds[6])
 {
   if (!m_WorldGeometry || !this->GetInput())
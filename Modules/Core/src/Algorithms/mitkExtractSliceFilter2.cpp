@@ -23,6 +23,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkLinearInterpolateImageFunction.h>
 #include <itkNearestNeighborInterpolateImageFunction.h>
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
 
 struct mitk::ExtractSliceFilter2::Impl
@@ -78,14 +80,162 @@ namespace
     result = interpolateImageFunction.GetPointer();
   }
 
+  typedef itk::ContinuousIndex<mitk::ScalarType, 3> ContinuousIndexType;
+
+  /** \brief Output pixels [first, last) of a row whose input index is inside the input region
+   *
+   * The input index of output pixel x is rowIndex + x * step. The span is solved for each dimension and then
+   * checked against the same expression the kernels use, so rounding cannot put a pixel on the wrong side.
+   */
+  void ClipRow(const ContinuousIndexType &rowIndex,
+               const ContinuousIndexType &step,
+               const double lower[3],
+               const double upper[3],
+               long xBegin,
+               long xEnd,
+               long &first,
+               long &last)
+  {
+    auto isInside = [&](long x) {
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        const double index = rowIndex[i] + x * step[i];
+        if (!(index >= lower[i] && index < upper[i]))
+          return false;
+      }
+      return true;
+    };
+
+    double from = xBegin;
+    double to = xEnd;
+
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      if (0.0 == step[i])
+      {
+        if (!(rowIndex[i] >= lower[i] && rowIndex[i] < upper[i]))
+          to = from;
+        continue;
+      }
+
+      double a = (lower[i] - rowIndex[i]) / step[i];
+      double b = (upper[i] - rowIndex[i]) / step[i];
+      if (a > b)
+        std::swap(a, b);
+
+      from = std::max(from, a);
+      to = std::min(to, b);
+    }
+
+    first = static_cast<long>(std::ceil(std::min(std::max(from, static_cast<double>(xBegin)), static_cast<double>(xEnd))));
+    last = static_cast<long>(std::ceil(std::min(std::max(to, static_cast<double>(first)), static_cast<double>(xEnd))));
+
+    while (first < last && !isInside(first))
+      ++first;
+    while (last > first && !isInside(last - 1))
+      --last;
+    if (first == last)
+      return;
+    while (first > xBegin && isInside(first - 1))
+      --first;
+    while (last < xEnd && isInside(last))
+      ++last;
+  }
+
+  template <typename TPixel>
+  void NearestNeighborRow(const TPixel *input,
+                          const long offsets[3],
+                          const long start[3],
+                          const ContinuousIndexType &rowIndex,
+                          const ContinuousIndexType &step,
+                          long first,
+                          long last,
+                          TPixel *output)
+  {
+    for (long x = first; x < last; ++x)
+    {
+      // rounds half up like itk::NearestNeighborInterpolateImageFunction
+      const long i = static_cast<long>(std::floor(rowIndex[0] + x * step[0] + 0.5)) - start[0];
+      const long j = static_cast<long>(std::floor(rowIndex[1] + x * step[1] + 0.5)) - start[1];
+      const long k = static_cast<long>(std::floor(rowIndex[2] + x * step[2] + 0.5)) - start[2];
+      output[x] = input[i * offsets[0] + j * offsets[1] + k * offsets[2]];
+    }
+  }
+
+  template <typename TPixel>
+  void LinearRow(const TPixel *input,
+                 const long offsets[3],
+                 const long start[3],
+                 const long size[3],
+                 const ContinuousIndexType &rowIndex,
+                 const ContinuousIndexType &step,
+                 long first,
+                 long last,
+                 TPixel *output)
+  {
+    long base[3], next[3];
+    double weight[3];
+
+    for (long x = first; x < last; ++x)
+    {
+      for (unsigned int d = 0; d < 3; ++d)
+      {
+        // the half pixel at the border of the input is clamped to the border pixel
+        const double index = std::max(0.0, rowIndex[d] + x * step[d] - start[d]);
+        base[d] = std::min(static_cast<long>(index), size[d] - 1);
+        next[d] = std::min(base[d] + 1, size[d] - 1);
+        weight[d] = index - base[d];
+      }
+
+      const TPixel *v00 = input + base[1] * offsets[1] + base[2] * offsets[2];
+      const TPixel *v10 = input + next[1] * offsets[1] + base[2] * offsets[2];
+      const TPixel *v01 = input + base[1] * offsets[1] + next[2] * offsets[2];
+      const TPixel *v11 = input + next[1] * offsets[1] + next[2] * offsets[2];
+      const long i0 = base[0] * offsets[0];
+      const long i1 = next[0] * offsets[0];
+
+      const double c00 = v00[i0] + weight[0] * (static_cast<double>(v00[i1]) - v00[i0]);
+      const double c10 = v10[i0] + weight[0] * (static_cast<double>(v10[i1]) - v10[i0]);
+      const double c01 = v01[i0] + weight[0] * (static_cast<double>(v01[i1]) - v01[i0]);
+      const double c11 = v11[i0] + weight[0] * (static_cast<double>(v11[i1]) - v11[i0]);
+      const double c0 = c00 + weight[1] * (c10 - c00);
+      const double c1 = c01 + weight[1] * (c11 - c01);
+
+      output[x] = static_cast<TPixel>(c0 + weight[2] * (c1 - c0));
+    }
+  }
+
+  template <typename TInputImage>
+  void InterpolateImageFunctionRow(const itk::InterpolateImageFunction<TInputImage> *interpolator,
+                                   const ContinuousIndexType &rowIndex,
+                                   const ContinuousIndexType &step,
+                                   long first,
+                                   long last,
+                                   typename TInputImage::PixelType *output)
+  {
+    typedef typename TInputImage::PixelType TPixel;
+    ContinuousIndexType index;
+
+    for (long x = first; x < last; ++x)
+    {
+      for (unsigned int d = 0; d < 3; ++d)
+        index[d] = rowIndex[d] + x * step[d];
+
+      output[x] = static_cast<TPixel>(interpolator->EvaluateAtContinuousIndex(index));
+    }
+  }
+
   template <typename TPixel, unsigned int VImageDimension>
-  void GenerateData(const itk::Image<TPixel, VImageDimension>* inputImage, mitk::Image* outputImage, const mitk::ExtractSliceFilter2::OutputImageRegionType& outputRegion, itk::Object* interpolateImageFunction)
+  void GenerateData(const itk::Image<TPixel, VImageDimension>* inputImage,
+                    mitk::Image* outputImage,
+                    const mitk::ExtractSliceFilter2::OutputImageRegionType& outputRegion,
+                    mitk::ExtractSliceFilter2::Interpolator interpolator,
+                    itk::Object* interpolateImageFunction)
   {
     typedef itk::Image<TPixel, VImageDimension> TInputImage;
     typedef itk::InterpolateImageFunction<TInputImage> TInterpolateImageFunction;
 
     auto outputGeometry = outputImage->GetSlicedGeometry()->GetPlaneGeometry(0);
-    auto interpolator = static_cast<TInterpolateImageFunction*>(interpolateImageFunction);
 
     auto origin = outputGeometry->GetOrigin();
     auto spacing = outputGeometry->GetSpacing();
@@ -98,40 +248,72 @@ namespace
     auto spacingAlongXDirection = xDirection * spacing[0];
     auto spacingAlongYDirection = yDirection * spacing[1];
 
-    const std::size_t pixelSize = outputImage->GetPixelType().GetSize();
-    const std::size_t width = outputGeometry->GetExtent(0);
-    const std::size_t xBegin = outputRegion.GetIndex(0);
-    const std::size_t yBegin = outputRegion.GetIndex(1);
-    const std::size_t xEnd = xBegin + outputRegion.GetSize(0);
-    const std::size_t yEnd = yBegin + outputRegion.GetSize(1);
+    // the mapping from output pixels to input indices is affine, so the input index changes by a constant step
+    // from pixel to pixel and from row to row
+    ContinuousIndexType originIndex, xIndex, yIndex, xStep, yStep;
+    inputImage->TransformPhysicalPointToContinuousIndex(origin, originIndex);
+    inputImage->TransformPhysicalPointToContinuousIndex(origin + spacingAlongXDirection, xIndex);
+    inputImage->TransformPhysicalPointToContinuousIndex(origin + spacingAlongYDirection, yIndex);
+
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      xStep[d] = xIndex[d] - originIndex[d];
+      yStep[d] = yIndex[d] - originIndex[d];
+    }
+
+    // a continuous index is inside if it is rounded to an index of the region, cf. itk::ImageRegion::IsInside()
+    const auto &inputRegion = inputImage->GetLargestPossibleRegion();
+    long start[3], size[3], offsets[3];
+    double lower[3], upper[3];
+
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      start[d] = inputRegion.GetIndex(d);
+      size[d] = static_cast<long>(inputRegion.GetSize(d));
+      offsets[d] = inputImage->GetOffsetTable()[d];
+      lower[d] = start[d] - 0.5;
+      upper[d] = start[d] + size[d] - 0.5;
+    }
+
+    const TPixel *input = inputImage->GetBufferPointer();
+    auto function = static_cast<const TInterpolateImageFunction*>(interpolateImageFunction);
+
+    const long width = static_cast<long>(outputGeometry->GetExtent(0));
+    const long xBegin = outputRegion.GetIndex(0);
+    const long yBegin = outputRegion.GetIndex(1);
+    const long xEnd = xBegin + static_cast<long>(outputRegion.GetSize(0));
+    const long yEnd = yBegin + static_cast<long>(outputRegion.GetSize(1));
 
     mitk::ImageWriteAccessor writeAccess(outputImage, nullptr, mitk::ImageAccessorBase::IgnoreLock);
-    auto data = static_cast<char*>(writeAccess.GetData());
+    auto data = static_cast<TPixel*>(writeAccess.GetData());
 
     const TPixel backgroundPixel = std::numeric_limits<TPixel>::lowest();
-    TPixel pixel;
+    ContinuousIndexType rowIndex;
+    long first, last;
 
-    itk::ContinuousIndex<mitk::ScalarType, 3> index;
-    mitk::Point3D yPoint;
-    mitk::Point3D point;
-
-    for (std::size_t y = yBegin; y < yEnd; ++y)
+    for (long y = yBegin; y < yEnd; ++y)
     {
-      yPoint = origin + spacingAlongYDirection * y;
+      for (unsigned int d = 0; d < 3; ++d)
+        rowIndex[d] = originIndex[d] + y * yStep[d];
+
+      TPixel *row = data + width * y;
+      ClipRow(rowIndex, xStep, lower, upper, xBegin, xEnd, first, last);
 
-      for (std::size_t x = xBegin; x < xEnd; ++x)
+      std::fill(row + xBegin, row + first, backgroundPixel);
+      std::fill(row + last, row + xEnd, backgroundPixel);
+
+      switch (interpolator)
       {
-        point = yPoint + spacingAlongXDirection * x;
-
-        if (inputImage->TransformPhysicalPointToContinuousIndex(point, index))
-        {
-          pixel = interpolator->EvaluateAtContinuousIndex(index);
-          memcpy(static_cast<void*>(data + pixelSize * (width * y + x)), static_cast<const void*>(&pixel), pixelSize);
-        }
-        else
-        {
-          memcpy(static_cast<void*>(data + pixelSize * (width * y + x)), static_cast<const void*>(&backgroundPixel), pixelSize);
-        }
+        case mitk::ExtractSliceFilter2::NearestNeighbor:
+          NearestNeighborRow(input, offsets, start, rowIndex, xStep, first, last, row);
+          break;
+
+        case mitk::ExtractSliceFilter2::Linear:
+          LinearRow(input, offsets, start, size, rowIndex, xStep, first, last, row);
+          break;
+
+        default:
+          InterpolateImageFunctionRow(function, rowIndex, xStep, first, last, row);
       }
     }
   }
@@ -212,22 +394,26 @@ void mitk::ExtractSliceFilter2::AllocateOutputs()
 void mitk::ExtractSliceFilter2::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType)
 {
   const auto* inputImage = this->GetInput();
-  AccessFixedDimensionByItk_3(inputImage, ::GenerateData, 3, this->GetOutput(), outputRegionForThread, m_Impl->InterpolateImageFunction);
+  AccessFixedDimensionByItk_n(inputImage, ::GenerateData, 3, (this->GetOutput(), outputRegionForThread, this->GetInterpolator(), m_Impl->InterpolateImageFunction.GetPointer()));
 }*/
 
 void mitk::ExtractSliceFilter2::GenerateData()
 {
-  if (nullptr != m_Impl->InterpolateImageFunction && this->GetInput()->GetMTime() < this->GetMTime())
-    return;
-
   const auto* inputImage = this->GetInput();
+  const auto interpolator = this->GetInterpolator();
 
-  AccessFixedDimensionByItk_2(inputImage, CreateInterpolateImageFunction, 3, this->GetInterpolator(), m_Impl->InterpolateImageFunction);
+  // nearest neighbor and linear interpolation sample the input directly, only the B-spline coefficients of
+  // cubic interpolation are computed in advance and kept as long as the input is not modified
+  if (Cubic == interpolator && (nullptr == m_Impl->InterpolateImageFunction ||
+                                m_Impl->InterpolateImageFunction->GetMTime() < inputImage->GetMTime()))
+  {
+    AccessFixedDimensionByItk_2(inputImage, CreateInterpolateImageFunction, 3, interpolator, m_Impl->InterpolateImageFunction);
+  }
 
   this->AllocateOutputs();
   auto outputRegion = this->GetOutput()->GetLargestPossibleRegion();
 
-  AccessFixedDimensionByItk_3(inputImage, ::GenerateData, 3, this->GetOutput(), outputRegion, m_Impl->InterpolateImageFunction);
+  AccessFixedDimensionByItk_n(inputImage, ::GenerateData, 3, (this->GetOutput(), outputRegion, interpolator, m_Impl->InterpolateImageFunction.GetPointer()));
 }
 
 void mitk::ExtractSliceFilter2::SetInput(const InputImageType* image)
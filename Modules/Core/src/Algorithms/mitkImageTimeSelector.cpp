@@ -72,9 +72,14 @@ void mitk::ImageTimeSelector::GenerateData()
   // do we really need a complete volume at a time?
   if (requestedRegion.GetSize(2) > 1)
   {
-    mitk::ImageDataItem::Pointer im = this->GetVolumeData(m_TimeNr, m_ChannelNr)->Clone();
+    mitk::ImageDataItem::Pointer volume = this->GetVolumeData(m_TimeNr, m_ChannelNr);
+    mitk::ImageDataItem::Pointer im = volume->ShareData();
+    if (im.IsNull())
+    {
+      im = volume->Clone();
+      im->SetManageMemory(false);
+    }
     im->SetTimestep(0);
-    im->SetManageMemory(false);
     this->SetVolumeItem(im, 0);
   }
   else
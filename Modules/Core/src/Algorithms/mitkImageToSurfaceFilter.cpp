@@ -16,7 +16,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkException.h"
 #include <mitkImageToSurfaceFilter.h>
+#include <vtkAppendPolyData.h>
 #include <vtkDecimatePro.h>
+#include <vtkExtractVOI.h>
+#include <vtkFlyingEdges3D.h>
 #include <vtkImageChangeInformation.h>
 #include <vtkImageData.h>
 #include <vtkLinearTransform.h>
@@ -30,6 +33,152 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkProgressBar.h"
 
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  /** Thinner slabs are not worth a thread of their own. */
+  const int MinimumNumberOfSlicesPerSlab = 8;
+
+  template <typename TScalar>
+  bool ComputeForegroundExtent(const TScalar *scalars, const int extent[6], double threshold, int foregroundExtent[6])
+  {
+    foregroundExtent[0] = foregroundExtent[2] = foregroundExtent[4] = VTK_INT_MAX;
+    foregroundExtent[1] = foregroundExtent[3] = foregroundExtent[5] = VTK_INT_MIN;
+
+    const TScalar *scalar = scalars;
+    for (int z = extent[4]; z <= extent[5]; ++z)
+    {
+      for (int y = extent[2]; y <= extent[3]; ++y)
+      {
+        for (int x = extent[0]; x <= extent[1]; ++x, ++scalar)
+        {
+          if (static_cast<double>(*scalar) >= threshold)
+          {
+            foregroundExtent[0] = std::min(foregroundExtent[0], x);
+            foregroundExtent[1] = std::max(foregroundExtent[1], x);
+            foregroundExtent[2] = std::min(foregroundExtent[2], y);
+            foregroundExtent[3] = std::max(foregroundExtent[3], y);
+            foregroundExtent[4] = std::min(foregroundExtent[4], z);
+            foregroundExtent[5] = std::max(foregroundExtent[5], z);
+          }
+        }
+      }
+    }
+    return foregroundExtent[0] <= foregroundExtent[1];
+  }
+
+  /** Computes the extent of all voxels at or above the threshold, grown by one voxel so that
+   *  every cell crossed by the isosurface is kept. Falls back to the whole extent if the image
+   *  cannot be scanned or contains no such voxel. */
+  void ComputeIsosurfaceExtent(vtkImageData *image, double threshold, int isosurfaceExtent[6])
+  {
+    int wholeExtent[6];
+    image->GetExtent(wholeExtent);
+    std::copy(wholeExtent, wholeExtent + 6, isosurfaceExtent);
+
+    if (image->GetNumberOfScalarComponents() != 1)
+      return;
+
+    int foregroundExtent[6];
+    bool found = false;
+    switch (image->GetScalarType())
+    {
+      vtkTemplateMacro(found = ComputeForegroundExtent(
+                         static_cast<VTK_TT *>(image->GetScalarPointer()), wholeExtent, threshold, foregroundExtent));
+      default:
+        break;
+    }
+
+    if (!found)
+      return;
+
+    for (int i = 0; i < 6; i += 2)
+    {
+      isosurfaceExtent[i] = std::max(wholeExtent[i], foregroundExtent[i] - 1);
+      isosurfaceExtent[i + 1] = std::min(wholeExtent[i + 1], foregroundExtent[i + 1] + 1);
+    }
+  }
+
+  /** Extracts the isosurface with flying edges. The image is cropped to the isosurface extent and
+   *  split into z-slabs sharing their boundary slice, which are processed in parallel. The seam
+   *  points of neighbouring slabs are merged afterwards. */
+  vtkSmartPointer<vtkPolyData> ExtractIsosurface(vtkImageData *image, double threshold, int numberOfThreads)
+  {
+    int wholeExtent[6];
+    image->GetExtent(wholeExtent);
+    int extent[6];
+    ComputeIsosurfaceExtent(image, threshold, extent);
+
+    const int numberOfCellSlices = extent[5] - extent[4];
+    const int numberOfSlabs =
+      std::max(1, std::min(numberOfThreads, numberOfCellSlices / MinimumNumberOfSlicesPerSlab));
+
+    std::vector<vtkSmartPointer<vtkFlyingEdges3D>> extractors(numberOfSlabs);
+    for (int i = 0; i < numberOfSlabs; ++i)
+    {
+      int slabExtent[6];
+      std::copy(extent, extent + 6, slabExtent);
+      slabExtent[4] = extent[4] + numberOfCellSlices * i / numberOfSlabs;
+      slabExtent[5] = extent[4] + numberOfCellSlices * (i + 1) / numberOfSlabs;
+
+      extractors[i] = vtkSmartPointer<vtkFlyingEdges3D>::New();
+      extractors[i]->ComputeScalarsOff();
+      extractors[i]->ComputeNormalsOff();
+      extractors[i]->ComputeGradientsOff();
+      extractors[i]->SetValue(0, threshold);
+
+      if (std::equal(slabExtent, slabExtent + 6, wholeExtent))
+      {
+        extractors[i]->SetInputData(image);
+      }
+      else
+      {
+        // Cropping copies the slab, so the extractors do not share their input
+        auto cropFilter = vtkSmartPointer<vtkExtractVOI>::New();
+        cropFilter->SetInputData(image);
+        cropFilter->SetVOI(slabExtent);
+        cropFilter->Update();
+        extractors[i]->SetInputData(cropFilter->GetOutput());
+      }
+    }
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < numberOfSlabs; ++i)
+    {
+      threads.emplace_back([&extractors, i]() { extractors[i]->Update(); });
+    }
+    extractors[0]->Update();
+    for (auto &thread : threads)
+    {
+      thread.join();
+    }
+
+    if (numberOfSlabs == 1)
+    {
+      return extractors[0]->GetOutput();
+    }
+
+    auto appendFilter = vtkSmartPointer<vtkAppendPolyData>::New();
+    for (const auto &extractor : extractors)
+    {
+      appendFilter->AddInputData(extractor->GetOutput());
+    }
+
+    auto seamMergeFilter = vtkSmartPointer<vtkCleanPolyData>::New();
+    seamMergeFilter->SetInputConnection(appendFilter->GetOutputPort());
+    seamMergeFilter->PieceInvariantOff();
+    seamMergeFilter->ConvertLinesToPointsOff();
+    seamMergeFilter->ConvertPolysToLinesOff();
+    seamMergeFilter->ConvertStripsToPolysOff();
+    seamMergeFilter->PointMergingOn();
+    seamMergeFilter->Update();
+    return seamMergeFilter->GetOutput();
+  }
+}
+
 mitk::ImageToSurfaceFilter::ImageToSurfaceFilter()
   : m_Smooth(false),
     m_Decimate(NoDecimation),
@@ -52,24 +201,20 @@ void mitk::ImageToSurfaceFilter::CreateSurface(int time,
   vtkImageChangeInformation *indexCoordinatesImageFilter = vtkImageChangeInformation::New();
   indexCoordinatesImageFilter->SetInputData(vtkimage);
   indexCoordinatesImageFilter->SetOutputOrigin(0.0, 0.0, 0.0);
+  indexCoordinatesImageFilter->Update();
 
-  // MarchingCube -->create Surface
-  vtkSmartPointer<vtkMarchingCubes> skinExtractor = vtkSmartPointer<vtkMarchingCubes>::New();
-  skinExtractor->ComputeScalarsOff();
-  skinExtractor->SetInputConnection(indexCoordinatesImageFilter->GetOutputPort()); // RC++
-  indexCoordinatesImageFilter->Delete();
-  skinExtractor->SetValue(0, threshold);
-
-  vtkPolyData *polydata;
-  skinExtractor->Update();
-  polydata = skinExtractor->GetOutput();
+  // Flying edges -->create Surface
+  vtkSmartPointer<vtkPolyData> isosurface =
+    ExtractIsosurface(indexCoordinatesImageFilter->GetOutput(), threshold, this->GetNumberOfThreads());
+  vtkPolyData *polydata = isosurface;
   polydata->Register(nullptr); // RC++
+  indexCoordinatesImageFilter->Delete();
 
   if (m_Smooth)
   {
     vtkSmoothPolyDataFilter *smoother = vtkSmoothPolyDataFilter::New();
     // read poly1 (poly1 can be the original polygon, or the decimated polygon)
-    smoother->SetInputConnection(skinExtractor->GetOutputPort()); // RC++
+    smoother->SetInputData(polydata); // RC++
     smoother->SetNumberOfIterations(m_SmoothIteration);
     smoother->SetRelaxationFactor(m_SmoothRelaxation);
     smoother->SetFeatureAngle(60);
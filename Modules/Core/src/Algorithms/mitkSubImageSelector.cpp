@@ -38,12 +38,23 @@ mitk::Image::ImageDataItemPointer mitk::SubImageSelector::GetChannelData(int n)
   return input->GetChannelData(n);
 }
 
+mitk::Image::ImageDataItemPointer mitk::SubImageSelector::ShareItem(mitk::Image::ImageDataItemPointer dataItem)
+{
+  if (dataItem.IsNull())
+    return dataItem;
+
+  // reference the memory of the input copy-on-write, so that writing to the
+  // output does not modify the input (and vice versa)
+  mitk::Image::ImageDataItemPointer sharedItem = dataItem->ShareData();
+  return sharedItem.IsNotNull() ? sharedItem : dataItem;
+}
+
 void mitk::SubImageSelector::SetChannelItem(mitk::Image::ImageDataItemPointer dataItem, int n)
 {
   mitk::Image::Pointer output = this->GetOutput();
   if (output->IsValidChannel(n) == false)
     return;
-  output->m_Channels[n] = dataItem;
+  output->m_Channels[n] = ShareItem(dataItem);
 }
 
 void mitk::SubImageSelector::SetVolumeItem(mitk::Image::ImageDataItemPointer dataItem, int t, int n)
@@ -53,7 +64,7 @@ void mitk::SubImageSelector::SetVolumeItem(mitk::Image::ImageDataItemPointer dat
     return;
   int pos;
   pos = output->GetVolumeIndex(t, n);
-  output->m_Volumes[pos] = dataItem;
+  output->m_Volumes[pos] = ShareItem(dataItem);
 }
 
 void mitk::SubImageSelector::SetSliceItem(mitk::Image::ImageDataItemPointer dataItem, int s, int t, int n)
@@ -63,7 +74,7 @@ void mitk::SubImageSelector::SetSliceItem(mitk::Image::ImageDataItemPointer data
     return;
   int pos;
   pos = output->GetSliceIndex(s, t, n);
-  output->m_Slices[pos] = dataItem;
+  output->m_Slices[pos] = ShareItem(dataItem);
 }
 
 mitk::SubImageSelector::SubImageSelector()
@@ -21,6 +21,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <vtkImageData.h>
 #include <vtkImageStencil.h>
+#include <vtkImageStencilData.h>
+#include <vtkMatrix4x4.h>
 #include <vtkPointData.h>
 #include <vtkPolyData.h>
 #include <vtkPolyDataNormals.h>
@@ -29,8 +31,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkTransform.h>
 #include <vtkTransformPolyDataFilter.h>
 
+#include <algorithm>
+#include <thread>
+
 mitk::SurfaceToImageFilter::SurfaceToImageFilter()
-  : m_MakeOutputBinary(false), m_UShortBinaryPixelType(false), m_BackgroundValue(-10000), m_Tolerance(0.0)
+  : m_MakeOutputBinary(false), m_UShortBinaryPixelType(false), m_BackgroundValue(-10000), m_Tolerance(0.0), m_ReuseStencil(false)
 {
 }
 
@@ -174,12 +179,6 @@ void mitk::SurfaceToImageFilter::Stencil3DImage(int time)
 
     normalsFilter->SetInputConnection(move->GetOutputPort());
 
-    vtkSmartPointer<vtkPolyDataToImageStencil> surfaceConverter = vtkSmartPointer<vtkPolyDataToImageStencil>::New();
-    surfaceConverter->SetTolerance(m_Tolerance);
-    surfaceConverter->ReleaseDataFlagOn();
-
-    surfaceConverter->SetInputConnection(normalsFilter->GetOutputPort());
-
     vtkImageData *image = m_MakeOutputBinary ? binaryImage->GetVtkImageData() :
                                                const_cast<mitk::Image *>(this->GetImage())->GetVtkImageData(time);
 
@@ -191,12 +190,47 @@ void mitk::SurfaceToImageFilter::Stencil3DImage(int time)
       image->GetPointData()->GetScalars()->SetTuple1(i, inval);
     }
 
+    // Voxelize the surface, or reuse the voxelization of a previous run
+    double transformElements[16];
+    vtkMatrix4x4::DeepCopy(transformElements, transform->GetMatrix());
+    int extent[6];
+    image->GetExtent(extent);
+
+    if (m_CachedStencils.size() <= static_cast<std::size_t>(time))
+    {
+      m_CachedStencils.resize(time + 1);
+    }
+    CachedStencil &cachedStencil = m_CachedStencils[time];
+
+    vtkSmartPointer<vtkImageStencilData> stencilData;
+    if (m_ReuseStencil &&
+        cachedStencil.Matches(polydata, polydata->GetMTime(), transformElements, extent, m_Tolerance))
+    {
+      stencilData = cachedStencil.Stencil;
+    }
+    else
+    {
+      normalsFilter->Update();
+      stencilData = this->ComputeStencil(normalsFilter->GetOutput(), image);
+
+      cachedStencil = CachedStencil();
+      if (m_ReuseStencil)
+      {
+        cachedStencil.Stencil = stencilData;
+        cachedStencil.PolyData = polydata;
+        cachedStencil.PolyDataMTime = polydata->GetMTime();
+        std::copy(transformElements, transformElements + 16, cachedStencil.Transform);
+        std::copy(extent, extent + 6, cachedStencil.Extent);
+        cachedStencil.Tolerance = m_Tolerance;
+      }
+    }
+
     // Create stencil and use numerical minimum of pixel type as background value
     vtkSmartPointer<vtkImageStencil> stencil = vtkSmartPointer<vtkImageStencil>::New();
     stencil->SetInputData(image);
     stencil->ReverseStencilOff();
     stencil->ReleaseDataFlagOn();
-    stencil->SetStencilConnection(surfaceConverter->GetOutputPort());
+    stencil->SetStencilData(stencilData);
 
     stencil->SetBackgroundValue(m_MakeOutputBinary ? 0 : m_BackgroundValue);
     stencil->Update();
@@ -211,6 +245,79 @@ void mitk::SurfaceToImageFilter::Stencil3DImage(int time)
   }
 }
 
+vtkSmartPointer<vtkImageStencilData> mitk::SurfaceToImageFilter::ComputeStencil(vtkPolyData *polydata,
+                                                                                 vtkImageData *image) const
+{
+  // The polydata is given in index coordinates, hence unit spacing and zero origin
+  int extent[6];
+  image->GetExtent(extent);
+
+  const int numberOfSlices = extent[5] - extent[4] + 1;
+  const int numberOfSlabs = std::max(1, std::min(static_cast<int>(this->GetNumberOfThreads()), numberOfSlices));
+
+  std::vector<vtkSmartPointer<vtkPolyDataToImageStencil>> surfaceConverters(numberOfSlabs);
+  for (int i = 0; i < numberOfSlabs; ++i)
+  {
+    int slabExtent[6];
+    std::copy(extent, extent + 6, slabExtent);
+    slabExtent[4] = extent[4] + numberOfSlices * i / numberOfSlabs;
+    slabExtent[5] = extent[4] + numberOfSlices * (i + 1) / numberOfSlabs - 1;
+
+    // vtkPolyDataToImageStencil traverses the cell arrays of its input, so
+    // converters running in parallel must not share the polydata.
+    vtkSmartPointer<vtkPolyData> input = polydata;
+    if (numberOfSlabs > 1)
+    {
+      input = vtkSmartPointer<vtkPolyData>::New();
+      input->DeepCopy(polydata);
+    }
+
+    surfaceConverters[i] = vtkSmartPointer<vtkPolyDataToImageStencil>::New();
+    surfaceConverters[i]->SetTolerance(m_Tolerance);
+    surfaceConverters[i]->SetOutputOrigin(0.0, 0.0, 0.0);
+    surfaceConverters[i]->SetOutputSpacing(1.0, 1.0, 1.0);
+    surfaceConverters[i]->SetOutputWholeExtent(slabExtent);
+    surfaceConverters[i]->SetInputData(input);
+  }
+
+  std::vector<std::thread> threads;
+  for (int i = 1; i < numberOfSlabs; ++i)
+  {
+    threads.emplace_back([&surfaceConverters, i]() { surfaceConverters[i]->Update(); });
+  }
+  surfaceConverters[0]->Update();
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+
+  if (numberOfSlabs == 1)
+  {
+    return surfaceConverters[0]->GetOutput();
+  }
+
+  auto stencilData = vtkSmartPointer<vtkImageStencilData>::New();
+  stencilData->SetOrigin(0.0, 0.0, 0.0);
+  stencilData->SetSpacing(1.0, 1.0, 1.0);
+  stencilData->SetExtent(extent);
+  stencilData->AllocateExtents();
+  for (const auto &surfaceConverter : surfaceConverters)
+  {
+    stencilData->Add(surfaceConverter->GetOutput());
+  }
+  return stencilData;
+}
+
+bool mitk::SurfaceToImageFilter::CachedStencil::Matches(const vtkPolyData *polydata,
+                                                        vtkMTimeType polyDataMTime,
+                                                        const double transform[16],
+                                                        const int extent[6],
+                                                        double tolerance) const
+{
+  return Stencil != nullptr && PolyData == polydata && PolyDataMTime == polyDataMTime && Tolerance == tolerance &&
+         std::equal(Transform, Transform + 16, transform) && std::equal(Extent, Extent + 6, extent);
+}
+
 const mitk::Surface *mitk::SurfaceToImageFilter::GetInput(void)
 {
   if (this->GetNumberOfInputs() < 1)
@@ -18,7 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkRenderingManager.h>
 
 mitk::LimitedLinearUndo::LimitedLinearUndo()
-: m_UndoLimit(0)
+: m_UndoLimit(0), m_MemoryLimit(0)
 {
   // nothing to do
 }
@@ -53,13 +53,8 @@ bool mitk::LimitedLinearUndo::SetOperationEvent(UndoStackItem *stackItem)
     InvokeEvent(RedoEmptyEvent());
   }
 
-  if (0 != m_UndoLimit && m_UndoList.size() == m_UndoLimit)
-  {
-    auto item = m_UndoList.front();
-    m_UndoList.pop_front();
-    delete item;
-  }
   m_UndoList.push_back(operationEvent);
+  this->EnforceLimits();
 
   InvokeEvent(UndoNotEmptyEvent());
 
@@ -186,11 +181,61 @@ void mitk::LimitedLinearUndo::SetUndoLimit(std::size_t undoLimit)
 {
   if (undoLimit != m_UndoLimit)
   {
-    if (m_UndoList.size() > undoLimit)
+    m_UndoLimit = undoLimit;
+    this->EnforceLimits();
+  }
+}
+
+std::size_t mitk::LimitedLinearUndo::GetMemoryLimit() const
+{
+  return m_MemoryLimit;
+}
+
+void mitk::LimitedLinearUndo::SetMemoryLimit(std::size_t memoryLimit)
+{
+  if (memoryLimit != m_MemoryLimit)
+  {
+    m_MemoryLimit = memoryLimit;
+    this->EnforceLimits();
+  }
+}
+
+std::size_t mitk::LimitedLinearUndo::GetMemorySize() const
+{
+  std::size_t size = 0;
+  for (const auto item : m_UndoList)
+    size += item->GetMemorySize();
+  for (const auto item : m_RedoList)
+    size += item->GetMemorySize();
+  return size;
+}
+
+void mitk::LimitedLinearUndo::EnforceLimits()
+{
+  bool dropped = false;
+
+  while (0 != m_UndoLimit && m_UndoList.size() > m_UndoLimit)
+  {
+    delete m_UndoList.front();
+    m_UndoList.pop_front();
+    dropped = true;
+  }
+
+  if (0 != m_MemoryLimit)
+  {
+    std::size_t size = this->GetMemorySize();
+    while (size > m_MemoryLimit && m_UndoList.size() > 1)
     {
-      m_UndoList.erase(m_UndoList.begin(), m_UndoList.end() - undoLimit);
+      size -= m_UndoList.front()->GetMemorySize();
+      delete m_UndoList.front();
+      m_UndoList.pop_front();
+      dropped = true;
     }
-    m_UndoLimit = undoLimit;
+  }
+
+  if (dropped && m_UndoList.empty())
+  {
+    InvokeEvent(UndoEmptyEvent());
   }
 }
 
@@ -0,0 +1,83 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#include "mitkModuleActivationProfile.h"
+
+#include <usAny.h>
+#include <usModule.h>
+#include <usModuleRegistry.h>
+
+#include <algorithm>
+#include <iomanip>
+
+std::vector<mitk::ModuleActivationProfile::Entry> mitk::ModuleActivationProfile::GetEntries()
+{
+  std::vector<Entry> entries;
+
+  for (us::Module *module : us::ModuleRegistry::GetLoadedModules())
+  {
+    Entry entry;
+    entry.ModuleName = module->GetName();
+    entry.Lazy = module->GetProperty(us::Module::PROP_ACTIVATION_POLICY()).ToString() == "lazy";
+    entry.Pending = module->IsActivationPending();
+    entry.ActivationTime = 0.0;
+
+    us::Any time = module->GetProperty(us::Module::PROP_ACTIVATION_TIME());
+    if (time.Type() == typeid(double))
+      entry.ActivationTime = us::any_cast<double>(time);
+
+    entries.push_back(entry);
+  }
+
+  std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+    return a.ActivationTime > b.ActivationTime;
+  });
+
+  return entries;
+}
+
+void mitk::ModuleActivationProfile::Print(std::ostream &os)
+{
+  const std::vector<Entry> entries = GetEntries();
+
+  std::size_t width = 6;
+  for (const Entry &entry : entries)
+    width = std::max(width, entry.ModuleName.size());
+
+  double total = 0.0;
+  unsigned int pending = 0;
+
+  os << std::left << std::setw(static_cast<int>(width)) << "Module"
+     << "  Activation [ms]  Policy\n";
+  for (const Entry &entry : entries)
+  {
+    os << std::left << std::setw(static_cast<int>(width)) << entry.ModuleName << "  " << std::right
+       << std::setw(15);
+    if (entry.Pending)
+      os << "pending";
+    else
+      os << std::fixed << std::setprecision(2) << entry.ActivationTime;
+    os << "  " << (entry.Lazy ? "lazy" : "eager") << "\n";
+
+    total += entry.ActivationTime;
+    if (entry.Pending)
+      ++pending;
+  }
+
+  os << entries.size() << " modules, " << pending << " pending, total activation time " << std::fixed
+     << std::setprecision(2) << total << " ms\n";
+}
@@ -76,6 +76,11 @@ void mitk::UndoStackItem::ReverseAndExecute()
   ReverseOperations();
 }
 
+std::size_t mitk::UndoStackItem::GetMemorySize() const
+{
+  return sizeof(*this) + m_Description.capacity();
+}
+
 // ******************** mitk::OperationEvent ********************
 
 mitk::Operation *mitk::OperationEvent::GetOperation()
@@ -152,3 +157,13 @@ bool mitk::OperationEvent::IsValid()
 {
   return !m_Invalid;
 }
+
+std::size_t mitk::OperationEvent::GetMemorySize() const
+{
+  std::size_t size = UndoStackItem::GetMemorySize();
+  if (m_Operation != nullptr)
+    size += m_Operation->GetMemorySize();
+  if (m_UndoOperation != nullptr)
+    size += m_UndoOperation->GetMemorySize();
+  return size;
+}
@@ -31,6 +31,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkVtkPropRenderer.h>
 
 #include <algorithm>
+#include <cmath>
 
 namespace mitk
 {
@@ -48,6 +49,8 @@ namespace mitk
       m_TimeNavigationController(SliceNavigationController::New()),
       m_DataStorage(nullptr),
       m_ConstrainedPanningZooming(true),
+      m_MinimumFrameInterval(1000.0 / 60.0),
+      m_RenderingTimeBudget(1000.0 / 60.0),
       m_FocusedRenderWindow(nullptr)
   {
     m_ShadingEnabled.assign(3, false);
@@ -164,6 +167,8 @@ namespace mitk
   {
     if (m_RenderWindowList.erase(renderWindow))
     {
+      m_RenderingTimes.erase(renderWindow);
+
       auto callbacks_it = this->m_RenderWindowCallbacksList.find(renderWindow);
       if (callbacks_it != this->m_RenderWindowCallbacksList.end())
       {
@@ -518,9 +523,36 @@ namespace mitk
     return m_TimeNavigationController.GetPointer();
   }
 
+  double RenderingManager::GetLastRenderingTime(vtkRenderWindow *renderWindow) const
+  {
+    auto it = m_RenderingTimes.find(renderWindow);
+    return it != m_RenderingTimes.cend() ? it->second.Last : 0.0;
+  }
+
+  double RenderingManager::GetAverageRenderingTime(vtkRenderWindow *renderWindow) const
+  {
+    auto it = m_RenderingTimes.find(renderWindow);
+    return it != m_RenderingTimes.cend() ? it->second.Average : 0.0;
+  }
+
   void RenderingManager::ExecutePendingRequests()
   {
+    // Requests arriving within the current frame are coalesced into the next one; they stay
+    // pending, so RequestUpdate does not generate further events in the meantime
+    const Clock::time_point now = Clock::now();
+    const double sinceLastFrame = std::chrono::duration<double, std::milli>(now - m_LastFrameTime).count();
+    if (m_MinimumFrameInterval > 0.0 && sinceLastFrame >= 0.0 && sinceLastFrame < m_MinimumFrameInterval)
+    {
+      const auto delay = static_cast<unsigned int>(std::ceil(m_MinimumFrameInterval - sinceLastFrame));
+      m_UpdatePending = true;
+      if (this->GenerateDelayedRenderingRequestEvent(delay))
+      {
+        return;
+      }
+    }
+
     m_UpdatePending = false;
+    m_LastFrameTime = now;
 
     // Satisfy all pending update requests
     RenderWindowList::const_iterator it;
@@ -543,6 +575,7 @@ namespace mitk
     if (renderWindow)
     {
       renderWindowList[renderWindow] = RENDERING_INPROGRESS;
+      renman->m_RenderingTimes[renderWindow].Start = Clock::now();
     }
 
     renman->m_UpdatePending = false;
@@ -584,12 +617,19 @@ namespace mitk
       {
         renderWindowList[renderer->GetRenderWindow()] = RENDERING_INACTIVE;
 
-        // Level-of-Detail handling
+        RenderingTime &renderingTime = renman->m_RenderingTimes[renderWindow];
+        renderingTime.Last = std::chrono::duration<double, std::milli>(Clock::now() - renderingTime.Start).count();
+        renderingTime.Average = renderingTime.Average > 0.0
+                                  ? 0.8 * renderingTime.Average + 0.2 * renderingTime.Last
+                                  : renderingTime.Last;
+
+        // Level-of-Detail handling: after a full quality frame, the interaction LOD is
+        // only used again if the window cannot be rendered within the budget
         if (renderer->GetNumberOfVisibleLODEnabledMappers() > 0)
         {
           if (nextLODMap[renderer] == 0)
             renman->StartOrResetTimer();
-          else
+          else if (renderingTime.Last > renman->m_RenderingTimeBudget)
             nextLODMap[renderer] = 0;
         }
       }
@@ -0,0 +1,420 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTaskScheduler.h"
+
+#include <mitkLogMacros.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <map>
+#include <thread>
+
+namespace
+{
+  struct Worker
+  {
+    std::mutex Mutex;
+    std::deque<mitk::TaskScheduler::TaskPointer> Queues[mitk::TaskScheduler::NumberOfPriorities];
+    std::thread Thread;
+  };
+
+  struct ResourceUse
+  {
+    unsigned int Readers = 0;
+    bool Written = false;
+    std::deque<mitk::TaskScheduler::TaskPointer> Waiting;
+  };
+
+  thread_local const void *CurrentScheduler = nullptr;
+  thread_local Worker *CurrentWorker = nullptr;
+  thread_local mitk::Task *CurrentTask = nullptr;
+}
+
+class mitk::TaskScheduler::Impl
+{
+public:
+  explicit Impl(TaskScheduler *scheduler) : Scheduler(scheduler), NumberOfQueuedTasks(0), Stop(false) {}
+
+  void Push(const TaskPointer &task)
+  {
+    if (CurrentScheduler == Scheduler && CurrentWorker != nullptr)
+    {
+      // counted first, so that a thief finding the task never sees a negative count
+      {
+        std::lock_guard<std::mutex> lock(Mutex);
+        ++NumberOfQueuedTasks;
+      }
+
+      // subtasks stay with their worker, which is likely to have their data in its cache
+      std::lock_guard<std::mutex> lock(CurrentWorker->Mutex);
+      CurrentWorker->Queues[task->m_Priority].push_back(task);
+    }
+    else
+    {
+      std::lock_guard<std::mutex> lock(Mutex);
+      ++NumberOfQueuedTasks;
+      Queues[task->m_Priority].push_back(task);
+    }
+
+    WakeUp.notify_one();
+  }
+
+  TaskPointer Pop(Worker *worker)
+  {
+    for (int priority = 0; priority < NumberOfPriorities; ++priority)
+    {
+      TaskPointer task;
+
+      // the own queue newest first, everything else oldest first
+      if (worker != nullptr)
+      {
+        std::lock_guard<std::mutex> lock(worker->Mutex);
+        if (!worker->Queues[priority].empty())
+        {
+          task = worker->Queues[priority].back();
+          worker->Queues[priority].pop_back();
+        }
+      }
+
+      if (!task)
+      {
+        std::lock_guard<std::mutex> lock(Mutex);
+        if (!Queues[priority].empty())
+        {
+          task = Queues[priority].front();
+          Queues[priority].pop_front();
+        }
+      }
+
+      for (std::size_t i = 0; !task && i < Workers.size(); ++i)
+      {
+        Worker *victim = Workers[i].get();
+        if (victim == worker)
+          continue;
+
+        std::lock_guard<std::mutex> lock(victim->Mutex);
+        if (!victim->Queues[priority].empty())
+        {
+          task = victim->Queues[priority].front();
+          victim->Queues[priority].pop_front();
+        }
+      }
+
+      if (task)
+      {
+        std::lock_guard<std::mutex> lock(Mutex);
+        --NumberOfQueuedTasks;
+        return task;
+      }
+    }
+
+    return nullptr;
+  }
+
+  /** Acquires all resources of the task, or parks it as queued at the first one in use. */
+  bool Acquire(const TaskPointer &task)
+  {
+    std::lock_guard<std::mutex> lock(ResourceMutex);
+
+    for (const auto &resource : task->m_Resources)
+    {
+      auto iter = Resources.find(resource.first);
+      if (iter == Resources.end())
+        continue;
+
+      const bool write = resource.second;
+      if (iter->second.Written || (write && iter->second.Readers > 0))
+      {
+        // set before parking, a Release() right after unlocking pushes the task again
+        task->m_State = Task::Queued;
+        iter->second.Waiting.push_back(task);
+        return false;
+      }
+    }
+
+    for (const auto &resource : task->m_Resources)
+    {
+      ResourceUse &use = Resources[resource.first];
+      if (resource.second)
+        use.Written = true;
+      else
+        ++use.Readers;
+    }
+    return true;
+  }
+
+  void Release(const TaskPointer &task)
+  {
+    std::vector<TaskPointer> waiting;
+    {
+      std::lock_guard<std::mutex> lock(ResourceMutex);
+      for (const auto &resource : task->m_Resources)
+      {
+        auto iter = Resources.find(resource.first);
+        if (iter == Resources.end())
+          continue;
+
+        if (resource.second)
+          iter->second.Written = false;
+        else if (iter->second.Readers > 0)
+          --iter->second.Readers;
+
+        if (!iter->second.Written && iter->second.Readers == 0)
+        {
+          waiting.insert(waiting.end(), iter->second.Waiting.begin(), iter->second.Waiting.end());
+          Resources.erase(iter);
+        }
+      }
+    }
+
+    // the parked tasks compete for the resources again
+    for (const auto &waitingTask : waiting)
+      this->Push(waitingTask);
+  }
+
+  void Run(const TaskPointer &task)
+  {
+    Task::State expected = Task::Queued;
+    if (!task->m_State.compare_exchange_strong(expected, Task::Running))
+      return; // canceled while queued
+
+    if (!this->Acquire(task))
+    {
+      // Cancel() may have been called while the task was briefly running
+      if (task->IsCanceled())
+        task->Cancel();
+      return;
+    }
+
+    Task *previousTask = CurrentTask;
+    CurrentTask = task.get();
+    try
+    {
+      task->m_Function();
+    }
+    catch (const std::exception &e)
+    {
+      MITK_ERROR << "Task failed: " << e.what();
+    }
+    catch (...)
+    {
+      MITK_ERROR << "Task failed with an unknown exception.";
+    }
+    CurrentTask = previousTask;
+
+    // the function and its captures are not needed any more
+    task->m_Function = nullptr;
+
+    this->Release(task);
+    task->SetDone(task->IsCanceled() ? Task::Canceled : Task::Finished);
+  }
+
+  void WorkerLoop(Worker *worker)
+  {
+    CurrentScheduler = Scheduler;
+    CurrentWorker = worker;
+
+    for (;;)
+    {
+      TaskPointer task = this->Pop(worker);
+      if (task)
+      {
+        this->Run(task);
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(Mutex);
+      WakeUp.wait(lock, [this] { return Stop || NumberOfQueuedTasks > 0; });
+      if (Stop)
+        break;
+    }
+  }
+
+  TaskScheduler *Scheduler;
+  std::vector<std::unique_ptr<Worker>> Workers;
+
+  std::mutex Mutex;
+  std::condition_variable WakeUp;
+  std::deque<TaskPointer> Queues[NumberOfPriorities];
+  long NumberOfQueuedTasks;
+  bool Stop;
+
+  std::mutex ResourceMutex;
+  std::map<const void *, ResourceUse> Resources;
+};
+
+bool mitk::Task::IsDone() const
+{
+  const State state = m_State.load();
+  return state == Finished || state == Canceled;
+}
+
+bool mitk::Task::Cancel()
+{
+  m_CancelRequested = true;
+
+  State expected = Queued;
+  if (!m_State.compare_exchange_strong(expected, Canceled))
+    return false;
+
+  // the queues hold on to the task until a worker drops it, but not to its captures
+  m_Function = nullptr;
+  this->SetDone(Canceled);
+  return true;
+}
+
+void mitk::Task::Wait()
+{
+  if (m_Scheduler != nullptr && m_Scheduler->IsWorkerThread())
+  {
+    while (!this->IsDone())
+    {
+      if (!m_Scheduler->RunPendingTask())
+      {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Done.wait_for(lock, std::chrono::milliseconds(1), [this] { return this->IsDone(); });
+      }
+    }
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_Done.wait(lock, [this] { return this->IsDone(); });
+}
+
+void mitk::Task::SetDone(State state)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_State = state;
+  }
+  m_Done.notify_all();
+}
+
+mitk::TaskScheduler *mitk::TaskScheduler::GetInstance()
+{
+  static TaskScheduler instance;
+  return &instance;
+}
+
+mitk::TaskScheduler::TaskScheduler(unsigned int numberOfThreads) : d(new Impl(this))
+{
+  if (numberOfThreads == 0)
+    numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  for (unsigned int i = 0; i < numberOfThreads; ++i)
+    d->Workers.push_back(std::unique_ptr<Worker>(new Worker));
+
+  for (auto &worker : d->Workers)
+  {
+    Worker *workerPointer = worker.get();
+    worker->Thread = std::thread([this, workerPointer] { d->WorkerLoop(workerPointer); });
+  }
+}
+
+mitk::TaskScheduler::~TaskScheduler()
+{
+  std::vector<TaskPointer> queued;
+  {
+    std::lock_guard<std::mutex> lock(d->Mutex);
+    d->Stop = true;
+    for (auto &queue : d->Queues)
+      queued.insert(queued.end(), queue.begin(), queue.end());
+  }
+  for (auto &worker : d->Workers)
+  {
+    std::lock_guard<std::mutex> lock(worker->Mutex);
+    for (auto &queue : worker->Queues)
+      queued.insert(queued.end(), queue.begin(), queue.end());
+  }
+  {
+    std::lock_guard<std::mutex> lock(d->ResourceMutex);
+    for (auto &resource : d->Resources)
+      queued.insert(queued.end(), resource.second.Waiting.begin(), resource.second.Waiting.end());
+  }
+
+  for (const auto &task : queued)
+    task->Cancel();
+
+  d->WakeUp.notify_all();
+  for (auto &worker : d->Workers)
+    worker->Thread.join();
+}
+
+mitk::TaskScheduler::TaskPointer mitk::TaskScheduler::Submit(const std::function<void()> &function,
+                                                               Priority priority,
+                                                               const std::vector<Resource> &resources)
+{
+  TaskPointer task(new Task);
+  task->m_Function = function;
+  task->m_Priority = std::min(std::max(static_cast<int>(priority), 0), NumberOfPriorities - 1);
+  task->m_Scheduler = this;
+
+  {
+    std::lock_guard<std::mutex> lock(d->Mutex);
+    if (d->Stop)
+    {
+      task->Cancel();
+      return task;
+    }
+  }
+
+  for (const auto &resource : resources)
+  {
+    if (resource.Data == nullptr)
+      continue;
+
+    // the strongest access of a task decides
+    auto iter = std::find_if(task->m_Resources.begin(),
+                             task->m_Resources.end(),
+                             [&resource](const std::pair<const void *, bool> &r) { return r.first == resource.Data; });
+    if (iter == task->m_Resources.end())
+      task->m_Resources.push_back(std::make_pair(resource.Data, resource.Mode == WriteAccess));
+    else
+      iter->second = iter->second || resource.Mode == WriteAccess;
+  }
+
+  d->Push(task);
+  return task;
+}
+
+unsigned int mitk::TaskScheduler::GetNumberOfThreads() const
+{
+  return static_cast<unsigned int>(d->Workers.size());
+}
+
+bool mitk::TaskScheduler::IsCurrentTaskCanceled()
+{
+  return CurrentTask != nullptr && CurrentTask->IsCanceled();
+}
+
+bool mitk::TaskScheduler::RunPendingTask()
+{
+  TaskPointer task = d->Pop(CurrentWorker);
+  if (!task)
+    return false;
+
+  d->Run(task);
+  return true;
+}
+
+bool mitk::TaskScheduler::IsWorkerThread() const
+{
+  return CurrentScheduler == this;
+}
@@ -0,0 +1,233 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTracer.h"
+
+#include "mitkExceptionMacro.h"
+#include "mitkImage.h"
+#include "mitkSurface.h"
+
+#include <vtkPolyData.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+
+namespace
+{
+  void WriteJsonString(std::ostream &stream, const std::string &value)
+  {
+    stream << '"';
+    for (char c : value)
+    {
+      switch (c)
+      {
+        case '"':
+          stream << "\\\"";
+          break;
+        case '\\':
+          stream << "\\\\";
+          break;
+        case '\n':
+          stream << "\\n";
+          break;
+        case '\t':
+          stream << "\\t";
+          break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20)
+            stream << ' ';
+          else
+            stream << c;
+      }
+    }
+    stream << '"';
+  }
+}
+
+mitk::Tracer *mitk::Tracer::GetInstance()
+{
+  static Tracer instance;
+  return &instance;
+}
+
+mitk::Tracer::Tracer() : m_Enabled(false), m_MaximumNumberOfEvents(1000000), m_DroppedEvents(0)
+{
+  const char *traceFile = std::getenv("MITK_TRACE_FILE");
+  if (traceFile != nullptr && *traceFile != '\0')
+  {
+    m_TraceFile = traceFile;
+    m_Enabled = true;
+  }
+}
+
+mitk::Tracer::~Tracer()
+{
+  if (m_TraceFile.empty())
+    return;
+
+  // no logging here, the logging backend may already be gone
+  std::ofstream stream(m_TraceFile.c_str());
+  if (stream)
+    this->WriteChromeTrace(stream);
+}
+
+void mitk::Tracer::SetEnabled(bool enabled)
+{
+  m_Enabled = enabled;
+}
+
+void mitk::Tracer::SetMaximumNumberOfEvents(std::size_t maximum)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_MaximumNumberOfEvents = maximum;
+}
+
+std::size_t mitk::Tracer::GetMaximumNumberOfEvents() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_MaximumNumberOfEvents;
+}
+
+void mitk::Tracer::Record(const Event &event)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if (m_Events.size() < m_MaximumNumberOfEvents)
+    m_Events.push_back(event);
+  else
+    ++m_DroppedEvents;
+}
+
+std::vector<mitk::Tracer::Event> mitk::Tracer::GetEvents() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Events;
+}
+
+std::size_t mitk::Tracer::GetNumberOfDroppedEvents() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_DroppedEvents;
+}
+
+void mitk::Tracer::Clear()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Events.clear();
+  m_DroppedEvents = 0;
+}
+
+void mitk::Tracer::WriteChromeTrace(std::ostream &stream) const
+{
+  std::vector<Event> events = this->GetEvents();
+
+  stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  for (std::size_t i = 0; i < events.size(); ++i)
+  {
+    const Event &event = events[i];
+    stream << (i == 0 ? "\n" : ",\n") << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << event.ThreadId
+           << ",\"ts\":" << event.Begin << ",\"dur\":" << event.Duration << ",\"cat\":";
+    WriteJsonString(stream, event.Category);
+    stream << ",\"name\":";
+    WriteJsonString(stream, event.Name);
+    stream << ",\"args\":{\"size\":" << event.DataSize;
+    if (!event.NodeName.empty())
+    {
+      stream << ",\"node\":";
+      WriteJsonString(stream, event.NodeName);
+    }
+    stream << "}}";
+  }
+  stream << "\n]}\n";
+}
+
+void mitk::Tracer::WriteChromeTrace(const std::string &fileName) const
+{
+  std::ofstream stream(fileName.c_str());
+  if (!stream)
+    mitkThrow() << "Cannot open trace file " << fileName << " for writing";
+
+  this->WriteChromeTrace(stream);
+  if (!stream)
+    mitkThrow() << "Writing trace file " << fileName << " failed";
+}
+
+long long mitk::Tracer::GetTimeStamp()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+unsigned int mitk::Tracer::GetCurrentThreadId()
+{
+  static std::atomic<unsigned int> nextId(1);
+  thread_local unsigned int id = nextId++;
+  return id;
+}
+
+std::size_t mitk::Tracer::GetDataSize(const BaseData *data)
+{
+  if (auto image = dynamic_cast<const Image *>(data))
+    return image->GetDataMemorySize();
+
+  if (auto surface = dynamic_cast<const Surface *>(data))
+  {
+    std::size_t size = 0;
+    for (unsigned int t = 0; t < surface->GetSizeOfPolyDataSeries(); ++t)
+    {
+      vtkPolyData *polyData = surface->GetVtkPolyData(t);
+      if (polyData != nullptr)
+        size += static_cast<std::size_t>(polyData->GetActualMemorySize()) * 1024;
+    }
+    return size;
+  }
+
+  return 0;
+}
+
+mitk::TraceScope::TraceScope(const char *category, const char *name) : m_Active(Tracer::GetInstance()->IsEnabled())
+{
+  if (!m_Active)
+    return;
+
+  m_Event.Category = category;
+  m_Event.Name = name;
+  m_Event.DataSize = 0;
+  m_Event.ThreadId = Tracer::GetCurrentThreadId();
+  m_Event.Begin = Tracer::GetTimeStamp();
+  m_Event.Duration = 0;
+}
+
+mitk::TraceScope::~TraceScope()
+{
+  if (!m_Active)
+    return;
+
+  m_Event.Duration = Tracer::GetTimeStamp() - m_Event.Begin;
+  Tracer::GetInstance()->Record(m_Event);
+}
+
+void mitk::TraceScope::SetDataSize(std::size_t size)
+{
+  if (m_Active)
+    m_Event.DataSize = size;
+}
+
+void mitk::TraceScope::SetNodeName(const std::string &nodeName)
+{
+  if (m_Active)
+    m_Event.NodeName = nodeName;
+}
@@ -211,6 +211,16 @@ mitk::OperationEvent *mitk::UndoController::GetLastOfType(OperationActor *destin
   return m_CurUndoModel->GetLastOfType(destination, opType);
 }
 
+void mitk::UndoController::SetMemoryLimit(std::size_t limit)
+{
+  m_CurUndoModel->SetMemoryLimit(limit);
+}
+
+std::size_t mitk::UndoController::GetMemoryLimit() const
+{
+  return m_CurUndoModel->GetMemoryLimit();
+}
+
 mitk::UndoModel *mitk::UndoController::GetCurrentUndoModel()
 {
   return m_CurUndoModel;
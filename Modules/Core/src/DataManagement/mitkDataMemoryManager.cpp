@@ -0,0 +1,246 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#include "mitkDataMemoryManager.h"
+
+#include "mitkDataStorage.h"
+#include "mitkImage.h"
+#include "mitkSurface.h"
+
+#include <vtkPolyData.h>
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+mitk::DataMemoryManager::DataMemoryManager() : m_MemoryBudget(0), m_Enforcing(false)
+{
+}
+
+mitk::DataMemoryManager::~DataMemoryManager()
+{
+  while (!m_DataStorages.empty())
+    this->RemoveDataStorage(m_DataStorages.begin()->first);
+}
+
+void mitk::DataMemoryManager::SetMemoryBudget(std::size_t bytes)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_MemoryBudget = bytes;
+}
+
+std::size_t mitk::DataMemoryManager::GetMemoryBudget() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_MemoryBudget;
+}
+
+void mitk::DataMemoryManager::SetSwapDirectory(const std::string &path)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_SwapDirectory = path;
+}
+
+std::string mitk::DataMemoryManager::GetSwapDirectory() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_SwapDirectory;
+}
+
+std::size_t mitk::DataMemoryManager::GetMemoryUsage(const BaseData *data) const
+{
+  if (auto image = dynamic_cast<const Image *>(data))
+    return image->GetDataMemorySize();
+
+  std::size_t size = 0;
+
+  if (auto surface = dynamic_cast<const Surface *>(data))
+  {
+    for (unsigned int t = 0; t < surface->GetSizeOfPolyDataSeries(); ++t)
+    {
+      vtkPolyData *polyData = surface->GetVtkPolyData(t);
+      if (polyData != nullptr)
+        size += static_cast<std::size_t>(polyData->GetActualMemorySize()) * 1024;
+    }
+  }
+
+  return size;
+}
+
+std::size_t mitk::DataMemoryManager::GetMemoryUsage(const DataStorage *storage) const
+{
+  if (storage == nullptr)
+    return 0;
+
+  std::size_t size = 0;
+  std::set<const BaseData *> counted;
+
+  auto nodes = storage->GetAll();
+  for (const auto &node : *nodes)
+  {
+    const BaseData *data = node->GetData();
+    if (data != nullptr && counted.insert(data).second)
+      size += this->GetMemoryUsage(data);
+  }
+  return size;
+}
+
+std::size_t mitk::DataMemoryManager::EnforceBudget(const DataStorage *storage)
+{
+  if (storage == nullptr)
+    return 0;
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+
+  struct Candidate
+  {
+    Image *image;
+    std::size_t size;
+  };
+
+  std::vector<Candidate> candidates;
+  std::map<const BaseData *, itk::ModifiedTimeType> mtimes;
+  std::size_t usage = 0;
+
+  auto nodes = storage->GetAll();
+  for (const auto &node : *nodes)
+  {
+    BaseData *data = node->GetData();
+    if (data == nullptr || mtimes.count(data) != 0)
+      continue;
+
+    const std::size_t size = this->GetMemoryUsage(data);
+    mtimes[data] = data->GetMTime();
+    usage += size;
+
+    auto image = dynamic_cast<Image *>(data);
+    if (image == nullptr || size == 0)
+      continue;
+
+    // data that was modified since the last check is probably still being worked on
+    auto checked = m_CheckedMTimes.find(data);
+    if (checked != m_CheckedMTimes.end() && checked->second == mtimes[data])
+      candidates.push_back({image, size});
+  }
+
+  m_CheckedMTimes.swap(mtimes);
+
+  std::size_t released = 0;
+  if (m_MemoryBudget == 0 || usage <= m_MemoryBudget)
+    return released;
+
+  std::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
+    return a.image->GetDataAccessTime() < b.image->GetDataAccessTime();
+  });
+
+  for (const auto &candidate : candidates)
+  {
+    if (usage <= m_MemoryBudget)
+      break;
+
+    if (candidate.image->SwapOutData(m_SwapDirectory))
+    {
+      const std::size_t freed = candidate.size - std::min(candidate.size, candidate.image->GetDataMemorySize());
+      usage -= std::min(usage, freed);
+      released += freed;
+    }
+  }
+
+  if (usage > m_MemoryBudget)
+    MITK_WARN << "Memory budget of " << m_MemoryBudget << " bytes exceeded by " << usage - m_MemoryBudget << " bytes";
+
+  return released;
+}
+
+void mitk::DataMemoryManager::AddDataStorage(DataStorage *storage)
+{
+  if (storage == nullptr)
+    return;
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if (m_DataStorages.count(storage) != 0)
+    return;
+
+  storage->AddNodeEvent.AddListener(
+    MessageDelegate1<DataMemoryManager, const DataNode *>(this, &DataMemoryManager::OnNodeAdded));
+  storage->AddNodesEvent.AddListener(MessageDelegate1<DataMemoryManager, const DataStorage::SetOfObjects *>(
+    this, &DataMemoryManager::OnNodesAdded));
+
+  auto command = itk::MemberCommand<DataMemoryManager>::New();
+  command->SetCallbackFunction(this, &DataMemoryManager::OnDataStorageDeleted);
+  m_DataStorages[storage] = storage->AddObserver(itk::DeleteEvent(), command);
+}
+
+void mitk::DataMemoryManager::RemoveDataStorage(DataStorage *storage)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+
+  auto it = m_DataStorages.find(storage);
+  if (it == m_DataStorages.end())
+    return;
+
+  storage->AddNodeEvent.RemoveListener(
+    MessageDelegate1<DataMemoryManager, const DataNode *>(this, &DataMemoryManager::OnNodeAdded));
+  storage->AddNodesEvent.RemoveListener(MessageDelegate1<DataMemoryManager, const DataStorage::SetOfObjects *>(
+    this, &DataMemoryManager::OnNodesAdded));
+  storage->RemoveObserver(it->second);
+  m_DataStorages.erase(it);
+}
+
+void mitk::DataMemoryManager::OnNodeAdded(const DataNode *node)
+{
+  // the new node is accounted, but never swapped out right away because it was not
+  // checked before: older data makes room for it
+  if (m_Enforcing)
+    return;
+
+  std::vector<DataStorage *> storages;
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (const auto &entry : m_DataStorages)
+      storages.push_back(entry.first);
+  }
+
+  // the budget is enforced once for all nodes of a batch update, see OnNodesAdded()
+  for (auto storage : storages)
+  {
+    if (node != nullptr && storage->IsBatchUpdateActive() && storage->Exists(node))
+      return;
+  }
+
+  m_Enforcing = true;
+  for (auto storage : storages)
+    this->EnforceBudget(storage);
+  m_Enforcing = false;
+}
+
+void mitk::DataMemoryManager::OnNodesAdded(const DataStorage::SetOfObjects *)
+{
+  this->OnNodeAdded(nullptr);
+}
+
+void mitk::DataMemoryManager::OnDataStorageDeleted(const itk::Object *caller, const itk::EventObject &)
+{
+  // the storage is being destroyed, its events will never be emitted again
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_DataStorages.erase(const_cast<DataStorage *>(static_cast<const DataStorage *>(caller)));
+}
+
+mitk::IDataMemoryManager *mitk::CreateTestInstanceDataMemoryManager()
+{
+  return new DataMemoryManager();
+}
@@ -246,6 +246,29 @@ mitk::BaseProperty *mitk::DataNode::GetProperty(const char *propertyKey, const m
   return property;
 }
 
+mitk::BaseProperty *mitk::DataNode::GetProperty(const PropertyKey &propertyKey, const mitk::BaseRenderer *renderer, bool fallBackOnDataProperties) const
+{
+  if (nullptr != renderer)
+  {
+    auto it = m_MapOfPropertyLists.find(renderer->GetName());
+
+    if (m_MapOfPropertyLists.end() != it)
+    {
+      auto property = it->second->GetProperty(propertyKey);
+
+      if (nullptr != property)
+        return property;
+    }
+  }
+
+  auto property = m_PropertyList->GetProperty(propertyKey);
+
+  if (nullptr == property && fallBackOnDataProperties && m_Data.IsNotNull())
+    property = m_Data->GetPropertyList()->GetProperty(propertyKey);
+
+  return property;
+}
+
 mitk::DataNode::GroupTagList mitk::DataNode::GetGroupTags() const
 {
   GroupTagList groups;
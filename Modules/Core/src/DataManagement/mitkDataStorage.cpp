@@ -26,7 +26,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkProperties.h"
 #include "mitkArbitraryTimeGeometry.h"
 
-mitk::DataStorage::DataStorage() : itk::Object(), m_BlockNodeModifiedEvents(false)
+#include <set>
+#include <stdexcept>
+
+mitk::DataStorage::DataStorage() : itk::Object(), m_BlockNodeModifiedEvents(false), m_BatchUpdateDepth(0)
 {
 }
 
@@ -52,10 +55,77 @@ void mitk::DataStorage::Remove(const DataStorage::SetOfObjects *nodes)
 {
   if (nodes == nullptr)
     return;
+  BatchUpdate batch(this);
   for (DataStorage::SetOfObjects::ConstIterator it = nodes->Begin(); it != nodes->End(); it++)
     this->Remove(it.Value());
 }
 
+void mitk::DataStorage::Add(const DataStorage::SetOfObjects *nodes)
+{
+  if (nodes == nullptr)
+    return;
+  BatchUpdate batch(this);
+  for (DataStorage::SetOfObjects::ConstIterator it = nodes->Begin(); it != nodes->End(); it++)
+    this->Add(it.Value());
+}
+
+void mitk::DataStorage::BeginBatchUpdate()
+{
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_BatchUpdateMutex);
+  ++m_BatchUpdateDepth;
+}
+
+void mitk::DataStorage::EndBatchUpdate()
+{
+  std::vector<DataNode::ConstPointer> added;
+  std::vector<DataNode::ConstPointer> removed;
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_BatchUpdateMutex);
+    if (m_BatchUpdateDepth == 0)
+      throw std::logic_error("EndBatchUpdate() called without BeginBatchUpdate()");
+    if (--m_BatchUpdateDepth != 0)
+      return;
+    added.swap(m_BatchAddedNodes);
+    removed.swap(m_BatchRemovedNodes);
+  }
+
+  // nodes that were added and removed again within the batch are in both lists
+  std::set<const DataNode *> visited;
+  SetOfObjects::Pointer removedNodes = SetOfObjects::New();
+  for (const auto &node : removed)
+    if (visited.insert(node).second && !this->Exists(node))
+      removedNodes->InsertElement(removedNodes->Size(), const_cast<DataNode *>(node.GetPointer()));
+
+  visited.clear();
+  SetOfObjects::Pointer addedNodes = SetOfObjects::New();
+  for (const auto &node : added)
+    if (visited.insert(node).second && this->Exists(node))
+      addedNodes->InsertElement(addedNodes->Size(), const_cast<DataNode *>(node.GetPointer()));
+
+  if (removedNodes->Size() != 0)
+    RemoveNodesEvent.Send(removedNodes);
+  if (addedNodes->Size() != 0)
+    AddNodesEvent.Send(addedNodes);
+}
+
+bool mitk::DataStorage::IsBatchUpdateActive() const
+{
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_BatchUpdateMutex);
+  return m_BatchUpdateDepth != 0;
+}
+
+mitk::DataStorage::BatchUpdate::BatchUpdate(DataStorage *storage) : m_Storage(storage)
+{
+  if (m_Storage.IsNotNull())
+    m_Storage->BeginBatchUpdate();
+}
+
+mitk::DataStorage::BatchUpdate::~BatchUpdate()
+{
+  if (m_Storage.IsNotNull())
+    m_Storage->EndBatchUpdate();
+}
+
 mitk::DataStorage::SetOfObjects::ConstPointer mitk::DataStorage::GetSubset(const NodePredicateBase *condition) const
 {
   DataStorage::SetOfObjects::ConstPointer result = this->FilterSetOfObjects(this->GetAll(), condition);
@@ -179,11 +249,21 @@ const mitk::DataNode::GroupTagList mitk::DataStorage::GetGroupTags() const
 
 void mitk::DataStorage::EmitAddNodeEvent(const DataNode *node)
 {
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_BatchUpdateMutex);
+    if (m_BatchUpdateDepth != 0)
+      m_BatchAddedNodes.push_back(node);
+  }
   AddNodeEvent.Send(node);
 }
 
 void mitk::DataStorage::EmitRemoveNodeEvent(const DataNode *node)
 {
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_BatchUpdateMutex);
+    if (m_BatchUpdateDepth != 0)
+      m_BatchRemovedNodes.push_back(node);
+  }
   RemoveNodeEvent.Send(node);
 }
 
@@ -198,10 +278,13 @@ void mitk::DataStorage::OnNodeInteractorChanged(itk::Object *caller, const itk::
 
 void mitk::DataStorage::OnNodeModifiedOrDeleted(const itk::Object *caller, const itk::EventObject &event)
 {
+  const auto *_Node = dynamic_cast<const DataNode *>(caller);
+  if (_Node && dynamic_cast<const itk::ModifiedEvent *>(&event))
+    this->NodeModified(_Node);
+
   if (m_BlockNodeModifiedEvents)
     return;
 
-  const auto *_Node = dynamic_cast<const DataNode *>(caller);
   if (_Node)
   {
     const auto *modEvent = dynamic_cast<const itk::ModifiedEvent *>(&event);
@@ -17,9 +17,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 // MITK
 #include "mitkImage.h"
 #include "mitkCompareImageDataFilter.h"
+#include "mitkIOUtil.h"
 #include "mitkImageStatisticsHolder.h"
 #include "mitkImageVtkReadAccessor.h"
 #include "mitkImageVtkWriteAccessor.h"
+#include "mitkMemoryMappedFile.h"
 #include "mitkPixelTypeMultiplex.h"
 #include <mitkProportionalTimeGeometry.h>
 
@@ -31,6 +33,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 // Other
 #include <cmath>
+#include <cstdio>
+#include <fstream>
 
 #define FILL_C_ARRAY(_arr, _size, _value)                                                                              \
   for (unsigned int i = 0u; i < _size; i++)                                                                            \
@@ -65,6 +69,8 @@ mitk::Image::Image(const Image &other)
   m_Dimensions = new unsigned int[MAX_IMAGE_DIMENSIONS];
   FILL_C_ARRAY(m_Dimensions, MAX_IMAGE_DIMENSIONS, 0u);
 
+  m_RegionProvider = other.m_RegionProvider;
+
   this->Initialize(other.GetPixelType(), other.GetDimension(), other.GetDimensions());
 
   // Since the above called "Initialize" method doesn't take the geometry into account we need to set it
@@ -72,22 +78,39 @@ mitk::Image::Image(const Image &other)
   TimeGeometry::Pointer cloned = other.GetTimeGeometry()->Clone();
   this->SetTimeGeometry(cloned.GetPointer());
 
-  if (this->GetDimension() > 3)
+  // share the data copy-on-write if possible, it is copied once one of the images is written to
+  ImageDataItemPointer sharedChannel;
   {
-    const unsigned int time_steps = this->GetDimension(3);
-
-    for (unsigned int i = 0u; i < time_steps; ++i)
-    {
-      ImageDataItemPointer volume = other.GetVolumeData(i);
+    MutexHolder lock(other.m_ImageDataArraysLock);
+    if (!other.m_Channels.empty() && other.m_Channels[0].IsNotNull() && other.m_Channels[0]->IsComplete())
+      sharedChannel = other.m_Channels[0]->ShareData();
+  }
 
-      this->SetVolume(volume->GetData(), i);
-    }
+  if (sharedChannel.IsNotNull())
+  {
+    sharedChannel->SetComplete(true);
+    MutexHolder lock(m_ImageDataArraysLock);
+    m_Channels[0] = sharedChannel;
+    return;
   }
-  else
+
+  const unsigned int time_steps = this->GetDimension() > 3 ? this->GetDimension(3) : 1u;
+
+  for (unsigned int i = 0u; i < time_steps; ++i)
   {
-    ImageDataItemPointer volume = other.GetVolumeData(0);
+    ImageDataItemPointer volume = other.GetVolumeData(i);
+    ImageDataItemPointer sharedVolume = volume->ShareData();
 
-    this->SetVolume(volume->GetData(), 0);
+    if (sharedVolume.IsNotNull())
+    {
+      sharedVolume->SetComplete(true);
+      MutexHolder lock(m_ImageDataArraysLock);
+      m_Volumes[this->GetVolumeIndex(i, 0)] = sharedVolume;
+    }
+    else
+    {
+      this->SetVolume(volume->GetData(), i);
+    }
   }
 }
 
@@ -248,6 +271,7 @@ mitk::Image::ImageDataItemPointer mitk::Image::GetSliceData(
   int s, int t, int n, void *data, ImportMemoryManagementType importMemoryManagement) const
 {
   MutexHolder lock(m_ImageDataArraysLock);
+  m_DataAccessTime.Modified();
   return GetSliceData_unlocked(s, t, n, data, importMemoryManagement);
 }
 
@@ -333,6 +357,7 @@ mitk::Image::ImageDataItemPointer mitk::Image::GetVolumeData(int t,
                                                              ImportMemoryManagementType importMemoryManagement) const
 {
   MutexHolder lock(m_ImageDataArraysLock);
+  m_DataAccessTime.Modified();
   return GetVolumeData_unlocked(t, n, data, importMemoryManagement);
 }
 mitk::Image::ImageDataItemPointer mitk::Image::GetVolumeData_unlocked(
@@ -463,6 +488,7 @@ mitk::Image::ImageDataItemPointer mitk::Image::GetChannelData(int n,
                                                               ImportMemoryManagementType importMemoryManagement) const
 {
   MutexHolder lock(m_ImageDataArraysLock);
+  m_DataAccessTime.Modified();
   return GetChannelData_unlocked(n, data, importMemoryManagement);
 }
 
@@ -686,6 +712,9 @@ bool mitk::Image::SetImportSlice(void *data, int s, int t, int n, ImportMemoryMa
 {
   if (IsValidSlice(s, t, n) == false)
     return false;
+
+  // the data is about to be overwritten, so it must not be shared any more
+  this->DetachSharedData();
   ImageDataItemPointer sl;
   const size_t ptypeSize = this->m_ImageDescriptor->GetChannelTypeById(n).GetSize();
 
@@ -722,6 +751,9 @@ bool mitk::Image::SetImportVolume(void *data, int t, int n, ImportMemoryManageme
   if (IsValidVolume(t, n) == false)
     return false;
 
+  // the data is about to be overwritten, so it must not be shared any more
+  this->DetachSharedData();
+
   const size_t ptypeSize = this->m_ImageDescriptor->GetChannelTypeById(n).GetSize();
   ImageDataItemPointer vol;
   if (IsVolumeSet(t, n))
@@ -732,6 +764,13 @@ bool mitk::Image::SetImportVolume(void *data, int t, int n, ImportMemoryManageme
       vol = AllocateVolumeData(t, n, data, importMemoryManagement);
       if (vol.GetPointer() == nullptr)
         return false;
+      // the slices of the replaced volume still point into the memory referenced before
+      {
+        MutexHolder lock(m_ImageDataArraysLock);
+        for (unsigned int s = 0; s < m_Dimensions[2]; ++s)
+          m_Slices[GetSliceIndex(s, t, n)] = nullptr;
+      }
+      this->m_ImageDescriptor->GetChannelDescriptor(n).SetData(vol->GetData());
     }
     if (vol->GetData() != data)
       std::memcpy(vol->GetData(), data, m_OffsetTable[3] * (ptypeSize));
@@ -767,6 +806,9 @@ bool mitk::Image::SetImportChannel(void *data, int n, ImportMemoryManagementType
   if (IsValidChannel(n) == false)
     return false;
 
+  // the data is about to be overwritten, so it must not be shared any more
+  this->DetachSharedData();
+
   // channel descriptor
 
   const size_t ptypeSize = this->m_ImageDescriptor->GetChannelTypeById(n).GetSize();
@@ -1310,6 +1352,177 @@ mitk::Image::ImageDataItemPointer mitk::Image::AllocateChannelData_unlocked(
   return ch;
 }
 
+unsigned char *mitk::Image::RebaseAddress(const std::vector<DataMove> &moves,
+                                          const ImageDataItem *root,
+                                          const void *address)
+{
+  const auto *begin = static_cast<const unsigned char *>(address);
+  for (const auto &move : moves)
+  {
+    if ((root == nullptr || root == move.root) && begin >= move.oldBegin && begin <= move.oldBegin + move.size)
+      return move.newBegin + (begin - move.oldBegin);
+  }
+  return nullptr;
+}
+
+void mitk::Image::MoveItemData_unlocked(const std::vector<DataMove> &moves)
+{
+  for (auto items : {&m_Channels, &m_Volumes, &m_Slices})
+  {
+    for (auto &item : *items)
+    {
+      if (item.IsNull() || item->m_Parent.IsNull())
+        continue;
+
+      unsigned char *data = RebaseAddress(moves, item->GetRoot(), item->m_Data);
+      if (data != nullptr)
+        item->SetDataPointer(data);
+    }
+  }
+}
+
+void mitk::Image::DetachSharedData(ImageAccessorBase *accessor)
+{
+  std::vector<DataMove> moves;
+  std::vector<itk::LightObject::ConstPointer> previousHolders;
+
+  m_ReadWriteLock.Lock();
+  {
+    MutexHolder lock(m_ImageDataArraysLock);
+
+    // only top level items of this image own (shared) memory, sub items reference their parents
+    for (auto items : {&m_Channels, &m_Volumes, &m_Slices})
+    {
+      for (auto &item : *items)
+      {
+        if (item.IsNull() || item->m_Parent.IsNotNull())
+          continue;
+
+        const unsigned char *oldBegin = item->m_Data;
+        itk::LightObject::ConstPointer previousHolder;
+        if (item->DetachData(previousHolder))
+        {
+          moves.push_back({item.GetPointer(), oldBegin, item->m_Data, item->m_Size});
+          previousHolders.push_back(previousHolder);
+        }
+      }
+    }
+
+    if (!moves.empty())
+    {
+      this->MoveItemData_unlocked(moves);
+
+      std::vector<ImageAccessorBase *> accessors(m_Readers);
+      accessors.insert(accessors.end(), m_Writers.begin(), m_Writers.end());
+      if (accessor != nullptr)
+        accessors.push_back(accessor);
+
+      for (auto a : accessors)
+      {
+        unsigned char *begin = RebaseAddress(moves, nullptr, a->m_AddressBegin);
+        if (begin != nullptr)
+        {
+          a->m_AddressEnd = begin + (static_cast<unsigned char *>(a->m_AddressEnd) - static_cast<unsigned char *>(a->m_AddressBegin));
+          a->m_AddressBegin = begin;
+        }
+      }
+
+      // accessors that are still alive may already have handed out pointers to the previous memory
+      if (!m_Readers.empty() || !m_Writers.empty())
+        m_RetiredDataHolders.insert(m_RetiredDataHolders.end(), previousHolders.begin(), previousHolders.end());
+    }
+  }
+  m_ReadWriteLock.Unlock();
+}
+
+size_t mitk::Image::GetDataMemorySize() const
+{
+  MutexHolder lock(m_ImageDataArraysLock);
+
+  size_t size = 0;
+  for (auto items : {&m_Channels, &m_Volumes, &m_Slices})
+  {
+    for (const auto &item : *items)
+    {
+      if (item.IsNull() || item->m_Parent.IsNotNull() || item->m_Data == nullptr)
+        continue;
+
+      // file backed memory can be dropped by the operating system at any time
+      if (dynamic_cast<const MemoryMappedFile *>(item->GetMemoryHolder()) == nullptr)
+        size += item->m_Size;
+    }
+  }
+  return size;
+}
+
+bool mitk::Image::SwapOutData(const std::string &path)
+{
+  std::vector<DataMove> moves;
+  std::vector<unsigned char *> releasedMemory;
+
+  m_ReadWriteLock.Lock();
+  if (!m_Readers.empty() || !m_Writers.empty())
+  {
+    // the data is in use
+    m_ReadWriteLock.Unlock();
+    return false;
+  }
+
+  {
+    MutexHolder lock(m_ImageDataArraysLock);
+
+    for (auto items : {&m_Channels, &m_Volumes, &m_Slices})
+    {
+      for (auto &item : *items)
+      {
+        if (item.IsNull() || item->m_Parent.IsNotNull() || item->m_MemoryHolder.IsNotNull() ||
+            !item->m_ManageMemory || item->m_Data == nullptr || item->m_Size == 0)
+          continue;
+
+        MemoryMappedFile::Pointer file;
+        std::string fileName;
+        try
+        {
+          std::ofstream stream;
+          fileName = IOUtil::CreateTemporaryFile(stream, std::ios_base::binary, "MITK-swap-XXXXXX.raw", path);
+          stream.write(reinterpret_cast<const char *>(item->m_Data), item->m_Size);
+          stream.close();
+          if (!stream)
+            mitkThrow() << "Cannot write swap file " << fileName;
+
+          file = MemoryMappedFile::New();
+          file->Open(fileName);
+          file->SetRemoveFileOnClose(true);
+        }
+        catch (const mitk::Exception &e)
+        {
+          MITK_WARN << "Cannot swap out image data: " << e.GetDescription();
+          if (!fileName.empty())
+            std::remove(fileName.c_str());
+          continue;
+        }
+
+        unsigned char *oldBegin = item->m_Data;
+        releasedMemory.push_back(oldBegin);
+
+        item->m_ManageMemory = false;
+        item->m_MemoryHolder = file.GetPointer();
+        item->SetDataPointer(static_cast<unsigned char *>(file->GetData()));
+        moves.push_back({item.GetPointer(), oldBegin, item->m_Data, item->m_Size});
+      }
+    }
+
+    if (!moves.empty())
+      this->MoveItemData_unlocked(moves);
+  }
+  m_ReadWriteLock.Unlock();
+
+  for (auto memory : releasedMemory)
+    delete[] memory;
+
+  return !moves.empty();
+}
+
 unsigned int *mitk::Image::GetDimensions() const
 {
   return m_Dimensions;
@@ -1337,6 +1550,20 @@ void mitk::Image::SetGeometry(BaseGeometry *aGeometry3D)
     GetTimeGeometry()->GetGeometryForTimeStep(step)->ImageGeometryOn();
 }
 
+void mitk::Image::SetRegionProvider(ImageRegionProvider *provider)
+{
+  if (m_RegionProvider != provider)
+  {
+    m_RegionProvider = provider;
+    this->Modified();
+  }
+}
+
+mitk::ImageRegionProvider *mitk::Image::GetRegionProvider() const
+{
+  return m_RegionProvider.GetPointer();
+}
+
 void mitk::Image::PrintSelf(std::ostream &os, itk::Indent indent) const
 {
   if (m_Initialized)
@@ -35,6 +35,32 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkImageVtkReadAccessor.h>
 #include <mitkImageVtkWriteAccessor.h>
 
+#include <cstring>
+
+namespace
+{
+  /** Owns the memory of a top level ImageDataItem as soon as it is shared with other items. */
+  class SharedImageMemory : public itk::LightObject
+  {
+  public:
+    typedef itk::SmartPointer<SharedImageMemory> Pointer;
+
+    explicit SharedImageMemory(unsigned char *data) : m_Data(data) { m_ReferenceCount = 0; }
+    ~SharedImageMemory() override { delete[] m_Data; }
+
+    /** Gives up the ownership of the memory without freeing it. */
+    unsigned char *Release()
+    {
+      unsigned char *data = m_Data;
+      m_Data = nullptr;
+      return data;
+    }
+
+  private:
+    unsigned char *m_Data;
+  };
+}
+
 mitk::ImageDataItem::ImageDataItem(const ImageDataItem &aParent,
                                    const mitk::ImageDescriptor::Pointer desc,
                                    int timestep,
@@ -180,6 +206,7 @@ mitk::ImageDataItem::ImageDataItem(const ImageDataItem &other)
     m_IsComplete(other.m_IsComplete),
     m_Size(other.m_Size),
     m_Parent(other.m_Parent),
+    m_MemoryHolder(other.m_MemoryHolder),
     m_Dimension(other.m_Dimension),
     m_Timestep(other.m_Timestep)
 {
@@ -195,6 +222,87 @@ itk::LightObject::Pointer mitk::ImageDataItem::InternalClone() const
   return newGeometry.GetPointer();
 }
 
+const mitk::ImageDataItem *mitk::ImageDataItem::GetRoot() const
+{
+  const ImageDataItem *root = this;
+  while (root->m_Parent.IsNotNull())
+    root = root->m_Parent.GetPointer();
+  return root;
+}
+
+mitk::ImageDataItem::Pointer mitk::ImageDataItem::ShareData() const
+{
+  auto root = const_cast<ImageDataItem *>(this->GetRoot());
+
+  if (root->m_MemoryHolder.IsNull())
+  {
+    if (!root->m_ManageMemory || root->m_Data == nullptr)
+      return nullptr;
+
+    // hand the memory over to a holder that is referenced by all items sharing it
+    root->m_MemoryHolder = new SharedImageMemory(root->m_Data);
+    root->m_ManageMemory = false;
+  }
+
+  Self::Pointer item = new Self(*this);
+  item->UnRegister();
+  item->m_Parent = nullptr;
+  item->m_MemoryHolder = root->m_MemoryHolder;
+  item->m_ManageMemory = false;
+  item->m_Offset = 0;
+  return item;
+}
+
+bool mitk::ImageDataItem::IsDataShared() const
+{
+  const ImageDataItem *root = this->GetRoot();
+  return root->m_MemoryHolder.IsNotNull() && root->m_MemoryHolder->GetReferenceCount() > 1;
+}
+
+bool mitk::ImageDataItem::DetachData(itk::LightObject::ConstPointer &previousHolder)
+{
+  previousHolder = nullptr;
+
+  if (m_Parent.IsNotNull() || m_MemoryHolder.IsNull())
+    return false;
+
+  if (!this->IsDataShared())
+  {
+    // nobody else references the memory any more, so take it back if it was ours
+    auto memory = dynamic_cast<const SharedImageMemory *>(m_MemoryHolder.GetPointer());
+    if (memory != nullptr)
+    {
+      const_cast<SharedImageMemory *>(memory)->Release();
+      m_MemoryHolder = nullptr;
+      m_ManageMemory = true;
+    }
+    return false;
+  }
+
+  unsigned char *data = mitk::MemoryUtilities::AllocateElements<unsigned char>(m_Size);
+  std::memcpy(data, m_Data, m_Size);
+
+  previousHolder = m_MemoryHolder;
+  m_MemoryHolder = nullptr;
+  m_ManageMemory = true;
+  this->SetDataPointer(data);
+  return true;
+}
+
+void mitk::ImageDataItem::SetDataPointer(unsigned char *data)
+{
+  m_Data = data;
+
+  if (m_VtkImageData != nullptr)
+  {
+    // keep the vtkImageData handed out to mappers etc. valid
+    vtkDataArray *scalars = m_VtkImageData->GetPointData()->GetScalars();
+    if (scalars != nullptr)
+      scalars->SetVoidArray(m_Data, scalars->GetNumberOfTuples() * scalars->GetNumberOfComponents(), 1);
+    m_VtkImageData->Modified();
+  }
+}
+
 void mitk::ImageDataItem::ComputeItemSize(const unsigned int *dimensions, unsigned int dimension)
 {
   m_Size = m_PixelType->GetSize();
@@ -70,6 +70,9 @@ mitk::ImageReadAccessor::~ImageReadAccessor()
     auto it = std::find(m_Image->m_Readers.begin(), m_Image->m_Readers.end(), this);
     m_Image->m_Readers.erase(it);
 
+    if (m_Image->m_Readers.empty() && m_Image->m_Writers.empty())
+      m_Image->m_RetiredDataHolders.clear();
+
     // delete lock, if there are no waiting ImageAccessors
     if (m_WaitLock->m_WaiterCount <= 0)
     {
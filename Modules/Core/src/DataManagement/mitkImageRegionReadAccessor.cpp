@@ -0,0 +1,125 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkImageRegionReadAccessor.h"
+
+#include <mitkImageReadAccessor.h>
+
+#include <algorithm>
+#include <cstring>
+
+mitk::ImageRegionReadAccessor::ImageRegionReadAccessor(const Image *image,
+                                                       const RegionType &region,
+                                                       unsigned int t)
+  : m_Image(image), m_Region(region), m_TimeStep(t)
+{
+  if (m_Image.IsNull())
+  {
+    mitkThrow() << "Invalid ImageRegionReadAccessor: no image given";
+  }
+
+  if (t >= std::max(m_Image->GetDimension(3), 1u))
+  {
+    mitkThrow() << "Invalid ImageRegionReadAccessor: time step " << t << " does not exist";
+  }
+
+  if (!GetLargestPossibleRegion(m_Image.GetPointer()).IsInside(m_Region))
+  {
+    mitkThrow() << "Invalid ImageRegionReadAccessor: region " << m_Region << " is not inside of the image";
+  }
+
+  m_Buffer.resize(m_Region.GetNumberOfPixels() * m_Image->GetPixelType().GetSize());
+  if (m_Buffer.empty())
+    return;
+
+  ImageRegionProvider *provider = m_Image->GetRegionProvider();
+  if (provider != nullptr && !m_Image->IsVolumeSet(t))
+  {
+    provider->ReadRegion(m_Region, t, m_Buffer.data());
+  }
+  else
+  {
+    this->CopyRegionFromVolume();
+  }
+}
+
+mitk::ImageRegionReadAccessor::~ImageRegionReadAccessor()
+{
+}
+
+void mitk::ImageRegionReadAccessor::CopyRegionFromVolume()
+{
+  ImageReadAccessor accessor(m_Image, m_Image->GetVolumeData(m_TimeStep).GetPointer());
+  const char *volume = static_cast<const char *>(accessor.GetData());
+
+  const size_t pixelSize = m_Image->GetPixelType().GetSize();
+  const size_t dimX = m_Image->GetDimension(0);
+  const size_t dimY = m_Image->GetDimension(1);
+  const size_t rowSize = m_Region.GetSize(0) * pixelSize;
+
+  char *target = m_Buffer.data();
+  for (size_t z = 0; z < m_Region.GetSize(2); ++z)
+  {
+    for (size_t y = 0; y < m_Region.GetSize(1); ++y)
+    {
+      const size_t sourceIndex = ((m_Region.GetIndex(2) + z) * dimY + m_Region.GetIndex(1) + y) * dimX +
+                                 m_Region.GetIndex(0);
+      std::memcpy(target, volume + sourceIndex * pixelSize, rowSize);
+      target += rowSize;
+    }
+  }
+}
+
+mitk::ImageRegionReadAccessor::RegionType mitk::ImageRegionReadAccessor::GetLargestPossibleRegion(const Image *image)
+{
+  RegionType::SizeType size;
+  for (unsigned int i = 0; i < 3; ++i)
+    size[i] = std::max(image->GetDimension(i), 1u);
+
+  RegionType region;
+  region.SetSize(size);
+  return region;
+}
+
+std::vector<mitk::ImageRegionReadAccessor::RegionType> mitk::ImageRegionReadAccessor::GenerateTiles(
+  const Image *image, const RegionType::SizeType &tileSize)
+{
+  const RegionType largest = GetLargestPossibleRegion(image);
+  std::vector<RegionType> tiles;
+
+  RegionType::SizeType step;
+  for (unsigned int i = 0; i < 3; ++i)
+    step[i] = std::max<RegionType::SizeValueType>(tileSize[i], 1);
+
+  for (RegionType::SizeValueType z = 0; z < largest.GetSize(2); z += step[2])
+  {
+    for (RegionType::SizeValueType y = 0; y < largest.GetSize(1); y += step[1])
+    {
+      for (RegionType::SizeValueType x = 0; x < largest.GetSize(0); x += step[0])
+      {
+        RegionType::IndexType index = {{static_cast<itk::IndexValueType>(x),
+                                        static_cast<itk::IndexValueType>(y),
+                                        static_cast<itk::IndexValueType>(z)}};
+        RegionType::SizeType size = {{std::min(step[0], largest.GetSize(0) - x),
+                                      std::min(step[1], largest.GetSize(1) - y),
+                                      std::min(step[2], largest.GetSize(2) - z)}};
+        tiles.push_back(RegionType(index, size));
+      }
+    }
+  }
+
+  return tiles;
+}
@@ -100,82 +100,225 @@ void mitk::ImageStatisticsHolder::ResetImageStatistics()
 
 #include "mitkImageAccessByItk.h"
 
+#include <algorithm>
+#include <thread>
+
 //#define BOUNDINGOBJECT_IGNORE
 
-template <typename ItkImageType>
-void mitk::_ComputeExtremaInItkImage(const ItkImageType *itkImage, mitk::ImageStatisticsHolder *statisticsHolder, int t)
+namespace
 {
-  typename ItkImageType::RegionType region;
-  region = itkImage->GetBufferedRegion();
-  if (region.Crop(itkImage->GetRequestedRegion()) == false)
-    return;
-  if (region != itkImage->GetRequestedRegion())
-    return;
-
-  itk::ImageRegionConstIterator<ItkImageType> it(itkImage, region);
-  typedef typename ItkImageType::PixelType TPixel;
-  TPixel value = 0;
-
-  if (statisticsHolder == nullptr || !statisticsHolder->IsValidTimeStep(t))
-    return;
-  statisticsHolder->Expand(t + 1); // make sure we have initialized all arrays
-  statisticsHolder->m_CountOfMinValuedVoxels[t] = 0;
-  statisticsHolder->m_CountOfMaxValuedVoxels[t] = 0;
-
-  statisticsHolder->m_Scalar2ndMin[t] = statisticsHolder->m_ScalarMin[t] = itk::NumericTraits<ScalarType>::max();
-  statisticsHolder->m_Scalar2ndMax[t] = statisticsHolder->m_ScalarMax[t] =
-    itk::NumericTraits<ScalarType>::NonpositiveMin();
-
-  while (!it.IsAtEnd())
+  /** Partial extrema of a part of an image. Two accumulators can be merged, which allows
+   *  splitting the computation into independent chunks. 2nd minimum and maximum are the
+   *  second smallest and second largest distinct values, as in the serial computation. */
+  struct ExtremaAccumulator
   {
-    value = it.Get();
-#ifdef BOUNDINGOBJECT_IGNORE
-    if (value > -32765)
+    ExtremaAccumulator()
+      : Min(itk::NumericTraits<mitk::ScalarType>::max()),
+        SecondMin(itk::NumericTraits<mitk::ScalarType>::max()),
+        Max(itk::NumericTraits<mitk::ScalarType>::NonpositiveMin()),
+        SecondMax(itk::NumericTraits<mitk::ScalarType>::NonpositiveMin()),
+        CountOfMin(0),
+        CountOfMax(0)
+    {
+    }
+
+    void Add(mitk::ScalarType value)
     {
+#ifdef BOUNDINGOBJECT_IGNORE
+      if (value <= -32765)
+        return;
 #endif
       // update min
-      if (value < statisticsHolder->m_ScalarMin[t])
+      if (value < Min)
       {
-        statisticsHolder->m_Scalar2ndMin[t] = statisticsHolder->m_ScalarMin[t];
-        statisticsHolder->m_ScalarMin[t] = value;
-        statisticsHolder->m_CountOfMinValuedVoxels[t] = 1;
+        SecondMin = Min;
+        Min = value;
+        CountOfMin = 1;
       }
-      else if (value == statisticsHolder->m_ScalarMin[t])
+      else if (value == Min)
       {
-        ++statisticsHolder->m_CountOfMinValuedVoxels[t];
+        ++CountOfMin;
       }
-      else if (value < statisticsHolder->m_Scalar2ndMin[t])
+      else if (value < SecondMin)
       {
-        statisticsHolder->m_Scalar2ndMin[t] = value;
+        SecondMin = value;
       }
 
       // update max
-      if (value > statisticsHolder->m_ScalarMax[t])
+      if (value > Max)
       {
-        statisticsHolder->m_Scalar2ndMax[t] = statisticsHolder->m_ScalarMax[t];
-        statisticsHolder->m_ScalarMax[t] = value;
-        statisticsHolder->m_CountOfMaxValuedVoxels[t] = 1;
+        SecondMax = Max;
+        Max = value;
+        CountOfMax = 1;
       }
-      else if (value == statisticsHolder->m_ScalarMax[t])
+      else if (value == Max)
       {
-        ++statisticsHolder->m_CountOfMaxValuedVoxels[t];
+        ++CountOfMax;
       }
-      else if (value > statisticsHolder->m_Scalar2ndMax[t])
+      else if (value > SecondMax)
       {
-        statisticsHolder->m_Scalar2ndMax[t] = value;
+        SecondMax = value;
+      }
+    }
+
+    void Merge(const ExtremaAccumulator &other)
+    {
+      if (other.Min < Min)
+      {
+        SecondMin = std::min(other.SecondMin, Min);
+        Min = other.Min;
+        CountOfMin = other.CountOfMin;
+      }
+      else if (other.Min == Min)
+      {
+        SecondMin = std::min(SecondMin, other.SecondMin);
+        CountOfMin += other.CountOfMin;
+      }
+      else
+      {
+        SecondMin = std::min(SecondMin, other.Min);
+      }
+
+      if (other.Max > Max)
+      {
+        SecondMax = std::max(other.SecondMax, Max);
+        Max = other.Max;
+        CountOfMax = other.CountOfMax;
+      }
+      else if (other.Max == Max)
+      {
+        SecondMax = std::max(SecondMax, other.SecondMax);
+        CountOfMax += other.CountOfMax;
+      }
+      else
+      {
+        SecondMax = std::max(SecondMax, other.Max);
       }
-#ifdef BOUNDINGOBJECT_IGNORE
     }
-#endif
 
-    ++it;
+    mitk::ScalarType Min;
+    mitk::ScalarType SecondMin;
+    mitk::ScalarType Max;
+    mitk::ScalarType SecondMax;
+    unsigned int CountOfMin;
+    unsigned int CountOfMax;
+  };
+
+  /** Images with fewer pixels are processed in the calling thread. */
+  const itk::SizeValueType MinimumNumberOfPixelsPerThread = 1 << 18;
+
+  /** Computes the extrema of \a region. Large regions are split along their slowest
+   *  dimension and the chunks are reduced in parallel. */
+  template <typename ItkImageType, typename ValueFunctor>
+  ExtremaAccumulator ComputeExtremaInRegion(const ItkImageType *itkImage,
+                                            const typename ItkImageType::RegionType &region,
+                                            ValueFunctor getValue)
+  {
+    typedef typename ItkImageType::RegionType RegionType;
+    const unsigned int splitDimension = ItkImageType::ImageDimension - 1;
+
+    auto reduce = [itkImage, &getValue](const RegionType &chunk, ExtremaAccumulator &result) {
+      itk::ImageRegionConstIterator<ItkImageType> it(itkImage, chunk);
+      for (; !it.IsAtEnd(); ++it)
+      {
+        result.Add(getValue(it.Get()));
+      }
+    };
+
+    const itk::SizeValueType numberOfPixels = region.GetNumberOfPixels();
+    const itk::SizeValueType splitSize = region.GetSize(splitDimension);
+    std::size_t numberOfChunks = std::max(1u, std::thread::hardware_concurrency());
+    numberOfChunks = std::min<std::size_t>(numberOfChunks, numberOfPixels / MinimumNumberOfPixelsPerThread);
+    numberOfChunks = std::min<std::size_t>(numberOfChunks, splitSize);
+
+    ExtremaAccumulator result;
+    if (numberOfChunks < 2)
+    {
+      reduce(region, result);
+      return result;
+    }
+
+    std::vector<ExtremaAccumulator> partialResults(numberOfChunks);
+    std::vector<std::thread> threads;
+    threads.reserve(numberOfChunks - 1);
+
+    for (std::size_t i = 0; i < numberOfChunks; ++i)
+    {
+      RegionType chunk = region;
+      const itk::SizeValueType begin = splitSize * i / numberOfChunks;
+      const itk::SizeValueType end = splitSize * (i + 1) / numberOfChunks;
+      chunk.SetIndex(splitDimension, region.GetIndex(splitDimension) + static_cast<itk::IndexValueType>(begin));
+      chunk.SetSize(splitDimension, end - begin);
+
+      // The calling thread processes the last chunk itself
+      if (i + 1 < numberOfChunks)
+        threads.emplace_back(reduce, chunk, std::ref(partialResults[i]));
+      else
+        reduce(chunk, partialResults[i]);
+    }
+
+    for (auto &thread : threads)
+    {
+      thread.join();
+    }
+
+    for (const auto &partialResult : partialResults)
+    {
+      result.Merge(partialResult);
+    }
+    return result;
   }
 
-  //// guard for wrong 2dMin/Max on single constant value images
-  if (statisticsHolder->m_ScalarMax[t] == statisticsHolder->m_ScalarMin[t])
+  void StoreExtrema(const ExtremaAccumulator &extrema,
+                    std::vector<unsigned int> &countOfMinValuedVoxels,
+                    std::vector<unsigned int> &countOfMaxValuedVoxels,
+                    std::vector<mitk::ScalarType> &scalarMin,
+                    std::vector<mitk::ScalarType> &scalarMax,
+                    std::vector<mitk::ScalarType> &scalar2ndMin,
+                    std::vector<mitk::ScalarType> &scalar2ndMax,
+                    int t)
   {
-    statisticsHolder->m_Scalar2ndMax[t] = statisticsHolder->m_Scalar2ndMin[t] = statisticsHolder->m_ScalarMax[t];
+    countOfMinValuedVoxels[t] = extrema.CountOfMin;
+    countOfMaxValuedVoxels[t] = extrema.CountOfMax;
+    scalarMin[t] = extrema.Min;
+    scalarMax[t] = extrema.Max;
+    scalar2ndMin[t] = extrema.SecondMin;
+    scalar2ndMax[t] = extrema.SecondMax;
+
+    //// guard for wrong 2dMin/Max on single constant value images
+    if (scalarMax[t] == scalarMin[t])
+    {
+      scalar2ndMax[t] = scalar2ndMin[t] = scalarMax[t];
+    }
   }
+}
+
+template <typename ItkImageType>
+void mitk::_ComputeExtremaInItkImage(const ItkImageType *itkImage, mitk::ImageStatisticsHolder *statisticsHolder, int t)
+{
+  typename ItkImageType::RegionType region;
+  region = itkImage->GetBufferedRegion();
+  if (region.Crop(itkImage->GetRequestedRegion()) == false)
+    return;
+  if (region != itkImage->GetRequestedRegion())
+    return;
+
+  if (statisticsHolder == nullptr || !statisticsHolder->IsValidTimeStep(t))
+    return;
+  statisticsHolder->Expand(t + 1); // make sure we have initialized all arrays
+
+  typedef typename ItkImageType::PixelType TPixel;
+  ExtremaAccumulator extrema =
+    ComputeExtremaInRegion(itkImage, region, [](const TPixel &value) { return static_cast<ScalarType>(value); });
+
+  StoreExtrema(extrema,
+               statisticsHolder->m_CountOfMinValuedVoxels,
+               statisticsHolder->m_CountOfMaxValuedVoxels,
+               statisticsHolder->m_ScalarMin,
+               statisticsHolder->m_ScalarMax,
+               statisticsHolder->m_Scalar2ndMin,
+               statisticsHolder->m_Scalar2ndMax,
+               t);
   statisticsHolder->m_LastRecomputeTimeStamp.Modified();
 }
 
@@ -192,68 +335,22 @@ void mitk::_ComputeExtremaInItkVectorImage(const ItkImageType *itkImage,
   if (region != itkImage->GetRequestedRegion())
     return;
 
-  itk::ImageRegionConstIterator<ItkImageType> it(itkImage, region);
-
   if (statisticsHolder == nullptr || !statisticsHolder->IsValidTimeStep(t))
     return;
   statisticsHolder->Expand(t + 1); // make sure we have initialized all arrays
-  statisticsHolder->m_CountOfMinValuedVoxels[t] = 0;
-  statisticsHolder->m_CountOfMaxValuedVoxels[t] = 0;
 
-  statisticsHolder->m_Scalar2ndMin[t] = statisticsHolder->m_ScalarMin[t] = itk::NumericTraits<ScalarType>::max();
-  statisticsHolder->m_Scalar2ndMax[t] = statisticsHolder->m_ScalarMax[t] =
-    itk::NumericTraits<ScalarType>::NonpositiveMin();
-
-  while (!it.IsAtEnd())
-  {
-    double value = it.Get()[component];
-#ifdef BOUNDINGOBJECT_IGNORE
-    if (value > -32765)
-    {
-#endif
-      // update min
-      if (value < statisticsHolder->m_ScalarMin[t])
-      {
-        statisticsHolder->m_Scalar2ndMin[t] = statisticsHolder->m_ScalarMin[t];
-        statisticsHolder->m_ScalarMin[t] = value;
-        statisticsHolder->m_CountOfMinValuedVoxels[t] = 1;
-      }
-      else if (value == statisticsHolder->m_ScalarMin[t])
-      {
-        ++statisticsHolder->m_CountOfMinValuedVoxels[t];
-      }
-      else if (value < statisticsHolder->m_Scalar2ndMin[t])
-      {
-        statisticsHolder->m_Scalar2ndMin[t] = value;
-      }
-
-      // update max
-      if (value > statisticsHolder->m_ScalarMax[t])
-      {
-        statisticsHolder->m_Scalar2ndMax[t] = statisticsHolder->m_ScalarMax[t];
-        statisticsHolder->m_ScalarMax[t] = value;
-        statisticsHolder->m_CountOfMaxValuedVoxels[t] = 1;
-      }
-      else if (value == statisticsHolder->m_ScalarMax[t])
-      {
-        ++statisticsHolder->m_CountOfMaxValuedVoxels[t];
-      }
-      else if (value > statisticsHolder->m_Scalar2ndMax[t])
-      {
-        statisticsHolder->m_Scalar2ndMax[t] = value;
-      }
-#ifdef BOUNDINGOBJECT_IGNORE
-    }
-#endif
-
-    ++it;
-  }
-
-  //// guard for wrong 2dMin/Max on single constant value images
-  if (statisticsHolder->m_ScalarMax[t] == statisticsHolder->m_ScalarMin[t])
-  {
-    statisticsHolder->m_Scalar2ndMax[t] = statisticsHolder->m_Scalar2ndMin[t] = statisticsHolder->m_ScalarMax[t];
-  }
+  typedef typename ItkImageType::PixelType TPixel;
+  ExtremaAccumulator extrema = ComputeExtremaInRegion(
+    itkImage, region, [component](const TPixel &value) { return static_cast<ScalarType>(value[component]); });
+
+  StoreExtrema(extrema,
+               statisticsHolder->m_CountOfMinValuedVoxels,
+               statisticsHolder->m_CountOfMaxValuedVoxels,
+               statisticsHolder->m_ScalarMin,
+               statisticsHolder->m_ScalarMax,
+               statisticsHolder->m_Scalar2ndMin,
+               statisticsHolder->m_Scalar2ndMax,
+               t);
   statisticsHolder->m_LastRecomputeTimeStamp.Modified();
 }
 
@@ -20,6 +20,9 @@ mitk::ImageWriteAccessor::ImageWriteAccessor(ImagePointer image, const mitk::Ima
   : ImageAccessorBase(image.GetPointer(), iDI, OptionFlags), m_Image(image)
 
 {
+  // data shared with other images is copied before it may be written to
+  m_Image->DetachSharedData(this);
+
   OrganizeWriteAccess();
 }
 
@@ -34,6 +37,9 @@ mitk::ImageWriteAccessor::~ImageWriteAccessor()
   auto it = std::find(m_Image->m_Writers.begin(), m_Image->m_Writers.end(), this);
   m_Image->m_Writers.erase(it);
 
+  if (m_Image->m_Readers.empty() && m_Image->m_Writers.empty())
+    m_Image->m_RetiredDataHolders.clear();
+
   // delete lock, if there are no waiting ImageAccessors
   if (m_WaitLock->m_WaiterCount <= 0)
   {
@@ -47,6 +47,11 @@ mitk::LevelWindowManager::~LevelWindowManager()
       MessageDelegate1<LevelWindowManager, const mitk::DataNode *>(this, &LevelWindowManager::DataStorageAddedNode));
     m_DataStorage->RemoveNodeEvent.RemoveListener(
       MessageDelegate1<LevelWindowManager, const mitk::DataNode *>(this, &LevelWindowManager::DataStorageRemovedNode));
+    m_DataStorage->AddNodesEvent.RemoveListener(MessageDelegate1<LevelWindowManager, const DataStorage::SetOfObjects *>(
+      this, &LevelWindowManager::DataStorageAddedNodes));
+    m_DataStorage->RemoveNodesEvent.RemoveListener(
+      MessageDelegate1<LevelWindowManager, const DataStorage::SetOfObjects *>(
+        this, &LevelWindowManager::DataStorageRemovedNodes));
     m_DataStorage = nullptr;
   }
 
@@ -72,6 +77,11 @@ void mitk::LevelWindowManager::SetDataStorage(mitk::DataStorage *ds)
       MessageDelegate1<LevelWindowManager, const mitk::DataNode *>(this, &LevelWindowManager::DataStorageAddedNode));
     m_DataStorage->RemoveNodeEvent.RemoveListener(
       MessageDelegate1<LevelWindowManager, const mitk::DataNode *>(this, &LevelWindowManager::DataStorageRemovedNode));
+    m_DataStorage->AddNodesEvent.RemoveListener(MessageDelegate1<LevelWindowManager, const DataStorage::SetOfObjects *>(
+      this, &LevelWindowManager::DataStorageAddedNodes));
+    m_DataStorage->RemoveNodesEvent.RemoveListener(
+      MessageDelegate1<LevelWindowManager, const DataStorage::SetOfObjects *>(
+        this, &LevelWindowManager::DataStorageRemovedNodes));
   }
 
   /* register listener for new DataStorage */
@@ -80,6 +90,10 @@ void mitk::LevelWindowManager::SetDataStorage(mitk::DataStorage *ds)
     MessageDelegate1<LevelWindowManager, const mitk::DataNode *>(this, &LevelWindowManager::DataStorageAddedNode));
   m_DataStorage->RemoveNodeEvent.AddListener(
     MessageDelegate1<LevelWindowManager, const mitk::DataNode *>(this, &LevelWindowManager::DataStorageRemovedNode));
+  m_DataStorage->AddNodesEvent.AddListener(MessageDelegate1<LevelWindowManager, const DataStorage::SetOfObjects *>(
+    this, &LevelWindowManager::DataStorageAddedNodes));
+  m_DataStorage->RemoveNodesEvent.AddListener(MessageDelegate1<LevelWindowManager, const DataStorage::SetOfObjects *>(
+    this, &LevelWindowManager::DataStorageRemovedNodes));
 
   this->DataStorageAddedNode(); // update us with new DataStorage
 }
@@ -263,8 +277,12 @@ void mitk::LevelWindowManager::SetLevelWindow(const mitk::LevelWindow &levelWind
   this->Modified();
 }
 
-void mitk::LevelWindowManager::DataStorageAddedNode(const mitk::DataNode *)
+void mitk::LevelWindowManager::DataStorageAddedNode(const mitk::DataNode *n)
 {
+  // batch updates are handled once in DataStorageAddedNodes()
+  if (n != nullptr && m_DataStorage->IsBatchUpdateActive())
+    return;
+
   // update observers with new data storage
   UpdateObservers();
 
@@ -281,6 +299,10 @@ void mitk::LevelWindowManager::DataStorageAddedNode(const mitk::DataNode *)
 
 void mitk::LevelWindowManager::DataStorageRemovedNode(const mitk::DataNode *removedNode)
 {
+  // batch updates are handled once in DataStorageRemovedNodes()
+  if (removedNode != nullptr && m_DataStorage->IsBatchUpdateActive())
+    return;
+
   // first: check if deleted node is part of relevant nodes. If not, abort method because there is no need change
   // anything.
   if ((this->GetRelevantNodes()->size() == 0))
@@ -334,6 +356,28 @@ void mitk::LevelWindowManager::DataStorageRemovedNode(const mitk::DataNode *remo
   }
 }
 
+void mitk::LevelWindowManager::DataStorageAddedNodes(const DataStorage::SetOfObjects *)
+{
+  this->DataStorageAddedNode();
+}
+
+void mitk::LevelWindowManager::DataStorageRemovedNodes(const DataStorage::SetOfObjects *)
+{
+  // the removed nodes are no longer in the data storage, so the observers can simply be recreated
+  UpdateObservers();
+
+  if (m_LevelWindowProperty.IsNull() || m_AutoTopMost)
+  {
+    SetAutoTopMostImage(true);
+  }
+  else
+  {
+    mitk::NodePredicateProperty::Pointer p2 = mitk::NodePredicateProperty::New("levelwindow", m_LevelWindowProperty);
+    if (m_DataStorage->GetNode(p2) == nullptr) // the node of the level window was removed
+      SetAutoTopMostImage(true);
+  }
+}
+
 void mitk::LevelWindowManager::UpdateObservers()
 {
   this->ClearPropObserverLists(); // remove old observers
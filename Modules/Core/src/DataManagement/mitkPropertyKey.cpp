@@ -0,0 +1,191 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#include "mitkPropertyKey.h"
+
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+  /** Process wide storage of the interned property names. The deque keeps the
+   *  addresses of the strings stable while new names are added. */
+  struct PropertyKeyRegistry
+  {
+    std::mutex mutex;
+    std::deque<std::string> names;
+    std::unordered_map<std::string, const std::string *> lookup;
+  };
+
+  PropertyKeyRegistry &GetPropertyKeyRegistry()
+  {
+    static PropertyKeyRegistry registry;
+    return registry;
+  }
+}
+
+mitk::PropertyKey::PropertyKey(const std::string &name)
+{
+  this->Intern(name.c_str(), name.size());
+}
+
+mitk::PropertyKey::PropertyKey(const char *name)
+{
+  this->Intern(name != nullptr ? name : "", name != nullptr ? std::strlen(name) : 0);
+}
+
+void mitk::PropertyKey::Intern(const char *name, std::size_t length)
+{
+  m_Hash = Hash(name, length);
+
+  auto &registry = GetPropertyKeyRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+
+  std::string key(name, length);
+  auto it = registry.lookup.find(key);
+  if (it == registry.lookup.end())
+  {
+    registry.names.push_back(key);
+    it = registry.lookup.insert(std::make_pair(key, &registry.names.back())).first;
+  }
+  m_Name = it->second;
+}
+
+std::size_t mitk::PropertyKey::Hash(const char *name, std::size_t length)
+{
+  std::size_t hash = sizeof(std::size_t) == 8 ? static_cast<std::size_t>(14695981039346656037ULL) : 2166136261U;
+  const std::size_t prime = sizeof(std::size_t) == 8 ? static_cast<std::size_t>(1099511628211ULL) : 16777619U;
+
+  for (std::size_t i = 0; i < length; ++i)
+  {
+    hash ^= static_cast<unsigned char>(name[i]);
+    hash *= prime;
+  }
+  return hash;
+}
+
+mitk::PropertyKeyIndex::PropertyKeyIndex() : m_Size(0)
+{
+}
+
+std::size_t mitk::PropertyKeyIndex::FindSlot(const char *name, std::size_t length, std::size_t hash) const
+{
+  const std::size_t mask = m_Entries.size() - 1;
+  std::size_t slot = hash & mask;
+
+  while (nullptr != m_Entries[slot].name)
+  {
+    const Entry &entry = m_Entries[slot];
+    if (entry.hash == hash && entry.name->size() == length && 0 == entry.name->compare(0, length, name, length))
+      break;
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+mitk::BaseProperty *mitk::PropertyKeyIndex::Find(const PropertyKey &key) const
+{
+  if (0 == m_Size)
+    return nullptr;
+
+  const std::string &name = key.GetName();
+  return m_Entries[this->FindSlot(name.c_str(), name.size(), key.GetHash())].property;
+}
+
+mitk::BaseProperty *mitk::PropertyKeyIndex::Find(const char *name, std::size_t length) const
+{
+  if (0 == m_Size)
+    return nullptr;
+
+  return m_Entries[this->FindSlot(name, length, PropertyKey::Hash(name, length))].property;
+}
+
+void mitk::PropertyKeyIndex::Insert(const std::string *name, BaseProperty *property)
+{
+  // keep the load factor at or below 0.5 so that probe sequences stay short
+  if (2 * (m_Size + 1) > m_Entries.size())
+    this->Rehash(m_Entries.empty() ? 16 : 2 * m_Entries.size());
+
+  const std::size_t hash = PropertyKey::Hash(name->c_str(), name->size());
+  Entry &entry = m_Entries[this->FindSlot(name->c_str(), name->size(), hash)];
+
+  if (nullptr == entry.name)
+    ++m_Size;
+
+  entry.hash = hash;
+  entry.name = name;
+  entry.property = property;
+}
+
+void mitk::PropertyKeyIndex::Erase(const std::string &name)
+{
+  if (0 == m_Size)
+    return;
+
+  const std::size_t mask = m_Entries.size() - 1;
+  std::size_t hole = this->FindSlot(name.c_str(), name.size(), PropertyKey::Hash(name.c_str(), name.size()));
+
+  if (nullptr == m_Entries[hole].name)
+    return;
+
+  // backward shift deletion: move following entries of the probe sequence
+  // into the hole so that no tombstones are needed
+  std::size_t slot = hole;
+  while (true)
+  {
+    slot = (slot + 1) & mask;
+    const Entry &entry = m_Entries[slot];
+    if (nullptr == entry.name)
+      break;
+
+    const std::size_t home = entry.hash & mask;
+    if (((slot - home) & mask) >= ((slot - hole) & mask))
+    {
+      m_Entries[hole] = entry;
+      hole = slot;
+    }
+  }
+
+  m_Entries[hole] = Entry{0, nullptr, nullptr};
+  --m_Size;
+}
+
+void mitk::PropertyKeyIndex::Clear()
+{
+  m_Entries.clear();
+  m_Size = 0;
+}
+
+void mitk::PropertyKeyIndex::Rehash(std::size_t capacity)
+{
+  std::vector<Entry> entries(capacity, Entry{0, nullptr, nullptr});
+  entries.swap(m_Entries);
+
+  const std::size_t mask = capacity - 1;
+  for (const auto &entry : entries)
+  {
+    if (nullptr == entry.name)
+      continue;
+
+    std::size_t slot = entry.hash & mask;
+    while (nullptr != m_Entries[slot].name)
+      slot = (slot + 1) & mask;
+    m_Entries[slot] = entry;
+  }
+}
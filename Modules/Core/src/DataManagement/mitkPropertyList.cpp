@@ -20,15 +20,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkProperties.h"
 #include "mitkStringProperty.h"
 
+#include <cstring>
+
 mitk::BaseProperty::ConstPointer mitk::PropertyList::GetConstProperty(const std::string &propertyKey, const std::string &/*contextName*/, bool /*fallBackOnDefaultContext*/) const
 {
-  PropertyMap::const_iterator it;
-
-  it = m_Properties.find(propertyKey);
-  if (it != m_Properties.cend())
-    return it->second.GetPointer();
-  else
-    return nullptr;
+  return m_PropertyIndex.Find(propertyKey);
 };
 
 std::vector<std::string> mitk::PropertyList::GetPropertyKeys(const std::string &contextName, bool includeDefaultContext) const
@@ -51,13 +47,20 @@ std::vector<std::string> mitk::PropertyList::GetPropertyContextNames() const
 
 mitk::BaseProperty *mitk::PropertyList::GetProperty(const std::string &propertyKey) const
 {
-  PropertyMap::const_iterator it;
+  return m_PropertyIndex.Find(propertyKey);
+}
 
-  it = m_Properties.find(propertyKey);
-  if (it != m_Properties.cend())
-    return it->second;
-  else
+mitk::BaseProperty *mitk::PropertyList::GetProperty(const char *propertyKey) const
+{
+  if (nullptr == propertyKey)
     return nullptr;
+
+  return m_PropertyIndex.Find(propertyKey, std::strlen(propertyKey));
+}
+
+mitk::BaseProperty *mitk::PropertyList::GetProperty(const PropertyKey &propertyKey) const
+{
+  return m_PropertyIndex.Find(propertyKey);
 }
 
 mitk::BaseProperty * mitk::PropertyList::GetNonConstProperty(const std::string &propertyKey, const std::string &/*contextName*/, bool /*fallBackOnDefaultContext*/)
@@ -107,7 +110,8 @@ void mitk::PropertyList::SetProperty(const std::string &propertyKey, BasePropert
   }
 
   // no? add it.
-  m_Properties.insert(PropertyMap::value_type(propertyKey, property));
+  it = m_Properties.insert(PropertyMap::value_type(propertyKey, property)).first;
+  m_PropertyIndex.Insert(&it->first, property);
   this->Modified();
 }
 
@@ -121,12 +125,15 @@ void mitk::PropertyList::ReplaceProperty(const std::string &propertyKey, BasePro
   // Is a property with key @a propertyKey contained in the list?
   if (it != m_Properties.cend())
   {
-    it->second = nullptr;
-    m_Properties.erase(it);
+    // the map node is kept so that the index entry stays valid
+    it->second = property;
   }
-
-  // no? add/replace it.
-  m_Properties.insert(PropertyMap::value_type(propertyKey, property));
+  else
+  {
+    // no? add it.
+    it = m_Properties.insert(PropertyMap::value_type(propertyKey, property)).first;
+  }
+  m_PropertyIndex.Insert(&it->first, property);
   Modified();
 }
 
@@ -137,6 +144,7 @@ void mitk::PropertyList::RemoveProperty(const std::string &propertyKey, const st
   // Is a property with key @a propertyKey contained in the list?
   if (it != m_Properties.cend())
   {
+    m_PropertyIndex.Erase(propertyKey);
     it->second = nullptr;
     m_Properties.erase(it);
     Modified();
@@ -151,7 +159,8 @@ mitk::PropertyList::PropertyList(const mitk::PropertyList &other) : itk::Object(
 {
   for (auto i = other.m_Properties.cbegin(); i != other.m_Properties.cend(); ++i)
   {
-    m_Properties.insert(std::make_pair(i->first, i->second->Clone()));
+    auto it = m_Properties.insert(std::make_pair(i->first, i->second->Clone())).first;
+    m_PropertyIndex.Insert(&it->first, it->second);
   }
 }
 
@@ -188,6 +197,7 @@ bool mitk::PropertyList::DeleteProperty(const std::string &propertyKey)
 
   if (it != m_Properties.end())
   {
+    m_PropertyIndex.Erase(propertyKey);
     it->second = nullptr;
     m_Properties.erase(it);
     Modified();
@@ -204,6 +214,7 @@ void mitk::PropertyList::Clear()
     it->second = nullptr;
     ++it;
   }
+  m_PropertyIndex.Clear();
   m_Properties.clear();
 }
 
@@ -14,6 +14,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 ===================================================================*/
 
+#include <algorithm>
+
 #include <itkSpatialOrientationAdapter.h>
 
 #include "mitkSlicedGeometry3D.h"
@@ -29,20 +31,31 @@ See LICENSE.txt or http://www.mitk.org for details.
 const mitk::ScalarType PI = 3.14159265359;
 
 mitk::SlicedGeometry3D::SlicedGeometry3D()
-  : m_EvenlySpaced(true), m_Slices(0), m_ReferenceGeometry(nullptr), m_SliceNavigationController(nullptr)
+  : m_EvenlySpaced(true),
+    m_SliceStepCachePlane(nullptr),
+    m_SliceStepCachePlaneMTime(0),
+    m_SliceStepCacheMTime(0),
+    m_Slices(0),
+    m_ReferenceGeometry(nullptr),
+    m_SliceNavigationController(nullptr)
 {
   m_DirectionVector.Fill(0);
+  m_SliceStep.Fill(0);
   this->InitializeSlicedGeometry(m_Slices);
 }
 
 mitk::SlicedGeometry3D::SlicedGeometry3D(const SlicedGeometry3D &other)
   : Superclass(other),
     m_EvenlySpaced(other.m_EvenlySpaced),
+    m_SliceStepCachePlane(nullptr),
+    m_SliceStepCachePlaneMTime(0),
+    m_SliceStepCacheMTime(0),
     m_Slices(other.m_Slices),
     m_ReferenceGeometry(other.m_ReferenceGeometry),
     m_SliceNavigationController(other.m_SliceNavigationController)
 {
   m_DirectionVector.Fill(0);
+  m_SliceStep.Fill(0);
   SetSpacing(other.GetSpacing());
   SetDirectionVector(other.GetDirectionVector());
 
@@ -90,30 +103,15 @@ mitk::PlaneGeometry *mitk::SlicedGeometry3D::GetPlaneGeometry(int s) const
     // is a PlaneGeometry instance, then we calculate the geometry of the
     // requested as the plane of the first slice shifted by m_Spacing[2]*s
     // in the direction of m_DirectionVector.
-    if ((m_EvenlySpaced) && (geometry2D.IsNull()))
+    if ((m_EvenlySpaced) && (geometry2D.IsNull()) && this->UpdateSliceStepCache())
     {
-      PlaneGeometry *firstSlice = m_PlaneGeometries[0];
-
-      if (firstSlice != nullptr &&
-          dynamic_cast<AbstractTransformGeometry *>(m_PlaneGeometries[0].GetPointer()) == nullptr)
-      {
-        if ((m_DirectionVector[0] == 0.0) && (m_DirectionVector[1] == 0.0) && (m_DirectionVector[2] == 0.0))
-        {
-          m_DirectionVector = firstSlice->GetNormal();
-          m_DirectionVector.Normalize();
-        }
-
-        Vector3D direction;
-        direction = m_DirectionVector * this->GetSpacing()[2];
+      mitk::PlaneGeometry::Pointer requestedslice;
+      requestedslice = static_cast<mitk::PlaneGeometry *>(m_PlaneGeometries[0]->Clone().GetPointer());
 
-        mitk::PlaneGeometry::Pointer requestedslice;
-        requestedslice = static_cast<mitk::PlaneGeometry *>(firstSlice->Clone().GetPointer());
+      requestedslice->SetOrigin(m_FirstSliceOrigin + m_SliceStep * s);
 
-        requestedslice->SetOrigin(requestedslice->GetOrigin() + direction * s);
-
-        geometry2D = requestedslice;
-        m_PlaneGeometries[s] = geometry2D;
-      }
+      geometry2D = requestedslice;
+      m_PlaneGeometries[s] = geometry2D;
     }
     return geometry2D;
   }
@@ -123,6 +121,82 @@ mitk::PlaneGeometry *mitk::SlicedGeometry3D::GetPlaneGeometry(int s) const
   }
 }
 
+bool mitk::SlicedGeometry3D::UpdateSliceStepCache() const
+{
+  const PlaneGeometry *firstSlice = m_PlaneGeometries.empty() ? nullptr : m_PlaneGeometries[0].GetPointer();
+
+  if (firstSlice == nullptr || dynamic_cast<const AbstractTransformGeometry *>(firstSlice) != nullptr)
+  {
+    m_SliceStepCachePlane = nullptr;
+    return false;
+  }
+
+  const AffineTransform3D *transform = firstSlice->GetIndexToWorldTransform();
+  itk::ModifiedTimeType planeMTime = std::max(firstSlice->GetMTime(), transform->GetMTime());
+
+  if (m_SliceStepCachePlane == firstSlice && m_SliceStepCachePlaneMTime == planeMTime &&
+      m_SliceStepCacheMTime == this->GetMTime())
+  {
+    return true;
+  }
+
+  if ((m_DirectionVector[0] == 0.0) && (m_DirectionVector[1] == 0.0) && (m_DirectionVector[2] == 0.0))
+  {
+    m_DirectionVector = firstSlice->GetNormal();
+    m_DirectionVector.Normalize();
+  }
+
+  m_FirstSliceMatrix = transform->GetMatrix();
+  m_FirstSliceOrigin = firstSlice->GetOrigin();
+  m_SliceStep = m_DirectionVector * this->GetSpacing()[2];
+
+  m_SliceStepCachePlane = firstSlice;
+  m_SliceStepCachePlaneMTime = planeMTime;
+  m_SliceStepCacheMTime = this->GetMTime();
+  return true;
+}
+
+bool mitk::SlicedGeometry3D::GetSliceIndexToWorldTransform(int s,
+                                                           AffineTransform3D::MatrixType &matrix,
+                                                           AffineTransform3D::OutputVectorType &offset) const
+{
+  if (!this->IsValidSlice(s))
+  {
+    return false;
+  }
+
+  const PlaneGeometry *slice = m_PlaneGeometries[s];
+  if (slice != nullptr)
+  {
+    matrix = slice->GetIndexToWorldTransform()->GetMatrix();
+    offset = slice->GetIndexToWorldTransform()->GetOffset();
+    return true;
+  }
+
+  if (!m_EvenlySpaced || !this->UpdateSliceStepCache())
+  {
+    return false;
+  }
+
+  matrix = m_FirstSliceMatrix;
+  offset = m_FirstSliceOrigin.GetVectorFromOrigin() + m_SliceStep * s;
+  return true;
+}
+
+bool mitk::SlicedGeometry3D::GetSliceOrigin(int s, Point3D &origin) const
+{
+  AffineTransform3D::MatrixType matrix;
+  AffineTransform3D::OutputVectorType offset;
+
+  if (!this->GetSliceIndexToWorldTransform(s, matrix, offset))
+  {
+    return false;
+  }
+
+  mitk::FillVector3D(origin, offset[0], offset[1], offset[2]);
+  return true;
+}
+
 const mitk::BoundingBox *mitk::SlicedGeometry3D::GetBoundingBox() const
 {
   assert(this->IsBoundingBoxNull() == false);
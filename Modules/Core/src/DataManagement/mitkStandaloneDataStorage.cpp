@@ -18,11 +18,41 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "itkMutexLockHolder.h"
 #include "itkSimpleFastMutexLock.h"
+#include "mitkBaseData.h"
 #include "mitkDataNode.h"
 #include "mitkGroupTagProperty.h"
+#include "mitkNodePredicateAnd.h"
 #include "mitkNodePredicateBase.h"
+#include "mitkNodePredicateDataType.h"
+#include "mitkNodePredicateDataUID.h"
+#include "mitkNodePredicateOr.h"
 #include "mitkNodePredicateProperty.h"
+#include "mitkNodePredicateSource.h"
 #include "mitkProperties.h"
+#include "mitkStringProperty.h"
+
+namespace
+{
+  template <class TIndex>
+  void EraseFromIndex(TIndex &index, const std::string &key, const mitk::DataNode *node)
+  {
+    auto it = index.find(key);
+    if (it == index.end())
+      return;
+
+    it->second.erase(node);
+    if (it->second.empty())
+      index.erase(it);
+  }
+
+  template <class TIndex, class TNodeSet>
+  void InsertFromIndex(const TIndex &index, const std::string &key, TNodeSet &candidates)
+  {
+    auto it = index.find(key);
+    if (it != index.end())
+      candidates.insert(it->second.cbegin(), it->second.cend());
+  }
+}
 
 mitk::StandaloneDataStorage::StandaloneDataStorage() : mitk::DataStorage()
 {
@@ -83,6 +113,8 @@ void mitk::StandaloneDataStorage::Add(mitk::DataNode *node, const mitk::DataStor
                           node); // node is derived from parent. Insert it into the parents list of derived objects
     }
 
+    this->UpdateIndex(node);
+
     // register for ITK changed events
     this->AddListeners(node);
   }
@@ -116,6 +148,10 @@ void mitk::StandaloneDataStorage::Remove(const mitk::DataNode *node)
     /* remove node from both relation adjacency lists */
     this->RemoveFromRelation(node, m_SourceNodes);
     this->RemoveFromRelation(node, m_DerivedNodes);
+
+    this->RemoveFromIndex(node);
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> outdatedLocked(m_OutdatedNodesMutex);
+    m_OutdatedNodes.erase(node);
   }
 }
 
@@ -187,10 +223,13 @@ mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetRe
   /* Or traverse adjacency list to collect all related nodes */
   std::vector<mitk::DataNode::ConstPointer> resultset;
   std::vector<mitk::DataNode::ConstPointer> openlist;
+  /* nodes that are either in resultset or in openlist */
+  std::set<const mitk::DataNode *> visited;
 
   /* Initialize openlist with node. this will add node to resultset,
      but that is necessary to detect circular relations that would lead to endless recursion */
   openlist.push_back(node);
+  visited.insert(node);
 
   while (openlist.size() > 0)
   {
@@ -209,11 +248,8 @@ mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetRe
            ++parentIt) // for each parent of current node
       {
         mitk::DataNode::ConstPointer p = parentIt.Value().GetPointer();
-        if (!(std::find(resultset.cbegin(), resultset.cend(), p) !=
-              resultset.end()) // if it is not already in resultset
-            &&
-            !(std::find(openlist.cbegin(), openlist.cend(), p) != openlist.cend())) // and not already in openlist
-          openlist.push_back(p); // then add it to openlist, so that it can be processed
+        if (visited.insert(p.GetPointer()).second) // if it is not already in resultset or openlist
+          openlist.push_back(p);                   // then add it to openlist, so that it can be processed
       }
   }
 
@@ -255,6 +291,179 @@ mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetDe
   return this->GetRelations(node, m_DerivedNodes, condition, onlyDirectDerivations);
 }
 
+mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetSubset(
+  const NodePredicateBase *condition) const
+{
+  mitk::DataStorage::SetOfObjects::Pointer candidateSet = mitk::DataStorage::SetOfObjects::New();
+  bool indexed = false;
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
+    if (!IsInitialized())
+      throw std::logic_error("DataStorage not initialized");
+
+    NodeSet outdatedNodes;
+    {
+      itk::MutexLockHolder<itk::SimpleFastMutexLock> outdatedLocked(m_OutdatedNodesMutex);
+      outdatedNodes.swap(m_OutdatedNodes);
+    }
+    for (auto node : outdatedNodes)
+      if (m_IndexKeys.find(node) != m_IndexKeys.end())
+        this->UpdateIndex(node);
+
+    NodeSet candidates;
+    indexed = this->GetIndexCandidates(condition, candidates);
+    if (indexed)
+      for (auto node : candidates)
+        candidateSet->InsertElement(candidateSet->Size(), const_cast<mitk::DataNode *>(node));
+  }
+
+  /* the predicates might query the storage again, so they are evaluated without holding m_Mutex */
+  if (!indexed)
+    return Superclass::GetSubset(condition);
+
+  return this->FilterSetOfObjects(candidateSet, condition);
+}
+
+void mitk::StandaloneDataStorage::NodeModified(const mitk::DataNode *node)
+{
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_OutdatedNodesMutex);
+  m_OutdatedNodes.insert(node);
+}
+
+void mitk::StandaloneDataStorage::UpdateIndex(const mitk::DataNode *node) const
+{
+  this->RemoveFromIndex(node);
+
+  IndexKeys keys;
+
+  /* nodes without an own name fall back on the name of their data, which is not tracked */
+  const BaseProperty *nameProperty = node->GetProperty("name", nullptr, false);
+  if (nameProperty == nullptr)
+  {
+    m_UnnamedNodes.insert(node);
+  }
+  else if (auto stringProperty = dynamic_cast<const StringProperty *>(nameProperty))
+  {
+    keys.HasName = true;
+    keys.Name = stringProperty->GetValue();
+    m_NameIndex[keys.Name].insert(node);
+  }
+
+  const BaseData *data = node->GetData();
+  if (data != nullptr)
+  {
+    keys.HasData = true;
+    keys.DataType = data->GetNameOfClass();
+    keys.DataUID = data->GetUID();
+    m_DataTypeIndex[keys.DataType].insert(node);
+    m_DataUIDIndex[keys.DataUID].insert(node);
+  }
+
+  m_IndexKeys[node] = keys;
+}
+
+void mitk::StandaloneDataStorage::RemoveFromIndex(const mitk::DataNode *node) const
+{
+  m_UnnamedNodes.erase(node);
+
+  auto keysIter = m_IndexKeys.find(node);
+  if (keysIter == m_IndexKeys.end())
+    return;
+
+  const IndexKeys &keys = keysIter->second;
+  if (keys.HasName)
+    EraseFromIndex(m_NameIndex, keys.Name, node);
+  if (keys.HasData)
+  {
+    EraseFromIndex(m_DataTypeIndex, keys.DataType, node);
+    EraseFromIndex(m_DataUIDIndex, keys.DataUID, node);
+  }
+
+  m_IndexKeys.erase(keysIter);
+}
+
+bool mitk::StandaloneDataStorage::GetIndexCandidates(const NodePredicateBase *condition, NodeSet &candidates) const
+{
+  if (condition == nullptr)
+    return false;
+
+  if (auto dataTypePredicate = dynamic_cast<const NodePredicateDataType *>(condition))
+  {
+    InsertFromIndex(m_DataTypeIndex, dataTypePredicate->GetValidDataType(), candidates);
+    return true;
+  }
+
+  if (auto dataUIDPredicate = dynamic_cast<const NodePredicateDataUID *>(condition))
+  {
+    InsertFromIndex(m_DataUIDIndex, dataUIDPredicate->GetUID(), candidates);
+    return true;
+  }
+
+  if (auto propertyPredicate = dynamic_cast<const NodePredicateProperty *>(condition))
+  {
+    auto nameProperty = dynamic_cast<const StringProperty *>(propertyPredicate->GetValidProperty());
+    if (propertyPredicate->GetRenderer() != nullptr || propertyPredicate->GetValidPropertyName() != "name" ||
+        nameProperty == nullptr)
+      return false;
+
+    InsertFromIndex(m_NameIndex, nameProperty->GetValue(), candidates);
+    candidates.insert(m_UnnamedNodes.cbegin(), m_UnnamedNodes.cend());
+    return true;
+  }
+
+  if (auto sourcePredicate = dynamic_cast<const NodePredicateSource *>(condition))
+  {
+    if (sourcePredicate->GetDataStorage().GetPointer() != this)
+      return false;
+
+    mitk::DataNode::Pointer baseNode = sourcePredicate->GetBaseNode();
+    if (baseNode.IsNull())
+      return true;
+
+    /* a node has the base node as source if it is derived from the base node */
+    SetOfObjects::ConstPointer derivations =
+      this->GetRelations(baseNode, m_DerivedNodes, nullptr, !sourcePredicate->GetSearchAllSources());
+    for (SetOfObjects::ConstIterator it = derivations->Begin(); it != derivations->End(); ++it)
+      candidates.insert(it.Value().GetPointer());
+    return true;
+  }
+
+  if (auto andPredicate = dynamic_cast<const NodePredicateAnd *>(condition))
+  {
+    /* every child has to be fulfilled, so the smallest candidate set of any indexed child suffices */
+    NodeSet smallestCandidates;
+    bool indexed = false;
+    for (const auto &child : andPredicate->GetPredicates())
+    {
+      NodeSet childCandidates;
+      if (!this->GetIndexCandidates(child, childCandidates))
+        continue;
+
+      if (!indexed || childCandidates.size() < smallestCandidates.size())
+        smallestCandidates.swap(childCandidates);
+      indexed = true;
+    }
+
+    candidates.insert(smallestCandidates.cbegin(), smallestCandidates.cend());
+    return indexed;
+  }
+
+  if (auto orPredicate = dynamic_cast<const NodePredicateOr *>(condition))
+  {
+    /* any child may be fulfilled, so all of them have to be indexed */
+    const NodePredicateCompositeBase::ChildPredicates children = orPredicate->GetPredicates();
+    if (children.empty())
+      return false;
+
+    for (const auto &child : children)
+      if (!this->GetIndexCandidates(child, candidates))
+        return false;
+    return true;
+  }
+
+  return false;
+}
+
 void mitk::StandaloneDataStorage::PrintSelf(std::ostream &os, itk::Indent indent) const
 {
   os << indent << "StandaloneDataStorage:\n";
@@ -19,6 +19,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkSurfaceOperation.h"
 
 #include <algorithm>
+#include <cstring>
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
 #include <vtkPolyData.h>
 
 static vtkSmartPointer<vtkPolyData> DeepCopy(vtkPolyData *other)
@@ -32,6 +38,68 @@ static vtkSmartPointer<vtkPolyData> DeepCopy(vtkPolyData *other)
   return copy;
 }
 
+/** Returns a poly data that references the cells and cell data of topology, with the given points and point data. */
+static vtkSmartPointer<vtkPolyData> ShareCells(vtkPolyData *topology, vtkPoints *points, vtkPointData *pointData)
+{
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  polyData->ShallowCopy(topology);
+  polyData->SetPoints(points);
+  polyData->GetPointData()->Initialize();
+  if (pointData != nullptr)
+    polyData->GetPointData()->ShallowCopy(pointData);
+  return polyData;
+}
+
+static bool SameCellArray(vtkCellArray *left, vtkCellArray *right)
+{
+  // vtkPolyData returns a dummy cell array for missing cell types
+  return left == right || (left->GetNumberOfCells() == 0 && right->GetNumberOfCells() == 0);
+}
+
+/** Cell attributes are part of the topology, they are only shared if they are the very same arrays */
+static bool SameCellData(vtkPolyData *left, vtkPolyData *right)
+{
+  vtkCellData *leftData = left->GetCellData();
+  vtkCellData *rightData = right->GetCellData();
+
+  if (leftData->GetNumberOfArrays() != rightData->GetNumberOfArrays())
+    return false;
+
+  for (int i = 0; i < leftData->GetNumberOfArrays(); ++i)
+  {
+    if (leftData->GetAbstractArray(i) != rightData->GetAbstractArray(i))
+      return false;
+  }
+
+  return true;
+}
+
+static bool SharesCells(vtkPolyData *left, vtkPolyData *right)
+{
+  return SameCellArray(left->GetVerts(), right->GetVerts()) && SameCellArray(left->GetLines(), right->GetLines()) &&
+         SameCellArray(left->GetPolys(), right->GetPolys()) && SameCellArray(left->GetStrips(), right->GetStrips()) &&
+         SameCellData(left, right);
+}
+
+static bool EqualCellArray(vtkCellArray *left, vtkCellArray *right)
+{
+  if (SameCellArray(left, right))
+    return true;
+
+  vtkIdTypeArray *leftData = left->GetData();
+  vtkIdTypeArray *rightData = right->GetData();
+  const vtkIdType numberOfValues = leftData->GetNumberOfValues();
+  return left->GetNumberOfCells() == right->GetNumberOfCells() && numberOfValues == rightData->GetNumberOfValues() &&
+         std::memcmp(leftData->GetPointer(0), rightData->GetPointer(0), numberOfValues * sizeof(vtkIdType)) == 0;
+}
+
+static bool EqualCells(vtkPolyData *left, vtkPolyData *right)
+{
+  return left->GetNumberOfPoints() == right->GetNumberOfPoints() && SameCellData(left, right) &&
+         EqualCellArray(left->GetVerts(), right->GetVerts()) && EqualCellArray(left->GetLines(), right->GetLines()) &&
+         EqualCellArray(left->GetPolys(), right->GetPolys()) && EqualCellArray(left->GetStrips(), right->GetStrips());
+}
+
 static void Update(vtkPolyData * /*polyData*/)
 {
   //  if (polyData != nullptr)
@@ -53,6 +121,7 @@ mitk::Surface::Surface(const mitk::Surface &other)
   {
     m_PolyDatas.resize(other.m_PolyDatas.size());
     std::transform(other.m_PolyDatas.cbegin(), other.m_PolyDatas.cend(), m_PolyDatas.begin(), DeepCopy);
+    this->RestoreSharedTopology(other);
   }
   else
   {
@@ -60,6 +129,18 @@ mitk::Surface::Surface(const mitk::Surface &other)
   }
 }
 
+void mitk::Surface::RestoreSharedTopology(const Surface &other)
+{
+  if (m_PolyDatas.size() != other.m_PolyDatas.size() || m_PolyDatas.empty() || m_PolyDatas[0] == nullptr)
+    return;
+
+  for (unsigned int t = 1; t < m_PolyDatas.size(); ++t)
+  {
+    if (m_PolyDatas[t] != nullptr && other.IsTopologyShared(t))
+      m_PolyDatas[t] = ShareCells(m_PolyDatas[0], m_PolyDatas[t]->GetPoints(), m_PolyDatas[t]->GetPointData());
+  }
+}
+
 void mitk::Surface::Swap(mitk::Surface &other)
 {
   std::swap(m_PolyDatas, other.m_PolyDatas);
@@ -131,6 +212,90 @@ void mitk::Surface::SetVtkPolyData(vtkPolyData *polyData, unsigned int t)
   this->UpdateOutputInformation();
 }
 
+void mitk::Surface::SetVtkPolyDataWithSharedTopology(vtkPoints *points, unsigned int t, vtkDataArray *scalars)
+{
+  vtkPolyData *topology = m_PolyDatas.empty() ? nullptr : m_PolyDatas[0].GetPointer();
+
+  if (topology == nullptr)
+    mitkThrow() << "Cannot share the topology of time step 0, it is not set.";
+
+  if (points == nullptr || points->GetNumberOfPoints() != topology->GetNumberOfPoints())
+    mitkThrow() << "Number of points of time step " << t << " does not match time step 0.";
+
+  if (t == 0)
+  {
+    topology->SetPoints(points);
+    if (scalars != nullptr)
+      topology->GetPointData()->SetScalars(scalars);
+
+    m_CalculateBoundingBox = true;
+    this->Modified();
+    this->UpdateOutputInformation();
+    return;
+  }
+
+  vtkSmartPointer<vtkPolyData> polyData = ShareCells(topology, points, nullptr);
+  if (scalars != nullptr)
+    polyData->GetPointData()->SetScalars(scalars);
+
+  this->SetVtkPolyData(polyData, t);
+}
+
+unsigned int mitk::Surface::ShareTopology()
+{
+  if (m_PolyDatas.empty() || m_PolyDatas[0] == nullptr)
+    return 0;
+
+  vtkPolyData *topology = m_PolyDatas[0];
+  unsigned int numberOfSharingTimeSteps = 1;
+  bool modified = false;
+
+  for (unsigned int t = 1; t < m_PolyDatas.size(); ++t)
+  {
+    vtkPolyData *polyData = m_PolyDatas[t];
+    if (polyData == nullptr)
+      continue;
+
+    if (!SharesCells(topology, polyData))
+    {
+      if (!EqualCells(topology, polyData))
+        continue;
+
+      m_PolyDatas[t] = ShareCells(topology, polyData->GetPoints(), polyData->GetPointData());
+      modified = true;
+    }
+
+    ++numberOfSharingTimeSteps;
+  }
+
+  if (modified)
+    this->Modified();
+
+  return numberOfSharingTimeSteps;
+}
+
+bool mitk::Surface::HasSharedTopology() const
+{
+  if (m_PolyDatas.size() < 2)
+    return false;
+
+  for (unsigned int t = 1; t < m_PolyDatas.size(); ++t)
+  {
+    if (!this->IsTopologyShared(t))
+      return false;
+  }
+
+  return true;
+}
+
+bool mitk::Surface::IsTopologyShared(unsigned int t) const
+{
+  if (t >= m_PolyDatas.size() || m_PolyDatas[t] == nullptr || m_PolyDatas[0] == nullptr)
+    return false;
+
+  return t == 0 || SharesCells(m_PolyDatas[0], m_PolyDatas[t]);
+}
+
 bool mitk::Surface::IsEmptyTimeStep(unsigned int t) const
 {
   if (!IsInitialized())
@@ -337,6 +502,7 @@ void mitk::Surface::Graft(const DataObject *data)
     m_PolyDatas.push_back(vtkSmartPointer<vtkPolyData>::New());
     m_PolyDatas.back()->DeepCopy(surface->GetVtkPolyData(i));
   }
+  this->RestoreSharedTopology(*surface);
 }
 
 void mitk::Surface::PrintSelf(std::ostream &os, itk::Indent indent) const
@@ -344,6 +510,7 @@ void mitk::Surface::PrintSelf(std::ostream &os, itk::Indent indent) const
   Superclass::PrintSelf(os, indent);
 
   os << indent << "\nNumber PolyDatas: " << m_PolyDatas.size() << "\n";
+  os << indent << "Shared topology: " << (this->HasSharedTopology() ? "yes" : "no") << "\n";
 
   unsigned int count = 0;
 
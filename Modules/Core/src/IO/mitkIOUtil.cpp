@@ -24,6 +24,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkIMimeTypeProvider.h>
 #include <mitkProgressBar.h>
 #include <mitkStandaloneDataStorage.h>
+#include <mitkTracer.h>
 #include <usGetModuleContext.h>
 #include <usLDAPProp.h>
 #include <usModuleContext.h>
@@ -39,8 +40,15 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkSmartPointer.h>
 #include <vtkTriangleFilter.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <condition_variable>
 #include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 static std::string GetLastErrorStr()
 {
@@ -318,8 +326,229 @@ namespace mitk
     static BaseData::Pointer LoadBaseDataFromFile(const std::string &path, const ReaderOptionsFunctorBase* optionsCallback = nullptr);
 
     static void SetDefaultDataNodeProperties(mitk::DataNode *node, const std::string &filePath = std::string());
+
+    enum SelectionResult
+    {
+      SelectionSelected,
+      SelectionSkipped,
+      SelectionAborted
+    };
+
+    /** Selects the reader of \c loadInfo, re-using the choices recorded in \c usedReaderItems */
+    static SelectionResult SelectReader(LoadInfo &loadInfo,
+                                        std::map<std::string, FileReaderSelector::Item> &usedReaderItems,
+                                        const ReaderOptionsFunctorBase *optionsCallback,
+                                        std::string &errMsg);
+
+    /** Reads with \c reader and wraps every data object into a new node */
+    static DataStorage::SetOfObjects::Pointer ReadNodes(IFileReader *reader);
+
+    /** Sets the path property of the read data and appends it to the outputs of \c loadInfo */
+    static void CollectNodes(LoadInfo &loadInfo,
+                             const DataStorage::SetOfObjects *nodes,
+                             DataStorage::SetOfObjects *nodeResult,
+                             std::string &errMsg);
+
+    /** Calls \c task for all indices below \c count on up to \c numberOfThreads worker threads
+     *  and \c done on the calling thread in ascending index order once the task finished. */
+    static void ParallelFor(std::size_t count,
+                            unsigned int numberOfThreads,
+                            const std::function<void(std::size_t)> &task,
+                            const std::function<void(std::size_t)> &done);
   };
 
+  IOUtil::Impl::SelectionResult IOUtil::Impl::SelectReader(
+    LoadInfo &loadInfo,
+    std::map<std::string, FileReaderSelector::Item> &usedReaderItems,
+    const ReaderOptionsFunctorBase *optionsCallback,
+    std::string &errMsg)
+  {
+    std::vector<FileReaderSelector::Item> readers = loadInfo.m_ReaderSelector.Get();
+
+    if (readers.empty())
+    {
+      if (!itksys::SystemTools::FileExists(loadInfo.m_Path.c_str()))
+      {
+        errMsg += "File '" + loadInfo.m_Path + "' does not exist\n";
+      }
+      else
+      {
+        errMsg += "No reader available for '" + loadInfo.m_Path + "'\n";
+      }
+      return SelectionSkipped;
+    }
+
+    bool callOptionsCallback = readers.size() > 1 || !readers.front().GetReader()->GetOptions().empty();
+
+    // check if we already used a reader which should be re-used
+    std::vector<MimeType> currMimeTypes = loadInfo.m_ReaderSelector.GetMimeTypes();
+    std::string selectedMimeType;
+    for (std::vector<MimeType>::const_iterator mimeTypeIter = currMimeTypes.begin(),
+                                               mimeTypeIterEnd = currMimeTypes.end();
+         mimeTypeIter != mimeTypeIterEnd;
+         ++mimeTypeIter)
+    {
+      std::map<std::string, FileReaderSelector::Item>::const_iterator oldSelectedItemIter =
+        usedReaderItems.find(mimeTypeIter->GetName());
+      if (oldSelectedItemIter != usedReaderItems.end())
+      {
+        // we found an already used item for a mime-type which is contained
+        // in the current reader set, check all current readers if there service
+        // id equals the old reader
+        for (std::vector<FileReaderSelector::Item>::const_iterator currReaderItem = readers.begin(),
+                                                                   currReaderItemEnd = readers.end();
+             currReaderItem != currReaderItemEnd;
+             ++currReaderItem)
+        {
+          if (currReaderItem->GetMimeType().GetName() == mimeTypeIter->GetName() &&
+              currReaderItem->GetServiceId() == oldSelectedItemIter->second.GetServiceId() &&
+              currReaderItem->GetConfidenceLevel() >= oldSelectedItemIter->second.GetConfidenceLevel())
+          {
+            // okay, we used the same reader already, re-use its options
+            selectedMimeType = mimeTypeIter->GetName();
+            callOptionsCallback = false;
+            loadInfo.m_ReaderSelector.Select(oldSelectedItemIter->second.GetServiceId());
+            loadInfo.m_ReaderSelector.GetSelected().GetReader()->SetOptions(
+              oldSelectedItemIter->second.GetReader()->GetOptions());
+            break;
+          }
+        }
+        if (!selectedMimeType.empty())
+          break;
+      }
+    }
+
+    if (callOptionsCallback && optionsCallback)
+    {
+      callOptionsCallback = (*optionsCallback)(loadInfo);
+      if (!callOptionsCallback && !loadInfo.m_Cancel)
+      {
+        usedReaderItems.erase(selectedMimeType);
+        FileReaderSelector::Item selectedItem = loadInfo.m_ReaderSelector.GetSelected();
+        usedReaderItems.insert(std::make_pair(selectedItem.GetMimeType().GetName(), selectedItem));
+      }
+    }
+
+    if (loadInfo.m_Cancel)
+    {
+      errMsg += "Reading operation(s) cancelled.";
+      return SelectionAborted;
+    }
+
+    if (loadInfo.m_ReaderSelector.GetSelected().GetReader() == nullptr)
+    {
+      errMsg += "Unexpected nullptr reader.";
+      return SelectionAborted;
+    }
+
+    return SelectionSelected;
+  }
+
+  DataStorage::SetOfObjects::Pointer IOUtil::Impl::ReadNodes(IFileReader *reader)
+  {
+    DataStorage::SetOfObjects::Pointer nodes = DataStorage::SetOfObjects::New();
+    std::vector<mitk::BaseData::Pointer> baseData = reader->Read();
+    for (auto iter = baseData.begin(); iter != baseData.end(); ++iter)
+    {
+      if (iter->IsNotNull())
+      {
+        mitk::DataNode::Pointer node = mitk::DataNode::New();
+        node->SetData(*iter);
+        nodes->InsertElement(nodes->Size(), node);
+      }
+    }
+    return nodes;
+  }
+
+  void IOUtil::Impl::CollectNodes(LoadInfo &loadInfo,
+                                  const DataStorage::SetOfObjects *nodes,
+                                  DataStorage::SetOfObjects *nodeResult,
+                                  std::string &errMsg)
+  {
+    for (DataStorage::SetOfObjects::ConstIterator nodeIter = nodes->Begin(), nodeIterEnd = nodes->End();
+         nodeIter != nodeIterEnd;
+         ++nodeIter)
+    {
+      const mitk::DataNode::Pointer &node = nodeIter->Value();
+      mitk::BaseData::Pointer data = node->GetData();
+      if (data.IsNull())
+      {
+        continue;
+      }
+
+      mitk::StringProperty::Pointer pathProp = mitk::StringProperty::New(loadInfo.m_Path);
+      data->SetProperty("path", pathProp);
+
+      loadInfo.m_Output.push_back(data);
+      if (nodeResult)
+      {
+        nodeResult->push_back(nodeIter->Value());
+      }
+    }
+
+    if (loadInfo.m_Output.empty() || (nodeResult && nodeResult->Size() == 0))
+    {
+      errMsg += "Unknown read error occurred reading " + loadInfo.m_Path;
+    }
+  }
+
+  void IOUtil::Impl::ParallelFor(std::size_t count,
+                                 unsigned int numberOfThreads,
+                                 const std::function<void(std::size_t)> &task,
+                                 const std::function<void(std::size_t)> &done)
+  {
+    if (numberOfThreads == 0)
+    {
+      numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    numberOfThreads = static_cast<unsigned int>(std::min<std::size_t>(numberOfThreads, count));
+
+    std::mutex mutex;
+    std::condition_variable finishedCondition;
+    std::vector<char> finished(count, 0);
+    std::atomic<std::size_t> next(0);
+
+    auto worker = [&]() {
+      for (std::size_t i = next++; i < count; i = next++)
+      {
+        try
+        {
+          task(i);
+        }
+        catch (...)
+        {
+          MITK_ERROR << "Unexpected exception in load task " << i;
+        }
+
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          finished[i] = 1;
+        }
+        finishedCondition.notify_all();
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < numberOfThreads; ++i)
+    {
+      threads.emplace_back(worker);
+    }
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        finishedCondition.wait(lock, [&]() { return finished[i] != 0; });
+      }
+      done(i);
+    }
+
+    for (auto &thread : threads)
+    {
+      thread.join();
+    }
+  }
+
   BaseData::Pointer IOUtil::Impl::LoadBaseDataFromFile(const std::string &path,
                                                        const ReaderOptionsFunctorBase *optionsCallback)
   {
@@ -571,6 +800,40 @@ namespace mitk
     return result;
   }
 
+  DataStorage::SetOfObjects::Pointer IOUtil::LoadConcurrently(const std::vector<std::string> &paths,
+                                                              DataStorage &storage,
+                                                              const ReaderOptionsFunctorBase *optionsCallback,
+                                                              unsigned int numberOfThreads)
+  {
+    DataStorage::SetOfObjects::Pointer nodeResult = DataStorage::SetOfObjects::New();
+    std::vector<LoadInfo> loadInfos;
+    std::string errMsg = LoadConcurrently(paths, loadInfos, nodeResult, &storage, optionsCallback, numberOfThreads);
+    if (!errMsg.empty())
+    {
+      mitkThrow() << errMsg;
+    }
+    return nodeResult;
+  }
+
+  std::vector<BaseData::Pointer> IOUtil::LoadConcurrently(const std::vector<std::string> &paths,
+                                                          const ReaderOptionsFunctorBase *optionsCallback,
+                                                          unsigned int numberOfThreads)
+  {
+    std::vector<BaseData::Pointer> result;
+    std::vector<LoadInfo> loadInfos;
+    std::string errMsg = LoadConcurrently(paths, loadInfos, nullptr, nullptr, optionsCallback, numberOfThreads);
+    if (!errMsg.empty())
+    {
+      mitkThrow() << errMsg;
+    }
+
+    for (const auto &loadInfo : loadInfos)
+    {
+      result.insert(result.end(), loadInfo.m_Output.begin(), loadInfo.m_Output.end());
+    }
+    return result;
+  }
+
   std::string IOUtil::Load(std::vector<LoadInfo> &loadInfos,
                            DataStorage::SetOfObjects *nodeResult,
                            DataStorage *ds,
@@ -594,154 +857,190 @@ namespace mitk
       if(std::find(read_files.begin(), read_files.end(), loadInfo.m_Path) != read_files.end())
         continue;
 
-      std::vector<FileReaderSelector::Item> readers = loadInfo.m_ReaderSelector.Get();
+      Impl::SelectionResult selection = Impl::SelectReader(loadInfo, usedReaderItems, optionsCallback, errMsg);
+      if (selection == Impl::SelectionAborted)
+        break;
+      if (selection == Impl::SelectionSkipped)
+        continue;
 
-      if (readers.empty())
+      IFileReader *reader = loadInfo.m_ReaderSelector.GetSelected().GetReader();
+
+      // Do the actual reading
+      try
       {
-        if (!itksys::SystemTools::FileExists(loadInfo.m_Path.c_str()))
+        MITK_TRACE_NAMED_SCOPE(traceScope, "Read", loadInfo.m_ReaderSelector.GetSelected().GetDescription().c_str());
+        MITK_TRACE_SET_NODE_NAME(traceScope, loadInfo.m_Path);
+
+        DataStorage::SetOfObjects::Pointer nodes;
+        if (ds != nullptr)
         {
-          errMsg += "File '" + loadInfo.m_Path + "' does not exist\n";
+          nodes = reader->Read(*ds);
         }
         else
         {
-          errMsg += "No reader available for '" + loadInfo.m_Path + "'\n";
+          nodes = Impl::ReadNodes(reader);
         }
-        continue;
-      }
 
-      bool callOptionsCallback = readers.size() > 1 || !readers.front().GetReader()->GetOptions().empty();
+        std::vector< std::string > new_files =  reader->GetReadFiles();
+        read_files.insert( read_files.end(), new_files.begin(), new_files.end() );
 
-      // check if we already used a reader which should be re-used
-      std::vector<MimeType> currMimeTypes = loadInfo.m_ReaderSelector.GetMimeTypes();
-      std::string selectedMimeType;
-      for (std::vector<MimeType>::const_iterator mimeTypeIter = currMimeTypes.begin(),
-                                                 mimeTypeIterEnd = currMimeTypes.end();
-           mimeTypeIter != mimeTypeIterEnd;
-           ++mimeTypeIter)
+        Impl::CollectNodes(loadInfo, nodes, nodeResult, errMsg);
+      }
+      catch (const std::exception &e)
       {
-        std::map<std::string, FileReaderSelector::Item>::const_iterator oldSelectedItemIter =
-          usedReaderItems.find(mimeTypeIter->GetName());
-        if (oldSelectedItemIter != usedReaderItems.end())
-        {
-          // we found an already used item for a mime-type which is contained
-          // in the current reader set, check all current readers if there service
-          // id equals the old reader
-          for (std::vector<FileReaderSelector::Item>::const_iterator currReaderItem = readers.begin(),
-                                                                     currReaderItemEnd = readers.end();
-               currReaderItem != currReaderItemEnd;
-               ++currReaderItem)
-          {
-            if (currReaderItem->GetMimeType().GetName() == mimeTypeIter->GetName() &&
-                currReaderItem->GetServiceId() == oldSelectedItemIter->second.GetServiceId() &&
-                currReaderItem->GetConfidenceLevel() >= oldSelectedItemIter->second.GetConfidenceLevel())
-            {
-              // okay, we used the same reader already, re-use its options
-              selectedMimeType = mimeTypeIter->GetName();
-              callOptionsCallback = false;
-              loadInfo.m_ReaderSelector.Select(oldSelectedItemIter->second.GetServiceId());
-              loadInfo.m_ReaderSelector.GetSelected().GetReader()->SetOptions(
-                oldSelectedItemIter->second.GetReader()->GetOptions());
-              break;
-            }
-          }
-          if (!selectedMimeType.empty())
-            break;
-        }
+        errMsg += "Exception occured when reading file " + loadInfo.m_Path + ":\n" + e.what() + "\n\n";
       }
+      mitk::ProgressBar::GetInstance()->Progress(2);
+      --filesToRead;
+    }
 
-      if (callOptionsCallback && optionsCallback)
+    if (!errMsg.empty())
+    {
+      MITK_ERROR << errMsg;
+    }
+
+    mitk::ProgressBar::GetInstance()->Progress(2 * filesToRead);
+
+    return errMsg;
+  }
+
+  std::string IOUtil::LoadConcurrently(const std::vector<std::string> &paths,
+                                       std::vector<LoadInfo> &loadInfos,
+                                       DataStorage::SetOfObjects *nodeResult,
+                                       DataStorage *ds,
+                                       const ReaderOptionsFunctorBase *optionsCallback,
+                                       unsigned int numberOfThreads)
+  {
+    if (paths.empty())
+    {
+      return "No input files given";
+    }
+
+    const std::size_t numberOfFiles = paths.size();
+    int stepsToDo = 2 * numberOfFiles;
+    mitk::ProgressBar::GetInstance()->AddStepsToDo(stepsToDo);
+
+    std::string errMsg;
+
+    // Mime-type detection, which may already touch the files, runs on the workers
+    std::vector<std::unique_ptr<LoadInfo>> detected(numberOfFiles);
+    Impl::ParallelFor(numberOfFiles,
+                      numberOfThreads,
+                      [&](std::size_t i) { detected[i].reset(new LoadInfo(paths[i])); },
+                      [&](std::size_t) {
+                        mitk::ProgressBar::GetInstance()->Progress();
+                        --stepsToDo;
+                      });
+
+    loadInfos.clear();
+    for (std::size_t i = 0; i < numberOfFiles; ++i)
+    {
+      if (detected[i])
       {
-        callOptionsCallback = (*optionsCallback)(loadInfo);
-        if (!callOptionsCallback && !loadInfo.m_Cancel)
-        {
-          usedReaderItems.erase(selectedMimeType);
-          FileReaderSelector::Item selectedItem = loadInfo.m_ReaderSelector.GetSelected();
-          usedReaderItems.insert(std::make_pair(selectedItem.GetMimeType().GetName(), selectedItem));
-        }
+        loadInfos.push_back(*detected[i]);
       }
-
-      if (loadInfo.m_Cancel)
+      else
       {
-        errMsg += "Reading operation(s) cancelled.";
-        break;
+        errMsg += "Detecting the file type of '" + paths[i] + "' failed\n";
       }
+    }
+    detected.clear();
 
-      IFileReader *reader = loadInfo.m_ReaderSelector.GetSelected().GetReader();
-      if (reader == nullptr)
-      {
-        errMsg += "Unexpected nullptr reader.";
+    // The options callback may show a dialog, so readers are selected on the calling thread
+    std::map<std::string, FileReaderSelector::Item> usedReaderItems;
+    std::vector<std::size_t> selected;
+    for (std::size_t i = 0; i < loadInfos.size(); ++i)
+    {
+      Impl::SelectionResult selection = Impl::SelectReader(loadInfos[i], usedReaderItems, optionsCallback, errMsg);
+      if (selection == Impl::SelectionAborted)
         break;
-      }
+      if (selection == Impl::SelectionSelected)
+        selected.push_back(i);
+    }
 
-      // Do the actual reading
-      try
-      {
-        DataStorage::SetOfObjects::Pointer nodes;
-        if (ds != nullptr)
-        {
-          nodes = reader->Read(*ds);
+    struct ReadResult
+    {
+      DataStorage::SetOfObjects::Pointer nodes;
+      StandaloneDataStorage::Pointer storage;
+      std::vector<std::string> readFiles;
+      std::string errMsg;
+    };
+    std::vector<ReadResult> results(selected.size());
+    std::vector<std::string> read_files;
 
-          std::vector< std::string > new_files =  reader->GetReadFiles();
-          read_files.insert( read_files.end(), new_files.begin(), new_files.end() );
-        }
-        else
+    // listeners of ds are notified once about all loaded nodes
+    DataStorage::BatchUpdate batch(ds);
+
+    Impl::ParallelFor(
+      selected.size(),
+      numberOfThreads,
+      [&](std::size_t i) {
+        LoadInfo &loadInfo = loadInfos[selected[i]];
+        IFileReader *reader = loadInfo.m_ReaderSelector.GetSelected().GetReader();
+        try
         {
-          nodes = DataStorage::SetOfObjects::New();
-          std::vector<mitk::BaseData::Pointer> baseData = reader->Read();
-          for (auto iter = baseData.begin(); iter != baseData.end(); ++iter)
+          MITK_TRACE_NAMED_SCOPE(traceScope, "Read", loadInfo.m_ReaderSelector.GetSelected().GetDescription().c_str());
+          MITK_TRACE_SET_NODE_NAME(traceScope, loadInfo.m_Path);
+
+          if (ds != nullptr)
           {
-            if (iter->IsNotNull())
-            {
-              mitk::DataNode::Pointer node = mitk::DataNode::New();
-              node->SetData(*iter);
-              nodes->InsertElement(nodes->Size(), node);
-            }
+            // Readers may add nodes with parents, so they read into a private
+            // storage and the nodes are moved to ds on the calling thread
+            results[i].storage = StandaloneDataStorage::New();
+            results[i].nodes = reader->Read(*results[i].storage);
           }
-
-          std::vector< std::string > new_files =  reader->GetReadFiles();
-          read_files.insert( read_files.end(), new_files.begin(), new_files.end() );
-        }
-
-        for (DataStorage::SetOfObjects::ConstIterator nodeIter = nodes->Begin(), nodeIterEnd = nodes->End();
-             nodeIter != nodeIterEnd;
-             ++nodeIter)
-        {
-          const mitk::DataNode::Pointer &node = nodeIter->Value();
-          mitk::BaseData::Pointer data = node->GetData();
-          if (data.IsNull())
+          else
           {
-            continue;
+            results[i].nodes = Impl::ReadNodes(reader);
           }
+          results[i].readFiles = reader->GetReadFiles();
+        }
+        catch (const std::exception &e)
+        {
+          results[i].errMsg = "Exception occured when reading file " + loadInfo.m_Path + ":\n" + e.what() + "\n\n";
+        }
+      },
+      [&](std::size_t i) {
+        LoadInfo &loadInfo = loadInfos[selected[i]];
+        ReadResult &result = results[i];
 
-          mitk::StringProperty::Pointer pathProp = mitk::StringProperty::New(loadInfo.m_Path);
-          data->SetProperty("path", pathProp);
+        // Skip files which were already read as part of a previous entry, e.g. a series
+        if (std::find(read_files.begin(), read_files.end(), loadInfo.m_Path) == read_files.end())
+        {
+          errMsg += result.errMsg;
+          read_files.insert(read_files.end(), result.readFiles.begin(), result.readFiles.end());
 
-          loadInfo.m_Output.push_back(data);
-          if (nodeResult)
+          if (result.nodes.IsNotNull())
           {
-            nodeResult->push_back(nodeIter->Value());
+            try
+            {
+              if (ds != nullptr)
+              {
+                for (const auto &node : *result.nodes)
+                {
+                  ds->Add(node, result.storage->GetSources(node, nullptr, true));
+                }
+              }
+              Impl::CollectNodes(loadInfo, result.nodes, nodeResult, errMsg);
+            }
+            catch (const std::exception &e)
+            {
+              errMsg += "Exception occured when adding the data of " + loadInfo.m_Path + ":\n" + e.what() + "\n\n";
+            }
           }
         }
 
-        if (loadInfo.m_Output.empty() || (nodeResult && nodeResult->Size() == 0))
-        {
-          errMsg += "Unknown read error occurred reading " + loadInfo.m_Path;
-        }
-      }
-      catch (const std::exception &e)
-      {
-        errMsg += "Exception occured when reading file " + loadInfo.m_Path + ":\n" + e.what() + "\n\n";
-      }
-      mitk::ProgressBar::GetInstance()->Progress(2);
-      --filesToRead;
-    }
+        result = ReadResult();
+        mitk::ProgressBar::GetInstance()->Progress();
+        --stepsToDo;
+      });
 
     if (!errMsg.empty())
     {
       MITK_ERROR << errMsg;
     }
 
-    mitk::ProgressBar::GetInstance()->Progress(2 * filesToRead);
+    mitk::ProgressBar::GetInstance()->Progress(stepsToDo);
 
     return errMsg;
   }
@@ -822,6 +1121,50 @@ namespace mitk
     }
   }
 
+  std::future<void> IOUtil::SaveAsync(const BaseData *data,
+                                      const std::string &path,
+                                      const IFileWriter::Options &options)
+  {
+    if ((data == nullptr) || (data->IsEmpty()))
+      mitkThrow() << "BaseData cannot be null or empty for SaveAsync.";
+
+    if (path.empty())
+      mitkThrow() << "No output filename given";
+
+    BaseData::ConstPointer snapshot = dynamic_cast<const BaseData *>(data->Clone().GetPointer());
+    if (snapshot.IsNull())
+      mitkThrow() << "Cannot create a snapshot of the " << data->GetNameOfClass() << " data for saving.";
+
+    mitk::CoreServicePointer<mitk::IMimeTypeProvider> mimeTypeProvider(mitk::CoreServices::GetMimeTypeProvider());
+    auto saveInfo = std::make_shared<SaveInfo>(snapshot, mimeTypeProvider->GetMimeTypeForName(std::string()), path);
+
+    IFileWriter *writer =
+      saveInfo->m_WriterSelector.IsEmpty() ? nullptr : saveInfo->m_WriterSelector.GetSelected().GetWriter();
+    if (writer == nullptr)
+    {
+      const std::string ext = itksys::SystemTools::GetFilenameExtension(path);
+      mitkThrow() << "No suitable writer found for the current data of type " << data->GetNameOfClass()
+                  << (ext.empty() ? std::string() : (std::string(" with extension ") + ext));
+    }
+
+    if (!options.empty())
+      writer->SetOptions(options);
+
+    // The SaveInfo owns the writer instance and keeps it alive together with the snapshot
+    return std::async(std::launch::async, [saveInfo, snapshot]() {
+      IFileWriter *writer = saveInfo->m_WriterSelector.GetSelected().GetWriter();
+      try
+      {
+        writer->SetOutputLocation(saveInfo->m_Path);
+        writer->Write();
+      }
+      catch (const std::exception &e)
+      {
+        mitkThrow() << "Exception occurred when writing to " << saveInfo->m_Path << ":\n" << e.what();
+      }
+    });
+  }
+
   std::string IOUtil::Save(const BaseData *data,
                            const std::string &mimeTypeName,
                            const std::string &path,
@@ -0,0 +1,193 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkImageFileRegionProvider.h"
+
+#include <mitkExceptionMacro.h>
+#include <mitkLocaleSwitch.h>
+#include <mitkProportionalTimeGeometry.h>
+
+#include <itkImageIOFactory.h>
+#include <itkImageIORegion.h>
+#include <itkMutexLockHolder.h>
+
+#include <cstring>
+#include <vector>
+
+mitk::ImageFileRegionProvider::ImageFileRegionProvider()
+{
+}
+
+mitk::ImageFileRegionProvider::~ImageFileRegionProvider()
+{
+}
+
+void mitk::ImageFileRegionProvider::SetFileName(const std::string &fileName)
+{
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_ImageIOMutex);
+  LocaleSwitch localeSwitch("C");
+
+  itk::ImageIOBase::Pointer imageIO =
+    itk::ImageIOFactory::CreateImageIO(fileName.c_str(), itk::ImageIOFactory::ReadMode);
+  if (imageIO.IsNull())
+  {
+    mitkThrow() << "No ITK image IO available for " << fileName;
+  }
+
+  imageIO->SetFileName(fileName);
+  imageIO->ReadImageInformation();
+
+  const unsigned int ndim = imageIO->GetNumberOfDimensions();
+  if (ndim < 2 || ndim > 4)
+  {
+    mitkThrow() << "Only images with 2 to 4 dimensions can be provided by region, " << fileName << " has " << ndim;
+  }
+
+  m_FileName = fileName;
+  m_ImageIO = imageIO;
+  this->Modified();
+}
+
+bool mitk::ImageFileRegionProvider::CanStreamRead() const
+{
+  return m_ImageIO.IsNotNull() && m_ImageIO->CanStreamRead();
+}
+
+mitk::Image::Pointer mitk::ImageFileRegionProvider::CreateImage()
+{
+  if (m_ImageIO.IsNull())
+  {
+    mitkThrow() << "No file set at ImageFileRegionProvider";
+  }
+
+  const unsigned int ndim = m_ImageIO->GetNumberOfDimensions();
+
+  unsigned int dimensions[4] = {1, 1, 1, 1};
+  ScalarType spacing[3] = {1.0, 1.0, 1.0};
+  Point3D origin;
+  origin.Fill(0);
+  Matrix3D matrix;
+  matrix.SetIdentity();
+
+  for (unsigned int i = 0; i < ndim; ++i)
+  {
+    dimensions[i] = m_ImageIO->GetDimensions(i);
+    if (i < 3)
+    {
+      spacing[i] = m_ImageIO->GetSpacing(i) > 0 ? m_ImageIO->GetSpacing(i) : 1.0;
+      origin[i] = m_ImageIO->GetOrigin(i);
+    }
+  }
+
+  const unsigned int dimMax3 = ndim >= 3 ? 3 : ndim;
+  for (unsigned int i = 0; i < dimMax3; ++i)
+    for (unsigned int j = 0; j < dimMax3; ++j)
+      matrix[i][j] = m_ImageIO->GetDirection(j)[i];
+
+  Image::Pointer image = Image::New();
+  image->Initialize(MakePixelType(m_ImageIO), ndim, dimensions);
+
+  PlaneGeometry *planeGeometry = image->GetSlicedGeometry(0)->GetPlaneGeometry(0);
+  planeGeometry->SetOrigin(origin);
+  planeGeometry->GetIndexToWorldTransform()->SetMatrix(matrix);
+
+  SlicedGeometry3D *slicedGeometry = image->GetSlicedGeometry(0);
+  slicedGeometry->InitializeEvenlySpaced(planeGeometry, image->GetDimension(2));
+  slicedGeometry->SetSpacing(spacing);
+
+  ProportionalTimeGeometry::Pointer timeGeometry = ProportionalTimeGeometry::New();
+  timeGeometry->Initialize(slicedGeometry, image->GetDimension(3));
+  image->SetTimeGeometry(timeGeometry);
+
+  image->SetRegionProvider(this);
+  return image;
+}
+
+void mitk::ImageFileRegionProvider::ReadRegion(const RegionType &region, unsigned int t, void *buffer) const
+{
+  if (m_ImageIO.IsNull())
+  {
+    mitkThrow() << "No file set at ImageFileRegionProvider";
+  }
+
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_ImageIOMutex);
+  LocaleSwitch localeSwitch("C");
+
+  const unsigned int ndim = m_ImageIO->GetNumberOfDimensions();
+  const size_t pixelSize = m_ImageIO->GetPixelSize();
+
+  unsigned int dimensions[4] = {1, 1, 1, 1};
+  for (unsigned int i = 0; i < ndim; ++i)
+    dimensions[i] = m_ImageIO->GetDimensions(i);
+
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    if (region.GetIndex(i) < 0 || region.GetIndex(i) + region.GetSize(i) > dimensions[i])
+    {
+      mitkThrow() << "Requested region exceeds the image: " << region;
+    }
+  }
+  if (t >= dimensions[3])
+  {
+    mitkThrow() << "Requested time step " << t << " does not exist in " << m_FileName;
+  }
+
+  itk::ImageIORegion ioRegion(ndim);
+  for (unsigned int i = 0; i < ndim; ++i)
+  {
+    if (i < 3)
+    {
+      ioRegion.SetIndex(i, region.GetIndex(i));
+      ioRegion.SetSize(i, region.GetSize(i));
+    }
+    else
+    {
+      ioRegion.SetIndex(i, t);
+      ioRegion.SetSize(i, 1);
+    }
+  }
+
+  if (m_ImageIO->CanStreamRead())
+  {
+    m_ImageIO->SetIORegion(ioRegion);
+    m_ImageIO->Read(buffer);
+    return;
+  }
+
+  // The IO decodes the whole file at once, extract the requested region afterwards
+  itk::ImageIORegion largestRegion(ndim);
+  for (unsigned int i = 0; i < ndim; ++i)
+    largestRegion.SetSize(i, dimensions[i]);
+
+  std::vector<char> completeImage(m_ImageIO->GetImageSizeInBytes());
+  m_ImageIO->SetIORegion(largestRegion);
+  m_ImageIO->Read(completeImage.data());
+
+  const size_t rowSize = region.GetSize(0) * pixelSize;
+  const size_t volumeOffset = static_cast<size_t>(t) * dimensions[0] * dimensions[1] * dimensions[2];
+  char *target = static_cast<char *>(buffer);
+
+  for (size_t z = 0; z < region.GetSize(2); ++z)
+  {
+    for (size_t y = 0; y < region.GetSize(1); ++y)
+    {
+      const size_t sourceIndex = volumeOffset + ((region.GetIndex(2) + z) * dimensions[1] + region.GetIndex(1) + y) *
+                                                  dimensions[0] + region.GetIndex(0);
+      std::memcpy(target, completeImage.data() + sourceIndex * pixelSize, rowSize);
+      target += rowSize;
+    }
+  }
+}
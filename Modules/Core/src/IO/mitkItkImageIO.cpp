@@ -24,14 +24,24 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkImage.h>
 #include <mitkImageReadAccessor.h>
 #include <mitkLocaleSwitch.h>
+#include <mitkMemoryMappedFile.h>
 
+#include "mitkParallelGzipWriter.h"
+
+#include <itkByteSwapper.h>
 #include <itkImage.h>
 #include <itkImageFileReader.h>
 #include <itkImageIOFactory.h>
 #include <itkImageIORegion.h>
 #include <itkMetaDataObject.h>
 
+#include <itksys/SystemTools.hxx>
+
 #include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <thread>
 
 namespace mitk
 {
@@ -40,6 +50,20 @@ namespace mitk
   const char *const PROPERTY_KEY_TIMEGEOMETRY_TYPE = "org_mitk_timegeometry_type";
   const char *const PROPERTY_KEY_TIMEGEOMETRY_TIMEPOINTS = "org_mitk_timegeometry_timepoints";
 
+  std::string ItkImageIO::OPTION_MEMORY_MAPPED()
+  {
+    static std::string s = "Memory mapped (lazy) loading";
+    return s;
+  }
+
+  /** Helper that sets the default reader options shared by all ItkImageIO instances.*/
+  static IFileReader::Options CreateDefaultReaderOptions()
+  {
+    IFileReader::Options defaultOptions;
+    defaultOptions[ItkImageIO::OPTION_MEMORY_MAPPED()] = us::Any(false);
+    return defaultOptions;
+  }
+
   ItkImageIO::ItkImageIO(const ItkImageIO &other)
     : AbstractFileIO(other), m_ImageIO(dynamic_cast<itk::ImageIOBase *>(other.m_ImageIO->Clone().GetPointer()))
   {
@@ -123,6 +147,7 @@ namespace mitk
     }
 
     this->AbstractFileReader::SetMimeTypePrefix(IOMimeTypes::DEFAULT_BASE_NAME() + ".image.");
+    this->SetDefaultReaderOptions(CreateDefaultReaderOptions());
     this->InitializeDefaultMetaDataKeys();
 
     std::vector<std::string> readExtensions = m_ImageIO->GetSupportedReadExtensions();
@@ -208,6 +233,7 @@ namespace mitk
     }
 
     this->AbstractFileReader::SetMimeTypePrefix(IOMimeTypes::DEFAULT_BASE_NAME() + ".image.");
+    this->SetDefaultReaderOptions(CreateDefaultReaderOptions());
     this->InitializeDefaultMetaDataKeys();
 
     if (rank)
@@ -316,11 +342,60 @@ namespace mitk
 
     MITK_INFO << "ioRegion: " << ioRegion << std::endl;
     m_ImageIO->SetIORegion(ioRegion);
-    void *buffer = new unsigned char[m_ImageIO->GetImageSizeInBytes()];
-    m_ImageIO->Read(buffer);
+
+    bool memoryMapped = false;
+    try
+    {
+      memoryMapped = us::any_cast<bool>(this->GetReaderOption(OPTION_MEMORY_MAPPED()));
+    }
+    catch (const us::BadAnyCastException &e)
+    {
+      MITK_WARN << "Unexpected error: " << e.what();
+    }
+
+    // Lazy loading: reference the voxels of an uncompressed file directly. The OS pages them
+    // in on first access and the mapping is released together with the channel data item.
+    MemoryMappedFile::Pointer mappedFile;
+    void *buffer = nullptr;
+    if (memoryMapped && m_ImageIO->GetNumberOfDimensions() == ndim)
+    {
+      try
+      {
+        mappedFile = MemoryMappedFile::New();
+        mappedFile->Open(path);
+
+        size_t offset = 0;
+        if (this->GetUncompressedDataOffset(mappedFile->GetSize(), offset))
+        {
+          buffer = static_cast<unsigned char *>(mappedFile->GetData()) + offset;
+          MITK_INFO << "memory mapped image data at offset " << offset << std::endl;
+        }
+        else
+        {
+          MITK_INFO << "image data cannot be memory mapped, reading it instead" << std::endl;
+          mappedFile = nullptr;
+        }
+      }
+      catch (const mitk::Exception &e)
+      {
+        MITK_WARN << e.GetDescription() << ". Reading image data instead.";
+        mappedFile = nullptr;
+      }
+    }
 
     image->Initialize(MakePixelType(m_ImageIO), ndim, dimensions);
-    image->SetImportChannel(buffer, 0, Image::ManageMemory);
+
+    if (mappedFile.IsNotNull())
+    {
+      image->SetImportChannel(buffer, 0, Image::ReferenceMemory);
+      image->GetChannelData(0)->SetMemoryHolder(mappedFile);
+    }
+    else
+    {
+      buffer = new unsigned char[m_ImageIO->GetImageSizeInBytes()];
+      m_ImageIO->Read(buffer);
+      image->SetImportChannel(buffer, 0, Image::ManageMemory);
+    }
 
     const itk::MetaDataDictionary &dictionary = m_ImageIO->GetMetaDataDictionary();
 
@@ -492,11 +567,200 @@ namespace mitk
     return result;
   }
 
+  /** Helper that reads the first maxLength bytes of a file as text.*/
+  static std::string ReadFileHeader(const std::string &path, size_t maxLength)
+  {
+    std::ifstream stream(path.c_str(), std::ios::in | std::ios::binary);
+    std::string header(maxLength, '\0');
+    stream.read(&header[0], maxLength);
+    header.resize(static_cast<size_t>(stream.gcount()));
+    return header;
+  }
+
+  /** Helper that checks if text ends with an empty line, i.e. with "\n\n" or "\r\n\r\n".*/
+  static bool EndsWithEmptyLine(const std::string &text)
+  {
+    const size_t length = text.length();
+    return (length >= 2 && text.compare(length - 2, 2, "\n\n") == 0) ||
+           (length >= 4 && text.compare(length - 4, 4, "\r\n\r\n") == 0);
+  }
+
+  bool ItkImageIO::GetUncompressedDataOffset(size_t fileSize, size_t &offset) const
+  {
+    const std::string path = m_ImageIO->GetFileName();
+    const size_t imageSize = static_cast<size_t>(m_ImageIO->GetImageSizeInBytes());
+    const size_t componentSize = m_ImageIO->GetComponentSize();
+
+    // Vector images may be stored in a different component order than mitk::Image uses
+    if (m_ImageIO->GetNumberOfComponents() != 1 || imageSize == 0 || imageSize > fileSize)
+      return false;
+
+    if (componentSize > 1)
+    {
+      const bool fileIsBigEndian = m_ImageIO->GetByteOrder() == itk::ImageIOBase::BigEndian;
+      const bool fileIsLittleEndian = m_ImageIO->GetByteOrder() == itk::ImageIOBase::LittleEndian;
+      if ((fileIsBigEndian || fileIsLittleEndian) &&
+          fileIsBigEndian != itk::ByteSwapper<unsigned short>::SystemIsBigEndian())
+        return false;
+    }
+
+    // All supported formats store the voxels as one block at the end of the file
+    const size_t candidate = fileSize - imageSize;
+    if (componentSize > 0 && candidate % componentSize != 0)
+      return false;
+
+    const std::string imageIOName = m_ImageIO->GetNameOfClass();
+    if (imageIOName == "NrrdImageIO")
+    {
+      // attached header, raw encoding, data directly after the empty line closing the header
+      const std::string header = ReadFileHeader(path, candidate);
+      if (header.compare(0, 4, "NRRD") != 0 || !EndsWithEmptyLine(header))
+        return false;
+      if (header.find("\nencoding: raw") == std::string::npos || header.find("\ndata file:") != std::string::npos ||
+          header.find("\ndatafile:") != std::string::npos)
+        return false;
+    }
+    else if (imageIOName == "MetaImageIO")
+    {
+      // ElementDataFile = LOCAL has to be the last header line
+      const std::string header = ReadFileHeader(path, candidate);
+      if (header.empty() || header[header.length() - 1] != '\n')
+        return false;
+      const size_t lastLine = header.rfind("ElementDataFile");
+      if (lastLine == std::string::npos || header.find("LOCAL", lastLine) == std::string::npos ||
+          header.find('\n', lastLine) != header.length() - 1)
+        return false;
+      if (header.find("CompressedData = True") != std::string::npos)
+        return false;
+    }
+    else if (imageIOName == "NiftiImageIO")
+    {
+      // NIfTI-1 single file in native byte order without intensity scaling
+      const size_t niftiHeaderSize = 348;
+      const std::string header = ReadFileHeader(path, niftiHeaderSize);
+      if (header.length() != niftiHeaderSize || candidate < niftiHeaderSize)
+        return false;
+
+      int sizeOfHeader = 0;
+      float voxOffset = 0, slope = 0, intercept = 0;
+      std::memcpy(&sizeOfHeader, header.data(), sizeof(int));
+      std::memcpy(&voxOffset, header.data() + 108, sizeof(float));
+      std::memcpy(&slope, header.data() + 112, sizeof(float));
+      std::memcpy(&intercept, header.data() + 116, sizeof(float));
+
+      if (sizeOfHeader != static_cast<int>(niftiHeaderSize) || header.compare(344, 3, "n+1") != 0)
+        return false;
+      if (static_cast<size_t>(voxOffset) != candidate)
+        return false;
+      if ((slope != 0.0f && slope != 1.0f) || intercept != 0.0f)
+        return false;
+    }
+    else
+    {
+      return false;
+    }
+
+    offset = candidate;
+    return true;
+  }
+
   AbstractFileIO::ConfidenceLevel ItkImageIO::GetReaderConfidenceLevel() const
   {
     return m_ImageIO->CanReadFile(GetLocalFileName().c_str()) ? IFileReader::Supported : IFileReader::Unsupported;
   }
 
+  /** Images below this size are compressed by the ImageIO itself, splitting them up does not pay off.*/
+  static const size_t MinimumParallelCompressionSize = 16 * 1024 * 1024;
+
+  /** Helper that gzip compresses the part of a file starting at offset and appends it to stream.*/
+  static void GzipFileSection(const std::string &path, size_t offset, std::ostream &stream)
+  {
+    std::ifstream input(path.c_str(), std::ios::in | std::ios::binary);
+    input.seekg(static_cast<std::streamoff>(offset));
+
+    ParallelGzipWriter gzip(stream);
+    std::vector<char> buffer(64 * 1024 * 1024);
+    while (input)
+    {
+      input.read(buffer.data(), buffer.size());
+      gzip.Write(buffer.data(), static_cast<size_t>(input.gcount()));
+    }
+    if (!input.eof())
+      mitkThrow() << "Reading " << path << " failed.";
+    gzip.Close();
+  }
+
+  /**
+   * Helper that writes the image with multi-threaded compression for the formats that store
+   * standard gzip streams: NRRD with attached header (gzip encoded voxels after the text header)
+   * and .nii.gz (the whole file is gzip compressed). The ImageIO writes the uncompressed file
+   * next to path, which is then compressed into path by ParallelGzipWriter. Returns false if
+   * the image has to be written by the ImageIO as usual.
+   */
+  static bool WriteWithParallelCompression(itk::ImageIOBase *imageIO, const std::string &path, const void *buffer)
+  {
+    const std::string imageIOName = imageIO->GetNameOfClass();
+    const std::string lowerPath = itksys::SystemTools::LowerCase(path);
+    const bool isNrrd = imageIOName == "NrrdImageIO" && itksys::SystemTools::StringEndsWith(lowerPath, ".nrrd");
+    const bool isNifti = imageIOName == "NiftiImageIO" && itksys::SystemTools::StringEndsWith(lowerPath, ".nii.gz");
+    const size_t imageSize = static_cast<size_t>(imageIO->GetImageSizeInBytes());
+
+    if ((!isNrrd && !isNifti) || imageSize < MinimumParallelCompressionSize || std::thread::hardware_concurrency() < 2)
+      return false;
+
+    const std::string rawPath = path + (isNrrd ? ".raw.nrrd" : ".raw.nii");
+    bool written = false;
+    try
+    {
+      imageIO->SetFileName(rawPath);
+      imageIO->UseCompressionOff();
+      imageIO->Write(buffer);
+
+      size_t dataOffset = 0;
+      std::string header;
+      if (isNrrd)
+      {
+        // exchange the encoding in the header, everything else stays as written by the ImageIO
+        const size_t fileSize = static_cast<size_t>(itksys::SystemTools::FileLength(rawPath));
+        dataOffset = fileSize >= imageSize ? fileSize - imageSize : 0;
+        header = ReadFileHeader(rawPath, dataOffset);
+        const std::string rawEncoding = "\nencoding: raw\n";
+        const size_t position = header.find(rawEncoding);
+        if (fileSize >= imageSize && header.compare(0, 4, "NRRD") == 0 && EndsWithEmptyLine(header) &&
+            position != std::string::npos)
+        {
+          header.replace(position, rawEncoding.length(), "\nencoding: gzip\n");
+          written = true;
+        }
+      }
+      else
+      {
+        written = true;
+      }
+
+      if (written)
+      {
+        std::ofstream stream(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        stream.write(header.data(), header.size());
+        GzipFileSection(rawPath, dataOffset, stream);
+        if (!stream)
+          mitkThrow() << "Writing " << path << " failed.";
+      }
+    }
+    catch (...)
+    {
+      std::remove(rawPath.c_str());
+      imageIO->SetFileName(path);
+      imageIO->UseCompressionOn();
+      throw;
+    }
+
+    std::remove(rawPath.c_str());
+    imageIO->SetFileName(path);
+    imageIO->UseCompressionOn();
+    return written;
+  }
+
   void ItkImageIO::Write()
   {
     const auto *image = dynamic_cast<const mitk::Image *>(this->GetInput());
@@ -655,7 +919,8 @@ namespace mitk
       }
       ImageReadAccessor imageAccess(image);
       LocaleSwitch localeSwitch2("C");
-      m_ImageIO->Write(imageAccess.GetData());
+      if (!WriteWithParallelCompression(m_ImageIO, path, imageAccess.GetData()))
+        m_ImageIO->Write(imageAccess.GetData());
     }
     catch (const std::exception &e)
     {
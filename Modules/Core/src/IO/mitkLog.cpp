@@ -21,9 +21,17 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkOutputWindow.h>
 #include <itkSimpleFastMutexLock.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
+#include <cstdlib>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
 
 static itk::SimpleFastMutexLock logMutex;
 static mitk::LoggingBackend *mitkLogBackend = nullptr;
@@ -32,6 +40,159 @@ static std::string logFileName = "";
 static std::stringstream *outputWindow = nullptr;
 static bool logOutputWindow = false;
 
+namespace
+{
+  /** Node of the intrusive multi-producer/single-consumer queue of the asynchronous mode */
+  struct QueuedMessage
+  {
+    QueuedMessage(const mbilog::LogMessage &l, int id) : message(l), threadID(id), next(nullptr) {}
+    const mbilog::LogMessage message;
+    const int threadID;
+    QueuedMessage *next;
+  };
+
+  /** Per site budget of the rate limit. Sites are hashed into a fixed table, so
+   *  colliding sites simply share their budget. */
+  struct RateLimitSlot
+  {
+    std::atomic<long long> second;
+    std::atomic<unsigned int> count;
+    std::atomic<unsigned int> suppressed;
+  };
+}
+
+// producers push onto this stack, the consumer takes the whole stack at once and reverses it
+static std::atomic<QueuedMessage *> queueHead(nullptr);
+static std::atomic<int> queueSize(0);
+// beyond this size producers write synchronously instead of growing the queue further
+static const int maximumQueueSize = 100000;
+static std::atomic<bool> asynchronous(false);
+
+static std::mutex writerMutex;
+static std::condition_variable writerCondition;
+static std::thread *writerThread = nullptr;
+static bool stopWriter = false;
+
+static const std::size_t numberOfRateLimitSlots = 1024;
+static RateLimitSlot rateLimitSlots[numberOfRateLimitSlots];
+static std::atomic<unsigned int> messageRateLimit(0);
+static std::atomic<unsigned long long> suppressedMessages(0);
+
+static QueuedMessage *TakeQueuedMessages()
+{
+  QueuedMessage *stack = queueHead.exchange(nullptr, std::memory_order_acquire);
+  QueuedMessage *fifo = nullptr;
+  while (stack != nullptr)
+  {
+    QueuedMessage *next = stack->next;
+    stack->next = fifo;
+    fifo = stack;
+    stack = next;
+  }
+  return fifo;
+}
+
+static void EnqueueMessage(const mbilog::LogMessage &l, int threadID)
+{
+  auto *node = new QueuedMessage(l, threadID);
+  node->next = queueHead.load(std::memory_order_relaxed);
+  while (!queueHead.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+  {
+  }
+
+  // only wake the writer for the first message of a batch, it drains everything else in one go
+  if (queueSize.fetch_add(1, std::memory_order_relaxed) == 0)
+    writerCondition.notify_one();
+}
+
+static void RunWriterThread()
+{
+  std::unique_lock<std::mutex> lock(writerMutex);
+  while (!stopWriter)
+  {
+    // the timeout catches notifications that were sent while the writer was busy
+    writerCondition.wait_for(lock, std::chrono::milliseconds(50));
+    lock.unlock();
+    if (queueHead.load(std::memory_order_relaxed) != nullptr)
+      mitk::LoggingBackend::Flush();
+    lock.lock();
+  }
+}
+
+static void StopWriterThread()
+{
+  std::thread *thread = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    thread = writerThread;
+    writerThread = nullptr;
+    stopWriter = true;
+  }
+
+  if (thread != nullptr)
+  {
+    writerCondition.notify_all();
+    thread->join();
+    delete thread;
+  }
+}
+
+static void ShutdownAsynchronousLogging()
+{
+  asynchronous = false;
+  StopWriterThread();
+  mitk::LoggingBackend::Flush();
+}
+
+static void StartWriterThread()
+{
+  static bool atExitRegistered = false;
+
+  std::lock_guard<std::mutex> lock(writerMutex);
+  if (writerThread != nullptr)
+    return;
+
+  if (!atExitRegistered)
+  {
+    atExitRegistered = true;
+    std::atexit(&ShutdownAsynchronousLogging);
+  }
+
+  stopWriter = false;
+  writerThread = new std::thread(&RunWriterThread);
+}
+
+/** Returns false if the message exceeds the budget of its site. Otherwise suppressedBefore
+ *  is set to the number of messages of the site that were dropped since the last one passed. */
+static bool PassesMessageRateLimit(const mbilog::LogMessage &l, unsigned int &suppressedBefore)
+{
+  suppressedBefore = 0;
+
+  const unsigned int limit = messageRateLimit.load(std::memory_order_relaxed);
+  if (limit == 0 || l.level == mbilog::Error || l.level == mbilog::Fatal)
+    return true;
+
+  const std::size_t hash =
+    std::hash<const void *>()(l.filePath) ^ (static_cast<std::size_t>(l.lineNumber) * 0x9E3779B9u);
+  RateLimitSlot &slot = rateLimitSlots[hash % numberOfRateLimitSlots];
+
+  const long long now =
+    std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  long long second = slot.second.load(std::memory_order_relaxed);
+  if (second != now && slot.second.compare_exchange_strong(second, now, std::memory_order_relaxed))
+    slot.count.store(0, std::memory_order_relaxed);
+
+  if (slot.count.fetch_add(1, std::memory_order_relaxed) < limit)
+  {
+    suppressedBefore = slot.suppressed.exchange(0, std::memory_order_relaxed);
+    return true;
+  }
+
+  slot.suppressed.fetch_add(1, std::memory_order_relaxed);
+  suppressedMessages.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
 void mitk::LoggingBackend::EnableAdditionalConsoleWindow(bool enable)
 {
   logOutputWindow = enable;
@@ -39,20 +200,54 @@ void mitk::LoggingBackend::EnableAdditionalConsoleWindow(bool enable)
 
 void mitk::LoggingBackend::ProcessMessage(const mbilog::LogMessage &l)
 {
-  logMutex.Lock();
 #ifdef _WIN32
-  FormatSmart(l, (int)GetCurrentThreadId());
+  const int threadID = (int)GetCurrentThreadId();
 #else
-  FormatSmart(l);
+  const int threadID = 0;
 #endif
 
+  unsigned int suppressedBefore = 0;
+  if (!PassesMessageRateLimit(l, suppressedBefore))
+    return;
+
+  auto dispatch = [this, threadID](const mbilog::LogMessage &message) {
+    if (asynchronous.load(std::memory_order_relaxed) && message.level != mbilog::Fatal &&
+        queueSize.load(std::memory_order_relaxed) < maximumQueueSize)
+    {
+      EnqueueMessage(message, threadID);
+      return;
+    }
+
+    logMutex.Lock();
+    // keep the order of whatever is still queued
+    this->WriteQueuedMessages();
+    this->WriteMessage(message, threadID, true);
+    logMutex.Unlock();
+  };
+
+  if (suppressedBefore > 0)
+  {
+    mbilog::LogMessage summary(mbilog::Warn, l.filePath, l.lineNumber, l.functionName);
+    summary.moduleName = l.moduleName;
+    summary.category = l.category;
+    summary.message = std::to_string(suppressedBefore) + " messages from " + l.filePath + ":" +
+                      std::to_string(l.lineNumber) + " were suppressed by the message rate limit";
+    dispatch(summary);
+  }
+
+  dispatch(l);
+}
+
+void mitk::LoggingBackend::WriteMessage(const mbilog::LogMessage &l, int threadID, bool colouredConsole)
+{
+  if (colouredConsole)
+    FormatSmart(l, threadID);
+  else
+    FormatSmart(std::cout, l, threadID);
+
   if (logFile)
   {
-#ifdef _WIN32
-    FormatFull(*logFile, l, (int)GetCurrentThreadId());
-#else
-    FormatFull(*logFile, l);
-#endif
+    FormatFull(*logFile, l, threadID);
   }
   if (logOutputWindow)
   {
@@ -62,21 +257,98 @@ void mitk::LoggingBackend::ProcessMessage(const mbilog::LogMessage &l)
     }
     outputWindow->str("");
     outputWindow->clear();
-#ifdef _WIN32
-    FormatFull(*outputWindow, l, (int)GetCurrentThreadId());
-#else
-    FormatFull(*outputWindow, l);
-#endif
+    FormatFull(*outputWindow, l, threadID);
     itk::OutputWindow::GetInstance()->DisplayText(outputWindow->str().c_str());
   }
+}
+
+void mitk::LoggingBackend::WriteQueuedMessages()
+{
+  QueuedMessage *message = TakeQueuedMessages();
+  if (message == nullptr)
+    return;
+
+  while (message != nullptr)
+  {
+    QueuedMessage *next = message->next;
+    this->WriteMessage(message->message, message->threadID, false);
+    delete message;
+    queueSize.fetch_sub(1, std::memory_order_relaxed);
+    message = next;
+  }
+
+  std::cout.flush();
+  if (logFile)
+    logFile->flush();
+}
+
+void mitk::LoggingBackend::SetAsynchronous(bool async)
+{
+  if (async)
+  {
+    asynchronous = true;
+    StartWriterThread();
+  }
+  else
+  {
+    asynchronous = false;
+    StopWriterThread();
+    Flush();
+  }
+}
+
+bool mitk::LoggingBackend::IsAsynchronous()
+{
+  return asynchronous;
+}
+
+void mitk::LoggingBackend::Flush()
+{
+  logMutex.Lock();
+  if (mitkLogBackend)
+  {
+    mitkLogBackend->WriteQueuedMessages();
+  }
+  else
+  {
+    // nobody to write to anymore
+    QueuedMessage *message = TakeQueuedMessages();
+    while (message != nullptr)
+    {
+      QueuedMessage *next = message->next;
+      delete message;
+      queueSize.fetch_sub(1, std::memory_order_relaxed);
+      message = next;
+    }
+  }
+  std::cout.flush();
+  if (logFile)
+    logFile->flush();
   logMutex.Unlock();
 }
 
+void mitk::LoggingBackend::SetMessageRateLimit(unsigned int messagesPerSecond)
+{
+  messageRateLimit = messagesPerSecond;
+}
+
+unsigned int mitk::LoggingBackend::GetMessageRateLimit()
+{
+  return messageRateLimit;
+}
+
+unsigned long long mitk::LoggingBackend::GetNumberOfSuppressedMessages()
+{
+  return suppressedMessages;
+}
+
 void mitk::LoggingBackend::Register()
 {
   if (mitkLogBackend)
     return;
+  logMutex.Lock();
   mitkLogBackend = new mitk::LoggingBackend();
+  logMutex.Unlock();
   mbilog::RegisterBackend(mitkLogBackend);
 }
 
@@ -86,8 +358,14 @@ void mitk::LoggingBackend::Unregister()
   {
     SetLogFile(nullptr);
     mbilog::UnregisterBackend(mitkLogBackend);
-    delete mitkLogBackend;
+
+    logMutex.Lock();
+    mitk::LoggingBackend *backend = mitkLogBackend;
+    backend->WriteQueuedMessages();
     mitkLogBackend = nullptr;
+    logMutex.Unlock();
+
+    delete backend;
   }
 }
 
@@ -99,6 +377,11 @@ void mitk::LoggingBackend::SetLogFile(const char *file)
     std::string closedFileName;
 
     logMutex.Lock();
+    if (mitkLogBackend)
+    {
+      // pending messages still belong into the old file
+      mitkLogBackend->WriteQueuedMessages();
+    }
     if (logFile)
     {
       closed = true;
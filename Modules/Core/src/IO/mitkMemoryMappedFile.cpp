@@ -0,0 +1,125 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkMemoryMappedFile.h"
+
+#include <mitkExceptionMacro.h>
+
+#include <cstdio>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+mitk::MemoryMappedFile::MemoryMappedFile() : m_Data(nullptr), m_Size(0), m_RemoveFileOnClose(false)
+{
+}
+
+mitk::MemoryMappedFile::~MemoryMappedFile()
+{
+  this->Close();
+}
+
+void mitk::MemoryMappedFile::Open(const std::string &path)
+{
+  this->Close();
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA(
+    path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    mitkThrow() << "Cannot open file for memory mapping: " << path;
+  }
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+  {
+    CloseHandle(file);
+    mitkThrow() << "Cannot memory map empty file: " << path;
+  }
+
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (mapping == nullptr)
+  {
+    mitkThrow() << "Cannot create file mapping for " << path;
+  }
+
+  // the view keeps the mapping object alive
+  void *data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+  CloseHandle(mapping);
+  if (data == nullptr)
+  {
+    mitkThrow() << "Cannot map view of file " << path;
+  }
+
+  m_Size = static_cast<size_t>(fileSize.QuadPart);
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    mitkThrow() << "Cannot open file for memory mapping: " << path;
+  }
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+  {
+    close(fd);
+    mitkThrow() << "Cannot memory map empty file: " << path;
+  }
+
+  // private mapping: writes through image accessors never modify the file
+  void *data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+  {
+    mitkThrow() << "Cannot memory map file " << path;
+  }
+
+  m_Size = static_cast<size_t>(fileStat.st_size);
+#endif
+
+  m_Data = data;
+  m_FileName = path;
+}
+
+void mitk::MemoryMappedFile::Close()
+{
+  if (m_Data == nullptr)
+    return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(m_Data);
+#else
+  munmap(m_Data, m_Size);
+#endif
+
+  if (m_RemoveFileOnClose)
+    std::remove(m_FileName.c_str());
+
+  m_Data = nullptr;
+  m_Size = 0;
+  m_FileName.clear();
+}
@@ -23,6 +23,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <itksys/SystemTools.hxx>
 
+#include <algorithm>
+#include <typeinfo>
+
 #ifdef _MSC_VER
 #pragma warning(disable : 4503) // decorated name length exceeded, name was truncated
 #pragma warning(disable : 4355)
@@ -30,7 +33,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 namespace mitk
 {
-  MimeTypeProvider::MimeTypeProvider() : m_Tracker(nullptr) {}
+  MimeTypeProvider::MimeTypeProvider() : m_Tracker(nullptr), m_MaxExtensionLength(0) {}
   MimeTypeProvider::~MimeTypeProvider() { delete m_Tracker; }
   void MimeTypeProvider::Start()
   {
@@ -44,6 +47,7 @@ namespace mitk
   void MimeTypeProvider::Stop() { m_Tracker->Close(); }
   std::vector<MimeType> MimeTypeProvider::GetMimeTypes() const
   {
+    std::lock_guard<std::mutex> lock(m_Mutex);
     std::vector<MimeType> result;
     for (const auto &elem : m_NameToMimeType)
     {
@@ -54,12 +58,20 @@ namespace mitk
 
   std::vector<MimeType> MimeTypeProvider::GetMimeTypesForFile(const std::string &filePath) const
   {
+    std::vector<MimeType> contentCandidates;
     std::vector<MimeType> result;
-    for (const auto &elem : m_NameToMimeType)
     {
-      if (elem.second.AppliesTo(filePath))
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      result = this->GetMatchingPathMimeTypes_unlocked(filePath);
+      contentCandidates = m_ContentCandidates;
+    }
+
+    // These may open the file, so they are not called with the mutex locked
+    for (const auto &mimeType : contentCandidates)
+    {
+      if (mimeType.AppliesTo(filePath))
       {
-        result.push_back(elem.second);
+        result.push_back(mimeType);
       }
     }
     std::sort(result.begin(), result.end());
@@ -67,8 +79,55 @@ namespace mitk
     return result;
   }
 
+  std::vector<MimeType> MimeTypeProvider::GetMatchingPathMimeTypes_unlocked(const std::string &filePath) const
+  {
+    // Matching extensions is a case-insensitive comparison of the path ending, so
+    // the result only depends on the last m_MaxExtensionLength characters
+    std::string ending = filePath.substr(filePath.size() - std::min(filePath.size(), m_MaxExtensionLength));
+    ending = itksys::SystemTools::LowerCase(ending);
+
+    auto iter = m_PathEndingCache.find(ending);
+    if (iter == m_PathEndingCache.end())
+    {
+      std::vector<MimeType> matching;
+      for (const auto &mimeType : m_PathCandidates)
+      {
+        if (mimeType.MatchesExtension(ending))
+        {
+          matching.push_back(mimeType);
+        }
+      }
+      iter = m_PathEndingCache.insert(std::make_pair(ending, matching)).first;
+    }
+    return iter->second;
+  }
+
+  void MimeTypeProvider::UpdateCandidates_unlocked()
+  {
+    m_PathCandidates.clear();
+    m_ContentCandidates.clear();
+    m_PathEndingCache.clear();
+    m_MaxExtensionLength = 0;
+
+    for (const auto &elem : m_NameToMimeType)
+    {
+      if (m_ContentMimeTypes.count(elem.second) != 0)
+      {
+        m_ContentCandidates.push_back(elem.second);
+        continue;
+      }
+
+      m_PathCandidates.push_back(elem.second);
+      for (const auto &extension : elem.second.GetExtensions())
+      {
+        m_MaxExtensionLength = std::max(m_MaxExtensionLength, extension.size());
+      }
+    }
+  }
+
   std::vector<MimeType> MimeTypeProvider::GetMimeTypesForCategory(const std::string &category) const
   {
+    std::lock_guard<std::mutex> lock(m_Mutex);
     std::vector<MimeType> result;
     for (const auto &elem : m_NameToMimeType)
     {
@@ -82,6 +141,7 @@ namespace mitk
 
   MimeType MimeTypeProvider::GetMimeTypeForName(const std::string &name) const
   {
+    std::lock_guard<std::mutex> lock(m_Mutex);
     auto iter = m_NameToMimeType.find(name);
     if (iter != m_NameToMimeType.end())
       return iter->second;
@@ -90,6 +150,7 @@ namespace mitk
 
   std::vector<std::string> MimeTypeProvider::GetCategories() const
   {
+    std::lock_guard<std::mutex> lock(m_Mutex);
     std::vector<std::string> result;
     for (const auto &elem : m_NameToMimeType)
     {
@@ -106,14 +167,21 @@ namespace mitk
 
   MimeTypeProvider::TrackedType MimeTypeProvider::AddingService(const ServiceReferenceType &reference)
   {
-    MimeType result = this->GetMimeType(reference);
+    bool inspectsContent = false;
+    MimeType result = this->GetMimeType(reference, &inspectsContent);
     if (result.IsValid())
     {
+      std::lock_guard<std::mutex> lock(m_Mutex);
       std::string name = result.GetName();
       m_NameToMimeTypes[name].insert(result);
+      if (inspectsContent)
+      {
+        m_ContentMimeTypes.insert(result);
+      }
 
       // get the highest ranked mime-type
       m_NameToMimeType[name] = *(m_NameToMimeTypes[name].rbegin());
+      this->UpdateCandidates_unlocked();
     }
     return result;
   }
@@ -125,9 +193,11 @@ namespace mitk
 
   void MimeTypeProvider::RemovedService(const ServiceReferenceType & /*reference*/, TrackedType mimeType)
   {
+    std::lock_guard<std::mutex> lock(m_Mutex);
     std::string name = mimeType.GetName();
     std::set<MimeType> &mimeTypes = m_NameToMimeTypes[name];
     mimeTypes.erase(mimeType);
+    m_ContentMimeTypes.erase(mimeType);
     if (mimeTypes.empty())
     {
       m_NameToMimeTypes.erase(name);
@@ -138,9 +208,10 @@ namespace mitk
       // get the highest ranked mime-type
       m_NameToMimeType[name] = *(mimeTypes.rbegin());
     }
+    this->UpdateCandidates_unlocked();
   }
 
-  MimeType MimeTypeProvider::GetMimeType(const ServiceReferenceType &reference) const
+  MimeType MimeTypeProvider::GetMimeType(const ServiceReferenceType &reference, bool *inspectsContent) const
   {
     MimeType result;
     if (!reference)
@@ -159,6 +230,12 @@ namespace mitk
         }
         auto id = us::any_cast<long>(reference.GetProperty(us::ServiceConstants::SERVICE_ID()));
         result = MimeType(*mimeType, rank, id);
+
+        // Only the base class implementation of AppliesTo() is known to look at the path alone
+        if (inspectsContent != nullptr)
+        {
+          *inspectsContent = typeid(*mimeType) != typeid(CustomMimeType);
+        }
       }
       catch (const us::BadAnyCastException &e)
       {
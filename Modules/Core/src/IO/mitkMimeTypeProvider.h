@@ -23,6 +23,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "usServiceTracker.h"
 #include "usServiceTrackerCustomizer.h"
 
+#include <map>
+#include <mutex>
 #include <set>
 
 namespace mitk
@@ -57,7 +59,13 @@ namespace mitk
     void ModifiedService(const ServiceReferenceType &reference, TrackedType service) override;
     void RemovedService(const ServiceReferenceType &reference, TrackedType service) override;
 
-    MimeType GetMimeType(const ServiceReferenceType &reference) const;
+    MimeType GetMimeType(const ServiceReferenceType &reference, bool *inspectsContent = nullptr) const;
+
+    /** Must be called with m_Mutex locked whenever the registered mime-types change */
+    void UpdateCandidates_unlocked();
+
+    /** Returns the mime-types which only look at the path and match the ending of filePath */
+    std::vector<MimeType> GetMatchingPathMimeTypes_unlocked(const std::string &filePath) const;
 
     us::ServiceTracker<CustomMimeType, MimeTypeTrackerTypeTraits> *m_Tracker;
 
@@ -65,6 +73,19 @@ namespace mitk
     MapType m_NameToMimeTypes;
 
     std::map<std::string, MimeType> m_NameToMimeType;
+
+    /** Registered mime-types which override CustomMimeType::AppliesTo() and may peek into files */
+    std::set<MimeType> m_ContentMimeTypes;
+
+    /** The mime-types of m_NameToMimeType split by whether AppliesTo() depends on the path only */
+    std::vector<MimeType> m_PathCandidates;
+    std::vector<MimeType> m_ContentCandidates;
+    std::string::size_type m_MaxExtensionLength;
+
+    /** Maps the lower-case path endings to the matching entries of m_PathCandidates */
+    mutable std::map<std::string, std::vector<MimeType>> m_PathEndingCache;
+
+    mutable std::mutex m_Mutex;
   };
 }
 
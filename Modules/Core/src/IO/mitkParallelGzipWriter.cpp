@@ -0,0 +1,257 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkParallelGzipWriter.h"
+
+#include <mitkException.h>
+
+#include "itk_zlib.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace
+{
+  // deflate can refer back at most 32 KiB, more dictionary does not help
+  const std::size_t DictionarySize = 32 * 1024;
+
+  // blocks handed to each thread per round, keeps the threads busy while the results are written
+  const std::size_t BlocksPerThread = 4;
+
+  struct CompressedBlock
+  {
+    std::vector<unsigned char> Data;
+    unsigned long Crc = 0;
+    bool Failed = false;
+  };
+
+  void CompressBlock(const char *dictionary,
+                     std::size_t dictionarySize,
+                     const char *data,
+                     std::size_t size,
+                     bool last,
+                     int level,
+                     CompressedBlock &block)
+  {
+    block.Crc = crc32(0L, reinterpret_cast<const Bytef *>(data), static_cast<uInt>(size));
+
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+
+    // negative window bits: raw deflate without zlib header, the gzip framing is written by the caller
+    if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+      block.Failed = true;
+      return;
+    }
+
+    if (dictionarySize > 0 &&
+        deflateSetDictionary(&stream, reinterpret_cast<const Bytef *>(dictionary), static_cast<uInt>(dictionarySize)) !=
+          Z_OK)
+    {
+      deflateEnd(&stream);
+      block.Failed = true;
+      return;
+    }
+
+    // the sync flush marker needs a few bytes more than deflateBound accounts for
+    block.Data.resize(deflateBound(&stream, static_cast<uLong>(size)) + 16);
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    stream.avail_in = static_cast<uInt>(size);
+    stream.next_out = block.Data.data();
+    stream.avail_out = static_cast<uInt>(block.Data.size());
+
+    const int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+    for (;;)
+    {
+      if (stream.avail_out == 0)
+      {
+        const std::size_t used = block.Data.size();
+        block.Data.resize(2 * used);
+        stream.next_out = block.Data.data() + used;
+        stream.avail_out = static_cast<uInt>(block.Data.size() - used);
+      }
+
+      const int result = deflate(&stream, flush);
+      if (result == Z_STREAM_ERROR)
+      {
+        block.Failed = true;
+        break;
+      }
+
+      if (last ? result == Z_STREAM_END : (stream.avail_in == 0 && stream.avail_out != 0))
+        break;
+    }
+
+    block.Data.resize(block.Data.size() - stream.avail_out);
+    deflateEnd(&stream);
+  }
+
+  void WriteLittleEndian32(std::ostream &stream, unsigned long value)
+  {
+    char bytes[4];
+    for (int i = 0; i < 4; ++i)
+      bytes[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+    stream.write(bytes, 4);
+  }
+}
+
+const std::size_t mitk::ParallelGzipWriter::BlockSize;
+
+mitk::ParallelGzipWriter::ParallelGzipWriter(std::ostream &stream, unsigned int numberOfThreads, int level)
+  : m_Stream(stream),
+    m_NumberOfThreads(numberOfThreads),
+    m_Level(level),
+    m_Crc(crc32(0L, Z_NULL, 0)),
+    m_Size(0),
+    m_Closed(false)
+{
+  if (m_NumberOfThreads == 0)
+    m_NumberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  // magic, deflate, no flags, no modification time, no extra flags, unknown OS
+  const char header[10] = {'\x1f', '\x8b', '\x08', 0, 0, 0, 0, 0, 0, '\xff'};
+  m_Stream.write(header, sizeof(header));
+}
+
+std::size_t mitk::ParallelGzipWriter::GetRoundSize() const
+{
+  return m_NumberOfThreads * BlocksPerThread * BlockSize;
+}
+
+void mitk::ParallelGzipWriter::Write(const char *data, std::size_t size)
+{
+  if (m_Closed)
+    mitkThrow() << "Cannot write to a closed gzip stream.";
+
+  const std::size_t roundSize = this->GetRoundSize();
+
+  if (!m_Pending.empty())
+  {
+    const std::size_t count = std::min(size, roundSize - m_Pending.size());
+    m_Pending.insert(m_Pending.end(), data, data + count);
+    data += count;
+    size -= count;
+
+    if (m_Pending.size() < roundSize)
+      return;
+
+    this->CompressRound(m_Pending.data(), m_Pending.size(), false);
+    m_Pending.clear();
+  }
+
+  // full rounds are compressed directly from the caller's buffer without copying
+  while (size >= roundSize)
+  {
+    this->CompressRound(data, roundSize, false);
+    data += roundSize;
+    size -= roundSize;
+  }
+
+  m_Pending.assign(data, data + size);
+}
+
+void mitk::ParallelGzipWriter::Close()
+{
+  if (m_Closed)
+    return;
+
+  // the last round may be empty, it still has to emit the final deflate block
+  this->CompressRound(m_Pending.data(), m_Pending.size(), true);
+  m_Pending.clear();
+  m_Closed = true;
+
+  WriteLittleEndian32(m_Stream, m_Crc);
+  WriteLittleEndian32(m_Stream, static_cast<unsigned long>(m_Size & 0xffffffffu));
+  m_Stream.flush();
+
+  if (!m_Stream)
+    mitkThrow() << "Writing the gzip stream failed.";
+}
+
+void mitk::ParallelGzipWriter::CompressRound(const char *data, std::size_t size, bool last)
+{
+  const std::size_t numberOfBlocks = std::max<std::size_t>(1, (size + BlockSize - 1) / BlockSize);
+  std::vector<CompressedBlock> blocks(numberOfBlocks);
+
+  auto compress = [&](std::size_t i) {
+    const std::size_t begin = i * BlockSize;
+    const std::size_t blockSize = std::min(BlockSize, size - begin);
+
+    // the first block is primed with the tail of the previous round, all others with the preceding input
+    const char *dictionary = m_Dictionary.data();
+    std::size_t dictionarySize = m_Dictionary.size();
+    if (i > 0)
+    {
+      dictionary = data + begin - DictionarySize;
+      dictionarySize = DictionarySize;
+    }
+
+    const bool lastBlock = last && i + 1 == numberOfBlocks;
+    CompressBlock(dictionary, dictionarySize, data + begin, blockSize, lastBlock, m_Level, blocks[i]);
+  };
+
+  const unsigned int numberOfThreads =
+    static_cast<unsigned int>(std::min<std::size_t>(m_NumberOfThreads, numberOfBlocks));
+  if (numberOfThreads <= 1)
+  {
+    for (std::size_t i = 0; i < numberOfBlocks; ++i)
+      compress(i);
+  }
+  else
+  {
+    std::atomic<std::size_t> nextBlock(0);
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < numberOfThreads; ++t)
+    {
+      threads.emplace_back([&]() {
+        for (std::size_t i = nextBlock++; i < numberOfBlocks; i = nextBlock++)
+          compress(i);
+      });
+    }
+    for (auto &thread : threads)
+      thread.join();
+  }
+
+  for (std::size_t i = 0; i < numberOfBlocks; ++i)
+  {
+    const CompressedBlock &block = blocks[i];
+    if (block.Failed)
+      mitkThrow() << "Deflate compression failed.";
+
+    const std::size_t blockSize = std::min(BlockSize, size - std::min(size, i * BlockSize));
+    m_Stream.write(reinterpret_cast<const char *>(block.Data.data()), block.Data.size());
+    m_Crc = crc32_combine(m_Crc, block.Crc, static_cast<z_off_t>(blockSize));
+  }
+  m_Size += size;
+
+  if (!m_Stream)
+    mitkThrow() << "Writing the gzip stream failed.";
+
+  if (size >= DictionarySize)
+  {
+    m_Dictionary.assign(data + size - DictionarySize, data + size);
+  }
+  else
+  {
+    m_Dictionary.insert(m_Dictionary.end(), data, data + size);
+    if (m_Dictionary.size() > DictionarySize)
+      m_Dictionary.erase(m_Dictionary.begin(), m_Dictionary.end() - DictionarySize);
+  }
+}
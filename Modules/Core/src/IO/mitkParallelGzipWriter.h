@@ -0,0 +1,71 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKPARALLELGZIPWRITER_H
+#define MITKPARALLELGZIPWRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace mitk
+{
+  /**
+   * \brief Writes a gzip stream whose deflate data is compressed by several threads.
+   *
+   * The input is cut into blocks which are deflated independently, each one primed with the
+   * last 32 KiB of the preceding input as dictionary. All but the last block end on a byte
+   * boundary (Z_SYNC_FLUSH), so the concatenation of the blocks forms one ordinary deflate
+   * stream and the output is a standard single member gzip file that every gzip reader,
+   * including zlib, teem and the NIfTI library, can decompress (this is the scheme of pigz).
+   * Compared to single-threaded deflate the output is a few bytes per block larger.
+   *
+   * Only a bounded window of blocks is kept in memory, so arbitrarily large inputs can be
+   * streamed through Write(). Close() has to be called to finish the stream, errors are
+   * reported as mitk::Exception.
+   */
+  class ParallelGzipWriter
+  {
+  public:
+    /** numberOfThreads == 0 uses one thread per hardware core, level is a zlib compression level */
+    ParallelGzipWriter(std::ostream &stream, unsigned int numberOfThreads = 0, int level = -1);
+
+    void Write(const char *data, std::size_t size);
+    void Close();
+
+    /** Size of the blocks that are compressed independently */
+    static const std::size_t BlockSize = 1024 * 1024;
+
+  private:
+    ParallelGzipWriter(const ParallelGzipWriter &) = delete;
+    ParallelGzipWriter &operator=(const ParallelGzipWriter &) = delete;
+
+    std::size_t GetRoundSize() const;
+    void CompressRound(const char *data, std::size_t size, bool last);
+
+    std::ostream &m_Stream;
+    unsigned int m_NumberOfThreads;
+    int m_Level;
+    std::vector<char> m_Pending;
+    std::vector<char> m_Dictionary;
+    unsigned long m_Crc;
+    std::uint64_t m_Size;
+    bool m_Closed;
+  };
+}
+
+#endif // MITKPARALLELGZIPWRITER_H
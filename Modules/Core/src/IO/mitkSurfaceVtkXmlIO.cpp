@@ -19,11 +19,27 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkIOMimeTypes.h"
 #include "mitkSurface.h"
 
+#include <mitkArbitraryTimeGeometry.h>
+
+#include <vtkDoubleArray.h>
 #include <vtkErrorCode.h>
+#include <vtkFieldData.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
 #include <vtkSmartPointer.h>
 #include <vtkXMLPolyDataReader.h>
 #include <vtkXMLPolyDataWriter.h>
 
+namespace
+{
+  // Arrays of surfaces with shared topology, the time bounds mark such files
+  const char *const TIME_BOUNDS_ARRAY_NAME = "org.mitk.surface.timebounds";
+  const char *const POINTS_ARRAY_PREFIX = "org.mitk.surface.points.T";
+  const char *const SCALARS_ARRAY_PREFIX = "org.mitk.surface.scalars.T";
+
+  std::string GetArrayName(const char *prefix, unsigned int t) { return prefix + std::to_string(t); }
+}
+
 namespace mitk
 {
   class VtkXMLPolyDataReader : public ::vtkXMLPolyDataReader
@@ -73,13 +89,60 @@ namespace mitk
     }
     reader->Update();
 
-    if (reader->GetOutput() != nullptr)
+    vtkPolyData *polyData = reader->GetOutput();
+    if (polyData == nullptr)
+    {
+      mitkThrow() << "vtkXMLPolyDataReader error: " << vtkErrorCode::GetStringFromErrorCode(reader->GetErrorCode());
+    }
+
+    vtkSmartPointer<vtkDataArray> timeBounds;
+    if (polyData->GetFieldData() != nullptr)
     {
-      output->SetVtkPolyData(reader->GetOutput());
+      timeBounds = polyData->GetFieldData()->GetArray(TIME_BOUNDS_ARRAY_NAME);
+      polyData->GetFieldData()->RemoveArray(TIME_BOUNDS_ARRAY_NAME);
+    }
+
+    if (timeBounds == nullptr || timeBounds->GetNumberOfComponents() != 2 || timeBounds->GetNumberOfTuples() < 2)
+    {
+      output->SetVtkPolyData(polyData);
     }
     else
     {
-      mitkThrow() << "vtkXMLPolyDataReader error: " << vtkErrorCode::GetStringFromErrorCode(reader->GetErrorCode());
+      // time series with shared topology, the arrays of the other time steps are removed from time step 0
+      const auto timeSteps = static_cast<unsigned int>(timeBounds->GetNumberOfTuples());
+      vtkSmartPointer<vtkPointData> pointData = vtkSmartPointer<vtkPointData>::New();
+      pointData->ShallowCopy(polyData->GetPointData());
+
+      for (unsigned int t = 1; t < timeSteps; ++t)
+      {
+        polyData->GetPointData()->RemoveArray(GetArrayName(POINTS_ARRAY_PREFIX, t).c_str());
+        polyData->GetPointData()->RemoveArray(GetArrayName(SCALARS_ARRAY_PREFIX, t).c_str());
+      }
+      output->SetVtkPolyData(polyData);
+
+      for (unsigned int t = 1; t < timeSteps; ++t)
+      {
+        vtkDataArray *coordinates = pointData->GetArray(GetArrayName(POINTS_ARRAY_PREFIX, t).c_str());
+        if (coordinates == nullptr || coordinates->GetNumberOfComponents() != 3)
+          mitkThrow() << "Points of time step " << t << " are missing.";
+
+        vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+        points->SetData(coordinates);
+        coordinates->SetName(nullptr);
+
+        vtkDataArray *scalars = pointData->GetArray(GetArrayName(SCALARS_ARRAY_PREFIX, t).c_str());
+        output->SetVtkPolyDataWithSharedTopology(points, t, scalars);
+      }
+
+      ArbitraryTimeGeometry::Pointer timeGeometry = ArbitraryTimeGeometry::New();
+      timeGeometry->ClearAllGeometries();
+      timeGeometry->ReserveSpaceForGeometries(timeSteps);
+      for (unsigned int t = 0; t < timeSteps; ++t)
+      {
+        timeGeometry->AppendNewTimeStepClone(
+          output->GetGeometry(t), timeBounds->GetComponent(t, 0), timeBounds->GetComponent(t, 1));
+      }
+      output->SetTimeGeometry(timeGeometry);
     }
 
     std::vector<BaseData::Pointer> result;
@@ -112,6 +175,12 @@ namespace mitk
 
     const auto *input = dynamic_cast<const Surface *>(this->GetInput());
 
+    if (input->HasSharedTopology())
+    {
+      this->WriteSharedTopology();
+      return;
+    }
+
     const unsigned int timesteps = input->GetTimeGeometry()->CountTimeSteps();
     for (unsigned int t = 0; t < timesteps; ++t)
     {
@@ -152,5 +221,91 @@ namespace mitk
     }
   }
 
+  void SurfaceVtkXmlIO::WriteSharedTopology()
+  {
+    const auto *input = dynamic_cast<const Surface *>(this->GetInput());
+    const unsigned int timesteps = input->GetTimeGeometry()->CountTimeSteps();
+
+    std::string fileName;
+    vtkSmartPointer<vtkPolyData> firstTimeStep = this->GetPolyData(0, fileName);
+    if (firstTimeStep.Get() == nullptr)
+    {
+      mitkThrow() << "Cannot write empty surface";
+    }
+
+    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->ShallowCopy(firstTimeStep);
+
+    vtkSmartPointer<vtkDoubleArray> timeBounds = vtkSmartPointer<vtkDoubleArray>::New();
+    timeBounds->SetName(TIME_BOUNDS_ARRAY_NAME);
+    timeBounds->SetNumberOfComponents(2);
+    timeBounds->SetNumberOfTuples(timesteps);
+    for (unsigned int t = 0; t < timesteps; ++t)
+    {
+      const TimeBounds &bounds = input->GetTimeGeometry()->GetTimeBounds(t);
+      timeBounds->SetTuple2(t, bounds[0], bounds[1]);
+    }
+    if (polyData->GetFieldData() == nullptr)
+    {
+      polyData->SetFieldData(vtkSmartPointer<vtkFieldData>::New());
+    }
+    polyData->GetFieldData()->AddArray(timeBounds);
+
+    // the cells are written once, the other time steps only contribute their points and scalars
+    for (unsigned int t = 1; t < timesteps; ++t)
+    {
+      vtkSmartPointer<vtkPolyData> timeStep = this->GetPolyData(t, fileName);
+      if (timeStep.Get() == nullptr)
+      {
+        mitkThrow() << "Cannot write empty surface";
+      }
+
+      vtkSmartPointer<vtkDataArray> coordinates;
+      coordinates.TakeReference(timeStep->GetPoints()->GetData()->NewInstance());
+      coordinates->DeepCopy(timeStep->GetPoints()->GetData());
+      coordinates->SetName(GetArrayName(POINTS_ARRAY_PREFIX, t).c_str());
+      polyData->GetPointData()->AddArray(coordinates);
+
+      vtkDataArray *scalars = timeStep->GetPointData()->GetScalars();
+      if (scalars != nullptr && scalars != firstTimeStep->GetPointData()->GetScalars())
+      {
+        vtkSmartPointer<vtkDataArray> namedScalars;
+        namedScalars.TakeReference(scalars->NewInstance());
+        namedScalars->ShallowCopy(scalars);
+        namedScalars->SetName(GetArrayName(SCALARS_ARRAY_PREFIX, t).c_str());
+        polyData->GetPointData()->AddArray(namedScalars);
+      }
+    }
+
+    vtkSmartPointer<VtkXMLPolyDataWriter> writer = vtkSmartPointer<VtkXMLPolyDataWriter>::New();
+    writer->SetInputData(polyData);
+    if (this->GetOutputStream())
+    {
+      writer->SetStream(this->GetOutputStream());
+    }
+    else
+    {
+      writer->SetFileName(this->GetOutputLocation().c_str());
+    }
+
+    if (writer->Write() == 0 || writer->GetErrorCode() != 0)
+    {
+      mitkThrow() << "Error during surface writing"
+                  << (writer->GetErrorCode() ?
+                        std::string(": ") + vtkErrorCode::GetStringFromErrorCode(writer->GetErrorCode()) :
+                        std::string());
+    }
+  }
+
+  IFileIO::ConfidenceLevel SurfaceVtkXmlIO::GetWriterConfidenceLevel() const
+  {
+    // time series with shared topology are written completely into one file
+    const auto *input = dynamic_cast<const Surface *>(this->GetInput());
+    if (input != nullptr && input->HasSharedTopology() && AbstractFileIO::GetWriterConfidenceLevel() != Unsupported)
+      return Supported;
+
+    return SurfaceVtkIO::GetWriterConfidenceLevel();
+  }
+
   SurfaceVtkXmlIO *SurfaceVtkXmlIO::IOClone() const { return new SurfaceVtkXmlIO(*this); }
 }
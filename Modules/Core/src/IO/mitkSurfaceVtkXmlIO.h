@@ -23,6 +23,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 namespace mitk
 {
+  /**
+   * Reads and writes VTK XML PolyData (.vtp) files.
+   *
+   * 3D+t surfaces are written to one file per time step, except for surfaces whose time steps
+   * share one topology (see Surface::HasSharedTopology()). Those are written to a single file
+   * with the cells once, the points of time step 0 as points and the points (and point scalars)
+   * of the other time steps as additional point data arrays. Other VTK readers see time step 0.
+   */
   class SurfaceVtkXmlIO : public mitk::SurfaceVtkIO
   {
   public:
@@ -39,7 +47,11 @@ namespace mitk
 
     void Write() override;
 
+    ConfidenceLevel GetWriterConfidenceLevel() const override;
+
   private:
+    void WriteSharedTopology();
+
     SurfaceVtkXmlIO *IOClone() const override;
   };
 }
@@ -69,6 +69,11 @@ int mitk::DataInteractor::GetLayer() const
   return layer;
 }
 
+bool mitk::DataInteractor::GetMouseMoveBounds(const InteractionPositionEvent *, BoundingBox::BoundsArrayType &) const
+{
+  return false;
+}
+
 void mitk::DataInteractor::ConnectActionsAndFunctions()
 {
   MITK_WARN << "DataInteractor::ConnectActionsAndFunctions() is not implemented.";
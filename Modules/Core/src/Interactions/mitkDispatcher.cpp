@@ -18,20 +18,42 @@
 #include "mitkInteractionEvent.h"
 #include "mitkInteractionEventObserver.h"
 #include "mitkInternalEvent.h"
+#include "mitkMouseMoveEvent.h"
 #include "usGetModuleContext.h"
 
+#include <algorithm>
+
 namespace
 {
+  typedef std::pair<int, mitk::WeakPointer<mitk::DataInteractor>> LayeredInteractorType;
+
   struct cmp
   {
-    bool operator()(mitk::WeakPointer<mitk::DataInteractor> d1, mitk::WeakPointer<mitk::DataInteractor> d2)
+    bool operator()(const LayeredInteractorType &d1, const LayeredInteractorType &d2) const
     {
-      return (d1.Lock()->GetLayer() > d2.Lock()->GetLayer());
+      return (d1.first > d2.first);
     }
   };
+
+  bool IsInsideMouseMoveBounds(const mitk::DataInteractor *dataInteractor,
+                               const mitk::InteractionPositionEvent *positionEvent)
+  {
+    mitk::BoundingBox::BoundsArrayType bounds;
+    if (!dataInteractor->GetMouseMoveBounds(positionEvent, bounds))
+      return true;
+
+    const mitk::Point3D position = positionEvent->GetPositionInWorld();
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      if (position[i] < bounds[2 * i] || position[i] > bounds[2 * i + 1])
+        return false;
+    }
+    return true;
+  }
 }
 
-mitk::Dispatcher::Dispatcher(const std::string &rendererName) : m_ProcessingMode(REGULAR)
+mitk::Dispatcher::Dispatcher(const std::string &rendererName)
+  : m_ProcessingMode(REGULAR), m_EventObserverTrackingCount(-1)
 {
   // LDAP filter string to find all listeners specific for the renderer
   // corresponding to this dispatcher
@@ -163,7 +185,10 @@ bool mitk::Dispatcher::ProcessEvent(InteractionEvent *event)
   {
     if (std::strcmp(p->GetNameOfClass(), "MousePressEvent") == 0)
       event->GetSender()->GetRenderingManager()->SetRenderWindowFocus(event->GetSender()->GetRenderWindow());
-    m_Interactors.sort(cmp()); // sorts interactors by layer (descending);
+    this->SortInteractorsByLayer();
+
+    // mouse moves are only offered to interactors that can be affected at the cursor position
+    const auto *mouseMoveEvent = dynamic_cast<const MouseMoveEvent *>(event);
 
     // copy the list to prevent iterator invalidation as executing actions
     // in HandleEvent() can cause the m_Interactors list to be updated
@@ -171,6 +196,9 @@ bool mitk::Dispatcher::ProcessEvent(InteractionEvent *event)
     ListInteractorType::const_iterator it;
     for (it = tmpInteractorList.cbegin(); it != tmpInteractorList.cend(); ++it)
     {
+      if (mouseMoveEvent != nullptr && !(*it).IsExpired() && !IsInsideMouseMoveBounds((*it).Lock(), mouseMoveEvent))
+        continue;
+
       if (!(*it).IsExpired() && (*it).Lock()->HandleEvent(event, (*it).Lock()->GetDataNode()))
       {
         // Interactor can be deleted during HandleEvent(), so check it again
@@ -192,13 +220,18 @@ bool mitk::Dispatcher::ProcessEvent(InteractionEvent *event)
   }
 
   /* Notify InteractionEventObserver  */
-  const std::vector<us::ServiceReference<InteractionEventObserver>> listEventObserver =
-    m_EventObserverTracker->GetServiceReferences();
-  for (auto it = listEventObserver.cbegin();
-       it != listEventObserver.cend();
-       ++it)
+  this->UpdateEventObservers();
+
+  // copy the lists, observers may register or unregister services while being notified
+  const int trackingCount = m_EventObserverTrackingCount;
+  const std::vector<us::ServiceReference<InteractionEventObserver>> listEventObserver = m_EventObserverReferences;
+  const std::vector<InteractionEventObserver *> eventObservers = m_EventObservers;
+  for (std::size_t i = 0; i < listEventObserver.size(); ++i)
   {
-    InteractionEventObserver *interactionEventObserver = m_EventObserverTracker->GetService(*it);
+    // the cached pointers are only valid as long as the tracked services did not change
+    InteractionEventObserver *interactionEventObserver = m_EventObserverTracker->GetTrackingCount() == trackingCount
+      ? eventObservers[i]
+      : m_EventObserverTracker->GetService(listEventObserver[i]);
     if (interactionEventObserver != nullptr)
     {
       if (interactionEventObserver->IsEnabled())
@@ -255,6 +288,40 @@ void mitk::Dispatcher::RemoveOrphanedInteractors()
   }
 }
 
+void mitk::Dispatcher::SortInteractorsByLayer()
+{
+  std::vector<LayeredInteractorType> layeredInteractors;
+  layeredInteractors.reserve(m_Interactors.size());
+  for (auto it = m_Interactors.cbegin(); it != m_Interactors.cend(); ++it)
+  {
+    layeredInteractors.push_back(std::make_pair((*it).IsExpired() ? -1 : (*it).Lock()->GetLayer(), *it));
+  }
+
+  std::stable_sort(layeredInteractors.begin(), layeredInteractors.end(), cmp());
+
+  auto target = m_Interactors.begin();
+  for (auto it = layeredInteractors.cbegin(); it != layeredInteractors.cend(); ++it, ++target)
+  {
+    *target = it->second;
+  }
+}
+
+void mitk::Dispatcher::UpdateEventObservers()
+{
+  const int trackingCount = m_EventObserverTracker->GetTrackingCount();
+  if (trackingCount == m_EventObserverTrackingCount)
+    return;
+
+  m_EventObserverReferences = m_EventObserverTracker->GetServiceReferences();
+  m_EventObservers.clear();
+  m_EventObservers.reserve(m_EventObserverReferences.size());
+  for (auto it = m_EventObserverReferences.cbegin(); it != m_EventObserverReferences.cend(); ++it)
+  {
+    m_EventObservers.push_back(m_EventObserverTracker->GetService(*it));
+  }
+  m_EventObserverTrackingCount = trackingCount;
+}
+
 void mitk::Dispatcher::QueueEvent(InteractionEvent *event)
 {
   m_QueuedEvents.push_back(event);
@@ -142,33 +142,37 @@ bool mitk::Annotation::GetStringProperty(const std::string &propertyKey, std::st
   }
 }
 
+void mitk::Annotation::SetPropertyIfChanged(const std::string &propertyKey, BaseProperty *property)
+{
+  // the property list ignores equal values, only a real change marks the annotation as modified
+  const unsigned long propertyListTime = this->m_PropertyList->GetMTime();
+  this->m_PropertyList->SetProperty(propertyKey, property);
+  if (this->m_PropertyList->GetMTime() != propertyListTime)
+    Modified();
+}
+
 void mitk::Annotation::SetIntProperty(const std::string &propertyKey, int intValue)
 {
-  this->m_PropertyList->SetProperty(propertyKey, mitk::IntProperty::New(intValue));
-  Modified();
+  this->SetPropertyIfChanged(propertyKey, mitk::IntProperty::New(intValue));
 }
 void mitk::Annotation::SetBoolProperty(const std::string &propertyKey, bool boolValue)
 {
-  this->m_PropertyList->SetProperty(propertyKey, mitk::BoolProperty::New(boolValue));
-  Modified();
+  this->SetPropertyIfChanged(propertyKey, mitk::BoolProperty::New(boolValue));
 }
 
 void mitk::Annotation::SetFloatProperty(const std::string &propertyKey, float floatValue)
 {
-  this->m_PropertyList->SetProperty(propertyKey, mitk::FloatProperty::New(floatValue));
-  Modified();
+  this->SetPropertyIfChanged(propertyKey, mitk::FloatProperty::New(floatValue));
 }
 
 void mitk::Annotation::SetDoubleProperty(const std::string &propertyKey, double doubleValue)
 {
-  this->m_PropertyList->SetProperty(propertyKey, mitk::DoubleProperty::New(doubleValue));
-  Modified();
+  this->SetPropertyIfChanged(propertyKey, mitk::DoubleProperty::New(doubleValue));
 }
 
 void mitk::Annotation::SetStringProperty(const std::string &propertyKey, const std::string &stringValue)
 {
-  this->m_PropertyList->SetProperty(propertyKey, mitk::StringProperty::New(stringValue));
-  Modified();
+  this->SetPropertyIfChanged(propertyKey, mitk::StringProperty::New(stringValue));
 }
 
 std::string mitk::Annotation::GetName() const
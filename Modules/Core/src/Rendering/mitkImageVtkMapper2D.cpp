@@ -17,6 +17,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 // MITK
 #include <mitkAbstractTransformGeometry.h>
 #include <mitkDataNode.h>
+#include <mitkImageReadAccessor.h>
 #include <mitkImageSliceSelector.h>
 #include <mitkLevelWindowProperty.h>
 #include <mitkLookupTableProperty.h>
@@ -31,9 +32,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkImageStatisticsHolder.h"
 #include "mitkPlaneClipping.h"
 #include <mitkTransferFunctionProperty.h>
+#include <mitkTracer.h>
 
 // MITK Rendering
 #include "mitkImageVtkMapper2D.h"
+#include "vtkMitkGPUResliceMapper.h"
 #include "vtkMitkLevelWindowFilter.h"
 #include "vtkMitkThickSlicesFilter.h"
 #include "vtkNeverTranslucentTexture.h"
@@ -59,6 +62,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkRGBAPixel.h>
 #include <mitkRenderingModeProperty.h>
 
+#include <algorithm>
+#include <chrono>
+
 mitk::ImageVtkMapper2D::ImageVtkMapper2D()
 {
 }
@@ -145,6 +151,7 @@ void mitk::ImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rendere
     // see bug-13275
     localStorage->m_ReslicedImage = nullptr;
     localStorage->m_Mapper->SetInputData(localStorage->m_EmptyPolyData);
+    localStorage->m_Actor->SetMapper(localStorage->m_Mapper);
     return;
   }
 
@@ -164,12 +171,12 @@ void mitk::ImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rendere
 
   // Initialize the interpolation mode for resampling; switch to nearest
   // neighbor if the input image is too small.
+  int interpolationMode = VTK_RESLICE_NEAREST;
   if ((image->GetDimension() >= 3) && (image->GetDimension(2) > 1))
   {
     VtkResliceInterpolationProperty *resliceInterpolationProperty;
     datanode->GetProperty(resliceInterpolationProperty, "reslice interpolation", renderer);
 
-    int interpolationMode = VTK_RESLICE_NEAREST;
     if (resliceInterpolationProperty != nullptr)
     {
       interpolationMode = resliceInterpolationProperty->GetInterpolation();
@@ -193,6 +200,11 @@ void mitk::ImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rendere
     localStorage->m_Reslicer->SetInterpolationMode(ExtractSliceFilter::RESLICE_NEAREST);
   }
 
+  // sample the slice with the registered accelerator (e.g. OpenCL) if the user opted in
+  bool acceleratedReslicing = false;
+  datanode->GetBoolProperty("Image Rendering.Accelerated Reslicing", acceleratedReslicing, renderer);
+  localStorage->m_Reslicer->SetUseAccelerator(acceleratedReslicing);
+
   // set the vtk output property to true, makes sure that no unneeded mitk image convertion
   // is done.
   localStorage->m_Reslicer->SetVtkOutputRequest(true);
@@ -227,74 +239,159 @@ void mitk::ImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rendere
 
   const auto *planeGeometry = dynamic_cast<const PlaneGeometry *>(worldGeometry);
 
-  if (thickSlicesMode > 0)
+  if (this->UseGPUReslicing(renderer))
   {
-    double dataZSpacing = 1.0;
+    this->GenerateGPUSliceForRenderer(
+      renderer, interpolationMode != VTK_RESLICE_NEAREST, thickSlicesMode, thickSlicesNum);
+    return;
+  }
+  // the GPU reslicing mode might have been switched off
+  localStorage->m_Actor->SetMapper(localStorage->m_Mapper);
+
+  // resliced images of plane geometries are cached, so scrolling back to a recent slice is cheap
+  LocalStorage::SliceCacheEntry slice;
+  const bool useSliceCache = localStorage->m_SliceCacheSize > 0 && planeGeometry != nullptr &&
+                             dynamic_cast<const AbstractTransformGeometry *>(worldGeometry) == nullptr;
+  if (useSliceCache)
+  {
+    BaseGeometry::Pointer imageGeometry = image->GetTimeGeometry()->GetGeometryForTimeStep(this->GetTimestep());
+    const BaseGeometry *referenceGeometry = planeGeometry->GetReferenceGeometry();
+
+    slice.ImageMTime = image->GetMTime();
+    slice.ImageGeometry = imageGeometry.GetPointer();
+    slice.ImageGeometryMTime = imageGeometry.IsNotNull() ? imageGeometry->GetMTime() : 0;
+    slice.ReferenceGeometry = referenceGeometry;
+    slice.ReferenceGeometryMTime = referenceGeometry != nullptr ? referenceGeometry->GetMTime() : 0;
+    slice.PlaneMatrix = planeGeometry->GetIndexToWorldTransform()->GetMatrix();
+    slice.PlaneOffset = planeGeometry->GetIndexToWorldTransform()->GetOffset();
+    slice.PlaneBounds = planeGeometry->GetBounds();
+    slice.TimeStep = this->GetTimestep();
+    slice.InterpolationMode = interpolationMode;
+    slice.InPlaneResampleExtentByGeometry = inPlaneResampleExtentByGeometry;
+    slice.ThickSlicesMode = thickSlicesMode;
+    slice.ThickSlicesNum = thickSlicesMode > 0 ? thickSlicesNum : 0;
+
+    // slices of an outdated version of the image will never be used again
+    localStorage->m_SliceCache.remove_if([&slice](const LocalStorage::SliceCacheEntry &entry) {
+      return entry.ImageMTime != slice.ImageMTime;
+    });
+    this->CollectPrefetchedSlices(localStorage, slice);
+  }
 
-    Vector3D normInIndex, normal;
+  auto cachedSlice = localStorage->m_SliceCache.end();
+  if (useSliceCache)
+  {
+    cachedSlice = std::find_if(localStorage->m_SliceCache.begin(),
+                               localStorage->m_SliceCache.end(),
+                               [&slice](const LocalStorage::SliceCacheEntry &entry) { return entry.HasSameReslicing(slice); });
+  }
 
-    const auto *abstractGeometry =
-      dynamic_cast<const AbstractTransformGeometry *>(worldGeometry);
-    if (abstractGeometry != nullptr)
-      normal = abstractGeometry->GetPlane()->GetNormal();
-    else
+  // Bounds information for reslicing (only reuqired if reference geometry
+  // is present)
+  // this used for generating a vtkPLaneSource with the right size
+  double sliceBounds[6];
+  for (auto &sliceBound : sliceBounds)
+  {
+    sliceBound = 0.0;
+  }
+
+  if (cachedSlice != localStorage->m_SliceCache.end())
+  {
+    // move the slice to the front of the cache, it is the most recently used one now
+    localStorage->m_SliceCache.splice(localStorage->m_SliceCache.begin(), localStorage->m_SliceCache, cachedSlice);
+    const LocalStorage::SliceCacheEntry &entry = localStorage->m_SliceCache.front();
+
+    localStorage->m_ReslicedImage = entry.ReslicedImage;
+    std::copy(entry.ClippedPlaneBounds, entry.ClippedPlaneBounds + 6, sliceBounds);
+    std::copy(entry.Spacing, entry.Spacing + 3, localStorage->m_SliceSpacing);
+    localStorage->m_ResliceAxes->DeepCopy(entry.ResliceAxes);
+  }
+  else
+  {
+
+    if (thickSlicesMode > 0)
     {
-      if (planeGeometry != nullptr)
+      double dataZSpacing = 1.0;
+
+      Vector3D normInIndex, normal;
+
+      const auto *abstractGeometry =
+        dynamic_cast<const AbstractTransformGeometry *>(worldGeometry);
+      if (abstractGeometry != nullptr)
+        normal = abstractGeometry->GetPlane()->GetNormal();
+      else
       {
-        normal = planeGeometry->GetNormal();
+        if (planeGeometry != nullptr)
+        {
+          normal = planeGeometry->GetNormal();
+        }
+        else
+          return; // no fitting geometry set
       }
-      else
-        return; // no fitting geometry set
-    }
-    normal.Normalize();
+      normal.Normalize();
 
-    image->GetTimeGeometry()->GetGeometryForTimeStep(this->GetTimestep())->WorldToIndex(normal, normInIndex);
+      image->GetTimeGeometry()->GetGeometryForTimeStep(this->GetTimestep())->WorldToIndex(normal, normInIndex);
 
-    dataZSpacing = 1.0 / normInIndex.GetNorm();
+      dataZSpacing = 1.0 / normInIndex.GetNorm();
 
-    localStorage->m_Reslicer->SetOutputDimensionality(3);
-    localStorage->m_Reslicer->SetOutputSpacingZDirection(dataZSpacing);
-    localStorage->m_Reslicer->SetOutputExtentZDirection(-thickSlicesNum, 0 + thickSlicesNum);
+      localStorage->m_Reslicer->SetOutputDimensionality(3);
+      localStorage->m_Reslicer->SetOutputSpacingZDirection(dataZSpacing);
+      localStorage->m_Reslicer->SetOutputExtentZDirection(-thickSlicesNum, 0 + thickSlicesNum);
 
-    // Do the reslicing. Modified() is called to make sure that the reslicer is
-    // executed even though the input geometry information did not change; this
-    // is necessary when the input /em data, but not the /em geometry changes.
-    localStorage->m_TSFilter->SetThickSliceMode(thickSlicesMode - 1);
-    localStorage->m_TSFilter->SetInputData(localStorage->m_Reslicer->GetVtkOutput());
+      // Do the reslicing. Modified() is called to make sure that the reslicer is
+      // executed even though the input geometry information did not change; this
+      // is necessary when the input /em data, but not the /em geometry changes.
+      localStorage->m_TSFilter->SetThickSliceMode(thickSlicesMode - 1);
+      localStorage->m_TSFilter->SetInputData(localStorage->m_Reslicer->GetVtkOutput());
 
-    // vtkFilter=>mitkFilter=>vtkFilter update mechanism will fail without calling manually
-    localStorage->m_Reslicer->Modified();
-    localStorage->m_Reslicer->Update();
+      // vtkFilter=>mitkFilter=>vtkFilter update mechanism will fail without calling manually
+      localStorage->m_Reslicer->Modified();
+      localStorage->m_Reslicer->Update();
 
-    localStorage->m_TSFilter->Modified();
-    localStorage->m_TSFilter->Update();
-    localStorage->m_ReslicedImage = localStorage->m_TSFilter->GetOutput();
-  }
-  else
-  {
-    // this is needed when thick mode was enable bevore. These variable have to be reset to default values
-    localStorage->m_Reslicer->SetOutputDimensionality(2);
-    localStorage->m_Reslicer->SetOutputSpacingZDirection(1.0);
-    localStorage->m_Reslicer->SetOutputExtentZDirection(0, 0);
-
-    localStorage->m_Reslicer->Modified();
-    // start the pipeline with updating the largest possible, needed if the geometry of the input has changed
-    localStorage->m_Reslicer->UpdateLargestPossibleRegion();
-    localStorage->m_ReslicedImage = localStorage->m_Reslicer->GetVtkOutput();
-  }
+      localStorage->m_TSFilter->Modified();
+      localStorage->m_TSFilter->Update();
+      localStorage->m_ReslicedImage = localStorage->m_TSFilter->GetOutput();
+    }
+    else
+    {
+      // this is needed when thick mode was enable bevore. These variable have to be reset to default values
+      localStorage->m_Reslicer->SetOutputDimensionality(2);
+      localStorage->m_Reslicer->SetOutputSpacingZDirection(1.0);
+      localStorage->m_Reslicer->SetOutputExtentZDirection(0, 0);
+
+      localStorage->m_Reslicer->Modified();
+      // start the pipeline with updating the largest possible, needed if the geometry of the input has changed
+      localStorage->m_Reslicer->UpdateLargestPossibleRegion();
+      localStorage->m_ReslicedImage = localStorage->m_Reslicer->GetVtkOutput();
+    }
 
-  // Bounds information for reslicing (only reuqired if reference geometry
-  // is present)
-  // this used for generating a vtkPLaneSource with the right size
-  double sliceBounds[6];
-  for (auto &sliceBound : sliceBounds)
-  {
-    sliceBound = 0.0;
+    localStorage->m_Reslicer->GetClippedPlaneBounds(sliceBounds);
+
+    // get the spacing of the slice
+    const mitk::ScalarType *outputSpacing = localStorage->m_Reslicer->GetOutputSpacing();
+    std::copy(outputSpacing, outputSpacing + 3, localStorage->m_SliceSpacing);
+    localStorage->m_ResliceAxes->DeepCopy(localStorage->m_Reslicer->GetResliceAxes());
+
+    if (useSliceCache)
+    {
+      // the reslicer reuses its output, so the cache needs its own copy
+      slice.ReslicedImage = vtkSmartPointer<vtkImageData>::New();
+      slice.ReslicedImage->DeepCopy(localStorage->m_ReslicedImage);
+      std::copy(sliceBounds, sliceBounds + 6, slice.ClippedPlaneBounds);
+      std::copy(localStorage->m_SliceSpacing, localStorage->m_SliceSpacing + 3, slice.Spacing);
+      slice.ResliceAxes = vtkSmartPointer<vtkMatrix4x4>::New();
+      slice.ResliceAxes->DeepCopy(localStorage->m_ResliceAxes);
+
+      localStorage->m_SliceCache.push_front(slice);
+      while (localStorage->m_SliceCache.size() > localStorage->m_SliceCacheSize)
+        localStorage->m_SliceCache.pop_back();
+    }
   }
-  localStorage->m_Reslicer->GetClippedPlaneBounds(sliceBounds);
 
-  // get the spacing of the slice
-  localStorage->m_mmPerPixel = localStorage->m_Reslicer->GetOutputSpacing();
+  if (useSliceCache && thickSlicesMode == 0)
+    this->PrefetchTimeSteps(renderer, localStorage, slice);
+
+  localStorage->m_mmPerPixel = localStorage->m_SliceSpacing;
 
   // calculate minimum bounding rect of IMAGE in texture
   {
@@ -440,6 +537,242 @@ void mitk::ImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rendere
   localStorage->m_LastUpdateTime.Modified();
 }
 
+bool mitk::ImageVtkMapper2D::UseGPUReslicing(mitk::BaseRenderer *renderer)
+{
+  bool gpuReslicing = false;
+  mitk::DataNode *datanode = this->GetDataNode();
+  datanode->GetBoolProperty("Image Rendering.GPU Reslicing", gpuReslicing, renderer);
+  if (!gpuReslicing)
+    return false;
+
+  // curved geometries are resliced with a non-linear transform, which the shader does not know
+  const PlaneGeometry *worldGeometry = renderer->GetCurrentWorldPlaneGeometry();
+  if (dynamic_cast<const AbstractTransformGeometry *>(worldGeometry) != nullptr)
+    return false;
+
+  // binaries need the resliced image for their outlines, multi component images are not supported
+  bool binary = false;
+  datanode->GetBoolProperty("binary", binary, renderer);
+  if (binary || this->GetInput()->GetPixelType().GetNumberOfComponents() != 1)
+    return false;
+
+  // the shader maps the scalars through the lookup table only, transfer functions add an opacity function
+  int renderingMode = mitk::RenderingModeProperty::LOOKUPTABLE_LEVELWINDOW_COLOR;
+  mitk::RenderingModeProperty::Pointer mode =
+    dynamic_cast<mitk::RenderingModeProperty *>(datanode->GetProperty("Image Rendering.Mode", renderer));
+  if (mode.IsNotNull())
+  {
+    renderingMode = mode->GetRenderingMode();
+  }
+  return renderingMode == mitk::RenderingModeProperty::LOOKUPTABLE_LEVELWINDOW_COLOR ||
+         renderingMode == mitk::RenderingModeProperty::LOOKUPTABLE_COLOR;
+}
+
+void mitk::ImageVtkMapper2D::GenerateGPUSliceForRenderer(mitk::BaseRenderer *renderer,
+                                                         bool interpolate,
+                                                         int thickSlicesMode,
+                                                         int thickSlicesNum)
+{
+  LocalStorage *localStorage = m_LSH.GetLocalStorage(renderer);
+  auto *image = const_cast<mitk::Image *>(this->GetInput());
+  const PlaneGeometry *planeGeometry = renderer->GetCurrentWorldPlaneGeometry();
+
+  // the reslicer only computes the reslice axes, the spacing and the extent of the slice
+  localStorage->m_Reslicer->SetOutputDimensionality(2);
+  localStorage->m_Reslicer->SetOutputSpacingZDirection(1.0);
+  localStorage->m_Reslicer->SetOutputExtentZDirection(0, 0);
+  localStorage->m_Reslicer->SetResliceGeometryOnly(true);
+  localStorage->m_Reslicer->Modified();
+  localStorage->m_Reslicer->Update();
+  localStorage->m_Reslicer->SetResliceGeometryOnly(false);
+
+  double sliceBounds[6];
+  for (auto &sliceBound : sliceBounds)
+  {
+    sliceBound = 0.0;
+  }
+  localStorage->m_Reslicer->GetClippedPlaneBounds(sliceBounds);
+
+  const mitk::ScalarType *outputSpacing = localStorage->m_Reslicer->GetOutputSpacing();
+  std::copy(outputSpacing, outputSpacing + 3, localStorage->m_SliceSpacing);
+  localStorage->m_ResliceAxes->DeepCopy(localStorage->m_Reslicer->GetResliceAxes());
+  localStorage->m_mmPerPixel = localStorage->m_SliceSpacing;
+
+  // there is no resliced image the 3D view could show
+  localStorage->m_ReslicedImage = nullptr;
+
+  // model coordinates of the plane -> slice (see TransformActor) -> world (reslice axes) -> voxel index.
+  // The z coordinate of the plane is the layer depth and must not move the sampling position.
+  BaseGeometry::Pointer imageGeometry = image->GetTimeGeometry()->GetGeometryForTimeStep(this->GetTimestep());
+  auto modelToSlice = vtkSmartPointer<vtkMatrix4x4>::New();
+  modelToSlice->SetElement(0, 3, -0.5 * localStorage->m_mmPerPixel[0]);
+  modelToSlice->SetElement(1, 3, -0.5 * localStorage->m_mmPerPixel[1]);
+  modelToSlice->SetElement(2, 2, 0.0);
+  auto modelToWorld = vtkSmartPointer<vtkMatrix4x4>::New();
+  vtkMatrix4x4::Multiply4x4(localStorage->m_ResliceAxes, modelToSlice, modelToWorld);
+  auto worldToIndex = vtkSmartPointer<vtkMatrix4x4>::New();
+  vtkMatrix4x4::Invert(imageGeometry->GetVtkTransform()->GetMatrix(), worldToIndex);
+  auto modelToIndex = vtkSmartPointer<vtkMatrix4x4>::New();
+  vtkMatrix4x4::Multiply4x4(worldToIndex, modelToWorld, modelToIndex);
+
+  // thick slices are sampled with a distance of one voxel along the normal, as on the CPU
+  double thickSliceStep[3] = {0.0, 0.0, 0.0};
+  if (thickSlicesMode > 0)
+  {
+    Vector3D normal = planeGeometry->GetNormal();
+    normal.Normalize();
+    Vector3D normInIndex;
+    imageGeometry->WorldToIndex(normal, normInIndex);
+    normInIndex.Normalize();
+    for (int i = 0; i < 3; ++i)
+      thickSliceStep[i] = normInIndex[i];
+  }
+
+  vtkMitkGPUResliceMapper *gpuMapper = localStorage->m_GPUResliceMapper;
+
+  // the volume is uploaded to the GPU only if it was modified
+  vtkImageData *volume = image->GetVtkImageData(this->GetTimestep());
+  if (gpuMapper->GetVolume() != volume || localStorage->m_GPUVolumeMTime != image->GetMTime())
+  {
+    gpuMapper->SetVolume(volume);
+    localStorage->m_GPUVolumeMTime = image->GetMTime();
+  }
+
+  this->ApplyOpacity(renderer);
+  this->ApplyRenderingMode(renderer);
+
+  // the level window is applied as range of the lookup table, see ApplyLevelWindow
+  gpuMapper->SetColorTable(localStorage->m_LevelWindowFilter->GetLookupTable());
+  gpuMapper->SetModelToIndexMatrix(modelToIndex);
+  gpuMapper->SetThickSlices(thickSlicesMode - 1, thickSlicesMode > 0 ? thickSlicesNum : 0, thickSliceStep);
+  gpuMapper->SetInterpolate(interpolate);
+
+  this->TransformActor(renderer);
+  this->GeneratePlane(renderer, sliceBounds);
+  gpuMapper->SetInputConnection(localStorage->m_Plane->GetOutputPort());
+
+  localStorage->m_Actor->SetMapper(gpuMapper);
+  localStorage->m_Actor->SetTexture(nullptr);
+  dynamic_cast<vtkActor *>(localStorage->m_Actors->GetParts()->GetItemAsObject(0))->SetVisibility(false);
+
+  // We have been modified => save this for next Update()
+  localStorage->m_LastUpdateTime.Modified();
+}
+
+void mitk::ImageVtkMapper2D::CollectPrefetchedSlices(LocalStorage *localStorage,
+                                                     const LocalStorage::SliceCacheEntry &requestedSlice)
+{
+  auto job = localStorage->m_PrefetchJobs.begin();
+  while (job != localStorage->m_PrefetchJobs.end())
+  {
+    // the requested slice is needed now, finishing its prefetch is faster than reslicing it again
+    if (job->Slice.HasSameReslicing(requestedSlice))
+      job->Done.wait();
+
+    if (job->Done.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+      ++job;
+      continue;
+    }
+
+    if (job->Slice.ImageMTime == requestedSlice.ImageMTime)
+    {
+      // detach the slice from the reslicer, which is released with the job
+      job->Slice.ReslicedImage = vtkSmartPointer<vtkImageData>::New();
+      job->Slice.ReslicedImage->ShallowCopy(job->Reslicer->GetVtkOutput());
+      localStorage->m_SliceCache.push_front(job->Slice);
+    }
+    job = localStorage->m_PrefetchJobs.erase(job);
+  }
+
+  while (localStorage->m_SliceCache.size() > localStorage->m_SliceCacheSize)
+    localStorage->m_SliceCache.pop_back();
+}
+
+void mitk::ImageVtkMapper2D::PrefetchTimeSteps(mitk::BaseRenderer *renderer,
+                                               LocalStorage *localStorage,
+                                               const LocalStorage::SliceCacheEntry &currentSlice)
+{
+  int prefetchTimeSteps = 0;
+  this->GetDataNode()->GetIntProperty("Image Rendering.Prefetch Time Steps", prefetchTimeSteps, renderer);
+
+  auto *image = const_cast<mitk::Image *>(this->GetInput());
+  const int numberOfTimeSteps = static_cast<int>(image->GetTimeSteps());
+
+  // prefetched slices beyond the cache size would push each other out before they are shown
+  prefetchTimeSteps = std::min(prefetchTimeSteps, static_cast<int>(localStorage->m_SliceCacheSize) - 1);
+  prefetchTimeSteps = std::min(prefetchTimeSteps, numberOfTimeSteps - 1);
+
+  const PlaneGeometry *worldGeometry = renderer->GetCurrentWorldPlaneGeometry();
+  for (int i = 1; i <= prefetchTimeSteps; ++i)
+  {
+    // playback continues with the first time step after the last one
+    const int timeStep = (currentSlice.TimeStep + i) % numberOfTimeSteps;
+    if (!image->IsVolumeSet(timeStep))
+      continue;
+
+    LocalStorage::SliceCacheEntry slice = currentSlice;
+    BaseGeometry::Pointer imageGeometry = image->GetTimeGeometry()->GetGeometryForTimeStep(timeStep);
+    slice.ImageGeometry = imageGeometry.GetPointer();
+    slice.ImageGeometryMTime = imageGeometry.IsNotNull() ? imageGeometry->GetMTime() : 0;
+    slice.TimeStep = timeStep;
+
+    auto isSameSlice = [&slice](const LocalStorage::SliceCacheEntry &entry) { return entry.HasSameReslicing(slice); };
+    if (std::any_of(localStorage->m_SliceCache.begin(), localStorage->m_SliceCache.end(), isSameSlice) ||
+        std::any_of(localStorage->m_PrefetchJobs.begin(),
+                    localStorage->m_PrefetchJobs.end(),
+                    [&isSameSlice](const LocalStorage::PrefetchJob &job) { return isSameSlice(job.Slice); }))
+    {
+      continue;
+    }
+
+    std::shared_ptr<ImageReadAccessor> volumeAccessor;
+    try
+    {
+      // do not wait for a writer on the rendering thread, the slice is simply resliced when it is shown
+      volumeAccessor = std::make_shared<ImageReadAccessor>(Image::ConstPointer(image),
+                                                           image->GetVolumeData(timeStep).GetPointer(),
+                                                           ImageAccessorBase::ExceptionIfLocked);
+    }
+    catch (const MemoryIsLockedException &)
+    {
+      return;
+    }
+
+    // the geometry of the slice is set up here, only the sampling of the volume is done by the worker
+    ExtractSliceFilter::Pointer reslicer = ExtractSliceFilter::New();
+    reslicer->SetInput(image);
+    reslicer->SetWorldGeometry(worldGeometry);
+    reslicer->SetTimeStep(timeStep);
+    reslicer->SetResliceTransformByGeometry(imageGeometry);
+    reslicer->SetInPlaneResampleExtentByGeometry(slice.InPlaneResampleExtentByGeometry);
+    // the interpolation modes of ExtractSliceFilter have the values of the VTK modes
+    reslicer->SetInterpolationMode(static_cast<ExtractSliceFilter::ResliceInterpolation>(slice.InterpolationMode));
+    reslicer->SetVtkOutputRequest(true);
+    reslicer->SetResliceGeometryOnly(true);
+    reslicer->Update();
+    if (!reslicer->DetachReslicer())
+      continue;
+
+    for (auto &bound : slice.ClippedPlaneBounds)
+      bound = 0.0;
+    reslicer->GetClippedPlaneBounds(slice.ClippedPlaneBounds);
+    const mitk::ScalarType *outputSpacing = reslicer->GetOutputSpacing();
+    std::copy(outputSpacing, outputSpacing + 3, slice.Spacing);
+    slice.ResliceAxes = vtkSmartPointer<vtkMatrix4x4>::New();
+    slice.ResliceAxes->DeepCopy(reslicer->GetResliceAxes());
+    slice.ReslicedImage = nullptr;
+
+    ExtractSliceFilter *detachedReslicer = reslicer.GetPointer();
+    LocalStorage::PrefetchJob job;
+    job.Slice = slice;
+    job.Reslicer = reslicer;
+    job.VolumeAccessor = volumeAccessor;
+    job.Done = std::async(std::launch::async, [detachedReslicer]() { detachedReslicer->ResliceDetached(); });
+    localStorage->m_PrefetchJobs.push_back(std::move(job));
+  }
+}
+
 void mitk::ImageVtkMapper2D::ApplyLevelWindow(mitk::BaseRenderer *renderer)
 {
   LocalStorage *localStorage = this->GetLocalStorage(renderer);
@@ -677,6 +1010,9 @@ void mitk::ImageVtkMapper2D::Update(mitk::BaseRenderer *renderer)
       (localStorage->m_LastUpdateTime < node->GetPropertyList(renderer)->GetMTime()) ||
       (localStorage->m_LastUpdateTime < data->GetPropertyList()->GetMTime()))
   {
+    MITK_TRACE_NAMED_SCOPE(traceScope, "Mapper", this->GetNameOfClass());
+    MITK_TRACE_SET_NODE_NAME(traceScope, node->GetName());
+    MITK_TRACE_SET_DATA_SIZE(traceScope, Tracer::GetDataSize(data));
     this->GenerateDataForRenderer(renderer);
   }
 
@@ -694,6 +1030,9 @@ void mitk::ImageVtkMapper2D::SetDefaultProperties(mitk::DataNode *node, mitk::Ba
   node->AddProperty("outline binary", mitk::BoolProperty::New(false), renderer, overwrite);
   node->AddProperty("outline width", mitk::FloatProperty::New(1.0), renderer, overwrite);
   node->AddProperty("outline binary shadow", mitk::BoolProperty::New(false), renderer, overwrite);
+  node->AddProperty("Image Rendering.GPU Reslicing", mitk::BoolProperty::New(false), renderer, overwrite);
+  node->AddProperty("Image Rendering.Accelerated Reslicing", mitk::BoolProperty::New(false), renderer, overwrite);
+  node->AddProperty("Image Rendering.Prefetch Time Steps", mitk::IntProperty::New(0), renderer, overwrite);
   node->AddProperty("outline binary shadow color", ColorProperty::New(0.0, 0.0, 0.0), renderer, overwrite);
   node->AddProperty("outline shadow width", mitk::FloatProperty::New(1.5), renderer, overwrite);
   if (image->IsRotated())
@@ -1027,8 +1366,7 @@ void mitk::ImageVtkMapper2D::TransformActor(mitk::BaseRenderer *renderer)
   LocalStorage *localStorage = m_LSH.GetLocalStorage(renderer);
   // get the transformation matrix of the reslicer in order to render the slice as axial, coronal or saggital
   vtkSmartPointer<vtkTransform> trans = vtkSmartPointer<vtkTransform>::New();
-  vtkSmartPointer<vtkMatrix4x4> matrix = localStorage->m_Reslicer->GetResliceAxes();
-  trans->SetMatrix(matrix);
+  trans->SetMatrix(localStorage->m_ResliceAxes);
   // transform the plane/contour (the actual actor) to the corresponding view (axial, coronal or saggital)
   localStorage->m_Actor->SetUserTransform(trans);
   // transform the origin to center based coordinates, because MITK is center based.
@@ -1071,13 +1409,31 @@ bool mitk::ImageVtkMapper2D::RenderingGeometryIntersectsImage(const PlaneGeometr
   return false;
 }
 
+bool mitk::ImageVtkMapper2D::LocalStorage::SliceCacheEntry::HasSameReslicing(const SliceCacheEntry &other) const
+{
+  return ImageMTime == other.ImageMTime && ImageGeometry == other.ImageGeometry &&
+         ImageGeometryMTime == other.ImageGeometryMTime && ReferenceGeometry == other.ReferenceGeometry &&
+         ReferenceGeometryMTime == other.ReferenceGeometryMTime && PlaneMatrix == other.PlaneMatrix &&
+         PlaneOffset == other.PlaneOffset && PlaneBounds == other.PlaneBounds && TimeStep == other.TimeStep &&
+         InterpolationMode == other.InterpolationMode &&
+         InPlaneResampleExtentByGeometry == other.InPlaneResampleExtentByGeometry &&
+         ThickSlicesMode == other.ThickSlicesMode && ThickSlicesNum == other.ThickSlicesNum;
+}
+
 mitk::ImageVtkMapper2D::LocalStorage::~LocalStorage()
 {
 }
 
 mitk::ImageVtkMapper2D::LocalStorage::LocalStorage()
-  : m_VectorComponentExtractor(vtkSmartPointer<vtkImageExtractComponents>::New())
+  : m_VectorComponentExtractor(vtkSmartPointer<vtkImageExtractComponents>::New()),
+    m_SliceCacheSize(16),
+    m_ResliceAxes(vtkSmartPointer<vtkMatrix4x4>::New()),
+    m_GPUResliceMapper(vtkSmartPointer<vtkMitkGPUResliceMapper>::New()),
+    m_GPUVolumeMTime(0)
 {
+  m_SliceSpacing[0] = m_SliceSpacing[1] = m_SliceSpacing[2] = 1.0;
+  m_mmPerPixel = m_SliceSpacing;
+
   m_LevelWindowFilter = vtkSmartPointer<vtkMitkLevelWindowFilter>::New();
 
   // Do as much actions as possible in here to avoid double executions.
@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkBaseRenderer.h"
 #include "mitkDataNode.h"
 #include "mitkProperties.h"
+#include "mitkTracer.h"
 
 mitk::Mapper::Mapper() : m_DataNode(nullptr), m_TimeStep(0)
 {
@@ -117,6 +118,9 @@ void mitk::Mapper::Update(mitk::BaseRenderer *renderer)
     return;
   }
 
+  MITK_TRACE_NAMED_SCOPE(traceScope, "Mapper", this->GetNameOfClass());
+  MITK_TRACE_SET_NODE_NAME(traceScope, node->GetName());
+  MITK_TRACE_SET_DATA_SIZE(traceScope, Tracer::GetDataSize(data));
   this->GenerateDataForRenderer(renderer);
 }
 
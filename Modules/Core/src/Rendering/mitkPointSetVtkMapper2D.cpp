@@ -28,8 +28,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkCellArray.h>
 #include <vtkFloatArray.h>
 #include <vtkGlyph3D.h>
+#include <vtkGlyph3DMapper.h>
 #include <vtkGlyphSource2D.h>
 #include <vtkLine.h>
+#include <vtkLookupTable.h>
 #include <vtkPointData.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkPropAssembly.h>
@@ -37,6 +39,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkTextProperty.h>
 #include <vtkTransform.h>
 #include <vtkTransformFilter.h>
+#include <vtkUnsignedCharArray.h>
 
 #include <cstdlib>
 
@@ -83,6 +86,50 @@ mitk::PointSetVtkMapper2D::LocalStorage::LocalStorage()
 
   // propassembly
   m_PropAssembly = vtkSmartPointer<vtkPropAssembly>::New();
+
+  // instanced rendering
+  m_InstanceSelection = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  m_InstanceSelection->SetName("selected");
+  m_InstanceScales = vtkSmartPointer<vtkFloatArray>::New();
+  m_InstanceScales->SetName("scales");
+
+  m_InstancePolyData = vtkSmartPointer<vtkPolyData>::New();
+  m_InstancePolyData->SetPoints(vtkSmartPointer<vtkPoints>::New());
+  m_InstancePolyData->GetPointData()->SetScalars(m_InstanceSelection);
+  m_InstancePolyData->GetPointData()->AddArray(m_InstanceScales);
+
+  m_InstanceGlyphTransform = vtkSmartPointer<vtkTransform>::New();
+  m_InstanceUnselectedGlyphTransformFilter = vtkSmartPointer<vtkTransformFilter>::New();
+  m_InstanceUnselectedGlyphTransformFilter->SetInputConnection(m_UnselectedGlyphSource2D->GetOutputPort());
+  m_InstanceUnselectedGlyphTransformFilter->SetTransform(m_InstanceGlyphTransform);
+  m_InstanceSelectedGlyphTransformFilter = vtkSmartPointer<vtkTransformFilter>::New();
+  m_InstanceSelectedGlyphTransformFilter->SetInputConnection(m_SelectedGlyphSource2D->GetOutputPort());
+  m_InstanceSelectedGlyphTransformFilter->SetTransform(m_InstanceGlyphTransform);
+
+  m_InstanceLookupTable = vtkSmartPointer<vtkLookupTable>::New();
+  m_InstanceLookupTable->SetNumberOfTableValues(2);
+  m_InstanceLookupTable->SetTableRange(0.0, 1.0);
+  m_InstanceLookupTable->Build();
+
+  // the selection state is the index of the glyph source and is mapped to the colors
+  m_InstanceMapper = vtkSmartPointer<vtkGlyph3DMapper>::New();
+  m_InstanceMapper->SetInputData(m_InstancePolyData);
+  m_InstanceMapper->SetSourceConnection(0, m_InstanceUnselectedGlyphTransformFilter->GetOutputPort());
+  m_InstanceMapper->SetSourceConnection(1, m_InstanceSelectedGlyphTransformFilter->GetOutputPort());
+  m_InstanceMapper->SetSourceIndexArray("selected");
+  m_InstanceMapper->SourceIndexingOn();
+  m_InstanceMapper->SetScaleArray("scales");
+  m_InstanceMapper->SetScaleModeToScaleByMagnitude();
+  m_InstanceMapper->ScalingOn();
+  m_InstanceMapper->OrientOff();
+  m_InstanceMapper->SetLookupTable(m_InstanceLookupTable);
+  m_InstanceMapper->SetColorModeToMapScalars();
+  m_InstanceMapper->SetScalarModeToUsePointData();
+  m_InstanceMapper->SetScalarRange(0.0, 1.0);
+  m_InstanceMapper->ScalarVisibilityOn();
+
+  m_InstanceActor = vtkSmartPointer<vtkActor>::New();
+  m_InstanceActor->SetMapper(m_InstanceMapper);
 }
 // destructor LocalStorage
 mitk::PointSetVtkMapper2D::LocalStorage::~LocalStorage()
@@ -109,7 +156,8 @@ mitk::PointSetVtkMapper2D::PointSetVtkMapper2D()
     m_Point2DSize(6),
     m_IDShapeProperty(mitk::PointSetShapeProperty::CROSS),
     m_FillShape(false),
-    m_DistanceToPlane(4.0f)
+    m_DistanceToPlane(4.0f),
+    m_UseInstancedRendering(false)
 {
 }
 
@@ -132,6 +180,15 @@ vtkProp *mitk::PointSetVtkMapper2D::GetVtkProp(mitk::BaseRenderer *renderer)
   return ls->m_PropAssembly;
 }
 
+// set a table value only if it differs, the instance colors are uploaded again whenever the table is modified
+static void setTableValueIfChanged(vtkLookupTable *lookupTable, vtkIdType index, double r, double g, double b)
+{
+  double current[4];
+  lookupTable->GetTableValue(index, current);
+  if (current[0] != r || current[1] != g || current[2] != b || current[3] != 1.0)
+    lookupTable->SetTableValue(index, r, g, b, 1.0);
+}
+
 static bool makePerpendicularVector2D(const mitk::Vector2D &in, mitk::Vector2D &out)
 {
   // The dot product of orthogonal vectors is zero.
@@ -510,6 +567,37 @@ void mitk::PointSetVtkMapper2D::CreateVTKRenderObjects(mitk::BaseRenderer *rende
 
   transform->SetMatrix(b);
 
+  //---- INSTANCED POINTS  -----//
+
+  if (m_UseInstancedRendering)
+  {
+    ls->m_UnselectedGlyphSource2D->SetGlyphType(m_IDShapeProperty);
+    ls->m_UnselectedGlyphSource2D->SetFilled(m_FillShape);
+    ls->m_SelectedGlyphSource2D->SetGlyphTypeToDiamond();
+    ls->m_SelectedGlyphSource2D->CrossOn();
+    ls->m_SelectedGlyphSource2D->FilledOff();
+
+    // the glyphs are only transformed again if the orientation of the plane changed
+    vtkMatrix4x4 *glyphMatrix = ls->m_InstanceGlyphTransform->GetMatrix();
+    bool orientationChanged = false;
+    for (int row = 0; row < 4 && !orientationChanged; ++row)
+      for (int column = 0; column < 4 && !orientationChanged; ++column)
+        orientationChanged = glyphMatrix->GetElement(row, column) != b->GetElement(row, column);
+    if (orientationChanged)
+      ls->m_InstanceGlyphTransform->SetMatrix(b);
+
+    this->UpdateInstancedPoints(ls);
+
+    ls->m_InstanceActor->GetProperty()->SetLineWidth(m_PointLineWidth);
+
+    ls->m_PropAssembly->RemovePart(ls->m_UnselectedActor);
+    ls->m_PropAssembly->RemovePart(ls->m_SelectedActor);
+    ls->m_PropAssembly->AddPart(ls->m_InstanceActor);
+    return;
+  }
+
+  ls->m_PropAssembly->RemovePart(ls->m_InstanceActor);
+
   //---- UNSELECTED POINTS  -----//
 
   // apply properties to glyph
@@ -567,6 +655,66 @@ void mitk::PointSetVtkMapper2D::CreateVTKRenderObjects(mitk::BaseRenderer *rende
   ls->m_PropAssembly->AddPart(ls->m_SelectedActor);
 }
 
+void mitk::PointSetVtkMapper2D::UpdateInstancedPoints(LocalStorage *ls)
+{
+  vtkPoints *instancePoints = ls->m_InstancePolyData->GetPoints();
+  const vtkIdType numberOfUnselectedPoints = ls->m_UnselectedPoints->GetNumberOfPoints();
+  const vtkIdType numberOfPoints = numberOfUnselectedPoints + ls->m_SelectedPoints->GetNumberOfPoints();
+  const vtkIdType previousNumberOfPoints = instancePoints->GetNumberOfPoints();
+
+  // added points are appended, if there are less points all entries are written again
+  bool modified = (numberOfPoints != previousNumberOfPoints);
+  if (numberOfPoints < previousNumberOfPoints)
+  {
+    instancePoints->Reset();
+    ls->m_InstanceSelection->Reset();
+    ls->m_InstanceScales->Reset();
+  }
+  const vtkIdType numberOfKeptPoints = instancePoints->GetNumberOfPoints();
+
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+  {
+    const bool isSelected = i >= numberOfUnselectedPoints;
+    const vtkIdType sourceIndex = isSelected ? i - numberOfUnselectedPoints : i;
+
+    double position[3];
+    (isSelected ? ls->m_SelectedPoints : ls->m_UnselectedPoints)->GetPoint(sourceIndex, position);
+    const float scale = (isSelected ? ls->m_SelectedScales : ls->m_UnselectedScales)->GetComponent(sourceIndex, 0);
+    const unsigned char selected = isSelected ? 1 : 0;
+
+    if (i < numberOfKeptPoints)
+    {
+      double previousPosition[3];
+      instancePoints->GetPoint(i, previousPosition);
+      if (previousPosition[0] == position[0] && previousPosition[1] == position[1] &&
+          previousPosition[2] == position[2] && ls->m_InstanceScales->GetValue(i) == scale &&
+          ls->m_InstanceSelection->GetValue(i) == selected)
+      {
+        continue;
+      }
+
+      instancePoints->SetPoint(i, position);
+      ls->m_InstanceScales->SetValue(i, scale);
+      ls->m_InstanceSelection->SetValue(i, selected);
+    }
+    else
+    {
+      instancePoints->InsertNextPoint(position);
+      ls->m_InstanceScales->InsertNextValue(scale);
+      ls->m_InstanceSelection->InsertNextValue(selected);
+    }
+    modified = true;
+  }
+
+  if (modified)
+  {
+    instancePoints->Modified();
+    ls->m_InstanceScales->Modified();
+    ls->m_InstanceSelection->Modified();
+    ls->m_InstancePolyData->Modified();
+  }
+}
+
 void mitk::PointSetVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *renderer)
 {
   const mitk::DataNode *node = GetDataNode();
@@ -586,6 +734,7 @@ void mitk::PointSetVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rend
     ls->m_UnselectedActor->VisibilityOff();
     ls->m_SelectedActor->VisibilityOff();
     ls->m_ContourActor->VisibilityOff();
+    ls->m_InstanceActor->VisibilityOff();
     ls->m_PropAssembly->VisibilityOff();
     return;
   }
@@ -614,6 +763,7 @@ void mitk::PointSetVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rend
   }
   node->GetBoolProperty("Pointset.2D.fill shape", m_FillShape, renderer);
   node->GetFloatProperty("Pointset.2D.distance to plane", m_DistanceToPlane, renderer);
+  node->GetBoolProperty("Pointset.instanced rendering", m_UseInstancedRendering, renderer);
 
   mitk::PointSetShapeProperty::Pointer shape =
     dynamic_cast<mitk::PointSetShapeProperty *>(this->GetDataNode()->GetProperty("Pointset.2D.shape", renderer));
@@ -637,6 +787,7 @@ void mitk::PointSetVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rend
 
     ls->m_UnselectedActor->VisibilityOn();
     ls->m_SelectedActor->VisibilityOn();
+    ls->m_InstanceActor->VisibilityOn();
 
     // check if there is a color property
     GetDataNode()->GetColor(unselectedColor);
@@ -670,11 +821,16 @@ void mitk::PointSetVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rend
 
     ls->m_UnselectedActor->GetProperty()->SetColor(unselectedColor[0], unselectedColor[1], unselectedColor[2]);
     ls->m_UnselectedActor->GetProperty()->SetOpacity(opacity);
+
+    setTableValueIfChanged(ls->m_InstanceLookupTable, 0, unselectedColor[0], unselectedColor[1], unselectedColor[2]);
+    setTableValueIfChanged(ls->m_InstanceLookupTable, 1, selectedColor[0], selectedColor[1], selectedColor[2]);
+    ls->m_InstanceActor->GetProperty()->SetOpacity(opacity);
   }
   else
   {
     ls->m_UnselectedActor->VisibilityOff();
     ls->m_SelectedActor->VisibilityOff();
+    ls->m_InstanceActor->VisibilityOff();
   }
 
   if (m_ShowContour)
@@ -744,6 +900,7 @@ void mitk::PointSetVtkMapper2D::SetDefaultProperties(mitk::DataNode *node, mitk:
                     mitk::FloatProperty::New(4.0f),
                     renderer,
                     overwrite); // show the point at a certain distance above/below the 2D imaging plane.
+  node->AddProperty("Pointset.instanced rendering", mitk::BoolProperty::New(false), renderer, overwrite);
 
   Superclass::SetDefaultProperties(node, renderer, overwrite);
 }
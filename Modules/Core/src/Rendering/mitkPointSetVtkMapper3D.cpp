@@ -27,6 +27,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkConeSource.h>
 #include <vtkCubeSource.h>
 #include <vtkCylinderSource.h>
+#include <vtkGlyph3DMapper.h>
+#include <vtkLookupTable.h>
+#include <vtkPointData.h>
 #include <vtkPolyDataAlgorithm.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkPropAssembly.h>
@@ -36,6 +39,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkTransform.h>
 #include <vtkTransformPolyDataFilter.h>
 #include <vtkTubeFilter.h>
+#include <vtkUnsignedCharArray.h>
 #include <vtkVectorText.h>
 
 #include <cstdlib>
@@ -43,6 +47,42 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkPropertyObserver.h>
 #include <vtk_glew.h>
 
+namespace
+{
+  // glyph sources of the instanced rendering
+  enum InstanceGlyph
+  {
+    InstanceGlyphSphere = 0,
+    InstanceGlyphCube,
+    InstanceGlyphCone,
+    InstanceGlyphCylinder
+  };
+
+  unsigned char GetInstanceGlyph(int pointType)
+  {
+    switch (pointType)
+    {
+      case mitk::PTSTART:
+        return InstanceGlyphCube;
+      case mitk::PTCORNER:
+        return InstanceGlyphCone;
+      case mitk::PTEDGE:
+        return InstanceGlyphCylinder;
+      default:
+        return InstanceGlyphSphere;
+    }
+  }
+
+  /** set a table value only if it differs, the instance colors are uploaded again whenever the table is modified */
+  void SetTableValueIfChanged(vtkLookupTable *lookupTable, vtkIdType index, const double rgba[4])
+  {
+    double current[4];
+    lookupTable->GetTableValue(index, current);
+    if (current[0] != rgba[0] || current[1] != rgba[1] || current[2] != rgba[2] || current[3] != rgba[3])
+      lookupTable->SetTableValue(index, rgba[0], rgba[1], rgba[2], rgba[3]);
+  }
+}
+
 const mitk::PointSet *mitk::PointSetVtkMapper3D::GetInput()
 {
   return static_cast<const mitk::PointSet *>(GetDataNode()->GetData());
@@ -54,6 +94,7 @@ mitk::PointSetVtkMapper3D::PointSetVtkMapper3D()
     m_VtkSelectedPolyDataMapper(nullptr),
     m_VtkUnselectedPolyDataMapper(nullptr),
     m_vtkTextList(nullptr),
+    m_UseInstancedRendering(false),
     m_NumberOfSelectedAdded(0),
     m_NumberOfUnselectedAdded(0),
     m_PointSize(1.0),
@@ -66,6 +107,63 @@ mitk::PointSetVtkMapper3D::PointSetVtkMapper3D()
   m_SelectedActor = vtkSmartPointer<vtkActor>::New();
   m_UnselectedActor = vtkSmartPointer<vtkActor>::New();
   m_ContourActor = vtkSmartPointer<vtkActor>::New();
+
+  // instanced rendering: one polydata holding a vertex per point, the glyphs are
+  // scaled by the point size and placed by the mapper
+  m_InstanceSelection = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  m_InstanceSelection->SetName("selected");
+  m_InstanceGlyphIndices = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  m_InstanceGlyphIndices->SetName("glyph index");
+
+  m_InstancePolyData = vtkSmartPointer<vtkPolyData>::New();
+  m_InstancePolyData->SetPoints(vtkSmartPointer<vtkPoints>::New());
+  m_InstancePolyData->GetPointData()->SetScalars(m_InstanceSelection);
+  m_InstancePolyData->GetPointData()->AddArray(m_InstanceGlyphIndices);
+
+  m_InstanceLookupTable = vtkSmartPointer<vtkLookupTable>::New();
+  m_InstanceLookupTable->SetNumberOfTableValues(2);
+  m_InstanceLookupTable->SetTableRange(0.0, 1.0);
+  m_InstanceLookupTable->Build();
+
+  m_InstanceMapper = vtkSmartPointer<vtkGlyph3DMapper>::New();
+  m_InstanceMapper->SetInputData(m_InstancePolyData);
+
+  // unit sized versions of the per point sources of CreateVTKRenderObjects()
+  vtkSmartPointer<vtkSphereSource> sphere = vtkSmartPointer<vtkSphereSource>::New();
+  sphere->SetRadius(0.5);
+  sphere->SetThetaResolution(20);
+  sphere->SetPhiResolution(20);
+  m_InstanceMapper->SetSourceConnection(InstanceGlyphSphere, sphere->GetOutputPort());
+
+  vtkSmartPointer<vtkCubeSource> cube = vtkSmartPointer<vtkCubeSource>::New();
+  cube->SetXLength(0.5);
+  cube->SetYLength(0.5);
+  cube->SetZLength(0.5);
+  m_InstanceMapper->SetSourceConnection(InstanceGlyphCube, cube->GetOutputPort());
+
+  vtkSmartPointer<vtkConeSource> cone = vtkSmartPointer<vtkConeSource>::New();
+  cone->SetRadius(0.5);
+  cone->SetResolution(20);
+  m_InstanceMapper->SetSourceConnection(InstanceGlyphCone, cone->GetOutputPort());
+
+  vtkSmartPointer<vtkCylinderSource> cylinder = vtkSmartPointer<vtkCylinderSource>::New();
+  cylinder->SetRadius(0.5);
+  cylinder->SetResolution(20);
+  m_InstanceMapper->SetSourceConnection(InstanceGlyphCylinder, cylinder->GetOutputPort());
+
+  m_InstanceMapper->SetSourceIndexArray("glyph index");
+  m_InstanceMapper->SourceIndexingOn();
+  m_InstanceMapper->OrientOff();
+  m_InstanceMapper->ScalingOn();
+  m_InstanceMapper->SetScaleModeToNoDataScaling();
+  m_InstanceMapper->SetLookupTable(m_InstanceLookupTable);
+  m_InstanceMapper->SetColorModeToMapScalars();
+  m_InstanceMapper->SetScalarModeToUsePointData();
+  m_InstanceMapper->SetScalarRange(0.0, 1.0);
+  m_InstanceMapper->ScalarVisibilityOn();
+
+  m_InstanceActor = vtkSmartPointer<vtkActor>::New();
+  m_InstanceActor->SetMapper(m_InstanceMapper);
 }
 
 mitk::PointSetVtkMapper3D::~PointSetVtkMapper3D()
@@ -79,6 +177,7 @@ void mitk::PointSetVtkMapper3D::ReleaseGraphicsResources(vtkWindow *renWin)
   m_SelectedActor->ReleaseGraphicsResources(renWin);
   m_UnselectedActor->ReleaseGraphicsResources(renWin);
   m_ContourActor->ReleaseGraphicsResources(renWin);
+  m_InstanceActor->ReleaseGraphicsResources(renWin);
 }
 
 void mitk::PointSetVtkMapper3D::ReleaseGraphicsResources(mitk::BaseRenderer *renderer)
@@ -88,6 +187,7 @@ void mitk::PointSetVtkMapper3D::ReleaseGraphicsResources(mitk::BaseRenderer *ren
   m_SelectedActor->ReleaseGraphicsResources(renderer->GetRenderWindow());
   m_UnselectedActor->ReleaseGraphicsResources(renderer->GetRenderWindow());
   m_ContourActor->ReleaseGraphicsResources(renderer->GetRenderWindow());
+  m_InstanceActor->ReleaseGraphicsResources(renderer->GetRenderWindow());
 }
 
 void mitk::PointSetVtkMapper3D::CreateVTKRenderObjects()
@@ -103,6 +203,8 @@ void mitk::PointSetVtkMapper3D::CreateVTKRenderObjects()
     m_PointsAssembly->RemovePart(m_UnselectedActor);
   if (m_PointsAssembly->GetParts()->IsItemPresent(m_ContourActor))
     m_PointsAssembly->RemovePart(m_ContourActor);
+  if (m_PointsAssembly->GetParts()->IsItemPresent(m_InstanceActor))
+    m_PointsAssembly->RemovePart(m_InstanceActor);
 
   // exceptional displaying for PositionTracker -> MouseOrientationTool
   int mapperID;
@@ -200,6 +302,17 @@ void mitk::PointSetVtkMapper3D::CreateVTKRenderObjects()
     this->CreateContour(m_WorldPositions, m_PointConnections);
   }
 
+  // large point sets: all points are drawn by one glyph mapper, only changed points are written
+  m_UseInstancedRendering = false;
+  this->GetDataNode()->GetBoolProperty("Pointset.instanced rendering", m_UseInstancedRendering);
+  if (m_UseInstancedRendering)
+  {
+    this->UpdateInstancedPoints();
+    m_InstanceMapper->SetScaleFactor(m_PointSize);
+    m_PointsAssembly->AddPart(m_InstanceActor);
+    return;
+  }
+
   // check if the list for the PointDataContainer is the same size as the PointsContainer. Is not, then the points were
   // inserted manually and can not be visualized according to the PointData (selected/unselected)
   bool pointDataBroken = (itkPointSet->GetPointData()->Size() != itkPointSet->GetPoints()->Size());
@@ -371,6 +484,76 @@ void mitk::PointSetVtkMapper3D::CreateVTKRenderObjects()
   }
 }
 
+void mitk::PointSetVtkMapper3D::UpdateInstancedPoints()
+{
+  mitk::PointSet::DataType::Pointer itkPointSet =
+    const_cast<mitk::PointSet *>(this->GetInput())->GetPointSet(this->GetTimestep());
+
+  // see CreateVTKRenderObjects(): without valid point data all points are unselected spheres
+  bool pointDataBroken = (itkPointSet->GetPointData()->Size() != itkPointSet->GetPoints()->Size());
+
+  vtkPoints *instancePoints = m_InstancePolyData->GetPoints();
+  const vtkIdType numberOfPoints = m_WorldPositions->GetNumberOfPoints();
+  const vtkIdType previousNumberOfPoints = instancePoints->GetNumberOfPoints();
+
+  // added points are appended, after a removal all entries are written again
+  bool modified = (numberOfPoints != previousNumberOfPoints);
+  if (numberOfPoints < previousNumberOfPoints)
+  {
+    instancePoints->Reset();
+    m_InstanceSelection->Reset();
+    m_InstanceGlyphIndices->Reset();
+  }
+  const vtkIdType numberOfKeptPoints = instancePoints->GetNumberOfPoints();
+
+  mitk::PointSet::PointDataContainer::Iterator pointDataIter = itkPointSet->GetPointData()->Begin();
+  for (vtkIdType ptIdx = 0; ptIdx < numberOfPoints; ++ptIdx)
+  {
+    double position[3];
+    m_WorldPositions->GetPoint(ptIdx, position);
+
+    unsigned char selected = 0;
+    unsigned char glyph = InstanceGlyphSphere;
+    if (!pointDataBroken && pointDataIter != itkPointSet->GetPointData()->End())
+    {
+      selected = pointDataIter.Value().selected ? 1 : 0;
+      glyph = GetInstanceGlyph(pointDataIter.Value().pointSpec);
+      ++pointDataIter;
+    }
+
+    if (ptIdx < numberOfKeptPoints)
+    {
+      double previousPosition[3];
+      instancePoints->GetPoint(ptIdx, previousPosition);
+      if (previousPosition[0] == position[0] && previousPosition[1] == position[1] &&
+          previousPosition[2] == position[2] && m_InstanceSelection->GetValue(ptIdx) == selected &&
+          m_InstanceGlyphIndices->GetValue(ptIdx) == glyph)
+      {
+        continue;
+      }
+
+      instancePoints->SetPoint(ptIdx, position);
+      m_InstanceSelection->SetValue(ptIdx, selected);
+      m_InstanceGlyphIndices->SetValue(ptIdx, glyph);
+    }
+    else
+    {
+      instancePoints->InsertNextPoint(position);
+      m_InstanceSelection->InsertNextValue(selected);
+      m_InstanceGlyphIndices->InsertNextValue(glyph);
+    }
+    modified = true;
+  }
+
+  if (modified)
+  {
+    instancePoints->Modified();
+    m_InstanceSelection->Modified();
+    m_InstanceGlyphIndices->Modified();
+    m_InstancePolyData->Modified();
+  }
+}
+
 void mitk::PointSetVtkMapper3D::GenerateDataForRenderer(mitk::BaseRenderer *renderer)
 {
   bool visible = true;
@@ -380,6 +563,7 @@ void mitk::PointSetVtkMapper3D::GenerateDataForRenderer(mitk::BaseRenderer *rend
     m_UnselectedActor->VisibilityOff();
     m_SelectedActor->VisibilityOff();
     m_ContourActor->VisibilityOff();
+    m_InstanceActor->VisibilityOff();
     return;
   }
 
@@ -409,6 +593,7 @@ void mitk::PointSetVtkMapper3D::GenerateDataForRenderer(mitk::BaseRenderer *rend
 
   m_UnselectedActor->SetVisibility(showPoints);
   m_SelectedActor->SetVisibility(showPoints);
+  m_InstanceActor->SetVisibility(showPoints);
 
   if (false && dynamic_cast<mitk::FloatProperty *>(this->GetDataNode()->GetProperty("opacity")) != nullptr)
   {
@@ -567,6 +752,11 @@ void mitk::PointSetVtkMapper3D::ApplyAllProperties(mitk::BaseRenderer *renderer,
 
   m_UnselectedActor->GetProperty()->SetColor(unselectedColor);
   m_UnselectedActor->GetProperty()->SetOpacity(opacity);
+
+  // the instanced points are colored by their selection state
+  SetTableValueIfChanged(m_InstanceLookupTable, 0, unselectedColor);
+  SetTableValueIfChanged(m_InstanceLookupTable, 1, selectedColor);
+  m_InstanceActor->GetProperty()->SetOpacity(opacity);
 }
 
 void mitk::PointSetVtkMapper3D::CreateContour(vtkPoints *points, vtkCellArray *m_PointConnections)
@@ -614,5 +804,6 @@ void mitk::PointSetVtkMapper3D::SetDefaultProperties(mitk::DataNode *node, mitk:
   node->AddProperty("contoursize", mitk::FloatProperty::New(0.5), renderer, overwrite);
   node->AddProperty("show points", mitk::BoolProperty::New(true), renderer, overwrite);
   node->AddProperty("updateDataOnRender", mitk::BoolProperty::New(true), renderer, overwrite);
+  node->AddProperty("Pointset.instanced rendering", mitk::BoolProperty::New(false), renderer, overwrite);
   Superclass::SetDefaultProperties(node, renderer, overwrite);
 }
@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkRenderingManager.h"
 #include "mitkVtkEventProvider.h"
 #include "mitkVtkLayerController.h"
+#include "vtkGenericRenderWindowInteractor.h"
 #include "vtkRenderWindowInteractor.h"
 #include "vtkRenderer.h"
 
@@ -40,7 +41,11 @@ mitk::RenderWindow::RenderWindow(vtkRenderWindow *renWin,
     m_vtkRenderWindow->SetSize(100, 100);
   }
 
-  m_vtkRenderWindowInteractor = vtkRenderWindowInteractor::New();
+  // an offscreen window must not connect to a display, which the platform interactors do
+  if (m_vtkRenderWindow->GetOffScreenRendering())
+    m_vtkRenderWindowInteractor = vtkGenericRenderWindowInteractor::New();
+  else
+    m_vtkRenderWindowInteractor = vtkRenderWindowInteractor::New();
   m_vtkRenderWindowInteractor->SetRenderWindow(m_vtkRenderWindow);
   m_vtkRenderWindowInteractor->Initialize();
 
@@ -53,6 +58,24 @@ mitk::RenderWindow::RenderWindow(vtkRenderWindow *renWin,
   m_vtkMitkEventProvider->SetEnabled(1);
 }
 
+mitk::RenderWindow::Pointer mitk::RenderWindow::NewOffscreen(int width,
+                                                             int height,
+                                                             const char *name,
+                                                             mitk::RenderingManager *rm,
+                                                             mitk::BaseRenderer::RenderingMode::Type rmtype)
+{
+  vtkRenderWindow *renderWindow = vtkRenderWindow::New();
+  renderWindow->SetMultiSamples(0);
+  renderWindow->SetAlphaBitPlanes(0);
+  renderWindow->SetOffScreenRendering(1);
+  renderWindow->SetSize(width, height);
+
+  // the render window takes ownership of renderWindow
+  Pointer smartPtr = new RenderWindow(renderWindow, name, rm, rmtype);
+  smartPtr->UnRegister();
+  return smartPtr;
+}
+
 mitk::RenderWindow::~RenderWindow()
 {
   Destroy();
@@ -61,6 +84,11 @@ mitk::RenderWindow::~RenderWindow()
   m_vtkMitkEventProvider->Delete();
 }
 
+bool mitk::RenderWindow::IsOffscreen()
+{
+  return m_vtkRenderWindow->GetOffScreenRendering() != 0;
+}
+
 vtkRenderWindow *mitk::RenderWindow::GetVtkRenderWindow()
 {
   return m_vtkRenderWindow;
@@ -0,0 +1,292 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkRenderWindowFrameReader.h"
+
+#include <mitkExceptionMacro.h>
+
+#include <vtkRenderWindow.h>
+#include <vtkSmartPointer.h>
+#include <vtk_glew.h>
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#ifndef GL_BGR
+#define GL_BGR GL_BGR_EXT
+#endif
+
+class mitk::RenderWindowFrameReader::Impl
+{
+public:
+  struct Buffer
+  {
+    GLuint Name;
+    std::size_t Size;
+  };
+
+  struct PendingFrame
+  {
+    Buffer PixelBuffer;
+    GLsync Fence;
+    int Width;
+    int Height;
+    std::size_t Size;
+    FrameCallback Callback;
+  };
+
+  Impl() : Asynchronous(false) {}
+
+  bool MakeCurrent()
+  {
+    if (RenderWindow == nullptr)
+      return false;
+
+    RenderWindow->MakeCurrent();
+    return true;
+  }
+
+  void Complete(PendingFrame &frame)
+  {
+    // GL_SYNC_FLUSH_COMMANDS_BIT makes sure the fence is submitted, the loop only guards against timeouts
+    GLenum waitResult = GL_TIMEOUT_EXPIRED;
+    while (waitResult == GL_TIMEOUT_EXPIRED)
+    {
+      waitResult = glClientWaitSync(frame.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000);
+    }
+    glDeleteSync(frame.Fence);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, frame.PixelBuffer.Name);
+    const void *pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frame.Size, GL_MAP_READ_BIT);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (waitResult == GL_WAIT_FAILED || pixels == nullptr)
+    {
+      MITK_ERROR << "Reading the pixels of a render window failed.";
+    }
+    else
+    {
+      frame.Callback(static_cast<const unsigned char *>(pixels), frame.Width, frame.Height);
+    }
+
+    if (pixels != nullptr)
+    {
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, frame.PixelBuffer.Name);
+      glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    FreeBuffers.push_back(frame.PixelBuffer);
+  }
+
+  void CompleteOldest()
+  {
+    PendingFrame frame = Pending.front();
+    Pending.pop_front();
+    this->Complete(frame);
+  }
+
+  void CompleteFinished()
+  {
+    while (!Pending.empty())
+    {
+      const GLenum status = glClientWaitSync(Pending.front().Fence, 0, 0);
+      if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        break;
+
+      this->CompleteOldest();
+    }
+  }
+
+  void CompleteAll()
+  {
+    if (!Pending.empty() && this->MakeCurrent())
+    {
+      while (!Pending.empty())
+        this->CompleteOldest();
+    }
+  }
+
+  void DiscardAll()
+  {
+    if (!Pending.empty() && this->MakeCurrent())
+    {
+      for (const auto &frame : Pending)
+      {
+        glDeleteSync(frame.Fence);
+        FreeBuffers.push_back(frame.PixelBuffer);
+      }
+    }
+    Pending.clear();
+  }
+
+  void ReleaseBuffers()
+  {
+    if (!FreeBuffers.empty() && this->MakeCurrent())
+    {
+      for (const auto &buffer : FreeBuffers)
+        glDeleteBuffers(1, &buffer.Name);
+    }
+    FreeBuffers.clear();
+  }
+
+  vtkSmartPointer<vtkRenderWindow> RenderWindow;
+  std::deque<PendingFrame> Pending;
+  std::vector<Buffer> FreeBuffers;
+  std::vector<unsigned char> SynchronousPixels;
+  bool Asynchronous;
+};
+
+mitk::RenderWindowFrameReader::RenderWindowFrameReader() : d(new Impl), m_PixelFormat(RGB), m_NumberOfBuffers(3)
+{
+}
+
+mitk::RenderWindowFrameReader::~RenderWindowFrameReader()
+{
+  d->CompleteAll();
+  d->ReleaseBuffers();
+}
+
+void mitk::RenderWindowFrameReader::SetRenderWindow(vtkRenderWindow *renderWindow)
+{
+  if (d->RenderWindow == renderWindow)
+    return;
+
+  // the buffers belong to the context of the previous window
+  d->CompleteAll();
+  d->ReleaseBuffers();
+
+  d->RenderWindow = renderWindow;
+  this->Modified();
+}
+
+vtkRenderWindow *mitk::RenderWindowFrameReader::GetRenderWindow() const
+{
+  return d->RenderWindow;
+}
+
+void mitk::RenderWindowFrameReader::SetNumberOfBuffers(unsigned int numberOfBuffers)
+{
+  numberOfBuffers = std::max(numberOfBuffers, 1u);
+  if (m_NumberOfBuffers == numberOfBuffers)
+    return;
+
+  m_NumberOfBuffers = numberOfBuffers;
+  this->Modified();
+}
+
+void mitk::RenderWindowFrameReader::ReadPixels(const FrameCallback &callback)
+{
+  if (d->RenderWindow == nullptr)
+    mitkThrow() << "No render window set to read pixels from.";
+
+  const int *size = d->RenderWindow->GetSize();
+  this->ReadPixels(0, 0, size[0], size[1], callback);
+}
+
+void mitk::RenderWindowFrameReader::ReadPixels(int x, int y, int width, int height, const FrameCallback &callback)
+{
+  if (!d->MakeCurrent())
+    mitkThrow() << "No render window set to read pixels from.";
+
+  if (width <= 0 || height <= 0)
+    mitkThrow() << "Invalid region of " << width << " x " << height << " pixels.";
+
+  GLenum format = GL_RGB;
+  std::size_t bytesPerPixel = 3;
+  switch (m_PixelFormat)
+  {
+    case BGR:
+      format = GL_BGR;
+      break;
+    case RGBA:
+      format = GL_RGBA;
+      bytesPerPixel = 4;
+      break;
+    case RGB:
+    default:
+      break;
+  }
+
+  const std::size_t size = bytesPerPixel * width * height;
+
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+  d->Asynchronous = glewIsSupported("GL_VERSION_3_2") || (GLEW_ARB_pixel_buffer_object && GLEW_ARB_sync);
+  if (!d->Asynchronous)
+  {
+    d->SynchronousPixels.resize(size);
+    glReadPixels(x, y, width, height, format, GL_UNSIGNED_BYTE, d->SynchronousPixels.data());
+    callback(d->SynchronousPixels.data(), width, height);
+    return;
+  }
+
+  // deliver what is done already, then make room for this frame
+  d->CompleteFinished();
+  while (d->Pending.size() >= m_NumberOfBuffers)
+    d->CompleteOldest();
+
+  Impl::PendingFrame frame;
+  if (d->FreeBuffers.empty())
+  {
+    frame.PixelBuffer.Size = 0;
+    glGenBuffers(1, &frame.PixelBuffer.Name);
+  }
+  else
+  {
+    frame.PixelBuffer = d->FreeBuffers.back();
+    d->FreeBuffers.pop_back();
+  }
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, frame.PixelBuffer.Name);
+  if (frame.PixelBuffer.Size < size)
+  {
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    frame.PixelBuffer.Size = size;
+  }
+
+  // with a bound pack buffer the pixels are copied into it without waiting for the rendering
+  glReadPixels(x, y, width, height, format, GL_UNSIGNED_BYTE, nullptr);
+  frame.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  frame.Width = width;
+  frame.Height = height;
+  frame.Size = size;
+  frame.Callback = callback;
+  d->Pending.push_back(frame);
+}
+
+void mitk::RenderWindowFrameReader::Flush()
+{
+  d->CompleteAll();
+}
+
+void mitk::RenderWindowFrameReader::Discard()
+{
+  d->DiscardAll();
+}
+
+unsigned int mitk::RenderWindowFrameReader::GetNumberOfPendingFrames() const
+{
+  return static_cast<unsigned int>(d->Pending.size());
+}
+
+bool mitk::RenderWindowFrameReader::IsAsynchronous() const
+{
+  return d->Asynchronous;
+}
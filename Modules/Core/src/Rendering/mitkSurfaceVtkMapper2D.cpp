@@ -25,6 +25,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkLookupTableProperty.h>
 #include <mitkProperties.h>
 #include <mitkSurface.h>
+#include <mitkTracer.h>
 #include <mitkTransferFunctionProperty.h>
 #include <mitkVtkScalarModeProperty.h>
 
@@ -32,10 +33,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkActor.h>
 #include <vtkArrowSource.h>
 #include <vtkAssembly.h>
-#include <vtkCutter.h>
 #include <vtkGlyph3D.h>
 #include <vtkLookupTable.h>
-#include <vtkPlane.h>
+#include <vtkMitkIndexedPlaneCutter.h>
 #include <vtkPointData.h>
 #include <vtkPolyData.h>
 #include <vtkReverseSense.h>
@@ -49,9 +49,9 @@ mitk::SurfaceVtkMapper2D::LocalStorage::LocalStorage()
   m_Actor = vtkSmartPointer<vtkActor>::New();
   m_PropAssembly = vtkSmartPointer<vtkAssembly>::New();
   m_PropAssembly->AddPart(m_Actor);
-  m_CuttingPlane = vtkSmartPointer<vtkPlane>::New();
-  m_Cutter = vtkSmartPointer<vtkCutter>::New();
-  m_Cutter->SetCutFunction(m_CuttingPlane);
+  m_TransformFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
+  m_Cutter = vtkSmartPointer<vtkMitkIndexedPlaneCutter>::New();
+  m_Cutter->SetInputConnection(m_TransformFilter->GetOutputPort());
   m_Mapper->SetInputConnection(m_Cutter->GetOutputPort());
 
   m_NormalGlyph = vtkSmartPointer<vtkGlyph3D>::New();
@@ -165,6 +165,9 @@ void mitk::SurfaceVtkMapper2D::Update(mitk::BaseRenderer *renderer)
       ||
       (localStorage->m_LastUpdateTime < node->GetPropertyList(renderer)->GetMTime()))
   {
+    MITK_TRACE_NAMED_SCOPE(traceScope, "Mapper", this->GetNameOfClass());
+    MITK_TRACE_SET_NODE_NAME(traceScope, node->GetName());
+    MITK_TRACE_SET_DATA_SIZE(traceScope, Tracer::GetDataSize(surface));
     this->GenerateDataForRenderer(renderer);
   }
 
@@ -212,15 +215,15 @@ void mitk::SurfaceVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rende
   normal[1] = planeGeometry->GetNormal()[1];
   normal[2] = planeGeometry->GetNormal()[2];
 
-  localStorage->m_CuttingPlane->SetOrigin(origin);
-  localStorage->m_CuttingPlane->SetNormal(normal);
+  localStorage->m_Cutter->SetOrigin(origin);
+  localStorage->m_Cutter->SetNormal(normal);
   // Transform the data according to its geometry.
   // See UpdateVtkTransform documentation for details.
+  // The filter only executes again if the surface or its transform was modified,
+  // this keeps the cell index of the cutter valid while scrolling.
   vtkSmartPointer<vtkLinearTransform> vtktransform = GetDataNode()->GetVtkTransform(this->GetTimestep());
-  vtkSmartPointer<vtkTransformPolyDataFilter> filter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-  filter->SetTransform(vtktransform);
-  filter->SetInputData(inputPolyData);
-  localStorage->m_Cutter->SetInputConnection(filter->GetOutputPort());
+  localStorage->m_TransformFilter->SetTransform(vtktransform);
+  localStorage->m_TransformFilter->SetInputData(inputPolyData);
   localStorage->m_Cutter->Update();
 
   bool generateNormals = false;
@@ -78,7 +78,16 @@ void mitk::SurfaceVtkMapper3D::GenerateDataForRenderer(mitk::BaseRenderer *rende
     ls->m_Actor->VisibilityOff();
     return;
   }
-  if (m_GenerateNormals)
+  if (m_GenerateNormals && input->HasSharedTopology())
+  {
+    ls->m_SharedTopologyNormals->SetInputData(polydata);
+    ls->m_SharedTopologyNormals->Update();
+    ls->m_SharedTopologyFrame->ShallowCopy(polydata);
+    ls->m_SharedTopologyFrame->GetPointData()->SetNormals(
+      ls->m_SharedTopologyNormals->GetOutput()->GetPointData()->GetNormals());
+    ls->m_VtkPolyDataMapper->SetInputData(ls->m_SharedTopologyFrame);
+  }
+  else if (m_GenerateNormals)
   {
     ls->m_VtkPolyDataNormals->SetInputData(polydata);
     ls->m_VtkPolyDataMapper->SetInputConnection(ls->m_VtkPolyDataNormals->GetOutputPort());
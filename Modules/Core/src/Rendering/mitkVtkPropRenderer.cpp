@@ -35,10 +35,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkVtkInteractorStyle.h>
 
 // VTK
+#include <vtkActor.h>
 #include <vtkAssemblyNode.h>
 #include <vtkAssemblyPath.h>
 #include <vtkCamera.h>
+#include <vtkCellLocator.h>
 #include <vtkCellPicker.h>
+#include <vtkDataSet.h>
+#include <vtkHardwareSelector.h>
 #include <vtkInteractorStyleTrackballCamera.h>
 #include <vtkLight.h>
 #include <vtkLightKit.h>
@@ -54,8 +58,50 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkTextActor.h>
 #include <vtkTextProperty.h>
 #include <vtkTransform.h>
+#include <vtkWeakPointer.h>
 #include <vtkWorldPointPicker.h>
 
+#include <algorithm>
+
+struct mitk::VtkPropRenderer::PickingCache
+{
+  struct Locator
+  {
+    vtkWeakPointer<vtkDataSet> DataSet;
+    vtkSmartPointer<vtkCellLocator> CellLocator;
+    vtkMTimeType BuildTime;
+  };
+  std::map<vtkDataSet *, Locator> Locators;
+
+  vtkSmartPointer<vtkHardwareSelector> Selector;
+  vtkSmartPointer<vtkRenderer> SelectionRenderer;
+  std::vector<vtkProp *> SelectionProps;
+  vtkMTimeType SelectionTime = 0;
+  int SelectionArea[4] = {0, 0, -1, -1};
+  bool BuffersValid = false;
+  bool HardwareSelectionFailed = false;
+};
+
+namespace
+{
+  // Meshes with fewer cells are intersected cell by cell, building a locator would not pay off
+  const vtkIdType MinimumNumberOfCellsForLocator = 1000;
+
+  // The actors of a prop, i.e. the prop itself or the parts of an assembly
+  std::vector<vtkActor *> GetActors(vtkProp *prop)
+  {
+    std::vector<vtkActor *> actors;
+    prop->InitPathTraversal();
+    while (vtkAssemblyPath *path = prop->GetNextPath())
+    {
+      auto *actor = vtkActor::SafeDownCast(path->GetLastNode()->GetViewProp());
+      if (actor != nullptr && actor->GetMapper() != nullptr)
+        actors.push_back(actor);
+    }
+    return actors;
+  }
+}
+
 mitk::VtkPropRenderer::VtkPropRenderer(const char *name,
                                        vtkRenderWindow *renWin,
                                        mitk::RenderingManager *rm,
@@ -72,6 +118,8 @@ mitk::VtkPropRenderer::VtkPropRenderer(const char *name,
   m_CellPicker = vtkCellPicker::New();
   m_CellPicker->SetTolerance(0.0025);
 
+  m_PickingCache.reset(new PickingCache);
+
   mitk::PlaneGeometryDataVtkMapper3D::Pointer geometryMapper = mitk::PlaneGeometryDataVtkMapper3D::New();
   m_CurrentWorldPlaneGeometryMapper = geometryMapper;
   m_CurrentWorldPlaneGeometryNode->SetMapper(2, geometryMapper);
@@ -405,6 +453,7 @@ void mitk::VtkPropRenderer::PickWorldPoint(const mitk::Point2D &displayPoint, mi
   switch (m_PickingMode)
   {
     case (WorldPointPicking):
+    case (HardwarePicking):
     {
       m_WorldPointPicker->Pick(displayPoint[0], displayPoint[1], 0, m_VtkRenderer);
       vtk2itk(m_WorldPointPicker->GetPickPosition(), worldPoint);
@@ -418,6 +467,7 @@ void mitk::VtkPropRenderer::PickWorldPoint(const mitk::Point2D &displayPoint, mi
     }
     case (CellPicking):
     {
+      this->UpdatePickLocators(this->GetPickableProps());
       m_CellPicker->Pick(displayPoint[0], displayPoint[1], 0, m_VtkRenderer);
       vtk2itk(m_CellPicker->GetPickPosition(), worldPoint);
       break;
@@ -427,9 +477,11 @@ void mitk::VtkPropRenderer::PickWorldPoint(const mitk::Point2D &displayPoint, mi
   //    Superclass::PickWorldPoint(displayPoint, worldPoint);
 }
 
-mitk::DataNode *mitk::VtkPropRenderer::PickObject(const Point2D &displayPosition, Point3D &worldPosition) const
+mitk::VtkPropRenderer::PickablePropsType mitk::VtkPropRenderer::GetPickableProps() const
 {
-  m_CellPicker->InitializePickList();
+  PickablePropsType props;
+  if (m_DataStorage.IsNull())
+    return props;
 
   // Iterate over all DataStorage objects to determine all vtkProps intended
   // for picking
@@ -453,9 +505,179 @@ mitk::DataNode *mitk::VtkPropRenderer::PickObject(const Point2D &displayPosition
     if (prop == nullptr)
       continue;
 
-    m_CellPicker->AddPickList(prop);
+    props.push_back(std::make_pair(node, prop));
+  }
+  return props;
+}
+
+void mitk::VtkPropRenderer::UpdatePickLocators(const PickablePropsType &props) const
+{
+  // Locators of meshes that are no longer pickable are dropped
+  std::map<vtkDataSet *, PickingCache::Locator> locators;
+  m_CellPicker->RemoveAllLocators();
+
+  for (const auto &nodeAndProp : props)
+  {
+    for (vtkActor *actor : GetActors(nodeAndProp.second))
+    {
+      vtkDataSet *dataSet = actor->GetMapper()->GetInput();
+      if (dataSet == nullptr || dataSet->GetNumberOfCells() < MinimumNumberOfCellsForLocator ||
+          locators.count(dataSet) != 0)
+        continue;
+
+      PickingCache::Locator locator;
+      auto cached = m_PickingCache->Locators.find(dataSet);
+      if (cached != m_PickingCache->Locators.end())
+        locator = cached->second;
+
+      // the address of a deleted data set can be reused, hence the weak pointer
+      if (locator.CellLocator == nullptr || locator.DataSet != dataSet || locator.BuildTime < dataSet->GetMTime())
+      {
+        locator.DataSet = dataSet;
+        locator.CellLocator = vtkSmartPointer<vtkCellLocator>::New();
+        locator.CellLocator->SetDataSet(dataSet);
+        locator.CellLocator->BuildLocator();
+        locator.BuildTime = dataSet->GetMTime();
+      }
+
+      m_CellPicker->AddLocator(locator.CellLocator);
+      locators[dataSet] = locator;
+    }
+  }
+  m_PickingCache->Locators.swap(locators);
+}
+
+bool mitk::VtkPropRenderer::PickPropFromSelectionBuffers(const PickablePropsType &props,
+                                                         const Point2D &displayPosition,
+                                                         vtkProp *&pickedProp) const
+{
+  pickedProp = nullptr;
+
+  PickingCache &cache = *m_PickingCache;
+  vtkRenderWindow *renderWindow = this->GetRenderWindow();
+  if (cache.HardwareSelectionFailed || renderWindow == nullptr || renderWindow->GetNeverRendered() != 0)
+    return false;
+
+  std::vector<vtkProp *> selectionProps;
+  vtkMTimeType selectionTime = m_VtkRenderer->GetActiveCamera()->GetMTime();
+  for (const auto &nodeAndProp : props)
+  {
+    selectionProps.push_back(nodeAndProp.second);
+    selectionTime = std::max(selectionTime, nodeAndProp.second->GetRedrawMTime());
+    for (vtkActor *actor : GetActors(nodeAndProp.second))
+    {
+      selectionTime = std::max(selectionTime, actor->GetRedrawMTime());
+      if (vtkDataSet *dataSet = actor->GetMapper()->GetInput())
+        selectionTime = std::max(selectionTime, dataSet->GetMTime());
+    }
+  }
+
+  const int *origin = m_VtkRenderer->GetOrigin();
+  const int *size = m_VtkRenderer->GetSize();
+  const int area[4] = {origin[0], origin[1], origin[0] + size[0] - 1, origin[1] + size[1] - 1};
+
+  if (!cache.BuffersValid || selectionTime != cache.SelectionTime || selectionProps != cache.SelectionProps ||
+      !std::equal(area, area + 4, cache.SelectionArea))
+  {
+    cache.BuffersValid = false;
+    if (selectionProps.empty() || size[0] <= 0 || size[1] <= 0)
+      return true;
+
+    // All MITK data is rendered through a single vtkMitkRenderProp, which the selector cannot tell apart.
+    // The pickable props are therefore rendered on their own by a renderer that shares camera and viewport.
+    if (cache.Selector == nullptr)
+    {
+      cache.Selector = vtkSmartPointer<vtkHardwareSelector>::New();
+      cache.Selector->SetFieldAssociation(vtkDataObject::FIELD_ASSOCIATION_CELLS);
+      cache.SelectionRenderer = vtkSmartPointer<vtkRenderer>::New();
+      cache.SelectionRenderer->SetInteractive(0);
+    }
+    vtkRenderer *selectionRenderer = cache.SelectionRenderer;
+    selectionRenderer->RemoveAllViewProps();
+    for (vtkProp *prop : selectionProps)
+      selectionRenderer->AddViewProp(prop);
+    selectionRenderer->SetActiveCamera(m_VtkRenderer->GetActiveCamera());
+    selectionRenderer->SetViewport(m_VtkRenderer->GetViewport());
+    selectionRenderer->SetLayer(m_VtkRenderer->GetLayer());
+
+    // only the selection renderer may draw into the ID buffer
+    std::vector<std::pair<vtkRenderer *, int>> drawStates;
+    vtkRendererCollection *renderers = renderWindow->GetRenderers();
+    renderers->InitTraversal();
+    while (vtkRenderer *renderer = renderers->GetNextItem())
+    {
+      drawStates.push_back(std::make_pair(renderer, renderer->GetDraw()));
+      renderer->DrawOff();
+    }
+    renderWindow->AddRenderer(selectionRenderer);
+
+    cache.Selector->SetRenderer(selectionRenderer);
+    cache.Selector->SetArea(area[0], area[1], area[2], area[3]);
+    const bool captured = cache.Selector->CaptureBuffers();
+
+    renderWindow->RemoveRenderer(selectionRenderer);
+    for (const auto &drawState : drawStates)
+      drawState.first->SetDraw(drawState.second);
+
+    if (!captured)
+    {
+      MITK_WARN << "Hardware selection is not available for render window " << this->GetName()
+                << ", falling back to cell picking.";
+      cache.HardwareSelectionFailed = true;
+      cache.SelectionRenderer->RemoveAllViewProps();
+      return false;
+    }
+
+    cache.SelectionProps = selectionProps;
+    cache.SelectionTime = selectionTime;
+    std::copy(area, area + 4, cache.SelectionArea);
+    cache.BuffersValid = true;
   }
 
+  if (displayPosition[0] < area[0] || displayPosition[0] > area[2] || displayPosition[1] < area[1] ||
+      displayPosition[1] > area[3])
+    return true;
+
+  unsigned int position[2] = {static_cast<unsigned int>(displayPosition[0]),
+                              static_cast<unsigned int>(displayPosition[1])};
+  unsigned int selectedPosition[2];
+  vtkHardwareSelector::PixelInformation info = cache.Selector->GetPixelInformation(position, 0, selectedPosition);
+  if (info.Valid)
+    pickedProp = info.Prop;
+  return true;
+}
+
+mitk::DataNode *mitk::VtkPropRenderer::PickObject(const Point2D &displayPosition, Point3D &worldPosition) const
+{
+  PickablePropsType props = this->GetPickableProps();
+
+  if (m_PickingMode == HardwarePicking)
+  {
+    vtkProp *pickedProp = nullptr;
+    if (this->PickPropFromSelectionBuffers(props, displayPosition, pickedProp))
+    {
+      if (pickedProp == nullptr)
+      {
+        worldPosition.Fill(0.0);
+        return nullptr;
+      }
+
+      // the exact position is picked on the mesh of the selected prop only
+      props.erase(std::remove_if(props.begin(),
+                                 props.end(),
+                                 [pickedProp](const PickablePropsType::value_type &nodeAndProp) {
+                                   return nodeAndProp.second != pickedProp;
+                                 }),
+                  props.end());
+    }
+  }
+
+  this->UpdatePickLocators(props);
+
+  m_CellPicker->InitializePickList();
+  for (const auto &nodeAndProp : props)
+    m_CellPicker->AddPickList(nodeAndProp.second);
+
   // Do the picking and retrieve the picked vtkProp (if any)
   m_CellPicker->PickFromListOn();
   m_CellPicker->Pick(displayPosition[0], displayPosition[1], 0.0, m_VtkRenderer);
@@ -471,6 +693,7 @@ mitk::DataNode *mitk::VtkPropRenderer::PickObject(const Point2D &displayPosition
 
   // Iterate over all DataStorage objects to determine if the retrieved
   // vtkProp is owned by any associated mapper.
+  DataStorage::SetOfObjects::ConstPointer allObjects = m_DataStorage->GetAll();
   for (DataStorage::SetOfObjects::ConstIterator it = allObjects->Begin(); it != allObjects->End(); ++it)
   {
     DataNode::Pointer node = it->Value();
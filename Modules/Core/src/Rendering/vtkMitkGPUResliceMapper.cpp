@@ -0,0 +1,533 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#include "vtkMitkGPUResliceMapper.h"
+
+#include <vtkActor.h>
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkObjectFactory.h>
+#include <vtkOpenGLHelper.h>
+#include <vtkOpenGLRenderWindow.h>
+#include <vtkPointData.h>
+#include <vtkProperty.h>
+#include <vtkRenderer.h>
+#include <vtkScalarsToColors.h>
+#include <vtkShaderProgram.h>
+#include <vtkTextureObject.h>
+#include <vtk_glew.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+  /** Number of entries the color table is sampled with */
+  const int ColorTableSize = 1024;
+
+  template <typename TIn, typename TOut>
+  void vtkMitkGPUResliceMapperCopyBrick(
+    const TIn *volume, const int dimensions[3], const int begin[3], const int end[3], TOut *brick)
+  {
+    const vtkIdType sliceSize = static_cast<vtkIdType>(dimensions[0]) * dimensions[1];
+    for (int z = begin[2]; z < end[2]; ++z)
+    {
+      for (int y = begin[1]; y < end[1]; ++y)
+      {
+        const TIn *row = volume + z * sliceSize + static_cast<vtkIdType>(y) * dimensions[0];
+        for (int x = begin[0]; x < end[0]; ++x)
+        {
+          *brick++ = static_cast<TOut>(row[x]);
+        }
+      }
+    }
+  }
+
+  template <typename TOut>
+  void vtkMitkGPUResliceMapperCopyBrick(vtkImageData *volume, const int begin[3], const int end[3], TOut *brick)
+  {
+    void *scalars = volume->GetScalarPointer();
+    int *dimensions = volume->GetDimensions();
+    switch (volume->GetScalarType())
+    {
+      vtkTemplateMacro(vtkMitkGPUResliceMapperCopyBrick(
+        static_cast<const VTK_TT *>(scalars), dimensions, begin, end, brick));
+    }
+  }
+}
+
+vtkStandardNewMacro(vtkMitkGPUResliceMapper);
+
+vtkMitkGPUResliceMapper::vtkMitkGPUResliceMapper()
+  : VolumeUploadTime(0),
+    ScalarScale(1.0),
+    CurrentBrick(nullptr),
+    ColorUploadTime(0),
+    ModelToIndex(vtkSmartPointer<vtkMatrix4x4>::New()),
+    ThickSliceMode(MIP),
+    NumberOfThickSlices(0),
+    Interpolate(false),
+    MaximumBrickSize(0)
+{
+  this->ColorRange[0] = 0.0;
+  this->ColorRange[1] = 1.0;
+  this->ThickSliceStep[0] = this->ThickSliceStep[1] = this->ThickSliceStep[2] = 0.0;
+
+  this->SetVertexShaderCode("//VTK::System::Dec\n"
+                            "attribute vec4 vertexMC;\n"
+                            "uniform mat4 MCDCMatrix;\n"
+                            "uniform mat4 modelToTexture;\n"
+
+                            "varying vec3 textureCoordinate;\n"
+
+                            "void main(void)\n"
+                            "{\n"
+                            "  textureCoordinate = (modelToTexture * vertexMC).xyz;\n"
+                            "  gl_Position = MCDCMatrix * vertexMC;\n"
+                            "}\n");
+
+  // the thick slice modes are evaluated exactly like in vtkMitkThickSlicesFilter
+  this->SetFragmentShaderCode("//VTK::System::Dec\n" // always start with this line
+                              "//VTK::Output::Dec\n" // always have this line in your FS
+                              "uniform sampler3D volumeTexture;\n"
+                              "uniform sampler2D colorTexture;\n"
+                              "uniform vec3 coreMin;\n"
+                              "uniform vec3 coreMax;\n"
+                              "uniform vec3 thickSliceStep;\n"
+                              "uniform int numberOfThickSlices;\n"
+                              "uniform int thickSliceMode;\n"
+                              "uniform float scalarScale;\n"
+                              "uniform vec2 colorRange;\n"
+                              "uniform vec3 actorColor;\n"
+                              "uniform float opacity;\n"
+
+                              "varying vec3 textureCoordinate;\n"
+                              "out vec4 out_Color;\n"
+
+                              "float sampleVolume(vec3 position)\n"
+                              "{\n"
+                              "  return texture3D(volumeTexture, position).r * scalarScale;\n"
+                              "}\n"
+
+                              "void main(void)\n"
+                              "{\n"
+                              // every brick only draws its own voxels, the overlap is for interpolation
+                              "  if (any(lessThan(textureCoordinate, coreMin)) ||\n"
+                              "      any(greaterThanEqual(textureCoordinate, coreMax)))\n"
+                              "    discard;\n"
+
+                              "  float value = 0.0;\n"
+                              "  if (numberOfThickSlices == 0)\n"
+                              "  {\n"
+                              "    value = sampleVolume(textureCoordinate);\n"
+                              "  }\n"
+                              "  else\n"
+                              "  {\n"
+                              "    float n = float(numberOfThickSlices);\n"
+                              "    float sigmaSq = (2.0 * n) / 6.0;\n"
+                              "    sigmaSq *= sigmaSq;\n"
+                              "    float first = sampleVolume(textureCoordinate - n * thickSliceStep);\n"
+                              "    float extremum = first;\n"
+                              "    float sum = first;\n"
+                              "    float weightedSum = 0.0;\n"
+                              "    float weightSum = 0.0;\n"
+                              "    for (int z = 1 - numberOfThickSlices; z <= numberOfThickSlices; ++z)\n"
+                              "    {\n"
+                              "      float sampled = sampleVolume(textureCoordinate + float(z) * thickSliceStep);\n"
+                              "      extremum = (thickSliceMode == 3) ? min(extremum, sampled) : max(extremum, sampled);\n"
+                              "      sum += sampled;\n"
+                              "      float weight = exp(-float(z) / sigmaSq);\n"
+                              "      weightedSum += weight * sampled;\n"
+                              "      weightSum += weight;\n"
+                              "    }\n"
+                              "    if (thickSliceMode == 1)\n" // SUM
+                              "      value = sum / (2.0 * n + 1.0);\n"
+                              "    else if (thickSliceMode == 2)\n" // WEIGHTED
+                              "      value = weightedSum / weightSum;\n"
+                              "    else if (thickSliceMode == 4)\n" // MEAN
+                              "      value = sum / (2.0 * n);\n"
+                              "    else\n" // MIP, MINIP
+                              "      value = extremum;\n"
+                              "  }\n"
+
+                              "  float range = max(colorRange.y - colorRange.x, 1e-20);\n"
+                              "  float position = clamp((value - colorRange.x) / range, 0.0, 1.0);\n"
+                              "  vec4 color = texture2D(colorTexture, vec2(position, 0.5));\n"
+                              "  out_Color = vec4(color.rgb * actorColor, color.a * opacity);\n"
+                              "}\n");
+}
+
+vtkMitkGPUResliceMapper::~vtkMitkGPUResliceMapper()
+{
+}
+
+void vtkMitkGPUResliceMapper::SetVolume(vtkImageData *volume)
+{
+  // the volume is uploaded again on the next render, even if the pointer did not change
+  this->Volume = volume;
+  this->VolumeUploadTime = 0;
+  this->Modified();
+}
+
+vtkImageData *vtkMitkGPUResliceMapper::GetVolume()
+{
+  return this->Volume;
+}
+
+void vtkMitkGPUResliceMapper::SetModelToIndexMatrix(vtkMatrix4x4 *matrix)
+{
+  this->ModelToIndex->DeepCopy(matrix);
+  this->Modified();
+}
+
+void vtkMitkGPUResliceMapper::SetThickSlices(int mode, int numberOfSlices, const double indexStep[3])
+{
+  this->ThickSliceMode = mode;
+  this->NumberOfThickSlices = std::max(0, numberOfSlices);
+  std::copy(indexStep, indexStep + 3, this->ThickSliceStep);
+  this->Modified();
+}
+
+void vtkMitkGPUResliceMapper::SetColorTable(vtkScalarsToColors *colorTable)
+{
+  if (this->ColorTable == colorTable)
+    return;
+
+  this->ColorTable = colorTable;
+  this->ColorUploadTime = 0;
+  this->Modified();
+}
+
+void vtkMitkGPUResliceMapper::UpdateVolumeTextures(vtkOpenGLRenderWindow *renderWindow)
+{
+  if (this->VolumeUploadTime != 0 && this->VolumeUploadTime == this->Volume->GetMTime())
+    return;
+
+  for (Brick &brick : this->Bricks)
+    brick.Texture->ReleaseGraphicsResources(renderWindow);
+  this->Bricks.clear();
+
+  if (this->Volume->GetNumberOfScalarComponents() != 1 || this->Volume->GetPointData()->GetScalars() == nullptr)
+  {
+    vtkErrorMacro(<< "Only volumes with single component scalars can be resliced on the GPU.");
+    this->VolumeUploadTime = this->Volume->GetMTime();
+    return;
+  }
+
+  // normalized integer textures keep the memory footprint of the volume, everything else becomes float
+  int dataType = VTK_FLOAT;
+  unsigned int internalFormat = GL_R32F;
+  this->ScalarScale = 1.0;
+  switch (this->Volume->GetScalarType())
+  {
+    case VTK_UNSIGNED_CHAR:
+      dataType = VTK_UNSIGNED_CHAR;
+      internalFormat = GL_R8;
+      this->ScalarScale = 255.0;
+      break;
+    case VTK_SIGNED_CHAR:
+      dataType = VTK_SIGNED_CHAR;
+      internalFormat = GL_R8_SNORM;
+      this->ScalarScale = 127.0;
+      break;
+    case VTK_UNSIGNED_SHORT:
+      dataType = VTK_UNSIGNED_SHORT;
+      internalFormat = GL_R16;
+      this->ScalarScale = 65535.0;
+      break;
+    case VTK_SHORT:
+      dataType = VTK_SHORT;
+      internalFormat = GL_R16_SNORM;
+      this->ScalarScale = 32767.0;
+      break;
+    default:
+      break;
+  }
+
+  GLint maximumTextureSize = 0;
+  glGetIntegerv(GL_MAX_3D_TEXTURE_SIZE, &maximumTextureSize);
+  if (this->MaximumBrickSize > 0)
+    maximumTextureSize = std::min<GLint>(maximumTextureSize, this->MaximumBrickSize);
+  // bricks need room for their core and the overlap on both sides
+  maximumTextureSize = std::max<GLint>(maximumTextureSize, 4);
+
+  // split every axis into cores, a single core does not need an overlap
+  const int *dimensions = this->Volume->GetDimensions();
+  std::vector<std::pair<int, int>> cores[3];
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    const int coreSize = dimensions[axis] <= maximumTextureSize ? dimensions[axis] : maximumTextureSize - 2;
+    for (int begin = 0; begin < dimensions[axis]; begin += coreSize)
+      cores[axis].emplace_back(begin, std::min(dimensions[axis], begin + coreSize));
+  }
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+  std::vector<unsigned char> buffer;
+  bool uploaded = true;
+  for (auto coreZ = cores[2].begin(); uploaded && coreZ != cores[2].end(); ++coreZ)
+  {
+    for (auto coreY = cores[1].begin(); uploaded && coreY != cores[1].end(); ++coreY)
+    {
+      for (auto coreX = cores[0].begin(); uploaded && coreX != cores[0].end(); ++coreX)
+      {
+        Brick brick;
+        brick.CoreBegin[0] = coreX->first;
+        brick.CoreBegin[1] = coreY->first;
+        brick.CoreBegin[2] = coreZ->first;
+        brick.CoreEnd[0] = coreX->second;
+        brick.CoreEnd[1] = coreY->second;
+        brick.CoreEnd[2] = coreZ->second;
+
+        vtkIdType numberOfVoxels = 1;
+        int size[3];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+          brick.TextureBegin[axis] = std::max(0, brick.CoreBegin[axis] - 1);
+          brick.TextureEnd[axis] = std::min(dimensions[axis], brick.CoreEnd[axis] + 1);
+          size[axis] = brick.TextureEnd[axis] - brick.TextureBegin[axis];
+          numberOfVoxels *= size[axis];
+        }
+
+        buffer.resize(numberOfVoxels * vtkDataArray::GetDataTypeSize(dataType));
+        switch (dataType)
+        {
+          case VTK_UNSIGNED_CHAR:
+            vtkMitkGPUResliceMapperCopyBrick(
+              this->Volume, brick.TextureBegin, brick.TextureEnd, reinterpret_cast<unsigned char *>(buffer.data()));
+            break;
+          case VTK_SIGNED_CHAR:
+            vtkMitkGPUResliceMapperCopyBrick(
+              this->Volume, brick.TextureBegin, brick.TextureEnd, reinterpret_cast<signed char *>(buffer.data()));
+            break;
+          case VTK_UNSIGNED_SHORT:
+            vtkMitkGPUResliceMapperCopyBrick(
+              this->Volume, brick.TextureBegin, brick.TextureEnd, reinterpret_cast<unsigned short *>(buffer.data()));
+            break;
+          case VTK_SHORT:
+            vtkMitkGPUResliceMapperCopyBrick(
+              this->Volume, brick.TextureBegin, brick.TextureEnd, reinterpret_cast<short *>(buffer.data()));
+            break;
+          default:
+            vtkMitkGPUResliceMapperCopyBrick(
+              this->Volume, brick.TextureBegin, brick.TextureEnd, reinterpret_cast<float *>(buffer.data()));
+            break;
+        }
+
+        brick.Texture = vtkSmartPointer<vtkTextureObject>::New();
+        brick.Texture->SetContext(renderWindow);
+        brick.Texture->SetInternalFormat(internalFormat);
+        brick.Texture->SetWrapS(vtkTextureObject::ClampToEdge);
+        brick.Texture->SetWrapT(vtkTextureObject::ClampToEdge);
+        brick.Texture->SetWrapR(vtkTextureObject::ClampToEdge);
+        uploaded = brick.Texture->Create3DFromRaw(size[0], size[1], size[2], 1, dataType, buffer.data());
+        if (uploaded)
+        {
+          this->Bricks.push_back(brick);
+        }
+        else
+        {
+          vtkErrorMacro(<< "Could not upload a brick of " << size[0] << "x" << size[1] << "x" << size[2]
+                        << " voxels.");
+          for (Brick &uploadedBrick : this->Bricks)
+            uploadedBrick.Texture->ReleaseGraphicsResources(renderWindow);
+          this->Bricks.clear();
+        }
+      }
+    }
+  }
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+  // a failed upload is not repeated before the volume changes
+  this->VolumeUploadTime = this->Volume->GetMTime();
+}
+
+void vtkMitkGPUResliceMapper::UpdateColorTexture(vtkOpenGLRenderWindow *renderWindow)
+{
+  if (this->ColorTexture != nullptr && this->ColorUploadTime == this->ColorTable->GetMTime())
+    return;
+
+  const double *range = this->ColorTable->GetRange();
+  this->ColorRange[0] = range[0];
+  this->ColorRange[1] = range[1];
+
+  // every entry holds the color of the center of its interval
+  std::vector<unsigned char> table(4 * ColorTableSize);
+  const double step = (range[1] - range[0]) / ColorTableSize;
+  for (int i = 0; i < ColorTableSize; ++i)
+  {
+    const unsigned char *rgba = this->ColorTable->MapValue(range[0] + (i + 0.5) * step);
+    std::copy(rgba, rgba + 4, table.begin() + 4 * i);
+  }
+
+  if (this->ColorTexture == nullptr)
+  {
+    this->ColorTexture = vtkSmartPointer<vtkTextureObject>::New();
+    this->ColorTexture->SetContext(renderWindow);
+    this->ColorTexture->SetWrapS(vtkTextureObject::ClampToEdge);
+    this->ColorTexture->SetWrapT(vtkTextureObject::ClampToEdge);
+    this->ColorTexture->SetMinificationFilter(vtkTextureObject::Nearest);
+    this->ColorTexture->SetMagnificationFilter(vtkTextureObject::Nearest);
+  }
+  this->ColorTexture->Create2DFromRaw(ColorTableSize, 1, 4, VTK_UNSIGNED_CHAR, table.data());
+
+  this->ColorUploadTime = this->ColorTable->GetMTime();
+}
+
+bool vtkMitkGPUResliceMapper::BrickIntersectsSlab(const Brick &brick) const
+{
+  // the slice is the plane spanned by the first two columns of the model to index matrix
+  double origin[3], u[3], v[3], normal[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    u[i] = this->ModelToIndex->GetElement(i, 0);
+    v[i] = this->ModelToIndex->GetElement(i, 1);
+    origin[i] = this->ModelToIndex->GetElement(i, 3);
+  }
+  normal[0] = u[1] * v[2] - u[2] * v[1];
+  normal[1] = u[2] * v[0] - u[0] * v[2];
+  normal[2] = u[0] * v[1] - u[1] * v[0];
+  const double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+  if (length == 0.0)
+    return true;
+
+  double slabHalfThickness = 0.0;
+  for (int i = 0; i < 3; ++i)
+  {
+    normal[i] /= length;
+    slabHalfThickness += normal[i] * this->ThickSliceStep[i];
+  }
+  // one voxel of margin for the interpolation
+  slabHalfThickness = std::abs(slabHalfThickness) * this->NumberOfThickSlices + 1.0;
+
+  double minimumDistance = 0.0, maximumDistance = 0.0;
+  for (int corner = 0; corner < 8; ++corner)
+  {
+    double distance = 0.0;
+    for (int i = 0; i < 3; ++i)
+    {
+      const double position = ((corner >> i) & 1) ? brick.CoreEnd[i] - 0.5 : brick.CoreBegin[i] - 0.5;
+      distance += normal[i] * (position - origin[i]);
+    }
+    if (corner == 0)
+    {
+      minimumDistance = maximumDistance = distance;
+    }
+    else
+    {
+      minimumDistance = std::min(minimumDistance, distance);
+      maximumDistance = std::max(maximumDistance, distance);
+    }
+  }
+
+  return minimumDistance <= slabHalfThickness && maximumDistance >= -slabHalfThickness;
+}
+
+void vtkMitkGPUResliceMapper::RenderPiece(vtkRenderer *ren, vtkActor *act)
+{
+  auto *renderWindow = vtkOpenGLRenderWindow::SafeDownCast(ren->GetRenderWindow());
+  if (renderWindow == nullptr || this->Volume == nullptr || this->ColorTable == nullptr)
+    return;
+
+  this->UpdateVolumeTextures(renderWindow);
+  this->UpdateColorTexture(renderWindow);
+  if (this->Bricks.empty())
+    return;
+
+  const int filter = this->Interpolate ? vtkTextureObject::Linear : vtkTextureObject::Nearest;
+
+  this->ColorTexture->Activate();
+  for (const Brick &brick : this->Bricks)
+  {
+    if (!this->BrickIntersectsSlab(brick))
+      continue;
+
+    brick.Texture->SetMinificationFilter(filter);
+    brick.Texture->SetMagnificationFilter(filter);
+    brick.Texture->Activate();
+
+    // the uniforms of the current brick are set in SetMapperShaderParameters
+    this->CurrentBrick = &brick;
+    this->Superclass::RenderPiece(ren, act);
+
+    brick.Texture->Deactivate();
+  }
+  this->CurrentBrick = nullptr;
+  this->ColorTexture->Deactivate();
+}
+
+void vtkMitkGPUResliceMapper::SetMapperShaderParameters(vtkOpenGLHelper &cellBO, vtkRenderer *ren, vtkActor *act)
+{
+  this->Superclass::SetMapperShaderParameters(cellBO, ren, act);
+
+  if (this->CurrentBrick == nullptr)
+    return;
+
+  const Brick &brick = *this->CurrentBrick;
+  vtkShaderProgram *program = cellBO.Program;
+
+  // texel centers are at (i + 0.5) / size, voxel centers at integer indices
+  auto modelToTexture = vtkSmartPointer<vtkMatrix4x4>::New();
+  float coreMin[3], coreMax[3], thickSliceStep[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    const double size = brick.TextureEnd[i] - brick.TextureBegin[i];
+    for (int j = 0; j < 4; ++j)
+      modelToTexture->SetElement(i, j, this->ModelToIndex->GetElement(i, j) / size);
+    modelToTexture->SetElement(i, 3, modelToTexture->GetElement(i, 3) + (0.5 - brick.TextureBegin[i]) / size);
+
+    coreMin[i] = static_cast<float>((brick.CoreBegin[i] - brick.TextureBegin[i]) / size);
+    coreMax[i] = static_cast<float>((brick.CoreEnd[i] - brick.TextureBegin[i]) / size);
+    thickSliceStep[i] = static_cast<float>(this->ThickSliceStep[i] / size);
+  }
+  // shader programs expect column major matrices
+  modelToTexture->Transpose();
+
+  const float colorRange[2] = {static_cast<float>(this->ColorRange[0]), static_cast<float>(this->ColorRange[1])};
+  const double *color = act->GetProperty()->GetColor();
+  const float actorColor[3] = {
+    static_cast<float>(color[0]), static_cast<float>(color[1]), static_cast<float>(color[2])};
+
+  program->SetUniformMatrix("modelToTexture", modelToTexture);
+  program->SetUniformi("volumeTexture", brick.Texture->GetTextureUnit());
+  program->SetUniformi("colorTexture", this->ColorTexture->GetTextureUnit());
+  program->SetUniform3f("coreMin", coreMin);
+  program->SetUniform3f("coreMax", coreMax);
+  program->SetUniform3f("thickSliceStep", thickSliceStep);
+  program->SetUniformi("numberOfThickSlices", this->NumberOfThickSlices);
+  program->SetUniformi("thickSliceMode", this->ThickSliceMode);
+  program->SetUniformf("scalarScale", static_cast<float>(this->ScalarScale));
+  program->SetUniform2f("colorRange", colorRange);
+  program->SetUniform3f("actorColor", actorColor);
+  program->SetUniformf("opacity", static_cast<float>(act->GetProperty()->GetOpacity()));
+}
+
+void vtkMitkGPUResliceMapper::ReleaseGraphicsResources(vtkWindow *window)
+{
+  for (Brick &brick : this->Bricks)
+    brick.Texture->ReleaseGraphicsResources(window);
+  this->Bricks.clear();
+  this->VolumeUploadTime = 0;
+
+  if (this->ColorTexture != nullptr)
+    this->ColorTexture->ReleaseGraphicsResources(window);
+  this->ColorTexture = nullptr;
+
+  this->Superclass::ReleaseGraphicsResources(window);
+}
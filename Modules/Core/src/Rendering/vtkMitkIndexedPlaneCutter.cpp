@@ -0,0 +1,327 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "vtkMitkIndexedPlaneCutter.h"
+
+#include "vtkCellData.h"
+#include "vtkCutter.h"
+#include "vtkIdList.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkMath.h"
+#include "vtkObjectFactory.h"
+#include "vtkPlane.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+vtkStandardNewMacro(vtkMitkIndexedPlaneCutter);
+
+namespace
+{
+  // cells per bucket on average for a mesh whose cells do not overlap much along the normal
+  const vtkIdType CellsPerBucket = 8;
+  const vtkIdType MaximumNumberOfBuckets = 1 << 16;
+}
+
+//----------------------------------------------------------------------------
+vtkMitkIndexedPlaneCutter::vtkMitkIndexedPlaneCutter()
+{
+  this->Origin[0] = this->Origin[1] = this->Origin[2] = 0.0;
+  this->Normal[0] = this->Normal[1] = 0.0;
+  this->Normal[2] = 1.0;
+  this->CacheSize = 16;
+
+  this->NumberOfIndexBuilds = 0;
+  this->NumberOfCacheHits = 0;
+  this->NumberOfCandidateCells = 0;
+
+  this->IndexNormal[0] = this->IndexNormal[1] = this->IndexNormal[2] = 0.0;
+  this->IndexInputMTime = 0;
+  this->IndexInput = nullptr;
+  this->IndexMinimum = 0.0;
+  this->IndexBucketWidth = 0.0;
+
+  this->Plane = vtkSmartPointer<vtkPlane>::New();
+  this->Cutter = vtkSmartPointer<vtkCutter>::New();
+  this->Cutter->SetCutFunction(this->Plane);
+}
+
+//----------------------------------------------------------------------------
+vtkMitkIndexedPlaneCutter::~vtkMitkIndexedPlaneCutter()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkMitkIndexedPlaneCutter::PrintSelf(ostream &os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Origin: (" << this->Origin[0] << ", " << this->Origin[1] << ", " << this->Origin[2] << ")\n";
+  os << indent << "Normal: (" << this->Normal[0] << ", " << this->Normal[1] << ", " << this->Normal[2] << ")\n";
+  os << indent << "CacheSize: " << this->CacheSize << "\n";
+  os << indent << "NumberOfIndexBuilds: " << this->NumberOfIndexBuilds << "\n";
+  os << indent << "NumberOfCacheHits: " << this->NumberOfCacheHits << "\n";
+  os << indent << "NumberOfCandidateCells: " << this->NumberOfCandidateCells << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkMitkIndexedPlaneCutter::SetCacheSize(int cacheSize)
+{
+  cacheSize = std::max(0, cacheSize);
+  if (cacheSize == this->CacheSize)
+    return;
+
+  this->CacheSize = cacheSize;
+  while (this->Cache.size() > static_cast<size_t>(this->CacheSize))
+    this->Cache.pop_back();
+
+  // the output does not change, so the filter is not marked as modified
+}
+
+//----------------------------------------------------------------------------
+void vtkMitkIndexedPlaneCutter::BuildIndex(vtkPolyData *input, const double normal[3])
+{
+  this->IndexNormal[0] = normal[0];
+  this->IndexNormal[1] = normal[1];
+  this->IndexNormal[2] = normal[2];
+  this->IndexInput = input;
+  this->IndexInputMTime = input->GetMTime();
+  this->Cache.clear();
+  ++this->NumberOfIndexBuilds;
+
+  const vtkIdType numberOfPoints = input->GetNumberOfPoints();
+  const vtkIdType numberOfCells = input->GetNumberOfCells();
+
+  // distance of every point along the normal
+  std::vector<double> pointDistances(numberOfPoints);
+  double point[3];
+  for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+  {
+    input->GetPoint(pointId, point);
+    pointDistances[pointId] = vtkMath::Dot(point, normal);
+  }
+
+  double minimum = std::numeric_limits<double>::max();
+  double maximum = -std::numeric_limits<double>::max();
+
+  this->CellRanges.assign(2 * numberOfCells, 0.0);
+  vtkSmartPointer<vtkIdList> cellPointIds = vtkSmartPointer<vtkIdList>::New();
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+  {
+    input->GetCellPoints(cellId, cellPointIds);
+
+    double cellMinimum = std::numeric_limits<double>::max();
+    double cellMaximum = -std::numeric_limits<double>::max();
+    for (vtkIdType i = 0; i < cellPointIds->GetNumberOfIds(); ++i)
+    {
+      const double distance = pointDistances[cellPointIds->GetId(i)];
+      cellMinimum = std::min(cellMinimum, distance);
+      cellMaximum = std::max(cellMaximum, distance);
+    }
+
+    this->CellRanges[2 * cellId] = cellMinimum;
+    this->CellRanges[2 * cellId + 1] = cellMaximum;
+
+    if (cellMinimum <= cellMaximum)
+    {
+      minimum = std::min(minimum, cellMinimum);
+      maximum = std::max(maximum, cellMaximum);
+    }
+  }
+
+  this->BucketOffsets.assign(1, 0);
+  this->BucketCells.clear();
+  if (minimum > maximum) // no cell with points
+    return;
+
+  const vtkIdType numberOfBuckets =
+    std::max<vtkIdType>(1, std::min(MaximumNumberOfBuckets, numberOfCells / CellsPerBucket));
+  this->IndexMinimum = minimum;
+  this->IndexBucketWidth = (maximum - minimum) / numberOfBuckets;
+
+  auto bucketOf = [&](double distance) -> vtkIdType {
+    if (this->IndexBucketWidth <= 0.0)
+      return 0;
+    auto bucket = static_cast<vtkIdType>(std::floor((distance - this->IndexMinimum) / this->IndexBucketWidth));
+    return std::max<vtkIdType>(0, std::min(numberOfBuckets - 1, bucket));
+  };
+
+  // a cell is listed in every bucket its range overlaps, count first to fill a single array
+  this->BucketOffsets.assign(numberOfBuckets + 1, 0);
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+  {
+    if (this->CellRanges[2 * cellId] > this->CellRanges[2 * cellId + 1])
+      continue;
+
+    const vtkIdType last = bucketOf(this->CellRanges[2 * cellId + 1]);
+    for (vtkIdType bucket = bucketOf(this->CellRanges[2 * cellId]); bucket <= last; ++bucket)
+      ++this->BucketOffsets[bucket + 1];
+  }
+
+  for (vtkIdType bucket = 0; bucket < numberOfBuckets; ++bucket)
+    this->BucketOffsets[bucket + 1] += this->BucketOffsets[bucket];
+
+  this->BucketCells.resize(this->BucketOffsets[numberOfBuckets]);
+  std::vector<vtkIdType> nextInBucket(this->BucketOffsets.begin(), this->BucketOffsets.end() - 1);
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+  {
+    if (this->CellRanges[2 * cellId] > this->CellRanges[2 * cellId + 1])
+      continue;
+
+    const vtkIdType last = bucketOf(this->CellRanges[2 * cellId + 1]);
+    for (vtkIdType bucket = bucketOf(this->CellRanges[2 * cellId]); bucket <= last; ++bucket)
+      this->BucketCells[nextInBucket[bucket]++] = cellId;
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkMitkIndexedPlaneCutter::CollectCandidateCells(double offset, std::vector<vtkIdType> &cellIds) const
+{
+  cellIds.clear();
+
+  const auto numberOfBuckets = static_cast<vtkIdType>(this->BucketOffsets.size()) - 1;
+  if (numberOfBuckets < 1)
+    return;
+
+  vtkIdType bucket = 0;
+  if (this->IndexBucketWidth > 0.0)
+  {
+    const double position = std::floor((offset - this->IndexMinimum) / this->IndexBucketWidth);
+    if (position < -1.0 || position > numberOfBuckets)
+      return; // the plane does not touch the input
+    bucket = std::max<vtkIdType>(0, std::min(numberOfBuckets - 1, static_cast<vtkIdType>(position)));
+  }
+
+  for (vtkIdType i = this->BucketOffsets[bucket]; i < this->BucketOffsets[bucket + 1]; ++i)
+  {
+    const vtkIdType cellId = this->BucketCells[i];
+    if (this->CellRanges[2 * cellId] <= offset && offset <= this->CellRanges[2 * cellId + 1])
+      cellIds.push_back(cellId);
+  }
+
+  // the buckets are filled in ascending order, keep it so that the subset has the cell order of the input
+}
+
+//----------------------------------------------------------------------------
+void vtkMitkIndexedPlaneCutter::Cut(vtkPolyData *input, const std::vector<vtkIdType> &cellIds, vtkPolyData *output)
+{
+  if (cellIds.empty())
+    return;
+
+  // copy the candidate cells with their points and attributes into a compact polydata
+  vtkSmartPointer<vtkPolyData> subset = vtkSmartPointer<vtkPolyData>::New();
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetDataType(input->GetPoints()->GetDataType());
+  subset->SetPoints(points);
+  subset->Allocate(static_cast<vtkIdType>(cellIds.size()));
+
+  vtkPointData *inputPointData = input->GetPointData();
+  vtkPointData *subsetPointData = subset->GetPointData();
+  subsetPointData->CopyAllocate(inputPointData);
+  vtkCellData *inputCellData = input->GetCellData();
+  vtkCellData *subsetCellData = subset->GetCellData();
+  subsetCellData->CopyAllocate(inputCellData, static_cast<vtkIdType>(cellIds.size()));
+
+  std::vector<vtkIdType> pointMap(input->GetNumberOfPoints(), -1);
+  vtkSmartPointer<vtkIdList> cellPointIds = vtkSmartPointer<vtkIdList>::New();
+  for (vtkIdType cellId : cellIds)
+  {
+    input->GetCellPoints(cellId, cellPointIds);
+    for (vtkIdType i = 0; i < cellPointIds->GetNumberOfIds(); ++i)
+    {
+      const vtkIdType pointId = cellPointIds->GetId(i);
+      if (pointMap[pointId] < 0)
+      {
+        pointMap[pointId] = points->InsertNextPoint(input->GetPoint(pointId));
+        subsetPointData->CopyData(inputPointData, pointId, pointMap[pointId]);
+      }
+      cellPointIds->SetId(i, pointMap[pointId]);
+    }
+
+    const vtkIdType subsetCellId = subset->InsertNextCell(input->GetCellType(cellId), cellPointIds);
+    subsetCellData->CopyData(inputCellData, cellId, subsetCellId);
+  }
+
+  this->Plane->SetOrigin(this->Origin);
+  this->Plane->SetNormal(this->IndexNormal);
+  this->Cutter->SetInputData(subset);
+  this->Cutter->Update();
+
+  output->DeepCopy(this->Cutter->GetOutput());
+  this->Cutter->SetInputData(nullptr);
+}
+
+//----------------------------------------------------------------------------
+int vtkMitkIndexedPlaneCutter::RequestData(vtkInformation *,
+                                            vtkInformationVector **inputVector,
+                                            vtkInformationVector *outputVector)
+{
+  vtkPolyData *input = vtkPolyData::GetData(inputVector[0]);
+  vtkPolyData *output = vtkPolyData::GetData(outputVector);
+
+  this->NumberOfCandidateCells = 0;
+  if (input == nullptr || input->GetNumberOfPoints() < 1 || input->GetNumberOfCells() < 1)
+    return 1;
+
+  double normal[3] = {this->Normal[0], this->Normal[1], this->Normal[2]};
+  if (vtkMath::Normalize(normal) == 0.0)
+  {
+    vtkErrorMacro("Cannot cut with a zero normal.");
+    return 0;
+  }
+
+  if (input != this->IndexInput || input->GetMTime() != this->IndexInputMTime || normal[0] != this->IndexNormal[0] ||
+      normal[1] != this->IndexNormal[1] || normal[2] != this->IndexNormal[2])
+  {
+    this->BuildIndex(input, normal);
+  }
+
+  const double offset = vtkMath::Dot(this->Origin, normal);
+
+  auto cached = std::find_if(
+    this->Cache.begin(), this->Cache.end(), [offset](const std::pair<double, vtkSmartPointer<vtkPolyData>> &entry) {
+      return entry.first == offset;
+    });
+
+  if (cached != this->Cache.end())
+  {
+    ++this->NumberOfCacheHits;
+    this->Cache.splice(this->Cache.begin(), this->Cache, cached);
+    output->ShallowCopy(this->Cache.front().second);
+    return 1;
+  }
+
+  std::vector<vtkIdType> cellIds;
+  this->CollectCandidateCells(offset, cellIds);
+  this->NumberOfCandidateCells = static_cast<vtkIdType>(cellIds.size());
+
+  vtkSmartPointer<vtkPolyData> cut = vtkSmartPointer<vtkPolyData>::New();
+  this->Cut(input, cellIds, cut);
+  output->ShallowCopy(cut);
+
+  if (this->CacheSize > 0)
+  {
+    this->Cache.emplace_front(offset, cut);
+    while (this->Cache.size() > static_cast<size_t>(this->CacheSize))
+      this->Cache.pop_back();
+  }
+
+  return 1;
+}
@@ -24,8 +24,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vtkPointData.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <sstream>
+#include <vector>
 
 vtkStandardNewMacro(vtkMitkThickSlicesFilter);
 
@@ -38,6 +41,10 @@ vtkMitkThickSlicesFilter::vtkMitkThickSlicesFilter()
 
   this->m_CurrentMode = MIP;
 
+  this->LastExecutionTime = 0.0;
+  this->TotalExecutionTime = 0.0;
+  this->NumberOfExecutions = 0;
+
   // by default process active point scalars
   this->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, vtkDataSetAttributes::SCALARS);
 }
@@ -48,6 +55,9 @@ void vtkMitkThickSlicesFilter::PrintSelf(ostream &os, vtkIndent indent)
   this->Superclass::PrintSelf(os, indent);
   os << indent << "HandleBoundaries: " << this->HandleBoundaries << "\n";
   os << indent << "Dimensionality: " << this->Dimensionality << "\n";
+  os << indent << "LastExecutionTime: " << this->LastExecutionTime << "\n";
+  os << indent << "TotalExecutionTime: " << this->TotalExecutionTime << "\n";
+  os << indent << "NumberOfExecutions: " << this->NumberOfExecutions << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -108,6 +118,134 @@ int vtkMitkThickSlicesFilter::RequestUpdateExtent(vtkInformation *,
   return 1;
 }
 
+//----------------------------------------------------------------------------
+// Reductions over the slab. They work on whole rows: the slab is traversed
+// slice by slice, so every input row is read contiguously and the loops over x
+// are simple enough to be vectorized by the compiler.
+namespace
+{
+  template <class T>
+  struct vtkMitkThickSlicesMaximum
+  {
+    typedef T AccumulatorType;
+
+    void First(AccumulatorType *acc, const T *in, int n) const
+    {
+      for (int x = 0; x < n; ++x)
+        acc[x] = in[x];
+    }
+
+    void Next(AccumulatorType *acc, const T *in, int n, int) const
+    {
+      for (int x = 0; x < n; ++x)
+        acc[x] = in[x] > acc[x] ? in[x] : acc[x];
+    }
+
+    void Finish(T *out, const AccumulatorType *acc, int n) const
+    {
+      for (int x = 0; x < n; ++x)
+        out[x] = acc[x];
+    }
+  };
+
+  template <class T>
+  struct vtkMitkThickSlicesMinimum : public vtkMitkThickSlicesMaximum<T>
+  {
+    typedef T AccumulatorType;
+
+    void Next(AccumulatorType *acc, const T *in, int n, int) const
+    {
+      for (int x = 0; x < n; ++x)
+        acc[x] = in[x] < acc[x] ? in[x] : acc[x];
+    }
+  };
+
+  // SUM and MEAN only differ in the normalization
+  template <class T>
+  struct vtkMitkThickSlicesAverage
+  {
+    typedef double AccumulatorType;
+
+    double Scale;
+
+    void First(AccumulatorType *acc, const T *in, int n) const
+    {
+      for (int x = 0; x < n; ++x)
+        acc[x] = in[x];
+    }
+
+    void Next(AccumulatorType *acc, const T *in, int n, int) const
+    {
+      for (int x = 0; x < n; ++x)
+        acc[x] += in[x];
+    }
+
+    void Finish(T *out, const AccumulatorType *acc, int n) const
+    {
+      for (int x = 0; x < n; ++x)
+        out[x] = static_cast<T>(Scale * acc[x]);
+    }
+  };
+
+  // the first slice of the slab has no weight
+  template <class T>
+  struct vtkMitkThickSlicesWeighted
+  {
+    typedef double AccumulatorType;
+
+    std::vector<double> Weights;
+    int MinZ;
+
+    void First(AccumulatorType *acc, const T *, int n) const
+    {
+      for (int x = 0; x < n; ++x)
+        acc[x] = 0.0;
+    }
+
+    void Next(AccumulatorType *acc, const T *in, int n, int z) const
+    {
+      const double weight = Weights[z - MinZ - 1];
+      for (int x = 0; x < n; ++x)
+        acc[x] += weight * in[x];
+    }
+
+    void Finish(T *out, const AccumulatorType *acc, int n) const
+    {
+      for (int x = 0; x < n; ++x)
+        out[x] = static_cast<T>(acc[x]);
+    }
+  };
+
+  template <class T, class TReduction>
+  void vtkMitkThickSlicesFilterReduce(const TReduction &reduction,
+                                      const T *inPtr,
+                                      T *outPtr,
+                                      const vtkIdType *inIncs,
+                                      vtkIdType outIncY,
+                                      int maxX,
+                                      int maxY,
+                                      int minZ,
+                                      int maxZ)
+  {
+    const int width = maxX + 1;
+    std::vector<typename TReduction::AccumulatorType> row(width);
+
+    for (int idxY = 0; idxY <= maxY; idxY++)
+    {
+      const T *inRow = inPtr + idxY * inIncs[1];
+
+      reduction.First(row.data(), inRow + minZ * inIncs[2], width);
+      for (int z = minZ + 1; z <= maxZ; z++)
+      {
+        reduction.Next(row.data(), inRow + z * inIncs[2], width, z);
+      }
+      reduction.Finish(outPtr, row.data(), width);
+
+      outPtr += width + outIncY;
+    }
+  }
+}
+
 //----------------------------------------------------------------------------
 // This execute method handles boundaries.
 // it handles boundaries. Pixels are just replicated to get values
@@ -121,234 +259,103 @@ void vtkMitkThickSlicesFilterExecute(vtkMitkThickSlicesFilter *self,
                                      int outExt[6],
                                      int /*id*/)
 {
-  int idxX, idxY;
-  int maxX, maxY;
-  vtkIdType inIncX, inIncY, inIncZ;
   vtkIdType outIncX, outIncY, outIncZ;
-  // int axesNum;
   int *inExt = inData->GetExtent();
-  int *wholeExtent;
-  vtkIdType *inIncs;
-  // int useYMin, useYMax, useXMin, useXMax;
 
   // find the region to loop over
-  maxX = outExt[1] - outExt[0];
-  maxY = outExt[3] - outExt[2];
-
-  //  maxZ = outExt[5] - outExt[4];
-
-  // Get the dimensionality of the gradient.
-  // axesNum = self->GetDimensionality();
+  const int maxX = outExt[1] - outExt[0];
+  const int maxY = outExt[3] - outExt[2];
 
   // Get increments to march through data
-  inData->GetContinuousIncrements(outExt, inIncX, inIncY, inIncZ);
   outData->GetContinuousIncrements(outExt, outIncX, outIncY, outIncZ);
-  /*
-// The data spacing is important for computing the gradient.
-// central differences (2 * ratio).
-// Negative because below we have (min - max) for dx ...
-inData->GetSpacing(r);
-r[0] = -0.5 / r[0];
-r[1] = -0.5 / r[1];
-r[2] = -0.5 / r[2];
-    */
-  // get some other info we need
-  inIncs = inData->GetIncrements();
-  wholeExtent = inData->GetExtent();
+  vtkIdType *inIncs = inData->GetIncrements();
+  int *wholeExtent = inData->GetExtent();
 
   // Move the pointer to the correct starting position.
   inPtr += (outExt[0] - inExt[0]) * inIncs[0] + (outExt[2] - inExt[2]) * inIncs[1] + (outExt[4] - inExt[4]) * inIncs[2];
 
-  // Loop through ouput pixels
-
-  int _minZ = /*-5 + outExt[4];  if( _minZ  < wholeExtent[4]) _minZ=*/wholeExtent[4];
-  int _maxZ = /* 5 + outExt[4];  if( _maxZ  > wholeExtent[5]) _maxZ=*/wholeExtent[5];
+  const int minZ = wholeExtent[4];
+  const int maxZ = wholeExtent[5];
 
-  if (_maxZ < _minZ)
+  if (maxZ < minZ)
     return;
 
-  double invNum = 1.0 / (_maxZ - _minZ + 1);
-
   switch (self->GetThickSliceMode())
   {
     default:
     case vtkMitkThickSlicesFilter::MIP:
     {
-      // MIP
-      for (idxY = 0; idxY <= maxY; idxY++)
-      {
-        // useYMin = ((idxY + outExt[2]) <= wholeExtent[2]) ? 0 : -inIncs[1];
-        // useYMax = ((idxY + outExt[2]) >= wholeExtent[3]) ? 0 : inIncs[1];
-        for (idxX = 0; idxX <= maxX; idxX++)
-        {
-          // useXMin = ((idxX + outExt[0]) <= wholeExtent[0]) ? 0 : -inIncs[0];
-          // useXMax = ((idxX + outExt[0]) >= wholeExtent[1]) ? 0 : inIncs[0];
-
-          T mip = inPtr[_minZ * inIncs[2]];
-
-          for (int z = _minZ + 1; z <= _maxZ; z++)
-          {
-            T value = inPtr[z * inIncs[2]];
-            if (value > mip)
-              mip = value;
-          }
-
-          // do X axis
-          *outPtr = mip;
-          outPtr++;
-          inPtr++;
-        }
-        outPtr += outIncY;
-        inPtr += inIncY;
-      }
+      vtkMitkThickSlicesMaximum<T> reduction;
+      vtkMitkThickSlicesFilterReduce(reduction, inPtr, outPtr, inIncs, outIncY, maxX, maxY, minZ, maxZ);
     }
     break;
 
     case vtkMitkThickSlicesFilter::SUM:
     {
-      // MIP
-      for (idxY = 0; idxY <= maxY; idxY++)
-      {
-        // useYMin = ((idxY + outExt[2]) <= wholeExtent[2]) ? 0 : -inIncs[1];
-        // useYMax = ((idxY + outExt[2]) >= wholeExtent[3]) ? 0 : inIncs[1];
-        for (idxX = 0; idxX <= maxX; idxX++)
-        {
-          // useXMin = ((idxX + outExt[0]) <= wholeExtent[0]) ? 0 : -inIncs[0];
-          // useXMax = ((idxX + outExt[0]) >= wholeExtent[1]) ? 0 : inIncs[0];
-
-          double sum = 0;
-
-          for (int z = _minZ; z <= _maxZ; z++)
-          {
-            T value = inPtr[z * inIncs[2]];
-            sum += value;
-          }
-
-          // do X axis
-          *outPtr = static_cast<T>(invNum * sum);
-          outPtr++;
-          inPtr++;
-        }
-        outPtr += outIncY;
-        inPtr += inIncY;
-      }
+      vtkMitkThickSlicesAverage<T> reduction;
+      reduction.Scale = 1.0 / (maxZ - minZ + 1);
+      vtkMitkThickSlicesFilterReduce(reduction, inPtr, outPtr, inIncs, outIncY, maxX, maxY, minZ, maxZ);
     }
     break;
 
     case vtkMitkThickSlicesFilter::WEIGHTED:
     {
-      const int size = _maxZ - _minZ;
-      std::vector<double> weights(size);
-      double mean = 0.5 * double(_minZ + _maxZ);
+      const int size = maxZ - minZ;
+      vtkMitkThickSlicesWeighted<T> reduction;
+      reduction.Weights.resize(size);
+      reduction.MinZ = minZ;
+      double mean = 0.5 * double(minZ + maxZ);
       double sigma_sq = double(size) / 6.0;
       sigma_sq *= sigma_sq;
       double sum = 0;
       int i = 0;
-      for (int z = _minZ + 1; z <= _maxZ; z++)
+      for (int z = minZ + 1; z <= maxZ; z++)
       {
         double val = exp(-(((double)z - mean) / sigma_sq));
-        weights[i++] = val;
+        reduction.Weights[i++] = val;
         sum += val;
       }
       for (i = 0; i < size; i++)
       {
-        weights[i] /= sum;
-      }
-
-      for (idxY = 0; idxY <= maxY; idxY++)
-      {
-        // useYMin = ((idxY + outExt[2]) <= wholeExtent[2]) ? 0 : -inIncs[1];
-        // useYMax = ((idxY + outExt[2]) >= wholeExtent[3]) ? 0 : inIncs[1];
-        for (idxX = 0; idxX <= maxX; idxX++)
-        {
-          // useXMin = ((idxX + outExt[0]) <= wholeExtent[0]) ? 0 : -inIncs[0];
-          // useXMax = ((idxX + outExt[0]) >= wholeExtent[1]) ? 0 : inIncs[0];
-
-          T mip = inPtr[_minZ * inIncs[2]];
-          i = 0;
-          double mymip = 0;
-          for (int z = _minZ + 1; z <= _maxZ; z++)
-          {
-            double value = inPtr[z * inIncs[2]];
-            mymip += value * weights[i++];
-          }
-          mip = static_cast<T>(mymip);
-          // do X axis
-          *outPtr = mip;
-          outPtr++;
-          inPtr++;
-        }
-        outPtr += outIncY;
-        inPtr += inIncY;
+        reduction.Weights[i] /= sum;
       }
+      vtkMitkThickSlicesFilterReduce(reduction, inPtr, outPtr, inIncs, outIncY, maxX, maxY, minZ, maxZ);
     }
     break;
 
     case vtkMitkThickSlicesFilter::MINIP:
     {
-      for (idxY = 0; idxY <= maxY; idxY++)
-      {
-        for (idxX = 0; idxX <= maxX; idxX++)
-        {
-          T mip = inPtr[_minZ * inIncs[2]];
-
-          for (int z = _minZ + 1; z <= _maxZ; z++)
-          {
-            T value = inPtr[z * inIncs[2]];
-            if (value < mip)
-              mip = value;
-          }
-
-          // do X axis
-          *outPtr = mip;
-          outPtr++;
-          inPtr++;
-        }
-        outPtr += outIncY;
-        inPtr += inIncY;
-      }
+      vtkMitkThickSlicesMinimum<T> reduction;
+      vtkMitkThickSlicesFilterReduce(reduction, inPtr, outPtr, inIncs, outIncY, maxX, maxY, minZ, maxZ);
     }
     break;
 
     case vtkMitkThickSlicesFilter::MEAN:
     {
-      const int size = _maxZ - _minZ;
-
-      // MEAN
-      for (idxY = 0; idxY <= maxY; idxY++)
-      {
-        for (idxX = 0; idxX <= maxX; idxX++)
-        {
-          long double sum = 0;
-          for (int z = _minZ; z <= _maxZ; z++)
-          {
-            T value = inPtr[z * inIncs[2]];
-            sum += value;
-          }
-
-          T mip = static_cast<T>(sum / size);
-
-          // do X axis
-          *outPtr = mip;
-          outPtr++;
-          inPtr++;
-        }
-        outPtr += outIncY;
-        inPtr += inIncY;
-      }
+      // as before, the sum of all slices is divided by the number of slices minus one
+      const int size = std::max(1, maxZ - minZ);
+      vtkMitkThickSlicesAverage<T> reduction;
+      reduction.Scale = 1.0 / size;
+      vtkMitkThickSlicesFilterReduce(reduction, inPtr, outPtr, inIncs, outIncY, maxX, maxY, minZ, maxZ);
     }
     break;
   }
 }
 
+//----------------------------------------------------------------------------
 int vtkMitkThickSlicesFilter::RequestData(vtkInformation *request,
                                           vtkInformationVector **inputVector,
                                           vtkInformationVector *outputVector)
 {
+  const auto start = std::chrono::steady_clock::now();
   if (!this->Superclass::RequestData(request, inputVector, outputVector))
   {
     return 0;
   }
+  this->LastExecutionTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  this->TotalExecutionTime += this->LastExecutionTime;
+  ++this->NumberOfExecutions;
+
   vtkImageData *output = vtkImageData::GetData(outputVector);
   vtkDataArray *outArray = output->GetPointData()->GetScalars();
   std::ostringstream newname;
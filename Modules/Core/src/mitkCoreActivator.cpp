@@ -167,6 +167,9 @@ void MitkCoreActivator::Load(us::ModuleContext *context)
   m_PropertyRelations.reset(new mitk::PropertyRelations);
   context->RegisterService<mitk::IPropertyRelations>(m_PropertyRelations.get());
 
+  m_DataMemoryManager.reset(new mitk::DataMemoryManager);
+  context->RegisterService<mitk::IDataMemoryManager>(m_DataMemoryManager.get());
+
   m_MimeTypeProvider.reset(new mitk::MimeTypeProvider);
   m_MimeTypeProvider->Start();
   m_MimeTypeProviderReg = context->RegisterService<mitk::IMimeTypeProvider>(m_MimeTypeProvider.get());
@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 // File IO
 #include <mitkAbstractFileIO.h>
+#include <mitkDataMemoryManager.h>
 #include <mitkIFileReader.h>
 #include <mitkIFileWriter.h>
 
@@ -66,6 +67,7 @@ private:
   std::unique_ptr<mitk::PropertyFilters> m_PropertyFilters;
   std::unique_ptr<mitk::PropertyPersistence> m_PropertyPersistence;
   std::unique_ptr<mitk::PropertyRelations> m_PropertyRelations;
+  std::unique_ptr<mitk::DataMemoryManager> m_DataMemoryManager;
   std::unique_ptr<mitk::MimeTypeProvider> m_MimeTypeProvider;
 
   // File IO
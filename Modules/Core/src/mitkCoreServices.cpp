@@ -16,6 +16,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkCoreServices.h"
 
+#include <mitkIDataMemoryManager.h>
 #include <mitkIMimeTypeProvider.h>
 #include <mitkIPropertyAliases.h>
 #include <mitkIPropertyDescriptions.h>
@@ -25,25 +26,164 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkIPropertyRelations.h>
 
 #include <usGetModuleContext.h>
+#include <usModule.h>
 #include <usModuleContext.h>
+#include <usModuleEvent.h>
 #include <usServiceReference.h>
 #include <usServiceTracker.h>
 
-#include <itkMutexLockHolder.h>
-#include <itkSimpleFastMutexLock.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
 
 namespace mitk
 {
-  itk::SimpleFastMutexLock &s_ContextToServicesMapMutex()
+  namespace
   {
-    static itk::SimpleFastMutexLock mutex;
-    return mutex;
-  }
+    std::atomic<std::size_t> s_NumberOfRegistryLookups(0);
 
-  std::map<us::ModuleContext *, std::map<void *, us::ServiceReferenceU>> &s_ContextToServicesMap()
-  {
-    static std::map<us::ModuleContext *, std::map<void *, us::ServiceReferenceU>> serviceMap;
-    return serviceMap;
+    class TrackedCoreServiceBase
+    {
+    public:
+      virtual ~TrackedCoreServiceBase() {}
+      virtual void *GetTrackedService() = 0;
+    };
+
+    /**
+     * Tracks the services of one interface for one module context. The best service is cached and reset
+     * by the service events of the tracker, so the registry is only queried again after a change.
+     */
+    template <class S>
+    class TrackedCoreService : public TrackedCoreServiceBase, private us::ServiceTrackerCustomizer<S>
+    {
+    public:
+      explicit TrackedCoreService(us::ModuleContext *context)
+        : m_Context(context), m_Tracker(context, this), m_Service(nullptr)
+      {
+        ++s_NumberOfRegistryLookups;
+        m_Tracker.Open();
+      }
+
+      ~TrackedCoreService() override { m_Tracker.Close(); }
+
+      S *GetService()
+      {
+        S *service = m_Service;
+        if (service == nullptr)
+        {
+          std::lock_guard<std::mutex> lock(m_Mutex);
+          service = m_Tracker.GetService();
+          m_Service = service;
+        }
+        return service;
+      }
+
+      void *GetTrackedService() override { return this->GetService(); }
+
+    private:
+      S *AddingService(const us::ServiceReference<S> &reference) override
+      {
+        ++s_NumberOfRegistryLookups;
+        S *service = m_Context->GetService(reference);
+        this->Invalidate();
+        return service;
+      }
+
+      // the ranking may have changed
+      void ModifiedService(const us::ServiceReference<S> &, S *) override { this->Invalidate(); }
+
+      void RemovedService(const us::ServiceReference<S> &reference, S *) override
+      {
+        this->Invalidate();
+        m_Context->UngetService(reference);
+      }
+
+      void Invalidate()
+      {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Service = nullptr;
+      }
+
+      us::ModuleContext *m_Context;
+      us::ServiceTracker<S> m_Tracker;
+      std::atomic<S *> m_Service;
+      std::mutex m_Mutex;
+    };
+
+    /**
+     * The trackers of all module contexts, closed when the module of a context is unloaded.
+     * The instance is intentionally never deleted: closing trackers during static destruction would
+     * access module contexts that are already gone.
+     */
+    class CoreServiceTrackers
+    {
+    public:
+      static CoreServiceTrackers &GetInstance()
+      {
+        static CoreServiceTrackers *instance = new CoreServiceTrackers;
+        return *instance;
+      }
+
+      template <class S>
+      S *GetService(us::ModuleContext *context)
+      {
+        // recursive, service factories may use core services themselves
+        std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+        if (!m_ListeningToModuleEvents)
+        {
+          us::GetModuleContext()->AddModuleListener(this, &CoreServiceTrackers::OnModuleEvent);
+          m_ListeningToModuleEvents = true;
+        }
+
+        std::unique_ptr<TrackedCoreServiceBase> &tracker = m_Trackers[context][us_service_interface_iid<S>()];
+        if (!tracker)
+          tracker.reset(new TrackedCoreService<S>(context));
+        return static_cast<TrackedCoreService<S> *>(tracker.get())->GetService();
+      }
+
+      bool IsTracked(us::ModuleContext *context, const std::string &interfaceId, void *service)
+      {
+        std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+        auto contextIter = m_Trackers.find(context);
+        if (contextIter == m_Trackers.end())
+          return false;
+        auto trackerIter = contextIter->second.find(interfaceId);
+        return trackerIter != contextIter->second.end() && trackerIter->second->GetTrackedService() == service;
+      }
+
+    private:
+      CoreServiceTrackers() : m_ListeningToModuleEvents(false) {}
+
+      void OnModuleEvent(const us::ModuleEvent event)
+      {
+        if (event.GetType() != us::ModuleEvent::UNLOADING)
+          return;
+
+        // the trackers are closed outside of the lock, closing emits service events
+        std::map<us::ModuleContext *, std::map<std::string, std::unique_ptr<TrackedCoreServiceBase>>> closed;
+        {
+          std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+          if (event.GetModule() == us::GetModuleContext()->GetModule())
+          {
+            closed.swap(m_Trackers);
+          }
+          else
+          {
+            auto iter = m_Trackers.find(event.GetModule()->GetModuleContext());
+            if (iter != m_Trackers.end())
+            {
+              closed[iter->first].swap(iter->second);
+              m_Trackers.erase(iter);
+            }
+          }
+        }
+      }
+
+      std::recursive_mutex m_Mutex;
+      bool m_ListeningToModuleEvents;
+      std::map<us::ModuleContext *, std::map<std::string, std::unique_ptr<TrackedCoreServiceBase>>> m_Trackers;
+    };
   }
 
   template <class S>
@@ -52,19 +192,8 @@ namespace mitk
     if (context == nullptr)
       context = us::GetModuleContext();
 
-    S *coreService = nullptr;
-    us::ServiceReference<S> serviceRef = context->GetServiceReference<S>();
-    if (serviceRef)
-    {
-      coreService = context->GetService(serviceRef);
-    }
-
+    S *coreService = CoreServiceTrackers::GetInstance().GetService<S>(context);
     assert(coreService && "Asserting non-nullptr MITK core service");
-    {
-      itk::MutexLockHolder<itk::SimpleFastMutexLock> l(s_ContextToServicesMapMutex());
-      s_ContextToServicesMap()[context].insert(std::make_pair(coreService, serviceRef));
-    }
-
     return coreService;
   }
 
@@ -98,35 +227,26 @@ namespace mitk
     return GetCoreService<IPropertyRelations>(context);
   }
 
+  IDataMemoryManager *CoreServices::GetDataMemoryManager(us::ModuleContext *context)
+  {
+    return GetCoreService<IDataMemoryManager>(context);
+  }
+
   IMimeTypeProvider *CoreServices::GetMimeTypeProvider(us::ModuleContext *context)
   {
     return GetCoreService<IMimeTypeProvider>(context);
   }
 
-  bool CoreServices::Unget(us::ModuleContext *context, const std::string & /*interfaceId*/, void *service)
+  std::size_t CoreServices::GetNumberOfRegistryLookups()
   {
-    bool success = false;
-
-    itk::MutexLockHolder<itk::SimpleFastMutexLock> l(s_ContextToServicesMapMutex());
-    auto iter =
-      s_ContextToServicesMap().find(context);
-    if (iter != s_ContextToServicesMap().end())
-    {
-      auto iter2 = iter->second.find(service);
-      if (iter2 != iter->second.end())
-      {
-        us::ServiceReferenceU serviceRef = iter2->second;
-        if (serviceRef)
-        {
-          success = context->UngetService(serviceRef);
-          if (success)
-          {
-            iter->second.erase(iter2);
-          }
-        }
-      }
-    }
+    return s_NumberOfRegistryLookups;
+  }
 
-    return success;
+  bool CoreServices::Unget(us::ModuleContext *context, const std::string &interfaceId, void *service)
+  {
+    // the service stays in use by the tracker of the context, there is nothing to release
+    if (context == nullptr)
+      context = us::GetModuleContext();
+    return CoreServiceTrackers::GetInstance().IsTracked(context, interfaceId, service);
   }
 }
@@ -0,0 +1,53 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkCoreServices.h>
+#include <mitkIMimeTypeProvider.h>
+#include <mitkIPropertyAliases.h>
+#include <mitkIPropertyPersistence.h>
+#include <mitkTestingMacros.h>
+
+int mitkCoreServicesTest(int, char *[])
+{
+  MITK_TEST_BEGIN("mitkCoreServicesTest");
+
+  mitk::IPropertyAliases *aliases = mitk::CoreServices::GetPropertyAliases();
+  mitk::IPropertyPersistence *persistence = mitk::CoreServices::GetPropertyPersistence();
+  mitk::IMimeTypeProvider *mimeTypeProvider = mitk::CoreServices::GetMimeTypeProvider();
+  MITK_TEST_CONDITION_REQUIRED(aliases != nullptr && persistence != nullptr && mimeTypeProvider != nullptr,
+                               "Get core services");
+
+  const std::size_t lookups = mitk::CoreServices::GetNumberOfRegistryLookups();
+  MITK_TEST_CONDITION(lookups >= 3, "Lookups of the first requests are counted");
+
+  for (int i = 0; i < 1000; ++i)
+  {
+    MITK_TEST_CONDITION_REQUIRED(mitk::CoreServices::GetPropertyAliases() == aliases &&
+                                   mitk::CoreServices::GetPropertyPersistence() == persistence &&
+                                   mitk::CoreServices::GetMimeTypeProvider() == mimeTypeProvider,
+                                 "Repeated requests return the same service");
+  }
+  MITK_TEST_CONDITION(mitk::CoreServices::GetNumberOfRegistryLookups() == lookups,
+                      "Repeated requests do not query the service registry");
+
+  {
+    mitk::CoreServicePointer<mitk::IPropertyAliases> pointer(mitk::CoreServices::GetPropertyAliases());
+  }
+  MITK_TEST_CONDITION(mitk::CoreServices::GetPropertyAliases() == aliases, "Service is still available after Unget");
+  MITK_TEST_CONDITION(mitk::CoreServices::Unget(aliases), "Unget of a tracked service succeeds");
+
+  MITK_TEST_END();
+}
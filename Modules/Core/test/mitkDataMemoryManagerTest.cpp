@@ -0,0 +1,71 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkCoreServices.h>
+#include <mitkDataNode.h>
+#include <mitkIDataMemoryManager.h>
+#include <mitkImageGenerator.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkStandaloneDataStorage.h>
+#include <mitkTestingMacros.h>
+
+#include <vector>
+
+int mitkDataMemoryManagerTest(int, char *[])
+{
+  MITK_TEST_BEGIN("mitkDataMemoryManagerTest");
+
+  mitk::IDataMemoryManager *memoryManager = mitk::CoreServices::GetDataMemoryManager();
+  MITK_TEST_CONDITION_REQUIRED(memoryManager != nullptr, "Get data memory manager service");
+  MITK_TEST_CONDITION(memoryManager->GetMemoryBudget() == 0, "Memory budget is disabled by default");
+
+  mitk::Image::Pointer image = mitk::ImageGenerator::GenerateGradientImage<float>(16, 16, 16, 1);
+  const std::size_t imageSize = 16 * 16 * 16 * sizeof(float);
+  MITK_TEST_CONDITION(memoryManager->GetMemoryUsage(image) == imageSize, "Memory usage of an image");
+
+  std::vector<float> reference(16 * 16 * 16);
+  {
+    mitk::ImageReadAccessor accessor(image);
+    const auto *data = static_cast<const float *>(accessor.GetData());
+    reference.assign(data, data + reference.size());
+  }
+
+  mitk::StandaloneDataStorage::Pointer storage = mitk::StandaloneDataStorage::New();
+  mitk::DataNode::Pointer node = mitk::DataNode::New();
+  node->SetData(image);
+  storage->Add(node);
+  MITK_TEST_CONDITION(memoryManager->GetMemoryUsage(storage) == imageSize, "Memory usage of a data storage");
+
+  // the image is only evicted once it has been seen unmodified by a previous check
+  memoryManager->SetMemoryBudget(1);
+  memoryManager->EnforceBudget(storage);
+  std::size_t released = memoryManager->EnforceBudget(storage);
+  MITK_TEST_CONDITION(released == imageSize, "Unmodified image is swapped out");
+  MITK_TEST_CONDITION(memoryManager->GetMemoryUsage(storage) == 0, "No resident memory left after swap-out");
+
+  {
+    mitk::ImageReadAccessor accessor(image);
+    const auto *data = static_cast<const float *>(accessor.GetData());
+    bool equal = true;
+    for (std::size_t i = 0; i < reference.size(); ++i)
+      equal = equal && data[i] == reference[i];
+    MITK_TEST_CONDITION(equal, "Swapped out image data is still readable");
+  }
+
+  memoryManager->SetMemoryBudget(0);
+
+  MITK_TEST_END();
+}
@@ -31,6 +31,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkNodePredicateAnd.h"
 #include "mitkNodePredicateData.h"
 #include "mitkNodePredicateDataType.h"
+#include "mitkNodePredicateDataUID.h"
 #include "mitkNodePredicateDimension.h"
 #include "mitkNodePredicateNot.h"
 #include "mitkNodePredicateOr.h"
@@ -70,6 +71,39 @@ public:
   void OnRemove(const mitk::DataNode *node) { m_NodeRemoved = node; }
 };
 
+class DSBatchEventReceiver // Helper class for testing the aggregated events of batch updates
+{
+public:
+  unsigned int m_NumberOfAddEvents;
+  unsigned int m_NumberOfRemoveEvents;
+  unsigned int m_NumberOfNodesAdded;
+  unsigned int m_NumberOfNodesRemoved;
+  bool m_NodesRemovedBeforeEvent;
+  mitk::DataStorage *m_DataStorage;
+
+  DSBatchEventReceiver(mitk::DataStorage *ds)
+    : m_NumberOfAddEvents(0),
+      m_NumberOfRemoveEvents(0),
+      m_NumberOfNodesAdded(0),
+      m_NumberOfNodesRemoved(0),
+      m_NodesRemovedBeforeEvent(true),
+      m_DataStorage(ds)
+  {
+  }
+  void OnAdd(const mitk::DataStorage::SetOfObjects *nodes)
+  {
+    ++m_NumberOfAddEvents;
+    m_NumberOfNodesAdded += nodes->Size();
+  }
+  void OnRemove(const mitk::DataStorage::SetOfObjects *nodes)
+  {
+    ++m_NumberOfRemoveEvents;
+    m_NumberOfNodesRemoved += nodes->Size();
+    for (auto it = nodes->Begin(); it != nodes->End(); ++it)
+      m_NodesRemovedBeforeEvent = m_NodesRemovedBeforeEvent && !m_DataStorage->Exists(it->Value());
+  }
+};
+
 ///
 /// \brief a class for checking if the datastorage is really thread safe
 ///
@@ -546,6 +580,29 @@ void TestDataStorage(mitk::DataStorage *ds, std::string filename)
       mitk::NodePredicateDataType::Pointer p(mitk::NodePredicateDataType::New("PointSet"));
       MITK_TEST_CONDITION(ds->GetNode(p) == nullptr, "Checking GetNode with invalid predicate");
     }
+
+    /* Checking queries after nodes have been modified */
+    {
+      n5->SetName("Node 5 - renamed");
+      MITK_TEST_CONDITION((ds->GetNamedNode("Node 5 - renamed") == n5) && (ds->GetNamedNode("Node 5") == nullptr),
+                          "Checking named node method after renaming a node");
+
+      ds->BlockNodeModifiedEvents(true);
+      n5->SetName("Node 5");
+      ds->BlockNodeModifiedEvents(false);
+      MITK_TEST_CONDITION((ds->GetNamedNode("Node 5") == n5) && (ds->GetNamedNode("Node 5 - renamed") == nullptr),
+                          "Checking named node method after renaming a node while node events are blocked");
+
+      mitk::NodePredicateDataType::Pointer p(mitk::NodePredicateDataType::New("Surface"));
+      n5->SetData(mitk::Surface::New());
+      MITK_TEST_CONDITION(ds->GetSubset(p)->Size() == 2, "Checking data type query after setting the data of a node");
+      n5->SetData(nullptr);
+      MITK_TEST_CONDITION((ds->GetSubset(p)->Size() == 1) && (ds->GetNode(p) == n2),
+                          "Checking data type query after removing the data of a node");
+
+      mitk::NodePredicateDataUID::Pointer uidPredicate(mitk::NodePredicateDataUID::New(surface->GetUID()));
+      MITK_TEST_CONDITION(ds->GetNode(uidPredicate) == n2, "Checking data UID query");
+    }
   } // object retrieval methods
   catch (...)
   {
@@ -824,6 +881,53 @@ void TestDataStorage(mitk::DataStorage *ds, std::string filename)
     MITK_TEST_FAILED_MSG(<< "Exception during object removal methods");
   }
 
+  /* Checking batch updates */
+  DSBatchEventReceiver batchListener(ds);
+  ds->AddNodesEvent += mitk::MessageDelegate1<DSBatchEventReceiver, const mitk::DataStorage::SetOfObjects *>(
+    &batchListener, &DSBatchEventReceiver::OnAdd);
+  ds->RemoveNodesEvent += mitk::MessageDelegate1<DSBatchEventReceiver, const mitk::DataStorage::SetOfObjects *>(
+    &batchListener, &DSBatchEventReceiver::OnRemove);
+  {
+    mitk::DataStorage::SetOfObjects::Pointer batchNodes = mitk::DataStorage::SetOfObjects::New();
+    for (unsigned int i = 0; i < 10; ++i)
+      batchNodes->InsertElement(i, mitk::DataNode::New());
+    const unsigned int numberOfNodes = ds->GetAll()->Size();
+
+    ds->Add(batchNodes);
+    MITK_TEST_CONDITION(ds->GetAll()->Size() == numberOfNodes + 10 && batchListener.m_NumberOfAddEvents == 1 &&
+                          batchListener.m_NumberOfNodesAdded == 10 && !ds->IsBatchUpdateActive(),
+                        "Adding a set of nodes emits a single AddNodesEvent");
+
+    ds->Remove(batchNodes);
+    MITK_TEST_CONDITION(ds->GetAll()->Size() == numberOfNodes && batchListener.m_NumberOfRemoveEvents == 1 &&
+                          batchListener.m_NumberOfNodesRemoved == 10 && batchListener.m_NodesRemovedBeforeEvent,
+                        "Removing a set of nodes emits a single RemoveNodesEvent after the removal");
+
+    mitk::DataNode::Pointer transient = mitk::DataNode::New();
+    {
+      mitk::DataStorage::BatchUpdate outer(ds);
+      {
+        mitk::DataStorage::BatchUpdate inner(ds);
+        ds->Add(batchNodes->GetElement(0));
+        ds->Add(transient);
+      }
+      MITK_TEST_CONDITION(ds->IsBatchUpdateActive() && batchListener.m_NumberOfAddEvents == 1,
+                          "Aggregated events are deferred until the outermost batch ends");
+      ds->Remove(transient);
+    }
+    MITK_TEST_CONDITION(batchListener.m_NumberOfAddEvents == 2 && batchListener.m_NumberOfNodesAdded == 11 &&
+                          batchListener.m_NumberOfRemoveEvents == 1,
+                        "Nodes added and removed within one batch are not reported");
+    ds->Remove(batchNodes->GetElement(0));
+    MITK_TEST_CONDITION(batchListener.m_NumberOfRemoveEvents == 1,
+                        "No RemoveNodesEvent is emitted outside of batch updates");
+    MITK_TEST_FOR_EXCEPTION(std::logic_error, ds->EndBatchUpdate());
+  }
+  ds->AddNodesEvent -= mitk::MessageDelegate1<DSBatchEventReceiver, const mitk::DataStorage::SetOfObjects *>(
+    &batchListener, &DSBatchEventReceiver::OnAdd);
+  ds->RemoveNodesEvent -= mitk::MessageDelegate1<DSBatchEventReceiver, const mitk::DataStorage::SetOfObjects *>(
+    &batchListener, &DSBatchEventReceiver::OnRemove);
+
   // Checking ComputeBoundingGeometry3D method*/
   const mitk::DataStorage::SetOfObjects::ConstPointer all = ds->GetAll();
   auto geometry = ds->ComputeBoundingGeometry3D();
@@ -0,0 +1,207 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#include <mitkExtractSliceFilter2.h>
+#include <mitkITKImageImport.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkInteractionConst.h>
+#include <mitkRotationOperation.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <itkBSplineInterpolateImageFunction.h>
+#include <itkImageRegionIterator.h>
+#include <itkLinearInterpolateImageFunction.h>
+#include <itkNearestNeighborInterpolateImageFunction.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+class mitkExtractSliceFilter2TestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkExtractSliceFilter2TestSuite);
+  MITK_TEST(ObliqueSlice_NearestNeighbor_EqualsItkInterpolator);
+  MITK_TEST(ObliqueSlice_Linear_EqualsItkInterpolator);
+  MITK_TEST(ObliqueSlice_Cubic_EqualsItkInterpolator);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef itk::Image<float, 3> ImageType;
+  typedef itk::InterpolateImageFunction<ImageType> InterpolateImageFunctionType;
+
+  ImageType::Pointer m_ItkImage;
+  mitk::Image::Pointer m_Image;
+  mitk::PlaneGeometry::Pointer m_Plane;
+
+  // true if the continuous index is (almost) halfway between two indices, the rounding may go either way there
+  static bool IsAmbiguous(const itk::ContinuousIndex<mitk::ScalarType, 3> &index)
+  {
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      const double shifted = index[d] + 0.5;
+      if (std::abs(shifted - std::round(shifted)) < 1e-6)
+        return true;
+    }
+    return false;
+  }
+
+  void CompareWithInterpolateImageFunction(mitk::ExtractSliceFilter2::Interpolator interpolator,
+                                           InterpolateImageFunctionType *interpolateImageFunction,
+                                           double tolerance,
+                                           bool skipBorder)
+  {
+    auto filter = mitk::ExtractSliceFilter2::New();
+    filter->SetInput(m_Image);
+    filter->SetOutputGeometry(m_Plane);
+    filter->SetInterpolator(interpolator);
+    filter->Update();
+
+    mitk::Image::Pointer slice = filter->GetOutput();
+    mitk::ImageReadAccessor accessor(slice);
+    auto data = static_cast<const float *>(accessor.GetData());
+
+    auto outputGeometry = slice->GetSlicedGeometry()->GetPlaneGeometry(0);
+    auto xDirection = outputGeometry->GetAxisVector(0);
+    auto yDirection = outputGeometry->GetAxisVector(1);
+    xDirection.Normalize();
+    yDirection.Normalize();
+
+    const auto width = static_cast<unsigned int>(outputGeometry->GetExtent(0));
+    const auto height = static_cast<unsigned int>(outputGeometry->GetExtent(1));
+    const auto size = m_ItkImage->GetLargestPossibleRegion().GetSize();
+
+    unsigned int insidePixels = 0;
+    unsigned int outsidePixels = 0;
+    itk::ContinuousIndex<mitk::ScalarType, 3> index;
+
+    for (unsigned int y = 0; y < height; ++y)
+    {
+      for (unsigned int x = 0; x < width; ++x)
+      {
+        auto point = outputGeometry->GetOrigin() + xDirection * (outputGeometry->GetSpacing()[0] * x) +
+                     yDirection * (outputGeometry->GetSpacing()[1] * y);
+        const bool inside = m_ItkImage->TransformPhysicalPointToContinuousIndex(point, index);
+
+        if (IsAmbiguous(index))
+          continue;
+
+        const float value = data[width * y + x];
+        if (!inside)
+        {
+          CPPUNIT_ASSERT_EQUAL_MESSAGE(
+            "Pixel outside of the input has the lowest value", std::numeric_limits<float>::lowest(), value);
+          ++outsidePixels;
+          continue;
+        }
+
+        if (skipBorder)
+        {
+          bool border = false;
+          for (unsigned int d = 0; d < 3; ++d)
+            border = border || index[d] < 0.0 || index[d] > size[d] - 1.0;
+          if (border)
+            continue;
+        }
+
+        const auto expected = static_cast<float>(interpolateImageFunction->EvaluateAtContinuousIndex(index));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Pixel inside of the input is interpolated", expected, value, tolerance);
+        ++insidePixels;
+      }
+    }
+
+    CPPUNIT_ASSERT_MESSAGE("Slice is partially inside of the input", insidePixels > 0 && outsidePixels > 0);
+  }
+
+public:
+  void setUp() override
+  {
+    ImageType::SizeType size;
+    size[0] = 20;
+    size[1] = 18;
+    size[2] = 16;
+
+    ImageType::SpacingType spacing;
+    spacing[0] = 1.0;
+    spacing[1] = 1.5;
+    spacing[2] = 2.0;
+
+    ImageType::PointType origin;
+    origin[0] = -3.0;
+    origin[1] = 5.0;
+    origin[2] = 1.0;
+
+    m_ItkImage = ImageType::New();
+    m_ItkImage->SetRegions(size);
+    m_ItkImage->SetSpacing(spacing);
+    m_ItkImage->SetOrigin(origin);
+    m_ItkImage->Allocate();
+
+    std::srand(42);
+    itk::ImageRegionIterator<ImageType> it(m_ItkImage, m_ItkImage->GetLargestPossibleRegion());
+    for (; !it.IsAtEnd(); ++it)
+      it.Set(static_cast<float>(std::rand() % 1000) / 10.0f);
+
+    m_Image = mitk::ImportItkImage(m_ItkImage)->Clone();
+
+    m_Plane = mitk::PlaneGeometry::New();
+    m_Plane->InitializeStandardPlane(m_Image->GetGeometry(), mitk::PlaneGeometry::Axial, 7, true, false);
+
+    mitk::Point3D center = m_Image->GetGeometry()->GetCenter();
+    mitk::Vector3D rotationAxis;
+    rotationAxis[0] = 1;
+    rotationAxis[1] = 2;
+    rotationAxis[2] = 3;
+    rotationAxis.Normalize();
+
+    mitk::RotationOperation rotation(mitk::OpROTATE, center, rotationAxis, 25);
+    m_Plane->ExecuteOperation(&rotation);
+    m_Plane->SetImageGeometry(true);
+  }
+
+  void tearDown() override
+  {
+    m_Plane = nullptr;
+    m_Image = nullptr;
+    m_ItkImage = nullptr;
+  }
+
+  void ObliqueSlice_NearestNeighbor_EqualsItkInterpolator()
+  {
+    auto function = itk::NearestNeighborInterpolateImageFunction<ImageType>::New();
+    function->SetInputImage(m_ItkImage);
+    this->CompareWithInterpolateImageFunction(mitk::ExtractSliceFilter2::NearestNeighbor, function, 0.0, false);
+  }
+
+  void ObliqueSlice_Linear_EqualsItkInterpolator()
+  {
+    // the half pixel at the border of the input is clamped to the border pixel, unlike in ITK
+    auto function = itk::LinearInterpolateImageFunction<ImageType>::New();
+    function->SetInputImage(m_ItkImage);
+    this->CompareWithInterpolateImageFunction(mitk::ExtractSliceFilter2::Linear, function, 1e-3, true);
+  }
+
+  void ObliqueSlice_Cubic_EqualsItkInterpolator()
+  {
+    auto function = itk::BSplineInterpolateImageFunction<ImageType>::New();
+    function->SetSplineOrder(2);
+    function->SetInputImage(m_ItkImage);
+    this->CompareWithInterpolateImageFunction(mitk::ExtractSliceFilter2::Cubic, function, 1e-3, false);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkExtractSliceFilter2)
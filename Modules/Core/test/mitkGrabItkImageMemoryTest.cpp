@@ -18,6 +18,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkTestingMacros.h"
 
 #include "mitkImagePixelReadAccessor.h"
+#include "mitkImagePixelWriteAccessor.h"
+#include "mitkImageToItk.h"
 
 #include <itkThresholdImageFilter.h>
 
@@ -111,6 +113,65 @@ bool Assert_ItkImportWithinAccessByItkSucceded_ReturnsTrue()
   return equal;
 }
 
+template <typename TPixel, unsigned int VDimensions>
+static void ItkThresholdFilterSharingMemory(const itk::Image<TPixel, VDimensions> *image,
+                                            mitk::Image::Pointer &output,
+                                            const double th[])
+{
+  typedef itk::Image<TPixel, VDimensions> InputImageType;
+  typedef itk::ThresholdImageFilter<InputImageType> ThresholdFilterType;
+
+  typename ThresholdFilterType::Pointer thresholder = ThresholdFilterType::New();
+  thresholder->SetInput(image);
+  thresholder->ThresholdOutside(th[0], th[1]);
+  thresholder->Update();
+
+  output = mitk::ShareItkImageMemory(thresholder->GetOutput());
+}
+
+/**
+ * Hands an image computed within AccessByItk back without copying it and checks that the shared memory
+ * outlives the filter, and that the MITK image is not locked by an itk::Image sharing its memory.
+ */
+static void Assert_SharedMemoryOutlivesOwners()
+{
+  const unsigned int dimensions[3] = {3, 3, 3};
+  auto image_data = new short[27];
+  for (unsigned int i = 0; i < 27; i++)
+    image_data[i] = static_cast<short>(i * 10);
+
+  mitk::Image::Pointer input = mitk::Image::New();
+  input->Initialize(mitk::MakeScalarPixelType<short>(), 3, dimensions);
+  input->SetImportVolume(image_data, 0, 0, mitk::Image::ManageMemory);
+
+  double threshold[2] = {90.0, 180.0};
+  mitk::Image::Pointer output;
+  AccessByItk_2(input, ItkThresholdFilterSharingMemory, output, threshold);
+
+  {
+    mitk::ImagePixelReadAccessor<short, 3> readAccessor(output);
+    MITK_TEST_CONDITION(readAccessor.GetData()[10] == 100 && readAccessor.GetData()[5] == 0,
+                        "Shared ITK memory outlives the filter that computed it");
+  }
+
+  typedef itk::Image<short, 3> ItkImageType;
+  ItkImageType::Pointer itkView = mitk::ShareMitkImageMemory<short, 3>(input);
+  {
+    mitk::ImagePixelReadAccessor<short, 3> readAccessor(input);
+    MITK_TEST_CONDITION(itkView->GetBufferPointer() == readAccessor.GetData(), "ITK view references the MITK memory");
+  }
+
+  {
+    // succeeds because the view does not lock the image, and copies the data that is still shared
+    mitk::ImagePixelWriteAccessor<short, 3> writeAccessor(input);
+    writeAccessor.GetData()[0] = 42;
+  }
+  MITK_TEST_CONDITION(itkView->GetBufferPointer()[0] == 0, "Writing the MITK image detaches it from the ITK view");
+
+  input = nullptr;
+  MITK_TEST_CONDITION(itkView->GetBufferPointer()[1] == 10, "ITK view keeps the memory alive");
+}
+
 int mitkGrabItkImageMemoryTest(int /*argc*/, char * /*argv*/ [])
 {
   MITK_TEST_BEGIN("mitkGrabItkImageMemoryTest")
@@ -120,5 +181,7 @@ int mitkGrabItkImageMemoryTest(int /*argc*/, char * /*argv*/ [])
   Assert_ItkImportWithinAccessByItkSucceded_ReturnsTrue<unsigned char>(); // "Import succesfull on uchar");
   Assert_ItkImportWithinAccessByItkSucceded_ReturnsTrue<int>();           // "Import succesfull on int");
 
+  Assert_SharedMemoryOutlivesOwners();
+
   MITK_TEST_END()
 }
@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mitkIOUtil.h>
 #include <mitkImageGenerator.h>
+#include <mitkStandaloneDataStorage.h>
 
 #include <itksys/SystemTools.hxx>
 
@@ -33,6 +34,7 @@ class mitkIOUtilTestSuite : public mitk::TestFixture
   MITK_TEST(TestNullSave);
   MITK_TEST(TestLoadAndSavePointSet);
   MITK_TEST(TestLoadAndSaveSurface);
+  MITK_TEST(TestLoadConcurrently);
   MITK_TEST(TestTempMethodsForUniqueFilenames);
   MITK_TEST(TestTempMethodsForUniqueFilenames);
   CPPUNIT_TEST_SUITE_END();
@@ -230,6 +232,33 @@ public:
     // delete the files after the test is done
     std::remove(surfacePath.c_str());
   }
+
+  void TestLoadConcurrently()
+  {
+    std::vector<std::string> paths;
+    paths.push_back(m_ImagePath);
+    paths.push_back(m_SurfacePath);
+    paths.push_back(m_PointSetPath);
+    paths.push_back(m_SurfacePath);
+
+    mitk::StandaloneDataStorage::Pointer storage = mitk::StandaloneDataStorage::New();
+    mitk::DataStorage::SetOfObjects::Pointer nodes = mitk::IOUtil::LoadConcurrently(paths, *storage, nullptr, 3);
+
+    // the nodes have to arrive in the order of the given paths
+    CPPUNIT_ASSERT_EQUAL(static_cast<unsigned int>(paths.size()), nodes->Size());
+    CPPUNIT_ASSERT_EQUAL(static_cast<unsigned int>(paths.size()), storage->GetAll()->Size());
+    CPPUNIT_ASSERT(dynamic_cast<mitk::Image *>(nodes->GetElement(0)->GetData()) != nullptr);
+    CPPUNIT_ASSERT(dynamic_cast<mitk::Surface *>(nodes->GetElement(1)->GetData()) != nullptr);
+    CPPUNIT_ASSERT(dynamic_cast<mitk::PointSet *>(nodes->GetElement(2)->GetData()) != nullptr);
+    CPPUNIT_ASSERT(dynamic_cast<mitk::Surface *>(nodes->GetElement(3)->GetData()) != nullptr);
+
+    std::vector<mitk::BaseData::Pointer> data = mitk::IOUtil::LoadConcurrently(paths);
+    CPPUNIT_ASSERT_EQUAL(paths.size(), data.size());
+    CPPUNIT_ASSERT(dynamic_cast<mitk::PointSet *>(data[2].GetPointer()) != nullptr);
+
+    paths.push_back("/this/file/does/not/exist.nrrd");
+    CPPUNIT_ASSERT_THROW(mitk::IOUtil::LoadConcurrently(paths), mitk::Exception);
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkIOUtil)
@@ -18,6 +18,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkTestingMacros.h"
 
 #include "mitkImageCast.h"
+#include "mitkImageGenerator.h"
+#include "mitkImagePixelReadAccessor.h"
 #include "mitkImageToItk.h"
 
 class mitkImageCastTestSuite : public mitk::TestFixture
@@ -25,6 +27,8 @@ class mitkImageCastTestSuite : public mitk::TestFixture
   CPPUNIT_TEST_SUITE(mitkImageCastTestSuite);
   MITK_TEST(Cast_ToMultipleConstItkImages_Succeeds);
   MITK_TEST(Cast_ToMultipleNonConstItkImages_Fails);
+  MITK_TEST(Cast_ShortToFloat_ConvertsAllPixels);
+  MITK_TEST(Cast_SamePixelType_ReferencesImageMemory);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -74,6 +78,43 @@ public:
     CPPUNIT_ASSERT_THROW((mitk::ImageToItkImage<ItkImageType::PixelType, ItkImageType::ImageDimension>(mitkImage)),
                          mitk::Exception);
   }
+
+  void Cast_ShortToFloat_ConvertsAllPixels()
+  {
+    // Large enough to be converted by several threads
+    mitk::Image::Pointer mitkImage =
+      mitk::ImageGenerator::GenerateRandomImage<short>(64, 64, 40, 1, 0.5, 1, 2, 1000, -1000);
+
+    typedef itk::Image<float, 3> ItkImageType;
+    ItkImageType::Pointer itkImage;
+    mitk::CastToItkImage(mitkImage, itkImage);
+
+    CPPUNIT_ASSERT(itkImage.IsNotNull());
+    CPPUNIT_ASSERT(itkImage->GetLargestPossibleRegion().GetNumberOfPixels() == 64 * 64 * 40);
+    CPPUNIT_ASSERT(itkImage->GetSpacing()[0] == 0.5 && itkImage->GetSpacing()[2] == 2);
+
+    mitk::ImagePixelReadAccessor<short, 3> accessor(mitkImage);
+    const short *mitkBuffer = accessor.GetData();
+    const float *itkBuffer = itkImage->GetBufferPointer();
+    bool allPixelsConverted = true;
+    for (std::size_t i = 0; i < 64 * 64 * 40; ++i)
+    {
+      allPixelsConverted = allPixelsConverted && itkBuffer[i] == static_cast<float>(mitkBuffer[i]);
+    }
+    CPPUNIT_ASSERT(allPixelsConverted);
+  }
+
+  void Cast_SamePixelType_ReferencesImageMemory()
+  {
+    mitk::Image::Pointer mitkImage = mitk::ImageGenerator::GenerateRandomImage<short>(8, 8, 8);
+
+    typedef itk::Image<short, 3> ItkImageType;
+    ItkImageType::Pointer itkImage;
+    mitk::CastToItkImage(mitkImage, itkImage);
+
+    mitk::ImagePixelReadAccessor<short, 3> accessor(mitkImage);
+    CPPUNIT_ASSERT(itkImage->GetBufferPointer() == accessor.GetData());
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkImageCast)
@@ -0,0 +1,152 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <mitkIOUtil.h>
+#include <mitkITKImageImport.h>
+#include <mitkImageFileRegionProvider.h>
+#include <mitkImageRegionReadAccessor.h>
+
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkImageRegionIterator.h>
+
+class mitkImageRegionReadAccessorTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkImageRegionReadAccessorTestSuite);
+  MITK_TEST(TestRegionFromMemory);
+  MITK_TEST(TestInvalidRegion);
+  MITK_TEST(TestGenerateTiles);
+  MITK_TEST(TestRegionFromFile);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef itk::Image<int, 3> ItkImageType;
+
+  mitk::Image::Pointer m_Image;
+
+  static int ExpectedValue(const ItkImageType::IndexType &index)
+  {
+    return static_cast<int>(index[0] + 100 * index[1] + 10000 * index[2]);
+  }
+
+  void CheckRegion(const mitk::ImageRegionReadAccessor &accessor)
+  {
+    ItkImageType::Pointer tile = accessor.GetItkImage<int>();
+    CPPUNIT_ASSERT(tile->GetLargestPossibleRegion() == accessor.GetRegion());
+
+    itk::ImageRegionConstIteratorWithIndex<ItkImageType> iter(tile, tile->GetLargestPossibleRegion());
+    for (; !iter.IsAtEnd(); ++iter)
+    {
+      CPPUNIT_ASSERT_EQUAL(ExpectedValue(iter.GetIndex()), iter.Get());
+    }
+  }
+
+public:
+  void setUp() override
+  {
+    ItkImageType::Pointer itkImage = ItkImageType::New();
+    ItkImageType::SizeType size = {{17, 13, 7}};
+    itkImage->SetRegions(size);
+    itkImage->Allocate();
+
+    itk::ImageRegionIterator<ItkImageType> iter(itkImage, itkImage->GetLargestPossibleRegion());
+    for (; !iter.IsAtEnd(); ++iter)
+    {
+      iter.Set(ExpectedValue(iter.GetIndex()));
+    }
+
+    m_Image = mitk::ImportItkImage(itkImage)->Clone();
+  }
+
+  void tearDown() override { m_Image = nullptr; }
+
+  void TestRegionFromMemory()
+  {
+    mitk::ImageRegionReadAccessor::RegionType region;
+    region.SetIndex(0, 3);
+    region.SetIndex(1, 2);
+    region.SetIndex(2, 1);
+    region.SetSize(0, 5);
+    region.SetSize(1, 4);
+    region.SetSize(2, 3);
+
+    mitk::ImageRegionReadAccessor accessor(m_Image, region);
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(5 * 4 * 3 * sizeof(int)), accessor.GetSize());
+    CheckRegion(accessor);
+  }
+
+  void TestInvalidRegion()
+  {
+    mitk::ImageRegionReadAccessor::RegionType region;
+    region.SetIndex(0, 15);
+    region.SetSize(0, 5);
+    region.SetSize(1, 1);
+    region.SetSize(2, 1);
+
+    CPPUNIT_ASSERT_THROW(mitk::ImageRegionReadAccessor accessor(m_Image, region), mitk::Exception);
+
+    region.SetIndex(0, 0);
+    CPPUNIT_ASSERT_THROW(mitk::ImageRegionReadAccessor accessor(m_Image, region, 1), mitk::Exception);
+  }
+
+  void TestGenerateTiles()
+  {
+    mitk::ImageRegionReadAccessor::RegionType::SizeType tileSize = {{8, 8, 2}};
+    auto tiles = mitk::ImageRegionReadAccessor::GenerateTiles(m_Image, tileSize);
+
+    // 3 x 2 x 4 tiles, the last ones being cropped at the image border
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(24), tiles.size());
+
+    itk::SizeValueType numberOfPixels = 0;
+    for (const auto &tile : tiles)
+    {
+      numberOfPixels += tile.GetNumberOfPixels();
+      mitk::ImageRegionReadAccessor accessor(m_Image, tile);
+      CheckRegion(accessor);
+    }
+    CPPUNIT_ASSERT_EQUAL(static_cast<itk::SizeValueType>(17 * 13 * 7), numberOfPixels);
+  }
+
+  void TestRegionFromFile()
+  {
+    std::string path = mitk::IOUtil::CreateTemporaryFile("RegionAccessorXXXXXX.nrrd");
+    mitk::IOUtil::Save(m_Image, path);
+
+    mitk::ImageFileRegionProvider::Pointer provider = mitk::ImageFileRegionProvider::New();
+    provider->SetFileName(path);
+    mitk::Image::Pointer lazyImage = provider->CreateImage();
+
+    CPPUNIT_ASSERT(lazyImage->GetRegionProvider() == provider.GetPointer());
+    CPPUNIT_ASSERT(!lazyImage->IsVolumeSet(0));
+    CPPUNIT_ASSERT_EQUAL(m_Image->GetDimension(0), lazyImage->GetDimension(0));
+
+    mitk::ImageRegionReadAccessor::RegionType::SizeType tileSize = {{10, 5, 3}};
+    for (const auto &tile : mitk::ImageRegionReadAccessor::GenerateTiles(lazyImage, tileSize))
+    {
+      mitk::ImageRegionReadAccessor accessor(lazyImage, tile);
+      CheckRegion(accessor);
+    }
+
+    // region access must not materialize the volume
+    CPPUNIT_ASSERT(!lazyImage->IsVolumeSet(0));
+
+    std::remove(path.c_str());
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkImageRegionReadAccessor)
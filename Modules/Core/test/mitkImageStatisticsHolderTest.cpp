@@ -0,0 +1,78 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkImageGenerator.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageStatisticsHolder.h>
+#include <mitkTestingMacros.h>
+
+#include <algorithm>
+#include <iterator>
+#include <set>
+#include <vector>
+
+// Computes the expected statistics with a plain serial loop over the raw voxels of time step t
+static void CheckStatistics(mitk::Image *image, int t)
+{
+  const unsigned int *dims = image->GetDimensions();
+  const std::size_t numberOfVoxels =
+    static_cast<std::size_t>(dims[0]) * dims[1] * (image->GetDimension() > 2 ? dims[2] : 1);
+
+  std::vector<short> voxels;
+  {
+    mitk::ImageReadAccessor accessor(image, image->GetVolumeData(t));
+    const short *data = static_cast<const short *>(accessor.GetData());
+    voxels.assign(data, data + numberOfVoxels);
+  }
+  const short *begin = voxels.data();
+
+  std::set<short> values(begin, begin + numberOfVoxels);
+  const double min = *values.begin();
+  const double max = *values.rbegin();
+  const double secondMin = values.size() > 1 ? *std::next(values.begin()) : min;
+  const double secondMax = values.size() > 1 ? *std::next(values.rbegin()) : max;
+  const auto countOfMin = std::count(begin, begin + numberOfVoxels, static_cast<short>(min));
+  const auto countOfMax = std::count(begin, begin + numberOfVoxels, static_cast<short>(max));
+
+  mitk::ImageStatisticsHolder *statistics = image->GetStatistics();
+  MITK_TEST_CONDITION(statistics->GetScalarValueMin(t) == min, "Minimum of time step " << t);
+  MITK_TEST_CONDITION(statistics->GetScalarValueMax(t) == max, "Maximum of time step " << t);
+  MITK_TEST_CONDITION(statistics->GetScalarValue2ndMin(t) == secondMin, "2nd minimum of time step " << t);
+  MITK_TEST_CONDITION(statistics->GetScalarValue2ndMax(t) == secondMax, "2nd maximum of time step " << t);
+  MITK_TEST_CONDITION(statistics->GetCountOfMinValuedVoxels(t) == countOfMin, "Count of minimum of time step " << t);
+  MITK_TEST_CONDITION(statistics->GetCountOfMaxValuedVoxels(t) == countOfMax, "Count of maximum of time step " << t);
+}
+
+int mitkImageStatisticsHolderTest(int, char *[])
+{
+  MITK_TEST_BEGIN("mitkImageStatisticsHolderTest");
+
+  // Large enough to be split into several chunks on multi-core machines
+  mitk::Image::Pointer largeImage =
+    mitk::ImageGenerator::GenerateRandomImage<short>(128, 128, 40, 2, 1, 1, 1, 1000, -1000);
+  CheckStatistics(largeImage, 0);
+  CheckStatistics(largeImage, 1);
+
+  mitk::Image::Pointer smallImage = mitk::ImageGenerator::GenerateRandomImage<short>(16, 16, 4, 1, 1, 1, 1, 3, 0);
+  CheckStatistics(smallImage, 0);
+
+  mitk::Image::Pointer constantImage = mitk::ImageGenerator::GenerateRandomImage<short>(16, 16, 4, 1, 1, 1, 1, 5, 5);
+  CheckStatistics(constantImage, 0);
+  MITK_TEST_CONDITION(constantImage->GetStatistics()->GetScalarValue2ndMax() == 5,
+                      "2nd maximum of a constant image equals its value");
+
+  MITK_TEST_END();
+}
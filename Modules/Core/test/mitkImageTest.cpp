@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkImageGenerator.h"
 #include "mitkImagePixelReadAccessor.h"
 #include "mitkImageReadAccessor.h"
+#include "mitkImageWriteAccessor.h"
 #include "mitkPixelTypeMultiplex.h"
 #include <mitkImage.h>
 #include <mitkImageCast.h>
@@ -483,6 +484,27 @@ int mitkImageTest(int argc, char *argv[])
                                    "Clone (testing dimension " << i << ")");
     }
   }
+  {
+    // clones share their data until one of them is written to
+    mitk::Image::Pointer original = mitk::ImageGenerator::GenerateRandomImage<unsigned char>(8, 8, 4, 2);
+    mitk::Image::Pointer cloneImage = original->Clone();
+    unsigned char originalValue = 0;
+    {
+      mitk::ImageReadAccessor originalAccess(original);
+      mitk::ImageReadAccessor cloneAccess(cloneImage);
+      MITK_TEST_CONDITION_REQUIRED(originalAccess.GetData() == cloneAccess.GetData(), "Clone shares the data");
+      originalValue = static_cast<const unsigned char *>(originalAccess.GetData())[0];
+    }
+    {
+      mitk::ImageWriteAccessor cloneAccess(cloneImage);
+      static_cast<unsigned char *>(cloneAccess.GetData())[0] = originalValue + 1;
+    }
+    mitk::ImageReadAccessor originalAccess(original);
+    mitk::ImageReadAccessor cloneAccess(cloneImage);
+    MITK_TEST_CONDITION_REQUIRED(originalAccess.GetData() != cloneAccess.GetData(), "Clone is copied on write");
+    MITK_TEST_CONDITION(static_cast<const unsigned char *>(originalAccess.GetData())[0] == originalValue,
+                        "Writing to the clone does not modify the original");
+  }
   // access via itk
   if (image->GetDimension() > 3) // CastToItk only works with 3d images so we need to check for 4d images
   {
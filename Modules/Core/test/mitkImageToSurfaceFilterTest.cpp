@@ -48,6 +48,7 @@ class mitkImageToSurfaceFilterTestSuite : public mitk::TestFixture
   MITK_TEST(testDecimatePromeshDecimation);
   MITK_TEST(testQuadricDecimation);
   MITK_TEST(testSmoothingOfSurface);
+  MITK_TEST(testParallelSurfaceGeneration);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -149,6 +150,27 @@ public:
     CPPUNIT_ASSERT_MESSAGE("Testing smoothing of surface changes point data!",
                            CompareSurfacePointPositions(testSurface1, testSurface4));
   }
+
+  void testParallelSurfaceGeneration()
+  {
+    mitk::ImageToSurfaceFilter::Pointer testObject = mitk::ImageToSurfaceFilter::New();
+    testObject->SetInput(m_BallImage);
+    testObject->SetNumberOfThreads(1);
+    testObject->Update();
+    mitk::Surface::Pointer singleThreadSurface = testObject->GetOutput()->Clone();
+
+    testObject->SetNumberOfThreads(3);
+    testObject->Update();
+    mitk::Surface::Pointer slabSurface = testObject->GetOutput()->Clone();
+
+    vtkPolyData *singleThreadPolyData = singleThreadSurface->GetVtkPolyData();
+    vtkPolyData *slabPolyData = slabSurface->GetVtkPolyData();
+    CPPUNIT_ASSERT_MESSAGE("Testing that the ball surface is not empty!", singleThreadPolyData->GetNumberOfPoints() > 0);
+    CPPUNIT_ASSERT_MESSAGE("Testing that slab seams are merged!",
+                           singleThreadPolyData->GetNumberOfPoints() == slabPolyData->GetNumberOfPoints());
+    CPPUNIT_ASSERT_MESSAGE("Testing that slabs produce all triangles!",
+                           singleThreadPolyData->GetNumberOfPolys() == slabPolyData->GetNumberOfPolys());
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkImageToSurfaceFilter)
@@ -21,12 +21,15 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkIOUtil.h"
 #include "mitkITKImageImport.h"
+#include <mitkImageWriteAccessor.h>
+#include <mitkItkImageIO.h>
 #include <mitkExtractSliceFilter.h>
 
 #include "itksys/SystemTools.hxx"
 #include <itkImageRegionIterator.h>
 
 #include <fstream>
+#include <future>
 #include <iostream>
 
 #ifdef WIN32
@@ -47,6 +50,9 @@ class mitkItkImageIOTestSuite : public mitk::TestFixture
   MITK_TEST(TestWrite3DImageWithTwoPlanes);
   MITK_TEST(TestWrite3DplusT_ArbitraryTG);
   MITK_TEST(TestWrite3DplusT_ProportionalTG);
+  MITK_TEST(TestMemoryMappedReading);
+  MITK_TEST(TestParallelCompressedWriting);
+  MITK_TEST(TestSaveAsync);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -66,6 +72,41 @@ public:
     TestImageWriter("3D+t-ITKIO-TestData/LinearModel_4D_prop_time_geometry.nrrd");
   }
 
+  void TestMemoryMappedReading()
+  {
+    mitk::Image::Pointer image = mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("Pic3D.nrrd"));
+
+    // NIfTI is written uncompressed if the file name does not end with .gz
+    std::string tmpFilePath = mitk::IOUtil::CreateTemporaryFile("MemoryMappedXXXXXX.nii");
+    mitk::IOUtil::Save(image, tmpFilePath);
+
+    mitk::IFileReader::Options options;
+    options[mitk::ItkImageIO::OPTION_MEMORY_MAPPED()] = us::Any(true);
+
+    {
+      mitk::Image::Pointer readImage = mitk::IOUtil::Load<mitk::Image>(tmpFilePath);
+      mitk::Image::Pointer mappedImage = mitk::IOUtil::Load<mitk::Image>(tmpFilePath, options);
+
+      CPPUNIT_ASSERT_MESSAGE("Image data is read if not requested otherwise",
+                             readImage->GetChannelData(0)->GetMemoryHolder() == nullptr);
+      CPPUNIT_ASSERT_MESSAGE("Image data is memory mapped",
+                             mappedImage->GetChannelData(0)->GetMemoryHolder() != nullptr);
+      CPPUNIT_ASSERT_MESSAGE("Memory mapped image equals read image",
+                             mitk::Equal(*readImage, *mappedImage, mitk::eps, true));
+
+      // writing must never change the file
+      {
+        mitk::ImageWriteAccessor accessor(mappedImage);
+        static_cast<unsigned char *>(accessor.GetData())[0] += 1;
+      }
+      mitk::Image::Pointer reloadedImage = mitk::IOUtil::Load<mitk::Image>(tmpFilePath, options);
+      CPPUNIT_ASSERT_MESSAGE("Memory mapped file is unchanged after writing to the image",
+                             mitk::Equal(*readImage, *reloadedImage, mitk::eps, true));
+    }
+
+    std::remove(tmpFilePath.c_str());
+  }
+
   void TestImageWriterSimple()
   {
     // TODO
@@ -328,6 +369,81 @@ public:
   /**
   * Try to write a 3D image with only one plane (a 2D images in disguise for all intents and purposes)
   */
+  /** 32 MiB image, large enough to be compressed by several threads */
+  mitk::Image::Pointer CreateLargeImage()
+  {
+    typedef itk::Image<short, 3> ImageType;
+
+    ImageType::Pointer itkImage = ImageType::New();
+    ImageType::SizeType size;
+    size[0] = 256;
+    size[1] = 256;
+    size[2] = 256;
+    ImageType::RegionType region;
+    region.SetSize(size);
+    itkImage->SetRegions(region);
+    itkImage->Allocate();
+
+    itk::ImageRegionIterator<ImageType> imageIterator(itkImage, itkImage->GetLargestPossibleRegion());
+    unsigned int value = 1;
+    for (; !imageIterator.IsAtEnd(); ++imageIterator)
+    {
+      // some noise on a gradient, so that the compressed data is not trivial
+      value = value * 1103515245 + 12345;
+      imageIterator.Set(static_cast<short>(imageIterator.GetIndex()[2] * 10 + (value >> 28)));
+    }
+
+    return mitk::ImportItkImage(itkImage)->Clone();
+  }
+
+  void TestParallelCompressedWriting()
+  {
+    mitk::Image::Pointer image = CreateLargeImage();
+
+    for (const std::string extension : {".nrrd", ".nii.gz"})
+    {
+      std::string tmpFilePath = mitk::IOUtil::CreateTemporaryFile("ParallelGzipXXXXXX" + extension);
+      mitk::IOUtil::Save(image, tmpFilePath);
+
+      const std::string rawFilePath = tmpFilePath + (extension == ".nrrd" ? ".raw.nrrd" : ".raw.nii");
+      const unsigned long imageSize = image->GetPixelType().GetSize() * 256 * 256 * 256;
+      CPPUNIT_ASSERT_MESSAGE("Image is written compressed", itksys::SystemTools::FileLength(tmpFilePath) < imageSize);
+      CPPUNIT_ASSERT_MESSAGE("Uncompressed intermediate file is removed",
+                             !itksys::SystemTools::FileExists(rawFilePath));
+
+      mitk::Image::Pointer readImage = mitk::IOUtil::Load<mitk::Image>(tmpFilePath);
+      CPPUNIT_ASSERT_MESSAGE("Image written with parallel compression is read correctly (" + extension + ")",
+                             mitk::Equal(*image, *readImage, mitk::eps, true));
+
+      std::remove(tmpFilePath.c_str());
+    }
+  }
+
+  void TestSaveAsync()
+  {
+    mitk::Image::Pointer image = CreateLargeImage();
+    mitk::Image::Pointer reference = image->Clone();
+
+    std::string tmpFilePath = mitk::IOUtil::CreateTemporaryFile("SaveAsyncXXXXXX.nrrd");
+    std::future<void> saved = mitk::IOUtil::SaveAsync(image, tmpFilePath);
+
+    // modifying the image while it is being written must not change the written file
+    {
+      mitk::ImageWriteAccessor accessor(image);
+      static_cast<short *>(accessor.GetData())[0] += 1;
+    }
+    saved.get();
+
+    mitk::Image::Pointer readImage = mitk::IOUtil::Load<mitk::Image>(tmpFilePath);
+    CPPUNIT_ASSERT_MESSAGE("Snapshot of the image at the time of SaveAsync is written",
+                           mitk::Equal(*reference, *readImage, mitk::eps, true));
+    std::remove(tmpFilePath.c_str());
+
+    CPPUNIT_ASSERT_THROW(mitk::IOUtil::SaveAsync(image, "no_writer_for.this_extension"), mitk::Exception);
+    CPPUNIT_ASSERT_THROW(mitk::IOUtil::SaveAsync(image, tmpFilePath + ".nonexisting/file.nrrd").get(),
+                         mitk::Exception);
+  }
+
   void TestWrite3DImageWithOnePlane()
   {
     typedef itk::Image<unsigned char, 3> ImageType;
@@ -22,6 +22,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkNumericTypes.h>
 #include <mitkStandardFileLocations.h>
 
+#include <fstream>
+#include <thread>
+
 /** Documentation
  *
  * @brief this class provides an accessible BackendCout to determine whether this backend was
@@ -259,6 +262,77 @@ public:
     // TODO delete log file?
   }
 
+  static unsigned int CountLinesInLogFile(const std::string &filename, const std::string &marker)
+  {
+    std::ifstream file(filename.c_str());
+    std::string line;
+    unsigned int count = 0;
+    while (std::getline(file, line))
+    {
+      if (line.find(marker) != std::string::npos)
+        ++count;
+    }
+    return count;
+  }
+
+  static void TestAsynchronousLogging()
+  {
+    std::string filename = mitk::StandardFileLocations::GetInstance()->GetOptionDirectory() + "/testasynclog.log";
+    itksys::SystemTools::RemoveFile(filename.c_str());
+    mitk::LoggingBackend::SetLogFile(filename.c_str());
+
+    mitk::LoggingBackend::SetAsynchronous(true);
+    MITK_TEST_CONDITION(mitk::LoggingBackend::IsAsynchronous(), "Asynchronous mode is enabled.");
+
+    const unsigned int numberOfThreads = 4;
+    const unsigned int numberOfMessages = 1000;
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < numberOfThreads; ++t)
+    {
+      threads.emplace_back([t, numberOfMessages]() {
+        for (unsigned int i = 0; i < numberOfMessages; ++i)
+          MITK_INFO << "async test message " << t << " " << i;
+      });
+    }
+    for (auto &thread : threads)
+      thread.join();
+
+    mitk::LoggingBackend::Flush();
+    MITK_TEST_CONDITION(CountLinesInLogFile(filename, "async test message") == numberOfThreads * numberOfMessages,
+                        "All asynchronous messages were written after Flush().");
+
+    mitk::LoggingBackend::SetAsynchronous(false);
+    MITK_TEST_CONDITION(!mitk::LoggingBackend::IsAsynchronous(), "Asynchronous mode is disabled.");
+    mitk::LoggingBackend::SetLogFile(nullptr);
+  }
+
+  static void TestMessageRateLimit()
+  {
+    std::string filename = mitk::StandardFileLocations::GetInstance()->GetOptionDirectory() + "/testratelimitlog.log";
+    itksys::SystemTools::RemoveFile(filename.c_str());
+    mitk::LoggingBackend::SetLogFile(filename.c_str());
+
+    const unsigned int numberOfMessages = 1000;
+    const unsigned long long suppressedBefore = mitk::LoggingBackend::GetNumberOfSuppressedMessages();
+
+    mitk::LoggingBackend::SetMessageRateLimit(10);
+    for (unsigned int i = 0; i < numberOfMessages; ++i)
+      MITK_INFO << "rate limited test message";
+    for (unsigned int i = 0; i < numberOfMessages; ++i)
+      MITK_ERROR << "unlimited test message";
+    mitk::LoggingBackend::SetMessageRateLimit(0);
+    mitk::LoggingBackend::Flush();
+
+    const unsigned long long suppressed = mitk::LoggingBackend::GetNumberOfSuppressedMessages() - suppressedBefore;
+    const unsigned int written = CountLinesInLogFile(filename, "rate limited test message");
+    MITK_TEST_CONDITION(suppressed > 0, "Messages exceeding the rate limit were suppressed.");
+    MITK_TEST_CONDITION(written + suppressed == numberOfMessages, "Every message was either written or suppressed.");
+    MITK_TEST_CONDITION(CountLinesInLogFile(filename, "unlimited test message") == numberOfMessages,
+                        "Errors are not rate limited.");
+
+    mitk::LoggingBackend::SetLogFile(nullptr);
+  }
+
   static void TestAddAndRemoveBackends()
   {
     mbilog::BackendCout myBackend = mbilog::BackendCout();
@@ -309,6 +383,8 @@ int mitkLogTest(int /* argc */, char * /*argv*/ [])
   mitkLogTestClass::TestThreadSaveLog(false); // false = to console
   mitkLogTestClass::TestThreadSaveLog(true);  // true = to file
   mitkLogTestClass::TestEnableDisableBackends();
+  mitkLogTestClass::TestAsynchronousLogging();
+  mitkLogTestClass::TestMessageRateLimit();
   // TODO actually test file somehow?
 
   // always end with this!
@@ -0,0 +1,49 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#include <mitkModuleActivationProfile.h>
+#include <mitkTestingMacros.h>
+
+#include <sstream>
+
+int mitkModuleActivationProfileTest(int, char *[])
+{
+  MITK_TEST_BEGIN("mitkModuleActivationProfileTest");
+
+  std::vector<mitk::ModuleActivationProfile::Entry> entries = mitk::ModuleActivationProfile::GetEntries();
+  MITK_TEST_CONDITION_REQUIRED(!entries.empty(), "The profile lists the loaded modules");
+
+  bool foundCore = false;
+  bool sorted = true;
+  for (std::size_t i = 0; i < entries.size(); ++i)
+  {
+    if (entries[i].ModuleName == "MitkCore")
+      foundCore = !entries[i].Pending && entries[i].ActivationTime >= 0.0;
+    if (i > 0 && entries[i - 1].ActivationTime < entries[i].ActivationTime)
+      sorted = false;
+  }
+  MITK_TEST_CONDITION(foundCore, "MitkCore is listed as activated");
+  MITK_TEST_CONDITION(sorted, "Entries are sorted by descending activation time");
+
+  std::ostringstream stream;
+  mitk::ModuleActivationProfile::Print(stream);
+  MITK_TEST_CONDITION(stream.str().find("MitkCore") != std::string::npos &&
+                        stream.str().find("total activation time") != std::string::npos,
+                      "Printed report lists the modules and the total");
+
+  MITK_TEST_END();
+}
@@ -287,6 +287,37 @@ int mitkPropertyListTest(int /*argc*/, char * /*argv*/ [])
     return EXIT_FAILURE;
   }
 
+  {
+    std::cout << "Testing GetProperty() with interned keys: ";
+    mitk::PropertyList::Pointer keyList = mitk::PropertyList::New();
+    for (int i = 0; i < 100; ++i)
+      keyList->SetProperty("prop" + std::to_string(i), mitk::IntProperty::New(i));
+    keyList->DeleteProperty("prop50");
+    keyList->ReplaceProperty("prop7", mitk::StringProperty::New("seven"));
+
+    const mitk::PropertyKey key7("prop7");
+    const mitk::PropertyKey key42("prop42");
+    const mitk::PropertyKey key50("prop50");
+    mitk::PropertyList::Pointer clonedList = keyList->Clone();
+    auto prop42 = dynamic_cast<mitk::IntProperty *>(clonedList->GetProperty(key42));
+
+    if (keyList->GetProperty(key7) != keyList->GetMap()->find("prop7")->second ||
+        dynamic_cast<mitk::StringProperty *>(keyList->GetProperty("prop7")) == nullptr ||
+        keyList->GetProperty(key50) != nullptr || keyList->GetProperty(std::string("prop50")) != nullptr ||
+        prop42 == nullptr || prop42->GetValue() != 42 || keyList->GetProperty(static_cast<const char *>(nullptr)) != nullptr)
+    {
+      std::cout << "[FAILED]" << std::endl;
+      return EXIT_FAILURE;
+    }
+    keyList->Clear();
+    if (keyList->GetProperty(key42) != nullptr)
+    {
+      std::cout << "[FAILED]" << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cout << "[PASSED]" << std::endl;
+  }
+
   std::cout << "[TEST DONE]" << std::endl;
   return EXIT_SUCCESS;
 }
@@ -21,6 +21,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkInteractionConst.h"
 #include "mitkRotationOperation.h"
 #include "mitkTestingMacros.h"
+
+#include <vtkImageData.h>
+
+#include <algorithm>
+#include <cstring>
 #include <ctime>
 
 /*
@@ -82,6 +87,41 @@ int mitkRotatedSlice4DTest(int, char *argv[])
     ss << " : Valid slice in timestep " << ts;
 
     MITK_TEST_CONDITION_REQUIRED(extractedPlane.IsNotNull(), ss.str().c_str());
+
+    // a slice of the 4D image resliced after DetachReslicer() has to be identical to the regular one
+    mitk::BaseGeometry *timeStepGeometry = image4D->GetTimeGeometry()->GetGeometryForTimeStep(ts);
+    mitk::ExtractSliceFilter::Pointer regularExtractor = mitk::ExtractSliceFilter::New();
+    regularExtractor->SetInput(image4D);
+    regularExtractor->SetWorldGeometry(plane);
+    regularExtractor->SetTimeStep(ts);
+    regularExtractor->SetResliceTransformByGeometry(timeStepGeometry);
+    regularExtractor->SetVtkOutputRequest(true);
+    regularExtractor->Update();
+    vtkImageData *regularSlice = regularExtractor->GetVtkOutput();
+
+    mitk::ExtractSliceFilter::Pointer detachedExtractor = mitk::ExtractSliceFilter::New();
+    detachedExtractor->SetInput(image4D);
+    detachedExtractor->SetWorldGeometry(plane);
+    detachedExtractor->SetTimeStep(ts);
+    detachedExtractor->SetResliceTransformByGeometry(timeStepGeometry);
+    detachedExtractor->SetVtkOutputRequest(true);
+    detachedExtractor->SetResliceGeometryOnly(true);
+    detachedExtractor->Update();
+    MITK_TEST_CONDITION_REQUIRED(detachedExtractor->DetachReslicer(), "Detaching the reslicer");
+    detachedExtractor->ResliceDetached();
+    vtkImageData *detachedSlice = detachedExtractor->GetVtkOutput();
+
+    int regularDimensions[3], detachedDimensions[3];
+    regularSlice->GetDimensions(regularDimensions);
+    detachedSlice->GetDimensions(detachedDimensions);
+    const bool sameDimensions = std::equal(regularDimensions, regularDimensions + 3, detachedDimensions);
+    MITK_TEST_CONDITION_REQUIRED(sameDimensions, "Detached slice has the dimensions of the regular slice");
+
+    const std::size_t sliceSize = regularSlice->GetNumberOfPoints() * regularSlice->GetScalarSize() *
+                                  regularSlice->GetNumberOfScalarComponents();
+    MITK_TEST_CONDITION(
+      std::memcmp(regularSlice->GetScalarPointer(), detachedSlice->GetScalarPointer(), sliceSize) == 0,
+      "Detached slice has the voxels of the regular slice in timestep " << ts);
   }
   MITK_TEST_END();
 }
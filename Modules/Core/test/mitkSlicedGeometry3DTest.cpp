@@ -169,6 +169,28 @@ int mitkSlicedGeometry3DTest(int, char *[])
   MITK_TEST_OUTPUT(<< "Check if origin of last PlaneGeometry is at expected location");
   MITK_TEST_CONDITION_REQUIRED(mitk::Equal(lastPlaneGeometry->GetOrigin(), expectedOriginOfLastSlice, slicedGeometryEps), "");
 
+  MITK_TEST_OUTPUT(<< "Check if analytically derived slice origins match the PlaneGeometries");
+  bool originsMatch = true;
+  for (int s = 0; s < numberOfSlices; ++s)
+  {
+    mitk::Point3D origin;
+    originsMatch &= slicedGeometry->GetSliceOrigin(s, origin) &&
+                    mitk::Equal(origin, slicedGeometry->GetPlaneGeometry(s)->GetOrigin(), slicedGeometryEps);
+  }
+  mitk::Point3D invalidOrigin;
+  MITK_TEST_CONDITION_REQUIRED(originsMatch, "");
+  MITK_TEST_CONDITION_REQUIRED(!slicedGeometry->GetSliceOrigin(numberOfSlices, invalidOrigin), "");
+
+  MITK_TEST_OUTPUT(<< "Check if derived slices follow a moved first slice");
+  auto movedSlicedGeometry = createEvenlySpacedSlicedGeometry(planeGeometry->Clone(), thicknessInMM, numberOfSlices);
+  mitk::Point3D secondOrigin;
+  movedSlicedGeometry->GetSliceOrigin(1, secondOrigin);
+  movedSlicedGeometry->GetPlaneGeometry(0)->SetOrigin(createPoint(10.0, 0.0, 0.0));
+  movedSlicedGeometry->GetSliceOrigin(1, secondOrigin);
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(secondOrigin, createPoint(10.0, 0.0, thicknessInMM), slicedGeometryEps), "");
+  MITK_TEST_CONDITION_REQUIRED(
+    mitk::Equal(movedSlicedGeometry->GetPlaneGeometry(1)->GetOrigin(), secondOrigin, slicedGeometryEps), "");
+
   mitkSlicedGeometry3D_ChangeImageGeometryConsideringOriginOffset_Test();
 
   std::cout << "[TEST DONE]" << std::endl;
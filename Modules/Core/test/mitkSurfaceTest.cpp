@@ -15,13 +15,17 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "mitkCommon.h"
+#include "mitkIOUtil.h"
 #include "mitkNumericTypes.h"
 #include "mitkSurface.h"
 #include "mitkTestingMacros.h"
 
+#include "vtkPoints.h"
 #include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
 #include "vtkSphereSource.h"
 
+#include <cstdio>
 #include <fstream>
 
 int mitkSurfaceTest(int /*argc*/, char * /*argv*/ [])
@@ -142,6 +146,74 @@ int mitkSurfaceTest(int /*argc*/, char * /*argv*/ [])
     dummy->GetTimeSteps() == numberoftimesteps,
     "orig-numberofTimeSteps:" << numberoftimesteps << "  copy-numberofTimeSteps:" << dummy->GetTimeSteps());
 
+  // 3D+t surface with shared topology: a sphere whose radius grows per time step
+  {
+    sphereSource = vtkSphereSource::New();
+    sphereSource->SetRadius(10.0);
+    sphereSource->Update();
+    mitk::Surface::Pointer dynamicSurface = mitk::Surface::New();
+    dynamicSurface->SetVtkPolyData(sphereSource->GetOutput());
+    sphereSource->Delete();
+    vtkPolyData *topology = dynamicSurface->GetVtkPolyData(0);
+
+    for (unsigned int t = 1; t < 4; ++t)
+    {
+      vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+      points->DeepCopy(topology->GetPoints());
+      for (vtkIdType i = 0; i < points->GetNumberOfPoints(); ++i)
+      {
+        double point[3];
+        points->GetPoint(i, point);
+        points->SetPoint(i, point[0] * (1 + t), point[1] * (1 + t), point[2] * (1 + t));
+      }
+      dynamicSurface->SetVtkPolyDataWithSharedTopology(points, t);
+    }
+
+    MITK_TEST_CONDITION_REQUIRED(dynamicSurface->HasSharedTopology(), "Testing surface with shared topology");
+    MITK_TEST_CONDITION_REQUIRED(dynamicSurface->GetVtkPolyData(3)->GetPolys() == topology->GetPolys(),
+                                 "Testing that time steps reference the cells of time step 0");
+    const double extent = dynamicSurface->GetGeometry(0)->GetExtentInMM(0);
+    MITK_TEST_CONDITION_REQUIRED(mitk::Equal(dynamicSurface->GetGeometry(3)->GetExtentInMM(0), 4 * extent),
+                                 "Testing bounding box of a time step with shared topology");
+
+    vtkSmartPointer<vtkPoints> wrongPoints = vtkSmartPointer<vtkPoints>::New();
+    wrongPoints->InsertNextPoint(0, 0, 0);
+    MITK_TEST_FOR_EXCEPTION(mitk::Exception, dynamicSurface->SetVtkPolyDataWithSharedTopology(wrongPoints, 1));
+
+    mitk::Surface::Pointer clonedSurface = dynamicSurface->Clone();
+    MITK_TEST_CONDITION_REQUIRED(clonedSurface->HasSharedTopology() &&
+                                   clonedSurface->GetVtkPolyData(1)->GetPolys() != topology->GetPolys(),
+                                 "Testing that a clone shares its own copy of the topology");
+
+    // separately created time steps with equal cells are merged
+    mitk::Surface::Pointer separateSurface = mitk::Surface::New();
+    for (unsigned int t = 0; t < 3; ++t)
+    {
+      vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+      polyData->DeepCopy(dynamicSurface->GetVtkPolyData(t));
+      separateSurface->SetVtkPolyData(polyData, t);
+    }
+    MITK_TEST_CONDITION_REQUIRED(!separateSurface->HasSharedTopology(), "Testing surface with separate topologies");
+    MITK_TEST_CONDITION_REQUIRED(separateSurface->ShareTopology() == 3 && separateSurface->HasSharedTopology(),
+                                 "Testing ShareTopology()");
+
+    // all time steps are written into one VTK XML file
+    std::string path = mitk::IOUtil::CreateTemporaryFile("SharedTopologyXXXXXX.vtp");
+    mitk::IOUtil::Save(dynamicSurface, path);
+    mitk::Surface::Pointer readSurface = mitk::IOUtil::Load<mitk::Surface>(path);
+    std::remove(path.c_str());
+
+    MITK_TEST_CONDITION_REQUIRED(readSurface->GetTimeSteps() == 4 && readSurface->HasSharedTopology(),
+                                 "Testing reading a surface with shared topology");
+    bool equal = true;
+    for (unsigned int t = 0; t < 4; ++t)
+    {
+      equal =
+        equal && mitk::Equal(*readSurface->GetVtkPolyData(t), *dynamicSurface->GetVtkPolyData(t), mitk::eps, true);
+    }
+    MITK_TEST_CONDITION_REQUIRED(equal, "Testing time steps of the read surface");
+  }
+
   surface = nullptr;
   MITK_TEST_CONDITION_REQUIRED(surface.IsNull(), "Testing destruction of surface!");
 
@@ -30,6 +30,7 @@ class mitkSurfaceToImageFilterTestSuite : public mitk::TestFixture
   MITK_TEST(test3DSurfaceValidOutput);
   MITK_TEST(test3DSurfaceCorrect);
   MITK_TEST(test3DSurfaceIn4DImage);
+  MITK_TEST(test3DSurfaceSlabsAndReusedStencilMatchSingleThread);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -253,5 +254,39 @@ public:
 
     CPPUNIT_ASSERT_MESSAGE("SurfaceToImageFilter_BallSurfaceAsInput_Output4DCorrect", valuesCorrect == true);
   }
+
+  mitk::Image::Pointer Voxelize(mitk::SurfaceToImageFilter *surfaceToImageFilter, unsigned int numberOfThreads)
+  {
+    mitk::Image::Pointer additionalInputImage = mitk::Image::New();
+    unsigned int dims[3] = {32, 32, 32};
+    additionalInputImage->Initialize(mitk::MakeScalarPixelType<unsigned int>(), 3, dims);
+    additionalInputImage->GetGeometry()->SetIndexToWorldTransform(m_Surface->GetGeometry()->GetIndexToWorldTransform());
+
+    surfaceToImageFilter->MakeOutputBinaryOn();
+    surfaceToImageFilter->SetNumberOfThreads(numberOfThreads);
+    surfaceToImageFilter->SetInput(m_Surface);
+    surfaceToImageFilter->SetImage(additionalInputImage);
+    surfaceToImageFilter->Update();
+
+    mitk::Image::Pointer output = surfaceToImageFilter->GetOutput();
+    output->DisconnectPipeline();
+    return output;
+  }
+
+  void test3DSurfaceSlabsAndReusedStencilMatchSingleThread()
+  {
+    mitk::Image::Pointer singleThreadOutput = Voxelize(mitk::SurfaceToImageFilter::New(), 1);
+
+    mitk::SurfaceToImageFilter::Pointer surfaceToImageFilter = mitk::SurfaceToImageFilter::New();
+    surfaceToImageFilter->ReuseStencilOn();
+    mitk::Image::Pointer slabOutput = Voxelize(surfaceToImageFilter, 4);
+    CPPUNIT_ASSERT_MESSAGE("SurfaceToImageFilter_BallSurfaceAsInput_SlabsMatchSingleThread",
+                           mitk::Equal(*singleThreadOutput, *slabOutput, 0, true));
+
+    // Same surface and geometry, but a new reference image: the stencil is reused
+    mitk::Image::Pointer reusedOutput = Voxelize(surfaceToImageFilter, 4);
+    CPPUNIT_ASSERT_MESSAGE("SurfaceToImageFilter_BallSurfaceAsInput_ReusedStencilMatchesSingleThread",
+                           mitk::Equal(*singleThreadOutput, *reusedOutput, 0, true));
+  }
 };
 MITK_TEST_SUITE_REGISTRATION(mitkSurfaceToImageFilter)
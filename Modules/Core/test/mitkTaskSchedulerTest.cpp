@@ -0,0 +1,116 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkTaskScheduler.h>
+#include <mitkTestingMacros.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+int mitkTaskSchedulerTest(int, char *[])
+{
+  MITK_TEST_BEGIN("mitkTaskSchedulerTest");
+
+  {
+    mitk::TaskScheduler scheduler(1);
+
+    // keeps the only worker busy until everything else is queued
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool released = false;
+    scheduler.Submit([&] {
+      std::unique_lock<std::mutex> lock(mutex);
+      condition.wait(lock, [&] { return released; });
+    });
+
+    std::vector<int> order;
+    auto background = scheduler.Submit([&] { order.push_back(2); }, mitk::TaskScheduler::BackgroundPriority);
+    auto interactive = scheduler.Submit([&] { order.push_back(1); }, mitk::TaskScheduler::InteractivePriority);
+    auto canceled = scheduler.Submit([&] { order.push_back(3); });
+    MITK_TEST_CONDITION(canceled->Cancel(), "A queued task can be canceled");
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      released = true;
+    }
+    condition.notify_all();
+
+    background->Wait();
+    interactive->Wait();
+    canceled->Wait();
+
+    MITK_TEST_CONDITION(order.size() == 2 && order[0] == 1 && order[1] == 2, "Higher priorities run first");
+    MITK_TEST_CONDITION(canceled->GetState() == mitk::Task::Canceled, "A canceled task does not run");
+
+    std::atomic<int> value(0);
+    auto outer = scheduler.Submit([&] {
+      auto inner = scheduler.Submit([&] { value = 1; });
+      inner->Wait();
+      value += 1;
+    });
+    outer->Wait();
+    MITK_TEST_CONDITION(value == 2, "Waiting for a subtask on the only worker runs the subtask");
+  }
+
+  {
+    mitk::TaskScheduler scheduler(4);
+
+    int data = 0;
+    std::atomic<int> running(0);
+    std::atomic<bool> overlapping(false);
+
+    std::vector<mitk::TaskScheduler::TaskPointer> tasks;
+    for (int i = 0; i < 40; ++i)
+    {
+      const bool write = i % 4 == 0;
+      std::vector<mitk::TaskScheduler::Resource> resources;
+      resources.push_back(mitk::TaskScheduler::Resource(
+        &data, write ? mitk::TaskScheduler::WriteAccess : mitk::TaskScheduler::ReadAccess));
+
+      tasks.push_back(scheduler.Submit(
+        [&, write] {
+          if (++running > 1 && write)
+            overlapping = true;
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          --running;
+        },
+        mitk::TaskScheduler::NormalPriority,
+        resources));
+    }
+
+    for (const auto &task : tasks)
+      task->Wait();
+
+    MITK_TEST_CONDITION(!overlapping, "Tasks writing data do not run together with other tasks accessing it");
+
+    auto canceling = scheduler.Submit([] {
+      while (!mitk::TaskScheduler::IsCurrentTaskCanceled())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+    while (canceling->GetState() == mitk::Task::Queued)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    MITK_TEST_CONDITION(!canceling->Cancel(), "A running task is not removed when canceled");
+    canceling->Wait();
+    MITK_TEST_CONDITION(canceling->GetState() == mitk::Task::Canceled, "A running task can be asked to stop");
+  }
+
+  MITK_TEST_CONDITION(mitk::TaskScheduler::GetInstance()->GetNumberOfThreads() >= 1,
+                      "The shared scheduler has at least one thread");
+
+  MITK_TEST_END();
+}
@@ -0,0 +1,67 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkTracer.h>
+
+#include <sstream>
+
+int mitkTracerTest(int, char *[])
+{
+  MITK_TEST_BEGIN("mitkTracerTest");
+
+  mitk::Tracer *tracer = mitk::Tracer::GetInstance();
+  const bool wasEnabled = tracer->IsEnabled();
+
+  tracer->SetEnabled(false);
+  tracer->Clear();
+  {
+    mitk::TraceScope scope("Test", "disabled");
+  }
+  MITK_TEST_CONDITION(tracer->GetEvents().empty(), "No events are recorded while tracing is disabled");
+
+  tracer->SetEnabled(true);
+  {
+    mitk::TraceScope scope("Test", "scope \"quoted\"");
+    scope.SetDataSize(1024);
+    scope.SetNodeName("node");
+  }
+  std::vector<mitk::Tracer::Event> events = tracer->GetEvents();
+  MITK_TEST_CONDITION_REQUIRED(events.size() == 1, "One event is recorded while tracing is enabled");
+  MITK_TEST_CONDITION(events[0].Category == "Test" && events[0].DataSize == 1024 && events[0].NodeName == "node",
+                      "Event carries category, data size and node name");
+  MITK_TEST_CONDITION(events[0].Duration >= 0 && events[0].ThreadId == mitk::Tracer::GetCurrentThreadId(),
+                      "Event carries duration and thread id");
+
+  std::ostringstream stream;
+  tracer->WriteChromeTrace(stream);
+  MITK_TEST_CONDITION(stream.str().find("\"traceEvents\"") != std::string::npos &&
+                        stream.str().find("\"name\":\"scope \\\"quoted\\\"\"") != std::string::npos,
+                      "Chrome trace contains the escaped event");
+
+  tracer->SetMaximumNumberOfEvents(1);
+  {
+    mitk::TraceScope scope("Test", "dropped");
+  }
+  MITK_TEST_CONDITION(tracer->GetEvents().size() == 1 && tracer->GetNumberOfDroppedEvents() == 1,
+                      "Events beyond the maximum are dropped");
+
+  tracer->SetMaximumNumberOfEvents(1000000);
+  tracer->Clear();
+  tracer->SetEnabled(wasEnabled);
+
+  MITK_TEST_END();
+}
@@ -35,6 +35,7 @@ namespace mitk
   public:
     TestOperation(OperationType operationType) : Operation(operationType) { g_GlobalCounter++; };
     ~TestOperation() override { g_GlobalCounter--; };
+    std::size_t GetMemorySize() const override { return 1000; }
   };
 } // namespace
 
@@ -124,6 +125,35 @@ int mitkVerboseLimitedLinearUndoTest(int /* argc */, char * /*argv*/ [])
   }
   MITK_TEST_CONDITION_REQUIRED(g_GlobalCounter == 4, "checking added operations in UndoModel");
 
+  // limit the memory to a bit more than two OperationEvents (2 * 2 * 1000 bytes plus overhead)
+  myUndoController->SetMemoryLimit(5000);
+  MITK_TEST_CONDITION_REQUIRED(myUndoController->GetMemoryLimit() == 5000, "checking memory limit");
+  for (int i = 0; i < 3; i++)
+  {
+    auto doOp = new mitk::TestOperation(mitk::OpTEST);
+    auto undoOp = new mitk::TestOperation(mitk::OpTEST);
+    mitk::OperationEvent *operationEvent = new mitk::OperationEvent(nullptr, doOp, undoOp, "Test");
+    myUndoController->SetOperationEvent(operationEvent);
+    mitk::OperationEvent::IncCurrObjectEventId();
+  }
+  MITK_TEST_CONDITION_REQUIRED(g_GlobalCounter == 4, "checking that oldest operations are dropped at the memory limit");
+  MITK_TEST_CONDITION_REQUIRED(myUndoController->GetCurrentUndoModel()->GetMemorySize() <= 5000,
+                               "checking memory size of UndoModel");
+
+  // the most recent OperationEvent is always kept
+  myUndoController->SetMemoryLimit(1);
+  MITK_TEST_CONDITION_REQUIRED(g_GlobalCounter == 2, "checking that the latest operation is kept");
+  myUndoController->SetMemoryLimit(0);
+
+  // sending one more OperationEvent to restore the state expected below
+  {
+    auto doOp = new mitk::TestOperation(mitk::OpTEST);
+    auto undoOp = new mitk::TestOperation(mitk::OpTEST);
+    myUndoController->SetOperationEvent(new mitk::OperationEvent(nullptr, doOp, undoOp, "Test"));
+    mitk::OperationEvent::IncCurrObjectEventId();
+  }
+  MITK_TEST_CONDITION_REQUIRED(g_GlobalCounter == 4, "checking added operations without memory limit");
+
   delete myUndoController;
 
   // after deleting UndoController g_GlobalCounter will still be 4 because m_CurrentUndoModel inside myUndoModel is a
@@ -0,0 +1,193 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include <vtkMitkIndexedPlaneCutter.h>
+
+#include <vtkCutter.h>
+#include <vtkPlane.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
+
+class vtkMitkIndexedPlaneCutterTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(vtkMitkIndexedPlaneCutterTestSuite);
+
+  MITK_TEST(Cut_AxialPlanes_EqualsVtkCutter);
+  MITK_TEST(Cut_ObliquePlanes_EqualsVtkCutter);
+  MITK_TEST(Cut_PlaneOutsideOfInput_IsEmpty);
+  MITK_TEST(MovePlane_ReusesIndex);
+  MITK_TEST(RevisitPlane_IsAnsweredByCache);
+  MITK_TEST(ModifyInput_RebuildsIndex);
+
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  vtkSmartPointer<vtkPolyData> m_Sphere;
+  vtkSmartPointer<vtkMitkIndexedPlaneCutter> m_IndexedCutter;
+
+  vtkSmartPointer<vtkPolyData> ReferenceCut(const double origin[3], const double normal[3])
+  {
+    auto plane = vtkSmartPointer<vtkPlane>::New();
+    plane->SetOrigin(origin[0], origin[1], origin[2]);
+    plane->SetNormal(normal[0], normal[1], normal[2]);
+
+    auto cutter = vtkSmartPointer<vtkCutter>::New();
+    cutter->SetCutFunction(plane);
+    cutter->SetInputData(m_Sphere);
+    cutter->Update();
+
+    return cutter->GetOutput();
+  }
+
+  void CompareToReference(const double origin[3], const double normal[3])
+  {
+    m_IndexedCutter->SetOrigin(origin[0], origin[1], origin[2]);
+    m_IndexedCutter->SetNormal(normal[0], normal[1], normal[2]);
+    m_IndexedCutter->Update();
+
+    vtkSmartPointer<vtkPolyData> reference = this->ReferenceCut(origin, normal);
+    vtkPolyData *result = m_IndexedCutter->GetOutput();
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(
+      "Number of points equals vtkCutter", reference->GetNumberOfPoints(), result->GetNumberOfPoints());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(
+      "Number of lines equals vtkCutter", reference->GetNumberOfLines(), result->GetNumberOfLines());
+
+    double referenceBounds[6];
+    double resultBounds[6];
+    reference->GetBounds(referenceBounds);
+    result->GetBounds(resultBounds);
+    for (int i = 0; i < 6 && reference->GetNumberOfPoints() > 0; ++i)
+      CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Bounds equal vtkCutter", referenceBounds[i], resultBounds[i], 1e-9);
+  }
+
+public:
+  void setUp() override
+  {
+    auto sphereSource = vtkSmartPointer<vtkSphereSource>::New();
+    sphereSource->SetCenter(1.0, 2.0, 3.0);
+    sphereSource->SetRadius(10.0);
+    sphereSource->SetThetaResolution(64);
+    sphereSource->SetPhiResolution(64);
+    sphereSource->Update();
+    m_Sphere = sphereSource->GetOutput();
+
+    m_IndexedCutter = vtkSmartPointer<vtkMitkIndexedPlaneCutter>::New();
+    m_IndexedCutter->SetInputData(m_Sphere);
+  }
+
+  void tearDown() override
+  {
+    m_IndexedCutter = nullptr;
+    m_Sphere = nullptr;
+  }
+
+  void Cut_AxialPlanes_EqualsVtkCutter()
+  {
+    const double normal[3] = {0.0, 0.0, 1.0};
+    for (double z = -6.5; z <= 12.5; z += 1.25)
+    {
+      const double origin[3] = {0.0, 0.0, z};
+      this->CompareToReference(origin, normal);
+    }
+  }
+
+  void Cut_ObliquePlanes_EqualsVtkCutter()
+  {
+    const double normal[3] = {0.3, -0.5, 0.8};
+    for (double offset = -8.0; offset <= 8.0; offset += 2.0)
+    {
+      const double origin[3] = {1.0 + offset * 0.3, 2.0 - offset * 0.5, 3.0 + offset * 0.8};
+      this->CompareToReference(origin, normal);
+    }
+  }
+
+  void Cut_PlaneOutsideOfInput_IsEmpty()
+  {
+    m_IndexedCutter->SetOrigin(0.0, 0.0, 100.0);
+    m_IndexedCutter->SetNormal(0.0, 0.0, 1.0);
+    m_IndexedCutter->Update();
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("No cut outside of the input", vtkIdType(0), m_IndexedCutter->GetOutput()->GetNumberOfPoints());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("No candidate cells outside of the input", vtkIdType(0), m_IndexedCutter->GetNumberOfCandidateCells());
+  }
+
+  void MovePlane_ReusesIndex()
+  {
+    m_IndexedCutter->SetNormal(0.0, 0.0, 1.0);
+    for (double z = 0.0; z < 5.0; z += 1.0)
+    {
+      m_IndexedCutter->SetOrigin(0.0, 0.0, z);
+      m_IndexedCutter->Update();
+    }
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Index is built once while moving along the normal", 1ul, m_IndexedCutter->GetNumberOfIndexBuilds());
+    CPPUNIT_ASSERT_MESSAGE("Only a fraction of the cells is cut", m_IndexedCutter->GetNumberOfCandidateCells() < m_Sphere->GetNumberOfCells() / 4);
+
+    m_IndexedCutter->SetNormal(1.0, 0.0, 0.0);
+    m_IndexedCutter->Update();
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Index is built again for a new normal", 2ul, m_IndexedCutter->GetNumberOfIndexBuilds());
+  }
+
+  void RevisitPlane_IsAnsweredByCache()
+  {
+    m_IndexedCutter->SetNormal(0.0, 0.0, 1.0);
+    m_IndexedCutter->SetOrigin(0.0, 0.0, 4.0);
+    m_IndexedCutter->Update();
+    const vtkIdType numberOfPoints = m_IndexedCutter->GetOutput()->GetNumberOfPoints();
+
+    m_IndexedCutter->SetOrigin(0.0, 0.0, 5.0);
+    m_IndexedCutter->Update();
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("New plane is not in the cache", 0ul, m_IndexedCutter->GetNumberOfCacheHits());
+
+    // a different point of the same plane
+    m_IndexedCutter->SetOrigin(7.0, -3.0, 4.0);
+    m_IndexedCutter->Update();
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Revisited plane is answered by the cache", 1ul, m_IndexedCutter->GetNumberOfCacheHits());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Cached cut equals the first cut", numberOfPoints, m_IndexedCutter->GetOutput()->GetNumberOfPoints());
+
+    m_IndexedCutter->SetCacheSize(0);
+    m_IndexedCutter->SetOrigin(0.0, 0.0, 5.0);
+    m_IndexedCutter->Update();
+    m_IndexedCutter->SetOrigin(0.0, 0.0, 4.0);
+    m_IndexedCutter->Update();
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Disabled cache is not used", 1ul, m_IndexedCutter->GetNumberOfCacheHits());
+  }
+
+  void ModifyInput_RebuildsIndex()
+  {
+    const double normal[3] = {0.0, 0.0, 1.0};
+    const double origin[3] = {0.0, 0.0, 3.0};
+    this->CompareToReference(origin, normal);
+
+    auto sphereSource = vtkSmartPointer<vtkSphereSource>::New();
+    sphereSource->SetCenter(0.0, 0.0, 0.0);
+    sphereSource->SetRadius(5.0);
+    sphereSource->SetThetaResolution(16);
+    sphereSource->SetPhiResolution(16);
+    sphereSource->Update();
+    m_Sphere->DeepCopy(sphereSource->GetOutput());
+
+    this->CompareToReference(origin, normal);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Index is built again for a modified input", 2ul, m_IndexedCutter->GetNumberOfIndexBuilds());
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(vtkMitkIndexedPlaneCutter)
@@ -152,6 +152,46 @@ public:
    */
   static const std::string& PROP_AUTOLOADED_MODULES();
 
+  /**
+   * Returns the property key with a value of \c module.activation_policy for
+   * looking up this module's activation policy.
+   * The property value is of type \c std::string. If it is \c "lazy" and
+   * the module also declares PROP_LAZY_SERVICES(), the module activator is
+   * not called when the module is loaded but on the first service lookup
+   * for one of the declared interfaces. Any other value means eager activation.
+   *
+   * @return The activation policy property key.
+   *
+   * @see ModuleSettings::SetLazyActivationEnabled(bool)
+   */
+  static const std::string& PROP_ACTIVATION_POLICY();
+
+  /**
+   * Returns the property key with a value of \c module.lazy_services for
+   * looking up the service interface ids which trigger the activation of a
+   * lazily activated module.
+   * The property value is of type \c std::vector<Any> containing strings.
+   *
+   * <p>
+   * Only ModuleContext::GetServiceReference() and ModuleContext::GetServiceReferences()
+   * calls which name one of these interfaces, either directly or via an
+   * \c objectclass filter, trigger the activation. Wildcard lookups and
+   * service listeners do not.
+   *
+   * @return The lazy services property key.
+   */
+  static const std::string& PROP_LAZY_SERVICES();
+
+  /**
+   * Returns the property key with a value of \c module.activation_time for
+   * looking up the time the module activator's Load() method took.
+   * The property value is of type \c double and given in milliseconds. It is
+   * not set before the module has been activated.
+   *
+   * @return The activation time property key.
+   */
+  static const std::string& PROP_ACTIVATION_TIME();
+
   ~Module();
 
   /**
@@ -165,6 +205,17 @@ public:
    */
   bool IsLoaded() const;
 
+  /**
+   * Returns whether this module is loaded but its activator has not been
+   * called yet, because the module is activated lazily.
+   *
+   * @return <code>true</code> if the activation of this module is pending,
+   *         <code>false</code> otherwise.
+   *
+   * @see PROP_ACTIVATION_POLICY()
+   */
+  bool IsActivationPending() const;
+
   /**
    * Returns this module's {@link ModuleContext}. The returned
    * <code>ModuleContext</code> can be used by the caller to act on behalf
@@ -41,6 +41,8 @@ US_BEGIN_NAMESPACE
  * - \e US_DISABLE_AUTOLOADING If set, auto-loading of modules is disabled.
  * - \e US_AUTOLOAD_PATHS A ':' (Unix) or ';' (Windows) separated list of paths
  *   from which modules should be auto-loaded.
+ * - \e US_DISABLE_LAZY_ACTIVATION If set, all modules are activated when they
+ *   are loaded, regardless of their activation policy.
  *
  * \remarks This class is thread safe.
  */
@@ -97,6 +99,26 @@ public:
    */
   static void SetAutoLoadingEnabled(bool enable);
 
+  /**
+   * \return \c true if modules declaring a lazy activation policy in their
+   * manifest are activated on first use, \c false if all modules are
+   * activated when they are loaded.
+   *
+   * \remarks This method will always return \c false if lazy activation has been
+   * disabled by defining the US_DISABLE_LAZY_ACTIVATION environment variable.
+   *
+   * \sa Module::PROP_ACTIVATION_POLICY()
+   */
+  static bool IsLazyActivationEnabled();
+
+  /**
+   * Enable or disable lazy module activation. Lazy activation is enabled by default.
+   *
+   * \param enable If \c true, honor the activation policy of modules loaded
+   * afterwards, activate them eagerly otherwise.
+   */
+  static void SetLazyActivationEnabled(bool enable);
+
   /**
    * \return A list of paths in the file-system from which modules will be
    * auto-loaded.
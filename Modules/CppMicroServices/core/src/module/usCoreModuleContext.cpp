@@ -25,14 +25,37 @@
 US_MSVC_DISABLE_WARNING(4355)
 
 #include "usCoreModuleContext_p.h"
+#include "usModulePrivate.h"
+#include "usLDAPExpr_p.h"
+
+#include <algorithm>
+#include <stdexcept>
 
 US_BEGIN_NAMESPACE
 
+namespace {
+
+  bool ProvidesLazyService(const ModulePrivate* module, const std::vector<std::string>& classes)
+  {
+    for (std::vector<std::string>::const_iterator name = classes.begin();
+         name != classes.end(); ++name)
+    {
+      if (std::find(module->lazyServices.begin(), module->lazyServices.end(), *name) != module->lazyServices.end())
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+}
+
 CoreModuleContext::CoreModuleContext()
   : listeners(this)
   , services(this)
   , serviceHooks(this)
   , moduleHooks(this)
+  , lazyModuleCount(0)
 {
 }
 
@@ -50,4 +73,91 @@ void CoreModuleContext::Uninit()
   serviceHooks.Close();
 }
 
+void CoreModuleContext::AddLazyModule(ModulePrivate* module)
+{
+  std::lock_guard<std::recursive_mutex> lock(lazyModulesMutex);
+  lazyModules.push_back(module);
+  ++lazyModuleCount;
+}
+
+bool CoreModuleContext::RemoveLazyModule(ModulePrivate* module)
+{
+  std::lock_guard<std::recursive_mutex> lock(lazyModulesMutex);
+  std::vector<ModulePrivate*>::iterator iter = std::find(lazyModules.begin(), lazyModules.end(), module);
+  if (iter == lazyModules.end())
+  {
+    return false;
+  }
+  lazyModules.erase(iter);
+  --lazyModuleCount;
+  return true;
+}
+
+void CoreModuleContext::ActivateLazyModules(const std::string& clazz, const std::string& filter)
+{
+  // fast path, taken by every lookup once all lazy modules are active
+  if (lazyModuleCount == 0)
+  {
+    return;
+  }
+
+  std::vector<std::string> classes;
+  if (!clazz.empty())
+  {
+    classes.push_back(clazz);
+  }
+  else if (!filter.empty())
+  {
+    try
+    {
+      LDAPExpr ldap(filter);
+      LDAPExpr::ObjectClassSet matched;
+      if (ldap.GetMatchedObjectClasses(matched))
+      {
+        classes.assign(matched.begin(), matched.end());
+      }
+    }
+    catch (const std::invalid_argument&)
+    {
+      // the lookup itself reports the invalid filter
+    }
+  }
+
+  if (classes.empty())
+  {
+    return;
+  }
+
+  // Other threads looking up the same interfaces wait here until the
+  // activation is complete and its services are registered.
+  std::lock_guard<std::recursive_mutex> lock(lazyModulesMutex);
+  for (;;)
+  {
+    std::vector<ModulePrivate*>::iterator iter = lazyModules.begin();
+    while (iter != lazyModules.end() && !ProvidesLazyService(*iter, classes))
+    {
+      ++iter;
+    }
+
+    if (iter == lazyModules.end())
+    {
+      break;
+    }
+
+    ModulePrivate* module = *iter;
+    lazyModules.erase(iter);
+    --lazyModuleCount;
+
+    // the activator may trigger further activations, so the list is scanned again afterwards
+    try
+    {
+      module->Activate();
+    }
+    catch (const std::exception& e)
+    {
+      US_ERROR << "Lazy activation of module " << module->info.name << " failed: " << e.what();
+    }
+  }
+}
+
 US_END_NAMESPACE
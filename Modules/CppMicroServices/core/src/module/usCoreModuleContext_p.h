@@ -28,8 +28,14 @@
 #include "usModuleHooks_p.h"
 #include "usServiceHooks_p.h"
 
+#include <atomic>
+#include <mutex>
+#include <vector>
+
 US_BEGIN_NAMESPACE
 
+class ModulePrivate;
+
 /**
  * This class is not part of the public API.
  */
@@ -69,6 +75,33 @@ public:
 
   void Uninit();
 
+  /**
+   * Remembers a loaded module whose activation is deferred until one
+   * of its lazy services is looked up.
+   */
+  void AddLazyModule(ModulePrivate* module);
+
+  /**
+   * Forgets a lazily activated module without activating it.
+   *
+   * @return \c true if the module was still waiting for its activation.
+   */
+  bool RemoveLazyModule(ModulePrivate* module);
+
+  /**
+   * Activates all pending modules which declared one of the service
+   * interfaces requested by a lookup for \c clazz or \c filter.
+   */
+  void ActivateLazyModules(const std::string& clazz, const std::string& filter);
+
+private:
+
+  std::vector<ModulePrivate*> lazyModules;
+  std::atomic<int> lazyModuleCount;
+
+  // recursive, because module activators may look up services themselves
+  std::recursive_mutex lazyModulesMutex;
+
 };
 
 US_END_NAMESPACE
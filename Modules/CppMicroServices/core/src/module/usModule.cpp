@@ -78,6 +78,24 @@ const std::string&Module::PROP_AUTOLOADED_MODULES()
   return s;
 }
 
+const std::string&Module::PROP_ACTIVATION_POLICY()
+{
+  static const std::string s("module.activation_policy");
+  return s;
+}
+
+const std::string&Module::PROP_LAZY_SERVICES()
+{
+  static const std::string s("module.lazy_services");
+  return s;
+}
+
+const std::string&Module::PROP_ACTIVATION_TIME()
+{
+  static const std::string s("module.activation_time");
+  return s;
+}
+
 Module::Module()
 : d(nullptr)
 {
@@ -116,6 +134,11 @@ bool Module::IsLoaded() const
   return d->moduleContext != nullptr;
 }
 
+bool Module::IsActivationPending() const
+{
+  return d->activationPending;
+}
+
 void Module::Start()
 {
 
@@ -149,11 +172,18 @@ void Module::Start()
       throw;
     }
 
-    // This method should be "noexcept" and by not catching exceptions
-    // here we semantically treat it that way since any exception during
-    // static initialization will either terminate the program or cause
-    // the dynamic loader to report an error.
-    d->moduleActivator->Load(d->moduleContext);
+    // The activator instance is created in any case, so its static storage
+    // outlives the module initializer of the shared library. Only calling
+    // Load() is deferred for lazily activated modules.
+    if (d->IsActivatedLazily())
+    {
+      d->activationPending = true;
+      d->coreCtx->AddLazyModule(d);
+    }
+    else
+    {
+      d->Activate();
+    }
   }
 
 #ifdef US_ENABLE_AUTOLOADING_SUPPORT
@@ -178,11 +208,15 @@ void Module::Stop()
     return;
   }
 
+  // a module which was never activated has nothing to unload
+  const bool activated = !d->coreCtx->RemoveLazyModule(d);
+  d->activationPending = false;
+
   try
   {
     d->coreCtx->listeners.ModuleChanged(ModuleEvent(ModuleEvent::UNLOADING, this));
 
-    if (d->moduleActivator)
+    if (d->moduleActivator && activated)
     {
       d->moduleActivator->Unload(d->moduleContext);
     }
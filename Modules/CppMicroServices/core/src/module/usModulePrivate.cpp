@@ -35,6 +35,7 @@
 #include <algorithm>
 #include <iterator>
 #include <cassert>
+#include <chrono>
 #include <cstring>
 
 US_BEGIN_NAMESPACE
@@ -48,6 +49,7 @@ ModulePrivate::ModulePrivate(Module* qq, CoreModuleContext* coreCtx,
   , resourceContainer(info)
   , moduleContext(nullptr)
   , moduleActivator(nullptr)
+  , activationPending(false)
   , q(qq)
 {
   // Check if the module provides a manifest.json file and if yes, parse it.
@@ -108,6 +110,63 @@ ModulePrivate::ModulePrivate(Module* qq, CoreModuleContext* coreCtx,
     this->info.autoLoadDir = this->info.name;
     moduleManifest.SetValue(Module::PROP_AUTOLOAD_DIR(), Any(this->info.autoLoadDir));
   }
+
+  if (moduleManifest.Contains(Module::PROP_LAZY_SERVICES()))
+  {
+    Any servicesAny = moduleManifest.GetValue(Module::PROP_LAZY_SERVICES());
+    if (servicesAny.Type() == typeid(std::vector<Any>))
+    {
+      const std::vector<Any>& services = ref_any_cast<std::vector<Any> >(servicesAny);
+      for (std::vector<Any>::const_iterator iter = services.begin(); iter != services.end(); ++iter)
+      {
+        if (iter->Type() == typeid(std::string))
+        {
+          lazyServices.push_back(iter->ToString());
+        }
+      }
+    }
+    else
+    {
+      US_WARN << "The Json value for " << Module::PROP_LAZY_SERVICES() << " for module "
+              << info->location << " must be an array of service interface ids";
+    }
+  }
+}
+
+bool ModulePrivate::IsActivatedLazily() const
+{
+  if (!moduleManifest.Contains(Module::PROP_ACTIVATION_POLICY()) ||
+      moduleManifest.GetValue(Module::PROP_ACTIVATION_POLICY()).ToString() != "lazy")
+  {
+    return false;
+  }
+
+  if (lazyServices.empty())
+  {
+    US_WARN << "Module " << info.name << " requests lazy activation without declaring "
+            << Module::PROP_LAZY_SERVICES() << ", activating it eagerly";
+    return false;
+  }
+
+  return ModuleSettings::IsLazyActivationEnabled();
+}
+
+void ModulePrivate::Activate()
+{
+  activationPending = false;
+
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  // This method should be "noexcept" and by not catching exceptions
+  // here we semantically treat it that way since any exception during
+  // static initialization will either terminate the program or cause
+  // the dynamic loader to report an error.
+  moduleActivator->Load(moduleContext);
+
+  const double milliseconds =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  moduleManifest.SetValue(Module::PROP_ACTIVATION_TIME(), Any(milliseconds));
+  US_DEBUG << "Activated module " << info.name << " in " << milliseconds << " ms";
 }
 
 ModulePrivate::~ModulePrivate()
@@ -55,6 +55,18 @@ public:
 
   void RemoveModuleResources();
 
+  /**
+   * Returns \c true if the manifest requests lazy activation, declares
+   * the services triggering it and lazy activation is enabled.
+   */
+  bool IsActivatedLazily() const;
+
+  /**
+   * Calls the Load() method of the module activator and records
+   * the time it took.
+   */
+  void Activate();
+
   CoreModuleContext* const coreCtx;
 
   /**
@@ -75,6 +87,16 @@ public:
 
   ModuleManifest moduleManifest;
 
+  /**
+   * Service interface ids which trigger the activation of a lazy module
+   */
+  std::vector<std::string> lazyServices;
+
+  /**
+   * True between loading a lazy module and its activation
+   */
+  bool activationPending;
+
   std::string baseStoragePath;
   std::string storagePath;
 
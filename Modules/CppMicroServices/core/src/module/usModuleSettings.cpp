@@ -67,6 +67,8 @@ struct ModuleSettingsPrivate : public MultiThreaded<>
     , autoLoadingEnabled(false)
   #endif
     , autoLoadingDisabled(false)
+    , lazyActivationEnabled(true)
+    , lazyActivationDisabled(false)
     , logLevel(DebugMsg)
   {
     autoLoadPaths.insert(ModuleSettings::CURRENT_MODULE_PATH());
@@ -95,12 +97,19 @@ struct ModuleSettingsPrivate : public MultiThreaded<>
     {
       autoLoadingDisabled = true;
     }
+
+    if (getenv("US_DISABLE_LAZY_ACTIVATION"))
+    {
+      lazyActivationDisabled = true;
+    }
   }
 
   std::set<std::string> autoLoadPaths;
   std::set<std::string> extraPaths;
   bool autoLoadingEnabled;
   bool autoLoadingDisabled;
+  bool lazyActivationEnabled;
+  bool lazyActivationDisabled;
   std::string storagePath;
   MsgType logLevel;
 };
@@ -133,6 +142,19 @@ void ModuleSettings::SetAutoLoadingEnabled(bool enable)
   moduleSettingsPrivate()->autoLoadingEnabled = enable;
 }
 
+bool ModuleSettings::IsLazyActivationEnabled()
+{
+  US_UNUSED(ModuleSettingsPrivate::Lock(moduleSettingsPrivate()));
+  return !moduleSettingsPrivate()->lazyActivationDisabled &&
+      moduleSettingsPrivate()->lazyActivationEnabled;
+}
+
+void ModuleSettings::SetLazyActivationEnabled(bool enable)
+{
+  US_UNUSED(ModuleSettingsPrivate::Lock(moduleSettingsPrivate()));
+  moduleSettingsPrivate()->lazyActivationEnabled = enable;
+}
+
 ModuleSettings::PathList ModuleSettings::GetAutoLoadPaths()
 {
   US_UNUSED(ModuleSettingsPrivate::Lock(moduleSettingsPrivate()));
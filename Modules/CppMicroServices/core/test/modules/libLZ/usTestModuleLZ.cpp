@@ -0,0 +1,56 @@
+/*=============================================================================
+
+  Library: CppMicroServices
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#include "usTestModuleLZService.h"
+
+#include <usModuleActivator.h>
+#include <usModuleContext.h>
+
+US_BEGIN_NAMESPACE
+
+struct TestModuleLZ : public TestModuleLZService
+{
+};
+
+class TestModuleLZActivator : public ModuleActivator
+{
+public:
+
+  void Load(ModuleContext* context) override
+  {
+    sr = context->RegisterService<TestModuleLZService>(&s);
+  }
+
+  void Unload(ModuleContext* /*context*/) override
+  {
+    sr.Unregister();
+  }
+
+private:
+
+  TestModuleLZ s;
+  ServiceRegistration<TestModuleLZService> sr;
+};
+
+US_END_NAMESPACE
+
+US_EXPORT_MODULE_ACTIVATOR(US_PREPEND_NAMESPACE(TestModuleLZActivator))
@@ -0,0 +1,144 @@
+/*=============================================================================
+
+  Library: CppMicroServices
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include <usModule.h>
+#include <usModuleContext.h>
+#include <usModuleRegistry.h>
+#include <usModuleSettings.h>
+#include <usGetModuleContext.h>
+#include <usSharedLibrary.h>
+
+#include "usTestingMacros.h"
+#include "usTestingConfig.h"
+
+US_USE_NAMESPACE
+
+namespace {
+
+#ifdef US_PLATFORM_WINDOWS
+  static const std::string LIB_PATH = US_RUNTIME_OUTPUT_DIRECTORY;
+#else
+  static const std::string LIB_PATH = US_LIBRARY_OUTPUT_DIRECTORY;
+#endif
+
+  const std::string lazyServiceId = "org.cppmicroservices.TestModuleLZService";
+
+void frameLZ01a()
+{
+  SharedLibrary target(LIB_PATH, "TestModuleLZ");
+  try
+  {
+    target.Load();
+  }
+  catch (const std::exception& e)
+  {
+    US_TEST_FAILED_MSG( << "Failed to load module, got exception: " << e.what() );
+  }
+
+  Module* module = ModuleRegistry::GetModule("TestModuleLZ");
+  US_TEST_CONDITION_REQUIRED(module != nullptr, "Test for existing module TestModuleLZ")
+  US_TEST_CONDITION(module->IsLoaded(), "Lazy module is loaded")
+  US_TEST_CONDITION(module->IsActivationPending(), "Lazy module is not activated yet")
+  US_TEST_CONDITION(module->GetProperty(Module::PROP_ACTIVATION_TIME()).Empty(), "No activation time before activation")
+  US_TEST_CONDITION(module->GetRegisteredServices().empty(), "Lazy module has no registered services yet")
+
+  ModuleContext* mc = GetModuleContext();
+
+  // wildcard lookups must not wake up every lazy module
+  mc->GetServiceReferences("");
+  US_TEST_CONDITION(module->IsActivationPending(), "Wildcard lookup does not activate the module")
+
+  mc->GetServiceReferences("org.cppmicroservices.SomeOtherService");
+  US_TEST_CONDITION(module->IsActivationPending(), "Lookup of other services does not activate the module")
+
+  ServiceReferenceU ref = mc->GetServiceReference(lazyServiceId);
+  US_TEST_CONDITION(ref, "Lookup of a lazy service activates the module")
+  US_TEST_CONDITION(!module->IsActivationPending(), "Lazy module is activated")
+  US_TEST_CONDITION(module->GetRegisteredServices().size() == 1, "Lazy module registered its service")
+  US_TEST_CONDITION(module->GetProperty(Module::PROP_ACTIVATION_TIME()).Type() == typeid(double), "Activation time is recorded")
+
+  target.Unload();
+  US_TEST_CONDITION(!mc->GetServiceReference(lazyServiceId), "Service is gone after unloading")
+}
+
+// activation through an objectclass filter
+void frameLZ02a()
+{
+  SharedLibrary target(LIB_PATH, "TestModuleLZ");
+  target.Load();
+
+  Module* module = ModuleRegistry::GetModule("TestModuleLZ");
+  US_TEST_CONDITION_REQUIRED(module != nullptr, "Test for existing module TestModuleLZ")
+  US_TEST_CONDITION(module->IsActivationPending(), "Reloaded lazy module is not activated yet")
+
+  std::vector<ServiceReferenceU> refs =
+      GetModuleContext()->GetServiceReferences("", "(objectclass=" + lazyServiceId + ")");
+  US_TEST_CONDITION(refs.size() == 1, "Filter lookup of a lazy service activates the module")
+  US_TEST_CONDITION(!module->IsActivationPending(), "Lazy module is activated")
+
+  target.Unload();
+}
+
+// unloading a module which was never activated
+void frameLZ03a()
+{
+  SharedLibrary target(LIB_PATH, "TestModuleLZ");
+  target.Load();
+
+  Module* module = ModuleRegistry::GetModule("TestModuleLZ");
+  US_TEST_CONDITION_REQUIRED(module != nullptr, "Test for existing module TestModuleLZ")
+  US_TEST_CONDITION(module->IsActivationPending(), "Lazy module is not activated yet")
+
+  target.Unload();
+  US_TEST_CONDITION(!module->IsActivationPending(), "Unloaded module is no longer pending")
+  US_TEST_CONDITION(!GetModuleContext()->GetServiceReference(lazyServiceId), "Lookup does not activate an unloaded module")
+}
+
+// lazy activation disabled at runtime
+void frameLZ04a()
+{
+  ModuleSettings::SetLazyActivationEnabled(false);
+
+  SharedLibrary target(LIB_PATH, "TestModuleLZ");
+  target.Load();
+
+  Module* module = ModuleRegistry::GetModule("TestModuleLZ");
+  US_TEST_CONDITION_REQUIRED(module != nullptr, "Test for existing module TestModuleLZ")
+  US_TEST_CONDITION(!module->IsActivationPending(), "Module is activated eagerly")
+  US_TEST_CONDITION(module->GetRegisteredServices().size() == 1, "Eagerly activated module registered its service")
+
+  target.Unload();
+  ModuleSettings::SetLazyActivationEnabled(true);
+}
+
+} // end unnamed namespace
+
+int usModuleLazyActivationTest(int /*argc*/, char* /*argv*/[])
+{
+  US_TEST_BEGIN("ModuleLazyActivationTest");
+
+  frameLZ01a();
+  frameLZ02a();
+  frameLZ03a();
+  frameLZ04a();
+
+  US_TEST_END()
+}
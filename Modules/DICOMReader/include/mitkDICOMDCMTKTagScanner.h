@@ -31,6 +31,10 @@ namespace mitk
     \brief Encapsulates the tag scanning process for a set of DICOM files.
 
     For the scanning process it uses DCMTK functionality.
+
+    The files are distributed over several threads (see SetNumberOfThreads()). Each
+    file is parsed only up to the last top level element of the scanned tag paths;
+    pixel data is not read unless it is requested itself.
   */
   class MITKDICOMREADER_EXPORT DICOMDCMTKTagScanner : public DICOMTagScanner
   {
@@ -19,8 +19,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkDICOMTagCache.h"
 
-#include <set>
+#include <deque>
+#include <map>
 #include <memory>
+#include <set>
+#include <vector>
 
 #include <gdcmScanner.h>
 
@@ -47,8 +50,21 @@ namespace mitk
 
       void InitCache(const std::set<DICOMTag>& scannedTags, const std::shared_ptr<gdcm::Scanner>& scanner, const StringList& inputFiles);
 
+      typedef std::map<std::string, std::map<DICOMTag, std::string> > PersistentValuesType;
+
+      /**
+        \brief Merges the results of several scanners that each scanned a part of inputFiles.
+        Files in persistentValues have not been scanned, their values are taken from
+        the DICOMPersistentTagCache instead. The frame info list keeps the order of inputFiles.
+      */
+      void InitCache(const std::set<DICOMTag>& scannedTags, const std::vector<std::shared_ptr<gdcm::Scanner> >& scanners, const StringList& inputFiles,
+        const PersistentValuesType& persistentValues = PersistentValuesType());
+
+      /** \brief First scanner of the cache; use GetScanners() if the scan was split up. */
       const gdcm::Scanner& GetScanner() const;
 
+      const std::vector<std::shared_ptr<gdcm::Scanner> >& GetScanners() const;
+
   protected:
 
       DICOMGDCMTagCache();
@@ -56,7 +72,10 @@ namespace mitk
 
       std::set<DICOMTag> m_ScannedTags;
 
-      std::shared_ptr<gdcm::Scanner> m_Scanner;
+      std::vector<std::shared_ptr<gdcm::Scanner> > m_Scanners;
+
+      /** Storage of the values that did not come from a scanner, the frame infos point into it. */
+      std::deque<std::string> m_PersistentValues;
 
       DICOMDatasetAccessingImageFrameList m_ScanResult;
 
@@ -45,6 +45,11 @@ namespace mitk
     results, care should be taken that all the tags and files of interest
     are communicated to DICOMGDCMTagScanner before requesting the results!
 
+    Scan() splits the input files into one part per thread (see SetNumberOfThreads())
+    and scans each part with its own gdcm::Scanner. gdcm::Scanner reads a file only up
+    to the last requested tag and never reads pixel data. The results of all parts are
+    merged into one DICOMGDCMTagCache.
+
     @remark This scanner does only support the scanning for simple value tag.
     If you need to scann for sequence items or non-top-level elements, this scanner
     will not be sufficient. See i.a. DICOMDCMTKTagScanner for these cases.
@@ -113,7 +118,6 @@ namespace mitk
       std::set<DICOMTag> m_ScannedTags;
       StringList m_InputFilenames;
       DICOMGDCMTagCache::Pointer m_Cache;
-      std::shared_ptr<gdcm::Scanner> m_GDCMScanner;
 
     private:
       DICOMGDCMTagScanner(const DICOMGDCMTagScanner&);
@@ -0,0 +1,133 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkDICOMPersistentTagCache_h
+#define mitkDICOMPersistentTagCache_h
+
+#include <itkObjectFactory.h>
+#include <mitkCommon.h>
+
+#include "MitkDICOMReaderExports.h"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mitk
+{
+
+  /**
+    \ingroup DICOMReaderModule
+    \brief Tag values of already scanned DICOM files that survive the session.
+
+    DICOMTagScanner implementations look up every input file in this cache before
+    scanning it and store the results of all files they had to scan. An entry is
+    valid as long as size and modification time of the file are unchanged and it
+    contains all requested tags. Entries are kept per scanner type, since the
+    scanners differ in the way they report values.
+
+    Queries and keys are strings defined by the scanner, e.g. a tag path as
+    property name. This class does not interpret them.
+
+    The default cache is shared by all scanners and thus by all readers that use
+    them (e.g. DICOMITKSeriesGDCMReader, ThreeDnTDICOMSeriesReader and the readers
+    selected by DICOMFileReaderSelector). It is disabled unless an application
+    calls SetDefault() or the environment variable MITK_DICOM_TAG_CACHE_FILE names
+    the file of the cache. Scanners save the default cache after each scan that
+    changed it.
+
+    All methods are thread safe.
+  */
+  class MITKDICOMREADER_EXPORT DICOMPersistentTagCache : public itk::Object
+  {
+    public:
+
+      mitkClassMacroItkParent(DICOMPersistentTagCache, itk::Object);
+      itkFactorylessNewMacro( DICOMPersistentTagCache );
+
+      typedef std::vector<std::pair<std::string, std::string> > ValueListType;
+
+      /** \brief Cache used by new scanners, nullptr if persistent caching is disabled. */
+      static Pointer GetDefault();
+      static void SetDefault(Pointer cache);
+
+      /** \brief File used by Load() and Save(). */
+      void SetFileName(const std::string& fileName);
+      std::string GetFileName() const;
+
+      /**
+        \brief Replaces the content by that of the cache file.
+        A missing file results in an empty cache. Unreadable files are reported
+        and ignored, they are overwritten by the next Save().
+      */
+      void Load();
+
+      /**
+        \brief Writes the cache file, if the content changed since the last Load() or Save().
+        Throws an mitk::Exception if the file cannot be written.
+      */
+      void Save();
+
+      /**
+        \brief Retrieves the values that scanner has stored for fileName.
+        \return false if there is no entry, the file changed, or not all queries
+        have been scanned before.
+      */
+      bool Lookup(const std::string& scanner, const std::string& fileName, const std::set<std::string>& queries, ValueListType& values) const;
+
+      /**
+        \brief Stores the values found for queries in fileName.
+        Entries of an unchanged file are extended, so that scans for different
+        tags accumulate.
+      */
+      void Store(const std::string& scanner, const std::string& fileName, const std::set<std::string>& queries, const ValueListType& values);
+
+      std::size_t GetNumberOfEntries() const;
+      void Clear();
+
+    protected:
+
+      DICOMPersistentTagCache();
+      ~DICOMPersistentTagCache() override;
+
+    private:
+
+      struct Entry
+      {
+        std::uint64_t size;
+        std::int64_t modificationTime;
+        std::set<std::string> queries;
+        std::map<std::string, std::string> values;
+      };
+
+      typedef std::pair<std::string, std::string> EntryKeyType;
+
+      static bool GetFileState(const std::string& fileName, std::uint64_t& size, std::int64_t& modificationTime);
+
+      mutable std::mutex m_Mutex;
+      std::string m_FileName;
+      std::map<EntryKeyType, Entry> m_Entries;
+      bool m_Changed;
+
+      DICOMPersistentTagCache(const DICOMPersistentTagCache&);
+  };
+}
+
+#endif
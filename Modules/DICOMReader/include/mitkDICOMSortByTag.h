@@ -62,6 +62,12 @@ class MITKDICOMREADER_EXPORT DICOMSortByTag : public DICOMSortCriterion
     bool StringCompare(const mitk::DICOMDatasetAccess* left, const mitk::DICOMDatasetAccess* right, const DICOMTag& tag) const;
     bool NumericCompare(const mitk::DICOMDatasetAccess* left, const mitk::DICOMDatasetAccess* right, const DICOMTag& tag) const;
 
+    /// \brief The numerical value of the tag, as used by NumericCompare().
+    unsigned int GetNumberOfSortKeyValues() const override;
+    void ExtractSortKeyValues(const mitk::DICOMDatasetAccess* dataset, double* values) const override;
+    int CompareSortKeyValues(const double* left, const double* right) const override;
+    double NumericDistanceOfSortKeyValues(const double* from, const double* to) const override;
+
   private:
 
     DICOMTag m_Tag;
@@ -22,6 +22,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkDICOMDatasetAccess.h"
 
+#include <vector>
+
 namespace mitk
 {
 
@@ -59,6 +61,28 @@ class MITKDICOMREADER_EXPORT DICOMSortCriterion : public itk::LightObject
     /// \brief The fallback criterion.
     DICOMSortCriterion::ConstPointer GetSecondaryCriterion() const;
 
+    /**
+      \brief Typed values of the tags of interest of one dataset (includes secondary criteria).
+
+      Sorting large numbers of frames with IsLeftBeforeRight() would convert the
+      same tag values again in each comparison. DICOMTagBasedSorter therefore
+      extracts one key per dataset before sorting and compares these keys.
+    */
+    struct SortKey
+    {
+      const DICOMDatasetAccess* dataset;
+      std::vector<double> values;
+    };
+
+    /// \brief Convert the tags of interest of dataset for IsLeftKeyBeforeRightKey() and NumericKeyDistance().
+    SortKey ExtractSortKey(const mitk::DICOMDatasetAccess* dataset) const;
+
+    /// \brief Same answer as IsLeftBeforeRight() for the datasets of the keys.
+    bool IsLeftKeyBeforeRightKey(const SortKey& left, const SortKey& right) const;
+
+    /// \brief Same answer as NumericDistance() for the datasets of the keys.
+    double NumericKeyDistance(const SortKey& from, const SortKey& to) const;
+
     /// brief describe this class in given stream.
     virtual void Print(std::ostream& os) const = 0;
 
@@ -71,6 +95,22 @@ class MITKDICOMREADER_EXPORT DICOMSortCriterion : public itk::LightObject
 
     bool NextLevelIsLeftBeforeRight(const mitk::DICOMDatasetAccess* left, const mitk::DICOMDatasetAccess* right) const;
 
+    /**
+      \brief Number of values this criterion (without secondary criteria) adds to a SortKey.
+      The default 0 means that the criterion has no typed representation, keys are
+      then compared by calling IsLeftBeforeRight() for their datasets.
+    */
+    virtual unsigned int GetNumberOfSortKeyValues() const;
+
+    /// \brief Write GetNumberOfSortKeyValues() values of dataset to values.
+    virtual void ExtractSortKeyValues(const mitk::DICOMDatasetAccess* dataset, double* values) const;
+
+    /// \brief Compare the values of this criterion, < 0 if left is before right, 0 if the secondary criterion has to decide.
+    virtual int CompareSortKeyValues(const double* left, const double* right) const;
+
+    /// \brief NumericDistance() for the values of this criterion.
+    virtual double NumericDistanceOfSortKeyValues(const double* from, const double* to) const;
+
     explicit DICOMSortCriterion(const DICOMSortCriterion& other);
     DICOMSortCriterion& operator=(const DICOMSortCriterion& other);
 
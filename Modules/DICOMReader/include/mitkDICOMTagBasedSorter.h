@@ -157,6 +157,7 @@ class MITKDICOMREADER_EXPORT DICOMTagBasedSorter : public DICOMDatasetSorter
     {
       ParameterizedDatasetSort(DICOMSortCriterion::ConstPointer);
       bool operator() (const mitk::DICOMDatasetAccess* left, const mitk::DICOMDatasetAccess* right);
+      bool operator() (const DICOMSortCriterion::SortKey& left, const DICOMSortCriterion::SortKey& right);
       DICOMSortCriterion::ConstPointer m_SortCriterion;
     };
 
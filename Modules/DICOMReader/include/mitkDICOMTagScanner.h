@@ -24,6 +24,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkDICOMTagPath.h"
 #include "mitkDICOMTagCache.h"
 #include "mitkDICOMDatasetAccessingImageFrameInfo.h"
+#include "mitkDICOMPersistentTagCache.h"
 
 namespace mitk
 {
@@ -90,8 +91,36 @@ namespace mitk
       */
       virtual DICOMTagCache::Pointer GetScanCache() const = 0;
 
+      /**
+      \brief Number of threads that scan the files in parallel.
+      0 (default) uses one thread per available core.
+      */
+      void SetNumberOfThreads(unsigned int numberOfThreads);
+      unsigned int GetNumberOfThreads() const;
+
+      /**
+      \brief Files per second of the last call of Scan(), 0 if nothing has been scanned yet.
+      */
+      double GetLastScanThroughput() const;
+
+      /**
+      \brief Cache that is consulted before files are scanned and updated after Scan().
+      Defaults to DICOMPersistentTagCache::GetDefault(), set nullptr to always scan all files.
+      */
+      void SetPersistentTagCache(DICOMPersistentTagCache* cache);
+      DICOMPersistentTagCache* GetPersistentTagCache() const;
+
     protected:
 
+      /** \brief Number of threads to use for numberOfFiles, at least 1 and at most numberOfFiles. */
+      unsigned int GetNumberOfScanThreads(std::size_t numberOfFiles) const;
+
+      /** \brief Remember and log the throughput of a finished scan. */
+      void ReportScanThroughput(std::size_t numberOfFiles, double seconds);
+
+      /** \brief Saves the persistent tag cache after a scan; failures are only reported. */
+      void SavePersistentTagCache() const;
+
       /** \brief Return active C locale */
       static std::string GetActiveLocale();
       /**
@@ -112,6 +141,10 @@ namespace mitk
 
       static itk::MutexLock::Pointer s_LocaleMutex;
 
+      unsigned int m_NumberOfThreads;
+      double m_LastScanThroughput;
+      DICOMPersistentTagCache::Pointer m_PersistentTagCache;
+
       mutable std::stack<std::string> m_ReplacedCLocales;
       mutable std::stack<std::locale> m_ReplacedCinLocales;
 
@@ -23,6 +23,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkVector.h"
 
+#include <map>
+#include <utility>
+
 namespace mitk
 {
 
@@ -186,6 +189,12 @@ class MITKDICOMREADER_EXPORT EquiDistantBlocksSorter : public DICOMDatasetSorter
     SliceGroupingAnalysisResult
     AnalyzeFileForITKImageSeriesReaderSpacingAssumption(const DICOMDatasetList& files, bool groupsOfSimilarImages);
 
+    /**
+      \brief Image position (patient) of dataset, converted only once per Sort().
+      \return false if the dataset has no position information.
+     */
+    bool GetImagePositionPatient(DICOMDatasetAccess* dataset, Point3D& origin);
+
     /**
       \brief Safely convert const char* to std::string.
      */
@@ -207,6 +216,10 @@ class MITKDICOMREADER_EXPORT EquiDistantBlocksSorter : public DICOMDatasetSorter
     bool m_ToleratedOriginOffsetIsAbsolute;
 
     bool m_AcceptTwoSlicesGroups;
+
+    /// \brief Converted positions of the datasets of the current Sort(), the analysis visits each dataset once per block.
+    typedef std::map<const DICOMDatasetAccess*, std::pair<bool, Point3D> > ImagePositionCacheType;
+    ImagePositionCacheType m_ImagePositionCache;
 };
 
 }
@@ -45,6 +45,10 @@ class ITKDICOMSeriesReaderHelper
 
     static bool CanHandleFile(const std::string& filename);
 
+    /** Number of threads that decode the slices of a volume, 0 (default) uses one thread per core. */
+    void SetNumberOfThreads(unsigned int numberOfThreads);
+    unsigned int GetNumberOfThreads() const;
+
   private:
 
     typedef std::vector<TimeBounds> TimeBoundsList;
@@ -87,6 +91,35 @@ class ITKDICOMSeriesReaderHelper
     typename ImageType::Pointer
     FixUpTiltedGeometry( ImageType* input, const GantryTiltInformation& tiltInfo );
 
+    /** Decodes one single-frame file per slice into buffer, in the order of filenames.
+        The files are read in parallel, every thread uses its own GDCMImageIO. */
+    template <typename PixelType>
+    void
+    DecodeSlices( const StringContainer& filenames,
+                  unsigned int sizeX,
+                  unsigned int sizeY,
+                  PixelType* buffer ) const;
+
+    /** Reads the geometry of the block of filenames with ITK's series reader without
+        decoding any pixel. Returns false if the slices cannot be decoded by DecodeSlices,
+        e.g. for multi-frame files. */
+    template <typename ImageType>
+    static bool
+    ReadBlockInformation( const StringContainer& filenames,
+                          itk::GDCMImageIO::Pointer& io,
+                          typename ImageType::Pointer& information );
+
+    /** Loads the volume of one time step into image, which is initialized by the first time step. */
+    template <typename ImageType>
+    void
+    LoadBlock( const StringContainer& filenames,
+               bool correctTilt,
+               const GantryTiltInformation& tiltInfo,
+               itk::GDCMImageIO::Pointer& io,
+               Image* image,
+               unsigned int timeStep,
+               unsigned int numberOfTimeSteps );
+
     template <typename PixelType>
     Image::Pointer
     LoadDICOMByITK( const StringContainer& filenames,
@@ -101,7 +134,7 @@ class ITKDICOMSeriesReaderHelper
                         const GantryTiltInformation& tiltInfo,
                         itk::GDCMImageIO::Pointer& io);
 
-
+    unsigned int m_NumberOfThreads = 0;
 };
 
 }
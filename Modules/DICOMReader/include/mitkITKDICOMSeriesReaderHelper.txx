@@ -15,6 +15,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkITKDICOMSeriesReaderHelper.h"
 
+#include <mitkImageWriteAccessor.h>
+
+#include <itkImageFileReader.h>
 #include <itkImageSeriesReader.h>
 #include <itkResampleImageFilter.h>
 //#include <itkAffineTransform.h>
@@ -23,19 +26,92 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "dcmtk/ofstd/ofdatime.h"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 template <typename PixelType>
-mitk::Image::Pointer
+void
 mitk::ITKDICOMSeriesReaderHelper
-::LoadDICOMByITK(
+::DecodeSlices(
     const StringContainer& filenames,
-    bool correctTilt,
-    const GantryTiltInformation& tiltInfo,
-    itk::GDCMImageIO::Pointer& io)
+    unsigned int sizeX,
+    unsigned int sizeY,
+    PixelType* buffer) const
 {
-  /******** Normal Case, 3D (also for GDCM < 2 usable) ***************/
-  mitk::Image::Pointer image = mitk::Image::New();
+  typedef itk::Image<PixelType, 3> SliceImageType;
+  typedef itk::ImageFileReader<SliceImageType> SliceReaderType;
 
-  typedef itk::Image<PixelType, 3> ImageType;
+  const std::size_t numberOfFiles = filenames.size();
+  const std::size_t pixelsPerSlice = static_cast<std::size_t>(sizeX) * sizeY;
+
+  std::atomic<std::size_t> nextFile(0);
+  std::exception_ptr exception;
+  std::mutex exceptionMutex;
+
+  auto worker = [&]()
+  {
+    for (std::size_t i = nextFile++; i < numberOfFiles; i = nextFile++)
+    {
+      try
+      {
+        // every thread needs its own IO, GDCMImageIO keeps the state of the file being read
+        typename SliceReaderType::Pointer reader = SliceReaderType::New();
+        reader->SetImageIO(itk::GDCMImageIO::New());
+        reader->SetFileName(filenames[i]);
+        reader->Update();
+
+        const typename SliceImageType::SizeType size = reader->GetOutput()->GetLargestPossibleRegion().GetSize();
+        if (size[0] != sizeX || size[1] != sizeY || size[2] != 1)
+        {
+          mitkThrow() << "Slice " << filenames[i] << " has size " << size << " instead of [" << sizeX << ", " << sizeY << ", 1]";
+        }
+
+        const PixelType* slice = reader->GetOutput()->GetBufferPointer();
+        std::copy(slice, slice + pixelsPerSlice, buffer + i * pixelsPerSlice);
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(exceptionMutex);
+        if (!exception)
+          exception = std::current_exception();
+        nextFile = numberOfFiles;
+        return;
+      }
+    }
+  };
+
+  std::size_t numberOfThreads = m_NumberOfThreads > 0 ? m_NumberOfThreads : std::max(1u, std::thread::hardware_concurrency());
+  numberOfThreads = std::max<std::size_t>(1, std::min(numberOfThreads, numberOfFiles));
+
+  std::vector<std::thread> threads;
+  for (std::size_t i = 1; i < numberOfThreads; ++i)
+  {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  if (exception)
+  {
+    std::rethrow_exception(exception);
+  }
+}
+
+template <typename ImageType>
+bool
+mitk::ITKDICOMSeriesReaderHelper
+::ReadBlockInformation(
+    const StringContainer& filenames,
+    itk::GDCMImageIO::Pointer& io,
+    typename ImageType::Pointer& information)
+{
   typedef itk::ImageSeriesReader<ImageType> ReaderType;
 
   io = itk::GDCMImageIO::New();
@@ -49,17 +125,97 @@ mitk::ITKDICOMSeriesReaderHelper
                              // see NormalDirectionConsistencySorter.
 
   reader->SetFileNames(filenames);
-  reader->Update();
-  typename ImageType::Pointer readVolume = reader->GetOutput();
+
+  // the series reader only reads the headers here, its geometry is used for the decoded slices
+  reader->UpdateOutputInformation();
+  information = ImageType::New();
+  information->CopyInformation(reader->GetOutput());
+  information->SetRegions(reader->GetOutput()->GetLargestPossibleRegion());
+
+  // multi-frame files contribute more than one slice, they are left to the series reader
+  return filenames.size() > 1 && information->GetLargestPossibleRegion().GetSize()[2] == filenames.size();
+}
+
+template <typename ImageType>
+void
+mitk::ITKDICOMSeriesReaderHelper
+::LoadBlock(
+    const StringContainer& filenames,
+    bool correctTilt,
+    const GantryTiltInformation& tiltInfo,
+    itk::GDCMImageIO::Pointer& io,
+    Image* image,
+    unsigned int timeStep,
+    unsigned int numberOfTimeSteps)
+{
+  typedef typename ImageType::PixelType PixelType;
+  typedef itk::ImageSeriesReader<ImageType> ReaderType;
+
+  typename ImageType::Pointer readVolume;
+  const bool decodeSlices = ReadBlockInformation<ImageType>(filenames, io, readVolume);
+  const typename ImageType::SizeType size = readVolume->GetLargestPossibleRegion().GetSize();
+
+  if (decodeSlices && !correctTilt)
+  {
+    if (timeStep == 0)
+    {
+      image->InitializeByItk(readVolume.GetPointer(), 1, numberOfTimeSteps);
+    }
+    else if (size[0] != image->GetDimension(0) || size[1] != image->GetDimension(1) || size[2] != image->GetDimension(2))
+    {
+      mitkThrow() << "Time step " << timeStep << " has size [" << size[0] << ", " << size[1] << ", " << size[2]
+                  << "], which differs from the size of the first time step";
+    }
+
+    // the slices are decoded in parallel, directly into the buffer of the result
+    mitk::ImageWriteAccessor accessor(image, image->GetVolumeData(timeStep));
+    DecodeSlices<PixelType>(filenames, size[0], size[1], static_cast<PixelType*>(accessor.GetData()));
+    return;
+  }
+
+  if (decodeSlices)
+  {
+    readVolume->Allocate();
+    DecodeSlices<PixelType>(filenames, size[0], size[1], readVolume->GetBufferPointer());
+  }
+  else
+  {
+    typename ReaderType::Pointer reader = ReaderType::New();
+    reader->SetImageIO(io);
+    reader->ReverseOrderOff();
+    reader->SetFileNames(filenames);
+    reader->Update();
+    readVolume = reader->GetOutput();
+  }
 
   // if we detected that the images are from a tilted gantry acquisition, we need to push some pixels into the right position
   if (correctTilt)
   {
-    readVolume = FixUpTiltedGeometry( reader->GetOutput(), tiltInfo );
+    readVolume = FixUpTiltedGeometry( readVolume.GetPointer(), tiltInfo );
   }
 
-  image->InitializeByItk(readVolume.GetPointer());
-  image->SetImportVolume(readVolume->GetBufferPointer());
+  if (timeStep == 0)
+  {
+    image->InitializeByItk(readVolume.GetPointer(), 1, numberOfTimeSteps);
+  }
+  image->SetImportVolume(readVolume->GetBufferPointer(), timeStep);
+}
+
+template <typename PixelType>
+mitk::Image::Pointer
+mitk::ITKDICOMSeriesReaderHelper
+::LoadDICOMByITK(
+    const StringContainer& filenames,
+    bool correctTilt,
+    const GantryTiltInformation& tiltInfo,
+    itk::GDCMImageIO::Pointer& io)
+{
+  /******** Normal Case, 3D (also for GDCM < 2 usable) ***************/
+  mitk::Image::Pointer image = mitk::Image::New();
+
+  typedef itk::Image<PixelType, 3> ImageType;
+
+  LoadBlock<ImageType>(filenames, correctTilt, tiltInfo, io, image, 0, 1);
 
 #ifdef MBILOG_ENABLE_DEBUG
 
@@ -104,41 +260,9 @@ mitk::ITKDICOMSeriesReaderHelper
   mitk::Image::Pointer image = mitk::Image::New();
 
   typedef itk::Image<PixelType, 4> ImageType;
-  typedef itk::ImageSeriesReader<ImageType> ReaderType;
-
-  io = itk::GDCMImageIO::New();
-  typename ReaderType::Pointer reader = ReaderType::New();
-
-  reader->SetImageIO(io);
-  reader->ReverseOrderOff(); // at this point we require an order of input images so that
-                             // the direction between the origin of the first and the last slice
-                             // is the same direction as the image normals! Otherwise we might
-                             // see images upside down. Unclear whether this is a bug in MITK,
-                             // see NormalDirectionConsistencySorter.
-
 
   unsigned int currentTimeStep = 0;
-
-#ifdef MBILOG_ENABLE_DEBUG
-  MITK_DEBUG << "Start loading timestep " << currentTimeStep;
-  MITK_DEBUG_OUTPUT_FILELIST( filenamesForTimeSteps.front() )
-#endif // MBILOG_ENABLE_DEBUG
-
-  reader->SetFileNames(filenamesForTimeSteps.front());
-  reader->Update();
-  typename ImageType::Pointer readVolume = reader->GetOutput();
-
-  // if we detected that the images are from a tilted gantry acquisition, we need to push some pixels into the right position
-  if (correctTilt)
-  {
-    readVolume = FixUpTiltedGeometry( reader->GetOutput(), tiltInfo );
-  }
-
-  image->InitializeByItk(readVolume.GetPointer(), 1, numberOfTimeSteps);
-  image->SetImportVolume(readVolume->GetBufferPointer(), currentTimeStep++); // timestep 0
-
-  // for other time-steps
-  for (auto timestepsIter = ++(filenamesForTimeSteps.cbegin()); // start with SECOND entry
+  for (auto timestepsIter = filenamesForTimeSteps.cbegin();
       timestepsIter != filenamesForTimeSteps.cend();
       ++currentTimeStep, ++timestepsIter)
   {
@@ -147,16 +271,7 @@ mitk::ITKDICOMSeriesReaderHelper
     MITK_DEBUG_OUTPUT_FILELIST( *timestepsIter )
 #endif // MBILOG_ENABLE_DEBUG
 
-    reader->SetFileNames( *timestepsIter );
-    reader->Update();
-    readVolume = reader->GetOutput();
-
-    if (correctTilt)
-    {
-      readVolume = FixUpTiltedGeometry( reader->GetOutput(), tiltInfo );
-    }
-
-    image->SetImportVolume(readVolume->GetBufferPointer(), currentTimeStep);
+    LoadBlock<ImageType>(*timestepsIter, correctTilt, tiltInfo, io, image, currentTimeStep, numberOfTimeSteps);
   }
 
 #ifdef MBILOG_ENABLE_DEBUG
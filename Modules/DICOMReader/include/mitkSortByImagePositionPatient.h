@@ -60,6 +60,15 @@ class MITKDICOMREADER_EXPORT SortByImagePositionPatient : public DICOMSortCriter
 
     double InternalNumericDistance(const mitk::DICOMDatasetAccess* from, const mitk::DICOMDatasetAccess* to, bool& possible) const;
 
+    /// \brief Distance of the origins along the normal of the left orientation, values are origin, right and up vector.
+    static double InternalNumericDistance(const double* left, const double* right, bool& possible);
+
+    /// \brief Origin and orientation vectors, parsed once per dataset.
+    unsigned int GetNumberOfSortKeyValues() const override;
+    void ExtractSortKeyValues(const mitk::DICOMDatasetAccess* dataset, double* values) const override;
+    int CompareSortKeyValues(const double* left, const double* right) const override;
+    double NumericDistanceOfSortKeyValues(const double* from, const double* to) const override;
+
   private:
 };
 
@@ -17,9 +17,16 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkDICOMDCMTKTagScanner.h"
 #include "mitkDICOMGenericImageFrameInfo.h"
 
+#include <dcmtk/dcmdata/dcdeftag.h>
 #include <dcmtk/dcmdata/dcfilefo.h>
 #include <dcmtk/dcmdata/dcpath.h>
 
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <thread>
+
 mitk::DICOMDCMTKTagScanner::DICOMDCMTKTagScanner()
 {
 }
@@ -102,61 +109,188 @@ mitk::DICOMTagPath DcmPathToTagPath(DcmPath * dcmpath)
   return result;
 }
 
+namespace
+{
+  /** Returns the first top level element that is not needed any more to find all paths,
+   DCM_UndefinedTagKey if the whole data set has to be parsed. Pixel data is never needed
+   unless it is requested itself.*/
+  DcmTagKey GetStopParsingTag(const std::set<mitk::DICOMTagPath>& paths)
+  {
+    DcmTagKey lastTag(0, 0);
+    for (const auto& path : paths)
+    {
+      if (path.Size() == 0 || path.GetFirstNode().type == mitk::DICOMTagPath::NodeInfo::NodeType::AnyElement ||
+          path.GetFirstNode().type == mitk::DICOMTagPath::NodeInfo::NodeType::Invalid)
+      {
+        return DCM_UndefinedTagKey;
+      }
+      const DcmTagKey tag(path.GetFirstNode().tag.GetGroup(), path.GetFirstNode().tag.GetElement());
+      if (lastTag < tag)
+      {
+        lastTag = tag;
+      }
+    }
+
+    if (lastTag.getElement() < 0xFFFF)
+    {
+      return DcmTagKey(lastTag.getGroup(), lastTag.getElement() + 1);
+    }
+    if (lastTag.getGroup() < 0xFFFF)
+    {
+      return DcmTagKey(lastTag.getGroup() + 1, 0);
+    }
+    return DCM_UndefinedTagKey;
+  }
+
+  const char* const PersistentCacheScannerName = "dcmtk";
+
+  /** Scans fileName for paths. All found values are also added to persistentValues, keyed by
+   the property name of their path.*/
+  mitk::DICOMGenericImageFrameInfo::Pointer ScanFile(const std::string& fileName, const std::set<mitk::DICOMTagPath>& paths,
+                                                     DcmPathProcessor& processor, const DcmTagKey& stopTag,
+                                                     mitk::DICOMPersistentTagCache::ValueListType& persistentValues)
+  {
+    DcmFileFormat dfile;
+    OFCondition cond = dfile.loadFileUntilTag(fileName.c_str(), EXS_Unknown, EGL_noChange, DCM_MaxReadLength, ERM_autoDetect, stopTag);
+    if (cond.bad())
+    {
+      MITK_ERROR << "Error when scanning for tags. Cannot open given file. File: " << fileName;
+      return nullptr;
+    }
+
+    mitk::DICOMGenericImageFrameInfo::Pointer info = mitk::DICOMGenericImageFrameInfo::New(fileName);
+
+    for (const auto& path : paths)
+    {
+      std::string tagPath = mitk::DICOMTagPathToDCMTKSearchPath(path);
+      cond = processor.findOrCreatePath(dfile.getDataset(), tagPath.c_str());
+      if (cond.good())
+      {
+        OFList< DcmPath * > findings;
+        processor.getResults(findings);
+        for (const auto& finding : findings)
+        {
+          auto element = dynamic_cast<DcmElement*>(finding->back()->m_obj);
+          if (!element)
+          {
+            auto item = dynamic_cast<DcmItem*>(finding->back()->m_obj);
+            if (item)
+            {
+              element = item->getElement(finding->back()->m_itemNo);
+            }
+          }
+
+          if (element)
+          {
+            OFString value;
+            cond = element->getOFStringArray(value);
+            if (cond.good())
+            {
+              const mitk::DICOMTagPath foundPath = DcmPathToTagPath(finding);
+              info->SetTagValue(foundPath, std::string(value.c_str()));
+              persistentValues.push_back(std::make_pair(mitk::DICOMTagPathToPropertyName(foundPath), std::string(value.c_str())));
+            }
+          }
+        }
+      }
+    }
+    return info;
+  }
+}
+
 void mitk::DICOMDCMTKTagScanner::Scan()
 {
+  const auto start = std::chrono::steady_clock::now();
+
   this->PushLocale();
 
   try
   {
-    DcmPathProcessor processor;
-    processor.setItemWildcardSupport(true);
+    const DcmTagKey stopTag = GetStopParsingTag(this->m_ScannedTags);
+    const std::size_t numberOfFiles = this->m_InputFilenames.size();
 
-    DICOMGenericTagCache::Pointer newCache = DICOMGenericTagCache::New();
+    DICOMPersistentTagCache::Pointer persistentCache = this->GetPersistentTagCache();
+    std::set<std::string> queryNames;
+    for (const auto& path : this->m_ScannedTags)
+    {
+      queryNames.insert(DICOMTagPathToPropertyName(path));
+    }
+    std::atomic<bool> persistentCacheChanged(false);
 
-    for (const auto& fileName : this->m_InputFilenames)
+    // Files are handed out one by one, the results keep the order of the input files
+    std::vector<DICOMGenericImageFrameInfo::Pointer> infos(numberOfFiles);
+    std::atomic<std::size_t> nextFile(0);
+    std::exception_ptr exception;
+    std::mutex exceptionMutex;
+
+    auto worker = [&]()
     {
-      DcmFileFormat dfile;
-      OFCondition cond = dfile.loadFile(fileName.c_str());
-      if (cond.bad())
-      {
-        MITK_ERROR << "Error when scanning for tags. Cannot open given file. File: " << fileName;
-      }
-      else
-      {
-        DICOMGenericImageFrameInfo::Pointer info = DICOMGenericImageFrameInfo::New(fileName);
+      DcmPathProcessor processor;
+      processor.setItemWildcardSupport(true);
 
-        for (const auto& path : this->m_ScannedTags)
+      for (std::size_t i = nextFile++; i < numberOfFiles; i = nextFile++)
+      {
+        try
         {
-          std::string tagPath = DICOMTagPathToDCMTKSearchPath(path);
-          cond = processor.findOrCreatePath(dfile.getDataset(), tagPath.c_str());
-          if (cond.good())
+          const std::string& fileName = this->m_InputFilenames[i];
+          DICOMPersistentTagCache::ValueListType values;
+
+          // Files that are unchanged since an earlier scan for the same paths are not scanned again
+          if (persistentCache.IsNotNull() && persistentCache->Lookup(PersistentCacheScannerName, fileName, queryNames, values))
           {
-            OFList< DcmPath * > findings;
-            processor.getResults(findings);
-            for (const auto& finding : findings)
+            infos[i] = DICOMGenericImageFrameInfo::New(fileName);
+            for (const auto& value : values)
             {
-              auto element = dynamic_cast<DcmElement*>(finding->back()->m_obj);
-              if (!element)
-              {
-                auto item = dynamic_cast<DcmItem*>(finding->back()->m_obj);
-                if (item)
-                {
-                  element = item->getElement(finding->back()->m_itemNo);
-                }
-              }
-
-              if (element)
-              {
-                OFString value;
-                cond = element->getOFStringArray(value);
-                if (cond.good())
-                {
-                  info->SetTagValue(DcmPathToTagPath(finding), std::string(value.c_str()));
-                }
-              }
+              infos[i]->SetTagValue(PropertyNameToDICOMTagPath(value.first), value.second);
             }
+            continue;
           }
+
+          infos[i] = ScanFile(fileName, this->m_ScannedTags, processor, stopTag, values);
+          if (persistentCache.IsNotNull() && infos[i].IsNotNull())
+          {
+            persistentCache->Store(PersistentCacheScannerName, fileName, queryNames, values);
+            persistentCacheChanged = true;
+          }
+        }
+        catch (...)
+        {
+          std::lock_guard<std::mutex> lock(exceptionMutex);
+          if (!exception)
+            exception = std::current_exception();
+          nextFile = numberOfFiles;
+          return;
         }
+      }
+    };
+
+    const unsigned int numberOfThreads = this->GetNumberOfScanThreads(numberOfFiles);
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < numberOfThreads; ++i)
+    {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+
+    if (exception)
+    {
+      std::rethrow_exception(exception);
+    }
+
+    if (persistentCacheChanged)
+    {
+      this->SavePersistentTagCache();
+    }
+
+    DICOMGenericTagCache::Pointer newCache = DICOMGenericTagCache::New();
+    for (const auto& info : infos)
+    {
+      if (info.IsNotNull())
+      {
         newCache->AddFrameInfo(info);
       }
     }
@@ -170,6 +304,8 @@ void mitk::DICOMDCMTKTagScanner::Scan()
     this->PopLocale();
     throw;
   }
+
+  this->ReportScanThroughput(m_InputFilenames.size(), std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
 }
 
 mitk::DICOMTagCache::Pointer
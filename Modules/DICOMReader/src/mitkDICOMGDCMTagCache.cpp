@@ -18,6 +18,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkDICOMEnums.h"
 #include "mitkDICOMGDCMImageFrameInfo.h"
 
+#include <mitkExceptionMacro.h>
+
 mitk::DICOMGDCMTagCache::DICOMGDCMTagCache()
 {
 }
@@ -87,22 +89,65 @@ mitk::DICOMDatasetAccessingImageFrameList mitk::DICOMGDCMTagCache::GetFrameInfoL
 void
 mitk::DICOMGDCMTagCache::InitCache(const std::set<DICOMTag>& scannedTags, const std::shared_ptr<gdcm::Scanner>& scanner, const StringList& inputFiles)
 {
+  this->InitCache(scannedTags, std::vector<std::shared_ptr<gdcm::Scanner> >(1, scanner), inputFiles);
+}
+
+void
+mitk::DICOMGDCMTagCache::InitCache(const std::set<DICOMTag>& scannedTags, const std::vector<std::shared_ptr<gdcm::Scanner> >& scanners, const StringList& inputFiles,
+  const PersistentValuesType& persistentValues)
+{
+  if (scanners.empty())
+  {
+    mitkThrow() << "Invalid call to DICOMGDCMTagCache::InitCache(). No scanner given.";
+  }
+
   m_ScannedTags = scannedTags;
   m_InputFilenames = inputFiles;
-  m_Scanner = scanner;
+  m_Scanners = scanners;
+  m_PersistentValues.clear();
 
   m_ScanResult.clear();
   m_ScanResult.reserve(m_InputFilenames.size());
 
   for (auto inputIter = m_InputFilenames.cbegin(); inputIter != m_InputFilenames.cend(); ++inputIter)
   {
+    const auto persistentFinding = persistentValues.find(*inputIter);
+    if (persistentFinding != persistentValues.cend())
+    {
+      gdcm::Scanner::TagToValue mapping;
+      for (const auto& value : persistentFinding->second)
+      {
+        m_PersistentValues.push_back(value.second);
+        mapping[gdcm::Tag(value.first.GetGroup(), value.first.GetElement())] = m_PersistentValues.back().c_str();
+      }
+      m_ScanResult.push_back(DICOMGDCMImageFrameInfo::New(DICOMImageFrameInfo::New(*inputIter, 0), mapping).GetPointer());
+      continue;
+    }
+
+    // files that could not be read are known to no scanner and get an empty mapping, like with a single scanner
+    const gdcm::Scanner* fileScanner = m_Scanners.front().get();
+    for (const auto& scanner : m_Scanners)
+    {
+      if (scanner->IsKey(inputIter->c_str()))
+      {
+        fileScanner = scanner.get();
+        break;
+      }
+    }
+
     m_ScanResult.push_back(DICOMGDCMImageFrameInfo::New(DICOMImageFrameInfo::New(*inputIter, 0),
-      m_Scanner->GetMapping(inputIter->c_str())).GetPointer());
+      fileScanner->GetMapping(inputIter->c_str())).GetPointer());
   }
 }
 
 const gdcm::Scanner&
 mitk::DICOMGDCMTagCache::GetScanner() const
 {
-  return *(this->m_Scanner);
+  return *(this->m_Scanners.front());
+}
+
+const std::vector<std::shared_ptr<gdcm::Scanner> >&
+mitk::DICOMGDCMTagCache::GetScanners() const
+{
+  return this->m_Scanners;
 }
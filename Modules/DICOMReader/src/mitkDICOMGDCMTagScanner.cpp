@@ -20,9 +20,19 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <gdcmScanner.h>
 
+#include <chrono>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+  const char* const PersistentCacheScannerName = "gdcm";
+}
+
 mitk::DICOMGDCMTagScanner::DICOMGDCMTagScanner()
 {
-  m_GDCMScanner = std::make_shared<gdcm::Scanner>();
 }
 
 mitk::DICOMGDCMTagScanner::~DICOMGDCMTagScanner()
@@ -44,9 +54,7 @@ mitk::DICOMDatasetFinding mitk::DICOMGDCMTagScanner::GetTagValue( DICOMImageFram
 
 void mitk::DICOMGDCMTagScanner::AddTag( const DICOMTag& tag )
 {
-  m_ScannedTags.insert( tag );
-  m_GDCMScanner->AddTag(
-    gdcm::Tag( tag.GetGroup(), tag.GetElement() ) ); // also a set, duplicate calls to AddTag don't hurt
+  m_ScannedTags.insert( tag ); // a set, duplicate calls to AddTag don't hurt
 }
 
 void mitk::DICOMGDCMTagScanner::AddTags( const DICOMTagList& tags )
@@ -96,13 +104,127 @@ void mitk::DICOMGDCMTagScanner::SetInputFiles( const StringList& filenames )
 
 void mitk::DICOMGDCMTagScanner::Scan()
 {
-  // TODO integrate push/pop locale??
-  m_GDCMScanner->Scan( m_InputFilenames );
+  const auto start = std::chrono::steady_clock::now();
+
+  // Files that are unchanged since an earlier scan for the same tags are not scanned again
+  DICOMPersistentTagCache::Pointer persistentCache = this->GetPersistentTagCache();
+  std::map<std::string, DICOMTag> queries;
+  for (const auto& tag : m_ScannedTags)
+  {
+    queries.insert(std::make_pair(DICOMTagPathToPropertyName(DICOMTagPath(tag)), tag));
+  }
+  std::set<std::string> queryNames;
+  for (const auto& query : queries)
+  {
+    queryNames.insert(query.first);
+  }
+
+  DICOMGDCMTagCache::PersistentValuesType persistentValues;
+  StringList filesToScan;
+  for (const auto& fileName : m_InputFilenames)
+  {
+    DICOMPersistentTagCache::ValueListType values;
+    if (persistentCache.IsNotNull() && persistentCache->Lookup(PersistentCacheScannerName, fileName, queryNames, values))
+    {
+      auto& fileValues = persistentValues[fileName];
+      for (const auto& value : values)
+      {
+        const auto query = queries.find(value.first);
+        if (query != queries.cend())
+        {
+          fileValues[query->second] = value.second;
+        }
+      }
+    }
+    else
+    {
+      filesToScan.push_back(fileName);
+    }
+  }
+
+  // Contiguous parts, each scanned by its own gdcm::Scanner
+  const unsigned int numberOfParts = this->GetNumberOfScanThreads(filesToScan.size());
+  std::vector<StringList> parts(numberOfParts);
+  for (std::size_t i = 0; i < filesToScan.size(); ++i)
+  {
+    parts[i * numberOfParts / filesToScan.size()].push_back(filesToScan[i]);
+  }
+
+  std::vector<std::shared_ptr<gdcm::Scanner> > scanners(numberOfParts);
+  for (auto& scanner : scanners)
+  {
+    scanner = std::make_shared<gdcm::Scanner>();
+    for (const auto& tag : m_ScannedTags)
+    {
+      scanner->AddTag(gdcm::Tag(tag.GetGroup(), tag.GetElement()));
+    }
+  }
+
+  std::exception_ptr exception;
+  std::mutex exceptionMutex;
+  auto scanPart = [&](unsigned int part)
+  {
+    try
+    {
+      // TODO integrate push/pop locale??
+      scanners[part]->Scan(parts[part]);
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(exceptionMutex);
+      if (!exception)
+        exception = std::current_exception();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned int part = 1; part < numberOfParts; ++part)
+  {
+    threads.emplace_back(scanPart, part);
+  }
+  scanPart(0);
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  if (exception)
+  {
+    std::rethrow_exception(exception);
+  }
+
+  if (persistentCache.IsNotNull() && !filesToScan.empty())
+  {
+    for (unsigned int part = 0; part < numberOfParts; ++part)
+    {
+      for (const auto& fileName : parts[part])
+      {
+        if (!scanners[part]->IsKey(fileName.c_str()))
+        {
+          continue; // not readable, try again next time
+        }
+
+        DICOMPersistentTagCache::ValueListType values;
+        for (const auto& value : scanners[part]->GetMapping(fileName.c_str()))
+        {
+          if (value.second != nullptr)
+          {
+            values.push_back(std::make_pair(
+              DICOMTagPathToPropertyName(DICOMTagPath(value.first.GetGroup(), value.first.GetElement())), std::string(value.second)));
+          }
+        }
+        persistentCache->Store(PersistentCacheScannerName, fileName, queryNames, values);
+      }
+    }
+    this->SavePersistentTagCache();
+  }
 
   DICOMGDCMTagCache::Pointer newCache = DICOMGDCMTagCache::New();
-  newCache->InitCache(m_ScannedTags, m_GDCMScanner, m_InputFilenames);
+  newCache->InitCache(m_ScannedTags, scanners, m_InputFilenames, persistentValues);
 
   m_Cache = newCache;
+
+  this->ReportScanThroughput(m_InputFilenames.size(), std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
 }
 
 mitk::DICOMTagCache::Pointer
@@ -0,0 +1,317 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkDICOMPersistentTagCache.h"
+
+#include <mitkExceptionMacro.h>
+#include <mitkLogMacros.h>
+
+#include <itksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+  // File layout: magic, number of entries, per entry: scanner, file name, size,
+  // modification time, queries, key value pairs. Strings are stored with their
+  // length, so that values may contain any character.
+  const char FileMagic[8] = { 'M', 'I', 'T', 'K', 'D', 'T', 'C', '1' };
+
+  std::mutex s_DefaultMutex;
+  bool s_DefaultInitialized = false;
+  mitk::DICOMPersistentTagCache::Pointer s_Default;
+
+  void WriteUInt64(std::ostream& stream, std::uint64_t value)
+  {
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  void WriteString(std::ostream& stream, const std::string& value)
+  {
+    WriteUInt64(stream, value.size());
+    stream.write(value.data(), value.size());
+  }
+
+  std::uint64_t ReadUInt64(std::istream& stream)
+  {
+    std::uint64_t value = 0;
+    stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+    if (!stream)
+    {
+      mitkThrow() << "unexpected end of file";
+    }
+    return value;
+  }
+
+  std::string ReadString(std::istream& stream)
+  {
+    const std::uint64_t length = ReadUInt64(stream);
+    std::string value;
+    // read in blocks, so that a corrupt length does not allocate arbitrary memory
+    while (value.size() < length)
+    {
+      char buffer[4096];
+      const std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(sizeof(buffer), length - value.size()));
+      stream.read(buffer, count);
+      if (!stream)
+      {
+        mitkThrow() << "unexpected end of file";
+      }
+      value.append(buffer, count);
+    }
+    return value;
+  }
+}
+
+mitk::DICOMPersistentTagCache::DICOMPersistentTagCache()
+  : m_Changed(false)
+{
+}
+
+mitk::DICOMPersistentTagCache::~DICOMPersistentTagCache()
+{
+}
+
+mitk::DICOMPersistentTagCache::Pointer mitk::DICOMPersistentTagCache::GetDefault()
+{
+  std::lock_guard<std::mutex> lock(s_DefaultMutex);
+  if (!s_DefaultInitialized)
+  {
+    s_DefaultInitialized = true;
+    const char* fileName = std::getenv("MITK_DICOM_TAG_CACHE_FILE");
+    if (fileName != nullptr && *fileName != '\0')
+    {
+      s_Default = DICOMPersistentTagCache::New();
+      s_Default->SetFileName(fileName);
+      s_Default->Load();
+    }
+  }
+  return s_Default;
+}
+
+void mitk::DICOMPersistentTagCache::SetDefault(Pointer cache)
+{
+  std::lock_guard<std::mutex> lock(s_DefaultMutex);
+  s_DefaultInitialized = true;
+  s_Default = cache;
+}
+
+void mitk::DICOMPersistentTagCache::SetFileName(const std::string& fileName)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_FileName = fileName;
+}
+
+std::string mitk::DICOMPersistentTagCache::GetFileName() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_FileName;
+}
+
+void mitk::DICOMPersistentTagCache::Load()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+
+  m_Entries.clear();
+  m_Changed = false;
+
+  std::ifstream stream(m_FileName.c_str(), std::ios::binary);
+  if (!stream.is_open())
+  {
+    return;
+  }
+
+  std::map<EntryKeyType, Entry> entries;
+  try
+  {
+    char magic[sizeof(FileMagic)];
+    stream.read(magic, sizeof(magic));
+    if (!stream || std::memcmp(magic, FileMagic, sizeof(FileMagic)) != 0)
+    {
+      mitkThrow() << "not a DICOM tag cache";
+    }
+
+    const std::uint64_t numberOfEntries = ReadUInt64(stream);
+    for (std::uint64_t i = 0; i < numberOfEntries; ++i)
+    {
+      EntryKeyType key;
+      key.first = ReadString(stream);
+      key.second = ReadString(stream);
+
+      Entry entry;
+      entry.size = ReadUInt64(stream);
+      entry.modificationTime = static_cast<std::int64_t>(ReadUInt64(stream));
+      const std::uint64_t numberOfQueries = ReadUInt64(stream);
+      for (std::uint64_t q = 0; q < numberOfQueries; ++q)
+      {
+        entry.queries.insert(ReadString(stream));
+      }
+      const std::uint64_t numberOfValues = ReadUInt64(stream);
+      for (std::uint64_t v = 0; v < numberOfValues; ++v)
+      {
+        std::string valueKey = ReadString(stream);
+        entry.values[valueKey] = ReadString(stream);
+      }
+      entries[key] = entry;
+    }
+  }
+  catch (const mitk::Exception& e)
+  {
+    MITK_WARN << "Ignoring DICOM tag cache " << m_FileName << ": " << e.GetDescription();
+    return;
+  }
+
+  m_Entries.swap(entries);
+}
+
+void mitk::DICOMPersistentTagCache::Save()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+
+  if (!m_Changed || m_FileName.empty())
+  {
+    return;
+  }
+
+  // write to a temporary file first, so that an interrupted save does not destroy the cache
+  const std::string temporaryFileName = m_FileName + ".tmp";
+  {
+    std::ofstream stream(temporaryFileName.c_str(), std::ios::binary | std::ios::trunc);
+    if (!stream.is_open())
+    {
+      mitkThrow() << "Cannot open DICOM tag cache " << temporaryFileName << " for writing";
+    }
+
+    stream.write(FileMagic, sizeof(FileMagic));
+    WriteUInt64(stream, m_Entries.size());
+    for (const auto& entry : m_Entries)
+    {
+      WriteString(stream, entry.first.first);
+      WriteString(stream, entry.first.second);
+      WriteUInt64(stream, entry.second.size);
+      WriteUInt64(stream, static_cast<std::uint64_t>(entry.second.modificationTime));
+      WriteUInt64(stream, entry.second.queries.size());
+      for (const auto& query : entry.second.queries)
+      {
+        WriteString(stream, query);
+      }
+      WriteUInt64(stream, entry.second.values.size());
+      for (const auto& value : entry.second.values)
+      {
+        WriteString(stream, value.first);
+        WriteString(stream, value.second);
+      }
+    }
+
+    stream.close();
+    if (stream.fail())
+    {
+      mitkThrow() << "Writing DICOM tag cache " << temporaryFileName << " failed";
+    }
+  }
+
+  std::remove(m_FileName.c_str());
+  if (std::rename(temporaryFileName.c_str(), m_FileName.c_str()) != 0)
+  {
+    mitkThrow() << "Cannot replace DICOM tag cache " << m_FileName;
+  }
+
+  m_Changed = false;
+}
+
+bool mitk::DICOMPersistentTagCache::GetFileState(const std::string& fileName, std::uint64_t& size, std::int64_t& modificationTime)
+{
+  if (!itksys::SystemTools::FileExists(fileName.c_str(), true))
+  {
+    return false;
+  }
+  size = itksys::SystemTools::FileLength(fileName);
+  modificationTime = itksys::SystemTools::ModifiedTime(fileName);
+  return true;
+}
+
+bool mitk::DICOMPersistentTagCache::Lookup(const std::string& scanner, const std::string& fileName, const std::set<std::string>& queries, ValueListType& values) const
+{
+  std::uint64_t size;
+  std::int64_t modificationTime;
+  if (!GetFileState(fileName, size, modificationTime))
+  {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+
+  const auto finding = m_Entries.find(EntryKeyType(scanner, fileName));
+  if (finding == m_Entries.cend())
+  {
+    return false;
+  }
+
+  const Entry& entry = finding->second;
+  if (entry.size != size || entry.modificationTime != modificationTime ||
+      !std::includes(entry.queries.cbegin(), entry.queries.cend(), queries.cbegin(), queries.cend()))
+  {
+    return false;
+  }
+
+  values.assign(entry.values.cbegin(), entry.values.cend());
+  return true;
+}
+
+void mitk::DICOMPersistentTagCache::Store(const std::string& scanner, const std::string& fileName, const std::set<std::string>& queries, const ValueListType& values)
+{
+  std::uint64_t size;
+  std::int64_t modificationTime;
+  if (!GetFileState(fileName, size, modificationTime))
+  {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+
+  Entry& entry = m_Entries[EntryKeyType(scanner, fileName)];
+  if (entry.size != size || entry.modificationTime != modificationTime)
+  {
+    entry.size = size;
+    entry.modificationTime = modificationTime;
+    entry.queries.clear();
+    entry.values.clear();
+  }
+
+  entry.queries.insert(queries.cbegin(), queries.cend());
+  for (const auto& value : values)
+  {
+    entry.values[value.first] = value.second;
+  }
+  m_Changed = true;
+}
+
+std::size_t mitk::DICOMPersistentTagCache::GetNumberOfEntries() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Entries.size();
+}
+
+void mitk::DICOMPersistentTagCache::Clear()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Changed = m_Changed || !m_Entries.empty();
+  m_Entries.clear();
+}
@@ -179,3 +179,38 @@ mitk::DICOMSortByTag
   return toDouble - fromDouble;
   // TODO second-level compare?
 }
+
+unsigned int
+mitk::DICOMSortByTag
+::GetNumberOfSortKeyValues() const
+{
+  return 1;
+}
+
+void
+mitk::DICOMSortByTag
+::ExtractSortKeyValues(const mitk::DICOMDatasetAccess* dataset, double* values) const
+{
+  assert(dataset);
+
+  // invalid findings have an empty value, which converts to 0 like in NumericCompare()
+  values[0] = OFStandard::atof( dataset->GetTagValueAsString(m_Tag).value.c_str() );
+}
+
+int
+mitk::DICOMSortByTag
+::CompareSortKeyValues(const double* left, const double* right) const
+{
+  if ( left[0] != right[0] ) // can we decide?
+  {
+    return left[0] < right[0] ? -1 : 1;
+  }
+  return 0; // ask secondary criterion
+}
+
+double
+mitk::DICOMSortByTag
+::NumericDistanceOfSortKeyValues(const double* from, const double* to) const
+{
+  return to[0] - from[0];
+}
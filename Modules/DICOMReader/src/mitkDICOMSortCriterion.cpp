@@ -84,3 +84,92 @@ mitk::DICOMSortCriterion
     return (void*)left < (void*)right;
   }
 }
+
+mitk::DICOMSortCriterion::SortKey
+mitk::DICOMSortCriterion
+::ExtractSortKey(const mitk::DICOMDatasetAccess* dataset) const
+{
+  assert(dataset);
+
+  SortKey key;
+  key.dataset = dataset;
+
+  // criteria without typed values, and all of their secondary criteria, work on the dataset
+  for (const DICOMSortCriterion* criterion = this;
+       criterion && criterion->GetNumberOfSortKeyValues() > 0;
+       criterion = criterion->m_SecondaryCriterion.GetPointer())
+  {
+    const std::size_t offset = key.values.size();
+    key.values.resize(offset + criterion->GetNumberOfSortKeyValues());
+    criterion->ExtractSortKeyValues(dataset, key.values.data() + offset);
+  }
+
+  return key;
+}
+
+bool
+mitk::DICOMSortCriterion
+::IsLeftKeyBeforeRightKey(const SortKey& left, const SortKey& right) const
+{
+  std::size_t offset = 0;
+  for (const DICOMSortCriterion* criterion = this;
+       criterion;
+       criterion = criterion->m_SecondaryCriterion.GetPointer())
+  {
+    const unsigned int numberOfValues = criterion->GetNumberOfSortKeyValues();
+    if (numberOfValues == 0)
+    {
+      return criterion->IsLeftBeforeRight(left.dataset, right.dataset);
+    }
+
+    const int comparison = criterion->CompareSortKeyValues(left.values.data() + offset, right.values.data() + offset);
+    if (comparison != 0)
+    {
+      return comparison < 0;
+    }
+
+    offset += numberOfValues;
+  }
+
+  // same as NextLevelIsLeftBeforeRight() of the last criterion
+  return (void*)left.dataset < (void*)right.dataset;
+}
+
+double
+mitk::DICOMSortCriterion
+::NumericKeyDistance(const SortKey& from, const SortKey& to) const
+{
+  if (this->GetNumberOfSortKeyValues() == 0)
+  {
+    return this->NumericDistance(from.dataset, to.dataset);
+  }
+
+  return this->NumericDistanceOfSortKeyValues(from.values.data(), to.values.data());
+}
+
+unsigned int
+mitk::DICOMSortCriterion
+::GetNumberOfSortKeyValues() const
+{
+  return 0;
+}
+
+void
+mitk::DICOMSortCriterion
+::ExtractSortKeyValues(const mitk::DICOMDatasetAccess* /*dataset*/, double* /*values*/) const
+{
+}
+
+int
+mitk::DICOMSortCriterion
+::CompareSortKeyValues(const double* /*left*/, const double* /*right*/) const
+{
+  return 0;
+}
+
+double
+mitk::DICOMSortCriterion
+::NumericDistanceOfSortKeyValues(const double* /*from*/, const double* /*to*/) const
+{
+  return 0.0;
+}
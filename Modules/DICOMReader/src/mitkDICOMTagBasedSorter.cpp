@@ -397,6 +397,9 @@ mitk::DICOMTagBasedSorter
     //    - sorting order (ascending, descending)
     //    - sort numerically
     //    - ... ?
+    typedef std::vector<DICOMSortCriterion::SortKey> SortKeyList;
+    std::map<std::string, SortKeyList> keysForGroupID;
+
     unsigned int groupIndex(0);
     for (auto gIter = groups.begin();
          gIter != groups.end();
@@ -416,7 +419,20 @@ mitk::DICOMTagBasedSorter
 #endif // #ifdef MBILOG_ENABLE_DEBUG
 
 
-      std::sort( dsList.begin(), dsList.end(), ParameterizedDatasetSort( m_SortCriterion ) );
+      // convert the sorting relevant tags once per dataset instead of once per comparison
+      SortKeyList& keys = keysForGroupID[gIter->first];
+      keys.reserve(dsList.size());
+      for (auto dataset = dsList.cbegin(); dataset != dsList.cend(); ++dataset)
+      {
+        keys.push_back( m_SortCriterion->ExtractSortKey(*dataset) );
+      }
+
+      std::sort( keys.begin(), keys.end(), ParameterizedDatasetSort( m_SortCriterion ) );
+
+      for (std::size_t keyIndex = 0; keyIndex < keys.size(); ++keyIndex)
+      {
+        dsList[keyIndex] = const_cast<DICOMDatasetAccess*>(keys[keyIndex].dataset);
+      }
 
 #ifdef MBILOG_ENABLE_DEBUG
       MITK_DEBUG << "   --------------------------------------------------------------------------------";
@@ -446,7 +462,7 @@ mitk::DICOMTagBasedSorter
         groupKey << std::setfill('0') << std::setw(6) << groupIndex++;
 
         DICOMDatasetList& dsList = gIter->second;
-        DICOMDatasetAccess* previousDS(nullptr);
+        const SortKeyList& keys = keysForGroupID[gIter->first];
         unsigned int dsIndex(0);
         double constantDistance(0.0);
         bool constantDistanceInitialized(false);
@@ -459,7 +475,7 @@ mitk::DICOMTagBasedSorter
             // for the second and every following dataset:
             // let the sorting criterion calculate a "distance"
             // if the distance is not 1, split off a new group!
-            const double currentDistance = m_SortCriterion->NumericDistance(previousDS, *dataset);
+            const double currentDistance = m_SortCriterion->NumericKeyDistance(keys[dsIndex-1], keys[dsIndex]);
             if (constantDistanceInitialized)
             {
               if (fabs(currentDistance - constantDistance) < fabs(constantDistance * 0.01)) // ok, deviation of up to 1% of distance is tolerated
@@ -509,7 +525,6 @@ mitk::DICOMTagBasedSorter
             }
           }
           consecutiveGroups[groupKey.str()].push_back(*dataset);
-          previousDS = *dataset;
         }
       }
     }
@@ -524,17 +539,19 @@ mitk::DICOMTagBasedSorter
       sort this list-1
       build a new result list-2:
        - iterate list-1, for each dataset
-         - find the group that contains this dataset
+         - find the group that starts with this dataset
          - add this group as the next element to list-2
       return list-2 as the sorted output
     */
-    DICOMDatasetList firstSlices;
+    SortKeyList firstSlices;
+    std::map<const DICOMDatasetAccess*, const DICOMDatasetList*> groupOfFirstSlice;
     for (auto gIter = consecutiveGroups.cbegin();
          gIter != consecutiveGroups.cend();
          ++gIter)
     {
       assert(!gIter->second.empty());
-      firstSlices.push_back(gIter->second.front());
+      firstSlices.push_back( m_SortCriterion->ExtractSortKey(gIter->second.front()) );
+      groupOfFirstSlice[gIter->second.front()] = &(gIter->second);
     }
 
     std::sort( firstSlices.begin(), firstSlices.end(), ParameterizedDatasetSort( m_SortCriterion ) );
@@ -543,19 +560,11 @@ mitk::DICOMTagBasedSorter
     unsigned int groupKeyValue(0);
     for (auto firstSlice = firstSlices.cbegin();
          firstSlice != firstSlices.cend();
-         ++firstSlice)
+         ++groupKeyValue, ++firstSlice)
     {
-      for (auto gIter = consecutiveGroups.cbegin();
-           gIter != consecutiveGroups.cend();
-           ++groupKeyValue, ++gIter)
-      {
-        if (gIter->second.front() == *firstSlice)
-        {
-          std::stringstream groupKey;
-          groupKey << std::setfill('0') << std::setw(6) << groupKeyValue; // try more than 999,999 groups and you are doomed (your application already is)
-          sortedResultBlocks[groupKey.str()] = gIter->second;
-        }
-      }
+      std::stringstream groupKey;
+      groupKey << std::setfill('0') << std::setw(6) << groupKeyValue; // try more than 999,999 groups and you are doomed (your application already is)
+      sortedResultBlocks[groupKey.str()] = *groupOfFirstSlice[firstSlice->dataset];
     }
 
     groups = sortedResultBlocks;
@@ -597,3 +606,12 @@ mitk::DICOMTagBasedSorter::ParameterizedDatasetSort
 
   return m_SortCriterion->IsLeftBeforeRight(left, right);
 }
+
+bool
+mitk::DICOMTagBasedSorter::ParameterizedDatasetSort
+::operator() (const DICOMSortCriterion::SortKey& left, const DICOMSortCriterion::SortKey& right)
+{
+  assert(m_SortCriterion.IsNotNull());
+
+  return m_SortCriterion->IsLeftKeyBeforeRightKey(left, right);
+}
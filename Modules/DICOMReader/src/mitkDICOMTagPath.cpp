@@ -711,7 +711,7 @@ namespace mitk
 
         if (node.type == DICOMTagPath::NodeInfo::NodeType::SequenceSelection)
         {
-          nameStream << ".[" << node.selection << "]";
+          nameStream << ".[" << std::dec << node.selection << "]";
         }
         else if (node.type == DICOMTagPath::NodeInfo::NodeType::AnySelection)
         {
@@ -16,9 +16,17 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkDICOMTagScanner.h"
 
+#include <mitkExceptionMacro.h>
+
+#include <algorithm>
+#include <thread>
+
 itk::MutexLock::Pointer mitk::DICOMTagScanner::s_LocaleMutex = itk::MutexLock::New();
 
 mitk::DICOMTagScanner::DICOMTagScanner()
+  : m_NumberOfThreads(0)
+  , m_LastScanThroughput(0.0)
+  , m_PersistentTagCache(DICOMPersistentTagCache::GetDefault())
 {
 }
 
@@ -74,3 +82,62 @@ std::string mitk::DICOMTagScanner::GetActiveLocale()
 {
   return setlocale(LC_NUMERIC, nullptr);
 }
+
+void mitk::DICOMTagScanner::SetNumberOfThreads(unsigned int numberOfThreads)
+{
+  m_NumberOfThreads = numberOfThreads;
+}
+
+unsigned int mitk::DICOMTagScanner::GetNumberOfThreads() const
+{
+  return m_NumberOfThreads;
+}
+
+double mitk::DICOMTagScanner::GetLastScanThroughput() const
+{
+  return m_LastScanThroughput;
+}
+
+unsigned int mitk::DICOMTagScanner::GetNumberOfScanThreads(std::size_t numberOfFiles) const
+{
+  std::size_t numberOfThreads = m_NumberOfThreads;
+  if (numberOfThreads == 0)
+  {
+    numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  return static_cast<unsigned int>(std::max<std::size_t>(1, std::min(numberOfThreads, numberOfFiles)));
+}
+
+void mitk::DICOMTagScanner::ReportScanThroughput(std::size_t numberOfFiles, double seconds)
+{
+  m_LastScanThroughput = seconds > 0 ? numberOfFiles / seconds : 0.0;
+  MITK_DEBUG << this->GetNameOfClass() << ": scanned " << numberOfFiles << " files in " << seconds << " s ("
+             << m_LastScanThroughput << " files/s)";
+}
+
+void mitk::DICOMTagScanner::SetPersistentTagCache(DICOMPersistentTagCache* cache)
+{
+  m_PersistentTagCache = cache;
+}
+
+mitk::DICOMPersistentTagCache* mitk::DICOMTagScanner::GetPersistentTagCache() const
+{
+  return m_PersistentTagCache;
+}
+
+void mitk::DICOMTagScanner::SavePersistentTagCache() const
+{
+  if (m_PersistentTagCache.IsNull())
+  {
+    return;
+  }
+
+  try
+  {
+    m_PersistentTagCache->Save();
+  }
+  catch (const mitk::Exception& e)
+  {
+    MITK_WARN << "Cannot save DICOM tag cache: " << e.GetDescription();
+  }
+}
@@ -248,6 +248,7 @@ mitk::EquiDistantBlocksSorter
   OutputListType outputs;
 
   m_SliceGroupingResults.clear();
+  m_ImagePositionCache.clear();
 
   while (!remainingInput.empty()) // repeat until all files are grouped somehow
   {
@@ -268,6 +269,8 @@ mitk::EquiDistantBlocksSorter
     remainingInput = regularBlock.GetUnsortedDatasets();
   }
 
+  m_ImagePositionCache.clear();
+
   unsigned int numberOfOutputs = outputs.size();
   this->SetNumberOfOutputs(numberOfOutputs);
 
@@ -325,6 +328,33 @@ mitk::EquiDistantBlocksSorter
 }
 
 
+bool
+mitk::EquiDistantBlocksSorter
+::GetImagePositionPatient(DICOMDatasetAccess* dataset, Point3D& origin)
+{
+  auto finding = m_ImagePositionCache.find(dataset);
+  if (finding == m_ImagePositionCache.end())
+  {
+    const DICOMTag tagImagePositionPatient = DICOMTag(0x0020,0x0032); // Image Position (Patient)
+
+    // Read tag value into point3D. PLEASE replace this by appropriate GDCM code if you figure out how to do that
+    const std::string originString = dataset->GetTagValueAsString(tagImagePositionPatient).value;
+
+    std::pair<bool, Point3D> position;
+    position.first = !originString.empty();
+    position.second.Fill(0.0);
+    if (position.first)
+    {
+      bool ignoredConversionError(-42); // hard to get here, no graceful way to react
+      position.second = DICOMStringToPoint3D( originString, ignoredConversionError );
+    }
+    finding = m_ImagePositionCache.insert(std::make_pair(dataset, position)).first;
+  }
+
+  origin = finding->second.second;
+  return finding->second.first;
+}
+
 std::string
 mitk::EquiDistantBlocksSorter
 ::ConstCharStarToString(const char* s)
@@ -365,11 +395,8 @@ mitk::EquiDistantBlocksSorter
        ++dsIter, ++fileIndex)
   {
     bool fileFitsIntoPattern(false);
-    std::string thisOriginString;
-    // Read tag value into point3D. PLEASE replace this by appropriate GDCM code if you figure out how to do that
-    thisOriginString = (*dsIter)->GetTagValueAsString(tagImagePositionPatient).value;
 
-    if (thisOriginString.empty())
+    if (!this->GetImagePositionPatient(*dsIter, thisOrigin))
     {
       // don't let such files be in a common group. Everything without position information will be loaded as a single slice:
       // with standard DICOM files this can happen to: CR, DX, SC
@@ -396,9 +423,6 @@ mitk::EquiDistantBlocksSorter
       }
     }
 
-    bool ignoredConversionError(-42); // hard to get here, no graceful way to react
-    thisOrigin = DICOMStringToPoint3D( thisOriginString, ignoredConversionError );
-
     MITK_DEBUG << "  " << fileIndex << " " << (*dsIter)->GetFilenameIfAvailable()
                        << " at "
                        /* << thisOriginString */ << "(" << thisOrigin[0] << "," << thisOrigin[1] << "," << thisOrigin[2] << ")";
@@ -442,6 +466,7 @@ mitk::EquiDistantBlocksSorter
         Vector3D right; right.Fill(0.0);
         Vector3D up; right.Fill(0.0); // might be down as well, but it is just a name at this point
         std::string orientationValue = (*dsIter)->GetTagValueAsString( tagImageOrientation ).value;
+        bool ignoredConversionError(false);
         DICOMStringToOrientationVectors( orientationValue, right, up, ignoredConversionError );
 
         GantryTiltInformation tiltInfo( lastDifferentOrigin, thisOrigin, right, up, 1 );
@@ -51,6 +51,16 @@ bool mitk::ITKDICOMSeriesReaderHelper::CanHandleFile( const std::string& filenam
   return tester->CanReadFile( filename.c_str() );
 }
 
+void mitk::ITKDICOMSeriesReaderHelper::SetNumberOfThreads( unsigned int numberOfThreads )
+{
+  m_NumberOfThreads = numberOfThreads;
+}
+
+unsigned int mitk::ITKDICOMSeriesReaderHelper::GetNumberOfThreads() const
+{
+  return m_NumberOfThreads;
+}
+
 mitk::Image::Pointer mitk::ITKDICOMSeriesReaderHelper::Load( const StringContainer& filenames,
                                                              bool correctTilt,
                                                              const GantryTiltInformation& tiltInfo )
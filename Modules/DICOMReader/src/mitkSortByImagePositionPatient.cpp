@@ -90,29 +90,26 @@ double
 mitk::SortByImagePositionPatient
 ::InternalNumericDistance(const mitk::DICOMDatasetAccess* left, const mitk::DICOMDatasetAccess* right, bool& possible) const
 {
-  // sort by distance to world origin, assuming (almost) equal orientation
-  static const DICOMTag tagImagePositionPatient = DICOMTag(0x0020,0x0032); // Image Position (Patient)
-  static const DICOMTag    tagImageOrientation = DICOMTag(0x0020, 0x0037); // Image Orientation
+  double leftValues[9];
+  double rightValues[9];
+  this->ExtractSortKeyValues(left, leftValues);
+  this->ExtractSortKeyValues(right, rightValues);
 
-  Vector3D leftRight; leftRight.Fill(0.0);
-  Vector3D leftUp; leftUp.Fill(0.0);
-  bool leftHasOrientation(false);
-  DICOMStringToOrientationVectors( left->GetTagValueAsString( tagImageOrientation ).value,
-                                   leftRight, leftUp, leftHasOrientation );
-
-  Vector3D rightRight; rightRight.Fill(0.0);
-  Vector3D rightUp; rightUp.Fill(0.0);
-  bool rightHasOrientation(false);
-  DICOMStringToOrientationVectors(right->GetTagValueAsString(tagImageOrientation).value,
-                                   rightRight, rightUp, rightHasOrientation );
+  return InternalNumericDistance(leftValues, rightValues, possible);
+}
 
-  Point3D leftOrigin; leftOrigin.Fill(0.0f);
-  bool leftHasOrigin(false);
-  leftOrigin = DICOMStringToPoint3D(left->GetTagValueAsString(tagImagePositionPatient).value, leftHasOrigin);
+double
+mitk::SortByImagePositionPatient
+::InternalNumericDistance(const double* left, const double* right, bool& possible)
+{
+  // sort by distance to world origin, assuming (almost) equal orientation
+  const double* leftOrigin = left;
+  const double* leftRight = left + 3;
+  const double* leftUp = left + 6;
 
-  Point3D rightOrigin; rightOrigin.Fill(0.0f);
-  bool rightHasOrigin(false);
-  rightOrigin = DICOMStringToPoint3D(right->GetTagValueAsString(tagImagePositionPatient).value, rightHasOrigin);
+  const double* rightOrigin = right;
+  const double* rightRight = right + 3;
+  const double* rightUp = right + 6;
 
   //   we tolerate very small differences in image orientation, since we got to know about
   //   acquisitions where these values change across a single series (7th decimal digit)
@@ -157,6 +154,59 @@ mitk::SortByImagePositionPatient
   }
 }
 
+unsigned int
+mitk::SortByImagePositionPatient
+::GetNumberOfSortKeyValues() const
+{
+  return 9;
+}
+
+void
+mitk::SortByImagePositionPatient
+::ExtractSortKeyValues(const mitk::DICOMDatasetAccess* dataset, double* values) const
+{
+  static const DICOMTag tagImagePositionPatient = DICOMTag(0x0020,0x0032); // Image Position (Patient)
+  static const DICOMTag    tagImageOrientation = DICOMTag(0x0020, 0x0037); // Image Orientation
+
+  Vector3D right; right.Fill(0.0);
+  Vector3D up; up.Fill(0.0);
+  bool hasOrientation(false);
+  DICOMStringToOrientationVectors( dataset->GetTagValueAsString( tagImageOrientation ).value,
+                                   right, up, hasOrientation );
+
+  Point3D origin; origin.Fill(0.0f);
+  bool hasOrigin(false);
+  origin = DICOMStringToPoint3D(dataset->GetTagValueAsString(tagImagePositionPatient).value, hasOrigin);
+
+  for (unsigned int dim = 0; dim < 3; ++dim)
+  {
+    values[dim] = origin[dim];
+    values[3 + dim] = right[dim];
+    values[6 + dim] = up[dim];
+  }
+}
+
+int
+mitk::SortByImagePositionPatient
+::CompareSortKeyValues(const double* left, const double* right) const
+{
+  bool possible(false);
+  const double distance = InternalNumericDistance(left, right, possible); // returns 0.0 if not possible
+  if (!possible)
+  {
+    return 0;
+  }
+  return distance > 0.0 ? -1 : 1;
+}
+
+double
+mitk::SortByImagePositionPatient
+::NumericDistanceOfSortKeyValues(const double* from, const double* to) const
+{
+  bool possible(false);
+  const double retVal = InternalNumericDistance(from, to, possible); // returns 0.0 if not possible
+  return possible ? retVal : 0.0;
+}
 
 double
 mitk::SortByImagePositionPatient
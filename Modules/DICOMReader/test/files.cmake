@@ -1,6 +1,8 @@
 set(MODULE_TESTS
   mitkDICOMReaderConfiguratorTest.cpp
   mitkDICOMDCMTKTagScannerTest.cpp
+  mitkDICOMPersistentTagCacheTest.cpp
+  mitkDICOMSortCriterionTest.cpp
   mitkDICOMSimpleVolumeImportTest.cpp
   mitkDICOMTagPathTest.cpp
   mitkDICOMPropertyTest.cpp
@@ -15,6 +15,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "mitkDICOMDCMTKTagScanner.h"
+#include "mitkDICOMGDCMTagScanner.h"
 #include "mitkDICOMFileReaderTestHelper.h"
 
 #include "mitkTestFixture.h"
@@ -28,6 +29,7 @@ class mitkDICOMDCMTKTagScannerTestSuite : public mitk::TestFixture
 
   MITK_TEST(DeepScanning);
   MITK_TEST(MultiFileScanning);
+  MITK_TEST(ParallelScanning);
 
   CPPUNIT_TEST_SUITE_END();
 
@@ -123,6 +125,42 @@ public:
     CPPUNIT_ASSERT_MESSAGE("Testing value of instance uid finding of frame 3", findings.front().value == "1.2.276.0.99.1.4.8323329.3795.1303917947.940055");
   }
 
+  void ParallelScanning()
+  {
+    mitk::DICOMTagPath instanceUID(0x0008, 0x0018);
+    mitk::DICOMTag sliceLocation(0x0020, 0x1041);
+
+    std::vector<mitk::DICOMTagScanner::Pointer> scanners;
+    scanners.push_back(scanner.GetPointer());
+    scanners.push_back(mitk::DICOMGDCMTagScanner::New().GetPointer());
+
+    for (auto& tagScanner : scanners)
+    {
+      tagScanner->SetInputFiles(ctFiles);
+      tagScanner->AddTagPath(instanceUID);
+      tagScanner->AddTag(sliceLocation);
+
+      tagScanner->SetNumberOfThreads(1);
+      tagScanner->Scan();
+      mitk::DICOMDatasetAccessingImageFrameList expectedFrames = tagScanner->GetFrameInfoList();
+
+      tagScanner->SetNumberOfThreads(3);
+      tagScanner->Scan();
+      mitk::DICOMDatasetAccessingImageFrameList frames = tagScanner->GetFrameInfoList();
+
+      CPPUNIT_ASSERT_MESSAGE("Testing number of frames of parallel scan", frames.size() == ctFiles.size());
+      CPPUNIT_ASSERT_MESSAGE("Testing throughput of parallel scan", tagScanner->GetLastScanThroughput() > 0);
+      for (std::size_t i = 0; i < frames.size(); ++i)
+      {
+        CPPUNIT_ASSERT_MESSAGE("Testing order of parallel scan", frames[i]->GetFilenameIfAvailable() == ctFiles[i]);
+        CPPUNIT_ASSERT_MESSAGE("Testing instance uid of parallel scan",
+          frames[i]->GetTagValueAsString(instanceUID).front().value == expectedFrames[i]->GetTagValueAsString(instanceUID).front().value);
+        CPPUNIT_ASSERT_MESSAGE("Testing slice location of parallel scan",
+          frames[i]->GetTagValueAsString(sliceLocation).value == expectedFrames[i]->GetTagValueAsString(sliceLocation).value);
+      }
+    }
+  }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkDICOMDCMTKTagScanner)
@@ -0,0 +1,172 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkDICOMPersistentTagCache.h"
+#include "mitkDICOMDCMTKTagScanner.h"
+#include "mitkDICOMGDCMTagScanner.h"
+
+#include "mitkIOUtil.h"
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include <cstdio>
+#include <fstream>
+
+class mitkDICOMPersistentTagCacheTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkDICOMPersistentTagCacheTestSuite);
+
+  MITK_TEST(LookupAfterStore);
+  MITK_TEST(ChangedFileIsRescanned);
+  MITK_TEST(SaveAndLoad);
+  MITK_TEST(ScannersUseCache);
+
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  mitk::DICOMPersistentTagCache::Pointer m_Cache;
+  std::string m_DataFileName;
+  std::string m_CacheFileName;
+
+  mitk::StringList ctFiles;
+
+public:
+
+  void setUp() override
+  {
+    m_Cache = mitk::DICOMPersistentTagCache::New();
+
+    std::ofstream dataStream;
+    m_DataFileName = mitk::IOUtil::CreateTemporaryFile(dataStream, "tagcachedata-XXXXXX");
+    dataStream << "some content";
+    dataStream.close();
+
+    m_CacheFileName = mitk::IOUtil::CreateTemporaryFile("tagcache-XXXXXX");
+    std::remove(m_CacheFileName.c_str());
+
+    ctFiles.clear();
+    ctFiles.push_back(GetTestDataFilePath("TinyCTAbdomen/100"));
+    ctFiles.push_back(GetTestDataFilePath("TinyCTAbdomen/101"));
+    ctFiles.push_back(GetTestDataFilePath("TinyCTAbdomen/102"));
+    ctFiles.push_back(GetTestDataFilePath("TinyCTAbdomen/104"));
+  }
+
+  void tearDown() override
+  {
+    std::remove(m_DataFileName.c_str());
+    std::remove(m_CacheFileName.c_str());
+    m_Cache = nullptr;
+  }
+
+  void LookupAfterStore()
+  {
+    std::set<std::string> queries = { "a", "b" };
+    mitk::DICOMPersistentTagCache::ValueListType values = { { "a", "1" }, { "b", "2\\3" } };
+
+    mitk::DICOMPersistentTagCache::ValueListType result;
+    CPPUNIT_ASSERT_MESSAGE("Empty cache has no entry", !m_Cache->Lookup("scanner", m_DataFileName, queries, result));
+
+    m_Cache->Store("scanner", m_DataFileName, queries, values);
+    CPPUNIT_ASSERT_MESSAGE("Stored entry is found", m_Cache->Lookup("scanner", m_DataFileName, queries, result));
+    CPPUNIT_ASSERT_MESSAGE("Stored values are returned", result == values);
+
+    CPPUNIT_ASSERT_MESSAGE("Subset of the queries is found", m_Cache->Lookup("scanner", m_DataFileName, { "a" }, result));
+    CPPUNIT_ASSERT_MESSAGE("Unscanned query is not found", !m_Cache->Lookup("scanner", m_DataFileName, { "a", "c" }, result));
+    CPPUNIT_ASSERT_MESSAGE("Entries are kept per scanner", !m_Cache->Lookup("other", m_DataFileName, queries, result));
+
+    m_Cache->Store("scanner", m_DataFileName, { "c" }, { { "c", "4" } });
+    CPPUNIT_ASSERT_MESSAGE("Queries of unchanged files accumulate", m_Cache->Lookup("scanner", m_DataFileName, { "a", "c" }, result));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), result.size());
+  }
+
+  void ChangedFileIsRescanned()
+  {
+    std::set<std::string> queries = { "a" };
+    m_Cache->Store("scanner", m_DataFileName, queries, { { "a", "1" } });
+
+    std::ofstream dataStream(m_DataFileName.c_str(), std::ios::app);
+    dataStream << "more content";
+    dataStream.close();
+
+    mitk::DICOMPersistentTagCache::ValueListType result;
+    CPPUNIT_ASSERT_MESSAGE("Changed file is not found", !m_Cache->Lookup("scanner", m_DataFileName, queries, result));
+    CPPUNIT_ASSERT_MESSAGE("Missing file is not found", !m_Cache->Lookup("scanner", m_DataFileName + ".missing", queries, result));
+  }
+
+  void SaveAndLoad()
+  {
+    std::set<std::string> queries = { "a" };
+    mitk::DICOMPersistentTagCache::ValueListType values = { { "a", std::string("with\nnewline and \0 zero", 24) } };
+    m_Cache->SetFileName(m_CacheFileName);
+    m_Cache->Store("scanner", m_DataFileName, queries, values);
+    m_Cache->Save();
+
+    mitk::DICOMPersistentTagCache::Pointer loaded = mitk::DICOMPersistentTagCache::New();
+    loaded->SetFileName(m_CacheFileName);
+    loaded->Load();
+
+    mitk::DICOMPersistentTagCache::ValueListType result;
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), loaded->GetNumberOfEntries());
+    CPPUNIT_ASSERT_MESSAGE("Loaded entry is found", loaded->Lookup("scanner", m_DataFileName, queries, result));
+    CPPUNIT_ASSERT_MESSAGE("Loaded values are unchanged", result == values);
+
+    std::ofstream corrupt(m_CacheFileName.c_str(), std::ios::binary | std::ios::trunc);
+    corrupt << "no cache";
+    corrupt.close();
+    loaded->Load();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), loaded->GetNumberOfEntries());
+  }
+
+  void ScannersUseCache()
+  {
+    mitk::DICOMTagPath instanceUID(0x0008, 0x0018);
+
+    std::vector<mitk::DICOMTagScanner::Pointer> scanners;
+    scanners.push_back(mitk::DICOMDCMTKTagScanner::New().GetPointer());
+    scanners.push_back(mitk::DICOMGDCMTagScanner::New().GetPointer());
+
+    for (auto& scanner : scanners)
+    {
+      scanner->SetInputFiles(ctFiles);
+      scanner->AddTagPath(instanceUID);
+
+      scanner->SetPersistentTagCache(nullptr);
+      scanner->Scan();
+      mitk::DICOMDatasetAccessingImageFrameList expectedFrames = scanner->GetFrameInfoList();
+
+      mitk::DICOMPersistentTagCache::Pointer cache = mitk::DICOMPersistentTagCache::New();
+      scanner->SetPersistentTagCache(cache);
+      scanner->Scan();
+      CPPUNIT_ASSERT_EQUAL(ctFiles.size(), cache->GetNumberOfEntries());
+
+      // second scan with the cache, the values come from the cache
+      scanner->Scan();
+      mitk::DICOMDatasetAccessingImageFrameList frames = scanner->GetFrameInfoList();
+
+      CPPUNIT_ASSERT_EQUAL(expectedFrames.size(), frames.size());
+      for (std::size_t i = 0; i < frames.size(); ++i)
+      {
+        CPPUNIT_ASSERT_MESSAGE("Testing order of cached scan", frames[i]->GetFilenameIfAvailable() == ctFiles[i]);
+        CPPUNIT_ASSERT_MESSAGE("Testing instance uid of cached scan",
+          frames[i]->GetTagValueAsString(instanceUID).front().value == expectedFrames[i]->GetTagValueAsString(instanceUID).front().value);
+      }
+    }
+  }
+
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkDICOMPersistentTagCache)
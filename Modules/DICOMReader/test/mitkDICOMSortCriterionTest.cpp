@@ -0,0 +1,173 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkDICOMGenericImageFrameInfo.h"
+#include "mitkDICOMSortByTag.h"
+#include "mitkSortByImagePositionPatient.h"
+
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include <algorithm>
+#include <sstream>
+
+class mitkDICOMSortCriterionTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkDICOMSortCriterionTestSuite);
+
+  MITK_TEST(SortKeys_ImagePositionAndInstanceNumber_MatchDatasetOrder);
+  MITK_TEST(NumericKeyDistance_MatchesNumericDistance);
+  MITK_TEST(CriterionWithoutKeys_UsesDatasets);
+
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  std::vector<mitk::DICOMGenericImageFrameInfo::Pointer> m_Frames;
+  mitk::DICOMSortCriterion::Pointer m_Criterion;
+
+  /** Criterion without typed sort key values, like external subclasses that only implement the dataset interface. */
+  class SortByFilename : public mitk::DICOMSortCriterion
+  {
+  public:
+    mitkClassMacro(SortByFilename, DICOMSortCriterion);
+    itkFactorylessNewMacro(Self);
+
+    mitk::DICOMTagList GetTagsOfInterest() const override { return mitk::DICOMTagList(); }
+
+    bool IsLeftBeforeRight(const mitk::DICOMDatasetAccess* left, const mitk::DICOMDatasetAccess* right) const override
+    {
+      return left->GetFilenameIfAvailable() > right->GetFilenameIfAvailable();
+    }
+
+    double NumericDistance(const mitk::DICOMDatasetAccess*, const mitk::DICOMDatasetAccess*) const override { return 42.0; }
+
+    void Print(std::ostream& os) const override { os << "filename"; }
+
+    bool operator==(const DICOMSortCriterion& other) const override { return dynamic_cast<const SortByFilename*>(&other) != nullptr; }
+
+  protected:
+    SortByFilename() : DICOMSortCriterion(nullptr) {}
+  };
+
+public:
+
+  void setUp() override
+  {
+    m_Frames.clear();
+
+    // slices of two time steps along an oblique normal, in shuffled order
+    const int positions[] = { 7, 3, 9, 0, 5, 1, 8, 2, 6, 4 };
+    unsigned int instanceNumber = 0;
+    for (int timeStep = 0; timeStep < 2; ++timeStep)
+    {
+      for (int position : positions)
+      {
+        std::ostringstream filename;
+        filename << "frame" << instanceNumber;
+        mitk::DICOMGenericImageFrameInfo::Pointer frame = mitk::DICOMGenericImageFrameInfo::New(filename.str());
+
+        std::ostringstream origin;
+        origin << 10.0 + 0.5 * position << "\\" << -3.0 << "\\" << 2.5 * position;
+        frame->SetTagValue(mitk::DICOMTagPath(0x0020, 0x0032), origin.str());
+        frame->SetTagValue(mitk::DICOMTagPath(0x0020, 0x0037), "1\\0\\0\\0\\0.8\\-0.6");
+
+        std::ostringstream instance;
+        instance << (timeStep == 0 ? 100 - instanceNumber : instanceNumber);
+        frame->SetTagValue(mitk::DICOMTagPath(0x0020, 0x0013), instance.str());
+
+        m_Frames.push_back(frame);
+        ++instanceNumber;
+      }
+    }
+
+    m_Criterion = mitk::SortByImagePositionPatient::New(mitk::DICOMSortByTag::New(mitk::DICOMTag(0x0020, 0x0013)).GetPointer()).GetPointer();
+  }
+
+  void tearDown() override
+  {
+    m_Frames.clear();
+    m_Criterion = nullptr;
+  }
+
+  void SortKeys_ImagePositionAndInstanceNumber_MatchDatasetOrder()
+  {
+    std::vector<const mitk::DICOMDatasetAccess*> expected;
+    for (const auto& frame : m_Frames)
+    {
+      expected.push_back(frame.GetPointer());
+    }
+    std::sort(expected.begin(), expected.end(),
+      [this](const mitk::DICOMDatasetAccess* left, const mitk::DICOMDatasetAccess* right) { return m_Criterion->IsLeftBeforeRight(left, right); });
+
+    std::vector<mitk::DICOMSortCriterion::SortKey> keys;
+    for (const auto& frame : m_Frames)
+    {
+      keys.push_back(m_Criterion->ExtractSortKey(frame));
+    }
+    CPPUNIT_ASSERT_EQUAL(std::size_t(10), keys.front().values.size());
+
+    std::sort(keys.begin(), keys.end(),
+      [this](const mitk::DICOMSortCriterion::SortKey& left, const mitk::DICOMSortCriterion::SortKey& right) { return m_Criterion->IsLeftKeyBeforeRightKey(left, right); });
+
+    CPPUNIT_ASSERT_EQUAL(expected.size(), keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i)
+    {
+      CPPUNIT_ASSERT_MESSAGE("Sorting by keys results in the order of sorting by datasets", keys[i].dataset == expected[i]);
+    }
+  }
+
+  void NumericKeyDistance_MatchesNumericDistance()
+  {
+    for (std::size_t i = 1; i < m_Frames.size(); ++i)
+    {
+      const mitk::DICOMSortCriterion::SortKey from = m_Criterion->ExtractSortKey(m_Frames[i - 1]);
+      const mitk::DICOMSortCriterion::SortKey to = m_Criterion->ExtractSortKey(m_Frames[i]);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(m_Criterion->NumericDistance(m_Frames[i - 1], m_Frames[i]), m_Criterion->NumericKeyDistance(from, to), 1e-12);
+
+      const mitk::DICOMSortCriterion::ConstPointer secondary = m_Criterion->GetSecondaryCriterion();
+      const mitk::DICOMSortCriterion::SortKey secondaryFrom = secondary->ExtractSortKey(m_Frames[i - 1]);
+      const mitk::DICOMSortCriterion::SortKey secondaryTo = secondary->ExtractSortKey(m_Frames[i]);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(secondary->NumericDistance(m_Frames[i - 1], m_Frames[i]), secondary->NumericKeyDistance(secondaryFrom, secondaryTo), 1e-12);
+    }
+  }
+
+  void CriterionWithoutKeys_UsesDatasets()
+  {
+    mitk::DICOMSortCriterion::Pointer criterion = mitk::DICOMSortByTag::New(mitk::DICOMTag(0x0020, 0x0037), SortByFilename::New().GetPointer()).GetPointer();
+
+    // all frames share the orientation, so the filename has to decide
+    std::vector<mitk::DICOMSortCriterion::SortKey> keys;
+    for (const auto& frame : m_Frames)
+    {
+      keys.push_back(criterion->ExtractSortKey(frame));
+    }
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), keys.front().values.size());
+
+    std::sort(keys.begin(), keys.end(),
+      [&criterion](const mitk::DICOMSortCriterion::SortKey& left, const mitk::DICOMSortCriterion::SortKey& right) { return criterion->IsLeftKeyBeforeRightKey(left, right); });
+
+    for (std::size_t i = 1; i < keys.size(); ++i)
+    {
+      CPPUNIT_ASSERT_MESSAGE("Secondary criterion without keys decides", keys[i - 1].dataset->GetFilenameIfAvailable() > keys[i].dataset->GetFilenameIfAvailable());
+    }
+
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(42.0, criterion->GetSecondaryCriterion()->NumericKeyDistance(keys[0], keys[1]), 1e-12);
+  }
+
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkDICOMSortCriterion)
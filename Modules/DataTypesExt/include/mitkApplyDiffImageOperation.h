@@ -78,6 +78,8 @@ namespace mitk
     void SetFactor(double factor) { m_Factor = factor; }
     double GetFactor() { return m_Factor; }
     Image *GetImage() { return m_Image; }
+    /** \brief Returns the size of the compressed diff image */
+    std::size_t GetMemorySize() const override;
     Image::Pointer GetDiffImage();
 
     bool IsImageStillValid() { return m_ImageStillValid; }
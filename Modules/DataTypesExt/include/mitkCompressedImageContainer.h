@@ -25,6 +25,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <itkObject.h>
 
+#include <future>
 #include <vector>
 
 namespace mitk
@@ -34,6 +35,13 @@ namespace mitk
 
     Uses zlib to compress the data of an mitk::Image.
 
+    The voxels are split into chunks of SlicesPerChunk slices that are compressed independently
+    and in parallel (see NumberOfThreads). Single slices can be restored with GetSliceImage()
+    without uncompressing the whole volume.
+
+    SetImage(image, true) compresses in the background. The voxels are copied first, so the
+    image may be modified right after the call. All getters wait for a pending compression.
+
     $Author$
   */
   class MITKDATATYPESEXT_EXPORT CompressedImageContainer : public itk::Object
@@ -50,6 +58,13 @@ namespace mitk
        */
       void SetImage(Image *);
 
+    /**
+     * \brief Creates a compressed version of the image, optionally in a background thread.
+     *
+     * In the background case the voxel data is copied before this method returns.
+     */
+    void SetImage(Image *, bool compressInBackground);
+
     /**
      * \brief Creates a full mitk::Image from its compressed version.
      *
@@ -59,21 +74,65 @@ namespace mitk
      */
     Image::Pointer GetImage();
 
+    /**
+     * \brief Creates a 2D image of one slice, uncompressing only the chunk that holds it.
+     *
+     * Returns nullptr if slice or time step do not exist.
+     */
+    Image::Pointer GetSliceImage(unsigned int slice, unsigned int timeStep = 0);
+
+    /** \brief Blocks until a background compression started by SetImage() is finished */
+    void WaitForCompression();
+
+    /** \brief Number of slices compressed together as one independent chunk (default 1) */
+    itkSetClampMacro(SlicesPerChunk, unsigned int, 1, 65536);
+    itkGetConstMacro(SlicesPerChunk, unsigned int);
+
+    /** \brief zlib compression level, from 1 (fastest) to 9 (best ratio), default Z_BEST_SPEED */
+    itkSetClampMacro(CompressionLevel, int, 1, 9);
+    itkGetConstMacro(CompressionLevel, int);
+
+    /** \brief Threads used for compression, 0 (default) means one per hardware thread */
+    itkSetMacro(NumberOfThreads, unsigned int);
+    itkGetConstMacro(NumberOfThreads, unsigned int);
+
+    /** \brief Total size of all compressed chunks */
+    unsigned long GetCompressedSizeInBytes();
+
   protected:
     CompressedImageContainer(); // purposely hidden
     ~CompressedImageContainer() override;
 
+    /// compresses all chunks of the given volumes (one pointer per timestep) in parallel
+    void CompressVolumes(const std::vector<const unsigned char *> &volumes);
+
+    /// uncompresses one chunk into dest, which has to hold the uncompressed chunk size
+    bool UncompressChunk(unsigned int chunk, unsigned char *dest) const;
+
+    unsigned long GetChunkSizeInBytes(unsigned int chunkInTimeStep) const;
+
     PixelType *m_PixelType;
 
     unsigned int m_ImageDimension;
     std::vector<unsigned int> m_ImageDimensions;
 
     unsigned long m_OneTimeStepImageSizeInBytes;
+    unsigned long m_OneSliceSizeInBytes;
 
     unsigned int m_NumberOfTimeSteps;
+    unsigned int m_NumberOfSlices;
+    unsigned int m_ChunksPerTimeStep;
+
+    unsigned int m_SlicesPerChunk;
+    int m_CompressionLevel;
+    unsigned int m_NumberOfThreads;
+
+    /// compressed chunks, ordered by timestep and then by slice
+    std::vector<std::vector<unsigned char>> m_Chunks;
 
-    /// one for each timestep. first = pointer to compressed data; second = size of buffer in bytes
-    std::vector<std::pair<unsigned char *, unsigned long>> m_ByteBuffers;
+    /// copy of the voxels and result of a pending background compression
+    std::vector<unsigned char> m_PendingVoxels;
+    std::future<void> m_PendingCompression;
 
     BaseGeometry::Pointer m_ImageGeometry;
   };
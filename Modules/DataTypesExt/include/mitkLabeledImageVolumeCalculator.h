@@ -31,7 +31,11 @@ namespace mitk
    * \brief Class for calculating the volume (or area) for each label in a
    * labeled image.
    *
-   * Labels are expected to be of an unsigned integer type.
+   * Labels are expected to be of an unsigned integer type, voxels with negative values are ignored.
+   *
+   * Voxel count, volume, centroid and bounding box of all labels are computed in one pass over the
+   * image, split into chunks of image lines that are processed in parallel. The results are kept until
+   * the image or its geometry is modified, so calling Calculate() again on an unchanged image is cheap.
    *
    * TODO: Extend class for time resolved images
    */
@@ -40,12 +44,20 @@ namespace mitk
   public:
     typedef std::vector<double> VolumeVector;
     typedef std::vector<Point3D> PointVector;
+    typedef std::vector<std::size_t> VoxelCountVector;
+    typedef itk::ImageRegion<3> RegionType;
+    typedef std::vector<RegionType> RegionVector;
 
     mitkClassMacroItkParent(LabeledImageVolumeCalculator, itk::Object);
     itkFactorylessNewMacro(Self) itkCloneMacro(Self)
 
       itkSetConstObjectMacro(Image, mitk::Image);
 
+    /** \brief Maximum number of threads used by Calculate(), 0 (default) uses one per hardware thread. */
+    itkSetMacro(NumberOfThreads, unsigned int);
+    itkGetConstMacro(NumberOfThreads, unsigned int);
+
+    /** \brief Computes the measures of all labels unless the image was not modified since the last call. */
     virtual void Calculate();
 
     double GetVolume(unsigned int label) const;
@@ -56,6 +68,16 @@ namespace mitk
 
     const PointVector &GetCentroids() const;
 
+    std::size_t GetNumberOfVoxels(unsigned int label) const;
+
+    const VoxelCountVector &GetNumbersOfVoxels() const;
+
+    /** \brief Bounding box of a label in index coordinates, empty if the label does not occur.
+        For 2D images the third dimension has the size 1. */
+    const RegionType &GetBoundingBox(unsigned int label) const;
+
+    const RegionVector &GetBoundingBoxes() const;
+
   protected:
     LabeledImageVolumeCalculator();
 
@@ -72,8 +94,16 @@ namespace mitk
 
     VolumeVector m_VolumeVector;
     PointVector m_CentroidVector;
+    VoxelCountVector m_VoxelCountVector;
+    RegionVector m_BoundingBoxVector;
 
     Point3D m_DummyPoint;
+    RegionType m_DummyRegion;
+
+    unsigned int m_NumberOfThreads;
+
+    const Image *m_CalculatedImage;
+    itk::ModifiedTimeType m_CalculatedImageMTime;
   };
 }
 
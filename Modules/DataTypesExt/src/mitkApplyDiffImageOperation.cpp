@@ -57,6 +57,14 @@ mitk::ApplyDiffImageOperation::~ApplyDiffImageOperation()
   }
 }
 
+std::size_t mitk::ApplyDiffImageOperation::GetMemorySize() const
+{
+  std::size_t size = Operation::GetMemorySize();
+  if (zlibContainer.IsNotNull())
+    size += zlibContainer->GetCompressedSizeInBytes();
+  return size;
+}
+
 void mitk::ApplyDiffImageOperation::OnImageDeleted()
 {
   m_ImageStillValid = false;
@@ -16,39 +16,52 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkCompressedImageContainer.h"
 #include "mitkImageReadAccessor.h"
+#include "mitkImageWriteAccessor.h"
 
 #include "itk_zlib.h"
 
-#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
 
-mitk::CompressedImageContainer::CompressedImageContainer() : m_PixelType(nullptr), m_ImageGeometry(nullptr)
+mitk::CompressedImageContainer::CompressedImageContainer()
+  : m_PixelType(nullptr),
+    m_ImageDimension(0),
+    m_OneTimeStepImageSizeInBytes(0),
+    m_OneSliceSizeInBytes(0),
+    m_NumberOfTimeSteps(0),
+    m_NumberOfSlices(0),
+    m_ChunksPerTimeStep(0),
+    m_SlicesPerChunk(1),
+    m_CompressionLevel(Z_BEST_SPEED),
+    m_NumberOfThreads(0),
+    m_ImageGeometry(nullptr)
 {
 }
 
 mitk::CompressedImageContainer::~CompressedImageContainer()
 {
-  for (auto iter = m_ByteBuffers.begin(); iter != m_ByteBuffers.end(); ++iter)
-  {
-    free(iter->first);
-  }
+  this->WaitForCompression();
 
   delete m_PixelType;
 }
 
 void mitk::CompressedImageContainer::SetImage(Image *image)
 {
-  for (auto iter = m_ByteBuffers.begin(); iter != m_ByteBuffers.end(); ++iter)
-  {
-    free(iter->first);
-  }
+  this->SetImage(image, false);
+}
 
-  m_ByteBuffers.clear();
+void mitk::CompressedImageContainer::SetImage(Image *image, bool compressInBackground)
+{
+  this->WaitForCompression();
+  m_Chunks.clear();
 
-  // Compress diff image using zlib (will be restored on demand)
   // determine memory size occupied by voxel data
   m_ImageDimension = image->GetDimension();
   m_ImageDimensions.clear();
 
+  delete m_PixelType;
   m_PixelType = new mitk::PixelType(image->GetPixelType());
 
   m_OneTimeStepImageSizeInBytes = m_PixelType->GetSize(); // bits per element divided by 8
@@ -70,35 +83,75 @@ void mitk::CompressedImageContainer::SetImage(Image *image)
     m_NumberOfTimeSteps = image->GetDimension(3);
   }
 
-  for (unsigned int timestep = 0; timestep < m_NumberOfTimeSteps; ++timestep)
+  m_NumberOfSlices = m_ImageDimension > 2 ? image->GetDimension(2) : 1;
+  m_OneSliceSizeInBytes = m_OneTimeStepImageSizeInBytes / m_NumberOfSlices;
+  m_ChunksPerTimeStep = (m_NumberOfSlices + m_SlicesPerChunk - 1) / m_SlicesPerChunk;
+
+  std::vector<const unsigned char *> volumes;
+
+  if (compressInBackground)
   {
-    // allocate a buffer as specified by zlib
-    unsigned long bufferSize =
-      m_OneTimeStepImageSizeInBytes + static_cast<unsigned long>(m_OneTimeStepImageSizeInBytes * 0.2) + 12;
-    auto *byteBuffer = (unsigned char *)malloc(bufferSize);
+    // copy the voxels, the image may change as soon as we return
+    m_PendingVoxels.resize(m_OneTimeStepImageSizeInBytes * m_NumberOfTimeSteps);
+    for (unsigned int timestep = 0; timestep < m_NumberOfTimeSteps; ++timestep)
+    {
+      ImageReadAccessor imgAcc(image, image->GetVolumeData(timestep));
+      unsigned char *dest = m_PendingVoxels.data() + timestep * m_OneTimeStepImageSizeInBytes;
+      std::memcpy(dest, imgAcc.GetData(), m_OneTimeStepImageSizeInBytes);
+      volumes.push_back(dest);
+    }
 
-    if (itk::Object::GetDebug())
+    m_PendingCompression = std::async(std::launch::async, [this, volumes]() {
+      this->CompressVolumes(volumes);
+      std::vector<unsigned char>().swap(m_PendingVoxels);
+    });
+  }
+  else
+  {
+    std::vector<ImageReadAccessor *> accessors;
+    for (unsigned int timestep = 0; timestep < m_NumberOfTimeSteps; ++timestep)
     {
-      // compress image here into a buffer
-      MITK_INFO << "Using ZLib version: '" << zlibVersion() << "'" << std::endl
-                << "Attempting to compress " << m_OneTimeStepImageSizeInBytes << " image bytes into a buffer of size "
-                << bufferSize << std::endl;
+      accessors.push_back(new ImageReadAccessor(image, image->GetVolumeData(timestep)));
+      volumes.push_back(static_cast<const unsigned char *>(accessors.back()->GetData()));
     }
 
-    ImageReadAccessor imgAcc(image, image->GetVolumeData(timestep));
-    ::Bytef *dest(byteBuffer);
-    ::uLongf destLen(bufferSize);
-    auto *source((unsigned char *)imgAcc.GetData());
-    ::uLongf sourceLen(m_OneTimeStepImageSizeInBytes);
-    int zlibRetVal = ::compress(dest, &destLen, source, sourceLen);
-    if (itk::Object::GetDebug())
+    this->CompressVolumes(volumes);
+
+    for (auto accessor : accessors)
+      delete accessor;
+  }
+}
+
+void mitk::CompressedImageContainer::CompressVolumes(const std::vector<const unsigned char *> &volumes)
+{
+  const unsigned int numberOfChunks = m_ChunksPerTimeStep * m_NumberOfTimeSteps;
+  m_Chunks.assign(numberOfChunks, std::vector<unsigned char>());
+
+  if (itk::Object::GetDebug())
+  {
+    MITK_INFO << "Using ZLib version: '" << zlibVersion() << "'" << std::endl
+              << "Attempting to compress " << m_OneTimeStepImageSizeInBytes * m_NumberOfTimeSteps
+              << " image bytes in " << numberOfChunks << " chunks" << std::endl;
+  }
+
+  std::atomic<unsigned int> nextChunk(0);
+  auto worker = [&]() {
+    for (unsigned int chunk = nextChunk++; chunk < numberOfChunks; chunk = nextChunk++)
     {
-      if (zlibRetVal == Z_OK)
-      {
-        MITK_INFO << "Success, using " << destLen << " bytes of the buffer (ratio "
-                  << ((double)destLen / (double)sourceLen) << ")" << std::endl;
-      }
-      else
+      const unsigned int timestep = chunk / m_ChunksPerTimeStep;
+      const unsigned int chunkInTimeStep = chunk % m_ChunksPerTimeStep;
+
+      const ::Bytef *source =
+        volumes[timestep] + static_cast<unsigned long>(chunkInTimeStep) * m_SlicesPerChunk * m_OneSliceSizeInBytes;
+      const ::uLong sourceLen(this->GetChunkSizeInBytes(chunkInTimeStep));
+
+      // allocate a buffer as specified by zlib
+      std::vector<unsigned char> &buffer = m_Chunks[chunk];
+      buffer.resize(::compressBound(sourceLen));
+      ::uLongf destLen(buffer.size());
+
+      int zlibRetVal = ::compress2(buffer.data(), &destLen, source, sourceLen, m_CompressionLevel);
+      if (zlibRetVal != Z_OK)
       {
         switch (zlibRetVal)
         {
@@ -112,22 +165,96 @@ void mitk::CompressedImageContainer::SetImage(Image *image)
             MITK_ERROR << "other, unspecified error" << std::endl;
             break;
         }
+        destLen = 0;
       }
+
+      // only use the neccessary amount of memory
+      buffer.resize(destLen);
+      buffer.shrink_to_fit();
     }
+  };
+
+  unsigned int numberOfThreads = m_NumberOfThreads > 0 ? m_NumberOfThreads : std::thread::hardware_concurrency();
+  numberOfThreads = std::max(1u, std::min(numberOfThreads, numberOfChunks));
+
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < numberOfThreads; ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (auto &thread : threads)
+    thread.join();
+
+  if (itk::Object::GetDebug())
+  {
+    unsigned long compressedSize = 0;
+    for (const auto &chunk : m_Chunks)
+      compressedSize += chunk.size();
+    MITK_INFO << "Success, using " << compressedSize << " bytes (ratio "
+              << ((double)compressedSize / (double)(m_OneTimeStepImageSizeInBytes * m_NumberOfTimeSteps)) << ")"
+              << std::endl;
+  }
+}
+
+unsigned long mitk::CompressedImageContainer::GetChunkSizeInBytes(unsigned int chunkInTimeStep) const
+{
+  const unsigned int firstSlice = chunkInTimeStep * m_SlicesPerChunk;
+  const unsigned int slices = std::min(m_SlicesPerChunk, m_NumberOfSlices - firstSlice);
+  return slices * m_OneSliceSizeInBytes;
+}
 
-    // only use the neccessary amount of memory, realloc the buffer!
-    byteBuffer = (unsigned char *)realloc(byteBuffer, destLen);
-    bufferSize = destLen;
-    // MITK_INFO << "Using " << bufferSize << " bytes to store compressed image (" << destLen << " needed)" <<
-    // std::endl;
+bool mitk::CompressedImageContainer::UncompressChunk(unsigned int chunk, unsigned char *dest) const
+{
+  ::uLongf destLen(this->GetChunkSizeInBytes(chunk % m_ChunksPerTimeStep));
+  const ::Bytef *source(m_Chunks[chunk].data());
+  ::uLong sourceLen(m_Chunks[chunk].size());
 
-    m_ByteBuffers.push_back(std::pair<unsigned char *, unsigned long>(byteBuffer, bufferSize));
+  int zlibRetVal = ::uncompress(dest, &destLen, source, sourceLen);
+  if (zlibRetVal != Z_OK)
+  {
+    switch (zlibRetVal)
+    {
+      case Z_DATA_ERROR:
+        MITK_ERROR << "compressed data corrupted" << std::endl;
+        break;
+      case Z_MEM_ERROR:
+        MITK_ERROR << "not enough memory" << std::endl;
+        break;
+      case Z_BUF_ERROR:
+        MITK_ERROR << "output buffer too small" << std::endl;
+        break;
+      default:
+        MITK_ERROR << "other, unspecified error" << std::endl;
+        break;
+    }
+    return false;
   }
+
+  return true;
+}
+
+void mitk::CompressedImageContainer::WaitForCompression()
+{
+  if (m_PendingCompression.valid())
+  {
+    m_PendingCompression.get();
+  }
+}
+
+unsigned long mitk::CompressedImageContainer::GetCompressedSizeInBytes()
+{
+  this->WaitForCompression();
+
+  unsigned long compressedSize = 0;
+  for (const auto &chunk : m_Chunks)
+    compressedSize += chunk.size();
+  return compressedSize;
 }
 
 mitk::Image::Pointer mitk::CompressedImageContainer::GetImage()
 {
-  if (m_ByteBuffers.empty())
+  this->WaitForCompression();
+
+  if (m_Chunks.empty())
     return nullptr;
 
   // uncompress image data, create an Image
@@ -139,39 +266,14 @@ mitk::Image::Pointer mitk::CompressedImageContainer::GetImage()
   image->Initialize(*m_PixelType, m_ImageDimension, dims); // this IS needed, right ?? But it does allocate memory ->
                                                            // does create one big lump of memory (also in windows)
 
-  unsigned int timeStep(0);
-  for (auto iter = m_ByteBuffers.begin(); iter != m_ByteBuffers.end(); ++iter, ++timeStep)
+  for (unsigned int timeStep = 0; timeStep < m_NumberOfTimeSteps; ++timeStep)
   {
-    ImageReadAccessor imgAcc(image, image->GetVolumeData(timeStep));
+    ImageWriteAccessor imgAcc(image, image->GetVolumeData(timeStep));
     auto *dest((unsigned char *)imgAcc.GetData());
-    ::uLongf destLen(m_OneTimeStepImageSizeInBytes);
-    ::Bytef *source(iter->first);
-    ::uLongf sourceLen(iter->second);
-    int zlibRetVal = ::uncompress(dest, &destLen, source, sourceLen);
-    if (itk::Object::GetDebug())
+    for (unsigned int chunkInTimeStep = 0; chunkInTimeStep < m_ChunksPerTimeStep; ++chunkInTimeStep)
     {
-      if (zlibRetVal == Z_OK)
-      {
-        MITK_INFO << "Success, destLen now " << destLen << " bytes" << std::endl;
-      }
-      else
-      {
-        switch (zlibRetVal)
-        {
-          case Z_DATA_ERROR:
-            MITK_ERROR << "compressed data corrupted" << std::endl;
-            break;
-          case Z_MEM_ERROR:
-            MITK_ERROR << "not enough memory" << std::endl;
-            break;
-          case Z_BUF_ERROR:
-            MITK_ERROR << "output buffer too small" << std::endl;
-            break;
-          default:
-            MITK_ERROR << "other, unspecified error" << std::endl;
-            break;
-        }
-      }
+      this->UncompressChunk(timeStep * m_ChunksPerTimeStep + chunkInTimeStep,
+                            dest + static_cast<unsigned long>(chunkInTimeStep) * m_SlicesPerChunk * m_OneSliceSizeInBytes);
     }
   }
 
@@ -180,3 +282,35 @@ mitk::Image::Pointer mitk::CompressedImageContainer::GetImage()
 
   return image;
 }
+
+mitk::Image::Pointer mitk::CompressedImageContainer::GetSliceImage(unsigned int slice, unsigned int timeStep)
+{
+  this->WaitForCompression();
+
+  if (m_Chunks.empty() || slice >= m_NumberOfSlices || timeStep >= m_NumberOfTimeSteps)
+    return nullptr;
+
+  const unsigned int chunkInTimeStep = slice / m_SlicesPerChunk;
+  const unsigned int sliceInChunk = slice % m_SlicesPerChunk;
+
+  std::vector<unsigned char> chunkData(this->GetChunkSizeInBytes(chunkInTimeStep));
+  if (!this->UncompressChunk(timeStep * m_ChunksPerTimeStep + chunkInTimeStep, chunkData.data()))
+    return nullptr;
+
+  Image::Pointer image = Image::New();
+
+  auto *slicedGeometry = dynamic_cast<SlicedGeometry3D *>(m_ImageGeometry.GetPointer());
+  if (slicedGeometry != nullptr && slicedGeometry->GetPlaneGeometry(slice) != nullptr)
+  {
+    image->Initialize(*m_PixelType, 1, *slicedGeometry->GetPlaneGeometry(slice));
+  }
+  else
+  {
+    unsigned int dims[2] = {m_ImageDimensions[0], m_ImageDimension > 1 ? m_ImageDimensions[1] : 1};
+    image->Initialize(*m_PixelType, 2, dims);
+  }
+
+  image->SetImportSlice(chunkData.data() + sliceInChunk * m_OneSliceSizeInBytes, 0, 0, 0, Image::CopyMemory);
+
+  return image;
+}
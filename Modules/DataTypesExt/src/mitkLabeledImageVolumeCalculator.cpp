@@ -17,11 +17,44 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkLabeledImageVolumeCalculator.h"
 #include "mitkImageAccessByItk.h"
 
-#include <itkImageRegionConstIteratorWithIndex.h>
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+namespace
+{
+  /** Sums of one label, collected separately by every thread. */
+  struct LabelAccumulator
+  {
+    LabelAccumulator() : numberOfVoxels(0)
+    {
+      std::fill(indexSum, indexSum + 3, 0.0);
+      std::fill(minimumIndex, minimumIndex + 3, std::numeric_limits<itk::IndexValueType>::max());
+      std::fill(maximumIndex, maximumIndex + 3, std::numeric_limits<itk::IndexValueType>::min());
+    }
+
+    void Add(const LabelAccumulator &other)
+    {
+      numberOfVoxels += other.numberOfVoxels;
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        indexSum[i] += other.indexSum[i];
+        minimumIndex[i] = std::min(minimumIndex[i], other.minimumIndex[i]);
+        maximumIndex[i] = std::max(maximumIndex[i], other.maximumIndex[i]);
+      }
+    }
+
+    std::size_t numberOfVoxels;
+    double indexSum[3];
+    itk::IndexValueType minimumIndex[3];
+    itk::IndexValueType maximumIndex[3];
+  };
+}
 
 namespace mitk
 {
   LabeledImageVolumeCalculator::LabeledImageVolumeCalculator()
+    : m_NumberOfThreads(0), m_CalculatedImage(nullptr), m_CalculatedImageMTime(0)
   {
     m_InputTimeSelector = ImageTimeSelector::New();
 
@@ -55,6 +88,33 @@ namespace mitk
     return m_CentroidVector;
   }
 
+  std::size_t LabeledImageVolumeCalculator::GetNumberOfVoxels(unsigned int label) const
+  {
+    if (label < m_VoxelCountVector.size())
+      return m_VoxelCountVector[label];
+    else
+      return 0;
+  }
+
+  const LabeledImageVolumeCalculator::VoxelCountVector &LabeledImageVolumeCalculator::GetNumbersOfVoxels() const
+  {
+    return m_VoxelCountVector;
+  }
+
+  const LabeledImageVolumeCalculator::RegionType &LabeledImageVolumeCalculator::GetBoundingBox(
+    unsigned int label) const
+  {
+    if (label < m_BoundingBoxVector.size())
+      return m_BoundingBoxVector[label];
+    else
+      return m_DummyRegion;
+  }
+
+  const LabeledImageVolumeCalculator::RegionVector &LabeledImageVolumeCalculator::GetBoundingBoxes() const
+  {
+    return m_BoundingBoxVector;
+  }
+
   void LabeledImageVolumeCalculator::Calculate()
   {
     if (m_Image.IsNull())
@@ -63,13 +123,19 @@ namespace mitk
       return;
     }
 
+    // The modified time of the image includes its geometry, which determines volumes and centroids
+    if (m_Image.GetPointer() == m_CalculatedImage && m_Image->GetMTime() <= m_CalculatedImageMTime)
+      return;
+
     m_InputTimeSelector->SetInput(m_Image);
 
     m_InputTimeSelector->SetTimeNr(0);
     m_InputTimeSelector->UpdateLargestPossibleRegion();
 
     AccessByItk_2(m_InputTimeSelector->GetOutput(), _InternalCalculateVolumes, this, m_Image->GetGeometry(0));
-    //}
+
+    m_CalculatedImage = m_Image.GetPointer();
+    m_CalculatedImageMTime = m_Image->GetMTime();
   }
 
   template <typename TPixel, unsigned int VImageDimension>
@@ -78,50 +144,136 @@ namespace mitk
                                                                BaseGeometry *geometry)
   {
     typedef itk::Image<TPixel, VImageDimension> ImageType;
-    typedef typename ImageType::IndexType IndexType;
-    typedef itk::ImageRegionConstIteratorWithIndex<ImageType> IteratorType;
+    typedef typename ImageType::RegionType ImageRegionType;
 
-    // Reset volume and centroid vectors
+    // Reset volume, centroid, voxel count and bounding box vectors
     m_VolumeVector.clear();
     m_CentroidVector.clear();
+    m_VoxelCountVector.clear();
+    m_BoundingBoxVector.clear();
+
+    const ImageRegionType region = image->GetBufferedRegion();
+    const TPixel *buffer = image->GetBufferPointer();
 
-    // Iterate over image and determine number of voxels and centroid
-    // per label
-    IteratorType it(image, image->GetBufferedRegion());
-    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    itk::IndexValueType startIndex[3] = {0, 0, 0};
+    itk::IndexValueType size[3] = {1, 1, 1};
+    for (unsigned int i = 0; i < VImageDimension && i < 3; ++i)
     {
-      const IndexType &index = it.GetIndex();
-      auto pixel = static_cast<unsigned int>(it.Get());
+      startIndex[i] = region.GetIndex(i);
+      size[i] = region.GetSize(i);
+    }
+
+    itk::SizeValueType numberOfLines = 1;
+    for (unsigned int i = 1; i < VImageDimension; ++i)
+      numberOfLines *= region.GetSize(i);
+
+    unsigned int numberOfThreads = m_NumberOfThreads;
+    if (numberOfThreads == 0)
+      numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+    numberOfThreads = static_cast<unsigned int>(std::min<itk::SizeValueType>(numberOfThreads, numberOfLines));
+    numberOfThreads = std::max(1u, numberOfThreads);
 
-      if (m_VolumeVector.size() <= pixel)
+    // Every thread collects its own histogram of labels over a consecutive chunk of image lines.
+    // Runs of equal labels along a line are added at once.
+    std::vector<std::vector<LabelAccumulator>> accumulators(numberOfThreads);
+
+    auto accumulateLines = [&](unsigned int thread) {
+      std::vector<LabelAccumulator> &labels = accumulators[thread];
+      const itk::SizeValueType firstLine = numberOfLines * thread / numberOfThreads;
+      const itk::SizeValueType lastLine = numberOfLines * (thread + 1) / numberOfThreads;
+
+      for (itk::SizeValueType line = firstLine; line < lastLine; ++line)
       {
-        m_VolumeVector.resize(pixel + 1);
-        m_CentroidVector.resize(pixel + 1);
+        const TPixel *pixel = buffer + line * size[0];
+        const auto lineInSlice = static_cast<itk::IndexValueType>(line % static_cast<itk::SizeValueType>(size[1]));
+        const auto slice = static_cast<itk::IndexValueType>(line / static_cast<itk::SizeValueType>(size[1]));
+        const itk::IndexValueType y = startIndex[1] + lineInSlice;
+        const itk::IndexValueType z = startIndex[2] + slice;
+
+        itk::IndexValueType runStart = 0;
+        while (runStart < size[0])
+        {
+          const TPixel value = pixel[runStart];
+          itk::IndexValueType runEnd = runStart + 1;
+          while (runEnd < size[0] && pixel[runEnd] == value)
+            ++runEnd;
+
+          if (!(value < static_cast<TPixel>(0)))
+          {
+            const auto label = static_cast<unsigned int>(value);
+            if (labels.size() <= label)
+              labels.resize(label + 1);
+
+            LabelAccumulator &accumulator = labels[label];
+            const auto runLength = static_cast<double>(runEnd - runStart);
+            const itk::IndexValueType x0 = startIndex[0] + runStart;
+            const itk::IndexValueType x1 = startIndex[0] + runEnd - 1;
+
+            accumulator.numberOfVoxels += static_cast<std::size_t>(runEnd - runStart);
+            accumulator.indexSum[0] += runLength * 0.5 * static_cast<double>(x0 + x1);
+            accumulator.indexSum[1] += runLength * y;
+            accumulator.indexSum[2] += runLength * z;
+            accumulator.minimumIndex[0] = std::min(accumulator.minimumIndex[0], x0);
+            accumulator.maximumIndex[0] = std::max(accumulator.maximumIndex[0], x1);
+            accumulator.minimumIndex[1] = std::min(accumulator.minimumIndex[1], y);
+            accumulator.maximumIndex[1] = std::max(accumulator.maximumIndex[1], y);
+            accumulator.minimumIndex[2] = std::min(accumulator.minimumIndex[2], z);
+            accumulator.maximumIndex[2] = std::max(accumulator.maximumIndex[2], z);
+          }
+
+          runStart = runEnd;
+        }
       }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int thread = 1; thread < numberOfThreads; ++thread)
+      threads.emplace_back(accumulateLines, thread);
+
+    accumulateLines(0);
 
-      m_VolumeVector[pixel] += 1.0;
+    for (auto &thread : threads)
+      thread.join();
 
-      m_CentroidVector[pixel][0] += index[0];
-      m_CentroidVector[pixel][1] += index[1];
-      m_CentroidVector[pixel][2] += index[2];
+    // Merge the histograms of all threads
+    std::vector<LabelAccumulator> labels;
+    for (const auto &threadLabels : accumulators)
+    {
+      if (labels.size() < threadLabels.size())
+        labels.resize(threadLabels.size());
+
+      for (std::size_t label = 0; label < threadLabels.size(); ++label)
+        labels[label].Add(threadLabels[label]);
     }
 
     // Calculate voxel volume from spacing
     const Vector3D &spacing = geometry->GetSpacing();
     double voxelVolume = spacing[0] * spacing[1] * spacing[2];
 
-    // Calculate centroid (in world coordinates) and volumes for all labels
-    for (unsigned int i = 0; i < m_VolumeVector.size(); ++i)
+    m_VolumeVector.resize(labels.size(), 0.0);
+    m_CentroidVector.resize(labels.size(), m_DummyPoint);
+    m_VoxelCountVector.resize(labels.size(), 0);
+    m_BoundingBoxVector.resize(labels.size());
+
+    // Calculate centroid (in world coordinates), volume and bounding box for all labels
+    for (std::size_t i = 0; i < labels.size(); ++i)
     {
-      if (m_VolumeVector[i] > 0.0)
-      {
-        m_CentroidVector[i][0] /= m_VolumeVector[i];
-        m_CentroidVector[i][1] /= m_VolumeVector[i];
-        m_CentroidVector[i][2] /= m_VolumeVector[i];
-        geometry->IndexToWorld(m_CentroidVector[i], m_CentroidVector[i]);
+      const LabelAccumulator &accumulator = labels[i];
+      if (accumulator.numberOfVoxels == 0)
+        continue;
 
-        m_VolumeVector[i] *= voxelVolume;
+      const auto numberOfVoxels = static_cast<double>(accumulator.numberOfVoxels);
+      Point3D centroid;
+      for (unsigned int j = 0; j < 3; ++j)
+      {
+        centroid[j] = accumulator.indexSum[j] / numberOfVoxels;
+        m_BoundingBoxVector[i].SetIndex(j, accumulator.minimumIndex[j]);
+        m_BoundingBoxVector[i].SetSize(j, accumulator.maximumIndex[j] - accumulator.minimumIndex[j] + 1);
       }
+      geometry->IndexToWorld(centroid, m_CentroidVector[i]);
+
+      m_VoxelCountVector[i] = accumulator.numberOfVoxels;
+      m_VolumeVector[i] = numberOfVoxels * voxelVolume;
     }
   }
 }
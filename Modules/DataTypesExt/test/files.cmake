@@ -1,5 +1,6 @@
 set(MODULE_TESTS
   mitkColorSequenceRainbowTest.cpp
+  mitkLabeledImageVolumeCalculatorTest.cpp
   mitkMeshTest.cpp
   mitkMultiStepperTest.cpp
   mitkUnstructuredGridTest.cpp
@@ -20,6 +20,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkImageDataItem.h"
 #include "mitkImageReadAccessor.h"
 
+#include <cstring>
+
 class mitkCompressedImageContainerTestClass
 {
 public:
@@ -111,6 +113,50 @@ public:
       }
     }
   }
+
+  static void TestSliceAccess(mitk::CompressedImageContainer *container, mitk::Image *image, unsigned int &numberFailed)
+  {
+    // compress in the background with chunks of several slices, then restore single slices
+    container->SetSlicesPerChunk(3);
+    container->SetImage(image, true);
+
+    const unsigned int numberOfSlices = image->GetDimension() > 2 ? image->GetDimension(2) : 1;
+    const unsigned int numberOfTimeSteps = image->GetDimension() > 3 ? image->GetDimension(3) : 1;
+    const unsigned long sliceSizeInBytes =
+      image->GetPixelType().GetSize() * image->GetDimension(0) * (image->GetDimension() > 1 ? image->GetDimension(1) : 1);
+
+    for (unsigned int timeStep = 0; timeStep < numberOfTimeSteps; ++timeStep)
+    {
+      mitk::ImageReadAccessor origImgAcc(image, image->GetVolumeData(timeStep));
+      auto *originalData((unsigned char *)origImgAcc.GetData());
+
+      for (unsigned int slice = 0; slice < numberOfSlices; slice += 2)
+      {
+        mitk::Image::Pointer sliceImage = container->GetSliceImage(slice, timeStep);
+        if (sliceImage.IsNull())
+        {
+          ++numberFailed;
+          std::cerr << "  (EE) Slice " << slice << " of timestep " << timeStep << " could not be restored" << std::endl;
+          return;
+        }
+
+        mitk::ImageReadAccessor sliceAcc(sliceImage, sliceImage->GetSliceData(0));
+        if (std::memcmp(sliceAcc.GetData(), originalData + slice * sliceSizeInBytes, sliceSizeInBytes) != 0)
+        {
+          ++numberFailed;
+          std::cerr << "  (EE) Slice " << slice << " of timestep " << timeStep << " differs after uncompression"
+                    << std::endl;
+          return;
+        }
+      }
+    }
+
+    if (container->GetSliceImage(numberOfSlices, 0).IsNotNull())
+    {
+      ++numberFailed;
+      std::cerr << "  (EE) Restoring a slice outside of the image did not fail" << std::endl;
+    }
+  }
 };
 
 /// ctest entry point
@@ -165,6 +211,8 @@ int mitkCompressedImageContainerTest(int argc, char *argv[])
 
   // some real work
   mitkCompressedImageContainerTestClass::Test(container, image, numberFailed);
+  mitkCompressedImageContainerTestClass::TestSliceAccess(container, image, numberFailed);
+  mitkCompressedImageContainerTestClass::Test(container, image, numberFailed);
 
   std::cout << "Testing destruction" << std::endl;
 
@@ -0,0 +1,153 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkITKImageImport.h>
+#include <mitkImagePixelWriteAccessor.h>
+#include <mitkLabeledImageVolumeCalculator.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+class mitkLabeledImageVolumeCalculatorTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkLabeledImageVolumeCalculatorTestSuite);
+  MITK_TEST(TestAllLabelsInOnePass);
+  MITK_TEST(TestThreadsYieldSameResult);
+  MITK_TEST(TestResultsAreUpdatedAfterModification);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef itk::Image<unsigned char, 3> LabelImageType;
+
+  mitk::Image::Pointer m_Image;
+
+  void FillBox(LabelImageType *image, unsigned char label, const int lower[3], const int upper[3])
+  {
+    LabelImageType::IndexType index;
+    for (index[2] = lower[2]; index[2] <= upper[2]; ++index[2])
+      for (index[1] = lower[1]; index[1] <= upper[1]; ++index[1])
+        for (index[0] = lower[0]; index[0] <= upper[0]; ++index[0])
+          image->SetPixel(index, label);
+  }
+
+public:
+  void setUp() override
+  {
+    LabelImageType::RegionType region;
+    region.SetSize(0, 30);
+    region.SetSize(1, 20);
+    region.SetSize(2, 10);
+
+    LabelImageType::SpacingType spacing;
+    spacing[0] = 1.0;
+    spacing[1] = 2.0;
+    spacing[2] = 3.0;
+
+    LabelImageType::Pointer image = LabelImageType::New();
+    image->SetRegions(region);
+    image->SetSpacing(spacing);
+    image->Allocate();
+    image->FillBuffer(0);
+
+    // label 1: 4 x 3 x 2 voxels, label 3: 10 x 5 x 1 voxels, label 2 does not occur
+    const int lower1[3] = {2, 4, 6};
+    const int upper1[3] = {5, 6, 7};
+    this->FillBox(image, 1, lower1, upper1);
+    const int lower3[3] = {20, 0, 0};
+    const int upper3[3] = {29, 4, 0};
+    this->FillBox(image, 3, lower3, upper3);
+
+    m_Image = mitk::GrabItkImageMemory(image);
+  }
+
+  void tearDown() override { m_Image = nullptr; }
+
+  void TestAllLabelsInOnePass()
+  {
+    mitk::LabeledImageVolumeCalculator::Pointer calculator = mitk::LabeledImageVolumeCalculator::New();
+    calculator->SetImage(m_Image);
+    calculator->Calculate();
+
+    CPPUNIT_ASSERT_EQUAL(std::size_t(4), calculator->GetNumbersOfVoxels().size());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(30 * 20 * 10 - 24 - 50), calculator->GetNumberOfVoxels(0));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(24), calculator->GetNumberOfVoxels(1));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), calculator->GetNumberOfVoxels(2));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(50), calculator->GetNumberOfVoxels(3));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), calculator->GetNumberOfVoxels(7));
+
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(24 * 6.0, calculator->GetVolume(1), mitk::eps);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(50 * 6.0, calculator->GetVolume(3), mitk::eps);
+
+    const mitk::Point3D &centroid = calculator->GetCentroid(1);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(3.5 * 1.0, centroid[0], mitk::eps);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(5.0 * 2.0, centroid[1], mitk::eps);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(6.5 * 3.0, centroid[2], mitk::eps);
+
+    const mitk::LabeledImageVolumeCalculator::RegionType &boundingBox = calculator->GetBoundingBox(3);
+    CPPUNIT_ASSERT_EQUAL(itk::IndexValueType(20), boundingBox.GetIndex(0));
+    CPPUNIT_ASSERT_EQUAL(itk::IndexValueType(0), boundingBox.GetIndex(1));
+    CPPUNIT_ASSERT_EQUAL(itk::IndexValueType(0), boundingBox.GetIndex(2));
+    CPPUNIT_ASSERT_EQUAL(itk::SizeValueType(10), boundingBox.GetSize(0));
+    CPPUNIT_ASSERT_EQUAL(itk::SizeValueType(5), boundingBox.GetSize(1));
+    CPPUNIT_ASSERT_EQUAL(itk::SizeValueType(1), boundingBox.GetSize(2));
+
+    CPPUNIT_ASSERT_EQUAL(itk::SizeValueType(0), calculator->GetBoundingBox(2).GetNumberOfPixels());
+  }
+
+  void TestThreadsYieldSameResult()
+  {
+    mitk::LabeledImageVolumeCalculator::Pointer sequential = mitk::LabeledImageVolumeCalculator::New();
+    sequential->SetNumberOfThreads(1);
+    sequential->SetImage(m_Image);
+    sequential->Calculate();
+
+    mitk::LabeledImageVolumeCalculator::Pointer parallel = mitk::LabeledImageVolumeCalculator::New();
+    parallel->SetNumberOfThreads(7);
+    parallel->SetImage(m_Image);
+    parallel->Calculate();
+
+    CPPUNIT_ASSERT(sequential->GetNumbersOfVoxels() == parallel->GetNumbersOfVoxels());
+    CPPUNIT_ASSERT(sequential->GetBoundingBoxes() == parallel->GetBoundingBoxes());
+    for (unsigned int label = 0; label < 4; ++label)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(sequential->GetVolume(label), parallel->GetVolume(label), mitk::eps);
+      CPPUNIT_ASSERT(mitk::Equal(sequential->GetCentroid(label), parallel->GetCentroid(label), 1e-6, true));
+    }
+  }
+
+  void TestResultsAreUpdatedAfterModification()
+  {
+    mitk::LabeledImageVolumeCalculator::Pointer calculator = mitk::LabeledImageVolumeCalculator::New();
+    calculator->SetImage(m_Image);
+    calculator->Calculate();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), calculator->GetNumberOfVoxels(2));
+
+    {
+      mitk::ImagePixelWriteAccessor<unsigned char, 3> accessor(m_Image);
+      itk::Index<3> index;
+      index[0] = 10;
+      index[1] = 10;
+      index[2] = 5;
+      accessor.SetPixelByIndex(index, 2);
+    }
+
+    m_Image->Modified();
+    calculator->Calculate();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), calculator->GetNumberOfVoxels(2));
+    CPPUNIT_ASSERT_EQUAL(itk::IndexValueType(10), calculator->GetBoundingBox(2).GetIndex(0));
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkLabeledImageVolumeCalculator)
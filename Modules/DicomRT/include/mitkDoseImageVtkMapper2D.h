@@ -31,6 +31,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkPropAssembly.h>
 #include <vtkCellArray.h>
 
+//STL
+#include <deque>
+#include <map>
+#include <vector>
+
 class vtkActor;
 class vtkPolyDataMapper;
 class vtkPlaneSource;
@@ -183,6 +188,18 @@ namespace mitk {
       For instance, if you zoom or pann, there is no need to recompute the contour. */
       vtkSmartPointer<vtkPolyData> m_OutlinePolyData;
 
+      /** \brief Key of a slice for the iso line cache (reslice axes, extent, spacing, depth, time step and thick slice settings).*/
+      typedef std::vector<double> IsoLineSliceKeyType;
+      /** \brief Iso line geometry of the recently visited slices. Scrolling back to a slice reuses its lines
+      instead of recomputing them. The cache is reset if the dose data or the visible iso levels change.*/
+      std::map<IsoLineSliceKeyType, vtkSmartPointer<vtkPolyData> > m_IsoLineCache;
+      /** \brief Insertion order of m_IsoLineCache, the oldest slice is dropped first.*/
+      std::deque<IsoLineSliceKeyType> m_IsoLineCacheOrder;
+      /** \brief Pipeline MTime of the dose image the cache was filled for.*/
+      itk::ModifiedTimeType m_IsoLineCacheDataMTime;
+      /** \brief Dose values and colors of the visible iso levels the cache was filled for.*/
+      std::vector<double> m_IsoLineCacheLevels;
+
       /** \brief Timestamp of last update of stored data. */
       itk::TimeStamp m_LastUpdateTime;
 
@@ -241,6 +258,12 @@ namespace mitk {
     */
     vtkSmartPointer<vtkPolyData> CreateOutlinePolyData(mitk::BaseRenderer* renderer);
 
+    /** \brief Returns the outline of the current slice (see CreateOutlinePolyData()) from the iso line cache of the
+    * renderer. The lines are only generated if the slice was not visited since the last change of the dose data or
+    * of the visible iso levels.
+    */
+    vtkSmartPointer<vtkPolyData> GetCachedOutlinePolyData(mitk::BaseRenderer* renderer, int thickSlicesMode, int thickSlicesNum);
+
     /** Default constructor */
     DoseImageVtkMapper2D();
     /** Default deconstructor */
@@ -304,7 +327,19 @@ namespace mitk {
     bool RenderingGeometryIntersectsImage( const PlaneGeometry* renderingGeometry, SlicedGeometry3D* imageGeometry );
 
   private:
-    void CreateLevelOutline(mitk::BaseRenderer* renderer, const mitk::IsoDoseLevel* level, float pref, vtkSmartPointer<vtkPoints> points, vtkSmartPointer<vtkCellArray> lines,  vtkSmartPointer<vtkUnsignedCharArray> colors);
+    /** \brief Absolute dose value and line color of a visible iso level */
+    struct IsoLineLevel
+    {
+      double m_DoseValue;
+      unsigned char m_Color[3];
+    };
+    typedef std::vector<IsoLineLevel> IsoLineLevelVectorType;
+
+    /** \brief Collects the visible levels of the iso dose level set and of the free iso values.*/
+    IsoLineLevelVectorType GetVisibleIsoLineLevels() const;
+
+    /** \brief Generates the outlines of all given levels in a single pass over the resliced image.*/
+    void CreateIsoLines(mitk::BaseRenderer* renderer, const IsoLineLevelVectorType& levels, vtkSmartPointer<vtkPoints> points, vtkSmartPointer<vtkCellArray> lines, vtkSmartPointer<vtkUnsignedCharArray> colors);
 
   };
 
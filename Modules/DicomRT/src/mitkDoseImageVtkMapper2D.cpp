@@ -62,6 +62,15 @@ See LICENSE.txt or http://www.mitk.org for details.
 // ITK
 #include <itkRGBAPixel.h>
 
+// STL
+#include <algorithm>
+
+namespace
+{
+  /** Number of slices per renderer whose iso lines are kept in the cache. */
+  const std::size_t MaximumNumberOfCachedIsoLineSlices = 64;
+}
+
 mitk::DoseImageVtkMapper2D::DoseImageVtkMapper2D()
 {
 }
@@ -332,7 +341,7 @@ void mitk::DoseImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *ren
   if (showIsoLines) // contour rendering
   {
     // generate contours/outlines
-    localStorage->m_OutlinePolyData = CreateOutlinePolyData(renderer);
+    localStorage->m_OutlinePolyData = this->GetCachedOutlinePolyData(renderer, thickSlicesMode, thickSlicesNum);
 
     float binaryOutlineWidth(1.0);
     if (datanode->GetFloatProperty("outline width", binaryOutlineWidth, renderer))
@@ -846,17 +855,23 @@ mitk::DoseImageVtkMapper2D::LocalStorage *mitk::DoseImageVtkMapper2D::GetLocalSt
   return m_LSH.GetLocalStorage(renderer);
 }
 
-vtkSmartPointer<vtkPolyData> mitk::DoseImageVtkMapper2D::CreateOutlinePolyData(mitk::BaseRenderer *renderer)
+mitk::DoseImageVtkMapper2D::IsoLineLevelVectorType mitk::DoseImageVtkMapper2D::GetVisibleIsoLineLevels() const
 {
-  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();      // the points to draw
-  vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New(); // the lines to connect the points
-  vtkSmartPointer<vtkUnsignedCharArray> colors = vtkSmartPointer<vtkUnsignedCharArray>::New();
-  colors->SetNumberOfComponents(3);
-  colors->SetName("Colors");
+  IsoLineLevelVectorType result;
 
   float pref;
   this->GetDataNode()->GetFloatProperty(mitk::RTConstants::REFERENCE_DOSE_PROPERTY_NAME.c_str(), pref);
 
+  auto addLevel = [&result, pref](const mitk::IsoDoseLevel *level) {
+    IsoLineLevel isoLine;
+    isoLine.m_DoseValue = level->GetDoseValue() * pref;
+    mitk::IsoDoseLevel::ColorType isoColor = level->GetColor();
+    isoLine.m_Color[0] = static_cast<unsigned char>(isoColor.GetRed() * 255);
+    isoLine.m_Color[1] = static_cast<unsigned char>(isoColor.GetGreen() * 255);
+    isoLine.m_Color[2] = static_cast<unsigned char>(isoColor.GetBlue() * 255);
+    result.push_back(isoLine);
+  };
+
   mitk::IsoDoseLevelSetProperty::Pointer propIsoSet = dynamic_cast<mitk::IsoDoseLevelSetProperty *>(
     GetDataNode()->GetProperty(mitk::RTConstants::DOSE_ISO_LEVELS_PROPERTY_NAME.c_str()));
   mitk::IsoDoseLevelSet::Pointer isoDoseLevelSet = propIsoSet->GetValue();
@@ -866,7 +881,7 @@ vtkSmartPointer<vtkPolyData> mitk::DoseImageVtkMapper2D::CreateOutlinePolyData(m
   {
     if (doseIT->GetVisibleIsoLine())
     {
-      this->CreateLevelOutline(renderer, &(doseIT.Value()), pref, points, lines, colors);
+      addLevel(&(doseIT.Value()));
     } // end of if visible dose value
   }   // end of loop over all does values
 
@@ -880,10 +895,23 @@ vtkSmartPointer<vtkPolyData> mitk::DoseImageVtkMapper2D::CreateOutlinePolyData(m
   {
     if (freeDoseIT->Value()->GetVisibleIsoLine())
     {
-      this->CreateLevelOutline(renderer, freeDoseIT->Value(), pref, points, lines, colors);
+      addLevel(freeDoseIT->Value());
     } // end of if visible dose value
   }   // end of loop over all does values
 
+  return result;
+}
+
+vtkSmartPointer<vtkPolyData> mitk::DoseImageVtkMapper2D::CreateOutlinePolyData(mitk::BaseRenderer *renderer)
+{
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();      // the points to draw
+  vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New(); // the lines to connect the points
+  vtkSmartPointer<vtkUnsignedCharArray> colors = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  colors->SetNumberOfComponents(3);
+  colors->SetName("Colors");
+
+  this->CreateIsoLines(renderer, this->GetVisibleIsoLineLevels(), points, lines, colors);
+
   // Create a polydata to store everything in
   vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
   // Add the points to the dataset
@@ -894,15 +922,80 @@ vtkSmartPointer<vtkPolyData> mitk::DoseImageVtkMapper2D::CreateOutlinePolyData(m
   return polyData;
 }
 
-void mitk::DoseImageVtkMapper2D::CreateLevelOutline(mitk::BaseRenderer *renderer,
-                                                    const mitk::IsoDoseLevel *level,
-                                                    float pref,
-                                                    vtkSmartPointer<vtkPoints> points,
-                                                    vtkSmartPointer<vtkCellArray> lines,
-                                                    vtkSmartPointer<vtkUnsignedCharArray> colors)
+vtkSmartPointer<vtkPolyData> mitk::DoseImageVtkMapper2D::GetCachedOutlinePolyData(mitk::BaseRenderer *renderer,
+                                                                                  int thickSlicesMode,
+                                                                                  int thickSlicesNum)
+{
+  LocalStorage *localStorage = this->GetLocalStorage(renderer);
+
+  // reset the cache if the dose or the iso levels changed
+  std::vector<double> levelSignature;
+  for (const auto &level : this->GetVisibleIsoLineLevels())
+  {
+    levelSignature.push_back(level.m_DoseValue);
+    levelSignature.insert(levelSignature.end(), level.m_Color, level.m_Color + 3);
+  }
+
+  const itk::ModifiedTimeType dataMTime = this->GetInput()->GetPipelineMTime();
+  if (dataMTime != localStorage->m_IsoLineCacheDataMTime || levelSignature != localStorage->m_IsoLineCacheLevels)
+  {
+    localStorage->m_IsoLineCache.clear();
+    localStorage->m_IsoLineCacheOrder.clear();
+    localStorage->m_IsoLineCacheDataMTime = dataMTime;
+    localStorage->m_IsoLineCacheLevels = levelSignature;
+  }
+
+  // identify the slice by everything that determines the resliced image and the generated lines
+  LocalStorage::IsoLineSliceKeyType sliceKey;
+  vtkMatrix4x4 *resliceAxes = localStorage->m_Reslicer->GetResliceAxes();
+  for (int i = 0; i < 4; ++i)
+  {
+    for (int j = 0; j < 4; ++j)
+    {
+      sliceKey.push_back(resliceAxes->GetElement(i, j));
+    }
+  }
+  int *extent = localStorage->m_ReslicedImage->GetExtent();
+  sliceKey.insert(sliceKey.end(), extent, extent + 6);
+  sliceKey.push_back(localStorage->m_mmPerPixel[0]);
+  sliceKey.push_back(localStorage->m_mmPerPixel[1]);
+  sliceKey.push_back(this->CalculateLayerDepth(renderer));
+  sliceKey.push_back(this->GetTimestep());
+  sliceKey.push_back(thickSlicesMode);
+  sliceKey.push_back(thickSlicesNum);
+
+  auto finding = localStorage->m_IsoLineCache.find(sliceKey);
+  if (finding != localStorage->m_IsoLineCache.end())
+  {
+    return finding->second;
+  }
+
+  vtkSmartPointer<vtkPolyData> polyData = this->CreateOutlinePolyData(renderer);
+
+  if (localStorage->m_IsoLineCacheOrder.size() >= MaximumNumberOfCachedIsoLineSlices)
+  {
+    localStorage->m_IsoLineCache.erase(localStorage->m_IsoLineCacheOrder.front());
+    localStorage->m_IsoLineCacheOrder.pop_front();
+  }
+  localStorage->m_IsoLineCache[sliceKey] = polyData;
+  localStorage->m_IsoLineCacheOrder.push_back(sliceKey);
+
+  return polyData;
+}
+
+void mitk::DoseImageVtkMapper2D::CreateIsoLines(mitk::BaseRenderer *renderer,
+                                                const IsoLineLevelVectorType &levels,
+                                                vtkSmartPointer<vtkPoints> points,
+                                                vtkSmartPointer<vtkCellArray> lines,
+                                                vtkSmartPointer<vtkUnsignedCharArray> colors)
 {
   LocalStorage *localStorage = this->GetLocalStorage(renderer);
 
+  if (levels.empty())
+  {
+    return;
+  }
+
   // get the min and max index values of each direction
   int *extent = localStorage->m_ReslicedImage->GetExtent();
   int xMin = extent[0];
@@ -915,150 +1008,111 @@ void mitk::DoseImageVtkMapper2D::CreateLevelOutline(mitk::BaseRenderer *renderer
   // get the depth for each contour
   float depth = CalculateLayerDepth(renderer);
 
-  double doseValue = level->GetDoseValue() * pref;
-  mitk::IsoDoseLevel::ColorType isoColor = level->GetColor();
-  unsigned char colorLine[3] = {static_cast<unsigned char>(isoColor.GetRed() * 255),
-                                static_cast<unsigned char>(isoColor.GetGreen() * 255),
-                                static_cast<unsigned char>(isoColor.GetBlue() * 255)};
-
-  int x = xMin; // pixel index x
-  int y = yMin; // pixel index y
-  float *currentPixel;
-
   // We take the pointer to the first pixel of the image
-  currentPixel = static_cast<float *>(localStorage->m_ReslicedImage->GetScalarPointer());
-
-  while (y <= yMax)
+  const float *currentPixel = static_cast<float *>(localStorage->m_ReslicedImage->GetScalarPointer());
+  if (!currentPixel)
   {
-    // if the current pixel value is set to something
-    if ((currentPixel) && (*currentPixel >= doseValue))
-    {
-      // check in which direction a line is necessary
-      // a line is added if the neighbor of the current pixel has the value 0
-      // and if the pixel is located at the edge of the image
-
-      // if   vvvvv  not the first line vvvvv
-      if (y > yMin && *(currentPixel - line) < doseValue)
-      { // x direction - bottom edge of the pixel
-        // add the 2 points
-        vtkIdType p1 =
-          points->InsertNextPoint(x * localStorage->m_mmPerPixel[0], y * localStorage->m_mmPerPixel[1], depth);
-        vtkIdType p2 =
-          points->InsertNextPoint((x + 1) * localStorage->m_mmPerPixel[0], y * localStorage->m_mmPerPixel[1], depth);
-        // add the line between both points
-        lines->InsertNextCell(2);
-        lines->InsertCellPoint(p1);
-        lines->InsertCellPoint(p2);
-        colors->InsertNextTypedTuple(colorLine);
-      }
-
-      // if   vvvvv  not the last line vvvvv
-      if (y < yMax && *(currentPixel + line) < doseValue)
-      { // x direction - top edge of the pixel
-        vtkIdType p1 =
-          points->InsertNextPoint(x * localStorage->m_mmPerPixel[0], (y + 1) * localStorage->m_mmPerPixel[1], depth);
-        vtkIdType p2 = points->InsertNextPoint(
-          (x + 1) * localStorage->m_mmPerPixel[0], (y + 1) * localStorage->m_mmPerPixel[1], depth);
-        lines->InsertNextCell(2);
-        lines->InsertCellPoint(p1);
-        lines->InsertCellPoint(p2);
-        colors->InsertNextTypedTuple(colorLine);
-      }
+    return;
+  }
 
-      // if   vvvvv  not the first pixel vvvvv
-      if ((x > xMin || y > yMin) && *(currentPixel - 1) < doseValue)
-      { // y direction - left edge of the pixel
-        vtkIdType p1 =
-          points->InsertNextPoint(x * localStorage->m_mmPerPixel[0], y * localStorage->m_mmPerPixel[1], depth);
-        vtkIdType p2 =
-          points->InsertNextPoint(x * localStorage->m_mmPerPixel[0], (y + 1) * localStorage->m_mmPerPixel[1], depth);
-        lines->InsertNextCell(2);
-        lines->InsertCellPoint(p1);
-        lines->InsertCellPoint(p2);
-        colors->InsertNextTypedTuple(colorLine);
-      }
+  // the levels sorted by dose value, so the levels crossed by an edge are a contiguous range
+  std::vector<std::size_t> levelOrder(levels.size());
+  for (std::size_t i = 0; i < levelOrder.size(); ++i)
+  {
+    levelOrder[i] = i;
+  }
+  std::stable_sort(levelOrder.begin(), levelOrder.end(), [&levels](std::size_t a, std::size_t b) {
+    return levels[a].m_DoseValue < levels[b].m_DoseValue;
+  });
+  std::vector<double> sortedDoseValues;
+  for (std::size_t index : levelOrder)
+  {
+    sortedDoseValues.push_back(levels[index].m_DoseValue);
+  }
 
-      // if   vvvvv  not the last pixel vvvvv
-      if ((y < yMax || (x < xMax)) && *(currentPixel + 1) < doseValue)
-      { // y direction - right edge of the pixel
-        vtkIdType p1 =
-          points->InsertNextPoint((x + 1) * localStorage->m_mmPerPixel[0], y * localStorage->m_mmPerPixel[1], depth);
-        vtkIdType p2 = points->InsertNextPoint(
-          (x + 1) * localStorage->m_mmPerPixel[0], (y + 1) * localStorage->m_mmPerPixel[1], depth);
-        lines->InsertNextCell(2);
-        lines->InsertCellPoint(p1);
-        lines->InsertCellPoint(p2);
-        colors->InsertNextTypedTuple(colorLine);
-      }
+  // every pixel corner is inserted only once and shared by all lines and levels
+  const int cornersPerLine = line + 1;
+  std::vector<vtkIdType> cornerIds(static_cast<std::size_t>(cornersPerLine) * (yMax - yMin + 2), -1);
+  auto corner = [&](int x, int y) {
+    vtkIdType &id = cornerIds[static_cast<std::size_t>(y - yMin) * cornersPerLine + (x - xMin)];
+    if (id < 0)
+    {
+      id = points->InsertNextPoint(x * localStorage->m_mmPerPixel[0], y * localStorage->m_mmPerPixel[1], depth);
+    }
+    return id;
+  };
 
-      /*  now consider pixels at the edge of the image  */
-
-      // if   vvvvv  left edge of image vvvvv
-      if (x == xMin)
-      { // draw left edge of the pixel
-        vtkIdType p1 =
-          points->InsertNextPoint(x * localStorage->m_mmPerPixel[0], y * localStorage->m_mmPerPixel[1], depth);
-        vtkIdType p2 =
-          points->InsertNextPoint(x * localStorage->m_mmPerPixel[0], (y + 1) * localStorage->m_mmPerPixel[1], depth);
-        lines->InsertNextCell(2);
-        lines->InsertCellPoint(p1);
-        lines->InsertCellPoint(p2);
-        colors->InsertNextTypedTuple(colorLine);
-      }
+  // point ids of the line segments, collected per level to keep the drawing order of the levels
+  std::vector<std::vector<vtkIdType>> segments(levels.size());
+  auto addEdge = [&](std::size_t firstLevel, std::size_t endLevel, int x1, int y1, int x2, int y2) {
+    if (firstLevel >= endLevel)
+    {
+      return;
+    }
+    const vtkIdType p1 = corner(x1, y1);
+    const vtkIdType p2 = corner(x2, y2);
+    for (std::size_t i = firstLevel; i < endLevel; ++i)
+    {
+      std::vector<vtkIdType> &levelSegments = segments[levelOrder[i]];
+      levelSegments.push_back(p1);
+      levelSegments.push_back(p2);
+    }
+  };
 
-      // if   vvvvv  right edge of image vvvvv
-      if (x == xMax)
-      { // draw right edge of the pixel
-        vtkIdType p1 =
-          points->InsertNextPoint((x + 1) * localStorage->m_mmPerPixel[0], y * localStorage->m_mmPerPixel[1], depth);
-        vtkIdType p2 = points->InsertNextPoint(
-          (x + 1) * localStorage->m_mmPerPixel[0], (y + 1) * localStorage->m_mmPerPixel[1], depth);
-        lines->InsertNextCell(2);
-        lines->InsertCellPoint(p1);
-        lines->InsertCellPoint(p2);
-        colors->InsertNextTypedTuple(colorLine);
-      }
+  // number of levels with a dose value <= value
+  auto levelsBelow = [&sortedDoseValues](float value) {
+    return static_cast<std::size_t>(
+      std::upper_bound(sortedDoseValues.begin(), sortedDoseValues.end(), value) - sortedDoseValues.begin());
+  };
 
-      // if   vvvvv  bottom edge of image vvvvv
-      if (y == yMin)
-      { // draw bottom edge of the pixel
-        vtkIdType p1 =
-          points->InsertNextPoint(x * localStorage->m_mmPerPixel[0], y * localStorage->m_mmPerPixel[1], depth);
-        vtkIdType p2 =
-          points->InsertNextPoint((x + 1) * localStorage->m_mmPerPixel[0], y * localStorage->m_mmPerPixel[1], depth);
-        lines->InsertNextCell(2);
-        lines->InsertCellPoint(p1);
-        lines->InsertCellPoint(p2);
-        colors->InsertNextTypedTuple(colorLine);
+  for (int y = yMin; y <= yMax; ++y)
+  {
+    for (int x = xMin; x <= xMax; ++x, ++currentPixel)
+    {
+      const float value = *currentPixel;
+      if (value != value)
+      {
+        continue;
       }
 
-      // if   vvvvv  top edge of image vvvvv
-      if (y == yMax)
-      { // draw top edge of the pixel
-        vtkIdType p1 =
-          points->InsertNextPoint(x * localStorage->m_mmPerPixel[0], (y + 1) * localStorage->m_mmPerPixel[1], depth);
-        vtkIdType p2 = points->InsertNextPoint(
-          (x + 1) * localStorage->m_mmPerPixel[0], (y + 1) * localStorage->m_mmPerPixel[1], depth);
-        lines->InsertNextCell(2);
-        lines->InsertCellPoint(p1);
-        lines->InsertCellPoint(p2);
-        colors->InsertNextTypedTuple(colorLine);
+      // all levels with a dose value <= pixel value enclose the pixel
+      const std::size_t enclosing = levelsBelow(value);
+      if (enclosing == 0)
+      {
+        continue;
       }
-    } // end if currentpixel is set
 
-    x++;
+      // a line of a level is added at the edge to a neighbor below the dose value of the level
+      // and at the edges of the image
+      auto neighborEdge = [&](bool atImageEdge, const float *neighbor, int x1, int y1, int x2, int y2) {
+        if (atImageEdge)
+        {
+          addEdge(0, enclosing, x1, y1, x2, y2);
+        }
+        else if (*neighbor == *neighbor)
+        {
+          addEdge(levelsBelow(*neighbor), enclosing, x1, y1, x2, y2);
+        }
+      };
 
-    if (x > xMax)
-    { // reached end of line
-      x = xMin;
-      y++;
+      neighborEdge(y == yMin, currentPixel - line, x, y, x + 1, y);                 // bottom edge of the pixel
+      neighborEdge(y == yMax, currentPixel + line, x, y + 1, x + 1, y + 1);         // top edge of the pixel
+      neighborEdge(x == xMin, currentPixel - 1, x, y, x, y + 1);                    // left edge of the pixel
+      neighborEdge(x == xMax, currentPixel + 1, x + 1, y, x + 1, y + 1);            // right edge of the pixel
     }
+  }
 
-    // Increase the pointer-position to the next pixel.
-    // This is safe, as the while-loop and the x-reset logic above makes
-    // sure we do not exceed the bounds of the image
-    currentPixel++;
-  } // end of while
+  for (std::size_t levelIndex = 0; levelIndex < levels.size(); ++levelIndex)
+  {
+    const std::vector<vtkIdType> &levelSegments = segments[levelIndex];
+    for (std::size_t i = 0; i < levelSegments.size(); i += 2)
+    {
+      lines->InsertNextCell(2);
+      lines->InsertCellPoint(levelSegments[i]);
+      lines->InsertCellPoint(levelSegments[i + 1]);
+      colors->InsertNextTypedTuple(levels[levelIndex].m_Color);
+    }
+  }
 }
 
 void mitk::DoseImageVtkMapper2D::TransformActor(mitk::BaseRenderer *renderer)
@@ -1115,7 +1169,7 @@ mitk::DoseImageVtkMapper2D::LocalStorage::~LocalStorage()
 }
 
 mitk::DoseImageVtkMapper2D::LocalStorage::LocalStorage()
-  : m_VectorComponentExtractor(vtkSmartPointer<vtkImageExtractComponents>::New())
+  : m_VectorComponentExtractor(vtkSmartPointer<vtkImageExtractComponents>::New()), m_IsoLineCacheDataMTime(0)
 {
   m_LevelWindowFilter = vtkSmartPointer<vtkMitkLevelWindowFilter>::New();
 
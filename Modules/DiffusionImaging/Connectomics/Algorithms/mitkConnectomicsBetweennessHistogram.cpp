@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <boost/numeric/conversion/converter.hpp>
 
 #include <mitkConnectomicsConstantsManager.h>
+#include <mitkConnectomicsParallelGraphAlgorithms.h>
 
 mitk::ConnectomicsBetweennessHistogram::ConnectomicsBetweennessHistogram()
 : m_Mode( UnweightedUndirectedMode )
@@ -71,13 +72,17 @@ void mitk::ConnectomicsBetweennessHistogram::ComputeFromConnectomicsNetwork( Con
 void mitk::ConnectomicsBetweennessHistogram::CalculateUnweightedUndirectedBetweennessCentrality(
   NetworkType* boostGraph, IteratorType /*vertex_iterator_begin*/, IteratorType /*vertex_iterator_end*/ )
 {
-  boost::brandes_betweenness_centrality(
-    *boostGraph,
-    boost::centrality_map(
-    boost::make_iterator_property_map( m_CentralityMap.begin(), boost::get( &mitk::ConnectomicsNetwork::NetworkNode::id, *boostGraph ), double() )
-    ).vertex_index_map( boost::get( &mitk::ConnectomicsNetwork::NetworkNode::id, *boostGraph ) )
-    );
-
+  std::vector< double > vertexCentrality;
+  std::vector< double > edgeCentrality;
+  mitk::ConnectomicsParallelGraphAlgorithms::ComputeBetweennessCentrality( *boostGraph, vertexCentrality, edgeCentrality );
+
+  // the centrality map is indexed by the node ids
+  IteratorType iterator, end;
+  boost::tie( iterator, end ) = boost::vertices( *boostGraph );
+  for ( ; iterator != end; ++iterator )
+  {
+    m_CentralityMap[ (*boostGraph)[ *iterator ].id ] = vertexCentrality[ *iterator ];
+  }
 }
 
 void mitk::ConnectomicsBetweennessHistogram::CalculateWeightedUndirectedBetweennessCentrality(
@@ -24,13 +24,17 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkConnectomicsDegreeHistogram.h>
 #include <mitkConnectomicsBetweennessHistogram.h>
 #include <mitkConnectomicsShortestPathHistogram.h>
+#include <mitkConnectomicsStatisticsCalculator.h>
 
 #include <MitkConnectomicsExports.h>
 
 namespace mitk {
 
   /**
-    * @brief Provides a method to cache network histograms
+    * @brief Provides a method to cache network histograms and statistics
+    *
+    * The histograms and the network statistics are computed once per network and are only
+    * recomputed after the network has been modified, so repeated requests are free.
     */
 
   class ConnectomicsHistogramsContainer
@@ -42,6 +46,15 @@ namespace mitk {
       m_BetweennessHistogram.ComputeFromBaseData(baseData);
       m_DegreeHistogram.ComputeFromBaseData(baseData);
       m_ShortestPathHistogram.ComputeFromBaseData(baseData);
+
+      m_StatisticsCalculator = nullptr;
+      ConnectomicsNetwork* network = dynamic_cast<ConnectomicsNetwork*>(baseData);
+      if (network != nullptr)
+      {
+        m_StatisticsCalculator = ConnectomicsStatisticsCalculator::New();
+        m_StatisticsCalculator->SetNetwork(network);
+        m_StatisticsCalculator->Update();
+      }
     }
 
     ConnectomicsBetweennessHistogram* GetBetweennessHistogram( )
@@ -59,9 +72,16 @@ namespace mitk {
       return &m_ShortestPathHistogram;
     }
 
+    /** @brief Statistics of the network, nullptr if the data is no network */
+    ConnectomicsStatisticsCalculator* GetStatisticsCalculator( )
+    {
+      return m_StatisticsCalculator;
+    }
+
     ConnectomicsBetweennessHistogram  m_BetweennessHistogram;
     ConnectomicsDegreeHistogram       m_DegreeHistogram;
     ConnectomicsShortestPathHistogram m_ShortestPathHistogram;
+    ConnectomicsStatisticsCalculator::Pointer m_StatisticsCalculator;
   };
 
   class MITKCONNECTOMICS_EXPORT ConnectomicsHistogramCache : public SimpleHistogramCache
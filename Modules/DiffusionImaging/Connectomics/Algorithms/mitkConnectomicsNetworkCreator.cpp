@@ -16,13 +16,18 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkConnectomicsNetworkCreator.h"
 
+#include <algorithm>
 #include <sstream>
 #include <vector>
 
+#include <omp.h>
+
 #include "mitkConnectomicsConstantsManager.h"
 #include "mitkImageAccessByItk.h"
 #include "mitkImageStatisticsHolder.h"
 #include "mitkImageCast.h"
+#include "mitkExceptionMacro.h"
+#include "mitkFiberBundleStreamReader.h"
 
 #include "itkImageRegionIteratorWithIndex.h"
 
@@ -44,6 +49,7 @@ mitk::ConnectomicsNetworkCreator::ConnectomicsNetworkCreator()
 , m_MappingStrategy( EndElementPositionAvoidingWhiteMatter )
 , m_EndPointSearchRadius( 10.0 )
 , m_ZeroLabelInvalid( true )
+, m_FiberChunkSize( 100000 )
 , m_AbortConnection( false )
 {
 }
@@ -60,6 +66,7 @@ mitk::ConnectomicsNetworkCreator::ConnectomicsNetworkCreator( mitk::Image::Point
 , m_MappingStrategy( EndElementPositionAvoidingWhiteMatter )
 , m_EndPointSearchRadius( 10.0 )
 , m_ZeroLabelInvalid( true )
+, m_FiberChunkSize( 100000 )
 , m_AbortConnection( false )
 {
   mitk::CastToItkImage( segmentation, m_SegmentationItk );
@@ -89,42 +96,195 @@ itk::Point<float, 3> mitk::ConnectomicsNetworkCreator::GetItkPoint(double point[
   return itkPoint;
 }
 
-void mitk::ConnectomicsNetworkCreator::CreateNetworkFromFibersAndSegmentation()
+void mitk::ConnectomicsNetworkCreator::InitializeNetwork()
 {
-
   //empty graph
   m_ConNetwork = mitk::ConnectomicsNetwork::New();
   m_LabelToVertexMap.clear();
   m_LabelToNodePropertyMap.clear();
   idCounter = 0;
+}
+
+void mitk::ConnectomicsNetworkCreator::CreateNetworkFromFibersAndSegmentation()
+{
+  InitializeNetwork();
 
   vtkSmartPointer<vtkPolyData> fiberPolyData = m_FiberBundle->GetFiberPolyData();
+  vtkCellArray* lines = fiberPolyData->GetLines();
+  vtkPoints* points = fiberPolyData->GetPoints();
 
+  std::vector< FiberMappingAccumulator > threadMappings( omp_get_max_threads() );
+  unsigned int chunkSize = std::max( m_FiberChunkSize, 1u );
+
+  // copy the fibers chunk by chunk, so only the points of one chunk are held twice
+  FiberPointBuffer chunk;
+  std::vector< float > chunkWeights;
+  std::vector< float > fiberPoints;
   int numFibers = m_FiberBundle->GetNumFibers();
-  for( int fiberID( 0 ); fiberID < numFibers; fiberID++ )
+  int fiberID( 0 );
+  vtkIdType numPoints( 0 );
+  vtkIdType* pointIds( nullptr );
+  double point[3];
+  lines->InitTraversal();
+  while( fiberID < numFibers )
   {
-    vtkCell* cell = fiberPolyData->GetCell(fiberID);
-    int numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
+    OccurrenceType firstFiber = fiberID;
+    chunk.Clear();
+    chunkWeights.clear();
+    for( unsigned int i( 0 ); i < chunkSize && fiberID < numFibers && lines->GetNextCell( numPoints, pointIds ); i++, fiberID++ )
+    {
+      fiberPoints.resize( 3 * numPoints );
+      for( vtkIdType pointInCellID( 0 ); pointInCellID < numPoints; pointInCellID++ )
+      {
+        points->GetPoint( pointIds[ pointInCellID ], point );
+        fiberPoints[ 3 * pointInCellID ] = point[ 0 ];
+        fiberPoints[ 3 * pointInCellID + 1 ] = point[ 1 ];
+        fiberPoints[ 3 * pointInCellID + 2 ] = point[ 2 ];
+      }
+      chunk.AddFiber( fiberPoints );
+      chunkWeights.push_back( m_FiberBundle->GetFiberWeight( fiberID ) );
+    }
 
-    TractType::Pointer singleTract = TractType::New();
-    for( int pointInCellID( 0 ); pointInCellID < numPoints ; pointInCellID++)
+    if( chunk.GetNumberOfFibers() == 0 )
     {
-      // push back point
-      PointType point = GetItkPoint( points->GetPoint( pointInCellID ) );
-      singleTract->InsertElement( singleTract->Size(), point );
+      break;
     }
+    MapFibers( chunk, chunkWeights, firstFiber, threadMappings );
+  }
+
+  BuildNetwork( threadMappings );
+}
+
+void mitk::ConnectomicsNetworkCreator::CreateNetworkFromFiberStreamAndSegmentation( FiberBundleStreamReader* reader )
+{
+  if( reader == nullptr )
+  {
+    mitkThrow() << "No fiber stream reader set.";
+  }
+
+  // stream mode, the fiber points are world coordinates
+  m_FiberBundle = nullptr;
+  InitializeNetwork();
+
+  std::vector< FiberMappingAccumulator > threadMappings( omp_get_max_threads() );
+  unsigned int chunkSize = std::max( m_FiberChunkSize, 1u );
+
+  FiberPointBuffer chunk;
+  std::vector< float > chunkWeights;
+  OccurrenceType firstFiber( 0 );
+  while( reader->ReadChunk( chunk, chunkSize ) > 0 )
+  {
+    // streamed fibers carry no weights
+    chunkWeights.assign( chunk.GetNumberOfFibers(), 1.0 );
+    MapFibers( chunk, chunkWeights, firstFiber, threadMappings );
+    firstFiber += chunk.GetNumberOfFibers();
+    chunk.Clear();
+  }
 
-    if ( singleTract && ( singleTract->Size() > 0 ) )
+  BuildNetwork( threadMappings );
+}
+
+void mitk::ConnectomicsNetworkCreator::MapFibers( const FiberPointBuffer& fibers, const std::vector< float >& fiberWeights,
+  OccurrenceType firstFiber, std::vector< FiberMappingAccumulator >& threadMappings )
+{
+  int numFibers = fibers.GetNumberOfFibers();
+
+#pragma omp parallel
+  {
+    FiberMappingAccumulator& mapping = threadMappings[ omp_get_thread_num() ];
+    TractType::Pointer singleTract = TractType::New();
+
+#pragma omp for schedule(dynamic, 256)
+    for( int fiberID = 0; fiberID < numFibers; fiberID++ )
     {
-      AddConnectionToNetwork(
-        ReturnAssociatedVertexPairForLabelPair(
-        ReturnLabelForFiberTract( singleTract, m_MappingStrategy )
-        ), m_FiberBundle->GetFiberWeight(fiberID)
-        );
-      m_AbortConnection = false;
+      int numPoints = fibers.GetNumberOfPoints( fiberID );
+      if( numPoints == 0 )
+      {
+        continue;
+      }
+
+      const float* fiberPoints = fibers.GetFiberPoints( fiberID );
+      singleTract->Initialize();
+      for( int pointInCellID( 0 ); pointInCellID < numPoints ; pointInCellID++)
+      {
+        PointType point;
+        point[0] = fiberPoints[ 3 * pointInCellID ];
+        point[1] = fiberPoints[ 3 * pointInCellID + 1 ];
+        point[2] = fiberPoints[ 3 * pointInCellID + 2 ];
+        singleTract->InsertElement( pointInCellID, point );
+      }
+
+      ImageIndexPairType endIndices;
+      ImageLabelPairType labelpair = ReturnLabelForFiberTract( singleTract, m_MappingStrategy, endIndices );
+
+      // same rules as ReturnAssociatedVertexForLabel and AddConnectionToNetwork
+      OccurrenceType occurrence = 2 * ( firstFiber + fiberID );
+      bool firstValid = !( m_ZeroLabelInvalid && ( labelpair.first == 0 ) );
+      bool lastValid = !( m_ZeroLabelInvalid && ( labelpair.second == 0 ) );
+      if( firstValid )
+      {
+        mapping.AddLabel( labelpair.first, endIndices.first, occurrence );
+      }
+      if( lastValid )
+      {
+        mapping.AddLabel( labelpair.second, endIndices.second, occurrence + 1 );
+      }
+      if( firstValid && lastValid && ( allowLoops || labelpair.first != labelpair.second ) )
+      {
+        mapping.AddConnection( labelpair, fiberWeights[ fiberID ], occurrence );
+      }
     }
   }
+}
+
+namespace
+{
+  template< class TIterator >
+  bool FirstOccurrenceLess( const TIterator& a, const TIterator& b )
+  {
+    return a->second.first < b->second.first;
+  }
+}
+
+void mitk::ConnectomicsNetworkCreator::BuildNetwork( std::vector< FiberMappingAccumulator >& threadMappings )
+{
+  FiberMappingAccumulator mapping;
+  for( unsigned int i( 0 ); i < threadMappings.size(); i++ )
+  {
+    mapping.Merge( threadMappings[ i ] );
+  }
+  threadMappings.clear();
+
+  // create the vertices and edges in the order of a serial pass over the fibers
+  typedef std::map< ImageLabelType, FiberMappingAccumulator::LabelEntry >::const_iterator LabelIteratorType;
+  std::vector< LabelIteratorType > labels;
+  for( LabelIteratorType it = mapping.m_Labels.begin(); it != mapping.m_Labels.end(); ++it )
+  {
+    labels.push_back( it );
+  }
+  std::sort( labels.begin(), labels.end(), FirstOccurrenceLess< LabelIteratorType > );
+
+  for( unsigned int i( 0 ); i < labels.size(); i++ )
+  {
+    CreateNewNode( labels[ i ]->first, labels[ i ]->second.index, m_UseCoMCoordinates );
+    ReturnAssociatedVertexForLabel( labels[ i ]->first );
+  }
+
+  typedef std::map< ImageLabelPairType, FiberMappingAccumulator::ConnectionEntry >::const_iterator ConnectionIteratorType;
+  std::vector< ConnectionIteratorType > connections;
+  for( ConnectionIteratorType it = mapping.m_Connections.begin(); it != mapping.m_Connections.end(); ++it )
+  {
+    connections.push_back( it );
+  }
+  std::sort( connections.begin(), connections.end(), FirstOccurrenceLess< ConnectionIteratorType > );
+
+  for( unsigned int i( 0 ); i < connections.size(); i++ )
+  {
+    AddConnectionToNetwork(
+      ReturnAssociatedVertexPairForLabelPair( connections[ i ]->second.labels ),
+      connections[ i ]->second.fiber_count );
+    m_AbortConnection = false;
+  }
 
   // Prune unconnected nodes
   //m_ConNetwork->PruneUnconnectedSingleNodes();
@@ -137,6 +297,58 @@ void mitk::ConnectomicsNetworkCreator::CreateNetworkFromFibersAndSegmentation()
   MBI_INFO << mitk::ConnectomicsConstantsManager::CONNECTOMICS_WARNING_INFO_NETWORK_CREATED;
 }
 
+void mitk::ConnectomicsNetworkCreator::FiberMappingAccumulator::AddLabel( ImageLabelType label, const itk::Index<3>& index, OccurrenceType occurrence )
+{
+  std::map< ImageLabelType, LabelEntry >::iterator it = m_Labels.find( label );
+  if( it == m_Labels.end() )
+  {
+    LabelEntry entry;
+    entry.first = occurrence;
+    entry.index = index;
+    m_Labels.insert( std::make_pair( label, entry ) );
+  }
+  else if( occurrence < it->second.first )
+  {
+    it->second.first = occurrence;
+    it->second.index = index;
+  }
+}
+
+void mitk::ConnectomicsNetworkCreator::FiberMappingAccumulator::AddConnection( const ImageLabelPairType& labels, double fiber_count, OccurrenceType occurrence )
+{
+  // connections are undirected
+  ImageLabelPairType key( std::min( labels.first, labels.second ), std::max( labels.first, labels.second ) );
+  std::map< ImageLabelPairType, ConnectionEntry >::iterator it = m_Connections.find( key );
+  if( it == m_Connections.end() )
+  {
+    ConnectionEntry entry;
+    entry.first = occurrence;
+    entry.labels = labels;
+    entry.fiber_count = fiber_count;
+    m_Connections.insert( std::make_pair( key, entry ) );
+    return;
+  }
+
+  if( occurrence < it->second.first )
+  {
+    it->second.first = occurrence;
+    it->second.labels = labels;
+  }
+  it->second.fiber_count += fiber_count;
+}
+
+void mitk::ConnectomicsNetworkCreator::FiberMappingAccumulator::Merge( const FiberMappingAccumulator& other )
+{
+  for( std::map< ImageLabelType, LabelEntry >::const_iterator it = other.m_Labels.begin(); it != other.m_Labels.end(); ++it )
+  {
+    AddLabel( it->first, it->second.index, it->second.first );
+  }
+  for( std::map< ImageLabelPairType, ConnectionEntry >::const_iterator it = other.m_Connections.begin(); it != other.m_Connections.end(); ++it )
+  {
+    AddConnection( it->second.labels, it->second.fiber_count, it->second.first );
+  }
+}
+
 void mitk::ConnectomicsNetworkCreator::AddConnectionToNetwork(ConnectionType newConnection, double fiber_count)
 {
   if( m_AbortConnection )
@@ -193,25 +405,25 @@ mitk::ConnectomicsNetworkCreator::ConnectionType mitk::ConnectomicsNetworkCreato
   return connection;
 }
 
-mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCreator::ReturnLabelForFiberTract( TractType::Pointer singleTract, mitk::ConnectomicsNetworkCreator::MappingStrategy strategy)
+mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCreator::ReturnLabelForFiberTract( TractType::Pointer singleTract, mitk::ConnectomicsNetworkCreator::MappingStrategy strategy, ImageIndexPairType& endIndices )
 {
   switch( strategy )
   {
   case EndElementPosition:
     {
-      return EndElementPositionLabel( singleTract );
+      return EndElementPositionLabel( singleTract, endIndices );
     }
   case JustEndPointVerticesNoLabel:
     {
-      return JustEndPointVerticesNoLabelTest( singleTract );
+      return JustEndPointVerticesNoLabelTest( singleTract, endIndices );
     }
   case EndElementPositionAvoidingWhiteMatter:
     {
-      return EndElementPositionLabelAvoidingWhiteMatter( singleTract );
+      return EndElementPositionLabelAvoidingWhiteMatter( singleTract, endIndices );
     }
   case PrecomputeAndDistance:
     {
-      return PrecomputeVertexLocationsBySegmentation( singleTract );
+      return PrecomputeVertexLocationsBySegmentation( singleTract, endIndices );
     }
   }
 
@@ -221,7 +433,7 @@ mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCr
   return nullPair;
 }
 
-mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCreator::EndElementPositionLabel( TractType::Pointer singleTract )
+mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCreator::EndElementPositionLabel( TractType::Pointer singleTract, ImageIndexPairType& endIndices )
 {
   ImageLabelPairType labelpair;
 
@@ -256,22 +468,22 @@ mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCr
     labelpair.first = firstLabel;
     labelpair.second = lastLabel;
 
-    // Add property to property map
-    CreateNewNode( firstLabel, firstElementSegIndex, m_UseCoMCoordinates );
-    CreateNewNode( lastLabel, lastElementSegIndex, m_UseCoMCoordinates );
+    // the nodes are created from these when the network is built
+    endIndices.first = firstElementSegIndex;
+    endIndices.second = lastElementSegIndex;
   }
 
   return labelpair;
 }
 
-mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCreator::PrecomputeVertexLocationsBySegmentation( TractType::Pointer /*singleTract*/ )
+mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCreator::PrecomputeVertexLocationsBySegmentation( TractType::Pointer /*singleTract*/, ImageIndexPairType& /*endIndices*/ )
 {
   ImageLabelPairType labelpair;
 
   return labelpair;
 }
 
-mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCreator::EndElementPositionLabelAvoidingWhiteMatter( TractType::Pointer singleTract )
+mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCreator::EndElementPositionLabelAvoidingWhiteMatter( TractType::Pointer singleTract, ImageIndexPairType& endIndices )
 {
   ImageLabelPairType labelpair;
 
@@ -382,15 +594,15 @@ mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCr
     labelpair.first = firstLabel;
     labelpair.second = lastLabel;
 
-    // Add property to property map
-    CreateNewNode( firstLabel, firstElementSegIndex, m_UseCoMCoordinates );
-    CreateNewNode( lastLabel, lastElementSegIndex, m_UseCoMCoordinates );
+    // the nodes are created from these when the network is built
+    endIndices.first = firstElementSegIndex;
+    endIndices.second = lastElementSegIndex;
   }
 
   return labelpair;
 }
 
-mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCreator::JustEndPointVerticesNoLabelTest( TractType::Pointer singleTract )
+mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCreator::JustEndPointVerticesNoLabelTest( TractType::Pointer singleTract, ImageIndexPairType& endIndices )
 {
   ImageLabelPairType labelpair;
 
@@ -425,9 +637,9 @@ mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCr
     labelpair.first = firstLabel;
     labelpair.second = lastLabel;
 
-    // Add property to property map
-    CreateNewNode( firstLabel, firstElementSegIndex, m_UseCoMCoordinates );
-    CreateNewNode( lastLabel, lastElementSegIndex, m_UseCoMCoordinates );
+    // the nodes are created from these when the network is built
+    endIndices.first = firstElementSegIndex;
+    endIndices.second = lastElementSegIndex;
   }
 
   return labelpair;
@@ -462,8 +674,16 @@ void mitk::ConnectomicsNetworkCreator::FiberToSegmentationCoords( mitk::Point3D&
 {
   mitk::Point3D tempPoint;
 
-  // convert from fiber index coordinates to segmentation index coordinates
-  m_FiberBundle->GetGeometry()->IndexToWorld( fiberCoord, tempPoint );
+  // convert from fiber index coordinates to segmentation index coordinates,
+  // streamed fibers are already in world coordinates
+  if( m_FiberBundle.IsNotNull() )
+  {
+    m_FiberBundle->GetGeometry()->IndexToWorld( fiberCoord, tempPoint );
+  }
+  else
+  {
+    tempPoint = fiberCoord;
+  }
   m_Segmentation->GetGeometry()->WorldToIndex( tempPoint, segCoord );
 }
 
@@ -473,7 +693,14 @@ void mitk::ConnectomicsNetworkCreator::SegmentationToFiberCoords( mitk::Point3D&
 
   // convert from fiber index coordinates to segmentation index coordinates
   m_Segmentation->GetGeometry()->IndexToWorld( segCoord, tempPoint );
-  m_FiberBundle->GetGeometry()->WorldToIndex( tempPoint, fiberCoord );
+  if( m_FiberBundle.IsNotNull() )
+  {
+    m_FiberBundle->GetGeometry()->WorldToIndex( tempPoint, fiberCoord );
+  }
+  else
+  {
+    fiberCoord = tempPoint;
+  }
 }
 
 bool mitk::ConnectomicsNetworkCreator::IsNonWhiteMatterLabel( int labelInQuestion )
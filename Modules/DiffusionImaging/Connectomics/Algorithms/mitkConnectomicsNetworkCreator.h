@@ -25,6 +25,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkImage.h"
 
 #include "mitkFiberBundle.h"
+#include "mitkFiberPointBuffer.h"
 #include "mitkConnectomicsNetwork.h"
 
 #include <MitkConnectomicsExports.h>
@@ -32,11 +33,18 @@ See LICENSE.txt or http://www.mitk.org for details.
 namespace mitk
 {
 
+  class FiberBundleStreamReader;
+
   /**
     * \brief Creates connectomics networks from fibers and parcellation
     *
     * This class needs a parcellation image and a fiber image to be set. Then you can create
     * a connectomics network from the two, using different strategies.
+    *
+    * The fibers are mapped to label pairs in parallel and chunk by chunk. Every thread collects
+    * the labels and connections it found, the network is built from the merged results afterwards
+    * in the order in which a serial pass would have hit them. Instead of a fiber bundle, the fibers
+    * can also be streamed from a file, so the tractogram never has to be loaded completely.
     */
 
   class MITKCONNECTOMICS_EXPORT ConnectomicsNetworkCreator : public itk::Object
@@ -82,6 +90,11 @@ namespace mitk
 
     /** Given a fiber bundle and a parcellation are set, this will create a network from both */
     void CreateNetworkFromFibersAndSegmentation();
+
+    /** Given a parcellation is set, this will create a network from the fibers of the opened reader.
+    The fibers are read chunk by chunk, their points are expected in world coordinates and all are counted
+    with weight 1. A fiber bundle set before is released. */
+    void CreateNetworkFromFiberStreamAndSegmentation( FiberBundleStreamReader* reader );
     void SetFiberBundle(mitk::FiberBundle::Pointer fiberBundle);
     void SetSegmentation(mitk::Image::Pointer segmentation);
 
@@ -90,6 +103,9 @@ namespace mitk
     itkSetMacro(MappingStrategy, MappingStrategy);
     itkSetMacro(EndPointSearchRadius, double);
     itkSetMacro(ZeroLabelInvalid, bool);
+    /** Number of fibers that are mapped at once, this bounds the memory used for the fiber points */
+    itkSetMacro(FiberChunkSize, unsigned int);
+    itkGetMacro(FiberChunkSize, unsigned int);
 
     /** \brief Calculate the locations of vertices
      *
@@ -106,6 +122,48 @@ namespace mitk
     ConnectomicsNetworkCreator( mitk::Image::Pointer segmentation, mitk::FiberBundle::Pointer fiberBundle );
     ~ConnectomicsNetworkCreator() override;
 
+    /** Order in which labels and connections are hit by a serial pass, 2 * fiber index + fiber end */
+    typedef unsigned long long OccurrenceType;
+    typedef std::pair< itk::Index<3>, itk::Index<3> > ImageIndexPairType;
+
+    /** \brief Labels and connections found by one thread
+    *
+    * Only the first occurrence of a label (with its index) and of a connection is kept, the fiber counts
+    * of a connection are summed up. Connections are stored with the label order of their first occurrence.
+    */
+    struct FiberMappingAccumulator
+    {
+      struct LabelEntry
+      {
+        OccurrenceType first;
+        itk::Index<3> index;
+      };
+
+      struct ConnectionEntry
+      {
+        OccurrenceType first;
+        ImageLabelPairType labels;
+        double fiber_count;
+      };
+
+      void AddLabel( ImageLabelType label, const itk::Index<3>& index, OccurrenceType occurrence );
+      void AddConnection( const ImageLabelPairType& labels, double fiber_count, OccurrenceType occurrence );
+      void Merge( const FiberMappingAccumulator& other );
+
+      std::map< ImageLabelType, LabelEntry > m_Labels;
+      std::map< ImageLabelPairType, ConnectionEntry > m_Connections;
+    };
+
+    /** Resets the network and the label maps */
+    void InitializeNetwork();
+
+    /** Map the fibers of the buffer in parallel, fiber i of the buffer is fiber firstFiber + i of the tractogram */
+    void MapFibers( const FiberPointBuffer& fibers, const std::vector< float >& fiberWeights, OccurrenceType firstFiber,
+      std::vector< FiberMappingAccumulator >& threadMappings );
+
+    /** Merge the mappings of all threads and create the vertices and edges */
+    void BuildNetwork( std::vector< FiberMappingAccumulator >& threadMappings );
+
     /** Add a connection to the network */
     void AddConnectionToNetwork(ConnectionType newConnection, double fiber_count);
 
@@ -116,7 +174,7 @@ namespace mitk
     ConnectionType ReturnAssociatedVertexPairForLabelPair( ImageLabelPairType labelpair );
 
     /** Return the pair of labels which identify the areas connected by a single fiber */
-    ImageLabelPairType ReturnLabelForFiberTract( TractType::Pointer singleTract, MappingStrategy strategy );
+    ImageLabelPairType ReturnLabelForFiberTract( TractType::Pointer singleTract, MappingStrategy strategy, ImageIndexPairType& endIndices );
 
     /** Assign the additional information which should be part of the vertex */
     void SupplyVertexWithInformation( ImageLabelType& label, VertexType& vertex );
@@ -164,25 +222,25 @@ namespace mitk
 
     Map a fiber to a vertex by taking the value of the parcellation image at the same world coordinates as the last
     and first element of the tract.*/
-    ImageLabelPairType EndElementPositionLabel( TractType::Pointer singleTract );
+    ImageLabelPairType EndElementPositionLabel( TractType::Pointer singleTract, ImageIndexPairType& endIndices );
 
     /** Map by distance between elements and vertices depending on their volume
 
     First go through the parcellation and compute the coordinates of the future vertices. Assign a radius according on their volume.
     Then map an edge to a label by considering the nearest vertices and comparing the distance to them to their radii. */
-    ImageLabelPairType PrecomputeVertexLocationsBySegmentation( TractType::Pointer singleTract );
+    ImageLabelPairType PrecomputeVertexLocationsBySegmentation( TractType::Pointer singleTract, ImageIndexPairType& endIndices );
 
         /** Use the position of the end and starting element only to map to labels
 
     Just take first and last position, no labelling, nothing */
-    ImageLabelPairType JustEndPointVerticesNoLabelTest( TractType::Pointer singleTract );
+    ImageLabelPairType JustEndPointVerticesNoLabelTest( TractType::Pointer singleTract, ImageIndexPairType& endIndices );
 
     /** Use the position of the end and starting element unless it is in white matter, then search for nearby parcellation to map to labels
 
     Map a fiber to a vertex by taking the value of the parcellation image at the same world coordinates as the last
     and first element of the tract. If this happens to be white matter, then try to extend the fiber in a line and
     take the first non-white matter parcel, that is intersected. */
-    ImageLabelPairType EndElementPositionLabelAvoidingWhiteMatter( TractType::Pointer singleTract );
+    ImageLabelPairType EndElementPositionLabelAvoidingWhiteMatter( TractType::Pointer singleTract, ImageIndexPairType& endIndices );
 
     ///////// Conversions //////////
     /** Convert fiber index to segmentation index coordinates */
@@ -225,6 +283,9 @@ namespace mitk
     // toggles whether a node with the label 0 may be present
     bool m_ZeroLabelInvalid;
 
+    // number of fibers mapped at once
+    unsigned int m_FiberChunkSize;
+
     // used internally to communicate a connection should not be added if the a problem
     // is encountered while adding it
     bool m_AbortConnection;
@@ -0,0 +1,250 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#include "mitkConnectomicsParallelGraphAlgorithms.h"
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable: 4172)
+#endif
+
+#include <boost/graph/dijkstra_shortest_paths.hpp>
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#include <omp.h>
+
+namespace
+{
+  /** Adjacency array of the undirected graph, neighbors[ offsets[ v ] ... offsets[ v + 1 ] ) are the neighbors of v */
+  struct AdjacencyArray
+  {
+    std::vector< int > offsets;
+    std::vector< int > neighbors;
+    std::vector< int > edges;   ///< index of the connecting edge in boost::edges( graph )
+  };
+
+  void BuildAdjacencyArray( const mitk::ConnectomicsParallelGraphAlgorithms::NetworkType& graph, AdjacencyArray& adjacency )
+  {
+    int numberOfVertices = boost::num_vertices( graph );
+    adjacency.offsets.assign( numberOfVertices + 1, 0 );
+
+    std::vector< std::pair< int, int > > endPoints;
+    endPoints.reserve( boost::num_edges( graph ) );
+    boost::graph_traits< mitk::ConnectomicsParallelGraphAlgorithms::NetworkType >::edge_iterator iterator, end;
+    for ( boost::tie( iterator, end ) = boost::edges( graph ); iterator != end; ++iterator )
+    {
+      int source = boost::source( *iterator, graph );
+      int target = boost::target( *iterator, graph );
+      endPoints.push_back( std::make_pair( source, target ) );
+      adjacency.offsets[ source + 1 ]++;
+      if ( source != target )
+      {
+        adjacency.offsets[ target + 1 ]++;
+      }
+    }
+
+    for ( int vertex( 0 ); vertex < numberOfVertices; vertex++ )
+    {
+      adjacency.offsets[ vertex + 1 ] += adjacency.offsets[ vertex ];
+    }
+
+    adjacency.neighbors.resize( adjacency.offsets.back() );
+    adjacency.edges.resize( adjacency.offsets.back() );
+    std::vector< int > position( adjacency.offsets.begin(), adjacency.offsets.end() - 1 );
+    for ( unsigned int edge( 0 ); edge < endPoints.size(); edge++ )
+    {
+      int source = endPoints[ edge ].first;
+      int target = endPoints[ edge ].second;
+      adjacency.neighbors[ position[ source ] ] = target;
+      adjacency.edges[ position[ source ]++ ] = edge;
+      if ( source != target )
+      {
+        adjacency.neighbors[ position[ target ] ] = source;
+        adjacency.edges[ position[ target ]++ ] = edge;
+      }
+    }
+  }
+}
+
+void mitk::ConnectomicsParallelGraphAlgorithms::ComputeBetweennessCentrality( const NetworkType& graph, std::vector< double >& vertexCentrality, std::vector< double >& edgeCentrality )
+{
+  AdjacencyArray adjacency;
+  BuildAdjacencyArray( graph, adjacency );
+
+  int numberOfVertices = boost::num_vertices( graph );
+  int numberOfEdges = boost::num_edges( graph );
+  int numberOfThreads = omp_get_max_threads();
+
+  std::vector< std::vector< double > > threadVertexCentrality( numberOfThreads, std::vector< double >( numberOfVertices, 0.0 ) );
+  std::vector< std::vector< double > > threadEdgeCentrality( numberOfThreads, std::vector< double >( numberOfEdges, 0.0 ) );
+
+#pragma omp parallel num_threads( numberOfThreads )
+  {
+    std::vector< double >& localVertexCentrality = threadVertexCentrality[ omp_get_thread_num() ];
+    std::vector< double >& localEdgeCentrality = threadEdgeCentrality[ omp_get_thread_num() ];
+
+    // per thread traversal buffers, reset after every source
+    std::vector< int > distance( numberOfVertices, -1 );
+    std::vector< double > pathCount( numberOfVertices, 0.0 );
+    std::vector< double > dependency( numberOfVertices, 0.0 );
+    std::vector< int > order;
+    order.reserve( numberOfVertices );
+
+#pragma omp for schedule( dynamic, 16 )
+    for ( int source = 0; source < numberOfVertices; source++ )
+    {
+      // breadth first search, order holds the vertices by non-decreasing distance
+      order.clear();
+      order.push_back( source );
+      distance[ source ] = 0;
+      pathCount[ source ] = 1.0;
+      for ( unsigned int head( 0 ); head < order.size(); head++ )
+      {
+        int vertex = order[ head ];
+        for ( int i = adjacency.offsets[ vertex ]; i < adjacency.offsets[ vertex + 1 ]; i++ )
+        {
+          int neighbor = adjacency.neighbors[ i ];
+          if ( distance[ neighbor ] < 0 )
+          {
+            distance[ neighbor ] = distance[ vertex ] + 1;
+            order.push_back( neighbor );
+          }
+          if ( distance[ neighbor ] == distance[ vertex ] + 1 )
+          {
+            pathCount[ neighbor ] += pathCount[ vertex ];
+          }
+        }
+      }
+
+      // accumulate the dependencies in reverse order, the predecessors of a vertex are its neighbors one hop closer
+      for ( int head = static_cast< int >( order.size() ) - 1; head >= 0; head-- )
+      {
+        int vertex = order[ head ];
+        for ( int i = adjacency.offsets[ vertex ]; i < adjacency.offsets[ vertex + 1 ]; i++ )
+        {
+          int predecessor = adjacency.neighbors[ i ];
+          if ( distance[ predecessor ] == distance[ vertex ] - 1 )
+          {
+            double contribution = pathCount[ predecessor ] / pathCount[ vertex ] * ( 1.0 + dependency[ vertex ] );
+            localEdgeCentrality[ adjacency.edges[ i ] ] += contribution;
+            dependency[ predecessor ] += contribution;
+          }
+        }
+        if ( vertex != source )
+        {
+          localVertexCentrality[ vertex ] += dependency[ vertex ];
+        }
+      }
+
+      for ( unsigned int head( 0 ); head < order.size(); head++ )
+      {
+        int vertex = order[ head ];
+        distance[ vertex ] = -1;
+        pathCount[ vertex ] = 0.0;
+        dependency[ vertex ] = 0.0;
+      }
+    }
+  }
+
+  // every pair has been counted in both directions
+  vertexCentrality.assign( numberOfVertices, 0.0 );
+  edgeCentrality.assign( numberOfEdges, 0.0 );
+  for ( int thread( 0 ); thread < numberOfThreads; thread++ )
+  {
+    for ( int vertex( 0 ); vertex < numberOfVertices; vertex++ )
+    {
+      vertexCentrality[ vertex ] += threadVertexCentrality[ thread ][ vertex ] / 2.0;
+    }
+    for ( int edge( 0 ); edge < numberOfEdges; edge++ )
+    {
+      edgeCentrality[ edge ] += threadEdgeCentrality[ thread ][ edge ] / 2.0;
+    }
+  }
+}
+
+void mitk::ConnectomicsParallelGraphAlgorithms::ComputeHopDistanceHistograms( const NetworkType& graph, std::vector< std::vector< int > >& histograms )
+{
+  AdjacencyArray adjacency;
+  BuildAdjacencyArray( graph, adjacency );
+
+  int numberOfVertices = boost::num_vertices( graph );
+  histograms.clear();
+  histograms.resize( numberOfVertices );
+
+#pragma omp parallel
+  {
+    std::vector< int > distance( numberOfVertices, -1 );
+    std::vector< int > order;
+    order.reserve( numberOfVertices );
+
+#pragma omp for schedule( dynamic, 16 )
+    for ( int source = 0; source < numberOfVertices; source++ )
+    {
+      order.clear();
+      order.push_back( source );
+      distance[ source ] = 0;
+      for ( unsigned int head( 0 ); head < order.size(); head++ )
+      {
+        int vertex = order[ head ];
+        for ( int i = adjacency.offsets[ vertex ]; i < adjacency.offsets[ vertex + 1 ]; i++ )
+        {
+          int neighbor = adjacency.neighbors[ i ];
+          if ( distance[ neighbor ] < 0 )
+          {
+            distance[ neighbor ] = distance[ vertex ] + 1;
+            order.push_back( neighbor );
+          }
+        }
+      }
+
+      // the last discovered vertex is the farthest one
+      std::vector< int >& histogram = histograms[ source ];
+      histogram.assign( distance[ order.back() ] + 1, 0 );
+      for ( unsigned int head( 1 ); head < order.size(); head++ )
+      {
+        histogram[ distance[ order[ head ] ] ]++;
+      }
+
+      for ( unsigned int head( 0 ); head < order.size(); head++ )
+      {
+        distance[ order[ head ] ] = -1;
+      }
+    }
+  }
+}
+
+void mitk::ConnectomicsParallelGraphAlgorithms::ComputeShortestPathDistances( const NetworkType& graph, std::vector< std::vector< int > >& distances )
+{
+  int numberOfVertices = boost::num_vertices( graph );
+  distances.resize( numberOfVertices );
+
+#pragma omp parallel
+  {
+    std::vector< mitk::ConnectomicsNetwork::VertexDescriptorType > predecessorMap( numberOfVertices );
+
+#pragma omp for schedule( dynamic, 16 )
+    for ( int source = 0; source < numberOfVertices; source++ )
+    {
+      distances[ source ].resize( numberOfVertices );
+      boost::dijkstra_shortest_paths( graph, boost::vertex( source, graph ),
+        boost::predecessor_map( &predecessorMap[ 0 ] ).distance_map( &distances[ source ][ 0 ] ).weight_map( boost::get( &mitk::ConnectomicsNetwork::NetworkEdge::edge_weight, graph ) ) );
+    }
+  }
+}
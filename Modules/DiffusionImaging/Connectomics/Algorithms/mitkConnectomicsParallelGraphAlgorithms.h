@@ -0,0 +1,70 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#ifndef mitkConnectomicsParallelGraphAlgorithms_h
+#define mitkConnectomicsParallelGraphAlgorithms_h
+
+#include <MitkConnectomicsExports.h>
+
+#include <mitkConnectomicsNetwork.h>
+
+#include <vector>
+
+namespace mitk
+{
+  /**
+  * \brief Path based network measures that run one traversal per source vertex in parallel
+  *
+  * The sources are partitioned across the OpenMP threads, every thread works on its own
+  * traversal buffers and accumulators which are combined after all sources are processed.
+  * The graph itself is only read, it is converted once into an adjacency array so that
+  * the traversals do not have to go through the boost iterators.
+  */
+  class MITKCONNECTOMICS_EXPORT ConnectomicsParallelGraphAlgorithms
+  {
+  public:
+
+    typedef mitk::ConnectomicsNetwork::NetworkType NetworkType;
+
+    /**
+    * \brief Brandes betweenness centrality of the unweighted graph
+    *
+    * Gives the same values as boost::brandes_betweenness_centrality for the undirected network,
+    * i.e. the centralities are halved. The edge centralities are ordered as boost::edges( graph ).
+    */
+    static void ComputeBetweennessCentrality( const NetworkType& graph, std::vector< double >& vertexCentrality, std::vector< double >& edgeCentrality );
+
+    /**
+    * \brief Number of vertices at every hop distance from every source vertex
+    *
+    * histograms[ source ][ h ] is the number of vertices reachable in exactly h hops, the source
+    * itself is not counted (histograms[ source ][ 0 ] is 0). The size of every histogram is the
+    * eccentricity of the source plus one.
+    */
+    static void ComputeHopDistanceHistograms( const NetworkType& graph, std::vector< std::vector< int > >& histograms );
+
+    /**
+    * \brief All pairs shortest paths weighted by NetworkEdge::edge_weight (one Dijkstra run per source)
+    *
+    * Unreachable vertices get std::numeric_limits< int >::max().
+    */
+    static void ComputeShortestPathDistances( const NetworkType& graph, std::vector< std::vector< int > >& distances );
+  };
+
+}// end namespace mitk
+
+#endif // mitkConnectomicsParallelGraphAlgorithms_h
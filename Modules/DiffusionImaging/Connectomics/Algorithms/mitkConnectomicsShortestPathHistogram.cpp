@@ -17,18 +17,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include<mitkConnectomicsShortestPathHistogram.h>
 
-#ifdef _MSC_VER
-# pragma warning(push)
-# pragma warning(disable: 4172)
-#endif
-
-#include <boost/graph/dijkstra_shortest_paths.hpp>
-
-#ifdef _MSC_VER
-# pragma warning(pop)
-#endif
-
 #include "mitkConnectomicsConstantsManager.h"
+#include "mitkConnectomicsParallelGraphAlgorithms.h"
 
 mitk::ConnectomicsShortestPathHistogram::ConnectomicsShortestPathHistogram()
 : m_Mode( UnweightedUndirectedMode )
@@ -75,22 +65,8 @@ void mitk::ConnectomicsShortestPathHistogram::ComputeFromConnectomicsNetwork( Co
 
 void mitk::ConnectomicsShortestPathHistogram::CalculateUnweightedUndirectedShortestPaths( NetworkType* boostGraph )
 {
-  std::vector< DescriptorType > predecessorMap( boost::num_vertices( *boostGraph ) );
-  int numberOfNodes( boost::num_vertices( *boostGraph ) );
-
-  m_DistanceMatrix.resize( numberOfNodes );
-  for(unsigned int index(0); index < m_DistanceMatrix.size(); index++ )
-  {
-    m_DistanceMatrix[ index ].resize( numberOfNodes );
-  }
-
-  IteratorType iterator, end;
-  boost::tie(iterator, end) = boost::vertices( *boostGraph );
-
-  for ( int index(0) ; iterator != end; ++iterator, index++)
-  {
-          boost::dijkstra_shortest_paths(*boostGraph, *iterator, boost::predecessor_map(&predecessorMap[ 0 ]).distance_map(&m_DistanceMatrix[ index ][ 0 ]).weight_map( boost::get( &mitk::ConnectomicsNetwork::NetworkEdge::edge_weight ,*boostGraph ) ) ) ;
-  }
+  // one Dijkstra run per source vertex, the sources are distributed over the threads
+  mitk::ConnectomicsParallelGraphAlgorithms::ComputeShortestPathDistances( *boostGraph, m_DistanceMatrix );
 }
 
 void mitk::ConnectomicsShortestPathHistogram::CalculateWeightedUndirectedShortestPaths( NetworkType* /*boostGraph*/ )
@@ -27,10 +27,15 @@ mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity::~ConnectomicsSimulat
 double mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity::Evaluate( mitk::ConnectomicsNetwork::Pointer network, ToModuleMapType* vertexToModuleMap ) const
 {
   double cost( 0.0 );
-  cost = 100.0 * ( 1.0 - CalculateModularity( network, vertexToModuleMap ) );
+  cost = ModularityToCost( CalculateModularity( network, vertexToModuleMap ) );
   return cost;
 }
 
+double mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity::ModularityToCost( double modularity ) const
+{
+  return 100.0 * ( 1.0 - modularity );
+}
+
 double mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity::CalculateModularity( mitk::ConnectomicsNetwork::Pointer network, ToModuleMapType* vertexToModuleMap ) const
 {
   double modularity( 0.0 );
@@ -77,11 +82,26 @@ double mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity::CalculateModu
     return 0;
   }
 
-  for( int index( 0 ); index < numberOfModules ; index++)
+  for( int moduleID( 0 ); moduleID < numberOfModules; moduleID++ )
+  {
+    modularity += CalculateModuleContribution( numberOfLinksInModule[ moduleID ], sumOfDegreesInModule[ moduleID ], numberOfLinksInNetwork );
+  }
+
+  return modularity;
+}
+
+double mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity::CalculateModuleContribution(
+  int linkEndsInModule, int sumOfDegreesInModule, int numberOfLinksInNetwork ) const
+{
+  // if the network contains no links return 0
+  if( numberOfLinksInNetwork < 1)
   {
-    numberOfLinksInModule[ index ] = numberOfLinksInModule[ index ] / 2;
+    return 0;
   }
 
+  // the number of links has to be halved, as each link was counted at both ends
+  int numberOfLinksInModule = linkEndsInModule / 2;
+
   //Calculate modularity M:
   //M = sum_{s=1}^{N_{M}} [ (l_{s} / L) - (d_{s} / ( 2L ))^2 ]
   //where N_{M} is the number of modules
@@ -93,16 +113,11 @@ double mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity::CalculateModu
   // Cartography of complex networks: modules and universal roles
   // Journal of Statistical Mechanics: Theory and Experiment, 2005, 2005, P02001 )
 
-  for( int moduleID( 0 ); moduleID < numberOfModules; moduleID++ )
-  {
-    modularity += (((double) numberOfLinksInModule[ moduleID ]) / ((double) numberOfLinksInNetwork)) -
-      (
-      (((double) sumOfDegreesInModule[ moduleID ]) / ((double) 2 * numberOfLinksInNetwork) ) *
-      (((double) sumOfDegreesInModule[ moduleID ]) / ((double) 2 * numberOfLinksInNetwork) )
-      );
-  }
-
-  return modularity;
+  return (((double) numberOfLinksInModule) / ((double) numberOfLinksInNetwork)) -
+    (
+    (((double) sumOfDegreesInModule) / ((double) 2 * numberOfLinksInNetwork) ) *
+    (((double) sumOfDegreesInModule) / ((double) 2 * numberOfLinksInNetwork) )
+    );
 }
 
 int mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity::getNumberOfModules(
@@ -46,6 +46,13 @@ namespace mitk
     // Will calculate and return the modularity of the network
     double CalculateModularity( mitk::ConnectomicsNetwork::Pointer network, ToModuleMapType *vertexToModuleMap  ) const;
 
+    // Contribution of a single module to the modularity, links inside the module are counted at both ends
+    // as they appear in the adjacency lists, the modularity is the sum over all modules
+    double CalculateModuleContribution( int linkEndsInModule, int sumOfDegreesInModule, int numberOfLinksInNetwork ) const;
+
+    // The cost belonging to a given modularity, as returned by Evaluate
+    double ModularityToCost( double modularity ) const;
+
 
   protected:
 
@@ -20,8 +20,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vnl/vnl_random.h"
 #include "vnl/vnl_math.h"
 
+#include <omp.h>
+
 mitk::ConnectomicsSimulatedAnnealingManager::ConnectomicsSimulatedAnnealingManager()
 : m_Permutation( nullptr )
+, m_NumberOfChains( 1 )
 {
 }
 
@@ -76,8 +79,63 @@ void mitk::ConnectomicsSimulatedAnnealingManager::RunSimulatedAnnealing(
     return;
   }
 
+  std::vector< mitk::ConnectomicsSimulatedAnnealingPermutationBase::Pointer > chains;
+  chains.push_back( m_Permutation );
+  for( unsigned int chain( 1 ); chain < m_NumberOfChains; chain++ )
+  {
+    mitk::ConnectomicsSimulatedAnnealingPermutationBase::Pointer newChain = m_Permutation->CreateChain();
+    if( newChain.IsNull() )
+    {
+      MBI_WARN << "Permutation does not support multiple chains, running a single one.";
+      chains.resize( 1 );
+      break;
+    }
+    chains.push_back( newChain );
+  }
+
+  if( chains.size() == 1 )
+  {
+    RunChain( m_Permutation, temperature, stepSize );
+    return;
+  }
+
+  // every chain gets its own random sequence
+  for( unsigned int chain( 0 ); chain < chains.size(); chain++ )
+  {
+    chains[ chain ]->SetSeed( (unsigned int) rand() );
+  }
+
+  const int numberOfChains = chains.size();
+#pragma omp parallel for schedule(dynamic, 1)
+  for( int chain = 0; chain < numberOfChains; chain++ )
+  {
+    RunChain( chains[ chain ], temperature, stepSize );
+  }
+
+  // keep the best solution in the permutation that was set
+  int bestChain( 0 );
+  for( int chain( 1 ); chain < numberOfChains; chain++ )
+  {
+    if( chains[ chain ]->GetCost() < chains[ bestChain ]->GetCost() )
+    {
+      bestChain = chain;
+    }
+  }
+
+  if( bestChain != 0 )
+  {
+    m_Permutation->TakeSolution( chains[ bestChain ] );
+  }
+}
+
+void mitk::ConnectomicsSimulatedAnnealingManager::RunChain(
+  mitk::ConnectomicsSimulatedAnnealingPermutationBase* permutation,
+  double temperature,
+  double stepSize
+  )
+{
   // Initialize the associated permutation
-  m_Permutation->Initialize();
+  permutation->Initialize();
 
 
   for( double currentTemperature( temperature );
@@ -85,11 +143,11 @@ void mitk::ConnectomicsSimulatedAnnealingManager::RunSimulatedAnnealing(
     currentTemperature = currentTemperature / stepSize )
   {
     // Run Permutations at the current temperature
-    m_Permutation->Permutate( currentTemperature );
+    permutation->Permutate( currentTemperature );
 
   }
 
   // Clean up result
-  m_Permutation->CleanUp();
+  permutation->CleanUp();
 
 }
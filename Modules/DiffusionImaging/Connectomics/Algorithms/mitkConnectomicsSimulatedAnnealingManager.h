@@ -51,16 +51,26 @@ namespace mitk
     // Set the permutation to be used
     void SetPermutation( mitk::ConnectomicsSimulatedAnnealingPermutationBase::Pointer permutation );
 
+    // Number of independent annealing chains run in parallel, the best solution is kept in the permutation
+    itkSetMacro( NumberOfChains, unsigned int );
+    itkGetMacro( NumberOfChains, unsigned int );
+
   protected:
 
     //////////////////// Functions ///////////////////////
     ConnectomicsSimulatedAnnealingManager();
     ~ConnectomicsSimulatedAnnealingManager() override;
 
+    // Run a single annealing chain on the given permutation
+    void RunChain( mitk::ConnectomicsSimulatedAnnealingPermutationBase* permutation, double temperature, double stepSize );
+
     /////////////////////// Variables ////////////////////////
     // The permutation assigned to the simulated annealing manager
     mitk::ConnectomicsSimulatedAnnealingPermutationBase::Pointer m_Permutation;
 
+    // Number of chains run in parallel
+    unsigned int m_NumberOfChains;
+
   };
 
 }// end namespace mitk
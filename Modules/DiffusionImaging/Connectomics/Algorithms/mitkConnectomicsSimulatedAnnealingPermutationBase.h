@@ -58,6 +58,19 @@ namespace mitk
     // Do clean up necessary after a permutation
     virtual void CleanUp(){};
 
+    // Create a permutation with the same settings but a state of its own, used to run several
+    // annealing chains in parallel. Returns nullptr if the permutation does not support this.
+    virtual ConnectomicsSimulatedAnnealingPermutationBase::Pointer CreateChain() const { return nullptr; };
+
+    // The cost of the current solution
+    virtual double GetCost() const { return 0.0; };
+
+    // Take over the solution of another chain
+    virtual void TakeSolution( ConnectomicsSimulatedAnnealingPermutationBase* /*chain*/ ){};
+
+    // Seed the random number generation of the permutation
+    virtual void SetSeed( unsigned int /*seed*/ ){};
+
   protected:
 
     //////////////////// Functions ///////////////////////
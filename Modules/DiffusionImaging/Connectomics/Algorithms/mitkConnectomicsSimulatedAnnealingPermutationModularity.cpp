@@ -18,11 +18,16 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkConnectomicsSimulatedAnnealingCostFunctionModularity.h"
 #include "mitkConnectomicsSimulatedAnnealingManager.h"
 
+#include <algorithm>
+
 //for random number generation
-#include "vnl/vnl_random.h"
 #include "vnl/vnl_math.h"
 
 mitk::ConnectomicsSimulatedAnnealingPermutationModularity::ConnectomicsSimulatedAnnealingPermutationModularity()
+: m_Depth( 0 )
+, m_StepSize( 0.0 )
+, m_NumberOfLinks( 0 )
+, m_RandomGenerator( (unsigned long) rand() )
 {
 }
 
@@ -38,6 +43,8 @@ void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::SetNetwork(
 
 void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::Initialize()
 {
+  BuildAdjacency();
+
   // create entry for every vertex
   std::vector< VertexDescriptorType > vertexVector = m_Network->GetVectorOfAllVertexDescriptors();
   const int vectorSize = vertexVector.size();
@@ -55,40 +62,56 @@ void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::Initialize()
 
 void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::Permutate( double temperature )
 {
+  if( m_Vertices.size() != m_BestSolution.size() )
+  {
+    BuildAdjacency();
+  }
 
-  ToModuleMapType currentSolution = m_BestSolution;
-  ToModuleMapType currentBestSolution = m_BestSolution;
+  // The current solution keeps being permutated, whether a change is accepted or not. Instead of copying
+  // it on every accepted change, the changes since then are logged and undone at the end.
+  ModuleAssignment currentSolution;
+  MappingToAssignment( m_BestSolution, currentSolution, nullptr );
+  ChangeLogType changesSinceBestSolution;
 
   int factor = 1;
   int numberOfVertices = m_BestSolution.size();
   int singleNodeMaxNumber = factor * numberOfVertices * numberOfVertices;
   int moduleMaxNumber = factor  * numberOfVertices;
-  double currentBestCost = Evaluate( &currentBestSolution );
+  double currentBestCost = Evaluate( currentSolution );
 
   // do singleNodeMaxNumber node permutations and evaluate
   for(int loop( 0 ); loop < singleNodeMaxNumber; loop++)
   {
-    permutateMappingSingleNodeShift( &currentSolution, m_Network );
-    if( AcceptChange( currentBestCost, Evaluate( &currentSolution ), temperature ) )
+    permutateMappingSingleNodeShift( currentSolution, &changesSinceBestSolution );
+    double currentCost = Evaluate( currentSolution );
+    if( AcceptChange( currentBestCost, currentCost, temperature ) )
     {
-      currentBestSolution = currentSolution;
-      currentBestCost = Evaluate( &currentBestSolution );
+      changesSinceBestSolution.clear();
+      currentBestCost = currentCost;
     }
   }
 
   // do moduleMaxNumber module permutations
+  ToModuleMapType currentMapping;
   for(int loop( 0 ); loop < moduleMaxNumber; loop++)
   {
-    permutateMappingModuleChange( &currentSolution, temperature, m_Network );
-    if( AcceptChange( currentBestCost, Evaluate( &currentSolution ), temperature ) )
+    AssignmentToMapping( currentSolution, currentMapping );
+    permutateMappingModuleChange( &currentMapping, temperature, m_Network );
+    MappingToAssignment( currentMapping, currentSolution, &changesSinceBestSolution );
+    double currentCost = Evaluate( currentSolution );
+    if( AcceptChange( currentBestCost, currentCost, temperature ) )
     {
-      currentBestSolution = currentSolution;
-      currentBestCost = Evaluate( &currentBestSolution );
+      changesSinceBestSolution.clear();
+      currentBestCost = currentCost;
     }
   }
 
   // store the best solution after the run
-  m_BestSolution = currentBestSolution;
+  for( int change = (int)changesSinceBestSolution.size() - 1; change >= 0; change-- )
+  {
+    currentSolution.modules[ changesSinceBestSolution[ change ].first ] = changesSinceBestSolution[ change ].second;
+  }
+  AssignmentToMapping( currentSolution, m_BestSolution );
 }
 
 void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::CleanUp()
@@ -103,19 +126,237 @@ void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::CleanUp()
   }
 }
 
-void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::permutateMappingSingleNodeShift(
-  ToModuleMapType *vertexToModuleMap, mitk::ConnectomicsNetwork::Pointer network )
+mitk::ConnectomicsSimulatedAnnealingPermutationBase::Pointer mitk::ConnectomicsSimulatedAnnealingPermutationModularity::CreateChain() const
 {
+  mitk::ConnectomicsSimulatedAnnealingPermutationModularity::Pointer chain = mitk::ConnectomicsSimulatedAnnealingPermutationModularity::New();
+  chain->SetCostFunction( m_CostFunction );
+  chain->SetNetwork( m_Network );
+  chain->SetDepth( m_Depth );
+  chain->SetStepSize( m_StepSize );
+  return chain.GetPointer();
+}
 
-  const int nodeCount = vertexToModuleMap->size();
-  const int moduleCount = getNumberOfModules( vertexToModuleMap );
+double mitk::ConnectomicsSimulatedAnnealingPermutationModularity::GetCost() const
+{
+  ToModuleMapType solution = m_BestSolution;
+  return Evaluate( &solution );
+}
 
-  // the random number generators
-  vnl_random rng( (unsigned int) rand() );
-  unsigned long randomNode = rng.lrand32( nodeCount - 1 );
-  // move the node either to any existing module, or to its own
-  //unsigned long randomModule = rng.lrand32( moduleCount );
-  unsigned long randomModule = rng.lrand32( moduleCount - 1 );
+void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::TakeSolution( mitk::ConnectomicsSimulatedAnnealingPermutationBase* chain )
+{
+  mitk::ConnectomicsSimulatedAnnealingPermutationModularity* modularityChain =
+    dynamic_cast<mitk::ConnectomicsSimulatedAnnealingPermutationModularity*>( chain );
+  if( modularityChain )
+  {
+    SetMapping( modularityChain->GetMapping() );
+  }
+}
+
+void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::SetSeed( unsigned int seed )
+{
+  m_RandomGenerator.reseed( seed );
+}
+
+void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::BuildAdjacency()
+{
+  m_Vertices = m_Network->GetVectorOfAllVertexDescriptors();
+
+  std::map< VertexDescriptorType, int > vertexToIndexMap;
+  for( unsigned int index( 0 ); index < m_Vertices.size(); index++ )
+  {
+    vertexToIndexMap.insert( std::pair< VertexDescriptorType, int >( m_Vertices[ index ], index ) );
+  }
+
+  m_AdjacencyOffsets.assign( 1, 0 );
+  m_Adjacency.clear();
+  for( unsigned int index( 0 ); index < m_Vertices.size(); index++ )
+  {
+    const std::vector< VertexDescriptorType > adjacentNodexVector
+      = m_Network->GetVectorOfAdjacentNodes( m_Vertices[ index ] );
+    for( unsigned int adjacentNodeNumber( 0 ); adjacentNodeNumber < adjacentNodexVector.size() ; adjacentNodeNumber++)
+    {
+      m_Adjacency.push_back( vertexToIndexMap.find( adjacentNodexVector[ adjacentNodeNumber ] )->second );
+    }
+    m_AdjacencyOffsets.push_back( m_Adjacency.size() );
+  }
+
+  // each link is listed at both ends
+  m_NumberOfLinks = m_Adjacency.size() / 2;
+}
+
+void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::MappingToAssignment(
+  const ToModuleMapType& mapping, ModuleAssignment& assignment, ChangeLogType* log ) const
+{
+  assignment.modules.resize( m_Vertices.size(), 0 );
+  for( unsigned int index( 0 ); index < m_Vertices.size(); index++ )
+  {
+    auto iter = mapping.find( m_Vertices[ index ] );
+    int module = ( iter != mapping.end() ) ? iter->second : 0;
+    if( log && assignment.modules[ index ] != module )
+    {
+      log->push_back( std::pair< int, int >( index, assignment.modules[ index ] ) );
+    }
+    assignment.modules[ index ] = module;
+  }
+
+  UpdateModuleSums( assignment );
+}
+
+void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::AssignmentToMapping(
+  const ModuleAssignment& assignment, ToModuleMapType& mapping ) const
+{
+  mapping.clear();
+  for( unsigned int index( 0 ); index < m_Vertices.size(); index++ )
+  {
+    mapping.insert( mapping.end(), std::pair< VertexDescriptorType, int >( m_Vertices[ index ], assignment.modules[ index ] ) );
+  }
+}
+
+void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::UpdateModuleSums( ModuleAssignment& assignment ) const
+{
+  int maxModule( 0 );
+  for( unsigned int index( 0 ); index < assignment.modules.size(); index++ )
+  {
+    maxModule = std::max( maxModule, assignment.modules[ index ] );
+  }
+
+  assignment.linkEndsInModule.assign( maxModule + 1, 0 );
+  assignment.sumOfDegreesInModule.assign( maxModule + 1, 0 );
+  assignment.numberOfVerticesInModule.assign( maxModule + 1, 0 );
+
+  for( unsigned int index( 0 ); index < assignment.modules.size(); index++ )
+  {
+    const int module = assignment.modules[ index ];
+    assignment.numberOfVerticesInModule[ module ]++;
+    assignment.sumOfDegreesInModule[ module ] += m_AdjacencyOffsets[ index + 1 ] - m_AdjacencyOffsets[ index ];
+    for( int adjacent( m_AdjacencyOffsets[ index ] ); adjacent < m_AdjacencyOffsets[ index + 1 ]; adjacent++ )
+    {
+      if( assignment.modules[ m_Adjacency[ adjacent ] ] == module )
+      {
+        assignment.linkEndsInModule[ module ]++;
+      }
+    }
+  }
+
+  assignment.modularity = 0.0;
+  mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity* costMapping =
+    dynamic_cast<mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity*>( m_CostFunction.GetPointer() );
+  if( costMapping )
+  {
+    for( int module( 0 ); module <= maxModule; module++ )
+    {
+      assignment.modularity += costMapping->CalculateModuleContribution(
+        assignment.linkEndsInModule[ module ], assignment.sumOfDegreesInModule[ module ], m_NumberOfLinks );
+    }
+  }
+}
+
+void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::MoveVertex(
+  ModuleAssignment& assignment, int vertex, int module, ChangeLogType* log ) const
+{
+  const int previousModule = assignment.modules[ vertex ];
+  if( previousModule == module )
+  {
+    return;
+  }
+
+  if( log )
+  {
+    log->push_back( std::pair< int, int >( vertex, previousModule ) );
+  }
+
+  if( module >= (int)assignment.linkEndsInModule.size() )
+  {
+    assignment.linkEndsInModule.resize( module + 1, 0 );
+    assignment.sumOfDegreesInModule.resize( module + 1, 0 );
+    assignment.numberOfVerticesInModule.resize( module + 1, 0 );
+  }
+
+  // only the links of the moved vertex change the sums of the two modules
+  int linksToPreviousModule( 0 ), linksToModule( 0 ), selfLinks( 0 );
+  for( int adjacent( m_AdjacencyOffsets[ vertex ] ); adjacent < m_AdjacencyOffsets[ vertex + 1 ]; adjacent++ )
+  {
+    const int adjacentVertex = m_Adjacency[ adjacent ];
+    if( adjacentVertex == vertex )
+    {
+      selfLinks++;
+    }
+    else if( assignment.modules[ adjacentVertex ] == previousModule )
+    {
+      linksToPreviousModule++;
+    }
+    else if( assignment.modules[ adjacentVertex ] == module )
+    {
+      linksToModule++;
+    }
+  }
+  const int degree = m_AdjacencyOffsets[ vertex + 1 ] - m_AdjacencyOffsets[ vertex ];
+
+  mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity* costMapping =
+    dynamic_cast<mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity*>( m_CostFunction.GetPointer() );
+  if( costMapping )
+  {
+    assignment.modularity -=
+      costMapping->CalculateModuleContribution( assignment.linkEndsInModule[ previousModule ], assignment.sumOfDegreesInModule[ previousModule ], m_NumberOfLinks )
+      + costMapping->CalculateModuleContribution( assignment.linkEndsInModule[ module ], assignment.sumOfDegreesInModule[ module ], m_NumberOfLinks );
+  }
+
+  // links between the vertex and a module are counted at both ends
+  assignment.linkEndsInModule[ previousModule ] -= 2 * linksToPreviousModule + selfLinks;
+  assignment.linkEndsInModule[ module ] += 2 * linksToModule + selfLinks;
+  assignment.sumOfDegreesInModule[ previousModule ] -= degree;
+  assignment.sumOfDegreesInModule[ module ] += degree;
+  assignment.numberOfVerticesInModule[ previousModule ]--;
+  assignment.numberOfVerticesInModule[ module ]++;
+  assignment.modules[ vertex ] = module;
+
+  if( costMapping )
+  {
+    assignment.modularity +=
+      costMapping->CalculateModuleContribution( assignment.linkEndsInModule[ previousModule ], assignment.sumOfDegreesInModule[ previousModule ], m_NumberOfLinks )
+      + costMapping->CalculateModuleContribution( assignment.linkEndsInModule[ module ], assignment.sumOfDegreesInModule[ module ], m_NumberOfLinks );
+  }
+}
+
+void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::RemoveEmptyModule(
+  ModuleAssignment& assignment, int module, ChangeLogType* log ) const
+{
+  const int lastModuleNumber = assignment.linkEndsInModule.size() - 1;
+  if( assignment.numberOfVerticesInModule[ module ] > 0 )
+  {
+    MBI_WARN << "Trying to remove non-empty module";
+    return;
+  }
+
+  // an empty module does not contribute to the modularity, so only the numbering changes
+  if( module != lastModuleNumber )
+  {
+    for( unsigned int index( 0 ); index < assignment.modules.size(); index++ )
+    {
+      if( assignment.modules[ index ] == lastModuleNumber )
+      {
+        if( log )
+        {
+          log->push_back( std::pair< int, int >( index, lastModuleNumber ) );
+        }
+        assignment.modules[ index ] = module;
+      }
+    }
+    assignment.linkEndsInModule[ module ] = assignment.linkEndsInModule[ lastModuleNumber ];
+    assignment.sumOfDegreesInModule[ module ] = assignment.sumOfDegreesInModule[ lastModuleNumber ];
+    assignment.numberOfVerticesInModule[ module ] = assignment.numberOfVerticesInModule[ lastModuleNumber ];
+  }
+
+  assignment.linkEndsInModule.pop_back();
+  assignment.sumOfDegreesInModule.pop_back();
+  assignment.numberOfVerticesInModule.pop_back();
+}
+
+void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::permutateMappingSingleNodeShift(
+  ModuleAssignment& assignment, ChangeLogType* log )
+{
+  const int nodeCount = assignment.modules.size();
+  const int moduleCount = assignment.linkEndsInModule.size();
 
   // do some sanity checks
 
@@ -125,11 +366,12 @@ void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::permutateMapping
     return;
   }
 
-  const std::vector< VertexDescriptorType > allNodesVector
-    = network->GetVectorOfAllVertexDescriptors();
+  unsigned long randomNode = m_RandomGenerator.lrand32( nodeCount - 1 );
+  // move the node either to any existing module, or to its own
+  //unsigned long randomModule = m_RandomGenerator.lrand32( moduleCount );
+  unsigned long randomModule = m_RandomGenerator.lrand32( moduleCount - 1 );
 
-  auto iter = vertexToModuleMap->find( allNodesVector[ randomNode ] );
-  const int previousModuleNumber = iter->second;
+  const int previousModuleNumber = assignment.modules[ randomNode ];
 
   // if we move the node to its own module, do nothing
   if( previousModuleNumber == (long)randomModule )
@@ -137,22 +379,19 @@ void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::permutateMapping
     return;
   }
 
-  iter->second = randomModule;
+  MoveVertex( assignment, randomNode, randomModule, log );
 
-  if( getNumberOfVerticesInModule( vertexToModuleMap, previousModuleNumber ) < 1 )
+  if( assignment.numberOfVerticesInModule[ previousModuleNumber ] < 1 )
   {
-    removeModule( vertexToModuleMap, previousModuleNumber );
+    RemoveEmptyModule( assignment, previousModuleNumber, log );
   }
 }
 
 void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::permutateMappingModuleChange(
   ToModuleMapType *vertexToModuleMap, double currentTemperature, mitk::ConnectomicsNetwork::Pointer network )
 {
-  //the random number generators
-  vnl_random rng( (unsigned int) rand() );
-
   //randomly generate threshold
-  const double threshold = rng.drand64( 0.0 , 1.0);
+  const double threshold = m_RandomGenerator.drand64( 0.0 , 1.0);
 
   //for deciding whether to join two modules or split one
   double splitThreshold = 0.5;
@@ -162,10 +401,10 @@ void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::permutateMapping
 
   //select random module
   int numberOfModules = getNumberOfModules( vertexToModuleMap );
-  unsigned long randomModuleA = rng.lrand32( numberOfModules - 1 );
+  unsigned long randomModuleA = m_RandomGenerator.lrand32( numberOfModules - 1 );
 
   //select the second module to join, if joining
-  unsigned long randomModuleB = rng.lrand32( numberOfModules - 1 );
+  unsigned long randomModuleB = m_RandomGenerator.lrand32( numberOfModules - 1 );
 
   if( ( threshold < splitThreshold ) && ( randomModuleA != randomModuleB )  )
   {
@@ -249,6 +488,7 @@ void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::splitModule(
     permutation->SetNetwork( subNetwork );
     permutation->SetDepth( m_Depth - 1 );
     permutation->SetStepSize( m_StepSize * 2 );
+    permutation->SetSeed( m_RandomGenerator.lrand32() );
 
     manager->SetPermutation( permutation.GetPointer() );
 
@@ -433,9 +673,6 @@ void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::randomlyAssignNo
     numberOfIntendedModules = vertexToModuleMap->size();
   }
 
-  //the random number generators
-  vnl_random rng( (unsigned int) rand() );
-
   std::vector< int > histogram;
   std::vector< int > nodeList;
 
@@ -448,7 +685,7 @@ void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::randomlyAssignNo
   for( unsigned int nodeIndex( 0 ); nodeIndex < nodeList.size(); nodeIndex++ )
   {
     //select random module
-    nodeList[ nodeIndex ] = rng.lrand32( numberOfIntendedModules - 1 );
+    nodeList[ nodeIndex ] = m_RandomGenerator.lrand32( numberOfIntendedModules - 1 );
 
     histogram[ nodeList[ nodeIndex ] ]++;
 
@@ -460,7 +697,7 @@ void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::randomlyAssignNo
   {
     while( histogram[ moduleIndex ] == 0 )
     {
-      int randomNodeIndex = rng.lrand32( numberOfVertices - 1 );
+      int randomNodeIndex = m_RandomGenerator.lrand32( numberOfVertices - 1 );
       if( histogram[ nodeList[ randomNodeIndex ] ] > 1 )
       {
         histogram[ moduleIndex ]++;
@@ -490,6 +727,20 @@ mitk::ConnectomicsSimulatedAnnealingPermutationModularity::GetMapping()
   return m_BestSolution;
 }
 
+double mitk::ConnectomicsSimulatedAnnealingPermutationModularity::Evaluate( const ModuleAssignment& assignment ) const
+{
+  mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity* costMapping =
+    dynamic_cast<mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity*>( m_CostFunction.GetPointer() );
+  if( costMapping )
+  {
+    return costMapping->ModularityToCost( assignment.modularity );
+  }
+  else
+  {
+    return 0;
+  }
+}
+
 double mitk::ConnectomicsSimulatedAnnealingPermutationModularity::Evaluate( ToModuleMapType* mapping ) const
 {
   mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity* costMapping =
@@ -511,11 +762,8 @@ bool mitk::ConnectomicsSimulatedAnnealingPermutationModularity::AcceptChange( do
     return true;
   }
 
-  //the random number generators
-  vnl_random rng( (unsigned int) rand() );
-
   //randomly generate threshold
-  const double threshold = rng.drand64( 0.0 , 1.0);
+  const double threshold = m_RandomGenerator.drand64( 0.0 , 1.0);
 
   //the likelihood of acceptance
   double likelihood = std::exp( - ( costAfter - costBefore ) / temperature );
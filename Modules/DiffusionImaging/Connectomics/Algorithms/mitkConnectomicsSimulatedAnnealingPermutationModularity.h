@@ -21,10 +21,15 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkConnectomicsNetwork.h"
 
+#include "vnl/vnl_random.h"
+
 namespace mitk
 {
   /**
-  * \brief A class providing permutations for the calculation of modularity using simulated annealing */
+  * \brief A class providing permutations for the calculation of modularity using simulated annealing
+  *
+  * Single node shifts are evaluated incrementally: the permutation keeps the link and degree sums of every
+  * module, so a shift only costs the degree of the moved node instead of a full modularity calculation. */
   class MITKCONNECTOMICS_EXPORT ConnectomicsSimulatedAnnealingPermutationModularity : public mitk::ConnectomicsSimulatedAnnealingPermutationBase
   {
   public:
@@ -49,6 +54,18 @@ namespace mitk
     // Do clean up necessary after a permutation
     void CleanUp() override;
 
+    // Create a permutation with the same network and settings for an independent chain
+    mitk::ConnectomicsSimulatedAnnealingPermutationBase::Pointer CreateChain() const override;
+
+    // The cost of the current best solution
+    double GetCost() const override;
+
+    // Take over the best solution of another chain
+    void TakeSolution( mitk::ConnectomicsSimulatedAnnealingPermutationBase* chain ) override;
+
+    // Seed the random number generation
+    void SetSeed( unsigned int seed ) override;
+
     // set the network permutation is to be run upon
     void SetNetwork( mitk::ConnectomicsNetwork::Pointer theNetwork );
 
@@ -76,10 +93,38 @@ namespace mitk
     ConnectomicsSimulatedAnnealingPermutationModularity();
     ~ConnectomicsSimulatedAnnealingPermutationModularity() override;
 
+    // Vertex to module assignment with the link and degree sums of all modules,
+    // vertices are numbered as in m_Vertices
+    struct ModuleAssignment
+    {
+      std::vector< int > modules;
+      std::vector< int > linkEndsInModule;
+      std::vector< int > sumOfDegreesInModule;
+      std::vector< int > numberOfVerticesInModule;
+      double modularity;
+    };
+
+    // (vertex, previous module) of the changes that were made to an assignment
+    typedef std::vector< std::pair< int, int > > ChangeLogType;
+
+    // Copy the topology of the network to m_Vertices and the adjacency arrays
+    void BuildAdjacency();
+
+    // Convert between mapping and assignment, the sums are recalculated
+    void MappingToAssignment( const ToModuleMapType& mapping, ModuleAssignment& assignment, ChangeLogType* log ) const;
+    void AssignmentToMapping( const ModuleAssignment& assignment, ToModuleMapType& mapping ) const;
+
+    // Recalculate the sums and the modularity of an assignment
+    void UpdateModuleSums( ModuleAssignment& assignment ) const;
+
+    // Move a vertex to another module, updating sums and modularity in O(degree)
+    void MoveVertex( ModuleAssignment& assignment, int vertex, int module, ChangeLogType* log ) const;
+
+    // Renumber the last module to the given empty one
+    void RemoveEmptyModule( ModuleAssignment& assignment, int module, ChangeLogType* log ) const;
+
     // This function moves one single node from a module to another
-        void permutateMappingSingleNodeShift(
-      ToModuleMapType *vertexToModuleMap,
-      mitk::ConnectomicsNetwork::Pointer network );
+    void permutateMappingSingleNodeShift( ModuleAssignment& assignment, ChangeLogType* log );
 
         // This function splits and joins modules
     void permutateMappingModuleChange(
@@ -118,6 +163,7 @@ namespace mitk
 
     // Evaluate mapping using a modularity cost function
     double Evaluate( ToModuleMapType* mapping ) const;
+    double Evaluate( const ModuleAssignment& assignment ) const;
 
     // Whether to accept the permutation
     bool AcceptChange( double costBefore, double costAfter, double temperature ) const;
@@ -133,6 +179,16 @@ namespace mitk
 
     // The step size for recursive configuring of simulated annealing manager
     double m_StepSize;
+
+    // Topology of m_Network, the neighbours of vertex i are
+    // m_Adjacency[ m_AdjacencyOffsets[ i ] ] to m_Adjacency[ m_AdjacencyOffsets[ i + 1 ] - 1 ]
+    std::vector< VertexDescriptorType > m_Vertices;
+    std::vector< int > m_AdjacencyOffsets;
+    std::vector< int > m_Adjacency;
+    int m_NumberOfLinks;
+
+    // Random numbers of this permutation, so that chains can run in parallel
+    mutable vnl_random m_RandomGenerator;
   };
 
 }// end namespace mitk
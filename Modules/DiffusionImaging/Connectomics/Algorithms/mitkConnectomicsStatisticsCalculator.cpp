@@ -16,6 +16,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkConnectomicsStatisticsCalculator.h"
 #include "mitkConnectomicsNetworkConverter.h"
+#include "mitkConnectomicsParallelGraphAlgorithms.h"
 
 #include <numeric>
 
@@ -26,43 +27,13 @@ See LICENSE.txt or http://www.mitk.org for details.
 # pragma warning(disable: 4172)
 #endif
 #include <boost/graph/connected_components.hpp>
-#include <boost/graph/betweenness_centrality.hpp>
 
 #ifdef _MSC_VER
 # pragma warning(pop)
 #endif
 
-#include <boost/graph/visitors.hpp>
-
 #include "vnl/algo/vnl_symmetric_eigensystem.h"
 
-template<typename GraphType>
-class all_pairs_shortest_recorder : public boost::default_bfs_visitor
-{
-public:
-  typedef typename boost::graph_traits<GraphType>::vertex_descriptor VertexType;
-  typedef typename boost::graph_traits<GraphType>::edge_descriptor EdgeType;
-
-  all_pairs_shortest_recorder(int* dist, int &max, unsigned int &size)
-  {
-    d = dist;
-    ecc = &max;
-    component_size = &size;
-  }
-
-  void tree_edge(EdgeType edge, const GraphType& graph) {
-    VertexType u = boost::source(edge, graph);
-    VertexType v = boost::target(edge, graph);
-    d[v] = d[u] + 1;
-    *ecc = d[v];
-    *component_size = *component_size + 1;
-  }
-private:
-  int* d;
-  int* ecc;
-  unsigned int* component_size;
-};
-
 mitk::ConnectomicsStatisticsCalculator::ConnectomicsStatisticsCalculator()
   : m_Network( nullptr )
   , m_NumberOfVertices( 0 )
@@ -138,6 +109,7 @@ void mitk::ConnectomicsStatisticsCalculator::Update()
   CalculateAverageComponentSize();
   CalculateLargestComponentSize();
   CalculateRatioOfNodesInLargestComponent();
+  CalculateHopDistanceHistograms();
   CalculateHopPlotValues();
   CalculateClusteringCoefficients();
   CalculateBetweennessCentrality();
@@ -206,31 +178,21 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateRatioOfNodesInLargestCompo
   m_RatioOfNodesInLargestComponent = (double) m_LargestComponentSize / (double) m_NumberOfVertices ;
 }
 
+void mitk::ConnectomicsStatisticsCalculator::CalculateHopDistanceHistograms()
+{
+  mitk::ConnectomicsParallelGraphAlgorithms::ComputeHopDistanceHistograms( *(m_Network->GetBoostGraph()), m_HopDistanceHistograms );
+}
+
 void mitk::ConnectomicsStatisticsCalculator::CalculateHopPlotValues()
 {
   std::vector<int> bins( m_NumberOfVertices );
-
-  VertexIteratorType vi, vi_end;
   unsigned int index( 0 );
 
-  for( boost::tie( vi, vi_end ) = boost::vertices( *(m_Network->GetBoostGraph()) ); vi != vi_end; ++vi)
+  for( unsigned int src( 0 ); src < m_HopDistanceHistograms.size(); src++ )
   {
-    std::vector<int> distances(m_NumberOfVertices, 0);
-    int max_distance = 0;
-    VertexDescriptorType src = *vi;
-    distances[src] = 0;
-    unsigned int size = 0;
-
-    boost::breadth_first_search(*(m_Network->GetBoostGraph()), src,
-      visitor(all_pairs_shortest_recorder< NetworkType >
-      (&distances[0], max_distance, size)));
-
-    for(index=0; index < distances.size(); index++)
+    for(index=1; index < m_HopDistanceHistograms[ src ].size(); index++)
     {
-      if(distances[index] > 0)
-      {
-        bins[distances[index]]++;
-      }
+      bins[index] += m_HopDistanceHistograms[ src ][ index ];
     }
   }
 
@@ -351,8 +313,9 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateClusteringCoefficients()
 
 void mitk::ConnectomicsStatisticsCalculator::CalculateBetweennessCentrality()
 {
-  // std::map used for convenient initialization
-  EdgeIndexStdMapType stdEdgeIndex;
+  // std::map used for convenient initialization, kept as the property map refers to it
+  EdgeIndexStdMapType& stdEdgeIndex = m_EdgeIndexStdMap;
+  stdEdgeIndex.clear();
   // associative property map needed for iterator property map-wrapper
   EdgeIndexMapType edgeIndex(stdEdgeIndex);
 
@@ -367,20 +330,17 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateBetweennessCentrality()
     stdEdgeIndex.insert(std::pair< EdgeDescriptorType, int >( *iterator, i));
   }
 
-  // Define EdgeCentralityMap
-  m_VectorOfEdgeBetweennessCentralities.resize( m_NumberOfEdges, 0.0);
+  // Define EdgeCentralityMap, the values are ordered as boost::edges
+  mitk::ConnectomicsParallelGraphAlgorithms::ComputeBetweennessCentrality( *(m_Network->GetBoostGraph()),
+    m_VectorOfVertexBetweennessCentralities, m_VectorOfEdgeBetweennessCentralities );
   // Create the external property map
   m_PropertyMapOfEdgeBetweennessCentralities = EdgeIteratorPropertyMapType(m_VectorOfEdgeBetweennessCentralities.begin(), edgeIndex);
 
   // Define VertexCentralityMap
   VertexIndexMapType vertexIndex = get(boost::vertex_index, *(m_Network->GetBoostGraph()) );
-  m_VectorOfVertexBetweennessCentralities.resize( m_NumberOfVertices, 0.0);
   // Create the external property map
   m_PropertyMapOfVertexBetweennessCentralities = VertexIteratorPropertyMapType(m_VectorOfVertexBetweennessCentralities.begin(), vertexIndex);
 
-  boost::brandes_betweenness_centrality( *(m_Network->GetBoostGraph()),
-    m_PropertyMapOfVertexBetweennessCentralities, m_PropertyMapOfEdgeBetweennessCentralities );
-
   m_AverageVertexBetweennessCentrality = std::accumulate(m_VectorOfVertexBetweennessCentralities.begin(),
     m_VectorOfVertexBetweennessCentralities.end(),
     0.0) / (double) m_NumberOfVertices;
@@ -446,25 +406,16 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateShortestPathMetrics()
   unsigned int giant_component_size = 0;
   VertexDescriptorType radius_src(0);
 
-  //Loop over the vertices
+  //Loop over the vertices. The breadth first searches from every vertex have been run in
+  //parallel before, the histogram of a vertex holds the number of vertices reachable in
+  //exactly h hops.
   for( boost::tie(vi, vi_end) = boost::vertices( *(m_Network->GetBoostGraph()) ); vi!=vi_end; ++vi)
   {
-    //We are going to start a BFS, initialize the neccessary
-    //structures for that.  Store the distances of nodes from the
-    //source in distance vector. The maximum distance is stored in
-    //max. The BFS will start from the node that vi is pointing, that
-    //is the src is *vi. We also init the distance of the src node to
-    //itself to 0. size gives the number of nodes discovered during
-    //this BFS.
-    std::vector<int> distances( m_NumberOfVertices );
-    int max_distance = 0;
     VertexDescriptorType src = *vi;
-    distances[src] = 0;
-    unsigned int size = 0;
+    const std::vector <int>& bucket = m_HopDistanceHistograms[ src ];
+    int max_distance = bucket.size() - 1;
+    unsigned int size = std::accumulate( bucket.begin(), bucket.end(), 0 );
 
-    breadth_first_search(*(m_Network->GetBoostGraph()), src,
-      visitor(all_pairs_shortest_recorder<NetworkType>
-      (&distances[0], max_distance, size)));
     // vertex vi has eccentricity equal to max_distance
     m_VectorOfEccentrities[src] = max_distance;
 
@@ -490,27 +441,19 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateShortestPathMetrics()
     }
 
     //Calculate in how many hops we can reach 90 percent of the
-    //nodes. We store the number of hops we can reach in h hops in the
-    //bucket vector. That is bucket[h] gives the number of nodes
-    //reachable in exactly h hops. sum of bucket[i<h] gives the number
-    //of nodes that are reachable in less than h hops. We also
-    //calculate sum of the distances from this node to every single
-    //other node in the graph.
+    //nodes. bucket[h] gives the number of nodes reachable in exactly
+    //h hops. sum of bucket[i<h] gives the number of nodes that are
+    //reachable in less than h hops. We also calculate sum of the
+    //distances from this node to every single other node in the graph.
     int reachable90 = std::ceil((double)size * 0.9);
-    std::vector <int> bucket (max_distance+1);
-    int counter = 0;
-    for(unsigned int i=0; i<distances.size(); i++)
+    m_VectorOfAveragePathLengths[src] = 0.0;
+    for(unsigned int i=1; i<bucket.size(); i++)
     {
-      if(distances[i]>0)
-      {
-        bucket[distances[i]]++;
-        m_VectorOfAveragePathLengths[src] += distances[i];
-        counter ++;
-      }
+      m_VectorOfAveragePathLengths[src] += (double) i * bucket[i];
     }
-    if(counter > 0)
+    if(size > 0)
     {
-      m_VectorOfAveragePathLengths[src] = m_VectorOfAveragePathLengths[src] / counter;
+      m_VectorOfAveragePathLengths[src] = m_VectorOfAveragePathLengths[src] / size;
     }
 
     int eccentricity90 = 0;
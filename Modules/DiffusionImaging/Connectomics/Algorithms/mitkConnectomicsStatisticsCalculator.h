@@ -139,6 +139,9 @@ namespace mitk
 
     void CalculateRatioOfNodesInLargestComponent();
 
+    /** \brief One parallel breadth first search per vertex, shared by the hop plot and the shortest path metrics */
+    void CalculateHopDistanceHistograms();
+
     void CalculateHopPlotValues();
 
     /**
@@ -209,6 +212,8 @@ namespace mitk
     std::vector< unsigned int > m_VectorOfEccentrities;
     std::vector< unsigned int > m_VectorOfEccentrities90;
     std::vector< double > m_VectorOfAveragePathLengths;
+    std::vector< std::vector< int > > m_HopDistanceHistograms;
+    EdgeIndexStdMapType m_EdgeIndexStdMap;
     unsigned int m_Diameter;
     unsigned int m_Diameter90;
     unsigned int m_Radius;
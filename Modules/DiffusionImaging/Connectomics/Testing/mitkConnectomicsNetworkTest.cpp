@@ -519,6 +519,22 @@ int mitkConnectomicsNetworkTest(int, char* [])
 
     bool noInternalThreeModuleModularity( std::abs(-0.3395 - costFunction->CalculateModularity( network, &noInternalLinksThreeModuleSolution )) < eps);
     MITK_TEST_CONDITION_REQUIRED( noInternalThreeModuleModularity, "Expected three module modularity containing no internal links")
+
+    // Test whether parallel chains return a complete solution with a matching cost
+    permutation->SetCostFunction( costFunction.GetPointer() );
+    permutation->SetNetwork( network );
+    permutation->SetDepth( 0 );
+    permutation->SetStepSize( 2.0 );
+    manager->SetPermutation( permutation.GetPointer() );
+    manager->SetNumberOfChains( 3 );
+    manager->RunSimulatedAnnealing( 1.0, 2.0 );
+
+    ToModuleMapType annealedSolution = permutation->GetMapping();
+    bool completeSolution( annealedSolution.size() == vertexInVector.size() );
+    MITK_TEST_CONDITION_REQUIRED( completeSolution, "Expected every vertex to be assigned to a module")
+
+    bool matchingCost( std::abs( permutation->GetCost() - costFunction->Evaluate( network, &annealedSolution ) ) < eps );
+    MITK_TEST_CONDITION_REQUIRED( matchingCost, "Expected cost of the best chain")
   }
   catch (...)
   {
@@ -15,6 +15,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 // std includes
+#include <memory>
 #include <string>
 
 // CTK includes
@@ -22,6 +23,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 // MITK includes
 #include "mitkConnectomicsNetworkCreator.h"
+#include "mitkFiberBundleStreamReader.h"
 #include <mitkCoreObjectFactory.h>
 #include <mitkIOUtil.h>
 
@@ -35,7 +37,7 @@ int main(int argc, char* argv[])
   parser.setContributor("MIC");
 
   parser.setArgumentPrefix("--", "-");
-  parser.addArgument("", "f", mitkCommandLineParser::InputFile, "Input Tractogram", "input tractogram (.fib)", us::Any(), false);
+  parser.addArgument("", "f", mitkCommandLineParser::InputFile, "Input Tractogram", "input tractogram (.fib, .tck and .trk are streamed)", us::Any(), false);
   parser.addArgument("", "p", mitkCommandLineParser::InputFile, "Parcellation", "parcellation image", us::Any(), false);
   parser.addArgument("", "o", mitkCommandLineParser::String, "Output network", "where to save the output (.cnf, .mat)", us::Any(), false);
 
@@ -58,17 +60,27 @@ int main(int argc, char* argv[])
 
   try
   {
-    // load fiber image
-    std::vector<mitk::BaseData::Pointer> fiberInfile = mitk::IOUtil::Load( fiberFilename);
-
-    if( fiberInfile.empty() )
+    // large tractograms are streamed instead of loaded completely
+    std::unique_ptr< mitk::FiberBundleStreamReader > fiberStream = mitk::FiberBundleStreamReader::Create( fiberFilename );
+    mitk::FiberBundle::Pointer fiberBundle;
+    if( fiberStream )
     {
-      std::string errorMessage = "Fiber Image at " + fiberFilename + " could not be read. Aborting.";
-      MITK_ERROR << errorMessage;
-      return EXIT_FAILURE;
+      fiberStream->Open( fiberFilename );
+    }
+    else
+    {
+      // load fiber image
+      std::vector<mitk::BaseData::Pointer> fiberInfile = mitk::IOUtil::Load( fiberFilename);
+
+      if( fiberInfile.empty() )
+      {
+        std::string errorMessage = "Fiber Image at " + fiberFilename + " could not be read. Aborting.";
+        MITK_ERROR << errorMessage;
+        return EXIT_FAILURE;
+      }
+      mitk::BaseData* fiberBaseData = fiberInfile.at(0);
+      fiberBundle = dynamic_cast<mitk::FiberBundle*>( fiberBaseData );
     }
-    mitk::BaseData* fiberBaseData = fiberInfile.at(0);
-    mitk::FiberBundle* fiberBundle = dynamic_cast<mitk::FiberBundle*>( fiberBaseData );
 
     // load parcellation
     std::vector<mitk::BaseData::Pointer> parcellationInFile =
@@ -85,13 +97,20 @@ int main(int argc, char* argv[])
     // do creation
     mitk::ConnectomicsNetworkCreator::Pointer connectomicsNetworkCreator = mitk::ConnectomicsNetworkCreator::New();
     connectomicsNetworkCreator->SetSegmentation( parcellationImage );
-    connectomicsNetworkCreator->SetFiberBundle( fiberBundle );
     if( !noCenterOfMass )
     {
       connectomicsNetworkCreator->CalculateCenterOfMass();
     }
     connectomicsNetworkCreator->SetMappingStrategy(mitk::ConnectomicsNetworkCreator::MappingStrategy::EndElementPosition);
-    connectomicsNetworkCreator->CreateNetworkFromFibersAndSegmentation();
+    if( fiberStream )
+    {
+      connectomicsNetworkCreator->CreateNetworkFromFiberStreamAndSegmentation( fiberStream.get() );
+    }
+    else
+    {
+      connectomicsNetworkCreator->SetFiberBundle( fiberBundle );
+      connectomicsNetworkCreator->CreateNetworkFromFibersAndSegmentation();
+    }
 
 
     mitk::ConnectomicsNetwork::Pointer network = connectomicsNetworkCreator->GetNetwork();
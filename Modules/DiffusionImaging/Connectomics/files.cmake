@@ -31,6 +31,7 @@ set(CPP_FILES
   Algorithms/mitkConnectomicsSimulatedAnnealingCostFunctionBase.cpp
   Algorithms/mitkConnectomicsSimulatedAnnealingCostFunctionModularity.cpp
   Algorithms/mitkConnectomicsStatisticsCalculator.cpp
+  Algorithms/mitkConnectomicsParallelGraphAlgorithms.cpp
   Algorithms/mitkConnectomicsNetworkConverter.cpp
   Algorithms/mitkConnectomicsNetworkThresholder.cpp
   Algorithms/mitkFreeSurferParcellationTranslator.cpp
@@ -71,6 +72,7 @@ set(H_FILES
   Algorithms/mitkConnectomicsSimulatedAnnealingCostFunctionModularity.h
   Algorithms/itkConnectomicsNetworkToConnectivityMatrixImageFilter.h
   Algorithms/mitkConnectomicsStatisticsCalculator.h
+  Algorithms/mitkConnectomicsParallelGraphAlgorithms.h
   Algorithms/mitkConnectomicsNetworkConverter.h
   Algorithms/BrainParcellation/mitkCostFunctionBase.h
   Algorithms/BrainParcellation/mitkRandomParcellationGenerator.h
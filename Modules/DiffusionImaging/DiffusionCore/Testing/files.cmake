@@ -1,6 +1,8 @@
 set(MODULE_TESTS
   mitkNonLocalMeansDenoisingTest.cpp
   mitkDiffusionPropertySerializerTest.cpp
+  mitkShEvaluationTest.cpp
+  mitkMultishellFitFunctorTest.cpp
 )
 
 set(MODULE_CUSTOM_TESTS
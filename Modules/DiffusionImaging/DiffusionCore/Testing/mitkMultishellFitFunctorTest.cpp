@@ -0,0 +1,129 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include "mitkTestFixture.h"
+
+#include <itkADCFitFunctor.h>
+#include <itkKurtosisFitFunctor.h>
+#include <itkBiExpFitFunctor.h>
+
+#include <cmath>
+
+class mitkMultishellFitFunctorTestSuite : public mitk::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(mitkMultishellFitFunctorTestSuite);
+  MITK_TEST(ADCFit_ShouldRecoverSignal);
+  MITK_TEST(KurtosisFit_ShouldRecoverSignal);
+  MITK_TEST(BiExpFit_ShouldRecoverSignal);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  vnl_vector<double> m_BValues;
+  double m_S0;
+  double m_TargetBValue;
+
+  /** one row per direction, one column per shell */
+  template< class ModelFunctionType >
+  vnl_matrix<double> CreateSignal(unsigned int numDirections, ModelFunctionType model)
+  {
+    vnl_matrix<double> signal(numDirections, m_BValues.size());
+    for (unsigned int i=0; i<numDirections; ++i)
+      for (unsigned int j=0; j<m_BValues.size(); ++j)
+        signal(i,j) = model(i, m_BValues[j]);
+    return signal;
+  }
+
+public:
+
+  void setUp() override
+  {
+    m_BValues.set_size(4);
+    m_BValues[0] = 500;
+    m_BValues[1] = 1000;
+    m_BValues[2] = 2000;
+    m_BValues[3] = 3000;
+    m_S0 = 1000;
+    m_TargetBValue = 1500;
+  }
+
+  void tearDown() override
+  {
+    m_BValues.clear();
+  }
+
+  void ADCFit_ShouldRecoverSignal()
+  {
+    auto model = [this](unsigned int i, double b){ return m_S0*std::exp(-b*(0.0005 + 0.0002*i)); };
+    vnl_matrix<double> signal = CreateSignal(5, model);
+
+    itk::ADCFitFunctor::Pointer functor = itk::ADCFitFunctor::New();
+    functor->setListOfBValues(m_BValues);
+    functor->setTargetBValue(m_TargetBValue);
+    vnl_matrix<double> newSignal(5, 2);
+    (*functor)(newSignal, signal, m_S0);
+
+    for (unsigned int i=0; i<5; ++i)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(model(i, m_TargetBValue), newSignal(i,0), 1e-3);
+      CPPUNIT_ASSERT(newSignal(i,1)<1e-3);
+    }
+  }
+
+  void KurtosisFit_ShouldRecoverSignal()
+  {
+    auto model = [this](unsigned int i, double b){
+      const double D = 0.0008 + 0.0001*i;
+      const double K = 0.5 + 0.2*i;
+      return m_S0*std::exp(-b*D + b*b*D*D*K/6.);
+    };
+    vnl_matrix<double> signal = CreateSignal(5, model);
+
+    itk::KurtosisFitFunctor::Pointer functor = itk::KurtosisFitFunctor::New();
+    functor->setListOfBValues(m_BValues);
+    functor->setTargetBValue(m_TargetBValue);
+    vnl_matrix<double> newSignal(5, 2);
+    (*functor)(newSignal, signal, m_S0);
+
+    for (unsigned int i=0; i<5; ++i)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(model(i, m_TargetBValue), newSignal(i,0), 1e-3);
+      CPPUNIT_ASSERT(newSignal(i,1)<1e-3);
+    }
+  }
+
+  void BiExpFit_ShouldRecoverSignal()
+  {
+    auto model = [this](unsigned int i, double b){
+      const double lambda = 0.6 + 0.05*i;
+      return m_S0*(lambda*std::exp(-b*0.0006) + (1-lambda)*std::exp(-b*(0.003 + 0.0005*i)));
+    };
+    vnl_matrix<double> signal = CreateSignal(5, model);
+
+    itk::BiExpFitFunctor::Pointer functor = itk::BiExpFitFunctor::New();
+    functor->setListOfBValues(m_BValues);
+    functor->setTargetBValue(m_TargetBValue);
+    vnl_matrix<double> newSignal(5, 2);
+    (*functor)(newSignal, signal, m_S0);
+
+    for (unsigned int i=0; i<5; ++i)
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(model(i, m_TargetBValue), newSignal(i,0), 1e-2);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkMultishellFitFunctor)
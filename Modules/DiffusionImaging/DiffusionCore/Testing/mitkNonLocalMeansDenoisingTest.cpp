@@ -21,6 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkGradientDirectionsProperty.h"
 #include "mitkITKImageImport.h"
 #include <mitkImageCast.h>
+#include <itkImageRegionConstIterator.h>
 
 class mitkNonLocalMeansDenoisingTestSuite : public mitk::TestFixture
 {
@@ -30,6 +31,7 @@ class mitkNonLocalMeansDenoisingTestSuite : public mitk::TestFixture
   MITK_TEST(Denoise_NLMr_shouldReturnTrue);
   MITK_TEST(Denoise_NLMv_shouldReturnTrue);
   MITK_TEST(Denoise_NLMvr_shouldReturnTrue);
+  MITK_TEST(Denoise_Blockwise_shouldMatchVoxelwise);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -164,6 +166,45 @@ public:
     MITK_ASSERT_EQUAL( m_DenoisedImage, m_ReferenceImage, "NLMvr should always return the same result.");
   }
 
+  void Denoise_Blockwise_shouldMatchVoxelwise()
+  {
+    VectorImagetType::Pointer vectorImage;
+    mitk::CastToItkImage(m_Image,vectorImage);
+
+    // NLMvr is excluded, see itk::NonLocalMeansDenoisingFilter::SetUseBlockwiseAlgorithm
+    bool rician[3] = {false, true, false};
+    bool joint[3] = {false, false, true};
+    for (int m=0; m<3; ++m)
+    {
+      m_DenoisingFilter->SetUseRicianAdaption(rician[m]);
+      m_DenoisingFilter->SetUseJointInformation(joint[m]);
+      m_DenoisingFilter->Update();
+
+      itk::NonLocalMeansDenoisingFilter<short>::Pointer blockwiseFilter = itk::NonLocalMeansDenoisingFilter<short>::New();
+      blockwiseFilter->SetInputImage(vectorImage);
+      blockwiseFilter->SetNumberOfThreads(2);
+      blockwiseFilter->SetComparisonRadius(1);
+      blockwiseFilter->SetSearchRadius(1);
+      blockwiseFilter->SetVariance(500);
+      blockwiseFilter->SetUseRicianAdaption(rician[m]);
+      blockwiseFilter->SetUseJointInformation(joint[m]);
+      blockwiseFilter->SetUseBlockwiseAlgorithm(true);
+      blockwiseFilter->Update();
+
+      itk::ImageRegionConstIterator< VectorImagetType > vit(m_DenoisingFilter->GetOutput(), m_DenoisingFilter->GetOutput()->GetLargestPossibleRegion());
+      itk::ImageRegionConstIterator< VectorImagetType > bit(blockwiseFilter->GetOutput(), blockwiseFilter->GetOutput()->GetLargestPossibleRegion());
+      int maxDiff = 0;
+      while (!vit.IsAtEnd())
+      {
+        for (unsigned int c=0; c<vectorImage->GetVectorLength(); ++c)
+          maxDiff = std::max(maxDiff, std::abs(vit.Get()[c] - bit.Get()[c]));
+        ++vit;
+        ++bit;
+      }
+      CPPUNIT_ASSERT_MESSAGE("Blockwise NLM should differ from the voxelwise result by at most one gray value.", maxDiff<=1);
+    }
+  }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkNonLocalMeansDenoising)
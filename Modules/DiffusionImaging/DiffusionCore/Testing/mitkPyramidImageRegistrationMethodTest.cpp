@@ -46,6 +46,11 @@ int mitkPyramidImageRegistrationMethodTest( int argc, char* argv[] )
   registrationMethod->SetFixedImage( fixedImage );
   registrationMethod->SetMovingImage( movingImage );
 
+  MITK_TEST_CONDITION( registrationMethod->GetMetricSamplingPercentage() == 1.0, "Dense metric sampling on default" );
+  MITK_TEST_CONDITION( registrationMethod->GetNumberOfThreads() == 0, "ITK default threading on default" );
+  MITK_TEST_FOR_EXCEPTION( mitk::Exception, registrationMethod->SetMetricSamplingPercentage( 0.0 ) );
+  MITK_TEST_FOR_EXCEPTION( mitk::Exception, registrationMethod->SetMetricSamplingPercentage( 1.5 ) );
+
   if( type_flag == "Rigid" )
   {
     registrationMethod->SetTransformToRigid();
@@ -0,0 +1,112 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include "mitkTestFixture.h"
+
+#include <mitkDiffusionFunctionCollection.h>
+#include <mitkOdfImage.h>
+#include <itkShToOdfImageFilter.h>
+#include <itkPointShell.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+
+#include <vector>
+
+class mitkShEvaluationTestSuite : public mitk::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(mitkShEvaluationTestSuite);
+  MITK_TEST(EvaluateSh_ShouldMatchMatrixVectorProduct);
+  MITK_TEST(ShToOdf_ShouldMatchMatrixVectorProduct);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  typedef itk::ShToOdfImageFilter< float, 4 > ShToOdfFilterType;
+
+  vnl_matrix<float> m_ShBasis;
+
+public:
+
+  void setUp() override
+  {
+    vnl_matrix_fixed<double, 3, ODF_SAMPLING_SIZE>* U = itk::PointShell<ODF_SAMPLING_SIZE, vnl_matrix_fixed<double, 3, ODF_SAMPLING_SIZE> >::DistributePointShell();
+    m_ShBasis = mitk::sh::CalcShBasisForDirections(4, U->as_matrix());
+  }
+
+  void tearDown() override
+  {
+    m_ShBasis.clear();
+  }
+
+  void EvaluateSh_ShouldMatchMatrixVectorProduct()
+  {
+    const unsigned int numVoxels = 7;
+    const unsigned int numCoeffs = m_ShBasis.cols();
+    std::vector<float> coeffs(numVoxels*numCoeffs);
+    for (unsigned int i=0; i<coeffs.size(); ++i)
+      coeffs[i] = 0.1f*(i%11) - 0.3f;
+
+    std::vector<float> values(numVoxels*m_ShBasis.rows());
+    mitk::sh::EvaluateSh(m_ShBasis.transpose(), coeffs.data(), numVoxels, values.data());
+
+    for (unsigned int v=0; v<numVoxels; ++v)
+    {
+      vnl_vector<float> c(coeffs.data() + v*numCoeffs, numCoeffs);
+      vnl_vector<float> reference = m_ShBasis * c;
+      for (unsigned int i=0; i<reference.size(); ++i)
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(reference[i], values[v*m_ShBasis.rows() + i], 1e-5);
+    }
+  }
+
+  void ShToOdf_ShouldMatchMatrixVectorProduct()
+  {
+    ShToOdfFilterType::InputImageType::Pointer image = ShToOdfFilterType::InputImageType::New();
+    ShToOdfFilterType::InputImageType::RegionType region;
+    region.SetSize(0, 5);
+    region.SetSize(1, 3);
+    region.SetSize(2, 2);
+    image->SetRegions(region);
+    image->Allocate();
+
+    unsigned int counter = 0;
+    itk::ImageRegionIterator< ShToOdfFilterType::InputImageType > it(image, region);
+    for (; !it.IsAtEnd(); ++it)
+    {
+      ShToOdfFilterType::InputPixelType pix;
+      for (unsigned int k=0; k<pix.Size(); ++k, ++counter)
+        pix[k] = 0.05f*(counter%13) - 0.2f;
+      it.Set(pix);
+    }
+
+    ShToOdfFilterType::Pointer filter = ShToOdfFilterType::New();
+    filter->SetInput(image);
+    filter->SetNumberOfThreads(2);
+    filter->Update();
+
+    itk::ImageRegionConstIterator< ShToOdfFilterType::InputImageType > cit(image, region);
+    itk::ImageRegionConstIterator< ShToOdfFilterType::OutputImageType > oit(filter->GetOutput(), region);
+    for (; !cit.IsAtEnd(); ++cit, ++oit)
+    {
+      vnl_vector<float> reference = m_ShBasis * cit.Get().GetVnlVector();
+      for (unsigned int i=0; i<ODF_SAMPLING_SIZE; ++i)
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(reference[i], oit.Get()[i], 1e-5);
+    }
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkShEvaluation)
@@ -84,6 +84,7 @@ set(H_FILES
   # Reconstruction
   include/Algorithms/Reconstruction/itkDiffusionQballReconstructionImageFilter.h
   include/Algorithms/Reconstruction/mitkTeemDiffusionTensor3DReconstructionImageFilter.h
+  include/Algorithms/Reconstruction/mitkLinearReconstructionEngine.h
   include/Algorithms/Reconstruction/itkAnalyticalDiffusionQballReconstructionImageFilter.h
   include/Algorithms/Reconstruction/itkDiffusionMultiShellQballReconstructionImageFilter.h
   include/Algorithms/Reconstruction/itkPointShell.h
@@ -106,6 +107,7 @@ set(H_FILES
   include/Algorithms/Reconstruction/MultishellProcessing/itkKurtosisFitFunctor.h
   include/Algorithms/Reconstruction/MultishellProcessing/itkBiExpFitFunctor.h
   include/Algorithms/Reconstruction/MultishellProcessing/itkADCFitFunctor.h
+  include/Algorithms/Reconstruction/MultishellProcessing/itkBatchedLevenbergMarquardt.h
 
   # Properties
   include/IODataStructures/Properties/mitkBValueMapProperty.h
@@ -33,8 +33,8 @@ public:
   typedef itk::VectorImage< unsigned short, 3 >                           DiffusionImageType;
   typedef TensorImage::PixelType                                          TensorType;
 
-  AbstractFitter(unsigned int number_of_parameters, unsigned int number_of_measurements) :
-    vnl_least_squares_function(number_of_parameters, number_of_measurements, no_gradient)
+  AbstractFitter(unsigned int number_of_parameters, unsigned int number_of_measurements, UseGradient g=no_gradient) :
+    vnl_least_squares_function(number_of_parameters, number_of_measurements, g)
   {
 
   }
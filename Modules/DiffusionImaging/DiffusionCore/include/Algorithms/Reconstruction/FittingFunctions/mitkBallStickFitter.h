@@ -27,7 +27,7 @@ struct BallStickFitter: public AbstractFitter
 public :
 
   BallStickFitter(unsigned int number_of_parameters, unsigned int number_of_measurements) :
-    AbstractFitter(number_of_parameters, number_of_measurements)
+    AbstractFitter(number_of_parameters, number_of_measurements, use_gradient)
   {
 
   }
@@ -65,6 +65,43 @@ public :
       fx[s] = factor*factor + penalty(x);
     }
   }
+
+  /** analytic derivatives of the residuals f(), the penalty is piecewise constant and does not contribute */
+  void gradf(const vnl_vector<double>& x, vnl_matrix<double>& jacobian) override
+  {
+    const double & f = x[0];
+    const double & d = x[1];
+    const double & theta = x[2];
+    const double & phi = x[3];
+    vnl_vector_fixed<double,3> dir, dir_dtheta, dir_dphi;
+    Sph2Cart(dir, theta, phi);
+    dir_dtheta[0] = std::cos(theta)*std::cos(phi);
+    dir_dtheta[1] = std::cos(theta)*std::sin(phi);
+    dir_dtheta[2] = -std::sin(theta);
+    dir_dphi[0] = -std::sin(theta)*std::sin(phi);
+    dir_dphi[1] = std::sin(theta)*std::cos(phi);
+    dir_dphi[2] = 0;
+
+    jacobian.fill(0.0);
+    for(auto s : weightedIndices)
+    {
+      const double b = bValues[s];
+      double s_iso = S0 * std::exp(-b * d);
+      GradientDirectionType g = gradientDirections->GetElement(s);
+      g.normalize();
+      double dot = dot_product(g, dir);
+      double s_aniso = S0 * std::exp(-b * d * dot*dot );
+      double approx = (1-f)*s_iso + f*s_aniso;
+      const double factor = measurements[s] - approx;
+
+      // d(factor^2)/dx = -2*factor*d(approx)/dx
+      const double dot_factor = -2 * b * d * dot * f * s_aniso;
+      jacobian(s, 0) = -2*factor*(s_aniso - s_iso);
+      jacobian(s, 1) = -2*factor*(-b*(1-f)*s_iso - b*dot*dot*f*s_aniso);
+      jacobian(s, 2) = -2*factor*dot_factor*dot_product(g, dir_dtheta);
+      jacobian(s, 3) = -2*factor*dot_factor*dot_product(g, dir_dphi);
+    }
+  }
 };
 
 }
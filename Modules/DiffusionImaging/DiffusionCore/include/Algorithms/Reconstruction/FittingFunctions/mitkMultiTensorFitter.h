@@ -18,6 +18,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define _MITK_MultiTensorFitter_H
 
 #include <mitkAbstractFitter.h>
+#include <vnl/algo/vnl_svd.h>
+#include <algorithm>
 
 namespace mitk {
 
@@ -26,7 +28,7 @@ class MultiTensorFitter: public AbstractFitter
 public:
 
   MultiTensorFitter(unsigned int number_of_tensors=2, unsigned int number_of_measurements=1) :
-    AbstractFitter(check(number_of_tensors), number_of_measurements)
+    AbstractFitter(check(number_of_tensors), number_of_measurements, use_gradient)
   {
     num_tensors = number_of_tensors;
   }
@@ -110,6 +112,95 @@ public:
     }
   }
 
+  /** analytic derivatives of the residuals f(), only the volume fraction sum term of the penalty is differentiable */
+  void gradf(const vnl_vector<double>& x, vnl_matrix<double>& jacobian) override
+  {
+    int elements = 7;
+    bool weighted = num_tensors>1 && x.size()>6;
+
+    double penalty_dw = 0;
+    if (num_tensors>1)
+    {
+      double f = 0;
+      for (int i=0; i<num_tensors; i++)
+        f += x[6+i*7];
+      if (f<1)
+        penalty_dw = -10e7;
+      else if (f>1)
+        penalty_dw = 10e7;
+    }
+
+    jacobian.fill(0.0);
+    for(auto s : weightedIndices)
+    {
+      GradientDirectionType g = gradientDirections->GetElement(s);
+      g.normalize();
+
+      // derivatives of D with respect to the six tensor elements
+      double dD[6];
+      dD[0] = g[0]*g[0];
+      dD[1] = 2*g[1]*g[0];
+      dD[2] = 2*g[2]*g[0];
+      dD[3] = g[1]*g[1];
+      dD[4] = 2*g[2]*g[1];
+      dD[5] = g[2]*g[2];
+
+      double approx = 0;
+      for (int i=0; i<num_tensors; i++)
+      {
+        double D = 0;
+        for (int k=0; k<6; k++)
+          D += x[k+i*elements]*dD[k];
+        double exponential = S0 * std::exp ( -bValues[s] * D );
+        double signal = weighted ? exponential*x[elements-1+i*elements] : exponential;
+        approx += signal;
+
+        for (int k=0; k<6; k++)
+          jacobian(s, k+i*elements) = -bValues[s] * dD[k] * signal;
+        if (weighted)
+          jacobian(s, elements-1+i*elements) = exponential;
+      }
+
+      // d(factor^2)/dx = -2*factor*d(approx)/dx
+      const double factor = measurements[s] - approx;
+      for (unsigned int k=0; k<x.size(); k++)
+        jacobian(s, k) *= -2*factor;
+      if (weighted)
+        for (int i=0; i<num_tensors; i++)
+          jacobian(s, elements-1+i*elements) += penalty_dw;
+    }
+  }
+
+  /** log-linear least squares fit of a single tensor, used as initial guess of the nonlinear fit */
+  void linear_fit(vnl_vector<double>& x)
+  {
+    x.set_size(6);
+    x.fill(0.0);
+    if (S0<=0)
+      return;
+
+    vnl_matrix<double> B(weightedIndices.size(), 6);
+    vnl_vector<double> y(weightedIndices.size());
+    unsigned int row = 0;
+    for(auto s : weightedIndices)
+    {
+      GradientDirectionType g = gradientDirections->GetElement(s);
+      g.normalize();
+      B(row, 0) = -bValues[s]*g[0]*g[0];
+      B(row, 1) = -bValues[s]*2*g[1]*g[0];
+      B(row, 2) = -bValues[s]*2*g[2]*g[0];
+      B(row, 3) = -bValues[s]*g[1]*g[1];
+      B(row, 4) = -bValues[s]*2*g[2]*g[1];
+      B(row, 5) = -bValues[s]*g[2]*g[2];
+      y[row] = std::log(std::max(static_cast<double>(measurements[s]), 1.0) / S0);
+      ++row;
+    }
+    if (row<6)
+      return;
+
+    x = vnl_svd<double>(B).solve(y);
+  }
+
 };
 
 }
@@ -18,8 +18,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define _itk_ADCFitFunctor_h_
 
 #include "itkDWIVoxelFunctor.h"
-#include "vnl/vnl_least_squares_function.h"
-#include "vnl/vnl_math.h"
+#include "itkBatchedLevenbergMarquardt.h"
+#include <cmath>
 namespace itk
 {
 
@@ -49,51 +49,19 @@ protected:
   vnl_vector<double> m_BValueList;
 
   /**
-   * \brief The lestSquaresFunction struct for Non-Linear-Least-Squres fit of monoexponential model
+   * \brief Monoexponential model S0*exp(-b*ADC) with analytic derivative, fitted by BatchedLevenbergMarquardt
    */
-  struct lestSquaresFunction: public vnl_least_squares_function
+  struct Model
   {
-
-    void set_measurements(const vnl_vector<double>& x)
-    {
-      measurements.set_size(x.size());
-      measurements.copy_in(x.data_block());
-    }
-
-    void set_bvalues(const vnl_vector<double>& x)
-    {
-      bValueVector.set_size(x.size());
-      bValueVector.copy_in(x.data_block());
-    }
-
-    void set_reference_measurement(const double & x)
-    {
-      S0 = x;
-    }
-
-    vnl_vector<double> measurements;
-    vnl_vector<double> bValueVector;
+    const double* bValues;
     double S0;
-    int N;
 
-    lestSquaresFunction(unsigned int number_of_measurements) :
-      vnl_least_squares_function(1 /*number of unknowns [ ADC ]*/, number_of_measurements, no_gradient)
+    double Evaluate(const double* x, unsigned int s, double* jacobian) const
     {
-      N = get_number_of_residuals();
-    }
-
-    void f(const vnl_vector<double>& x, vnl_vector<double>& fx) override {
-
       const double & ADC = x[0];
-
-      const vnl_vector<double> & b = bValueVector;
-
-      for(int s=0; s<N; s++)
-      {
-        double approx = S0 * std::exp(-b[s] * ADC);
-        fx[s] = vnl_math_abs( measurements[s] - approx );
-      }
-
+      const double approx = S0 * std::exp(-bValues[s] * ADC);
+      jacobian[0] = -bValues[s] * approx;
+      return approx;
     }
   };
 };
@@ -0,0 +1,203 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef _itk_BatchedLevenbergMarquardt_h_
+#define _itk_BatchedLevenbergMarquardt_h_
+
+#include "vnl/vnl_vector.h"
+#include "vnl/vnl_matrix.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace itk
+{
+
+/**
+ * \brief Levenberg-Marquardt least squares fit of a small model to many signal vectors that share the sampling scheme.
+ *
+ * Each row of the measurement matrix is fitted independently. In contrast to vnl_levenberg_marquardt no cost
+ * function object is created per fit and the Jacobian is computed analytically by the model, so the normal equations
+ * are formed from one model evaluation per iteration. The workspace is allocated once per call of Fit() and reused
+ * for all rows.
+ *
+ * The model has to provide
+ * \code
+ * // value of measurement s for the parameters x, the partial derivatives are written to jacobian[0..NParameters-1]
+ * double Evaluate(const double* x, unsigned int s, double* jacobian) const;
+ * \endcode
+ */
+template< unsigned int NParameters >
+class BatchedLevenbergMarquardt
+{
+public:
+  BatchedLevenbergMarquardt()
+    : m_MaximumNumberOfIterations(100)
+    , m_FunctionTolerance(1e-10)
+  {}
+
+  void SetMaximumNumberOfIterations(unsigned int iterations){m_MaximumNumberOfIterations = iterations;}
+  void SetFunctionTolerance(double tolerance){m_FunctionTolerance = tolerance;}  ///< stop if the relative decrease of the cost is smaller
+
+  /**
+   * \param measurements one signal vector per row
+   * \param parameters one initial guess per row, replaced by the fitted parameters
+   * \param rmsErrors receives the RMS residual of each row
+   */
+  template< class ModelType >
+  void Fit(const ModelType& model, const vnl_matrix<double>& measurements, vnl_matrix<double>& parameters, vnl_vector<double>& rmsErrors) const
+  {
+    const unsigned int numFits = measurements.rows();
+    const unsigned int numMeasurements = measurements.cols();
+    rmsErrors.set_size(numFits);
+
+    // model values and Jacobian of the current and of the trial step, measurement major
+    std::vector<double> values(numMeasurements), trialValues(numMeasurements);
+    std::vector<double> jacobian(numMeasurements*NParameters), trialJacobian(numMeasurements*NParameters);
+
+    for (unsigned int i=0; i<numFits; ++i)
+    {
+      const double* y = measurements[i];
+      double* x = parameters[i];
+
+      double cost = Evaluate(model, x, y, numMeasurements, values.data(), jacobian.data());
+      double lambda = 1e-3;
+
+      for (unsigned int iteration=0; iteration<m_MaximumNumberOfIterations && cost>0; ++iteration)
+      {
+        // normal equations JtJ dx = Jt r
+        double JtJ[NParameters][NParameters] = {};
+        double Jtr[NParameters] = {};
+        for (unsigned int s=0; s<numMeasurements; ++s)
+        {
+          const double* J = &jacobian[s*NParameters];
+          const double r = y[s] - values[s];
+          for (unsigned int p=0; p<NParameters; ++p)
+          {
+            Jtr[p] += J[p]*r;
+            for (unsigned int q=0; q<=p; ++q)
+              JtJ[p][q] += J[p]*J[q];
+          }
+        }
+
+        bool improved = false;
+        bool converged = false;
+        while (!improved && lambda<1e10)
+        {
+          double A[NParameters][NParameters];
+          double step[NParameters];
+          for (unsigned int p=0; p<NParameters; ++p)
+          {
+            for (unsigned int q=0; q<=p; ++q)
+              A[p][q] = A[q][p] = JtJ[p][q];
+            A[p][p] += lambda*(JtJ[p][p]>0 ? JtJ[p][p] : 1.0);
+            step[p] = Jtr[p];
+          }
+
+          if (!Solve(A, step))
+          {
+            lambda *= 10;
+            continue;
+          }
+
+          double trial[NParameters];
+          for (unsigned int p=0; p<NParameters; ++p)
+            trial[p] = x[p] + step[p];
+
+          const double trialCost = Evaluate(model, trial, y, numMeasurements, trialValues.data(), trialJacobian.data());
+          if (trialCost<cost)
+          {
+            improved = true;
+            const double decrease = cost - trialCost;
+            for (unsigned int p=0; p<NParameters; ++p)
+              x[p] = trial[p];
+            values.swap(trialValues);
+            jacobian.swap(trialJacobian);
+            lambda = std::max(lambda*0.1, 1e-12);
+
+            converged = decrease<=m_FunctionTolerance*cost;
+            cost = trialCost;
+          }
+          else
+            lambda *= 10;
+        }
+
+        if (!improved || converged)
+          break;
+      }
+
+      rmsErrors[i] = numMeasurements>0 ? std::sqrt(cost/numMeasurements) : 0;
+    }
+  }
+
+protected:
+
+  /** Sum of squared residuals, also fills the model values and the Jacobian */
+  template< class ModelType >
+  static double Evaluate(const ModelType& model, const double* x, const double* y, unsigned int numMeasurements, double* values, double* jacobian)
+  {
+    double cost = 0;
+    for (unsigned int s=0; s<numMeasurements; ++s)
+    {
+      values[s] = model.Evaluate(x, s, jacobian + s*NParameters);
+      const double r = y[s] - values[s];
+      cost += r*r;
+    }
+    return std::isfinite(cost) ? cost : std::numeric_limits<double>::max();
+  }
+
+  /** Gaussian elimination with partial pivoting, the solution replaces b */
+  static bool Solve(double A[NParameters][NParameters], double b[NParameters])
+  {
+    for (unsigned int c=0; c<NParameters; ++c)
+    {
+      unsigned int pivot = c;
+      for (unsigned int r=c+1; r<NParameters; ++r)
+        if (std::fabs(A[r][c])>std::fabs(A[pivot][c]))
+          pivot = r;
+      if (std::fabs(A[pivot][c])<1e-300)
+        return false;
+      if (pivot!=c)
+      {
+        for (unsigned int k=0; k<NParameters; ++k)
+          std::swap(A[c][k], A[pivot][k]);
+        std::swap(b[c], b[pivot]);
+      }
+      for (unsigned int r=c+1; r<NParameters; ++r)
+      {
+        const double factor = A[r][c]/A[c][c];
+        for (unsigned int k=c; k<NParameters; ++k)
+          A[r][k] -= factor*A[c][k];
+        b[r] -= factor*b[c];
+      }
+    }
+    for (int r=NParameters-1; r>=0; --r)
+    {
+      for (unsigned int k=r+1; k<NParameters; ++k)
+        b[r] -= A[r][k]*b[k];
+      b[r] /= A[r][r];
+    }
+    return true;
+  }
+
+  unsigned int m_MaximumNumberOfIterations;
+  double m_FunctionTolerance;
+};
+
+}
+
+#endif
@@ -18,13 +18,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define _itk_BiExpFitFunctor_h_
 
 #include "itkDWIVoxelFunctor.h"
+#include "itkBatchedLevenbergMarquardt.h"
 #include <cmath>
 
-// vnl include
-#include "vnl/vnl_least_squares_function.h"
-#include "vnl/algo/vnl_levenberg_marquardt.h"
-#include "vnl/vnl_math.h"
-
 namespace itk
 {
 
@@ -54,56 +50,29 @@ protected:
   vnl_vector<double> m_BValueList;
 
   /**
-   * \brief The lestSquaresFunction struct for Non-Linear-Least-Squres fit of Biexponential model
+   * \brief Biexponential model S0*(lambda*exp(-b*ADC_slow) + (1-lambda)*exp(-b*ADC_fast)) with analytic derivatives,
+   * fitted by BatchedLevenbergMarquardt
    */
-  struct lestSquaresFunction: public vnl_least_squares_function
+  struct Model
   {
-
-    void set_measurements(const vnl_vector<double>& x)
-    {
-      measurements.set_size(x.size());
-      measurements.copy_in(x.data_block());
-    }
-
-    void set_bvalues(const vnl_vector<double>& x)
-    {
-      bValueVector.set_size(x.size());
-      bValueVector.copy_in(x.data_block());
-    }
-
-    void set_reference_measurement(const double & x)
-    {
-      S0 = x;
-    }
-
-    vnl_vector<double> measurements;
-    vnl_vector<double> bValueVector;
+    const double* bValues;
     double S0;
-    int N;
 
-    lestSquaresFunction(unsigned int number_of_measurements) :
-      vnl_least_squares_function(3 /*number of unknowns [ ADC_slow ADC_fast lambda]*/, number_of_measurements, no_gradient)
+    double Evaluate(const double* x, unsigned int s, double* jacobian) const
     {
-      N = get_number_of_residuals();
-    }
-
-    void f(const vnl_vector<double>& x, vnl_vector<double>& fx) override {
-
       const double & ADC_slow = x[0];
       const double & ADC_fast = x[1];
       const double & lambda = x[2];
-
-      const vnl_vector<double> & b = bValueVector;
-
-      for(int s=0; s<N; s++)
-      {
-        double approx = lambda * std::exp(-b[s] * ADC_slow) + (1-lambda) * std::exp(-b[s] * ADC_fast);
-        fx[s] = vnl_math_abs( measurements[s] - approx*S0 );
-      }
-
+      const double & b = bValues[s];
+
+      const double slow = std::exp(-b * ADC_slow);
+      const double fast = std::exp(-b * ADC_fast);
+      jacobian[0] = -S0 * lambda * b * slow;
+      jacobian[1] = -S0 * (1-lambda) * b * fast;
+      jacobian[2] = S0 * (slow - fast);
+      return S0 * (lambda * slow + (1-lambda) * fast);
     }
   };
-
 };
 
 }
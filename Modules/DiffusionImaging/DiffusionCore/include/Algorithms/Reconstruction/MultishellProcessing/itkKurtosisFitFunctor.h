@@ -18,13 +18,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define _itk_KurtosisFitFunctor_h_
 
 #include "itkDWIVoxelFunctor.h"
+#include "itkBatchedLevenbergMarquardt.h"
 #include <cmath>
 
-// vnl include
-#include "vnl/vnl_least_squares_function.h"
-#include "vnl/algo/vnl_levenberg_marquardt.h"
-#include "vnl/vnl_math.h"
-
 namespace itk
 {
 
@@ -54,54 +50,24 @@ protected:
   vnl_vector<double> m_BValueList;
 
   /**
-   * \brief The lestSquaresFunction struct for Non-Linear-Least-Squres fit of Kurtosis
+   * \brief Kurtosis model S0*exp(-b*ADC + b^2*ADC^2*AKC/6) with analytic derivatives, fitted by BatchedLevenbergMarquardt
    */
-  struct lestSquaresFunction: public vnl_least_squares_function
+  struct Model
   {
-
-    void set_measurements(const vnl_vector<double>& x)
-    {
-      measurements.set_size(x.size());
-      measurements.copy_in(x.data_block());
-    }
-
-    void set_bvalues(const vnl_vector<double>& x)
-    {
-      bValueVector.set_size(x.size());
-      bValueVector.copy_in(x.data_block());
-    }
-
-    void set_reference_measurement(const double & x)
-    {
-      S0 = x;
-    }
-
-    vnl_vector<double> measurements;
-    vnl_vector<double> bValueVector;
+    const double* bValues;
     double S0;
-    int N;
 
-    lestSquaresFunction(unsigned int number_of_measurements) :
-      vnl_least_squares_function(2 /*number of unknowns [ADC AKC]*/, number_of_measurements, no_gradient)
+    double Evaluate(const double* x, unsigned int s, double* jacobian) const
     {
-      N = get_number_of_residuals();
-    }
-
-    void f(const vnl_vector<double>& x, vnl_vector<double>& fx) override {
-
       const double & D = x[0];
       const double & K = x[1];
-      const vnl_vector<double> & b = bValueVector;
-
-      for(int s=0; s<N; s++)
-      {
-        double approx = S0 * std::exp(- b[s] * D + 1./6. *b[s] * b[s] *D * D * K);
-        fx[s] = vnl_math_abs( measurements[s] - approx );
-      }
-
+      const double & b = bValues[s];
+      const double approx = S0 * std::exp(- b * D + 1./6. * b * b * D * D * K);
+      jacobian[0] = approx * (-b + 1./3. * b * b * D * K);
+      jacobian[1] = approx * 1./6. * b * b * D * D;
+      return approx;
     }
   };
-
 };
 
 }
@@ -23,6 +23,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkArray.h>
 #include <vnl/vnl_vector.h>
 #include <mitkDiffusionFunctionCollection.h>
+#include <mitkLinearReconstructionEngine.h>
 
 #include <cstdio>
 #include <locale>
@@ -325,74 +326,105 @@ void AnalyticalDiffusionQballReconstructionImageFilter<T,TG,TO,ShOrder,NrOdfDire
       gradientind.push_back(gradientind[i]);
   }
 
+  // the signals of up to batchSize voxels are reconstructed at once
+  const unsigned int batchSize = 256;
+  mitk::LinearReconstructionEngine<TO> coeffEngine(m_CoeffReconstructionMatrix);
+  mitk::LinearReconstructionEngine<TO> odfEngine;
+  if(m_NormalizationMethod == QBAR_SOLID_ANGLE)
+    odfEngine.SetMatrix(m_SphericalHarmonicBasisMatrix);
+  else
+    odfEngine.SetMatrix(m_ReconstructionMatrix);
+
+  std::vector< typename NumericTraits<ReferencePixelType>::AccumulateType > b0Values;
+  std::vector< int > batchIndices;    // -1 for voxels below the b0 threshold
+  std::vector< TO > signals;
+  std::vector< TO > coefficients;
+  std::vector< TO > odfs;
+  vnl_vector<TO> B(m_NumberOfGradientDirections);
+
   while( !git.IsAtEnd() )
   {
-    GradientVectorType b = git.Get();
+    b0Values.clear();
+    batchIndices.clear();
+    signals.clear();
+    unsigned int numSignals = 0;
 
-    typename NumericTraits<ReferencePixelType>::AccumulateType b0 = NumericTraits<ReferencePixelType>::Zero;
-
-    // Average the baseline image pixels
-    for(unsigned int i = 0; i < baselineind.size(); ++i)
+    for (unsigned int n=0; n<batchSize && !git.IsAtEnd(); ++n, ++git)
     {
-      b0 += b[baselineind[i]];
-    }
-    b0 /= this->m_NumberOfBaselineImages;
-
-    OdfPixelType odf(0.0);
+      GradientVectorType b = git.Get();
 
-    typename CoefficientImageType::PixelType coeffPixel(0.0);
-    vnl_vector<TO> B(m_NumberOfGradientDirections);
+      typename NumericTraits<ReferencePixelType>::AccumulateType b0 = NumericTraits<ReferencePixelType>::Zero;
 
-    if( (b0 != 0) && (b0 >= m_Threshold) )
-    {
-      for( unsigned int i = 0; i< m_NumberOfGradientDirections; i++ )
+      // Average the baseline image pixels
+      for(unsigned int i = 0; i < baselineind.size(); ++i)
       {
-        B[i] = static_cast<TO>(b[gradientind[i]]);
+        b0 += b[baselineind[i]];
       }
+      b0 /= this->m_NumberOfBaselineImages;
+      b0Values.push_back(b0);
 
-      B = PreNormalize(B, b0);
-      if(m_NormalizationMethod == QBAR_SOLID_ANGLE)
-      {
-        vnl_vector<TO> coeffs(m_NumberCoefficients);
-        coeffs = ( m_CoeffReconstructionMatrix * B );
-        coeffs[0] += 1.0/(2.0*sqrt(itk::Math::pi));
-        odf = ( m_SphericalHarmonicBasisMatrix * coeffs ).data_block();
-        coeffPixel = coeffs.data_block();
-      }
-      else if(m_NormalizationMethod == QBAR_NONNEG_SOLID_ANGLE)
+      if( (b0 != 0) && (b0 >= m_Threshold) )
       {
-        /** this would be the place to implement a non-negative
-              * solver for quadratic programming problem:
-              * min .5*|| Bc-s ||^2 subject to -CLPc <= 4*pi*ones
-              * (refer to MICCAI 2009 Goh et al. "Estimating ODFs with PDF constraints")
-              * .5*|| Bc-s ||^2 == .5*c'B'Bc - x'B's + .5*s's
-              */
-
-        itkExceptionMacro( << "Nonnegative Solid Angle not yet implemented");
+        if(m_NormalizationMethod == QBAR_NONNEG_SOLID_ANGLE)
+        {
+          /** this would be the place to implement a non-negative
+                * solver for quadratic programming problem:
+                * min .5*|| Bc-s ||^2 subject to -CLPc <= 4*pi*ones
+                * (refer to MICCAI 2009 Goh et al. "Estimating ODFs with PDF constraints")
+                * .5*|| Bc-s ||^2 == .5*c'B'Bc - x'B's + .5*s's
+                */
+
+          itkExceptionMacro( << "Nonnegative Solid Angle not yet implemented");
+        }
+
+        for( unsigned int i = 0; i< m_NumberOfGradientDirections; i++ )
+        {
+          B[i] = static_cast<TO>(b[gradientind[i]]);
+        }
+
+        B = PreNormalize(B, b0);
+        signals.insert(signals.end(), B.begin(), B.end());
+        batchIndices.push_back(numSignals++);
       }
       else
+        batchIndices.push_back(-1);
+    }
+
+    coefficients.resize(numSignals*m_NumberCoefficients);
+    coeffEngine.Apply(signals.data(), numSignals, coefficients.data());
+    for (unsigned int v=0; v<numSignals; ++v)
+      coefficients[v*m_NumberCoefficients] += 1.0/(2.0*sqrt(itk::Math::pi));
+
+    odfs.resize(numSignals*NrOdfDirections);
+    if(m_NormalizationMethod == QBAR_SOLID_ANGLE)
+      odfEngine.Apply(coefficients.data(), numSignals, odfs.data());
+    else
+      odfEngine.Apply(signals.data(), numSignals, odfs.data());
+
+    for (unsigned int n=0; n<b0Values.size(); ++n)
+    {
+      OdfPixelType odf(0.0);
+      typename CoefficientImageType::PixelType coeffPixel(0.0);
+
+      if (batchIndices[n]>=0)
       {
-        vnl_vector<TO> coeffs(m_NumberCoefficients);
-        coeffs = ( m_CoeffReconstructionMatrix * B );
-        coeffs[0] += 1.0/(2.0*sqrt(itk::Math::pi));
-        coeffPixel = coeffs.data_block();
-        odf = ( m_ReconstructionMatrix * B ).data_block();
+        coeffPixel = &coefficients[batchIndices[n]*m_NumberCoefficients];
+        odf = &odfs[batchIndices[n]*NrOdfDirections];
+        odf = Normalize(odf, b0Values[n]);
       }
-      odf = Normalize(odf, b0);
-    }
 
-    oit.Set( odf );
-    oit2.Set( b0 );
-    float sum = 0;
-    for (unsigned int k=0; k<odf.Size(); k++)
-      sum += (float) odf[k];
-    oit3.Set( sum-1 );
-    oit4.Set(coeffPixel);
-    ++oit;  // odf image iterator
-    ++oit3; // odf sum image iterator
-    ++oit2; // b0 image iterator
-    ++oit4; // coefficient image iterator
-    ++git;  // Gradient  image iterator
+      oit.Set( odf );
+      oit2.Set( b0Values[n] );
+      float sum = 0;
+      for (unsigned int k=0; k<odf.Size(); k++)
+        sum += (float) odf[k];
+      oit3.Set( sum-1 );
+      oit4.Set(coeffPixel);
+      ++oit;  // odf image iterator
+      ++oit3; // odf sum image iterator
+      ++oit2; // b0 image iterator
+      ++oit4; // coefficient image iterator
+    }
   }
 
   std::cout << "One Thread finished reconstruction" << std::endl;
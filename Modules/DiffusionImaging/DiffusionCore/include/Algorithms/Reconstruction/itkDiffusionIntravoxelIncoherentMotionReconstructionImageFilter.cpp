@@ -703,7 +703,7 @@ void DiffusionIntravoxelIncoherentMotionReconstructionImageFilter<TIn, TOut>
         filter->SetReferenceImage(m_InternalVectorImage);
         filter->SetBValues(m_Snap.high_bvalues);
         filter->SetNumberIterations(m_NumberIterations);
-        filter->SetNumberOfThreads(1);
+        filter->SetNumberOfThreads(this->GetNumberOfThreads());
         filter->SetLambda(m_Lambda);
         filter->Update();
         typename RegFitType::OutputImageType::Pointer outimg = filter->GetOutput();
@@ -131,8 +131,7 @@ MultiTensorImageFilter< TInPixelType, TOutPixelType>::FitSingleVoxel( const type
 
   vnl_levenberg_marquardt lm(ls_fit);
   vnl_vector<double> x;
-  x.set_size(6);
-  x.fill(0.0);
+  ls_fit.linear_fit(x);   // log-linear tensor fit as initial guess
 
   lm.minimize(x);
 
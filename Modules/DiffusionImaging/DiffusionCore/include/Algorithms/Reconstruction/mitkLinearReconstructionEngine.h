@@ -0,0 +1,130 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef __mitkLinearReconstructionEngine_h_
+#define __mitkLinearReconstructionEngine_h_
+
+#include <vnl/vnl_matrix.h>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+namespace mitk
+{
+
+/**
+* \brief Applies a fixed linear reconstruction matrix (e.g. the pseudo-inverse of a design matrix) to the signals of many voxels at once.
+*
+* The design matrix of the linear diffusion models is the same for all voxels, so instead of one matrix-vector product per voxel the signal vectors of a batch of voxels are
+* stored one after another and multiplied with the reconstruction matrix in one step. The product is blocked over voxels, so the reconstruction matrix stays in the cache
+* while it is applied to a block of signals and every inner loop is a contiguous dot product.
+*/
+template< class TValue >
+class LinearReconstructionEngine
+{
+
+public:
+
+  LinearReconstructionEngine() : m_Rows(0), m_Columns(0) {}
+
+  template< class TMatrixValue >
+  explicit LinearReconstructionEngine(const vnl_matrix< TMatrixValue >& matrix) { SetMatrix(matrix); }
+
+  /** \brief Sets the reconstruction matrix (number of outputs x number of inputs). */
+  template< class TMatrixValue >
+  void SetMatrix(const vnl_matrix< TMatrixValue >& matrix)
+  {
+    m_Rows = matrix.rows();
+    m_Columns = matrix.cols();
+    m_Matrix.resize(m_Rows*m_Columns);
+    for (unsigned int r=0; r<m_Rows; ++r)
+      for (unsigned int c=0; c<m_Columns; ++c)
+        m_Matrix[r*m_Columns + c] = static_cast<TValue>(matrix(r,c));
+  }
+
+  unsigned int GetNumberOfInputs() const { return m_Columns; }
+  unsigned int GetNumberOfOutputs() const { return m_Rows; }
+
+  /**
+   * \brief results[v*outputs + o] = sum_i M(o,i) * signals[v*inputs + i] for all numVoxels voxels.
+   */
+  void Apply(const TValue* signals, unsigned int numVoxels, TValue* results) const
+  {
+    const unsigned int blockSize = 32;
+    for (unsigned int v0=0; v0<numVoxels; v0+=blockSize)
+    {
+      const unsigned int v1 = std::min(numVoxels, v0+blockSize);
+      for (unsigned int r=0; r<m_Rows; ++r)
+      {
+        const TValue* row = &m_Matrix[r*m_Columns];
+        for (unsigned int v=v0; v<v1; ++v)
+        {
+          const TValue* signal = signals + static_cast<std::size_t>(v)*m_Columns;
+          TValue sum = 0;
+          for (unsigned int c=0; c<m_Columns; ++c)
+            sum += row[c]*signal[c];
+          results[static_cast<std::size_t>(v)*m_Rows + r] = sum;
+        }
+      }
+    }
+  }
+
+  /**
+   * \brief Closed form eigenvalues of symmetric 3x3 tensors stored as (xx, xy, xz, yy, yz, zz). Eigenvalues of each tensor are written in ascending order like itk::SymmetricEigenAnalysis does.
+   *
+   * Avoids the iterative eigen analysis when only the eigenvalues are needed and has no data dependent loops, so the loop over the tensors can be vectorized.
+   */
+  static void ComputeSymmetricEigenValues(const TValue* tensors, unsigned int numTensors, TValue* eigenvalues)
+  {
+    for (unsigned int t=0; t<numTensors; ++t)
+    {
+      const TValue* a = tensors + 6*t;
+      double xx = a[0], xy = a[1], xz = a[2], yy = a[3], yz = a[4], zz = a[5];
+
+      double q = (xx+yy+zz)/3;
+      double p1 = xy*xy + xz*xz + yz*yz;
+      double p2 = (xx-q)*(xx-q) + (yy-q)*(yy-q) + (zz-q)*(zz-q) + 2*p1;
+      double p = std::sqrt(p2/6);
+
+      double e0 = q, e1 = q, e2 = q;
+      if (p>0)
+      {
+        double bxx = (xx-q)/p, byy = (yy-q)/p, bzz = (zz-q)/p, bxy = xy/p, bxz = xz/p, byz = yz/p;
+        double r = 0.5 * (bxx*(byy*bzz - byz*byz) - bxy*(bxy*bzz - byz*bxz) + bxz*(bxy*byz - byy*bxz));
+        r = std::max(-1.0, std::min(1.0, r));
+
+        double phi = std::acos(r)/3;
+        e2 = q + 2*p*std::cos(phi);
+        e0 = q + 2*p*std::cos(phi + 2.0943951023931954923);   // phi + 2pi/3
+        e1 = 3*q - e0 - e2;
+      }
+
+      eigenvalues[3*t] = static_cast<TValue>(e0);
+      eigenvalues[3*t+1] = static_cast<TValue>(e1);
+      eigenvalues[3*t+2] = static_cast<TValue>(e2);
+    }
+  }
+
+protected:
+
+  unsigned int            m_Rows;
+  unsigned int            m_Columns;
+  std::vector< TValue >   m_Matrix;     ///< row-major copy of the reconstruction matrix
+};
+
+}
+
+#endif
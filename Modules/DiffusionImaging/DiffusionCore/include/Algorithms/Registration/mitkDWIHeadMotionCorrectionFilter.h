@@ -40,6 +40,9 @@ namespace mitk
  * as error metric. Second, the weighted gradient images are registered to the unweighted reference ( computed as average from the aligned images from first step )
  * by an affine transformation using the MattesMutualInformation metric as optimizer guidance.
  *
+ * The volumes are registered independently of each other, so several registrations run concurrently. The number of
+ * concurrent registrations is limited by SetMaxConcurrentRegistrations() and by the memory budget given via SetMaxMemory().
+ *
  */
 
 class MITKDIFFUSIONCORE_EXPORT DWIHeadMotionCorrectionFilter
@@ -64,14 +67,27 @@ public:
   mitk::Image::Pointer GetCorrectedImage() const;
   void UpdateOutputInformation() override;
 
+  /** \brief Maximum number of volume registrations running in parallel. 0 uses all available threads (default). */
+  itkSetMacro(MaxConcurrentRegistrations, unsigned int)
+  itkGetMacro(MaxConcurrentRegistrations, unsigned int)
+
+  /** \brief Rough memory budget in MB shared by all concurrently running registrations (default 2048). */
+  itkSetMacro(MaxMemory, unsigned int)
+  itkGetMacro(MaxMemory, unsigned int)
+
 protected:
   DWIHeadMotionCorrectionFilter();
   ~DWIHeadMotionCorrectionFilter() override {}
 
   mitk::Image::Pointer m_CorrectedImage;
+  unsigned int m_MaxConcurrentRegistrations;
+  unsigned int m_MaxMemory;
 
   void GenerateData() override;
 
+  /** \brief Number of registrations that may run at the same time for volumes with the given number of voxels */
+  int GetNumberOfConcurrentRegistrations(unsigned long num_voxels, int num_volumes) const;
+
 };
 
 } //end namespace mitk
@@ -56,6 +56,13 @@ namespace mitk
  * It uses
  *   - MattesMutualInformation for CrossModality=on ( default ) and
  *   - NormalizedCorrelation for CrossModality=off.
+ *
+ * The fixed image prepared for the registration (cast to double) and the fixed image mask are kept between
+ * subsequent Update() calls as long as neither the images nor the mask are modified. This way registering many
+ * moving images onto the same reference does not repeat the preparation of the fixed side.
+ *
+ * To run several registrations concurrently, limit the threads of each instance by SetNumberOfThreads() to
+ * avoid oversubscription, and optionally reduce the metric cost with SetMetricSamplingPercentage().
  */
 class MITKDIFFUSIONCORE_EXPORT PyramidImageRegistrationMethod :
     public itk::Object
@@ -152,6 +159,42 @@ public:
     m_InitializeByGeometry = flag;
   }
 
+  /**
+   * @brief Fraction ( 0,1 ] of the fixed image voxels evaluated by the metric on every pyramid level
+   *
+   * For values below 1 the metric is evaluated on random sparse samples (the ITKv4 RANDOM sampling strategy)
+   * drawn anew for each level, 1.0 ( default ) evaluates the metric densely on all voxels.
+   */
+  void SetMetricSamplingPercentage( double percentage )
+  {
+    if( percentage <= 0.0 || percentage > 1.0 )
+    {
+      mitkThrow() << "Metric sampling percentage has to be in (0,1], got " << percentage;
+    }
+    m_MetricSamplingPercentage = percentage;
+  }
+
+  double GetMetricSamplingPercentage() const
+  {
+    return m_MetricSamplingPercentage;
+  }
+
+  /**
+   * @brief Maximal number of threads used by the metric, the optimizer and the registration filters
+   *
+   * 0 ( default ) leaves the choice to the global ITK settings. Set to a small number when running several
+   * registrations in parallel.
+   */
+  void SetNumberOfThreads( unsigned int numberOfThreads )
+  {
+    m_NumberOfThreads = numberOfThreads;
+  }
+
+  unsigned int GetNumberOfThreads() const
+  {
+    return m_NumberOfThreads;
+  }
+
   void Update();
 
   /**
@@ -315,6 +358,26 @@ protected:
 
   bool m_InitializeByGeometry;
 
+  double m_MetricSamplingPercentage;
+
+  unsigned int m_NumberOfThreads;
+
+  typedef itk::Image< double, 3> RegistrationImageType;
+  typedef itk::ImageMaskSpatialObject< 3 > MaskSpatialObjectType;
+
+  /** Fixed image cast to the registration pixel type, reused while m_FixedImage is unchanged */
+  RegistrationImageType::Pointer m_CachedFixedImage;
+  const mitk::Image* m_CachedFixedImageSource;
+  itk::ModifiedTimeType m_CachedFixedImageMTime;
+
+  /** Spatial object of the (inverted) fixed image mask, reused while m_FixedImageMask is unchanged */
+  MaskSpatialObjectType::Pointer m_CachedFixedMask;
+  const mitk::Image* m_CachedFixedMaskSource;
+  itk::ModifiedTimeType m_CachedFixedMaskMTime;
+
+  /** Returns the spatial object for the fixed image mask, rebuilt only if the mask changed */
+  MaskSpatialObjectType* GetFixedMaskSpatialObject();
+
   /**
    * @brief The method takes two itk::Images and performs a multi-scale registration on them
    *
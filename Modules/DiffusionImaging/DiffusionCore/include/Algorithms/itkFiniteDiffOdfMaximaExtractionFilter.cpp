@@ -62,35 +62,49 @@ FiniteDiffOdfMaximaExtractionFilter< PixelType, ShOrder, NrOdfDirections>
 
 template< class PixelType, int ShOrder, int NrOdfDirections >
 void FiniteDiffOdfMaximaExtractionFilter< PixelType, ShOrder, NrOdfDirections>
-::FindCandidatePeaks(OdfType& odf, double thr, std::vector< DirectionType >& container)
+::FindCandidatePeaks(const float* odf, double thr, std::vector< DirectionType >& container)
 {
-  double gfa = odf.GetGeneralizedFractionalAnisotropy();
+  // generalized fractional anisotropy, see OrientationDistributionFunction::GetGeneralizedFractionalAnisotropy()
+  double mean = 0;
+  double std = 0;
+  double rms = 0;
+  for (int i=0; i<NrOdfDirections; i++)
+    mean += odf[i];
+  mean /= NrOdfDirections;
+  for (int i=0; i<NrOdfDirections; i++)
+  {
+    std += (odf[i] - mean) * (odf[i] - mean);
+    rms += odf[i]*odf[i];
+  }
+  std *= NrOdfDirections;
+  rms *= NrOdfDirections - 1;
+  double gfa = rms==0 ? 0 : sqrt(std/rms);
+
   //Find the peaks using a finite difference method
-  bool flag = true;
-  vnl_vector_fixed< bool, NrOdfDirections > used; used.fill(false);
-  //Find the peaks
+  std::vector< bool > used(NrOdfDirections, false);
   for (int i=0; i<NrOdfDirections; i++)
   {
     if (used[i])
       continue;
 
-    double val = odf.GetElement(i);
+    double val = odf[i];
     if (val>thr && val*gfa>m_AbsolutePeakThreshold)  // limit to one hemisphere ???
     {
-      flag = true;
-      std::vector< int > neighbours = odf.GetNeighbors(i);
-      for (unsigned int j=0; j<neighbours.size(); j++)
-        if (val<=odf.GetElement(neighbours.at(j)))
+      const unsigned int* first = m_Neighbors.data() + m_NeighborOffsets[i];
+      const unsigned int* last = m_Neighbors.data() + m_NeighborOffsets[i+1];
+      bool flag = true;
+      for (const unsigned int* n=first; n!=last; ++n)
+        if (val<=odf[*n])
         {
           flag = false;
           break;
         }
       if (flag)   // point is a peak
       {
-        container.push_back(odf.GetDirection(i).normalize());
+        container.push_back(m_OdfDirections[i]);
         used[i] = true;
-        for (unsigned int j=0; j<neighbours.size(); j++)
-          used[neighbours.at(j)] = true;
+        for (const unsigned int* n=first; n!=last; ++n)
+          used[*n] = true;
       }
     }
   }
@@ -241,23 +255,26 @@ void FiniteDiffOdfMaximaExtractionFilter< PixelType, ShOrder, NrOdfDirections>
   m_NumDirectionsImage->Allocate();
   m_NumDirectionsImage->FillBuffer(0);
 
-  // calculate SH basis
-  OdfType odf;
+  // calculate SH basis and neighbourhood of the sampling points once, they are shared by all threads
   vnl_matrix< double > sphCoords;
-  std::vector< DirectionType > dirs;
+  m_OdfDirections.clear();
+  m_NeighborOffsets.assign(1, 0);
+  m_Neighbors.clear();
   for (int i=0; i<NrOdfDirections; i++)
   {
-    DirectionType odf_dir;
-    odf_dir[0] = odf.GetDirection(i)[0];
-    odf_dir[1] = odf.GetDirection(i)[1];
-    odf_dir[2] = odf.GetDirection(i)[2];
-    dirs.push_back(odf_dir);
+    DirectionType odf_dir = OdfType::GetDirection(i);
+    m_OdfDirections.push_back(odf_dir.normalize());
+
+    std::vector< int > neighbours = OdfType::GetNeighbors(i);
+    m_Neighbors.insert(m_Neighbors.end(), neighbours.begin(), neighbours.end());
+    m_NeighborOffsets.push_back(m_Neighbors.size());
   }
-  CreateDirMatrix(dirs, sphCoords);                          // convert candidate peaks to spherical angles
+  CreateDirMatrix(m_OdfDirections, sphCoords);                          // convert candidate peaks to spherical angles
   if (m_Toolkit==Toolkit::MRTRIX)
     m_ShBasis = mitk::sh::CalcShBasisForDirections(ShOrder, sphCoords);
   else
     m_ShBasis = mitk::sh::CalcShBasisForDirections(ShOrder, sphCoords, false);
+  m_ShBasisTransposed = m_ShBasis.transpose();
 
   MITK_INFO << "Starting finite differences maximum extraction";
   MITK_INFO << "ODF sampling points: " << NrOdfDirections;
@@ -284,131 +301,140 @@ void FiniteDiffOdfMaximaExtractionFilter< PixelType, ShOrder, NrOdfDirections>
 
   ImageRegionConstIterator< CoefficientImageType > cit(ShCoeffImage, outputRegionForThread );
 
-  OdfType odf;
+  // the ODFs of a chunk of masked voxels are sampled by one matrix product
+  const unsigned int chunkSize = 32;
+  std::vector< float > coeffs(chunkSize*m_NumCoeffs);
+  std::vector< float > odfs(chunkSize*NrOdfDirections);
+  std::vector< typename CoefficientImageType::IndexType > indices;
+  std::vector< CoefficientPixelType > pixels;
   while( !cit.IsAtEnd() )
   {
-    typename CoefficientImageType::IndexType idx3 = cit.GetIndex();
-    if (m_MaskImage->GetPixel(idx3)==0)
+    indices.clear();
+    pixels.clear();
+    for (; indices.size()<chunkSize && !cit.IsAtEnd(); ++cit)
     {
-      ++cit;
-      continue;
-    }
+      if (m_MaskImage->GetPixel(cit.GetIndex())==0)
+        continue;
 
-    CoefficientPixelType c = cit.Get();
-
-    // calculate ODF
-    double max = 0;
-    odf.Fill(0.0);
-    for (int i=0; i<NrOdfDirections; i++)
-    {
+      CoefficientPixelType c = cit.Get();
       for (int j=0; j<m_NumCoeffs; j++)
-        odf[i] += c[j]*m_ShBasis(i,j);
-      if (odf[i]>max)
-        max = odf[i];
-    }
-    if (max<0.0001)
-    {
-      ++cit;
-      continue;
+        coeffs[pixels.size()*m_NumCoeffs + j] = c[j];
+      indices.push_back(cit.GetIndex());
+      pixels.push_back(c);
     }
+    mitk::sh::EvaluateSh(m_ShBasisTransposed, coeffs.data(), pixels.size(), odfs.data());
 
-    std::vector< DirectionType > candidates, peaks, temp;
-    peaks.clear();
-    max *= m_PeakThreshold;                         // relative threshold
-    FindCandidatePeaks(odf, max, candidates);       // find all local maxima
-    candidates = MeanShiftClustering(candidates);   // cluster maxima
-
-    vnl_matrix<double> sphCoords;
-    CreateDirMatrix(candidates, sphCoords);                // convert candidate peaks to spherical angles
-    vnl_matrix< float > shBasis;
-    if (m_Toolkit==Toolkit::MRTRIX)
-      shBasis = mitk::sh::CalcShBasisForDirections(ShOrder, sphCoords);
-    else
-      shBasis = mitk::sh::CalcShBasisForDirections(ShOrder, sphCoords, false);
-
-    max = 0.0;
-    for (unsigned int i=0; i<candidates.size(); i++)         // scale peaks according to ODF value
-    {
-      double val = 0;
-      for (int j=0; j<m_NumCoeffs; j++)
-        val += c[j]*shBasis(i,j);
-      if (val>max)
-        max = val;
-      peaks.push_back(candidates[i]*val);
-    }
-    std::sort( peaks.begin(), peaks.end(), CompareVectors );  // sort peaks
+    for (unsigned int v=0; v<pixels.size(); v++)
+      ExtractPeaks(pixels[v], odfs.data() + v*NrOdfDirections, indices[v]);
+  }
+  MITK_INFO << "Thread " << threadID << " finished extraction";
+}
 
-    // kick out directions to close to a larger direction (too far away to cluster but too close to keep)
-    unsigned int m = peaks.size();
-    if ( m>m_MaxNumPeaks )
-      m = m_MaxNumPeaks;
-    for (unsigned int i=0; i<m; i++)
-    {
-      DirectionType v1 = peaks.at(i);
-      double val = v1.magnitude();
-      if (val<max*m_PeakThreshold || val<m_AbsolutePeakThreshold)
-        break;
+template< class PixelType, int ShOrder, int NrOdfDirections >
+void FiniteDiffOdfMaximaExtractionFilter< PixelType, ShOrder, NrOdfDirections>
+::ExtractPeaks(const CoefficientPixelType& c, const float* odf, const typename CoefficientImageType::IndexType& idx3)
+{
+  double max = 0;
+  for (int i=0; i<NrOdfDirections; i++)
+    if (odf[i]>max)
+      max = odf[i];
+  if (max<0.0001)
+    return;
+
+  std::vector< DirectionType > candidates, peaks, temp;
+  peaks.clear();
+  max *= m_PeakThreshold;                         // relative threshold
+  FindCandidatePeaks(odf, max, candidates);       // find all local maxima
+  candidates = MeanShiftClustering(candidates);   // cluster maxima
+
+  vnl_matrix<double> sphCoords;
+  CreateDirMatrix(candidates, sphCoords);                // convert candidate peaks to spherical angles
+  vnl_matrix< float > shBasis;
+  if (m_Toolkit==Toolkit::MRTRIX)
+    shBasis = mitk::sh::CalcShBasisForDirections(ShOrder, sphCoords);
+  else
+    shBasis = mitk::sh::CalcShBasisForDirections(ShOrder, sphCoords, false);
 
-      bool flag = true;
-      for (unsigned int j=0; j<peaks.size(); j++)
-        if (i!=j)
+  max = 0.0;
+  for (unsigned int i=0; i<candidates.size(); i++)         // scale peaks according to ODF value
+  {
+    double val = 0;
+    for (int j=0; j<m_NumCoeffs; j++)
+      val += c[j]*shBasis(i,j);
+    if (val>max)
+      max = val;
+    peaks.push_back(candidates[i]*val);
+  }
+  std::sort( peaks.begin(), peaks.end(), CompareVectors );  // sort peaks
+
+  // kick out directions to close to a larger direction (too far away to cluster but too close to keep)
+  unsigned int m = peaks.size();
+  if ( m>m_MaxNumPeaks )
+    m = m_MaxNumPeaks;
+  for (unsigned int i=0; i<m; i++)
+  {
+    DirectionType v1 = peaks.at(i);
+    double val = v1.magnitude();
+    if (val<max*m_PeakThreshold || val<m_AbsolutePeakThreshold)
+      break;
+
+    bool flag = true;
+    for (unsigned int j=0; j<peaks.size(); j++)
+      if (i!=j)
+      {
+        DirectionType v2 = peaks.at(j);
+        double val2 = v2.magnitude();
+        double angle = fabs(dot_product(v1,v2)/(val*val2));
+        if (angle>m_AngularThreshold && val<val2)
         {
-          DirectionType v2 = peaks.at(j);
-          double val2 = v2.magnitude();
-          double angle = fabs(dot_product(v1,v2)/(val*val2));
-          if (angle>m_AngularThreshold && val<val2)
-          {
-            flag = false;
-            break;
-          }
+          flag = false;
+          break;
         }
+      }
 
-      if (flag)
-        temp.push_back(v1);
-    }
-    peaks = temp;
+    if (flag)
+      temp.push_back(v1);
+  }
+  peaks = temp;
 
-    itk::Index<4> idx4; idx4[0] = idx3[0]; idx4[1] = idx3[1]; idx4[2] = idx3[2];
+  itk::Index<4> idx4; idx4[0] = idx3[0]; idx4[1] = idx3[1]; idx4[2] = idx3[2];
 
-    // fill output image
-    unsigned int num = peaks.size();
-    if ( num>m_MaxNumPeaks )
-      num = m_MaxNumPeaks;
-    for (unsigned int i=0; i<num; i++)
+  // fill output image
+  unsigned int num = peaks.size();
+  if ( num>m_MaxNumPeaks )
+    num = m_MaxNumPeaks;
+  for (unsigned int i=0; i<num; i++)
+  {
+    DirectionType dir = peaks.at(i);
+    switch (m_NormalizationMethod)
     {
-      DirectionType dir = peaks.at(i);
-      switch (m_NormalizationMethod)
-      {
-      case NO_NORM:
-        break;
-      case SINGLE_VEC_NORM:
-        dir.normalize();
-        break;
-      case MAX_VEC_NORM:
-        dir /= max;
-        break;
-      }
+    case NO_NORM:
+      break;
+    case SINGLE_VEC_NORM:
+      dir.normalize();
+      break;
+    case MAX_VEC_NORM:
+      dir /= max;
+      break;
+    }
 
-      if (m_ApplyDirectionMatrix)
-        dir = m_MaskImage->GetDirection()*dir;
+    if (m_ApplyDirectionMatrix)
+      dir = m_MaskImage->GetDirection()*dir;
 
-      if (m_FlipX)
-        dir[0] = -dir[0];
-      if (m_FlipY)
-        dir[1] = -dir[1];
-      if (m_FlipZ)
-        dir[2] = -dir[2];
+    if (m_FlipX)
+      dir[0] = -dir[0];
+    if (m_FlipY)
+      dir[1] = -dir[1];
+    if (m_FlipZ)
+      dir[2] = -dir[2];
 
-      for (unsigned int j = 0; j<3; j++)
-      {
-        idx4[3] = i*3 + j;
-        m_PeakImage->SetPixel(idx4, dir[j]);
-      }
+    for (unsigned int j = 0; j<3; j++)
+    {
+      idx4[3] = i*3 + j;
+      m_PeakImage->SetPixel(idx4, dir[j]);
     }
-    m_NumDirectionsImage->SetPixel(idx3, num);
-    ++cit;
   }
-  MITK_INFO << "Thread " << threadID << " finished extraction";
+  m_NumDirectionsImage->SetPixel(idx3, num);
 }
 
 // convert cartesian to spherical coordinates
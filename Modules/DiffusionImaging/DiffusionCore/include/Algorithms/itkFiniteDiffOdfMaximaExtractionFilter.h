@@ -105,8 +105,11 @@ Image< unsigned char, 3 > >
     void ThreadedGenerateData( const OutputImageRegionType &outputRegionForThread, ThreadIdType threadID );
     void AfterThreadedGenerateData();
 
-    /** Extract all local maxima from the densely sampled ODF surface. Thresholding possible. **/
-    void FindCandidatePeaks(OdfType& odf, double odfMax, std::vector< DirectionType >& inDirs);
+    /** Extract all local maxima from the densely sampled ODF surface (NrOdfDirections values). Thresholding possible. **/
+    void FindCandidatePeaks(const float* odf, double odfMax, std::vector< DirectionType >& inDirs);
+
+    /** Extract, cluster and threshold the peaks of one voxel and write them to the output images. **/
+    void ExtractPeaks(const CoefficientPixelType& c, const float* odf, const typename CoefficientImageType::IndexType& idx3);
 
     /** Cluster input directions within a certain angular threshold **/
     std::vector< DirectionType > MeanShiftClustering(std::vector< DirectionType >& inDirs);
@@ -121,6 +124,10 @@ Image< unsigned char, 3 > >
     double                                      m_PeakThreshold;        ///< threshold on the peak length relative to the largest peak inside the current voxel
     double                                      m_AbsolutePeakThreshold;///< hard threshold on the peak length of all local maxima
     vnl_matrix< float >                         m_ShBasis;              ///< container for evaluated SH base functions
+    vnl_matrix< float >                         m_ShBasisTransposed;    ///< SH base functions (coefficients x directions) used to sample the ODFs of several voxels at once
+    std::vector< DirectionType >                m_OdfDirections;        ///< normalized ODF sampling directions
+    std::vector< unsigned int >                 m_NeighborOffsets;      ///< neighbours of sampling point i are m_Neighbors[m_NeighborOffsets[i]] to m_Neighbors[m_NeighborOffsets[i+1]-1]
+    std::vector< unsigned int >                 m_Neighbors;            ///< concatenated neighbour indices of all sampling points
     double                                      m_ClusteringThreshold;  ///< directions closer together than the specified angular threshold will be clustered (in rad)
     double                                      m_AngularThreshold;     ///< directions closer together than the specified threshold that remain after clustering are discarded (largest is kept) (in rad)
     const int                                   m_NumCoeffs;            ///< number of spherical harmonics coefficients
@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "itkImageToImageFilter.h"
 #include "itkVectorImage.h"
+#include <vector>
 
 
 namespace itk{
@@ -83,6 +84,30 @@ namespace itk{
      * If this flag is true the filter uses a method which is optimized for Rician distributed noise.
      */
     itkSetMacro(UseRicianAdaption, bool)
+    /**
+     * @brief Set flag to use the blockwise algorithm
+     *
+     * Instead of comparing the patches of every voxel pair, the patch distances of a block of voxels are computed for one search offset at a time
+     * from an image of squared differences with a separable box filter. The weights are identical to the voxelwise algorithm, only the summation
+     * order differs, so the output differs by at most one gray value due to rounding. For joint information with Rician adaption only the squared
+     * values are averaged (the voxelwise algorithm additionally mixes in the unsquared values).
+     * Default is false.
+     */
+    itkSetMacro(UseBlockwiseAlgorithm, bool)
+    /**
+     * @brief Set the mean ratio for the pre-selection of the blockwise algorithm
+     *
+     * Neighbors are only used if the ratio of the local patch means is inside [ratio, 1/ratio]. Enabling the pre-selection changes the result.
+     * Default is 0 (disabled), a typical value is 0.95.
+     */
+    itkSetMacro(PreSelectionMeanRatio, double)
+    /**
+     * @brief Set the variance ratio for the pre-selection of the blockwise algorithm
+     *
+     * Neighbors are only used if the ratio of the local patch variances is inside [ratio, 1/ratio]. Enabling the pre-selection changes the result.
+     * Default is 0 (disabled), a typical value is 0.5.
+     */
+    itkSetMacro(PreSelectionVarianceRatio, double)
     /**
      * @brief Get the amount of calculated Voxels
      *
@@ -124,6 +149,15 @@ namespace itk{
      */
     void ThreadedGenerateData( const OutputImageRegionType &outputRegionForThread, ThreadIdType) override;
 
+    /**
+     * @brief Blockwise denoising procedure, see SetUseBlockwiseAlgorithm()
+     */
+    void BlockwiseGenerateData( const OutputImageRegionType &outputRegionForThread );
+
+    /**
+     * @brief Sums up the values in a (2 * radius + 1)³ neighborhood of each voxel of a buffer of the given size (x fastest).
+     */
+    static void BoxFilter( std::vector<double>& values, std::vector<double>& line, const int size[3], int radius );
 
 
   private:
@@ -132,6 +166,9 @@ namespace itk{
     int m_ComparisonRadius;                           ///< Radius of the comparisonblock.
     bool m_UseJointInformation;                       ///< Flag to use joint information.
     bool m_UseRicianAdaption;                         ///< Flag to use rician adaption.
+    bool m_UseBlockwiseAlgorithm;                     ///< Flag to use the blockwise algorithm.
+    double m_PreSelectionMeanRatio;                   ///< Mean ratio for the pre-selection of neighbors, 0 disables it.
+    double m_PreSelectionVarianceRatio;               ///< Variance ratio for the pre-selection of neighbors, 0 disables it.
     unsigned int m_CurrentVoxelCount;                 ///< Amount of processed voxels.
     double m_Variance;                                ///< Estimated noise variance.
     typename MaskImageType::Pointer m_Mask;           ///< Pointer to the mask image.
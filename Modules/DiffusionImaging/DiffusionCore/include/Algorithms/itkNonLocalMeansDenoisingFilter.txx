@@ -28,6 +28,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkNeighborhoodIterator.h"
 #include <itkImageRegionIteratorWithIndex.h>
 #include <vector>
+#include <algorithm>
 
 namespace itk {
 
@@ -39,6 +40,9 @@ NonLocalMeansDenoisingFilter< TPixelType >
     m_ComparisonRadius(1),
     m_UseJointInformation(false),
     m_UseRicianAdaption(false),
+    m_UseBlockwiseAlgorithm(false),
+    m_PreSelectionMeanRatio(0),
+    m_PreSelectionVarianceRatio(0),
     m_Variance(1),
     m_Mask(nullptr)
 {
@@ -56,6 +60,9 @@ NonLocalMeansDenoisingFilter< TPixelType >
   MITK_INFO << "Noisevariance: " << m_Variance;
   MITK_INFO << "Use Rician Adaption: " << std::boolalpha << m_UseRicianAdaption;
   MITK_INFO << "Use Joint Information: " << std::boolalpha << m_UseJointInformation;
+  MITK_INFO << "Use Blockwise Algorithm: " << std::boolalpha << m_UseBlockwiseAlgorithm;
+  if (m_UseBlockwiseAlgorithm && (m_PreSelectionMeanRatio > 0 || m_PreSelectionVarianceRatio > 0))
+    MITK_INFO << "Pre-selection mean/variance ratio: " << m_PreSelectionMeanRatio << "/" << m_PreSelectionVarianceRatio;
 
 
   typename InputImageType::Pointer inputImagePointer = static_cast< InputImageType * >( this->ProcessObject::GetInput(0) );
@@ -127,6 +134,11 @@ void
 NonLocalMeansDenoisingFilter< TPixelType >
 ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType )
 {
+  if (m_UseBlockwiseAlgorithm)
+  {
+    BlockwiseGenerateData(outputRegionForThread);
+    return;
+  }
 
 
   // initialize iterators
@@ -372,6 +384,247 @@ NonLocalMeansDenoisingFilter< TPixelType >
   MITK_INFO << "One Thread finished calculation";
 }
 
+template< class TPixelType >
+void
+NonLocalMeansDenoisingFilter< TPixelType >
+::BoxFilter(std::vector<double>& values, std::vector<double>& line, const int size[3], int radius)
+{
+  // separable box filter. the window is cropped at the borders of the buffer, so only values inside are summed up.
+  const int strides[3] = {1, size[0], size[0]*size[1]};
+  for (int d = 0; d < 3; ++d)
+  {
+    const int n = size[d];
+    const int d1 = (d+1)%3;
+    const int d2 = (d+2)%3;
+    line.resize(n+1);
+    for (int b = 0; b < size[d2]; ++b)
+    {
+      for (int a = 0; a < size[d1]; ++a)
+      {
+        double* start = &values[a*strides[d1] + b*strides[d2]];
+        line[0] = 0;
+        for (int i = 0; i < n; ++i)
+          line[i+1] = line[i] + start[i*strides[d]];
+        for (int i = 0; i < n; ++i)
+          start[i*strides[d]] = line[std::min(i+radius, n-1)+1] - line[std::max(i-radius, 0)];
+      }
+    }
+  }
+}
+
+template< class TPixelType >
+void
+NonLocalMeansDenoisingFilter< TPixelType >
+::BlockwiseGenerateData(const OutputImageRegionType& outputRegionForThread)
+{
+  typename OutputImageType::Pointer outputImage = static_cast< OutputImageType * >(this->ProcessObject::GetOutput(0));
+  typename InputImageType::Pointer inputImagePointer = static_cast< InputImageType * >( this->ProcessObject::GetInput(0) );
+
+  const int numChannels = inputImagePointer->GetVectorLength();
+  const typename InputImageType::RegionType imageRegion = inputImagePointer->GetLargestPossibleRegion();
+  const TPixelType* inBuffer = inputImagePointer->GetBufferPointer();
+  TPixelType* outBuffer = outputImage->GetBufferPointer();
+
+  // without joint information each channel is denoised on its own
+  const int numPasses = m_UseJointInformation ? 1 : numChannels;
+  const int passChannels = m_UseJointInformation ? numChannels : 1;
+  const bool preSelection = m_PreSelectionMeanRatio > 0 || m_PreSelectionVarianceRatio > 0;
+  const int blockSize = 32;
+
+  int imageStart[3];
+  int imageEnd[3];
+  for (int d = 0; d < 3; ++d)
+  {
+    imageStart[d] = imageRegion.GetIndex(d);
+    imageEnd[d] = imageStart[d] + imageRegion.GetSize(d);
+  }
+
+  // crops the box [lower, upper) grown by radius to the image
+  auto growBox = [&](const int lower[3], const int upper[3], int radius, int grownLower[3], int grownUpper[3], int grownSize[3])
+  {
+    for (int d = 0; d < 3; ++d)
+    {
+      grownLower[d] = std::max(lower[d] - radius, imageStart[d]);
+      grownUpper[d] = std::min(upper[d] + radius, imageEnd[d]);
+      grownSize[d] = grownUpper[d] - grownLower[d];
+    }
+  };
+  auto inputValue = [&](int x, int y, int z, int c) -> double
+  {
+    typename InputImageType::IndexType idx = {{x, y, z}};
+    return inBuffer[inputImagePointer->ComputeOffset(idx)*numChannels + c];
+  };
+
+  // buffers are reused for all blocks, channels and offsets
+  std::vector<double> ssd;            // summed squared differences of the patches
+  std::vector<double> pairs;          // number of voxel pairs inside the image per patch
+  std::vector<double> line;
+  std::vector<double> weightSum;
+  std::vector<double> valueSum;
+  std::vector<double> localMean;
+  std::vector<double> localVariance;
+  std::vector<double> localCount;
+  std::vector<char> mask;
+
+  const int regionStart[3] = { (int)outputRegionForThread.GetIndex(0), (int)outputRegionForThread.GetIndex(1), (int)outputRegionForThread.GetIndex(2) };
+  const int regionEnd[3] = { regionStart[0] + (int)outputRegionForThread.GetSize(0), regionStart[1] + (int)outputRegionForThread.GetSize(1), regionStart[2] + (int)outputRegionForThread.GetSize(2) };
+
+  for (int bz = regionStart[2]; bz < regionEnd[2]; bz += blockSize)
+  for (int by = regionStart[1]; by < regionEnd[1]; by += blockSize)
+  for (int bx = regionStart[0]; bx < regionEnd[0]; bx += blockSize)
+  {
+    if (this->GetAbortGenerateData())
+      return;
+
+    const int blockLower[3] = {bx, by, bz};
+    const int blockUpper[3] = {std::min(bx + blockSize, regionEnd[0]), std::min(by + blockSize, regionEnd[1]), std::min(bz + blockSize, regionEnd[2])};
+    const int blockSizes[3] = {blockUpper[0]-bx, blockUpper[1]-by, blockUpper[2]-bz};
+    const int numBlockVoxels = blockSizes[0]*blockSizes[1]*blockSizes[2];
+
+    // the patches of the block voxels
+    int patchLower[3], patchUpper[3], patchSize[3];
+    growBox(blockLower, blockUpper, m_ComparisonRadius, patchLower, patchUpper, patchSize);
+    const int numPatchVoxels = patchSize[0]*patchSize[1]*patchSize[2];
+
+    // the search windows of the block voxels and their patches, used for the pre-selection
+    int searchLower[3], searchUpper[3], searchSize[3];
+    int statsLower[3], statsUpper[3], statsSize[3];
+    growBox(blockLower, blockUpper, m_SearchRadius, searchLower, searchUpper, searchSize);
+    growBox(searchLower, searchUpper, m_ComparisonRadius, statsLower, statsUpper, statsSize);
+
+    mask.resize(numBlockVoxels);
+    for (int z = bz, v = 0; z < blockUpper[2]; ++z)
+      for (int y = by; y < blockUpper[1]; ++y)
+        for (int x = bx; x < blockUpper[0]; ++x, ++v)
+        {
+          typename MaskImageType::IndexType idx = {{x, y, z}};
+          mask[v] = m_Mask->GetPixel(idx) != 0;
+        }
+
+    for (int pass = 0; pass < numPasses; ++pass)
+    {
+      const int firstChannel = m_UseJointInformation ? 0 : pass;
+
+      if (preSelection)
+      {
+        // local mean and variance of the patch around each voxel of the search windows
+        const int numStatsVoxels = statsSize[0]*statsSize[1]*statsSize[2];
+        localMean.assign(numStatsVoxels, 0);
+        localVariance.assign(numStatsVoxels, 0);
+        localCount.assign(numStatsVoxels, passChannels);
+        for (int z = statsLower[2], v = 0; z < statsUpper[2]; ++z)
+          for (int y = statsLower[1]; y < statsUpper[1]; ++y)
+            for (int x = statsLower[0]; x < statsUpper[0]; ++x, ++v)
+              for (int c = firstChannel; c < firstChannel + passChannels; ++c)
+              {
+                double val = inputValue(x, y, z, c);
+                localMean[v] += val;
+                localVariance[v] += val*val;
+              }
+        BoxFilter(localMean, line, statsSize, m_ComparisonRadius);
+        BoxFilter(localVariance, line, statsSize, m_ComparisonRadius);
+        BoxFilter(localCount, line, statsSize, m_ComparisonRadius);
+        for (int v = 0; v < numStatsVoxels; ++v)
+        {
+          localMean[v] /= localCount[v];
+          localVariance[v] = localVariance[v]/localCount[v] - localMean[v]*localMean[v];
+        }
+      }
+      auto statsIndex = [&](int x, int y, int z) { return ((z-statsLower[2])*statsSize[1] + (y-statsLower[1]))*statsSize[0] + (x-statsLower[0]); };
+
+      weightSum.assign(numBlockVoxels, 0);
+      valueSum.assign(numBlockVoxels*passChannels, 0);
+
+      for (int oz = -m_SearchRadius; oz <= m_SearchRadius; ++oz)
+      for (int oy = -m_SearchRadius; oy <= m_SearchRadius; ++oy)
+      for (int ox = -m_SearchRadius; ox <= m_SearchRadius; ++ox)
+      {
+        // squared differences between each voxel and its shifted counterpart
+        ssd.assign(numPatchVoxels, 0);
+        pairs.assign(numPatchVoxels, 0);
+        for (int z = patchLower[2], v = 0; z < patchUpper[2]; ++z)
+          for (int y = patchLower[1]; y < patchUpper[1]; ++y)
+            for (int x = patchLower[0]; x < patchUpper[0]; ++x, ++v)
+            {
+              if (x+ox < imageStart[0] || x+ox >= imageEnd[0] || y+oy < imageStart[1] || y+oy >= imageEnd[1] || z+oz < imageStart[2] || z+oz >= imageEnd[2])
+                continue;
+              double sum = 0;
+              for (int c = firstChannel; c < firstChannel + passChannels; ++c)
+              {
+                double diff = inputValue(x, y, z, c) - inputValue(x+ox, y+oy, z+oz, c);
+                sum += diff*diff;
+              }
+              ssd[v] = sum;
+              pairs[v] = 1;
+            }
+        BoxFilter(ssd, line, patchSize, m_ComparisonRadius);
+        BoxFilter(pairs, line, patchSize, m_ComparisonRadius);
+
+        for (int z = bz, v = 0; z < blockUpper[2]; ++z)
+          for (int y = by; y < blockUpper[1]; ++y)
+            for (int x = bx; x < blockUpper[0]; ++x, ++v)
+            {
+              if (!mask[v])
+                continue;
+              const int xj = x+ox, yj = y+oy, zj = z+oz;
+              if (xj < imageStart[0] || xj >= imageEnd[0] || yj < imageStart[1] || yj >= imageEnd[1] || zj < imageStart[2] || zj >= imageEnd[2])
+                continue;
+
+              if (preSelection)
+              {
+                int i = statsIndex(x, y, z);
+                int j = statsIndex(xj, yj, zj);
+                if (m_PreSelectionMeanRatio > 0 && (localMean[i] < m_PreSelectionMeanRatio*localMean[j] || localMean[j] < m_PreSelectionMeanRatio*localMean[i]))
+                  continue;
+                if (m_PreSelectionVarianceRatio > 0 && (localVariance[i] < m_PreSelectionVarianceRatio*localVariance[j] || localVariance[j] < m_PreSelectionVarianceRatio*localVariance[i]))
+                  continue;
+              }
+
+              const int p = ((z-patchLower[2])*patchSize[1] + (y-patchLower[1]))*patchSize[0] + (x-patchLower[0]);
+              double size = pairs[p];
+              if (m_UseJointInformation)
+                size *= numChannels + 1;
+              double w = std::exp( - (ssd[p] / size) / m_Variance);
+              weightSum[v] += w;
+              for (int c = 0; c < passChannels; ++c)
+              {
+                double val = inputValue(xj, yj, zj, firstChannel + c);
+                if (m_UseRicianAdaption)
+                  val *= val;
+                valueSum[v*passChannels + c] += w*val;
+              }
+            }
+      }
+
+      // write the denoised values of this pass
+      for (int z = bz, v = 0; z < blockUpper[2]; ++z)
+        for (int y = by; y < blockUpper[1]; ++y)
+          for (int x = bx; x < blockUpper[0]; ++x, ++v)
+          {
+            typename OutputImageType::IndexType idx = {{x, y, z}};
+            TPixelType* outpix = outBuffer + outputImage->ComputeOffset(idx)*numChannels;
+            for (int c = 0; c < passChannels; ++c)
+            {
+              double a = 0;
+              if (mask[v] && weightSum[v] > 0)
+              {
+                a = valueSum[v*passChannels + c] / weightSum[v];
+                if (m_UseRicianAdaption)
+                  a -= 2 * m_Variance;
+                if (a < 0)
+                  a = 0;
+                a = m_UseRicianAdaption ? std::floor(std::sqrt(a) + 0.5) : std::floor(a + 0.5);
+              }
+              outpix[firstChannel + c] = static_cast<TPixelType>(a);
+            }
+          }
+    }
+    m_CurrentVoxelCount += numBlockVoxels;
+  }
+
+  MITK_INFO << "One Thread finished calculation";
+}
+
 template< class TPixelType >
 void NonLocalMeansDenoisingFilter< TPixelType >::SetInputImage(const InputImageType* image)
 {
@@ -191,33 +191,55 @@ void OdfMaximaExtractionFilter< TOdfPixelType >
 
     m_CandidatePeaks.clear();   // clear peaks of last voxel
 
+    // normalization of the 4th order SH basis functions, independent of phi
+    double norm[15];
+    for (int l=0; l<=4; l=l+2)
+    {
+        for (int m=-l; m<=l; m++)
+        {
+            int j=l*(l+1)/2+m;
+            if (m<0)
+                norm[j] = sqrt(((2*l+1)/(2*itk::Math::pi))*factorial<double>(l+m)/factorial<double>(l-m));
+            else if (m==0)
+                norm[j] = sqrt((2*l+1)/(4*itk::Math::pi));
+            else
+                norm[j] = pow(-1.0,m)*sqrt(((2*l+1)/(2*itk::Math::pi))*factorial<double>(l-m)/factorial<double>(l+m));
+        }
+    }
+    double cosm[5], sinm[5];
+
     for (int adaptiveStepwidth=0; adaptiveStepwidth<=1; adaptiveStepwidth++)
     {
     phi=0;
     while (phi<(2*itk::Math::pi)) // phi exhaustive search 0..pi
     {
+        for (int m=1; m<=4; m++)
+        {
+            cosm[m] = cos(m*phi);
+            sinm[m] = sin(m*phi);
+        }
+
         // calculate 4th order SH representtaion of ODF and according derivative
         for (int l=0; l<=4; l=l+2)
         {
             for (int m=-l; m<=l; m++)
             {
                 int j=l*(l+1)/2+m;
+                mag = norm[j];
                 if (m<0)
                 {
-                    mag = sqrt(((2*l+1)/(2*itk::Math::pi))*factorial<double>(l+m)/factorial<double>(l-m));
-                    Y = mag*cos(m*phi);
-                    Yp = -m*mag*sin(m*phi);
+                    Y = mag*cosm[-m];
+                    Yp = m*mag*sinm[-m];
                 }
                 else if (m==0)
                 {
-                    Y = sqrt((2*l+1)/(4*itk::Math::pi));
+                    Y = mag;
                     Yp = 0;
                 }
                 else
                 {
-                    mag = pow(-1.0,m)*sqrt(((2*l+1)/(2*itk::Math::pi))*factorial<double>(l-m)/factorial<double>(l+m));
-                    Y = mag*sin(m*phi);
-                    Yp = m*mag*cos(m*phi);
+                    Y = mag*sinm[m];
+                    Yp = m*mag*cosm[m];
                 }
                 a[j] = SHcoeff[j]*Y;
                 ap[j] = SHcoeff[j]*Yp;
@@ -21,6 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkImage.h"
 #include "mitkImage.h"
 #include "mitkTbssImage.h"
+#include <vector>
 
 namespace itk
 {
@@ -118,6 +119,24 @@ public:
   itkGetMacro(Projections, Float4DImageType::Pointer)
 
 
+  /** \brief Set additional 4D metric images (e.g. MD, RD, AD) of all study subjects.
+   *
+   * The additional metrics are projected in the same pass as the FA data. Each skeleton voxel receives the value of
+   * the metric at the location where the FA projection found its maximum.
+   */
+  void SetAdditionalMetrics(const std::vector< Float4DImageType::Pointer >& metrics)
+  {
+    m_AdditionalMetrics = metrics;
+  }
+
+
+  /** \brief Returns the skeleton projections of the additional metrics, in the order they were set */
+  std::vector< Float4DImageType::Pointer > GetAdditionalProjections()
+  {
+    return m_AdditionalProjections;
+  }
+
+
 protected:
 
   /** Constructor */
@@ -138,6 +157,12 @@ protected:
 
   Float4DImageType::Pointer m_AllFA;
 
+  std::vector< Float4DImageType::Pointer > m_AdditionalMetrics;
+
+  std::vector< Float4DImageType::Pointer > m_AdditionalProjections;
+
+  Float4DImageType::Pointer AllocateProjection(Float4DImageType::Pointer reference);
+
   int round(float x)
   {
     if (x>0.0) return ((int) (x+0.5));
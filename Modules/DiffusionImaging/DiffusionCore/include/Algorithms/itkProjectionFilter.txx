@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkProjectionFilter.h"
 
 #include "mitkProgressBar.h"
+#include <vector>
 //#include <itkSignedMaurerDistanceMapImageFilter.h>
 
 #define SEARCHSIGMA 10 /* length in linear voxel dimensions */
@@ -42,154 +43,222 @@ namespace itk
 
   void ProjectionFilter::Project()
   {
-    // Contains only code for the projection of FA data. The original FSL code contains some extra lines
-    // For projection of other measurements than FA
+    // The projection of FA data determines the location of the maximum along the search direction.
+    // As in the FSL code for the projection of other measurements, the additional metrics are sampled
+    // at the same locations.
 
     mitk::ProgressBar::GetInstance()->AddStepsToDo( 3 );
 
-    Float4DImageType::Pointer data_4d_projected = Float4DImageType::New();
-    data_4d_projected->SetRegions(m_AllFA->GetRequestedRegion());
-    data_4d_projected->SetDirection(m_AllFA->GetDirection());
-    data_4d_projected->SetSpacing(m_AllFA->GetSpacing());
-    data_4d_projected->SetOrigin(m_AllFA->GetOrigin());
-    data_4d_projected->Allocate();
-    data_4d_projected->FillBuffer(0.0);
-
     Float4DImageType::SizeType size = m_AllFA->GetRequestedRegion().GetSize();
-    long s0 = size[0], s1 = size[1], s2 = size[2], s3 = size[3];
+    int s0 = size[0], s1 = size[1], s2 = size[2], s3 = size[3];
+    const long s01 = (long)s0*s1;
+    const long numPixels3D = s01*s2;
 
-    for(int t=0; t<s3; t++)
+    m_Projections = AllocateProjection(m_AllFA);
+    m_AdditionalProjections.clear();
+    for(unsigned int m=0; m<m_AdditionalMetrics.size(); m++)
     {
-      for(int z=1; z<s2-1; z++)
+      if( m_AdditionalMetrics[m]->GetRequestedRegion().GetSize() != size )
       {
-        for(int y=1; y<s1-1; y++)
-        {
-
-          for(int x=1; x<s0-1; x++)
-          {
-
-            VectorImageType::IndexType ix;
-            ix[0] = x; ix[1] = y; ix[2] = z;
-
-            if(m_Skeleton->GetPixel(ix) != 0)
-            {
-              VectorImageType::PixelType dir = m_Directions->GetPixel(ix);
-
-              Float4DImageType::IndexType ix4d;
-              ix4d[0]=x; ix4d[1]=y; ix4d[2]=z; ix4d[3]=t;
-              float maxval = m_AllFA->GetPixel(ix4d);
-              float maxval_weighted = maxval;
-              float exponentfactor = -0.5 * (dir[0]*dir[0]+dir[1]*dir[1]+dir[2]*dir[2]) / (float)(SEARCHSIGMA*SEARCHSIGMA);
-
-
-              // No tubular structure here
-              if(m_Tube->GetPixel(ix) == 0)
-              {
-                for(int iters=0;iters<2;iters++)
-                {
-                  float distance=0;
-
-                  for(int d=1;d<MAXSEARCHLENGTH;d++)
-                  {
-                    int D=d;
-                    if (iters==1) D=-d;
-
-                    FloatImageType::IndexType ix3d;
-                    int dx = x+dir[0]*D, dy = y+dir[1]*D, dz = z+dir[2]*D;
-                    ix3d[0] = dx; ix3d[1] = dy; ix3d[2] = dz;
-
-                    if(dx<0 || dy<0 || dz<0
-                      || (dx>=s0 && dy<=s1 && dz<=s2))
-                    {
-                      d=MAXSEARCHLENGTH;
-                    }
-                    else if(m_DistanceMap->GetPixel(ix3d)>=distance)
-                    {
-                      float distanceweight = exp(d * d * exponentfactor);
-                      distance = m_DistanceMap->GetPixel(ix3d);
+        itkExceptionMacro(<< "Additional metric " << m << " does not match the size of the FA data.");
+      }
+      m_AdditionalProjections.push_back(AllocateProjection(m_AdditionalMetrics[m]));
+    }
+    const int numMetrics = m_AdditionalMetrics.size();
 
-                      ix4d[0]=x+dir[0]*D; ix4d[1]=y+dir[1]*D; ix4d[2]=z+dir[2]*D; ix4d[3]=t;
+    const float* allFA = m_AllFA->GetBufferPointer();
+    float* projected = m_Projections->GetBufferPointer();
+    std::vector< const float* > metrics;
+    std::vector< float* > metricsProjected;
+    for(int m=0; m<numMetrics; m++)
+    {
+      metrics.push_back(m_AdditionalMetrics[m]->GetBufferPointer());
+      metricsProjected.push_back(m_AdditionalProjections[m]->GetBufferPointer());
+    }
 
-                      if(distanceweight*m_AllFA->GetPixel(ix4d)>maxval_weighted)
-                      {
-                        maxval = m_AllFA->GetPixel(ix4d);
-                        maxval_weighted =  maxval*distanceweight;
-                      }
-                    }
-                    else{
-                      d=MAXSEARCHLENGTH;
-                    }
+    const float* distanceMap = m_DistanceMap->GetBufferPointer();
+    const VectorType* directions = m_Directions->GetBufferPointer();
+    const char* tube = m_Tube->GetBufferPointer();
+    const char* skeleton = m_Skeleton->GetBufferPointer();
 
+    // Linear indices of the skeleton voxels, the image border is not searched
+    std::vector< long > skeletonVoxels;
+    for(int z=1; z<s2-1; z++)
+      for(int y=1; y<s1-1; y++)
+        for(int x=1; x<s0-1; x++)
+        {
+          const long ix = x + y*s0 + z*s01;
+          if(skeleton[ix] != 0)
+            skeletonVoxels.push_back(ix);
+        }
+    const long numSkeletonVoxels = skeletonVoxels.size();
 
+    mitk::ProgressBar::GetInstance()->Progress();
 
-                  }
+    // Distance weights along the perpendicular direction only depend on the squared length of the
+    // direction vector (1, 2 or 3) and on the step
+    float sheetWeights[4][MAXSEARCHLENGTH];
+    for(int l=0; l<4; l++)
+    {
+      float exponentfactor = -0.5 * l / (float)(SEARCHSIGMA*SEARCHSIGMA);
+      for(int d=0; d<MAXSEARCHLENGTH; d++)
+        sheetWeights[l][d] = exp(d * d * exponentfactor);
+    }
 
-                }
-              }
+    // In-plane search positions of tubular structures. For each position the offsets along the ray from the centre
+    // are stored, the distance map has to increase along this ray.
+    struct TubeCandidate
+    {
+      int dx, dy;
+      float weight;
+      unsigned int firstStep, endStep;
+    };
+    std::vector< TubeCandidate > tubeCandidates;
+    std::vector< int > tubeSteps; // pairs of in-plane (dx,dy) offsets, two pairs per step
+    for(int dy=-MAXSEARCHLENGTH; dy<=MAXSEARCHLENGTH;dy++) {
+      for(int dx=-MAXSEARCHLENGTH; dx<=MAXSEARCHLENGTH; dx++) {
+
+        float r=sqrt((float)(dx*dx+dy*dy));
+        if (r>0)
+        {
+          TubeCandidate candidate;
+          candidate.dx = dx;
+          candidate.dy = dy;
+          candidate.weight = exp(-0.5 * (dx*dx+dy*dy) / (float)(SEARCHSIGMA*SEARCHSIGMA) );
+          candidate.firstStep = tubeSteps.size()/4;
 
-              // Tubular structure
-              else
-              {
-                for(int dy=-MAXSEARCHLENGTH; dy<=MAXSEARCHLENGTH;dy++) {
-                  for(int dx=-MAXSEARCHLENGTH; dx<=MAXSEARCHLENGTH; dx++) {
+          for(float rr=1; rr<=r+0.1; rr++) /* search outwards from centre to current voxel - test that distancemap always increasing */
+          {
+            tubeSteps.push_back(round(rr*dx/r));
+            tubeSteps.push_back(round(rr*dy/r));
+            tubeSteps.push_back(round((rr+1)*dx/r));
+            tubeSteps.push_back(round((rr+1)*dy/r));
+          }
+          candidate.endStep = tubeSteps.size()/4;
+          tubeCandidates.push_back(candidate);
+        }
+      }
+    }
+    const int numTubeCandidates = tubeCandidates.size();
 
-                    float distanceweight = exp(-0.5 * (dx*dx+dy*dy) / (float)(SEARCHSIGMA*SEARCHSIGMA) );
-                    float r=sqrt((float)(dx*dx+dy*dy));
+    mitk::ProgressBar::GetInstance()->Progress();
 
-                    if (r>0)
-                    {
-                      int allok=1;
+#pragma omp parallel for schedule(dynamic)
+    for(long i=0; i<numSkeletonVoxels; i++)
+    {
+      const long ix = skeletonVoxels[i];
+      const int x = ix % s0;
+      const int y = (ix / s0) % s1;
+      const int z = ix / s01;
 
-                      for(float rr=1; rr<=r+0.1; rr++) /* search outwards from centre to current voxel - test that distancemap always increasing */
-                      {
+      // The search positions only depend on the skeleton and the distance map, so they are shared by all
+      // subjects and metrics
+      std::vector< long > positions;
+      std::vector< float > weights;
 
-                        int dx1=round(rr*dx/r);
-                        int dy1=round(rr*dy/r);
-                        int dx2=round((rr+1)*dx/r);
-                        int dy2=round((rr+1)*dy/r);
+      if(tube[ix] == 0)
+      {
+        // No tubular structure here
+        const VectorType& dir = directions[ix];
+        const float* weightsAlongDir = sheetWeights[dir[0]*dir[0]+dir[1]*dir[1]+dir[2]*dir[2]];
 
-                        RealImageType::IndexType ix1, ix2;
-                        ix1[0]=x+dx1; ix1[1]=y+dy1; ix1[2]=z;
-                        ix2[0]=x+dx2; ix2[1]=y+dy2; ix2[2]=z;
-                        if(m_DistanceMap->GetPixel(ix1) > m_DistanceMap->GetPixel(ix2) )
-                        {
-                          allok=0;
-                        }
+        for(int iters=0;iters<2;iters++)
+        {
+          float distance=0;
 
-                      }
+          for(int d=1;d<MAXSEARCHLENGTH;d++)
+          {
+            int D=d;
+            if (iters==1) D=-d;
 
-                      ix4d[0]=x+dx; ix4d[1]=y+dy, ix4d[2]=z; ix4d[3]=t;
-                      if( allok && (distanceweight * m_AllFA->GetPixel(ix4d) > maxval_weighted) )
-                      {
-                        maxval = m_AllFA->GetPixel(ix4d);
-                        maxval_weighted = maxval * distanceweight;
-                      }
+            int dx = x+dir[0]*D, dy = y+dir[1]*D, dz = z+dir[2]*D;
+            if(dx<0 || dy<0 || dz<0 || dx>=s0 || dy>=s1 || dz>=s2)
+              break;
 
+            // stop as soon as the distance map decreases
+            const long pos = dx + dy*s0 + dz*s01;
+            if(distanceMap[pos] < distance)
+              break;
+            distance = distanceMap[pos];
 
-                    }
+            positions.push_back(pos);
+            weights.push_back(weightsAlongDir[d]);
+          }
+        }
+      }
+      else
+      {
+        // Tubular structure
+        for(int c=0; c<numTubeCandidates; c++)
+        {
+          const TubeCandidate& candidate = tubeCandidates[c];
+          if(x+candidate.dx<0 || x+candidate.dx>=s0 || y+candidate.dy<0 || y+candidate.dy>=s1)
+            continue;
 
-                  }
-                }
-              }
+          bool allok = true;
+          for(unsigned int step=candidate.firstStep; step<candidate.endStep && allok; step++)
+          {
+            const int* st = &tubeSteps[4*step];
+            if(x+st[2]<0 || x+st[2]>=s0 || y+st[3]<0 || y+st[3]>=s1)
+            {
+              allok = false;
+              break;
+            }
+            if(distanceMap[ix + st[0] + st[1]*s0] > distanceMap[ix + st[2] + st[3]*s0])
+            {
+              allok = false;
+            }
+          }
 
-              ix4d[0]=x; ix4d[1]=y; ix4d[2]=z; ix4d[3]=t;
+          if(allok)
+          {
+            positions.push_back(ix + candidate.dx + candidate.dy*s0);
+            weights.push_back(candidate.weight);
+          }
+        }
+      }
 
-              data_4d_projected->SetPixel(ix4d, maxval);
+      const int numPositions = positions.size();
+      for(int t=0; t<s3; t++)
+      {
+        const long offset4D = t*numPixels3D;
+        long maxpos = ix;
+        float maxval = allFA[ix + offset4D];
+        float maxval_weighted = maxval;
 
-            }
+        for(int p=0; p<numPositions; p++)
+        {
+          float val = allFA[positions[p] + offset4D];
+          if(weights[p]*val > maxval_weighted)
+          {
+            maxval = val;
+            maxval_weighted = maxval*weights[p];
+            maxpos = positions[p];
           }
         }
+
+        projected[ix + offset4D] = maxval;
+        for(int m=0; m<numMetrics; m++)
+          metricsProjected[m][ix + offset4D] = metrics[m][maxpos + offset4D];
       }
     }
 
-    m_Projections = data_4d_projected;
-
-
+    mitk::ProgressBar::GetInstance()->Progress();
 
   }
 
 
-
+  ProjectionFilter::Float4DImageType::Pointer ProjectionFilter::AllocateProjection(Float4DImageType::Pointer reference)
+  {
+    Float4DImageType::Pointer projection = Float4DImageType::New();
+    projection->SetRegions(reference->GetRequestedRegion());
+    projection->SetDirection(reference->GetDirection());
+    projection->SetSpacing(reference->GetSpacing());
+    projection->SetOrigin(reference->GetOrigin());
+    projection->Allocate();
+    projection->FillBuffer(0.0);
+    return projection;
+  }
 
 
 }
@@ -35,12 +35,16 @@ PURPOSE.  See the above copyright notices for more information.
 #include <itkImageToImageFilter.h>
 #include <itkVectorImage.h>
 #include <itkPointShell.h>
+#include <itkMultiThreader.h>
 
 namespace itk
 {
 
 /**
-* \brief Resample DWI channel by channel.   */
+* \brief Resample DWI.
+*
+* Nearest neighbour and linear interpolation compute the source voxels and weights once per output voxel and apply
+* them to all channels (multi-threaded). B-spline and windowed sinc interpolation resample channel by channel.   */
 
 template <class TScalarType>
 class ResampleDwiImageFilter
@@ -129,9 +133,18 @@ public:
 
     void GenerateData() override;
 
+    /** Resamples all channels of the output slices [firstSlice, endSlice) with nearest neighbour or linear interpolation */
+    void ResampleSlices(int firstSlice, int endSlice);
+    static ITK_THREAD_RETURN_TYPE ResampleCallback(void *arg);
+
+    /** Resamples the channels one after another with itk::ResampleImageFilter */
+    void ResampleChannels(DwiImageType* outImage);
+
     DoubleVectorType m_NewSpacing;
     ImageRegion<3>   m_NewImageRegion;
     Interpolation    m_Interpolation;
+
+    typename DwiImageType::Pointer m_ResampledImage;  ///< output image while it is generated
 };
 
 
@@ -37,12 +37,18 @@ PURPOSE.  See the above copyright notices for more information.
 
 #include "itkResampleDwiImageFilter.h"
 #include <itkImageRegionIterator.h>
+#include <itkImageRegionIteratorWithIndex.h>
+#include <itkContinuousIndex.h>
 #include <itkImageRegion.h>
 #include <itkResampleImageFilter.h>
 #include <itkBSplineInterpolateImageFunction.h>
 #include <itkNearestNeighborInterpolateImageFunction.h>
 #include <itkLinearInterpolateImageFunction.h>
 #include <itkWindowedSincInterpolateImageFunction.h>
+#include <itkMath.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 namespace itk
 {
@@ -89,6 +95,138 @@ ResampleDwiImageFilter<TScalarType>
     outImage->SetVectorLength( this->GetInput()->GetVectorLength() );
     outImage->Allocate();
 
+    if (m_Interpolation==Interpolate_NearestNeighbour || m_Interpolation==Interpolate_Linear)
+    {
+        // all channels share the sampling positions, so they are interpolated together
+        m_ResampledImage = outImage;
+        this->GetMultiThreader()->SetNumberOfThreads(this->GetNumberOfThreads());
+        this->GetMultiThreader()->SetSingleMethod(ResampleCallback, this);
+        this->GetMultiThreader()->SingleMethodExecute();
+        m_ResampledImage = nullptr;
+    }
+    else
+        ResampleChannels(outImage);
+
+    this->SetNthOutput(0, outImage);
+}
+
+template <class TScalarType>
+ITK_THREAD_RETURN_TYPE
+ResampleDwiImageFilter<TScalarType>
+::ResampleCallback(void *arg)
+{
+    MultiThreader::ThreadInfoStruct *info = static_cast<MultiThreader::ThreadInfoStruct *>(arg);
+    Self* self = static_cast<Self *>(info->UserData);
+    const int numSlices = self->m_ResampledImage->GetLargestPossibleRegion().GetSize(2);
+    self->ResampleSlices(numSlices*info->ThreadID/info->NumberOfThreads, numSlices*(info->ThreadID+1)/info->NumberOfThreads);
+    return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TScalarType>
+void
+ResampleDwiImageFilter<TScalarType>
+::ResampleSlices(int firstSlice, int endSlice)
+{
+    if (firstSlice>=endSlice)
+        return;
+
+    const DwiImageType* inImage = this->GetInput();
+    DwiImageType* outImage = m_ResampledImage;
+    const unsigned int numChannels = inImage->GetVectorLength();
+    const TScalarType* inBuffer = inImage->GetBufferPointer();
+    TScalarType* outBuffer = outImage->GetBufferPointer();
+
+    const ImageRegion<3> inRegion = inImage->GetLargestPossibleRegion();
+    const ImageRegion<3> outRegion = outImage->GetLargestPossibleRegion();
+    const typename DwiImageType::IndexType inStart = inRegion.GetIndex();
+    const typename DwiImageType::SizeType inSize = inRegion.GetSize();
+    const OffsetValueType inStrides[3] = { 1, static_cast<OffsetValueType>(inSize[0]), static_cast<OffsetValueType>(inSize[0]*inSize[1]) };
+
+    // same conversion as itk::ResampleImageFilter: values are clamped to the range of the pixel type
+    const double minValue = static_cast<double>(NumericTraits<TScalarType>::NonpositiveMin());
+    const double maxValue = static_cast<double>(NumericTraits<TScalarType>::max());
+
+    std::vector< double > values(numChannels);
+    ImageRegion<3> region = outRegion;
+    region.SetIndex(2, outRegion.GetIndex(2) + firstSlice);
+    region.SetSize(2, endSlice - firstSlice);
+
+    ImageRegionIteratorWithIndex<DwiImageType> it(outImage, region);
+    for (; !it.IsAtEnd(); ++it)
+    {
+        itk::Point<double,3> point;
+        outImage->TransformIndexToPhysicalPoint(it.GetIndex(), point);
+        itk::ContinuousIndex<double,3> cIdx;
+        inImage->TransformPhysicalPointToContinuousIndex(point, cIdx);
+
+        TScalarType* out = outBuffer + outImage->ComputeOffset(it.GetIndex())*numChannels;
+
+        // outside of the input (by more than half a voxel) the output is 0, as the default value of itk::ResampleImageFilter
+        bool inside = true;
+        for (int d=0; d<3; d++)
+            if (!(cIdx[d] >= inStart[d]-0.5 && cIdx[d] < inStart[d]+static_cast<double>(inSize[d])-0.5))
+                inside = false;
+        if (!inside)
+        {
+            std::fill(out, out+numChannels, TScalarType(0));
+            continue;
+        }
+
+        if (m_Interpolation==Interpolate_NearestNeighbour)
+        {
+            OffsetValueType offset = 0;
+            for (int d=0; d<3; d++)
+            {
+                OffsetValueType idx = Math::RoundHalfIntegerUp<OffsetValueType>(cIdx[d]) - inStart[d];
+                idx = std::min(std::max(idx, OffsetValueType(0)), static_cast<OffsetValueType>(inSize[d])-1);
+                offset += idx*inStrides[d];
+            }
+            std::copy(inBuffer + offset*numChannels, inBuffer + (offset+1)*numChannels, out);
+            continue;
+        }
+
+        // linear interpolation, the neighbours are clamped to the image like itk::LinearInterpolateImageFunction does
+        OffsetValueType lower[3], upper[3];
+        double distance[3];
+        for (int d=0; d<3; d++)
+        {
+            const double base = std::floor(cIdx[d]);
+            distance[d] = cIdx[d] - base;
+            const OffsetValueType last = static_cast<OffsetValueType>(inSize[d])-1;
+            const OffsetValueType idx = static_cast<OffsetValueType>(base) - inStart[d];
+            lower[d] = std::min(std::max(idx, OffsetValueType(0)), last)*inStrides[d];
+            upper[d] = std::min(std::max(idx+1, OffsetValueType(0)), last)*inStrides[d];
+        }
+
+        std::fill(values.begin(), values.end(), 0.0);
+        for (int corner=0; corner<8; corner++)
+        {
+            double weight = 1;
+            OffsetValueType offset = 0;
+            for (int d=0; d<3; d++)
+            {
+                const bool up = (corner>>d) & 1;
+                weight *= up ? distance[d] : 1-distance[d];
+                offset += up ? upper[d] : lower[d];
+            }
+            if (weight==0)
+                continue;
+
+            const TScalarType* in = inBuffer + offset*numChannels;
+            for (unsigned int c=0; c<numChannels; c++)
+                values[c] += weight*in[c];
+        }
+
+        for (unsigned int c=0; c<numChannels; c++)
+            out[c] = static_cast<TScalarType>(std::min(std::max(values[c], minValue), maxValue));
+    }
+}
+
+template <class TScalarType>
+void
+ResampleDwiImageFilter<TScalarType>
+::ResampleChannels(DwiImageType* outImage)
+{
     typename itk::ResampleImageFilter<DwiChannelType, DwiChannelType>::Pointer resampler = itk::ResampleImageFilter<DwiChannelType, DwiChannelType>::New();
     resampler->SetOutputParametersFromImage(outImage);
 
@@ -125,7 +263,10 @@ ResampleDwiImageFilter<TScalarType>
     }
     }
 
-    for (unsigned int i=0; i<this->GetInput()->GetVectorLength(); i++)
+    const unsigned int numChannels = this->GetInput()->GetVectorLength();
+    const TScalarType* inBuffer = this->GetInput()->GetBufferPointer();
+    TScalarType* outBuffer = outImage->GetBufferPointer();
+    for (unsigned int i=0; i<numChannels; i++)
     {
         typename DwiChannelType::Pointer channel = DwiChannelType::New();
         channel->SetSpacing( this->GetInput()->GetSpacing() );
@@ -136,29 +277,21 @@ ResampleDwiImageFilter<TScalarType>
         channel->SetRequestedRegion( this->GetInput()->GetLargestPossibleRegion() );
         channel->Allocate();
 
-        ImageRegionIterator<DwiChannelType> it(channel, channel->GetLargestPossibleRegion());
-        while(!it.IsAtEnd())
-        {
-            typename DwiImageType::PixelType pix = this->GetInput()->GetPixel(it.GetIndex());
-            it.Set(pix[i]);
-            ++it;
-        }
+        // both images use the same voxel order, the channels are interleaved in the vector image buffer
+        TScalarType* channelBuffer = channel->GetBufferPointer();
+        const SizeValueType numInVoxels = channel->GetLargestPossibleRegion().GetNumberOfPixels();
+        for (SizeValueType v=0; v<numInVoxels; v++)
+            channelBuffer[v] = inBuffer[v*numChannels + i];
 
         resampler->SetInput(channel);
         resampler->Update();
         channel = resampler->GetOutput();
 
-        ImageRegionIterator<DwiImageType> it2(outImage, outImage->GetLargestPossibleRegion());
-        while(!it2.IsAtEnd())
-        {
-            typename DwiImageType::PixelType pix = it2.Get();
-            pix[i] = channel->GetPixel(it2.GetIndex());
-            it2.Set(pix);
-            ++it2;
-        }
+        const TScalarType* resampledBuffer = channel->GetBufferPointer();
+        const SizeValueType numOutVoxels = outImage->GetLargestPossibleRegion().GetNumberOfPixels();
+        for (SizeValueType v=0; v<numOutVoxels; v++)
+            outBuffer[v*numChannels + i] = resampledBuffer[v];
     }
-
-    this->SetNthOutput(0, outImage);
 }
 
 template <class TScalarType>
@@ -23,6 +23,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkShToOdfImageFilter.h"
 #include <itkImageRegionIterator.h>
 #include <mitkDiffusionFunctionCollection.h>
+#include <vector>
 
 namespace itk {
 
@@ -34,10 +35,14 @@ ShToOdfImageFilter< PixelType, ShOrder >::ShToOdfImageFilter()
 }
 
 template< class PixelType, int ShOrder >
-void ShToOdfImageFilter< PixelType, ShOrder >::ThreadedGenerateData( const OutputImageRegionType &outputRegionForThread, ThreadIdType)
+void ShToOdfImageFilter< PixelType, ShOrder >::BeforeThreadedGenerateData()
 {
   CalcShBasis();
+}
 
+template< class PixelType, int ShOrder >
+void ShToOdfImageFilter< PixelType, ShOrder >::ThreadedGenerateData( const OutputImageRegionType &outputRegionForThread, ThreadIdType)
+{
   typename OutputImageType::Pointer outputImage = static_cast< OutputImageType * >(this->ProcessObject::GetPrimaryOutput());
 
   typename InputImageType::Pointer inputImage = static_cast< InputImageType * >( this->ProcessObject::GetInput(0) );
@@ -48,15 +53,31 @@ void ShToOdfImageFilter< PixelType, ShOrder >::ThreadedGenerateData( const Outpu
   typedef ImageRegionIterator< OutputImageType > OutputIteratorType;
   OutputIteratorType oit(outputImage, outputRegionForThread);
 
+  // the coefficients of a chunk of voxels are evaluated by one matrix product
+  const unsigned int chunkSize = 64;
+  const unsigned int numCoeffs = InputPixelType::Dimension;
+  std::vector< float > coeffs(chunkSize*numCoeffs);
+  std::vector< float > odfs(chunkSize*ODF_SAMPLING_SIZE);
+
   while(!it.IsAtEnd())
   {
-    auto pix = it.Get();
-    vnl_vector<PixelType> coeffs = pix.GetVnlVector();
-    OutputPixelType odf = (m_ShBasis * coeffs).data_block();
-    oit.Set(odf);
-
-    ++it;
-    ++oit;
+    unsigned int numVoxels = 0;
+    for (; numVoxels<chunkSize && !it.IsAtEnd(); ++numVoxels, ++it)
+    {
+      const InputPixelType& pix = it.Get();
+      for (unsigned int k=0; k<numCoeffs; ++k)
+        coeffs[numVoxels*numCoeffs + k] = pix[k];
+    }
+
+    mitk::sh::EvaluateSh(m_ShBasisTransposed, coeffs.data(), numVoxels, odfs.data());
+
+    for (unsigned int v=0; v<numVoxels; ++v, ++oit)
+    {
+      OutputPixelType odf;
+      for (unsigned int i=0; i<ODF_SAMPLING_SIZE; ++i)
+        odf[i] = odfs[v*ODF_SAMPLING_SIZE + i];
+      oit.Set(odf);
+    }
   }
 }
 
@@ -69,6 +90,7 @@ void ShToOdfImageFilter< PixelType, ShOrder >::CalcShBasis()
     m_ShBasis = mitk::sh::CalcShBasisForDirections(ShOrder, U->as_matrix());
   else
     m_ShBasis = mitk::sh::CalcShBasisForDirections(ShOrder, U->as_matrix(), false);
+  m_ShBasisTransposed = m_ShBasis.transpose();
 }
 
 }
@@ -61,6 +61,7 @@ public:
     itkSetMacro( Toolkit, Toolkit)  ///< define SH coefficient convention (depends on toolkit)
     itkGetMacro( Toolkit, Toolkit)  ///< SH coefficient convention (depends on toolkit)
 
+    void BeforeThreadedGenerateData();
     void ThreadedGenerateData( const OutputImageRegionType &outputRegionForThread, ThreadIdType);
 
 protected:
@@ -70,6 +71,7 @@ protected:
     void CalcShBasis();
 
     vnl_matrix<float>                         m_ShBasis;
+    vnl_matrix<float>                         m_ShBasisTransposed;  ///< coefficients x directions, input of mitk::sh::EvaluateSh
     Toolkit                                   m_Toolkit;
 
 private:
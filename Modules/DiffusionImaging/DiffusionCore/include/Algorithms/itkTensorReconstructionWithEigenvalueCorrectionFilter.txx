@@ -22,6 +22,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkImage.h"
 #include "itkImageRegionIterator.h"
 #include <itkImageDuplicator.h>
+#include <mitkLinearReconstructionEngine.h>
 
 namespace itk
 {
@@ -522,14 +523,14 @@ TensorReconstructionWithEigenvalueCorrectionFilter<TDiffusionPixelType, TTensorP
         // but only if previously marked as bad one-negative eigen value
         if(pixel > 1)
         {
+          itk::DiffusionTensor3D<double> ten = tensorImg->GetPixel(ix);
+          double elements[6] = { ten(0,0), ten(0,1), ten(0,2), ten(1,1), ten(1,2), ten(2,2) };
+          double eigenvalues[3];
+          mitk::LinearReconstructionEngine<double>::ComputeSymmetricEigenValues(elements, 1, eigenvalues);
+
+          //comparison to 0.01 instead of 0 was proposed by O.Pasternak
 #pragma omp critical
           {
-            itk::DiffusionTensor3D<double>::EigenValuesArrayType eigenvalues;
-            itk::DiffusionTensor3D<double>::EigenVectorsMatrixType eigenvectors;
-            itk::DiffusionTensor3D<double> ten = tensorImg->GetPixel(ix);
-            ten.ComputeEigenAnalysis(eigenvalues, eigenvectors);
-
-            //comparison to 0.01 instead of 0 was proposed by O.Pasternak
             if( eigenvalues[0]>0.01 && eigenvalues[1]>0.01 && eigenvalues[2]>0.01)
               mask->SetPixel(ix,1);
             else
@@ -727,27 +728,29 @@ TensorReconstructionWithEigenvalueCorrectionFilter<TDiffusionPixelType, TTensorP
 ::GenerateTensorImage(int nof,int numberb0,itk::Size<3> size,itk::VectorImage<short, 3>::Pointer corrected_diffusion,itk::Image<short, 3>::Pointer mask,double , typename itk::Image< itk::DiffusionTensor3D<TTensorPixelType>, 3 >::Pointer tensorImg)
 {
   // in this method the whole tensor image is updated with a tensors for defined voxels ( defined by a value of mask);
+  // the attenuations of all voxels of one line in z direction are collected and multiplied with the pseudo inverse at once
+  mitk::LinearReconstructionEngine<double> engine(m_PseudoInverse);
 
 #ifdef WIN32
 #pragma omp parallel for
 #else
-#pragma omp parallel for collapse(3)
+#pragma omp parallel for collapse(2)
 #endif
   for (int x=0;x<(int)size[0];x++)
     for (int y=0;y<(int)size[1];y++)
+    {
+      std::vector< double > attenuations;
+      std::vector< double > tensors;
+      std::vector< int > fitted_z;    // z index of each attenuation vector
+      std::vector< int > zero_z;      // voxels outside of the mask
+      vnl_vector<double> org_data(nof);
+
       for (int z=0;z<(int)size[2];z++)
       {
         itk::Index<3> ix;
-
-        vnl_vector<double> org_data(nof);
-        vnl_vector<double> atten(nof-numberb0);
-        vnl_vector<double> tensor(6);
-        itk::DiffusionTensor3D<double> ten;
-        double mask_val=0;
-
         ix[0] = x; ix[1] = y; ix[2] = z;
 
-        mask_val= mask->GetPixel(ix);
+        double mask_val= mask->GetPixel(ix);
 
         //Tensors are calculated only for voxels above theshold for B0 image.
         if( mask_val > 0.0 )
@@ -772,7 +775,6 @@ TensorReconstructionWithEigenvalueCorrectionFilter<TDiffusionPixelType, TTensorP
 
           }
           mean_b=mean_b/numberb0;
-          int cnt=0;
           for (int i=0;i<nof;i++)
           {
             if (org_data[i]<= 0)
@@ -782,44 +784,46 @@ TensorReconstructionWithEigenvalueCorrectionFilter<TDiffusionPixelType, TTensorP
             }
             if(m_B0Mask[i]==0)
             {
-              atten[cnt]=org_data[i]/mean_b;
-              cnt++;
+              attenuations.push_back(log((double)(org_data[i]/mean_b)));
             }
           }
+          fitted_z.push_back(z);
+        }
+        // for voxels with mask value 0 - tensor is simply 0 ( outside brain value)
+        else if (mask_val < 1.0)
+          zero_z.push_back(z);
+      }
 
-          for (int i=0;i<nof-numberb0;i++)
-          {
-
-            atten[i]=log((double)atten[i]);
-          }
-
-          // Calculation of tensor with use of previously calculated inverse of design matrix and attenuation
-          tensor = m_PseudoInverse*atten;
+      // Calculation of tensors with use of previously calculated inverse of design matrix and attenuation
+      tensors.resize(fitted_z.size()*6);
+      engine.Apply(attenuations.data(), fitted_z.size(), tensors.data());
 
+#pragma omp critical
+      {
+        itk::Index<3> ix;
+        ix[0] = x; ix[1] = y;
+        itk::DiffusionTensor3D<double> ten;
+        for (unsigned int v=0; v<fitted_z.size(); v++)
+        {
+          const double* tensor = &tensors[6*v];
           ten(0,0) = tensor[0];
           ten(0,1) = tensor[3];
           ten(0,2) = tensor[5];
           ten(1,1) = tensor[1];
           ten(1,2) = tensor[4];
           ten(2,2) = tensor[2];
-
-#pragma omp critical
+          ix[2] = fitted_z[v];
           tensorImg->SetPixel(ix, ten);
         }
-        // for voxels with mask value 0 - tensor is simply 0 ( outside brain value)
-        else if (mask_val < 1.0)
-        {
-          ten(0,0) = 0;
-          ten(0,1) = 0;
-          ten(0,2) = 0;
-          ten(1,1) = 0;
-          ten(1,2) = 0;
-          ten(2,2) = 0;
 
-#pragma omp critical
+        ten.Fill(0);
+        for (int z : zero_z)
+        {
+          ix[2] = z;
           tensorImg->SetPixel(ix, ten);
         }
       }
+    }
 
 }// end of Generate Tensor
 
@@ -477,6 +477,10 @@ namespace mitk
     ParamsType* Cluster(const HistType h) const
     {return Cluster(h, InitialGuess(h));}
 
+    /** \brief Fit the mixture model to the histogram or return the fit of the previous call if histogram, number of
+     * iterations and integration steps are unchanged. The returned curves are normalized. */
+    void ClusterHistogram(const MitkHistType *histogram, const HistType& h, ParamsType& params, ClusterResultType& result) const;
+
     void SetMaxIt(unsigned int it)
     { m_MaxIt = it; }
 
@@ -498,6 +502,14 @@ namespace mitk
     unsigned int m_MaxIt;
     unsigned int m_StepsNumIntegration;
 
+    // fit of the last clustered histogram
+    mutable MitkHistType::ConstPointer m_CachedHistogram;
+    mutable unsigned long m_CachedHistogramMTime;
+    mutable unsigned int m_CachedMaxIt;
+    mutable unsigned int m_CachedStepsNumIntegration;
+    mutable ParamsType m_CachedParams;
+    mutable ClusterResultType m_CachedResult;
+
   };
 
 }
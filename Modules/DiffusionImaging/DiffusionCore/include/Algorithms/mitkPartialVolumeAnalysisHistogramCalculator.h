@@ -154,6 +154,7 @@ namespace mitk
       if(m_UpsamplingFactor != number)
       {
         m_UpsamplingFactor = number;
+        m_ExtractionModified = true;
         SetModified();
       }
     }
@@ -168,6 +169,7 @@ namespace mitk
       if(m_GaussianSigma != number)
       {
         m_GaussianSigma = number;
+        m_ExtractionModified = true;
         SetModified();
       }
     }
@@ -183,6 +185,7 @@ namespace mitk
       if(m_PlanarFigureThickness != number)
       {
         m_PlanarFigureThickness = number;
+        m_ExtractionModified = true;
         SetModified();
       }
     }
@@ -245,6 +248,9 @@ namespace mitk
    * through. */
     void ExtractImageAndMask( );
 
+    /** \brief Check whether the previously extracted image and mask are still valid. */
+    bool IsExtractionUpToDate( ) const;
+
 
     /** \brief If the passed vector matches any of the three principal axes
    * of the passed geometry, the ínteger value corresponding to the axis
@@ -375,6 +381,11 @@ namespace mitk
 
     bool m_ForceUpdate;
 
+    /** The extracted (masked, resampled, smoothed) image and mask only depend on the inputs, the upsampling factor,
+     * the gaussian sigma and the planar figure thickness. If only the number of bins changes, they are reused. */
+    bool m_ExtractionModified;
+    TimeStampType m_ExtractionTimeStamp;
+
     unsigned int m_PlanarFigureThickness;
 
   };
@@ -6,6 +6,8 @@
 
 #include "itkImageRegionIteratorWithIndex.h"
 
+#include <omp.h>
+
 namespace mitk
 {
 
@@ -87,20 +89,23 @@ public:
     output_image->SetBufferedRegion( requestedRegion );
     output_image->Allocate();
 
-    itk::ImageRegionIterator< VectorImageType > vecIter(
-          output_image, requestedRegion );
+    // the volumes are interleaved into the vector image in batches, so each pass over the output
+    // writes a contiguous run of components per voxel instead of a single strided value
+    const unsigned int volumeBatchSize = 8;
+    const unsigned int numberOfComponents = filenames.size();
+    const long numberOfVoxels = static_cast< long >( requestedRegion.GetNumberOfPixels() );
+    PixelType* output_buffer = output_image->GetBufferPointer();
 
-    auto volumesFileNamesIter = filenames.begin();
+    std::vector< typename InputImageType::Pointer > volume_batch;
 
     // iterate over the given volumes
-    unsigned int component = 0;
-    while( volumesFileNamesIter != filenames.end() )
+    for( unsigned int component = 0; component < numberOfComponents; component++ )
     {
 
       MITK_INFO << " ======== Loading volume " << component+1 << " of " << filenames.size();
 
       typename SeriesReaderType::Pointer volume_reader = SeriesReaderType::New();
-      volume_reader->SetFileNames( *volumesFileNamesIter );
+      volume_reader->SetFileNames( filenames.at( component ) );
 
       try
       {
@@ -111,28 +116,33 @@ public:
         mitkThrow() << " ITK Series reader failed : "<< e.what();
       }
 
-      itk::ImageRegionConstIterator< InputImageType > iRCIter (
-            volume_reader->GetOutput(),
-            volume_reader->GetOutput()->GetLargestPossibleRegion() );
+      if( static_cast< long >( volume_reader->GetOutput()->GetLargestPossibleRegion().GetNumberOfPixels() ) != numberOfVoxels )
+      {
+        mitkThrow() << " Volume " << component+1 << " does not match the size of the first volume.";
+      }
 
-      // transfer to vector image
-      iRCIter.GoToBegin();
-      vecIter.GoToBegin();
+      volume_batch.push_back( volume_reader->GetOutput() );
 
+      if( volume_batch.size() < volumeBatchSize && component+1 < numberOfComponents )
+        continue;
 
+      // transfer to vector image
+      const unsigned int firstComponent = component + 1 - volume_batch.size();
+      const int batchSize = volume_batch.size();
 
-      while( !iRCIter.IsAtEnd() )
-      {
-        typename VectorImageType::PixelType vector_pixel = vecIter.Get();
-        vector_pixel.SetElement( component, iRCIter.Get() );
-        vecIter.Set( vector_pixel );
+      std::vector< const PixelType* > batch_buffers;
+      for( auto& volume : volume_batch )
+        batch_buffers.push_back( volume->GetBufferPointer() );
 
-        ++vecIter;
-        ++iRCIter;
+#pragma omp parallel for
+      for( long voxel = 0; voxel < numberOfVoxels; ++voxel )
+      {
+        PixelType* target = output_buffer + voxel * numberOfComponents + firstComponent;
+        for( int b = 0; b < batchSize; ++b )
+          target[b] = batch_buffers[b][voxel];
       }
 
-      ++volumesFileNamesIter;
-      component++;
+      volume_batch.clear();
     }
 
     return output_image;
@@ -207,22 +217,27 @@ public:
     output_image->SetBufferedRegion( requestedRegion );
     output_image->Allocate();
 
-    itk::ImageRegionIteratorWithIndex< VectorImageType > vecIter(
-          output_image, requestedRegion );
-
     // hold the image sizes in an extra variable ( used very often )
     typename MosaicImageType::SizeValueType dx = requestedRegion.GetSize()[0];
     typename MosaicImageType::SizeValueType dy = requestedRegion.GetSize()[1];
+    typename MosaicImageType::SizeValueType mosaic_dx = mosaic_lpr.GetSize()[0];
+
+    // the volumes are interleaved into the vector image in batches, see LoadToVector
+    const unsigned int volumeBatchSize = 8;
+    const unsigned int numberOfComponents = filenames.size();
+    const int numberOfRows = dy * mosaicInfo.nimages;
+    PixelType* output_buffer = output_image->GetBufferPointer();
+
+    std::vector< typename MosaicImageType::Pointer > mosaic_batch;
 
     // iterate over the given volumes
-    unsigned int component = 0;
-    while( volumesFileNamesIter != filenames.end() )
+    for( unsigned int component = 0; component < numberOfComponents; component++ )
     {
 
       MITK_INFO << " ======== Loading volume " << component+1 << " of " << filenames.size();
 
       typename SingleImageReaderType::Pointer mosaic_reader = SingleImageReaderType::New();
-      mosaic_reader->SetFileName( (*volumesFileNamesIter).at(0) );
+      mosaic_reader->SetFileName( filenames.at( component ).at(0) );
 
       try
       {
@@ -233,40 +248,44 @@ public:
         mitkThrow() << " ITK Image file reader failed : "<< e.what();
       }
 
-      typename MosaicImageType::Pointer current_mosaic = mosaic_reader->GetOutput();
-
-      vecIter.GoToBegin();
-      while( !vecIter.IsAtEnd() )
+      if( mosaic_reader->GetOutput()->GetLargestPossibleRegion().GetSize() != mosaic_lpr.GetSize() )
       {
-        typename VectorImageType::PixelType vector_pixel = vecIter.Get();
-        typename VectorImageType::IndexType threeD_index = vecIter.GetIndex();
-
-        typename MosaicImageType::IndexType mosaic_index;
-
-        mosaic_index[2] = 0;
+        mitkThrow() << " Mosaic " << component+1 << " does not match the size of the first mosaic.";
+      }
 
-        // first find the corresponding tile in the mosaic
-        // this is defined by the z-position of the vector (3D) image iterator
-        //      in x : z_index % #images_in_grid
-        //      in y : z_index / #images_in_grid
-        //
-        // the remaining is just computing the correct position in the mosaic, done by
-        //                --------- index of (0,0,z) -----        + --- current 2d position ---
-        mosaic_index[0] = (threeD_index[2] % images_per_row) * dx + threeD_index[0];
-        mosaic_index[1] = (threeD_index[2] / images_per_row) * dy + threeD_index[1];
+      mosaic_batch.push_back( mosaic_reader->GetOutput() );
 
-        typename MosaicImageType::PixelType mosaic_pixel = current_mosaic->GetPixel( mosaic_index );
+      if( mosaic_batch.size() < volumeBatchSize && component+1 < numberOfComponents )
+        continue;
 
-        vector_pixel.SetElement( component, mosaic_pixel );
+      const unsigned int firstComponent = component + 1 - mosaic_batch.size();
+      const int batchSize = mosaic_batch.size();
 
-        vecIter.Set( vector_pixel );
+      std::vector< const PixelType* > batch_buffers;
+      for( auto& mosaic : mosaic_batch )
+        batch_buffers.push_back( mosaic->GetBufferPointer() );
 
-        ++vecIter;
+      // every row of the output volume is a contiguous row within one tile of the mosaic
+      //      tile in x : z_index % #images_in_grid
+      //      tile in y : z_index / #images_in_grid
+#pragma omp parallel for
+      for( int row = 0; row < numberOfRows; ++row )
+      {
+        const typename MosaicImageType::SizeValueType z = row / dy;
+        const typename MosaicImageType::SizeValueType y = row % dy;
+
+        //                         --------- row of (0,y,z) -----------------------   + --- column of (0,y,z) -------
+        const std::size_t mosaic_offset = ( (z / images_per_row) * dy + y ) * mosaic_dx + (z % images_per_row) * dx;
+        PixelType* target = output_buffer + static_cast< std::size_t >( row ) * dx * numberOfComponents + firstComponent;
+
+        for( typename MosaicImageType::SizeValueType x = 0; x < dx; ++x, target += numberOfComponents )
+        {
+          for( int b = 0; b < batchSize; ++b )
+            target[b] = batch_buffers[b][mosaic_offset + x];
+        }
       }
 
-      ++volumesFileNamesIter;
-      component++;
-
+      mosaic_batch.clear();
     }
 
     return output_image;
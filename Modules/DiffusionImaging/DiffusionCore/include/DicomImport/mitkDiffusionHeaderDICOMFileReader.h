@@ -90,6 +90,16 @@ public:
    */
   virtual bool ReadDiffusionHeader( std::string ){ return false; }
 
+  /**
+   * @brief Parse all given dicom files, the files are read in parallel
+   *
+   * Each file is parsed by its own reader instance of the same vendor type, the collected information is appended to the
+   * header list in the order of the given files, i.e. the result equals calling ReadDiffusionHeader for each file in turn.
+   *
+   * @return true if the last file could be read
+   */
+  bool ReadDiffusionHeaders( const std::vector< std::string >& filenames );
+
   DICOMHeaderListType GetHeaderInformation();
 
 protected:
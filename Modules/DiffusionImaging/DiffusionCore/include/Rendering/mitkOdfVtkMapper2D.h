@@ -32,6 +32,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vtkOdfSource.h"
 #include "vtkThickPlane.h"
 #include <mitkDiffusionFunctionCollection.h>
+#include <deque>
 
 namespace mitk {
 
@@ -98,6 +99,16 @@ public:
         std::vector< vtkSmartPointer<vtkPolyDataMapper> >     m_OdfsMappers;
         vtkSmartPointer< vtkPolyData >                        m_TemplateOdf;
 
+        struct CachedSlice
+        {
+            OdfDisplayGeometry              geometry;
+            int                             timestep;
+            vtkSmartPointer< vtkPolyData >  glyphs;
+        };
+        /** \brief Glyphs of the most recently displayed slices of each view, the most recent one last. */
+        std::vector< std::deque< CachedSlice > >              m_SliceCache;
+        unsigned long                                         m_SliceCacheMTime;
+
         itk::TimeStamp                      m_LastUpdateTime;
 
         /** \brief Default constructor of the local storage. */
@@ -113,7 +124,18 @@ protected:
     OdfVtkMapper2D();
     ~OdfVtkMapper2D() override;
 
+    typedef itk::OrientationDistributionFunction<float,NrOdfDirections> OdfType;
+
     static void GlyphMethod(void *arg);
+    static void ComputeOdf(vtkDataArray* image_vals, vtkIdType id, OdfType& odf);
+    static double GetGlyphScale(OdfType& odf);
+
+    /** \brief Generates the glyphs of all selected points in one pass. Every glyph is a copy of the ODF base mesh with displaced vertices. */
+    vtkSmartPointer<vtkPolyData> GenerateGlyphs(vtkPolyData* cuttedPlane);
+    /** \brief Displays the cached glyphs for the given geometry. Returns false if the slice is not cached. */
+    bool ShowCachedSlice(mitk::BaseRenderer* renderer, const OdfDisplayGeometry& dispGeo);
+    void CacheSlice(mitk::BaseRenderer* renderer, const OdfDisplayGeometry& dispGeo, vtkPolyData* glyphs);
+    void UpdateOdfActor(mitk::BaseRenderer* renderer);
     bool IsPlaneRotated(mitk::BaseRenderer* renderer);
     static bool m_ToggleTensorEllipsoidView;
     static bool m_ToggleColourisationMode;
@@ -136,6 +158,8 @@ private:
     static float                                      m_IndexParam2;
     static vtkSmartPointer<vtkDoubleArray>            m_ColourScalars;
     int                                               m_ShowMaxNumber;
+    bool                                              m_InstancedGlyphs;
+    int                                               m_SliceCacheSize;
     std::vector< vtkSmartPointer<vtkPlane> >          m_Planes;
     std::vector< vtkSmartPointer<vtkCutter> >         m_Cutters;
     std::vector< vtkSmartPointer<vtkThickPlane> >     m_ThickPlanes1;
@@ -52,6 +52,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vtkMath.h"
 #include "vtkFloatArray.h"
 #include "vtkDelaunay2D.h"
+#include "vtkMaskPoints.h"
+#include "vtkPolygon.h"
+#include "vtkUnsignedCharArray.h"
 #include "vtkMapper.h"
 #include <vtkInformationVector.h>
 #include <vtkInformation.h>
@@ -68,6 +71,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <cmath>
 
 #include <ciso646>
+#include <algorithm>
 
 
 template<class T, int N>
@@ -154,6 +158,9 @@ mitk::OdfVtkMapper2D<T,N>::LocalStorage::LocalStorage()
   m_OdfsActors[0]->SetMapper(m_OdfsMappers[0]);
   m_OdfsActors[1]->SetMapper(m_OdfsMappers[1]);
   m_OdfsActors[2]->SetMapper(m_OdfsMappers[2]);
+
+  m_SliceCache.resize(3);
+  m_SliceCacheMTime = 0;
 }
 
 template<class T, int N>
@@ -208,6 +215,8 @@ mitk::OdfVtkMapper2D<T,N>
   m_Clippers2[2]->SetClipFunction( m_ThickPlanes2[2] );
 
   m_ShowMaxNumber = 500;
+  m_InstancedGlyphs = true;
+  m_SliceCacheSize = 16;
 }
 
 template<class T, int N>
@@ -277,9 +286,31 @@ void  mitk::OdfVtkMapper2D<T,N>
   m_OdfTransform->Identity();
   m_OdfTransform->Translate(point[0],point[1],point[2]);
 
-  typedef itk::OrientationDistributionFunction<float,N> OdfType;
   OdfType odf;
+  ComputeOdf(image_vals, id, odf);
 
+  if (m_ToggleColourisationMode)
+  {
+    m_OdfSource->SetUseCustomColor(true);
+    vnl_vector_fixed<double,3> d = odf.GetPrincipalDiffusionDirection();
+    m_OdfSource->SetColor(fabs(d[0])*255,fabs(d[1])*255,fabs(d[2])*255);
+  }
+  else
+  {
+    m_OdfSource->SetUseCustomColor(false);
+  }
+
+  m_OdfSource->SetScale(GetGlyphScale(odf));
+
+  m_OdfSource->SetNormalization(m_Normalization);
+  m_OdfSource->SetOdf(odf);
+  m_OdfSource->Modified();
+}
+
+template<class T, int N>
+void  mitk::OdfVtkMapper2D<T,N>
+::ComputeOdf(vtkDataArray* image_vals, vtkIdType id, OdfType& odf)
+{
   if( image_vals->GetNumberOfComponents()==6 && !m_ToggleTensorEllipsoidView )
   {
     float tensorelems[6] = {
@@ -346,34 +377,197 @@ void  mitk::OdfVtkMapper2D<T,N>
     for(int i=0; i<N; i++)
       odf[i] = odf_vals[i];
   }
+}
 
-  if (m_ToggleColourisationMode)
+template<class T, int N>
+double  mitk::OdfVtkMapper2D<T,N>
+::GetGlyphScale(OdfType& odf)
+{
+  switch(m_ScaleBy)
   {
-    m_OdfSource->SetUseCustomColor(true);
-    vnl_vector_fixed<double,3> d = odf.GetPrincipalDiffusionDirection();
-    m_OdfSource->SetColor(fabs(d[0])*255,fabs(d[1])*255,fabs(d[2])*255);
+  case ODFSB_GFA:
+    return m_Scaling*odf.GetGeneralizedFractionalAnisotropy();
+  case ODFSB_PC:
+    return m_Scaling*odf.GetPrincipleCurvature(m_IndexParam1, m_IndexParam2, 0);
+  default:
+    return m_Scaling;
   }
-  else
+}
+
+template<class T, int N>
+vtkSmartPointer<vtkPolyData>  mitk::OdfVtkMapper2D<T,N>
+::GenerateGlyphs(vtkPolyData* cuttedPlane)
+{
+  vtkSmartPointer<vtkPolyData> glyphs = vtkSmartPointer<vtkPolyData>::New();
+  int maxPoints = std::min(m_ShowMaxNumber,(int)cuttedPlane->GetNumberOfPoints());
+  if (maxPoints<1)
+    return glyphs;
+
+  // same selection of the glyphed points as in vtkMaskedProgrammableGlyphFilter
+  vtkSmartPointer<vtkMaskPoints> maskPoints = vtkSmartPointer<vtkMaskPoints>::New();
+  maskPoints->SetInputData(cuttedPlane);
+  maskPoints->SetRandomMode(m_ToggleGlyphPlacementMode);
+  maskPoints->SetMaximumNumberOfPoints(maxPoints);
+  maskPoints->SetOnRatio(cuttedPlane->GetNumberOfPoints() / maxPoints);
+  maskPoints->Update();
+  vtkPolyData* centers = maskPoints->GetOutput();
+  vtkDataArray* image_vals = centers->GetPointData()->GetArray("vector");
+  int numGlyphs = centers->GetNumberOfPoints();
+  if (numGlyphs<1 || image_vals==nullptr)
+    return glyphs;
+
+  // every glyph is a copy of the unit sphere mesh with displaced vertices
+  vtkPolyData* templateOdf = OdfType::GetBaseMesh();
+  vtkIdType numTemplatePoints = templateOdf->GetNumberOfPoints();
+  vtkCellArray* templatePolys = templateOdf->GetPolys();
+
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->Allocate(numGlyphs*numTemplatePoints);
+  vtkSmartPointer<vtkUnsignedCharArray> colors = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  colors->SetNumberOfComponents(4);
+  colors->SetName("ODF_COLORS");
+  colors->Allocate(numGlyphs*numTemplatePoints*4);
+
+  mitk::BaseGeometry* geometry = this->GetDataNode()->GetData()->GetGeometry();
+  Vector3D spacing = geometry->GetSpacing();
+  for (int g=0; g<numGlyphs; ++g)
   {
-    m_OdfSource->SetUseCustomColor(false);
+    itk::Point<double,3> p(centers->GetPoint(g));
+    p[0] /= spacing[0];
+    p[1] /= spacing[1];
+    p[2] /= spacing[2];
+
+    mitk::Point3D p2;
+    geometry->IndexToWorld( p, p2 );
+    double center[3] = { p2[0], p2[1], p2[2] };
+
+    OdfType odf;
+    ComputeOdf(image_vals, g, odf);
+
+    if (m_ToggleColourisationMode)
+    {
+      m_OdfSource->SetUseCustomColor(true);
+      vnl_vector_fixed<double,3> d = odf.GetPrincipalDiffusionDirection();
+      m_OdfSource->SetColor(fabs(d[0])*255,fabs(d[1])*255,fabs(d[2])*255);
+    }
+    else
+    {
+      m_OdfSource->SetUseCustomColor(false);
+    }
+
+    m_OdfSource->SetNormalization(m_Normalization);
+    m_OdfSource->AppendGlyph(odf, GetGlyphScale(odf), center, points, colors);
   }
 
-  switch(m_ScaleBy)
+  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+  vtkSmartPointer<vtkFloatArray> normals = vtkSmartPointer<vtkFloatArray>::New();
+  normals->SetNumberOfComponents(3);
+  normals->SetNumberOfTuples(numGlyphs*numTemplatePoints);
+  normals->SetName("Normals");
+  normals->FillComponent(0, 0);
+  normals->FillComponent(1, 0);
+  normals->FillComponent(2, 0);
+
+  // point normals are the averaged polygon normals, as computed by vtkPolyDataNormals without splitting
+  std::vector< vtkIdType > ids;
+  for (int g=0; g<numGlyphs; ++g)
   {
-  case ODFSB_NONE:
-    m_OdfSource->SetScale(m_Scaling);
-    break;
-  case ODFSB_GFA:
-    m_OdfSource->SetScale(m_Scaling*odf.GetGeneralizedFractionalAnisotropy());
-    break;
-  case ODFSB_PC:
-    m_OdfSource->SetScale(m_Scaling*odf.GetPrincipleCurvature(m_IndexParam1, m_IndexParam2, 0));
-    break;
+    vtkIdType offset = g*numTemplatePoints;
+    vtkIdType npts = 0;
+    vtkIdType* pts = nullptr;
+    for (templatePolys->InitTraversal(); templatePolys->GetNextCell(npts, pts); )
+    {
+      ids.resize(npts);
+      for (vtkIdType i=0; i<npts; ++i)
+        ids[i] = pts[i] + offset;
+      polys->InsertNextCell(npts, ids.data());
+
+      double n[3];
+      vtkPolygon::ComputeNormal(points, npts, ids.data(), n);
+      for (vtkIdType i=0; i<npts; ++i)
+      {
+        float* pn = normals->GetPointer(3*ids[i]);
+        pn[0] += n[0];
+        pn[1] += n[1];
+        pn[2] += n[2];
+      }
+    }
   }
+  for (vtkIdType i=0; i<normals->GetNumberOfTuples(); ++i)
+    vtkMath::Normalize(normals->GetPointer(3*i));
+
+  glyphs->SetPoints(points);
+  glyphs->SetPolys(polys);
+  glyphs->GetPointData()->AddArray(colors);
+  glyphs->GetPointData()->SetNormals(normals);
+  return glyphs;
+}
 
-  m_OdfSource->SetNormalization(m_Normalization);
-  m_OdfSource->SetOdf(odf);
-  m_OdfSource->Modified();
+template<class T, int N>
+bool  mitk::OdfVtkMapper2D<T,N>
+::ShowCachedSlice(mitk::BaseRenderer* renderer, const OdfDisplayGeometry& dispGeo)
+{
+  LocalStorage *localStorage = m_LSH.GetLocalStorage(renderer);
+  int index = GetIndex(renderer);
+  int timestep = this->GetTimestep();
+
+  auto& cache = localStorage->m_SliceCache[index];
+  for (auto it = cache.begin(); it!=cache.end(); ++it)
+  {
+    OdfDisplayGeometry geo = dispGeo;
+    if (it->timestep!=timestep || !geo.Equals(it->geometry))
+      continue;
+
+    typename LocalStorage::CachedSlice slice = *it;
+    cache.erase(it);
+    cache.push_back(slice);
+
+    localStorage->m_OdfsPlanes[index]->RemoveAllInputs();
+    localStorage->m_OdfsPlanes[index]->AddInputData(slice.glyphs);
+    localStorage->m_OdfsPlanes[index]->Update();
+    this->UpdateOdfActor(renderer);
+    return true;
+  }
+  return false;
+}
+
+template<class T, int N>
+void  mitk::OdfVtkMapper2D<T,N>
+::CacheSlice(mitk::BaseRenderer* renderer, const OdfDisplayGeometry& dispGeo, vtkPolyData* glyphs)
+{
+  if (m_SliceCacheSize<=0)
+    return;
+
+  LocalStorage *localStorage = m_LSH.GetLocalStorage(renderer);
+  auto& cache = localStorage->m_SliceCache[GetIndex(renderer)];
+
+  typename LocalStorage::CachedSlice slice;
+  slice.geometry = dispGeo;
+  slice.timestep = this->GetTimestep();
+  slice.glyphs = glyphs;
+  cache.push_back(slice);
+  while (static_cast<int>(cache.size())>m_SliceCacheSize)
+    cache.pop_front();
+}
+
+template<class T, int N>
+void  mitk::OdfVtkMapper2D<T,N>
+::UpdateOdfActor(mitk::BaseRenderer* renderer)
+{
+  LocalStorage *localStorage = m_LSH.GetLocalStorage(renderer);
+  int index = GetIndex(renderer);
+
+  localStorage->m_OdfsMappers[index]->ScalarVisibilityOn();
+  localStorage->m_OdfsMappers[index]->SetScalarModeToUsePointFieldData();
+  localStorage->m_OdfsMappers[index]->SelectColorArray("ODF_COLORS");
+
+  localStorage->m_PropAssemblies[index]->VisibilityOn();
+  if(localStorage->m_PropAssemblies[index]->GetParts()->IsItemPresent(localStorage->m_OdfsActors[index]))
+  {
+    localStorage->m_PropAssemblies[index]->RemovePart(localStorage->m_OdfsActors[index]);
+  }
+  localStorage->m_OdfsMappers[index]->SetInputData(localStorage->m_OdfsPlanes[index]->GetOutput());
+  localStorage->m_PropAssemblies[index]->AddPart(localStorage->m_OdfsActors[index]);
 }
 
 template<class T, int N>
@@ -482,6 +676,7 @@ void  mitk::OdfVtkMapper2D<T,N>
 ::Slice(mitk::BaseRenderer* renderer, OdfDisplayGeometry dispGeo)
 {
   LocalStorage *localStorage = m_LSH.GetLocalStorage(renderer);
+  OdfDisplayGeometry requestedGeo = dispGeo;
 
   vtkLinearTransform * vtktransform =
       this->GetDataNode()->GetVtkTransform(this->GetTimestep());
@@ -656,7 +851,15 @@ void  mitk::OdfVtkMapper2D<T,N>
 
     cuttedPlane = m_Clippers2[index]->GetOutput ();
 
-    if(cuttedPlane->GetNumberOfPoints())
+    if(cuttedPlane->GetNumberOfPoints() && m_InstancedGlyphs)
+    {
+      vtkSmartPointer<vtkPolyData> glyphs = GenerateGlyphs(cuttedPlane);
+      localStorage->m_OdfsPlanes[index]->RemoveAllInputs();
+      localStorage->m_OdfsPlanes[index]->AddInputData(glyphs);
+      localStorage->m_OdfsPlanes[index]->Update();
+      CacheSlice(renderer, requestedGeo, glyphs);
+    }
+    else if(cuttedPlane->GetNumberOfPoints())
     {
       localStorage->m_OdfsPlanes[index]->RemoveAllInputs();
 
@@ -697,17 +900,7 @@ void  mitk::OdfVtkMapper2D<T,N>
       localStorage->m_OdfsPlanes[index]->Update();
     }
   }
-  localStorage->m_OdfsMappers[index]->ScalarVisibilityOn();
-  localStorage->m_OdfsMappers[index]->SetScalarModeToUsePointFieldData();
-  localStorage->m_OdfsMappers[index]->SelectColorArray("ODF_COLORS");
-
-  localStorage->m_PropAssemblies[index]->VisibilityOn();
-  if(localStorage->m_PropAssemblies[index]->GetParts()->IsItemPresent(localStorage->m_OdfsActors[index]))
-  {
-    localStorage->m_PropAssemblies[index]->RemovePart(localStorage->m_OdfsActors[index]);
-  }
-  localStorage->m_OdfsMappers[index]->SetInputData(localStorage->m_OdfsPlanes[index]->GetOutput());
-  localStorage->m_PropAssemblies[index]->AddPart(localStorage->m_OdfsActors[index]);
+  UpdateOdfActor(renderer);
 }
 
 template<class T, int N>
@@ -860,7 +1053,20 @@ void  mitk::OdfVtkMapper2D<T,N>
 
     m_OdfSource->SetAdditionalScale(GetMinImageSpacing(GetIndex(renderer)));
     ApplyPropertySettings();
-    Slice(renderer, dispGeo);
+
+    // cached glyphs are only valid as long as neither the data nor any property changed
+    unsigned long mtime = std::max(m_DataNode->GetMTime(), GetInput()->GetMTime());
+    mtime = std::max(mtime, m_DataNode->GetPropertyList()->GetMTime());
+    mtime = std::max(mtime, m_DataNode->GetPropertyList(renderer)->GetMTime());
+    if (mtime!=localStorage->m_SliceCacheMTime || !m_InstancedGlyphs)
+    {
+      for (auto& cache : localStorage->m_SliceCache)
+        cache.clear();
+      localStorage->m_SliceCacheMTime = mtime;
+    }
+
+    if (!m_InstancedGlyphs || !ShowCachedSlice(renderer, dispGeo))
+      Slice(renderer, dispGeo);
     m_LastDisplayGeometry[GetIndex(renderer)] = dispGeo;
   }
 }
@@ -911,6 +1117,8 @@ void  mitk::OdfVtkMapper2D<T,N>
   this->GetDataNode()->GetBoolProperty( "DiffusionCore.Rendering.OdfVtkMapper.SwitchTensorView", m_ToggleTensorEllipsoidView );
   this->GetDataNode()->GetBoolProperty( "DiffusionCore.Rendering.OdfVtkMapper.ColourisationModeBit", m_ToggleColourisationMode );
   this->GetDataNode()->GetBoolProperty( "DiffusionCore.Rendering.OdfVtkMapper.RandomModeBit", m_ToggleGlyphPlacementMode);
+  this->GetDataNode()->GetBoolProperty( "DiffusionCore.Rendering.OdfVtkMapper.InstancedGlyphs", m_InstancedGlyphs);
+  this->GetDataNode()->GetIntProperty( "DiffusionCore.Rendering.OdfVtkMapper.SliceCacheSize", m_SliceCacheSize);
 }
 
 template <class T, int N>
@@ -978,6 +1186,8 @@ void  mitk::OdfVtkMapper2D<T,N>
   node->SetProperty( "DoRefresh", mitk::BoolProperty::New( true ) );
   node->AddProperty( "DiffusionCore.Rendering.OdfVtkMapper.SwitchTensorView", mitk::BoolProperty::New( true) );
   node->AddProperty( "DiffusionCore.Rendering.OdfVtkMapper.RandomModeBit", mitk::BoolProperty::New( true ) );
+  node->AddProperty( "DiffusionCore.Rendering.OdfVtkMapper.InstancedGlyphs", mitk::BoolProperty::New( true ) );
+  node->AddProperty( "DiffusionCore.Rendering.OdfVtkMapper.SliceCacheSize", mitk::IntProperty::New( 16 ) );
 }
 
 #endif // __mitkOdfVtkMapper2D_txx__
@@ -22,6 +22,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vtkPolyDataAlgorithm.h"
 #include "mitkCommon.h"
 #include <vtkFloatArray.h>
+#include <vtkPoints.h>
+#include <vtkUnsignedCharArray.h>
 #include <itkOrientationDistributionFunction.h>
 #include <mitkOdfNormalizationMethodProperty.h>
 
@@ -60,6 +62,12 @@ public:
     this->b = b;
   }
 
+  // Description:
+  // Appends the glyph of the given ODF, centered at the given point, to the points and colors without
+  // executing the pipeline. The current normalization, additional scale and color settings are used,
+  // the given scale replaces Scale. The glyph uses the topology of the ODF base mesh.
+  void AppendGlyph(OdfType odf, double scale, const double center[3], vtkPoints* points, vtkUnsignedCharArray* colors);
+
 protected:
   vtkOdfSource();
   ~vtkOdfSource() override;
@@ -94,6 +94,15 @@ public:
   static double spherical_harmonic(int m,int l,double theta,double phi, bool complexPart);
   static double Yj(int m, int k, float theta, float phi, bool mrtrix=true);
   static vnl_matrix<float> CalcShBasisForDirections(int sh_order, vnl_matrix<double> U, bool mrtrix=true);
+
+  /**
+   * \brief Evaluates the SH coefficients of several voxels at once as one matrix product.
+   *
+   * basisT is the transposed SH basis (coefficients x directions), e.g. CalcShBasisForDirections(...).transpose().
+   * coefficients holds numVoxels rows of basisT.rows() coefficients, values receives numVoxels rows of basisT.cols()
+   * function values. The directions are processed in blocks so that the basis rows stay in cache.
+   */
+  static void EvaluateSh(const vnl_matrix<float>& basisT, const float* coefficients, unsigned int numVoxels, float* values);
 };
 
 class MITKDIFFUSIONCORE_EXPORT gradients
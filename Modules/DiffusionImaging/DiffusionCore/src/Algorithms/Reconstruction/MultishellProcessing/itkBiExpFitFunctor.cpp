@@ -15,56 +15,76 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "itkBiExpFitFunctor.h"
+#include <algorithm>
 #include <cmath>
-#include <iostream>
-#include <iomanip>
 
 void itk::BiExpFitFunctor::operator()(vnl_matrix<double> & newSignal,const vnl_matrix<double> & SignalMatrix, const double & S0)
 {
-
-  vnl_vector<double> initalGuess(3);
-  // initialize Least Squres Function
   // SignalMatrix.cols() defines the number of shells points
-  lestSquaresFunction model(SignalMatrix.cols());
-  model.set_bvalues(m_BValueList);// set BValue Vector e.g.: [1000, 2000, 3000] <- shell b Values
-
-  // initialize Levenberg Marquardt
-  vnl_levenberg_marquardt minimizer(model);
-  minimizer.set_max_function_evals(1000);   // Iterations
-  minimizer.set_f_tolerance(1e-10);        // Function tolerance
+  Model model;
+  model.bValues = m_BValueList.data_block(); // set BValue Vector e.g.: [1000, 2000, 3000] <- shell b Values
+  model.S0 = S0;
 
-  // for each Direction calculate LSF Coeffs ADC & AKC
+  vnl_matrix<double> parameters(SignalMatrix.rows(), 3);
   for(unsigned int i = 0 ; i < SignalMatrix.rows(); i++)
   {
-    model.set_measurements(SignalMatrix.get_row(i));
-    model.set_reference_measurement(S0);
+    parameters(i,0) = 0; // ADC_slow
+    parameters(i,1) = 0.009; // ADC_fast
+    parameters(i,2) = 0.7; // lambda
+  }
 
-    initalGuess.put(0, 0.f); // ADC_slow
-    initalGuess.put(1, 0.009f); // ADC_fast
-    initalGuess.put(2, 0.7f); // lambda
+  // initial guess: the slow component is fitted log-linearly to the upper half of the shells (the fast one has decayed
+  // there), the fast diffusivity follows from the remaining signal of the lowest shell
+  const unsigned int numShells = SignalMatrix.cols();
+  const unsigned int firstSlowShell = numShells/2;
+  if (S0>0 && numShells>=3 && numShells-firstSlowShell>=2)
+  {
+    double meanB = 0;
+    for(unsigned int j = firstSlowShell; j < numShells; j++)
+      meanB += m_BValueList[j];
+    meanB /= numShells-firstSlowShell;
+
+    for(unsigned int i = 0 ; i < SignalMatrix.rows(); i++)
+    {
+      double meanY = 0;
+      for(unsigned int j = firstSlowShell; j < numShells; j++)
+        meanY += std::log(std::max(SignalMatrix(i,j), 1e-6*S0) / S0);
+      meanY /= numShells-firstSlowShell;
+
+      double by = 0, bb = 0;
+      for(unsigned int j = firstSlowShell; j < numShells; j++)
+      {
+        const double db = m_BValueList[j] - meanB;
+        by += db * (std::log(std::max(SignalMatrix(i,j), 1e-6*S0) / S0) - meanY);
+        bb += db * db;
+      }
+      if (bb<=0)
+        continue;
+
+      const double ADC_slow = std::max(-by/bb, 0.0);
+      const double lambda = std::min(std::max(std::exp(meanY + ADC_slow*meanB), 0.05), 0.95);
+      const double b = m_BValueList[0];
+      const double fast = (SignalMatrix(i,0)/S0 - lambda * std::exp(-b * ADC_slow)) / (1-lambda);
+
+      parameters(i,0) = ADC_slow;
+      parameters(i,2) = lambda;
+      if (fast>0 && fast<1 && b>0)
+        parameters(i,1) = std::max(-std::log(fast)/b, ADC_slow);
+    }
+  }
 
-    // start Levenberg-Marquardt
-    minimizer.minimize_without_gradient(initalGuess);
+  // for each Direction calculate LSF Coeffs ADC_slow, ADC_fast & lambda
+  BatchedLevenbergMarquardt<3> minimizer;
+  vnl_vector<double> errors;
+  minimizer.Fit(model, SignalMatrix, parameters, errors);
 
-    const double & ADC_slow = initalGuess.get(0);
-    const double & ADC_fast = initalGuess.get(1);
-    const double & lambda = initalGuess(2);
+  for(unsigned int i = 0 ; i < SignalMatrix.rows(); i++)
+  {
+    const double & ADC_slow = parameters(i,0);
+    const double & ADC_fast = parameters(i,1);
+    const double & lambda = parameters(i,2);
 
     newSignal.put(i, 0, S0 * (lambda * std::exp(-m_TargetBvalue * ADC_slow) + (1-lambda)* std::exp(-m_TargetBvalue * ADC_fast)));
-    newSignal.put(i, 1, minimizer.get_end_error()); // RMS Error
-
-    //OUTPUT FOR EVALUATION
-    /*std::cout << std::scientific << std::setprecision(5)
-              << ADC_slow   << ","                        // lambda
-              << ADC_fast   << ","                        // alpha
-              << lambda     << ","                        // lambda
-              << S0         << ","                        // S0 value
-              << minimizer.get_end_error() << ",";      // End error
-    for(unsigned int j = 0; j < SignalMatrix.get_row(i).size(); j++ ){
-      std::cout << std::scientific << std::setprecision(5) << SignalMatrix.get_row(i)[j];    // S_n Values corresponding to shell 1 to shell n
-      if(j != SignalMatrix.get_row(i).size()-1) std::cout << ",";
-    }
-    std::cout << std::endl;*/
+    newSignal.put(i, 1, errors[i]); // RMS Error
   }
-
 }
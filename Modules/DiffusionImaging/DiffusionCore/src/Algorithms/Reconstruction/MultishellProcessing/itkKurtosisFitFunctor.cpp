@@ -15,52 +15,64 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "itkKurtosisFitFunctor.h"
-#include <iostream>
-#include <iomanip>
+#include <algorithm>
+#include <cmath>
 
 void itk::KurtosisFitFunctor::operator()(vnl_matrix<double> & newSignal, const vnl_matrix<double> & SignalMatrix, const double & S0)
 {
-
-  vnl_vector<double> initalGuess(2);
-  // initialize Least Squres Function
   // SignalMatrix.cols() defines the number of shells points
-  lestSquaresFunction model(SignalMatrix.cols());
-  model.set_bvalues(m_BValueList);// set BValue Vector e.g.: [1000, 2000, 3000] <- shell b Values
-
-  // initialize Levenberg Marquardt
-  vnl_levenberg_marquardt minimizer(model);
-  minimizer.set_max_function_evals(1000); // Iterations
-  minimizer.set_f_tolerance(1e-10);        // Function tolerance
+  Model model;
+  model.bValues = m_BValueList.data_block(); // set BValue Vector e.g.: [1000, 2000, 3000] <- shell b Values
+  model.S0 = S0;
 
-  // for each Direction calculate LSF Coeffs ADC & AKC
+  vnl_matrix<double> parameters(SignalMatrix.rows(), 2);
   for(unsigned int i = 0 ; i < SignalMatrix.rows(); i++)
   {
-    model.set_measurements(SignalMatrix.get_row(i));
-    model.set_reference_measurement(S0);
+    parameters(i,0) = 0; // ADC
+    parameters(i,1) = 0.8; // AKC
+  }
 
-    initalGuess.put(0, 0.f); // ADC
-    initalGuess.put(1, 0.8f); // AKC
+  // initial guess from the linear fit ln(S/S0) = -b*ADC + b^2/6*(ADC^2*AKC)
+  double aa = 0, ac = 0, cc = 0;
+  for(unsigned int j = 0; j < SignalMatrix.cols(); j++)
+  {
+    const double a = -m_BValueList[j];
+    const double c = m_BValueList[j] * m_BValueList[j] / 6.;
+    aa += a*a; ac += a*c; cc += c*c;
+  }
+  const double det = aa*cc - ac*ac;
+  if (S0>0 && std::fabs(det)>1e-12*aa*cc)
+  {
+    for(unsigned int i = 0 ; i < SignalMatrix.rows(); i++)
+    {
+      double ay = 0, cy = 0;
+      for(unsigned int j = 0; j < SignalMatrix.cols(); j++)
+      {
+        const double y = std::log(std::max(SignalMatrix(i,j), 1e-6*S0) / S0);
+        ay += -m_BValueList[j] * y;
+        cy += m_BValueList[j] * m_BValueList[j] / 6. * y;
+      }
+      const double D = (cc*ay - ac*cy)/det;
+      const double q = (aa*cy - ac*ay)/det;
+      if (D>0)
+      {
+        parameters(i,0) = D;
+        parameters(i,1) = q/(D*D);
+      }
+    }
+  }
 
-    // start Levenberg-Marquardt
-    minimizer.minimize_without_gradient(initalGuess);
+  // for each Direction calculate LSF Coeffs ADC & AKC
+  BatchedLevenbergMarquardt<2> minimizer;
+  vnl_vector<double> errors;
+  minimizer.Fit(model, SignalMatrix, parameters, errors);
 
-    const double & ADC = initalGuess.get(0);
-    const double & AKC = initalGuess.get(1);
+  for(unsigned int i = 0 ; i < SignalMatrix.rows(); i++)
+  {
+    const double & ADC = parameters(i,0);
+    const double & AKC = parameters(i,1);
 
     newSignal.put(i, 0, S0 * std::exp(-m_TargetBvalue * ADC + 1./6. * m_TargetBvalue* m_TargetBvalue * ADC * ADC * AKC));
-    newSignal.put(i, 1, minimizer.get_end_error()); // RMS Error
-
-    //OUTPUT FOR EVALUATION
-
-    /*std::cout << std::scientific << std::setprecision(5)
-              << initalGuess[0] << ","                  // fitted ADC
-              << initalGuess[1] << ","                  // fitted AKC
-              << S0 << ","                              // S0 value
-              << minimizer.get_end_error() << ",";      // End error
-    for(unsigned int j = 0; j < SignalMatrix.get_row(i).size(); j++ ){
-      std::cout << std::scientific << std::setprecision(5) << SignalMatrix.get_row(i)[j];    // S_n Values corresponding to shell 1 to shell n
-      if(j != SignalMatrix.get_row(i).size()-1) std::cout << ",";
-    }
-    std::cout << std::endl;*/
+    newSignal.put(i, 1, errors[i]); // RMS Error
   }
 }
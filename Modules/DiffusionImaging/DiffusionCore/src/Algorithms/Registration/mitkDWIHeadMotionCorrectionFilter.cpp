@@ -43,6 +43,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkBValueMapProperty.h>
 
 #include <vector>
+#include <omp.h>
 
 #include "mitkIOUtil.h"
 #include <itkImage.h>
@@ -51,10 +52,31 @@ typedef mitk::DiffusionPropertyHelper DPH;
 typedef itk::ExtractDwiChannelFilter< short > ExtractorType;
 
 mitk::DWIHeadMotionCorrectionFilter::DWIHeadMotionCorrectionFilter()
+  : m_MaxConcurrentRegistrations(0)
+  , m_MaxMemory(2048)
 {
 
 }
 
+int mitk::DWIHeadMotionCorrectionFilter::GetNumberOfConcurrentRegistrations(unsigned long num_voxels, int num_volumes) const
+{
+  int num_threads = omp_get_max_threads();
+  if (m_MaxConcurrentRegistrations>0 && static_cast<int>(m_MaxConcurrentRegistrations)<num_threads)
+    num_threads = m_MaxConcurrentRegistrations;
+
+  // each registration holds the extracted and the mapped moving volume as well as the float
+  // copies, gradients and pyramid levels of the metric, roughly 40 bytes per voxel
+  double bytes_per_registration = static_cast<double>(num_voxels) * 40.0;
+  int memory_bound = static_cast<int>(static_cast<double>(m_MaxMemory) * 1024.0 * 1024.0 / bytes_per_registration);
+  if (memory_bound<num_threads)
+    num_threads = memory_bound;
+  if (num_volumes<num_threads)
+    num_threads = num_volumes;
+  if (num_threads<1)
+    num_threads = 1;
+  return num_threads;
+}
+
 mitk::Image::Pointer mitk::DWIHeadMotionCorrectionFilter::GetCorrectedImage() const
 {
   return m_CorrectedImage;
@@ -90,52 +112,86 @@ void mitk::DWIHeadMotionCorrectionFilter::GenerateData()
   mitk::Image::Pointer fixedImage = mitk::Image::New();
   fixedImage->InitializeByItk( filter->GetOutput() );
   fixedImage->SetImportChannel( filter->GetOutput()->GetBufferPointer() );
-  composer->SetInput(0, filter->GetOutput());
-
-  mitk::MultiModalAffineDefaultRegistrationAlgorithm< ITKDiffusionVolumeType >::Pointer algo = mitk::MultiModalAffineDefaultRegistrationAlgorithm< ITKDiffusionVolumeType >::New();
-  mitk::MITKAlgorithmHelper helper(algo);
 
   typedef vnl_matrix_fixed< double, 3, 3> TransformMatrixType;
-  std::vector< TransformMatrixType > estimated_transforms;
-  std::vector< ITKDiffusionVolumeType::Pointer > registered_itk_images;
+  TransformMatrixType identity; identity.set_identity();
+  std::vector< TransformMatrixType > volume_transforms(num_gradients, identity);
+  std::vector< ITKDiffusionVolumeType::Pointer > registered_itk_images(num_gradients);
+  registered_itk_images[first_unweighted_index] = filter->GetOutput();
+
+  std::vector< int > moving_indices;
   for (int i=0; i<num_gradients; ++i)
+    if (i!=first_unweighted_index)
+      moving_indices.push_back(i);
+
+  unsigned long num_voxels = itkVectorImagePointer->GetLargestPossibleRegion().GetNumberOfPixels();
+  int num_threads = GetNumberOfConcurrentRegistrations(num_voxels, moving_indices.size());
+  MITK_INFO << "Registering " << moving_indices.size() << " volumes using " << num_threads << " concurrent registrations";
+
+  // the volumes are independent, every thread uses its own registration algorithm and only reads the shared fixed image
+  bool failed = false;
+  std::string error_message;
+#pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+  for (int m=0; m<static_cast<int>(moving_indices.size()); ++m)
   {
-    if (i==first_unweighted_index)
+    if (failed)
       continue;
 
-    MITK_INFO << "Correcting volume " << i;
-
-    ExtractorType::Pointer filter = ExtractorType::New();
-    filter->SetInput( itkVectorImagePointer);
-    filter->SetChannelIndex(i);
-    filter->Update();
-
-    mitk::Image::Pointer movingImage = mitk::Image::New();
-    movingImage->InitializeByItk( filter->GetOutput() );
-    movingImage->SetImportChannel( filter->GetOutput()->GetBufferPointer() );
-
-    helper.SetData(movingImage, fixedImage);
-    mitk::MAPRegistrationWrapper::Pointer reg = helper.GetMITKRegistrationWrapper();
-    mitk::MITKRegistrationHelper::Affine3DTransformType::Pointer affine = mitk::MITKRegistrationHelper::getAffineMatrix(reg, false);
-    estimated_transforms.push_back(affine->GetMatrix().GetVnlMatrix());
-
-    mitk::Image::Pointer registered_mitk_image = mitk::ImageMappingHelper::map(movingImage, reg, false, 0, nullptr, false, 0, mitk::ImageMappingInterpolator::BSpline_3);
-    ITKDiffusionVolumeType::Pointer registered_itk_image = ITKDiffusionVolumeType::New();
-    mitk::CastToItkImage(registered_mitk_image, registered_itk_image);
-    registered_itk_images.push_back(registered_itk_image);
+    int i = moving_indices[m];
+    try
+    {
+      ExtractorType::Pointer extractor = ExtractorType::New();
+      extractor->SetInput( itkVectorImagePointer);
+      extractor->SetChannelIndex(i);
+      extractor->Update();
+
+      mitk::Image::Pointer movingImage = mitk::Image::New();
+      movingImage->InitializeByItk( extractor->GetOutput() );
+      movingImage->SetImportChannel( extractor->GetOutput()->GetBufferPointer() );
+
+      mitk::MultiModalAffineDefaultRegistrationAlgorithm< ITKDiffusionVolumeType >::Pointer algo = mitk::MultiModalAffineDefaultRegistrationAlgorithm< ITKDiffusionVolumeType >::New();
+      mitk::MITKAlgorithmHelper helper(algo);
+      helper.SetData(movingImage, fixedImage);
+      mitk::MAPRegistrationWrapper::Pointer reg = helper.GetMITKRegistrationWrapper();
+      mitk::MITKRegistrationHelper::Affine3DTransformType::Pointer affine = mitk::MITKRegistrationHelper::getAffineMatrix(reg, false);
+      volume_transforms[i] = affine->GetMatrix().GetVnlMatrix();
+
+      mitk::Image::Pointer registered_mitk_image = mitk::ImageMappingHelper::map(movingImage, reg, false, 0, nullptr, false, 0, mitk::ImageMappingInterpolator::BSpline_3);
+      ITKDiffusionVolumeType::Pointer registered_itk_image = ITKDiffusionVolumeType::New();
+      mitk::CastToItkImage(registered_mitk_image, registered_itk_image);
+      registered_itk_images[i] = registered_itk_image;
+
+#pragma omp critical (DWIHeadMotionCorrectionFilter_Log)
+      MITK_INFO << "Corrected volume " << i;
+    }
+    catch (const std::exception& e)
+    {
+#pragma omp critical (DWIHeadMotionCorrectionFilter_Log)
+      {
+        failed = true;
+        error_message = e.what();
+      }
     }
-
-  int i=1;
-  for (auto image : registered_itk_images)
-  {
-    composer->SetInput(i, image);
-    ++i;
   }
+
+  if (failed)
+    mitkThrow() << "Registration of the diffusion-weighted volumes failed: " << error_message;
+
+  // keep the channel order of the input so that the volumes still match their gradient directions
+  for (int i=0; i<num_gradients; ++i)
+    composer->SetInput(i, registered_itk_images[i]);
   composer->Update();
 
   m_CorrectedImage = mitk::GrabItkImageMemory( composer->GetOutput() );
   DPH::CopyProperties(input, m_CorrectedImage, true);
 
+  // the direction correction expects one transform per weighted direction
+  DPH::GradientDirectionsContainerType::Pointer directions = DPH::GetGradientContainer(input);
+  std::vector< TransformMatrixType > estimated_transforms;
+  for (int i=0; i<num_gradients; ++i)
+    if (directions->ElementAt(i).one_norm() > 0.0)
+      estimated_transforms.push_back(volume_transforms[i]);
+
   typedef mitk::DiffusionImageCorrectionFilter CorrectionFilterType;
   CorrectionFilterType::Pointer corrector = CorrectionFilterType::New();
   corrector->SetImage( m_CorrectedImage );
@@ -29,7 +29,14 @@ mitk::PyramidImageRegistrationMethod::PyramidImageRegistrationMethod()
     m_UseMask(false),
     m_EstimatedParameters(nullptr),
     m_InitialParameters(0),
-    m_Verbose(false)
+    m_Verbose(false),
+    m_InitializeByGeometry(false),
+    m_MetricSamplingPercentage(1.0),
+    m_NumberOfThreads(0),
+    m_CachedFixedImageSource(nullptr),
+    m_CachedFixedImageMTime(0),
+    m_CachedFixedMaskSource(nullptr),
+    m_CachedFixedMaskMTime(0)
 {
 
 }
@@ -65,6 +72,41 @@ void mitk::PyramidImageRegistrationMethod::SetFixedImageMask(mitk::Image::Pointe
   m_FixedImageMask = mask;
 }
 
+mitk::PyramidImageRegistrationMethod::MaskSpatialObjectType*
+mitk::PyramidImageRegistrationMethod::GetFixedMaskSpatialObject()
+{
+  if( m_FixedImageMask.IsNull() )
+  {
+    mitkThrow() << "Fixed image mask usage enabled, but no mask set.";
+  }
+
+  if( m_CachedFixedMask.IsNull() || m_CachedFixedMaskSource != m_FixedImageMask.GetPointer()
+      || m_CachedFixedMaskMTime != m_FixedImageMask->GetMTime() )
+  {
+    typedef itk::Image<unsigned char, 3> BinaryImageType;
+    BinaryImageType::Pointer itkFixedImageMask = BinaryImageType::New();
+    CastToItkImage( m_FixedImageMask, itkFixedImageMask);
+
+    itk::NotImageFilter<BinaryImageType, BinaryImageType>::Pointer notFilter = itk::NotImageFilter<BinaryImageType, BinaryImageType>::New();
+    notFilter->SetInput(itkFixedImageMask);
+    if( m_NumberOfThreads > 0 )
+    {
+      notFilter->SetNumberOfThreads( m_NumberOfThreads );
+    }
+    notFilter->Update();
+
+    BinaryImageType::Pointer invertedMask = notFilter->GetOutput();
+    invertedMask->DisconnectPipeline();
+
+    m_CachedFixedMask = MaskSpatialObjectType::New();
+    m_CachedFixedMask->SetImage( invertedMask );
+    m_CachedFixedMaskSource = m_FixedImageMask.GetPointer();
+    m_CachedFixedMaskMTime = m_FixedImageMask->GetMTime();
+  }
+
+  return m_CachedFixedMask;
+}
+
 void mitk::PyramidImageRegistrationMethod::Update()
 {
   if( m_MovingImage.IsNull() )
@@ -189,6 +231,29 @@ mitk::Image::Pointer mitk::PyramidImageRegistrationMethod::GetResampledMovingIma
 #include <itkOptimizerParameterScalesEstimator.h>
 #include <itkRegistrationParameterScalesFromPhysicalShift.h>
 
+namespace
+{
+  /** Applies the thread limit and the metric sampling to both (rigid/affine) registration types */
+  template <typename TRegistration>
+  void ConfigureRegistrationSampling( TRegistration* registration, unsigned int numberOfLevels,
+                                      double samplingPercentage, unsigned int numberOfThreads )
+  {
+    if( numberOfThreads > 0 )
+    {
+      registration->SetNumberOfThreads( numberOfThreads );
+    }
+
+    if( samplingPercentage < 1.0 )
+    {
+      registration->SetMetricSamplingStrategy( TRegistration::RANDOM );
+
+      typename TRegistration::MetricSamplingPercentageArrayType percentages( numberOfLevels );
+      percentages.Fill( samplingPercentage );
+      registration->SetMetricSamplingPercentagePerLevel( percentages );
+    }
+  }
+}
+
 template <typename TPixel1, unsigned int VImageDimension1, typename TPixel2, unsigned int VImageDimension2>
 void mitk::PyramidImageRegistrationMethod::
 RegisterTwoImagesV4(itk::Image<TPixel1, VImageDimension1>* itkImage1, itk::Image<TPixel2, VImageDimension2>* itkImage2)
@@ -199,7 +264,7 @@ RegisterTwoImagesV4(itk::Image<TPixel1, VImageDimension1>* itkImage1, itk::Image
 
   typedef itk::MatrixOffsetTransformBase< double, VImageDimension1, VImageDimension2 > BaseTransformType;
 
-  typedef itk::Image< double, 3> ItkRegistrationImageType;
+  typedef RegistrationImageType ItkRegistrationImageType;
   typedef itk::CastImageFilter< ItkImageTypeFixed, ItkRegistrationImageType> FixedCastFilterType;
   typedef itk::CastImageFilter< ItkImageTypeMoving, ItkRegistrationImageType> MovingCastFilterType;
 
@@ -239,20 +304,43 @@ RegisterTwoImagesV4(itk::Image<TPixel1, VImageDimension1>* itkImage1, itk::Image
 
   // [Prepare registration]
   //  The ITKv4 Methods ( the MI Metric ) require double-type images so we need to perform cast first
-  typename FixedCastFilterType::Pointer caster_f = FixedCastFilterType::New();
+  //  the cast fixed image is kept for subsequent registrations onto the same reference
+  const bool fixedCacheValid = m_CachedFixedImage.IsNotNull()
+      && m_CachedFixedImageSource == m_FixedImage.GetPointer()
+      && m_CachedFixedImageMTime == m_FixedImage->GetMTime();
+
   typename MovingCastFilterType::Pointer caster_m = MovingCastFilterType::New();
+  ItkRegistrationImageType::Pointer movingRegistrationImage;
 
   try
   {
-    caster_f->SetInput(0, referenceImage );
-    caster_m->SetInput(0, movingImage );
+    if( !fixedCacheValid )
+    {
+      typename FixedCastFilterType::Pointer caster_f = FixedCastFilterType::New();
+      caster_f->SetInput(0, referenceImage );
+      if( m_NumberOfThreads > 0 )
+      {
+        caster_f->SetNumberOfThreads( m_NumberOfThreads );
+      }
+      caster_f->Update();
+
+      m_CachedFixedImage = caster_f->GetOutput();
+      m_CachedFixedImage->DisconnectPipeline();
+      m_CachedFixedImageSource = m_FixedImage.GetPointer();
+      m_CachedFixedImageMTime = m_FixedImage->GetMTime();
+    }
 
-    caster_f->Update();
+    caster_m->SetInput(0, movingImage );
+    if( m_NumberOfThreads > 0 )
+    {
+      caster_m->SetNumberOfThreads( m_NumberOfThreads );
+    }
     caster_m->Update();
-
+    movingRegistrationImage = caster_m->GetOutput();
   }
   catch( const itk::ExceptionObject &/*e*/ )
   {
+    m_CachedFixedImage = nullptr;
     return ;
   }
 
@@ -339,6 +427,12 @@ RegisterTwoImagesV4(itk::Image<TPixel1, VImageDimension1>* itkImage1, itk::Image
   optimizer->SetUpperLimit( 1.7 );
   optimizer->SetMaximumLineSearchIterations( 20 );
 
+  if( m_NumberOfThreads > 0 )
+  {
+    optimizer->SetNumberOfThreads( m_NumberOfThreads );
+    base_metric->SetMaximumNumberOfThreads( m_NumberOfThreads );
+  }
+
   // add observer tag if verbose
   unsigned long vopt_tag = 0;
   if(m_Verbose)
@@ -376,16 +470,7 @@ RegisterTwoImagesV4(itk::Image<TPixel1, VImageDimension1>* itkImage1, itk::Image
   //  Masking (Optional)
   if( m_UseMask )
   {
-    typedef itk::Image<unsigned char, 3> BinaryImageType;
-    BinaryImageType::Pointer itkFixedImageMask = BinaryImageType::New();
-    itk::ImageMaskSpatialObject< 3 >::Pointer fixedMaskSpatialObject = itk::ImageMaskSpatialObject< 3 >::New();
-
-    CastToItkImage( m_FixedImageMask, itkFixedImageMask);
-    itk::NotImageFilter<BinaryImageType, BinaryImageType>::Pointer notFilter = itk::NotImageFilter<BinaryImageType, BinaryImageType>::New();
-    notFilter->SetInput(itkFixedImageMask);
-    notFilter->Update();
-    fixedMaskSpatialObject->SetImage( notFilter->GetOutput() );
-    base_metric->SetFixedImageMask( fixedMaskSpatialObject );
+    base_metric->SetFixedImageMask( this->GetFixedMaskSpatialObject() );
   }
 
 
@@ -406,13 +491,14 @@ RegisterTwoImagesV4(itk::Image<TPixel1, VImageDimension1>* itkImage1, itk::Image
 
     typename RegistrationType::Pointer registration = RegistrationType::New();
 
-    registration->SetFixedImage( 0, caster_f->GetOutput() );
-    registration->SetMovingImage( 0, caster_m->GetOutput() );
+    registration->SetFixedImage( 0, m_CachedFixedImage );
+    registration->SetMovingImage( 0, movingRegistrationImage );
     registration->SetMetric( base_metric );
     registration->SetOptimizer( optimizer );
     registration->SetMovingInitialTransform( transform.GetPointer() );
     registration->SetNumberOfLevels(max_pyramid_lvl);
     registration->SetShrinkFactorsPerLevel( shrink_factors );
+    ConfigureRegistrationSampling( registration.GetPointer(), max_pyramid_lvl, m_MetricSamplingPercentage, m_NumberOfThreads );
 
     // observe the pyramid level change in order to adapt parameters
     typename PyramidOptControlCommandv4<RegistrationType>::Pointer pyramid_observer =
@@ -460,13 +546,14 @@ RegisterTwoImagesV4(itk::Image<TPixel1, VImageDimension1>* itkImage1, itk::Image
 
     typename RigidRegistrationType::Pointer registration = RigidRegistrationType::New();
 
-    registration->SetFixedImage( 0, caster_f->GetOutput() );
-    registration->SetMovingImage( 0, caster_m->GetOutput() );
+    registration->SetFixedImage( 0, m_CachedFixedImage );
+    registration->SetMovingImage( 0, movingRegistrationImage );
     registration->SetMetric( base_metric );
     registration->SetOptimizer( optimizer );
     registration->SetMovingInitialTransform( transform.GetPointer() );
     registration->SetNumberOfLevels(max_pyramid_lvl);
     registration->SetShrinkFactorsPerLevel( shrink_factors );
+    ConfigureRegistrationSampling( registration.GetPointer(), max_pyramid_lvl, m_MetricSamplingPercentage, m_NumberOfThreads );
 
     // observe the pyramid level change in order to adapt parameters
     typename PyramidOptControlCommandv4<RigidRegistrationType>::Pointer pyramid_observer =
@@ -22,11 +22,15 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkScalarImageToHistogramGenerator.h"
 #include "itkListSample.h"
 
+#include <vector>
+
 namespace mitk
 {
 
   PartialVolumeAnalysisClusteringCalculator::PartialVolumeAnalysisClusteringCalculator()
-    : m_MaxIt(100), m_StepsNumIntegration(100)
+    : m_MaxIt(100), m_StepsNumIntegration(100),
+      m_CachedHistogramMTime(0), m_CachedMaxIt(0), m_CachedStepsNumIntegration(0),
+      m_CachedResult(0)
   {
   }
 
@@ -202,27 +206,29 @@ namespace mitk
       }
     }
 
-    for(int i=0; i<arraysz; i++)
+    // the parameters of the partial volume gaussians only depend on the
+    // integration step, so they are computed once for all bins
+    std::vector<double> stepMeans, stepExpFactors, stepAmps;
+    double p = 1.0 - params.ps[0] - params.ps[1];
+    for(double t=0; t<=1; t = t + 1.0/(m_StepsNumIntegration-1.0))
     {
-      result.mixedVals[0](i) = 0;
+      double v = t*params.sigmas[0]+(1-t)*params.sigmas[1];
+      stepMeans.push_back(t*params.means[0]+(1-t)*params.means[1]);
+      stepExpFactors.push_back(-0.5/v);
+      stepAmps.push_back((1.0/m_StepsNumIntegration) * p / sqrt(2.0*itk::Math::pi*v));
     }
+    int numSteps = stepMeans.size();
 
-    for(double t=0; t<=1; t = t + 1.0/(m_StepsNumIntegration-1.0))
+#pragma omp parallel for if(arraysz*numSteps > 10000)
+    for(int i=0; i<arraysz; i++)
     {
-      for(int i=0; i<arraysz; i++)
+      double mixed = 0;
+      for(int t=0; t<numSteps; t++)
       {
-        double d = xVals(i)-(t*params.means[0]+(1-t)*params.means[1]);
-        double v = t*params.sigmas[0]+(1-t)*params.sigmas[1];
-        double p = 1.0 - params.ps[0] - params.ps[1];
-        double amp = (1.0/m_StepsNumIntegration) * p / sqrt(2.0*itk::Math::pi*v);
-
-        result.mixedVals[0](i) = result.mixedVals[0](i) + amp*exp(-0.5 * (d*d)/v);
-
-        //        MITK_INFO << "d=" << d << "v=" <<v << "p=" << p << "amp=" << amp << "result=" << amp*exp(-0.5 * (d*d)/v) << std::endl;
+        double d = xVals(i)-stepMeans[t];
+        mixed += stepAmps[t]*exp(d*d*stepExpFactors[t]);
       }
-      //      MITK_INFO << "t=" << t << std::endl;
-      //      params.Print();
-      //      result.Print();
+      result.mixedVals[0](i) = mixed;
     }
 
     for(int i=0; i<arraysz; i++)
@@ -233,6 +239,34 @@ namespace mitk
     return result;
   }
 
+  void PartialVolumeAnalysisClusteringCalculator::ClusterHistogram(
+      const MitkHistType *histogram, const HistType& h, ParamsType& params, ClusterResultType& result) const
+  {
+    if( m_CachedHistogram.GetPointer() != histogram
+        || m_CachedHistogramMTime != histogram->GetMTime()
+        || m_CachedMaxIt != m_MaxIt
+        || m_CachedStepsNumIntegration != m_StepsNumIntegration )
+    {
+      ParamsType* initialGuess = InitialGuess(h);
+      ParamsType* fit = Cluster(h, initialGuess);
+      m_CachedParams.Initialize(fit);
+      delete fit;
+      delete initialGuess;
+
+      ClusterResultType curves = CalculateCurves(m_CachedParams, h.xVals);
+      Normalize(m_CachedParams, &curves);
+      m_CachedResult.Initialize(&curves);
+
+      m_CachedHistogram = histogram;
+      m_CachedHistogramMTime = histogram->GetMTime();
+      m_CachedMaxIt = m_MaxIt;
+      m_CachedStepsNumIntegration = m_StepsNumIntegration;
+    }
+
+    params.Initialize(&m_CachedParams);
+    result.Initialize(&m_CachedResult);
+  }
+
   PartialVolumeAnalysisClusteringCalculator::HelperStructPerformRGBClusteringRetval*
       PartialVolumeAnalysisClusteringCalculator::PerformRGBClustering(mitk::Image::ConstPointer image, const MitkHistType *histogram) const
   {
@@ -380,9 +414,8 @@ namespace mitk
       retval->hist->InitByMitkHistogram(histogram);
 
       ParamsType params;
-      params.Initialize( Cluster(*(retval->hist)) );
-      ClusterResultType result = CalculateCurves(params,retval->hist->xVals);
-      Normalize(params, &result);
+      ClusterResultType result(retval->hist->xVals.size());
+      ClusterHistogram(histogram, *(retval->hist), params, result);
 
       retval->params = new ParamsType();
       retval->params->Initialize(&params);
@@ -518,55 +551,69 @@ namespace mitk
     rgba.Set(0.0f, 0.0f, 0.0f, 0.0f);
     displayimage->FillBuffer(rgba);
 
-    itk::ImageRegionConstIterator<ImageType>
-        itimage(image, image->GetLargestPossibleRegion());
-
-    itk::ImageRegionIterator<ProbImageType>
-        itprob(probimage, probimage->GetLargestPossibleRegion());
-
-    itk::ImageRegionIterator<DisplayImageType>
-        itdisp(displayimage, displayimage->GetLargestPossibleRegion());
+    // a posteriori probability of each histogram bin
+    int numBins = clusterResults.interestingHist->GetSize(0);
+    std::vector<double> aposterioriLut(numBins);
+    for(int b=0; b<numBins; b++)
+    {
+      double aprioriProb = clusterResults.interestingHist->GetFrequency(b);
+      double intensityProb = clusterResults.totalHist->GetFrequency(b);
+      aposterioriLut[b] = clusterResults.p_interesting * aprioriProb / intensityProb;
+    }
 
-    itimage.GoToBegin();
-    itprob.GoToBegin();
+    // classify the voxels in parallel, all image buffers have the same layout
+    const TPixel* imageBuffer = image->GetBufferPointer();
+    float* probBuffer = probimage->GetBufferPointer();
+    long numPixels = image->GetLargestPossibleRegion().GetNumberOfPixels();
+    long numNotFound = 0;
 
-    MitkHistType::IndexType index(1);
-    float maxp = 0;
-    while( !itimage.IsAtEnd() )
+#pragma omp parallel
     {
-      if(itimage.Get())
-      {
-        MitkHistType::MeasurementVectorType meas(1);
-        meas.Fill(itimage.Get());
-        double aposteriori = 0;
-        bool success = clusterResults.interestingHist->GetIndex(meas, index );
-        if(success)
-        {
-          double aprioriProb = clusterResults.interestingHist->GetFrequency(index);
-          double intensityProb = clusterResults.totalHist->GetFrequency(index);
-          double p_interesting = clusterResults.p_interesting;
-          aposteriori = p_interesting * aprioriProb / intensityProb;
-        }
-        else
-        {
-          MITK_ERROR << "index not found in histogram";
-        }
+      MitkHistType::IndexType index(1);
+      MitkHistType::MeasurementVectorType meas(1);
+      long numNotFoundThread = 0;
 
-        if(aposteriori > 0.0000000000000001)
-        {
-          itprob.Set( aposteriori );
-          maxp = aposteriori > maxp ? aposteriori : maxp;
-        }
-        else
+#pragma omp for
+      for(long i=0; i<numPixels; i++)
+      {
+        if(imageBuffer[i])
         {
-          itprob.Set(0.0f);
+          meas.Fill(imageBuffer[i]);
+          double aposteriori = 0;
+          if(clusterResults.interestingHist->GetIndex(meas, index ))
+          {
+            aposteriori = aposterioriLut[index[0]];
+          }
+          else
+          {
+            numNotFoundThread++;
+          }
+
+          probBuffer[i] = aposteriori > 0.0000000000000001 ? aposteriori : 0.0f;
         }
       }
 
-      ++itimage;
-      ++itprob;
+#pragma omp critical
+      numNotFound += numNotFoundThread;
     }
 
+    if(numNotFound > 0)
+    {
+      MITK_ERROR << "index not found in histogram (" << numNotFound << " voxels)";
+    }
+
+    float maxp = 0;
+    for(long i=0; i<numPixels; i++)
+    {
+      maxp = probBuffer[i] > maxp ? probBuffer[i] : maxp;
+    }
+
+    itk::ImageRegionIterator<ProbImageType>
+        itprob(probimage, probimage->GetLargestPossibleRegion());
+
+    itk::ImageRegionIterator<DisplayImageType>
+        itdisp(displayimage, displayimage->GetLargestPossibleRegion());
+
     itprob.GoToBegin();
     itdisp.GoToBegin();
 
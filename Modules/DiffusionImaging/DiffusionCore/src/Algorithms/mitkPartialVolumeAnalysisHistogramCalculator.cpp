@@ -71,7 +71,8 @@ namespace mitk
     m_UpsamplingFactor(1),
     m_GaussianSigma(0),
     m_ForceUpdate(false),
-    m_PlanarFigureThickness(0)
+    m_PlanarFigureThickness(0),
+    m_ExtractionModified(true)
   {
     m_EmptyHistogram = HistogramType::New();
     m_EmptyHistogram->SetMeasurementVectorSize(1);
@@ -93,6 +94,7 @@ namespace mitk
     if ( m_Image != image )
     {
       m_Image = image;
+      m_ExtractionModified = true;
       this->Modified();
 
       m_ImageStatisticsTimeStamp.Modified();
@@ -103,6 +105,7 @@ namespace mitk
   void PartialVolumeAnalysisHistogramCalculator::AddAdditionalResamplingImage( const mitk::Image *image )
   {
     m_AdditionalResamplingImages.push_back(image);
+    m_ExtractionModified = true;
     this->Modified();
     m_ImageStatisticsTimeStamp.Modified();
     m_ImageStatisticsCalculationTriggerBool = true;
@@ -134,6 +137,7 @@ namespace mitk
     if ( m_ImageMask != imageMask )
     {
       m_ImageMask = imageMask;
+      m_ExtractionModified = true;
       this->Modified();
 
       m_MaskedImageStatisticsTimeStamp.Modified();
@@ -152,6 +156,7 @@ namespace mitk
     if ( m_PlanarFigure != planarFigure )
     {
       m_PlanarFigure = planarFigure;
+      m_ExtractionModified = true;
       this->Modified();
 
       m_PlanarFigureStatisticsTimeStamp.Modified();
@@ -166,6 +171,7 @@ namespace mitk
     {
       m_MaskingMode = mode;
       m_MaskingModeChanged = true;
+      m_ExtractionModified = true;
       this->Modified();
     }
   }
@@ -177,6 +183,7 @@ namespace mitk
     {
       m_MaskingMode = MASKING_MODE_NONE;
       m_MaskingModeChanged = true;
+      m_ExtractionModified = true;
       this->Modified();
     }
   }
@@ -188,6 +195,7 @@ namespace mitk
     {
       m_MaskingMode = MASKING_MODE_IMAGE;
       m_MaskingModeChanged = true;
+      m_ExtractionModified = true;
       this->Modified();
     }
   }
@@ -199,6 +207,7 @@ namespace mitk
     {
       m_MaskingMode = MASKING_MODE_PLANARFIGURE;
       m_MaskingModeChanged = true;
+      m_ExtractionModified = true;
       this->Modified();
     }
   }
@@ -260,8 +269,14 @@ namespace mitk
 
 
     // Depending on masking mode, extract and/or generate the required image
-    // and mask data from the user input
-    this->ExtractImageAndMask( );
+    // and mask data from the user input. If only the histogram parameters
+    // changed, the previous extraction is reused.
+    if ( !this->IsExtractionUpToDate() )
+    {
+      this->ExtractImageAndMask( );
+      m_ExtractionModified = false;
+      m_ExtractionTimeStamp.Modified();
+    }
 
 
     Statistics *statistics;
@@ -345,14 +360,43 @@ namespace mitk
       MITK_ERROR << "ImageStatistics: Image dimension not supported!";
     }
 
-    // Release unused image smart pointers to free memory
-    // m_InternalImage = mitk::Image::Pointer();
-    m_InternalImageMask3D = MaskImage3DType::Pointer();
-    m_InternalImageMask2D = MaskImage2DType::Pointer();
+    // The internal image and masks are kept, so that changing only the number
+    // of bins does not repeat the extraction
     return true;
   }
 
 
+  bool PartialVolumeAnalysisHistogramCalculator::IsExtractionUpToDate( ) const
+  {
+    if ( m_ForceUpdate || m_ExtractionModified || m_InternalImage.IsNull() )
+    {
+      return false;
+    }
+
+    unsigned long extractionMTime = m_ExtractionTimeStamp.GetMTime();
+    if ( m_Image->GetMTime() > extractionMTime )
+    {
+      return false;
+    }
+
+    switch ( m_MaskingMode )
+    {
+    case MASKING_MODE_IMAGE:
+      return m_ImageMask.IsNotNull() && m_InternalImageMask3D.IsNotNull()
+          && m_ImageMask->GetMTime() <= extractionMTime;
+
+    case MASKING_MODE_PLANARFIGURE:
+      return m_PlanarFigure.IsNotNull()
+          && ( m_InternalImageMask3D.IsNotNull() || m_InternalImageMask2D.IsNotNull() )
+          && m_PlanarFigure->GetMTime() <= extractionMTime;
+
+    case MASKING_MODE_NONE:
+    default:
+      return true;
+    }
+  }
+
+
   const PartialVolumeAnalysisHistogramCalculator::HistogramType *
       PartialVolumeAnalysisHistogramCalculator::GetHistogram( ) const
   {
@@ -16,6 +16,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkDiffusionHeaderDICOMFileReader.h"
 
+#include <omp.h>
+
 mitk::DiffusionHeaderDICOMFileReader
 ::DiffusionHeaderDICOMFileReader()
 {
@@ -40,6 +42,46 @@ mitk::DiffusionHeaderDICOMFileReader
   return m_HeaderInformationList;
 }
 
+bool mitk::DiffusionHeaderDICOMFileReader
+::ReadDiffusionHeaders( const std::vector< std::string >& filenames )
+{
+  const int numberOfFiles = static_cast< int >( filenames.size() );
+  if( numberOfFiles < 1 )
+    return false;
+
+  // one reader per file, the vendor readers keep their state in members
+  std::vector< Self::Pointer > fileReaders( numberOfFiles );
+  for( int i = 0; i < numberOfFiles; ++i )
+  {
+    fileReaders[i] = dynamic_cast< Self* >( this->CreateAnother().GetPointer() );
+    if( fileReaders[i].IsNull() )
+    {
+      // no vendor type to clone, parse sequentially
+      bool canread = false;
+      for( const auto& filename : filenames )
+        canread = this->ReadDiffusionHeader( filename );
+
+      return canread;
+    }
+  }
+
+  std::vector< char > canread( numberOfFiles, 0 );
+
+#pragma omp parallel for schedule(dynamic)
+  for( int i = 0; i < numberOfFiles; ++i )
+  {
+    canread[i] = fileReaders[i]->ReadDiffusionHeader( filenames[i] ) ? 1 : 0;
+  }
+
+  for( int i = 0; i < numberOfFiles; ++i )
+  {
+    const DICOMHeaderListType& fileHeader = fileReaders[i]->m_HeaderInformationList;
+    m_HeaderInformationList.insert( m_HeaderInformationList.end(), fileHeader.begin(), fileHeader.end() );
+  }
+
+  return canread.back() != 0;
+}
+
 bool mitk::RevealBinaryTag(const gdcm::Tag tag, const gdcm::DataSet& dataset, std::string& target)
 {
   if( dataset.FindDataElement( tag ) )
@@ -44,36 +44,50 @@ int vtkOdfSource::RequestData(
   // get the ouptut
   vtkPolyData *output = vtkPolyData::SafeDownCast(outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
+  vtkCellArray* polys = TemplateOdf->GetPolys();
+  output->SetPolys(polys);
+  polys->InitTraversal();
+  vtkSmartPointer<vtkPoints> newPoints = vtkSmartPointer<vtkPoints>::New();
+  newPoints->Allocate(TemplateOdf->GetPoints()->GetNumberOfPoints());
+
+  vtkSmartPointer<vtkUnsignedCharArray> point_colors = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  point_colors->Allocate(output->GetNumberOfPoints() * 4);
+  point_colors->SetNumberOfComponents(4);
+  point_colors->SetName("ODF_COLORS");
+
+  double center[3] = {0, 0, 0};
+  AppendGlyph(Odf, Scale, center, newPoints, point_colors);
+
+  output->SetPoints(newPoints);
+  output->GetPointData()->AddArray(point_colors);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkOdfSource::AppendGlyph(OdfType odf, double scale, const double center[3], vtkPoints* points, vtkUnsignedCharArray* colors)
+{
+  vtkPolyData* TemplateOdf = OdfType::GetBaseMesh();
+
   OdfType colorOdf;
   switch(Normalization)
   {
   case mitk::ODFN_MINMAX:
-    Odf = Odf.MinMaxNormalize();
-    colorOdf = Odf;
+    odf = odf.MinMaxNormalize();
+    colorOdf = odf;
     break;
   case mitk::ODFN_MAX:
-    Odf = Odf.MaxNormalize();
-    colorOdf = Odf;
+    odf = odf.MaxNormalize();
+    colorOdf = odf;
     break;
   case mitk::ODFN_NONE:
-    colorOdf = Odf.MaxNormalize();
+    colorOdf = odf.MaxNormalize();
     break;
   default:
-    Odf = Odf.MaxNormalize();
-    colorOdf = Odf;
+    odf = odf.MaxNormalize();
+    colorOdf = odf;
   }
 
-  vtkCellArray* polys = TemplateOdf->GetPolys();
-  output->SetPolys(polys);
-  polys->InitTraversal();
-  vtkSmartPointer<vtkPoints> newPoints = vtkSmartPointer<vtkPoints>::New();
   int numPoints = TemplateOdf->GetPoints()->GetNumberOfPoints();
-  newPoints->Allocate(numPoints);
-
-  vtkSmartPointer<vtkUnsignedCharArray> point_colors = vtkSmartPointer<vtkUnsignedCharArray>::New();
-  point_colors->Allocate(output->GetNumberOfPoints() * 4);
-  point_colors->SetNumberOfComponents(4);
-  point_colors->SetName("ODF_COLORS");
   unsigned char rgba[4];
   double rgb[3];
 
@@ -81,11 +95,11 @@ int vtkOdfSource::RequestData(
   {
     double p[3];
     TemplateOdf->GetPoints()->GetPoint(j,p);
-    double val = Odf.GetElement(j);
-    p[0] *= val*Scale*AdditionalScale*0.5;
-    p[1] *= val*Scale*AdditionalScale*0.5;
-    p[2] *= val*Scale*AdditionalScale*0.5;
-    newPoints->InsertNextPoint(p);
+    double val = odf.GetElement(j);
+    p[0] = center[0] + p[0]*val*scale*AdditionalScale*0.5;
+    p[1] = center[1] + p[1]*val*scale*AdditionalScale*0.5;
+    p[2] = center[2] + p[2]*val*scale*AdditionalScale*0.5;
+    points->InsertNextPoint(p);
 
     if (UseCustomColor)
     {
@@ -102,11 +116,8 @@ int vtkOdfSource::RequestData(
       rgba[2] = (unsigned char)(255.0*rgb[2]);
     }
     rgba[3] = 255;
-    point_colors->InsertTypedTuple(j, rgba);
+    colors->InsertNextTypedTuple(rgba);
   }
-  output->SetPoints(newPoints);
-  output->GetPointData()->AddArray(point_colors);
-  return 1;
 }
 
 //----------------------------------------------------------------------------
@@ -22,6 +22,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <boost/math/special_functions/spherical_harmonic.hpp>
 #include <boost/version.hpp>
 #include <itkPointShell.h>
+#include <algorithm>
 
 // Namespace ::Gradients
 #include "itkVectorContainer.h"
@@ -130,6 +131,31 @@ vnl_matrix<float> mitk::sh::CalcShBasisForDirections(int sh_order, vnl_matrix<do
   return sh_basis;
 }
 
+void mitk::sh::EvaluateSh(const vnl_matrix<float>& basisT, const float* coefficients, unsigned int numVoxels, float* values)
+{
+  const unsigned int numCoeffs = basisT.rows();
+  const unsigned int numDirections = basisT.cols();
+  const unsigned int blockSize = 256;
+
+  std::fill(values, values + static_cast<std::size_t>(numVoxels)*numDirections, 0.0f);
+  for (unsigned int first=0; first<numDirections; first+=blockSize)
+  {
+    const unsigned int last = std::min(first + blockSize, numDirections);
+    for (unsigned int v=0; v<numVoxels; ++v)
+    {
+      const float* c = coefficients + static_cast<std::size_t>(v)*numCoeffs;
+      float* out = values + static_cast<std::size_t>(v)*numDirections;
+      for (unsigned int k=0; k<numCoeffs; ++k)
+      {
+        const float ck = c[k];
+        const float* b = basisT[k];
+        for (unsigned int i=first; i<last; ++i)
+          out[i] += ck*b[i];
+      }
+    }
+  }
+}
+
 //------------------------- gradients-function ------------------------------------
 
 std::vector<unsigned int> mitk::gradients::GetAllUniqueDirections(const BValueMap & refBValueMap, GradientDirectionContainerType *refGradientsContainer )
@@ -0,0 +1,195 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#include "mitkFiberBundleLevelOfDetail.h"
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPointData.h>
+#include <omp.h>
+
+namespace
+{
+  void CopyPoint(vtkPoints* inPoints, const unsigned char* inColors, int numComponents, vtkIdType id, float* outCoords, unsigned char* outColors, vtkIdType& out)
+  {
+    double p[3];
+    inPoints->GetPoint(id, p);
+    for (int d=0; d<3; ++d)
+      outCoords[3*out+d] = static_cast<float>(p[d]);
+    for (int c=0; c<numComponents; ++c)
+      outColors[numComponents*out+c] = inColors[numComponents*id+c];
+    ++out;
+  }
+}
+
+mitk::FiberBundleLevelOfDetail::FiberBundleLevelOfDetail()
+  : m_FiberPolyData(nullptr)
+  , m_FiberPolyDataMTime(0)
+  , m_FiberColors(nullptr)
+  , m_FiberColorsMTime(0)
+  , m_PointSpacing(0.0)
+  , m_MaxLevel(3)
+{
+}
+
+void mitk::FiberBundleLevelOfDetail::Clear()
+{
+  m_Levels.clear();
+  m_FiberPolyData = nullptr;
+  m_FiberPolyDataMTime = 0;
+  m_FiberColors = nullptr;
+  m_FiberColorsMTime = 0;
+  m_PointSpacing = 0.0;
+}
+
+void mitk::FiberBundleLevelOfDetail::SetInput(FiberBundle* fiberBundle)
+{
+  if (fiberBundle==nullptr || fiberBundle->GetFiberPolyData()==nullptr)
+  {
+    this->Clear();
+    return;
+  }
+
+  vtkPolyData* fiberPolyData = fiberBundle->GetFiberPolyData();
+  vtkUnsignedCharArray* colors = fiberBundle->GetFiberColors();
+  unsigned long colorsMTime = colors!=nullptr ? colors->GetMTime() : 0;
+
+  if (fiberPolyData==m_FiberPolyData && fiberPolyData->GetMTime()==m_FiberPolyDataMTime && colors==m_FiberColors && colorsMTime==m_FiberColorsMTime)
+    return;
+
+  this->Clear();
+  m_FiberPolyData = fiberPolyData;
+  m_FiberPolyDataMTime = fiberPolyData->GetMTime();
+  m_FiberColors = colors;
+  m_FiberColorsMTime = colorsMTime;
+  m_Levels.resize(m_MaxLevel+1);
+  m_Levels[0] = fiberPolyData;
+
+  long numSegments = static_cast<long>(fiberBundle->GetNumberOfPoints()) - fiberBundle->GetNumFibers();
+  if (numSegments>0)
+    m_PointSpacing = fiberBundle->GetMeanFiberLength()*fiberBundle->GetNumFibers()/numSegments;
+}
+
+void mitk::FiberBundleLevelOfDetail::SetMaxLevel(unsigned int level)
+{
+  if (level==m_MaxLevel)
+    return;
+  m_MaxLevel = level;
+  if (!m_Levels.empty())
+    m_Levels.resize(m_MaxLevel+1);
+}
+
+unsigned int mitk::FiberBundleLevelOfDetail::GetLevelForPointSpacing(double spacing) const
+{
+  unsigned int level = 0;
+  if (m_PointSpacing<=0.0)
+    return level;
+  while (level<m_MaxLevel && m_PointSpacing*(2u<<level)<=spacing)
+    ++level;
+  return level;
+}
+
+vtkPolyData* mitk::FiberBundleLevelOfDetail::GetLevel(unsigned int level)
+{
+  if (m_Levels.empty())
+    return nullptr;
+  if (level>m_MaxLevel)
+    level = m_MaxLevel;
+
+  if (m_Levels[level]==nullptr)
+    m_Levels[level] = GenerateLevel(m_FiberPolyData, m_FiberColors, 1u<<level);
+  return m_Levels[level];
+}
+
+vtkSmartPointer<vtkPolyData> mitk::FiberBundleLevelOfDetail::GenerateLevel(vtkPolyData* fiberPolyData, vtkUnsignedCharArray* colors, unsigned int stride)
+{
+  vtkPoints* inPoints = fiberPolyData->GetPoints();
+  vtkCellArray* inLines = fiberPolyData->GetLines();
+  int numFibers = inLines!=nullptr ? static_cast<int>(inLines->GetNumberOfCells()) : 0;
+  if (inPoints==nullptr || numFibers==0 || stride<1)
+    return fiberPolyData;
+
+  // start of every fiber in the raw connectivity array (n, id_0, ..., id_n-1) and in the subsampled point list
+  const vtkIdType* connectivity = inLines->GetPointer();
+  std::vector< vtkIdType > cellStart(numFibers);
+  std::vector< vtkIdType > outStart(numFibers+1, 0);
+  vtkIdType loc = 0;
+  for (int i=0; i<numFibers; ++i)
+  {
+    cellStart[i] = loc;
+    vtkIdType numPoints = connectivity[loc];
+    vtkIdType numOutPoints = numPoints>0 ? (numPoints-1)/stride + 1 : 0;
+    if (numPoints>0 && (numPoints-1)%stride!=0)
+      ++numOutPoints;
+    outStart[i+1] = outStart[i] + numOutPoints;
+    loc += numPoints + 1;
+  }
+  vtkIdType numOutPoints = outStart[numFibers];
+
+  bool copyColors = colors!=nullptr && colors->GetNumberOfTuples()>=inPoints->GetNumberOfPoints();
+  int numComponents = copyColors ? colors->GetNumberOfComponents() : 0;
+
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetDataTypeToFloat();
+  points->SetNumberOfPoints(numOutPoints);
+  float* outCoords = static_cast<float*>(points->GetVoidPointer(0));
+
+  vtkSmartPointer<vtkIdTypeArray> cells = vtkSmartPointer<vtkIdTypeArray>::New();
+  cells->SetNumberOfValues(numOutPoints + numFibers);
+  vtkIdType* outCells = cells->GetPointer(0);
+
+  vtkSmartPointer<vtkUnsignedCharArray> outColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  outColors->SetName("FIBER_COLORS");
+  unsigned char* outColorValues = nullptr;
+  const unsigned char* inColorValues = nullptr;
+  if (copyColors)
+  {
+    outColors->SetNumberOfComponents(numComponents);
+    outColors->SetNumberOfTuples(numOutPoints);
+    outColorValues = outColors->GetPointer(0);
+    inColorValues = colors->GetPointer(0);
+  }
+
+#pragma omp parallel for schedule(static)
+  for (int i=0; i<numFibers; ++i)
+  {
+    vtkIdType numPoints = connectivity[cellStart[i]];
+    const vtkIdType* ids = connectivity + cellStart[i] + 1;
+
+    vtkIdType* cell = outCells + outStart[i] + i;
+    *cell = outStart[i+1]-outStart[i];
+
+    vtkIdType out = outStart[i];
+    for (vtkIdType j=0; j<numPoints; j+=stride)
+      CopyPoint(inPoints, inColorValues, numComponents, ids[j], outCoords, outColorValues, out);
+    if (numPoints>0 && (numPoints-1)%stride!=0)
+      CopyPoint(inPoints, inColorValues, numComponents, ids[numPoints-1], outCoords, outColorValues, out);
+
+    for (vtkIdType j=outStart[i]; j<outStart[i+1]; ++j)
+      *(++cell) = j;
+  }
+
+  vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+  lines->SetCells(numFibers, cells);
+
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  polyData->SetPoints(points);
+  polyData->SetLines(lines);
+  if (copyColors)
+    polyData->GetPointData()->AddArray(outColors);
+  return polyData;
+}
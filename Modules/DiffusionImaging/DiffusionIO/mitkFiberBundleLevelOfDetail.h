@@ -0,0 +1,75 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#ifndef FiberBundleLevelOfDetail_H_HEADER_INCLUDED
+#define FiberBundleLevelOfDetail_H_HEADER_INCLUDED
+
+#include <mitkFiberBundle.h>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <vtkUnsignedCharArray.h>
+#include <vector>
+
+namespace mitk {
+
+//##Documentation
+//## @brief Precomputed coarser versions of the fiber polydata that are used by the fiber bundle mappers.
+//##
+//## Level 0 is the original fiber polydata. On level l only every 2^l-th point of each fiber
+//## (and always its last point) is kept and the FIBER_COLORS array is subsampled accordingly.
+//## Levels are generated on first request and dropped as soon as the fibers or their colors change.
+//## @ingroup Mapper
+class FiberBundleLevelOfDetail
+{
+public:
+
+  FiberBundleLevelOfDetail();
+
+  /** Sets the fiber bundle. Already generated levels are kept if the fibers and colors did not change. */
+  void SetInput(FiberBundle* fiberBundle);
+
+  void SetMaxLevel(unsigned int level);
+  unsigned int GetMaxLevel() const { return m_MaxLevel; }
+
+  /** Returns the polydata of the given level (clamped to the maximum level). Generated on first request. */
+  vtkPolyData* GetLevel(unsigned int level);
+
+  /** Mean distance between two consecutive fiber points on level 0 */
+  double GetPointSpacing() const { return m_PointSpacing; }
+
+  /** Coarsest level whose point spacing does not exceed the given distance (in mm) */
+  unsigned int GetLevelForPointSpacing(double spacing) const;
+
+  /** Subsamples every fiber of the polydata by keeping each stride-th point and the last point. */
+  static vtkSmartPointer<vtkPolyData> GenerateLevel(vtkPolyData* fiberPolyData, vtkUnsignedCharArray* colors, unsigned int stride);
+
+private:
+
+  void Clear();
+
+  vtkPolyData*          m_FiberPolyData;
+  unsigned long         m_FiberPolyDataMTime;
+  vtkUnsignedCharArray* m_FiberColors;
+  unsigned long         m_FiberColorsMTime;
+  double                m_PointSpacing;
+  unsigned int          m_MaxLevel;
+  std::vector< vtkSmartPointer<vtkPolyData> > m_Levels;
+};
+
+} // end namespace mitk
+
+#endif /* FiberBundleLevelOfDetail_H_HEADER_INCLUDED */
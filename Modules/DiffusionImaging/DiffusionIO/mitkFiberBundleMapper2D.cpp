@@ -151,14 +151,24 @@ void mitk::FiberBundleMapper2D::Update(mitk::BaseRenderer * renderer)
     fiberBundle->RequestUpdate2D();
   }
 
+  int maxLevel = 3;
+  node->GetIntProperty("Fiber2DLevelOfDetailMaxLevel", maxLevel);
+  m_LevelOfDetail.SetMaxLevel(maxLevel>0 ? maxLevel : 0);
+
   vtkProperty *property = localStorage->m_Actor->GetProperty();
   property->SetLighting(false);
+  property->SetLineWidth(m_LineWidth);
 
-  if ( localStorage->m_LastUpdateTime<renderer->GetCurrentWorldPlaneGeometryUpdateTime() || localStorage->m_LastUpdateTime<fiberBundle->GetUpdateTime2D() )
+  // slice changes only touch the slicingPlane uniform (see vtkShaderCallback), the fibers stay on the GPU
+  if ( localStorage->m_LastUpdateTime<fiberBundle->GetUpdateTime2D() )
   {
     this->UpdateShaderParameter(renderer);
     this->GenerateDataForRenderer( renderer );
   }
+
+  MITKFIBERBUNDLEMAPPER2D_POLYDATAMAPPER* mapper = this->GetLevelMapper(renderer, this->GetLevelOfDetail(renderer));
+  if (mapper!=nullptr && localStorage->m_Actor->GetMapper()!=mapper)
+    localStorage->m_Actor->SetMapper(mapper);
 }
 
 void mitk::FiberBundleMapper2D::UpdateShaderParameter(mitk::BaseRenderer *)
@@ -166,6 +176,103 @@ void mitk::FiberBundleMapper2D::UpdateShaderParameter(mitk::BaseRenderer *)
   // see new vtkShaderCallback
 }
 
+unsigned int mitk::FiberBundleMapper2D::GetLevelOfDetail(mitk::BaseRenderer *renderer)
+{
+  bool useLevelOfDetail = true;
+  this->GetDataNode()->GetBoolProperty("Fiber2DLevelOfDetail", useLevelOfDetail, renderer);
+  if (!useLevelOfDetail)
+    return 0;
+
+  // the fibers are drawn as lines, so point distances below one display pixel are not visible anyway
+  return m_LevelOfDetail.GetLevelForPointSpacing(renderer->GetScaleFactorMMPerDisplayUnit());
+}
+
+MITKFIBERBUNDLEMAPPER2D_POLYDATAMAPPER* mitk::FiberBundleMapper2D::GetLevelMapper(mitk::BaseRenderer *renderer, unsigned int level)
+{
+  FBXLocalStorage *localStorage = m_LocalStorageHandler.GetLocalStorage(renderer);
+
+  vtkPolyData* fiberPolyData = m_LevelOfDetail.GetLevel(level);
+  if (fiberPolyData == nullptr)
+    return nullptr;
+  if (level>m_LevelOfDetail.GetMaxLevel())
+    level = m_LevelOfDetail.GetMaxLevel();
+
+  if (localStorage->m_Mappers.size()<=level)
+    localStorage->m_Mappers.resize(level+1);
+
+  vtkSmartPointer<MITKFIBERBUNDLEMAPPER2D_POLYDATAMAPPER>& mapper = localStorage->m_Mappers[level];
+  if (mapper == nullptr)
+  {
+    mapper = vtkSmartPointer<MITKFIBERBUNDLEMAPPER2D_POLYDATAMAPPER>::New();
+    mapper->ScalarVisibilityOn();
+    mapper->SetScalarModeToUsePointFieldData();
+    mapper->SetLookupTable(m_lut);  //apply the properties after the slice was set
+    mapper->SelectColorArray("FIBER_COLORS");
+
+    mapper->SetVertexShaderCode(
+          "//VTK::System::Dec\n"
+          "attribute vec4 vertexMC;\n"
+
+          "//VTK::Normal::Dec\n"
+          "uniform mat4 MCDCMatrix;\n"
+
+          "//VTK::Color::Dec\n"
+
+          "varying vec4 positionWorld;\n"
+          "varying vec4 colorVertex;\n"
+
+          "void main(void)\n"
+          "{\n"
+          "  colorVertex = scalarColor;\n"
+          "  positionWorld = vertexMC;\n"
+          "  gl_Position = MCDCMatrix * vertexMC;\n"
+          "}\n"
+          );
+
+    mapper->SetFragmentShaderCode(
+          "//VTK::System::Dec\n"  // always start with this line
+          "//VTK::Output::Dec\n"  // always have this line in your FS
+          "uniform vec4 slicingPlane;\n"
+          "uniform float fiberThickness;\n"
+          "uniform int fiberFadingON;\n"
+          "uniform float fiberOpacity;\n"
+
+          "varying vec4 positionWorld;\n"
+          "varying vec4 colorVertex;\n"
+          "out vec4 out_Color;\n"
+
+          "void main(void)\n"
+          "{\n"
+          "  float r1 = dot(positionWorld.xyz, slicingPlane.xyz) - slicingPlane.w;\n"
+
+          "  if (abs(r1) >= fiberThickness)\n"
+          "    discard;\n"
+
+          "  if (fiberFadingON != 0)\n"
+          "  {\n"
+          "    float x = (r1 + fiberThickness) / (fiberThickness*2.0);\n"
+          "    x = 1.0 - x;\n"
+          "    out_Color = vec4(colorVertex.xyz*x, fiberOpacity);\n"
+          "  }\n"
+          "  else{\n"
+          "    out_Color = vec4(colorVertex.xyz, fiberOpacity);\n"
+          "  }\n"
+          "}\n"
+          );
+
+    // the callback reads the current slice on every render, so it is registered only once per mapper
+    vtkSmartPointer<vtkShaderCallback> myCallback = vtkSmartPointer<vtkShaderCallback>::New();
+    myCallback->renderer = renderer;
+    myCallback->node = this->GetDataNode();
+    mapper->AddObserver(vtkCommand::UpdateShaderEvent,myCallback);
+  }
+
+  if (mapper->GetInput()!=fiberPolyData)
+    mapper->SetInputData(fiberPolyData);
+
+  return mapper;
+}
+
 // vtkActors and Mappers are feeded here
 void mitk::FiberBundleMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *renderer)
 {
@@ -183,71 +290,13 @@ void mitk::FiberBundleMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rend
     return;
 
   fiberPolyData->GetPointData()->AddArray(fiberBundle->GetFiberColors());
-  localStorage->m_Mapper->ScalarVisibilityOn();
-  localStorage->m_Mapper->SetScalarModeToUsePointFieldData();
-  localStorage->m_Mapper->SetLookupTable(m_lut);  //apply the properties after the slice was set
   localStorage->m_Actor->GetProperty()->SetOpacity(0.999);
-  localStorage->m_Mapper->SelectColorArray("FIBER_COLORS");
-  localStorage->m_Mapper->SetInputData(fiberPolyData);
-
-  localStorage->m_Mapper->SetVertexShaderCode(
-        "//VTK::System::Dec\n"
-        "attribute vec4 vertexMC;\n"
-
-        "//VTK::Normal::Dec\n"
-        "uniform mat4 MCDCMatrix;\n"
-
-        "//VTK::Color::Dec\n"
-
-        "varying vec4 positionWorld;\n"
-        "varying vec4 colorVertex;\n"
-
-        "void main(void)\n"
-        "{\n"
-        "  colorVertex = scalarColor;\n"
-        "  positionWorld = vertexMC;\n"
-        "  gl_Position = MCDCMatrix * vertexMC;\n"
-        "}\n"
-        );
-
-  localStorage->m_Mapper->SetFragmentShaderCode(
-        "//VTK::System::Dec\n"  // always start with this line
-        "//VTK::Output::Dec\n"  // always have this line in your FS
-        "uniform vec4 slicingPlane;\n"
-        "uniform float fiberThickness;\n"
-        "uniform int fiberFadingON;\n"
-        "uniform float fiberOpacity;\n"
-
-        "varying vec4 positionWorld;\n"
-        "varying vec4 colorVertex;\n"
-        "out vec4 out_Color;\n"
-
-        "void main(void)\n"
-        "{\n"
-        "  float r1 = dot(positionWorld.xyz, slicingPlane.xyz) - slicingPlane.w;\n"
-
-        "  if (abs(r1) >= fiberThickness)\n"
-        "    discard;\n"
-
-        "  if (fiberFadingON != 0)\n"
-        "  {\n"
-        "    float x = (r1 + fiberThickness) / (fiberThickness*2.0);\n"
-        "    x = 1.0 - x;\n"
-        "    out_Color = vec4(colorVertex.xyz*x, fiberOpacity);\n"
-        "  }\n"
-        "  else{\n"
-        "    out_Color = vec4(colorVertex.xyz, fiberOpacity);\n"
-        "  }\n"
-        "}\n"
-        );
-
-  vtkSmartPointer<vtkShaderCallback> myCallback = vtkSmartPointer<vtkShaderCallback>::New();
-  myCallback->renderer = renderer;
-  myCallback->node = this->GetDataNode();
-  localStorage->m_Mapper->AddObserver(vtkCommand::UpdateShaderEvent,myCallback);
-
-  localStorage->m_Actor->SetMapper(localStorage->m_Mapper);
-  localStorage->m_Actor->GetProperty()->SetLineWidth(m_LineWidth);
+
+  // drops the coarser levels if the fibers or their colors changed, they are regenerated on first use
+  m_LevelOfDetail.SetInput(fiberBundle);
+  for (auto mapper : localStorage->m_Mappers)
+    if (mapper!=nullptr && mapper!=localStorage->m_Actor->GetMapper())
+      mapper->RemoveAllInputs();
 
   // We have been modified => save this for next Update()
   localStorage->m_LastUpdateTime.Modified();
@@ -269,6 +318,8 @@ void mitk::FiberBundleMapper2D::SetDefaultProperties(mitk::DataNode* node, mitk:
   //add other parameters to propertylist
   node->AddProperty( "Fiber2DSliceThickness", mitk::FloatProperty::New(1.0f), renderer, overwrite );
   node->AddProperty( "Fiber2DfadeEFX", mitk::BoolProperty::New(true), renderer, overwrite );
+  node->AddProperty( "Fiber2DLevelOfDetail", mitk::BoolProperty::New(true), renderer, overwrite );
+  node->AddProperty( "Fiber2DLevelOfDetailMaxLevel", mitk::IntProperty::New(3), renderer, overwrite );
   node->AddProperty( "color", mitk::ColorProperty::New(1.0,1.0,1.0), renderer, overwrite);
 }
 
@@ -276,5 +327,4 @@ void mitk::FiberBundleMapper2D::SetDefaultProperties(mitk::DataNode* node, mitk:
 mitk::FiberBundleMapper2D::FBXLocalStorage::FBXLocalStorage()
 {
   m_Actor = vtkSmartPointer<vtkActor>::New();
-  m_Mapper = vtkSmartPointer<MITKFIBERBUNDLEMAPPER2D_POLYDATAMAPPER>::New();
 }
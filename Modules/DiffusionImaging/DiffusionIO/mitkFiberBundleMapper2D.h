@@ -22,6 +22,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkVtkMapper.h>
 #include <mitkFiberBundle.h>
 #include <vtkSmartPointer.h>
+#include "mitkFiberBundleLevelOfDetail.h"
 
 #define MITKFIBERBUNDLEMAPPER2D_POLYDATAMAPPER vtkOpenGLPolyDataMapper
 
@@ -53,7 +54,8 @@ public:
   {
   public:
     vtkSmartPointer<vtkActor> m_Actor;
-    vtkSmartPointer<MITKFIBERBUNDLEMAPPER2D_POLYDATAMAPPER> m_Mapper;
+    /** One mapper per level of detail, so that switching the level does not re-upload the fibers */
+    std::vector< vtkSmartPointer<MITKFIBERBUNDLEMAPPER2D_POLYDATAMAPPER> > m_Mappers;
     itk::TimeStamp m_LastUpdateTime;
     FBXLocalStorage();
 
@@ -74,8 +76,15 @@ protected:
 
   void UpdateShaderParameter(mitk::BaseRenderer*);
 
+  /** Level of detail that fits the current zoom of the renderer */
+  unsigned int GetLevelOfDetail(mitk::BaseRenderer*);
+
+  /** Returns the mapper of the given level and creates it (including the slab clipping shaders) on first use */
+  MITKFIBERBUNDLEMAPPER2D_POLYDATAMAPPER* GetLevelMapper(mitk::BaseRenderer*, unsigned int level);
+
 private:
   vtkSmartPointer<vtkLookupTable> m_lut;
+  FiberBundleLevelOfDetail m_LevelOfDetail;
 
   int     m_LineWidth;
 };
@@ -31,11 +31,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkVectorProperty.h>
 #include <vtkPlane.h>
 #include <mitkClippingProperty.h>
+#include <mitkRenderingManager.h>
 
 mitk::FiberBundleMapper3D::FiberBundleMapper3D()
   : m_TubeRadius(0.0)
   , m_TubeSides(15)
   , m_LineWidth(1)
+  , m_RibbonWidth(0.0)
+  , m_InteractiveLevel(2)
 {
   m_lut = vtkSmartPointer<vtkLookupTable>::New();
   m_lut->Build();
@@ -63,23 +66,7 @@ void mitk::FiberBundleMapper3D::InternalGenerateData(mitk::BaseRenderer *rendere
   m_FiberPolyData->GetPointData()->AddArray(m_FiberBundle->GetFiberColors());
   LocalStorage3D *localStorage = m_LocalStorageHandler.GetLocalStorage(renderer);
 
-  if (m_TubeRadius>0.0)
-  {
-    vtkSmartPointer<vtkTubeFilter> tubeFilter = vtkSmartPointer<vtkTubeFilter>::New();
-    tubeFilter->SetInputData(m_FiberPolyData);
-    tubeFilter->SetNumberOfSides(m_TubeSides);
-    tubeFilter->SetRadius(m_TubeRadius);
-    tubeFilter->Update();
-    m_FiberPolyData = tubeFilter->GetOutput();
-  }
-  else if (m_RibbonWidth>0.0)
-  {
-    vtkSmartPointer<vtkRibbonFilter> tubeFilter = vtkSmartPointer<vtkRibbonFilter>::New();
-    tubeFilter->SetInputData(m_FiberPolyData);
-    tubeFilter->SetWidth(m_RibbonWidth);
-    tubeFilter->Update();
-    m_FiberPolyData = tubeFilter->GetOutput();
-  }
+  m_FiberPolyData = this->GenerateShape(m_FiberPolyData);
 
 //  if (tmpopa<1)
 //  {
@@ -93,14 +80,21 @@ void mitk::FiberBundleMapper3D::InternalGenerateData(mitk::BaseRenderer *rendere
 //  }
 //  else
 //  {
-    localStorage->m_FiberMapper->SetInputData(m_FiberPolyData);
+    this->SetupMapper(localStorage->m_FiberMapper, m_FiberPolyData);
 //  }
 
-  localStorage->m_FiberMapper->SelectColorArray("FIBER_COLORS");
-  localStorage->m_FiberMapper->ScalarVisibilityOn();
-  localStorage->m_FiberMapper->SetScalarModeToUsePointFieldData();
-  localStorage->m_FiberActor->SetMapper(localStorage->m_FiberMapper);
-  localStorage->m_FiberMapper->SetLookupTable(m_lut);
+  // the subsampled fibers get their own mapper so that switching between both does not re-upload them
+  if (m_InteractiveLevel>0)
+  {
+    m_LevelOfDetail.SetMaxLevel(m_InteractiveLevel);
+    m_LevelOfDetail.SetInput(m_FiberBundle);
+    vtkPolyData* interactivePolyData = m_LevelOfDetail.GetLevel(m_InteractiveLevel);
+    if (interactivePolyData!=nullptr)
+      this->SetupMapper(localStorage->m_InteractiveFiberMapper, this->GenerateShape(interactivePolyData));
+  }
+  else
+    localStorage->m_InteractiveFiberMapper->RemoveAllInputs();
+
   localStorage->m_FiberActor->GetProperty()->SetLineWidth(m_LineWidth);
   localStorage->m_FiberAssembly->AddPart(localStorage->m_FiberActor);
 
@@ -128,12 +122,53 @@ void mitk::FiberBundleMapper3D::InternalGenerateData(mitk::BaseRenderer *rendere
   plane->SetNormal(vnormal);
 
   localStorage->m_FiberMapper->RemoveAllClippingPlanes();
+  localStorage->m_InteractiveFiberMapper->RemoveAllClippingPlanes();
   if (plane_normal.GetNorm() > 0.0)
+  {
     localStorage->m_FiberMapper->AddClippingPlane(plane);
+    localStorage->m_InteractiveFiberMapper->AddClippingPlane(plane);
+  }
 
   localStorage->m_LastUpdateTime.Modified();
 }
 
+vtkSmartPointer<vtkPolyData> mitk::FiberBundleMapper3D::GenerateShape(vtkPolyData* fiberPolyData)
+{
+  if (m_TubeRadius>0.0)
+  {
+    vtkSmartPointer<vtkTubeFilter> tubeFilter = vtkSmartPointer<vtkTubeFilter>::New();
+    tubeFilter->SetInputData(fiberPolyData);
+    tubeFilter->SetNumberOfSides(m_TubeSides);
+    tubeFilter->SetRadius(m_TubeRadius);
+    tubeFilter->Update();
+    return tubeFilter->GetOutput();
+  }
+  else if (m_RibbonWidth>0.0)
+  {
+    vtkSmartPointer<vtkRibbonFilter> tubeFilter = vtkSmartPointer<vtkRibbonFilter>::New();
+    tubeFilter->SetInputData(fiberPolyData);
+    tubeFilter->SetWidth(m_RibbonWidth);
+    tubeFilter->Update();
+    return tubeFilter->GetOutput();
+  }
+  return fiberPolyData;
+}
+
+void mitk::FiberBundleMapper3D::SetupMapper(vtkOpenGLPolyDataMapper* mapper, vtkPolyData* fiberPolyData)
+{
+  mapper->SetInputData(fiberPolyData);
+  mapper->SelectColorArray("FIBER_COLORS");
+  mapper->ScalarVisibilityOn();
+  mapper->SetScalarModeToUsePointFieldData();
+  mapper->SetLookupTable(m_lut);
+}
+
+bool mitk::FiberBundleMapper3D::IsLODEnabled(mitk::BaseRenderer *renderer) const
+{
+  bool value = false;
+  return GetDataNode()->GetBoolProperty("shape.interactivelod", value, renderer) && value;
+}
+
 
 
 void mitk::FiberBundleMapper3D::GenerateDataForRenderer( mitk::BaseRenderer *renderer )
@@ -182,6 +217,26 @@ void mitk::FiberBundleMapper3D::GenerateDataForRenderer( mitk::BaseRenderer *ren
     m_FiberBundle->RequestUpdate3D();
   }
 
+  // level 0 means that no coarse fibers are generated
+  int interactiveLevel = 0;
+  if (this->IsLODEnabled(renderer))
+  {
+    interactiveLevel = 2;
+    node->GetIntProperty("shape.interactivelodlevel", interactiveLevel);
+    interactiveLevel = interactiveLevel>1 ? interactiveLevel : 1;
+  }
+  if (m_InteractiveLevel!=interactiveLevel)
+  {
+    m_InteractiveLevel = interactiveLevel;
+    m_FiberBundle->RequestUpdate3D();
+  }
+
+  // while the user interacts with the scene, the coarse fibers are shown
+  bool interacting = m_InteractiveLevel>0 && mitk::RenderingManager::GetInstance()->GetNextLOD(renderer)==0;
+  vtkOpenGLPolyDataMapper* mapper = interacting && localStorage->m_InteractiveFiberMapper->GetInput()!=nullptr ? localStorage->m_InteractiveFiberMapper : localStorage->m_FiberMapper;
+  if (localStorage->m_FiberActor->GetMapper()!=mapper)
+    localStorage->m_FiberActor->SetMapper(mapper);
+
   float opacity;
   this->GetDataNode()->GetOpacity(opacity, nullptr);
   vtkProperty *property = localStorage->m_FiberActor->GetProperty();
@@ -234,6 +289,8 @@ void mitk::FiberBundleMapper3D::SetDefaultProperties(mitk::DataNode* node, mitk:
   node->AddProperty( "shape.tuberadius",mitk::FloatProperty::New( 0.0 ), renderer, overwrite);
   node->AddProperty( "shape.tubesides",mitk::IntProperty::New( 15 ), renderer, overwrite);
   node->AddProperty( "shape.ribbonwidth", mitk::FloatProperty::New( 0.0 ), renderer, overwrite);
+  node->AddProperty( "shape.interactivelod", mitk::BoolProperty::New( true ), renderer, overwrite);
+  node->AddProperty( "shape.interactivelodlevel", mitk::IntProperty::New( 2 ), renderer, overwrite);
 
   node->AddProperty( "light.ambient", mitk::FloatProperty::New( 0.05 ), renderer, overwrite);
   node->AddProperty( "light.diffuse", mitk::FloatProperty::New( 0.9 ), renderer, overwrite);
@@ -254,6 +311,7 @@ mitk::FiberBundleMapper3D::LocalStorage3D::LocalStorage3D()
 {
   m_FiberActor = vtkSmartPointer<vtkActor>::New();
   m_FiberMapper = vtkSmartPointer<vtkOpenGLPolyDataMapper>::New();
+  m_InteractiveFiberMapper = vtkSmartPointer<vtkOpenGLPolyDataMapper>::New();
   m_FiberAssembly = vtkSmartPointer<vtkPropAssembly>::New();
 }
 
@@ -22,6 +22,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkFiberBundle.h>
 #include <vtkOpenGLPolyDataMapper.h>
 #include <vtkSmartPointer.h>
+#include "mitkFiberBundleLevelOfDetail.h"
 class vtkPropAssembly;
 class vtkPolyDataMapper;
 class vtkLookupTable;
@@ -46,11 +47,16 @@ public:
   static void SetDefaultProperties(DataNode* node, BaseRenderer* renderer = nullptr, bool overwrite = false );
   void GenerateDataForRenderer(mitk::BaseRenderer* renderer) override;
 
+  /** The coarse fibers are shown while interacting if "shape.interactivelod" is enabled */
+  bool IsLODEnabled(mitk::BaseRenderer* renderer) const override;
+
   class  LocalStorage3D : public mitk::Mapper::BaseLocalStorage
   {
   public:
     vtkSmartPointer<vtkActor> m_FiberActor;
     vtkSmartPointer<vtkOpenGLPolyDataMapper> m_FiberMapper;
+    /** Shows the subsampled fibers during interaction */
+    vtkSmartPointer<vtkOpenGLPolyDataMapper> m_InteractiveFiberMapper;
     vtkSmartPointer<vtkPropAssembly> m_FiberAssembly;
 
     itk::TimeStamp m_LastUpdateTime;
@@ -73,15 +79,22 @@ protected:
 
   void UpdateShaderParameter(mitk::BaseRenderer*);
 
+  /** Applies the tube or ribbon filter if requested */
+  vtkSmartPointer<vtkPolyData> GenerateShape(vtkPolyData* fiberPolyData);
+
+  void SetupMapper(vtkOpenGLPolyDataMapper* mapper, vtkPolyData* fiberPolyData);
+
 private:
   vtkSmartPointer<vtkLookupTable> m_lut;
   float   m_TubeRadius;
   int     m_TubeSides;
   int     m_LineWidth;
   float   m_RibbonWidth;
+  int     m_InteractiveLevel;
   bool    m_Lighting;
   vtkSmartPointer<vtkPolyData> m_FiberPolyData;
   mitk::FiberBundle* m_FiberBundle;
+  FiberBundleLevelOfDetail m_LevelOfDetail;
 };
 
 } // end namespace mitk
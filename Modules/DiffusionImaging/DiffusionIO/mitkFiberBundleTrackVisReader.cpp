@@ -30,6 +30,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <tinyxml.h>
 #include <vtkCleanPolyData.h>
 #include <mitkTrackvis.h>
+#include <mitkFiberBundleStreamReader.h>
 #include <mitkCustomMimeType.h>
 #include "mitkDiffusionIOMimeTypes.h"
 
@@ -68,10 +69,14 @@ std::vector<itk::SmartPointer<mitk::BaseData> > mitk::FiberBundleTrackVisReader:
 
     if (ext==".trk")
     {
-      FiberBundle::Pointer mitk_fib = FiberBundle::New();
-      TrackVisFiberReader reader;
-      reader.open(this->GetInputLocation().c_str());
-      reader.read(mitk_fib.GetPointer());
+      TrackVisFiberBundleStreamReader reader;
+      reader.Open(this->GetInputLocation());
+      FiberPointBuffer buffer = reader.ReadAll();
+      reader.Close();
+
+      FiberBundle::Pointer mitk_fib = FiberBundle::New(buffer.ToPolyData());
+      if (reader.GetReferenceGeometry().IsNotNull())
+        mitk_fib->SetReferenceGeometry(reader.GetReferenceGeometry());
       result.push_back(mitk_fib.GetPointer());
       return result;
     }
@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkCleanPolyData.h>
 #include <itksys/SystemTools.hxx>
 #include <mitkTrackvis.h>
+#include <mitkFiberBundleStreamWriter.h>
 #include <itkSize.h>
 #include <vtkFloatArray.h>
 #include <vtkCellData.h>
@@ -93,10 +94,14 @@ void mitk::FiberBundleTrackVisWriter::Write()
         bool lps = us::any_cast<bool>(options["Save in LPS space (if unchecked, use RAS)"]);
 
         MITK_INFO << "Writing fiber bundle as TRK";
-        TrackVisFiberReader trk;
-        trk.create(filename, input.GetPointer(), lps);
-        trk.writeHdr();
-        trk.append(input.GetPointer());
+        TrackVisFiberBundleStreamWriter writer;
+        writer.SetLps(lps);
+        if (input->GetReferenceGeometry().IsNotNull())
+          writer.Open(filename, input->GetReferenceGeometry());
+        else
+          writer.Open(filename, input->GetGeometry());
+        writer.Write(input.GetPointer());
+        writer.Close();
 
         setlocale(LC_ALL, currLocale.c_str());
         MITK_INFO << "TrackVis Fiber bundle written to " << filename;
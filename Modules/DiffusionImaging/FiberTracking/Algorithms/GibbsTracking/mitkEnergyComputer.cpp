@@ -164,6 +164,21 @@ float EnergyComputer::mexp(float x)
     //  return exp(-x);
 }
 
+float EnergyComputer::ComputeTotalInternalEnergy()
+{
+    float energy = 0;
+    for (int i=0; i<m_ParticleGrid->m_NumParticles; i++)
+    {
+        // count every connection only once, from the particle with the smaller ID
+        Particle* p = m_ParticleGrid->GetParticle(i);
+        if (p->pID > i)
+            energy += ComputeInternalEnergyConnection(p,+1);
+        if (p->mID > i)
+            energy += ComputeInternalEnergyConnection(p,-1);
+    }
+    return energy;
+}
+
 int EnergyComputer::GetNumActiveVoxels()
 {
     return m_NumActiveVoxels;
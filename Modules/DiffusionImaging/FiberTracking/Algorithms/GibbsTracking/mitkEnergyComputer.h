@@ -50,6 +50,9 @@ public:
     virtual float ComputeInternalEnergyConnection(Particle *p1,int ep1, Particle *p2, int ep2) = 0;
     virtual float ComputeInternalEnergy(Particle *dp) = 0;
 
+    // sum of the internal energies of all connections in the particle grid
+    float ComputeTotalInternalEnergy();
+
     int GetNumActiveVoxels();
 
 protected:
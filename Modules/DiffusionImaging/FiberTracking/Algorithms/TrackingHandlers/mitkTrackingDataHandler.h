@@ -21,6 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkPoint.h>
 #include <itkImage.h>
 #include <deque>
+#include <vector>
 #include <MitkFiberTrackingExports.h>
 #include <boost/random/discrete_distribution.hpp>
 #include <boost/random/variate_generator.hpp>
@@ -57,6 +58,14 @@ public:
 
   virtual TrackingDirectionType ProposeDirection(const itk::Point<float, 3>& pos, std::deque< TrackingDirectionType >& olddirs, itk::Index<3>& oldIndex) = 0;  ///< predicts next progression direction at the given position
 
+  /** Predicts the progression directions at several positions that share the same streamline history (e.g. the neighborhood samples of one tracking step). Handlers with a per-call overhead, such as the random forest handler, override this to process all positions at once. */
+  virtual void ProposeDirections(const std::vector< itk::Point<float, 3> >& positions, std::deque< TrackingDirectionType >& olddirs, itk::Index<3>& oldIndex, std::vector< TrackingDirectionType >& directions)
+  {
+    directions.resize(positions.size());
+    for (unsigned int i=0; i<positions.size(); i++)
+      directions[i] = ProposeDirection(positions[i], olddirs, oldIndex);
+  }
+
   virtual void InitForTracking() = 0;
   virtual itk::Vector<double, 3> GetSpacing() = 0;
   virtual itk::Point<float,3> GetOrigin() = 0;
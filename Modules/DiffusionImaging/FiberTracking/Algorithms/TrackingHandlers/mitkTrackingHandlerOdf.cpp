@@ -17,6 +17,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkTrackingHandlerOdf.h"
 #include <itkDiffusionOdfGeneralizedFaImageFilter.h>
 #include <itkImageRegionIterator.h>
+#include <itkImageRegionConstIterator.h>
 #include <itkPointShell.h>
 #include <omp.h>
 #include <cmath>
@@ -32,7 +33,6 @@ TrackingHandlerOdf::TrackingHandlerOdf()
   , m_OdfFromTensor(false)
 {
   m_GfaInterpolator = itk::LinearInterpolateImageFunction< itk::Image< float, 3 >, float >::New();
-  m_OdfInterpolator = itk::LinearInterpolateImageFunction< itk::Image< ItkOdfImageType::PixelType, 3 >, float >::New();
 }
 
 TrackingHandlerOdf::~TrackingHandlerOdf()
@@ -78,11 +78,13 @@ void TrackingHandlerOdf::InitForTracking()
       m_GfaImage = gfaFilter->GetOutput();
     }
 
+    InitOdfVolume();
     m_NeedsDataInit = false;
   }
 
   m_GfaInterpolator->SetInputImage(m_GfaImage);
-  m_OdfInterpolator->SetInputImage(m_OdfImage);
+  m_CellCache.clear();
+  m_CellCache.resize(omp_get_max_threads());
 
   std::cout << "TrackingHandlerOdf - GFA threshold: " << m_GfaThreshold << std::endl;
   std::cout << "TrackingHandlerOdf - ODF threshold: " << m_OdfThreshold << std::endl;
@@ -90,6 +92,52 @@ void TrackingHandlerOdf::InitForTracking()
     std::cout << "TrackingHandlerOdf - Sharpening ODfs" << std::endl;
 }
 
+void TrackingHandlerOdf::InitOdfVolume()
+{
+  itk::ImageRegion<3> region;
+  region.SetSize(m_OdfImage->GetLargestPossibleRegion().GetSize());
+  itk::Index<3> start = m_OdfImage->GetLargestPossibleRegion().GetIndex();
+  m_OdfVolume.Allocate(region, static_cast<int>(m_OdfHemisphereIndices.size()));
+
+  itk::ImageRegionConstIterator< ItkOdfImageType > it(m_OdfImage, m_OdfImage->GetLargestPossibleRegion());
+  while (!it.IsAtEnd())
+  {
+    itk::Index<3> idx = it.GetIndex();
+    idx[0] -= start[0]; idx[1] -= start[1]; idx[2] -= start[2];
+    float* values = m_OdfVolume.GetVoxel(idx);
+    const ItkOdfImageType::PixelType& odf = it.Get();
+    for (unsigned int c=0; c<m_OdfHemisphereIndices.size(); c++)
+      values[c] = odf[m_OdfHemisphereIndices[c]];
+    ++it;
+  }
+}
+
+bool TrackingHandlerOdf::GetOdfValues(const itk::Point<float, 3>& pos, const itk::Index<3>& idx, float* values)
+{
+  itk::Index<3> start = m_OdfImage->GetLargestPossibleRegion().GetIndex();
+  if (!m_Interpolate)
+  {
+    itk::Index<3> vIdx;
+    vIdx[0] = idx[0]-start[0]; vIdx[1] = idx[1]-start[1]; vIdx[2] = idx[2]-start[2];
+    const float* voxel = m_OdfVolume.GetVoxel(vIdx);
+    for (int c=0; c<m_OdfVolume.GetNumberOfChannels(); c++)
+      values[c] = voxel[c];
+    return true;
+  }
+
+  itk::ContinuousIndex< float, 3> cIdx;
+  m_OdfImage->TransformPhysicalPointToContinuousIndex(pos, cIdx);
+  cIdx[0] -= start[0]; cIdx[1] -= start[1]; cIdx[2] -= start[2];
+
+  TrackingVolume::Cell local_cell;
+  unsigned int thread_id = omp_get_thread_num();
+  TrackingVolume::Cell& cell = thread_id<m_CellCache.size() ? m_CellCache[thread_id] : local_cell;
+  if (!m_OdfVolume.UpdateCell(cIdx, cell))
+    return false;
+  m_OdfVolume.Interpolate(cell, values);
+  return true;
+}
+
 int TrackingHandlerOdf::SampleOdf(vnl_vector< float >& probs, vnl_vector< float >& angles)
 {
   boost::random::discrete_distribution<int, float> dist(probs.begin(), probs.end());
@@ -151,30 +199,27 @@ vnl_vector_fixed<float,3> TrackingHandlerOdf::ProposeDirection(const itk::Point<
   if (!m_Interpolate && oldIndex==idx)
     return last_dir;
 
-  ItkOdfImageType::PixelType odf_values = mitk::imv::GetImageValue<ItkOdfImageType::PixelType>(pos, m_Interpolate, m_OdfInterpolator);
   vnl_vector< float > probs; probs.set_size(m_OdfHemisphereIndices.size());
+  if (!GetOdfValues(pos, idx, probs.data_block()))
+    return output_direction;
   vnl_vector< float > angles; angles.set_size(m_OdfHemisphereIndices.size()); angles.fill(1.0);
 
   // Find ODF maximum and remove <0 values
   float max_odf_val = 0;
   float min_odf_val = 999;
   int max_idx_d = -1;
-  int c = 0;
-  for (int i : m_OdfHemisphereIndices)
+  for (unsigned int c=0; c<probs.size(); c++)
   {
-    if (odf_values[i]<0)
-      odf_values[i] = 0;
+    if (probs[c]<0)
+      probs[c] = 0;
 
-    if (odf_values[i]>max_odf_val)
+    if (probs[c]>max_odf_val)
     {
-      max_odf_val = odf_values[i];
+      max_odf_val = probs[c];
       max_idx_d = c;
     }
-    if (odf_values[i]<min_odf_val)
-      min_odf_val = odf_values[i];
-
-    probs[c] = odf_values[i];
-    c++;
+    if (probs[c]<min_odf_val)
+      min_odf_val = probs[c];
   }
 
   if (m_SharpenOdfs)
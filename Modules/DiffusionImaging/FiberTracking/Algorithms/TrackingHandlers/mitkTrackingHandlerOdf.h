@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define _TrackingHandlerOdf
 
 #include "mitkTrackingDataHandler.h"
+#include "mitkTrackingVolume.h"
 #include <mitkOdfImage.h>
 #include <mitkTensorImage.h>
 #include <itkOrientationDistributionFunction.h>
@@ -67,6 +68,8 @@ public:
 protected:
 
   int SampleOdf(vnl_vector< float >& probs, vnl_vector< float >& angles);
+  void InitOdfVolume();   ///< copies the ODF values of the hemisphere directions into m_OdfVolume
+  bool GetOdfValues(const itk::Point<float, 3>& pos, const itk::Index<3>& idx, float* values);   ///< writes the (interpolated) hemisphere ODF values at pos. idx is the nearest voxel.
 
   float                           m_GfaThreshold;
   float                           m_OdfThreshold;
@@ -80,7 +83,8 @@ protected:
   bool                            m_OdfFromTensor;
 
   itk::LinearInterpolateImageFunction< itk::Image< float, 3 >, float >::Pointer   m_GfaInterpolator;
-  itk::LinearInterpolateImageFunction< itk::Image< ItkOdfImageType::PixelType, 3 >, float >::Pointer   m_OdfInterpolator;
+  TrackingVolume                                                                  m_OdfVolume;    ///< ODF values of the hemisphere directions in tracking layout
+  std::vector< TrackingVolume::Cell >                                             m_CellCache;    ///< last interpolation cell of each thread
 };
 
 }
@@ -15,6 +15,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "mitkTrackingHandlerPeaks.h"
+#include <itkImageRegionConstIterator.h>
+#include <omp.h>
 
 namespace mitk
 {
@@ -71,10 +73,13 @@ void TrackingHandlerPeaks::InitForTracking()
     m_NeedsDataInit = false;
   }
 
+  // rebuilt for every run since the flip and direction matrix settings may have changed
+  InitPeakVolume();
+
   std::cout << "TrackingHandlerPeaks - Peak threshold: " << m_PeakThreshold << std::endl;
 }
 
-vnl_vector_fixed<float,3> TrackingHandlerPeaks::GetMatchingDirection(itk::Index<3> idx3, vnl_vector_fixed<float,3>& oldDir)
+vnl_vector_fixed<float,3> TrackingHandlerPeaks::GetMatchingDirection(const float* peaks, vnl_vector_fixed<float,3>& oldDir)
 {
   vnl_vector_fixed<float,3> out_dir; out_dir.fill(0);
   float angle = 0;
@@ -91,7 +96,7 @@ vnl_vector_fixed<float,3> TrackingHandlerPeaks::GetMatchingDirection(itk::Index<
         int i = 0;
 #pragma omp critical
         i = m_RngItk->GetIntegerVariate(m_NumDirs-1);
-        out_dir = GetDirection(idx3, i);
+        out_dir = GetDirection(peaks, i);
 
         if (out_dir.magnitude()>mitk::eps)
         {
@@ -109,7 +114,7 @@ vnl_vector_fixed<float,3> TrackingHandlerPeaks::GetMatchingDirection(itk::Index<
       // if you didn't find a non-zero random direction, take first non-zero direction you find
       for (int i=0; i<m_NumDirs; i++)
       {
-        out_dir = GetDirection(idx3, i);
+        out_dir = GetDirection(peaks, i);
         if (out_dir.magnitude()>mitk::eps)
         {
           oldDir[0] = out_dir[0];
@@ -124,7 +129,7 @@ vnl_vector_fixed<float,3> TrackingHandlerPeaks::GetMatchingDirection(itk::Index<
   {
     for (int i=0; i<m_NumDirs; i++)
     {
-      vnl_vector_fixed<float,3> dir = GetDirection(idx3, i);
+      vnl_vector_fixed<float,3> dir = GetDirection(peaks, i);
       mag = dir.magnitude();
       if (mag>mitk::eps)
         dir.normalize();
@@ -145,32 +150,58 @@ vnl_vector_fixed<float,3> TrackingHandlerPeaks::GetMatchingDirection(itk::Index<
   return out_dir;
 }
 
-vnl_vector_fixed<float,3> TrackingHandlerPeaks::GetDirection(itk::Index<3> idx3, int dirIdx)
+void TrackingHandlerPeaks::InitPeakVolume()
 {
-  vnl_vector_fixed<float,3> dir; dir.fill(0.0);
-  if ( !m_DummyImage->GetLargestPossibleRegion().IsInside(idx3) )
-    return dir;
-
-  PeakImgType::IndexType idx4;
-  idx4.SetElement(0,idx3[0]);
-  idx4.SetElement(1,idx3[1]);
-  idx4.SetElement(2,idx3[2]);
+  m_PeakVolume.Allocate(imageRegion3, 3*m_NumDirs);
 
-  for (int k=0; k<3; k++)
+  PeakImgType::IndexType start4 = m_PeakImage->GetLargestPossibleRegion().GetIndex();
+  itk::ImageRegionConstIterator< PeakImgType > it(m_PeakImage, m_PeakImage->GetLargestPossibleRegion());
+  while (!it.IsAtEnd())
   {
-    idx4.SetElement(3, dirIdx*3 + k);
-    dir[k] = m_PeakImage->GetPixel(idx4);
+    PeakImgType::IndexType idx4 = it.GetIndex();
+    itk::Index<3> idx3;
+    idx3[0] = idx4[0]-start4[0]; idx3[1] = idx4[1]-start4[1]; idx3[2] = idx4[2]-start4[2];
+    int channel = idx4[3]-start4[3];
+    if (channel < 3*m_NumDirs)
+      m_PeakVolume.GetVoxel(idx3)[channel] = it.Get();
+    ++it;
   }
 
-  if (m_FlipX)
-    dir[0] *= -1;
-  if (m_FlipY)
-    dir[1] *= -1;
-  if (m_FlipZ)
-    dir[2] *= -1;
-  if (m_ApplyDirectionMatrix)
-    dir = m_FloatImageRotation*dir;
+  for (unsigned int z=0; z<imageRegion3.GetSize(2); z++)
+    for (unsigned int y=0; y<imageRegion3.GetSize(1); y++)
+      for (unsigned int x=0; x<imageRegion3.GetSize(0); x++)
+      {
+        itk::Index<3> idx3;
+        idx3[0] = x; idx3[1] = y; idx3[2] = z;
+        float* peaks = m_PeakVolume.GetVoxel(idx3);
+        for (int i=0; i<m_NumDirs; i++)
+        {
+          vnl_vector_fixed<float,3> dir;
+          dir[0] = peaks[3*i]; dir[1] = peaks[3*i+1]; dir[2] = peaks[3*i+2];
+
+          if (m_FlipX)
+            dir[0] *= -1;
+          if (m_FlipY)
+            dir[1] *= -1;
+          if (m_FlipZ)
+            dir[2] *= -1;
+          if (m_ApplyDirectionMatrix)
+            dir = m_FloatImageRotation*dir;
+
+          peaks[3*i] = dir[0]; peaks[3*i+1] = dir[1]; peaks[3*i+2] = dir[2];
+        }
+      }
+
+  m_CellCache.clear();
+  m_CellCache.resize(omp_get_max_threads());
+}
 
+vnl_vector_fixed<float,3> TrackingHandlerPeaks::GetDirection(const float* peaks, int dirIdx)
+{
+  vnl_vector_fixed<float,3> dir;
+  dir[0] = peaks[3*dirIdx];
+  dir[1] = peaks[3*dirIdx+1];
+  dir[2] = peaks[3*dirIdx+2];
   return dir;
 }
 
@@ -182,75 +213,26 @@ vnl_vector_fixed<float,3> TrackingHandlerPeaks::GetDirection(itk::Point<float, 3
   m_DummyImage->TransformPhysicalPointToContinuousIndex(itkP, cIdx);
 
   vnl_vector_fixed<float,3> dir; dir.fill(0.0);
-  if ( !m_DummyImage->GetLargestPossibleRegion().IsInside(idx3) )
+  if ( !m_PeakVolume.IsInside(idx3) )
     return dir;
 
   if (interpolate)
   {
-    float frac_x = cIdx[0] - idx3[0];
-    float frac_y = cIdx[1] - idx3[1];
-    float frac_z = cIdx[2] - idx3[2];
-    if (frac_x<0)
-    {
-      idx3[0] -= 1;
-      frac_x += 1;
-    }
-    if (frac_y<0)
-    {
-      idx3[1] -= 1;
-      frac_y += 1;
-    }
-    if (frac_z<0)
-    {
-      idx3[2] -= 1;
-      frac_z += 1;
-    }
-    frac_x = 1-frac_x;
-    frac_y = 1-frac_y;
-    frac_z = 1-frac_z;
-
-    // int coordinates inside image?
-    if (idx3[0] >= 0 && idx3[0] < static_cast<itk::IndexValueType>(m_DummyImage->GetLargestPossibleRegion().GetSize(0) - 1) &&
-        idx3[1] >= 0 && idx3[1] < static_cast<itk::IndexValueType>(m_DummyImage->GetLargestPossibleRegion().GetSize(1) - 1) &&
-        idx3[2] >= 0 && idx3[2] < static_cast<itk::IndexValueType>(m_DummyImage->GetLargestPossibleRegion().GetSize(2) - 1))
-    {
-      // trilinear interpolation
-      vnl_vector_fixed<float, 8> interpWeights;
-      interpWeights[0] = (  frac_x)*(  frac_y)*(  frac_z);
-      interpWeights[1] = (1-frac_x)*(  frac_y)*(  frac_z);
-      interpWeights[2] = (  frac_x)*(1-frac_y)*(  frac_z);
-      interpWeights[3] = (  frac_x)*(  frac_y)*(1-frac_z);
-      interpWeights[4] = (1-frac_x)*(1-frac_y)*(  frac_z);
-      interpWeights[5] = (  frac_x)*(1-frac_y)*(1-frac_z);
-      interpWeights[6] = (1-frac_x)*(  frac_y)*(1-frac_z);
-      interpWeights[7] = (1-frac_x)*(1-frac_y)*(1-frac_z);
-
-      dir = GetMatchingDirection(idx3, oldDir) * interpWeights[0];
-
-      itk::Index<3> tmpIdx = idx3; tmpIdx[0]++;
-      dir +=  GetMatchingDirection(tmpIdx, oldDir) * interpWeights[1];
+    TrackingVolume::Cell local_cell;
+    unsigned int thread_id = omp_get_thread_num();
+    TrackingVolume::Cell& cell = thread_id<m_CellCache.size() ? m_CellCache[thread_id] : local_cell;
 
-      tmpIdx = idx3; tmpIdx[1]++;
-      dir +=  GetMatchingDirection(tmpIdx, oldDir) * interpWeights[2];
-
-      tmpIdx = idx3; tmpIdx[2]++;
-      dir +=  GetMatchingDirection(tmpIdx, oldDir) * interpWeights[3];
-
-      tmpIdx = idx3; tmpIdx[0]++; tmpIdx[1]++;
-      dir +=  GetMatchingDirection(tmpIdx, oldDir) * interpWeights[4];
-
-      tmpIdx = idx3; tmpIdx[1]++; tmpIdx[2]++;
-      dir +=  GetMatchingDirection(tmpIdx, oldDir) * interpWeights[5];
-
-      tmpIdx = idx3; tmpIdx[2]++; tmpIdx[0]++;
-      dir +=  GetMatchingDirection(tmpIdx, oldDir) * interpWeights[6];
-
-      tmpIdx = idx3; tmpIdx[0]++; tmpIdx[1]++; tmpIdx[2]++;
-      dir +=  GetMatchingDirection(tmpIdx, oldDir) * interpWeights[7];
+    // trilinear interpolation if all eight cell corners are inside the image
+    if (m_PeakVolume.UpdateInnerCell(cIdx, cell))
+    {
+      // corner order of the original implementation since GetMatchingDirection may initialize oldDir
+      const int corners[8] = {0, 1, 2, 4, 3, 6, 5, 7};
+      for (int c : corners)
+        dir += GetMatchingDirection(cell.voxels[c], oldDir) * cell.weights[c];
     }
   }
   else
-    dir = GetMatchingDirection(idx3, oldDir);
+    dir = GetMatchingDirection(m_PeakVolume.GetVoxel(idx3), oldDir);
 
   return dir;
 }
@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define _TrackingHandlerPeaks
 
 #include "mitkTrackingDataHandler.h"
+#include "mitkTrackingVolume.h"
 #include <itkDiffusionTensor3D.h>
 #include <MitkFiberTrackingExports.h>
 
@@ -61,8 +62,9 @@ public:
 protected:
 
   vnl_vector_fixed<float,3> GetDirection(itk::Point<float, 3> itkP, bool interpolate, vnl_vector_fixed<float,3> oldDir);
-  vnl_vector_fixed<float,3> GetMatchingDirection(itk::Index<3> idx3, vnl_vector_fixed<float,3>& oldDir);
-  vnl_vector_fixed<float,3> GetDirection(itk::Index<3> idx3, int dirIdx);
+  vnl_vector_fixed<float,3> GetMatchingDirection(const float* peaks, vnl_vector_fixed<float,3>& oldDir);
+  vnl_vector_fixed<float,3> GetDirection(const float* peaks, int dirIdx);
+  void InitPeakVolume();   ///< copies the peaks into m_PeakVolume with flips and direction matrix already applied
 
   PeakImgType::ConstPointer m_PeakImage;
   float m_PeakThreshold;
@@ -75,6 +77,8 @@ protected:
   vnl_matrix_fixed<float,3,3> m_FloatImageRotation;
 
   ItkUcharImgType::Pointer m_DummyImage;
+  TrackingVolume m_PeakVolume;
+  std::vector< TrackingVolume::Cell > m_CellCache;   ///< last interpolation cell of each thread
 
   bool    m_ApplyDirectionMatrix;
 };
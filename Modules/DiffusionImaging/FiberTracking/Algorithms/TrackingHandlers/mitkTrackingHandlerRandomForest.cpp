@@ -180,11 +180,16 @@ void TrackingHandlerRandomForest< ShOrder, NumberOfSignalFeatures >::InitForTrac
 template< int ShOrder, int NumberOfSignalFeatures >
 vnl_vector_fixed<float,3> TrackingHandlerRandomForest< ShOrder, NumberOfSignalFeatures >::ProposeDirection(const itk::Point<float, 3>& pos, std::deque<vnl_vector_fixed<float, 3> >& olddirs, itk::Index<3>& oldIndex)
 {
+  std::vector< itk::Point<float, 3> > positions(1, pos);
+  std::vector< vnl_vector_fixed<float,3> > directions;
+  ProposeDirections(positions, olddirs, oldIndex, directions);
+  return directions.at(0);
+}
 
-  vnl_vector_fixed<float,3> output_direction; output_direction.fill(0);
-
-  itk::Index<3> idx;
-  m_DwiFeatureImages.at(0)->TransformPhysicalPointToIndex(pos, idx);
+template< int ShOrder, int NumberOfSignalFeatures >
+void TrackingHandlerRandomForest< ShOrder, NumberOfSignalFeatures >::ProposeDirections(const std::vector< itk::Point<float, 3> >& positions, std::deque<vnl_vector_fixed<float, 3> >& olddirs, itk::Index<3>& oldIndex, std::vector< vnl_vector_fixed<float,3> >& directions)
+{
+  directions.resize(positions.size());
 
   bool check_last_dir = false;
   vnl_vector_fixed<float,3> last_dir;
@@ -195,23 +200,25 @@ vnl_vector_fixed<float,3> TrackingHandlerRandomForest< ShOrder, NumberOfSignalFe
       check_last_dir = true;
   }
 
-  if (!m_Interpolate && oldIndex==idx)
-    return last_dir;
-
-  // store feature pixel values in a vigra data type
-  vigra::MultiArray<2, float> featureData = vigra::MultiArray<2, float>( vigra::Shape2(1,m_Forest->GetNumFeatures()) );
-  featureData.init(0.0);
-  typename DwiFeatureImageType::PixelType dwiFeaturePixel = mitk::imv::GetImageValue< typename DwiFeatureImageType::PixelType >(pos, m_Interpolate, m_DwiFeatureImageInterpolator);
-  for (unsigned int f=0; f<NumberOfSignalFeatures; f++)
-    featureData(0,f) = dwiFeaturePixel[f];
+  // only positions that left the voxel of the previous step need to be classified
+  std::vector< unsigned int > samples;
+  for (unsigned int p=0; p<positions.size(); p++)
+  {
+    itk::Index<3> idx;
+    m_DwiFeatureImages.at(0)->TransformPhysicalPointToIndex(positions[p], idx);
+    if (!m_Interpolate && oldIndex==idx)
+      directions[p] = last_dir;
+    else
+      samples.push_back(p);
+  }
+  if (samples.empty())
+    return;
 
-  vnl_matrix_fixed<double,3,3> direction_matrix = m_DwiFeatureImages.at(0)->GetDirection().GetVnlMatrix();
   vnl_matrix_fixed<double,3,3> inverse_direction_matrix = m_DwiFeatureImages.at(0)->GetInverseDirection().GetVnlMatrix();
 
-  // append normalized previous direction(s) to feature vector
-  int i = 0;
+  // normalized previous direction(s) in image space. these features are the same for all positions.
+  std::vector< float > dir_features;
   vnl_vector_fixed<double,3> ref; ref.fill(0); ref[0]=1;
-
   for (auto d : olddirs)
   {
     vnl_vector_fixed<double,3> tempD;
@@ -229,34 +236,56 @@ vnl_vector_fixed<float,3> TrackingHandlerRandomForest< ShOrder, NumberOfSignalFe
     last_dir[1] = tempD[1];
     last_dir[2] = tempD[2];
 
-    int c = 0;
-    for (int f=NumberOfSignalFeatures+3*i; f<NumberOfSignalFeatures+3*(i+1); f++)
+    for (int c=0; c<3; c++)
     {
       if (dot_product(ref, tempD)<0)
-        featureData(0,f) = -tempD[c];
+        dir_features.push_back(-tempD[c]);
       else
-        featureData(0,f) = tempD[c];
-      c++;
+        dir_features.push_back(tempD[c]);
     }
-    i++;
   }
 
-  // additional feature images
-  if (m_AdditionalFeatureImages.size()>0)
+  // store feature pixel values in a vigra data type, one row per position
+  vigra::MultiArray<2, float> featureData = vigra::MultiArray<2, float>( vigra::Shape2(samples.size(),m_Forest->GetNumFeatures()) );
+  featureData.init(0.0);
+  for (unsigned int s=0; s<samples.size(); s++)
   {
-    int c = 0;
-    for (auto interpolator : m_AdditionalFeatureImageInterpolators.at(0))
+    const itk::Point<float, 3>& pos = positions[samples[s]];
+    typename DwiFeatureImageType::PixelType dwiFeaturePixel = mitk::imv::GetImageValue< typename DwiFeatureImageType::PixelType >(pos, m_Interpolate, m_DwiFeatureImageInterpolator);
+    for (unsigned int f=0; f<NumberOfSignalFeatures; f++)
+      featureData(s,f) = dwiFeaturePixel[f];
+
+    // append previous direction(s) to feature vector
+    for (unsigned int f=0; f<dir_features.size(); f++)
+      featureData(s,NumberOfSignalFeatures+f) = dir_features[f];
+
+    // additional feature images
+    if (m_AdditionalFeatureImages.size()>0)
     {
-      float v = mitk::imv::GetImageValue<float>(pos, false, interpolator);
-      featureData(0,NumberOfSignalFeatures+m_NumPreviousDirections*3+c) = v;
-      c++;
+      int c = 0;
+      for (auto interpolator : m_AdditionalFeatureImageInterpolators.at(0))
+      {
+        float v = mitk::imv::GetImageValue<float>(pos, false, interpolator);
+        featureData(s,NumberOfSignalFeatures+m_NumPreviousDirections*3+c) = v;
+        c++;
+      }
     }
   }
 
-  // perform classification
-  vigra::MultiArray<2, float> probs(vigra::Shape2(1, m_Forest->GetNumClasses()));
+  // perform classification of all positions at once
+  vigra::MultiArray<2, float> probs(vigra::Shape2(samples.size(), m_Forest->GetNumClasses()));
   m_Forest->PredictProbabilities(featureData, probs);
 
+  for (unsigned int s=0; s<samples.size(); s++)
+    directions[samples[s]] = GetDirectionFromProbabilities(probs, s, check_last_dir, last_dir);
+}
+
+template< int ShOrder, int NumberOfSignalFeatures >
+vnl_vector_fixed<float,3> TrackingHandlerRandomForest< ShOrder, NumberOfSignalFeatures >::GetDirectionFromProbabilities(vigra::MultiArray<2, float>& probs, int row, bool check_last_dir, vnl_vector_fixed<float,3>& last_dir)
+{
+  vnl_vector_fixed<float,3> output_direction; output_direction.fill(0);
+  vnl_matrix_fixed<double,3,3> direction_matrix = m_DwiFeatureImages.at(0)->GetDirection().GetVnlMatrix();
+
   vnl_vector< float > angles = m_OdfFloatDirs*last_dir;
   vnl_vector< float > probs2; probs2.set_size(m_DirectionContainer.size()); probs2.fill(0.0); // used for probabilistic direction sampling
   float probs_sum = 0;
@@ -266,7 +295,7 @@ vnl_vector_fixed<float,3> TrackingHandlerRandomForest< ShOrder, NumberOfSignalFe
 
   for (int i=0; i<m_Forest->GetNumClasses(); i++)   // for each class (number of possible directions + out-of-wm class)
   {
-    if (probs(0,i)>0)   // if probability of respective class is 0, do nothing
+    if (probs(row,i)>0)   // if probability of respective class is 0, do nothing
     {
       // get label of class (does not correspond to the loop variable i)
       unsigned int classLabel = m_Forest->IndexToClassLabel(i);
@@ -278,7 +307,7 @@ vnl_vector_fixed<float,3> TrackingHandlerRandomForest< ShOrder, NumberOfSignalFe
 
         if (m_Mode==MODE::PROBABILISTIC)
         {
-          probs2[classLabel] = probs(0,i);
+          probs2[classLabel] = probs(row,i);
           if (check_last_dir)
             probs2[classLabel] *= abs_angle;
           probs_sum += probs2[classLabel];
@@ -292,20 +321,20 @@ vnl_vector_fixed<float,3> TrackingHandlerRandomForest< ShOrder, NumberOfSignalFe
             {
               if (angle<0)                          // make sure we don't walk backwards
                 d *= -1;
-              float w_i = probs(0,i)*abs_angle;
+              float w_i = probs(row,i)*abs_angle;
               output_direction += w_i*d; // weight contribution to output direction with its probability and the angular deviation from the previous direction
               w += w_i;           // increase output weight of the final direction
             }
           }
           else
           {
-            output_direction += probs(0,i)*d;
-            w += probs(0,i);
+            output_direction += probs(row,i)*d;
+            w += probs(row,i);
           }
         }
       }
       else
-        pNonFib += probs(0,i);  // probability that we are not in the white matter anymore
+        pNonFib += probs(row,i);  // probability that we are not in the white matter anymore
     }
   }
 
@@ -92,6 +92,7 @@ public:
 
   void InitForTracking() override;     ///< calls InputDataValidForTracking() and creates feature images
   vnl_vector_fixed<float,3> ProposeDirection(const itk::Point<float, 3>& pos, std::deque< vnl_vector_fixed<float,3> >& olddirs, itk::Index<3>& oldIndex) override;  ///< predicts next progression direction at the given position
+  void ProposeDirections(const std::vector< itk::Point<float, 3> >& positions, std::deque< vnl_vector_fixed<float,3> >& olddirs, itk::Index<3>& oldIndex, std::vector< vnl_vector_fixed<float,3> >& directions) override;  ///< classifies the feature vectors of all positions with a single forest call
   bool WorldToIndex(itk::Point<float, 3>& pos, itk::Index<3>& index) override;
 
   bool IsForestValid();   ///< true is forest is not null, has more than 0 trees and the correct number of features (NumberOfSignalFeatures + 3)
@@ -106,6 +107,7 @@ public:
 protected:
 
   void InputDataValidForTracking();                                                   ///< check if raw data is set and tracking forest is valid
+  vnl_vector_fixed<float,3> GetDirectionFromProbabilities(vigra::MultiArray<2, float>& probs, int row, bool check_last_dir, vnl_vector_fixed<float,3>& last_dir);   ///< converts the class probabilities of one sample into a weighted progression direction. last_dir is the previous direction in image space.
 
   template<typename T=bool>
   typename std::enable_if<NumberOfSignalFeatures <= 99, T>::type InitDwiImageFeatures(mitk::Image::Pointer mitk_dwi);
@@ -0,0 +1,145 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTrackingVolume.h"
+#include <mitkExceptionMacro.h>
+#include <cmath>
+#include <cstdint>
+
+namespace mitk
+{
+
+TrackingVolume::TrackingVolume()
+  : m_Channels(0)
+  , m_ChannelStride(0)
+  , m_Buffer(nullptr)
+{
+  m_NumBricks[0] = m_NumBricks[1] = m_NumBricks[2] = 0;
+}
+
+void TrackingVolume::Allocate(const itk::ImageRegion<3>& region, int channels)
+{
+  if (channels<=0)
+    mitkThrow() << "Tracking volume needs at least one channel";
+  if (region.GetIndex()[0]!=0 || region.GetIndex()[1]!=0 || region.GetIndex()[2]!=0)
+    mitkThrow() << "Tracking volume region has to start at index 0";
+
+  m_Region = region;
+  m_Channels = channels;
+  m_ChannelStride = (channels+3)/4*4;
+  for (int d=0; d<3; ++d)
+    m_NumBricks[d] = (region.GetSize(d)+3)/4;
+
+  std::size_t num_floats = m_NumBricks[0]*m_NumBricks[1]*m_NumBricks[2]*64*m_ChannelStride;
+  m_Data.clear();
+  m_Data.resize(num_floats + 4, 0.0f);
+
+  // align the first voxel to 16 bytes. every voxel starts at a multiple of four floats.
+  std::uintptr_t address = reinterpret_cast<std::uintptr_t>(m_Data.data());
+  m_Buffer = m_Data.data() + ((16 - address%16)%16)/sizeof(float);
+}
+
+bool TrackingVolume::IsInside(const itk::Index<3>& idx) const
+{
+  return !IsEmpty() && m_Region.IsInside(idx);
+}
+
+void TrackingVolume::SetCellVoxels(const itk::Index<3>& base, const itk::Index<3>& next, Cell& cell) const
+{
+  if (cell.valid && cell.base==base)
+    return;
+
+  for (int c=0; c<8; ++c)
+  {
+    itk::Index<3> idx;
+    idx[0] = (c&1) ? next[0] : base[0];
+    idx[1] = (c&2) ? next[1] : base[1];
+    idx[2] = (c&4) ? next[2] : base[2];
+    cell.voxels[c] = GetVoxel(idx);
+  }
+  cell.base = base;
+  cell.valid = true;
+}
+
+bool TrackingVolume::UpdateCell(const itk::ContinuousIndex<float, 3>& cIdx, Cell& cell) const
+{
+  if (IsEmpty())
+    return false;
+
+  itk::Index<3> base;
+  itk::Index<3> next;
+  float t[3];
+  for (int d=0; d<3; ++d)
+  {
+    itk::IndexValueType end = static_cast<itk::IndexValueType>(m_Region.GetSize(d)) - 1;
+    if ( !(cIdx[d]>=-0.5f && cIdx[d]<end+0.5f) )
+      return false;
+
+    base[d] = static_cast<itk::IndexValueType>(std::floor(cIdx[d]));
+    if (base[d]<0)
+      base[d] = 0;
+    t[d] = cIdx[d] - base[d];
+    if (t[d]<0)
+      t[d] = 0;
+    next[d] = base[d]<end ? base[d]+1 : base[d];
+  }
+
+  SetCellVoxels(base, next, cell);
+  for (int c=0; c<8; ++c)
+    cell.weights[c] = ((c&1) ? t[0] : 1-t[0]) * ((c&2) ? t[1] : 1-t[1]) * ((c&4) ? t[2] : 1-t[2]);
+  return true;
+}
+
+bool TrackingVolume::UpdateInnerCell(const itk::ContinuousIndex<float, 3>& cIdx, Cell& cell) const
+{
+  if (IsEmpty())
+    return false;
+
+  itk::Index<3> base;
+  itk::Index<3> next;
+  float t[3];
+  for (int d=0; d<3; ++d)
+  {
+    base[d] = static_cast<itk::IndexValueType>(std::floor(cIdx[d]));
+    if (base[d]<0 || base[d]>=static_cast<itk::IndexValueType>(m_Region.GetSize(d))-1)
+      return false;
+    t[d] = cIdx[d] - base[d];
+    next[d] = base[d]+1;
+  }
+
+  SetCellVoxels(base, next, cell);
+  for (int c=0; c<8; ++c)
+    cell.weights[c] = ((c&1) ? t[0] : 1-t[0]) * ((c&2) ? t[1] : 1-t[1]) * ((c&4) ? t[2] : 1-t[2]);
+  return true;
+}
+
+void TrackingVolume::Interpolate(const Cell& cell, float* out) const
+{
+  for (int ch=0; ch<m_Channels; ++ch)
+    out[ch] = 0;
+
+  for (int c=0; c<8; ++c)
+  {
+    const float w = cell.weights[c];
+    if (w==0)
+      continue;
+    const float* v = cell.voxels[c];
+    for (int ch=0; ch<m_Channels; ++ch)
+      out[ch] += w*v[ch];
+  }
+}
+
+}
@@ -0,0 +1,94 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef _TrackingVolume
+#define _TrackingVolume
+
+#include <itkImage.h>
+#include <itkContinuousIndex.h>
+#include <MitkFiberTrackingExports.h>
+#include <vector>
+
+namespace mitk
+{
+
+/**
+* \brief Float volume with a fixed number of channels per voxel in a memory layout optimized for tracking.
+*
+* Voxels are stored in bricks of 4x4x4 voxels and all channels of a voxel are contiguous and 16 byte aligned, so the eight voxels of an interpolation cell are close in memory.
+* Trilinear interpolation works on a Cell that caches the voxel pointers of the last cell. Consecutive tracking steps usually stay in the same cell, so the
+* tracking handlers keep one Cell per thread and only the interpolation weights have to be recomputed. No memory is allocated during interpolation. */
+
+class MITKFIBERTRACKING_EXPORT TrackingVolume
+{
+
+public:
+
+  /** The eight voxels around a continuous index. Corner c is the voxel base + ((c&1), (c>>1)&1, (c>>2)&1). */
+  struct Cell
+  {
+    Cell() : valid(false) { base.Fill(0); }
+
+    itk::Index<3>   base;
+    const float*    voxels[8];
+    float           weights[8];
+    bool            valid;        ///< false if the voxel pointers were not set yet
+  };
+
+  TrackingVolume();
+
+  void Allocate(const itk::ImageRegion<3>& region, int channels);   ///< allocates and zero-fills the volume. Region index has to be 0.
+  bool IsEmpty() const { return m_Data.empty(); }
+  int GetNumberOfChannels() const { return m_Channels; }
+  const itk::ImageRegion<3>& GetRegion() const { return m_Region; }
+  bool IsInside(const itk::Index<3>& idx) const;
+
+  float* GetVoxel(const itk::Index<3>& idx) { return m_Buffer + Offset(idx[0], idx[1], idx[2]); }
+  const float* GetVoxel(const itk::Index<3>& idx) const { return m_Buffer + Offset(idx[0], idx[1], idx[2]); }
+
+  /**
+   * \brief Sets the voxels and weights of the cell containing cIdx. Follows the boundary handling of itk::LinearInterpolateImageFunction: the cell is clamped to the image and a corner outside is replaced by its inside neighbor.
+   * \return false if cIdx is outside the buffer (same test as itk::LinearInterpolateImageFunction::IsInsideBuffer)
+   */
+  bool UpdateCell(const itk::ContinuousIndex<float, 3>& cIdx, Cell& cell) const;
+
+  /** \brief Like UpdateCell but only succeeds if all eight corners are inside the image and have distinct voxels. Weights are the plain trilinear weights of the fractional index. */
+  bool UpdateInnerCell(const itk::ContinuousIndex<float, 3>& cIdx, Cell& cell) const;
+
+  void Interpolate(const Cell& cell, float* out) const;   ///< writes the trilinear interpolation of all channels to out
+
+protected:
+
+  std::size_t Offset(itk::IndexValueType x, itk::IndexValueType y, itk::IndexValueType z) const
+  {
+    std::size_t brick = (static_cast<std::size_t>(z>>2)*m_NumBricks[1] + static_cast<std::size_t>(y>>2))*m_NumBricks[0] + static_cast<std::size_t>(x>>2);
+    std::size_t voxel = static_cast<std::size_t>(((z&3)<<4) | ((y&3)<<2) | (x&3));
+    return (brick*64 + voxel)*m_ChannelStride;
+  }
+
+  void SetCellVoxels(const itk::Index<3>& base, const itk::Index<3>& next, Cell& cell) const;
+
+  itk::ImageRegion<3>   m_Region;
+  int                   m_Channels;
+  int                   m_ChannelStride;    ///< number of channels rounded up to a multiple of four
+  std::size_t           m_NumBricks[3];
+  std::vector< float >  m_Data;
+  float*                m_Buffer;           ///< 16 byte aligned start of m_Data
+};
+
+}
+
+#endif
@@ -23,6 +23,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <cmath>
 #include <boost/progress.hpp>
 #include <mitkDiffusionFunctionCollection.h>
+#include <algorithm>
 
 namespace itk{
 
@@ -94,6 +95,46 @@ bool FiberExtractionFilter< PixelType >::IsPositive(const itk::Point<float, 3>&
   return false;
 }
 
+template< class PixelType >
+std::vector< char > FiberExtractionFilter< PixelType >::GetCandidateFibers(const ItkInputImgType* roi)
+{
+  int num_fibers = m_InputFiberBundle->GetNumFibers();
+
+  // points outside of the image are never positive, except for label 0. interpolated labels can take any
+  // value between two neighbouring labels, so in these cases we can't restrict the search.
+  bool restrict = true;
+  if (m_InputType==INPUT::LABEL_MAP)
+  {
+    restrict = !m_Interpolate;
+    for (auto l : m_Labels)
+      if (l==0)
+        restrict = false;
+  }
+  if (!restrict)
+    return std::vector< char >(num_fibers, 1);
+
+  // linear interpolation is a convex combination of the neighbouring voxels, so every positive point lies
+  // within one voxel of a positive voxel
+  double min[3], max[3];
+  bool found = false;
+  if (m_InputType==INPUT::SCALAR_MAP)
+  {
+    float threshold = m_Threshold;
+    found = mitk::FiberBundleSpatialIndex::GetPositiveBounds(roi, [threshold](PixelType v){ return v>=threshold; }, min, max);
+  }
+  else
+  {
+    std::vector< unsigned short > labels = m_Labels;
+    found = mitk::FiberBundleSpatialIndex::GetPositiveBounds(roi, [&labels](PixelType v){ return std::find(labels.begin(), labels.end(), v)!=labels.end(); }, min, max);
+  }
+
+  std::vector< char > candidates(num_fibers, 0);
+  if (found)
+    for (auto id : m_InputFiberBundle->GetSpatialIndex().GetCandidateFibers(min, max))
+      candidates[id] = 1;
+  return candidates;
+}
+
 template< class PixelType >
 std::vector< std::pair<unsigned int, unsigned int> > FiberExtractionFilter< PixelType >::GetPositiveLabels() const
 {
@@ -111,6 +152,10 @@ void FiberExtractionFilter< PixelType >::ExtractOverlap(mitk::FiberBundle::Point
 
   std::vector< long > negative_ids; // fibers not overlapping with ANY mask
 
+  std::vector< std::vector< char > > candidates;
+  for (auto roi : m_RoiImages)
+    candidates.push_back(GetCandidateFibers(roi));
+
   boost::progress_display disp(m_InputFiberBundle->GetNumFibers());
   for (int i=0; i<m_InputFiberBundle->GetNumFibers(); i++)
   {
@@ -122,6 +167,8 @@ void FiberExtractionFilter< PixelType >::ExtractOverlap(mitk::FiberBundle::Point
     bool positive = false;
     for (unsigned int m=0; m<m_RoiImages.size(); ++m)
     {
+      if (!candidates[m][i])
+        continue;
       auto roi = m_RoiImages.at(m);
       m_Interpolator->SetInputImage(roi);
       int inside = 0;
@@ -169,6 +216,10 @@ void FiberExtractionFilter< PixelType >::ExtractEndpoints(mitk::FiberBundle::Poi
 
   std::vector< long > negative_ids; // fibers not overlapping with ANY mask
 
+  std::vector< std::vector< char > > candidates;
+  for (auto roi : m_RoiImages)
+    candidates.push_back(GetCandidateFibers(roi));
+
   boost::progress_display disp(m_InputFiberBundle->GetNumFibers());
   for (int i=0; i<m_InputFiberBundle->GetNumFibers(); i++)
   {
@@ -181,6 +232,8 @@ void FiberExtractionFilter< PixelType >::ExtractEndpoints(mitk::FiberBundle::Poi
     if (numPoints>1)
       for (unsigned int m=0; m<m_RoiImages.size(); ++m)
       {
+        if (!candidates[m][i])
+          continue;
         auto roi = m_RoiImages.at(m);
         m_Interpolator->SetInputImage(roi);
 
@@ -235,6 +288,10 @@ void FiberExtractionFilter< PixelType >::ExtractLabels(mitk::FiberBundle::Pointe
 
   std::vector< long > negative_ids; // fibers not overlapping with ANY label
 
+  std::vector< std::vector< char > > candidates;
+  for (auto roi : m_RoiImages)
+    candidates.push_back(GetCandidateFibers(roi));
+
   boost::progress_display disp(m_InputFiberBundle->GetNumFibers());
   for (int i=0; i<m_InputFiberBundle->GetNumFibers(); i++)
   {
@@ -247,6 +304,8 @@ void FiberExtractionFilter< PixelType >::ExtractLabels(mitk::FiberBundle::Pointe
     if (numPoints>1)
       for (unsigned int m=0; m<m_RoiImages.size(); ++m)
       {
+        if (!candidates[m][i])
+          continue;
         auto roi = m_RoiImages.at(m);
         m_Interpolator->SetInputImage(roi);
 
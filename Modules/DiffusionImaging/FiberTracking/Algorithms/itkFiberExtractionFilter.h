@@ -92,6 +92,7 @@ protected:
   void ExtractEndpoints(mitk::FiberBundle::Pointer fib);
   void ExtractLabels(mitk::FiberBundle::Pointer fib);
   bool IsPositive(const itk::Point<float, 3>& itkP);
+  std::vector< char > GetCandidateFibers(const ItkInputImgType* roi);   ///< Flags the fibers that could be positive for the given ROI (spatial index query)
 
   mitk::FiberBundle::Pointer                  m_InputFiberBundle;
   std::vector< mitk::FiberBundle::Pointer >   m_Positives;
@@ -1,6 +1,7 @@
 #include "itkFitFibersToImageFilter.h"
 
 #include <boost/progress.hpp>
+#include <omp.h>
 
 namespace itk{
 
@@ -45,6 +46,33 @@ FitFibersToImageFilter::~FitFibersToImageFilter()
 
 }
 
+void FitFibersToImageFilter::GetFiberBuffers(std::vector< mitk::FiberPointBuffer >& buffers, std::vector< unsigned int >& first_fiber)
+{
+  buffers.clear();
+  first_fiber.clear();
+  first_fiber.push_back(0);
+  m_GroupSizes.clear();
+  for (unsigned int bundle=0; bundle<m_Tractograms.size(); bundle++)
+  {
+    buffers.push_back(m_Tractograms.at(bundle)->GetFiberPointBuffer());
+    m_GroupSizes.push_back(m_Tractograms.at(bundle)->GetNumFibers());
+    first_fiber.push_back(first_fiber.back() + m_Tractograms.at(bundle)->GetNumFibers());
+  }
+}
+
+void FitFibersToImageFilter::AppendFiberTriplets(mitk::CsrMatrix::TripletContainer& fiber_triplets, mitk::CsrMatrix::TripletContainer& triplets)
+{
+  // all entries of one fiber share the column, densely sampled fibers hit the same row many times
+  std::stable_sort(fiber_triplets.begin(), fiber_triplets.end(), [](const mitk::CsrMatrix::Triplet& t1, const mitk::CsrMatrix::Triplet& t2) { return t1.row<t2.row; });
+  for (auto& t : fiber_triplets)
+  {
+    if (!triplets.empty() && triplets.back().row==t.row && triplets.back().col==t.col)
+      triplets.back().value += t.value;
+    else
+      triplets.push_back(t);
+  }
+}
+
 void FitFibersToImageFilter::CreateDiffSystem()
 {
   sz_x = m_DiffImage->GetLargestPossibleRegion().GetSize(0);
@@ -79,32 +107,45 @@ void FitFibersToImageFilter::CreateDiffSystem()
   MITK_INFO << "Num. residuals: " << m_NumResiduals;
   MITK_INFO << "Creating system ...";
 
-  A.set_size(m_NumResiduals, m_NumUnknowns);
   b.set_size(m_NumResiduals); b.fill(0.0);
 
   m_MeanTractDensity = 0;
   m_MeanSignal = 0;
   m_NumCoveredDirections = 0;
-  fiber_count = 0;
-  vnl_vector<int> voxel_indicator; voxel_indicator.set_size(sz_x*sz_y*sz_z); voxel_indicator.fill(0);
 
-  m_GroupSizes.clear();
-  for (unsigned int bundle=0; bundle<m_Tractograms.size(); bundle++)
+  int num_nonzero_g = 0;
+  for (int g=0; g<dim_four_size; ++g)
+    if( m_SignalModel->GetGradientDirection(g).GetNorm()>=mitk::eps )
+      ++num_nonzero_g;
+
+  std::vector< mitk::FiberPointBuffer > fibers;
+  std::vector< unsigned int > first_fiber;
+  GetFiberBuffers(fibers, first_fiber);
+  fiber_count = first_fiber.back();
+
+  std::vector< mitk::CsrMatrix::TripletContainer > triplets(omp_get_max_threads());
+  double mean_tract_density = 0;
+#pragma omp parallel reduction(+:mean_tract_density)
   {
-    vtkSmartPointer<vtkPolyData> polydata = m_Tractograms.at(bundle)->GetFiberPolyData();
-    m_GroupSizes.push_back(m_Tractograms.at(bundle)->GetNumFibers());
-    for (int i=0; i<m_Tractograms.at(bundle)->GetNumFibers(); ++i)
+    mitk::CsrMatrix::TripletContainer& thread_triplets = triplets[omp_get_thread_num()];
+    mitk::CsrMatrix::TripletContainer fiber_triplets;
+
+#pragma omp for schedule(dynamic, 100)
+    for (int f=0; f<static_cast<int>(fiber_count); ++f)
     {
-      vtkCell* cell = polydata->GetCell(i);
-      int numPoints = cell->GetNumberOfPoints();
-      vtkPoints* points = cell->GetPoints();
+      unsigned int bundle = std::upper_bound(first_fiber.begin(), first_fiber.end(), static_cast<unsigned int>(f)) - first_fiber.begin() - 1;
+      unsigned int col = m_FitIndividualFibers ? f : bundle;
+      unsigned int i = f - first_fiber[bundle];
+      int numPoints = fibers[bundle].GetNumberOfPoints(i);
+      const float* points = fibers[bundle].GetFiberPoints(i);
 
       if (numPoints<2)
         MITK_INFO << "FIBER WITH ONLY ONE POINT ENCOUNTERED!";
 
+      fiber_triplets.clear();
       for (int j=0; j<numPoints-1; ++j)
       {
-        double* p1 = points->GetPoint(j);
+        const float* p1 = points + 3*j;
         PointType3 p;
         p[0]=p1[0];
         p[1]=p1[1];
@@ -115,63 +156,76 @@ void FitFibersToImageFilter::CreateDiffSystem()
         if (!m_DiffImage->GetLargestPossibleRegion().IsInside(idx3) || (m_MaskImage.IsNotNull() && m_MaskImage->GetPixel(idx3)==0))
           continue;
 
-        double* p2 = points->GetPoint(j+1);
+        const float* p2 = points + 3*(j+1);
         mitk::DiffusionSignalModel<>::GradientType fiber_dir;
         fiber_dir[0] = p[0]-p2[0];
         fiber_dir[1] = p[1]-p2[1];
         fiber_dir[2] = p[2]-p2[2];
         fiber_dir.Normalize();
 
-        int x = idx3[0];
-        int y = idx3[1];
-        int z = idx3[2];
-
-        mitk::DiffusionSignalModel<>::PixelType simulated_pixel = m_SignalModel->SimulateMeasurement(fiber_dir);
-        VectorImgType::PixelType measured_pixel = m_DiffImage->GetPixel(idx3);
+        // some signal models keep internal state (e.g. random generators)
+        mitk::DiffusionSignalModel<>::PixelType simulated_pixel;
+#pragma omp critical (FitFibersToImageFilter_SignalModel)
+        simulated_pixel = m_SignalModel->SimulateMeasurement(fiber_dir);
 
         double simulated_mean = 0;
-        double measured_mean = 0;
-        int num_nonzero_g = 0;
         for (int g=0; g<dim_four_size; ++g)
         {
           if( m_SignalModel->GetGradientDirection(g).GetNorm()<mitk::eps )
             continue;
           simulated_mean += simulated_pixel[g];
-          measured_mean += (double)measured_pixel[g];
-          ++num_nonzero_g;
         }
         simulated_mean /= num_nonzero_g;
-        measured_mean /= num_nonzero_g;
         simulated_pixel -= simulated_mean;
+        mean_tract_density += simulated_mean;
 
-        if (voxel_indicator[x + sz_x*y + sz_x*sz_y*z]==0)
-          m_MeanSignal += measured_mean;
-        m_MeanTractDensity += simulated_mean;
-        voxel_indicator[x + sz_x*y + sz_x*sz_y*z] = 1;
-
+        unsigned int voxel = idx3[0] + sz_x*idx3[1] + sz_x*sz_y*idx3[2];
         for (int g=0; g<dim_four_size; ++g)
         {
-          unsigned int linear_index = x + sz_x*y + sz_x*sz_y*z + sz_x*sz_y*sz_z*g;
-
-          if (m_FitIndividualFibers)
-          {
-            b[linear_index] = (double)measured_pixel[g] - measured_mean;
-            A.put(linear_index, fiber_count, A.get(linear_index, fiber_count) + simulated_pixel[g]);
-          }
-          else
-          {
-            b[linear_index] = (double)measured_pixel[g] - measured_mean;
-            A.put(linear_index, bundle, A.get(linear_index, bundle) + simulated_pixel[g]);
-          }
+          mitk::CsrMatrix::Triplet t = { voxel + num_voxels*g, col, simulated_pixel[g] };
+          fiber_triplets.push_back(t);
         }
-
       }
 
-      ++fiber_count;
+      AppendFiberTriplets(fiber_triplets, thread_triplets);
     }
   }
+  m_MeanTractDensity = mean_tract_density;
+
+  A.SetTriplets(m_NumResiduals, m_NumUnknowns, triplets);
+
+  // the measurements of all covered voxels, a voxel is covered if any fiber segment contributed to its first channel
+  double mean_signal = 0;
+  unsigned int num_covered = 0;
+#pragma omp parallel for schedule(dynamic, 4096) reduction(+:mean_signal,num_covered)
+  for (int voxel=0; voxel<num_voxels; ++voxel)
+  {
+    if (A.GetRowSize(voxel)==0)
+      continue;
 
-  m_NumCoveredDirections = voxel_indicator.sum();
+    itk::Index<3> idx3;
+    idx3[0] = voxel % sz_x;
+    idx3[1] = (voxel / sz_x) % sz_y;
+    idx3[2] = voxel / (sz_x*sz_y);
+    VectorImgType::PixelType measured_pixel = m_DiffImage->GetPixel(idx3);
+
+    double measured_mean = 0;
+    for (int g=0; g<dim_four_size; ++g)
+    {
+      if( m_SignalModel->GetGradientDirection(g).GetNorm()<mitk::eps )
+        continue;
+      measured_mean += (double)measured_pixel[g];
+    }
+    measured_mean /= num_nonzero_g;
+
+    for (int g=0; g<dim_four_size; ++g)
+      b[voxel + num_voxels*g] = (double)measured_pixel[g] - measured_mean;
+
+    mean_signal += measured_mean;
+    ++num_covered;
+  }
+  m_MeanSignal = mean_signal;
+  m_NumCoveredDirections = num_covered;
 
   m_MeanTractDensity /= (m_NumCoveredDirections*fiber_count);
   m_MeanSignal /= m_NumCoveredDirections;
@@ -219,32 +273,40 @@ void FitFibersToImageFilter::CreatePeakSystem()
   MITK_INFO << "Num. residuals: " << m_NumResiduals;
   MITK_INFO << "Creating system ...";
 
-  A.set_size(m_NumResiduals, m_NumUnknowns);
   b.set_size(m_NumResiduals); b.fill(0.0);
 
   m_MeanTractDensity = 0;
   m_MeanSignal = 0;
   m_NumCoveredDirections = 0;
-  fiber_count = 0;
 
-  m_GroupSizes.clear();
-  for (unsigned int bundle=0; bundle<m_Tractograms.size(); bundle++)
+  std::vector< mitk::FiberPointBuffer > fibers;
+  std::vector< unsigned int > first_fiber;
+  GetFiberBuffers(fibers, first_fiber);
+  fiber_count = first_fiber.back();
+
+  std::vector< mitk::CsrMatrix::TripletContainer > triplets(omp_get_max_threads());
+  double mean_tract_density = 0;
+#pragma omp parallel reduction(+:mean_tract_density)
   {
-    vtkSmartPointer<vtkPolyData> polydata = m_Tractograms.at(bundle)->GetFiberPolyData();
+    mitk::CsrMatrix::TripletContainer& thread_triplets = triplets[omp_get_thread_num()];
+    mitk::CsrMatrix::TripletContainer fiber_triplets;
 
-    m_GroupSizes.push_back(m_Tractograms.at(bundle)->GetNumFibers());
-    for (int i=0; i<m_Tractograms.at(bundle)->GetNumFibers(); ++i)
+#pragma omp for schedule(dynamic, 100)
+    for (int f=0; f<static_cast<int>(fiber_count); ++f)
     {
-      vtkCell* cell = polydata->GetCell(i);
-      int numPoints = cell->GetNumberOfPoints();
-      vtkPoints* points = cell->GetPoints();
+      unsigned int bundle = std::upper_bound(first_fiber.begin(), first_fiber.end(), static_cast<unsigned int>(f)) - first_fiber.begin() - 1;
+      unsigned int col = m_FitIndividualFibers ? f : bundle;
+      unsigned int i = f - first_fiber[bundle];
+      int numPoints = fibers[bundle].GetNumberOfPoints(i);
+      const float* points = fibers[bundle].GetFiberPoints(i);
 
       if (numPoints<2)
         MITK_INFO << "FIBER WITH ONLY ONE POINT ENCOUNTERED!";
 
+      fiber_triplets.clear();
       for (int j=0; j<numPoints-1; ++j)
       {
-        double* p1 = points->GetPoint(j);
+        const float* p1 = points + 3*j;
         PointType4 p;
         p[0]=p1[0];
         p[1]=p1[1];
@@ -257,7 +319,7 @@ void FitFibersToImageFilter::CreatePeakSystem()
         if (!m_PeakImage->GetLargestPossibleRegion().IsInside(idx4) || (m_MaskImage.IsNotNull() && m_MaskImage->GetPixel(idx3)==0))
           continue;
 
-        double* p2 = points->GetPoint(j+1);
+        const float* p2 = points + 3*(j+1);
         vnl_vector_fixed<float,3> fiber_dir;
         fiber_dir[0] = p[0]-p2[0];
         fiber_dir[1] = p[1]-p2[1];
@@ -275,29 +337,50 @@ void FitFibersToImageFilter::CreatePeakSystem()
         int z = idx4[2];
 
         unsigned int linear_index = x + sz_x*y + sz_x*sz_y*z + sz_x*sz_y*sz_z*peak_id;
+        mean_tract_density += w;
 
-        if (b[linear_index] == 0 && peak_id<dim_four_size-1)
-        {
-          m_NumCoveredDirections++;
-          m_MeanSignal += peak_mag;
-        }
-        m_MeanTractDensity += w;
-
-        if (m_FitIndividualFibers)
-        {
-          b[linear_index] = peak_mag;
-          A.put(linear_index, fiber_count, A.get(linear_index, fiber_count) + w);
-        }
-        else
-        {
-          b[linear_index] = peak_mag;
-          A.put(linear_index, bundle, A.get(linear_index, bundle) + w);
-        }
+        mitk::CsrMatrix::Triplet t = { linear_index, col, w };
+        fiber_triplets.push_back(t);
       }
 
-      ++fiber_count;
+      AppendFiberTriplets(fiber_triplets, thread_triplets);
     }
   }
+  m_MeanTractDensity = mean_tract_density;
+
+  A.SetTriplets(m_NumResiduals, m_NumUnknowns, triplets);
+
+  // the measurement of each covered peak is its magnitude, the last (zero) peak has no measurement
+  double mean_signal = 0;
+  unsigned int num_covered = 0;
+#pragma omp parallel for schedule(dynamic, 4096) reduction(+:mean_signal,num_covered)
+  for (int r=0; r<num_voxels*(dim_four_size-1); ++r)
+  {
+    if (A.GetRowSize(r)==0)
+      continue;
+
+    itk::Index<4> idx4;
+    idx4[0] = r % sz_x;
+    idx4[1] = (r / sz_x) % sz_y;
+    idx4[2] = (r / (sz_x*sz_y)) % sz_z;
+    int peak_id = r / num_voxels;
+
+    vnl_vector_fixed<float,3> dir;
+    idx4[3] = peak_id*3;
+    dir[0] = m_PeakImage->GetPixel(idx4);
+    idx4[3] += 1;
+    dir[1] = m_PeakImage->GetPixel(idx4);
+    idx4[3] += 1;
+    dir[2] = m_PeakImage->GetPixel(idx4);
+
+    float peak_mag = dir.magnitude();
+    b[r] = peak_mag;
+    mean_signal += peak_mag;
+    ++num_covered;
+  }
+  m_MeanSignal = mean_signal;
+  m_NumCoveredDirections = num_covered;
+
   m_MeanTractDensity /= (m_NumCoveredDirections*fiber_count);
   m_MeanSignal /= m_NumCoveredDirections;
   A /= m_MeanTractDensity;
@@ -343,29 +426,36 @@ void FitFibersToImageFilter::CreateScalarSystem()
   MITK_INFO << "Num. residuals: " << m_NumResiduals;
   MITK_INFO << "Creating system ...";
 
-  A.set_size(m_NumResiduals, m_NumUnknowns);
   b.set_size(m_NumResiduals); b.fill(0.0);
 
   m_MeanTractDensity = 0;
   m_MeanSignal = 0;
-  int numCoveredVoxels = 0;
-  fiber_count = 0;
 
-  m_GroupSizes.clear();
-  for (unsigned int bundle=0; bundle<m_Tractograms.size(); bundle++)
+  std::vector< mitk::FiberPointBuffer > fibers;
+  std::vector< unsigned int > first_fiber;
+  GetFiberBuffers(fibers, first_fiber);
+  fiber_count = first_fiber.back();
+
+  std::vector< mitk::CsrMatrix::TripletContainer > triplets(omp_get_max_threads());
+  double mean_tract_density = 0;
+#pragma omp parallel reduction(+:mean_tract_density)
   {
-    vtkSmartPointer<vtkPolyData> polydata = m_Tractograms.at(bundle)->GetFiberPolyData();
+    mitk::CsrMatrix::TripletContainer& thread_triplets = triplets[omp_get_thread_num()];
+    mitk::CsrMatrix::TripletContainer fiber_triplets;
 
-    m_GroupSizes.push_back(m_Tractograms.at(bundle)->GetNumFibers());
-    for (int i=0; i<m_Tractograms.at(bundle)->GetNumFibers(); ++i)
+#pragma omp for schedule(dynamic, 100)
+    for (int f=0; f<static_cast<int>(fiber_count); ++f)
     {
-      vtkCell* cell = polydata->GetCell(i);
-      int numPoints = cell->GetNumberOfPoints();
-      vtkPoints* points = cell->GetPoints();
+      unsigned int bundle = std::upper_bound(first_fiber.begin(), first_fiber.end(), static_cast<unsigned int>(f)) - first_fiber.begin() - 1;
+      unsigned int col = m_FitIndividualFibers ? f : bundle;
+      unsigned int i = f - first_fiber[bundle];
+      int numPoints = fibers[bundle].GetNumberOfPoints(i);
+      const float* points = fibers[bundle].GetFiberPoints(i);
 
+      fiber_triplets.clear();
       for (int j=0; j<numPoints; ++j)
       {
-        double* p1 = points->GetPoint(j);
+        const float* p1 = points + 3*j;
         PointType3 p;
         p[0]=p1[0];
         p[1]=p1[1];
@@ -376,35 +466,40 @@ void FitFibersToImageFilter::CreateScalarSystem()
         if (!m_ScalarImage->GetLargestPossibleRegion().IsInside(idx3) || (m_MaskImage.IsNotNull() && m_MaskImage->GetPixel(idx3)==0))
           continue;
 
-        float image_value = m_ScalarImage->GetPixel(idx3);
-        int x = idx3[0];
-        int y = idx3[1];
-        int z = idx3[2];
-
-        unsigned int linear_index = x + sz_x*y + sz_x*sz_y*z;
+        unsigned int linear_index = idx3[0] + sz_x*idx3[1] + sz_x*sz_y*idx3[2];
+        mean_tract_density += 1;
 
-        if (b[linear_index] == 0)
-        {
-          numCoveredVoxels++;
-          m_MeanSignal += image_value;
-        }
-        m_MeanTractDensity += 1;
-
-        if (m_FitIndividualFibers)
-        {
-          b[linear_index] = image_value;
-          A.put(linear_index, fiber_count, A.get(linear_index, fiber_count) + 1);
-        }
-        else
-        {
-          b[linear_index] = image_value;
-          A.put(linear_index, bundle, A.get(linear_index, bundle) + 1);
-        }
+        mitk::CsrMatrix::Triplet t = { linear_index, col, 1.0 };
+        fiber_triplets.push_back(t);
       }
 
-      ++fiber_count;
+      AppendFiberTriplets(fiber_triplets, thread_triplets);
     }
   }
+  m_MeanTractDensity = mean_tract_density;
+
+  A.SetTriplets(m_NumResiduals, m_NumUnknowns, triplets);
+
+  double mean_signal = 0;
+  int numCoveredVoxels = 0;
+#pragma omp parallel for schedule(dynamic, 4096) reduction(+:mean_signal,numCoveredVoxels)
+  for (int r=0; r<num_voxels; ++r)
+  {
+    if (A.GetRowSize(r)==0)
+      continue;
+
+    itk::Index<3> idx3;
+    idx3[0] = r % sz_x;
+    idx3[1] = (r / sz_x) % sz_y;
+    idx3[2] = r / (sz_x*sz_y);
+
+    float image_value = m_ScalarImage->GetPixel(idx3);
+    b[r] = image_value;
+    mean_signal += image_value;
+    ++numCoveredVoxels;
+  }
+  m_MeanSignal = mean_signal;
+
   m_MeanTractDensity /= (numCoveredVoxels*fiber_count);
   m_MeanSignal /= numCoveredVoxels;
   A /= m_MeanTractDensity;
@@ -558,7 +653,7 @@ void FitFibersToImageFilter::GenerateData()
   MITK_INFO << "NumEvals: " << minimizer.get_num_evaluations();
   MITK_INFO << "NumIterations: " << minimizer.get_num_iterations();
   MITK_INFO << "Residual cost: " << minimizer.get_end_error();
-  m_RMSE = cost.S->get_rms_error(m_Weights);
+  m_RMSE = cost.get_rms_error(m_Weights);
   MITK_INFO << "Final RMSE: " << m_RMSE;
 
   clock.Stop();
@@ -588,7 +683,7 @@ void FitFibersToImageFilter::GenerateData()
 
         ++fiber_count;
       }
-      double d_rms = cost.S->get_rms_error(temp_weights) - m_RMSE;
+      double d_rms = cost.get_rms_error(temp_weights) - m_RMSE;
       m_RmsDiffPerBundle[bundle] = d_rms;
       m_Tractograms.at(bundle)->Compress(0.1);
       m_Tractograms.at(bundle)->ColorFibersByFiberWeights(false, true);
@@ -602,7 +697,7 @@ void FitFibersToImageFilter::GenerateData()
       temp_weights.set_size(m_Weights.size());
       temp_weights.copy_in(m_Weights.data_block());
       temp_weights[i] = 0;
-      double d_rms = cost.S->get_rms_error(temp_weights) - m_RMSE;
+      double d_rms = cost.get_rms_error(temp_weights) - m_RMSE;
       m_RmsDiffPerBundle[i] = d_rms;
 
       m_Tractograms.at(i)->SetFiberWeights(m_Weights[i]);
@@ -656,7 +751,7 @@ void FitFibersToImageFilter::GenerateOutputDiffImages()
   m_FittedImageDiff->FillBuffer(pix);
 
   vnl_vector<double> fitted_b; fitted_b.set_size(b.size());
-  cost.S->multiply(m_Weights, fitted_b);
+  A.Multiply(m_Weights, fitted_b);
 
   itk::ImageRegionIterator<VectorImgType> it1 = itk::ImageRegionIterator<VectorImgType>(m_DiffImage, m_DiffImage->GetLargestPossibleRegion());
   itk::ImageRegionIterator<VectorImgType> it2 = itk::ImageRegionIterator<VectorImgType>(m_FittedImageDiff, m_FittedImageDiff->GetLargestPossibleRegion());
@@ -747,7 +842,7 @@ void FitFibersToImageFilter::GenerateOutputScalarImages()
   m_FittedImageScalar->FillBuffer(0);
 
   vnl_vector<double> fitted_b; fitted_b.set_size(b.size());
-  cost.S->multiply(m_Weights, fitted_b);
+  A.Multiply(m_Weights, fitted_b);
 
   itk::ImageRegionIterator<DoubleImgType> it1 = itk::ImageRegionIterator<DoubleImgType>(m_ScalarImage, m_ScalarImage->GetLargestPossibleRegion());
   itk::ImageRegionIterator<DoubleImgType> it2 = itk::ImageRegionIterator<DoubleImgType>(m_FittedImageScalar, m_FittedImageScalar->GetLargestPossibleRegion());
@@ -833,7 +928,7 @@ void FitFibersToImageFilter::GenerateOutputPeakImages()
   m_FittedImage->FillBuffer(0.0);
 
   vnl_vector<double> fitted_b; fitted_b.set_size(b.size());
-  cost.S->multiply(m_Weights, fitted_b);
+  A.Multiply(m_Weights, fitted_b);
 
   for (unsigned int r=0; r<b.size(); r++)
   {
@@ -6,8 +6,7 @@
 #include <itkImageSource.h>
 #include <mitkPeakImage.h>
 #include <vnl/algo/vnl_lbfgsb.h>
-#include <vnl/vnl_sparse_matrix.h>
-#include <vnl/vnl_sparse_matrix_linear_system.h>
+#include <mitkCsrMatrix.h>
 #include <itkImageDuplicator.h>
 #include <itkTimeProbe.h>
 #include <itkMersenneTwisterRandomVariateGenerator.h>
@@ -29,10 +28,8 @@ public:
     NONE
   };
 
-  vnl_sparse_matrix_linear_system< double >* S;
-  vnl_sparse_matrix< double > m_A;
-  vnl_sparse_matrix< double > m_A_Ones; // matrix indicating active weights with 1
-  vnl_vector< double > m_b;
+  const mitk::CsrMatrix* m_A;      // system matrix, not copied
+  const vnl_vector< double >* m_b;  // measurements, not copied
   double m_Lambda;  // regularization factor
 
   vnl_vector<double> row_sums;  // number of active weights per row
@@ -40,22 +37,16 @@ public:
   REGU regularization;
   std::vector<unsigned int> group_sizes;
 
-  void SetProblem(vnl_sparse_matrix< double >& A, vnl_vector<double>& b, double lambda, REGU regu)
+  void SetProblem(const mitk::CsrMatrix& A, const vnl_vector<double>& b, double lambda, REGU regu)
   {
-    S = new vnl_sparse_matrix_linear_system<double>(A, b);
-    m_A = A;
-    m_b = b;
+    m_A = &A;
+    m_b = &b;
     m_Lambda = lambda;
 
-    m_A_Ones.set_size(m_A.rows(), m_A.cols());
-    m_A.reset();
-    while (m_A.next())
-      m_A_Ones.put(m_A.getrow(), m_A.getcolumn(), 1);
-
-    unsigned int N = m_b.size();
-    vnl_vector<double> ones; ones.set_size(dim); ones.fill(1.0);
+    unsigned int N = m_b->size();
     row_sums.set_size(N);
-    m_A_Ones.mult(ones, row_sums);
+    for (unsigned int r=0; r<N; ++r)
+      row_sums[r] = m_A->GetRowSize(r);
     local_weight_means.set_size(N);
     regularization = regu;
   }
@@ -65,15 +56,20 @@ public:
     unsigned int sum = 0;
     for (auto s : sizes)
       sum += s;
-    if (sum!=m_A.cols())
+    if (sum!=m_A->cols())
     {
-      MITK_INFO << "Group sizes do not match number of unknowns (" << sum << " vs. " << m_A.cols() << ")";
+      MITK_INFO << "Group sizes do not match number of unknowns (" << sum << " vs. " << m_A->cols() << ")";
       return;
     }
     group_sizes = sizes;
   }
 
-  VnlCostFunction(const int NumVars=0) : vnl_cost_function(NumVars)
+  VnlCostFunction(const int NumVars=0)
+    : vnl_cost_function(NumVars)
+    , m_A(nullptr)
+    , m_b(nullptr)
+    , m_Lambda(0)
+    , regularization(NONE)
   {
   }
 
@@ -121,20 +117,23 @@ public:
   // Regularization: voxel-weise mean squared deaviation of weights from voxel-wise mean weight (enforce locally uniform weights)
   void regu_VoxelVariance(vnl_vector<double> const &x, double& cost)
   {
-    m_A_Ones.mult(x, local_weight_means);
+    m_A->PatternMultiply(x, local_weight_means);
     local_weight_means = element_quotient(local_weight_means, row_sums);
 
-    m_A_Ones.reset();
+    const std::vector< std::size_t >& row_pointers = m_A->GetRowPointers();
+    const std::vector< unsigned int >& columns = m_A->GetColumnIndices();
     double regu = 0;
-    while (m_A_Ones.next())
-    {
-      double d = 0;
-      if (x[m_A_Ones.getcolumn()]>local_weight_means[m_A_Ones.getrow()])
-        d = std::exp(x[m_A_Ones.getcolumn()]) - std::exp(local_weight_means[m_A_Ones.getrow()]);
-      else
-        d = x[m_A_Ones.getcolumn()] - local_weight_means[m_A_Ones.getrow()];
-      regu += d*d;
-    }
+#pragma omp parallel for schedule(dynamic, 4096) reduction(+:regu)
+    for (int r=0; r<static_cast<int>(m_A->rows()); ++r)
+      for (std::size_t k=row_pointers[r]; k<row_pointers[r+1]; ++k)
+      {
+        double d = 0;
+        if (x[columns[k]]>local_weight_means[r])
+          d = std::exp(x[columns[k]]) - std::exp(local_weight_means[r]);
+        else
+          d = x[columns[k]] - local_weight_means[r];
+        regu += d*d;
+      }
     cost += m_Lambda*regu/dim;
   }
 
@@ -195,23 +194,29 @@ public:
 
   void grad_regu_VoxelVariance(vnl_vector<double> const &x, vnl_vector<double> &dx)
   {
-    m_A_Ones.mult(x, local_weight_means);
+    m_A->PatternMultiply(x, local_weight_means);
     local_weight_means = element_quotient(local_weight_means, row_sums);
 
     vnl_vector<double> exp_x = x.apply(std::exp);
     vnl_vector<double> exp_means = local_weight_means.apply(std::exp);
 
+    // accumulate per column, so every unknown is written by one thread only
+    const std::vector< std::size_t >& column_pointers = m_A->GetColumnPointers();
+    const std::vector< unsigned int >& rows = m_A->GetRowIndices();
     vnl_vector<double> tdx(dim, 0);
-    m_A_Ones.reset();
-    while (m_A_Ones.next())
+#pragma omp parallel for schedule(dynamic, 256)
+    for (int c=0; c<dim; ++c)
     {
-      int c = m_A_Ones.getcolumn();
-      int r = m_A_Ones.getrow();
-
-      if (x[c]>local_weight_means[r])
-        tdx[c] += exp_x[c] * ( exp_x[c] - exp_means[r] );
-      else
-        tdx[c] += x[c] - local_weight_means[r];
+      double g = 0;
+      for (std::size_t k=column_pointers[c]; k<column_pointers[c+1]; ++k)
+      {
+        int r = rows[k];
+        if (x[c]>local_weight_means[r])
+          g += exp_x[c] * ( exp_x[c] - exp_means[r] );
+        else
+          g += x[c] - local_weight_means[r];
+      }
+      tdx[c] = g;
     }
     dx += tdx*2.0*m_Lambda/dim;
   }
@@ -272,35 +277,49 @@ public:
   // cost function
   double f(vnl_vector<double> const &x)
   {
-    // RMS error
-    unsigned int N = m_b.size();
-    vnl_vector<double> d; d.set_size(N);
-    S->multiply(x,d);
-    double cost = (d - m_b).squared_magnitude()/N;
-
-    // regularize
-    calc_regularization(x, cost);
-
+    double cost = 0;
+    compute(x, &cost, nullptr);
     return cost;
   }
 
   // gradient of cost function
   void gradf(vnl_vector<double> const &x, vnl_vector<double> &dx)
   {
-    dx.fill(0.0);
-    unsigned int N = m_b.size();
+    compute(x, nullptr, &dx);
+  }
 
+  // cost and gradient share the output difference, so it is only computed once per evaluation
+  void compute(vnl_vector<double> const &x, double *f, vnl_vector<double> *g)
+  {
     // calculate output difference d
-    vnl_vector<double> d; d.set_size(N);
-    S->multiply(x,d);
-    d -= m_b;
+    unsigned int N = m_b->size();
+    vnl_vector<double> d;
+    m_A->Multiply(x, d);
+    d -= *m_b;
+
+    if (f!=nullptr)
+    {
+      // RMS error
+      *f = d.squared_magnitude()/N;
 
-    // (f(u(x)))' = f'(u(x)) * u'(x)
-    // d/dx_j = 1/N * Sum_i A_i,j * 2*(A_i,j * x_j - b_i)
-    S->transpose_multiply(d, dx);
-    dx *= 2.0/N;
+      // regularize
+      calc_regularization(x, *f);
+    }
+
+    if (g!=nullptr)
+    {
+      // (f(u(x)))' = f'(u(x)) * u'(x)
+      // d/dx_j = 1/N * Sum_i A_i,j * 2*(A_i,j * x_j - b_i)
+      m_A->TransposeMultiply(d, *g);
+      *g *= 2.0/N;
 
-    calc_regularization_gradient(x,dx);
+      calc_regularization_gradient(x, *g);
+    }
+  }
+
+  double get_rms_error(vnl_vector<double> const &x) const
+  {
+    return m_A->GetRmsError(x, *m_b);
   }
 };
 
@@ -405,6 +424,11 @@ protected:
 
   void GetClosestPeak(itk::Index<4> idx, PeakImgType::Pointer m_PeakImage , vnl_vector_fixed<float,3> fiber_dir, int& id, double& w, double& peak_mag );
 
+  /** \brief Contiguous copies of all tractograms and the index of the first fiber of each tractogram */
+  void GetFiberBuffers(std::vector< mitk::FiberPointBuffer >& buffers, std::vector< unsigned int >& first_fiber);
+  /** \brief Sums up the entries of one fiber that fall into the same row and appends them to the (thread local) triplets */
+  static void AppendFiberTriplets(mitk::CsrMatrix::TripletContainer& fiber_triplets, mitk::CsrMatrix::TripletContainer& triplets);
+
   void CreatePeakSystem();
   void CreateDiffSystem();
   void CreateScalarSystem();
@@ -459,7 +483,7 @@ protected:
 
   mitk::DiffusionSignalModel<>*               m_SignalModel;
 
-  vnl_sparse_matrix<double>                   A;
+  mitk::CsrMatrix                             A;
   vnl_vector<double>                          b;
   VnlCostFunction                             cost;
   int                                         sz_x;
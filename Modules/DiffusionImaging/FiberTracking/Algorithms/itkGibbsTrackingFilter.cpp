@@ -32,6 +32,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 // MISC
 #include <fstream>
+#include <algorithm>
 // #include <QFile>
 #include <tinyxml.h>
 #include <boost/progress.hpp>
@@ -65,7 +66,11 @@ GibbsTrackingFilter< ItkOdfImageType >::GibbsTrackingFilter():
   m_RandomSeed(-1),
   m_LoadParameterFile(""),
   m_LutPath(""),
-  m_IsInValidState(true)
+  m_IsInValidState(true),
+  m_NumReplicas(1),
+  m_SwapInterval(1000),
+  m_TemperatureLadderFactor(2),
+  m_SwapAcceptance(0)
 {
 
 }
@@ -244,18 +249,46 @@ void GibbsTrackingFilter< ItkOdfImageType >::GenerateData()
     mitkThrow() << "Unable to load lookup tables.";
   }
   // initialize the actual tracking components (ParticleGrid, Metropolis Hastings Sampler and Energy Computer)
-  ParticleGrid* particleGrid;
-  GibbsEnergyComputer* encomp;
-  MetropolisHastingsSampler* sampler;
+  // every parallel tempering replica gets its own set, replica 0 uses the components created above
+  if (m_NumReplicas<1)
+    m_NumReplicas = 1;
+  std::vector< ParticleGrid* > particleGrids(m_NumReplicas, nullptr);
+  std::vector< GibbsEnergyComputer* > encomps(m_NumReplicas, nullptr);
+  std::vector< MetropolisHastingsSampler* > samplers(m_NumReplicas, nullptr);
+  std::vector< SphereInterpolator* > interpolators(m_NumReplicas, nullptr);
+  std::vector< Statistics::MersenneTwisterRandomVariateGenerator::Pointer > randGens(m_NumReplicas);
+  interpolators[0] = interpolator;
+  randGens[0] = randGen;
   try{
-    particleGrid = new ParticleGrid(m_MaskImage, m_ParticleLength, m_ParticleGridCellCapacity);
-    encomp = new GibbsEnergyComputer(m_OdfImage, m_MaskImage, particleGrid, interpolator, randGen);
-    encomp->SetParameters(m_ParticleWeight,m_ParticleWidth,m_ConnectionPotential*m_ParticleLength*m_ParticleLength,m_CurvatureThreshold,m_InexBalance,m_ParticlePotential);
-    sampler = new MetropolisHastingsSampler(particleGrid, encomp, randGen, m_CurvatureThreshold);
+    for (unsigned int r=0; r<m_NumReplicas; ++r)
+    {
+      if (r>0)
+      {
+        interpolators[r] = new SphereInterpolator(*interpolator);
+        randGens[r] = Statistics::MersenneTwisterRandomVariateGenerator::New();
+        if (m_RandomSeed>-1)
+          randGens[r]->SetSeed(m_RandomSeed+r);
+        else
+          randGens[r]->SetSeed();
+      }
+      particleGrids[r] = new ParticleGrid(m_MaskImage, m_ParticleLength, m_ParticleGridCellCapacity);
+      encomps[r] = new GibbsEnergyComputer(m_OdfImage, m_MaskImage, particleGrids[r], interpolators[r], randGens[r]);
+      encomps[r]->SetParameters(m_ParticleWeight,m_ParticleWidth,m_ConnectionPotential*m_ParticleLength*m_ParticleLength,m_CurvatureThreshold,m_InexBalance,m_ParticlePotential);
+      samplers[r] = new MetropolisHastingsSampler(particleGrids[r], encomps[r], randGens[r], m_CurvatureThreshold);
+    }
   }
   catch(...)
   {
-    MITK_ERROR  << "Particle grid allocation failed. Not enough memory? Try to increase the particle length.";
+    MITK_ERROR  << "Particle grid allocation failed. Not enough memory? Try to increase the particle length or to use less replicas.";
+    for (unsigned int r=0; r<m_NumReplicas; ++r)
+    {
+      delete samplers[r];
+      delete encomps[r];
+      delete particleGrids[r];
+      if (r>0)
+        delete interpolators[r];
+    }
+    delete interpolator;
     m_IsInValidState = false;
     m_AbortTracking = true;
     m_BuildFibers = false;
@@ -273,8 +306,27 @@ void GibbsTrackingFilter< ItkOdfImageType >::GenerateData()
   MITK_INFO << "Min. fiber length: " << m_MinFiberLength;
   MITK_INFO << "Curvature threshold: " << m_CurvatureThreshold;
   MITK_INFO << "Random seed: " << m_RandomSeed;
+  if (m_NumReplicas>1)
+  {
+    MITK_INFO << "Replicas: " << m_NumReplicas;
+    MITK_INFO << "Swap interval: " << m_SwapInterval;
+    MITK_INFO << "Temperature ladder factor: " << m_TemperatureLadderFactor;
+  }
   MITK_INFO << "----------------------------------------";
 
+  // level[r] is the position of replica r in the temperature ladder, the replica at level 0 is the
+  // one that is annealed to the end temperature and whose particles form the output fibers
+  std::vector< int > level(m_NumReplicas);
+  for (unsigned int r=0; r<m_NumReplicas; ++r)
+    level[r] = r;
+  unsigned int coldReplica = 0;
+  unsigned long swapRounds = 0;
+  unsigned long swapAttempts = 0;
+  unsigned long acceptedSwaps = 0;
+  m_SwapAcceptance = 0;
+  if (m_SwapInterval<1)
+    m_SwapInterval = 1;
+
   // main loop
   preClock.Stop();
   TimeProbe clock; clock.Start();
@@ -286,26 +338,86 @@ void GibbsTrackingFilter< ItkOdfImageType >::GenerateData()
     while (m_CurrentIteration<m_Iterations)
     {
       just_built_fibers = false;
-      ++disp;
-      m_CurrentIteration++;
       if (m_AbortTracking)
         break;
 
-      // update temperatur for simulated annealing process
-      float temperature = m_StartTemperature * exp(alpha*m_CurrentIteration/m_Iterations);
-      sampler->SetTemperature(temperature);
-      sampler->MakeProposal();
+      if (m_NumReplicas==1)
+      {
+        ++disp;
+        m_CurrentIteration++;
+
+        // update temperatur for simulated annealing process
+        float temperature = m_StartTemperature * exp(alpha*m_CurrentIteration/m_Iterations);
+        samplers[0]->SetTemperature(temperature);
+        samplers[0]->MakeProposal();
+      }
+      else
+      {
+        // all replicas follow the annealing schedule, scaled by their position in the temperature ladder
+        unsigned long steps = m_SwapInterval;
+        if (m_CurrentIteration+steps>m_Iterations)
+          steps = m_Iterations-m_CurrentIteration;
+        double firstIteration = m_CurrentIteration;
+
+#pragma omp parallel for num_threads(m_NumReplicas)
+        for (int r=0; r<(int)m_NumReplicas; ++r)
+        {
+          float ladder = pow(m_TemperatureLadderFactor, level[r]);
+          for (unsigned long i=1; i<=steps; ++i)
+          {
+            float temperature = ladder * m_StartTemperature * exp(alpha*(firstIteration+i)/m_Iterations);
+            samplers[r]->SetTemperature(temperature);
+            samplers[r]->MakeProposal();
+          }
+        }
+        m_CurrentIteration += steps;
+        disp += steps;
+
+        // replica exchange between neighbouring temperatures. only the internal energy is tempered
+        // (the external temperature of the sampler is constant), so the external energies cancel out.
+        std::vector< float > energies(m_NumReplicas);
+#pragma omp parallel for num_threads(m_NumReplicas)
+        for (int r=0; r<(int)m_NumReplicas; ++r)
+          energies[r] = encomps[r]->ComputeTotalInternalEnergy();
+
+        std::vector< int > replicaAtLevel(m_NumReplicas);
+        for (unsigned int r=0; r<m_NumReplicas; ++r)
+          replicaAtLevel[level[r]] = r;
+
+        float baseTemperature = m_StartTemperature * exp(alpha*m_CurrentIteration/m_Iterations);
+        for (unsigned int l=swapRounds%2; l+1<m_NumReplicas; l+=2)
+        {
+          swapAttempts++;
+          int a = replicaAtLevel[l];
+          int b = replicaAtLevel[l+1];
+          float ta = baseTemperature * pow(m_TemperatureLadderFactor, l);
+          float tb = baseTemperature * pow(m_TemperatureLadderFactor, l+1);
+          float prob = exp((energies[b]-energies[a])*(1/ta-1/tb));
+          if (prob > 1 || randGen->GetVariate() < prob)
+          {
+            std::swap(level[a], level[b]);
+            acceptedSwaps++;
+          }
+        }
+        swapRounds++;
+        if (swapAttempts>0)
+          m_SwapAcceptance = (float)acceptedSwaps/swapAttempts;
+
+        for (unsigned int r=0; r<m_NumReplicas; ++r)
+          if (level[r]==0)
+            coldReplica = r;
+      }
 
-      m_ProposalAcceptance = (float)sampler->GetNumAcceptedProposals()/m_CurrentIteration;
-      m_NumParticles = particleGrid->m_NumParticles;
-      m_NumConnections = particleGrid->m_NumConnections;
+      m_ProposalAcceptance = (float)samplers[coldReplica]->GetNumAcceptedProposals()/m_CurrentIteration;
+      m_NumParticles = particleGrids[coldReplica]->m_NumParticles;
+      m_NumConnections = particleGrids[coldReplica]->m_NumConnections;
 
       if (m_AbortTracking)
         break;
 
       if (m_BuildFibers)
       {
-        FiberBuilder fiberBuilder(particleGrid, m_MaskImage);
+        FiberBuilder fiberBuilder(particleGrids[coldReplica], m_MaskImage);
         m_FiberPolyData = fiberBuilder.iterate(m_MinFiberLength);
         m_NumAcceptedFibers = m_FiberPolyData->GetNumberOfLines();
         m_BuildFibers = false;
@@ -314,16 +426,24 @@ void GibbsTrackingFilter< ItkOdfImageType >::GenerateData()
     }
   if (!just_built_fibers)
   {
-    FiberBuilder fiberBuilder(particleGrid, m_MaskImage);
+    FiberBuilder fiberBuilder(particleGrids[coldReplica], m_MaskImage);
     m_FiberPolyData = fiberBuilder.iterate(m_MinFiberLength);
     m_NumAcceptedFibers = m_FiberPolyData->GetNumberOfLines();
   }
   clock.Stop();
 
-  delete sampler;
-  delete encomp;
+  if (m_NumReplicas>1)
+    MITK_INFO << "GibbsTrackingFilter: replica exchange acceptance " << m_SwapAcceptance;
+
+  for (unsigned int r=0; r<m_NumReplicas; ++r)
+  {
+    delete samplers[r];
+    delete encomps[r];
+    delete particleGrids[r];
+    if (r>0)
+      delete interpolators[r];
+  }
   delete interpolator;
-  delete particleGrid;
   m_AbortTracking = true;
   m_BuildFibers = false;
 
@@ -74,6 +74,9 @@ public:
     itkSetMacro( LoadParameterFile, std::string )   ///< Parameter file.
     itkSetMacro( SaveParameterFile, std::string )
     itkSetMacro( LutPath, std::string )             ///< Path to lookuptables. Default is binary directory.
+    itkSetMacro( NumReplicas, unsigned int )        ///< Number of parallel tempering replicas, each running on its own core with its own particle grid. 1 runs the original single chain.
+    itkSetMacro( SwapInterval, unsigned int )       ///< Number of proposals per replica between two attempts to exchange the temperatures of neighbouring replicas.
+    itkSetMacro( TemperatureLadderFactor, float )   ///< Replica i runs at the annealing temperature times factor^i.
 
     /** Getter. */
     itkGetMacro( ParticleWeight, float )
@@ -86,6 +89,8 @@ public:
     itkGetMacro( CurrentIteration, double)
     itkGetMacro( Iterations, double)
     itkGetMacro( IsInValidState, bool)
+    itkGetMacro( NumReplicas, unsigned int )
+    itkGetMacro( SwapAcceptance, float )            ///< Fraction of accepted replica exchanges (0-1)
     FiberPolyDataType GetFiberBundle();             ///< Output fibers
 
     void SetDicomProperties(mitk::FiberBundle::Pointer fib);
@@ -141,6 +146,10 @@ protected:
     std::string     m_SaveParameterFile;    ///< filename of parameter file (writer)
     std::string     m_LutPath;              ///< path to lookuptables used by the sphere interpolator
     bool            m_IsInValidState;       ///< Whether the filter is in a valid state, false if error occured
+    unsigned int    m_NumReplicas;          ///< number of parallel tempering replicas
+    unsigned int    m_SwapInterval;         ///< proposals per replica between replica exchanges
+    float           m_TemperatureLadderFactor;  ///< ratio of the temperatures of neighbouring replicas
+    float           m_SwapAcceptance;       ///< replica exchange acceptance rate (0-1)
 
     FiberPolyDataType m_FiberPolyData;      ///< container for reconstructed fibers
 
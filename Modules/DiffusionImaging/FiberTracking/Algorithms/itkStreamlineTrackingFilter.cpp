@@ -17,6 +17,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <ctime>
 #include <cstdio>
 #include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <iterator>
 
 #include <omp.h>
 #include "itkStreamlineTrackingFilter.h"
@@ -81,6 +84,9 @@ StreamlineTrackingFilter
   , m_StopTracking(false)
   , m_InterpolateMasks(true)
   , m_TrialsPerSeed(10)
+  , m_SeedBatchSize(0)
+  , m_FiberStreamWriter(nullptr)
+  , m_StreamChunkSize(10000)
   , m_EndpointConstraint(EndpointConstraints::NONE)
   , m_IntroduceDirectionsFromPrior(true)
   , m_TrackingPriorAsMask(true)
@@ -96,9 +102,9 @@ std::string StreamlineTrackingFilter::GetStatusText()
   if (m_SeedPoints.size()>0)
     status += " (" + boost::lexical_cast<std::string>(100*m_Progress/m_SeedPoints.size()) + "%)";
   if (m_MaxNumTracts>0)
-    status += "\nFibers accepted: " + boost::lexical_cast<std::string>(m_CurrentTracts) + "/" + boost::lexical_cast<std::string>(m_MaxNumTracts);
+    status += "\nFibers accepted: " + boost::lexical_cast<std::string>(m_CurrentTracts.load()) + "/" + boost::lexical_cast<std::string>(m_MaxNumTracts);
   else
-    status += "\nFibers accepted: " + boost::lexical_cast<std::string>(m_CurrentTracts);
+    status += "\nFibers accepted: " + boost::lexical_cast<std::string>(m_CurrentTracts.load());
 
   return status;
 }
@@ -106,6 +112,7 @@ std::string StreamlineTrackingFilter::GetStatusText()
 void StreamlineTrackingFilter::BeforeTracking()
 {
   m_StopTracking = false;
+  m_StreamError.clear();
   m_TrackingHandler->SetRandom(m_Random);
   m_TrackingHandler->InitForTracking();
   m_FiberPolyData = PolyDataType::New();
@@ -384,103 +391,150 @@ vnl_vector_fixed<float,3> StreamlineTrackingFilter::GetNewDirection(const itk::P
   }
   vnl_vector_fixed<float,3> direction; direction.fill(0);
 
-  if (mitk::imv::IsInsideMask<float>(pos, m_InterpolateMasks, m_MaskInterpolator) && !mitk::imv::IsInsideMask<float>(pos, m_InterpolateMasks, m_StopInterpolator))
-    direction = m_TrackingHandler->ProposeDirection(pos, olddirs, oldIndex); // get direction proposal at current streamline position
-  else
+  if (!mitk::imv::IsInsideMask<float>(pos, m_InterpolateMasks, m_MaskInterpolator) || mitk::imv::IsInsideMask<float>(pos, m_InterpolateMasks, m_StopInterpolator))
     return direction;
 
+  // the direction proposals at the current position and at all neighborhood samples are requested from the tracking handler in one batch
+  struct NeighborhoodSample
+  {
+    unsigned int                i;
+    vnl_vector_fixed<float,3>   d;
+    itk::Point<float, 3>        pos;
+    bool                        is_stop_voter;
+    int                         alternative;    ///< point id of the alternative sample in the demo mode
+    int                         batch_index;    ///< index in the batch passed to the tracking handler, -1 if outside of the mask
+  };
+
+  std::vector< NeighborhoodSample > samples;
+  std::vector< itk::Point<float, 3> > batch_positions;
+  std::vector< vnl_vector_fixed<float,3> > batch_directions;
+  batch_positions.push_back(pos);
+
   int stop_votes = 0;
   int possible_stop_votes = 0;
+  vnl_vector_fixed<float,3> olddir; olddir.fill(0);
   if (!olddirs.empty())
   {
-    vnl_vector_fixed<float,3> olddir = olddirs.back();
+    olddir = olddirs.back();
     std::vector< vnl_vector_fixed<float,3> > probeVecs = CreateDirections(m_NumberOfSamples);
-    itk::Point<float, 3> sample_pos;
-    int alternatives = 1;
     for (unsigned int i=0; i<probeVecs.size(); i++)
     {
-      vnl_vector_fixed<float,3> d;
-      bool is_stop_voter = false;
+      NeighborhoodSample s;
+      s.i = i;
+      s.is_stop_voter = false;
+      s.alternative = 0;
       if (m_Random && m_RandomSampling)
       {
-        d[0] = m_TrackingHandler->GetRandDouble(-0.5, 0.5);
-        d[1] = m_TrackingHandler->GetRandDouble(-0.5, 0.5);
-        d[2] = m_TrackingHandler->GetRandDouble(-0.5, 0.5);
-        d.normalize();
-        d *= m_TrackingHandler->GetRandDouble(0,m_SamplingDistance);
+        s.d[0] = m_TrackingHandler->GetRandDouble(-0.5, 0.5);
+        s.d[1] = m_TrackingHandler->GetRandDouble(-0.5, 0.5);
+        s.d[2] = m_TrackingHandler->GetRandDouble(-0.5, 0.5);
+        s.d.normalize();
+        s.d *= m_TrackingHandler->GetRandDouble(0,m_SamplingDistance);
       }
       else
       {
-        d = probeVecs.at(i);
-        float dot = dot_product(d, olddir);
+        s.d = probeVecs.at(i);
+        float dot = dot_product(s.d, olddir);
         if (m_UseStopVotes && dot>0.7)
         {
-          is_stop_voter = true;
+          s.is_stop_voter = true;
           possible_stop_votes++;
         }
         else if (m_OnlyForwardSamples && dot<0)
           continue;
-        d *= m_SamplingDistance;
+        s.d *= m_SamplingDistance;
       }
 
-      sample_pos[0] = pos[0] + d[0];
-      sample_pos[1] = pos[1] + d[1];
-      sample_pos[2] = pos[2] + d[2];
+      s.pos[0] = pos[0] + s.d[0];
+      s.pos[1] = pos[1] + s.d[1];
+      s.pos[2] = pos[2] + s.d[2];
 
-      vnl_vector_fixed<float,3> tempDir; tempDir.fill(0.0);
-      if (mitk::imv::IsInsideMask<float>(sample_pos, m_InterpolateMasks, m_MaskInterpolator))
-        tempDir = m_TrackingHandler->ProposeDirection(sample_pos, olddirs, oldIndex); // sample neighborhood
-      if (tempDir.magnitude()>mitk::eps)
+      s.batch_index = -1;
+      if (mitk::imv::IsInsideMask<float>(s.pos, m_InterpolateMasks, m_MaskInterpolator))
       {
-        direction += tempDir;
-
-        if(m_DemoMode)
-          m_SamplingPointset->InsertPoint(i, sample_pos);
+        s.batch_index = static_cast<int>(batch_positions.size());
+        batch_positions.push_back(s.pos);
       }
-      else if (m_AvoidStop && olddir.magnitude()>0.5) // out of white matter
-      {
-        if (is_stop_voter)
-          stop_votes++;
-        if (m_DemoMode)
-          m_StopVotePointset->InsertPoint(i, sample_pos);
-
-        float dot = dot_product(d, olddir);
-        if (dot >= 0.0) // in front of plane defined by pos and olddir
-          d = -d + 2*dot*olddir; // reflect
-        else
-          d = -d; // invert
-
-        // look a bit further into the other direction
-        sample_pos[0] = pos[0] + d[0];
-        sample_pos[1] = pos[1] + d[1];
-        sample_pos[2] = pos[2] + d[2];
-        alternatives++;
-        vnl_vector_fixed<float,3> tempDir; tempDir.fill(0.0);
-        if (mitk::imv::IsInsideMask<float>(sample_pos, m_InterpolateMasks, m_MaskInterpolator))
-          tempDir = m_TrackingHandler->ProposeDirection(sample_pos, olddirs, oldIndex); // sample neighborhood
-
-        if (tempDir.magnitude()>mitk::eps)  // are we back in the white matter?
-        {
-          direction += d * m_DeflectionMod;         // go into the direction of the white matter
-          direction += tempDir;  // go into the direction of the white matter direction at this location
+      samples.push_back(s);
+    }
+  }
 
-          if(m_DemoMode)
-            m_AlternativePointset->InsertPoint(alternatives, sample_pos);
-        }
-        else
-        {
-          if (m_DemoMode)
-            m_StopVotePointset->InsertPoint(i, sample_pos);
-        }
-      }
+  m_TrackingHandler->ProposeDirections(batch_positions, olddirs, oldIndex, batch_directions);
+  direction = batch_directions.at(0); // direction proposal at current streamline position
+
+  // samples that did not hit the white matter look a bit further into the other direction
+  std::vector< NeighborhoodSample > alternative_samples;
+  batch_positions.clear();
+  int alternatives = 1;
+  for (auto& s : samples)
+  {
+    vnl_vector_fixed<float,3> tempDir; tempDir.fill(0.0);
+    if (s.batch_index>=0)
+      tempDir = batch_directions.at(s.batch_index);
+    if (tempDir.magnitude()>mitk::eps)
+    {
+      direction += tempDir;
+
+      if(m_DemoMode)
+        m_SamplingPointset->InsertPoint(s.i, s.pos);
+    }
+    else if (m_AvoidStop && olddir.magnitude()>0.5) // out of white matter
+    {
+      if (s.is_stop_voter)
+        stop_votes++;
+      if (m_DemoMode)
+        m_StopVotePointset->InsertPoint(s.i, s.pos);
+
+      NeighborhoodSample a = s;
+      float dot = dot_product(s.d, olddir);
+      if (dot >= 0.0) // in front of plane defined by pos and olddir
+        a.d = -s.d + 2*dot*olddir; // reflect
       else
+        a.d = -s.d; // invert
+
+      a.pos[0] = pos[0] + a.d[0];
+      a.pos[1] = pos[1] + a.d[1];
+      a.pos[2] = pos[2] + a.d[2];
+      alternatives++;
+      a.alternative = alternatives;
+      a.batch_index = -1;
+      if (mitk::imv::IsInsideMask<float>(a.pos, m_InterpolateMasks, m_MaskInterpolator))
       {
-        if (m_DemoMode)
-          m_StopVotePointset->InsertPoint(i, sample_pos);
-
-        if (is_stop_voter)
-          stop_votes++;
+        a.batch_index = static_cast<int>(batch_positions.size());
+        batch_positions.push_back(a.pos);
       }
+      alternative_samples.push_back(a);
+    }
+    else
+    {
+      if (m_DemoMode)
+        m_StopVotePointset->InsertPoint(s.i, s.pos);
+
+      if (s.is_stop_voter)
+        stop_votes++;
+    }
+  }
+
+  if (!batch_positions.empty())
+    m_TrackingHandler->ProposeDirections(batch_positions, olddirs, oldIndex, batch_directions);
+  for (auto& a : alternative_samples)
+  {
+    vnl_vector_fixed<float,3> tempDir; tempDir.fill(0.0);
+    if (a.batch_index>=0)
+      tempDir = batch_directions.at(a.batch_index);
+
+    if (tempDir.magnitude()>mitk::eps)  // are we back in the white matter?
+    {
+      direction += a.d * m_DeflectionMod;         // go into the direction of the white matter
+      direction += tempDir;  // go into the direction of the white matter direction at this location
+
+      if(m_DemoMode)
+        m_AlternativePointset->InsertPoint(a.alternative, a.pos);
+    }
+    else
+    {
+      if (m_DemoMode)
+        m_StopVotePointset->InsertPoint(a.i, a.pos);
     }
   }
 
@@ -693,103 +747,202 @@ void StreamlineTrackingFilter::GenerateData()
   int num_seeds = m_SeedPoints.size();
   itk::Index<3> zeroIndex; zeroIndex.Fill(0);
   m_Progress = 0;
-  int i = 0;
   int print_interval = num_seeds/100;
   if (print_interval<100)
     m_Verbose=false;
 
+  // Seeds are handed out in batches through an atomic counter, so fast threads simply grab the next batch
+  // instead of waiting for a static partition. Accepted fibers go into per-thread buffers that are merged
+  // after the parallel region, which removes the critical section from the hot path.
+  const int num_threads = omp_get_max_threads();
+  int batch_size = static_cast<int>(m_SeedBatchSize);
+  if (batch_size<=0)
+    batch_size = std::max(1, std::min(256, num_seeds/(64*num_threads)));
+
+  std::atomic<int> next_seed(0);
+  std::vector< BundleType > thread_tractograms(num_threads);
+  std::vector< unsigned int > thread_tracts(num_threads, 0);
+  std::vector< unsigned int > thread_seeds(num_threads, 0);
+  std::vector< double > thread_seconds(num_threads, 0);
+
 #pragma omp parallel
-  while (i<num_seeds && !m_StopTracking)
   {
-    int temp_i = 0;
-#pragma omp critical
-    {
-      temp_i = i;
-      i++;
-    }
+    const int thread_id = omp_get_thread_num();
+    // in demo mode only one thread is tracking and the visualization needs the accepted fibers right away
+    BundleType& tractogram = m_DemoMode ? m_Tractogram : thread_tractograms.at(thread_id);
+    auto thread_start = std::chrono::steady_clock::now();
 
-    if (temp_i>=num_seeds || m_StopTracking)
-      continue;
-    else if (m_Verbose && i%print_interval==0)
-#pragma omp critical
+    while (!m_StopTracking)
     {
-      m_Progress += print_interval;
-      std::cout << "                                                                                                     \r";
-      if (m_MaxNumTracts>0)
-        std::cout << "Tried: " << m_Progress << "/" << num_seeds << " | Accepted: " << m_CurrentTracts << "/" << m_MaxNumTracts << '\r';
-      else
-        std::cout << "Tried: " << m_Progress << "/" << num_seeds << " | Accepted: " << m_CurrentTracts << '\r';
-      cout.flush();
-    }
+      const int batch_start = next_seed.fetch_add(batch_size);
+      if (batch_start>=num_seeds)
+        break;
+      const int batch_end = std::min(batch_start+batch_size, num_seeds);
 
-    const itk::Point<float> worldPos = m_SeedPoints.at(temp_i);
-
-    for (unsigned int trials=0; trials<m_TrialsPerSeed; ++trials)
-    {
-      FiberType fib;
-      DirectionContainer direction_container;
-      float tractLength = 0;
-      unsigned int counter = 0;
-
-      // get starting direction
-      vnl_vector_fixed<float,3> dir; dir.fill(0.0);
-      std::deque< vnl_vector_fixed<float,3> > olddirs;
-      dir = GetNewDirection(worldPos, olddirs, zeroIndex) * 0.5f;
-
-      bool exclude = false;
-      if (m_ExclusionRegions.IsNotNull() && mitk::imv::IsInsideMask<float>(worldPos, m_InterpolateMasks, m_ExclusionInterpolator))
-        exclude = true;
-
-      bool success = false;
-      if (dir.magnitude()>0.0001 && !exclude)
+      if (m_Verbose && batch_start/print_interval != batch_end/print_interval)
+#pragma omp critical
       {
-        // forward tracking
-        tractLength = FollowStreamline(worldPos, dir, &fib, &direction_container, 0, false, exclude);
-        fib.push_front(worldPos);
-
-        // backward tracking
-        if (!exclude)
-          tractLength = FollowStreamline(worldPos, -dir, &fib, &direction_container, tractLength, true, exclude);
+        m_Progress = batch_end;
+        std::cout << "                                                                                                     \r";
+        if (m_MaxNumTracts>0)
+          std::cout << "Tried: " << m_Progress << "/" << num_seeds << " | Accepted: " << m_CurrentTracts << "/" << m_MaxNumTracts << '\r';
+        else
+          std::cout << "Tried: " << m_Progress << "/" << num_seeds << " | Accepted: " << m_CurrentTracts << '\r';
+        cout.flush();
+      }
 
-        counter = fib.size();
+      for (int temp_i=batch_start; temp_i<batch_end && !m_StopTracking; ++temp_i)
+      {
+        const itk::Point<float> worldPos = m_SeedPoints.at(temp_i);
+        thread_seeds[thread_id]++;
 
-        if (tractLength>=m_MinTractLength && counter>=2 && !exclude)
+        for (unsigned int trials=0; trials<m_TrialsPerSeed; ++trials)
         {
-#pragma omp critical
-          if ( IsValidFiber(&fib) )
+          FiberType fib;
+          DirectionContainer direction_container;
+          float tractLength = 0;
+          unsigned int counter = 0;
+
+          // get starting direction
+          vnl_vector_fixed<float,3> dir; dir.fill(0.0);
+          std::deque< vnl_vector_fixed<float,3> > olddirs;
+          dir = GetNewDirection(worldPos, olddirs, zeroIndex) * 0.5f;
+
+          bool exclude = false;
+          if (m_ExclusionRegions.IsNotNull() && mitk::imv::IsInsideMask<float>(worldPos, m_InterpolateMasks, m_ExclusionInterpolator))
+            exclude = true;
+
+          bool success = false;
+          if (dir.magnitude()>0.0001 && !exclude)
           {
-            if (!m_StopTracking)
+            // forward tracking
+            tractLength = FollowStreamline(worldPos, dir, &fib, &direction_container, 0, false, exclude);
+            fib.push_front(worldPos);
+
+            // backward tracking
+            if (!exclude)
+              tractLength = FollowStreamline(worldPos, -dir, &fib, &direction_container, tractLength, true, exclude);
+
+            counter = fib.size();
+
+            if (tractLength>=m_MinTractLength && counter>=2 && !exclude && IsValidFiber(&fib) && !m_StopTracking)
             {
-              if (!m_UseOutputProbabilityMap)
-                m_Tractogram.push_back(fib);
+              // reserve a slot in the global count first so that the maximum number of tracts is never exceeded
+              const unsigned int tract_number = ++m_CurrentTracts;
+              if (m_MaxNumTracts <= 0 || tract_number<=static_cast<unsigned int>(m_MaxNumTracts))
+              {
+                if (!m_UseOutputProbabilityMap)
+                {
+                  tractogram.push_back(fib);
+                  if (m_FiberStreamWriter!=nullptr && !m_DemoMode && tractogram.size()>=m_StreamChunkSize)
+                  {
+#pragma omp critical (StreamlineTrackingFilterStream)
+                    WriteToStream(tractogram);
+                  }
+                }
+                else
+                {
+#pragma omp critical
+                  FiberToProbmap(&fib);
+                }
+                thread_tracts[thread_id]++;
+                success = true;
+              }
               else
-                FiberToProbmap(&fib);
-              m_CurrentTracts++;
-              success = true;
-            }
-            if (m_MaxNumTracts > 0 && m_CurrentTracts>=static_cast<unsigned int>(m_MaxNumTracts))
-            {
-              if (!m_StopTracking)
+                --m_CurrentTracts;
+
+              if (m_MaxNumTracts > 0 && tract_number==static_cast<unsigned int>(m_MaxNumTracts))
               {
                 std::cout << "                                                                                                     \r";
-                MITK_INFO << "Reconstructed maximum number of tracts (" << m_CurrentTracts << "). Stopping tractography.";
+                MITK_INFO << "Reconstructed maximum number of tracts (" << tract_number << "). Stopping tractography.";
+                m_StopTracking = true;
               }
-              m_StopTracking = true;
             }
           }
-        }
-      }
 
-      if (success || m_TrackingHandler->GetMode()!=mitk::TrackingDataHandler::PROBABILISTIC)
-        break;  // we only try one seed point multiple times if we use a probabilistic tracker and have not found a valid streamline yet
+          if (success || m_TrackingHandler->GetMode()!=mitk::TrackingDataHandler::PROBABILISTIC)
+            break;  // we only try one seed point multiple times if we use a probabilistic tracker and have not found a valid streamline yet
 
-    }// trials per seed
+        }// trials per seed
+      }// seed points of batch
+    }// batches
 
-  }// seed points
+    thread_seconds[thread_id] = std::chrono::duration<double>(std::chrono::steady_clock::now() - thread_start).count();
+  }
+
+  if (m_FiberStreamWriter!=nullptr && !m_DemoMode)
+  {
+    for (auto& t : thread_tractograms)
+      WriteToStream(t);
+    if (!m_StreamError.empty())
+      mitkThrow() << "Writing streamlines failed: " << m_StreamError;
+  }
+  else if (!m_DemoMode)
+  {
+    std::size_t num_fibers = m_Tractogram.size();
+    for (auto& t : thread_tractograms)
+      num_fibers += t.size();
+    m_Tractogram.reserve(num_fibers);
+    for (auto& t : thread_tractograms)
+    {
+      std::move(t.begin(), t.end(), std::back_inserter(m_Tractogram));
+      BundleType().swap(t);
+    }
+  }
+  m_Progress = std::min(next_seed.load(), num_seeds);
+
+  std::chrono::duration<double> total_seconds = std::chrono::system_clock::now() - m_StartTime;
+  unsigned int active_threads = 0;
+  for (int t=0; t<num_threads; ++t)
+  {
+    if (thread_seeds[t]==0)
+      continue;
+    ++active_threads;
+    if (m_Verbose)
+      MITK_INFO << "Thread " << t << ": " << thread_seeds[t] << " seeds, " << thread_tracts[t] << " streamlines, "
+                << (thread_seconds[t]>0 ? thread_tracts[t]/thread_seconds[t] : 0) << " streamlines/s";
+  }
+  MITK_INFO << "Tracking throughput: " << (total_seconds.count()>0 ? m_CurrentTracts/total_seconds.count() : 0)
+            << " streamlines/s on " << active_threads << " threads (seed batch size " << batch_size << ")";
 
   this->AfterTracking();
 }
 
+void StreamlineTrackingFilter::WriteToStream(BundleType& fibers)
+{
+  if (!m_StreamError.empty())
+  {
+    fibers.clear();
+    return;
+  }
+
+  mitk::FiberPointBuffer buffer;
+  std::vector< float > points;
+  for (const auto& fib : fibers)
+  {
+    points.clear();
+    for (const auto& p : fib)
+    {
+      points.push_back(p[0]);
+      points.push_back(p[1]);
+      points.push_back(p[2]);
+    }
+    buffer.AddFiber(points);
+  }
+  fibers.clear();
+
+  // exceptions must not leave the parallel region
+  try
+  {
+    m_FiberStreamWriter->Write(buffer);
+  }
+  catch (const std::exception& e)
+  {
+    m_StreamError = e.what();
+    m_StopTracking = true;
+  }
+}
+
 bool StreamlineTrackingFilter::IsValidFiber(FiberType* fib)
 {
   if (m_EndpointConstraint==EndpointConstraints::NONE)
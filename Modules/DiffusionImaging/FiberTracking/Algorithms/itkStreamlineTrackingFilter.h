@@ -33,9 +33,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkDiffusionPropertyHelper.h>
 #include <mitkPointSet.h>
 #include <chrono>
+#include <atomic>
 #include <TrackingHandlers/mitkTrackingDataHandler.h>
 #include <MitkFiberTrackingExports.h>
 #include <mitkFiberBundle.h>
+#include <mitkFiberBundleStreamWriter.h>
 #include <mitkPeakImage.h>
 
 namespace itk{
@@ -130,6 +132,7 @@ public:
   itkSetMacro( StopTracking, bool )
   itkSetMacro( InterpolateMasks, bool )
   itkSetMacro( TrialsPerSeed, unsigned int )          ///< When using probabilistic tractography, each seed point is used N times until a valid streamline that is compliant with all thresholds etc. is found
+  itkSetMacro( SeedBatchSize, unsigned int )          ///< Number of seed points a thread claims at once. 0 chooses the batch size automatically.
   itkSetMacro( TrackingPriorWeight, float)            ///< Weight between prior and data [0-1]. One mean tracking only on the prior peaks, zero only on the data.
   itkSetMacro( TrackingPriorAsMask, bool)             ///< If true, data directions in voxels where prior directions are invalid are set to zero
   itkSetMacro( IntroduceDirectionsFromPrior, bool)    ///< If false, prior voxels with invalid data voxel are ignored
@@ -139,6 +142,14 @@ public:
     m_SeedPoints = sP;
   }
 
+  /** If set, accepted streamlines are written to the (opened) writer in chunks during tracking instead of being
+   * collected in memory. The output polydata is empty in this case. The writer is not closed by the filter. */
+  void SetFiberStreamWriter( mitk::FiberBundleStreamWriter* writer )
+  {
+    m_FiberStreamWriter = writer;
+  }
+  itkSetMacro( StreamChunkSize, unsigned int )        ///< Number of streamlines a thread collects before writing them to the stream writer
+
   void SetTrackingHandler( mitk::TrackingDataHandler* h )   ///<
   {
     m_TrackingHandler = h;
@@ -212,14 +223,19 @@ protected:
   bool                                m_Random;
   bool                                m_UseOutputProbabilityMap;
   std::vector< itk::Point<float> >    m_SeedPoints;
-  unsigned int                        m_CurrentTracts;
+  std::atomic<unsigned int>           m_CurrentTracts;
   unsigned int                        m_Progress;
   bool                                m_StopTracking;
   bool                                m_InterpolateMasks;
   unsigned int                        m_TrialsPerSeed;
+  unsigned int                        m_SeedBatchSize;
+  mitk::FiberBundleStreamWriter*      m_FiberStreamWriter;
+  unsigned int                        m_StreamChunkSize;
+  std::string                         m_StreamError;
   EndpointConstraints                 m_EndpointConstraint;
 
   void BuildFibers(bool check);
+  void WriteToStream(BundleType& fibers);   ///< Writes and clears the given fibers, not thread safe
   float CheckCurvature(DirectionContainer *fib, bool front);
 
   // decision forest
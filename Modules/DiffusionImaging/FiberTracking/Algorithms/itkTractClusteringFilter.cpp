@@ -19,6 +19,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <math.h>
 #include <boost/progress.hpp>
 #include <vnl/vnl_sparse_matrix.h>
+#include <mitkClusteringMetricEuclideanMean.h>
+#include <mitkClusteringMetricEuclideanMax.h>
+#include <mitkClusteringMetricEuclideanStd.h>
+#include <typeinfo>
+#include <algorithm>
+#include <cmath>
 
 namespace itk{
 
@@ -31,6 +37,8 @@ TractClusteringFilter::TractClusteringFilter()
   , m_DoResampling(true)
   , m_FilterMask(nullptr)
   , m_OverlapThreshold(0.0)
+  , m_FastMetric(EUCLIDEAN::NONE)
+  , m_FastMetricScale(1.0)
 {
 
 }
@@ -131,7 +139,160 @@ std::vector<vnl_matrix<float> > TractClusteringFilter::ResampleFibers(mitk::Fibe
   return out_fib;
 }
 
-std::vector< TractClusteringFilter::Cluster > TractClusteringFilter::ClusterStep(std::vector< long > f_indices, std::vector<float> distances)
+void TractClusteringFilter::InitFastMetric()
+{
+  m_FastMetric = EUCLIDEAN::NONE;
+  if (m_Metrics.size()!=1)
+    return;
+
+  mitk::ClusteringMetric* m = m_Metrics.at(0);
+  if (typeid(*m)==typeid(mitk::ClusteringMetricEuclideanMean))
+    m_FastMetric = EUCLIDEAN::MEAN;
+  else if (typeid(*m)==typeid(mitk::ClusteringMetricEuclideanMax))
+    m_FastMetric = EUCLIDEAN::MAX;
+  else if (typeid(*m)==typeid(mitk::ClusteringMetricEuclideanStd))
+    m_FastMetric = EUCLIDEAN::STD;
+  m_FastMetricScale = m->GetScale();
+}
+
+void TractClusteringFilter::PackFiber(const vnl_matrix<float>& t, float* packed, float* packed_flipped) const
+{
+  const unsigned int P = m_NumPoints;
+  for (unsigned int d=0; d<3; ++d)
+    for (unsigned int j=0; j<P; ++j)
+    {
+      packed[d*P + j] = t.get(d, j);
+      packed_flipped[d*P + j] = t.get(d, P-j-1);
+    }
+}
+
+void TractClusteringFilter::PackCentroid(const vnl_matrix<float>& h, int n, float* packed) const
+{
+  const unsigned int P = m_NumPoints;
+  for (unsigned int d=0; d<3; ++d)
+    for (unsigned int j=0; j<P; ++j)
+      packed[d*P + j] = h.get(d, j)/n;
+}
+
+float TractClusteringFilter::FastEuclideanDistance(const float* fiber, const float* fiber_flipped, const float* centroid, float bound, bool& flipped) const
+{
+  const unsigned int P = m_NumPoints;
+  const float* cx = centroid;
+  const float* cy = centroid + P;
+  const float* cz = centroid + 2*P;
+  const float* fx = fiber;
+  const float* fy = fiber + P;
+  const float* fz = fiber + 2*P;
+  const float* rx = fiber_flipped;
+  const float* ry = fiber_flipped + P;
+  const float* rz = fiber_flipped + 2*P;
+
+  float sum_d = 0;
+  float sum_f = 0;
+  float max_d = 0;
+  float max_f = 0;
+
+  // accumulate in blocks of points and stop as soon as neither orientation can get below the bound
+  const unsigned int block = 8;
+  for (unsigned int b=0; b<P; b+=block)
+  {
+    const unsigned int e = std::min(b+block, P);
+    for (unsigned int j=b; j<e; ++j)
+    {
+      float dd = std::sqrt((fx[j]-cx[j])*(fx[j]-cx[j]) + (fy[j]-cy[j])*(fy[j]-cy[j]) + (fz[j]-cz[j])*(fz[j]-cz[j]));
+      float df = std::sqrt((rx[j]-cx[j])*(rx[j]-cx[j]) + (ry[j]-cy[j])*(ry[j]-cy[j]) + (rz[j]-cz[j])*(rz[j]-cz[j]));
+      sum_d += dd;
+      sum_f += df;
+      max_d = dd>max_d ? dd : max_d;
+      max_f = df>max_f ? df : max_f;
+    }
+
+    float lower_bound = 0;
+    switch (m_FastMetric)
+    {
+    case EUCLIDEAN::MEAN:
+      lower_bound = m_FastMetricScale*std::min(sum_d, sum_f)/P;
+      break;
+    case EUCLIDEAN::MAX:
+      lower_bound = m_FastMetricScale*std::min(max_d, max_f);
+      break;
+    default:  // mean + deviation >= mean
+      lower_bound = m_FastMetricScale*std::min(sum_d, sum_f)/P/2;
+    }
+    if (lower_bound>=bound)
+      return lower_bound;
+  }
+
+  // same orientation choice as the ClusteringMetricEuclidean* classes
+  flipped = sum_d>sum_f;
+  const float* px = flipped ? rx : fx;
+  const float* py = flipped ? ry : fy;
+  const float* pz = flipped ? rz : fz;
+  switch (m_FastMetric)
+  {
+  case EUCLIDEAN::MEAN:
+    return m_FastMetricScale*(flipped ? sum_f : sum_d)/P;
+  case EUCLIDEAN::MAX:
+    return m_FastMetricScale*(flipped ? max_f : max_d);
+  default:
+  {
+    float mean = (flipped ? sum_f : sum_d)/P;
+    float dev = 0;
+    for (unsigned int j=0; j<P; ++j)
+    {
+      float dist = std::sqrt((px[j]-cx[j])*(px[j]-cx[j]) + (py[j]-cy[j])*(py[j]-cy[j]) + (pz[j]-cz[j])*(pz[j]-cz[j])) - mean;
+      dev += dist*dist;
+    }
+    return m_FastMetricScale*(mean + std::sqrt(dev))/2;
+  }
+  }
+}
+
+int TractClusteringFilter::FindClosestCentroid(const float* fiber, const float* fiber_flipped, const std::vector< float >& centroids, int num_centroids, float threshold, float& distance, bool& flipped, bool parallel) const
+{
+  const unsigned int stride = 3*m_NumPoints;
+  int best_index = -1;
+  float best_distance = threshold;
+  bool best_flipped = false;
+
+  // every thread searches a contiguous block of centroids. ties are resolved towards the smaller index,
+  // so the result does not depend on the number of threads.
+#pragma omp parallel if (parallel && num_centroids>=256)
+  {
+    int t_index = -1;
+    float t_distance = threshold;
+    bool t_flipped = false;
+
+#pragma omp for schedule(static)
+    for (int k=0; k<num_centroids; ++k)
+    {
+      bool f = false;
+      float d = FastEuclideanDistance(fiber, fiber_flipped, &centroids[k*stride], t_distance, f);
+      if (d<t_distance)
+      {
+        t_distance = d;
+        t_index = k;
+        t_flipped = f;
+      }
+    }
+
+#pragma omp critical (TractClusteringFilterClosest)
+    {
+      if (t_index>=0 && (best_index<0 || t_distance<best_distance || (t_distance==best_distance && t_index<best_index)))
+      {
+        best_distance = t_distance;
+        best_index = t_index;
+        best_flipped = t_flipped;
+      }
+    }
+  }
+
+  distance = best_distance;
+  flipped = best_flipped;
+  return best_index;
+}
+
+std::vector< TractClusteringFilter::Cluster > TractClusteringFilter::ClusterStep(std::vector< long > f_indices, std::vector<float> distances, bool parallel)
 {
   float dist_thres = distances.back();
   distances.pop_back();
@@ -147,28 +308,47 @@ std::vector< TractClusteringFilter::Cluster > TractClusteringFilter::ClusterStep
   if (f_indices.size()==1)
     return C;
 
+  const bool fast = m_FastMetric!=EUCLIDEAN::NONE;
+  const unsigned int stride = 3*m_NumPoints;
+  std::vector< float > centroids;
+  std::vector< float > fiber(stride);
+  std::vector< float > fiber_flipped(stride);
+  if (fast)
+  {
+    centroids.resize(stride);
+    PackCentroid(c1.h, c1.n, centroids.data());
+  }
+
   for (int i=1; i<N; ++i)
   {
-    vnl_matrix<float> t = T.at(f_indices.at(i));
+    vnl_matrix<float>& t = T.at(f_indices.at(i));
 
     int min_cluster_index = -1;
     float min_cluster_distance = 99999;
     bool flip = false;
 
-    for (unsigned int k=0; k<C.size(); ++k)
+    if (fast)
     {
-      vnl_matrix<float> v = C.at(k).h / C.at(k).n;
-      bool f = false;
-      float d = 0;
-      for (auto m : m_Metrics)
-        d += m->CalculateDistance(t, v, f);
-      d /= m_Metrics.size();
-
-      if (d<min_cluster_distance)
+      PackFiber(t, fiber.data(), fiber_flipped.data());
+      min_cluster_index = FindClosestCentroid(fiber.data(), fiber_flipped.data(), centroids, C.size(), dist_thres, min_cluster_distance, flip, parallel);
+    }
+    else
+    {
+      for (unsigned int k=0; k<C.size(); ++k)
       {
-        min_cluster_distance = d;
-        min_cluster_index = k;
-        flip = f;
+        vnl_matrix<float> v = C.at(k).h / C.at(k).n;
+        bool f = false;
+        float d = 0;
+        for (auto m : m_Metrics)
+          d += m->CalculateDistance(t, v, f);
+        d /= m_Metrics.size();
+
+        if (d<min_cluster_distance)
+        {
+          min_cluster_distance = d;
+          min_cluster_index = k;
+          flip = f;
+        }
       }
     }
 
@@ -180,6 +360,8 @@ std::vector< TractClusteringFilter::Cluster > TractClusteringFilter::ClusterStep
       else
         C[min_cluster_index].h += t.fliplr();
       C[min_cluster_index].n += 1;
+      if (fast)
+        PackCentroid(C[min_cluster_index].h, C[min_cluster_index].n, &centroids[min_cluster_index*stride]);
     }
     else
     {
@@ -188,19 +370,22 @@ std::vector< TractClusteringFilter::Cluster > TractClusteringFilter::ClusterStep
       c.h = t;
       c.n = 1;
       C.push_back(c);
+      if (fast)
+        centroids.insert(centroids.end(), fiber.begin(), fiber.end());
     }
   }
 
   if (!distances.empty())
   {
-    std::vector< Cluster > outC;
-//#pragma omp parallel for
+    // the clusters are refined independently, the results are concatenated in cluster order
+    std::vector< std::vector< Cluster > > subclusters(C.size());
+#pragma omp parallel for schedule(dynamic) if (parallel)
     for (int c=0; c<(int)C.size(); c++)
-    {
+      subclusters[c] = ClusterStep(C.at(c).I, distances, false);
 
-      std::vector< Cluster > tempC = ClusterStep(C.at(c).I, distances);
+    std::vector< Cluster > outC;
+    for (auto& tempC : subclusters)
       AppendCluster(outC, tempC);
-    }
     return outC;
   }
   else
@@ -305,55 +490,86 @@ std::vector<TractClusteringFilter::Cluster> TractClusteringFilter::AddToKnownClu
     C.push_back(c);
   }
 
-#pragma omp parallel for
-  for (int i=0; i<N; ++i)
+  const bool fast = m_FastMetric!=EUCLIDEAN::NONE;
+  const unsigned int stride = 3*m_NumPoints;
+  std::vector< float > packed_centroids;
+  if (fast)
   {
-    vnl_matrix<float> t = T.at(f_indices.at(i));
+    packed_centroids.resize(centroids.size()*stride);
+    for (unsigned int i=0; i<centroids.size(); ++i)
+      PackCentroid(centroids.at(i), 1, &packed_centroids[i*stride]);
+  }
 
-    int min_cluster_index = -1;
-    float min_cluster_distance = 99999;
-    bool flip = false;
+  // the centroids are fixed, so all fibers can be assigned in parallel. the clusters are filled afterwards
+  // in fiber order, which keeps the output independent of the thread scheduling.
+  std::vector< int > assignment(N, -1);
+  std::vector< char > flipped(N, 0);
+#pragma omp parallel
+  {
+    std::vector< float > fiber(stride);
+    std::vector< float > fiber_flipped(stride);
 
-    if (CalcOverlap(t)>=m_OverlapThreshold)
+#pragma omp for schedule(dynamic, 64)
+    for (int i=0; i<N; ++i)
     {
-      int c_idx = 0;
-      for (vnl_matrix<float> centroid : centroids)
-      {
-        bool f = false;
-        float d = 0;
-        for (auto m : m_Metrics)
-          d += m->CalculateDistance(t, centroid, f);
-        d /= m_Metrics.size();
+      vnl_matrix<float>& t = T.at(f_indices.at(i));
 
-        if (d<min_cluster_distance)
+      int min_cluster_index = -1;
+      float min_cluster_distance = 99999;
+      bool flip = false;
+
+      if (CalcOverlap(t)>=m_OverlapThreshold)
+      {
+        if (fast)
         {
-          min_cluster_distance = d;
-          min_cluster_index = c_idx;
-          flip = f;
+          PackFiber(t, fiber.data(), fiber_flipped.data());
+          min_cluster_index = FindClosestCentroid(fiber.data(), fiber_flipped.data(), packed_centroids, centroids.size(), dist_thres, min_cluster_distance, flip, false);
+        }
+        else
+        {
+          for (unsigned int c_idx=0; c_idx<centroids.size(); ++c_idx)
+          {
+            bool f = false;
+            float d = 0;
+            for (auto m : m_Metrics)
+              d += m->CalculateDistance(t, centroids[c_idx], f);
+            d /= m_Metrics.size();
+
+            if (d<min_cluster_distance)
+            {
+              min_cluster_distance = d;
+              min_cluster_index = c_idx;
+              flip = f;
+            }
+          }
         }
-        ++c_idx;
       }
-    }
 
-    if (min_cluster_index>=0 && min_cluster_distance<dist_thres)
-    {
-#pragma omp critical
+      if (min_cluster_index>=0 && min_cluster_distance<dist_thres)
       {
-        C[min_cluster_index].I.push_back(f_indices.at(i));
-        if (!flip)
-          C[min_cluster_index].h += t;
-        else
-          C[min_cluster_index].h += t.fliplr();
-        C[min_cluster_index].n += 1;
+        assignment[i] = min_cluster_index;
+        flipped[i] = flip;
       }
     }
+  }
+
+  for (int i=0; i<N; ++i)
+  {
+    vnl_matrix<float>& t = T.at(f_indices.at(i));
+    int k = assignment[i];
+    if (k>=0)
+    {
+      C[k].I.push_back(f_indices.at(i));
+      if (!flipped[i])
+        C[k].h += t;
+      else
+        C[k].h += t.fliplr();
+      C[k].n += 1;
+    }
     else
     {
-#pragma omp critical
-      {
-        no_fit.I.push_back(f_indices.at(i));
-        no_fit.n++;
-      }
+      no_fit.I.push_back(f_indices.at(i));
+      no_fit.n++;
     }
   }
   C.push_back(no_fit);
@@ -374,6 +590,7 @@ void TractClusteringFilter::GenerateData()
     return;
   }
 
+  InitFastMetric();
   T = ResampleFibers(m_Tractogram);
   if (T.empty())
   {
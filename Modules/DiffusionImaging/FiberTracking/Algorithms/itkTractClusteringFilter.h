@@ -104,12 +104,21 @@ protected:
   std::vector< vnl_matrix<float> > ResampleFibers(FiberBundle::Pointer tractogram);
   float CalcOverlap(vnl_matrix<float>& t);
 
-  std::vector< Cluster > ClusterStep(std::vector< long > f_indices, std::vector< float > distances);
+  std::vector< Cluster > ClusterStep(std::vector< long > f_indices, std::vector< float > distances, bool parallel=true);
 
   void MergeDuplicateClusters(std::vector< TractClusteringFilter::Cluster >& clusters);
   std::vector< Cluster > AddToKnownClusters(std::vector< long > f_indices, std::vector<vnl_matrix<float> > &centroids);
   void AppendCluster(std::vector< Cluster >& a, std::vector< Cluster >&b);
 
+  // fast path for a single euclidean metric. fibers and centroids are packed as x, y and z of all points
+  // (3*m_NumPoints floats) so that distances can be evaluated in tight, vectorizable loops.
+  enum class EUCLIDEAN { NONE, MEAN, MAX, STD };
+  void InitFastMetric();
+  void PackFiber(const vnl_matrix<float>& t, float* packed, float* packed_flipped) const;
+  void PackCentroid(const vnl_matrix<float>& h, int n, float* packed) const;
+  float FastEuclideanDistance(const float* fiber, const float* fiber_flipped, const float* centroid, float bound, bool& flipped) const; ///< Returns a lower bound >= bound if the distance exceeds bound
+  int FindClosestCentroid(const float* fiber, const float* fiber_flipped, const std::vector< float >& centroids, int num_centroids, float threshold, float& distance, bool& flipped, bool parallel) const; ///< Index of the closest centroid with distance < threshold or -1
+
   TractClusteringFilter();
   virtual ~TractClusteringFilter();
 
@@ -129,6 +138,8 @@ protected:
   float                                       m_OverlapThreshold;
   std::vector< mitk::ClusteringMetric* >      m_Metrics;
   std::vector< std::vector< long > >          m_OutFiberIndices;
+  EUCLIDEAN                                   m_FastMetric;
+  float                                       m_FastMetricScale;
 };
 }
 
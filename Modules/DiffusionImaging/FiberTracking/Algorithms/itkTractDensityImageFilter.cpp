@@ -23,7 +23,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 // misc
 #include <cmath>
+#include <limits>
 #include <boost/progress.hpp>
+#include <omp.h>
 
 namespace itk{
 
@@ -39,6 +41,8 @@ TractDensityImageFilter< OutputImageType >::TractDensityImageFilter()
   , m_WorkOnFiberCopy(true)
   , m_MaxDensity(0)
   , m_NumCoveredVoxels(0)
+  , m_UseExactSegmentLengths(false)
+  , m_MaxBufferMemory(4096)
 {
 }
 
@@ -57,6 +61,173 @@ itk::Point<float, 3> TractDensityImageFilter< OutputImageType >::GetItkPoint(dou
   return itkPoint;
 }
 
+template< class OutputImageType >
+void TractDensityImageFilter< OutputImageType >::RasterizePoint(const float* point, float weight, OutPixelType* buffer) const
+{
+  const int w = m_ImageSize[0];
+  const int h = m_ImageSize[1];
+  const int d = m_ImageSize[2];
+  const OutputImageType* outImage = this->GetOutput();
+
+  itk::Point<float, 3> vertex;
+  vertex[0] = point[0];
+  vertex[1] = point[1];
+  vertex[2] = point[2];
+  itk::Index<3> index;
+  itk::ContinuousIndex<float, 3> contIndex;
+  outImage->TransformPhysicalPointToIndex(vertex, index);
+  outImage->TransformPhysicalPointToContinuousIndex(vertex, contIndex);
+
+  if (!m_UseTrilinearInterpolation)
+  {
+    if (outImage->GetLargestPossibleRegion().IsInside(index))
+    {
+      OutPixelType& pix = buffer[index[0] + w*(index[1] + h*index[2])];
+      if (m_BinaryOutput)
+        pix = 1;
+      else
+        pix += weight;
+    }
+    return;
+  }
+
+  float frac_x = contIndex[0] - index[0];
+  float frac_y = contIndex[1] - index[1];
+  float frac_z = contIndex[2] - index[2];
+
+  if (frac_x<0)
+  {
+    index[0] -= 1;
+    frac_x += 1;
+  }
+  if (frac_y<0)
+  {
+    index[1] -= 1;
+    frac_y += 1;
+  }
+  if (frac_z<0)
+  {
+    index[2] -= 1;
+    frac_z += 1;
+  }
+
+  frac_x = 1-frac_x;
+  frac_y = 1-frac_y;
+  frac_z = 1-frac_z;
+
+  // int coordinates inside image?
+  if (index[0] < 0 || index[0] >= w-1)
+    return;
+  if (index[1] < 0 || index[1] >= h-1)
+    return;
+  if (index[2] < 0 || index[2] >= d-1)
+    return;
+
+  if (m_BinaryOutput)
+  {
+    buffer[( index[0]   + w*(index[1]  + h*index[2]  ))] = 1;
+    buffer[( index[0]   + w*(index[1]+1+ h*index[2]  ))] = 1;
+    buffer[( index[0]   + w*(index[1]  + h*index[2]+h))] = 1;
+    buffer[( index[0]   + w*(index[1]+1+ h*index[2]+h))] = 1;
+    buffer[( index[0]+1 + w*(index[1]  + h*index[2]  ))] = 1;
+    buffer[( index[0]+1 + w*(index[1]  + h*index[2]+h))] = 1;
+    buffer[( index[0]+1 + w*(index[1]+1+ h*index[2]  ))] = 1;
+    buffer[( index[0]+1 + w*(index[1]+1+ h*index[2]+h))] = 1;
+  }
+  else
+  {
+    buffer[( index[0]   + w*(index[1]  + h*index[2]  ))] += (  frac_x)*(  frac_y)*(  frac_z);
+    buffer[( index[0]   + w*(index[1]+1+ h*index[2]  ))] += (  frac_x)*(1-frac_y)*(  frac_z);
+    buffer[( index[0]   + w*(index[1]  + h*index[2]+h))] += (  frac_x)*(  frac_y)*(1-frac_z);
+    buffer[( index[0]   + w*(index[1]+1+ h*index[2]+h))] += (  frac_x)*(1-frac_y)*(1-frac_z);
+    buffer[( index[0]+1 + w*(index[1]  + h*index[2]  ))] += (1-frac_x)*(  frac_y)*(  frac_z);
+    buffer[( index[0]+1 + w*(index[1]  + h*index[2]+h))] += (1-frac_x)*(  frac_y)*(1-frac_z);
+    buffer[( index[0]+1 + w*(index[1]+1+ h*index[2]  ))] += (1-frac_x)*(1-frac_y)*(  frac_z);
+    buffer[( index[0]+1 + w*(index[1]+1+ h*index[2]+h))] += (1-frac_x)*(1-frac_y)*(1-frac_z);
+  }
+}
+
+template< class OutputImageType >
+void TractDensityImageFilter< OutputImageType >::RasterizeSegment(const float* p1, const float* p2, float weight, OutPixelType* buffer) const
+{
+  const OutputImageType* outImage = this->GetOutput();
+
+  itk::Point<double, 3> vertex1, vertex2;
+  double length = 0;
+  for (int i=0; i<3; ++i)
+  {
+    vertex1[i] = p1[i];
+    vertex2[i] = p2[i];
+    length += (p2[i]-p1[i])*(p2[i]-p1[i]);
+  }
+  length = std::sqrt(length);
+
+  // voxel k covers the continuous index range [k-0.5, k+0.5), shift by 0.5 to get voxel k = floor(x)
+  itk::ContinuousIndex<double, 3> c1, c2;
+  outImage->TransformPhysicalPointToContinuousIndex(vertex1, c1);
+  outImage->TransformPhysicalPointToContinuousIndex(vertex2, c2);
+
+  // walk through all voxels traversed by the segment (Amanatides & Woo) and add the length of each piece
+  int voxel[3];
+  int step[3];
+  double t_max[3];
+  double t_delta[3];
+  int num_steps = 1;
+  for (int i=0; i<3; ++i)
+  {
+    double a = c1[i] + 0.5;
+    double b = c2[i] + 0.5;
+    double dir = b - a;
+    voxel[i] = static_cast<int>(std::floor(a));
+    num_steps += std::abs(static_cast<int>(std::floor(b)) - voxel[i]);
+    if (dir>0)
+    {
+      step[i] = 1;
+      t_delta[i] = 1.0/dir;
+      t_max[i] = (voxel[i] + 1 - a)/dir;
+    }
+    else if (dir<0)
+    {
+      step[i] = -1;
+      t_delta[i] = -1.0/dir;
+      t_max[i] = (voxel[i] - a)/dir;
+    }
+    else
+    {
+      step[i] = 0;
+      t_delta[i] = std::numeric_limits<double>::infinity();
+      t_max[i] = std::numeric_limits<double>::infinity();
+    }
+  }
+
+  const int w = m_ImageSize[0];
+  const int h = m_ImageSize[1];
+  const int d = m_ImageSize[2];
+  double t = 0;
+  for (int s=0; s<num_steps; ++s)
+  {
+    int axis = 0;
+    if (t_max[1]<t_max[axis])
+      axis = 1;
+    if (t_max[2]<t_max[axis])
+      axis = 2;
+    double t_next = s+1<num_steps ? std::min(t_max[axis], 1.0) : 1.0;
+
+    if (t_next>t && voxel[0]>=0 && voxel[0]<w && voxel[1]>=0 && voxel[1]<h && voxel[2]>=0 && voxel[2]<d)
+    {
+      OutPixelType& pix = buffer[voxel[0] + w*(voxel[1] + h*voxel[2])];
+      if (m_BinaryOutput)
+        pix = 1;
+      else
+        pix += weight*length*(t_next-t);
+    }
+
+    t = t_next;
+    voxel[axis] += step[axis];
+    t_max[axis] += t_delta[axis];
+  }
+}
+
 template< class OutputImageType >
 void TractDensityImageFilter< OutputImageType >::GenerateData()
 {
@@ -130,7 +301,7 @@ void TractDensityImageFilter< OutputImageType >::GenerateData()
   else
     minSpacing = newSpacing[2];
 
-  if (m_DoFiberResampling)
+  if (m_DoFiberResampling && !m_UseExactSegmentLengths)
   {
     MITK_INFO << "TractDensityImageFilter: resampling fibers to ensure sufficient voxel coverage";
     if (m_WorkOnFiberCopy)
@@ -140,115 +311,81 @@ void TractDensityImageFilter< OutputImageType >::GenerateData()
 
   MITK_INFO << "TractDensityImageFilter: starting image generation";
 
-  vtkSmartPointer<vtkPolyData> fiberPolyData = m_FiberBundle->GetFiberPolyData();
+  m_ImageSize[0] = w;
+  m_ImageSize[1] = h;
+  m_ImageSize[2] = d;
+  const std::size_t numVoxels = static_cast<std::size_t>(w)*h*d;
+
+  // the fibers are split into contiguous ranges that are rasterized into separate images, the first one being
+  // the output image itself. the number of additional images is limited by the memory budget.
+  mitk::FiberPointBuffer fibers = m_FiberBundle->GetFiberPointBuffer();
+  int numFibers = fibers.GetNumberOfFibers();
+  std::size_t maxBuffers = 1 + static_cast<std::size_t>(m_MaxBufferMemory)*1024*1024/std::max<std::size_t>(1, numVoxels*sizeof(OutPixelType));
+  int numBuffers = static_cast<int>(std::max<std::size_t>(1, std::min<std::size_t>(std::min<std::size_t>(omp_get_max_threads(), maxBuffers), numFibers/1000+1)));
+  std::vector< std::vector< OutPixelType > > buffers(numBuffers-1);
+  MITK_INFO << "TractDensityImageFilter: using " << numBuffers << " accumulation image(s)";
 
-  int numFibers = m_FiberBundle->GetNumFibers();
   boost::progress_display disp(numFibers);
-  for( int i=0; i<numFibers; i++ )
+#pragma omp parallel num_threads(numBuffers)
+  for (int b=omp_get_thread_num(); b<numBuffers; b+=omp_get_num_threads())
   {
-    ++disp;
-    vtkCell* cell = fiberPolyData->GetCell(i);
-    int numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
-
-    float weight = m_FiberBundle->GetFiberWeight(i);
-
-    // fill output image
-    for( int j=0; j<numPoints; j++)
+    OutPixelType* buffer = outImageBufferPointer;
+    if (b>0)
     {
-      itk::Point<float, 3> vertex = GetItkPoint(points->GetPoint(j));
-      itk::Index<3> index;
-      itk::ContinuousIndex<float, 3> contIndex;
-      outImage->TransformPhysicalPointToIndex(vertex, index);
-      outImage->TransformPhysicalPointToContinuousIndex(vertex, contIndex);
-
-      if (!m_UseTrilinearInterpolation && outImage->GetLargestPossibleRegion().IsInside(index))
-      {
-        if (outImage->GetPixel(index)==0)
-          m_NumCoveredVoxels++;
-
-        if (m_BinaryOutput)
-          outImage->SetPixel(index, 1);
-        else
-          outImage->SetPixel(index, outImage->GetPixel(index)+weight);
-        continue;
-      }
+      buffers[b-1].assign(numVoxels, 0);
+      buffer = buffers[b-1].data();
+    }
 
-      float frac_x = contIndex[0] - index[0];
-      float frac_y = contIndex[1] - index[1];
-      float frac_z = contIndex[2] - index[2];
+    int start = static_cast<int>(static_cast<long long>(numFibers)*b/numBuffers);
+    int stop = static_cast<int>(static_cast<long long>(numFibers)*(b+1)/numBuffers);
+    for (int i=start; i<stop; ++i)
+    {
+      float weight = m_FiberBundle->GetFiberWeight(i);
+      const float* p = fibers.GetFiberPoints(i);
+      std::size_t numPoints = fibers.GetNumberOfPoints(i);
 
-      if (frac_x<0)
+      if (m_UseExactSegmentLengths)
       {
-        index[0] -= 1;
-        frac_x += 1;
+        for (std::size_t j=0; j+1<numPoints; ++j)
+          RasterizeSegment(p+3*j, p+3*(j+1), weight, buffer);
       }
-      if (frac_y<0)
-      {
-        index[1] -= 1;
-        frac_y += 1;
-      }
-      if (frac_z<0)
+      else
       {
-        index[2] -= 1;
-        frac_z += 1;
+        for (std::size_t j=0; j<numPoints; ++j)
+          RasterizePoint(p+3*j, weight, buffer);
       }
 
-      frac_x = 1-frac_x;
-      frac_y = 1-frac_y;
-      frac_z = 1-frac_z;
-
-      // int coordinates inside image?
-      if (index[0] < 0 || index[0] >= w-1)
-        continue;
-      if (index[1] < 0 || index[1] >= h-1)
-        continue;
-      if (index[2] < 0 || index[2] >= d-1)
-        continue;
-
-
-      if (outImageBufferPointer[( index[0]   + w*(index[1]  + h*index[2]  ))]==0)
-        m_NumCoveredVoxels++;
-      if (outImageBufferPointer[( index[0]   + w*(index[1]+1+ h*index[2]  ))]==0)
-        m_NumCoveredVoxels++;
-      if (outImageBufferPointer[( index[0]   + w*(index[1]  + h*index[2]+h))]==0)
-        m_NumCoveredVoxels++;
-      if (outImageBufferPointer[( index[0]   + w*(index[1]+1+ h*index[2]+h))]==0)
-        m_NumCoveredVoxels++;
-      if (outImageBufferPointer[( index[0]+1 + w*(index[1]  + h*index[2]  ))]==0)
-        m_NumCoveredVoxels++;
-      if (outImageBufferPointer[( index[0]+1 + w*(index[1]  + h*index[2]+h))]==0)
-        m_NumCoveredVoxels++;
-      if (outImageBufferPointer[( index[0]+1 + w*(index[1]+1+ h*index[2]  ))]==0)
-        m_NumCoveredVoxels++;
-      if (outImageBufferPointer[( index[0]+1 + w*(index[1]+1+ h*index[2]+h))]==0)
-        m_NumCoveredVoxels++;
-
-      if (m_BinaryOutput)
+      if ((i-start+1)%1000==0 || i+1==stop)
       {
-        outImageBufferPointer[( index[0]   + w*(index[1]  + h*index[2]  ))] = 1;
-        outImageBufferPointer[( index[0]   + w*(index[1]+1+ h*index[2]  ))] = 1;
-        outImageBufferPointer[( index[0]   + w*(index[1]  + h*index[2]+h))] = 1;
-        outImageBufferPointer[( index[0]   + w*(index[1]+1+ h*index[2]+h))] = 1;
-        outImageBufferPointer[( index[0]+1 + w*(index[1]  + h*index[2]  ))] = 1;
-        outImageBufferPointer[( index[0]+1 + w*(index[1]  + h*index[2]+h))] = 1;
-        outImageBufferPointer[( index[0]+1 + w*(index[1]+1+ h*index[2]  ))] = 1;
-        outImageBufferPointer[( index[0]+1 + w*(index[1]+1+ h*index[2]+h))] = 1;
+#pragma omp critical (TractDensityImageFilterProgress)
+        {
+          disp += (i-start)%1000 + 1;
+        }
       }
-      else
+    }
+  }
+
+  // reduce the accumulation images into the output
+  if (!buffers.empty())
+  {
+#pragma omp parallel for
+    for (int i=0; i<static_cast<int>(numVoxels); i++)
+    {
+      for (auto& buffer : buffers)
       {
-        outImageBufferPointer[( index[0]   + w*(index[1]  + h*index[2]  ))] += (  frac_x)*(  frac_y)*(  frac_z);
-        outImageBufferPointer[( index[0]   + w*(index[1]+1+ h*index[2]  ))] += (  frac_x)*(1-frac_y)*(  frac_z);
-        outImageBufferPointer[( index[0]   + w*(index[1]  + h*index[2]+h))] += (  frac_x)*(  frac_y)*(1-frac_z);
-        outImageBufferPointer[( index[0]   + w*(index[1]+1+ h*index[2]+h))] += (  frac_x)*(1-frac_y)*(1-frac_z);
-        outImageBufferPointer[( index[0]+1 + w*(index[1]  + h*index[2]  ))] += (1-frac_x)*(  frac_y)*(  frac_z);
-        outImageBufferPointer[( index[0]+1 + w*(index[1]  + h*index[2]+h))] += (1-frac_x)*(  frac_y)*(1-frac_z);
-        outImageBufferPointer[( index[0]+1 + w*(index[1]+1+ h*index[2]  ))] += (1-frac_x)*(1-frac_y)*(  frac_z);
-        outImageBufferPointer[( index[0]+1 + w*(index[1]+1+ h*index[2]+h))] += (1-frac_x)*(1-frac_y)*(1-frac_z);
+        if (m_BinaryOutput)
+          outImageBufferPointer[i] = std::max(outImageBufferPointer[i], buffer[i]);
+        else
+          outImageBufferPointer[i] += buffer[i];
       }
     }
   }
 
+  m_NumCoveredVoxels = 0;
+  for (std::size_t i=0; i<numVoxels; i++)
+    if (outImageBufferPointer[i]!=0)
+      m_NumCoveredVoxels++;
+
   m_MaxDensity = 0;
   for (int i=0; i<w*h*d; i++)
     if (m_MaxDensity < outImageBufferPointer[i])
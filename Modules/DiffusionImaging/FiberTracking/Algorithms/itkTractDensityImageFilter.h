@@ -58,6 +58,10 @@ public:
   itkSetMacro( UseTrilinearInterpolation, bool )
   itkSetMacro( DoFiberResampling, bool )
   itkSetMacro( WorkOnFiberCopy, bool )
+  itkSetMacro( UseExactSegmentLengths, bool )                   ///< add the length of every fiber segment inside a voxel (mm) instead of sampling resampled fiber points. No fiber resampling is needed in this mode.
+  itkGetMacro( UseExactSegmentLengths, bool )                   ///< add the length of every fiber segment inside a voxel (mm) instead of sampling resampled fiber points. No fiber resampling is needed in this mode.
+  itkSetMacro( MaxBufferMemory, unsigned int )                  ///< memory in MB that may be used for the per-thread accumulation images. Limits the number of threads for large output images.
+  itkGetMacro( MaxBufferMemory, unsigned int )                  ///< memory in MB that may be used for the per-thread accumulation images. Limits the number of threads for large output images.
   itkGetMacro( MaxDensity, OutPixelType)
   itkGetMacro( NumCoveredVoxels, unsigned int)
 
@@ -66,6 +70,8 @@ public:
 protected:
 
   itk::Point<float, 3> GetItkPoint(double point[3]);
+  void RasterizePoint(const float* point, float weight, OutPixelType* buffer) const;
+  void RasterizeSegment(const float* p1, const float* p2, float weight, OutPixelType* buffer) const;
 
   TractDensityImageFilter();
   ~TractDensityImageFilter() override;
@@ -82,6 +88,9 @@ protected:
   bool                              m_WorkOnFiberCopy;
   OutPixelType                      m_MaxDensity;
   unsigned int                      m_NumCoveredVoxels;
+  bool                              m_UseExactSegmentLengths;
+  unsigned int                      m_MaxBufferMemory;
+  int                               m_ImageSize[3];
 };
 
 }
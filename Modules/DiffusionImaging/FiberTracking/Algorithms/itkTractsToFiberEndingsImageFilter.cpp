@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkCellArray.h>
 #include <vtkCellData.h>
 #include <boost/progress.hpp>
+#include <omp.h>
 
 namespace itk{
 
@@ -107,56 +108,61 @@ namespace itk{
     for (int i=0; i<w*h*d; i++)
       outImageBufferPointer[i] = 0;
 
-    // resample fiber bundle
+    // start of every fiber in the raw connectivity array (n, id_0, ..., id_n-1)
     vtkSmartPointer<vtkPolyData> fiberPolyData = m_FiberBundle->GetFiberPolyData();
-
+    vtkPoints* points = fiberPolyData->GetPoints();
     int numFibers = m_FiberBundle->GetNumFibers();
-    boost::progress_display disp(numFibers);
+    const vtkIdType* connectivity = fiberPolyData->GetLines()->GetPointer();
+    std::vector< vtkIdType > cellStart(numFibers);
+    vtkIdType loc = 0;
     for( int i=0; i<numFibers; i++ )
     {
-        ++disp;
-      vtkCell* cell = fiberPolyData->GetCell(i);
-      int numPoints = cell->GetNumberOfPoints();
-      vtkPoints* points = cell->GetPoints();
+      cellStart[i] = loc;
+      loc += connectivity[loc] + 1;
+    }
 
-      // fill output image
-      if (numPoints>0)
+    // the threads only collect the voxels hit by the fiber endings, these are counted afterwards in fiber order
+    std::vector< std::vector< std::size_t > > endingVoxels(omp_get_max_threads());
+    boost::progress_display disp(numFibers);
+#pragma omp parallel
+    {
+      std::vector< std::size_t >& voxels = endingVoxels[omp_get_thread_num()];
+#pragma omp for schedule(static)
+      for( int i=0; i<numFibers; i++ )
       {
-        itk::Point<float, 3> vertex = GetItkPoint(points->GetPoint(0));
-        itk::Index<3> index;
-        outImage->TransformPhysicalPointToIndex(vertex, index);
-        if (upsampledRegion.IsInside(index))
+        vtkIdType numPoints = connectivity[cellStart[i]];
+        const vtkIdType* ids = connectivity + cellStart[i] + 1;
+
+        for (int e=0; e<2 && e<numPoints; ++e)
         {
-          if (m_BinaryOutput)
-          {
-            outImage->SetPixel(index, 1);
-          }
-          else
-          {
-            outImage->SetPixel(index, outImage->GetPixel(index)+1);
-          }
+          double p[3];
+          points->GetPoint(e==0 ? ids[0] : ids[numPoints-1], p);
+          itk::Point<float, 3> vertex = GetItkPoint(p);
+          itk::Index<3> index;
+          outImage->TransformPhysicalPointToIndex(vertex, index);
+          if (upsampledRegion.IsInside(index))
+            voxels.push_back(index[0] + static_cast<std::size_t>(w)*(index[1] + static_cast<std::size_t>(h)*index[2]));
         }
-      }
 
-      if (numPoints>=2)
-      {
-        itk::Point<float, 3> vertex = GetItkPoint(points->GetPoint(numPoints-1));
-        itk::Index<3> index;
-        outImage->TransformPhysicalPointToIndex(vertex, index);
-        if (upsampledRegion.IsInside(index))
+        if ((i+1)%1000==0)
         {
-          if (m_BinaryOutput)
-          {
-              outImage->SetPixel(index, 1);
-          }
-          else
+#pragma omp critical (TractsToFiberEndingsImageFilterProgress)
           {
-              outImage->SetPixel(index, outImage->GetPixel(index)+1);
+            disp += 1000;
           }
         }
       }
     }
 
+    for (auto& voxels : endingVoxels)
+      for (auto v : voxels)
+      {
+        if (m_BinaryOutput)
+          outImageBufferPointer[v] = 1;
+        else
+          outImageBufferPointer[v] += 1;
+      }
+
     if (m_InvertImage)
       for (int i=0; i<w*h*d; i++)
         outImageBufferPointer[i] = 1-outImageBufferPointer[i];
@@ -0,0 +1,245 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef _MITK_CsrMatrix_H
+#define _MITK_CsrMatrix_H
+
+#include <vnl/vnl_vector.h>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace mitk {
+
+/**
+* \brief Compressed sparse row matrix used to solve the fiber fitting systems (itk::FitFibersToImageFilter).
+*
+* The matrix is assembled once from (row, column, value) triplets, duplicate entries are summed. A column
+* compressed copy of the entries is kept as well, so that A*x and A^T*x can both be computed in parallel without
+* any synchronization. Explicitly stored zeros are kept, i.e. the sparsity pattern is exactly the set of
+* (row, column) pairs that occurred in the triplets.
+*/
+class CsrMatrix
+{
+public:
+
+  struct Triplet
+  {
+    unsigned int row;
+    unsigned int col;
+    double value;
+  };
+  typedef std::vector< Triplet > TripletContainer;
+
+  CsrMatrix() : m_Rows(0), m_Cols(0) {}
+
+  /** \brief Builds the matrix from the given triplet containers (e.g. one per thread). The containers are cleared. */
+  void SetTriplets(unsigned int rows, unsigned int cols, std::vector< TripletContainer >& triplets)
+  {
+    m_Rows = rows;
+    m_Cols = cols;
+
+    // bucket the triplets by row
+    std::vector< std::size_t > row_start(m_Rows+1, 0);
+    for (auto& container : triplets)
+      for (auto& t : container)
+        ++row_start[t.row+1];
+    for (unsigned int r=0; r<m_Rows; ++r)
+      row_start[r+1] += row_start[r];
+
+    std::vector< std::pair< unsigned int, double > > entries(row_start[m_Rows]);
+    std::vector< std::size_t > fill(row_start.begin(), row_start.end()-1);
+    for (auto& container : triplets)
+    {
+      for (auto& t : container)
+        entries[fill[t.row]++] = std::make_pair(t.col, t.value);
+      TripletContainer().swap(container);
+    }
+    std::vector< std::size_t >().swap(fill);
+
+    // sort each row by column and sum up duplicate entries in place
+    std::vector< std::size_t > row_size(m_Rows, 0);
+#pragma omp parallel for schedule(dynamic, 4096)
+    for (int r=0; r<static_cast<int>(m_Rows); ++r)
+    {
+      auto first = entries.begin()+row_start[r];
+      auto last = entries.begin()+row_start[r+1];
+      if (first==last)
+        continue;
+      std::stable_sort(first, last, [](const std::pair< unsigned int, double >& a, const std::pair< unsigned int, double >& b) { return a.first<b.first; });
+
+      auto out = first;
+      for (auto it=first+1; it!=last; ++it)
+      {
+        if (it->first==out->first)
+          out->second += it->second;
+        else
+          *(++out) = *it;
+      }
+      row_size[r] = out-first+1;
+    }
+
+    m_RowPointers.assign(m_Rows+1, 0);
+    for (unsigned int r=0; r<m_Rows; ++r)
+      m_RowPointers[r+1] = m_RowPointers[r] + row_size[r];
+    std::vector< std::size_t >().swap(row_size);
+
+    m_ColumnIndices.resize(m_RowPointers[m_Rows]);
+    m_Values.resize(m_RowPointers[m_Rows]);
+#pragma omp parallel for schedule(dynamic, 4096)
+    for (int r=0; r<static_cast<int>(m_Rows); ++r)
+    {
+      std::size_t in = row_start[r];
+      for (std::size_t k=m_RowPointers[r]; k<m_RowPointers[r+1]; ++k, ++in)
+      {
+        m_ColumnIndices[k] = entries[in].first;
+        m_Values[k] = entries[in].second;
+      }
+    }
+    std::vector< std::pair< unsigned int, double > >().swap(entries);
+
+    // column compressed copy, rows within each column are sorted since the rows are visited in order
+    m_ColumnPointers.assign(m_Cols+1, 0);
+    for (std::size_t k=0; k<m_ColumnIndices.size(); ++k)
+      ++m_ColumnPointers[m_ColumnIndices[k]+1];
+    for (unsigned int c=0; c<m_Cols; ++c)
+      m_ColumnPointers[c+1] += m_ColumnPointers[c];
+
+    m_RowIndices.resize(m_Values.size());
+    m_TransposedValues.resize(m_Values.size());
+    fill.assign(m_ColumnPointers.begin(), m_ColumnPointers.end()-1);
+    for (unsigned int r=0; r<m_Rows; ++r)
+      for (std::size_t k=m_RowPointers[r]; k<m_RowPointers[r+1]; ++k)
+      {
+        std::size_t t = fill[m_ColumnIndices[k]]++;
+        m_RowIndices[t] = r;
+        m_TransposedValues[t] = m_Values[k];
+      }
+  }
+
+  unsigned int rows() const { return m_Rows; }
+  unsigned int cols() const { return m_Cols; }
+  std::size_t GetNumberOfNonZeros() const { return m_Values.size(); }
+
+  /** \brief Number of stored entries in the given row */
+  unsigned int GetRowSize(unsigned int r) const { return static_cast<unsigned int>(m_RowPointers[r+1]-m_RowPointers[r]); }
+
+  const std::vector< std::size_t >& GetRowPointers() const { return m_RowPointers; }
+  const std::vector< unsigned int >& GetColumnIndices() const { return m_ColumnIndices; }
+  const std::vector< std::size_t >& GetColumnPointers() const { return m_ColumnPointers; }
+  const std::vector< unsigned int >& GetRowIndices() const { return m_RowIndices; }
+
+  /** \brief y = A*x */
+  void Multiply(const vnl_vector<double>& x, vnl_vector<double>& y) const
+  {
+    y.set_size(m_Rows);
+#pragma omp parallel for schedule(dynamic, 4096)
+    for (int r=0; r<static_cast<int>(m_Rows); ++r)
+    {
+      double sum = 0;
+      for (std::size_t k=m_RowPointers[r]; k<m_RowPointers[r+1]; ++k)
+        sum += m_Values[k]*x[m_ColumnIndices[k]];
+      y[r] = sum;
+    }
+  }
+
+  /** \brief y = A^T*x */
+  void TransposeMultiply(const vnl_vector<double>& x, vnl_vector<double>& y) const
+  {
+    y.set_size(m_Cols);
+#pragma omp parallel for schedule(dynamic, 256)
+    for (int c=0; c<static_cast<int>(m_Cols); ++c)
+    {
+      double sum = 0;
+      for (std::size_t k=m_ColumnPointers[c]; k<m_ColumnPointers[c+1]; ++k)
+        sum += m_TransposedValues[k]*x[m_RowIndices[k]];
+      y[c] = sum;
+    }
+  }
+
+  /** \brief y = P*x where P contains a 1 for each stored entry of A */
+  void PatternMultiply(const vnl_vector<double>& x, vnl_vector<double>& y) const
+  {
+    y.set_size(m_Rows);
+#pragma omp parallel for schedule(dynamic, 4096)
+    for (int r=0; r<static_cast<int>(m_Rows); ++r)
+    {
+      double sum = 0;
+      for (std::size_t k=m_RowPointers[r]; k<m_RowPointers[r+1]; ++k)
+        sum += x[m_ColumnIndices[k]];
+      y[r] = sum;
+    }
+  }
+
+  /** \brief Root mean squared residual of A*x-b over all rows */
+  double GetRmsError(const vnl_vector<double>& x, const vnl_vector<double>& b) const
+  {
+    double sum = 0;
+#pragma omp parallel for schedule(dynamic, 4096) reduction(+:sum)
+    for (int r=0; r<static_cast<int>(m_Rows); ++r)
+    {
+      double d = -b[r];
+      for (std::size_t k=m_RowPointers[r]; k<m_RowPointers[r+1]; ++k)
+        d += m_Values[k]*x[m_ColumnIndices[k]];
+      sum += d*d;
+    }
+    return m_Rows>0 ? std::sqrt(sum/m_Rows) : 0.0;
+  }
+
+  CsrMatrix& operator*=(double s)
+  {
+#pragma omp parallel for schedule(dynamic, 4096)
+    for (int r=0; r<static_cast<int>(m_Rows); ++r)
+      for (std::size_t k=m_RowPointers[r]; k<m_RowPointers[r+1]; ++k)
+        m_Values[k] *= s;
+#pragma omp parallel for schedule(dynamic, 256)
+    for (int c=0; c<static_cast<int>(m_Cols); ++c)
+      for (std::size_t k=m_ColumnPointers[c]; k<m_ColumnPointers[c+1]; ++k)
+        m_TransposedValues[k] *= s;
+    return *this;
+  }
+
+  CsrMatrix& operator/=(double s)
+  {
+#pragma omp parallel for schedule(dynamic, 4096)
+    for (int r=0; r<static_cast<int>(m_Rows); ++r)
+      for (std::size_t k=m_RowPointers[r]; k<m_RowPointers[r+1]; ++k)
+        m_Values[k] /= s;
+#pragma omp parallel for schedule(dynamic, 256)
+    for (int c=0; c<static_cast<int>(m_Cols); ++c)
+      for (std::size_t k=m_ColumnPointers[c]; k<m_ColumnPointers[c+1]; ++k)
+        m_TransposedValues[k] /= s;
+    return *this;
+  }
+
+private:
+
+  unsigned int                m_Rows;
+  unsigned int                m_Cols;
+
+  std::vector< std::size_t >  m_RowPointers;        ///< index of the first entry of each row, last entry is the number of entries
+  std::vector< unsigned int > m_ColumnIndices;
+  std::vector< double >       m_Values;
+
+  std::vector< std::size_t >  m_ColumnPointers;     ///< same for the column compressed copy
+  std::vector< unsigned int > m_RowIndices;
+  std::vector< double >       m_TransposedValues;
+};
+
+}
+
+#endif
@@ -13,6 +13,7 @@ A PARTICULAR PURPOSE.
 See LICENSE.txt or http://www.mitk.org for details.
 
 ===================================================================*/
+#include <algorithm>
 #include <vnl/vnl_cross.h>
 #include <vnl/vnl_quaternion.h>
 #include <mitkAstroStickModel.h>
@@ -120,3 +121,16 @@ typename AstroStickModel< ScalarType >::PixelType AstroStickModel< ScalarType >:
 
     return signal;
 }
+
+template< class ScalarType >
+void AstroStickModel< ScalarType >::SimulateMeasurements(unsigned int dir, GradientType* fiberDirections, unsigned int numDirections, ScalarType* signals)
+{
+    if (m_RandomizeSticks)
+    {
+        // a new random stick configuration for each direction, as with single measurements
+        for (unsigned int i=0; i<numDirections; ++i)
+            signals[i] = SimulateMeasurement(dir, fiberDirections[i]);
+    }
+    else if (numDirections>0)   // the fixed sticks do not depend on the fiber direction
+        std::fill(signals, signals+numDirections, SimulateMeasurement(dir, fiberDirections[0]));
+}
@@ -57,6 +57,7 @@ public:
   /** Actual signal generation **/
   PixelType SimulateMeasurement(GradientType& fiberDirection) override;
   ScalarType SimulateMeasurement(unsigned int dir, GradientType& fiberDirection) override;
+  void SimulateMeasurements(unsigned int dir, GradientType* fiberDirections, unsigned int numDirections, ScalarType* signals) override;
 
   void SetRandomizeSticks(bool randomize=true){ m_RandomizeSticks=randomize; } ///< Random stick configuration in each voxel
   bool GetRandomizeSticks() { return m_RandomizeSticks; }
@@ -13,6 +13,7 @@ A PARTICULAR PURPOSE.
 See LICENSE.txt or http://www.mitk.org for details.
 
 ===================================================================*/
+#include <algorithm>
 #include <vnl/vnl_cross.h>
 #include <vnl/vnl_quaternion.h>
 #include <mitkBallModel.h>
@@ -70,3 +71,11 @@ typename BallModel< ScalarType >::PixelType BallModel< ScalarType >::SimulateMea
 
     return signal;
 }
+
+template< class ScalarType >
+void BallModel< ScalarType >::SimulateMeasurements(unsigned int dir, GradientType* fiberDirections, unsigned int numDirections, ScalarType* signals)
+{
+    // isotropic, the same signal for all fiber directions
+    if (numDirections>0)
+        std::fill(signals, signals+numDirections, SimulateMeasurement(dir, fiberDirections[0]));
+}
@@ -54,6 +54,7 @@ public:
   /** Actual signal generation **/
   PixelType SimulateMeasurement(GradientType& fiberDirection) override;
   ScalarType SimulateMeasurement(unsigned int dir, GradientType& fiberDirection) override;
+  void SimulateMeasurements(unsigned int dir, GradientType* fiberDirections, unsigned int numDirections, ScalarType* signals) override;
 
   void SetDiffusivity(double D) { m_Diffusivity = D; }
   double GetDiffusivity() { return m_Diffusivity; }
@@ -55,6 +55,17 @@ public:
     virtual PixelType SimulateMeasurement(GradientType& fiberDirection) = 0;
     virtual ScalarType SimulateMeasurement(unsigned int dir, GradientType& fiberDirection) = 0;
 
+    /**
+     * Signal of gradient direction "dir" for "numDirections" packed fiber directions, written to "signals".
+     * Calls SimulateMeasurement(dir, fiberDirection) for each direction in order. Models override it with a
+     * loop over the packed directions which evaluates everything depending only on the gradient once.
+     **/
+    virtual void SimulateMeasurements(unsigned int dir, GradientType* fiberDirections, unsigned int numDirections, ScalarType* signals)
+    {
+      for (unsigned int i=0; i<numDirections; ++i)
+        signals[i] = SimulateMeasurement(dir, fiberDirections[i]);
+    }
+
     void SetGradientList(DPH::GradientDirectionsContainerType* gradients)
     {
       m_GradientList.clear();
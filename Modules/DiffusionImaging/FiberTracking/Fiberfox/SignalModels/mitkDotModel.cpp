@@ -13,6 +13,7 @@ A PARTICULAR PURPOSE.
 See LICENSE.txt or http://www.mitk.org for details.
 
 ===================================================================*/
+#include <algorithm>
 #include <vnl/vnl_cross.h>
 #include <vnl/vnl_quaternion.h>
 #include <mitkDotModel.h>
@@ -45,3 +46,9 @@ typename DotModel< ScalarType >::PixelType DotModel< ScalarType >::SimulateMeasu
     signal.Fill(1);
     return signal;
 }
+
+template< class ScalarType >
+void DotModel< ScalarType >::SimulateMeasurements(unsigned int /*dir*/, GradientType* , unsigned int numDirections, ScalarType* signals)
+{
+    std::fill(signals, signals+numDirections, ScalarType(1));
+}
@@ -13,6 +13,7 @@ A PARTICULAR PURPOSE.
 See LICENSE.txt or http://www.mitk.org for details.
 
 ===================================================================*/
+#include <algorithm>
 #include <vnl/vnl_cross.h>
 #include <vnl/vnl_quaternion.h>
 #include <mitkStickModel.h>
@@ -72,3 +73,33 @@ typename StickModel< ScalarType >::PixelType StickModel< ScalarType >::SimulateM
 
   return signal;
 }
+
+template< class ScalarType >
+void StickModel< ScalarType >::SimulateMeasurements(unsigned int dir, GradientType* fiberDirections, unsigned int numDirections, ScalarType* signals)
+{
+  if (numDirections==0)
+    return;
+
+  if (dir>=this->m_GradientList.size())
+  {
+    std::fill(signals, signals+numDirections, ScalarType(0));
+    return;
+  }
+
+  const GradientType g = this->m_GradientList[dir];
+  if (g.GetNorm()<=0.0001)
+  {
+    std::fill(signals, signals+numDirections, ScalarType(1));
+    return;
+  }
+
+  // plain arithmetic on the packed directions, no branches, so the loop can be vectorized
+  const double b = -this->m_BValue*m_Diffusivity;
+  const double g0 = g[0], g1 = g[1], g2 = g[2];
+  const double* f = fiberDirections[0].GetDataPointer();
+  for (unsigned int i=0; i<numDirections; ++i)
+  {
+    ScalarType dot = f[3*i]*g0 + f[3*i+1]*g1 + f[3*i+2]*g2;
+    signals[i] = std::exp( b*dot*dot );
+  }
+}
@@ -13,6 +13,7 @@ A PARTICULAR PURPOSE.
 See LICENSE.txt or http://www.mitk.org for details.
 
 ===================================================================*/
+#include <algorithm>
 #include <vnl/vnl_cross.h>
 #include <vnl/vnl_quaternion.h>
 #include <mitkTensorModel.h>
@@ -36,13 +37,8 @@ TensorModel< ScalarType >::~TensorModel()
 }
 
 template< class ScalarType >
-ScalarType TensorModel< ScalarType >::SimulateMeasurement(unsigned int dir, GradientType &fiberDirection)
+typename TensorModel< ScalarType >::ItkTensorType TensorModel< ScalarType >::GetRotatedKernelTensor(GradientType& fiberDirection)
 {
-  ScalarType signal = 0;
-
-  if (dir>=this->m_GradientList.size())
-    return signal;
-
   ItkTensorType tensor; tensor.Fill(0.0);
   vnl_vector_fixed<double, 3> axis = itk::CrossProduct(m_KernelDirection, fiberDirection).GetVnlVector(); axis.normalize();
   vnl_quaternion<double> rotation(axis, acos(m_KernelDirection*fiberDirection));
@@ -53,6 +49,19 @@ ScalarType TensorModel< ScalarType >::SimulateMeasurement(unsigned int dir, Grad
   tensor[0] = tensorMatrix[0][0]; tensor[1] = tensorMatrix[0][1]; tensor[2] = tensorMatrix[0][2];
   tensor[3] = tensorMatrix[1][1]; tensor[4] = tensorMatrix[1][2]; tensor[5] = tensorMatrix[2][2];
 
+  return tensor;
+}
+
+template< class ScalarType >
+ScalarType TensorModel< ScalarType >::SimulateMeasurement(unsigned int dir, GradientType &fiberDirection)
+{
+  ScalarType signal = 0;
+
+  if (dir>=this->m_GradientList.size())
+    return signal;
+
+  ItkTensorType tensor = GetRotatedKernelTensor(fiberDirection);
+
   GradientType g = this->m_GradientList[dir];
   if (g.GetNorm()>0.0001)
   {
@@ -84,15 +93,7 @@ typename TensorModel< ScalarType >::PixelType TensorModel< ScalarType >::Simulat
 {
   PixelType signal; signal.SetSize(this->m_GradientList.size()); signal.Fill(0.0);
 
-  ItkTensorType tensor; tensor.Fill(0.0);
-  vnl_vector_fixed<double, 3> axis = itk::CrossProduct(m_KernelDirection, fiberDirection).GetVnlVector(); axis.normalize();
-  vnl_quaternion<double> rotation(axis, acos(m_KernelDirection*fiberDirection));
-  rotation.normalize();
-  vnl_matrix_fixed<double, 3, 3> matrix = rotation.rotation_matrix_transpose();
-
-  vnl_matrix_fixed<double, 3, 3> tensorMatrix = matrix.transpose()*m_KernelTensorMatrix*matrix;
-  tensor[0] = tensorMatrix[0][0]; tensor[1] = tensorMatrix[0][1]; tensor[2] = tensorMatrix[0][2];
-  tensor[3] = tensorMatrix[1][1]; tensor[4] = tensorMatrix[1][2]; tensor[5] = tensorMatrix[2][2];
+  ItkTensorType tensor = GetRotatedKernelTensor(fiberDirection);
 
   for( unsigned int i=0; i<this->m_GradientList.size(); i++)
   {
@@ -122,3 +123,41 @@ typename TensorModel< ScalarType >::PixelType TensorModel< ScalarType >::Simulat
 
   return signal;
 }
+
+template< class ScalarType >
+void TensorModel< ScalarType >::SimulateMeasurements(unsigned int dir, GradientType* fiberDirections, unsigned int numDirections, ScalarType* signals)
+{
+  if (numDirections==0)
+    return;
+
+  if (dir>=this->m_GradientList.size())
+  {
+    std::fill(signals, signals+numDirections, ScalarType(0));
+    return;
+  }
+
+  GradientType g = this->m_GradientList[dir];
+  if (g.GetNorm()<=0.0001)
+  {
+    std::fill(signals, signals+numDirections, ScalarType(1));
+    return;
+  }
+
+  // g^T * D * g = sum of the tensor entries weighted with S, off-diagonal entries count twice
+  ScalarType S[6];
+  S[0] = g[0]*g[0];
+  S[1] = 2*g[1]*g[0];
+  S[2] = 2*g[2]*g[0];
+  S[3] = g[1]*g[1];
+  S[4] = 2*g[2]*g[1];
+  S[5] = g[2]*g[2];
+
+  for (unsigned int i=0; i<numDirections; ++i)
+  {
+    ItkTensorType tensor = GetRotatedKernelTensor(fiberDirections[i]);
+    ScalarType D_scalar = tensor[0]*S[0] + tensor[1]*S[1] + tensor[2]*S[2] + tensor[3]*S[3] + tensor[4]*S[4] + tensor[5]*S[5];
+
+    // check for corrupted tensor and generate signal
+    signals[i] = D_scalar>=0 ? std::exp( -this->m_BValue * D_scalar ) : 0;
+  }
+}
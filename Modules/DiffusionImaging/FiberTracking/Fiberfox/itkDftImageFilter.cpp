@@ -39,7 +39,51 @@ template< class TPixelType >
 void DftImageFilter< TPixelType >
 ::BeforeThreadedGenerateData()
 {
+    typename InputImageType::Pointer inputImage  = static_cast< InputImageType * >( this->ProcessObject::GetInput(0) );
 
+    int szx = inputImage->GetLargestPossibleRegion().GetSize(0);
+    int szy = inputImage->GetLargestPossibleRegion().GetSize(1);
+
+    // the 2D transform is separable: precompute the twiddle factors of both directions
+    // and transform all rows here, the threads then only transform along y
+    m_TwiddleX.resize(szx*szx);
+    for (int k=0; k<szx; ++k)
+        for (int x=0; x<szx; ++x)
+            m_TwiddleX[k*szx+x] = exp( std::complex<TPixelType>(0, -2 * itk::Math::pi * CenteredIndex(k, szx)*CenteredIndex(x, szx)/szx ) );
+    m_TwiddleY.resize(szy*szy);
+    for (int k=0; k<szy; ++k)
+        for (int y=0; y<szy; ++y)
+            m_TwiddleY[k*szy+y] = exp( std::complex<TPixelType>(0, -2 * itk::Math::pi * CenteredIndex(k, szy)*CenteredIndex(y, szy)/szy ) );
+
+    m_Rows.resize(szx*szy);
+    std::vector< vcl_complex<TPixelType> > row(szx);
+    typename InputImageType::IndexType idx;
+    for (int y=0; y<szy; ++y)
+    {
+        idx[1] = y;
+        for (int x=0; x<szx; ++x)
+        {
+            idx[0] = x;
+            row[x] = inputImage->GetPixel(idx);
+        }
+        for (int kx=0; kx<szx; ++kx)
+        {
+            const vcl_complex<TPixelType>* e = &m_TwiddleX[kx*szx];
+            vcl_complex<TPixelType> s(0,0);
+            for (int x=0; x<szx; ++x)
+                s += row[x] * e[x];
+            m_Rows[kx*szy+y] = s;
+        }
+    }
+}
+
+template< class TPixelType >
+void DftImageFilter< TPixelType >
+::AfterThreadedGenerateData()
+{
+    m_TwiddleX.clear();
+    m_TwiddleY.clear();
+    m_Rows.clear();
 }
 
 template< class TPixelType >
@@ -50,46 +94,18 @@ void DftImageFilter< TPixelType >
 
     ImageRegionIterator< OutputImageType > oit(outputImage, outputRegionForThread);
 
-    typedef ImageRegionConstIterator< InputImageType > InputIteratorType;
-    typename InputImageType::Pointer inputImage  = static_cast< InputImageType * >( this->ProcessObject::GetInput(0) );
-
-    int szx = outputImage->GetLargestPossibleRegion().GetSize(0);
     int szy = outputImage->GetLargestPossibleRegion().GetSize(1);
 
     while( !oit.IsAtEnd() )
     {
-        float kx = oit.GetIndex()[0];
-        float ky = oit.GetIndex()[1];
-
-        if ((int)szx%2==1)
-            kx -= (szx-1)/2;
-        else
-            kx -= szx/2;
-        if ((int)szy%2==1)
-            ky -= (szy-1)/2;
-        else
-            ky -= szy/2;
+        int kx = oit.GetIndex()[0];
+        int ky = oit.GetIndex()[1];
 
+        const vcl_complex<TPixelType>* r = &m_Rows[kx*szy];
+        const vcl_complex<TPixelType>* e = &m_TwiddleY[ky*szy];
         vcl_complex<TPixelType> s(0,0);
-        InputIteratorType it(inputImage, inputImage->GetLargestPossibleRegion() );
-        while( !it.IsAtEnd() )
-        {
-            float x = it.GetIndex()[0];
-            float y = it.GetIndex()[1];
-
-            if ((int)szx%2==1)
-                x -= (szx-1)/2;
-            else
-                x -= szx/2;
-            if ((int)szy%2==1)
-                y -= (szy-1)/2;
-            else
-                y -= szy/2;
-
-            s += it.Get() * exp( std::complex<TPixelType>(0, -2 * itk::Math::pi * (kx*x/szx + ky*y/szy) ) );
-
-            ++it;
-        }
+        for (int y=0; y<szy; ++y)
+            s += r[y] * e[y];
 
         oit.Set(s);
         ++oit;
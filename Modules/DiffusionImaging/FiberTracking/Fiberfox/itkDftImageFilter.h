@@ -26,12 +26,16 @@ This file is based heavily on a corresponding ITK filter.
 #include <itkImageToImageFilter.h>
 #include <itkDiffusionTensor3D.h>
 #include <vcl_complex.h>
+#include <vector>
 #include <mitkFiberfoxParameters.h>
 
 namespace itk{
 
 /**
-* \brief 2D Discrete Fourier Transform Filter (complex to real). Special issue for Fiberfox -> rearranges slice. */
+* \brief 2D Discrete Fourier Transform Filter (complex to real). Special issue for Fiberfox -> rearranges slice.
+*
+* The transform is computed separably (rows, then columns) using precomputed twiddle tables,
+* which is exact for arbitrary image sizes and reduces the cost per slice from O(N^4) to O(N^3). */
 
 template< class TPixelType >
 class DftImageFilter :
@@ -64,10 +68,18 @@ protected:
 
     void BeforeThreadedGenerateData() override;
     void ThreadedGenerateData( const OutputImageRegionType &outputRegionForThread, ThreadIdType threadId) override;
+    void AfterThreadedGenerateData() override;
+
+    /** Shift index for DFT: (0 -- N) --> (-N/2 -- N/2) */
+    static float CenteredIndex(int i, int n) { return n%2==1 ? i-(n-1)/2 : i-n/2; }
 
 private:
 
     FiberfoxParameters  m_Parameters;
+
+    std::vector< vcl_complex< TPixelType > > m_TwiddleX;   ///< [kx*szx+x]
+    std::vector< vcl_complex< TPixelType > > m_TwiddleY;   ///< [ky*szy+y]
+    std::vector< vcl_complex< TPixelType > > m_Rows;       ///< input transformed along x, [kx*szy+y]
 };
 
 }
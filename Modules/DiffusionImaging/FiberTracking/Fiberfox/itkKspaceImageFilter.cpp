@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <ctime>
 #include <cstdio>
 #include <cstdlib>
+#include <algorithm>
 
 #include "itkKspaceImageFilter.h"
 #include <itkImageRegionConstIterator.h>
@@ -38,6 +39,7 @@ namespace itk {
     , m_UseConstantRandSeed(false)
     , m_SpikesPerSlice(0)
     , m_IsBaseline(true)
+    , m_UseSeparableTransform(false)
   {
     m_DiffusionGradientDirection.Fill(0.0);
     m_CoilPosition.Fill(0.0);
@@ -120,6 +122,114 @@ namespace itk {
     m_ReadoutScheme->AdjustEchoTime();
 
     m_FmapInterpolator->SetInputImage(m_Parameters->m_SignalGen.m_FrequencyMap);
+
+    // without off-resonance effects the phase of each DFT term only depends on k and the pixel position
+    bool eddy = m_Parameters->m_SignalGen.m_EddyStrength>0 && m_Parameters->m_Misc.m_CheckAddEddyCurrentsBox && !m_IsBaseline;
+    m_UseSeparableTransform = !eddy && m_Parameters->m_SignalGen.m_FrequencyMap.IsNull();
+    m_CompartmentSpectra.clear();
+    if (m_UseSeparableTransform)
+      CalculateCompartmentSpectra();
+  }
+
+  template< class ScalarType >
+  void KspaceImageFilter< ScalarType >::CalculateCompartmentSpectra()
+  {
+    int kxMax = m_Parameters->m_SignalGen.m_CroppedRegion.GetSize(0);
+    int kyMax = m_Parameters->m_SignalGen.m_CroppedRegion.GetSize(1);
+    int xMax = m_CompartmentImages.at(0)->GetLargestPossibleRegion().GetSize(0);
+    int yMax = m_CompartmentImages.at(0)->GetLargestPossibleRegion().GetSize(1);
+    float yMaxFov = yMax*m_Parameters->m_SignalGen.m_CroppingFactor;
+    float offset = m_Parameters->m_SignalGen.m_KspaceLineOffset;
+
+    // centered pixel coordinates, y is wrapped back into the FOV (aliasing)
+    std::vector< float > xs(xMax), ys(yMax);
+    for (int x=0; x<xMax; ++x)
+      xs[x] = xMax%2==1 ? x-(xMax-1)/2.0f : x-xMax/2.0f;
+    std::vector< float > yc(yMax);
+    for (int y=0; y<yMax; ++y)
+    {
+      yc[y] = yMax%2==1 ? y-(yMax-1)/2.0f : y-yMax/2.0f;
+      ys[y] = yc[y];
+      if (ys[y]<-yMaxFov/2)
+        ys[y] += yMaxFov;
+      else if (ys[y]>=yMaxFov/2)
+        ys[y] -= yMaxFov;
+    }
+
+    // pixel weights (signal scale and coil sensitivity)
+    std::vector< ScalarType > weights(xMax*yMax, m_Parameters->m_SignalGen.m_SignalScale);
+    if (m_Parameters->m_SignalGen.m_CoilSensitivityProfile!=SignalGenerationParameters::COIL_CONSTANT)
+      for (int y=0; y<yMax; ++y)
+        for (int x=0; x<xMax; ++x)
+        {
+          VectorType pos; pos[0] = xs[x]; pos[1] = yc[y]; pos[2] = m_Z;
+          pos = m_Transform*pos/1000;
+          weights[y*xMax+x] *= CoilSensitivity(pos);
+        }
+
+    // twiddle tables; even and odd k-space lines are shifted in opposite directions by the ghosting offset
+    int numShifts = offset!=0 ? 2 : 1;
+    std::vector< std::vector< vcl_complex<ScalarType> > > ex(numShifts, std::vector< vcl_complex<ScalarType> >(kxMax*xMax));
+    for (int v=0; v<numShifts; ++v)
+      for (int kx=0; kx<kxMax; ++kx)
+      {
+        float k = kxMax%2==1 ? kx-(kxMax-1)/2.0f : kx-kxMax/2.0f;
+        k += v==0 ? offset : -offset;
+        for (int x=0; x<xMax; ++x)
+          ex[v][kx*xMax+x] = std::exp( std::complex<ScalarType>(0, 2 * itk::Math::pi * k*xs[x]/xMax) );
+      }
+    std::vector< vcl_complex<ScalarType> > ey(kyMax*yMax);
+    for (int ky=0; ky<kyMax; ++ky)
+    {
+      float k = kyMax%2==1 ? ky-(kyMax-1)/2.0f : ky-kyMax/2.0f;
+      for (int y=0; y<yMax; ++y)
+        ey[ky*yMax+y] = std::exp( std::complex<ScalarType>(0, 2 * itk::Math::pi * k*ys[y]/yMaxFov) );
+    }
+
+    m_CompartmentSpectra.assign(numShifts, std::vector< std::vector< vcl_complex<ScalarType> > >(m_CompartmentImages.size()));
+    std::vector< vcl_complex<ScalarType> > rows(kxMax*yMax);
+    std::vector< ScalarType > f(xMax);
+    for (unsigned int i=0; i<m_CompartmentImages.size(); ++i)
+    {
+      typename InputImageType::IndexType idx;
+      for (int v=0; v<numShifts; ++v)
+      {
+        // transform along x
+        for (int y=0; y<yMax; ++y)
+        {
+          idx[1] = y;
+          for (int x=0; x<xMax; ++x)
+          {
+            idx[0] = x;
+            f[x] = m_CompartmentImages.at(i)->GetPixel(idx)*weights[y*xMax+x];
+          }
+          for (int kx=0; kx<kxMax; ++kx)
+          {
+            const vcl_complex<ScalarType>* e = &ex[v][kx*xMax];
+            vcl_complex<ScalarType> s(0,0);
+            for (int x=0; x<xMax; ++x)
+              s += f[x]*e[x];
+            rows[kx*yMax+y] = s;
+          }
+        }
+
+        // transform along y
+        std::vector< vcl_complex<ScalarType> >& spectrum = m_CompartmentSpectra[v][i];
+        spectrum.resize(kxMax*kyMax);
+        for (int ky=0; ky<kyMax; ++ky)
+        {
+          const vcl_complex<ScalarType>* e = &ey[ky*yMax];
+          for (int kx=0; kx<kxMax; ++kx)
+          {
+            const vcl_complex<ScalarType>* r = &rows[kx*yMax];
+            vcl_complex<ScalarType> s(0,0);
+            for (int y=0; y<yMax; ++y)
+              s += r[y]*e[y];
+            spectrum[ky*kxMax+kx] = s;
+          }
+        }
+      }
+    }
   }
 
   template< class ScalarType >
@@ -241,65 +351,79 @@ namespace itk {
           kx += m_Parameters->m_SignalGen.m_KspaceLineOffset;
 
         vcl_complex<ScalarType> s(0,0);
-        InputIteratorType it(m_CompartmentImages.at(0), m_CompartmentImages.at(0)->GetLargestPossibleRegion() );
-        while( !it.IsAtEnd() )
+        if (m_UseSeparableTransform)
         {
-          typename InputImageType::IndexType input_idx = it.GetIndex();
-          float x = input_idx[0];
-          float y = input_idx[1];
-          if ((int)xMax%2==1){ x -= (xMax-1)/2; }
-          else{ x -= xMax/2; }
-          if ((int)yMax%2==1){ y -= (yMax-1)/2; }
-          else{ y -= yMax/2; }
-
-          VectorType pos; pos[0] = x; pos[1] = y; pos[2] = m_Z;
-          pos = m_Transform*pos/1000;   // vector from image center to current position (in meter)
-
-          vcl_complex<ScalarType> f(0, 0);
-
-          // sum compartment signals and simulate relaxation
+          // odd lines use the negative line offset
+          const unsigned int v = std::min<std::size_t>(out_idx[1]%2, m_CompartmentSpectra.size()-1);
+          const std::size_t k = kIdx[1]*(int)kxMax + kIdx[0];
           for (unsigned int i=0; i<m_CompartmentImages.size(); i++)
             if ( m_Parameters->m_SignalGen.m_DoSimulateRelaxation)
-              f += std::complex<ScalarType>( m_CompartmentImages.at(i)->GetPixel(it.GetIndex()) * relaxFactor.at(i) *  m_Parameters->m_SignalGen.m_SignalScale, 0);
+              s += m_CompartmentSpectra[v][i][k] * static_cast<ScalarType>(relaxFactor.at(i));
             else
-              f += std::complex<ScalarType>( m_CompartmentImages.at(i)->GetPixel(it.GetIndex()) * m_Parameters->m_SignalGen.m_SignalScale, 0);
-
-          if (m_Parameters->m_SignalGen.m_CoilSensitivityProfile!=SignalGenerationParameters::COIL_CONSTANT)
-            f *= CoilSensitivity(pos);
-
-          // simulate eddy currents and other distortions
-          float omega = 0;   // frequency offset
-          if (  m_Parameters->m_SignalGen.m_EddyStrength>0 && m_Parameters->m_Misc.m_CheckAddEddyCurrentsBox && !m_IsBaseline)
-          {
-            omega += (m_DiffusionGradientDirection[0]*pos[0]+m_DiffusionGradientDirection[1]*pos[1]+m_DiffusionGradientDirection[2]*pos[2]) * eddyDecay;
-          }
-
-          if (m_Parameters->m_SignalGen.m_FrequencyMap.IsNotNull()) // simulate distortions
+              s += m_CompartmentSpectra[v][i][k];
+        }
+        else
+        {
+          InputIteratorType it(m_CompartmentImages.at(0), m_CompartmentImages.at(0)->GetLargestPossibleRegion() );
+          while( !it.IsAtEnd() )
           {
-            itk::Point<double, 3> point3D;
-            itk::Image<float, 3>::IndexType index; index[0] = input_idx[0]; index[1] = input_idx[1]; index[2] = m_Zidx;
-            if (m_Parameters->m_SignalGen.m_DoAddMotion)    // we have to account for the head motion since this also moves our frequency map
+            typename InputImageType::IndexType input_idx = it.GetIndex();
+            float x = input_idx[0];
+            float y = input_idx[1];
+            if ((int)xMax%2==1){ x -= (xMax-1)/2; }
+            else{ x -= xMax/2; }
+            if ((int)yMax%2==1){ y -= (yMax-1)/2; }
+            else{ y -= yMax/2; }
+
+            VectorType pos; pos[0] = x; pos[1] = y; pos[2] = m_Z;
+            pos = m_Transform*pos/1000;   // vector from image center to current position (in meter)
+
+            vcl_complex<ScalarType> f(0, 0);
+
+            // sum compartment signals and simulate relaxation
+            for (unsigned int i=0; i<m_CompartmentImages.size(); i++)
+              if ( m_Parameters->m_SignalGen.m_DoSimulateRelaxation)
+                f += std::complex<ScalarType>( m_CompartmentImages.at(i)->GetPixel(it.GetIndex()) * relaxFactor.at(i) *  m_Parameters->m_SignalGen.m_SignalScale, 0);
+              else
+                f += std::complex<ScalarType>( m_CompartmentImages.at(i)->GetPixel(it.GetIndex()) * m_Parameters->m_SignalGen.m_SignalScale, 0);
+
+            if (m_Parameters->m_SignalGen.m_CoilSensitivityProfile!=SignalGenerationParameters::COIL_CONSTANT)
+              f *= CoilSensitivity(pos);
+
+            // simulate eddy currents and other distortions
+            float omega = 0;   // frequency offset
+            if (  m_Parameters->m_SignalGen.m_EddyStrength>0 && m_Parameters->m_Misc.m_CheckAddEddyCurrentsBox && !m_IsBaseline)
             {
-              m_Parameters->m_SignalGen.m_FrequencyMap->TransformIndexToPhysicalPoint(index, point3D);
-              point3D = m_FiberBundle->TransformPoint( point3D.GetVnlVector(), -m_Rotation[0], -m_Rotation[1], -m_Rotation[2], -m_Translation[0], -m_Translation[1], -m_Translation[2] );
-              omega += mitk::imv::GetImageValue<float>(point3D, true, m_FmapInterpolator);
+              omega += (m_DiffusionGradientDirection[0]*pos[0]+m_DiffusionGradientDirection[1]*pos[1]+m_DiffusionGradientDirection[2]*pos[2]) * eddyDecay;
             }
-            else
+
+            if (m_Parameters->m_SignalGen.m_FrequencyMap.IsNotNull()) // simulate distortions
             {
-              omega += m_Parameters->m_SignalGen.m_FrequencyMap->GetPixel(index);
+              itk::Point<double, 3> point3D;
+              itk::Image<float, 3>::IndexType index; index[0] = input_idx[0]; index[1] = input_idx[1]; index[2] = m_Zidx;
+              if (m_Parameters->m_SignalGen.m_DoAddMotion)    // we have to account for the head motion since this also moves our frequency map
+              {
+                m_Parameters->m_SignalGen.m_FrequencyMap->TransformIndexToPhysicalPoint(index, point3D);
+                point3D = m_FiberBundle->TransformPoint( point3D.GetVnlVector(), -m_Rotation[0], -m_Rotation[1], -m_Rotation[2], -m_Translation[0], -m_Translation[1], -m_Translation[2] );
+                omega += mitk::imv::GetImageValue<float>(point3D, true, m_FmapInterpolator);
+              }
+              else
+              {
+                omega += m_Parameters->m_SignalGen.m_FrequencyMap->GetPixel(index);
+              }
             }
-          }
 
-          // if signal comes from outside FOV, mirror it back (wrap-around artifact - aliasing)
-          if (y<-yMaxFov/2)
-            y += yMaxFov;
-          else if (y>=yMaxFov/2)
-            y -= yMaxFov;
+            // if signal comes from outside FOV, mirror it back (wrap-around artifact - aliasing)
+            if (y<-yMaxFov/2)
+              y += yMaxFov;
+            else if (y>=yMaxFov/2)
+              y -= yMaxFov;
 
-          // actual DFT term
-          s += f * std::exp( std::complex<ScalarType>(0, 2 * itk::Math::pi * (kx*x/xMax + ky*y/yMaxFov + omega*t/1000 )) );
+            // actual DFT term
+            s += f * std::exp( std::complex<ScalarType>(0, 2 * itk::Math::pi * (kx*x/xMax + ky*y/yMaxFov + omega*t/1000 )) );
 
-          ++it;
+            ++it;
+          }
         }
         s /= numPix;
 
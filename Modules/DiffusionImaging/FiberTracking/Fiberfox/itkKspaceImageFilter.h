@@ -42,7 +42,9 @@ namespace itk{
 * - Image distortions (off-frequency effects)
 * - Gibbs ringing
 * - Eddy current effects
-* Based on a discrete fourier transformation.
+* Based on a discrete fourier transformation. If no off-resonance effects (eddy currents, frequency map) are simulated,
+* the transform is separable and the compartment spectra are computed row/column wise from precomputed twiddle tables.
+* Otherwise every k-space sample is computed with the full DFT sum.
 * See "Fiberfox: Facilitating the creation of realistic white matter software phantoms" (DOI: 10.1002/mrm.25045) for details.
 */
 
@@ -96,6 +98,7 @@ namespace itk{
     ~KspaceImageFilter() override {}
 
     float CoilSensitivity(VectorType& pos);
+    void CalculateCompartmentSpectra();   ///< Separable DFT of all compartment images, only valid without off-resonance effects.
 
     void BeforeThreadedGenerateData() override;
     void ThreadedGenerateData( const OutputImageRegionType &outputRegionForThread, ThreadIdType threadID) override;
@@ -127,6 +130,9 @@ namespace itk{
     typename InputImageType::Pointer        m_ReadoutTimeImage;
     AcquisitionType*                        m_ReadoutScheme;
 
+    bool                                    m_UseSeparableTransform;
+    std::vector< std::vector< std::vector< vcl_complex<ScalarType> > > > m_CompartmentSpectra;  ///< [line offset sign][compartment][ky*kxMax+kx]
+
     itk::LinearInterpolateImageFunction< itk::Image< float, 3 >, float >::Pointer   m_FmapInterpolator;
 
   private:
@@ -40,6 +40,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <iostream>
 #include <fstream>
 #include <exception>
+#include <algorithm>
 #include <itkImageDuplicator.h>
 #include <itksys/SystemTools.hxx>
 #include <mitkIOUtil.h>
@@ -63,6 +64,8 @@ TractsToDWIImageFilter< PixelType >::TractsToDWIImageFilter()
   : m_FiberBundle(nullptr)
   , m_StatusText("")
   , m_UseConstantRandSeed(false)
+  , m_NumberOfStreamedVolumes(0)
+  , m_VolumesPerBlock(0)
   , m_RandGen(itk::Statistics::MersenneTwisterRandomVariateGenerator::New())
 {
   m_RandGen->SetSeed();
@@ -78,9 +81,11 @@ TractsToDWIImageFilter< PixelType >::~TractsToDWIImageFilter()
 
 template< class PixelType >
 TractsToDWIImageFilter< PixelType >::DoubleDwiType::Pointer TractsToDWIImageFilter< PixelType >::
-SimulateKspaceAcquisition( std::vector< DoubleDwiType::Pointer >& compartment_images )
+SimulateKspaceAcquisition( std::vector< DoubleDwiType::Pointer >& compartment_images, unsigned int firstVolume )
 {
   unsigned int numFiberCompartments = m_Parameters.m_FiberModelList.size();
+  const unsigned int numVolumes = compartment_images.at(0)->GetVectorLength();
+  const bool allVolumes = numVolumes==m_Parameters.m_SignalGen.GetNumVolumes();
   // create slice object
   ImageRegion<2> sliceRegion;
   sliceRegion.SetSize(0, m_WorkingImageRegion.GetSize()[0]);
@@ -89,7 +94,7 @@ SimulateKspaceAcquisition( std::vector< DoubleDwiType::Pointer >& compartment_im
   sliceSpacing[0] = m_WorkingSpacing[0];
   sliceSpacing[1] = m_WorkingSpacing[1];
 
-  DoubleDwiType::PixelType nullPix; nullPix.SetSize(compartment_images.at(0)->GetVectorLength()); nullPix.Fill(0.0);
+  DoubleDwiType::PixelType nullPix; nullPix.SetSize(numVolumes); nullPix.Fill(0.0);
   auto magnitudeDwiImage = DoubleDwiType::New();
   magnitudeDwiImage->SetSpacing( m_Parameters.m_SignalGen.m_ImageSpacing );
   magnitudeDwiImage->SetOrigin( m_Parameters.m_SignalGen.m_ImageOrigin );
@@ -97,37 +102,45 @@ SimulateKspaceAcquisition( std::vector< DoubleDwiType::Pointer >& compartment_im
   magnitudeDwiImage->SetLargestPossibleRegion( m_Parameters.m_SignalGen.m_CroppedRegion );
   magnitudeDwiImage->SetBufferedRegion( m_Parameters.m_SignalGen.m_CroppedRegion );
   magnitudeDwiImage->SetRequestedRegion( m_Parameters.m_SignalGen.m_CroppedRegion );
-  magnitudeDwiImage->SetVectorLength( compartment_images.at(0)->GetVectorLength() );
+  magnitudeDwiImage->SetVectorLength( numVolumes );
   magnitudeDwiImage->Allocate();
   magnitudeDwiImage->FillBuffer(nullPix);
 
-  m_PhaseImage = DoubleDwiType::New();
-  m_PhaseImage->SetSpacing( m_Parameters.m_SignalGen.m_ImageSpacing );
-  m_PhaseImage->SetOrigin( m_Parameters.m_SignalGen.m_ImageOrigin );
-  m_PhaseImage->SetDirection( m_Parameters.m_SignalGen.m_ImageDirection );
-  m_PhaseImage->SetLargestPossibleRegion( m_Parameters.m_SignalGen.m_CroppedRegion );
-  m_PhaseImage->SetBufferedRegion( m_Parameters.m_SignalGen.m_CroppedRegion );
-  m_PhaseImage->SetRequestedRegion( m_Parameters.m_SignalGen.m_CroppedRegion );
-  m_PhaseImage->SetVectorLength( compartment_images.at(0)->GetVectorLength() );
-  m_PhaseImage->Allocate();
-  m_PhaseImage->FillBuffer(nullPix);
-
-  m_KspaceImage = DoubleDwiType::New();
-  m_KspaceImage->SetSpacing( m_Parameters.m_SignalGen.m_ImageSpacing );
-  m_KspaceImage->SetOrigin( m_Parameters.m_SignalGen.m_ImageOrigin );
-  m_KspaceImage->SetDirection( m_Parameters.m_SignalGen.m_ImageDirection );
-  m_KspaceImage->SetLargestPossibleRegion( m_Parameters.m_SignalGen.m_CroppedRegion );
-  m_KspaceImage->SetBufferedRegion( m_Parameters.m_SignalGen.m_CroppedRegion );
-  m_KspaceImage->SetRequestedRegion( m_Parameters.m_SignalGen.m_CroppedRegion );
-  m_KspaceImage->SetVectorLength( m_Parameters.m_SignalGen.m_NumberOfCoils );
-  m_KspaceImage->Allocate();
-  m_KspaceImage->FillBuffer(nullPix);
-
-  std::vector< unsigned int > spikeVolume;
-  for (unsigned int i=0; i<m_Parameters.m_SignalGen.m_Spikes; i++)
-    spikeVolume.push_back(m_RandGen->GetIntegerVariate()%(compartment_images.at(0)->GetVectorLength()));
-  std::sort (spikeVolume.begin(), spikeVolume.end());
-  std::reverse (spikeVolume.begin(), spikeVolume.end());
+  // the phase image holds all volumes and is only generated if they are simulated at once
+  m_PhaseImage = nullptr;
+  if (allVolumes)
+  {
+    m_PhaseImage = DoubleDwiType::New();
+    m_PhaseImage->SetSpacing( m_Parameters.m_SignalGen.m_ImageSpacing );
+    m_PhaseImage->SetOrigin( m_Parameters.m_SignalGen.m_ImageOrigin );
+    m_PhaseImage->SetDirection( m_Parameters.m_SignalGen.m_ImageDirection );
+    m_PhaseImage->SetLargestPossibleRegion( m_Parameters.m_SignalGen.m_CroppedRegion );
+    m_PhaseImage->SetBufferedRegion( m_Parameters.m_SignalGen.m_CroppedRegion );
+    m_PhaseImage->SetRequestedRegion( m_Parameters.m_SignalGen.m_CroppedRegion );
+    m_PhaseImage->SetVectorLength( numVolumes );
+    m_PhaseImage->Allocate();
+    m_PhaseImage->FillBuffer(nullPix);
+  }
+
+  // k-space of the first volume and volumes containing spikes are determined with the first block
+  if (firstVolume==0)
+  {
+    DoubleDwiType::PixelType nullCoilPix; nullCoilPix.SetSize(m_Parameters.m_SignalGen.m_NumberOfCoils); nullCoilPix.Fill(0.0);
+    m_KspaceImage = DoubleDwiType::New();
+    m_KspaceImage->SetSpacing( m_Parameters.m_SignalGen.m_ImageSpacing );
+    m_KspaceImage->SetOrigin( m_Parameters.m_SignalGen.m_ImageOrigin );
+    m_KspaceImage->SetDirection( m_Parameters.m_SignalGen.m_ImageDirection );
+    m_KspaceImage->SetLargestPossibleRegion( m_Parameters.m_SignalGen.m_CroppedRegion );
+    m_KspaceImage->SetBufferedRegion( m_Parameters.m_SignalGen.m_CroppedRegion );
+    m_KspaceImage->SetRequestedRegion( m_Parameters.m_SignalGen.m_CroppedRegion );
+    m_KspaceImage->SetVectorLength( m_Parameters.m_SignalGen.m_NumberOfCoils );
+    m_KspaceImage->Allocate();
+    m_KspaceImage->FillBuffer(nullCoilPix);
+
+    m_SpikeVolumes.clear();
+    for (unsigned int i=0; i<m_Parameters.m_SignalGen.m_Spikes; i++)
+      m_SpikeVolumes.push_back(m_RandGen->GetIntegerVariate()%m_Parameters.m_SignalGen.GetNumVolumes());
+  }
 
   // calculate coil positions
   double a = m_Parameters.m_SignalGen.m_ImageRegion.GetSize(0)*m_Parameters.m_SignalGen.m_ImageSpacing[0];
@@ -161,21 +174,21 @@ SimulateKspaceAcquisition( std::vector< DoubleDwiType::Pointer >& compartment_im
   PrintToLog("|----|----|----|----|----|----|----|----|----|----|\n*", false, false, false);
   unsigned long lastTick = 0;
 
-  boost::progress_display disp(compartment_images.at(0)->GetVectorLength()*compartment_images.at(0)->GetLargestPossibleRegion().GetSize(2));
+  boost::progress_display disp(numVolumes*compartment_images.at(0)->GetLargestPossibleRegion().GetSize(2));
 
 #pragma omp parallel for
-  for (int g=0; g<(int)compartment_images.at(0)->GetVectorLength(); g++)
+  for (int channel=0; channel<(int)numVolumes; channel++)
   {
     if (this->GetAbortGenerateData())
       continue;
 
+    const int g = firstVolume+channel;   // volume simulated in this channel of the compartment images
+
     std::vector< unsigned int > spikeSlice;
 #pragma omp critical
-    while (!spikeVolume.empty() && (int)spikeVolume.back()==g)
-    {
-      spikeSlice.push_back(m_RandGen->GetIntegerVariate()%compartment_images.at(0)->GetLargestPossibleRegion().GetSize(2));
-      spikeVolume.pop_back();
-    }
+    for (unsigned int spikeVolume : m_SpikeVolumes)
+      if ((int)spikeVolume==g)
+        spikeSlice.push_back(m_RandGen->GetIntegerVariate()%compartment_images.at(0)->GetLargestPossibleRegion().GetSize(2));
     std::sort (spikeSlice.begin(), spikeSlice.end());
     std::reverse (spikeSlice.begin(), spikeSlice.end());
 
@@ -208,7 +221,7 @@ SimulateKspaceAcquisition( std::vector< DoubleDwiType::Pointer >& compartment_im
             Float2DImageType::IndexType index2D; index2D[0]=x; index2D[1]=y;
             DoubleDwiType::IndexType index3D; index3D[0]=x; index3D[1]=y; index3D[2]=z;
 
-            slice->SetPixel(index2D, compartment_images.at(i)->GetPixel(index3D)[g]);
+            slice->SetPixel(index2D, compartment_images.at(i)->GetPixel(index3D)[channel]);
           }
 
         compartment_slices.push_back(slice);
@@ -279,32 +292,36 @@ SimulateKspaceAcquisition( std::vector< DoubleDwiType::Pointer >& compartment_im
             if (cPix.real()!=0)
               phase = atan( cPix.imag()/cPix.real() );
 
-            DoubleDwiType::PixelType real_pix = m_OutputImagesReal.at(c)->GetPixel(index3D);
-            real_pix[g] = cPix.real();
-            m_OutputImagesReal.at(c)->SetPixel(index3D, real_pix);
+            if (!m_OutputImagesReal.empty())
+            {
+              DoubleDwiType::PixelType real_pix = m_OutputImagesReal.at(c)->GetPixel(index3D);
+              real_pix[g] = cPix.real();
+              m_OutputImagesReal.at(c)->SetPixel(index3D, real_pix);
 
-            DoubleDwiType::PixelType imag_pix = m_OutputImagesImag.at(c)->GetPixel(index3D);
-            imag_pix[g] = cPix.imag();
-            m_OutputImagesImag.at(c)->SetPixel(index3D, imag_pix);
+              DoubleDwiType::PixelType imag_pix = m_OutputImagesImag.at(c)->GetPixel(index3D);
+              imag_pix[g] = cPix.imag();
+              m_OutputImagesImag.at(c)->SetPixel(index3D, imag_pix);
+            }
 
             DoubleDwiType::PixelType dwiPix = magnitudeDwiImage->GetPixel(index3D);
-            DoubleDwiType::PixelType phasePix = m_PhaseImage->GetPixel(index3D);
-
             if (m_Parameters.m_SignalGen.m_NumberOfCoils>1)
-            {
-              dwiPix[g] += magn*magn;
-              phasePix[g] += phase*phase;
-            }
+              dwiPix[channel] += magn*magn;
             else
-            {
-              dwiPix[g] = magn;
-              phasePix[g] = phase;
-            }
+              dwiPix[channel] = magn;
 
             //#pragma omp critical
             {
               magnitudeDwiImage->SetPixel(index3D, dwiPix);
-              m_PhaseImage->SetPixel(index3D, phasePix);
+
+              if (m_PhaseImage.IsNotNull())
+              {
+                DoubleDwiType::PixelType phasePix = m_PhaseImage->GetPixel(index3D);
+                if (m_Parameters.m_SignalGen.m_NumberOfCoils>1)
+                  phasePix[g] += phase*phase;
+                else
+                  phasePix[g] = phase;
+                m_PhaseImage->SetPixel(index3D, phasePix);
+              }
 
               // k-space image
               if (g==0)
@@ -324,15 +341,18 @@ SimulateKspaceAcquisition( std::vector< DoubleDwiType::Pointer >& compartment_im
           {
             DoubleDwiType::IndexType index3D; index3D[0]=x; index3D[1]=y; index3D[2]=z;
             DoubleDwiType::PixelType magPix = magnitudeDwiImage->GetPixel(index3D);
-            magPix[g] = sqrt(magPix[g]/m_Parameters.m_SignalGen.m_NumberOfCoils);
-
-            DoubleDwiType::PixelType phasePix = m_PhaseImage->GetPixel(index3D);
-            phasePix[g] = sqrt(phasePix[g]/m_Parameters.m_SignalGen.m_NumberOfCoils);
+            magPix[channel] = sqrt(magPix[channel]/m_Parameters.m_SignalGen.m_NumberOfCoils);
 
             //#pragma omp critical
             {
               magnitudeDwiImage->SetPixel(index3D, magPix);
-              m_PhaseImage->SetPixel(index3D, phasePix);
+
+              if (m_PhaseImage.IsNotNull())
+              {
+                DoubleDwiType::PixelType phasePix = m_PhaseImage->GetPixel(index3D);
+                phasePix[g] = sqrt(phasePix[g]/m_Parameters.m_SignalGen.m_NumberOfCoils);
+                m_PhaseImage->SetPixel(index3D, phasePix);
+              }
             }
           }
       }
@@ -522,10 +542,10 @@ void TractsToDWIImageFilter< PixelType >::InitializeData()
   temp.Fill(0.0);
   m_OutputImage->FillBuffer(temp);
 
-  // images containing real and imaginary part of the dMRI signal for each coil
+  // images containing real and imaginary part of the dMRI signal for each coil (not generated when streaming volumes)
   m_OutputImagesReal.clear();
   m_OutputImagesImag.clear();
-  for (int i=0; i<m_Parameters.m_SignalGen.m_NumberOfCoils; ++i)
+  for (int i=0; i<m_Parameters.m_SignalGen.m_NumberOfCoils && m_VolumesPerBlock==m_Parameters.m_SignalGen.GetNumVolumes(); ++i)
   {
     typename DoubleDwiType::Pointer outputImageReal = DoubleDwiType::New();
     outputImageReal->SetSpacing( m_Parameters.m_SignalGen.m_ImageSpacing );
@@ -572,26 +592,7 @@ void TractsToDWIImageFilter< PixelType >::InitializeData()
   m_VoxelVolume = m_WorkingSpacing[0]*m_WorkingSpacing[1]*m_WorkingSpacing[2];
 
   // generate double images to store the individual compartment signals
-  m_CompartmentImages.clear();
-  int numFiberCompartments = m_Parameters.m_FiberModelList.size();
-  int numNonFiberCompartments = m_Parameters.m_NonFiberModelList.size();
-  for (int i=0; i<numFiberCompartments+numNonFiberCompartments; i++)
-  {
-    auto doubleDwi = DoubleDwiType::New();
-    doubleDwi->SetSpacing( m_WorkingSpacing );
-    doubleDwi->SetOrigin( m_WorkingOrigin );
-    doubleDwi->SetDirection( m_Parameters.m_SignalGen.m_ImageDirection );
-    doubleDwi->SetLargestPossibleRegion( m_WorkingImageRegion );
-    doubleDwi->SetBufferedRegion( m_WorkingImageRegion );
-    doubleDwi->SetRequestedRegion( m_WorkingImageRegion );
-    doubleDwi->SetVectorLength( m_Parameters.m_SignalGen.GetNumVolumes() );
-    doubleDwi->Allocate();
-    DoubleDwiType::PixelType pix;
-    pix.SetSize(m_Parameters.m_SignalGen.GetNumVolumes());
-    pix.Fill(0.0);
-    doubleDwi->FillBuffer(pix);
-    m_CompartmentImages.push_back(doubleDwi);
-  }
+  InitializeCompartmentImages(m_VolumesPerBlock);
 
   if (m_FiberBundle.IsNull() && m_InputImage.IsNotNull())
   {
@@ -775,6 +776,32 @@ void TractsToDWIImageFilter< PixelType >::InitializeData()
   m_UpsampledMaskImage = upsampler->GetOutput();
 }
 
+template< class PixelType >
+void TractsToDWIImageFilter< PixelType >::InitializeCompartmentImages(unsigned int numVolumes)
+{
+  // release the images of the previous block before allocating the new ones
+  m_CompartmentImages.clear();
+  int numFiberCompartments = m_Parameters.m_FiberModelList.size();
+  int numNonFiberCompartments = m_Parameters.m_NonFiberModelList.size();
+  for (int i=0; i<numFiberCompartments+numNonFiberCompartments; i++)
+  {
+    auto doubleDwi = DoubleDwiType::New();
+    doubleDwi->SetSpacing( m_WorkingSpacing );
+    doubleDwi->SetOrigin( m_WorkingOrigin );
+    doubleDwi->SetDirection( m_Parameters.m_SignalGen.m_ImageDirection );
+    doubleDwi->SetLargestPossibleRegion( m_WorkingImageRegion );
+    doubleDwi->SetBufferedRegion( m_WorkingImageRegion );
+    doubleDwi->SetRequestedRegion( m_WorkingImageRegion );
+    doubleDwi->SetVectorLength( numVolumes );
+    doubleDwi->Allocate();
+    DoubleDwiType::PixelType pix;
+    pix.SetSize(numVolumes);
+    pix.Fill(0.0);
+    doubleDwi->FillBuffer(pix);
+    m_CompartmentImages.push_back(doubleDwi);
+  }
+}
+
 template< class PixelType >
 void TractsToDWIImageFilter< PixelType >::InitializeFiberData()
 {
@@ -948,375 +975,262 @@ bool TractsToDWIImageFilter< PixelType >::PrepareLogFile()
 
 
 template< class PixelType >
-void TractsToDWIImageFilter< PixelType >::GenerateData()
+void TractsToDWIImageFilter< PixelType >::SimulateDiffusionSignal(unsigned int firstVolume, unsigned int numVolumes, int signalModelSeed)
 {
-  // prepare logfile
-  if ( ! PrepareLogFile() )
-  {
-    this->SetAbortGenerateData( true );
-    return;
-  }
-
-  m_TimeProbe.Start();
-
-  // check input data
-  if (m_FiberBundle.IsNull() && m_InputImage.IsNull())
-    itkExceptionMacro("Input fiber bundle and input diffusion-weighted image is nullptr!");
-
-  if (m_Parameters.m_FiberModelList.empty() && m_InputImage.IsNull())
-    itkExceptionMacro("No diffusion model for fiber compartments defined and input diffusion-weighted"
-                      " image is nullptr! At least one fiber compartment is necessary to simulate diffusion.");
-
-  if (m_Parameters.m_NonFiberModelList.empty() && m_InputImage.IsNull())
-    itkExceptionMacro("No diffusion model for non-fiber compartments defined and input diffusion-weighted"
-                      " image is nullptr! At least one non-fiber compartment is necessary to simulate diffusion.");
+  int numFiberCompartments = m_Parameters.m_FiberModelList.size();
 
-  if (m_Parameters.m_SignalGen.m_DoDisablePartialVolume)  // no partial volume? remove all but first fiber compartment
-    while (m_Parameters.m_FiberModelList.size()>1)
-      m_Parameters.m_FiberModelList.pop_back();
+  double maxVolume = 0;
+  unsigned long lastTick = 0;
 
-  //    int baselineIndex = m_Parameters.m_SignalGen.GetFirstBaselineIndex();
-  //    if (baselineIndex<0) { itkExceptionMacro("No baseline index found!"); }
+  int numFibers = m_FiberBundleWorkingCopy->GetNumFibers();
+  boost::progress_display disp(numFibers*numVolumes);
 
-  if (!m_Parameters.m_SignalGen.m_SimulateKspaceAcquisition)  // No upsampling of input image needed if no k-space simulation is performed
-    m_Parameters.m_SignalGen.m_DoAddGibbsRinging = false;
+  if (m_FiberBundle->GetMeanFiberLength()<5.0)
+    omp_set_num_threads(2);
 
-  if (m_UseConstantRandSeed)  // always generate the same random numbers?
-    m_RandGen->SetSeed(0);
-  else
-    m_RandGen->SetSeed();
+  PrintToLog("0%   10   20   30   40   50   60   70   80   90   100%", false, true, false);
+  PrintToLog("|----|----|----|----|----|----|----|----|----|----|\n*", false, false, false);
 
-  InitializeData();
-  if ( m_FiberBundle.IsNotNull() )    // if no fiber bundle is found, we directly proceed to the k-space acquisition simulation
+  for (unsigned int g=firstVolume; g<firstVolume+numVolumes; ++g)
   {
-    CheckVolumeFractionImages();
-    InitializeFiberData();
-
-    int numFiberCompartments = m_Parameters.m_FiberModelList.size();
-    int numNonFiberCompartments = m_Parameters.m_NonFiberModelList.size();
-
-    double maxVolume = 0;
-    unsigned long lastTick = 0;
-    int signalModelSeed = m_RandGen->GetIntegerVariate();
+    const unsigned int channel = g-firstVolume;   // channel of volume g in the compartment images
+    // move fibers
+    SimulateMotion(g);
+
+    // Set signal model random generator seeds to get same configuration in each voxel
+    for (std::size_t i=0; i<m_Parameters.m_FiberModelList.size(); i++)
+      m_Parameters.m_FiberModelList.at(i)->SetSeed(signalModelSeed);
+    for (std::size_t i=0; i<m_Parameters.m_NonFiberModelList.size(); i++)
+      m_Parameters.m_NonFiberModelList.at(i)->SetSeed(signalModelSeed);
+
+    // storing voxel-wise intra-axonal volume in mm³
+    auto intraAxonalVolumeImage = ItkDoubleImgType::New();
+    intraAxonalVolumeImage->SetSpacing( m_WorkingSpacing );
+    intraAxonalVolumeImage->SetOrigin( m_WorkingOrigin );
+    intraAxonalVolumeImage->SetDirection( m_Parameters.m_SignalGen.m_ImageDirection );
+    intraAxonalVolumeImage->SetLargestPossibleRegion( m_WorkingImageRegion );
+    intraAxonalVolumeImage->SetBufferedRegion( m_WorkingImageRegion );
+    intraAxonalVolumeImage->SetRequestedRegion( m_WorkingImageRegion );
+    intraAxonalVolumeImage->Allocate();
+    intraAxonalVolumeImage->FillBuffer(0);
+    maxVolume = 0;
 
-    PrintToLog("\n", false, false);
-    PrintToLog("Generating " + boost::lexical_cast<std::string>(numFiberCompartments+numNonFiberCompartments)
-               + "-compartment diffusion-weighted signal.");
-
-    std::vector< int > bVals = m_Parameters.m_SignalGen.GetBvalues();
-    PrintToLog("b-values: ", false, false, true);
-    for (auto v : bVals)
-      PrintToLog(boost::lexical_cast<std::string>(v) + " ", false, false, true);
-    PrintToLog("\n", false, false, true);
-    PrintToLog("\n", false, false, true);
+    if (this->GetAbortGenerateData())
+      continue;
 
-    int numFibers = m_FiberBundleWorkingCopy->GetNumFibers();
-    boost::progress_display disp(numFibers*m_Parameters.m_SignalGen.GetNumVolumes());
+    vtkPolyData* fiberPolyData = m_FiberBundleTransformed->GetFiberPolyData();
+    // generate fiber signal (if there are any fiber models present)
+    if (!m_Parameters.m_FiberModelList.empty())
+    {
+#pragma omp parallel for
+      for( int i=0; i<numFibers; i++ )
+      {
+        if (this->GetAbortGenerateData())
+          continue;
 
-    if (m_FiberBundle->GetMeanFiberLength()<5.0)
-      omp_set_num_threads(2);
+        float fiberWeight = m_FiberBundleTransformed->GetFiberWeight(i);
 
-    PrintToLog("0%   10   20   30   40   50   60   70   80   90   100%", false, true, false);
-    PrintToLog("|----|----|----|----|----|----|----|----|----|----|\n*", false, false, false);
+        int numPoints = -1;
+        std::vector< itk::Vector<double, 3> > points_copy;
+#pragma omp critical
+        {
+          vtkCell* cell = fiberPolyData->GetCell(i);
+          numPoints = cell->GetNumberOfPoints();
+          vtkPoints* points = cell->GetPoints();
+          for (int j=0; j<numPoints; j++)
+            points_copy.push_back(GetItkVector(points->GetPoint(j)));
+        }
 
-    for (unsigned int g=0; g<m_Parameters.m_SignalGen.GetNumVolumes(); ++g)
-    {
-      // move fibers
-      SimulateMotion(g);
-
-      // Set signal model random generator seeds to get same configuration in each voxel
-      for (std::size_t i=0; i<m_Parameters.m_FiberModelList.size(); i++)
-        m_Parameters.m_FiberModelList.at(i)->SetSeed(signalModelSeed);
-      for (std::size_t i=0; i<m_Parameters.m_NonFiberModelList.size(); i++)
-        m_Parameters.m_NonFiberModelList.at(i)->SetSeed(signalModelSeed);
-
-      // storing voxel-wise intra-axonal volume in mm³
-      auto intraAxonalVolumeImage = ItkDoubleImgType::New();
-      intraAxonalVolumeImage->SetSpacing( m_WorkingSpacing );
-      intraAxonalVolumeImage->SetOrigin( m_WorkingOrigin );
-      intraAxonalVolumeImage->SetDirection( m_Parameters.m_SignalGen.m_ImageDirection );
-      intraAxonalVolumeImage->SetLargestPossibleRegion( m_WorkingImageRegion );
-      intraAxonalVolumeImage->SetBufferedRegion( m_WorkingImageRegion );
-      intraAxonalVolumeImage->SetRequestedRegion( m_WorkingImageRegion );
-      intraAxonalVolumeImage->Allocate();
-      intraAxonalVolumeImage->FillBuffer(0);
-      maxVolume = 0;
+        if (numPoints<2)
+          continue;
 
-      if (this->GetAbortGenerateData())
-        continue;
+        // collect the segments inside of the mask, their signal is generated in one batch per compartment
+        std::vector< itk::Index<3> > segmentIndices;
+        std::vector< DoubleVectorType > segmentDirections;
+        segmentIndices.reserve(numPoints);
+        segmentDirections.reserve(numPoints);
 
-      vtkPolyData* fiberPolyData = m_FiberBundleTransformed->GetFiberPolyData();
-      // generate fiber signal (if there are any fiber models present)
-      if (!m_Parameters.m_FiberModelList.empty())
-      {
-#pragma omp parallel for
-        for( int i=0; i<numFibers; i++ )
+        for( int j=0; j<numPoints; j++)
         {
           if (this->GetAbortGenerateData())
-            continue;
-
-          float fiberWeight = m_FiberBundleTransformed->GetFiberWeight(i);
-
-          int numPoints = -1;
-          std::vector< itk::Vector<double, 3> > points_copy;
-#pragma omp critical
           {
-            vtkCell* cell = fiberPolyData->GetCell(i);
-            numPoints = cell->GetNumberOfPoints();
-            vtkPoints* points = cell->GetPoints();
-            for (int j=0; j<numPoints; j++)
-              points_copy.push_back(GetItkVector(points->GetPoint(j)));
+            j=numPoints;
+            continue;
           }
 
-          if (numPoints<2)
-            continue;
+          itk::Point<float, 3> vertex = points_copy.at(j);
+          itk::Vector<double> v = points_copy.at(j);
 
-          for( int j=0; j<numPoints; j++)
-          {
-            if (this->GetAbortGenerateData())
-            {
-              j=numPoints;
-              continue;
-            }
+          itk::Vector<double, 3> dir(3);
+          if (j<numPoints-1) { dir = points_copy.at(j+1)-v; }
+          else { dir = v-points_copy.at(j-1); }
 
-            itk::Point<float, 3> vertex = points_copy.at(j);
-            itk::Vector<double> v = points_copy.at(j);
+          if ( dir.GetSquaredNorm()<0.0001 || dir[0]!=dir[0] || dir[1]!=dir[1] || dir[2]!=dir[2] )
+            continue;
 
-            itk::Vector<double, 3> dir(3);
-            if (j<numPoints-1) { dir = points_copy.at(j+1)-v; }
-            else { dir = v-points_copy.at(j-1); }
+          itk::Index<3> idx;
+          itk::ContinuousIndex<float, 3> contIndex;
+          m_TransformedMaskImage->TransformPhysicalPointToIndex(vertex, idx);
+          m_TransformedMaskImage->TransformPhysicalPointToContinuousIndex(vertex, contIndex);
 
-            if ( dir.GetSquaredNorm()<0.0001 || dir[0]!=dir[0] || dir[1]!=dir[1] || dir[2]!=dir[2] )
-              continue;
+          if (!m_TransformedMaskImage->GetLargestPossibleRegion().IsInside(idx) || m_TransformedMaskImage->GetPixel(idx)<=0)
+            continue;
+          dir.Normalize();
+          segmentIndices.push_back(idx);
+          segmentDirections.push_back(dir);
 
-            itk::Index<3> idx;
-            itk::ContinuousIndex<float, 3> contIndex;
-            m_TransformedMaskImage->TransformPhysicalPointToIndex(vertex, idx);
-            m_TransformedMaskImage->TransformPhysicalPointToContinuousIndex(vertex, contIndex);
+          // update fiber volume image
+          double vol = intraAxonalVolumeImage->GetPixel(idx) + m_SegmentVolume*fiberWeight;
+          intraAxonalVolumeImage->SetPixel(idx, vol);
 
-            if (!m_TransformedMaskImage->GetLargestPossibleRegion().IsInside(idx) || m_TransformedMaskImage->GetPixel(idx)<=0)
-              continue;
-            dir.Normalize();
+          // we assume that the first volume is always unweighted!
+          if (vol>maxVolume) { maxVolume = vol; }
+        }
 
-            // generate signal for each fiber compartment
-            for (int k=0; k<numFiberCompartments; k++)
-            {
-              DoubleDwiType::PixelType pix = m_CompartmentImages.at(k)->GetPixel(idx);
-              pix[g] += fiberWeight*m_SegmentVolume*m_Parameters.m_FiberModelList[k]->SimulateMeasurement(g, dir);
-              m_CompartmentImages.at(k)->SetPixel(idx, pix);
-            }
+        if (segmentIndices.empty())
+          continue;
 
-            // update fiber volume image
-            double vol = intraAxonalVolumeImage->GetPixel(idx) + m_SegmentVolume*fiberWeight;
-            intraAxonalVolumeImage->SetPixel(idx, vol);
+        // generate signal for each fiber compartment, accumulated directly in the image buffer of gradient g
+        const unsigned int numSegments = segmentIndices.size();
+        std::vector< double > segmentSignals(numSegments);
+        for (int k=0; k<numFiberCompartments; k++)
+        {
+          m_Parameters.m_FiberModelList[k]->SimulateMeasurements(g, segmentDirections.data(), numSegments, segmentSignals.data());
 
-            // we assume that the first volume is always unweighted!
-            if (vol>maxVolume) { maxVolume = vol; }
-          }
+          DoubleDwiType* compartmentImage = m_CompartmentImages.at(k);
+          double* buffer = compartmentImage->GetBufferPointer();
+          const unsigned int numComponents = compartmentImage->GetNumberOfComponentsPerPixel();
+          for (unsigned int j=0; j<numSegments; ++j)
+            buffer[compartmentImage->ComputeOffset(segmentIndices[j])*numComponents + channel] += fiberWeight*m_SegmentVolume*segmentSignals[j];
+        }
 
 #pragma omp critical
-          {
-            // progress report
-            ++disp;
-            unsigned long newTick = 50*disp.count()/disp.expected_count();
-            for (unsigned int tick = 0; tick<(newTick-lastTick); ++tick)
-              PrintToLog("*", false, false, false);
-            lastTick = newTick;
-          }
+        {
+          // progress report
+          ++disp;
+          unsigned long newTick = 50*disp.count()/disp.expected_count();
+          for (unsigned int tick = 0; tick<(newTick-lastTick); ++tick)
+            PrintToLog("*", false, false, false);
+          lastTick = newTick;
         }
       }
+    }
 
-      // axon radius not manually defined --> set fullest voxel (maxVolume) to full fiber voxel
-      double density_correctiony_global = 1.0;
-      if (m_Parameters.m_SignalGen.m_AxonRadius<0.0001)
-        density_correctiony_global = m_VoxelVolume/maxVolume;
+    // axon radius not manually defined --> set fullest voxel (maxVolume) to full fiber voxel
+    double density_correctiony_global = 1.0;
+    if (m_Parameters.m_SignalGen.m_AxonRadius<0.0001)
+      density_correctiony_global = m_VoxelVolume/maxVolume;
 
-      // generate non-fiber signal
-      ImageRegionIterator<ItkUcharImgType> it3(m_TransformedMaskImage, m_TransformedMaskImage->GetLargestPossibleRegion());
-      while(!it3.IsAtEnd())
+    // generate non-fiber signal
+    ImageRegionIterator<ItkUcharImgType> it3(m_TransformedMaskImage, m_TransformedMaskImage->GetLargestPossibleRegion());
+    while(!it3.IsAtEnd())
+    {
+      if (it3.Get()>0)
       {
-        if (it3.Get()>0)
-        {
-          DoubleDwiType::IndexType index = it3.GetIndex();
-          double iAxVolume = intraAxonalVolumeImage->GetPixel(index);
-
-          // get non-transformed point (remove headmotion tranformation)
-          // this point lives in the volume fraction image space
-          itk::Point<double, 3> volume_fraction_point;
-          if ( m_Parameters.m_SignalGen.m_DoAddMotion && m_Parameters.m_SignalGen.m_MotionVolumes[g] )
-            volume_fraction_point = GetMovedPoint(index, false);
-          else
-            m_TransformedMaskImage->TransformIndexToPhysicalPoint(index, volume_fraction_point);
+        DoubleDwiType::IndexType index = it3.GetIndex();
+        double iAxVolume = intraAxonalVolumeImage->GetPixel(index);
+
+        // get non-transformed point (remove headmotion tranformation)
+        // this point lives in the volume fraction image space
+        itk::Point<double, 3> volume_fraction_point;
+        if ( m_Parameters.m_SignalGen.m_DoAddMotion && m_Parameters.m_SignalGen.m_MotionVolumes[g] )
+          volume_fraction_point = GetMovedPoint(index, false);
+        else
+          m_TransformedMaskImage->TransformIndexToPhysicalPoint(index, volume_fraction_point);
 
-          if (m_Parameters.m_SignalGen.m_DoDisablePartialVolume)
+        if (m_Parameters.m_SignalGen.m_DoDisablePartialVolume)
+        {
+          if (iAxVolume>0.0001) // scale fiber compartment to voxel
           {
-            if (iAxVolume>0.0001) // scale fiber compartment to voxel
-            {
-              DoubleDwiType::PixelType pix = m_CompartmentImages.at(0)->GetPixel(index);
-              pix[g] *= m_VoxelVolume/iAxVolume;
-              m_CompartmentImages.at(0)->SetPixel(index, pix);
+            DoubleDwiType::PixelType pix = m_CompartmentImages.at(0)->GetPixel(index);
+            pix[channel] *= m_VoxelVolume/iAxVolume;
+            m_CompartmentImages.at(0)->SetPixel(index, pix);
 
-              if (g==0)
-                m_VolumeFractions.at(0)->SetPixel(index, 1);
-            }
-            else
-            {
-              DoubleDwiType::PixelType pix = m_CompartmentImages.at(0)->GetPixel(index);
-              pix[g] = 0;
-              m_CompartmentImages.at(0)->SetPixel(index, pix);
-              SimulateExtraAxonalSignal(index, volume_fraction_point, 0, g);
-            }
+            if (g==0)
+              m_VolumeFractions.at(0)->SetPixel(index, 1);
           }
           else
           {
-            // manually defined axon radius and voxel overflow --> rescale to voxel volume
-            if ( m_Parameters.m_SignalGen.m_AxonRadius>=0.0001 && iAxVolume>m_VoxelVolume )
+            DoubleDwiType::PixelType pix = m_CompartmentImages.at(0)->GetPixel(index);
+            pix[channel] = 0;
+            m_CompartmentImages.at(0)->SetPixel(index, pix);
+            SimulateExtraAxonalSignal(index, volume_fraction_point, 0, g, channel);
+          }
+        }
+        else
+        {
+          // manually defined axon radius and voxel overflow --> rescale to voxel volume
+          if ( m_Parameters.m_SignalGen.m_AxonRadius>=0.0001 && iAxVolume>m_VoxelVolume )
+          {
+            for (int i=0; i<numFiberCompartments; ++i)
             {
-              for (int i=0; i<numFiberCompartments; ++i)
-              {
-                DoubleDwiType::PixelType pix = m_CompartmentImages.at(i)->GetPixel(index);
-                pix[g] *= m_VoxelVolume/iAxVolume;
-                m_CompartmentImages.at(i)->SetPixel(index, pix);
-              }
-              iAxVolume = m_VoxelVolume;
+              DoubleDwiType::PixelType pix = m_CompartmentImages.at(i)->GetPixel(index);
+              pix[channel] *= m_VoxelVolume/iAxVolume;
+              m_CompartmentImages.at(i)->SetPixel(index, pix);
             }
+            iAxVolume = m_VoxelVolume;
+          }
 
-            // if volume fraction image is set use it, otherwise use global scaling factor
-            double density_correction_voxel = density_correctiony_global;
-            if ( m_Parameters.m_FiberModelList[0]->GetVolumeFractionImage()!=nullptr && iAxVolume>0.0001 )
-            {
-              m_DoubleInterpolator->SetInputImage(m_Parameters.m_FiberModelList[0]->GetVolumeFractionImage());
-              double volume_fraction = mitk::imv::GetImageValue<double>(volume_fraction_point, true, m_DoubleInterpolator);
-              if (volume_fraction<0)
-                mitkThrow() << "Volume fraction image (index 1) contains negative values (intra-axonal compartment)!";
-              density_correction_voxel = m_VoxelVolume*volume_fraction/iAxVolume; // remove iAxVolume sclaing and scale to volume_fraction
-            }
-            else if (m_Parameters.m_FiberModelList[0]->GetVolumeFractionImage()!=nullptr)
-              density_correction_voxel = 0.0;
+          // if volume fraction image is set use it, otherwise use global scaling factor
+          double density_correction_voxel = density_correctiony_global;
+          if ( m_Parameters.m_FiberModelList[0]->GetVolumeFractionImage()!=nullptr && iAxVolume>0.0001 )
+          {
+            m_DoubleInterpolator->SetInputImage(m_Parameters.m_FiberModelList[0]->GetVolumeFractionImage());
+            double volume_fraction = mitk::imv::GetImageValue<double>(volume_fraction_point, true, m_DoubleInterpolator);
+            if (volume_fraction<0)
+              mitkThrow() << "Volume fraction image (index 1) contains negative values (intra-axonal compartment)!";
+            density_correction_voxel = m_VoxelVolume*volume_fraction/iAxVolume; // remove iAxVolume sclaing and scale to volume_fraction
+          }
+          else if (m_Parameters.m_FiberModelList[0]->GetVolumeFractionImage()!=nullptr)
+            density_correction_voxel = 0.0;
 
-            // adjust intra-axonal compartment volume by density correction factor
-            DoubleDwiType::PixelType pix = m_CompartmentImages.at(0)->GetPixel(index);
-            pix[g] *= density_correction_voxel;
-            m_CompartmentImages.at(0)->SetPixel(index, pix);
+          // adjust intra-axonal compartment volume by density correction factor
+          DoubleDwiType::PixelType pix = m_CompartmentImages.at(0)->GetPixel(index);
+          pix[channel] *= density_correction_voxel;
+          m_CompartmentImages.at(0)->SetPixel(index, pix);
 
-            // normalize remaining fiber volume fractions (they are rescaled in SimulateExtraAxonalSignal)
-            if (iAxVolume>0.0001)
+          // normalize remaining fiber volume fractions (they are rescaled in SimulateExtraAxonalSignal)
+          if (iAxVolume>0.0001)
+          {
+            for (int i=1; i<numFiberCompartments; i++)
             {
-              for (int i=1; i<numFiberCompartments; i++)
-              {
-                DoubleDwiType::PixelType pix = m_CompartmentImages.at(i)->GetPixel(index);
-                pix[g] /= iAxVolume;
-                m_CompartmentImages.at(i)->SetPixel(index, pix);
-              }
+              DoubleDwiType::PixelType pix = m_CompartmentImages.at(i)->GetPixel(index);
+              pix[channel] /= iAxVolume;
+              m_CompartmentImages.at(i)->SetPixel(index, pix);
             }
-            else
+          }
+          else
+          {
+            for (int i=1; i<numFiberCompartments; i++)
             {
-              for (int i=1; i<numFiberCompartments; i++)
-              {
-                DoubleDwiType::PixelType pix = m_CompartmentImages.at(i)->GetPixel(index);
-                pix[g] = 0;
-                m_CompartmentImages.at(i)->SetPixel(index, pix);
-              }
+              DoubleDwiType::PixelType pix = m_CompartmentImages.at(i)->GetPixel(index);
+              pix[channel] = 0;
+              m_CompartmentImages.at(i)->SetPixel(index, pix);
             }
+          }
 
-            iAxVolume = density_correction_voxel*iAxVolume; // new intra-axonal volume = old intra-axonal volume * correction factor
+          iAxVolume = density_correction_voxel*iAxVolume; // new intra-axonal volume = old intra-axonal volume * correction factor
 
-            // simulate other compartments
-            SimulateExtraAxonalSignal(index, volume_fraction_point, iAxVolume, g);
-          }
+          // simulate other compartments
+          SimulateExtraAxonalSignal(index, volume_fraction_point, iAxVolume, g, channel);
         }
-        ++it3;
       }
+      ++it3;
     }
-
-    PrintToLog("\n", false);
   }
 
-  if (this->GetAbortGenerateData())
-  {
-    PrintToLog("\n", false, false);
-    PrintToLog("Simulation aborted");
-    return;
-  }
-
-  DoubleDwiType::Pointer doubleOutImage;
-  double signalScale = m_Parameters.m_SignalGen.m_SignalScale;
-  if ( m_Parameters.m_SignalGen.m_SimulateKspaceAcquisition ) // do k-space stuff
-  {
-    PrintToLog("\n", false, false);
-    PrintToLog("Simulating k-space acquisition using "
-               +boost::lexical_cast<std::string>(m_Parameters.m_SignalGen.m_NumberOfCoils)
-               +" coil(s)");
-
-    switch (m_Parameters.m_SignalGen.m_AcquisitionType)
-    {
-    case SignalGenerationParameters::SingleShotEpi:
-    {
-      PrintToLog("Acquisition type: single shot EPI", false);
-      break;
-    }
-    case SignalGenerationParameters::SpinEcho:
-    {
-      PrintToLog("Acquisition type: classic spin echo with cartesian k-space trajectory", false);
-      break;
-    }
-    default:
-    {
-      PrintToLog("Acquisition type: single shot EPI", false);
-      break;
-    }
-    }
-
-    if (m_Parameters.m_SignalGen.m_NoiseVariance>0 && m_Parameters.m_Misc.m_CheckAddNoiseBox)
-      PrintToLog("Simulating complex Gaussian noise", false);
-    if (m_Parameters.m_SignalGen.m_DoSimulateRelaxation)
-      PrintToLog("Simulating signal relaxation", false);
-    if (m_Parameters.m_SignalGen.m_FrequencyMap.IsNotNull())
-      PrintToLog("Simulating distortions", false);
-    if (m_Parameters.m_SignalGen.m_DoAddGibbsRinging)
-      PrintToLog("Simulating ringing artifacts", false);
-    if (m_Parameters.m_SignalGen.m_EddyStrength>0)
-      PrintToLog("Simulating eddy currents", false);
-    if (m_Parameters.m_SignalGen.m_Spikes>0)
-      PrintToLog("Simulating spikes", false);
-    if (m_Parameters.m_SignalGen.m_CroppingFactor<1.0)
-      PrintToLog("Simulating aliasing artifacts", false);
-    if (m_Parameters.m_SignalGen.m_KspaceLineOffset>0)
-      PrintToLog("Simulating ghosts", false);
-
-    doubleOutImage = SimulateKspaceAcquisition(m_CompartmentImages);
-    signalScale = 1; // already scaled in SimulateKspaceAcquisition()
-  }
-  else    // don't do k-space stuff, just sum compartments
-  {
-    PrintToLog("Summing compartments");
-    doubleOutImage = m_CompartmentImages.at(0);
+  PrintToLog("\n", false);
+}
 
-    for (unsigned int i=1; i<m_CompartmentImages.size(); i++)
-    {
-      auto adder = itk::AddImageFilter< DoubleDwiType, DoubleDwiType, DoubleDwiType>::New();
-      adder->SetInput1(doubleOutImage);
-      adder->SetInput2(m_CompartmentImages.at(i));
-      adder->Update();
-      doubleOutImage = adder->GetOutput();
-    }
-  }
-  if (this->GetAbortGenerateData())
-  {
-    PrintToLog("\n", false, false);
-    PrintToLog("Simulation aborted");
-    return;
-  }
+template< class PixelType >
+void TractsToDWIImageFilter< PixelType >::FinalizeVolumes(DoubleDwiType* image, unsigned int firstVolume, double signalScale, unsigned int& window, unsigned int& min)
+{
+  const unsigned int numVolumes = image->GetVectorLength();
+  const unsigned int numOutputVolumes = m_OutputImage->GetVectorLength();
+  PixelType* outputBuffer = m_OutputImage->GetBufferPointer();
 
-  PrintToLog("Finalizing image");
-  if (signalScale>1)
-    PrintToLog(" Scaling signal", false);
-  if (m_Parameters.m_NoiseModel)
-    PrintToLog(" Adding noise", false);
-  unsigned int window = 0;
-  unsigned int min = itk::NumericTraits<unsigned int>::max();
   ImageRegionIterator<OutputImageType> it4 (m_OutputImage, m_OutputImage->GetLargestPossibleRegion());
-  DoubleDwiType::PixelType signal; signal.SetSize(m_Parameters.m_SignalGen.GetNumVolumes());
+  DoubleDwiType::PixelType signal; signal.SetSize(numVolumes);
   boost::progress_display disp2(m_OutputImage->GetLargestPossibleRegion().GetNumberOfPixels());
 
   PrintToLog("0%   10   20   30   40   50   60   70   80   90   100%", false, true, false);
@@ -1326,11 +1240,7 @@ void TractsToDWIImageFilter< PixelType >::GenerateData()
   while(!it4.IsAtEnd())
   {
     if (this->GetAbortGenerateData())
-    {
-      PrintToLog("\n", false, false);
-      PrintToLog("Simulation aborted");
       return;
-    }
 
     ++disp2;
     unsigned long newTick = 50*disp2.count()/disp2.expected_count();
@@ -1339,11 +1249,13 @@ void TractsToDWIImageFilter< PixelType >::GenerateData()
     lastTick = newTick;
 
     typename OutputImageType::IndexType index = it4.GetIndex();
-    signal = doubleOutImage->GetPixel(index)*signalScale;
+    signal = image->GetPixel(index)*signalScale;
 
     if (m_Parameters.m_NoiseModel)
       m_Parameters.m_NoiseModel->AddNoise(signal);
 
+    // write the volumes of the block into the corresponding channels of the output pixel
+    PixelType* outputPixel = outputBuffer + m_OutputImage->ComputeOffset(index)*numOutputVolumes + firstVolume;
     for (unsigned int i=0; i<signal.Size(); i++)
     {
       if (signal[i]>0)
@@ -1351,14 +1263,213 @@ void TractsToDWIImageFilter< PixelType >::GenerateData()
       else
         signal[i] = ceil(signal[i]-0.5);
 
-      if ( (!m_Parameters.m_SignalGen.IsBaselineIndex(i) || signal.Size()==1) && signal[i]>window)
+      const unsigned int g = firstVolume+i;
+      if ( (!m_Parameters.m_SignalGen.IsBaselineIndex(g) || numOutputVolumes==1) && signal[i]>window)
         window = signal[i];
-      if ( (!m_Parameters.m_SignalGen.IsBaselineIndex(i) || signal.Size()==1) && signal[i]<min)
+      if ( (!m_Parameters.m_SignalGen.IsBaselineIndex(g) || numOutputVolumes==1) && signal[i]<min)
         min = signal[i];
+
+      outputPixel[i] = static_cast<PixelType>(signal[i]);
     }
-    it4.Set(signal);
     ++it4;
   }
+}
+
+template< class PixelType >
+void TractsToDWIImageFilter< PixelType >::GenerateData()
+{
+  // prepare logfile
+  if ( ! PrepareLogFile() )
+  {
+    this->SetAbortGenerateData( true );
+    return;
+  }
+
+  m_TimeProbe.Start();
+
+  // check input data
+  if (m_FiberBundle.IsNull() && m_InputImage.IsNull())
+    itkExceptionMacro("Input fiber bundle and input diffusion-weighted image is nullptr!");
+
+  if (m_Parameters.m_FiberModelList.empty() && m_InputImage.IsNull())
+    itkExceptionMacro("No diffusion model for fiber compartments defined and input diffusion-weighted"
+                      " image is nullptr! At least one fiber compartment is necessary to simulate diffusion.");
+
+  if (m_Parameters.m_NonFiberModelList.empty() && m_InputImage.IsNull())
+    itkExceptionMacro("No diffusion model for non-fiber compartments defined and input diffusion-weighted"
+                      " image is nullptr! At least one non-fiber compartment is necessary to simulate diffusion.");
+
+  if (m_Parameters.m_SignalGen.m_DoDisablePartialVolume)  // no partial volume? remove all but first fiber compartment
+    while (m_Parameters.m_FiberModelList.size()>1)
+      m_Parameters.m_FiberModelList.pop_back();
+
+  //    int baselineIndex = m_Parameters.m_SignalGen.GetFirstBaselineIndex();
+  //    if (baselineIndex<0) { itkExceptionMacro("No baseline index found!"); }
+
+  if (!m_Parameters.m_SignalGen.m_SimulateKspaceAcquisition)  // No upsampling of input image needed if no k-space simulation is performed
+    m_Parameters.m_SignalGen.m_DoAddGibbsRinging = false;
+
+  if (m_UseConstantRandSeed)  // always generate the same random numbers?
+    m_RandGen->SetSeed(0);
+  else
+    m_RandGen->SetSeed();
+
+  // simulate all volumes at once or stream blocks of volumes through signal generation, k-space simulation and noise
+  const unsigned int numVolumes = m_Parameters.m_SignalGen.GetNumVolumes();
+  m_VolumesPerBlock = numVolumes;
+  if (m_NumberOfStreamedVolumes>0 && m_NumberOfStreamedVolumes<numVolumes)
+  {
+    if (m_FiberBundle.IsNotNull())
+      m_VolumesPerBlock = m_NumberOfStreamedVolumes;
+    else
+      PrintToLog("Streaming of volumes is only supported for fiber based simulations. Simulating all volumes at once.", false);
+  }
+
+  InitializeData();
+
+  int signalModelSeed = 0;
+  if ( m_FiberBundle.IsNotNull() )    // if no fiber bundle is found, we directly proceed to the k-space acquisition simulation
+  {
+    CheckVolumeFractionImages();
+    InitializeFiberData();
+
+    int numFiberCompartments = m_Parameters.m_FiberModelList.size();
+    int numNonFiberCompartments = m_Parameters.m_NonFiberModelList.size();
+    signalModelSeed = m_RandGen->GetIntegerVariate();
+
+    PrintToLog("\n", false, false);
+    PrintToLog("Generating " + boost::lexical_cast<std::string>(numFiberCompartments+numNonFiberCompartments)
+               + "-compartment diffusion-weighted signal.");
+
+    std::vector< int > bVals = m_Parameters.m_SignalGen.GetBvalues();
+    PrintToLog("b-values: ", false, false, true);
+    for (auto v : bVals)
+      PrintToLog(boost::lexical_cast<std::string>(v) + " ", false, false, true);
+    PrintToLog("\n", false, false, true);
+    PrintToLog("\n", false, false, true);
+
+    if (m_VolumesPerBlock<numVolumes)
+      PrintToLog("Streaming " + boost::lexical_cast<std::string>(m_VolumesPerBlock) + " volume(s) at a time", false);
+  }
+
+  unsigned int window = 0;
+  unsigned int min = itk::NumericTraits<unsigned int>::max();
+  for (unsigned int firstVolume=0; firstVolume<numVolumes; firstVolume+=m_VolumesPerBlock)
+  {
+    const unsigned int numBlockVolumes = std::min(m_VolumesPerBlock, numVolumes-firstVolume);
+    if (m_VolumesPerBlock<numVolumes)
+    {
+      PrintToLog("\n", false, false);
+      PrintToLog("Volumes " + boost::lexical_cast<std::string>(firstVolume+1) + " to "
+                 + boost::lexical_cast<std::string>(firstVolume+numBlockVolumes) + " of "
+                 + boost::lexical_cast<std::string>(numVolumes));
+    }
+
+    if ( m_FiberBundle.IsNotNull() )
+    {
+      if (firstVolume>0)
+        InitializeCompartmentImages(numBlockVolumes);
+      SimulateDiffusionSignal(firstVolume, numBlockVolumes, signalModelSeed);
+    }
+
+    if (this->GetAbortGenerateData())
+    {
+      PrintToLog("\n", false, false);
+      PrintToLog("Simulation aborted");
+      return;
+    }
+
+    DoubleDwiType::Pointer doubleOutImage;
+    double signalScale = m_Parameters.m_SignalGen.m_SignalScale;
+    if ( m_Parameters.m_SignalGen.m_SimulateKspaceAcquisition ) // do k-space stuff
+    {
+      if (firstVolume==0)
+      {
+        PrintToLog("\n", false, false);
+        PrintToLog("Simulating k-space acquisition using "
+                   +boost::lexical_cast<std::string>(m_Parameters.m_SignalGen.m_NumberOfCoils)
+                   +" coil(s)");
+
+        switch (m_Parameters.m_SignalGen.m_AcquisitionType)
+        {
+        case SignalGenerationParameters::SingleShotEpi:
+        {
+          PrintToLog("Acquisition type: single shot EPI", false);
+          break;
+        }
+        case SignalGenerationParameters::SpinEcho:
+        {
+          PrintToLog("Acquisition type: classic spin echo with cartesian k-space trajectory", false);
+          break;
+        }
+        default:
+        {
+          PrintToLog("Acquisition type: single shot EPI", false);
+          break;
+        }
+        }
+
+        if (m_Parameters.m_SignalGen.m_NoiseVariance>0 && m_Parameters.m_Misc.m_CheckAddNoiseBox)
+          PrintToLog("Simulating complex Gaussian noise", false);
+        if (m_Parameters.m_SignalGen.m_DoSimulateRelaxation)
+          PrintToLog("Simulating signal relaxation", false);
+        if (m_Parameters.m_SignalGen.m_FrequencyMap.IsNotNull())
+          PrintToLog("Simulating distortions", false);
+        if (m_Parameters.m_SignalGen.m_DoAddGibbsRinging)
+          PrintToLog("Simulating ringing artifacts", false);
+        if (m_Parameters.m_SignalGen.m_EddyStrength>0)
+          PrintToLog("Simulating eddy currents", false);
+        if (m_Parameters.m_SignalGen.m_Spikes>0)
+          PrintToLog("Simulating spikes", false);
+        if (m_Parameters.m_SignalGen.m_CroppingFactor<1.0)
+          PrintToLog("Simulating aliasing artifacts", false);
+        if (m_Parameters.m_SignalGen.m_KspaceLineOffset>0)
+          PrintToLog("Simulating ghosts", false);
+      }
+
+      doubleOutImage = SimulateKspaceAcquisition(m_CompartmentImages, firstVolume);
+      signalScale = 1; // already scaled in SimulateKspaceAcquisition()
+    }
+    else    // don't do k-space stuff, just sum compartments
+    {
+      if (firstVolume==0)
+        PrintToLog("Summing compartments");
+      doubleOutImage = m_CompartmentImages.at(0);
+
+      for (unsigned int i=1; i<m_CompartmentImages.size(); i++)
+      {
+        auto adder = itk::AddImageFilter< DoubleDwiType, DoubleDwiType, DoubleDwiType>::New();
+        adder->SetInput1(doubleOutImage);
+        adder->SetInput2(m_CompartmentImages.at(i));
+        adder->Update();
+        doubleOutImage = adder->GetOutput();
+      }
+    }
+    if (this->GetAbortGenerateData())
+    {
+      PrintToLog("\n", false, false);
+      PrintToLog("Simulation aborted");
+      return;
+    }
+
+    if (firstVolume==0)
+    {
+      PrintToLog("Finalizing image");
+      if (signalScale>1)
+        PrintToLog(" Scaling signal", false);
+      if (m_Parameters.m_NoiseModel)
+        PrintToLog(" Adding noise", false);
+    }
+    FinalizeVolumes(doubleOutImage, firstVolume, signalScale, window, min);
+
+    if (this->GetAbortGenerateData())
+    {
+      PrintToLog("\n", false, false);
+      PrintToLog("Simulation aborted");
+      return;
+    }
+  }
+
   window -= min;
   unsigned int level = window/2 + min;
   m_LevelWindow.SetLevelWindow(level, window);
@@ -1559,7 +1670,7 @@ itk::Point<double, 3> TractsToDWIImageFilter< PixelType >::GetMovedPoint(itk::In
 
 template< class PixelType >
 void TractsToDWIImageFilter< PixelType >::
-SimulateExtraAxonalSignal(ItkUcharImgType::IndexType& index, itk::Point<double, 3>& volume_fraction_point, double intraAxonalVolume, int g)
+SimulateExtraAxonalSignal(ItkUcharImgType::IndexType& index, itk::Point<double, 3>& volume_fraction_point, double intraAxonalVolume, int g, unsigned int channel)
 {
   int numFiberCompartments = m_Parameters.m_FiberModelList.size();
   int numNonFiberCompartments = m_Parameters.m_NonFiberModelList.size();
@@ -1588,7 +1699,7 @@ SimulateExtraAxonalSignal(ItkUcharImgType::IndexType& index, itk::Point<double,
 
     DoubleDwiType::Pointer doubleDwi = m_CompartmentImages.at(max_compartment_index+numFiberCompartments);
     DoubleDwiType::PixelType pix = doubleDwi->GetPixel(index);
-    pix[g] += m_Parameters.m_NonFiberModelList[max_compartment_index]->SimulateMeasurement(g, m_NullDir)*m_VoxelVolume;
+    pix[channel] += m_Parameters.m_NonFiberModelList[max_compartment_index]->SimulateMeasurement(g, m_NullDir)*m_VoxelVolume;
     doubleDwi->SetPixel(index, pix);
 
     if (g==0)
@@ -1634,7 +1745,7 @@ SimulateExtraAxonalSignal(ItkUcharImgType::IndexType& index, itk::Point<double,
       }
 
       DoubleDwiType::PixelType pix = m_CompartmentImages.at(i)->GetPixel(index);
-      pix[g] *= interAxonalVolume;
+      pix[channel] *= interAxonalVolume;
       m_CompartmentImages.at(i)->SetPixel(index, pix);
 
       compartmentSum += interAxonalVolume;
@@ -1658,7 +1769,7 @@ SimulateExtraAxonalSignal(ItkUcharImgType::IndexType& index, itk::Point<double,
       }
 
       DoubleDwiType::PixelType pix = m_CompartmentImages.at(i+numFiberCompartments)->GetPixel(index);
-      pix[g] += m_Parameters.m_NonFiberModelList[i]->SimulateMeasurement(g, m_NullDir)*volume;
+      pix[channel] += m_Parameters.m_NonFiberModelList[i]->SimulateMeasurement(g, m_NullDir)*volume;
       m_CompartmentImages.at(i+numFiberCompartments)->SetPixel(index, pix);
 
       compartmentSum += volume;
@@ -66,6 +66,8 @@ public:
     itkSetMacro( FiberBundle, FiberBundleType )             ///< Input fiber bundle
     itkSetMacro( InputImage, typename OutputImageType::Pointer )     ///< Input diffusion-weighted image. If no fiber bundle is set, then the acquisition is simulated for this image without a new diffusion simulation.
     itkSetMacro( UseConstantRandSeed, bool )                ///< Seed for random generator.
+    itkSetMacro( NumberOfStreamedVolumes, unsigned int )    ///< Number of volumes simulated at once (0 = all). Signal generation, k-space simulation and noise are then performed block by block and written into the output, so the peak memory is proportional to the block size instead of the number of volumes. The phase image and the real and imaginary coil images are not generated in this case. Only used for fiber based simulations.
+    itkGetMacro( NumberOfStreamedVolumes, unsigned int )
     void SetParameters( FiberfoxParameters param )  ///< Simulation parameters.
     { m_Parameters = param; }
 
@@ -105,11 +107,17 @@ protected:
     bool PrepareLogFile();  /** Prepares the log file and returns true if successful or false if failed. */
     void PrintToLog(std::string m, bool addTime=true, bool linebreak=true, bool stdOut=true);
 
-    /** Transform generated image compartment by compartment, channel by channel and slice by slice using DFT and add k-space artifacts/effects. */
-    DoubleDwiType::Pointer SimulateKspaceAcquisition(std::vector< DoubleDwiType::Pointer >& images);
+    /** Transform generated image compartment by compartment, channel by channel and slice by slice using DFT and add k-space artifacts/effects. The channels of the images contain the volumes starting at firstVolume. */
+    DoubleDwiType::Pointer SimulateKspaceAcquisition(std::vector< DoubleDwiType::Pointer >& images, unsigned int firstVolume);
 
-    /** Generate signal of non-fiber compartments. */
-    void SimulateExtraAxonalSignal(ItkUcharImgType::IndexType& index, itk::Point<double, 3>& volume_fraction_point, double intraAxonalVolume, int g);
+    /** Generate the fiber and non-fiber signal of numVolumes volumes starting at firstVolume in the compartment images. */
+    void SimulateDiffusionSignal(unsigned int firstVolume, unsigned int numVolumes, int signalModelSeed);
+
+    /** Generate signal of non-fiber compartments for volume g, stored in the given channel of the compartment images. */
+    void SimulateExtraAxonalSignal(ItkUcharImgType::IndexType& index, itk::Point<double, 3>& volume_fraction_point, double intraAxonalVolume, int g, unsigned int channel);
+
+    /** Scale, add noise and round the volumes of the image and write them into the output, starting at volume firstVolume. Updates the level window range. */
+    void FinalizeVolumes(DoubleDwiType* image, unsigned int firstVolume, double signalScale, unsigned int& window, unsigned int& min);
 
     /** Move fibers to simulate headmotion */
     void SimulateMotion(int g=-1);
@@ -117,6 +125,7 @@ protected:
     void CheckVolumeFractionImages();
     ItkDoubleImgType::Pointer NormalizeInsideMask(ItkDoubleImgType::Pointer image);
     void InitializeData();
+    void InitializeCompartmentImages(unsigned int numVolumes);
     void InitializeFiberData();
 
     itk::Point<double, 3> GetMovedPoint(itk::Index<3>& index, bool forward);
@@ -139,6 +148,7 @@ protected:
     // MISC
     itk::TimeProbe                              m_TimeProbe;
     bool                                        m_UseConstantRandSeed;
+    unsigned int                                m_NumberOfStreamedVolumes;
     bool                                        m_MaskImageSet;
     ofstream                                    m_Logfile;
     std::string                                 m_MotionLog;
@@ -151,7 +161,9 @@ protected:
     itk::Point<double,3>                        m_WorkingOrigin;
     ImageRegion<3>                              m_WorkingImageRegion;
     double                                      m_VoxelVolume;
-    std::vector< DoubleDwiType::Pointer >       m_CompartmentImages;
+    std::vector< DoubleDwiType::Pointer >       m_CompartmentImages;        ///< one channel per volume of the current block
+    unsigned int                                m_VolumesPerBlock;          ///< number of volumes held by the compartment images
+    std::vector< unsigned int >                 m_SpikeVolumes;             ///< volume of each spike
     ItkUcharImgType::Pointer                    m_TransformedMaskImage;     ///< copy of mask image (changes for each motion step)
     ItkUcharImgType::Pointer                    m_UpsampledMaskImage;       ///< helper image for motion simulation
     DoubleVectorType                            m_Rotation;
@@ -49,6 +49,8 @@ const char* mitk::FiberBundle::FIBER_ID_ARRAY = "Fiber_IDs";
 
 mitk::FiberBundle::FiberBundle( vtkPolyData* fiberPolyData )
   : m_NumFibers(0)
+  , m_SpatialIndexPolyData(nullptr)
+  , m_SpatialIndexMTime(0)
 {
   m_FiberWeights = vtkSmartPointer<vtkFloatArray>::New();
   m_FiberWeights->SetName("FIBER_WEIGHTS");
@@ -517,6 +519,29 @@ vtkSmartPointer<vtkPolyData> mitk::FiberBundle::GetFiberPolyData() const
   return m_FiberPolyData;
 }
 
+const mitk::FiberBundleSpatialIndex& mitk::FiberBundle::GetSpatialIndex() const
+{
+  std::lock_guard<std::mutex> lock(m_SpatialIndexMutex);
+  if (m_SpatialIndex==nullptr || m_SpatialIndexPolyData!=m_FiberPolyData.GetPointer() || m_SpatialIndexMTime!=m_FiberPolyData->GetMTime())
+  {
+    m_SpatialIndex.reset(new FiberBundleSpatialIndex(this->GetFiberPointBuffer()));
+    m_SpatialIndexPolyData = m_FiberPolyData.GetPointer();
+    m_SpatialIndexMTime = m_FiberPolyData->GetMTime();
+  }
+  return *m_SpatialIndex;
+}
+
+mitk::FiberPointBuffer mitk::FiberBundle::GetFiberPointBuffer() const
+{
+  return FiberPointBuffer(m_FiberPolyData);
+}
+
+void mitk::FiberBundle::SetFiberPointBuffer(const FiberPointBuffer& buffer, bool updateGeometry)
+{
+  m_FiberPolyData = buffer.ToPolyData();
+  this->SetFiberPolyData(m_FiberPolyData, updateGeometry);
+}
+
 void mitk::FiberBundle::ColorFibersByLength(bool opacity, bool normalize)
 {
   if (m_MaxFiberLength<=0)
@@ -1012,7 +1037,6 @@ void mitk::FiberBundle::GenerateFiberIds()
 
 float mitk::FiberBundle::GetOverlap(ItkUcharImgType* mask, bool do_resampling)
 {
-  vtkSmartPointer<vtkPolyData> PolyData = m_FiberPolyData;
   mitk::FiberBundle::Pointer fibCopy = this;
   if (do_resampling)
   {
@@ -1026,33 +1050,27 @@ float mitk::FiberBundle::GetOverlap(ItkUcharImgType* mask, bool do_resampling)
 
     fibCopy = this->GetDeepCopy();
     fibCopy->ResampleLinear(minSpacing/5);
-    PolyData = fibCopy->GetFiberPolyData();
   }
+  FiberPointBuffer buffer = fibCopy->GetFiberPointBuffer();
 
   MITK_INFO << "Calculating overlap";
   int inside = 0;
   int outside = 0;
-  boost::progress_display disp(m_NumFibers);
-  for (int i=0; i<m_NumFibers; i++)
-  {
-    ++disp;
-    vtkCell* cell = PolyData->GetCell(i);
-    int numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
+  const int numPoints = buffer.GetNumberOfPoints();
+  const float* points = buffer.GetPoints().data();
 
-    for (int j=0; j<numPoints; j++)
-    {
-      double* p = points->GetPoint(j);
-      itk::Point<float, 3> itkP;
-      itkP[0] = p[0]; itkP[1] = p[1]; itkP[2] = p[2];
-      itk::Index<3> idx;
-      mask->TransformPhysicalPointToIndex(itkP, idx);
+#pragma omp parallel for reduction(+:inside,outside)
+  for (int j=0; j<numPoints; j++)
+  {
+    itk::Point<float, 3> itkP;
+    itkP[0] = points[3*j]; itkP[1] = points[3*j+1]; itkP[2] = points[3*j+2];
+    itk::Index<3> idx;
+    mask->TransformPhysicalPointToIndex(itkP, idx);
 
-      if ( mask->GetLargestPossibleRegion().IsInside(idx) && mask->GetPixel(idx) != 0 )
-        inside++;
-      else
-        outside++;
-    }
+    if ( mask->GetLargestPossibleRegion().IsInside(idx) && mask->GetPixel(idx) != 0 )
+      inside++;
+    else
+      outside++;
   }
 
   if (inside+outside==0)
@@ -1070,20 +1088,36 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::RemoveFibersOutside(ItkUcharImgTyp
   else
     minSpacing = mask->GetSpacing()[2];
 
-  mitk::FiberBundle::Pointer fibCopy = this->GetDeepCopy();
+  mitk::FiberBundle::Pointer fibCopy;
+  if (!invert)
+  {
+    // fibers that do not come near the mask cannot contribute, so only those around it are resampled and cut
+    double boxMin[3], boxMax[3];
+    if (!FiberBundleSpatialIndex::GetPositiveBounds(mask, [](unsigned char v){ return v!=0; }, boxMin, boxMax))
+      return nullptr;
+    std::vector<long> candidates = this->GetSpatialIndex().GetCandidateFibers(boxMin, boxMax);
+    if (candidates.empty())
+      return nullptr;
+    vtkSmartPointer<vtkFloatArray> weights = vtkSmartPointer<vtkFloatArray>::New();
+    fibCopy = mitk::FiberBundle::New(this->GeneratePolyDataByIds(candidates, weights));
+    fibCopy->SetFiberWeights(weights);
+  }
+  else
+    fibCopy = this->GetDeepCopy();
   fibCopy->ResampleLinear(minSpacing/10);
   vtkSmartPointer<vtkPolyData> PolyData =fibCopy->GetFiberPolyData();
+  int numFibers = fibCopy->GetNumFibers();
 
   vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
   vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
 
   vtkSmartPointer<vtkFloatArray> newFiberWeights = vtkSmartPointer<vtkFloatArray>::New();
   newFiberWeights->SetName("FIBER_WEIGHTS");
-  newFiberWeights->SetNumberOfValues(m_NumFibers);
+  newFiberWeights->SetNumberOfValues(numFibers);
 
   MITK_INFO << "Cutting fibers";
-  boost::progress_display disp(m_NumFibers);
-  for (int i=0; i<m_NumFibers; i++)
+  boost::progress_display disp(numFibers);
+  for (int i=0; i<numFibers; i++)
   {
     ++disp;
 
@@ -1253,9 +1287,17 @@ std::vector<long> mitk::FiberBundle::ExtractFiberIdSubset(DataNode *roi, DataSto
         polygonVtk->GetPointIds()->InsertNextId(id);
       }
 
-      MITK_INFO << "Extracting with polygon";
-      boost::progress_display disp(m_NumFibers);
-      for (int i=0; i<m_NumFibers; i++)
+      // only fibers passing through the (slightly padded) bounding box of the polygon can intersect it
+      double bounds[6];
+      polygonVtk->GetPoints()->GetBounds(bounds);
+      double pad = 0.01 + 0.01*std::sqrt((bounds[1]-bounds[0])*(bounds[1]-bounds[0]) + (bounds[3]-bounds[2])*(bounds[3]-bounds[2]) + (bounds[5]-bounds[4])*(bounds[5]-bounds[4]));
+      double boxMin[3] = {bounds[0]-pad, bounds[2]-pad, bounds[4]-pad};
+      double boxMax[3] = {bounds[1]+pad, bounds[3]+pad, bounds[5]+pad};
+      std::vector<long> candidates = this->GetSpatialIndex().GetCandidateFibers(boxMin, boxMax);
+
+      MITK_INFO << "Extracting with polygon (" << candidates.size() << " of " << m_NumFibers << " fibers are candidates)";
+      boost::progress_display disp(candidates.size());
+      for (long i : candidates)
       {
         ++disp ;
         vtkCell* cell = m_FiberPolyData->GetCell(i);
@@ -1299,9 +1341,14 @@ std::vector<long> mitk::FiberBundle::ExtractFiberIdSubset(DataNode *roi, DataSto
       double radius = V1w.EuclideanDistanceTo(V2w);
       radius *= radius;
 
-      MITK_INFO << "Extracting with circle";
-      boost::progress_display disp(m_NumFibers);
-      for (int i=0; i<m_NumFibers; i++)
+      double r = std::sqrt(radius);
+      double boxMin[3] = {V1w[0]-r, V1w[1]-r, V1w[2]-r};
+      double boxMax[3] = {V1w[0]+r, V1w[1]+r, V1w[2]+r};
+      std::vector<long> candidates = this->GetSpatialIndex().GetCandidateFibers(boxMin, boxMax);
+
+      MITK_INFO << "Extracting with circle (" << candidates.size() << " of " << m_NumFibers << " fibers are candidates)";
+      boost::progress_display disp(candidates.size());
+      for (long i : candidates)
       {
         ++disp ;
         vtkCell* cell = m_FiberPolyData->GetCell(i);
@@ -1554,30 +1601,21 @@ itk::Point<float, 3> mitk::FiberBundle::TransformPoint(vnl_vector_fixed< double,
 
 void mitk::FiberBundle::TransformFibers(itk::ScalableAffineTransform< mitk::ScalarType >::Pointer transform)
 {
-  vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-  vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
+  FiberPointBuffer buffer = this->GetFiberPointBuffer();
+  const int numPoints = buffer.GetNumberOfPoints();
+  float* points = buffer.GetPoints().data();
 
-  for (int i=0; i<m_NumFibers; i++)
+#pragma omp parallel for
+  for (int j=0; j<numPoints; j++)
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
-    int numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
-
-    vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-    for (int j=0; j<numPoints; j++)
-    {
-      itk::Point<float, 3> p = GetItkPoint(points->GetPoint(j));
-      p = transform->TransformPoint(p);
-      vtkIdType id = vtkNewPoints->InsertNextPoint(p.GetDataPointer());
-      container->GetPointIds()->InsertNextId(id);
-    }
-    vtkNewCells->InsertNextCell(container);
+    float* fp = points + 3*j;
+    itk::Point<float, 3> p;
+    p[0] = fp[0]; p[1] = fp[1]; p[2] = fp[2];
+    p = transform->TransformPoint(p);
+    fp[0] = p[0]; fp[1] = p[1]; fp[2] = p[2];
   }
 
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  this->SetFiberPointBuffer(buffer, true);
 }
 
 void mitk::FiberBundle::TransformFibers(double rx, double ry, double rz, double tx, double ty, double tz)
@@ -1609,37 +1647,25 @@ void mitk::FiberBundle::TransformFibers(double rx, double ry, double rz, double
   mitk::BaseGeometry::Pointer geom = this->GetGeometry();
   mitk::Point3D center = geom->GetCenter();
 
-  vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-  vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
+  FiberPointBuffer buffer = this->GetFiberPointBuffer();
+  const int numPoints = buffer.GetNumberOfPoints();
+  float* points = buffer.GetPoints().data();
 
-  for (int i=0; i<m_NumFibers; i++)
+#pragma omp parallel for
+  for (int j=0; j<numPoints; j++)
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
-    int numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
-
-    vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-    for (int j=0; j<numPoints; j++)
-    {
-      double* p = points->GetPoint(j);
-      vnl_vector_fixed< double, 3 > dir;
-      dir[0] = p[0]-center[0];
-      dir[1] = p[1]-center[1];
-      dir[2] = p[2]-center[2];
-      dir = rot*dir;
-      dir[0] += center[0]+tx;
-      dir[1] += center[1]+ty;
-      dir[2] += center[2]+tz;
-      vtkIdType id = vtkNewPoints->InsertNextPoint(dir.data_block());
-      container->GetPointIds()->InsertNextId(id);
-    }
-    vtkNewCells->InsertNextCell(container);
+    float* p = points + 3*j;
+    vnl_vector_fixed< double, 3 > dir;
+    dir[0] = p[0]-center[0];
+    dir[1] = p[1]-center[1];
+    dir[2] = p[2]-center[2];
+    dir = rot*dir;
+    p[0] = dir[0]+center[0]+tx;
+    p[1] = dir[1]+center[1]+ty;
+    p[2] = dir[2]+center[2]+tz;
   }
 
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  this->SetFiberPointBuffer(buffer, true);
 }
 
 void mitk::FiberBundle::RotateAroundAxis(double x, double y, double z)
@@ -1970,40 +1996,22 @@ bool mitk::FiberBundle::RemoveShortFibers(float lengthInMM)
     return false;
   }
 
-  vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-  vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
-  float min = m_MaxFiberLength;
+  FiberPointBuffer buffer = this->GetFiberPointBuffer();
+  FiberPointBuffer newBuffer;
+  newBuffer.Reserve(buffer.GetNumberOfFibers(), buffer.GetNumberOfPoints());
 
   boost::progress_display disp(m_NumFibers);
   for (int i=0; i<m_NumFibers; i++)
   {
     ++disp;
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
-    int numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
-
     if (m_FiberLengths.at(i)>=lengthInMM)
-    {
-      vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-      for (int j=0; j<numPoints; j++)
-      {
-        double* p = points->GetPoint(j);
-        vtkIdType id = vtkNewPoints->InsertNextPoint(p);
-        container->GetPointIds()->InsertNextId(id);
-      }
-      vtkNewCells->InsertNextCell(container);
-      if (m_FiberLengths.at(i)<min)
-        min = m_FiberLengths.at(i);
-    }
+      newBuffer.AddFiber(buffer.GetFiberPoints(i), buffer.GetNumberOfPoints(i));
   }
 
-  if (vtkNewCells->GetNumberOfCells()<=0)
+  if (newBuffer.GetNumberOfFibers()<=0)
     return false;
 
-  m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  m_FiberPolyData->SetPoints(vtkNewPoints);
-  m_FiberPolyData->SetLines(vtkNewCells);
-  this->SetFiberPolyData(m_FiberPolyData, true);
+  this->SetFiberPointBuffer(newBuffer, true);
   return true;
 }
 
@@ -2413,52 +2421,43 @@ void mitk::FiberBundle::ResampleToNumPoints(unsigned int targetPoints)
 
 void mitk::FiberBundle::ResampleLinear(double pointDistance)
 {
-  vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-  vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
+  FiberPointBuffer buffer = this->GetFiberPointBuffer();
+  const int numFibers = buffer.GetNumberOfFibers();
 
   MITK_INFO << "Resampling fibers (linear)";
-  boost::progress_display disp(m_FiberPolyData->GetNumberOfCells());
-  vtkSmartPointer<vtkFloatArray> newFiberWeights = vtkSmartPointer<vtkFloatArray>::New();
-  newFiberWeights->SetName("FIBER_WEIGHTS");
-  newFiberWeights->SetNumberOfValues(m_NumFibers);
+  boost::progress_display disp(numFibers);
 
-  std::vector< vtkSmartPointer<vtkPolyLine> > resampled_streamlines;
-  resampled_streamlines.resize(m_FiberPolyData->GetNumberOfCells());
+  std::vector< std::vector< float > > resampled_streamlines;
+  resampled_streamlines.resize(numFibers);
 
 #pragma omp parallel for
-  for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+  for (int i=0; i<numFibers; i++)
   {
+    const float* points = buffer.GetFiberPoints(i);
+    const int numPoints = buffer.GetNumberOfPoints(i);
+    std::vector< float >& container = resampled_streamlines[i];
+    if (numPoints<=0)
+      continue;
 
-    std::vector< vnl_vector_fixed< double, 3 > > vertices;
-
-#pragma omp critical
+    auto vertex = [points](int j)
     {
-      ++disp;
-      vtkCell* cell = m_FiberPolyData->GetCell(i);
-      int numPoints = cell->GetNumberOfPoints();
-      vtkPoints* points = cell->GetPoints();
-
-      for (int j=0; j<numPoints; j++)
-      {
-        double cand[3];
-        points->GetPoint(j, cand);
-        vnl_vector_fixed< double, 3 > candV;
-        candV[0]=cand[0]; candV[1]=cand[1]; candV[2]=cand[2];
-        vertices.push_back(candV);
-      }
-    }
+      vnl_vector_fixed< double, 3 > v;
+      v[0] = points[3*j]; v[1] = points[3*j+1]; v[2] = points[3*j+2];
+      return v;
+    };
+    auto add_point = [&container](const vnl_vector_fixed< double, 3 >& v)
+    {
+      container.push_back(v[0]);
+      container.push_back(v[1]);
+      container.push_back(v[2]);
+    };
 
-    vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-    vnl_vector_fixed< double, 3 > lastV = vertices.at(0);
+    vnl_vector_fixed< double, 3 > lastV = vertex(0);
+    add_point(lastV);
 
-#pragma omp critical
+    for (int j=1; j<numPoints; j++)
     {
-      vtkIdType id = vtkNewPoints->InsertNextPoint(lastV.data_block());
-      container->GetPointIds()->InsertNextId(id);
-    }
-    for (unsigned int j=1; j<vertices.size(); j++)
-    {
-      vnl_vector_fixed< double, 3 > vec = vertices.at(j) - lastV;
+      vnl_vector_fixed< double, 3 > vec = vertex(j) - lastV;
       double new_dist = vec.magnitude();
 
       if (new_dist >= pointDistance)
@@ -2472,8 +2471,8 @@ void mitk::FiberBundle::ResampleLinear(double pointDistance)
         else
         {
           // intersection between sphere (radius 'pointDistance', center 'lastV') and line (direction 'd' and point 'p')
-          vnl_vector_fixed< double, 3 > p = vertices.at(j-1);
-          vnl_vector_fixed< double, 3 > d = vertices.at(j) - p;
+          vnl_vector_fixed< double, 3 > p = vertex(j-1);
+          vnl_vector_fixed< double, 3 > d = vertex(j) - p;
 
           double a = d[0]*d[0] + d[1]*d[1] + d[2]*d[2];
           double b = 2 * (d[0] * (p[0] - lastV[0]) + d[1] * (p[1] - lastV[1]) + d[2] * (p[2] - lastV[2]));
@@ -2492,41 +2491,29 @@ void mitk::FiberBundle::ResampleLinear(double pointDistance)
           j--;
         }
 
-#pragma omp critical
-        {
-          vtkIdType id = vtkNewPoints->InsertNextPoint(newV.data_block());
-          container->GetPointIds()->InsertNextId(id);
-        }
+        add_point(newV);
         lastV = newV;
       }
-      else if (j==vertices.size()-1 && new_dist>0.0001)
+      else if (j==numPoints-1 && new_dist>0.0001)
       {
-#pragma omp critical
-        {
-          vtkIdType id = vtkNewPoints->InsertNextPoint(vertices.at(j).data_block());
-          container->GetPointIds()->InsertNextId(id);
-        }
+        add_point(vertex(j));
       }
     }
 
 #pragma omp critical
-    {
-      resampled_streamlines[i] = container;
-    }
+    ++disp;
   }
 
-  for (auto container : resampled_streamlines)
-  {
-    vtkNewCells->InsertNextCell(container);
-  }
+  FiberPointBuffer newBuffer;
+  std::size_t numNewPoints = 0;
+  for (const auto& container : resampled_streamlines)
+    numNewPoints += container.size()/3;
+  newBuffer.Reserve(numFibers, numNewPoints);
+  for (const auto& container : resampled_streamlines)
+    newBuffer.AddFiber(container);
 
-  if (vtkNewCells->GetNumberOfCells()>0)
-  {
-    m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-    m_FiberPolyData->SetPoints(vtkNewPoints);
-    m_FiberPolyData->SetLines(vtkNewCells);
-    this->SetFiberPolyData(m_FiberPolyData, true);
-  }
+  if (newBuffer.GetNumberOfFibers()>0)
+    this->SetFiberPointBuffer(newBuffer, true);
 }
 
 // reapply selected colorcoding in case PolyData structure has changed
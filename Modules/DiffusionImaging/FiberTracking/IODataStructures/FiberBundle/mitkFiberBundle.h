@@ -26,6 +26,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkPlanarFigure.h>
 #include <mitkPixelTypeTraits.h>
 #include <mitkPlanarFigureComposite.h>
+#include <mitkFiberPointBuffer.h>
+#include <mitkFiberBundleSpatialIndex.h>
 
 
 //includes storing fiberdata
@@ -36,6 +38,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkTransform.h>
 #include <vtkFloatArray.h>
 #include <itkScalableAffineTransform.h>
+#include <memory>
+#include <mutex>
 
 namespace mitk {
 
@@ -119,6 +123,9 @@ public:
     void SetFiberWeights(vtkSmartPointer<vtkFloatArray> weights);
     void SetFiberPolyData(vtkSmartPointer<vtkPolyData>, bool updateGeometry = true);
     vtkSmartPointer<vtkPolyData> GetFiberPolyData() const;
+    FiberPointBuffer GetFiberPointBuffer() const;   ///< Contiguous copy of all fiber points, faster to iterate than the polydata
+    void SetFiberPointBuffer(const FiberPointBuffer& buffer, bool updateGeometry = true);
+    const FiberBundleSpatialIndex& GetSpatialIndex() const;   ///< Built on first use and rebuilt whenever the fiber polydata was modified
     itkGetConstMacro( NumFibers, int)
     //itkGetMacro( FiberSampling, int)
     itkGetConstMacro( MinFiberLength, float )
@@ -176,6 +183,12 @@ private:
     itk::TimeStamp m_UpdateTime2D;
     itk::TimeStamp m_UpdateTime3D;
     mitk::BaseGeometry::Pointer m_ReferenceGeometry;
+
+    // lazily built spatial index and the polydata state it belongs to
+    mutable std::unique_ptr< FiberBundleSpatialIndex > m_SpatialIndex;
+    mutable const vtkPolyData* m_SpatialIndexPolyData;
+    mutable unsigned long m_SpatialIndexMTime;
+    mutable std::mutex m_SpatialIndexMutex;
 };
 
 } // namespace mitk
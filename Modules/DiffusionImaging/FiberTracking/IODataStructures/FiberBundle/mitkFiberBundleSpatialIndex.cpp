@@ -0,0 +1,134 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#include "mitkFiberBundleSpatialIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+mitk::FiberBundleSpatialIndex::FiberBundleSpatialIndex(const FiberPointBuffer& fibers, float cellSize)
+  : m_NumFibers(fibers.GetNumberOfFibers())
+  , m_CellSize(cellSize)
+{
+  double max[3];
+  for (int d=0; d<3; ++d)
+  {
+    m_Origin[d] = std::numeric_limits<double>::max();
+    max[d] = std::numeric_limits<double>::lowest();
+  }
+  const std::vector< float >& points = fibers.GetPoints();
+  for (std::size_t i=0; i<points.size(); i+=3)
+    for (int d=0; d<3; ++d)
+    {
+      m_Origin[d] = std::min(m_Origin[d], static_cast<double>(points[i+d]));
+      max[d] = std::max(max[d], static_cast<double>(points[i+d]));
+    }
+  if (points.empty())
+    for (int d=0; d<3; ++d)
+      m_Origin[d] = max[d] = 0;
+
+  double extent = std::max(max[0]-m_Origin[0], std::max(max[1]-m_Origin[1], max[2]-m_Origin[2]));
+  if (m_CellSize<=0)
+    m_CellSize = std::max(extent/100, 0.001);
+  for (int d=0; d<3; ++d)
+    m_Dim[d] = std::max(1, static_cast<int>(std::floor((max[d]-m_Origin[d])/m_CellSize))+1);
+
+  // two passes over all fibers (count, fill) to build the compressed cell lists without temporary pairs
+  const std::size_t numCells = static_cast<std::size_t>(m_Dim[0])*m_Dim[1]*m_Dim[2];
+  m_CellOffsets.assign(numCells+1, 0);
+  std::vector< unsigned int > cells;
+  for (std::size_t i=0; i<m_NumFibers; ++i)
+  {
+    CollectCells(fibers, i, cells);
+    for (auto c : cells)
+      ++m_CellOffsets[c+1];
+  }
+  for (std::size_t c=0; c<numCells; ++c)
+    m_CellOffsets[c+1] += m_CellOffsets[c];
+
+  m_FiberIds.resize(m_CellOffsets[numCells]);
+  std::vector< std::size_t > fill(m_CellOffsets.begin(), m_CellOffsets.end()-1);
+  for (std::size_t i=0; i<m_NumFibers; ++i)
+  {
+    CollectCells(fibers, i, cells);
+    for (auto c : cells)
+      m_FiberIds[fill[c]++] = static_cast<unsigned int>(i);
+  }
+}
+
+void mitk::FiberBundleSpatialIndex::ClampedCellIndex(const double p[3], int idx[3]) const
+{
+  for (int d=0; d<3; ++d)
+  {
+    double v = std::floor((p[d]-m_Origin[d])/m_CellSize);
+    idx[d] = static_cast<int>(std::max(0.0, std::min(v, static_cast<double>(m_Dim[d]-1))));
+  }
+}
+
+void mitk::FiberBundleSpatialIndex::CollectCells(const FiberPointBuffer& fibers, std::size_t fiber, std::vector< unsigned int >& cells) const
+{
+  cells.clear();
+  const std::size_t numPoints = fibers.GetNumberOfPoints(fiber);
+  const float* p = fibers.GetFiberPoints(fiber);
+  for (std::size_t j=0; j<numPoints; ++j, p+=3)
+  {
+    // bounding box of the segment j -> j+1 (a single point for the last point)
+    const float* q = j+1<numPoints ? p+3 : p;
+    double lower[3], upper[3];
+    for (int d=0; d<3; ++d)
+    {
+      lower[d] = std::min(p[d], q[d]);
+      upper[d] = std::max(p[d], q[d]);
+    }
+    int a[3], b[3];
+    ClampedCellIndex(lower, a);
+    ClampedCellIndex(upper, b);
+    for (int z=a[2]; z<=b[2]; ++z)
+      for (int y=a[1]; y<=b[1]; ++y)
+        for (int x=a[0]; x<=b[0]; ++x)
+          cells.push_back(static_cast<unsigned int>((static_cast<std::size_t>(z)*m_Dim[1] + y)*m_Dim[0] + x));
+  }
+  std::sort(cells.begin(), cells.end());
+  cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+}
+
+std::vector< long > mitk::FiberBundleSpatialIndex::GetCandidateFibers(const double min[3], const double max[3]) const
+{
+  std::vector< long > result;
+  for (int d=0; d<3; ++d)
+    if (max[d]<m_Origin[d] || min[d]>m_Origin[d]+m_Dim[d]*m_CellSize || min[d]>max[d])
+      return result;
+
+  int a[3], b[3];
+  ClampedCellIndex(min, a);
+  ClampedCellIndex(max, b);
+  for (int z=a[2]; z<=b[2]; ++z)
+    for (int y=a[1]; y<=b[1]; ++y)
+      for (int x=a[0]; x<=b[0]; ++x)
+      {
+        std::size_t c = (static_cast<std::size_t>(z)*m_Dim[1] + y)*m_Dim[0] + x;
+        result.insert(result.end(), m_FiberIds.begin()+m_CellOffsets[c], m_FiberIds.begin()+m_CellOffsets[c+1]);
+      }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+std::size_t mitk::FiberBundleSpatialIndex::GetMemorySize() const
+{
+  return sizeof(*this) + m_CellOffsets.capacity()*sizeof(std::size_t) + m_FiberIds.capacity()*sizeof(unsigned int);
+}
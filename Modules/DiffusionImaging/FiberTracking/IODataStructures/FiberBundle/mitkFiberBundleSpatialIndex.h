@@ -0,0 +1,115 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#ifndef _MITK_FiberBundleSpatialIndex_H
+#define _MITK_FiberBundleSpatialIndex_H
+
+#include <MitkFiberTrackingExports.h>
+#include <mitkFiberPointBuffer.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <algorithm>
+#include <vector>
+
+namespace mitk {
+
+/**
+   * \brief Uniform grid over the fiber segments of a tractogram.
+   *
+   * Every grid cell stores the ids of all fibers that have a segment whose bounding box overlaps the cell.
+   * Box queries return a superset of the fibers that pass through the box, so ROI tests only have to check these
+   * candidates instead of every fiber. The index does not track changes of the fibers it was built from;
+   * mitk::FiberBundle::GetSpatialIndex() rebuilds it when the bundle was modified.   */
+class MITKFIBERTRACKING_EXPORT FiberBundleSpatialIndex
+{
+public:
+
+    /** cellSize in mm, 0 chooses about 100 cells along the largest extent of the tractogram. */
+    explicit FiberBundleSpatialIndex(const FiberPointBuffer& fibers, float cellSize = 0);
+
+    /** Sorted ids of all fibers that might pass through the axis aligned box [min, max]. */
+    std::vector< long > GetCandidateFibers(const double min[3], const double max[3]) const;
+
+    std::size_t GetNumberOfFibers() const { return m_NumFibers; }
+    float GetCellSize() const { return m_CellSize; }
+    std::size_t GetMemorySize() const;
+
+    /** World space bounding box of all voxels of the image for which isPositive(pixel) is true, padded by
+     * padVoxels voxels. Returns false if there is no such voxel. */
+    template< class TImage, class TPredicate >
+    static bool GetPositiveBounds(const TImage* image, TPredicate isPositive, double min[3], double max[3], double padVoxels = 1);
+
+private:
+
+    void CollectCells(const FiberPointBuffer& fibers, std::size_t fiber, std::vector< unsigned int >& cells) const;
+    void ClampedCellIndex(const double p[3], int idx[3]) const;
+
+    std::size_t                   m_NumFibers;
+    float                         m_CellSize;
+    double                        m_Origin[3];
+    int                           m_Dim[3];
+    std::vector< std::size_t >    m_CellOffsets;    ///< start of each cell in m_FiberIds, numCells+1 entries
+    std::vector< unsigned int >   m_FiberIds;
+};
+
+template< class TImage, class TPredicate >
+bool FiberBundleSpatialIndex::GetPositiveBounds(const TImage* image, TPredicate isPositive, double min[3], double max[3], double padVoxels)
+{
+  typename TImage::IndexType minIdx, maxIdx;
+  bool found = false;
+  itk::ImageRegionConstIteratorWithIndex< TImage > it(image, image->GetLargestPossibleRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    if (!isPositive(it.Get()))
+      continue;
+    const typename TImage::IndexType& idx = it.GetIndex();
+    for (int d=0; d<3; ++d)
+    {
+      if (!found || idx[d]<minIdx[d])
+        minIdx[d] = idx[d];
+      if (!found || idx[d]>maxIdx[d])
+        maxIdx[d] = idx[d];
+    }
+    found = true;
+  }
+  if (!found)
+    return false;
+
+  // transform all corners of the (padded) index box
+  for (int d=0; d<3; ++d)
+  {
+    min[d] = itk::NumericTraits<double>::max();
+    max[d] = itk::NumericTraits<double>::NonpositiveMin();
+  }
+  for (int c=0; c<8; ++c)
+  {
+    itk::ContinuousIndex< double, 3 > corner;
+    for (int d=0; d<3; ++d)
+      corner[d] = (c>>d)&1 ? maxIdx[d]+0.5+padVoxels : minIdx[d]-0.5-padVoxels;
+    itk::Point< double, 3 > p;
+    image->TransformContinuousIndexToPhysicalPoint(corner, p);
+    for (int d=0; d<3; ++d)
+    {
+      min[d] = std::min(min[d], p[d]);
+      max[d] = std::max(max[d], p[d]);
+    }
+  }
+  return true;
+}
+
+} // namespace mitk
+
+#endif /*  _MITK_FiberBundleSpatialIndex_H */
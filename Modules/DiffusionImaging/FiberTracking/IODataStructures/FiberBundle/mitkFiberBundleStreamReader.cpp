@@ -0,0 +1,408 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#include "mitkFiberBundleStreamReader.h"
+#include <mitkTrackvis.h>
+#include <mitkExceptionMacro.h>
+#include <mitkGeometry3D.h>
+#include <mitkLexicalCast.h>
+#include <itksys/SystemTools.hxx>
+#include <vtkMatrix4x4.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+namespace
+{
+  bool IsSeparator(const float* p)
+  {
+    return std::isnan(p[0]) || std::isnan(p[1]) || std::isnan(p[2]);
+  }
+
+  bool IsTerminator(const float* p)
+  {
+    return std::isinf(p[0]) || std::isinf(p[1]) || std::isinf(p[2]);
+  }
+}
+
+mitk::FiberBundleStreamReader::FiberBundleStreamReader()
+{
+}
+
+mitk::FiberBundleStreamReader::~FiberBundleStreamReader()
+{
+}
+
+std::unique_ptr< mitk::FiberBundleStreamReader > mitk::FiberBundleStreamReader::Create(const std::string& filename)
+{
+  std::string ext = itksys::SystemTools::LowerCase(itksys::SystemTools::GetFilenameLastExtension(filename));
+  if (ext==".tck")
+    return std::unique_ptr< FiberBundleStreamReader >(new TckFiberBundleStreamReader());
+  if (ext==".trk")
+    return std::unique_ptr< FiberBundleStreamReader >(new TrackVisFiberBundleStreamReader());
+  return nullptr;
+}
+
+mitk::FiberPointBuffer mitk::FiberBundleStreamReader::ReadAll()
+{
+  FiberPointBuffer buffer;
+  while (this->ReadChunk(buffer, 100000)>0) {}
+  return buffer;
+}
+
+// ---------------------------------------------------------------------------------------
+// TCK
+
+mitk::TckFiberBundleStreamReader::TckFiberBundleStreamReader()
+  : m_UseMemoryMapping(true)
+  , m_NumberOfThreads(0)
+  , m_FilePointer(nullptr)
+  , m_DataOffset(0)
+  , m_NumTriplets(0)
+  , m_NextTriplet(0)
+  , m_AtEnd(true)
+{
+}
+
+mitk::TckFiberBundleStreamReader::~TckFiberBundleStreamReader()
+{
+  this->Close();
+}
+
+void mitk::TckFiberBundleStreamReader::Open(const std::string& filename)
+{
+  this->Close();
+
+  m_FilePointer = std::fopen(filename.c_str(), "rb");
+  if (m_FilePointer == nullptr)
+    mitkThrow() << "Unable to open file " << filename;
+
+  m_Header = "";
+  char c;
+  while (std::fread(&c, 1, 1, m_FilePointer)==1)
+  {
+    m_Header += c;
+    if (m_Header.size() >= 3 && m_Header.compare(m_Header.size() - 3, 3, "END") == 0)
+      break;
+  }
+
+  std::string delimiter = "file: . ";
+  std::size_t pos = m_Header.find(delimiter);
+  if (pos == std::string::npos)
+    mitkThrow() << "Could not parse header size from " << filename;
+  try
+  {
+    std::string value = m_Header.substr(pos + delimiter.length());
+    m_DataOffset = boost::lexical_cast<std::size_t>(value.substr(0, value.find("\n")));
+  }
+  catch(...)
+  {
+    mitkThrow() << "Could not parse header size from " << filename;
+  }
+
+  pos = m_Header.find("datatype: ");
+  if (pos != std::string::npos && m_Header.compare(pos + 10, 9, "Float32LE") != 0)
+    mitkThrow() << "Unsupported tck datatype in " << filename << ". Only Float32LE is supported.";
+
+  if (m_UseMemoryMapping)
+  {
+    try
+    {
+      m_MappedFile = MemoryMappedFile::New();
+      m_MappedFile->Open(filename);
+      std::size_t size = m_MappedFile->GetSize();
+      m_NumTriplets = size>m_DataOffset ? (size-m_DataOffset)/12 : 0;
+      m_NextTriplet = 0;
+      std::fclose(m_FilePointer);
+      m_FilePointer = nullptr;
+    }
+    catch (const mitk::Exception& e)
+    {
+      MITK_WARN << "Memory mapping failed, reading " << filename << " sequentially: " << e.GetDescription();
+      m_MappedFile = nullptr;
+    }
+  }
+  if (m_FilePointer != nullptr)
+    std::fseek(m_FilePointer, m_DataOffset, SEEK_SET);
+
+  m_CurrentFiber.clear();
+  m_AtEnd = false;
+}
+
+void mitk::TckFiberBundleStreamReader::Close()
+{
+  if (m_FilePointer != nullptr)
+    std::fclose(m_FilePointer);
+  m_FilePointer = nullptr;
+  m_MappedFile = nullptr;
+  m_NumTriplets = 0;
+  m_NextTriplet = 0;
+  m_AtEnd = true;
+}
+
+void mitk::TckFiberBundleStreamReader::GetMappedTriplet(std::size_t i, float* p) const
+{
+  // the data offset is not necessarily aligned
+  std::memcpy(p, static_cast<const char*>(m_MappedFile->GetData()) + m_DataOffset + 12*i, 12);
+}
+
+bool mitk::TckFiberBundleStreamReader::ReadTriplet(float* p)
+{
+  if (m_MappedFile.IsNotNull())
+  {
+    if (m_NextTriplet>=m_NumTriplets)
+      return false;
+    GetMappedTriplet(m_NextTriplet++, p);
+    return true;
+  }
+  return m_FilePointer != nullptr && std::fread(p, 1, 12, m_FilePointer)==12;
+}
+
+std::size_t mitk::TckFiberBundleStreamReader::ReadChunk(FiberPointBuffer& chunk, std::size_t maxFibers)
+{
+  std::size_t count = 0;
+  float p[3];
+  while (count<maxFibers && !m_AtEnd)
+  {
+    if (!ReadTriplet(p) || IsTerminator(p))
+    {
+      m_AtEnd = true;
+      break;
+    }
+
+    if (IsSeparator(p))
+    {
+      chunk.AddFiber(m_CurrentFiber);
+      m_CurrentFiber.clear();
+      ++count;
+    }
+    else
+    {
+      // RAS (MRtrix) to LPS (MITK)
+      m_CurrentFiber.push_back(-p[0]);
+      m_CurrentFiber.push_back(-p[1]);
+      m_CurrentFiber.push_back(p[2]);
+    }
+  }
+  return count;
+}
+
+void mitk::TckFiberBundleStreamReader::DecodeRange(std::size_t first, std::size_t last, std::size_t end, FiberPointBuffer& buffer) const
+{
+  // a fiber belongs to the range that contains its first point
+  float p[3];
+  std::size_t i = first;
+  if (i>m_NextTriplet)
+  {
+    for (; i<last; ++i)
+    {
+      GetMappedTriplet(i-1, p);
+      if (IsSeparator(p))
+        break;
+    }
+  }
+
+  std::vector< float > fiber;
+  while (i<last)
+  {
+    fiber.clear();
+    bool complete = false;
+    for (; i<end; ++i)
+    {
+      GetMappedTriplet(i, p);
+      if (IsSeparator(p))
+      {
+        complete = true;
+        ++i;
+        break;
+      }
+      fiber.push_back(-p[0]);
+      fiber.push_back(-p[1]);
+      fiber.push_back(p[2]);
+    }
+    if (!complete)
+      break;
+    buffer.AddFiber(fiber);
+  }
+}
+
+mitk::FiberPointBuffer mitk::TckFiberBundleStreamReader::ReadAll()
+{
+  // partially read fibers can only be continued sequentially
+  if (m_MappedFile.IsNull() || m_AtEnd || !m_CurrentFiber.empty())
+    return FiberBundleStreamReader::ReadAll();
+
+  unsigned int numThreads = m_NumberOfThreads>0 ? m_NumberOfThreads : std::max(1u, std::thread::hardware_concurrency());
+  const std::size_t begin = m_NextTriplet;
+  const std::size_t numTriplets = m_NumTriplets-begin;
+  numThreads = static_cast<unsigned int>(std::max<std::size_t>(1, std::min<std::size_t>(numThreads, numTriplets/10000)));
+  const std::size_t rangeSize = (numTriplets+numThreads-1)/numThreads;
+
+  auto runParallel = [numThreads](std::function<void(unsigned int)> job)
+  {
+    std::vector< std::thread > workers;
+    for (unsigned int t=1; t<numThreads; ++t)
+      workers.emplace_back(job, t);
+    job(0);
+    for (auto& w : workers)
+      w.join();
+  };
+
+  // the data ends at the first terminator triplet
+  std::vector< std::size_t > ends(numThreads, m_NumTriplets);
+  runParallel([&](unsigned int t)
+  {
+    float p[3];
+    const std::size_t last = std::min(m_NumTriplets, begin+(t+1)*rangeSize);
+    for (std::size_t i=begin+t*rangeSize; i<last; ++i)
+    {
+      GetMappedTriplet(i, p);
+      if (IsTerminator(p))
+      {
+        ends[t] = i;
+        break;
+      }
+    }
+  });
+  const std::size_t end = *std::min_element(ends.begin(), ends.end());
+
+  std::vector< FiberPointBuffer > buffers(numThreads);
+  runParallel([&](unsigned int t)
+  {
+    const std::size_t first = std::min(end, begin+t*rangeSize);
+    const std::size_t last = std::min(end, begin+(t+1)*rangeSize);
+    DecodeRange(first, last, end, buffers[t]);
+  });
+
+  std::size_t numFibers = 0;
+  std::size_t numPoints = 0;
+  for (const auto& b : buffers)
+  {
+    numFibers += b.GetNumberOfFibers();
+    numPoints += b.GetNumberOfPoints();
+  }
+  FiberPointBuffer result;
+  result.Reserve(numFibers, numPoints);
+  for (auto& b : buffers)
+  {
+    for (std::size_t i=0; i<b.GetNumberOfFibers(); ++i)
+      result.AddFiber(b.GetFiberPoints(i), b.GetNumberOfPoints(i));
+    b.Clear();
+  }
+
+  m_NextTriplet = m_NumTriplets;
+  m_AtEnd = true;
+  return result;
+}
+
+// ---------------------------------------------------------------------------------------
+// TrackVis
+
+mitk::TrackVisFiberBundleStreamReader::TrackVisFiberBundleStreamReader()
+  : m_FilePointer(nullptr)
+  , m_NumScalars(0)
+  , m_NumProperties(0)
+{
+  m_Flip[0] = m_Flip[1] = m_Flip[2] = 1;
+}
+
+mitk::TrackVisFiberBundleStreamReader::~TrackVisFiberBundleStreamReader()
+{
+  this->Close();
+}
+
+void mitk::TrackVisFiberBundleStreamReader::Open(const std::string& filename)
+{
+  this->Close();
+
+  m_FilePointer = std::fopen(filename.c_str(), "rb");
+  if (m_FilePointer == nullptr)
+    mitkThrow() << "Unable to open file " << filename;
+
+  TrackVis_header header;
+  if (std::fread(&header, 1, 1000, m_FilePointer) != 1000)
+    mitkThrow() << "Could not read TrackVis header of " << filename;
+
+  m_NumScalars = std::max<short int>(0, header.n_scalars);
+  m_NumProperties = std::max<short int>(0, header.n_properties);
+  m_Flip[0] = header.voxel_order[0]=='R' ? -1 : 1;
+  m_Flip[1] = header.voxel_order[1]=='A' ? -1 : 1;
+  m_Flip[2] = header.voxel_order[2]=='I' ? -1 : 1;
+
+  // same reference geometry as TrackVisFiberReader::read
+  mitk::Geometry3D::Pointer geometry = mitk::Geometry3D::New();
+  vtkSmartPointer< vtkMatrix4x4 > matrix = vtkSmartPointer< vtkMatrix4x4 >::New();
+  matrix->Identity();
+  for (int i=0; i<3; ++i)
+    matrix->SetElement(i, i, m_Flip[i]);
+  geometry->SetIndexToWorldTransformByVtkMatrix(matrix);
+
+  mitk::Point3D origin;
+  mitk::Vector3D spacing;
+  for (int i=0; i<3; ++i)
+  {
+    origin[i] = header.origin[i];
+    spacing[i] = header.voxel_size[i];
+  }
+  geometry->SetOrigin(origin);
+
+  m_ReferenceGeometry = nullptr;
+  if (spacing[0]>0 && spacing[1]>0 && spacing[2]>0 && header.dim[0]>0 && header.dim[1]>0 && header.dim[2]>0)
+  {
+    geometry->SetSpacing(spacing);
+    for (int i=0; i<3; ++i)
+      geometry->SetExtentInMM(i, header.voxel_size[i]*header.dim[i]);
+    m_ReferenceGeometry = geometry.GetPointer();
+  }
+}
+
+void mitk::TrackVisFiberBundleStreamReader::Close()
+{
+  if (m_FilePointer != nullptr)
+    std::fclose(m_FilePointer);
+  m_FilePointer = nullptr;
+}
+
+std::size_t mitk::TrackVisFiberBundleStreamReader::ReadChunk(FiberPointBuffer& chunk, std::size_t maxFibers)
+{
+  if (m_FilePointer == nullptr)
+    return 0;
+
+  const std::size_t valuesPerPoint = 3 + m_NumScalars;
+  std::size_t count = 0;
+  int numPoints = 0;
+  std::vector< float > fiber;
+  while (count<maxFibers && std::fread(&numPoints, 1, 4, m_FilePointer)==4)
+  {
+    if (numPoints <= 0)
+      mitkThrow() << "Trying to read a fiber with " << numPoints << " points!";
+
+    m_PointData.resize(numPoints*valuesPerPoint + m_NumProperties);
+    if (std::fread(m_PointData.data(), sizeof(float), m_PointData.size(), m_FilePointer) != m_PointData.size())
+      mitkThrow() << "Unexpected end of TrackVis file.";
+
+    fiber.resize(3*numPoints);
+    for (int i=0; i<numPoints; ++i)
+      for (int j=0; j<3; ++j)
+        fiber[3*i+j] = m_Flip[j]*m_PointData[i*valuesPerPoint+j];
+    chunk.AddFiber(fiber);
+    ++count;
+  }
+  return count;
+}
@@ -0,0 +1,129 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#ifndef _MITK_FiberBundleStreamReader_H
+#define _MITK_FiberBundleStreamReader_H
+
+#include <MitkFiberTrackingExports.h>
+#include <mitkFiberPointBuffer.h>
+#include <mitkBaseGeometry.h>
+#include <mitkMemoryMappedFile.h>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+namespace mitk {
+
+/**
+   * \brief Reads fibers from a tractogram file in chunks, so that the whole file never has to be held as vtkPolyData.
+   *
+   * All points are returned in MITK world coordinates (LPS). Open() throws an mitk::Exception if the file
+   * can not be read.   */
+class MITKFIBERTRACKING_EXPORT FiberBundleStreamReader
+{
+public:
+
+    virtual ~FiberBundleStreamReader();
+
+    /** Reader matching the file extension (.tck or .trk), nullptr if the format is not supported. */
+    static std::unique_ptr< FiberBundleStreamReader > Create(const std::string& filename);
+
+    virtual void Open(const std::string& filename) = 0;
+    virtual void Close() = 0;
+
+    /** Appends up to maxFibers fibers to chunk. Returns the number of fibers read, 0 at the end of the file. */
+    virtual std::size_t ReadChunk(FiberPointBuffer& chunk, std::size_t maxFibers) = 0;
+
+    /** Reads all remaining fibers. */
+    virtual FiberPointBuffer ReadAll();
+
+    /** Geometry of the reference image stored in the file header, nullptr if not available. */
+    BaseGeometry::Pointer GetReferenceGeometry() const { return m_ReferenceGeometry; }
+
+protected:
+
+    FiberBundleStreamReader();
+
+    BaseGeometry::Pointer m_ReferenceGeometry;
+};
+
+/**
+   * \brief Streaming reader for MRtrix .tck files (Float32LE).
+   *
+   * With memory mapping enabled (default), the file is mapped instead of read and ReadAll() decodes the
+   * data in parallel: the point stream is split into ranges and every thread starts decoding at the first
+   * fiber boundary (NaN triplet) inside its range.   */
+class MITKFIBERTRACKING_EXPORT TckFiberBundleStreamReader : public FiberBundleStreamReader
+{
+public:
+
+    TckFiberBundleStreamReader();
+    ~TckFiberBundleStreamReader() override;
+
+    void SetUseMemoryMapping(bool use) { m_UseMemoryMapping = use; }
+    void SetNumberOfThreads(unsigned int n) { m_NumberOfThreads = n; }   ///< 0 uses all hardware threads
+
+    void Open(const std::string& filename) override;
+    void Close() override;
+    std::size_t ReadChunk(FiberPointBuffer& chunk, std::size_t maxFibers) override;
+    FiberPointBuffer ReadAll() override;
+
+    std::string GetHeader() const { return m_Header; }
+
+private:
+
+    bool ReadTriplet(float* p);
+    void GetMappedTriplet(std::size_t i, float* p) const;
+    void DecodeRange(std::size_t first, std::size_t last, std::size_t end, FiberPointBuffer& buffer) const;
+
+    bool                          m_UseMemoryMapping;
+    unsigned int                  m_NumberOfThreads;
+    std::string                   m_Header;
+    std::FILE*                    m_FilePointer;
+    MemoryMappedFile::Pointer     m_MappedFile;
+    std::size_t                   m_DataOffset;     ///< start of the point data in bytes
+    std::size_t                   m_NumTriplets;    ///< number of complete triplets after the header (mapped file)
+    std::size_t                   m_NextTriplet;    ///< read position in triplets (mapped file)
+    bool                          m_AtEnd;
+    std::vector< float >          m_CurrentFiber;
+};
+
+/**
+   * \brief Streaming reader for TrackVis .trk files. Per point scalars and per track properties are skipped.   */
+class MITKFIBERTRACKING_EXPORT TrackVisFiberBundleStreamReader : public FiberBundleStreamReader
+{
+public:
+
+    TrackVisFiberBundleStreamReader();
+    ~TrackVisFiberBundleStreamReader() override;
+
+    void Open(const std::string& filename) override;
+    void Close() override;
+    std::size_t ReadChunk(FiberPointBuffer& chunk, std::size_t maxFibers) override;
+
+private:
+
+    std::FILE*              m_FilePointer;
+    short int               m_NumScalars;
+    short int               m_NumProperties;
+    float                   m_Flip[3];
+    std::vector< float >    m_PointData;
+};
+
+} // namespace mitk
+
+#endif /*  _MITK_FiberBundleStreamReader_H */
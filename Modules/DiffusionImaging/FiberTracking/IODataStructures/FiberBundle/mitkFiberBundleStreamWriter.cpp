@@ -0,0 +1,271 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#include "mitkFiberBundleStreamWriter.h"
+#include <mitkFiberBundle.h>
+#include <mitkTrackvis.h>
+#include <mitkExceptionMacro.h>
+#include <itksys/SystemTools.hxx>
+#include <vtkCellArray.h>
+#include <cstring>
+#include <limits>
+
+mitk::FiberBundleStreamWriter::FiberBundleStreamWriter()
+  : m_FilePointer(nullptr)
+  , m_NumberOfWrittenFibers(0)
+{
+}
+
+mitk::FiberBundleStreamWriter::~FiberBundleStreamWriter()
+{
+}
+
+std::unique_ptr< mitk::FiberBundleStreamWriter > mitk::FiberBundleStreamWriter::Create(const std::string& filename)
+{
+  std::string ext = itksys::SystemTools::LowerCase(itksys::SystemTools::GetFilenameLastExtension(filename));
+  if (ext==".tck")
+    return std::unique_ptr< FiberBundleStreamWriter >(new TckFiberBundleStreamWriter());
+  if (ext==".trk")
+    return std::unique_ptr< FiberBundleStreamWriter >(new TrackVisFiberBundleStreamWriter());
+  return nullptr;
+}
+
+void mitk::FiberBundleStreamWriter::Write(const FiberBundle* fib, std::size_t chunkSize)
+{
+  vtkPolyData* polyData = fib->GetFiberPolyData();
+  if (polyData == nullptr || polyData->GetLines() == nullptr)
+    return;
+
+  vtkCellArray* lines = polyData->GetLines();
+  vtkPoints* points = polyData->GetPoints();
+
+  FiberPointBuffer chunk;
+  std::vector< float > fiber;
+  vtkIdType numPoints = 0;
+  vtkIdType* pointIds = nullptr;
+  double p[3];
+  for (lines->InitTraversal(); lines->GetNextCell(numPoints, pointIds); )
+  {
+    fiber.resize(3*numPoints);
+    for (vtkIdType j=0; j<numPoints; ++j)
+    {
+      points->GetPoint(pointIds[j], p);
+      fiber[3*j] = p[0];
+      fiber[3*j+1] = p[1];
+      fiber[3*j+2] = p[2];
+    }
+    chunk.AddFiber(fiber);
+
+    if (chunk.GetNumberOfFibers()>=chunkSize)
+    {
+      this->Write(chunk);
+      chunk.Clear();
+    }
+  }
+  if (chunk.GetNumberOfFibers()>0)
+    this->Write(chunk);
+}
+
+// ---------------------------------------------------------------------------------------
+// TCK
+
+mitk::TckFiberBundleStreamWriter::TckFiberBundleStreamWriter()
+  : m_CountPosition(0)
+{
+}
+
+mitk::TckFiberBundleStreamWriter::~TckFiberBundleStreamWriter()
+{
+  if (m_FilePointer != nullptr)
+  {
+    try
+    {
+      this->Close();
+    }
+    catch (...)
+    {
+    }
+  }
+}
+
+void mitk::TckFiberBundleStreamWriter::Open(const std::string& filename, const BaseGeometry*)
+{
+  if (m_FilePointer != nullptr)
+    this->Close();
+
+  m_FilePointer = std::fopen(filename.c_str(), "w+b");
+  if (m_FilePointer == nullptr)
+    mitkThrow() << "Unable to create file " << filename;
+  m_NumberOfWrittenFibers = 0;
+
+  // the count is written with a fixed width so that it can be updated in place on Close()
+  std::string start = "mrtrix tracks\ndatatype: Float32LE\ncount: ";
+  std::string count = "0000000000";
+  std::string header;
+  std::size_t offset = 0;
+  do
+  {
+    std::size_t previous = offset;
+    header = start + count + "\nfile: . " + std::to_string(static_cast<unsigned long long>(offset)) + "\nEND\n";
+    offset = header.size();
+    if (offset==previous)
+      break;
+  } while (true);
+
+  m_CountPosition = start.size();
+  if (std::fwrite(header.data(), 1, header.size(), m_FilePointer) != header.size())
+    mitkThrow() << "Could not write tck header to " << filename;
+}
+
+void mitk::TckFiberBundleStreamWriter::Write(const FiberPointBuffer& fibers)
+{
+  if (m_FilePointer == nullptr)
+    mitkThrow() << "Writer not opened.";
+
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const float separator[3] = {nan, nan, nan};
+  std::vector< float > data;
+  for (std::size_t i=0; i<fibers.GetNumberOfFibers(); ++i)
+  {
+    const std::size_t numPoints = fibers.GetNumberOfPoints(i);
+    const float* p = fibers.GetFiberPoints(i);
+    data.resize(3*numPoints);
+    for (std::size_t j=0; j<numPoints; ++j)
+    {
+      // LPS (MITK) to RAS (MRtrix)
+      data[3*j] = -p[3*j];
+      data[3*j+1] = -p[3*j+1];
+      data[3*j+2] = p[3*j+2];
+    }
+    if (std::fwrite(data.data(), sizeof(float), data.size(), m_FilePointer) != data.size()
+        || std::fwrite(separator, sizeof(float), 3, m_FilePointer) != 3)
+      mitkThrow() << "Problems saving the fiber!";
+  }
+  m_NumberOfWrittenFibers += fibers.GetNumberOfFibers();
+}
+
+void mitk::TckFiberBundleStreamWriter::Close()
+{
+  if (m_FilePointer == nullptr)
+    return;
+
+  const float inf = std::numeric_limits<float>::infinity();
+  const float terminator[3] = {inf, inf, inf};
+  bool ok = std::fwrite(terminator, sizeof(float), 3, m_FilePointer) == 3;
+
+  char count[11];
+  std::snprintf(count, sizeof(count), "%010llu", static_cast<unsigned long long>(m_NumberOfWrittenFibers));
+  ok = ok && std::fseek(m_FilePointer, m_CountPosition, SEEK_SET)==0 && std::fwrite(count, 1, 10, m_FilePointer)==10;
+
+  std::fclose(m_FilePointer);
+  m_FilePointer = nullptr;
+  if (!ok)
+    mitkThrow() << "Could not finalize tck file.";
+}
+
+// ---------------------------------------------------------------------------------------
+// TrackVis
+
+mitk::TrackVisFiberBundleStreamWriter::TrackVisFiberBundleStreamWriter()
+  : m_Lps(true)
+{
+}
+
+mitk::TrackVisFiberBundleStreamWriter::~TrackVisFiberBundleStreamWriter()
+{
+  if (m_FilePointer != nullptr)
+  {
+    try
+    {
+      this->Close();
+    }
+    catch (...)
+    {
+    }
+  }
+}
+
+void mitk::TrackVisFiberBundleStreamWriter::Open(const std::string& filename, const BaseGeometry* referenceGeometry)
+{
+  if (m_FilePointer != nullptr)
+    this->Close();
+
+  TrackVis_header header;
+  std::memset(&header, 0, sizeof(header));
+  if (referenceGeometry != nullptr)
+  {
+    for (int i=0; i<3; i++)
+    {
+      header.dim[i]        = referenceGeometry->GetExtent(i);
+      header.voxel_size[i] = referenceGeometry->GetSpacing()[i];
+      header.origin[i]     = referenceGeometry->GetOrigin()[i];
+    }
+  }
+  std::strcpy(header.voxel_order, m_Lps ? "LPS" : "RAS");
+  header.image_orientation_patient[0] = 1.0;
+  header.image_orientation_patient[4] = 1.0;
+  header.version = 1;
+  header.hdr_size = 1000;
+  std::strcpy(header.id_string, "TRACK");
+
+  m_FilePointer = std::fopen(filename.c_str(), "w+b");
+  if (m_FilePointer == nullptr)
+    mitkThrow() << "Unable to create file " << filename;
+  m_NumberOfWrittenFibers = 0;
+
+  if (std::fwrite(&header, 1, 1000, m_FilePointer) != 1000)
+    mitkThrow() << "Could not write TrackVis header to " << filename;
+}
+
+void mitk::TrackVisFiberBundleStreamWriter::Write(const FiberPointBuffer& fibers)
+{
+  if (m_FilePointer == nullptr)
+    mitkThrow() << "Writer not opened.";
+
+  const float flip = m_Lps ? 1 : -1;
+  std::vector< float > data;
+  for (std::size_t i=0; i<fibers.GetNumberOfFibers(); ++i)
+  {
+    const int numPoints = fibers.GetNumberOfPoints(i);
+    const float* p = fibers.GetFiberPoints(i);
+    data.resize(3*numPoints);
+    for (int j=0; j<numPoints; ++j)
+    {
+      data[3*j] = flip*p[3*j];
+      data[3*j+1] = flip*p[3*j+1];
+      data[3*j+2] = p[3*j+2];
+    }
+    if (std::fwrite(&numPoints, 1, 4, m_FilePointer) != 4
+        || std::fwrite(data.data(), sizeof(float), data.size(), m_FilePointer) != data.size())
+      mitkThrow() << "Problems saving the fiber!";
+  }
+  m_NumberOfWrittenFibers += fibers.GetNumberOfFibers();
+}
+
+void mitk::TrackVisFiberBundleStreamWriter::Close()
+{
+  if (m_FilePointer == nullptr)
+    return;
+
+  int count = static_cast<int>(m_NumberOfWrittenFibers);
+  bool ok = std::fseek(m_FilePointer, 1000-12, SEEK_SET)==0 && std::fwrite(&count, 1, 4, m_FilePointer)==4;
+
+  std::fclose(m_FilePointer);
+  m_FilePointer = nullptr;
+  if (!ok)
+    mitkThrow() << "Could not finalize TrackVis file.";
+}
@@ -0,0 +1,106 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#ifndef _MITK_FiberBundleStreamWriter_H
+#define _MITK_FiberBundleStreamWriter_H
+
+#include <MitkFiberTrackingExports.h>
+#include <mitkFiberPointBuffer.h>
+#include <mitkBaseGeometry.h>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+namespace mitk {
+
+class FiberBundle;
+
+/**
+   * \brief Writes fibers to a tractogram file chunk by chunk, e.g. progressively during tractography.
+   *
+   * Points are expected in MITK world coordinates (LPS). The fiber count in the header is updated on Close().
+   * Errors are reported as mitk::Exception. Instances are not thread safe.   */
+class MITKFIBERTRACKING_EXPORT FiberBundleStreamWriter
+{
+public:
+
+    virtual ~FiberBundleStreamWriter();
+
+    /** Writer matching the file extension (.tck or .trk), nullptr if the format is not supported. */
+    static std::unique_ptr< FiberBundleStreamWriter > Create(const std::string& filename);
+
+    /** Creates the file and writes the header. The reference geometry is optional. */
+    virtual void Open(const std::string& filename, const BaseGeometry* referenceGeometry = nullptr) = 0;
+    virtual void Write(const FiberPointBuffer& fibers) = 0;
+    virtual void Close() = 0;
+
+    /** Writes all fibers of the bundle in chunks of chunkSize fibers. */
+    void Write(const FiberBundle* fib, std::size_t chunkSize = 100000);
+
+    std::size_t GetNumberOfWrittenFibers() const { return m_NumberOfWrittenFibers; }
+
+protected:
+
+    FiberBundleStreamWriter();
+
+    std::FILE*    m_FilePointer;
+    std::size_t   m_NumberOfWrittenFibers;
+};
+
+/**
+   * \brief Streaming writer for MRtrix .tck files (Float32LE, RAS).   */
+class MITKFIBERTRACKING_EXPORT TckFiberBundleStreamWriter : public FiberBundleStreamWriter
+{
+public:
+
+    TckFiberBundleStreamWriter();
+    ~TckFiberBundleStreamWriter() override;
+
+    void Open(const std::string& filename, const BaseGeometry* referenceGeometry = nullptr) override;
+    using FiberBundleStreamWriter::Write;
+    void Write(const FiberPointBuffer& fibers) override;
+    void Close() override;
+
+private:
+
+    long    m_CountPosition;    ///< file position of the fixed width fiber count in the header
+};
+
+/**
+   * \brief Streaming writer for TrackVis .trk files.   */
+class MITKFIBERTRACKING_EXPORT TrackVisFiberBundleStreamWriter : public FiberBundleStreamWriter
+{
+public:
+
+    TrackVisFiberBundleStreamWriter();
+    ~TrackVisFiberBundleStreamWriter() override;
+
+    void SetLps(bool lps) { m_Lps = lps; }   ///< Store the points in LPS (default) or RAS coordinates
+
+    void Open(const std::string& filename, const BaseGeometry* referenceGeometry = nullptr) override;
+    using FiberBundleStreamWriter::Write;
+    void Write(const FiberPointBuffer& fibers) override;
+    void Close() override;
+
+private:
+
+    bool    m_Lps;
+};
+
+} // namespace mitk
+
+#endif /*  _MITK_FiberBundleStreamWriter_H */
@@ -0,0 +1,132 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#include "mitkFiberPointBuffer.h"
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPoints.h>
+#include <cmath>
+#include <cstring>
+
+mitk::FiberPointBuffer::FiberPointBuffer()
+  : m_Offsets(1, 0)
+{
+}
+
+mitk::FiberPointBuffer::FiberPointBuffer(vtkPolyData* polyData)
+  : m_Offsets(1, 0)
+{
+  if (polyData == nullptr || polyData->GetLines() == nullptr || polyData->GetPoints() == nullptr)
+    return;
+
+  vtkCellArray* lines = polyData->GetLines();
+  vtkPoints* points = polyData->GetPoints();
+  Reserve(lines->GetNumberOfCells(), lines->GetNumberOfConnectivityEntries()-lines->GetNumberOfCells());
+
+  // direct access to the coordinates if they are stored as float (default for vtkPoints)
+  vtkFloatArray* floatData = vtkFloatArray::SafeDownCast(points->GetData());
+  const float* floatPoints = floatData != nullptr ? floatData->GetPointer(0) : nullptr;
+
+  vtkIdType numPoints = 0;
+  vtkIdType* pointIds = nullptr;
+  double p[3];
+  for (lines->InitTraversal(); lines->GetNextCell(numPoints, pointIds); )
+  {
+    for (vtkIdType j=0; j<numPoints; ++j)
+    {
+      if (floatPoints != nullptr)
+      {
+        const float* fp = floatPoints + 3*pointIds[j];
+        m_Points.insert(m_Points.end(), fp, fp+3);
+      }
+      else
+      {
+        points->GetPoint(pointIds[j], p);
+        m_Points.push_back(p[0]);
+        m_Points.push_back(p[1]);
+        m_Points.push_back(p[2]);
+      }
+    }
+    m_Offsets.push_back(m_Points.size()/3);
+  }
+}
+
+void mitk::FiberPointBuffer::Clear()
+{
+  m_Points.clear();
+  m_Offsets.assign(1, 0);
+}
+
+void mitk::FiberPointBuffer::Reserve(std::size_t numFibers, std::size_t numPoints)
+{
+  m_Offsets.reserve(numFibers+1);
+  m_Points.reserve(3*numPoints);
+}
+
+void mitk::FiberPointBuffer::AddFiber(const float* points, std::size_t numPoints)
+{
+  m_Points.insert(m_Points.end(), points, points+3*numPoints);
+  m_Offsets.push_back(m_Offsets.back()+numPoints);
+}
+
+float mitk::FiberPointBuffer::GetFiberLength(std::size_t fiber) const
+{
+  const float* p = GetFiberPoints(fiber);
+  std::size_t numPoints = GetNumberOfPoints(fiber);
+  float length = 0;
+  for (std::size_t j=1; j<numPoints; ++j, p+=3)
+  {
+    float dx = p[3]-p[0];
+    float dy = p[4]-p[1];
+    float dz = p[5]-p[2];
+    length += std::sqrt(dx*dx+dy*dy+dz*dz);
+  }
+  return length;
+}
+
+vtkSmartPointer<vtkPolyData> mitk::FiberPointBuffer::ToPolyData() const
+{
+  vtkSmartPointer<vtkFloatArray> coordinates = vtkSmartPointer<vtkFloatArray>::New();
+  coordinates->SetNumberOfComponents(3);
+  coordinates->SetNumberOfTuples(GetNumberOfPoints());
+  if (!m_Points.empty())
+    std::memcpy(coordinates->GetPointer(0), m_Points.data(), m_Points.size()*sizeof(float));
+
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetData(coordinates);
+
+  // connectivity in legacy vtkCellArray layout: (n, id_0, ..., id_n-1) per fiber
+  const std::size_t numFibers = GetNumberOfFibers();
+  vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+  connectivity->SetNumberOfValues(numFibers+GetNumberOfPoints());
+  vtkIdType* c = connectivity->GetPointer(0);
+  for (std::size_t i=0; i<numFibers; ++i)
+  {
+    *c++ = GetNumberOfPoints(i);
+    for (std::size_t j=m_Offsets[i]; j<m_Offsets[i+1]; ++j)
+      *c++ = j;
+  }
+
+  vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+  lines->SetCells(numFibers, connectivity);
+
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  polyData->SetPoints(points);
+  polyData->SetLines(lines);
+  return polyData;
+}
@@ -0,0 +1,71 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#ifndef _MITK_FiberPointBuffer_H
+#define _MITK_FiberPointBuffer_H
+
+#include <MitkFiberTrackingExports.h>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <vector>
+
+namespace mitk {
+
+/**
+   * \brief Compact fiber point storage: one contiguous float buffer (x,y,z per point) and a per-fiber offset table.
+   *
+   * Algorithms that walk all fibers can iterate this buffer directly instead of going through vtkCell/GetPoint.
+   * Conversion from and to vtkPolyData is done in bulk.   */
+class MITKFIBERTRACKING_EXPORT FiberPointBuffer
+{
+public:
+
+    FiberPointBuffer();
+    explicit FiberPointBuffer(vtkPolyData* polyData);   ///< copies all lines of the polydata
+
+    void Clear();
+    void Reserve(std::size_t numFibers, std::size_t numPoints);
+
+    /** Appends a fiber. points has to contain 3*numPoints values. */
+    void AddFiber(const float* points, std::size_t numPoints);
+    void AddFiber(const std::vector< float >& points) { AddFiber(points.data(), points.size()/3); }
+
+    std::size_t GetNumberOfFibers() const { return m_Offsets.size()-1; }
+    std::size_t GetNumberOfPoints() const { return m_Points.size()/3; }
+    std::size_t GetNumberOfPoints(std::size_t fiber) const { return m_Offsets[fiber+1]-m_Offsets[fiber]; }
+
+    /** Pointer to the first coordinate of the given fiber. Points of one fiber are stored consecutively. */
+    const float* GetFiberPoints(std::size_t fiber) const { return &m_Points[3*m_Offsets[fiber]]; }
+    float* GetFiberPoints(std::size_t fiber) { return &m_Points[3*m_Offsets[fiber]]; }
+    const float* GetPoint(std::size_t fiber, std::size_t point) const { return &m_Points[3*(m_Offsets[fiber]+point)]; }
+
+    float GetFiberLength(std::size_t fiber) const;
+
+    const std::vector< float >& GetPoints() const { return m_Points; }
+    std::vector< float >& GetPoints() { return m_Points; }
+
+    vtkSmartPointer<vtkPolyData> ToPolyData() const;
+
+private:
+
+    std::vector< float >        m_Points;     ///< x,y,z of all points
+    std::vector< std::size_t >  m_Offsets;    ///< index of the first point of each fiber, last entry is the total number of points
+};
+
+} // namespace mitk
+
+#endif /*  _MITK_FiberPointBuffer_H */
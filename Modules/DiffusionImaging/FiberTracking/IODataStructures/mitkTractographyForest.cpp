@@ -19,6 +19,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkTractographyForest.h"
 #include <mitkExceptionMacro.h>
 #include <mitkGeometry3D.h>
+#include <mitkLogMacros.h>
+#include <cmath>
 
 namespace mitk
 {
@@ -26,6 +28,7 @@ namespace mitk
 TractographyForest::TractographyForest( std::shared_ptr< vigra::RandomForest<int> > forest )
 {
   m_Forest = forest;
+  BuildFlatForest();
   mitk::Geometry3D::Pointer geometry = mitk::Geometry3D::New();
   SetGeometry(geometry);
 }
@@ -35,9 +38,126 @@ TractographyForest::~TractographyForest()
 
 }
 
+void TractographyForest::BuildFlatForest()
+{
+  m_FlatNodes.clear();
+  m_FlatRoots.clear();
+  m_FlatLeafWeights.clear();
+  if (!HasForest())
+    return;
+
+  const int num_classes = m_Forest->class_count();
+  const bool weighted = m_Forest->options_.predict_weighted_;
+
+  for (int t=0; t<m_Forest->tree_count(); ++t)
+  {
+    const auto& topology = m_Forest->trees_[t].topology_;
+    const auto& parameters = m_Forest->trees_[t].parameters_;
+
+    // pairs of vigra topology index and index of the corresponding flat node
+    std::vector< std::pair<int, int> > stack;
+    m_FlatRoots.push_back(static_cast<int>(m_FlatNodes.size()));
+    m_FlatNodes.push_back(FlatNode());
+    stack.push_back(std::make_pair(2, m_FlatRoots.back()));   // the first two topology entries hold the column and class count
+
+    while (!stack.empty())
+    {
+      int topology_index = stack.back().first;
+      int flat_index = stack.back().second;
+      stack.pop_back();
+
+      int type = topology[topology_index];
+      int parameter_addr = topology[topology_index+1];
+      FlatNode node;
+
+      if (type==vigra::e_ConstProbNode)
+      {
+        double node_weight = weighted ? parameters[parameter_addr] : 1.0;
+        double sum = 0;
+        node.feature = -1;
+        node.left = static_cast<int>(m_FlatLeafWeights.size());
+        node.right = -1;
+        node.threshold = 0;
+        for (int c=0; c<num_classes; ++c)
+        {
+          double w = parameters[parameter_addr+1+c] * node_weight;
+          m_FlatLeafWeights.push_back(w);
+          sum += w;
+        }
+        m_FlatLeafWeights.push_back(sum);
+      }
+      else if (type==vigra::i_ThresholdNode)
+      {
+        node.feature = topology[topology_index+4];
+        node.threshold = parameters[parameter_addr+1];
+        node.left = static_cast<int>(m_FlatNodes.size());
+        m_FlatNodes.push_back(FlatNode());
+        node.right = static_cast<int>(m_FlatNodes.size());
+        m_FlatNodes.push_back(FlatNode());
+        stack.push_back(std::make_pair(topology[topology_index+3], node.right));
+        stack.push_back(std::make_pair(topology[topology_index+2], node.left));
+      }
+      else
+      {
+        MITK_INFO << "Random forest contains unsupported node type " << type << ". Using vigra for prediction.";
+        m_FlatNodes.clear();
+        m_FlatRoots.clear();
+        m_FlatLeafWeights.clear();
+        return;
+      }
+      m_FlatNodes[flat_index] = node;
+    }
+  }
+}
+
 void TractographyForest::PredictProbabilities(vigra::MultiArray<2, float>& features, vigra::MultiArray<2, float>& probabilities) const
 {
-  m_Forest->predictProbabilities(features, probabilities);
+  if (!HasFlatForest())
+  {
+    m_Forest->predictProbabilities(features, probabilities);
+    return;
+  }
+
+  const int num_samples = features.shape(0);
+  const int num_classes = GetNumClasses();
+  if (probabilities.shape(0)!=num_samples || probabilities.shape(1)!=num_classes)
+    mitkThrow() << "Probability array has wrong shape";
+
+  std::vector< bool > valid(num_samples, true);
+  for (int s=0; s<num_samples; ++s)
+    for (int f=0; f<features.shape(1); ++f)
+      if (std::isnan(features(s,f)))
+      {
+        valid[s] = false;
+        break;
+      }
+
+  // trees in the outer loop so that each tree is traversed for the whole batch while its nodes are in the cache
+  std::vector< double > votes(num_samples*(num_classes+1), 0.0);
+  for (unsigned int t=0; t<m_FlatRoots.size(); ++t)
+  {
+    for (int s=0; s<num_samples; ++s)
+    {
+      if (!valid[s])
+        continue;
+
+      const FlatNode* node = &m_FlatNodes[m_FlatRoots[t]];
+      while (node->feature>=0)
+        node = &m_FlatNodes[ features(s,node->feature) < node->threshold ? node->left : node->right ];
+
+      const double* leaf = &m_FlatLeafWeights[node->left];
+      double* sample_votes = &votes[s*(num_classes+1)];
+      for (int c=0; c<=num_classes; ++c)
+        sample_votes[c] += leaf[c];
+    }
+  }
+
+  for (int s=0; s<num_samples; ++s)
+  {
+    const double* sample_votes = &votes[s*(num_classes+1)];
+    for (int c=0; c<num_classes; ++c)
+      probabilities(s,c) = valid[s] && sample_votes[num_classes]>0 ? static_cast<float>(sample_votes[c]/sample_votes[num_classes]) : 0;
+  }
 }
 
 int TractographyForest::GetNumFeatures() const
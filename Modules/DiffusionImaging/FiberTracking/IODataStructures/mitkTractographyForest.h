@@ -50,7 +50,8 @@ public:
   int GetMaxTreeDepth() const;
   int IndexToClassLabel(int idx) const;
   bool HasForest() const;
-  void PredictProbabilities(vigra::MultiArray<2, float>& features, vigra::MultiArray<2, float>& probabilities) const;
+  void PredictProbabilities(vigra::MultiArray<2, float>& features, vigra::MultiArray<2, float>& probabilities) const;   ///< one row of features and probabilities per sample. Larger batches are classified tree by tree using the flattened forest.
+  bool HasFlatForest() const { return !m_FlatRoots.empty(); }  ///< false if the forest contains node types that are not supported by the flattened representation. vigra is used for prediction in this case.
   std::shared_ptr< const vigra::RandomForest<int> > GetForest() const
   { return m_Forest; }
 
@@ -63,8 +64,23 @@ protected:
 
 private:
 
+  /** Flattened decision tree node. Inner nodes send samples with features[feature] < threshold to the left child. Leaves are marked with feature = -1 and store the offset of their class weights in left. */
+  struct FlatNode
+  {
+    int     feature;
+    int     left;
+    int     right;
+    double  threshold;
+  };
+
+  void BuildFlatForest();  ///< copies the vigra trees into one contiguous node array
+
   std::shared_ptr< vigra::RandomForest<int> > m_Forest;   ///< random forest classifier
 
+  std::vector< FlatNode >                     m_FlatNodes;        ///< nodes of all trees, the two children of a node are stored next to each other
+  std::vector< int >                          m_FlatRoots;        ///< index of the root node of each tree in m_FlatNodes
+  std::vector< double >                       m_FlatLeafWeights;  ///< per leaf: weighted vote of each class followed by the sum of these votes
+
 };
 
 } // namespace mitk
@@ -20,6 +20,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itksys/SystemTools.hxx>
 #include <mitkTestingConfig.h>
 #include <mitkIOUtil.h>
+#include <mitkFiberBundleStreamReader.h>
+#include <mitkFiberBundleStreamWriter.h>
 
 #include "mitkTestFixture.h"
 
@@ -28,6 +30,8 @@ class mitkFiberBundleReaderWriterTestSuite : public mitk::TestFixture
 
   CPPUNIT_TEST_SUITE(mitkFiberBundleReaderWriterTestSuite);
   MITK_TEST(Equal_SaveLoad_ReturnsTrue);
+  MITK_TEST(Equal_StreamTck_ReturnsTrue);
+  MITK_TEST(Equal_StreamTrk_ReturnsTrue);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -66,6 +70,50 @@ public:
     //MITK_ASSERT_EQUAL(fib1, fib2, "A saved and re-loaded file should be equal");
   }
 
+  void Equal_StreamTck_ReturnsTrue()
+  {
+    std::string filename = std::string(MITK_TEST_OUTPUT_DIR)+"/writerTest.tck";
+    mitk::TckFiberBundleStreamWriter writer;
+    writer.Open(filename);
+    writer.Write(fib1.GetPointer(), 7);
+    writer.Close();
+    CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(fib1->GetNumFibers()), writer.GetNumberOfWrittenFibers());
+
+    // chunked sequential reading
+    mitk::TckFiberBundleStreamReader reader;
+    reader.SetUseMemoryMapping(false);
+    reader.Open(filename);
+    mitk::FiberPointBuffer chunked;
+    while (reader.ReadChunk(chunked, 5)>0) {}
+    reader.Close();
+    fib2 = mitk::FiberBundle::New(chunked.ToPolyData());
+    CPPUNIT_ASSERT_MESSAGE("Chunked tck reading should be equal", fib1->Equals(fib2));
+
+    // memory mapped parallel reading
+    mitk::TckFiberBundleStreamReader mappedReader;
+    mappedReader.SetNumberOfThreads(4);
+    mappedReader.Open(filename);
+    fib2 = mitk::FiberBundle::New(mappedReader.ReadAll().ToPolyData());
+    CPPUNIT_ASSERT_MESSAGE("Memory mapped tck reading should be equal", fib1->Equals(fib2));
+  }
+
+  void Equal_StreamTrk_ReturnsTrue()
+  {
+    std::string filename = std::string(MITK_TEST_OUTPUT_DIR)+"/writerTest.trk";
+    std::unique_ptr<mitk::FiberBundleStreamWriter> writer = mitk::FiberBundleStreamWriter::Create(filename);
+    CPPUNIT_ASSERT(writer != nullptr);
+    writer->Open(filename, fib1->GetGeometry());
+    writer->Write(fib1.GetPointer(), 7);
+    writer->Close();
+
+    std::unique_ptr<mitk::FiberBundleStreamReader> reader = mitk::FiberBundleStreamReader::Create(filename);
+    CPPUNIT_ASSERT(reader != nullptr);
+    reader->Open(filename);
+    fib2 = mitk::FiberBundle::New(reader->ReadAll().ToPolyData());
+    reader->Close();
+    CPPUNIT_ASSERT_MESSAGE("Streamed trk should be equal", fib1->Equals(fib2));
+  }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkFiberBundleReaderWriter)
@@ -0,0 +1,188 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkFiberTrackingBenchmarkUtils.h"
+
+#include <mitkClusteringMetricEuclideanMean.h>
+#include <mitkDataNode.h>
+#include <mitkPlanarCircle.h>
+#include <mitkPlaneGeometry.h>
+#include <mitkStandaloneDataStorage.h>
+
+#include <itkFiberExtractionFilter.h>
+#include <itkTractClusteringFilter.h>
+#include <itkTractDensityImageFilter.h>
+
+namespace
+{
+  long long GetNumberOfFibers(mitk::FiberBundle *fib) { return fib->GetNumFibers(); }
+  long long GetNumberOfPoints(mitk::FiberBundle *fib) { return static_cast<long long>(fib->GetNumberOfPoints()); }
+}
+
+// Arguments of all benchmarks in this file: fibers per phantom bundle, number of threads
+
+void BM_TractDensityImage(mitk::BenchmarkState &state)
+{
+  mitk::FiberBundle::Pointer fib = mitk::FiberPhantom::Get(static_cast<unsigned int>(state.range(0))).GetTractogram();
+  mitk::SetBenchmarkThreads(state, state.range(1));
+
+  typedef itk::Image<float, 3> ImageType;
+  mitk::PeakMemorySampler memory;
+  while (state.KeepRunning())
+  {
+    itk::TractDensityImageFilter<ImageType>::Pointer filter = itk::TractDensityImageFilter<ImageType>::New();
+    filter->SetFiberBundle(fib);
+    filter->SetUpsamplingFactor(2);
+    filter->Update();
+    mitk::DoNotOptimize(filter->GetOutput());
+  }
+  mitk::ReportFiberThroughput(state,
+                              state.GetIterations() * GetNumberOfFibers(fib),
+                              state.GetIterations() * GetNumberOfPoints(fib),
+                              memory);
+}
+MITK_BENCHMARK(BM_TractDensityImage)
+  ->Args({1000, 1})
+  ->Args({10000, 1})
+  ->Args({50000, 1})
+  ->Args({50000, 2})
+  ->Args({50000, 4})
+  ->Args({50000, 8});
+
+void BM_TractClustering(mitk::BenchmarkState &state)
+{
+  mitk::FiberBundle::Pointer fib = mitk::FiberPhantom::Get(static_cast<unsigned int>(state.range(0))).GetTractogram();
+  mitk::SetBenchmarkThreads(state, state.range(1));
+
+  mitk::PeakMemorySampler memory;
+  while (state.KeepRunning())
+  {
+    itk::TractClusteringFilter::Pointer clusterer = itk::TractClusteringFilter::New();
+    clusterer->SetDistances({10, 20, 30});
+    clusterer->SetTractogram(fib);
+    clusterer->SetMetrics({new mitk::ClusteringMetricEuclideanMean()});
+    clusterer->Update();
+    mitk::DoNotOptimize(clusterer->GetOutCentroids());
+  }
+  mitk::ReportFiberThroughput(state,
+                              state.GetIterations() * GetNumberOfFibers(fib),
+                              state.GetIterations() * GetNumberOfPoints(fib),
+                              memory);
+}
+MITK_BENCHMARK(BM_TractClustering)
+  ->Args({1000, 1})
+  ->Args({10000, 1})
+  ->Args({10000, 2})
+  ->Args({10000, 4})
+  ->Args({10000, 8});
+
+// ResampleSpline works in place, the copy of the phantom is not measured
+void BM_FiberResampleSpline(mitk::BenchmarkState &state)
+{
+  mitk::FiberBundle::Pointer fib = mitk::FiberPhantom::Get(static_cast<unsigned int>(state.range(0))).GetTractogram();
+  mitk::SetBenchmarkThreads(state, state.range(1));
+
+  mitk::PeakMemorySampler memory;
+  while (state.KeepRunning())
+  {
+    state.PauseTiming();
+    mitk::FiberBundle::Pointer copy = fib->GetDeepCopy();
+    state.ResumeTiming();
+
+    copy->ResampleSpline(0.5);
+  }
+  mitk::ReportFiberThroughput(state,
+                              state.GetIterations() * GetNumberOfFibers(fib),
+                              state.GetIterations() * GetNumberOfPoints(fib),
+                              memory);
+}
+MITK_BENCHMARK(BM_FiberResampleSpline)->Args({1000, 1})->Args({10000, 1})->Args({10000, 4})->Args({10000, 8});
+
+// Fibers passing a circle in the central axial plane, the extraction path of the fiber dissection view
+void BM_FiberExtractPlanarFigure(mitk::BenchmarkState &state)
+{
+  mitk::FiberBundle::Pointer fib = mitk::FiberPhantom::Get(static_cast<unsigned int>(state.range(0))).GetTractogram();
+  mitk::SetBenchmarkThreads(state, state.range(1));
+
+  mitk::Vector3D spacing;
+  spacing.Fill(1.0);
+  mitk::PlaneGeometry::Pointer plane = mitk::PlaneGeometry::New();
+  plane->InitializeStandardPlane(100, 100, spacing, mitk::PlaneGeometry::Axial, 50);
+
+  mitk::PlanarCircle::Pointer circle = mitk::PlanarCircle::New();
+  circle->SetPlaneGeometry(plane);
+  mitk::Point2D center;
+  center[0] = 50;
+  center[1] = 54;
+  circle->PlaceFigure(center);
+  mitk::Point2D boundary = center;
+  boundary[0] += 4;
+  circle->SetControlPoint(1, boundary);
+
+  mitk::StandaloneDataStorage::Pointer storage = mitk::StandaloneDataStorage::New();
+  mitk::DataNode::Pointer roi = mitk::DataNode::New();
+  roi->SetData(circle);
+  storage->Add(roi);
+
+  // the spatial index is built on first use, the benchmark measures the repeated extraction
+  fib->GetSpatialIndex();
+
+  mitk::PeakMemorySampler memory;
+  while (state.KeepRunning())
+  {
+    mitk::FiberBundle::Pointer extracted = fib->ExtractFiberSubset(roi, storage);
+    mitk::DoNotOptimize(extracted.GetPointer());
+  }
+  mitk::ReportFiberThroughput(state,
+                              state.GetIterations() * GetNumberOfFibers(fib),
+                              state.GetIterations() * GetNumberOfPoints(fib),
+                              memory);
+}
+MITK_BENCHMARK(BM_FiberExtractPlanarFigure)->Args({1000, 1})->Args({10000, 1})->Args({50000, 1});
+
+// Fibers overlapping the phantom envelope, i.e. the worst case where every fiber is positive
+void BM_FiberExtractRoiImage(mitk::BenchmarkState &state)
+{
+  mitk::FiberPhantom &phantom = mitk::FiberPhantom::Get(static_cast<unsigned int>(state.range(0)));
+  mitk::FiberBundle::Pointer fib = phantom.GetTractogram();
+  mitk::FiberPhantom::ItkFloatImgType::Pointer roi = phantom.GetMask();
+  mitk::SetBenchmarkThreads(state, state.range(1));
+
+  typedef itk::FiberExtractionFilter<float> ExtractorType;
+  mitk::PeakMemorySampler memory;
+  while (state.KeepRunning())
+  {
+    ExtractorType::Pointer extractor = ExtractorType::New();
+    extractor->SetInputFiberBundle(fib);
+    extractor->SetRoiImages({roi.GetPointer()});
+    extractor->SetOverlapFraction(0.5);
+    extractor->SetDontResampleFibers(true);
+    extractor->SetNoNegatives(true);
+    extractor->SetMode(ExtractorType::MODE::OVERLAP);
+    extractor->Update();
+    mitk::DoNotOptimize(extractor->GetPositives());
+  }
+  mitk::ReportFiberThroughput(state,
+                              state.GetIterations() * GetNumberOfFibers(fib),
+                              state.GetIterations() * GetNumberOfPoints(fib),
+                              memory);
+}
+MITK_BENCHMARK(BM_FiberExtractRoiImage)
+  ->Args({1000, 1})
+  ->Args({10000, 1})
+  ->Args({50000, 1})
+  ->Args({50000, 4})
+  ->Args({50000, 8});
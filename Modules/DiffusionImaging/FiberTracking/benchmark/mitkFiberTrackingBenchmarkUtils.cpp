@@ -0,0 +1,296 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkFiberTrackingBenchmarkUtils.h"
+
+#include <mitkFiberfoxParameters.h>
+#include <mitkMemoryUtilities.h>
+#include <mitkPlanarEllipse.h>
+#include <mitkPlaneGeometry.h>
+
+#include <itkFibersFromPlanarFiguresFilter.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+#include <itkTensorImageToOdfImageFilter.h>
+#include <itkTractDensityImageFilter.h>
+#include <itkTractsToVectorImageFilter.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <omp.h>
+
+namespace
+{
+  // Circular fiducial with the given center and radius in the 2D coordinates of a 100x100 mm standard plane
+  mitk::PlanarEllipse::Pointer CreateFiducial(mitk::PlaneGeometry::PlaneOrientation orientation,
+                                              double position,
+                                              double u,
+                                              double v,
+                                              double radius)
+  {
+    mitk::Vector3D spacing;
+    spacing.Fill(1.0);
+    mitk::PlaneGeometry::Pointer plane = mitk::PlaneGeometry::New();
+    plane->InitializeStandardPlane(100, 100, spacing, orientation, position);
+
+    mitk::PlanarEllipse::Pointer figure = mitk::PlanarEllipse::New();
+    figure->SetPlaneGeometry(plane);
+
+    mitk::Point2D center;
+    center[0] = u;
+    center[1] = v;
+    figure->PlaceFigure(center);
+
+    mitk::Point2D boundary = center;
+    boundary[0] += radius;
+    figure->SetControlPoint(1, boundary);
+    return figure;
+  }
+}
+
+mitk::FiberPhantom &mitk::FiberPhantom::Get(unsigned int fibersPerBundle)
+{
+  static std::map<unsigned int, std::unique_ptr<FiberPhantom>> phantoms;
+  std::unique_ptr<FiberPhantom> &phantom = phantoms[fibersPerBundle];
+  if (!phantom)
+    phantom.reset(new FiberPhantom(fibersPerBundle));
+  return *phantom;
+}
+
+mitk::FiberPhantom::FiberPhantom(unsigned int fibersPerBundle) : m_FibersPerBundle(fibersPerBundle)
+{
+}
+
+mitk::FiberBundle::Pointer mitk::FiberPhantom::GetTractogram()
+{
+  if (m_Tractogram.IsNotNull())
+    return m_Tractogram;
+
+  FiberGenerationParameters parameters;
+  parameters.m_Distribution = FiberGenerationParameters::DISTRIBUTE_UNIFORM;
+  parameters.m_Density = m_FibersPerBundle;
+  parameters.m_Sampling = 1;
+  parameters.m_Tension = 0;
+  parameters.m_Continuity = 0;
+  parameters.m_Bias = 0;
+
+  // bundle along z with a slight bend, crossing a straight bundle along x in the center of the phantom
+  std::vector<mitk::PlanarEllipse::Pointer> bundle;
+  bundle.push_back(CreateFiducial(mitk::PlaneGeometry::Axial, 10, 50, 50, 8));
+  bundle.push_back(CreateFiducial(mitk::PlaneGeometry::Axial, 50, 50, 54, 8));
+  bundle.push_back(CreateFiducial(mitk::PlaneGeometry::Axial, 90, 50, 50, 8));
+  parameters.m_Fiducials.push_back(bundle);
+  parameters.m_FlipList.push_back(std::vector<unsigned int>(bundle.size(), 0));
+
+  bundle.clear();
+  bundle.push_back(CreateFiducial(mitk::PlaneGeometry::Sagittal, 10, 50, 50, 8));
+  bundle.push_back(CreateFiducial(mitk::PlaneGeometry::Sagittal, 50, 50, 50, 8));
+  bundle.push_back(CreateFiducial(mitk::PlaneGeometry::Sagittal, 90, 50, 50, 8));
+  parameters.m_Fiducials.push_back(bundle);
+  parameters.m_FlipList.push_back(std::vector<unsigned int>(bundle.size(), 0));
+
+  itk::FibersFromPlanarFiguresFilter::Pointer filter = itk::FibersFromPlanarFiguresFilter::New();
+  filter->SetParameters(parameters);
+  filter->Update();
+
+  m_Tractogram = FiberBundle::New(nullptr);
+  m_Tractogram = m_Tractogram->AddBundles(filter->GetFiberBundles());
+  return m_Tractogram;
+}
+
+mitk::FiberPhantom::ItkFloatImgType::Pointer mitk::FiberPhantom::GetMask()
+{
+  if (m_Mask.IsNotNull())
+    return m_Mask;
+
+  itk::TractDensityImageFilter<ItkFloatImgType>::Pointer filter = itk::TractDensityImageFilter<ItkFloatImgType>::New();
+  filter->SetFiberBundle(this->GetTractogram());
+  filter->SetBinaryOutput(true);
+  filter->Update();
+  m_Mask = filter->GetOutput();
+  return m_Mask;
+}
+
+mitk::FiberPhantom::ItkUcharImgType::Pointer mitk::FiberPhantom::GetUcharMask()
+{
+  if (m_UcharMask.IsNotNull())
+    return m_UcharMask;
+
+  ItkFloatImgType::Pointer mask = this->GetMask();
+  m_UcharMask = ItkUcharImgType::New();
+  m_UcharMask->SetSpacing(mask->GetSpacing());
+  m_UcharMask->SetOrigin(mask->GetOrigin());
+  m_UcharMask->SetDirection(mask->GetDirection());
+  m_UcharMask->SetRegions(mask->GetLargestPossibleRegion());
+  m_UcharMask->Allocate();
+
+  itk::ImageRegionConstIterator<ItkFloatImgType> in(mask, mask->GetLargestPossibleRegion());
+  itk::ImageRegionIterator<ItkUcharImgType> out(m_UcharMask, m_UcharMask->GetLargestPossibleRegion());
+  for (; !in.IsAtEnd(); ++in, ++out)
+    out.Set(in.Get() > 0 ? 1 : 0);
+  return m_UcharMask;
+}
+
+mitk::FiberPhantom::PeakImgType::Pointer mitk::FiberPhantom::GetPeaks()
+{
+  if (m_Peaks.IsNotNull())
+    return m_Peaks;
+
+  itk::TractsToVectorImageFilter<float>::Pointer filter = itk::TractsToVectorImageFilter<float>::New();
+  filter->SetFiberBundle(this->GetTractogram());
+  filter->SetMaskImage(this->GetUcharMask());
+  filter->SetMaxNumDirections(2);
+  filter->Update();
+  m_Peaks = filter->GetDirectionImage();
+  return m_Peaks;
+}
+
+mitk::FiberPhantom::ItkTensorImageType::Pointer mitk::FiberPhantom::GetTensors()
+{
+  if (m_Tensors.IsNotNull())
+    return m_Tensors;
+
+  PeakImgType::Pointer peaks = this->GetPeaks();
+  const PeakImgType::SpacingType peakSpacing = peaks->GetSpacing();
+  const PeakImgType::PointType peakOrigin = peaks->GetOrigin();
+  const PeakImgType::DirectionType peakDirection = peaks->GetDirection();
+  const PeakImgType::SizeType peakSize = peaks->GetLargestPossibleRegion().GetSize();
+
+  ItkTensorImageType::SpacingType spacing;
+  ItkTensorImageType::PointType origin;
+  ItkTensorImageType::DirectionType direction;
+  ItkTensorImageType::RegionType region;
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    spacing[i] = peakSpacing[i];
+    origin[i] = peakOrigin[i];
+    region.SetSize(i, peakSize[i]);
+    for (unsigned int j = 0; j < 3; ++j)
+      direction[i][j] = peakDirection[i][j];
+  }
+
+  m_Tensors = ItkTensorImageType::New();
+  m_Tensors->SetSpacing(spacing);
+  m_Tensors->SetOrigin(origin);
+  m_Tensors->SetDirection(direction);
+  m_Tensors->SetRegions(region);
+  m_Tensors->Allocate();
+
+  // prolate tensors along the first peak, FA ~0.7 inside of the bundles and 0 outside
+  const float parallel = 0.0017f;
+  const float perpendicular = 0.0003f;
+  const float isotropic = 0.0007f;
+
+  itk::ImageRegionIterator<ItkTensorImageType> it(m_Tensors, region);
+  for (; !it.IsAtEnd(); ++it)
+  {
+    const ItkTensorImageType::IndexType index3 = it.GetIndex();
+    PeakImgType::IndexType index4;
+    for (unsigned int i = 0; i < 3; ++i)
+      index4[i] = index3[i];
+
+    float v[3];
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      index4[3] = i;
+      v[i] = peaks->GetPixel(index4);
+    }
+
+    ItkTensorImageType::PixelType tensor;
+    tensor.Fill(0);
+    const float norm = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (norm > 0)
+    {
+      for (unsigned int i = 0; i < 3; ++i)
+        v[i] /= norm;
+      tensor(0, 0) = perpendicular + (parallel - perpendicular) * v[0] * v[0];
+      tensor(0, 1) = (parallel - perpendicular) * v[0] * v[1];
+      tensor(0, 2) = (parallel - perpendicular) * v[0] * v[2];
+      tensor(1, 1) = perpendicular + (parallel - perpendicular) * v[1] * v[1];
+      tensor(1, 2) = (parallel - perpendicular) * v[1] * v[2];
+      tensor(2, 2) = perpendicular + (parallel - perpendicular) * v[2] * v[2];
+    }
+    else
+    {
+      tensor(0, 0) = tensor(1, 1) = tensor(2, 2) = isotropic;
+    }
+    it.Set(tensor);
+  }
+  return m_Tensors;
+}
+
+mitk::FiberPhantom::ItkOdfImageType::Pointer mitk::FiberPhantom::GetOdfs()
+{
+  if (m_Odfs.IsNotNull())
+    return m_Odfs;
+
+  typedef itk::TensorImageToOdfImageFilter<float, float> FilterType;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(this->GetTensors());
+  filter->Update();
+  m_Odfs = filter->GetOutput();
+  return m_Odfs;
+}
+
+mitk::PeakMemorySampler::PeakMemorySampler()
+  : m_Baseline(MemoryUtilities::GetProcessMemoryUsage()), m_Peak(m_Baseline), m_Running(true)
+{
+  m_Thread = std::thread([this]() {
+    while (m_Running)
+    {
+      const std::size_t usage = MemoryUtilities::GetProcessMemoryUsage();
+      if (usage > m_Peak)
+        m_Peak = usage;
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  });
+}
+
+mitk::PeakMemorySampler::~PeakMemorySampler()
+{
+  this->Stop();
+}
+
+double mitk::PeakMemorySampler::Stop()
+{
+  if (m_Running)
+  {
+    m_Running = false;
+    m_Thread.join();
+  }
+  const std::size_t peak = std::max<std::size_t>(m_Peak, MemoryUtilities::GetProcessMemoryUsage());
+  return peak > m_Baseline ? static_cast<double>(peak - m_Baseline) / (1024 * 1024) : 0.0;
+}
+
+void mitk::ReportFiberThroughput(BenchmarkState &state,
+                                 long long numFibers,
+                                 long long numPoints,
+                                 PeakMemorySampler &memory)
+{
+  state.SetItemsProcessed(numFibers);
+  if (state.GetRealTime() > 0)
+    state.SetCounter("points_per_second", numPoints / state.GetRealTime());
+  state.SetCounter("peak_memory_MiB", memory.Stop());
+}
+
+void mitk::SetBenchmarkThreads(BenchmarkState &state, long long numThreads)
+{
+  omp_set_num_threads(static_cast<int>(numThreads));
+  state.SetCounter("threads", static_cast<double>(numThreads));
+}
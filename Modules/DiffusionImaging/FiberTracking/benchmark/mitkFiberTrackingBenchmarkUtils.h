@@ -0,0 +1,110 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKFIBERTRACKINGBENCHMARKUTILS_H
+#define MITKFIBERTRACKINGBENCHMARKUTILS_H
+
+#include "mitkBenchmark.h"
+
+#include <mitkFiberBundle.h>
+#include <mitkOdfImage.h>
+#include <mitkTensorImage.h>
+
+#include <itkImage.h>
+
+#include <atomic>
+#include <thread>
+
+namespace mitk
+{
+  /**
+   * @brief Synthetic Fiberfox phantom of two crossing, slightly curved bundles and the images derived from it.
+   *
+   * The bundles are generated with itk::FibersFromPlanarFiguresFilter from circular fiducials, the size of the
+   * phantom is given by the number of fibers per bundle. The derived images are computed on first use and cached,
+   * so that the set-up is only paid once per phantom and is not part of the measured time.
+   */
+  class FiberPhantom
+  {
+  public:
+    typedef itk::Image<float, 3> ItkFloatImgType;
+    typedef itk::Image<unsigned char, 3> ItkUcharImgType;
+    typedef itk::Image<float, 4> PeakImgType;
+    typedef TensorImage::ItkTensorImageType ItkTensorImageType;
+    typedef OdfImage::ItkOdfImageType ItkOdfImageType;
+
+    /** @brief Phantom with the given number of fibers per bundle, created on first request */
+    static FiberPhantom &Get(unsigned int fibersPerBundle);
+
+    /** @brief The phantom tractogram, do not modify, use GetDeepCopy() instead */
+    FiberBundle::Pointer GetTractogram();
+    /** @brief Binary envelope of the tractogram, used as tracking mask and seed image */
+    ItkFloatImgType::Pointer GetMask();
+    ItkUcharImgType::Pointer GetUcharMask();
+    /** @brief Fiber orientation distribution peaks in the MRtrix layout */
+    PeakImgType::Pointer GetPeaks();
+    /** @brief Tensors with the principal direction of the strongest peak, isotropic outside of the bundles */
+    ItkTensorImageType::Pointer GetTensors();
+    ItkOdfImageType::Pointer GetOdfs();
+
+  private:
+    explicit FiberPhantom(unsigned int fibersPerBundle);
+
+    unsigned int m_FibersPerBundle;
+    FiberBundle::Pointer m_Tractogram;
+    ItkFloatImgType::Pointer m_Mask;
+    ItkUcharImgType::Pointer m_UcharMask;
+    PeakImgType::Pointer m_Peaks;
+    ItkTensorImageType::Pointer m_Tensors;
+    ItkOdfImageType::Pointer m_Odfs;
+  };
+
+  /**
+   * @brief Polls the resident memory of the process in a background thread and keeps the maximum.
+   *
+   * Sampling starts on construction. Stop() returns the peak increase over the memory in use at construction
+   * in MiB, so allocations that are freed again before the next sample are missed.
+   */
+  class PeakMemorySampler
+  {
+  public:
+    PeakMemorySampler();
+    ~PeakMemorySampler();
+
+    double Stop();
+
+  private:
+    PeakMemorySampler(const PeakMemorySampler &) = delete;
+    PeakMemorySampler &operator=(const PeakMemorySampler &) = delete;
+
+    std::size_t m_Baseline;
+    std::atomic<std::size_t> m_Peak;
+    std::atomic<bool> m_Running;
+    std::thread m_Thread;
+  };
+
+  /**
+   * @brief Reports streamlines/s as items per second and points/s, and the peak memory as counters.
+   *
+   * Has to be called after the KeepRunning() loop, numFibers and numPoints are the totals over all iterations.
+   */
+  void ReportFiberThroughput(BenchmarkState &state, long long numFibers, long long numPoints, PeakMemorySampler &memory);
+
+  /** @brief Sets the number of OpenMP threads used by the fiber tracking filters and reports it as counter */
+  void SetBenchmarkThreads(BenchmarkState &state, long long numThreads);
+}
+
+#endif // MITKFIBERTRACKINGBENCHMARKUTILS_H
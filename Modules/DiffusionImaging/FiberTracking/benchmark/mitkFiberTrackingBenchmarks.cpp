@@ -0,0 +1,29 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkBenchmark.h"
+
+/**
+ * Benchmarks of streamline tractography, fiber processing and tractogram IO on synthetic Fiberfox phantoms.
+ *
+ * Besides the time, every benchmark reports streamlines/s (items_per_second), points_per_second, the peak
+ * memory increase during the run and the number of OpenMP threads, so thread scaling curves can be plotted
+ * from the output of --benchmark_out=results.json.
+ */
+int main(int argc, char *argv[])
+{
+  return mitk::RunBenchmarks(argc, argv);
+}
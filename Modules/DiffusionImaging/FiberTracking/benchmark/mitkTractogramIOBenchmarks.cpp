@@ -0,0 +1,181 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkFiberTrackingBenchmarkUtils.h"
+
+#include <mitkFiberBundleStreamReader.h>
+#include <mitkFiberBundleStreamWriter.h>
+#include <mitkIOUtil.h>
+
+#include <itksys/SystemTools.hxx>
+
+#include <memory>
+
+namespace
+{
+  // All temporary files of this translation unit go to one directory, so that they are removed even
+  // if a benchmark fails
+  class TemporaryDirectory
+  {
+  public:
+    TemporaryDirectory() : m_Path(mitk::IOUtil::CreateTemporaryDirectory("MitkFiberTrackingBenchmarks-XXXXXX")) {}
+    ~TemporaryDirectory() { itksys::SystemTools::RemoveADirectory(m_Path); }
+    std::string GetFilePath(const std::string &name) const { return m_Path + "/" + name; }
+
+  private:
+    std::string m_Path;
+  };
+
+  const TemporaryDirectory &GetTemporaryDirectory()
+  {
+    static TemporaryDirectory directory;
+    return directory;
+  }
+
+  mitk::FiberBundle::Pointer GetPhantom(mitk::BenchmarkState &state)
+  {
+    return mitk::FiberPhantom::Get(static_cast<unsigned int>(state.range(0))).GetTractogram();
+  }
+
+  // MRtrix files can only be written by the stream writer, the other formats go through the registered writers
+  void Save(mitk::FiberBundle *fib, const std::string &path)
+  {
+    if (itksys::SystemTools::GetFilenameLastExtension(path) == ".tck")
+    {
+      std::unique_ptr<mitk::FiberBundleStreamWriter> writer = mitk::FiberBundleStreamWriter::Create(path);
+      writer->Open(path, fib->GetGeometry());
+      writer->Write(fib);
+      writer->Close();
+    }
+    else
+    {
+      mitk::IOUtil::Save(fib, path);
+    }
+  }
+
+  void RunWrite(mitk::BenchmarkState &state, const std::string &extension)
+  {
+    mitk::FiberBundle::Pointer fib = GetPhantom(state);
+    const std::string path = GetTemporaryDirectory().GetFilePath("write" + extension);
+
+    mitk::PeakMemorySampler memory;
+    while (state.KeepRunning())
+    {
+      Save(fib, path);
+    }
+    state.SetBytesProcessed(state.GetIterations() * itksys::SystemTools::FileLength(path));
+    mitk::ReportFiberThroughput(state,
+                                state.GetIterations() * fib->GetNumFibers(),
+                                state.GetIterations() * static_cast<long long>(fib->GetNumberOfPoints()),
+                                memory);
+  }
+
+  void RunRead(mitk::BenchmarkState &state, const std::string &extension)
+  {
+    mitk::FiberBundle::Pointer fib = GetPhantom(state);
+    const std::string path = GetTemporaryDirectory().GetFilePath("read" + extension);
+    Save(fib, path);
+
+    mitk::PeakMemorySampler memory;
+    while (state.KeepRunning())
+    {
+      mitk::FiberBundle::Pointer loaded = mitk::IOUtil::Load<mitk::FiberBundle>(path);
+      mitk::DoNotOptimize(loaded.GetPointer());
+    }
+    state.SetBytesProcessed(state.GetIterations() * itksys::SystemTools::FileLength(path));
+    mitk::ReportFiberThroughput(state,
+                                state.GetIterations() * fib->GetNumFibers(),
+                                state.GetIterations() * static_cast<long long>(fib->GetNumberOfPoints()),
+                                memory);
+  }
+
+  // Decoding in chunks without ever creating the vtkPolyData of the whole tractogram
+  void RunStreamRead(mitk::BenchmarkState &state, const std::string &extension)
+  {
+    mitk::FiberBundle::Pointer fib = GetPhantom(state);
+    const std::string path = GetTemporaryDirectory().GetFilePath("stream" + extension);
+    Save(fib, path);
+
+    long long numFibers = 0;
+    long long numPoints = 0;
+    mitk::PeakMemorySampler memory;
+    while (state.KeepRunning())
+    {
+      std::unique_ptr<mitk::FiberBundleStreamReader> reader = mitk::FiberBundleStreamReader::Create(path);
+      reader->Open(path);
+      mitk::FiberPointBuffer chunk;
+      while (reader->ReadChunk(chunk, 10000) > 0)
+      {
+        numFibers += chunk.GetNumberOfFibers();
+        numPoints += chunk.GetNumberOfPoints();
+        chunk.Clear();
+      }
+      reader->Close();
+    }
+    state.SetBytesProcessed(state.GetIterations() * itksys::SystemTools::FileLength(path));
+    mitk::ReportFiberThroughput(state, numFibers, numPoints, memory);
+  }
+}
+
+// Argument of all benchmarks in this file: fibers per phantom bundle
+
+void BM_TractogramWriteTck(mitk::BenchmarkState &state)
+{
+  RunWrite(state, ".tck");
+}
+MITK_BENCHMARK(BM_TractogramWriteTck)->Arg(1000)->Arg(50000);
+
+void BM_TractogramWriteTrk(mitk::BenchmarkState &state)
+{
+  RunWrite(state, ".trk");
+}
+MITK_BENCHMARK(BM_TractogramWriteTrk)->Arg(1000)->Arg(50000);
+
+void BM_TractogramWriteVtk(mitk::BenchmarkState &state)
+{
+  RunWrite(state, ".fib");
+}
+MITK_BENCHMARK(BM_TractogramWriteVtk)->Arg(1000)->Arg(50000);
+
+void BM_TractogramReadTck(mitk::BenchmarkState &state)
+{
+  RunRead(state, ".tck");
+}
+MITK_BENCHMARK(BM_TractogramReadTck)->Arg(1000)->Arg(50000);
+
+void BM_TractogramReadTrk(mitk::BenchmarkState &state)
+{
+  RunRead(state, ".trk");
+}
+MITK_BENCHMARK(BM_TractogramReadTrk)->Arg(1000)->Arg(50000);
+
+void BM_TractogramReadVtk(mitk::BenchmarkState &state)
+{
+  RunRead(state, ".fib");
+}
+MITK_BENCHMARK(BM_TractogramReadVtk)->Arg(1000)->Arg(50000);
+
+void BM_TractogramStreamReadTck(mitk::BenchmarkState &state)
+{
+  RunStreamRead(state, ".tck");
+}
+MITK_BENCHMARK(BM_TractogramStreamReadTck)->Arg(1000)->Arg(50000);
+
+void BM_TractogramStreamReadTrk(mitk::BenchmarkState &state)
+{
+  RunStreamRead(state, ".trk");
+}
+MITK_BENCHMARK(BM_TractogramStreamReadTrk)->Arg(1000)->Arg(50000);
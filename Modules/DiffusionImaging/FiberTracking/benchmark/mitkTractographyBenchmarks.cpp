@@ -0,0 +1,95 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkFiberTrackingBenchmarkUtils.h"
+
+#include <itkStreamlineTrackingFilter.h>
+#include <mitkTrackingHandlerOdf.h>
+#include <mitkTrackingHandlerPeaks.h>
+#include <mitkTrackingHandlerTensor.h>
+
+#include <vtkPolyData.h>
+
+namespace
+{
+  // The tracking phantom is fixed, its size is varied via the seeds per voxel of the binary bundle envelope
+  const unsigned int TrackingPhantomFibersPerBundle = 2000;
+
+  void RunStreamlineTracking(mitk::BenchmarkState &state, mitk::TrackingDataHandler *handler)
+  {
+    mitk::FiberPhantom &phantom = mitk::FiberPhantom::Get(TrackingPhantomFibersPerBundle);
+    mitk::FiberPhantom::ItkFloatImgType::Pointer mask = phantom.GetMask();
+    mitk::SetBenchmarkThreads(state, state.range(1));
+
+    long long numFibers = 0;
+    long long numPoints = 0;
+    mitk::PeakMemorySampler memory;
+    while (state.KeepRunning())
+    {
+      itk::StreamlineTrackingFilter::Pointer tracker = itk::StreamlineTrackingFilter::New();
+      tracker->SetRandom(false);
+      tracker->SetVerbose(false);
+      tracker->SetInterpolateMasks(false);
+      tracker->SetNumberOfSamples(0);
+      tracker->SetAngularThreshold(-1);
+      tracker->SetMaskImage(mask);
+      tracker->SetSeedImage(mask);
+      tracker->SetSeedsPerVoxel(static_cast<int>(state.range(0)));
+      tracker->SetStepSize(0.5);
+      tracker->SetSamplingDistance(0.25);
+      tracker->SetMinTractLength(20);
+      tracker->SetMaxNumTracts(-1);
+      tracker->SetTrackingHandler(handler);
+      tracker->SetUseOutputProbabilityMap(false);
+      tracker->Update();
+
+      vtkSmartPointer<vtkPolyData> polyData = tracker->GetFiberPolyData();
+      numFibers += polyData->GetNumberOfLines();
+      numPoints += polyData->GetNumberOfPoints();
+    }
+    mitk::ReportFiberThroughput(state, numFibers, numPoints, memory);
+  }
+}
+
+// Arguments: seeds per voxel, number of threads
+void BM_StreamlineTrackingPeaks(mitk::BenchmarkState &state)
+{
+  mitk::TrackingHandlerPeaks handler;
+  handler.SetPeakImage(mitk::FiberPhantom::Get(TrackingPhantomFibersPerBundle).GetPeaks());
+  handler.SetPeakThreshold(0.1f);
+  RunStreamlineTracking(state, &handler);
+}
+MITK_BENCHMARK(BM_StreamlineTrackingPeaks)->Args({1, 1})->Args({1, 2})->Args({1, 4})->Args({1, 8})->Args({4, 8});
+
+void BM_StreamlineTrackingTensor(mitk::BenchmarkState &state)
+{
+  mitk::TrackingHandlerTensor handler;
+  handler.SetTensorImage(mitk::FiberPhantom::Get(TrackingPhantomFibersPerBundle).GetTensors().GetPointer());
+  handler.SetFaThreshold(0.2f);
+  RunStreamlineTracking(state, &handler);
+}
+MITK_BENCHMARK(BM_StreamlineTrackingTensor)->Args({1, 1})->Args({1, 2})->Args({1, 4})->Args({1, 8})->Args({4, 8});
+
+void BM_StreamlineTrackingOdf(mitk::BenchmarkState &state)
+{
+  mitk::TrackingHandlerOdf handler;
+  handler.SetOdfImage(mitk::FiberPhantom::Get(TrackingPhantomFibersPerBundle).GetOdfs());
+  handler.SetGfaThreshold(0.2f);
+  handler.SetOdfThreshold(0.1f);
+  handler.SetIsOdfFromTensor(true);
+  RunStreamlineTracking(state, &handler);
+}
+MITK_BENCHMARK(BM_StreamlineTrackingOdf)->Args({1, 1})->Args({1, 2})->Args({1, 4})->Args({1, 8})->Args({4, 8});
@@ -48,6 +48,7 @@ int main(int argc, char* argv[])
   parser.addArgument("input", "i", mitkCommandLineParser::String, "Input:", "Input tractogram or diffusion-weighted image.", us::Any(), false);
   parser.addArgument("template", "t", mitkCommandLineParser::String, "Template image:", "Use parameters of the template diffusion-weighted image.", us::Any());
   parser.addArgument("verbose", "v", mitkCommandLineParser::Bool, "Output additional images:", "output volume fraction images etc.", us::Any());
+  parser.addArgument("stream", "s", mitkCommandLineParser::Int, "Streamed volumes:", "number of volumes simulated at once to limit the memory consumption, 0 simulates all volumes at once. No phase and coil images are generated when streaming.", 0);
 
   std::map<std::string, us::Any> parsedArgs = parser.parseArguments(argc, argv);
   if (parsedArgs.size()==0)
@@ -65,6 +66,9 @@ int main(int argc, char* argv[])
   bool verbose = false;
   if (parsedArgs.count("verbose"))
     verbose = us::any_cast<bool>(parsedArgs["verbose"]);
+  int streamedVolumes = 0;
+  if (parsedArgs.count("stream"))
+    streamedVolumes = us::any_cast<int>(parsedArgs["stream"]);
 
   FiberfoxParameters parameters;
   parameters.LoadParameters(paramName);
@@ -177,6 +181,8 @@ int main(int argc, char* argv[])
     parameters.SaveParameters(outName+".ffp");
   }
   tractsToDwiFilter->SetParameters(parameters);
+  if (streamedVolumes>0)
+    tractsToDwiFilter->SetNumberOfStreamedVolumes(streamedVolumes);
   tractsToDwiFilter->Update();
 
   mitk::Image::Pointer image = mitk::GrabItkImageMemory( tractsToDwiFilter->GetOutput() );
@@ -63,6 +63,7 @@ int main(int argc, char* argv[])
   parser.addArgument("parameters", "p", mitkCommandLineParser::InputFile, "Parameters:", "parameter file (.gtp)", us::Any(), false);
   parser.addArgument("mask", "m", mitkCommandLineParser::InputFile, "Mask:", "binary mask image");
   parser.addArgument("outFile", "o", mitkCommandLineParser::OutputFile, "Output:", "output fiber bundle (.fib)", us::Any(), false);
+  parser.addArgument("replicas", "", mitkCommandLineParser::Int, "Replicas:", "number of parallel tempering replicas, each needs its own particle grid (default 1)");
 
   std::map<std::string, us::Any> parsedArgs = parser.parseArguments(argc, argv);
   if (parsedArgs.size()==0)
@@ -143,6 +144,8 @@ int main(int argc, char* argv[])
 
     gibbsTracker->SetDuplicateImage(false);
     gibbsTracker->SetLoadParameterFile( paramFileName );
+    if (parsedArgs.count("replicas"))
+      gibbsTracker->SetNumReplicas(us::any_cast<int>(parsedArgs["replicas"]));
     //        gibbsTracker->SetLutPath( "" );
     gibbsTracker->Update();
 
@@ -4,6 +4,10 @@ set(CPP_FILES
 
   ## IO datastructures
   IODataStructures/FiberBundle/mitkFiberBundle.cpp
+  IODataStructures/FiberBundle/mitkFiberBundleStreamReader.cpp
+  IODataStructures/FiberBundle/mitkFiberBundleStreamWriter.cpp
+  IODataStructures/FiberBundle/mitkFiberPointBuffer.cpp
+  IODataStructures/FiberBundle/mitkFiberBundleSpatialIndex.cpp
   IODataStructures/FiberBundle/mitkTrackvis.cpp
   IODataStructures/PlanarFigureComposite/mitkPlanarFigureComposite.cpp
   IODataStructures/mitkTractographyForest.cpp
@@ -24,11 +28,16 @@ set(CPP_FILES
   Algorithms/TrackingHandlers/mitkTrackingHandlerTensor.cpp
   Algorithms/TrackingHandlers/mitkTrackingHandlerPeaks.cpp
   Algorithms/TrackingHandlers/mitkTrackingHandlerOdf.cpp
+  Algorithms/TrackingHandlers/mitkTrackingVolume.cpp
 )
 
 set(H_FILES
   # DataStructures -> FiberBundle
   IODataStructures/FiberBundle/mitkFiberBundle.h
+  IODataStructures/FiberBundle/mitkFiberBundleStreamReader.h
+  IODataStructures/FiberBundle/mitkFiberBundleStreamWriter.h
+  IODataStructures/FiberBundle/mitkFiberPointBuffer.h
+  IODataStructures/FiberBundle/mitkFiberBundleSpatialIndex.h
   IODataStructures/FiberBundle/mitkTrackvis.h
   IODataStructures/mitkFiberfoxParameters.h
   IODataStructures/mitkTractographyForest.h
@@ -42,6 +51,7 @@ set(H_FILES
   Algorithms/itkEvaluateTractogramDirectionsFilter.h
   Algorithms/itkFiberCurvatureFilter.h
   Algorithms/itkFitFibersToImageFilter.h
+  Algorithms/mitkCsrMatrix.h
   Algorithms/itkTractClusteringFilter.h
   Algorithms/itkFiberExtractionFilter.h
   Algorithms/itkTdiToVolumeFractionFilter.h
@@ -52,6 +62,7 @@ set(H_FILES
   Algorithms/TrackingHandlers/mitkTrackingHandlerTensor.h
   Algorithms/TrackingHandlers/mitkTrackingHandlerPeaks.h
   Algorithms/TrackingHandlers/mitkTrackingHandlerOdf.h
+  Algorithms/TrackingHandlers/mitkTrackingVolume.h
 
   Algorithms/itkGibbsTrackingFilter.h
   Algorithms/itkStochasticTractographyFilter.h
@@ -93,6 +93,20 @@ public:
   itkSetMacro(NumberIterations, int);
   itkGetMacro(NumberIterations, int);
 
+  /** Reuse two image buffers for all iterations and compute local variation and update in one
+   *  threaded pass per iteration, instead of running a filter pipeline per iteration (default true) */
+  itkSetMacro(UsePingPongBuffers, bool);
+  itkGetMacro(UsePingPongBuffers, bool);
+  itkBooleanMacro(UsePingPongBuffers);
+
+  /** Stop as soon as the relative change of f and D in one iteration is below this threshold,
+   *  0 runs all iterations (default). Only used with ping-pong buffers. */
+  itkSetMacro(ConvergenceThreshold, double);
+  itkGetMacro(ConvergenceThreshold, double);
+
+  /** Number of iterations that were run in the last update */
+  itkGetMacro(NumberOfPerformedIterations, int);
+
   void SetBValues( vnl_vector<double> bvals )
   { this->m_BValues = bvals; }
   vnl_vector<double> GetBValues()
@@ -110,10 +124,19 @@ protected:
 
   void GenerateData();
 
+  /** Runs the iterations on two buffers, image is replaced by the buffer holding the result */
+  void RunPingPongIterations( typename OutputImageType::Pointer& image );
+
   double m_Lambda;
 
   int m_NumberIterations;
 
+  bool m_UsePingPongBuffers;
+
+  double m_ConvergenceThreshold;
+
+  int m_NumberOfPerformedIterations;
+
   typename RefImageType::Pointer m_ReferenceImage;
 
   vnl_vector<double> m_BValues;
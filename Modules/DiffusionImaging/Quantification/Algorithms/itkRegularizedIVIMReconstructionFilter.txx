@@ -24,9 +24,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkZeroFluxNeumannBoundaryCondition.h"
 #include "itkOffset.h"
 #include "itkProgressReporter.h"
+#include "itkRegularizedIVIMLocalVariationImageFilter.h"
 
 #include <vector>
 #include <algorithm>
+#include <omp.h>
 
 namespace itk
 {
@@ -36,6 +38,9 @@ namespace itk
     ::RegularizedIVIMReconstructionFilter()
   {
     m_Lambda = 1.0;
+    m_UsePingPongBuffers = true;
+    m_ConvergenceThreshold = 0.0;
+    m_NumberOfPerformedIterations = 0;
   }
 
 
@@ -50,19 +55,27 @@ namespace itk
     infilter->Update();
     typename OutputImageType::Pointer image = infilter->GetOutput();
 
-    typename SingleIterationFilterType::Pointer filter;
-    for(int i=0; i<m_NumberIterations; i++)
+    if( m_UsePingPongBuffers )
     {
-      filter = SingleIterationFilterType::New();
-      filter->SetInput( image.GetPointer() );
-      filter->SetOriginalImage( m_ReferenceImage );
-      filter->SetBValues(m_BValues);
-      filter->SetLambda(m_Lambda);
-      filter->SetNumberOfThreads(this->GetNumberOfThreads());
-      filter->UpdateLargestPossibleRegion();
-      image = filter->GetOutput();
-      std::cout << "Iteration " << i+1 << "/" <<
-        m_NumberIterations << std::endl;
+      RunPingPongIterations( image );
+    }
+    else
+    {
+      typename SingleIterationFilterType::Pointer filter;
+      for(int i=0; i<m_NumberIterations; i++)
+      {
+        filter = SingleIterationFilterType::New();
+        filter->SetInput( image.GetPointer() );
+        filter->SetOriginalImage( m_ReferenceImage );
+        filter->SetBValues(m_BValues);
+        filter->SetLambda(m_Lambda);
+        filter->SetNumberOfThreads(this->GetNumberOfThreads());
+        filter->UpdateLargestPossibleRegion();
+        image = filter->GetOutput();
+        std::cout << "Iteration " << i+1 << "/" <<
+          m_NumberIterations << std::endl;
+      }
+      m_NumberOfPerformedIterations = m_NumberIterations;
     }
 
     typename OutputImageType::Pointer output = this->GetOutput();
@@ -90,6 +103,164 @@ namespace itk
   }
 
 
+  /**
+  * Same update as RegularizedIVIMReconstructionSingleIteration, but on raw buffers: in every
+  * iteration the local variation of the current buffer is computed first, after a barrier the
+  * update is written to the other buffer. Out of image neighbours behave like the zero flux
+  * Neumann boundary condition of the single iteration filter.
+  */
+  template <class TInputPixel, class TOutputPixel, class TRefPixelType>
+  void
+  RegularizedIVIMReconstructionFilter<TInputPixel, TOutputPixel, TRefPixelType>
+    ::RunPingPongIterations( typename OutputImageType::Pointer& image )
+  {
+    const OutputImageRegionType region = image->GetLargestPossibleRegion();
+    if( m_ReferenceImage.IsNull() || !( m_ReferenceImage->GetLargestPossibleRegion().GetSize() == region.GetSize() ) )
+    {
+      itkExceptionMacro(<< "Reference image does not match the size of the input image.");
+    }
+
+    typename OutputImageType::Pointer buffers[2];
+    buffers[0] = image;
+    buffers[1] = OutputImageType::New();
+    buffers[1]->CopyInformation( image );
+    buffers[1]->SetRegions( region );
+    buffers[1]->Allocate();
+
+    const int sx = region.GetSize()[0];
+    const int sy = region.GetSize()[1];
+    const int sz = region.GetSize()[2];
+    const int numRows = sy * sz;
+    const int strides[3] = { 1, sx, sx * sy };
+    const int sizes[3] = { sx, sy, sz };
+
+    const TRefPixelType* reference = m_ReferenceImage->GetBufferPointer();
+    const int numComponents = m_ReferenceImage->GetNumberOfComponentsPerPixel();
+    const int numBValues = m_BValues.size();
+    const double lambda = m_Lambda;
+
+    std::vector< float > localVariation( region.GetNumberOfPixels() );
+
+    int current = 0;
+    m_NumberOfPerformedIterations = 0;
+    for( int i=0; i<m_NumberIterations; i++ )
+    {
+      const OutputVectorType* u = buffers[current]->GetBufferPointer();
+      OutputVectorType* next = buffers[1-current]->GetBufferPointer();
+
+      double changeF = 0;
+      double changeD = 0;
+      double sumF = 0;
+      double sumD = 0;
+
+#pragma omp parallel num_threads(this->GetNumberOfThreads())
+      {
+        // neighbours: -x, +x, -y, +y, -z, +z, out of image neighbours are replaced by the voxel itself
+        int neighbors[6];
+
+#pragma omp for schedule(static)
+        for( int row=0; row<numRows; row++ )
+        {
+          const int y = row % sy;
+          const int z = row / sy;
+          for( int x=0; x<sx; x++ )
+          {
+            const int index = x + sx*row;
+            const int pos[3] = { x, y, z };
+            float locVariation = 0;
+            for( int d=0; d<3; d++ )
+            {
+              if( pos[d] > 0 )
+                locVariation += IVIMSquaredEuclideanMetric<OutputVectorType>::Calc( u[index-strides[d]] - u[index] );
+              if( pos[d] < sizes[d]-1 )
+                locVariation += IVIMSquaredEuclideanMetric<OutputVectorType>::Calc( u[index+strides[d]] - u[index] );
+            }
+            localVariation[index] = sqrt(locVariation + 0.0001);
+          }
+        }
+        // implicit barrier, the local variation of all voxels is needed from here on
+
+#pragma omp for schedule(static) reduction(+:changeF,changeD,sumF,sumD)
+        for( int row=0; row<numRows; row++ )
+        {
+          const int y = row % sy;
+          const int z = row / sy;
+          for( int x=0; x<sx; x++ )
+          {
+            const int index = x + sx*row;
+            const int pos[3] = { x, y, z };
+            for( int d=0; d<3; d++ )
+            {
+              neighbors[2*d] = pos[d] > 0 ? index-strides[d] : index;
+              neighbors[2*d+1] = pos[d] < sizes[d]-1 ? index+strides[d] : index;
+            }
+
+            // w_alphabeta(u) =
+            //   1 / ||nabla_alpha(u)||_a + 1 / ||nabla_beta(u)||_a
+            const double locvar_alpha_inv = 1.0/localVariation[index];
+            double ws[6];
+            double wsum = 0;
+            for( int n=0; n<6; n++ )
+            {
+              ws[n] = locvar_alpha_inv + (1.0/(double)localVariation[neighbors[n]]);
+              wsum += ws[n];
+            }
+
+            const OutputVectorType& in = u[index];
+            const TRefPixelType* orig = reference + index*numComponents;
+            vnl_vector_fixed<double,2> step;
+            step[0] = 0; step[1]=0;
+            for( int ind=0; ind<numBValues; ind++ )
+            {
+              const double e = exp(-m_BValues[ind]*in[1]);
+              double estim = (1-in[0])*e;
+              double estimdash1 = e;
+              double estimdash2 = (-1.0) * (1.0-in[0]) * m_BValues[ind] * e;
+              if(orig[ind] != IVIM_FOO)
+              {
+                step[0] += ((double) orig[ind] - estim) * estimdash2;
+                step[1] += ((double) orig[ind] - estim) * estimdash1;
+              }
+            }
+
+            step[1] *= lambda / (lambda+wsum);
+            for( int n=0; n<6; n++ )
+            {
+              step[1] += (u[neighbors[n]][1] - in[1]) * (ws[n] / (lambda+wsum));
+            }
+
+            OutputVectorType out = in;
+            out[0] = in[0] + .001*step[0];
+            out[1] = in[1] + .00001*step[1];
+            next[index] = out;
+
+            changeF += std::fabs( out[0] - in[0] );
+            changeD += std::fabs( out[1] - in[1] );
+            sumF += std::fabs( in[0] );
+            sumD += std::fabs( in[1] );
+          }
+        }
+      }
+
+      current = 1-current;
+      m_NumberOfPerformedIterations++;
+      std::cout << "Iteration " << i+1 << "/" <<
+        m_NumberIterations << std::endl;
+
+      if( m_ConvergenceThreshold > 0 )
+      {
+        const double relativeChange = std::max( sumF > 0 ? changeF/sumF : 0.0, sumD > 0 ? changeD/sumD : 0.0 );
+        if( relativeChange < m_ConvergenceThreshold )
+        {
+          std::cout << "Converged after " << i+1 << " iterations" << std::endl;
+          break;
+        }
+      }
+    }
+
+    image = buffers[current];
+  }
+
   /**
   * Standard "PrintSelf" method
   */
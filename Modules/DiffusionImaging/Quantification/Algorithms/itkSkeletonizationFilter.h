@@ -33,6 +33,9 @@ namespace itk
   *
   *
   * The skeletonization algorithm is described in Smith et al., 2009. http://dx.doi.org/10.1016/j.neuroimage.2006.02.024 )
+  *
+  * The direction estimation, the direction smoothing and the non-maximum-suppression are distributed over
+  * the slices of the image using the number of threads of the filter.
   */
 
 
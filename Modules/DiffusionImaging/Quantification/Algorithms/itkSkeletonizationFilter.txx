@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkProgressBar.h"
 #include <limits>
 #include <ctime>
+#include <vector>
 
 namespace itk
 {
@@ -53,8 +54,7 @@ namespace itk
     const InputImageType* faImage = this->GetInput();
     typename InputImageType::SizeType size = faImage->GetRequestedRegion().GetSize();
 
-    //typename RealImageType::SizeType size = m_FaImage->GetRequestedRegion().GetSize();
-
+    m_DirectionImage = VectorImageType::New();
     m_DirectionImage->SetRegions(faImage->GetRequestedRegion());
     m_DirectionImage->SetDirection(faImage->GetDirection());
     m_DirectionImage->SetSpacing(faImage->GetSpacing());
@@ -62,12 +62,52 @@ namespace itk
     m_DirectionImage->Allocate();
     m_DirectionImage->FillBuffer(0.0);
 
+    // All three passes work on the raw buffers. The neighbours are addressed by linear offsets,
+    // which are the same for every voxel and are computed once.
+    const int sx = size[0];
+    const int sy = size[1];
+    const int sz = size[2];
+    const long sxy = (long)sx*sy;
+    const long numPixels = sxy*sz;
+    const int numThreads = this->GetNumberOfThreads();
+
+    const typename InputImageType::PixelType* fa = faImage->GetBufferPointer();
+    VectorType* directions = m_DirectionImage->GetBufferPointer();
+
+    // 3x3x3 neighbourhood, dx runs fastest
+    long neighborOffsets[27];
+    for(int dz=-1, n=0; dz<=1; dz++) for(int dy=-1; dy<=1; dy++) for(int dx=-1; dx<=1; dx++, n++)
+      neighborOffsets[n] = dx + dy*sx + dz*sxy;
+
+    // Half of the neighbourhood that is searched for the direction of maximum curvature,
+    // together with the distance weighting of each direction
+    std::vector< VectorType > searchDirections;
+    std::vector< long > searchOffsets;
+    std::vector< float > searchWeights;
+    for(int zz=0; zz<=1; zz++) // note - starts at zero as we're only searching half the voxels
+    {
+      for(int yy=-1; yy<=1; yy++)
+      {
+        for(int xx=-1; xx<=1; xx++)
+        {
+          if ( (zz==1) || (yy==1) || ((yy==0)&&(xx==1)) )
+          {
+            VectorType vec;
+            vec[0] = xx; vec[1] = yy; vec[2] = zz;
+            searchDirections.push_back(vec);
+            searchOffsets.push_back(xx + yy*sx + zz*sxy);
+            searchWeights.push_back(pow( (float)(xx*xx+yy*yy+zz*zz) , (float)-0.7 )); // power is arbitrary: maybe test other functions here
+          }
+        }
+      }
+    }
+    const int numSearchDirections = searchDirections.size();
 
-    for(unsigned int z=1; z<size[2]-1; z++) for(unsigned int y=1; y<size[1]-1; y++) for(unsigned int x=1; x<size[0]-1; x++)
+#pragma omp parallel for num_threads(numThreads) schedule(dynamic)
+    for(int z=1; z<sz-1; z++) for(int y=1; y<sy-1; y++) for(int x=1; x<sx-1; x++)
     {
-      typename InputImageType::IndexType ix;
-      ix[0]=x; ix[1]=y; ix[2]=z;
-      float theval = faImage->GetPixel(ix);
+      const long ix = x + y*sx + z*sxy;
+      float theval = fa[ix];
 
       if(theval != 0)
       {
@@ -79,11 +119,9 @@ namespace itk
         float cogX = 0.0; float cogY = 0.0; float cogZ = 0.0; float sum = 0.0; float l;
         int vecX = 0; int vecY = 0; int vecZ = 0;
 
-        for(int dz=-1; dz<=1; dz++) for(int dy=-1; dy<=1; dy++) for(int dx=-1; dx<=1;dx++)
+        for(int dz=-1, n=0; dz<=1; dz++) for(int dy=-1; dy<=1; dy++) for(int dx=-1; dx<=1; dx++, n++)
         {
-          typename InputImageType::IndexType p;
-          p[0] = x+dx; p[1] = y+dy; p[2] = z+dz;
-          float mass = faImage->GetPixel(p);
+          float mass = fa[ix + neighborOffsets[n]];
 
           sum += mass;
           cogX += (float)dx*mass; cogY += (float)dy*mass; cogZ += (float)dz*mass;
@@ -103,40 +141,25 @@ namespace itk
         {
 
           float maxcost=0, centreval=2*theval;
-          for(int zz=0; zz<=1; zz++) // note - starts at zero as we're only searching half the voxels
+          for(int n=0; n<numSearchDirections; n++)
           {
-            for(int yy=-1; yy<=1; yy++)
+            float cost = searchWeights[n] * ( centreval
+              - (float)fa[ix + searchOffsets[n]]
+              - (float)fa[ix - searchOffsets[n]]);
+
+            if (cost>maxcost)
             {
-              for(int xx=-1; xx<=1; xx++)
-              {
-                if ( (zz==1) || (yy==1) || ((yy==0)&&(xx==1)) )
-                {
-                  float weighting = pow( (float)(xx*xx+yy*yy+zz*zz) , (float)-0.7 ); // power is arbitrary: maybe test other functions here
-
-
-                  typename InputImageType::IndexType i,j;
-                  i[0] = x+xx; i[1] = y+yy; i[2] = z+zz;
-                  j[0] = x-xx; j[1] = y-yy; j[2] = z-zz;
-                  float cost = weighting * ( centreval
-                    - (float)faImage->GetPixel(i)
-                    - (float)faImage->GetPixel(j));
-
-                  if (cost>maxcost)
-                  {
-                    maxcost=cost;
-                    vecX=xx;
-                    vecY=yy;
-                    vecZ=zz;
-                  }
-                }
-              }
+              maxcost=cost;
+              vecX=searchDirections[n][0];
+              vecY=searchDirections[n][1];
+              vecZ=searchDirections[n][2];
             }
           }
         }
 
         VectorType vec;
         vec[0] = vecX; vec[1] = vecY; vec[2]=vecZ;
-        m_DirectionImage->SetPixel(ix, vec);
+        directions[ix] = vec;
 
       }
     }
@@ -157,24 +180,22 @@ namespace itk
     p[0]=0; p[1]=0; p[2]=0;
     directionSmoothed->FillBuffer(p);
 
+    VectorType* smoothed = directionSmoothed->GetBufferPointer();
 
-
-    for(unsigned int z=1; z<size[2]-1; z++) for(unsigned int y=1; y<size[1]-1; y++) for(unsigned int x=1; x<size[0]-1; x++)
+#pragma omp parallel for num_threads(numThreads) schedule(dynamic)
+    for(int z=1; z<sz-1; z++) for(int y=1; y<sy-1; y++) for(int x=1; x<sx-1; x++)
     {
-      VectorImageType::IndexType ix;
-      ix[0]=x; ix[1]=y; ix[2]=z;
+      const long ix = x + y*sx + z*sxy;
 
       // Find the vector that occured most
-      auto  localsum = new int[27];
+      int localsum[27];
       int localmax=0, xxx, yyy, zzz;
 
       for(int zz=0; zz<27; zz++) localsum[zz]=0;
 
-      for(int zz=-1; zz<=1; zz++) for(int yy=-1; yy<=1; yy++) for(int xx=-1; xx<=1; xx++)
+      for(int n=0; n<27; n++)
       {
-        VectorImageType::IndexType i;
-        i[0] = x+xx; i[1] = y+yy; i[2] = z+zz;
-        VectorType v = m_DirectionImage->GetPixel(i);
+        const VectorType& v = directions[ix + neighborOffsets[n]];
         xxx = v[0];
         yyy = v[1];
         zzz = v[2];
@@ -190,12 +211,10 @@ namespace itk
           localmax=localsum[(1+zz)*9+(1+yy)*3+1+xx];
           VectorType v;
           v[0] = xx; v[1] = yy; v[2] = zz;
-          directionSmoothed->SetPixel(ix, v);
+          smoothed[ix] = v;
         }
       }
 
-      delete[] localsum;
-
     }
 
     m_DirectionImage = directionSmoothed;
@@ -211,33 +230,32 @@ namespace itk
     outputImg->Allocate();
     outputImg->FillBuffer(0.0);
 
-    for(unsigned int z=1; z<size[2]-1; z++) for(unsigned int y=1; y<size[1]-1; y++) for(unsigned int x=1; x<size[0]-1; x++)
-    {
-
-      typename InputImageType::IndexType ix;
-      ix[0]=x; ix[1]=y; ix[2]=z;
+    typename OutputImageType::PixelType* output = outputImg->GetBufferPointer();
 
-      float theval = faImage->GetPixel(ix);
-      VectorType v = directionSmoothed->GetPixel(ix);
-
-      typename VectorImageType::IndexType i;
-
-      i[0] = x-v[0]; i[1] = y-v[1]; i[2] = z-v[2];
-      float min = faImage->GetPixel(i);
+#pragma omp parallel for num_threads(numThreads) schedule(dynamic)
+    for(int z=1; z<sz-1; z++) for(int y=1; y<sy-1; y++) for(int x=1; x<sx-1; x++)
+    {
+      const long ix = x + y*sx + z*sxy;
 
-      i[0] = x+v[0]; i[1] = y+v[1]; i[2] = z+v[2];
-      float plus = faImage->GetPixel(i);
+      float theval = fa[ix];
+      const VectorType& v = smoothed[ix];
 
-      i[0] = x-2*v[0]; i[1] = y-2*v[1]; i[2] = z-2*v[2];
-      float minmin = faImage->GetPixel(i);
+      if( (v[0]==0) && (v[1]==0) && (v[2]==0) )
+      {
+        continue;
+      }
 
-      i[0] = x+2*v[0]; i[1] = y+2*v[1]; i[2] = z+2*v[2];
-      float plusplus = faImage->GetPixel(i);
+      // values at one and two steps perpendicular to the skeleton, the two step neighbours of
+      // voxels next to the image border lie outside of the buffer and count as background
+      const long offset = v[0] + v[1]*sx + v[2]*sxy;
+      float min = fa[ix - offset];
+      float plus = fa[ix + offset];
+      float minmin = ix - 2*offset >= 0 && ix - 2*offset < numPixels ? fa[ix - 2*offset] : 0;
+      float plusplus = ix + 2*offset >= 0 && ix + 2*offset < numPixels ? fa[ix + 2*offset] : 0;
 
-      if( ((v[0]!=0) || (v[1]!=0) || (v[2]!=0)) &&
-           theval >= plus && theval >  min && theval >= plusplus && theval >  minmin  )
+      if( theval >= plus && theval >  min && theval >= plusplus && theval >  minmin  )
       {
-        outputImg->SetPixel(ix, theval);
+        output[ix] = theval;
       }
 
     }
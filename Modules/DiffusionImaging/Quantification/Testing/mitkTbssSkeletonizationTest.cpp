@@ -133,6 +133,11 @@ int mitkTbssSkeletonizationTest(int, char* argv[])
   projectionFilter->SetAllFA(reader4d->GetOutput());
   projectionFilter->SetTube(cingulum);
   projectionFilter->SetSkeleton(thresholdedImg);
+
+  // Project the FA data a second time as additional metric, it has to be sampled at the same locations
+  std::vector< Float4DImageType::Pointer > additionalMetrics;
+  additionalMetrics.push_back(reader4d->GetOutput());
+  projectionFilter->SetAdditionalMetrics(additionalMetrics);
   projectionFilter->Project();
 
 
@@ -162,6 +167,13 @@ int mitkTbssSkeletonizationTest(int, char* argv[])
 
   MITK_TEST_CONDITION(diff < 0.001, "Check correctness of the projections");
 
+  MITK_TEST_CONDITION_REQUIRED(projectionFilter->GetAdditionalProjections().size() == 1, "One additional projection");
+  comparisonFilter = ComparisonFilterType::New();
+  comparisonFilter->SetTestInput(projectionFilter->GetAdditionalProjections()[0]);
+  comparisonFilter->SetValidInput(projected);
+  comparisonFilter->Update();
+  MITK_TEST_CONDITION(comparisonFilter->GetTotalDifference() == 0, "Check projection of additional metrics");
+
 
   MITK_TEST_END();
 }
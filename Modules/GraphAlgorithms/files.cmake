@@ -4,6 +4,7 @@ set(CPP_FILES
 set(H_FILES
   itkShortestPathCostFunction.h
   itkShortestPathCostFunctionTbss.h
+  itkShortestPathHeap.h
   itkShortestPathNode.h
   itkShortestPathImageFilter.h
   itkShortestPathCostFunctionLiveWire.h
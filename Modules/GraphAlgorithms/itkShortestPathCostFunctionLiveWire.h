@@ -71,6 +71,12 @@ namespace itk
     /** \brief calculates the costs for going from p1 to p2*/
     double GetCost(IndexType p1, IndexType p2) override;
 
+    /** \brief calculates the costs of entering p2 from a horizontal or vertical neighbor, ignoring repulsive points.
+       GetCost() only scales them for diagonal neighbors. Reads the initialized feature images only, so it may be
+       called concurrently.
+    */
+    double GetLocalCost(const IndexType &p2) const;
+
     /** \brief returns the minimal costs possible (needed for A*)*/
     double GetMinCost() override;
 
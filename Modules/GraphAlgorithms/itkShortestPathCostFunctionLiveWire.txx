@@ -86,13 +86,6 @@ namespace itk
   template <class TInputImageType>
   double ShortestPathCostFunctionLiveWire<TInputImageType>::GetCost(IndexType p1, IndexType p2)
   {
-    // local component costs
-    // weights
-    double w1;
-    double w2;
-    double w3;
-    double costs = 0.0;
-
     // if we are on the mask, return asap
     if (m_UseRepulsivePoints)
     {
@@ -100,6 +93,36 @@ namespace itk
         return 1000;
     }
 
+    double costs = this->GetLocalCost(p2);
+
+    // scale by euclidian distance
+    double costScale;
+    if (p1[0] == p2[0] || p1[1] == p2[1])
+    {
+      // horizontal or vertical neighbor
+      costScale = 1.0;
+    }
+    else
+    {
+      // diagonal neighbor
+      costScale = sqrt(2.0);
+    }
+
+    costs *= costScale;
+
+    return costs;
+  }
+
+  template <class TInputImageType>
+  double ShortestPathCostFunctionLiveWire<TInputImageType>::GetLocalCost(const IndexType &p2) const
+  {
+    // local component costs
+    // weights
+    double w1;
+    double w2;
+    double w3;
+    double costs = 0.0;
+
     double gradientX, gradientY;
     gradientX = gradientY = 0.0;
 
@@ -114,19 +137,19 @@ namespace itk
 
     if (m_UseCostMap && !m_CostMap.empty())
     {
-      std::map<int, int>::iterator end = m_CostMap.end();
-      std::map<int, int>::iterator last = --(m_CostMap.end());
+      std::map<int, int>::const_iterator end = m_CostMap.end();
+      std::map<int, int>::const_iterator last = --(m_CostMap.end());
 
       // current position
-      std::map<int, int>::iterator x;
+      std::map<int, int>::const_iterator x;
       // std::map< int, int >::key_type keyOfX = static_cast<std::map< int, int >::key_type>(gradientMagnitude * 1000);
       int keyOfX = static_cast<int>(gradientMagnitude /* ShortestPathCostFunctionLiveWire::MAPSCALEFACTOR*/);
       x = m_CostMap.find(keyOfX);
 
-      std::map<int, int>::iterator left2;
-      std::map<int, int>::iterator left1;
-      std::map<int, int>::iterator right1;
-      std::map<int, int>::iterator right2;
+      std::map<int, int>::const_iterator left2;
+      std::map<int, int>::const_iterator left1;
+      std::map<int, int>::const_iterator right1;
+      std::map<int, int>::const_iterator right2;
 
       if (x == end)
       { // x can also be == end if the key is not in the map but between two other keys
@@ -276,21 +299,6 @@ namespace itk
     }
     costs = w1 * laplacianCost + w2 * gradientCost + w3 * gradientDirectionCost;
 
-    // scale by euclidian distance
-    double costScale;
-    if (p1[0] == p2[0] || p1[1] == p2[1])
-    {
-      // horizontal or vertical neighbor
-      costScale = 1.0;
-    }
-    else
-    {
-      // diagonal neighbor
-      costScale = sqrt(2.0);
-    }
-
-    costs *= costScale;
-
     return costs;
   }
 
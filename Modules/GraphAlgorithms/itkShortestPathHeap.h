@@ -0,0 +1,152 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+#ifndef __itkShortestPathHeap_h_
+#define __itkShortestPathHeap_h_
+
+#include "itkShortestPathNode.h"
+
+#include <limits>
+#include <vector>
+
+namespace itk
+{
+  /** \brief Binary min-heap of node numbers, keyed by their (estimated) distance.
+   *
+   * The heap knows the position of every node of the graph, so the key of a queued node can be lowered
+   * in logarithmic time instead of searching and reinserting it. Popped nodes are marked as closed until
+   * they are reset. Needs 4 bytes per node of the graph plus 16 bytes per queued node.
+   */
+  class ShortestPathHeap
+  {
+  public:
+    static const NodeNumType NotQueued = std::numeric_limits<NodeNumType>::max();
+    static const NodeNumType Closed = std::numeric_limits<NodeNumType>::max() - 1;
+
+    /** \brief Empties the heap and marks all nodes as not queued */
+    void Resize(NodeNumType numberOfNodes)
+    {
+      m_Entries.clear();
+      m_Positions.assign(numberOfNodes, NodeNumType(NotQueued));
+    }
+
+    /** \brief Empties the heap, the nodes have to be reset separately */
+    void Clear() { m_Entries.clear(); }
+
+    void Reset(NodeNumType node) { m_Positions[node] = NotQueued; }
+
+    void Release()
+    {
+      std::vector<Entry>().swap(m_Entries);
+      std::vector<NodeNumType>().swap(m_Positions);
+    }
+
+    NodeNumType GetNumberOfNodes() const { return static_cast<NodeNumType>(m_Positions.size()); }
+
+    bool IsEmpty() const { return m_Entries.empty(); }
+    bool IsClosed(NodeNumType node) const { return m_Positions[node] == Closed; }
+
+    DistanceType GetTopKey() const { return m_Entries.front().Key; }
+
+    /** \brief Queues the node, or changes its key if it is queued already. The node must not be closed. */
+    void Push(NodeNumType node, DistanceType key)
+    {
+      NodeNumType position = m_Positions[node];
+      if (position == NotQueued)
+      {
+        position = static_cast<NodeNumType>(m_Entries.size());
+        m_Entries.push_back(Entry());
+      }
+      else if (key > m_Entries[position].Key)
+      {
+        m_Entries[position].Key = key;
+        this->SiftDown(position);
+        return;
+      }
+
+      Entry entry = {key, node};
+      this->SiftUp(position, entry);
+    }
+
+    /** \brief Removes the node with the lowest key and marks it as closed */
+    NodeNumType Pop()
+    {
+      const NodeNumType top = m_Entries.front().Node;
+      m_Positions[top] = Closed;
+
+      const Entry last = m_Entries.back();
+      m_Entries.pop_back();
+      if (!m_Entries.empty())
+      {
+        m_Entries.front() = last;
+        m_Positions[last.Node] = 0;
+        this->SiftDown(0);
+      }
+      return top;
+    }
+
+  private:
+    struct Entry
+    {
+      DistanceType Key;
+      NodeNumType Node;
+    };
+
+    void SiftUp(NodeNumType position, const Entry &entry)
+    {
+      while (position > 0)
+      {
+        const NodeNumType parent = (position - 1) / 2;
+        if (!(entry.Key < m_Entries[parent].Key))
+          break;
+
+        this->Place(position, m_Entries[parent]);
+        position = parent;
+      }
+      this->Place(position, entry);
+    }
+
+    void SiftDown(NodeNumType position)
+    {
+      const Entry entry = m_Entries[position];
+      const NodeNumType size = static_cast<NodeNumType>(m_Entries.size());
+      for (;;)
+      {
+        NodeNumType child = 2 * position + 1;
+        if (child >= size)
+          break;
+        if (child + 1 < size && m_Entries[child + 1].Key < m_Entries[child].Key)
+          ++child;
+        if (!(m_Entries[child].Key < entry.Key))
+          break;
+
+        this->Place(position, m_Entries[child]);
+        position = child;
+      }
+      this->Place(position, entry);
+    }
+
+    void Place(NodeNumType position, const Entry &entry)
+    {
+      m_Entries[position] = entry;
+      m_Positions[entry.Node] = position;
+    }
+
+    std::vector<Entry> m_Entries;
+    std::vector<NodeNumType> m_Positions;
+  };
+}
+
+#endif
@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "itkImageToImageFilter.h"
 #include "itkShortestPathCostFunction.h"
+#include "itkShortestPathHeap.h"
 #include "itkShortestPathNode.h"
 #include <itkImageRegionIteratorWithIndex.h>
 
@@ -39,6 +40,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 // for GetVectorOrderImage
 // void AddEndIndex(const IndexType & EndIndex) //Optional. By calling this function you can add several endpoints! The
 // algorithm will look for several shortest Pathes. From Start to all Endpoints.
+// void SetSearchRegion(const RegionType & region) // Optional, restricts the graph to this region of the image, e.g. a
+// bounding box around start and end point
+// void SetBidirectionalSearch(bool) // Optional (default=false), searches from start and end point at the same time.
+// Only used for a single end point without CalcAllDistances
 //
 /// GET FUNCTIONS
 // std::vector< itk::Index<3> > GetVectorPath(); // returns the shortest path as vector
@@ -72,6 +77,8 @@ namespace itk
     typedef typename TInputImageType::PixelType InputImagePixelType;
     typedef typename TInputImageType::SizeType InputImageSizeType;
     typedef typename TInputImageType::IndexType IndexType;
+    typedef typename TInputImageType::OffsetType OffsetType;
+    typedef typename TInputImageType::RegionType RegionType;
     typedef typename itk::ImageRegionIteratorWithIndex<InputImageType> InputImageIteratorType;
 
     typedef TOutputImageType OutputImageType;
@@ -133,6 +140,17 @@ namespace itk
     itkSetMacro(ActivateTimeOut, bool);
     itkGetMacro(ActivateTimeOut, bool);
 
+    // \brief (default=false), search from start and end point at the same time, which usually visits far less
+    // nodes. Only used for a single end point without CalcAllDistances, the A* estimate is not used then.
+    itkSetMacro(BidirectionalSearch, bool);
+    itkGetMacro(BidirectionalSearch, bool);
+
+    // \brief Restricts the graph to a region of the image, e.g. a bounding box around start and end point. Only the
+    // nodes of this region are allocated. By default the whole requested region of the input is used.
+    void SetSearchRegion(const RegionType &region);
+    const RegionType &GetSearchRegion() const { return m_SearchRegion; }
+    void ResetSearchRegion();
+
     // \brief returns shortest Path as vector
     std::vector<IndexType> GetVectorPath();
 
@@ -151,7 +169,7 @@ namespace itk
     // \brief Fill m_VectorPath
     void MakeShortestPathVector();
 
-    // \brief cleans up the filter
+    // \brief cleans up the filter and releases the graph
     void CleanUp();
 
     itkSetObjectMacro(CostFunction,
@@ -163,13 +181,29 @@ namespace itk
       m_endPoints; // if you fill this vector, the algo will not rest until all endPoints have been reached
     std::vector<IndexType> m_endPointsClosed;
 
-    ShortestPathNode *m_Nodes; // main list that contains all nodes
+    // The graph is implicit, nodes are numbered linearly in m_GraphRegion. Per node only the distance (-1 if not
+    // discovered yet), the previous node and the heap position are stored.
+    std::vector<DistanceType> m_Distances;
+    std::vector<NodeNumType> m_PreviousNodes;
+    ShortestPathHeap m_Heap;
+    // the same for the backward search from the end point of a bidirectional search
+    std::vector<DistanceType> m_BackwardDistances;
+    std::vector<NodeNumType> m_NextNodes;
+    ShortestPathHeap m_BackwardHeap;
+    // nodes discovered by the last search, only those are reset for the next one
+    std::vector<NodeNumType> m_TouchedNodes;
+
+    RegionType m_GraphRegion;
+    RegionType m_SearchRegion;
+    bool m_UseSearchRegion;
+    std::vector<OffsetType> m_NeighborOffsets;
+    std::vector<OffsetValueType> m_NeighborNodeOffsets;
+
     NodeNumType m_Graph_NumberOfNodes;
     NodeNumType m_Graph_StartNode;
     NodeNumType m_Graph_EndNode;
     unsigned int m_ImageDimensions;
     bool m_Graph_fullNeighbors;
-    std::vector<ShortestPathNode *> m_Graph_DiscoveredNodeList;
     ShortestPathImageFilter(Self &); // intentionally not implemented
     void operator=(const Self &);    // intentionally not implemented
     const static int BACKGROUND = 0;
@@ -185,7 +219,7 @@ namespace itk
 
     bool m_ActivateTimeOut; // if true, then i search max. 30 secs. then abort
 
-    bool m_Initialized;
+    bool m_BidirectionalSearch;
 
     CostFunctionTypePointer m_CostFunction;
     IndexType m_StartIndex, m_EndIndex;
@@ -209,23 +243,26 @@ namespace itk
 
     typename InputImageType::Pointer m_magnitudeImage;
 
-    // \brief Convert a indexnumber of a node in m_Nodes to image coordinates
+    // \brief Convert the number of a node to image coordinates
     typename TInputImageType::IndexType NodeToCoord(NodeNumType);
 
-    // \brief Convert image coordinate to a indexnumber of a node in m_Nodes
-    unsigned int CoordToNode(IndexType);
+    // \brief Convert image coordinates to the number of a node
+    NodeNumType CoordToNode(IndexType);
 
-    // \brief Returns the neighbors of a node
-    std::vector<ShortestPathNode *> GetNeighbors(NodeNumType nodeNum, bool FullNeighbors);
-
-    // \brief Check if coords are in bounds of image
+    // \brief Check if coords are in bounds of the graph
     bool CoordIsInBounds(IndexType);
 
-    // \brief Initializes the graph
+    // \brief Initializes the graph, only the nodes of the previous search are reset if the graph region did not change
     void InitGraph();
 
+    // \brief Marks a node as discovered by the search, so it is reset before the next one
+    void Discover(NodeNumType node);
+
     // \brief Start ShortestPathSearch
     void StartShortestPathSearch();
+
+    // \brief Dijkstra search from start and end point until both searches meet
+    void StartBidirectionalSearch();
   };
 
 } // end of namespace itk
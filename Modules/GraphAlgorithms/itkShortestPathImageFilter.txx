@@ -19,9 +19,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkShortestPathImageFilter.h"
 
 #include "mitkMemoryUtilities.h"
-#include <ctime>
 #include <algorithm>
+#include <cmath>
+#include <ctime>
 #include <iostream>
+#include <limits>
 #include <vector>
 
 namespace itk
@@ -29,18 +31,24 @@ namespace itk
   // Constructor  (initialize standard values)
   template <class TInputImageType, class TOutputImageType>
   ShortestPathImageFilter<TInputImageType, TOutputImageType>::ShortestPathImageFilter()
-    : m_Nodes(nullptr),
+    : m_UseSearchRegion(false),
       m_Graph_NumberOfNodes(0),
+      m_Graph_StartNode(0),
+      m_Graph_EndNode(0),
+      m_ImageDimensions(TInputImageType::ImageDimension),
+      m_Graph_fullNeighbors(false),
       m_FullNeighborsMode(false),
       m_MakeOutputImage(true),
       m_StoreVectorOrder(false),
       m_CalcAllDistances(false),
       multipleEndPoints(false),
       m_ActivateTimeOut(false),
-      m_Initialized(false)
+      m_BidirectionalSearch(false)
   {
     m_endPoints.clear();
     m_endPointsClosed.clear();
+    m_StartIndex.Fill(0);
+    m_EndIndex.Fill(0);
 
     if (m_MakeOutputImage)
     {
@@ -52,40 +60,19 @@ namespace itk
   template <class TInputImageType, class TOutputImageType>
   ShortestPathImageFilter<TInputImageType, TOutputImageType>::~ShortestPathImageFilter()
   {
-    delete[] m_Nodes;
   }
 
   template <class TInputImageType, class TOutputImageType>
   inline typename ShortestPathImageFilter<TInputImageType, TOutputImageType>::IndexType
     ShortestPathImageFilter<TInputImageType, TOutputImageType>::NodeToCoord(NodeNumType node)
   {
-    const InputImageSizeType &size = this->GetInput()->GetRequestedRegion().GetSize();
-    int dim = InputImageType::ImageDimension;
-    IndexType coord;
-    if (dim == 2)
-    {
-      coord[1] = node / size[0];
-      coord[0] = node % size[0];
-      if (((unsigned long)coord[0] >= size[0]) || ((unsigned long)coord[1] >= size[1]))
-      {
-        coord[0] = 0;
-        coord[1] = 0;
-      }
-    }
-    if (dim == 3)
+    const InputImageSizeType &size = m_GraphRegion.GetSize();
+    IndexType coord = m_GraphRegion.GetIndex();
+    for (unsigned int i = 0; i < TInputImageType::ImageDimension; ++i)
     {
-      coord[2] = node / (size[0] * size[1]);
-      coord[1] = (node % (size[0] * size[1])) / size[0];
-      coord[0] = (node % (size[0] * size[1])) % size[0];
-      if (((unsigned long)coord[0] >= size[0]) || ((unsigned long)coord[1] >= size[1]) ||
-          ((unsigned long)coord[2] >= size[2]))
-      {
-        coord[0] = 0;
-        coord[1] = 0;
-        coord[2] = 0;
-      }
+      coord[i] += node % size[i];
+      node /= size[i];
     }
-
     return coord;
   }
 
@@ -93,310 +80,37 @@ namespace itk
   inline typename itk::NodeNumType ShortestPathImageFilter<TInputImageType, TOutputImageType>::CoordToNode(
     IndexType coord)
   {
-    const InputImageSizeType &size = this->GetInput()->GetRequestedRegion().GetSize();
-    int dim = InputImageType::ImageDimension;
-    NodeNumType node = 0;
-    if (dim == 2)
-    {
-      node = (coord[1] * size[0]) + coord[0];
-    }
-    if (dim == 3)
-    {
-      node = (coord[2] * size[0] * size[1]) + (coord[1] * size[0]) + coord[0];
-    }
-    if ((m_Graph_NumberOfNodes > 0) && (node >= m_Graph_NumberOfNodes))
-    {
-      /*MITK_INFO << "WARNING! Coordinates outside image!";
-      MITK_INFO << "Coords = " << coord ;
-      MITK_INFO << "ImageDim = " << dim ;
-      MITK_INFO << "RequestedRegionSize = " << size ;*/
-      node = 0;
-    }
+    if (!m_GraphRegion.IsInside(coord))
+      return 0;
 
+    const InputImageSizeType &size = m_GraphRegion.GetSize();
+    const IndexType &origin = m_GraphRegion.GetIndex();
+    NodeNumType node = 0;
+    for (int i = TInputImageType::ImageDimension - 1; i >= 0; --i)
+      node = node * size[i] + (coord[i] - origin[i]);
     return node;
   }
 
   template <class TInputImageType, class TOutputImageType>
   inline bool ShortestPathImageFilter<TInputImageType, TOutputImageType>::CoordIsInBounds(IndexType coord)
   {
-    const InputImageSizeType &size = this->GetInput()->GetRequestedRegion().GetSize();
-    int dim = InputImageType::ImageDimension;
-
-    if (dim == 2)
-    {
-      if ((coord[0] >= 0) && ((unsigned long)coord[0] < size[0]) && (coord[1] >= 0) &&
-          ((unsigned long)coord[1] < size[1]))
-      {
-        return true;
-      }
-    }
-    if (dim == 3)
-    {
-      if ((coord[0] >= 0) && ((unsigned long)coord[0] < size[0]) && (coord[1] >= 0) &&
-          ((unsigned long)coord[1] < size[1]) && (coord[2] >= 0) && ((unsigned long)coord[2] < size[2]))
-      {
-        return true;
-      }
-    }
-    return false;
-  }
-
-  template <class TInputImageType, class TOutputImageType>
-  inline std::vector<ShortestPathNode *> ShortestPathImageFilter<TInputImageType, TOutputImageType>::GetNeighbors(
-    unsigned int nodeNum, bool FullNeighbors)
-  {
-    // returns a vector of nodepointers.. these nodes are the neighbors
-    int dim = InputImageType::ImageDimension;
-    IndexType Coord = NodeToCoord(nodeNum);
-    IndexType NeighborCoord;
-    std::vector<ShortestPathNode *> nodeList;
-
-    int neighborDistance = 1; // if i increase that, i might not hit the endnote
-
-    // maybe use itkNeighborhoodIterator here, might be faster
-
-    if (dim == 2)
-    {
-      // N4
-      NeighborCoord[0] = Coord[0];
-      NeighborCoord[1] = Coord[1] - neighborDistance;
-      if (CoordIsInBounds(NeighborCoord))
-        nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-      NeighborCoord[0] = Coord[0] + neighborDistance;
-      NeighborCoord[1] = Coord[1];
-      if (CoordIsInBounds(NeighborCoord))
-        nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-      NeighborCoord[0] = Coord[0];
-      NeighborCoord[1] = Coord[1] + neighborDistance;
-      if (CoordIsInBounds(NeighborCoord))
-        nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-      NeighborCoord[0] = Coord[0] - neighborDistance;
-      NeighborCoord[1] = Coord[1];
-      if (CoordIsInBounds(NeighborCoord))
-        nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-      if (FullNeighbors)
-      {
-        // N8
-        NeighborCoord[0] = Coord[0] - neighborDistance;
-        NeighborCoord[1] = Coord[1] - neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] + neighborDistance;
-        NeighborCoord[1] = Coord[1] - neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] - neighborDistance;
-        NeighborCoord[1] = Coord[1] + neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] + neighborDistance;
-        NeighborCoord[1] = Coord[1] + neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-      }
-    }
-    if (dim == 3)
-    {
-      // N6
-      NeighborCoord[0] = Coord[0];
-      NeighborCoord[1] = Coord[1] - neighborDistance;
-      NeighborCoord[2] = Coord[2];
-      if (CoordIsInBounds(NeighborCoord))
-        nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-      NeighborCoord[0] = Coord[0] + neighborDistance;
-      NeighborCoord[1] = Coord[1];
-      NeighborCoord[2] = Coord[2];
-      if (CoordIsInBounds(NeighborCoord))
-        nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-      NeighborCoord[0] = Coord[0];
-      NeighborCoord[1] = Coord[1] + neighborDistance;
-      NeighborCoord[2] = Coord[2];
-      if (CoordIsInBounds(NeighborCoord))
-        nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-      NeighborCoord[0] = Coord[0] - neighborDistance;
-      NeighborCoord[1] = Coord[1];
-      NeighborCoord[2] = Coord[2];
-      if (CoordIsInBounds(NeighborCoord))
-        nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-      NeighborCoord[0] = Coord[0];
-      NeighborCoord[1] = Coord[1];
-      NeighborCoord[2] = Coord[2] + neighborDistance;
-      if (CoordIsInBounds(NeighborCoord))
-        nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-      NeighborCoord[0] = Coord[0];
-      NeighborCoord[1] = Coord[1];
-      NeighborCoord[2] = Coord[2] - neighborDistance;
-      if (CoordIsInBounds(NeighborCoord))
-        nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-      if (FullNeighbors)
-      {
-        // N26
-        // Middle Slice
-        NeighborCoord[0] = Coord[0] - neighborDistance;
-        NeighborCoord[1] = Coord[1] - neighborDistance;
-        NeighborCoord[2] = Coord[2];
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] + neighborDistance;
-        NeighborCoord[1] = Coord[1] - neighborDistance;
-        NeighborCoord[2] = Coord[2];
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] - neighborDistance;
-        NeighborCoord[1] = Coord[1] + neighborDistance;
-        NeighborCoord[2] = Coord[2];
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] + neighborDistance;
-        NeighborCoord[1] = Coord[1] + neighborDistance;
-        NeighborCoord[2] = Coord[2];
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        // BackSlice (Diagonal)
-        NeighborCoord[0] = Coord[0] - neighborDistance;
-        NeighborCoord[1] = Coord[1] - neighborDistance;
-        NeighborCoord[2] = Coord[2] - neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] + neighborDistance;
-        NeighborCoord[1] = Coord[1] - neighborDistance;
-        NeighborCoord[2] = Coord[2] - neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] - neighborDistance;
-        NeighborCoord[1] = Coord[1] + neighborDistance;
-        NeighborCoord[2] = Coord[2] - neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] + neighborDistance;
-        NeighborCoord[1] = Coord[1] + neighborDistance;
-        NeighborCoord[2] = Coord[2] - neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        // BackSlice (Non-Diag)
-        NeighborCoord[0] = Coord[0];
-        NeighborCoord[1] = Coord[1] - neighborDistance;
-        NeighborCoord[2] = Coord[2] - neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] + neighborDistance;
-        NeighborCoord[1] = Coord[1];
-        NeighborCoord[2] = Coord[2] - neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0];
-        NeighborCoord[1] = Coord[1] + neighborDistance;
-        NeighborCoord[2] = Coord[2] - neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] - neighborDistance;
-        NeighborCoord[1] = Coord[1];
-        NeighborCoord[2] = Coord[2] - neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        // FrontSlice (Diagonal)
-        NeighborCoord[0] = Coord[0] - neighborDistance;
-        NeighborCoord[1] = Coord[1] - neighborDistance;
-        NeighborCoord[2] = Coord[2] + neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] + neighborDistance;
-        NeighborCoord[1] = Coord[1] - neighborDistance;
-        NeighborCoord[2] = Coord[2] + neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] - neighborDistance;
-        NeighborCoord[1] = Coord[1] + neighborDistance;
-        NeighborCoord[2] = Coord[2] + neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] + neighborDistance;
-        NeighborCoord[1] = Coord[1] + neighborDistance;
-        NeighborCoord[2] = Coord[2] + neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        // FrontSlice(Non-Diag)
-        NeighborCoord[0] = Coord[0];
-        NeighborCoord[1] = Coord[1] - neighborDistance;
-        NeighborCoord[2] = Coord[2] + neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] + neighborDistance;
-        NeighborCoord[1] = Coord[1];
-        NeighborCoord[2] = Coord[2] + neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0];
-        NeighborCoord[1] = Coord[1] + neighborDistance;
-        NeighborCoord[2] = Coord[2] + neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-
-        NeighborCoord[0] = Coord[0] - neighborDistance;
-        NeighborCoord[1] = Coord[1];
-        NeighborCoord[2] = Coord[2] + neighborDistance;
-        if (CoordIsInBounds(NeighborCoord))
-          nodeList.push_back(&m_Nodes[CoordToNode(NeighborCoord)]);
-      }
-    }
-    return nodeList;
+    return m_GraphRegion.IsInside(coord);
   }
 
   template <class TInputImageType, class TOutputImageType>
   void ShortestPathImageFilter<TInputImageType, TOutputImageType>::SetStartIndex(
     const typename TInputImageType::IndexType &StartIndex)
   {
-    for (unsigned int i = 0; i < TInputImageType::ImageDimension; ++i)
-    {
-      m_StartIndex[i] = StartIndex[i];
-    }
-    m_Graph_StartNode = CoordToNode(m_StartIndex);
-    // MITK_INFO << "StartIndex = " << StartIndex;
-    // MITK_INFO << "StartNode = " << m_Graph_StartNode;
-    m_Initialized = false;
+    m_StartIndex = StartIndex;
+    this->Modified();
   }
 
   template <class TInputImageType, class TOutputImageType>
   void ShortestPathImageFilter<TInputImageType, TOutputImageType>::SetEndIndex(
     const typename TInputImageType::IndexType &EndIndex)
   {
-    for (unsigned int i = 0; i < TInputImageType::ImageDimension; ++i)
-    {
-      m_EndIndex[i] = EndIndex[i];
-    }
-    m_Graph_EndNode = CoordToNode(m_EndIndex);
-    // MITK_INFO << "EndNode = " << m_Graph_EndNode;
+    m_EndIndex = EndIndex;
+    this->Modified();
   }
 
   template <class TInputImageType, class TOutputImageType>
@@ -404,119 +118,194 @@ namespace itk
     const typename TInputImageType::IndexType &index)
   {
     // ONLY FOR MULTIPLE END POINTS SEARCH
-    IndexType newEndIndex;
-    for (unsigned int i = 0; i < TInputImageType::ImageDimension; ++i)
-    {
-      newEndIndex[i] = index[i];
-    }
-    m_endPoints.push_back(newEndIndex);
+    m_endPoints.push_back(index);
     SetEndIndex(m_endPoints[0]);
     multipleEndPoints = true;
   }
 
+  template <class TInputImageType, class TOutputImageType>
+  void ShortestPathImageFilter<TInputImageType, TOutputImageType>::SetSearchRegion(const RegionType &region)
+  {
+    m_SearchRegion = region;
+    m_UseSearchRegion = true;
+    this->Modified();
+  }
+
+  template <class TInputImageType, class TOutputImageType>
+  void ShortestPathImageFilter<TInputImageType, TOutputImageType>::ResetSearchRegion()
+  {
+    m_SearchRegion = RegionType();
+    m_UseSearchRegion = false;
+    this->Modified();
+  }
+
   template <class TInputImageType, class TOutputImageType>
   inline double ShortestPathImageFilter<TInputImageType, TOutputImageType>::getEstimatedCostsToTarget(
     const typename TInputImageType::IndexType &a)
   {
     // Returns the minimal possible costs for a path from "a" to targetnode.
-    itk::Vector<float, 3> v;
-    v[0] = m_EndIndex[0] - a[0];
-    v[1] = m_EndIndex[1] - a[1];
-    v[2] = m_EndIndex[2] - a[2];
+    double squaredNorm = 0.0;
+    for (unsigned int i = 0; i < TInputImageType::ImageDimension; ++i)
+    {
+      const double difference = m_EndIndex[i] - a[i];
+      squaredNorm += difference * difference;
+    }
 
-    return m_CostFunction->GetMinCost() * v.GetNorm();
+    return m_CostFunction->GetMinCost() * std::sqrt(squaredNorm);
   }
 
   template <class TInputImageType, class TOutputImageType>
   void ShortestPathImageFilter<TInputImageType, TOutputImageType>::InitGraph()
   {
-    if (!m_Initialized)
+    m_VectorOrder.clear();
+    m_VectorPath.clear();
+    m_MultipleVectorPaths.clear();
+    m_endPointsClosed.clear();
+
+    RegionType graphRegion = this->GetInput()->GetRequestedRegion();
+    if (m_UseSearchRegion && !graphRegion.Crop(m_SearchRegion))
+      itkExceptionMacro(<< "The search region " << m_SearchRegion << " does not overlap the image.");
+
+    if (!graphRegion.IsInside(m_StartIndex))
+      itkExceptionMacro(<< "The start index " << m_StartIndex << " is outside of the search region.");
+    if (!graphRegion.IsInside(m_EndIndex))
+      itkExceptionMacro(<< "The end index " << m_EndIndex << " is outside of the search region.");
+    for (const auto &endPoint : m_endPoints)
     {
-      // Clean up previous stuff
-      CleanUp();
+      if (!graphRegion.IsInside(endPoint))
+        itkExceptionMacro(<< "The end index " << endPoint << " is outside of the search region.");
+    }
+
+    const NodeNumType numberOfNodes = static_cast<NodeNumType>(graphRegion.GetNumberOfPixels());
+    const bool useBackwardSearch = m_BidirectionalSearch && !multipleEndPoints && !m_CalcAllDistances;
+
+    // A new graph is only allocated if the region changed. Otherwise, or there are only a few nodes to reset
+    // after an early terminated search and repeated searches, e.g. of the live wire, stay cheap.
+    if (graphRegion != m_GraphRegion || m_Distances.size() != numberOfNodes ||
+        m_TouchedNodes.size() > numberOfNodes / 4)
+    {
+      m_GraphRegion = graphRegion;
+      m_Graph_NumberOfNodes = numberOfNodes;
+
+      m_Distances.assign(numberOfNodes, -1);
+      m_PreviousNodes.assign(numberOfNodes, NodeNumType(ShortestPathHeap::NotQueued));
+      m_Heap.Resize(numberOfNodes);
+
+      m_BackwardDistances.clear();
+      m_NextNodes.clear();
+      m_BackwardHeap.Release();
+    }
+    else
+    {
+      const bool resetBackward = !m_BackwardDistances.empty();
+      for (const NodeNumType node : m_TouchedNodes)
+      {
+        m_Distances[node] = -1;
+        m_PreviousNodes[node] = ShortestPathHeap::NotQueued;
+        m_Heap.Reset(node);
+        if (resetBackward)
+        {
+          m_BackwardDistances[node] = -1;
+          m_NextNodes[node] = ShortestPathHeap::NotQueued;
+          m_BackwardHeap.Reset(node);
+        }
+      }
+      m_Heap.Clear();
+      m_BackwardHeap.Clear();
+    }
+    m_TouchedNodes.clear();
 
-      // Calc Number of nodes
-      m_ImageDimensions = TInputImageType::ImageDimension;
-      const InputImageSizeType &size = this->GetInput()->GetRequestedRegion().GetSize();
-      m_Graph_NumberOfNodes = 1;
-      for (NodeNumType i = 0; i < m_ImageDimensions; ++i)
-        m_Graph_NumberOfNodes = m_Graph_NumberOfNodes * size[i];
+    if (useBackwardSearch && m_BackwardDistances.size() != numberOfNodes)
+    {
+      m_BackwardDistances.assign(numberOfNodes, -1);
+      m_NextNodes.assign(numberOfNodes, NodeNumType(ShortestPathHeap::NotQueued));
+      m_BackwardHeap.Resize(numberOfNodes);
+    }
 
-      // Initialize mainNodeList with that number
-      m_Nodes = new ShortestPathNode[m_Graph_NumberOfNodes];
+    // Neighbors as offsets in the image and in the node numbering, the face neighbors first
+    const bool fullNeighbors = m_FullNeighborsMode || m_Graph_fullNeighbors;
+    m_NeighborOffsets.clear();
+    m_NeighborNodeOffsets.clear();
+    for (int faceNeighbors = 1; faceNeighbors >= 0; --faceNeighbors)
+    {
+      unsigned int numberOfCombinations = 1;
+      for (unsigned int i = 0; i < TInputImageType::ImageDimension; ++i)
+        numberOfCombinations *= 3;
 
-      // Initialize each node in nodelist
-      for (NodeNumType i = 0; i < m_Graph_NumberOfNodes; i++)
+      for (unsigned int combination = 0; combination < numberOfCombinations; ++combination)
       {
-        m_Nodes[i].distAndEst = -1;
-        m_Nodes[i].distance = -1;
-        m_Nodes[i].prevNode = -1;
-        m_Nodes[i].mainListIndex = i;
-        m_Nodes[i].closed = false;
+        OffsetType offset;
+        OffsetValueType nodeOffset = 0;
+        OffsetValueType stride = 1;
+        unsigned int nonZero = 0;
+        unsigned int remainder = combination;
+        for (unsigned int i = 0; i < TInputImageType::ImageDimension; ++i)
+        {
+          offset[i] = static_cast<OffsetValueType>(remainder % 3) - 1;
+          remainder /= 3;
+          nodeOffset += offset[i] * stride;
+          stride *= m_GraphRegion.GetSize()[i];
+          if (offset[i] != 0)
+            ++nonZero;
+        }
+
+        if (nonZero == 0 || (faceNeighbors == 1) != (nonZero == 1))
+          continue;
+
+        m_NeighborOffsets.push_back(offset);
+        m_NeighborNodeOffsets.push_back(nodeOffset);
       }
 
-      m_Initialized = true;
+      if (!fullNeighbors)
+        break;
     }
 
+    m_Graph_StartNode = CoordToNode(m_StartIndex);
+    m_Graph_EndNode = CoordToNode(m_EndIndex);
+
     // In the beginning, the Startnode needs a distance of 0
-    m_Nodes[m_Graph_StartNode].distance = 0;
-    m_Nodes[m_Graph_StartNode].distAndEst = 0;
+    this->Discover(m_Graph_StartNode);
+    m_Distances[m_Graph_StartNode] = 0;
 
     // initalize cost function
     m_CostFunction->Initialize();
   }
 
+  template <class TInputImageType, class TOutputImageType>
+  inline void ShortestPathImageFilter<TInputImageType, TOutputImageType>::Discover(NodeNumType node)
+  {
+    if (m_Distances[node] == -1 && (m_BackwardDistances.empty() || m_BackwardDistances[node] == -1))
+      m_TouchedNodes.push_back(node);
+  }
+
   template <class TInputImageType, class TOutputImageType>
   void ShortestPathImageFilter<TInputImageType, TOutputImageType>::StartShortestPathSearch()
   {
-    // Setup Timer
-    clock_t startAll = clock();
-    clock_t stopAll = clock();
+    if (m_BidirectionalSearch && !multipleEndPoints && !m_CalcAllDistances)
+    {
+      this->StartBidirectionalSearch();
+      return;
+    }
 
-    // init variables
-    double durationAll = 0;
+    // Setup Timer
+    const clock_t startAll = clock();
     bool timeout = false;
-    NodeNumType mainNodeListIndex = 0;
-    DistanceType curNodeDistance = 0;
-    NodeNumType numberOfNodesChecked = 0;
 
-    // Create Multimap (tree structure for fast searching)
-    std::multimap<double, ShortestPathNode *> myMap;
-    std::pair<std::multimap<double, ShortestPathNode *>::iterator, std::multimap<double, ShortestPathNode *>::iterator>
-      ret;
-    std::multimap<double, ShortestPathNode *>::iterator it;
+    // node numbers of the end points, which are removed when they are reached
+    std::vector<NodeNumType> endNodes;
+    for (const auto &endPoint : m_endPoints)
+      endNodes.push_back(CoordToNode(endPoint));
 
     // At first, only startNote is discovered.
-    myMap.insert(
-      std::pair<double, ShortestPathNode *>(m_Nodes[m_Graph_StartNode].distAndEst, &m_Nodes[m_Graph_StartNode]));
+    m_Heap.Push(m_Graph_StartNode, 0);
 
     // While there are discovered Nodes, pick the one with lowest distance,
     // update its neighbors and eventually delete it from the discovered Nodes list.
-    while (!myMap.empty())
+    while (!m_Heap.IsEmpty())
     {
-      numberOfNodesChecked++;
-      /*if ( (numberOfNodesChecked % (m_Graph_NumberOfNodes/100)) == 0)
-      {
-        MITK_INFO << "Checked " << ( numberOfNodesChecked / (m_Graph_NumberOfNodes/100) ) << "% List: " << myMap.size()
-      << "\n";
-      }*/
-
-      // Get element with lowest score
-      mainNodeListIndex = myMap.begin()->second->mainListIndex;
-      curNodeDistance = myMap.begin()->second->distance;
-      myMap.begin()->second->closed = true; // close it
-
-      // Debug:
-      // MITK_INFO << "INFO: size " << myMap.size();
-      /*
-      for (it = myMap.begin(); it != myMap.end(); ++it)
-      {
-      MITK_INFO << "(1) " << it->first << "|" << it->second->distAndEst << "|"<<it->second->mainListIndex;
-      }
-      */
-
-      // Kicks out element with lowest score
-      myMap.erase(myMap.begin());
+      // Kicks out element with lowest score and closes it
+      const NodeNumType mainNodeListIndex = m_Heap.Pop();
+      const DistanceType curNodeDistance = m_Distances[mainNodeListIndex];
 
       // if wanted, store vector order
       if (m_StoreVectorOrder)
@@ -525,188 +314,157 @@ namespace itk
       }
 
       // Check neighbors
-      std::vector<ShortestPathNode *> neighborNodes = GetNeighbors(mainNodeListIndex, m_Graph_fullNeighbors);
-      for (NodeNumType i = 0; i < neighborNodes.size(); i++)
+      const IndexType coordCurNode = NodeToCoord(mainNodeListIndex);
+      for (std::size_t i = 0; i < m_NeighborOffsets.size(); ++i)
       {
-        if (neighborNodes[i]->closed)
-          continue; // this nodes is already closed, go to next neighbor
+        const IndexType coordNeighborNode = coordCurNode + m_NeighborOffsets[i];
+        if (!m_GraphRegion.IsInside(coordNeighborNode))
+          continue;
 
-        IndexType coordCurNode = NodeToCoord(mainNodeListIndex);
-        IndexType coordNeighborNode = NodeToCoord(neighborNodes[i]->mainListIndex);
+        const NodeNumType neighbor =
+          static_cast<NodeNumType>(static_cast<OffsetValueType>(mainNodeListIndex) + m_NeighborNodeOffsets[i]);
+        if (m_Heap.IsClosed(neighbor))
+          continue; // this nodes is already closed, go to next neighbor
 
         // calculate the new Distance to the current neighbor
-        double newDistance = curNodeDistance + (m_CostFunction->GetCost(coordCurNode, coordNeighborNode));
+        const DistanceType newDistance =
+          curNodeDistance + m_CostFunction->GetCost(coordCurNode, coordNeighborNode);
 
         // if it is shorter than any yet known path to this neighbor, than the current path is better. Save that!
-        if ((newDistance < neighborNodes[i]->distance) || (neighborNodes[i]->distance == -1))
+        if (newDistance < m_Distances[neighbor] || m_Distances[neighbor] == -1)
         {
-          // if that neighbornode is not in discoverednodeList yet, Push it there and update
-          if (neighborNodes[i]->distance == -1)
-          {
-            neighborNodes[i]->distance = newDistance;
-            neighborNodes[i]->distAndEst = newDistance + getEstimatedCostsToTarget(coordNeighborNode);
-            neighborNodes[i]->prevNode = mainNodeListIndex;
-            myMap.insert(std::pair<double, ShortestPathNode *>(m_Nodes[neighborNodes[i]->mainListIndex].distAndEst,
-                                                               &m_Nodes[neighborNodes[i]->mainListIndex]));
-            /*
-            MITK_INFO << "Inserted: " << m_Nodes[neighborNodes[i]->mainListIndex].distAndEst << "|" <<
-            m_Nodes[neighborNodes[i]->mainListIndex].mainListIndex;
-            MITK_INFO << "INFO: size " << myMap.size();
-            for (it = myMap.begin(); it != myMap.end(); ++it)
-            {
-            MITK_INFO << "(1) " << it->first << "|" << it->second->distAndEst << "|"<<it->second->mainListIndex;
-            }
-            */
-          }
-          // or if is already in discoverednodelist, update
-          else
-          {
-            /*
-            it = myMap.find(neighborNodes[i]->distAndEst);
-            if (it == myMap.end() )
-            {
-            MITK_INFO << "Nothing!";
-            // look further
-            for (it = myMap.begin(); it != myMap.end(); ++it)
-            {
-            if ((*it).second->mainListIndex == lookForId)
-            {
-            MITK_INFO << "But it is there!!!";
-            MITK_INFO << "Searched for: " << lookFor << "   but had: " << (*it).second->distAndEst;
-            }
-
-            }
-            }
-            */
-
-            // 1st : find and delete old element
-            bool found = false;
-            ret = myMap.equal_range(neighborNodes[i]->distAndEst);
-
-            if ((ret.first == ret.second))
-            {
-              /*+++++++++++++ no exact match +++++++++++++*/
-              // MITK_INFO << "No exact match!"; // if this happens, you are screwed
-              /*
-              MITK_INFO << "Was looking for: " << lookFor << "  ID: " << lookForId;
-              if (ret.first != myMap.end() )
-              {
-              it = ret.first;
-              MITK_INFO << "Found: " << it->first << "  ID: " << it->second->mainListIndex;
-              ++it;
-              MITK_INFO << "Found: " << it->first << "  ID: " << it->second->mainListIndex;
-              --it;
-              --it;
-              MITK_INFO << "Found: " << it->first << "  ID: " << it->second->mainListIndex;
-              }
-
-              // look if that ID is found in the map
-              for (it = myMap.begin(); it != myMap.end(); ++it)
-              {
-              if ((*it).second->mainListIndex == lookForId)
-              {
-              MITK_INFO << "But it is there!!!";
-              MITK_INFO << "Searched dist: " << lookFor << "  found dist: " << (*it).second->distAndEst;
-              }
-
-              }
-              */
-            }
-            else
-            {
-              for (it = ret.first; it != ret.second; ++it)
-              {
-                if (it->second->mainListIndex == neighborNodes[i]->mainListIndex)
-                {
-                  found = true;
-                  myMap.erase(it);
-                  /*
-                  MITK_INFO << "INFO: size " << myMap.size();
-                  MITK_INFO << "Erase: " << it->first << "|" << it->second->mainListIndex;
-
-                  MITK_INFO << "INFO: size " << myMap.size();
-                  for (it = myMap.begin(); it != myMap.end(); ++it)
-                  {
-                  MITK_INFO << "(1) " << it->first << "|" << it->second->distAndEst << "|"<<it->second->mainListIndex;
-                  }
-                  */
-                  break;
-                }
-              }
-            }
-
-            if (!found)
-            {
-              // MITK_INFO << "Could not find it! :(";
-              continue;
-            }
-
-            // 2nd: update and insert new element
-            neighborNodes[i]->distance = newDistance;
-            neighborNodes[i]->distAndEst = newDistance + getEstimatedCostsToTarget(coordNeighborNode);
-            neighborNodes[i]->prevNode = mainNodeListIndex;
-            // myMap.insert( std::pair<double,ShortestPathNode*> (neighborNodes[i]->distAndEst, neighborNodes[i]));
-            myMap.insert(std::pair<double, ShortestPathNode *>(m_Nodes[neighborNodes[i]->mainListIndex].distAndEst,
-                                                               &m_Nodes[neighborNodes[i]->mainListIndex]));
-
-            // MITK_INFO << "Re-Inserted: " << m_Nodes[neighborNodes[i]->mainListIndex].distAndEst << "|" <<
-            // m_Nodes[neighborNodes[i]->mainListIndex].mainListIndex;
-            // MITK_INFO << "INFO: size " << myMap.size();
-            /*for (it = myMap.begin(); it != myMap.end(); ++it)
-            {
-            MITK_INFO << "(1) " << it->first << "|" << it->second->distAndEst << "|"<<it->second->mainListIndex;
-            }*/
-          }
+          this->Discover(neighbor);
+          m_Distances[neighbor] = newDistance;
+          m_PreviousNodes[neighbor] = mainNodeListIndex;
+          m_Heap.Push(neighbor, newDistance + getEstimatedCostsToTarget(coordNeighborNode));
         }
       }
       // finished with checking all neighbors.
 
       // Check Timeout, if activated
-      if (m_ActivateTimeOut)
+      if (m_ActivateTimeOut && static_cast<double>(clock() - startAll) / CLOCKS_PER_SEC >= 30)
       {
-        stopAll = clock();
-        durationAll = (double)(stopAll - startAll) / CLOCKS_PER_SEC;
-        if (durationAll >= 30)
-        {
-          // MITK_INFO << "TIMEOUT!! Search took over 30 seconds";
-          timeout = true;
-        }
+        timeout = true;
       }
 
       // Check end criteria:
       // For multiple points
       if (multipleEndPoints)
       {
-        // super slow, make it faster
-        for (unsigned int i = 0; i < m_endPoints.size(); i++)
+        auto endNode = std::find(endNodes.begin(), endNodes.end(), mainNodeListIndex);
+        while (endNode != endNodes.end())
         {
-          if (CoordToNode(m_endPoints[i]) == mainNodeListIndex)
-          {
-            m_endPointsClosed.push_back(NodeToCoord(mainNodeListIndex));
-            m_endPoints.erase(m_endPoints.begin() + i);
-            if (m_endPoints.empty())
-            {
-              // Finished! break
-              return;
-            }
-            if (m_Graph_EndNode == mainNodeListIndex)
-            {
-              // set new end
-              SetEndIndex(m_endPoints[0]);
-            }
-          }
+          m_endPointsClosed.push_back(coordCurNode);
+          m_endPoints.erase(m_endPoints.begin() + (endNode - endNodes.begin()));
+          endNode = endNodes.erase(endNode);
+          endNode = std::find(endNode, endNodes.end(), mainNodeListIndex);
+        }
+
+        if (m_endPoints.empty() || timeout)
+        {
+          // Finished! break
+          return;
+        }
+        if (m_Graph_EndNode == mainNodeListIndex)
+        {
+          // set new end
+          SetEndIndex(m_endPoints[0]);
+          m_Graph_EndNode = endNodes[0];
         }
       }
       // if single end point, then end, if this one is reached or timeout happened.
       else if ((mainNodeListIndex == m_Graph_EndNode || timeout) && !m_CalcAllDistances)
       {
-        /*if (m_StoreVectorOrder)
-          MITK_INFO << "Number of Nodes checked: " << m_VectorOrder.size() ;*/
         return;
       }
     }
   }
 
+  template <class TInputImageType, class TOutputImageType>
+  void ShortestPathImageFilter<TInputImageType, TOutputImageType>::StartBidirectionalSearch()
+  {
+    const clock_t startAll = clock();
+
+    // the best path found so far, through the meeting node of both searches
+    DistanceType bestDistance = std::numeric_limits<DistanceType>::infinity();
+    NodeNumType meetingNode = ShortestPathHeap::NotQueued;
+    if (m_Graph_StartNode == m_Graph_EndNode)
+    {
+      bestDistance = 0;
+      meetingNode = m_Graph_StartNode;
+    }
+
+    this->Discover(m_Graph_EndNode);
+    m_BackwardDistances[m_Graph_EndNode] = 0;
+    m_Heap.Push(m_Graph_StartNode, 0);
+    m_BackwardHeap.Push(m_Graph_EndNode, 0);
+
+    // Once the closest open nodes of both searches are together as far away as the best path, no shorter one exists
+    while (!m_Heap.IsEmpty() && !m_BackwardHeap.IsEmpty() &&
+           m_Heap.GetTopKey() + m_BackwardHeap.GetTopKey() < bestDistance)
+    {
+      const bool forward = m_Heap.GetTopKey() <= m_BackwardHeap.GetTopKey();
+      ShortestPathHeap &heap = forward ? m_Heap : m_BackwardHeap;
+      std::vector<DistanceType> &distances = forward ? m_Distances : m_BackwardDistances;
+      std::vector<NodeNumType> &previousNodes = forward ? m_PreviousNodes : m_NextNodes;
+      const std::vector<DistanceType> &otherDistances = forward ? m_BackwardDistances : m_Distances;
+
+      const NodeNumType node = heap.Pop();
+      const DistanceType nodeDistance = distances[node];
+
+      if (m_StoreVectorOrder)
+      {
+        m_VectorOrder.push_back(node);
+      }
+
+      const IndexType coord = NodeToCoord(node);
+      for (std::size_t i = 0; i < m_NeighborOffsets.size(); ++i)
+      {
+        const IndexType neighborCoord = coord + m_NeighborOffsets[i];
+        if (!m_GraphRegion.IsInside(neighborCoord))
+          continue;
+
+        const NodeNumType neighbor =
+          static_cast<NodeNumType>(static_cast<OffsetValueType>(node) + m_NeighborNodeOffsets[i]);
+        if (heap.IsClosed(neighbor))
+          continue;
+
+        // the backward search walks the edges against their direction
+        const DistanceType newDistance =
+          nodeDistance + (forward ? m_CostFunction->GetCost(coord, neighborCoord)
+                                  : m_CostFunction->GetCost(neighborCoord, coord));
+
+        if (newDistance < distances[neighbor] || distances[neighbor] == -1)
+        {
+          this->Discover(neighbor);
+          distances[neighbor] = newDistance;
+          previousNodes[neighbor] = node;
+          heap.Push(neighbor, newDistance);
+        }
+
+        if (otherDistances[neighbor] != -1 && distances[neighbor] + otherDistances[neighbor] < bestDistance)
+        {
+          bestDistance = distances[neighbor] + otherDistances[neighbor];
+          meetingNode = neighbor;
+        }
+      }
+
+      if (m_ActivateTimeOut && static_cast<double>(clock() - startAll) / CLOCKS_PER_SEC >= 30)
+        break;
+    }
+
+    if (meetingNode == ShortestPathHeap::NotQueued)
+      return;
+
+    // Continue the previous nodes of the forward search along the backward search up to the end node
+    for (NodeNumType node = meetingNode; node != m_Graph_EndNode; node = m_NextNodes[node])
+    {
+      const NodeNumType next = m_NextNodes[node];
+      m_PreviousNodes[next] = node;
+      m_Distances[next] = m_Distances[node] + (m_BackwardDistances[node] - m_BackwardDistances[next]);
+    }
+  }
+
   template <class TInputImageType, class TOutputImageType>
   void ShortestPathImageFilter<TInputImageType, TOutputImageType>::MakeOutputs()
   {
@@ -777,23 +535,22 @@ namespace itk
   typename ShortestPathImageFilter<TInputImageType, TOutputImageType>::OutputImagePointer
     ShortestPathImageFilter<TInputImageType, TOutputImageType>::GetDistanceImage()
   {
-    // Create Distance Image
+    // Create Distance Image, nodes which were not reached or are outside of the graph get -1
     // Return it
 
     OutputImagePointer image = OutputImageType::New();
     image->SetRegions(this->GetInput()->GetLargestPossibleRegion());
     image->Allocate();
-    ;
     OutputImageIteratorType distanceImageIt(image, image->GetRequestedRegion());
-    // Create Distance Image (Output 1)
-    NodeNumType myNodeNum;
     for (distanceImageIt.GoToBegin(); !distanceImageIt.IsAtEnd(); ++distanceImageIt)
     {
-      IndexType index = distanceImageIt.GetIndex();
-      myNodeNum = CoordToNode(index);
-      double newVal = m_Nodes[myNodeNum].distance;
+      const IndexType index = distanceImageIt.GetIndex();
+      double newVal = -1;
+      if (!m_Distances.empty() && CoordIsInBounds(index))
+        newVal = m_Distances[CoordToNode(index)];
       distanceImageIt.Set(newVal);
     }
+    return image;
   }
 
   template <class TInputImageType, class TOutputImageType>
@@ -813,20 +570,23 @@ namespace itk
   template <class TInputImageType, class TOutputImageType>
   void ShortestPathImageFilter<TInputImageType, TOutputImageType>::MakeShortestPathVector()
   {
-    // MITK_INFO << "Make ShortestPath Vec";
-
     // single end point
     if (!multipleEndPoints)
     {
-      // fill m_VectorPath with the Shortest Path
+      // fill m_VectorPath with the Shortest Path, which stays empty if the end point was not reached
       m_VectorPath.clear();
+      if (m_Distances[m_Graph_EndNode] == -1)
+      {
+        itkWarningMacro(<< "The end index " << m_EndIndex << " could not be reached.");
+        return;
+      }
 
       // Go backwards from endnote to startnode
       NodeNumType prevNode = m_Graph_EndNode;
       while (prevNode != m_Graph_StartNode)
       {
         m_VectorPath.push_back(NodeToCoord(prevNode));
-        prevNode = m_Nodes[prevNode].prevNode;
+        prevNode = m_PreviousNodes[prevNode];
       }
       m_VectorPath.push_back(NodeToCoord(prevNode));
       // reverse it
@@ -835,6 +595,7 @@ namespace itk
     // Multiple end end points and pathes
     else
     {
+      m_MultipleVectorPaths.clear();
       for (unsigned int i = 0; i < m_endPointsClosed.size(); i++)
       {
         m_VectorPath.clear();
@@ -843,7 +604,7 @@ namespace itk
         while (prevNode != m_Graph_StartNode)
         {
           m_VectorPath.push_back(NodeToCoord(prevNode));
-          prevNode = m_Nodes[prevNode].prevNode;
+          prevNode = m_PreviousNodes[prevNode];
         }
         m_VectorPath.push_back(NodeToCoord(prevNode));
 
@@ -860,10 +621,16 @@ namespace itk
   {
     m_VectorOrder.clear();
     m_VectorPath.clear();
-    // TODO: if multiple Path, clear all multiple Paths
-
-    if (m_Nodes)
-      delete[] m_Nodes;
+    m_MultipleVectorPaths.clear();
+
+    std::vector<DistanceType>().swap(m_Distances);
+    std::vector<NodeNumType>().swap(m_PreviousNodes);
+    m_Heap.Release();
+    std::vector<DistanceType>().swap(m_BackwardDistances);
+    std::vector<NodeNumType>().swap(m_NextNodes);
+    m_BackwardHeap.Release();
+    std::vector<NodeNumType>().swap(m_TouchedNodes);
+    m_Graph_NumberOfNodes = 0;
   }
 
   template <class TInputImageType, class TOutputImageType>
@@ -886,6 +653,9 @@ namespace itk
   void ShortestPathImageFilter<TInputImageType, TOutputImageType>::PrintSelf(std::ostream &os, Indent indent) const
   {
     Superclass::PrintSelf(os, indent);
+    os << indent << "BidirectionalSearch: " << m_BidirectionalSearch << std::endl;
+    if (m_UseSearchRegion)
+      os << indent << "SearchRegion: " << m_SearchRegion << std::endl;
   }
 
 } /* end namespace itk */
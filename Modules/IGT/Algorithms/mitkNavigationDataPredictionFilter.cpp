@@ -0,0 +1,224 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkNavigationDataPredictionFilter.h"
+#include "mitkNavigationDataLatencyMonitor.h"
+
+#include <vnl/vnl_math.h>
+
+#include <cmath>
+
+namespace
+{
+  const double InitialVelocityVariance = 1.0e6;      // (mm/s)^2, the velocity is unknown at the first sample
+  const double InitialAccelerationVariance = 1.0e8;  // (mm/s^2)^2
+
+  /** rotation vector (axis * angle) of a unit quaternion, using the shorter of both rotations */
+  vnl_vector_fixed<double, 3> RotationVector(const mitk::Quaternion& q)
+  {
+    vnl_vector_fixed<double, 3> v(q.x(), q.y(), q.z());
+    double sine = v.magnitude();
+    if (sine < 1.0e-12)
+      return vnl_vector_fixed<double, 3>(0.0);
+    double angle = 2.0 * std::atan2(sine, q.r());
+    if (angle > vnl_math::pi)
+      angle -= 2.0 * vnl_math::pi;
+    return v * (angle / sine);
+  }
+
+  /** unit quaternion of a rotation vector */
+  mitk::Quaternion QuaternionFromRotationVector(const vnl_vector_fixed<double, 3>& v)
+  {
+    double angle = v.magnitude();
+    if (angle < 1.0e-12)
+      return mitk::Quaternion(0.0, 0.0, 0.0, 1.0);
+    vnl_vector_fixed<double, 3> axis = v * (std::sin(0.5 * angle) / angle);
+    return mitk::Quaternion(axis[0], axis[1], axis[2], std::cos(0.5 * angle));
+  }
+}
+
+mitk::NavigationDataPredictionFilter::NavigationDataPredictionFilter()
+  : mitk::NavigationDataToNavigationDataFilter(),
+    m_MotionModel(ConstantVelocity),
+    m_ProcessNoise(10000.0),
+    m_MeasurementNoise(0.25),
+    m_AngularVelocitySmoothing(0.5),
+    m_PredictionTime(0.0),
+    m_UseMeasuredLatency(false),
+    m_LatencyStage("Render")
+{
+}
+
+mitk::NavigationDataPredictionFilter::~NavigationDataPredictionFilter()
+{
+}
+
+void mitk::NavigationDataPredictionFilter::ResetFilter()
+{
+  for (auto& state : m_FilterStates)
+  {
+    state.m_Initialized = false;
+  }
+}
+
+double mitk::NavigationDataPredictionFilter::GetCurrentPredictionTime() const
+{
+  if (m_UseMeasuredLatency)
+  {
+    std::vector<NavigationDataLatencyMonitor::LatencyStatistics> statistics = NavigationDataLatencyMonitor::GetInstance()->GetStatistics();
+    for (const auto& stage : statistics)
+    {
+      if (stage.m_Stage == m_LatencyStage && stage.m_NumberOfSamples > 0)
+        return stage.m_Median;
+    }
+  }
+  return m_PredictionTime;
+}
+
+void mitk::NavigationDataPredictionFilter::GenerateData()
+{
+  DataObjectPointerArraySizeType numberOfInputs = this->GetNumberOfInputs();
+
+  if ( numberOfInputs == 0 ) return;
+
+  this->CreateOutputsForAllInputs();
+
+  if (m_FilterStates.size() != numberOfInputs)
+  {
+    m_FilterStates.resize(numberOfInputs);
+    this->ResetFilter();
+  }
+
+  const double predictionTime = this->GetCurrentPredictionTime();
+
+  for (unsigned int i = 0; i < numberOfInputs; ++i)
+  {
+    const mitk::NavigationData* nd = this->GetInput(i);
+    assert(nd);
+
+    mitk::NavigationData* output = this->GetOutput(i);
+    assert(output);
+
+    output->Graft(nd); // copy all information from input to output
+
+    FilterState& state = m_FilterStates[i];
+    if (!nd->IsDataValid())
+    {
+      state.m_Initialized = false; // the tool was lost, start over when it is visible again
+      continue;
+    }
+
+    if (!state.m_Initialized)
+      this->InitializeState(state, nd);
+    else
+      this->UpdateState(state, nd);
+
+    mitk::Point3D position;
+    mitk::Quaternion orientation;
+    this->Extrapolate(state, predictionTime, position, orientation);
+    output->SetPosition(position);
+    output->SetOrientation(orientation);
+  }
+}
+
+void mitk::NavigationDataPredictionFilter::InitializeState(FilterState& state, const mitk::NavigationData* nd)
+{
+  const mitk::Point3D position = nd->GetPosition();
+  for (unsigned int axis = 0; axis < 3; ++axis)
+  {
+    state.m_State[axis] = StateType(position[axis], 0.0, 0.0);
+    state.m_Covariance[axis].fill(0.0);
+    state.m_Covariance[axis](0, 0) = m_MeasurementNoise;
+    state.m_Covariance[axis](1, 1) = InitialVelocityVariance;
+    state.m_Covariance[axis](2, 2) = (m_MotionModel == ConstantAcceleration) ? InitialAccelerationVariance : 0.0;
+  }
+  state.m_Orientation = nd->GetOrientation();
+  state.m_AngularVelocity.fill(0.0);
+  state.m_TimeStamp = nd->GetIGTTimeStamp();
+  state.m_Initialized = true;
+}
+
+void mitk::NavigationDataPredictionFilter::UpdateState(FilterState& state, const mitk::NavigationData* nd)
+{
+  const double dt = (nd->GetIGTTimeStamp() - state.m_TimeStamp) / 1000.0;
+  if (dt <= 0.0)
+    return; // no new sample
+
+  /* state transition and process noise; for the constant velocity model the acceleration stays zero */
+  CovarianceType transition;
+  transition.set_identity();
+  transition(0, 1) = dt;
+  CovarianceType processNoise;
+  processNoise.fill(0.0);
+  const double dt2 = dt * dt;
+  const double dt3 = dt2 * dt;
+  if (m_MotionModel == ConstantAcceleration)
+  {
+    transition(0, 2) = 0.5 * dt2;
+    transition(1, 2) = dt;
+    const double dt4 = dt3 * dt;
+    const double dt5 = dt4 * dt;
+    processNoise(0, 0) = dt5 / 20.0;
+    processNoise(0, 1) = processNoise(1, 0) = dt4 / 8.0;
+    processNoise(0, 2) = processNoise(2, 0) = dt3 / 6.0;
+    processNoise(1, 1) = dt3 / 3.0;
+    processNoise(1, 2) = processNoise(2, 1) = dt2 / 2.0;
+    processNoise(2, 2) = dt;
+  }
+  else
+  {
+    transition(2, 2) = 0.0;
+    processNoise(0, 0) = dt3 / 3.0;
+    processNoise(0, 1) = processNoise(1, 0) = dt2 / 2.0;
+    processNoise(1, 1) = dt;
+  }
+  processNoise *= m_ProcessNoise;
+
+  const mitk::Point3D position = nd->GetPosition();
+  for (unsigned int axis = 0; axis < 3; ++axis)
+  {
+    StateType& x = state.m_State[axis];
+    CovarianceType& p = state.m_Covariance[axis];
+
+    /* predict */
+    x = transition * x;
+    p = transition * p * transition.transpose() + processNoise;
+
+    /* correct with the measured position (only the position is observed) */
+    const double innovationVariance = p(0, 0) + m_MeasurementNoise;
+    const StateType gain = p.get_column(0) / innovationVariance;
+    x += gain * (position[axis] - x[0]);
+    p -= outer_product(gain, p.get_row(0));
+  }
+
+  /* angular velocity from the rotation between the last two orientations */
+  const mitk::Quaternion orientation = nd->GetOrientation();
+  const vnl_vector_fixed<double, 3> measuredAngularVelocity = RotationVector(orientation * state.m_Orientation.conjugate()) / dt;
+  state.m_AngularVelocity = m_AngularVelocitySmoothing * state.m_AngularVelocity + (1.0 - m_AngularVelocitySmoothing) * measuredAngularVelocity;
+  state.m_Orientation = orientation;
+  state.m_TimeStamp = nd->GetIGTTimeStamp();
+}
+
+void mitk::NavigationDataPredictionFilter::Extrapolate(const FilterState& state, double predictionTime, mitk::Point3D& position, mitk::Quaternion& orientation) const
+{
+  const double t = predictionTime / 1000.0;
+  for (unsigned int axis = 0; axis < 3; ++axis)
+  {
+    const StateType& x = state.m_State[axis];
+    position[axis] = x[0] + x[1] * t + 0.5 * x[2] * t * t;
+  }
+  orientation = QuaternionFromRotationVector(state.m_AngularVelocity * t) * state.m_Orientation;
+}
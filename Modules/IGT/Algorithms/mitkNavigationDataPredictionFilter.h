@@ -0,0 +1,141 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKNavigationDataPredictionFilter_H_HEADER_INCLUDED_
+#define MITKNavigationDataPredictionFilter_H_HEADER_INCLUDED_
+
+#include <mitkNavigationDataToNavigationDataFilter.h>
+#include "MitkIGTExports.h"
+
+#include <vnl/vnl_matrix_fixed.h>
+#include <vnl/vnl_vector_fixed.h>
+
+namespace mitk {
+
+  /**Documentation
+  * \brief Kalman filter for navigation data which can extrapolate the pose to the time it is displayed.
+  *
+  * Each coordinate of the position is filtered with a Kalman filter using either a constant velocity or a
+  * constant acceleration motion model. The time between two samples is taken from the IGT time stamps, so
+  * irregular update rates are handled correctly. The angular velocity is estimated from consecutive
+  * orientations and smoothed exponentially.
+  *
+  * In contrast to NavigationDataSmoothingFilter, which averages the last positions and thereby adds lag,
+  * this filter can compensate the latency of the pipeline: the output pose is extrapolated by the
+  * prediction time, which is either fixed (SetPredictionTime()) or taken from the latencies measured by
+  * the NavigationDataLatencyMonitor for a pipeline stage (SetUseMeasuredLatency(), SetLatencyStage()).
+  * The time stamp of the output stays the acquisition time of the input, so latency measurements are
+  * not affected.
+  *
+  * If an input becomes invalid, its filter state is reset and restarts with the next valid sample.
+  *
+  * @ingroup Navigation
+  */
+  class MITKIGT_EXPORT NavigationDataPredictionFilter : public NavigationDataToNavigationDataFilter
+  {
+  public:
+    mitkClassMacro(NavigationDataPredictionFilter, NavigationDataToNavigationDataFilter);
+
+    itkNewMacro(Self);
+
+    enum MotionModel {ConstantVelocity, ConstantAcceleration};
+
+    /** @brief Motion model of the position filter. Default is ConstantVelocity. */
+    itkSetMacro(MotionModel, MotionModel);
+    itkGetConstMacro(MotionModel, MotionModel);
+
+    /** @brief Spectral density of the process noise of the position filter (white acceleration for the
+     *         constant velocity model, white jerk for the constant acceleration model), in mm^2 per s^3
+     *         resp. s^5. Higher values follow fast motions more closely, lower values smooth stronger.
+     *         Default is 10000.
+     */
+    itkSetMacro(ProcessNoise, double);
+    itkGetConstMacro(ProcessNoise, double);
+
+    /** @brief Variance of the measured positions in mm^2. Default is 0.25. */
+    itkSetMacro(MeasurementNoise, double);
+    itkGetConstMacro(MeasurementNoise, double);
+
+    /** @brief Weight of the previous angular velocity when a new one is measured, between 0 (no smoothing)
+     *         and 1 (angular velocity is never updated). Default is 0.5.
+     */
+    itkSetClampMacro(AngularVelocitySmoothing, double, 0.0, 1.0);
+    itkGetConstMacro(AngularVelocitySmoothing, double);
+
+    /** @brief Time in ms by which the output pose is extrapolated. Used if UseMeasuredLatency is false or
+     *         no latency was measured yet. Default is 0, i.e. filtering only.
+     */
+    itkSetMacro(PredictionTime, double);
+    itkGetConstMacro(PredictionTime, double);
+
+    /** @brief If true, the prediction time is the median latency the NavigationDataLatencyMonitor measured
+     *         for the stage LatencyStage. Default is false.
+     */
+    itkSetMacro(UseMeasuredLatency, bool);
+    itkGetConstMacro(UseMeasuredLatency, bool);
+    itkBooleanMacro(UseMeasuredLatency);
+
+    /** @brief Stage of the NavigationDataLatencyMonitor whose latency is compensated. Default is "Render". */
+    itkSetStringMacro(LatencyStage);
+    itkGetStringMacro(LatencyStage);
+
+    /** @brief Returns the prediction time in ms that is currently applied. */
+    double GetCurrentPredictionTime() const;
+
+    /** @brief Resets the filter states of all inputs. */
+    void ResetFilter();
+
+  protected:
+    NavigationDataPredictionFilter();
+    ~NavigationDataPredictionFilter() override;
+
+    void GenerateData() override;
+
+    typedef vnl_vector_fixed<double, 3> StateType;        ///< position, velocity and acceleration of one coordinate
+    typedef vnl_matrix_fixed<double, 3, 3> CovarianceType;
+
+    struct FilterState
+    {
+      bool m_Initialized;
+      double m_TimeStamp;                  ///< time stamp of the last sample in ms
+      StateType m_State[3];                ///< Kalman state for x, y and z
+      CovarianceType m_Covariance[3];
+      mitk::Quaternion m_Orientation;      ///< last measured orientation
+      vnl_vector_fixed<double, 3> m_AngularVelocity; ///< rotation vector per second
+    };
+
+    /** @brief Initializes the state of an input with its first valid sample. */
+    void InitializeState(FilterState& state, const mitk::NavigationData* nd);
+
+    /** @brief Predicts the state of an input to the time stamp of the new sample and corrects it with the sample. */
+    void UpdateState(FilterState& state, const mitk::NavigationData* nd);
+
+    /** @brief Computes the pose of the given state extrapolated by predictionTime ms. */
+    void Extrapolate(const FilterState& state, double predictionTime, mitk::Point3D& position, mitk::Quaternion& orientation) const;
+
+    std::vector<FilterState> m_FilterStates;
+
+    MotionModel m_MotionModel;
+    double m_ProcessNoise;
+    double m_MeasurementNoise;
+    double m_AngularVelocitySmoothing;
+    double m_PredictionTime;
+    bool m_UseMeasuredLatency;
+    std::string m_LatencyStage;
+  };
+} // namespace mitk
+
+#endif /* MITKNavigationDataPredictionFilter_H_HEADER_INCLUDED_ */
@@ -33,6 +33,7 @@ mitk::NavigationDataToIGTLMessageFilter::NavigationDataToIGTLMessageFilter()
 
   //  m_OperationMode = Mode3D;
   m_CurrentTimeStep = 0;
+  m_UseMessagePool = false;
   //  m_RingBufferSize = 50; //the default ring buffer size
   //  m_NumberForMean = 100;
 }
@@ -133,17 +134,18 @@ void mitk::NavigationDataToIGTLMessageFilter::CreateOutputsForAllInputs()
   }
 }
 
-void ConvertAffineTransformationIntoIGTLMatrix(mitk::AffineTransform3D* trans,
+static void ConvertNavigationDataIntoIGTLMatrix(const mitk::NavigationData* nd,
   igtl::Matrix4x4 igtlTransform)
 {
-  const mitk::AffineTransform3D::MatrixType& matrix = trans->GetMatrix();
-  mitk::Vector3D position = trans->GetOffset();
+  // the rotation matrix is computed on the stack, no itk transform has to be created
+  const mitk::Matrix3D matrix = nd->GetRotationMatrix();
+  const mitk::NavigationData::PositionType position = nd->GetPosition();
   //copy the data into a matrix type that igtl understands
   for (unsigned int r = 0; r < 3; r++)
   {
     for (unsigned int c = 0; c < 3; c++)
     {
-      igtlTransform[r][c] = matrix(r, c);
+      igtlTransform[r][c] = matrix[r][c];
     }
     igtlTransform[r][3] = position[r];
   }
@@ -154,6 +156,54 @@ void ConvertAffineTransformationIntoIGTLMatrix(mitk::AffineTransform3D* trans,
   igtlTransform[3][3] = 1.0;
 }
 
+void mitk::NavigationDataToIGTLMessageFilter::SetUseMessagePool(bool usePool)
+{
+  if (m_UseMessagePool == usePool)
+    return;
+  m_UseMessagePool = usePool;
+  this->ClearMessagePool();
+  this->Modified();
+}
+
+void mitk::NavigationDataToIGTLMessageFilter::ClearMessagePool()
+{
+  m_MessagePool.clear();
+  m_TrackingDataElementPool.clear();
+  m_QuaternionTrackingDataElementPool.clear();
+  m_TimeStamp = nullptr;
+}
+
+template <class TMessage>
+typename TMessage::Pointer mitk::NavigationDataToIGTLMessageFilter::GetPooledMessage(unsigned int idx)
+{
+  if (!m_UseMessagePool)
+    return TMessage::New();
+
+  if (m_MessagePool.size() <= idx)
+    m_MessagePool.resize(idx + 1);
+  typename TMessage::Pointer message = dynamic_cast<TMessage*>(m_MessagePool[idx].GetPointer());
+  if (message.IsNull())
+  {
+    message = TMessage::New();
+    m_MessagePool[idx] = message.GetPointer();
+  }
+  return message;
+}
+
+template <class TElement>
+typename TElement::Pointer mitk::NavigationDataToIGTLMessageFilter::GetPooledElement(
+  std::vector<typename TElement::Pointer>& pool, unsigned int idx)
+{
+  if (!m_UseMessagePool)
+    return TElement::New();
+
+  if (pool.size() <= idx)
+    pool.resize(idx + 1);
+  if (pool[idx].IsNull())
+    pool[idx] = TElement::New();
+  return pool[idx];
+}
+
 void mitk::NavigationDataToIGTLMessageFilter::GenerateDataModeSendQTransMsg()
 {
   // for each output message
@@ -172,7 +222,7 @@ void mitk::NavigationDataToIGTLMessageFilter::GenerateDataModeSendQTransMsg()
     mitk::NavigationData::OrientationType ori = input->GetOrientation();
 
     //insert this information into the message
-    igtl::PositionMessage::Pointer posMsg = igtl::PositionMessage::New();
+    igtl::PositionMessage::Pointer posMsg = this->GetPooledMessage<igtl::PositionMessage>(i);
     posMsg->SetPosition(pos[0], pos[1], pos[2]);
     posMsg->SetQuaternion(ori[0], ori[1], ori[2], ori[3]);
     igtl::TimeStamp::Pointer timestamp = ConvertToIGTLTimeStamp(input->GetIGTTimeStamp());
@@ -199,15 +249,14 @@ void mitk::NavigationDataToIGTLMessageFilter::GenerateDataModeSendTransMsg()
       continue;
 
     //get the navigation data components
-    mitk::AffineTransform3D::Pointer transform = input->GetAffineTransform3D();
-    mitk::NavigationData::PositionType position = transform->GetOffset();
+    mitk::NavigationData::PositionType position = input->GetPosition();
 
     //convert the transform into a igtl type
     igtl::Matrix4x4 igtlTransform;
-    ConvertAffineTransformationIntoIGTLMatrix(transform, igtlTransform);
+    ConvertNavigationDataIntoIGTLMatrix(input, igtlTransform);
 
     //insert this information into the message
-    igtl::TransformMessage::Pointer transMsg = igtl::TransformMessage::New();
+    igtl::TransformMessage::Pointer transMsg = this->GetPooledMessage<igtl::TransformMessage>(i);
     transMsg->SetMatrix(igtlTransform);
     transMsg->SetPosition(position[0], position[1], position[2]);
     igtl::TimeStamp::Pointer timestamp = ConvertToIGTLTimeStamp(input->GetIGTTimeStamp());
@@ -221,7 +270,13 @@ void mitk::NavigationDataToIGTLMessageFilter::GenerateDataModeSendTransMsg()
 }
 igtl::TimeStamp::Pointer mitk::NavigationDataToIGTLMessageFilter::ConvertToIGTLTimeStamp(double IGTTimeStamp)
 {
-  igtl::TimeStamp::Pointer timestamp = igtl::TimeStamp::New();
+  igtl::TimeStamp::Pointer timestamp = m_TimeStamp;
+  if (timestamp.IsNull())
+  {
+    timestamp = igtl::TimeStamp::New();
+    if (m_UseMessagePool)
+      m_TimeStamp = timestamp;
+  }
   timestamp->SetTime(IGTTimeStamp / 1000, (int)(IGTTimeStamp) % 1000);
   return timestamp;
 }
@@ -233,7 +288,8 @@ void mitk::NavigationDataToIGTLMessageFilter::GenerateDataModeSendQTDataMsg()
 
   //create a output igtl message
   igtl::QuaternionTrackingDataMessage::Pointer qtdMsg =
-    igtl::QuaternionTrackingDataMessage::New();
+    this->GetPooledMessage<igtl::QuaternionTrackingDataMessage>(0);
+  qtdMsg->ClearQuaternionTrackingDataElements();
 
   mitk::NavigationData::PositionType pos;
   mitk::NavigationData::OrientationType ori;
@@ -249,15 +305,13 @@ void mitk::NavigationDataToIGTLMessageFilter::GenerateDataModeSendQTDataMsg()
 
     //insert the information into the tracking element
     igtl::QuaternionTrackingDataElement::Pointer tde =
-      igtl::QuaternionTrackingDataElement::New();
+      this->GetPooledElement<igtl::QuaternionTrackingDataElement>(m_QuaternionTrackingDataElementPool, index);
     tde->SetPosition(pos[0], pos[1], pos[2]);
     tde->SetQuaternion(ori[0], ori[1], ori[2], ori[3]);
     tde->SetName(nd->GetName());
 
     //insert this element into the tracking data message
     qtdMsg->AddQuaternionTrackingDataElement(tde);
-
-    MITK_INFO << ConvertToIGTLTimeStamp(nd->GetIGTTimeStamp());
   }
   qtdMsg->Pack();
 
@@ -267,7 +321,8 @@ void mitk::NavigationDataToIGTLMessageFilter::GenerateDataModeSendQTDataMsg()
 
 void mitk::NavigationDataToIGTLMessageFilter::GenerateDataModeSendTDataMsg()
 {
-  igtl::TrackingDataMessage::Pointer tdMsg = igtl::TrackingDataMessage::New();
+  igtl::TrackingDataMessage::Pointer tdMsg = this->GetPooledMessage<igtl::TrackingDataMessage>(0);
+  tdMsg->ClearTrackingDataElements();
   mitk::IGTLMessage* output = this->GetOutput(0);
   assert(output);
 
@@ -281,15 +336,15 @@ void mitk::NavigationDataToIGTLMessageFilter::GenerateDataModeSendTDataMsg()
       continue;
 
     //get the navigation data components
-    mitk::AffineTransform3D::Pointer transform = input->GetAffineTransform3D();
-    mitk::NavigationData::PositionType position = transform->GetOffset();
+    mitk::NavigationData::PositionType position = input->GetPosition();
 
     //convert the transform into a igtl type
     igtl::Matrix4x4 igtlTransform;
-    ConvertAffineTransformationIntoIGTLMatrix(transform, igtlTransform);
+    ConvertNavigationDataIntoIGTLMatrix(input, igtlTransform);
 
     //insert this information into the message
-    igtl::TrackingDataElement::Pointer tde = igtl::TrackingDataElement::New();
+    igtl::TrackingDataElement::Pointer tde =
+      this->GetPooledElement<igtl::TrackingDataElement>(m_TrackingDataElementPool, i);
     tde->SetMatrix(igtlTransform);
     tde->SetPosition(position[0], position[1], position[2]);
     tde->SetName(input->GetName());
@@ -309,6 +364,7 @@ void mitk::NavigationDataToIGTLMessageFilter::GenerateDataModeSendTDataMsg()
 void mitk::NavigationDataToIGTLMessageFilter::SetOperationMode(OperationMode mode)
 {
   m_OperationMode = mode;
+  this->ClearMessagePool();
   this->Modified();
 }
 
@@ -23,11 +23,21 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkNavigationData.h"
 #include "mitkNavigationDataSource.h"
 
+#include <igtlQuaternionTrackingDataMessage.h>
+#include <igtlTrackingDataMessage.h>
+
 namespace mitk {
   /**Documentation
   *
   * \brief This filter creates IGTL messages from mitk::NavigaitionData objects
   *
+  * By default, new igtl messages are created in every update. If the message pool is
+  * used (SetUseMessagePool()), the igtl messages, tracking data elements and time stamps
+  * are created once per output and input and are updated and packed in place afterwards,
+  * so streaming many tools at high rates does not allocate memory in every update.
+  * \warning With the message pool, the igtl message of an output is overwritten by the
+  * next update. Messages which are still queued for sending at that time are sent with
+  * the new content.
   *
   * \ingroup IGT
   *
@@ -105,6 +115,19 @@ namespace mitk {
     */
     itkGetConstMacro(OperationMode, OperationMode);
 
+    /**
+    * \brief If true, the igtl messages are reused in every update instead of being
+    * created again (see class description). Default is false.
+    */
+    virtual void SetUseMessagePool(bool usePool);
+    itkGetConstMacro(UseMessagePool, bool);
+    itkBooleanMacro(UseMessagePool);
+
+    /**
+    * \brief Releases all pooled messages, they are created again with the next update.
+    */
+    void ClearMessagePool();
+
     /**
     * empty implementation to prevent calling of the superclass method that
     * would try to copy information from the input NavigationData to the output
@@ -167,6 +190,20 @@ namespace mitk {
     /** Converts a mitk::IGTTimestamp (double, milliseconds) to an OpenIGTLink timestamp */
     igtl::TimeStamp::Pointer ConvertToIGTLTimeStamp(double IGTTimeStamp);
 
+    /** Returns the pooled message of output idx, or a new message if the pool is not used */
+    template <class TMessage>
+    typename TMessage::Pointer GetPooledMessage(unsigned int idx);
+
+    /** Returns the pooled tracking data element of input idx, or a new element if the pool is not used */
+    template <class TElement>
+    typename TElement::Pointer GetPooledElement(std::vector<typename TElement::Pointer>& pool, unsigned int idx);
+
+    bool m_UseMessagePool;
+    std::vector<igtl::MessageBase::Pointer> m_MessagePool;          ///< one message per output
+    std::vector<igtl::TrackingDataElement::Pointer> m_TrackingDataElementPool;
+    std::vector<igtl::QuaternionTrackingDataElement::Pointer> m_QuaternionTrackingDataElementPool;
+    igtl::TimeStamp::Pointer m_TimeStamp;                           ///< reused by ConvertToIGTLTimeStamp() with the pool
+
     /** Measurement class to calculate latency and frame count */
   };
 } // namespace mitk
@@ -0,0 +1,218 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkNavigationDataLatencyMonitor.h"
+#include "mitkIGTTimeStamp.h"
+
+#include <mitkExceptionMacro.h>
+#include <mitkNavigationData.h>
+
+#include <algorithm>
+#include <limits>
+
+mitk::NavigationDataLatencyMonitor::Pointer mitk::NavigationDataLatencyMonitor::s_Instance = nullptr;
+
+mitk::NavigationDataLatencyMonitor::NavigationDataLatencyMonitor()
+  : m_Enabled(false), m_BinWidth(0.5), m_NumberOfBins(400), m_NewestIGTTimeStamp(0.0)
+{
+}
+
+mitk::NavigationDataLatencyMonitor::~NavigationDataLatencyMonitor()
+{
+}
+
+mitk::NavigationDataLatencyMonitor* mitk::NavigationDataLatencyMonitor::GetInstance()
+{
+  if (s_Instance.IsNull())
+  {
+    s_Instance = new NavigationDataLatencyMonitor;
+    s_Instance->UnRegister();
+  }
+  return s_Instance;
+}
+
+void mitk::NavigationDataLatencyMonitor::SetEnabled(bool enabled)
+{
+  m_Enabled = enabled;
+}
+
+bool mitk::NavigationDataLatencyMonitor::GetEnabled() const
+{
+  return m_Enabled;
+}
+
+void mitk::NavigationDataLatencyMonitor::SetHistogram(double binWidth, unsigned int numberOfBins)
+{
+  if (binWidth <= 0.0 || numberOfBins == 0)
+  {
+    mitkThrow() << "Invalid latency histogram: bin width " << binWidth << ", " << numberOfBins << " bins.";
+  }
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_BinWidth = binWidth;
+  m_NumberOfBins = numberOfBins;
+  m_Stages.clear();
+  m_StageIndices.clear();
+  m_NewestIGTTimeStamp = 0.0;
+}
+
+double mitk::NavigationDataLatencyMonitor::GetHistogramBinWidth() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_BinWidth;
+}
+
+unsigned int mitk::NavigationDataLatencyMonitor::GetNumberOfHistogramBins() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_NumberOfBins;
+}
+
+void mitk::NavigationDataLatencyMonitor::RecordNavigationData(const std::string& stageName, const NavigationData* navigationData)
+{
+  if (!m_Enabled || navigationData == nullptr || !navigationData->IsDataValid())
+    return;
+
+  const double timeStamp = navigationData->GetIGTTimeStamp();
+  const double now = IGTTimeStamp::GetInstance()->GetElapsed();
+  // no time stamp or clock not running
+  if (timeStamp <= 0.0 || now < 0.0)
+    return;
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  Stage& stage = this->GetStage(stageName);
+  if (timeStamp <= stage.m_LastIGTTimeStamp)
+    return;
+
+  stage.m_LastIGTTimeStamp = timeStamp;
+  m_NewestIGTTimeStamp = std::max(m_NewestIGTTimeStamp, timeStamp);
+  this->AddLatency(stage, now - timeStamp);
+}
+
+void mitk::NavigationDataLatencyMonitor::RecordRendering(const std::string& stageName)
+{
+  if (!m_Enabled)
+    return;
+
+  const double now = IGTTimeStamp::GetInstance()->GetElapsed();
+  if (now < 0.0)
+    return;
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if (m_NewestIGTTimeStamp <= 0.0)
+    return;
+
+  Stage& stage = this->GetStage(stageName);
+  if (m_NewestIGTTimeStamp <= stage.m_LastIGTTimeStamp)
+    return;
+
+  stage.m_LastIGTTimeStamp = m_NewestIGTTimeStamp;
+  this->AddLatency(stage, now - m_NewestIGTTimeStamp);
+}
+
+void mitk::NavigationDataLatencyMonitor::RecordLatency(const std::string& stageName, double latency)
+{
+  if (!m_Enabled)
+    return;
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  this->AddLatency(this->GetStage(stageName), latency);
+}
+
+std::vector<mitk::NavigationDataLatencyMonitor::LatencyStatistics> mitk::NavigationDataLatencyMonitor::GetStatistics() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+
+  std::vector<LatencyStatistics> result;
+  result.reserve(m_Stages.size());
+  for (const Stage& stage : m_Stages)
+  {
+    LatencyStatistics statistics;
+    statistics.m_Stage = stage.m_Name;
+    statistics.m_NumberOfSamples = stage.m_NumberOfSamples;
+    statistics.m_Mean = stage.m_NumberOfSamples > 0 ? stage.m_Sum / stage.m_NumberOfSamples : 0.0;
+    statistics.m_Minimum = stage.m_NumberOfSamples > 0 ? stage.m_Minimum : 0.0;
+    statistics.m_Maximum = stage.m_NumberOfSamples > 0 ? stage.m_Maximum : 0.0;
+    statistics.m_Histogram = stage.m_Histogram;
+
+    // percentiles from the cumulative histogram, bounded by the measured maximum
+    const double fractions[3] = { 0.5, 0.95, 0.99 };
+    double* percentiles[3] = { &statistics.m_Median, &statistics.m_Percentile95, &statistics.m_Percentile99 };
+    for (unsigned int p = 0; p < 3; ++p)
+    {
+      *percentiles[p] = 0.0;
+      if (stage.m_NumberOfSamples == 0)
+        continue;
+
+      const double required = fractions[p] * stage.m_NumberOfSamples;
+      unsigned long cumulative = 0;
+      for (std::size_t bin = 0; bin < stage.m_Histogram.size(); ++bin)
+      {
+        cumulative += stage.m_Histogram[bin];
+        if (cumulative >= required)
+        {
+          *percentiles[p] = std::min((bin + 1) * m_BinWidth, statistics.m_Maximum);
+          break;
+        }
+      }
+    }
+
+    result.push_back(statistics);
+  }
+
+  return result;
+}
+
+void mitk::NavigationDataLatencyMonitor::Reset()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Stages.clear();
+  m_StageIndices.clear();
+  m_NewestIGTTimeStamp = 0.0;
+}
+
+mitk::NavigationDataLatencyMonitor::Stage& mitk::NavigationDataLatencyMonitor::GetStage(const std::string& name)
+{
+  auto it = m_StageIndices.find(name);
+  if (it != m_StageIndices.end())
+    return m_Stages[it->second];
+
+  Stage stage;
+  stage.m_Name = name;
+  stage.m_NumberOfSamples = 0;
+  stage.m_Sum = 0.0;
+  stage.m_Minimum = std::numeric_limits<double>::max();
+  stage.m_Maximum = 0.0;
+  stage.m_LastIGTTimeStamp = 0.0;
+  stage.m_Histogram.assign(m_NumberOfBins, 0);
+
+  m_StageIndices[name] = m_Stages.size();
+  m_Stages.push_back(stage);
+  return m_Stages.back();
+}
+
+void mitk::NavigationDataLatencyMonitor::AddLatency(Stage& stage, double latency)
+{
+  latency = std::max(latency, 0.0);
+
+  ++stage.m_NumberOfSamples;
+  stage.m_Sum += latency;
+  stage.m_Minimum = std::min(stage.m_Minimum, latency);
+  stage.m_Maximum = std::max(stage.m_Maximum, latency);
+
+  const std::size_t bin = std::min(static_cast<std::size_t>(latency / m_BinWidth), static_cast<std::size_t>(m_NumberOfBins - 1));
+  ++stage.m_Histogram[bin];
+}
@@ -0,0 +1,130 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKNAVIGATIONDATALATENCYMONITOR_H_HEADER_INCLUDED_
+#define MITKNAVIGATIONDATALATENCYMONITOR_H_HEADER_INCLUDED_
+
+#include <itkObject.h>
+#include <MitkIGTExports.h>
+#include <mitkCommon.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mitk {
+
+  class NavigationData;
+
+  /**
+  * \brief Collects the latency of navigation data at the stages of navigation pipelines in histograms.
+  *
+  * The latency of a sample at a stage is its age, i.e. the current mitk::IGTTimeStamp::GetElapsed() minus
+  * the IGT time stamp the tracking device assigned at acquisition. If monitoring is enabled (SetEnabled()),
+  * every mitk::NavigationDataSource (TrackingDeviceSource, every NavigationDataToNavigationDataFilter, ...)
+  * records its outputs after each update, the stage is named by the name of the source (see
+  * NavigationDataSource::SetName()) or its class name. RecordRendering() adds the age of the newest sample
+  * when a render pass ends. The difference between consecutive stages is the time spent in a stage.
+  *
+  * Each new sample time stamp is counted once per stage; outputs that were not updated (e.g. a device slower
+  * than the pipeline) are not counted again. Results are only meaningful for live tracking, not for played
+  * recordings. All methods are thread safe, a disabled monitor costs one atomic load per update.
+  *
+  * \ingroup IGT
+  */
+  class MITKIGT_EXPORT NavigationDataLatencyMonitor : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(NavigationDataLatencyMonitor, itk::Object);
+
+    /** \brief Statistics of one stage, all values in milliseconds. */
+    struct LatencyStatistics
+    {
+      std::string m_Stage;
+      unsigned long m_NumberOfSamples;
+      double m_Mean;
+      double m_Minimum;
+      double m_Maximum;
+      /** percentiles are resolved to the upper edge of their histogram bin */
+      double m_Median;
+      double m_Percentile95;
+      double m_Percentile99;
+      /** bin i counts latencies in [i * width, (i+1) * width), the last bin also counts all larger ones */
+      std::vector<unsigned long> m_Histogram;
+    };
+
+    /** \brief Returns the monitor shared by all pipelines. */
+    static NavigationDataLatencyMonitor* GetInstance();
+
+    /** \brief Enables or disables the recording. Default is false. */
+    void SetEnabled(bool enabled);
+    bool GetEnabled() const;
+
+    /** \brief Sets the histogram layout and resets all statistics. Defaults are 0.5 ms and 400 bins (200 ms). */
+    void SetHistogram(double binWidth, unsigned int numberOfBins);
+    double GetHistogramBinWidth() const;
+    unsigned int GetNumberOfHistogramBins() const;
+
+    /** \brief Records the age of valid navigation data at the stage, if the monitor is enabled and the
+    * time stamp is newer than the last one recorded for the stage. */
+    void RecordNavigationData(const std::string& stage, const NavigationData* navigationData);
+
+    /** \brief Records the age of the newest sample recorded by any stage, e.g. after a render pass. */
+    void RecordRendering(const std::string& stage = "Render");
+
+    /** \brief Records a latency (ms) measured elsewhere, if the monitor is enabled. */
+    void RecordLatency(const std::string& stage, double latency);
+
+    /** \brief Returns the statistics of all stages in the order they were recorded first. */
+    std::vector<LatencyStatistics> GetStatistics() const;
+
+    /** \brief Removes all stages and statistics. */
+    void Reset();
+
+  protected:
+    NavigationDataLatencyMonitor();
+    ~NavigationDataLatencyMonitor() override;
+
+  private:
+    struct Stage
+    {
+      std::string m_Name;
+      unsigned long m_NumberOfSamples;
+      double m_Sum;
+      double m_Minimum;
+      double m_Maximum;
+      double m_LastIGTTimeStamp;
+      std::vector<unsigned long> m_Histogram;
+    };
+
+    Stage& GetStage(const std::string& name);
+    void AddLatency(Stage& stage, double latency);
+
+    static Pointer s_Instance;
+
+    std::atomic<bool> m_Enabled;
+    mutable std::mutex m_Mutex;
+    double m_BinWidth;
+    unsigned int m_NumberOfBins;
+    std::vector<Stage> m_Stages;
+    std::map<std::string, std::size_t> m_StageIndices;
+    double m_NewestIGTTimeStamp;
+  };
+} // namespace mitk
+
+#endif /* MITKNAVIGATIONDATALATENCYMONITOR_H_HEADER_INCLUDED_ */
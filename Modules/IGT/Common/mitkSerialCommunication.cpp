@@ -16,6 +16,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkSerialCommunication.h"
 
+#include <algorithm>
+
 #ifdef WIN32
 //#include <atlstr.h>
 #include <itksys/SystemTools.hxx>
@@ -39,7 +41,8 @@ mitk::SerialCommunication::SerialCommunication() : itk::Object(),
   m_DeviceName(""), m_PortNumber(COM1), m_BaudRate(BaudRate9600),
   m_DataBits(DataBits8), m_Parity(None), m_StopBits(StopBits1),
   m_HardwareHandshake(HardwareHandshakeOff),
-  m_ReceiveTimeout(500), m_SendTimeout(500), m_Connected(false)
+  m_ReceiveTimeout(500), m_SendTimeout(500), m_Connected(false),
+  m_BufferedReceive(false), m_ReceiveBuffer(), m_ReceiveBufferPosition(0)
 {
 #ifdef  WIN32 // Windows
   m_ComPortHandle = INVALID_HANDLE_VALUE;
@@ -152,6 +155,29 @@ int mitk::SerialCommunication::Receive(std::string& answer, unsigned int numberO
   if (m_Connected == false)
     return ERROR_VALUE;
 
+  if (m_BufferedReceive)
+  {
+    answer.clear();
+    while (true)
+    {
+      /* take as much as possible from the buffer, but stop after an eol character */
+      std::string::size_type count = std::min<std::string::size_type>(m_ReceiveBuffer.size() - m_ReceiveBufferPosition, numberOfBytes - answer.size());
+      if (eol)
+      {
+        std::string::size_type eolPosition = m_ReceiveBuffer.find(*eol, m_ReceiveBufferPosition);
+        if (eolPosition != std::string::npos && eolPosition < m_ReceiveBufferPosition + count)
+          count = eolPosition - m_ReceiveBufferPosition + 1;
+      }
+      answer.append(m_ReceiveBuffer, m_ReceiveBufferPosition, count);
+      m_ReceiveBufferPosition += count;
+
+      if (answer.size() == numberOfBytes || (eol && !answer.empty() && *eol == answer.at(answer.size() - 1)))
+        return OK;
+      if (this->ReadIntoBuffer() <= 0) // timeout or error
+        return ERROR_VALUE;
+    }
+  }
+
 #ifdef WIN32
   if (m_ComPortHandle == INVALID_HANDLE_VALUE)
     return ERROR_VALUE;
@@ -223,6 +249,69 @@ int mitk::SerialCommunication::Receive(std::string& answer, unsigned int numberO
 #endif
 }
 
+int mitk::SerialCommunication::ReceiveIntoBuffer(char eol)
+{
+  if (m_Connected == false || m_BufferedReceive == false)
+    return ERROR_VALUE;
+
+  std::string::size_type searched = 0; // number of buffered bytes that are known not to contain eol
+  while (m_ReceiveBuffer.find(eol, m_ReceiveBufferPosition + searched) == std::string::npos)
+  {
+    searched = m_ReceiveBuffer.size() - m_ReceiveBufferPosition;
+    if (this->ReadIntoBuffer() <= 0) // timeout or error
+      return ERROR_VALUE;
+  }
+  return OK;
+}
+
+unsigned int mitk::SerialCommunication::GetNumberOfBufferedBytes() const
+{
+  return static_cast<unsigned int>(m_ReceiveBuffer.size() - m_ReceiveBufferPosition);
+}
+
+int mitk::SerialCommunication::ReadIntoBuffer()
+{
+  if (m_ReceiveBufferPosition == m_ReceiveBuffer.size()) // everything was consumed, start over
+  {
+    m_ReceiveBuffer.clear();
+    m_ReceiveBufferPosition = 0;
+  }
+  char chunk[4096];
+
+#ifdef WIN32
+  if (m_ComPortHandle == INVALID_HANDLE_VALUE)
+    return -1;
+
+  /* read everything that is available, or wait up to the receive timeout for a single byte */
+  DWORD numberOfBytesToRead = 1;
+  DWORD errors = 0;
+  COMSTAT status;
+  if (ClearCommError(m_ComPortHandle, &errors, &status) != 0 && status.cbInQue > 0)
+    numberOfBytesToRead = std::min<DWORD>(status.cbInQue, sizeof(chunk));
+
+  DWORD numberOfBytesRead = 0;
+  if (ReadFile(m_ComPortHandle, chunk, numberOfBytesToRead, &numberOfBytesRead, nullptr) == 0)
+    return -1;
+  m_ReceiveBuffer.append(chunk, numberOfBytesRead);
+  return static_cast<int>(numberOfBytesRead);
+
+#else  // Posix
+  if (m_FileDescriptor == INVALID_HANDLE_VALUE)
+    return -1;
+
+  /* VMIN is 0, so read() returns as soon as any bytes are available or VTIME expires */
+  ssize_t num = 0;
+  do
+  {
+    num = read(m_FileDescriptor, chunk, sizeof(chunk));
+  } while (num == -1 && errno == EINTR);
+  if (num < 0)
+    return -1;
+  m_ReceiveBuffer.append(chunk, num);
+  return static_cast<int>(num);
+#endif
+}
+
 int mitk::SerialCommunication::Send(const std::string& input, bool block)
 {
   //long retval = E2ERR_OPENFAILED;
@@ -493,6 +582,8 @@ void mitk::SerialCommunication::SendBreak(unsigned int ms)
 
 void mitk::SerialCommunication::ClearReceiveBuffer()
 {
+  m_ReceiveBuffer.clear();
+  m_ReceiveBufferPosition = 0;
 #ifdef WIN32
   if (m_ComPortHandle != INVALID_HANDLE_VALUE)
     PurgeComm(m_ComPortHandle, PURGE_RXCLEAR);
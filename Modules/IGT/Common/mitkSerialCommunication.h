@@ -155,6 +155,22 @@ namespace mitk
     */
     int Receive(std::string& answer, unsigned int numberOfBytes, const char *eol=nullptr);
 
+    /**
+    * \brief Reads from the serial interface until the eol character is contained in the receive buffer
+    *
+    * Only available if BufferedReceive is enabled. The data stays in the receive buffer and
+    * is returned by the next calls of Receive(), which then do not need to access the serial
+    * interface anymore. This allows to fetch a complete reply before it is parsed.
+    * \return OK if the eol character was received, ERROR_VALUE on timeout, error or if
+    *         BufferedReceive is disabled
+    */
+    int ReceiveIntoBuffer(char eol);
+
+    /**
+    * \brief Returns the number of received bytes which were not yet returned by Receive()
+    */
+    unsigned int GetNumberOfBufferedBytes() const;
+
     /**
     * \brief Send the string input
     *
@@ -298,6 +314,24 @@ namespace mitk
     */
     itkSetMacro(ReceiveTimeout, unsigned int);
 
+    /**
+    * \brief returns true if incoming data is read in chunks into an internal receive buffer
+    */
+    itkGetConstMacro(BufferedReceive, bool);
+
+    /**
+    * \brief Set if incoming data should be read in chunks into an internal receive buffer
+    *
+    * By default, Receive() reads the requested number of bytes directly from the serial
+    * interface, which means one system call per byte on POSIX systems. If BufferedReceive is
+    * enabled, all bytes which are already available are read at once and further calls of
+    * Receive() are served from the buffer. Bytes which were received after the requested ones
+    * (e.g. the reply to a request that was sent in advance) are kept for the next call.
+    * ClearReceiveBuffer() also clears the internal buffer.
+    */
+    itkSetMacro(BufferedReceive, bool);
+    itkBooleanMacro(BufferedReceive);
+
   protected:
     SerialCommunication();
     ~SerialCommunication() override;
@@ -325,6 +359,13 @@ namespace mitk
 
     #endif
 
+    /**
+    * \brief Appends the bytes which are available at the serial interface to m_ReceiveBuffer.
+    * Waits up to the receive timeout for at least one byte.
+    * \return the number of bytes read, 0 on timeout and -1 on error
+    */
+    int ReadIntoBuffer();
+
 
     std::string m_DeviceName; ///< device name that is used to connect to the serial interface (will be used if != "")
     PortNumber m_PortNumber;  ///< port number of the device
@@ -337,6 +378,9 @@ namespace mitk
     unsigned int m_SendTimeout;    ///< timeout for sending data to the serial interface in milliseconds
 
     bool m_Connected;       ///< is set to true if a connection currently established
+    bool m_BufferedReceive; ///< read available data in chunks into m_ReceiveBuffer
+    std::string m_ReceiveBuffer;               ///< received data, valid from m_ReceiveBufferPosition on
+    std::string::size_type m_ReceiveBufferPosition; ///< position of the first byte not yet returned by Receive()
 
 #ifdef WIN32
     HANDLE m_ComPortHandle;
@@ -16,6 +16,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkNavigationDataSource.h"
 #include "mitkUIDGenerator.h"
+#include "mitkNavigationDataLatencyMonitor.h"
 
 
 //Microservices
@@ -29,8 +30,13 @@ const std::string mitk::NavigationDataSource::US_PROPKEY_DEVICENAME = US_INTERFA
 const std::string mitk::NavigationDataSource::US_PROPKEY_ID = US_INTERFACE_NAME + ".id";
 const std::string mitk::NavigationDataSource::US_PROPKEY_ISACTIVE = US_INTERFACE_NAME + ".isActive";
 
+namespace
+{
+  const char* const DefaultName = "NavigationDataSource (no defined type)";
+}
+
 mitk::NavigationDataSource::NavigationDataSource()
-: itk::ProcessObject(), m_Name("NavigationDataSource (no defined type)"), m_IsFrozen(false)
+: itk::ProcessObject(), m_Name(DefaultName), m_IsFrozen(false)
 {
 }
 
@@ -38,6 +44,21 @@ mitk::NavigationDataSource::~NavigationDataSource()
 {
 }
 
+void mitk::NavigationDataSource::UpdateOutputData(itk::DataObject *output)
+{
+  Superclass::UpdateOutputData(output);
+
+  NavigationDataLatencyMonitor* monitor = NavigationDataLatencyMonitor::GetInstance();
+  if (!monitor->GetEnabled())
+    return;
+
+  const std::string stage = (m_Name == DefaultName) ? std::string(this->GetNameOfClass()) : m_Name;
+  for (DataObjectPointerArraySizeType idx = 0; idx < this->GetNumberOfIndexedOutputs(); ++idx)
+  {
+    monitor->RecordNavigationData(stage, this->GetOutput(idx));
+  }
+}
+
 mitk::NavigationData* mitk::NavigationDataSource::GetOutput()
 {
   if (this->GetNumberOfIndexedOutputs() < 1)
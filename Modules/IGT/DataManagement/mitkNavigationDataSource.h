@@ -167,6 +167,12 @@ namespace mitk {
     /** @return Returns whether the data source is currently frozen. */
     itkGetMacro(IsFrozen,bool);
 
+    /**
+    * \brief Updates the outputs and, if enabled, records their latency in the mitk::NavigationDataLatencyMonitor
+    * (stage name is the name of this source, or the class name if no name was set).
+    */
+    void UpdateOutputData(itk::DataObject *output) override;
+
 
   protected:
     NavigationDataSource();
@@ -24,7 +24,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkIGTHardwareException.h"
 
 mitk::TrackingDeviceSource::TrackingDeviceSource()
-  : mitk::NavigationDataSource(), m_TrackingDevice(nullptr)
+  : mitk::NavigationDataSource(), m_TrackingDevice(nullptr), m_UseToolStateSnapshots(false),
+  m_LastFrameNumber(0), m_NumberOfSkippedFrames(0)
 {
 }
 
@@ -66,6 +67,35 @@ void mitk::TrackingDeviceSource::GenerateData()
   }
   /* update outputs with tracking data from tools */
   unsigned int toolCount = m_TrackingDevice->GetToolCount();
+
+  unsigned long frameNumber = 0;
+  if (m_UseToolStateSnapshots && m_TrackingDevice->GetLatestToolStates(m_ToolStates, frameNumber)
+      && m_ToolStates.size() == toolCount)
+  {
+    if (m_LastFrameNumber != 0 && frameNumber > m_LastFrameNumber + 1)
+      m_NumberOfSkippedFrames += frameNumber - m_LastFrameNumber - 1;
+    m_LastFrameNumber = frameNumber;
+
+    for (unsigned int i = 0; i < toolCount; ++i)
+    {
+      mitk::NavigationData* nd = this->GetOutput(i);
+      assert(nd);
+      const mitk::TrackingDevice::ToolState& state = m_ToolStates[i];
+      if (!state.m_Enabled || !state.m_DataValid)
+      {
+        nd->SetDataValid(false);
+        continue;
+      }
+      nd->SetDataValid(true);
+      nd->SetPosition(state.m_Position);
+      nd->SetOrientation(state.m_Orientation);
+      nd->SetOrientationAccuracy(state.m_TrackingError);
+      nd->SetPositionAccuracy(state.m_TrackingError);
+      nd->SetIGTTimeStamp(state.m_IGTTimeStamp);
+    }
+    return;
+  }
+
   for (unsigned int i = 0; i < toolCount; ++i)
   {
     mitk::NavigationData* nd = this->GetOutput(i);
@@ -101,6 +131,8 @@ void mitk::TrackingDeviceSource::SetTrackingDevice( mitk::TrackingDevice* td )
   if (this->m_TrackingDevice.GetPointer() != td)
   {
     this->m_TrackingDevice = td;
+    m_LastFrameNumber = 0;
+    m_NumberOfSkippedFrames = 0;
     this->CreateOutputs();
     std::stringstream name; // create a human readable name for the source
     name << td->GetData().Model << " Tracking Source";
@@ -199,6 +231,13 @@ void mitk::TrackingDeviceSource::UpdateOutputInformation()
 //  return 0;
 //}
 
+bool mitk::TrackingDeviceSource::WaitForNewFrame(unsigned int timeoutMs)
+{
+  if (m_TrackingDevice.IsNull() || !m_UseToolStateSnapshots)
+    return false;
+  return m_TrackingDevice->WaitForToolStates(m_LastFrameNumber, timeoutMs);
+}
+
 bool mitk::TrackingDeviceSource::IsConnected()
 {
   if (m_TrackingDevice.IsNull())
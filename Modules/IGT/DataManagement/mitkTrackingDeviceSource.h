@@ -108,6 +108,34 @@ namespace mitk {
     */
     void UpdateOutputInformation() override;
 
+    /**
+    * \brief If true, the outputs are filled from the tool state snapshots of the tracking device
+    *
+    * The tracking thread of the device publishes all tool states of a frame at once (see
+    * TrackingDevice::GetLatestToolStates()), so the outputs always belong to the same frame and the update
+    * neither waits for nor blocks the tracking thread. If the device does not publish snapshots, the tools
+    * are queried directly as before. Default is false.
+    */
+    itkSetMacro(UseToolStateSnapshots, bool);
+    itkGetConstMacro(UseToolStateSnapshots, bool);
+    itkBooleanMacro(UseToolStateSnapshots);
+
+    /**
+    * \brief Blocks until the tracking device publishes a frame which was not passed to the outputs yet.
+    *
+    * Can be used to update the pipeline with the rate of the tracking device instead of a timer, e.g. from
+    * a dedicated thread: while (source->WaitForNewFrame(100)) { pipeline->Update(); }
+    * Requires UseToolStateSnapshots.
+    * \return false if the timeout expired, tracking stopped or the device does not publish snapshots
+    */
+    bool WaitForNewFrame(unsigned int timeoutMs);
+
+    /**
+    * \brief Returns the number of frames of the device which were never passed to the outputs,
+    * because a newer frame was already available at the next update
+    */
+    itkGetConstMacro(NumberOfSkippedFrames, unsigned long);
+
   protected:
     TrackingDeviceSource();
     ~TrackingDeviceSource() override;
@@ -130,6 +158,11 @@ namespace mitk {
     void CreateOutputs();
 
     mitk::TrackingDevice::Pointer m_TrackingDevice;  ///< the tracking device that is used as a source for this filter object
+
+    bool m_UseToolStateSnapshots;                     ///< read the outputs from the snapshots of the tracking thread
+    unsigned long m_LastFrameNumber;                  ///< number of the frame passed to the outputs by the last update
+    unsigned long m_NumberOfSkippedFrames;            ///< frames which were overwritten before they were used
+    mitk::TrackingDevice::ToolStateVector m_ToolStates; ///< reused to avoid allocations during updates
   };
 } // namespace mitk
 #endif /* MITKTrackingDeviceSource_H_HEADER_INCLUDED_ */
\ No newline at end of file
@@ -58,27 +58,10 @@ void mitk::NavigationDataPlayer::GenerateData()
   // imediatly with the first navigation data (not to wait till the first time
   // stamp is reached)
   TimeStampType timeStampSinceStartWithOffset = m_TimeStampSinceStart
-      + m_NavigationDataSet->Begin()->at(0)->GetIGTTimeStamp();
+      + m_NavigationDataSet->GetIGTTimeStampForIndex(0, 0);
 
-  // iterate through all NavigationData objects of the given tool index
-  // till the timestamp of the NavigationData is greater then the given timestamp
-  for (; m_NavigationDataSetIterator != m_NavigationDataSet->End(); ++m_NavigationDataSetIterator)
-  {
-    // test if the timestamp of the successor is greater than the time stamp
-    if ( m_NavigationDataSetIterator+1 == m_NavigationDataSet->End() ||
-        (m_NavigationDataSetIterator+1)->at(0)->GetIGTTimeStamp() > timeStampSinceStartWithOffset )
-    {
-      break;
-    }
-  }
-
-  for (unsigned int index = 0; index < GetNumberOfOutputs(); index++)
-  {
-    mitk::NavigationData* output = this->GetOutput(index);
-    if( !output ) { mitkThrowException(mitk::IGTException) << "Output of index "<<index<<" is null."; }
-
-    output->Graft(m_NavigationDataSetIterator->at(index));
-  }
+  // binary search for the time step, the outputs are interpolated if enabled
+  this->GraftTimeStamp(timeStampSinceStartWithOffset);
 
   // stop playing if the last NavigationData objects were grafted
   if (m_NavigationDataSetIterator+1 == m_NavigationDataSet->End())
@@ -149,6 +132,25 @@ void mitk::NavigationDataPlayer::Resume()
   }
 }
 
+void mitk::NavigationDataPlayer::SeekTimeStampSinceStart(TimeStampType timeStampSinceStart)
+{
+  if (m_CurPlayerState == PlayerStopped)
+  {
+    this->StartPlaying();
+  }
+
+  if (m_CurPlayerState == PlayerPaused)
+  {
+    // Resume() continues at m_PauseTimeStamp - m_StartPlayingTimeStamp
+    m_StartPlayingTimeStamp = m_PauseTimeStamp - timeStampSinceStart;
+  }
+  else
+  {
+    m_StartPlayingTimeStamp = mitk::IGTTimeStamp::GetInstance()->GetElapsed() - timeStampSinceStart;
+  }
+  m_TimeStampSinceStart = timeStampSinceStart;
+}
+
 mitk::NavigationDataPlayer::PlayerState mitk::NavigationDataPlayer::GetCurrentPlayerState()
 {
   return m_CurPlayerState;
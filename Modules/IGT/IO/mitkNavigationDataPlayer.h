@@ -71,6 +71,13 @@ namespace mitk {
     */
     void Resume();
 
+    /**
+    * \brief Moves the playback to the given time since the start of the recording (in ms), e.g. for
+    * synchronizing with a recorded video. Possible while running or paused, a stopped player is started.
+    * The time step is found by binary search, the outputs change with the next Update().
+    */
+    void SeekTimeStampSinceStart(TimeStampType timeStampSinceStart);
+
     PlayerState GetCurrentPlayerState();
 
     TimeStampType GetTimeStampSinceStart();
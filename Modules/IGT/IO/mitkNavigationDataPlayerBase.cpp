@@ -20,7 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkIGTException.h"
 
 mitk::NavigationDataPlayerBase::NavigationDataPlayerBase()
-  : m_Repeat(false)
+  : m_Repeat(false), m_Interpolation(false)
 {
   this->SetName("Navigation Data Player Source");
 }
@@ -108,3 +108,35 @@ void mitk::NavigationDataPlayerBase::GraftEmptyOutput()
     output->Graft(nd);
   }
 }
+
+void mitk::NavigationDataPlayerBase::GraftCurrentTimeStep()
+{
+  const std::vector<mitk::NavigationData::Pointer> currentTimeStep = *m_NavigationDataSetIterator;
+  for (unsigned int index = 0; index < GetNumberOfOutputs(); index++)
+  {
+    mitk::NavigationData* output = this->GetOutput(index);
+    if( !output ) { mitkThrowException(mitk::IGTException) << "Output of index "<<index<<" is null."; }
+
+    output->Graft(currentTimeStep.at(index));
+  }
+}
+
+void mitk::NavigationDataPlayerBase::GraftTimeStamp(NavigationData::TimeStampType timeStamp)
+{
+  m_NavigationDataSetIterator = m_NavigationDataSet->Begin() + m_NavigationDataSet->GetIndexForIGTTimeStamp(timeStamp, 0);
+
+  if (!m_Interpolation)
+  {
+    this->GraftCurrentTimeStep();
+    return;
+  }
+
+  // every tool is interpolated at its own time stamps, the outputs are filled directly
+  for (unsigned int index = 0; index < GetNumberOfOutputs(); index++)
+  {
+    mitk::NavigationData* output = this->GetOutput(index);
+    if( !output ) { mitkThrowException(mitk::IGTException) << "Output of index "<<index<<" is null."; }
+
+    m_NavigationDataSet->GetInterpolatedNavigationData(timeStamp, index, output);
+  }
+}
@@ -46,6 +46,14 @@ namespace mitk{
     */
     itkGetMacro(Repeat, bool)
 
+    /**
+    * \brief If set to true, the players interpolate the outputs between the recorded time steps when playing
+    * or seeking by time stamp (see mitk::NavigationDataSet::GetInterpolatedNavigationData()), e.g. to play
+    * a recording at another output rate. Default is false.
+    */
+    itkSetMacro(Interpolation, bool)
+    itkGetMacro(Interpolation, bool)
+
     /**
     * \brief Used for pipeline update just to tell the pipeline that we always have to update.
     */
@@ -101,11 +109,30 @@ namespace mitk{
     */
     void GraftEmptyOutput();
 
+    /**
+    * \brief Sets the outputs to the time step m_NavigationDataSetIterator points to.
+    * @throw mitk::IGTException if an output is null.
+    */
+    void GraftCurrentTimeStep();
+
+    /**
+    * \brief Moves m_NavigationDataSetIterator to the last time step (of the first tool) that is not after the
+    * given time stamp, found by binary search, and sets the outputs to this time step or - if m_Interpolation
+    * is set - to the state of each tool interpolated at the time stamp.
+    * @throw mitk::IGTException if an output is null.
+    */
+    void GraftTimeStamp(NavigationData::TimeStampType timeStamp);
+
     /**
     * \brief If the player should repeat outputs. Default is false.
     */
     bool m_Repeat;
 
+    /**
+    * \brief If the outputs are interpolated between time steps. Default is false.
+    */
+    bool m_Interpolation;
+
     NavigationDataSet::Pointer m_NavigationDataSet;
 
     /**
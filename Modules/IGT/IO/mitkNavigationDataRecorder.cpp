@@ -16,8 +16,21 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkNavigationDataRecorder.h"
 #include <mitkIGTTimeStamp.h>
+#include "mitkIGTIOException.h"
+
+#include <algorithm>
+#include <chrono>
 
 mitk::NavigationDataRecorder::NavigationDataRecorder()
+  : m_StreamingBufferSize(1024),
+    m_StreamingFlushInterval(100),
+    m_Streaming(false),
+    m_StreamingCapacity(0),
+    m_StreamingTimeStepSize(0),
+    m_StreamingWriteCount(0),
+    m_StreamingReadCount(0),
+    m_StreamingDroppedCount(0),
+    m_StopStreaming(false)
 {
   //set default values
   m_NumberOfInputs = 0;
@@ -30,6 +43,14 @@ mitk::NavigationDataRecorder::NavigationDataRecorder()
 mitk::NavigationDataRecorder::~NavigationDataRecorder()
 {
   //mitk::IGTTimeStamp::GetInstance()->Stop(this); //commented out because of bug 18952
+  try
+  {
+    this->StopStreaming();
+  }
+  catch (const std::exception& e)
+  {
+    MITK_ERROR << "Error while finishing the streamed recording: " << e.what();
+  }
 }
 
 void mitk::NavigationDataRecorder::GenerateData()
@@ -37,6 +58,19 @@ void mitk::NavigationDataRecorder::GenerateData()
   // get each input, lookup the associated BaseData and transfer the data
   DataObjectPointerArray inputs = this->GetIndexedInputs(); //get all inputs
 
+  if (m_Streaming)
+  {
+    for (unsigned int index = 0; index < inputs.size(); index++)
+    {
+      this->GetOutput(index)->Graft(this->GetInput(index));
+    }
+    if (m_Recording)
+    {
+      this->StreamTimeStep();
+    }
+    return;
+  }
+
   //This vector will hold the NavigationDatas that are copied from the inputs
   std::vector< mitk::NavigationData::Pointer > clonedDatas;
 
@@ -96,16 +130,31 @@ void mitk::NavigationDataRecorder::StartRecording()
 
   if (m_NavigationDataSet.IsNull())
     m_NavigationDataSet = mitk::NavigationDataSet::New(GetNumberOfIndexedInputs());
+
+  if (!m_StreamingFileName.empty())
+  {
+    try
+    {
+      this->StartStreaming();
+    }
+    catch (...)
+    {
+      m_Recording = false;
+      throw;
+    }
+  }
 }
 
 void mitk::NavigationDataRecorder::StopRecording()
 {
-  if (!m_Recording)
+  if (!m_Recording && !m_Streaming)
   {
     std::cout << "You have to start a recording first" << std::endl;
     return;
   }
   m_Recording = false;
+
+  this->StopStreaming();
 }
 
 void mitk::NavigationDataRecorder::ResetRecording()
@@ -117,9 +166,214 @@ void mitk::NavigationDataRecorder::ResetRecording()
     mitk::IGTTimeStamp::GetInstance()->Stop(this);
     mitk::IGTTimeStamp::GetInstance()->Start(this);
   }
+
+  const bool restartStreaming = m_Streaming;
+  this->StopStreaming();
+  m_StreamingInitializedFileName.clear();
+  m_StreamingWriteCount = 0;
+  m_StreamingReadCount = 0;
+  m_StreamingDroppedCount = 0;
+  if (restartStreaming && m_Recording)
+  {
+    this->StartStreaming();
+  }
 }
 
 int mitk::NavigationDataRecorder::GetNumberOfRecordedSteps()
 {
+  if (!m_StreamingInitializedFileName.empty())
+    return static_cast<int>(m_StreamingWriteCount.load());
+
   return m_NavigationDataSet->Size();
+}
+
+unsigned long mitk::NavigationDataRecorder::GetNumberOfDroppedSteps()
+{
+  return m_StreamingDroppedCount;
+}
+
+void mitk::NavigationDataRecorder::StartStreaming()
+{
+  const unsigned int numberOfInputs = this->GetNumberOfIndexedInputs();
+
+  if (m_StreamingInitializedFileName != m_StreamingFileName)
+  {
+    // new file: write the header, the tool names are taken from the inputs
+    m_StreamingHeader = NavigationDataSetBinaryFormat::Header();
+    for (unsigned int index = 0; index < numberOfInputs; index++)
+    {
+      m_StreamingHeader.m_ToolNames.push_back(this->GetInput(index)->GetName());
+    }
+
+    m_StreamingFile.open(m_StreamingFileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!m_StreamingFile.is_open())
+    {
+      mitkThrowException(mitk::IGTIOException) << "Could not open streaming file " << m_StreamingFileName << ".";
+    }
+    NavigationDataSetBinaryFormat::WriteHeader(m_StreamingFile, m_StreamingHeader);
+    m_StreamingFile.flush();
+
+    m_StreamingInitializedFileName = m_StreamingFileName;
+    m_StreamingWriteCount = 0;
+    m_StreamingReadCount = 0;
+    m_StreamingDroppedCount = 0;
+  }
+  else
+  {
+    // resumed recording: append to the file of the previous session
+    if (m_StreamingHeader.m_ToolNames.size() != numberOfInputs)
+    {
+      mitkThrowException(mitk::IGTIOException) << "Cannot resume streaming to " << m_StreamingFileName << " with "
+        << numberOfInputs << " inputs, the file has " << m_StreamingHeader.m_ToolNames.size() << " tools.";
+    }
+    m_StreamingFile.open(m_StreamingFileName.c_str(), std::ios::out | std::ios::binary | std::ios::app);
+    if (!m_StreamingFile.is_open())
+    {
+      mitkThrowException(mitk::IGTIOException) << "Could not open streaming file " << m_StreamingFileName << ".";
+    }
+  }
+
+  // the buffer is empty here (read count == write count), so the ring can be resized between sessions
+  m_StreamingTimeStepSize = NavigationDataSetBinaryFormat::GetTimeStepSize(m_StreamingHeader);
+  m_StreamingCapacity = std::max(m_StreamingBufferSize, 1u);
+  m_StreamingBuffer.assign(m_StreamingCapacity * m_StreamingTimeStepSize, 0);
+
+  m_StopStreaming = false;
+  m_StreamingError = nullptr;
+  m_StreamingThread = std::thread(&NavigationDataRecorder::StreamingThreadFunction, this);
+  m_Streaming = true;
+}
+
+void mitk::NavigationDataRecorder::StopStreaming()
+{
+  if (!m_Streaming)
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(m_StreamingMutex);
+    m_StopStreaming = true;
+  }
+  m_StreamingCondition.notify_one();
+  m_StreamingThread.join();
+
+  m_StreamingFile.close();
+  m_StreamingBuffer = std::vector<char>();
+  m_Streaming = false;
+
+  if (m_StreamingError)
+  {
+    std::exception_ptr error = m_StreamingError;
+    m_StreamingError = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+void mitk::NavigationDataRecorder::StreamTimeStep()
+{
+  // if limitation is set and has been reached, stop recording
+  if ((m_RecordCountLimit > 0) && (m_StreamingWriteCount.load(std::memory_order_relaxed) >= static_cast<std::size_t>(m_RecordCountLimit)))
+  {
+    m_Recording = false;
+    return;
+  }
+
+  const std::size_t numberOfTools = m_StreamingHeader.m_ToolNames.size();
+
+  if (m_RecordOnlyValidData)
+  {
+    for (std::size_t index = 0; index < numberOfTools; index++)
+    {
+      if (!this->GetInput(index)->IsDataValid())
+        return;
+    }
+  }
+
+  // only the pipeline thread writes m_StreamingWriteCount, the writer thread only reads it
+  const std::size_t writeCount = m_StreamingWriteCount.load(std::memory_order_relaxed);
+  const std::size_t bufferedSteps = writeCount - m_StreamingReadCount.load(std::memory_order_acquire);
+  if (bufferedSteps >= m_StreamingCapacity)
+  {
+    // never block or allocate on the pipeline thread
+    ++m_StreamingDroppedCount;
+    m_StreamingCondition.notify_one();
+    return;
+  }
+
+  const std::size_t recordSize = NavigationDataSetBinaryFormat::GetRecordSize(m_StreamingHeader.m_CovariancePerRecord);
+  char* timeStep = &m_StreamingBuffer[(writeCount % m_StreamingCapacity) * m_StreamingTimeStepSize];
+  mitk::NavigationData::TimeStampType igtTimestamp = 0.0;
+  if (m_StandardizeTime)
+    igtTimestamp = mitk::IGTTimeStamp::GetInstance()->GetElapsed(this);
+
+  for (std::size_t index = 0; index < numberOfTools; index++)
+  {
+    const mitk::NavigationData* nd = this->GetInput(index);
+    const mitk::NavigationData::PositionType position = nd->GetPosition();
+    const mitk::NavigationData::OrientationType orientation = nd->GetOrientation();
+    const mitk::NavigationData::CovarianceMatrixType covariance = nd->GetCovErrorMatrix();
+    const double orientationValues[4] = { orientation[0], orientation[1], orientation[2], orientation[3] };
+
+    unsigned char flags = 0;
+    if (nd->IsDataValid()) flags |= mitk::NavigationDataSet::DataValidFlag;
+    if (nd->GetHasPosition()) flags |= mitk::NavigationDataSet::HasPositionFlag;
+    if (nd->GetHasOrientation()) flags |= mitk::NavigationDataSet::HasOrientationFlag;
+
+    NavigationDataSetBinaryFormat::PackRecord(timeStep + index * recordSize, m_StreamingHeader.m_CovariancePerRecord,
+      m_StandardizeTime ? igtTimestamp : nd->GetIGTTimeStamp(), position.GetDataPointer(), orientationValues, flags,
+      covariance.GetVnlMatrix().data_block());
+  }
+
+  m_StreamingWriteCount.store(writeCount + 1, std::memory_order_release);
+
+  // wake up the writer early if the buffer is half full
+  if (2 * (bufferedSteps + 1) >= m_StreamingCapacity)
+    m_StreamingCondition.notify_one();
+}
+
+void mitk::NavigationDataRecorder::WriteBufferedSteps()
+{
+  const std::size_t writeCount = m_StreamingWriteCount.load(std::memory_order_acquire);
+  std::size_t readCount = m_StreamingReadCount.load(std::memory_order_relaxed);
+
+  while (readCount != writeCount)
+  {
+    // at most two contiguous parts because of the wrap around of the ring
+    const std::size_t slot = readCount % m_StreamingCapacity;
+    const std::size_t count = std::min(writeCount - readCount, m_StreamingCapacity - slot);
+    m_StreamingFile.write(&m_StreamingBuffer[slot * m_StreamingTimeStepSize], count * m_StreamingTimeStepSize);
+    readCount += count;
+  }
+  m_StreamingFile.flush();
+
+  if (!m_StreamingFile)
+  {
+    mitkThrowException(mitk::IGTIOException) << "Could not write to streaming file " << m_StreamingFileName << ".";
+  }
+
+  // the slots are released only after the data has been handed to the operating system
+  m_StreamingReadCount.store(readCount, std::memory_order_release);
+}
+
+void mitk::NavigationDataRecorder::StreamingThreadFunction()
+{
+  try
+  {
+    std::unique_lock<std::mutex> lock(m_StreamingMutex);
+    while (!m_StopStreaming)
+    {
+      m_StreamingCondition.wait_for(lock, std::chrono::milliseconds(m_StreamingFlushInterval));
+      lock.unlock();
+      this->WriteBufferedSteps();
+      lock.lock();
+    }
+    lock.unlock();
+
+    // write what was recorded until StopStreaming()
+    this->WriteBufferedSteps();
+  }
+  catch (...)
+  {
+    // rethrown by StopStreaming(), the pipeline thread drops the steps once the buffer is full
+    m_StreamingError = std::current_exception();
+  }
 }
\ No newline at end of file
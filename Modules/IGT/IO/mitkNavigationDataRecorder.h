@@ -20,6 +20,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkNavigationDataToNavigationDataFilter.h"
 #include "mitkNavigationData.h"
 #include "mitkNavigationDataSet.h"
+#include "mitkNavigationDataSetBinaryFormat.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <thread>
 
 namespace mitk
 {
@@ -31,6 +39,15 @@ namespace mitk
   * With StopRecording() the stream is stopped, but can be resumed anytime.
   * To start recording to a new NavigationDataSet, call ResetRecording();
   *
+  * <b>Streaming mode:</b> If a streaming file name is set (see SetStreamingFileName()) the recorder does not
+  * store the data in the NavigationDataSet. Instead, every Update() packs the current state into a ring buffer
+  * that is preallocated by StartRecording() (no allocation and no locking on the pipeline thread), and a
+  * background thread appends the buffered time steps to the file in the binary NavigationDataSet format (*.ndb).
+  * The file is flushed at least every StreamingFlushInterval milliseconds, so a crash loses at most the data of
+  * that interval. If the writer cannot keep up and the buffer is full, time steps are dropped
+  * (see GetNumberOfDroppedSteps()) instead of growing the memory. The recorded file can be loaded with
+  * mitk::IOUtil::Load().
+  *
   * \warning Do not add inputs while the recorder ist recording. The recorder can't handle that and will cause a nullpointer exception.
   * \ingroup IGT
   */
@@ -107,6 +124,33 @@ namespace mitk
     */
     virtual int GetNumberOfRecordedSteps();
 
+    /**
+    * \brief Sets the file the data is streamed to while recording. An empty name (the default) records into
+    * the NavigationDataSet. Must not be changed while recording.
+    *
+    * Resuming a stopped recording appends to the file, ResetRecording() starts a new file.
+    */
+    itkSetStringMacro(StreamingFileName);
+    itkGetStringMacro(StreamingFileName);
+
+    /**
+    * \brief Sets the number of time steps the ring buffer of the streaming mode can hold. Default is 1024.
+    */
+    itkSetMacro(StreamingBufferSize, unsigned int);
+    itkGetMacro(StreamingBufferSize, unsigned int);
+
+    /**
+    * \brief Sets the maximum time in milliseconds until recorded time steps are written and flushed to the file.
+    * Default is 100.
+    */
+    itkSetMacro(StreamingFlushInterval, unsigned int);
+    itkGetMacro(StreamingFlushInterval, unsigned int);
+
+    /**
+    * \brief Returns the number of time steps that were dropped in streaming mode because the buffer was full.
+    */
+    virtual unsigned long GetNumberOfDroppedSteps();
+
   protected:
 
     void GenerateData() override;
@@ -128,6 +172,42 @@ namespace mitk
     int m_RecordCountLimit; ///< limits the number of frames, recording will be stopped if the limit is reached. -1 disables the limit
 
     bool m_RecordOnlyValidData; //< indicates whether only valid data is recorded
+
+  private:
+
+    /** opens the streaming file and starts the writer thread, throws mitk::IGTIOException if the file cannot be opened */
+    void StartStreaming();
+
+    /** writes the remaining buffered steps, stops the writer thread and closes the file */
+    void StopStreaming();
+
+    /** appends the buffered time steps to the file (writer thread) */
+    void WriteBufferedSteps();
+
+    /** packs the current state of the inputs into the ring buffer (pipeline thread) */
+    void StreamTimeStep();
+
+    void StreamingThreadFunction();
+
+    std::string m_StreamingFileName;
+    unsigned int m_StreamingBufferSize;
+    unsigned int m_StreamingFlushInterval;
+
+    bool m_Streaming; ///< true while the writer thread is running
+    std::string m_StreamingInitializedFileName; ///< file whose header has been written, a resumed recording appends to it
+    NavigationDataSetBinaryFormat::Header m_StreamingHeader;
+    std::ofstream m_StreamingFile;
+    std::vector<char> m_StreamingBuffer; ///< ring buffer of packed time steps
+    std::size_t m_StreamingCapacity; ///< number of time steps of the ring buffer
+    std::size_t m_StreamingTimeStepSize;
+    std::atomic<std::size_t> m_StreamingWriteCount; ///< number of time steps put into the buffer (pipeline thread)
+    std::atomic<std::size_t> m_StreamingReadCount; ///< number of time steps written to the file (writer thread)
+    std::atomic<unsigned long> m_StreamingDroppedCount;
+    std::thread m_StreamingThread;
+    std::mutex m_StreamingMutex;
+    std::condition_variable m_StreamingCondition;
+    bool m_StopStreaming;
+    std::exception_ptr m_StreamingError;
   };
 }
 #endif // #define _MITK_POINT_SET_SOURCE_H
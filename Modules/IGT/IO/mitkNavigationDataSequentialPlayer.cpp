@@ -71,6 +71,16 @@ bool mitk::NavigationDataSequentialPlayer::GoToNextSnapshot()
   return true;
 }
 
+void mitk::NavigationDataSequentialPlayer::GoToTimeStamp(NavigationData::TimeStampType timeStamp)
+{
+  if ( this->GetNumberOfSnapshots() == 0 )
+  {
+    mitkThrowException(mitk::IGTException) << "Cannot go to time stamp " << timeStamp << ", the NavigationDataSet is empty.";
+  }
+
+  this->GraftTimeStamp(timeStamp);
+}
+
 void mitk::NavigationDataSequentialPlayer::GenerateData()
 {
   if ( m_NavigationDataSetIterator == m_NavigationDataSet->End() )
@@ -80,13 +90,7 @@ void mitk::NavigationDataSequentialPlayer::GenerateData()
   }
   else
   {
-    for (unsigned int index = 0; index < GetNumberOfOutputs(); index++)
-    {
-      mitk::NavigationData* output = this->GetOutput(index);
-      if( !output ) { mitkThrowException(mitk::IGTException) << "Output of index "<<index<<" is null."; }
-
-      output->Graft(m_NavigationDataSetIterator->at(index));
-    }
+    this->GraftCurrentTimeStep();
   }
 }
 
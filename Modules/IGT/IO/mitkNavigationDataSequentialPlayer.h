@@ -57,6 +57,19 @@ namespace mitk
     */
     bool GoToNextSnapshot();
 
+    /**
+    * \brief Advance the output to the state at the given IGT time stamp (time stamps of the first tool).
+    *
+    * The snapshot is found by binary search. If interpolation is enabled (see SetInterpolation()) the outputs are
+    * interpolated between the snapshots, which allows playing a recording at an arbitrary rate, e.g. synchronized
+    * to a recorded video. Time stamps outside of the recording are clamped to the first or last snapshot.
+    * Going back is possible independent of m_Repeat.
+    * Filter output is updated inside the function.
+    *
+    * @throw mitk::IGTException Throws an exception if the NavigationDataSet is empty or an output is null.
+    */
+    void GoToTimeStamp(NavigationData::TimeStampType timeStamp);
+
     /**
     * \brief Used for pipeline update just to tell the pipeline
     * that we always have to update
@@ -20,7 +20,9 @@ set(MODULE_TESTS
    mitkClaronTrackingDeviceTest.cpp
    mitkNavigationDataDisplacementFilterTest.cpp
    mitkNavigationDataLandmarkTransformFilterTest.cpp
+   mitkNavigationDataLatencyMonitorTest.cpp
    mitkNavigationDataObjectVisualizationFilterTest.cpp
+   mitkNavigationDataPredictionFilterTest.cpp
    mitkNavigationDataSetTest.cpp
    mitkNavigationDataTest.cpp
    mitkNavigationDataRecorderTest.cpp
@@ -28,6 +30,7 @@ set(MODULE_TESTS
    mitkNavigationDataSequentialPlayerTest.cpp
    mitkNavigationDataSetReaderWriterXMLTest.cpp
    mitkNavigationDataSetReaderWriterCSVTest.cpp
+   mitkNavigationDataSetReaderWriterBinaryTest.cpp
    mitkNavigationDataSourceTest.cpp
    mitkNavigationDataToMessageFilterTest.cpp
    mitkNavigationDataToNavigationDataFilterTest.cpp
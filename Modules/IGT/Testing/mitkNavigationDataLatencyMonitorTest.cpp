@@ -0,0 +1,117 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkNavigationDataLatencyMonitor.h>
+#include <mitkNavigationDataDisplacementFilter.h>
+#include <mitkNavigationData.h>
+#include <mitkIGTTimeStamp.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <itksys/SystemTools.hxx>
+
+class mitkNavigationDataLatencyMonitorTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkNavigationDataLatencyMonitorTestSuite);
+  MITK_TEST(TestStatistics);
+  MITK_TEST(TestDisabledMonitorRecordsNothing);
+  MITK_TEST(TestPipelineStages);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::NavigationDataLatencyMonitor* m_Monitor;
+  itk::Object::Pointer m_Clock;
+
+public:
+
+  void setUp() override
+  {
+    m_Monitor = mitk::NavigationDataLatencyMonitor::GetInstance();
+    m_Monitor->SetHistogram(1.0, 100);
+    m_Monitor->SetEnabled(true);
+
+    m_Clock = itk::Object::New();
+    mitk::IGTTimeStamp::GetInstance()->Start(m_Clock);
+  }
+
+  void tearDown() override
+  {
+    mitk::IGTTimeStamp::GetInstance()->Stop(m_Clock);
+    m_Monitor->SetEnabled(false);
+    m_Monitor->Reset();
+  }
+
+  void TestStatistics()
+  {
+    for (unsigned int i = 0; i < 100; i++)
+    {
+      m_Monitor->RecordLatency("Stage", i + 0.5);
+    }
+    m_Monitor->RecordLatency("Stage", 1000.0);
+
+    std::vector<mitk::NavigationDataLatencyMonitor::LatencyStatistics> statistics = m_Monitor->GetStatistics();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), statistics.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("Stage"), statistics[0].m_Stage);
+    CPPUNIT_ASSERT_EQUAL(101ul, statistics[0].m_NumberOfSamples);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, statistics[0].m_Minimum, mitk::eps);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1000.0, statistics[0].m_Maximum, mitk::eps);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL((5000.0 + 1000.0) / 101.0, statistics[0].m_Mean, mitk::eps);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(51.0, statistics[0].m_Median, mitk::eps);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(96.0, statistics[0].m_Percentile95, mitk::eps);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Latencies above the histogram are counted in the last bin", 2ul, statistics[0].m_Histogram.back());
+  }
+
+  void TestDisabledMonitorRecordsNothing()
+  {
+    m_Monitor->SetEnabled(false);
+    m_Monitor->RecordLatency("Stage", 1.0);
+    CPPUNIT_ASSERT(m_Monitor->GetStatistics().empty());
+  }
+
+  void TestPipelineStages()
+  {
+    itksys::SystemTools::Delay(5);
+    mitk::NavigationData::Pointer nd = mitk::NavigationData::New();
+    nd->SetDataValid(true);
+    nd->SetIGTTimeStamp(mitk::IGTTimeStamp::GetInstance()->GetElapsed());
+
+    mitk::NavigationDataDisplacementFilter::Pointer first = mitk::NavigationDataDisplacementFilter::New();
+    first->SetName("First");
+    first->SetInput(nd);
+    mitk::NavigationDataDisplacementFilter::Pointer second = mitk::NavigationDataDisplacementFilter::New();
+    second->SetName("Second");
+    second->ConnectTo(first);
+
+    second->Update();
+    // the same sample is not counted twice
+    second->GetOutput()->Modified();
+    second->Update();
+    m_Monitor->RecordRendering();
+
+    std::vector<mitk::NavigationDataLatencyMonitor::LatencyStatistics> statistics = m_Monitor->GetStatistics();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), statistics.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("First"), statistics[0].m_Stage);
+    CPPUNIT_ASSERT_EQUAL(std::string("Second"), statistics[1].m_Stage);
+    CPPUNIT_ASSERT_EQUAL(std::string("Render"), statistics[2].m_Stage);
+    for (const auto& stage : statistics)
+    {
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(stage.m_Stage, 1ul, stage.m_NumberOfSamples);
+    }
+    CPPUNIT_ASSERT_MESSAGE("Later stages see older samples", statistics[0].m_Maximum <= statistics[2].m_Maximum);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkNavigationDataLatencyMonitor)
@@ -0,0 +1,171 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkNavigationDataPredictionFilter.h>
+#include <mitkNavigationDataLatencyMonitor.h>
+#include <mitkNavigationData.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <cmath>
+
+class mitkNavigationDataPredictionFilterTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkNavigationDataPredictionFilterTestSuite);
+  MITK_TEST(TestFilteringWithoutPrediction);
+  MITK_TEST(TestConstantVelocityPrediction);
+  MITK_TEST(TestConstantAccelerationPrediction);
+  MITK_TEST(TestOrientationPrediction);
+  MITK_TEST(TestInvalidInputResetsFilter);
+  MITK_TEST(TestMeasuredLatency);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::NavigationDataPredictionFilter::Pointer m_Filter;
+  mitk::NavigationData::Pointer m_Input;
+
+  /** moves the input to the given position and orientation at time stamp (ms) and updates the filter */
+  void Step(double timeStamp, const mitk::Point3D& position, const mitk::Quaternion& orientation)
+  {
+    m_Input->SetIGTTimeStamp(timeStamp);
+    m_Input->SetPosition(position);
+    m_Input->SetOrientation(orientation);
+    m_Input->SetDataValid(true);
+    m_Filter->Update();
+  }
+
+  mitk::Point3D PositionAt(double x)
+  {
+    mitk::Point3D position;
+    mitk::FillVector3D(position, x, 10.0, -5.0);
+    return position;
+  }
+
+  mitk::Quaternion RotationAroundZ(double angle)
+  {
+    return mitk::Quaternion(0.0, 0.0, std::sin(0.5 * angle), std::cos(0.5 * angle));
+  }
+
+public:
+
+  void setUp() override
+  {
+    m_Filter = mitk::NavigationDataPredictionFilter::New();
+    m_Input = mitk::NavigationData::New();
+    m_Filter->SetInput(m_Input);
+  }
+
+  void tearDown() override
+  {
+    m_Filter = nullptr;
+    m_Input = nullptr;
+  }
+
+  void TestFilteringWithoutPrediction()
+  {
+    // a resting tool is not moved by the filter
+    for (unsigned int i = 1; i <= 20; ++i)
+    {
+      this->Step(10.0 * i, this->PositionAt(3.0), this->RotationAroundZ(0.3));
+    }
+    CPPUNIT_ASSERT(mitk::Equal(m_Filter->GetOutput()->GetPosition(), this->PositionAt(3.0), 1e-6));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(10.0 * 20, m_Filter->GetOutput()->GetIGTTimeStamp(), mitk::eps);
+  }
+
+  void TestConstantVelocityPrediction()
+  {
+    // 100 mm/s along x, one sample every 10 ms, extrapolated by 50 ms
+    m_Filter->SetPredictionTime(50.0);
+    for (unsigned int i = 1; i <= 100; ++i)
+    {
+      this->Step(10.0 * i, this->PositionAt(1.0 * i), this->RotationAroundZ(0.0));
+    }
+    CPPUNIT_ASSERT_MESSAGE("Position is extrapolated by the prediction time",
+      mitk::Equal(m_Filter->GetOutput()->GetPosition(), this->PositionAt(105.0), 0.1));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Time stamp stays the acquisition time", 1000.0, m_Filter->GetOutput()->GetIGTTimeStamp(), mitk::eps);
+  }
+
+  void TestConstantAccelerationPrediction()
+  {
+    // x = 0.5 * a * t^2 with a = 1000 mm/s^2
+    m_Filter->SetMotionModel(mitk::NavigationDataPredictionFilter::ConstantAcceleration);
+    m_Filter->SetPredictionTime(20.0);
+    for (unsigned int i = 1; i <= 100; ++i)
+    {
+      const double t = 0.01 * i;
+      this->Step(1000.0 * t, this->PositionAt(500.0 * t * t), this->RotationAroundZ(0.0));
+    }
+    const double t = 1.02;
+    CPPUNIT_ASSERT(mitk::Equal(m_Filter->GetOutput()->GetPosition(), this->PositionAt(500.0 * t * t), 0.1));
+  }
+
+  void TestOrientationPrediction()
+  {
+    // 90 degrees per second around z, extrapolated by 100 ms
+    const double angularVelocity = 0.5 * vnl_math::pi;
+    m_Filter->SetPredictionTime(100.0);
+    for (unsigned int i = 1; i <= 50; ++i)
+    {
+      this->Step(10.0 * i, this->PositionAt(0.0), this->RotationAroundZ(angularVelocity * 0.01 * i));
+    }
+    mitk::Quaternion expected = this->RotationAroundZ(angularVelocity * 0.6);
+    mitk::Quaternion output = m_Filter->GetOutput()->GetOrientation();
+    for (unsigned int j = 0; j < 4; ++j)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[j], output[j], 1e-6);
+    }
+  }
+
+  void TestInvalidInputResetsFilter()
+  {
+    m_Filter->SetPredictionTime(50.0);
+    for (unsigned int i = 1; i <= 20; ++i)
+    {
+      this->Step(10.0 * i, this->PositionAt(1.0 * i), this->RotationAroundZ(0.0));
+    }
+    m_Input->SetDataValid(false);
+    m_Input->SetIGTTimeStamp(210.0);
+    m_Filter->Update();
+    CPPUNIT_ASSERT(!m_Filter->GetOutput()->IsDataValid());
+
+    // after the tool reappeared, the filter starts over without a velocity
+    this->Step(1000.0, this->PositionAt(-20.0), this->RotationAroundZ(0.0));
+    CPPUNIT_ASSERT(m_Filter->GetOutput()->IsDataValid());
+    CPPUNIT_ASSERT(mitk::Equal(m_Filter->GetOutput()->GetPosition(), this->PositionAt(-20.0), 1e-6));
+  }
+
+  void TestMeasuredLatency()
+  {
+    mitk::NavigationDataLatencyMonitor* monitor = mitk::NavigationDataLatencyMonitor::GetInstance();
+    monitor->SetHistogram(1.0, 100);
+    monitor->SetEnabled(true);
+
+    m_Filter->SetPredictionTime(10.0);
+    m_Filter->UseMeasuredLatencyOn();
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Fixed prediction time is used until a latency is measured", 10.0, m_Filter->GetCurrentPredictionTime(), mitk::eps);
+
+    for (unsigned int i = 0; i < 10; ++i)
+    {
+      monitor->RecordLatency("Render", 39.5);
+    }
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(40.0, m_Filter->GetCurrentPredictionTime(), mitk::eps);
+
+    monitor->SetEnabled(false);
+    monitor->Reset();
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkNavigationDataPredictionFilter)
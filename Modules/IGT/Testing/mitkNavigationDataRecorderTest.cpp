@@ -22,6 +22,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkTestFixture.h>
 #include <mitkIOUtil.h>
 
+#include <cstdio>
+
 //for exceptions
 #include "mitkIGTException.h"
 #include "mitkIGTIOException.h"
@@ -32,6 +34,7 @@ class mitkNavigationDataRecorderTestSuite : public mitk::TestFixture
   MITK_TEST(TestRecording);
   MITK_TEST(TestStopRecording);
   MITK_TEST(TestLimiting);
+  MITK_TEST(TestStreaming);
 
   CPPUNIT_TEST_SUITE_END();
 
@@ -117,6 +120,46 @@ public:
     MITK_TEST_CONDITION_REQUIRED(m_Recorder->GetNavigationDataSet()->Size() == 30, "Test if SetRecordCountLimit works as intended.");
   }
 
+  void TestStreaming()
+  {
+    // record into a file with a buffer that is smaller than the recording, stop and resume once
+    std::string fileName = mitk::IOUtil::CreateTemporaryFile("navigationdatarecorder-XXXXXX.ndb");
+    m_Recorder->SetStreamingFileName(fileName);
+    m_Recorder->SetStreamingBufferSize(8);
+    m_Recorder->SetStreamingFlushInterval(1);
+
+    m_Recorder->StartRecording();
+    for (int i = 0; i < 5; i++)
+    {
+      m_Recorder->Update();
+      m_Player->GoToNextSnapshot();
+    }
+    m_Recorder->StopRecording();
+    m_Recorder->StartRecording();
+    while (!m_Player->IsAtEnd())
+    {
+      m_Recorder->Update();
+      m_Player->GoToNextSnapshot();
+    }
+    m_Recorder->StopRecording();
+
+    unsigned long dropped = m_Recorder->GetNumberOfDroppedSteps();
+    CPPUNIT_ASSERT_MESSAGE("Test if streaming does not store the data in memory", m_Recorder->GetNavigationDataSet()->Size() == 0);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Test if all steps are counted", static_cast<unsigned long>(m_NavigationDataSet->Size()),
+      m_Recorder->GetNumberOfRecordedSteps() + dropped);
+
+    mitk::NavigationDataSet::Pointer recordedData = mitk::IOUtil::Load<mitk::NavigationDataSet>(fileName);
+    std::remove(fileName.c_str());
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Test if the file contains all recorded steps",
+      static_cast<unsigned int>(m_Recorder->GetNumberOfRecordedSteps()), recordedData->Size());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Test if the file contains all tools", m_NavigationDataSet->GetNumberOfTools(), recordedData->GetNumberOfTools());
+    if (dropped == 0)
+    {
+      CPPUNIT_ASSERT_MESSAGE("Test streamed dataset for equality with reference", compareDataSet(recordedData));
+    }
+  }
+
 private:
 
   /*
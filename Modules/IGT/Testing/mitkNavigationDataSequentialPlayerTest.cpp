@@ -34,6 +34,7 @@ class mitkNavigationDataSequentialPlayerTestSuite : public mitk::TestFixture
   MITK_TEST(TestRestartWithNewNavigationDataSet);
   MITK_TEST(TestGoToSnapshotException);
   MITK_TEST(TestDoubleUpdate);
+  MITK_TEST(TestGoToTimeStamp);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -171,5 +172,27 @@ public:
 
     MITK_TEST_CONDITION(nd1Orientation.as_vector() != nd3Orientation.as_vector(), "Output must be different if GoToNextSnapshot() was called between.");
   }
+
+  void TestGoToTimeStamp()
+  {
+    player->SetNavigationDataSet(NavigationDataSet);
+
+    const mitk::NavigationData::TimeStampType timeStamp1 = NavigationDataSet->GetIGTTimeStampForIndex(1, 0);
+    const mitk::NavigationData::TimeStampType timeStamp2 = NavigationDataSet->GetIGTTimeStampForIndex(2, 0);
+
+    player->GoToTimeStamp(timeStamp2);
+    MITK_TEST_CONDITION(player->GetCurrentSnapshotNumber() == 2, "Going to the time stamp of a snapshot.");
+
+    player->GoToTimeStamp(0.5 * (timeStamp1 + timeStamp2));
+    MITK_TEST_CONDITION(player->GetCurrentSnapshotNumber() == 1, "Going back to a time stamp between snapshots.");
+    MITK_TEST_CONDITION(mitk::Equal(*player->GetOutput(0), *NavigationDataSet->GetNavigationDataForIndex(1, 0)),
+      "Without interpolation the earlier snapshot is used.");
+
+    player->SetInterpolation(true);
+    player->GoToTimeStamp(0.5 * (timeStamp1 + timeStamp2));
+    mitk::NavigationData::Pointer expected = mitk::NavigationData::New();
+    NavigationDataSet->GetInterpolatedNavigationData(0.5 * (timeStamp1 + timeStamp2), 0, expected);
+    MITK_TEST_CONDITION(mitk::Equal(*player->GetOutput(0), *expected), "With interpolation the output is interpolated between the snapshots.");
+  }
 };
 MITK_TEST_SUITE_REGISTRATION(mitkNavigationDataSequentialPlayer)
@@ -0,0 +1,150 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+//testing headers
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <mitkNavigationData.h>
+#include <mitkNavigationDataSet.h>
+#include <mitkIOUtil.h>
+
+#include <cstdio>
+#include <fstream>
+
+class mitkNavigationDataSetReaderWriterBinaryTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkNavigationDataSetReaderWriterBinaryTestSuite);
+  MITK_TEST(TestReadWriteConstantCovariance);
+  MITK_TEST(TestReadWriteChangingCovariance);
+  MITK_TEST(TestIncompleteTimeStepIsIgnored);
+  MITK_TEST(TestMemoryMappedRead);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  std::string m_FileName;
+
+  mitk::NavigationDataSet::Pointer CreateSet(bool changingCovariance)
+  {
+    mitk::NavigationDataSet::Pointer set = mitk::NavigationDataSet::New(2);
+
+    for (unsigned int i = 0; i < 10; i++)
+    {
+      std::vector<mitk::NavigationData::Pointer> timeStep;
+      for (unsigned int tool = 0; tool < 2; tool++)
+      {
+        mitk::NavigationData::Pointer nd = mitk::NavigationData::New();
+        nd->SetName(tool == 0 ? "Pointer" : "Reference");
+        nd->SetIGTTimeStamp(100.0 + i * 10.0 + tool);
+
+        mitk::NavigationData::PositionType position;
+        mitk::FillVector3D(position, i * 1.5, tool - 2.0, i * tool * 0.25);
+        nd->SetPosition(position);
+        nd->SetOrientation(mitk::NavigationData::OrientationType(0.0, 0.6, 0.0, 0.8));
+        nd->SetDataValid(i % 3 != 0);
+        nd->SetHasPosition(true);
+        nd->SetHasOrientation(tool == 0);
+        nd->SetPositionAccuracy(changingCovariance ? 0.1 * (i + 1) : 0.3);
+
+        timeStep.push_back(nd);
+      }
+      CPPUNIT_ASSERT(set->AddNavigationDatas(timeStep));
+    }
+
+    return set;
+  }
+
+  void CompareSets(mitk::NavigationDataSet::Pointer expected, mitk::NavigationDataSet::Pointer actual)
+  {
+    CPPUNIT_ASSERT_MESSAGE("Testing whether something was read at all", actual.IsNotNull());
+    CPPUNIT_ASSERT_EQUAL(expected->GetNumberOfTools(), actual->GetNumberOfTools());
+    CPPUNIT_ASSERT_EQUAL(expected->Size(), actual->Size());
+
+    for (unsigned int i = 0; i < expected->Size(); i++)
+    {
+      for (unsigned int tool = 0; tool < expected->GetNumberOfTools(); tool++)
+      {
+        mitk::NavigationData::Pointer reference = expected->GetNavigationDataForIndex(i, tool);
+        mitk::NavigationData::Pointer read = actual->GetNavigationDataForIndex(i, tool);
+        CPPUNIT_ASSERT_MESSAGE("Read navigation data equals written one", mitk::Equal(*reference, *read, mitk::eps, true));
+      }
+    }
+  }
+
+public:
+
+  void setUp() override
+  {
+    m_FileName = mitk::IOUtil::CreateTemporaryFile("navigationdataset-XXXXXX.ndb");
+  }
+
+  void tearDown() override
+  {
+    std::remove(m_FileName.c_str());
+  }
+
+  void TestReadWriteConstantCovariance()
+  {
+    mitk::NavigationDataSet::Pointer set = this->CreateSet(false);
+    mitk::IOUtil::Save(set, m_FileName);
+    this->CompareSets(set, mitk::IOUtil::Load<mitk::NavigationDataSet>(m_FileName));
+  }
+
+  void TestReadWriteChangingCovariance()
+  {
+    mitk::NavigationDataSet::Pointer set = this->CreateSet(true);
+    mitk::IOUtil::Save(set, m_FileName);
+    this->CompareSets(set, mitk::IOUtil::Load<mitk::NavigationDataSet>(m_FileName));
+  }
+
+  void TestIncompleteTimeStepIsIgnored()
+  {
+    mitk::NavigationDataSet::Pointer set = this->CreateSet(false);
+    mitk::IOUtil::Save(set, m_FileName);
+
+    // simulate a recording that was interrupted while appending a time step
+    {
+      std::ofstream file(m_FileName.c_str(), std::ios::out | std::ios::binary | std::ios::app);
+      const char partialRecord[20] = { 0 };
+      file.write(partialRecord, sizeof(partialRecord));
+    }
+
+    this->CompareSets(set, mitk::IOUtil::Load<mitk::NavigationDataSet>(m_FileName));
+  }
+
+  void TestMemoryMappedRead()
+  {
+    mitk::NavigationDataSet::Pointer set = this->CreateSet(true);
+    mitk::IOUtil::Save(set, m_FileName);
+
+    mitk::NavigationDataSet::Pointer mapped = mitk::NavigationDataSet::MapBinaryFile(m_FileName);
+    CPPUNIT_ASSERT_MESSAGE("Set is memory mapped", mapped->IsMemoryMapped());
+    this->CompareSets(set, mapped);
+    CPPUNIT_ASSERT_EQUAL(set->GetIndexForIGTTimeStamp(145.0, 1), mapped->GetIndexForIGTTimeStamp(145.0, 1));
+    CPPUNIT_ASSERT_MESSAGE("Mapped sets are read only", !mapped->AddNavigationDatas(set->GetTimeStep(0)));
+
+    // a mapped set can be written again
+    std::string copyFileName = mitk::IOUtil::CreateTemporaryFile("navigationdataset-copy-XXXXXX.ndb");
+    mitk::IOUtil::Save(mapped, copyFileName);
+    mapped = nullptr;
+    mitk::NavigationDataSet::Pointer copy = mitk::IOUtil::Load<mitk::NavigationDataSet>(copyFileName);
+    std::remove(copyFileName.c_str());
+    this->CompareSets(set, copy);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkNavigationDataSetReaderWriterBinary)
@@ -18,6 +18,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkNavigationData.h"
 #include "mitkNavigationDataSet.h"
 
+#include <cmath>
+
 static void TestEmptySet()
 {
   mitk::NavigationDataSet::Pointer navigationDataSet = mitk::NavigationDataSet::New(1);
@@ -41,6 +43,15 @@ static void TestSetAndGet()
   mitk::NavigationData::Pointer nd23 = mitk::NavigationData::New();
   nd22->SetIGTTimeStamp(1);
 
+  mitk::NavigationData::PositionType position;
+  mitk::FillVector3D(position, 1.0, 2.0, 3.0);
+  nd21->SetPosition(position);
+  nd21->SetPositionAccuracy(0.5);
+  mitk::FillVector3D(position, -4.0, 5.0, 6.5);
+  nd22->SetPosition(position);
+  nd22->SetOrientation(mitk::NavigationData::OrientationType(0.0, 1.0, 0.0, 0.0));
+  nd22->SetDataValid(false);
+
   // First set, Timestamp = 0
   std::vector<mitk::NavigationData::Pointer> step1;
   step1.push_back(nd11);
@@ -63,22 +74,72 @@ static void TestSetAndGet()
   MITK_TEST_CONDITION_REQUIRED(!(navigationDataSet->AddNavigationDatas(step3)),
     "Adding an invalid third set, should be unsusuccessful.");
 
-  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetNavigationDataForIndex(0, 0) == nd11,
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*navigationDataSet->GetNavigationDataForIndex(0, 0), *nd11),
     "First NavigationData object for tool 0 should be the same as added previously.");
-  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetNavigationDataForIndex(0, 1) == nd21,
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*navigationDataSet->GetNavigationDataForIndex(0, 1), *nd21),
     "Second NavigationData object for tool 0 should be the same as added previously.");
-  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetNavigationDataForIndex(1, 0) == nd12,
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*navigationDataSet->GetNavigationDataForIndex(1, 0), *nd12),
     "First NavigationData object for tool 0 should be the same as added previously.");
-  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetNavigationDataForIndex(1, 1) == nd22,
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*navigationDataSet->GetNavigationDataForIndex(1, 1), *nd22),
     "Second NavigationData object for tool 0 should be the same as added previously.");
 
   std::vector<mitk::NavigationData::Pointer> result = navigationDataSet->GetTimeStep(1);
-  MITK_TEST_CONDITION_REQUIRED(nd12 == result[0],"Comparing returned datas from GetTimeStep().");
-  MITK_TEST_CONDITION_REQUIRED(nd22 == result[1],"Comparing returned datas from GetTimeStep().");
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*nd12, *result[0]),"Comparing returned datas from GetTimeStep().");
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*nd22, *result[1]),"Comparing returned datas from GetTimeStep().");
 
   result = navigationDataSet->GetDataStreamForTool(1);
-  MITK_TEST_CONDITION_REQUIRED(nd21 == result[0],"Comparing returned datas from GetStreamForTool().");
-  MITK_TEST_CONDITION_REQUIRED(nd22 == result[1],"Comparing returned datas from GetStreamForTool().");
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*nd21, *result[0]),"Comparing returned datas from GetStreamForTool().");
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*nd22, *result[1]),"Comparing returned datas from GetStreamForTool().");
+
+  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetIGTTimeStampForIndex(1, 1) == nd22->GetIGTTimeStamp(),
+    "Time stamp is accessible without creating NavigationData objects.");
+  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->End() - navigationDataSet->Begin() == 2, "Iterating over time steps.");
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*((navigationDataSet->Begin() + 1)->at(1)), *nd22), "Dereferencing iterators.");
+}
+
+static void TestTimeStampSearchAndInterpolation()
+{
+  mitk::NavigationDataSet::Pointer navigationDataSet = mitk::NavigationDataSet::New(1);
+
+  // rotation of 0 and 90 degrees around z at time stamps 10, 20 and 30
+  const double s = std::sqrt(0.5);
+  for (unsigned int i = 0; i < 3; i++)
+  {
+    mitk::NavigationData::Pointer nd = mitk::NavigationData::New();
+    nd->SetIGTTimeStamp(10.0 * (i + 1));
+    mitk::NavigationData::PositionType position;
+    mitk::FillVector3D(position, 10.0 * i, 0.0, -2.0 * i);
+    nd->SetPosition(position);
+    nd->SetOrientation(i == 1 ? mitk::NavigationData::OrientationType(0.0, 0.0, s, s) : mitk::NavigationData::OrientationType(0.0, 0.0, 0.0, 1.0));
+    nd->SetDataValid(true);
+    std::vector<mitk::NavigationData::Pointer> step;
+    step.push_back(nd);
+    navigationDataSet->AddNavigationDatas(step);
+  }
+
+  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetIndexForIGTTimeStamp(5.0, 0) == 0, "Time stamp before the first time step.");
+  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetIndexForIGTTimeStamp(20.0, 0) == 1, "Time stamp of a time step.");
+  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetIndexForIGTTimeStamp(29.9, 0) == 1, "Time stamp between time steps.");
+  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetIndexForIGTTimeStamp(100.0, 0) == 2, "Time stamp after the last time step.");
+
+  mitk::NavigationData::Pointer interpolated = mitk::NavigationData::New();
+  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetInterpolatedNavigationData(15.0, 0, interpolated), "Interpolating between time steps.");
+  MITK_TEST_CONDITION(mitk::Equal(interpolated->GetPosition()[0], 5.0) && mitk::Equal(interpolated->GetPosition()[2], -1.0), "Position is interpolated linearly.");
+
+  // half way between 0 and 90 degrees is a rotation of 45 degrees
+  const double angle = std::atan(1.0);
+  mitk::NavigationData::OrientationType expected(0.0, 0.0, std::sin(0.5 * angle), std::cos(0.5 * angle));
+  bool orientationEqual = true;
+  for (unsigned int j = 0; j < 4; j++)
+  {
+    orientationEqual = orientationEqual && mitk::Equal(interpolated->GetOrientation()[j], expected[j], 1e-6);
+  }
+  MITK_TEST_CONDITION(orientationEqual, "Orientation is interpolated spherically.");
+  MITK_TEST_CONDITION(interpolated->GetIGTTimeStamp() == 15.0, "Interpolated time stamp.");
+
+  MITK_TEST_CONDITION_REQUIRED(navigationDataSet->GetInterpolatedNavigationData(50.0, 0, interpolated), "Interpolating after the last time step.");
+  MITK_TEST_CONDITION(mitk::Equal(*interpolated, *navigationDataSet->GetNavigationDataForIndex(2, 0)), "Time stamps after the recording are clamped.");
+  MITK_TEST_CONDITION(!navigationDataSet->GetInterpolatedNavigationData(15.0, 1, interpolated), "Interpolating an invalid tool fails.");
 }
 
 /**
@@ -90,6 +151,7 @@ int mitkNavigationDataSetTest(int /* argc */, char* /*argv*/[])
 
   TestEmptySet();
   TestSetAndGet();
+  TestTimeStampSearchAndInterpolation();
 
   MITK_TEST_END();
 }
\ No newline at end of file
@@ -109,6 +109,19 @@ int mitkTrackingDeviceSourceTest(int /* argc */, char* /*argv*/[])
     MITK_TEST_CONDITION(mitk::Equal(newPos, pos) == false, "Testing if output changes on each update");
   }
 
+  //test updates from the tool state snapshots of the tracking thread
+  MITK_TEST_CONDITION(mySource->WaitForNewFrame(1000) == false, "Testing WaitForNewFrame() without snapshots");
+  mySource->UseToolStateSnapshotsOn();
+  MITK_TEST_CONDITION_REQUIRED(mySource->WaitForNewFrame(1000), "Testing WaitForNewFrame()");
+  MITK_TEST_CONDITION(tracker->GetNumberOfPublishedFrames() > 0, "Testing if the tracking thread publishes frames");
+  nd0->Modified();
+  nd0->Update();
+  MITK_TEST_CONDITION(nd0->IsDataValid() && nd0->GetIGTTimeStamp() > 0, "Testing output from tool state snapshot");
+  MITK_TEST_CONDITION(mySource->WaitForNewFrame(1000), "Testing WaitForNewFrame() after the frame was used");
+  mitk::TrackingDevice::ToolStateVector states;
+  unsigned long frameNumber = 0;
+  MITK_TEST_CONDITION(tracker->GetLatestToolStates(states, frameNumber) && states.size() == 2 && frameNumber > 0, "Testing GetLatestToolStates()");
+
   mySource->StopTracking();
   mySource->Disconnect();
 
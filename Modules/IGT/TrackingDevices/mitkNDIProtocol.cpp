@@ -26,7 +26,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <cstdio>
 
 mitk::NDIProtocol::NDIProtocol()
-: itk::Object(), m_TrackingDevice(nullptr), m_UseCRC(true)
+: itk::Object(), m_TrackingDevice(nullptr), m_UseCRC(true), m_PipelineTX(false), m_TXRequestPending(false)
 {
 }
 
@@ -36,6 +36,18 @@ mitk::NDIProtocol::~NDIProtocol()
 }
 
 
+void mitk::NDIProtocol::DiscardPendingTX()
+{
+  if (!m_TXRequestPending)
+    return;
+  m_TXRequestPending = false;
+  if (m_TrackingDevice == nullptr)
+    return;
+  m_TrackingDevice->ReceiveReplyIntoBuffer(); // the current reply was read completely, so the next CR terminates the pending one
+  m_TrackingDevice->ClearReceiveBuffer();
+}
+
+
 mitk::NDIErrorCode mitk::NDIProtocol::COMM(mitk::SerialCommunication::BaudRate baudRate , mitk::SerialCommunication::DataBits dataBits, mitk::SerialCommunication::Parity parity, mitk::SerialCommunication::StopBits stopBits, mitk::SerialCommunication::HardwareHandshake hardwareHandshake)
 {
   /* Build parameter string */
@@ -677,12 +689,24 @@ mitk::NDIErrorCode mitk::NDIProtocol::TX(bool trackIndividualMarkers, MarkerPoin
       fullcommand = "TX ";          // command string format 2: without crc
   }
 
-  returnValue = m_TrackingDevice->Send(&fullcommand, m_UseCRC);
-  if (returnValue != NDIOKAY)
+  const bool pipelined = m_PipelineTX && !trackIndividualMarkers;
+  if (!(pipelined && m_TXRequestPending))      // otherwise the request was already sent by the last call
   {
-    /* cleanup and return */
-    m_TrackingDevice->ClearReceiveBuffer();   // flush the buffer to remove the remaining carriage return or unknown/unexpected reply
-    return returnValue;
+    this->DiscardPendingTX();
+    returnValue = m_TrackingDevice->Send(&fullcommand, m_UseCRC);
+    if (returnValue != NDIOKAY)
+    {
+      /* cleanup and return */
+      m_TrackingDevice->ClearReceiveBuffer();   // flush the buffer to remove the remaining carriage return or unknown/unexpected reply
+      return returnValue;
+    }
+  }
+  m_TXRequestPending = false;
+  if (pipelined && m_TrackingDevice->ReceiveReplyIntoBuffer() == NDIOKAY)
+  {
+    /* the complete reply is buffered now, request the next frame while this one is parsed */
+    if (m_TrackingDevice->Send(&fullcommand, m_UseCRC) == NDIOKAY)
+      m_TXRequestPending = true;
   }
   /* read number of handles returned */
   std::string reply;
@@ -919,7 +943,18 @@ mitk::NDIErrorCode mitk::NDIProtocol::TX(bool trackIndividualMarkers, MarkerPoin
 
   /* cleanup and return */
   m_TrackingDevice->Receive(&s, 1);         // read the last linde feed (because the tracking system device is sometimes to slow to send it before we clear the buffer. In this case, the LF would remain in the receive buffer and be read as the first character of the next command
-  m_TrackingDevice->ClearReceiveBuffer();   // flush the buffer to remove the remaining carriage return or unknown/unexpected reply
+  if (!m_TXRequestPending)
+  {
+    m_TrackingDevice->ClearReceiveBuffer();   // flush the buffer to remove the remaining carriage return or unknown/unexpected reply
+  }
+  else if (s.empty() || s.at(0) != '\r')
+  {
+    /* the reply was not read up to its end, so the position of the pending reply is unknown. Drop both and start over */
+    m_TXRequestPending = false;
+    m_TrackingDevice->ClearReceiveBuffer();
+    m_TrackingDevice->ReceiveReplyIntoBuffer();
+    m_TrackingDevice->ClearReceiveBuffer();
+  }
   return returnValue;
 }
 
@@ -137,6 +137,22 @@ namespace mitk
     itkGetConstMacro(UseCRC, bool); ///< Get whether to append a CRC16 checksum to each message
     itkSetMacro(UseCRC, bool);      ///< Set whether to append a CRC16 checksum to each message
     itkBooleanMacro(UseCRC);        ///< Set whether to append a CRC16 checksum to each message
+
+    /**
+    * \brief If true, TX() requests the next frame as soon as the reply to the current one is completely received.
+    *
+    * The tracking device then prepares the next frame while the current reply is parsed, so the round trip of the
+    * request does not limit the update rate. Requires buffered serial communication (see
+    * NDITrackingDevice::SetBufferedSerialCommunication()) and is only used for TX without marker data.
+    * DiscardPendingTX() has to be called before any other command is sent.
+    */
+    itkSetMacro(PipelineTX, bool);
+    itkGetConstMacro(PipelineTX, bool);
+
+    /**
+    * \brief Receives and drops the reply to a TX request that was sent in advance (see SetPipelineTX()).
+    */
+    void DiscardPendingTX();
   protected:
     NDIProtocol();
     ~NDIProtocol() override;
@@ -162,6 +178,8 @@ namespace mitk
 
     NDITrackingDevice* m_TrackingDevice;  ///< tracking device to which the commands will be send
     bool m_UseCRC;  ///< whether to append a CRC16 checksum to each message
+    bool m_PipelineTX;       ///< whether to request the next frame before the current reply is parsed
+    bool m_TXRequestPending; ///< a TX request was sent, but its reply was not read yet
   };
 } // namespace mitk
 #endif /* MITKNDIPROTOCOL_H_HEADER_INCLUDED_ */
@@ -39,7 +39,8 @@ mitk::NDITrackingDevice::NDITrackingDevice() :
 TrackingDevice(), m_DeviceName(""), m_PortNumber(mitk::SerialCommunication::COM5), m_BaudRate(mitk::SerialCommunication::BaudRate9600),
 m_DataBits(mitk::SerialCommunication::DataBits8), m_Parity(mitk::SerialCommunication::None), m_StopBits(mitk::SerialCommunication::StopBits1),
 m_HardwareHandshake(mitk::SerialCommunication::HardwareHandshakeOff),
-m_IlluminationActivationRate(Hz20), m_DataTransferMode(TX), m_6DTools(), m_ToolsMutex(nullptr),
+m_IlluminationActivationRate(Hz20), m_DataTransferMode(TX), m_BufferedSerialCommunication(false),
+m_PipelinedDataTransfer(false), m_6DTools(), m_ToolsMutex(nullptr),
 m_SerialCommunication(nullptr), m_SerialCommunicationMutex(nullptr), m_DeviceProtocol(nullptr),
 m_MultiThreader(nullptr), m_ThreadID(0), m_OperationMode(ToolTracking6D), m_MarkerPointsMutex(nullptr), m_MarkerPoints()
 {
@@ -305,6 +306,14 @@ mitk::NDIErrorCode mitk::NDITrackingDevice::ReceiveLine(std::string* answer)
   return NDIOKAY;
 }
 
+mitk::NDIErrorCode mitk::NDITrackingDevice::ReceiveReplyIntoBuffer()
+{
+  MutexLockHolder lock(*m_SerialCommunicationMutex); // lock and unlock the mutex
+  if (m_SerialCommunication->ReceiveIntoBuffer(CR) == 0)
+    return SERIALRECEIVEERROR;
+  return NDIOKAY;
+}
+
 void mitk::NDITrackingDevice::ClearSendBuffer()
 {
   MutexLockHolder lock(*m_SerialCommunicationMutex); // lock and unlock the mutex
@@ -368,6 +377,7 @@ bool mitk::NDITrackingDevice::OpenConnection()
   m_SerialCommunication->SetStopBits(mitk::SerialCommunication::StopBits1);
   m_SerialCommunication->SetSendTimeout(5000);
   m_SerialCommunication->SetReceiveTimeout(5000);
+  m_SerialCommunication->SetBufferedReceive(m_BufferedSerialCommunication || m_PipelinedDataTransfer);
   if (m_SerialCommunication->OpenConnection() == 0) // 0 == ERROR_VALUE
   {
     m_SerialCommunication->CloseConnection();
@@ -701,6 +711,7 @@ ITK_THREAD_RETURN_TYPE mitk::NDITrackingDevice::ThreadStartTracking(void* pInfoS
   NDITrackingDevice *trackingDevice = (NDITrackingDevice*)pInfo->UserData;
   if (trackingDevice != nullptr)
   {
+    trackingDevice->ConfigureTrackingThread();
     if (trackingDevice->GetOperationMode() == ToolTracking6D)
       trackingDevice->TrackTools();             // call TrackTools() from the original object
     else if (trackingDevice->GetOperationMode() == MarkerTracking3D)
@@ -748,6 +759,7 @@ void mitk::NDITrackingDevice::TrackTools()
   this->m_StopTrackingMutex->Lock();  // update the local copy of m_StopTracking
   localStopTracking = this->m_StopTracking;
   this->m_StopTrackingMutex->Unlock();
+  m_DeviceProtocol->SetPipelineTX(m_PipelinedDataTransfer && m_SerialCommunication->GetBufferedReceive());
   while ((this->GetState() == Tracking) && (localStopTracking == false))
   {
     if (this->m_DataTransferMode == TX)
@@ -762,12 +774,15 @@ void mitk::NDITrackingDevice::TrackTools()
       if (returnvalue != NDIOKAY)
         break;
     }
+    this->PublishToolStates();
     /* Update the local copy of m_StopTracking */
     this->m_StopTrackingMutex->Lock();
     localStopTracking = m_StopTracking;
     this->m_StopTrackingMutex->Unlock();
   }
   /* StopTracking was called, thus the mode should be changed back to Ready now that the tracking loop has ended. */
+  m_DeviceProtocol->DiscardPendingTX(); // the reply to a pipelined request must not be mistaken for the reply to TSTOP
+  m_DeviceProtocol->SetPipelineTX(false);
 
   returnvalue = m_DeviceProtocol->TSTOP();
   if (returnvalue != NDIOKAY)
@@ -848,6 +863,10 @@ void mitk::NDITrackingDevice::TrackToolsAndMarkers()
     {
       std::cout << "Error in TX: could not read data. Possibly no markers present." << std::endl;
     }
+    else
+    {
+      this->PublishToolStates();
+    }
     /* Update the local copy of m_StopTracking */
     this->m_StopTrackingMutex->Lock();
     localStopTracking = m_StopTracking;
@@ -1063,108 +1082,108 @@ bool mitk::NDITrackingDevice::DiscoverWiredTools()
   /* First, check for disconnected tools and remove them */
   this->FreePortHandles();
 
-  //NDI handling (PHSR 02, PINIT, PHSR 02, PHSR 00) => all initialized and all handles available
-  //creation of MITK tools
-  //NDI enable all tools (PENA)
-  //NDI get all serial numbers (PHINF)
-
-  /** 
-  NDI handling (PHSR 02, PINIT, PHSR 02, PHSR 00) => all initialized and all handles available
-  **/
-
-  /* check for occupied port handles on channel 0 */
+  //NDI handling (PHSR 02, PINIT, PHSR 02, PHSR 00) => all initialized and all handles available
+  //creation of MITK tools
+  //NDI enable all tools (PENA)
+  //NDI get all serial numbers (PHINF)
+
+  /** 
+  NDI handling (PHSR 02, PINIT, PHSR 02, PHSR 00) => all initialized and all handles available
+  **/
+
+  /* check for occupied port handles on channel 0 */
   std::string portHandle;
-  NDIErrorCode returnvalue = m_DeviceProtocol->PHSR(OCCUPIED, &portHandle);
-
-  if (returnvalue != NDIOKAY)
-  {
-	  mitkThrowException(mitk::IGTHardwareException) << "Could not obtain a list of port handles that are connected on channel 0.";
-  }
-
-  /* Initialize all port handles on channel 0 */
-  for (unsigned int i = 0; i < portHandle.size(); i += 2)
-  {
-     std::string ph = portHandle.substr(i, 2);
-     returnvalue = m_DeviceProtocol->PINIT(&ph);
-
-     if (returnvalue != NDIOKAY)
-     {
-        mitkThrowException(mitk::IGTHardwareException) << (std::string("Could not initialize port '") + ph + std::string("."));
-     }
-  }
-
-  /* check for occupied port handles on channel 1 (initialize automatically, portHandle is empty although additional tools were detected) */
-  //For a split port on a dual 5DOF tool, the first PHSR sent will report only one port handle. After the port handle is
-  //initialized, it is assigned to channel 0. You must then use PHSR again to assign a port handle to channel 1. The
-  //port handle for channel 1 is initialized automatically.
+  NDIErrorCode returnvalue = m_DeviceProtocol->PHSR(OCCUPIED, &portHandle);
+
+  if (returnvalue != NDIOKAY)
+  {
+	  mitkThrowException(mitk::IGTHardwareException) << "Could not obtain a list of port handles that are connected on channel 0.";
+  }
+
+  /* Initialize all port handles on channel 0 */
+  for (unsigned int i = 0; i < portHandle.size(); i += 2)
+  {
+     std::string ph = portHandle.substr(i, 2);
+     returnvalue = m_DeviceProtocol->PINIT(&ph);
+
+     if (returnvalue != NDIOKAY)
+     {
+        mitkThrowException(mitk::IGTHardwareException) << (std::string("Could not initialize port '") + ph + std::string("."));
+     }
+  }
+
+  /* check for occupied port handles on channel 1 (initialize automatically, portHandle is empty although additional tools were detected) */
+  //For a split port on a dual 5DOF tool, the first PHSR sent will report only one port handle. After the port handle is
+  //initialized, it is assigned to channel 0. You must then use PHSR again to assign a port handle to channel 1. The
+  //port handle for channel 1 is initialized automatically.
   returnvalue = m_DeviceProtocol->PHSR(OCCUPIED, &portHandle);
 
   if (returnvalue != NDIOKAY)
   {
-     mitkThrowException(mitk::IGTHardwareException) << "Could not obtain a list of port handles that are connected on channel 1.";
+     mitkThrowException(mitk::IGTHardwareException) << "Could not obtain a list of port handles that are connected on channel 1.";
   }
 
-  /* read all port handles */
-  returnvalue = m_DeviceProtocol->PHSR(ALL, &portHandle);
+  /* read all port handles */
+  returnvalue = m_DeviceProtocol->PHSR(ALL, &portHandle);
+
+  if (returnvalue != NDIOKAY)
+  {
+     mitkThrowException(mitk::IGTHardwareException) << "Could not obtain a list of port handles that are connected on all channels.";
+  }
 
-  if (returnvalue != NDIOKAY)
-  {
-     mitkThrowException(mitk::IGTHardwareException) << "Could not obtain a list of port handles that are connected on all channels.";
-  }
-
-  /**
-  1. Create MITK tracking tool representations of NDI tools
-  2. NDI enable all tools (PENA)
-  **/
+  /**
+  1. Create MITK tracking tool representations of NDI tools
+  2. NDI enable all tools (PENA)
+  **/
 
   for (unsigned int i = 0; i < portHandle.size(); i += 2)
   {
-     std::string ph = portHandle.substr(i, 2);
-     if (this->GetInternalTool(ph) != nullptr) // if we already have a tool with this handle
-        continue;                              // then skip the initialization
-
-     //define tracking priority
-     auto trackingPriority = mitk::NDIPassiveTool::Dynamic;
-
-     //instantiate an object for each tool that is connected
-     mitk::NDIPassiveTool::Pointer newTool = mitk::NDIPassiveTool::New();
-     newTool->SetPortHandle(ph.c_str());
-     newTool->SetTrackingPriority(trackingPriority);
-
-     //set a name for identification
-     newTool->SetToolName((std::string("Port ") + ph).c_str());
-
-     /* enable the port handle */
-     returnvalue = m_DeviceProtocol->PENA(&ph, trackingPriority); // Enable tool
-
-     if (returnvalue != NDIOKAY)
-     {
+     std::string ph = portHandle.substr(i, 2);
+     if (this->GetInternalTool(ph) != nullptr) // if we already have a tool with this handle
+        continue;                              // then skip the initialization
+
+     //define tracking priority
+     auto trackingPriority = mitk::NDIPassiveTool::Dynamic;
+
+     //instantiate an object for each tool that is connected
+     mitk::NDIPassiveTool::Pointer newTool = mitk::NDIPassiveTool::New();
+     newTool->SetPortHandle(ph.c_str());
+     newTool->SetTrackingPriority(trackingPriority);
+
+     //set a name for identification
+     newTool->SetToolName((std::string("Port ") + ph).c_str());
+
+     /* enable the port handle */
+     returnvalue = m_DeviceProtocol->PENA(&ph, trackingPriority); // Enable tool
+
+     if (returnvalue != NDIOKAY)
+     {
         mitkThrowException(mitk::IGTHardwareException) << (std::string("Could not enable port '") + ph +
-           std::string("' for tool '") + newTool->GetToolName() + std::string("'")).c_str();
-     }
-
-     //we have to temporarily unlock m_ModeMutex here to avoid a deadlock with another lock inside InternalAddTool()
-     if (this->InternalAddTool(newTool) == false)
-     {
-        mitkThrowException(mitk::IGTException) << "Error while adding new tool";
-     }
-  }
-
-  /**
-  NDI get all serial numbers (PHINF)
-  **/
-
+           std::string("' for tool '") + newTool->GetToolName() + std::string("'")).c_str();
+     }
+
+     //we have to temporarily unlock m_ModeMutex here to avoid a deadlock with another lock inside InternalAddTool()
+     if (this->InternalAddTool(newTool) == false)
+     {
+        mitkThrowException(mitk::IGTException) << "Error while adding new tool";
+     }
+  }
+
+  /**
+  NDI get all serial numbers (PHINF)
+  **/
+
   // after initialization readout serial numbers of automatically detected tools
-  for (unsigned int i = 0; i < portHandle.size(); i += 2)
-  {
-     std::string ph = portHandle.substr(i, 2);
-
-     std::string portInfo;
-     NDIErrorCode returnvaluePort = m_DeviceProtocol->PHINF(ph, &portInfo);
-     if ((returnvaluePort == NDIOKAY) && (portInfo.size() > 31))
-        dynamic_cast<mitk::NDIPassiveTool*>(this->GetInternalTool(ph))->SetSerialNumber(portInfo.substr(23, 8));
-     MITK_INFO << "portInfo: " << portInfo;
-     itksys::SystemTools::Delay(10);
+  for (unsigned int i = 0; i < portHandle.size(); i += 2)
+  {
+     std::string ph = portHandle.substr(i, 2);
+
+     std::string portInfo;
+     NDIErrorCode returnvaluePort = m_DeviceProtocol->PHINF(ph, &portInfo);
+     if ((returnvaluePort == NDIOKAY) && (portInfo.size() > 31))
+        dynamic_cast<mitk::NDIPassiveTool*>(this->GetInternalTool(ph))->SetSerialNumber(portInfo.substr(23, 8));
+     MITK_INFO << "portInfo: " << portInfo;
+     itksys::SystemTools::Delay(10);
   }
 
   return true;
@@ -181,6 +181,10 @@ namespace mitk
     itkGetConstMacro(IlluminationActivationRate, IlluminationActivationRate);          ///< returns the activation rate of IR illumator for polaris
     virtual void SetDataTransferMode(const DataTransferMode _arg);    ///< set data transfer mode to text (TX) or binary (BX). \warning: only TX is supportet at the moment
     itkGetConstMacro(DataTransferMode, DataTransferMode);              ///< returns the data transfer mode
+    itkSetMacro(BufferedSerialCommunication, bool);    ///< read replies in chunks into a receive buffer instead of byte by byte. Takes effect with the next OpenConnection(). Default is false
+    itkGetConstMacro(BufferedSerialCommunication, bool); ///< returns whether replies are read into a receive buffer
+    itkSetMacro(PipelinedDataTransfer, bool);          ///< request the next frame while the reply of the last one is parsed during tracking. Implies BufferedSerialCommunication. Takes effect with the next OpenConnection(). Default is false
+    itkGetConstMacro(PipelinedDataTransfer, bool);     ///< returns whether the next frame is requested while the last one is parsed
     virtual bool Beep(unsigned char count);   ///< Beep the tracking device 1 to 9 times
 
     NDIErrorCode GetErrorCode(const std::string* input);  ///< returns the error code for a string that contains an error code in hexadecimal format
@@ -264,6 +268,7 @@ namespace mitk
     NDIErrorCode Receive(std::string* answer, unsigned int numberOfBytes);  ///< receive numberOfBytes bytes from tracking device
     NDIErrorCode ReceiveByte(char* answer);   ///< lightweight receive function, that reads just one byte
     NDIErrorCode ReceiveLine(std::string* answer); ///< receive characters until the first LF (The LF is included in the answer string)
+    NDIErrorCode ReceiveReplyIntoBuffer();    ///< waits until a complete reply (terminated by CR) is in the receive buffer, without consuming it. Requires buffered serial communication
     void ClearSendBuffer();                   ///< empty send buffer of serial communication interface
     void ClearReceiveBuffer();                ///< empty receive buffer of serial communication interface
     const std::string CalcCRC(const std::string* input);  ///< returns the CRC16 for input as a std::string
@@ -317,6 +322,8 @@ public:
     ///< which tracking volume is currently used (if device supports multiple volumes) (\warning This parameter is not used yet)
     IlluminationActivationRate m_IlluminationActivationRate; ///< update rate of IR illuminator for Polaris
     DataTransferMode m_DataTransferMode;  ///< use TX (text) or BX (binary) (\warning currently, only TX mode is supported)
+    bool m_BufferedSerialCommunication;   ///< read replies in chunks into the receive buffer of m_SerialCommunication
+    bool m_PipelinedDataTransfer;         ///< request the next frame before the last reply is parsed
     Tool6DContainerType m_6DTools;        ///< list of 6D tools
 
     itk::FastMutexLock::Pointer m_ToolsMutex; ///< mutex for coordinated access of tool container
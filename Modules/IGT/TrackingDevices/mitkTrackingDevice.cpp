@@ -20,6 +20,18 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <itkMutexLockHolder.h>
 
+#include <chrono>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #include <usModuleContext.h>
 #include <usGetModuleContext.h>
 
@@ -31,6 +43,9 @@ typedef itk::MutexLockHolder<itk::FastMutexLock> MutexLockHolder;
 
 mitk::TrackingDevice::TrackingDevice() :
   m_State(mitk::TrackingDevice::Setup),
+  m_PublishedFrames(0),
+  m_HighPriorityTrackingThread(false),
+  m_TrackingThreadCPUAffinity(-1),
   m_Data(mitk::UnspecifiedTrackingTypeInformation::GetDeviceDataUnspecified()),
   m_StopTracking(false),
   m_RotationMode(mitk::TrackingDevice::RotationStandard)
@@ -137,10 +152,99 @@ bool mitk::TrackingDevice::StopTracking()
     //   to Ready now that the tracking loop has ended.
     this->SetState(Ready);
     m_TrackingFinishedMutex->Unlock();
+    m_ToolStatesPublished.notify_all(); // wake up threads waiting for new frames
+  }
+  return true;
+}
+
+void mitk::TrackingDevice::PublishToolStates()
+{
+  ToolStateSnapshot& snapshot = m_ToolStates.GetWriteBuffer();
+  const unsigned int toolCount = this->GetToolCount();
+  const double now = mitk::IGTTimeStamp::GetInstance()->GetElapsed();
+  snapshot.m_States.resize(toolCount);
+  for (unsigned int i = 0; i < toolCount; ++i)
+  {
+    const mitk::TrackingTool* tool = this->GetTool(i);
+    ToolState& state = snapshot.m_States[i];
+    tool->GetPosition(state.m_Position);
+    tool->GetOrientation(state.m_Orientation);
+    state.m_TrackingError = tool->GetTrackingError();
+    state.m_Enabled = tool->IsEnabled();
+    state.m_DataValid = tool->IsDataValid();
+    state.m_IGTTimeStamp = tool->GetIGTTimeStamp();
+    if (state.m_IGTTimeStamp == 0)
+      state.m_IGTTimeStamp = now;
+  }
+  snapshot.m_FrameNumber = m_PublishedFrames.load(std::memory_order_relaxed) + 1;
+  m_ToolStates.Publish();
+  m_PublishedFrames.store(snapshot.m_FrameNumber, std::memory_order_release);
+
+  // the lock is only held for an instant to make sure that no waiting thread misses the notification
+  {
+    std::lock_guard<std::mutex> lock(m_ToolStatesWaitMutex);
   }
+  m_ToolStatesPublished.notify_all();
+}
+
+bool mitk::TrackingDevice::GetLatestToolStates(ToolStateVector& states, unsigned long& frameNumber)
+{
+  std::lock_guard<std::mutex> lock(m_ToolStatesReaderMutex);
+  m_ToolStates.Acquire();
+  const ToolStateSnapshot& snapshot = m_ToolStates.GetReadBuffer();
+  if (snapshot.m_FrameNumber == 0)
+    return false;
+  states = snapshot.m_States;
+  frameNumber = snapshot.m_FrameNumber;
   return true;
 }
 
+unsigned long mitk::TrackingDevice::GetNumberOfPublishedFrames() const
+{
+  return m_PublishedFrames.load(std::memory_order_acquire);
+}
+
+bool mitk::TrackingDevice::WaitForToolStates(unsigned long frameNumber, unsigned int timeoutMs)
+{
+  std::unique_lock<std::mutex> lock(m_ToolStatesWaitMutex);
+  m_ToolStatesPublished.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this, frameNumber]
+  {
+    return this->GetNumberOfPublishedFrames() > frameNumber || this->GetState() != Tracking;
+  });
+  return this->GetNumberOfPublishedFrames() > frameNumber;
+}
+
+void mitk::TrackingDevice::ConfigureTrackingThread()
+{
+#ifdef _WIN32
+  HANDLE thread = GetCurrentThread();
+  if (m_HighPriorityTrackingThread && !SetThreadPriority(thread, THREAD_PRIORITY_TIME_CRITICAL))
+    MITK_WARN("IGT") << "Could not raise the priority of the tracking thread.";
+  if (m_TrackingThreadCPUAffinity >= 0 && SetThreadAffinityMask(thread, DWORD_PTR(1) << m_TrackingThreadCPUAffinity) == 0)
+    MITK_WARN("IGT") << "Could not bind the tracking thread to CPU " << m_TrackingThreadCPUAffinity << ".";
+#else
+  if (m_HighPriorityTrackingThread)
+  {
+    sched_param parameters;
+    parameters.sched_priority = sched_get_priority_max(SCHED_FIFO);
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters) != 0)
+      MITK_WARN("IGT") << "Could not set a real time priority for the tracking thread. This usually requires special privileges.";
+  }
+  if (m_TrackingThreadCPUAffinity >= 0)
+  {
+#ifdef __linux__
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(m_TrackingThreadCPUAffinity, &cpus);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0)
+      MITK_WARN("IGT") << "Could not bind the tracking thread to CPU " << m_TrackingThreadCPUAffinity << ".";
+#else
+    MITK_WARN("IGT") << "Binding the tracking thread to a CPU is not supported on this platform.";
+#endif
+  }
+#endif
+}
+
 
 mitk::TrackingTool* mitk::TrackingDevice::GetToolByName( std::string name ) const
 {
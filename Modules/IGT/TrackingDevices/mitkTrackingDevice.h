@@ -21,9 +21,16 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <MitkIGTExports.h>
 #include "itkObject.h"
 #include "mitkCommon.h"
+#include "mitkNumericTypes.h"
 #include "mitkTrackingTypes.h"
 #include "itkFastMutexLock.h"
 #include "mitkNavigationToolStorage.h"
+#include "mitkTripleBuffer.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
 
 
 namespace mitk {
@@ -57,6 +64,21 @@ namespace mitk {
       enum RotationMode {RotationStandard, RotationTransposed};
 
       enum TrackingDeviceState {Setup, Ready, Tracking};   ///< Type for state variable. The trackingdevice is always in one of these states
+
+      /**
+       * \brief State of a single tool at the time a frame was acquired
+       */
+      struct ToolState
+      {
+        Point3D m_Position;
+        Quaternion m_Orientation;
+        float m_TrackingError;
+        double m_IGTTimeStamp;
+        bool m_Enabled;
+        bool m_DataValid;
+      };
+      typedef std::vector<ToolState> ToolStateVector;  ///< states of all tools of one frame, in the order of GetTool()
+
       /**
        * \brief Opens a connection to the device
        *
@@ -183,8 +205,56 @@ namespace mitk {
      */
     virtual mitk::NavigationToolStorage::Pointer AutoDetectTools();
 
+    /**
+     * \brief Copies the tool states of the most recent complete frame.
+     *
+     * Devices which support it publish a snapshot of all tools after every frame from their tracking thread
+     * (see PublishToolStates()). Reading the snapshot never blocks the tracking thread and never returns a
+     * frame in which only some of the tools are updated.
+     * \param states receives the tool states
+     * \param frameNumber receives the number of the frame, counting from 1
+     * \return false if the device did not publish a frame yet or does not support snapshots
+     */
+    bool GetLatestToolStates(ToolStateVector& states, unsigned long& frameNumber);
+
+    /** \brief Returns the number of frames published by the tracking thread so far */
+    unsigned long GetNumberOfPublishedFrames() const;
+
+    /**
+     * \brief Blocks until a frame newer than frameNumber is published, tracking stops or the timeout expires.
+     *
+     * This allows a pipeline to be updated with the rate of the device instead of a timer.
+     * \return true if a newer frame is available
+     */
+    bool WaitForToolStates(unsigned long frameNumber, unsigned int timeoutMs);
+
+    /** \brief If true, the tracking thread requests the highest (real time) scheduling priority.
+     *  Has to be set before StartTracking(). Only applied by devices which call ConfigureTrackingThread().
+     *  Default is false. */
+    itkSetMacro(HighPriorityTrackingThread, bool);
+    itkGetConstMacro(HighPriorityTrackingThread, bool);
+
+    /** \brief Index of the CPU the tracking thread is bound to, -1 (default) lets the system decide.
+     *  Has to be set before StartTracking(). Only applied by devices which call ConfigureTrackingThread(). */
+    itkSetMacro(TrackingThreadCPUAffinity, int);
+    itkGetConstMacro(TrackingThreadCPUAffinity, int);
+
     private:
       TrackingDeviceState m_State; ///< current object state (Setup, Ready or Tracking)
+
+      struct ToolStateSnapshot
+      {
+        ToolStateVector m_States;
+        unsigned long m_FrameNumber = 0;
+      };
+      TripleBuffer<ToolStateSnapshot> m_ToolStates; ///< handoff of the tool states from the tracking thread
+      std::atomic<unsigned long> m_PublishedFrames; ///< number of frames published
+      std::mutex m_ToolStatesReaderMutex;           ///< serializes readers of m_ToolStates, never locked by the tracking thread
+      std::mutex m_ToolStatesWaitMutex;
+      std::condition_variable m_ToolStatesPublished;
+      bool m_HighPriorityTrackingThread;
+      int m_TrackingThreadCPUAffinity;
+
     protected:
 
       /**
@@ -192,6 +262,22 @@ namespace mitk {
       */
       void SetState(TrackingDeviceState state);
 
+      /**
+      * \brief Publishes the current state of all tools as one frame, see GetLatestToolStates().
+      *
+      * Has to be called by the tracking thread after all tools were updated with the data of a new frame.
+      * Tools without a time stamp get the current IGT time stamp.
+      */
+      void PublishToolStates();
+
+      /**
+      * \brief Applies the priority and CPU affinity settings to the calling thread.
+      *
+      * Has to be called by the tracking thread when it starts. Failures are only reported as warnings
+      * (e.g. real time priorities usually require special privileges).
+      */
+      void ConfigureTrackingThread();
+
 
       TrackingDevice();
       ~TrackingDevice() override;
@@ -268,6 +268,7 @@ void mitk::VirtualTrackingDevice::TrackTools()
       currentTool->SetDataValid(true);
       currentTool->Modified();
     }
+    this->PublishToolStates();
     itksys::SystemTools::Delay(m_RefreshRate);
     /* Update the local copy of m_StopTracking */
     this->m_StopTrackingMutex->Lock();
@@ -291,7 +292,10 @@ ITK_THREAD_RETURN_TYPE mitk::VirtualTrackingDevice::ThreadStartTracking(void* pI
   VirtualTrackingDevice *trackingDevice = static_cast<VirtualTrackingDevice*>(pInfo->UserData);
 
   if (trackingDevice != nullptr)
+  {
+    trackingDevice->ConfigureTrackingThread();
     trackingDevice->TrackTools();
+  }
 
   trackingDevice->m_ThreadID = -1; // reset thread ID because we end the thread here
   return ITK_THREAD_RETURN_VALUE;
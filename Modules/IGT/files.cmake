@@ -7,6 +7,7 @@ set(CPP_FILES
   Algorithms/mitkNavigationDataEvaluationFilter.cpp
   Algorithms/mitkNavigationDataLandmarkTransformFilter.cpp
   Algorithms/mitkNavigationDataPassThroughFilter.cpp
+  Algorithms/mitkNavigationDataPredictionFilter.cpp
   Algorithms/mitkNavigationDataReferenceTransformFilter.cpp
   Algorithms/mitkNavigationDataSmoothingFilter.cpp
   Algorithms/mitkNavigationDataToMessageFilter.cpp
@@ -19,6 +20,7 @@ set(CPP_FILES
   Algorithms/mitkPivotCalibration.cpp
 
   Common/mitkIGTTimeStamp.cpp
+  Common/mitkNavigationDataLatencyMonitor.cpp
   Common/mitkSerialCommunication.cpp
 
   DataManagement/mitkNavigationDataSource.cpp
@@ -0,0 +1,157 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+// MITK
+#include "mitkNavigationDataReaderBinary.h"
+#include <mitkNavigationDataSetBinaryFormat.h>
+#include <mitkIGTIOException.h>
+#include <mitkIGTMimeTypes.h>
+
+// STL
+#include <algorithm>
+#include <fstream>
+
+mitk::NavigationDataReaderBinary::NavigationDataReaderBinary() : AbstractFileReader(
+  mitk::IGTMimeTypes::NAVIGATIONDATASETBINARY_MIMETYPE(),
+  "MITK NavigationData Reader (binary)")
+{
+  Options defaultOptions;
+  defaultOptions[OPTION_MEMORY_MAPPED()] = us::Any(false);
+  this->SetDefaultOptions(defaultOptions);
+
+  RegisterService();
+}
+
+std::string mitk::NavigationDataReaderBinary::OPTION_MEMORY_MAPPED()
+{
+  static std::string s = "Memory mapped (lazy) loading";
+  return s;
+}
+
+mitk::NavigationDataReaderBinary::NavigationDataReaderBinary(const mitk::NavigationDataReaderBinary& other) : AbstractFileReader(other)
+{
+}
+
+mitk::NavigationDataReaderBinary::~NavigationDataReaderBinary()
+{
+}
+
+mitk::NavigationDataReaderBinary* mitk::NavigationDataReaderBinary::Clone() const
+{
+  return new NavigationDataReaderBinary(*this);
+}
+
+std::vector<itk::SmartPointer<mitk::BaseData>> mitk::NavigationDataReaderBinary::Read()
+{
+  std::istream* in = GetInputStream();
+
+  bool memoryMapped = false;
+  try
+  {
+    memoryMapped = us::any_cast<bool>(this->GetOption(OPTION_MEMORY_MAPPED()));
+  }
+  catch (const us::BadAnyCastException& e)
+  {
+    MITK_WARN << "Unexpected error: " << e.what();
+  }
+
+  // streams cannot be mapped, they are read as usual
+  if (memoryMapped && in == nullptr)
+  {
+    std::vector<mitk::BaseData::Pointer> result;
+    result.push_back(NavigationDataSet::MapBinaryFile(GetInputLocation()).GetPointer());
+    return result;
+  }
+
+  std::ifstream file;
+  if (in == nullptr)
+  {
+    file.open(GetInputLocation().c_str(), std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+      mitkThrowException(mitk::IGTIOException) << "File '" << GetInputLocation() << "' could not be opened.";
+    }
+    in = &file;
+  }
+
+  NavigationDataSetBinaryFormat::Header header = NavigationDataSetBinaryFormat::ReadHeader(*in);
+
+  // the number of time steps follows from the file size
+  in->seekg(0, std::ios::end);
+  const std::streamoff fileSize = in->tellg();
+  in->seekg(static_cast<std::streamoff>(header.m_HeaderSize), std::ios::beg);
+  if (!(*in) || fileSize < static_cast<std::streamoff>(header.m_HeaderSize))
+  {
+    mitkThrowException(mitk::IGTIOException) << "NavigationDataSet binary file is truncated.";
+  }
+
+  const unsigned int numberOfTools = static_cast<unsigned int>(header.m_ToolNames.size());
+  const std::size_t recordSize = NavigationDataSetBinaryFormat::GetRecordSize(header.m_CovariancePerRecord);
+  const std::size_t timeStepSize = NavigationDataSetBinaryFormat::GetTimeStepSize(header);
+  const std::size_t dataSize = static_cast<std::size_t>(fileSize) - static_cast<std::size_t>(header.m_HeaderSize);
+  const unsigned int numberOfTimeSteps = timeStepSize > 0 ? static_cast<unsigned int>(dataSize / timeStepSize) : 0;
+
+  if (timeStepSize > 0 && dataSize % timeStepSize != 0)
+  {
+    MITK_WARN("NavigationDataReaderBinary") << "Ignoring incomplete last time step in '" << GetInputLocation() << "'.";
+  }
+
+  mitk::NavigationDataSet::Pointer navigationDataSet = mitk::NavigationDataSet::New(numberOfTools);
+  navigationDataSet->Reserve(numberOfTimeSteps);
+
+  // the navigation datas are only used to pass the values to the set, thus they are reused for all time steps
+  std::vector<mitk::NavigationData::Pointer> timeStep;
+  NavigationData::CovarianceMatrixType identity;
+  identity.SetIdentity();
+  for (unsigned int toolIndex = 0; toolIndex < numberOfTools; toolIndex++)
+  {
+    mitk::NavigationData::Pointer nd = mitk::NavigationData::New();
+    nd->SetName(header.m_ToolNames[toolIndex].c_str());
+    timeStep.push_back(nd);
+  }
+
+  const unsigned int timeStepsPerBlock = 4096;
+  std::vector<char> buffer;
+
+  for (unsigned int blockStart = 0; blockStart < numberOfTimeSteps; blockStart += timeStepsPerBlock)
+  {
+    const unsigned int blockEnd = std::min(blockStart + timeStepsPerBlock, numberOfTimeSteps);
+    buffer.resize((blockEnd - blockStart) * timeStepSize);
+    in->read(buffer.data(), buffer.size());
+    if (!(*in))
+    {
+      mitkThrowException(mitk::IGTIOException) << "Could not read time steps " << blockStart << " to " << blockEnd << ".";
+    }
+
+    for (unsigned int i = 0; i < blockEnd - blockStart; i++)
+    {
+      for (unsigned int toolIndex = 0; toolIndex < numberOfTools; toolIndex++)
+      {
+        NavigationDataSetBinaryFormat::UnpackRecord(&buffer[i * timeStepSize + toolIndex * recordSize], header.m_CovariancePerRecord,
+          header.m_CovariancePerRecord ? identity : header.m_ToolCovariances[toolIndex], timeStep[toolIndex]);
+      }
+
+      if (!navigationDataSet->AddNavigationDatas(timeStep))
+      {
+        mitkThrowException(mitk::IGTIOException) << "Invalid time step " << blockStart + i << " in NavigationDataSet binary file.";
+      }
+    }
+  }
+
+  std::vector<mitk::BaseData::Pointer> result;
+  result.push_back(navigationDataSet.GetPointer());
+  return result;
+}
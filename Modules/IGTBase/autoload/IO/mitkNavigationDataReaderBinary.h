@@ -0,0 +1,58 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKNavigationDataReaderBinary_H_HEADER_INCLUDED_
+#define MITKNavigationDataReaderBinary_H_HEADER_INCLUDED_
+
+#include <MitkIGTIOExports.h>
+
+#include <mitkAbstractFileReader.h>
+#include <mitkNavigationDataSet.h>
+
+namespace mitk {
+  /** This class reads navigation data sets in the binary format described in mitk::NavigationDataSetBinaryFormat.
+   *
+   *  An incomplete time step at the end of the file (e.g. of an interrupted recording) is ignored.
+   *
+   *  The reader option OPTION_MEMORY_MAPPED() creates a read only set that maps the file instead of
+   *  loading it (see mitk::NavigationDataSet::MapBinaryFile()), so long recordings open instantly.
+   */
+  class MITKIGTIO_EXPORT NavigationDataReaderBinary : public AbstractFileReader
+  {
+  public:
+
+    NavigationDataReaderBinary();
+    ~NavigationDataReaderBinary() override;
+
+    /** Name of the boolean reader option for memory mapped loading, default is false. */
+    static std::string OPTION_MEMORY_MAPPED();
+
+    /** @return Returns the NavigationDataSet stored in the file.
+     *  @throw mitk::IGTIOException if the file could not be read.
+     */
+    using AbstractFileReader::Read;
+    std::vector<itk::SmartPointer<BaseData>> Read() override;
+
+  protected:
+
+    NavigationDataReaderBinary(const NavigationDataReaderBinary& other);
+
+    mitk::NavigationDataReaderBinary* Clone() const override;
+
+  };
+}
+
+#endif // MITKNavigationDataReaderBinary_H_HEADER_INCLUDED_
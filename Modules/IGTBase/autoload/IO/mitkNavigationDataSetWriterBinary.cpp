@@ -0,0 +1,143 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkNavigationDataSetWriterBinary.h"
+#include <mitkNavigationDataSetBinaryFormat.h>
+
+#include <mitkIGTIOException.h>
+#include <mitkIGTMimeTypes.h>
+
+// STL
+#include <algorithm>
+#include <fstream>
+
+mitk::NavigationDataSetWriterBinary::NavigationDataSetWriterBinary() : AbstractFileWriter(NavigationDataSet::GetStaticNameOfClass(),
+  mitk::IGTMimeTypes::NAVIGATIONDATASETBINARY_MIMETYPE(),
+  "MITK NavigationDataSet Writer (binary)")
+{
+  RegisterService();
+}
+
+mitk::NavigationDataSetWriterBinary::~NavigationDataSetWriterBinary()
+{
+}
+
+mitk::NavigationDataSetWriterBinary::NavigationDataSetWriterBinary(const mitk::NavigationDataSetWriterBinary& other) : AbstractFileWriter(other)
+{
+}
+
+mitk::NavigationDataSetWriterBinary* mitk::NavigationDataSetWriterBinary::Clone() const
+{
+  return new NavigationDataSetWriterBinary(*this);
+}
+
+void mitk::NavigationDataSetWriterBinary::Write()
+{
+  mitk::NavigationDataSet::ConstPointer data = dynamic_cast<const NavigationDataSet*> (this->GetInput());
+  if (data.IsNull())
+  {
+    mitkThrowException(mitk::IGTIOException) << "Input of the NavigationDataSet binary writer is not a NavigationDataSet.";
+  }
+
+  std::ostream* out = GetOutputStream();
+  std::ofstream file;
+  if (out == nullptr)
+  {
+    file.open(GetOutputLocation().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+      mitkThrowException(mitk::IGTIOException) << "Could not open '" << GetOutputLocation() << "' for writing.";
+    }
+    out = &file;
+  }
+
+  const unsigned int numberOfTools = data->GetNumberOfTools();
+  const std::size_t covarianceSize = 36;
+
+  if (data->IsMemoryMapped())
+  {
+    // the tool streams of a mapped set are not loaded, copy the time steps one by one
+    NavigationDataSetBinaryFormat::Header header;
+    for (unsigned int toolIndex = 0; toolIndex < numberOfTools; toolIndex++)
+    {
+      mitk::NavigationData::Pointer nd = data->GetNavigationDataForIndex(0, toolIndex);
+      header.m_ToolNames.push_back(nd.IsNotNull() ? nd->GetName() : "");
+    }
+
+    NavigationDataSetBinaryFormat::WriteHeader(*out, header);
+    for (auto it = data->Begin(); it != data->End(); ++it)
+    {
+      NavigationDataSetBinaryFormat::WriteTimeStep(*out, header, *it);
+    }
+    out->flush();
+    return;
+  }
+
+  NavigationDataSetBinaryFormat::Header header;
+  header.m_CovariancePerRecord = false;
+  for (unsigned int toolIndex = 0; toolIndex < numberOfTools; toolIndex++)
+  {
+    const NavigationDataSet::ToolStream& stream = data->GetToolStream(toolIndex);
+    header.m_ToolNames.push_back(stream.m_Name);
+
+    NavigationData::CovarianceMatrixType covariance;
+    covariance.SetIdentity();
+    if (!stream.m_Covariances.empty())
+    {
+      covariance.GetVnlMatrix().copy_in(stream.m_Covariances.data());
+    }
+    header.m_ToolCovariances.push_back(covariance);
+
+    if (stream.m_Covariances.size() > covarianceSize)
+    {
+      header.m_CovariancePerRecord = true;
+    }
+  }
+
+  NavigationDataSetBinaryFormat::WriteHeader(*out, header);
+
+  // write blocks of time steps to keep the number of stream operations low
+  const std::size_t recordSize = NavigationDataSetBinaryFormat::GetRecordSize(header.m_CovariancePerRecord);
+  const std::size_t timeStepSize = NavigationDataSetBinaryFormat::GetTimeStepSize(header);
+  const unsigned int timeStepsPerBlock = 4096;
+  std::vector<char> buffer;
+
+  for (unsigned int blockStart = 0; blockStart < data->Size(); blockStart += timeStepsPerBlock)
+  {
+    const unsigned int blockEnd = std::min(blockStart + timeStepsPerBlock, data->Size());
+    buffer.resize((blockEnd - blockStart) * timeStepSize);
+
+    for (unsigned int toolIndex = 0; toolIndex < numberOfTools; toolIndex++)
+    {
+      const NavigationDataSet::ToolStream& stream = data->GetToolStream(toolIndex);
+      for (unsigned int i = blockStart; i < blockEnd; i++)
+      {
+        char* record = &buffer[(i - blockStart) * timeStepSize + toolIndex * recordSize];
+        NavigationDataSetBinaryFormat::PackRecord(record, header.m_CovariancePerRecord, stream.m_TimeStamps[i],
+          &(stream.m_Positions[3 * static_cast<std::size_t>(i)]), &(stream.m_Orientations[4 * static_cast<std::size_t>(i)]),
+          stream.m_Flags[i], &(stream.m_Covariances[stream.m_CovarianceIndices[i] * covarianceSize]));
+      }
+    }
+
+    out->write(buffer.data(), buffer.size());
+  }
+
+  out->flush();
+  if (!(*out))
+  {
+    mitkThrowException(mitk::IGTIOException) << "Writing NavigationDataSet binary file failed.";
+  }
+}
@@ -85,9 +85,10 @@ void mitk::NavigationDataSetWriterXML::StreamData (std::ostream* stream, mitk::N
   // For each time step in the Dataset
   for (auto it = data->Begin(); it != data->End(); it++)
   {
-    for (std::size_t toolIndex = 0; toolIndex < it->size(); toolIndex++)
+    const std::vector<mitk::NavigationData::Pointer> timeStep = *it;
+    for (std::size_t toolIndex = 0; toolIndex < timeStep.size(); toolIndex++)
     {
-      mitk::NavigationData::Pointer nd = it->at(toolIndex);
+      mitk::NavigationData::Pointer nd = timeStep.at(toolIndex);
       auto  elem = new TiXmlElement("ND");
 
       elem->SetDoubleAttribute("Time", nd->GetIGTTimeStamp());
@@ -10,6 +10,7 @@ set(CPP_FILES
   mitkIGTException.cpp
   mitkIGTIOException.cpp
   mitkIGTHardwareException.cpp
+  mitkNavigationDataSetBinaryFormat.cpp
 )
 
 if(WIN32)
@@ -20,6 +20,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <MitkIGTBaseExports.h>
 #include "mitkBaseData.h"
 #include "mitkNavigationData.h"
+#include "mitkNavigationDataSetBinaryFormat.h"
+#include <mitkMemoryMappedFile.h>
+
+#include <iterator>
+#include <vector>
 
 namespace mitk {
   /**
@@ -29,40 +34,137 @@ namespace mitk {
   * Use mitk::NavigationDataRecorder to create these sets easily from pipelines.
   * Use mitk::NavigationDataPlayer to stream from these sets easily.
   *
+  * The set does not keep the added mitk::NavigationData objects. The values are copied into contiguous
+  * arrays per tool (time stamps, positions, orientations, flags and an index into a table of the distinct
+  * covariance matrices of the tool), so long recordings do not consist of millions of ITK objects.
+  * All accessors returning mitk::NavigationData create new objects holding the stored values; the name
+  * of a tool is taken from the first mitk::NavigationData added for it.
+  *
+  * A set created by MapBinaryFile() does not load the data at all but references the time steps of a binary
+  * file (see mitk::NavigationDataSetBinaryFormat) through a memory mapping, so only the parts of a long recording
+  * that are actually played occupy memory. Such a set is read only.
   */
   class MITKIGTBASE_EXPORT NavigationDataSet : public BaseData
   {
   public:
 
     /**
-    * \brief This iterator iterates over the distinct time steps in this set.
+    * \brief This iterator iterates over the distinct time steps in this set. And is const.
     *
-    * It returns an array of the length equal to GetNumberOfTools(), containing a
-    * mitk::NavigationData for each tool..
+    * Dereferencing returns a vector of the length equal to GetNumberOfTools(), containing a
+    * new mitk::NavigationData for each tool (see GetTimeStep()).
+    */
+    class NavigationDataSetConstIterator
+    {
+    public:
+      typedef std::random_access_iterator_tag iterator_category;
+      typedef std::vector<mitk::NavigationData::Pointer> value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef value_type reference;
+
+      /** \brief Holds the dereferenced time step for the member access by operator->. */
+      class pointer
+      {
+      public:
+        explicit pointer(const value_type& value) : m_Value(value) {}
+        const value_type* operator->() const { return &m_Value; }
+      private:
+        value_type m_Value;
+      };
+
+      NavigationDataSetConstIterator() : m_Set(nullptr), m_Index(0) {}
+      NavigationDataSetConstIterator(const NavigationDataSet* set, difference_type index) : m_Set(set), m_Index(index) {}
+
+      reference operator*() const { return m_Set->GetTimeStep(static_cast<unsigned int>(m_Index)); }
+      pointer operator->() const { return pointer(**this); }
+      reference operator[](difference_type n) const { return *(*this + n); }
+
+      NavigationDataSetConstIterator& operator++() { ++m_Index; return *this; }
+      NavigationDataSetConstIterator operator++(int) { NavigationDataSetConstIterator result(*this); ++m_Index; return result; }
+      NavigationDataSetConstIterator& operator--() { --m_Index; return *this; }
+      NavigationDataSetConstIterator operator--(int) { NavigationDataSetConstIterator result(*this); --m_Index; return result; }
+      NavigationDataSetConstIterator& operator+=(difference_type n) { m_Index += n; return *this; }
+      NavigationDataSetConstIterator& operator-=(difference_type n) { m_Index -= n; return *this; }
+      NavigationDataSetConstIterator operator+(difference_type n) const { return NavigationDataSetConstIterator(m_Set, m_Index + n); }
+      NavigationDataSetConstIterator operator-(difference_type n) const { return NavigationDataSetConstIterator(m_Set, m_Index - n); }
+      difference_type operator-(const NavigationDataSetConstIterator& other) const { return m_Index - other.m_Index; }
+
+      bool operator==(const NavigationDataSetConstIterator& other) const { return m_Set == other.m_Set && m_Index == other.m_Index; }
+      bool operator!=(const NavigationDataSetConstIterator& other) const { return !(*this == other); }
+      bool operator<(const NavigationDataSetConstIterator& other) const { return m_Index < other.m_Index; }
+      bool operator>(const NavigationDataSetConstIterator& other) const { return m_Index > other.m_Index; }
+      bool operator<=(const NavigationDataSetConstIterator& other) const { return m_Index <= other.m_Index; }
+      bool operator>=(const NavigationDataSetConstIterator& other) const { return m_Index >= other.m_Index; }
+
+      /** \brief Index of the time step the iterator points to. */
+      unsigned int GetIndex() const { return static_cast<unsigned int>(m_Index); }
+
+    private:
+      const NavigationDataSet* m_Set;
+      difference_type m_Index;
+    };
+
+    /**
+    * \brief The time steps cannot be modified through iterators, thus this is the same as NavigationDataSetConstIterator.
     */
-    typedef std::vector< std::vector<mitk::NavigationData::Pointer> >::iterator NavigationDataSetIterator;
+    typedef NavigationDataSetConstIterator NavigationDataSetIterator;
 
     /**
-    * \brief This iterator iterates over the distinct time steps in this set. And is const.
+    * \brief Stored values of all time steps of one tool.
     *
-    * It returns an array of the length equal to GetNumberOfTools(), containing a
-    * mitk::NavigationData for each tool..
+    * Element i of every column belongs to time step i. Positions hold 3, orientations 4 (x, y, z, r)
+    * values per time step. m_CovarianceIndices refers to the 6x6 matrices (row major) in m_Covariances.
     */
-    typedef std::vector< std::vector<mitk::NavigationData::Pointer> >::const_iterator NavigationDataSetConstIterator;
+    struct ToolStream
+    {
+      std::string m_Name;
+      std::vector<NavigationData::TimeStampType> m_TimeStamps;
+      std::vector<ScalarType> m_Positions;
+      std::vector<ScalarType> m_Orientations;
+      std::vector<unsigned char> m_Flags;
+      std::vector<unsigned int> m_CovarianceIndices;
+      std::vector<ScalarType> m_Covariances;
+    };
+
+    /** \brief Bits of ToolStream::m_Flags */
+    enum ToolStreamFlags
+    {
+      DataValidFlag = 1,
+      HasPositionFlag = 2,
+      HasOrientationFlag = 4
+    };
 
     mitkClassMacro(NavigationDataSet, BaseData);
 
     mitkNewMacro1Param(Self, unsigned int);
 
+    /**
+    * \brief Creates a read only set that references the time steps of a binary NavigationDataSet file (*.ndb)
+    * through a memory mapping instead of loading them. An incomplete last time step is ignored.
+    *
+    * @throw mitk::IGTIOException if the file cannot be opened or is not a valid binary NavigationDataSet file.
+    */
+    static Pointer MapBinaryFile( const std::string& fileName );
+
+    /**
+    * \brief Returns true if the set references a memory mapped file (see MapBinaryFile()).
+    */
+    bool IsMemoryMapped() const;
+
     /**
     * \brief Add mitk::NavigationData of the given tool to the Set.
     *
     * @param navigationDatas vector of mitk::NavigationData objects to be added. Make sure that the size of the
     * vector equals the number of tools given in the constructor
-    * @return true if object was be added to the set successfully, false otherwise
+    * @return true if object was be added to the set successfully, false otherwise (also for memory mapped sets)
     */
     bool AddNavigationDatas( std::vector<mitk::NavigationData::Pointer> navigationDatas );
 
+    /**
+    * \brief Reserves memory for the given number of time steps, e.g., before reading or recording a known amount of data.
+    */
+    void Reserve( unsigned int numberOfTimeSteps );
+
     /**
     * \brief Get mitk::NavigationData from the given tool at given index.
     *
@@ -72,6 +174,38 @@ namespace mitk {
     */
     NavigationData::Pointer GetNavigationDataForIndex( unsigned int index, unsigned int toolIndex ) const;
 
+    /**
+    * \brief Get the time stamp of the given tool at given index without creating a mitk::NavigationData.
+    * @return the IGT time stamp, 0 if there is no data at the indices.
+    */
+    NavigationData::TimeStampType GetIGTTimeStampForIndex( unsigned int index, unsigned int toolIndex ) const;
+
+    /**
+    * \brief Returns the index of the last time step of the tool whose time stamp is not greater than the given
+    * time stamp, 0 if the time stamp is before the first time step.
+    *
+    * Uses a binary search, thus seeking in long recordings is fast. The time stamps of a tool are strictly
+    * increasing (see AddNavigationDatas()).
+    */
+    unsigned int GetIndexForIGTTimeStamp( NavigationData::TimeStampType timeStamp, unsigned int toolIndex ) const;
+
+    /**
+    * \brief Sets navigationData to the state of the tool at the given time stamp.
+    *
+    * The position is interpolated linearly and the orientation by spherical linear interpolation (SLERP)
+    * between the neighboured time steps. Time stamps outside of the recording are clamped to the first or last
+    * time step. The data is valid if both neighbours are valid, the covariance is taken from the earlier one.
+    *
+    * @return false if the set is empty or the tool index is invalid.
+    */
+    bool GetInterpolatedNavigationData( NavigationData::TimeStampType timeStamp, unsigned int toolIndex, NavigationData* navigationData ) const;
+
+    /**
+    * \brief Direct read access to the stored values of a tool.
+    * @throw mitk::Exception if the tool index is invalid or the set is memory mapped.
+    */
+    const ToolStream& GetToolStream( unsigned int toolIndex ) const;
+
     ///**
     //* \brief Get last mitk::Navigation object for given tool whose timestamp is less than the given timestamp.
     //* @param toolIndex Index of the tool from which mitk::NavigationData should be returned.
@@ -157,17 +291,38 @@ namespace mitk {
     ~NavigationDataSet( ) override;
 
     /**
-    * \brief Holds all the mitk::NavigationData objects managed by this class.
-    *
-    * The first dimension is the index of the navigation data, the second is the
-    * tool to which this data belongs. i.e. the first dimension is usually the longer one.
+    * \brief Copies the values of the time step index of the tool into the given navigation data.
+    */
+    void FillNavigationData( unsigned int index, unsigned int toolIndex, NavigationData* navigationData ) const;
+
+    /**
+    * \brief Time stamp of a time step without range checks.
+    */
+    NavigationData::TimeStampType GetTimeStamp( unsigned int index, unsigned int toolIndex ) const;
+
+    /**
+    * \brief Holds the values of all time steps, one stream per tool.
     */
-    std::vector<std::vector<NavigationData::Pointer> > m_NavigationDataVectors;
+    std::vector<ToolStream> m_ToolStreams;
+
+    /**
+    * \brief Number of time steps stored in every tool stream.
+    */
+    unsigned int m_NumberOfTimeSteps;
 
     /**
     * \brief The Number of Tools that this class is going to support.
     */
     unsigned int m_NumberOfTools;
+
+    /**
+    * \brief Mapping of the binary file of a memory mapped set, null otherwise.
+    */
+    MemoryMappedFile::Pointer m_MappedFile;
+    NavigationDataSetBinaryFormat::Header m_MappedHeader;
+    const char* m_MappedTimeSteps; ///< first time step in the mapping
+    std::size_t m_MappedTimeStepSize;
+    std::size_t m_MappedRecordSize;
   };
 }
 
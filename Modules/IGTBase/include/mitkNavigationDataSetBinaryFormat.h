@@ -0,0 +1,85 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKNavigationDataSetBinaryFormat_H_HEADER_INCLUDED_
+#define MITKNavigationDataSetBinaryFormat_H_HEADER_INCLUDED_
+
+#include <MitkIGTBaseExports.h>
+
+#include <mitkNavigationData.h>
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace mitk {
+  /** \brief Layout of the binary NavigationDataSet files (*.ndb).
+   *
+   *  The file consists of a header followed by fixed size time step records, so time step i starts at
+   *  GetHeaderSize() + i * GetTimeStepSize(). New time steps are appended at the end of the file without
+   *  touching the header; the number of time steps is derived from the file size. This allows recording
+   *  directly into a file (see WriteHeader() and WriteTimeStep()) and memory mapping it for playback.
+   *
+   *  All values are stored in native byte order (checked by a byte order mark) and are 8 byte aligned:
+   *    - header: magic "MITKNDSB", uint32 version, uint32 byte order mark, uint32 number of tools,
+   *      uint32 flags, uint64 header size, per tool uint32 name length and the name, padding to 8 bytes,
+   *      and - if the covariance is constant - the 36 doubles of the covariance matrix of each tool.
+   *    - time step: for each tool double time stamp, 3 doubles position, 4 doubles orientation (x, y, z, r),
+   *      uint64 flags (see NavigationDataSet::ToolStreamFlags) and - if not constant - 36 doubles covariance.
+   */
+  class MITKIGTBASE_EXPORT NavigationDataSetBinaryFormat
+  {
+  public:
+    struct Header
+    {
+      Header() : m_CovariancePerRecord(true), m_HeaderSize(0) {}
+
+      std::vector<std::string> m_ToolNames;
+      /** true: every record holds its covariance matrix, false: m_ToolCovariances holds one matrix per tool */
+      bool m_CovariancePerRecord;
+      std::vector<NavigationData::CovarianceMatrixType> m_ToolCovariances;
+      /** set by WriteHeader() and ReadHeader() */
+      std::uint64_t m_HeaderSize;
+    };
+
+    /** \brief Writes the header and sets header.m_HeaderSize.
+     *  @throw mitk::IGTIOException if the number of tool covariances does not fit the number of tools.*/
+    static void WriteHeader(std::ostream& stream, Header& header);
+
+    /** \brief Reads the header from the current stream position.
+     *  @throw mitk::IGTIOException if the stream does not contain a valid header.*/
+    static Header ReadHeader(std::istream& stream);
+
+    static std::size_t GetRecordSize(bool covariancePerRecord);
+
+    static std::size_t GetTimeStepSize(const Header& header);
+
+    /** \brief Appends a time step, e.g. while recording.
+     *  @throw mitk::IGTIOException if the number of navigation datas does not fit the header.*/
+    static void WriteTimeStep(std::ostream& stream, const Header& header, const std::vector<NavigationData::Pointer>& navigationDatas);
+
+    /** \brief Copies the values of one tool into a record. covariance is ignored (may be nullptr) if covariancePerRecord is false. */
+    static void PackRecord(char* record, bool covariancePerRecord, double timeStamp, const double* position,
+      const double* orientation, unsigned char flags, const double* covariance);
+
+    /** \brief Copies the values of a record into navigationData. constantCovariance is used if the record holds no covariance.*/
+    static void UnpackRecord(const char* record, bool covariancePerRecord, const NavigationData::CovarianceMatrixType& constantCovariance,
+      NavigationData* navigationData);
+  };
+}
+
+#endif // MITKNavigationDataSetBinaryFormat_H_HEADER_INCLUDED_
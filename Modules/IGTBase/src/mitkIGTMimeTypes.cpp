@@ -37,6 +37,16 @@ mitk::CustomMimeType mitk::IGTMimeTypes::NAVIGATIONDATASETCSV_MIMETYPE()
   return mimeType;
 }
 
+mitk::CustomMimeType mitk::IGTMimeTypes::NAVIGATIONDATASETBINARY_MIMETYPE()
+{
+  mitk::CustomMimeType mimeType(IOMimeTypes::DEFAULT_BASE_NAME() + ".NavigationDataSet.ndb");
+  std::string category = "NavigationDataSet";
+  mimeType.SetComment("NavigationDataSet (binary)");
+  mimeType.SetCategory(category);
+  mimeType.AddExtension("ndb");
+  return mimeType;
+}
+
 mitk::CustomMimeType mitk::IGTMimeTypes::USDEVICEINFORMATIONXML_MIMETYPE()
 {
   mitk::CustomMimeType mimeType(IOMimeTypes::DEFAULT_BASE_NAME() + ".USDeviceInformation.xml");
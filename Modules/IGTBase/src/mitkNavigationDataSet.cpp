@@ -18,17 +18,132 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkPointSet.h"
 #include "mitkBaseRenderer.h"
 
+#include "mitkIGTIOException.h"
+
+#include <mitkExceptionMacro.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+  /** Spherical linear interpolation along the shorter arc, falls back to a normalized linear interpolation for close orientations. */
+  mitk::Quaternion Slerp( const mitk::Quaternion& q0, const mitk::Quaternion& q1, double t )
+  {
+    double cosTheta = 0.0;
+    for (unsigned int j = 0; j < 4; ++j)
+    {
+      cosTheta += q0[j] * q1[j];
+    }
+
+    // q and -q are the same rotation
+    const double sign = cosTheta < 0.0 ? -1.0 : 1.0;
+    cosTheta *= sign;
+
+    double w0 = 1.0 - t;
+    double w1 = t;
+    if ( cosTheta < 0.9995 )
+    {
+      const double theta = std::acos(cosTheta);
+      const double sinTheta = std::sin(theta);
+      w0 = std::sin((1.0 - t) * theta) / sinTheta;
+      w1 = std::sin(t * theta) / sinTheta;
+    }
+    w1 *= sign;
+
+    mitk::Quaternion result(w0 * q0[0] + w1 * q1[0], w0 * q0[1] + w1 * q1[1], w0 * q0[2] + w1 * q1[2], w0 * q0[3] + w1 * q1[3]);
+    const double norm = result.magnitude();
+    if ( norm > 0.0 )
+    {
+      result /= norm;
+    }
+    return result;
+  }
+}
+
 mitk::NavigationDataSet::NavigationDataSet( unsigned int numberOfTools )
-  : m_NavigationDataVectors(std::vector<std::vector<mitk::NavigationData::Pointer> >()), m_NumberOfTools(numberOfTools)
+  : m_ToolStreams(numberOfTools), m_NumberOfTimeSteps(0), m_NumberOfTools(numberOfTools),
+    m_MappedTimeSteps(nullptr), m_MappedTimeStepSize(0), m_MappedRecordSize(0)
 {
 }
 
+mitk::NavigationDataSet::Pointer mitk::NavigationDataSet::MapBinaryFile( const std::string& fileName )
+{
+  NavigationDataSetBinaryFormat::Header header;
+  {
+    std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+    if ( !file.is_open() )
+    {
+      mitkThrowException(mitk::IGTIOException) << "File '" << fileName << "' could not be opened.";
+    }
+    header = NavigationDataSetBinaryFormat::ReadHeader(file);
+  }
+
+  MemoryMappedFile::Pointer mappedFile = MemoryMappedFile::New();
+  try
+  {
+    mappedFile->Open(fileName);
+  }
+  catch (const mitk::Exception& e)
+  {
+    mitkThrowException(mitk::IGTIOException) << "Could not map '" << fileName << "': " << e.GetDescription();
+  }
+
+  if ( mappedFile->GetSize() < header.m_HeaderSize )
+  {
+    mitkThrowException(mitk::IGTIOException) << "NavigationDataSet binary file is truncated.";
+  }
+
+  const unsigned int numberOfTools = static_cast<unsigned int>(header.m_ToolNames.size());
+  Pointer result = New(numberOfTools);
+  result->m_MappedTimeStepSize = NavigationDataSetBinaryFormat::GetTimeStepSize(header);
+  result->m_MappedRecordSize = NavigationDataSetBinaryFormat::GetRecordSize(header.m_CovariancePerRecord);
+  result->m_MappedTimeSteps = static_cast<const char*>(mappedFile->GetData()) + header.m_HeaderSize;
+
+  const std::size_t dataSize = mappedFile->GetSize() - static_cast<std::size_t>(header.m_HeaderSize);
+  if ( result->m_MappedTimeStepSize > 0 )
+  {
+    result->m_NumberOfTimeSteps = static_cast<unsigned int>(dataSize / result->m_MappedTimeStepSize);
+    if ( dataSize % result->m_MappedTimeStepSize != 0 )
+    {
+      MITK_WARN("NavigationDataSet") << "Ignoring incomplete last time step in '" << fileName << "'.";
+    }
+  }
+
+  for (unsigned int toolIndex = 0; toolIndex < numberOfTools; toolIndex++)
+  {
+    result->m_ToolStreams[toolIndex].m_Name = header.m_ToolNames[toolIndex];
+  }
+  if ( header.m_CovariancePerRecord )
+  {
+    // UnpackRecord() ignores the constant covariances in this case
+    header.m_ToolCovariances.resize(numberOfTools);
+  }
+  result->m_MappedHeader = header;
+  result->m_MappedFile = mappedFile;
+
+  return result;
+}
+
+bool mitk::NavigationDataSet::IsMemoryMapped() const
+{
+  return m_MappedFile.IsNotNull();
+}
+
 mitk::NavigationDataSet::~NavigationDataSet( )
 {
 }
 
 bool mitk::NavigationDataSet::AddNavigationDatas( std::vector<mitk::NavigationData::Pointer> navigationDatas )
 {
+  if ( this->IsMemoryMapped() )
+  {
+    MITK_WARN("NavigationDataSet") << "Cannot add navigation datas to a memory mapped NavigationDataSet.";
+    return false;
+  }
+
   // test if tool with given index exist
   if ( navigationDatas.size() != m_NumberOfTools )
   {
@@ -36,36 +151,238 @@ bool mitk::NavigationDataSet::AddNavigationDatas( std::vector<mitk::NavigationDa
     return false;
   }
 
-  // test for consistent timestamp
-  if ( m_NavigationDataVectors.size() > 0)
+  for (std::vector<mitk::NavigationData::Pointer>::size_type i = 0; i < navigationDatas.size(); i++)
+  {
+    if ( navigationDatas[i].IsNull() )
+    {
+      MITK_WARN("NavigationDataSet") << "Tried to add a null NavigationData for tool " << i << ".";
+      return false;
+    }
+
+    // test for consistent timestamp
+    if ( m_NumberOfTimeSteps > 0 && navigationDatas[i]->GetIGTTimeStamp() <= m_ToolStreams[i].m_TimeStamps.back() )
+    {
+      MITK_WARN("NavigationDataSet") << "IGTTimeStamp of new NavigationData should be newer than timestamp of last NavigationData.";
+      return false;
+    }
+  }
+
+  for (std::vector<mitk::NavigationData::Pointer>::size_type i = 0; i < navigationDatas.size(); i++)
   {
-    for (std::vector<mitk::NavigationData::Pointer>::size_type i = 0; i < navigationDatas.size(); i++)
-      if (navigationDatas[i]->GetIGTTimeStamp() <= m_NavigationDataVectors.back()[i]->GetIGTTimeStamp())
-      {
-        MITK_WARN("NavigationDataSet") << "IGTTimeStamp of new NavigationData should be newer than timestamp of last NavigationData.";
-        return false;
-      }
+    const NavigationData* nd = navigationDatas[i];
+    ToolStream& stream = m_ToolStreams[i];
+
+    if ( m_NumberOfTimeSteps == 0 )
+    {
+      stream.m_Name = nd->GetName();
+    }
+
+    stream.m_TimeStamps.push_back(nd->GetIGTTimeStamp());
+
+    const NavigationData::PositionType position = nd->GetPosition();
+    stream.m_Positions.insert(stream.m_Positions.end(), position.GetDataPointer(), position.GetDataPointer() + 3);
+
+    const NavigationData::OrientationType orientation = nd->GetOrientation();
+    for (unsigned int j = 0; j < 4; ++j)
+    {
+      stream.m_Orientations.push_back(orientation[j]);
+    }
+
+    unsigned char flags = 0;
+    if ( nd->IsDataValid() ) flags |= DataValidFlag;
+    if ( nd->GetHasPosition() ) flags |= HasPositionFlag;
+    if ( nd->GetHasOrientation() ) flags |= HasOrientationFlag;
+    stream.m_Flags.push_back(flags);
+
+    // the covariance rarely changes during a recording, store a new matrix only if it differs from the last one
+    const NavigationData::CovarianceMatrixType covariance = nd->GetCovErrorMatrix();
+    const std::size_t matrixSize = NavigationData::CovarianceMatrixType::RowDimensions * NavigationData::CovarianceMatrixType::ColumnDimensions;
+    const ScalarType* matrixBegin = covariance.GetVnlMatrix().data_block();
+    if ( stream.m_Covariances.empty() || !std::equal(matrixBegin, matrixBegin + matrixSize, stream.m_Covariances.end() - matrixSize) )
+    {
+      stream.m_Covariances.insert(stream.m_Covariances.end(), matrixBegin, matrixBegin + matrixSize);
+    }
+    stream.m_CovarianceIndices.push_back(static_cast<unsigned int>(stream.m_Covariances.size() / matrixSize - 1));
   }
 
-  m_NavigationDataVectors.push_back(navigationDatas);
+  ++m_NumberOfTimeSteps;
   return true;
 }
 
+void mitk::NavigationDataSet::Reserve( unsigned int numberOfTimeSteps )
+{
+  if ( this->IsMemoryMapped() )
+    return;
+
+  for (auto& stream : m_ToolStreams)
+  {
+    stream.m_TimeStamps.reserve(numberOfTimeSteps);
+    stream.m_Positions.reserve(3 * static_cast<std::size_t>(numberOfTimeSteps));
+    stream.m_Orientations.reserve(4 * static_cast<std::size_t>(numberOfTimeSteps));
+    stream.m_Flags.reserve(numberOfTimeSteps);
+    stream.m_CovarianceIndices.reserve(numberOfTimeSteps);
+  }
+}
+
+void mitk::NavigationDataSet::FillNavigationData( unsigned int index, unsigned int toolIndex, NavigationData* navigationData ) const
+{
+  const ToolStream& stream = m_ToolStreams[toolIndex];
+
+  if ( this->IsMemoryMapped() )
+  {
+    navigationData->SetName(stream.m_Name.c_str());
+    NavigationDataSetBinaryFormat::UnpackRecord(m_MappedTimeSteps + index * m_MappedTimeStepSize + toolIndex * m_MappedRecordSize,
+      m_MappedHeader.m_CovariancePerRecord, m_MappedHeader.m_ToolCovariances[toolIndex], navigationData);
+    return;
+  }
+
+  NavigationData::PositionType position;
+  for (unsigned int j = 0; j < 3; ++j)
+  {
+    position[j] = stream.m_Positions[3 * static_cast<std::size_t>(index) + j];
+  }
+
+  const ScalarType* q = &(stream.m_Orientations[4 * static_cast<std::size_t>(index)]);
+  NavigationData::OrientationType orientation(q[0], q[1], q[2], q[3]);
+
+  NavigationData::CovarianceMatrixType covariance;
+  const std::size_t matrixSize = NavigationData::CovarianceMatrixType::RowDimensions * NavigationData::CovarianceMatrixType::ColumnDimensions;
+  covariance.GetVnlMatrix().copy_in(&(stream.m_Covariances[stream.m_CovarianceIndices[index] * matrixSize]));
+
+  const unsigned char flags = stream.m_Flags[index];
+
+  navigationData->SetName(stream.m_Name.c_str());
+  navigationData->SetIGTTimeStamp(stream.m_TimeStamps[index]);
+  navigationData->SetPosition(position);
+  navigationData->SetOrientation(orientation);
+  navigationData->SetCovErrorMatrix(covariance);
+  navigationData->SetDataValid((flags & DataValidFlag) != 0);
+  navigationData->SetHasPosition((flags & HasPositionFlag) != 0);
+  navigationData->SetHasOrientation((flags & HasOrientationFlag) != 0);
+}
+
 mitk::NavigationData::Pointer mitk::NavigationDataSet::GetNavigationDataForIndex( unsigned int index, unsigned int toolIndex ) const
 {
-  if ( index >= m_NavigationDataVectors.size() )
+  if ( index >= m_NumberOfTimeSteps )
   {
     MITK_WARN("NavigationDataSet") << "There is no NavigationData available at index " << index << ".";
     return nullptr;
   }
 
-  if ( toolIndex >= m_NavigationDataVectors.at(index).size() )
+  if ( toolIndex >= m_NumberOfTools )
   {
     MITK_WARN("NavigationDataSet") << "There is NavigatitionData available at index " << index << " for tool " << toolIndex << ".";
     return nullptr;
   }
 
-  return m_NavigationDataVectors.at(index).at(toolIndex);
+  mitk::NavigationData::Pointer result = mitk::NavigationData::New();
+  this->FillNavigationData(index, toolIndex, result);
+  return result;
+}
+
+mitk::NavigationData::TimeStampType mitk::NavigationDataSet::GetIGTTimeStampForIndex( unsigned int index, unsigned int toolIndex ) const
+{
+  if ( index >= m_NumberOfTimeSteps || toolIndex >= m_NumberOfTools )
+  {
+    MITK_WARN("NavigationDataSet") << "There is no NavigationData available at index " << index << " for tool " << toolIndex << ".";
+    return 0;
+  }
+
+  return this->GetTimeStamp(index, toolIndex);
+}
+
+mitk::NavigationData::TimeStampType mitk::NavigationDataSet::GetTimeStamp( unsigned int index, unsigned int toolIndex ) const
+{
+  if ( this->IsMemoryMapped() )
+  {
+    // the time stamp is the first value of a record
+    NavigationData::TimeStampType timeStamp;
+    std::memcpy(&timeStamp, m_MappedTimeSteps + index * m_MappedTimeStepSize + toolIndex * m_MappedRecordSize, sizeof(timeStamp));
+    return timeStamp;
+  }
+
+  return m_ToolStreams[toolIndex].m_TimeStamps[index];
+}
+
+unsigned int mitk::NavigationDataSet::GetIndexForIGTTimeStamp( NavigationData::TimeStampType timeStamp, unsigned int toolIndex ) const
+{
+  if ( m_NumberOfTimeSteps == 0 || toolIndex >= m_NumberOfTools )
+  {
+    return 0;
+  }
+
+  // first index with a greater time stamp
+  unsigned int first = 0;
+  unsigned int count = m_NumberOfTimeSteps;
+  while ( count > 0 )
+  {
+    const unsigned int step = count / 2;
+    if ( this->GetTimeStamp(first + step, toolIndex) <= timeStamp )
+    {
+      first += step + 1;
+      count -= step + 1;
+    }
+    else
+    {
+      count = step;
+    }
+  }
+
+  return first > 0 ? first - 1 : 0;
+}
+
+bool mitk::NavigationDataSet::GetInterpolatedNavigationData( NavigationData::TimeStampType timeStamp, unsigned int toolIndex, NavigationData* navigationData ) const
+{
+  if ( m_NumberOfTimeSteps == 0 || toolIndex >= m_NumberOfTools )
+  {
+    MITK_WARN("NavigationDataSet") << "There is no NavigationData available for tool " << toolIndex << ".";
+    return false;
+  }
+
+  const unsigned int index = this->GetIndexForIGTTimeStamp(timeStamp, toolIndex);
+  this->FillNavigationData(index, toolIndex, navigationData);
+
+  const NavigationData::TimeStampType timeStamp0 = this->GetTimeStamp(index, toolIndex);
+  if ( index + 1 >= m_NumberOfTimeSteps || timeStamp <= timeStamp0 )
+  {
+    return true;
+  }
+
+  NavigationData::Pointer next = NavigationData::New();
+  this->FillNavigationData(index + 1, toolIndex, next);
+
+  const double t = (timeStamp - timeStamp0) / (next->GetIGTTimeStamp() - timeStamp0);
+
+  NavigationData::PositionType position = navigationData->GetPosition();
+  const NavigationData::PositionType nextPosition = next->GetPosition();
+  for (unsigned int j = 0; j < 3; ++j)
+  {
+    position[j] += t * (nextPosition[j] - position[j]);
+  }
+
+  navigationData->SetPosition(position);
+  navigationData->SetOrientation(Slerp(navigationData->GetOrientation(), next->GetOrientation(), t));
+  navigationData->SetIGTTimeStamp(timeStamp);
+  navigationData->SetDataValid(navigationData->IsDataValid() && next->IsDataValid());
+  navigationData->SetHasPosition(navigationData->GetHasPosition() && next->GetHasPosition());
+  navigationData->SetHasOrientation(navigationData->GetHasOrientation() && next->GetHasOrientation());
+
+  return true;
+}
+
+const mitk::NavigationDataSet::ToolStream& mitk::NavigationDataSet::GetToolStream( unsigned int toolIndex ) const
+{
+  if ( toolIndex >= m_NumberOfTools )
+  {
+    mitkThrow() << "Invalid toolIndex: " << m_NumberOfTools << " Tools known, requested index " << toolIndex << "";
+  }
+
+  if ( this->IsMemoryMapped() )
+  {
+    mitkThrow() << "The tool streams of a memory mapped NavigationDataSet are not loaded, use GetTimeStep() instead.";
+  }
+
+  return m_ToolStreams[toolIndex];
 }
 
 // Method not yet supported, code below compiles but delivers wrong results
@@ -108,16 +425,36 @@ std::vector< mitk::NavigationData::Pointer > mitk::NavigationDataSet::GetDataStr
   }
 
   std::vector< mitk::NavigationData::Pointer > result;
+  result.reserve(m_NumberOfTimeSteps);
 
-  for(std::vector<std::vector<NavigationData::Pointer> >::size_type i = 0; i < m_NavigationDataVectors.size(); i++)
-    result.push_back(m_NavigationDataVectors[i][toolIndex]);
+  for (unsigned int i = 0; i < m_NumberOfTimeSteps; i++)
+  {
+    mitk::NavigationData::Pointer nd = mitk::NavigationData::New();
+    this->FillNavigationData(i, toolIndex, nd);
+    result.push_back(nd);
+  }
 
   return result;
 }
 
 std::vector< mitk::NavigationData::Pointer > mitk::NavigationDataSet::GetTimeStep(unsigned int index) const
 {
-  return m_NavigationDataVectors[index];
+  std::vector< mitk::NavigationData::Pointer > result;
+  if ( index >= m_NumberOfTimeSteps )
+  {
+    MITK_WARN("NavigationDataSet") << "There is no time step available at index " << index << ".";
+    return result;
+  }
+
+  result.reserve(m_NumberOfTools);
+  for (unsigned int toolIndex = 0; toolIndex < m_NumberOfTools; toolIndex++)
+  {
+    mitk::NavigationData::Pointer nd = mitk::NavigationData::New();
+    this->FillNavigationData(index, toolIndex, nd);
+    result.push_back(nd);
+  }
+
+  return result;
 }
 
 unsigned int mitk::NavigationDataSet::GetNumberOfTools() const
@@ -127,7 +464,7 @@ unsigned int mitk::NavigationDataSet::GetNumberOfTools() const
 
 unsigned int mitk::NavigationDataSet::Size() const
 {
-  return m_NavigationDataVectors.size();
+  return m_NumberOfTimeSteps;
 }
 
 // ---> methods necessary for BaseData
@@ -160,11 +497,14 @@ void mitk::NavigationDataSet::ConvertNavigationDataToPointSet() const
   for (unsigned int toolIndex = 0; toolIndex < this->GetNumberOfTools(); ++ toolIndex)
   {
     mitk::PointSet::Pointer _tempPointSet = mitk::PointSet::New();
+    mitk::NavigationData::Pointer nd = mitk::NavigationData::New();
     //iterate over all time steps
-    for (unsigned int time = 0; time < m_NavigationDataVectors.size(); time++)
+    for (unsigned int time = 0; time < m_NumberOfTimeSteps; time++)
     {
-      _tempPointSet->InsertPoint(time,m_NavigationDataVectors[time][toolIndex]->GetPosition());
-      MITK_DEBUG << m_NavigationDataVectors[time][toolIndex]->GetPosition() << " --- " << _tempPointSet->GetPoint(time);
+      this->FillNavigationData(time, toolIndex, nd);
+      mitk::Point3D position = nd->GetPosition();
+      _tempPointSet->InsertPoint(time, position);
+      MITK_DEBUG << position << " --- " << _tempPointSet->GetPoint(time);
     }
     mitk::DataNode::Pointer dn = mitk::DataNode::New();
     std::stringstream str;
@@ -181,10 +521,10 @@ void mitk::NavigationDataSet::ConvertNavigationDataToPointSet() const
 
 mitk::NavigationDataSet::NavigationDataSetConstIterator mitk::NavigationDataSet::Begin() const
 {
-  return m_NavigationDataVectors.cbegin();
+  return NavigationDataSetConstIterator(this, 0);
 }
 
 mitk::NavigationDataSet::NavigationDataSetConstIterator mitk::NavigationDataSet::End() const
 {
-  return m_NavigationDataVectors.cend();
+  return NavigationDataSetConstIterator(this, m_NumberOfTimeSteps);
 }
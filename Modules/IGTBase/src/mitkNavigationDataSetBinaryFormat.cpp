@@ -0,0 +1,269 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkNavigationDataSetBinaryFormat.h"
+
+#include <mitkIGTIOException.h>
+#include <mitkNavigationDataSet.h>
+
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+namespace
+{
+  const char Magic[8] = { 'M', 'I', 'T', 'K', 'N', 'D', 'S', 'B' };
+  const std::uint32_t Version = 1;
+  const std::uint32_t ByteOrderMark = 0x01020304;
+  const std::uint32_t CovariancePerRecordFlag = 1;
+
+  const std::size_t CovarianceSize = 36;
+  // time stamp, position, orientation and flags
+  const std::size_t BasicRecordSize = (1 + 3 + 4) * sizeof(double) + sizeof(std::uint64_t);
+
+  template <typename T>
+  void WriteValue(std::ostream& stream, T value)
+  {
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template <typename T>
+  T ReadValue(std::istream& stream)
+  {
+    T value = T();
+    stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+    if (!stream)
+    {
+      mitkThrowException(mitk::IGTIOException) << "Unexpected end of NavigationDataSet binary header.";
+    }
+    return value;
+  }
+
+  std::size_t PaddingTo8(std::size_t size)
+  {
+    return (8 - size % 8) % 8;
+  }
+}
+
+void mitk::NavigationDataSetBinaryFormat::WriteHeader(std::ostream& stream, Header& header)
+{
+  const std::uint32_t numberOfTools = static_cast<std::uint32_t>(header.m_ToolNames.size());
+  if (!header.m_CovariancePerRecord && header.m_ToolCovariances.size() != numberOfTools)
+  {
+    mitkThrowException(mitk::IGTIOException) << "Constant covariance requires one matrix per tool, got "
+      << header.m_ToolCovariances.size() << " for " << numberOfTools << " tools.";
+  }
+
+  std::size_t namesSize = 0;
+  for (const auto& name : header.m_ToolNames)
+  {
+    namesSize += sizeof(std::uint32_t) + name.size();
+  }
+
+  const std::size_t fixedSize = sizeof(Magic) + 4 * sizeof(std::uint32_t) + sizeof(std::uint64_t);
+  const std::size_t padding = PaddingTo8(fixedSize + namesSize);
+  header.m_HeaderSize = fixedSize + namesSize + padding;
+  if (!header.m_CovariancePerRecord)
+  {
+    header.m_HeaderSize += numberOfTools * CovarianceSize * sizeof(double);
+  }
+
+  stream.write(Magic, sizeof(Magic));
+  WriteValue(stream, Version);
+  WriteValue(stream, ByteOrderMark);
+  WriteValue(stream, numberOfTools);
+  WriteValue(stream, header.m_CovariancePerRecord ? CovariancePerRecordFlag : std::uint32_t(0));
+  WriteValue(stream, header.m_HeaderSize);
+
+  for (const auto& name : header.m_ToolNames)
+  {
+    WriteValue(stream, static_cast<std::uint32_t>(name.size()));
+    stream.write(name.data(), name.size());
+  }
+
+  const char zeros[8] = { 0 };
+  stream.write(zeros, padding);
+
+  if (!header.m_CovariancePerRecord)
+  {
+    for (const auto& covariance : header.m_ToolCovariances)
+    {
+      stream.write(reinterpret_cast<const char*>(covariance.GetVnlMatrix().data_block()), CovarianceSize * sizeof(double));
+    }
+  }
+
+  if (!stream)
+  {
+    mitkThrowException(mitk::IGTIOException) << "Could not write NavigationDataSet binary header.";
+  }
+}
+
+mitk::NavigationDataSetBinaryFormat::Header mitk::NavigationDataSetBinaryFormat::ReadHeader(std::istream& stream)
+{
+  char magic[sizeof(Magic)];
+  stream.read(magic, sizeof(magic));
+  if (!stream || std::memcmp(magic, Magic, sizeof(Magic)) != 0)
+  {
+    mitkThrowException(mitk::IGTIOException) << "Stream is not a NavigationDataSet binary file.";
+  }
+
+  const std::uint32_t version = ReadValue<std::uint32_t>(stream);
+  if (version != Version)
+  {
+    mitkThrowException(mitk::IGTIOException) << "Unsupported NavigationDataSet binary version " << version << ".";
+  }
+
+  if (ReadValue<std::uint32_t>(stream) != ByteOrderMark)
+  {
+    mitkThrowException(mitk::IGTIOException) << "NavigationDataSet binary file was written with a different byte order.";
+  }
+
+  Header header;
+  const std::uint32_t numberOfTools = ReadValue<std::uint32_t>(stream);
+  header.m_CovariancePerRecord = (ReadValue<std::uint32_t>(stream) & CovariancePerRecordFlag) != 0;
+  header.m_HeaderSize = ReadValue<std::uint64_t>(stream);
+
+  std::size_t namesSize = 0;
+  for (std::uint32_t i = 0; i < numberOfTools; ++i)
+  {
+    const std::uint32_t length = ReadValue<std::uint32_t>(stream);
+    std::string name(length, '\0');
+    stream.read(&name[0], length);
+    header.m_ToolNames.push_back(name);
+    namesSize += sizeof(std::uint32_t) + length;
+  }
+
+  const std::size_t fixedSize = sizeof(Magic) + 4 * sizeof(std::uint32_t) + sizeof(std::uint64_t);
+  stream.ignore(PaddingTo8(fixedSize + namesSize));
+
+  if (!header.m_CovariancePerRecord)
+  {
+    for (std::uint32_t i = 0; i < numberOfTools; ++i)
+    {
+      NavigationData::CovarianceMatrixType covariance;
+      stream.read(reinterpret_cast<char*>(covariance.GetVnlMatrix().data_block()), CovarianceSize * sizeof(double));
+      header.m_ToolCovariances.push_back(covariance);
+    }
+  }
+
+  if (!stream)
+  {
+    mitkThrowException(mitk::IGTIOException) << "Unexpected end of NavigationDataSet binary header.";
+  }
+
+  return header;
+}
+
+std::size_t mitk::NavigationDataSetBinaryFormat::GetRecordSize(bool covariancePerRecord)
+{
+  return BasicRecordSize + (covariancePerRecord ? CovarianceSize * sizeof(double) : 0);
+}
+
+std::size_t mitk::NavigationDataSetBinaryFormat::GetTimeStepSize(const Header& header)
+{
+  return header.m_ToolNames.size() * GetRecordSize(header.m_CovariancePerRecord);
+}
+
+void mitk::NavigationDataSetBinaryFormat::WriteTimeStep(std::ostream& stream, const Header& header,
+  const std::vector<NavigationData::Pointer>& navigationDatas)
+{
+  if (navigationDatas.size() != header.m_ToolNames.size())
+  {
+    mitkThrowException(mitk::IGTIOException) << "Time step has " << navigationDatas.size()
+      << " navigation datas, file has " << header.m_ToolNames.size() << " tools.";
+  }
+
+  const std::size_t recordSize = GetRecordSize(header.m_CovariancePerRecord);
+  std::vector<char> buffer(GetTimeStepSize(header));
+
+  for (std::size_t i = 0; i < navigationDatas.size(); ++i)
+  {
+    const NavigationData* nd = navigationDatas[i];
+    const NavigationData::PositionType position = nd->GetPosition();
+    const NavigationData::OrientationType orientation = nd->GetOrientation();
+    const NavigationData::CovarianceMatrixType covariance = nd->GetCovErrorMatrix();
+    const double orientationValues[4] = { orientation[0], orientation[1], orientation[2], orientation[3] };
+
+    unsigned char flags = 0;
+    if (nd->IsDataValid()) flags |= NavigationDataSet::DataValidFlag;
+    if (nd->GetHasPosition()) flags |= NavigationDataSet::HasPositionFlag;
+    if (nd->GetHasOrientation()) flags |= NavigationDataSet::HasOrientationFlag;
+
+    PackRecord(&buffer[i * recordSize], header.m_CovariancePerRecord, nd->GetIGTTimeStamp(), position.GetDataPointer(),
+      orientationValues, flags, covariance.GetVnlMatrix().data_block());
+  }
+
+  stream.write(buffer.data(), buffer.size());
+  if (!stream)
+  {
+    mitkThrowException(mitk::IGTIOException) << "Could not write NavigationDataSet time step.";
+  }
+}
+
+void mitk::NavigationDataSetBinaryFormat::PackRecord(char* record, bool covariancePerRecord, double timeStamp,
+  const double* position, const double* orientation, unsigned char flags, const double* covariance)
+{
+  std::memcpy(record, &timeStamp, sizeof(double));
+  record += sizeof(double);
+  std::memcpy(record, position, 3 * sizeof(double));
+  record += 3 * sizeof(double);
+  std::memcpy(record, orientation, 4 * sizeof(double));
+  record += 4 * sizeof(double);
+  const std::uint64_t flagValue = flags;
+  std::memcpy(record, &flagValue, sizeof(std::uint64_t));
+  record += sizeof(std::uint64_t);
+
+  if (covariancePerRecord)
+  {
+    std::memcpy(record, covariance, CovarianceSize * sizeof(double));
+  }
+}
+
+void mitk::NavigationDataSetBinaryFormat::UnpackRecord(const char* record, bool covariancePerRecord,
+  const NavigationData::CovarianceMatrixType& constantCovariance, NavigationData* navigationData)
+{
+  double timeStamp;
+  double values[7];
+  std::uint64_t flags;
+
+  std::memcpy(&timeStamp, record, sizeof(double));
+  record += sizeof(double);
+  std::memcpy(values, record, 7 * sizeof(double));
+  record += 7 * sizeof(double);
+  std::memcpy(&flags, record, sizeof(std::uint64_t));
+  record += sizeof(std::uint64_t);
+
+  NavigationData::PositionType position(values);
+  NavigationData::OrientationType orientation(values[3], values[4], values[5], values[6]);
+
+  navigationData->SetIGTTimeStamp(timeStamp);
+  navigationData->SetPosition(position);
+  navigationData->SetOrientation(orientation);
+  navigationData->SetDataValid((flags & NavigationDataSet::DataValidFlag) != 0);
+  navigationData->SetHasPosition((flags & NavigationDataSet::HasPositionFlag) != 0);
+  navigationData->SetHasOrientation((flags & NavigationDataSet::HasOrientationFlag) != 0);
+
+  if (covariancePerRecord)
+  {
+    NavigationData::CovarianceMatrixType covariance;
+    std::memcpy(covariance.GetVnlMatrix().data_block(), record, CovarianceSize * sizeof(double));
+    navigationData->SetCovErrorMatrix(covariance);
+  }
+  else
+  {
+    navigationData->SetCovErrorMatrix(constantCovariance);
+  }
+}
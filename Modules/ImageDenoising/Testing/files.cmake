@@ -1,3 +1,4 @@
 set(MODULE_TESTS
   itkTotalVariationDenoisingImageFilterTest.cpp
+  mitkBilateralFilterTest.cpp
 )
@@ -204,6 +204,57 @@ int itkTotalVariationDenoisingImageFilterTest(int /*argc*/, char * /*argv*/ [])
     return EXIT_FAILURE;
   }
 
+  try
+  {
+    // a multi-threaded run over several slices matches chained single iterations
+    ImageType::Pointer volume = ImageType::New();
+    ImageType::RegionType region;
+    ImageType::SizeType size = {{7, 6, 5}};
+    region.SetSize(size);
+    volume->SetRegions(region);
+    volume->Allocate();
+    unsigned int seed = 1;
+    for (IteratorType it(volume, region); !it.IsAtEnd(); ++it)
+    {
+      seed = seed * 1103515245 + 12345;
+      it.Set((seed >> 16) % 100);
+    }
+
+    ImageType::Pointer expected = volume;
+    for (int i = 0; i < 4; i++)
+    {
+      typedef itk::TotalVariationSingleIterationImageFilter<ImageType, ImageType> SingleFilterType;
+      SingleFilterType::Pointer sFilter = SingleFilterType::New();
+      sFilter->SetInput(expected);
+      sFilter->SetOriginalImage(volume);
+      sFilter->SetLambda(0.1);
+      sFilter->UpdateLargestPossibleRegion();
+      expected = sFilter->GetOutput();
+    }
+
+    typedef itk::TotalVariationDenoisingImageFilter<ImageType, ImageType> TVFilterType;
+    TVFilterType::Pointer tvFilter = TVFilterType::New();
+    tvFilter->SetInput(volume);
+    tvFilter->SetNumberIterations(4);
+    tvFilter->SetNumberOfThreads(3);
+    tvFilter->SetLambda(0.1);
+    tvFilter->Update();
+
+    IteratorType eit(expected, region);
+    IteratorType oit(tvFilter->GetOutput(), region);
+    for (; !eit.IsAtEnd(); ++eit, ++oit)
+    {
+      if (fabs(eit.Get() - oit.Get()) > 1e-4)
+      {
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  catch (...)
+  {
+    return EXIT_FAILURE;
+  }
+
   VectorImageType::Pointer vecImage = GenerateVectorTestImage();
   PrintVectorImage(vecImage);
 
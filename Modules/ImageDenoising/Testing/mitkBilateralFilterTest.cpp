@@ -0,0 +1,109 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include <mitkBilateralFilter.h>
+#include <mitkITKImageImport.h>
+#include <mitkImageCast.h>
+#include <mitkTestFixture.h>
+
+#include <itkImageRegionIterator.h>
+
+#include <random>
+
+class mitkBilateralFilterTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkBilateralFilterTestSuite);
+  MITK_TEST(FastApproximation_ConstantImage_RemainsConstant);
+  MITK_TEST(FastApproximation_NoisyEdge_MatchesExactFilter);
+  MITK_TEST(FastApproximation_RefinedLattice_IsMoreAccurate);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef itk::Image<float, 3> ImageType;
+
+  /** Two halves of intensity 100 and 300 with gaussian noise */
+  static mitk::Image::Pointer CreateNoisyEdge(float noise)
+  {
+    ImageType::Pointer image = ImageType::New();
+    ImageType::SizeType size = {{24, 20, 10}};
+    image->SetRegions(ImageType::RegionType(size));
+    image->Allocate();
+
+    std::mt19937 generator(1);
+    std::normal_distribution<float> distribution(0.0f, noise);
+    for (itk::ImageRegionIterator<ImageType> it(image, image->GetLargestPossibleRegion()); !it.IsAtEnd(); ++it)
+      it.Set((it.GetIndex()[0] < 12 ? 100.0f : 300.0f) + distribution(generator));
+
+    return mitk::GrabItkImageMemory(image);
+  }
+
+  static mitk::Image::Pointer Filter(mitk::Image *image, bool fast, unsigned int refinement = 1)
+  {
+    mitk::BilateralFilter::Pointer filter = mitk::BilateralFilter::New();
+    filter->SetInput(image);
+    filter->SetDomainSigma(2.0f);
+    filter->SetRangeSigma(50.0f);
+    filter->SetUseFastApproximation(fast);
+    filter->SetLatticeRefinement(refinement);
+    filter->Update();
+    return filter->GetOutput();
+  }
+
+  static double GetMeanAbsoluteDifference(mitk::Image *image1, mitk::Image *image2)
+  {
+    ImageType::Pointer itkImage1, itkImage2;
+    mitk::CastToItkImage(image1, itkImage1);
+    mitk::CastToItkImage(image2, itkImage2);
+
+    double difference = 0;
+    itk::ImageRegionIterator<ImageType> it1(itkImage1, itkImage1->GetLargestPossibleRegion());
+    itk::ImageRegionIterator<ImageType> it2(itkImage2, itkImage2->GetLargestPossibleRegion());
+    for (; !it1.IsAtEnd(); ++it1, ++it2)
+      difference += std::abs(it1.Get() - it2.Get());
+    return difference / itkImage1->GetLargestPossibleRegion().GetNumberOfPixels();
+  }
+
+public:
+  void FastApproximation_ConstantImage_RemainsConstant()
+  {
+    mitk::Image::Pointer image = CreateNoisyEdge(0.0f);
+    mitk::Image::Pointer result = Filter(image, true);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, GetMeanAbsoluteDifference(image, result), 0.01);
+  }
+
+  void FastApproximation_NoisyEdge_MatchesExactFilter()
+  {
+    mitk::Image::Pointer image = CreateNoisyEdge(10.0f);
+    mitk::Image::Pointer exact = Filter(image, false);
+    mitk::Image::Pointer fast = Filter(image, true);
+
+    // the edge is kept and the noise is removed like the exact filter does
+    CPPUNIT_ASSERT(GetMeanAbsoluteDifference(image, fast) > 5.0);
+    CPPUNIT_ASSERT(GetMeanAbsoluteDifference(exact, fast) < 1.0);
+  }
+
+  void FastApproximation_RefinedLattice_IsMoreAccurate()
+  {
+    mitk::Image::Pointer image = CreateNoisyEdge(10.0f);
+    mitk::Image::Pointer exact = Filter(image, false);
+
+    CPPUNIT_ASSERT(GetMeanAbsoluteDifference(exact, Filter(image, true, 2)) <
+                   GetMeanAbsoluteDifference(exact, Filter(image, true, 1)));
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkBilateralFilter)
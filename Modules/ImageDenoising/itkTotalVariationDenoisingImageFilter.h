@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkCastImageFilter.h"
 #include "itkImage.h"
 #include "itkImageToImageFilter.h"
+#include "itkMultiThreader.h"
 #include "itkTotalVariationSingleIterationImageFilter.h"
 
 namespace itk
@@ -29,6 +30,11 @@ namespace itk
    *
    * Reference: Tony F. Chan et al., The digital TV filter and nonlinear denoising
    *
+   * Computes the same iterations as chaining TotalVariationSingleIterationImageFilter, but each iteration is a
+   * single multi-threaded pass which computes the local variation on the fly. Every thread keeps the local
+   * variation of three slices only, and the iterations alternate between the output buffer and one further
+   * buffer, so no images are allocated while iterating.
+   *
    * \sa Image
    * \sa Neighborhood
    * \sa NeighborhoodOperator
@@ -86,10 +92,20 @@ namespace itk
 
     void GenerateData() override;
 
+    /** Computes the slices of the current iteration assigned to the given thread, slices being taken along the
+     * last image dimension. */
+    void ThreadedIteration(ThreadIdType threadId, ThreadIdType numberOfThreads);
+
+    static ITK_THREAD_RETURN_TYPE IterationCallback(void *arg);
+
     double m_Lambda;
 
     int m_NumberIterations;
 
+    const OutputPixelType *m_OriginalBuffer;
+    const OutputPixelType *m_CurrentBuffer;
+    OutputPixelType *m_NextBuffer;
+
   private:
     TotalVariationDenoisingImageFilter(const Self &); // purposely not implemented
     void operator=(const Self &);                     // purposely not implemented
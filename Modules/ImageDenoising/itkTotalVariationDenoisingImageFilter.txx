@@ -23,15 +23,7 @@ This file is based heavily on a corresponding ITK filter.
 #define _itkTotalVariationDenoisingImageFilter_txx
 #include "itkTotalVariationDenoisingImageFilter.h"
 
-#include "itkConstShapedNeighborhoodIterator.h"
-#include "itkImageRegionConstIterator.h"
-#include "itkImageRegionIterator.h"
 #include "itkLocalVariationImageFilter.h"
-#include "itkNeighborhoodAlgorithm.h"
-#include "itkNeighborhoodInnerProduct.h"
-#include "itkOffset.h"
-#include "itkProgressReporter.h"
-#include "itkZeroFluxNeumannBoundaryCondition.h"
 
 #include <algorithm>
 #include <vector>
@@ -40,58 +32,183 @@ namespace itk
 {
   template <class TInputImage, class TOutputImage>
   TotalVariationDenoisingImageFilter<TInputImage, TOutputImage>::TotalVariationDenoisingImageFilter()
+    : m_Lambda(1.0), m_NumberIterations(1), m_OriginalBuffer(nullptr), m_CurrentBuffer(nullptr), m_NextBuffer(nullptr)
   {
-    m_Lambda = 1.0;
   }
 
   template <class TInputImage, class TOutputImage>
   void TotalVariationDenoisingImageFilter<TInputImage, TOutputImage>::GenerateData()
   {
-    // first we cast the input image to match output type
+    // the input cast to the output type is kept as reference
     typename CastType::Pointer infilter = CastType::New();
     infilter->SetInput(this->GetInput());
     infilter->Update();
-    typename TOutputImage::Pointer image = infilter->GetOutput();
-
-    // a second copy of the input image is saved as reference
-    infilter = CastType::New();
-    infilter->SetInput(this->GetInput());
-    infilter->Update();
     typename TOutputImage::Pointer origImage = infilter->GetOutput();
 
-    typename SingleIterationFilterType::Pointer filter;
-    for (int i = 0; i < m_NumberIterations; i++)
+    typename OutputImageType::Pointer output = this->GetOutput();
+    output->SetSpacing(origImage->GetSpacing());
+    output->SetLargestPossibleRegion(origImage->GetLargestPossibleRegion());
+    output->SetBufferedRegion(origImage->GetLargestPossibleRegion());
+    output->Allocate();
+
+    const SizeValueType numberOfPixels = origImage->GetLargestPossibleRegion().GetNumberOfPixels();
+    const int numberOfIterations = std::max(0, m_NumberIterations);
+
+    // the iterations alternate between both buffers, starting such that the last one writes the output
+    std::vector<OutputPixelType> temporaryBuffer(numberOfIterations > 0 ? numberOfPixels : 0);
+    OutputPixelType *buffers[2] = {output->GetBufferPointer(), temporaryBuffer.data()};
+    const int first = numberOfIterations % 2;
+    std::copy(origImage->GetBufferPointer(), origImage->GetBufferPointer() + numberOfPixels, buffers[first]);
+
+    m_OriginalBuffer = origImage->GetBufferPointer();
+    this->GetMultiThreader()->SetNumberOfThreads(this->GetNumberOfThreads());
+    this->GetMultiThreader()->SetSingleMethod(IterationCallback, this);
+
+    for (int i = 0; i < numberOfIterations; i++)
     {
-      filter = SingleIterationFilterType::New();
-      filter->SetInput(image);
-      filter->SetOriginalImage(origImage);
-      filter->SetLambda(m_Lambda);
-      filter->SetNumberOfThreads(this->GetNumberOfThreads());
-      filter->UpdateLargestPossibleRegion();
-      image = filter->GetOutput();
-      std::cout << "Iteration " << i + 1 << "/" << m_NumberIterations << std::endl;
+      m_CurrentBuffer = buffers[(first + i) % 2];
+      m_NextBuffer = buffers[(first + i + 1) % 2];
+      this->GetMultiThreader()->SingleMethodExecute();
+      this->UpdateProgress(static_cast<float>(i + 1) / numberOfIterations);
     }
 
-    typename OutputImageType::Pointer output = this->GetOutput();
-    output->SetSpacing(image->GetSpacing());
-    typename OutputImageType::RegionType largestPossibleRegion;
-    largestPossibleRegion.SetSize(image->GetLargestPossibleRegion().GetSize());
-    largestPossibleRegion.SetIndex(image->GetLargestPossibleRegion().GetIndex());
-    output->SetLargestPossibleRegion(image->GetLargestPossibleRegion());
-    output->SetBufferedRegion(image->GetLargestPossibleRegion());
-    output->Allocate();
+    m_OriginalBuffer = nullptr;
+    m_CurrentBuffer = nullptr;
+    m_NextBuffer = nullptr;
+  }
 
-    itk::ImageRegionIterator<OutputImageType> oit(output, output->GetLargestPossibleRegion());
-    oit.GoToBegin();
+  template <class TInputImage, class TOutputImage>
+  ITK_THREAD_RETURN_TYPE TotalVariationDenoisingImageFilter<TInputImage, TOutputImage>::IterationCallback(void *arg)
+  {
+    MultiThreader::ThreadInfoStruct *info = static_cast<MultiThreader::ThreadInfoStruct *>(arg);
+    static_cast<Self *>(info->UserData)->ThreadedIteration(info->ThreadID, info->NumberOfThreads);
+    return ITK_THREAD_RETURN_VALUE;
+  }
 
-    itk::ImageRegionConstIterator<OutputImageType> iit(image, image->GetLargestPossibleRegion());
-    iit.GoToBegin();
+  template <class TInputImage, class TOutputImage>
+  void TotalVariationDenoisingImageFilter<TInputImage, TOutputImage>::ThreadedIteration(ThreadIdType threadId,
+                                                                                       ThreadIdType numberOfThreads)
+  {
+    const unsigned int dimension = OutputImageDimension;
+    const typename OutputImageType::SizeType size = this->GetOutput()->GetLargestPossibleRegion().GetSize();
 
-    while (!oit.IsAtEnd())
+    // voxels of one slice are contiguous, the slices are taken along the last dimension
+    OffsetValueType strides[OutputImageDimension];
+    OffsetValueType sliceSize = 1;
+    for (unsigned int d = 0; d < dimension - 1; ++d)
+    {
+      strides[d] = sliceSize;
+      sliceSize *= size[d];
+    }
+    strides[dimension - 1] = sliceSize;
+    const OffsetValueType numberOfSlices = size[dimension - 1];
+
+    const OffsetValueType firstSlice = numberOfSlices * threadId / numberOfThreads;
+    const OffsetValueType endSlice = numberOfSlices * (threadId + 1) / numberOfThreads;
+    if (firstSlice >= endSlice)
+      return;
+
+    const OutputPixelType *orig = m_OriginalBuffer;
+    const OutputPixelType *input = m_CurrentBuffer;
+    OutputPixelType *output = m_NextBuffer;
+
+    // calls function(offsetInSlice, neighbours) for all voxels of a slice. The neighbours hold the offsets in
+    // the slice of the previous and next voxel along each dimension but the last, clamped at the image border
+    // like the zero flux Neumann boundary condition does.
+    auto forEachVoxelInSlice = [&](auto function) {
+      OffsetValueType index[OutputImageDimension] = {0};
+      OffsetValueType neighbours[2 * OutputImageDimension];
+      for (OffsetValueType q = 0; q < sliceSize; ++q)
+      {
+        for (unsigned int d = 0; d < dimension - 1; ++d)
+        {
+          neighbours[2 * d] = index[d] > 0 ? q - strides[d] : q;
+          neighbours[2 * d + 1] = index[d] + 1 < static_cast<OffsetValueType>(size[d]) ? q + strides[d] : q;
+        }
+
+        function(q, neighbours);
+
+        for (unsigned int d = 0; d < dimension - 1 && ++index[d] == static_cast<OffsetValueType>(size[d]); ++d)
+          index[d] = 0;
+      }
+    };
+
+    // local variation of the slices z - 1, z and z + 1, slice z being stored at z % 3
+    std::vector<float> localVariation[3];
+    OffsetValueType storedSlices[3] = {-1, -1, -1};
+
+    auto computeLocalVariation = [&](OffsetValueType z) {
+      std::vector<float> &slice = localVariation[z % 3];
+      if (storedSlices[z % 3] == z)
+        return;
+      storedSlices[z % 3] = z;
+      slice.resize(sliceSize);
+
+      const OutputPixelType *u = input + z * sliceSize;
+      const OutputPixelType *previous = input + (z > 0 ? z - 1 : z) * sliceSize;
+      const OutputPixelType *next = input + (z + 1 < numberOfSlices ? z + 1 : z) * sliceSize;
+
+      forEachVoxelInSlice([&](OffsetValueType q, const OffsetValueType *neighbours) {
+        float locVariation = 0;
+        for (unsigned int n = 0; n < 2 * (dimension - 1); ++n)
+        {
+          OutputPixelType diffVec = u[neighbours[n]] - u[q];
+          locVariation += SquaredEuclideanMetric<OutputPixelType>::Calc(diffVec);
+        }
+        OutputPixelType diffVec = previous[q] - u[q];
+        locVariation += SquaredEuclideanMetric<OutputPixelType>::Calc(diffVec);
+        diffVec = next[q] - u[q];
+        locVariation += SquaredEuclideanMetric<OutputPixelType>::Calc(diffVec);
+        slice[q] = sqrt(locVariation + 0.0001);
+      });
+    };
+
+    for (OffsetValueType z = firstSlice; z < endSlice; ++z)
     {
-      oit.Set(iit.Get());
-      ++iit;
-      ++oit;
+      const OffsetValueType zPrevious = z > 0 ? z - 1 : z;
+      const OffsetValueType zNext = z + 1 < numberOfSlices ? z + 1 : z;
+      computeLocalVariation(zPrevious);
+      computeLocalVariation(z);
+      computeLocalVariation(zNext);
+
+      const float *lv = localVariation[z % 3].data();
+      const float *lvPrevious = localVariation[zPrevious % 3].data();
+      const float *lvNext = localVariation[zNext % 3].data();
+      const OutputPixelType *u = input + z * sliceSize;
+      const OutputPixelType *uPrevious = input + zPrevious * sliceSize;
+      const OutputPixelType *uNext = input + zNext * sliceSize;
+      const OutputPixelType *u0 = orig + z * sliceSize;
+      OutputPixelType *result = output + z * sliceSize;
+
+      forEachVoxelInSlice([&](OffsetValueType q, const OffsetValueType *neighbours) {
+        //   1 / ||nabla_alpha(u)||_a
+        const double locvar_alpha_inv = 1.0 / lv[q];
+
+        // w_alphabeta(u) =
+        //   1 / ||nabla_alpha(u)||_a + 1 / ||nabla_beta(u)||_a
+        double ws[2 * OutputImageDimension];
+        double wsum = 0;
+        for (unsigned int n = 0; n < 2 * (dimension - 1); ++n)
+        {
+          ws[n] = locvar_alpha_inv + (1.0 / (double)lv[neighbours[n]]);
+          wsum += ws[n];
+        }
+        ws[2 * dimension - 2] = locvar_alpha_inv + (1.0 / (double)lvPrevious[q]);
+        ws[2 * dimension - 1] = locvar_alpha_inv + (1.0 / (double)lvNext[q]);
+        wsum += ws[2 * dimension - 2] + ws[2 * dimension - 1];
+
+        // h_alphaalpha * u_alpha^zero
+        OutputPixelType res =
+          static_cast<OutputPixelType>(((OutputPixelType)u0[q]) * (m_Lambda / (m_Lambda + wsum)));
+
+        // add the different h_alphabeta * u_beta
+        for (unsigned int n = 0; n < 2 * (dimension - 1); ++n)
+          res += u[neighbours[n]] * (ws[n] / (m_Lambda + wsum));
+        res += uPrevious[q] * (ws[2 * dimension - 2] / (m_Lambda + wsum));
+        res += uNext[q] * (ws[2 * dimension - 1] / (m_Lambda + wsum));
+
+        result[q] = res;
+      });
     }
   }
 
@@ -18,9 +18,220 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkImageAccessByItk.h"
 #include "mitkImageCast.h"
 #include <itkBilateralImageFilter.h>
+#include <mitkTaskScheduler.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+  /** Sparse permutohedral lattice of dimension D holding a value and a weight per vertex. The vertices found while
+   * splatting are kept in a hash table. A point of the lattice has D + 1 integer coordinates summing to zero,
+   * the last one is not stored. */
+  template <unsigned int D>
+  class PermutohedralLattice
+  {
+  public:
+    typedef std::array<int, D> KeyType;
+
+    /** The vertices of the simplex enclosing a position and their barycentric weights */
+    struct Simplex
+    {
+      KeyType Keys[D + 1];
+      float Weights[D + 1];
+    };
+
+    PermutohedralLattice() : m_Table(64, -1)
+    {
+      // the features are scaled such that one blur pass corresponds to a gaussian with a standard deviation of 1
+      for (unsigned int i = 0; i < D; ++i)
+        m_ScaleFactors[i] = (D + 1) * std::sqrt(2.0 / 3.0) / std::sqrt((i + 1.0) * (i + 2.0));
+
+      for (unsigned int i = 0; i <= D; ++i)
+      {
+        for (unsigned int j = 0; j <= D - i; ++j)
+          m_Canonical[i][j] = i;
+        for (unsigned int j = D - i + 1; j <= D; ++j)
+          m_Canonical[i][j] = static_cast<int>(i) - static_cast<int>(D + 1);
+      }
+    }
+
+    void FindSimplex(const double *position, Simplex &simplex) const
+    {
+      // elevates the position onto the hyperplane of the lattice
+      double elevated[D + 1];
+      double sum = 0;
+      for (unsigned int j = D; j > 0; --j)
+      {
+        const double scaled = position[j - 1] * m_ScaleFactors[j - 1];
+        elevated[j] = sum - j * scaled;
+        sum += scaled;
+      }
+      elevated[0] = sum;
+
+      // the closest lattice point of remainder 0
+      int rem0[D + 1];
+      int coordinateSum = 0;
+      for (unsigned int i = 0; i <= D; ++i)
+      {
+        const double v = elevated[i] / (D + 1);
+        const double up = std::ceil(v) * (D + 1);
+        const double down = std::floor(v) * (D + 1);
+        rem0[i] = static_cast<int>(up - elevated[i] < elevated[i] - down ? up : down);
+        coordinateSum += rem0[i] / static_cast<int>(D + 1);
+      }
+
+      // the ordering of the differences determines the enclosing simplex
+      int rank[D + 1] = {0};
+      for (unsigned int i = 0; i < D; ++i)
+      {
+        const double di = elevated[i] - rem0[i];
+        for (unsigned int j = i + 1; j <= D; ++j)
+        {
+          if (di < elevated[j] - rem0[j])
+            ++rank[i];
+          else
+            ++rank[j];
+        }
+      }
+
+      // moves the point of remainder 0 back onto the hyperplane if the coordinates do not sum to zero
+      for (unsigned int i = 0; i <= D; ++i)
+      {
+        rank[i] += coordinateSum;
+        if (rank[i] < 0)
+        {
+          rank[i] += D + 1;
+          rem0[i] += D + 1;
+        }
+        else if (rank[i] > static_cast<int>(D))
+        {
+          rank[i] -= D + 1;
+          rem0[i] -= D + 1;
+        }
+      }
+
+      double barycentric[D + 2] = {0};
+      for (unsigned int i = 0; i <= D; ++i)
+      {
+        const double v = (elevated[i] - rem0[i]) / (D + 1);
+        barycentric[D - rank[i]] += v;
+        barycentric[D - rank[i] + 1] -= v;
+      }
+      barycentric[0] += 1.0 + barycentric[D + 1];
+
+      for (unsigned int remainder = 0; remainder <= D; ++remainder)
+      {
+        for (unsigned int i = 0; i < D; ++i)
+          simplex.Keys[remainder][i] = rem0[i] + m_Canonical[remainder][rank[i]];
+        simplex.Weights[remainder] = static_cast<float>(barycentric[remainder]);
+      }
+    }
+
+    /** Index of the vertex or -1 if it was never splatted to */
+    int Find(const KeyType &key) const
+    {
+      const std::size_t mask = m_Table.size() - 1;
+      for (std::size_t h = Hash(key) & mask;; h = (h + 1) & mask)
+      {
+        const int index = m_Table[h];
+        if (index < 0 || m_Keys[index] == key)
+          return index;
+      }
+    }
+
+    int FindOrInsert(const KeyType &key)
+    {
+      if (2 * (m_Keys.size() + 1) > m_Table.size())
+        this->Grow();
+
+      const std::size_t mask = m_Table.size() - 1;
+      std::size_t h = Hash(key) & mask;
+      for (; m_Table[h] >= 0; h = (h + 1) & mask)
+      {
+        if (m_Keys[m_Table[h]] == key)
+          return m_Table[h];
+      }
+
+      m_Table[h] = static_cast<int>(m_Keys.size());
+      m_Keys.push_back(key);
+      Values.push_back(0.0f);
+      Values.push_back(0.0f);
+      return m_Table[h];
+    }
+
+    void Splat(const Simplex &simplex, float value)
+    {
+      for (unsigned int i = 0; i <= D; ++i)
+      {
+        const int index = this->FindOrInsert(simplex.Keys[i]);
+        Values[2 * index] += simplex.Weights[i] * value;
+        Values[2 * index + 1] += simplex.Weights[i];
+      }
+    }
+
+    std::size_t GetNumberOfVertices() const { return m_Keys.size(); }
+    const KeyType &GetKey(std::size_t index) const { return m_Keys[index]; }
+
+    /** The value and the weight of each vertex */
+    std::vector<float> Values;
+
+  private:
+    static std::size_t Hash(const KeyType &key)
+    {
+      std::size_t hash = 0;
+      for (unsigned int i = 0; i < D; ++i)
+        hash = (hash + static_cast<std::size_t>(key[i])) * 2531011;
+      return hash ^ (hash >> 17);
+    }
+
+    void Grow()
+    {
+      m_Table.assign(2 * m_Table.size(), -1);
+      const std::size_t mask = m_Table.size() - 1;
+      for (std::size_t index = 0; index < m_Keys.size(); ++index)
+      {
+        std::size_t h = Hash(m_Keys[index]) & mask;
+        while (m_Table[h] >= 0)
+          h = (h + 1) & mask;
+        m_Table[h] = static_cast<int>(index);
+      }
+    }
+
+    double m_ScaleFactors[D];
+    int m_Canonical[D + 1][D + 1];
+    std::vector<KeyType> m_Keys;
+    std::vector<int> m_Table;
+  };
+
+  template <typename TFunction>
+  void ParallelFor(std::size_t size, std::size_t numberOfChunks, const TFunction &function)
+  {
+    numberOfChunks = std::max<std::size_t>(1, std::min(size, numberOfChunks));
+    const std::size_t chunkSize = (size + numberOfChunks - 1) / numberOfChunks;
+
+    std::vector<mitk::TaskScheduler::TaskPointer> tasks;
+    for (std::size_t chunk = 0, begin = 0; begin < size; ++chunk, begin += chunkSize)
+    {
+      const std::size_t end = std::min(size, begin + chunkSize);
+      tasks.push_back(
+        mitk::TaskScheduler::GetInstance()->Submit([&function, chunk, begin, end]() { function(chunk, begin, end); }));
+    }
+
+    for (const auto &task : tasks)
+      task->Wait();
+  }
+}
 
 mitk::BilateralFilter::BilateralFilter()
-  : m_DomainSigma(2.0f), m_RangeSigma(50.0f), m_AutoKernel(true), m_KernelRadius(1u)
+  : m_DomainSigma(2.0f),
+    m_RangeSigma(50.0f),
+    m_AutoKernel(true),
+    m_KernelRadius(1u),
+    m_UseFastApproximation(false),
+    m_LatticeRefinement(1u)
 {
   // default parameters DomainSigma: 2 , RangeSigma: 50, AutoKernel: true, KernelRadius: 1
 }
@@ -64,6 +275,12 @@ void mitk::BilateralFilter::GenerateData()
 template <typename TPixel, unsigned int VImageDimension>
 void mitk::BilateralFilter::ItkImageProcessing(const itk::Image<TPixel, VImageDimension> *itkImage)
 {
+  if (m_UseFastApproximation)
+  {
+    this->FastApproximation(itkImage);
+    return;
+  }
+
   // ITK Image type given from the input image
   typedef itk::Image<TPixel, VImageDimension> ItkImageType;
   // bilateral filter with same type
@@ -85,6 +302,164 @@ void mitk::BilateralFilter::ItkImageProcessing(const itk::Image<TPixel, VImageDi
   mitk::CastToMitkImage(bilateralFilter->GetOutput(), resultImage);
 }
 
+template <typename TPixel, unsigned int VImageDimension>
+void mitk::BilateralFilter::FastApproximation(const itk::Image<TPixel, VImageDimension> *itkImage)
+{
+  typedef itk::Image<TPixel, VImageDimension> ItkImageType;
+  // the lattice is spanned by the position and the intensity
+  typedef PermutohedralLattice<VImageDimension + 1> LatticeType;
+
+  if (m_DomainSigma <= 0 || m_RangeSigma <= 0)
+  {
+    itkExceptionMacro("mitk::BilateralFilter: the fast approximation requires positive sigmas.");
+  }
+
+  const typename ItkImageType::RegionType region = itkImage->GetBufferedRegion();
+  const std::size_t numberOfPixels = region.GetNumberOfPixels();
+  const TPixel *input = itkImage->GetBufferPointer();
+  const double refinement = std::max(1u, m_LatticeRefinement);
+
+  // The position of a voxel in units of the sigmas. On a lattice refined by r, the blur is repeated r^2 times.
+  // Each blur pass has a standard deviation of sqrt(3) / 2 lattice units and splatting and slicing add a variance
+  // of about 1 / 4, hence the features are scaled such that the whole kernel keeps a standard deviation of 1.
+  const double featureScale = std::sqrt(0.75 * refinement * refinement + 0.25);
+  double positionScales[VImageDimension + 1];
+  for (unsigned int d = 0; d < VImageDimension; ++d)
+    positionScales[d] = itkImage->GetSpacing()[d] / m_DomainSigma * featureScale;
+  positionScales[VImageDimension] = featureScale / m_RangeSigma;
+
+  const LatticeType geometry;
+  auto findSimplex = [&](std::size_t offset, typename LatticeType::Simplex &simplex) {
+    double position[VImageDimension + 1];
+    position[VImageDimension] = static_cast<double>(input[offset]) * positionScales[VImageDimension];
+    for (unsigned int d = 0; d < VImageDimension; ++d)
+    {
+      position[d] = (offset % region.GetSize(d)) * positionScales[d];
+      offset /= region.GetSize(d);
+    }
+    geometry.FindSimplex(position, simplex);
+  };
+
+  mitk::TaskScheduler *scheduler = mitk::TaskScheduler::GetInstance();
+  const std::size_t numberOfChunks = 4 * scheduler->GetNumberOfThreads();
+
+  // splat: every thread fills a lattice of its own, which are merged afterwards. The threads work on slabs of
+  // the image, so that their lattices share few vertices.
+  std::vector<LatticeType> partialLattices(scheduler->GetNumberOfThreads());
+  ParallelFor(numberOfPixels, partialLattices.size(), [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+    typename LatticeType::Simplex simplex;
+    for (std::size_t offset = begin; offset < end; ++offset)
+    {
+      findSimplex(offset, simplex);
+      partialLattices[chunk].Splat(simplex, static_cast<float>(input[offset]));
+    }
+  });
+
+  LatticeType lattice(std::move(partialLattices[0]));
+  for (std::size_t chunk = 1; chunk < partialLattices.size(); ++chunk)
+  {
+    const LatticeType &partialLattice = partialLattices[chunk];
+    for (std::size_t vertex = 0; vertex < partialLattice.GetNumberOfVertices(); ++vertex)
+    {
+      const int index = lattice.FindOrInsert(partialLattice.GetKey(vertex));
+      lattice.Values[2 * index] += partialLattice.Values[2 * vertex];
+      lattice.Values[2 * index + 1] += partialLattice.Values[2 * vertex + 1];
+    }
+    partialLattices[chunk] = LatticeType();
+  }
+
+  // blur: a [1 2 1] kernel along each direction of the lattice, repeated to widen the gaussian on a refined lattice
+  const unsigned int numberOfPasses = static_cast<unsigned int>(refinement * refinement);
+  const unsigned int latticeDimension = VImageDimension + 1;
+  auto getNeighbours = [latticeDimension](const typename LatticeType::KeyType &key,
+                                          unsigned int direction,
+                                          typename LatticeType::KeyType &previous,
+                                          typename LatticeType::KeyType &next) {
+    for (unsigned int i = 0; i < latticeDimension; ++i)
+    {
+      previous[i] = key[i] + 1;
+      next[i] = key[i] - 1;
+    }
+    if (direction < latticeDimension)
+    {
+      previous[direction] = key[direction] - latticeDimension;
+      next[direction] = key[direction] + latticeDimension;
+    }
+  };
+
+  std::vector<float> blurred;
+  for (unsigned int pass = 0; pass < numberOfPasses; ++pass)
+  {
+    for (unsigned int direction = 0; direction <= latticeDimension; ++direction)
+    {
+      if (numberOfPasses > 1)
+      {
+        // repeated blurs spread beyond the splatted vertices, which would lose their share otherwise
+        const std::size_t numberOfVertices = lattice.GetNumberOfVertices();
+        for (std::size_t vertex = 0; vertex < numberOfVertices; ++vertex)
+        {
+          typename LatticeType::KeyType previous, next;
+          getNeighbours(lattice.GetKey(vertex), direction, previous, next);
+          lattice.FindOrInsert(previous);
+          lattice.FindOrInsert(next);
+        }
+      }
+      blurred.resize(lattice.Values.size());
+
+      ParallelFor(lattice.GetNumberOfVertices(), numberOfChunks, [&](std::size_t, std::size_t begin, std::size_t end) {
+        for (std::size_t vertex = begin; vertex < end; ++vertex)
+        {
+          typename LatticeType::KeyType previous, next;
+          getNeighbours(lattice.GetKey(vertex), direction, previous, next);
+
+          const int previousIndex = lattice.Find(previous);
+          const int nextIndex = lattice.Find(next);
+          for (unsigned int c = 0; c < 2; ++c)
+          {
+            float value = 0.5f * lattice.Values[2 * vertex + c];
+            if (previousIndex >= 0)
+              value += 0.25f * lattice.Values[2 * previousIndex + c];
+            if (nextIndex >= 0)
+              value += 0.25f * lattice.Values[2 * nextIndex + c];
+            blurred[2 * vertex + c] = value;
+          }
+        }
+      });
+      lattice.Values.swap(blurred);
+    }
+  }
+
+  // slice: interpolates the blurred values at the voxels and normalizes them by the weights
+  typename ItkImageType::Pointer outputImage = ItkImageType::New();
+  outputImage->CopyInformation(itkImage);
+  outputImage->SetRegions(region);
+  outputImage->Allocate();
+  TPixel *output = outputImage->GetBufferPointer();
+
+  ParallelFor(numberOfPixels, numberOfChunks, [&](std::size_t, std::size_t begin, std::size_t end) {
+    typename LatticeType::Simplex simplex;
+    for (std::size_t offset = begin; offset < end; ++offset)
+    {
+      findSimplex(offset, simplex);
+
+      double value = 0;
+      double weight = 0;
+      for (unsigned int i = 0; i <= latticeDimension; ++i)
+      {
+        const int index = lattice.Find(simplex.Keys[i]);
+        if (index < 0)
+          continue;
+        value += simplex.Weights[i] * lattice.Values[2 * index];
+        weight += simplex.Weights[i] * lattice.Values[2 * index + 1];
+      }
+      output[offset] = weight > 0 ? static_cast<TPixel>(value / weight) : input[offset];
+    }
+  });
+
+  mitk::Image::Pointer resultImage = this->GetOutput();
+  mitk::CastToMitkImage(outputImage, resultImage);
+}
+
 void mitk::BilateralFilter::GenerateOutputInformation()
 {
   mitk::Image::Pointer inputImage = (mitk::Image *)this->GetInput();
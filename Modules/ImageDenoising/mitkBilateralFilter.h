@@ -41,6 +41,13 @@ namespace mitk
     itkGetMacro(AutoKernel, bool);
     itkGetMacro(KernelRadius, unsigned int);
 
+    itkSetMacro(UseFastApproximation, bool);
+    itkGetMacro(UseFastApproximation, bool);
+    itkBooleanMacro(UseFastApproximation);
+
+    itkSetMacro(LatticeRefinement, unsigned int);
+    itkGetMacro(LatticeRefinement, unsigned int);
+
   protected:
     /*!
     \brief standard constructor
@@ -67,10 +74,22 @@ namespace mitk
     template <typename TPixel, unsigned int VImageDimension>
     void ItkImageProcessing(const itk::Image<TPixel, VImageDimension> *itkImage);
 
+    /*!
+    \brief Approximates the bilateral filter on a sparse permutohedral lattice (Adams et al., Fast High-Dimensional
+    Filtering Using the Permutohedral Lattice, 2010). The voxels are splatted onto the lattice spanned by their
+    position and intensity, the lattice is blurred and the result is interpolated at the voxels again. The cost
+    does not depend on the kernel size, the kernel is an untruncated gaussian.
+    */
+    template <typename TPixel, unsigned int VImageDimension>
+    void FastApproximation(const itk::Image<TPixel, VImageDimension> *itkImage);
+
     float m_DomainSigma; /// Sigma of the gaussian kernel. See ITK docu
     float m_RangeSigma;  /// Sigma of the range mask kernel. See ITK docu
     bool m_AutoKernel;   // true: kernel size is calculated from DomainSigma. See ITK Doc; false: set by m_KernelRadius
     unsigned int m_KernelRadius; // use in combination with m_AutoKernel = true
+    bool m_UseFastApproximation; // true: approximate the filter on a permutohedral lattice, kernel size is ignored
+    unsigned int m_LatticeRefinement; // fast approximation only: 1 is fastest, larger values are more accurate but
+                                      // the cost grows with its (image dimension + 2)th power
   };
 } // END mitk namespace
 #endif
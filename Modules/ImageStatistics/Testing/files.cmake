@@ -3,6 +3,10 @@ set(MODULE_TESTS
   mitkPointSetStatisticsCalculatorTest.cpp
   mitkPointSetDifferenceStatisticsCalculatorTest.cpp
   mitkImageStatisticsTextureAnalysisTest.cpp
+  mitkMultiLabelStatisticsEngineTest.cpp
+  mitkImageStatisticsCacheTest.cpp
+  mitkHotspotMaskGeneratorTest.cpp
+  mitkPlanarFigureMaskGeneratorTest.cpp
 )
 
 set(MODULE_CUSTOM_TESTS
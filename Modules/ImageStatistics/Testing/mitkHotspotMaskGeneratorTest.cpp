@@ -0,0 +1,180 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkHotspotMaskGenerator.h>
+#include <mitkITKImageImport.h>
+#include <mitkImageMaskGenerator.h>
+#include <mitkImagePixelReadAccessor.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <itkImageRegionIteratorWithIndex.h>
+
+/**
+ * \brief Test class for mitkHotspotMaskGenerator
+ *
+ * This test covers:
+ * - hotspot search in the whole image and within the bounding box of a label
+ * - the sphere of the generated hotspot mask
+ */
+class mitkHotspotMaskGeneratorTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkHotspotMaskGeneratorTestSuite);
+  MITK_TEST(TestHotspotInWholeImage);
+  MITK_TEST(TestHotspotWithinLabel);
+  MITK_TEST(TestLabelWithoutCandidates);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef itk::Image<float, 3> ImageType;
+  typedef itk::Image<unsigned short, 3> MaskImageType;
+
+  mitk::Image::Pointer m_Image;
+  mitk::Image::Pointer m_Mask;
+
+  // bright peaks of radius 4 around these centers, the first one is the brightest
+  static const int Centers[2][3];
+
+public:
+  void setUp() override
+  {
+    ImageType::RegionType region;
+    region.SetSize(0, 60);
+    region.SetSize(1, 50);
+    region.SetSize(2, 40);
+
+    ImageType::SpacingType spacing;
+    spacing.Fill(2.0);
+
+    ImageType::Pointer image = ImageType::New();
+    image->SetRegions(region);
+    image->SetSpacing(spacing);
+    image->Allocate();
+
+    MaskImageType::Pointer mask = MaskImageType::New();
+    mask->SetRegions(region);
+    mask->SetSpacing(spacing);
+    mask->Allocate();
+
+    // deterministic noise between 0 and 10, label 1 is a box around the second peak, label 2 lies outside of the
+    // image border distance required for the default radius
+    unsigned int state = 42;
+    itk::ImageRegionIteratorWithIndex<ImageType> it(image, region);
+    itk::ImageRegionIteratorWithIndex<MaskImageType> maskIt(mask, region);
+    for (it.GoToBegin(), maskIt.GoToBegin(); !it.IsAtEnd(); ++it, ++maskIt)
+    {
+      state = state * 1103515245u + 12345u;
+      double value = (state >> 16) % 1000 / 100.0;
+
+      const ImageType::IndexType &index = it.GetIndex();
+      for (unsigned int sphere = 0; sphere < 2; ++sphere)
+      {
+        double distanceSquared = 0.0;
+        for (unsigned int i = 0; i < 3; ++i)
+          distanceSquared += (index[i] - Centers[sphere][i]) * (index[i] - Centers[sphere][i]);
+        if (distanceSquared <= 16.0)
+          value += sphere == 0 ? 1000.0 - 50.0 * distanceSquared : 500.0 - 25.0 * distanceSquared;
+      }
+      it.Set(value);
+
+      unsigned short label = 0;
+      if (std::abs(index[0] - Centers[1][0]) <= 6 && std::abs(index[1] - Centers[1][1]) <= 6 &&
+          std::abs(index[2] - Centers[1][2]) <= 6)
+        label = 1;
+      else if (index[0] == 0)
+        label = 2;
+      maskIt.Set(label);
+    }
+
+    m_Image = mitk::GrabItkImageMemory(image);
+    m_Mask = mitk::GrabItkImageMemory(mask);
+  }
+
+  void tearDown() override
+  {
+    m_Image = nullptr;
+    m_Mask = nullptr;
+  }
+
+  void AssertHotspotAt(mitk::HotspotMaskGenerator *generator, const int center[3])
+  {
+    const vnl_vector<int> hotspotIndex = generator->GetHotspotIndex();
+    for (unsigned int i = 0; i < 3; ++i)
+      CPPUNIT_ASSERT_EQUAL(center[i], hotspotIndex[i]);
+
+    // the mask is a sphere of radius 6.2mm, i.e. 3.1 pixels, around the hotspot
+    mitk::Image::Pointer hotspotMask = generator->GetMask();
+    mitk::ImagePixelReadAccessor<unsigned short, 3> accessor(hotspotMask);
+    unsigned int numberOfPixels = 0;
+    unsigned int expectedNumberOfPixels = 0;
+    itk::Index<3> index;
+    for (index[2] = 0; index[2] < 40; ++index[2])
+      for (index[1] = 0; index[1] < 50; ++index[1])
+        for (index[0] = 0; index[0] < 60; ++index[0])
+        {
+          double distanceSquared = 0.0;
+          for (unsigned int i = 0; i < 3; ++i)
+            distanceSquared += 4.0 * (index[i] - center[i]) * (index[i] - center[i]);
+          if (distanceSquared <= generator->GetHotspotRadiusinMM() * generator->GetHotspotRadiusinMM())
+            ++expectedNumberOfPixels;
+          if (accessor.GetPixelByIndex(index) != 0)
+            ++numberOfPixels;
+        }
+
+    CPPUNIT_ASSERT(expectedNumberOfPixels > 0);
+    CPPUNIT_ASSERT_EQUAL(expectedNumberOfPixels, numberOfPixels);
+  }
+
+  void TestHotspotInWholeImage()
+  {
+    mitk::HotspotMaskGenerator::Pointer generator = mitk::HotspotMaskGenerator::New();
+    generator->SetInputImage(m_Image);
+    this->AssertHotspotAt(generator, Centers[0]);
+  }
+
+  void TestHotspotWithinLabel()
+  {
+    mitk::ImageMaskGenerator::Pointer maskGenerator = mitk::ImageMaskGenerator::New();
+    maskGenerator->SetImageMask(m_Mask);
+
+    mitk::HotspotMaskGenerator::Pointer generator = mitk::HotspotMaskGenerator::New();
+    generator->SetInputImage(m_Image);
+    generator->SetMask(maskGenerator.GetPointer());
+    generator->SetLabel(1);
+    this->AssertHotspotAt(generator, Centers[1]);
+  }
+
+  void TestLabelWithoutCandidates()
+  {
+    mitk::ImageMaskGenerator::Pointer maskGenerator = mitk::ImageMaskGenerator::New();
+    maskGenerator->SetImageMask(m_Mask);
+
+    mitk::HotspotMaskGenerator::Pointer generator = mitk::HotspotMaskGenerator::New();
+    generator->SetInputImage(m_Image);
+    generator->SetMask(maskGenerator.GetPointer());
+    generator->SetLabel(2);
+    CPPUNIT_ASSERT(generator->GetMask().IsNull());
+
+    // without the border distance, label 2 contains candidates
+    generator->SetHotspotMustBeCompletelyInsideImage(false);
+    CPPUNIT_ASSERT(generator->GetMask().IsNotNull());
+    CPPUNIT_ASSERT_EQUAL(0, generator->GetHotspotIndex()[0]);
+  }
+};
+
+const int mitkHotspotMaskGeneratorTestSuite::Centers[2][3] = {{40, 20, 25}, {15, 30, 12}};
+
+MITK_TEST_SUITE_REGISTRATION(mitkHotspotMaskGenerator)
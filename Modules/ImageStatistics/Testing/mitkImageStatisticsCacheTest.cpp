@@ -0,0 +1,185 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkIgnorePixelMaskGenerator.h>
+#include <mitkImageGenerator.h>
+#include <mitkImageMaskGenerator.h>
+#include <mitkImagePixelWriteAccessor.h>
+#include <mitkImageStatisticsCache.h>
+#include <mitkImageStatisticsCalculator.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+/**
+ * \brief Test class for mitkImageStatisticsCache
+ *
+ * This test covers:
+ * - least recently used eviction
+ * - sharing of results between calculators and new mask generators for the same mask
+ * - recomputation after the image or the histogram settings have changed
+ */
+class mitkImageStatisticsCacheTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkImageStatisticsCacheTestSuite);
+  MITK_TEST(TestLeastRecentlyUsedEviction);
+  MITK_TEST(TestCalculatorsShareResults);
+  MITK_TEST(TestModifiedImageIsRecomputed);
+  MITK_TEST(TestCacheCanBeDisabled);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef mitk::ImageStatisticsCache::StatisticsVectorType StatisticsVectorType;
+
+  std::size_t m_OriginalCapacity;
+  mitk::Image::Pointer m_Image;
+  mitk::Image::Pointer m_Mask;
+
+  StatisticsVectorType CreateStatistics(long n)
+  {
+    mitk::ImageStatisticsCalculator::StatisticsContainer::Pointer statistics =
+      mitk::ImageStatisticsCalculator::StatisticsContainer::New();
+    statistics->SetN(n);
+    return StatisticsVectorType(1, statistics);
+  }
+
+public:
+  void setUp() override
+  {
+    m_OriginalCapacity = mitk::ImageStatisticsCache::GetInstance().GetCapacity();
+    mitk::ImageStatisticsCache::GetInstance().Clear();
+
+    m_Image = mitk::ImageGenerator::GenerateRandomImage<short>(20, 20, 10, 2, 1, 1, 1, 500, 0);
+    m_Mask = mitk::ImageGenerator::GenerateGradientImage<unsigned short>(20, 20, 10);
+
+    // label 1 in the lower half of the image, background elsewhere
+    mitk::ImagePixelWriteAccessor<unsigned short, 3> accessor(m_Mask);
+    itk::Index<3> index;
+    for (index[2] = 0; index[2] < 10; ++index[2])
+      for (index[1] = 0; index[1] < 20; ++index[1])
+        for (index[0] = 0; index[0] < 20; ++index[0])
+          accessor.SetPixelByIndex(index, index[1] < 10 ? 1 : 0);
+  }
+
+  void tearDown() override
+  {
+    mitk::ImageStatisticsCache::GetInstance().SetCapacity(m_OriginalCapacity);
+    mitk::ImageStatisticsCache::GetInstance().Clear();
+    m_Image = nullptr;
+    m_Mask = nullptr;
+  }
+
+  void TestLeastRecentlyUsedEviction()
+  {
+    mitk::ImageStatisticsCache &cache = mitk::ImageStatisticsCache::GetInstance();
+    cache.SetCapacity(2);
+
+    cache.Insert("a", this->CreateStatistics(1));
+    cache.Insert("b", this->CreateStatistics(2));
+
+    StatisticsVectorType statistics;
+    CPPUNIT_ASSERT(cache.Lookup("a", statistics));
+    CPPUNIT_ASSERT_EQUAL(1l, statistics.front()->GetN());
+
+    // "b" is the least recently used entry now
+    cache.Insert("c", this->CreateStatistics(3));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), cache.GetNumberOfEntries());
+    CPPUNIT_ASSERT(!cache.Lookup("b", statistics));
+    CPPUNIT_ASSERT(cache.Lookup("a", statistics));
+    CPPUNIT_ASSERT(cache.Lookup("c", statistics));
+    CPPUNIT_ASSERT_EQUAL(3l, statistics.front()->GetN());
+
+    cache.Insert("c", this->CreateStatistics(4));
+    CPPUNIT_ASSERT(cache.Lookup("c", statistics));
+    CPPUNIT_ASSERT_EQUAL(4l, statistics.front()->GetN());
+
+    cache.SetCapacity(1);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), cache.GetNumberOfEntries());
+    CPPUNIT_ASSERT(cache.Lookup("c", statistics));
+  }
+
+  void TestCalculatorsShareResults()
+  {
+    mitk::ImageMaskGenerator::Pointer maskGenerator = mitk::ImageMaskGenerator::New();
+    maskGenerator->SetImageMask(m_Mask);
+
+    mitk::ImageStatisticsCalculator::Pointer calculator = mitk::ImageStatisticsCalculator::New();
+    calculator->SetInputImage(m_Image);
+    calculator->SetMask(maskGenerator.GetPointer());
+    calculator->ComputeAllTimeSteps();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), mitk::ImageStatisticsCache::GetInstance().GetNumberOfEntries());
+
+    // a new generator for the same mask image finds the cached results
+    mitk::ImageMaskGenerator::Pointer otherMaskGenerator = mitk::ImageMaskGenerator::New();
+    otherMaskGenerator->SetImageMask(m_Mask);
+    CPPUNIT_ASSERT_EQUAL(maskGenerator->GetCacheKey(), otherMaskGenerator->GetCacheKey());
+
+    mitk::ImageStatisticsCalculator::Pointer otherCalculator = mitk::ImageStatisticsCalculator::New();
+    otherCalculator->SetInputImage(m_Image);
+    otherCalculator->SetMask(otherMaskGenerator.GetPointer());
+
+    for (unsigned int t = 0; t < 2; ++t)
+    {
+      mitk::ImageStatisticsCalculator::StatisticsContainer::Pointer expected = calculator->GetStatistics(t);
+      mitk::ImageStatisticsCalculator::StatisticsContainer::Pointer result = otherCalculator->GetStatistics(t);
+      CPPUNIT_ASSERT_EQUAL(20l * 10l * 10l, result->GetN());
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(expected->GetMean(), result->GetMean(), mitk::eps);
+    }
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), mitk::ImageStatisticsCache::GetInstance().GetNumberOfEntries());
+
+    // other histogram settings are separate entries
+    otherCalculator->SetNBinsForHistogramStatistics(20);
+    otherCalculator->GetStatistics(0);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), mitk::ImageStatisticsCache::GetInstance().GetNumberOfEntries());
+    CPPUNIT_ASSERT_EQUAL(20u, static_cast<unsigned int>(otherCalculator->GetStatistics(0)->GetHistogram()->Size()));
+  }
+
+  void TestModifiedImageIsRecomputed()
+  {
+    mitk::IgnorePixelMaskGenerator::Pointer maskGenerator = mitk::IgnorePixelMaskGenerator::New();
+    maskGenerator->SetInputImage(m_Image);
+    maskGenerator->SetIgnoredPixelValue(-10000);
+
+    mitk::ImageStatisticsCalculator::Pointer calculator = mitk::ImageStatisticsCalculator::New();
+    calculator->SetInputImage(m_Image);
+    calculator->SetMask(maskGenerator.GetPointer());
+    const std::string keyBefore = maskGenerator->GetCacheKey();
+    CPPUNIT_ASSERT(calculator->GetStatistics(0)->GetMax() < 1000.0);
+
+    {
+      mitk::ImagePixelWriteAccessor<short, 3> accessor(m_Image, m_Image->GetVolumeData(0));
+      itk::Index<3> index;
+      index.Fill(3);
+      accessor.SetPixelByIndex(index, 1000);
+    }
+    m_Image->Modified();
+
+    CPPUNIT_ASSERT(keyBefore != maskGenerator->GetCacheKey());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1000.0, calculator->GetStatistics(0)->GetMax(), mitk::eps);
+  }
+
+  void TestCacheCanBeDisabled()
+  {
+    mitk::ImageStatisticsCalculator::Pointer calculator = mitk::ImageStatisticsCalculator::New();
+    calculator->UseStatisticsCacheOff();
+    calculator->SetInputImage(m_Image);
+    calculator->GetStatistics(1);
+
+    CPPUNIT_ASSERT(!calculator->GetUseStatisticsCache());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), mitk::ImageStatisticsCache::GetInstance().GetNumberOfEntries());
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkImageStatisticsCache)
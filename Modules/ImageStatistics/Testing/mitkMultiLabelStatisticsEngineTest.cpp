@@ -0,0 +1,221 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkImageGenerator.h>
+#include <mitkImageStatisticsCalculator.h>
+#include <mitkMultiLabelStatisticsEngine.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <itkImageRegionIteratorWithIndex.h>
+
+#include <map>
+
+/**
+ * \brief Test class for mitkMultiLabelStatisticsEngine
+ *
+ * This test covers:
+ * - correctness of moments, extrema and histograms of all labels compared to a direct computation
+ * - independence of the results from the number of threads
+ * - unmasked time steps and all time steps of the ImageStatisticsCalculator at once
+ */
+class mitkMultiLabelStatisticsEngineTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkMultiLabelStatisticsEngineTestSuite);
+  MITK_TEST(TestCountedPixelType);
+  MITK_TEST(TestFloatingPointPixelType);
+  MITK_TEST(TestUnmaskedTimeStep);
+  MITK_TEST(TestCalculatorAllTimeSteps);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef itk::Image<unsigned short, 3> LabelImageType;
+
+  template <typename TPixel>
+  typename itk::Image<TPixel, 3>::Pointer CreateImage(double offset)
+  {
+    typedef itk::Image<TPixel, 3> ImageType;
+
+    typename ImageType::RegionType region;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      region.SetIndex(i, 3);
+      region.SetSize(i, 20 + i);
+    }
+
+    typename ImageType::Pointer image = ImageType::New();
+    image->SetRegions(region);
+    image->Allocate();
+
+    // deterministic pseudo random values between -300 and 700
+    unsigned int state = 4711;
+    itk::ImageRegionIteratorWithIndex<ImageType> it(image, region);
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      state = state * 1103515245u + 12345u;
+      it.Set(static_cast<TPixel>(static_cast<double>((state >> 16) % 1000) - 300 + offset));
+    }
+
+    return image;
+  }
+
+  template <typename TImage>
+  LabelImageType::Pointer CreateLabelImage(const TImage *image)
+  {
+    // the label image is larger than the image, only the image region is evaluated
+    LabelImageType::RegionType region = image->GetBufferedRegion();
+    region.PadByRadius(2);
+
+    LabelImageType::Pointer labelImage = LabelImageType::New();
+    labelImage->SetRegions(region);
+    labelImage->Allocate();
+    labelImage->FillBuffer(7);
+
+    itk::ImageRegionIteratorWithIndex<LabelImageType> it(labelImage, image->GetBufferedRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      const LabelImageType::IndexType &index = it.GetIndex();
+      it.Set((index[0] + index[1]) % 3 + (index[2] > 12 ? 10 : 0));
+    }
+
+    return labelImage;
+  }
+
+  template <typename TPixel>
+  void CompareWithDirectComputation(const itk::Image<TPixel, 3> *image,
+                                    const LabelImageType *labelImage,
+                                    unsigned int numberOfThreads)
+  {
+    typedef itk::Image<TPixel, 3> ImageType;
+    typedef mitk::MultiLabelStatisticsEngine<TPixel, 3> EngineType;
+
+    EngineType engine;
+    engine.SetNumberOfThreads(numberOfThreads);
+    engine.SetNumberOfBins(50);
+    engine.AddTimeStep(0, image, labelImage);
+    engine.Compute();
+
+    std::map<unsigned short, std::vector<double>> values;
+    std::map<unsigned short, typename ImageType::IndexType> minIndices;
+    itk::ImageRegionConstIteratorWithIndex<ImageType> it(image, image->GetBufferedRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      const unsigned short label = labelImage->GetPixel(it.GetIndex());
+      std::vector<double> &labelValues = values[label];
+      if (labelValues.empty() || it.Get() < *std::min_element(labelValues.begin(), labelValues.end()))
+        minIndices[label] = it.GetIndex();
+      labelValues.push_back(it.Get());
+    }
+
+    const typename EngineType::LabelStatisticsMapType &statisticsMap = engine.GetStatistics(0);
+    CPPUNIT_ASSERT_EQUAL(values.size(), statisticsMap.size());
+
+    for (const auto &entry : values)
+    {
+      const std::vector<double> &labelValues = entry.second;
+      const double n = labelValues.size();
+
+      double mean = 0.0;
+      for (double value : labelValues)
+        mean += value;
+      mean /= n;
+
+      double m2 = 0.0, m3 = 0.0, m4 = 0.0;
+      for (double value : labelValues)
+      {
+        const double d = value - mean;
+        m2 += d * d;
+        m3 += d * d * d;
+        m4 += d * d * d * d;
+      }
+      m2 /= n;
+      m3 /= n;
+      m4 /= n;
+
+      const typename EngineType::LabelStatistics &statistics = statisticsMap.at(entry.first);
+      CPPUNIT_ASSERT_EQUAL(static_cast<itk::SizeValueType>(n), statistics.N);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(mean, statistics.Mean, 1e-9);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(m2, statistics.Variance, 1e-6);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(m3 / std::pow(m2, 1.5), statistics.Skewness, 1e-9);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(m4 / (m2 * m2), statistics.Kurtosis, 1e-9);
+      CPPUNIT_ASSERT_EQUAL(*std::min_element(labelValues.begin(), labelValues.end()), statistics.Min);
+      CPPUNIT_ASSERT_EQUAL(*std::max_element(labelValues.begin(), labelValues.end()), statistics.Max);
+      CPPUNIT_ASSERT_EQUAL(minIndices[entry.first], statistics.MinIndex);
+
+      CPPUNIT_ASSERT_EQUAL(50u, static_cast<unsigned int>(statistics.Histogram->Size()));
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(n, statistics.Histogram->GetTotalFrequency(), mitk::eps);
+    }
+  }
+
+public:
+  void TestCountedPixelType()
+  {
+    itk::Image<short, 3>::Pointer image = this->CreateImage<short>(0.0);
+    LabelImageType::Pointer labelImage = this->CreateLabelImage(image.GetPointer());
+
+    this->CompareWithDirectComputation<short>(image, labelImage, 1);
+    this->CompareWithDirectComputation<short>(image, labelImage, 5);
+  }
+
+  void TestFloatingPointPixelType()
+  {
+    itk::Image<float, 3>::Pointer image = this->CreateImage<float>(0.25);
+    LabelImageType::Pointer labelImage = this->CreateLabelImage(image.GetPointer());
+
+    this->CompareWithDirectComputation<float>(image, labelImage, 1);
+    this->CompareWithDirectComputation<float>(image, labelImage, 5);
+  }
+
+  void TestUnmaskedTimeStep()
+  {
+    itk::Image<short, 3>::Pointer image = this->CreateImage<short>(0.0);
+
+    mitk::MultiLabelStatisticsEngine<short, 3> engine;
+    engine.AddTimeStep(2, image);
+    engine.Compute();
+
+    const mitk::MultiLabelStatisticsEngine<short, 3>::LabelStatisticsMapType &statisticsMap = engine.GetStatistics(2);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), statisticsMap.size());
+    CPPUNIT_ASSERT_EQUAL(image->GetBufferedRegion().GetNumberOfPixels(), statisticsMap.at(1).N);
+    CPPUNIT_ASSERT_THROW(engine.GetStatistics(0), mitk::Exception);
+  }
+
+  void TestCalculatorAllTimeSteps()
+  {
+    mitk::Image::Pointer image = mitk::ImageGenerator::GenerateRandomImage<short>(15, 16, 17, 3);
+
+    mitk::ImageStatisticsCalculator::Pointer allAtOnce = mitk::ImageStatisticsCalculator::New();
+    allAtOnce->SetInputImage(image);
+    allAtOnce->ComputeAllTimeSteps();
+
+    mitk::ImageStatisticsCalculator::Pointer oneByOne = mitk::ImageStatisticsCalculator::New();
+    oneByOne->SetInputImage(image);
+
+    for (unsigned int t = 0; t < 3; ++t)
+    {
+      mitk::ImageStatisticsCalculator::StatisticsContainer::Pointer expected = oneByOne->GetStatistics(t);
+      mitk::ImageStatisticsCalculator::StatisticsContainer::Pointer result = allAtOnce->GetStatistics(t);
+
+      CPPUNIT_ASSERT_EQUAL(15l * 16l * 17l, result->GetN());
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(expected->GetMean(), result->GetMean(), mitk::eps);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(expected->GetVariance(), result->GetVariance(), mitk::eps);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(expected->GetMedian(), result->GetMedian(), mitk::eps);
+      CPPUNIT_ASSERT_EQUAL(std::size_t(1), allAtOnce->GetStatisticsForAllLabels(t).size());
+    }
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkMultiLabelStatisticsEngine)
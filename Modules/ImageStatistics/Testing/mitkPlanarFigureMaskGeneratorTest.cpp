@@ -0,0 +1,186 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkImageGenerator.h>
+#include <mitkImagePixelReadAccessor.h>
+#include <mitkPlanarFigureMaskGenerator.h>
+#include <mitkPlanarPolygon.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <itkImageRegionConstIteratorWithIndex.h>
+
+/**
+ * \brief Test class for mitkPlanarFigureMaskGenerator
+ *
+ * This test covers:
+ * - the scanline rasterization of a closed figure compared to a point in polygon test of all pixel centers
+ * - pixel centers on the border of the figure
+ * - the partial volume weights, which sum up to the area of the figure
+ */
+class mitkPlanarFigureMaskGeneratorTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkPlanarFigureMaskGeneratorTestSuite);
+  MITK_TEST(TestMaskMatchesPointInPolygon);
+  MITK_TEST(TestPixelCentersOnBorder);
+  MITK_TEST(TestPartialVolumeWeights);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::Image::Pointer m_Image;
+  std::vector<mitk::Point2D> m_Polygon;
+
+  mitk::PlanarPolygon::Pointer CreateFigure(const std::vector<mitk::Point2D> &points)
+  {
+    mitk::PlanarPolygon::Pointer figure = mitk::PlanarPolygon::New();
+    figure->SetPlaneGeometry(m_Image->GetSlicedGeometry()->GetPlaneGeometry(2));
+    figure->PlaceFigure(points.front());
+    for (std::size_t i = 1; i < points.size(); ++i)
+      figure->SetControlPoint(i, points[i], true);
+    figure->SetClosed(true);
+    return figure;
+  }
+
+  mitk::PlanarFigureMaskGenerator::Pointer CreateGenerator(const std::vector<mitk::Point2D> &points)
+  {
+    mitk::PlanarFigureMaskGenerator::Pointer generator = mitk::PlanarFigureMaskGenerator::New();
+    generator->SetInputImage(m_Image);
+    generator->SetPlanarFigure(this->CreateFigure(points).GetPointer());
+    return generator;
+  }
+
+  static bool IsInside(const std::vector<mitk::Point2D> &polygon, double x, double y)
+  {
+    bool inside = false;
+    for (std::size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++)
+    {
+      if ((polygon[i][1] > y) != (polygon[j][1] > y) &&
+          x < (polygon[j][0] - polygon[i][0]) * (y - polygon[i][1]) / (polygon[j][1] - polygon[i][1]) + polygon[i][0])
+        inside = !inside;
+    }
+    return inside;
+  }
+
+  static mitk::Point2D MakePoint(double x, double y)
+  {
+    mitk::Point2D point;
+    point[0] = x;
+    point[1] = y;
+    return point;
+  }
+
+  static unsigned int CountMaskPixels(mitk::Image *mask)
+  {
+    mitk::ImagePixelReadAccessor<unsigned short, 2> accessor(mask);
+    unsigned int numberOfPixels = 0;
+    itk::Index<2> index;
+    for (index[1] = 0; index[1] < static_cast<itk::IndexValueType>(mask->GetDimension(1)); ++index[1])
+      for (index[0] = 0; index[0] < static_cast<itk::IndexValueType>(mask->GetDimension(0)); ++index[0])
+        if (accessor.GetPixelByIndex(index) != 0)
+          ++numberOfPixels;
+    return numberOfPixels;
+  }
+
+public:
+  void setUp() override
+  {
+    m_Image = mitk::ImageGenerator::GenerateGradientImage<short>(40, 30, 5);
+
+    m_Polygon.clear();
+    m_Polygon.push_back(MakePoint(5.2, 5.3));
+    m_Polygon.push_back(MakePoint(30.7, 8.1));
+    m_Polygon.push_back(MakePoint(18.4, 12.3));
+    m_Polygon.push_back(MakePoint(28.4, 22.6));
+    m_Polygon.push_back(MakePoint(7.1, 19.9));
+  }
+
+  void tearDown() override { m_Image = nullptr; }
+
+  void TestMaskMatchesPointInPolygon()
+  {
+    mitk::PlanarFigureMaskGenerator::Pointer generator = this->CreateGenerator(m_Polygon);
+    mitk::Image::Pointer mask = generator->GetMask();
+    CPPUNIT_ASSERT_EQUAL(2u, generator->GetPlanarFigureAxis());
+    CPPUNIT_ASSERT(generator->GetPartialVolumeWeights().IsNull());
+
+    mitk::ImagePixelReadAccessor<unsigned short, 2> accessor(mask);
+    itk::Index<2> index;
+    for (index[1] = 0; index[1] < 30; ++index[1])
+      for (index[0] = 0; index[0] < 40; ++index[0])
+        CPPUNIT_ASSERT_EQUAL(IsInside(m_Polygon, index[0], index[1]), accessor.GetPixelByIndex(index) != 0);
+  }
+
+  void TestPixelCentersOnBorder()
+  {
+    // rectangle from pixel center to pixel center, all 3 x 2 centers lie on its border or inside
+    std::vector<mitk::Point2D> rectangle;
+    rectangle.push_back(MakePoint(9.0, 3.0));
+    rectangle.push_back(MakePoint(11.0, 3.0));
+    rectangle.push_back(MakePoint(11.0, 4.0));
+    rectangle.push_back(MakePoint(9.0, 4.0));
+    CPPUNIT_ASSERT_EQUAL(6u, CountMaskPixels(this->CreateGenerator(rectangle)->GetMask()));
+
+    // a diamond touching four pixel centers with its vertices encloses one more
+    std::vector<mitk::Point2D> diamond;
+    diamond.push_back(MakePoint(20.0, 10.0));
+    diamond.push_back(MakePoint(21.0, 11.0));
+    diamond.push_back(MakePoint(20.0, 12.0));
+    diamond.push_back(MakePoint(19.0, 11.0));
+    CPPUNIT_ASSERT_EQUAL(5u, CountMaskPixels(this->CreateGenerator(diamond)->GetMask()));
+  }
+
+  void TestPartialVolumeWeights()
+  {
+    mitk::PlanarFigureMaskGenerator::Pointer generator = this->CreateGenerator(m_Polygon);
+    generator->ComputePartialVolumeWeightsOn();
+
+    mitk::PlanarFigureMaskGenerator::PartialVolumeWeightsImageType::Pointer weights =
+      generator->GetPartialVolumeWeights();
+    CPPUNIT_ASSERT(weights.IsNotNull());
+
+    double area = 0.0;
+    for (std::size_t i = 0, j = m_Polygon.size() - 1; i < m_Polygon.size(); j = i++)
+      area += m_Polygon[j][0] * m_Polygon[i][1] - m_Polygon[i][0] * m_Polygon[j][1];
+    area = std::abs(area) / 2.0;
+
+    double sum = 0.0;
+    itk::ImageRegionConstIteratorWithIndex<mitk::PlanarFigureMaskGenerator::PartialVolumeWeightsImageType> it(
+      weights, weights->GetLargestPossibleRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      CPPUNIT_ASSERT(it.Get() >= 0.0f && it.Get() <= 1.0f);
+      sum += it.Get();
+
+      // pixels far inside are covered completely, pixels far outside not at all
+      const double x = it.GetIndex()[0], y = it.GetIndex()[1];
+      bool cornersInside = true, cornersOutside = true;
+      for (double dx = -0.5; dx <= 0.5; dx += 1.0)
+        for (double dy = -0.5; dy <= 0.5; dy += 1.0)
+        {
+          cornersInside = cornersInside && IsInside(m_Polygon, x + dx, y + dy);
+          cornersOutside = cornersOutside && !IsInside(m_Polygon, x + dx, y + dy);
+        }
+      if (cornersInside && IsInside(m_Polygon, x, y))
+        CPPUNIT_ASSERT(it.Get() > 0.0f);
+      if (cornersOutside && !IsInside(m_Polygon, x, y))
+        CPPUNIT_ASSERT(it.Get() < 1.0f);
+    }
+
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(area, sum, 1e-3);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkPlanarFigureMaskGenerator)
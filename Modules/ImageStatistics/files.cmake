@@ -1,5 +1,6 @@
 set(CPP_FILES
   mitkImageStatisticsCalculator.cpp
+  mitkImageStatisticsCache.cpp
   mitkPointSetStatisticsCalculator.cpp
   mitkPointSetDifferenceStatisticsCalculator.cpp
   mitkIntensityProfile.cpp
@@ -15,6 +16,7 @@ set(CPP_FILES
 
 set(H_FILES
   mitkImageStatisticsCalculator.h
+  mitkImageStatisticsCache.h
   mitkPointSetDifferenceStatisticsCalculator.h
   mitkPointSetStatisticsCalculator.h
   mitkExtendedStatisticsImageFilter.h
@@ -30,4 +32,5 @@ set(H_FILES
   mitkIgnorePixelMaskGenerator.h
   mitkMinMaxImageFilterWithIndex.h
   mitkMinMaxLabelmageFilterWithIndex.h
+  mitkMultiLabelStatisticsEngine.h
 )
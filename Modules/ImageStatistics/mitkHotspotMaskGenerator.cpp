@@ -3,10 +3,64 @@
 #include <mitkImageCast.h>
 #include <mitkPoint.h>
 #include <itkImageRegionIterator.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
 #include "mitkImageAccessByItk.h"
 #include <itkImageDuplicator.h>
 #include <itkFFTConvolutionImageFilter.h>
 #include <mitkITKImageImport.h>
+#include <itkExtractImageFilter.h>
+
+#include <algorithm>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+    /** Number of slabs along the last dimension into which region is split for parallel processing. */
+    template <unsigned int VImageDimension>
+    std::size_t GetNumberOfSlabs(const itk::ImageRegion<VImageDimension> &region)
+    {
+        const std::size_t numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+        return std::max<std::size_t>(1, std::min<std::size_t>(numberOfThreads, region.GetSize(VImageDimension - 1)));
+    }
+
+    /** Calls function(slab, slabRegion) for numberOfSlabs consecutive slabs of region, each in its own thread. */
+    template <unsigned int VImageDimension, typename TFunction>
+    void ForEachSlab(const itk::ImageRegion<VImageDimension> &region, std::size_t numberOfSlabs, TFunction function)
+    {
+        const itk::SizeValueType size = region.GetSize(VImageDimension - 1);
+
+        auto processSlab = [&](std::size_t slab)
+        {
+            itk::ImageRegion<VImageDimension> slabRegion = region;
+            const itk::SizeValueType begin = size * slab / numberOfSlabs;
+            const itk::SizeValueType end = size * (slab + 1) / numberOfSlabs;
+            slabRegion.SetIndex(VImageDimension - 1, region.GetIndex(VImageDimension - 1) + begin);
+            slabRegion.SetSize(VImageDimension - 1, end - begin);
+
+            if (slabRegion.GetNumberOfPixels() > 0)
+            {
+                function(slab, slabRegion);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (std::size_t slab = 1; slab < numberOfSlabs; ++slab)
+        {
+            threads.emplace_back(processSlab, slab);
+        }
+
+        if (numberOfSlabs > 0)
+        {
+            processSlab(0);
+        }
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+    }
+}
 
 namespace mitk
 {
@@ -18,6 +72,7 @@ namespace mitk
         m_TimeStep = 0;
         m_InternalMask = mitk::Image::New();
         m_InternalMaskUpdateTime = 0;
+        m_InternalMaskTimeStep = 0;
     }
 
     void HotspotMaskGenerator::SetInputImage(mitk::Image::Pointer inputImage)
@@ -93,6 +148,10 @@ namespace mitk
             imageTimeSelector->UpdateLargestPossibleRegion();
             mitk::Image::Pointer timeSliceImage = imageTimeSelector->GetOutput();
 
+            // remember the state of the mask before it is generated, to detect later modifications
+            m_InternalMaskCacheKey = m_Mask.IsNotNull() ? m_Mask->GetCacheKey() : std::string();
+            m_InternalMaskTimeStep = m_TimeStep;
+
             m_internalImage = timeSliceImage;
             m_internalMask2D = nullptr; // is this correct when this variable holds a smart pointer?
             m_internalMask3D = nullptr;
@@ -134,9 +193,9 @@ namespace mitk
                 }
             }
             this->Modified();
+            m_InternalMaskUpdateTime = this->GetMTime();
         }
 
-        m_InternalMaskUpdateTime = m_InternalMask->GetMTime();
         return m_InternalMask;
     }
 
@@ -148,6 +207,16 @@ namespace mitk
         }
     }
 
+    std::string HotspotMaskGenerator::GetCacheKey()
+    {
+        std::ostringstream key;
+        key.precision(17);
+        key << this->GetNameOfClass() << "/" << m_HotspotRadiusinMM << "/" << m_HotspotMustBeCompletelyInsideImage
+            << "/" << m_Label << "/" << (m_Mask.IsNotNull() ? m_Mask->GetCacheKey() : "none") << "/"
+            << GetCacheKeyOf(m_inputImage);
+        return key.str();
+    }
+
     void HotspotMaskGenerator::SetLabel(unsigned short label)
     {
         if (label != m_Label)
@@ -169,27 +238,20 @@ namespace mitk
         return m_ConvolutionImageMaxIndex;
     }
 
-    template <typename TPixel, unsigned int VImageDimension  >
-    HotspotMaskGenerator::ImageExtrema
-      HotspotMaskGenerator::CalculateExtremaWorld( const itk::Image<TPixel, VImageDimension>* inputImage,
-                                                    typename itk::Image<unsigned short, VImageDimension>::Pointer maskImage,
-                                                    double neccessaryDistanceToImageBorderInMM,
-                                                    unsigned int label )
+    template <typename TPixel, unsigned int VImageDimension>
+    itk::ImageRegion<VImageDimension>
+      HotspotMaskGenerator::CalculateSearchRegion( const itk::Image<TPixel, VImageDimension>* inputImage,
+                                                   const itk::Image<unsigned short, VImageDimension>* maskImage,
+                                                   double neccessaryDistanceToImageBorderInMM,
+                                                   unsigned int label )
     {
       typedef itk::Image< TPixel, VImageDimension > ImageType;
       typedef itk::Image< unsigned short, VImageDimension > MaskImageType;
-
-      typedef itk::ImageRegionConstIteratorWithIndex<MaskImageType> MaskImageIteratorType;
-      typedef itk::ImageRegionConstIteratorWithIndex<ImageType> InputImageIndexIteratorType;
+      typedef typename ImageType::RegionType RegionType;
 
       typename ImageType::SpacingType spacing = inputImage->GetSpacing();
 
-      ImageExtrema minMax;
-      minMax.Defined = false;
-      minMax.MaxIndex.set_size(VImageDimension);
-      minMax.MaxIndex.set_size(VImageDimension);
-
-      typename ImageType::RegionType allowedExtremaRegion = inputImage->GetLargestPossibleRegion();
+      RegionType allowedExtremaRegion = inputImage->GetLargestPossibleRegion();
 
       bool keepDistanceToImageBorders( neccessaryDistanceToImageBorderInMM > 0 );
       if (keepDistanceToImageBorders)
@@ -207,93 +269,183 @@ namespace mitk
         allowedExtremaRegion.ShrinkByRadius(distanceInPixels);
       }
 
-      InputImageIndexIteratorType imageIndexIt(inputImage, allowedExtremaRegion);
-
-      float maxValue = itk::NumericTraits<float>::min();
-      float minValue = itk::NumericTraits<float>::max();
-
-      typename ImageType::IndexType maxIndex;
-      typename ImageType::IndexType minIndex;
-
-      for(unsigned short i = 0; i < VImageDimension; ++i)
+      if (maskImage == nullptr)
       {
-        maxIndex[i] = 0;
-        minIndex[i] = 0;
+        return allowedExtremaRegion;
       }
 
-      if (maskImage != nullptr)
+      // bounding box of all mask pixels with value label, determined per slab in parallel
+      typedef typename MaskImageType::IndexType IndexType;
+      struct BoundingBox
       {
-        MaskImageIteratorType maskIt(maskImage, maskImage->GetLargestPossibleRegion());
-        typename ImageType::IndexType imageIndex;
-        typename ImageType::PointType worldPosition;
-        typename ImageType::IndexType maskIndex;
+        bool Defined = false;
+        IndexType Lower;
+        IndexType Upper;
+      };
+
+      const RegionType maskRegion = maskImage->GetLargestPossibleRegion();
+      std::vector<BoundingBox> boundingBoxes(GetNumberOfSlabs(maskRegion));
 
-        for(maskIt.GoToBegin(); !maskIt.IsAtEnd(); ++maskIt)
+      ForEachSlab(maskRegion, boundingBoxes.size(), [&](std::size_t slab, const RegionType &slabRegion)
+      {
+        BoundingBox &boundingBox = boundingBoxes[slab];
+        itk::ImageRegionConstIteratorWithIndex<MaskImageType> maskIt(maskImage, slabRegion);
+        for (maskIt.GoToBegin(); !maskIt.IsAtEnd(); ++maskIt)
         {
-          imageIndex = maskIndex = maskIt.GetIndex();
+          if (maskIt.Get() != label)
+            continue;
 
-          if(maskIt.Get() == label)
+          const IndexType &index = maskIt.GetIndex();
+          if (!boundingBox.Defined)
           {
-            if( allowedExtremaRegion.IsInside(imageIndex) )
-            {
-              imageIndexIt.SetIndex( imageIndex );
-              double value = imageIndexIt.Get();
-              minMax.Defined = true;
+            boundingBox.Defined = true;
+            boundingBox.Lower = boundingBox.Upper = index;
+          }
+          for (unsigned int dimension = 0; dimension < VImageDimension; ++dimension)
+          {
+            boundingBox.Lower[dimension] = std::min(boundingBox.Lower[dimension], index[dimension]);
+            boundingBox.Upper[dimension] = std::max(boundingBox.Upper[dimension], index[dimension]);
+          }
+        }
+      });
 
-              //Calculate minimum, maximum and corresponding index-values
-              if( value > maxValue )
-              {
-                maxIndex = imageIndexIt.GetIndex();
-                maxValue = value;
-              }
+      BoundingBox labelBoundingBox;
+      for (const BoundingBox &boundingBox : boundingBoxes)
+      {
+        if (!boundingBox.Defined)
+          continue;
 
-              if(value < minValue )
-              {
-                minIndex = imageIndexIt.GetIndex();
-                minValue = value;
-              }
-            }
-          }
+        if (!labelBoundingBox.Defined)
+        {
+          labelBoundingBox = boundingBox;
+          continue;
+        }
+        for (unsigned int dimension = 0; dimension < VImageDimension; ++dimension)
+        {
+          labelBoundingBox.Lower[dimension] = std::min(labelBoundingBox.Lower[dimension], boundingBox.Lower[dimension]);
+          labelBoundingBox.Upper[dimension] = std::max(labelBoundingBox.Upper[dimension], boundingBox.Upper[dimension]);
+        }
+      }
+
+      RegionType searchRegion;
+      if (labelBoundingBox.Defined)
+      {
+        searchRegion.SetIndex(labelBoundingBox.Lower);
+        for (unsigned int dimension = 0; dimension < VImageDimension; ++dimension)
+        {
+          searchRegion.SetSize(dimension, labelBoundingBox.Upper[dimension] - labelBoundingBox.Lower[dimension] + 1);
+        }
+
+        if (searchRegion.Crop(allowedExtremaRegion))
+        {
+          return searchRegion;
         }
       }
-      else
+
+      // empty region, no hotspot can be found
+      typename RegionType::SizeType emptySize;
+      emptySize.Fill(0);
+      searchRegion.SetIndex(allowedExtremaRegion.GetIndex());
+      searchRegion.SetSize(emptySize);
+      return searchRegion;
+    }
+
+    template <typename TPixel, unsigned int VImageDimension  >
+    HotspotMaskGenerator::ImageExtrema
+      HotspotMaskGenerator::CalculateExtremaWorld( const itk::Image<TPixel, VImageDimension>* inputImage,
+                                                    const itk::Image<unsigned short, VImageDimension>* maskImage,
+                                                    const itk::ImageRegion<VImageDimension> &searchRegion,
+                                                    unsigned int label )
+    {
+      typedef itk::Image< TPixel, VImageDimension > ImageType;
+      typedef itk::Image< unsigned short, VImageDimension > MaskImageType;
+      typedef typename ImageType::RegionType RegionType;
+      typedef typename ImageType::IndexType IndexType;
+
+      // Slabs are searched in parallel and merged in raster order. Since later pixels only replace
+      // an extremum if they are strictly larger (smaller), the first extremum in raster order is found.
+      struct Extrema
       {
-        for(imageIndexIt.GoToBegin(); !imageIndexIt.IsAtEnd(); ++imageIndexIt)
+        bool Defined = false;
+        double Max = 0.0;
+        double Min = 0.0;
+        IndexType MaxIndex;
+        IndexType MinIndex;
+
+        void Add(double value, const IndexType &index)
         {
-          double value = imageIndexIt.Get();
-          minMax.Defined = true;
+          this->Merge(value, index, value, index);
+        }
 
-          //Calculate minimum, maximum and corresponding index-values
-          if( value > maxValue )
+        void Merge(double max, const IndexType &maxIndex, double min, const IndexType &minIndex)
+        {
+          if (!Defined || max > Max)
           {
-            maxIndex = imageIndexIt.GetIndex();
-            maxValue = value;
+            Max = max;
+            MaxIndex = maxIndex;
           }
+          if (!Defined || min < Min)
+          {
+            Min = min;
+            MinIndex = minIndex;
+          }
+          Defined = true;
+        }
+      };
+
+      std::vector<Extrema> slabExtrema(searchRegion.GetNumberOfPixels() > 0 ? GetNumberOfSlabs(searchRegion) : 0);
+
+      ForEachSlab(searchRegion, slabExtrema.size(), [&](std::size_t slab, const RegionType &slabRegion)
+      {
+        Extrema &extrema = slabExtrema[slab];
+        itk::ImageRegionConstIteratorWithIndex<ImageType> imageIt(inputImage, slabRegion);
 
-          if(value < minValue )
+        if (maskImage != nullptr)
+        {
+          itk::ImageRegionConstIterator<MaskImageType> maskIt(maskImage, slabRegion);
+          for (imageIt.GoToBegin(), maskIt.GoToBegin(); !imageIt.IsAtEnd(); ++imageIt, ++maskIt)
+          {
+            if (maskIt.Get() == label)
+            {
+              extrema.Add(imageIt.Get(), imageIt.GetIndex());
+            }
+          }
+        }
+        else
+        {
+          for (imageIt.GoToBegin(); !imageIt.IsAtEnd(); ++imageIt)
           {
-            minIndex = imageIndexIt.GetIndex();
-            minValue = value;
+            extrema.Add(imageIt.Get(), imageIt.GetIndex());
           }
         }
+      });
+
+      Extrema extrema;
+      for (const Extrema &slab : slabExtrema)
+      {
+        if (!slab.Defined)
+          continue;
+
+        extrema.Merge(slab.Max, slab.MaxIndex, slab.Min, slab.MinIndex);
       }
 
+      ImageExtrema minMax;
+      minMax.Defined = extrema.Defined;
       minMax.MaxIndex.set_size(VImageDimension);
       minMax.MinIndex.set_size(VImageDimension);
 
-      for(unsigned int i = 0; i < minMax.MaxIndex.size(); ++i)
+      for(unsigned int i = 0; i < VImageDimension; ++i)
       {
-        minMax.MaxIndex[i] = maxIndex[i];
+        minMax.MaxIndex[i] = extrema.Defined ? extrema.MaxIndex[i] : 0;
+        minMax.MinIndex[i] = extrema.Defined ? extrema.MinIndex[i] : 0;
       }
 
-      for(unsigned int i = 0; i < minMax.MinIndex.size(); ++i)
+      if (extrema.Defined)
       {
-        minMax.MinIndex[i] = minIndex[i];
+        minMax.Max = extrema.Max;
+        minMax.Min = extrema.Min;
       }
 
-      minMax.Max = maxValue;
-      minMax.Min = minValue;
-
       return minMax;
     }
 
@@ -419,7 +571,8 @@ namespace mitk
 
     template <typename TPixel, unsigned int VImageDimension>
     itk::SmartPointer<itk::Image<TPixel, VImageDimension> >
-      HotspotMaskGenerator::GenerateConvolutionImage( const itk::Image<TPixel, VImageDimension>* inputImage )
+      HotspotMaskGenerator::GenerateConvolutionImage( const itk::Image<TPixel, VImageDimension>* inputImage,
+                                                      const itk::ImageRegion<VImageDimension> &searchRegion )
     {
       double mmPerPixel[VImageDimension];
       for (unsigned int dimension = 0; dimension < VImageDimension; ++dimension)
@@ -431,9 +584,28 @@ namespace mitk
       typedef itk::Image< float, VImageDimension > KernelImageType;
       typename KernelImageType::Pointer convolutionKernel = this->GenerateHotspotSearchConvolutionKernel<VImageDimension>(mmPerPixel, m_HotspotRadiusinMM);
 
-      // update convolution image
+      // only the search region padded by the kernel radius contributes to the convolution at the search region,
+      // so the FFT is restricted to it. Where the padded region reaches the image border, the boundary condition
+      // applies exactly as for the whole image.
       typedef itk::Image< TPixel, VImageDimension > InputImageType;
       typedef itk::Image< TPixel, VImageDimension > ConvolutionImageType;
+
+      typename InputImageType::RegionType convolutionRegion = searchRegion;
+      typename InputImageType::SizeType kernelRadius;
+      for (unsigned int dimension = 0; dimension < VImageDimension; ++dimension)
+      {
+        kernelRadius[dimension] = (convolutionKernel->GetLargestPossibleRegion().GetSize(dimension) - 1) / 2;
+      }
+      convolutionRegion.PadByRadius(kernelRadius);
+      convolutionRegion.Crop(inputImage->GetLargestPossibleRegion());
+
+      typedef itk::ExtractImageFilter<InputImageType, InputImageType> ExtractFilterType;
+      typename ExtractFilterType::Pointer extractFilter = ExtractFilterType::New();
+      extractFilter->SetInput(inputImage);
+      extractFilter->SetExtractionRegion(convolutionRegion);
+      extractFilter->SetDirectionCollapseToSubmatrix();
+      extractFilter->Update();
+
       typedef itk::FFTConvolutionImageFilter<InputImageType,
         KernelImageType,
         ConvolutionImageType> ConvolutionFilterType;
@@ -449,7 +621,7 @@ namespace mitk
         convolutionFilter->SetBoundaryCondition(&boundaryCondition);
       }
 
-      convolutionFilter->SetInput(inputImage);
+      convolutionFilter->SetInput(extractFilter->GetOutput());
       convolutionFilter->SetKernelImage(convolutionKernel);
       convolutionFilter->SetNormalize(true);
       MITK_DEBUG << "Update Convolution image for hotspot search";
@@ -470,12 +642,31 @@ namespace mitk
       typedef itk::Image< TPixel, VImageDimension > MaskImageType;
       typedef itk::ImageRegionIteratorWithIndex<MaskImageType> MaskImageIteratorType;
 
-      MaskImageIteratorType maskIt(maskImage, maskImage->GetLargestPossibleRegion());
+      // the mask is 0 initialized, only the bounding region of the sphere needs to be visited. Since the direction
+      // matrix is orthonormal, the sphere extends by radius / spacing around its center along each index axis.
+      itk::ContinuousIndex<double, VImageDimension> centerIndex;
+      maskImage->TransformPhysicalPointToContinuousIndex(sphereCenter, centerIndex);
+
+      typename MaskImageType::RegionType sphereRegion;
+      for (unsigned int dimension = 0; dimension < VImageDimension; ++dimension)
+      {
+        const double radiusInPixels = sphereRadiusInMM / maskImage->GetSpacing()[dimension];
+        const itk::IndexValueType lower = static_cast<itk::IndexValueType>(std::floor(centerIndex[dimension] - radiusInPixels)) - 1;
+        const itk::IndexValueType upper = static_cast<itk::IndexValueType>(std::ceil(centerIndex[dimension] + radiusInPixels)) + 1;
+        sphereRegion.SetIndex(dimension, lower);
+        sphereRegion.SetSize(dimension, upper - lower + 1);
+      }
+
+      if (!sphereRegion.Crop(maskImage->GetLargestPossibleRegion()))
+      {
+        return;
+      }
+
+      MaskImageIteratorType maskIt(maskImage, sphereRegion);
 
       typename MaskImageType::IndexType maskIndex;
       typename MaskImageType::PointType worldPosition;
 
-      // this is not very smart. I would rather use a 0 initialized mask (not the case here -> blame CalculateHotspotMask) and find the region where I need to iterate over, then iterate only over the small region
       for(maskIt.GoToBegin(); !maskIt.IsAtEnd(); ++maskIt)
       {
         maskIndex = maskIt.GetIndex();
@@ -494,38 +685,27 @@ namespace mitk
         typedef itk::Image< TPixel, VImageDimension > ConvolutionImageType;
         typedef itk::Image< unsigned short, VImageDimension > MaskImageType;
 
-        typename ConvolutionImageType::Pointer convolutionImage = this->GenerateConvolutionImage(inputImage);
-
-        if (convolutionImage.IsNull())
-        {
-          MITK_ERROR << "Empty convolution image in CalculateHotspotStatistics(). We should never reach this state (logic error).";
-          throw std::logic_error("Empty convolution image in CalculateHotspotStatistics()");
-        }
+        // candidates for the hotspot center are the pixels with value label inside the bounding box of the label,
+        // optionally keeping the hotspot radius to the image border. Without mask, all pixels are candidates.
+        double requiredDistanceToBorder = m_HotspotMustBeCompletelyInsideImage ? m_HotspotRadiusinMM : -1.0;
+        const typename InputImageType::RegionType searchRegion =
+          this->CalculateSearchRegion(inputImage, maskImage.GetPointer(), requiredDistanceToBorder, label);
 
-        // if mask image is not defined, create an image of the same size as inputImage and fill it with 1's
-        // there is maybe a better way to do this!?
-        if (maskImage == nullptr)
+        ImageExtrema convolutionImageInformation;
+        if (searchRegion.GetNumberOfPixels() > 0)
         {
-            maskImage = MaskImageType::New();
-            typename MaskImageType::RegionType maskRegion = inputImage->GetLargestPossibleRegion();
-            typename MaskImageType::SpacingType maskSpacing = inputImage->GetSpacing();
-            typename MaskImageType::PointType maskOrigin = inputImage->GetOrigin();
-            typename MaskImageType::DirectionType maskDirection = inputImage->GetDirection();
-            maskImage->SetRegions(maskRegion);
-            maskImage->Allocate();
-            maskImage->SetOrigin(maskOrigin);
-            maskImage->SetSpacing(maskSpacing);
-            maskImage->SetDirection(maskDirection);
+          typename ConvolutionImageType::Pointer convolutionImage = this->GenerateConvolutionImage(inputImage, searchRegion);
 
-            maskImage->FillBuffer(1);
+          if (convolutionImage.IsNull())
+          {
+            MITK_ERROR << "Empty convolution image in CalculateHotspotStatistics(). We should never reach this state (logic error).";
+            throw std::logic_error("Empty convolution image in CalculateHotspotStatistics()");
+          }
 
-            label = 1;
+          // find maximum in convolution image, given the current mask
+          convolutionImageInformation = CalculateExtremaWorld(convolutionImage.GetPointer(), maskImage.GetPointer(), searchRegion, label);
         }
 
-        // find maximum in convolution image, given the current mask
-        double requiredDistanceToBorder = m_HotspotMustBeCompletelyInsideImage ? m_HotspotRadiusinMM : -1.0;
-        ImageExtrema convolutionImageInformation = CalculateExtremaWorld(convolutionImage.GetPointer(), maskImage, requiredDistanceToBorder, label);
-
         bool isHotspotDefined = convolutionImageInformation.Defined;
 
         if (!isHotspotDefined)
@@ -551,7 +731,7 @@ namespace mitk
           hotspotMaskITK->SetDirection(inputImage->GetDirection());
           hotspotMaskITK->SetNumberOfComponentsPerPixel(inputImage->GetNumberOfComponentsPerPixel());
           hotspotMaskITK->Allocate();
-          hotspotMaskITK->FillBuffer(1);
+          hotspotMaskITK->FillBuffer(0);
 
           typedef typename InputImageType::IndexType IndexType;
           IndexType maskCenterIndex;
@@ -576,9 +756,13 @@ namespace mitk
 
     bool HotspotMaskGenerator::IsUpdateRequired() const
     {
+        if (m_inputImage.IsNull() || m_InternalMask.IsNull()) // nothing computed yet or no hotspot found
+        {
+            return true;
+        }
+
         unsigned long thisClassTimeStamp = this->GetMTime();
         unsigned long internalMaskTimeStamp = m_InternalMask->GetMTime();
-        unsigned long maskGeneratorTimeStamp = m_Mask->GetMTime();
         unsigned long inputImageTimeStamp = m_inputImage->GetMTime();
 
         if (thisClassTimeStamp > m_InternalMaskUpdateTime) // inputs have changed
@@ -586,7 +770,12 @@ namespace mitk
             return true;
         }
 
-        if (m_InternalMaskUpdateTime < maskGeneratorTimeStamp || m_InternalMaskUpdateTime < inputImageTimeStamp) // mask image has changed outside of this class
+        if (m_InternalMaskUpdateTime < inputImageTimeStamp || m_InternalMaskTimeStep != m_TimeStep) // input image has changed outside of this class
+        {
+            return true;
+        }
+
+        if (m_Mask.IsNotNull() && m_Mask->GetCacheKey() != m_InternalMaskCacheKey) // mask has changed outside of this class
         {
             return true;
         }
@@ -20,7 +20,8 @@ namespace mitk
      * mask of predefined size is generated. This mask is then convolved with the input image (in fourier domain).
      * The maximum value of the convolved image then corresponds to the hotspot.
      * If a maskGenerator is set, only the pixels of the convolved image where the corresponding mask is == @a label
-     * are searched for the maximum value.
+     * are searched for the maximum value. The convolution is then restricted to the bounding box of the label, padded
+     * by the kernel radius, which is considerably faster for small masks in large images.
      */
     class MITKIMAGESTATISTICS_EXPORT HotspotMaskGenerator: public MaskGenerator
     {
@@ -87,6 +88,11 @@ namespace mitk
          */
         void SetTimeStep(unsigned int timeStep) override;
 
+        /**
+         * @brief Depends on the hotspot parameters, the mask and the input image.
+         */
+        std::string GetCacheKey() override;
+
     protected:
         HotspotMaskGenerator();
 
@@ -120,10 +126,12 @@ namespace mitk
         itk::SmartPointer< itk::Image<float, VImageDimension> >
           GenerateHotspotSearchConvolutionKernel(double spacing[VImageDimension], double radiusInMM);
 
-        /** \brief Convolves image with spherical kernel image. Used for hotspot calculation.   */
+        /** \brief Convolves image with spherical kernel image. Used for hotspot calculation.
+            Only the convolution within searchRegion is valid, the output covers searchRegion padded by the kernel radius. */
         template <typename TPixel, unsigned int VImageDimension>
         itk::SmartPointer< itk::Image<TPixel, VImageDimension> >
-          GenerateConvolutionImage( const itk::Image<TPixel, VImageDimension>* inputImage );
+          GenerateConvolutionImage( const itk::Image<TPixel, VImageDimension>* inputImage,
+                                    const itk::ImageRegion<VImageDimension> &searchRegion );
 
 
         /** \brief Fills pixels of the spherical hotspot mask. */
@@ -142,10 +150,19 @@ namespace mitk
                                unsigned int label);
 
 
+        /** \brief Bounding region of all mask pixels with value label (or the whole image without mask), shrunk
+            by neccessaryDistanceToImageBorderInMM at the image borders if it is positive. */
+        template <typename TPixel, unsigned int VImageDimension>
+        itk::ImageRegion<VImageDimension> CalculateSearchRegion( const itk::Image<TPixel, VImageDimension>* inputImage,
+                                                                 const itk::Image<unsigned short, VImageDimension>* maskImage,
+                                                                 double neccessaryDistanceToImageBorderInMM,
+                                                                 unsigned int label);
+
+        /** \brief Extrema of all pixels of searchRegion where maskImage (if any) is label. */
         template <typename TPixel, unsigned int VImageDimension  >
         ImageExtrema CalculateExtremaWorld( const itk::Image<TPixel, VImageDimension>* inputImage,
-                                                        typename itk::Image<unsigned short, VImageDimension>::Pointer maskImage,
-                                                        double neccessaryDistanceToImageBorderInMM,
+                                                        const itk::Image<unsigned short, VImageDimension>* maskImage,
+                                                        const itk::ImageRegion<VImageDimension> &searchRegion,
                                                         unsigned int label);
 
         bool IsUpdateRequired() const;
@@ -162,6 +179,8 @@ namespace mitk
         unsigned short m_Label;
         vnl_vector<int> m_ConvolutionImageMinIndex, m_ConvolutionImageMaxIndex;
         unsigned long m_InternalMaskUpdateTime;
+        unsigned int m_InternalMaskTimeStep;
+        std::string m_InternalMaskCacheKey;
     };
 }
 #endif // MITKHOTSPOTCALCULATOR
@@ -5,6 +5,8 @@
 #include <itkImageConstIterator.h>
 #include <mitkITKImageImport.h>
 
+#include <sstream>
+
 namespace mitk
 {
 void IgnorePixelMaskGenerator::SetIgnoredPixelValue(RealType pixelValue)
@@ -24,6 +26,14 @@ void IgnorePixelMaskGenerator::SetTimeStep(unsigned int timeStep)
     }
 }
 
+std::string IgnorePixelMaskGenerator::GetCacheKey()
+{
+    std::ostringstream key;
+    key.precision(17);
+    key << this->GetNameOfClass() << "/" << m_IgnoredPixelValue << "/" << GetCacheKeyOf(m_inputImage);
+    return key.str();
+}
+
 mitk::Image::Pointer IgnorePixelMaskGenerator::GetMask()
 {
     if (IsUpdateRequired())
@@ -45,6 +45,11 @@ public:
      */
     void SetTimeStep(unsigned int timeStep) override;
 
+    /**
+     * @brief Depends on the ignored pixel value and the input image.
+     */
+    std::string GetCacheKey() override;
+
 protected:
     IgnorePixelMaskGenerator():
        m_IgnoredPixelValue(std::numeric_limits<RealType>::min())
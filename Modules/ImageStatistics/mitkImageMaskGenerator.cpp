@@ -61,6 +61,11 @@ mitk::Image::Pointer ImageMaskGenerator::GetMask()
     return m_InternalMask;
 }
 
+std::string ImageMaskGenerator::GetCacheKey()
+{
+    return std::string(this->GetNameOfClass()) + "/" + GetCacheKeyOf(m_internalMaskImage);
+}
+
 bool ImageMaskGenerator::IsUpdateRequired() const
 {
     unsigned long internalMaskTimeStamp = m_InternalMask->GetMTime();
@@ -30,6 +30,11 @@ public:
 
     void SetImageMask(mitk::Image::Pointer maskImage);
 
+    /**
+     * @brief Depends on the mask image only.
+     */
+    std::string GetCacheKey() override;
+
 protected:
     ImageMaskGenerator():Superclass(){
         m_InternalMaskUpdateTime = 0;
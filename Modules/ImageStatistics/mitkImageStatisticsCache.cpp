@@ -0,0 +1,82 @@
+#include <mitkImageStatisticsCache.h>
+
+namespace mitk
+{
+    ImageStatisticsCache &ImageStatisticsCache::GetInstance()
+    {
+        static ImageStatisticsCache instance;
+        return instance;
+    }
+
+    ImageStatisticsCache::ImageStatisticsCache()
+        : m_Capacity(1000)
+    {
+    }
+
+    void ImageStatisticsCache::SetCapacity(std::size_t capacity)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Capacity = capacity;
+        this->EvictEntries();
+    }
+
+    std::size_t ImageStatisticsCache::GetCapacity() const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_Capacity;
+    }
+
+    std::size_t ImageStatisticsCache::GetNumberOfEntries() const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_Entries.size();
+    }
+
+    bool ImageStatisticsCache::Lookup(const std::string &key, StatisticsVectorType &statistics)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        auto it = m_EntriesByKey.find(key);
+        if (it == m_EntriesByKey.end())
+        {
+            return false;
+        }
+
+        m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+        statistics = it->second->second;
+        return true;
+    }
+
+    void ImageStatisticsCache::Insert(const std::string &key, const StatisticsVectorType &statistics)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        auto it = m_EntriesByKey.find(key);
+        if (it != m_EntriesByKey.end())
+        {
+            it->second->second = statistics;
+            m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+            return;
+        }
+
+        m_Entries.emplace_front(key, statistics);
+        m_EntriesByKey[key] = m_Entries.begin();
+        this->EvictEntries();
+    }
+
+    void ImageStatisticsCache::Clear()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Entries.clear();
+        m_EntriesByKey.clear();
+    }
+
+    void ImageStatisticsCache::EvictEntries()
+    {
+        while (m_Entries.size() > m_Capacity)
+        {
+            m_EntriesByKey.erase(m_Entries.back().first);
+            m_Entries.pop_back();
+        }
+    }
+}
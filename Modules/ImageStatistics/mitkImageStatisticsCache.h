@@ -0,0 +1,68 @@
+#ifndef MITKIMAGESTATISTICSCACHE
+#define MITKIMAGESTATISTICSCACHE
+
+#include <MitkImageStatisticsExports.h>
+#include <mitkImageStatisticsCalculator.h>
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mitk
+{
+    /**
+    @brief Process wide cache of image statistics shared by all ImageStatisticsCalculator instances.
+
+    The statistics of one time step are stored under a key that identifies the image (UID and modified time), the
+    masks (see MaskGenerator::GetCacheKey()), the histogram settings and the time step. Since every modification
+    of an input changes its key, entries never need to be invalidated explicitly; outdated entries are simply not
+    requested anymore and are evicted once the cache is full, least recently used first.
+
+    Modified times are not persistent, so the cache only lives in memory. All methods are thread safe.
+    */
+    class MITKIMAGESTATISTICS_EXPORT ImageStatisticsCache
+    {
+    public:
+        typedef std::vector<ImageStatisticsCalculator::StatisticsContainer::Pointer> StatisticsVectorType;
+
+        static ImageStatisticsCache &GetInstance();
+
+        /**Documentation
+        @brief Maximum number of cached time steps, 1000 by default. Reducing it evicts the least recently used entries.*/
+        void SetCapacity(std::size_t capacity);
+        std::size_t GetCapacity() const;
+
+        std::size_t GetNumberOfEntries() const;
+
+        /**Documentation
+        @brief Copies the statistics stored under @a key to @a statistics and marks them as recently used.
+        @return false if there are no statistics for @a key.*/
+        bool Lookup(const std::string &key, StatisticsVectorType &statistics);
+
+        /**Documentation
+        @brief Stores @a statistics under @a key, replacing previously stored statistics.*/
+        void Insert(const std::string &key, const StatisticsVectorType &statistics);
+
+        void Clear();
+
+    private:
+        typedef std::pair<std::string, StatisticsVectorType> EntryType;
+
+        ImageStatisticsCache();
+        ImageStatisticsCache(const ImageStatisticsCache &) = delete;
+        ImageStatisticsCache &operator=(const ImageStatisticsCache &) = delete;
+
+        void EvictEntries();
+
+        mutable std::mutex m_Mutex;
+        std::size_t m_Capacity;
+
+        // most recently used entries first
+        std::list<EntryType> m_Entries;
+        std::unordered_map<std::string, std::list<EntryType>::iterator> m_EntriesByKey;
+    };
+}
+
+#endif
@@ -1,6 +1,7 @@
 
 #include <limits>
 #include <cmath>
+#include <sstream>
 
 #include <itkImageToHistogramFilter.h>
 #include <itkMaskedImageToHistogramFilter.h>
@@ -14,15 +15,13 @@
 #include <itkExceptionObject.h>
 
 #include <mitkImageStatisticsCalculator.h>
+#include <mitkImageStatisticsCache.h>
 #include <mitkImage.h>
 #include <mitkHistogramStatisticsCalculator.h>
 #include <mitkImageAccessByItk.h>
 #include <mitkImageToItk.h>
-#include <mitkExtendedStatisticsImageFilter.h>
-#include <mitkExtendedLabelStatisticsImageFilter.h>
 #include <mitkImageTimeSelector.h>
-#include <mitkMinMaxImageFilterWithIndex.h>
-#include <mitkMinMaxLabelmageFilterWithIndex.h>
+#include <mitkMultiLabelStatisticsEngine.h>
 #include <mitkitkMaskImageFilter.h>
 #include <mitkImageCast.h>
 
@@ -112,7 +111,65 @@ namespace mitk
 
     ImageStatisticsCalculator::StatisticsContainer::Pointer ImageStatisticsCalculator::GetStatistics(unsigned int timeStep, unsigned int label)
     {
+        this->CheckInput(timeStep);
 
+        if (IsUpdateRequired(timeStep))
+        {
+            this->CalculateStatistics(std::vector<unsigned int>(1, timeStep));
+        }
+
+        for (auto it = m_StatisticsByTimeStep[timeStep].begin(); it != m_StatisticsByTimeStep[timeStep].end(); ++it)
+        {
+            StatisticsContainer::Pointer statCont = *it;
+            if (statCont->GetLabel() == label)
+            {
+                return statCont->Clone();
+            }
+        }
+
+        // these lines will ony be executed if the requested label could not be found!
+        MITK_WARN << "Invalid label: " << label << " in time step: " << timeStep;
+        return StatisticsContainer::New();
+    }
+
+    std::vector<ImageStatisticsCalculator::StatisticsContainer::Pointer> ImageStatisticsCalculator::GetStatisticsForAllLabels(unsigned int timeStep)
+    {
+        this->CheckInput(timeStep);
+
+        if (IsUpdateRequired(timeStep))
+        {
+            this->CalculateStatistics(std::vector<unsigned int>(1, timeStep));
+        }
+
+        std::vector<StatisticsContainer::Pointer> statistics;
+        for (const auto &statCont : m_StatisticsByTimeStep[timeStep])
+        {
+            statistics.push_back(statCont->Clone());
+        }
+        return statistics;
+    }
+
+    void ImageStatisticsCalculator::ComputeAllTimeSteps()
+    {
+        this->CheckInput(0);
+
+        std::vector<unsigned int> timeSteps;
+        for (unsigned int timeStep = 0; timeStep < m_StatisticsByTimeStep.size(); ++timeStep)
+        {
+            if (IsUpdateRequired(timeStep))
+            {
+                timeSteps.push_back(timeStep);
+            }
+        }
+
+        if (!timeSteps.empty())
+        {
+            this->CalculateStatistics(timeSteps);
+        }
+    }
+
+    void ImageStatisticsCalculator::CheckInput(unsigned int timeStep) const
+    {
         if (timeStep >= m_StatisticsByTimeStep.size())
         {
              mitkThrow() << "invalid timeStep in ImageStatisticsCalculator_v2::GetStatistics";
@@ -127,13 +184,42 @@ namespace mitk
         {
           mitkThrow() << "Image not initialized!";
         }
+    }
 
-        if (IsUpdateRequired(timeStep))
+    void ImageStatisticsCalculator::CalculateStatistics(const std::vector<unsigned int> &requestedTimeSteps)
+    {
+        ImageStatisticsCache &cache = ImageStatisticsCache::GetInstance();
+
+        // keys have to be determined before the masks are generated, generators may modify themselves meanwhile
+        std::vector<unsigned int> timeSteps;
+        std::vector<std::string> cacheKeys;
+        for (unsigned int timeStep : requestedTimeSteps)
         {
+            if (m_UseStatisticsCache)
+            {
+                std::string key = this->GetCacheKey(timeStep);
+                if (cache.Lookup(key, m_StatisticsByTimeStep[timeStep]))
+                {
+                    continue;
+                }
+                cacheKeys.push_back(key);
+            }
+            timeSteps.push_back(timeStep);
+        }
+
+        m_ImageTimeSlices.clear();
+        m_InternalMasks.clear();
+        m_SecondaryMasks.clear();
+
+        for (unsigned int timeStep : timeSteps)
+        {
+            mitk::Image::Pointer internalMask;
+            mitk::Image::Pointer secondaryMask;
+
             if (m_MaskGenerator.IsNotNull())
             {
                 m_MaskGenerator->SetTimeStep(timeStep);
-                m_InternalMask = m_MaskGenerator->GetMask();
+                internalMask = m_MaskGenerator->GetMask();
                 if (m_MaskGenerator->GetReferenceImage().IsNotNull())
                 {
                     m_InternalImageForStatistics = m_MaskGenerator->GetReferenceImage();
@@ -151,187 +237,211 @@ namespace mitk
             if (m_SecondaryMaskGenerator.IsNotNull())
             {
                 m_SecondaryMaskGenerator->SetTimeStep(timeStep);
-                m_SecondaryMask = m_SecondaryMaskGenerator->GetMask();
+                secondaryMask = m_SecondaryMaskGenerator->GetMask();
             }
 
             ImageTimeSelector::Pointer imgTimeSel = ImageTimeSelector::New();
             imgTimeSel->SetInput(m_InternalImageForStatistics);
             imgTimeSel->SetTimeNr(timeStep);
             imgTimeSel->UpdateLargestPossibleRegion();
-            m_ImageTimeSlice = imgTimeSel->GetOutput();
-
-
-            // Calculate statistics with/without mask
-            if (m_MaskGenerator.IsNull() && m_SecondaryMaskGenerator.IsNull())
-            {
-                // 1) calculate statistics unmasked:
-                AccessByItk_1(m_ImageTimeSlice, InternalCalculateStatisticsUnmasked, timeStep)
-
-            }
-            else
-            {
-                // 2) calculate statistics masked
-                AccessByItk_1(m_ImageTimeSlice, InternalCalculateStatisticsMasked, timeStep)
-            }
 
+            m_ImageTimeSlices.push_back(imgTimeSel->GetOutput());
+            m_InternalMasks.push_back(internalMask);
+            m_SecondaryMasks.push_back(secondaryMask);
+        }
 
-            //this->Modified();
+        if (!timeSteps.empty())
+        {
+            // all time steps are traversed at once, with or without mask
+            AccessByItk_1(m_ImageTimeSlices.front(), InternalCalculateStatistics, timeSteps)
         }
 
-        m_StatisticsUpdateTimePerTimeStep[timeStep] = m_StatisticsByTimeStep[timeStep][m_StatisticsByTimeStep[timeStep].size()-1]->GetMTime();
+        for (std::size_t i = 0; i < cacheKeys.size(); ++i)
+        {
+            cache.Insert(cacheKeys[i], m_StatisticsByTimeStep[timeSteps[i]]);
+        }
 
-        for (auto it = m_StatisticsByTimeStep[timeStep].begin(); it != m_StatisticsByTimeStep[timeStep].end(); ++it)
+        m_StatisticsUpdateTime.Modified();
+        for (unsigned int timeStep : requestedTimeSteps)
         {
-            StatisticsContainer::Pointer statCont = *it;
-            if (statCont->GetLabel() == label)
-            {
-                return statCont->Clone();
-            }
+            m_StatisticsUpdateTimePerTimeStep[timeStep] = m_StatisticsUpdateTime.GetMTime();
         }
 
-        // these lines will ony be executed if the requested label could not be found!
-        MITK_WARN << "Invalid label: " << label << " in time step: " << timeStep;
-        return StatisticsContainer::New();
+        m_ImageTimeSlices.clear();
+        m_InternalMasks.clear();
+        m_SecondaryMasks.clear();
     }
 
-    template < typename TPixel, unsigned int VImageDimension > void ImageStatisticsCalculator::InternalCalculateStatisticsUnmasked(
-            typename itk::Image< TPixel, VImageDimension >* image, unsigned int timeStep)
+    template < typename TPixel, unsigned int VImageDimension > void ImageStatisticsCalculator::InternalCalculateStatistics(
+            typename itk::Image< TPixel, VImageDimension >* image,
+            const std::vector<unsigned int> &timeSteps)
     {
-        typedef typename itk::Image< TPixel, VImageDimension > ImageType;
-        typedef typename itk::ExtendedStatisticsImageFilter<ImageType> ImageStatisticsFilterType;
-        typedef typename itk::MinMaxImageFilterWithIndex<ImageType> MinMaxFilterType;
-
-        StatisticsContainer::Pointer statisticsResult = StatisticsContainer::New();
-
-        typename ImageStatisticsFilterType::Pointer statisticsFilter = ImageStatisticsFilterType::New();
-        statisticsFilter->SetInput(image);
-        statisticsFilter->SetCoordinateTolerance(0.001);
-        statisticsFilter->SetDirectionTolerance(0.001);
+        typedef itk::Image< TPixel, VImageDimension > ImageType;
+        typedef itk::Image< MaskPixelType, VImageDimension > MaskType;
+        typedef MultiLabelStatisticsEngine< TPixel, VImageDimension > EngineType;
 
-        // TODO: this is single threaded. Implement our own image filter that does this multi threaded
-//        typename itk::MinimumMaximumImageCalculator<ImageType>::Pointer imgMinMaxFilter = itk::MinimumMaximumImageCalculator<ImageType>::New();
-//        imgMinMaxFilter->SetImage(image);
-//        imgMinMaxFilter->Compute();
-        vnl_vector<int> minIndex, maxIndex;
+        EngineType engine;
+        if (m_UseBinSizeOverNBins)
+        {
+            engine.SetBinSize(m_binSizeForHistogramStatistics);
+        }
+        else
+        {
+            engine.SetNumberOfBins(m_nBinsForHistogramStatistics);
+        }
 
-        typename MinMaxFilterType::Pointer minMaxFilter = MinMaxFilterType::New();
-        minMaxFilter->SetInput(image);
-        minMaxFilter->UpdateLargestPossibleRegion();
-        typename ImageType::PixelType minval = minMaxFilter->GetMin();
-        typename ImageType::PixelType maxval = minMaxFilter->GetMax();
+        // the engine only references the images, keep them alive until it is done
+        std::vector<typename ImageType::Pointer> images;
+        std::vector<typename MaskType::Pointer> masks;
+        std::vector<bool> isMasked;
 
-        typename ImageType::IndexType tmpMinIndex = minMaxFilter->GetMinIndex();
-        typename ImageType::IndexType tmpMaxIndex = minMaxFilter->GetMaxIndex();
+        for (std::size_t i = 0; i < timeSteps.size(); ++i)
+        {
+            typename ImageType::Pointer timeSliceImage = image;
+            if (0 != i)
+            {
+                timeSliceImage = ImageToItkImage< TPixel, VImageDimension >(m_ImageTimeSlices[i]);
+            }
 
-//        typename ImageType::IndexType tmpMinIndex = imgMinMaxFilter->GetIndexOfMinimum();
-//        typename ImageType::IndexType tmpMaxIndex = imgMinMaxFilter->GetIndexOfMaximum();
+            typename MaskType::Pointer maskImage;
+            if (m_InternalMasks[i].IsNotNull() || m_SecondaryMasks[i].IsNotNull())
+            {
+                maskImage = this->InternalPrepareMask<TPixel, VImageDimension>(timeSliceImage, timeSteps[i], i);
+            }
 
-        minIndex.set_size(tmpMaxIndex.GetIndexDimension());
-        maxIndex.set_size(tmpMaxIndex.GetIndexDimension());
+            images.push_back(timeSliceImage);
+            masks.push_back(maskImage);
+            isMasked.push_back(maskImage.IsNotNull());
 
-        for (unsigned int i=0; i < tmpMaxIndex.GetIndexDimension(); i++)
-        {
-            minIndex[i] = tmpMinIndex[i];
-            maxIndex[i] = tmpMaxIndex[i];
+            engine.AddTimeStep(timeSteps[i], timeSliceImage, maskImage);
         }
 
-        statisticsResult->SetMinIndex(minIndex);
-        statisticsResult->SetMaxIndex(maxIndex);
-
-        //convert m_binSize in m_nBins if necessary
-        unsigned int nBinsForHistogram;
-        if (m_UseBinSizeOverNBins)
+        try
         {
-            nBinsForHistogram = std::max(static_cast<double>(std::ceil(maxval - minval)) / m_binSizeForHistogramStatistics, 10.); // do not allow less than 10 bins
+            engine.Compute();
         }
-        else
+        catch (const itk::ExceptionObject& e)
         {
-            nBinsForHistogram = m_nBinsForHistogramStatistics;
+            mitkThrow() << "Image statistics calculation failed due to following ITK Exception: \n " << e.what();
         }
 
-        statisticsFilter->SetHistogramParameters(nBinsForHistogram, minval, maxval);
-
-        try
+        for (std::size_t i = 0; i < timeSteps.size(); ++i)
         {
-          statisticsFilter->Update();
+            const unsigned int timeStep = timeSteps[i];
+            m_StatisticsByTimeStep[timeStep].resize(0);
+
+            for (const auto &entry : engine.GetStatistics(timeStep))
+            {
+                const typename EngineType::LabelStatistics &labelStatistics = entry.second;
+                StatisticsContainer::Pointer statisticsResult = StatisticsContainer::New();
+
+                vnl_vector<int> minIndex, maxIndex;
+                if (isMasked[i])
+                {
+                    // the mask may be defined on another image (e.g. a planar figure mask), so min and max
+                    // are located in world coordinates and converted into indices of the input image
+                    mitk::Point3D worldCoordinateMin;
+                    mitk::Point3D worldCoordinateMax;
+                    mitk::Point3D indexCoordinateMin;
+                    mitk::Point3D indexCoordinateMax;
+                    m_InternalImageForStatistics->GetGeometry()->IndexToWorld(labelStatistics.MinIndex, worldCoordinateMin);
+                    m_InternalImageForStatistics->GetGeometry()->IndexToWorld(labelStatistics.MaxIndex, worldCoordinateMax);
+                    m_Image->GetGeometry()->WorldToIndex(worldCoordinateMin, indexCoordinateMin);
+                    m_Image->GetGeometry()->WorldToIndex(worldCoordinateMax, indexCoordinateMax);
+
+                    minIndex.set_size(3);
+                    maxIndex.set_size(3);
+                    for (unsigned int j = 0; j < 3; j++)
+                    {
+                        minIndex[j] = indexCoordinateMin[j];
+                        maxIndex[j] = indexCoordinateMax[j];
+                    }
+                }
+                else
+                {
+                    minIndex.set_size(VImageDimension);
+                    maxIndex.set_size(VImageDimension);
+                    for (unsigned int j = 0; j < VImageDimension; j++)
+                    {
+                        minIndex[j] = labelStatistics.MinIndex[j];
+                        maxIndex[j] = labelStatistics.MaxIndex[j];
+                    }
+                }
+
+                statisticsResult->SetMinIndex(minIndex);
+                statisticsResult->SetMaxIndex(maxIndex);
+
+                statisticsResult->SetN(labelStatistics.N);
+                statisticsResult->SetMean(labelStatistics.Mean);
+                statisticsResult->SetMin(labelStatistics.Min);
+                statisticsResult->SetMax(labelStatistics.Max);
+                statisticsResult->SetVariance(labelStatistics.Variance);
+                statisticsResult->SetStd(std::sqrt(labelStatistics.Variance));
+                statisticsResult->SetSkewness(labelStatistics.Skewness);
+                statisticsResult->SetKurtosis(labelStatistics.Kurtosis);
+                statisticsResult->SetRMS(std::sqrt(std::pow(labelStatistics.Mean, 2.) + labelStatistics.Variance)); // variance = sigma^2
+                statisticsResult->SetMPP(labelStatistics.MPP);
+                statisticsResult->SetLabel(entry.first);
+
+                statisticsResult->SetEntropy(labelStatistics.Entropy);
+                statisticsResult->SetMedian(labelStatistics.Median);
+                statisticsResult->SetUniformity(labelStatistics.Uniformity);
+                statisticsResult->SetUPP(labelStatistics.UPP);
+                statisticsResult->SetHistogram(labelStatistics.Histogram);
+
+                m_StatisticsByTimeStep[timeStep].push_back(statisticsResult);
+            }
         }
-        catch (const itk::ExceptionObject& e)
-        {
-          mitkThrow() << "Image statistics calculation failed due to following ITK Exception: \n " << e.what();
-        }
-
-        // no mask, therefore just one label = the whole image
-        m_StatisticsByTimeStep[timeStep].resize(1);
-        statisticsResult->SetLabel(1);
-        statisticsResult->SetN(image->GetLargestPossibleRegion().GetNumberOfPixels());
-        statisticsResult->SetMean(statisticsFilter->GetMean());
-        statisticsResult->SetMin(statisticsFilter->GetMinimum());
-        statisticsResult->SetMax(statisticsFilter->GetMaximum());
-        statisticsResult->SetVariance(statisticsFilter->GetVariance());
-        statisticsResult->SetStd(statisticsFilter->GetSigma());
-        statisticsResult->SetSkewness(statisticsFilter->GetSkewness());
-        statisticsResult->SetKurtosis(statisticsFilter->GetKurtosis());
-        statisticsResult->SetRMS(std::sqrt(std::pow(statisticsFilter->GetMean(), 2.) + statisticsFilter->GetVariance())); // variance = sigma^2
-        statisticsResult->SetMPP(statisticsFilter->GetMPP());
-
-        statisticsResult->SetEntropy(statisticsFilter->GetEntropy());
-        statisticsResult->SetMedian(statisticsFilter->GetMedian());
-        statisticsResult->SetUniformity(statisticsFilter->GetUniformity());
-        statisticsResult->SetUPP(statisticsFilter->GetUPP());
-        statisticsResult->SetHistogram(statisticsFilter->GetHistogram());
-
-        m_StatisticsByTimeStep[timeStep][0] = statisticsResult;
     }
 
-
-    template < typename TPixel, unsigned int VImageDimension > void ImageStatisticsCalculator::InternalCalculateStatisticsMasked(
-            typename itk::Image< TPixel, VImageDimension >* image,
-            unsigned int timeStep)
+    template < typename TPixel, unsigned int VImageDimension >
+    typename itk::Image< ImageStatisticsCalculator::MaskPixelType, VImageDimension >::Pointer
+        ImageStatisticsCalculator::InternalPrepareMask(
+            typename itk::Image< TPixel, VImageDimension >::Pointer &image,
+            unsigned int timeStep,
+            std::size_t timeStepIndex)
     {
-        typedef itk::Image< TPixel, VImageDimension > ImageType;
         typedef itk::Image< MaskPixelType, VImageDimension > MaskType;
-        typedef typename MaskType::PixelType LabelPixelType;
-        typedef itk::ExtendedLabelStatisticsImageFilter< ImageType, MaskType > ImageStatisticsFilterType;
         typedef MaskUtilities< TPixel, VImageDimension > MaskUtilType;
-        typedef typename itk::MinMaxLabelImageFilterWithIndex<ImageType, MaskType> MinMaxLabelFilterType;
-        typedef typename ImageType::PixelType InputImgPixelType;
+
+        mitk::Image::Pointer internalMask = m_InternalMasks[timeStepIndex];
+        mitk::Image::Pointer secondaryMask = m_SecondaryMasks[timeStepIndex];
 
         // workaround: if m_SecondaryMaskGenerator ist not null but m_MaskGenerator is! (this is the case if we request a 'ignore zuero valued pixels'
         // mask in the gui but do not define a primary mask)
-        bool swapMasks = false;
-        if (m_SecondaryMask.IsNotNull() && m_InternalMask.IsNull())
+        if (secondaryMask.IsNotNull() && internalMask.IsNull())
         {
-            m_InternalMask = m_SecondaryMask;
-            m_SecondaryMask = nullptr;
-            swapMasks = true;
+            internalMask = secondaryMask;
+            secondaryMask = nullptr;
         }
 
         // maskImage has to have the same dimension as image
         typename MaskType::Pointer maskImage = MaskType::New();
         try {
             // try to access the pixel values directly (no copying or casting). Only works if mask pixels are of pixelType unsigned short
-            maskImage = ImageToItkImage< MaskPixelType, VImageDimension >(m_InternalMask);
+            maskImage = ImageToItkImage< MaskPixelType, VImageDimension >(internalMask);
         }
         catch (const itk::ExceptionObject &)
 
         {
-            // if the pixel type of the mask is not short, then we have to make a copy of m_InternalMask (and cast the values)
-            CastToItkImage(m_InternalMask, maskImage);
+            // if the pixel type of the mask is not short, then we have to make a copy of internalMask (and cast the values)
+            CastToItkImage(internalMask, maskImage);
         }
 
         // if we have a secondary mask (say a ignoreZeroPixelMask) we need to combine the masks (corresponds to AND)
-        if (m_SecondaryMask.IsNotNull())
+        if (secondaryMask.IsNotNull())
         {
             // dirty workaround for a bug when pf mask + any other mask is used in conjunction. We need a proper fix for this (Fabian Isensee is responsible and probably working on it!)
-            if (m_InternalMask->GetDimension() == 2 && (m_SecondaryMask->GetDimension() == 3 || m_SecondaryMask->GetDimension() == 4))
+            if (internalMask->GetDimension() == 2 && (secondaryMask->GetDimension() == 3 || secondaryMask->GetDimension() == 4))
             {
                 mitk::Image::Pointer old_img = m_SecondaryMaskGenerator->GetReferenceImage();
                 m_SecondaryMaskGenerator->SetInputImage(m_MaskGenerator->GetReferenceImage());
-                m_SecondaryMask = m_SecondaryMaskGenerator->GetMask();
+                m_SecondaryMaskGenerator->SetTimeStep(timeStep);
+                secondaryMask = m_SecondaryMaskGenerator->GetMask();
                 m_SecondaryMaskGenerator->SetInputImage(old_img);
             }
             typename MaskType::Pointer secondaryMaskImage = MaskType::New();
-            secondaryMaskImage = ImageToItkImage< MaskPixelType, VImageDimension >(m_SecondaryMask);
+            secondaryMaskImage = ImageToItkImage< MaskPixelType, VImageDimension >(secondaryMask);
 
             // secondary mask should be a ignore zero value pixel mask derived from image. it has to be cropped to the mask region (which may be planar or simply smaller)
             typename MaskUtilities<MaskPixelType, VImageDimension>::Pointer secondaryMaskMaskUtil = MaskUtilities<MaskPixelType, VImageDimension>::New();
@@ -352,117 +462,28 @@ namespace mitk
         maskUtil->SetMask(maskImage.GetPointer());
 
         // if mask is smaller than image, extract the image region where the mask is
-        typename ImageType::Pointer adaptedImage = ImageType::New();
-
-        adaptedImage = maskUtil->ExtractMaskImageRegion(); // this also checks mask sanity
-
-        // find min, max, minindex and maxindex
-        typename MinMaxLabelFilterType::Pointer minMaxFilter = MinMaxLabelFilterType::New();
-        minMaxFilter->SetInput(adaptedImage);
-        minMaxFilter->SetLabelInput(maskImage);
-        minMaxFilter->UpdateLargestPossibleRegion();
-
-        // set histogram parameters for each label individually (min/max may be different for each label)
-        typedef typename std::map<LabelPixelType, InputImgPixelType> MapType;
-        typedef typename std::pair<LabelPixelType, InputImgPixelType> PairType;
-
-        std::vector<LabelPixelType> relevantLabels = minMaxFilter->GetRelevantLabels();
-        MapType minVals;
-        MapType maxVals;
-        std::map<LabelPixelType, unsigned int> nBins;
-
-        for (LabelPixelType label:relevantLabels)
-        {
-            minVals.insert(PairType(label, minMaxFilter->GetMin(label)));
-            maxVals.insert(PairType(label, minMaxFilter->GetMax(label)));
-
-            unsigned int nBinsForHistogram;
-            if (m_UseBinSizeOverNBins)
-            {
-                nBinsForHistogram = std::max(static_cast<double>(std::ceil(minMaxFilter->GetMax(label) - minMaxFilter->GetMin(label))) / m_binSizeForHistogramStatistics, 10.); // do not allow less than 10 bins
-            }
-            else
-            {
-                nBinsForHistogram = m_nBinsForHistogramStatistics;
-            }
-
-            nBins.insert(typename std::pair<LabelPixelType, unsigned int>(label, nBinsForHistogram));
-        }
+        image = maskUtil->ExtractMaskImageRegion(); // this also checks mask sanity
 
-        typename ImageStatisticsFilterType::Pointer imageStatisticsFilter = ImageStatisticsFilterType::New();
-        imageStatisticsFilter->SetDirectionTolerance(0.001);
-        imageStatisticsFilter->SetCoordinateTolerance(0.001);
-        imageStatisticsFilter->SetInput(adaptedImage);
-        imageStatisticsFilter->SetLabelInput(maskImage);
-        imageStatisticsFilter->SetHistogramParametersForLabels(nBins, minVals, maxVals);
-        imageStatisticsFilter->Update();
-
-        std::list<int> labels = imageStatisticsFilter->GetRelevantLabels();
-        auto it = labels.begin();
-        m_StatisticsByTimeStep[timeStep].resize(0);
+        return maskImage;
+    }
 
-        while(it != labels.end())
+    std::string ImageStatisticsCalculator::GetCacheKey(unsigned int timeStep)
+    {
+        std::ostringstream key;
+        key.precision(17);
+        key << m_Image->GetUID() << ":" << m_Image->GetMTime() << "|"
+            << (m_MaskGenerator.IsNotNull() ? m_MaskGenerator->GetCacheKey() : "none") << "|"
+            << (m_SecondaryMaskGenerator.IsNotNull() ? m_SecondaryMaskGenerator->GetCacheKey() : "none") << "|";
+        if (m_UseBinSizeOverNBins)
         {
-            StatisticsContainer::Pointer statisticsResult = StatisticsContainer::New();
-
-            // find min, max, minindex and maxindex
-            // make sure to only look in the masked region, use a masker for this
-
-            vnl_vector<int> minIndex, maxIndex;
-            mitk::Point3D worldCoordinateMin;
-            mitk::Point3D worldCoordinateMax;
-            mitk::Point3D indexCoordinateMin;
-            mitk::Point3D indexCoordinateMax;
-            m_InternalImageForStatistics->GetGeometry()->IndexToWorld(minMaxFilter->GetMinIndex(*it), worldCoordinateMin);
-            m_InternalImageForStatistics->GetGeometry()->IndexToWorld(minMaxFilter->GetMaxIndex(*it), worldCoordinateMax);
-            m_Image->GetGeometry()->WorldToIndex(worldCoordinateMin, indexCoordinateMin);
-            m_Image->GetGeometry()->WorldToIndex(worldCoordinateMax, indexCoordinateMax);
-
-            minIndex.set_size(3);
-            maxIndex.set_size(3);
-
-            //for (unsigned int i=0; i < tmpMaxIndex.GetIndexDimension(); i++)
-            for (unsigned int i=0; i < 3; i++)
-            {
-                minIndex[i] = indexCoordinateMin[i];
-                maxIndex[i] = indexCoordinateMax[i];
-            }
-
-            statisticsResult->SetMinIndex(minIndex);
-            statisticsResult->SetMaxIndex(maxIndex);
-
-            assert(std::abs(minMaxFilter->GetMax(*it) - imageStatisticsFilter->GetMaximum(*it)) < mitk::eps);
-            assert(std::abs(minMaxFilter->GetMin(*it) - imageStatisticsFilter->GetMinimum(*it)) < mitk::eps);
-
-
-            statisticsResult->SetN(imageStatisticsFilter->GetSum(*it) / (double) imageStatisticsFilter->GetMean(*it));
-            statisticsResult->SetMean(imageStatisticsFilter->GetMean(*it));
-            statisticsResult->SetMin(imageStatisticsFilter->GetMinimum(*it));
-            statisticsResult->SetMax(imageStatisticsFilter->GetMaximum(*it));
-            statisticsResult->SetVariance(imageStatisticsFilter->GetVariance(*it));
-            statisticsResult->SetStd(imageStatisticsFilter->GetSigma(*it));
-            statisticsResult->SetSkewness(imageStatisticsFilter->GetSkewness(*it));
-            statisticsResult->SetKurtosis(imageStatisticsFilter->GetKurtosis(*it));
-            statisticsResult->SetRMS(std::sqrt(std::pow(imageStatisticsFilter->GetMean(*it), 2.) + imageStatisticsFilter->GetVariance(*it))); // variance = sigma^2
-            statisticsResult->SetMPP(imageStatisticsFilter->GetMPP(*it));
-            statisticsResult->SetLabel(*it);
-
-            statisticsResult->SetEntropy(imageStatisticsFilter->GetEntropy(*it));
-            statisticsResult->SetMedian(imageStatisticsFilter->GetMedian(*it));
-            statisticsResult->SetUniformity(imageStatisticsFilter->GetUniformity(*it));
-            statisticsResult->SetUPP(imageStatisticsFilter->GetUPP(*it));
-            statisticsResult->SetHistogram(imageStatisticsFilter->GetHistogram(*it));
-
-            m_StatisticsByTimeStep[timeStep].push_back(statisticsResult);
-            ++it;
+            key << "binSize:" << m_binSizeForHistogramStatistics;
         }
-
-        // swap maskGenerators back
-        if (swapMasks)
+        else
         {
-            m_SecondaryMask = m_InternalMask;
-            m_InternalMask = nullptr;
+            key << "nBins:" << m_nBinsForHistogramStatistics;
         }
+        key << "|" << timeStep;
+        return key.str();
     }
 
     bool ImageStatisticsCalculator::IsUpdateRequired(unsigned int timeStep) const
@@ -8,6 +8,7 @@
 #include <limits>
 #include <itkObject.h>
 #include <itkSmartPointer.h>
+#include <itkTimeStamp.h>
 
 namespace mitk
 {
@@ -362,51 +363,82 @@ namespace mitk
          */
         StatisticsContainer::Pointer GetStatistics(unsigned int timeStep=0, unsigned int label=1);
 
+        /**Documentation
+        @brief Returns the statistics of all labels occurring in timeStep @a timeStep, computing them if necessary.*/
+        std::vector<StatisticsContainer::Pointer> GetStatisticsForAllLabels(unsigned int timeStep=0);
+
+        /**Documentation
+        @brief Computes the statistics of all time steps that are not up to date.
+        All labels of all these time steps are computed in a single parallel traversal, which is considerably faster for
+        time resolved images than requesting one time step after another. Afterwards GetStatistics() just returns the results.
+         */
+        void ComputeAllTimeSteps();
+
+        /**Documentation
+        @brief Whether results are shared through the ImageStatisticsCache (default). Statistics of a time step are
+        then only computed if no calculator has computed them before for the same image, masks and histogram settings.*/
+        itkSetMacro(UseStatisticsCache, bool);
+        itkGetConstMacro(UseStatisticsCache, bool);
+        itkBooleanMacro(UseStatisticsCache);
+
     protected:
         ImageStatisticsCalculator(){
             m_nBinsForHistogramStatistics = 100;
             m_binSizeForHistogramStatistics = 10;
             m_UseBinSizeOverNBins = false;
+            m_UseStatisticsCache = true;
         };
 
 
     private:
-        template < typename TPixel, unsigned int VImageDimension > void InternalCalculateStatisticsUnmasked(
-                typename itk::Image< TPixel, VImageDimension >* image,
-                unsigned int timeStep);
+        /**Documentation
+        @brief Computes the statistics of all labels of the given time steps in one traversal.*/
+        void CalculateStatistics(const std::vector<unsigned int> &requestedTimeSteps);
 
-        template < typename TPixel, unsigned int VImageDimension > typename HistogramType::Pointer InternalCalculateHistogramUnmasked(
+        template < typename TPixel, unsigned int VImageDimension > void InternalCalculateStatistics(
                 typename itk::Image< TPixel, VImageDimension >* image,
-                double minVal,
-                double maxVal);
+                const std::vector<unsigned int> &timeSteps);
 
-        template < typename TPixel, unsigned int VImageDimension > void InternalCalculateStatisticsMasked(
-                typename itk::Image< TPixel, VImageDimension >* image,
-                unsigned int timeStep);
+        /**Documentation
+        @brief Combines primary and secondary mask of a time step and crops @a image to the mask region.*/
+        template < typename TPixel, unsigned int VImageDimension >
+        typename itk::Image< MaskPixelType, VImageDimension >::Pointer InternalPrepareMask(
+                typename itk::Image< TPixel, VImageDimension >::Pointer &image,
+                unsigned int timeStep,
+                std::size_t timeStepIndex);
+
+        void CheckInput(unsigned int timeStep) const;
 
         bool IsUpdateRequired(unsigned int timeStep) const;
 
+        /**Documentation
+        @brief Identifies the statistics of @a timeStep in the ImageStatisticsCache.*/
+        std::string GetCacheKey(unsigned int timeStep);
+
         std::string GetNameOfClass()
         {
             return std::string("ImageStatisticsCalculator_v2");
         }
 
         mitk::Image::Pointer m_Image;
-        mitk::Image::Pointer m_ImageTimeSlice;
         mitk::Image::Pointer m_InternalImageForStatistics;
 
         mitk::MaskGenerator::Pointer m_MaskGenerator;
-        mitk::Image::Pointer m_InternalMask;
-
         mitk::MaskGenerator::Pointer m_SecondaryMaskGenerator;
-        mitk::Image::Pointer m_SecondaryMask;
+
+        // image time slices and masks of the time steps currently being calculated
+        std::vector<mitk::Image::Pointer> m_ImageTimeSlices;
+        std::vector<mitk::Image::Pointer> m_InternalMasks;
+        std::vector<mitk::Image::Pointer> m_SecondaryMasks;
 
         unsigned int m_nBinsForHistogramStatistics;
         double m_binSizeForHistogramStatistics;
         bool m_UseBinSizeOverNBins;
+        bool m_UseStatisticsCache;
 
         std::vector<std::vector<StatisticsContainer::Pointer>> m_StatisticsByTimeStep;
         std::vector<unsigned long> m_StatisticsUpdateTimePerTimeStep;
+        itk::TimeStamp m_StatisticsUpdateTime;
     };
 
 }
@@ -1,5 +1,7 @@
 #include <mitkMaskGenerator.h>
 
+#include <sstream>
+
 namespace mitk
 {
 
@@ -48,4 +50,23 @@ mitk::Image::Pointer MaskGenerator::GetReferenceImage()
 {
     return m_inputImage;
 }
+
+std::string MaskGenerator::GetCacheKey()
+{
+    std::ostringstream key;
+    key << this->GetNameOfClass() << "@" << this << ":" << this->GetMTime() << "/" << GetCacheKeyOf(m_inputImage);
+    return key.str();
+}
+
+std::string MaskGenerator::GetCacheKeyOf(const mitk::BaseData *data)
+{
+    if (data == nullptr)
+    {
+        return "none";
+    }
+
+    std::ostringstream key;
+    key << data->GetUID() << ":" << data->GetMTime();
+    return key.str();
+}
 }
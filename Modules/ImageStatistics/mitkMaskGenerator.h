@@ -7,6 +7,8 @@
 #include <itkObject.h>
 #include <itkSmartPointer.h>
 
+#include <string>
+
 namespace mitk
 {
 /**
@@ -50,9 +52,22 @@ public:
 
     virtual void SetTimeStep(unsigned int timeStep);
 
+    /**
+     * @brief GetCacheKey returns a string that changes whenever the mask returned by GetMask() may change. It is used
+     * by the ImageStatisticsCache to identify statistics computed with this mask. The default implementation depends
+     * on the identity and modified time of the generator and its input image. Derived classes should depend on the
+     * mask source (image, planar figure, ...) instead, so that new generators for the same source share cache entries.
+     */
+    virtual std::string GetCacheKey();
+
 protected:
     MaskGenerator();
 
+    /**
+     * @brief Returns "UID:MTime" of data or "none" if data is a nullptr.
+     */
+    static std::string GetCacheKeyOf(const mitk::BaseData *data);
+
     unsigned int m_TimeStep;
     mitk::Image::Pointer m_InternalMask;
     mitk::Image::Pointer m_inputImage;
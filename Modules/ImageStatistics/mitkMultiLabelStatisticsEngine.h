@@ -0,0 +1,166 @@
+#ifndef MITKMULTILABELSTATISTICSENGINE
+#define MITKMULTILABELSTATISTICSENGINE
+
+#include <itkImage.h>
+#include <itkHistogram.h>
+
+#include <limits>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace mitk
+{
+    /**
+    @brief Computes first order statistics, min/max indices and histograms of all labels of all time steps at once.
+
+    Every time step is given as an image and an optional label image covering the same region. Without a label
+    image all pixels belong to label 1. Compute() splits the lines of all time steps into one chunk per thread and
+    traverses every pixel once. Each thread keeps its own accumulators per time step and label, which are merged
+    in line order afterwards, so results do not depend on the number of threads.
+
+    Moments are accumulated with Welford's method (and its extension to third and fourth order moments), which is
+    numerically stable also for large images, and per thread results are combined pairwise. For pixel types of at
+    most 16 bit the threads count the occurrences of every value instead, so moments and histograms are derived
+    from these counts without another traversal. All other pixel types need a second traversal for the histograms,
+    once the value range of each label is known.
+
+    The statistics definitions match those of itk::ExtendedLabelStatisticsImageFilter: variance is the population
+    variance, the kurtosis is not corrected by -3, and the histogram of each label spans its min and max value.
+    */
+    template <typename TPixel, unsigned int VImageDimension>
+    class MultiLabelStatisticsEngine
+    {
+    public:
+        typedef itk::Image<TPixel, VImageDimension> ImageType;
+        typedef unsigned short LabelPixelType;
+        typedef itk::Image<LabelPixelType, VImageDimension> LabelImageType;
+        typedef typename ImageType::IndexType IndexType;
+        typedef typename ImageType::RegionType RegionType;
+        typedef itk::Statistics::Histogram<double> HistogramType;
+
+        struct LabelStatistics
+        {
+            itk::SizeValueType N;
+            double Mean;
+            double Variance;
+            double Skewness;
+            double Kurtosis;
+            double MPP;
+            double Min;
+            double Max;
+            IndexType MinIndex;
+            IndexType MaxIndex;
+            HistogramType::Pointer Histogram;
+            double Median;
+            double Entropy;
+            double Uniformity;
+            double UPP;
+        };
+
+        typedef std::map<LabelPixelType, LabelStatistics> LabelStatisticsMapType;
+
+        MultiLabelStatisticsEngine();
+
+        /** @brief Number of threads used by Compute(). 0 (default) uses one thread per hardware thread. */
+        void SetNumberOfThreads(unsigned int numberOfThreads) { m_NumberOfThreads = numberOfThreads; }
+        unsigned int GetNumberOfThreads() const { return m_NumberOfThreads; }
+
+        /** @brief Use a fixed number of bins for every histogram. */
+        void SetNumberOfBins(unsigned int numberOfBins);
+
+        /** @brief Derive the number of bins of every histogram from its value range, using at least 10 bins. */
+        void SetBinSize(double binSize);
+
+        /**
+        @brief Adds time step @a timeStep.
+        The statistics are computed over the buffered region of @a image, which @a labelImage has to contain.
+        Both images have to be kept alive until Compute() has returned.
+        */
+        void AddTimeStep(unsigned int timeStep, const ImageType *image, const LabelImageType *labelImage = nullptr);
+
+        /** @brief Removes all time steps and results. */
+        void Clear();
+
+        /** @brief Computes the statistics of all labels of all added time steps. */
+        void Compute();
+
+        /** @brief Statistics of all labels occurring in time step @a timeStep. */
+        const LabelStatisticsMapType &GetStatistics(unsigned int timeStep) const;
+
+    private:
+        /** Occurrences of every value of a pixel type of at most 16 bit, allocated in pages of 256 values. */
+        class ValueCounts
+        {
+        public:
+            void Add(TPixel value);
+            void Merge(const ValueCounts &other);
+            template <typename TFunction> void ForEach(TFunction function) const;
+
+        private:
+            static std::size_t Offset(TPixel value);
+
+            std::vector<std::unique_ptr<itk::SizeValueType[]>> m_Pages;
+        };
+
+        /** Running moments, extrema and value counts of one label within one chunk of lines. */
+        struct Accumulator
+        {
+            Accumulator();
+
+            void Add(TPixel value, const IndexType &index);
+            void Merge(const Accumulator &other);
+
+            /** Combines the moments with those of n further values of mean mean and central moments m2 to m4. */
+            void MergeMoments(itk::SizeValueType n, double mean, double m2, double m3, double m4);
+
+            itk::SizeValueType N;
+            double Mean;
+            double M2;
+            double M3;
+            double M4;
+            itk::SizeValueType PositiveN;
+            double PositiveSum;
+            TPixel Min;
+            TPixel Max;
+            IndexType MinIndex;
+            IndexType MaxIndex;
+            ValueCounts Counts;
+        };
+
+        typedef std::map<LabelPixelType, Accumulator> AccumulatorMapType;
+        typedef std::map<LabelPixelType, std::vector<double>> FrequenciesMapType;
+
+        struct TimeStep
+        {
+            unsigned int Number;
+            const ImageType *Image;
+            const LabelImageType *LabelImage;
+            LabelStatisticsMapType Statistics;
+        };
+
+        static const bool CountValues = std::numeric_limits<TPixel>::is_integer && sizeof(TPixel) <= 2;
+
+        /** Calls function(value, label, index) for all pixels of lines [firstLine, endLine) of timeStep. */
+        template <typename TFunction>
+        void ForEachPixel(const TimeStep &timeStep, itk::SizeValueType firstLine, itk::SizeValueType endLine,
+            TFunction function) const;
+
+        /** Runs function(timeStepIndex, chunk, firstLine, endLine) for all chunks of all time steps in parallel. */
+        template <typename TFunction>
+        void ForEachChunk(unsigned int numberOfChunks, TFunction function) const;
+
+        HistogramType::Pointer CreateHistogram(double min, double max) const;
+
+        unsigned int m_NumberOfThreads;
+        unsigned int m_NumberOfBins;
+        double m_BinSize;
+        bool m_UseBinSize;
+
+        std::vector<TimeStep> m_TimeSteps;
+    };
+}
+
+#include "mitkMultiLabelStatisticsEngine.hxx"
+
+#endif
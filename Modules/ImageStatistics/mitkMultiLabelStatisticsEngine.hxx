@@ -0,0 +1,518 @@
+#ifndef MITKMULTILABELSTATISTICSENGINE_HXX
+#define MITKMULTILABELSTATISTICSENGINE_HXX
+
+#include <mitkMultiLabelStatisticsEngine.h>
+#include <mitkHistogramStatisticsCalculator.h>
+#include <mitkExceptionMacro.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+namespace mitk
+{
+    template <typename TPixel, unsigned int VImageDimension>
+    void MultiLabelStatisticsEngine<TPixel, VImageDimension>::ValueCounts::Add(TPixel value)
+    {
+        if (m_Pages.empty())
+        {
+            m_Pages.resize((sizeof(TPixel) == 1 ? 256 : 65536) / 256);
+        }
+
+        const std::size_t offset = Offset(value);
+        std::unique_ptr<itk::SizeValueType[]> &page = m_Pages[offset >> 8];
+        if (!page)
+        {
+            page.reset(new itk::SizeValueType[256]());
+        }
+        ++page[offset & 255];
+    }
+
+    template <typename TPixel, unsigned int VImageDimension>
+    void MultiLabelStatisticsEngine<TPixel, VImageDimension>::ValueCounts::Merge(const ValueCounts &other)
+    {
+        if (m_Pages.empty())
+        {
+            m_Pages.resize(other.m_Pages.size());
+        }
+
+        for (std::size_t i = 0; i < other.m_Pages.size(); ++i)
+        {
+            if (!other.m_Pages[i])
+                continue;
+
+            if (!m_Pages[i])
+            {
+                m_Pages[i].reset(new itk::SizeValueType[256]());
+            }
+
+            for (std::size_t j = 0; j < 256; ++j)
+            {
+                m_Pages[i][j] += other.m_Pages[i][j];
+            }
+        }
+    }
+
+    template <typename TPixel, unsigned int VImageDimension>
+    template <typename TFunction>
+    void MultiLabelStatisticsEngine<TPixel, VImageDimension>::ValueCounts::ForEach(TFunction function) const
+    {
+        const auto lowest = static_cast<long long>(std::numeric_limits<TPixel>::lowest());
+
+        for (std::size_t i = 0; i < m_Pages.size(); ++i)
+        {
+            if (!m_Pages[i])
+                continue;
+
+            for (std::size_t j = 0; j < 256; ++j)
+            {
+                if (0 != m_Pages[i][j])
+                {
+                    function(static_cast<TPixel>(lowest + static_cast<long long>(i * 256 + j)), m_Pages[i][j]);
+                }
+            }
+        }
+    }
+
+    template <typename TPixel, unsigned int VImageDimension>
+    std::size_t MultiLabelStatisticsEngine<TPixel, VImageDimension>::ValueCounts::Offset(TPixel value)
+    {
+        return static_cast<std::size_t>(static_cast<long long>(value) -
+            static_cast<long long>(std::numeric_limits<TPixel>::lowest()));
+    }
+
+    template <typename TPixel, unsigned int VImageDimension>
+    MultiLabelStatisticsEngine<TPixel, VImageDimension>::Accumulator::Accumulator()
+        : N(0),
+          Mean(0.0),
+          M2(0.0),
+          M3(0.0),
+          M4(0.0),
+          PositiveN(0),
+          PositiveSum(0.0),
+          Min(std::numeric_limits<TPixel>::max()),
+          Max(std::numeric_limits<TPixel>::lowest())
+    {
+        MinIndex.Fill(0);
+        MaxIndex.Fill(0);
+    }
+
+    template <typename TPixel, unsigned int VImageDimension>
+    void MultiLabelStatisticsEngine<TPixel, VImageDimension>::Accumulator::Add(TPixel value, const IndexType &index)
+    {
+        if (value < Min)
+        {
+            Min = value;
+            MinIndex = index;
+        }
+        if (value > Max)
+        {
+            Max = value;
+            MaxIndex = index;
+        }
+
+        const double x = static_cast<double>(value);
+        if (x > 0)
+        {
+            ++PositiveN;
+            PositiveSum += x;
+        }
+
+        if (CountValues)
+        {
+            // moments are computed from the value counts once all chunks are merged
+            ++N;
+            Counts.Add(value);
+            return;
+        }
+
+        // Welford update extended to the third and fourth central moment
+        const double n1 = static_cast<double>(N);
+        ++N;
+        const double n = static_cast<double>(N);
+        const double delta = x - Mean;
+        const double deltaN = delta / n;
+        const double deltaN2 = deltaN * deltaN;
+        const double term1 = delta * deltaN * n1;
+
+        Mean += deltaN;
+        M4 += term1 * deltaN2 * (n * n - 3. * n + 3.) + 6. * deltaN2 * M2 - 4. * deltaN * M3;
+        M3 += term1 * deltaN * (n - 2.) - 3. * deltaN * M2;
+        M2 += term1;
+    }
+
+    template <typename TPixel, unsigned int VImageDimension>
+    void MultiLabelStatisticsEngine<TPixel, VImageDimension>::Accumulator::Merge(const Accumulator &other)
+    {
+        if (0 == other.N)
+            return;
+
+        // other always covers later lines, so on equal values the first occurrence is kept
+        if (other.Min < Min)
+        {
+            Min = other.Min;
+            MinIndex = other.MinIndex;
+        }
+        if (other.Max > Max)
+        {
+            Max = other.Max;
+            MaxIndex = other.MaxIndex;
+        }
+
+        PositiveN += other.PositiveN;
+        PositiveSum += other.PositiveSum;
+
+        if (CountValues)
+        {
+            N += other.N;
+            Counts.Merge(other.Counts);
+            return;
+        }
+
+        this->MergeMoments(other.N, other.Mean, other.M2, other.M3, other.M4);
+    }
+
+    template <typename TPixel, unsigned int VImageDimension>
+    void MultiLabelStatisticsEngine<TPixel, VImageDimension>::Accumulator::MergeMoments(
+        itk::SizeValueType n, double mean, double m2, double m3, double m4)
+    {
+        // pairwise combination of central moments, see Pebay (2008), Formulas for robust, one-pass parallel
+        // computation of covariances and arbitrary-order statistical moments
+        const double na = static_cast<double>(N);
+        const double nb = static_cast<double>(n);
+        const double nab = na + nb;
+        const double delta = mean - Mean;
+        const double delta2 = delta * delta;
+
+        M4 += m4 + delta2 * delta2 * na * nb * (na * na - na * nb + nb * nb) / (nab * nab * nab) +
+              6. * delta2 * (na * na * m2 + nb * nb * M2) / (nab * nab) + 4. * delta * (na * m3 - nb * M3) / nab;
+        M3 += m3 + delta * delta2 * na * nb * (na - nb) / (nab * nab) + 3. * delta * (na * m2 - nb * M2) / nab;
+        M2 += m2 + delta2 * na * nb / nab;
+        Mean += delta * nb / nab;
+        N += n;
+    }
+
+    template <typename TPixel, unsigned int VImageDimension>
+    MultiLabelStatisticsEngine<TPixel, VImageDimension>::MultiLabelStatisticsEngine()
+        : m_NumberOfThreads(0), m_NumberOfBins(100), m_BinSize(10.0), m_UseBinSize(false)
+    {
+    }
+
+    template <typename TPixel, unsigned int VImageDimension>
+    void MultiLabelStatisticsEngine<TPixel, VImageDimension>::SetNumberOfBins(unsigned int numberOfBins)
+    {
+        m_NumberOfBins = numberOfBins;
+        m_UseBinSize = false;
+    }
+
+    template <typename TPixel, unsigned int VImageDimension>
+    void MultiLabelStatisticsEngine<TPixel, VImageDimension>::SetBinSize(double binSize)
+    {
+        m_BinSize = binSize;
+        m_UseBinSize = true;
+    }
+
+    template <typename TPixel, unsigned int VImageDimension>
+    void MultiLabelStatisticsEngine<TPixel, VImageDimension>::AddTimeStep(
+        unsigned int timeStep, const ImageType *image, const LabelImageType *labelImage)
+    {
+        if (nullptr == image)
+        {
+            mitkThrow() << "No image given for time step " << timeStep;
+        }
+
+        if (nullptr != labelImage && !labelImage->GetBufferedRegion().IsInside(image->GetBufferedRegion()))
+        {
+            mitkThrow() << "Label image of time step " << timeStep << " does not cover the image region";
+        }
+
+        TimeStep entry;
+        entry.Number = timeStep;
+        entry.Image = image;
+        entry.LabelImage = labelImage;
+        m_TimeSteps.push_back(entry);
+    }
+
+    template <typename TPixel, unsigned int VImageDimension>
+    void MultiLabelStatisticsEngine<TPixel, VImageDimension>::Clear()
+    {
+        m_TimeSteps.clear();
+    }
+
+    template <typename TPixel, unsigned int VImageDimension>
+    const typename MultiLabelStatisticsEngine<TPixel, VImageDimension>::LabelStatisticsMapType &
+        MultiLabelStatisticsEngine<TPixel, VImageDimension>::GetStatistics(unsigned int timeStep) const
+    {
+        for (const auto &entry : m_TimeSteps)
+        {
+            if (entry.Number == timeStep)
+                return entry.Statistics;
+        }
+
+        mitkThrow() << "Time step " << timeStep << " was not added";
+    }
+
+    template <typename TPixel, unsigned int VImageDimension>
+    template <typename TFunction>
+    void MultiLabelStatisticsEngine<TPixel, VImageDimension>::ForEachPixel(
+        const TimeStep &timeStep, itk::SizeValueType firstLine, itk::SizeValueType endLine, TFunction function) const
+    {
+        const RegionType &region = timeStep.Image->GetBufferedRegion();
+        const itk::SizeValueType lineLength = region.GetSize(0);
+
+        for (itk::SizeValueType line = firstLine; line < endLine; ++line)
+        {
+            IndexType index = region.GetIndex();
+            itk::SizeValueType remainder = line;
+            for (unsigned int dim = 1; dim < VImageDimension; ++dim)
+            {
+                index[dim] += static_cast<itk::IndexValueType>(remainder % region.GetSize(dim));
+                remainder /= region.GetSize(dim);
+            }
+
+            const TPixel *values = timeStep.Image->GetBufferPointer() + timeStep.Image->ComputeOffset(index);
+            const LabelPixelType *labels = nullptr != timeStep.LabelImage
+                ? timeStep.LabelImage->GetBufferPointer() + timeStep.LabelImage->ComputeOffset(index)
+                : nullptr;
+
+            for (itk::SizeValueType x = 0; x < lineLength; ++x, ++index[0])
+            {
+                function(values[x], nullptr != labels ? labels[x] : LabelPixelType(1), index);
+            }
+        }
+    }
+
+    template <typename TPixel, unsigned int VImageDimension>
+    template <typename TFunction>
+    void MultiLabelStatisticsEngine<TPixel, VImageDimension>::ForEachChunk(
+        unsigned int numberOfChunks, TFunction function) const
+    {
+        const std::size_t numberOfItems = m_TimeSteps.size() * numberOfChunks;
+        std::atomic<std::size_t> nextItem(0);
+
+        auto worker = [&]() {
+            for (std::size_t item = nextItem++; item < numberOfItems; item = nextItem++)
+            {
+                const std::size_t timeStepIndex = item / numberOfChunks;
+                const unsigned int chunk = static_cast<unsigned int>(item % numberOfChunks);
+
+                const RegionType &region = m_TimeSteps[timeStepIndex].Image->GetBufferedRegion();
+                if (0 == region.GetSize(0))
+                    continue;
+
+                const itk::SizeValueType numberOfLines = region.GetNumberOfPixels() / region.GetSize(0);
+                function(timeStepIndex,
+                    chunk,
+                    numberOfLines * chunk / numberOfChunks,
+                    numberOfLines * (chunk + 1) / numberOfChunks);
+            }
+        };
+
+        const std::size_t numberOfThreads = std::min<std::size_t>(numberOfChunks, numberOfItems);
+
+        std::vector<std::thread> threads;
+        for (std::size_t i = 1; i < numberOfThreads; ++i)
+        {
+            threads.emplace_back(worker);
+        }
+
+        worker();
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    template <typename TPixel, unsigned int VImageDimension>
+    typename MultiLabelStatisticsEngine<TPixel, VImageDimension>::HistogramType::Pointer
+        MultiLabelStatisticsEngine<TPixel, VImageDimension>::CreateHistogram(double min, double max) const
+    {
+        unsigned int numberOfBins = m_NumberOfBins;
+        if (m_UseBinSize)
+        {
+            // do not allow less than 10 bins
+            numberOfBins = std::max(static_cast<double>(std::ceil(max - min)) / m_BinSize, 10.);
+        }
+
+        HistogramType::Pointer histogram = HistogramType::New();
+        HistogramType::SizeType size;
+        HistogramType::MeasurementVectorType lowerBound;
+        HistogramType::MeasurementVectorType upperBound;
+        size.SetSize(1);
+        lowerBound.SetSize(1);
+        upperBound.SetSize(1);
+        histogram->SetMeasurementVectorSize(1);
+        size[0] = numberOfBins;
+        lowerBound[0] = min;
+        upperBound[0] = max;
+        histogram->Initialize(size, lowerBound, upperBound);
+
+        return histogram;
+    }
+
+    template <typename TPixel, unsigned int VImageDimension>
+    void MultiLabelStatisticsEngine<TPixel, VImageDimension>::Compute()
+    {
+        const unsigned int numberOfChunks =
+            0 != m_NumberOfThreads ? m_NumberOfThreads : std::max(1u, std::thread::hardware_concurrency());
+
+        // 1. Accumulate moments, extrema and (for small integer types) value counts of all chunks
+        std::vector<AccumulatorMapType> chunkAccumulators(m_TimeSteps.size() * numberOfChunks);
+
+        this->ForEachChunk(numberOfChunks,
+            [&](std::size_t timeStepIndex, unsigned int chunk,
+                itk::SizeValueType firstLine, itk::SizeValueType endLine) {
+                AccumulatorMapType &accumulators = chunkAccumulators[timeStepIndex * numberOfChunks + chunk];
+                Accumulator *accumulator = nullptr;
+                LabelPixelType currentLabel = 0;
+
+                this->ForEachPixel(m_TimeSteps[timeStepIndex], firstLine, endLine,
+                    [&](TPixel value, LabelPixelType label, const IndexType &index) {
+                        // labels usually come in long runs, so the map is only searched when the label changes
+                        if (nullptr == accumulator || label != currentLabel)
+                        {
+                            accumulator = &accumulators[label];
+                            currentLabel = label;
+                        }
+                        accumulator->Add(value, index);
+                    });
+            });
+
+        // 2. Merge the chunks of each time step in line order
+        std::vector<AccumulatorMapType> accumulatorsByTimeStep(m_TimeSteps.size());
+        for (std::size_t t = 0; t < m_TimeSteps.size(); ++t)
+        {
+            for (unsigned int chunk = 0; chunk < numberOfChunks; ++chunk)
+            {
+                for (const auto &entry : chunkAccumulators[t * numberOfChunks + chunk])
+                {
+                    accumulatorsByTimeStep[t][entry.first].Merge(entry.second);
+                }
+            }
+        }
+        chunkAccumulators.clear();
+
+        // 3. Derive the statistics and create the histograms
+        for (std::size_t t = 0; t < m_TimeSteps.size(); ++t)
+        {
+            LabelStatisticsMapType &statisticsMap = m_TimeSteps[t].Statistics;
+            statisticsMap.clear();
+
+            for (auto &entry : accumulatorsByTimeStep[t])
+            {
+                Accumulator &accumulator = entry.second;
+                LabelStatistics &statistics = statisticsMap[entry.first];
+                statistics.Histogram = this->CreateHistogram(accumulator.Min, accumulator.Max);
+
+                if (CountValues)
+                {
+                    HistogramType::MeasurementVectorType measurement(1);
+                    HistogramType::IndexType histogramIndex(1);
+                    Accumulator moments;
+
+                    accumulator.Counts.ForEach([&](TPixel value, itk::SizeValueType count) {
+                        measurement[0] = value;
+                        statistics.Histogram->GetIndex(measurement, histogramIndex);
+                        statistics.Histogram->IncreaseFrequencyOfIndex(histogramIndex, count);
+
+                        // count equal values have no spread, so they merge like a single weighted sample
+                        moments.MergeMoments(count, value, 0., 0., 0.);
+                    });
+
+                    accumulator.Mean = moments.Mean;
+                    accumulator.M2 = moments.M2;
+                    accumulator.M3 = moments.M3;
+                    accumulator.M4 = moments.M4;
+                }
+
+                const double n = static_cast<double>(accumulator.N);
+                const double secondMoment = accumulator.M2 / n;
+
+                statistics.N = accumulator.N;
+                statistics.Mean = accumulator.Mean;
+                statistics.Variance = secondMoment;
+                statistics.Skewness = (accumulator.M3 / n) / std::pow(secondMoment, 1.5);
+                statistics.Kurtosis = (accumulator.M4 / n) / (secondMoment * secondMoment);
+                statistics.MPP = accumulator.PositiveSum / static_cast<double>(accumulator.PositiveN);
+                statistics.Min = accumulator.Min;
+                statistics.Max = accumulator.Max;
+                statistics.MinIndex = accumulator.MinIndex;
+                statistics.MaxIndex = accumulator.MaxIndex;
+            }
+        }
+
+        // 4. Without value counts the histograms need a second traversal
+        if (!CountValues)
+        {
+            std::vector<FrequenciesMapType> chunkFrequencies(m_TimeSteps.size() * numberOfChunks);
+
+            this->ForEachChunk(numberOfChunks,
+                [&](std::size_t timeStepIndex, unsigned int chunk,
+                itk::SizeValueType firstLine, itk::SizeValueType endLine) {
+                    const LabelStatisticsMapType &statisticsMap = m_TimeSteps[timeStepIndex].Statistics;
+                    FrequenciesMapType &frequencies = chunkFrequencies[timeStepIndex * numberOfChunks + chunk];
+
+                    HistogramType::MeasurementVectorType measurement(1);
+                    HistogramType::IndexType histogramIndex(1);
+                    const HistogramType *histogram = nullptr;
+                    std::vector<double> *labelFrequencies = nullptr;
+                    LabelPixelType currentLabel = 0;
+
+                    this->ForEachPixel(m_TimeSteps[timeStepIndex], firstLine, endLine,
+                        [&](TPixel value, LabelPixelType label, const IndexType &) {
+                            if (nullptr == histogram || label != currentLabel)
+                            {
+                                histogram = statisticsMap.find(label)->second.Histogram;
+                                labelFrequencies = &frequencies[label];
+                                labelFrequencies->resize(histogram->Size(), 0.0);
+                                currentLabel = label;
+                            }
+
+                            measurement[0] = value;
+                            histogram->GetIndex(measurement, histogramIndex);
+                            if (histogramIndex[0] >= 0 &&
+                                histogramIndex[0] < static_cast<itk::IndexValueType>(histogram->Size()))
+                            {
+                                ++(*labelFrequencies)[histogramIndex[0]];
+                            }
+                        });
+                });
+
+            for (std::size_t t = 0; t < m_TimeSteps.size(); ++t)
+            {
+                for (unsigned int chunk = 0; chunk < numberOfChunks; ++chunk)
+                {
+                    for (const auto &entry : chunkFrequencies[t * numberOfChunks + chunk])
+                    {
+                        HistogramType *histogram = m_TimeSteps[t].Statistics[entry.first].Histogram;
+                        for (std::size_t bin = 0; bin < entry.second.size(); ++bin)
+                        {
+                            histogram->IncreaseFrequency(bin, entry.second[bin]);
+                        }
+                    }
+                }
+            }
+        }
+
+        // 5. Histogram based statistics
+        for (auto &timeStep : m_TimeSteps)
+        {
+            for (auto &entry : timeStep.Statistics)
+            {
+                LabelStatistics &statistics = entry.second;
+
+                mitk::HistogramStatisticsCalculator histStatCalc;
+                histStatCalc.SetHistogram(statistics.Histogram);
+                histStatCalc.CalculateStatistics();
+                statistics.Median = histStatCalc.GetMedian();
+                statistics.Entropy = histStatCalc.GetEntropy();
+                statistics.Uniformity = histStatCalc.GetUniformity();
+                statistics.UPP = histStatCalc.GetUPP();
+            }
+        }
+    }
+}
+
+#endif
@@ -8,20 +8,177 @@
 #include <mitkIOUtil.h>
 
 #include <itkCastImageFilter.h>
-#include <itkVTKImageExport.h>
-#include <itkVTKImageImport.h>
 #include <itkImageDuplicator.h>
 #include <itkExceptionObject.h>
 #include <itkLineIterator.h>
 
 #include <vtkPoints.h>
-#include <vtkImageStencil.h>
-#include <vtkImageImport.h>
-#include <vtkImageExport.h>
-#include <vtkLassoStencilSource.h>
 #include <vtkSmartPointer.h>
 
+#include <algorithm>
+#include <cmath>
 
+namespace
+{
+  /**
+   * Calls function(y, begin, end) for all spans [begin, end) of pixels of row y whose center lies inside or on the
+   * border of the closed polygon given in index coordinates (even-odd rule). Only the rows of the polygon's bounding
+   * box are visited.
+   */
+  template <typename TFunction>
+  void FillPolygonSpans(vtkPoints *points, itk::IndexValueType width, itk::IndexValueType height, TFunction function)
+  {
+    const vtkIdType numberOfPoints = points->GetNumberOfPoints();
+    if (numberOfPoints < 3)
+      return;
+
+    double bounds[6];
+    points->GetBounds(bounds);
+    const auto firstRow = std::max<itk::IndexValueType>(0, static_cast<itk::IndexValueType>(std::ceil(bounds[2] - mitk::eps)));
+    const auto lastRow = std::min<itk::IndexValueType>(height - 1, static_cast<itk::IndexValueType>(std::floor(bounds[3] + mitk::eps)));
+
+    typedef std::pair<double, double> IntervalType;
+    std::vector<double> crossings;
+    std::vector<IntervalType> intervals;
+    std::vector<std::pair<itk::IndexValueType, itk::IndexValueType>> spans;
+
+    for (itk::IndexValueType y = firstRow; y <= lastRow; ++y)
+    {
+      crossings.clear();
+      intervals.clear();
+      for (vtkIdType i = 0; i < numberOfPoints; ++i)
+      {
+        double p0[3], p1[3];
+        points->GetPoint(i, p0);
+        points->GetPoint((i + 1) % numberOfPoints, p1);
+
+        // interior: half open in y, so that vertices on the scanline are counted once
+        if ((p0[1] <= y && y < p1[1]) || (p1[1] <= y && y < p0[1]))
+        {
+          crossings.push_back(p0[0] + (y - p0[1]) * (p1[0] - p0[0]) / (p1[1] - p0[1]));
+        }
+
+        // border: pixel centers on an edge belong to the polygon as well
+        if (std::min(p0[1], p1[1]) - mitk::eps <= y && y <= std::max(p0[1], p1[1]) + mitk::eps)
+        {
+          if (std::abs(p1[1] - p0[1]) < mitk::eps)
+          {
+            intervals.emplace_back(std::min(p0[0], p1[0]), std::max(p0[0], p1[0]));
+          }
+          else
+          {
+            const double t = std::min(1.0, std::max(0.0, (y - p0[1]) / (p1[1] - p0[1])));
+            const double x = p0[0] + t * (p1[0] - p0[0]);
+            intervals.emplace_back(x, x);
+          }
+        }
+      }
+
+      std::sort(crossings.begin(), crossings.end());
+      for (std::size_t i = 0; i + 1 < crossings.size(); i += 2)
+      {
+        intervals.emplace_back(crossings[i], crossings[i + 1]);
+      }
+
+      // pixel spans of all intervals, merged where they overlap or touch
+      spans.clear();
+      for (const IntervalType &interval : intervals)
+      {
+        const auto begin = std::max<itk::IndexValueType>(0, static_cast<itk::IndexValueType>(std::ceil(interval.first - mitk::eps)));
+        const auto end = std::min<itk::IndexValueType>(width, static_cast<itk::IndexValueType>(std::floor(interval.second + mitk::eps)) + 1);
+        if (begin < end)
+        {
+          spans.emplace_back(begin, end);
+        }
+      }
+      std::sort(spans.begin(), spans.end());
+
+      for (std::size_t i = 0; i < spans.size();)
+      {
+        itk::IndexValueType begin = spans[i].first;
+        itk::IndexValueType end = spans[i].second;
+        for (++i; i < spans.size() && spans[i].first <= end; ++i)
+        {
+          end = std::max(end, spans[i].second);
+        }
+        function(y, begin, end);
+      }
+    }
+  }
+
+  /**
+   * Computes the exact fraction of each pixel covered by the closed polygon given in index coordinates, within the
+   * pixels [x, x + width) x [y, y + height) of the polygon's bounding box. Each edge is split at the pixel borders,
+   * every piece adds its signed height (cover) to the pixels right of it and the area right of it within its own
+   * pixel, so that a running sum along each row yields the coverage.
+   */
+  void ComputePolygonCoverage(vtkPoints *points, std::vector<double> &coverage,
+    itk::IndexValueType &x, itk::IndexValueType &y, itk::IndexValueType &width, itk::IndexValueType &height)
+  {
+    double bounds[6];
+    points->GetBounds(bounds);
+
+    // pixel (i, j) covers [i - 0.5, i + 0.5) x [j - 0.5, j + 0.5)
+    x = static_cast<itk::IndexValueType>(std::floor(bounds[0] + 0.5));
+    y = static_cast<itk::IndexValueType>(std::floor(bounds[2] + 0.5));
+    width = static_cast<itk::IndexValueType>(std::floor(bounds[1] + 0.5)) - x + 1;
+    height = static_cast<itk::IndexValueType>(std::floor(bounds[3] + 0.5)) - y + 1;
+
+    std::vector<double> cover(width * height, 0.0);
+    std::vector<double> area(width * height, 0.0);
+
+    const vtkIdType numberOfPoints = points->GetNumberOfPoints();
+    std::vector<double> parameters;
+    for (vtkIdType i = 0; i < numberOfPoints; ++i)
+    {
+      double p0[3], p1[3];
+      points->GetPoint(i, p0);
+      points->GetPoint((i + 1) % numberOfPoints, p1);
+
+      const double x0 = p0[0] + 0.5 - x, y0 = p0[1] + 0.5 - y;
+      const double dx = p1[0] - p0[0], dy = p1[1] - p0[1];
+      if (dy == 0.0)
+        continue;
+
+      // split the edge where it crosses pixel borders
+      parameters.assign(1, 0.0);
+      parameters.push_back(1.0);
+      for (double border = std::floor(std::min(x0, x0 + dx)) + 1.0; dx != 0.0 && border < std::max(x0, x0 + dx); ++border)
+        parameters.push_back((border - x0) / dx);
+      for (double border = std::floor(std::min(y0, y0 + dy)) + 1.0; border < std::max(y0, y0 + dy); ++border)
+        parameters.push_back((border - y0) / dy);
+      std::sort(parameters.begin(), parameters.end());
+
+      for (std::size_t j = 0; j + 1 < parameters.size(); ++j)
+      {
+        const double t0 = parameters[j], t1 = parameters[j + 1];
+        if (t1 <= t0)
+          continue;
+
+        const double middleX = x0 + 0.5 * (t0 + t1) * dx;
+        const double middleY = y0 + 0.5 * (t0 + t1) * dy;
+        const auto cellX = std::min(width - 1, std::max<itk::IndexValueType>(0, static_cast<itk::IndexValueType>(std::floor(middleX))));
+        const auto cellY = std::min(height - 1, std::max<itk::IndexValueType>(0, static_cast<itk::IndexValueType>(std::floor(middleY))));
+
+        const double pieceHeight = (t1 - t0) * dy;
+        cover[cellY * width + cellX] += pieceHeight;
+        area[cellY * width + cellX] += pieceHeight * (cellX + 1 - middleX);
+      }
+    }
+
+    coverage.assign(width * height, 0.0);
+    for (itk::IndexValueType row = 0; row < height; ++row)
+    {
+      double accumulatedCover = 0.0;
+      for (itk::IndexValueType column = 0; column < width; ++column)
+      {
+        const itk::IndexValueType cell = row * width + column;
+        coverage[cell] = std::min(1.0, std::abs(accumulatedCover + area[cell]));
+        accumulatedCover += cover[cell];
+      }
+    }
+  }
+}
 
 namespace mitk
 {
@@ -77,11 +234,10 @@ void PlanarFigureMaskGenerator::InternalCalculateMaskFromPlanarFigure(
   maskImage->SetDirection(image->GetDirection());
   maskImage->SetNumberOfComponentsPerPixel(image->GetNumberOfComponentsPerPixel());
   maskImage->Allocate();
-  maskImage->FillBuffer(1);
+  maskImage->FillBuffer(0);
 
-  // all PolylinePoints of the PlanarFigure are stored in a vtkPoints object.
-  // These points are used by the vtkLassoStencilSource to create
-  // a vtkImageStencil.
+  // all PolylinePoints of the PlanarFigure are stored in a vtkPoints object
+  // in index coordinates of the slice.
   const mitk::PlaneGeometry *planarFigurePlaneGeometry = m_PlanarFigure->GetPlaneGeometry();
   const typename PlanarFigure::PolyLineType planarFigurePolyline = m_PlanarFigure->GetPolyLine( 0 );
   const mitk::BaseGeometry *imageGeometry3D = m_inputImage->GetGeometry( 0 );
@@ -181,69 +337,65 @@ void PlanarFigureMaskGenerator::InternalCalculateMaskFromPlanarFigure(
     throw std::runtime_error( "Figure at least partially outside of image bounds!" );
   }
 
-  // create a vtkLassoStencilSource and set the points of the Polygon
-  vtkSmartPointer<vtkLassoStencilSource> lassoStencil = vtkSmartPointer<vtkLassoStencilSource>::New();
-  lassoStencil->SetShapeToPolygon();
-  lassoStencil->SetPoints( points );
+  // rasterize the polygon (and the hole) within its bounding box
+  const MaskImage2DType::RegionType &region = maskImage->GetLargestPossibleRegion();
+  const itk::IndexValueType width = region.GetSize(0);
+  const itk::IndexValueType height = region.GetSize(1);
+  unsigned short *maskBuffer = maskImage->GetBufferPointer();
 
-  vtkSmartPointer<vtkLassoStencilSource> holeLassoStencil = nullptr;
-
-  if (holePoints.GetPointer() != nullptr)
+  FillPolygonSpans(points, width, height, [&](itk::IndexValueType y, itk::IndexValueType begin, itk::IndexValueType end)
   {
-    holeLassoStencil = vtkSmartPointer<vtkLassoStencilSource>::New();
-    holeLassoStencil->SetShapeToPolygon();
-    holeLassoStencil->SetPoints(holePoints);
-  }
+    std::fill(maskBuffer + y * width + begin, maskBuffer + y * width + end, 1);
+  });
 
-  // Export from ITK to VTK (to use a VTK filter)
-  typedef itk::VTKImageImport< MaskImage2DType > ImageImportType;
-  typedef itk::VTKImageExport< MaskImage2DType > ImageExportType;
-
-  typename ImageExportType::Pointer itkExporter = ImageExportType::New();
-  itkExporter->SetInput( maskImage );
-//  itkExporter->SetInput( castFilter->GetOutput() );
-
-  vtkSmartPointer<vtkImageImport> vtkImporter = vtkSmartPointer<vtkImageImport>::New();
-  this->ConnectPipelines( itkExporter, vtkImporter );
-
-  // Apply the generated image stencil to the input image
-  vtkSmartPointer<vtkImageStencil> imageStencilFilter = vtkSmartPointer<vtkImageStencil>::New();
-  imageStencilFilter->SetInputConnection( vtkImporter->GetOutputPort() );
-  imageStencilFilter->SetStencilConnection(lassoStencil->GetOutputPort());
-  imageStencilFilter->ReverseStencilOff();
-  imageStencilFilter->SetBackgroundValue( 0 );
-  imageStencilFilter->Update();
-
-  vtkSmartPointer<vtkImageStencil> holeStencilFilter = nullptr;
-
-  if (holeLassoStencil.GetPointer() != nullptr)
+  if (holePoints != nullptr)
   {
-    holeStencilFilter = vtkSmartPointer<vtkImageStencil>::New();
-    holeStencilFilter->SetInputConnection(imageStencilFilter->GetOutputPort());
-    holeStencilFilter->SetStencilConnection(holeLassoStencil->GetOutputPort());
-    holeStencilFilter->ReverseStencilOn();
-    holeStencilFilter->SetBackgroundValue(0);
-    holeStencilFilter->Update();
+    FillPolygonSpans(holePoints, width, height, [&](itk::IndexValueType y, itk::IndexValueType begin, itk::IndexValueType end)
+    {
+      std::fill(maskBuffer + y * width + begin, maskBuffer + y * width + end, 0);
+    });
   }
 
-  // Export from VTK back to ITK
-  vtkSmartPointer<vtkImageExport> vtkExporter = vtkSmartPointer<vtkImageExport>::New();
-  vtkExporter->SetInputConnection( holeStencilFilter.GetPointer() == nullptr
-    ? imageStencilFilter->GetOutputPort()
-    : holeStencilFilter->GetOutputPort());
-  vtkExporter->Update();
+  // Store mask
+  m_InternalITKImageMask2D = maskImage;
 
-  typename ImageImportType::Pointer itkImporter = ImageImportType::New();
-  this->ConnectPipelines( vtkExporter, itkImporter );
-  itkImporter->Update();
+  m_PartialVolumeWeights2D = nullptr;
+  if (m_ComputePartialVolumeWeights)
+  {
+    PartialVolumeWeightsImageType::Pointer weights = PartialVolumeWeightsImageType::New();
+    weights->CopyInformation(maskImage);
+    weights->SetRegions(region);
+    weights->Allocate();
+    weights->FillBuffer(0.0f);
+
+    std::vector<double> coverage;
+    itk::IndexValueType coverageX, coverageY, coverageWidth, coverageHeight;
+    ComputePolygonCoverage(points, coverage, coverageX, coverageY, coverageWidth, coverageHeight);
+
+    std::vector<double> holeCoverage;
+    itk::IndexValueType holeX = 0, holeY = 0, holeWidth = 0, holeHeight = 0;
+    if (holePoints != nullptr)
+    {
+      ComputePolygonCoverage(holePoints, holeCoverage, holeX, holeY, holeWidth, holeHeight);
+    }
 
-  typedef itk::ImageDuplicator< ImageImportType::OutputImageType > DuplicatorType;
-  DuplicatorType::Pointer duplicator = DuplicatorType::New();
-  duplicator->SetInputImage( itkImporter->GetOutput() );
-  duplicator->Update();
+    for (itk::IndexValueType y = std::max<itk::IndexValueType>(coverageY, 0);
+         y < std::min(coverageY + coverageHeight, height); ++y)
+    {
+      for (itk::IndexValueType x = std::max<itk::IndexValueType>(coverageX, 0);
+           x < std::min(coverageX + coverageWidth, width); ++x)
+      {
+        double weight = coverage[(y - coverageY) * coverageWidth + x - coverageX];
+        if (x >= holeX && x < holeX + holeWidth && y >= holeY && y < holeY + holeHeight)
+        {
+          weight -= holeCoverage[(y - holeY) * holeWidth + x - holeX];
+        }
+        weights->GetBufferPointer()[y * width + x] = static_cast<float>(std::min(1.0, std::max(0.0, weight)));
+      }
+    }
 
-  // Store mask
-  m_InternalITKImageMask2D = duplicator->GetOutput();
+    m_PartialVolumeWeights2D = weights;
+  }
 }
 
 template < typename TPixel, unsigned int VImageDimension >
@@ -401,6 +553,7 @@ void PlanarFigureMaskGenerator::CalculateMask()
     }
 
     m_InternalITKImageMask2D = nullptr;
+    m_PartialVolumeWeights2D = nullptr;
     const PlaneGeometry *planarFigurePlaneGeometry = m_PlanarFigure->GetPlaneGeometry();
     const auto *planarFigureGeometry = dynamic_cast< const PlaneGeometry * >( planarFigurePlaneGeometry );
     //const BaseGeometry *imageGeometry = m_inputImage->GetGeometry();
@@ -462,6 +615,12 @@ void PlanarFigureMaskGenerator::SetTimeStep(unsigned int timeStep)
     }
 }
 
+std::string PlanarFigureMaskGenerator::GetCacheKey()
+{
+    return std::string(this->GetNameOfClass()) + "/" + GetCacheKeyOf(m_PlanarFigure) + "/" +
+        GetCacheKeyOf(m_inputImage);
+}
+
 mitk::Image::Pointer PlanarFigureMaskGenerator::GetMask()
 {
     if (IsUpdateRequired())
@@ -474,6 +633,12 @@ mitk::Image::Pointer PlanarFigureMaskGenerator::GetMask()
     return m_InternalMask;
 }
 
+PlanarFigureMaskGenerator::PartialVolumeWeightsImageType::Pointer PlanarFigureMaskGenerator::GetPartialVolumeWeights()
+{
+    this->GetMask(); // make sure we are up to date
+    return m_PartialVolumeWeights2D;
+}
+
 mitk::Image::Pointer PlanarFigureMaskGenerator::extract2DImageSlice(unsigned int axis, unsigned int slice)
 {
     // Extract slice with given position and direction from image
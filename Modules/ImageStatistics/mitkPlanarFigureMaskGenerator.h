@@ -7,16 +7,15 @@
 #include <itkImage.h>
 #include <mitkMaskGenerator.h>
 #include <vtkSmartPointer.h>
-#include <itkVTKImageExport.h>
-#include <itkVTKImageImport.h>
-#include <vtkImageImport.h>
-#include <vtkImageExport.h>
 
 namespace mitk
 {
 /**
 * \class PlanarFigureMaskGenerator
 * \brief Derived from MaskGenerator. This class is used to convert a mitk::PlanarFigure into a binary image mask
+*
+* Closed figures are rasterized by a scanline fill of their polygon, visiting only the bounding box of the figure.
+* A pixel belongs to the mask if its center lies inside the figure and outside of its hole (if any).
 */
 class MITKIMAGESTATISTICS_EXPORT PlanarFigureMaskGenerator: public MaskGenerator
     {
@@ -49,15 +48,37 @@ class MITKIMAGESTATISTICS_EXPORT PlanarFigureMaskGenerator: public MaskGenerator
      */
     void SetTimeStep(unsigned int timeStep) override;
 
+    /**
+     * @brief Depends on the planar figure and the input image.
+     */
+    std::string GetCacheKey() override;
+
     itkGetConstMacro(PlanarFigureAxis, unsigned int);
     itkGetConstMacro(PlanarFigureSlice, unsigned int);
 
+    typedef itk::Image<float, 2> PartialVolumeWeightsImageType;
+
+    /**
+     * @brief If enabled, the fraction of each pixel of the figure's slice covered by a closed planar figure (minus
+     * its hole) is computed along with the mask. Disabled by default.
+     */
+    itkSetMacro(ComputePartialVolumeWeights, bool);
+    itkGetConstMacro(ComputePartialVolumeWeights, bool);
+    itkBooleanMacro(ComputePartialVolumeWeights);
+
+    /**
+     * @brief Returns the exact area fractions between 0 and 1 of all pixels of the mask covered by the planar
+     * figure, or nullptr if they are not computed (see SetComputePartialVolumeWeights()) or the figure is open.
+     */
+    PartialVolumeWeightsImageType::Pointer GetPartialVolumeWeights();
+
     protected:
     PlanarFigureMaskGenerator():Superclass(){
         m_InternalMaskUpdateTime = 0;
         m_InternalMask = mitk::Image::New();
         m_ReferenceImage = nullptr;
         m_PlanarFigureAxis = 0;
+        m_ComputePartialVolumeWeights = false;
     }
 
 
@@ -77,52 +98,12 @@ class MITKIMAGESTATISTICS_EXPORT PlanarFigureMaskGenerator: public MaskGenerator
     bool GetPrincipalAxis(const BaseGeometry *geometry, Vector3D vector,
       unsigned int &axis );
 
-    /** Connection from ITK to VTK */
-    template <typename ITK_Exporter, typename VTK_Importer>
-    void ConnectPipelines(ITK_Exporter exporter, vtkSmartPointer<VTK_Importer> importer)
-    {
-      importer->SetUpdateInformationCallback(exporter->GetUpdateInformationCallback());
-
-      importer->SetPipelineModifiedCallback(exporter->GetPipelineModifiedCallback());
-      importer->SetWholeExtentCallback(exporter->GetWholeExtentCallback());
-      importer->SetSpacingCallback(exporter->GetSpacingCallback());
-      importer->SetOriginCallback(exporter->GetOriginCallback());
-      importer->SetScalarTypeCallback(exporter->GetScalarTypeCallback());
-
-      importer->SetNumberOfComponentsCallback(exporter->GetNumberOfComponentsCallback());
-
-      importer->SetPropagateUpdateExtentCallback(exporter->GetPropagateUpdateExtentCallback());
-      importer->SetUpdateDataCallback(exporter->GetUpdateDataCallback());
-      importer->SetDataExtentCallback(exporter->GetDataExtentCallback());
-      importer->SetBufferPointerCallback(exporter->GetBufferPointerCallback());
-      importer->SetCallbackUserData(exporter->GetCallbackUserData());
-    }
-
-    /** Connection from VTK to ITK */
-    template <typename VTK_Exporter, typename ITK_Importer>
-    void ConnectPipelines(vtkSmartPointer<VTK_Exporter> exporter, ITK_Importer importer)
-    {
-      importer->SetUpdateInformationCallback(exporter->GetUpdateInformationCallback());
-
-      importer->SetPipelineModifiedCallback(exporter->GetPipelineModifiedCallback());
-      importer->SetWholeExtentCallback(exporter->GetWholeExtentCallback());
-      importer->SetSpacingCallback(exporter->GetSpacingCallback());
-      importer->SetOriginCallback(exporter->GetOriginCallback());
-      importer->SetScalarTypeCallback(exporter->GetScalarTypeCallback());
-
-      importer->SetNumberOfComponentsCallback(exporter->GetNumberOfComponentsCallback());
-
-      importer->SetPropagateUpdateExtentCallback(exporter->GetPropagateUpdateExtentCallback());
-      importer->SetUpdateDataCallback(exporter->GetUpdateDataCallback());
-      importer->SetDataExtentCallback(exporter->GetDataExtentCallback());
-      importer->SetBufferPointerCallback(exporter->GetBufferPointerCallback());
-      importer->SetCallbackUserData(exporter->GetCallbackUserData());
-    }
-
     bool IsUpdateRequired() const;
 
     mitk::PlanarFigure::Pointer m_PlanarFigure;
     itk::Image<unsigned short, 2>::Pointer m_InternalITKImageMask2D;
+    PartialVolumeWeightsImageType::Pointer m_PartialVolumeWeights2D;
+    bool m_ComputePartialVolumeWeights;
     mitk::Image::Pointer m_InternalTimeSliceImage;
     mitk::Image::Pointer m_ReferenceImage;
     unsigned int m_PlanarFigureAxis;
@@ -28,6 +28,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkFixedPointVolumeRayCastMapper.h>
 #include <vtkGPUVolumeRayCastMapper.h>
 #include <vtkImageChangeInformation.h>
+#include <vtkImageResample.h>
 #include <vtkSmartPointer.h>
 #include <vtkVersionMacros.h>
 #include <vtkVolumeProperty.h>
@@ -42,6 +43,15 @@ namespace mitk
   * - \b "level window": for the level window of the volume data
   * - \b "LookupTable" : for the lookup table of the volume data
   * - \b "TransferFunction" (mitk::TransferFunctionProperty): for the used transfer function of the volume data
+  * - \b "volumerendering.uselod" (BoolProperty): render at a reduced quality while the RenderingManager
+  *   requests the interaction LOD, i.e. while a full quality frame exceeds its rendering time budget. The
+  *   RenderingManager renders the full quality again as soon as the interaction stops.
+  * - \b "volumerendering.lod.sampledistance" (FloatProperty): distance between the samples along a ray in
+  *   voxels at the interaction LOD of the GPU raycaster, 1 is used at full quality
+  * - \b "volumerendering.lod.imagesampledistance" (FloatProperty): distance between the rays in pixels at the
+  *   interaction LOD of the GPU raycaster, 1 is used at full quality
+  * - \b "volumerendering.gpu.maxmemory" (IntProperty): maximum size of the volume texture of the GPU raycaster
+  *   in MB. Larger volumes are downsampled to fit, 0 disables the limit.
   ************************************************************************/
 
   //##Documentation
@@ -95,6 +105,10 @@ namespace mitk
 
     void InitVtkMapper(mitk::BaseRenderer *renderer);
 
+    /** Connects the GPU raycaster to the full resolution volume or, if it exceeds "volumerendering.gpu.maxmemory",
+     * to a downsampled copy. */
+    void UpdateRAYInput(mitk::BaseRenderer *renderer, vtkImageData *inputData);
+
     void GenerateDataForRenderer(mitk::BaseRenderer *renderer) override;
 
     void CreateDefaultTransferFunctions();
@@ -104,6 +118,8 @@ namespace mitk
 
     bool m_commonInitialized;
     vtkSmartPointer<vtkImageChangeInformation> m_UnitSpacingImageFilter;
+    /** Downsamples volumes exceeding the texture memory limit of the GPU raycaster */
+    vtkSmartPointer<vtkImageResample> m_LowResolutionImageFilter;
     vtkSmartPointer<vtkPiecewiseFunction> m_DefaultOpacityTransferFunction;
     vtkSmartPointer<vtkPiecewiseFunction> m_DefaultGradientTransferFunction;
     vtkSmartPointer<vtkColorTransferFunction> m_DefaultColorTransferFunction;
@@ -42,6 +42,14 @@ namespace mitk
   //##Documentation
   //## @brief Vtk-based mapper for VolumeData
   //##
+  //## With "volumerendering.uselod" enabled, the volume is rendered with "volumerendering.lod.sampledistance"
+  //## (in voxels) and nearest neighbor interpolation while the RenderingManager requests the interaction LOD.
+  //## The full quality is rendered again once the interaction stops. vtkSmartVolumeMapper does not expose the
+  //## image sample distance, so "volumerendering.lod.imagesampledistance" is not used by this mapper.
+  //##
+  //## "volumerendering.gpu.maxmemory" (in MB, 0 uses the limit detected by VTK) is the texture memory available
+  //## for the volume, larger volumes are rendered from a downsampled copy by vtkSmartVolumeMapper.
+  //##
   //## @ingroup Mapper
   class MITKMAPPEREXT_EXPORT VolumeMapperVtkSmart3D : public VtkMapper
   {
@@ -54,7 +62,11 @@ namespace mitk
 
     void ApplyProperties(vtkActor *actor, mitk::BaseRenderer *renderer) override;
     static void SetDefaultProperties(mitk::DataNode *node, mitk::BaseRenderer *renderer = nullptr, bool overwrite = false);
-    
+
+    /** Returns true if "volumerendering.uselod" is enabled, the RenderingManager then switches between the
+     * interaction LOD and full quality. */
+    bool IsLODEnabled(BaseRenderer *renderer = nullptr) const override;
+
   protected:
     VolumeMapperVtkSmart3D();
     ~VolumeMapperVtkSmart3D() override;
@@ -76,6 +88,10 @@ namespace mitk
     
     void UpdateTransferFunctions(mitk::BaseRenderer *renderer);
     void UpdateRenderMode(mitk::BaseRenderer *renderer);
+    void UpdateLevelOfDetail(mitk::BaseRenderer *renderer);
+
+    /** Initial maximum memory of vtkSmartVolumeMapper, restored if "volumerendering.gpu.maxmemory" is 0 */
+    vtkIdType m_DefaultMaxMemoryInBytes;
   };
 
 } // namespace mitk
@@ -58,6 +58,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "vtkOpenGLGPUVolumeRayCastMapper.h"
 
+#include <algorithm>
+#include <cmath>
+
 const mitk::Image *mitk::GPUVolumeMapper3D::GetInput()
 {
   return static_cast<const mitk::Image *>(GetDataNode()->GetData());
@@ -148,6 +151,10 @@ void mitk::GPUVolumeMapper3D::InitCommon()
   m_UnitSpacingImageFilter = vtkSmartPointer<vtkImageChangeInformation>::New();
   m_UnitSpacingImageFilter->SetOutputSpacing(1.0, 1.0, 1.0);
 
+  m_LowResolutionImageFilter = vtkSmartPointer<vtkImageResample>::New();
+  m_LowResolutionImageFilter->SetDimensionality(3);
+  m_LowResolutionImageFilter->SetInputConnection(m_UnitSpacingImageFilter->GetOutputPort());
+
   CreateDefaultTransferFunctions();
 
   m_commonInitialized = true;
@@ -265,6 +272,7 @@ void mitk::GPUVolumeMapper3D::GenerateDataForRenderer(mitk::BaseRenderer *render
 
   if (ls->m_rayInitialized)
   {
+    UpdateRAYInput(renderer, inputData);
     GenerateDataRAY(renderer);
   }
   else
@@ -425,6 +433,8 @@ void mitk::GPUVolumeMapper3D::SetDefaultProperties(mitk::DataNode *node, mitk::B
   node->AddProperty("volumerendering", mitk::BoolProperty::New(false), renderer, overwrite);
   node->AddProperty("volumerendering.usemip", mitk::BoolProperty::New(false), renderer, overwrite);
   node->AddProperty("volumerendering.uselod", mitk::BoolProperty::New(false), renderer, overwrite);
+  node->AddProperty("volumerendering.lod.sampledistance", mitk::FloatProperty::New(2.0f), renderer, overwrite);
+  node->AddProperty("volumerendering.lod.imagesampledistance", mitk::FloatProperty::New(4.0f), renderer, overwrite);
 
   node->AddProperty("volumerendering.cpu.ambient", mitk::FloatProperty::New(0.10f), renderer, overwrite);
   node->AddProperty("volumerendering.cpu.diffuse", mitk::FloatProperty::New(0.50f), renderer, overwrite);
@@ -450,6 +460,7 @@ void mitk::GPUVolumeMapper3D::SetDefaultProperties(mitk::DataNode *node, mitk::B
   node->AddProperty("volumerendering.gpu.specular.power", mitk::FloatProperty::New(16.0f), renderer, overwrite);
   node->AddProperty("volumerendering.gpu.usetexturecompression", mitk::BoolProperty::New(false), renderer, overwrite);
   node->AddProperty("volumerendering.gpu.reducesliceartifacts", mitk::BoolProperty::New(false), renderer, overwrite);
+  node->AddProperty("volumerendering.gpu.maxmemory", mitk::IntProperty::New(0), renderer, overwrite);
 
   node->AddProperty("binary", mitk::BoolProperty::New(false), renderer, overwrite);
 
@@ -557,10 +568,21 @@ void mitk::GPUVolumeMapper3D::GenerateDataRAY(mitk::BaseRenderer *renderer)
 {
   LocalStorage *ls = m_LSH.GetLocalStorage(renderer);
 
+  // the RenderingManager requests the full quality again once the interaction stops
   if (IsLODEnabled(renderer) && mitk::RenderingManager::GetInstance()->GetNextLOD(renderer) == 0)
-    ls->m_MapperRAY->SetImageSampleDistance(4.0);
+  {
+    float imageSampleDistance = 4.0f;
+    float sampleDistance = 2.0f;
+    GetDataNode()->GetFloatProperty("volumerendering.lod.imagesampledistance", imageSampleDistance, renderer);
+    GetDataNode()->GetFloatProperty("volumerendering.lod.sampledistance", sampleDistance, renderer);
+    ls->m_MapperRAY->SetImageSampleDistance(std::max(1.0f, imageSampleDistance));
+    ls->m_MapperRAY->SetSampleDistance(std::max(1.0f, sampleDistance));
+  }
   else
+  {
     ls->m_MapperRAY->SetImageSampleDistance(1.0);
+    ls->m_MapperRAY->SetSampleDistance(1.0);
+  }
 
   // Check raycasting mode
   if (IsMIPEnabled(renderer))
@@ -582,6 +604,41 @@ void mitk::GPUVolumeMapper3D::GenerateDataRAY(mitk::BaseRenderer *renderer)
   }
 }
 
+void mitk::GPUVolumeMapper3D::UpdateRAYInput(mitk::BaseRenderer *renderer, vtkImageData *inputData)
+{
+  LocalStorage *ls = m_LSH.GetLocalStorage(renderer);
+
+  int maximumMemory = 0; // MB
+  GetDataNode()->GetIntProperty("volumerendering.gpu.maxmemory", maximumMemory, renderer);
+
+  // GetActualMemorySize() is given in KiB
+  const double volumeMemory = static_cast<double>(inputData->GetActualMemorySize()) / 1024.0;
+  if (maximumMemory <= 0 || volumeMemory <= maximumMemory)
+  {
+    ls->m_MapperRAY->SetInputConnection(m_UnitSpacingImageFilter->GetOutputPort());
+    return;
+  }
+
+  // the same factor on every axis keeps the aspect of the voxels, the resampled spacing keeps the extent in world
+  const double factor = std::cbrt(maximumMemory / volumeMemory);
+  if (m_LowResolutionImageFilter->GetAxisMagnificationFactor(0, nullptr) != factor)
+  {
+    GPU_INFO << "downsampling the volume of " << volumeMemory << " MB by " << factor
+             << " to fit into the texture memory limit of " << maximumMemory << " MB";
+    for (int axis = 0; axis < 3; ++axis)
+      m_LowResolutionImageFilter->SetAxisMagnificationFactor(axis, factor);
+  }
+
+  bool isBinary = false;
+  GetDataNode()->GetBoolProperty("binary", isBinary, renderer);
+  if (isBinary)
+    m_LowResolutionImageFilter->SetInterpolationModeToNearestNeighbor();
+  else
+    m_LowResolutionImageFilter->SetInterpolationModeToLinear();
+
+  ls->m_MapperRAY->SetInputConnection(m_LowResolutionImageFilter->GetOutputPort());
+}
+
 bool mitk::GPUVolumeMapper3D::IsRAYEnabled(mitk::BaseRenderer *renderer)
 {
   LocalStorage *ls = m_LSH.GetLocalStorage(renderer);
@@ -18,12 +18,15 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkTransferFunctionProperty.h"
 #include "mitkTransferFunctionInitializer.h"
 #include "mitkLevelWindowProperty.h"
+#include "mitkRenderingManager.h"
 #include <vtkObjectFactory.h>
 #include <vtkRenderingOpenGL2ObjectFactory.h>
 #include <vtkRenderingVolumeOpenGL2ObjectFactory.h>
 #include <vtkColorTransferFunction.h>
 #include <vtkPiecewiseFunction.h>
 
+#include <algorithm>
+
 void mitk::VolumeMapperVtkSmart3D::GenerateDataForRenderer(mitk::BaseRenderer *renderer)
 {
   bool value;
@@ -40,6 +43,7 @@ void mitk::VolumeMapperVtkSmart3D::GenerateDataForRenderer(mitk::BaseRenderer *r
 
   UpdateTransferFunctions(renderer);
   UpdateRenderMode(renderer);
+  UpdateLevelOfDetail(renderer);
   this->Modified();
 }
 
@@ -66,6 +70,8 @@ void mitk::VolumeMapperVtkSmart3D::SetDefaultProperties(mitk::DataNode *node, mi
 
   node->AddProperty("volumerendering", mitk::BoolProperty::New(false), renderer, overwrite);
   node->AddProperty("volumerendering.usemip", mitk::BoolProperty::New(false), renderer, overwrite);
+  node->AddProperty("volumerendering.uselod", mitk::BoolProperty::New(false), renderer, overwrite);
+  node->AddProperty("volumerendering.lod.sampledistance", mitk::FloatProperty::New(2.0f), renderer, overwrite);
 
   node->AddProperty("volumerendering.cpu.ambient", mitk::FloatProperty::New(0.10f), renderer, overwrite);
   node->AddProperty("volumerendering.cpu.diffuse", mitk::FloatProperty::New(0.50f), renderer, overwrite);
@@ -78,6 +84,7 @@ void mitk::VolumeMapperVtkSmart3D::SetDefaultProperties(mitk::DataNode *node, mi
   node->AddProperty("volumerendering.gpu.diffuse", mitk::FloatProperty::New(0.50f), renderer, overwrite);
   node->AddProperty("volumerendering.gpu.specular", mitk::FloatProperty::New(0.40f), renderer, overwrite);
   node->AddProperty("volumerendering.gpu.specular.power", mitk::FloatProperty::New(16.0f), renderer, overwrite);
+  node->AddProperty("volumerendering.gpu.maxmemory", mitk::IntProperty::New(0), renderer, overwrite);
 
   node->AddProperty("binary", mitk::BoolProperty::New(false), renderer, overwrite);
 
@@ -234,6 +241,42 @@ void mitk::VolumeMapperVtkSmart3D::UpdateRenderMode(mitk::BaseRenderer *renderer
   }
 }
 
+void mitk::VolumeMapperVtkSmart3D::UpdateLevelOfDetail(mitk::BaseRenderer *renderer)
+{
+  // the RenderingManager requests the full quality again once the interaction stops
+  if (this->IsLODEnabled(renderer) && mitk::RenderingManager::GetInstance()->GetNextLOD(renderer) == 0)
+  {
+    float sampleDistance = 2.0f;
+    this->GetDataNode()->GetFloatProperty("volumerendering.lod.sampledistance", sampleDistance, renderer);
+    m_SmartVolumeMapper->SetAutoAdjustSampleDistances(0);
+    m_SmartVolumeMapper->SetSampleDistance(std::max(1.0f, sampleDistance));
+    m_VolumeProperty->SetInterpolationTypeToNearest();
+  }
+  else
+  {
+    m_SmartVolumeMapper->SetAutoAdjustSampleDistances(1);
+    m_SmartVolumeMapper->SetSampleDistance(1.0);
+    m_VolumeProperty->SetInterpolationType(VTK_LINEAR_INTERPOLATION);
+  }
+
+  // larger volumes are rendered by the low resolution GPU mapper of vtkSmartVolumeMapper
+  int maximumMemory = 0; // MB
+  this->GetDataNode()->GetIntProperty("volumerendering.gpu.maxmemory", maximumMemory, renderer);
+  const vtkIdType maximumMemoryInBytes =
+    maximumMemory > 0 ? static_cast<vtkIdType>(maximumMemory) * 1024 * 1024 : m_DefaultMaxMemoryInBytes;
+  if (m_SmartVolumeMapper->GetMaxMemoryInBytes() != maximumMemoryInBytes)
+  {
+    m_SmartVolumeMapper->SetMaxMemoryInBytes(maximumMemoryInBytes);
+    m_SmartVolumeMapper->SetMaxMemoryFraction(maximumMemory > 0 ? 1.0f : 0.75f);
+  }
+}
+
+bool mitk::VolumeMapperVtkSmart3D::IsLODEnabled(mitk::BaseRenderer *renderer) const
+{
+  bool value = false;
+  return this->GetDataNode()->GetBoolProperty("volumerendering.uselod", value, renderer) && value;
+}
+
 mitk::VolumeMapperVtkSmart3D::VolumeMapperVtkSmart3D()
 {
   m_RenderingOpenGL2ObjectFactory = vtkSmartPointer<vtkRenderingOpenGL2ObjectFactory>::New();
@@ -244,6 +287,7 @@ mitk::VolumeMapperVtkSmart3D::VolumeMapperVtkSmart3D()
 
   m_SmartVolumeMapper = vtkSmartPointer<vtkSmartVolumeMapper>::New();
   m_SmartVolumeMapper->SetBlendModeToComposite();
+  m_DefaultMaxMemoryInBytes = m_SmartVolumeMapper->GetMaxMemoryInBytes();
   m_ImageChangeInformation = vtkSmartPointer<vtkImageChangeInformation>::New();
   m_VolumeProperty = vtkSmartPointer<vtkVolumeProperty>::New();
   m_Volume = vtkSmartPointer<vtkVolume>::New();
@@ -0,0 +1,216 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mapRegistration.h"
+
+#include <mitkExceptionMacro.h>
+
+#include "mitkImageMappingField.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+mitk::ImageMappingField::ImageMappingField() : m_Registration(nullptr), m_RegistrationMTime(0)
+{
+  m_Origin.Fill(0.0);
+  m_Spacing.Fill(1.0);
+  m_Direction.SetIdentity();
+  m_Size.Fill(0);
+  m_IndexToWorld.SetIdentity();
+}
+
+mitk::ImageMappingField::~ImageMappingField()
+{
+}
+
+void
+  mitk::ImageMappingField::
+  ExtractGrid(const ResultImageGeometryType* resultGeometry, PointType& origin, SpacingType& spacing, DirectionType& direction, SizeType& size)
+{
+  const ResultImageGeometryType::BoundsArrayType geoBounds = resultGeometry->GetBounds();
+  const mitk::Vector3D geoSpacing = resultGeometry->GetSpacing();
+  const mitk::Point3D geoOrigin = resultGeometry->GetOrigin();
+  const mitk::AffineTransform3D::MatrixType geoMatrix = resultGeometry->GetIndexToWorldTransform()->GetMatrix();
+
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    origin[i] = geoOrigin[i];
+    spacing[i] = geoSpacing[i];
+    size[i] = static_cast<SizeType::SizeValueType>(geoBounds[(2 * i) + 1] - geoBounds[2 * i]);
+  }
+
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    for (unsigned int j = 0; j < 3; ++j)
+    {
+      direction[i][j] = geoMatrix[i][j] / spacing[j];
+    }
+  }
+}
+
+void
+  mitk::ImageMappingField::
+  Generate(const RegistrationType* registration, const ResultImageGeometryType* resultGeometry, unsigned int numberOfThreads)
+{
+  if (!registration)
+  {
+    mitkThrow() << "Cannot generate mapping field. Passed registration pointer is nullptr.";
+  }
+  if (!resultGeometry)
+  {
+    mitkThrow() << "Cannot generate mapping field. Passed result geometry pointer is nullptr.";
+  }
+
+  typedef ::map::core::Registration<3, 3> ConcreteRegistrationType;
+  const ConcreteRegistrationType* castedReg = dynamic_cast<const ConcreteRegistrationType*>(registration);
+  if (!castedReg)
+  {
+    mitkThrow() << "Cannot generate mapping field. Only 3D registrations are supported.";
+  }
+
+  ExtractGrid(resultGeometry, m_Origin, m_Spacing, m_Direction, m_Size);
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    for (unsigned int j = 0; j < 3; ++j)
+    {
+      m_IndexToWorld[i][j] = m_Direction[i][j] * m_Spacing[j];
+    }
+  }
+
+  m_Displacements.assign(3 * this->GetNumberOfVoxels(), 0.0f);
+  m_Geometry = nullptr;
+  m_Registration = nullptr;
+
+  typedef ConcreteRegistrationType::InverseMappingType KernelType;
+  const KernelType& kernel = castedReg->getInverseMapping();
+
+  auto sampleSlice = [&](std::size_t z)
+  {
+    for (std::size_t y = 0; y < m_Size[1]; ++y)
+    {
+      for (std::size_t x = 0; x < m_Size[0]; ++x)
+      {
+        const KernelType::InputPointType targetPoint = this->GetTargetPoint(x, y, z);
+        KernelType::OutputPointType movingPoint;
+        float* displacement = &(m_Displacements[3 * (x + m_Size[0] * (y + m_Size[1] * z))]);
+
+        if (kernel.mapPoint(targetPoint, movingPoint))
+        {
+          for (unsigned int i = 0; i < 3; ++i)
+          {
+            displacement[i] = static_cast<float>(movingPoint[i] - targetPoint[i]);
+          }
+        }
+        else
+        {
+          std::fill(displacement, displacement + 3, std::numeric_limits<float>::quiet_NaN());
+        }
+      }
+    }
+  };
+
+  const std::size_t numberOfSlices = m_Size[2];
+  if (numberOfSlices > 0)
+  {
+    // the first slice is sampled by this thread alone, lazy kernels generate their field on first use
+    sampleSlice(0);
+
+    std::atomic<std::size_t> nextSlice(1);
+    std::exception_ptr exception;
+    std::mutex exceptionMutex;
+
+    auto worker = [&]()
+    {
+      for (std::size_t z = nextSlice++; z < numberOfSlices; z = nextSlice++)
+      {
+        try
+        {
+          sampleSlice(z);
+        }
+        catch (...)
+        {
+          std::lock_guard<std::mutex> lock(exceptionMutex);
+          if (!exception)
+            exception = std::current_exception();
+          nextSlice = numberOfSlices;
+          return;
+        }
+      }
+    };
+
+    std::size_t threadCount = numberOfThreads > 0 ? numberOfThreads : std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::max<std::size_t>(1, std::min(threadCount, numberOfSlices - 1));
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < threadCount; ++i)
+    {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+
+    if (exception)
+    {
+      std::rethrow_exception(exception);
+    }
+  }
+
+  m_Geometry = resultGeometry->Clone();
+  m_Registration = registration;
+  m_RegistrationMTime = registration->GetMTime();
+  this->Modified();
+}
+
+bool
+  mitk::ImageMappingField::
+  IsGeneratedFor(const RegistrationType* registration, const ResultImageGeometryType* resultGeometry) const
+{
+  if (!registration || !resultGeometry || registration != m_Registration || registration->GetMTime() != m_RegistrationMTime)
+  {
+    return false;
+  }
+
+  PointType origin;
+  SpacingType spacing;
+  DirectionType direction;
+  SizeType size;
+  ExtractGrid(resultGeometry, origin, spacing, direction, size);
+
+  const double eps = 1e-6;
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    if (size[i] != m_Size[i] || std::abs(origin[i] - m_Origin[i]) > eps || std::abs(spacing[i] - m_Spacing[i]) > eps)
+    {
+      return false;
+    }
+    for (unsigned int j = 0; j < 3; ++j)
+    {
+      if (std::abs(direction[i][j] - m_Direction[i][j]) > eps)
+      {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
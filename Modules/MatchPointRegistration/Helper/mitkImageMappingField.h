@@ -0,0 +1,128 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITK_IMAGE_MAPPING_FIELD_H
+#define MITK_IMAGE_MAPPING_FIELD_H
+
+#include "mapRegistrationBase.h"
+#include "mitkBaseGeometry.h"
+
+#include <itkImage.h>
+#include <itkObject.h>
+
+#include <limits>
+#include <vector>
+
+#include "MitkMatchPointRegistrationExports.h"
+
+namespace mitk
+{
+  /**Dense sampling of the inverse mapping kernel of a 3D registration on the grid of a result geometry.
+   * For every voxel of the grid the field stores the displacement from the target position to the position
+   * in the moving space. Thus mapping several images (e.g. all time steps or all segmentations of a study)
+   * onto the same grid has to evaluate the registration only once. See ImageMappingHelper::map() and
+   * MAPRegistrationWrapper::SetCacheMappingField().
+   * The displacements are stored in single precision, positions the kernel cannot map are marked invalid.*/
+  class MITKMATCHPOINTREGISTRATION_EXPORT ImageMappingField : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(ImageMappingField, itk::Object);
+    itkFactorylessNewMacro(Self);
+
+    typedef ::map::core::RegistrationBase RegistrationType;
+    typedef ::mitk::BaseGeometry ResultImageGeometryType;
+
+    typedef ::itk::Image<unsigned char, 3> GridType;
+    typedef GridType::PointType PointType;
+    typedef GridType::SpacingType SpacingType;
+    typedef GridType::DirectionType DirectionType;
+    typedef GridType::SizeType SizeType;
+
+    /**Samples the inverse mapping of registration at every voxel of resultGeometry.
+     * @param numberOfThreads Number of threads that evaluate the kernel, 0 uses one thread per core.
+     * @pre registration must be a valid 3D registration, otherwise an mitk::Exception is thrown.
+     * @pre resultGeometry must be valid.*/
+    void Generate(const RegistrationType* registration, const ResultImageGeometryType* resultGeometry, unsigned int numberOfThreads = 0);
+
+    /**Indicates if the field has been generated for the current state of registration and the grid of resultGeometry.*/
+    bool IsGeneratedFor(const RegistrationType* registration, const ResultImageGeometryType* resultGeometry) const;
+
+    /**Copy of the result geometry the field has been generated for, nullptr before Generate().*/
+    const ResultImageGeometryType* GetGeometry() const { return m_Geometry.GetPointer(); };
+
+    /**Grid of the field, in the convention of itk images (direction without spacing).*/
+    const PointType& GetOrigin() const { return m_Origin; };
+    const SpacingType& GetSpacing() const { return m_Spacing; };
+    const DirectionType& GetDirection() const { return m_Direction; };
+    const SizeType& GetSize() const { return m_Size; };
+
+    std::size_t GetNumberOfVoxels() const { return m_Size[0] * m_Size[1] * m_Size[2]; };
+
+    /**Position of the voxel in the target space.*/
+    PointType GetTargetPoint(std::size_t x, std::size_t y, std::size_t z) const
+    {
+      PointType result = m_Origin;
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        result[i] += m_IndexToWorld[i][0] * x + m_IndexToWorld[i][1] * y + m_IndexToWorld[i][2] * z;
+      }
+      return result;
+    };
+
+    /**Position of the voxel in the moving space.
+     * @return false if the registration does not map the voxel.*/
+    bool GetMovingPoint(std::size_t x, std::size_t y, std::size_t z, PointType& movingPoint) const
+    {
+      const float* displacement = &(m_Displacements[3 * (x + m_Size[0] * (y + m_Size[1] * z))]);
+      if (displacement[0] != displacement[0]) // NaN marks positions the kernel could not map
+      {
+        return false;
+      }
+
+      movingPoint = this->GetTargetPoint(x, y, z);
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        movingPoint[i] += displacement[i];
+      }
+      return true;
+    };
+
+  protected:
+    ImageMappingField();
+    ~ImageMappingField() override;
+
+  private:
+    ImageMappingField(const Self &) = delete;
+    Self &operator=(const Self &) = delete;
+
+    /**Extracts the grid of resultGeometry like the result image descriptor of ImageMappingHelper::map().*/
+    static void ExtractGrid(const ResultImageGeometryType* resultGeometry, PointType& origin, SpacingType& spacing, DirectionType& direction, SizeType& size);
+
+    ResultImageGeometryType::Pointer m_Geometry;
+    PointType m_Origin;
+    SpacingType m_Spacing;
+    DirectionType m_Direction;
+    SizeType m_Size;
+    DirectionType m_IndexToWorld;
+
+    std::vector<float> m_Displacements;
+
+    const RegistrationType* m_Registration;
+    itk::ModifiedTimeType m_RegistrationMTime;
+  };
+}
+
+#endif
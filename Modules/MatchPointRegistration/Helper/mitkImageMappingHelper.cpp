@@ -25,12 +25,22 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkGeometry3D.h>
 #include <mitkImageToItk.h>
 #include <mitkImageTimeSelector.h>
+#include <mitkImageWriteAccessor.h>
 
 #include "mapRegistration.h"
 
 #include "mitkImageMappingHelper.h"
 #include "mitkRegistrationHelper.h"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 template <typename TImage >
 typename ::itk::InterpolateImageFunction< TImage >::Pointer generateInterpolator(mitk::ImageMappingInterpolator::Type interpolatorType)
 {
@@ -222,6 +232,214 @@ void doMITKMap(const ::itk::Image<TPixelType,VImageDimension>* input, mitk::Imag
   mitk::CastToMitkImage<>(spTask->getResultImage(),result);
 }
 
+/**Maps all time steps of input with the precomputed field. Every time step is interpolated as a volume of its own;
+ * the slices of all time steps are resampled in one parallel pass. For a single time step the result image is created,
+ * otherwise result has to be initialized with the geometry of the field.*/
+template <typename TPixelType, unsigned int VImageDimension >
+void doMITKMapByField(const ::itk::Image<TPixelType,VImageDimension>* input, mitk::ImageMappingHelper::ResultImageType::Pointer& result, const mitk::ImageMappingField* field,
+  bool throwOnOutOfInputAreaError, const double& paddingValue, bool throwOnMappingError, const double& errorValue, mitk::ImageMappingInterpolator::Type interpolatorType)
+{
+  typedef ::itk::Image<TPixelType,VImageDimension> InputImageType;
+  typedef ::itk::Image<TPixelType,3> VolumeType;
+  typedef ::itk::InterpolateImageFunction< VolumeType > InterpolatorType;
+
+  const typename InputImageType::SizeType inputSize = input->GetLargestPossibleRegion().GetSize();
+  const std::size_t numberOfTimeSteps = VImageDimension > 3 ? inputSize[VImageDimension - 1] : 1;
+
+  //wrap every time step of the input into a volume (no copy) with its own interpolator
+  /////////////////////////
+  typename VolumeType::SizeType volumeSize;
+  typename VolumeType::PointType volumeOrigin;
+  typename VolumeType::SpacingType volumeSpacing;
+  typename VolumeType::DirectionType volumeDirection;
+  for (unsigned int i = 0; i<3; ++i)
+  {
+    volumeSize[i] = inputSize[i];
+    volumeOrigin[i] = input->GetOrigin()[i];
+    volumeSpacing[i] = input->GetSpacing()[i];
+    for (unsigned int j = 0; j<3; ++j)
+    {
+      volumeDirection[i][j] = input->GetDirection()[i][j];
+    }
+  }
+  const std::size_t voxelsPerInputVolume = volumeSize[0] * volumeSize[1] * volumeSize[2];
+
+  std::vector<typename VolumeType::Pointer> volumes;
+  std::vector<typename InterpolatorType::Pointer> interpolators;
+  for (std::size_t t = 0; t<numberOfTimeSteps; ++t)
+  {
+    typename VolumeType::Pointer volume = VolumeType::New();
+    volume->SetRegions(volumeSize);
+    volume->SetOrigin(volumeOrigin);
+    volume->SetSpacing(volumeSpacing);
+    volume->SetDirection(volumeDirection);
+    volume->GetPixelContainer()->SetImportPointer(const_cast<TPixelType*>(input->GetBufferPointer()) + t * voxelsPerInputVolume, voxelsPerInputVolume, false);
+
+    typename InterpolatorType::Pointer interpolator = generateInterpolator< VolumeType >(interpolatorType);
+    assert(interpolator.IsNotNull());
+    interpolator->SetInputImage(volume);
+
+    volumes.push_back(volume);
+    interpolators.push_back(interpolator);
+  }
+
+  //prepare the result buffer
+  /////////////////////////
+  const mitk::ImageMappingField::SizeType& fieldSize = field->GetSize();
+  const std::size_t voxelsPerResultVolume = field->GetNumberOfVoxels();
+
+  typename VolumeType::Pointer resultVolume;
+  std::unique_ptr<mitk::ImageWriteAccessor> resultAccessor;
+  TPixelType* resultBuffer = nullptr;
+  if (result.IsNull())
+  {
+    resultVolume = VolumeType::New();
+    resultVolume->SetRegions(fieldSize);
+    resultVolume->SetOrigin(field->GetOrigin());
+    resultVolume->SetSpacing(field->GetSpacing());
+    resultVolume->SetDirection(field->GetDirection());
+    resultVolume->Allocate();
+    resultBuffer = resultVolume->GetBufferPointer();
+  }
+  else
+  {
+    resultAccessor.reset(new mitk::ImageWriteAccessor(result));
+    resultBuffer = static_cast<TPixelType*>(resultAccessor->GetData());
+  }
+
+  //do the mapping
+  /////////////////////////
+  const double lowestValue = static_cast<double>(std::numeric_limits<TPixelType>::lowest());
+  const double maximumValue = static_cast<double>(std::numeric_limits<TPixelType>::max());
+
+  auto mapSlice = [&](std::size_t item)
+  {
+    const std::size_t t = item / fieldSize[2];
+    const std::size_t z = item % fieldSize[2];
+    const InterpolatorType* interpolator = interpolators[t];
+    TPixelType* output = resultBuffer + t * voxelsPerResultVolume + z * fieldSize[0] * fieldSize[1];
+
+    for (std::size_t y = 0; y < fieldSize[1]; ++y)
+    {
+      for (std::size_t x = 0; x < fieldSize[0]; ++x, ++output)
+      {
+        typename InterpolatorType::PointType movingPoint;
+        double value = 0.0;
+
+        if (!field->GetMovingPoint(x, y, z, movingPoint))
+        {
+          if (throwOnMappingError)
+          {
+            mitkThrow() << "Cannot map image. Registration does not map the result position " << field->GetTargetPoint(x, y, z) << ".";
+          }
+          value = errorValue;
+        }
+        else if (!interpolator->IsInsideBuffer(movingPoint))
+        {
+          if (throwOnOutOfInputAreaError)
+          {
+            mitkThrow() << "Cannot map image. Result position " << field->GetTargetPoint(x, y, z) << " is mapped outside of the input image.";
+          }
+          value = paddingValue;
+        }
+        else
+        {
+          value = interpolator->Evaluate(movingPoint);
+        }
+
+        *output = static_cast<TPixelType>(std::min(maximumValue, std::max(lowestValue, value)));
+      }
+    }
+  };
+
+  const std::size_t numberOfItems = numberOfTimeSteps * fieldSize[2];
+  std::atomic<std::size_t> nextItem(0);
+  std::exception_ptr exception;
+  std::mutex exceptionMutex;
+
+  auto worker = [&]()
+  {
+    for (std::size_t item = nextItem++; item < numberOfItems; item = nextItem++)
+    {
+      try
+      {
+        mapSlice(item);
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(exceptionMutex);
+        if (!exception)
+          exception = std::current_exception();
+        nextItem = numberOfItems;
+        return;
+      }
+    }
+  };
+
+  const std::size_t numberOfThreads = std::max<std::size_t>(1, std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), numberOfItems));
+  std::vector<std::thread> threads;
+  for (std::size_t i = 1; i < numberOfThreads; ++i)
+  {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  if (exception)
+  {
+    std::rethrow_exception(exception);
+  }
+
+  if (resultVolume.IsNotNull())
+  {
+    mitk::CastToMitkImage<>(resultVolume.GetPointer(),result);
+  }
+}
+
+mitk::ImageMappingHelper::ResultImageType::Pointer
+  mitk::ImageMappingHelper::map(const InputImageType* input, const ImageMappingField* field,
+  bool throwOnOutOfInputAreaError, const double& paddingValue,
+  bool throwOnMappingError, const double& errorValue, mitk::ImageMappingInterpolator::Type interpolatorType)
+{
+  if (!field || !field->GetGeometry())
+  {
+    mitkThrow() << "Cannot map image. Passed mapping field pointer is nullptr or the field has not been generated.";
+  }
+  if (!input)
+  {
+    mitkThrow() << "Cannot map image. Passed image pointer is nullptr.";
+  }
+
+  ResultImageType::Pointer result;
+
+  if(input->GetTimeSteps()==1)
+  {
+    AccessFixedDimensionByItk_n(input, doMITKMapByField, 3, (result, field, throwOnOutOfInputAreaError, paddingValue, throwOnMappingError, errorValue, interpolatorType));
+  }
+  else
+  { //all time steps share the grid of the field
+
+    mitk::TimeGeometry::ConstPointer timeGeometry = input->GetTimeGeometry();
+    mitk::TimeGeometry::Pointer mappedTimeGeometry = timeGeometry->Clone();
+
+    for (unsigned int i = 0; i<input->GetTimeSteps(); ++i)
+    {
+      ResultImageGeometryType::Pointer mappedGeometry = field->GetGeometry()->Clone();
+      mappedTimeGeometry->SetTimeStepGeometry(mappedGeometry,i);
+    }
+
+    result = mitk::Image::New();
+    result->Initialize(input->GetPixelType(),*mappedTimeGeometry, 1, input->GetTimeSteps());
+
+    AccessFixedDimensionByItk_n(input, doMITKMapByField, 4, (result, field, throwOnOutOfInputAreaError, paddingValue, throwOnMappingError, errorValue, interpolatorType));
+  }
+
+  return result;
+}
+
 mitk::ImageMappingHelper::ResultImageType::Pointer
   mitk::ImageMappingHelper::map(const InputImageType* input, const RegistrationType* registration,
   bool throwOnOutOfInputAreaError, const double& paddingValue, const ResultImageGeometryType* resultGeometry,
@@ -242,16 +460,25 @@ mitk::ImageMappingHelper::ResultImageType::Pointer
   { //map the image and done
     AccessByItk_n(input, doMITKMap, (result, registration, throwOnOutOfInputAreaError, paddingValue, resultGeometry, throwOnMappingError, errorValue, interpolatorType));
   }
+  else if (input->GetDimension()==4 && dynamic_cast<const ::map::core::Registration<3,3>*>(registration))
+  { //evaluate the registration once for all time steps
+    ImageMappingField::Pointer field = ImageMappingField::New();
+    field->Generate(registration, resultGeometry ? resultGeometry : input->GetGeometry());
+    result = map(input, field, throwOnOutOfInputAreaError, paddingValue, throwOnMappingError, errorValue, interpolatorType);
+  }
   else
   { //map every time step and compose
 
     mitk::TimeGeometry::ConstPointer timeGeometry = input->GetTimeGeometry();
     mitk::TimeGeometry::Pointer mappedTimeGeometry = timeGeometry->Clone();
 
-    for (unsigned int i = 0; i<input->GetTimeSteps(); ++i)
+    if (resultGeometry)
     {
-      ResultImageGeometryType::Pointer mappedGeometry = resultGeometry->Clone();
-      mappedTimeGeometry->SetTimeStepGeometry(mappedGeometry,i);
+      for (unsigned int i = 0; i<input->GetTimeSteps(); ++i)
+      {
+        ResultImageGeometryType::Pointer mappedGeometry = resultGeometry->Clone();
+        mappedTimeGeometry->SetTimeStepGeometry(mappedGeometry,i);
+      }
     }
 
     result = mitk::Image::New();
@@ -278,7 +505,7 @@ mitk::ImageMappingHelper::ResultImageType::Pointer
 mitk::ImageMappingHelper::ResultImageType::Pointer
   mitk::ImageMappingHelper::map(const InputImageType* input, const MITKRegistrationType* registration,
   bool throwOnOutOfInputAreaError, const double& paddingValue, const ResultImageGeometryType* resultGeometry,
-  bool throwOnMappingError, const double& errorValue, mitk::ImageMappingInterpolator::Type)
+  bool throwOnMappingError, const double& errorValue, mitk::ImageMappingInterpolator::Type interpolatorType)
 {
   if (!registration)
   {
@@ -293,7 +520,14 @@ mitk::ImageMappingHelper::ResultImageType::Pointer
     mitkThrow() << "Cannot map image. Passed image pointer is nullptr.";
   }
 
-  ResultImageType::Pointer result = map(input, registration->GetRegistration(), throwOnOutOfInputAreaError, paddingValue, resultGeometry, throwOnMappingError, errorValue);
+  if (registration->GetCacheMappingField() && registration->GetMovingDimensions()==3 && registration->GetTargetDimensions()==3
+    && (input->GetDimension()==3 || input->GetDimension()==4))
+  { //reuse the field of former mappings onto the same grid
+    ImageMappingField::ConstPointer field = registration->GetMappingField(resultGeometry ? resultGeometry : input->GetGeometry());
+    return map(input, field, throwOnOutOfInputAreaError, paddingValue, throwOnMappingError, errorValue, interpolatorType);
+  }
+
+  ResultImageType::Pointer result = map(input, registration->GetRegistration(), throwOnOutOfInputAreaError, paddingValue, resultGeometry, throwOnMappingError, errorValue, interpolatorType);
   return result;
 }
 
@@ -24,6 +24,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkGeometry3D.h"
 
 #include "mitkMAPRegistrationWrapper.h"
+#include "mitkImageMappingField.h"
 
 #include "MitkMatchPointRegistrationExports.h"
 
@@ -86,12 +87,24 @@ namespace mitk
      * @pre Dimensionality of the registration must match with the input imageinput must be valid
      * @remark Depending in the settings of throwOnOutOfInputAreaError and throwOnMappingError it may also throw
      * due to inconsistencies in the mapping process. See parameter description.
+     * @remark If the wrapper caches its mapping field (MAPRegistrationWrapper::SetCacheMappingField()), 3D and 3D+t images
+     * are mapped with the field of former calls on the same grid.
      * @result Pointer to the resulting mapped image.h*/
     MITKMATCHPOINTREGISTRATION_EXPORT ResultImageType::Pointer map(const InputImageType* input, const MITKRegistrationType* registration,
       bool throwOnOutOfInputAreaError = false, const double& paddingValue = 0,
       const ResultImageGeometryType* resultGeometry = nullptr,
       bool throwOnMappingError = true, const double& errorValue = 0, mitk::ImageMappingInterpolator::Type interpolatorType = mitk::ImageMappingInterpolator::Linear);
 
+    /**Helper that maps a given input image with a precomputed mapping field (see ImageMappingField).
+     * @overload
+     * The result has the grid of the field, all time steps of the input are mapped in one parallel pass.
+     * Parameters are the same as for the other map() overloads.
+     * @pre input must be a 3D or 3D+t image
+     * @pre field must have been generated*/
+    MITKMATCHPOINTREGISTRATION_EXPORT ResultImageType::Pointer map(const InputImageType* input, const ImageMappingField* field,
+      bool throwOnOutOfInputAreaError = false, const double& paddingValue = 0,
+      bool throwOnMappingError = true, const double& errorValue = 0, mitk::ImageMappingInterpolator::Type interpolatorType = mitk::ImageMappingInterpolator::Linear);
+
     /**Method clones the input image and applies the registration by applying it to the Geometry3D of the image.
     Thus this method only produces a result if the passed registration has an direct mapping kernel that
     can be converted into an affine matrix transformation.
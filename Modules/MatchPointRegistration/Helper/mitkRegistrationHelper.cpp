@@ -19,6 +19,18 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 //MatchPoint
 #include "mapRegistrationKernel.h"
+#include "mapRegistrationManipulator.h"
+#include "mapPreCachedRegistrationKernel.h"
+#include "mapNullRegistrationKernel.h"
+
+//MITK
+#include <mitkExceptionMacro.h>
+#include <mitkImageToItk.h>
+
+//ITK
+#include <itkDisplacementFieldTransform.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
 
 namespace mitk
 {
@@ -122,6 +134,61 @@ namespace mitk
     return result;
   }
 
+  MAPRegistrationWrapper::Pointer
+  MITKRegistrationHelper::
+  generateRegistrationFromDisplacementField(const mitk::Image* field)
+  {
+    if (!field)
+    {
+      mitkThrow() << "Cannot generate registration. Passed displacement field is nullptr.";
+    }
+    if (field->GetDimension() != 3 || field->GetPixelType().GetNumberOfComponents() != 3 ||
+        field->GetPixelType().GetComponentType() != itk::ImageIOBase::FLOAT)
+    {
+      mitkThrow() << "Cannot generate registration. Displacement field must be a 3D image with 3 float components.";
+    }
+
+    typedef itk::Image<itk::Vector<float, 3>, 3> InputFieldType;
+    typedef itk::DisplacementFieldTransform< ::map::core::continuous::ScalarType, 3> TransformType;
+    typedef TransformType::DisplacementFieldType FieldType;
+
+    InputFieldType::ConstPointer input = mitk::ImageToItkImage<itk::Vector<float, 3>, 3>(field);
+
+    FieldType::Pointer displacements = FieldType::New();
+    displacements->SetRegions(input->GetLargestPossibleRegion());
+    displacements->SetOrigin(input->GetOrigin());
+    displacements->SetSpacing(input->GetSpacing());
+    displacements->SetDirection(input->GetDirection());
+    displacements->Allocate();
+
+    itk::ImageRegionConstIterator<InputFieldType> inputIter(input, input->GetLargestPossibleRegion());
+    itk::ImageRegionIterator<FieldType> outputIter(displacements, displacements->GetLargestPossibleRegion());
+    for (; !inputIter.IsAtEnd(); ++inputIter, ++outputIter)
+    {
+      FieldType::PixelType value;
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        value[i] = inputIter.Get()[i];
+      }
+      outputIter.Set(value);
+    }
+
+    TransformType::Pointer transform = TransformType::New();
+    transform->SetDisplacementField(displacements);
+
+    ::map::core::PreCachedRegistrationKernel<3, 3>::Pointer kernel = ::map::core::PreCachedRegistrationKernel<3, 3>::New();
+    kernel->setTransformModel(transform);
+
+    Registration3DType::Pointer registration = Registration3DType::New();
+    ::map::core::RegistrationManipulator<Registration3DType> manipulator(registration);
+    manipulator.setInverseMapping(kernel);
+    manipulator.setDirectMapping(::map::core::NullRegistrationKernel<3, 3>::New());
+
+    MAPRegistrationWrapper::Pointer wrapper = MAPRegistrationWrapper::New();
+    wrapper->SetRegistration(registration);
+    return wrapper;
+  }
+
   bool MITKRegistrationHelper::IsRegNode(const mitk::DataNode* node)
   {
     if (!node) return false;
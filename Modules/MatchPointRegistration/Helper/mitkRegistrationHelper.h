@@ -59,6 +59,13 @@ public:
   static bool is3D(const mitk::MAPRegistrationWrapper* wrapper);
   static bool is3D(const RegistrationBaseType* regBase);
 
+  /** Generates a 3D registration from a dense displacement field, e.g. the result of a GPU based deformable registration.
+   @param field 3D image with 3 float components. Every vector (in world coordinates) maps a position x of the target
+    space onto the position x + field(x) in the moving space (inverse mapping). The field defines the target space.
+   @return Registration wrapper with the field as inverse mapping. The direct mapping is not available.
+   @pre field must point to a valid 3D image with 3 float components, otherwise an mitk::Exception is thrown.*/
+  static MAPRegistrationWrapper::Pointer generateRegistrationFromDisplacementField(const mitk::Image* field);
+
   /** Checks if the passed Node contains a MatchPoint registration
    @param Pointer to the node to be checked.*
    @return true: node contains a MAPRegistrationWrapper. false: "node" does not point to a valid instance or does not contain
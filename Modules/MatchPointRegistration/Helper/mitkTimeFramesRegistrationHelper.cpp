@@ -23,6 +23,13 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkMaskedAlgorithmHelper.h>
 #include <mitkAlgorithmHelper.h>
 
+#include <mapMetaPropertyAlgorithmInterface.h>
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <vector>
+
 mitk::Image::Pointer
 mitk::TimeFramesRegistrationHelper::GetFrameImage(const mitk::Image* image,
     mitk::TimePointType timePoint) const
@@ -60,51 +67,106 @@ mitk::TimeFramesRegistrationHelper::Generate()
     }
   }
 
-  double progressDelta = 1.0 / ((this->m_4DImage->GetTimeSteps() - 1) * 3.0);
+  const double progressDelta = 1.0 / ((this->m_4DImage->GetTimeSteps() - 1) * 3.0);
   m_Progress = 0.0;
 
-  //process the frames
-  for (unsigned int i = 1; i < this->m_4DImage->GetTimeSteps(); ++i)
+  auto addProgress = [this](double delta)
   {
-    Image::Pointer movingFrame = GetFrameImage(this->m_4DImage, i);
-    Image::Pointer mappedFrame;
-
-    IgnoreListType::iterator finding = std::find(m_IgnoreList.begin(), m_IgnoreList.end(), i);
-
-
-    if (finding == m_IgnoreList.end())
-    {
-      //frame should be processed
-      RegistrationPointer reg = DoFrameRegistration(movingFrame, targetFrame, mask);
-
-      m_Progress += progressDelta;
-      this->InvokeEvent(::mitk::FrameRegistrationEvent(nullptr,
-                        "Registred frame #" +::map::core::convert::toStr(i)));
-
-      mappedFrame = DoFrameMapping(movingFrame, reg, targetFrame);
-
-      m_Progress += progressDelta;
-      this->InvokeEvent(::mitk::FrameMappingEvent(nullptr,
-                        "Mapped frame #" + ::map::core::convert::toStr(i)));
-
-      mitk::ImageReadAccessor accessor(mappedFrame, mappedFrame->GetVolumeData(0, 0, nullptr,
-                                       mitk::Image::ReferenceMemory));
+    m_Progress = m_Progress.load() + delta;
+  };
 
+  //process the frames
+  const unsigned int numberOfFrames = this->m_4DImage->GetTimeSteps();
+  std::atomic<unsigned int> nextFrame(1);
+  std::exception_ptr exception;
 
-      this->m_Registered4DImage->SetVolume(accessor.GetData(), i);
-      this->m_Registered4DImage->GetTimeGeometry()->SetTimeStepGeometry(mappedFrame->GetGeometry(), i);
-
-      m_Progress += progressDelta;
-    }
-    else
+  auto worker = [&](RegistrationAlgorithmBaseType* algorithm)
+  {
+    for (unsigned int i = nextFrame++; i < numberOfFrames; i = nextFrame++)
     {
-      m_Progress += 3 * progressDelta;
+      try
+      {
+        Image::Pointer movingFrame;
+        {
+          std::lock_guard<std::mutex> lock(m_ProcessingMutex);
+          movingFrame = GetFrameImage(this->m_4DImage, i);
+        }
+
+        IgnoreListType::const_iterator finding = std::find(m_IgnoreList.cbegin(), m_IgnoreList.cend(), i);
+
+        if (finding == m_IgnoreList.cend())
+        {
+          //frame should be processed
+          RegistrationPointer reg = DoFrameRegistration(movingFrame, targetFrame, mask, algorithm);
+
+          {
+            std::lock_guard<std::mutex> lock(m_ProcessingMutex);
+            addProgress(progressDelta);
+            this->InvokeEvent(::mitk::FrameRegistrationEvent(nullptr,
+                              "Registred frame #" +::map::core::convert::toStr(i)));
+          }
+
+          Image::Pointer mappedFrame = DoFrameMapping(movingFrame, reg, targetFrame);
+
+          std::lock_guard<std::mutex> lock(m_ProcessingMutex);
+          addProgress(progressDelta);
+          this->InvokeEvent(::mitk::FrameMappingEvent(nullptr,
+                            "Mapped frame #" + ::map::core::convert::toStr(i)));
+
+          mitk::ImageReadAccessor accessor(mappedFrame, mappedFrame->GetVolumeData(0, 0, nullptr,
+                                           mitk::Image::ReferenceMemory));
+
+          this->m_Registered4DImage->SetVolume(accessor.GetData(), i);
+          this->m_Registered4DImage->GetTimeGeometry()->SetTimeStepGeometry(mappedFrame->GetGeometry(), i);
+
+          addProgress(progressDelta);
+          this->InvokeEvent(::itk::ProgressEvent());
+        }
+        else
+        {
+          std::lock_guard<std::mutex> lock(m_ProcessingMutex);
+          addProgress(3 * progressDelta);
+          this->InvokeEvent(::itk::ProgressEvent());
+        }
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(m_ProcessingMutex);
+        if (!exception)
+        {
+          exception = std::current_exception();
+        }
+        nextFrame = numberOfFrames;
+        return;
+      }
     }
+  };
 
-    this->InvokeEvent(::itk::ProgressEvent());
+  unsigned int numberOfRegistrations = m_NumberOfConcurrentRegistrations > 0 ? m_NumberOfConcurrentRegistrations : std::max(1u, std::thread::hardware_concurrency());
+  numberOfRegistrations = std::max(1u, std::min(numberOfRegistrations, numberOfFrames - 1));
 
+  //every concurrent registration needs its own algorithm instance
+  std::vector<RegistrationAlgorithmPointer> algorithms;
+  for (unsigned int i = 1; i < numberOfRegistrations; ++i)
+  {
+    algorithms.push_back(this->CloneAlgorithm());
+  }
+
+  std::vector<std::thread> threads;
+  for (const auto& algorithm : algorithms)
+  {
+    threads.emplace_back(worker, algorithm.GetPointer());
+  }
+  worker(m_Algorithm);
+  for (auto& thread : threads)
+  {
+    thread.join();
   }
 
+  if (exception)
+  {
+    std::rethrow_exception(exception);
+  }
 };
 
 mitk::Image::Pointer
@@ -138,19 +200,72 @@ mitk::TimeFramesRegistrationHelper::RegistrationPointer
 mitk::TimeFramesRegistrationHelper::DoFrameRegistration(const mitk::Image* movingFrame,
     const mitk::Image* targetFrame, const mitk::Image* targetMask) const
 {
-  mitk::MITKAlgorithmHelper algHelper(m_Algorithm);
+  return DoFrameRegistration(movingFrame, targetFrame, targetMask, m_Algorithm);
+};
+
+mitk::TimeFramesRegistrationHelper::RegistrationPointer
+mitk::TimeFramesRegistrationHelper::DoFrameRegistration(const mitk::Image* movingFrame,
+    const mitk::Image* targetFrame, const mitk::Image* targetMask, RegistrationAlgorithmBaseType* algorithm) const
+{
+  mitk::MITKAlgorithmHelper algHelper(algorithm);
   algHelper.SetAllowImageCasting(true);
   algHelper.SetData(movingFrame, targetFrame);
 
   if (targetMask)
   {
-    mitk::MaskedAlgorithmHelper maskHelper(m_Algorithm);
+    mitk::MaskedAlgorithmHelper maskHelper(algorithm);
     maskHelper.SetMasks(nullptr, targetMask);
   }
 
   return algHelper.GetRegistration();
 };
 
+mitk::TimeFramesRegistrationHelper::RegistrationAlgorithmPointer
+mitk::TimeFramesRegistrationHelper::CloneAlgorithm() const
+{
+  ::itk::LightObject::Pointer another = m_Algorithm->CreateAnother();
+  RegistrationAlgorithmPointer clone = dynamic_cast<RegistrationAlgorithmBaseType*>(another.GetPointer());
+
+  if (clone.IsNull())
+  {
+    mitkThrow() << "Cannot register frames concurrently. Algorithm cannot be instantiated. Algorithm: " << m_Algorithm->GetNameOfClass();
+  }
+
+  typedef ::map::algorithm::facet::MetaPropertyAlgorithmInterface MetaInterfaceType;
+  MetaInterfaceType* sourceMeta = dynamic_cast<MetaInterfaceType*>(m_Algorithm.GetPointer());
+  MetaInterfaceType* cloneMeta = dynamic_cast<MetaInterfaceType*>(clone.GetPointer());
+
+  if (sourceMeta && cloneMeta)
+  {
+    const MetaInterfaceType::MetaPropertyVectorType cloneInfos = cloneMeta->getPropertyInfos();
+
+    for (const auto& info : sourceMeta->getPropertyInfos())
+    {
+      if (!info->isReadable() || !info->isWritable())
+      {
+        continue;
+      }
+
+      MetaInterfaceType::MetaPropertyPointer prop = sourceMeta->getProperty(info);
+      if (!prop)
+      {
+        continue;
+      }
+
+      for (const auto& cloneInfo : cloneInfos)
+      {
+        if (cloneInfo->getName() == info->getName())
+        {
+          cloneMeta->setProperty(cloneInfo, prop);
+          break;
+        }
+      }
+    }
+  }
+
+  return clone;
+};
+
 mitk::Image::Pointer mitk::TimeFramesRegistrationHelper::DoFrameMapping(
   const mitk::Image* movingFrame, const RegistrationType* reg, const mitk::Image* targetFrame) const
 {
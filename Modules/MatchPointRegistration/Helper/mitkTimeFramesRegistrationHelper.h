@@ -28,6 +28,9 @@
 
 #include "MitkMatchPointRegistrationExports.h"
 
+#include <atomic>
+#include <mutex>
+
 namespace mitk
 {
 
@@ -43,6 +46,12 @@ namespace mitk
    * - mitk::FrameRegistrationEvent: when ever a frame was registered.
    * - mitk::FrameMappingEvent: when ever a frame was mapped registered.
    * - itk::ProgressEvent: when ever a new frame was added to the result image.
+   *
+   * Frames can be registered concurrently (see SetNumberOfConcurrentRegistrations()). Each concurrent registration uses
+   * its own algorithm instance: the set algorithm and clones of it (see CloneAlgorithm()). The frames are written to their
+   * position of the result image, irrespective of the order in which they are finished. The events are invoked
+   * serialized, but from the thread that processed the frame; observers of the set algorithm only receive the events of
+   * the frames registered by the set algorithm itself.
    */
   class MITKMATCHPOINTREGISTRATION_EXPORT TimeFramesRegistrationHelper : public itk::Object
   {
@@ -82,6 +91,11 @@ namespace mitk
     itkSetMacro(InterpolatorType, mitk::ImageMappingInterpolator::Type);
     itkGetConstMacro(InterpolatorType, mitk::ImageMappingInterpolator::Type);
 
+    /** Number of frames that are registered concurrently. 1 (default) registers the frames sequentially with
+     * the set algorithm, 0 uses one registration per core.*/
+    itkSetMacro(NumberOfConcurrentRegistrations, unsigned int);
+    itkGetConstMacro(NumberOfConcurrentRegistrations, unsigned int);
+
     /** cleares the ignore list. Therefore all frames will be processed.*/
     void ClearIgnoreList();
     void SetIgnoreList(const IgnoreListType& il);
@@ -114,6 +128,7 @@ namespace mitk
       m_AllowUnregPixels(true),
       m_ErrorValue(0),
       m_InterpolatorType(mitk::ImageMappingInterpolator::Linear),
+      m_NumberOfConcurrentRegistrations(1),
       m_Progress(0)
     {
       m_4DImage = nullptr;
@@ -126,6 +141,16 @@ namespace mitk
     RegistrationPointer DoFrameRegistration(const mitk::Image* movingFrame,
                                             const mitk::Image* targetFrame, const mitk::Image* targetMask) const;
 
+    /** Registers the frames with the passed algorithm instead of the set one.*/
+    RegistrationPointer DoFrameRegistration(const mitk::Image* movingFrame,
+                                            const mitk::Image* targetFrame, const mitk::Image* targetMask,
+                                            RegistrationAlgorithmBaseType* algorithm) const;
+
+    /** Creates a new instance of the set algorithm for a concurrent registration and copies all
+     * readable and writable meta properties of the set algorithm into it.
+     * Throws an mitk::Exception if the algorithm cannot be instantiated.*/
+    virtual RegistrationAlgorithmPointer CloneAlgorithm() const;
+
     mitk::Image::Pointer DoFrameMapping(const mitk::Image* movingFrame, const RegistrationType* reg,
                                         const mitk::Image* targetFrame) const;
 
@@ -156,7 +181,12 @@ namespace mitk
     /** Type of interpolator. Only relevant for images and if m_doGeometryRefinement is false. */
     mitk::ImageMappingInterpolator::Type m_InterpolatorType;
 
-    double m_Progress;
+    unsigned int m_NumberOfConcurrentRegistrations;
+
+    std::atomic<double> m_Progress;
+    /** Serializes event invocations, frame extraction and writing of the result image
+     * during concurrent registrations.*/
+    mutable std::mutex m_ProcessingMutex;
   };
 
 }
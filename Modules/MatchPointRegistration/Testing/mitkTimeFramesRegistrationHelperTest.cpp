@@ -28,6 +28,7 @@ class mitkTimeFramesRegistrationHelperTestSuite : public mitk::TestFixture
   MITK_TEST(SetErrorValue_GetErrorValue);
   MITK_TEST(SetAllowUnregPixels_GetAllowUnregPixels);
   MITK_TEST(SetInterpolatorType_GetInterpolatorType);
+  MITK_TEST(SetNumberOfConcurrentRegistrations_GetNumberOfConcurrentRegistrations);
   MITK_TEST(Set_Get_Clear_IgnoreList);
   CPPUNIT_TEST_SUITE_END();
 private:
@@ -91,6 +92,15 @@ public:
                                  mitk::ImageMappingInterpolator::NearestNeighbor, frameRegHelper->GetInterpolatorType());
   }
 
+  void SetNumberOfConcurrentRegistrations_GetNumberOfConcurrentRegistrations()
+  {
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Check getter on default value", 1u,
+                                 frameRegHelper->GetNumberOfConcurrentRegistrations());
+    frameRegHelper->SetNumberOfConcurrentRegistrations(4);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Check getter on changed value", 4u,
+                                 frameRegHelper->GetNumberOfConcurrentRegistrations());
+  }
+
   void Set_Get_Clear_IgnoreList()
   {
     CPPUNIT_ASSERT(frameRegHelper->GetIgnoreList().empty());
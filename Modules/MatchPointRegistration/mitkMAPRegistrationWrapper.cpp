@@ -18,7 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mapExceptionObjectMacros.h>
 
-mitk::MAPRegistrationWrapper::MAPRegistrationWrapper()
+mitk::MAPRegistrationWrapper::MAPRegistrationWrapper() : m_CacheMappingField(false)
 {
 }
 
@@ -114,6 +114,52 @@ const map::core::RegistrationBase* mitk::MAPRegistrationWrapper::GetRegistration
 void mitk::MAPRegistrationWrapper::SetRegistration(map::core::RegistrationBase* pReg)
 {
   m_spRegistration = pReg;
+  this->ReleaseMappingField();
+}
+
+void mitk::MAPRegistrationWrapper::SetCacheMappingField(bool cache)
+{
+  m_CacheMappingField = cache;
+  if (!cache)
+  {
+    this->ReleaseMappingField();
+  }
+}
+
+bool mitk::MAPRegistrationWrapper::GetCacheMappingField() const
+{
+  return m_CacheMappingField;
+}
+
+mitk::ImageMappingField::ConstPointer mitk::MAPRegistrationWrapper::GetMappingField(const mitk::BaseGeometry* resultGeometry) const
+{
+  if (m_spRegistration.IsNull())
+  {
+    mitkThrow()<< "Error. Cannot return mapping field. Wrapper points to invalid registration (nullptr).";
+  }
+
+  if (!m_CacheMappingField)
+  {
+    ImageMappingField::Pointer field = ImageMappingField::New();
+    field->Generate(m_spRegistration, resultGeometry);
+    return field.GetPointer();
+  }
+
+  std::lock_guard<std::mutex> lock(m_MappingFieldMutex);
+  if (m_MappingField.IsNull() || !m_MappingField->IsGeneratedFor(m_spRegistration, resultGeometry))
+  {
+    // a new field instance, so that callers may still use the previous one
+    ImageMappingField::Pointer field = ImageMappingField::New();
+    field->Generate(m_spRegistration, resultGeometry);
+    m_MappingField = field;
+  }
+  return m_MappingField.GetPointer();
+}
+
+void mitk::MAPRegistrationWrapper::ReleaseMappingField()
+{
+  std::lock_guard<std::mutex> lock(m_MappingFieldMutex);
+  m_MappingField = nullptr;
 }
 
 void mitk::MAPRegistrationWrapper::PrintSelf (std::ostream &os, itk::Indent indent) const
@@ -30,6 +30,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 //MITK
 #include "MitkMatchPointRegistrationExports.h"
+#include "mitkImageMappingField.h"
+
+#include <mutex>
 
 namespace mitk
 {
@@ -251,6 +254,22 @@ public:
 
   void SetRegistration(::map::core::RegistrationBase* pReg);
 
+  /*! Enables the cache of the mapping field that mitk::ImageMappingHelper::map() samples on the result grid.
+  If enabled, mapping several images on the same grid with this wrapper evaluates the registration only once.
+  The cache is renewed if the grid or the registration changes. Default is false.
+  */
+  void SetCacheMappingField(bool cache);
+  bool GetCacheMappingField() const;
+
+  /*! Returns the mapping field of the registration for the grid of resultGeometry. The field is generated if the
+  cache is disabled or does not cover resultGeometry.
+  @pre valid 3D registration instance must be set.
+  */
+  ImageMappingField::ConstPointer GetMappingField(const mitk::BaseGeometry* resultGeometry) const;
+
+  /*! Releases the memory of the cached mapping field.*/
+  void ReleaseMappingField();
+
 protected:
     void PrintSelf (std::ostream &os, itk::Indent indent) const override;
 
@@ -259,6 +278,10 @@ protected:
 
     ::map::core::RegistrationBase::Pointer m_spRegistration;
 
+    bool m_CacheMappingField;
+    mutable ImageMappingField::Pointer m_MappingField;
+    mutable std::mutex m_MappingFieldMutex;
+
 private:
 
     MAPRegistrationWrapper& operator = (const MAPRegistrationWrapper&);
@@ -15,6 +15,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include <mitkIOUtil.h>
+#include <mitkImagePixelWriteAccessor.h>
 #include <mitkImageStatisticsHolder.h>
 #include <mitkLabelSetImage.h>
 #include <mitkTestFixture.h>
@@ -38,6 +39,7 @@ class mitkLabelSetImageTestSuite : public mitk::TestFixture
   MITK_TEST(TestRemoveLayer);
   MITK_TEST(TestRemoveLabels);
   MITK_TEST(TestMergeLabel);
+  MITK_TEST(TestLabelBoundingBox);
   // TODO check it these functionalities can be moved into a process object
   //  MITK_TEST(TestMergeLabels);
   //  MITK_TEST(TestConcatenate);
@@ -442,6 +444,51 @@ public:
     // Count all pixels with value 6 = 507
     // Check if merge label has 507 + 823 = 1330 pixels
     CPPUNIT_ASSERT_MESSAGE("Label with value 7 was not remove from the image", m_LabelSetImage->GetStatistics()->GetCountOfMaxValuedVoxels() == 1330);
+    CPPUNIT_ASSERT_MESSAGE("Wrong voxel count of the merged label", m_LabelSetImage->GetNumberOfLabelVoxels(6) == 1330);
+    CPPUNIT_ASSERT_MESSAGE("Merged label still has voxels", m_LabelSetImage->GetNumberOfLabelVoxels(7) == 0);
+  }
+
+  void TestLabelBoundingBox()
+  {
+    CPPUNIT_ASSERT_MESSAGE("Empty image has a label box",
+                           m_LabelSetImage->GetLabelBoundingBox(1).GetNumberOfPixels() == 0);
+
+    {
+      mitk::ImagePixelWriteAccessor<mitk::LabelSetImage::PixelType, 3> accessor(m_LabelSetImage.GetPointer());
+      itk::Index<3> index;
+      index[0] = 10;
+      index[1] = 20;
+      index[2] = 30;
+      accessor.SetPixelByIndex(index, 1);
+      index[0] = 15;
+      index[1] = 22;
+      index[2] = 40;
+      accessor.SetPixelByIndex(index, 1);
+      index[0] = 100;
+      accessor.SetPixelByIndex(index, 2);
+    }
+    m_LabelSetImage->Modified();
+
+    mitk::LabelSetImage::LabelRegionType box = m_LabelSetImage->GetLabelBoundingBox(1);
+    CPPUNIT_ASSERT_MESSAGE("Wrong lower index of label box",
+                           box.GetIndex()[0] == 10 && box.GetIndex()[1] == 20 && box.GetIndex()[2] == 30);
+    CPPUNIT_ASSERT_MESSAGE("Wrong size of label box",
+                           box.GetSize()[0] == 6 && box.GetSize()[1] == 3 && box.GetSize()[2] == 11);
+    CPPUNIT_ASSERT_MESSAGE("Wrong voxel count of label 1", m_LabelSetImage->GetNumberOfLabelVoxels(1) == 2);
+
+    m_LabelSetImage->MergeLabel(1, 2);
+    box = m_LabelSetImage->GetLabelBoundingBox(1);
+    CPPUNIT_ASSERT_MESSAGE("Label box not grown by merge", box.GetUpperIndex()[0] == 100);
+    CPPUNIT_ASSERT_MESSAGE("Wrong voxel count after merge", m_LabelSetImage->GetNumberOfLabelVoxels(1) == 3);
+
+    mitk::Image::Pointer mask = m_LabelSetImage->CreateLabelMask(1);
+    CPPUNIT_ASSERT_MESSAGE("Wrong mask", mask->GetStatistics()->GetCountOfMaxValuedVoxels() == 3);
+
+    m_LabelSetImage->EraseLabel(1);
+    CPPUNIT_ASSERT_MESSAGE("Label box not removed by erase",
+                           m_LabelSetImage->GetLabelBoundingBox(1).GetNumberOfPixels() == 0);
+    CPPUNIT_ASSERT_MESSAGE("Label still in image after erase",
+                           m_LabelSetImage->GetStatistics()->GetScalarValueMax() == 0);
   }
 };
 
@@ -0,0 +1,115 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkEqual.h>
+#include <mitkImageCast.h>
+#include <mitkLabelSetImageToSurfaceFilter.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <itkImageRegionIterator.h>
+
+#include <vtkFeatureEdges.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+class mitkLabelSetImageToSurfaceFilterTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkLabelSetImageToSurfaceFilterTestSuite);
+  MITK_TEST(TestGenerateAllLabels);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef itk::Image<mitk::LabelSetImage::PixelType, 3> ItkImageType;
+
+  mitk::Image::Pointer m_Image;
+
+  static void FillBox(ItkImageType *image, const ItkImageType::IndexType &index, unsigned int edgeLength,
+                      mitk::LabelSetImage::PixelType label)
+  {
+    ItkImageType::SizeType size;
+    size.Fill(edgeLength);
+    itk::ImageRegionIterator<ItkImageType> it(image, ItkImageType::RegionType(index, size));
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+      it.Set(label);
+  }
+
+  static bool IsClosed(vtkPolyData *polydata)
+  {
+    auto featureEdges = vtkSmartPointer<vtkFeatureEdges>::New();
+    featureEdges->SetInputData(polydata);
+    featureEdges->BoundaryEdgesOn();
+    featureEdges->FeatureEdgesOff();
+    featureEdges->ManifoldEdgesOff();
+    featureEdges->NonManifoldEdgesOff();
+    featureEdges->Update();
+    return featureEdges->GetOutput()->GetNumberOfLines() == 0;
+  }
+
+public:
+  void setUp() override
+  {
+    ItkImageType::SizeType size;
+    size.Fill(20);
+    ItkImageType::Pointer itkImage = ItkImageType::New();
+    itkImage->SetRegions(size);
+    itkImage->Allocate();
+    itkImage->FillBuffer(0);
+
+    // Label 1 lies inside the image, label 2 touches its upper border, label 3 is adjacent to label 1
+    ItkImageType::IndexType index;
+    index.Fill(2);
+    FillBox(itkImage, index, 4, 1);
+    index.Fill(12);
+    FillBox(itkImage, index, 8, 2);
+    index[0] = 6;
+    index[1] = 2;
+    index[2] = 2;
+    FillBox(itkImage, index, 2, 3);
+
+    mitk::CastToMitkImage(itkImage, m_Image);
+  }
+
+  void tearDown() override { m_Image = nullptr; }
+
+  void TestGenerateAllLabels()
+  {
+    mitk::LabelSetImageToSurfaceFilter::Pointer filter = mitk::LabelSetImageToSurfaceFilter::New();
+    filter->SetInput(m_Image);
+    filter->GenerateAllLabelsOn();
+    filter->Update();
+
+    const mitk::LabelSetImageToSurfaceFilter::IndexToLabelMapType &labels = filter->GetIndexToLabels();
+    CPPUNIT_ASSERT_MESSAGE("One output per label", labels.size() == 3 && filter->GetNumberOfIndexedOutputs() == 3);
+    CPPUNIT_ASSERT_MESSAGE("Outputs sorted by label", labels.at(0) == 1 && labels.at(1) == 2 && labels.at(2) == 3);
+
+    const double expectedBounds[3][2] = {{1.5, 5.5}, {11.5, 19.5}, {5.5, 7.5}};
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      vtkPolyData *polydata = filter->GetOutput(i)->GetVtkPolyData();
+      CPPUNIT_ASSERT_MESSAGE("Label surface is not empty", polydata && polydata->GetNumberOfPolys() > 0);
+      CPPUNIT_ASSERT_MESSAGE("Label surface is closed", IsClosed(polydata));
+
+      double bounds[6];
+      polydata->GetBounds(bounds);
+      CPPUNIT_ASSERT_MESSAGE("Label surface encloses the label voxels",
+                             mitk::Equal(bounds[0], expectedBounds[i][0], 1e-6) &&
+                               mitk::Equal(bounds[1], expectedBounds[i][1], 1e-6));
+    }
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkLabelSetImageToSurfaceFilter)
@@ -8,6 +8,7 @@ set(CPP_FILES
   mitkLabelSetImageToSurfaceFilter.cpp
   mitkLabelSetImageToSurfaceThreadedFilter.cpp
   mitkLabelSetImageVtkMapper2D.cpp
+  vtkMitkLabelSetGPUMapper.cpp
   mitkMultilabelObjectFactory.cpp
   mitkLabelSetIOHelper.cpp
   mitkDICOMSegmentationPropertyHelper.cpp
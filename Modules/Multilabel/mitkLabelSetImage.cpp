@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkImageAccessByItk.h"
 #include "mitkImageCast.h"
 #include "mitkImagePixelReadAccessor.h"
+#include "mitkImageReadAccessor.h"
 #include "mitkImagePixelWriteAccessor.h"
 #include "mitkInteractionConst.h"
 #include "mitkLookupTableProperty.h"
@@ -36,6 +37,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <itkCommand.h>
 
+#include <algorithm>
+
 template <typename TPixel, unsigned int VDimensions>
 void SetToZero(itk::Image<TPixel, VDimensions> *source)
 {
@@ -43,18 +46,44 @@ void SetToZero(itk::Image<TPixel, VDimensions> *source)
 }
 
 template <unsigned int VImageDimension = 3>
-void CreateLabelMaskProcessing(mitk::Image *layerImage, mitk::Image *mask, mitk::LabelSet::PixelType index)
+void CreateLabelMaskProcessing(mitk::Image *layerImage,
+                               mitk::Image *mask,
+                               mitk::LabelSet::PixelType index,
+                               const mitk::LabelSetImage::LabelRegionType *boundingBox = nullptr)
 {
   mitk::ImagePixelReadAccessor<mitk::LabelSet::PixelType, VImageDimension> readAccessor(layerImage);
   mitk::ImagePixelWriteAccessor<mitk::LabelSet::PixelType, VImageDimension> writeAccessor(mask);
 
+  auto src = readAccessor.GetData();
+  auto dest = writeAccessor.GetData();
+
+  if (boundingBox != nullptr && VImageDimension == 3)
+  {
+    // only the rows within the bounding box of the label can contain it
+    const std::size_t dimX = readAccessor.GetDimension(0);
+    const std::size_t dimY = readAccessor.GetDimension(1);
+    const auto &lower = boundingBox->GetIndex();
+    const auto &size = boundingBox->GetSize();
+
+    for (std::size_t z = lower[2]; z < lower[2] + size[2]; ++z)
+    {
+      for (std::size_t y = lower[1]; y < lower[1] + size[1]; ++y)
+      {
+        const std::size_t rowOffset = (z * dimY + y) * dimX;
+        for (std::size_t i = rowOffset + lower[0]; i < rowOffset + lower[0] + size[0]; ++i)
+        {
+          if (index == *(src + i))
+            *(dest + i) = 1;
+        }
+      }
+    }
+    return;
+  }
+
   std::size_t numberOfPixels = 1;
   for (int dim = 0; dim < static_cast<int>(VImageDimension); ++dim)
     numberOfPixels *= static_cast<std::size_t>(readAccessor.GetDimension(dim));
 
-  auto src = readAccessor.GetData();
-  auto dest = writeAccessor.GetData();
-
   for (std::size_t i = 0; i < numberOfPixels; ++i)
   {
     if (index == *(src + i))
@@ -62,8 +91,25 @@ void CreateLabelMaskProcessing(mitk::Image *layerImage, mitk::Image *mask, mitk:
   }
 }
 
+/** Returns the region of itkImage the processing of a label is restricted to: its bounding box for 3D images. */
+template <typename ImageType>
+typename ImageType::RegionType GetLabelProcessingRegion(const ImageType *itkImage,
+                                                        const mitk::LabelSetImage::LabelRegionType *boundingBox)
+{
+  typename ImageType::RegionType region = itkImage->GetLargestPossibleRegion();
+  if (boundingBox == nullptr || ImageType::ImageDimension != 3)
+    return region;
+
+  for (unsigned int dim = 0; dim < ImageType::ImageDimension && dim < 3; ++dim)
+  {
+    region.SetIndex(dim, boundingBox->GetIndex(dim));
+    region.SetSize(dim, boundingBox->GetSize(dim));
+  }
+  return region;
+}
+
 mitk::LabelSetImage::LabelSetImage()
-  : mitk::Image(), m_ActiveLayer(0), m_activeLayerInvalid(false), m_ExteriorLabel(nullptr)
+  : mitk::Image(), m_ActiveLayer(0), m_activeLayerInvalid(false), m_ExteriorLabel(nullptr), m_LabelExtentsTime(0)
 {
   // Iniitlaize Background Label
   mitk::Color color;
@@ -80,7 +126,8 @@ mitk::LabelSetImage::LabelSetImage(const mitk::LabelSetImage &other)
   : Image(other),
     m_ActiveLayer(other.GetActiveLayer()),
     m_activeLayerInvalid(false),
-    m_ExteriorLabel(other.GetExteriorLabel()->Clone())
+    m_ExteriorLabel(other.GetExteriorLabel()->Clone()),
+    m_LabelExtentsTime(0)
 {
   for (unsigned int i = 0; i < other.GetNumberOfLayers(); i++)
   {
@@ -100,7 +147,11 @@ mitk::LabelSetImage::LabelSetImage(const mitk::LabelSetImage &other)
 
 void mitk::LabelSetImage::OnLabelSetModified()
 {
+  // changes of the label sets do not touch the voxels, the label extents stay valid
+  const bool extentsValid = m_LabelExtentsTime != 0 && m_LabelExtentsTime == this->GetMTime();
   Superclass::Modified();
+  if (extentsValid)
+    this->LabelExtentsModified();
 }
 
 void mitk::LabelSetImage::SetExteriorLabel(mitk::Label *label)
@@ -409,25 +460,32 @@ bool mitk::LabelSetImage::ExistLabelSet(unsigned int layer) const
 
 void mitk::LabelSetImage::MergeLabel(PixelType pixelValue, PixelType sourcePixelValue, unsigned int layer)
 {
-  try
-  {
-    AccessByItk_2(this, MergeLabelProcessing, pixelValue, sourcePixelValue);
-  }
-  catch (itk::ExceptionObject &e)
-  {
-    mitkThrow() << e.GetDescription();
-  }
-  GetLabelSet(layer)->SetActiveLabel(pixelValue);
-  Modified();
+  std::vector<PixelType> sourcePixelValues(1, sourcePixelValue);
+  this->MergeLabels(pixelValue, sourcePixelValues, layer);
 }
 
 void mitk::LabelSetImage::MergeLabels(PixelType pixelValue, std::vector<PixelType>& vectorOfSourcePixelValues, unsigned int layer)
 {
+  const bool extentsAvailable = this->UpdateLabelExtents();
   try
   {
     for (unsigned int idx = 0; idx < vectorOfSourcePixelValues.size(); idx++)
     {
-      AccessByItk_2(this, MergeLabelProcessing, pixelValue, vectorOfSourcePixelValues[idx]);
+      const PixelType sourcePixelValue = vectorOfSourcePixelValues[idx];
+      if (extentsAvailable)
+      {
+        const LabelRegionType boundingBox = this->GetLabelBoundingBox(sourcePixelValue);
+        if (boundingBox.GetNumberOfPixels() > 0 && sourcePixelValue != pixelValue)
+        {
+          const LabelRegionType *box = &boundingBox;
+          AccessByItk_3(this, MergeLabelProcessing, pixelValue, sourcePixelValue, box);
+          this->MergeLabelExtents(pixelValue, sourcePixelValue);
+        }
+      }
+      else
+      {
+        AccessByItk_2(this, MergeLabelProcessing, pixelValue, sourcePixelValue);
+      }
     }
   }
   catch (itk::ExceptionObject &e)
@@ -436,6 +494,9 @@ void mitk::LabelSetImage::MergeLabels(PixelType pixelValue, std::vector<PixelTyp
   }
   GetLabelSet(layer)->SetActiveLabel(pixelValue);
   Modified();
+
+  if (extentsAvailable)
+    this->LabelExtentsModified();
 }
 
 void mitk::LabelSetImage::RemoveLabels(std::vector<PixelType> &VectorOfLabelPixelValues, unsigned int layer)
@@ -457,15 +518,32 @@ void mitk::LabelSetImage::EraseLabels(std::vector<PixelType> &VectorOfLabelPixel
 
 void mitk::LabelSetImage::EraseLabel(PixelType pixelValue, unsigned int layer)
 {
+  const bool extentsAvailable = this->UpdateLabelExtents();
   try
   {
-    AccessByItk_2(this, EraseLabelProcessing, pixelValue, layer);
+    if (extentsAvailable)
+    {
+      const LabelRegionType boundingBox = this->GetLabelBoundingBox(pixelValue);
+      if (boundingBox.GetNumberOfPixels() > 0 && pixelValue != 0)
+      {
+        const LabelRegionType *box = &boundingBox;
+        AccessByItk_3(this, EraseLabelProcessing, pixelValue, layer, box);
+        this->MergeLabelExtents(0, pixelValue);
+      }
+    }
+    else
+    {
+      AccessByItk_2(this, EraseLabelProcessing, pixelValue, layer);
+    }
   }
   catch (itk::ExceptionObject &e)
   {
     mitkThrow() << e.GetDescription();
   }
   Modified();
+
+  if (extentsAvailable)
+    this->LabelExtentsModified();
 }
 
 mitk::Label *mitk::LabelSetImage::GetActiveLabel(unsigned int layer)
@@ -514,6 +592,13 @@ void mitk::LabelSetImage::UpdateCenterOfMass(PixelType pixelValue, unsigned int
   {
     AccessFixedDimensionByItk_2(this, CalculateCenterOfMassProcessing, 4, pixelValue, layer);
   }
+  else if (this->UpdateLabelExtents())
+  {
+    const LabelRegionType boundingBox = this->GetLabelBoundingBox(pixelValue);
+    const LabelRegionType *box = &boundingBox;
+    const std::size_t numberOfVoxels = this->GetNumberOfLabelVoxels(pixelValue);
+    AccessByItk_n(this, CalculateCenterOfMassProcessing, (pixelValue, layer, box, numberOfVoxels));
+  }
   else
   {
     AccessByItk_2(this, CalculateCenterOfMassProcessing, pixelValue, layer);
@@ -534,6 +619,135 @@ unsigned int mitk::LabelSetImage::GetTotalNumberOfLabels() const
   return totalLabels;
 }
 
+mitk::LabelSetImage::LabelRegionType mitk::LabelSetImage::GetLabelBoundingBox(PixelType pixelValue) const
+{
+  LabelRegionType region;
+  if (!this->UpdateLabelExtents())
+    return region;
+
+  auto extent = m_LabelExtents.find(pixelValue);
+  if (extent != m_LabelExtents.end())
+  {
+    region.SetIndex(extent->second.lower);
+    region.SetUpperIndex(extent->second.upper);
+  }
+  return region;
+}
+
+std::size_t mitk::LabelSetImage::GetNumberOfLabelVoxels(PixelType pixelValue) const
+{
+  if (!this->UpdateLabelExtents())
+    return 0;
+
+  auto extent = m_LabelExtents.find(pixelValue);
+  return extent != m_LabelExtents.end() ? extent->second.numberOfVoxels : 0;
+}
+
+bool mitk::LabelSetImage::UpdateLabelExtents() const
+{
+  if (!this->IsInitialized() || this->GetDimension() != 3 || !this->IsVolumeSet())
+    return false;
+
+  const unsigned long time = this->GetMTime();
+  if (m_LabelExtentsTime == time)
+    return true;
+
+  m_LabelExtents.clear();
+
+  const unsigned int dimX = this->GetDimension(0);
+  const unsigned int dimY = this->GetDimension(1);
+  const unsigned int dimZ = this->GetDimension(2);
+
+  // indexed by the label value; a label without voxels has not been seen yet
+  LabelExtent unseen;
+  unseen.numberOfVoxels = 0;
+  std::vector<LabelExtent> extents;
+
+  {
+    ImageReadAccessor accessor(this);
+    const auto *data = static_cast<const PixelType *>(accessor.GetData());
+
+    for (unsigned int z = 0; z < dimZ; ++z)
+    {
+      for (unsigned int y = 0; y < dimY; ++y)
+      {
+        const PixelType *row = data + (static_cast<std::size_t>(z) * dimY + y) * dimX;
+
+        // labels mostly come in runs along a row, each run is accounted for at once
+        unsigned int x = 0;
+        while (x < dimX)
+        {
+          const PixelType value = row[x];
+          unsigned int runEnd = x + 1;
+          while (runEnd < dimX && row[runEnd] == value)
+            ++runEnd;
+
+          if (value >= extents.size())
+            extents.resize(static_cast<std::size_t>(value) + 1, unseen);
+
+          LabelExtent &extent = extents[value];
+          if (extent.numberOfVoxels == 0)
+          {
+            extent.lower[0] = x;
+            extent.lower[1] = y;
+            extent.lower[2] = z;
+            extent.upper[0] = runEnd - 1;
+            extent.upper[1] = y;
+            extent.upper[2] = z;
+          }
+          else
+          {
+            extent.lower[0] = std::min<itk::IndexValueType>(extent.lower[0], x);
+            extent.lower[1] = std::min<itk::IndexValueType>(extent.lower[1], y);
+            extent.upper[0] = std::max<itk::IndexValueType>(extent.upper[0], runEnd - 1);
+            extent.upper[1] = std::max<itk::IndexValueType>(extent.upper[1], y);
+            extent.upper[2] = z;
+          }
+          extent.numberOfVoxels += runEnd - x;
+          x = runEnd;
+        }
+      }
+    }
+  }
+
+  for (std::size_t value = 0; value < extents.size(); ++value)
+  {
+    if (extents[value].numberOfVoxels > 0)
+      m_LabelExtents.emplace_hint(m_LabelExtents.end(), static_cast<PixelType>(value), extents[value]);
+  }
+
+  m_LabelExtentsTime = time;
+  return true;
+}
+
+void mitk::LabelSetImage::LabelExtentsModified() const
+{
+  m_LabelExtentsTime = this->GetMTime();
+}
+
+void mitk::LabelSetImage::MergeLabelExtents(PixelType pixelValue, PixelType index) const
+{
+  auto source = m_LabelExtents.find(index);
+  if (source == m_LabelExtents.end() || pixelValue == index)
+    return;
+
+  auto target = m_LabelExtents.find(pixelValue);
+  if (target == m_LabelExtents.end())
+  {
+    m_LabelExtents[pixelValue] = source->second;
+  }
+  else
+  {
+    for (unsigned int dim = 0; dim < 3; ++dim)
+    {
+      target->second.lower[dim] = std::min(target->second.lower[dim], source->second.lower[dim]);
+      target->second.upper[dim] = std::max(target->second.upper[dim], source->second.upper[dim]);
+    }
+    target->second.numberOfVoxels += source->second.numberOfVoxels;
+  }
+  m_LabelExtents.erase(index);
+}
+
 void mitk::LabelSetImage::MaskStamp(mitk::Image *mask, bool forceOverwrite)
 {
   try
@@ -588,7 +802,15 @@ mitk::Image::Pointer mitk::LabelSetImage::CreateLabelMask(PixelType index, bool
     }
     else if (3 == this->GetDimension())
     {
-      ::CreateLabelMaskProcessing(this, mask, index);
+      if (this->UpdateLabelExtents())
+      {
+        const LabelRegionType boundingBox = this->GetLabelBoundingBox(index);
+        ::CreateLabelMaskProcessing(this, mask, index, &boundingBox);
+      }
+      else
+      {
+        ::CreateLabelMaskProcessing(this, mask, index);
+      }
     }
     else
     {
@@ -734,23 +956,44 @@ void mitk::LabelSetImage::MaskStampProcessing(ImageType *itkImage, mitk::Image *
 }
 
 template <typename ImageType>
-void mitk::LabelSetImage::CalculateCenterOfMassProcessing(ImageType *itkImage, PixelType pixelValue, unsigned int layer)
+void mitk::LabelSetImage::CalculateCenterOfMassProcessing(ImageType *itkImage,
+                                                          PixelType pixelValue,
+                                                          unsigned int layer,
+                                                          const LabelRegionType *boundingBox,
+                                                          std::size_t numberOfVoxels)
 {
   // for now, we just retrieve the voxel in the middle
   typedef itk::ImageRegionConstIterator<ImageType> IteratorType;
-  IteratorType iter(itkImage, itkImage->GetLargestPossibleRegion());
+  IteratorType iter(itkImage, GetLabelProcessingRegion(itkImage, boundingBox));
   iter.GoToBegin();
 
   std::vector<typename ImageType::IndexType> indexVector;
 
-  while (!iter.IsAtEnd())
+  if (boundingBox != nullptr)
   {
-    // TODO fix comparison warning more effective
-    if (iter.Get() == pixelValue)
+    // the number of voxels is known, so the voxel in the middle can be picked without collecting all of them
+    std::size_t remaining = numberOfVoxels / 2;
+    while (numberOfVoxels > 0 && !iter.IsAtEnd())
     {
-      indexVector.push_back(iter.GetIndex());
+      if (iter.Get() == pixelValue && remaining-- == 0)
+      {
+        indexVector.push_back(iter.GetIndex());
+        break;
+      }
+      ++iter;
+    }
+  }
+  else
+  {
+    while (!iter.IsAtEnd())
+    {
+      // TODO fix comparison warning more effective
+      if (iter.Get() == pixelValue)
+      {
+        indexVector.push_back(iter.GetIndex());
+      }
+      ++iter;
     }
-    ++iter;
   }
 
   mitk::Point3D pos;
@@ -759,7 +1002,7 @@ void mitk::LabelSetImage::CalculateCenterOfMassProcessing(ImageType *itkImage, P
   if (!indexVector.empty())
   {
     typename itk::ImageRegionConstIteratorWithIndex<ImageType>::IndexType centerIndex;
-    centerIndex = indexVector.at(indexVector.size() / 2);
+    centerIndex = boundingBox != nullptr ? indexVector.front() : indexVector.at(indexVector.size() / 2);
     if (centerIndex.GetIndexDimension() == 3)
     {
       pos[0] = centerIndex[0];
@@ -863,11 +1106,14 @@ void mitk::LabelSetImage::ImageToLayerContainerProcessing(itk::Image<TPixel, VIm
 }
 
 template <typename ImageType>
-void mitk::LabelSetImage::EraseLabelProcessing(ImageType *itkImage, PixelType pixelValue, unsigned int /*layer*/)
+void mitk::LabelSetImage::EraseLabelProcessing(ImageType *itkImage,
+                                               PixelType pixelValue,
+                                               unsigned int /*layer*/,
+                                               const LabelRegionType *boundingBox)
 {
   typedef itk::ImageRegionIterator<ImageType> IteratorType;
 
-  IteratorType iter(itkImage, itkImage->GetLargestPossibleRegion());
+  IteratorType iter(itkImage, GetLabelProcessingRegion(itkImage, boundingBox));
   iter.GoToBegin();
 
   while (!iter.IsAtEnd())
@@ -883,11 +1129,14 @@ void mitk::LabelSetImage::EraseLabelProcessing(ImageType *itkImage, PixelType pi
 }
 
 template <typename ImageType>
-void mitk::LabelSetImage::MergeLabelProcessing(ImageType *itkImage, PixelType pixelValue, PixelType index)
+void mitk::LabelSetImage::MergeLabelProcessing(ImageType *itkImage,
+                                               PixelType pixelValue,
+                                               PixelType index,
+                                               const LabelRegionType *boundingBox)
 {
   typedef itk::ImageRegionIterator<ImageType> IteratorType;
 
-  IteratorType iter(itkImage, itkImage->GetLargestPossibleRegion());
+  IteratorType iter(itkImage, GetLabelProcessingRegion(itkImage, boundingBox));
   iter.GoToBegin();
 
   while (!iter.IsAtEnd())
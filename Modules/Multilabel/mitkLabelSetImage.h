@@ -22,6 +22,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <MitkMultilabelExports.h>
 
+#include <itkImageRegion.h>
+
+#include <map>
+
 namespace mitk
 {
   //##Documentation
@@ -177,6 +181,24 @@ namespace mitk
      */
     unsigned int GetTotalNumberOfLabels() const;
 
+    typedef itk::ImageRegion<3> LabelRegionType;
+
+    /**
+     * @brief Returns the bounding box of all voxels of the active layer that carry the given label value.
+     *        The boxes and voxel counts of all labels are computed in one pass over the image and are kept until
+     *        the image is modified. Operations of this class that only change single labels update them instead.
+     *        Only three-dimensional images are supported.
+     * @param pixelValue the label value
+     * @return the box in index coordinates, or an empty region if no voxel carries the label
+     */
+    LabelRegionType GetLabelBoundingBox(PixelType pixelValue) const;
+
+    /**
+     * @brief Returns the number of voxels of the active layer that carry the given label value.
+     *        See GetLabelBoundingBox() for the caching; 0 is returned for images that are not three-dimensional.
+     */
+    std::size_t GetNumberOfLabelVoxels(PixelType pixelValue) const;
+
     // This function will need to be ported to an external class
     // it requires knowledge of pixeltype and dimension and includes
     // too much algorithm to be sensibly part of a data class
@@ -283,19 +305,33 @@ namespace mitk
     void ImageToLayerContainerProcessing(itk::Image<TPixel, VImageDimension> *source, unsigned int layer) const;
 
     template <typename ImageType>
-    void CalculateCenterOfMassProcessing(ImageType *input, PixelType index, unsigned int layer);
+    void CalculateCenterOfMassProcessing(ImageType *input,
+                                         PixelType index,
+                                         unsigned int layer,
+                                         const LabelRegionType *boundingBox = nullptr,
+                                         std::size_t numberOfVoxels = 0);
 
     template <typename ImageType>
     void ClearBufferProcessing(ImageType *input);
 
     template <typename ImageType>
-    void EraseLabelProcessing(ImageType *input, PixelType index, unsigned int layer);
+    void EraseLabelProcessing(ImageType *input,
+                              PixelType index,
+                              unsigned int layer,
+                              const LabelRegionType *boundingBox = nullptr);
 
     //  template < typename ImageType >
     //  void ReorderLabelProcessing( ImageType* input, int index, int layer);
 
     template <typename ImageType>
-    void MergeLabelProcessing(ImageType *input, PixelType pixelValue, PixelType index);
+    void MergeLabelProcessing(ImageType *input,
+                              PixelType pixelValue,
+                              PixelType index,
+                              const LabelRegionType *boundingBox = nullptr);
+
+    /** \brief Moves the bounding box and voxel count of label index to label pixelValue after the voxels were
+      relabeled.*/
+    void MergeLabelExtents(PixelType pixelValue, PixelType index) const;
 
     template <typename ImageType>
     void ConcatenateProcessing(ImageType *input, mitk::LabelSetImage *other);
@@ -306,6 +342,21 @@ namespace mitk
     template <typename LabelSetImageType, typename ImageType>
     void InitializeByLabeledImageProcessing(LabelSetImageType *input, ImageType *other);
 
+    struct LabelExtent
+    {
+      itk::Index<3> lower;
+      itk::Index<3> upper;
+      std::size_t numberOfVoxels;
+    };
+
+    /** \brief Recomputes m_LabelExtents if the image was modified since they were computed.
+      \return false if the extents are not available because the image is not three-dimensional.*/
+    bool UpdateLabelExtents() const;
+
+    /** \brief Marks m_LabelExtents as matching the current state of the image after they were
+      adapted to a change of the image data made by this class.*/
+    void LabelExtentsModified() const;
+
     std::vector<LabelSet::Pointer> m_LabelSetContainer;
     std::vector<Image::Pointer> m_LayerContainer;
 
@@ -314,6 +365,10 @@ namespace mitk
     bool m_activeLayerInvalid;
 
     mitk::Label::Pointer m_ExteriorLabel;
+
+    // bounding boxes and voxel counts of the labels of the active layer, valid for m_LabelExtentsTime
+    mutable std::map<PixelType, LabelExtent> m_LabelExtents;
+    mutable unsigned long m_LabelExtentsTime;
   };
 
   /**
@@ -31,15 +31,163 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkSmoothingRecursiveGaussianImageFilter.h>
 
 // vtk
+#include <vtkAppendPolyData.h>
+#include <vtkCellArray.h>
 #include <vtkCleanPolyData.h>
+#include <vtkDecimatePro.h>
 #include <vtkImageChangeInformation.h>
 #include <vtkImageData.h>
 #include <vtkLinearTransform.h>
 #include <vtkMarchingCubes.h>
+#include <vtkMarchingCubesTriangleCases.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataNormals.h>
 #include <vtkSmartPointer.h>
+#include <vtkWindowedSincPolyDataFilter.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+  /** Thinner slabs are not worth a thread of their own. */
+  const int MinimumNumberOfSlicesPerSlab = 8;
+
+  /** Smoothing of the label surfaces generated with GenerateAllLabels() set. */
+  const int NumberOfSmoothingIterations = 15;
+  const double SmoothingPassBand = 0.1;
+
+  /** Index offsets of the eight cube vertices in the order used by vtkMarchingCubesTriangleCases. */
+  const int CubeVertices[8][3] = {
+    {0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}};
+
+  /** Vertices of the twelve cube edges in the order used by vtkMarchingCubesTriangleCases. */
+  const int CubeEdges[12][2] = {
+    {0, 1}, {1, 2}, {3, 2}, {0, 3}, {4, 5}, {5, 6}, {7, 6}, {4, 7}, {0, 4}, {1, 5}, {3, 7}, {2, 6}};
+
+  /** Triangles of a single label extracted from one slab, in index coordinates. */
+  struct LabelMesh
+  {
+    LabelMesh() : points(vtkSmartPointer<vtkPoints>::New()), polys(vtkSmartPointer<vtkCellArray>::New()) {}
+
+    vtkSmartPointer<vtkPoints> points;
+    vtkSmartPointer<vtkCellArray> polys;
+
+    /** Point ids of the cube edges already crossed by the surface, so neighbouring cubes share them. */
+    std::unordered_map<long long, vtkIdType> edgePoints;
+  };
+
+  /** Generates the discrete marching cubes triangles of all labels but the background within the
+   *  cube slices [firstSlice, lastSlice). Cube slice z spans the voxel slices z and z + 1. The cubes
+   *  cover the image padded by one background voxel on each side, so that labels touching the image
+   *  border get closed surfaces as well. Cubes whose corners all carry the same label are skipped,
+   *  the others only consider the (at most eight) labels present at their corners. */
+  template <typename TPixel>
+  void ExtractLabelMeshes(const TPixel *buffer,
+                          const int size[3],
+                          TPixel background,
+                          int firstSlice,
+                          int lastSlice,
+                          std::map<TPixel, LabelMesh> &meshes)
+  {
+    const vtkMarchingCubesTriangleCases *cases = vtkMarchingCubesTriangleCases::GetCases();
+
+    const long long sliceSize = static_cast<long long>(size[0]) * size[1];
+    long long vertexOffsets[8];
+    for (int v = 0; v < 8; ++v)
+    {
+      vertexOffsets[v] = CubeVertices[v][2] * sliceSize + CubeVertices[v][1] * size[0] + CubeVertices[v][0];
+    }
+
+    TPixel corners[8];
+    for (int z = firstSlice; z < lastSlice; ++z)
+    {
+      for (int y = -1; y < size[1]; ++y)
+      {
+        const bool interiorRow = z >= 0 && z + 1 < size[2] && y >= 0 && y + 1 < size[1];
+        for (int x = -1; x < size[0]; ++x)
+        {
+          if (interiorRow && x >= 0 && x + 1 < size[0])
+          {
+            const TPixel *cube = buffer + z * sliceSize + static_cast<long long>(y) * size[0] + x;
+            for (int v = 0; v < 8; ++v)
+              corners[v] = cube[vertexOffsets[v]];
+          }
+          else
+          {
+            for (int v = 0; v < 8; ++v)
+            {
+              const int vx = x + CubeVertices[v][0];
+              const int vy = y + CubeVertices[v][1];
+              const int vz = z + CubeVertices[v][2];
+              corners[v] = (vx < 0 || vy < 0 || vz < 0 || vx >= size[0] || vy >= size[1] || vz >= size[2]) ?
+                             background :
+                             buffer[vz * sliceSize + static_cast<long long>(vy) * size[0] + vx];
+            }
+          }
+
+          if (std::all_of(corners + 1, corners + 8, [&corners](TPixel value) { return value == corners[0]; }))
+            continue;
+
+          for (int v = 0; v < 8; ++v)
+          {
+            const TPixel label = corners[v];
+            if (label == background || std::find(corners, corners + v, label) != corners + v)
+              continue;
+
+            int caseIndex = 0;
+            for (int c = v; c < 8; ++c)
+            {
+              if (corners[c] == label)
+                caseIndex |= 1 << c;
+            }
+
+            LabelMesh &mesh = meshes[label];
+            for (const int *edge = cases[caseIndex].edges; edge[0] > -1; edge += 3)
+            {
+              vtkIdType pointIds[3];
+              for (int e = 0; e < 3; ++e)
+              {
+                const int *a = CubeVertices[CubeEdges[edge[e]][0]];
+                const int *b = CubeVertices[CubeEdges[edge[e]][1]];
+                const int axis = a[0] != b[0] ? 0 : (a[1] != b[1] ? 1 : 2);
+
+                // Key the edge by its lower vertex within the padded image and its direction
+                const long long lowerX = x + std::min(a[0], b[0]) + 1;
+                const long long lowerY = y + std::min(a[1], b[1]) + 1;
+                const long long lowerZ = z + std::min(a[2], b[2]) + 1;
+                const long long key = ((lowerZ * (size[1] + 2) + lowerY) * (size[0] + 2) + lowerX) * 3 + axis;
+
+                auto edgePoint = mesh.edgePoints.find(key);
+                if (edgePoint == mesh.edgePoints.end())
+                {
+                  // Discrete surfaces pass through the middle of the edge
+                  const vtkIdType pointId = mesh.points->InsertNextPoint(
+                    x + 0.5 * (a[0] + b[0]), y + 0.5 * (a[1] + b[1]), z + 0.5 * (a[2] + b[2]));
+                  edgePoint = mesh.edgePoints.emplace(key, pointId).first;
+                }
+                pointIds[e] = edgePoint->second;
+              }
+              mesh.polys->InsertNextCell(3, pointIds);
+            }
+          }
+        }
+      }
+    }
+  }
+}
 
 mitk::LabelSetImageToSurfaceFilter::LabelSetImageToSurfaceFilter()
-  : m_GenerateAllLabels(false), m_RequestedLabel(1), m_BackgroundLabel(0), m_UseSmoothing(0), m_Sigma(0.1)
+  : m_GenerateAllLabels(false),
+    m_RequestedLabel(1),
+    m_BackgroundLabel(0),
+    m_UseSmoothing(0),
+    m_Sigma(0.1),
+    m_TargetReduction(0.0)
 {
 }
 
@@ -83,7 +231,186 @@ void mitk::LabelSetImageToSurfaceFilter::GenerateData()
   if (!outputSurface)
     return;
 
-  AccessFixedDimensionByItk_1(inputImage, InternalProcessing, 3, outputSurface);
+  if (m_GenerateAllLabels)
+  {
+    AccessFixedDimensionByItk(inputImage, MultiLabelProcessing, 3);
+  }
+  else
+  {
+    m_AvailableLabels.clear();
+    m_IndexToLabels.clear();
+    this->SetNumberOfIndexedOutputs(1);
+
+    AccessFixedDimensionByItk_1(inputImage, InternalProcessing, 3, outputSurface);
+
+    m_AvailableLabels[m_RequestedLabel] = 0;
+    m_IndexToLabels[0] = m_RequestedLabel;
+  }
+}
+
+template <typename TPixel, unsigned int VDimension>
+void mitk::LabelSetImageToSurfaceFilter::MultiLabelProcessing(const itk::Image<TPixel, VDimension> *input)
+{
+  typedef std::map<TPixel, LabelMesh> LabelMeshMapType;
+
+  const typename itk::Image<TPixel, VDimension>::SizeType &imageSize = input->GetBufferedRegion().GetSize();
+  const int size[3] = {static_cast<int>(imageSize[0]), static_cast<int>(imageSize[1]), static_cast<int>(imageSize[2])};
+  const TPixel *buffer = input->GetBufferPointer();
+  const TPixel background = static_cast<TPixel>(m_BackgroundLabel);
+
+  // The cube slices -1 ... size[2] - 1 are split into slabs, each one extracted by a thread of its own
+  const int numberOfThreads = std::max(1, static_cast<int>(this->GetNumberOfThreads()));
+  const int numberOfCubeSlices = size[2] + 1;
+  const int numberOfSlabs =
+    std::max(1, std::min(numberOfThreads, numberOfCubeSlices / MinimumNumberOfSlicesPerSlab));
+
+  std::vector<LabelMeshMapType> slabMeshes(numberOfSlabs);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < numberOfSlabs; ++i)
+  {
+    const int firstSlice = numberOfCubeSlices * i / numberOfSlabs - 1;
+    const int lastSlice = numberOfCubeSlices * (i + 1) / numberOfSlabs - 1;
+    threads.emplace_back([&, i, firstSlice, lastSlice]() {
+      ExtractLabelMeshes(buffer, size, background, firstSlice, lastSlice, slabMeshes[i]);
+    });
+  }
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+  threads.clear();
+
+  std::vector<TPixel> labels;
+  for (const auto &meshes : slabMeshes)
+  {
+    for (const auto &labelMesh : meshes)
+    {
+      labels.push_back(labelMesh.first);
+    }
+  }
+  std::sort(labels.begin(), labels.end());
+  labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+
+  if (labels.empty())
+    throw itk::ExceptionObject(__FILE__, __LINE__, "no label surface could be extracted.");
+
+  m_AvailableLabels.clear();
+  m_IndexToLabels.clear();
+  for (std::size_t index = 0; index < labels.size(); ++index)
+  {
+    m_AvailableLabels[static_cast<LabelType>(labels[index])] = index;
+    m_IndexToLabels[index] = static_cast<LabelType>(labels[index]);
+  }
+
+  vtkSmartPointer<vtkMatrix4x4> vtkmatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  this->GetInput()->GetGeometry()->GetVtkTransform()->GetMatrix(vtkmatrix);
+  double(*matrix)[4] = vtkmatrix->Element;
+
+  // Merge, transform, smooth and decimate the label surfaces concurrently
+  std::vector<vtkSmartPointer<vtkPolyData>> surfaces(labels.size());
+  std::atomic<std::size_t> nextLabel(0);
+  auto processLabels = [&]() {
+    for (std::size_t index = nextLabel++; index < labels.size(); index = nextLabel++)
+    {
+      const TPixel label = labels[index];
+
+      std::vector<vtkSmartPointer<vtkPolyData>> pieces;
+      for (auto &meshes : slabMeshes)
+      {
+        auto labelMesh = meshes.find(label);
+        if (labelMesh == meshes.end())
+          continue;
+
+        auto piece = vtkSmartPointer<vtkPolyData>::New();
+        piece->SetPoints(labelMesh->second.points);
+        piece->SetPolys(labelMesh->second.polys);
+        pieces.push_back(piece);
+      }
+
+      vtkSmartPointer<vtkPolyData> polydata = pieces.front();
+      if (pieces.size() > 1)
+      {
+        auto appendFilter = vtkSmartPointer<vtkAppendPolyData>::New();
+        for (const auto &piece : pieces)
+        {
+          appendFilter->AddInputData(piece);
+        }
+
+        // The slabs share the edges of their boundary slices
+        auto seamMergeFilter = vtkSmartPointer<vtkCleanPolyData>::New();
+        seamMergeFilter->SetInputConnection(appendFilter->GetOutputPort());
+        seamMergeFilter->PieceInvariantOff();
+        seamMergeFilter->ConvertLinesToPointsOff();
+        seamMergeFilter->ConvertPolysToLinesOff();
+        seamMergeFilter->ConvertStripsToPolysOff();
+        seamMergeFilter->PointMergingOn();
+        seamMergeFilter->Update();
+        polydata = seamMergeFilter->GetOutput();
+      }
+
+      vtkPoints *points = polydata->GetPoints();
+      const vtkIdType n = points->GetNumberOfPoints();
+      double point[3];
+      for (vtkIdType i = 0; i < n; ++i)
+      {
+        points->GetPoint(i, point);
+        mitkVtkLinearTransformPoint(matrix, point, point);
+        points->SetPoint(i, point);
+      }
+
+      if (m_UseSmoothing)
+      {
+        auto smoother = vtkSmartPointer<vtkWindowedSincPolyDataFilter>::New();
+        smoother->SetInputData(polydata);
+        smoother->SetNumberOfIterations(NumberOfSmoothingIterations);
+        smoother->SetPassBand(SmoothingPassBand);
+        smoother->BoundarySmoothingOff();
+        smoother->FeatureEdgeSmoothingOff();
+        smoother->NonManifoldSmoothingOn();
+        smoother->NormalizeCoordinatesOn();
+        smoother->Update();
+        polydata = smoother->GetOutput();
+      }
+
+      if (m_TargetReduction > 0.0)
+      {
+        auto decimate = vtkSmartPointer<vtkDecimatePro>::New();
+        decimate->SetInputData(polydata);
+        decimate->SetTargetReduction(m_TargetReduction);
+        decimate->PreserveTopologyOn();
+        decimate->Update();
+        polydata = decimate->GetOutput();
+      }
+
+      auto normalsFilter = vtkSmartPointer<vtkPolyDataNormals>::New();
+      normalsFilter->SetInputData(polydata);
+      normalsFilter->SplittingOff();
+      normalsFilter->ConsistencyOn();
+      normalsFilter->Update();
+
+      surfaces[index] = normalsFilter->GetOutput();
+    }
+  };
+
+  for (int i = 1; i < std::min(numberOfThreads, static_cast<int>(labels.size())); ++i)
+  {
+    threads.emplace_back(processLabels);
+  }
+  processLabels();
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+
+  this->SetNumberOfIndexedOutputs(surfaces.size());
+  for (unsigned int i = 0; i < surfaces.size(); ++i)
+  {
+    if (this->GetOutput(i) == nullptr)
+    {
+      this->SetNthOutput(i, this->MakeOutput(i));
+    }
+    this->GetOutput(i)->SetVtkPolyData(surfaces[i], 0);
+  }
 }
 
 template <typename TPixel, unsigned int VDimension>
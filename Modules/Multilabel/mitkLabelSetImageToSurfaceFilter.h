@@ -34,6 +34,10 @@ namespace mitk
    * Generates surface meshes from a labelset image.
    * If you want to calculate a surface representation for all available labels,
    * you may call GenerateAllLabelsOn().
+   *
+   * In that case the surfaces of all labels are extracted in a single, block-parallel sweep
+   * over the image and the filter provides one output per label (see GetIndexToLabels()).
+   * Smoothing and decimation of the label surfaces run concurrently afterwards.
    */
   class MITKMULTILABEL_EXPORT LabelSetImageToSurfaceFilter : public SurfaceSource
   {
@@ -109,6 +113,18 @@ namespace mitk
      */
     itkSetMacro(Sigma, float);
 
+    /**
+     * Sets the fraction of triangles removed from each label surface when GenerateAllLabels()
+     * is set. 0 (default) disables the decimation.
+     */
+    itkSetClampMacro(TargetReduction, float, 0.0f, 1.0f);
+    itkGetMacro(TargetReduction, float);
+
+    /**
+     * Returns the label of each output generated with GenerateAllLabels() set.
+     */
+    itkGetConstReferenceMacro(IndexToLabels, IndexToLabelMapType);
+
   protected:
     LabelSetImageToSurfaceFilter();
 
@@ -133,6 +149,13 @@ namespace mitk
     template <typename TPixel, unsigned int VImageDimension>
     void InternalProcessing(const itk::Image<TPixel, VImageDimension> *input, mitk::Surface *surface);
 
+    /**
+    * Extracts the surfaces of all labels but the background in one sweep and assigns them to the
+    * indexed outputs.
+    */
+    template <typename TPixel, unsigned int VImageDimension>
+    void MultiLabelProcessing(const itk::Image<TPixel, VImageDimension> *input);
+
     bool m_GenerateAllLabels;
 
     int m_RequestedLabel;
@@ -143,6 +166,8 @@ namespace mitk
 
     float m_Sigma;
 
+    float m_TargetReduction;
+
     LabelMapType m_AvailableLabels;
 
     IndexToLabelMapType m_IndexToLabels;
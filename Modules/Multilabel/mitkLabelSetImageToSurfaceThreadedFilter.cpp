@@ -21,7 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 namespace mitk
 {
-  LabelSetImageToSurfaceThreadedFilter::LabelSetImageToSurfaceThreadedFilter() : m_RequestedLabel(1), m_Result(nullptr)
+  LabelSetImageToSurfaceThreadedFilter::LabelSetImageToSurfaceThreadedFilter() : m_RequestedLabel(1)
   {
   }
 
@@ -65,19 +65,33 @@ namespace mitk
       MITK_WARN << "\"Smooth\" parameter was not set: will use the default value (" << useSmoothing << ").";
     }
 
+    bool generateAllLabels(false);
     try
     {
-      this->GetParameter("RequestedLabel", m_RequestedLabel);
+      this->GetParameter("GenerateAllLabels", generateAllLabels);
     }
     catch (std::invalid_argument &)
     {
-      MITK_WARN << "\"RequestedLabel\" parameter was not set: will use the default value (" << m_RequestedLabel << ").";
+      // optional parameter, only the requested label is extracted by default
+    }
+
+    if (!generateAllLabels)
+    {
+      try
+      {
+        this->GetParameter("RequestedLabel", m_RequestedLabel);
+      }
+      catch (std::invalid_argument &)
+      {
+        MITK_WARN << "\"RequestedLabel\" parameter was not set: will use the default value (" << m_RequestedLabel
+                  << ").";
+      }
     }
 
     mitk::LabelSetImageToSurfaceFilter::Pointer filter = mitk::LabelSetImageToSurfaceFilter::New();
     filter->SetInput(image);
     //  filter->SetObserver(obsv);
-    filter->SetGenerateAllLabels(false);
+    filter->SetGenerateAllLabels(generateAllLabels);
     filter->SetRequestedLabel(m_RequestedLabel);
     filter->SetUseSmoothing(useSmoothing);
 
@@ -101,14 +115,19 @@ namespace mitk
       return false;
     }
 
-    m_Result = filter->GetOutput();
+    m_Results.clear();
+    for (const auto &indexToLabel : filter->GetIndexToLabels())
+    {
+      Surface::Pointer result = filter->GetOutput(indexToLabel.first);
 
-    if (m_Result.IsNull() || !m_Result->GetVtkPolyData())
-      return false;
+      if (result.IsNull() || !result->GetVtkPolyData())
+        return false;
 
-    m_Result->DisconnectPipeline();
+      result->DisconnectPipeline();
+      m_Results[indexToLabel.second] = result;
+    }
 
-    return true;
+    return !m_Results.empty();
   }
 
   void LabelSetImageToSurfaceThreadedFilter::ThreadedUpdateSuccessful()
@@ -116,17 +135,24 @@ namespace mitk
     LabelSetImage::Pointer image;
     this->GetPointerParameter("Input", image);
 
-    std::string name = this->GetGroupNode()->GetName();
-    name.append("-surf");
+    for (const auto &result : m_Results)
+    {
+      mitk::Label *label = image->GetLabel(result.first, image->GetActiveLayer());
+
+      std::string name = this->GetGroupNode()->GetName();
+      if (m_Results.size() > 1 && label)
+        name.append("-").append(label->GetName());
+      name.append("-surf");
 
-    mitk::DataNode::Pointer node = mitk::DataNode::New();
-    node->SetData(m_Result);
-    node->SetName(name);
+      mitk::DataNode::Pointer node = mitk::DataNode::New();
+      node->SetData(result.second);
+      node->SetName(name);
 
-    mitk::Color color = image->GetLabel(m_RequestedLabel, image->GetActiveLayer())->GetColor();
-    node->SetColor(color);
+      if (label)
+        node->SetColor(label->GetColor());
 
-    this->InsertBelowGroupNode(node);
+      this->InsertBelowGroupNode(node);
+    }
 
     Superclass::ThreadedUpdateSuccessful();
   }
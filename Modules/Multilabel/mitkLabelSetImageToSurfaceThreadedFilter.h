@@ -17,12 +17,20 @@ See LICENSE.txt or http://www.mitk.org for details.
 #ifndef __mitkLabelSetImageToSurfaceThreadedFilter_H_
 #define __mitkLabelSetImageToSurfaceThreadedFilter_H_
 
+#include "mitkLabelSetImage.h"
 #include "mitkSegmentationSink.h"
 #include "mitkSurface.h"
 #include <MitkMultilabelExports.h>
 
+#include <map>
+
 namespace mitk
 {
+  /**
+   * Creates the surface of the label given by the "RequestedLabel" parameter in the background.
+   * If the "GenerateAllLabels" parameter is set, the surfaces of all labels are extracted in a
+   * single sweep instead and inserted as one node per label.
+   */
   class MITKMULTILABEL_EXPORT LabelSetImageToSurfaceThreadedFilter : public SegmentationSink
   {
   public:
@@ -42,7 +50,7 @@ namespace mitk
 
   private:
     int m_RequestedLabel;
-    Surface::Pointer m_Result;
+    std::map<LabelSetImage::PixelType, Surface::Pointer> m_Results;
   };
 
 } // namespace
@@ -36,6 +36,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vtkMitkLevelWindowFilter.h"
 #include "vtkMitkThickSlicesFilter.h"
 #include "vtkNeverTranslucentTexture.h"
+#include "vtkMitkLabelSetGPUMapper.h"
 
 // VTK
 #include <vtkCamera.h>
@@ -105,6 +106,8 @@ void mitk::LabelSetImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer
     localStorage->m_LevelWindowFilterVector.clear();
     localStorage->m_LayerMapperVector.clear();
     localStorage->m_LayerActorVector.clear();
+    localStorage->m_GPULayerVolumes.assign(numberOfLayers, nullptr);
+    localStorage->m_GPULayerMTimes.assign(numberOfLayers, 0);
 
     localStorage->m_Actors = vtkSmartPointer<vtkPropAssembly>::New();
 
@@ -128,6 +131,7 @@ void mitk::LabelSetImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer
 
     localStorage->m_Actors->AddPart(localStorage->m_OutlineShadowActor);
     localStorage->m_Actors->AddPart(localStorage->m_OutlineActor);
+    localStorage->m_Actors->AddPart(localStorage->m_GPUActor);
   }
 
   // early out if there is no intersection of the current rendering geometry
@@ -144,9 +148,18 @@ void mitk::LabelSetImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer
       localStorage->m_OutlineActor->SetVisibility(false);
       localStorage->m_OutlineShadowActor->SetVisibility(false);
     }
+    localStorage->m_GPUActor->SetVisibility(false);
     return;
   }
 
+  if (this->UseGPURendering(renderer))
+  {
+    this->GenerateGPUDataForRenderer(renderer);
+    return;
+  }
+  // the GPU rendering mode might have been switched off
+  localStorage->m_GPUActor->SetVisibility(false);
+
   for (int lidx = 0; lidx < numberOfLayers; ++lidx)
   {
     mitk::Image *layerImage = nullptr;
@@ -248,6 +261,7 @@ void mitk::LabelSetImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer
     // set the texture for the actor
     localStorage->m_LayerActorVector[lidx]->SetTexture(localStorage->m_LayerTextureVector[lidx]);
     localStorage->m_LayerActorVector[lidx]->GetProperty()->SetOpacity(opacity);
+    localStorage->m_LayerActorVector[lidx]->SetVisibility(true);
   }
 
   mitk::Label* activeLabel = image->GetActiveLabel(activeLayer);
@@ -282,6 +296,125 @@ void mitk::LabelSetImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer
   localStorage->m_OutlineShadowActor->SetVisibility(false);
 }
 
+bool mitk::LabelSetImageVtkMapper2D::UseGPURendering(mitk::BaseRenderer *renderer)
+{
+  bool gpuRendering = false;
+  mitk::DataNode *node = this->GetDataNode();
+  node->GetBoolProperty("labelset.gpu rendering", gpuRendering, renderer);
+  if (!gpuRendering)
+    return false;
+
+  // curved geometries are resliced with a non-linear transform, which the shader does not know
+  const PlaneGeometry *worldGeometry = renderer->GetCurrentWorldPlaneGeometry();
+  if (dynamic_cast<const AbstractTransformGeometry *>(worldGeometry) != nullptr)
+    return false;
+
+  LocalStorage *localStorage = m_LSH.GetLocalStorage(renderer);
+  return localStorage->m_NumberOfLayers <= vtkMitkLabelSetGPUMapper::MaximumNumberOfLayers &&
+         !localStorage->m_GPUMapper->GetUploadFailed();
+}
+
+void mitk::LabelSetImageVtkMapper2D::GenerateGPUDataForRenderer(mitk::BaseRenderer *renderer)
+{
+  LocalStorage *localStorage = m_LSH.GetLocalStorage(renderer);
+  mitk::DataNode *node = this->GetDataNode();
+  auto *image = dynamic_cast<mitk::LabelSetImage *>(node->GetData());
+  const PlaneGeometry *worldGeometry = renderer->GetCurrentWorldPlaneGeometry();
+
+  int numberOfLayers = image->GetNumberOfLayers();
+  int activeLayer = image->GetActiveLayer();
+  BaseGeometry::Pointer imageGeometry = image->GetTimeGeometry()->GetGeometryForTimeStep(this->GetTimestep());
+
+  // the reslicer of the first layer only computes the reslice axes, the spacing and the extent of the slice
+  mitk::ExtractSliceFilter *reslicer = localStorage->m_ReslicerVector[0];
+  reslicer->SetInput(image);
+  reslicer->SetWorldGeometry(worldGeometry);
+  reslicer->SetTimeStep(this->GetTimestep());
+  reslicer->SetResliceTransformByGeometry(imageGeometry);
+  bool inPlaneResampleExtentByGeometry = false;
+  node->GetBoolProperty("in plane resample extent by geometry", inPlaneResampleExtentByGeometry, renderer);
+  reslicer->SetInPlaneResampleExtentByGeometry(inPlaneResampleExtentByGeometry);
+  reslicer->SetOutputDimensionality(2);
+  reslicer->SetOutputSpacingZDirection(1.0);
+  reslicer->SetOutputExtentZDirection(0, 0);
+  reslicer->SetResliceGeometryOnly(true);
+  reslicer->Modified();
+  reslicer->Update();
+  reslicer->SetResliceGeometryOnly(false);
+
+  double sliceBounds[6];
+  for (auto &sliceBound : sliceBounds)
+  {
+    sliceBound = 0.0;
+  }
+  reslicer->GetClippedPlaneBounds(sliceBounds);
+  this->GeneratePlane(renderer, sliceBounds);
+  localStorage->m_mmPerPixel = reslicer->GetOutputSpacing();
+
+  // there is no resliced image the 3D view could show
+  for (int lidx = 0; lidx < numberOfLayers; ++lidx)
+  {
+    localStorage->m_ReslicedImageVector[lidx] = nullptr;
+    localStorage->m_LayerActorVector[lidx]->SetVisibility(false);
+  }
+  localStorage->m_OutlineActor->SetVisibility(false);
+  localStorage->m_OutlineShadowActor->SetVisibility(false);
+
+  // model coordinates of the plane -> slice (see TransformActor) -> world (reslice axes) -> voxel index.
+  // The z coordinate of the plane is the layer depth and must not move the sampling position.
+  auto modelToSlice = vtkSmartPointer<vtkMatrix4x4>::New();
+  modelToSlice->SetElement(0, 3, -0.5 * localStorage->m_mmPerPixel[0]);
+  modelToSlice->SetElement(1, 3, -0.5 * localStorage->m_mmPerPixel[1]);
+  modelToSlice->SetElement(2, 2, 0.0);
+  auto modelToWorld = vtkSmartPointer<vtkMatrix4x4>::New();
+  vtkMatrix4x4::Multiply4x4(reslicer->GetResliceAxes(), modelToSlice, modelToWorld);
+  auto worldToIndex = vtkSmartPointer<vtkMatrix4x4>::New();
+  vtkMatrix4x4::Invert(imageGeometry->GetVtkTransform()->GetMatrix(), worldToIndex);
+  auto modelToIndex = vtkSmartPointer<vtkMatrix4x4>::New();
+  vtkMatrix4x4::Multiply4x4(worldToIndex, modelToWorld, modelToIndex);
+
+  vtkMitkLabelSetGPUMapper *gpuMapper = localStorage->m_GPUMapper;
+  gpuMapper->SetNumberOfLayers(numberOfLayers);
+  gpuMapper->SetModelToIndexMatrix(modelToIndex);
+  gpuMapper->SetSliceSpacing(localStorage->m_mmPerPixel[0], localStorage->m_mmPerPixel[1]);
+
+  // the voxels of a layer are uploaded to the GPU only if it was modified
+  for (int lidx = 0; lidx < numberOfLayers; ++lidx)
+  {
+    mitk::Image *layerImage = lidx == activeLayer ? image : image->GetLayerImage(lidx);
+    vtkImageData *volume = layerImage->GetVtkImageData(this->GetTimestep());
+    if (localStorage->m_GPULayerVolumes[lidx] != volume || localStorage->m_GPULayerMTimes[lidx] != layerImage->GetMTime())
+    {
+      gpuMapper->SetLayerVolume(lidx, volume);
+      localStorage->m_GPULayerVolumes[lidx] = volume;
+      localStorage->m_GPULayerMTimes[lidx] = layerImage->GetMTime();
+    }
+    gpuMapper->SetLayerLookupTable(lidx, image->GetLabelSet(lidx)->GetLookupTable()->GetVtkLookupTable());
+  }
+
+  float opacity = 1.0f;
+  node->GetOpacity(opacity, renderer, "opacity");
+  localStorage->m_GPUActor->GetProperty()->SetOpacity(opacity);
+
+  gpuMapper->SetOutlineLabel(-1, 0);
+  mitk::Label *activeLabel = image->GetActiveLabel(activeLayer);
+  bool contourActive = false;
+  node->GetBoolProperty("labelset.contour.active", contourActive, renderer);
+  if (nullptr != activeLabel && contourActive && activeLabel->GetVisible())
+  {
+    float contourWidth(2.0);
+    node->GetFloatProperty("labelset.contour.width", contourWidth, renderer);
+    const mitk::Color &color = activeLabel->GetColor();
+    gpuMapper->SetOutlineLabel(activeLayer, activeLabel->GetValue());
+    gpuMapper->SetOutlineColor(color.GetRed(), color.GetGreen(), color.GetBlue());
+    gpuMapper->SetOutlineWidth(contourWidth);
+  }
+
+  this->TransformActor(renderer);
+  gpuMapper->SetInputConnection(localStorage->m_Plane->GetOutputPort());
+  localStorage->m_GPUActor->SetVisibility(true);
+}
+
 bool mitk::LabelSetImageVtkMapper2D::RenderingGeometryIntersectsImage(const PlaneGeometry *renderingGeometry,
                                                                       SlicedGeometry3D *imageGeometry)
 {
@@ -486,6 +619,7 @@ void mitk::LabelSetImageVtkMapper2D::ApplyOpacity(mitk::BaseRenderer *renderer,
   localStorage->m_LayerActorVector[layer]->GetProperty()->SetOpacity(opacity);
   localStorage->m_OutlineActor->GetProperty()->SetOpacity(opacity);
   localStorage->m_OutlineShadowActor->GetProperty()->SetOpacity(opacity);
+  localStorage->m_GPUActor->GetProperty()->SetOpacity(opacity);
 }
 
 void mitk::LabelSetImageVtkMapper2D::ApplyLookuptable(mitk::BaseRenderer *renderer, int layer)
@@ -526,7 +660,11 @@ void mitk::LabelSetImageVtkMapper2D::Update(mitk::BaseRenderer *renderer)
 
   // check if something important has changed and we need to re-render
 
-  if ((localStorage->m_LastDataUpdateTime < image->GetMTime()) ||
+  // a layer volume the graphics card could not hold is rendered on the CPU instead
+  const bool gpuRenderingFailed =
+    localStorage->m_GPUActor->GetVisibility() && localStorage->m_GPUMapper->GetUploadFailed();
+
+  if (gpuRenderingFailed || (localStorage->m_LastDataUpdateTime < image->GetMTime()) ||
       (localStorage->m_LastDataUpdateTime < image->GetPipelineMTime()) ||
       (localStorage->m_LastDataUpdateTime < renderer->GetCurrentWorldPlaneGeometryUpdateTime()) ||
       (localStorage->m_LastDataUpdateTime < renderer->GetCurrentWorldPlaneGeometry()->GetMTime()))
@@ -602,6 +740,10 @@ void mitk::LabelSetImageVtkMapper2D::TransformActor(mitk::BaseRenderer *renderer
   localStorage->m_OutlineShadowActor->SetUserTransform(trans);
   localStorage->m_OutlineShadowActor->SetPosition(
     -0.5 * localStorage->m_mmPerPixel[0], -0.5 * localStorage->m_mmPerPixel[1], 0.0);
+  // same for the actor of the GPU rendering mode
+  localStorage->m_GPUActor->SetUserTransform(trans);
+  localStorage->m_GPUActor->SetPosition(
+    -0.5 * localStorage->m_mmPerPixel[0], -0.5 * localStorage->m_mmPerPixel[1], 0.0);
 }
 
 void mitk::LabelSetImageVtkMapper2D::SetDefaultProperties(mitk::DataNode *node,
@@ -624,6 +766,7 @@ void mitk::LabelSetImageVtkMapper2D::SetDefaultProperties(mitk::DataNode *node,
 
   node->SetProperty("labelset.contour.active", BoolProperty::New(true), renderer);
   node->SetProperty("labelset.contour.width", FloatProperty::New(2.0), renderer);
+  node->SetProperty("labelset.gpu rendering", BoolProperty::New(false), renderer);
 
   Superclass::SetDefaultProperties(node, renderer, overwrite);
 }
@@ -642,6 +785,8 @@ mitk::LabelSetImageVtkMapper2D::LocalStorage::LocalStorage()
   m_OutlineActor = vtkSmartPointer<vtkActor>::New();
   m_OutlineMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
   m_OutlineShadowActor = vtkSmartPointer<vtkActor>::New();
+  m_GPUMapper = vtkSmartPointer<vtkMitkLabelSetGPUMapper>::New();
+  m_GPUActor = vtkSmartPointer<vtkActor>::New();
 
   m_NumberOfLayers = 0;
 
@@ -650,4 +795,7 @@ mitk::LabelSetImageVtkMapper2D::LocalStorage::LocalStorage()
 
   m_OutlineActor->SetVisibility(false);
   m_OutlineShadowActor->SetVisibility(false);
+
+  m_GPUActor->SetMapper(m_GPUMapper);
+  m_GPUActor->SetVisibility(false);
 }
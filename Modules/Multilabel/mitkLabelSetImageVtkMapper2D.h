@@ -41,6 +41,7 @@ class vtkMitkThickSlicesFilter;
 class vtkPolyData;
 class vtkMitkLevelWindowFilter;
 class vtkNeverTranslucentTexture;
+class vtkMitkLabelSetGPUMapper;
 
 namespace mitk
 {
@@ -51,11 +52,18 @@ namespace mitk
    *
    *   - \b "labelset.contour.active": (BoolProperty) whether to show only the active label as a contour or not
    *   - \b "labelset.contour.width": (FloatProperty) line width of the contour
+   *   - \b "labelset.gpu rendering": (BoolProperty) render all layers in a single pass with
+   *     vtkMitkLabelSetGPUMapper instead of reslicing every layer and generating the outline on the CPU.
+   *     The layers are kept on the GPU, scrolling and label changes then do not depend on the number of
+   *     layers and labels. There is no resliced image in this mode, the 3D view does not show the slice.
+   *     Curved geometries, more than vtkMitkLabelSetGPUMapper::MaximumNumberOfLayers layers and volumes
+   *     exceeding the 3D texture size of the graphics card are rendered on the CPU.
 
    * The default properties are:
 
    *   - \b "labelset.contour.active", mitk::BoolProperty::New( true ), renderer, overwrite )
    *   - \b "labelset.contour.width", mitk::FloatProperty::New( 2.0 ), renderer, overwrite )
+   *   - \b "labelset.gpu rendering", mitk::BoolProperty::New( false ), renderer, overwrite )
 
    * \ingroup Mapper
    */
@@ -109,6 +117,13 @@ namespace mitk
       /** \brief A mapper for the outline */
       vtkSmartPointer<vtkPolyDataMapper> m_OutlineMapper;
 
+      /** \brief Renders all layers and the outline in GPU rendering mode */
+      vtkSmartPointer<vtkMitkLabelSetGPUMapper> m_GPUMapper;
+      vtkSmartPointer<vtkActor> m_GPUActor;
+      /** \brief The layer volumes passed to m_GPUMapper and the modification times of their images */
+      std::vector<vtkImageData *> m_GPULayerVolumes;
+      std::vector<unsigned long> m_GPULayerMTimes;
+
       /** \brief Timestamp of last update of stored data. */
       itk::TimeStamp m_LastDataUpdateTime;
 
@@ -194,6 +209,13 @@ namespace mitk
       */
     void GenerateDataForRenderer(mitk::BaseRenderer *renderer) override;
 
+    /** \brief Whether the current slice is rendered by vtkMitkLabelSetGPUMapper, see "labelset.gpu rendering". */
+    bool UseGPURendering(mitk::BaseRenderer *renderer);
+
+    /** \brief Passes the layers, lookup tables and the outline to vtkMitkLabelSetGPUMapper. Only the geometry
+      * of the slice is computed on the CPU, the voxels are uploaded again only if a layer was modified. */
+    void GenerateGPUDataForRenderer(mitk::BaseRenderer *renderer);
+
     /** \brief This method uses the vtkCamera clipping range and the layer property
       * to calcualte the depth of the object (e.g. image or contour). The depth is used
       * to keep the correct order for the final VTK rendering.*/
@@ -0,0 +1,476 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "vtkMitkLabelSetGPUMapper.h"
+
+#include <vtkActor.h>
+#include <vtkImageData.h>
+#include <vtkLookupTable.h>
+#include <vtkMatrix4x4.h>
+#include <vtkObjectFactory.h>
+#include <vtkOpenGLHelper.h>
+#include <vtkOpenGLRenderWindow.h>
+#include <vtkPointData.h>
+#include <vtkProperty.h>
+#include <vtkRenderer.h>
+#include <vtkShaderProgram.h>
+#include <vtkTextureObject.h>
+#include <vtk_glew.h>
+
+#include <algorithm>
+
+namespace
+{
+  /** Number of layers packed into one RGBA texture */
+  const int LayersPerGroup = 4;
+
+  /** The 65536 label values of a layer are stored as 256 x 256 block of the lookup texture */
+  const int LookupBlockSize = 256;
+}
+
+vtkStandardNewMacro(vtkMitkLabelSetGPUMapper);
+
+vtkMitkLabelSetGPUMapper::vtkMitkLabelSetGPUMapper()
+  : NumberOfLayers(0),
+    UploadFailed(false),
+    LookupUploadTime(0),
+    LookupTextureLayers(0),
+    ModelToIndex(vtkSmartPointer<vtkMatrix4x4>::New()),
+    OutlineLayer(-1),
+    OutlineLabel(0),
+    OutlineWidth(2.0)
+{
+  this->VolumeDimensions[0] = this->VolumeDimensions[1] = this->VolumeDimensions[2] = 0;
+  this->SliceSpacing[0] = this->SliceSpacing[1] = 1.0;
+  this->OutlineColor[0] = this->OutlineColor[1] = this->OutlineColor[2] = 1.0;
+
+  this->SetVertexShaderCode("//VTK::System::Dec\n"
+                            "attribute vec4 vertexMC;\n"
+                            "uniform mat4 MCDCMatrix;\n"
+
+                            "varying vec2 modelPosition;\n"
+
+                            "void main(void)\n"
+                            "{\n"
+                            "  modelPosition = vertexMC.xy;\n"
+                            "  gl_Position = MCDCMatrix * vertexMC;\n"
+                            "}\n");
+
+  // every fragment uses the labels at the center of its slice pixel, like the texture of a resliced image
+  this->SetFragmentShaderCode("//VTK::System::Dec\n" // always start with this line
+                              "//VTK::Output::Dec\n" // always have this line in your FS
+                              "uniform sampler3D layerTexture0;\n"
+                              "uniform sampler3D layerTexture1;\n"
+                              "uniform sampler3D layerTexture2;\n"
+                              "uniform sampler3D layerTexture3;\n"
+                              "uniform sampler2D lookupTexture;\n"
+                              "uniform float lookupTextureHeight;\n"
+                              "uniform int numberOfLayers;\n"
+                              "uniform mat4 modelToIndex;\n"
+                              "uniform vec3 volumeDimensions;\n"
+                              "uniform vec2 sliceSpacing;\n"
+                              "uniform int outlineLayer;\n"
+                              "uniform float outlineLabel;\n"
+                              "uniform float outlineWidth;\n"
+                              "uniform vec3 outlineColor;\n"
+                              "uniform float opacity;\n"
+
+                              "varying vec2 modelPosition;\n"
+                              "out vec4 out_Color;\n"
+
+                              "vec4 sampleGroup(int group, vec3 position)\n"
+                              "{\n"
+                              "  vec4 value;\n"
+                              "  if (group == 0)\n"
+                              "    value = texture3D(layerTexture0, position);\n"
+                              "  else if (group == 1)\n"
+                              "    value = texture3D(layerTexture1, position);\n"
+                              "  else if (group == 2)\n"
+                              "    value = texture3D(layerTexture2, position);\n"
+                              "  else\n"
+                              "    value = texture3D(layerTexture3, position);\n"
+                              "  return floor(value * 65535.0 + 0.5);\n"
+                              "}\n"
+
+                              // nearest neighbor position of a slice pixel in the textures, false outside of the volume
+                              "bool pixelToTexture(vec2 pixel, out vec3 position)\n"
+                              "{\n"
+                              "  vec3 index = (modelToIndex * vec4((pixel + 0.5) * sliceSpacing, 0.0, 1.0)).xyz;\n"
+                              "  vec3 voxel = floor(index + 0.5);\n"
+                              "  position = (voxel + 0.5) / volumeDimensions;\n"
+                              "  return all(greaterThanEqual(voxel, vec3(0.0))) && all(lessThan(voxel, volumeDimensions));\n"
+                              "}\n"
+
+                              "float labelAt(vec2 pixel, int layer)\n"
+                              "{\n"
+                              "  vec3 position;\n"
+                              "  if (!pixelToTexture(pixel, position))\n"
+                              "    return -1.0;\n"
+                              "  return sampleGroup(layer / 4, position)[layer - 4 * (layer / 4)];\n"
+                              "}\n"
+
+                              "vec4 lookupLabel(int layer, float label)\n"
+                              "{\n"
+                              "  vec2 position = vec2((mod(label, 256.0) + 0.5) / 256.0,\n"
+                              "                       (float(layer) * 256.0 + floor(label / 256.0) + 0.5) / lookupTextureHeight);\n"
+                              "  return texture2D(lookupTexture, position);\n"
+                              "}\n"
+
+                              "void main(void)\n"
+                              "{\n"
+                              "  vec2 slicePosition = modelPosition / sliceSpacing;\n"
+                              "  vec2 pixel = floor(slicePosition);\n"
+
+                              // composite the layers in ascending order with premultiplied colors
+                              "  vec3 color = vec3(0.0);\n"
+                              "  float alpha = 0.0;\n"
+                              "  vec3 position;\n"
+                              "  if (pixelToTexture(pixel, position))\n"
+                              "  {\n"
+                              "    for (int group = 0; 4 * group < numberOfLayers; ++group)\n"
+                              "    {\n"
+                              "      vec4 labels = sampleGroup(group, position);\n"
+                              "      for (int channel = 0; channel < 4 && 4 * group + channel < numberOfLayers; ++channel)\n"
+                              "      {\n"
+                              "        vec4 layerColor = lookupLabel(4 * group + channel, labels[channel]);\n"
+                              "        float layerAlpha = layerColor.a * opacity;\n"
+                              "        color = color * (1.0 - layerAlpha) + layerColor.rgb * layerAlpha;\n"
+                              "        alpha = alpha * (1.0 - layerAlpha) + layerAlpha;\n"
+                              "      }\n"
+                              "    }\n"
+                              "  }\n"
+
+                              // the outline runs along the edges between pixels inside and outside of the label
+                              "  if (outlineLayer >= 0)\n"
+                              "  {\n"
+                              "    bool inside = labelAt(pixel, outlineLayer) == outlineLabel;\n"
+                              "    vec2 fraction = slicePosition - pixel;\n"
+                              "    vec2 screenPixels = vec2(1.0 / max(length(vec2(dFdx(slicePosition.x), dFdy(slicePosition.x))), 1e-6),\n"
+                              "                             1.0 / max(length(vec2(dFdx(slicePosition.y), dFdy(slicePosition.y))), 1e-6));\n"
+                              "    vec4 edgeDistances = vec4(fraction.x, 1.0 - fraction.x, fraction.y, 1.0 - fraction.y) * screenPixels.xxyy;\n"
+                              "    float edgeDistance = 1e20;\n"
+                              "    if ((labelAt(pixel + vec2(-1.0, 0.0), outlineLayer) == outlineLabel) != inside)\n"
+                              "      edgeDistance = min(edgeDistance, edgeDistances.x);\n"
+                              "    if ((labelAt(pixel + vec2(1.0, 0.0), outlineLayer) == outlineLabel) != inside)\n"
+                              "      edgeDistance = min(edgeDistance, edgeDistances.y);\n"
+                              "    if ((labelAt(pixel + vec2(0.0, -1.0), outlineLayer) == outlineLabel) != inside)\n"
+                              "      edgeDistance = min(edgeDistance, edgeDistances.z);\n"
+                              "    if ((labelAt(pixel + vec2(0.0, 1.0), outlineLayer) == outlineLabel) != inside)\n"
+                              "      edgeDistance = min(edgeDistance, edgeDistances.w);\n"
+
+                              "    if (edgeDistance < 0.75 * outlineWidth)\n"
+                              "    {\n"
+                              "      vec3 lineColor = edgeDistance < 0.5 * outlineWidth ? outlineColor : vec3(0.0);\n"
+                              "      color = color * (1.0 - opacity) + lineColor * opacity;\n"
+                              "      alpha = alpha * (1.0 - opacity) + opacity;\n"
+                              "    }\n"
+                              "  }\n"
+
+                              "  if (alpha <= 0.0)\n"
+                              "    discard;\n"
+                              "  out_Color = vec4(color / alpha, alpha);\n"
+                              "}\n");
+}
+
+vtkMitkLabelSetGPUMapper::~vtkMitkLabelSetGPUMapper()
+{
+}
+
+void vtkMitkLabelSetGPUMapper::SetNumberOfLayers(int numberOfLayers)
+{
+  numberOfLayers = std::max(0, std::min(numberOfLayers, static_cast<int>(MaximumNumberOfLayers)));
+  if (this->NumberOfLayers == numberOfLayers)
+    return;
+
+  this->NumberOfLayers = numberOfLayers;
+  this->LayerVolumes.resize(numberOfLayers);
+  this->LayerLookupTables.resize(numberOfLayers);
+
+  const int numberOfGroups = (numberOfLayers + LayersPerGroup - 1) / LayersPerGroup;
+  this->GroupTextures.resize(numberOfGroups);
+  this->GroupModified.assign(numberOfGroups, true);
+  this->LookupUploadTime = 0;
+  this->Modified();
+}
+
+void vtkMitkLabelSetGPUMapper::SetLayerVolume(int layer, vtkImageData *volume)
+{
+  if (layer < 0 || layer >= this->NumberOfLayers)
+    return;
+
+  this->LayerVolumes[layer] = volume;
+  this->GroupModified[layer / LayersPerGroup] = true;
+  this->UploadFailed = false;
+  this->Modified();
+}
+
+void vtkMitkLabelSetGPUMapper::SetLayerLookupTable(int layer, vtkLookupTable *lookupTable)
+{
+  if (layer < 0 || layer >= this->NumberOfLayers || this->LayerLookupTables[layer] == lookupTable)
+    return;
+
+  this->LayerLookupTables[layer] = lookupTable;
+  this->LookupUploadTime = 0;
+  this->Modified();
+}
+
+void vtkMitkLabelSetGPUMapper::SetModelToIndexMatrix(vtkMatrix4x4 *matrix)
+{
+  this->ModelToIndex->DeepCopy(matrix);
+  this->Modified();
+}
+
+void vtkMitkLabelSetGPUMapper::SetOutlineLabel(int layer, int labelValue)
+{
+  if (this->OutlineLayer == layer && this->OutlineLabel == labelValue)
+    return;
+
+  this->OutlineLayer = layer < this->NumberOfLayers ? layer : -1;
+  this->OutlineLabel = labelValue;
+  this->Modified();
+}
+
+bool vtkMitkLabelSetGPUMapper::UpdateLayerTextures(vtkOpenGLRenderWindow *renderWindow)
+{
+  if (this->UploadFailed)
+    return false;
+
+  // all layers share the geometry of the labelset image
+  int dimensions[3] = {0, 0, 0};
+  for (const auto &volume : this->LayerVolumes)
+  {
+    if (volume == nullptr || volume->GetNumberOfScalarComponents() != 1 ||
+        volume->GetScalarType() != VTK_UNSIGNED_SHORT || volume->GetPointData()->GetScalars() == nullptr)
+    {
+      vtkErrorMacro(<< "Every layer needs single component unsigned short scalars.");
+      this->UploadFailed = true;
+      return false;
+    }
+
+    const int *volumeDimensions = volume->GetDimensions();
+    if (dimensions[0] == 0)
+    {
+      std::copy(volumeDimensions, volumeDimensions + 3, dimensions);
+    }
+    else if (!std::equal(dimensions, dimensions + 3, volumeDimensions))
+    {
+      vtkErrorMacro(<< "All layers need the same dimensions.");
+      this->UploadFailed = true;
+      return false;
+    }
+  }
+
+  GLint maximumTextureSize = 0;
+  glGetIntegerv(GL_MAX_3D_TEXTURE_SIZE, &maximumTextureSize);
+  if (*std::max_element(dimensions, dimensions + 3) > maximumTextureSize)
+  {
+    vtkWarningMacro(<< "The layers exceed the maximum 3D texture size of " << maximumTextureSize << ".");
+    this->UploadFailed = true;
+    return false;
+  }
+
+  if (!std::equal(dimensions, dimensions + 3, this->VolumeDimensions))
+  {
+    std::copy(dimensions, dimensions + 3, this->VolumeDimensions);
+    std::fill(this->GroupModified.begin(), this->GroupModified.end(), true);
+  }
+
+  const vtkIdType numberOfVoxels = static_cast<vtkIdType>(dimensions[0]) * dimensions[1] * dimensions[2];
+  std::vector<unsigned short> buffer;
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+  for (size_t group = 0; group < this->GroupTextures.size(); ++group)
+  {
+    if (!this->GroupModified[group])
+      continue;
+
+    // interleave the layers of the group, missing layers of the last group stay 0
+    buffer.assign(numberOfVoxels * LayersPerGroup, 0);
+    for (int channel = 0; channel < LayersPerGroup; ++channel)
+    {
+      const size_t layer = group * LayersPerGroup + channel;
+      if (layer >= this->LayerVolumes.size())
+        break;
+
+      const auto *scalars = static_cast<const unsigned short *>(this->LayerVolumes[layer]->GetScalarPointer());
+      for (vtkIdType voxel = 0; voxel < numberOfVoxels; ++voxel)
+        buffer[voxel * LayersPerGroup + channel] = scalars[voxel];
+    }
+
+    vtkSmartPointer<vtkTextureObject> &texture = this->GroupTextures[group];
+    if (texture == nullptr)
+    {
+      texture = vtkSmartPointer<vtkTextureObject>::New();
+      texture->SetContext(renderWindow);
+      texture->SetInternalFormat(GL_RGBA16);
+      texture->SetWrapS(vtkTextureObject::ClampToEdge);
+      texture->SetWrapT(vtkTextureObject::ClampToEdge);
+      texture->SetWrapR(vtkTextureObject::ClampToEdge);
+      texture->SetMinificationFilter(vtkTextureObject::Nearest);
+      texture->SetMagnificationFilter(vtkTextureObject::Nearest);
+    }
+
+    if (!texture->Create3DFromRaw(
+          dimensions[0], dimensions[1], dimensions[2], LayersPerGroup, VTK_UNSIGNED_SHORT, buffer.data()))
+    {
+      vtkWarningMacro(<< "Could not upload the layers of " << dimensions[0] << "x" << dimensions[1] << "x"
+                      << dimensions[2] << " voxels.");
+      this->UploadFailed = true;
+      break;
+    }
+    this->GroupModified[group] = false;
+  }
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+  if (this->UploadFailed)
+  {
+    for (auto &texture : this->GroupTextures)
+    {
+      if (texture != nullptr)
+        texture->ReleaseGraphicsResources(renderWindow);
+      texture = nullptr;
+    }
+    std::fill(this->GroupModified.begin(), this->GroupModified.end(), true);
+    return false;
+  }
+  return true;
+}
+
+void vtkMitkLabelSetGPUMapper::UpdateLookupTexture(vtkOpenGLRenderWindow *renderWindow)
+{
+  vtkMTimeType lookupTime = 0;
+  for (const auto &lookupTable : this->LayerLookupTables)
+  {
+    if (lookupTable != nullptr)
+      lookupTime = std::max(lookupTime, lookupTable->GetMTime());
+  }
+
+  if (this->LookupTexture != nullptr && this->LookupUploadTime != 0 && this->LookupUploadTime >= lookupTime &&
+      this->LookupTextureLayers == this->NumberOfLayers)
+    return;
+
+  // label values index the tables directly, labels without a table entry are transparent
+  const vtkIdType layerSize = LookupBlockSize * LookupBlockSize;
+  std::vector<unsigned char> table(4 * layerSize * this->NumberOfLayers, 0);
+  for (int layer = 0; layer < this->NumberOfLayers; ++layer)
+  {
+    vtkLookupTable *lookupTable = this->LayerLookupTables[layer];
+    if (lookupTable == nullptr)
+      continue;
+
+    const vtkIdType numberOfValues = std::min(lookupTable->GetNumberOfTableValues(), layerSize);
+    const unsigned char *rgba = lookupTable->GetPointer(0);
+    std::copy(rgba, rgba + 4 * numberOfValues, table.begin() + 4 * layerSize * layer);
+  }
+
+  if (this->LookupTexture == nullptr)
+  {
+    this->LookupTexture = vtkSmartPointer<vtkTextureObject>::New();
+    this->LookupTexture->SetContext(renderWindow);
+    this->LookupTexture->SetWrapS(vtkTextureObject::ClampToEdge);
+    this->LookupTexture->SetWrapT(vtkTextureObject::ClampToEdge);
+    this->LookupTexture->SetMinificationFilter(vtkTextureObject::Nearest);
+    this->LookupTexture->SetMagnificationFilter(vtkTextureObject::Nearest);
+  }
+  this->LookupTexture->Create2DFromRaw(
+    LookupBlockSize, LookupBlockSize * this->NumberOfLayers, 4, VTK_UNSIGNED_CHAR, table.data());
+
+  this->LookupUploadTime = std::max<vtkMTimeType>(lookupTime, 1);
+  this->LookupTextureLayers = this->NumberOfLayers;
+}
+
+void vtkMitkLabelSetGPUMapper::RenderPiece(vtkRenderer *ren, vtkActor *act)
+{
+  auto *renderWindow = vtkOpenGLRenderWindow::SafeDownCast(ren->GetRenderWindow());
+  if (renderWindow == nullptr || this->NumberOfLayers == 0)
+    return;
+
+  if (!this->UpdateLayerTextures(renderWindow))
+    return;
+  this->UpdateLookupTexture(renderWindow);
+
+  for (const auto &texture : this->GroupTextures)
+    texture->Activate();
+  this->LookupTexture->Activate();
+
+  this->Superclass::RenderPiece(ren, act);
+
+  this->LookupTexture->Deactivate();
+  for (const auto &texture : this->GroupTextures)
+    texture->Deactivate();
+}
+
+void vtkMitkLabelSetGPUMapper::SetMapperShaderParameters(vtkOpenGLHelper &cellBO, vtkRenderer *ren, vtkActor *act)
+{
+  this->Superclass::SetMapperShaderParameters(cellBO, ren, act);
+
+  if (this->GroupTextures.empty() || this->LookupTexture == nullptr)
+    return;
+
+  vtkShaderProgram *program = cellBO.Program;
+
+  // samplers of missing groups are never read, they point to the first group
+  const char *samplerNames[] = {"layerTexture0", "layerTexture1", "layerTexture2", "layerTexture3"};
+  for (int group = 0; group < MaximumNumberOfLayers / LayersPerGroup; ++group)
+  {
+    const size_t boundGroup = static_cast<size_t>(group) < this->GroupTextures.size() ? group : 0;
+    program->SetUniformi(samplerNames[group], this->GroupTextures[boundGroup]->GetTextureUnit());
+  }
+
+  // shader programs expect column major matrices
+  auto modelToIndex = vtkSmartPointer<vtkMatrix4x4>::New();
+  vtkMatrix4x4::Transpose(this->ModelToIndex, modelToIndex);
+
+  const float volumeDimensions[3] = {static_cast<float>(this->VolumeDimensions[0]),
+                                     static_cast<float>(this->VolumeDimensions[1]),
+                                     static_cast<float>(this->VolumeDimensions[2])};
+  const float sliceSpacing[2] = {static_cast<float>(this->SliceSpacing[0]), static_cast<float>(this->SliceSpacing[1])};
+  const float outlineColor[3] = {static_cast<float>(this->OutlineColor[0]),
+                                 static_cast<float>(this->OutlineColor[1]),
+                                 static_cast<float>(this->OutlineColor[2])};
+
+  program->SetUniformi("lookupTexture", this->LookupTexture->GetTextureUnit());
+  program->SetUniformf("lookupTextureHeight", static_cast<float>(LookupBlockSize * this->NumberOfLayers));
+  program->SetUniformi("numberOfLayers", this->NumberOfLayers);
+  program->SetUniformMatrix("modelToIndex", modelToIndex);
+  program->SetUniform3f("volumeDimensions", volumeDimensions);
+  program->SetUniform2f("sliceSpacing", sliceSpacing);
+  program->SetUniformi("outlineLayer", this->OutlineLayer);
+  program->SetUniformf("outlineLabel", static_cast<float>(this->OutlineLabel));
+  program->SetUniformf("outlineWidth", static_cast<float>(this->OutlineWidth));
+  program->SetUniform3f("outlineColor", outlineColor);
+  program->SetUniformf("opacity", static_cast<float>(act->GetProperty()->GetOpacity()));
+}
+
+void vtkMitkLabelSetGPUMapper::ReleaseGraphicsResources(vtkWindow *window)
+{
+  for (auto &texture : this->GroupTextures)
+  {
+    if (texture != nullptr)
+      texture->ReleaseGraphicsResources(window);
+    texture = nullptr;
+  }
+  std::fill(this->GroupModified.begin(), this->GroupModified.end(), true);
+
+  if (this->LookupTexture != nullptr)
+    this->LookupTexture->ReleaseGraphicsResources(window);
+  this->LookupTexture = nullptr;
+  this->LookupUploadTime = 0;
+
+  this->Superclass::ReleaseGraphicsResources(window);
+}
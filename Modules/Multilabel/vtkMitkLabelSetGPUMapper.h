@@ -0,0 +1,126 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef vtkMitkLabelSetGPUMapper_h
+#define vtkMitkLabelSetGPUMapper_h
+
+#include "MitkMultilabelExports.h"
+
+#include <vtkOpenGLPolyDataMapper.h>
+#include <vtkSmartPointer.h>
+
+#include <vector>
+
+class vtkImageData;
+class vtkLookupTable;
+class vtkMatrix4x4;
+class vtkOpenGLRenderWindow;
+class vtkTextureObject;
+
+/**
+  \brief Renders a slice of all layers of a labelset image in a single pass.
+
+  The layers are packed into RGBA textures with four layers each and kept on the GPU. Every
+  fragment is mapped to the center of its slice pixel, all layers are sampled there with nearest
+  neighbor interpolation (which is what the reslicing of the CPU path does), and the labels are
+  mapped to their color, opacity and visibility by a lookup texture holding the lookup tables of
+  all layers. The layers are composited in the fragment shader in ascending order.
+
+  The outline of one label is computed in the same pass by comparing the slice pixel to its four
+  neighbors, it is drawn with a black shadow like the outline actors of the CPU path.
+
+  Changing the slice, the label colors or the outline only updates uniforms and the lookup
+  texture. A modified layer uploads the texture of its group of four layers again.
+  Up to MaximumNumberOfLayers layers are supported, volumes have to fit into a single 3D texture.
+  GetUploadFailed() reports volumes the graphics card could not hold.
+
+  \sa mitk::LabelSetImageVtkMapper2D
+*/
+class MITKMULTILABEL_EXPORT vtkMitkLabelSetGPUMapper : public vtkOpenGLPolyDataMapper
+{
+public:
+  static vtkMitkLabelSetGPUMapper *New();
+  vtkTypeMacro(vtkMitkLabelSetGPUMapper, vtkOpenGLPolyDataMapper);
+
+  /** \brief Number of layers sampled by the shader, four per texture. */
+  static const int MaximumNumberOfLayers = 16;
+
+  void SetNumberOfLayers(int numberOfLayers);
+  vtkGetMacro(NumberOfLayers, int);
+
+  /** \brief The voxels of a layer, unsigned short scalars with the same dimensions for all layers.
+   * The group of the layer is uploaded again on the next render, even if the pointer did not change. */
+  void SetLayerVolume(int layer, vtkImageData *volume);
+
+  /** \brief Maps the label values of a layer to colors, the alpha holds the opacity and visibility. */
+  void SetLayerLookupTable(int layer, vtkLookupTable *lookupTable);
+
+  /** \brief Maps the model coordinates of the rendered polydata to continuous voxel indices. */
+  void SetModelToIndexMatrix(vtkMatrix4x4 *matrix);
+
+  /** \brief Size of a slice pixel in model coordinates, the slice pixels start at the model origin. */
+  vtkSetVector2Macro(SliceSpacing, double);
+
+  /** \brief Label whose outline is drawn, a negative layer disables the outline. */
+  void SetOutlineLabel(int layer, int labelValue);
+
+  /** \brief Width of the outline in screen pixels, the shadow is 1.5 times wider. */
+  vtkSetMacro(OutlineWidth, double);
+  vtkSetVector3Macro(OutlineColor, double);
+
+  /** \brief True if a layer volume could not be uploaded, it is not tried again before the volume is set again. */
+  vtkGetMacro(UploadFailed, bool);
+
+  void RenderPiece(vtkRenderer *ren, vtkActor *act) override;
+  void ReleaseGraphicsResources(vtkWindow *window) override;
+
+protected:
+  vtkMitkLabelSetGPUMapper();
+  ~vtkMitkLabelSetGPUMapper() override;
+
+  void SetMapperShaderParameters(vtkOpenGLHelper &cellBO, vtkRenderer *ren, vtkActor *act) override;
+
+  bool UpdateLayerTextures(vtkOpenGLRenderWindow *renderWindow);
+  void UpdateLookupTexture(vtkOpenGLRenderWindow *renderWindow);
+
+  int NumberOfLayers;
+  std::vector<vtkSmartPointer<vtkImageData>> LayerVolumes;
+  std::vector<vtkSmartPointer<vtkLookupTable>> LayerLookupTables;
+
+  /** \brief One texture per group of four layers, uploaded if the group is marked as modified */
+  std::vector<vtkSmartPointer<vtkTextureObject>> GroupTextures;
+  std::vector<bool> GroupModified;
+  int VolumeDimensions[3];
+  bool UploadFailed;
+
+  vtkSmartPointer<vtkTextureObject> LookupTexture;
+  vtkMTimeType LookupUploadTime;
+  int LookupTextureLayers;
+
+  vtkSmartPointer<vtkMatrix4x4> ModelToIndex;
+  double SliceSpacing[2];
+
+  int OutlineLayer;
+  int OutlineLabel;
+  double OutlineWidth;
+  double OutlineColor[3];
+
+private:
+  vtkMitkLabelSetGPUMapper(const vtkMitkLabelSetGPUMapper &); // Not implemented.
+  void operator=(const vtkMitkLabelSetGPUMapper &);          // Not implemented.
+};
+
+#endif
@@ -0,0 +1,90 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+__kernel void ckGaussianConvert(
+  __read_only image3d_t dSource, // input image
+  __global float* dDest // output buffer
+)
+{
+  // get thread identifier
+  unsigned int globalPosX = get_global_id(0);
+  unsigned int globalPosY = get_global_id(1);
+  unsigned int globalPosZ = get_global_id(2);
+
+  const unsigned int uiWidth = get_image_width( dSource );
+  const unsigned int uiHeight = get_image_height( dSource );
+  const unsigned int uiDepth = get_image_depth( dSource );
+
+  const sampler_t defaultSampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP_TO_EDGE | CLK_FILTER_NEAREST;
+
+  // terminate non-valid threads
+  if ( globalPosX < uiWidth && globalPosY < uiHeight && globalPosZ < uiDepth )
+  {
+    dDest[ globalPosZ * uiWidth * uiHeight + globalPosY * uiWidth + globalPosX ] =
+      READ_INPUT( dSource, defaultSampler, (int4)(globalPosX, globalPosY, globalPosZ, 0) );
+  }
+}
+
+__kernel void ckGaussianConvolve(
+  __global const float* dSource, // input buffer
+  __global float* dDest, // output buffer
+  __global const float* dWeights, // normalized kernel weights of all axes
+  unsigned int weightOffset, // index of the first weight of the current axis
+  int radius, // kernel radius along the current axis in voxels
+  unsigned int axis, // 0, 1 or 2
+  unsigned int uiWidth, unsigned int uiHeight, unsigned int uiDepth // image size
+)
+{
+  // get thread identifier
+  unsigned int globalPosX = get_global_id(0);
+  unsigned int globalPosY = get_global_id(1);
+  unsigned int globalPosZ = get_global_id(2);
+
+  // terminate non-valid threads
+  if ( globalPosX >= uiWidth || globalPosY >= uiHeight || globalPosZ >= uiDepth )
+    return;
+
+  const unsigned int index = globalPosZ * uiWidth * uiHeight + globalPosY * uiWidth + globalPosX;
+
+  // position, size and memory stride along the filtered axis
+  int position = globalPosX;
+  int size = uiWidth;
+  unsigned int stride = 1;
+  if ( axis == 1 )
+  {
+    position = globalPosY;
+    size = uiHeight;
+    stride = uiWidth;
+  }
+  else if ( axis == 2 )
+  {
+    position = globalPosZ;
+    size = uiDepth;
+    stride = uiWidth * uiHeight;
+  }
+
+  __global const float* dLine = dSource + index - position * stride;
+  __global const float* dKernel = dWeights + weightOffset + radius;
+
+  // the border voxels are replicated
+  float sum = 0.0f;
+  for ( int k = -radius; k <= radius; ++k )
+  {
+    sum += dKernel[k] * dLine[ clamp(position + k, 0, size - 1) * stride ];
+  }
+
+  dDest[index] = sum;
+}
@@ -0,0 +1,104 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+// Neighbors and weight for linear interpolation along one axis. Like vtkImageReslice, points up to half a
+// voxel outside of the image are inside and use the border voxel.
+bool GetLinearNeighbors(float position, int size, int* index0, int* index1, float* weight)
+{
+  float lower = floor(position);
+  *weight = position - lower;
+  *index0 = (int)lower;
+  *index1 = *index0 + (*weight != 0.0f ? 1 : 0);
+
+  bool inside = (*index0 >= 0 && *index1 < size) ||
+                (*index0 == -1 && *weight >= 0.5f) ||
+                (*index0 == size - 1 && *weight < 0.5f);
+
+  *index0 = clamp(*index0, 0, size - 1);
+  *index1 = clamp(*index1, 0, size - 1);
+  return inside;
+}
+
+__kernel void ckResample(
+  __read_only image3d_t dSource, // input image
+  __global INPUT_TYPE* dDest, // output buffer
+  float16 outputToInputIndex, // rows of the 3x4 matrix mapping output voxels to continuous input indices
+  unsigned int uiWidth, unsigned int uiHeight, unsigned int uiDepth, // output size
+  int useLinearInterpolation,
+  float defaultValue // value outside of the input
+)
+{
+  // get thread identifier
+  unsigned int globalPosX = get_global_id(0);
+  unsigned int globalPosY = get_global_id(1);
+  unsigned int globalPosZ = get_global_id(2);
+
+  // terminate non-valid threads
+  if ( globalPosX >= uiWidth || globalPosY >= uiHeight || globalPosZ >= uiDepth )
+    return;
+
+  const int4 inputSize = (int4)( get_image_width( dSource ), get_image_height( dSource ), get_image_depth( dSource ), 1 );
+  const sampler_t defaultSampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP_TO_EDGE | CLK_FILTER_NEAREST;
+
+  const float4 outputIndex = (float4)( globalPosX, globalPosY, globalPosZ, 1.0f );
+  const float4 inputIndex = (float4)( dot( outputToInputIndex.s0123, outputIndex ),
+                                      dot( outputToInputIndex.s4567, outputIndex ),
+                                      dot( outputToInputIndex.s89ab, outputIndex ), 0.0f );
+
+  float result = defaultValue;
+
+  if ( useLinearInterpolation )
+  {
+    int x0, x1, y0, y1, z0, z1;
+    float fx, fy, fz;
+    bool inside = GetLinearNeighbors( inputIndex.x, inputSize.x, &x0, &x1, &fx );
+    inside &= GetLinearNeighbors( inputIndex.y, inputSize.y, &y0, &y1, &fy );
+    inside &= GetLinearNeighbors( inputIndex.z, inputSize.z, &z0, &z1, &fz );
+
+    if ( inside )
+    {
+      float v000 = READ_INPUT( dSource, defaultSampler, (int4)(x0, y0, z0, 0) );
+      float v100 = READ_INPUT( dSource, defaultSampler, (int4)(x1, y0, z0, 0) );
+      float v010 = READ_INPUT( dSource, defaultSampler, (int4)(x0, y1, z0, 0) );
+      float v110 = READ_INPUT( dSource, defaultSampler, (int4)(x1, y1, z0, 0) );
+      float v001 = READ_INPUT( dSource, defaultSampler, (int4)(x0, y0, z1, 0) );
+      float v101 = READ_INPUT( dSource, defaultSampler, (int4)(x1, y0, z1, 0) );
+      float v011 = READ_INPUT( dSource, defaultSampler, (int4)(x0, y1, z1, 0) );
+      float v111 = READ_INPUT( dSource, defaultSampler, (int4)(x1, y1, z1, 0) );
+
+      float v00 = mix( v000, v100, fx );
+      float v10 = mix( v010, v110, fx );
+      float v01 = mix( v001, v101, fx );
+      float v11 = mix( v011, v111, fx );
+
+      result = mix( mix( v00, v10, fy ), mix( v01, v11, fy ), fz );
+    }
+  }
+  else
+  {
+    // round like vtkImageReslice
+    int4 nearest = convert_int4( floor( inputIndex + 0.5f ) );
+
+    if ( nearest.x >= 0 && nearest.x < inputSize.x &&
+         nearest.y >= 0 && nearest.y < inputSize.y &&
+         nearest.z >= 0 && nearest.z < inputSize.z )
+    {
+      result = READ_INPUT( dSource, defaultSampler, (int4)(nearest.x, nearest.y, nearest.z, 0) );
+    }
+  }
+
+  dDest[ globalPosZ * uiWidth * uiHeight + globalPosY * uiWidth + globalPosX ] = CONVERT_TO_INPUT_TYPE( result );
+}
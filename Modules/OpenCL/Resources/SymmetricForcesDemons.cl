@@ -0,0 +1,250 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+// All images are stored as float buffers in x-fastest order, displacement
+// fields as interleaved (x,y,z) triples in world coordinates (mm).
+// Index to world transforms are passed as float16 with the 3x3 matrix
+// (row major) in s0-s8 and the offset in s9-sb.
+
+inline int linearIndex(int x, int y, int z, int4 size)
+{
+  return (z * size.y + y) * size.x + x;
+}
+
+inline float3 transformPoint(float16 t, float3 p)
+{
+  return (float3)( t.s0 * p.x + t.s1 * p.y + t.s2 * p.z + t.s9,
+                   t.s3 * p.x + t.s4 * p.y + t.s5 * p.z + t.sa,
+                   t.s6 * p.x + t.s7 * p.y + t.s8 * p.z + t.sb );
+}
+
+inline float3 transformVector(float16 t, float3 v)
+{
+  return (float3)( t.s0 * v.x + t.s1 * v.y + t.s2 * v.z,
+                   t.s3 * v.x + t.s4 * v.y + t.s5 * v.z,
+                   t.s6 * v.x + t.s7 * v.y + t.s8 * v.z );
+}
+
+inline float sampleLinear(__global const float* image, int4 size, float3 index)
+{
+  const float3 f = floor(index);
+  const float3 w = index - f;
+  const int x0 = clamp((int)f.x, 0, size.x - 1);
+  const int y0 = clamp((int)f.y, 0, size.y - 1);
+  const int z0 = clamp((int)f.z, 0, size.z - 1);
+  const int x1 = clamp((int)f.x + 1, 0, size.x - 1);
+  const int y1 = clamp((int)f.y + 1, 0, size.y - 1);
+  const int z1 = clamp((int)f.z + 1, 0, size.z - 1);
+
+  const float c00 = mix(image[linearIndex(x0, y0, z0, size)], image[linearIndex(x1, y0, z0, size)], w.x);
+  const float c10 = mix(image[linearIndex(x0, y1, z0, size)], image[linearIndex(x1, y1, z0, size)], w.x);
+  const float c01 = mix(image[linearIndex(x0, y0, z1, size)], image[linearIndex(x1, y0, z1, size)], w.x);
+  const float c11 = mix(image[linearIndex(x0, y1, z1, size)], image[linearIndex(x1, y1, z1, size)], w.x);
+
+  return mix(mix(c00, c10, w.y), mix(c01, c11, w.y), w.z);
+}
+
+inline float3 sampleFieldLinear(__global const float* field, int4 size, float3 index)
+{
+  const float3 f = floor(index);
+  const float3 w = index - f;
+  const int x0 = clamp((int)f.x, 0, size.x - 1);
+  const int y0 = clamp((int)f.y, 0, size.y - 1);
+  const int z0 = clamp((int)f.z, 0, size.z - 1);
+  const int x1 = clamp((int)f.x + 1, 0, size.x - 1);
+  const int y1 = clamp((int)f.y + 1, 0, size.y - 1);
+  const int z1 = clamp((int)f.z + 1, 0, size.z - 1);
+
+  const float3 c00 = mix(vload3(linearIndex(x0, y0, z0, size), field), vload3(linearIndex(x1, y0, z0, size), field), w.x);
+  const float3 c10 = mix(vload3(linearIndex(x0, y1, z0, size), field), vload3(linearIndex(x1, y1, z0, size), field), w.x);
+  const float3 c01 = mix(vload3(linearIndex(x0, y0, z1, size), field), vload3(linearIndex(x1, y0, z1, size), field), w.x);
+  const float3 c11 = mix(vload3(linearIndex(x0, y1, z1, size), field), vload3(linearIndex(x1, y1, z1, size), field), w.x);
+
+  return mix(mix(c00, c10, w.y), mix(c01, c11, w.y), w.z);
+}
+
+/** Box filtered downsampling by a factor of 2 (one pyramid level). */
+__kernel void ckDownsample(
+  __global const float* dSource, __global float* dDest,
+  int4 sourceSize, int4 destSize
+)
+{
+  const int x = get_global_id(0);
+  const int y = get_global_id(1);
+  const int z = get_global_id(2);
+
+  if ( x < destSize.x && y < destSize.y && z < destSize.z )
+  {
+    float sum = 0.0f;
+    for (int k = 0; k < 2; ++k)
+    {
+      for (int j = 0; j < 2; ++j)
+      {
+        for (int i = 0; i < 2; ++i)
+        {
+          sum += dSource[linearIndex(min(2 * x + i, sourceSize.x - 1), min(2 * y + j, sourceSize.y - 1), min(2 * z + k, sourceSize.z - 1), sourceSize)];
+        }
+      }
+    }
+    dDest[linearIndex(x, y, z, destSize)] = 0.125f * sum;
+  }
+}
+
+/** Samples the moving image at the positions of the fixed grid displaced by the field.
+  * Positions outside of the moving image are marked with NaN. */
+__kernel void ckWarp(
+  __global const float* dMoving, __global float* dWarped, __global const float* dField,
+  int4 fixedSize, int4 movingSize,
+  float16 fixedIndexToWorld, float16 movingWorldToIndex
+)
+{
+  const int x = get_global_id(0);
+  const int y = get_global_id(1);
+  const int z = get_global_id(2);
+
+  if ( x < fixedSize.x && y < fixedSize.y && z < fixedSize.z )
+  {
+    const int idx = linearIndex(x, y, z, fixedSize);
+    const float3 world = transformPoint(fixedIndexToWorld, (float3)(x, y, z)) + vload3(idx, dField);
+    const float3 movingIndex = transformPoint(movingWorldToIndex, world);
+
+    if ( movingIndex.x < -0.5f || movingIndex.y < -0.5f || movingIndex.z < -0.5f ||
+         movingIndex.x > movingSize.x - 0.5f || movingIndex.y > movingSize.y - 0.5f || movingIndex.z > movingSize.z - 0.5f )
+    {
+      dWarped[idx] = NAN;
+    }
+    else
+    {
+      dWarped[idx] = sampleLinear(dMoving, movingSize, movingIndex);
+    }
+  }
+}
+
+inline float3 indexGradient(__global const float* image, int4 size, int x, int y, int z)
+{
+  const float xm = image[linearIndex(max(x - 1, 0), y, z, size)];
+  const float xp = image[linearIndex(min(x + 1, size.x - 1), y, z, size)];
+  const float ym = image[linearIndex(x, max(y - 1, 0), z, size)];
+  const float yp = image[linearIndex(x, min(y + 1, size.y - 1), z, size)];
+  const float zm = image[linearIndex(x, y, max(z - 1, 0), size)];
+  const float zp = image[linearIndex(x, y, min(z + 1, size.z - 1), size)];
+
+  float3 g = (float3)(0.5f * (xp - xm), 0.5f * (yp - ym), 0.5f * (zp - zm));
+  // neighbours outside of the moving image do not contribute
+  g = select(g, (float3)(0.0f), isnan(g));
+  return g;
+}
+
+/** Adds the symmetric forces demons update to the field.
+  * indexGradientToWorld maps index space gradients to world space gradients. */
+__kernel void ckSymmetricForcesUpdate(
+  __global const float* dFixed, __global const float* dWarped, __global float* dField,
+  int4 size, float16 indexGradientToWorld,
+  float normalizer, float intensityDifferenceThreshold, float maximumUpdateStepLength
+)
+{
+  const int x = get_global_id(0);
+  const int y = get_global_id(1);
+  const int z = get_global_id(2);
+
+  if ( x < size.x && y < size.y && z < size.z )
+  {
+    const int idx = linearIndex(x, y, z, size);
+    const float fixedValue = dFixed[idx];
+    const float warpedValue = dWarped[idx];
+
+    if ( isnan(warpedValue) )
+    {
+      return;
+    }
+
+    const float3 fixedGradient = transformVector(indexGradientToWorld, indexGradient(dFixed, size, x, y, z));
+    const float3 warpedGradient = transformVector(indexGradientToWorld, indexGradient(dWarped, size, x, y, z));
+    const float3 gradient = 0.5f * (fixedGradient + warpedGradient);
+
+    const float difference = fixedValue - warpedValue;
+    const float denominator = dot(gradient, gradient) + difference * difference / normalizer;
+
+    if ( fabs(difference) < intensityDifferenceThreshold || denominator < 1e-9f )
+    {
+      return;
+    }
+
+    float3 update = (difference / denominator) * gradient;
+
+    const float length = fast_length(update);
+    if ( maximumUpdateStepLength > 0.0f && length > maximumUpdateStepLength )
+    {
+      update *= maximumUpdateStepLength / length;
+    }
+
+    vstore3(vload3(idx, dField) + update, idx, dField);
+  }
+}
+
+/** One pass of the separable gaussian smoothing of the field along axis (0, 1 or 2). */
+__kernel void ckSmoothField(
+  __global const float* dSource, __global float* dDest,
+  int4 size, int axis, float sigma, int radius
+)
+{
+  const int x = get_global_id(0);
+  const int y = get_global_id(1);
+  const int z = get_global_id(2);
+
+  if ( x < size.x && y < size.y && z < size.z )
+  {
+    const int4 position = (int4)(x, y, z, 0);
+    const int extent = (axis == 0) ? size.x : ((axis == 1) ? size.y : size.z);
+    const int center = (axis == 0) ? x : ((axis == 1) ? y : z);
+    const float factor = -0.5f / (sigma * sigma);
+
+    float3 sum = (float3)(0.0f);
+    float weightSum = 0.0f;
+
+    for (int offset = -radius; offset <= radius; ++offset)
+    {
+      const int p = clamp(center + offset, 0, extent - 1);
+      int4 neighbour = position;
+      if (axis == 0) neighbour.x = p;
+      else if (axis == 1) neighbour.y = p;
+      else neighbour.z = p;
+
+      const float weight = exp(factor * offset * offset);
+      sum += weight * vload3(linearIndex(neighbour.x, neighbour.y, neighbour.z, size), dSource);
+      weightSum += weight;
+    }
+
+    vstore3(sum / weightSum, linearIndex(x, y, z, size), dDest);
+  }
+}
+
+/** Upsamples the field of the coarser pyramid level onto the grid of the finer level. */
+__kernel void ckUpsampleField(
+  __global const float* dSource, __global float* dDest,
+  int4 sourceSize, int4 destSize
+)
+{
+  const int x = get_global_id(0);
+  const int y = get_global_id(1);
+  const int z = get_global_id(2);
+
+  if ( x < destSize.x && y < destSize.y && z < destSize.z )
+  {
+    const float3 sourceIndex = ((float3)(x, y, z) - 0.5f) * 0.5f;
+    vstore3(sampleFieldLinear(dSource, sourceSize, sourceIndex), linearIndex(x, y, z, destSize), dDest);
+  }
+}
@@ -2,5 +2,7 @@ set(MODULE_TESTS
   mitkOclResourceServiceTest.cpp
   mitkOclImageTest.cpp
   mitkOclBinaryThresholdImageFilterTest.cpp
+  mitkOclImageProcessingAcceleratorTest.cpp
+  mitkOclSymmetricForcesDemonsRegistrationFilterTest.cpp
   mitkOclReferenceCountTest.cpp
 )
@@ -33,6 +33,7 @@ class mitkOclBinaryThresholdImageFilterTestSuite : public mitk::TestFixture
   CPPUNIT_TEST_SUITE(mitkOclBinaryThresholdImageFilterTestSuite);
   MITK_TEST(SetInput_2DImage_ThrowsException);
   MITK_TEST(GenerateData_3DImage_CompareToReference);
+  MITK_TEST(GenerateData_ChainedOnDevice_CompareToReference);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -134,6 +135,71 @@ public:
     }
 
   }
+
+  void GenerateData_ChainedOnDevice_CompareToReference()
+  {
+    us::ServiceReference<OclResourceService> ref = GetModuleContext()->GetServiceReference<OclResourceService>();
+    OclResourceService* resources = GetModuleContext()->GetService<OclResourceService>(ref);
+    resources->GetContext();
+    if(resources->GetMaximumImageSize(2, CL_MEM_OBJECT_IMAGE3D) == 0)
+    {
+      //GPU device does not support 3D images. Skip this test.
+      MITK_INFO << "Skipping test.";
+      return;
+    }
+
+    try{
+      // first stage: 100 inside [60, 255], 0 outside
+      m_oclBinaryFilter->SetInput( m_Random3DImage );
+      m_oclBinaryFilter->SetUpperThreshold( 255 );
+      m_oclBinaryFilter->SetLowerThreshold( 60 );
+      m_oclBinaryFilter->SetOutsideValue( 0 );
+      m_oclBinaryFilter->SetInsideValue( 100 );
+      m_oclBinaryFilter->Update();
+
+      // second stage reads the output of the first one without a transfer to the CPU
+      mitk::OclBinaryThresholdImageFilter::Pointer secondFilter = mitk::OclBinaryThresholdImageFilter::New();
+      secondFilter->SetInput( m_oclBinaryFilter->GetGPUOutput() );
+      secondFilter->SetUpperThreshold( 150 );
+      secondFilter->SetLowerThreshold( 50 );
+      secondFilter->SetOutsideValue( 10 );
+      secondFilter->SetInsideValue( 200 );
+      secondFilter->Update();
+      secondFilter->PrefetchOutput();
+
+      mitk::Image::Pointer outputImage = secondFilter->GetOutput();
+
+      // both stages together are a single threshold
+      typedef itk::Image< unsigned char, 3> ImageType;
+      typedef itk::BinaryThresholdImageFilter< ImageType, ImageType > ThresholdFilterType;
+
+      ImageType::Pointer itkInputImage = ImageType::New();
+      CastToItkImage( m_Random3DImage, itkInputImage );
+
+      ThresholdFilterType::Pointer refThrFilter = ThresholdFilterType::New();
+      refThrFilter->SetInput( itkInputImage );
+      refThrFilter->SetLowerThreshold( 60 );
+      refThrFilter->SetUpperThreshold( 255 );
+      refThrFilter->SetOutsideValue( 10 );
+      refThrFilter->SetInsideValue( 200 );
+      refThrFilter->Update();
+      mitk::Image::Pointer referenceImage = mitk::Image::New();
+      mitk::CastToMitkImage(refThrFilter->GetOutput(), referenceImage);
+
+      MITK_ASSERT_EQUAL( referenceImage, outputImage,
+                         "Chained OclBinaryThresholdFilters should be equal to a single itkBinaryThresholdImageFilter.");
+
+      // the first stage is still usable, its output was not replaced by the image object the second stage read
+      m_oclBinaryFilter->Update();
+      CPPUNIT_ASSERT( m_oclBinaryFilter->GetOutput().IsNotNull() );
+    }
+    catch(mitk::Exception &e)
+    {
+      std::string errorMessage = "Caught unexpected exception ";
+      errorMessage.append(e.what());
+      CPPUNIT_FAIL(errorMessage.c_str());
+    }
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkOclBinaryThresholdImageFilter)
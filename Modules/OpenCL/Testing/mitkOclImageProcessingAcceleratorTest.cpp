@@ -0,0 +1,244 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkImage.h>
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+
+#include <mitkExtractSliceFilter.h>
+#include <mitkIImageProcessingAccelerator.h>
+#include <mitkImageGenerator.h>
+#include <mitkImagePixelReadAccessor.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkInteractionConst.h>
+#include <mitkRotationOperation.h>
+
+#include <mitkOclGaussianImageFilter.h>
+#include <mitkOclResampleImageFilter.h>
+#include <mitkException.h>
+
+#include <cmath>
+#include <vector>
+
+class mitkOclImageProcessingAcceleratorTestSuite : public mitk::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(mitkOclImageProcessingAcceleratorTestSuite);
+  MITK_TEST(ServiceIsRegistered);
+  MITK_TEST(GaussianSmooth_CompareToReference);
+  MITK_TEST(Resample_OwnGeometry_EqualsInput);
+  MITK_TEST(ExtractSliceFilter_Accelerated_CompareToCPU);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  /** Members used inside the different (sub-)tests. All members are initialized via setUp().
+    */
+  mitk::Image::Pointer m_Random3DImage;
+
+  mitk::IImageProcessingAccelerator* m_Accelerator;
+
+  bool IsDeviceSupported()
+  {
+    us::ServiceReference<OclResourceService> ref = GetModuleContext()->GetServiceReference<OclResourceService>();
+    OclResourceService* resources = GetModuleContext()->GetService<OclResourceService>(ref);
+    resources->GetContext();
+    if(resources->GetMaximumImageSize(2, CL_MEM_OBJECT_IMAGE3D) == 0)
+    {
+      //GPU device does not support 3D images. Skip this test.
+      MITK_INFO << "Skipping test.";
+      return false;
+    }
+    return true;
+  }
+
+  /** Separable convolution with the sampled, normalized Gaussian and replicated borders, as done on the device */
+  std::vector<float> SmoothOnCPU(const double sigma[3])
+  {
+    unsigned int* dimensions = m_Random3DImage->GetDimensions();
+    const mitk::Vector3D spacing = m_Random3DImage->GetGeometry()->GetSpacing();
+
+    mitk::ImagePixelReadAccessor<unsigned char, 3> accessor(m_Random3DImage);
+    std::vector<float> data(accessor.GetData(), accessor.GetData() + dimensions[0] * dimensions[1] * dimensions[2]);
+
+    const unsigned int strides[3] = { 1, dimensions[0], dimensions[0] * dimensions[1] };
+    for (unsigned int axis = 0; axis < 3; ++axis)
+    {
+      const double voxelSigma = sigma[axis] / spacing[axis];
+      const int radius = static_cast<int>(std::ceil(3.0 * voxelSigma));
+
+      std::vector<double> weights;
+      double sum = 0.0;
+      for (int k = -radius; k <= radius; ++k)
+      {
+        weights.push_back(std::exp(-0.5 * k * k / (voxelSigma * voxelSigma)));
+        sum += weights.back();
+      }
+
+      std::vector<float> result(data.size());
+      for (unsigned int z = 0; z < dimensions[2]; ++z)
+        for (unsigned int y = 0; y < dimensions[1]; ++y)
+          for (unsigned int x = 0; x < dimensions[0]; ++x)
+          {
+            const unsigned int position[3] = { x, y, z };
+            const unsigned int index = x + y * strides[1] + z * strides[2];
+            const unsigned int lineStart = index - position[axis] * strides[axis];
+
+            double value = 0.0;
+            for (int k = -radius; k <= radius; ++k)
+            {
+              int neighbor = static_cast<int>(position[axis]) + k;
+              neighbor = std::max(0, std::min(static_cast<int>(dimensions[axis]) - 1, neighbor));
+              value += weights[k + radius] / sum * data[lineStart + neighbor * strides[axis]];
+            }
+            result[index] = static_cast<float>(value);
+          }
+      data.swap(result);
+    }
+    return data;
+  }
+
+  mitk::Image::Pointer ExtractSlice(const mitk::PlaneGeometry* plane, bool linear, bool useAccelerator)
+  {
+    mitk::ExtractSliceFilter::Pointer extractor = mitk::ExtractSliceFilter::New();
+    extractor->SetInput(m_Random3DImage);
+    extractor->SetWorldGeometry(plane);
+    extractor->SetResliceTransformByGeometry(m_Random3DImage->GetGeometry());
+    extractor->SetInterpolationMode(linear ? mitk::ExtractSliceFilter::RESLICE_LINEAR : mitk::ExtractSliceFilter::RESLICE_NEAREST);
+    extractor->SetUseAccelerator(useAccelerator);
+    extractor->Update();
+    return extractor->GetOutput();
+  }
+
+  /** Compares two slices, the tolerance allows for rounding differences of the interpolation in single precision */
+  void CompareSlices(mitk::Image* reference, mitk::Image* slice, int tolerance, const std::string& message)
+  {
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(message, reference->GetDimension(0), slice->GetDimension(0));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(message, reference->GetDimension(1), slice->GetDimension(1));
+
+    mitk::ImageReadAccessor referenceAccessor(reference);
+    mitk::ImageReadAccessor sliceAccessor(slice);
+    const unsigned char* referenceData = static_cast<const unsigned char*>(referenceAccessor.GetData());
+    const unsigned char* sliceData = static_cast<const unsigned char*>(sliceAccessor.GetData());
+
+    unsigned int differences = 0;
+    for (unsigned int i = 0; i < reference->GetDimension(0) * reference->GetDimension(1); ++i)
+    {
+      if (std::abs(referenceData[i] - sliceData[i]) > tolerance)
+        ++differences;
+    }
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(message, 0u, differences);
+  }
+
+public:
+
+  void setUp()
+  {
+    //Random input image with anisotropic spacing
+    m_Random3DImage = mitk::ImageGenerator::GenerateRandomImage<unsigned char>(64, 48, 24, 1,  // dimension
+                                                                               0.8f, 1.0f, 2.0f, // spacing
+                                                                               255, 0); // max, min
+
+    us::ServiceReference<mitk::IImageProcessingAccelerator> ref =
+      GetModuleContext()->GetServiceReference<mitk::IImageProcessingAccelerator>();
+    m_Accelerator = ref ? GetModuleContext()->GetService<mitk::IImageProcessingAccelerator>(ref) : nullptr;
+  }
+
+  void tearDown()
+  {
+    m_Random3DImage = nullptr;
+    m_Accelerator = nullptr;
+  }
+
+  void ServiceIsRegistered()
+  {
+    CPPUNIT_ASSERT_MESSAGE("The OpenCL module registers an image processing accelerator.", m_Accelerator != nullptr);
+  }
+
+  void GaussianSmooth_CompareToReference()
+  {
+    if (!this->IsDeviceSupported())
+      return;
+
+    const double sigma[3] = { 1.6, 1.0, 2.0 };
+    try
+    {
+      mitk::Image::Pointer outputImage = m_Accelerator->GaussianSmooth(m_Random3DImage, 0, sigma);
+      CPPUNIT_ASSERT(outputImage.IsNotNull());
+      CPPUNIT_ASSERT(outputImage->GetPixelType() == mitk::MakeScalarPixelType<float>());
+      MITK_ASSERT_EQUAL(m_Random3DImage->GetGeometry(), outputImage->GetGeometry(), "Smoothing keeps the geometry.");
+
+      std::vector<float> reference = this->SmoothOnCPU(sigma);
+      mitk::ImagePixelReadAccessor<float, 3> accessor(outputImage);
+      for (size_t i = 0; i < reference.size(); ++i)
+      {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(reference[i], accessor.GetData()[i], 1e-3);
+      }
+    }
+    catch(mitk::Exception &e)
+    {
+      std::string errorMessage = "Caught unexpected exception ";
+      errorMessage.append(e.what());
+      CPPUNIT_FAIL(errorMessage.c_str());
+    }
+  }
+
+  void Resample_OwnGeometry_EqualsInput()
+  {
+    if (!this->IsDeviceSupported())
+      return;
+
+    try
+    {
+      // voxel centers of the target are voxel centers of the input, both interpolations reproduce the input
+      mitk::Image::Pointer nearest = m_Accelerator->Resample(m_Random3DImage, 0, m_Random3DImage->GetGeometry(), false, 0.0);
+      MITK_ASSERT_EQUAL(m_Random3DImage, nearest, "Nearest neighbor resampling to the own grid should reproduce the input.");
+
+      mitk::Image::Pointer linear = m_Accelerator->Resample(m_Random3DImage, 0, m_Random3DImage->GetGeometry(), true, 0.0);
+      MITK_ASSERT_EQUAL(m_Random3DImage, linear, "Linear resampling to the own grid should reproduce the input.");
+    }
+    catch(mitk::Exception &e)
+    {
+      std::string errorMessage = "Caught unexpected exception ";
+      errorMessage.append(e.what());
+      CPPUNIT_FAIL(errorMessage.c_str());
+    }
+  }
+
+  void ExtractSliceFilter_Accelerated_CompareToCPU()
+  {
+    if (!this->IsDeviceSupported())
+      return;
+
+    mitk::PlaneGeometry::Pointer axialPlane = mitk::PlaneGeometry::New();
+    axialPlane->InitializeStandardPlane(m_Random3DImage->GetGeometry(), mitk::PlaneGeometry::Axial, 11, true, false);
+
+    mitk::PlaneGeometry::Pointer obliquePlane = axialPlane->Clone();
+    mitk::Vector3D rotationVector;
+    mitk::FillVector3D(rotationVector, 0.2, 0.4, 0.62);
+    mitk::RotationOperation op(mitk::OpROTATE, obliquePlane->GetCenter(), rotationVector, 37.0);
+    obliquePlane->ExecuteOperation(&op);
+
+    this->CompareSlices(this->ExtractSlice(axialPlane, false, false), this->ExtractSlice(axialPlane, false, true), 0,
+                        "Axial slice with nearest neighbor interpolation");
+    this->CompareSlices(this->ExtractSlice(obliquePlane, false, false), this->ExtractSlice(obliquePlane, false, true), 0,
+                        "Oblique slice with nearest neighbor interpolation");
+    this->CompareSlices(this->ExtractSlice(obliquePlane, true, false), this->ExtractSlice(obliquePlane, true, true), 1,
+                        "Oblique slice with linear interpolation");
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkOclImageProcessingAccelerator)
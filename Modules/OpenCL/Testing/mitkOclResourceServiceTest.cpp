@@ -18,6 +18,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkOclUtils.h>
 #include <mitkOclResourceService.h>
 #include <mitkException.h>
+#include <mitkIOUtil.h>
+
+#include <itksys/Directory.hxx>
+#include <itksys/SystemTools.hxx>
 
 #include <usModuleContext.h>
 #include <usGetModuleContext.h>
@@ -103,5 +107,45 @@ int mitkOclResourceServiceTest( int /*argc*/, char* /*argv*/[] )
   // the second test program should no more exist in the storage, hence we await an exception
   MITK_TEST_FOR_EXCEPTION( mitk::Exception, resources->GetProgram("test_program_failed"); );
 
+  // the program binary cache stores the binary on first build and is used for the following builds
+  const std::string cacheDirectory = mitk::IOUtil::CreateTemporaryDirectory("OclProgramCacheTest_XXXXXX");
+  const std::string previousCacheDirectory = resources->GetProgramCacheDirectory();
+  resources->SetProgramCacheDirectory(cacheDirectory);
+  MITK_TEST_CONDITION( resources->GetProgramCacheDirectory() == cacheDirectory, "Program cache directory set.");
+
+  std::vector<std::string> cachedSources(1, testProgramSource);
+  cl_program uncachedProgram = resources->BuildProgram(cachedSources, "-cl-mad-enable", &err);
+  MITK_TEST_CONDITION_REQUIRED( err == CL_SUCCESS && uncachedProgram != nullptr, "Test program built from source.");
+
+  itksys::Directory directory;
+  directory.Load(cacheDirectory.c_str());
+  // the listing contains "." and ".."
+  MITK_TEST_CONDITION( directory.GetNumberOfFiles() == 3, "Program binary stored in the cache directory.");
+
+  cl_program cachedProgram = resources->BuildProgram(cachedSources, "-cl-mad-enable", &err);
+  MITK_TEST_CONDITION( err == CL_SUCCESS && cachedProgram != nullptr, "Test program built from cached binary.");
+
+  cl_kernel cachedKernel = clCreateKernel( cachedProgram, "testKernel", &err );
+  MITK_TEST_CONDITION( err == CL_SUCCESS, "Kernel created from cached binary.");
+  clReleaseKernel( cachedKernel );
+
+  // other build options are a different cache entry
+  cl_program otherOptionsProgram = resources->BuildProgram(cachedSources, "", &err);
+  MITK_TEST_CONDITION( err == CL_SUCCESS, "Test program built with other options.");
+  directory.Load(cacheDirectory.c_str());
+  MITK_TEST_CONDITION( directory.GetNumberOfFiles() == 4, "Build options are part of the cache key.");
+
+  clReleaseProgram( uncachedProgram );
+  clReleaseProgram( cachedProgram );
+  clReleaseProgram( otherOptionsProgram );
+
+  // registered programs are built in the background, GetProgram waits for them
+  resources->RegisterProgram("test_program_prewarmed", cachedSources, "");
+  MITK_TEST_CONDITION( resources->GetProgram("test_program_prewarmed") != nullptr, "Prewarmed program available.");
+  resources->RemoveProgram("test_program_prewarmed");
+
+  resources->SetProgramCacheDirectory(previousCacheDirectory);
+  itksys::SystemTools::RemoveADirectory(cacheDirectory.c_str());
+
   MITK_TEST_END();
 }
@@ -0,0 +1,100 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkImage.h>
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+
+#include <mitkImageGenerator.h>
+#include <mitkImageToItk.h>
+
+#include <mitkOclSymmetricForcesDemonsRegistrationFilter.h>
+#include <mitkException.h>
+
+#include <itkImageRegionConstIterator.h>
+
+class mitkOclSymmetricForcesDemonsRegistrationFilterTestSuite : public mitk::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(mitkOclSymmetricForcesDemonsRegistrationFilterTestSuite);
+  MITK_TEST(SetFixedImage_2DImage_ThrowsException);
+  MITK_TEST(Update_IdenticalImages_ZeroField);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  /** Members used inside the different (sub-)tests. All members are initialized via setUp().
+    */
+  mitk::OclSymmetricForcesDemonsRegistrationFilter::Pointer m_DemonsFilter;
+
+  mitk::Image::Pointer m_Random2DImage;
+  mitk::Image::Pointer m_Gradient3DImage;
+
+public:
+
+  void setUp()
+  {
+    m_Gradient3DImage = mitk::ImageGenerator::GenerateGradientImage<float>(40, 30, 20, 1.0f, 1.5f, 2.0f);
+
+    m_Random2DImage = mitk::ImageGenerator::GenerateRandomImage<unsigned char>(119, 204, 0, 0,   // dimension
+                                                                               1.0f, 1.0f, 1.0f, // spacing
+                                                                               255, 0); // max, min
+    m_DemonsFilter = mitk::OclSymmetricForcesDemonsRegistrationFilter::New();
+  }
+
+  void tearDown()
+  {
+    m_DemonsFilter = nullptr;
+  }
+
+  void SetFixedImage_2DImage_ThrowsException()
+  {
+    CPPUNIT_ASSERT_THROW( m_DemonsFilter->SetFixedImage( m_Random2DImage ), mitk::Exception );
+    CPPUNIT_ASSERT_THROW( m_DemonsFilter->SetMovingImage( m_Random2DImage ), mitk::Exception );
+  }
+
+  void Update_IdenticalImages_ZeroField()
+  {
+    try{
+      m_DemonsFilter->SetFixedImage( m_Gradient3DImage );
+      m_DemonsFilter->SetMovingImage( m_Gradient3DImage );
+      m_DemonsFilter->SetNumberOfLevels( 3 );
+      m_DemonsFilter->SetNumberOfIterations( 10 );
+      m_DemonsFilter->Update();
+
+      mitk::Image::Pointer field = m_DemonsFilter->GetDisplacementField();
+      CPPUNIT_ASSERT( field.IsNotNull() );
+      CPPUNIT_ASSERT_EQUAL( 3u, field->GetPixelType().GetNumberOfComponents() );
+      CPPUNIT_ASSERT( mitk::Equal( *(m_Gradient3DImage->GetGeometry()), *(field->GetGeometry()), mitk::eps, true ) );
+
+      typedef itk::Image<itk::Vector<float, 3>, 3> FieldType;
+      FieldType::ConstPointer itkField = mitk::ImageToItkImage<itk::Vector<float, 3>, 3>( field.GetPointer() );
+      itk::ImageRegionConstIterator<FieldType> iter( itkField, itkField->GetLargestPossibleRegion() );
+      for (; !iter.IsAtEnd(); ++iter)
+      {
+        CPPUNIT_ASSERT_MESSAGE( "Identical images do not need a displacement", iter.Get().GetNorm() < 1e-3 );
+      }
+    }
+    catch(mitk::Exception &e)
+    {
+      std::string errorMessage = "Caught unexpected exception ";
+      errorMessage.append(e.what());
+      CPPUNIT_FAIL(errorMessage.c_str());
+    }
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkOclSymmetricForcesDemonsRegistrationFilter)
@@ -2,7 +2,9 @@ set(CPP_FILES
 # helper classes
   mitkOclUtils.cpp
   mitkOclResourceServiceImpl_Private.cpp
+  mitkOclProgramBinaryCache_Private.cpp
   mitkOclImageFormats.cpp
+  mitkOclImageProcessingAcceleratorImpl_Private.cpp
 
 # module activator
   mitkOpenCLActivator.cpp
@@ -19,8 +21,14 @@ set(CPP_FILES
 
 # own filter implementations
   mitkOclBinaryThresholdImageFilter.cpp
+  mitkOclGaussianImageFilter.cpp
+  mitkOclResampleImageFilter.cpp
+  mitkOclSymmetricForcesDemonsRegistrationFilter.cpp
 )
 
 set(RESOURCE_FILES
   BinaryThresholdFilter.cl
+  GaussianFilter.cl
+  ResampleFilter.cl
+  SymmetricForcesDemons.cl
 )
@@ -46,6 +46,9 @@ public:
   */
   void SetInput(Image::Pointer image);
 
+  /** @brief Set the output of another OpenCL filter as input, the data stays on the device */
+  using OclImageToImageFilter::SetInput;
+
   /** Update the filter */
   void Update();
 
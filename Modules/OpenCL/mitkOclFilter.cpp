@@ -247,7 +247,7 @@ void mitk::OclFilter::LoadSourceFiles(CStringList &sourceCode, ClSizeList &sourc
 void mitk::OclFilter::CompileSource()
 {
   // helper variable
-  int clErr = 0;
+  cl_int clErr = 0;
   CStringList sourceCode;
   ClSizeList sourceCodeSize;
 
@@ -261,26 +261,36 @@ void mitk::OclFilter::CompileSource()
   us::ServiceReference<OclResourceService> ref = GetModuleContext()->GetServiceReference<OclResourceService>();
   OclResourceService* resources = GetModuleContext()->GetService<OclResourceService>(ref);
 
-  cl_context gpuContext = resources->GetContext();
   // load the program source from file
   LoadSourceFiles(sourceCode, sourceCodeSize);
 
   if ( !sourceCode.empty() )
   {
-    // create program from all files in the file list
-    m_ClProgram = clCreateProgramWithSource(gpuContext, sourceCode.size(), &sourceCode[0], &sourceCodeSize[0], &clErr);
-    CHECK_OCL_ERR(clErr);
+    std::vector<std::string> sources(sourceCode.begin(), sourceCode.end());
+
+    // free the char buffers with the source code
+    for( CStringList::iterator it = sourceCode.begin(); it != sourceCode.end(); ++it )
+    {
+      delete[] *it;
+    }
 
-    // build the source code
+    // build the source code, the resource service takes the binary from its cache if available
     MITK_DEBUG << "Building Program Source";
     std::string compilerOptions = "";
     compilerOptions.append(m_ClCompilerFlags);
 
     MITK_DEBUG("ocl.filter") << "cl compiler flags: " << compilerOptions.c_str();
 
-    clErr = clBuildProgram(m_ClProgram, 0, nullptr, compilerOptions.c_str(), nullptr, nullptr);
+    m_ClProgram = resources->BuildProgram(sources, compilerOptions, &clErr);
     CHECK_OCL_ERR(clErr);
 
+    if (m_ClProgram == nullptr)
+    {
+      MITK_ERROR("ocl.filter") << "Failed to create program";
+      m_Initialized = false;
+      return;
+    }
+
     // if OpenCL Source build failed
     if (clErr != CL_SUCCESS)
     {
@@ -292,12 +302,6 @@ void mitk::OclFilter::CompileSource()
 
     // store the succesfully build program into the program storage provided by the resource service
     resources->InsertProgram(m_ClProgram, m_FilterID, true);
-
-    // free the char buffers with the source code
-    for( CStringList::iterator it = sourceCode.begin(); it != sourceCode.end(); ++it )
-    {
-      delete[] *it;
-    }
   }
   else
   {
@@ -306,6 +310,31 @@ void mitk::OclFilter::CompileSource()
   }
 }
 
+void mitk::OclFilter::PrewarmProgram()
+{
+  CStringList sourceCode;
+  ClSizeList sourceCodeSize;
+
+  if (m_ClFiles.empty())
+  {
+    MITK_ERROR("ocl.filter") << "No shader source file was set";
+    return;
+  }
+
+  LoadSourceFiles(sourceCode, sourceCodeSize);
+
+  std::vector<std::string> sources(sourceCode.begin(), sourceCode.end());
+  for( CStringList::iterator it = sourceCode.begin(); it != sourceCode.end(); ++it )
+  {
+    delete[] *it;
+  }
+
+  us::ServiceReference<OclResourceService> ref = GetModuleContext()->GetServiceReference<OclResourceService>();
+  OclResourceService* resources = GetModuleContext()->GetService<OclResourceService>(ref);
+
+  resources->RegisterProgram(m_FilterID, sources, m_ClCompilerFlags);
+}
+
 void mitk::OclFilter::SetWorkingSize(unsigned int locx, unsigned int dimx, unsigned int locy, unsigned int dimy, unsigned int locz, unsigned int dimz)
 {
   // set the local work size
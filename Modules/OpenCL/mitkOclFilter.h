@@ -53,6 +53,16 @@ public:
     */
   void SetCompilerFlags(const char* flags);
 
+  /**
+    * @brief Build the program of the filter in the background, before the filter is initialized
+    *
+    * The program is registered with the OclResourceService, which builds it in a separate thread (or
+    * loads it from the on-disk binary cache). Initialize() then takes the program from the service instead
+    * of compiling it. Has to be called after the source files, the preambel and the compiler flags are set,
+    * e.g. on application start.
+    */
+  void PrewarmProgram();
+
   /**
     * @brief Returns true if the initialization was successfull
     */
@@ -0,0 +1,223 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkOclGaussianImageFilter.h"
+#include "usServiceReference.h"
+
+#include <cmath>
+
+mitk::OclGaussianImageFilter::OclGaussianImageFilter()
+: m_ckConvert( nullptr ),
+  m_ckConvolve( nullptr ),
+  m_TemporaryBuffer( nullptr ),
+  m_TemporaryBufferSize( 0 )
+{
+  this->AddSourceFile("GaussianFilter.cl");
+  this->m_FilterID = "Gaussian";
+
+  this->SetSigma( 1.0 );
+}
+
+mitk::OclGaussianImageFilter::~OclGaussianImageFilter()
+{
+  this->ReleaseKernels();
+
+  if ( this->m_TemporaryBuffer )
+  {
+    clReleaseMemObject( m_TemporaryBuffer );
+  }
+}
+
+void mitk::OclGaussianImageFilter::ReleaseKernels()
+{
+  if ( this->m_ckConvert )
+  {
+    clReleaseKernel( m_ckConvert );
+    m_ckConvert = nullptr;
+  }
+  if ( this->m_ckConvolve )
+  {
+    clReleaseKernel( m_ckConvolve );
+    m_ckConvolve = nullptr;
+  }
+}
+
+void mitk::OclGaussianImageFilter::Update()
+{
+  // the program is compiled for the type of the input
+  if ( this->SelectProgramForInputType("Gaussian") )
+  {
+    this->ReleaseKernels();
+  }
+
+  //Check if context & program available
+  if (!this->Initialize())
+  {
+    us::ServiceReference<OclResourceService> ref = GetModuleContext()->GetServiceReference<OclResourceService>();
+    OclResourceService* resources = GetModuleContext()->GetService<OclResourceService>(ref);
+
+    // clean-up also the resources
+    resources->InvalidateStorage();
+    mitkThrow() <<"Filter is not initialized. Cannot update.";
+  }
+  else{
+    // Execute
+    this->Execute();
+  }
+}
+
+std::vector<float> mitk::OclGaussianImageFilter::ComputeWeights(int radius[3])
+{
+  const mitk::Vector3D spacing = m_Input->GetMITKImage()->GetGeometry()->GetSpacing();
+
+  std::vector<float> weights;
+  for ( unsigned int axis = 0; axis < 3; ++axis )
+  {
+    // standard deviation in voxels
+    const double sigma = m_Sigma[axis] / spacing[axis];
+    radius[axis] = sigma > 0.0 ? static_cast<int>( std::ceil( 3.0 * sigma ) ) : 0;
+
+    const size_t first = weights.size();
+    double sum = 0.0;
+    for ( int k = -radius[axis]; k <= radius[axis]; ++k )
+    {
+      const double weight = sigma > 0.0 ? std::exp( -0.5 * k * k / ( sigma * sigma ) ) : 1.0;
+      weights.push_back( static_cast<float>( weight ) );
+      sum += weight;
+    }
+
+    for ( size_t i = first; i < weights.size(); ++i )
+    {
+      weights[i] = static_cast<float>( weights[i] / sum );
+    }
+  }
+  return weights;
+}
+
+void mitk::OclGaussianImageFilter::Execute()
+{
+  cl_int clErr = 0;
+
+  try
+  {
+    this->InitExec( this->m_ckConvert );
+  }
+  catch( const mitk::Exception& e)
+  {
+    MITK_ERROR << "Catched exception while initializing filter: " << e.what();
+    return;
+  }
+
+  us::ServiceReference<OclResourceService> ref = GetModuleContext()->GetServiceReference<OclResourceService>();
+  OclResourceService* resources = GetModuleContext()->GetService<OclResourceService>(ref);
+
+  cl_uint uiWidth = m_Input->GetDimension(0);
+  cl_uint uiHeight = m_Input->GetDimension(1);
+  cl_uint uiDepth = m_Input->GetDimension(2);
+
+  // the passes alternate between the temporary buffer and the output buffer
+  const size_t bufferSize = m_Output->GetBufferSizeInBytes();
+  if ( m_TemporaryBuffer == nullptr || m_TemporaryBufferSize != bufferSize )
+  {
+    if ( m_TemporaryBuffer )
+      clReleaseMemObject( m_TemporaryBuffer );
+
+    m_TemporaryBuffer = clCreateBuffer( resources->GetContext(), CL_MEM_READ_WRITE, bufferSize, nullptr, &clErr );
+    m_TemporaryBufferSize = bufferSize;
+    CHECK_OCL_ERR( clErr );
+  }
+
+  int radius[3];
+  std::vector<float> weights = this->ComputeWeights( radius );
+  cl_mem clWeights = clCreateBuffer( resources->GetContext(), CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+                                     weights.size() * sizeof(float), weights.data(), &clErr );
+  CHECK_OCL_ERR( clErr );
+
+  if ( m_TemporaryBuffer == nullptr || clWeights == nullptr )
+  {
+    MITK_ERROR << "Could not allocate the buffers of the filter.";
+    if ( clWeights )
+      clReleaseMemObject( clWeights );
+    return;
+  }
+
+  // convert the input to float into the temporary buffer
+  clErr = clSetKernelArg( this->m_ckConvert, 1, sizeof(cl_mem), &(this->m_TemporaryBuffer) );
+  CHECK_OCL_ERR( clErr );
+  this->ExecuteKernel( m_ckConvert, 3 );
+
+  // x: temporary -> output, y: output -> temporary, z: temporary -> output
+  cl_mem clOutput = m_Output->GetGPUBuffer();
+  cl_mem sources[3] = { m_TemporaryBuffer, clOutput, m_TemporaryBuffer };
+  cl_mem destinations[3] = { clOutput, m_TemporaryBuffer, clOutput };
+
+  cl_uint weightOffset = 0;
+  for ( cl_uint axis = 0; axis < 3; ++axis )
+  {
+    clErr =  clSetKernelArg( this->m_ckConvolve, 0, sizeof(cl_mem), &(sources[axis]) );
+    clErr |= clSetKernelArg( this->m_ckConvolve, 1, sizeof(cl_mem), &(destinations[axis]) );
+    clErr |= clSetKernelArg( this->m_ckConvolve, 2, sizeof(cl_mem), &clWeights );
+    clErr |= clSetKernelArg( this->m_ckConvolve, 3, sizeof(cl_uint), &weightOffset );
+    clErr |= clSetKernelArg( this->m_ckConvolve, 4, sizeof(cl_int), &(radius[axis]) );
+    clErr |= clSetKernelArg( this->m_ckConvolve, 5, sizeof(cl_uint), &axis );
+    clErr |= clSetKernelArg( this->m_ckConvolve, 6, sizeof(cl_uint), &uiWidth );
+    clErr |= clSetKernelArg( this->m_ckConvolve, 7, sizeof(cl_uint), &uiHeight );
+    clErr |= clSetKernelArg( this->m_ckConvolve, 8, sizeof(cl_uint), &uiDepth );
+    CHECK_OCL_ERR( clErr );
+
+    this->ExecuteKernel( m_ckConvolve, 3 );
+
+    weightOffset += 2 * radius[axis] + 1;
+  }
+
+  // the buffer is released by OpenCL after the kernels finished
+  clReleaseMemObject( clWeights );
+
+  // signalize the GPU-side data changed
+  m_Output->Modified( GPU_DATA );
+}
+
+us::Module *mitk::OclGaussianImageFilter::GetModule()
+{
+  return us::GetModuleContext()->GetModule();
+}
+
+bool mitk::OclGaussianImageFilter::Initialize()
+{
+  bool buildErr = true;
+  cl_int clErr = 0;
+
+  if ( OclFilter::Initialize() && this->m_ckConvert == nullptr )
+  {
+    this->m_ckConvert = clCreateKernel( this->m_ClProgram, "ckGaussianConvert", &clErr);
+    buildErr |= CHECK_OCL_ERR( clErr );
+
+    this->m_ckConvolve = clCreateKernel( this->m_ClProgram, "ckGaussianConvolve", &clErr);
+    buildErr |= CHECK_OCL_ERR( clErr );
+  }
+
+  return (OclFilter::IsInitialized() && buildErr );
+}
+
+void mitk::OclGaussianImageFilter::SetInput(mitk::Image::Pointer image)
+{
+  if(image->GetDimension() != 3)
+  {
+    mitkThrowException(mitk::Exception) << "Input for " << this->GetNameOfClass() <<
+                                           " is not 3D. The filter only supports 3D. Please change your input.";
+  }
+  OclImageToImageFilter::SetInput(image);
+}
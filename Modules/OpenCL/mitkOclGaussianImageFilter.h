@@ -0,0 +1,123 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef _MITKOCLGAUSSIANIMAGEFILTER_H_
+#define _MITKOCLGAUSSIANIMAGEFILTER_H_
+
+#include "mitkOclImageToImageFilter.h"
+#include <itkObject.h>
+
+#include <vector>
+
+namespace mitk
+{
+class OclImageToImageFilter;
+
+/** Documentation
+  *
+  * \brief The OclGaussianImageFilter smoothes an image with a Gaussian kernel.
+  *
+  * The convolution is separated into three passes along the image axes, the sampled kernel is cut off at three
+  * standard deviations and normalized. Voxels outside of the image are replaced by the nearest border voxel.
+  * Input images of type unsigned char, short and float are supported, the output is of type float.
+  */
+class MITKOPENCL_EXPORT OclGaussianImageFilter : public OclImageToImageFilter, public itk::Object
+{
+
+public:
+  mitkClassMacroItkParent(OclGaussianImageFilter, itk::Object);
+  itkNewMacro(Self);
+
+  /**
+  * @brief SetInput Set the input image. Only 3D images are supported for now.
+  * @param image a 3D image.
+  * @throw mitk::Exception if the dimesion is not 3.
+  */
+  void SetInput(Image::Pointer image);
+
+  /** @brief Set the output of another OpenCL filter as input, the data stays on the device */
+  using OclImageToImageFilter::SetInput;
+
+  /** Update the filter */
+  void Update();
+
+  /** Set the standard deviation of the Gaussian for all axes
+    @param sigma Standard deviation in mm
+    */
+  void SetSigma( double sigma )
+  {
+    this->m_Sigma[0] = this->m_Sigma[1] = this->m_Sigma[2] = sigma;
+  }
+
+  /** Set the standard deviation of the Gaussian per axis
+    @param sigma Standard deviations in mm, 0 disables the smoothing along an axis
+    */
+  void SetSigma( const double sigma[3] )
+  {
+    this->m_Sigma[0] = sigma[0];
+    this->m_Sigma[1] = sigma[1];
+    this->m_Sigma[2] = sigma[2];
+  }
+
+protected:
+
+  /** Constructor */
+  OclGaussianImageFilter();
+
+  /** Destructor */
+  virtual ~OclGaussianImageFilter();
+
+  /** Initialize the filter */
+  bool Initialize();
+
+  void Execute();
+
+  mitk::PixelType GetOutputType()
+  {
+    return mitk::MakeScalarPixelType<float>();
+  }
+
+  int GetBytesPerElem()
+  {
+    return sizeof(float);
+  }
+
+  virtual us::Module* GetModule();
+
+private:
+  /** Releases the kernels, e.g. if the program changes with the input type */
+  void ReleaseKernels();
+
+  /** @brief Computes the normalized weights of all axes, the weights of an axis are 2 * radius + 1 values */
+  std::vector<float> ComputeWeights(int radius[3]);
+
+  /** The OpenCL kernel converting the input to float */
+  cl_kernel m_ckConvert;
+
+  /** The OpenCL kernel convolving along one axis */
+  cl_kernel m_ckConvolve;
+
+  /** Intermediate result of the passes, of the size of the output */
+  cl_mem m_TemporaryBuffer;
+
+  size_t m_TemporaryBufferSize;
+
+  double m_Sigma[3];
+};
+}
+
+
+#endif
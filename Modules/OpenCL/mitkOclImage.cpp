@@ -22,10 +22,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkOclUtils.h"
 
 #include <mitkImageReadAccessor.h>
+#include <cstring>
 #include <fstream>
 
 mitk::OclImage::OclImage() : m_gpuImage(nullptr), m_context(nullptr), m_bufferSize(0), m_gpuModified(false), m_cpuModified(false),
-  m_Image(nullptr), m_dim(0), m_Dims(nullptr), m_BpE(1), m_formatSupported(false)
+  m_Image(nullptr), m_dim(0), m_Dims(nullptr), m_BpE(1), m_formatSupported(false),
+  m_gpuImageFromBuffer(nullptr), m_gpuImageFromBufferOutdated(true),
+  m_pinnedBuffer(nullptr), m_pinnedData(nullptr), m_pinnedSize(0), m_pinnedQueue(nullptr),
+  m_transferEvent(nullptr)
 {
 }
 
@@ -33,7 +37,16 @@ mitk::OclImage::~OclImage()
 {
   MITK_INFO << "OclImage Destructor";
 
+  // a running download writes to the pinned memory
+  if (m_transferEvent)
+  {
+    clWaitForEvents(1, &m_transferEvent);
+    clReleaseEvent(m_transferEvent);
+  }
+  this->ReleasePinnedMemory();
+
   //release GMEM Image buffer
+  if (m_gpuImageFromBuffer) clReleaseMemObject(m_gpuImageFromBuffer);
   if (m_gpuImage) clReleaseMemObject(m_gpuImage);
 }
 
@@ -56,6 +69,17 @@ cl_mem mitk::OclImage::CreateGPUImage(unsigned int _wi, unsigned int _he, unsign
 
   m_BpE = _bpp;
 
+  // release the objects of a previous update, the size may differ
+  if (this->IsTransferPending())
+    this->FinishTransferToCPU();
+  if (m_gpuImageFromBuffer)
+  {
+    clReleaseMemObject(m_gpuImageFromBuffer);
+    m_gpuImageFromBuffer = nullptr;
+  }
+  if (m_gpuImage)
+    clReleaseMemObject(m_gpuImage);
+
   us::ServiceReference<OclResourceService> ref = GetModuleContext()->GetServiceReference<OclResourceService>();
   OclResourceService* resources = GetModuleContext()->GetService<OclResourceService>(ref);
 
@@ -104,6 +128,10 @@ void mitk::OclImage::Modified(int _type)
   // defines... GPU: 0, CPU: 1
   m_cpuModified = _type;
   m_gpuModified = !_type;
+
+  // the image object created from the buffer has to be updated before the next filter reads it
+  if (_type == GPU_DATA)
+    m_gpuImageFromBufferOutdated = true;
 }
 
 int mitk::OclImage::TransferDataToGPU(cl_command_queue gpuComQueue)
@@ -122,7 +150,7 @@ int mitk::OclImage::TransferDataToGPU(cl_command_queue gpuComQueue)
     //check the buffer
     if(m_gpuImage == nullptr)
     {
-      clErr = this->AllocateGPUImage();
+      clErr = this->AllocateGPUImage(&m_gpuImage);
     }
 
     if (m_Image->IsInitialized() &&
@@ -149,7 +177,7 @@ int mitk::OclImage::TransferDataToGPU(cl_command_queue gpuComQueue)
   return clErr;
 }
 
-cl_int mitk::OclImage::AllocateGPUImage()
+cl_int mitk::OclImage::AllocateGPUImage(cl_mem* image)
 {
   cl_int clErr = 0;
 
@@ -194,7 +222,7 @@ cl_int mitk::OclImage::AllocateGPUImage()
     //Create a 2D Image
     imageDescriptor.image_type = CL_MEM_OBJECT_IMAGE2D;
   }
-  m_gpuImage = clCreateImage(gpuContext, CL_MEM_READ_ONLY, &m_supportedFormat, &imageDescriptor, nullptr, &clErr);
+  *image = clCreateImage(gpuContext, CL_MEM_READ_ONLY, &m_supportedFormat, &imageDescriptor, nullptr, &clErr);
 
   CHECK_OCL_ERR(clErr);
 
@@ -204,7 +232,7 @@ cl_int mitk::OclImage::AllocateGPUImage()
 cl_mem mitk::OclImage::GetGPUImage(cl_command_queue gpuComQueue)
 {
   // clGetMemObjectInfo()
-  cl_mem_object_type memInfo;
+  cl_mem_object_type memInfo = 0;
   cl_int clErr = 0;
 
   // query image object info only if already initialized
@@ -214,30 +242,36 @@ cl_mem mitk::OclImage::GetGPUImage(cl_command_queue gpuComQueue)
     CHECK_OCL_ERR(clErr);
   }
 
-  MITK_INFO << "Querying info for object, recieving: " << memInfo;
+  MITK_DEBUG << "Querying info for object, recieving: " << memInfo;
 
   // test if m_gpuImage CL_MEM_IMAGE_2/3D
-  // if not, copy buffer to image
+  // if not, copy buffer to image on the device, the buffer stays the output of the filter
   if (memInfo == CL_MEM_OBJECT_BUFFER)
   {
-    MITK_WARN << " Passed oclImage is a buffer-object, creating image";
+    if (m_gpuImageFromBuffer == nullptr)
+    {
+      MITK_DEBUG << "Passed oclImage is a buffer-object, creating image";
 
-    //hold a copy of the buffer gmem pointer
-    cl_mem tempBuffer = this->m_gpuImage;
+      clErr = this->AllocateGPUImage(&m_gpuImageFromBuffer);
+      if (clErr != CL_SUCCESS)
+        return nullptr;
 
-    const size_t origin[3] = {0, 0, 0};
-    size_t region[3] = {this->m_Dims[0], this->m_Dims[1], 1};
+      m_gpuImageFromBufferOutdated = true;
+    }
 
-    clErr = this->AllocateGPUImage();
+    if (m_gpuImageFromBufferOutdated)
+    {
+      const size_t origin[3] = {0, 0, 0};
+      const size_t region[3] = {this->m_Dims[0], this->m_Dims[1], this->m_Dims[2]};
 
-    this->m_dim = 3;
+      //copy last data to the image data
+      clErr = clEnqueueCopyBufferToImage( gpuComQueue, m_gpuImage, m_gpuImageFromBuffer, 0, origin, region, 0, nullptr, nullptr);
+      CHECK_OCL_ERR(clErr);
 
-    //copy last data to the image data
-    clErr = clEnqueueCopyBufferToImage( gpuComQueue, tempBuffer, m_gpuImage, 0, origin, region, 0, nullptr, nullptr);
-    CHECK_OCL_ERR(clErr);
+      m_gpuImageFromBufferOutdated = (clErr != CL_SUCCESS);
+    }
 
-    //release pointer
-    clReleaseMemObject(tempBuffer);
+    return m_gpuImageFromBuffer;
   }
   return m_gpuImage;
 }
@@ -250,28 +284,133 @@ void mitk::OclImage::SetPixelType(const cl_image_format *_image)
 
 void* mitk::OclImage::TransferDataToCPU(cl_command_queue gpuComQueue)
 {
-  cl_int clErr = 0;
-
   // if image created on GPU, needs to create mitk::Image
   if( m_Image.IsNull() ){
     MITK_INFO << "Image not initialized, creating new one.";
     m_Image = mitk::Image::New();
   }
 
+  // a download started before is reused
+  if (!this->IsTransferPending() && this->EnqueueTransferToCPU(gpuComQueue) != CL_SUCCESS)
+    return nullptr;
+
+  void* pinnedData = this->FinishTransferToCPU();
+  if (pinnedData == nullptr)
+    return nullptr;
+
   // check buffersize/image size
   char* data = new char[m_bufferSize * m_BpE];
+  std::memcpy(data, pinnedData, m_bufferSize * m_BpE);
+
+  return (void*) data;
+}
+
+cl_int mitk::OclImage::EnqueueTransferToCPU(cl_command_queue gpuComQueue)
+{
+  if (m_gpuImage == nullptr)
+  {
+    MITK_ERROR("ocl.Image") << "No GPU buffer to transfer.";
+    return CL_INVALID_MEM_OBJECT;
+  }
+
+  // the pinned memory is reused, so a previous download has to be finished first
+  if (this->IsTransferPending())
+    this->FinishTransferToCPU();
 
-  // debug info
-  oclPrintMemObjectInfo( m_gpuImage );
+  const size_t size = m_bufferSize * m_BpE;
+  cl_int clErr = this->AllocatePinnedMemory(gpuComQueue, size);
+  if (clErr != CL_SUCCESS)
+    return clErr;
 
-  clErr = clEnqueueReadBuffer( gpuComQueue, m_gpuImage, CL_FALSE, 0, m_bufferSize * m_BpE, data ,0, nullptr, nullptr);
+  clErr = clEnqueueReadBuffer( gpuComQueue, m_gpuImage, CL_FALSE, 0, size, m_pinnedData, 0, nullptr, &m_transferEvent);
   CHECK_OCL_ERR(clErr);
 
+  if (clErr != CL_SUCCESS)
+  {
+    m_transferEvent = nullptr;
+    return clErr;
+  }
+
+  // start the transfer without waiting for it
   clFlush( gpuComQueue );
+  return clErr;
+}
+
+void* mitk::OclImage::FinishTransferToCPU()
+{
+  if (m_transferEvent == nullptr)
+    return m_gpuModified ? nullptr : m_pinnedData;
+
+  cl_int clErr = clWaitForEvents(1, &m_transferEvent);
+  CHECK_OCL_ERR(clErr);
+
+  cl_int status = CL_COMPLETE;
+  clGetEventInfo(m_transferEvent, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(cl_int), &status, nullptr);
+
+  clReleaseEvent(m_transferEvent);
+  m_transferEvent = nullptr;
+
+  if (clErr != CL_SUCCESS || status != CL_COMPLETE)
+    return nullptr;
+
   // the cpu data is same as gpu
   this->m_gpuModified = false;
 
-  return (void*) data;
+  return m_pinnedData;
+}
+
+cl_int mitk::OclImage::AllocatePinnedMemory(cl_command_queue gpuComQueue, size_t size)
+{
+  if (m_pinnedBuffer && m_pinnedSize == size)
+    return CL_SUCCESS;
+
+  this->ReleasePinnedMemory();
+
+  us::ServiceReference<OclResourceService> ref = GetModuleContext()->GetServiceReference<OclResourceService>();
+  OclResourceService* resources = GetModuleContext()->GetService<OclResourceService>(ref);
+
+  // CL_MEM_ALLOC_HOST_PTR lets the driver allocate page-locked memory, which is transferred by DMA without staging
+  cl_int clErr = 0;
+  m_pinnedBuffer = clCreateBuffer(resources->GetContext(), CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, size, nullptr, &clErr);
+  CHECK_OCL_ERR(clErr);
+  if (clErr != CL_SUCCESS)
+  {
+    m_pinnedBuffer = nullptr;
+    return clErr;
+  }
+
+  // map once and keep mapped, downloads write to the mapped host pointer
+  m_pinnedData = clEnqueueMapBuffer(gpuComQueue, m_pinnedBuffer, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0, size, 0, nullptr, nullptr, &clErr);
+  CHECK_OCL_ERR(clErr);
+  if (clErr != CL_SUCCESS)
+  {
+    clReleaseMemObject(m_pinnedBuffer);
+    m_pinnedBuffer = nullptr;
+    m_pinnedData = nullptr;
+    return clErr;
+  }
+
+  m_pinnedSize = size;
+  m_pinnedQueue = gpuComQueue;
+  return CL_SUCCESS;
+}
+
+void mitk::OclImage::ReleasePinnedMemory()
+{
+  if (m_pinnedBuffer == nullptr)
+    return;
+
+  if (m_pinnedData)
+  {
+    clEnqueueUnmapMemObject(m_pinnedQueue, m_pinnedBuffer, m_pinnedData, 0, nullptr, nullptr);
+    clFinish(m_pinnedQueue);
+  }
+  clReleaseMemObject(m_pinnedBuffer);
+
+  m_pinnedBuffer = nullptr;
+  m_pinnedData = nullptr;
+  m_pinnedSize = 0;
+  m_pinnedQueue = nullptr;
 }
 
 cl_image_format mitk::OclImage::ConvertPixelTypeToOCLFormat()
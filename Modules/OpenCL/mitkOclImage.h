@@ -43,6 +43,11 @@ namespace mitk {
   *  The class holds a pointer to the mitk::Image stored in RAM and performs an
   *  on-demand-copy to the graphics memory. It is the basic data structure for all
   *  mitk::oclImageToImageFilter classes
+  *
+  *  The output of an image filter stays in graphics memory and can be passed directly to the
+  *  next filter, which reads it through an image object created from the buffer on the device.
+  *  Data is copied back to RAM only on request, through page-locked (pinned) host memory, either
+  *  blocking (TransferDataToCPU()) or asynchronously (EnqueueTransferToCPU() and FinishTransferToCPU()).
   *  @throw This class may throw an ImageTypeIsNotSupportedByGPU, if the image
   *  format is supported by the GPU.
   */
@@ -56,9 +61,31 @@ public:
   /*!  \brief Copies the RAM-stored data to GMEM */
   virtual int TransferDataToGPU(cl_command_queue);
 
-  /*! \brief Copies the in GMEM stored data to RAM */
+  /*! \brief Copies the in GMEM stored data to RAM
+   *
+   *  Blocks until the data is available. The returned memory is allocated with new[] and owned by the caller.
+   */
   virtual void* TransferDataToCPU(cl_command_queue);
 
+  /*! \brief Starts copying the GMEM buffer to pinned host memory without waiting for the copy to finish
+   *
+   *  @return CL_SUCCESS or the OpenCL error of allocating the host memory or enqueueing the copy
+   */
+  cl_int EnqueueTransferToCPU(cl_command_queue);
+
+  /*! \brief Waits for the copy started by EnqueueTransferToCPU()
+   *
+   *  @return the pinned host memory holding the data, or nullptr if the copy failed. The memory is owned by the
+   *          OclImage and valid until the next transfer or its destruction.
+   */
+  void* FinishTransferToCPU();
+
+  /*! \brief Returns true if a copy started by EnqueueTransferToCPU() was not finished yet */
+  bool IsTransferPending() const
+  {
+    return this->m_transferEvent != nullptr;
+  }
+
   /*! \brief Returns the pointer to the referenced mitk::Image */
   Image::Pointer GetMITKImage()
   {
@@ -68,7 +95,9 @@ public:
   /*! \brief Checks whether gpuImage is a valid clImage object
 
     when an oclImage gets created by an image to image filter, the output image is created
-    by clCreateBuffer() because it is not in general possible to write to clImage directly
+    by clCreateBuffer() because it is not in general possible to write to clImage directly.
+    In this case, the buffer is copied on the device to an image object which is returned instead.
+    The buffer itself is kept, since the filter writes to it again on its next update.
     */
   cl_mem GetGPUImage(cl_command_queue);
 
@@ -130,6 +159,12 @@ public:
     return this->m_BpE;
   }
 
+  /** @brief Returns the size of the GMEM buffer in bytes */
+  size_t GetBufferSizeInBytes() const
+  {
+    return static_cast<size_t>(this->m_bufferSize) * this->m_BpE;
+  }
+
   /** @brief Get the currently used pixel type
 
       @returns OpenCL Image Format struct
@@ -165,6 +200,33 @@ private:
 
   cl_image_format ConvertPixelTypeToOCLFormat();
 
+  /*! Allocates the page-locked host buffer for downloads and maps it permanently */
+  cl_int AllocatePinnedMemory(cl_command_queue, size_t);
+
+  /*! Unmaps and releases the page-locked host buffer */
+  void ReleasePinnedMemory();
+
+  /*! GMEM Image object holding a copy of the buffer m_gpuImage, for filters reading through samplers */
+  cl_mem m_gpuImageFromBuffer;
+
+  /*! True if m_gpuImage was modified after the last copy to m_gpuImageFromBuffer */
+  bool m_gpuImageFromBufferOutdated;
+
+  /*! Page-locked host buffer for downloads */
+  cl_mem m_pinnedBuffer;
+
+  /*! Host pointer of the mapped pinned buffer */
+  void* m_pinnedData;
+
+  /*! Size of the pinned buffer in bytes */
+  size_t m_pinnedSize;
+
+  /*! Command queue the pinned buffer was mapped with, needed for unmapping */
+  cl_command_queue m_pinnedQueue;
+
+  /*! Event of the running download, nullptr if there is none */
+  cl_event m_transferEvent;
+
   bool m_gpuModified;
   bool m_cpuModified;
 
@@ -177,7 +239,8 @@ private:
 
   unsigned short m_BpE;
 
-  cl_int AllocateGPUImage();
+  /*! Creates an image object in the supported format for the current dimensions */
+  cl_int AllocateGPUImage(cl_mem* image);
 
   /** Bool flag to signalize if the proposed format is supported on currend HW.
       For value 'false', the transfer kernel has to be called to fit the data to
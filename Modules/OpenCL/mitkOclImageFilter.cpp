@@ -18,6 +18,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkOclFilter.h"
 #include "mitkOclImage.h"
 
+#include <usServiceReference.h>
+
 mitk::OclImageFilter::OclImageFilter()
 {
   // set the filter type to default value = SHORT
@@ -31,6 +33,9 @@ mitk::OclImageFilter::~OclImageFilter()
 void mitk::OclImageFilter::SetInput(mitk::OclImage::Pointer image)
 {
   m_Input = image;
+
+  // the input may be the output of another filter with a different pixel type
+  this->m_CurrentType = m_Input->GetBytesPerPixel() - 1;
 }
 
 void mitk::OclImageFilter::SetInput(mitk::Image::Pointer image)
@@ -44,3 +49,54 @@ void mitk::OclImageFilter::SetInput(mitk::Image::Pointer image)
   MITK_DEBUG << "Current Type is: " << this->m_CurrentType;
 }
 
+
+
+bool mitk::OclImageFilter::SelectProgramForInputType(const std::string& filterName)
+{
+  if (m_Input.IsNull())
+    mitkThrow() << "Input image is null.";
+
+  // the image formats are chosen by the size of the pixel type, see OclImage
+  const char* preambel = nullptr;
+  const char* typeName = nullptr;
+  switch (m_Input->GetBytesPerPixel())
+  {
+  case 1:
+    typeName = "uchar";
+    preambel = "#define INPUT_TYPE uchar\n"
+               "#define READ_INPUT(image, sampler, position) convert_float(read_imageui(image, sampler, position).x)\n"
+               "#define CONVERT_TO_INPUT_TYPE(value) convert_uchar_sat(floor((value) + 0.5f))\n";
+    break;
+  case 2:
+    typeName = "short";
+    preambel = "#define INPUT_TYPE short\n"
+               "#define READ_INPUT(image, sampler, position) convert_float(read_imagei(image, sampler, position).x)\n"
+               "#define CONVERT_TO_INPUT_TYPE(value) convert_short_sat(floor((value) + 0.5f))\n";
+    break;
+  case 4:
+    typeName = "float";
+    preambel = "#define INPUT_TYPE float\n"
+               "#define READ_INPUT(image, sampler, position) read_imagef(image, sampler, position).x\n"
+               "#define CONVERT_TO_INPUT_TYPE(value) (value)\n";
+    break;
+  default:
+    mitkThrow() << "Pixel type with " << m_Input->GetBytesPerPixel() << " bytes is not supported by " << filterName;
+  }
+
+  const std::string filterID = filterName + "_" + typeName;
+  if (m_ClProgram != nullptr && m_FilterID == filterID)
+    return false;
+
+  // release the program of the previous input type
+  if (m_ClProgram != nullptr)
+  {
+    us::ServiceReference<OclResourceService> ref = GetModuleContext()->GetServiceReference<OclResourceService>();
+    OclResourceService* resources = GetModuleContext()->GetService<OclResourceService>(ref);
+    resources->RemoveProgram(m_FilterID);
+    m_ClProgram = nullptr;
+  }
+
+  m_FilterID = filterID;
+  this->SetSourcePreambel(preambel);
+  return true;
+}
@@ -55,6 +55,21 @@ protected:
 
   virtual ~OclImageFilter();
 
+  /**
+   * @brief Select the program variant for the pixel type of the input
+   *
+   * For filters which support several input types, the program is compiled once per type. The preambel
+   * defines INPUT_TYPE (uchar, short or float), READ_INPUT(image, sampler, position), which reads a voxel of
+   * the input image as float, and CONVERT_TO_INPUT_TYPE(value), which rounds and saturates a float to the
+   * input type. The type is appended to the filter ID, so the variants are kept separately by the
+   * OclResourceService. Has to be called before Initialize().
+   *
+   * @param filterName The filter ID without the type
+   * @return true if the program was selected again, kernels of a previous program have to be created again
+   * @throws mitk::Exception if the pixel type of the input is not supported
+   */
+  bool SelectProgramForInputType(const std::string& filterName);
+
   /** The input image */
   mitk::OclImage::Pointer m_Input;
 
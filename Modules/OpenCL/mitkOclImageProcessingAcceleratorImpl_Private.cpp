@@ -0,0 +1,208 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkOclImageProcessingAcceleratorImpl_p.h"
+
+#include <mitkImageReadAccessor.h>
+#include <mitkImageTimeSelector.h>
+
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+
+#include <cstring>
+
+namespace
+{
+  /** vtk scalar type of the supported pixel types, -1 for unsupported types */
+  int GetVtkScalarType(const mitk::PixelType &pixelType)
+  {
+    switch (pixelType.GetComponentType())
+    {
+    case itk::ImageIOBase::UCHAR:
+      return VTK_UNSIGNED_CHAR;
+    case itk::ImageIOBase::SHORT:
+      return VTK_SHORT;
+    case itk::ImageIOBase::FLOAT:
+      return VTK_FLOAT;
+    default:
+      return -1;
+    }
+  }
+}
+
+OclImageProcessingAcceleratorImpl::OclImageProcessingAcceleratorImpl()
+  : m_DeviceImageSource(nullptr), m_DeviceImageTimeStep(0), m_DeviceImageMTime(0)
+{
+}
+
+OclImageProcessingAcceleratorImpl::~OclImageProcessingAcceleratorImpl()
+{
+}
+
+bool OclImageProcessingAcceleratorImpl::IsSupported(const mitk::Image *image, unsigned int timeStep)
+{
+  if (image == nullptr || !image->IsInitialized())
+    return false;
+
+  // the filters read 3D image objects
+  if (image->GetDimension() < 3 || image->GetDimension() > 4 || !image->GetTimeGeometry()->IsValidTimeStep(timeStep))
+    return false;
+
+  const mitk::PixelType pixelType = image->GetPixelType();
+  return pixelType.GetNumberOfComponents() == 1 && GetVtkScalarType(pixelType) != -1;
+}
+
+mitk::OclImage::Pointer OclImageProcessingAcceleratorImpl::GetDeviceImage(const mitk::Image *image, unsigned int timeStep)
+{
+  if (m_DeviceImage.IsNotNull() && m_DeviceImageSource == image && m_DeviceImageTimeStep == timeStep &&
+      m_DeviceImageMTime == image->GetMTime())
+  {
+    return m_DeviceImage;
+  }
+
+  mitk::Image::Pointer volume = const_cast<mitk::Image *>(image);
+  if (image->GetDimension() > 3)
+  {
+    mitk::ImageTimeSelector::Pointer timeSelector = mitk::ImageTimeSelector::New();
+    timeSelector->SetInput(image);
+    timeSelector->SetTimeNr(timeStep);
+    timeSelector->UpdateLargestPossibleRegion();
+    volume = timeSelector->GetOutput();
+  }
+
+  m_DeviceImage = mitk::OclImage::New();
+  m_DeviceImage->InitializeByMitkImage(volume);
+
+  m_DeviceImageSource = image;
+  m_DeviceImageTimeStep = timeStep;
+  m_DeviceImageMTime = image->GetMTime();
+
+  return m_DeviceImage;
+}
+
+mitk::Image::Pointer OclImageProcessingAcceleratorImpl::GaussianSmooth(const mitk::Image *input,
+                                                                       unsigned int timeStep,
+                                                                       const double sigma[3])
+{
+  if (!IsSupported(input, timeStep))
+    return nullptr;
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  try
+  {
+    if (m_GaussianFilter.IsNull())
+      m_GaussianFilter = mitk::OclGaussianImageFilter::New();
+
+    m_GaussianFilter->SetInput(this->GetDeviceImage(input, timeStep));
+    m_GaussianFilter->SetSigma(sigma);
+    m_GaussianFilter->Update();
+
+    // the filter reuses its output image
+    return m_GaussianFilter->GetOutput()->Clone();
+  }
+  catch (const mitk::Exception &e)
+  {
+    MITK_WARN("OpenCL") << "Gaussian smoothing on the device failed: " << e.what();
+  }
+  return nullptr;
+}
+
+mitk::Image::Pointer OclImageProcessingAcceleratorImpl::Resample(const mitk::Image *input,
+                                                                 unsigned int timeStep,
+                                                                 const mitk::BaseGeometry *targetGeometry,
+                                                                 bool linear,
+                                                                 double defaultValue)
+{
+  if (!IsSupported(input, timeStep) || targetGeometry == nullptr)
+    return nullptr;
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  try
+  {
+    if (m_ResampleFilter.IsNull())
+      m_ResampleFilter = mitk::OclResampleImageFilter::New();
+
+    m_ResampleFilter->SetInput(this->GetDeviceImage(input, timeStep));
+    m_ResampleFilter->SetReferenceGeometry(targetGeometry);
+    m_ResampleFilter->SetUseLinearInterpolation(linear);
+    m_ResampleFilter->SetDefaultValue(defaultValue);
+    m_ResampleFilter->Update();
+
+    // the filter reuses its output image
+    return m_ResampleFilter->GetOutput()->Clone();
+  }
+  catch (const mitk::Exception &e)
+  {
+    MITK_WARN("OpenCL") << "Resampling on the device failed: " << e.what();
+  }
+  return nullptr;
+}
+
+bool OclImageProcessingAcceleratorImpl::Reslice(const mitk::Image *input,
+                                                unsigned int timeStep,
+                                                vtkMatrix4x4 *outputToInputIndex,
+                                                bool linear,
+                                                double backgroundLevel,
+                                                vtkImageData *output)
+{
+  if (!IsSupported(input, timeStep) || outputToInputIndex == nullptr || output == nullptr ||
+      output->GetNumberOfScalarComponents() != 1 || output->GetScalarType() != GetVtkScalarType(input->GetPixelType()))
+  {
+    return false;
+  }
+
+  int extent[6];
+  output->GetExtent(extent);
+  const unsigned int outputSize[3] = { static_cast<unsigned int>(extent[1] - extent[0] + 1),
+                                       static_cast<unsigned int>(extent[3] - extent[2] + 1),
+                                       static_cast<unsigned int>(extent[5] - extent[4] + 1) };
+
+  double matrix[12];
+  for (unsigned int row = 0; row < 3; ++row)
+  {
+    for (unsigned int column = 0; column < 4; ++column)
+    {
+      matrix[4 * row + column] = outputToInputIndex->GetElement(row, column);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  try
+  {
+    if (m_ResampleFilter.IsNull())
+      m_ResampleFilter = mitk::OclResampleImageFilter::New();
+
+    m_ResampleFilter->SetInput(this->GetDeviceImage(input, timeStep));
+    m_ResampleFilter->SetOutputToInputIndex(matrix, outputSize);
+    m_ResampleFilter->SetUseLinearInterpolation(linear);
+    m_ResampleFilter->SetDefaultValue(backgroundLevel);
+    m_ResampleFilter->Update();
+
+    mitk::Image::Pointer slice = m_ResampleFilter->GetOutput();
+    if (slice->GetDimension(0) != outputSize[0] || slice->GetDimension(1) != outputSize[1])
+      return false;
+
+    mitk::ImageReadAccessor accessor(slice);
+    std::memcpy(output->GetScalarPointer(), accessor.GetData(), output->GetNumberOfPoints() * output->GetScalarSize());
+    output->Modified();
+    return true;
+  }
+  catch (const mitk::Exception &e)
+  {
+    MITK_WARN("OpenCL") << "Reslicing on the device failed: " << e.what();
+  }
+  return false;
+}
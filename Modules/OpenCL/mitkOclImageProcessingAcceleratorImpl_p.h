@@ -0,0 +1,80 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef __mitkOclImageProcessingAcceleratorImpl_h
+#define __mitkOclImageProcessingAcceleratorImpl_h
+
+#include <mutex>
+
+#include <mitkIImageProcessingAccelerator.h>
+
+#include "mitkOclGaussianImageFilter.h"
+#include "mitkOclResampleImageFilter.h"
+
+/** @class OclImageProcessingAcceleratorImpl
+ *  @brief OpenCL implementation of the mitk::IImageProcessingAccelerator service, registered by the module activator
+ *
+ *  Supports single component 3D and 4D images of type unsigned char, short and float. The filters and their
+ *  programs are created on first use and kept. The device copy of the last input volume is kept as well, so
+ *  reslicing the same volume repeatedly (e.g. by the 2D mapper or segmentation tools) uploads it only once,
+ *  until the image is modified. Errors are logged and reported as an empty result, so callers fall back to
+ *  their CPU implementation.
+ */
+class OclImageProcessingAcceleratorImpl : public mitk::IImageProcessingAccelerator
+{
+public:
+  OclImageProcessingAcceleratorImpl();
+
+  ~OclImageProcessingAcceleratorImpl() override;
+
+  mitk::Image::Pointer GaussianSmooth(const mitk::Image *input, unsigned int timeStep, const double sigma[3]) override;
+
+  mitk::Image::Pointer Resample(const mitk::Image *input,
+                                unsigned int timeStep,
+                                const mitk::BaseGeometry *targetGeometry,
+                                bool linear,
+                                double defaultValue) override;
+
+  bool Reslice(const mitk::Image *input,
+               unsigned int timeStep,
+               vtkMatrix4x4 *outputToInputIndex,
+               bool linear,
+               double backgroundLevel,
+               vtkImageData *output) override;
+
+private:
+
+  /** @brief Returns true if the filters can process the volume of the given time step */
+  static bool IsSupported(const mitk::Image *image, unsigned int timeStep);
+
+  /** @brief Returns the device copy of a volume, uploaded again only if the image was modified */
+  mitk::OclImage::Pointer GetDeviceImage(const mitk::Image *image, unsigned int timeStep);
+
+  /** serializes the calls, the filters and the cached volume are shared */
+  std::mutex m_Mutex;
+
+  mitk::OclGaussianImageFilter::Pointer m_GaussianFilter;
+  mitk::OclResampleImageFilter::Pointer m_ResampleFilter;
+
+  mitk::OclImage::Pointer m_DeviceImage;
+
+  /** source of m_DeviceImage, only compared and never dereferenced */
+  const mitk::Image *m_DeviceImageSource;
+  unsigned int m_DeviceImageTimeStep;
+  unsigned long m_DeviceImageMTime;
+};
+
+#endif // __mitkOclImageProcessingAcceleratorImpl_h
@@ -18,6 +18,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkOclImage.h"
 
 #include "mitkException.h"
+#include "mitkImageWriteAccessor.h"
+
+#include <algorithm>
+#include <cstring>
 
 mitk::OclImageToImageFilter::OclImageToImageFilter()
 {
@@ -35,40 +39,64 @@ mitk::OclImage::Pointer mitk::OclImageToImageFilter::GetGPUOutput()
   m_Output->SetPixelType(m_Input->GetPixelType());
 
   // create new image, for passing the essential information to the output
-  m_Output->InitializeMITKImage();
-
-  const unsigned int dimension = m_Input->GetDimension();
-  unsigned int* dimensions = m_Input->GetDimensions();
+  // the image is kept over several updates, its data is transferred only when requested by GetOutput()
+  if (m_Output->GetMITKImage().IsNull())
+    m_Output->InitializeMITKImage();
 
-  m_Output->SetDimensions( dimensions );
-  m_Output->SetDimension( (unsigned short)dimension );
+  this->InitializeOutputImage(m_Output->GetMITKImage());
 
-  m_Output->GetMITKImage()->Initialize( this->GetOutputType(), dimension, dimensions);
-  const mitk::SlicedGeometry3D::Pointer p_slg = m_Input->GetMITKImage()->GetSlicedGeometry(0);
-  m_Output->GetMITKImage()->SetSpacing( p_slg->GetSpacing() );
-  m_Output->GetMITKImage()->SetGeometry( m_Input->GetMITKImage()->GetGeometry() );
+  m_Output->SetDimensions( m_Output->GetMITKImage()->GetDimensions() );
+  m_Output->SetDimension( (unsigned short)m_Output->GetMITKImage()->GetDimension() );
 
   return this->m_Output;
 
 }
 
+void mitk::OclImageToImageFilter::InitializeOutputImage(mitk::Image* outputImage)
+{
+  const mitk::SlicedGeometry3D::Pointer p_slg = m_Input->GetMITKImage()->GetSlicedGeometry();
+
+  outputImage->Initialize( this->GetOutputType(), m_Input->GetDimension(), m_Input->GetDimensions());
+  outputImage->SetSpacing( p_slg->GetSpacing() );
+  outputImage->SetGeometry( m_Input->GetMITKImage()->GetGeometry() );
+}
+
+void mitk::OclImageToImageFilter::PrefetchOutput()
+{
+  if (m_Output->IsModified(GPU_DATA) && !m_Output->IsTransferPending())
+  {
+    if (m_Output->EnqueueTransferToCPU(m_CommandQue) != CL_SUCCESS)
+      MITK_WARN << "Could not start the transfer of the output.";
+  }
+}
+
 mitk::Image::Pointer mitk::OclImageToImageFilter::GetOutput()
 {
   if (m_Output->IsModified(GPU_DATA))
   {
-    void* pData = m_Output->TransferDataToCPU(m_CommandQue);
-
-    const unsigned int dimension = m_Input->GetDimension();
-    unsigned int* dimensions = m_Input->GetDimensions();
+    // the transfer may have been started already by PrefetchOutput()
+    if (!m_Output->IsTransferPending() && m_Output->EnqueueTransferToCPU(m_CommandQue) != CL_SUCCESS)
+      mitkThrow() << "Could not transfer the output to the CPU.";
 
-    const mitk::SlicedGeometry3D::Pointer p_slg = m_Input->GetMITKImage()->GetSlicedGeometry();
+    if (m_Output->GetMITKImage().IsNull())
+      m_Output->InitializeMITKImage();
 
     MITK_DEBUG << "Creating new MITK Image.";
 
-    m_Output->GetMITKImage()->Initialize( this->GetOutputType(), dimension, dimensions);
-    m_Output->GetMITKImage()->SetSpacing( p_slg->GetSpacing());
-    m_Output->GetMITKImage()->SetGeometry( m_Input->GetMITKImage()->GetGeometry() );
-    m_Output->GetMITKImage()->SetImportVolume( pData, 0, 0, mitk::Image::ReferenceMemory);
+    // initialize the image while the transfer is running
+    mitk::Image::Pointer outputImage = m_Output->GetMITKImage();
+    this->InitializeOutputImage(outputImage);
+
+    void* pData = m_Output->FinishTransferToCPU();
+    if (pData == nullptr)
+      mitkThrow() << "Could not transfer the output to the CPU.";
+
+    // copy from the pinned memory, which is owned by the OclImage and reused by the next transfer
+    mitk::ImageWriteAccessor accessor(outputImage);
+    size_t imageSize = outputImage->GetPixelType().GetSize();
+    for (unsigned int i = 0; i < outputImage->GetDimension(); ++i)
+      imageSize *= outputImage->GetDimension(i);
+    std::memcpy(accessor.GetData(), pData, std::min(imageSize, m_Output->GetBufferSizeInBytes()));
   }
 
   MITK_DEBUG << "Image Initialized.";
@@ -101,19 +129,23 @@ int mitk::OclImageToImageFilter::GetBytesPerElem()
 }
 
 bool mitk::OclImageToImageFilter::InitExec(cl_kernel ckKernel)
+{
+  if( m_Input.IsNull() )
+    mitkThrow() << "Input image is null.";
+
+  // the output has the size of the input
+  return this->InitExec(ckKernel, m_Input->GetDimension(0), m_Input->GetDimension(1), m_Input->GetDimension(2));
+}
+
+bool mitk::OclImageToImageFilter::InitExec(cl_kernel ckKernel, unsigned int outputWidth, unsigned int outputHeight, unsigned int outputDepth)
 {
   cl_int clErr = 0;
 
   if( m_Input.IsNull() )
     mitkThrow() << "Input image is null.";
 
-  // get image size once
-  const unsigned int uiImageWidth  = m_Input->GetDimension(0);
-  const unsigned int uiImageHeight = m_Input->GetDimension(1);
-  const unsigned int uiImageDepth  = m_Input->GetDimension(2);
-
-  // compute work sizes
-  this->SetWorkingSize( 8, uiImageWidth, 8, uiImageHeight , 8, uiImageDepth );
+  // compute work sizes, a single slice or row is not divided into work groups
+  this->SetWorkingSize( 8, outputWidth, outputHeight > 1 ? 8 : 1, outputHeight, outputDepth > 1 ? 8 : 1, outputDepth );
 
   cl_mem clBuffIn = m_Input->GetGPUImage(this->m_CommandQue);
   cl_mem clBuffOut = m_Output->GetGPUBuffer();
@@ -128,12 +160,12 @@ bool mitk::OclImageToImageFilter::InitExec(cl_kernel ckKernel)
     clBuffIn = m_Input->GetGPUImage(m_CommandQue);
   }
 
-  // output image not initialized
-  if (!clBuffOut)
+  // output image not initialized or of another size than in the last update
+  const size_t outputSize = static_cast<size_t>(outputWidth) * outputHeight * outputDepth * this->GetBytesPerElem();
+  if (!clBuffOut || m_Output->GetBufferSizeInBytes() != outputSize)
   {
-    //TODO bpp, or SetImageWidth/Height/...
-    MITK_DEBUG << "Create GPU Image call " << uiImageWidth<< "x"<<uiImageHeight<< "x"<<uiImageDepth;
-    clBuffOut = m_Output->CreateGPUImage(uiImageWidth, uiImageHeight, uiImageDepth, this->m_CurrentType + 1);
+    MITK_DEBUG << "Create GPU Image call " << outputWidth<< "x"<<outputHeight<< "x"<<outputDepth;
+    clBuffOut = m_Output->CreateGPUImage(outputWidth, outputHeight, outputDepth, this->GetBytesPerElem());
   }
 
   clErr = 0;
@@ -178,7 +210,7 @@ bool mitk::OclImageToImageFilter::InitExec(cl_kernel ckKernel)
   // output image not initialized
   //TODO bpp, or SetImageWidth/Height/...
   MITK_INFO << "Create GPU Image call " << uiImageWidth<< "x"<<uiImageHeight<< "x"<<uiImageDepth;
-  clBuffOut = m_Output->CreateGPUImage(uiImageWidth, uiImageHeight, uiImageDepth, this->m_CurrentType + 1);
+  clBuffOut = m_Output->CreateGPUImage(uiImageWidth, uiImageHeight, uiImageDepth, this->GetBytesPerElem());
   
 
   clErr = 0;
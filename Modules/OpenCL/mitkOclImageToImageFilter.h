@@ -32,6 +32,9 @@ class MITKOPENCL_EXPORT OclImageToImageFilter: public OclImageFilter
 public:
   /*!
     * \brief Returns an mitk::Image::Pointer containing the filtered data.
+    *
+    * The data is copied from the graphics memory only if it was modified by an update since the last call.
+    * @throws mitk::Exception if the transfer fails.
     */
   mitk::Image::Pointer GetOutput();
 
@@ -39,10 +42,19 @@ public:
     * \brief Returns a pointer to the graphics memory.
     *
     * Use this method when executing two and more filters on the GPU for fast access.
-    * This method does not copy the data to RAM. It returns only a pointer.
+    * This method does not copy the data to RAM. It returns only a pointer, which can be
+    * passed to SetInput() of the next filter, which then reads the data on the device.
     */
   mitk::OclImage::Pointer GetGPUOutput();
 
+  /*!
+    * \brief Starts the transfer of the filtered data to RAM without waiting for it.
+    *
+    * Call this after Update() if the data will be needed on the CPU, to overlap the transfer
+    * with other work. GetOutput() then only waits for the transfer to finish.
+    */
+  void PrefetchOutput();
+
 protected:
   /**
    * @brief OclImageToImageFilter Default constructor.
@@ -70,6 +82,22 @@ protected:
   bool InitExec(cl_kernel ckKernel);
   bool InitExec(cl_kernel ckKernel, unsigned int* dimensions);
 
+  /**
+   * @brief InitExec Initialize the execution for an output, whose size differs from the input
+   *
+   * The output buffer is created again if its size changed, the working size covers the output.
+   * @throws mitk::Exception if something goes wrong.
+   */
+  bool InitExec(cl_kernel ckKernel, unsigned int outputWidth, unsigned int outputHeight, unsigned int outputDepth);
+
+  /**
+   * @brief Initialize the MITK image holding the output on the CPU
+   *
+   * The default implementation takes the dimensions and the geometry of the input, filters with another
+   * output grid (e.g. resampling) override it.
+   */
+  virtual void InitializeOutputImage(mitk::Image* outputImage);
+
   /** @brief Get the memory size needed for each element */
   virtual int GetBytesPerElem();
 
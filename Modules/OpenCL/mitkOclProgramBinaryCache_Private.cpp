@@ -0,0 +1,274 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkOclProgramBinaryCache_p.h"
+#include "mitkOclUtils.h"
+
+#include <mitkIOUtil.h>
+#include <mitkLogMacros.h>
+
+#include <itksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+namespace
+{
+  const char CacheFileMagic[8] = { 'M', 'I', 'T', 'K', 'O', 'C', 'L', '1' };
+
+  /** 64 bit FNV-1a hash, stable across runs and platforms in contrast to std::hash */
+  std::uint64_t HashString(const std::string& text, std::uint64_t hash = 14695981039346656037ULL)
+  {
+    for (unsigned char c : text)
+    {
+      hash ^= c;
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+
+  std::string ToHex(std::uint64_t value)
+  {
+    std::ostringstream stream;
+    stream << std::hex;
+    stream.width(16);
+    stream.fill('0');
+    stream << value;
+    return stream.str();
+  }
+
+  std::string GetDeviceString(cl_device_id device, cl_device_info param)
+  {
+    size_t size = 0;
+    if (clGetDeviceInfo(device, param, 0, nullptr, &size) != CL_SUCCESS || size == 0)
+      return std::string();
+
+    std::vector<char> value(size);
+    if (clGetDeviceInfo(device, param, size, value.data(), nullptr) != CL_SUCCESS)
+      return std::string();
+
+    return std::string(value.data());
+  }
+
+  std::string GetPlatformVersion(cl_device_id device)
+  {
+    cl_platform_id platform = nullptr;
+    if (clGetDeviceInfo(device, CL_DEVICE_PLATFORM, sizeof(platform), &platform, nullptr) != CL_SUCCESS)
+      return std::string();
+
+    size_t size = 0;
+    if (clGetPlatformInfo(platform, CL_PLATFORM_VERSION, 0, nullptr, &size) != CL_SUCCESS || size == 0)
+      return std::string();
+
+    std::vector<char> value(size);
+    if (clGetPlatformInfo(platform, CL_PLATFORM_VERSION, size, value.data(), nullptr) != CL_SUCCESS)
+      return std::string();
+
+    return std::string(value.data());
+  }
+
+  void WriteSize(std::ostream& stream, std::uint64_t value)
+  {
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  bool ReadSize(std::istream& stream, std::uint64_t& value)
+  {
+    return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(value)));
+  }
+}
+
+OclProgramBinaryCache::OclProgramBinaryCache()
+  : m_Directory(GetDefaultDirectory())
+{
+}
+
+void OclProgramBinaryCache::SetDirectory(const std::string& directory)
+{
+  std::lock_guard<std::mutex> lock(m_DirectoryMutex);
+  m_Directory = directory;
+}
+
+std::string OclProgramBinaryCache::GetDirectory() const
+{
+  std::lock_guard<std::mutex> lock(m_DirectoryMutex);
+  return m_Directory;
+}
+
+std::string OclProgramBinaryCache::GetDefaultDirectory()
+{
+  std::string directory;
+  if (itksys::SystemTools::GetEnv("MITK_OPENCL_PROGRAM_CACHE", directory))
+    return directory; // an empty variable disables the cache
+
+  return mitk::IOUtil::GetTempPath() + "MITK-OpenCL-ProgramCache";
+}
+
+std::string OclProgramBinaryCache::GetKey(cl_device_id device, const std::vector<std::string>& sources, const std::string& options)
+{
+  std::uint64_t sourceHash = HashString(std::string());
+  for (const std::string& source : sources)
+  {
+    // include the length so that the split into files is part of the hash
+    sourceHash = HashString(std::to_string(source.size()) + ":", sourceHash);
+    sourceHash = HashString(source, sourceHash);
+  }
+
+  std::ostringstream key;
+  key << GetDeviceString(device, CL_DEVICE_NAME) << '|'
+      << GetDeviceString(device, CL_DEVICE_VENDOR) << '|'
+      << GetDeviceString(device, CL_DEVICE_VERSION) << '|'
+      << GetDeviceString(device, CL_DRIVER_VERSION) << '|'
+      << GetPlatformVersion(device) << '|'
+      << options << '|'
+      << ToHex(sourceHash);
+  return key.str();
+}
+
+std::string OclProgramBinaryCache::GetFileName(const std::string& key) const
+{
+  std::string directory = this->GetDirectory();
+  if (directory.empty())
+    return std::string();
+
+  return directory + "/" + ToHex(HashString(key)) + ".bin";
+}
+
+cl_program OclProgramBinaryCache::Load(cl_context context, cl_device_id device,
+                                       const std::vector<std::string>& sources, const std::string& options) const
+{
+  const std::string key = GetKey(device, sources, options);
+  const std::string fileName = this->GetFileName(key);
+  if (fileName.empty())
+    return nullptr;
+
+  std::ifstream file(fileName.c_str(), std::ios::binary);
+  if (!file.is_open())
+    return nullptr;
+
+  // check magic and key first, a mismatching key is a hash collision and the file belongs to another program
+  char magic[sizeof(CacheFileMagic)];
+  std::uint64_t keySize = 0;
+  if (!file.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), CacheFileMagic) ||
+      !ReadSize(file, keySize) || keySize != key.size())
+  {
+    return nullptr;
+  }
+
+  std::string storedKey(key.size(), '\0');
+  std::uint64_t binarySize = 0;
+  if (!file.read(&storedKey[0], storedKey.size()) || storedKey != key || !ReadSize(file, binarySize) || binarySize == 0)
+    return nullptr;
+
+  std::vector<unsigned char> binary(binarySize);
+  if (!file.read(reinterpret_cast<char*>(binary.data()), binary.size()))
+    return nullptr;
+  file.close();
+
+  size_t length = binary.size();
+  const unsigned char* binaryPointer = binary.data();
+  cl_int binaryStatus = CL_SUCCESS;
+  cl_int clErr = CL_SUCCESS;
+  cl_program program = clCreateProgramWithBinary(context, 1, &device, &length, &binaryPointer, &binaryStatus, &clErr);
+
+  if (clErr == CL_SUCCESS && binaryStatus == CL_SUCCESS)
+  {
+    // a program created from a binary has to be built as well, this does not invoke the compiler
+    clErr = clBuildProgram(program, 1, &device, options.c_str(), nullptr, nullptr);
+    if (clErr == CL_SUCCESS)
+    {
+      MITK_DEBUG("OpenCL.ProgramCache") << "Loaded program binary " << fileName;
+      return program;
+    }
+  }
+
+  MITK_WARN("OpenCL.ProgramCache") << "Cached program binary " << fileName << " was rejected ("
+                                   << GetOclErrorAsString(clErr != CL_SUCCESS ? clErr : binaryStatus)
+                                   << "), compiling from source.";
+  if (program)
+    clReleaseProgram(program);
+  std::remove(fileName.c_str());
+
+  return nullptr;
+}
+
+bool OclProgramBinaryCache::Store(cl_program program, cl_device_id device,
+                                  const std::vector<std::string>& sources, const std::string& options) const
+{
+  const std::string key = GetKey(device, sources, options);
+  const std::string fileName = this->GetFileName(key);
+  if (fileName.empty())
+    return false;
+
+  // the programs are built for the single device of the context
+  cl_uint numberOfDevices = 0;
+  cl_int clErr = clGetProgramInfo(program, CL_PROGRAM_NUM_DEVICES, sizeof(numberOfDevices), &numberOfDevices, nullptr);
+  if (clErr != CL_SUCCESS || numberOfDevices != 1)
+    return false;
+
+  size_t binarySize = 0;
+  clErr = clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, sizeof(binarySize), &binarySize, nullptr);
+  if (clErr != CL_SUCCESS || binarySize == 0)
+    return false;
+
+  std::vector<unsigned char> binary(binarySize);
+  unsigned char* binaryPointer = binary.data();
+  clErr = clGetProgramInfo(program, CL_PROGRAM_BINARIES, sizeof(binaryPointer), &binaryPointer, nullptr);
+  if (clErr != CL_SUCCESS)
+    return false;
+
+  const std::string directory = itksys::SystemTools::GetFilenamePath(fileName);
+  if (!itksys::SystemTools::MakeDirectory(directory.c_str()))
+  {
+    MITK_WARN("OpenCL.ProgramCache") << "Could not create the program cache directory " << directory;
+    return false;
+  }
+
+  // write to a unique temporary file first, so that other processes never see partially written binaries
+  std::random_device random;
+  const std::string temporaryFileName = fileName + "." + ToHex((static_cast<std::uint64_t>(random()) << 32) | random()) + ".tmp";
+  {
+    std::ofstream file(temporaryFileName.c_str(), std::ios::binary | std::ios::trunc);
+    file.write(CacheFileMagic, sizeof(CacheFileMagic));
+    WriteSize(file, key.size());
+    file.write(key.data(), key.size());
+    WriteSize(file, binary.size());
+    file.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+
+    if (!file.good())
+    {
+      file.close();
+      std::remove(temporaryFileName.c_str());
+      MITK_WARN("OpenCL.ProgramCache") << "Could not write the program binary " << temporaryFileName;
+      return false;
+    }
+  }
+
+  // rename does not replace existing files on all platforms
+  std::remove(fileName.c_str());
+  if (std::rename(temporaryFileName.c_str(), fileName.c_str()) != 0)
+  {
+    std::remove(temporaryFileName.c_str());
+    return false;
+  }
+
+  MITK_DEBUG("OpenCL.ProgramCache") << "Stored program binary " << fileName;
+  return true;
+}
@@ -0,0 +1,80 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef __mitkOclProgramBinaryCache_h
+#define __mitkOclProgramBinaryCache_h
+
+#include <mitkOpenCL.h>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+/** @class OclProgramBinaryCache
+ *  @brief On-disk storage of compiled OpenCL program binaries, used by the OclResourceService implementation
+ *
+ *  Every binary is stored in its own file, named after a hash of the cache key. The key consists of the device
+ *  name and vendor, the device, driver and platform version, the build options and a hash of the program
+ *  sources, so a driver update or a modified kernel leads to a new entry. The complete key is stored in the file
+ *  as well and compared on loading to rule out hash collisions.
+ *
+ *  The cache is disabled if the directory is empty. Files are written to a temporary name first and renamed
+ *  afterwards, so concurrent processes never read partially written binaries.
+ */
+class OclProgramBinaryCache
+{
+public:
+  OclProgramBinaryCache();
+
+  /** @brief Set the directory of the cache files, an empty string disables the cache */
+  void SetDirectory(const std::string& directory);
+
+  std::string GetDirectory() const;
+
+  /** @brief Create and build a program from a cached binary
+   *
+   *  @return the built program or nullptr if there is no valid binary for the given device, sources and options.
+   *          Invalid cache files (e.g. rejected by the driver) are removed.
+   */
+  cl_program Load(cl_context context, cl_device_id device,
+                  const std::vector<std::string>& sources, const std::string& options) const;
+
+  /** @brief Store the binary of a successfully built program
+   *  @return false if the cache is disabled or the binary could not be written
+   */
+  bool Store(cl_program program, cl_device_id device,
+             const std::vector<std::string>& sources, const std::string& options) const;
+
+  /** @brief Default directory, taken from the environment variable MITK_OPENCL_PROGRAM_CACHE if it is set,
+   *         otherwise a subdirectory of the temp path
+   */
+  static std::string GetDefaultDirectory();
+
+private:
+
+  /** @brief Returns the cache key of a program */
+  static std::string GetKey(cl_device_id device, const std::vector<std::string>& sources, const std::string& options);
+
+  /** @brief Returns the path of the cache file for the given key, or an empty string if the cache is disabled */
+  std::string GetFileName(const std::string& key) const;
+
+  std::string m_Directory;
+
+  /** guards the directory, the cache is used from the prewarming thread as well */
+  mutable std::mutex m_DirectoryMutex;
+};
+
+#endif // __mitkOclProgramBinaryCache_h
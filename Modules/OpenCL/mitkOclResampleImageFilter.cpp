@@ -0,0 +1,219 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkOclResampleImageFilter.h"
+#include "usServiceReference.h"
+
+#include <algorithm>
+
+mitk::OclResampleImageFilter::OclResampleImageFilter()
+: m_ckResample( nullptr ),
+  m_UseLinearInterpolation( true ),
+  m_DefaultValue( 0.0 )
+{
+  this->AddSourceFile("ResampleFilter.cl");
+  this->m_FilterID = "Resample";
+
+  std::fill( m_OutputToInputIndex, m_OutputToInputIndex + 12, 0.0 );
+  m_OutputToInputIndex[0] = m_OutputToInputIndex[5] = m_OutputToInputIndex[10] = 1.0;
+  std::fill( m_OutputSize, m_OutputSize + 3, 0u );
+}
+
+mitk::OclResampleImageFilter::~OclResampleImageFilter()
+{
+  if ( this->m_ckResample )
+  {
+    clReleaseKernel( m_ckResample );
+  }
+}
+
+void mitk::OclResampleImageFilter::SetReferenceGeometry( const BaseGeometry* geometry )
+{
+  this->m_ReferenceGeometry = geometry;
+}
+
+void mitk::OclResampleImageFilter::SetOutputToInputIndex( const double outputToInputIndex[12], const unsigned int outputSize[3] )
+{
+  this->m_ReferenceGeometry = nullptr;
+  std::copy( outputToInputIndex, outputToInputIndex + 12, m_OutputToInputIndex );
+  std::copy( outputSize, outputSize + 3, m_OutputSize );
+}
+
+void mitk::OclResampleImageFilter::ComputeOutputToInputIndex()
+{
+  const BaseGeometry* inputGeometry = m_Input->GetMITKImage()->GetGeometry();
+
+  // same rounding as mitk::Image::Initialize()
+  for ( unsigned int i = 0; i < 3; ++i )
+  {
+    m_OutputSize[i] = std::max( 1u, static_cast<unsigned int>( m_ReferenceGeometry->GetExtent(i) + 0.5 ) );
+  }
+
+  // integer indices of an image geometry are voxel centers, otherwise corners
+  const double centerOffset = m_ReferenceGeometry->GetImageGeometry() ? 0.0 : 0.5;
+  mitk::Point3D outputIndex;
+  mitk::FillVector3D( outputIndex, centerOffset, centerOffset, centerOffset );
+
+  mitk::Point3D world, inputIndex;
+  m_ReferenceGeometry->IndexToWorld( outputIndex, world );
+  inputGeometry->WorldToIndex( world, inputIndex );
+
+  for ( unsigned int row = 0; row < 3; ++row )
+  {
+    m_OutputToInputIndex[4 * row + 3] = inputIndex[row];
+  }
+
+  // the columns are the axes of the reference in input indices
+  for ( unsigned int column = 0; column < 3; ++column )
+  {
+    mitk::Vector3D axis, worldAxis, inputAxis;
+    axis.Fill( 0.0 );
+    axis[column] = 1.0;
+
+    m_ReferenceGeometry->IndexToWorld( axis, worldAxis );
+    inputGeometry->WorldToIndex( worldAxis, inputAxis );
+
+    for ( unsigned int row = 0; row < 3; ++row )
+    {
+      m_OutputToInputIndex[4 * row + column] = inputAxis[row];
+    }
+  }
+}
+
+void mitk::OclResampleImageFilter::Update()
+{
+  // the program is compiled for the type of the input
+  if ( this->SelectProgramForInputType("Resample") && this->m_ckResample )
+  {
+    clReleaseKernel( m_ckResample );
+    m_ckResample = nullptr;
+  }
+
+  //Check if context & program available
+  if (!this->Initialize())
+  {
+    us::ServiceReference<OclResourceService> ref = GetModuleContext()->GetServiceReference<OclResourceService>();
+    OclResourceService* resources = GetModuleContext()->GetService<OclResourceService>(ref);
+
+    // clean-up also the resources
+    resources->InvalidateStorage();
+    mitkThrow() <<"Filter is not initialized. Cannot update.";
+  }
+  else{
+    // Execute
+    this->Execute();
+  }
+}
+
+void mitk::OclResampleImageFilter::Execute()
+{
+  cl_int clErr = 0;
+
+  if ( m_ReferenceGeometry.IsNotNull() )
+  {
+    this->ComputeOutputToInputIndex();
+  }
+
+  if ( m_OutputSize[0] == 0 || m_OutputSize[1] == 0 || m_OutputSize[2] == 0 )
+  {
+    MITK_ERROR << "No output grid set for " << this->GetNameOfClass();
+    return;
+  }
+
+  try
+  {
+    this->InitExec( this->m_ckResample, m_OutputSize[0], m_OutputSize[1], m_OutputSize[2] );
+  }
+  catch( const mitk::Exception& e)
+  {
+    MITK_ERROR << "Catched exception while initializing filter: " << e.what();
+    return;
+  }
+
+  cl_float16 outputToInputIndex;
+  for ( unsigned int i = 0; i < 16; ++i )
+  {
+    outputToInputIndex.s[i] = i < 12 ? static_cast<cl_float>( m_OutputToInputIndex[i] ) : 0.0f;
+  }
+  cl_int useLinearInterpolation = m_UseLinearInterpolation ? 1 : 0;
+  cl_float defaultValue = static_cast<cl_float>( m_DefaultValue );
+
+  // set kernel arguments
+  clErr =  clSetKernelArg( this->m_ckResample, 2, sizeof(cl_float16), &outputToInputIndex );
+  clErr |= clSetKernelArg( this->m_ckResample, 3, sizeof(cl_uint), &(this->m_OutputSize[0]) );
+  clErr |= clSetKernelArg( this->m_ckResample, 4, sizeof(cl_uint), &(this->m_OutputSize[1]) );
+  clErr |= clSetKernelArg( this->m_ckResample, 5, sizeof(cl_uint), &(this->m_OutputSize[2]) );
+  clErr |= clSetKernelArg( this->m_ckResample, 6, sizeof(cl_int), &useLinearInterpolation );
+  clErr |= clSetKernelArg( this->m_ckResample, 7, sizeof(cl_float), &defaultValue );
+  CHECK_OCL_ERR( clErr );
+
+  // execute the filter on a 3D NDRange
+  this->ExecuteKernel( m_ckResample, 3 );
+
+  // signalize the GPU-side data changed
+  m_Output->Modified( GPU_DATA );
+}
+
+mitk::PixelType mitk::OclResampleImageFilter::GetOutputType()
+{
+  return m_Input->GetMITKImage()->GetPixelType();
+}
+
+int mitk::OclResampleImageFilter::GetBytesPerElem()
+{
+  return m_Input->GetBytesPerPixel();
+}
+
+void mitk::OclResampleImageFilter::InitializeOutputImage(mitk::Image* outputImage)
+{
+  if ( m_ReferenceGeometry.IsNotNull() )
+  {
+    outputImage->Initialize( this->GetOutputType(), *m_ReferenceGeometry );
+  }
+  else
+  {
+    outputImage->Initialize( this->GetOutputType(), m_OutputSize[2] > 1 ? 3 : 2, m_OutputSize );
+  }
+}
+
+us::Module *mitk::OclResampleImageFilter::GetModule()
+{
+  return us::GetModuleContext()->GetModule();
+}
+
+bool mitk::OclResampleImageFilter::Initialize()
+{
+  bool buildErr = true;
+  cl_int clErr = 0;
+
+  if ( OclFilter::Initialize() && this->m_ckResample == nullptr )
+  {
+    this->m_ckResample = clCreateKernel( this->m_ClProgram, "ckResample", &clErr);
+    buildErr |= CHECK_OCL_ERR( clErr );
+  }
+
+  return (OclFilter::IsInitialized() && buildErr );
+}
+
+void mitk::OclResampleImageFilter::SetInput(mitk::Image::Pointer image)
+{
+  if(image->GetDimension() != 3)
+  {
+    mitkThrowException(mitk::Exception) << "Input for " << this->GetNameOfClass() <<
+                                           " is not 3D. The filter only supports 3D. Please change your input.";
+  }
+  OclImageToImageFilter::SetInput(image);
+}
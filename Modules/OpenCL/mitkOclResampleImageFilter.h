@@ -0,0 +1,123 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef _MITKOCLRESAMPLEIMAGEFILTER_H_
+#define _MITKOCLRESAMPLEIMAGEFILTER_H_
+
+#include "mitkOclImageToImageFilter.h"
+#include <mitkBaseGeometry.h>
+#include <itkObject.h>
+
+namespace mitk
+{
+class OclImageToImageFilter;
+
+/** Documentation
+  *
+  * \brief The OclResampleImageFilter samples an image on another voxel grid.
+  *
+  * The grid is either given by a reference geometry, the output then has the extent and the geometry of the
+  * reference, or directly by a matrix mapping output voxels to continuous input indices and the output size.
+  * The latter is used to extract oblique slices like ExtractSliceFilter, a slice is an output of depth 1.
+  *
+  * Voxels are interpolated trilinearly or by nearest neighbor. Rounding and the handling of the image border
+  * follow vtkImageReslice: points up to half a voxel outside of the image take the border voxel, points further
+  * outside the default value. Input images of type unsigned char, short and float are supported, the output has
+  * the type of the input.
+  */
+class MITKOPENCL_EXPORT OclResampleImageFilter : public OclImageToImageFilter, public itk::Object
+{
+
+public:
+  mitkClassMacroItkParent(OclResampleImageFilter, itk::Object);
+  itkNewMacro(Self);
+
+  /**
+  * @brief SetInput Set the input image. Only 3D images are supported for now.
+  * @param image a 3D image.
+  * @throw mitk::Exception if the dimesion is not 3.
+  */
+  void SetInput(Image::Pointer image);
+
+  /** @brief Set the output of another OpenCL filter as input, the data stays on the device */
+  using OclImageToImageFilter::SetInput;
+
+  /** Update the filter */
+  void Update();
+
+  /** Set the geometry defining the output grid */
+  void SetReferenceGeometry( const BaseGeometry* geometry );
+
+  /** Set the output grid directly
+    @param outputToInputIndex Rows of a 3x4 matrix, mapping the index of an output voxel to the continuous input index
+    @param outputSize Size of the output in voxels
+    */
+  void SetOutputToInputIndex( const double outputToInputIndex[12], const unsigned int outputSize[3] );
+
+  /** Trilinear interpolation if true (default), nearest neighbor otherwise */
+  void SetUseLinearInterpolation( bool useLinearInterpolation )
+  {
+    this->m_UseLinearInterpolation = useLinearInterpolation;
+  }
+
+  /** Set the value of voxels outside of the input, default is 0 */
+  void SetDefaultValue( double defaultValue )
+  {
+    this->m_DefaultValue = defaultValue;
+  }
+
+protected:
+
+  /** Constructor */
+  OclResampleImageFilter();
+
+  /** Destructor */
+  virtual ~OclResampleImageFilter();
+
+  /** Initialize the filter */
+  bool Initialize();
+
+  void Execute();
+
+  mitk::PixelType GetOutputType();
+
+  int GetBytesPerElem();
+
+  void InitializeOutputImage(mitk::Image* outputImage);
+
+  virtual us::Module* GetModule();
+
+private:
+  /** Computes the matrix and the output size from the reference geometry */
+  void ComputeOutputToInputIndex();
+
+  /** The OpenCL kernel for the filter */
+  cl_kernel m_ckResample;
+
+  BaseGeometry::ConstPointer m_ReferenceGeometry;
+
+  double m_OutputToInputIndex[12];
+
+  unsigned int m_OutputSize[3];
+
+  bool m_UseLinearInterpolation;
+
+  double m_DefaultValue;
+};
+}
+
+
+#endif
@@ -21,12 +21,20 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mitkOpenCL.h>
 
+#include <string>
+#include <vector>
+
 /**
  * @brief Declaration of the OpenCL Resources micro-service
  *
  * The OclResourceService defines an service interface for providing access to the
  * essential OpenCL-related variables. In addition the service can also store compiled
- * OpenCL Programs in order to avoid multiple compiling of a single program source
+ * OpenCL Programs in order to avoid multiple compiling of a single program source.
+ *
+ * Programs built through BuildProgram() are additionally kept in an on-disk binary cache,
+ * so they are compiled only once per device, driver, source and build options and not in
+ * every session. Programs registered with RegisterProgram() are built in a background thread
+ * in advance, i.e. before the first filter using them is initialized.
  */
 class OclResourceService
 {
@@ -75,6 +83,40 @@ public:
    */
   virtual unsigned int GetMaximumImageSize( unsigned int , cl_mem_object_type) = 0;
 
+  /** @brief Create and build a program for the current device
+   *
+   * The program binary is taken from the on-disk cache if available, otherwise the program is
+   * compiled from the sources and its binary is added to the cache.
+   *
+   * @param sources The program sources, one entry per source file.
+   * @param options The build options passed to the OpenCL compiler.
+   * @param errcodeRet Returns CL_SUCCESS or the OpenCL error of creating or building the program, may be nullptr.
+   * @return The program, or nullptr if it could not be created. If the build failed, the program is
+   *         returned nevertheless so that the build log can be queried.
+   */
+  virtual cl_program BuildProgram(const std::vector<std::string>& sources, const std::string& options, cl_int* errcodeRet) = 0;
+
+  /** @brief Build a program in the background and insert it into the program storage
+   *
+   * Used for pre-warming the programs of filters, e.g. on application start. GetProgram() waits
+   * for the build of a registered program to finish. Programs already in the storage are skipped.
+   *
+   * @param name Text identifier of the program, the filter ID.
+   * @param sources The program sources, one entry per source file.
+   * @param options The build options passed to the OpenCL compiler.
+   */
+  virtual void RegisterProgram(const std::string& name, const std::vector<std::string>& sources, const std::string& options) = 0;
+
+  /** @brief Set the directory of the on-disk program binary cache, an empty string disables the cache
+   *
+   * The default directory is given by the environment variable MITK_OPENCL_PROGRAM_CACHE, or a
+   * subdirectory of the temp path if it is not set.
+   */
+  virtual void SetProgramCacheDirectory(const std::string& directory) = 0;
+
+  /** @brief Get the directory of the on-disk program binary cache */
+  virtual std::string GetProgramCacheDirectory() const = 0;
+
   virtual ~OclResourceService() = 0;
 
 };
@@ -21,13 +21,15 @@ OclResourceService::~OclResourceService()
 }
 
 OclResourceServiceImpl::OclResourceServiceImpl()
-  : m_ContextCollection(nullptr), m_ProgramStorage()
+  : m_ContextCollection(nullptr), m_ProgramStorage(), m_StopPrewarming(false)
 {
   m_ProgramStorageMutex = itk::FastMutexLock::New();
 }
 
 OclResourceServiceImpl::~OclResourceServiceImpl()
 {
+  this->StopPrewarming();
+
   // if map non-empty, release all remaining
   if( m_ProgramStorage.size() )
   {
@@ -43,18 +45,26 @@ OclResourceServiceImpl::~OclResourceServiceImpl()
     delete m_ContextCollection;
 }
 
-cl_context OclResourceServiceImpl::GetContext() const
+OclContextCollection* OclResourceServiceImpl::GetContextCollection() const
 {
+  std::lock_guard<std::mutex> lock(m_ContextCollectionMutex);
   if( m_ContextCollection == nullptr )
   {
     m_ContextCollection = new OclContextCollection();
   }
-  else if( !m_ContextCollection->CanProvideContext() )
+
+  return m_ContextCollection;
+}
+
+cl_context OclResourceServiceImpl::GetContext() const
+{
+  OclContextCollection* contextCollection = this->GetContextCollection();
+  if( !contextCollection->CanProvideContext() )
   {
     return nullptr;
   }
 
-  return m_ContextCollection->m_Context;
+  return contextCollection->m_Context;
 }
 
 cl_command_queue OclResourceServiceImpl::GetCommandQueue() const
@@ -64,10 +74,7 @@ cl_command_queue OclResourceServiceImpl::GetCommandQueue() const
 
   // check if there is a context available
   // if not create one
-  if( ! m_ContextCollection )
-  {
-    m_ContextCollection = new OclContextCollection();
-  }
+  this->GetContextCollection();
 
   cl_int clErr = clGetCommandQueueInfo( m_ContextCollection->m_CommandQueue, CL_QUEUE_CONTEXT, sizeof(clQueueContext), &clQueueContext, nullptr );
   if( clErr != CL_SUCCESS || clQueueContext != m_ContextCollection->m_Context )
@@ -134,9 +141,18 @@ void OclResourceServiceImpl::InsertProgram(cl_program _program_in, std::string n
 
 cl_program OclResourceServiceImpl::GetProgram(const std::string &name)
 {
+  // wait if the program is currently built by the prewarming thread
+  {
+    std::unique_lock<std::mutex> lock(m_PrewarmMutex);
+    m_PrewarmCondition.wait(lock, [this, &name] { return m_PendingPrograms.count(name) == 0; });
+  }
+
+  m_ProgramStorageMutex->Lock();
   ProgramMapType::iterator it = m_ProgramStorage.find(name);
+  const bool found = ( it != m_ProgramStorage.end() );
+  m_ProgramStorageMutex->Unlock();
 
-  if( it != m_ProgramStorage.end() )
+  if( found )
   {
     it->second.mutex->Lock();
     // first check if the program was deleted
@@ -258,3 +274,144 @@ unsigned int OclResourceServiceImpl::GetMaximumImageSize(unsigned int dimension,
   return retValue;
 }
 
+cl_program OclResourceServiceImpl::BuildProgram(const std::vector<std::string>& sources, const std::string& options, cl_int* errcodeRet)
+{
+  cl_int clErr = CL_SUCCESS;
+  cl_program program = nullptr;
+
+  cl_context context = this->GetContext();
+  if( context == nullptr || sources.empty() )
+  {
+    if( errcodeRet )
+      *errcodeRet = ( context == nullptr ) ? CL_INVALID_CONTEXT : CL_INVALID_VALUE;
+    return nullptr;
+  }
+
+  cl_device_id device = this->GetCurrentDevice();
+
+  // try the binary cache first, only compile if there is no valid binary
+  program = m_ProgramBinaryCache.Load(context, device, sources, options);
+  if( program )
+  {
+    if( errcodeRet )
+      *errcodeRet = CL_SUCCESS;
+    return program;
+  }
+
+  std::vector<const char*> sourcePointers;
+  std::vector<size_t> sourceSizes;
+  for( const std::string& source : sources )
+  {
+    sourcePointers.push_back( source.c_str() );
+    sourceSizes.push_back( source.size() );
+  }
+
+  program = clCreateProgramWithSource( context, sourcePointers.size(), &sourcePointers[0], &sourceSizes[0], &clErr );
+  if( clErr == CL_SUCCESS )
+  {
+    clErr = clBuildProgram( program, 1, &device, options.c_str(), nullptr, nullptr );
+
+    if( clErr == CL_SUCCESS )
+      m_ProgramBinaryCache.Store( program, device, sources, options );
+  }
+
+  if( errcodeRet )
+    *errcodeRet = clErr;
+
+  return program;
+}
+
+void OclResourceServiceImpl::RegisterProgram(const std::string& name, const std::vector<std::string>& sources, const std::string& options)
+{
+  std::lock_guard<std::mutex> lock(m_PrewarmMutex);
+
+  // a program is registered only once, the first registration defines the sources
+  if( m_StopPrewarming || m_PendingPrograms.count(name) )
+    return;
+
+  RegisteredProgram registeredProgram;
+  registeredProgram.name = name;
+  registeredProgram.sources = sources;
+  registeredProgram.options = options;
+
+  m_PendingPrograms.insert(name);
+  m_RegisteredPrograms.push_back(registeredProgram);
+
+  if( !m_PrewarmThread.joinable() )
+    m_PrewarmThread = std::thread(&OclResourceServiceImpl::PrewarmPrograms, this);
+
+  m_PrewarmCondition.notify_all();
+}
+
+void OclResourceServiceImpl::PrewarmPrograms()
+{
+  std::unique_lock<std::mutex> lock(m_PrewarmMutex);
+
+  while( true )
+  {
+    m_PrewarmCondition.wait(lock, [this] { return m_StopPrewarming || !m_RegisteredPrograms.empty(); });
+    if( m_StopPrewarming )
+      return;
+
+    RegisteredProgram registeredProgram = m_RegisteredPrograms.front();
+    m_RegisteredPrograms.pop_front();
+    lock.unlock();
+
+    m_ProgramStorageMutex->Lock();
+    const bool stored = ( m_ProgramStorage.count(registeredProgram.name) != 0 );
+    m_ProgramStorageMutex->Unlock();
+
+    if( !stored )
+    {
+      cl_int clErr = CL_SUCCESS;
+      cl_program program = this->BuildProgram(registeredProgram.sources, registeredProgram.options, &clErr);
+
+      if( clErr == CL_SUCCESS )
+      {
+        this->InsertProgram(program, registeredProgram.name, false);
+        MITK_DEBUG("OpenCL.ResourceService") << "Prewarmed program " << registeredProgram.name;
+      }
+      else
+      {
+        // the filter compiles the program itself on initialization and reports the build log
+        MITK_WARN("OpenCL.ResourceService") << "Prewarming the program " << registeredProgram.name
+                                            << " failed: " << GetOclErrorAsString(clErr);
+        if( program )
+          clReleaseProgram(program);
+      }
+    }
+
+    lock.lock();
+    m_PendingPrograms.erase(registeredProgram.name);
+    m_PrewarmCondition.notify_all();
+  }
+}
+
+void OclResourceServiceImpl::StopPrewarming()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_PrewarmMutex);
+    m_StopPrewarming = true;
+
+    // discard the programs not started yet, the one currently built is finished
+    for( const RegisteredProgram& registeredProgram : m_RegisteredPrograms )
+    {
+      m_PendingPrograms.erase(registeredProgram.name);
+    }
+    m_RegisteredPrograms.clear();
+    m_PrewarmCondition.notify_all();
+  }
+
+  if( m_PrewarmThread.joinable() )
+    m_PrewarmThread.join();
+}
+
+void OclResourceServiceImpl::SetProgramCacheDirectory(const std::string& directory)
+{
+  m_ProgramBinaryCache.SetDirectory(directory);
+}
+
+std::string OclResourceServiceImpl::GetProgramCacheDirectory() const
+{
+  return m_ProgramBinaryCache.GetDirectory();
+}
@@ -17,7 +17,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 #ifndef __mitkOclResourceServiceImpl_h
 #define __mitkOclResourceServiceImpl_h
 
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <mutex>
+#include <set>
+#include <thread>
 
 //Micro Services
 #include <usModuleActivator.h>
@@ -29,6 +34,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkOclResourceService.h"
 #include "mitkOclUtils.h"
 #include "mitkOclImageFormats.h"
+#include "mitkOclProgramBinaryCache_p.h"
 
 #include <itkFastMutexLock.h>
 
@@ -149,13 +155,41 @@ private:
   typedef std::map< std::string, ProgramData > ProgramMapType;
   //typedef std::map< std::string, std::pair< int, cl_program> > ProgramMapType;
 
+  // a program registered for building in the background
+  struct RegisteredProgram
+  {
+    std::string name;
+    std::vector<std::string> sources;
+    std::string options;
+  };
+
   mutable OclContextCollection* m_ContextCollection;
+  /** mutex for the lazy creation of the context collection, which is also requested by the prewarming thread */
+  mutable std::mutex m_ContextCollectionMutex;
 
   /** Map containing all available (allready compiled) OpenCL Programs */
   ProgramMapType m_ProgramStorage;
   /** mutex for manipulating the program storage */
   itk::FastMutexLock::Pointer m_ProgramStorageMutex;
 
+  /** On-disk storage of the binaries of all programs built by BuildProgram */
+  OclProgramBinaryCache m_ProgramBinaryCache;
+
+  /** Registered programs waiting for the prewarming thread */
+  std::deque<RegisteredProgram> m_RegisteredPrograms;
+  /** Names of all registered programs not built yet, including the one currently built */
+  std::set<std::string> m_PendingPrograms;
+  std::mutex m_PrewarmMutex;
+  std::condition_variable m_PrewarmCondition;
+  std::thread m_PrewarmThread;
+  bool m_StopPrewarming;
+
+  /** Creates the context collection on first call */
+  OclContextCollection* GetContextCollection() const;
+
+  /** Main loop of the prewarming thread, builds the registered programs until StopPrewarming() is called */
+  void PrewarmPrograms();
+
 public:
 
   OclResourceServiceImpl();
@@ -181,6 +215,17 @@ public:
   void RemoveProgram(const std::string&name);
 
   unsigned int GetMaximumImageSize(unsigned int dimension, cl_mem_object_type _imagetype);
+
+  cl_program BuildProgram(const std::vector<std::string>& sources, const std::string& options, cl_int* errcodeRet);
+
+  void RegisterProgram(const std::string& name, const std::vector<std::string>& sources, const std::string& options);
+
+  void SetProgramCacheDirectory(const std::string& directory);
+
+  std::string GetProgramCacheDirectory() const;
+
+  /** @brief Discard all registered programs not built yet and wait for the prewarming thread to finish */
+  void StopPrewarming();
 };
 
 #endif // __mitkOclResourceServiceImpl_h
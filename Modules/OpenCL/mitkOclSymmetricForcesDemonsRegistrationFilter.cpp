@@ -0,0 +1,477 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkOclSymmetricForcesDemonsRegistrationFilter.h"
+#include "mitkOclResourceService.h"
+
+#include <mitkExceptionMacro.h>
+#include <mitkImageCast.h>
+#include <mitkITKImageImport.h>
+
+#include "usServiceReference.h"
+#include <usGetModuleContext.h>
+#include <usModuleContext.h>
+
+#include <itkImage.h>
+#include <itkVector.h>
+
+#include <vnl/vnl_inverse.h>
+#include <vnl/vnl_matrix_fixed.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+  typedef itk::Image<float, 3> InternalImageType;
+  typedef itk::Image<itk::Vector<float, 3>, 3> DisplacementFieldType;
+
+  /** Owns the device buffers of one registration run, so that they are released on every exit path. */
+  class ClBufferList
+  {
+  public:
+    explicit ClBufferList(cl_context context) : m_Context(context) {}
+
+    ~ClBufferList()
+    {
+      for (cl_mem buffer : m_Buffers)
+      {
+        clReleaseMemObject(buffer);
+      }
+    }
+
+    cl_mem Create(std::size_t numberOfFloats, const float* hostData = nullptr)
+    {
+      cl_int clErr = 0;
+      cl_mem_flags flags = CL_MEM_READ_WRITE | (hostData ? CL_MEM_COPY_HOST_PTR : 0);
+      cl_mem buffer = clCreateBuffer(m_Context, flags, numberOfFloats * sizeof(float), const_cast<float*>(hostData), &clErr);
+      if (!CHECK_OCL_ERR(clErr) || !buffer)
+      {
+        mitkThrow() << "Could not allocate GPU buffer of " << numberOfFloats * sizeof(float) << " bytes: " << GetOclErrorAsString(clErr);
+      }
+      m_Buffers.push_back(buffer);
+      return buffer;
+    }
+
+  private:
+    ClBufferList(const ClBufferList&) = delete;
+    ClBufferList& operator=(const ClBufferList&) = delete;
+
+    cl_context m_Context;
+    std::vector<cl_mem> m_Buffers;
+  };
+
+  /** Grid of one pyramid level. */
+  struct LevelGrid
+  {
+    int size[3];
+    double indexToWorld[3][3];
+    double origin[3];
+
+    std::size_t GetNumberOfVoxels() const { return static_cast<std::size_t>(size[0]) * size[1] * size[2]; }
+
+    cl_int4 GetClSize() const
+    {
+      cl_int4 result;
+      result.s[0] = size[0];
+      result.s[1] = size[1];
+      result.s[2] = size[2];
+      result.s[3] = 0;
+      return result;
+    }
+
+    /** Grid of the next coarser level, every voxel covers 2x2x2 voxels of this level. */
+    LevelGrid Coarsen() const
+    {
+      LevelGrid result;
+      for (int i = 0; i < 3; ++i)
+      {
+        result.size[i] = std::max(1, (size[i] + 1) / 2);
+        result.origin[i] = origin[i];
+        for (int j = 0; j < 3; ++j)
+        {
+          result.indexToWorld[i][j] = 2.0 * indexToWorld[i][j];
+          result.origin[i] += 0.5 * indexToWorld[i][j];
+        }
+      }
+      return result;
+    }
+
+    cl_float16 GetClIndexToWorld() const
+    {
+      cl_float16 result;
+      std::fill(result.s, result.s + 16, 0.0f);
+      for (int i = 0; i < 3; ++i)
+      {
+        for (int j = 0; j < 3; ++j)
+        {
+          result.s[3 * i + j] = static_cast<float>(indexToWorld[i][j]);
+        }
+        result.s[9 + i] = static_cast<float>(origin[i]);
+      }
+      return result;
+    }
+
+    /** Inverse of the index to world transform. */
+    cl_float16 GetClWorldToIndex() const
+    {
+      vnl_matrix_fixed<double, 3, 3> matrix;
+      for (int i = 0; i < 3; ++i)
+      {
+        for (int j = 0; j < 3; ++j)
+        {
+          matrix[i][j] = indexToWorld[i][j];
+        }
+      }
+      const vnl_matrix_fixed<double, 3, 3> inverse = vnl_inverse(matrix);
+
+      cl_float16 result;
+      std::fill(result.s, result.s + 16, 0.0f);
+      for (int i = 0; i < 3; ++i)
+      {
+        double offset = 0.0;
+        for (int j = 0; j < 3; ++j)
+        {
+          result.s[3 * i + j] = static_cast<float>(inverse[i][j]);
+          offset -= inverse[i][j] * origin[j];
+        }
+        result.s[9 + i] = static_cast<float>(offset);
+      }
+      return result;
+    }
+
+    /** Maps gradients computed by central differences in index space onto world space gradients. */
+    cl_float16 GetClIndexGradientToWorld() const
+    {
+      // the gradient transforms with the inverse transposed of the index to world matrix
+      const cl_float16 worldToIndex = this->GetClWorldToIndex();
+      cl_float16 result;
+      std::fill(result.s, result.s + 16, 0.0f);
+      for (int i = 0; i < 3; ++i)
+      {
+        for (int j = 0; j < 3; ++j)
+        {
+          result.s[3 * i + j] = worldToIndex.s[3 * j + i];
+        }
+      }
+      return result;
+    }
+
+    /** Mean squared voxel size, used as normalizer of the demons update. */
+    double GetNormalizer() const
+    {
+      double result = 0.0;
+      for (int j = 0; j < 3; ++j)
+      {
+        double spacing2 = 0.0;
+        for (int i = 0; i < 3; ++i)
+        {
+          spacing2 += indexToWorld[i][j] * indexToWorld[i][j];
+        }
+        result += spacing2;
+      }
+      return result / 3.0;
+    }
+  };
+
+  LevelGrid GetGrid(const InternalImageType* image)
+  {
+    LevelGrid grid;
+    for (int i = 0; i < 3; ++i)
+    {
+      grid.size[i] = static_cast<int>(image->GetLargestPossibleRegion().GetSize()[i]);
+      grid.origin[i] = image->GetOrigin()[i];
+      for (int j = 0; j < 3; ++j)
+      {
+        grid.indexToWorld[i][j] = image->GetDirection()[i][j] * image->GetSpacing()[j];
+      }
+    }
+    return grid;
+  }
+}
+
+mitk::OclSymmetricForcesDemonsRegistrationFilter::OclSymmetricForcesDemonsRegistrationFilter()
+: m_ckDownsample( nullptr ),
+  m_ckWarp( nullptr ),
+  m_ckUpdate( nullptr ),
+  m_ckSmooth( nullptr ),
+  m_ckUpsample( nullptr ),
+  m_NumberOfLevels( 4 ),
+  m_NumberOfIterations( 50 ),
+  m_StandardDeviation( 1.0 ),
+  m_IntensityDifferenceThreshold( 0.001 ),
+  m_MaximumUpdateStepLength( 0.0 )
+{
+  this->AddSourceFile("SymmetricForcesDemons.cl");
+  this->m_FilterID = "SymmetricForcesDemons";
+}
+
+mitk::OclSymmetricForcesDemonsRegistrationFilter::~OclSymmetricForcesDemonsRegistrationFilter()
+{
+  cl_kernel kernels[] = { m_ckDownsample, m_ckWarp, m_ckUpdate, m_ckSmooth, m_ckUpsample };
+  for (cl_kernel kernel : kernels)
+  {
+    if ( kernel )
+    {
+      clReleaseKernel( kernel );
+    }
+  }
+}
+
+void mitk::OclSymmetricForcesDemonsRegistrationFilter::SetFixedImage(const mitk::Image* image)
+{
+  if(!image || image->GetDimension() != 3)
+  {
+    mitkThrowException(mitk::Exception) << "Fixed image for " << this->GetNameOfClass() <<
+                                           " is not 3D. The filter only supports 3D. Please change your input.";
+  }
+  m_FixedImage = image;
+  this->Modified();
+}
+
+void mitk::OclSymmetricForcesDemonsRegistrationFilter::SetMovingImage(const mitk::Image* image)
+{
+  if(!image || image->GetDimension() != 3)
+  {
+    mitkThrowException(mitk::Exception) << "Moving image for " << this->GetNameOfClass() <<
+                                           " is not 3D. The filter only supports 3D. Please change your input.";
+  }
+  m_MovingImage = image;
+  this->Modified();
+}
+
+void mitk::OclSymmetricForcesDemonsRegistrationFilter::Update()
+{
+  if (m_FixedImage.IsNull() || m_MovingImage.IsNull())
+  {
+    mitkThrow() << "Fixed or moving image is not set. Cannot update.";
+  }
+
+  //Check if context & program available
+  if (!this->Initialize())
+  {
+    us::ServiceReference<OclResourceService> ref = us::GetModuleContext()->GetServiceReference<OclResourceService>();
+    OclResourceService* resources = us::GetModuleContext()->GetService<OclResourceService>(ref);
+
+    // clean-up also the resources
+    resources->InvalidateStorage();
+    mitkThrow() <<"Filter is not initialized. Cannot update.";
+  }
+  else{
+    // Execute
+    this->Execute();
+  }
+}
+
+void mitk::OclSymmetricForcesDemonsRegistrationFilter::Execute()
+{
+  us::ServiceReference<OclResourceService> ref = us::GetModuleContext()->GetServiceReference<OclResourceService>();
+  OclResourceService* resources = us::GetModuleContext()->GetService<OclResourceService>(ref);
+
+  InternalImageType::Pointer fixed;
+  InternalImageType::Pointer moving;
+  mitk::CastToItkImage(m_FixedImage, fixed);
+  mitk::CastToItkImage(m_MovingImage, moving);
+
+  const unsigned int numberOfLevels = std::max(1u, m_NumberOfLevels);
+
+  // upload the images once and build the pyramids on the device
+  ClBufferList buffers(resources->GetContext());
+
+  std::vector<LevelGrid> fixedGrids(1, GetGrid(fixed));
+  std::vector<LevelGrid> movingGrids(1, GetGrid(moving));
+  std::vector<cl_mem> fixedLevels(1, buffers.Create(fixedGrids[0].GetNumberOfVoxels(), fixed->GetBufferPointer()));
+  std::vector<cl_mem> movingLevels(1, buffers.Create(movingGrids[0].GetNumberOfVoxels(), moving->GetBufferPointer()));
+
+  cl_int clErr = 0;
+
+  auto downsample = [&](std::vector<LevelGrid>& grids, std::vector<cl_mem>& levels)
+  {
+    const LevelGrid coarse = grids.back().Coarsen();
+    cl_mem coarseBuffer = buffers.Create(coarse.GetNumberOfVoxels());
+    const cl_int4 sourceSize = grids.back().GetClSize();
+    const cl_int4 destSize = coarse.GetClSize();
+
+    clErr  = clSetKernelArg( m_ckDownsample, 0, sizeof(cl_mem), &(levels.back()) );
+    clErr |= clSetKernelArg( m_ckDownsample, 1, sizeof(cl_mem), &coarseBuffer );
+    clErr |= clSetKernelArg( m_ckDownsample, 2, sizeof(cl_int4), &sourceSize );
+    clErr |= clSetKernelArg( m_ckDownsample, 3, sizeof(cl_int4), &destSize );
+    CHECK_OCL_ERR( clErr );
+
+    this->SetWorkingSize( 8, coarse.size[0], 8, coarse.size[1], 4, coarse.size[2] );
+    if ( clErr != CL_SUCCESS || !this->ExecuteKernel( m_ckDownsample, 3 ) )
+    {
+      mitkThrow() << "Could not compute resolution pyramid: " << GetOclErrorAsString(clErr);
+    }
+
+    grids.push_back(coarse);
+    levels.push_back(coarseBuffer);
+  };
+
+  for (unsigned int level = 1; level < numberOfLevels; ++level)
+  {
+    downsample(fixedGrids, fixedLevels);
+    downsample(movingGrids, movingLevels);
+  }
+
+  // fixed image and field share the grid, so the field of a level needs two buffers for the smoothing
+  // and one for the warped moving image
+  cl_mem field = nullptr;
+  LevelGrid fieldGrid = fixedGrids.back();
+
+  for (int level = static_cast<int>(numberOfLevels) - 1; level >= 0; --level)
+  {
+    const LevelGrid& grid = fixedGrids[level];
+    const cl_int4 size = grid.GetClSize();
+    const std::size_t numberOfVoxels = grid.GetNumberOfVoxels();
+
+    cl_mem levelField = nullptr;
+    if (!field)
+    {
+      const std::vector<float> zeros(3 * numberOfVoxels, 0.0f);
+      levelField = buffers.Create(3 * numberOfVoxels, zeros.data());
+    }
+    else
+    {
+      levelField = buffers.Create(3 * numberOfVoxels);
+      const cl_int4 sourceSize = fieldGrid.GetClSize();
+
+      clErr  = clSetKernelArg( m_ckUpsample, 0, sizeof(cl_mem), &field );
+      clErr |= clSetKernelArg( m_ckUpsample, 1, sizeof(cl_mem), &levelField );
+      clErr |= clSetKernelArg( m_ckUpsample, 2, sizeof(cl_int4), &sourceSize );
+      clErr |= clSetKernelArg( m_ckUpsample, 3, sizeof(cl_int4), &size );
+      CHECK_OCL_ERR( clErr );
+
+      this->SetWorkingSize( 8, grid.size[0], 8, grid.size[1], 4, grid.size[2] );
+      if ( clErr != CL_SUCCESS || !this->ExecuteKernel( m_ckUpsample, 3 ) )
+      {
+        mitkThrow() << "Could not upsample displacement field: " << GetOclErrorAsString(clErr);
+      }
+    }
+    field = levelField;
+    fieldGrid = grid;
+
+    cl_mem smoothed = buffers.Create(3 * numberOfVoxels);
+    cl_mem warped = buffers.Create(numberOfVoxels);
+
+    const cl_int4 movingSize = movingGrids[level].GetClSize();
+    const cl_float16 fixedIndexToWorld = grid.GetClIndexToWorld();
+    const cl_float16 movingWorldToIndex = movingGrids[level].GetClWorldToIndex();
+    const cl_float16 indexGradientToWorld = grid.GetClIndexGradientToWorld();
+    const cl_float normalizer = static_cast<cl_float>(grid.GetNormalizer());
+    const cl_float intensityThreshold = static_cast<cl_float>(m_IntensityDifferenceThreshold);
+    const cl_float maximumStep = static_cast<cl_float>(m_MaximumUpdateStepLength);
+    const cl_float sigma = static_cast<cl_float>(m_StandardDeviation);
+    const cl_int radius = static_cast<cl_int>(std::ceil(3.0 * m_StandardDeviation));
+
+    this->SetWorkingSize( 8, grid.size[0], 8, grid.size[1], 4, grid.size[2] );
+
+    for (unsigned int iteration = 0; iteration < m_NumberOfIterations; ++iteration)
+    {
+      // warp the moving image with the current field
+      clErr  = clSetKernelArg( m_ckWarp, 0, sizeof(cl_mem), &(movingLevels[level]) );
+      clErr |= clSetKernelArg( m_ckWarp, 1, sizeof(cl_mem), &warped );
+      clErr |= clSetKernelArg( m_ckWarp, 2, sizeof(cl_mem), &field );
+      clErr |= clSetKernelArg( m_ckWarp, 3, sizeof(cl_int4), &size );
+      clErr |= clSetKernelArg( m_ckWarp, 4, sizeof(cl_int4), &movingSize );
+      clErr |= clSetKernelArg( m_ckWarp, 5, sizeof(cl_float16), &fixedIndexToWorld );
+      clErr |= clSetKernelArg( m_ckWarp, 6, sizeof(cl_float16), &movingWorldToIndex );
+      CHECK_OCL_ERR( clErr );
+      bool success = ( clErr == CL_SUCCESS ) && this->ExecuteKernel( m_ckWarp, 3 );
+
+      // add the symmetric forces update
+      clErr  = clSetKernelArg( m_ckUpdate, 0, sizeof(cl_mem), &(fixedLevels[level]) );
+      clErr |= clSetKernelArg( m_ckUpdate, 1, sizeof(cl_mem), &warped );
+      clErr |= clSetKernelArg( m_ckUpdate, 2, sizeof(cl_mem), &field );
+      clErr |= clSetKernelArg( m_ckUpdate, 3, sizeof(cl_int4), &size );
+      clErr |= clSetKernelArg( m_ckUpdate, 4, sizeof(cl_float16), &indexGradientToWorld );
+      clErr |= clSetKernelArg( m_ckUpdate, 5, sizeof(cl_float), &normalizer );
+      clErr |= clSetKernelArg( m_ckUpdate, 6, sizeof(cl_float), &intensityThreshold );
+      clErr |= clSetKernelArg( m_ckUpdate, 7, sizeof(cl_float), &maximumStep );
+      CHECK_OCL_ERR( clErr );
+      success = success && ( clErr == CL_SUCCESS ) && this->ExecuteKernel( m_ckUpdate, 3 );
+
+      // regularize the field, separable gaussian ping-pong between the field buffers
+      if (radius > 0)
+      {
+        for (cl_int axis = 0; axis < 3; ++axis)
+        {
+          clErr  = clSetKernelArg( m_ckSmooth, 0, sizeof(cl_mem), &field );
+          clErr |= clSetKernelArg( m_ckSmooth, 1, sizeof(cl_mem), &smoothed );
+          clErr |= clSetKernelArg( m_ckSmooth, 2, sizeof(cl_int4), &size );
+          clErr |= clSetKernelArg( m_ckSmooth, 3, sizeof(cl_int), &axis );
+          clErr |= clSetKernelArg( m_ckSmooth, 4, sizeof(cl_float), &sigma );
+          clErr |= clSetKernelArg( m_ckSmooth, 5, sizeof(cl_int), &radius );
+          CHECK_OCL_ERR( clErr );
+          success = success && ( clErr == CL_SUCCESS ) && this->ExecuteKernel( m_ckSmooth, 3 );
+          std::swap(field, smoothed);
+        }
+      }
+
+      if (!success)
+      {
+        mitkThrow() << "Demons iteration " << iteration << " on level " << level << " failed: " << GetOclErrorAsString(clErr);
+      }
+    }
+  }
+
+  // download the final field
+  DisplacementFieldType::Pointer displacementField = DisplacementFieldType::New();
+  displacementField->SetRegions(fixed->GetLargestPossibleRegion());
+  displacementField->SetOrigin(fixed->GetOrigin());
+  displacementField->SetSpacing(fixed->GetSpacing());
+  displacementField->SetDirection(fixed->GetDirection());
+  displacementField->Allocate();
+
+  clErr = clEnqueueReadBuffer( this->m_CommandQue, field, CL_TRUE, 0, 3 * fixedGrids[0].GetNumberOfVoxels() * sizeof(float),
+                               displacementField->GetBufferPointer(), 0, nullptr, nullptr );
+  CHECK_OCL_ERR( clErr );
+  if ( clErr != CL_SUCCESS )
+  {
+    mitkThrow() << "Could not download displacement field: " << GetOclErrorAsString(clErr);
+  }
+
+  m_DisplacementField = mitk::GrabItkImageMemory(displacementField.GetPointer());
+}
+
+us::Module *mitk::OclSymmetricForcesDemonsRegistrationFilter::GetModule()
+{
+  return us::GetModuleContext()->GetModule();
+}
+
+bool mitk::OclSymmetricForcesDemonsRegistrationFilter::Initialize()
+{
+  bool buildErr = true;
+  cl_int clErr = 0;
+
+  if ( OclFilter::Initialize() )
+  {
+    const char* names[] = { "ckDownsample", "ckWarp", "ckSymmetricForcesUpdate", "ckSmoothField", "ckUpsampleField" };
+    cl_kernel* kernels[] = { &m_ckDownsample, &m_ckWarp, &m_ckUpdate, &m_ckSmooth, &m_ckUpsample };
+
+    for (unsigned int i = 0; i < 5; ++i)
+    {
+      if ( !*(kernels[i]) )
+      {
+        *(kernels[i]) = clCreateKernel( this->m_ClProgram, names[i], &clErr);
+        buildErr &= CHECK_OCL_ERR( clErr );
+      }
+    }
+  }
+
+  return (OclFilter::IsInitialized() && buildErr );
+}
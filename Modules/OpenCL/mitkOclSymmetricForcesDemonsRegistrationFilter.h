@@ -0,0 +1,128 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef _MITKOCLSYMMETRICFORCESDEMONSREGISTRATIONFILTER_H_
+#define _MITKOCLSYMMETRICFORCESDEMONSREGISTRATIONFILTER_H_
+
+#include "mitkOclFilter.h"
+
+#include <mitkImage.h>
+#include <itkObject.h>
+
+namespace mitk
+{
+/** Documentation
+  *
+  * \brief The OclSymmetricForcesDemonsRegistrationFilter computes a deformable registration of two 3D images
+  * on the GPU with Thirion's demons using symmetric forces and a multi resolution pyramid.
+  *
+  * Both images are uploaded once as float data. The pyramid levels, the warped moving image and the displacement
+  * field stay resident on the device during the whole registration; only the final field is downloaded.
+  * In every iteration the moving image is warped, the symmetric forces update is added to the field and the field
+  * is smoothed with a gaussian (diffusion like regularization).
+  *
+  * The resulting displacement field (see GetDisplacementField()) has the geometry of the fixed image and a
+  * 3 component float pixel type. Every vector is given in world coordinates (mm) and maps a position x of the
+  * fixed image onto the position x + u(x) in the moving image, i.e. it is the inverse mapping in terms of a
+  * MatchPoint registration.
+  */
+class MITKOPENCL_EXPORT OclSymmetricForcesDemonsRegistrationFilter : public OclFilter, public itk::Object
+{
+
+public:
+  mitkClassMacroItkParent(OclSymmetricForcesDemonsRegistrationFilter, itk::Object);
+  itkNewMacro(Self);
+
+  /**
+  * @brief Set the fixed (target) image. Only 3D images are supported.
+  * @throw mitk::Exception if the dimesion is not 3.
+  */
+  void SetFixedImage(const Image* image);
+
+  /**
+  * @brief Set the moving image. Only 3D images are supported.
+  * @throw mitk::Exception if the dimesion is not 3.
+  */
+  void SetMovingImage(const Image* image);
+
+  /** Number of resolution levels. Each level halves the resolution of the finer one. Default is 4.*/
+  itkSetMacro(NumberOfLevels, unsigned int);
+  itkGetConstMacro(NumberOfLevels, unsigned int);
+
+  /** Number of demons iterations per resolution level. Default is 50.*/
+  itkSetMacro(NumberOfIterations, unsigned int);
+  itkGetConstMacro(NumberOfIterations, unsigned int);
+
+  /** Standard deviation (in voxels of the current level) of the gaussian used to smooth the field
+    * after each iteration. 0 disables the smoothing. Default is 1.0.*/
+  itkSetMacro(StandardDeviation, double);
+  itkGetConstMacro(StandardDeviation, double);
+
+  /** Voxels with an intensity difference below the threshold are not updated. Default is 0.001.*/
+  itkSetMacro(IntensityDifferenceThreshold, double);
+  itkGetConstMacro(IntensityDifferenceThreshold, double);
+
+  /** Maximum length (mm) of the update of a single iteration. 0 disables the limit. Default is 0.*/
+  itkSetMacro(MaximumUpdateStepLength, double);
+  itkGetConstMacro(MaximumUpdateStepLength, double);
+
+  /** Computes the registration.
+    * @throw mitk::Exception if the inputs are missing or the GPU computation fails.*/
+  void Update();
+
+  /** Returns the displacement field of the last Update().*/
+  Image::Pointer GetDisplacementField() const
+  {
+    return m_DisplacementField;
+  }
+
+protected:
+
+  /** Constructor */
+  OclSymmetricForcesDemonsRegistrationFilter();
+
+  /** Destructor */
+  virtual ~OclSymmetricForcesDemonsRegistrationFilter();
+
+  /** Initialize the filter */
+  bool Initialize();
+
+  void Execute();
+
+  virtual us::Module* GetModule();
+
+private:
+  /** The OpenCL kernels of the filter */
+  cl_kernel m_ckDownsample;
+  cl_kernel m_ckWarp;
+  cl_kernel m_ckUpdate;
+  cl_kernel m_ckSmooth;
+  cl_kernel m_ckUpsample;
+
+  Image::ConstPointer m_FixedImage;
+  Image::ConstPointer m_MovingImage;
+  Image::Pointer m_DisplacementField;
+
+  unsigned int m_NumberOfLevels;
+  unsigned int m_NumberOfIterations;
+  double m_StandardDeviation;
+  double m_IntensityDifferenceThreshold;
+  double m_MaximumUpdateStepLength;
+};
+}
+
+
+#endif
@@ -15,6 +15,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "mitkOpenCLActivator.h"
+#include "mitkOclImageProcessingAcceleratorImpl_p.h"
 
 void OpenCLActivator::Load(us::ModuleContext *context)
 {
@@ -23,10 +24,20 @@ void OpenCLActivator::Load(us::ModuleContext *context)
   us::ServiceProperties props;
 
   context->RegisterService<OclResourceService>(m_ResourceService.get(), props);
+
+  // the filters of the accelerator create their OpenCL resources on first use
+  m_ImageProcessingAccelerator.reset(new OclImageProcessingAcceleratorImpl);
+  m_ImageProcessingAcceleratorRegistration =
+    context->RegisterService<mitk::IImageProcessingAccelerator>(m_ImageProcessingAccelerator.get());
 }
 
 void OpenCLActivator::Unload(us::ModuleContext *)
 {
+  // release the filters while the resource service is still available
+  m_ImageProcessingAcceleratorRegistration.Unregister();
+  m_ImageProcessingAccelerator.reset();
+
+  m_ResourceService->StopPrewarming();
   m_ResourceService.release();
 }
 
@@ -23,16 +23,22 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <usModuleContext.h>
 #include <usGetModuleContext.h>
 #include <usServiceProperties.h>
+#include <usServiceRegistration.h>
 
 #include <set>
 #include <algorithm>
 #include <memory>
 
+#include <mitkIImageProcessingAccelerator.h>
+
+class OclImageProcessingAcceleratorImpl;
+
 /**
  * @class OpenCLActivator
  *
  * @brief Custom activator for the OpenCL Module in order to register
- * and provide the OclResourceService
+ * and provide the OclResourceService and the OpenCL implementation of
+ * the mitk::IImageProcessingAccelerator service
  */
 class US_ABI_LOCAL OpenCLActivator : public us::ModuleActivator
 {
@@ -40,6 +46,10 @@ private:
 
   std::unique_ptr<OclResourceServiceImpl> m_ResourceService;
 
+  std::unique_ptr<OclImageProcessingAcceleratorImpl> m_ImageProcessingAccelerator;
+
+  us::ServiceRegistration<mitk::IImageProcessingAccelerator> m_ImageProcessingAcceleratorRegistration;
+
 public:
   /** @brief Load module context */
   void Load(us::ModuleContext *context);
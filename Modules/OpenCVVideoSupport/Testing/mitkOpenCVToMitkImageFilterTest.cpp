@@ -16,6 +16,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 // mitk includes
 #include "mitkOpenCVToMitkImageFilter.h"
+#include "mitkImageToOpenCVImageFilter.h"
+#include <mitkImageReadAccessor.h>
 #include <mitkStandardFileLocations.h>
 #include <mitkTestingMacros.h>
 #include <mitkTestFixture.h>
@@ -125,6 +127,9 @@ class mitkOpenCVToMitkImageFilterTestSuite : public mitk::TestFixture
   CPPUNIT_TEST_SUITE(mitkOpenCVToMitkImageFilterTestSuite);
   MITK_TEST(TestInitialization);
   MITK_TEST(TestThreadSafety);
+  MITK_TEST(TestOutputImageIsReused);
+  MITK_TEST(TestReferenceInputMemory);
+  MITK_TEST(TestRoundTripWithoutCopy);
 
   CPPUNIT_TEST_SUITE_END();
 
@@ -228,6 +233,65 @@ public:
 
   }
 
+  void TestOutputImageIsReused()
+  {
+    cv::Mat frame1(4, 5, CV_8UC3, cv::Scalar(10, 20, 30));
+    cv::Mat frame2(4, 5, CV_8UC3, cv::Scalar(40, 50, 60));
+
+    testFilter->SetOpenCVMat(frame1);
+    testFilter->Update();
+    mitk::Image* firstOutput = testFilter->GetOutput();
+    CPPUNIT_ASSERT(firstOutput != nullptr);
+
+    // nobody holds a reference, so the image is reused for the next frame
+    testFilter->SetOpenCVMat(frame2);
+    testFilter->Update();
+    CPPUNIT_ASSERT_MESSAGE("Output image is reused if it is not referenced", testFilter->GetOutput() == firstOutput);
+    {
+      mitk::ImageReadAccessor accessor(testFilter->GetOutput());
+      const unsigned char* data = static_cast<const unsigned char*>(accessor.GetData());
+      CPPUNIT_ASSERT_MESSAGE("BGR input is converted to RGB", data[0] == 60 && data[1] == 50 && data[2] == 40);
+    }
+
+    // a referenced output must not be overwritten
+    mitk::Image::Pointer heldOutput = testFilter->GetOutput();
+    testFilter->SetOpenCVMat(frame1);
+    testFilter->Update();
+    CPPUNIT_ASSERT_MESSAGE("Referenced output image is not reused", testFilter->GetOutput() != heldOutput.GetPointer());
+    mitk::ImageReadAccessor accessor(heldOutput);
+    CPPUNIT_ASSERT_MESSAGE("Referenced output image is unchanged", static_cast<const unsigned char*>(accessor.GetData())[0] == 60);
+  }
+
+  void TestReferenceInputMemory()
+  {
+    cv::Mat frame(4, 5, CV_16UC1, cv::Scalar(1000));
+
+    testFilter->ReferenceInputMemoryOn();
+    testFilter->SetOpenCVMat(frame);
+    testFilter->Update();
+
+    mitk::ImageReadAccessor accessor(testFilter->GetOutput());
+    CPPUNIT_ASSERT_MESSAGE("Output references the input buffer", accessor.GetData() == frame.data);
+  }
+
+  void TestRoundTripWithoutCopy()
+  {
+    cv::Mat frame(4, 5, CV_32FC1, cv::Scalar(0.5));
+    frame.at<float>(2, 3) = 2.f;
+    testFilter->SetOpenCVMat(frame);
+    testFilter->Update();
+    mitk::Image::Pointer image = testFilter->GetOutput();
+
+    mitk::ImageToOpenCVImageFilter::Pointer toOpenCVFilter = mitk::ImageToOpenCVImageFilter::New();
+    toOpenCVFilter->SetImage(image);
+    toOpenCVFilter->CopyBufferOff();
+    cv::Mat result = toOpenCVFilter->GetOpenCVMat();
+
+    mitk::ImageReadAccessor accessor(image);
+    CPPUNIT_ASSERT_MESSAGE("Result references the image buffer", result.data == accessor.GetData());
+    CPPUNIT_ASSERT(result.rows == 4 && result.cols == 5 && result.type() == CV_32FC1);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(2., result.at<float>(2, 3), 1e-6);
+  }
 
 private:
 
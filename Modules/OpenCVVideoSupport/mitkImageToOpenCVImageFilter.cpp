@@ -19,11 +19,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkImportImageFilter.h>
 #include <itkRGBPixel.h>
 #include <mitkImageAccessByItk.h>
+#include <mitkImageReadAccessor.h>
+#include <opencv2/imgproc.hpp>
 
 namespace mitk{
 
   ImageToOpenCVImageFilter::ImageToOpenCVImageFilter()
-    : m_OpenCVImage(nullptr)
+    : m_OpenCVImage(nullptr),
+      m_CopyBuffer(true)
   {
     m_sliceSelector = ImageSliceSelector::New();
   }
@@ -86,17 +89,84 @@ namespace mitk{
 
   cv::Mat ImageToOpenCVImageFilter::GetOpenCVMat()
   {
-    IplImage* img = this->GetOpenCVImage();
+    auto image = m_Image.Lock();
+
+    if(!this->CheckImage(image))
+      return cv::Mat();
+
+    const mitk::PixelType pixelType = image->GetPixelType();
+    const int depth = GetOpenCVDepth(pixelType.GetComponentType());
+    const unsigned int channels = pixelType.GetNumberOfComponents();
+
+    if (depth < 0 || (channels != 1 && channels != 3) || (channels == 3 && pixelType.GetPixelType() != itk::ImageIOBase::RGB))
+    {
+      // unusual pixel types are left to the ITK bridge
+      IplImage* img = this->GetOpenCVImage();
+
+      cv::Mat mat;
+      if( img )
+      {
+        // do not copy data, then release just the header
+        mat = cv::cvarrToMat(img, false);
+        cvReleaseImageHeader( &img );
+      }
+
+      return mat;
+    }
+
+    const int rows = image->GetDimension() > 1 ? image->GetDimension(1) : 1;
+    const int cols = image->GetDimension(0);
+    const int type = CV_MAKETYPE(depth, channels);
+
+    mitk::ImageReadAccessor accessor(image);
+    const cv::Mat source(rows, cols, type, const_cast<void*>(accessor.GetData()));
+
+    if (!m_CopyBuffer && channels == 1)
+    {
+      return source;
+    }
+
+    // a buffer still referenced by the caller must not be overwritten
+    if (m_OpenCVMat.u != nullptr && m_OpenCVMat.u->refcount > 1)
+    {
+      m_OpenCVMat.release();
+    }
+    m_OpenCVMat.create(rows, cols, type);
 
-    cv::Mat mat;
-    if( img )
+    if (channels == 3)
+    {
+      // cvtColor has vectorized implementations, but supports only these depths
+      if (depth == CV_8U || depth == CV_16U || depth == CV_32F)
+      {
+        cv::cvtColor(source, m_OpenCVMat, cv::COLOR_RGB2BGR);
+      }
+      else
+      {
+        const int fromTo[] = { 0, 2, 1, 1, 2, 0 };
+        cv::mixChannels(&source, 1, &m_OpenCVMat, 1, fromTo, 3);
+      }
+    }
+    else
     {
-      // do not copy data, then release just the header
-      mat = cv::cvarrToMat(img, false);
-      cvReleaseImageHeader( &img );
+      source.copyTo(m_OpenCVMat);
     }
 
-    return mat;
+    return m_OpenCVMat;
+  }
+
+  int ImageToOpenCVImageFilter::GetOpenCVDepth(int componentType)
+  {
+    switch (componentType)
+    {
+    case itk::ImageIOBase::UCHAR: return CV_8U;
+    case itk::ImageIOBase::CHAR: return CV_8S;
+    case itk::ImageIOBase::USHORT: return CV_16U;
+    case itk::ImageIOBase::SHORT: return CV_16S;
+    case itk::ImageIOBase::INT: return CV_32S;
+    case itk::ImageIOBase::FLOAT: return CV_32F;
+    case itk::ImageIOBase::DOUBLE: return CV_64F;
+    default: return -1;
+    }
   }
 
   template<typename TPixel, unsigned int VImageDimension>
@@ -67,10 +67,22 @@ class MITKOPENCVVIDEOSUPPORT_EXPORT ImageToOpenCVImageFilter : public itk::Objec
 
         ///
         /// RUNS the conversion and returns the produced image as cv::Mat.
+        /// Scalar and RGB images are converted in a single pass (RGB to BGR where needed) into a buffer
+        /// that is reused by the next call, as long as the previously returned matrix was released.
         /// \return the produced OpenCVImage or an empty image if an error occured
         ///
         cv::Mat GetOpenCVMat();
 
+        ///
+        /// \brief If disabled, GetOpenCVMat() returns a matrix referencing the buffer of scalar input images.
+        ///
+        /// The returned matrix is then only valid as long as the input image exists and must not be written to.
+        /// RGB images are always copied, because OpenCV expects the channels in BGR order.
+        ///
+        itkSetMacro(CopyBuffer, bool);
+        itkGetMacro(CopyBuffer, bool);
+        itkBooleanMacro(CopyBuffer);
+
         //##Documentation
         //## @brief Convenient method to set a certain slice of a 3D or 4D mitk::Image as input to convert it to an openCV image
         //##
@@ -88,6 +100,11 @@ class MITKOPENCVVIDEOSUPPORT_EXPORT ImageToOpenCVImageFilter : public itk::Objec
         template<typename TPixel, unsigned int VImageDimension>
         void ItkImageProcessing( itk::Image<TPixel,VImageDimension>* image );
 
+        ///
+        /// \return the OpenCV depth matching an itk::ImageIOBase component type or -1 if there is none
+        ///
+        static int GetOpenCVDepth(int componentType);
+
         ImageToOpenCVImageFilter();
         ~ImageToOpenCVImageFilter() override;
 
@@ -97,6 +114,12 @@ class MITKOPENCVVIDEOSUPPORT_EXPORT ImageToOpenCVImageFilter : public itk::Objec
         mitk::WeakPointer<mitk::Image> m_Image;
         IplImage* m_OpenCVImage;
 
+        ///
+        /// output buffer of GetOpenCVMat(), reused for the next frame
+        ///
+        cv::Mat m_OpenCVMat;
+        bool m_CopyBuffer;
+
   private:
     ImageSliceSelector::Pointer m_sliceSelector;
 };
@@ -21,12 +21,16 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkITKImageImport.txx>
 #include <itkOpenCVImageBridge.h>
 #include <itkImageFileWriter.h>
+#include <mitkImageWriteAccessor.h>
+#include <opencv2/imgproc.hpp>
 
 #include "mitkImageToOpenCVImageFilter.h"
 
 namespace mitk{
 
   OpenCVToMitkImageFilter::OpenCVToMitkImageFilter()
+    : m_ReferenceInputMemory(false),
+      m_OutputReferencesInput(false)
   {
     m_ImageMutex = itk::FastMutexLock::New();
     m_OpenCVMatMutex = itk::FastMutexLock::New();
@@ -52,64 +56,116 @@ namespace mitk{
 
   void OpenCVToMitkImageFilter::GenerateData()
   {
-    if (m_OpenCVMat.cols != 0 && m_OpenCVMat.rows != 0 && m_OpenCVMat.data)
+    // copy current cvMat
+    m_OpenCVMatMutex->Lock();
+    const cv::Mat input = m_OpenCVMat;
+    m_OpenCVMatMutex->Unlock();
+
+    if (input.cols == 0 || input.rows == 0 || !input.data)
     {
-      // copy current cvMat
-      m_OpenCVMatMutex->Lock();
-      const cv::Mat input = m_OpenCVMat;
-      m_OpenCVMatMutex->Unlock();
-      // convert cvMat to mitk::Image
-      m_ImageMutex->Lock();
-      // now convert rgb image
-      if ((input.depth() >= 0) && ((unsigned int)input.depth() == CV_8S) && (input.channels() == 1))
-      {
-        m_Image = ConvertCVMatToMitkImage< char, 2>(input);
-      }
-      else if (input.depth() == CV_8U && input.channels() == 1)
-      {
-        m_Image = ConvertCVMatToMitkImage< unsigned char, 2>(input);
-      }
-      else if (input.depth() == CV_8U && input.channels() == 3)
-      {
-        m_Image = ConvertCVMatToMitkImage< UCRGBPixelType, 2>(input);
-      }
-      else if (input.depth() == CV_16U && input.channels() == 1)
-      {
-        m_Image = ConvertCVMatToMitkImage< unsigned short, 2>(input);
-      }
-      else if (input.depth() == CV_16U && input.channels() == 3)
-      {
-        m_Image = ConvertCVMatToMitkImage< USRGBPixelType, 2>(input);
-      }
-      else if (input.depth() == CV_32F && input.channels() == 1)
-      {
-        m_Image = ConvertCVMatToMitkImage< float, 2>(input);
-      }
-      else if (input.depth() == CV_32F && input.channels() == 3)
-      {
-        m_Image = ConvertCVMatToMitkImage< FloatRGBPixelType, 2>(input);
-      }
-      else if (input.depth() == CV_64F && input.channels() == 1)
-      {
-        m_Image = ConvertCVMatToMitkImage< double, 2>(input);
-      }
-      else if (input.depth() == CV_64F && input.channels() == 3)
+      MITK_WARN << "Cannot start filter. OpenCV Image not set.";
+      return;
+    }
+
+    // convert cvMat to mitk::Image
+    m_ImageMutex->Lock();
+    // now convert rgb image
+    if ((input.depth() >= 0) && ((unsigned int)input.depth() == CV_8S) && (input.channels() == 1))
+    {
+      this->ConvertCVMatIntoOutputImage< char >(input);
+    }
+    else if (input.depth() == CV_8U && input.channels() == 1)
+    {
+      this->ConvertCVMatIntoOutputImage< unsigned char >(input);
+    }
+    else if (input.depth() == CV_8U && input.channels() == 3)
+    {
+      this->ConvertCVMatIntoOutputImage< UCRGBPixelType >(input);
+    }
+    else if (input.depth() == CV_16U && input.channels() == 1)
+    {
+      this->ConvertCVMatIntoOutputImage< unsigned short >(input);
+    }
+    else if (input.depth() == CV_16U && input.channels() == 3)
+    {
+      this->ConvertCVMatIntoOutputImage< USRGBPixelType >(input);
+    }
+    else if (input.depth() == CV_32F && input.channels() == 1)
+    {
+      this->ConvertCVMatIntoOutputImage< float >(input);
+    }
+    else if (input.depth() == CV_32F && input.channels() == 3)
+    {
+      this->ConvertCVMatIntoOutputImage< FloatRGBPixelType >(input);
+    }
+    else if (input.depth() == CV_64F && input.channels() == 1)
+    {
+      this->ConvertCVMatIntoOutputImage< double >(input);
+    }
+    else if (input.depth() == CV_64F && input.channels() == 3)
+    {
+      this->ConvertCVMatIntoOutputImage< DoubleRGBPixelType >(input);
+    }
+    else
+    {
+      MITK_WARN << "Unknown image depth and/or pixel type. Cannot convert OpenCV to MITK image.";
+    }
+    m_ImageMutex->Unlock();
+  }
+
+  template <typename TPixel>
+  void OpenCVToMitkImageFilter::ConvertCVMatIntoOutputImage(const cv::Mat& input)
+  {
+    const PixelType pixelType = MakePixelType< itk::Image<TPixel, 2> >(input.channels());
+    const unsigned int dimensions[2] = { static_cast<unsigned int>(input.cols), static_cast<unsigned int>(input.rows) };
+    const bool referenceInput = m_ReferenceInputMemory && input.channels() == 1 && input.isContinuous();
+
+    // the output of the last update is reused if nobody else holds a reference to it, a referenced
+    // volume must not be written to, so switching between copying and referencing needs a new image
+    const bool reuseImage = m_Image.IsNotNull() && m_Image->GetReferenceCount() == 1
+      && m_OutputReferencesInput == referenceInput
+      && m_Image->GetDimension() == 2 && m_Image->GetTimeSteps() == 1
+      && m_Image->GetDimension(0) == dimensions[0] && m_Image->GetDimension(1) == dimensions[1]
+      && m_Image->GetPixelType() == pixelType;
+
+    if (!reuseImage)
+    {
+      m_Image = Image::New();
+      m_Image->Initialize(pixelType, 2, dimensions);
+    }
+    m_OutputReferencesInput = referenceInput;
+
+    if (referenceInput)
+    {
+      m_Image->SetImportVolume(input.data, 0, 0, Image::ReferenceMemory);
+      return;
+    }
+
+    {
+      ImageWriteAccessor accessor(m_Image);
+
+      // wrap the image buffer, so that OpenCV writes directly into it
+      cv::Mat target(input.rows, input.cols, input.type(), accessor.GetData());
+      if (input.channels() == 3)
       {
-        m_Image = ConvertCVMatToMitkImage< DoubleRGBPixelType, 2>(input);
+        // cvtColor has vectorized implementations, but supports only these depths
+        if (input.depth() == CV_8U || input.depth() == CV_16U || input.depth() == CV_32F)
+        {
+          cv::cvtColor(input, target, cv::COLOR_BGR2RGB);
+        }
+        else
+        {
+          const int fromTo[] = { 0, 2, 1, 1, 2, 0 };
+          cv::mixChannels(&input, 1, &target, 1, fromTo, 3);
+        }
       }
       else
       {
-        MITK_WARN << "Unknown image depth and/or pixel type. Cannot convert OpenCV to MITK image.";
-        return;
+        input.copyTo(target);
       }
-      //inputMutex->Unlock();
-      m_ImageMutex->Unlock();
-    }
-    else
-    {
-      MITK_WARN << "Cannot start filter. OpenCV Image not set.";
-      return;
     }
+
+    m_Image->Modified();
   }
 
   ImageSource::OutputImageType* OpenCVToMitkImageFilter::GetOutput()
@@ -153,6 +209,7 @@ namespace mitk{
 
     m_ImageMutex->Lock();
     m_Image = mitkImage;
+    m_OutputReferencesInput = false;
     m_ImageMutex->Unlock();
   }
 
@@ -36,6 +36,11 @@ namespace mitk
   ///
   /// \brief Filter for creating MITK RGB Images from an OpenCV image
   ///
+  /// The output image of the last update is reused for the next one, as long as nobody else holds
+  /// a reference to it and size and pixel type of the input did not change. So converting a stream
+  /// of video frames does not allocate a new image per frame. A BGR input is converted to RGB while
+  /// it is copied into the output buffer, all other inputs are copied directly.
+  ///
   class MITKOPENCVVIDEOSUPPORT_EXPORT OpenCVToMitkImageFilter : public ImageSource
   {
   public:
@@ -68,6 +73,17 @@ namespace mitk
 
     OutputImageType* GetOutput(void);
 
+    ///
+    /// \brief If enabled, the output image references the buffer of a continuous single channel input instead of copying it.
+    ///
+    /// The buffer of the input matrix then has to stay valid and unchanged as long as the output image is used.
+    /// Video sources usually reuse their frame buffer, so this is disabled by default. Input matrices that need
+    /// a color conversion or that are not continuous are always copied.
+    ///
+    itkSetMacro(ReferenceInputMemory, bool);
+    itkGetMacro(ReferenceInputMemory, bool);
+    itkBooleanMacro(ReferenceInputMemory);
+
     //##Documentation
     //## @brief Convenient method to insert an openCV image as a slice at a
     //## certain time step into a 3D or 4D mitk::Image.
@@ -86,9 +102,17 @@ namespace mitk
 
     void GenerateData() override;
 
+    ///
+    /// \brief Copies (or references) the input into m_Image, which is reallocated only if it cannot be reused.
+    ///
+    template <typename TPixel>
+    void ConvertCVMatIntoOutputImage(const cv::Mat& input);
+
   protected:
     Image::Pointer m_Image;
     cv::Mat m_OpenCVMat;
+    bool m_ReferenceInputMemory;
+    bool m_OutputReferencesInput;
 
     itk::FastMutexLock::Pointer m_ImageMutex;
     itk::FastMutexLock::Pointer m_OpenCVMatMutex;
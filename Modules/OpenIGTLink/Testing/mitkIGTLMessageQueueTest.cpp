@@ -0,0 +1,112 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+
+#include <mitkIGTLMessageQueue.h>
+
+#include <igtlTrackingDataMessage.h>
+#include <igtlStringMessage.h>
+
+class mitkIGTLMessageQueueTestSuite : public mitk::TestFixture {
+CPPUNIT_TEST_SUITE(mitkIGTLMessageQueueTestSuite);
+MITK_TEST(Test_RingBuffer_PullInPushOrder);
+MITK_TEST(Test_RingBuffer_DropOldest);
+MITK_TEST(Test_RingBuffer_DropNewest);
+MITK_TEST(Test_RingBuffer_SortsByType);
+CPPUNIT_TEST_SUITE_END();
+
+private:
+
+mitk::IGTLMessageQueue::Pointer m_Queue;
+
+igtl::StringMessage::Pointer CreateStringMessage(const std::string& content)
+{
+igtl::StringMessage::Pointer msg = igtl::StringMessage::New();
+msg->SetString(content);
+return msg;
+}
+
+public:
+
+void setUp() override
+{
+m_Queue = mitk::IGTLMessageQueue::New();
+}
+
+void tearDown() override
+{
+m_Queue = nullptr;
+}
+
+void Test_RingBuffer_PullInPushOrder()
+{
+m_Queue->EnableRingBufferMode(true, 4);
+CPPUNIT_ASSERT_MESSAGE("Ring buffer mode was not enabled", m_Queue->IsRingBufferModeEnabled());
+
+m_Queue->PushMessage(CreateStringMessage("a").GetPointer());
+m_Queue->PushMessage(CreateStringMessage("b").GetPointer());
+CPPUNIT_ASSERT_EQUAL(2, m_Queue->GetSize());
+
+CPPUNIT_ASSERT_EQUAL(std::string("a"), std::string(m_Queue->PullStringMessage()->GetString()));
+CPPUNIT_ASSERT_EQUAL(std::string("b"), std::string(m_Queue->PullStringMessage()->GetString()));
+CPPUNIT_ASSERT_MESSAGE("Empty ring buffer did not return a null message", m_Queue->PullStringMessage().IsNull());
+}
+
+void Test_RingBuffer_DropOldest()
+{
+m_Queue->EnableRingBufferMode(true, 2, mitk::IGTLMessageQueue::DropOldest);
+
+m_Queue->PushMessage(CreateStringMessage("a").GetPointer());
+m_Queue->PushMessage(CreateStringMessage("b").GetPointer());
+m_Queue->PushMessage(CreateStringMessage("c").GetPointer());
+
+CPPUNIT_ASSERT_EQUAL(1ULL, m_Queue->GetNumberOfDroppedMessages());
+CPPUNIT_ASSERT_EQUAL(std::string("b"), std::string(m_Queue->PullStringMessage()->GetString()));
+CPPUNIT_ASSERT_EQUAL(std::string("c"), std::string(m_Queue->PullStringMessage()->GetString()));
+CPPUNIT_ASSERT_MESSAGE("Empty ring buffer did not return a null message", m_Queue->PullStringMessage().IsNull());
+}
+
+void Test_RingBuffer_DropNewest()
+{
+m_Queue->EnableRingBufferMode(true, 2, mitk::IGTLMessageQueue::DropNewest);
+
+m_Queue->PushMessage(CreateStringMessage("a").GetPointer());
+m_Queue->PushMessage(CreateStringMessage("b").GetPointer());
+m_Queue->PushMessage(CreateStringMessage("c").GetPointer());
+
+CPPUNIT_ASSERT_EQUAL(1ULL, m_Queue->GetNumberOfDroppedMessages());
+CPPUNIT_ASSERT_EQUAL(std::string("a"), std::string(m_Queue->PullStringMessage()->GetString()));
+CPPUNIT_ASSERT_EQUAL(std::string("b"), std::string(m_Queue->PullStringMessage()->GetString()));
+CPPUNIT_ASSERT_MESSAGE("Empty ring buffer did not return a null message", m_Queue->PullStringMessage().IsNull());
+}
+
+void Test_RingBuffer_SortsByType()
+{
+m_Queue->EnableRingBufferMode(true, 4);
+
+igtl::TrackingDataMessage::Pointer tdata = igtl::TrackingDataMessage::New();
+m_Queue->PushMessage(tdata.GetPointer());
+m_Queue->PushMessage(CreateStringMessage("a").GetPointer());
+
+CPPUNIT_ASSERT_MESSAGE("Tracking message was not sorted into the tracking buffer", m_Queue->PullTrackingMessage() == tdata);
+CPPUNIT_ASSERT_MESSAGE("Transform buffer is not empty", m_Queue->PullTransformMessage().IsNull());
+CPPUNIT_ASSERT_MESSAGE("String message was not sorted into the string buffer", m_Queue->PullStringMessage().IsNotNull());
+}
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkIGTLMessageQueue)
@@ -42,6 +42,8 @@ MITK_TEST(Test_CreatePositionMessage_NotNull);
 MITK_TEST(Test_CreateStatusMessage_NotNull);
 MITK_TEST(Test_CreateCapabilityMessage_NotNull);
 MITK_TEST(Test_AddCustomMessageType_Succeeds);
+MITK_TEST(Test_CreateMessageByTypeId_NotNull);
+MITK_TEST(Test_UnknownTypeId_IsInvalid);
 CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -109,6 +111,29 @@ mitk::IGTLDummyMessage::Pointer message = dynamic_cast<mitk::IGTLDummyMessage*>(
 
 CPPUNIT_ASSERT_MESSAGE("The created message was not of type mitk::IGTLDummyMessage", message.IsNotNull());
 }
+
+void Test_CreateMessageByTypeId_NotNull()
+{
+mitk::IGTLMessageFactory::MessageTypeId id = m_MessageFactory->GetMessageTypeId(TYPE_TRANSFORM);
+CPPUNIT_ASSERT_MESSAGE("The transform message type has no valid id", id != mitk::IGTLMessageFactory::InvalidMessageTypeId);
+
+igtl::MessageBase::Pointer messageBase = m_MessageFactory->CreateInstance(id);
+igtl::TransformMessage::Pointer message = dynamic_cast<igtl::TransformMessage*>(messageBase.GetPointer());
+
+CPPUNIT_ASSERT_MESSAGE("The created message was not of type igtl::TransformMessage", message.IsNotNull());
+
+//replacing the new method keeps the id
+m_MessageFactory->AddMessageNewMethod(TYPE_TRANSFORM, (mitk::IGTLMessageFactory::PointerToMessageBaseNew)&mitk::IGTLDummyMessage::New);
+CPPUNIT_ASSERT_MESSAGE("The id changed after the new method was replaced", id == m_MessageFactory->GetMessageTypeId(TYPE_TRANSFORM));
+messageBase = m_MessageFactory->CreateInstance(id);
+CPPUNIT_ASSERT_MESSAGE("The replaced new method was not used", dynamic_cast<mitk::IGTLDummyMessage*>(messageBase.GetPointer()) != nullptr);
+}
+
+void Test_UnknownTypeId_IsInvalid()
+{
+CPPUNIT_ASSERT_MESSAGE("An unregistered type has a valid id", m_MessageFactory->GetMessageTypeId(TYPE_TEST) == mitk::IGTLMessageFactory::InvalidMessageTypeId);
+CPPUNIT_ASSERT_MESSAGE("A message was created for an invalid id", m_MessageFactory->CreateInstance(mitk::IGTLMessageFactory::InvalidMessageTypeId).IsNull());
+}
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkOpenIGTLinkImageFactory)
@@ -494,6 +494,12 @@ void mitk::IGTLDevice::EnableNoBufferingMode(
   queue->EnableNoBufferingMode(enable);
 }
 
+void mitk::IGTLDevice::EnableRingBufferMode(bool enable, unsigned int capacity,
+  mitk::IGTLMessageQueue::OverflowPolicy policy)
+{
+  m_MessageQueue->EnableRingBufferMode(enable, capacity, policy);
+}
+
 ITK_THREAD_RETURN_TYPE mitk::IGTLDevice::ThreadStartSending(void* pInfoStruct)
 {
   /* extract this pointer from Thread Info structure */
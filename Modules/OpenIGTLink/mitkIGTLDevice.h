@@ -244,6 +244,13 @@ namespace mitk {
 
     void EnableNoBufferingMode(bool enable = true);
 
+    /**
+    * \brief Stores the received messages in lock-free ring buffers, see
+    * IGTLMessageQueue::EnableRingBufferMode(). Call before opening the connection.
+    */
+    void EnableRingBufferMode(bool enable = true, unsigned int capacity = 64,
+      mitk::IGTLMessageQueue::OverflowPolicy policy = mitk::IGTLMessageQueue::DropOldest);
+
     /**
     * \brief Returns the number of connections of this device
     */
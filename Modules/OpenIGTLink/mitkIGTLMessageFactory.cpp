@@ -95,6 +95,8 @@ igtl::MessageBase::Pointer TransformMsgCloneHandler::Clone(igtl::MessageBase* or
   return igtl::MessageBase::Pointer(clone_.GetPointer());
 }
 
+const mitk::IGTLMessageFactory::MessageTypeId mitk::IGTLMessageFactory::InvalidMessageTypeId;
+
 mitk::IGTLMessageFactory::IGTLMessageFactory()
 {
   //create clone handlers
@@ -177,6 +179,17 @@ void mitk::IGTLMessageFactory::AddMessageNewMethod(std::string messageTypeName,
   IGTLMessageFactory::PointerToMessageBaseNew messageTypeNewPointer)
 {
   this->m_NewMethods[messageTypeName] = messageTypeNewPointer;
+
+  auto id = this->m_MessageTypeIds.find(messageTypeName);
+  if (id != this->m_MessageTypeIds.end())
+  {
+    this->m_NewMethodsById[id->second] = messageTypeNewPointer;
+  }
+  else
+  {
+    this->m_MessageTypeIds[messageTypeName] = static_cast<MessageTypeId>(this->m_NewMethodsById.size());
+    this->m_NewMethodsById.push_back(messageTypeNewPointer);
+  }
 }
 
 void mitk::IGTLMessageFactory::AddMessageCloneHandler(std::string msgTypeName,
@@ -211,9 +224,10 @@ mitk::IGTLMessageFactory::Clone(igtl::MessageBase::Pointer msg)
 mitk::IGTLMessageFactory::PointerToMessageBaseNew
 mitk::IGTLMessageFactory::GetMessageTypeNewPointer(std::string messageTypeName)
 {
-  if (this->m_NewMethods.find(messageTypeName) != this->m_NewMethods.end())
+  auto it = this->m_NewMethods.find(messageTypeName);
+  if (it != this->m_NewMethods.end())
   {
-    return m_NewMethods[messageTypeName];
+    return it->second;
   }
 
   MITK_ERROR("IGTLMessageFactory") << messageTypeName <<
@@ -236,6 +250,28 @@ mitk::IGTLMessageFactory::CreateInstance(std::string messageTypeName)
   }
 }
 
+mitk::IGTLMessageFactory::MessageTypeId
+mitk::IGTLMessageFactory::GetMessageTypeId(const std::string& messageTypeName) const
+{
+  auto it = this->m_MessageTypeIds.find(messageTypeName);
+  if (it != this->m_MessageTypeIds.end())
+  {
+    return it->second;
+  }
+  return InvalidMessageTypeId;
+}
+
+igtl::MessageBase::Pointer
+mitk::IGTLMessageFactory::CreateInstance(MessageTypeId messageTypeId)
+{
+  if (messageTypeId < this->m_NewMethodsById.size() &&
+    this->m_NewMethodsById[messageTypeId] != nullptr)
+  {
+    return this->m_NewMethodsById[messageTypeId]();
+  }
+  return nullptr;
+}
+
 std::list<std::string>
 mitk::IGTLMessageFactory::GetAvailableMessageRequestTypes()
 {
@@ -271,17 +307,20 @@ mitk::IGTLMessageFactory::CreateInstance(igtl::MessageHeader::Pointer msgHeader)
     messageType = msgHeader->GetDeviceType();
   }
 
-  //make message type uppercase
-  messageType = itksys::SystemTools::UpperCase(messageType);
-
-  //find the according new method
-  if (this->m_NewMethods.find(messageType)
-    != this->m_NewMethods.end())
+  //find the according new method, the type names of the standard are already
+  //uppercase, so the conversion is only necessary if the type was not found
+  auto it = this->m_NewMethods.find(messageType);
+  if (it == this->m_NewMethods.end())
+  {
+    messageType = itksys::SystemTools::UpperCase(messageType);
+    it = this->m_NewMethods.find(messageType);
+  }
+  if (it != this->m_NewMethods.end())
   {
-    if (this->m_NewMethods[messageType] != nullptr)
+    if (it->second != nullptr)
     {
       // Call tracker New() function if tracker not nullptr
-      return (*this->m_NewMethods[messageType])();
+      return (*it->second)();
     }
     else
       return nullptr;
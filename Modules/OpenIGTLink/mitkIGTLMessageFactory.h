@@ -33,6 +33,11 @@ namespace mitk {
   * pairs of type and pointer to the message new method. Available standard types
   * are already added but you can also add your custom types at runtime.
   *
+  * Code which creates messages of the same type repeatedly can resolve the type
+  * name once with GetMessageTypeId() and create the messages with
+  * CreateInstance(MessageTypeId), which avoids the string comparisons of the
+  * type name lookup.
+  *
   */
   class MITKOPENIGTLINK_EXPORT IGTLMessageFactory : public itk::Object
   {
@@ -47,6 +52,16 @@ namespace mitk {
     */
     typedef igtl::MessageBase::Pointer (*PointerToMessageBaseNew)();
 
+    /**
+    * \brief Numeric id of a registered message type, see GetMessageTypeId()
+    */
+    typedef unsigned int MessageTypeId;
+
+    /**
+    * \brief Id returned by GetMessageTypeId() for unregistered message types
+    */
+    static const MessageTypeId InvalidMessageTypeId = static_cast<MessageTypeId>(-1);
+
     /**
     * \brief Add message type name and pointer to IGTL message new function and
     * the clone handler
@@ -96,6 +111,23 @@ namespace mitk {
     */
     igtl::MessageBase::Pointer CreateInstance(igtl::MessageHeader::Pointer msg);
 
+    /**
+    * \brief Returns the id of the given message type, or InvalidMessageTypeId if
+    * the type is not registered. The id of a type does not change when its new
+    * method is replaced.
+    */
+    MessageTypeId GetMessageTypeId(const std::string& messageTypeName) const;
+
+    /**
+    * \brief Creates a new message instance of the type with the given id.
+    *
+    * If the id is not valid or no new method is registered for it, it returns nullptr
+    * Usage:
+    * MessageTypeId imageType = GetMessageTypeId("IMAGE");
+    * igtl::MessageBase::Pointer message = CreateInstance(imageType);
+    */
+    igtl::MessageBase::Pointer CreateInstance(MessageTypeId messageTypeId);
+
     /**
     * \brief Adds a clone function for the specified message type
     * \param msgTypeName The name of the message type
@@ -144,6 +176,16 @@ namespace mitk {
     */
     std::map<std::string, PointerToMessageBaseNew> m_NewMethods;
 
+    /**
+     * \brief Map igt message types and their ids
+    */
+    std::map<std::string, MessageTypeId> m_MessageTypeIds;
+
+    /**
+     * \brief New() static methods indexed by the message type id
+    */
+    std::vector<PointerToMessageBaseNew> m_NewMethodsById;
+
   private:
     IGTLMessageFactory(const IGTLMessageFactory&);
   };
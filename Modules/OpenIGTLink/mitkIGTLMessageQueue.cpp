@@ -38,8 +38,47 @@ void mitk::IGTLMessageQueue::PushCommandMessage(igtl::MessageBase::Pointer messa
   this->m_Mutex->Unlock();
 }
 
+void mitk::IGTLMessageQueue::PushMessageToRingBuffers(igtl::MessageBase::Pointer msg)
+{
+  if (auto trackingMsg = dynamic_cast<igtl::TrackingDataMessage*>(msg.GetPointer()))
+  {
+    this->m_TrackingDataRingBuffer->Push(trackingMsg);
+  }
+  else if (auto transformMsg = dynamic_cast<igtl::TransformMessage*>(msg.GetPointer()))
+  {
+    this->m_TransformRingBuffer->Push(transformMsg);
+  }
+  else if (auto stringMsg = dynamic_cast<igtl::StringMessage*>(msg.GetPointer()))
+  {
+    this->m_StringRingBuffer->Push(stringMsg);
+  }
+  else if (auto imageMsg = dynamic_cast<igtl::ImageMessage*>(msg.GetPointer()))
+  {
+    int dim[3];
+    imageMsg->GetDimensions(dim);
+    if (dim[2] > 1)
+      this->m_Image3dRingBuffer->Push(imageMsg);
+    else
+      this->m_Image2dRingBuffer->Push(imageMsg);
+  }
+  else
+  {
+    this->m_MiscRingBuffer->Push(msg.GetPointer());
+  }
+
+  this->m_LatestMessageMutex->Lock();
+  m_Latest_Message = msg;
+  this->m_LatestMessageMutex->Unlock();
+}
+
 void mitk::IGTLMessageQueue::PushMessage(igtl::MessageBase::Pointer msg)
 {
+  if (this->m_UseRingBuffers)
+  {
+    this->PushMessageToRingBuffers(msg);
+    return;
+  }
+
   this->m_Mutex->Lock();
 
   std::stringstream infolog;
@@ -76,7 +115,7 @@ void mitk::IGTLMessageQueue::PushMessage(igtl::MessageBase::Pointer msg)
   else if (dynamic_cast<igtl::ImageMessage*>(msg.GetPointer()) != nullptr)
   {
     igtl::ImageMessage::Pointer imageMsg = dynamic_cast<igtl::ImageMessage*>(msg.GetPointer());
-    int* dim = new int[3];
+    int dim[3];
     imageMsg->GetDimensions(dim);
     if (dim[2] > 1)
     {
@@ -107,7 +146,9 @@ void mitk::IGTLMessageQueue::PushMessage(igtl::MessageBase::Pointer msg)
     infolog << "OTHER";
   }
 
+  this->m_LatestMessageMutex->Lock();
   m_Latest_Message = msg;
+  this->m_LatestMessageMutex->Unlock();
 
   //MITK_INFO << infolog.str();
 
@@ -129,6 +170,9 @@ mitk::IGTLMessage::Pointer mitk::IGTLMessageQueue::PullSendMessage()
 
 igtl::MessageBase::Pointer mitk::IGTLMessageQueue::PullMiscMessage()
 {
+  if (this->m_UseRingBuffers)
+    return this->m_MiscRingBuffer->Pull();
+
   igtl::MessageBase::Pointer ret = nullptr;
   this->m_Mutex->Lock();
   if (this->m_MiscQueue.size() > 0)
@@ -142,6 +186,9 @@ igtl::MessageBase::Pointer mitk::IGTLMessageQueue::PullMiscMessage()
 
 igtl::ImageMessage::Pointer mitk::IGTLMessageQueue::PullImage2dMessage()
 {
+  if (this->m_UseRingBuffers)
+    return this->m_Image2dRingBuffer->Pull();
+
   igtl::ImageMessage::Pointer ret = nullptr;
   this->m_Mutex->Lock();
   if (this->m_Image2dQueue.size() > 0)
@@ -155,6 +202,9 @@ igtl::ImageMessage::Pointer mitk::IGTLMessageQueue::PullImage2dMessage()
 
 igtl::ImageMessage::Pointer mitk::IGTLMessageQueue::PullImage3dMessage()
 {
+  if (this->m_UseRingBuffers)
+    return this->m_Image3dRingBuffer->Pull();
+
   igtl::ImageMessage::Pointer ret = nullptr;
   this->m_Mutex->Lock();
   if (this->m_Image3dQueue.size() > 0)
@@ -168,6 +218,9 @@ igtl::ImageMessage::Pointer mitk::IGTLMessageQueue::PullImage3dMessage()
 
 igtl::TrackingDataMessage::Pointer mitk::IGTLMessageQueue::PullTrackingMessage()
 {
+  if (this->m_UseRingBuffers)
+    return this->m_TrackingDataRingBuffer->Pull();
+
   igtl::TrackingDataMessage::Pointer ret = nullptr;
   this->m_Mutex->Lock();
   if (this->m_TrackingDataQueue.size() > 0)
@@ -194,6 +247,9 @@ igtl::MessageBase::Pointer mitk::IGTLMessageQueue::PullCommandMessage()
 
 igtl::StringMessage::Pointer mitk::IGTLMessageQueue::PullStringMessage()
 {
+  if (this->m_UseRingBuffers)
+    return this->m_StringRingBuffer->Pull();
+
   igtl::StringMessage::Pointer ret = nullptr;
   this->m_Mutex->Lock();
   if (this->m_StringQueue.size() > 0)
@@ -207,6 +263,9 @@ igtl::StringMessage::Pointer mitk::IGTLMessageQueue::PullStringMessage()
 
 igtl::TransformMessage::Pointer mitk::IGTLMessageQueue::PullTransformMessage()
 {
+  if (this->m_UseRingBuffers)
+    return this->m_TransformRingBuffer->Pull();
+
   igtl::TransformMessage::Pointer ret = nullptr;
   this->m_Mutex->Lock();
   if (this->m_TransformQueue.size() > 0)
@@ -220,7 +279,7 @@ igtl::TransformMessage::Pointer mitk::IGTLMessageQueue::PullTransformMessage()
 
 std::string mitk::IGTLMessageQueue::GetNextMsgInformationString()
 {
-  this->m_Mutex->Lock();
+  this->m_LatestMessageMutex->Lock();
   std::stringstream s;
   if (this->m_Latest_Message != nullptr)
   {
@@ -231,13 +290,13 @@ std::string mitk::IGTLMessageQueue::GetNextMsgInformationString()
   {
     s << "No Msg";
   }
-  this->m_Mutex->Unlock();
+  this->m_LatestMessageMutex->Unlock();
   return s.str();
 }
 
 std::string mitk::IGTLMessageQueue::GetNextMsgDeviceType()
 {
-  this->m_Mutex->Lock();
+  this->m_LatestMessageMutex->Lock();
   std::stringstream s;
   if (m_Latest_Message != nullptr)
   {
@@ -247,13 +306,13 @@ std::string mitk::IGTLMessageQueue::GetNextMsgDeviceType()
   {
     s << "";
   }
-  this->m_Mutex->Unlock();
+  this->m_LatestMessageMutex->Unlock();
   return s.str();
 }
 
 std::string mitk::IGTLMessageQueue::GetLatestMsgInformationString()
 {
-  this->m_Mutex->Lock();
+  this->m_LatestMessageMutex->Lock();
   std::stringstream s;
   if (m_Latest_Message != nullptr)
   {
@@ -264,13 +323,13 @@ std::string mitk::IGTLMessageQueue::GetLatestMsgInformationString()
   {
     s << "No Msg";
   }
-  this->m_Mutex->Unlock();
+  this->m_LatestMessageMutex->Unlock();
   return s.str();
 }
 
 std::string mitk::IGTLMessageQueue::GetLatestMsgDeviceType()
 {
-  this->m_Mutex->Lock();
+  this->m_LatestMessageMutex->Lock();
   std::stringstream s;
   if (m_Latest_Message != nullptr)
   {
@@ -280,14 +339,21 @@ std::string mitk::IGTLMessageQueue::GetLatestMsgDeviceType()
   {
     s << "";
   }
-  this->m_Mutex->Unlock();
+  this->m_LatestMessageMutex->Unlock();
   return s.str();
 }
 
 int mitk::IGTLMessageQueue::GetSize()
 {
-  return (this->m_CommandQueue.size() + this->m_Image2dQueue.size() + this->m_Image3dQueue.size() + this->m_MiscQueue.size()
+  int size = (this->m_CommandQueue.size() + this->m_Image2dQueue.size() + this->m_Image3dQueue.size() + this->m_MiscQueue.size()
     + this->m_StringQueue.size() + this->m_TrackingDataQueue.size() + this->m_TransformQueue.size());
+
+  if (this->m_UseRingBuffers)
+  {
+    size += this->m_Image2dRingBuffer->GetSize() + this->m_Image3dRingBuffer->GetSize() + this->m_MiscRingBuffer->GetSize()
+      + this->m_StringRingBuffer->GetSize() + this->m_TrackingDataRingBuffer->GetSize() + this->m_TransformRingBuffer->GetSize();
+  }
+  return size;
 }
 
 void mitk::IGTLMessageQueue::EnableNoBufferingMode(bool enable)
@@ -300,9 +366,67 @@ void mitk::IGTLMessageQueue::EnableNoBufferingMode(bool enable)
   this->m_Mutex->Unlock();
 }
 
+void mitk::IGTLMessageQueue::EnableRingBufferMode(bool enable, unsigned int capacity, OverflowPolicy policy)
+{
+  this->m_Mutex->Lock();
+
+  this->m_Image2dQueue.clear();
+  this->m_Image3dQueue.clear();
+  this->m_TransformQueue.clear();
+  this->m_TrackingDataQueue.clear();
+  this->m_StringQueue.clear();
+  this->m_MiscQueue.clear();
+
+  this->m_UseRingBuffers = enable;
+
+  if (enable)
+  {
+    this->m_Image2dRingBuffer.reset(new IGTLMessageRingBuffer<igtl::ImageMessage>(capacity,
+      static_cast<IGTLMessageRingBuffer<igtl::ImageMessage>::OverflowPolicy>(policy)));
+    this->m_Image3dRingBuffer.reset(new IGTLMessageRingBuffer<igtl::ImageMessage>(capacity,
+      static_cast<IGTLMessageRingBuffer<igtl::ImageMessage>::OverflowPolicy>(policy)));
+    this->m_TransformRingBuffer.reset(new IGTLMessageRingBuffer<igtl::TransformMessage>(capacity,
+      static_cast<IGTLMessageRingBuffer<igtl::TransformMessage>::OverflowPolicy>(policy)));
+    this->m_TrackingDataRingBuffer.reset(new IGTLMessageRingBuffer<igtl::TrackingDataMessage>(capacity,
+      static_cast<IGTLMessageRingBuffer<igtl::TrackingDataMessage>::OverflowPolicy>(policy)));
+    this->m_StringRingBuffer.reset(new IGTLMessageRingBuffer<igtl::StringMessage>(capacity,
+      static_cast<IGTLMessageRingBuffer<igtl::StringMessage>::OverflowPolicy>(policy)));
+    this->m_MiscRingBuffer.reset(new IGTLMessageRingBuffer<igtl::MessageBase>(capacity,
+      static_cast<IGTLMessageRingBuffer<igtl::MessageBase>::OverflowPolicy>(policy)));
+  }
+  else
+  {
+    this->m_Image2dRingBuffer.reset();
+    this->m_Image3dRingBuffer.reset();
+    this->m_TransformRingBuffer.reset();
+    this->m_TrackingDataRingBuffer.reset();
+    this->m_StringRingBuffer.reset();
+    this->m_MiscRingBuffer.reset();
+  }
+
+  this->m_Mutex->Unlock();
+}
+
+bool mitk::IGTLMessageQueue::IsRingBufferModeEnabled() const
+{
+  return this->m_UseRingBuffers;
+}
+
+unsigned long long mitk::IGTLMessageQueue::GetNumberOfDroppedMessages() const
+{
+  if (!this->m_UseRingBuffers)
+    return 0;
+
+  return this->m_Image2dRingBuffer->GetNumberOfDroppedMessages() + this->m_Image3dRingBuffer->GetNumberOfDroppedMessages()
+    + this->m_TransformRingBuffer->GetNumberOfDroppedMessages() + this->m_TrackingDataRingBuffer->GetNumberOfDroppedMessages()
+    + this->m_StringRingBuffer->GetNumberOfDroppedMessages() + this->m_MiscRingBuffer->GetNumberOfDroppedMessages();
+}
+
 mitk::IGTLMessageQueue::IGTLMessageQueue()
+  : m_UseRingBuffers(false)
 {
   this->m_Mutex = itk::FastMutexLock::New();
+  this->m_LatestMessageMutex = itk::FastMutexLock::New();
   this->m_BufferingType = IGTLMessageQueue::NoBuffering;
 }
 
@@ -24,7 +24,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkCommon.h"
 
 #include <deque>
+#include <memory>
 #include <mitkIGTLMessage.h>
+#include "mitkIGTLMessageRingBuffer.h"
 
 //OpenIGTLink
 #include "igtlMessageBase.h"
@@ -38,6 +40,13 @@ namespace mitk {
   * \class IGTLMessageQueue
   * \brief Thread safe message queue to store OpenIGTLink messages.
   *
+  * By default all queues are guarded by a single mutex. For high rate streams
+  * the incoming messages (tracking, transform, string, image and misc) can be
+  * stored in per-type lock-free ring buffers instead, see
+  * EnableRingBufferMode(). In this mode PushMessage() and the corresponding
+  * Pull methods never block each other, but each of them must only be called
+  * from one thread (single producer, single consumer).
+  *
   * \ingroup OpenIGTLink
   */
   class MITKOPENIGTLINK_EXPORT IGTLMessageQueue : public itk::Object
@@ -54,6 +63,13 @@ namespace mitk {
        */
     enum BufferingType { Infinit, NoBuffering };
 
+    /**
+     * \brief Defines which message is dropped if a ring buffer is full
+     * DropOldest overwrites the oldest message that was not pulled yet,
+     * DropNewest discards the incoming message
+     */
+    enum OverflowPolicy { DropOldest, DropNewest };
+
     void PushSendMessage(mitk::IGTLMessage::Pointer message);
 
     /**
@@ -108,10 +124,34 @@ namespace mitk {
      */
     void EnableNoBufferingMode(bool enable);
 
+    /**
+    * \brief Stores incoming messages in per-type lock-free ring buffers with
+    * the given capacity instead of the mutex guarded queues.
+    *
+    * Messages that are still in the queues are discarded. Must not be called
+    * while messages are pushed or pulled, i.e. configure the queue before the
+    * device starts communicating. The buffering type set by
+    * EnableNoBufferingMode() is ignored for the ring buffered messages.
+    */
+    void EnableRingBufferMode(bool enable, unsigned int capacity = 64, OverflowPolicy policy = DropOldest);
+
+    bool IsRingBufferModeEnabled() const;
+
+    /**
+    * \brief Returns the number of incoming messages that were dropped because
+    * their ring buffer was full
+    */
+    unsigned long long GetNumberOfDroppedMessages() const;
+
   protected:
     IGTLMessageQueue();
     ~IGTLMessageQueue() override;
 
+    /**
+    * \brief Sorts the message into the matching ring buffer without locking
+    */
+    void PushMessageToRingBuffers(igtl::MessageBase::Pointer message);
+
   protected:
     /**
     * \brief Mutex to take car of the queue
@@ -131,8 +171,25 @@ namespace mitk {
 
     std::deque< mitk::IGTLMessage::Pointer > m_SendQueue;
 
+    /**
+    * \brief lock-free ring buffers that replace the queues above in ring buffer mode
+    */
+    std::unique_ptr< IGTLMessageRingBuffer<igtl::ImageMessage> > m_Image2dRingBuffer;
+    std::unique_ptr< IGTLMessageRingBuffer<igtl::ImageMessage> > m_Image3dRingBuffer;
+    std::unique_ptr< IGTLMessageRingBuffer<igtl::TransformMessage> > m_TransformRingBuffer;
+    std::unique_ptr< IGTLMessageRingBuffer<igtl::TrackingDataMessage> > m_TrackingDataRingBuffer;
+    std::unique_ptr< IGTLMessageRingBuffer<igtl::StringMessage> > m_StringRingBuffer;
+    std::unique_ptr< IGTLMessageRingBuffer<igtl::MessageBase> > m_MiscRingBuffer;
+
+    bool m_UseRingBuffers;
+
     igtl::MessageBase::Pointer m_Latest_Message;
 
+    /**
+    * \brief Mutex that only guards m_Latest_Message in ring buffer mode
+    */
+    itk::FastMutexLock::Pointer m_LatestMessageMutex;
+
     /**
     * \brief defines the kind of buffering
     */
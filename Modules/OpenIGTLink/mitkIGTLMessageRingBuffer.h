@@ -0,0 +1,168 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef IGTLMessageRingBuffer_H
+#define IGTLMessageRingBuffer_H
+
+#include <atomic>
+#include <vector>
+
+namespace mitk {
+  /**
+  * \class IGTLMessageRingBuffer
+  * \brief Bounded single-producer/single-consumer lock-free ring buffer for
+  * OpenIGTLink messages.
+  *
+  * Exactly one thread may call Push() (typically the network receive thread)
+  * and exactly one thread may call Pull() (typically the consumer/rendering
+  * thread). Neither call ever blocks.
+  *
+  * Every slot holds a registered raw pointer that is handed over with an
+  * atomic exchange, so a message is always owned by exactly one side and the
+  * reference count can never be touched concurrently on the same slot.
+  *
+  * If the buffer is full, the OverflowPolicy decides which message is lost:
+  * DropNewest rejects the incoming message, DropOldest overwrites the oldest
+  * message that has not been pulled yet. Lost messages are counted and can be
+  * queried with GetNumberOfDroppedMessages().
+  *
+  * \ingroup OpenIGTLink
+  */
+  template <class TMessage>
+  class IGTLMessageRingBuffer
+  {
+  public:
+    typedef TMessage MessageType;
+    typedef typename MessageType::Pointer MessagePointer;
+
+    enum OverflowPolicy { DropOldest, DropNewest };
+
+    explicit IGTLMessageRingBuffer(unsigned int capacity, OverflowPolicy policy = DropOldest)
+      : m_Slots(capacity > 0 ? capacity : 1),
+        m_Policy(policy),
+        m_Head(0),
+        m_Tail(0),
+        m_Dropped(0)
+    {
+      for (auto& slot : m_Slots)
+        slot.store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~IGTLMessageRingBuffer()
+    {
+      for (auto& slot : m_Slots)
+      {
+        MessageType* msg = slot.exchange(nullptr);
+        if (msg != nullptr)
+          msg->UnRegister();
+      }
+    }
+
+    IGTLMessageRingBuffer(const IGTLMessageRingBuffer&) = delete;
+    IGTLMessageRingBuffer& operator=(const IGTLMessageRingBuffer&) = delete;
+
+    /**
+    * \brief Adds a message to the buffer. Must only be called by the producer.
+    * \return false if the message was rejected (DropNewest and buffer full)
+    */
+    bool Push(MessageType* message)
+    {
+      if (message == nullptr)
+        return false;
+
+      const unsigned long long head = m_Head.load(std::memory_order_relaxed);
+      const unsigned long long tail = m_Tail.load(std::memory_order_acquire);
+
+      if (head - tail >= m_Slots.size() && m_Policy == DropNewest)
+      {
+        ++m_Dropped;
+        return false;
+      }
+
+      message->Register();
+      MessageType* previous = m_Slots[head % m_Slots.size()].exchange(message, std::memory_order_acq_rel);
+      if (previous != nullptr)
+      {
+        // the consumer did not pick up this slot in time, so it is overwritten
+        previous->UnRegister();
+        ++m_Dropped;
+      }
+
+      m_Head.store(head + 1, std::memory_order_release);
+      return true;
+    }
+
+    /**
+    * \brief Returns and removes the oldest message from the buffer or nullptr
+    * if it is empty. Must only be called by the consumer.
+    */
+    MessagePointer Pull()
+    {
+      unsigned long long tail = m_Tail.load(std::memory_order_relaxed);
+      const unsigned long long head = m_Head.load(std::memory_order_acquire);
+
+      // skip the slots that were overwritten by the producer in the meantime
+      if (head - tail > m_Slots.size())
+        tail = head - m_Slots.size();
+
+      MessagePointer ret;
+      while (tail < head)
+      {
+        MessageType* msg = m_Slots[tail % m_Slots.size()].exchange(nullptr, std::memory_order_acq_rel);
+        ++tail;
+        if (msg != nullptr)
+        {
+          ret = msg;
+          msg->UnRegister();
+          break;
+        }
+      }
+
+      m_Tail.store(tail, std::memory_order_release);
+      return ret;
+    }
+
+    /**
+    * \brief Approximate number of messages that are currently buffered
+    */
+    unsigned int GetSize() const
+    {
+      const unsigned long long tail = m_Tail.load(std::memory_order_acquire);
+      const unsigned long long head = m_Head.load(std::memory_order_acquire);
+      const unsigned long long size = head - tail;
+      return static_cast<unsigned int>(size < m_Slots.size() ? size : m_Slots.size());
+    }
+
+    unsigned int GetCapacity() const { return static_cast<unsigned int>(m_Slots.size()); }
+
+    OverflowPolicy GetOverflowPolicy() const { return m_Policy; }
+
+    unsigned long long GetNumberOfDroppedMessages() const { return m_Dropped.load(); }
+
+  private:
+    std::vector< std::atomic<MessageType*> > m_Slots;
+    const OverflowPolicy m_Policy;
+
+    /** \brief Number of messages pushed so far, written by the producer only */
+    std::atomic<unsigned long long> m_Head;
+    /** \brief Number of slots consumed so far, written by the consumer only */
+    std::atomic<unsigned long long> m_Tail;
+
+    std::atomic<unsigned long long> m_Dropped;
+  };
+}
+
+#endif
@@ -25,8 +25,105 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <igtlImageMessage.h>
 #include <igtl_status.h>
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+/**
+* Send queue of one client in broadcast mode. The packed messages are shared by
+* the queues of all clients and never modified after they were packed. The
+* sending thread blocks in igtl::Socket::Send() at most for the send timeout of
+* the socket, so a stalled client is detected without delaying the others.
+*/
+class mitk::IGTLServer::ClientSender
+{
+public:
+  typedef std::shared_ptr<const std::string> BufferType;
+
+  explicit ClientSender(igtl::Socket* socket)
+    : m_Socket(socket), m_Stop(false), m_Failed(false)
+  {
+    m_Thread = std::thread(&ClientSender::Run, this);
+  }
+
+  ~ClientSender()
+  {
+    this->Stop();
+  }
+
+  /** appends a buffer, returns the number of skipped buffers or -1 if the queue is full and nothing may be skipped */
+  int Enqueue(const BufferType& buffer, unsigned int maximumSize, bool skipOldest)
+  {
+    int skipped = 0;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      while (m_Queue.size() >= maximumSize && !m_Queue.empty())
+      {
+        if (!skipOldest)
+          return -1;
+        m_Queue.pop_front();
+        ++skipped;
+      }
+      m_Queue.push_back(buffer);
+    }
+    m_Condition.notify_one();
+    return skipped;
+  }
+
+  /** true if sending to the client failed */
+  bool HasFailed() const { return m_Failed; }
+
+  /** stops the sending thread, the socket has to be closed before if the thread may block in Send() */
+  void Stop()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Stop = true;
+    }
+    m_Condition.notify_one();
+    if (m_Thread.joinable())
+      m_Thread.join();
+  }
+
+private:
+  void Run()
+  {
+    while (true)
+    {
+      BufferType buffer;
+      {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Condition.wait(lock, [this] { return m_Stop || !m_Queue.empty(); });
+        if (m_Stop)
+          return;
+        buffer = m_Queue.front();
+        m_Queue.pop_front();
+      }
+      if (!m_Socket->Send(buffer->data(), buffer->size()))
+      {
+        m_Failed = true;
+        return;
+      }
+    }
+  }
+
+  igtl::Socket::Pointer m_Socket;
+  std::deque<BufferType> m_Queue;
+  std::mutex m_Mutex;
+  std::condition_variable m_Condition;
+  std::thread m_Thread;
+  bool m_Stop;
+  std::atomic<bool> m_Failed;
+};
+
 mitk::IGTLServer::IGTLServer(bool ReadFully) :
-IGTLDevice(ReadFully)
+IGTLDevice(ReadFully),
+m_BroadcastMode(false),
+m_BroadcastQueueSize(16),
+m_BroadcastOverflowPolicy(SkipOldestMessages),
+m_BroadcastSendTimeout(1000),
+m_NumberOfSkippedMessages(0)
 {
   m_ReceiveListMutex = itk::FastMutexLock::New();
   m_SentListMutex = itk::FastMutexLock::New();
@@ -102,6 +199,11 @@ void mitk::IGTLServer::Connect()
     m_SentListMutex->Lock();
     m_ReceiveListMutex->Lock();
     this->m_RegisteredClients.push_back(socket);
+    if (m_BroadcastMode)
+    {
+      socket->SetSendTimeout(m_BroadcastSendTimeout);
+      m_ClientSenders[socket.GetPointer()] = std::make_shared<ClientSender>(socket);
+    }
     m_SentListMutex->Unlock();
     m_ReceiveListMutex->Unlock();
     //inform observers about this new client
@@ -157,6 +259,12 @@ void mitk::IGTLServer::Send()
   if (curMessage.IsNull())
     return;
 
+  if (m_BroadcastMode)
+  {
+    this->Broadcast(curMessage);
+    return;
+  }
+
   //the server can be connected with several clients, therefore it has to check
   //all registered clients
   //sending a message to all registered clients might not be the best solution,
@@ -177,6 +285,54 @@ void mitk::IGTLServer::Send()
   m_SentListMutex->Unlock();
 }
 
+void mitk::IGTLServer::Broadcast(mitk::IGTLMessage* message)
+{
+  // pack once, all clients share the same buffer
+  igtl::MessageBase* sendMessage = message->GetMessage();
+  sendMessage->Pack();
+  ClientSender::BufferType buffer = std::make_shared<const std::string>(
+    static_cast<const char*>(sendMessage->GetPackPointer()), sendMessage->GetPackSize());
+
+  const bool skipOldest = (m_BroadcastOverflowPolicy == SkipOldestMessages);
+  SocketListType socketsToBeRemoved;
+
+  m_SentListMutex->Lock();
+  for (auto it = m_ClientSenders.begin(); it != m_ClientSenders.end(); ++it)
+  {
+    if (it->second->HasFailed())
+    {
+      socketsToBeRemoved.push_back(it->first);
+      MITK_WARN("IGTLServer") << "Could not send to a client socket, it will be disconnected.";
+      continue;
+    }
+    int skipped = it->second->Enqueue(buffer, m_BroadcastQueueSize, skipOldest);
+    if (skipped < 0)
+    {
+      socketsToBeRemoved.push_back(it->first);
+      MITK_WARN("IGTLServer") << "Send queue of a client socket is full, it will be disconnected.";
+    }
+    else
+    {
+      m_NumberOfSkippedMessages += skipped;
+    }
+  }
+  m_SentListMutex->Unlock();
+
+  if (m_LogMessages) { MITK_INFO << "Broadcast IGTL message: " << message->ToString(); }
+  this->InvokeEvent(MessageSentEvent());
+
+  if (socketsToBeRemoved.size() > 0)
+  {
+    this->StopCommunicationWithSocket(socketsToBeRemoved);
+    this->InvokeEvent(LostConnectionEvent());
+  }
+}
+
+unsigned long mitk::IGTLServer::GetNumberOfSkippedMessages() const
+{
+  return m_NumberOfSkippedMessages;
+}
+
 void mitk::IGTLServer::StopCommunicationWithSocket(
   SocketListType& toBeRemovedSockets)
 {
@@ -186,15 +342,22 @@ void mitk::IGTLServer::StopCommunicationWithSocket(
 
 void mitk::IGTLServer::StopCommunicationWithSocket(igtl::Socket* client)
 {
+  std::shared_ptr<ClientSender> sender;
   m_SentListMutex->Lock();
   m_ReceiveListMutex->Lock();
+  auto senderIt = m_ClientSenders.find(client);
+  if (senderIt != m_ClientSenders.end())
+  {
+    sender = senderIt->second;
+    m_ClientSenders.erase(senderIt);
+  }
   auto i = m_RegisteredClients.begin();
   auto end = m_RegisteredClients.end();
   while (i != end)
   {
     if ((*i) == client)
     {
-      //    //close the socket
+      //    //close the socket, this also releases a sender blocked in Send()
       (*i)->CloseSocket();
       //and remove it from the list
       i = this->m_RegisteredClients.erase(i);
@@ -208,6 +371,10 @@ void mitk::IGTLServer::StopCommunicationWithSocket(igtl::Socket* client)
   }
   m_SentListMutex->Unlock();
   m_ReceiveListMutex->Unlock();
+
+  //wait for the sending thread of the client outside of the locks
+  if (sender)
+    sender->Stop();
 }
 
 unsigned int mitk::IGTLServer::GetNumberOfConnections()
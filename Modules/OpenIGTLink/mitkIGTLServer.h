@@ -21,6 +21,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <MitkOpenIGTLinkExports.h>
 
+#include <atomic>
+#include <map>
+#include <memory>
+
 namespace mitk
 {
   /**
@@ -32,6 +36,14 @@ namespace mitk
   * connect to several clients. Therefore, it is necessary for the server to
   * have a list with registered sockets.
   *
+  * By default, every message is packed and sent to one client after the other by the
+  * sending thread, so a slow client delays all others. In broadcast mode
+  * (SetBroadcastMode()) a message is packed only once into a shared, immutable buffer
+  * which is appended to a bounded send queue of every client. Each client has its own
+  * sending thread, so a slow client only delays itself. If the queue of a client is full,
+  * either the oldest queued messages of that client are skipped or the client is
+  * disconnected (see SetBroadcastOverflowPolicy()).
+  *
   * \ingroup OpenIGTLink
   */
   class MITKOPENIGTLINK_EXPORT IGTLServer : public IGTLDevice
@@ -67,6 +79,37 @@ namespace mitk
     */
     unsigned int GetNumberOfConnections() override;
 
+    /** \brief What happens if the send queue of a client is full in broadcast mode */
+    enum BroadcastOverflowPolicy
+    {
+      SkipOldestMessages, ///< the oldest queued message of the client is dropped
+      DisconnectClient    ///< the client is disconnected
+    };
+
+    /**
+    * \brief Enables the broadcast mode (see class description). Has to be set before
+    * clients connect. Default is false.
+    */
+    itkSetMacro(BroadcastMode, bool);
+    itkGetConstMacro(BroadcastMode, bool);
+    itkBooleanMacro(BroadcastMode);
+
+    /** \brief Maximum number of messages queued per client in broadcast mode. Default is 16. */
+    itkSetMacro(BroadcastQueueSize, unsigned int);
+    itkGetConstMacro(BroadcastQueueSize, unsigned int);
+
+    /** \brief Policy for clients whose queue is full in broadcast mode. Default is SkipOldestMessages. */
+    itkSetMacro(BroadcastOverflowPolicy, BroadcastOverflowPolicy);
+    itkGetConstMacro(BroadcastOverflowPolicy, BroadcastOverflowPolicy);
+
+    /** \brief Send timeout in ms of the client sockets in broadcast mode. A client which does not
+    * accept data within this time is disconnected. Default is 1000. */
+    itkSetMacro(BroadcastSendTimeout, int);
+    itkGetConstMacro(BroadcastSendTimeout, int);
+
+    /** \brief Returns the number of messages which were skipped for slow clients in broadcast mode. */
+    unsigned long GetNumberOfSkippedMessages() const;
+
   protected:
     /** Constructor */
     IGTLServer(bool ReadFully);
@@ -97,6 +140,11 @@ namespace mitk
     */
     void Send() override;
 
+    /**
+    * \brief Packs the message once and appends it to the send queues of all clients.
+    */
+    void Broadcast(mitk::IGTLMessage* message);
+
     /**
       * \brief Stops the communication with the given sockets.
       *
@@ -123,6 +171,18 @@ namespace mitk
 
     /** mutex to control access to m_RegisteredClients */
     itk::FastMutexLock::Pointer m_SentListMutex;
+
+    /** the send queue and sending thread of a client in broadcast mode */
+    class ClientSender;
+
+    /** senders of all registered clients in broadcast mode, guarded by m_SentListMutex */
+    std::map<igtl::Socket*, std::shared_ptr<ClientSender> > m_ClientSenders;
+
+    bool m_BroadcastMode;
+    unsigned int m_BroadcastQueueSize;
+    BroadcastOverflowPolicy m_BroadcastOverflowPolicy;
+    int m_BroadcastSendTimeout;
+    std::atomic<unsigned long> m_NumberOfSkippedMessages;
   };
 } // namespace mitk
 #endif /* MITKIGTLSERVER_H */
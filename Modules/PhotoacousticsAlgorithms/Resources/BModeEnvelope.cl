@@ -0,0 +1,161 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+unsigned int ReverseBits(unsigned int value, unsigned int bits)
+{
+  unsigned int reversed = 0;
+  for (unsigned int bit = 0; bit < bits; ++bit)
+  {
+    reversed = (reversed << 1) | (value & 1);
+    value >>= 1;
+  }
+  return reversed;
+}
+
+// in place radix-2 FFT of bit reversed data in local memory, computed by all work items of the group
+void TransformLine(__local float2* sLine, unsigned int length, float direction)
+{
+  unsigned int localId = get_local_id(0);
+  unsigned int localSize = get_local_size(0);
+
+  for (unsigned int size = 2; size <= length; size <<= 1)
+  {
+    unsigned int half = size >> 1;
+    for (unsigned int butterfly = localId; butterfly < length / 2; butterfly += localSize)
+    {
+      unsigned int k = butterfly & (half - 1);
+      unsigned int i = (butterfly - k) * 2 + k;
+      unsigned int j = i + half;
+
+      float cosine;
+      float sine = sincos(direction * 2.0f * M_PI_F * k / size, &cosine);
+      float2 value = sLine[j];
+      float2 t = (float2)(cosine * value.x - sine * value.y, cosine * value.y + sine * value.x);
+
+      sLine[j] = sLine[i] - t;
+      sLine[i] = sLine[i] + t;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+  }
+}
+
+__kernel void ckBmodeEnvelope(
+  __global float* dData, // image, processed in place
+  __global float* dLineMaximum, // output: maximum of every scan line
+  __local float2* sLine, // fftLength complex values
+  unsigned int lines,
+  unsigned int samples,
+  unsigned int fftLength,
+  unsigned int log2Length,
+  unsigned int useEnvelopeDetection
+)
+{
+  // one work group per scan line; the work group size is a power of two not larger than fftLength / 2
+  unsigned int line = get_group_id(0);
+  unsigned int slice = get_global_id(1);
+  unsigned int localId = get_local_id(0);
+  unsigned int localSize = get_local_size(0);
+
+  __global float* dLine = dData + (size_t)slice * lines * samples + line;
+
+  if (useEnvelopeDetection)
+  {
+    // load the zero padded line in bit reversed order
+    for (unsigned int i = localId; i < fftLength; i += localSize)
+    {
+      sLine[ReverseBits(i, log2Length)] = (float2)(i < samples ? dLine[(size_t)i * lines] : 0.0f, 0.0f);
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    TransformLine(sLine, fftLength, -1.0f);
+
+    // analytic signal: keep the DC and Nyquist components, double the positive and remove the negative frequencies
+    for (unsigned int i = localId; i < fftLength; i += localSize)
+    {
+      float weight = (i == 0 || i == fftLength / 2) ? 1.0f : (i < fftLength / 2 ? 2.0f : 0.0f);
+      sLine[i] *= weight / fftLength;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // bit reversal for the inverse transform; the swapped pairs are disjoint
+    for (unsigned int i = localId; i < fftLength; i += localSize)
+    {
+      unsigned int j = ReverseBits(i, log2Length);
+      if (i < j)
+      {
+        float2 value = sLine[i];
+        sLine[i] = sLine[j];
+        sLine[j] = value;
+      }
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    TransformLine(sLine, fftLength, 1.0f);
+  }
+
+  float maximum = 0.0f;
+  for (unsigned int i = localId; i < samples; i += localSize)
+  {
+    float envelope = useEnvelopeDetection ? length(sLine[i]) : fabs(dLine[(size_t)i * lines]);
+    dLine[(size_t)i * lines] = envelope;
+    maximum = fmax(maximum, envelope);
+  }
+
+  // reduce the maximum of the line, reusing the local memory
+  barrier(CLK_LOCAL_MEM_FENCE);
+  __local float* sMaximum = (__local float*)sLine;
+  sMaximum[localId] = maximum;
+  barrier(CLK_LOCAL_MEM_FENCE);
+
+  for (unsigned int stride = localSize / 2; stride > 0; stride >>= 1)
+  {
+    if (localId < stride)
+      sMaximum[localId] = fmax(sMaximum[localId], sMaximum[localId + stride]);
+    barrier(CLK_LOCAL_MEM_FENCE);
+  }
+
+  if (localId == 0)
+    dLineMaximum[slice * lines + line] = sMaximum[0];
+}
+
+__kernel void ckBmodeLogCompression(
+  __global float* dData, // envelope image, processed in place
+  __global float* dLineMaximum, // maximum of every scan line
+  unsigned int lines,
+  unsigned int samples,
+  float dynamicRange // [dB]
+)
+{
+  unsigned int line = get_global_id(0);
+  unsigned int slice = get_global_id(1);
+
+  if (line >= lines)
+    return;
+
+  float maximum = 0.0f;
+  for (unsigned int l = 0; l < lines; ++l)
+  {
+    maximum = fmax(maximum, dLineMaximum[slice * lines + l]);
+  }
+
+  __global float* dLine = dData + (size_t)slice * lines * samples + line;
+  for (unsigned int i = 0; i < samples; ++i)
+  {
+    float envelope = dLine[(size_t)i * lines];
+    float decibel = (maximum > 0.0f && envelope > 0.0f) ? 20.0f * log10(envelope / maximum) : -dynamicRange;
+    dLine[(size_t)i * lines] = clamp((decibel + dynamicRange) / dynamicRange, 0.0f, 1.0f);
+  }
+}
@@ -17,6 +17,7 @@ ENDIF(MITK_USE_OpenCL)
 set(RESOURCE_FILES
   BModeAbs.cl
   BModeAbsLog.cl
+  BModeEnvelope.cl
   UsedLinesCalculation.cl
   DelayCalculation.cl
   DMAS.cl
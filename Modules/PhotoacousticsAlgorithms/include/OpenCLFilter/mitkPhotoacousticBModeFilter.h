@@ -28,11 +28,45 @@ namespace mitk
 {
   #if defined(PHOTOACOUSTICS_USE_GPU) || DOXYGEN
 
+  /*!
+  * \brief The B-mode computation on the GPU, working in place on a device buffer of float data
+  *
+  *  The kernels are created from a program built from BModeEnvelope.cl. The envelope of each scan line (along the second
+  *  dimension) is detected with one work group per line, which transforms the line in local memory, so the line length
+  *  rounded up to the next power of two must fit into the local memory of the device. The stage is used by
+  *  mitk::PhotoacousticOCLBModeFilter and by mitk::PhotoacousticOCLBeamformingFilter, which applies it to its output buffer
+  *  before the data is read back.
+  */
+  class PhotoacousticOCLBModeStage
+  {
+  public:
+    PhotoacousticOCLBModeStage();
+    ~PhotoacousticOCLBModeStage();
+
+    /** \brief Creates the kernels from the given program; returns false if they could not be created */
+    bool Initialize(cl_program program);
+
+    /** \brief Enqueues the B-mode computation of the data with the given dimensions on the queue
+    *
+    * @param useEnvelopeDetection If true, the envelope is the magnitude of the analytic signal of each scan line, otherwise the absolute value
+    * @param dynamicRange If greater than 0, the envelope is log compressed and dynamicRange dB below the maximum of each slice are mapped to [0, 1]
+    */
+    void Enqueue(cl_command_queue queue, cl_mem data, const unsigned int dimensions[3], bool useEnvelopeDetection, float dynamicRange);
+
+  private:
+    cl_kernel m_EnvelopeKernel;
+    cl_kernel m_LogCompressionKernel;
+    /** maximum of every scan line, needed for the log compression */
+    cl_mem m_LineMaximumBuffer;
+    size_t m_LineMaximumBufferSize;
+  };
+
   /*!
   * \brief Class implementing a mitk::OclDataSetToDataSetFilter for BMode filtering on GPU
   *
-  *  The only parameter that needs to be provided is whether it should use a logfilter.
-  *  Currently this class only performs an absolute BMode filter.
+  *  By default the absolute value of the input is computed and optionally a log filter is applied. With
+  *  SetBModeParameters() the envelope can be detected by a Hilbert transform along each scan line, followed by a log
+  *  compression to a given dynamic range (see mitk::PhotoacousticOCLBModeStage).
   */
   class PhotoacousticOCLBModeFilter : public OclDataSetToDataSetFilter, public itk::Object
   {
@@ -54,8 +88,19 @@ namespace mitk
     void SetParameters(bool useLogFilter)
     {
       m_UseLogFilter = useLogFilter;
-    }    
-    
+    }
+
+    /** \brief Set the parameters of the full B-mode computation
+    *
+    * @param useEnvelopeDetection If true, the envelope is detected by a Hilbert transform along each scan line instead of the absolute value
+    * @param dynamicRange If greater than 0, the envelope is log compressed and dynamicRange dB below the maximum of each slice are mapped to [0, 1]; the log filter is not applied then
+    */
+    void SetBModeParameters(bool useEnvelopeDetection, float dynamicRange)
+    {
+      m_UseEnvelopeDetection = useEnvelopeDetection;
+      m_DynamicRange = dynamicRange;
+    }
+
     /**
      * @brief GetOutput Returns an mitk::Image constructed from the processed data
      */
@@ -87,6 +132,9 @@ namespace mitk
     /** The OpenCL kernel for the filter */
     cl_kernel m_PixelCalculation;
     bool m_UseLogFilter;
+    bool m_UseEnvelopeDetection;
+    float m_DynamicRange;
+    PhotoacousticOCLBModeStage m_BModeStage;
 
     mitk::Image::Pointer m_InputImage;
     unsigned int m_InputDim[3];
@@ -98,8 +146,9 @@ namespace mitk
   /*!
   * \brief Class implementing a mitk::ImageToImageFilter for BMode filtering on CPU
   *
-  *  The only parameter that needs to be provided is whether it should use a logfilter.
-  *  Currently this class only performs an absolute BMode filter.
+  *  By default the absolute value of the input is computed and optionally a log filter is applied. With
+  *  SetBModeParameters() the envelope can be detected by a Hilbert transform along each scan line, followed by a log
+  *  compression to a given dynamic range (see ComputeBMode()).
   */
   class PhotoacousticBModeFilter : public ImageToImageFilter
   {
@@ -118,6 +167,28 @@ namespace mitk
       m_UseLogFilter = useLogFilter;
     }
 
+    /** \brief Set the parameters of the full B-mode computation
+    *
+    * @param useEnvelopeDetection If true, the envelope is detected by a Hilbert transform along each scan line instead of the absolute value
+    * @param dynamicRange If greater than 0, the envelope is log compressed and dynamicRange dB below the maximum of each slice are mapped to [0, 1]; the log filter is not applied then
+    */
+    void SetBModeParameters(bool useEnvelopeDetection, float dynamicRange)
+    {
+      m_UseEnvelopeDetection = useEnvelopeDetection;
+      m_DynamicRange = dynamicRange;
+    }
+
+    /** \brief Computes the B-mode of float data in place
+    *
+    * The scan lines run along the second dimension. For the envelope detection, each line is zero padded to the next power
+    * of two and its analytic signal is computed with a forward and an inverse FFT. The lines of all slices are distributed
+    * over numberOfThreads threads; 0 uses one thread per available core.
+    * @param data The data of dimensions[0] * dimensions[1] * dimensions[2] floats
+    * @param useEnvelopeDetection If true, the envelope is the magnitude of the analytic signal of each scan line, otherwise the absolute value
+    * @param dynamicRange If greater than 0, the envelope is log compressed and dynamicRange dB below the maximum of each slice are mapped to [0, 1]
+    */
+    static void ComputeBMode(float* data, const unsigned int dimensions[3], bool useEnvelopeDetection, float dynamicRange, unsigned int numberOfThreads = 0);
+
   protected:
 
     PhotoacousticBModeFilter();
@@ -135,6 +206,8 @@ namespace mitk
     itk::TimeStamp m_TimeOfHeaderInitialization;
 
     bool m_UseLogFilter;
+    bool m_UseEnvelopeDetection;
+    float m_DynamicRange;
   };
 }
 #endif
@@ -26,8 +26,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkPhotoacousticOCLDelayCalculation.h"
 #include "mitkPhotoacousticOCLUsedLinesCalculation.h"
 #include "mitkPhotoacousticBeamformingSettings.h"
+#include "mitkPhotoacousticBModeFilter.h"
 
 #include <chrono>
+#include <vector>
 
 namespace mitk
 {
@@ -36,6 +38,14 @@ namespace mitk
   *
   *  The class must be given a configuration class instance of mitk::BeamformingSettings for beamforming parameters through mitk::PhotoacousticOCLBeamformingFilter::SetConfig(BeamformingSettings settings)
   *  Additional configuration of the apodisation function is needed.
+  *
+  *  In streaming mode (see SetStreamingMode()) the input and output buffers stay resident on the device and are only
+  *  reallocated if a larger frame arrives. The input is passed with EnqueueInput(), which uploads into one of two device
+  *  buffers without blocking, so the next frame can be transferred while the current one is beamformed by Update().
+  *  The delay and used lines tables are only recomputed if the relevant settings changed.
+  *
+  *  If BeamformingSettings::UseBMode is set, the B-mode (see mitk::PhotoacousticOCLBModeStage) is computed on the device
+  *  right after beamforming, in place in the output buffer, so reconstruction and B-mode need a single transfer back.
   */
 
 class PhotoacousticOCLBeamformingFilter : public OclDataSetToDataSetFilter, public itk::Object
@@ -63,9 +73,29 @@ public:
   */
   mitk::Image::Pointer GetOutputAsImage();
 
-  /** \brief Update the filter */
+  /** \brief Update the filter
+  *
+  * In streaming mode, the oldest input passed to EnqueueInput() which was not beamformed yet is processed.
+  */
   void Update();
 
+  /** \brief Enables or disables the streaming mode, in which device buffers are kept across frames */
+  void SetStreamingMode(bool streaming);
+  bool GetStreamingMode() const { return m_StreamingMode; }
+
+  /** \brief Starts the non-blocking upload of the next input frame in streaming mode.
+  *
+  * At most two frames can be pending. The host memory must stay valid until the frame was processed by Update().
+  * @param data the float input data
+  * @param dimensions the three dimensions of the input data
+  */
+  void EnqueueInput(const void* data, unsigned int* dimensions);
+
+  /** \brief Copies the result of the last Update() into the given host memory, which must be large enough to hold
+  * ReconstructionLines * SamplesPerLine * inputDim[2] floats. Avoids allocating a new host buffer per frame.
+  */
+  void GetOutput(void* output);
+
   /** \brief Set the Apodisation function to apply when beamforming */
   void SetApodisation(float* apodisation, unsigned short apodArraySize)
   {
@@ -91,6 +121,15 @@ protected:
   /** \brief Updated the used data for beamforming depending on whether the configuration has significantly changed */
   void UpdateDataBuffers();
 
+  /** \brief Recomputes the apodisation, used lines and delay tables if the relevant settings changed */
+  void UpdateLookupTables();
+
+  /** \brief Makes sure the resident output buffer can hold the output of the current configuration */
+  void UpdateStreamingOutputBuffer();
+
+  /** \brief Releases all resident streaming buffers and pending uploads */
+  void ReleaseStreamingBuffers();
+
   /** \brief Execute the filter */
   void Execute();
 
@@ -109,6 +148,8 @@ protected:
 private:
   /** The OpenCL kernel for the filter */
   cl_kernel m_PixelCalculation;
+  /** The algorithm m_PixelCalculation was created for; the kernel is only recreated if it changes */
+  BeamformingSettings::BeamformingAlgorithm m_KernelAlgorithm;
 
   unsigned int m_OutputDim[3];
 
@@ -124,6 +165,8 @@ private:
 
   size_t m_ChunkSize[3];
 
+  PhotoacousticOCLBModeStage m_BModeStage;
+
   mitk::OCLUsedLinesCalculation::Pointer m_UsedLinesCalculation;
   mitk::OCLDelayCalculation::Pointer m_DelayCalculation;
 
@@ -131,6 +174,27 @@ private:
   cl_mem m_MemoryLocationsBuffer;
   cl_mem m_DelaysBuffer;
   cl_mem m_UsedLinesBuffer;
+
+  /** \brief Everything needed to beamform a frame that was passed to EnqueueInput() */
+  struct PendingInput
+  {
+    unsigned int BufferIndex;
+    unsigned int Dimensions[3];
+    cl_event UploadFinished;
+  };
+
+  bool m_StreamingMode;
+  /** Queue used for the uploads in streaming mode, so they can overlap with the kernels on m_CommandQue */
+  cl_command_queue m_TransferQueue;
+  cl_mem m_StreamingInputBuffers[2];
+  size_t m_StreamingInputBufferSizes[2];
+  unsigned int m_NextInputBuffer;
+  /** Input buffer read by the kernels of the last Update() that were not waited for yet, -1 if none */
+  int m_BusyInputBuffer;
+  std::vector<PendingInput> m_PendingInputs;
+  cl_mem m_StreamingOutputBuffer;
+  size_t m_StreamingOutputBufferSize;
+  size_t m_StreamingOutputSize;
 };
 }
 #else
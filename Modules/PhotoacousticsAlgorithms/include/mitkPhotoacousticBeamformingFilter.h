@@ -117,6 +117,17 @@ namespace mitk {
     */
     void sDMASSphericalLine(float* input, float* output, float inputDim[2], float outputDim[2], const short& line, float* apodisation, const short& apodArraySize);
 
+    /** \brief Performs beamforming on CPU for all slices of the input, distributing the lines of all slices over a fixed number
+    * of threads. The result is written to the output image.
+    */
+    void BeamformOnCPU(mitk::Image::Pointer input, mitk::Image::Pointer output, float* apodisation);
+    /** \brief Function to perform beamforming on CPU for a single line, supporting all algorithms and delay calculation methods
+    *
+    * For DMAS and sDMAS the sum over all pairs of signed square roots is computed as ((sum b)^2 - sum b^2) / 2,
+    * where b are the signed square roots of the single apodized samples, which makes it linear instead of quadratic in the number of used lines.
+    */
+    void BeamformLine(const float* input, float* output, const float inputDim[2], const float outputDim[2], short line, const float* apodisation, short apodArraySize);
+
     float* m_OutputData;
     float* m_InputData;
     float* m_InputDataPuffer;
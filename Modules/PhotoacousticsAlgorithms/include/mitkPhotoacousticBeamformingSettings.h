@@ -74,6 +74,19 @@ namespace mitk {
     */
     bool UseGPU = true;
 
+    /** \brief Decides whether the GPU path keeps its buffers resident on the device and uploads the next batch of slices
+    * while the current one is beamformed.
+    */
+    bool UseGPUStreaming = true;
+
+    /** \brief Decides whether the CPU path distributes all lines of all slices over a fixed pool of threads and evaluates the
+    * pairwise DMAS sums in linear time. If false, the reference implementation using one thread per line is used.
+    */
+    bool UseFastCPUBeamforming = true;
+    /** \brief Sets how many threads the fast CPU beamformer uses; 0 uses one thread per available core.
+    */
+    unsigned int NumberOfCPUThreads = 0;
+
     /** \brief Available delay calculation methods:
     * - Spherical delay for best results.
     * - A quadratic Taylor approximation for slightly faster results with hardly any quality loss.
@@ -114,6 +127,19 @@ namespace mitk {
     /** \brief Sets the position at which higher frequencies are completely cut off in Hz.
     */
     float BPLowPass = 50;
+
+    /** \brief Decides whether the B-mode is computed from the beamformed data before it leaves the beamformer.
+    * On the GPU the B-mode runs on the device buffer of the beamformed data, so only the B-mode image is transferred back.
+    */
+    bool UseBMode = false;
+    /** \brief Sets whether the B-mode detects the envelope as the magnitude of the analytic signal of each scan line
+    * (Hilbert transform); otherwise the absolute value is used.
+    */
+    bool UseEnvelopeDetection = true;
+    /** \brief Sets the dynamic range of the log compression in dB: the range from the maximum of each slice down to
+    * BModeDynamicRange dB below it is mapped to [0, 1]. 0 disables the log compression.
+    */
+    float BModeDynamicRange = 60;
     
     /** \brief function for mitk::PhotoacousticOCLBeamformingFilter to check whether buffers need to be updated
     * this method only checks parameters relevant for the openCL implementation
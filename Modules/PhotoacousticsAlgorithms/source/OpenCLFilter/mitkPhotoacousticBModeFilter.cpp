@@ -17,14 +17,197 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "./OpenCLFilter/mitkPhotoacousticBModeFilter.h"
 #include "usServiceReference.h"
 #include <mitkImageReadAccessor.h>
+#include <itkMath.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  /** smallest power of two which is not smaller than length */
+  unsigned int NextPowerOfTwo(unsigned int length)
+  {
+    unsigned int powerOfTwo = 1;
+    while (powerOfTwo < length)
+      powerOfTwo <<= 1;
+    return powerOfTwo;
+  }
+
+  /** in place radix-2 FFT of a fixed length with precomputed twiddle factors, shared by all threads */
+  class ScanLineFFT
+  {
+  public:
+    explicit ScanLineFFT(unsigned int length) : m_Length(length), m_Twiddles(length / 2), m_BitReversed(length)
+    {
+      unsigned int bits = 0;
+      while ((1u << bits) < length)
+        ++bits;
+
+      for (unsigned int i = 0; i < length; ++i)
+      {
+        unsigned int reversed = 0;
+        for (unsigned int bit = 0; bit < bits; ++bit)
+          reversed |= ((i >> bit) & 1u) << (bits - 1 - bit);
+        m_BitReversed[i] = reversed;
+      }
+
+      for (unsigned int k = 0; k < length / 2; ++k)
+        m_Twiddles[k] = std::polar(1.0, -2.0 * itk::Math::pi * k / length);
+    }
+
+    /** unnormalized transform; the inverse transform uses the conjugate twiddle factors */
+    void Transform(std::complex<float>* data, bool inverse) const
+    {
+      for (unsigned int i = 0; i < m_Length; ++i)
+      {
+        if (i < m_BitReversed[i])
+          std::swap(data[i], data[m_BitReversed[i]]);
+      }
+
+      for (unsigned int size = 2; size <= m_Length; size <<= 1)
+      {
+        const unsigned int half = size / 2;
+        const unsigned int step = m_Length / size;
+        for (unsigned int start = 0; start < m_Length; start += size)
+        {
+          for (unsigned int k = 0; k < half; ++k)
+          {
+            std::complex<float> w(m_Twiddles[k * step]);
+            if (inverse)
+              w = std::conj(w);
+            const std::complex<float> t = w * data[start + k + half];
+            data[start + k + half] = data[start + k] - t;
+            data[start + k] += t;
+          }
+        }
+      }
+    }
+
+  private:
+    unsigned int m_Length;
+    std::vector<std::complex<double>> m_Twiddles;
+    std::vector<unsigned int> m_BitReversed;
+  };
+}
 
 #if defined(PHOTOACOUSTICS_USE_GPU) || DOXYGEN
 
+mitk::PhotoacousticOCLBModeStage::PhotoacousticOCLBModeStage()
+  : m_EnvelopeKernel(nullptr), m_LogCompressionKernel(nullptr), m_LineMaximumBuffer(nullptr), m_LineMaximumBufferSize(0)
+{
+}
+
+mitk::PhotoacousticOCLBModeStage::~PhotoacousticOCLBModeStage()
+{
+  if (m_EnvelopeKernel) clReleaseKernel(m_EnvelopeKernel);
+  if (m_LogCompressionKernel) clReleaseKernel(m_LogCompressionKernel);
+  if (m_LineMaximumBuffer) clReleaseMemObject(m_LineMaximumBuffer);
+}
+
+bool mitk::PhotoacousticOCLBModeStage::Initialize(cl_program program)
+{
+  if (m_EnvelopeKernel != nullptr && m_LogCompressionKernel != nullptr)
+    return true;
+
+  cl_int clErr = 0;
+  m_EnvelopeKernel = clCreateKernel(program, "ckBmodeEnvelope", &clErr);
+  CHECK_OCL_ERR(clErr);
+  if (clErr != CL_SUCCESS)
+    return false;
+
+  m_LogCompressionKernel = clCreateKernel(program, "ckBmodeLogCompression", &clErr);
+  CHECK_OCL_ERR(clErr);
+  return clErr == CL_SUCCESS;
+}
+
+void mitk::PhotoacousticOCLBModeStage::Enqueue(cl_command_queue queue, cl_mem data, const unsigned int dimensions[3], bool useEnvelopeDetection, float dynamicRange)
+{
+  if (m_EnvelopeKernel == nullptr || m_LogCompressionKernel == nullptr)
+    mitkThrow() << "The B-mode kernels are not initialized.";
+
+  us::ServiceReference<OclResourceService> ref = GetModuleContext()->GetServiceReference<OclResourceService>();
+  OclResourceService* resources = GetModuleContext()->GetService<OclResourceService>(ref);
+  cl_device_id device = resources->GetCurrentDevice();
+
+  cl_uint lines = dimensions[0];
+  cl_uint samples = dimensions[1];
+  cl_uint slices = dimensions[2];
+  cl_uint fftLength = NextPowerOfTwo(samples);
+  cl_uint log2Length = 0;
+  while ((1u << log2Length) < fftLength)
+    ++log2Length;
+  cl_uint envelope = useEnvelopeDetection ? 1 : 0;
+
+  cl_ulong localMemorySize = 0;
+  clGetDeviceInfo(device, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(cl_ulong), &localMemorySize, nullptr);
+  const size_t localBufferSize = (size_t)fftLength * 2 * sizeof(cl_float);
+  if (localBufferSize > localMemorySize)
+    mitkThrow() << "Scan lines of " << samples << " samples do not fit into the local memory of the device.";
+
+  // one work group per scan line; its size is a power of two, as needed by the reduction of the line maximum
+  size_t maxWorkGroupSize = 1;
+  clGetKernelWorkGroupInfo(m_EnvelopeKernel, device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(size_t), &maxWorkGroupSize, nullptr);
+  size_t workGroupSize = 1;
+  while (workGroupSize * 2 <= std::min<size_t>(std::min<size_t>(maxWorkGroupSize, 256), std::max<size_t>(fftLength / 2, 1)))
+    workGroupSize *= 2;
+
+  const size_t lineMaximumSize = (size_t)lines * slices * sizeof(cl_float);
+  cl_int clErr = 0;
+  if (m_LineMaximumBuffer == nullptr || m_LineMaximumBufferSize < lineMaximumSize)
+  {
+    if (m_LineMaximumBuffer) clReleaseMemObject(m_LineMaximumBuffer);
+    m_LineMaximumBuffer = clCreateBuffer(resources->GetContext(), CL_MEM_READ_WRITE, lineMaximumSize, nullptr, &clErr);
+    CHECK_OCL_ERR(clErr);
+    if (clErr != CL_SUCCESS)
+      mitkThrow() << "openCL Error when creating the line maximum buffer";
+    m_LineMaximumBufferSize = lineMaximumSize;
+  }
+
+  clErr = clSetKernelArg(m_EnvelopeKernel, 0, sizeof(cl_mem), &data);
+  clErr |= clSetKernelArg(m_EnvelopeKernel, 1, sizeof(cl_mem), &m_LineMaximumBuffer);
+  clErr |= clSetKernelArg(m_EnvelopeKernel, 2, localBufferSize, nullptr);
+  clErr |= clSetKernelArg(m_EnvelopeKernel, 3, sizeof(cl_uint), &lines);
+  clErr |= clSetKernelArg(m_EnvelopeKernel, 4, sizeof(cl_uint), &samples);
+  clErr |= clSetKernelArg(m_EnvelopeKernel, 5, sizeof(cl_uint), &fftLength);
+  clErr |= clSetKernelArg(m_EnvelopeKernel, 6, sizeof(cl_uint), &log2Length);
+  clErr |= clSetKernelArg(m_EnvelopeKernel, 7, sizeof(cl_uint), &envelope);
+  CHECK_OCL_ERR(clErr);
+
+  size_t envelopeGlobalSize[2] = { workGroupSize * lines, slices };
+  size_t envelopeLocalSize[2] = { workGroupSize, 1 };
+  clErr = clEnqueueNDRangeKernel(queue, m_EnvelopeKernel, 2, nullptr, envelopeGlobalSize, envelopeLocalSize, 0, nullptr, nullptr);
+  CHECK_OCL_ERR(clErr);
+  if (clErr != CL_SUCCESS)
+    mitkThrow() << "openCL Error when executing the envelope detection";
+
+  if (dynamicRange <= 0)
+    return;
+
+  clErr = clSetKernelArg(m_LogCompressionKernel, 0, sizeof(cl_mem), &data);
+  clErr |= clSetKernelArg(m_LogCompressionKernel, 1, sizeof(cl_mem), &m_LineMaximumBuffer);
+  clErr |= clSetKernelArg(m_LogCompressionKernel, 2, sizeof(cl_uint), &lines);
+  clErr |= clSetKernelArg(m_LogCompressionKernel, 3, sizeof(cl_uint), &samples);
+  clErr |= clSetKernelArg(m_LogCompressionKernel, 4, sizeof(cl_float), &dynamicRange);
+  CHECK_OCL_ERR(clErr);
+
+  size_t compressionGlobalSize[2] = { lines, slices };
+  clErr = clEnqueueNDRangeKernel(queue, m_LogCompressionKernel, 2, nullptr, compressionGlobalSize, nullptr, 0, nullptr, nullptr);
+  CHECK_OCL_ERR(clErr);
+  if (clErr != CL_SUCCESS)
+    mitkThrow() << "openCL Error when executing the log compression";
+}
+
 mitk::PhotoacousticOCLBModeFilter::PhotoacousticOCLBModeFilter()
-  : m_PixelCalculation(NULL)
+  : m_PixelCalculation(NULL), m_UseLogFilter(false), m_UseEnvelopeDetection(false), m_DynamicRange(0)
 {
   this->AddSourceFile("BModeAbs.cl");
   this->AddSourceFile("BModeAbsLog.cl");
+  this->AddSourceFile("BModeEnvelope.cl");
 
   this->m_FilterID = "BModeFilter";
 
@@ -70,13 +253,25 @@ void mitk::PhotoacousticOCLBModeFilter::Execute()
     return;
   }
 
-  cl_int clErr;
-  clErr = clSetKernelArg(this->m_PixelCalculation, 2, sizeof(cl_uint), &(this->m_Size));
+  if (m_UseEnvelopeDetection || m_DynamicRange > 0)
+  {
+    // the envelope detection needs the signed input, so the stage runs on a copy of it in the output buffer
+    cl_int clErr = clEnqueueCopyBuffer(m_CommandQue, m_Input->GetGPUBuffer(), m_Output->GetGPUBuffer(), 0, 0,
+      (size_t)m_Size * sizeof(float), 0, nullptr, nullptr);
+    CHECK_OCL_ERR(clErr);
+    m_BModeStage.Enqueue(m_CommandQue, m_Output->GetGPUBuffer(), m_InputDim, m_UseEnvelopeDetection, m_DynamicRange);
+    clFinish(m_CommandQue);
+  }
+  else
+  {
+    cl_int clErr;
+    clErr = clSetKernelArg(this->m_PixelCalculation, 2, sizeof(cl_uint), &(this->m_Size));
 
-  CHECK_OCL_ERR(clErr);
+    CHECK_OCL_ERR(clErr);
 
-  // execute the filter on a 3D NDRange
-  this->ExecuteKernel(m_PixelCalculation, 3);
+    // execute the filter on a 3D NDRange
+    this->ExecuteKernel(m_PixelCalculation, 3);
+  }
 
   // signalize the GPU-side data changed
   m_Output->Modified(GPU_DATA);
@@ -99,6 +294,7 @@ bool mitk::PhotoacousticOCLBModeFilter::Initialize()
     else
       this->m_PixelCalculation = clCreateKernel(this->m_ClProgram, "ckBmodeAbs", &clErr);
     buildErr |= CHECK_OCL_ERR(clErr);
+    buildErr &= m_BModeStage.Initialize(this->m_ClProgram);
   }
   return (OclFilter::IsInitialized() && buildErr);
 }
@@ -143,7 +339,7 @@ mitk::Image::Pointer mitk::PhotoacousticOCLBModeFilter::GetOutput()
 #endif
 
 
-mitk::PhotoacousticBModeFilter::PhotoacousticBModeFilter() : m_UseLogFilter(false)
+mitk::PhotoacousticBModeFilter::PhotoacousticBModeFilter() : m_UseLogFilter(false), m_UseEnvelopeDetection(false), m_DynamicRange(0)
 {
   this->SetNumberOfIndexedInputs(1);
   this->SetNumberOfRequiredInputs(1);
@@ -202,7 +398,13 @@ void mitk::PhotoacousticBModeFilter::GenerateData()
 
   float* InputData = (float*)const_cast<void*>(reader.GetData());
   float* OutputData = new float[size];
-  if(!m_UseLogFilter)
+  if (m_UseEnvelopeDetection || m_DynamicRange > 0)
+  {
+    const unsigned int dimensions[3] = { output->GetDimension(0), output->GetDimension(1), output->GetDimension(2) };
+    std::copy(InputData, InputData + size, OutputData);
+    ComputeBMode(OutputData, dimensions, m_UseEnvelopeDetection, m_DynamicRange);
+  }
+  else if(!m_UseLogFilter)
     for (unsigned int i = 0; i < size; ++i)
     {
       OutputData[i] = abs(InputData[i]);
@@ -218,4 +420,101 @@ void mitk::PhotoacousticBModeFilter::GenerateData()
   output->SetImportVolume(OutputData, 0, 0, mitk::Image::ImportMemoryManagementType::ManageMemory);
 
   m_TimeOfHeaderInitialization.Modified();
-}
\ No newline at end of file
+}
+
+void mitk::PhotoacousticBModeFilter::ComputeBMode(float* data, const unsigned int dimensions[3], bool useEnvelopeDetection, float dynamicRange, unsigned int numberOfThreads)
+{
+  const unsigned int lines = dimensions[0];
+  const unsigned int samples = dimensions[1];
+  const unsigned int slices = dimensions[2];
+  const unsigned int items = lines * slices;
+  if (items == 0 || samples == 0)
+    return;
+
+  if (numberOfThreads == 0)
+    numberOfThreads = std::thread::hardware_concurrency();
+  numberOfThreads = std::max(1u, std::min(numberOfThreads, items));
+
+  const unsigned int fftLength = NextPowerOfTwo(samples);
+  const ScanLineFFT fft(fftLength);
+  std::vector<float> lineMaximum(items, 0.0f);
+
+  // runs body(slice, line) for all lines of all slices, the threads fetch the lines until all are done
+  auto forAllLines = [&](const std::function<void(unsigned int, unsigned int, std::vector<std::complex<float>>&)>& body)
+  {
+    std::atomic<unsigned int> nextItem(0);
+    auto worker = [&]()
+    {
+      std::vector<std::complex<float>> buffer(useEnvelopeDetection ? fftLength : 0);
+      for (unsigned int item = nextItem++; item < items; item = nextItem++)
+        body(item / lines, item % lines, buffer);
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < numberOfThreads; ++t)
+      threads.push_back(std::thread(worker));
+    worker();
+    for (auto& thread : threads)
+      thread.join();
+  };
+
+  forAllLines([&](unsigned int slice, unsigned int line, std::vector<std::complex<float>>& buffer)
+  {
+    float* scanLine = data + (size_t)slice * lines * samples + line;
+    float maximum = 0;
+
+    if (useEnvelopeDetection)
+    {
+      for (unsigned int i = 0; i < fftLength; ++i)
+        buffer[i] = std::complex<float>(i < samples ? scanLine[(size_t)i * lines] : 0.0f, 0.0f);
+
+      fft.Transform(buffer.data(), false);
+
+      // analytic signal: keep the DC and Nyquist components, double the positive and remove the negative frequencies
+      const float normalization = 1.0f / fftLength;
+      buffer[0] *= normalization;
+      for (unsigned int i = 1; i < fftLength / 2; ++i)
+        buffer[i] *= 2.0f * normalization;
+      if (fftLength > 1)
+        buffer[fftLength / 2] *= normalization;
+      for (unsigned int i = fftLength / 2 + 1; i < fftLength; ++i)
+        buffer[i] = 0;
+
+      fft.Transform(buffer.data(), true);
+
+      for (unsigned int i = 0; i < samples; ++i)
+      {
+        const float envelope = std::abs(buffer[i]);
+        scanLine[(size_t)i * lines] = envelope;
+        maximum = std::max(maximum, envelope);
+      }
+    }
+    else
+    {
+      for (unsigned int i = 0; i < samples; ++i)
+      {
+        const float envelope = std::abs(scanLine[(size_t)i * lines]);
+        scanLine[(size_t)i * lines] = envelope;
+        maximum = std::max(maximum, envelope);
+      }
+    }
+
+    lineMaximum[slice * lines + line] = maximum;
+  });
+
+  if (dynamicRange <= 0)
+    return;
+
+  forAllLines([&](unsigned int slice, unsigned int line, std::vector<std::complex<float>>&)
+  {
+    const float maximum = *std::max_element(lineMaximum.begin() + slice * lines, lineMaximum.begin() + (slice + 1) * lines);
+    float* scanLine = data + (size_t)slice * lines * samples + line;
+
+    for (unsigned int i = 0; i < samples; ++i)
+    {
+      const float envelope = scanLine[(size_t)i * lines];
+      const float decibel = (maximum > 0 && envelope > 0) ? 20.0f * std::log10(envelope / maximum) : -dynamicRange;
+      scanLine[(size_t)i * lines] = std::min(1.0f, std::max(0.0f, (decibel + dynamicRange) / dynamicRange));
+    }
+  });
+}
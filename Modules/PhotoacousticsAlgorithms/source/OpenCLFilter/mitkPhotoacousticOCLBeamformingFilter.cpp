@@ -20,11 +20,20 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "usServiceReference.h"
 
 mitk::PhotoacousticOCLBeamformingFilter::PhotoacousticOCLBeamformingFilter()
-: m_PixelCalculation( NULL ), m_InputImage(mitk::Image::New()), m_ApodizationBuffer(nullptr), m_MemoryLocationsBuffer(nullptr), m_DelaysBuffer(nullptr), m_UsedLinesBuffer(nullptr)
+: m_PixelCalculation( NULL ), m_KernelAlgorithm(BeamformingSettings::BeamformingAlgorithm::DAS), m_InputImage(mitk::Image::New()),
+  m_ApodizationBuffer(nullptr), m_MemoryLocationsBuffer(nullptr), m_DelaysBuffer(nullptr), m_UsedLinesBuffer(nullptr),
+  m_StreamingMode(false), m_TransferQueue(nullptr), m_NextInputBuffer(0), m_BusyInputBuffer(-1), m_StreamingOutputBuffer(nullptr),
+  m_StreamingOutputBufferSize(0), m_StreamingOutputSize(0)
 {
+  m_StreamingInputBuffers[0] = nullptr;
+  m_StreamingInputBuffers[1] = nullptr;
+  m_StreamingInputBufferSizes[0] = 0;
+  m_StreamingInputBufferSizes[1] = 0;
+
   this->AddSourceFile("DAS.cl");
   this->AddSourceFile("DMAS.cl");
   this->AddSourceFile("sDMAS.cl");
+  this->AddSourceFile("BModeEnvelope.cl");
   this->m_FilterID = "OpenCLBeamformingFilter";
 
   this->Initialize();
@@ -55,6 +64,9 @@ mitk::PhotoacousticOCLBeamformingFilter::~PhotoacousticOCLBeamformingFilter()
   }
 
   if (m_ApodizationBuffer) clReleaseMemObject(m_ApodizationBuffer);
+
+  this->ReleaseStreamingBuffers();
+  if (m_TransferQueue) clReleaseCommandQueue(m_TransferQueue);
 }
 
 void mitk::PhotoacousticOCLBeamformingFilter::Update()
@@ -97,7 +109,13 @@ void mitk::PhotoacousticOCLBeamformingFilter::UpdateDataBuffers()
     return;
   }
 
-  if (BeamformingSettings::SettingsChangedOpenCL(m_Conf, m_ConfOld))
+  this->UpdateLookupTables();
+}
+
+void mitk::PhotoacousticOCLBeamformingFilter::UpdateLookupTables()
+{
+  // the tables only depend on the probe geometry and the settings, so they are kept as long as those stay the same
+  if (BeamformingSettings::SettingsChangedOpenCL(m_Conf, m_ConfOld) || m_DelaysBuffer == nullptr)
   {
     cl_int clErr = 0;
     MITK_DEBUG << "Updating GPU Buffers for new configuration";
@@ -138,10 +156,173 @@ void mitk::PhotoacousticOCLBeamformingFilter::UpdateDataBuffers()
   }
 }
 
+void mitk::PhotoacousticOCLBeamformingFilter::UpdateStreamingOutputBuffer()
+{
+  m_OutputDim[0] = m_Conf.ReconstructionLines;
+  m_OutputDim[1] = m_Conf.SamplesPerLine;
+  m_OutputDim[2] = m_Conf.inputDim[2];
+  m_StreamingOutputSize = (size_t)m_OutputDim[0] * (size_t)m_OutputDim[1] * (size_t)m_OutputDim[2] * sizeof(float);
+
+  this->SetWorkingSize(8, m_OutputDim[0], 8, m_OutputDim[1], 8, m_OutputDim[2]);
+
+  // the buffer is only reallocated if it grows, smaller frames (e.g. the last batch) reuse it
+  if (m_StreamingOutputBuffer == nullptr || m_StreamingOutputBufferSize < m_StreamingOutputSize)
+  {
+    us::ServiceReference<OclResourceService> ref = GetModuleContext()->GetServiceReference<OclResourceService>();
+    OclResourceService* resources = GetModuleContext()->GetService<OclResourceService>(ref);
+
+    cl_int clErr = 0;
+    if (m_StreamingOutputBuffer) clReleaseMemObject(m_StreamingOutputBuffer);
+    m_StreamingOutputBuffer = clCreateBuffer(resources->GetContext(), CL_MEM_READ_WRITE, m_StreamingOutputSize, nullptr, &clErr);
+    CHECK_OCL_ERR(clErr);
+    if (clErr != CL_SUCCESS)
+      mitkThrow() << "openCL Error when creating output buffer";
+
+    m_StreamingOutputBufferSize = m_StreamingOutputSize;
+  }
+}
+
+void mitk::PhotoacousticOCLBeamformingFilter::ReleaseStreamingBuffers()
+{
+  if (m_CommandQue) clFinish(m_CommandQue);
+
+  for (auto& pending : m_PendingInputs)
+  {
+    clWaitForEvents(1, &pending.UploadFinished);
+    clReleaseEvent(pending.UploadFinished);
+  }
+  m_PendingInputs.clear();
+
+  for (unsigned int i = 0; i < 2; ++i)
+  {
+    if (m_StreamingInputBuffers[i]) clReleaseMemObject(m_StreamingInputBuffers[i]);
+    m_StreamingInputBuffers[i] = nullptr;
+    m_StreamingInputBufferSizes[i] = 0;
+  }
+
+  if (m_StreamingOutputBuffer) clReleaseMemObject(m_StreamingOutputBuffer);
+  m_StreamingOutputBuffer = nullptr;
+  m_StreamingOutputBufferSize = 0;
+  m_NextInputBuffer = 0;
+  m_BusyInputBuffer = -1;
+}
+
+void mitk::PhotoacousticOCLBeamformingFilter::SetStreamingMode(bool streaming)
+{
+  if (m_StreamingMode == streaming)
+    return;
+
+  if (!streaming)
+    this->ReleaseStreamingBuffers();
+
+  m_StreamingMode = streaming;
+}
+
+void mitk::PhotoacousticOCLBeamformingFilter::EnqueueInput(const void* data, unsigned int* dimensions)
+{
+  if (!m_StreamingMode)
+    mitkThrow() << "EnqueueInput() is only available in streaming mode.";
+  if (m_PendingInputs.size() >= 2)
+    mitkThrow() << "Cannot enqueue more than two frames; call Update() first.";
+
+  us::ServiceReference<OclResourceService> ref = GetModuleContext()->GetServiceReference<OclResourceService>();
+  OclResourceService* resources = GetModuleContext()->GetService<OclResourceService>(ref);
+
+  cl_int clErr = 0;
+  if (m_TransferQueue == nullptr)
+  {
+    m_TransferQueue = clCreateCommandQueue(resources->GetContext(), resources->GetCurrentDevice(), 0, &clErr);
+    CHECK_OCL_ERR(clErr);
+    if (clErr != CL_SUCCESS)
+      mitkThrow() << "openCL Error when creating the transfer queue";
+  }
+
+  const unsigned int bufferIndex = m_NextInputBuffer;
+  m_NextInputBuffer = (m_NextInputBuffer + 1) % 2;
+
+  // the kernels of the previous frame may still read from this buffer if its output was not fetched yet
+  if (m_BusyInputBuffer == (int)bufferIndex)
+  {
+    clFinish(m_CommandQue);
+    m_BusyInputBuffer = -1;
+  }
+
+  const size_t size = (size_t)dimensions[0] * (size_t)dimensions[1] * (size_t)dimensions[2] * sizeof(float);
+  if (m_StreamingInputBuffers[bufferIndex] == nullptr || m_StreamingInputBufferSizes[bufferIndex] < size)
+  {
+    if (m_StreamingInputBuffers[bufferIndex]) clReleaseMemObject(m_StreamingInputBuffers[bufferIndex]);
+    m_StreamingInputBuffers[bufferIndex] = clCreateBuffer(resources->GetContext(), CL_MEM_READ_ONLY, size, nullptr, &clErr);
+    CHECK_OCL_ERR(clErr);
+    if (clErr != CL_SUCCESS)
+      mitkThrow() << "openCL Error when creating input buffer";
+    m_StreamingInputBufferSizes[bufferIndex] = size;
+  }
+
+  PendingInput pending;
+  pending.BufferIndex = bufferIndex;
+  pending.Dimensions[0] = dimensions[0];
+  pending.Dimensions[1] = dimensions[1];
+  pending.Dimensions[2] = dimensions[2];
+
+  clErr = clEnqueueWriteBuffer(m_TransferQueue, m_StreamingInputBuffers[bufferIndex], CL_FALSE, 0, size, data, 0, nullptr, &pending.UploadFinished);
+  CHECK_OCL_ERR(clErr);
+  if (clErr != CL_SUCCESS)
+    mitkThrow() << "openCL Error when uploading input";
+
+  clFlush(m_TransferQueue);
+  m_PendingInputs.push_back(pending);
+}
+
+void mitk::PhotoacousticOCLBeamformingFilter::GetOutput(void* output)
+{
+  cl_mem buffer = m_StreamingMode ? m_StreamingOutputBuffer : m_Output->GetGPUBuffer();
+  size_t size = m_StreamingMode ? m_StreamingOutputSize : (size_t)m_Output->GetBufferSize() * sizeof(float);
+
+  if (buffer == nullptr)
+    mitkThrow() << "No output available; call Update() first.";
+
+  cl_int clErr = clEnqueueReadBuffer(m_CommandQue, buffer, CL_TRUE, 0, size, output, 0, nullptr, nullptr);
+  CHECK_OCL_ERR(clErr);
+
+  // the queue is in order, so all kernels have finished once the blocking read returns
+  m_BusyInputBuffer = -1;
+  if (clErr != CL_SUCCESS)
+    mitkThrow() << "openCL Error when reading Output Buffer";
+}
+
 void mitk::PhotoacousticOCLBeamformingFilter::Execute()
 {
   cl_int clErr = 0;
-  UpdateDataBuffers();
+
+  if (m_StreamingMode)
+  {
+    if (m_PendingInputs.empty())
+      mitkThrow() << "No input enqueued; call EnqueueInput() first.";
+
+    PendingInput input = m_PendingInputs.front();
+    m_PendingInputs.erase(m_PendingInputs.begin());
+
+    m_Conf.inputDim[0] = input.Dimensions[0];
+    m_Conf.inputDim[1] = input.Dimensions[1];
+    m_Conf.inputDim[2] = input.Dimensions[2];
+
+    UpdateLookupTables();
+    UpdateStreamingOutputBuffer();
+
+    // the upload of the next frame keeps running on the transfer queue while this frame is beamformed
+    clWaitForEvents(1, &input.UploadFinished);
+    clReleaseEvent(input.UploadFinished);
+
+    clErr = clSetKernelArg(this->m_PixelCalculation, 0, sizeof(cl_mem), &(m_StreamingInputBuffers[input.BufferIndex]));
+    clErr |= clSetKernelArg(this->m_PixelCalculation, 1, sizeof(cl_mem), &(m_StreamingOutputBuffer));
+    CHECK_OCL_ERR(clErr);
+
+    m_BusyInputBuffer = input.BufferIndex;
+  }
+  else
+  {
+    UpdateDataBuffers();
+  }
 
   clErr = clSetKernelArg(this->m_PixelCalculation, 2, sizeof(cl_mem), &(this->m_UsedLinesBuffer));
   clErr |= clSetKernelArg(this->m_PixelCalculation, 3, sizeof(cl_mem), &(this->m_DelaysBuffer));
@@ -165,8 +346,16 @@ void mitk::PhotoacousticOCLBeamformingFilter::Execute()
       mitkThrow() << "openCL Error when executing Kernel";
   }
 
+  // the B-mode runs on the same queue in the output buffer, so it is read back only once
+  if (m_Conf.UseBMode)
+  {
+    cl_mem outputBuffer = m_StreamingMode ? m_StreamingOutputBuffer : m_Output->GetGPUBuffer();
+    m_BModeStage.Enqueue(m_CommandQue, outputBuffer, m_OutputDim, m_Conf.UseEnvelopeDetection, m_Conf.BModeDynamicRange);
+  }
+
   // signalize the GPU-side data changed
-  m_Output->Modified( GPU_DATA );
+  if (!m_StreamingMode)
+    m_Output->Modified( GPU_DATA );
 }
 
 us::Module *mitk::PhotoacousticOCLBeamformingFilter::GetModule()
@@ -181,6 +370,21 @@ bool mitk::PhotoacousticOCLBeamformingFilter::Initialize()
 
   if ( OclFilter::Initialize() )
   {
+    if (!m_BModeStage.Initialize(this->m_ClProgram))
+      return false;
+
+    // the kernel is kept across updates and only recreated if another algorithm is requested
+    if (m_PixelCalculation != nullptr && m_KernelAlgorithm == m_Conf.Algorithm)
+      return OclFilter::IsInitialized();
+
+    if (m_PixelCalculation != nullptr)
+    {
+      clReleaseKernel(m_PixelCalculation);
+      m_PixelCalculation = nullptr;
+    }
+
+    m_KernelAlgorithm = m_Conf.Algorithm;
+
     switch (m_Conf.Algorithm)
     {
       case BeamformingSettings::BeamformingAlgorithm::DAS:
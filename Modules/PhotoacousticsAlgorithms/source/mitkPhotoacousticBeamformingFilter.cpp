@@ -16,13 +16,17 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkProperties.h"
 #include "mitkImageReadAccessor.h"
+#include "mitkImageWriteAccessor.h"
 #include <algorithm>
 #include <itkImageIOBase.h>
+#include <atomic>
 #include <chrono>
 #include <thread>
+#include <vector>
 #include <itkImageIOBase.h>
 #include "mitkImageCast.h"
 #include "mitkPhotoacousticBeamformingFilter.h"
+#include "./OpenCLFilter/mitkPhotoacousticBModeFilter.h"
 
 mitk::BeamformingFilter::BeamformingFilter() : m_OutputData(nullptr), m_InputData(nullptr), m_Message("noMessage")
 {
@@ -132,7 +136,11 @@ void mitk::BeamformingFilter::GenerateData()
 
   auto begin = std::chrono::high_resolution_clock::now(); // debbuging the performance...
 
-  if (!m_Conf.UseGPU)
+  if (!m_Conf.UseGPU && m_Conf.UseFastCPUBeamforming)
+  {
+    BeamformOnCPU(input, output, ApodWindow);
+  }
+  else if (!m_Conf.UseGPU)
   {
     int progInterval = output->GetDimension(2) / 20 > 1 ? output->GetDimension(2) / 20 : 1;
     // the interval at which we update the gui progress bar
@@ -226,6 +234,12 @@ void mitk::BeamformingFilter::GenerateData()
         threads[line].join();
       }
 
+      if (m_Conf.UseBMode)
+      {
+        const unsigned int sliceDim[3] = { output->GetDimension(0), output->GetDimension(1), 1 };
+        PhotoacousticBModeFilter::ComputeBMode(m_OutputData, sliceDim, m_Conf.UseEnvelopeDetection, m_Conf.BModeDynamicRange);
+      }
+
       output->SetSlice(m_OutputData, i);
 
       if (i % progInterval == 0)
@@ -275,7 +289,38 @@ void mitk::BeamformingFilter::GenerateData()
 
       mitk::ImageReadAccessor copy(input);
 
-      for(unsigned int i = 0; i < batches; ++i)
+      if (m_Conf.UseGPUStreaming)
+      {
+        // upload batch i + 1 while batch i is beamformed; the results are read into the output image directly
+        m_BeamformingOclFilter->SetStreamingMode(true);
+        m_BeamformingOclFilter->SetApodisation(ApodWindow, m_Conf.apodizationArraySize);
+        m_BeamformingOclFilter->SetConfig(m_Conf);
+
+        mitk::ImageWriteAccessor outputWriteAccessor(output);
+        float* outputData = (float*)outputWriteAccessor.GetData();
+        const float* inputData = (const float*)copy.GetData();
+
+        auto enqueueBatch = [&](unsigned int batch)
+        {
+          unsigned int* dim = (batch == batches - 1 && (input->GetDimension(2) % batchSize > 0)) ? batchDimLast : batchDim;
+          m_BeamformingOclFilter->EnqueueInput(&inputData[(size_t)input->GetDimension(0) * input->GetDimension(1) * batchSize * batch], dim);
+        };
+
+        enqueueBatch(0);
+        for (unsigned int i = 0; i < batches; ++i)
+        {
+          m_ProgressHandle(input->GetDimension(2) / batches * i, "performing reconstruction");
+
+          if (i + 1 < batches)
+            enqueueBatch(i + 1);
+
+          m_BeamformingOclFilter->Update();
+          m_BeamformingOclFilter->GetOutput(&outputData[(size_t)m_Conf.ReconstructionLines * m_Conf.SamplesPerLine * batchSize * i]);
+        }
+        m_Conf.inputDim[2] = input->GetDimension(2);
+      }
+
+      for(unsigned int i = 0; i < batches && !m_Conf.UseGPUStreaming; ++i)
       {
         m_ProgressHandle(input->GetDimension(2)/batches * i, "performing reconstruction");
 
@@ -295,19 +340,21 @@ void mitk::BeamformingFilter::GenerateData()
 
         inputBatch->SetImportVolume(&(((float*)copy.GetData())[input->GetDimension(0) * input->GetDimension(1) * batchSize * i]));
 
+        m_BeamformingOclFilter->SetStreamingMode(false);
         m_BeamformingOclFilter->SetApodisation(ApodWindow, m_Conf.apodizationArraySize);
         m_BeamformingOclFilter->SetConfig(m_Conf);
         m_BeamformingOclFilter->SetInput(inputBatch);
         m_BeamformingOclFilter->Update();
 
-        void* out = m_BeamformingOclFilter->GetOutput();
+        float* out = (float*)m_BeamformingOclFilter->GetOutput();
 
         for(unsigned int slice = 0; slice < m_Conf.inputDim[2]; ++slice)
         {
           output->SetImportSlice(
-                &(((float*)out)[m_Conf.ReconstructionLines * m_Conf.SamplesPerLine * slice]),
+                &(out[m_Conf.ReconstructionLines * m_Conf.SamplesPerLine * slice]),
               batchSize * i + slice, 0, 0, mitk::Image::ImportMemoryManagementType::CopyMemory);
         }
+        delete[] reinterpret_cast<char*>(out);
       }
     }
     catch (mitk::Exception &e)
@@ -329,6 +376,175 @@ void mitk::BeamformingFilter::GenerateData()
   MITK_INFO << "Beamforming of " << output->GetDimension(2) << " Images completed in " << ((float)std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()) / 1000000 << "ms" << std::endl;
 }
 
+void mitk::BeamformingFilter::BeamformOnCPU(mitk::Image::Pointer input, mitk::Image::Pointer output, float* apodisation)
+{
+  // first, we check whether the data is float, other formats are unsupported
+  if (!(input->GetPixelType().GetTypeAsString() == "scalar (float)" || input->GetPixelType().GetTypeAsString() == " (float)"))
+  {
+    MITK_INFO << "Pixel type is not float, abort";
+    return;
+  }
+
+  const unsigned int slices = output->GetDimension(2);
+  const unsigned int lines = output->GetDimension(0);
+
+  const float inputDim[2] = { (float)input->GetDimension(0), (float)input->GetDimension(1) };
+  const float outputDim[2] = { (float)output->GetDimension(0), (float)output->GetDimension(1) };
+
+  const size_t inputSliceSize = (size_t)input->GetDimension(0) * input->GetDimension(1);
+  const size_t outputSliceSize = (size_t)output->GetDimension(0) * output->GetDimension(1);
+
+  unsigned int numberOfThreads = m_Conf.NumberOfCPUThreads;
+  if (numberOfThreads == 0)
+    numberOfThreads = std::thread::hardware_concurrency();
+  if (numberOfThreads == 0)
+    numberOfThreads = 1;
+
+  mitk::ImageReadAccessor inputReadAccessor(input);
+  const float* inputData = (const float*)inputReadAccessor.GetData();
+  std::vector<float> outputData(outputSliceSize * slices, 0.0f);
+
+  // the interval at which we update the gui progress bar
+  unsigned int progInterval = slices / 20 > 1 ? slices / 20 : 1;
+
+  for (unsigned int firstSlice = 0; firstSlice < slices; firstSlice += progInterval)
+  {
+    const unsigned int lastItem = std::min(slices, firstSlice + progInterval) * lines;
+    std::atomic<unsigned int> nextItem(firstSlice * lines);
+
+    // every work item is one line of one slice; the threads fetch items until all are done
+    auto worker = [&]()
+    {
+      for (unsigned int item = nextItem++; item < lastItem; item = nextItem++)
+      {
+        const unsigned int slice = item / lines;
+        const short line = (short)(item % lines);
+        BeamformLine(inputData + slice * inputSliceSize, outputData.data() + slice * outputSliceSize,
+          inputDim, outputDim, line, apodisation, m_Conf.apodizationArraySize);
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < numberOfThreads; ++t)
+      threads.push_back(std::thread(worker));
+    worker();
+    for (auto& thread : threads)
+      thread.join();
+
+    m_ProgressHandle((int)(std::min(slices, firstSlice + progInterval) / (float)slices * 100), "performing reconstruction");
+  }
+
+  // the B-mode works on the beamformed lines in place, before they are copied into the output image
+  if (m_Conf.UseBMode)
+  {
+    const unsigned int outputDimensions[3] = { output->GetDimension(0), output->GetDimension(1), slices };
+    PhotoacousticBModeFilter::ComputeBMode(outputData.data(), outputDimensions, m_Conf.UseEnvelopeDetection,
+      m_Conf.BModeDynamicRange, numberOfThreads);
+  }
+
+  output->SetImportVolume(outputData.data(), 0, 0, mitk::Image::ImportMemoryManagementType::CopyMemory);
+}
+
+void mitk::BeamformingFilter::BeamformLine(const float* input, float* output, const float inputDim[2], const float outputDim[2], short line, const float* apodisation, short apodArraySize)
+{
+  const float inputS = inputDim[1];
+  const float inputL = inputDim[0];
+
+  const float outputS = outputDim[1];
+  const float outputL = outputDim[0];
+
+  const bool quadraticDelay = m_Conf.DelayCalculationMethod == BeamformingSettings::DelayCalc::QuadApprox;
+  const BeamformingSettings::BeamformingAlgorithm algorithm = m_Conf.Algorithm;
+
+  float tan_phi = std::tan(m_Conf.Angle / 360 * 2 * itk::Math::pi);
+  float part_multiplicator = tan_phi * m_Conf.TimeSpacing * m_Conf.SpeedOfSound / m_Conf.Pitch * inputL / (float)m_Conf.TransducerElements;
+
+  float l_i = (float)line / outputL * inputL;
+
+  for (short sample = 0; sample < outputS; ++sample)
+  {
+    float s_i = (float)sample / outputS * inputS / 2;
+
+    float part = part_multiplicator*s_i;
+    if (part < 1)
+      part = 1;
+
+    short maxLine = (short)std::min((l_i + part) + 1, inputL);
+    short minLine = (short)std::max((l_i - part), 0.0f);
+    short usedLines = (maxLine - minLine);
+
+    float apod_mult = (float)apodArraySize / (float)usedLines;
+
+    float delayMultiplicator = 0;
+    if (quadraticDelay)
+      delayMultiplicator = pow((1 / (m_Conf.TimeSpacing*m_Conf.SpeedOfSound) * (m_Conf.Pitch*m_Conf.TransducerElements) / inputL), 2) / s_i / 2;
+
+    // sum of the apodized samples for DAS, sum of their signed square roots for DMAS
+    double sum = 0;
+    double sumOfSquares = 0;
+    float sign = 0;
+
+    for (short l_s = minLine; l_s < maxLine; ++l_s)
+    {
+      short AddSample = 0;
+      if (!quadraticDelay)
+      {
+        AddSample = (short)sqrt(
+          pow(s_i, 2)
+          +
+          pow((1 / (m_Conf.TimeSpacing*m_Conf.SpeedOfSound) * (((float)l_s - l_i)*m_Conf.Pitch*(float)m_Conf.TransducerElements) / inputL), 2)
+        ) + (1 - m_Conf.isPhotoacousticImage)*s_i;
+      }
+      else if (algorithm == BeamformingSettings::BeamformingAlgorithm::DAS)
+      {
+        AddSample = delayMultiplicator * pow((l_s - l_i), 2) + s_i + (1 - m_Conf.isPhotoacousticImage)*s_i;
+      }
+      else
+      {
+        AddSample = (short)(delayMultiplicator * pow((l_s - l_i), 2) + s_i) + (1 - m_Conf.isPhotoacousticImage)*s_i;
+      }
+
+      if (AddSample >= inputS || AddSample < 0)
+      {
+        // the reference DMAS implementation does not count a missing sample on the last line
+        if (algorithm == BeamformingSettings::BeamformingAlgorithm::DAS || l_s < maxLine - 1)
+          --usedLines;
+        continue;
+      }
+
+      const float value = input[l_s + AddSample*(short)inputL];
+      const float weighted = value * apodisation[(int)((l_s - minLine)*apod_mult)];
+
+      if (algorithm == BeamformingSettings::BeamformingAlgorithm::DAS)
+      {
+        sum += weighted;
+      }
+      else
+      {
+        const double root = sqrt(fabs(weighted)) * ((weighted > 0) - (weighted < 0));
+        sum += root;
+        sumOfSquares += root * root;
+        if (l_s < maxLine - 1)
+          sign += value;
+      }
+    }
+
+    float result = 0;
+    if (algorithm == BeamformingSettings::BeamformingAlgorithm::DAS)
+    {
+      result = sum / usedLines;
+    }
+    else
+    {
+      result = (sum * sum - sumOfSquares) / 2 / (float)(pow(usedLines, 2) - (usedLines - 1));
+      if (algorithm == BeamformingSettings::BeamformingAlgorithm::sDMAS)
+        result *= ((sign > 0) - (sign < 0));
+    }
+
+    output[sample*(short)outputL + line] = result;
+  }
+}
+
 float* mitk::BeamformingFilter::VonHannFunction(int samples)
 {
   float* ApodWindow = new float[samples];
@@ -274,7 +274,7 @@ public:
    *      D.E. Knuth, "Seminumerical Algorithms," 2nd edition, vol. 2
    *      of "The Art of Computer Programming", Addison-Wesley, (1981).
    *
-   *      When Type is 0, sets Seed as the seed. Make sure 0<Seed<32000.
+   *      When Type is 0, sets Seed as the seed. Make sure 0<Seed<MSEED.
    *      When Type is 1, returns a random number.
    *      When Type is 2, gets the status of the generator.
    *      When Type is 3, restores the status of the generator.
@@ -621,6 +621,7 @@ bool simulatePVFC = false;
 int requestedNumberOfPhotons = 100000;
 float requestedSimulationTime = 0; // in minutes
 int concurentThreadsSupported = -1;
+long randomSeed = -1; // base seed of the work packages, -1 = derived from the current time
 float yOffset = 0; // in mm
 bool saveLegacy = false;
 std::string normalizationFilename;
@@ -673,6 +674,9 @@ int main(int argc, char * argv[]) {
   parser.addArgument(
     "jobs", "j", mitkCommandLineParser::Int,
     "Number of jobs", "Specifies the number of jobs for simutation (default: -1 which starts as many jobs as supported).");
+  parser.addArgument(
+    "seed", "s", mitkCommandLineParser::Int,
+    "Random seed", "Specifies the seed of the random number generators (default: -1 which seeds with the current time). The same seed reproduces a simulation with a given number of photons, independent of the number of jobs.");
   parser.addArgument(
     "probe-xml", "p", mitkCommandLineParser::InputFile,
     "Xml definition of the probe", "Specifies the absolute path of the location of the xml definition file of the probe design.");
@@ -728,6 +732,10 @@ int main(int argc, char * argv[]) {
   {
     concurentThreadsSupported = us::any_cast<int>(parsedArgs["jobs"]);
   }
+  if (parsedArgs.count("seed"))
+  {
+    randomSeed = us::any_cast<int>(parsedArgs["seed"]);
+  }
   if (parsedArgs.count("probe-xml"))
   {
     std::string inputXmlProbeDesign = us::any_cast<std::string>(parsedArgs["probe-xml"]);
@@ -753,6 +761,12 @@ int main(int argc, char * argv[]) {
     }
   }
 
+  if (randomSeed < 0)
+  {
+    randomSeed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count() % 32000;
+  }
+  if (verbose) std::cout << "Random seed: " << randomSeed << std::endl;
+
   if (detector_x != -1 && detector_z != -1)
   {
     if (verbose)
@@ -1041,16 +1055,21 @@ void runMonteCarlo(InputValues* inputValues, ReturnValues* returnValue, int thre
 
   /**** ======================== MAJOR CYCLE ============================ *****/
 
-  auto duration = std::chrono::system_clock::now().time_since_epoch();
-  returnValue->RandomGen(0, (std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() + thread) % 32000, nullptr); /* initiate with seed = 1, or any long integer. */
   for (j = 0; j < inputValues->totalNumberOfVoxels; j++) returnValue->totalFluence[j] = 0; // ensure F[] starts empty.
 
   /**** RUN Launch N photons, initializing each one before progation. *****/
 
   long photonsToSimulate = 0;
+  long workPackageIndex = 0;
 
   do {
-    photonsToSimulate = threadHandler->GetNextWorkPackage();
+    photonsToSimulate = threadHandler->GetNextWorkPackage(workPackageIndex);
+    if (photonsToSimulate <= 0)
+      break;
+
+    /* every work package has its own random sequence, so the result does not depend on which thread simulates it */
+    returnValue->RandomGen(0, 1 + (randomSeed + workPackageIndex) % 161803397, nullptr);
+
     if (returnValue->detectorVoxel != nullptr)
     {
       photonsToSimulate = photonsToSimulate * returnValue->detectorVoxel->m_PhotonNormalizationValue;
@@ -19,7 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mitkCommon.h>
 #include <MitkPhotoacousticsLibExports.h>
-#include <mutex>
+#include <atomic>
 
 //Includes for smart pointer usage
 #include "mitkCommon.h"
@@ -42,10 +42,20 @@ namespace mitk {
 
         long GetNextWorkPackage();
 
+      /**
+       * @brief GetNextWorkPackage claims the next work package without locking, so any number of
+       * simulation threads can draw packages concurrently.
+       * @param workPackageIndex is set to the index of the claimed package. Packages are numbered
+       * consecutively from 0 in the order they are claimed, which allows seeding a random number
+       * generator per package, independent of the thread simulating it.
+       * @return the number of photons of the package, 0 if the simulation is finished
+       */
+      long GetNextWorkPackage(long& workPackageIndex);
+
       void SetPackageSize(long sizeInMilliseconsOrNumberOfPhotons);
 
       itkGetMacro(NumberPhotonsToSimulate, long);
-      itkGetMacro(NumberPhotonsRemaining, long);
+      long GetNumberPhotonsRemaining() const;
       itkGetMacro(WorkPackageSize, long);
       itkGetMacro(SimulationTime, long);
       itkGetMacro(SimulateOnTimeBasis, bool);
@@ -53,13 +63,13 @@ namespace mitk {
 
     protected:
       long m_NumberPhotonsToSimulate;
-      long m_NumberPhotonsRemaining;
+      std::atomic<long> m_NumberPhotonsRemaining; ///< may become negative when the last packages are claimed concurrently
+      std::atomic<long> m_NextWorkPackageIndex;
       long m_WorkPackageSize;
       long m_SimulationTime;
       long m_Time;
       bool m_SimulateOnTimeBasis;
       bool m_Verbose;
-      std::mutex m_MutexRemainingPhotonsManipulation;
 
       /**
        * @brief PhotoacousticThreadhandler
@@ -22,6 +22,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkImage.h>
 
 #include <mitkPASimulationBatchGeneratorParameters.h>
+#include <mitkPATissueGeneratorParameters.h>
 
 namespace mitk {
   namespace pa {
@@ -32,6 +33,28 @@ namespace mitk {
         SimulationBatchGeneratorParameters::Pointer parameters,
         mitk::Image::Pointer tissueVolume);
 
+      /**
+       * @brief GenerateBatch generates numberOfVolumes in silico tissue volumes in parallel and saves each of them
+       * together with its simulation batch entry, like WriteBatchFileAndSaveTissueVolume() does.
+       *
+       * The volumes get the indices batchParameters->GetVolumeIndex() up to GetVolumeIndex() + numberOfVolumes - 1.
+       * If tissueParameters uses a rng seed, the volume with index offset i is generated with the seed
+       * GetRngSeed() + i, so a batch is reproducible independent of the number of threads. The volumes are
+       * written by a background thread in the order of their indices. A generated volume waits until fewer than
+       * maximumNumberOfQueuedVolumes volumes are waiting to be written before it, so the memory is bounded by
+       * numberOfThreads + maximumNumberOfQueuedVolumes volumes.
+       *
+       * @param numberOfThreads number of threads generating volumes, 0 uses all cores.
+       * @param maximumNumberOfQueuedVolumes 0 uses numberOfThreads.
+       * @throw mitk::Exception if generating or writing a volume failed. No further volumes are generated then.
+       */
+      static void GenerateBatch(
+        TissueGeneratorParameters::Pointer tissueParameters,
+        SimulationBatchGeneratorParameters::Pointer batchParameters,
+        unsigned int numberOfVolumes,
+        unsigned int numberOfThreads = 0,
+        unsigned int maximumNumberOfQueuedVolumes = 0);
+
       static std::string CreateBatchSimulationString(
         SimulationBatchGeneratorParameters::Pointer parameter);
     protected:
@@ -31,6 +31,7 @@ namespace mitk {
     public:
       mitkClassMacroItkParent(TissueGeneratorParameters, itk::Object)
         itkFactorylessNewMacro(Self)
+        mitkNewMacro1Param(Self, Self::Pointer)
 
         /**
          * Callback function definition of a VesselMeanderStrategy
@@ -48,6 +49,8 @@ namespace mitk {
         itkGetMacro(RngSeed, long)
         itkGetMacro(RandomizePhysicalProperties, bool)
         itkGetMacro(RandomizePhysicalPropertiesPercentage, double)
+        itkGetMacro(UseCompactVolumeStorage, bool)
+        itkGetMacro(NumberOfRasterizationThreads, unsigned int)
 
         itkGetMacro(BackgroundAbsorption, double)
         itkGetMacro(BackgroundScattering, double)
@@ -103,6 +106,14 @@ namespace mitk {
         itkSetMacro(RngSeed, long)
         itkSetMacro(RandomizePhysicalProperties, bool)
         itkSetMacro(RandomizePhysicalPropertiesPercentage, double)
+        /** stores the generated tissue volumes as float in bricks, see mitk::pa::Volume. Default is false. */
+        itkSetMacro(UseCompactVolumeStorage, bool)
+
+        /**
+         * @brief Number of threads drawing the vessels into the volume. A value of 0 uses all cores.
+         * The generated volume does not depend on this value.
+         */
+        itkSetMacro(NumberOfRasterizationThreads, unsigned int)
 
         itkSetMacro(BackgroundAbsorption, double)
         itkSetMacro(BackgroundScattering, double)
@@ -150,6 +161,7 @@ namespace mitk {
 
     protected:
       TissueGeneratorParameters();
+      TissueGeneratorParameters(Self::Pointer other);
       ~TissueGeneratorParameters() override;
 
     private:
@@ -164,6 +176,8 @@ namespace mitk {
       long m_RngSeed;
       bool m_RandomizePhysicalProperties;
       double m_RandomizePhysicalPropertiesPercentage;
+      bool m_UseCompactVolumeStorage;
+      unsigned int m_NumberOfRasterizationThreads;
 
       double m_BackgroundAbsorption;
       double m_BackgroundScattering;
@@ -23,6 +23,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkPAVector.h"
 #include "mitkPAVesselProperties.h"
 
+#include <vector>
+
 #include <MitkPhotoacousticsLibExports.h>
 
 //Includes for smart pointer usage
@@ -43,6 +45,20 @@ namespace mitk {
         typedef void (VesselMeanderStrategy::*CalculateNewVesselPositionCallback)
         (Vector::Pointer, Vector::Pointer, double, std::mt19937*);
 
+      /**
+       * A sphere of vessel tissue as it is drawn into the volume while the vessel expands.
+       */
+      struct Sphere
+      {
+        int x;
+        int y;
+        int z;
+        double radius;
+        double absorption;
+        double scattering;
+        double anisotropy;
+      };
+
       /**
        * @brief ExpandVessel makes this Vessel expand one step in its current direction.
        * After expanding, the vessel will draw itself into the given InSilicoTissueVolume.
@@ -51,9 +67,21 @@ namespace mitk {
        * @param calculateNewPosition a callback function of the VesselMeanderStrategy class.
        * It is used to  calculate the final position after taking the step.
        * @param bendingFactor a metric of how much the Vessel should bend. If set to 0 the vessel will go in a straight line.
+       * @param deferredSpheres if not nullptr, the spheres are appended to this list instead of being drawn,
+       * so they can be drawn later by DrawSpheresInVolume(). The expansion itself is not affected.
        */
       void ExpandVessel(mitk::pa::InSilicoTissueVolume::Pointer volume,
-        CalculateNewVesselPositionCallback calculateNewPosition, double bendingFactor, std::mt19937* rng);
+        CalculateNewVesselPositionCallback calculateNewPosition, double bendingFactor, std::mt19937* rng,
+        std::vector<Sphere>* deferredSpheres = nullptr);
+
+      /**
+       * @brief DrawSpheresInVolume draws the given spheres into the volume, using numberOfThreads threads
+       * (0 uses all cores). Each thread draws the parts of all spheres within its own range of z slices,
+       * in the order of the list, so overlapping spheres compose exactly as if they were drawn one after
+       * the other.
+       */
+      static void DrawSpheresInVolume(const std::vector<Sphere>& spheres,
+        mitk::pa::InSilicoTissueVolume::Pointer volume, unsigned int numberOfThreads);
 
       /**
        * @brief CanBifurcate
@@ -87,7 +115,9 @@ namespace mitk {
       const double NEW_RADIUS_MINIMUM_RELATIVE_SIZE = 0.6;
       const double NEW_RADIUS_MAXIMUM_RELATIVE_SIZE = 0.8;
 
-      void DrawVesselInVolume(Vector::Pointer toPosition, mitk::pa::InSilicoTissueVolume::Pointer volume);
+      void DrawVesselInVolume(Vector::Pointer toPosition, mitk::pa::InSilicoTissueVolume::Pointer volume,
+        std::vector<Sphere>* deferredSpheres);
+      static void DrawSphere(const Sphere& sphere, int zBegin, int zEnd, mitk::pa::InSilicoTissueVolume* volume);
       VesselProperties::Pointer m_VesselProperties;
 
       VesselMeanderStrategy::Pointer m_VesselMeanderStrategy;
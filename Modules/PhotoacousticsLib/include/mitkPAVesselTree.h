@@ -43,10 +43,12 @@ namespace mitk {
          * @param volume
          * @param calculateNewPosition
          * @param bendingFactor
+         * @param deferredSpheres if not nullptr, the subvessels append what they would draw to this list
+         * instead of drawing it into the volume (see Vessel::DrawSpheresInVolume()).
          */
         void Step(InSilicoTissueVolume::Pointer volume,
           Vessel::CalculateNewVesselPositionCallback calculateNewPosition,
-          double bendingFactor, std::mt19937* rng);
+          double bendingFactor, std::mt19937* rng, std::vector<Vessel::Sphere>* deferredSpheres = nullptr);
 
       /**
        * @brief IsFinished
@@ -23,6 +23,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkImage.h>
 #include <itkLightObject.h>
 
+#include <atomic>
+#include <vector>
+
 namespace mitk
 {
   namespace pa
@@ -30,6 +33,12 @@ namespace mitk
     /**
      * @brief The Volume class is designed to encapsulate volumetric information and to provide convenience methods
      * for data access and image conversions.
+     *
+     * By default the voxels are stored as double in the memory of an internal mitk::Image in y|x|z order.
+     * For large volumes a compact storage can be chosen on construction: FloatStorage halves the memory,
+     * and BrickedLayout stores blocks of BRICK_EDGE_LENGTH^3 neighbouring voxels contiguously, so random
+     * accesses within a neighbourhood mostly hit the same cache lines. With a compact storage, the
+     * mitk::Image returned by AsMitkImage() is only created on demand.
      */
     class MITKPHOTOACOUSTICSLIB_EXPORT Volume : public itk::LightObject
     {
@@ -37,6 +46,21 @@ namespace mitk
 
       mitkClassMacroItkParent(Volume, itk::LightObject)
 
+        enum StorageType
+        {
+          DoubleStorage,
+          FloatStorage
+        };
+
+        enum LayoutType
+        {
+          LinearLayout,
+          BrickedLayout
+        };
+
+        /** @brief edge length in voxels of the bricks of the BrickedLayout */
+        static const unsigned int BRICK_EDGE_LENGTH = 8;
+
         /**
         *@brief returns smartpointer reference to a new instance of this objects.
         *  The given data array will be freed upon calling this constructor.
@@ -48,6 +72,13 @@ namespace mitk
         */
         static Volume::Pointer New(double* data, unsigned int xDim, unsigned int yDim, unsigned int zDim);
 
+      /**
+      *@brief returns smartpointer reference to a new instance of this objects, storing the voxels in the given
+      *  precision and layout. The given data array in y|x|z order will be freed upon calling this constructor.
+      */
+      static Volume::Pointer New(double* data, unsigned int xDim, unsigned int yDim, unsigned int zDim,
+        StorageType storageType, LayoutType layout);
+
       /**
        * @brief GetData. Returns data at wanted position. For performance reasons, this method will not check,
        * if the specified position it within the array. Please use the GetXDim(), GetYDim() and GetZDim() methods
@@ -63,8 +94,25 @@ namespace mitk
 
       /**
       * Returns a const reference to the data encapsuled by this class.
+      * A volume with compact storage is converted to DoubleStorage and LinearLayout by this call, because
+      * the caller expects a plain double array in y|x|z order.
       */
-      double* GetData() const;
+      double* GetData();
+
+      /**
+      * @brief CopyTo writes all voxels as double in y|x|z order to the given array of GetXDim()*GetYDim()*GetZDim() elements.
+      * In contrast to GetData(), the storage of the volume is not changed.
+      */
+      void CopyTo(double* data) const;
+
+      /**
+      * @brief CopyFrom sets all voxels from the given array in y|x|z order, keeping the storage of the volume.
+      */
+      void CopyFrom(const double* data);
+
+      StorageType GetStorageType() const;
+
+      LayoutType GetLayout() const;
 
       /**
        * @brief SetData
@@ -95,6 +143,8 @@ namespace mitk
 
       /**
       *@brief returns the Volume instance as an mitk image
+      * With a compact storage, the image is a double copy of the voxels which is created on the first call and
+      * kept until the volume is modified. Changes to this image do not affect the volume.
       */
       Image::Pointer AsMitkImage();
 
@@ -123,9 +173,20 @@ namespace mitk
        * @param yDim y dimension of the data
        * @param zDim z dimension of the data
        */
-      Volume(double* data, unsigned int xDim, unsigned int yDim, unsigned int zDim);
+      Volume(double* data, unsigned int xDim, unsigned int yDim, unsigned int zDim,
+        StorageType storageType, LayoutType layout);
       ~Volume() override;
 
+      /**
+      *@brief index of the voxel in m_FloatData resp. m_DoubleData of a compact storage
+      */
+      size_t GetStorageIndex(unsigned int x, unsigned int y, unsigned int z) const;
+
+      /**
+      *@brief creates the internal mitk image from a compact storage if it is missing or outdated
+      */
+      void UpdateInternalMitkImage();
+
       const int NUMBER_OF_SPATIAL_DIMENSIONS = 3;
 
       Image::Pointer m_InternalMitkImage;
@@ -134,7 +195,15 @@ namespace mitk
       unsigned int m_XDim;
       unsigned int m_YDim;
       unsigned int m_ZDim;
-      double* m_FastAccessDataPointer;
+      double* m_FastAccessDataPointer; ///< voxels of the default storage, nullptr for a compact storage
+
+      StorageType m_StorageType;
+      LayoutType m_Layout;
+      std::vector<float> m_FloatData;    ///< voxels of FloatStorage
+      std::vector<double> m_DoubleData;  ///< voxels of DoubleStorage with BrickedLayout
+      unsigned int m_XBricks;
+      unsigned int m_YBricks;
+      std::atomic<bool> m_InternalMitkImageOutdated;
     };
   }
 }
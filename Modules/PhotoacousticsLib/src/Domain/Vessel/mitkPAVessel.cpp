@@ -15,6 +15,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "mitkPAVessel.h"
+#include <algorithm>
+#include <limits>
 #include <chrono>
 #include <thread>
 
@@ -38,11 +40,12 @@ mitk::pa::Vessel::~Vessel()
 }
 
 void mitk::pa::Vessel::ExpandVessel(InSilicoTissueVolume::Pointer volume,
-  CalculateNewVesselPositionCallback calculateNewPosition, double bendingFactor, std::mt19937* rng)
+  CalculateNewVesselPositionCallback calculateNewPosition, double bendingFactor, std::mt19937* rng,
+  std::vector<Sphere>* deferredSpheres)
 {
   Vector::Pointer oldPosition = m_VesselProperties->GetPositionVector()->Clone();
   (m_VesselMeanderStrategy->*calculateNewPosition)(m_VesselProperties->GetPositionVector(), m_VesselProperties->GetDirectionVector(), bendingFactor, rng);
-  DrawVesselInVolume(oldPosition, volume);
+  DrawVesselInVolume(oldPosition, volume, deferredSpheres);
 }
 
 bool mitk::pa::Vessel::CanBifurcate()
@@ -78,7 +81,7 @@ mitk::pa::Vessel::Pointer mitk::pa::Vessel::Bifurcate(std::mt19937* rng)
 }
 
 void mitk::pa::Vessel::DrawVesselInVolume(Vector::Pointer fromPosition,
-  InSilicoTissueVolume::Pointer volume)
+  InSilicoTissueVolume::Pointer volume, std::vector<Sphere>* deferredSpheres)
 {
   Vector::Pointer diffVector = Vector::New();
   Vector::Pointer toPosition = m_VesselProperties->GetPositionVector();
@@ -109,20 +112,19 @@ void mitk::pa::Vessel::DrawVesselInVolume(Vector::Pointer fromPosition,
       break;
     }
 
-    double radius = m_VesselProperties->GetRadiusInVoxel();
+    Sphere sphere;
+    sphere.x = xPos;
+    sphere.y = yPos;
+    sphere.z = zPos;
+    sphere.radius = m_VesselProperties->GetRadiusInVoxel();
+    sphere.absorption = m_VesselProperties->GetAbsorptionCoefficient();
+    sphere.scattering = m_VesselProperties->GetScatteringCoefficient();
+    sphere.anisotropy = m_VesselProperties->GetAnisotopyCoefficient();
 
-    for (int x = xPos - radius; x <= xPos + radius; x++)
-      for (int y = yPos - radius; y <= yPos + radius; y++)
-        for (int z = zPos - radius; z <= zPos + radius; z++)
-        {
-          if (radius*radius >= (x - xPos)*(x - xPos) + (y - yPos)*(y - yPos) + (z - zPos)*(z - zPos))
-          {
-            volume->SetVolumeValues(x, y, z, m_VesselProperties->GetAbsorptionCoefficient(),
-              m_VesselProperties->GetScatteringCoefficient(),
-              m_VesselProperties->GetAnisotopyCoefficient(),
-              mitk::pa::InSilicoTissueVolume::SegmentationType::VESSEL);
-          }
-        }
+    if (deferredSpheres != nullptr)
+      deferredSpheres->push_back(sphere);
+    else
+      DrawSphere(sphere, std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), volume);
 
     diffVector->SetElement(0, fromPosition->GetElement(0) - toPosition->GetElement(0));
     diffVector->SetElement(1, fromPosition->GetElement(1) - toPosition->GetElement(1));
@@ -130,6 +132,61 @@ void mitk::pa::Vessel::DrawVesselInVolume(Vector::Pointer fromPosition,
   }
 }
 
+void mitk::pa::Vessel::DrawSphere(const Sphere& sphere, int zBegin, int zEnd, InSilicoTissueVolume* volume)
+{
+  const double radius = sphere.radius;
+
+  // the bounding box of the sphere, restricted to the z slices [zBegin, zEnd)
+  int zFirst = std::max((int)(sphere.z - radius), zBegin);
+  for (int x = sphere.x - radius; x <= sphere.x + radius; x++)
+    for (int y = sphere.y - radius; y <= sphere.y + radius; y++)
+      for (int z = zFirst; z <= sphere.z + radius && z < zEnd; z++)
+      {
+        if (radius*radius >= (x - sphere.x)*(x - sphere.x) + (y - sphere.y)*(y - sphere.y) + (z - sphere.z)*(z - sphere.z))
+        {
+          volume->SetVolumeValues(x, y, z, sphere.absorption, sphere.scattering, sphere.anisotropy,
+            mitk::pa::InSilicoTissueVolume::SegmentationType::VESSEL);
+        }
+      }
+}
+
+void mitk::pa::Vessel::DrawSpheresInVolume(const std::vector<Sphere>& spheres,
+  InSilicoTissueVolume::Pointer volume, unsigned int numberOfThreads)
+{
+  const int zDim = volume->GetAbsorptionVolume()->GetZDim();
+
+  if (numberOfThreads == 0)
+    numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+  numberOfThreads = std::min(numberOfThreads, (unsigned int)std::max(zDim, 1));
+
+  // every thread owns a range of z slices, so no voxel is written by two threads
+  auto drawSlab = [&spheres, &volume](int zBegin, int zEnd)
+  {
+    for (const Sphere& sphere : spheres)
+    {
+      if (sphere.z + sphere.radius < zBegin || sphere.z - sphere.radius >= zEnd)
+        continue;
+      DrawSphere(sphere, zBegin, zEnd, volume.GetPointer());
+    }
+  };
+
+  if (numberOfThreads <= 1)
+  {
+    drawSlab(0, zDim);
+    return;
+  }
+
+  std::vector<std::thread> threads;
+  for (unsigned int threadIdx = 0; threadIdx < numberOfThreads; ++threadIdx)
+  {
+    int zBegin = (int)((long)zDim * threadIdx / numberOfThreads);
+    int zEnd = (int)((long)zDim * (threadIdx + 1) / numberOfThreads);
+    threads.push_back(std::thread(drawSlab, zBegin, zEnd));
+  }
+  for (auto& thread : threads)
+    thread.join();
+}
+
 bool mitk::pa::Vessel::IsFinished()
 {
   return m_VesselProperties->GetRadiusInVoxel() < MINIMUM_VESSEL_RADIUS;
@@ -32,7 +32,8 @@ mitk::pa::VesselTree::~VesselTree()
 }
 
 void mitk::pa::VesselTree::Step(mitk::pa::InSilicoTissueVolume::Pointer volume,
-  Vessel::CalculateNewVesselPositionCallback calculateNewPosition, double bendingFactor, std::mt19937* rng)
+  Vessel::CalculateNewVesselPositionCallback calculateNewPosition, double bendingFactor, std::mt19937* rng,
+  std::vector<Vessel::Sphere>* deferredSpheres)
 {
   std::vector<Vessel::Pointer> newVessels;
 
@@ -41,7 +42,7 @@ void mitk::pa::VesselTree::Step(mitk::pa::InSilicoTissueVolume::Pointer volume,
     Vessel::Pointer currentVessel = m_CurrentSubvessels->at(vesselTreeIndex);
     if (!currentVessel->IsFinished())
     {
-      currentVessel->ExpandVessel(volume, calculateNewPosition, bendingFactor, rng);
+      currentVessel->ExpandVessel(volume, calculateNewPosition, bendingFactor, rng, deferredSpheres);
       if (currentVessel->CanBifurcate())
       {
         newVessels.push_back(currentVessel->Bifurcate(rng));
@@ -22,6 +22,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkDiscreteGaussianImageFilter.h>
 #include <mitkImageCast.h>
 #include <mitkImageToItk.h>
+#include <mitkImageWriteAccessor.h>
 #include <chrono>
 
 mitk::pa::InSilicoTissueVolume::InSilicoTissueVolume(TissueGeneratorParameters::Pointer parameters)
@@ -45,10 +46,12 @@ mitk::pa::InSilicoTissueVolume::InSilicoTissueVolume(TissueGeneratorParameters::
       segmentationArray[index] = SegmentationType::BACKGROUND;
     }
 
-    m_AbsorptionVolume = Volume::New(absorptionArray, xDim, yDim, zDim);
-    m_ScatteringVolume = Volume::New(scatteringArray, xDim, yDim, zDim);
-    m_AnisotropyVolume = Volume::New(anisotropyArray, xDim, yDim, zDim);
-    m_SegmentationVolume = Volume::New(segmentationArray, xDim, yDim, zDim);
+    Volume::StorageType storageType = parameters->GetUseCompactVolumeStorage() ? Volume::FloatStorage : Volume::DoubleStorage;
+    Volume::LayoutType layout = parameters->GetUseCompactVolumeStorage() ? Volume::BrickedLayout : Volume::LinearLayout;
+    m_AbsorptionVolume = Volume::New(absorptionArray, xDim, yDim, zDim, storageType, layout);
+    m_ScatteringVolume = Volume::New(scatteringArray, xDim, yDim, zDim, storageType, layout);
+    m_AnisotropyVolume = Volume::New(anisotropyArray, xDim, yDim, zDim, storageType, layout);
+    m_SegmentationVolume = Volume::New(segmentationArray, xDim, yDim, zDim, storageType, layout);
   }
 
   m_TissueParameters = parameters;
@@ -137,11 +140,13 @@ mitk::Image::Pointer mitk::pa::InSilicoTissueVolume::ConvertToMitkImage()
   resultImage->SetSpacing(spacing);
 
   MITK_INFO << "Set Import Volumes...";
-  //Copy memory, deal with cleaning up memory yourself!
-  resultImage->SetImportVolume(m_AbsorptionVolume->GetData(), 0, 0, mitk::Image::CopyMemory);
-  resultImage->SetImportVolume(m_ScatteringVolume->GetData(), 1, 0, mitk::Image::CopyMemory);
-  resultImage->SetImportVolume(m_AnisotropyVolume->GetData(), 2, 0, mitk::Image::CopyMemory);
-  resultImage->SetImportVolume(m_SegmentationVolume->GetData(), 3, 0, mitk::Image::CopyMemory);
+  //Copy memory, the volumes keep their own storage
+  Volume::Pointer volumes[] = { m_AbsorptionVolume, m_ScatteringVolume, m_AnisotropyVolume, m_SegmentationVolume };
+  for (unsigned int t = 0; t < 4; ++t)
+  {
+    mitk::ImageWriteAccessor writeAccess(resultImage, resultImage->GetVolumeData(t));
+    volumes[t]->CopyTo((double*)writeAccess.GetData());
+  }
   MITK_INFO << "Set Import Volumes...[Done]";
 
   resultImage->SetPropertyList(m_PropertyList);
@@ -20,27 +20,52 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mutex>
 
 mitk::pa::Volume::Volume(double* data,
-  unsigned int xDim, unsigned int yDim, unsigned int zDim)
+  unsigned int xDim, unsigned int yDim, unsigned int zDim, StorageType storageType, LayoutType layout) :
+  m_FastAccessDataPointer(nullptr),
+  m_StorageType(storageType),
+  m_Layout(layout),
+  m_XBricks((xDim + BRICK_EDGE_LENGTH - 1) / BRICK_EDGE_LENGTH),
+  m_YBricks((yDim + BRICK_EDGE_LENGTH - 1) / BRICK_EDGE_LENGTH),
+  m_InternalMitkImageOutdated(true)
 {
   if (data == nullptr)
     mitkThrow() << "You may not initialize a mitk::Volume with a nullptr";
-  m_InternalMitkImage = mitk::Image::New();
 
-  auto* dimensions = new unsigned int[NUMBER_OF_SPATIAL_DIMENSIONS];
-  dimensions[0] = yDim;
-  dimensions[1] = xDim;
-  dimensions[2] = zDim;
   m_XDim = xDim;
   m_YDim = yDim;
   m_ZDim = zDim;
-  mitk::PixelType pixelType = mitk::MakeScalarPixelType<double>();
 
-  m_InternalMitkImage->Initialize(pixelType, NUMBER_OF_SPATIAL_DIMENSIONS, dimensions);
-  m_InternalMitkImage->SetImportVolume(data, Image::ImportMemoryManagementType::CopyMemory);
+  if (m_StorageType == DoubleStorage && m_Layout == LinearLayout)
+  {
+    m_InternalMitkImage = mitk::Image::New();
+
+    auto* dimensions = new unsigned int[NUMBER_OF_SPATIAL_DIMENSIONS];
+    dimensions[0] = yDim;
+    dimensions[1] = xDim;
+    dimensions[2] = zDim;
+    mitk::PixelType pixelType = mitk::MakeScalarPixelType<double>();
+
+    m_InternalMitkImage->Initialize(pixelType, NUMBER_OF_SPATIAL_DIMENSIONS, dimensions);
+    m_InternalMitkImage->SetImportVolume(data, Image::ImportMemoryManagementType::CopyMemory);
+    delete[] dimensions;
 
-  m_FastAccessDataPointer = GetData();
+    mitk::ImageWriteAccessor imgWrite(m_InternalMitkImage, m_InternalMitkImage->GetVolumeData());
+    m_FastAccessDataPointer = (double*)imgWrite.GetData();
+    m_InternalMitkImageOutdated = false;
+  }
+  else
+  {
+    size_t size = (m_Layout == BrickedLayout)
+      ? (size_t)m_XBricks * m_YBricks * ((zDim + BRICK_EDGE_LENGTH - 1) / BRICK_EDGE_LENGTH) * BRICK_EDGE_LENGTH * BRICK_EDGE_LENGTH * BRICK_EDGE_LENGTH
+      : (size_t)xDim * yDim * zDim;
+    if (m_StorageType == FloatStorage)
+      m_FloatData.assign(size, 0.0f);
+    else
+      m_DoubleData.assign(size, 0.0);
+    CopyFrom(data);
+  }
 
-  delete data;
+  delete[] data;
 }
 
 mitk::pa::Volume::~Volume()
@@ -50,33 +75,120 @@ mitk::pa::Volume::~Volume()
 
 mitk::pa::Volume::Pointer mitk::pa::Volume::New(double* data, unsigned int xDim, unsigned int yDim, unsigned int zDim)
 {
-  mitk::pa::Volume::Pointer smartPtr = new mitk::pa::Volume(data, xDim, yDim, zDim);
+  return New(data, xDim, yDim, zDim, DoubleStorage, LinearLayout);
+}
+
+mitk::pa::Volume::Pointer mitk::pa::Volume::New(double* data, unsigned int xDim, unsigned int yDim, unsigned int zDim,
+  StorageType storageType, LayoutType layout)
+{
+  mitk::pa::Volume::Pointer smartPtr = new mitk::pa::Volume(data, xDim, yDim, zDim, storageType, layout);
   smartPtr->UnRegister();
   return smartPtr;
 }
 
 mitk::Image::Pointer mitk::pa::Volume::AsMitkImage()
 {
+  UpdateInternalMitkImage();
   return m_InternalMitkImage;
 }
 
+void mitk::pa::Volume::UpdateInternalMitkImage()
+{
+  if (!m_InternalMitkImageOutdated)
+    return;
+
+  m_InternalMitkImage = mitk::Image::New();
+  unsigned int dimensions[3] = { m_YDim, m_XDim, m_ZDim };
+  m_InternalMitkImage->Initialize(mitk::MakeScalarPixelType<double>(), NUMBER_OF_SPATIAL_DIMENSIONS, dimensions);
+  {
+    mitk::ImageWriteAccessor imgWrite(m_InternalMitkImage, m_InternalMitkImage->GetVolumeData());
+    CopyTo((double*)imgWrite.GetData());
+  }
+  m_InternalMitkImageOutdated = false;
+}
+
 mitk::pa::Volume::Pointer mitk::pa::Volume::DeepCopy()
 {
   long length = GetXDim()*GetYDim()*GetZDim();
   auto* data = new double[length];
-  memcpy(data, GetData(), length * sizeof(double));
+  CopyTo(data);
 
-  return mitk::pa::Volume::New(data, GetXDim(), GetYDim(), GetZDim());
+  return mitk::pa::Volume::New(data, GetXDim(), GetYDim(), GetZDim(), m_StorageType, m_Layout);
 }
 
 double mitk::pa::Volume::GetData(unsigned int x, unsigned int y, unsigned int z)
 {
-  return m_FastAccessDataPointer[GetIndex(x, y, z)];
+  if (m_FastAccessDataPointer != nullptr)
+    return m_FastAccessDataPointer[GetIndex(x, y, z)];
+  if (m_StorageType == FloatStorage)
+    return m_FloatData[GetStorageIndex(x, y, z)];
+  return m_DoubleData[GetStorageIndex(x, y, z)];
 }
 
 void mitk::pa::Volume::SetData(double data, unsigned int x, unsigned int y, unsigned int z)
 {
-  m_FastAccessDataPointer[GetIndex(x, y, z)] = data;
+  if (m_FastAccessDataPointer != nullptr)
+  {
+    m_FastAccessDataPointer[GetIndex(x, y, z)] = data;
+    return;
+  }
+  if (m_StorageType == FloatStorage)
+    m_FloatData[GetStorageIndex(x, y, z)] = (float)data;
+  else
+    m_DoubleData[GetStorageIndex(x, y, z)] = data;
+  m_InternalMitkImageOutdated = true;
+}
+
+void mitk::pa::Volume::CopyTo(double* data) const
+{
+  if (m_FastAccessDataPointer != nullptr)
+  {
+    memcpy(data, m_FastAccessDataPointer, (size_t)m_XDim * m_YDim * m_ZDim * sizeof(double));
+    return;
+  }
+  for (unsigned int z = 0; z < m_ZDim; ++z)
+    for (unsigned int x = 0; x < m_XDim; ++x)
+    {
+      double* row = data + ((size_t)z * m_XDim + x) * m_YDim;
+      for (unsigned int y = 0; y < m_YDim; ++y)
+      {
+        size_t index = GetStorageIndex(x, y, z);
+        row[y] = (m_StorageType == FloatStorage) ? (double)m_FloatData[index] : m_DoubleData[index];
+      }
+    }
+}
+
+void mitk::pa::Volume::CopyFrom(const double* data)
+{
+  if (m_FastAccessDataPointer != nullptr)
+  {
+    memcpy(m_FastAccessDataPointer, data, (size_t)m_XDim * m_YDim * m_ZDim * sizeof(double));
+    return;
+  }
+  for (unsigned int z = 0; z < m_ZDim; ++z)
+    for (unsigned int x = 0; x < m_XDim; ++x)
+    {
+      const double* row = data + ((size_t)z * m_XDim + x) * m_YDim;
+      for (unsigned int y = 0; y < m_YDim; ++y)
+      {
+        size_t index = GetStorageIndex(x, y, z);
+        if (m_StorageType == FloatStorage)
+          m_FloatData[index] = (float)row[y];
+        else
+          m_DoubleData[index] = row[y];
+      }
+    }
+  m_InternalMitkImageOutdated = true;
+}
+
+mitk::pa::Volume::StorageType mitk::pa::Volume::GetStorageType() const
+{
+  return m_StorageType;
+}
+
+mitk::pa::Volume::LayoutType mitk::pa::Volume::GetLayout() const
+{
+  return m_Layout;
 }
 
 unsigned int mitk::pa::Volume::GetXDim()
@@ -94,10 +206,20 @@ unsigned int mitk::pa::Volume::GetZDim()
   return m_ZDim;
 }
 
-double* mitk::pa::Volume::GetData() const
+double* mitk::pa::Volume::GetData()
 {
-  mitk::ImageWriteAccessor imgRead(m_InternalMitkImage, m_InternalMitkImage->GetVolumeData());
-  return (double*)imgRead.GetData();
+  if (m_FastAccessDataPointer == nullptr)
+  {
+    // the caller expects a plain double array, so the compact storage is given up
+    UpdateInternalMitkImage();
+    m_FloatData = std::vector<float>();
+    m_DoubleData = std::vector<double>();
+    m_StorageType = DoubleStorage;
+    m_Layout = LinearLayout;
+    mitk::ImageWriteAccessor imgRead(m_InternalMitkImage, m_InternalMitkImage->GetVolumeData());
+    m_FastAccessDataPointer = (double*)imgRead.GetData();
+  }
+  return m_FastAccessDataPointer;
 }
 
 int mitk::pa::Volume::GetIndex(unsigned int x, unsigned int y, unsigned int z)
@@ -113,3 +235,23 @@ int mitk::pa::Volume::GetIndex(unsigned int x, unsigned int y, unsigned int z)
 #endif
   return z * m_XDim * m_YDim + x * m_YDim + y;
 }
+
+size_t mitk::pa::Volume::GetStorageIndex(unsigned int x, unsigned int y, unsigned int z) const
+{
+#ifdef _DEBUG
+
+  if (x > (m_XDim - 1) || y > (m_YDim - 1) || z > (m_ZDim - 1))
+  {
+    MITK_ERROR << "Index out of bounds at " << x << "|" << y << "|" << z;
+    mitkThrow() << "Index out of bounds exception!";
+  }
+
+#endif
+  if (m_Layout == LinearLayout)
+    return ((size_t)z * m_XDim + x) * m_YDim + y;
+
+  // bricks and the voxels within a brick are both ordered y|x|z like the linear layout
+  size_t brick = ((size_t)(z / BRICK_EDGE_LENGTH) * m_XBricks + x / BRICK_EDGE_LENGTH) * m_YBricks + y / BRICK_EDGE_LENGTH;
+  size_t voxel = ((z % BRICK_EDGE_LENGTH) * BRICK_EDGE_LENGTH + x % BRICK_EDGE_LENGTH) * BRICK_EDGE_LENGTH + y % BRICK_EDGE_LENGTH;
+  return brick * BRICK_EDGE_LENGTH * BRICK_EDGE_LENGTH * BRICK_EDGE_LENGTH + voxel;
+}
@@ -15,9 +15,17 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "mitkPASimulationBatchGenerator.h"
+#include "mitkPATissueGenerator.h"
+#include <mitkException.h>
 #include <mitkIOUtil.h>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <iomanip>
+#include <map>
+#include <mutex>
+#include <thread>
 
 #ifdef _WIN32
 #include <direct.h>
@@ -89,3 +97,119 @@ void mitk::pa::SimulationBatchGenerator::WriteBatchFileAndSaveTissueVolume(
     fileAllSimulation.close();
   }
 }
+
+void mitk::pa::SimulationBatchGenerator::GenerateBatch(
+  TissueGeneratorParameters::Pointer tissueParameters,
+  SimulationBatchGeneratorParameters::Pointer batchParameters,
+  unsigned int numberOfVolumes,
+  unsigned int numberOfThreads,
+  unsigned int maximumNumberOfQueuedVolumes)
+{
+  if (numberOfVolumes == 0)
+    return;
+
+  if (numberOfThreads == 0)
+    numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+  numberOfThreads = std::min(numberOfThreads, numberOfVolumes);
+  if (maximumNumberOfQueuedVolumes == 0)
+    maximumNumberOfQueuedVolumes = numberOfThreads;
+
+  std::atomic<unsigned int> nextVolumeToGenerate(0);
+  std::mutex queueMutex;
+  std::condition_variable queueChanged;
+  std::map<unsigned int, mitk::Image::Pointer> queuedVolumes;
+  unsigned int nextVolumeToWrite = 0;
+  std::atomic<bool> aborted(false);
+  std::string errorMessage;
+
+  auto abort = [&](const std::string& message)
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (!aborted)
+      errorMessage = message;
+    aborted = true;
+    queueChanged.notify_all();
+  };
+
+  auto generateVolumes = [&]()
+  {
+    for (unsigned int volumeOffset = nextVolumeToGenerate++; volumeOffset < numberOfVolumes && !aborted;
+      volumeOffset = nextVolumeToGenerate++)
+    {
+      mitk::Image::Pointer tissueVolume;
+      try
+      {
+        auto volumeParameters = TissueGeneratorParameters::New(tissueParameters);
+        volumeParameters->SetRngSeed(tissueParameters->GetRngSeed() + volumeOffset);
+        // the volumes are generated in parallel already
+        volumeParameters->SetNumberOfRasterizationThreads(1);
+        tissueVolume = InSilicoTissueGenerator::GenerateInSilicoData(volumeParameters)->ConvertToMitkImage();
+      }
+      catch (const std::exception& e)
+      {
+        abort(e.what());
+        return;
+      }
+
+      std::unique_lock<std::mutex> lock(queueMutex);
+      queueChanged.wait(lock, [&]() { return aborted || volumeOffset < nextVolumeToWrite + maximumNumberOfQueuedVolumes; });
+      if (aborted)
+        return;
+      queuedVolumes[volumeOffset] = tissueVolume;
+      queueChanged.notify_all();
+    }
+  };
+
+  // a single writer keeps the batch file entries in the order of the volume indices
+  auto writeVolumes = [&]()
+  {
+    while (nextVolumeToWrite < numberOfVolumes)
+    {
+      mitk::Image::Pointer tissueVolume;
+      {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        queueChanged.wait(lock, [&]() { return aborted || queuedVolumes.count(nextVolumeToWrite) > 0; });
+        if (aborted)
+          return;
+        tissueVolume = queuedVolumes[nextVolumeToWrite];
+        queuedVolumes.erase(nextVolumeToWrite);
+      }
+
+      auto volumeBatchParameters = SimulationBatchGeneratorParameters::New();
+      volumeBatchParameters->SetVolumeIndex(batchParameters->GetVolumeIndex() + nextVolumeToWrite);
+      volumeBatchParameters->SetNrrdFilePath(batchParameters->GetNrrdFilePath());
+      volumeBatchParameters->SetTissueName(batchParameters->GetTissueName());
+      volumeBatchParameters->SetBinaryPath(batchParameters->GetBinaryPath());
+      volumeBatchParameters->SetNumberOfPhotons(batchParameters->GetNumberOfPhotons());
+      volumeBatchParameters->SetYOffsetLowerThresholdInCentimeters(batchParameters->GetYOffsetLowerThresholdInCentimeters());
+      volumeBatchParameters->SetYOffsetUpperThresholdInCentimeters(batchParameters->GetYOffsetUpperThresholdInCentimeters());
+      volumeBatchParameters->SetYOffsetStepInCentimeters(batchParameters->GetYOffsetStepInCentimeters());
+
+      try
+      {
+        WriteBatchFileAndSaveTissueVolume(volumeBatchParameters, tissueVolume);
+      }
+      catch (const std::exception& e)
+      {
+        abort(e.what());
+        return;
+      }
+      tissueVolume = nullptr;
+
+      std::lock_guard<std::mutex> lock(queueMutex);
+      ++nextVolumeToWrite;
+      queueChanged.notify_all();
+    }
+  };
+
+  std::thread writer(writeVolumes);
+  std::vector<std::thread> generators;
+  for (unsigned int threadIdx = 0; threadIdx < numberOfThreads; ++threadIdx)
+    generators.push_back(std::thread(generateVolumes));
+  for (auto& generator : generators)
+    generator.join();
+  writer.join();
+
+  if (aborted)
+    mitkThrow() << "Generating the simulation batch failed: " << errorMessage;
+}
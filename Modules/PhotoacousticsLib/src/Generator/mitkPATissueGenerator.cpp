@@ -59,6 +59,10 @@ mitk::pa::InSilicoTissueVolume::Pointer mitk::pa::InSilicoTissueGenerator::Gener
   generatedVolume->AddIntProperty("bifurcationFrequency", parameters->GetVesselBifurcationFrequency());
 
   MITK_INFO << "Simulating " << numberOfBloodVessels << " vessel structures";
+
+  // The vessel growth does not depend on the volume, so all vessels are grown first and drawn
+  // afterwards in parallel, in the same order in which they would have been drawn while growing.
+  std::vector<Vessel::Sphere> vesselSpheres;
   for (int vesselNumber = 0; vesselNumber < numberOfBloodVessels; vesselNumber++)
   {
     Vector::Pointer initialPosition = Vector::New();
@@ -138,10 +142,13 @@ mitk::pa::InSilicoTissueVolume::Pointer mitk::pa::InSilicoTissueGenerator::Gener
 
     while (!vesselTree->IsFinished())
     {
-      vesselTree->Step(generatedVolume, parameters->GetCalculateNewVesselPositionCallback(), bendingFactor, &randomNumberGenerator);
+      vesselTree->Step(generatedVolume, parameters->GetCalculateNewVesselPositionCallback(), bendingFactor,
+        &randomNumberGenerator, &vesselSpheres);
     }
   }
 
+  Vessel::DrawSpheresInVolume(vesselSpheres, generatedVolume, parameters->GetNumberOfRasterizationThreads());
+
   mitk::pa::VolumeManipulator::GaussianBlur3D(generatedVolume->GetAbsorptionVolume(), parameters->GetVolumeSmoothingSigma());
   mitk::pa::VolumeManipulator::GaussianBlur3D(generatedVolume->GetScatteringVolume(), parameters->GetVolumeSmoothingSigma());
   mitk::pa::VolumeManipulator::GaussianBlur3D(generatedVolume->GetAnisotropyVolume(), parameters->GetVolumeSmoothingSigma());
@@ -17,6 +17,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkPAMonteCarloThreadHandler.h"
 #include "mitkCommon.h"
 
+#include <algorithm>
+
 mitk::pa::MonteCarloThreadHandler::MonteCarloThreadHandler(long timInMillisecondsOrNumberofPhotons, bool simulateOnTimeBasis) :
   MonteCarloThreadHandler(timInMillisecondsOrNumberofPhotons, simulateOnTimeBasis, true){}
 
@@ -29,6 +31,7 @@ mitk::pa::MonteCarloThreadHandler::MonteCarloThreadHandler(long timInMillisecond
   m_Time = 0;
   m_NumberPhotonsToSimulate = 0;
   m_NumberPhotonsRemaining = 0;
+  m_NextWorkPackageIndex = 0;
 
   if (m_SimulateOnTimeBasis)
   {
@@ -47,14 +50,22 @@ mitk::pa::MonteCarloThreadHandler::~MonteCarloThreadHandler()
 }
 
 long mitk::pa::MonteCarloThreadHandler::GetNextWorkPackage()
+{
+  long workPackageIndex = 0;
+  return this->GetNextWorkPackage(workPackageIndex);
+}
+
+long mitk::pa::MonteCarloThreadHandler::GetNextWorkPackage(long& workPackageIndex)
 {
   long workPackageSize = 0;
+  workPackageIndex = -1;
   if (m_SimulateOnTimeBasis)
   {
     long now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
     if (now - m_Time <= m_SimulationTime)
     {
       workPackageSize = m_WorkPackageSize;
+      workPackageIndex = m_NextWorkPackageIndex.fetch_add(1, std::memory_order_relaxed);
       if (m_Verbose)
       {
         std::cout << "<filter-progress-text progress='" << ((double)(now - m_Time) / m_SimulationTime) << "'></filter-progress-text>" << std::endl;
@@ -63,29 +74,28 @@ long mitk::pa::MonteCarloThreadHandler::GetNextWorkPackage()
   }
   else
   {
-    m_MutexRemainingPhotonsManipulation.lock();
-
-    if (m_NumberPhotonsRemaining < m_WorkPackageSize)
-    {
-      workPackageSize = m_NumberPhotonsRemaining;
-    }
-    else
+    // the counter may drop below zero when threads claim the last photons at the same time,
+    // every thread only takes what was left before its own subtraction
+    long photonsRemainingBefore = m_NumberPhotonsRemaining.fetch_sub(m_WorkPackageSize, std::memory_order_relaxed);
+    workPackageSize = std::max(0L, std::min(photonsRemainingBefore, m_WorkPackageSize));
+    // the index follows from the photons claimed before, so a package always gets the same index and size
+    if (workPackageSize > 0)
+      workPackageIndex = (m_NumberPhotonsToSimulate - photonsRemainingBefore) / m_WorkPackageSize;
+
+    if (m_Verbose && workPackageSize > 0)
     {
-      workPackageSize = m_WorkPackageSize;
-    }
-
-    m_NumberPhotonsRemaining -= workPackageSize;
-    m_MutexRemainingPhotonsManipulation.unlock();
-
-    if (m_Verbose)
-    {
-      std::cout << "<filter-progress-text progress='" << 1.0 - ((double)m_NumberPhotonsRemaining / m_NumberPhotonsToSimulate) << "'></filter-progress-text>" << std::endl;
+      std::cout << "<filter-progress-text progress='" << 1.0 - ((double)this->GetNumberPhotonsRemaining() / m_NumberPhotonsToSimulate) << "'></filter-progress-text>" << std::endl;
     }
   }
 
   return workPackageSize;
 }
 
+long mitk::pa::MonteCarloThreadHandler::GetNumberPhotonsRemaining() const
+{
+  return std::max(0L, m_NumberPhotonsRemaining.load(std::memory_order_relaxed));
+}
+
 void mitk::pa::MonteCarloThreadHandler::SetPackageSize(long sizeInMilliseconsOrNumberOfPhotons)
 {
   m_WorkPackageSize = sizeInMilliseconsOrNumberOfPhotons;
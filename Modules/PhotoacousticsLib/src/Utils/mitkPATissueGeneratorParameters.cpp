@@ -28,6 +28,8 @@ mitk::pa::TissueGeneratorParameters::TissueGeneratorParameters()
   m_RngSeed = 1337L;
   m_RandomizePhysicalProperties = false;
   m_RandomizePhysicalPropertiesPercentage = 0;
+  m_UseCompactVolumeStorage = false;
+  m_NumberOfRasterizationThreads = 0;
 
   m_BackgroundAbsorption = 0.1;
   m_BackgroundScattering = 15;
@@ -74,6 +76,62 @@ mitk::pa::TissueGeneratorParameters::TissueGeneratorParameters()
   m_MCWaist = 4;
 }
 
+mitk::pa::TissueGeneratorParameters::TissueGeneratorParameters(Self::Pointer other)
+{
+  m_XDim = other->m_XDim;
+  m_YDim = other->m_YDim;
+  m_ZDim = other->m_ZDim;
+  m_VoxelSpacingInCentimeters = other->m_VoxelSpacingInCentimeters;
+  m_VolumeSmoothingSigma = other->m_VolumeSmoothingSigma;
+  m_DoVolumeSmoothing = other->m_DoVolumeSmoothing;
+  m_UseRngSeed = other->m_UseRngSeed;
+  m_RngSeed = other->m_RngSeed;
+  m_RandomizePhysicalProperties = other->m_RandomizePhysicalProperties;
+  m_RandomizePhysicalPropertiesPercentage = other->m_RandomizePhysicalPropertiesPercentage;
+  m_UseCompactVolumeStorage = other->m_UseCompactVolumeStorage;
+  m_BackgroundAbsorption = other->m_BackgroundAbsorption;
+  m_BackgroundScattering = other->m_BackgroundScattering;
+  m_BackgroundAnisotropy = other->m_BackgroundAnisotropy;
+  m_AirAbsorption = other->m_AirAbsorption;
+  m_AirScattering = other->m_AirScattering;
+  m_AirAnisotropy = other->m_AirAnisotropy;
+  m_AirThicknessInMillimeters = other->m_AirThicknessInMillimeters;
+  m_SkinAbsorption = other->m_SkinAbsorption;
+  m_SkinScattering = other->m_SkinScattering;
+  m_SkinAnisotropy = other->m_SkinAnisotropy;
+  m_SkinThicknessInMillimeters = other->m_SkinThicknessInMillimeters;
+  m_CalculateNewVesselPositionCallback = other->m_CalculateNewVesselPositionCallback;
+  m_MinNumberOfVessels = other->m_MinNumberOfVessels;
+  m_MaxNumberOfVessels = other->m_MaxNumberOfVessels;
+  m_MinVesselBending = other->m_MinVesselBending;
+  m_MaxVesselBending = other->m_MaxVesselBending;
+  m_MinVesselAbsorption = other->m_MinVesselAbsorption;
+  m_MaxVesselAbsorption = other->m_MaxVesselAbsorption;
+  m_MinVesselRadiusInMillimeters = other->m_MinVesselRadiusInMillimeters;
+  m_MaxVesselRadiusInMillimeters = other->m_MaxVesselRadiusInMillimeters;
+  m_VesselBifurcationFrequency = other->m_VesselBifurcationFrequency;
+  m_MinVesselScattering = other->m_MinVesselScattering;
+  m_MaxVesselScattering = other->m_MaxVesselScattering;
+  m_MinVesselAnisotropy = other->m_MinVesselAnisotropy;
+  m_MaxVesselAnisotropy = other->m_MaxVesselAnisotropy;
+  m_MinVesselZOrigin = other->m_MinVesselZOrigin;
+  m_MaxVesselZOrigin = other->m_MaxVesselZOrigin;
+  m_MCflag = other->m_MCflag;
+  m_MCLaunchflag = other->m_MCLaunchflag;
+  m_MCBoundaryflag = other->m_MCBoundaryflag;
+  m_MCLaunchPointX = other->m_MCLaunchPointX;
+  m_MCLaunchPointY = other->m_MCLaunchPointY;
+  m_MCLaunchPointZ = other->m_MCLaunchPointZ;
+  m_MCFocusPointX = other->m_MCFocusPointX;
+  m_MCFocusPointY = other->m_MCFocusPointY;
+  m_MCFocusPointZ = other->m_MCFocusPointZ;
+  m_MCTrajectoryVectorX = other->m_MCTrajectoryVectorX;
+  m_MCTrajectoryVectorY = other->m_MCTrajectoryVectorY;
+  m_MCTrajectoryVectorZ = other->m_MCTrajectoryVectorZ;
+  m_MCRadius = other->m_MCRadius;
+  m_MCWaist = other->m_MCWaist;
+}
+
 mitk::pa::TissueGeneratorParameters::~TissueGeneratorParameters()
 {
 }
@@ -72,7 +72,18 @@ void mitk::pa::VolumeManipulator::Log10Image(mitk::pa::Volume::Pointer image)
 */
 void mitk::pa::VolumeManipulator::GaussianBlur3D(mitk::pa::Volume::Pointer paVolume, double sigma)
 {
-  double* volume = paVolume->GetData();
+  if (sigma <= 0)
+    return;
+
+  // a compact storage is only expanded temporarily, GetData() would give it up
+  const bool compactStorage = paVolume->GetStorageType() != Volume::DoubleStorage || paVolume->GetLayout() != Volume::LinearLayout;
+  std::vector<double> linearData;
+  if (compactStorage)
+  {
+    linearData.resize((size_t)paVolume->GetXDim() * paVolume->GetYDim() * paVolume->GetZDim());
+    paVolume->CopyTo(linearData.data());
+  }
+  double* volume = compactStorage ? linearData.data() : paVolume->GetData();
   long width = paVolume->GetYDim();
   long height = paVolume->GetXDim();
   long depth = paVolume->GetZDim();
@@ -84,9 +95,6 @@ void mitk::pa::VolumeManipulator::GaussianBlur3D(mitk::pa::Volume::Pointer paVol
   long i, x, y, z;
   int step;
 
-  if (sigma <= 0)
-    return;
-
   lambda = (sigma*sigma) / (8.0);
   dnu = (1.0 + 2.0*lambda - sqrt(1.0 + 4.0*lambda)) / (2.0*lambda);
   nu = dnu;
@@ -174,4 +182,7 @@ void mitk::pa::VolumeManipulator::GaussianBlur3D(mitk::pa::Volume::Pointer paVol
   {
     volume[i] *= postscale;
   }
+
+  if (compactStorage)
+    paVolume->CopyFrom(volume);
 }
@@ -28,6 +28,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <random>
 #include <chrono>
+#include <thread>
+#include <algorithm>
 
 class mitkMCThreadHandlerTestSuite : public mitk::TestFixture
 {
@@ -36,6 +38,7 @@ class mitkMCThreadHandlerTestSuite : public mitk::TestFixture
   MITK_TEST(testCorrectNumberOfPhotons);
   MITK_TEST(testCorrectNumberOfPhotonsWithUnevenPackageSize);
   MITK_TEST(testCorrectNumberOfPhotonsWithTooLargePackageSize);
+  MITK_TEST(testConcurrentWorkPackages);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -96,6 +99,54 @@ public:
     CPPUNIT_ASSERT(numberOfPhotonsSimulated == m_NumberOrTime);
   }
 
+  void testConcurrentWorkPackages()
+  {
+    const long numberOfPhotons = 1000003;
+    const long packageSize = 100;
+    const unsigned int numberOfThreads = 8;
+    m_MonteCarloThreadHandler = mitk::pa::MonteCarloThreadHandler::New(numberOfPhotons, false, false);
+    m_MonteCarloThreadHandler->SetPackageSize(packageSize);
+
+    std::vector<std::vector<std::pair<long, long>>> claimedPackages(numberOfThreads);
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < numberOfThreads; ++t)
+    {
+      threads.emplace_back([this, &claimedPackages, t]()
+      {
+        long index = 0;
+        long size = 0;
+        while ((size = m_MonteCarloThreadHandler->GetNextWorkPackage(index)) > 0)
+        {
+          claimedPackages[t].push_back(std::make_pair(index, size));
+        }
+      });
+    }
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+
+    std::vector<std::pair<long, long>> allPackages;
+    for (const auto& packages : claimedPackages)
+    {
+      allPackages.insert(allPackages.end(), packages.begin(), packages.end());
+    }
+    std::sort(allPackages.begin(), allPackages.end());
+
+    const long numberOfPackages = (numberOfPhotons + packageSize - 1) / packageSize;
+    CPPUNIT_ASSERT_EQUAL(numberOfPackages, static_cast<long>(allPackages.size()));
+    long numberOfPhotonsSimulated = 0;
+    for (long i = 0; i < numberOfPackages; ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL_MESSAGE("Every package index is claimed exactly once", i, allPackages[i].first);
+      long expectedSize = (i < numberOfPackages - 1) ? packageSize : numberOfPhotons - i * packageSize;
+      CPPUNIT_ASSERT_EQUAL_MESSAGE("The size of a package only depends on its index", expectedSize, allPackages[i].second);
+      numberOfPhotonsSimulated += allPackages[i].second;
+    }
+    CPPUNIT_ASSERT_EQUAL(numberOfPhotons, numberOfPhotonsSimulated);
+    CPPUNIT_ASSERT_EQUAL(0L, m_MonteCarloThreadHandler->GetNumberPhotonsRemaining());
+  }
+
   void tearDown() override
   {
     m_MonteCarloThreadHandler = nullptr;
@@ -32,6 +32,7 @@ class mitkPhotoacoustic3dVolumeTestSuite : public mitk::TestFixture
   MITK_TEST(TestConvertToMitkImage);
   MITK_TEST(TestDeepCopy);
   MITK_TEST(TestCatchException);
+  MITK_TEST(TestCompactStorage);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -182,6 +183,66 @@ public:
     CPPUNIT_ASSERT(copiedVolume->GetData(0, 0, 0) == 3);
   }
 
+  void AssertCompactStorage(mitk::pa::Volume::StorageType storageType, mitk::pa::Volume::LayoutType layout)
+  {
+    unsigned int xDim = 13;
+    unsigned int yDim = 9;
+    unsigned int zDim = 10;
+    unsigned int length = xDim * yDim * zDim;
+    auto* data = new double[length];
+    for (unsigned int i = 0; i < length; i++)
+      data[i] = 0.5 * i;
+
+    m_Photoacoustic3dVolume = mitk::pa::Volume::New(data, xDim, yDim, zDim, storageType, layout);
+    CPPUNIT_ASSERT(m_Photoacoustic3dVolume->GetStorageType() == storageType);
+    CPPUNIT_ASSERT(m_Photoacoustic3dVolume->GetLayout() == layout);
+
+    for (unsigned int z = 0; z < zDim; z++)
+      for (unsigned int y = 0; y < yDim; y++)
+        for (unsigned int x = 0; x < xDim; x++)
+        {
+          int index = z*xDim*yDim + x*yDim + y;
+          CPPUNIT_ASSERT_MESSAGE(std::to_string(index), m_Photoacoustic3dVolume->GetData(x, y, z) == 0.5 * index);
+        }
+
+    {
+      mitk::Image::Pointer mitkImage = m_Photoacoustic3dVolume->AsMitkImage();
+      mitk::ImageReadAccessor readAccess(mitkImage, mitkImage->GetVolumeData());
+      auto* imageData = (const double*)readAccess.GetData();
+      CPPUNIT_ASSERT(imageData[m_Photoacoustic3dVolume->GetIndex(12, 8, 9)] == 0.5 * (length - 1));
+    }
+
+    // the image view is recreated after a modification
+    m_Photoacoustic3dVolume->SetData(-1, 12, 8, 9);
+    {
+      mitk::Image::Pointer mitkImage = m_Photoacoustic3dVolume->AsMitkImage();
+      mitk::ImageReadAccessor readAccess(mitkImage, mitkImage->GetVolumeData());
+      auto* imageData = (const double*)readAccess.GetData();
+      CPPUNIT_ASSERT(imageData[m_Photoacoustic3dVolume->GetIndex(12, 8, 9)] == -1);
+    }
+
+    mitk::pa::Volume::Pointer copiedVolume = m_Photoacoustic3dVolume->DeepCopy();
+    CPPUNIT_ASSERT(copiedVolume->GetStorageType() == storageType);
+    CPPUNIT_ASSERT(copiedVolume->GetLayout() == layout);
+    CPPUNIT_ASSERT(copiedVolume->GetData(12, 8, 9) == -1);
+    CPPUNIT_ASSERT(copiedVolume->GetData(3, 4, 5) == m_Photoacoustic3dVolume->GetData(3, 4, 5));
+
+    // the raw data pointer requires the default storage
+    double* rawData = m_Photoacoustic3dVolume->GetData();
+    CPPUNIT_ASSERT(m_Photoacoustic3dVolume->GetStorageType() == mitk::pa::Volume::DoubleStorage);
+    CPPUNIT_ASSERT(m_Photoacoustic3dVolume->GetLayout() == mitk::pa::Volume::LinearLayout);
+    CPPUNIT_ASSERT(rawData[m_Photoacoustic3dVolume->GetIndex(3, 4, 5)] == copiedVolume->GetData(3, 4, 5));
+    rawData[0] = 42;
+    CPPUNIT_ASSERT(m_Photoacoustic3dVolume->GetData(0, 0, 0) == 42);
+  }
+
+  void TestCompactStorage()
+  {
+    AssertCompactStorage(mitk::pa::Volume::FloatStorage, mitk::pa::Volume::LinearLayout);
+    AssertCompactStorage(mitk::pa::Volume::DoubleStorage, mitk::pa::Volume::BrickedLayout);
+    AssertCompactStorage(mitk::pa::Volume::FloatStorage, mitk::pa::Volume::BrickedLayout);
+  }
+
   void AssertIndexException(unsigned int x, unsigned int y, unsigned int z)
   {
     bool exceptionCaught = false;
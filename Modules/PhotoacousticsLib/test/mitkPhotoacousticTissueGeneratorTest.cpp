@@ -24,6 +24,7 @@ class mitkPhotoacousticTissueGeneratorTestSuite : public mitk::TestFixture
   CPPUNIT_TEST_SUITE(mitkPhotoacousticTissueGeneratorTestSuite);
   MITK_TEST(testCallWithEmptyParameters);
   MITK_TEST(testCallWithWorkingParameters);
+  MITK_TEST(testParallelRasterizationMatchesSequential);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -75,6 +76,42 @@ public:
     }
   }
 
+  void testParallelRasterizationMatchesSequential()
+  {
+    auto parameters = mitk::pa::TissueGeneratorParameters::New();
+    parameters->SetXDim(30);
+    parameters->SetYDim(30);
+    parameters->SetZDim(30);
+    parameters->SetMinNumberOfVessels(5);
+    parameters->SetMaxNumberOfVessels(5);
+    parameters->SetMinVesselZOrigin(5);
+    parameters->SetMaxVesselZOrigin(25);
+    parameters->SetMinVesselRadiusInMillimeters(10);
+    parameters->SetMaxVesselRadiusInMillimeters(40);
+    parameters->SetMinVesselAbsorption(1);
+    parameters->SetMaxVesselAbsorption(8);
+    parameters->SetUseRngSeed(true);
+    parameters->SetRngSeed(42);
+
+    parameters->SetNumberOfRasterizationThreads(1);
+    auto sequentialVolume = mitk::pa::InSilicoTissueGenerator::GenerateInSilicoData(parameters);
+    parameters->SetNumberOfRasterizationThreads(7);
+    auto parallelVolume = mitk::pa::InSilicoTissueGenerator::GenerateInSilicoData(parameters);
+
+    bool containsVessels = false;
+    for (unsigned int z = 0; z < 30; z++)
+      for (unsigned int y = 0; y < 30; y++)
+        for (unsigned int x = 0; x < 30; x++)
+        {
+          double segmentation = sequentialVolume->GetSegmentationVolume()->GetData(x, y, z);
+          containsVessels |= segmentation == mitk::pa::InSilicoTissueVolume::SegmentationType::VESSEL;
+          CPPUNIT_ASSERT_EQUAL(segmentation, parallelVolume->GetSegmentationVolume()->GetData(x, y, z));
+          CPPUNIT_ASSERT_EQUAL(sequentialVolume->GetAbsorptionVolume()->GetData(x, y, z),
+            parallelVolume->GetAbsorptionVolume()->GetData(x, y, z));
+        }
+    CPPUNIT_ASSERT_MESSAGE("The test volume should contain vessels", containsVessels);
+  }
+
   void tearDown() override
   {
   }
@@ -20,11 +20,15 @@
 #include <mitkPAVolume.h>
 #include <itkFileTools.h>
 
+#include <fstream>
+#include <iterator>
+
 class mitkSimulationBatchGeneratorTestSuite : public mitk::TestFixture
 {
   CPPUNIT_TEST_SUITE(mitkSimulationBatchGeneratorTestSuite);
   MITK_TEST(testGenerateBatchFileString);
   MITK_TEST(testGenerateBatchFileAndSaveFile);
+  MITK_TEST(testGenerateBatchInParallel);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -80,6 +84,42 @@ public:
       && itksys::SystemTools::FileIsDirectory(TEST_FOLDER_PATH + m_Parameters->GetTissueName() + "000"));
   }
 
+  void testGenerateBatchInParallel()
+  {
+    auto tissueParameters = mitk::pa::TissueGeneratorParameters::New();
+    tissueParameters->SetXDim(10);
+    tissueParameters->SetYDim(10);
+    tissueParameters->SetZDim(10);
+    tissueParameters->SetMinNumberOfVessels(1);
+    tissueParameters->SetMaxNumberOfVessels(2);
+    tissueParameters->SetUseRngSeed(true);
+    m_Parameters->SetVolumeIndex(3);
+
+    mitk::pa::SimulationBatchGenerator::GenerateBatch(tissueParameters, m_Parameters, 6, 3, 1);
+
+    for (unsigned int volumeIndex = 3; volumeIndex < 9; ++volumeIndex)
+    {
+      std::string volumeName = m_Parameters->GetTissueName() + "00" + std::to_string(volumeIndex);
+      CPPUNIT_ASSERT(itksys::SystemTools::FileExists(TEST_FOLDER_PATH + volumeName + ".nrrd"));
+      CPPUNIT_ASSERT(itksys::SystemTools::FileIsDirectory(TEST_FOLDER_PATH + volumeName));
+    }
+
+    // the batch file lists the volumes in the order of their indices
+    std::ifstream batchFile(TEST_FOLDER_PATH + "simulate_all.sh");
+    if (!batchFile.is_open())
+      batchFile.open(TEST_FOLDER_PATH + "simulate_all.bat");
+    CPPUNIT_ASSERT(batchFile.is_open());
+    std::string batchFileContent((std::istreambuf_iterator<char>(batchFile)), std::istreambuf_iterator<char>());
+    size_t lastPosition = 0;
+    for (unsigned int volumeIndex = 3; volumeIndex < 9; ++volumeIndex)
+    {
+      size_t position = batchFileContent.find("-i " + m_Parameters->GetTissueName() + "00" + std::to_string(volumeIndex) + ".nrrd");
+      CPPUNIT_ASSERT(position != std::string::npos);
+      CPPUNIT_ASSERT(position >= lastPosition);
+      lastPosition = position;
+    }
+  }
+
   void tearDown() override
   {
     m_Parameters = nullptr;
@@ -28,6 +28,7 @@ set(CPP_FILES
   IO/mitkPlanarFigureSubclassesSerializer.cpp
   Interactions/mitkPlanarFigureInteractor.cpp
   Rendering/mitkPlanarFigureMapper2D.cpp
+  Rendering/mitkPlanarFigureRenderBatch.cpp
   Rendering/mitkPlanarFigureVtkMapper3D.cpp
 )
 
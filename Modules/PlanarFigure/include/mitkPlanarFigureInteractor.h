@@ -69,6 +69,13 @@ namespace mitk
     /** \brief Sets the minimal distance between two control points. */
     void SetMinimumPointDistance(ScalarType minimumDistance);
 
+    /** \brief Returns the bounds of the figure while it waits for the cursor to hover above it.
+     *
+     * In all other states (placing, hovering, dragging) mouse moves are needed regardless of the position.
+     */
+    bool GetMouseMoveBounds(const InteractionPositionEvent *positionEvent,
+                            BoundingBox::BoundsArrayType &bounds) const override;
+
   protected:
     PlanarFigureInteractor();
     ~PlanarFigureInteractor() override;
@@ -197,6 +204,10 @@ namespace mitk
 
     bool m_LastPointWasValid;
 
+    /** \brief World bounds of control points and polylines, valid for the figure and geometry state at m_MouseMoveBoundsMTime. */
+    mutable BoundingBox::BoundsArrayType m_MouseMoveBounds;
+    mutable itk::ModifiedTimeType m_MouseMoveBoundsMTime;
+
     // mitk::PlanarFigure::Pointer m_PlanarFigure;
   };
 }
@@ -18,19 +18,23 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define MITK_PLANAR_FIGURE_MAPPER_2D_H_
 
 #include "mitkCommon.h"
+#include "mitkLocalStorageHandler.h"
 #include "mitkMapper.h"
 #include "mitkPlanarFigure.h"
 #include "mitkPlanarFigureControlPointStyleProperty.h"
 #include <MitkPlanarFigureExports.h>
-#include "vtkNew.h"
+#include "vtkSmartPointer.h"
 #include "vtkPen.h"
 
+#include <vector>
+
 class vtkContext2D;
 
 namespace mitk
 {
   class BaseRenderer;
   class Contour;
+  class PlanarFigureRenderBatch;
 
   /**
   * \brief OpenGL-based mapper to render display sub-class instances of mitk::PlanarFigure
@@ -106,6 +110,11 @@ namespace mitk
   *   </ul>
   * </ol>
   *
+  * The figures of a renderer are not drawn one by one: every mapper registers its visible figure in the
+  * opaque pass and the figures on the current slice are drawn together in the overlay pass by a
+  * PlanarFigureRenderBatch. The lines of a figure are kept in display coordinates per renderer and
+  * generated again only if the figure, its properties or the view changed.
+  *
   * @ingroup MitkPlanarFigureModule
   */
 
@@ -138,33 +147,119 @@ namespace mitk
       PF_COUNT = 3 // helper variable
     };
 
+    /** \brief Passes of the lines and markers of all figures, drawn in this order. */
+    enum PlanarFigureRenderPass
+    {
+      PF_OUTLINE_PASS = 0,
+      PF_SHADOW_PASS = 1,
+      PF_LINE_PASS = 2,
+      PF_MARKER_OUTLINE_PASS = 3,
+      PF_MARKER_PASS = 4,
+
+      PF_PASS_COUNT = 5 // helper variable
+    };
+
+    /**
+    * \brief Lines of one style in display coordinates.
+    *
+    * Solid lines are stored as separate segments (two points each), so that they can be merged with
+    * the lines of other figures. Dashed lines keep their polylines (PolyLineSizes holds the number of
+    * points of each), otherwise the dash pattern would restart at every vertex.
+    */
+    struct StyledLines
+    {
+      float Color[4];
+      float Width;
+      int LineType;
+      std::vector<float> Points;
+      std::vector<int> PolyLineSizes;
+    };
+
+    /** \brief Filled square of a control point, drawn before the lines of its pass. */
+    struct Marker
+    {
+      float Position[2];
+      float Color[4];
+      float Width;
+    };
+
+    /** \brief Everything the display geometry of a figure depends on, it is reused as long as this is equal. */
+    struct GeometryKey
+    {
+      unsigned long FigureMTime;
+      unsigned long FigurePlaneMTime;
+      unsigned long WorldPlaneUpdateTime;
+      unsigned long CameraMTime;
+      unsigned long PropertiesGeneration;
+      int ViewportSize[2];
+      int SelectedControlPoint;
+      bool PreviewControlPointVisible;
+      Point2D PreviewControlPoint;
+      bool HasDataInteractor;
+
+      bool operator==(const GeometryKey &other) const;
+    };
+
+    /** \brief Display geometry of the figure for one renderer. */
+    class LocalStorage : public Mapper::BaseLocalStorage
+    {
+    public:
+      std::vector<StyledLines> m_Lines[PF_PASS_COUNT];
+      std::vector<Marker> m_Markers[PF_PASS_COUNT];
+
+      // right most point of the last painted polyline, the annotations are placed next to it
+      Point2D m_AnchorPoint;
+      PlanarFigureDisplayMode m_LineDisplayMode;
+
+      GeometryKey m_GeometryKey;
+      bool m_GeometryGenerated;
+
+      LocalStorage();
+      ~LocalStorage() override;
+
+      void Clear();
+    };
+
     PlanarFigureMapper2D();
 
     ~PlanarFigureMapper2D() override;
 
     /**
-    * \brief Renders all the lines defined by the PlanarFigure.
+    * \brief Returns the display geometry of the figure for the renderer, or nullptr if the
+    * figure is not on the renderer plane.
     *
-    * This method renders all the lines that are defined by the PlanarFigure.
-    * That includes the mainlines and helperlines as well as their shadows
-    * and the outlines.
+    * Called by the PlanarFigureRenderBatch in the overlay pass. The geometry is generated only
+    * if the GeometryKey of the figure changed since the last call.
+    */
+    LocalStorage *UpdateBatchGeometry(mitk::BaseRenderer *renderer, const mitk::PlaneGeometry *rendererPlaneGeometry);
+
+    /**
+    * \brief Renders name and quantities of the figure, called by the PlanarFigureRenderBatch
+    * after the lines of all figures.
+    */
+    void RenderBatchAnnotations(mitk::BaseRenderer *renderer, vtkContext2D *context, const LocalStorage *localStorage);
+
+    /**
+    * \brief Generates all the lines defined by the PlanarFigure.
     *
-    * This method already takes responsibility for the setting of the relevant
-    * openGL attributes to reduce unnecessary setting of these attributes.
-    * (e.g. no need to set color twice if it's the same)
+    * This method generates all the lines that are defined by the PlanarFigure.
+    * That includes the mainlines and helperlines as well as their shadows
+    * and the outlines, each in its own PlanarFigureRenderPass.
     */
-    void RenderLines(const PlanarFigureDisplayMode lineDisplayMode,
-                     mitk::PlanarFigure *planarFigure,
-                     mitk::Point2D &anchorPoint,
-                     const mitk::PlaneGeometry *planarFigurePlaneGeometry,
-                     const mitk::PlaneGeometry *rendererPlaneGeometry,
-                     const mitk::BaseRenderer *renderer);
+    void GenerateLines(const PlanarFigureDisplayMode lineDisplayMode,
+                       mitk::PlanarFigure *planarFigure,
+                       LocalStorage *localStorage,
+                       mitk::Point2D &anchorPoint,
+                       const mitk::PlaneGeometry *planarFigurePlaneGeometry,
+                       const mitk::PlaneGeometry *rendererPlaneGeometry,
+                       const mitk::BaseRenderer *renderer);
 
     /**
     * \brief Renders the quantities of the figure below the text annotations.
     */
     void RenderQuantities(const mitk::PlanarFigure *planarFigure,
                           mitk::BaseRenderer *renderer,
+                          vtkContext2D *context,
                           const mitk::Point2D anchorPoint,
                           double &annotationOffset,
                           float globalOpacity,
@@ -174,6 +269,7 @@ namespace mitk
     * \brief Renders the text annotations.
     */
     void RenderAnnotations(mitk::BaseRenderer *renderer,
+                           vtkContext2D *context,
                            const std::string name,
                            const mitk::Point2D anchorPoint,
                            float globalOpacity,
@@ -181,13 +277,14 @@ namespace mitk
                            double &annotationOffset);
 
     /**
-    * \brief Renders the control-points.
+    * \brief Generates the markers of the control-points.
     */
-    void RenderControlPoints(const mitk::PlanarFigure *planarFigure,
-                             const PlanarFigureDisplayMode lineDisplayMode,
-                             const mitk::PlaneGeometry *planarFigurePlaneGeometry,
-                             const mitk::PlaneGeometry *rendererPlaneGeometry,
-                             mitk::BaseRenderer *renderer);
+    void GenerateControlPoints(const mitk::PlanarFigure *planarFigure,
+                               const PlanarFigureDisplayMode lineDisplayMode,
+                               LocalStorage *localStorage,
+                               const mitk::PlaneGeometry *planarFigurePlaneGeometry,
+                               const mitk::PlaneGeometry *rendererPlaneGeometry,
+                               mitk::BaseRenderer *renderer);
 
     void TransformObjectToDisplay(const mitk::Point2D &point2D,
                                   mitk::Point2D &displayPoint,
@@ -195,42 +292,57 @@ namespace mitk
                                   const mitk::PlaneGeometry *,
                                   const mitk::BaseRenderer *renderer);
 
-    void DrawMarker(const mitk::Point2D &point,
-                    float *lineColor,
-                    float lineOpacity,
-                    float *markerColor,
-                    float markerOpacity,
-                    float lineWidth,
-                    PlanarFigureControlPointStyleProperty::Shape shape,
-                    const mitk::PlaneGeometry *objectGeometry,
-                    const mitk::PlaneGeometry *rendererGeometry,
-                    const mitk::BaseRenderer *renderer);
+    void GenerateMarker(const mitk::Point2D &point,
+                        float *lineColor,
+                        float lineOpacity,
+                        float *markerColor,
+                        float markerOpacity,
+                        float lineWidth,
+                        PlanarFigureControlPointStyleProperty::Shape shape,
+                        LocalStorage *localStorage,
+                        PlanarFigureRenderPass pass,
+                        const mitk::PlaneGeometry *objectGeometry,
+                        const mitk::PlaneGeometry *rendererGeometry,
+                        const mitk::BaseRenderer *renderer);
 
     /**
-    * \brief Actually paints the polyline defined by the figure.
+    * \brief Returns the lines of the given style in the pass, they are added if not present yet.
+    */
+    StyledLines &GetStyledLines(LocalStorage *localStorage,
+                                PlanarFigureRenderPass pass,
+                                const float *color,
+                                float opacity,
+                                float width,
+                                bool dashed);
+
+    /**
+    * \brief Actually adds the polyline defined by the figure to the lines.
     */
     void PaintPolyLine(const mitk::PlanarFigure::PolyLineType vertices,
                        bool closed,
+                       StyledLines &lines,
                        Point2D &anchorPoint,
                        const PlaneGeometry *planarFigurePlaneGeometry,
                        const PlaneGeometry *rendererPlaneGeometry,
                        const mitk::BaseRenderer *renderer);
 
     /**
-    * \brief Internally used by RenderLines() to draw the mainlines using
+    * \brief Internally used by GenerateLines() to add the mainlines using
     * PaintPolyLine().
     */
     void DrawMainLines(mitk::PlanarFigure *figure,
+                       StyledLines &lines,
                        Point2D &anchorPoint,
                        const PlaneGeometry *planarFigurePlaneGeometry,
                        const PlaneGeometry *rendererPlaneGeometry,
                        const mitk::BaseRenderer *renderer);
 
     /**
-    * \brief Internally used by RenderLines() to draw the helperlines using
+    * \brief Internally used by GenerateLines() to add the helperlines using
     * PaintPolyLine().
     */
     void DrawHelperLines(mitk::PlanarFigure *figure,
+                         StyledLines &lines,
                          Point2D &anchorPoint,
                          const PlaneGeometry *planarFigurePlaneGeometry,
                          const PlaneGeometry *rendererPlaneGeometry,
@@ -257,9 +369,8 @@ namespace mitk
     */
     void OnNodeModified();
 
-    void Initialize(mitk::BaseRenderer *renderer);
-
   private:
+    friend class PlanarFigureRenderBatch;
 
     bool m_IsSelected;
     bool m_IsHovering;
@@ -309,10 +420,12 @@ namespace mitk
     // Bool flag that indicates if a node modified observer was added
     bool m_NodeModifiedObserverAdded;
 
-    bool m_Initialized;
+    // Incremented whenever the properties are read again, part of the GeometryKey
+    unsigned long m_PropertiesGeneration;
 
-    vtkNew<vtkContext2D> m_Context;
     vtkSmartPointer<vtkPen> m_Pen;
+
+    mitk::LocalStorageHandler<LocalStorage> m_LSH;
   };
 
 } // namespace mitk
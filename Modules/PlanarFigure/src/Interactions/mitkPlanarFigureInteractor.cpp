@@ -30,9 +30,18 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkAbstractTransformGeometry.h"
 #include "mitkPlaneGeometry.h"
+#include "mitkStateMachineState.h"
+
+#include <algorithm>
+#include <cmath>
 
 mitk::PlanarFigureInteractor::PlanarFigureInteractor()
-  : DataInteractor(), m_Precision(6.5), m_MinimumPointDistance(25.0), m_IsHovering(false), m_LastPointWasValid(false)
+  : DataInteractor(),
+    m_Precision(6.5),
+    m_MinimumPointDistance(25.0),
+    m_IsHovering(false),
+    m_LastPointWasValid(false),
+    m_MouseMoveBoundsMTime(0)
 {
 }
 
@@ -686,6 +695,70 @@ bool mitk::PlanarFigureInteractor::CheckFigureOnRenderingGeometry(const Interact
   return true;
 }
 
+bool mitk::PlanarFigureInteractor::GetMouseMoveBounds(const InteractionPositionEvent *positionEvent,
+                                                      BoundingBox::BoundsArrayType &bounds) const
+{
+  // only a placed figure that is not hovered ignores mouse moves away from it
+  if (this->GetCurrentState() == nullptr || this->GetCurrentState()->GetName() != "EditFigure")
+    return false;
+
+  const BaseRenderer *renderer = positionEvent->GetSender();
+  auto *planarFigure = dynamic_cast<mitk::PlanarFigure *>(GetDataNode()->GetData());
+  if (renderer == nullptr || planarFigure == nullptr || planarFigure->GetNumberOfControlPoints() == 0)
+    return false;
+
+  const mitk::PlaneGeometry *planarFigureGeometry = dynamic_cast<PlaneGeometry *>(planarFigure->GetGeometry(0));
+  const mitk::PlaneGeometry *rendererGeometry = renderer->GetCurrentWorldPlaneGeometry();
+  if (planarFigureGeometry == nullptr || rendererGeometry == nullptr ||
+      dynamic_cast<const AbstractTransformGeometry *>(planarFigureGeometry) != nullptr)
+    return false;
+
+  // the hover conditions work on the figure projected into the display, so the world
+  // distance to the cursor is only bounded if the figure is parallel to the rendered plane
+  if (std::abs(planarFigureGeometry->GetNormal() * rendererGeometry->GetNormal()) <
+      0.999 * planarFigureGeometry->GetNormal().GetNorm() * rendererGeometry->GetNormal().GetNorm())
+    return false;
+
+  if (std::max(planarFigure->GetMTime(), planarFigureGeometry->GetMTime()) != m_MouseMoveBoundsMTime)
+  {
+    m_MouseMoveBounds[0] = m_MouseMoveBounds[2] = m_MouseMoveBounds[4] = itk::NumericTraits<ScalarType>::max();
+    m_MouseMoveBounds[1] = m_MouseMoveBounds[3] = m_MouseMoveBounds[5] = itk::NumericTraits<ScalarType>::NonpositiveMin();
+
+    auto includePoint = [this, planarFigureGeometry](const Point2D &point2D) {
+      Point3D point3D;
+      planarFigureGeometry->Map(point2D, point3D);
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        m_MouseMoveBounds[2 * i] = std::min(m_MouseMoveBounds[2 * i], point3D[i]);
+        m_MouseMoveBounds[2 * i + 1] = std::max(m_MouseMoveBounds[2 * i + 1], point3D[i]);
+      }
+    };
+
+    for (unsigned int i = 0; i < planarFigure->GetNumberOfControlPoints(); ++i)
+      includePoint(planarFigure->GetControlPoint(i));
+
+    for (unsigned short loop = 0; loop < planarFigure->GetPolyLinesSize(); ++loop)
+    {
+      const mitk::PlanarFigure::PolyLineType polyLine = planarFigure->GetPolyLine(loop);
+      for (auto it = polyLine.cbegin(); it != polyLine.cend(); ++it)
+        includePoint(*it);
+    }
+
+    m_MouseMoveBoundsMTime = std::max(planarFigure->GetMTime(), planarFigureGeometry->GetMTime());
+  }
+
+  // enlarge by the slice thickness used by CheckFigureOnRenderingGeometry() and by more than
+  // the display distance of about 4.5 pixels used by the hover checks
+  const ScalarType tolerance =
+    std::max(planarFigureGeometry->GetExtentInMM(2), 10.0 * renderer->GetScaleFactorMMPerDisplayUnit());
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    bounds[2 * i] = m_MouseMoveBounds[2 * i] - tolerance;
+    bounds[2 * i + 1] = m_MouseMoveBounds[2 * i + 1] + tolerance;
+  }
+  return true;
+}
+
 void mitk::PlanarFigureInteractor::SetPrecision(mitk::ScalarType precision)
 {
   m_Precision = precision;
@@ -18,9 +18,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkBaseRenderer.h"
 #include "mitkColorProperty.h"
+#include "mitkPlanarFigureRenderBatch.h"
+#include "vtkCamera.h"
 #include "vtkContext2D.h"
-#include "vtkContextDevice2D.h"
-#include "vtkOpenGLContextDevice2D.h"
+#include "vtkRenderer.h"
 #include "mitkPlaneGeometry.h"
 #include "mitkProperties.h"
 #include "vtkTextProperty.h"
@@ -28,15 +29,46 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define _USE_MATH_DEFINES
 #include <cmath>
 
+bool mitk::PlanarFigureMapper2D::GeometryKey::operator==(const GeometryKey &other) const
+{
+  return FigureMTime == other.FigureMTime && FigurePlaneMTime == other.FigurePlaneMTime &&
+         WorldPlaneUpdateTime == other.WorldPlaneUpdateTime && CameraMTime == other.CameraMTime &&
+         PropertiesGeneration == other.PropertiesGeneration && ViewportSize[0] == other.ViewportSize[0] &&
+         ViewportSize[1] == other.ViewportSize[1] && SelectedControlPoint == other.SelectedControlPoint &&
+         PreviewControlPointVisible == other.PreviewControlPointVisible &&
+         PreviewControlPoint == other.PreviewControlPoint && HasDataInteractor == other.HasDataInteractor;
+}
+
+mitk::PlanarFigureMapper2D::LocalStorage::LocalStorage() : m_LineDisplayMode(PF_DEFAULT), m_GeometryGenerated(false)
+{
+  m_AnchorPoint.Fill(0.0);
+}
+
+mitk::PlanarFigureMapper2D::LocalStorage::~LocalStorage()
+{
+}
+
+void mitk::PlanarFigureMapper2D::LocalStorage::Clear()
+{
+  for (unsigned int pass = 0; pass < PF_PASS_COUNT; ++pass)
+  {
+    m_Lines[pass].clear();
+    m_Markers[pass].clear();
+  }
+}
+
 mitk::PlanarFigureMapper2D::PlanarFigureMapper2D()
-  : m_NodeModified(true), m_NodeModifiedObserverTag(0), m_NodeModifiedObserverAdded(false), m_Initialized(false)
+  : m_NodeModified(true), m_NodeModifiedObserverTag(0), m_NodeModifiedObserverAdded(false), m_PropertiesGeneration(0)
 {
+  this->m_Pen = vtkSmartPointer<vtkPen>::New();
 
   this->InitializeDefaultPlanarFigureProperties();
 }
 
 mitk::PlanarFigureMapper2D::~PlanarFigureMapper2D()
 {
+  PlanarFigureRenderBatch::RemoveMapper(this);
+
   if (m_NodeModifiedObserverAdded && GetDataNode() != nullptr)
   {
     GetDataNode()->RemoveObserver(m_NodeModifiedObserverTag);
@@ -54,32 +86,17 @@ void mitk::PlanarFigureMapper2D::ApplyColorAndOpacityProperties(mitk::BaseRender
   this->m_Pen->SetColorF((double)rgba[0], (double)rgba[1], (double)rgba[2], (double)rgba[3]);
 }
 
-void mitk::PlanarFigureMapper2D::Initialize(mitk::BaseRenderer *)
-{
-  this->m_Pen = vtkSmartPointer<vtkPen>::New();
-  vtkOpenGLContextDevice2D *device = nullptr;
-    device = vtkOpenGLContextDevice2D::New();
-  if (device)
-  {
-    this->m_Context->Begin(device);
-    device->Delete();
-    this->m_Initialized = true;
-    this->m_Context->ApplyPen(this->m_Pen);
-  }
-  else
-  {
-  }
-}
-
 void mitk::PlanarFigureMapper2D::MitkRender(mitk::BaseRenderer *renderer, mitk::VtkPropRenderer::RenderType type)
 {
-  if (type != mitk::VtkPropRenderer::Overlay) return;
-  if (!this->m_Initialized)
+  if (type == mitk::VtkPropRenderer::Overlay)
   {
-    this->Initialize(renderer);
+    // the first mapper of the frame draws the figures of all mappers
+    PlanarFigureRenderBatch::GetInstance(renderer)->Render(renderer);
+    return;
   }
-  vtkOpenGLContextDevice2D::SafeDownCast(
-    this->m_Context->GetDevice())->Begin(renderer->GetVtkRenderer());
+
+  if (type != mitk::VtkPropRenderer::Opaque)
+    return;
 
   bool visible = true;
 
@@ -88,8 +105,7 @@ void mitk::PlanarFigureMapper2D::MitkRender(mitk::BaseRenderer *renderer, mitk::
     return;
 
   // Get PlanarFigure from input
-  auto *planarFigure =
-    const_cast<mitk::PlanarFigure *>(static_cast<const mitk::PlanarFigure *>(GetDataNode()->GetData()));
+  auto *planarFigure = static_cast<const mitk::PlanarFigure *>(GetDataNode()->GetData());
 
   // Check if PlanarFigure has already been placed; otherwise, do nothing
   if (!planarFigure->IsPlaced())
@@ -98,15 +114,23 @@ void mitk::PlanarFigureMapper2D::MitkRender(mitk::BaseRenderer *renderer, mitk::
   }
 
   // Get 2D geometry frame of PlanarFigure
-  const mitk::PlaneGeometry *planarFigurePlaneGeometry = planarFigure->GetPlaneGeometry();
-  if (planarFigurePlaneGeometry == nullptr)
+  if (planarFigure->GetPlaneGeometry() == nullptr)
   {
     MITK_ERROR << "PlanarFigure does not have valid PlaneGeometry!";
     return;
   }
 
-  // Get current world 2D geometry from renderer
-  const mitk::PlaneGeometry *rendererPlaneGeometry = renderer->GetCurrentWorldPlaneGeometry();
+  PlanarFigureRenderBatch::GetInstance(renderer)->Collect(this, planarFigure);
+}
+
+mitk::PlanarFigureMapper2D::LocalStorage *mitk::PlanarFigureMapper2D::UpdateBatchGeometry(
+  mitk::BaseRenderer *renderer, const mitk::PlaneGeometry *rendererPlaneGeometry)
+{
+  auto *planarFigure =
+    const_cast<mitk::PlanarFigure *>(static_cast<const mitk::PlanarFigure *>(GetDataNode()->GetData()));
+
+  // Get 2D geometry frame of PlanarFigure
+  const mitk::PlaneGeometry *planarFigurePlaneGeometry = planarFigure->GetPlaneGeometry();
 
   // If the PlanarFigure geometry is a plane geometry, check if current
   // world plane is parallel to and within the planar figure geometry bounds
@@ -120,22 +144,42 @@ void mitk::PlanarFigureMapper2D::MitkRender(mitk::BaseRenderer *renderer, mitk::
     {
       // Planes are not parallel or renderer plane is not within PlanarFigure
       // geometry bounds --> exit
-      return;
+      return nullptr;
     }
   }
   else
   {
     // Plane is not valid (curved reformations are not possible yet)
-    return;
+    return nullptr;
   }
 
-  // Apply visual appearance properties from the PropertyList
-  ApplyColorAndOpacityProperties(renderer);
-
   // Get properties from node (if present)
   const mitk::DataNode *node = this->GetDataNode();
   this->InitializePlanarFigurePropertiesFromDataNode(node);
 
+  GeometryKey key;
+  key.FigureMTime = planarFigure->GetMTime();
+  key.FigurePlaneMTime = planarFigurePlaneGeometry->GetMTime();
+  key.WorldPlaneUpdateTime = renderer->GetCurrentWorldPlaneGeometryUpdateTime();
+  key.CameraMTime = renderer->GetVtkRenderer()->GetActiveCamera()->GetMTime();
+  key.PropertiesGeneration = m_PropertiesGeneration;
+  key.ViewportSize[0] = renderer->GetViewportSize()[0];
+  key.ViewportSize[1] = renderer->GetViewportSize()[1];
+  key.SelectedControlPoint = planarFigure->GetSelectedControlPoint();
+  key.PreviewControlPointVisible = planarFigure->IsPreviewControlPointVisible();
+  key.PreviewControlPoint = planarFigure->GetPreviewControlPoint();
+  key.HasDataInteractor = node->GetDataInteractor().IsNotNull();
+
+  LocalStorage *localStorage = m_LSH.GetLocalStorage(renderer);
+  if (localStorage->m_GeometryGenerated && localStorage->m_GeometryKey == key)
+  {
+    return localStorage;
+  }
+
+  localStorage->Clear();
+  localStorage->m_GeometryKey = key;
+  localStorage->m_GeometryGenerated = true;
+
   PlanarFigureDisplayMode lineDisplayMode = PF_DEFAULT;
 
   if (m_IsSelected)
@@ -146,13 +190,33 @@ void mitk::PlanarFigureMapper2D::MitkRender(mitk::BaseRenderer *renderer, mitk::
   {
     lineDisplayMode = PF_HOVER;
   }
+  localStorage->m_LineDisplayMode = lineDisplayMode;
 
   mitk::Point2D anchorPoint;
   anchorPoint[0] = 0;
   anchorPoint[1] = 1;
 
-  // render the actual lines of the PlanarFigure
-  RenderLines(lineDisplayMode, planarFigure, anchorPoint, planarFigurePlaneGeometry, rendererPlaneGeometry, renderer);
+  // generate the actual lines of the PlanarFigure
+  GenerateLines(lineDisplayMode, planarFigure, localStorage, anchorPoint, planarFigurePlaneGeometry,
+                rendererPlaneGeometry, renderer);
+  localStorage->m_AnchorPoint = anchorPoint;
+
+  if (m_DrawControlPoints)
+  {
+    // generate the control-points
+    GenerateControlPoints(
+      planarFigure, lineDisplayMode, localStorage, planarFigurePlaneGeometry, rendererPlaneGeometry, renderer);
+  }
+
+  return localStorage;
+}
+
+void mitk::PlanarFigureMapper2D::RenderBatchAnnotations(mitk::BaseRenderer *renderer,
+                                                        vtkContext2D *context,
+                                                        const LocalStorage *localStorage)
+{
+  const mitk::DataNode *node = this->GetDataNode();
+  const auto *planarFigure = static_cast<const mitk::PlanarFigure *>(node->GetData());
 
   // position-offset of the annotations, is set in RenderAnnotations() and
   // used in RenderQuantities()
@@ -162,31 +226,62 @@ void mitk::PlanarFigureMapper2D::MitkRender(mitk::BaseRenderer *renderer, mitk::
   float globalOpacity = 1.0;
   node->GetFloatProperty("opacity", globalOpacity);
 
-  if (m_DrawControlPoints)
-  {
-    // draw the control-points
-    RenderControlPoints(planarFigure, lineDisplayMode, planarFigurePlaneGeometry, rendererPlaneGeometry, renderer);
-  }
-
   // draw name near the anchor point (point located on the right)
   const std::string name = node->GetName();
   if (m_DrawName && !name.empty())
   {
-    RenderAnnotations(renderer, name, anchorPoint, globalOpacity, lineDisplayMode, annotationOffset);
+    RenderAnnotations(renderer,
+                      context,
+                      name,
+                      localStorage->m_AnchorPoint,
+                      globalOpacity,
+                      localStorage->m_LineDisplayMode,
+                      annotationOffset);
   }
 
   // draw feature quantities (if requested) next to the anchor point,
   // but under the name (that is where 'annotationOffset' is used)
   if (m_DrawQuantities)
   {
-    RenderQuantities(planarFigure, renderer, anchorPoint, annotationOffset, globalOpacity, lineDisplayMode);
+    RenderQuantities(planarFigure,
+                     renderer,
+                     context,
+                     localStorage->m_AnchorPoint,
+                     annotationOffset,
+                     globalOpacity,
+                     localStorage->m_LineDisplayMode);
+  }
+}
+
+mitk::PlanarFigureMapper2D::StyledLines &mitk::PlanarFigureMapper2D::GetStyledLines(
+  LocalStorage *localStorage, PlanarFigureRenderPass pass, const float *color, float opacity, float width, bool dashed)
+{
+  const int lineType = dashed ? vtkPen::DASH_LINE : vtkPen::SOLID_LINE;
+
+  for (auto &lines : localStorage->m_Lines[pass])
+  {
+    if (lines.Color[0] == color[0] && lines.Color[1] == color[1] && lines.Color[2] == color[2] &&
+        lines.Color[3] == opacity && lines.Width == width && lines.LineType == lineType)
+    {
+      return lines;
+    }
   }
 
-  this->m_Context->GetDevice()->End();
+  StyledLines lines;
+  lines.Color[0] = color[0];
+  lines.Color[1] = color[1];
+  lines.Color[2] = color[2];
+  lines.Color[3] = opacity;
+  lines.Width = width;
+  lines.LineType = lineType;
+  localStorage->m_Lines[pass].push_back(lines);
+
+  return localStorage->m_Lines[pass].back();
 }
 
 void mitk::PlanarFigureMapper2D::PaintPolyLine(const mitk::PlanarFigure::PolyLineType vertices,
                                                bool closed,
+                                               StyledLines &lines,
                                                Point2D &anchorPoint,
                                                const PlaneGeometry *planarFigurePlaneGeometry,
                                                const PlaneGeometry *rendererPlaneGeometry,
@@ -221,22 +316,35 @@ void mitk::PlanarFigureMapper2D::PaintPolyLine(const mitk::PlanarFigure::PolyLin
     pointlist.push_back(displayPoint);
   }
 
-  // now paint all the points in one run
+  anchorPoint = rightMostPoint;
 
-  auto* points = new float[pointlist.size()*2];
-  for (unsigned int i = 0 ; i < pointlist.size() ; ++i)
+  if (pointlist.size() < 2)
+    return;
+
+  if (lines.LineType == vtkPen::SOLID_LINE)
   {
-    points[i * 2] = pointlist[i][0];
-    points[i * 2 + 1] = pointlist[i][1];
+    // separate segments, so that the lines of all figures can be drawn in one run
+    for (unsigned int i = 1; i < pointlist.size(); ++i)
+    {
+      lines.Points.push_back(pointlist[i - 1][0]);
+      lines.Points.push_back(pointlist[i - 1][1]);
+      lines.Points.push_back(pointlist[i][0]);
+      lines.Points.push_back(pointlist[i][1]);
+    }
+  }
+  else
+  {
+    for (const auto &point : pointlist)
+    {
+      lines.Points.push_back(point[0]);
+      lines.Points.push_back(point[1]);
+    }
+    lines.PolyLineSizes.push_back(static_cast<int>(pointlist.size()));
   }
-
-  if (2 <= pointlist.size())
-    m_Context->DrawPoly(points,pointlist.size());
-
-  anchorPoint = rightMostPoint;
 }
 
 void mitk::PlanarFigureMapper2D::DrawMainLines(mitk::PlanarFigure *figure,
+                                               StyledLines &lines,
                                                Point2D &anchorPoint,
                                                const PlaneGeometry *planarFigurePlaneGeometry,
                                                const PlaneGeometry *rendererPlaneGeometry,
@@ -248,11 +356,12 @@ void mitk::PlanarFigureMapper2D::DrawMainLines(mitk::PlanarFigure *figure,
     const auto polyline = figure->GetPolyLine(loop);
 
     this->PaintPolyLine(
-      polyline, figure->IsClosed(), anchorPoint, planarFigurePlaneGeometry, rendererPlaneGeometry, renderer);
+      polyline, figure->IsClosed(), lines, anchorPoint, planarFigurePlaneGeometry, rendererPlaneGeometry, renderer);
   }
 }
 
 void mitk::PlanarFigureMapper2D::DrawHelperLines(mitk::PlanarFigure *figure,
+                                                 StyledLines &lines,
                                                  Point2D &anchorPoint,
                                                  const PlaneGeometry *planarFigurePlaneGeometry,
                                                  const PlaneGeometry *rendererPlaneGeometry,
@@ -273,7 +382,8 @@ void mitk::PlanarFigureMapper2D::DrawHelperLines(mitk::PlanarFigure *figure,
     }
 
     // ... and once normally above the shadow.
-    this->PaintPolyLine(helperPolyLine, false, anchorPoint, planarFigurePlaneGeometry, rendererPlaneGeometry, renderer);
+    this->PaintPolyLine(
+      helperPolyLine, false, lines, anchorPoint, planarFigurePlaneGeometry, rendererPlaneGeometry, renderer);
   }
 }
 
@@ -292,16 +402,18 @@ void mitk::PlanarFigureMapper2D::TransformObjectToDisplay(const mitk::Point2D &p
   renderer->WorldToView(point3D, displayPoint);
 }
 
-void mitk::PlanarFigureMapper2D::DrawMarker(const mitk::Point2D &point,
-                                            float *lineColor,
-                                            float lineOpacity,
-                                            float *markerColor,
-                                            float markerOpacity,
-                                            float lineWidth,
-                                            PlanarFigureControlPointStyleProperty::Shape shape,
-                                            const mitk::PlaneGeometry *objectGeometry,
-                                            const mitk::PlaneGeometry *rendererGeometry,
-                                            const mitk::BaseRenderer *renderer)
+void mitk::PlanarFigureMapper2D::GenerateMarker(const mitk::Point2D &point,
+                                                float *lineColor,
+                                                float lineOpacity,
+                                                float *markerColor,
+                                                float markerOpacity,
+                                                float lineWidth,
+                                                PlanarFigureControlPointStyleProperty::Shape shape,
+                                                LocalStorage *localStorage,
+                                                PlanarFigureRenderPass pass,
+                                                const mitk::PlaneGeometry *objectGeometry,
+                                                const mitk::PlaneGeometry *rendererGeometry,
+                                                const mitk::BaseRenderer *renderer)
 {
   if (this->GetDataNode() != nullptr && this->GetDataNode()->GetDataInteractor().IsNull())
     return;
@@ -313,9 +425,6 @@ void mitk::PlanarFigureMapper2D::DrawMarker(const mitk::Point2D &point,
 
   this->TransformObjectToDisplay(point, displayPoint, objectGeometry, rendererGeometry, renderer);
 
-  this->m_Context->GetPen()->SetColorF((double)markerColor[0], (double)markerColor[1], (double)markerColor[2], markerOpacity);
-  this->m_Context->GetPen()->SetWidth(lineWidth);
-
   switch (shape)
   {
     case PlanarFigureControlPointStyleProperty::Square:
@@ -325,23 +434,33 @@ void mitk::PlanarFigureMapper2D::DrawMarker(const mitk::Point2D &point,
 
       if (markerOpacity > 0)
       {
-        m_Context->DrawRect(displayPoint[0] - 4, displayPoint[1] - 4, 8, 8);
+        Marker marker;
+        marker.Position[0] = displayPoint[0];
+        marker.Position[1] = displayPoint[1];
+        marker.Color[0] = markerColor[0];
+        marker.Color[1] = markerColor[1];
+        marker.Color[2] = markerColor[2];
+        marker.Color[3] = markerOpacity;
+        marker.Width = lineWidth;
+        localStorage->m_Markers[pass].push_back(marker);
       }
 
       // Paint outline
-      this->m_Context->GetPen()->SetColorF((double)lineColor[0], (double)lineColor[1], (double)lineColor[2], (double)lineOpacity);
-
-      auto* outline = new float[8];
-      outline[0] = displayPoint[0] - 4;
-      outline[1] = displayPoint[1] - 4;
-      outline[2] = outline[0];
-      outline[3] = displayPoint[1] + 4;
-      outline[4] = displayPoint[0] + 4;
-      outline[5] = outline[3];
-      outline[6] = outline[4];
-      outline[7] = outline[1];
-
-      m_Context->DrawLines(outline, 4);
+      StyledLines &outline = this->GetStyledLines(localStorage, pass, lineColor, lineOpacity, lineWidth, false);
+
+      const float left = displayPoint[0] - 4;
+      const float right = displayPoint[0] + 4;
+      const float bottom = displayPoint[1] - 4;
+      const float top = displayPoint[1] + 4;
+
+      outline.Points.push_back(left);
+      outline.Points.push_back(bottom);
+      outline.Points.push_back(left);
+      outline.Points.push_back(top);
+      outline.Points.push_back(right);
+      outline.Points.push_back(top);
+      outline.Points.push_back(right);
+      outline.Points.push_back(bottom);
       break;
     }
 
@@ -466,6 +585,7 @@ void mitk::PlanarFigureMapper2D::InitializePlanarFigurePropertiesFromDataNode(co
 
   // Mark the current properties as unmodified
   m_NodeModified = false;
+  ++m_PropertiesGeneration;
 
   // Get Global Opacity
   float globalOpacity = 1.0;
@@ -648,11 +768,12 @@ void mitk::PlanarFigureMapper2D::SetDefaultProperties(mitk::DataNode *node,
   node->AddProperty("planarfigure.selected.marker.opacity", mitk::FloatProperty::New(1.0));
 }
 
-void mitk::PlanarFigureMapper2D::RenderControlPoints(const mitk::PlanarFigure *planarFigure,
-                                                     const PlanarFigureDisplayMode lineDisplayMode,
-                                                     const mitk::PlaneGeometry *planarFigurePlaneGeometry,
-                                                     const mitk::PlaneGeometry *rendererPlaneGeometry,
-                                                     mitk::BaseRenderer *renderer)
+void mitk::PlanarFigureMapper2D::GenerateControlPoints(const mitk::PlanarFigure *planarFigure,
+                                                       const PlanarFigureDisplayMode lineDisplayMode,
+                                                       LocalStorage *localStorage,
+                                                       const mitk::PlaneGeometry *planarFigurePlaneGeometry,
+                                                       const mitk::PlaneGeometry *rendererPlaneGeometry,
+                                                       mitk::BaseRenderer *renderer)
 {
   bool isEditable = true;
   m_DataNode->GetBoolProperty("planarfigure.iseditable", isEditable);
@@ -688,46 +809,53 @@ void mitk::PlanarFigureMapper2D::RenderControlPoints(const mitk::PlanarFigure *p
       // draw outlines for markers as well
       // linewidth for the contour is only half, as full width looks
       // much too thick!
-      this->DrawMarker(planarFigure->GetControlPoint(i),
-                       m_OutlineColor[lineDisplayMode],
-                       m_MarkerlineOpacity[pointDisplayMode],
-                       m_OutlineColor[lineDisplayMode],
-                       m_MarkerOpacity[pointDisplayMode],
-                       m_OutlineWidth / 2,
-                       m_ControlPointShape,
-                       planarFigurePlaneGeometry,
-                       rendererPlaneGeometry,
-                       renderer);
+      this->GenerateMarker(planarFigure->GetControlPoint(i),
+                           m_OutlineColor[lineDisplayMode],
+                           m_MarkerlineOpacity[pointDisplayMode],
+                           m_OutlineColor[lineDisplayMode],
+                           m_MarkerOpacity[pointDisplayMode],
+                           m_OutlineWidth / 2,
+                           m_ControlPointShape,
+                           localStorage,
+                           PF_MARKER_OUTLINE_PASS,
+                           planarFigurePlaneGeometry,
+                           rendererPlaneGeometry,
+                           renderer);
     }
 
-    this->DrawMarker(planarFigure->GetControlPoint(i),
-                     m_MarkerlineColor[pointDisplayMode],
-                     m_MarkerlineOpacity[pointDisplayMode],
-                     m_MarkerColor[pointDisplayMode],
-                     m_MarkerOpacity[pointDisplayMode],
-                     m_LineWidth,
-                     m_ControlPointShape,
-                     planarFigurePlaneGeometry,
-                     rendererPlaneGeometry,
-                     renderer);
+    this->GenerateMarker(planarFigure->GetControlPoint(i),
+                         m_MarkerlineColor[pointDisplayMode],
+                         m_MarkerlineOpacity[pointDisplayMode],
+                         m_MarkerColor[pointDisplayMode],
+                         m_MarkerOpacity[pointDisplayMode],
+                         m_LineWidth,
+                         m_ControlPointShape,
+                         localStorage,
+                         PF_MARKER_PASS,
+                         planarFigurePlaneGeometry,
+                         rendererPlaneGeometry,
+                         renderer);
   }
 
   if (planarFigure->IsPreviewControlPointVisible())
   {
-    this->DrawMarker(planarFigure->GetPreviewControlPoint(),
-                     m_MarkerlineColor[PF_HOVER],
-                     m_MarkerlineOpacity[PF_HOVER],
-                     m_MarkerColor[PF_HOVER],
-                     m_MarkerOpacity[PF_HOVER],
-                     m_LineWidth,
-                     m_ControlPointShape,
-                     planarFigurePlaneGeometry,
-                     rendererPlaneGeometry,
-                     renderer);
+    this->GenerateMarker(planarFigure->GetPreviewControlPoint(),
+                         m_MarkerlineColor[PF_HOVER],
+                         m_MarkerlineOpacity[PF_HOVER],
+                         m_MarkerColor[PF_HOVER],
+                         m_MarkerOpacity[PF_HOVER],
+                         m_LineWidth,
+                         m_ControlPointShape,
+                         localStorage,
+                         PF_MARKER_PASS,
+                         planarFigurePlaneGeometry,
+                         rendererPlaneGeometry,
+                         renderer);
   }
 }
 
 void mitk::PlanarFigureMapper2D::RenderAnnotations(mitk::BaseRenderer *,
+                                                   vtkContext2D *context,
                                                    const std::string name,
                                                    const mitk::Point2D anchorPoint,
                                                    float globalOpacity,
@@ -762,14 +890,14 @@ void mitk::PlanarFigureMapper2D::RenderAnnotations(mitk::BaseRenderer *,
   if(m_DrawShadow)
   {
     textProp->SetColor(0.0,0.0,0.0);
-    this->m_Context->ApplyTextProp(textProp);
-    this->m_Context->DrawString(scaledAnchorPoint[0]+offset[0]+1, scaledAnchorPoint[1]+offset[1]-1, name.c_str());
+    context->ApplyTextProp(textProp);
+    context->DrawString(scaledAnchorPoint[0]+offset[0]+1, scaledAnchorPoint[1]+offset[1]-1, name.c_str());
   }
   textProp->SetColor(m_AnnotationColor[lineDisplayMode][0],
           m_AnnotationColor[lineDisplayMode][1],
           m_AnnotationColor[lineDisplayMode][2]);
-  this->m_Context->ApplyTextProp(textProp);
-  this->m_Context->DrawString(scaledAnchorPoint[0]+offset[0], scaledAnchorPoint[1]+offset[1], name.c_str());
+  context->ApplyTextProp(textProp);
+  context->DrawString(scaledAnchorPoint[0]+offset[0], scaledAnchorPoint[1]+offset[1], name.c_str());
 
   annotationOffset -= 15.0;
   //  annotationOffset -= m_AnnotationAnnotation->GetBoundsOnDisplay( renderer ).Size[1];
@@ -778,6 +906,7 @@ void mitk::PlanarFigureMapper2D::RenderAnnotations(mitk::BaseRenderer *,
 
 void mitk::PlanarFigureMapper2D::RenderQuantities(const mitk::PlanarFigure *planarFigure,
                                                   mitk::BaseRenderer *,
+                                                  vtkContext2D *context,
                                                   const mitk::Point2D anchorPoint,
                                                   double &annotationOffset,
                                                   float globalOpacity,
@@ -830,26 +959,27 @@ void mitk::PlanarFigureMapper2D::RenderQuantities(const mitk::PlanarFigure *plan
   if(m_DrawShadow)
   {
     textProp->SetColor(0,0,0);
-    this->m_Context->ApplyTextProp(textProp);
-    this->m_Context->DrawString(scaledAnchorPoint[0]+offset[0]+1, scaledAnchorPoint[1]+offset[1]-1, quantityString.str().c_str());
+    context->ApplyTextProp(textProp);
+    context->DrawString(scaledAnchorPoint[0]+offset[0]+1, scaledAnchorPoint[1]+offset[1]-1, quantityString.str().c_str());
   }
   textProp->SetColor(m_AnnotationColor[lineDisplayMode][0],
           m_AnnotationColor[lineDisplayMode][1],
           m_AnnotationColor[lineDisplayMode][2]);
-  this->m_Context->ApplyTextProp(textProp);
-  this->m_Context->DrawString(scaledAnchorPoint[0]+offset[0], scaledAnchorPoint[1]+offset[1], quantityString.str().c_str());
+  context->ApplyTextProp(textProp);
+  context->DrawString(scaledAnchorPoint[0]+offset[0], scaledAnchorPoint[1]+offset[1], quantityString.str().c_str());
 
   annotationOffset -= 15.0;
   //  annotationOffset -= m_AnnotationAnnotation->GetBoundsOnDisplay( renderer ).Size[1];
   textProp->Delete();
 }
 
-void mitk::PlanarFigureMapper2D::RenderLines(const PlanarFigureDisplayMode lineDisplayMode,
-                                             mitk::PlanarFigure *planarFigure,
-                                             mitk::Point2D &anchorPoint,
-                                             const mitk::PlaneGeometry *planarFigurePlaneGeometry,
-                                             const mitk::PlaneGeometry *rendererPlaneGeometry,
-                                             const mitk::BaseRenderer *renderer)
+void mitk::PlanarFigureMapper2D::GenerateLines(const PlanarFigureDisplayMode lineDisplayMode,
+                                               mitk::PlanarFigure *planarFigure,
+                                               LocalStorage *localStorage,
+                                               mitk::Point2D &anchorPoint,
+                                               const mitk::PlaneGeometry *planarFigurePlaneGeometry,
+                                               const mitk::PlaneGeometry *rendererPlaneGeometry,
+                                               const mitk::BaseRenderer *renderer)
 {
   // If we want to draw an outline, we do it here
   if (m_DrawOutline)
@@ -857,38 +987,16 @@ void mitk::PlanarFigureMapper2D::RenderLines(const PlanarFigureDisplayMode lineD
     const float *color = m_OutlineColor[lineDisplayMode];
     const float opacity = m_OutlineOpacity[lineDisplayMode];
 
-    // convert to a float array that also contains opacity, faster GL
-    auto *colorVector = new float[4];
-    colorVector[0] = color[0];
-    colorVector[1] = color[1];
-    colorVector[2] = color[2];
-    colorVector[3] = opacity;
-
-    // set the color and opacity here as it is common for all outlines
-
-    this->m_Context->GetPen()->SetColorF((double)color[0], (double)color[1], (double)color[2], opacity);
-    this->m_Context->GetPen()->SetWidth(m_OutlineWidth);
-
-    if (m_DrawDashed)
-      this->m_Context->GetPen()->SetLineType(vtkPen::DASH_LINE);
-    else
-      this->m_Context->GetPen()->SetLineType(vtkPen::SOLID_LINE);
-
     // Draw the outline for all polylines if requested
-    this->DrawMainLines(planarFigure, anchorPoint, planarFigurePlaneGeometry, rendererPlaneGeometry, renderer);
-
-    this->m_Context->GetPen()->SetWidth(m_HelperlineWidth);
-
-    if (m_DrawHelperDashed)
-      this->m_Context->GetPen()->SetLineType(vtkPen::DASH_LINE);
-    else
-      this->m_Context->GetPen()->SetLineType(vtkPen::SOLID_LINE);
+    StyledLines &outline =
+      this->GetStyledLines(localStorage, PF_OUTLINE_PASS, color, opacity, m_OutlineWidth, m_DrawDashed);
+    this->DrawMainLines(planarFigure, outline, anchorPoint, planarFigurePlaneGeometry, rendererPlaneGeometry, renderer);
 
     // Draw the outline for all helper objects if requested
-    this->DrawHelperLines(planarFigure, anchorPoint, planarFigurePlaneGeometry, rendererPlaneGeometry, renderer);
-
-    // cleanup
-    delete[] colorVector;
+    StyledLines &helperOutline =
+      this->GetStyledLines(localStorage, PF_OUTLINE_PASS, color, opacity, m_HelperlineWidth, m_DrawHelperDashed);
+    this->DrawHelperLines(
+      planarFigure, helperOutline, anchorPoint, planarFigurePlaneGeometry, rendererPlaneGeometry, renderer);
   }
 
   // If we want to draw a shadow, we do it here
@@ -900,37 +1008,19 @@ void mitk::PlanarFigureMapper2D::RenderLines(const PlanarFigureDisplayMode lineD
     if (opacity > 0.2f)
       shadowOpacity = opacity - 0.2f;
 
-    // convert to a float array that also contains opacity, faster GL
-    auto *shadow = new float[4];
-    shadow[0] = 0;
-    shadow[1] = 0;
-    shadow[2] = 0;
-    shadow[3] = shadowOpacity;
-
-    // set the color and opacity here as it is common for all shadows
-    this->m_Context->GetPen()->SetColorF(0, 0, 0, shadowOpacity);
-    this->m_Context->GetPen()->SetWidth(m_OutlineWidth * m_ShadowWidthFactor);
+    const float shadow[3] = {0.0f, 0.0f, 0.0f};
 
-    if (m_DrawDashed)
-      this->m_Context->GetPen()->SetLineType(vtkPen::DASH_LINE);
-    else
-      this->m_Context->GetPen()->SetLineType(vtkPen::SOLID_LINE);
+    // Draw the shadow for all polylines
+    StyledLines &mainShadow = this->GetStyledLines(
+      localStorage, PF_SHADOW_PASS, shadow, shadowOpacity, m_OutlineWidth * m_ShadowWidthFactor, m_DrawDashed);
+    this->DrawMainLines(
+      planarFigure, mainShadow, anchorPoint, planarFigurePlaneGeometry, rendererPlaneGeometry, renderer);
 
-    // Draw the outline for all polylines if requested
-    this->DrawMainLines(planarFigure, anchorPoint, planarFigurePlaneGeometry, rendererPlaneGeometry, renderer);
-
-    this->m_Context->GetPen()->SetWidth(m_HelperlineWidth);
-
-    if (m_DrawHelperDashed)
-      this->m_Context->GetPen()->SetLineType(vtkPen::DASH_LINE);
-    else
-      this->m_Context->GetPen()->SetLineType(vtkPen::SOLID_LINE);
-
-    // Draw the outline for all helper objects if requested
-    this->DrawHelperLines(planarFigure, anchorPoint, planarFigurePlaneGeometry, rendererPlaneGeometry, renderer);
-
-    // cleanup
-    delete[] shadow;
+    // Draw the shadow for all helper objects
+    StyledLines &helperShadow = this->GetStyledLines(
+      localStorage, PF_SHADOW_PASS, shadow, shadowOpacity, m_HelperlineWidth, m_DrawHelperDashed);
+    this->DrawHelperLines(
+      planarFigure, helperShadow, anchorPoint, planarFigurePlaneGeometry, rendererPlaneGeometry, renderer);
   }
 
   // set this in brackets to avoid duplicate variables in the same scope
@@ -938,36 +1028,19 @@ void mitk::PlanarFigureMapper2D::RenderLines(const PlanarFigureDisplayMode lineD
     const float *color = m_LineColor[lineDisplayMode];
     const float opacity = m_LineOpacity[lineDisplayMode];
 
-    // set the color and opacity here as it is common for all mainlines
-
-    this->m_Context->GetPen()->SetColorF((double)color[0], (double)color[1], (double)color[2], (double)opacity);
-    this->m_Context->GetPen()->SetWidth(m_LineWidth);
-
-    if (m_DrawDashed)
-      this->m_Context->GetPen()->SetLineType(vtkPen::DASH_LINE);
-    else
-      this->m_Context->GetPen()->SetLineType(vtkPen::SOLID_LINE);
-
     // Draw the main line for all polylines
-    this->DrawMainLines(planarFigure, anchorPoint, planarFigurePlaneGeometry, rendererPlaneGeometry, renderer);
+    StyledLines &mainLines =
+      this->GetStyledLines(localStorage, PF_LINE_PASS, color, opacity, m_LineWidth, m_DrawDashed);
+    this->DrawMainLines(
+      planarFigure, mainLines, anchorPoint, planarFigurePlaneGeometry, rendererPlaneGeometry, renderer);
 
     const float *helperColor = m_HelperlineColor[lineDisplayMode];
     const float helperOpacity = m_HelperlineOpacity[lineDisplayMode];
 
-    // we only set the color for the helperlines as the linewidth is unchanged
-    this->m_Context->GetPen()->SetColorF((double)helperColor[0], (double)helperColor[1], (double)helperColor[2], (double)helperOpacity);
-    this->m_Context->GetPen()->SetWidth(m_HelperlineWidth);
-
-    if (m_DrawHelperDashed)
-      this->m_Context->GetPen()->SetLineType(vtkPen::DASH_LINE);
-    else
-      this->m_Context->GetPen()->SetLineType(vtkPen::SOLID_LINE);
-
-
     // Draw helper objects
-    this->DrawHelperLines(planarFigure, anchorPoint, planarFigurePlaneGeometry, rendererPlaneGeometry, renderer);
+    StyledLines &helperLines = this->GetStyledLines(
+      localStorage, PF_LINE_PASS, helperColor, helperOpacity, m_HelperlineWidth, m_DrawHelperDashed);
+    this->DrawHelperLines(
+      planarFigure, helperLines, anchorPoint, planarFigurePlaneGeometry, rendererPlaneGeometry, renderer);
   }
-
-  if (m_DrawDashed || m_DrawHelperDashed)
-    this->m_Context->GetPen()->SetLineType(vtkPen::SOLID_LINE);
 }
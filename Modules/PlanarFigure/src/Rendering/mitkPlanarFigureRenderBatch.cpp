@@ -0,0 +1,277 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkPlanarFigureRenderBatch.h"
+
+#include "mitkBaseRenderer.h"
+#include "mitkLocalStorageHandler.h"
+#include "mitkPlaneGeometry.h"
+#include "vtkContext2D.h"
+#include "vtkOpenGLContextDevice2D.h"
+#include "vtkPen.h"
+#include "vtkSmartPointer.h"
+
+#include <algorithm>
+
+namespace
+{
+  mitk::LocalStorageHandler<mitk::PlanarFigureRenderBatch> &GetBatchHandler()
+  {
+    static mitk::LocalStorageHandler<mitk::PlanarFigureRenderBatch> handler;
+    return handler;
+  }
+
+  // Added to the index search, covers the deviation of nearly parallel planes from the renderer normal
+  const double IndexTolerance = 0.01;
+}
+
+mitk::PlanarFigureRenderBatch::PlanarFigureRenderBatch()
+  : m_Frame(0), m_Collecting(false), m_IndexMaximumDistance(0.0), m_IndexModified(true)
+{
+  m_IndexNormal.Fill(0.0);
+
+  auto device = vtkSmartPointer<vtkOpenGLContextDevice2D>::New();
+  m_Context->Begin(device);
+}
+
+mitk::PlanarFigureRenderBatch::~PlanarFigureRenderBatch()
+{
+}
+
+mitk::PlanarFigureRenderBatch *mitk::PlanarFigureRenderBatch::GetInstance(BaseRenderer *renderer)
+{
+  return GetBatchHandler().GetLocalStorage(renderer);
+}
+
+void mitk::PlanarFigureRenderBatch::RemoveMapper(const PlanarFigureMapper2D *mapper)
+{
+  for (auto *renderer : GetBatchHandler().GetRegisteredBaseRenderer())
+  {
+    GetBatchHandler().GetLocalStorage(renderer)->RemoveEntry(mapper);
+  }
+}
+
+void mitk::PlanarFigureRenderBatch::RemoveEntry(const PlanarFigureMapper2D *mapper)
+{
+  if (m_Entries.erase(const_cast<PlanarFigureMapper2D *>(mapper)) > 0)
+  {
+    m_IndexModified = true;
+  }
+
+  m_Visible.erase(std::remove_if(m_Visible.begin(),
+                                 m_Visible.end(),
+                                 [mapper](const std::pair<PlanarFigureMapper2D *, const FigureGeometry *> &visible) {
+                                   return visible.first == mapper;
+                                 }),
+                  m_Visible.end());
+}
+
+void mitk::PlanarFigureRenderBatch::Collect(PlanarFigureMapper2D *mapper, const PlanarFigure *figure)
+{
+  // the first figure after a Render() starts a new frame
+  if (!m_Collecting)
+  {
+    ++m_Frame;
+    m_Collecting = true;
+  }
+
+  const PlaneGeometry *plane = figure->GetPlaneGeometry();
+
+  auto iter = m_Entries.find(mapper);
+  if (iter == m_Entries.end())
+  {
+    iter = m_Entries.insert(std::make_pair(mapper, Entry())).first;
+    iter->second.Figure = nullptr;
+  }
+
+  Entry &entry = iter->second;
+  if (entry.Figure != figure || entry.Plane != plane || entry.PlaneMTime != plane->GetMTime())
+  {
+    entry.Figure = figure;
+    entry.Plane = plane;
+    entry.PlaneMTime = plane->GetMTime();
+    m_IndexModified = true;
+  }
+  entry.Frame = m_Frame;
+}
+
+void mitk::PlanarFigureRenderBatch::BuildIndex(const Vector3D &normal)
+{
+  m_Index.clear();
+  m_Index.reserve(m_Entries.size());
+  m_IndexMaximumDistance = 0.0;
+
+  for (const auto &entry : m_Entries)
+  {
+    const PlaneGeometry *plane = entry.second.Plane;
+    const double offset = normal * plane->GetOrigin().GetVectorFromOrigin();
+    m_Index.push_back(std::make_pair(offset, entry.first));
+
+    // the mappers show a figure within a third of its plane thickness
+    m_IndexMaximumDistance = std::max(m_IndexMaximumDistance, plane->GetExtentInMM(2) / 3.0);
+  }
+
+  std::sort(m_Index.begin(), m_Index.end());
+
+  m_IndexNormal = normal;
+  m_IndexModified = false;
+}
+
+void mitk::PlanarFigureRenderBatch::Render(BaseRenderer *renderer)
+{
+  if (!m_Collecting)
+    return;
+
+  m_Collecting = false;
+  m_Visible.clear();
+
+  // figures which were not collected in this frame are invisible or gone
+  for (auto iter = m_Entries.begin(); iter != m_Entries.end();)
+  {
+    if (iter->second.Frame != m_Frame)
+    {
+      iter = m_Entries.erase(iter);
+      m_IndexModified = true;
+    }
+    else
+    {
+      ++iter;
+    }
+  }
+
+  const PlaneGeometry *rendererPlaneGeometry = renderer->GetCurrentWorldPlaneGeometry();
+  if (rendererPlaneGeometry == nullptr || m_Entries.empty())
+    return;
+
+  Vector3D normal = rendererPlaneGeometry->GetNormal();
+  normal.Normalize();
+
+  if (m_IndexModified || !Equal(normal, m_IndexNormal, mitk::eps))
+  {
+    this->BuildIndex(normal);
+  }
+
+  const double offset = normal * rendererPlaneGeometry->GetOrigin().GetVectorFromOrigin();
+  const double maximumDistance = m_IndexMaximumDistance + IndexTolerance;
+
+  auto first = std::lower_bound(m_Index.begin(),
+                                m_Index.end(),
+                                offset - maximumDistance,
+                                [](const std::pair<double, PlanarFigureMapper2D *> &indexed, double value) {
+                                  return indexed.first < value;
+                                });
+
+  for (auto iter = first; iter != m_Index.end() && iter->first <= offset + maximumDistance; ++iter)
+  {
+    const FigureGeometry *geometry = iter->second->UpdateBatchGeometry(renderer, rendererPlaneGeometry);
+    if (geometry != nullptr)
+    {
+      m_Visible.push_back(std::make_pair(iter->second, geometry));
+    }
+  }
+
+  if (m_Visible.empty())
+    return;
+
+  vtkOpenGLContextDevice2D::SafeDownCast(m_Context->GetDevice())->Begin(renderer->GetVtkRenderer());
+
+  for (int pass = 0; pass < PlanarFigureMapper2D::PF_PASS_COUNT; ++pass)
+  {
+    this->RenderPass(static_cast<PlanarFigureMapper2D::PlanarFigureRenderPass>(pass));
+  }
+
+  m_Context->GetPen()->SetLineType(vtkPen::SOLID_LINE);
+
+  // only keep the buffers of styles in use
+  for (auto iter = m_LineBuffers.begin(); iter != m_LineBuffers.end();)
+  {
+    if (iter->second.Frame != m_Frame)
+      iter = m_LineBuffers.erase(iter);
+    else
+      ++iter;
+  }
+
+  // text can not be merged, the annotations are drawn above the lines of all figures
+  for (const auto &visible : m_Visible)
+  {
+    visible.first->RenderBatchAnnotations(renderer, m_Context.GetPointer(), visible.second);
+  }
+
+  m_Context->GetDevice()->End();
+}
+
+void mitk::PlanarFigureRenderBatch::RenderPass(PlanarFigureMapper2D::PlanarFigureRenderPass pass)
+{
+  for (auto &buffer : m_LineBuffers)
+  {
+    buffer.second.Points.clear();
+  }
+
+  for (const auto &visible : m_Visible)
+  {
+    // filled markers are drawn below the lines of the pass
+    for (const auto &marker : visible.second->m_Markers[pass])
+    {
+      this->ApplyLineStyle(marker.Color, marker.Width, vtkPen::SOLID_LINE);
+      m_Context->DrawRect(marker.Position[0] - 4, marker.Position[1] - 4, 8, 8);
+    }
+
+    for (const auto &lines : visible.second->m_Lines[pass])
+    {
+      if (lines.Points.empty())
+        continue;
+
+      if (lines.LineType != vtkPen::SOLID_LINE)
+      {
+        // dashed lines are drawn per polyline to keep their dash pattern
+        this->ApplyLineStyle(lines.Color, lines.Width, lines.LineType);
+
+        auto *points = const_cast<float *>(lines.Points.data());
+        for (const int size : lines.PolyLineSizes)
+        {
+          m_Context->DrawPoly(points, size);
+          points += 2 * size;
+        }
+        continue;
+      }
+
+      const LineStyle style = {
+        {lines.Color[0], lines.Color[1], lines.Color[2], lines.Color[3], lines.Width, float(lines.LineType)}};
+      LineBuffer &buffer = m_LineBuffers[style];
+      buffer.Points.insert(buffer.Points.end(), lines.Points.begin(), lines.Points.end());
+      buffer.Frame = m_Frame;
+    }
+  }
+
+  for (auto &buffer : m_LineBuffers)
+  {
+    std::vector<float> &points = buffer.second.Points;
+    if (points.empty())
+      continue;
+
+    const LineStyle &style = buffer.first;
+    this->ApplyLineStyle(style.data(), style[4], static_cast<int>(style[5]));
+    m_Context->DrawLines(points.data(), static_cast<int>(points.size() / 2));
+  }
+}
+
+void mitk::PlanarFigureRenderBatch::ApplyLineStyle(const float *color, float width, int lineType)
+{
+  vtkPen *pen = m_Context->GetPen();
+  pen->SetColorF((double)color[0], (double)color[1], (double)color[2], (double)color[3]);
+  pen->SetWidth(width);
+  pen->SetLineType(lineType);
+}
@@ -0,0 +1,126 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITK_PLANAR_FIGURE_RENDER_BATCH_H_
+#define MITK_PLANAR_FIGURE_RENDER_BATCH_H_
+
+#include "mitkPlanarFigureMapper2D.h"
+
+#include "vtkNew.h"
+
+#include <array>
+#include <map>
+#include <utility>
+#include <vector>
+
+class vtkContext2D;
+
+namespace mitk
+{
+  class BaseRenderer;
+  class PlaneGeometry;
+  class PlanarFigure;
+
+  /**
+  * \brief Draws the planar figures of one renderer together.
+  *
+  * Every PlanarFigureMapper2D registers its visible figure in the opaque pass via Collect(). The
+  * first mapper reaching the overlay pass calls Render(), which draws all collected figures on the
+  * current slice: the solid line segments of all figures are merged into one buffer per pass and
+  * line style, so every style costs one draw call instead of one per polyline and figure. The
+  * buffers keep their memory from frame to frame. The figures provide their display geometry from
+  * a per renderer cache, see PlanarFigureMapper2D::UpdateBatchGeometry().
+  *
+  * The figures are culled by an index of the offsets of their planes along the normal of the renderer
+  * plane. It is rebuilt if figures are added, removed or their planes are modified, and if the
+  * renderer plane is rotated, scrolling through the slices only searches it. The figures found this
+  * way are checked exactly by their mapper.
+  *
+  * The batch of a renderer is held by a LocalStorageHandler and deleted together with the renderer.
+  *
+  * \sa PlanarFigureMapper2D
+  */
+  class PlanarFigureRenderBatch
+  {
+  public:
+    PlanarFigureRenderBatch();
+    ~PlanarFigureRenderBatch();
+
+    /** \brief The batch of the renderer, it is created on first use. */
+    static PlanarFigureRenderBatch *GetInstance(BaseRenderer *renderer);
+
+    /** \brief Removes the mapper from the batches of all renderers, called by its destructor. */
+    static void RemoveMapper(const PlanarFigureMapper2D *mapper);
+
+    /** \brief Registers a visible and placed figure for the current frame. */
+    void Collect(PlanarFigureMapper2D *mapper, const PlanarFigure *figure);
+
+    /** \brief Draws all figures collected since the last call, further calls of the same frame do nothing. */
+    void Render(BaseRenderer *renderer);
+
+  private:
+    typedef PlanarFigureMapper2D::LocalStorage FigureGeometry;
+
+    // color, opacity, width and line type
+    typedef std::array<float, 6> LineStyle;
+
+    struct Entry
+    {
+      const PlanarFigure *Figure;
+      const PlaneGeometry *Plane;
+      unsigned long PlaneMTime;
+      unsigned long Frame;
+    };
+
+    PlanarFigureRenderBatch(const PlanarFigureRenderBatch &);
+    PlanarFigureRenderBatch &operator=(const PlanarFigureRenderBatch &);
+
+    void RemoveEntry(const PlanarFigureMapper2D *mapper);
+
+    void BuildIndex(const Vector3D &normal);
+
+    void RenderPass(PlanarFigureMapper2D::PlanarFigureRenderPass pass);
+
+    void ApplyLineStyle(const float *color, float width, int lineType);
+
+    std::map<PlanarFigureMapper2D *, Entry> m_Entries;
+
+    // current frame, the figures collected in an earlier frame are removed by Render()
+    unsigned long m_Frame;
+    bool m_Collecting;
+
+    // offsets of the figure planes along m_IndexNormal, sorted
+    std::vector<std::pair<double, PlanarFigureMapper2D *>> m_Index;
+    Vector3D m_IndexNormal;
+    double m_IndexMaximumDistance;
+    bool m_IndexModified;
+
+    // figures on the current slice, filled by Render()
+    std::vector<std::pair<PlanarFigureMapper2D *, const FigureGeometry *>> m_Visible;
+
+    // merged segments of all figures, the memory is kept for the next frame
+    struct LineBuffer
+    {
+      unsigned long Frame = 0;
+      std::vector<float> Points;
+    };
+    std::map<LineStyle, LineBuffer> m_LineBuffers;
+
+    vtkNew<vtkContext2D> m_Context;
+  };
+}
+
+#endif /* MITK_PLANAR_FIGURE_RENDER_BATCH_H_ */
@@ -31,6 +31,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mitkExceptionMacro.h>
 
+#include <itkCommand.h>
+
+#include <memory>
+#include <vector>
+
 #ifndef WIN32
 #include <dlfcn.h>
 #endif
@@ -40,6 +45,163 @@ const QString mitk::PythonService::m_TmpDataFileName("temp_mitk_data_file");
 static char* pHome = nullptr;
 #endif
 
+namespace
+{
+  const char* const ImageAccessCapsuleName = "mitk.ImageAccess";
+
+  // the lock on an image held by a numpy array viewing its buffer
+  struct ImageAccess
+  {
+    std::unique_ptr<mitk::ImageAccessorBase> Accessor;
+    mitk::Image::Pointer WrittenImage;
+  };
+
+  void ReleaseImageAccess(PyObject* capsule)
+  {
+    auto* access = static_cast<ImageAccess*>(PyCapsule_GetPointer(capsule, ImageAccessCapsuleName));
+    if (access == nullptr)
+      return;
+
+    mitk::Image::Pointer writtenImage = access->WrittenImage;
+    delete access; // unlocks the image
+
+    if (writtenImage.IsNotNull())
+      writtenImage->Modified();
+  }
+
+  bool GetNumpyType(const mitk::PixelType& pixelType, int& npyType)
+  {
+    switch (pixelType.GetComponentType())
+    {
+      case itk::ImageIOBase::DOUBLE: npyType = NPY_DOUBLE; break;
+      case itk::ImageIOBase::FLOAT: npyType = NPY_FLOAT; break;
+      case itk::ImageIOBase::SHORT: npyType = NPY_SHORT; break;
+      case itk::ImageIOBase::CHAR: npyType = NPY_BYTE; break;
+      case itk::ImageIOBase::INT: npyType = NPY_INT; break;
+      case itk::ImageIOBase::LONG: npyType = NPY_LONG; break;
+      case itk::ImageIOBase::UCHAR: npyType = NPY_UBYTE; break;
+      case itk::ImageIOBase::UINT: npyType = NPY_UINT; break;
+      case itk::ImageIOBase::ULONG: npyType = NPY_ULONG; break;
+      case itk::ImageIOBase::USHORT: npyType = NPY_USHORT; break;
+      default: return false;
+    }
+    return true;
+  }
+
+  ///
+  /// creates a numpy array viewing the buffer of the image without copying it, either flat (first three
+  /// dimensions) or in the shape [t,]z,y,x[,components]. The array locks the image as long as it exists.
+  PyObject* CreateNumpyView(mitk::Image* image, bool flat, bool writable)
+  {
+    int npyType = NPY_USHORT;
+    if (!GetNumpyType(image->GetPixelType(), npyType))
+    {
+      MITK_WARN << "not a recognized pixeltype";
+      return nullptr;
+    }
+
+    import_array1(nullptr);
+
+    std::unique_ptr<ImageAccess> access(new ImageAccess);
+    void* data = nullptr;
+    if (writable)
+    {
+      auto* accessor = new mitk::ImageWriteAccessor(image);
+      access->Accessor.reset(accessor);
+      access->WrittenImage = image;
+      data = accessor->GetData();
+    }
+    else
+    {
+      auto* accessor = new mitk::ImageReadAccessor(image);
+      access->Accessor.reset(accessor);
+      data = const_cast<void*>(accessor->GetData());
+    }
+
+    const unsigned int* imgDim = image->GetDimensions();
+    const unsigned int nrComponents = image->GetPixelType().GetNumberOfComponents();
+
+    std::vector<npy_intp> shape;
+    if (flat)
+    {
+      shape.push_back(static_cast<npy_intp>(imgDim[0]) * imgDim[1] * imgDim[2] * nrComponents);
+    }
+    else
+    {
+      for (int i = static_cast<int>(image->GetDimension()) - 1; i >= 0; --i)
+        shape.push_back(imgDim[i]);
+      if (nrComponents > 1)
+        shape.push_back(nrComponents);
+    }
+
+    PyObject* array = PyArray_New(&PyArray_Type, static_cast<int>(shape.size()), shape.data(), npyType, nullptr, data, 0,
+      writable ? NPY_ARRAY_CARRAY : NPY_ARRAY_CARRAY_RO, nullptr);
+    if (array == nullptr)
+      return nullptr;
+
+    PyObject* capsule = PyCapsule_New(access.get(), ImageAccessCapsuleName, &ReleaseImageAccess);
+    if (capsule == nullptr)
+    {
+      Py_DECREF(array);
+      return nullptr;
+    }
+    access.release();
+
+    // the array owns the capsule now, releasing the array releases the lock
+    PyArray_SetBaseObject(reinterpret_cast<PyArrayObject*>(array), capsule);
+    return array;
+  }
+
+  void ReleasePythonObject(itk::Object*, const itk::EventObject&, void* clientData)
+  {
+    PyGILState_STATE state = PyGILState_Ensure();
+    Py_XDECREF(static_cast<PyObject*>(clientData));
+    PyGILState_Release(state);
+  }
+
+  ///
+  /// lets the image reference the buffer of a contiguous numpy array instead of copying it. The array (and owner,
+  /// if given) is kept alive until the image is deleted.
+  bool AdoptNumpyBuffer(mitk::Image* image, PyArrayObject* array, PyObject* owner = nullptr)
+  {
+    if (array == nullptr || !PyArray_ISCARRAY_RO(array))
+      return false;
+
+    std::size_t size = image->GetPixelType().GetSize();
+    for (unsigned int i = 0; i < image->GetDimension(); ++i)
+      size *= image->GetDimension(i);
+
+    if (static_cast<std::size_t>(PyArray_NBYTES(array)) < size)
+      return false;
+
+    PyObject* reference = nullptr;
+    if (owner != nullptr)
+    {
+      reference = PyTuple_Pack(2, reinterpret_cast<PyObject*>(array), owner);
+      if (reference == nullptr)
+        return false;
+    }
+    else
+    {
+      reference = reinterpret_cast<PyObject*>(array);
+      Py_INCREF(reference);
+    }
+
+    if (!image->SetImportChannel(PyArray_DATA(array), 0, mitk::Image::ReferenceMemory))
+    {
+      Py_DECREF(reference);
+      return false;
+    }
+
+    auto command = itk::CStyleCommand::New();
+    command->SetCallback(&ReleasePythonObject);
+    command->SetClientData(reference);
+    image->AddObserver(itk::DeleteEvent(), command);
+
+    return true;
+  }
+}
+
 mitk::PythonService::PythonService()
 : m_ItkWrappingAvailable( true ), m_OpenCVWrappingAvailable( true ), m_VtkWrappingAvailable( true ), m_ErrorOccured( false )
 {
@@ -280,7 +442,6 @@ bool mitk::PythonService::CopyToPythonAsSimpleItkImage(mitk::Image *image, const
   QString varName = QString::fromStdString( stdvarName );
   QString command;
   unsigned int* imgDim = image->GetDimensions();
-  int npy_nd = 1;
 
   // access python module
   PyObject *pyMod = PyImport_AddModule((char*)"__main__");
@@ -291,8 +452,6 @@ bool mitk::PythonService::CopyToPythonAsSimpleItkImage(mitk::Image *image, const
   mitk::PixelType pixelType = image->GetPixelType();
   itk::ImageIOBase::IOPixelType ioPixelType = image->GetPixelType().GetPixelType();
   PyObject* npyArray = nullptr;
-  mitk::ImageReadAccessor racc(image);
-  void* array = (void*) racc.GetData();
 
   mitk::Vector3D xDirection;
   mitk::Vector3D yDirection;
@@ -308,10 +467,6 @@ bool mitk::PythonService::CopyToPythonAsSimpleItkImage(mitk::Image *image, const
   mitk::FillVector3D(yDirection, transform[1][0]/s[0], transform[1][1]/s[1], transform[1][2]/s[2]);
   mitk::FillVector3D(zDirection, transform[2][0]/s[0], transform[2][1]/s[1], transform[2][2]/s[2]);
 
-  // save the total number of elements here (since the numpy array is one dimensional)
-  npy_intp* npy_dims = new npy_intp[1];
-  npy_dims[0] = imgDim[0];
-
   /**
    * Build a string in the format [1024,1028,1]
    * to describe the dimensionality. This is needed for simple itk
@@ -326,48 +481,32 @@ bool mitk::PythonService::CopyToPythonAsSimpleItkImage(mitk::Image *image, const
   {
     dimensionString.append(QString(","));
     dimensionString.append(QString::number(imgDim[i]));
-    npy_dims[0] *= imgDim[i];
   }
   dimensionString.append("]");
 
 
-  // the next line is necessary for vectorimages
-  npy_dims[0] *= pixelType.GetNumberOfComponents();
-
-  // default pixeltype: unsigned short
-  NPY_TYPES npy_type  = NPY_USHORT;
   std::string sitk_type = "sitkUInt8";
   if( ioPixelType == itk::ImageIOBase::SCALAR )
   {
     if( pixelType.GetComponentType() == itk::ImageIOBase::DOUBLE ) {
-      npy_type = NPY_DOUBLE;
       sitk_type = "sitkFloat64";
     } else if( pixelType.GetComponentType() == itk::ImageIOBase::FLOAT ) {
-      npy_type = NPY_FLOAT;
       sitk_type = "sitkFloat32";
     } else if( pixelType.GetComponentType() == itk::ImageIOBase::SHORT) {
-      npy_type = NPY_SHORT;
       sitk_type = "sitkInt16";
     } else if( pixelType.GetComponentType() == itk::ImageIOBase::CHAR ) {
-      npy_type = NPY_BYTE;
       sitk_type = "sitkInt8";
     } else if( pixelType.GetComponentType() == itk::ImageIOBase::INT ) {
-      npy_type = NPY_INT;
       sitk_type = "sitkInt32";
     } else if( pixelType.GetComponentType() == itk::ImageIOBase::LONG ) {
-      npy_type = NPY_LONG;
       sitk_type = "sitkInt64";
     } else if( pixelType.GetComponentType() == itk::ImageIOBase::UCHAR ) {
-      npy_type = NPY_UBYTE;
       sitk_type = "sitkUInt8";
     } else if( pixelType.GetComponentType() == itk::ImageIOBase::UINT ) {
-      npy_type = NPY_UINT;
       sitk_type = "sitkUInt32";
     } else if( pixelType.GetComponentType() == itk::ImageIOBase::ULONG ) {
-      npy_type = NPY_LONG;
       sitk_type = "sitkUInt64";
     } else if( pixelType.GetComponentType() == itk::ImageIOBase::USHORT ) {
-      npy_type = NPY_USHORT;
       sitk_type = "sitkUInt16";
     }
   }
@@ -377,34 +516,24 @@ bool mitk::PythonService::CopyToPythonAsSimpleItkImage(mitk::Image *image, const
   )
   {
     if( pixelType.GetComponentType() == itk::ImageIOBase::DOUBLE ) {
-      npy_type = NPY_DOUBLE;
       sitk_type = "sitkVectorFloat64";
     } else if( pixelType.GetComponentType() == itk::ImageIOBase::FLOAT ) {
-      npy_type = NPY_FLOAT;
       sitk_type = "sitkVectorFloat32";
     } else if( pixelType.GetComponentType() == itk::ImageIOBase::SHORT) {
-      npy_type = NPY_SHORT;
       sitk_type = "sitkVectorInt16";
     } else if( pixelType.GetComponentType() == itk::ImageIOBase::CHAR ) {
-      npy_type = NPY_BYTE;
       sitk_type = "sitkVectorInt8";
     } else if( pixelType.GetComponentType() == itk::ImageIOBase::INT ) {
-      npy_type = NPY_INT;
       sitk_type = "sitkVectorInt32";
     } else if( pixelType.GetComponentType() == itk::ImageIOBase::LONG ) {
-      npy_type = NPY_LONG;
       sitk_type = "sitkVectorInt64";
     } else if( pixelType.GetComponentType() == itk::ImageIOBase::UCHAR ) {
-      npy_type = NPY_UBYTE;
       sitk_type = "sitkVectorUInt8";
     } else if( pixelType.GetComponentType() == itk::ImageIOBase::UINT ) {
-      npy_type = NPY_UINT;
       sitk_type = "sitkVectorUInt32";
     } else if( pixelType.GetComponentType() == itk::ImageIOBase::ULONG ) {
-      npy_type = NPY_LONG;
       sitk_type = "sitkVectorUInt64";
     } else if( pixelType.GetComponentType() == itk::ImageIOBase::USHORT ) {
-      npy_type = NPY_USHORT;
       sitk_type = "sitkVectorUInt16";
     }
   }
@@ -413,14 +542,16 @@ bool mitk::PythonService::CopyToPythonAsSimpleItkImage(mitk::Image *image, const
     return false;
   }
 
-  // creating numpy array
-  import_array1 (true);
-  npyArray = PyArray_SimpleNewFromData(npy_nd,npy_dims,npy_type,array);
+  // a flat view onto the image buffer, the image is locked until the array is deleted below
+  npyArray = CreateNumpyView(image, true, false);
+  if (npyArray == nullptr)
+    return false;
 
   // add temp array it to the python dictionary to access it in python code
   const int status = PyDict_SetItemString( pyDict,QString("%1_numpy_array")
       .arg(varName).toStdString().c_str(),
       npyArray );
+  Py_DECREF(npyArray);
 
 
   // sanity check
@@ -463,6 +594,36 @@ bool mitk::PythonService::CopyToPythonAsSimpleItkImage(mitk::Image *image, const
 }
 
 
+bool mitk::PythonService::ShareImageWithPythonAsNumpyArray(mitk::Image *image, const std::string &stdvarName, bool writable)
+{
+  if (image == nullptr || !image->IsInitialized())
+    return false;
+
+  // access python module
+  PyObject *pyMod = PyImport_AddModule((char*)"__main__");
+  // global dictionary
+  PyObject *pyDict = PyModule_GetDict(pyMod);
+
+  PyObject* npyArray = nullptr;
+  try
+  {
+    npyArray = CreateNumpyView(image, false, writable);
+  }
+  catch (const mitk::Exception& e)
+  {
+    MITK_WARN << "Could not lock image to share it with python: " << e.GetDescription();
+    return false;
+  }
+
+  if (npyArray == nullptr)
+    return false;
+
+  const int status = PyDict_SetItemString( pyDict, stdvarName.c_str(), npyArray );
+  Py_DECREF(npyArray);
+
+  return status == 0;
+}
+
 mitk::PixelType DeterminePixelType(const std::string& pythonPixeltype, int nrComponents, int dimensions)
 {
   typedef itk::RGBPixel< unsigned char > UCRGBPixelType;
@@ -562,6 +723,16 @@ mitk::PixelType DeterminePixelType(const std::string& pythonPixeltype, int nrCom
 }
 
 mitk::Image::Pointer mitk::PythonService::CopySimpleItkImageFromPython(const std::string &stdvarName)
+{
+  return this->ImageFromSimpleItk(stdvarName, false);
+}
+
+mitk::Image::Pointer mitk::PythonService::AdoptSimpleItkImageFromPython(const std::string &stdvarName)
+{
+  return this->ImageFromSimpleItk(stdvarName, true);
+}
+
+mitk::Image::Pointer mitk::PythonService::ImageFromSimpleItk(const std::string &stdvarName, bool share)
 {
   double*ds = nullptr;
   // access python module
@@ -574,7 +745,15 @@ mitk::Image::Pointer mitk::PythonService::CopySimpleItkImageFromPython(const std
   QString command;
   QString varName = QString::fromStdString( stdvarName );
 
-  command.append( QString("%1_numpy_array = sitk.GetArrayFromImage(%1)\n").arg(varName) );
+  if (share)
+  {
+    // older SimpleITK versions only provide the copying GetArrayFromImage
+    command.append( QString("%1_numpy_array = getattr(sitk, 'GetArrayViewFromImage', sitk.GetArrayFromImage)(%1)\n").arg(varName) );
+  }
+  else
+  {
+    command.append( QString("%1_numpy_array = sitk.GetArrayFromImage(%1)\n").arg(varName) );
+  }
   command.append( QString("%1_spacing = numpy.asarray(%1.GetSpacing())\n").arg(varName) );
   command.append( QString("%1_origin = numpy.asarray(%1.GetOrigin())\n").arg(varName) );
   command.append( QString("%1_dtype = %1_numpy_array.dtype.name\n").arg(varName) );
@@ -614,8 +793,12 @@ mitk::Image::Pointer mitk::PythonService::CopySimpleItkImageFromPython(const std
 
   mitkImage->Initialize(pixelType, nr_dimensions, dimensions);
 
-
-  mitkImage->SetChannel(PyArray_DATA(py_data));
+  // the array is either a fresh copy or a view of the SimpleITK image, the view does not keep the image alive
+  PyObject* owner = share ? PyDict_GetItemString(pyDict, stdvarName.c_str()) : nullptr;
+  if (!AdoptNumpyBuffer(mitkImage, py_data, owner))
+  {
+    mitkImage->SetChannel(PyArray_DATA(py_data));
+  }
 
 
   ds = reinterpret_cast<double*>(PyArray_DATA(py_spacing));
@@ -681,7 +864,6 @@ bool mitk::PythonService::CopyToPythonAsCvImage( mitk::Image* image, const std::
   QString varName = QString::fromStdString( stdvarName );
   QString command;
   unsigned int* imgDim = image->GetDimensions();
-  int npy_nd = 1;
 
   // access python module
   PyObject *pyMod = PyImport_AddModule((char*)"__main__");
@@ -689,72 +871,17 @@ bool mitk::PythonService::CopyToPythonAsCvImage( mitk::Image* image, const std::
   PyObject *pyDict = PyModule_GetDict(pyMod);
   mitk::PixelType pixelType = image->GetPixelType();
   PyObject* npyArray = nullptr;
-  mitk::ImageReadAccessor racc(image);
-  void* array = (void*) racc.GetData();
-
-  // save the total number of elements here (since the numpy array is one dimensional)
-  npy_intp* npy_dims = new npy_intp[1];
-  npy_dims[0] = imgDim[0];
-
-  /**
-   * Build a string in the format [1024,1028,1]
-   * to describe the dimensionality. This is needed for simple itk
-   * to know the dimensions of the image
-   */
-  QString dimensionString;
-  dimensionString.append(QString("["));
-  dimensionString.append(QString::number(imgDim[0]));
-  // ToDo: check if we need this
-  for (unsigned i = 1; i < 3; ++i)
-    // always three because otherwise the 3d-geometry gets destroyed
-    // (relevant for backtransformation of simple itk image to mitk.
-  {
-    dimensionString.append(QString(","));
-    dimensionString.append(QString::number(imgDim[i]));
-    npy_dims[0] *= imgDim[i];
-  }
-  dimensionString.append("]");
-
 
-  // the next line is necessary for vectorimages
-  npy_dims[0] *= pixelType.GetNumberOfComponents();
-
-  // default pixeltype: unsigned short
-  NPY_TYPES npy_type  = NPY_USHORT;
-  if( pixelType.GetComponentType() == itk::ImageIOBase::DOUBLE ) {
-    npy_type = NPY_DOUBLE;
-  } else if( pixelType.GetComponentType() == itk::ImageIOBase::FLOAT ) {
-    npy_type = NPY_FLOAT;
-  } else if( pixelType.GetComponentType() == itk::ImageIOBase::SHORT) {
-    npy_type = NPY_SHORT;
-  } else if( pixelType.GetComponentType() == itk::ImageIOBase::CHAR ) {
-    npy_type = NPY_BYTE;
-  } else if( pixelType.GetComponentType() == itk::ImageIOBase::INT ) {
-    npy_type = NPY_INT;
-  } else if( pixelType.GetComponentType() == itk::ImageIOBase::LONG ) {
-    npy_type = NPY_LONG;
-  } else if( pixelType.GetComponentType() == itk::ImageIOBase::UCHAR ) {
-    npy_type = NPY_UBYTE;
-  } else if( pixelType.GetComponentType() == itk::ImageIOBase::UINT ) {
-    npy_type = NPY_UINT;
-  } else if( pixelType.GetComponentType() == itk::ImageIOBase::ULONG ) {
-    npy_type = NPY_LONG;
-  } else if( pixelType.GetComponentType() == itk::ImageIOBase::USHORT ) {
-    npy_type = NPY_USHORT;
-  }
-  else {
-    MITK_WARN << "not a recognized pixeltype";
+  // a flat view onto the image buffer, the image is locked until the array is deleted below
+  npyArray = CreateNumpyView(image, true, false);
+  if (npyArray == nullptr)
     return false;
-  }
-
-  // creating numpy array
-  import_array1 (true);
-  npyArray = PyArray_SimpleNewFromData(npy_nd,npy_dims,npy_type,array);
 
   // add temp array it to the python dictionary to access it in python code
   const int status = PyDict_SetItemString( pyDict,QString("%1_numpy_array")
       .arg(varName).toStdString().c_str(),
       npyArray );
+  Py_DECREF(npyArray);
   // sanity check
   if ( status != 0 )
     return false;
@@ -794,8 +921,7 @@ mitk::Image::Pointer mitk::PythonService::CopyCvImageFromPython( const std::stri
   command.append( QString("import numpy as np\n"));
   command.append( QString("%1_dtype=%1.dtype.name\n").arg(varName) );
   command.append( QString("%1_shape=np.asarray(%1.shape)\n").arg(varName) );
-  command.append( QString("%1_np_array=%1[:,...,::-1]\n").arg(varName));
-  command.append( QString("%1_np_array=np.reshape(%1_np_array,%1.shape[0] * %1.shape[1] * %1.shape[2])").arg(varName) );
+  command.append( QString("%1_np_array=np.array(%1[:,...,::-1], order='C').reshape(-1)").arg(varName) );
 
   MITK_DEBUG("PythonService") << "Issuing python command " << command.toStdString();
   this->Execute(command.toStdString(), IPythonService::MULTI_LINE_COMMAND );
@@ -820,8 +946,9 @@ mitk::Image::Pointer mitk::PythonService::CopyCvImageFromPython( const std::stri
   mitk::PixelType pixelType = DeterminePixelType(dtype, nr_Components, nr_dimensions);
 
   mitkImage->Initialize(pixelType, nr_dimensions, dimensions);
-  //mitkImage->SetChannel(py_data->data);
 
+  // the array is a copy with the channels in MITK order, the image keeps it instead of copying it again
+  if (!AdoptNumpyBuffer(mitkImage, py_data))
   {
     mitk::ImageWriteAccessor ra(mitkImage);
     char* data = (char*)(ra.GetData());
@@ -69,6 +69,12 @@ namespace mitk
       /// \see IPythonService::CopyItkImageFromPython()
       mitk::Image::Pointer CopySimpleItkImageFromPython( const std::string& varName );
       ///
+      /// \see IPythonService::AdoptSimpleItkImageFromPython()
+      mitk::Image::Pointer AdoptSimpleItkImageFromPython( const std::string& varName );
+      ///
+      /// \see IPythonService::ShareImageWithPythonAsNumpyArray()
+      bool ShareImageWithPythonAsNumpyArray( mitk::Image* image, const std::string& varName, bool writable = false );
+      ///
       /// \see IPythonService::IsOpenCvPythonWrappingAvailable()
       bool IsOpenCvPythonWrappingAvailable();
       ///
@@ -91,6 +97,9 @@ namespace mitk
       ctkAbstractPythonManager* GetPythonManager();
   protected:
       QString GetTempDataFileName(const std::string &ext) const;
+      ///
+      /// creates an mitk image from the simple itk image "varName", referencing a view onto its buffer if share is true
+      mitk::Image::Pointer ImageFromSimpleItk( const std::string& varName, bool share );
   private:
       QList<PythonCommandObserver*> m_Observer;
       ctkAbstractPythonManager m_PythonManager;
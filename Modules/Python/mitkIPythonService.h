@@ -112,6 +112,20 @@ namespace mitk
         /// copies an itk image from the python process that is named "varName"
         /// \return the image or 0 if copying was not possible
         virtual mitk::Image::Pointer CopySimpleItkImageFromPython( const std::string& varName ) = 0;
+        ///
+        /// creates an mitk image from the simple itk image "varName" without copying its voxels
+        /// the mitk image references the buffer of the python image and keeps it alive, changes to
+        /// the python image are visible in the mitk image
+        /// \return the image or 0 if adopting was not possible
+        virtual mitk::Image::Pointer AdoptSimpleItkImageFromPython( const std::string& varName ) = 0;
+
+        ///
+        /// makes the voxels of an mitk image available as numpy array "varName" without copying them
+        /// the array is a view onto the image buffer with the shape [t,]z,y,x[,components]. It holds
+        /// a read lock on the image (or a write lock if writable is true, the image is marked as modified
+        /// when the array is released) as long as it exists, so delete it ("del varName") when done
+        /// \return true if the array was created, else false
+        virtual bool ShareImageWithPythonAsNumpyArray( mitk::Image* image, const std::string& varName, bool writable = false ) = 0;
 
         ///
         /// \return true, if OpenCv wrapping is available, false otherwise
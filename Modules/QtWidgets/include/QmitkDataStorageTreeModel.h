@@ -29,12 +29,21 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "QmitkEnums.h"
 
 #include <QList>
+#include <QTimer>
+#include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 class QmitkDataStorageTreeModelInternalItem;
 
 /** \ingroup QmitkModule
+ The model is kept up to date incrementally: nodes are looked up in a hash map instead of searching the tree,
+ added and removed nodes only emit signals for the affected rows, and node modifications are collected and
+ emitted as one dataChanged() per range of consecutive rows after a short delay.
+ The children of a node are not reported to views until they are requested via fetchMore() (i.e. when the node is
+ expanded), in batches of FetchBatchSize rows. Top-level nodes are always available.
+
  @warning This class causes invalid point exception when used with invalid QModelIndex instances.
  The index validation is not sufficient. This may cause unspecific crashes in situation where
  this class is used multiple times or with multiple selection models. See https://phabricator.mitk.org/T24348
@@ -50,6 +59,11 @@ public:
   static const std::string COLUMN_TYPE;
   static const std::string COLUMN_VISIBILITY;
 
+  /// Number of child rows that are made available to a view per fetchMore()
+  static const int FetchBatchSize;
+  /// Delay in milliseconds for collecting node modifications before dataChanged() is emitted
+  static const int ModifiedNodesDelay;
+
   //# CTORS,DTOR
 public:
   QmitkDataStorageTreeModel(mitk::DataStorage *_DataStorage, bool _PlaceNewNodesOnTop = false, QObject *parent = nullptr);
@@ -87,6 +101,10 @@ public:
   QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
   int rowCount(const QModelIndex &parent = QModelIndex()) const override;
   int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+  bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+  //# lazy population
+  bool canFetchMore(const QModelIndex &parent) const override;
+  void fetchMore(const QModelIndex &parent) override;
   //# hierarchical model
   ///
   /// called whenever the model or the view needs to create a QModelIndex for a particular
@@ -129,12 +147,21 @@ public:
   ///
   virtual void RemoveNode(const mitk::DataNode *node);
   ///
+  /// Adds the nodes of a batch update of the DataStorage with a single model reset.
+  ///
+  void AddNodes(const mitk::DataStorage::SetOfObjects *nodes);
+  ///
+  /// Removes the nodes of a batch update of the DataStorage with a single model reset.
+  ///
+  void RemoveNodes(const mitk::DataStorage::SetOfObjects *nodes);
+  ///
   /// Sets a node to modfified. Called by the DataStorage
   ///
   virtual void SetNodeModified(const mitk::DataNode *node);
 
   ///
   /// \return an index for the given datatreenode in the tree. If the node is not found
+  /// an invalid index is returned. Rows of the node and its ancestors that were not fetched yet are fetched.
   ///
   QModelIndex GetIndex(const mitk::DataNode *) const;
 
@@ -181,6 +208,33 @@ protected:
   /// Update Tree Model
   ///
   void Update();
+  ///
+  /// \return the tree item of the node or nullptr (constant time)
+  ///
+  TreeItem *FindTreeItem(const mitk::DataNode *node) const;
+  ///
+  /// \return the number of children of parent that are available to views
+  ///
+  int GetFetchedChildCount(const TreeItem *parent) const;
+  ///
+  /// \return whether the item and all of its ancestors are available to views
+  ///
+  bool IsVisible(const TreeItem *item) const;
+  ///
+  /// Makes all children of parent available to views
+  ///
+  void FetchAllChildren(TreeItem *parent);
+  ///
+  /// Emit the row signals for the insertion of a child at row, if it is visible in views.
+  /// Have to be called before and after the child is actually inserted.
+  ///
+  bool BeginInsertChild(TreeItem *parent, int row);
+  void EndInsertChild(bool signalled);
+  ///
+  /// Emit the row signals for the removal of the child at row, if it is visible in views.
+  ///
+  bool BeginRemoveChild(TreeItem *parent, int row);
+  void EndRemoveChild(bool signalled);
 
   //# ATTRIBUTES
 protected:
@@ -199,9 +253,24 @@ protected:
   /// with that one.
   bool m_AllowHierarchyChange;
 
+  /// True while the nodes of a batch update are inserted or removed within a model reset,
+  /// no row signals are emitted then.
+  bool m_ResettingModel;
+
+  /// Tree item of every node in the model
+  std::unordered_map<const mitk::DataNode *, TreeItem *> m_TreeItems;
+  /// Number of children available to views, for all non-root items that have children and were fetched
+  std::unordered_map<const TreeItem *, int> m_FetchedChildCounts;
+
+  /// Modified nodes whose dataChanged() signal is pending
+  std::set<const mitk::DataNode *> m_ModifiedNodes;
+  QTimer m_ModifiedNodesTimer;
+
 private:
   void AddNodeInternal(const mitk::DataNode *);
   void RemoveNodeInternal(const mitk::DataNode *);
+  void EmitModifiedNodes();
+  void ResetTree();
   ///
   /// Checks if dicom properties patient name, study names and series name exists
   ///
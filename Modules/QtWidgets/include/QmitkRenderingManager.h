@@ -59,6 +59,8 @@ protected:
 
   void GenerateRenderingRequestEvent() override;
 
+  bool GenerateDelayedRenderingRequestEvent(unsigned int milliseconds) override;
+
   void StartOrResetTimer() override;
 
   int pendingTimerCallbacks;
@@ -67,6 +69,8 @@ protected slots:
 
   void TimerCallback();
 
+  void DelayedRenderingRequestCallback();
+
 private:
   friend class QmitkRenderingManagerFactory;
 };
@@ -38,10 +38,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <QMimeData>
 #include <QTextStream>
 
+#include <algorithm>
 #include <map>
 
 #include <mitkCoreServices.h>
 
+const int QmitkDataStorageTreeModel::FetchBatchSize = 100;
+const int QmitkDataStorageTreeModel::ModifiedNodesDelay = 20;
+
 QmitkDataStorageTreeModel::QmitkDataStorageTreeModel(mitk::DataStorage *_DataStorage,
                                                      bool _PlaceNewNodesOnTop,
                                                      QObject *parent)
@@ -50,8 +54,14 @@ QmitkDataStorageTreeModel::QmitkDataStorageTreeModel(mitk::DataStorage *_DataSto
     m_PlaceNewNodesOnTop(_PlaceNewNodesOnTop),
     m_Root(nullptr),
     m_BlockDataStorageEvents(false),
-    m_AllowHierarchyChange(false)
+    m_AllowHierarchyChange(false),
+    m_ResettingModel(false)
 {
+  // modifications are collected, e.g. AdjustLayerProperty() modifies every node
+  m_ModifiedNodesTimer.setSingleShot(true);
+  m_ModifiedNodesTimer.setInterval(ModifiedNodesDelay);
+  connect(&m_ModifiedNodesTimer, &QTimer::timeout, this, &QmitkDataStorageTreeModel::EmitModifiedNodes);
+
   this->SetDataStorage(_DataStorage);
 }
 
@@ -61,6 +71,8 @@ QmitkDataStorageTreeModel::~QmitkDataStorageTreeModel()
   this->SetDataStorage(nullptr);
   m_Root->Delete();
   m_Root = nullptr;
+  m_TreeItems.clear();
+  m_FetchedChildCounts.clear();
 }
 
 mitk::DataNode::Pointer QmitkDataStorageTreeModel::GetNode(const QModelIndex &index) const
@@ -82,6 +94,9 @@ QModelIndex QmitkDataStorageTreeModel::index(int row, int column, const QModelIn
   else
     parentItem = static_cast<TreeItem *>(parent.internalPointer());
 
+  if (row >= this->GetFetchedChildCount(parentItem))
+    return QModelIndex();
+
   TreeItem *childItem = parentItem->GetChild(row);
   if (childItem)
     return createIndex(row, column, childItem);
@@ -92,7 +107,117 @@ QModelIndex QmitkDataStorageTreeModel::index(int row, int column, const QModelIn
 int QmitkDataStorageTreeModel::rowCount(const QModelIndex &parent) const
 {
   TreeItem *parentTreeItem = this->TreeItemFromIndex(parent);
-  return parentTreeItem->GetChildCount();
+  return this->GetFetchedChildCount(parentTreeItem);
+}
+
+bool QmitkDataStorageTreeModel::hasChildren(const QModelIndex &parent) const
+{
+  // also true for children that were not fetched yet, so that views show the expand indicator
+  return this->TreeItemFromIndex(parent)->GetChildCount() > 0;
+}
+
+bool QmitkDataStorageTreeModel::canFetchMore(const QModelIndex &parent) const
+{
+  TreeItem *parentTreeItem = this->TreeItemFromIndex(parent);
+  return this->GetFetchedChildCount(parentTreeItem) < parentTreeItem->GetChildCount();
+}
+
+void QmitkDataStorageTreeModel::fetchMore(const QModelIndex &parent)
+{
+  TreeItem *parentTreeItem = this->TreeItemFromIndex(parent);
+  int fetchedChildCount = this->GetFetchedChildCount(parentTreeItem);
+  int count = std::min(FetchBatchSize, parentTreeItem->GetChildCount() - fetchedChildCount);
+  if (count <= 0 || m_ResettingModel)
+    return;
+
+  this->beginInsertRows(this->IndexFromTreeItem(parentTreeItem), fetchedChildCount, fetchedChildCount + count - 1);
+  m_FetchedChildCounts[parentTreeItem] = fetchedChildCount + count;
+  this->endInsertRows();
+}
+
+void QmitkDataStorageTreeModel::FetchAllChildren(TreeItem *parent)
+{
+  while (this->GetFetchedChildCount(parent) < parent->GetChildCount())
+    this->fetchMore(this->IndexFromTreeItem(parent));
+}
+
+int QmitkDataStorageTreeModel::GetFetchedChildCount(const TreeItem *parent) const
+{
+  // top-level nodes are always available, the children of other items once they were fetched
+  if (parent == m_Root)
+    return parent->GetChildCount();
+
+  auto it = m_FetchedChildCounts.find(parent);
+  return it != m_FetchedChildCounts.end() ? it->second : 0;
+}
+
+bool QmitkDataStorageTreeModel::IsVisible(const TreeItem *item) const
+{
+  for (; item != m_Root; item = item->GetParent())
+  {
+    if (item->GetParent() == nullptr || item->GetIndex() >= this->GetFetchedChildCount(item->GetParent()))
+      return false;
+  }
+  return true;
+}
+
+bool QmitkDataStorageTreeModel::BeginInsertChild(TreeItem *parent, int row)
+{
+  if (m_ResettingModel)
+    return false;
+
+  int fetchedChildCount = this->GetFetchedChildCount(parent);
+
+  // rows behind the fetched ones stay hidden, appending to completely fetched children (or to a node without
+  // children) shows the new row
+  if (row > fetchedChildCount || (row == fetchedChildCount && fetchedChildCount < parent->GetChildCount()))
+    return false;
+
+  bool signalled = this->IsVisible(parent);
+  if (signalled)
+    this->beginInsertRows(this->IndexFromTreeItem(parent), row, row);
+
+  if (parent != m_Root)
+    m_FetchedChildCounts[parent] = fetchedChildCount + 1;
+
+  return signalled;
+}
+
+void QmitkDataStorageTreeModel::EndInsertChild(bool signalled)
+{
+  if (signalled)
+    this->endInsertRows();
+}
+
+bool QmitkDataStorageTreeModel::BeginRemoveChild(TreeItem *parent, int row)
+{
+  if (m_ResettingModel)
+    return false;
+
+  int fetchedChildCount = this->GetFetchedChildCount(parent);
+  if (row >= fetchedChildCount)
+    return false;
+
+  bool signalled = this->IsVisible(parent);
+  if (signalled)
+    this->beginRemoveRows(this->IndexFromTreeItem(parent), row, row);
+
+  if (parent != m_Root)
+    m_FetchedChildCounts[parent] = fetchedChildCount - 1;
+
+  return signalled;
+}
+
+void QmitkDataStorageTreeModel::EndRemoveChild(bool signalled)
+{
+  if (signalled)
+    this->endRemoveRows();
+}
+
+QmitkDataStorageTreeModel::TreeItem *QmitkDataStorageTreeModel::FindTreeItem(const mitk::DataNode *node) const
+{
+  auto it = m_TreeItems.find(node);
+  return it != m_TreeItems.end() ? it->second : nullptr;
 }
 
 Qt::ItemFlags QmitkDataStorageTreeModel::flags(const QModelIndex &index) const
@@ -239,8 +364,9 @@ bool QmitkDataStorageTreeModel::dropMimeData(
 
     if (listOfItemsToDrop[0] != dropItem && isValidDragAndDropOperation)
     {
-      // Retrieve the index of where we are dropping stuff.
-      QModelIndex parentModelIndex = this->IndexFromTreeItem(parentItem);
+      // the item that receives the dropped items, all of its children are shown while rows are moved
+      TreeItem *targetItem = (m_AllowHierarchyChange || row != -1) ? dropItem : parentItem;
+      this->FetchAllChildren(targetItem);
 
       int dragIndex = 0;
 
@@ -258,10 +384,9 @@ bool QmitkDataStorageTreeModel::dropMimeData(
         }
 
         // Here we assume that as you remove items, one at a time, that GetIndex() will be valid.
-        this->beginRemoveRows(
-          this->IndexFromTreeItem(itemToDrop->GetParent()), itemToDrop->GetIndex(), itemToDrop->GetIndex());
+        bool signalled = this->BeginRemoveChild(itemToDrop->GetParent(), itemToDrop->GetIndex());
         itemToDrop->GetParent()->RemoveChild(itemToDrop);
-        this->endRemoveRows();
+        this->EndRemoveChild(signalled);
       }
 
       // row = -1 dropped on an item, row != -1 dropped  in between two items
@@ -284,16 +409,6 @@ bool QmitkDataStorageTreeModel::dropMimeData(
         dropIndex = parentItem->GetChildCount() - 1;
 
       // Now insert items again at the drop item position
-
-      if (m_AllowHierarchyChange)
-      {
-        this->beginInsertRows(dropItemModelIndex, dropIndex, dropIndex + listOfItemsToDrop.size() - 1);
-      }
-      else
-      {
-        this->beginInsertRows(parentModelIndex, dropIndex, dropIndex + listOfItemsToDrop.size() - 1);
-      }
-
       for (diIter = listOfItemsToDrop.begin(); diIter != listOfItemsToDrop.end(); diIter++)
       {
         // dropped on node, behaviour depends on preference setting
@@ -307,24 +422,16 @@ bool QmitkDataStorageTreeModel::dropMimeData(
           dataStorage->Remove(droppedNode);
           dataStorage->Add(droppedNode, dropOntoNode);
           m_BlockDataStorageEvents = false;
-
-          dropItem->InsertChild((*diIter), dropIndex);
-        }
-        else
-        {
-          if (row == -1) // drag onto a node
-          {
-            parentItem->InsertChild((*diIter), dropIndex);
-          }
-          else // drag between nodes
-          {
-            dropItem->InsertChild((*diIter), dropIndex);
-          }
         }
 
+        // InsertChild() appends if the index is out of range, the row signals have to use the actual row
+        int insertRow = std::min(dropIndex, targetItem->GetChildCount());
+        bool signalled = this->BeginInsertChild(targetItem, insertRow);
+        targetItem->InsertChild((*diIter), insertRow);
+        this->EndInsertChild(signalled);
+
         dropIndex++;
       }
-      this->endInsertRows();
 
       // Change Layers to match.
       this->AdjustLayerProperty();
@@ -525,18 +632,22 @@ void QmitkDataStorageTreeModel::SetDataStorage(mitk::DataStorage *_DataStorage)
       dataStorage->RemoveNodeEvent.RemoveListener(
         mitk::MessageDelegate1<QmitkDataStorageTreeModel, const mitk::DataNode *>(
           this, &QmitkDataStorageTreeModel::RemoveNode));
+
+      dataStorage->AddNodesEvent.RemoveListener(
+        mitk::MessageDelegate1<QmitkDataStorageTreeModel, const mitk::DataStorage::SetOfObjects *>(
+          this, &QmitkDataStorageTreeModel::AddNodes));
+
+      dataStorage->RemoveNodesEvent.RemoveListener(
+        mitk::MessageDelegate1<QmitkDataStorageTreeModel, const mitk::DataStorage::SetOfObjects *>(
+          this, &QmitkDataStorageTreeModel::RemoveNodes));
     }
 
     // take over the new data storage
     m_DataStorage = _DataStorage;
 
     // delete the old root (if necessary, create new)
-    if (m_Root)
-      m_Root->Delete();
-    mitk::DataNode::Pointer rootDataNode = mitk::DataNode::New();
-    rootDataNode->SetName("Data Manager");
-    m_Root = new TreeItem(rootDataNode, nullptr);
     this->beginResetModel();
+    this->ResetTree();
     this->endResetModel();
 
     if (!m_DataStorage.IsExpired())
@@ -560,7 +671,13 @@ void QmitkDataStorageTreeModel::SetDataStorage(mitk::DataStorage *_DataStorage)
         mitk::MessageDelegate1<QmitkDataStorageTreeModel, const mitk::DataNode *>(
           this, &QmitkDataStorageTreeModel::RemoveNode));
 
-      mitk::DataStorage::SetOfObjects::ConstPointer _NodeSet = dataStorage->GetSubset(m_Predicate);
+      dataStorage->AddNodesEvent.AddListener(
+        mitk::MessageDelegate1<QmitkDataStorageTreeModel, const mitk::DataStorage::SetOfObjects *>(
+          this, &QmitkDataStorageTreeModel::AddNodes));
+
+      dataStorage->RemoveNodesEvent.AddListener(
+        mitk::MessageDelegate1<QmitkDataStorageTreeModel, const mitk::DataStorage::SetOfObjects *>(
+          this, &QmitkDataStorageTreeModel::RemoveNodes));
 
       // finally add all nodes to the model
       this->Update();
@@ -573,39 +690,43 @@ void QmitkDataStorageTreeModel::SetDataStorageDeleted()
   this->SetDataStorage(nullptr);
 }
 
+void QmitkDataStorageTreeModel::ResetTree()
+{
+  if (m_Root)
+    m_Root->Delete();
+  m_TreeItems.clear();
+  m_FetchedChildCounts.clear();
+  m_ModifiedNodes.clear();
+
+  mitk::DataNode::Pointer rootDataNode = mitk::DataNode::New();
+  rootDataNode->SetName("Data Manager");
+  m_Root = new TreeItem(rootDataNode, nullptr);
+}
+
 void QmitkDataStorageTreeModel::AddNodeInternal(const mitk::DataNode *node)
 {
-  if (node == nullptr || m_DataStorage.IsExpired() || !m_DataStorage.Lock()->Exists(node) || m_Root->Find(node) != nullptr)
+  if (node == nullptr || m_DataStorage.IsExpired() || !m_DataStorage.Lock()->Exists(node) || this->FindTreeItem(node) != nullptr)
     return;
 
   // find out if we have a root node
   TreeItem *parentTreeItem = m_Root;
-  QModelIndex index;
   mitk::DataNode *parentDataNode = this->GetParentNode(node);
 
   if (parentDataNode) // no top level data node
   {
-    parentTreeItem = m_Root->Find(parentDataNode); // find the corresponding tree item
+    parentTreeItem = this->FindTreeItem(parentDataNode); // find the corresponding tree item
     if (!parentTreeItem)
     {
-      this->AddNode(parentDataNode);
-      parentTreeItem = m_Root->Find(parentDataNode);
+      this->AddNodeInternal(parentDataNode);
+      parentTreeItem = this->FindTreeItem(parentDataNode);
       if (!parentTreeItem)
         return;
     }
-
-    // get the index of this parent with the help of the grand parent
-    index = this->createIndex(parentTreeItem->GetIndex(), 0, parentTreeItem);
   }
 
   // add node
-  if (m_PlaceNewNodesOnTop)
-  {
-    // emit beginInsertRows event
-    beginInsertRows(index, 0, 0);
-    parentTreeItem->InsertChild(new TreeItem(const_cast<mitk::DataNode *>(node)), 0);
-  }
-  else
+  int row = 0;
+  if (!m_PlaceNewNodesOnTop)
   {
     int firstRowWithASiblingBelow = 0;
     int nodeLayer = -1;
@@ -623,14 +744,17 @@ void QmitkDataStorageTreeModel::AddNodeInternal(const mitk::DataNode *node)
       }
       ++firstRowWithASiblingBelow;
     }
-    beginInsertRows(index, firstRowWithASiblingBelow, firstRowWithASiblingBelow);
-    parentTreeItem->InsertChild(new TreeItem(const_cast<mitk::DataNode*>(node)), firstRowWithASiblingBelow);
+    row = firstRowWithASiblingBelow;
   }
 
-  // emit endInsertRows event
-  endInsertRows();
+  // only emits the row signals if the row is visible in views
+  bool signalled = this->BeginInsertChild(parentTreeItem, row);
+  auto treeItem = new TreeItem(const_cast<mitk::DataNode *>(node));
+  parentTreeItem->InsertChild(treeItem, row);
+  m_TreeItems[node] = treeItem;
+  this->EndInsertChild(signalled);
 
-  if(m_PlaceNewNodesOnTop)
+  if(m_PlaceNewNodesOnTop && !m_ResettingModel)
   {
     this->AdjustLayerProperty();
   }
@@ -639,7 +763,11 @@ void QmitkDataStorageTreeModel::AddNodeInternal(const mitk::DataNode *node)
 void QmitkDataStorageTreeModel::AddNode(const mitk::DataNode *node)
 {
   if (node == nullptr || m_BlockDataStorageEvents || m_DataStorage.IsExpired() || !m_DataStorage.Lock()->Exists(node) ||
-      m_Root->Find(node) != nullptr)
+      this->FindTreeItem(node) != nullptr)
+    return;
+
+  // batch updates are handled once in AddNodes()
+  if (m_DataStorage.Lock()->IsBatchUpdateActive())
     return;
 
   this->AddNodeInternal(node);
@@ -655,37 +783,38 @@ void QmitkDataStorageTreeModel::RemoveNodeInternal(const mitk::DataNode *node)
   if (!m_Root)
     return;
 
-  TreeItem *treeItem = m_Root->Find(node);
+  TreeItem *treeItem = this->FindTreeItem(node);
   if (!treeItem)
     return; // return because there is no treeitem containing this node
 
   TreeItem *parentTreeItem = treeItem->GetParent();
-  QModelIndex parentIndex = this->IndexFromTreeItem(parentTreeItem);
 
-  // emit beginRemoveRows event (QModelIndex is empty because we dont have a tree model)
-  this->beginRemoveRows(parentIndex, treeItem->GetIndex(), treeItem->GetIndex());
+  // emit beginRemoveRows event, if the row is visible in views
+  bool signalled = this->BeginRemoveChild(parentTreeItem, treeItem->GetIndex());
 
   // remove node
   std::vector<TreeItem *> children = treeItem->GetChildren();
+  m_TreeItems.erase(node);
+  m_FetchedChildCounts.erase(treeItem);
+  m_ModifiedNodes.erase(node);
   delete treeItem;
 
   // emit endRemoveRows event
-  endRemoveRows();
+  this->EndRemoveChild(signalled);
 
   // move all children of deleted node into its parent
   for (std::vector<TreeItem *>::iterator it = children.begin(); it != children.end(); it++)
   {
-    // emit beginInsertRows event
-    beginInsertRows(parentIndex, parentTreeItem->GetChildCount(), parentTreeItem->GetChildCount());
+    signalled = this->BeginInsertChild(parentTreeItem, parentTreeItem->GetChildCount());
 
     // add nodes again
     parentTreeItem->AddChild(*it);
 
-    // emit endInsertRows event
-    endInsertRows();
+    this->EndInsertChild(signalled);
   }
 
-  this->AdjustLayerProperty();
+  if (!m_ResettingModel)
+    this->AdjustLayerProperty();
 }
 
 void QmitkDataStorageTreeModel::RemoveNode(const mitk::DataNode *node)
@@ -693,22 +822,100 @@ void QmitkDataStorageTreeModel::RemoveNode(const mitk::DataNode *node)
   if (node == nullptr || m_BlockDataStorageEvents)
     return;
 
+  // batch updates are handled once in RemoveNodes()
+  if (!m_DataStorage.IsExpired() && m_DataStorage.Lock()->IsBatchUpdateActive())
+    return;
+
   this->RemoveNodeInternal(node);
 }
 
+void QmitkDataStorageTreeModel::AddNodes(const mitk::DataStorage::SetOfObjects *nodes)
+{
+  if (nodes == nullptr || m_BlockDataStorageEvents || m_DataStorage.IsExpired())
+    return;
+
+  // a single reset is much cheaper for attached views than a row insertion per node
+  this->beginResetModel();
+  m_ResettingModel = true;
+  for (const auto &node : *nodes)
+  {
+    this->AddNodeInternal(node);
+  }
+  m_ResettingModel = false;
+  // views collapse all items on reset, children are fetched again when they are expanded
+  m_FetchedChildCounts.clear();
+  this->endResetModel();
+
+  if (m_PlaceNewNodesOnTop)
+  {
+    this->AdjustLayerProperty();
+  }
+}
+
+void QmitkDataStorageTreeModel::RemoveNodes(const mitk::DataStorage::SetOfObjects *nodes)
+{
+  if (nodes == nullptr || m_BlockDataStorageEvents || !m_Root)
+    return;
+
+  this->beginResetModel();
+  m_ResettingModel = true;
+  for (const auto &node : *nodes)
+  {
+    this->RemoveNodeInternal(node);
+  }
+  m_ResettingModel = false;
+  m_FetchedChildCounts.clear();
+  this->endResetModel();
+
+  this->AdjustLayerProperty();
+}
+
 void QmitkDataStorageTreeModel::SetNodeModified(const mitk::DataNode *node)
 {
-  TreeItem *treeItem = m_Root->Find(node);
-  if (treeItem)
+  if (this->FindTreeItem(node) == nullptr)
+    return;
+
+  // the timer is not restarted, so that continuous modifications are still shown every ModifiedNodesDelay
+  m_ModifiedNodes.insert(node);
+  if (!m_ModifiedNodesTimer.isActive())
+    m_ModifiedNodesTimer.start();
+}
+
+void QmitkDataStorageTreeModel::EmitModifiedNodes()
+{
+  // collect the visible rows per parent, consecutive rows are combined into one dataChanged signal
+  std::map<TreeItem *, std::vector<int>> modifiedRows;
+  for (auto node : m_ModifiedNodes)
   {
-    TreeItem *parentTreeItem = treeItem->GetParent();
+    TreeItem *treeItem = this->FindTreeItem(node);
     // as the root node should not be removed one should always have a parent item
-    if (!parentTreeItem)
-      return;
-    QModelIndex index = this->createIndex(treeItem->GetIndex(), 0, treeItem);
+    if (treeItem == nullptr || treeItem->GetParent() == nullptr)
+      continue;
 
-    // now emit the dataChanged signal
-    emit dataChanged(index, index);
+    TreeItem *parentTreeItem = treeItem->GetParent();
+    int row = treeItem->GetIndex();
+    if (row < this->GetFetchedChildCount(parentTreeItem) && this->IsVisible(parentTreeItem))
+      modifiedRows[parentTreeItem].push_back(row);
+  }
+  m_ModifiedNodes.clear();
+
+  for (auto &parentRows : modifiedRows)
+  {
+    TreeItem *parentTreeItem = parentRows.first;
+    std::vector<int> &rows = parentRows.second;
+    std::sort(rows.begin(), rows.end());
+
+    std::size_t first = 0;
+    for (std::size_t i = 1; i <= rows.size(); ++i)
+    {
+      if (i == rows.size() || rows[i] != rows[i - 1] + 1)
+      {
+        QModelIndex topLeft = this->createIndex(rows[first], 0, parentTreeItem->GetChild(rows[first]));
+        QModelIndex bottomRight = this->createIndex(rows[i - 1], 0, parentTreeItem->GetChild(rows[i - 1]));
+        emit dataChanged(topLeft, bottomRight);
+        first = i;
+      }
+    }
   }
 }
 
@@ -775,7 +982,10 @@ void QmitkDataStorageTreeModel::AdjustLayerProperty()
     mitk::DataNode::Pointer dataNode = (*it)->GetDataNode();
     bool fixedLayer = false;
 
-    if (!(dataNode->GetBoolProperty("fixedLayer", fixedLayer) && fixedLayer))
+    // only changed layers are set, each modification of a node is propagated to all DataStorage listeners
+    int layer = 0;
+    if (!(dataNode->GetBoolProperty("fixedLayer", fixedLayer) && fixedLayer) &&
+        !(dataNode->GetIntProperty("layer", layer) && layer == i))
       dataNode->SetIntProperty("layer", i);
 
     --i;
@@ -826,9 +1036,23 @@ QModelIndex QmitkDataStorageTreeModel::GetIndex(const mitk::DataNode *node) cons
 {
   if (m_Root)
   {
-    TreeItem *item = m_Root->Find(node);
+    TreeItem *item = this->FindTreeItem(node);
     if (item)
+    {
+      // the index has to be valid for views, i.e. the node and its ancestors must have been fetched
+      std::vector<TreeItem *> ancestors;
+      for (TreeItem *ancestor = item->GetParent(); ancestor != m_Root; ancestor = ancestor->GetParent())
+        ancestors.push_back(ancestor);
+
+      auto self = const_cast<QmitkDataStorageTreeModel *>(this);
+      for (auto it = ancestors.rbegin(); it != ancestors.rend(); ++it)
+      {
+        TreeItem *child = (it + 1) != ancestors.rend() ? *(it + 1) : item;
+        while (child->GetIndex() >= this->GetFetchedChildCount(*it))
+          self->fetchMore(this->IndexFromTreeItem(*it));
+      }
       return this->IndexFromTreeItem(item);
+    }
   }
   return QModelIndex();
 }
@@ -866,10 +1090,16 @@ void QmitkDataStorageTreeModel::Update()
     bool newNodesWereToBePlacedOnTop = m_PlaceNewNodesOnTop;
     m_PlaceNewNodesOnTop = false;
 
+    /// A single reset instead of row signals per node, the children are fetched by views on demand.
+    this->beginResetModel();
+    m_ResettingModel = true;
     for (const auto& node: *_NodeSet)
     {
       this->AddNodeInternal(node);
     }
+    m_ResettingModel = false;
+    m_FetchedChildCounts.clear();
+    this->endResetModel();
 
     m_PlaceNewNodesOnTop = newNodesWereToBePlacedOnTop;
 
@@ -45,6 +45,17 @@ void QmitkRenderingManager::GenerateRenderingRequestEvent()
   QApplication::postEvent(this, new QmitkRenderingRequestEvent);
 }
 
+bool QmitkRenderingManager::GenerateDelayedRenderingRequestEvent(unsigned int milliseconds)
+{
+  QTimer::singleShot(milliseconds, this, SLOT(DelayedRenderingRequestCallback()));
+  return true;
+}
+
+void QmitkRenderingManager::DelayedRenderingRequestCallback()
+{
+  this->GenerateRenderingRequestEvent();
+}
+
 void QmitkRenderingManager::StartOrResetTimer()
 {
   QTimer::singleShot(200, this, SLOT(TimerCallback()));
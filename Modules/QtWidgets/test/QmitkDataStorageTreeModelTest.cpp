@@ -0,0 +1,149 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <QmitkDataStorageTreeModel.h>
+#include <mitkStandaloneDataStorage.h>
+
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+namespace
+{
+  // more than two fetch batches
+  const int NumberOfChildren = 250;
+}
+
+//! Tests for QmitkDataStorageTreeModel
+class QmitkDataStorageTreeModelTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(QmitkDataStorageTreeModelTestSuite);
+  MITK_TEST(TopLevelNodesTest);
+  MITK_TEST(FetchMoreTest);
+  MITK_TEST(IncrementalUpdateTest);
+  MITK_TEST(GetIndexFetchesTest);
+  MITK_TEST(RemoveParentTest);
+  CPPUNIT_TEST_SUITE_END();
+
+  mitk::DataStorage::Pointer m_DataStorage;
+  mitk::DataNode::Pointer m_ParentNode;
+  std::vector<mitk::DataNode::Pointer> m_ChildNodes;
+
+  mitk::DataNode::Pointer CreateNode(const std::string &name)
+  {
+    mitk::DataNode::Pointer node = mitk::DataNode::New();
+    node->SetName(name);
+    return node;
+  }
+
+public:
+  void setUp() override
+  {
+    m_DataStorage = mitk::StandaloneDataStorage::New();
+    m_ParentNode = this->CreateNode("parent");
+    m_DataStorage->Add(m_ParentNode);
+    m_DataStorage->Add(this->CreateNode("sibling"));
+
+    m_ChildNodes.clear();
+    for (int i = 0; i < NumberOfChildren; ++i)
+    {
+      m_ChildNodes.push_back(this->CreateNode("child" + std::to_string(i)));
+      m_DataStorage->Add(m_ChildNodes.back(), m_ParentNode);
+    }
+  }
+
+  void tearDown() override
+  {
+    m_ChildNodes.clear();
+    m_ParentNode = nullptr;
+    m_DataStorage = nullptr;
+  }
+
+  void TopLevelNodesTest()
+  {
+    QmitkDataStorageTreeModel model(m_DataStorage);
+    CPPUNIT_ASSERT_EQUAL(2, model.rowCount());
+    CPPUNIT_ASSERT(!model.canFetchMore(QModelIndex()));
+    CPPUNIT_ASSERT_EQUAL(NumberOfChildren + 2, model.GetNodeSet().size());
+  }
+
+  //! The children of a node are only reported after fetchMore()
+  void FetchMoreTest()
+  {
+    QmitkDataStorageTreeModel model(m_DataStorage);
+    QModelIndex parentIndex = model.GetIndex(m_ParentNode);
+    CPPUNIT_ASSERT(parentIndex.isValid());
+
+    CPPUNIT_ASSERT(model.hasChildren(parentIndex));
+    CPPUNIT_ASSERT_EQUAL(0, model.rowCount(parentIndex));
+    CPPUNIT_ASSERT(!model.index(0, 0, parentIndex).isValid());
+    CPPUNIT_ASSERT(model.canFetchMore(parentIndex));
+
+    model.fetchMore(parentIndex);
+    CPPUNIT_ASSERT_EQUAL(QmitkDataStorageTreeModel::FetchBatchSize, model.rowCount(parentIndex));
+
+    while (model.canFetchMore(parentIndex))
+      model.fetchMore(parentIndex);
+    CPPUNIT_ASSERT_EQUAL(NumberOfChildren, model.rowCount(parentIndex));
+    CPPUNIT_ASSERT(model.index(NumberOfChildren - 1, 0, parentIndex).isValid());
+  }
+
+  //! Nodes added to completely fetched children are shown, others only after fetching
+  void IncrementalUpdateTest()
+  {
+    QmitkDataStorageTreeModel model(m_DataStorage);
+    QModelIndex parentIndex = model.GetIndex(m_ParentNode);
+    while (model.canFetchMore(parentIndex))
+      model.fetchMore(parentIndex);
+
+    m_DataStorage->Add(this->CreateNode("new child"), m_ParentNode);
+    CPPUNIT_ASSERT_EQUAL(NumberOfChildren + 1, model.rowCount(parentIndex));
+
+    m_DataStorage->Remove(m_ChildNodes.front());
+    CPPUNIT_ASSERT_EQUAL(NumberOfChildren, model.rowCount(parentIndex));
+
+    m_DataStorage->Add(this->CreateNode("new top level node"));
+    CPPUNIT_ASSERT_EQUAL(3, model.rowCount());
+
+    QmitkDataStorageTreeModel unfetchedModel(m_DataStorage);
+    QModelIndex unfetchedParentIndex = unfetchedModel.GetIndex(m_ParentNode);
+    m_DataStorage->Add(this->CreateNode("hidden child"), m_ParentNode);
+    CPPUNIT_ASSERT_EQUAL(0, unfetchedModel.rowCount(unfetchedParentIndex));
+    CPPUNIT_ASSERT(unfetchedModel.canFetchMore(unfetchedParentIndex));
+  }
+
+  //! GetIndex() returns indices that are valid for views
+  void GetIndexFetchesTest()
+  {
+    QmitkDataStorageTreeModel model(m_DataStorage);
+    QModelIndex childIndex = model.GetIndex(m_ChildNodes.back());
+    CPPUNIT_ASSERT(childIndex.isValid());
+    CPPUNIT_ASSERT(childIndex.row() < model.rowCount(childIndex.parent()));
+    CPPUNIT_ASSERT(model.GetNode(childIndex) == m_ChildNodes.back());
+    CPPUNIT_ASSERT(model.GetNode(childIndex.parent()) == m_ParentNode);
+  }
+
+  //! The children of a removed node are moved to its parent
+  void RemoveParentTest()
+  {
+    QmitkDataStorageTreeModel model(m_DataStorage);
+    m_DataStorage->Remove(m_ParentNode);
+    CPPUNIT_ASSERT_EQUAL(NumberOfChildren + 1, model.rowCount());
+    CPPUNIT_ASSERT(!model.GetIndex(m_ParentNode).isValid());
+    CPPUNIT_ASSERT(model.GetIndex(m_ChildNodes.front()).isValid());
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(QmitkDataStorageTreeModel)
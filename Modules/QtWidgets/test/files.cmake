@@ -10,4 +10,5 @@ endif()
 
 set(MODULE_TESTS ${MODULE_TESTS}
   QmitkDataStorageListModelTest.cpp
+  QmitkDataStorageTreeModelTest.cpp
 )
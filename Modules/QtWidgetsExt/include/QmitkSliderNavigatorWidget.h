@@ -22,9 +22,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mitkStepper.h>
 
+#include <QElapsedTimer>
 #include <QString>
 #include <QWidget>
 
+class QTimer;
+
 class MITKQTWIDGETSEXT_EXPORT QmitkSliderNavigatorWidget : public QWidget, public Ui::QmitkSliderNavigator
 {
   Q_OBJECT
@@ -55,6 +58,8 @@ public:
 
   bool GetInvertedControls() const;
 
+  bool IsPlaying() const;
+
 public slots:
 
   /**
@@ -81,6 +86,17 @@ public slots:
 
   void SetInvertedControls(bool invertedControls);
 
+  /**
+   * \brief Steps through all positions of the stepper at the given rate, starting over after the last one.
+   *
+   * The position follows the time elapsed since the start rather than the number of timer events, so
+   * positions are skipped if rendering cannot keep up and the playback keeps its speed. Changing the
+   * position during playback continues the playback from there.
+   */
+  void StartPlayback(double stepsPerSecond);
+
+  void StopPlayback();
+
 protected slots:
 
   void slider_valueChanged(double);
@@ -106,6 +122,7 @@ protected slots:
 
   void spinBox_valueChanged(double);
 
+  void OnPlaybackTimeout();
 
 protected:
   bool m_HasLabelUnit;
@@ -121,6 +138,12 @@ protected:
   bool m_InverseDirection;
   bool m_InvertedControls;
 
+  QTimer *m_PlaybackTimer;
+  QElapsedTimer m_PlaybackClock;
+  double m_PlaybackStepsPerSecond;
+  unsigned int m_PlaybackStartPos;
+  unsigned int m_PlaybackPos;
+
 };
 
 #endif
@@ -16,7 +16,17 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "QmitkSliderNavigatorWidget.h"
 
-QmitkSliderNavigatorWidget::QmitkSliderNavigatorWidget(QWidget *parent, Qt::WindowFlags f) : QWidget(parent, f)
+#include <QTimer>
+
+#include <algorithm>
+#include <cmath>
+
+QmitkSliderNavigatorWidget::QmitkSliderNavigatorWidget(QWidget *parent, Qt::WindowFlags f)
+  : QWidget(parent, f),
+    m_PlaybackTimer(new QTimer(this)),
+    m_PlaybackStepsPerSecond(0.0),
+    m_PlaybackStartPos(0),
+    m_PlaybackPos(0)
 {
   this->setupUi(this);
 
@@ -35,6 +45,7 @@ QmitkSliderNavigatorWidget::QmitkSliderNavigatorWidget(QWidget *parent, Qt::Wind
 
   this->connect(m_Slider, SIGNAL(valueChanged(double)), SLOT(slider_valueChanged(double)));
   this->connect(m_SpinBox, SIGNAL(valueChanged(double)), SLOT(spinBox_valueChanged(double)));
+  this->connect(m_PlaybackTimer, SIGNAL(timeout()), SLOT(OnPlaybackTimeout()));
 
   // this avoids trying to use m_Stepper until it is set to something != nullptr
   // (additionally to the avoiding recursions during refetching)
@@ -309,3 +320,55 @@ void QmitkSliderNavigatorWidget::SetInvertedControls(bool invertedControls)
   }
 }
 
+
+bool QmitkSliderNavigatorWidget::IsPlaying() const
+{
+  return m_PlaybackTimer->isActive();
+}
+
+void QmitkSliderNavigatorWidget::StartPlayback(double stepsPerSecond)
+{
+  if (m_Stepper.IsNull() || stepsPerSecond <= 0.0)
+    return;
+
+  m_PlaybackStepsPerSecond = stepsPerSecond;
+  m_PlaybackStartPos = m_Stepper->GetPos();
+  m_PlaybackPos = m_PlaybackStartPos;
+  m_PlaybackClock.start();
+
+  // the timer only samples the clock, a late timeout skips positions instead of slowing down the playback
+  m_PlaybackTimer->start(std::max(1, static_cast<int>(1000.0 / stepsPerSecond)));
+}
+
+void QmitkSliderNavigatorWidget::StopPlayback()
+{
+  m_PlaybackTimer->stop();
+}
+
+void QmitkSliderNavigatorWidget::OnPlaybackTimeout()
+{
+  if (m_Stepper.IsNull() || m_Stepper->GetSteps() < 2)
+  {
+    this->StopPlayback();
+    return;
+  }
+
+  if (m_Stepper->GetPos() != m_PlaybackPos)
+  {
+    // the position was changed by the user meanwhile
+    m_PlaybackStartPos = m_Stepper->GetPos();
+    m_PlaybackPos = m_PlaybackStartPos;
+    m_PlaybackClock.restart();
+    return;
+  }
+
+  const double elapsedSteps = std::floor(m_PlaybackClock.elapsed() / 1000.0 * m_PlaybackStepsPerSecond);
+  const unsigned int pos =
+    static_cast<unsigned int>(std::fmod(m_PlaybackStartPos + elapsedSteps, static_cast<double>(m_Stepper->GetSteps())));
+  if (pos != m_PlaybackPos)
+  {
+    m_PlaybackPos = pos;
+    m_Stepper->SetPos(pos);
+    this->Refetch();
+  }
+}
@@ -14,6 +14,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 ===================================================================*/
 
+#include <algorithm>
 #include <mitkACVD.h>
 #include <mitkIOUtil.h>
 #include <mitkTestingMacros.h>
@@ -103,6 +104,48 @@ static void Remesh_SurfaceIsValid_ReturnsRemeshedSurface(const std::string &file
                       "Remesh_SurfaceIsValid_ReturnsRemeshedSurface")
 }
 
+static void RemeshFilter_NumVerticesChanged_ReturnsRemeshedSurfaces(const std::string &filename,
+                                                                    unsigned int t,
+                                                                    int numVertices,
+                                                                    double gradation,
+                                                                    int subsampling,
+                                                                    double edgeSplitting,
+                                                                    int optimizationLevel,
+                                                                    bool forceManifold,
+                                                                    bool boundaryFixing)
+{
+  auto surface = mitk::IOUtil::Load<mitk::Surface>(filename);
+
+  mitk::ACVD::RemeshFilter::Pointer remesher = mitk::ACVD::RemeshFilter::New();
+  remesher->SetInput(surface);
+  remesher->SetTimeStep(t);
+  remesher->SetNumVertices(numVertices);
+  remesher->SetGradation(gradation);
+  remesher->SetSubsampling(subsampling);
+  remesher->SetEdgeSplitting(edgeSplitting);
+  remesher->SetOptimizationLevel(optimizationLevel);
+  remesher->SetForceManifold(forceManifold);
+  remesher->SetBoundaryFixing(boundaryFixing);
+  remesher->Update();
+
+  mitk::Surface::Pointer firstSurface = remesher->GetOutput();
+  firstSurface->DisconnectPipeline();
+
+  // The second update reuses the prepared input
+  remesher->SetNumVertices(std::max(numVertices / 2, 100));
+  remesher->Update();
+
+  mitk::Surface::Pointer secondSurface = remesher->GetOutput();
+
+  MITK_TEST_CONDITION(firstSurface->GetVtkPolyData() != nullptr &&
+                        firstSurface->GetVtkPolyData()->GetNumberOfPolys() != 0 &&
+                        secondSurface->GetVtkPolyData() != nullptr &&
+                        secondSurface->GetVtkPolyData()->GetNumberOfPolys() != 0 &&
+                        secondSurface->GetVtkPolyData()->GetNumberOfPoints() <
+                          firstSurface->GetVtkPolyData()->GetNumberOfPoints(),
+                      "RemeshFilter_NumVerticesChanged_ReturnsRemeshedSurfaces")
+}
+
 int mitkACVDTest(int argc, char *argv[])
 {
   if (argc != 10)
@@ -138,5 +181,8 @@ int mitkACVDTest(int argc, char *argv[])
   Remesh_SurfaceIsValid_ReturnsRemeshedSurface(
     filename, t, numVertices, gradation, subsampling, edgeSplitting, optimizationLevel, forceManifold, boundaryFixing);
 
+  RemeshFilter_NumVerticesChanged_ReturnsRemeshedSurfaces(
+    filename, t, numVertices, gradation, subsampling, edgeSplitting, optimizationLevel, forceManifold, boundaryFixing);
+
   MITK_TEST_END()
 }
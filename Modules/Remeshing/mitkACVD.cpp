@@ -16,42 +16,92 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkACVD.h"
 #include <mitkExceptionMacro.h>
+#include <mitkTaskScheduler.h>
 #include <vtkIdList.h>
 #include <vtkIntArray.h>
 #include <vtkIsotropicDiscreteRemeshing.h>
+#include <vtkLinearSubdivisionFilter.h>
 #include <vtkMultiThreader.h>
 #include <vtkPolyData.h>
 #include <vtkPolyDataNormals.h>
 #include <vtkSmartPointer.h>
 #include <vtkSurface.h>
+#include <vtkTriangleFilter.h>
 
-struct ClustersQuadrics
+#include <algorithm>
+#include <array>
+#include <vector>
+
+class mitk::ACVD::PreparedInput
 {
-  explicit ClustersQuadrics(int size) : Elements(new double *[size]), Size(size)
-  {
-    for (int i = 0; i < size; ++i)
-    {
-      Elements[i] = new double[9];
+public:
+  PreparedInput() : m_PolyData(nullptr), m_MTime(0), m_EdgeSplitting(0.0) {}
 
-      for (int j = 0; j < 9; ++j)
-        Elements[i][j] = 0.0;
-    }
+  bool IsPreparedFrom(const vtkPolyData *polyData, double edgeSplitting) const
+  {
+    return !m_Levels.empty() && polyData == m_PolyData && polyData->GetMTime() == m_MTime &&
+           edgeSplitting == m_EdgeSplitting;
   }
 
-  ~ClustersQuadrics()
+  void Prepare(vtkPolyData *polyData, double edgeSplitting)
   {
-    for (int i = 0; i < Size; ++i)
-      delete[] Elements[i];
+    m_PolyData = polyData;
+    m_MTime = polyData->GetMTime();
+    m_EdgeSplitting = edgeSplitting;
+    m_Levels.clear();
+
+    vtkSmartPointer<vtkPolyData> surfacePolyData = vtkSmartPointer<vtkPolyData>::New();
+    surfacePolyData->DeepCopy(polyData);
+
+    vtkSmartPointer<vtkSurface> mesh = vtkSmartPointer<vtkSurface>::New();
 
-    delete Elements;
+    mesh->CreateFromPolyData(surfacePolyData);
+    mesh->GetCellData()->Initialize();
+    mesh->GetPointData()->Initialize();
+
+    mesh->DisplayMeshProperties();
+
+    if (edgeSplitting != 0.0)
+      mesh->SplitLongEdges(edgeSplitting);
+
+    m_Levels.push_back(mesh.GetPointer());
   }
 
-  double **Elements;
-  int Size;
+  /** \brief Returns the least subdivided level with at least numPoints points, subdividing further if necessary. */
+  vtkPolyData *GetSubdivision(vtkIdType numPoints)
+  {
+    for (const auto &level : m_Levels)
+    {
+      if (level->GetNumberOfPoints() >= numPoints)
+        return level;
+    }
+
+    while (m_Levels.back()->GetNumberOfPoints() < numPoints)
+    {
+      vtkSmartPointer<vtkTriangleFilter> triangles = vtkSmartPointer<vtkTriangleFilter>::New();
+      triangles->SetInputData(m_Levels.back());
+
+      vtkSmartPointer<vtkLinearSubdivisionFilter> subdivision = vtkSmartPointer<vtkLinearSubdivisionFilter>::New();
+      subdivision->SetInputConnection(triangles->GetOutputPort());
+      subdivision->SetNumberOfSubdivisions(1);
+      subdivision->Update();
+
+      vtkSmartPointer<vtkPolyData> level = subdivision->GetOutput();
+
+      if (level->GetNumberOfPoints() <= m_Levels.back()->GetNumberOfPoints())
+        break;
+
+      m_Levels.push_back(level);
+    }
+
+    return m_Levels.back();
+  }
 
 private:
-  ClustersQuadrics(const ClustersQuadrics &);
-  ClustersQuadrics &operator=(const ClustersQuadrics &);
+  const vtkPolyData *m_PolyData;
+  vtkMTimeType m_MTime;
+  double m_EdgeSplitting;
+  std::vector<vtkSmartPointer<vtkPolyData>> m_Levels;
 };
 
 static void ValidateSurface(mitk::Surface::ConstPointer surface, unsigned int t)
@@ -71,105 +121,154 @@ static void ValidateSurface(mitk::Surface::ConstPointer surface, unsigned int t)
     mitkThrow() << "Input surface has no polygons at time step " << t << "!";
 }
 
-mitk::Surface::Pointer mitk::ACVD::Remesh(mitk::Surface::ConstPointer surface,
-                                          unsigned int t,
-                                          int numVertices,
-                                          double gradation,
-                                          int subsampling,
-                                          double edgeSplitting,
-                                          int optimizationLevel,
-                                          bool forceManifold,
-                                          bool boundaryFixing)
+// Moves the remeshed vertices to the points minimizing the quadric error of their clusters.
+static void OptimizeClusterPositions(vtkIsotropicDiscreteRemeshing *remesher, int numVertices, int optimizationLevel)
 {
-  ValidateSurface(surface, t);
-
-  MITK_INFO << "Start remeshing...";
+  vtkSmartPointer<vtkIntArray> clustering = remesher->GetClustering();
+  vtkSmartPointer<vtkSurface> remesherInput = remesher->GetInput();
+  vtkSmartPointer<vtkSurface> remesherOutput = remesher->GetOutput();
+  const int clusteringType = remesher->GetClusteringType();
+  const int numItems = remesher->GetNumberOfItems();
+  int numMisclassifiedItems = 0;
 
-  vtkSmartPointer<vtkPolyData> surfacePolyData = vtkSmartPointer<vtkPolyData>::New();
-  surfacePolyData->DeepCopy(const_cast<Surface *>(surface.GetPointer())->GetVtkPolyData(t));
+  // Partition the input by cluster, so that every cluster is processed by a single task without any locking
+  std::vector<int> clusterOffsets(numVertices + 1, 0);
 
-  vtkSmartPointer<vtkSurface> mesh = vtkSmartPointer<vtkSurface>::New();
+  for (int i = 0; i < numItems; ++i)
+  {
+    int cluster = clustering->GetValue(i);
 
-  mesh->CreateFromPolyData(surfacePolyData);
-  mesh->GetCellData()->Initialize();
-  mesh->GetPointData()->Initialize();
+    if (cluster >= 0 && cluster < numVertices)
+      ++clusterOffsets[cluster + 1];
+    else
+      ++numMisclassifiedItems;
+  }
 
-  mesh->DisplayMeshProperties();
+  if (numMisclassifiedItems != 0)
+    std::cout << numMisclassifiedItems << " items with wrong cluster association" << std::endl;
 
-  if (numVertices == 0)
-    numVertices = surfacePolyData->GetNumberOfPoints();
+  for (int i = 0; i < numVertices; ++i)
+    clusterOffsets[i + 1] += clusterOffsets[i];
 
-  if (edgeSplitting != 0.0)
-    mesh->SplitLongEdges(edgeSplitting);
+  std::vector<int> clusterItems(clusterOffsets[numVertices]);
+  std::vector<int> insertPositions(clusterOffsets.begin(), clusterOffsets.end() - 1);
 
-  vtkSmartPointer<vtkIsotropicDiscreteRemeshing> remesher = vtkSmartPointer<vtkIsotropicDiscreteRemeshing>::New();
-
-  remesher->GetMetric()->SetGradation(gradation);
-  remesher->SetBoundaryFixing(boundaryFixing);
-  remesher->SetConsoleOutput(1);
-  remesher->SetForceManifold(forceManifold);
-  remesher->SetInput(mesh);
-  remesher->SetNumberOfClusters(numVertices);
-  remesher->SetNumberOfThreads(vtkMultiThreader::GetGlobalDefaultNumberOfThreads());
-  remesher->SetSubsamplingThreshold(subsampling);
+  for (int i = 0; i < numItems; ++i)
+  {
+    int cluster = clustering->GetValue(i);
 
-  remesher->Remesh();
+    if (cluster >= 0 && cluster < numVertices)
+      clusterItems[insertPositions[cluster]++] = i;
+  }
 
-  // Optimization: Minimize distance between input surface and remeshed surface
-  if (optimizationLevel != 0)
-  {
-    ClustersQuadrics clustersQuadrics(numVertices);
+  std::vector<std::array<double, 3>> points(numVertices);
 
+  auto optimizeClusters = [&](int begin, int end) {
     vtkSmartPointer<vtkIdList> faceList = vtkSmartPointer<vtkIdList>::New();
-    vtkSmartPointer<vtkIntArray> clustering = remesher->GetClustering();
-    vtkSmartPointer<vtkSurface> remesherInput = remesher->GetInput();
-    int clusteringType = remesher->GetClusteringType();
-    int numItems = remesher->GetNumberOfItems();
-    int numMisclassifiedItems = 0;
+    double quadric[9];
 
-    for (int i = 0; i < numItems; ++i)
+    for (int cluster = begin; cluster < end; ++cluster)
     {
-      int cluster = clustering->GetValue(i);
+      std::fill(quadric, quadric + 9, 0.0);
 
-      if (cluster >= 0 && cluster < numVertices)
+      for (int j = clusterOffsets[cluster]; j < clusterOffsets[cluster + 1]; ++j)
       {
+        const int item = clusterItems[j];
+
         if (clusteringType != 0)
         {
-          remesherInput->GetVertexNeighbourFaces(i, faceList);
+          remesherInput->GetVertexNeighbourFaces(item, faceList);
           int numIds = static_cast<int>(faceList->GetNumberOfIds());
 
-          for (int j = 0; j < numIds; ++j)
-            vtkQuadricTools::AddTriangleQuadric(
-              clustersQuadrics.Elements[cluster], remesherInput, faceList->GetId(j), false);
+          for (int k = 0; k < numIds; ++k)
+            vtkQuadricTools::AddTriangleQuadric(quadric, remesherInput, faceList->GetId(k), false);
         }
         else
         {
-          vtkQuadricTools::AddTriangleQuadric(clustersQuadrics.Elements[cluster], remesherInput, i, false);
+          vtkQuadricTools::AddTriangleQuadric(quadric, remesherInput, item, false);
         }
       }
-      else
-      {
-        ++numMisclassifiedItems;
-      }
+
+      remesherOutput->GetPoint(cluster, points[cluster].data());
+      vtkQuadricTools::ComputeRepresentativePoint(quadric, points[cluster].data(), optimizationLevel);
     }
+  };
 
-    if (numMisclassifiedItems != 0)
-      std::cout << numMisclassifiedItems << " items with wrong cluster association" << std::endl;
+  mitk::TaskScheduler *scheduler = mitk::TaskScheduler::GetInstance();
+  const int numChunks = std::max(1, std::min(numVertices, 4 * static_cast<int>(scheduler->GetNumberOfThreads())));
+  const int clustersPerChunk = (numVertices + numChunks - 1) / numChunks;
 
-    vtkSmartPointer<vtkSurface> remesherOutput = remesher->GetOutput();
-    double point[3];
+  std::vector<mitk::TaskScheduler::TaskPointer> tasks;
 
-    for (int i = 0; i < numVertices; ++i)
-    {
-      remesherOutput->GetPoint(i, point);
-      vtkQuadricTools::ComputeRepresentativePoint(clustersQuadrics.Elements[i], point, optimizationLevel);
-      remesherOutput->SetPointCoordinates(i, point);
-    }
+  for (int begin = 0; begin < numVertices; begin += clustersPerChunk)
+  {
+    const int end = std::min(numVertices, begin + clustersPerChunk);
+    tasks.push_back(scheduler->Submit([&optimizeClusters, begin, end]() { optimizeClusters(begin, end); }));
+  }
+
+  for (const auto &task : tasks)
+    task->Wait();
+
+  // The output is modified by a single thread only
+  for (int i = 0; i < numVertices; ++i)
+    remesherOutput->SetPointCoordinates(i, points[i].data());
+
+  std::cout << "After quadrics post-processing:" << std::endl;
+  remesherOutput->DisplayMeshProperties();
+}
+
+static mitk::Surface::Pointer Remesh(mitk::ACVD::PreparedInput &preparedInput,
+                                     mitk::Surface::ConstPointer surface,
+                                     unsigned int t,
+                                     int numVertices,
+                                     double gradation,
+                                     int subsampling,
+                                     double edgeSplitting,
+                                     int optimizationLevel,
+                                     bool forceManifold,
+                                     bool boundaryFixing)
+{
+  ValidateSurface(surface, t);
 
-    std::cout << "After quadrics post-processing:" << std::endl;
-    remesherOutput->DisplayMeshProperties();
+  MITK_INFO << "Start remeshing...";
+
+  vtkPolyData *polyData = const_cast<mitk::Surface *>(surface.GetPointer())->GetVtkPolyData(t);
+
+  if (preparedInput.IsPreparedFrom(polyData, edgeSplitting))
+  {
+    MITK_INFO << "Reusing prepared input surface";
+  }
+  else
+  {
+    preparedInput.Prepare(polyData, edgeSplitting);
   }
 
+  if (numVertices == 0)
+    numVertices = polyData->GetNumberOfPoints();
+
+  // Subsampling is done here instead of by the remesher, so that the subdivided surface can be reused
+  vtkPolyData *subdivision = preparedInput.GetSubdivision(static_cast<vtkIdType>(subsampling) * numVertices);
+
+  vtkSmartPointer<vtkSurface> mesh = vtkSmartPointer<vtkSurface>::New();
+  mesh->CreateFromPolyData(subdivision);
+
+  vtkSmartPointer<vtkIsotropicDiscreteRemeshing> remesher = vtkSmartPointer<vtkIsotropicDiscreteRemeshing>::New();
+
+  remesher->GetMetric()->SetGradation(gradation);
+  remesher->SetBoundaryFixing(boundaryFixing);
+  remesher->SetConsoleOutput(1);
+  remesher->SetForceManifold(forceManifold);
+  remesher->SetInput(mesh);
+  remesher->SetNumberOfClusters(numVertices);
+  remesher->SetNumberOfThreads(vtkMultiThreader::GetGlobalDefaultNumberOfThreads());
+  remesher->SetSubsamplingThreshold(0);
+
+  remesher->Remesh();
+
+  // Optimization: Minimize distance between input surface and remeshed surface
+  if (optimizationLevel != 0)
+    OptimizeClusterPositions(remesher, numVertices, optimizationLevel);
+
   vtkSmartPointer<vtkPolyDataNormals> normals = vtkSmartPointer<vtkPolyDataNormals>::New();
 
   normals->SetInputData(remesher->GetOutput());
@@ -183,7 +282,7 @@ mitk::Surface::Pointer mitk::ACVD::Remesh(mitk::Surface::ConstPointer surface,
 
   normals->Update();
 
-  Surface::Pointer remeshedSurface = Surface::New();
+  mitk::Surface::Pointer remeshedSurface = mitk::Surface::New();
   remeshedSurface->SetVtkPolyData(normals->GetOutput());
 
   MITK_INFO << "Finished remeshing";
@@ -191,6 +290,30 @@ mitk::Surface::Pointer mitk::ACVD::Remesh(mitk::Surface::ConstPointer surface,
   return remeshedSurface;
 }
 
+mitk::Surface::Pointer mitk::ACVD::Remesh(mitk::Surface::ConstPointer surface,
+                                          unsigned int t,
+                                          int numVertices,
+                                          double gradation,
+                                          int subsampling,
+                                          double edgeSplitting,
+                                          int optimizationLevel,
+                                          bool forceManifold,
+                                          bool boundaryFixing)
+{
+  PreparedInput preparedInput;
+
+  return ::Remesh(preparedInput,
+                  surface,
+                  t,
+                  numVertices,
+                  gradation,
+                  subsampling,
+                  edgeSplitting,
+                  optimizationLevel,
+                  forceManifold,
+                  boundaryFixing);
+}
+
 mitk::ACVD::RemeshFilter::RemeshFilter()
   : m_TimeStep(0),
     m_NumVertices(0),
@@ -199,7 +322,8 @@ mitk::ACVD::RemeshFilter::RemeshFilter()
     m_EdgeSplitting(0.0),
     m_OptimizationLevel(1),
     m_ForceManifold(false),
-    m_BoundaryFixing(false)
+    m_BoundaryFixing(false),
+    m_PreparedInput(new PreparedInput)
 {
   Surface::Pointer output = Surface::New();
   this->SetNthOutput(0, output);
@@ -211,14 +335,15 @@ mitk::ACVD::RemeshFilter::~RemeshFilter()
 
 void mitk::ACVD::RemeshFilter::GenerateData()
 {
-  Surface::Pointer output = Remesh(this->GetInput(),
-                                   m_TimeStep,
-                                   m_NumVertices,
-                                   m_Gradation,
-                                   m_Subsampling,
-                                   m_EdgeSplitting,
-                                   m_OptimizationLevel,
-                                   m_ForceManifold,
-                                   m_BoundaryFixing);
+  Surface::Pointer output = ::Remesh(*m_PreparedInput,
+                                     this->GetInput(),
+                                     m_TimeStep,
+                                     m_NumVertices,
+                                     m_Gradation,
+                                     m_Subsampling,
+                                     m_EdgeSplitting,
+                                     m_OptimizationLevel,
+                                     m_ForceManifold,
+                                     m_BoundaryFixing);
   this->SetNthOutput(0, output);
 }
@@ -21,10 +21,18 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkSurface.h>
 #include <mitkSurfaceToSurfaceFilter.h>
 
+#include <memory>
+
 namespace mitk
 {
   namespace ACVD
   {
+    /** \brief Input surface after the preparation for remeshing, i.e. copied, edge-split and subdivided.
+     *
+     * Defined in mitkACVD.cpp, RemeshFilter keeps it between updates.
+     */
+    class PreparedInput;
+
     /** \brief Remesh a surface and store the result in a new surface.
      *
      * The %ACVD library is used for remeshing which is based on the paper "Approximated Centroidal Voronoi Diagrams for
@@ -55,6 +63,9 @@ namespace mitk
      * \param[in] optimizationLevel Minimize distance between input surface and remeshed surface.
      * \param[in] boundaryFixing Keep original surface boundaries by adding additional polygons.
      * \return Returns the remeshed surface or nullptr if input surface is invalid.
+     *
+     * The clustering and the optimization run multi-threaded. Use RemeshFilter to remesh the same surface several
+     * times, it keeps the subdivided input as long as the surface, the time step and the edge splitting do not change.
      */
     MITKREMESHING_EXPORT Surface::Pointer Remesh(Surface::ConstPointer surface,
                                                  unsigned int t,
@@ -67,6 +78,8 @@ namespace mitk
                                                  bool boundaryFixing = false);
 
     /** \brief Encapsulates mitk::ACVD::Remesh function as filter.
+     *
+     * The prepared input is kept, so that changing the number of vertices only repeats the clustering.
      */
     class MITKREMESHING_EXPORT RemeshFilter : public mitk::SurfaceToSurfaceFilter
     {
@@ -98,6 +111,8 @@ namespace mitk
       int m_OptimizationLevel;
       bool m_ForceManifold;
       bool m_BoundaryFixing;
+
+      std::unique_ptr<PreparedInput> m_PreparedInput;
     };
   }
 }
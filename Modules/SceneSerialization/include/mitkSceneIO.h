@@ -21,14 +21,20 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkDataStorage.h"
 #include "mitkNodePredicateBase.h"
+#include <mitkWeakPointer.h>
 
+#include <Poco/Timestamp.h>
 #include <Poco/Zip/ZipLocalFileHeader.h>
 
+#include <map>
+#include <set>
+
 class TiXmlElement;
 
 namespace mitk
 {
   class BaseData;
+  class BaseDataSerializer;
   class PropertyList;
 
   class MITKSCENESERIALIZATION_EXPORT SceneIO : public itk::Object
@@ -47,6 +53,9 @@ namespace mitk
      * Attempts to read the provided file and create objects with
      * parent/child relations into a DataStorage.
      *
+     * The files of the scene are extracted from the archive one at a time when they are read, so the
+     * archive is never unpacked as a whole.
+     *
      * \param filename full filename of the scene file
      * \param storage If given, this DataStorage is used instead of a newly created one
      * \param clearStorageFirst If set, the provided DataStorage will be cleared before populating it with the loaded
@@ -66,6 +75,10 @@ namespace mitk
      * Attempts to write a scene file, which contains the nodes of the
      * provided DataStorage, their parent/child relations, and properties.
      *
+     * The data of different nodes is serialized in parallel, see SetNumberOfThreads(). Files which are
+     * compressed already (e.g. compressed NRRD images) are stored in the archive without deflating them
+     * again. See SetIncrementalSave() for rewriting only modified data.
+     *
      * \param storage a DataStorage containing all nodes that should be saved
      * \param filename full filename of the scene file
      * \param predicate defining which items of the datastorage to use and which not
@@ -95,15 +108,47 @@ namespace mitk
      */
     const PropertyList *GetFailedProperties();
 
+    /**
+     * \brief Number of threads serializing the data of the nodes in parallel, 0 (default) uses one per core.
+     *
+     * Properties are always serialized sequentially.
+     */
+    itkSetMacro(NumberOfThreads, unsigned int);
+    itkGetConstMacro(NumberOfThreads, unsigned int);
+
+    /**
+     * \brief Only rewrite data modified since this object loaded or saved the same scene file, default is false.
+     *
+     * If the scene file is saved again and was not changed by anyone else in between, the archive is
+     * updated in place: data that was not modified since (same object, same modification time) is kept
+     * as stored in the archive without serializing or compressing it again. The index and all properties
+     * are always rewritten. In all other cases the scene is saved completely.
+     */
+    itkSetMacro(IncrementalSave, bool);
+    itkGetConstMacro(IncrementalSave, bool);
+    itkBooleanMacro(IncrementalSave);
+
   protected:
     SceneIO();
     ~SceneIO() override;
 
     std::string CreateEmptyTempDirectory();
 
-    TiXmlElement *SaveBaseData(BaseData *data, const std::string &filenamehint, bool &error);
+    itk::SmartPointer<BaseDataSerializer> CreateBaseDataSerializer(BaseData *data, const std::string &filenamehint);
     TiXmlElement *SavePropertyList(PropertyList *propertyList, const std::string &filenamehint);
 
+    /** \brief Writes the content of the working directory into a new archive. */
+    bool WriteSceneArchive(const std::string &filename);
+
+    /** \brief Writes the content of the working directory into the existing archive, keeping keptFiles. */
+    bool UpdateSceneArchive(const std::string &filename, const std::set<std::string> &keptFiles);
+
+    /** \brief Remembers the data of the scene file for an incremental save. */
+    void StoreSceneState(const std::string &filename);
+
+    /** \brief True if filename is the scene file of the last load or save and unchanged since. */
+    bool IsStoredScene(const std::string &filename) const;
+
     void OnUnzipError(const void *pSender, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string> &info);
     void OnUnzipOk(const void *pSender, std::pair<const Poco::Zip::ZipLocalFileHeader, const Poco::Path> &info);
 
@@ -112,6 +157,21 @@ namespace mitk
 
     std::string m_WorkingDirectory;
     unsigned int m_UnzipErrors;
+
+    unsigned int m_NumberOfThreads;
+    bool m_IncrementalSave;
+
+    struct StoredData
+    {
+      WeakPointer<BaseData> Data;
+      unsigned long MTime;
+      std::string File;
+    };
+
+    // data of the last loaded or saved scene file and the names of their files in it
+    std::map<const BaseData *, StoredData> m_StoredData;
+    std::string m_StoredSceneFilename;
+    Poco::Timestamp m_StoredSceneTimestamp;
   };
 }
 
@@ -22,6 +22,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkDataStorage.h"
 
+#include <functional>
+
 namespace mitk
 {
   class MITKSCENESERIALIZATION_EXPORT SceneReader : public itk::Object
@@ -30,6 +32,30 @@ namespace mitk
     mitkClassMacroItkParent(SceneReader, itk::Object);
     itkFactorylessNewMacro(Self) itkCloneMacro(Self)
 
-      virtual bool LoadScene(TiXmlDocument &document, const std::string &workingDirectory, DataStorage *storage);
+      /**
+       * \brief Called before a file of the scene is read, with its name relative to the working directory.
+       *
+       * Allows to provide the files on demand, e.g. by extracting them from the scene archive only when
+       * they are needed. Returning false reports the file as missing.
+       */
+      typedef std::function<bool(const std::string &file)> FileRequestFunction;
+
+    /** \brief Called after the data of a node has been read from the given file. */
+    typedef std::function<void(DataNode *node, const std::string &file)> DataReadFunction;
+
+    virtual bool LoadScene(TiXmlDocument &document, const std::string &workingDirectory, DataStorage *storage);
+
+    void SetFileRequestFunction(const FileRequestFunction &function) { m_FileRequestFunction = function; }
+    void SetDataReadFunction(const DataReadFunction &function) { m_DataReadFunction = function; }
+
+  protected:
+    /** \brief Asks the FileRequestFunction for the file, true if there is none. */
+    bool RequestFile(const std::string &file);
+
+    /** \brief Passes the node to the DataReadFunction, if any. */
+    void ReportDataRead(DataNode *node, const std::string &file);
+
+    FileRequestFunction m_FileRequestFunction;
+    DataReadFunction m_DataReadFunction;
   };
 }
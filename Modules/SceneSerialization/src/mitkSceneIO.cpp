@@ -15,10 +15,18 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include <Poco/Delegate.h>
+#include <Poco/DirectoryIterator.h>
+#include <Poco/FileStream.h>
 #include <Poco/Path.h>
+#include <Poco/StreamCopier.h>
+#include <Poco/String.h>
 #include <Poco/TemporaryFile.h>
 #include <Poco/Zip/Compress.h>
 #include <Poco/Zip/Decompress.h>
+#include <Poco/Zip/ZipArchive.h>
+#include <Poco/Zip/ZipException.h>
+#include <Poco/Zip/ZipInputStream.h>
+#include <Poco/Zip/ZipManipulator.h>
 
 #include "mitkBaseDataSerializer.h"
 #include "mitkPropertyListSerializer.h"
@@ -36,13 +44,220 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <tinyxml.h>
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <memory>
 #include <mitkIOUtil.h>
 #include <sstream>
+#include <thread>
 
 #include "itksys/SystemTools.hxx"
 
-mitk::SceneIO::SceneIO() : m_WorkingDirectory(""), m_UnzipErrors(0)
+namespace
+{
+  typedef std::map<std::string, std::string> FileMapType;
+
+  // deflating these again takes time without making the archive smaller
+  bool IsCompressedFile(const std::string &path)
+  {
+    const std::string extension = Poco::toLower(Poco::Path(path).getExtension());
+    if (extension == "gz" || extension == "bz2" || extension == "zip" || extension == "png" || extension == "jpg" ||
+        extension == "jpeg" || extension == "vtp" || extension == "vtu" || extension == "vti")
+    {
+      return true;
+    }
+
+    if (extension == "nrrd")
+    {
+      // the header ends with an empty line, compressed data is announced by "encoding: gzip" or "bzip2"
+      std::ifstream file(path.c_str(), std::ios::binary);
+      std::string line;
+      while (std::getline(file, line) && !line.empty() && line != "\r")
+      {
+        if (line.compare(0, 9, "encoding:") == 0)
+          return line.find("gz") != std::string::npos || line.find("bz") != std::string::npos;
+      }
+    }
+
+    return false;
+  }
+
+  // all files below directory, by their name in the archive
+  void ListFiles(const Poco::Path &directory, const Poco::Path &entryDirectory, FileMapType &files)
+  {
+    for (Poco::DirectoryIterator iter(directory), end; iter != end; ++iter)
+    {
+      if (iter->isDirectory())
+      {
+        Poco::Path subdirectory(iter.path());
+        subdirectory.makeDirectory();
+        Poco::Path entrySubdirectory(entryDirectory);
+        entrySubdirectory.pushDirectory(iter.name());
+        ListFiles(subdirectory, entrySubdirectory, files);
+      }
+      else
+      {
+        const Poco::Path entry(entryDirectory, iter.name());
+        files[entry.toString(Poco::Path::PATH_UNIX)] = iter.path().toString();
+      }
+    }
+  }
+
+  Poco::Zip::ZipCommon::CompressionMethod GetCompressionMethod(const std::string &path)
+  {
+    return IsCompressedFile(path) ? Poco::Zip::ZipCommon::CM_STORE : Poco::Zip::ZipCommon::CM_DEFLATE;
+  }
+
+  // the file and the files of the same name with other extensions, e.g. the .raw of a .mhd
+  std::set<std::string> GetFilesOfMember(const Poco::Zip::ZipArchive &archive, const std::string &file)
+  {
+    std::set<std::string> files;
+    if (archive.findHeader(file) == archive.headerEnd())
+      return files;
+
+    files.insert(file);
+
+    const std::string::size_type extension = file.find_last_of('.');
+    if (extension != std::string::npos && extension > file.find_last_of('/') + 1)
+    {
+      const std::string prefix = file.substr(0, extension + 1);
+      for (auto iter = archive.headerBegin(); iter != archive.headerEnd(); ++iter)
+      {
+        if (iter->first.compare(0, prefix.size(), prefix) == 0 && iter->second.isFile())
+          files.insert(iter->first);
+      }
+    }
+
+    return files;
+  }
+
+  // extracts one file of the archive below directory, returns the path of the extracted file
+  std::string ExtractFile(std::istream &archiveStream,
+                          const Poco::Zip::ZipLocalFileHeader &header,
+                          const std::string &directory)
+  {
+    const Poco::Path entry(header.getFileName(), Poco::Path::PATH_UNIX);
+    for (int i = 0; i < entry.depth(); ++i)
+    {
+      if (entry[i] == "..")
+        throw Poco::Zip::ZipException("Invalid file name in archive", header.getFileName());
+    }
+    if (entry.isAbsolute())
+      throw Poco::Zip::ZipException("Invalid file name in archive", header.getFileName());
+
+    Poco::Path target(directory);
+    target.makeDirectory();
+    target.append(entry);
+    Poco::File(target.parent()).createDirectories();
+
+    archiveStream.clear();
+    Poco::Zip::ZipInputStream input(archiveStream, header, true);
+    Poco::FileOutputStream output(target.toString());
+    Poco::StreamCopier::copyStream(input, output);
+    output.close();
+
+    return target.toString();
+  }
+
+  /**
+   * Extracts the files of a scene archive when the scene reader requests them. The files of a
+   * request are deleted when the next one is made, so only one member is unpacked at a time.
+   */
+  class SceneFileExtractor
+  {
+  public:
+    SceneFileExtractor(std::istream &archiveStream, const Poco::Zip::ZipArchive &archive, const std::string &directory)
+      : m_ArchiveStream(archiveStream), m_Archive(archive), m_Directory(directory), m_Errors(0)
+    {
+    }
+
+    ~SceneFileExtractor() { this->DeleteExtractedFiles(); }
+
+    bool Extract(const std::string &file)
+    {
+      this->DeleteExtractedFiles();
+
+      const std::set<std::string> members = GetFilesOfMember(m_Archive, file);
+      if (members.empty())
+      {
+        ++m_Errors;
+        return false;
+      }
+
+      for (const auto &member : members)
+      {
+        try
+        {
+          m_ExtractedFiles.push_back(ExtractFile(m_ArchiveStream, m_Archive.findHeader(member)->second, m_Directory));
+        }
+        catch (const Poco::Exception &e)
+        {
+          MITK_ERROR << "Error while unzipping: " << member << " (" << e.displayText() << ")";
+          ++m_Errors;
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    unsigned int GetNumberOfErrors() const { return m_Errors; }
+
+  private:
+    void DeleteExtractedFiles()
+    {
+      for (const auto &file : m_ExtractedFiles)
+      {
+        try
+        {
+          Poco::File(file).remove();
+        }
+        catch (...)
+        {
+          // removed with the working directory
+        }
+      }
+      m_ExtractedFiles.clear();
+    }
+
+    std::istream &m_ArchiveStream;
+    const Poco::Zip::ZipArchive &m_Archive;
+    std::string m_Directory;
+    std::vector<std::string> m_ExtractedFiles;
+    unsigned int m_Errors;
+  };
+
+  struct DataSerialization
+  {
+    mitk::BaseData *Data = nullptr;
+    unsigned long MTime = 0;
+    std::string FilenameHint;
+    mitk::BaseDataSerializer::Pointer Serializer;
+    std::string File;
+    bool Reused = false;
+    bool Error = true;
+  };
+
+  void SerializeData(DataSerialization &serialization)
+  {
+    try
+    {
+      serialization.File = serialization.Serializer->Serialize();
+      serialization.Error = false;
+    }
+    catch (std::exception &e)
+    {
+      MITK_ERROR << "Serializer " << serialization.Serializer->GetNameOfClass() << " failed: " << e.what();
+    }
+    catch (...)
+    {
+      MITK_ERROR << "Serializer " << serialization.Serializer->GetNameOfClass() << " failed.";
+    }
+  }
+}
+
+mitk::SceneIO::SceneIO() : m_WorkingDirectory(""), m_UnzipErrors(0), m_NumberOfThreads(0), m_IncrementalSave(false)
 {
 }
 
@@ -133,23 +348,51 @@ mitk::DataStorage::Pointer mitk::SceneIO::LoadScene(const std::string &filename,
     return storage;
   }
 
-  // unzip all filenames contents to temp dir
   m_UnzipErrors = 0;
-  Poco::Zip::Decompress unzipper(file, Poco::Path(m_WorkingDirectory));
-  unzipper.EError += Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string>>(
-    this, &SceneIO::OnUnzipError);
-  unzipper.EOk += Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const Poco::Path>>(
-    this, &SceneIO::OnUnzipOk);
-  unzipper.decompressAllFiles();
-  unzipper.EError -= Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string>>(
-    this, &SceneIO::OnUnzipError);
-  unzipper.EOk -= Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const Poco::Path>>(
-    this, &SceneIO::OnUnzipOk);
 
-  if (m_UnzipErrors)
+  // read the directory of the archive to extract the files on demand
+  std::unique_ptr<Poco::Zip::ZipArchive> archive;
+  try
+  {
+    archive.reset(new Poco::Zip::ZipArchive(file));
+    if (archive->findHeader("index.xml") == archive->headerEnd())
+    {
+      archive.reset();
+    }
+  }
+  catch (const Poco::Exception &e)
   {
-    MITK_ERROR << "There were " << m_UnzipErrors << " errors unzipping '" << filename
-               << "'. Will attempt to read whatever could be unzipped.";
+    MITK_WARN << "Could not read the directory of '" << filename << "' (" << e.displayText()
+              << "). Will unzip all files.";
+    archive.reset();
+  }
+
+  std::unique_ptr<SceneFileExtractor> extractor;
+  if (archive)
+  {
+    extractor.reset(new SceneFileExtractor(file, *archive, m_WorkingDirectory));
+  }
+  else
+  {
+    // unzip all filenames contents to temp dir
+    file.clear();
+    file.seekg(0);
+    Poco::Zip::Decompress unzipper(file, Poco::Path(m_WorkingDirectory));
+    unzipper.EError += Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string>>(
+      this, &SceneIO::OnUnzipError);
+    unzipper.EOk += Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const Poco::Path>>(
+      this, &SceneIO::OnUnzipOk);
+    unzipper.decompressAllFiles();
+    unzipper.EError -= Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string>>(
+      this, &SceneIO::OnUnzipError);
+    unzipper.EOk -= Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const Poco::Path>>(
+      this, &SceneIO::OnUnzipOk);
+
+    if (m_UnzipErrors)
+    {
+      MITK_ERROR << "There were " << m_UnzipErrors << " errors unzipping '" << filename
+                 << "'. Will attempt to read whatever could be unzipped.";
+    }
   }
 
   // transcode locale-dependent string
@@ -158,19 +401,48 @@ mitk::DataStorage::Pointer mitk::SceneIO::LoadScene(const std::string &filename,
   // test if index.xml exists
   // parse index.xml with TinyXML
   TiXmlDocument document(m_WorkingDirectory + mitk::IOUtil::GetDirectorySeparator() + "index.xml");
-  if (!document.LoadFile())
+  if ((extractor && !extractor->Extract("index.xml")) || !document.LoadFile())
   {
     MITK_ERROR << "Could not open/read/parse " << m_WorkingDirectory << mitk::IOUtil::GetDirectorySeparator()
                << "index.xml\nTinyXML reports: " << document.ErrorDesc() << std::endl;
     return storage;
   }
 
+  std::vector<std::pair<DataNode::Pointer, std::string>> readData;
+
   SceneReader::Pointer reader = SceneReader::New();
+  if (extractor)
+  {
+    reader->SetFileRequestFunction([&extractor](const std::string &name) { return extractor->Extract(name); });
+  }
+  reader->SetDataReadFunction(
+    [&readData](DataNode *node, const std::string &name) { readData.push_back(std::make_pair(node, name)); });
+
   if (!reader->LoadScene(document, m_WorkingDirectory, storage))
   {
     MITK_ERROR << "There were errors while loading scene file " << filename << ". Your data may be corrupted";
   }
 
+  if (extractor)
+  {
+    m_UnzipErrors = extractor->GetNumberOfErrors();
+    extractor.reset();
+  }
+
+  // the data read now is what the archive contains, as long as it is not modified
+  m_StoredData.clear();
+  for (const auto &read : readData)
+  {
+    if (BaseData *data = read.first->GetData())
+    {
+      StoredData &stored = m_StoredData[data];
+      stored.Data = data;
+      stored.MTime = data->GetMTime();
+      stored.File = read.second;
+    }
+  }
+  this->StoreSceneState(filename);
+
   // delete temp directory
   try
   {
@@ -231,6 +503,11 @@ bool mitk::SceneIO::SaveScene(DataStorage::SetOfObjects::ConstPointer sceneNodes
 
     // DataStorage::SetOfObjects::ConstPointer sceneNodes = storage->GetSubset( predicate );
 
+    // serialized data of each node and the files kept from the existing archive by an incremental save
+    std::vector<DataSerialization> serializations;
+    std::set<std::string> keptFiles;
+    bool incremental(false);
+
     if (sceneNodes.IsNull())
     {
       MITK_WARN << "Saving empty scene to " << filename;
@@ -293,8 +570,131 @@ bool mitk::SceneIO::SaveScene(DataStorage::SetOfObjects::ConstPointer sceneNodes
         }
       }
 
+      // data that was not modified since the last load or save of this scene file is kept in the archive
+      std::unique_ptr<Poco::Zip::ZipArchive> previousArchive;
+      if (m_IncrementalSave && this->IsStoredScene(filename))
+      {
+        try
+        {
+          std::ifstream previousFile(filename.c_str(), std::ios::binary);
+          previousArchive.reset(new Poco::Zip::ZipArchive(previousFile));
+          incremental = true;
+        }
+        catch (const Poco::Exception &e)
+        {
+          MITK_WARN << "Could not read '" << filename << "' (" << e.displayText() << "). Will save the complete scene.";
+        }
+      }
+
+      serializations.resize(sceneNodes->size());
+      std::vector<DataSerialization *> pendingSerializations;
+
+      std::size_t nodeIndex(0);
+      for (auto iter = sceneNodes->begin(); iter != sceneNodes->end(); ++iter, ++nodeIndex)
+      {
+        DataNode *node = iter->GetPointer();
+        BaseData *data = node ? node->GetData() : nullptr;
+        if (!data)
+          continue;
+
+        DataSerialization &serialization = serializations[nodeIndex];
+        serialization.Data = data;
+        serialization.MTime = data->GetMTime();
+
+        // escape filename <-- only allow [A-Za-z0-9_], replace everything else with _
+        serialization.FilenameHint = itksys::SystemTools::MakeCindentifier(node->GetName().c_str());
+
+        if (incremental)
+        {
+          auto stored = m_StoredData.find(data);
+          if (stored != m_StoredData.end() && !stored->second.Data.IsExpired() &&
+              stored->second.MTime == serialization.MTime)
+          {
+            const std::set<std::string> files = GetFilesOfMember(*previousArchive, stored->second.File);
+            if (!files.empty())
+            {
+              serialization.File = stored->second.File;
+              serialization.Reused = true;
+              serialization.Error = false;
+              keptFiles.insert(files.begin(), files.end());
+              continue;
+            }
+          }
+        }
+
+        serialization.Serializer = this->CreateBaseDataSerializer(data, serialization.FilenameHint);
+        if (serialization.Serializer.IsNotNull())
+        {
+          pendingSerializations.push_back(&serialization);
+        }
+      }
+
+      // the serializers of different nodes write different files, run them in parallel
+      unsigned int numberOfThreads = m_NumberOfThreads;
+      if (numberOfThreads == 0)
+      {
+        numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+      }
+      numberOfThreads = static_cast<unsigned int>(
+        std::max<std::size_t>(1, std::min<std::size_t>(numberOfThreads, pendingSerializations.size())));
+
+      std::atomic<std::size_t> nextSerialization(0);
+      auto serializeData = [&pendingSerializations, &nextSerialization]() {
+        for (std::size_t i = nextSerialization++; i < pendingSerializations.size(); i = nextSerialization++)
+        {
+          SerializeData(*pendingSerializations[i]);
+        }
+      };
+
+      std::vector<std::thread> threads;
+      for (unsigned int thread = 1; thread < numberOfThreads; ++thread)
+      {
+        threads.emplace_back(serializeData);
+      }
+      serializeData();
+      for (auto &thread : threads)
+      {
+        thread.join();
+      }
+
+      if (incremental)
+      {
+        // a new file must not replace a kept one, otherwise the kept data is serialized again as well
+        FileMapType writtenFiles;
+        ListFiles(Poco::Path(m_WorkingDirectory).makeDirectory(), Poco::Path(), writtenFiles);
+
+        bool conflict(false);
+        for (const auto &written : writtenFiles)
+        {
+          conflict |= keptFiles.count(written.first) > 0;
+        }
+
+        if (conflict)
+        {
+          MITK_WARN << "New files of the scene conflict with files in '" << filename
+                    << "'. Will save the complete scene.";
+          for (auto &serialization : serializations)
+          {
+            if (serialization.Reused)
+            {
+              serialization.Reused = false;
+              serialization.Error = true;
+              serialization.Serializer =
+                this->CreateBaseDataSerializer(serialization.Data, serialization.FilenameHint);
+              if (serialization.Serializer.IsNotNull())
+              {
+                SerializeData(serialization);
+              }
+            }
+          }
+          keptFiles.clear();
+          incremental = false;
+        }
+      }
+
       // write out objects, dependencies and properties
-      for (auto iter = sceneNodes->begin(); iter != sceneNodes->end(); ++iter)
+      nodeIndex = 0;
+      for (auto iter = sceneNodes->begin(); iter != sceneNodes->end(); ++iter, ++nodeIndex)
       {
         DataNode *node = iter->GetPointer();
 
@@ -330,13 +730,18 @@ bool mitk::SceneIO::SaveScene(DataStorage::SetOfObjects::ConstPointer sceneNodes
           // store basedata
           if (BaseData *data = node->GetData())
           {
-            // std::string filenameHint( node->GetName() );
-            bool error(false);
-            TiXmlElement *dataElement(SaveBaseData(data, filenameHint, error)); // returns a reference to a file
-            if (error)
+            const DataSerialization &serialization = serializations[nodeIndex];
+
+            auto *dataElement = new TiXmlElement("data");
+            dataElement->SetAttribute("type", data->GetNameOfClass());
+            if (serialization.Error)
             {
               m_FailedNodes->push_back(node);
             }
+            else
+            {
+              dataElement->SetAttribute("file", serialization.File); // a reference to a file
+            }
 
             // store basedata properties
             PropertyList *propertyList = data->GetPropertyList();
@@ -391,48 +796,75 @@ bool mitk::SceneIO::SaveScene(DataStorage::SetOfObjects::ConstPointer sceneNodes
                  << "\nTinyXML reports '" << document.ErrorDesc() << "'";
       return false;
     }
-    else
+
+    bool written(false);
+    if (incremental)
     {
-      try
+      written = this->UpdateSceneArchive(filename, keptFiles);
+      if (!written && !keptFiles.empty())
       {
-        Poco::File deleteFile(filename.c_str());
-        if (deleteFile.exists())
+        // the kept files become part of the new archive
+        FileMapType writtenFiles;
+        ListFiles(Poco::Path(m_WorkingDirectory).makeDirectory(), Poco::Path(), writtenFiles);
+        for (const auto &keptFile : keptFiles)
         {
-          deleteFile.remove();
+          if (writtenFiles.count(keptFile) > 0)
+          {
+            MITK_ERROR << "Could not save scene to " << filename << ", file " << keptFile << " exists twice.";
+            return false;
+          }
         }
 
-        // create zip at filename
-        std::ofstream file(filename.c_str(), std::ios::binary | std::ios::out);
-        if (!file.good())
-        {
-          MITK_ERROR << "Could not open a zip file for writing: '" << filename << "'";
-          return false;
-        }
-        else
-        {
-          Poco::Zip::Compress zipper(file, true);
-          Poco::Path tmpdir(m_WorkingDirectory);
-          zipper.addRecursive(tmpdir);
-          zipper.close();
-        }
         try
         {
-          Poco::File deleteDir(m_WorkingDirectory);
-          deleteDir.remove(true); // recursive
+          std::ifstream previousFile(filename.c_str(), std::ios::binary);
+          Poco::Zip::ZipArchive previousArchive(previousFile);
+          for (const auto &keptFile : keptFiles)
+          {
+            ExtractFile(previousFile, previousArchive.findHeader(keptFile)->second, m_WorkingDirectory);
+          }
         }
-        catch (...)
+        catch (const Poco::Exception &e)
         {
-          MITK_ERROR << "Could not delete temporary directory " << m_WorkingDirectory;
-          return false; // ok?
+          MITK_ERROR << "Could not copy the unmodified data of '" << filename << "': " << e.displayText();
+          return false;
         }
       }
-      catch (std::exception &e)
+    }
+
+    if (!written)
+    {
+      written = this->WriteSceneArchive(filename);
+    }
+
+    try
+    {
+      Poco::File deleteDir(m_WorkingDirectory);
+      deleteDir.remove(true); // recursive
+    }
+    catch (...)
+    {
+      MITK_ERROR << "Could not delete temporary directory " << m_WorkingDirectory;
+      return false; // ok?
+    }
+
+    m_StoredData.clear();
+    if (written)
+    {
+      for (const auto &serialization : serializations)
       {
-        MITK_ERROR << "Could not create ZIP file from " << m_WorkingDirectory << "\nReason: " << e.what();
-        return false;
+        if (serialization.Data && !serialization.Error && !serialization.File.empty())
+        {
+          StoredData &stored = m_StoredData[serialization.Data];
+          stored.Data = serialization.Data;
+          stored.MTime = serialization.MTime;
+          stored.File = serialization.File;
+        }
       }
-      return true;
+      this->StoreSceneState(filename);
     }
+
+    return written;
   }
   catch (std::exception &e)
   {
@@ -441,18 +873,16 @@ bool mitk::SceneIO::SaveScene(DataStorage::SetOfObjects::ConstPointer sceneNodes
   }
 }
 
-TiXmlElement *mitk::SceneIO::SaveBaseData(BaseData *data, const std::string &filenamehint, bool &error)
+mitk::BaseDataSerializer::Pointer mitk::SceneIO::CreateBaseDataSerializer(BaseData *data,
+                                                                          const std::string &filenamehint)
 {
   assert(data);
-  error = true;
 
   // find correct serializer
   // the serializer must
   //  - create a file containing all information to recreate the BaseData object --> needs to know where to put this
   //  file (and a filename?)
   //  - TODO what to do about writers that creates one file per timestep?
-  auto *element = new TiXmlElement("data");
-  element->SetAttribute("type", data->GetNameOfClass());
 
   // construct name of serializer class
   std::string serializername(data->GetNameOfClass());
@@ -475,21 +905,131 @@ TiXmlElement *mitk::SceneIO::SaveBaseData(BaseData *data, const std::string &fil
       serializer->SetFilenameHint(filenamehint);
       std::string defaultLocale_WorkingDirectory = Poco::Path::transcode( m_WorkingDirectory );
       serializer->SetWorkingDirectory(defaultLocale_WorkingDirectory);
-      try
+      return serializer;
+    }
+  }
+
+  return nullptr;
+}
+
+bool mitk::SceneIO::WriteSceneArchive(const std::string &filename)
+{
+  try
+  {
+    Poco::File deleteFile(filename.c_str());
+    if (deleteFile.exists())
+    {
+      deleteFile.remove();
+    }
+
+    // create zip at filename
+    std::ofstream file(filename.c_str(), std::ios::binary | std::ios::out);
+    if (!file.good())
+    {
+      MITK_ERROR << "Could not open a zip file for writing: '" << filename << "'";
+      return false;
+    }
+
+    FileMapType files;
+    ListFiles(Poco::Path(m_WorkingDirectory).makeDirectory(), Poco::Path(), files);
+
+    Poco::Zip::Compress zipper(file, true);
+    for (const auto &entry : files)
+    {
+      zipper.addFile(Poco::Path(entry.second),
+                     Poco::Path(entry.first, Poco::Path::PATH_UNIX),
+                     GetCompressionMethod(entry.second),
+                     Poco::Zip::ZipCommon::CL_MAXIMUM);
+    }
+    zipper.close();
+  }
+  catch (std::exception &e)
+  {
+    MITK_ERROR << "Could not create ZIP file from " << m_WorkingDirectory << "\nReason: " << e.what();
+    return false;
+  }
+
+  return true;
+}
+
+bool mitk::SceneIO::UpdateSceneArchive(const std::string &filename, const std::set<std::string> &keptFiles)
+{
+  try
+  {
+    FileMapType files;
+    ListFiles(Poco::Path(m_WorkingDirectory).makeDirectory(), Poco::Path(), files);
+
+    Poco::Zip::ZipManipulator manipulator(filename, false);
+    const Poco::Zip::ZipArchive &archive = manipulator.originalArchive();
+
+    // replace the files of the same name, delete all others that are not kept
+    for (auto iter = archive.headerBegin(); iter != archive.headerEnd(); ++iter)
+    {
+      if (!iter->second.isFile() || keptFiles.count(iter->first) > 0)
+        continue;
+
+      auto written = files.find(iter->first);
+      if (written != files.end())
       {
-        std::string writtenfilename = serializer->Serialize();
-        element->SetAttribute("file", writtenfilename);
-        error = false;
+        manipulator.replaceFile(iter->first, written->second);
+        files.erase(written);
       }
-      catch (std::exception &e)
+      else
       {
-        MITK_ERROR << "Serializer " << serializer->GetNameOfClass() << " failed: " << e.what();
+        manipulator.deleteFile(iter->first);
       }
-      break;
     }
+
+    for (const auto &entry : files)
+    {
+      if (keptFiles.count(entry.first) > 0)
+      {
+        MITK_WARN << "File " << entry.first << " of the scene conflicts with a file kept in '" << filename << "'";
+        return false;
+      }
+
+      manipulator.addFile(
+        entry.first, entry.second, GetCompressionMethod(entry.second), Poco::Zip::ZipCommon::CL_MAXIMUM);
+    }
+
+    manipulator.commit();
+  }
+  catch (std::exception &e)
+  {
+    MITK_WARN << "Could not update the ZIP file '" << filename << "': " << e.what() << ". Will write a new one.";
+    return false;
   }
 
-  return element;
+  return true;
+}
+
+void mitk::SceneIO::StoreSceneState(const std::string &filename)
+{
+  m_StoredSceneFilename = filename;
+  try
+  {
+    m_StoredSceneTimestamp = Poco::File(filename).getLastModified();
+  }
+  catch (const Poco::Exception &)
+  {
+    m_StoredSceneFilename.clear();
+  }
+}
+
+bool mitk::SceneIO::IsStoredScene(const std::string &filename) const
+{
+  if (filename.empty() || filename != m_StoredSceneFilename)
+    return false;
+
+  try
+  {
+    Poco::File file(filename);
+    return file.exists() && file.getLastModified() == m_StoredSceneTimestamp;
+  }
+  catch (const Poco::Exception &)
+  {
+    return false;
+  }
 }
 
 TiXmlElement *mitk::SceneIO::SavePropertyList(PropertyList *propertyList, const std::string &filenamehint)
@@ -49,6 +49,9 @@ bool mitk::SceneReader::LoadScene(TiXmlDocument &document, const std::string &wo
   {
     if (auto *reader = dynamic_cast<SceneReader *>(iter->GetPointer()))
     {
+      reader->SetFileRequestFunction(m_FileRequestFunction);
+      reader->SetDataReadFunction(m_DataReadFunction);
+
       if (!reader->LoadScene(document, workingDirectory, storage))
       {
         MITK_ERROR << "There were errors while loading scene file "
@@ -63,3 +66,23 @@ bool mitk::SceneReader::LoadScene(TiXmlDocument &document, const std::string &wo
   }
   return false;
 }
+
+bool mitk::SceneReader::RequestFile(const std::string &file)
+{
+  if (!m_FileRequestFunction)
+    return true;
+
+  if (!m_FileRequestFunction(file))
+  {
+    MITK_ERROR << "File '" << file << "' of the scene is not available.";
+    return false;
+  }
+
+  return true;
+}
+
+void mitk::SceneReader::ReportDataRead(DataNode *node, const std::string &file)
+{
+  if (m_DataReadFunction)
+    m_DataReadFunction(node, file);
+}
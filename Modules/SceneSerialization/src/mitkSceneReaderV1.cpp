@@ -177,6 +177,9 @@ bool mitk::SceneReaderV1::LoadScene(TiXmlDocument &document, const std::string &
     }
   }
 
+  // listeners of the storage are notified once about all nodes of the scene
+  DataStorage::BatchUpdate batch(storage);
+
   // repeat the following loop ...
   //   ... for all created nodes
   unsigned int lastMapSize(0);
@@ -254,6 +257,12 @@ mitk::DataNode::Pointer mitk::SceneReaderV1::LoadBaseDataFromDataTag(TiXmlElemen
     {
       try
       {
+        if (!this->RequestFile(filename))
+        {
+          error = true;
+          return DataNode::New();
+        }
+
         std::vector<BaseData::Pointer> baseData = IOUtil::Load(workingDirectory + Poco::Path::separator() + filename);
         if (baseData.size() > 1)
         {
@@ -261,6 +270,7 @@ mitk::DataNode::Pointer mitk::SceneReaderV1::LoadBaseDataFromDataTag(TiXmlElemen
         }
         node = DataNode::New();
         node->SetData(baseData.front());
+        this->ReportDataRead(node, filename);
       }
       catch (std::exception &e)
       {
@@ -359,6 +369,12 @@ bool mitk::SceneReaderV1::DecorateNodeWithProperties(DataNode *node,
       node->GetPropertyList(renderwindow); // DataNode implementation always returns a propertylist
     ClearNodePropertyListWithExceptions(*node, *propertyList);
 
+    if (!this->RequestFile(propertiesfile))
+    {
+      error = true;
+      continue;
+    }
+
     // use deserializer to construct new properties
     PropertyListDeserializer::Pointer deserializer = PropertyListDeserializer::New();
 
@@ -397,6 +413,11 @@ bool mitk::SceneReaderV1::DecorateBaseDataWithProperties(BaseData::Pointer data,
   {
     // PropertyList::Pointer dataPropList = data->GetPropertyList();
 
+    if (!this->RequestFile(baseDataPropertyFile))
+    {
+      return false;
+    }
+
     PropertyListDeserializer::Pointer propertyDeserializer = PropertyListDeserializer::New();
 
     // initialize the property reader
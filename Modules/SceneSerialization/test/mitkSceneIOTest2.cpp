@@ -82,6 +82,7 @@ class mitkSceneIOTest2Suite : public mitk::TestFixture
   CPPUNIT_TEST_SUITE(mitkSceneIOTest2Suite);
   MITK_TEST(Test_SceneIOInterfaces);
   MITK_TEST(Test_ReconstructionOfScenes);
+  MITK_TEST(Test_IncrementalSave);
   CPPUNIT_TEST_SUITE_END();
 
   mitk::SceneIOTestScenarioProvider m_TestCaseProvider;
@@ -129,6 +130,54 @@ public:
     }
   }
 
+  void Test_IncrementalSave()
+  {
+    std::string tempDir = mitk::IOUtil::CreateTemporaryDirectory("SceneIOTest_XXXXXX");
+
+    for (auto scenario : m_TestCaseProvider.GetAllScenarios())
+    {
+      if (!scenario.serializable)
+        continue;
+
+      MITK_TEST_OUTPUT(<< "\n===== Test_IncrementalSave, scenario '" << scenario.key << "' =====");
+
+      std::string archiveFilename = mitk::IOUtil::CreateTemporaryFile("scene_XXXXXX.mitk", tempDir);
+      mitk::SceneIO::Pointer writer = mitk::SceneIO::New();
+      writer->IncrementalSaveOn();
+      writer->SetNumberOfThreads(2);
+
+      mitk::DataStorage::Pointer originalStorage = scenario.BuildDataStorage();
+      CPPUNIT_ASSERT_MESSAGE(std::string("Save test scenario '") + scenario.key + "'",
+                             writer->SaveScene(originalStorage->GetAll(), originalStorage, archiveFilename));
+
+      // modify one node and remove another one, all other data is kept from the first save
+      mitk::DataStorage::SetOfObjects::ConstPointer nodes = originalStorage->GetAll();
+      if (!nodes->empty() && nodes->front()->GetData() != nullptr)
+      {
+        nodes->front()->GetData()->Modified();
+      }
+      if (nodes->size() > 1 && originalStorage->GetDerivations(nodes->back())->empty())
+      {
+        originalStorage->Remove(nodes->back());
+      }
+
+      CPPUNIT_ASSERT_MESSAGE(std::string("Save test scenario '") + scenario.key + "' incrementally",
+                             writer->SaveScene(originalStorage->GetAll(), originalStorage, archiveFilename));
+
+      mitk::SceneIO::Pointer reader = mitk::SceneIO::New();
+      mitk::DataStorage::Pointer restoredStorage;
+      CPPUNIT_ASSERT_NO_THROW(restoredStorage = reader->LoadScene(archiveFilename));
+      CPPUNIT_ASSERT_MESSAGE(
+        std::string("Comparing incrementally saved test scenario '") + scenario.key + "'",
+        mitk::DataStorageCompare(originalStorage,
+                                 restoredStorage,
+                                 mitk::DataStorageCompare::CMP_Hierarchy | mitk::DataStorageCompare::CMP_Data |
+                                   mitk::DataStorageCompare::CMP_Properties,
+                                 scenario.comparisonPrecision)
+          .CompareVerbose());
+    }
+  }
+
 }; // class
 
 int mitkSceneIOTest2(int /*argc*/, char * /*argv*/ [])
@@ -14,76 +14,20 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 ===================================================================*/
 
-#include <mitkImageAccessByItk.h>
-
-#include "itkImageRegionConstIteratorWithIndex.h"
 #include "mitkCalculateSegmentationVolume.h"
 
+#include <algorithm>
 #include <limits>
 
 namespace mitk
 {
-  CalculateSegmentationVolume::CalculateSegmentationVolume() {}
-  CalculateSegmentationVolume::~CalculateSegmentationVolume() {}
-  template <typename TPixel, unsigned int VImageDimension>
-  void CalculateSegmentationVolume::ItkImageProcessing(itk::Image<TPixel, VImageDimension> *itkImage,
-                                                       TPixel *itkNotUsed(dummy))
+  CalculateSegmentationVolume::CalculateSegmentationVolume()
+    : m_VolumeCalculator(LabeledImageVolumeCalculator::New()), m_Volume(0)
   {
-    itk::ImageRegionConstIteratorWithIndex<itk::Image<TPixel, VImageDimension>> iterBinaryImage(
-      itkImage, itkImage->GetLargestPossibleRegion());
-    typename itk::ImageRegionConstIteratorWithIndex<itk::Image<TPixel, VImageDimension>>::IndexType currentIndex;
-    typename itk::ImageRegionConstIteratorWithIndex<itk::Image<TPixel, VImageDimension>>::IndexType minIndex;
-    for (unsigned int i = 0; i < VImageDimension; ++i)
-      minIndex[i] = std::numeric_limits<long int>::max();
-
-    typename itk::ImageRegionConstIteratorWithIndex<itk::Image<TPixel, VImageDimension>>::IndexType maxIndex;
-    for (unsigned int i = 0; i < VImageDimension; ++i)
-      maxIndex[i] = std::numeric_limits<long int>::min();
-
-    m_CenterOfMass.Fill(0.0);
-
-    m_Volume = 0;
-    while (!iterBinaryImage.IsAtEnd())
-    {
-      if (iterBinaryImage.Get() > static_cast<TPixel>(0.0))
-      {
-        // update center of mass
-        currentIndex = iterBinaryImage.GetIndex();
-        itk::Vector<ScalarType, VImageDimension> currentPoint;
-        for (unsigned int i = 0; i < VImageDimension; ++i)
-          currentPoint[i] = currentIndex[i];
-
-        m_CenterOfMass =
-          (m_CenterOfMass *
-           (static_cast<ScalarType>(m_Volume) /
-            static_cast<ScalarType>(m_Volume + 1))) // e.g. 3 points:   old center * 2/3 + currentPoint * 1/3;
-          + currentPoint / static_cast<ScalarType>(m_Volume + 1);
-
-        // update number of voxels
-        ++m_Volume;
-
-        // update bounding box
-        for (unsigned int i = 0; i < VImageDimension; ++i)
-        {
-          if (currentIndex[i] < minIndex[i])
-            minIndex[i] = currentIndex[i];
-          if (currentIndex[i] > maxIndex[i])
-            maxIndex[i] = currentIndex[i];
-        }
-      }
-
-      ++iterBinaryImage;
-    }
-
-    m_MinIndexOfBoundingBox[2] = 0.0;
-    m_MaxIndexOfBoundingBox[2] = 0.0;
-    for (unsigned int i = 0; i < VImageDimension; ++i)
-    {
-      m_MinIndexOfBoundingBox[i] = minIndex[i];
-      m_MaxIndexOfBoundingBox[i] = maxIndex[i];
-    }
   }
 
+  CalculateSegmentationVolume::~CalculateSegmentationVolume() {}
+
   bool CalculateSegmentationVolume::ReadyToRun()
   {
     Image::Pointer image;
@@ -98,13 +42,64 @@ namespace mitk
     Image::Pointer image;
     GetPointerParameter("Input", image);
 
-    AccessFixedDimensionByItk(image.GetPointer(),
-                              ItkImageProcessing,
-                              3); // some magic to call the correctly templated function (we only do 3D images here!)
+    if (image->GetDimension() != 3) // we only do 3D images here!
+      return false;
+
+    m_VolumeCalculator->SetImage(image);
+    m_VolumeCalculator->Calculate();
+
+    // Every voxel > 0 belongs to the segmentation, so sum up all labels except the background
+    const BaseGeometry *geometry = image->GetGeometry();
+    itk::IndexValueType minIndex[3];
+    itk::IndexValueType maxIndex[3];
+    std::fill(minIndex, minIndex + 3, std::numeric_limits<itk::IndexValueType>::max());
+    std::fill(maxIndex, maxIndex + 3, std::numeric_limits<itk::IndexValueType>::min());
+
+    Vector3D centroidSum;
+    centroidSum.Fill(0.0);
+    m_Volume = 0;
+    ScalarType volume = 0.0;
+
+    for (unsigned int label = 1; label < m_VolumeCalculator->GetNumbersOfVoxels().size(); ++label)
+    {
+      const std::size_t numberOfVoxels = m_VolumeCalculator->GetNumberOfVoxels(label);
+      if (numberOfVoxels == 0)
+        continue;
+
+      m_Volume += numberOfVoxels;
+      volume += m_VolumeCalculator->GetVolume(label);
+      centroidSum +=
+        m_VolumeCalculator->GetCentroid(label).GetVectorFromOrigin() * static_cast<ScalarType>(numberOfVoxels);
+
+      const LabeledImageVolumeCalculator::RegionType &boundingBox = m_VolumeCalculator->GetBoundingBox(label);
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        const auto size = static_cast<itk::IndexValueType>(boundingBox.GetSize(i));
+        minIndex[i] = std::min(minIndex[i], boundingBox.GetIndex(i));
+        maxIndex[i] = std::max(maxIndex[i], boundingBox.GetIndex(i) + size - 1);
+      }
+    }
+
+    // the centroids are in world coordinates, while the center of mass is given in index coordinates
+    m_CenterOfMass.Fill(0.0);
+    if (m_Volume > 0)
+    {
+      Point3D centerOfMassInWorld;
+      centerOfMassInWorld.Fill(0.0);
+      centerOfMassInWorld += centroidSum / static_cast<ScalarType>(m_Volume);
+
+      Point3D centerOfMassInIndex;
+      geometry->WorldToIndex(centerOfMassInWorld, centerOfMassInIndex);
+      m_CenterOfMass = centerOfMassInIndex.GetVectorFromOrigin();
+    }
+
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      m_MinIndexOfBoundingBox[i] = minIndex[i];
+      m_MaxIndexOfBoundingBox[i] = maxIndex[i];
+    }
 
-    // consider single voxel volume
-    Vector3D spacing = image->GetSlicedGeometry()->GetSpacing();                           // spacing in mm
-    float volumeML = (ScalarType)m_Volume * spacing[0] * spacing[1] * spacing[2] / 1000.0; // convert to ml
+    float volumeML = volume / 1000.0; // convert to ml
 
     DataNode *groupNode = GetGroupNode();
     if (groupNode)
@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define MITK_CALCULATE_SEGMENTATION_VOLUME_H_INCLUDET_WAD
 
 #include "mitkImageCast.h"
+#include "mitkLabeledImageVolumeCalculator.h"
 #include "mitkSegmentationSink.h"
 #include <MitkSegmentationExports.h>
 
@@ -36,11 +37,11 @@ namespace mitk
 
     bool ThreadedUpdateFunction() override; // will be called from a thread after calling StartAlgorithm
 
-    template <typename TPixel, unsigned int VImageDimension>
-    void ItkImageProcessing(itk::Image<TPixel, VImageDimension> *itkImage, TPixel *dummy = nullptr);
-
   private:
-    unsigned int m_Volume;
+    /// measures all labels in one pass, the results are reused as long as the image is not modified
+    LabeledImageVolumeCalculator::Pointer m_VolumeCalculator;
+
+    std::size_t m_Volume;
 
     Vector3D m_CenterOfMass;
     Vector3D m_MinIndexOfBoundingBox;
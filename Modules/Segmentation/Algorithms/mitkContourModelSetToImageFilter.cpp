@@ -17,16 +17,153 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkContourModelSetToImageFilter.h"
 
 #include <mitkContourModelSet.h>
-#include <mitkContourModelUtils.h>
-#include <mitkExtractSliceFilter.h>
 #include <mitkImageWriteAccessor.h>
+#include <mitkPixelTypeMultiplex.h>
 #include <mitkProgressBar.h>
 #include <mitkTimeHelper.h>
 
-#include <mitkVtkImageOverwrite.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <thread>
+
+namespace
+{
+  /** A contour vertex in continuous index coordinates of the two in-plane axes of its slice. */
+  struct SlicePoint
+  {
+    double X;
+    double Y;
+  };
+
+  typedef std::vector<SlicePoint> SlicePolygon;
+
+  /** All contours lying in one slice perpendicular to Axis. */
+  struct SliceContours
+  {
+    unsigned int Axis;
+    itk::IndexValueType Slice;
+    std::vector<SlicePolygon> Polygons;
+  };
+
+  /** In-plane axes for slices perpendicular to axis 0 (sagittal), 1 (frontal) and 2 (axial). */
+  const unsigned int InPlaneAxes[3][2] = {{1, 2}, {0, 2}, {0, 1}};
+
+  /** Pixels whose center lies within this distance of a contour are considered inside, as for
+      vtkPolyDataToImageStencil with tolerance mitk::eps. */
+  const double Tolerance = mitk::eps;
+
+  template <typename TPixel>
+  void FillPolygon(const SlicePolygon &polygon,
+                   TPixel *slice,
+                   itk::IndexValueType columns,
+                   itk::IndexValueType rows,
+                   itk::OffsetValueType columnStride,
+                   itk::OffsetValueType rowStride,
+                   std::vector<double> &crossings)
+  {
+    const std::size_t numberOfPoints = polygon.size();
+
+    double minY = polygon.front().Y;
+    double maxY = polygon.front().Y;
+    for (const auto &point : polygon)
+    {
+      minY = std::min(minY, point.Y);
+      maxY = std::max(maxY, point.Y);
+    }
+
+    const auto firstRow =
+      std::max(itk::IndexValueType(0), static_cast<itk::IndexValueType>(std::ceil(minY - Tolerance)));
+    const auto lastRow = std::min(rows - 1, static_cast<itk::IndexValueType>(std::floor(maxY + Tolerance)));
+
+    for (auto row = firstRow; row <= lastRow; ++row)
+    {
+      // Rows touching the top or bottom of the polygon are sampled just inside of it, so boundary
+      // pixels are filled as well.
+      const double y = std::min(std::max(static_cast<double>(row), minY + Tolerance), maxY - Tolerance);
+
+      crossings.clear();
+      for (std::size_t i = 0, j = numberOfPoints - 1; i < numberOfPoints; j = i++)
+      {
+        const SlicePoint &a = polygon[i];
+        const SlicePoint &b = polygon[j];
+        if ((a.Y <= y) != (b.Y <= y))
+          crossings.push_back(a.X + (y - a.Y) * (b.X - a.X) / (b.Y - a.Y));
+      }
+
+      std::sort(crossings.begin(), crossings.end());
+
+      TPixel *line = slice + row * rowStride;
+      for (std::size_t i = 0; i + 1 < crossings.size(); i += 2)
+      {
+        const auto first =
+          std::max(itk::IndexValueType(0), static_cast<itk::IndexValueType>(std::ceil(crossings[i] - Tolerance)));
+        const auto last =
+          std::min(columns - 1, static_cast<itk::IndexValueType>(std::floor(crossings[i + 1] + Tolerance)));
+
+        for (auto column = first; column <= last; ++column)
+          line[column * columnStride] = 1;
+      }
+    }
+  }
+
+  /** Fills all polygons of the given slices into the volume. The slices have to be perpendicular to the
+      same axis, so each thread writes to disjoint memory. */
+  template <typename TPixel>
+  void FillSlices(const mitk::PixelType &,
+                  void *volume,
+                  const unsigned int *dimensions,
+                  const std::vector<const SliceContours *> &slices,
+                  unsigned int numberOfThreads)
+  {
+    if (slices.empty())
+      return;
+
+    const itk::OffsetValueType strides[3] = {
+      1, dimensions[0], static_cast<itk::OffsetValueType>(dimensions[0]) * dimensions[1]};
+
+    std::atomic<std::size_t> nextSlice(0);
+
+    auto worker = [&]() {
+      std::vector<double> crossings;
+
+      for (auto i = nextSlice++; i < slices.size(); i = nextSlice++)
+      {
+        const SliceContours &sliceContours = *slices[i];
+        const unsigned int columnAxis = InPlaneAxes[sliceContours.Axis][0];
+        const unsigned int rowAxis = InPlaneAxes[sliceContours.Axis][1];
+
+        TPixel *slice = static_cast<TPixel *>(volume) + sliceContours.Slice * strides[sliceContours.Axis];
+
+        for (const auto &polygon : sliceContours.Polygons)
+        {
+          FillPolygon(polygon,
+                      slice,
+                      dimensions[columnAxis],
+                      dimensions[rowAxis],
+                      strides[columnAxis],
+                      strides[rowAxis],
+                      crossings);
+        }
+      }
+    };
+
+    numberOfThreads = std::min<std::size_t>(numberOfThreads, slices.size());
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < numberOfThreads; ++i)
+      threads.emplace_back(worker);
+
+    worker();
+
+    for (auto &thread : threads)
+      thread.join();
+  }
+}
 
 mitk::ContourModelSetToImageFilter::ContourModelSetToImageFilter()
-  : m_MakeOutputBinary(true), m_TimeStep(0), m_ReferenceImage(nullptr)
+  : m_MakeOutputBinary(true), m_TimeStep(0), m_NumberOfThreads(0), m_ReferenceImage(nullptr)
 {
   // Create the output.
   itk::DataObject::Pointer output = this->MakeOutput(0);
@@ -136,59 +273,56 @@ void mitk::ContourModelSetToImageFilter::GenerateData()
     return;
   }
 
-  mitk::BaseGeometry *outputImageGeo = outputImage->GetGeometry(m_TimeStep);
+  const mitk::BaseGeometry *outputImageGeo = outputImage->GetGeometry(m_TimeStep);
+  const unsigned int *dimensions = outputImage->GetDimensions();
 
-  // Create mitkVtkImageOverwrite which is needed to write the slice back into the volume
-  vtkSmartPointer<mitkVtkImageOverwrite> reslice = vtkSmartPointer<mitkVtkImageOverwrite>::New();
+  // 1. Project all contours into index coordinates and sort them into the slices they lie in
+  std::map<std::pair<unsigned int, itk::IndexValueType>, SliceContours> sliceContours;
 
-  // Create ExtractSliceFilter for extracting the corresponding slices from the volume
-  mitk::ExtractSliceFilter::Pointer extractor = mitk::ExtractSliceFilter::New(reslice);
-  extractor->SetInput(outputImage);
-  extractor->SetTimeStep(m_TimeStep);
-  extractor->SetResliceTransformByGeometry(outputImageGeo);
+  mitk::Point3D index;
+  std::vector<mitk::Point3D> indices;
 
-  // Fill each contour of the contourmodelset into the image
   auto it = contourSet->Begin();
   auto end = contourSet->End();
   while (it != end)
   {
     mitk::ContourModel *contour = it->GetPointer();
+    ++it;
 
-    // 1. Create slice geometry using the contour points
-    mitk::PlaneGeometry::Pointer plane = mitk::PlaneGeometry::New();
-    mitk::Point3D point3D, tempPoint;
-    mitk::Vector3D normal;
-
-    mitk::Image::Pointer slice;
-
-    int sliceIndex;
-    bool isFrontside = true;
-    bool isRotated = false;
-
-    // Determine plane orientation
-    point3D = contour->GetVertexAt(0)->Coordinates;
-    tempPoint = contour->GetVertexAt(contour->GetNumberOfVertices() * 0.25)->Coordinates;
-    mitk::Vector3D vec = point3D - tempPoint;
-    vec.Normalize();
-    outputImageGeo->WorldToIndex(point3D, point3D);
+    indices.clear();
+    for (auto vertexIt = contour->Begin(); vertexIt != contour->End(); ++vertexIt)
+    {
+      outputImageGeo->WorldToIndex((*vertexIt)->Coordinates, index);
+      indices.push_back(index);
+    }
 
-    mitk::PlaneGeometry::PlaneOrientation orientation;
-    if (mitk::Equal(vec[0], 0))
+    if (indices.size() < 3)
     {
-      orientation = mitk::PlaneGeometry::Sagittal;
-      sliceIndex = point3D[0];
+      mitk::ProgressBar::GetInstance()->Progress();
+      continue;
     }
-    else if (mitk::Equal(vec[1], 0))
+
+    // The slice axis is the one along which the contour does not extend
+    double minIndex[3];
+    double maxIndex[3];
+    for (unsigned int axis = 0; axis < 3; ++axis)
     {
-      orientation = mitk::PlaneGeometry::Frontal;
-      sliceIndex = point3D[1];
+      minIndex[axis] = maxIndex[axis] = indices.front()[axis];
+      for (const auto &point : indices)
+      {
+        minIndex[axis] = std::min(minIndex[axis], point[axis]);
+        maxIndex[axis] = std::max(maxIndex[axis], point[axis]);
+      }
     }
-    else if (mitk::Equal(vec[2], 0))
+
+    unsigned int sliceAxis = 2;
+    for (unsigned int axis = 0; axis < 2; ++axis)
     {
-      orientation = mitk::PlaneGeometry::Axial;
-      sliceIndex = point3D[2];
+      if (maxIndex[axis] - minIndex[axis] < maxIndex[sliceAxis] - minIndex[sliceAxis])
+        sliceAxis = axis;
     }
-    else
+
+    if (maxIndex[sliceAxis] - minIndex[sliceAxis] >= 0.5)
     {
       // TODO Maybe rotate geometry to extract slice?
       MITK_ERROR
@@ -196,46 +330,53 @@ void mitk::ContourModelSetToImageFilter::GenerateData()
       return;
     }
 
-    // Initialize plane using the detected orientation
-    plane->InitializeStandardPlane(outputImageGeo, orientation, sliceIndex, isFrontside, isRotated);
-    point3D = plane->GetOrigin();
-    normal = plane->GetNormal();
-    normal.Normalize();
-    point3D += normal * 0.5; // pixelspacing is 1, so half the spacing is 0.5
-    plane->SetOrigin(point3D);
+    const auto slice =
+      static_cast<itk::IndexValueType>(std::floor(0.5 * (minIndex[sliceAxis] + maxIndex[sliceAxis]) + 0.5));
 
-    // 2. Extract slice at the given position
-    extractor->SetWorldGeometry(plane);
-    extractor->SetVtkOutputRequest(false);
-    reslice->SetOverwriteMode(false);
-
-    extractor->Modified();
-    extractor->Update();
-
-    slice = extractor->GetOutput();
-    slice->DisconnectPipeline();
-
-    // 3. Fill contour into slice
-    mitk::ContourModel::Pointer projectedContour =
-      mitk::ContourModelUtils::ProjectContourTo2DSlice(slice, contour, true, false);
-    mitk::ContourModelUtils::FillContourInSlice(projectedContour, slice, outputImage);
-
-    // 4. Write slice back into image volume
-    reslice->SetInputSlice(slice->GetVtkImageData());
+    if (slice >= 0 && slice < static_cast<itk::IndexValueType>(dimensions[sliceAxis]))
+    {
+      SliceContours &contours = sliceContours[std::make_pair(sliceAxis, slice)];
+      contours.Axis = sliceAxis;
+      contours.Slice = slice;
 
-    // set overwrite mode to true to write back to the image volume
-    reslice->SetOverwriteMode(true);
-    reslice->Modified();
+      const unsigned int columnAxis = InPlaneAxes[sliceAxis][0];
+      const unsigned int rowAxis = InPlaneAxes[sliceAxis][1];
 
-    extractor->Modified();
-    extractor->Update();
+      SlicePolygon polygon;
+      polygon.reserve(indices.size());
+      for (const auto &point : indices)
+        polygon.push_back({point[columnAxis], point[rowAxis]});
 
-    reslice->SetInputSlice(nullptr);
+      contours.Polygons.push_back(std::move(polygon));
+    }
 
     // Progress
     mitk::ProgressBar::GetInstance()->Progress();
+  }
 
-    ++it;
+  // 2. Rasterize the slices of each orientation in parallel
+  const unsigned int numberOfThreads =
+    0 != m_NumberOfThreads ? m_NumberOfThreads : std::max(1u, std::thread::hardware_concurrency());
+
+  {
+    mitk::ImageWriteAccessor writeAccess(outputImage, outputImage->GetVolumeData(m_TimeStep));
+
+    for (unsigned int axis = 0; axis < 3; ++axis)
+    {
+      std::vector<const SliceContours *> slices;
+      for (const auto &entry : sliceContours)
+      {
+        if (entry.first.first == axis)
+          slices.push_back(&entry.second);
+      }
+
+      mitkPixelTypeMultiplex4(FillSlices,
+                              outputImage->GetPixelType(),
+                              writeAccess.GetData(),
+                              dimensions,
+                              slices,
+                              numberOfThreads);
+    }
   }
 
   outputImage->Modified();
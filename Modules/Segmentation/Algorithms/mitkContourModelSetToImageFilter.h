@@ -26,6 +26,11 @@ namespace mitk
 
   /**
     * @brief Fills a given mitk::ContourModelSet into a given mitk::Image
+    *
+    * Every contour has to lie within an axial, sagittal or frontal slice of the reference image. The contours
+    * are projected into index coordinates once and grouped by slice. The slices of each orientation are then
+    * rasterized in parallel by a polygon scanline fill that writes directly into the output volume.
+    *
     * @ingroup Process
     */
   class MITKSEGMENTATION_EXPORT ContourModelSetToImageFilter : public ImageSource
@@ -39,6 +44,10 @@ namespace mitk
 
     itkSetMacro(TimeStep, unsigned int);
 
+    /** @brief Number of threads used to rasterize the slices. 0 (default) uses one thread per hardware thread. */
+    itkSetMacro(NumberOfThreads, unsigned int);
+    itkGetConstMacro(NumberOfThreads, unsigned int);
+
     /**
        * Allocates a new output object and returns it. Currently the
        * index idx is not evaluated.
@@ -88,6 +97,8 @@ namespace mitk
 
     unsigned int m_TimeStep;
 
+    unsigned int m_NumberOfThreads;
+
     const mitk::Image *m_ReferenceImage;
   };
 }
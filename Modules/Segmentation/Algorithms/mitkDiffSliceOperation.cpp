@@ -16,10 +16,16 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkDiffSliceOperation.h"
 
+#include <mitkExtractSliceFilter.h>
 #include <mitkImage.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
 
 #include <itkCommand.h>
 
+#include <algorithm>
+#include <cstring>
+
 mitk::DiffSliceOperation::DiffSliceOperation() : Operation(1)
 {
   m_TimeStep = 0;
@@ -28,6 +34,10 @@ mitk::DiffSliceOperation::DiffSliceOperation() : Operation(1)
   m_WorldGeometry = nullptr;
   m_SliceGeometry = nullptr;
   m_ImageIsValid = false;
+  m_IsSparse = false;
+  m_PixelSize = 0;
+  std::fill(m_ChangedRegion, m_ChangedRegion + 4, 0);
+  std::fill(m_SliceDimensions, m_SliceDimensions + 2, 0);
 }
 
 mitk::DiffSliceOperation::DiffSliceOperation(mitk::Image *imageVolume,
@@ -35,8 +45,40 @@ mitk::DiffSliceOperation::DiffSliceOperation(mitk::Image *imageVolume,
                                              SlicedGeometry3D *sliceGeometry,
                                              unsigned int timestep,
                                              BaseGeometry *currentWorldGeometry)
-  : Operation(1)
+  : Operation(1), m_IsSparse(false), m_PixelSize(0)
+
+{
+  std::fill(m_ChangedRegion, m_ChangedRegion + 4, 0);
+  std::fill(m_SliceDimensions, m_SliceDimensions + 2, 0);
+
+  m_zlibSliceContainer = CompressedImageContainer::New();
+  m_zlibSliceContainer->SetImage(slice);
+
+  this->InitializeGeometryAndObserver(imageVolume, sliceGeometry, timestep, currentWorldGeometry);
+}
+
+mitk::DiffSliceOperation::DiffSliceOperation(mitk::Image *imageVolume,
+                                             mitk::Image *slice,
+                                             mitk::Image *referenceSlice,
+                                             SlicedGeometry3D *sliceGeometry,
+                                             unsigned int timestep,
+                                             BaseGeometry *currentWorldGeometry,
+                                             const unsigned int *searchRegion)
+  : Operation(1), m_IsSparse(true), m_PixelSize(0)
+{
+  std::fill(m_ChangedRegion, m_ChangedRegion + 4, 0);
+  std::fill(m_SliceDimensions, m_SliceDimensions + 2, 0);
+
+  m_zlibSliceContainer = nullptr;
+  this->EncodeSparseSlice(slice, referenceSlice, searchRegion);
+
+  this->InitializeGeometryAndObserver(imageVolume, sliceGeometry, timestep, currentWorldGeometry);
+}
 
+void mitk::DiffSliceOperation::InitializeGeometryAndObserver(mitk::Image *imageVolume,
+                                                             SlicedGeometry3D *sliceGeometry,
+                                                             unsigned int timestep,
+                                                             BaseGeometry *currentWorldGeometry)
 {
   m_WorldGeometry = currentWorldGeometry->Clone();
 
@@ -51,9 +93,6 @@ mitk::DiffSliceOperation::DiffSliceOperation(mitk::Image *imageVolume,
 
   m_TimeStep = timestep;
 
-  m_zlibSliceContainer = CompressedImageContainer::New();
-  m_zlibSliceContainer->SetImage(slice);
-
   m_Image = imageVolume;
 
   if (m_Image)
@@ -84,15 +123,171 @@ mitk::DiffSliceOperation::~DiffSliceOperation()
   m_Image = nullptr;
 }
 
+void mitk::DiffSliceOperation::EncodeSparseSlice(mitk::Image *slice,
+                                                 mitk::Image *referenceSlice,
+                                                 const unsigned int *searchRegion)
+{
+  m_PixelSize = slice->GetPixelType().GetSize();
+  m_SliceDimensions[0] = slice->GetDimension(0);
+  m_SliceDimensions[1] = slice->GetDimension(1);
+
+  if (referenceSlice == nullptr || referenceSlice->GetPixelType() != slice->GetPixelType() ||
+      referenceSlice->GetDimension(0) != m_SliceDimensions[0] ||
+      referenceSlice->GetDimension(1) != m_SliceDimensions[1])
+  {
+    // nothing to compare with, fall back to storing the whole slice
+    m_IsSparse = false;
+    m_zlibSliceContainer = CompressedImageContainer::New();
+    m_zlibSliceContainer->SetImage(slice);
+    return;
+  }
+
+  ImageReadAccessor sliceAccessor(slice, slice->GetSliceData(0));
+  ImageReadAccessor referenceAccessor(referenceSlice, referenceSlice->GetSliceData(0));
+  const auto *sliceData = static_cast<const unsigned char *>(sliceAccessor.GetData());
+  const auto *referenceData = static_cast<const unsigned char *>(referenceAccessor.GetData());
+
+  unsigned int searchBegin[2] = {0, 0};
+  unsigned int searchEnd[2] = {m_SliceDimensions[0], m_SliceDimensions[1]};
+  if (searchRegion != nullptr)
+  {
+    for (int i = 0; i < 2; ++i)
+    {
+      searchBegin[i] = std::min(searchRegion[i], m_SliceDimensions[i]);
+      searchEnd[i] = std::min(searchRegion[i] + searchRegion[i + 2], m_SliceDimensions[i]);
+    }
+  }
+
+  // bounding box of all differing voxels
+  unsigned int minX = m_SliceDimensions[0], minY = m_SliceDimensions[1], maxX = 0, maxY = 0;
+  for (unsigned int y = searchBegin[1]; y < searchEnd[1]; ++y)
+  {
+    const std::size_t rowOffset = static_cast<std::size_t>(y) * m_SliceDimensions[0] * m_PixelSize;
+    for (unsigned int x = searchBegin[0]; x < searchEnd[0]; ++x)
+    {
+      const std::size_t offset = rowOffset + x * m_PixelSize;
+      if (std::memcmp(sliceData + offset, referenceData + offset, m_PixelSize) != 0)
+      {
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+      }
+    }
+  }
+
+  if (minX > maxX || minY > maxY)
+  {
+    // slices are identical
+    return;
+  }
+
+  m_ChangedRegion[0] = minX;
+  m_ChangedRegion[1] = minY;
+  m_ChangedRegion[2] = maxX - minX + 1;
+  m_ChangedRegion[3] = maxY - minY + 1;
+
+  // run-length encode the bounding box row by row
+  const unsigned char *runValue = nullptr;
+  for (unsigned int y = minY; y <= maxY; ++y)
+  {
+    for (unsigned int x = minX; x <= maxX; ++x)
+    {
+      const unsigned char *value =
+        sliceData + (static_cast<std::size_t>(y) * m_SliceDimensions[0] + x) * m_PixelSize;
+      if (runValue != nullptr && std::memcmp(runValue, value, m_PixelSize) == 0)
+      {
+        ++m_RunLengths.back();
+      }
+      else
+      {
+        m_RunLengths.push_back(1);
+        m_RunValues.insert(m_RunValues.end(), value, value + m_PixelSize);
+        runValue = value;
+      }
+    }
+  }
+
+  m_RunLengths.shrink_to_fit();
+  m_RunValues.shrink_to_fit();
+}
+
+mitk::Image::Pointer mitk::DiffSliceOperation::DecodeSparseSlice()
+{
+  // the current slice of the volume equals the stored slice outside of the changed region
+  ExtractSliceFilter::Pointer extractor = ExtractSliceFilter::New();
+  extractor->SetInput(m_Image);
+  extractor->SetTimeStep(m_TimeStep);
+  extractor->SetWorldGeometry(dynamic_cast<PlaneGeometry *>(m_WorldGeometry.GetPointer()));
+  extractor->SetVtkOutputRequest(false);
+  extractor->SetResliceTransformByGeometry(m_Image->GetGeometry(m_TimeStep));
+  extractor->Update();
+
+  Image::Pointer slice = extractor->GetOutput();
+  slice->DisconnectPipeline();
+
+  if (slice->GetDimension(0) != m_SliceDimensions[0] || slice->GetDimension(1) != m_SliceDimensions[1] ||
+      slice->GetPixelType().GetSize() != m_PixelSize)
+  {
+    MITK_ERROR << "Slice extracted for undo/redo does not match the stored slice";
+    return slice;
+  }
+
+  if (m_RunLengths.empty())
+    return slice;
+
+  ImageWriteAccessor accessor(slice, slice->GetSliceData(0));
+  auto *data = static_cast<unsigned char *>(accessor.GetData());
+
+  std::size_t run = 0;
+  unsigned int remaining = m_RunLengths[0];
+  for (unsigned int y = m_ChangedRegion[1]; y < m_ChangedRegion[1] + m_ChangedRegion[3]; ++y)
+  {
+    for (unsigned int x = m_ChangedRegion[0]; x < m_ChangedRegion[0] + m_ChangedRegion[2]; ++x)
+    {
+      if (remaining == 0)
+        remaining = m_RunLengths[++run];
+
+      std::memcpy(data + (static_cast<std::size_t>(y) * m_SliceDimensions[0] + x) * m_PixelSize,
+                  m_RunValues.data() + run * m_PixelSize,
+                  m_PixelSize);
+      --remaining;
+    }
+  }
+
+  slice->GetSliceData(0)->Modified();
+  return slice;
+}
+
 mitk::Image::Pointer mitk::DiffSliceOperation::GetSlice()
 {
+  if (m_IsSparse)
+  {
+    return this->DecodeSparseSlice();
+  }
+
   Image::Pointer image = m_zlibSliceContainer->GetImage();
   return image;
 }
 
 bool mitk::DiffSliceOperation::IsValid()
 {
-  return m_ImageIsValid && m_zlibSliceContainer.IsNotNull() && (m_WorldGeometry.IsNotNull()); // TODO improve
+  return m_ImageIsValid && (m_IsSparse || m_zlibSliceContainer.IsNotNull()) &&
+         (m_WorldGeometry.IsNotNull()); // TODO improve
+}
+
+std::size_t mitk::DiffSliceOperation::GetMemorySize() const
+{
+  std::size_t size = sizeof(*this);
+  if (m_IsSparse)
+  {
+    size += m_RunLengths.capacity() * sizeof(unsigned int) + m_RunValues.capacity();
+  }
+  else if (m_zlibSliceContainer.IsNotNull())
+  {
+    size += m_zlibSliceContainer->GetCompressedSizeInBytes();
+  }
+  return size;
 }
 
 void mitk::DiffSliceOperation::OnImageDeleted()
@@ -23,6 +23,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <vtkSmartPointer.h>
 
+#include <vector>
+
 namespace mitk
 {
   class Image;
@@ -38,6 +40,12 @@ namespace mitk
      currentWorldGeometry   specifies the axis where the slice has to be applied in the volume.
 
     This Operation can be used to realize undo-redo functionality for e.g. segmentation purposes.
+
+    If a reference slice is given, the operation is stored sparse: only the bounding box of the
+    voxels that differ between slice and reference slice is kept, run-length encoded. When the
+    operation is applied, the remaining voxels are taken from the current state of the volume,
+    which equals the reference slice outside of the bounding box as long as the operations are
+    applied in the order of a linear undo stack.
   */
   class MITKSEGMENTATION_EXPORT DiffSliceOperation : public Operation
   {
@@ -61,6 +69,18 @@ namespace mitk
                        unsigned int timestep,
                        BaseGeometry *currentWorldGeometry);
 
+    /** \brief Creates a sparse operation that only stores the voxels of slice which differ from referenceSlice.
+      Both slices have to be extracted from imageVolume with the same currentWorldGeometry.
+      If the caller knows that the slices can only differ within a rectangle, it can pass it as searchRegion
+      (x, y, width, height in slice index coordinates) to restrict the comparison to it.*/
+    DiffSliceOperation(mitk::Image *imageVolume,
+                       mitk::Image *slice,
+                       mitk::Image *referenceSlice,
+                       SlicedGeometry3D *sliceGeometry,
+                       unsigned int timestep,
+                       BaseGeometry *currentWorldGeometry,
+                       const unsigned int *searchRegion = nullptr);
+
     /** \brief Check if it is a valid operation.*/
     bool IsValid();
 
@@ -85,12 +105,30 @@ namespace mitk
     void SetCurrentWorldGeometry(BaseGeometry *worldGeometry) { this->m_WorldGeometry = worldGeometry; }
     /** \brief Get the axis where the slice has to be applied in the volume.*/
     BaseGeometry *GetWorldGeometry() { return this->m_WorldGeometry; }
+
+    /** \brief True if only the changed region of the slice is stored.*/
+    bool IsSparse() const { return m_IsSparse; }
+
+    /** \brief Returns the memory held by the stored slice data.*/
+    std::size_t GetMemorySize() const override;
+
   protected:
     ~DiffSliceOperation() override;
 
     /** \brief Callback for image observer.*/
     void OnImageDeleted();
 
+    void InitializeGeometryAndObserver(mitk::Image *imageVolume,
+                                       SlicedGeometry3D *sliceGeometry,
+                                       unsigned int timestep,
+                                       BaseGeometry *currentWorldGeometry);
+
+    /** \brief Stores the bounding box of the voxels that differ as runs of equal pixels.*/
+    void EncodeSparseSlice(mitk::Image *slice, mitk::Image *referenceSlice, const unsigned int *searchRegion);
+
+    /** \brief Extracts the current slice from the volume and writes the stored runs into it.*/
+    Image::Pointer DecodeSparseSlice();
+
     CompressedImageContainer::Pointer m_zlibSliceContainer;
 
     mitk::Image *m_Image;
@@ -108,6 +146,14 @@ namespace mitk
     unsigned long m_DeleteObserverTag;
 
     mitk::BaseGeometry::ConstPointer m_GuardReferenceGeometry;
+
+    bool m_IsSparse;
+    /** bounding box of the changed voxels: x, y, width, height; empty if nothing changed */
+    unsigned int m_ChangedRegion[4];
+    unsigned int m_SliceDimensions[2];
+    std::size_t m_PixelSize;
+    std::vector<unsigned int> m_RunLengths;
+    std::vector<unsigned char> m_RunValues;
   };
 }
 #endif
@@ -22,6 +22,20 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkIOUtil.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+namespace
+{
+  // The local costs lie between 0 and 1, so a horizontal or vertical step costs between 0 and 100
+  const double CostQuantizationFactor = 100.0;
+
+  // Costs of a step from or onto a repulsive point, see ShortestPathCostFunctionLiveWire::GetCost()
+  const unsigned int QuantizedRepulsiveCost = 1000 * 100;
+}
+
 mitk::ImageLiveWireContourModelFilter::ImageLiveWireContourModelFilter()
 {
   OutputType::Pointer output = dynamic_cast<OutputType *>(this->MakeOutput(0).GetPointer());
@@ -33,6 +47,14 @@ mitk::ImageLiveWireContourModelFilter::ImageLiveWireContourModelFilter()
   m_ShortestPathFilter->SetCostFunction(m_CostFunction);
   m_UseDynamicCostMap = false;
   m_TimeStep = 0;
+  m_UseIncrementalSearch = false;
+  m_QuantizedCostsAreValid = false;
+  m_QuantizedCostsUseDynamicCostMap = false;
+  m_QuantizedCostsTime = 0;
+  m_SearchIsValid = false;
+  m_SearchStartNode = 0;
+  m_CurrentDistance = 0;
+  m_NumberOfQueuedNodes = 0;
 }
 
 mitk::ImageLiveWireContourModelFilter::~ImageLiveWireContourModelFilter()
@@ -130,16 +152,21 @@ void mitk::ImageLiveWireContourModelFilter::ItkPreProcessImage(const itk::Image<
   m_InternalImage = castFilter->GetOutput();
   m_CostFunction->SetImage(m_InternalImage);
   m_ShortestPathFilter->SetInput(m_InternalImage);
+
+  m_QuantizedCostsAreValid = false;
+  m_SearchIsValid = false;
 }
 
 void mitk::ImageLiveWireContourModelFilter::ClearRepulsivePoints()
 {
   m_CostFunction->ClearRepulsivePoints();
+  m_SearchIsValid = false;
 }
 
 void mitk::ImageLiveWireContourModelFilter::AddRepulsivePoint(const itk::Index<2> &idx)
 {
   m_CostFunction->AddRepulsivePoint(idx);
+  m_SearchIsValid = false;
 }
 
 void mitk::ImageLiveWireContourModelFilter::DumpMaskImage()
@@ -153,11 +180,13 @@ void mitk::ImageLiveWireContourModelFilter::DumpMaskImage()
 void mitk::ImageLiveWireContourModelFilter::RemoveRepulsivePoint(const itk::Index<2> &idx)
 {
   m_CostFunction->RemoveRepulsivePoint(idx);
+  m_SearchIsValid = false;
 }
 
 void mitk::ImageLiveWireContourModelFilter::SetRepulsivePoints(const ShortestPathType &points)
 {
   m_CostFunction->ClearRepulsivePoints();
+  m_SearchIsValid = false;
 
   auto iter = points.begin();
   for (; iter != points.end(); iter++)
@@ -200,20 +229,29 @@ void mitk::ImageLiveWireContourModelFilter::UpdateLiveWire()
   m_CostFunction->SetRequestedRegion(region);
   m_CostFunction->SetUseCostMap(m_UseDynamicCostMap);
 
-  // calculate shortest path between start and end point
-  m_ShortestPathFilter->SetFullNeighborsMode(true);
-  // m_ShortestPathFilter->SetInput( m_CostFunction->SetImage(m_InternalImage) );
-  m_ShortestPathFilter->SetMakeOutputImage(false);
+  ShortestPathType shortestPath;
 
-  // m_ShortestPathFilter->SetCalcAllDistances(true);
-  m_ShortestPathFilter->SetStartIndex(startPoint);
-  m_ShortestPathFilter->SetEndIndex(endPoint);
+  if (m_UseIncrementalSearch)
+  {
+    shortestPath = this->SearchIncrementally(startPoint, endPoint);
+  }
+  else
+  {
+    // calculate shortest path between start and end point
+    m_ShortestPathFilter->SetFullNeighborsMode(true);
+    // m_ShortestPathFilter->SetInput( m_CostFunction->SetImage(m_InternalImage) );
+    m_ShortestPathFilter->SetMakeOutputImage(false);
 
-  m_ShortestPathFilter->Update();
+    // m_ShortestPathFilter->SetCalcAllDistances(true);
+    m_ShortestPathFilter->SetStartIndex(startPoint);
+    m_ShortestPathFilter->SetEndIndex(endPoint);
 
-  // construct contour from path image
-  // get the shortest path as vector
-  ShortestPathType shortestPath = m_ShortestPathFilter->GetVectorPath();
+    m_ShortestPathFilter->Update();
+
+    // construct contour from path image
+    // get the shortest path as vector
+    shortestPath = m_ShortestPathFilter->GetVectorPath();
+  }
 
   // fill the output contour with control points from the path
   OutputType::Pointer output = dynamic_cast<OutputType *>(this->MakeOutput(0).GetPointer());
@@ -242,6 +280,171 @@ void mitk::ImageLiveWireContourModelFilter::UpdateLiveWire()
   }
 }
 
+mitk::ImageLiveWireContourModelFilter::ShortestPathType mitk::ImageLiveWireContourModelFilter::SearchIncrementally(
+  const itk::Index<2> &startPoint, const itk::Index<2> &endPoint)
+{
+  m_CostFunction->Initialize();
+
+  // The costs only have to be computed again if the slice or the cost map has changed
+  if (!m_QuantizedCostsAreValid || m_QuantizedCostsUseDynamicCostMap != m_UseDynamicCostMap ||
+      m_QuantizedCostsTime < m_CostFunction->GetMTime())
+  {
+    this->ComputeQuantizedCosts();
+    m_SearchIsValid = false;
+  }
+
+  const InternalImageType::SizeType size = m_InternalImage->GetLargestPossibleRegion().GetSize();
+  const unsigned int numberOfNodes = size[0] * size[1];
+  const unsigned int startNode = startPoint[1] * size[0] + startPoint[0];
+  const unsigned int endNode = endPoint[1] * size[0] + endPoint[0];
+
+  // The search tree can be extended as long as the start point and the costs stay the same
+  if (!m_SearchIsValid || m_SearchStartNode != startNode)
+  {
+    m_Distances.assign(numberOfNodes, std::numeric_limits<unsigned long long>::max());
+    m_Predecessors.assign(numberOfNodes, startNode);
+    m_Closed.assign(numberOfNodes, 0);
+    for (auto &bucket : m_Buckets)
+      bucket.clear();
+
+    m_Distances[startNode] = 0;
+    m_Buckets[0].push_back(startNode);
+    m_CurrentDistance = 0;
+    m_NumberOfQueuedNodes = 1;
+    m_SearchStartNode = startNode;
+    m_SearchIsValid = true;
+  }
+
+  this->ExtendSearch(endNode);
+
+  ShortestPathType shortestPath;
+  if (!m_Closed[endNode])
+    return shortestPath;
+
+  itk::Index<2> index;
+  for (unsigned int node = endNode; node != startNode; node = m_Predecessors[node])
+  {
+    index[0] = node % size[0];
+    index[1] = node / size[0];
+    shortestPath.push_back(index);
+  }
+  shortestPath.push_back(startPoint);
+  std::reverse(shortestPath.begin(), shortestPath.end());
+
+  return shortestPath;
+}
+
+void mitk::ImageLiveWireContourModelFilter::ComputeQuantizedCosts()
+{
+  const InternalImageType::SizeType size = m_InternalImage->GetLargestPossibleRegion().GetSize();
+  const unsigned int width = size[0];
+  const unsigned int height = size[1];
+  m_QuantizedCosts.resize(width * height);
+
+  auto computeRows = [this, width](unsigned int firstRow, unsigned int endRow) {
+    itk::Index<2> index;
+    for (unsigned int y = firstRow; y < endRow; ++y)
+    {
+      index[1] = y;
+      for (unsigned int x = 0; x < width; ++x)
+      {
+        index[0] = x;
+        const double cost = m_CostFunction->GetLocalCost(index);
+
+        // Without gradient the costs are undefined, treat such pixels like the worst ones
+        const double clampedCost = std::isfinite(cost) ? std::min(std::max(cost, 0.0), 1.0) : 1.0;
+        m_QuantizedCosts[y * width + x] = static_cast<unsigned int>(clampedCost * CostQuantizationFactor + 0.5);
+      }
+    }
+  };
+
+  const unsigned int numberOfThreads = std::max(1u, std::min(std::thread::hardware_concurrency(), height));
+  const unsigned int rowsPerThread = (height + numberOfThreads - 1) / numberOfThreads;
+
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < numberOfThreads; ++i)
+  {
+    threads.emplace_back(computeRows, std::min(height, i * rowsPerThread), std::min(height, (i + 1) * rowsPerThread));
+  }
+  computeRows(0, std::min(height, rowsPerThread));
+
+  for (auto &thread : threads)
+    thread.join();
+
+  // Every step costs at most QuantizedRepulsiveCost, so the queued distances always fit into the ring of buckets
+  m_Buckets.resize(QuantizedRepulsiveCost + 1);
+
+  m_QuantizedCostsAreValid = true;
+  m_QuantizedCostsUseDynamicCostMap = m_UseDynamicCostMap;
+  m_QuantizedCostsTime = m_CostFunction->GetMTime();
+}
+
+void mitk::ImageLiveWireContourModelFilter::ExtendSearch(unsigned int targetNode)
+{
+  const InternalImageType::SizeType size = m_InternalImage->GetLargestPossibleRegion().GetSize();
+  const long width = size[0];
+  const long height = size[1];
+  const unsigned char *mask = m_CostFunction->GetMaskImage()->GetBufferPointer();
+  const unsigned int numberOfBuckets = m_Buckets.size();
+  const double sqrtOfTwo = std::sqrt(2.0);
+
+  // Dial's algorithm: the queued nodes are kept in buckets by their integer distance
+  while (!m_Closed[targetNode] && m_NumberOfQueuedNodes > 0)
+  {
+    std::vector<unsigned int> &bucket = m_Buckets[m_CurrentDistance % numberOfBuckets];
+    if (bucket.empty())
+    {
+      ++m_CurrentDistance;
+      continue;
+    }
+
+    const unsigned int node = bucket.back();
+    bucket.pop_back();
+    --m_NumberOfQueuedNodes;
+
+    // Skip outdated entries of nodes that were queued again with a lower distance
+    if (m_Closed[node] || m_Distances[node] != m_CurrentDistance)
+      continue;
+
+    m_Closed[node] = 1;
+
+    const long x = node % width;
+    const long y = node / width;
+    for (long offsetY = -1; offsetY <= 1; ++offsetY)
+    {
+      for (long offsetX = -1; offsetX <= 1; ++offsetX)
+      {
+        const long neighborX = x + offsetX;
+        const long neighborY = y + offsetY;
+        if ((offsetX == 0 && offsetY == 0) || neighborX < 0 || neighborX >= width || neighborY < 0 ||
+            neighborY >= height)
+          continue;
+
+        const unsigned int neighbor = neighborY * width + neighborX;
+        if (m_Closed[neighbor])
+          continue;
+
+        unsigned int cost;
+        if (mask[node] != 0 || mask[neighbor] != 0)
+          cost = QuantizedRepulsiveCost;
+        else if (offsetX == 0 || offsetY == 0)
+          cost = m_QuantizedCosts[neighbor];
+        else
+          cost = static_cast<unsigned int>(m_QuantizedCosts[neighbor] * sqrtOfTwo + 0.5);
+
+        const unsigned long long distance = m_CurrentDistance + cost;
+        if (distance < m_Distances[neighbor])
+        {
+          m_Distances[neighbor] = distance;
+          m_Predecessors[neighbor] = node;
+          m_Buckets[distance % numberOfBuckets].push_back(neighbor);
+          ++m_NumberOfQueuedNodes;
+        }
+      }
+    }
+  }
+}
+
 bool mitk::ImageLiveWireContourModelFilter::CreateDynamicCostMap(mitk::ContourModel *path)
 {
   mitk::Image::ConstPointer input = dynamic_cast<const mitk::Image *>(this->GetInput());
@@ -43,6 +43,11 @@ namespace mitk
    \Note On the fly training will only be used for next update.
    The computation uses the last calculated segment to map cost according to features in the area of the segment.
 
+   With SetUseIncrementalSearch(true) the costs of all pixels are computed in parallel once per slice and quantized
+   to integers, so the shortest path can be searched with a bucket queue (Dial's algorithm). As long as the start point
+   stays the same, the search tree is kept and only extended until it reaches a new end point. This makes the
+   feedback real-time while the mouse moves, even on large slices.
+
    For time resolved purposes use ImageLiveWireContourModelFilter::SetTimestep( unsigned int ) to create the LiveWire
    contour
    at a specific timestep.
@@ -80,6 +85,12 @@ namespace mitk
     itkSetMacro(UseDynamicCostMap, bool);
     itkGetMacro(UseDynamicCostMap, bool);
 
+    /** \brief Use precomputed integer costs and keep the search tree of the start point between updates.
+    */
+    itkSetMacro(UseIncrementalSearch, bool);
+    itkGetMacro(UseIncrementalSearch, bool);
+    itkBooleanMacro(UseIncrementalSearch);
+
     /** \brief Actual time step
     */
     itkSetMacro(TimeStep, unsigned int);
@@ -128,6 +139,15 @@ namespace mitk
 
     void UpdateLiveWire();
 
+    /** \brief Computes the shortest path with the precomputed integer costs and the kept search tree*/
+    ShortestPathType SearchIncrementally(const itk::Index<2> &startPoint, const itk::Index<2> &endPoint);
+
+    /** \brief Computes the quantized costs of all pixels of the current slice in parallel*/
+    void ComputeQuantizedCosts();
+
+    /** \brief Extends the search tree until the given node is reached or no node is left*/
+    void ExtendSearch(unsigned int targetNode);
+
     /** \brief start point in worldcoordinates*/
     mitk::Point3D m_StartPoint;
 
@@ -151,6 +171,24 @@ namespace mitk
 
     unsigned int m_TimeStep;
 
+    bool m_UseIncrementalSearch;
+
+    /** \brief Quantized costs of entering each pixel from a horizontal or vertical neighbor*/
+    std::vector<unsigned int> m_QuantizedCosts;
+    bool m_QuantizedCostsAreValid;
+    bool m_QuantizedCostsUseDynamicCostMap;
+    itk::ModifiedTimeType m_QuantizedCostsTime;
+
+    /** \brief State of the search tree of m_SearchStartNode*/
+    bool m_SearchIsValid;
+    unsigned int m_SearchStartNode;
+    std::vector<unsigned long long> m_Distances;
+    std::vector<unsigned int> m_Predecessors;
+    std::vector<unsigned char> m_Closed;
+    std::vector<std::vector<unsigned int>> m_Buckets;
+    unsigned long long m_CurrentDistance;
+    unsigned int m_NumberOfQueuedNodes;
+
     template <typename TPixel, unsigned int VImageDimension>
     void ItkPreProcessImage(const itk::Image<TPixel, VImageDimension> *inputImage);
 
@@ -15,62 +15,342 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "mitkOtsuSegmentationFilter.h"
-#include "itkOtsuMultipleThresholdsImageFilter.h"
 #include "mitkImageAccessByItk.h"
 #include "mitkImageCast.h"
 
-struct paramContainer
-{
-  paramContainer(unsigned int numThresholds, bool useValley, unsigned int numBins, mitk::Image::Pointer image)
-    : m_NumberOfThresholds(numThresholds), m_ValleyEmphasis(useValley), m_NumberOfBins(numBins), m_Image(image)
-  {
-  }
+#include <itkHistogram.h>
+#include <itkOtsuMultipleThresholdsCalculator.h>
 
-  unsigned int m_NumberOfThresholds;
-  bool m_ValleyEmphasis;
-  unsigned int m_NumberOfBins;
-  mitk::Image::Pointer m_Image;
-};
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
 
-template <typename TPixel, unsigned int VImageDimension>
-void AccessItkOtsuFilter(const itk::Image<TPixel, VImageDimension> *itkImage, paramContainer params)
+namespace
 {
-  typedef itk::Image<TPixel, VImageDimension> itkInputImageType;
-  typedef itk::Image<mitk::OtsuSegmentationFilter::OutputPixelType, VImageDimension> itkOutputImageType;
-  typedef itk::OtsuMultipleThresholdsImageFilter<itkInputImageType, itkOutputImageType> OtsuFilterType;
+  // Calls function(begin, end, thread) for consecutive ranges of [0, size), one per thread
+  template <typename TFunction>
+  void ParallelForRanges(std::size_t size, unsigned int numberOfThreads, const TFunction &function)
+  {
+    const std::size_t chunkSize = (size + numberOfThreads - 1) / numberOfThreads;
 
-  typename OtsuFilterType::Pointer filter = OtsuFilterType::New();
-  filter->SetNumberOfThresholds(params.m_NumberOfThresholds);
-  filter->SetInput(itkImage);
-  filter->SetValleyEmphasis(params.m_ValleyEmphasis);
-  filter->SetNumberOfHistogramBins(params.m_NumberOfBins);
+    std::vector<std::thread> threads;
+    for (unsigned int thread = 1; thread < numberOfThreads; ++thread)
+    {
+      const std::size_t begin = std::min(size, thread * chunkSize);
+      const std::size_t end = std::min(size, begin + chunkSize);
+      threads.emplace_back([&function, begin, end, thread]() { function(begin, end, thread); });
+    }
+    function(0, std::min(size, chunkSize), 0u);
 
-  try
-  {
-    filter->Update();
+    for (auto &thread : threads)
+      thread.join();
   }
-  catch (...)
+
+  // maps pixel values to histogram bins, values outside of the histogram range go to the first or last bin
+  class BinMapper
   {
-    mitkThrow() << "itkOtsuFilter error.";
-  }
+  public:
+    BinMapper(double minimum, double maximum, std::size_t numberOfBins)
+      : m_Minimum(minimum),
+        m_Scale(maximum > minimum ? numberOfBins / (maximum - minimum) : 0.0),
+        m_LastBin(numberOfBins - 1)
+    {
+    }
+
+    std::size_t operator()(double value) const
+    {
+      const double bin = (value - m_Minimum) * m_Scale;
+      if (bin <= 0.0)
+        return 0;
+      return std::min(m_LastBin, static_cast<std::size_t>(bin));
+    }
 
-  mitk::CastToMitkImage<itkOutputImageType>(filter->GetOutput(), params.m_Image);
-  return;
+  private:
+    double m_Minimum;
+    double m_Scale;
+    std::size_t m_LastBin;
+  };
 }
 
 namespace mitk
 {
   OtsuSegmentationFilter::OtsuSegmentationFilter()
-    : m_NumberOfThresholds(2), m_ValleyEmphasis(false), m_NumberOfBins(128)
+    : m_NumberOfThresholds(2),
+      m_ValleyEmphasis(false),
+      m_NumberOfBins(128),
+      m_NumberOfThreads(0),
+      m_HistogramMinimum(0.0),
+      m_HistogramMaximum(0.0),
+      m_HistogramInput(nullptr),
+      m_HistogramMask(nullptr),
+      m_HistogramNumberOfBins(0)
   {
   }
 
   OtsuSegmentationFilter::~OtsuSegmentationFilter() {}
+
+  void OtsuSegmentationFilter::SetMaskImage(const Image *mask)
+  {
+    if (m_MaskImage != mask)
+    {
+      m_MaskImage = mask;
+      this->Modified();
+    }
+  }
+
   void OtsuSegmentationFilter::GenerateData()
   {
     mitk::Image::ConstPointer mitkImage = GetInput();
-    AccessByItk_n(mitkImage,
-                  AccessItkOtsuFilter,
-                  (paramContainer(m_NumberOfThresholds, m_ValleyEmphasis, m_NumberOfBins, this->GetOutput())));
+
+    if (m_NumberOfThresholds > std::numeric_limits<OutputPixelType>::max())
+      mitkThrow() << "The Otsu segmentation cannot label more than "
+                  << static_cast<int>(std::numeric_limits<OutputPixelType>::max()) + 1 << " regions.";
+
+    // the histogram only depends on the image, the mask and the bins, not on the number of thresholds
+    if (!this->IsHistogramUpToDate())
+    {
+      AccessByItk(mitkImage, ComputeHistogram);
+    }
+
+    m_ThresholdBins = m_ValleyEmphasis ? this->ComputeValleyEmphasisThresholdBins() :
+                                         ComputeThresholdBins(m_Histogram, m_NumberOfThresholds);
+
+    const double binWidth = (m_HistogramMaximum - m_HistogramMinimum) / m_Histogram.size();
+    m_Thresholds.clear();
+    for (unsigned int bin : m_ThresholdBins)
+      m_Thresholds.push_back(m_HistogramMinimum + (bin + 1) * binWidth);
+
+    AccessByItk(mitkImage, ComputeLabels);
+  }
+
+  bool OtsuSegmentationFilter::IsHistogramUpToDate() const
+  {
+    const Image *input = this->GetInput();
+    if (m_Histogram.empty() || input != m_HistogramInput || m_MaskImage.GetPointer() != m_HistogramMask ||
+        m_NumberOfBins != m_HistogramNumberOfBins)
+      return false;
+
+    if (input->GetMTime() > m_HistogramTime.GetMTime())
+      return false;
+
+    return m_MaskImage.IsNull() || m_MaskImage->GetMTime() <= m_HistogramTime.GetMTime();
+  }
+
+  unsigned int OtsuSegmentationFilter::GetNumberOfThreadsToUse() const
+  {
+    return 0 != m_NumberOfThreads ? m_NumberOfThreads : std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  template <typename TPixel, unsigned int VImageDimension>
+  void OtsuSegmentationFilter::ComputeHistogram(const itk::Image<TPixel, VImageDimension> *itkImage)
+  {
+    typedef itk::Image<unsigned char, VImageDimension> MaskImageType;
+
+    const TPixel *pixels = itkImage->GetBufferPointer();
+    const std::size_t numberOfPixels = itkImage->GetBufferedRegion().GetNumberOfPixels();
+
+    typename MaskImageType::Pointer itkMask;
+    const unsigned char *mask = nullptr;
+    if (m_MaskImage.IsNotNull())
+    {
+      CastToItkImage(m_MaskImage, itkMask);
+      if (itkMask->GetBufferedRegion().GetSize() != itkImage->GetBufferedRegion().GetSize())
+        mitkThrow() << "The mask of the Otsu segmentation does not match the size of the image.";
+      mask = itkMask->GetBufferPointer();
+    }
+
+    const unsigned int numberOfThreads = this->GetNumberOfThreadsToUse();
+
+    // 1. range of the histogram
+    std::vector<double> minima(numberOfThreads, std::numeric_limits<double>::max());
+    std::vector<double> maxima(numberOfThreads, std::numeric_limits<double>::lowest());
+    ParallelForRanges(numberOfPixels, numberOfThreads, [&](std::size_t begin, std::size_t end, unsigned int thread) {
+      double minimum = minima[thread];
+      double maximum = maxima[thread];
+      for (std::size_t i = begin; i < end; ++i)
+      {
+        if (mask && !mask[i])
+          continue;
+        const auto value = static_cast<double>(pixels[i]);
+        minimum = std::min(minimum, value);
+        maximum = std::max(maximum, value);
+      }
+      minima[thread] = minimum;
+      maxima[thread] = maximum;
+    });
+
+    const double minimum = *std::min_element(minima.begin(), minima.end());
+    const double maximum = *std::max_element(maxima.begin(), maxima.end());
+    if (minimum > maximum)
+      mitkThrow() << "The Otsu segmentation has no pixels to compute the histogram from.";
+
+    // 2. one histogram per thread, summed up afterwards
+    const BinMapper binMapper(minimum, maximum, m_NumberOfBins);
+    std::vector<std::vector<double>> histograms(numberOfThreads, std::vector<double>(m_NumberOfBins, 0.0));
+    ParallelForRanges(numberOfPixels, numberOfThreads, [&](std::size_t begin, std::size_t end, unsigned int thread) {
+      std::vector<double> &histogram = histograms[thread];
+      for (std::size_t i = begin; i < end; ++i)
+      {
+        if (mask && !mask[i])
+          continue;
+        histogram[binMapper(static_cast<double>(pixels[i]))] += 1.0;
+      }
+    });
+
+    m_Histogram.assign(m_NumberOfBins, 0.0);
+    for (const auto &histogram : histograms)
+    {
+      for (unsigned int bin = 0; bin < m_NumberOfBins; ++bin)
+        m_Histogram[bin] += histogram[bin];
+    }
+
+    m_HistogramMinimum = minimum;
+    m_HistogramMaximum = maximum;
+    m_HistogramInput = this->GetInput();
+    m_HistogramMask = m_MaskImage;
+    m_HistogramNumberOfBins = m_NumberOfBins;
+    m_HistogramTime.Modified();
+  }
+
+  template <typename TPixel, unsigned int VImageDimension>
+  void OtsuSegmentationFilter::ComputeLabels(const itk::Image<TPixel, VImageDimension> *itkImage)
+  {
+    typedef itk::Image<OutputPixelType, VImageDimension> itkOutputImageType;
+
+    // region of each histogram bin
+    std::vector<OutputPixelType> binLabels(m_Histogram.size());
+    OutputPixelType label = 0;
+    for (std::size_t bin = 0; bin < binLabels.size(); ++bin)
+    {
+      binLabels[bin] = label;
+      if (label < m_ThresholdBins.size() && bin == m_ThresholdBins[label])
+        ++label;
+    }
+
+    typename itkOutputImageType::Pointer labelImage = itkOutputImageType::New();
+    labelImage->CopyInformation(itkImage);
+    labelImage->SetRegions(itkImage->GetBufferedRegion());
+    labelImage->Allocate();
+
+    const TPixel *pixels = itkImage->GetBufferPointer();
+    OutputPixelType *labels = labelImage->GetBufferPointer();
+    const BinMapper binMapper(m_HistogramMinimum, m_HistogramMaximum, m_Histogram.size());
+    ParallelForRanges(itkImage->GetBufferedRegion().GetNumberOfPixels(),
+                      this->GetNumberOfThreadsToUse(),
+                      [&](std::size_t begin, std::size_t end, unsigned int) {
+                        for (std::size_t i = begin; i < end; ++i)
+                          labels[i] = binLabels[binMapper(static_cast<double>(pixels[i]))];
+                      });
+
+    mitk::GrabItkImageMemory(labelImage, this->GetOutput());
+  }
+
+  std::vector<unsigned int> OtsuSegmentationFilter::ComputeValleyEmphasisThresholdBins() const
+  {
+    typedef itk::Statistics::Histogram<double> HistogramType;
+    typedef itk::OtsuMultipleThresholdsCalculator<HistogramType> CalculatorType;
+
+    const std::size_t numberOfBins = m_Histogram.size();
+    if (numberOfBins <= m_NumberOfThresholds)
+      mitkThrow() << "The Otsu segmentation needs more histogram bins than thresholds.";
+
+    HistogramType::Pointer histogram = HistogramType::New();
+    HistogramType::SizeType size(1);
+    size[0] = numberOfBins;
+    HistogramType::MeasurementVectorType lowerBound(1);
+    HistogramType::MeasurementVectorType upperBound(1);
+    lowerBound[0] = m_HistogramMinimum;
+    upperBound[0] = m_HistogramMaximum > m_HistogramMinimum ? m_HistogramMaximum : m_HistogramMinimum + 1.0;
+    histogram->SetMeasurementVectorSize(1);
+    histogram->Initialize(size, lowerBound, upperBound);
+    for (std::size_t bin = 0; bin < numberOfBins; ++bin)
+      histogram->SetFrequency(bin, static_cast<HistogramType::AbsoluteFrequencyType>(m_Histogram[bin]));
+
+    CalculatorType::Pointer calculator = CalculatorType::New();
+    calculator->SetInputHistogram(histogram);
+    calculator->SetNumberOfThresholds(m_NumberOfThresholds);
+    calculator->SetValleyEmphasis(true);
+    try
+    {
+      calculator->Compute();
+    }
+    catch (const itk::ExceptionObject &e)
+    {
+      mitkThrow() << "itkOtsuFilter error: " << e.GetDescription();
+    }
+
+    // the calculator returns the upper bounds of the bins
+    const double binWidth = (upperBound[0] - lowerBound[0]) / numberOfBins;
+    std::vector<unsigned int> thresholdBins;
+    for (double threshold : calculator->GetOutput())
+    {
+      const double bin = std::round((threshold - lowerBound[0]) / binWidth) - 1.0;
+      thresholdBins.push_back(static_cast<unsigned int>(std::min(std::max(bin, 0.0), numberOfBins - 1.0)));
+    }
+    return thresholdBins;
+  }
+
+  std::vector<unsigned int> OtsuSegmentationFilter::ComputeThresholdBins(const std::vector<double> &histogram,
+                                                                         unsigned int numberOfThresholds)
+  {
+    const std::size_t numberOfBins = histogram.size();
+    if (numberOfBins <= numberOfThresholds)
+      mitkThrow() << "The Otsu segmentation needs more histogram bins than thresholds.";
+
+    // prefix sums of weight and first moment, the bin indices serve as values as the criterion does not change
+    // under a linear mapping of the values
+    std::vector<double> weights(numberOfBins + 1, 0.0);
+    std::vector<double> moments(numberOfBins + 1, 0.0);
+    for (std::size_t bin = 0; bin < numberOfBins; ++bin)
+    {
+      weights[bin + 1] = weights[bin] + histogram[bin];
+      moments[bin + 1] = moments[bin] + histogram[bin] * bin;
+    }
+
+    // maximizing the between-class variance means maximizing the sum of moment^2 / weight over the regions
+    auto regionValue = [&](std::size_t begin, std::size_t end) {
+      const double weight = weights[end] - weights[begin];
+      if (weight <= 0.0)
+        return 0.0;
+      const double moment = moments[end] - moments[begin];
+      return moment * moment / weight;
+    };
+
+    // best[k][end] is the optimum for k+1 regions covering the bins [0, end), split[k][end] the begin of the last one
+    const double undefined = std::numeric_limits<double>::lowest();
+    std::vector<std::vector<double>> best(numberOfThresholds + 1, std::vector<double>(numberOfBins + 1, undefined));
+    std::vector<std::vector<std::size_t>> split(numberOfThresholds + 1, std::vector<std::size_t>(numberOfBins + 1, 0));
+
+    for (std::size_t end = 1; end <= numberOfBins; ++end)
+      best[0][end] = regionValue(0, end);
+
+    for (unsigned int k = 1; k <= numberOfThresholds; ++k)
+    {
+      // every region needs at least one bin and all regions after this one as well
+      const std::size_t firstEnd = k == numberOfThresholds ? numberOfBins : k + 1;
+      const std::size_t lastEnd = numberOfBins - (numberOfThresholds - k);
+      for (std::size_t end = firstEnd; end <= lastEnd; ++end)
+      {
+        for (std::size_t begin = k; begin < end; ++begin)
+        {
+          const double value = best[k - 1][begin] + regionValue(begin, end);
+          if (value > best[k][end])
+          {
+            best[k][end] = value;
+            split[k][end] = begin;
+          }
+        }
+      }
+    }
+
+    std::vector<unsigned int> thresholdBins(numberOfThresholds);
+    std::size_t end = numberOfBins;
+    for (unsigned int k = numberOfThresholds; k > 0; --k)
+    {
+      end = split[k][end];
+      thresholdBins[k - 1] = static_cast<unsigned int>(end - 1);
+    }
+    return thresholdBins;
   }
 }
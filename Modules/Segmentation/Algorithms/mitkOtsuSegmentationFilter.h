@@ -26,6 +26,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <MitkSegmentationExports.h>
 
+#include <vector>
+
 namespace mitk
 {
   /**
@@ -33,7 +35,12 @@ namespace mitk
 
     This class being an mitk::ImageToImageFilter performs a multiple threshold otsu image segmentation based on the
     image histogram.
-    Internally, the itk::OtsuMultipleThresholdsImageFilter is used.
+
+    The histogram is computed in parallel and kept as long as the input, the mask and the number of bins stay the
+    same, so updates with a different number of thresholds only solve the Otsu problem on the histogram and label the
+    image. The thresholds maximizing the between-class variance are found by dynamic programming in
+    O(NumberOfThresholds * NumberOfBins^2). With valley emphasis the criterion does not decompose over the classes,
+    then the exhaustive search of itk::OtsuMultipleThresholdsCalculator is run on the histogram.
 
     $Author: somebody$
   */
@@ -56,10 +63,22 @@ namespace mitk
         MITK_WARN << "Tried to set an invalid number of thresholds in the OtsuSegmentationFilter.";
         return;
       }
-      m_NumberOfThresholds = number;
+      if (m_NumberOfThresholds != number)
+      {
+        m_NumberOfThresholds = number;
+        this->Modified();
+      }
+    }
+
+    void SetValleyEmphasis(bool useValley)
+    {
+      if (m_ValleyEmphasis != useValley)
+      {
+        m_ValleyEmphasis = useValley;
+        this->Modified();
+      }
     }
 
-    void SetValleyEmphasis(bool useValley) { m_ValleyEmphasis = useValley; }
     void SetNumberOfBins(unsigned int number)
     {
       if (number < 1)
@@ -67,19 +86,76 @@ namespace mitk
         MITK_WARN << "Tried to set an invalid number of bins in the OtsuSegmentationFilter.";
         return;
       }
-      m_NumberOfBins = number;
+      if (m_NumberOfBins != number)
+      {
+        m_NumberOfBins = number;
+        this->Modified();
+      }
     }
 
+    /**
+      \brief Restrict the histogram to the pixels where mask is not 0 (optional).
+
+      The mask must have the size of the input. The thresholds are applied to the whole image nevertheless.
+    */
+    void SetMaskImage(const Image *mask);
+    const Image *GetMaskImage() const { return m_MaskImage; }
+
+    /** \brief Threads for the histogram and the labels. 0 (default) uses one thread per hardware thread. */
+    itkSetMacro(NumberOfThreads, unsigned int);
+    itkGetConstMacro(NumberOfThreads, unsigned int);
+
+    /**
+      \brief Thresholds of the last update in ascending order.
+
+      A pixel belongs to region i if its value is above threshold i-1 and not above threshold i.
+    */
+    const std::vector<double> &GetThresholds() const { return m_Thresholds; }
+
+    /**
+      \brief Solves the multiple threshold Otsu problem on a histogram.
+
+      \return For each threshold the index of the last bin of the region below it, in ascending order.
+      Throws if there are less bins than regions.
+    */
+    static std::vector<unsigned int> ComputeThresholdBins(const std::vector<double> &histogram,
+                                                          unsigned int numberOfThresholds);
+
   protected:
     OtsuSegmentationFilter();
     ~OtsuSegmentationFilter() override;
     void GenerateData() override;
     // virtual void GenerateOutputInformation();
 
+    template <typename TPixel, unsigned int VImageDimension>
+    void ComputeHistogram(const itk::Image<TPixel, VImageDimension> *itkImage);
+
+    template <typename TPixel, unsigned int VImageDimension>
+    void ComputeLabels(const itk::Image<TPixel, VImageDimension> *itkImage);
+
+    bool IsHistogramUpToDate() const;
+    std::vector<unsigned int> ComputeValleyEmphasisThresholdBins() const;
+    unsigned int GetNumberOfThreadsToUse() const;
+
   private:
     unsigned int m_NumberOfThresholds;
     bool m_ValleyEmphasis;
     unsigned int m_NumberOfBins;
+    unsigned int m_NumberOfThreads;
+
+    Image::ConstPointer m_MaskImage;
+
+    // histogram of the last update and what it was computed from
+    std::vector<double> m_Histogram;
+    double m_HistogramMinimum;
+    double m_HistogramMaximum;
+    const Image *m_HistogramInput;
+    const Image *m_HistogramMask;
+    unsigned int m_HistogramNumberOfBins;
+    itk::TimeStamp m_HistogramTime;
+
+    std::vector<unsigned int> m_ThresholdBins;
+    std::vector<double> m_Thresholds;
 
   }; // class
 
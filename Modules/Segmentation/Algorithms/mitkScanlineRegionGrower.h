@@ -0,0 +1,154 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkScanlineRegionGrower_h
+#define mitkScanlineRegionGrower_h
+
+#include <itkImage.h>
+
+#include <vector>
+
+namespace mitk
+{
+  /**
+    \brief Connected threshold region growing by scanline flood fill.
+
+    Grows the face connected region of all pixels with lower <= value <= upper around a seed, i.e. the same
+    region as itk::ConnectedThresholdImageFilter. Instead of visiting every pixel with a neighborhood iterator,
+    whole runs along the x axis are filled at once and only one seed per run of the neighbouring lines is pushed
+    onto a span stack.
+
+    The result is kept as a list of spans together with its bounding region. Callers can write it directly into
+    an existing slice or volume (FillOutput()) or create a mask that only covers the touched region
+    (CreateMask()), so no full size output has to be allocated for small regions.
+
+    3D images are processed in parallel: the volume is split into slabs along z that are filled independently.
+    Seeds crossing a slab border are handed over to the neighbouring slab in the next round, and the spans of
+    all slabs are merged once no slab has pending seeds anymore.
+
+    \ingroup Segmentation
+  */
+  template <typename TInputImage,
+            typename TOutputImage = itk::Image<unsigned char, TInputImage::ImageDimension>>
+  class ScanlineRegionGrower
+  {
+  public:
+    typedef TInputImage InputImageType;
+    typedef TOutputImage OutputImageType;
+    typedef typename InputImageType::PixelType PixelType;
+    typedef typename OutputImageType::PixelType OutputPixelType;
+    typedef typename InputImageType::IndexType IndexType;
+    typedef typename InputImageType::RegionType RegionType;
+
+    static const unsigned int ImageDimension = InputImageType::ImageDimension;
+
+    /** \brief A run of Length pixels along the x axis, starting at Start. */
+    struct Span
+    {
+      IndexType Start;
+      itk::SizeValueType Length;
+    };
+
+    ScanlineRegionGrower();
+
+    void SetInput(const InputImageType *image);
+
+    void SetLower(PixelType lower) { m_Lower = lower; }
+    PixelType GetLower() const { return m_Lower; }
+    void SetUpper(PixelType upper) { m_Upper = upper; }
+    PixelType GetUpper() const { return m_Upper; }
+
+    /** \brief Maximum number of z slabs filled in parallel for 3D images.
+        0 (default) uses one slab per hardware thread, 1 grows the region sequentially. */
+    void SetNumberOfThreads(unsigned int numberOfThreads) { m_NumberOfThreads = numberOfThreads; }
+    unsigned int GetNumberOfThreads() const { return m_NumberOfThreads; }
+
+    /** \brief Grows the region around seed.
+        \return false if the seed lies outside of the input or its value is outside of the thresholds. */
+    bool Grow(const IndexType &seed);
+
+    const std::vector<Span> &GetSpans() const { return m_Spans; }
+
+    /** \brief Smallest region containing all grown pixels, empty if nothing was grown. */
+    const RegionType &GetBoundingRegion() const { return m_BoundingRegion; }
+
+    itk::SizeValueType GetNumberOfPixels() const { return m_NumberOfPixels; }
+
+    /** \brief Sets all grown pixels of output to value, all other pixels are left untouched.
+        The buffered region of output has to contain the bounding region. */
+    void FillOutput(OutputImageType *output, OutputPixelType value) const;
+
+    /** \brief The bounding region enlarged by padding and cropped to the input. */
+    RegionType GetMaskRegion(unsigned int padding) const;
+
+    /** \brief Creates a mask of GetMaskRegion(padding) with the grown pixels set to foreground and
+        all other pixels set to 0. The region of the mask starts at index 0, its origin is the physical
+        position of the first index of the mask region within the input. */
+    typename OutputImageType::Pointer CreateMask(unsigned int padding = 0, OutputPixelType foreground = 1) const;
+
+  private:
+    /** All coordinates below are relative to the buffered region of the input. */
+    struct Seed
+    {
+      itk::OffsetValueType X;
+      itk::OffsetValueType Y;
+      itk::OffsetValueType Z;
+    };
+
+    struct Slab
+    {
+      itk::OffsetValueType ZBegin;
+      itk::OffsetValueType ZEnd;
+      std::vector<bool> Visited;
+      std::vector<Seed> Pending;
+      std::vector<Seed> ToLowerSlab;
+      std::vector<Seed> ToUpperSlab;
+      std::vector<Span> Spans;
+      itk::OffsetValueType Min[3];
+      itk::OffsetValueType Max[3];
+      itk::SizeValueType NumberOfPixels;
+    };
+
+    bool IsInside(PixelType value) const { return m_Lower <= value && value <= m_Upper; }
+
+    void FillSlab(Slab &slab) const;
+
+    /** Pushes one seed for every run of pixels within the thresholds on line (y, z) between x0 and x1.
+        If slab is given, already visited pixels of that slab end a run as well. */
+    void PushRunSeeds(itk::OffsetValueType x0,
+                      itk::OffsetValueType x1,
+                      itk::OffsetValueType y,
+                      itk::OffsetValueType z,
+                      const Slab *slab,
+                      std::vector<Seed> &seeds) const;
+
+    const InputImageType *m_Input;
+    PixelType m_Lower;
+    PixelType m_Upper;
+    unsigned int m_NumberOfThreads;
+
+    RegionType m_InputRegion;
+    itk::OffsetValueType m_Size[3];
+
+    std::vector<Span> m_Spans;
+    RegionType m_BoundingRegion;
+    itk::SizeValueType m_NumberOfPixels;
+  };
+}
+
+#include "mitkScanlineRegionGrower.txx"
+
+#endif
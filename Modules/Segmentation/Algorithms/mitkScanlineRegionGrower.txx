@@ -0,0 +1,350 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkScanlineRegionGrower_txx
+#define mitkScanlineRegionGrower_txx
+
+#include "mitkScanlineRegionGrower.h"
+
+#include <mitkExceptionMacro.h>
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+template <typename TInputImage, typename TOutputImage>
+mitk::ScanlineRegionGrower<TInputImage, TOutputImage>::ScanlineRegionGrower()
+  : m_Input(nullptr), m_Lower(0), m_Upper(0), m_NumberOfThreads(0), m_NumberOfPixels(0)
+{
+  static_assert(ImageDimension == 2 || ImageDimension == 3, "ScanlineRegionGrower supports 2D and 3D images only");
+
+  m_Size[0] = m_Size[1] = m_Size[2] = 0;
+}
+
+template <typename TInputImage, typename TOutputImage>
+void mitk::ScanlineRegionGrower<TInputImage, TOutputImage>::SetInput(const InputImageType *image)
+{
+  m_Input = image;
+  m_Spans.clear();
+  m_BoundingRegion = RegionType();
+  m_NumberOfPixels = 0;
+
+  if (image == nullptr)
+  {
+    m_Size[0] = m_Size[1] = m_Size[2] = 0;
+    return;
+  }
+
+  m_InputRegion = image->GetBufferedRegion();
+  for (unsigned int d = 0; d < 3; ++d)
+  {
+    m_Size[d] = d < ImageDimension ? static_cast<itk::OffsetValueType>(m_InputRegion.GetSize(d)) : 1;
+  }
+}
+
+template <typename TInputImage, typename TOutputImage>
+bool mitk::ScanlineRegionGrower<TInputImage, TOutputImage>::Grow(const IndexType &seedIndex)
+{
+  m_Spans.clear();
+  m_BoundingRegion = RegionType();
+  m_NumberOfPixels = 0;
+
+  if (m_Input == nullptr || !m_InputRegion.IsInside(seedIndex))
+    return false;
+
+  Seed seed = {0, 0, 0};
+  itk::OffsetValueType *seedCoordinates[3] = {&seed.X, &seed.Y, &seed.Z};
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    *seedCoordinates[d] = seedIndex[d] - m_InputRegion.GetIndex(d);
+  }
+
+  const itk::OffsetValueType seedOffset = seed.X + m_Size[0] * (seed.Y + m_Size[1] * seed.Z);
+  if (!this->IsInside(m_Input->GetBufferPointer()[seedOffset]))
+    return false;
+
+  // Thin slabs would mostly hand seeds back and forth, so each slab covers at least a few slices
+  const itk::OffsetValueType minimumSlabThickness = 8;
+  unsigned int numberOfThreads = m_NumberOfThreads;
+  if (numberOfThreads == 0)
+    numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  const itk::OffsetValueType numberOfSlabs = std::max<itk::OffsetValueType>(
+    1, std::min<itk::OffsetValueType>(numberOfThreads, m_Size[2] / minimumSlabThickness));
+
+  std::vector<Slab> slabs(numberOfSlabs);
+  for (itk::OffsetValueType i = 0; i < numberOfSlabs; ++i)
+  {
+    Slab &slab = slabs[i];
+    slab.ZBegin = i * m_Size[2] / numberOfSlabs;
+    slab.ZEnd = (i + 1) * m_Size[2] / numberOfSlabs;
+    slab.NumberOfPixels = 0;
+    std::fill(slab.Min, slab.Min + 3, std::numeric_limits<itk::OffsetValueType>::max());
+    std::fill(slab.Max, slab.Max + 3, -1);
+
+    if (slab.ZBegin <= seed.Z && seed.Z < slab.ZEnd)
+      slab.Pending.push_back(seed);
+  }
+
+  while (true)
+  {
+    std::vector<Slab *> activeSlabs;
+    for (auto &slab : slabs)
+    {
+      if (!slab.Pending.empty())
+        activeSlabs.push_back(&slab);
+    }
+
+    if (activeSlabs.empty())
+      break;
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < activeSlabs.size(); ++i)
+    {
+      Slab *slab = activeSlabs[i];
+      threads.emplace_back([this, slab]() { this->FillSlab(*slab); });
+    }
+
+    this->FillSlab(*activeSlabs[0]);
+
+    for (auto &thread : threads)
+      thread.join();
+
+    // Hand over the seeds that crossed a slab border, they are filled by their owner in the next round
+    for (itk::OffsetValueType i = 0; i < numberOfSlabs; ++i)
+    {
+      if (i > 0)
+      {
+        slabs[i - 1].Pending.insert(
+          slabs[i - 1].Pending.end(), slabs[i].ToLowerSlab.begin(), slabs[i].ToLowerSlab.end());
+      }
+
+      if (i + 1 < numberOfSlabs)
+      {
+        slabs[i + 1].Pending.insert(
+          slabs[i + 1].Pending.end(), slabs[i].ToUpperSlab.begin(), slabs[i].ToUpperSlab.end());
+      }
+
+      slabs[i].ToLowerSlab.clear();
+      slabs[i].ToUpperSlab.clear();
+    }
+  }
+
+  // Merge the slabs
+  itk::OffsetValueType min[3];
+  itk::OffsetValueType max[3];
+  std::fill(min, min + 3, std::numeric_limits<itk::OffsetValueType>::max());
+  std::fill(max, max + 3, -1);
+
+  for (const auto &slab : slabs)
+  {
+    if (slab.NumberOfPixels == 0)
+      continue;
+
+    m_Spans.insert(m_Spans.end(), slab.Spans.begin(), slab.Spans.end());
+    m_NumberOfPixels += slab.NumberOfPixels;
+
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      min[d] = std::min(min[d], slab.Min[d]);
+      max[d] = std::max(max[d], slab.Max[d]);
+    }
+  }
+
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    m_BoundingRegion.SetIndex(d, m_InputRegion.GetIndex(d) + min[d]);
+    m_BoundingRegion.SetSize(d, max[d] - min[d] + 1);
+  }
+
+  return true;
+}
+
+template <typename TInputImage, typename TOutputImage>
+void mitk::ScanlineRegionGrower<TInputImage, TOutputImage>::FillSlab(Slab &slab) const
+{
+  const itk::OffsetValueType sliceStride = m_Size[0] * m_Size[1];
+
+  // Slabs that are never reached do not need a visited mask at all
+  if (slab.Visited.empty())
+    slab.Visited.assign(sliceStride * (slab.ZEnd - slab.ZBegin), false);
+
+  const PixelType *buffer = m_Input->GetBufferPointer();
+
+  std::vector<Seed> stack;
+  stack.swap(slab.Pending);
+
+  while (!stack.empty())
+  {
+    const Seed seed = stack.back();
+    stack.pop_back();
+
+    const itk::OffsetValueType lineOffset = m_Size[0] * seed.Y + sliceStride * seed.Z;
+    const itk::OffsetValueType visitedOffset = lineOffset - sliceStride * slab.ZBegin;
+    const PixelType *line = buffer + lineOffset;
+
+    if (slab.Visited[visitedOffset + seed.X] || !this->IsInside(line[seed.X]))
+      continue;
+
+    itk::OffsetValueType x0 = seed.X;
+    while (x0 > 0 && !slab.Visited[visitedOffset + x0 - 1] && this->IsInside(line[x0 - 1]))
+      --x0;
+
+    itk::OffsetValueType x1 = seed.X;
+    while (x1 + 1 < m_Size[0] && !slab.Visited[visitedOffset + x1 + 1] && this->IsInside(line[x1 + 1]))
+      ++x1;
+
+    std::fill(slab.Visited.begin() + visitedOffset + x0, slab.Visited.begin() + visitedOffset + x1 + 1, true);
+
+    const itk::OffsetValueType start[3] = {x0, seed.Y, seed.Z};
+    Span span;
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+    {
+      span.Start[d] = m_InputRegion.GetIndex(d) + start[d];
+    }
+    span.Length = x1 - x0 + 1;
+    slab.Spans.push_back(span);
+    slab.NumberOfPixels += span.Length;
+
+    const itk::OffsetValueType end[3] = {x1, seed.Y, seed.Z};
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      slab.Min[d] = std::min(slab.Min[d], start[d]);
+      slab.Max[d] = std::max(slab.Max[d], end[d]);
+    }
+
+    if (seed.Y > 0)
+      this->PushRunSeeds(x0, x1, seed.Y - 1, seed.Z, &slab, stack);
+
+    if (seed.Y + 1 < m_Size[1])
+      this->PushRunSeeds(x0, x1, seed.Y + 1, seed.Z, &slab, stack);
+
+    // The visited mask of a neighbouring slab must not be read here, its owner discards already visited seeds
+    if (seed.Z > slab.ZBegin)
+      this->PushRunSeeds(x0, x1, seed.Y, seed.Z - 1, &slab, stack);
+    else if (seed.Z > 0)
+      this->PushRunSeeds(x0, x1, seed.Y, seed.Z - 1, nullptr, slab.ToLowerSlab);
+
+    if (seed.Z + 1 < slab.ZEnd)
+      this->PushRunSeeds(x0, x1, seed.Y, seed.Z + 1, &slab, stack);
+    else if (seed.Z + 1 < m_Size[2])
+      this->PushRunSeeds(x0, x1, seed.Y, seed.Z + 1, nullptr, slab.ToUpperSlab);
+  }
+}
+
+template <typename TInputImage, typename TOutputImage>
+void mitk::ScanlineRegionGrower<TInputImage, TOutputImage>::PushRunSeeds(itk::OffsetValueType x0,
+                                                                          itk::OffsetValueType x1,
+                                                                          itk::OffsetValueType y,
+                                                                          itk::OffsetValueType z,
+                                                                          const Slab *slab,
+                                                                          std::vector<Seed> &seeds) const
+{
+  const itk::OffsetValueType sliceStride = m_Size[0] * m_Size[1];
+  const itk::OffsetValueType lineOffset = m_Size[0] * y + sliceStride * z;
+  const PixelType *line = m_Input->GetBufferPointer() + lineOffset;
+  const itk::OffsetValueType visitedOffset = slab != nullptr ? lineOffset - sliceStride * slab->ZBegin : 0;
+
+  bool inRun = false;
+  for (itk::OffsetValueType x = x0; x <= x1; ++x)
+  {
+    const bool grow = this->IsInside(line[x]) && (slab == nullptr || !slab->Visited[visitedOffset + x]);
+
+    if (grow && !inRun)
+    {
+      Seed seed = {x, y, z};
+      seeds.push_back(seed);
+    }
+
+    inRun = grow;
+  }
+}
+
+template <typename TInputImage, typename TOutputImage>
+void mitk::ScanlineRegionGrower<TInputImage, TOutputImage>::FillOutput(OutputImageType *output,
+                                                                       OutputPixelType value) const
+{
+  if (output == nullptr)
+    mitkThrow() << "ScanlineRegionGrower: no output image given.";
+
+  if (m_NumberOfPixels == 0)
+    return;
+
+  if (!output->GetBufferedRegion().IsInside(m_BoundingRegion))
+    mitkThrow() << "ScanlineRegionGrower: the output image does not contain the grown region.";
+
+  OutputPixelType *buffer = output->GetBufferPointer();
+  for (const auto &span : m_Spans)
+  {
+    std::fill_n(buffer + output->ComputeOffset(span.Start), span.Length, value);
+  }
+}
+
+template <typename TInputImage, typename TOutputImage>
+typename mitk::ScanlineRegionGrower<TInputImage, TOutputImage>::RegionType
+  mitk::ScanlineRegionGrower<TInputImage, TOutputImage>::GetMaskRegion(unsigned int padding) const
+{
+  RegionType region = m_BoundingRegion;
+
+  if (m_NumberOfPixels > 0)
+  {
+    region.PadByRadius(padding);
+    region.Crop(m_InputRegion);
+  }
+
+  return region;
+}
+
+template <typename TInputImage, typename TOutputImage>
+typename TOutputImage::Pointer mitk::ScanlineRegionGrower<TInputImage, TOutputImage>::CreateMask(
+  unsigned int padding, OutputPixelType foreground) const
+{
+  const RegionType maskRegion = this->GetMaskRegion(padding);
+
+  typename OutputImageType::RegionType region;
+  region.SetSize(maskRegion.GetSize());
+
+  typename OutputImageType::PointType origin;
+  if (m_Input != nullptr)
+    m_Input->TransformIndexToPhysicalPoint(maskRegion.GetIndex(), origin);
+
+  typename OutputImageType::Pointer mask = OutputImageType::New();
+  mask->SetRegions(region);
+  if (m_Input != nullptr)
+  {
+    mask->SetOrigin(origin);
+    mask->SetSpacing(m_Input->GetSpacing());
+    mask->SetDirection(m_Input->GetDirection());
+  }
+  mask->Allocate();
+  mask->FillBuffer(0);
+
+  OutputPixelType *buffer = mask->GetBufferPointer();
+  for (const auto &span : m_Spans)
+  {
+    typename OutputImageType::IndexType index;
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+    {
+      index[d] = span.Start[d] - maskRegion.GetIndex(d);
+    }
+
+    std::fill_n(buffer + mask->ComputeOffset(index), span.Length, foreground);
+  }
+
+  return mask;
+}
+
+#endif
@@ -48,6 +48,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #undef VTK_USE_UINT64
 #define VTK_USE_UINT64 0
 
+#include <algorithm>
 #include <cfloat>
 #include <climits>
 #include <cmath>
@@ -110,6 +111,9 @@ inline int vtkResliceRound(double x)
 mitkVtkImageOverwrite::mitkVtkImageOverwrite()
 {
   m_Overwrite_Mode = false;
+  m_UseOverwriteRegion = false;
+  m_OverwriteRegion[0] = m_OverwriteRegion[2] = 0;
+  m_OverwriteRegion[1] = m_OverwriteRegion[3] = -1;
   this->GetOutput()->AllocateScalars(VTK_UNSIGNED_INT, 1); // VTK6_TODO where should the image be allocated?
 }
 
@@ -843,6 +847,25 @@ void mitkVtkImageOverwrite::SetInputSlice(vtkImageData *slice)
   this->SetOutput(slice);
 }
 
+void mitkVtkImageOverwrite::SetOverwriteRegion(int xMin, int xMax, int yMin, int yMax)
+{
+  m_UseOverwriteRegion = true;
+  m_OverwriteRegion[0] = xMin;
+  m_OverwriteRegion[1] = xMax;
+  m_OverwriteRegion[2] = yMin;
+  m_OverwriteRegion[3] = yMax;
+  this->Modified();
+}
+
+void mitkVtkImageOverwrite::ResetOverwriteRegion()
+{
+  if (!m_UseOverwriteRegion)
+    return;
+
+  m_UseOverwriteRegion = false;
+  this->Modified();
+}
+
 //----------------------------------------------------------------------------
 // This method is passed a input and output region, and executes the filter
 // algorithm to fill the output from the input or vice versa.
@@ -871,17 +894,31 @@ void mitkVtkImageOverwrite::ThreadedRequestData(vtkInformation *vtkNotUsed(reque
     return;
   }
 
+  // only process the part of this thread's extent that lies within the requested rectangle
+  int regionExt[6] = {outExt[0], outExt[1], outExt[2], outExt[3], outExt[4], outExt[5]};
+  if (m_UseOverwriteRegion)
+  {
+    regionExt[0] = std::max(regionExt[0], this->OutputExtent[0] + m_OverwriteRegion[0]);
+    regionExt[1] = std::min(regionExt[1], this->OutputExtent[0] + m_OverwriteRegion[1]);
+    regionExt[2] = std::max(regionExt[2], this->OutputExtent[2] + m_OverwriteRegion[2]);
+    regionExt[3] = std::min(regionExt[3], this->OutputExtent[2] + m_OverwriteRegion[3]);
+    if (regionExt[1] < regionExt[0] || regionExt[3] < regionExt[2])
+    {
+      return;
+    }
+  }
+
   // Get the output pointer
-  void *outPtr = outData[0]->GetScalarPointerForExtent(outExt);
+  void *outPtr = outData[0]->GetScalarPointerForExtent(regionExt);
 
   if (this->HitInputExtent == 0)
   {
-    vtkImageResliceClearExecute(this, inData[0][0], nullptr, outData[0], outPtr, outExt, id);
+    vtkImageResliceClearExecute(this, inData[0][0], nullptr, outData[0], outPtr, regionExt, id);
     return;
   }
 
   // Now that we know that we need the input, get the input pointer
   void *inPtr = inData[0][0]->GetScalarPointerForExtent(inExt);
 
-  vtkImageResliceExecute(this, inData[0][0], inPtr, outData[0], outPtr, outExt, id);
+  vtkImageResliceExecute(this, inData[0][0], inPtr, outData[0], outPtr, regionExt, id);
 }
@@ -69,12 +69,25 @@ public:
     */
   void SetInputSlice(vtkImageData *slice);
 
+  /** \brief Restricts both modes to a rectangle of the slice, given in pixel indices relative to the first pixel
+    of the output extent (i.e. the index coordinates of the extracted slice). Bounds are inclusive.
+    Pixels outside of the rectangle are neither read nor written, so the slice keeps its previous values there
+    in reslice mode, and the volume is not touched there in overwrite mode.
+    */
+  void SetOverwriteRegion(int xMin, int xMax, int yMin, int yMax);
+  /** \brief Removes the restriction set by SetOverwriteRegion, the whole slice is processed again.*/
+  void ResetOverwriteRegion();
+  bool HasOverwriteRegion() const { return m_UseOverwriteRegion; }
+
 protected:
   mitkVtkImageOverwrite();
   ~mitkVtkImageOverwrite() override;
 
   bool m_Overwrite_Mode;
 
+  bool m_UseOverwriteRegion;
+  int m_OverwriteRegion[4];
+
   /** Overridden from vtkImageReslice. \sa vtkImageReslice::ThreadedRequestData */
   void ThreadedRequestData(vtkInformation *vtkNotUsed(request),
                                    vtkInformationVector **vtkNotUsed(inputVector),
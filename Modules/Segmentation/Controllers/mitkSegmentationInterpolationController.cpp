@@ -29,6 +29,41 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkImage.h>
 #include <itkImageSliceConstIteratorWithIndex.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+  // interpolated slices kept in the cache, the ones farthest from the current slice are dropped first
+  const std::size_t MaximumCacheSize = 16;
+
+  // tolerance in mm when comparing the plane of a cached interpolation to a requested plane
+  const double PlaneTolerance = 1e-5;
+
+  // Same orientation and extent, origins may only differ along the normal, i.e. within the same slice
+  bool IsSameSlicePlane(const mitk::PlaneGeometry *plane1, const mitk::PlaneGeometry *plane2)
+  {
+    if (!mitk::MatrixEqualElementWise(plane1->GetIndexToWorldTransform()->GetMatrix(),
+                                      plane2->GetIndexToWorldTransform()->GetMatrix(),
+                                      PlaneTolerance))
+      return false;
+
+    mitk::Vector3D offset = plane2->GetOrigin() - plane1->GetOrigin();
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+      if (std::abs(plane1->GetExtent(i) - plane2->GetExtent(i)) > PlaneTolerance)
+        return false;
+
+      mitk::Vector3D axis = plane1->GetAxisVector(i);
+      axis.Normalize();
+      if (std::abs(offset * axis) > PlaneTolerance)
+        return false;
+    }
+    return true;
+  }
+}
+
 mitk::SegmentationInterpolationController::InterpolatorMapType
   mitk::SegmentationInterpolationController::s_InterpolatorForImage; // static member initialization
 
@@ -46,7 +81,14 @@ mitk::SegmentationInterpolationController *mitk::SegmentationInterpolationContro
   }
 }
 
-mitk::SegmentationInterpolationController::SegmentationInterpolationController() : m_BlockModified(false)
+mitk::SegmentationInterpolationController::SegmentationInterpolationController()
+  : m_BlockModified(false),
+    m_2DInterpolationActivated(false),
+    m_ChangedRegionTimeStep(0),
+    m_ChangedRegionPending(false),
+    m_Generation(0),
+    m_PrecomputationRange(2),
+    m_StopPrecomputation(false)
 {
 }
 
@@ -68,6 +110,8 @@ mitk::SegmentationInterpolationController *mitk::SegmentationInterpolationContro
 
 mitk::SegmentationInterpolationController::~SegmentationInterpolationController()
 {
+  this->StopPrecomputation();
+
   // remove this from the list of interpolators
   for (auto iter = s_InterpolatorForImage.begin(); iter != s_InterpolatorForImage.end(); ++iter)
   {
@@ -96,6 +140,7 @@ void mitk::SegmentationInterpolationController::SetSegmentationVolume(const Imag
 {
   // clear old information (remove all time steps
   m_SegmentationCountInSlice.clear();
+  this->ClearCache();
 
   // delete this from the list of interpolators
   auto iter = s_InterpolatorForImage.find(segmentation);
@@ -134,6 +179,9 @@ void mitk::SegmentationInterpolationController::SetSegmentationVolume(const Imag
     }
   }
 
+  // previous interpolations are not valid for the new counts
+  this->ClearCache();
+
   s_InterpolatorForImage.insert(std::make_pair(m_Segmentation, this));
 
   // for all timesteps
@@ -159,6 +207,9 @@ void mitk::SegmentationInterpolationController::SetReferenceVolume(const Image *
 {
   m_ReferenceImage = referenceImage;
 
+  // the cached interpolations may depend on the previous reference image
+  this->ClearCache();
+
   if (m_ReferenceImage.IsNull())
     return;                           // no image set - ignore it then
   assert(m_Segmentation.IsNotNull()); // should never happen
@@ -193,6 +244,14 @@ void mitk::SegmentationInterpolationController::SetChangedVolume(const Image *sl
 
   AccessFixedDimensionByItk_1(sliceDiff, ScanChangedVolume, 3, timeStep);
 
+  if (timeStep < m_SegmentationCountInSlice.size())
+  {
+    itk::ImageRegion<3> region;
+    for (unsigned int dim = 0; dim < 3; ++dim)
+      region.SetSize(dim, m_SegmentationCountInSlice[timeStep][dim].size());
+    this->TouchRegion(region, timeStep);
+  }
+
   // PrintStatus();
   Modified();
 }
@@ -240,9 +299,95 @@ void mitk::SegmentationInterpolationController::SetChangedSlice(const Image *sli
   AccessFixedDimensionByItk_1(
     sliceDiff, ScanChangedSlice, 2, SetChangedSliceOptions(sliceDimension, sliceIndex, dim0, dim1, timeStep, rawSlice));
 
+  itk::ImageRegion<3> region;
+  region.SetSize(dim0, m_SegmentationCountInSlice[timeStep][dim0].size());
+  region.SetSize(dim1, m_SegmentationCountInSlice[timeStep][dim1].size());
+  region.SetIndex(sliceDimension, sliceIndex);
+  region.SetSize(sliceDimension, 1);
+  this->TouchRegion(region, timeStep);
+
   Modified();
 }
 
+bool mitk::SegmentationInterpolationController::BeginChangedRegion(const itk::ImageRegion<3> &region,
+                                                                   unsigned int timeStep)
+{
+  m_ChangedRegionPending = false;
+
+  // without 2D interpolation the counts are not maintained (see OnImageModified())
+  if (m_Segmentation.IsNull() || !m_2DInterpolationActivated)
+    return false;
+  if (timeStep >= m_SegmentationCountInSlice.size())
+    return false;
+
+  itk::ImageRegion<3> largestRegion;
+  for (unsigned int dim = 0; dim < 3; ++dim)
+    largestRegion.SetSize(dim, m_SegmentationCountInSlice[timeStep][dim].size());
+
+  m_ChangedRegion = region;
+  if (!m_ChangedRegion.Crop(largestRegion))
+    return false;
+
+  // the old content of the region is removed from the counts, EndChangedRegion() adds the new content
+  m_ChangedRegionTimeStep = timeStep;
+  this->UpdateCountsInRegion(m_ChangedRegion, m_ChangedRegionTimeStep, false);
+  m_ChangedRegionPending = true;
+  return true;
+}
+
+void mitk::SegmentationInterpolationController::EndChangedRegion()
+{
+  if (!m_ChangedRegionPending)
+    return;
+  m_ChangedRegionPending = false;
+
+  // the segmentation could have been replaced in between, then the counts have been rebuilt anyway
+  if (m_Segmentation.IsNull() || m_ChangedRegionTimeStep >= m_SegmentationCountInSlice.size())
+    return;
+
+  this->UpdateCountsInRegion(m_ChangedRegion, m_ChangedRegionTimeStep, true);
+  this->TouchRegion(m_ChangedRegion, m_ChangedRegionTimeStep);
+
+  Modified();
+}
+
+void mitk::SegmentationInterpolationController::UpdateCountsInRegion(const itk::ImageRegion<3> &region,
+                                                                     unsigned int timeStep,
+                                                                     bool add)
+{
+  try
+  {
+    ImageTimeSelector::Pointer timeSelector = ImageTimeSelector::New();
+    timeSelector->SetInput(m_Segmentation);
+    timeSelector->SetTimeNr(timeStep);
+    timeSelector->UpdateLargestPossibleRegion();
+    Image::Pointer segmentation3D = timeSelector->GetOutput();
+    AccessFixedDimensionByItk_n(segmentation3D, ScanChangedRegion, 3, (m_Segmentation, timeStep, region, add));
+  }
+  catch (const mitk::AccessByItkException &e)
+  {
+    MITK_ERROR << "Could not update the interpolation of the changed region: " << e.what();
+  }
+}
+
+void mitk::SegmentationInterpolationController::TouchRegion(const itk::ImageRegion<3> &region, unsigned int timeStep)
+{
+  std::lock_guard<std::mutex> lock(m_CacheMutex);
+
+  if (timeStep >= m_SliceGenerations.size())
+    return;
+
+  ++m_Generation;
+  for (unsigned int dim = 0; dim < 3; ++dim)
+  {
+    std::vector<unsigned long> &generations = m_SliceGenerations[timeStep][dim];
+    const auto begin = static_cast<std::size_t>(std::max<itk::IndexValueType>(region.GetIndex(dim), 0));
+    const auto end = std::min<std::size_t>(begin + region.GetSize(dim), generations.size());
+    for (std::size_t index = begin; index < end; ++index)
+      generations[index] = m_Generation;
+  }
+}
+
 template <typename DATATYPE>
 void mitk::SegmentationInterpolationController::ScanChangedSlice(const itk::Image<DATATYPE, 2> *,
                                                                  const SetChangedSliceOptions &options)
@@ -373,6 +518,57 @@ void mitk::SegmentationInterpolationController::ScanWholeVolume(const itk::Image
   }
 }
 
+template <typename DATATYPE>
+void mitk::SegmentationInterpolationController::ScanChangedRegion(const itk::Image<DATATYPE, 3> *,
+                                                                  const Image *volume,
+                                                                  unsigned int timeStep,
+                                                                  const itk::ImageRegion<3> &region,
+                                                                  bool add)
+{
+  if (!volume)
+    return;
+  if (timeStep >= m_SegmentationCountInSlice.size())
+    return;
+
+  ImageReadAccessor readAccess(volume, volume->GetVolumeData(timeStep));
+  const auto *rawVolume = static_cast<const DATATYPE *>(readAccess.GetData());
+
+  const std::size_t dim0 = volume->GetDimension(0);
+  const std::size_t dim1 = volume->GetDimension(1);
+  const itk::ImageRegion<3>::IndexType lower = region.GetIndex();
+  const itk::ImageRegion<3>::IndexType upper = region.GetUpperIndex();
+
+  DirtyVectorType &countsX = m_SegmentationCountInSlice[timeStep][0];
+  DirtyVectorType &countsY = m_SegmentationCountInSlice[timeStep][1];
+  DirtyVectorType &countsZ = m_SegmentationCountInSlice[timeStep][2];
+
+  for (auto z = lower[2]; z <= upper[2]; ++z)
+  {
+    int numberOfPixels(0); // sum of the pixels of this slice within the region
+    for (auto y = lower[1]; y <= upper[1]; ++y)
+    {
+      const DATATYPE *rawLine = rawVolume + (z * dim1 + y) * dim0;
+      int numberOfPixelsInLine(0);
+      for (auto x = lower[0]; x <= upper[0]; ++x)
+      {
+        const auto value = static_cast<int>(rawLine[x]);
+        if (value == 0)
+          continue;
+
+        const int change = add ? value : -value;
+        assert((signed)countsX[x] + change >= 0); // otherwise some counting is going wrong
+        countsX[x] = static_cast<unsigned int>(countsX[x] + change);
+        numberOfPixelsInLine += change;
+      }
+      assert((signed)countsY[y] + numberOfPixelsInLine >= 0);
+      countsY[y] = static_cast<unsigned int>(countsY[y] + numberOfPixelsInLine);
+      numberOfPixels += numberOfPixelsInLine;
+    }
+    assert((signed)countsZ[z] + numberOfPixels >= 0);
+    countsZ[z] = static_cast<unsigned int>(countsZ[z] + numberOfPixels);
+  }
+}
+
 void mitk::SegmentationInterpolationController::PrintStatus()
 {
   unsigned int timeStep(0); // if needed, put a loop over time steps around everyting, but beware, output will be long
@@ -437,34 +633,48 @@ mitk::Image::Pointer mitk::SegmentationInterpolationController::Interpolate(unsi
                                                                             const mitk::PlaneGeometry *currentPlane,
                                                                             unsigned int timeStep)
 {
-  if (m_Segmentation.IsNull())
+  InterpolationTask task;
+  if (!this->CreateInterpolationTask(timeStep, sliceDimension, sliceIndex, currentPlane, task))
     return nullptr;
 
-  if (!currentPlane)
+  Image::Pointer result;
   {
-    return nullptr;
+    std::lock_guard<std::mutex> lock(m_CacheMutex);
+    result = this->GetCachedInterpolation(task);
   }
 
-  if (timeStep >= m_SegmentationCountInSlice.size())
-    return nullptr;
-  if (sliceDimension > 2)
-    return nullptr;
-  unsigned int upperLimit = m_SegmentationCountInSlice[timeStep][sliceDimension].size();
-  if (sliceIndex >= upperLimit - 1)
-    return nullptr; // can't interpolate first and last slice
-  if (sliceIndex < 1)
+  if (result.IsNull())
+  {
+    result = ComputeInterpolation(task);
+    if (result.IsNotNull())
+    {
+      std::lock_guard<std::mutex> lock(m_CacheMutex);
+      this->StoreInterpolation(task, result);
+    }
+  }
+
+  // the user probably continues with one of the neighboring slices
+  this->SchedulePrecomputation(task);
+
+  if (result.IsNull())
     return nullptr;
 
-  if (m_SegmentationCountInSlice[timeStep][sliceDimension][sliceIndex] > 0)
-    return nullptr; // slice contains a segmentation, won't interpolate anything then
+  // callers may change the image, the cached one has to stay untouched
+  return result->Clone();
+}
 
-  unsigned int lowerBound(0);
-  unsigned int upperBound(0);
+bool mitk::SegmentationInterpolationController::FindBounds(unsigned int timeStep,
+                                                           unsigned int sliceDimension,
+                                                           unsigned int sliceIndex,
+                                                           unsigned int &lowerBound,
+                                                           unsigned int &upperBound) const
+{
+  const DirtyVectorType &counts = m_SegmentationCountInSlice[timeStep][sliceDimension];
   bool bounds(false);
 
   for (lowerBound = sliceIndex - 1; /*lowerBound >= 0*/; --lowerBound)
   {
-    if (m_SegmentationCountInSlice[timeStep][sliceDimension][lowerBound] > 0)
+    if (counts[lowerBound] > 0)
     {
       bounds = true;
       break;
@@ -475,25 +685,77 @@ mitk::Image::Pointer mitk::SegmentationInterpolationController::Interpolate(unsi
   }
 
   if (!bounds)
-    return nullptr;
+    return false;
 
   bounds = false;
-  for (upperBound = sliceIndex + 1; upperBound < upperLimit; ++upperBound)
+  for (upperBound = sliceIndex + 1; upperBound < counts.size(); ++upperBound)
   {
-    if (m_SegmentationCountInSlice[timeStep][sliceDimension][upperBound] > 0)
+    if (counts[upperBound] > 0)
     {
       bounds = true;
       break;
     }
   }
 
-  if (!bounds)
-    return nullptr;
+  return bounds;
+}
+
+bool mitk::SegmentationInterpolationController::CreateInterpolationTask(unsigned int timeStep,
+                                                                        unsigned int sliceDimension,
+                                                                        unsigned int sliceIndex,
+                                                                        const PlaneGeometry *plane,
+                                                                        InterpolationTask &task) const
+{
+  if (m_Segmentation.IsNull())
+    return false;
+
+  if (!plane)
+  {
+    return false;
+  }
+
+  if (timeStep >= m_SegmentationCountInSlice.size())
+    return false;
+  if (sliceDimension > 2)
+    return false;
+  unsigned int upperLimit = m_SegmentationCountInSlice[timeStep][sliceDimension].size();
+  if (sliceIndex >= upperLimit - 1)
+    return false; // can't interpolate first and last slice
+  if (sliceIndex < 1)
+    return false;
+
+  if (m_SegmentationCountInSlice[timeStep][sliceDimension][sliceIndex] > 0)
+    return false; // slice contains a segmentation, won't interpolate anything then
+
+  unsigned int lowerBound(0);
+  unsigned int upperBound(0);
+  if (!this->FindBounds(timeStep, sliceDimension, sliceIndex, lowerBound, upperBound))
+    return false;
 
   // ok, we have found two neighboring slices with segmentations (and we made sure that the current slice does NOT
   // contain anything
+  task.timeStep = timeStep;
+  task.sliceDimension = sliceDimension;
+  task.sliceIndex = sliceIndex;
+  task.lowerBound = lowerBound;
+  task.upperBound = upperBound;
+  // only this thread changes the generations, reading them needs no lock
+  task.lowerGeneration = m_SliceGenerations[timeStep][sliceDimension][lowerBound];
+  task.upperGeneration = m_SliceGenerations[timeStep][sliceDimension][upperBound];
+  task.plane = plane->Clone();
+  task.segmentation = m_Segmentation;
+  task.referenceImage = m_ReferenceImage;
+  return true;
+}
+
+mitk::Image::Pointer mitk::SegmentationInterpolationController::ComputeInterpolation(const InterpolationTask &task)
+{
+  const Image *segmentation = task.segmentation;
+  const unsigned int timeStep = task.timeStep;
+  const unsigned int sliceDimension = task.sliceDimension;
+
   // MITK_INFO << "Interpolate in timestep " << timeStep << ", dimension " << sliceDimension << ": estimate slice " <<
-  // sliceIndex << " from slices " << lowerBound << " and " << upperBound << std::endl;
+  // task.sliceIndex << " from slices " << task.lowerBound << " and " << task.upperBound << std::endl;
 
   mitk::Image::Pointer lowerMITKSlice;
   mitk::Image::Pointer upperMITKSlice;
@@ -503,33 +765,33 @@ mitk::Image::Pointer mitk::SegmentationInterpolationController::Interpolate(unsi
   {
     // Setting up the ExtractSliceFilter
     mitk::ExtractSliceFilter::Pointer extractor = ExtractSliceFilter::New();
-    extractor->SetInput(m_Segmentation);
+    extractor->SetInput(segmentation);
     extractor->SetTimeStep(timeStep);
-    extractor->SetResliceTransformByGeometry(m_Segmentation->GetTimeGeometry()->GetGeometryForTimeStep(timeStep));
+    extractor->SetResliceTransformByGeometry(segmentation->GetTimeGeometry()->GetGeometryForTimeStep(timeStep));
     extractor->SetVtkOutputRequest(false);
 
     // Reslicing the current plane
-    extractor->SetWorldGeometry(currentPlane);
+    extractor->SetWorldGeometry(task.plane);
     extractor->Modified();
     extractor->Update();
     resultImage = extractor->GetOutput();
     resultImage->DisconnectPipeline();
 
     // Creating PlaneGeometry for lower slice
-    mitk::PlaneGeometry::Pointer reslicePlane = currentPlane->Clone();
+    mitk::PlaneGeometry::Pointer reslicePlane = task.plane->Clone();
 
     // Transforming the current origin so that it matches the lower slice
-    mitk::Point3D origin = currentPlane->GetOrigin();
-    m_Segmentation->GetSlicedGeometry(timeStep)->WorldToIndex(origin, origin);
-    origin[sliceDimension] = lowerBound;
-    m_Segmentation->GetSlicedGeometry(timeStep)->IndexToWorld(origin, origin);
+    mitk::Point3D origin = task.plane->GetOrigin();
+    segmentation->GetSlicedGeometry(timeStep)->WorldToIndex(origin, origin);
+    origin[sliceDimension] = task.lowerBound;
+    segmentation->GetSlicedGeometry(timeStep)->IndexToWorld(origin, origin);
     reslicePlane->SetOrigin(origin);
 
     // Extract the lower slice
     extractor = ExtractSliceFilter::New();
-    extractor->SetInput(m_Segmentation);
+    extractor->SetInput(segmentation);
     extractor->SetTimeStep(timeStep);
-    extractor->SetResliceTransformByGeometry(m_Segmentation->GetTimeGeometry()->GetGeometryForTimeStep(timeStep));
+    extractor->SetResliceTransformByGeometry(segmentation->GetTimeGeometry()->GetGeometryForTimeStep(timeStep));
     extractor->SetVtkOutputRequest(false);
 
     extractor->SetWorldGeometry(reslicePlane);
@@ -539,16 +801,16 @@ mitk::Image::Pointer mitk::SegmentationInterpolationController::Interpolate(unsi
     lowerMITKSlice->DisconnectPipeline();
 
     // Transforming the current origin so that it matches the upper slice
-    m_Segmentation->GetSlicedGeometry(timeStep)->WorldToIndex(origin, origin);
-    origin[sliceDimension] = upperBound;
-    m_Segmentation->GetSlicedGeometry(timeStep)->IndexToWorld(origin, origin);
+    segmentation->GetSlicedGeometry(timeStep)->WorldToIndex(origin, origin);
+    origin[sliceDimension] = task.upperBound;
+    segmentation->GetSlicedGeometry(timeStep)->IndexToWorld(origin, origin);
     reslicePlane->SetOrigin(origin);
 
     // Extract the upper slice
     extractor = ExtractSliceFilter::New();
-    extractor->SetInput(m_Segmentation);
+    extractor->SetInput(segmentation);
     extractor->SetTimeStep(timeStep);
-    extractor->SetResliceTransformByGeometry(m_Segmentation->GetTimeGeometry()->GetGeometryForTimeStep(timeStep));
+    extractor->SetResliceTransformByGeometry(segmentation->GetTimeGeometry()->GetGeometryForTimeStep(timeStep));
     extractor->SetVtkOutputRequest(false);
 
     extractor->SetWorldGeometry(reslicePlane);
@@ -578,12 +840,177 @@ mitk::Image::Pointer mitk::SegmentationInterpolationController::Interpolate(unsi
   mitk::SegmentationInterpolationAlgorithm::Pointer algorithm =
     mitk::ShapeBasedInterpolationAlgorithm::New().GetPointer();
   return algorithm->Interpolate(lowerMITKSlice.GetPointer(),
-                                lowerBound,
+                                task.lowerBound,
                                 upperMITKSlice.GetPointer(),
-                                upperBound,
-                                sliceIndex,
+                                task.upperBound,
+                                task.sliceIndex,
                                 sliceDimension,
                                 resultImage,
                                 timeStep,
-                                m_ReferenceImage);
+                                task.referenceImage);
+}
+
+bool mitk::SegmentationInterpolationController::IsTaskUpToDate(const InterpolationTask &task) const
+{
+  if (task.timeStep >= m_SliceGenerations.size())
+    return false;
+
+  const std::vector<unsigned long> &generations = m_SliceGenerations[task.timeStep][task.sliceDimension];
+  return task.upperBound < generations.size() && generations[task.lowerBound] == task.lowerGeneration &&
+         generations[task.upperBound] == task.upperGeneration;
+}
+
+mitk::Image::Pointer mitk::SegmentationInterpolationController::GetCachedInterpolation(
+  const InterpolationTask &task) const
+{
+  auto iter = m_Cache.find(std::make_tuple(task.timeStep, task.sliceDimension, task.sliceIndex));
+  if (iter == m_Cache.end())
+    return nullptr;
+
+  // valid as long as it was interpolated from the same, unchanged slices
+  const InterpolationTask &cached = iter->second.task;
+  if (cached.segmentation != task.segmentation || cached.referenceImage != task.referenceImage ||
+      cached.lowerBound != task.lowerBound || cached.upperBound != task.upperBound ||
+      cached.lowerGeneration != task.lowerGeneration || cached.upperGeneration != task.upperGeneration)
+    return nullptr;
+
+  if (!IsSameSlicePlane(cached.plane, task.plane))
+    return nullptr;
+
+  return iter->second.result;
+}
+
+void mitk::SegmentationInterpolationController::StoreInterpolation(const InterpolationTask &task, Image *result)
+{
+  CacheKeyType key = std::make_tuple(task.timeStep, task.sliceDimension, task.sliceIndex);
+  CachedInterpolation &cached = m_Cache[key];
+  cached.task = task;
+  cached.result = result;
+
+  while (m_Cache.size() > MaximumCacheSize)
+  {
+    // drop the interpolation farthest from the new one, other directions and time steps first
+    auto farthest = m_Cache.end();
+    unsigned int farthestDistance = 0;
+    for (auto iter = m_Cache.begin(); iter != m_Cache.end(); ++iter)
+    {
+      const InterpolationTask &other = iter->second.task;
+      unsigned int distance = std::numeric_limits<unsigned int>::max();
+      if (other.timeStep == task.timeStep && other.sliceDimension == task.sliceDimension)
+        distance = other.sliceIndex > task.sliceIndex ? other.sliceIndex - task.sliceIndex :
+                                                        task.sliceIndex - other.sliceIndex;
+
+      if (farthest == m_Cache.end() || distance > farthestDistance)
+      {
+        farthest = iter;
+        farthestDistance = distance;
+      }
+    }
+    m_Cache.erase(farthest);
+  }
+}
+
+void mitk::SegmentationInterpolationController::SchedulePrecomputation(const InterpolationTask &task)
+{
+  if (m_PrecomputationRange == 0)
+    return;
+
+  const BaseGeometry *geometry = task.segmentation->GetSlicedGeometry(task.timeStep);
+
+  std::deque<InterpolationTask> tasks;
+  for (unsigned int distance = 1; distance <= m_PrecomputationRange; ++distance)
+  {
+    for (int direction = -1; direction <= 1; direction += 2)
+    {
+      if (direction < 0 && distance > task.sliceIndex)
+        continue;
+      const unsigned int sliceIndex = direction < 0 ? task.sliceIndex - distance : task.sliceIndex + distance;
+
+      // the plane of the neighbor, shifted in index coordinates to keep the position within the slice
+      PlaneGeometry::Pointer plane = task.plane->Clone();
+      Point3D origin = plane->GetOrigin();
+      geometry->WorldToIndex(origin, origin);
+      origin[task.sliceDimension] += static_cast<double>(direction) * distance;
+      geometry->IndexToWorld(origin, origin);
+      plane->SetOrigin(origin);
+
+      InterpolationTask neighbor;
+      if (this->CreateInterpolationTask(task.timeStep, task.sliceDimension, sliceIndex, plane, neighbor))
+        tasks.push_back(neighbor);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_CacheMutex);
+
+    // tasks for previous positions are not of interest anymore
+    m_PrecomputationTasks.clear();
+    for (const auto &neighbor : tasks)
+    {
+      if (this->GetCachedInterpolation(neighbor).IsNull())
+        m_PrecomputationTasks.push_back(neighbor);
+    }
+
+    if (m_PrecomputationTasks.empty())
+      return;
+
+    if (!m_PrecomputationThread.joinable())
+      m_PrecomputationThread = std::thread(&SegmentationInterpolationController::ProcessPrecomputationTasks, this);
+  }
+  m_PrecomputationCondition.notify_one();
+}
+
+void mitk::SegmentationInterpolationController::ProcessPrecomputationTasks()
+{
+  std::unique_lock<std::mutex> lock(m_CacheMutex);
+  for (;;)
+  {
+    m_PrecomputationCondition.wait(lock, [this]() { return m_StopPrecomputation || !m_PrecomputationTasks.empty(); });
+    if (m_StopPrecomputation)
+      return;
+
+    InterpolationTask task = m_PrecomputationTasks.front();
+    m_PrecomputationTasks.pop_front();
+    if (!this->IsTaskUpToDate(task) || this->GetCachedInterpolation(task).IsNotNull())
+      continue;
+
+    lock.unlock();
+    Image::Pointer result = ComputeInterpolation(task);
+    lock.lock();
+
+    // the input slices may have been changed during the computation
+    if (result.IsNotNull() && this->IsTaskUpToDate(task))
+      this->StoreInterpolation(task, result);
+  }
+}
+
+void mitk::SegmentationInterpolationController::StopPrecomputation()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_CacheMutex);
+    m_StopPrecomputation = true;
+    m_PrecomputationTasks.clear();
+  }
+  m_PrecomputationCondition.notify_all();
+
+  if (m_PrecomputationThread.joinable())
+    m_PrecomputationThread.join();
+}
+
+void mitk::SegmentationInterpolationController::ClearCache()
+{
+  std::lock_guard<std::mutex> lock(m_CacheMutex);
+
+  m_Cache.clear();
+  m_PrecomputationTasks.clear();
+
+  // a new generation for all slices, so that running computations are not stored either
+  ++m_Generation;
+  m_SliceGenerations.resize(m_SegmentationCountInSlice.size());
+  for (unsigned int timeStep = 0; timeStep < m_SegmentationCountInSlice.size(); ++timeStep)
+  {
+    m_SliceGenerations[timeStep].resize(3);
+    for (unsigned int dim = 0; dim < 3; ++dim)
+      m_SliceGenerations[timeStep][dim].assign(m_SegmentationCountInSlice[timeStep][dim].size(), m_Generation);
+  }
 }
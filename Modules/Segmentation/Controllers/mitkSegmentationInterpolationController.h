@@ -19,12 +19,19 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkCommon.h"
 #include "mitkImage.h"
+#include "mitkPlaneGeometry.h"
 #include <MitkSegmentationExports.h>
 
 #include <itkImage.h>
+#include <itkImageRegion.h>
 #include <itkObjectFactory.h>
 
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <mutex>
+#include <thread>
+#include <tuple>
 #include <vector>
 
 namespace mitk
@@ -69,6 +76,14 @@ namespace mitk
 
     \image html slice_based_segmentation_interpolator.png
 
+    Tools that write a region of the segmentation (like SegTool2D) can avoid the scan of the whole image by
+    enclosing their change in BeginChangedRegion() and EndChangedRegion(). Only the given region is counted then.
+
+    Interpolate() keeps the computed slices in a small cache. A cached slice is used as long as the two slices it was
+    interpolated from are unchanged. After each call of Interpolate() the slices next to the requested one
+    (see SetPrecomputationRange()) are interpolated in a background thread, so that they are available immediately
+    when the user navigates there.
+
     $Author$
   */
   class MITKSEGMENTATION_EXPORT SegmentationInterpolationController : public itk::Object
@@ -134,6 +149,23 @@ namespace mitk
                          unsigned int timeStep);
     void SetChangedVolume(const Image *sliceDiff, unsigned int timeStep);
 
+    /**
+      \brief Prepare an update of the segmentation within a region.
+
+      Call this before the pixels in region (index coordinates of the segmentation) are changed and
+      EndChangedRegion() after the change. In between, the Modified() event of the image should be blocked
+      (BlockModified()), so that only the region is scanned instead of the whole volume.
+
+      \return false if the region is not counted, e.g. because 2D interpolation is not active. Then nothing has to
+              be blocked and EndChangedRegion() does nothing.
+    */
+    bool BeginChangedRegion(const itk::ImageRegion<3> &region, unsigned int timeStep);
+
+    /**
+      \brief Finish an update started by BeginChangedRegion().
+    */
+    void EndChangedRegion();
+
     /**
       \brief Generates an interpolated image for the given slice.
 
@@ -150,6 +182,14 @@ namespace mitk
 
     void OnImageModified(const itk::EventObject &);
 
+    /**
+      \brief Number of slices on each side of an interpolated slice, which are interpolated in the background.
+
+      0 disables the background computation. Default is 2.
+    */
+    itkSetMacro(PrecomputationRange, unsigned int);
+    itkGetConstMacro(PrecomputationRange, unsigned int);
+
     /**
      * Activate/Deactivate the 2D interpolation.
     */
@@ -181,6 +221,30 @@ namespace mitk
       const void *pixelData;
     };
 
+    /// a slice that is interpolated, from which slices and in which state of these slices
+    struct InterpolationTask
+    {
+      unsigned int timeStep;
+      unsigned int sliceDimension;
+      unsigned int sliceIndex;
+      unsigned int lowerBound;
+      unsigned int upperBound;
+      unsigned long lowerGeneration;
+      unsigned long upperGeneration;
+      PlaneGeometry::Pointer plane;
+      Image::ConstPointer segmentation;
+      Image::ConstPointer referenceImage;
+    };
+
+    struct CachedInterpolation
+    {
+      InterpolationTask task;
+      Image::Pointer result;
+    };
+
+    typedef std::tuple<unsigned int, unsigned int, unsigned int> CacheKeyType;
+    typedef std::map<CacheKeyType, CachedInterpolation> InterpolationCacheType;
+
     typedef std::vector<unsigned int> DirtyVectorType;
     // typedef std::vector< DirtyVectorType[3] > TimeResolvedDirtyVectorType; // cannot work with C++, so next line is
     // used for implementation
@@ -200,6 +264,46 @@ namespace mitk
     template <typename DATATYPE>
     void ScanWholeVolume(const itk::Image<DATATYPE, 3> *, const Image *volume, unsigned int timeStep);
 
+    /// adds (or subtracts) the pixels of a region of the segmentation to the slice counts
+    template <typename DATATYPE>
+    void ScanChangedRegion(const itk::Image<DATATYPE, 3> *,
+                           const Image *volume,
+                           unsigned int timeStep,
+                           const itk::ImageRegion<3> &region,
+                           bool add);
+
+    void UpdateCountsInRegion(const itk::ImageRegion<3> &region, unsigned int timeStep, bool add);
+
+    /// marks all slices intersecting region as changed, invalidates cached interpolations that depend on them
+    void TouchRegion(const itk::ImageRegion<3> &region, unsigned int timeStep);
+
+    /// finds the nearest slices with segmentation below and above sliceIndex
+    bool FindBounds(unsigned int timeStep,
+                    unsigned int sliceDimension,
+                    unsigned int sliceIndex,
+                    unsigned int &lowerBound,
+                    unsigned int &upperBound) const;
+
+    /// the task to interpolate a slice, false if there is nothing to interpolate
+    bool CreateInterpolationTask(unsigned int timeStep,
+                                 unsigned int sliceDimension,
+                                 unsigned int sliceIndex,
+                                 const PlaneGeometry *plane,
+                                 InterpolationTask &task) const;
+
+    /// the actual interpolation, does not access any members and may run in the background thread
+    static Image::Pointer ComputeInterpolation(const InterpolationTask &task);
+
+    // the following methods have to be called with m_CacheMutex locked
+    bool IsTaskUpToDate(const InterpolationTask &task) const;
+    Image::Pointer GetCachedInterpolation(const InterpolationTask &task) const;
+    void StoreInterpolation(const InterpolationTask &task, Image *result);
+
+    void SchedulePrecomputation(const InterpolationTask &task);
+    void ProcessPrecomputationTasks();
+    void StopPrecomputation();
+    void ClearCache();
+
     void PrintStatus();
 
     /**
@@ -219,6 +323,28 @@ namespace mitk
     Image::ConstPointer m_ReferenceImage;
     bool m_BlockModified;
     bool m_2DInterpolationActivated;
+
+    /// region announced by BeginChangedRegion()
+    itk::ImageRegion<3> m_ChangedRegion;
+    unsigned int m_ChangedRegionTimeStep;
+    bool m_ChangedRegionPending;
+
+    /**
+      Time stamp of the last change of each slice, m_SliceGenerations[timeStep][dim][index]. Cached interpolations
+      remember the stamps of their two input slices.
+    */
+    std::vector<std::vector<std::vector<unsigned long>>> m_SliceGenerations;
+    unsigned long m_Generation;
+
+    InterpolationCacheType m_Cache;
+    std::deque<InterpolationTask> m_PrecomputationTasks;
+    unsigned int m_PrecomputationRange;
+
+    // protects m_SliceGenerations, m_Cache and m_PrecomputationTasks, which are shared with the background thread
+    mutable std::mutex m_CacheMutex;
+    std::condition_variable m_PrecomputationCondition;
+    std::thread m_PrecomputationThread;
+    bool m_StopPrecomputation;
   };
 
 } // namespace
@@ -175,8 +175,11 @@ void mitk::ContourTool::OnMouseReleased(StateMachineAction *, InteractionEvent *
   mitk::ContourModelUtils::FillContourInSlice(
     projectedContour, timestep, slice, image, (m_PaintingPixelValue * m_CurrentLabelID));
 
-  // this->WriteBackSegmentationResult(positionEvent, slice);
-  SegTool2D::WriteBackSegmentationResult(positionEvent, slice);
+  // only the bounding box of the contour has changed
+  SliceRegionType dirtyRegion;
+  SegTool2D::ExpandDirtyRegion(dirtyRegion, projectedContour, timestep);
+
+  SegTool2D::WriteBackSegmentationResult(positionEvent, slice, dirtyRegion);
 
   // 4. Make sure the result is drawn again --> is visible then.
   assert(positionEvent->GetSender()->GetRenderWindow());
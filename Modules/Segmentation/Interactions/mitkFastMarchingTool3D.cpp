@@ -21,10 +21,15 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkInteractionConst.h"
 #include "mitkRenderingManager.h"
 
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
 #include "itkOrImageFilter.h"
 #include "mitkImageCast.h"
 #include "mitkImageTimeSelector.h"
 
+#include <algorithm>
+#include <cmath>
+
 // us
 #include <usGetModuleContext.h>
 #include <usModule.h>
@@ -106,6 +111,7 @@ void mitk::FastMarchingTool3D::SetBeta(double value)
   {
     m_Beta = value;
     m_SigmoidFilter->SetBeta(m_Beta);
+    m_SpeedImage = nullptr;
     m_NeedUpdate = true;
   }
 }
@@ -118,6 +124,7 @@ void mitk::FastMarchingTool3D::SetSigma(double value)
     {
       m_Sigma = value;
       m_GradientMagnitudeFilter->SetSigma(m_Sigma);
+      m_GradientImage = nullptr;
       m_NeedUpdate = true;
     }
   }
@@ -129,6 +136,7 @@ void mitk::FastMarchingTool3D::SetAlpha(double value)
   {
     m_Alpha = value;
     m_SigmoidFilter->SetAlpha(m_Alpha);
+    m_SpeedImage = nullptr;
     m_NeedUpdate = true;
   }
 }
@@ -201,16 +209,15 @@ void mitk::FastMarchingTool3D::Activated()
   m_FastMarchingFilter = FastMarchingFilterType::New();
   m_FastMarchingFilter->AddObserver(itk::ProgressEvent(), m_ProgressCommand);
   m_FastMarchingFilter->SetStoppingValue(m_StoppingValue);
+  m_FastMarchingFilter->OverrideOutputInformationOn();
 
   m_SeedContainer = NodeContainer::New();
   m_SeedContainer->Initialize();
   m_FastMarchingFilter->SetTrialPoints(m_SeedContainer);
 
-  // set up pipeline
+  // set up pipeline, the gradient magnitude and the speed image are cached in between (see UpdateFeatureImages)
   m_SmoothFilter->SetInput(m_ReferenceImageAsITK);
   m_GradientMagnitudeFilter->SetInput(m_SmoothFilter->GetOutput());
-  m_SigmoidFilter->SetInput(m_GradientMagnitudeFilter->GetOutput());
-  m_FastMarchingFilter->SetInput(m_SigmoidFilter->GetOutput());
   m_ThresholdFilter->SetInput(m_FastMarchingFilter->GetOutput());
 
   m_ToolManager->GetDataStorage()->Add(m_SeedsAsPointSetNode, m_ToolManager->GetWorkingData(0));
@@ -238,6 +245,9 @@ void mitk::FastMarchingTool3D::Deactivated()
   this->m_GradientMagnitudeFilter->RemoveAllObservers();
   this->m_FastMarchingFilter->RemoveAllObservers();
   m_ResultImageNode = nullptr;
+  m_GradientImage = nullptr;
+  m_SpeedImage = nullptr;
+  m_PreviewImage = nullptr;
   mitk::RenderingManager::GetInstance()->RequestUpdateAll();
 
   unsigned int numberOfPoints = m_SeedsAsPointSet->GetSize();
@@ -270,6 +280,16 @@ void mitk::FastMarchingTool3D::Initialize()
   }
   CastToItkImage(m_ReferenceImage, m_ReferenceImageAsITK);
   m_SmoothFilter->SetInput(m_ReferenceImageAsITK);
+  m_GradientImage = nullptr;
+  m_SpeedImage = nullptr;
+
+  m_PreviewImage = OutputImageType::New();
+  m_PreviewImage->CopyInformation(m_ReferenceImageAsITK);
+  m_PreviewImage->SetRegions(m_ReferenceImageAsITK->GetLargestPossibleRegion());
+  m_PreviewImage->Allocate();
+  m_PreviewImage->FillBuffer(0);
+  m_PreviewRegion = OutputImageType::RegionType();
+
   m_NeedUpdate = true;
 }
 
@@ -298,13 +318,12 @@ void mitk::FastMarchingTool3D::ConfirmSegmentation()
     typedef itk::OrImageFilter<OutputImageType, OutputImageType> OrImageFilterType;
     OrImageFilterType::Pointer orFilter = OrImageFilterType::New();
 
-    orFilter->SetInput(0, m_ThresholdFilter->GetOutput());
+    orFilter->SetInput(0, m_PreviewImage);
     orFilter->SetInput(1, segmentationImageInITK);
     orFilter->Update();
 
     // set image volume in current time step from itk image
-    workingImage->SetVolume((void *)(m_ThresholdFilter->GetOutput()->GetPixelContainer()->GetBufferPointer()),
-                            m_CurrentTimeStep);
+    workingImage->SetVolume((void *)(m_PreviewImage->GetPixelContainer()->GetBufferPointer()), m_CurrentTimeStep);
     this->m_ResultImageNode->SetVisibility(false);
     this->ClearSeeds();
     workingImage->Modified();
@@ -359,6 +378,102 @@ void mitk::FastMarchingTool3D::OnDelete()
   }
 }
 
+void mitk::FastMarchingTool3D::UpdateFeatureImages()
+{
+  if (m_GradientImage.IsNull())
+  {
+    m_GradientMagnitudeFilter->Update();
+    m_GradientImage = m_GradientMagnitudeFilter->GetOutput();
+    m_GradientImage->DisconnectPipeline();
+
+    m_SigmoidFilter->SetInput(m_GradientImage);
+    m_SpeedImage = nullptr;
+  }
+
+  if (m_SpeedImage.IsNull())
+  {
+    m_SigmoidFilter->Update();
+    m_SpeedImage = m_SigmoidFilter->GetOutput();
+    m_SpeedImage->DisconnectPipeline();
+
+    m_FastMarchingFilter->SetInput(m_SpeedImage);
+    m_FastMarchingFilter->SetOutputOrigin(m_SpeedImage->GetOrigin());
+    m_FastMarchingFilter->SetOutputSpacing(m_SpeedImage->GetSpacing());
+    m_FastMarchingFilter->SetOutputDirection(m_SpeedImage->GetDirection());
+  }
+}
+
+mitk::FastMarchingTool3D::InternalImageType::RegionType mitk::FastMarchingTool3D::ComputeNarrowBandRegion() const
+{
+  const InternalImageType::RegionType largestRegion = m_SpeedImage->GetLargestPossibleRegion();
+  InternalImageType::RegionType narrowBand;
+
+  if (m_SeedContainer->empty())
+    return narrowBand;
+
+  // The speed is at most 1 (the output maximum of the sigmoid filter), so each update of the front between face
+  // neighbours adds at least the minimum spacing / sqrt(3) to the arrival time. Voxels farther away from every seed
+  // (in face neighbour steps) than that allows within the stopping value are neither reached nor become trial points.
+  const InternalImageType::SpacingType spacing = m_SpeedImage->GetSpacing();
+  const double minimumSpacing = std::min(spacing[0], std::min(spacing[1], spacing[2]));
+  double radius = std::ceil(std::sqrt(3.0) * m_StoppingValue / minimumSpacing) + 2.0;
+
+  itk::IndexValueType maximumExtent = 0;
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    maximumExtent = std::max(maximumExtent, static_cast<itk::IndexValueType>(largestRegion.GetSize(i)));
+  }
+  radius = std::min(radius, static_cast<double>(maximumExtent));
+  const auto radiusInVoxels = static_cast<itk::IndexValueType>(radius);
+
+  InternalImageType::IndexType minimumIndex = m_SeedContainer->ElementAt(0).GetIndex();
+  InternalImageType::IndexType maximumIndex = minimumIndex;
+  for (NodeContainer::ConstIterator it = m_SeedContainer->Begin(); it != m_SeedContainer->End(); ++it)
+  {
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      minimumIndex[i] = std::min(minimumIndex[i], it->Value().GetIndex()[i]);
+      maximumIndex[i] = std::max(maximumIndex[i], it->Value().GetIndex()[i]);
+    }
+  }
+
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    narrowBand.SetIndex(i, minimumIndex[i] - radiusInVoxels);
+    narrowBand.SetSize(i, maximumIndex[i] - minimumIndex[i] + 2 * radiusInVoxels + 1);
+  }
+
+  if (!narrowBand.Crop(largestRegion))
+    return InternalImageType::RegionType();
+
+  return narrowBand;
+}
+
+void mitk::FastMarchingTool3D::UpdatePreviewImage(const InternalImageType::RegionType &narrowBand)
+{
+  // Everything outside of the narrow band is 0, so only the last and the current band have to be touched
+  if (m_PreviewRegion.GetNumberOfPixels() > 0)
+  {
+    itk::ImageRegionIterator<OutputImageType> clearIt(m_PreviewImage, m_PreviewRegion);
+    for (clearIt.GoToBegin(); !clearIt.IsAtEnd(); ++clearIt)
+    {
+      clearIt.Set(0);
+    }
+  }
+
+  if (narrowBand.GetNumberOfPixels() > 0)
+  {
+    itk::ImageRegionConstIterator<OutputImageType> resultIt(m_ThresholdFilter->GetOutput(), narrowBand);
+    itk::ImageRegionIterator<OutputImageType> previewIt(m_PreviewImage, narrowBand);
+    for (resultIt.GoToBegin(), previewIt.GoToBegin(); !resultIt.IsAtEnd(); ++resultIt, ++previewIt)
+    {
+      previewIt.Set(resultIt.Get());
+    }
+  }
+
+  m_PreviewRegion = narrowBand;
+}
+
 void mitk::FastMarchingTool3D::Update()
 {
   const unsigned int progress_steps = 200;
@@ -370,9 +485,17 @@ void mitk::FastMarchingTool3D::Update()
     // remove interaction with poinset while updating
     m_SeedPointInteractor->SetDataNode(nullptr);
     CurrentlyBusy.Send(true);
+    InternalImageType::RegionType narrowBand;
     try
     {
-      m_ThresholdFilter->Update();
+      this->UpdateFeatureImages();
+
+      narrowBand = this->ComputeNarrowBandRegion();
+      if (narrowBand.GetNumberOfPixels() > 0)
+      {
+        m_FastMarchingFilter->SetOutputRegion(narrowBand);
+        m_ThresholdFilter->Update();
+      }
     }
     catch (itk::ExceptionObject &excep)
     {
@@ -389,9 +512,11 @@ void mitk::FastMarchingTool3D::Update()
     m_ProgressCommand->SetProgress(progress_steps);
     CurrentlyBusy.Send(false);
 
+    this->UpdatePreviewImage(narrowBand);
+
     // make output visible
     mitk::Image::Pointer result = mitk::Image::New();
-    CastToMitkImage(m_ThresholdFilter->GetOutput(), result);
+    CastToMitkImage(m_PreviewImage, result);
     result->GetGeometry()->SetOrigin(m_ReferenceImage->GetGeometry()->GetOrigin());
     result->GetGeometry()->SetIndexToWorldTransform(m_ReferenceImage->GetGeometry()->GetIndexToWorldTransform());
     m_ResultImageNode->SetData(result);
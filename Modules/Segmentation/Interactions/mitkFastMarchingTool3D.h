@@ -50,6 +50,10 @@ namespace mitk
       Smoothing->GradientMagnitude->SigmoidFunction->FastMarching->Threshold
     The resulting binary image is seen as a segmentation of an object.
 
+    The feature images (gradient magnitude and sigmoid speed image) are cached and only recomputed if the
+    reference image, sigma, alpha or beta change. Fast marching itself is only evaluated in the narrow band
+    around the seeds that the front can reach before the stopping value.
+
     For detailed documentation see ITK Software Guide section 9.3.1 Fast Marching Segmentation.
   */
   class MITKSEGMENTATION_EXPORT FastMarchingTool3D : public AutoSegmentationTool
@@ -127,6 +131,15 @@ namespace mitk
     /// \brief Reset all relevant inputs of the itk pipeline.
     void Reset();
 
+    /// \brief Recomputes the cached gradient magnitude and speed images if their parameters changed.
+    void UpdateFeatureImages();
+
+    /// \brief Region around the seeds that fast marching can reach before the stopping value.
+    InternalImageType::RegionType ComputeNarrowBandRegion() const;
+
+    /// \brief Copies the thresholded narrow band into the full size preview image.
+    void UpdatePreviewImage(const InternalImageType::RegionType &narrowBand);
+
     mitk::ToolCommand::Pointer m_ProgressCommand;
 
     Image::Pointer m_ReferenceImage;
@@ -146,6 +159,12 @@ namespace mitk
 
     InternalImageType::Pointer m_ReferenceImageAsITK; // the reference image as itk::Image
 
+    InternalImageType::Pointer m_GradientImage; // cached gradient magnitude, nullptr if it has to be recomputed
+    InternalImageType::Pointer m_SpeedImage;    // cached sigmoid output, nullptr if it has to be recomputed
+
+    OutputImageType::Pointer m_PreviewImage;     // full size result, only the narrow band is rewritten
+    OutputImageType::RegionType m_PreviewRegion; // narrow band that was written into the preview last time
+
     mitk::DataNode::Pointer m_ResultImageNode; // holds the result as a preview image
 
     mitk::DataNode::Pointer m_SeedsAsPointSetNode; // used to visualize the seed points
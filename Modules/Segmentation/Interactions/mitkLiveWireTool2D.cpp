@@ -268,6 +268,7 @@ void mitk::LiveWireTool2D::OnInitLiveWire(StateMachineAction *, InteractionEvent
   m_WorkingSlice->GetSlicedGeometry()->SetOrigin(origin);
 
   m_LiveWireFilter = ImageLiveWireContourModelFilter::New();
+  m_LiveWireFilter->UseIncrementalSearchOn();
   m_LiveWireFilter->SetInput(m_WorkingSlice);
 
   // Map click to pixel coordinates
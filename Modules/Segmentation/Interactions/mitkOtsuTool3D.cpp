@@ -29,8 +29,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkSliceNavigationController.h>
 
 // ITK
-#include <itkBinaryThresholdImageFilter.h>
-#include <itkOrImageFilter.h>
+#include <itkImageRegionIterator.h>
 #include <itkOtsuMultipleThresholdsImageFilter.h>
 
 // us
@@ -46,7 +45,7 @@ namespace mitk
   MITK_TOOL_MACRO(MITKSEGMENTATION_EXPORT, OtsuTool3D, "Otsu Segmentation");
 }
 
-mitk::OtsuTool3D::OtsuTool3D()
+mitk::OtsuTool3D::OtsuTool3D() : m_Image3DTimeStep(0), m_Image3DMTime(0)
 {
 }
 
@@ -92,6 +91,8 @@ void mitk::OtsuTool3D::Deactivated()
   m_BinaryPreviewNode = nullptr;
   m_ToolManager->GetDataStorage()->Remove(this->m_MaskedImagePreviewNode);
   m_MaskedImagePreviewNode = nullptr;
+  m_OtsuFilter = nullptr;
+  m_Image3D = nullptr;
 
   Superclass::Deactivated();
 }
@@ -116,17 +117,25 @@ void mitk::OtsuTool3D::RunSegmentation(int regions, bool useValley, int numberOf
 
   unsigned int timestep = mitk::RenderingManager::GetInstance()->GetTimeNavigationController()->GetTime()->GetPos();
 
-  mitk::Image::Pointer image3D = Get3DImage(m_OriginalImage, timestep);
+  // extract the time step only if it changed, then the filter reuses its histogram and only the thresholds and
+  // labels are computed for a new number of regions
+  if (m_Image3D.IsNull() || m_Image3DTimeStep != timestep || m_Image3DMTime != m_OriginalImage->GetMTime())
+  {
+    m_Image3D = Get3DImage(m_OriginalImage, timestep);
+    m_Image3DTimeStep = timestep;
+    m_Image3DMTime = m_OriginalImage->GetMTime();
+  }
 
-  mitk::OtsuSegmentationFilter::Pointer otsuFilter = mitk::OtsuSegmentationFilter::New();
-  otsuFilter->SetNumberOfThresholds(numberOfThresholds);
-  otsuFilter->SetValleyEmphasis(useValley);
-  otsuFilter->SetNumberOfBins(numberOfBins);
-  otsuFilter->SetInput(image3D);
+  if (m_OtsuFilter.IsNull())
+    m_OtsuFilter = mitk::OtsuSegmentationFilter::New();
+  m_OtsuFilter->SetNumberOfThresholds(numberOfThresholds);
+  m_OtsuFilter->SetValleyEmphasis(useValley);
+  m_OtsuFilter->SetNumberOfBins(numberOfBins);
+  m_OtsuFilter->SetInput(m_Image3D);
 
   try
   {
-    otsuFilter->Update();
+    m_OtsuFilter->Update();
   }
   catch (...)
   {
@@ -142,7 +151,7 @@ void mitk::OtsuTool3D::RunSegmentation(int regions, bool useValley, int numberOf
   m_MultiLabelResultNode->SetOpacity(1.0);
 
   mitk::LabelSetImage::Pointer resultImage = mitk::LabelSetImage::New();
-  resultImage->InitializeByLabeledImage(otsuFilter->GetOutput());
+  resultImage->InitializeByLabeledImage(m_OtsuFilter->GetOutput());
   this->m_MultiLabelResultNode->SetData(resultImage);
   m_MultiLabelResultNode->SetProperty("binary", mitk::BoolProperty::New(false));
   mitk::RenderingModeProperty::Pointer renderingMode = mitk::RenderingModeProperty::New();
@@ -193,46 +202,30 @@ void mitk::OtsuTool3D::CalculatePreview(itk::Image<TPixel, VImageDimension> *itk
   typedef itk::Image<TPixel, VImageDimension> InputImageType;
   typedef itk::Image<mitk::Tool::DefaultSegmentationDataType, VImageDimension> OutputImageType;
 
-  typedef itk::BinaryThresholdImageFilter<InputImageType, OutputImageType> FilterType;
-
-  typename FilterType::Pointer filter = FilterType::New();
-
-  // InputImageType::Pointer itkImage;
-  typename OutputImageType::Pointer itkBinaryTempImage1;
-  typename OutputImageType::Pointer itkBinaryTempImage2;
-  typename OutputImageType::Pointer itkBinaryResultImage;
-
-  // mitk::Image::Pointer multiLabelSegmentation = dynamic_cast<mitk::Image*>(m_MultiLabelResultNode->GetData());
-  // mitk::CastToItkImage(multiLabelSegmentation, itkImage);
-
-  filter->SetInput(itkImage);
-  filter->SetLowerThreshold(regionIDs[0]);
-  filter->SetUpperThreshold(regionIDs[0]);
-  filter->SetInsideValue(1);
-  filter->SetOutsideValue(0);
-  filter->Update();
-  itkBinaryTempImage2 = filter->GetOutput();
+  // the union of all given regions in one pass, selected[label] tells whether a label belongs to it
+  std::vector<bool> selected;
+  for (int regionID : regionIDs)
+  {
+    if (regionID < 0)
+      continue;
+    if (static_cast<std::size_t>(regionID) >= selected.size())
+      selected.resize(regionID + 1, false);
+    selected[regionID] = true;
+  }
 
-  typename itk::OrImageFilter<OutputImageType, OutputImageType>::Pointer orFilter =
-    itk::OrImageFilter<OutputImageType, OutputImageType>::New();
+  typename OutputImageType::Pointer itkBinaryResultImage = OutputImageType::New();
+  itkBinaryResultImage->CopyInformation(itkImage);
+  itkBinaryResultImage->SetRegions(itkImage->GetBufferedRegion());
+  itkBinaryResultImage->Allocate();
 
-  // if more than one region id is used compute the union of all given binary regions
-  for (auto it = regionIDs.begin(); it != regionIDs.end(); ++it)
+  itk::ImageRegionConstIterator<InputImageType> inputIter(itkImage, itkImage->GetBufferedRegion());
+  itk::ImageRegionIterator<OutputImageType> outputIter(itkBinaryResultImage, itkImage->GetBufferedRegion());
+  for (; !inputIter.IsAtEnd(); ++inputIter, ++outputIter)
   {
-    filter->SetLowerThreshold(*it);
-    filter->SetUpperThreshold(*it);
-    filter->SetInsideValue(1);
-    filter->SetOutsideValue(0);
-    filter->Update();
-    itkBinaryTempImage1 = filter->GetOutput();
-
-    orFilter->SetInput1(itkBinaryTempImage1);
-    orFilter->SetInput2(itkBinaryTempImage2);
-
-    orFilter->UpdateLargestPossibleRegion();
-    itkBinaryResultImage = orFilter->GetOutput();
-    itkBinaryTempImage2 = itkBinaryResultImage;
+    const auto label = static_cast<std::size_t>(inputIter.Get());
+    outputIter.Set(label < selected.size() && selected[label] ? 1 : 0);
   }
+
   //----------------------------------------------------------------------------------------------------
   mitk::Image::Pointer binarySegmentation;
   mitk::CastToMitkImage(itkBinaryResultImage, binarySegmentation);
@@ -28,6 +28,7 @@ namespace us
 namespace mitk
 {
   class Image;
+  class OtsuSegmentationFilter;
 
   class MITKSEGMENTATION_EXPORT OtsuTool3D : public AutoSegmentationTool
   {
@@ -59,6 +60,11 @@ namespace mitk
     void CalculatePreview(itk::Image<TPixel, VImageDimension> *itkImage, std::vector<int> regionIDs);
 
     itk::SmartPointer<Image> m_OriginalImage;
+    // the filter keeps the histogram of the selected time step, so it is reused for RunSegmentation() calls
+    itk::SmartPointer<OtsuSegmentationFilter> m_OtsuFilter;
+    itk::SmartPointer<Image> m_Image3D;
+    unsigned int m_Image3DTimeStep;
+    unsigned long m_Image3DMTime;
     // holds the user selected binary segmentation
     mitk::DataNode::Pointer m_BinaryPreviewNode;
     // holds the multilabel result as a preview image
@@ -401,6 +401,7 @@ void mitk::PaintbrushTool::MouseMoved(mitk::InteractionEvent *interactionEvent,
     // m_PaintingPixelValue only decides whether to paint or erase
     mitk::ContourModelUtils::FillContourInSlice(
       contour, m_WorkingSlice, image, m_PaintingPixelValue * activeColor);
+    SegTool2D::ExpandDirtyRegion(m_DirtyRegion, contour);
 
     m_WorkingNode->SetData(m_WorkingSlice);
     m_WorkingNode->Modified();
@@ -453,6 +454,7 @@ void mitk::PaintbrushTool::MouseMoved(mitk::InteractionEvent *interactionEvent,
       contour->AddVertex(vertex);
 
       mitk::ContourModelUtils::FillContourInSlice(contour, m_WorkingSlice, image, m_PaintingPixelValue * activeColor);
+      SegTool2D::ExpandDirtyRegion(m_DirtyRegion, contour);
       m_WorkingNode->SetData(m_WorkingSlice);
       m_WorkingNode->Modified();
     }
@@ -499,7 +501,8 @@ void mitk::PaintbrushTool::OnMouseReleased(StateMachineAction *, InteractionEven
   if (!positionEvent)
     return;
 
-  this->WriteBackSegmentationResult(positionEvent, m_WorkingSlice->Clone());
+  if (m_DirtyRegion.GetNumberOfPixels() > 0)
+    this->WriteBackSegmentationResult(positionEvent, m_WorkingSlice->Clone(), m_DirtyRegion);
 
   // deactivate visibility of helper node
   m_WorkingNode->SetVisibility(false);
@@ -545,6 +548,7 @@ void mitk::PaintbrushTool::CheckIfCurrentSliceHasChanged(const InteractionPositi
   {
     m_CurrentPlane = planeGeometry;
     m_WorkingSlice = SegTool2D::GetAffectedImageSliceAs2DImage(event, image)->Clone();
+    m_DirtyRegion = SliceRegionType();
     m_WorkingNode->ReplaceProperty("color", workingNode->GetProperty("color"));
     m_WorkingNode->SetData(m_WorkingSlice);
   }
@@ -563,6 +567,7 @@ void mitk::PaintbrushTool::CheckIfCurrentSliceHasChanged(const InteractionPositi
       m_WorkingNode = nullptr;
       m_CurrentPlane = planeGeometry;
       m_WorkingSlice = SegTool2D::GetAffectedImageSliceAs2DImage(event, image)->Clone();
+      m_DirtyRegion = SliceRegionType();
 
       m_WorkingNode = mitk::DataNode::New();
       m_WorkingNode->SetProperty("levelwindow", mitk::LevelWindowProperty::New(mitk::LevelWindow(0, 1)));
@@ -100,6 +100,8 @@ namespace mitk
     PlaneGeometry::ConstPointer m_CurrentPlane;
     DataNode::Pointer m_WorkingNode;
     mitk::Point3D m_LastPosition;
+    // part of m_WorkingSlice painted on since it was extracted
+    SliceRegionType m_DirtyRegion;
   };
 
 } // namespace
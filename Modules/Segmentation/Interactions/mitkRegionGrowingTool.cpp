@@ -22,6 +22,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkOverwriteSliceImageFilter.h"
 #include "mitkRegionGrowingTool.xpm"
 #include "mitkRenderingManager.h"
+#include "mitkScanlineRegionGrower.h"
 #include "mitkToolManager.h"
 
 #include "mitkExtractDirectedPlaneImageFilterNew.h"
@@ -38,7 +39,6 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkITKImageImport.h"
 #include "mitkImageAccessByItk.h"
 #include <itkConnectedComponentImageFilter.h>
-#include <itkConnectedThresholdImageFilter.h>
 #include <itkImageRegionIteratorWithIndex.h>
 #include <itkNeighborhoodIterator.h>
 
@@ -185,11 +185,12 @@ void mitk::RegionGrowingTool::IsInsideSegmentation(itk::Image<TPixel, imageDimen
   }
 }
 
-// Do the region growing (i.e. call an ITK filter that does it)
+// Do the region growing
 template <typename TPixel, unsigned int imageDimension>
 void mitk::RegionGrowingTool::StartRegionGrowing(itk::Image<TPixel, imageDimension> *inputImage,
                                                  itk::Index<imageDimension> seedIndex,
                                                  std::array<ScalarType, 2> thresholds,
+                                                 const BaseGeometry *sliceGeometry,
                                                  mitk::Image::Pointer &outputImage)
 {
   MITK_DEBUG << "Starting region growing at index " << seedIndex << " with lower threshold " << thresholds[0]
@@ -198,33 +199,31 @@ void mitk::RegionGrowingTool::StartRegionGrowing(itk::Image<TPixel, imageDimensi
   typedef itk::Image<TPixel, imageDimension> InputImageType;
   typedef itk::Image<DefaultSegmentationDataType, imageDimension> OutputImageType;
 
-  typedef itk::ConnectedThresholdImageFilter<InputImageType, OutputImageType> RegionGrowingFilterType;
-  typename RegionGrowingFilterType::Pointer regionGrower = RegionGrowingFilterType::New();
-
   // perform region growing in desired segmented region
-  regionGrower->SetInput(inputImage);
-  regionGrower->AddSeed(seedIndex);
-
-  regionGrower->SetLower(thresholds[0]);
-  regionGrower->SetUpper(thresholds[1]);
+  ScanlineRegionGrower<InputImageType, OutputImageType> regionGrower;
+  regionGrower.SetInput(inputImage);
+  regionGrower.SetLower(thresholds[0]);
+  regionGrower.SetUpper(thresholds[1]);
 
-  try
+  if (!regionGrower.Grow(seedIndex))
   {
-    regionGrower->Update();
-  }
-  catch (...)
-  {
-    return; // Should we do something?
+    MITK_DEBUG << "Region growing result is empty.";
+    m_ConnectedComponentValue = 0;
+    return;
   }
 
-  typename OutputImageType::Pointer resultImage = regionGrower->GetOutput();
+  // Everything below only works on the bounding box of the region plus the smoothing radius, since all pixels
+  // farther away stay 0 anyway. This keeps updating the preview while dragging the thresholds interactive.
+  const unsigned int smoothingRadius = 2; // for now, maybe make this something the user can adjust in the preferences?
+  const typename InputImageType::RegionType maskRegion = regionGrower.GetMaskRegion(smoothingRadius);
+  typename OutputImageType::Pointer resultImage = regionGrower.CreateMask(smoothingRadius);
 
   // Smooth result: Every pixel is replaced by the majority of the neighborhood
   typedef itk::NeighborhoodIterator<OutputImageType> NeighborhoodIteratorType;
   typedef itk::ImageRegionIterator<OutputImageType> ImageIteratorType;
 
   typename NeighborhoodIteratorType::RadiusType radius;
-  radius.Fill(2); // for now, maybe make this something the user can adjust in the preferences?
+  radius.Fill(smoothingRadius);
 
   typedef itk::ImageDuplicator< OutputImageType > DuplicatorType;
   typename DuplicatorType::Pointer duplicator = DuplicatorType::New();
@@ -264,11 +263,6 @@ void mitk::RegionGrowingTool::StartRegionGrowing(itk::Image<TPixel, imageDimensi
     }
   }
 
-  if (resultImage.IsNull())
-  {
-    MITK_DEBUG << "Region growing result is empty.";
-  }
-
   // Can potentially have multiple regions, use connected component image filter to label disjunct regions
   typedef itk::ConnectedComponentImageFilter<OutputImageType, OutputImageType> ConnectedComponentImageFilterType;
   typename ConnectedComponentImageFilterType::Pointer connectedComponentFilter =
@@ -276,9 +270,30 @@ void mitk::RegionGrowingTool::StartRegionGrowing(itk::Image<TPixel, imageDimensi
   connectedComponentFilter->SetInput(resultImage);
   connectedComponentFilter->Update();
   typename OutputImageType::Pointer resultImageCC = connectedComponentFilter->GetOutput();
-  m_ConnectedComponentValue = resultImageCC->GetPixel(seedIndex);
+
+  itk::Index<imageDimension> seedIndexInMask;
+  for (unsigned int i = 0; i < imageDimension; ++i)
+  {
+    seedIndexInMask[i] = seedIndex[i] - maskRegion.GetIndex(i);
+  }
+  m_ConnectedComponentValue = resultImageCC->GetPixel(seedIndexInMask);
 
   outputImage = mitk::GrabItkImageMemory(resultImageCC);
+
+  // Move the origin of the slice geometry to the first index of the mask
+  Point3D maskIndex;
+  maskIndex.Fill(0.0);
+  for (unsigned int i = 0; i < imageDimension; ++i)
+  {
+    maskIndex[i] = maskRegion.GetIndex(i);
+  }
+
+  Point3D maskOrigin;
+  sliceGeometry->IndexToWorld(maskIndex, maskOrigin);
+
+  BaseGeometry::Pointer maskGeometry = sliceGeometry->Clone();
+  maskGeometry->SetOrigin(maskOrigin);
+  outputImage->SetGeometry(maskGeometry);
 }
 
 void mitk::RegionGrowingTool::OnMousePressed(StateMachineAction *, InteractionEvent *interactionEvent)
@@ -447,9 +462,10 @@ void mitk::RegionGrowingTool::OnMousePressedOutside(StateMachineAction *, Intera
 
     // Perform region growing
     mitk::Image::Pointer resultImage = mitk::Image::New();
-    AccessFixedDimensionByItk_3(
-      m_ReferenceSlice, StartRegionGrowing, 2, indexInWorkingSlice2D, m_Thresholds, resultImage);
-    resultImage->SetGeometry(workingSliceGeometry);
+    AccessFixedDimensionByItk_n(m_ReferenceSlice,
+                                StartRegionGrowing,
+                                2,
+                                (indexInWorkingSlice2D, m_Thresholds, workingSliceGeometry.GetPointer(), resultImage));
 
     // Extract contour
     if (resultImage.IsNotNull() && m_ConnectedComponentValue >= 1)
@@ -517,9 +533,10 @@ void mitk::RegionGrowingTool::OnMouseMoved(StateMachineAction *, InteractionEven
 
     // Perform region growing again and show the result
     mitk::Image::Pointer resultImage = mitk::Image::New();
-    AccessFixedDimensionByItk_3(
-      m_ReferenceSlice, StartRegionGrowing, 2, indexInWorkingSlice2D, m_Thresholds, resultImage);
-    resultImage->SetGeometry(workingSliceGeometry);
+    AccessFixedDimensionByItk_n(m_ReferenceSlice,
+                                StartRegionGrowing,
+                                2,
+                                (indexInWorkingSlice2D, m_Thresholds, workingSliceGeometry.GetPointer(), resultImage));
 
     // Update the contour
     if (resultImage.IsNotNull() && m_ConnectedComponentValue >= 1)
@@ -125,12 +125,15 @@ namespace mitk
                               bool *result);
 
     /**
-     * @brief Template that calls an ITK filter to do the region growing.
+     * @brief Template that does the region growing.
+     *
+     * The output image only covers the bounding box of the grown region, its geometry is derived from sliceGeometry.
      */
     template <typename TPixel, unsigned int imageDimension>
     void StartRegionGrowing(itk::Image<TPixel, imageDimension> *itkImage,
                             itk::Index<imageDimension> seedPoint,
                             std::array<ScalarType, 2> thresholds,
+                            const BaseGeometry *sliceGeometry,
                             mitk::Image::Pointer &outputImage);
 
     Image::Pointer m_ReferenceSlice;
@@ -49,19 +49,89 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkOperationEvent.h"
 #include "mitkUndoController.h"
 #include <mitkDiffSliceOperationApplier.h>
+#include <mitkImageWriteAccessor.h>
 
 #include "mitkAbstractTransformGeometry.h"
+#include "mitkContourModel.h"
 #include "mitkImageAccessByItk.h"
 #include "mitkImageCast.h"
 #include "mitkImageToItk.h"
 #include "mitkLabelSetImage.h"
+#include "mitkSegmentationInterpolationController.h"
+
+#include <itkNumericTraits.h>
+
+#include <algorithm>
+#include <cmath>
 
 #define ROUND(a) ((a) > 0 ? (int)((a) + 0.5) : -(int)(0.5 - (a)))
 
 bool mitk::SegTool2D::m_SurfaceInterpolationEnabled = true;
+bool mitk::SegTool2D::m_AcceleratedSliceExtractionEnabled = false;
+
+namespace
+{
+  // Announces the voxels of the volume behind a region of the slice to the 2D interpolation of the image, which then
+  // recounts only these voxels instead of scanning the whole volume. Returns nullptr if the image has no interpolation
+  // or it does not count incrementally.
+  mitk::SegmentationInterpolationController *BeginInterpolationUpdate(const mitk::Image *image,
+                                                                      const mitk::Image *slice,
+                                                                      unsigned int timeStep,
+                                                                      const itk::ImageRegion<2> &sliceRegion)
+  {
+    mitk::SegmentationInterpolationController *interpolator =
+      mitk::SegmentationInterpolationController::InterpolatorForImage(image);
+    if (!interpolator || image->GetDimension() < 3)
+      return nullptr;
+
+    // the corners of the region span the voxels that are written, the reslicer picks the nearest voxel
+    const double tolerance = 1e-3;
+    mitk::Point3D lower;
+    mitk::Point3D upper;
+    for (unsigned int corner = 0; corner < 4; ++corner)
+    {
+      mitk::Point3D sliceIndex;
+      sliceIndex[0] = (corner & 1) ? sliceRegion.GetUpperIndex()[0] : sliceRegion.GetIndex(0);
+      sliceIndex[1] = (corner & 2) ? sliceRegion.GetUpperIndex()[1] : sliceRegion.GetIndex(1);
+      sliceIndex[2] = 0;
+
+      mitk::Point3D world;
+      slice->GetGeometry()->IndexToWorld(sliceIndex, world);
+      mitk::Point3D volumeIndex;
+      image->GetGeometry(timeStep)->WorldToIndex(world, volumeIndex);
+
+      for (unsigned int dim = 0; dim < 3; ++dim)
+      {
+        lower[dim] = corner == 0 ? volumeIndex[dim] : std::min(lower[dim], volumeIndex[dim]);
+        upper[dim] = corner == 0 ? volumeIndex[dim] : std::max(upper[dim], volumeIndex[dim]);
+      }
+    }
+
+    itk::ImageRegion<3> volumeRegion;
+    for (unsigned int dim = 0; dim < 3; ++dim)
+    {
+      const auto first = static_cast<itk::IndexValueType>(std::floor(lower[dim] + tolerance));
+      const auto last = static_cast<itk::IndexValueType>(std::ceil(upper[dim] - tolerance));
+      volumeRegion.SetIndex(dim, first);
+      volumeRegion.SetSize(dim, static_cast<itk::SizeValueType>(std::max<itk::IndexValueType>(last - first + 1, 1)));
+    }
+
+    if (!interpolator->BeginChangedRegion(volumeRegion, timeStep))
+      return nullptr;
+    return interpolator;
+  }
+}
 
 mitk::SegTool2D::SegTool2D(const char *type, const us::Module *interactorModule)
-  : Tool(type, interactorModule), m_LastEventSender(nullptr), m_LastEventSlice(0), m_Contourmarkername("Position"), m_ShowMarkerNodes(false)
+  : Tool(type, interactorModule),
+    m_LastEventSender(nullptr),
+    m_LastEventSlice(0),
+    m_Contourmarkername("Position"),
+    m_ShowMarkerNodes(false),
+    m_OverwriteReferenceGeometry(nullptr),
+    m_OverwriteReferenceGeometryMTime(0),
+    m_OverwriteImageGeometryMTime(0),
+    m_OverwriteTimeStep(0)
 {
   Tool::m_EventConfig = "DisplayConfigMITKNoCrosshair.xml";
 }
@@ -70,6 +140,13 @@ mitk::SegTool2D::~SegTool2D()
 {
 }
 
+void mitk::SegTool2D::Deactivated()
+{
+  // do not keep the working image's volume referenced while the tool is not in use
+  this->ResetOverwriteReslicer();
+  Superclass::Deactivated();
+}
+
 bool mitk::SegTool2D::FilterEvents(InteractionEvent *interactionEvent, DataNode *)
 {
   const auto *positionEvent = dynamic_cast<const InteractionPositionEvent *>(interactionEvent);
@@ -240,6 +317,8 @@ mitk::Image::Pointer mitk::SegTool2D::GetAffectedImageSliceAs2DImage(const Plane
   // additionally extract the given component
   // default is 0; the extractor checks for multi-component images
   extractor->SetComponent(component);
+  // the reslicer only extracts here, so the slice may be sampled by an accelerator
+  extractor->SetUseAccelerator(m_AcceleratedSliceExtractionEnabled);
 
   extractor->Modified();
   extractor->Update();
@@ -292,7 +371,9 @@ mitk::Image::Pointer mitk::SegTool2D::GetAffectedReferenceSlice(const Interactio
   }
 }
 
-void mitk::SegTool2D::WriteBackSegmentationResult(const InteractionPositionEvent *positionEvent, Image *slice)
+void mitk::SegTool2D::WriteBackSegmentationResult(const InteractionPositionEvent *positionEvent,
+                                                  Image *slice,
+                                                  const SliceRegionType &dirtyRegion)
 {
   if (!positionEvent)
     return;
@@ -306,18 +387,19 @@ void mitk::SegTool2D::WriteBackSegmentationResult(const InteractionPositionEvent
     DataNode *workingNode(m_ToolManager->GetWorkingData(0));
     auto *image = dynamic_cast<Image *>(workingNode->GetData());
     unsigned int timeStep = positionEvent->GetSender()->GetTimeStep(image);
-    this->WriteBackSegmentationResult(planeGeometry, slice, timeStep);
+    this->WriteBackSegmentationResult(planeGeometry, slice, timeStep, dirtyRegion);
   }
 }
 
 void mitk::SegTool2D::WriteBackSegmentationResult(const PlaneGeometry *planeGeometry,
                                                   Image *slice,
-                                                  unsigned int timeStep)
+                                                  unsigned int timeStep,
+                                                  const SliceRegionType &dirtyRegion)
 {
   if (!planeGeometry || !slice)
     return;
 
-  SliceInformation sliceInfo(slice, const_cast<mitk::PlaneGeometry *>(planeGeometry), timeStep);
+  SliceInformation sliceInfo(slice, const_cast<mitk::PlaneGeometry *>(planeGeometry), timeStep, dirtyRegion);
   this->WriteSliceToVolume(sliceInfo);
   DataNode *workingNode(m_ToolManager->GetWorkingData(0));
   auto *image = dynamic_cast<Image *>(workingNode->GetData());
@@ -372,50 +454,136 @@ void mitk::SegTool2D::WriteSliceToVolume(const mitk::SegTool2D::SliceInformation
   DataNode *workingNode(m_ToolManager->GetWorkingData(0));
   auto *image = dynamic_cast<Image *>(workingNode->GetData());
 
-  /*============= BEGIN undo/redo feature block ========================*/
-  // Create undo operation by caching the not yet modified slices
-  mitk::Image::Pointer originalSlice = GetAffectedImageSliceAs2DImage(sliceInfo.plane, image, sliceInfo.timestep);
-  auto *undoOperation =
-    new DiffSliceOperation(image,
-                           originalSlice,
-                           dynamic_cast<SlicedGeometry3D *>(originalSlice->GetGeometry()),
-                           sliceInfo.timestep,
-                           sliceInfo.plane);
-  /*============= END undo/redo feature block ========================*/
+  Image::Pointer originalSlice;
+  unsigned int searchRegion[4] = {0, 0, sliceInfo.slice->GetDimension(0), sliceInfo.slice->GetDimension(1)};
+  SegmentationInterpolationController *interpolator = nullptr;
 
-  // Make sure that for reslicing and overwriting the same alogrithm is used. We can specify the mode of the vtk
-  // reslicer
-  vtkSmartPointer<mitkVtkImageOverwrite> reslice = vtkSmartPointer<mitkVtkImageOverwrite>::New();
+  // slices that do not match the extent of the plane are left to the complete write back below
+  bool reuseReslicer = this->UpdateOverwriteReslicer(image, sliceInfo.plane, sliceInfo.timestep);
+  if (reuseReslicer)
+  {
+    const int *outputExtent = m_OverwriteReslicer->GetOutputExtent();
+    reuseReslicer = outputExtent[1] - outputExtent[0] + 1 == static_cast<int>(searchRegion[2]) &&
+                    outputExtent[3] - outputExtent[2] + 1 == static_cast<int>(searchRegion[3]);
+  }
 
-  // Set the slice as 'input'
-  reslice->SetInputSlice(sliceInfo.slice->GetVtkImageData());
+  if (reuseReslicer)
+  {
+    // the reslicer is set up for the plane already, only the edited rectangle has to be processed
+    SliceRegionType sliceRegion;
+    sliceRegion.SetSize(0, searchRegion[2]);
+    sliceRegion.SetSize(1, searchRegion[3]);
 
-  // set overwrite mode to true to write back to the image volume
-  reslice->SetOverwriteMode(true);
-  reslice->Modified();
+    SliceRegionType dirtyRegion = sliceInfo.dirtyRegion;
+    if (dirtyRegion.GetNumberOfPixels() == 0)
+      dirtyRegion = sliceRegion;
 
-  mitk::ExtractSliceFilter::Pointer extractor = mitk::ExtractSliceFilter::New(reslice);
-  extractor->SetInput(image);
-  extractor->SetTimeStep(sliceInfo.timestep);
-  extractor->SetWorldGeometry(sliceInfo.plane);
-  extractor->SetVtkOutputRequest(false);
-  extractor->SetResliceTransformByGeometry(image->GetGeometry(sliceInfo.timestep));
+    if (!dirtyRegion.Crop(sliceRegion))
+      return;
 
-  extractor->Modified();
-  extractor->Update();
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+      searchRegion[i] = static_cast<unsigned int>(dirtyRegion.GetIndex(i));
+      searchRegion[i + 2] = static_cast<unsigned int>(dirtyRegion.GetSize(i));
+    }
+
+    m_OverwriteReslicer->SetOverwriteRegion(static_cast<int>(dirtyRegion.GetIndex(0)),
+                                            static_cast<int>(dirtyRegion.GetUpperIndex()[0]),
+                                            static_cast<int>(dirtyRegion.GetIndex(1)),
+                                            static_cast<int>(dirtyRegion.GetUpperIndex()[1]));
+
+    /*============= BEGIN undo/redo feature block ========================*/
+    // Outside of the dirty region the edited slice equals the volume, so the not yet modified slice
+    // is the edited one with the dirty region read back from the volume
+    originalSlice = sliceInfo.slice->Clone();
+    {
+      // make sure the clone does not share its memory with the edited slice, it is written by vtk
+      ImageWriteAccessor detachAccessor(originalSlice);
+    }
+
+    m_OverwriteReslicer->SetOverwriteMode(false);
+    m_OverwriteReslicer->SetInputSlice(originalSlice->GetVtkImageData());
+    m_OverwriteReslicer->Modified();
+    m_OverwriteReslicer->UpdateWholeExtent();
+    /*============= END undo/redo feature block ========================*/
+
+    interpolator = BeginInterpolationUpdate(image, sliceInfo.slice, sliceInfo.timestep, dirtyRegion);
+
+    // write the dirty region of the edited slice into the volume
+    m_OverwriteReslicer->SetOverwriteMode(true);
+    m_OverwriteReslicer->SetInputSlice(sliceInfo.slice->GetVtkImageData());
+    m_OverwriteReslicer->Modified();
+    m_OverwriteReslicer->UpdateWholeExtent();
+  }
+  else
+  {
+    /*============= BEGIN undo/redo feature block ========================*/
+    // Cache the not yet modified slice for the undo operation
+    originalSlice = GetAffectedImageSliceAs2DImage(sliceInfo.plane, image, sliceInfo.timestep);
+    /*============= END undo/redo feature block ========================*/
+
+    SliceRegionType sliceRegion;
+    sliceRegion.SetSize(0, searchRegion[2]);
+    sliceRegion.SetSize(1, searchRegion[3]);
+    interpolator = BeginInterpolationUpdate(image, sliceInfo.slice, sliceInfo.timestep, sliceRegion);
+
+    // Make sure that for reslicing and overwriting the same alogrithm is used. We can specify the mode of the vtk
+    // reslicer
+    vtkSmartPointer<mitkVtkImageOverwrite> reslice = vtkSmartPointer<mitkVtkImageOverwrite>::New();
+
+    // Set the slice as 'input'
+    reslice->SetInputSlice(sliceInfo.slice->GetVtkImageData());
+
+    // set overwrite mode to true to write back to the image volume
+    reslice->SetOverwriteMode(true);
+    reslice->Modified();
+
+    mitk::ExtractSliceFilter::Pointer extractor = mitk::ExtractSliceFilter::New(reslice);
+    extractor->SetInput(image);
+    extractor->SetTimeStep(sliceInfo.timestep);
+    extractor->SetWorldGeometry(sliceInfo.plane);
+    extractor->SetVtkOutputRequest(false);
+    extractor->SetResliceTransformByGeometry(image->GetGeometry(sliceInfo.timestep));
+
+    extractor->Modified();
+    extractor->Update();
+  }
 
   // the image was modified within the pipeline, but not marked so
-  image->Modified();
+  if (interpolator)
+  {
+    // the interpolation counts the written region only, it must not scan the whole volume
+    interpolator->BlockModified(true);
+    image->Modified();
+    interpolator->BlockModified(false);
+    interpolator->EndChangedRegion();
+  }
+  else
+  {
+    image->Modified();
+  }
   image->GetVtkImageData()->Modified();
 
   /*============= BEGIN undo/redo feature block ========================*/
+  // Both operations only store the voxels that differ between the original and the edited slice
+  auto *undoOperation =
+    new DiffSliceOperation(image,
+                           originalSlice,
+                           sliceInfo.slice,
+                           dynamic_cast<SlicedGeometry3D *>(originalSlice->GetGeometry()),
+                           sliceInfo.timestep,
+                           sliceInfo.plane,
+                           searchRegion);
+
   // specify the undo operation with the edited slice
   auto *doOperation =
     new DiffSliceOperation(image,
-                           extractor->GetOutput(),
+                           sliceInfo.slice,
+                           originalSlice,
                            dynamic_cast<SlicedGeometry3D *>(sliceInfo.slice->GetGeometry()),
                            sliceInfo.timestep,
-                           sliceInfo.plane);
+                           sliceInfo.plane,
+                           searchRegion);
 
   // create an operation event for the undo stack
   OperationEvent *undoStackItem =
@@ -432,6 +600,93 @@ void mitk::SegTool2D::WriteSliceToVolume(const mitk::SegTool2D::SliceInformation
   /*============= END undo/redo feature block ========================*/
 }
 
+bool mitk::SegTool2D::UpdateOverwriteReslicer(Image *image, const PlaneGeometry *plane, unsigned int timestep)
+{
+  if (image == nullptr || plane == nullptr || !image->IsVolumeSet(timestep))
+    return false;
+
+  vtkImageData *volume = image->GetVtkImageData(timestep);
+  const BaseGeometry *imageGeometry = image->GetGeometry(timestep);
+  const BaseGeometry *referenceGeometry = plane->GetReferenceGeometry();
+
+  if (m_OverwriteReslicer.GetPointer() != nullptr && m_OverwriteVolume == volume && m_OverwriteTimeStep == timestep &&
+      m_OverwriteImageGeometryMTime == imageGeometry->GetMTime() &&
+      m_OverwriteReferenceGeometry == referenceGeometry &&
+      (referenceGeometry == nullptr || m_OverwriteReferenceGeometryMTime == referenceGeometry->GetMTime()) &&
+      mitk::Equal(*m_OverwritePlane, *plane, mitk::eps, false))
+  {
+    return true;
+  }
+
+  this->ResetOverwriteReslicer();
+
+  // let the ExtractSliceFilter compute reslice axes, transform and extent once, they are reused for further strokes
+  auto reslicer = vtkSmartPointer<mitkVtkImageOverwrite>::New();
+  mitk::ExtractSliceFilter::Pointer extractor = mitk::ExtractSliceFilter::New(reslicer);
+  extractor->SetInput(image);
+  extractor->SetTimeStep(timestep);
+  extractor->SetWorldGeometry(plane);
+  extractor->SetResliceTransformByGeometry(imageGeometry);
+  extractor->SetResliceGeometryOnly(true);
+  extractor->Update();
+
+  if (reslicer->GetNumberOfInputConnections(0) == 0)
+    return false;
+
+  m_OverwriteReslicer = reslicer;
+  m_OverwriteVolume = volume;
+  m_OverwritePlane = plane->Clone();
+  m_OverwriteReferenceGeometry = referenceGeometry;
+  m_OverwriteReferenceGeometryMTime = referenceGeometry != nullptr ? referenceGeometry->GetMTime() : 0;
+  m_OverwriteImageGeometryMTime = imageGeometry->GetMTime();
+  m_OverwriteTimeStep = timestep;
+  return true;
+}
+
+void mitk::SegTool2D::ResetOverwriteReslicer()
+{
+  m_OverwriteReslicer = nullptr;
+  m_OverwriteVolume = nullptr;
+  m_OverwritePlane = nullptr;
+  m_OverwriteReferenceGeometry = nullptr;
+}
+
+void mitk::SegTool2D::ExpandDirtyRegion(SliceRegionType &region, const ContourModel *contour, int timestep)
+{
+  if (contour == nullptr || contour->IsEmptyTimeStep(timestep) || contour->IsEmpty(timestep))
+    return;
+
+  double bounds[4] = {itk::NumericTraits<double>::max(), itk::NumericTraits<double>::NonpositiveMin(),
+                      itk::NumericTraits<double>::max(), itk::NumericTraits<double>::NonpositiveMin()};
+  for (auto it = contour->Begin(timestep); it != contour->End(timestep); ++it)
+  {
+    const Point3D &point = (*it)->Coordinates;
+    bounds[0] = std::min(bounds[0], point[0]);
+    bounds[1] = std::max(bounds[1], point[0]);
+    bounds[2] = std::min(bounds[2], point[1]);
+    bounds[3] = std::max(bounds[3], point[1]);
+  }
+
+  SliceRegionType::IndexType lower, upper;
+  for (unsigned int i = 0; i < 2; ++i)
+  {
+    lower[i] = static_cast<SliceRegionType::IndexValueType>(std::floor(bounds[2 * i])) - 1;
+    upper[i] = static_cast<SliceRegionType::IndexValueType>(std::ceil(bounds[2 * i + 1])) + 1;
+  }
+
+  if (region.GetNumberOfPixels() > 0)
+  {
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+      lower[i] = std::min(lower[i], region.GetIndex(i));
+      upper[i] = std::max(upper[i], region.GetUpperIndex()[i]);
+    }
+  }
+
+  region.SetIndex(lower);
+  region.SetUpperIndex(upper);
+}
+
 void mitk::SegTool2D::SetShowMarkerNodes(bool status)
 {
   m_ShowMarkerNodes = status;
@@ -442,6 +697,11 @@ void mitk::SegTool2D::SetEnable3DInterpolation(bool enabled)
   m_SurfaceInterpolationEnabled = enabled;
 }
 
+void mitk::SegTool2D::SetEnableAcceleratedSliceExtraction(bool enabled)
+{
+  m_AcceleratedSliceExtractionEnabled = enabled;
+}
+
 int mitk::SegTool2D::AddContourmarker()
 {
   if (m_LastEventSender == nullptr)
@@ -30,9 +30,16 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mitkDiffSliceOperation.h>
 
+#include <itkImageRegion.h>
+#include <vtkSmartPointer.h>
+
+class mitkVtkImageOverwrite;
+class vtkImageData;
+
 namespace mitk
 {
   class BaseRenderer;
+  class ContourModel;
 
   /**
     \brief Abstract base class for segmentation tools.
@@ -95,26 +102,43 @@ namespace mitk
      */
     void SetEnable3DInterpolation(bool);
 
+    /**
+     * \brief Enables or disables the extraction of slices with the registered IImageProcessingAccelerator service
+     * (e.g. on the GPU), and defaults to false. Writing back the slices is not affected.
+     */
+    void SetEnableAcceleratedSliceExtraction(bool);
+
   protected:
     SegTool2D();             // purposely hidden
     SegTool2D(const char *, const us::Module *interactorModule = nullptr); // purposely hidden
     ~SegTool2D() override;
 
+    /** \brief Region of a slice in its index coordinates. A region without pixels stands for the whole slice.*/
+    typedef itk::ImageRegion<2> SliceRegionType;
+
     struct SliceInformation
     {
       mitk::Image::Pointer slice;
       mitk::PlaneGeometry *plane;
       unsigned int timestep;
+      /** The part of the slice that was edited. Only this part is written back to the volume.*/
+      SliceRegionType dirtyRegion;
 
       SliceInformation() {}
-      SliceInformation(mitk::Image *slice, mitk::PlaneGeometry *plane, unsigned int timestep)
+      SliceInformation(mitk::Image *slice,
+                       mitk::PlaneGeometry *plane,
+                       unsigned int timestep,
+                       const SliceRegionType &dirtyRegion = SliceRegionType())
       {
         this->slice = slice;
         this->plane = plane;
         this->timestep = timestep;
+        this->dirtyRegion = dirtyRegion;
       }
     };
 
+    void Deactivated() override;
+
     /**
     * \brief Filters events that cannot be handle by 2D segmentation tools
     *
@@ -162,9 +186,19 @@ namespace mitk
     */
     Image::Pointer GetAffectedReferenceSlice(const InteractionPositionEvent *);
 
-    void WriteBackSegmentationResult(const InteractionPositionEvent *, Image *);
+    /**
+      \brief Writes the slice back into the working image and adds an undo operation for it.
+      If the tool knows which part of the slice it has edited, it should pass it as dirtyRegion,
+      because only this part is then written back and compared for the undo operation.
+    */
+    void WriteBackSegmentationResult(const InteractionPositionEvent *,
+                                     Image *,
+                                     const SliceRegionType &dirtyRegion = SliceRegionType());
 
-    void WriteBackSegmentationResult(const PlaneGeometry *planeGeometry, Image *, unsigned int timeStep);
+    void WriteBackSegmentationResult(const PlaneGeometry *planeGeometry,
+                                     Image *,
+                                     unsigned int timeStep,
+                                     const SliceRegionType &dirtyRegion = SliceRegionType());
 
     void WriteBackSegmentationResult(const std::vector<SliceInformation> &sliceList, bool writeSliceToVolume = true);
 
@@ -172,6 +206,12 @@ namespace mitk
       Image *targetSlice, Image *sourceSlice, Image *workingImage, int paintingPixelValue, int timestep);
 
     void WriteSliceToVolume(const SliceInformation &sliceInfo);
+
+    /**
+      \brief Grows region so that it covers all vertices of a contour given in index coordinates of a slice.
+      A border of one pixel is added to account for the rasterization of the contour.
+    */
+    static void ExpandDirtyRegion(SliceRegionType &region, const ContourModel *contour, int timestep = 0);
     /**
       \brief Adds a new node called Contourmarker to the datastorage which holds a mitk::PlanarFigure.
              By selecting this node the slicestack will be reoriented according to the PlanarFigure's Geometry
@@ -184,11 +224,29 @@ namespace mitk
     unsigned int m_LastEventSlice;
 
   private:
+    /**
+      \brief Sets up m_OverwriteReslicer for the plane, unless it is still set up for it by an earlier call.
+      \return false if the slice could not be set up, e.g. because the time step contains no volume.
+    */
+    bool UpdateOverwriteReslicer(Image *image, const PlaneGeometry *plane, unsigned int timestep);
+
+    void ResetOverwriteReslicer();
+
     // The prefix of the contourmarkername. Suffix is a consecutive number
     const std::string m_Contourmarkername;
 
+    // reslicer set up for the last written plane, reused as long as plane and volume stay the same
+    vtkSmartPointer<mitkVtkImageOverwrite> m_OverwriteReslicer;
+    vtkSmartPointer<vtkImageData> m_OverwriteVolume;
+    PlaneGeometry::Pointer m_OverwritePlane;
+    const BaseGeometry *m_OverwriteReferenceGeometry;
+    unsigned long m_OverwriteReferenceGeometryMTime;
+    unsigned long m_OverwriteImageGeometryMTime;
+    unsigned int m_OverwriteTimeStep;
+
     bool m_ShowMarkerNodes;
     static bool m_SurfaceInterpolationEnabled;
+    static bool m_AcceleratedSliceExtractionEnabled;
   };
 
 } // namespace
@@ -21,13 +21,13 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkBaseRenderer.h"
 #include "mitkImageDataItem.h"
 #include "mitkLabelSetImage.h"
+#include "mitkScanlineRegionGrower.h"
 
 #include <mitkITKImageImport.h>
 #include <mitkImagePixelReadAccessor.h>
 #include <mitkImageToContourModelFilter.h>
 
 #include <itkBinaryFillholeImageFilter.h>
-#include <itkConnectedThresholdImageFilter.h>
 
 mitk::SetRegionTool::SetRegionTool(int paintingPixelValue)
   : FeedbackContourTool("PressMoveRelease"), m_PaintingPixelValue(paintingPixelValue)
@@ -81,8 +81,6 @@ void mitk::SetRegionTool::OnMousePressed(StateMachineAction *, InteractionEvent
 
   typedef itk::Image<DefaultSegmentationDataType, 2> InputImageType;
   typedef InputImageType::IndexType IndexType;
-  typedef itk::ConnectedThresholdImageFilter<InputImageType, InputImageType> RegionGrowingFilterType;
-  RegionGrowingFilterType::Pointer regionGrower = RegionGrowingFilterType::New();
 
   // convert world coordinates to image indices
   IndexType seedIndex;
@@ -91,24 +89,41 @@ void mitk::SetRegionTool::OnMousePressed(StateMachineAction *, InteractionEvent
   // perform region growing in desired segmented region
   InputImageType::Pointer itkImage = InputImageType::New();
   CastToItkImage(workingSlice, itkImage);
-  regionGrower->SetInput(itkImage);
-  regionGrower->AddSeed(seedIndex);
 
   InputImageType::PixelType bound = itkImage->GetPixel(seedIndex);
 
-  regionGrower->SetLower(bound);
-  regionGrower->SetUpper(bound);
-  regionGrower->SetReplaceValue(1);
+  ScanlineRegionGrower<InputImageType, InputImageType> regionGrower;
+  regionGrower.SetInput(itkImage);
+  regionGrower.SetLower(bound);
+  regionGrower.SetUpper(bound);
+  regionGrower.Grow(seedIndex);
+
+  // Only the bounding box of the region is processed, the padding keeps holes that are open towards the
+  // outside of the box open
+  InputImageType::RegionType maskRegion = regionGrower.GetMaskRegion(1);
 
   itk::BinaryFillholeImageFilter<InputImageType>::Pointer fillHolesFilter =
     itk::BinaryFillholeImageFilter<InputImageType>::New();
 
-  fillHolesFilter->SetInput(regionGrower->GetOutput());
+  fillHolesFilter->SetInput(regionGrower.CreateMask(1));
   fillHolesFilter->SetForegroundValue(1);
 
   // Store result and preview
   mitk::Image::Pointer resultImage = mitk::GrabItkImageMemory(fillHolesFilter->GetOutput());
-  resultImage->SetGeometry(workingSlice->GetGeometry());
+
+  // Move the origin of the slice geometry to the first index of the mask
+  Point3D maskIndex;
+  maskIndex[0] = maskRegion.GetIndex(0);
+  maskIndex[1] = maskRegion.GetIndex(1);
+  maskIndex[2] = 0.0;
+
+  Point3D maskOrigin;
+  sliceGeometry->IndexToWorld(maskIndex, maskOrigin);
+
+  BaseGeometry::Pointer maskGeometry = sliceGeometry->Clone();
+  maskGeometry->SetOrigin(maskOrigin);
+  resultImage->SetGeometry(maskGeometry);
+
   // Get the current working color
   DataNode *workingNode(m_ToolManager->GetWorkingData(0));
   if (!workingNode)
@@ -49,7 +49,13 @@ namespace mitk
   MITK_TOOL_MACRO(MITKSEGMENTATION_EXPORT, WatershedTool, "Watershed tool");
 }
 
-mitk::WatershedTool::WatershedTool() : m_Threshold(0.0), m_Level(0.0)
+mitk::WatershedTool::WatershedTool()
+  : m_Threshold(0.0),
+    m_Level(0.0),
+    m_Sigma(1.0),
+    m_FeatureImageMTime(0),
+    m_FeatureImageTimeStep(0),
+    m_FeatureImageSigma(0.0)
 {
 }
 
@@ -64,6 +70,11 @@ void mitk::WatershedTool::Activated()
 
 void mitk::WatershedTool::Deactivated()
 {
+  // the cached images are of the size of the reference image
+  m_Watershed = nullptr;
+  m_FeatureImage = nullptr;
+  m_FeatureImageSource = nullptr;
+
   Superclass::Deactivated();
 }
 
@@ -93,6 +104,19 @@ void mitk::WatershedTool::DoIt()
     return;
 
   unsigned int timestep = mitk::RenderingManager::GetInstance()->GetTimeNavigationController()->GetTime()->GetPos();
+
+  // the gradient only depends on the reference image and sigma, otherwise ITKWatershed() reuses it
+  if (m_FeatureImageSource.GetPointer() != input.GetPointer() || m_FeatureImageMTime != input->GetMTime() ||
+      m_FeatureImageTimeStep != timestep || m_FeatureImageSigma != m_Sigma)
+  {
+    m_FeatureImage = nullptr;
+    m_Watershed = nullptr;
+    m_FeatureImageSource = input.GetPointer();
+    m_FeatureImageMTime = input->GetMTime();
+    m_FeatureImageTimeStep = timestep;
+    m_FeatureImageSigma = m_Sigma;
+  }
+
   input = Get3DImage(input, timestep);
 
   mitk::Image::Pointer output;
@@ -145,27 +169,65 @@ template <typename TPixel, unsigned int VImageDimension>
 void mitk::WatershedTool::ITKWatershed(itk::Image<TPixel, VImageDimension> *originalImage,
                                        mitk::Image::Pointer &segmentation)
 {
-  typedef itk::WatershedImageFilter<itk::Image<float, VImageDimension>> WatershedFilter;
-  typedef itk::GradientMagnitudeRecursiveGaussianImageFilter<itk::Image<TPixel, VImageDimension>,
-                                                             itk::Image<float, VImageDimension>>
+  typedef itk::Image<float, VImageDimension> FeatureImageType;
+  typedef itk::WatershedImageFilter<FeatureImageType> WatershedFilter;
+  typedef itk::GradientMagnitudeRecursiveGaussianImageFilter<itk::Image<TPixel, VImageDimension>, FeatureImageType>
     MagnitudeFilter;
 
-  // at first add a gradient magnitude filter
-  typename MagnitudeFilter::Pointer magnitude = MagnitudeFilter::New();
-  magnitude->SetInput(originalImage);
-  magnitude->SetSigma(1.0);
-
   // use the progress bar
   mitk::ToolCommand::Pointer command = mitk::ToolCommand::New();
   command->AddStepsToDo(60);
 
-  // then add the watershed filter to the pipeline
-  typename WatershedFilter::Pointer watershed = WatershedFilter::New();
-  watershed->SetInput(magnitude->GetOutput());
-  watershed->SetThreshold(m_Threshold);
-  watershed->SetLevel(m_Level);
-  watershed->AddObserver(itk::ProgressEvent(), command);
-  watershed->Update();
+  // at first compute the gradient magnitude, unless DoIt() kept the one of the previous run
+  auto *featureImage = dynamic_cast<FeatureImageType *>(m_FeatureImage.GetPointer());
+  if (!featureImage)
+  {
+    typename MagnitudeFilter::Pointer magnitude = MagnitudeFilter::New();
+    magnitude->SetInput(originalImage);
+    magnitude->SetSigma(m_Sigma);
+    magnitude->Update();
+
+    typename FeatureImageType::Pointer magnitudeImage = magnitude->GetOutput();
+    magnitudeImage->DisconnectPipeline();
+    m_FeatureImage = magnitudeImage.GetPointer();
+    featureImage = magnitudeImage;
+    m_Watershed = nullptr;
+  }
+
+  // then the watershed filter, which only floods again if the threshold changes and only extends its merge tree if
+  // the level exceeds the highest level so far. Its parameters are only set when changed, as setting them marks the
+  // corresponding stage as changed.
+  auto *watershed = dynamic_cast<WatershedFilter *>(m_Watershed.GetPointer());
+  if (!watershed)
+  {
+    typename WatershedFilter::Pointer newWatershed = WatershedFilter::New();
+    newWatershed->SetInput(featureImage);
+    newWatershed->SetThreshold(m_Threshold);
+    newWatershed->SetLevel(m_Level);
+    m_Watershed = newWatershed.GetPointer();
+    watershed = newWatershed;
+  }
+  else
+  {
+    if (watershed->GetThreshold() != m_Threshold)
+      watershed->SetThreshold(m_Threshold);
+    if (watershed->GetLevel() != m_Level)
+      watershed->SetLevel(m_Level);
+  }
+
+  const unsigned long observerTag = watershed->AddObserver(itk::ProgressEvent(), command);
+  try
+  {
+    watershed->Update();
+  }
+  catch (...)
+  {
+    watershed->RemoveObserver(observerTag);
+    // the filter may be in an inconsistent state
+    m_Watershed = nullptr;
+    throw;
+  }
+  watershed->RemoveObserver(observerTag);
 
   // then make sure, that the output has the desired pixel type
   typedef itk::CastImageFilter<typename WatershedFilter::OutputImageType,
@@ -21,6 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkCommon.h"
 #include <MitkSegmentationExports.h>
 #include <itkImage.h>
+#include <itkProcessObject.h>
 
 namespace us
 {
@@ -39,6 +40,11 @@ namespace mitk
 
     Wraps ITK Watershed Filter into tool concept of MITK. For more information look into ITK documentation.
 
+    The gradient magnitude of the reference image and the watershed filter are kept between runs of DoIt(). The
+    gradient is only recomputed when the reference image, its time step or the sigma change, the watershed
+    segmentation only when the threshold changes. A new level re-labels the segments from the existing merge tree,
+    as long as it does not exceed the highest level computed so far.
+
     \warning Only to be instantiated by mitk::ToolManager.
 
     $Darth Vader$
@@ -55,6 +61,8 @@ namespace mitk
     }
 
     void SetLevel(double l) { m_Level = l; }
+    /** \brief Sigma of the Gaussian used for the gradient magnitude, defaults to 1.0. */
+    void SetSigma(double sigma) { m_Sigma = sigma; }
     /** \brief Grabs the tool reference data and creates an ITK pipeline consisting of a GradientMagnitude
       * image filter followed by a Watershed image filter. The output of the filter pipeline is then added
       * to the data storage. */
@@ -84,6 +92,18 @@ namespace mitk
     double m_Threshold;
     /** \brief Threshold parameter of the ITK Watershed Image Filter. See ITK Documentation for more information. */
     double m_Level;
+
+    double m_Sigma;
+
+    /** \brief Gradient magnitude (float itk::Image) of the reference image and what it was computed from. */
+    itk::DataObject::Pointer m_FeatureImage;
+    itk::SmartPointer<const Image> m_FeatureImageSource;
+    unsigned long m_FeatureImageMTime;
+    unsigned int m_FeatureImageTimeStep;
+    double m_FeatureImageSigma;
+
+    /** \brief The itk::WatershedImageFilter working on m_FeatureImage, it keeps the segments and the merge tree. */
+    itk::ProcessObject::Pointer m_Watershed;
   };
 
 } // namespace
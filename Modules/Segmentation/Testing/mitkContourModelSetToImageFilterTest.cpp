@@ -18,6 +18,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkContourModelSetToImageFilter.h>
 #include <mitkIOUtil.h>
 #include <mitkImage.h>
+#include <mitkImagePixelReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
 #include <mitkTestFixture.h>
 #include <mitkTestingMacros.h>
 
@@ -25,11 +27,76 @@ class mitkContourModelSetToImageFilterTestSuite : public mitk::TestFixture
 {
   CPPUNIT_TEST_SUITE(mitkContourModelSetToImageFilterTestSuite);
   MITK_TEST(TestFillContourSetIntoImage);
+  MITK_TEST(TestFillAxialAndFrontalContours);
+  MITK_TEST(TestThreadsYieldSameResult);
   CPPUNIT_TEST_SUITE_END();
 
 private:
   mitk::ContourModelSetToImageFilter::Pointer m_ContourFiller;
 
+  mitk::Image::Pointer CreateReferenceImage()
+  {
+    unsigned int dimensions[3] = {20, 24, 28};
+    mitk::Image::Pointer image = mitk::Image::New();
+    image->Initialize(mitk::MakeScalarPixelType<short>(), 3, dimensions);
+
+    mitk::ImageWriteAccessor writeAccess(image);
+    memset(writeAccess.GetData(), 0, sizeof(short) * 20 * 24 * 28);
+
+    return image;
+  }
+
+  mitk::ContourModel::Pointer CreateContour(const std::vector<mitk::Point3D> &indices, const mitk::Image *image)
+  {
+    mitk::ContourModel::Pointer contour = mitk::ContourModel::New();
+    for (auto index : indices)
+    {
+      mitk::Point3D world;
+      image->GetGeometry()->IndexToWorld(index, world);
+      contour->AddVertex(world);
+    }
+    contour->Close();
+    return contour;
+  }
+
+  mitk::Point3D MakePoint(double x, double y, double z)
+  {
+    mitk::Point3D point;
+    point[0] = x;
+    point[1] = y;
+    point[2] = z;
+    return point;
+  }
+
+  mitk::ContourModelSet::Pointer CreateContourSet(const mitk::Image *image)
+  {
+    mitk::ContourModelSet::Pointer contourSet = mitk::ContourModelSet::New();
+
+    // Axial square covering 5 x 5 pixels of slice 3
+    contourSet->AddContourModel(this->CreateContour(
+      {MakePoint(2, 2, 3), MakePoint(6, 2, 3), MakePoint(6, 6, 3), MakePoint(2, 6, 3)}, image));
+
+    // Frontal triangle covering all pixels with x + z <= 19 in slice 15
+    contourSet->AddContourModel(
+      this->CreateContour({MakePoint(10, 15, 9), MakePoint(18, 15, 1), MakePoint(10, 15, 1)}, image));
+
+    return contourSet;
+  }
+
+  unsigned int CountForeground(mitk::Image *image)
+  {
+    mitk::ImagePixelReadAccessor<unsigned char, 3> readAccess(image);
+    const unsigned char *data = readAccess.GetData();
+
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < 20 * 24 * 28; ++i)
+    {
+      if (0 != data[i])
+        ++count;
+    }
+    return count;
+  }
+
 public:
   void setUp() override
   {
@@ -55,6 +122,54 @@ public:
 
     MITK_ASSERT_EQUAL(refImage, filledImage, "Error filling contours into image");
   }
+
+  void TestFillAxialAndFrontalContours()
+  {
+    mitk::Image::Pointer refImage = this->CreateReferenceImage();
+
+    m_ContourFiller->SetImage(refImage);
+    m_ContourFiller->SetInput(this->CreateContourSet(refImage));
+    m_ContourFiller->Update();
+    mitk::Image::Pointer filledImage = m_ContourFiller->GetOutput();
+
+    CPPUNIT_ASSERT_EQUAL(25u + 45u, this->CountForeground(filledImage));
+
+    mitk::ImagePixelReadAccessor<unsigned char, 3> readAccess(filledImage);
+    itk::Index<3> index;
+    index[0] = 2;
+    index[1] = 6;
+    index[2] = 3;
+    CPPUNIT_ASSERT_EQUAL(static_cast<unsigned char>(1), readAccess.GetPixelByIndex(index));
+    index[2] = 4;
+    CPPUNIT_ASSERT_EQUAL(static_cast<unsigned char>(0), readAccess.GetPixelByIndex(index));
+    index[0] = 14;
+    index[1] = 15;
+    index[2] = 5;
+    CPPUNIT_ASSERT_EQUAL(static_cast<unsigned char>(1), readAccess.GetPixelByIndex(index));
+    index[0] = 15;
+    CPPUNIT_ASSERT_EQUAL(static_cast<unsigned char>(0), readAccess.GetPixelByIndex(index));
+  }
+
+  void TestThreadsYieldSameResult()
+  {
+    mitk::Image::Pointer refImage = this->CreateReferenceImage();
+    mitk::ContourModelSet::Pointer contourSet = this->CreateContourSet(refImage);
+
+    m_ContourFiller->SetNumberOfThreads(1);
+    m_ContourFiller->SetImage(refImage);
+    m_ContourFiller->SetInput(contourSet);
+    m_ContourFiller->Update();
+    mitk::Image::Pointer sequentialImage = m_ContourFiller->GetOutput();
+    sequentialImage->DisconnectPipeline();
+
+    mitk::ContourModelSetToImageFilter::Pointer parallelFiller = mitk::ContourModelSetToImageFilter::New();
+    parallelFiller->SetNumberOfThreads(4);
+    parallelFiller->SetImage(refImage);
+    parallelFiller->SetInput(contourSet);
+    parallelFiller->Update();
+
+    MITK_ASSERT_EQUAL(sequentialImage, parallelFiller->GetOutput(), "Parallel filling differs from sequential filling");
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkContourModelSetToImageFilter)
@@ -0,0 +1,163 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <mitkDiffSliceOperation.h>
+#include <mitkExtractSliceFilter.h>
+#include <mitkImageCast.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+
+#include <itkImage.h>
+#include <itkImageRegionIterator.h>
+
+#include <cstring>
+
+class mitkDiffSliceOperationTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkDiffSliceOperationTestSuite);
+  MITK_TEST(TestSparseOperationRestoresSlices);
+  MITK_TEST(TestSparseOperationIsSmall);
+  MITK_TEST(TestUnchangedSlice);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::Image::Pointer m_Volume;
+  mitk::PlaneGeometry::Pointer m_Plane;
+  mitk::Image::Pointer m_OriginalSlice;
+  mitk::Image::Pointer m_EditedSlice;
+
+  mitk::Image::Pointer ExtractSlice()
+  {
+    mitk::ExtractSliceFilter::Pointer extractor = mitk::ExtractSliceFilter::New();
+    extractor->SetInput(m_Volume);
+    extractor->SetWorldGeometry(m_Plane);
+    extractor->SetVtkOutputRequest(false);
+    extractor->SetResliceTransformByGeometry(m_Volume->GetGeometry());
+    extractor->Update();
+
+    mitk::Image::Pointer slice = extractor->GetOutput();
+    slice->DisconnectPipeline();
+    return slice;
+  }
+
+  bool AreEqual(mitk::Image *a, mitk::Image *b)
+  {
+    mitk::ImageReadAccessor accA(a, a->GetSliceData(0));
+    mitk::ImageReadAccessor accB(b, b->GetSliceData(0));
+    const std::size_t size = a->GetDimension(0) * a->GetDimension(1) * a->GetPixelType().GetSize();
+    return a->GetDimension(0) == b->GetDimension(0) && a->GetDimension(1) == b->GetDimension(1) &&
+           std::memcmp(accA.GetData(), accB.GetData(), size) == 0;
+  }
+
+  mitk::DiffSliceOperation *CreateSparseOperation(mitk::Image *slice, mitk::Image *reference)
+  {
+    return new mitk::DiffSliceOperation(
+      m_Volume, slice, reference, dynamic_cast<mitk::SlicedGeometry3D *>(slice->GetGeometry()), 0, m_Plane);
+  }
+
+public:
+  void setUp() override
+  {
+    typedef itk::Image<unsigned char, 3> ImageType;
+    ImageType::Pointer itkImage = ImageType::New();
+    ImageType::SizeType size = {{64, 64, 16}};
+    itkImage->SetRegions(size);
+    itkImage->Allocate();
+    itkImage->FillBuffer(0);
+
+    // a square that is present in every slice
+    itk::ImageRegionIterator<ImageType> iter(itkImage, itkImage->GetLargestPossibleRegion());
+    for (; !iter.IsAtEnd(); ++iter)
+    {
+      if (iter.GetIndex()[0] > 10 && iter.GetIndex()[0] < 30 && iter.GetIndex()[1] > 10 && iter.GetIndex()[1] < 30)
+        iter.Set(1);
+    }
+    mitk::CastToMitkImage(itkImage, m_Volume);
+
+    m_Plane = mitk::PlaneGeometry::New();
+    m_Plane->InitializeStandardPlane(m_Volume->GetGeometry(), mitk::PlaneGeometry::Axial, 5, true, false);
+    mitk::Point3D origin = m_Plane->GetOrigin();
+    mitk::Vector3D normal = m_Plane->GetNormal();
+    normal.Normalize();
+    origin += normal * 0.5;
+    m_Plane->SetOrigin(origin);
+
+    m_OriginalSlice = this->ExtractSlice();
+    m_EditedSlice = this->ExtractSlice();
+
+    // paint a small stroke
+    mitk::ImageWriteAccessor accessor(m_EditedSlice, m_EditedSlice->GetSliceData(0));
+    auto *data = static_cast<unsigned char *>(accessor.GetData());
+    for (unsigned int y = 40; y < 44; ++y)
+      for (unsigned int x = 35; x < 50; ++x)
+        data[y * 64 + x] = 2;
+  }
+
+  void tearDown() override
+  {
+    m_Volume = nullptr;
+    m_Plane = nullptr;
+    m_OriginalSlice = nullptr;
+    m_EditedSlice = nullptr;
+  }
+
+  void TestSparseOperationRestoresSlices()
+  {
+    // the volume still holds the original slice, so the redo operation has to restore the edited one
+    mitk::DiffSliceOperation *doOperation = this->CreateSparseOperation(m_EditedSlice, m_OriginalSlice);
+    mitk::DiffSliceOperation *undoOperation = this->CreateSparseOperation(m_OriginalSlice, m_EditedSlice);
+
+    CPPUNIT_ASSERT(doOperation->IsSparse());
+    CPPUNIT_ASSERT(doOperation->IsValid());
+
+    mitk::Image::Pointer redoSlice = doOperation->GetSlice();
+    CPPUNIT_ASSERT_MESSAGE("Redo slice equals edited slice", AreEqual(redoSlice, m_EditedSlice));
+
+    mitk::Image::Pointer undoSlice = undoOperation->GetSlice();
+    CPPUNIT_ASSERT_MESSAGE("Undo slice equals original slice", AreEqual(undoSlice, m_OriginalSlice));
+
+    delete doOperation;
+    delete undoOperation;
+  }
+
+  void TestSparseOperationIsSmall()
+  {
+    mitk::DiffSliceOperation *sparseOperation = this->CreateSparseOperation(m_EditedSlice, m_OriginalSlice);
+    auto *denseOperation = new mitk::DiffSliceOperation(
+      m_Volume, m_EditedSlice, dynamic_cast<mitk::SlicedGeometry3D *>(m_EditedSlice->GetGeometry()), 0, m_Plane);
+
+    CPPUNIT_ASSERT(!denseOperation->IsSparse());
+    // the stroke is stored as a single run
+    CPPUNIT_ASSERT(sparseOperation->GetMemorySize() < sizeof(mitk::DiffSliceOperation) + 64);
+    CPPUNIT_ASSERT(denseOperation->GetMemorySize() > sizeof(mitk::DiffSliceOperation));
+
+    delete sparseOperation;
+    delete denseOperation;
+  }
+
+  void TestUnchangedSlice()
+  {
+    mitk::DiffSliceOperation *operation = this->CreateSparseOperation(m_OriginalSlice, m_OriginalSlice);
+    CPPUNIT_ASSERT(operation->GetMemorySize() <= sizeof(mitk::DiffSliceOperation));
+    CPPUNIT_ASSERT(AreEqual(operation->GetSlice(), m_OriginalSlice));
+    delete operation;
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkDiffSliceOperation)
@@ -0,0 +1,134 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkImageLiveWireContourModelFilter.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <itkImageRegionIteratorWithIndex.h>
+
+class mitkImageLiveWireContourModelFilterTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkImageLiveWireContourModelFilterTestSuite);
+  MITK_TEST(TestIncrementalSearchReachesEndPoint);
+  MITK_TEST(TestIncrementalSearchMatchesNewSearch);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::Image::Pointer m_Image;
+
+  std::vector<mitk::Point3D> ComputeLiveWire(mitk::ImageLiveWireContourModelFilter *filter,
+                                             const mitk::Point3D &startPoint,
+                                             const mitk::Point3D &endPoint)
+  {
+    filter->SetStartPoint(startPoint);
+    filter->SetEndPoint(endPoint);
+    filter->Update();
+
+    std::vector<mitk::Point3D> path;
+    mitk::ContourModel *contour = filter->GetOutput();
+    for (auto it = contour->IteratorBegin(); it != contour->IteratorEnd(); ++it)
+    {
+      path.push_back((*it)->Coordinates);
+    }
+    return path;
+  }
+
+  mitk::Point3D CreatePoint(mitk::ScalarType x, mitk::ScalarType y)
+  {
+    mitk::Point3D point;
+    point[0] = x;
+    point[1] = y;
+    point[2] = 0.0;
+    return point;
+  }
+
+public:
+  void setUp() override
+  {
+    // Bright square on a dark, slightly noisy background
+    typedef mitk::ImageLiveWireContourModelFilter::InternalImageType ImageType;
+    ImageType::RegionType region;
+    region.SetSize(0, 64);
+    region.SetSize(1, 64);
+
+    ImageType::Pointer image = ImageType::New();
+    image->SetRegions(region);
+    image->Allocate();
+
+    itk::ImageRegionIteratorWithIndex<ImageType> it(image, region);
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      const ImageType::IndexType index = it.GetIndex();
+      const bool inside = index[0] >= 16 && index[0] < 48 && index[1] >= 16 && index[1] < 48;
+      it.Set((inside ? 200.0f : 0.0f) + static_cast<float>((index[0] * 7 + index[1] * 13) % 5));
+    }
+
+    mitk::CastToMitkImage(image, m_Image);
+  }
+
+  void tearDown() override { m_Image = nullptr; }
+
+  void TestIncrementalSearchReachesEndPoint()
+  {
+    auto filter = mitk::ImageLiveWireContourModelFilter::New();
+    filter->UseIncrementalSearchOn();
+    filter->SetInput(m_Image);
+
+    const mitk::Point3D startPoint = this->CreatePoint(16, 16);
+    const mitk::Point3D endPoint = this->CreatePoint(47, 40);
+    std::vector<mitk::Point3D> path = this->ComputeLiveWire(filter, startPoint, endPoint);
+
+    CPPUNIT_ASSERT_MESSAGE("Live wire is empty", path.size() > 1);
+    CPPUNIT_ASSERT_MESSAGE("Live wire does not start at the start point", mitk::Equal(path.front(), startPoint));
+    CPPUNIT_ASSERT_MESSAGE("Live wire does not end at the end point", mitk::Equal(path.back(), endPoint));
+
+    for (unsigned int i = 1; i < path.size(); ++i)
+    {
+      const bool isNeighbor =
+        std::abs(path[i][0] - path[i - 1][0]) <= 1.0 && std::abs(path[i][1] - path[i - 1][1]) <= 1.0;
+      CPPUNIT_ASSERT_MESSAGE("Live wire is not connected", isNeighbor);
+    }
+  }
+
+  void TestIncrementalSearchMatchesNewSearch()
+  {
+    auto filter = mitk::ImageLiveWireContourModelFilter::New();
+    filter->UseIncrementalSearchOn();
+    filter->SetInput(m_Image);
+
+    const mitk::Point3D startPoint = this->CreatePoint(16, 20);
+
+    // Move the end point like the mouse does, so the kept search tree has to be extended
+    this->ComputeLiveWire(filter, startPoint, this->CreatePoint(20, 16));
+    this->ComputeLiveWire(filter, startPoint, this->CreatePoint(47, 30));
+    std::vector<mitk::Point3D> extendedPath = this->ComputeLiveWire(filter, startPoint, this->CreatePoint(30, 47));
+
+    auto newFilter = mitk::ImageLiveWireContourModelFilter::New();
+    newFilter->UseIncrementalSearchOn();
+    newFilter->SetInput(m_Image);
+    std::vector<mitk::Point3D> newPath = this->ComputeLiveWire(newFilter, startPoint, this->CreatePoint(30, 47));
+
+    CPPUNIT_ASSERT_MESSAGE("Extended search tree yields a different live wire", extendedPath.size() == newPath.size());
+    for (unsigned int i = 0; i < newPath.size(); ++i)
+    {
+      CPPUNIT_ASSERT_MESSAGE("Extended search tree yields a different live wire",
+                             mitk::Equal(extendedPath[i], newPath[i]));
+    }
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkImageLiveWireContourModelFilter)
@@ -0,0 +1,160 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <mitkImageCast.h>
+#include <mitkOtsuSegmentationFilter.h>
+
+#include <itkImage.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+
+class mitkOtsuSegmentationFilterTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkOtsuSegmentationFilterTestSuite);
+  MITK_TEST(ComputeThresholdBins_ThreePeaks_SplitsBetweenPeaks);
+  MITK_TEST(Update_ThreePlateaus_LabelsPlateaus);
+  MITK_TEST(Update_ChangedNumberOfThresholds_UsesNewThresholds);
+  MITK_TEST(Update_Mask_RestrictsHistogram);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef itk::Image<short, 3> ImageType;
+  typedef itk::Image<mitk::OtsuSegmentationFilter::OutputPixelType, 3> LabelImageType;
+
+  mitk::Image::Pointer m_Image;
+
+  // three slabs along x with the values 0, 100 and 200
+  static mitk::Image::Pointer CreatePlateauImage()
+  {
+    ImageType::Pointer itkImage = ImageType::New();
+    ImageType::RegionType region;
+    region.SetSize(0, 30);
+    region.SetSize(1, 10);
+    region.SetSize(2, 10);
+    itkImage->SetRegions(region);
+    itkImage->Allocate();
+
+    for (itk::ImageRegionIterator<ImageType> iter(itkImage, region); !iter.IsAtEnd(); ++iter)
+      iter.Set(static_cast<short>(100 * (iter.GetIndex()[0] / 10)));
+
+    mitk::Image::Pointer image;
+    mitk::CastToMitkImage(itkImage, image);
+    return image;
+  }
+
+  static LabelImageType::Pointer GetLabels(mitk::OtsuSegmentationFilter *filter)
+  {
+    LabelImageType::Pointer labels;
+    mitk::CastToItkImage(filter->GetOutput(), labels);
+    return labels;
+  }
+
+public:
+  void setUp() override { m_Image = CreatePlateauImage(); }
+  void tearDown() override { m_Image = nullptr; }
+
+  void ComputeThresholdBins_ThreePeaks_SplitsBetweenPeaks()
+  {
+    std::vector<double> histogram(30, 0.0);
+    histogram[2] = 10;
+    histogram[3] = 20;
+    histogram[14] = 30;
+    histogram[25] = 5;
+    histogram[27] = 5;
+
+    std::vector<unsigned int> bins = mitk::OtsuSegmentationFilter::ComputeThresholdBins(histogram, 2);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), bins.size());
+    CPPUNIT_ASSERT(bins[0] >= 3 && bins[0] < 14);
+    CPPUNIT_ASSERT(bins[1] >= 14 && bins[1] < 25);
+
+    CPPUNIT_ASSERT_THROW(mitk::OtsuSegmentationFilter::ComputeThresholdBins(histogram, 30), mitk::Exception);
+  }
+
+  void Update_ThreePlateaus_LabelsPlateaus()
+  {
+    mitk::OtsuSegmentationFilter::Pointer filter = mitk::OtsuSegmentationFilter::New();
+    filter->SetInput(m_Image);
+    filter->SetNumberOfThresholds(2);
+    filter->SetNumberOfBins(64);
+    filter->SetNumberOfThreads(3);
+    filter->Update();
+
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), filter->GetThresholds().size());
+    LabelImageType::Pointer labels = GetLabels(filter);
+    for (itk::ImageRegionConstIterator<LabelImageType> iter(labels, labels->GetLargestPossibleRegion());
+         !iter.IsAtEnd();
+         ++iter)
+    {
+      CPPUNIT_ASSERT_EQUAL(static_cast<int>(iter.GetIndex()[0] / 10), static_cast<int>(iter.Get()));
+    }
+  }
+
+  void Update_ChangedNumberOfThresholds_UsesNewThresholds()
+  {
+    mitk::OtsuSegmentationFilter::Pointer filter = mitk::OtsuSegmentationFilter::New();
+    filter->SetInput(m_Image);
+    filter->SetNumberOfThresholds(2);
+    filter->Update();
+
+    filter->SetNumberOfThresholds(1);
+    filter->Update();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), filter->GetThresholds().size());
+
+    // one threshold separates the lowest or the highest plateau, the two others share a region
+    LabelImageType::Pointer labels = GetLabels(filter);
+    LabelImageType::IndexType low = {{5, 5, 5}};
+    LabelImageType::IndexType middle = {{15, 5, 5}};
+    LabelImageType::IndexType high = {{25, 5, 5}};
+    CPPUNIT_ASSERT_EQUAL(0, static_cast<int>(labels->GetPixel(low)));
+    CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(labels->GetPixel(high)));
+    CPPUNIT_ASSERT(labels->GetPixel(middle) == labels->GetPixel(low) ||
+                   labels->GetPixel(middle) == labels->GetPixel(high));
+  }
+
+  void Update_Mask_RestrictsHistogram()
+  {
+    // the mask covers the two upper plateaus only, one threshold has to separate them
+    ImageType::Pointer itkImage;
+    mitk::CastToItkImage(m_Image, itkImage);
+    LabelImageType::Pointer itkMask = LabelImageType::New();
+    itkMask->SetRegions(itkImage->GetLargestPossibleRegion());
+    itkMask->Allocate();
+    for (itk::ImageRegionIterator<LabelImageType> iter(itkMask, itkMask->GetLargestPossibleRegion()); !iter.IsAtEnd();
+         ++iter)
+      iter.Set(iter.GetIndex()[0] >= 10 ? 1 : 0);
+    mitk::Image::Pointer mask;
+    mitk::CastToMitkImage(itkMask, mask);
+
+    mitk::OtsuSegmentationFilter::Pointer filter = mitk::OtsuSegmentationFilter::New();
+    filter->SetInput(m_Image);
+    filter->SetMaskImage(mask);
+    filter->SetNumberOfThresholds(1);
+    filter->Update();
+
+    LabelImageType::Pointer labels = GetLabels(filter);
+    LabelImageType::IndexType low = {{5, 5, 5}};
+    LabelImageType::IndexType middle = {{15, 5, 5}};
+    LabelImageType::IndexType high = {{25, 5, 5}};
+    CPPUNIT_ASSERT_EQUAL(0, static_cast<int>(labels->GetPixel(low)));
+    CPPUNIT_ASSERT_EQUAL(0, static_cast<int>(labels->GetPixel(middle)));
+    CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(labels->GetPixel(high)));
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkOtsuSegmentationFilter)
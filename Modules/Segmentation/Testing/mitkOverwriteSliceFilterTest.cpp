@@ -181,5 +181,31 @@ stop2:
   // MITK_INFO << "index: [" << x << ", " << y << ", " << z << "]";
   MITK_TEST_CONDITION(xx == idX && yy == idY && zz == sliceindex, "test overwrite modified slice");
 
+  /* ============= overwrite only a region of the slice ============*/
+  slice->SetScalarComponentFromDouble(10, 10, 0, 0, 44.0);
+  slice->SetScalarComponentFromDouble(100, 100, 0, 0, 55.0);
+
+  vtkSmartPointer<mitkVtkImageOverwrite> resliceIdx3 = vtkSmartPointer<mitkVtkImageOverwrite>::New();
+  resliceIdx3->SetOverwriteMode(true);
+  resliceIdx3->SetInputSlice(slice);
+  resliceIdx3->SetOverwriteRegion(5, 15, 5, 15);
+  mitk::ExtractSliceFilter::Pointer slicer3 = mitk::ExtractSliceFilter::New(resliceIdx3);
+  slicer3->SetInput(workingImage);
+  slicer3->SetWorldGeometry(plane);
+  slicer3->SetVtkOutputRequest(true);
+  slicer3->Modified();
+  slicer3->Update();
+
+  itk::Index<3> insideId;
+  insideId[0] = insideId[1] = 10;
+  insideId[2] = sliceindex;
+  itk::Index<3> outsideId;
+  outsideId[0] = outsideId[1] = 100;
+  outsideId[2] = sliceindex;
+  MITK_TEST_CONDITION(workingImgReadAccessor.GetPixelByIndex(insideId) == 44, "test overwrite within region");
+  MITK_TEST_CONDITION(workingImgReadAccessor.GetPixelByIndex(outsideId) ==
+                        refImgReadAccessor.GetPixelByIndex(outsideId),
+                      "test no overwrite outside of region");
+
   MITK_TEST_END()
 }
@@ -0,0 +1,207 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkScanlineRegionGrower.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <itkConnectedThresholdImageFilter.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+class mitkScanlineRegionGrowerTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkScanlineRegionGrowerTestSuite);
+  MITK_TEST(TestGrowing2DMatchesConnectedThreshold);
+  MITK_TEST(TestParallelGrowing3DMatchesConnectedThreshold);
+  MITK_TEST(TestMaskOnlyCoversBoundingRegion);
+  MITK_TEST(TestSeedOutsideOfThresholds);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef itk::Image<short, 2> Image2DType;
+  typedef itk::Image<short, 3> Image3DType;
+
+  template <typename TImage>
+  typename TImage::Pointer CreateNoiseImage(unsigned int size)
+  {
+    typename TImage::RegionType region;
+    for (unsigned int i = 0; i < TImage::ImageDimension; ++i)
+    {
+      region.SetIndex(i, 5);
+      region.SetSize(i, size);
+    }
+
+    typename TImage::Pointer image = TImage::New();
+    image->SetRegions(region);
+    image->Allocate();
+
+    // Deterministic pseudo random values, roughly 30 percent are below the lower threshold
+    unsigned int state = 12345;
+    itk::ImageRegionIteratorWithIndex<TImage> it(image, region);
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      state = state * 1103515245u + 12345u;
+      it.Set(static_cast<short>((state >> 16) % 100));
+    }
+
+    return image;
+  }
+
+  template <typename TImage>
+  typename TImage::IndexType FindSeed(const TImage *image, short lower)
+  {
+    itk::ImageRegionConstIteratorWithIndex<TImage> it(image, image->GetBufferedRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      if (it.Get() >= lower)
+        return it.GetIndex();
+    }
+    return it.GetIndex();
+  }
+
+  template <typename TImage>
+  void CompareWithConnectedThreshold(const TImage *image, unsigned int numberOfThreads)
+  {
+    typedef itk::Image<unsigned char, TImage::ImageDimension> MaskType;
+    const short lower = 30;
+    const short upper = 99;
+    const typename TImage::IndexType seed = this->FindSeed(image, lower);
+
+    typedef itk::ConnectedThresholdImageFilter<TImage, MaskType> ConnectedThresholdType;
+    typename ConnectedThresholdType::Pointer connectedThreshold = ConnectedThresholdType::New();
+    connectedThreshold->SetInput(image);
+    connectedThreshold->AddSeed(seed);
+    connectedThreshold->SetLower(lower);
+    connectedThreshold->SetUpper(upper);
+    connectedThreshold->SetReplaceValue(1);
+    connectedThreshold->Update();
+
+    mitk::ScanlineRegionGrower<TImage, MaskType> grower;
+    grower.SetInput(image);
+    grower.SetLower(lower);
+    grower.SetUpper(upper);
+    grower.SetNumberOfThreads(numberOfThreads);
+    CPPUNIT_ASSERT_MESSAGE("Region is grown", grower.Grow(seed));
+
+    typename MaskType::Pointer output = MaskType::New();
+    output->SetRegions(image->GetBufferedRegion());
+    output->Allocate();
+    output->FillBuffer(0);
+    grower.FillOutput(output, 1);
+
+    itk::SizeValueType numberOfPixels = 0;
+    itk::ImageRegionConstIterator<MaskType> expectedIt(connectedThreshold->GetOutput(), output->GetBufferedRegion());
+    itk::ImageRegionConstIterator<MaskType> it(output, output->GetBufferedRegion());
+    for (expectedIt.GoToBegin(), it.GoToBegin(); !it.IsAtEnd(); ++expectedIt, ++it)
+    {
+      CPPUNIT_ASSERT_EQUAL(expectedIt.Get(), it.Get());
+      if (it.Get() != 0)
+        ++numberOfPixels;
+    }
+
+    CPPUNIT_ASSERT_EQUAL(numberOfPixels, grower.GetNumberOfPixels());
+  }
+
+public:
+  void TestGrowing2DMatchesConnectedThreshold()
+  {
+    Image2DType::Pointer image = this->CreateNoiseImage<Image2DType>(200);
+    this->CompareWithConnectedThreshold<Image2DType>(image, 1);
+  }
+
+  void TestParallelGrowing3DMatchesConnectedThreshold()
+  {
+    Image3DType::Pointer image = this->CreateNoiseImage<Image3DType>(64);
+    this->CompareWithConnectedThreshold<Image3DType>(image, 1);
+    this->CompareWithConnectedThreshold<Image3DType>(image, 4);
+  }
+
+  void TestMaskOnlyCoversBoundingRegion()
+  {
+    Image2DType::Pointer image = this->CreateNoiseImage<Image2DType>(100);
+    image->FillBuffer(0);
+
+    Image2DType::IndexType index;
+    for (index[1] = 40; index[1] < 50; ++index[1])
+    {
+      for (index[0] = 20; index[0] < 35; ++index[0])
+      {
+        image->SetPixel(index, 7);
+      }
+    }
+
+    mitk::ScanlineRegionGrower<Image2DType> grower;
+    grower.SetInput(image);
+    grower.SetLower(7);
+    grower.SetUpper(7);
+    Image2DType::IndexType seed;
+    seed[0] = 25;
+    seed[1] = 45;
+    CPPUNIT_ASSERT(grower.Grow(seed));
+    CPPUNIT_ASSERT_EQUAL(itk::SizeValueType(150), grower.GetNumberOfPixels());
+
+    const Image2DType::RegionType boundingRegion = grower.GetBoundingRegion();
+    CPPUNIT_ASSERT_EQUAL(itk::IndexValueType(20), boundingRegion.GetIndex(0));
+    CPPUNIT_ASSERT_EQUAL(itk::IndexValueType(40), boundingRegion.GetIndex(1));
+    CPPUNIT_ASSERT_EQUAL(itk::SizeValueType(15), boundingRegion.GetSize(0));
+    CPPUNIT_ASSERT_EQUAL(itk::SizeValueType(10), boundingRegion.GetSize(1));
+
+    auto mask = grower.CreateMask(2);
+    CPPUNIT_ASSERT_EQUAL(itk::SizeValueType(19), mask->GetLargestPossibleRegion().GetSize(0));
+    CPPUNIT_ASSERT_EQUAL(itk::SizeValueType(14), mask->GetLargestPossibleRegion().GetSize(1));
+
+    itk::SizeValueType numberOfPixels = 0;
+    itk::ImageRegionConstIterator<itk::Image<unsigned char, 2>> it(mask, mask->GetLargestPossibleRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      if (it.Get() != 0)
+        ++numberOfPixels;
+    }
+    CPPUNIT_ASSERT_EQUAL(itk::SizeValueType(150), numberOfPixels);
+
+    itk::Image<unsigned char, 2>::IndexType maskIndex;
+    maskIndex[0] = 2;
+    maskIndex[1] = 2;
+    CPPUNIT_ASSERT_EQUAL(static_cast<unsigned char>(1), mask->GetPixel(maskIndex));
+    maskIndex[0] = 1;
+    CPPUNIT_ASSERT_EQUAL(static_cast<unsigned char>(0), mask->GetPixel(maskIndex));
+  }
+
+  void TestSeedOutsideOfThresholds()
+  {
+    Image2DType::Pointer image = this->CreateNoiseImage<Image2DType>(50);
+    image->FillBuffer(3);
+
+    mitk::ScanlineRegionGrower<Image2DType> grower;
+    grower.SetInput(image);
+    grower.SetLower(5);
+    grower.SetUpper(10);
+
+    Image2DType::IndexType seed;
+    seed[0] = 10;
+    seed[1] = 10;
+    CPPUNIT_ASSERT(!grower.Grow(seed));
+    CPPUNIT_ASSERT_EQUAL(itk::SizeValueType(0), grower.GetNumberOfPixels());
+    CPPUNIT_ASSERT(grower.GetSpans().empty());
+
+    seed[0] = 0;
+    CPPUNIT_ASSERT_MESSAGE("Seed outside of the buffered region is rejected", !grower.Grow(seed));
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkScanlineRegionGrower)
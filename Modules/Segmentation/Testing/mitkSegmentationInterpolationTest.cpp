@@ -35,6 +35,7 @@ class mitkSegmentationInterpolationTestSuite : public mitk::TestFixture
   MITK_TEST(Equal_Axial_TestInterpolationAndReferenceInterpolation_ReturnsTrue);
   MITK_TEST(Equal_Frontal_TestInterpolationAndReferenceInterpolation_ReturnsTrue);
   MITK_TEST(Equal_Sagittal_TestInterpolationAndReferenceInterpolation_ReturnsTrue);
+  MITK_TEST(Interpolate_AfterChangedRegion_UsesUpdatedSliceCounts);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -203,6 +204,70 @@ public:
     mitk::SliceNavigationController::ViewDirection viewDirection = mitk::SliceNavigationController::Sagittal;
     testRoutine(viewDirection);
   }
+
+  void Interpolate_AfterChangedRegion_UsesUpdatedSliceCounts()
+  {
+    m_InterpolationController->Activate2DInterpolation(true);
+    m_InterpolationController->SetSegmentationVolume(m_SegmentationImage);
+
+    itk::ImageRegion<3> region;
+    for (unsigned int dim = 0; dim < 3; ++dim)
+    {
+      region.SetIndex(dim, m_CenterPoint[dim] - 1);
+      region.SetSize(dim, 3);
+    }
+
+    // same content as in testRoutine, written the way SegTool2D does it
+    CPPUNIT_ASSERT(m_InterpolationController->BeginChangedRegion(region, 0));
+    itk::Index<3> currentPoint = m_CenterPoint;
+    {
+      mitk::ImagePixelWriteAccessor<mitk::Tool::DefaultSegmentationDataType, 3> writeAccessor(m_SegmentationImage);
+      currentPoint[2] = m_CenterPoint[2] - 1;
+      for (int i = -1; i <= 1; ++i)
+      {
+        for (int j = -1; j <= 1; ++j)
+        {
+          currentPoint[0] = m_CenterPoint[0] + i;
+          currentPoint[1] = m_CenterPoint[1] + j;
+          writeAccessor.SetPixelByIndexSafe(currentPoint, 1);
+        }
+      }
+      currentPoint[2] = m_CenterPoint[2] + 1;
+      writeAccessor.SetPixelByIndexSafe(currentPoint, 1);
+    }
+    m_InterpolationController->BlockModified(true);
+    m_SegmentationImage->Modified();
+    m_InterpolationController->BlockModified(false);
+    m_InterpolationController->EndChangedRegion();
+
+    mitk::SliceNavigationController::Pointer navigationController = mitk::SliceNavigationController::New();
+    navigationController->SetInputWorldTimeGeometry(m_SegmentationImage->GetTimeGeometry());
+    navigationController->Update(mitk::SliceNavigationController::Axial);
+    mitk::Point3D pointMM;
+    m_SegmentationImage->GetTimeGeometry()->GetGeometryForTimeStep(0)->IndexToWorld(m_CenterPoint, pointMM);
+    navigationController->SelectSliceByPoint(pointMM);
+    auto plane = navigationController->GetCurrentPlaneGeometry();
+
+    mitk::Image::Pointer interpolationResult = m_InterpolationController->Interpolate(2, m_CenterPoint[2], plane, 0);
+    CPPUNIT_ASSERT_MESSAGE("No interpolation after the region update.", interpolationResult.IsNotNull());
+
+    mitk::Image::Pointer cachedResult = m_InterpolationController->Interpolate(2, m_CenterPoint[2], plane, 0);
+    CPPUNIT_ASSERT_MESSAGE("No cached interpolation.", cachedResult.IsNotNull());
+    CPPUNIT_ASSERT_MESSAGE("Cached interpolation differs.",
+                           mitk::Equal(*interpolationResult, *cachedResult, mitk::eps, true));
+
+    // removing the upper slice leaves nothing to interpolate from
+    CPPUNIT_ASSERT(m_InterpolationController->BeginChangedRegion(region, 0));
+    {
+      mitk::ImagePixelWriteAccessor<mitk::Tool::DefaultSegmentationDataType, 3> writeAccessor(m_SegmentationImage);
+      writeAccessor.SetPixelByIndexSafe(currentPoint, 0);
+    }
+    m_InterpolationController->EndChangedRegion();
+    CPPUNIT_ASSERT_MESSAGE("Interpolation from a removed slice.",
+                           m_InterpolationController->Interpolate(2, m_CenterPoint[2], plane, 0).IsNull());
+
+    m_InterpolationController->Activate2DInterpolation(false);
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkSegmentationInterpolation)
@@ -0,0 +1,367 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkIOUtil.h>
+#include <mitkImage.h>
+#include <mitkInteractionTestHelper.h>
+#include <mitkNodePredicateDataType.h>
+#include <mitkNodePredicateProperty.h>
+#include <mitkToolManager.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+/**
+ * Interaction latency benchmark.
+ *
+ * Loads a scene (or any data IOUtil can read), replays recorded interaction sessions through the
+ * Dispatcher of offscreen render windows and reports the time from each event to the completed
+ * rendering. The sessions are recorded with the InteractionEventRecorder plugin; a segmentation tool
+ * to activate during replay can be appended to the session file name:
+ *
+ * \code
+ *   MitkInteractionLatencyBenchmark --scene=CT512.mitk --out=latency.json
+ *     brush.xml=DrawPaintbrushTool livewire.xml=LiveWireTool2D crosshair.xml scrolling.xml
+ * \endcode
+ *
+ * Sessions without a tool are handled by the display interaction (crosshair, scrolling, zooming).
+ * The tool works on the first segmentation of the scene, or on a new empty segmentation of the first image.
+ * The JSON file uses the Google Benchmark layout with one entry per session and statistic
+ * (e.g. "DrawPaintbrushTool/MouseMoveEvent/p95"), so it can be compared with the usual tools.
+ */
+namespace
+{
+  struct Statistics
+  {
+    std::size_t Count;
+    double Mean;
+    double Median;
+    double P90;
+    double P95;
+    double P99;
+    double Max;
+  };
+
+  struct Session
+  {
+    std::string File;
+    std::string Tool;
+    std::string Name;
+  };
+
+  bool ParseOption(const char *argument, const char *name, std::string &value)
+  {
+    const std::size_t length = std::strlen(name);
+    if (std::strncmp(argument, name, length) != 0 || argument[length] != '=')
+      return false;
+    value = argument + length + 1;
+    return true;
+  }
+
+  std::string EscapeJson(const std::string &text)
+  {
+    std::string result;
+    for (const char c : text)
+    {
+      if (c == '"' || c == '\\')
+        result += '\\';
+      result += c;
+    }
+    return result;
+  }
+
+  /** nearest rank percentile of sorted values */
+  double Percentile(const std::vector<double> &sorted, double percent)
+  {
+    const std::size_t rank = static_cast<std::size_t>(std::ceil(percent / 100.0 * sorted.size()));
+    return sorted[std::min(sorted.size(), std::max<std::size_t>(rank, 1)) - 1];
+  }
+
+  Statistics ComputeStatistics(std::vector<double> values)
+  {
+    std::sort(values.begin(), values.end());
+
+    Statistics statistics;
+    statistics.Count = values.size();
+    double sum = 0;
+    for (const double value : values)
+      sum += value;
+    statistics.Mean = sum / values.size();
+    statistics.Median = Percentile(values, 50);
+    statistics.P90 = Percentile(values, 90);
+    statistics.P95 = Percentile(values, 95);
+    statistics.P99 = Percentile(values, 99);
+    statistics.Max = values.back();
+    return statistics;
+  }
+
+  int GetToolIdByName(mitk::ToolManager *toolManager, const std::string &toolName)
+  {
+    const int numberOfTools = toolManager->GetTools().size();
+    for (int toolId = 0; toolId < numberOfTools; ++toolId)
+    {
+      if (toolName == toolManager->GetToolById(toolId)->GetNameOfClass())
+        return toolId;
+    }
+    return -1;
+  }
+
+  /** Sets working and reference data and activates the tool, creates an empty segmentation if the scene has none */
+  bool ActivateTool(mitk::ToolManager *toolManager, mitk::DataStorage *dataStorage, const std::string &toolName)
+  {
+    const int toolId = GetToolIdByName(toolManager, toolName);
+    mitk::Tool *tool = toolManager->GetToolById(toolId);
+    if (tool == nullptr)
+    {
+      std::cerr << "Unknown segmentation tool " << toolName << std::endl;
+      return false;
+    }
+
+    const auto isSegmentation = mitk::NodePredicateProperty::New("segmentation", mitk::BoolProperty::New(true));
+    const auto isImage = mitk::TNodePredicateDataType<mitk::Image>::New();
+    const auto isHelper = mitk::NodePredicateProperty::New("helper object", mitk::BoolProperty::New(true));
+
+    mitk::DataNode::Pointer referenceNode;
+    mitk::DataNode::Pointer workingNode = dataStorage->GetNode(isSegmentation);
+    const auto images = dataStorage->GetSubset(isImage);
+    for (auto it = images->begin(); it != images->end() && referenceNode.IsNull(); ++it)
+    {
+      if (!isSegmentation->CheckNode(*it) && !isHelper->CheckNode(*it))
+        referenceNode = *it;
+    }
+
+    if (referenceNode.IsNull())
+    {
+      std::cerr << "The scene does not contain an image to segment" << std::endl;
+      return false;
+    }
+
+    if (workingNode.IsNull())
+    {
+      mitk::Color color;
+      color.Set(1, 0, 0);
+      workingNode =
+        tool->CreateEmptySegmentationNode(dynamic_cast<mitk::Image *>(referenceNode->GetData()), "benchmark", color);
+      dataStorage->Add(workingNode);
+    }
+
+    toolManager->SetReferenceData(referenceNode);
+    toolManager->SetWorkingData(workingNode);
+    toolManager->ActivateTool(toolId);
+    return toolManager->GetActiveTool() == tool;
+  }
+
+  void WriteJson(std::ostream &stream, const std::vector<std::pair<std::string, Statistics>> &results)
+  {
+    std::time_t now = std::time(nullptr);
+    char date[64];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    stream << "{\n  \"context\": {\n"
+           << "    \"date\": \"" << date << "\",\n"
+           << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef NDEBUG
+           << "    \"library_build_type\": \"release\"\n"
+#else
+           << "    \"library_build_type\": \"debug\"\n"
+#endif
+           << "  },\n  \"benchmarks\": [";
+
+    bool first = true;
+    for (const auto &result : results)
+    {
+      const std::pair<const char *, double> values[] = {{"mean", result.second.Mean},
+                                                        {"p50", result.second.Median},
+                                                        {"p90", result.second.P90},
+                                                        {"p95", result.second.P95},
+                                                        {"p99", result.second.P99},
+                                                        {"max", result.second.Max}};
+      for (const auto &value : values)
+      {
+        const std::string name = EscapeJson(result.first + "/" + value.first);
+        stream << (first ? "\n" : ",\n") << "    {\n"
+               << "      \"name\": \"" << name << "\",\n"
+               << "      \"run_name\": \"" << EscapeJson(result.first) << "\",\n"
+               << "      \"run_type\": \"aggregate\",\n"
+               << "      \"aggregate_name\": \"" << value.first << "\",\n"
+               << "      \"iterations\": " << result.second.Count << ",\n"
+               << "      \"real_time\": " << std::setprecision(10) << value.second << ",\n"
+               << "      \"cpu_time\": " << value.second << ",\n"
+               << "      \"time_unit\": \"ms\"\n"
+               << "    }";
+        first = false;
+      }
+    }
+    stream << "\n  ]\n}\n";
+  }
+
+  void PrintUsage(const char *executable)
+  {
+    std::cerr << "Usage: " << executable
+              << " --scene=<file> [--out=<file>] [--repetitions=<n>] <session.xml>[=<ToolClassName>] ..." << std::endl;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  std::string sceneFile;
+  std::string outFile;
+  unsigned int repetitions = 1;
+  std::vector<Session> sessions;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string value;
+    if (ParseOption(argv[i], "--scene", value))
+    {
+      sceneFile = value;
+    }
+    else if (ParseOption(argv[i], "--out", value))
+    {
+      outFile = value;
+    }
+    else if (ParseOption(argv[i], "--repetitions", value))
+    {
+      std::istringstream stream(value);
+      if (!(stream >> repetitions) || repetitions == 0)
+      {
+        std::cerr << "Invalid number of repetitions: " << value << std::endl;
+        return 1;
+      }
+    }
+    else if (std::strncmp(argv[i], "--", 2) == 0)
+    {
+      std::cerr << "Unknown option: " << argv[i] << std::endl;
+      PrintUsage(argv[0]);
+      return 1;
+    }
+    else
+    {
+      Session session;
+      session.File = argv[i];
+      const std::size_t separator = session.File.rfind('=');
+      if (separator != std::string::npos)
+      {
+        session.Tool = session.File.substr(separator + 1);
+        session.File = session.File.substr(0, separator);
+      }
+      const std::size_t nameStart = session.File.find_last_of("/\\") + 1;
+      session.Name = session.Tool.empty() ? session.File.substr(nameStart) : session.Tool;
+      sessions.push_back(session);
+    }
+  }
+
+  if (sceneFile.empty() || sessions.empty())
+  {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  std::vector<std::pair<std::string, Statistics>> results;
+  bool failed = false;
+
+  std::cout << std::left << std::setw(50) << "Session" << std::right << std::setw(8) << "Events" << std::setw(10)
+            << "Mean" << std::setw(10) << "p50" << std::setw(10) << "p95" << std::setw(10) << "p99" << std::setw(10)
+            << "Max [ms]" << std::endl;
+
+  for (const Session &session : sessions)
+  {
+    try
+    {
+      // every session starts from the unmodified scene
+      mitk::InteractionTestHelper helper(session.File, true);
+      mitk::IOUtil::Load(sceneFile, *helper.GetDataStorage());
+      helper.Set3dCameraSettings();
+
+      mitk::ToolManager::Pointer toolManager;
+      if (!session.Tool.empty())
+      {
+        toolManager = mitk::ToolManager::New(helper.GetDataStorage());
+        toolManager->InitializeTools();
+        toolManager->RegisterClient();
+        if (!ActivateTool(toolManager, helper.GetDataStorage(), session.Tool))
+        {
+          failed = true;
+          continue;
+        }
+      }
+
+      std::map<std::string, std::vector<double>> latenciesPerClass;
+      std::vector<double> latencies;
+      for (unsigned int repetition = 0; repetition < repetitions; ++repetition)
+      {
+        const auto eventLatencies = helper.PlaybackInteractionAndMeasureLatency();
+        for (const auto &eventLatency : eventLatencies)
+        {
+          latencies.push_back(eventLatency.Milliseconds);
+          latenciesPerClass[eventLatency.EventClass].push_back(eventLatency.Milliseconds);
+        }
+      }
+
+      if (toolManager.IsNotNull())
+      {
+        toolManager->ActivateTool(-1);
+        toolManager->UnregisterClient();
+      }
+
+      if (latencies.empty())
+      {
+        std::cerr << "Session " << session.File << " does not contain any events" << std::endl;
+        failed = true;
+        continue;
+      }
+
+      results.emplace_back(session.Name, ComputeStatistics(latencies));
+      for (const auto &eventClass : latenciesPerClass)
+        results.emplace_back(session.Name + "/" + eventClass.first, ComputeStatistics(eventClass.second));
+    }
+    catch (const std::exception &e)
+    {
+      std::cerr << "Replaying " << session.File << " failed: " << e.what() << std::endl;
+      failed = true;
+    }
+  }
+
+  for (const auto &result : results)
+  {
+    const Statistics &statistics = result.second;
+    std::cout << std::left << std::setw(50) << result.first << std::right << std::setw(8) << statistics.Count
+              << std::fixed << std::setprecision(2) << std::setw(10) << statistics.Mean << std::setw(10)
+              << statistics.Median << std::setw(10) << statistics.P95 << std::setw(10) << statistics.P99
+              << std::setw(10) << statistics.Max << std::endl;
+  }
+
+  if (!outFile.empty())
+  {
+    std::ofstream stream(outFile.c_str());
+    if (!stream)
+    {
+      std::cerr << "Cannot write " << outFile << std::endl;
+      return 1;
+    }
+    WriteJson(stream, results);
+  }
+
+  return failed ? 1 : 0;
+}
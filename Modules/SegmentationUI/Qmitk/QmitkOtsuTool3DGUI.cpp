@@ -50,6 +50,11 @@ void QmitkOtsuTool3DGUI::OnRegionSpinboxChanged(int numberOfRegions)
   int curBinValue = m_Controls.m_BinsSpinBox->value();
   if (curBinValue < numberOfRegions)
     m_Controls.m_BinsSpinBox->setValue(numberOfRegions);
+
+  // once there is a preview, it follows the number of regions, only the thresholds are recomputed on the cached
+  // histogram (the exhaustive search of the valley emphasis is too slow for that)
+  if (m_NumberOfRegions > 0 && !m_Controls.m_ValleyCheckbox->isChecked())
+    this->OnSpinboxValueAccept();
 }
 
 void QmitkOtsuTool3DGUI::OnRegionSelectionChanged()
@@ -139,7 +144,8 @@ void QmitkOtsuTool3DGUI::OnSpinboxValueAccept()
                                                 "The otsu segmentation computation may take several minutes depending "
                                                 "on the number of Regions you selected. Proceed anyway?",
                                                 QMessageBox::Ok | QMessageBox::Cancel);
-      if (m_Controls.m_Spinbox->value() >= 5)
+      // only the valley emphasis searches all combinations of thresholds
+      if (m_Controls.m_Spinbox->value() >= 5 && m_Controls.m_ValleyCheckbox->isChecked())
       {
         proceed = messageBox->exec();
         if (proceed != QMessageBox::Ok)
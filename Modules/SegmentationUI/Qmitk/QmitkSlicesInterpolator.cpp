@@ -1069,7 +1069,10 @@ void QmitkSlicesInterpolator::OnInterpolationActivated(bool on)
 
 void QmitkSlicesInterpolator::Run3DInterpolation()
 {
-  m_SurfaceInterpolator->Interpolate();
+  // The controller cancels a running interpolation itself, so there is no need to wait for it here.
+  // The task does not reference this widget, superseded runs may therefore finish after its destruction.
+  m_Future = QtConcurrent::run(m_SurfaceInterpolator.GetPointer(), &mitk::SurfaceInterpolationController::Interpolate);
+  m_Watcher.setFuture(m_Future);
 }
 
 void QmitkSlicesInterpolator::StartUpdateInterpolationTimer()
@@ -1146,13 +1149,9 @@ void QmitkSlicesInterpolator::On3DInterpolationActivated(bool on)
             ret = msgBox.exec();
           }
 
-          if (m_Watcher.isRunning())
-            m_Watcher.waitForFinished();
-
           if (ret == QMessageBox::Yes)
           {
-            m_Future = QtConcurrent::run(this, &QmitkSlicesInterpolator::Run3DInterpolation);
-            m_Watcher.setFuture(m_Future);
+            this->Run3DInterpolation();
           }
           else
           {
@@ -1215,10 +1214,7 @@ void QmitkSlicesInterpolator::OnSurfaceInterpolationInfoChanged(const itk::Event
 {
   if (m_3DInterpolationEnabled)
   {
-    if (m_Watcher.isRunning())
-      m_Watcher.waitForFinished();
-    m_Future = QtConcurrent::run(this, &QmitkSlicesInterpolator::Run3DInterpolation);
-    m_Watcher.setFuture(m_Future);
+    this->Run3DInterpolation();
   }
 }
 
@@ -1275,10 +1271,7 @@ void QmitkSlicesInterpolator::SetCurrentContourListID()
 
         if (m_3DInterpolationEnabled)
         {
-          if (m_Watcher.isRunning())
-            m_Watcher.waitForFinished();
-          m_Future = QtConcurrent::run(this, &QmitkSlicesInterpolator::Run3DInterpolation);
-          m_Watcher.setFuture(m_Future);
+          this->Run3DInterpolation();
         }
       }
     }
@@ -1335,6 +1328,7 @@ void QmitkSlicesInterpolator::WaitForFutures()
 {
   if (m_Watcher.isRunning())
   {
+    m_SurfaceInterpolator->CancelInterpolation();
     m_Watcher.waitForFinished();
   }
 
@@ -18,9 +18,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkCreateDistanceImageFromSurfaceFilter.h>
 #include <mitkIOUtil.h>
 #include <mitkImageAccessByItk.h>
+#include <mitkImageCast.h>
 #include <mitkTestFixture.h>
 #include <mitkTestingMacros.h>
 
+#include <itkImageRegionConstIterator.h>
+
 #include <vtkDebugLeaks.h>
 
 class mitkCreateDistanceImageFromSurfaceFilterTestSuite : public mitk::TestFixture
@@ -29,6 +32,7 @@ class mitkCreateDistanceImageFromSurfaceFilterTestSuite : public mitk::TestFixtu
   vtkDebugLeaks::SetExitError(0);
   MITK_TEST(TestCreateDistanceImageForLiver);
   MITK_TEST(TestCreateDistanceImageForTube);
+  MITK_TEST(TestCompactlySupportedRBFMatchesDenseRBF);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -131,6 +135,72 @@ public:
     CPPUNIT_ASSERT_MESSAGE("HolesDistanceImages are not equal!",
                            mitk::Equal(*(holesDistanceImageReference), *(holeDistanceImage), 0.0001, true));
   }
+
+  // The two-level interpolation has to separate inside and outside like the dense one
+  void TestCompactlySupportedRBFMatchesDenseRBF()
+  {
+    unsigned int NUMBER_OF_LIVER_CONTOURS = 18;
+
+    for (unsigned int i = 0; i <= NUMBER_OF_LIVER_CONTOURS; ++i)
+    {
+      std::stringstream s;
+      s << "SurfaceInterpolation/InterpolateLiver/LiverContourWithNormals_";
+      s << i;
+      s << ".vtk";
+      mitk::Surface::Pointer contour = mitk::IOUtil::Load<mitk::Surface>(GetTestDataFilePath(s.str()));
+      contourList.push_back(contour);
+    }
+
+    mitk::Image::Pointer segmentationImage =
+      mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("SurfaceInterpolation/Reference/LiverSegmentation.nrrd"));
+
+    itk::ImageBase<3>::Pointer itkImage = itk::ImageBase<3>::New();
+    AccessFixedDimensionByItk_1(segmentationImage, GetImageBase, 3, itkImage);
+
+    mitk::ComputeContourSetNormalsFilter::Pointer normalsFilter = mitk::ComputeContourSetNormalsFilter::New();
+    mitk::CreateDistanceImageFromSurfaceFilter::Pointer denseFilter = mitk::CreateDistanceImageFromSurfaceFilter::New();
+    mitk::CreateDistanceImageFromSurfaceFilter::Pointer compactFilter =
+      mitk::CreateDistanceImageFromSurfaceFilter::New();
+    denseFilter->SetReferenceImage(itkImage.GetPointer());
+    compactFilter->SetReferenceImage(itkImage.GetPointer());
+    compactFilter->UseCompactlySupportedRBFOn();
+    compactFilter->SetMaximumNumberOfDenseCenters(300);
+
+    for (unsigned int j = 0; j < contourList.size(); j++)
+    {
+      normalsFilter->SetInput(j, contourList.at(j));
+      denseFilter->SetInput(j, normalsFilter->GetOutput(j));
+      compactFilter->SetInput(j, normalsFilter->GetOutput(j));
+    }
+
+    denseFilter->Update();
+    compactFilter->Update();
+
+    typedef mitk::CreateDistanceImageFromSurfaceFilter::DistanceImageType DistanceImageType;
+    DistanceImageType::Pointer denseDistanceImage;
+    DistanceImageType::Pointer compactDistanceImage;
+    mitk::CastToItkImage(denseFilter->GetOutput(), denseDistanceImage);
+    mitk::CastToItkImage(compactFilter->GetOutput(), compactDistanceImage);
+
+    CPPUNIT_ASSERT_MESSAGE("Distance images differ in size!",
+                           denseDistanceImage->GetLargestPossibleRegion() ==
+                             compactDistanceImage->GetLargestPossibleRegion());
+
+    itk::ImageRegionConstIterator<DistanceImageType> denseIt(denseDistanceImage,
+                                                             denseDistanceImage->GetLargestPossibleRegion());
+    itk::ImageRegionConstIterator<DistanceImageType> compactIt(compactDistanceImage,
+                                                               compactDistanceImage->GetLargestPossibleRegion());
+    unsigned int numberOfPixels(0);
+    unsigned int numberOfDifferentSigns(0);
+    for (; !denseIt.IsAtEnd(); ++denseIt, ++compactIt, ++numberOfPixels)
+    {
+      if ((denseIt.Get() < 0) != (compactIt.Get() < 0))
+        ++numberOfDifferentSigns;
+    }
+
+    CPPUNIT_ASSERT_MESSAGE("Inside and outside of the interpolations differ!",
+                           numberOfDifferentSigns < 0.01 * numberOfPixels);
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkCreateDistanceImageFromSurfaceFilter)
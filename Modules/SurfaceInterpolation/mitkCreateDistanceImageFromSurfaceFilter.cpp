@@ -26,7 +26,42 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkImageRegionIteratorWithIndex.h"
 #include "itkNeighborhoodIterator.h"
 
+#include <Eigen/Sparse>
+
+#include <array>
+#include <limits>
 #include <queue>
+#include <set>
+
+namespace
+{
+  // Evaluates the RBF Phi(r) = r for the given centers and weights
+  double EvaluateDenseRBF(const mitk::CreateDistanceImageFromSurfaceFilter::CenterList &centers,
+                          const Eigen::VectorXd &weights,
+                          const mitk::CreateDistanceImageFromSurfaceFilter::PointType &p)
+  {
+    double distanceValue(0);
+    for (unsigned int i = 0; i < centers.size(); ++i)
+    {
+      distanceValue += (p - centers[i]).two_norm() * weights[i];
+    }
+    return distanceValue;
+  }
+
+  // Wendland's C2 function, positive definite in 3D and zero outside of the support radius
+  double WendlandC2(double r, double supportRadius)
+  {
+    const double q = r / supportRadius;
+    if (q >= 1.0)
+      return 0.0;
+
+    const double oneMinusQ = 1.0 - q;
+    return oneMinusQ * oneMinusQ * oneMinusQ * oneMinusQ * (4.0 * q + 1.0);
+  }
+
+  const unsigned int MaximumNumberOfSolverIterations = 2000;
+  const double SolverTolerance = 1e-5;
+}
 
 void mitk::CreateDistanceImageFromSurfaceFilter::CreateEmptyDistanceImage()
 {
@@ -111,6 +146,10 @@ void mitk::CreateDistanceImageFromSurfaceFilter::CreateEmptyDistanceImage()
 mitk::CreateDistanceImageFromSurfaceFilter::CreateDistanceImageFromSurfaceFilter()
 {
   m_DistanceImageVolume = 50000;
+  m_UseCompactlySupportedRBF = false;
+  m_SupportRadius = 0.0;
+  m_MaximumNumberOfDenseCenters = 1500;
+  m_CurrentSupportRadius = 0.0;
   this->m_UseProgressBar = false;
   this->m_ProgressStepSize = 5;
 
@@ -133,19 +172,29 @@ void mitk::CreateDistanceImageFromSurfaceFilter::GenerateData()
   if (this->m_UseProgressBar)
     mitk::ProgressBar::GetInstance()->Progress(1);
 
-  m_Weights = m_SolutionMatrix.partialPivLu().solve(m_FunctionValues);
+  // Solving the equation system cannot be interrupted, so check for an abort before
+  if (!this->GetAbortGenerateData())
+  {
+    if (this->IsTwoLevelInterpolation())
+      this->SolveTwoLevelSystem();
+    else
+      m_Weights = m_SolutionMatrix.partialPivLu().solve(m_FunctionValues);
+  }
 
   if (this->m_UseProgressBar)
     mitk::ProgressBar::GetInstance()->Progress(2);
 
   // The last step is to create the distance map with the interpolated distance function
-  this->FillDistanceImage();
+  if (!this->GetAbortGenerateData())
+    this->FillDistanceImage();
 
   if (this->m_UseProgressBar)
     mitk::ProgressBar::GetInstance()->Progress(2);
 
   m_Centers.clear();
   m_Normals.clear();
+  m_CoarseCenters.clear();
+  m_CenterBuckets.clear();
 }
 
 void mitk::CreateDistanceImageFromSurfaceFilter::PreprocessContourPoints()
@@ -171,6 +220,8 @@ void mitk::CreateDistanceImageFromSurfaceFilter::PreprocessContourPoints()
   PointType currentPoint;
   PointType normal;
 
+  std::set<std::array<double, 3>> existingCenters;
+
   for (unsigned int i = 0; i < numberOfInputs; i++)
   {
     auto currentSurface = this->GetInput(i);
@@ -202,9 +253,7 @@ void mitk::CreateDistanceImageFromSurfaceFilter::PreprocessContourPoints()
 
         currentPoint.copy_in(p);
 
-        int count = std::count(m_Centers.begin(), m_Centers.end(), currentPoint);
-
-        if (count == 0)
+        if (existingCenters.insert({{p[0], p[1], p[2]}}).second)
         {
           double currentNormal[3];
           currentCellNormals->GetTuple(cell[j], currentNormal);
@@ -267,15 +316,22 @@ void mitk::CreateDistanceImageFromSurfaceFilter::CreateSolutionMatrixAndFunction
   // Now we have created all centers and all function values. Next step is to create the solution matrix
   numberOfCenters = m_Centers.size();
 
-  m_SolutionMatrix.resize(numberOfCenters, numberOfCenters);
-
   m_Weights.resize(numberOfCenters);
 
+  // The two-level interpolation sets up its own equation systems
+  if (this->IsTwoLevelInterpolation())
+  {
+    m_SolutionMatrix.resize(0, 0);
+    return;
+  }
+
+  m_SolutionMatrix.resize(numberOfCenters, numberOfCenters);
+
   PointType p1;
   PointType p2;
   double norm;
 
-  for (unsigned int i = 0; i < numberOfCenters; i++)
+  for (unsigned int i = 0; i < numberOfCenters && !this->GetAbortGenerateData(); i++)
   {
     for (unsigned int j = 0; j < numberOfCenters; j++)
     {
@@ -333,6 +389,9 @@ void mitk::CreateDistanceImageFromSurfaceFilter::FillDistanceImage()
   bool isInBounds = false;
   while (!narrowbandPoints.empty())
   {
+    if (this->GetAbortGenerateData())
+      return;
+
     nIt.SetLocation(narrowbandPoints.front());
     narrowbandPoints.pop();
 
@@ -424,25 +483,208 @@ void mitk::CreateDistanceImageFromSurfaceFilter::FillDistanceImage()
 
 double mitk::CreateDistanceImageFromSurfaceFilter::CalculateDistanceValue(PointType p)
 {
-  double distanceValue(0);
-  PointType p1;
-  PointType p2;
-  double norm;
+  if (this->IsTwoLevelInterpolation())
+    return EvaluateDenseRBF(m_CoarseCenters, m_CoarseWeights, p) + this->CalculateCompactlySupportedValue(p);
+
+  return EvaluateDenseRBF(m_Centers, m_Weights, p);
+}
 
-  CenterList::iterator centerIter;
+bool mitk::CreateDistanceImageFromSurfaceFilter::IsTwoLevelInterpolation() const
+{
+  return m_UseCompactlySupportedRBF && m_Centers.size() > m_MaximumNumberOfDenseCenters;
+}
 
-  unsigned int count(0);
-  for (centerIter = m_Centers.begin(); centerIter != m_Centers.end(); centerIter++)
+void mitk::CreateDistanceImageFromSurfaceFilter::FillCenterBuckets()
+{
+  m_BucketOrigin = m_Centers.at(0);
+  for (const auto &center : m_Centers)
   {
-    p1 = *centerIter;
-    p2 = p - p1;
-    norm = p2.two_norm();
-    distanceValue = distanceValue + (norm * m_Weights[count]);
-    ++count;
+    for (unsigned int dim = 0; dim < 3; ++dim)
+      m_BucketOrigin[dim] = std::min(m_BucketOrigin[dim], center[dim]);
   }
+
+  m_CenterBuckets.clear();
+  for (unsigned int i = 0; i < m_Centers.size(); ++i)
+  {
+    m_CenterBuckets[this->GetBucketKey(m_Centers[i])].push_back(i);
+  }
+}
+
+long long mitk::CreateDistanceImageFromSurfaceFilter::GetBucketKey(const PointType &p,
+                                                                  int offsetX,
+                                                                  int offsetY,
+                                                                  int offsetZ) const
+{
+  // Each bucket coordinate occupies 21 bits and is shifted to be positive around the bounding box of the centers
+  const long long bucketCoordinateOffset = 1 << 20;
+  const long long maximumBucketCoordinate = (1 << 21) - 1;
+  const int offsets[3] = {offsetX, offsetY, offsetZ};
+
+  long long key(0);
+  for (unsigned int dim = 0; dim < 3; ++dim)
+  {
+    long long bucketCoordinate =
+      static_cast<long long>(std::floor((p[dim] - m_BucketOrigin[dim]) / m_CurrentSupportRadius)) + offsets[dim] +
+      bucketCoordinateOffset;
+    bucketCoordinate = std::min(std::max(bucketCoordinate, 0LL), maximumBucketCoordinate);
+    key = (key << 21) | bucketCoordinate;
+  }
+  return key;
+}
+
+template <typename TFunctor>
+void mitk::CreateDistanceImageFromSurfaceFilter::VisitCentersInSupport(const PointType &p, TFunctor functor) const
+{
+  // As the buckets have the size of the support radius, all centers within the support lie in the neighboring buckets
+  for (int offsetZ = -1; offsetZ <= 1; ++offsetZ)
+  {
+    for (int offsetY = -1; offsetY <= 1; ++offsetY)
+    {
+      for (int offsetX = -1; offsetX <= 1; ++offsetX)
+      {
+        auto bucket = m_CenterBuckets.find(this->GetBucketKey(p, offsetX, offsetY, offsetZ));
+        if (bucket == m_CenterBuckets.end())
+          continue;
+
+        for (unsigned int index : bucket->second)
+        {
+          const double r = (p - m_Centers[index]).two_norm();
+          if (r < m_CurrentSupportRadius)
+            functor(index, WendlandC2(r, m_CurrentSupportRadius));
+        }
+      }
+    }
+  }
+}
+
+double mitk::CreateDistanceImageFromSurfaceFilter::CalculateCompactlySupportedValue(const PointType &p) const
+{
+  double distanceValue(0);
+  this->VisitCentersInSupport(p, [&](unsigned int index, double phi) { distanceValue += phi * m_Weights[index]; });
   return distanceValue;
 }
 
+void mitk::CreateDistanceImageFromSurfaceFilter::SolveTwoLevelSystem()
+{
+  // The centers consist of the surface points followed by all inner and all outer points
+  const unsigned int numberOfCenters = m_Centers.size();
+  const unsigned int numberOfSurfaceCenters = numberOfCenters / 3;
+  const unsigned int step = std::max(
+    1u, static_cast<unsigned int>(std::ceil(numberOfCenters / static_cast<double>(m_MaximumNumberOfDenseCenters))));
+
+  // Coarse level: every n-th surface point together with its inner and outer point is interpolated densely
+  std::vector<unsigned int> coarseIndices;
+  for (unsigned int i = 0; i < numberOfSurfaceCenters; i += step)
+  {
+    coarseIndices.push_back(i);
+    coarseIndices.push_back(numberOfSurfaceCenters + i);
+    coarseIndices.push_back(numberOfSurfaceCenters * 2 + i);
+  }
+
+  const unsigned int numberOfCoarseCenters = coarseIndices.size();
+  m_CoarseCenters.clear();
+  Eigen::VectorXd coarseFunctionValues(numberOfCoarseCenters);
+  for (unsigned int i = 0; i < numberOfCoarseCenters; ++i)
+  {
+    m_CoarseCenters.push_back(m_Centers[coarseIndices[i]]);
+    coarseFunctionValues[i] = m_FunctionValues[coarseIndices[i]];
+  }
+
+  Eigen::MatrixXd coarseSolutionMatrix(numberOfCoarseCenters, numberOfCoarseCenters);
+  for (unsigned int i = 0; i < numberOfCoarseCenters; ++i)
+  {
+    for (unsigned int j = 0; j < numberOfCoarseCenters; ++j)
+    {
+      coarseSolutionMatrix(i, j) = (m_CoarseCenters[i] - m_CoarseCenters[j]).two_norm();
+    }
+  }
+  m_CoarseWeights = coarseSolutionMatrix.partialPivLu().solve(coarseFunctionValues);
+  m_Weights.setZero(numberOfCenters);
+
+  if (this->GetAbortGenerateData())
+    return;
+
+  // If no support radius is set, use twice the mean distance between neighboring surface points of the coarse level
+  m_CurrentSupportRadius = m_SupportRadius;
+  if (m_CurrentSupportRadius <= 0.0)
+  {
+    double sumOfDistances(0.0);
+    unsigned int numberOfDistances(0);
+    for (unsigned int i = 0; i < numberOfCoarseCenters; i += 3)
+    {
+      double nearestDistance = std::numeric_limits<double>::max();
+      for (unsigned int j = 0; j < numberOfCoarseCenters; j += 3)
+      {
+        if (i != j)
+          nearestDistance = std::min(nearestDistance, (m_CoarseCenters[i] - m_CoarseCenters[j]).two_norm());
+      }
+
+      if (nearestDistance < std::numeric_limits<double>::max())
+      {
+        sumOfDistances += nearestDistance;
+        ++numberOfDistances;
+      }
+    }
+
+    if (numberOfDistances > 0)
+      m_CurrentSupportRadius = 2.0 * sumOfDistances / numberOfDistances;
+  }
+
+  // The inner and outer points have to lie within the support of their surface point
+  m_CurrentSupportRadius = std::max(m_CurrentSupportRadius, 3.0 * m_DistanceImageSpacing);
+  if (m_CurrentSupportRadius <= 0.0)
+    return;
+
+  this->FillCenterBuckets();
+
+  // Fine level: the residual of the coarse level is interpolated with the compactly supported RBFs
+  Eigen::VectorXd residuals(numberOfCenters);
+  std::vector<Eigen::Triplet<double>> triplets;
+  for (unsigned int i = 0; i < numberOfCenters; ++i)
+  {
+    if (this->GetAbortGenerateData())
+      return;
+
+    residuals[i] = m_FunctionValues[i] - EvaluateDenseRBF(m_CoarseCenters, m_CoarseWeights, m_Centers[i]);
+    this->VisitCentersInSupport(
+      m_Centers[i], [&](unsigned int j, double phi) { triplets.push_back(Eigen::Triplet<double>(i, j, phi)); });
+  }
+
+  Eigen::SparseMatrix<double> solutionMatrix(numberOfCenters, numberOfCenters);
+  solutionMatrix.setFromTriplets(triplets.begin(), triplets.end());
+  triplets.clear();
+  triplets.shrink_to_fit();
+
+  // Conjugate gradients, the matrix is positive definite. As its diagonal is one, no preconditioning is applied.
+  // Implemented here to be able to react on an abort in every iteration.
+  Eigen::VectorXd residual = residuals;
+  Eigen::VectorXd direction = residuals;
+  double squaredResidualNorm = residual.squaredNorm();
+  const double threshold = SolverTolerance * SolverTolerance * squaredResidualNorm;
+
+  unsigned int numberOfIterations(0);
+  for (; numberOfIterations < MaximumNumberOfSolverIterations && squaredResidualNorm > threshold; ++numberOfIterations)
+  {
+    if (this->GetAbortGenerateData())
+      return;
+
+    const Eigen::VectorXd matrixTimesDirection = solutionMatrix * direction;
+    const double alpha = squaredResidualNorm / direction.dot(matrixTimesDirection);
+    m_Weights += alpha * direction;
+    residual -= alpha * matrixTimesDirection;
+
+    const double newSquaredResidualNorm = residual.squaredNorm();
+    direction = residual + (newSquaredResidualNorm / squaredResidualNorm) * direction;
+    squaredResidualNorm = newSquaredResidualNorm;
+  }
+
+  if (squaredResidualNorm > threshold)
+  {
+    MITK_WARN << "mitk::CreateDistanceImageFromSurfaceFilter: Compactly supported interpolation did not converge "
+              << "within " << numberOfIterations << " iterations";
+  }
+}
+
 void mitk::CreateDistanceImageFromSurfaceFilter::GenerateOutputInformation()
 {
 }
@@ -29,6 +29,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <Eigen/Dense>
 
+#include <unordered_map>
+
 namespace mitk
 {
   /**
@@ -61,6 +63,14 @@ namespace mitk
          adjusted by calling SetDistanceImageVolume(unsigned int volume) which specifies the number ob pixels enclosed
   by the image.
 
+         Solving the dense equation system grows cubically with the number of contour points. For large contour sets
+         SetUseCompactlySupportedRBF(true) switches to a two-level interpolation: A dense interpolation of a subset of
+         the points is corrected by a compactly supported RBF interpolation of all points, which yields a sparse
+         equation system and only needs the nearby points for evaluating a pixel.
+
+         A running update can be aborted via AbortGenerateDataOn() from another thread. The output is
+         undefined then.
+
   \ingroup Process
 
   $Author: fetzer$
@@ -103,6 +113,28 @@ namespace mitk
     */
     itkSetMacro(DistanceImageVolume, unsigned int);
 
+    /**
+    \brief Use the two-level interpolation with compactly supported RBFs (Wendland's C2 function) if there are more
+           centers than MaximumNumberOfDenseCenters. Otherwise the equation system is solved densely. Default is false.
+    */
+    itkSetMacro(UseCompactlySupportedRBF, bool);
+    itkGetMacro(UseCompactlySupportedRBF, bool);
+    itkBooleanMacro(UseCompactlySupportedRBF);
+
+    /**
+    \brief Set the support radius of the compactly supported RBFs in mm.
+           If none is set, it is derived from the distance of the centers of the coarse level.
+    */
+    itkSetMacro(SupportRadius, double);
+    itkGetMacro(SupportRadius, double);
+
+    /**
+    \brief Set the maximum number of centers solved densely, i.e. the size of the coarse level of the two-level
+           interpolation. If none is set, 1500 centers are used.
+    */
+    itkSetMacro(MaximumNumberOfDenseCenters, unsigned int);
+    itkGetMacro(MaximumNumberOfDenseCenters, unsigned int);
+
     void PrintEquationSystem();
 
     // Resets the filter, i.e. removes all inputs and outputs
@@ -134,6 +166,26 @@ namespace mitk
     void CreateSolutionMatrixAndFunctionValues();
     double CalculateDistanceValue(PointType p);
 
+    bool IsTwoLevelInterpolation() const;
+
+    /**
+    * \brief Solves the two-level interpolation.
+    *
+    * Every n-th center together with its inner and outer point is interpolated densely. The residual of all
+    * centers is then interpolated with compactly supported RBFs, whose sparse equation system is solved with
+    * conjugate gradients. The centers are sorted into buckets with the size of the support radius, so only
+    * the neighboring buckets have to be visited for finding the centers within the support of a point.
+    */
+    void SolveTwoLevelSystem();
+
+    void FillCenterBuckets();
+    long long GetBucketKey(const PointType &p, int offsetX = 0, int offsetY = 0, int offsetZ = 0) const;
+
+    template <typename TFunctor>
+    void VisitCentersInSupport(const PointType &p, TFunctor functor) const;
+
+    double CalculateCompactlySupportedValue(const PointType &p) const;
+
     void FillDistanceImage();
 
     /**
@@ -166,6 +218,13 @@ namespace mitk
     Eigen::VectorXd m_FunctionValues;
     Eigen::VectorXd m_Weights;
 
+    // Coarse level of the two-level interpolation, m_Weights then holds the compactly supported weights
+    CenterList m_CoarseCenters;
+    Eigen::VectorXd m_CoarseWeights;
+    std::unordered_map<long long, std::vector<unsigned int>> m_CenterBuckets;
+    PointType m_BucketOrigin;
+    double m_CurrentSupportRadius;
+
     DistanceImageType::Pointer m_DistanceImageITK;
     itk::ImageBase<3>::Pointer m_ReferenceImage;
 
@@ -173,6 +232,10 @@ namespace mitk
     double m_DistanceImageDefaultBufferValue;
     unsigned int m_DistanceImageVolume;
 
+    bool m_UseCompactlySupportedRBF;
+    double m_SupportRadius;
+    unsigned int m_MaximumNumberOfDenseCenters;
+
     bool m_UseProgressBar;
     unsigned int m_ProgressStepSize;
   };
@@ -18,8 +18,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <cmath>
 
+#include <mitkPointLocator.h>
+
 #include <vtkDoubleArray.h>
-#include <vtkKdTree.h>
 #include <vtkPointData.h>
 #include <vtkPoints.h>
 #include <vtkPolyVertex.h>
@@ -61,42 +62,28 @@ void mitk::PointCloudScoringFilter::GenerateData()
   vtkSmartPointer<vtkUnstructuredGrid> edgevtkGrid = edgeGrid->GetVtkUnstructuredGrid();
   vtkSmartPointer<vtkUnstructuredGrid> segmvtkGrid = segmGrid->GetVtkUnstructuredGrid();
 
-  // KdTree from here
-  vtkSmartPointer<vtkPoints> kdPoints = vtkSmartPointer<vtkPoints>::New();
-  vtkSmartPointer<vtkKdTree> kdTree = vtkSmartPointer<vtkKdTree>::New();
-
-  for (int i = 0; i < edgevtkGrid->GetNumberOfPoints(); i++)
-  {
-    kdPoints->InsertNextPoint(edgevtkGrid->GetPoint(i));
-  }
-
-  kdTree->BuildLocatorFromPoints(kdPoints);
-  // KdTree until here
+  mitk::PointLocator::Pointer locator = mitk::PointLocator::New();
+  locator->SetPoints(edgevtkGrid);
 
-  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  vtkPoints *points = segmvtkGrid->GetPoints();
 
-  for (int i = 0; i < segmvtkGrid->GetNumberOfPoints(); i++)
-  {
-    points->InsertNextPoint(segmvtkGrid->GetPoint(i));
-  }
+  // all query points at once, the locator searches them in parallel
+  mitk::PointLocator::IdVectorType closestIds;
+  mitk::PointLocator::DistanceVectorType distances;
+  locator->FindClosestPoints(points, closestIds, distances);
 
   std::vector<ScorePair> score;
-  std::vector<double> distances;
+  score.reserve(distances.size());
 
   double dist_glob = 0.0;
-  double dist = 0.0;
 
-  for (int i = 0; i < points->GetNumberOfPoints(); i++)
+  for (unsigned int i = 0; i < distances.size(); i++)
   {
-    double point[3];
-    points->GetPoint(i, point);
-    kdTree->FindClosestPoint(point[0], point[1], point[2], dist);
-    dist_glob += dist;
-    distances.push_back(dist);
-    score.push_back(std::make_pair(i, dist));
+    dist_glob += distances[i];
+    score.push_back(std::make_pair(i, distances[i]));
   }
 
-  double avg = dist_glob / points->GetNumberOfPoints();
+  double avg = dist_glob / distances.size();
 
   double tmpVar = 0.0;
   double highest = 0.0;
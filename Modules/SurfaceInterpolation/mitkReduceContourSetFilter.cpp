@@ -27,6 +27,7 @@ mitk::ReduceContourSetFilter::ReduceContourSetFilter()
   this->m_UseProgressBar = false;
   this->m_ProgressStepSize = 1;
   m_NumberOfPointsAfterReduction = 0;
+  m_NumberOfInputsToReduce = 0;
 
   mitk::Surface::Pointer output = mitk::Surface::New();
   this->SetNthOutput(0, output.GetPointer());
@@ -50,6 +51,8 @@ void mitk::ReduceContourSetFilter::SetInput(const mitk::Surface *surface)
 void mitk::ReduceContourSetFilter::GenerateData()
 {
   unsigned int numberOfInputs = this->GetNumberOfIndexedInputs();
+  if (m_NumberOfInputsToReduce > 0 && m_NumberOfInputsToReduce < numberOfInputs)
+    numberOfInputs = m_NumberOfInputsToReduce;
   unsigned int numberOfOutputs(0);
 
   vtkSmartPointer<vtkPolyData> newPolyData;
@@ -79,6 +79,12 @@ namespace mitk
 
     itkGetMacro(NumberOfPointsAfterReduction, unsigned int);
 
+    /**
+      \brief Restricts the reduction to the first n inputs. The remaining inputs are only considered
+             when checking for intersections. By default (0) all inputs are reduced.
+    */
+    itkSetMacro(NumberOfInputsToReduce, unsigned int);
+
     // Resets the filter, i.e. removes all inputs and outputs
     void Reset();
 
@@ -132,6 +138,8 @@ namespace mitk
 
     unsigned int m_NumberOfPointsAfterReduction;
 
+    unsigned int m_NumberOfInputsToReduce;
+
   }; // class
 
 } // namespace
@@ -23,6 +23,17 @@ See LICENSE.txt or http://www.mitk.org for details.
 //#include "vtkXMLPolyDataWriter.h"
 #include "vtkPolyDataWriter.h"
 
+// Check whether the normals of the given contours are parallel
+bool ContoursParallel(const mitk::SurfaceInterpolationController::ContourPositionInformation &leftHandSide,
+                      const mitk::SurfaceInterpolationController::ContourPositionInformation &rightHandSide)
+{
+  // The normals of both contours have to be parallel but not of the same orientation
+  double lengthLHS = leftHandSide.contourNormal.GetNorm();
+  double lengthRHS = rightHandSide.contourNormal.GetNorm();
+  double dot = leftHandSide.contourNormal * rightHandSide.contourNormal;
+  return mitk::Equal(fabs(lengthLHS * lengthRHS), fabs(dot), 0.001);
+}
+
 // Check whether the given contours are coplanar
 bool ContoursCoplanar(mitk::SurfaceInterpolationController::ContourPositionInformation leftHandSide,
                       mitk::SurfaceInterpolationController::ContourPositionInformation rightHandSide)
@@ -46,18 +57,7 @@ bool ContoursCoplanar(mitk::SurfaceInterpolationController::ContourPositionInfor
   n[2] = rightHandSide.contourNormal[2];
   double dot = vtkMath::Dot(n, vec);
 
-  double n2[3];
-  n2[0] = leftHandSide.contourNormal[0];
-  n2[1] = leftHandSide.contourNormal[1];
-  n2[2] = leftHandSide.contourNormal[2];
-
-  // The normals of both contours have to be parallel but not of the same orientation
-  double lengthLHS = leftHandSide.contourNormal.GetNorm();
-  double lengthRHS = rightHandSide.contourNormal.GetNorm();
-  double dot2 = vtkMath::Dot(n, n2);
-  bool contoursParallel = mitk::Equal(fabs(lengthLHS * lengthRHS), fabs(dot2), 0.001);
-
-  if (mitk::Equal(dot, 0.0, 0.001) && contoursParallel)
+  if (mitk::Equal(dot, 0.0, 0.001) && ContoursParallel(leftHandSide, rightHandSide))
     return true;
   else
     return false;
@@ -78,20 +78,15 @@ mitk::SurfaceInterpolationController::ContourPositionInformation CreateContourPo
 }
 
 mitk::SurfaceInterpolationController::SurfaceInterpolationController()
-  : m_SelectedSegmentation(nullptr), m_CurrentTimeStep(0)
+  : m_MinSpacing(-1.0),
+    m_MaxSpacing(-1.0),
+    m_DistanceImageVolume(50000),
+    m_InterpolationCounter(0),
+    m_ContourListModifiedCounter(0),
+    m_SelectedSegmentation(nullptr),
+    m_CurrentTimeStep(0)
 {
   m_DistanceImageSpacing = 0.0;
-  m_ReduceFilter = ReduceContourSetFilter::New();
-  m_NormalsFilter = ComputeContourSetNormalsFilter::New();
-  m_InterpolateSurfaceFilter = CreateDistanceImageFromSurfaceFilter::New();
-  // m_TimeSelector = ImageTimeSelector::New();
-
-  m_ReduceFilter->SetUseProgressBar(false);
-  //  m_ReduceFilter->SetProgressStepSize(1);
-  m_NormalsFilter->SetUseProgressBar(true);
-  m_NormalsFilter->SetProgressStepSize(1);
-  m_InterpolateSurfaceFilter->SetUseProgressBar(true);
-  m_InterpolateSurfaceFilter->SetProgressStepSize(7);
 
   m_Contours = Surface::New();
 
@@ -105,6 +100,10 @@ mitk::SurfaceInterpolationController::SurfaceInterpolationController()
 
 mitk::SurfaceInterpolationController::~SurfaceInterpolationController()
 {
+  // Wait for a running interpolation to return
+  this->CancelInterpolation();
+  std::lock_guard<std::mutex> interpolationLock(m_InterpolationMutex);
+
   // Removing all observers
   auto dataIter = m_SegmentationObserverTags.begin();
   for (; dataIter != m_SegmentationObserverTags.end(); ++dataIter)
@@ -151,6 +150,15 @@ void mitk::SurfaceInterpolationController::AddNewContours(std::vector<mitk::Surf
 
 void mitk::SurfaceInterpolationController::AddToInterpolationPipeline(ContourPositionInformation contourInfo)
 {
+  mitk::Surface *newContour = contourInfo.contour;
+  if (newContour->GetVtkPolyData()->GetNumberOfPoints() == 0)
+  {
+    this->RemoveContour(contourInfo);
+    return;
+  }
+
+  std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
+
   if (!m_SelectedSegmentation)
   {
     return;
@@ -164,68 +172,85 @@ void mitk::SurfaceInterpolationController::AddToInterpolationPipeline(ContourPos
     return;
   }
 
-  ContourPositionInformationVec2D currentContours = m_ListOfInterpolationSessions[m_SelectedSegmentation];
-  ContourPositionInformationList currentContourList = currentContours[m_CurrentTimeStep];
+  ContourPositionInformationList &currentContourList =
+    m_ListOfInterpolationSessions[m_SelectedSegmentation][m_CurrentTimeStep];
 
-  mitk::Surface *newContour = contourInfo.contour;
   for (unsigned int i = 0; i < currentContourList.size(); i++)
   {
-    ContourPositionInformation contourFromList = currentContourList.at(i);
-    if (ContoursCoplanar(contourInfo, contourFromList))
+    if (ContoursCoplanar(contourInfo, currentContourList.at(i)))
     {
       pos = i;
       break;
     }
   }
 
-  // Don't save a new empty contour
-  if (pos == -1 && newContour->GetVtkPolyData()->GetNumberOfPoints() > 0)
+  if (pos == -1)
   {
-    m_ReduceFilter->SetInput(m_ListOfInterpolationSessions[m_SelectedSegmentation][m_CurrentTimeStep].size(),
-                             newContour);
-    m_ListOfInterpolationSessions[m_SelectedSegmentation][m_CurrentTimeStep].push_back(contourInfo);
+    currentContourList.push_back(contourInfo);
   }
-  else if (pos != -1 && newContour->GetVtkPolyData()->GetNumberOfPoints() > 0)
+  else
   {
-    m_ListOfInterpolationSessions[m_SelectedSegmentation][m_CurrentTimeStep].at(pos) = contourInfo;
-    m_ReduceFilter->SetInput(pos, newContour);
+    currentContourList.at(pos) = contourInfo;
   }
-  else if (newContour->GetVtkPolyData()->GetNumberOfPoints() == 0)
+
+  this->InvalidateReducedContours(contourInfo);
+  this->CancelInterpolation();
+}
+
+void mitk::SurfaceInterpolationController::InvalidateReducedContours(const ContourPositionInformation &contourInfo)
+{
+  ++m_ContourListModifiedCounter;
+
+  // Parallel contours never intersect, so their reduction does not depend on each other
+  for (auto &currentContour : m_ListOfInterpolationSessions[m_SelectedSegmentation][m_CurrentTimeStep])
   {
-    this->RemoveContour(contourInfo);
+    if (!ContoursParallel(currentContour, contourInfo))
+    {
+      currentContour.reducedContour = nullptr;
+      currentContour.reducedContourIsValid = false;
+    }
   }
 }
 
 bool mitk::SurfaceInterpolationController::RemoveContour(ContourPositionInformation contourInfo)
 {
-  if (!m_SelectedSegmentation)
   {
-    return false;
-  }
+    std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
 
-  unsigned int numTimeSteps = m_SelectedSegmentation->GetTimeSteps();
-  if (m_CurrentTimeStep >= numTimeSteps)
-  {
-    return false;
-  }
+    if (!m_SelectedSegmentation)
+    {
+      return false;
+    }
 
-  auto it = m_ListOfInterpolationSessions[m_SelectedSegmentation][m_CurrentTimeStep].begin();
-  while (it != m_ListOfInterpolationSessions[m_SelectedSegmentation][m_CurrentTimeStep].end())
-  {
-    ContourPositionInformation currentContour = (*it);
-    if (ContoursCoplanar(currentContour, contourInfo))
+    unsigned int numTimeSteps = m_SelectedSegmentation->GetTimeSteps();
+    if (m_CurrentTimeStep >= numTimeSteps)
+    {
+      return false;
+    }
+
+    ContourPositionInformationList &currentContourList =
+      m_ListOfInterpolationSessions[m_SelectedSegmentation][m_CurrentTimeStep];
+    auto it = currentContourList.begin();
+    while (it != currentContourList.end() && !ContoursCoplanar(*it, contourInfo))
     {
-      m_ListOfInterpolationSessions[m_SelectedSegmentation][m_CurrentTimeStep].erase(it);
-      this->ReinitializeInterpolation();
-      return true;
+      ++it;
     }
-    ++it;
+
+    if (it == currentContourList.end())
+      return false;
+
+    currentContourList.erase(it);
+    this->InvalidateReducedContours(contourInfo);
   }
-  return false;
+
+  this->ReinitializeInterpolation();
+  return true;
 }
 
 const mitk::Surface *mitk::SurfaceInterpolationController::GetContour(ContourPositionInformation contourInfo)
 {
+  std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
+
   if (!m_SelectedSegmentation)
   {
     return nullptr;
@@ -237,10 +262,11 @@ const mitk::Surface *mitk::SurfaceInterpolationController::GetContour(ContourPos
     return nullptr;
   }
 
-  ContourPositionInformationList contourList = m_ListOfInterpolationSessions[m_SelectedSegmentation][m_CurrentTimeStep];
+  const ContourPositionInformationList &contourList =
+    m_ListOfInterpolationSessions[m_SelectedSegmentation][m_CurrentTimeStep];
   for (unsigned int i = 0; i < contourList.size(); ++i)
   {
-    ContourPositionInformation currentContour = contourList.at(i);
+    const ContourPositionInformation &currentContour = contourList.at(i);
     if (ContoursCoplanar(contourInfo, currentContour))
       return currentContour.contour;
   }
@@ -249,6 +275,8 @@ const mitk::Surface *mitk::SurfaceInterpolationController::GetContour(ContourPos
 
 unsigned int mitk::SurfaceInterpolationController::GetNumberOfContours()
 {
+  std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
+
   if (!m_SelectedSegmentation)
   {
     return -1;
@@ -265,75 +293,201 @@ unsigned int mitk::SurfaceInterpolationController::GetNumberOfContours()
 
 void mitk::SurfaceInterpolationController::Interpolate()
 {
-  m_ReduceFilter->Update();
+  // Supersede a running interpolation before waiting for it to return
+  this->CancelInterpolation();
+  const unsigned long interpolationId = ++m_InterpolationCounter;
+  std::lock_guard<std::mutex> interpolationLock(m_InterpolationMutex);
 
-  m_CurrentNumberOfReducedContours = m_ReduceFilter->GetNumberOfOutputs();
-  if (m_CurrentNumberOfReducedContours == 1)
+  mitk::Image::Pointer segmentation;
+  unsigned int timeStep(0);
+  unsigned long contourListModifiedCounter(0);
+  unsigned int distanceImageVolume(0);
+  ContourPositionInformationList contours;
   {
-    vtkPolyData *tmp = m_ReduceFilter->GetOutput(0)->GetVtkPolyData();
-    if (tmp == nullptr)
-    {
-      m_CurrentNumberOfReducedContours = 0;
-    }
+    std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
+
+    if (this->IsInterpolationCancelled(interpolationId) || !m_SelectedSegmentation ||
+        m_CurrentTimeStep >= m_SelectedSegmentation->GetTimeSteps())
+      return;
+
+    segmentation = m_SelectedSegmentation;
+    timeStep = m_CurrentTimeStep;
+    contourListModifiedCounter = m_ContourListModifiedCounter;
+    distanceImageVolume = m_DistanceImageVolume;
+
+    auto session = m_ListOfInterpolationSessions.find(m_SelectedSegmentation);
+    if (session != m_ListOfInterpolationSessions.end() && timeStep < session->second.size())
+      contours = session->second[timeStep];
   }
 
   mitk::ImageTimeSelector::Pointer timeSelector = mitk::ImageTimeSelector::New();
-  timeSelector->SetInput(m_SelectedSegmentation);
-  timeSelector->SetTimeNr(m_CurrentTimeStep);
+  timeSelector->SetInput(segmentation);
+  timeSelector->SetTimeNr(timeStep);
   timeSelector->SetChannelNr(0);
   timeSelector->Update();
   mitk::Image::Pointer refSegImage = timeSelector->GetOutput();
 
-  m_NormalsFilter->SetSegmentationBinaryImage(refSegImage);
-  for (unsigned int i = 0; i < m_CurrentNumberOfReducedContours; i++)
+  // Only the contours changed since the last interpolation have to be reduced again
+  std::vector<mitk::Surface::Pointer> reducedContours;
+  for (unsigned int i = 0; i < contours.size(); i++)
   {
-    mitk::Surface::Pointer reducedContour = m_ReduceFilter->GetOutput(i);
-    reducedContour->DisconnectPipeline();
-    m_NormalsFilter->SetInput(i, reducedContour);
-    m_InterpolateSurfaceFilter->SetInput(i, m_NormalsFilter->GetOutput(i));
+    if (this->IsInterpolationCancelled(interpolationId))
+      return;
+
+    if (!contours[i].reducedContourIsValid)
+    {
+      contours[i].reducedContour = this->ComputeReducedContour(contours, i, refSegImage);
+      contours[i].reducedContourIsValid = true;
+    }
+
+    if (contours[i].reducedContour.IsNotNull())
+      reducedContours.push_back(contours[i].reducedContour);
   }
 
-  if (m_CurrentNumberOfReducedContours < 2)
   {
-    // If no interpolation is possible reset the interpolation result
-    m_InterpolationResult = nullptr;
-    return;
+    std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
+
+    // Keep the reduced contours for the next interpolation unless the contours have changed meanwhile
+    auto session = m_ListOfInterpolationSessions.find(segmentation.GetPointer());
+    if (contourListModifiedCounter == m_ContourListModifiedCounter && session != m_ListOfInterpolationSessions.end() &&
+        timeStep < session->second.size())
+      session->second[timeStep] = contours;
+
+    if (this->IsInterpolationCancelled(interpolationId))
+      return;
+
+    m_CurrentNumberOfReducedContours = reducedContours.size();
+    if (m_CurrentNumberOfReducedContours < 2)
+    {
+      // If no interpolation is possible reset the interpolation result
+      m_InterpolationResult = nullptr;
+      return;
+    }
+  }
+
+  itk::ImageBase<3>::Pointer itkImage = itk::ImageBase<3>::New();
+  AccessFixedDimensionByItk_1(refSegImage, GetImageBase, 3, itkImage);
+
+  CreateDistanceImageFromSurfaceFilter::Pointer interpolateSurfaceFilter = CreateDistanceImageFromSurfaceFilter::New();
+  interpolateSurfaceFilter->SetUseProgressBar(true);
+  interpolateSurfaceFilter->SetProgressStepSize(7);
+  interpolateSurfaceFilter->SetReferenceImage(itkImage.GetPointer());
+  interpolateSurfaceFilter->SetDistanceImageVolume(distanceImageVolume);
+  interpolateSurfaceFilter->UseCompactlySupportedRBFOn();
+  for (unsigned int i = 0; i < reducedContours.size(); i++)
+  {
+    interpolateSurfaceFilter->SetInput(i, reducedContours[i]);
+  }
+
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
+    if (this->IsInterpolationCancelled(interpolationId))
+      return;
+    m_RunningInterpolationFilter = interpolateSurfaceFilter;
   }
 
   // Setting up progress bar
   mitk::ProgressBar::GetInstance()->AddStepsToDo(10);
 
-  // create a surface from the distance-image
-  mitk::ImageToSurfaceFilter::Pointer imageToSurfaceFilter = mitk::ImageToSurfaceFilter::New();
-  imageToSurfaceFilter->SetInput(m_InterpolateSurfaceFilter->GetOutput());
-  imageToSurfaceFilter->SetThreshold(0);
-  imageToSurfaceFilter->SetSmooth(true);
-  imageToSurfaceFilter->SetSmoothIteration(20);
-  imageToSurfaceFilter->Update();
+  interpolateSurfaceFilter->Update();
 
-  mitk::Surface::Pointer interpolationResult = mitk::Surface::New();
-  interpolationResult->SetVtkPolyData(imageToSurfaceFilter->GetOutput()->GetVtkPolyData(), m_CurrentTimeStep);
-  m_InterpolationResult = interpolationResult;
-
-  m_DistanceImageSpacing = m_InterpolateSurfaceFilter->GetDistanceImageSpacing();
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
+    m_RunningInterpolationFilter = nullptr;
+  }
 
+  mitk::Surface::Pointer interpolationResult;
   vtkSmartPointer<vtkAppendPolyData> polyDataAppender = vtkSmartPointer<vtkAppendPolyData>::New();
-  for (unsigned int i = 0; i < m_ListOfInterpolationSessions[m_SelectedSegmentation][m_CurrentTimeStep].size(); i++)
+  if (!this->IsInterpolationCancelled(interpolationId))
   {
-    polyDataAppender->AddInputData(
-      m_ListOfInterpolationSessions[m_SelectedSegmentation][m_CurrentTimeStep].at(i).contour->GetVtkPolyData());
+    // create a surface from the distance-image
+    mitk::ImageToSurfaceFilter::Pointer imageToSurfaceFilter = mitk::ImageToSurfaceFilter::New();
+    imageToSurfaceFilter->SetInput(interpolateSurfaceFilter->GetOutput());
+    imageToSurfaceFilter->SetThreshold(0);
+    imageToSurfaceFilter->SetSmooth(true);
+    imageToSurfaceFilter->SetSmoothIteration(20);
+    imageToSurfaceFilter->Update();
+
+    interpolationResult = mitk::Surface::New();
+    interpolationResult->SetVtkPolyData(imageToSurfaceFilter->GetOutput()->GetVtkPolyData(), timeStep);
+
+    for (unsigned int i = 0; i < contours.size(); i++)
+    {
+      polyDataAppender->AddInputData(contours[i].contour->GetVtkPolyData());
+    }
+    polyDataAppender->Update();
   }
-  polyDataAppender->Update();
-  m_Contours->SetVtkPolyData(polyDataAppender->GetOutput());
 
   // Last progress step
   mitk::ProgressBar::GetInstance()->Progress(20);
 
+  std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
+  if (interpolationResult.IsNull() || this->IsInterpolationCancelled(interpolationId))
+    return;
+
+  m_InterpolationResult = interpolationResult;
+  m_DistanceImage = interpolateSurfaceFilter->GetOutput();
+  m_DistanceImageSpacing = interpolateSurfaceFilter->GetDistanceImageSpacing();
+  m_Contours->SetVtkPolyData(polyDataAppender->GetOutput());
+
   m_InterpolationResult->DisconnectPipeline();
 }
 
+void mitk::SurfaceInterpolationController::CancelInterpolation()
+{
+  ++m_InterpolationCounter;
+
+  std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
+  if (m_RunningInterpolationFilter.IsNotNull())
+    m_RunningInterpolationFilter->AbortGenerateDataOn();
+}
+
+bool mitk::SurfaceInterpolationController::IsInterpolationCancelled(unsigned long interpolationId) const
+{
+  return m_InterpolationCounter != interpolationId;
+}
+
+mitk::Surface::Pointer mitk::SurfaceInterpolationController::ComputeReducedContour(
+  const ContourPositionInformationList &contours, unsigned int index, Image *segmentation) const
+{
+  ReduceContourSetFilter::Pointer reduceFilter = ReduceContourSetFilter::New();
+  reduceFilter->SetUseProgressBar(false);
+  reduceFilter->SetMinSpacing(m_MinSpacing);
+  reduceFilter->SetMaxSpacing(m_MaxSpacing);
+  reduceFilter->SetNumberOfInputsToReduce(1);
+  reduceFilter->SetInput(0, contours[index].contour);
+
+  // Only the contours which are not parallel may make this one an intersection contour
+  unsigned int numberOfInputs(1);
+  for (unsigned int i = 0; i < contours.size(); i++)
+  {
+    if (i != index && !ContoursParallel(contours[i], contours[index]))
+      reduceFilter->SetInput(numberOfInputs++, contours[i].contour);
+  }
+  reduceFilter->Update();
+
+  mitk::Surface::Pointer reducedContour = reduceFilter->GetOutput(0);
+  if (reducedContour.IsNull() || reducedContour->GetVtkPolyData() == nullptr ||
+      reducedContour->GetVtkPolyData()->GetNumberOfPolys() == 0)
+    return nullptr;
+  reducedContour->DisconnectPipeline();
+
+  ComputeContourSetNormalsFilter::Pointer normalsFilter = ComputeContourSetNormalsFilter::New();
+  normalsFilter->SetUseProgressBar(false);
+  if (m_MaxSpacing > 0)
+    normalsFilter->SetMaxSpacing(m_MaxSpacing);
+  normalsFilter->SetSegmentationBinaryImage(segmentation);
+  normalsFilter->SetInput(0, reducedContour);
+  normalsFilter->Update();
+
+  mitk::Surface::Pointer contourWithNormals = normalsFilter->GetOutput(0);
+  contourWithNormals->DisconnectPipeline();
+  return contourWithNormals;
+}
+
 mitk::Surface::Pointer mitk::SurfaceInterpolationController::GetInterpolationResult()
 {
+  std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
   return m_InterpolationResult;
 }
 
@@ -349,18 +503,46 @@ void mitk::SurfaceInterpolationController::SetDataStorage(DataStorage::Pointer d
 
 void mitk::SurfaceInterpolationController::SetMinSpacing(double minSpacing)
 {
-  m_ReduceFilter->SetMinSpacing(minSpacing);
+  std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
+  if (minSpacing != m_MinSpacing)
+  {
+    m_MinSpacing = minSpacing;
+    this->InvalidateAllReducedContours();
+  }
 }
 
 void mitk::SurfaceInterpolationController::SetMaxSpacing(double maxSpacing)
 {
-  m_ReduceFilter->SetMaxSpacing(maxSpacing);
-  m_NormalsFilter->SetMaxSpacing(maxSpacing);
+  std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
+  if (maxSpacing != m_MaxSpacing)
+  {
+    m_MaxSpacing = maxSpacing;
+    this->InvalidateAllReducedContours();
+  }
+}
+
+void mitk::SurfaceInterpolationController::InvalidateAllReducedContours()
+{
+  ++m_ContourListModifiedCounter;
+
+  for (auto &session : m_ListOfInterpolationSessions)
+  {
+    for (auto &contourList : session.second)
+    {
+      for (auto &contourInfo : contourList)
+      {
+        contourInfo.reducedContour = nullptr;
+        contourInfo.reducedContourIsValid = false;
+      }
+    }
+  }
+  this->CancelInterpolation();
 }
 
 void mitk::SurfaceInterpolationController::SetDistanceImageVolume(unsigned int distImgVolume)
 {
-  m_InterpolateSurfaceFilter->SetDistanceImageVolume(distImgVolume);
+  std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
+  m_DistanceImageVolume = distImgVolume;
 }
 
 mitk::Image::Pointer mitk::SurfaceInterpolationController::GetCurrentSegmentation()
@@ -370,12 +552,31 @@ mitk::Image::Pointer mitk::SurfaceInterpolationController::GetCurrentSegmentatio
 
 mitk::Image *mitk::SurfaceInterpolationController::GetImage()
 {
-  return m_InterpolateSurfaceFilter->GetOutput();
+  std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
+  return m_DistanceImage;
 }
 
 double mitk::SurfaceInterpolationController::EstimatePortionOfNeededMemory()
 {
-  double numberOfPointsAfterReduction = m_ReduceFilter->GetNumberOfPointsAfterReduction() * 3;
+  // Contours which have not been reduced yet are estimated by their number of points
+  unsigned int numberOfPoints(0);
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
+
+    auto session = m_ListOfInterpolationSessions.find(m_SelectedSegmentation);
+    if (session != m_ListOfInterpolationSessions.end() && m_CurrentTimeStep < session->second.size())
+    {
+      for (const auto &contourInfo : session->second[m_CurrentTimeStep])
+      {
+        if (!contourInfo.reducedContourIsValid)
+          numberOfPoints += contourInfo.contour->GetVtkPolyData()->GetNumberOfPoints();
+        else if (contourInfo.reducedContour.IsNotNull())
+          numberOfPoints += contourInfo.reducedContour->GetVtkPolyData()->GetNumberOfPoints();
+      }
+    }
+  }
+
+  double numberOfPointsAfterReduction = numberOfPoints * 3;
   double sizeOfPoints = pow(numberOfPointsAfterReduction, 2) * sizeof(double);
   double totalMem = mitk::MemoryUtilities::GetTotalSizeOfPhysicalRam();
   double percentage = sizeOfPoints / totalMem;
@@ -384,6 +585,7 @@ double mitk::SurfaceInterpolationController::EstimatePortionOfNeededMemory()
 
 unsigned int mitk::SurfaceInterpolationController::GetNumberOfInterpolationSessions()
 {
+  std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
   return m_ListOfInterpolationSessions.size();
 }
 
@@ -401,33 +603,39 @@ void mitk::SurfaceInterpolationController::SetCurrentSegmentationInterpolationLi
 
 void mitk::SurfaceInterpolationController::SetCurrentInterpolationSession(mitk::Image::Pointer currentSegmentationImage)
 {
-  if (currentSegmentationImage.GetPointer() == m_SelectedSegmentation)
-    return;
-
-  if (currentSegmentationImage.IsNull())
   {
-    m_SelectedSegmentation = nullptr;
-    return;
-  }
+    std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
 
-  m_SelectedSegmentation = currentSegmentationImage.GetPointer();
+    if (currentSegmentationImage.GetPointer() == m_SelectedSegmentation)
+      return;
 
-  auto it = m_ListOfInterpolationSessions.find(currentSegmentationImage.GetPointer());
-  // If the session does not exist yet create a new ContourPositionPairList otherwise reinitialize the interpolation
-  // pipeline
-  if (it == m_ListOfInterpolationSessions.end())
-  {
-    ContourPositionInformationVec2D newList;
-    m_ListOfInterpolationSessions.insert(
-      std::pair<mitk::Image *, ContourPositionInformationVec2D>(m_SelectedSegmentation, newList));
-    m_InterpolationResult = nullptr;
-    m_CurrentNumberOfReducedContours = 0;
+    this->CancelInterpolation();
 
-    itk::MemberCommand<SurfaceInterpolationController>::Pointer command =
-      itk::MemberCommand<SurfaceInterpolationController>::New();
-    command->SetCallbackFunction(this, &SurfaceInterpolationController::OnSegmentationDeleted);
-    m_SegmentationObserverTags.insert(std::pair<mitk::Image *, unsigned long>(
-      m_SelectedSegmentation, m_SelectedSegmentation->AddObserver(itk::DeleteEvent(), command)));
+    if (currentSegmentationImage.IsNull())
+    {
+      m_SelectedSegmentation = nullptr;
+      return;
+    }
+
+    m_SelectedSegmentation = currentSegmentationImage.GetPointer();
+
+    auto it = m_ListOfInterpolationSessions.find(currentSegmentationImage.GetPointer());
+    // If the session does not exist yet create a new ContourPositionPairList otherwise reinitialize the interpolation
+    // pipeline
+    if (it == m_ListOfInterpolationSessions.end())
+    {
+      ContourPositionInformationVec2D newList;
+      m_ListOfInterpolationSessions.insert(
+        std::pair<mitk::Image *, ContourPositionInformationVec2D>(m_SelectedSegmentation, newList));
+      m_InterpolationResult = nullptr;
+      m_CurrentNumberOfReducedContours = 0;
+
+      itk::MemberCommand<SurfaceInterpolationController>::Pointer command =
+        itk::MemberCommand<SurfaceInterpolationController>::New();
+      command->SetCallbackFunction(this, &SurfaceInterpolationController::OnSegmentationDeleted);
+      m_SegmentationObserverTags.insert(std::pair<mitk::Image *, unsigned long>(
+        m_SelectedSegmentation, m_SelectedSegmentation->AddObserver(itk::DeleteEvent(), command)));
+    }
   }
 
   this->ReinitializeInterpolation();
@@ -445,6 +653,8 @@ bool mitk::SurfaceInterpolationController::ReplaceInterpolationSession(mitk::Ima
   if (!mitk::Equal(*(oldSession->GetGeometry()), *(newSession->GetGeometry()), mitk::eps, false))
     return false;
 
+  std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
+
   auto it = m_ListOfInterpolationSessions.find(oldSession.GetPointer());
 
   if (it == m_ListOfInterpolationSessions.end())
@@ -460,15 +670,11 @@ bool mitk::SurfaceInterpolationController::ReplaceInterpolationSession(mitk::Ima
     std::pair<mitk::Image *, unsigned long>(newSession, newSession->AddObserver(itk::DeleteEvent(), command)));
 
   if (m_SelectedSegmentation == oldSession)
+  {
+    // The normals of the reduced contours have been oriented using the old segmentation
+    this->CancelInterpolation();
     m_SelectedSegmentation = newSession;
-
-  mitk::ImageTimeSelector::Pointer timeSelector = mitk::ImageTimeSelector::New();
-  timeSelector->SetInput(m_SelectedSegmentation);
-  timeSelector->SetTimeNr(m_CurrentTimeStep);
-  timeSelector->SetChannelNr(0);
-  timeSelector->Update();
-  mitk::Image::Pointer refSegImage = timeSelector->GetOutput();
-  m_NormalsFilter->SetSegmentationBinaryImage(refSegImage);
+  }
 
   this->RemoveInterpolationSession(oldSession);
   return true;
@@ -483,9 +689,11 @@ void mitk::SurfaceInterpolationController::RemoveInterpolationSession(mitk::Imag
 {
   if (segmentationImage)
   {
+    std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
+
     if (m_SelectedSegmentation == segmentationImage)
     {
-      m_NormalsFilter->SetSegmentationBinaryImage(nullptr);
+      this->CancelInterpolation();
       m_SelectedSegmentation = nullptr;
     }
     m_ListOfInterpolationSessions.erase(segmentationImage);
@@ -501,6 +709,9 @@ void mitk::SurfaceInterpolationController::RemoveInterpolationSession(mitk::Imag
 
 void mitk::SurfaceInterpolationController::RemoveAllInterpolationSessions()
 {
+  std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
+  this->CancelInterpolation();
+
   // Removing all observers
   auto dataIter = m_SegmentationObserverTags.begin();
   while (dataIter != m_SegmentationObserverTags.end())
@@ -629,9 +840,11 @@ void mitk::SurfaceInterpolationController::OnSegmentationDeleted(const itk::Obje
   auto *tempImage = dynamic_cast<mitk::Image *>(const_cast<itk::Object *>(caller));
   if (tempImage)
   {
+    std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
+
     if (m_SelectedSegmentation == tempImage)
     {
-      m_NormalsFilter->SetSegmentationBinaryImage(nullptr);
+      this->CancelInterpolation();
       m_SelectedSegmentation = nullptr;
     }
     m_SegmentationObserverTags.erase(tempImage);
@@ -641,23 +854,14 @@ void mitk::SurfaceInterpolationController::OnSegmentationDeleted(const itk::Obje
 
 void mitk::SurfaceInterpolationController::ReinitializeInterpolation()
 {
-  // If session has changed reset the pipeline
-  m_ReduceFilter->Reset();
-  m_NormalsFilter->Reset();
-  m_InterpolateSurfaceFilter->Reset();
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_ContourListMutex);
 
-  itk::ImageBase<3>::Pointer itkImage = itk::ImageBase<3>::New();
+    // If session has changed a running interpolation is outdated
+    this->CancelInterpolation();
 
-  if (m_SelectedSegmentation)
-  {
-    mitk::ImageTimeSelector::Pointer timeSelector = mitk::ImageTimeSelector::New();
-    timeSelector->SetInput(m_SelectedSegmentation);
-    timeSelector->SetTimeNr(m_CurrentTimeStep);
-    timeSelector->SetChannelNr(0);
-    timeSelector->Update();
-    mitk::Image::Pointer refSegImage = timeSelector->GetOutput();
-    AccessFixedDimensionByItk_1(refSegImage, GetImageBase, 3, itkImage);
-    m_InterpolateSurfaceFilter->SetReferenceImage(itkImage.GetPointer());
+    if (!m_SelectedSegmentation)
+      return;
 
     unsigned int numTimeSteps = m_SelectedSegmentation->GetTimeSteps();
     unsigned int size = m_ListOfInterpolationSessions[m_SelectedSegmentation].size();
@@ -665,35 +869,7 @@ void mitk::SurfaceInterpolationController::ReinitializeInterpolation()
     {
       m_ListOfInterpolationSessions[m_SelectedSegmentation].resize(numTimeSteps);
     }
-
-    if (m_CurrentTimeStep < numTimeSteps)
-    {
-      unsigned int numContours = m_ListOfInterpolationSessions[m_SelectedSegmentation][m_CurrentTimeStep].size();
-      for (unsigned int c = 0; c < numContours; ++c)
-      {
-        m_ReduceFilter->SetInput(c,
-                                 m_ListOfInterpolationSessions[m_SelectedSegmentation][m_CurrentTimeStep][c].contour);
-      }
-
-      m_ReduceFilter->Update();
-
-      m_CurrentNumberOfReducedContours = m_ReduceFilter->GetNumberOfOutputs();
-      if (m_CurrentNumberOfReducedContours == 1)
-      {
-        vtkPolyData *tmp = m_ReduceFilter->GetOutput(0)->GetVtkPolyData();
-        if (tmp == nullptr)
-        {
-          m_CurrentNumberOfReducedContours = 0;
-        }
-      }
-
-      for (unsigned int i = 0; i < m_CurrentNumberOfReducedContours; i++)
-      {
-        m_NormalsFilter->SetInput(i, m_ReduceFilter->GetOutput(i));
-        m_InterpolateSurfaceFilter->SetInput(i, m_NormalsFilter->GetOutput(i));
-      }
-    }
-
-    Modified();
   }
+
+  Modified();
 }
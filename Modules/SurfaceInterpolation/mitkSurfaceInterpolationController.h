@@ -47,6 +47,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkProgressBar.h"
 
+#include <atomic>
+#include <mutex>
+
 namespace mitk
 {
   class MITKSURFACEINTERPOLATION_EXPORT SurfaceInterpolationController : public itk::Object
@@ -62,6 +65,12 @@ namespace mitk
       Surface::Pointer contour;
       Vector3D contourNormal;
       Point3D contourPoint;
+
+      /** The reduced contour including its normals as used by the last interpolation. It is
+       *  reused until the contour or one of the contours intersecting it changes. nullptr
+       *  if the reduction did not leave any polygon. */
+      Surface::Pointer reducedContour;
+      bool reducedContourIsValid = false;
     };
 
     typedef std::vector<ContourPositionInformation> ContourPositionInformationList;
@@ -120,10 +129,22 @@ namespace mitk
     unsigned int GetNumberOfContours();
 
     /**
-     * Interpolates the 3D surface from the given extracted contours
+     * Interpolates the 3D surface from the given extracted contours.
+     *
+     * The interpolation works on a copy of the current contours, so it may run in a background
+     * thread while contours are added or removed. Such changes as well as calling Interpolate()
+     * again cancel a running interpolation, which then returns without touching the result.
+     * Only the contours changed since the last interpolation are reduced and get their normals
+     * computed again. The result is published when the interpolation has finished.
      */
     void Interpolate();
 
+    /**
+     * Cancels a running interpolation as soon as possible. The last published result is kept.
+     * Does nothing if no interpolation is running.
+     */
+    void CancelInterpolation();
+
     mitk::Surface::Pointer GetInterpolationResult();
 
     /**
@@ -226,9 +247,45 @@ namespace mitk
 
     void AddToInterpolationPipeline(ContourPositionInformation contourInfo);
 
-    ReduceContourSetFilter::Pointer m_ReduceFilter;
-    ComputeContourSetNormalsFilter::Pointer m_NormalsFilter;
-    CreateDistanceImageFromSurfaceFilter::Pointer m_InterpolateSurfaceFilter;
+    /**
+     * Invalidates the reduced contours which may depend on the given contour, i.e. the ones which
+     * are not parallel to it. The caller has to hold the contour list mutex.
+     */
+    void InvalidateReducedContours(const ContourPositionInformation &contourInfo);
+
+    /** Invalidates the reduced contours of all sessions. The caller has to hold the contour list mutex. */
+    void InvalidateAllReducedContours();
+
+    /**
+     * Reduces the contour at the given index and computes its normals. The other contours are only
+     * considered for the intersection check of the reduction.
+     */
+    Surface::Pointer ComputeReducedContour(const ContourPositionInformationList &contours,
+                                           unsigned int index,
+                                           Image *segmentation) const;
+
+    /** Returns true if the interpolation with the given id has been cancelled or superseded */
+    bool IsInterpolationCancelled(unsigned long interpolationId) const;
+
+    double m_MinSpacing;
+    double m_MaxSpacing;
+    unsigned int m_DistanceImageVolume;
+
+    /** Guards the interpolation sessions, the published results and m_RunningInterpolationFilter */
+    mutable std::recursive_mutex m_ContourListMutex;
+
+    /** Serializes the interpolations */
+    std::mutex m_InterpolationMutex;
+
+    /** Incremented by every requested or cancelled interpolation */
+    std::atomic<unsigned long> m_InterpolationCounter;
+
+    /** Incremented by every change which invalidates reduced contours */
+    unsigned long m_ContourListModifiedCounter;
+
+    CreateDistanceImageFromSurfaceFilter::Pointer m_RunningInterpolationFilter;
+
+    mitk::Image::Pointer m_DistanceImage;
 
     Surface::Pointer m_Contours;
 
@@ -26,6 +26,7 @@ namespace mitk
 KinectDevice::KinectDevice()
 {
   m_Controller = mitk::KinectController::New();
+  m_SupportsFrameExchange = true;
 }
 
 KinectDevice::~KinectDevice()
@@ -120,6 +121,9 @@ void KinectDevice::StartCamera()
     this->m_FreePos = (this->m_FreePos+1) % this->m_BufferSize;
     this->m_CurrentPos = (this->m_CurrentPos+1) % this->m_BufferSize;
     this->m_ImageSequence++;
+    this->PublishFrame(this->m_DistanceDataBuffer[this->m_CurrentPos], this->m_AmplitudeDataBuffer[this->m_CurrentPos],
+                       nullptr, this->m_RGBDataBuffer[this->m_CurrentPos],
+                       this->m_ImageSequence);
     this->m_ImageMutex->Unlock();
 
     this->m_CameraActiveMutex->Lock();
@@ -201,6 +205,9 @@ ITK_THREAD_RETURN_TYPE KinectDevice::Acquire(void* pInfoStruct)
       toFCameraDevice->m_FreePos = (toFCameraDevice->m_FreePos+1) % toFCameraDevice->m_BufferSize;
       toFCameraDevice->m_CurrentPos = (toFCameraDevice->m_CurrentPos+1) % toFCameraDevice->m_BufferSize;
       toFCameraDevice->m_ImageSequence++;
+      toFCameraDevice->PublishFrame(toFCameraDevice->m_DistanceDataBuffer[toFCameraDevice->m_CurrentPos], toFCameraDevice->m_AmplitudeDataBuffer[toFCameraDevice->m_CurrentPos],
+                                    nullptr, toFCameraDevice->m_RGBDataBuffer[toFCameraDevice->m_CurrentPos],
+                                    toFCameraDevice->m_ImageSequence);
       if (toFCameraDevice->m_FreePos == toFCameraDevice->m_CurrentPos)
       {
         overflow = true;
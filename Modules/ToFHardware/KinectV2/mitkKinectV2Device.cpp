@@ -36,6 +36,7 @@ namespace mitk
     m_RGBBufferSize(3*1920*1080)
   {
     m_Controller = mitk::KinectV2Controller::New();
+    m_SupportsFrameExchange = true;
     m_PolyData = vtkSmartPointer<vtkPolyData>::New();
   }
 
@@ -132,6 +133,9 @@ namespace mitk
       this->m_FreePos = (this->m_FreePos+1) % this->m_BufferSize;
       this->m_CurrentPos = (this->m_CurrentPos+1) % this->m_BufferSize;
       this->m_ImageSequence++;
+      this->PublishFrame(this->m_DistanceDataBuffer[this->m_CurrentPos], this->m_AmplitudeDataBuffer[this->m_CurrentPos],
+                         nullptr, this->m_RGBDataBuffer[this->m_CurrentPos],
+                         this->m_ImageSequence);
       this->m_ImageMutex->Unlock();
 
       this->m_CameraActiveMutex->Lock();
@@ -225,6 +229,9 @@ namespace mitk
         toFCameraDevice->m_FreePos = (toFCameraDevice->m_FreePos+1) % toFCameraDevice->m_BufferSize;
         toFCameraDevice->m_CurrentPos = (toFCameraDevice->m_CurrentPos+1) % toFCameraDevice->m_BufferSize;
         toFCameraDevice->m_ImageSequence++;
+        toFCameraDevice->PublishFrame(toFCameraDevice->m_DistanceDataBuffer[toFCameraDevice->m_CurrentPos], toFCameraDevice->m_AmplitudeDataBuffer[toFCameraDevice->m_CurrentPos],
+                                      nullptr, toFCameraDevice->m_RGBDataBuffer[toFCameraDevice->m_CurrentPos],
+                                      toFCameraDevice->m_ImageSequence);
         if (toFCameraDevice->m_FreePos == toFCameraDevice->m_CurrentPos)
         {
           overflow = true;
@@ -23,6 +23,7 @@ namespace mitk
 {
   ToFCameraMESADevice::ToFCameraMESADevice()
   {
+    m_SupportsFrameExchange = true;
   }
 
   ToFCameraMESADevice::~ToFCameraMESADevice()
@@ -121,6 +122,9 @@ namespace mitk
       this->m_FreePos = (this->m_FreePos+1) % this->m_BufferSize;
       this->m_CurrentPos = (this->m_CurrentPos+1) % this->m_BufferSize;
       this->m_ImageSequence++;
+      this->PublishFrame(this->m_DistanceDataBuffer[this->m_CurrentPos], this->m_AmplitudeDataBuffer[this->m_CurrentPos],
+                         this->m_IntensityDataBuffer[this->m_CurrentPos], nullptr,
+                         this->m_ImageSequence);
       this->m_ImageMutex->Unlock();
 
       this->m_CameraActiveMutex->Lock();
@@ -205,6 +209,9 @@ namespace mitk
         toFCameraDevice->m_FreePos = (toFCameraDevice->m_FreePos+1) % toFCameraDevice->m_BufferSize;
         toFCameraDevice->m_CurrentPos = (toFCameraDevice->m_CurrentPos+1) % toFCameraDevice->m_BufferSize;
         toFCameraDevice->m_ImageSequence++;
+        toFCameraDevice->PublishFrame(toFCameraDevice->m_DistanceDataBuffer[toFCameraDevice->m_CurrentPos], toFCameraDevice->m_AmplitudeDataBuffer[toFCameraDevice->m_CurrentPos],
+                                      toFCameraDevice->m_IntensityDataBuffer[toFCameraDevice->m_CurrentPos], nullptr,
+                                      toFCameraDevice->m_ImageSequence);
         if (toFCameraDevice->m_FreePos == toFCameraDevice->m_CurrentPos)
         {
           overflow = true;
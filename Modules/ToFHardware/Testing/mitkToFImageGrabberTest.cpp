@@ -25,6 +25,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 
 #include <mitkImageSliceSelector.h>
+#include <mitkImageReadAccessor.h>
+
+#include <algorithm>
 
 /**
  * @brief The mitkToFImageGrabberTestSuite class is a test-suite for mitkToFImageGrabber.
@@ -41,6 +44,7 @@ class mitkToFImageGrabberTestSuite : public mitk::TestFixture
   MITK_TEST(IsCameraActive_DifferentStates_ReturnsCorrectResult);
   MITK_TEST(Update_2DData_ImagesAreEqual);
   MITK_TEST(Update_CamCubeData_PropertiesAreTrue);
+  MITK_TEST(Update_FrameExchange_OutputReferencesAcquiredFrame);
 
   CPPUNIT_TEST_SUITE_END();
 
@@ -185,6 +189,35 @@ public:
     CPPUNIT_ASSERT( m_ToFImageGrabber->GetOutput(1) != nullptr );
     CPPUNIT_ASSERT( m_ToFImageGrabber->GetOutput(2) != nullptr );
   }
+
+  void Update_FrameExchange_OutputReferencesAcquiredFrame()
+  {
+    mitk::ToFImageGrabber::Pointer grabber = mitk::ToFImageGrabber::New();
+    mitk::ToFCameraMITKPlayerDevice::Pointer device = mitk::ToFCameraMITKPlayerDevice::New();
+    grabber->SetCameraDevice(device);
+    grabber->SetProperty("DistanceImageFileName",mitk::StringProperty::New(m_KinectDepthImagePath));
+    CPPUNIT_ASSERT(device->SupportsFrameExchange());
+
+    grabber->ConnectCamera();
+    grabber->StartCamera();
+    grabber->Update();
+    grabber->StopCamera();
+
+    mitk::Image::Pointer distanceImage = grabber->GetOutput(0);
+    const float* frameDistances = device->GetAcquiredFrame().m_Distances.data();
+    {
+      mitk::ImageReadAccessor accessor(distanceImage);
+      CPPUNIT_ASSERT_MESSAGE("Output references the acquired frame", accessor.GetData() == frameDistances);
+    }
+
+    // the output keeps its own copy of the last frame if the grabber is destroyed
+    std::vector<float> expectedDistances = device->GetAcquiredFrame().m_Distances;
+    grabber->DisconnectCamera();
+    grabber = nullptr;
+    device = nullptr;
+    mitk::ImageReadAccessor accessor(distanceImage);
+    CPPUNIT_ASSERT(std::equal(expectedDistances.begin(), expectedDistances.end(), static_cast<const float*>(accessor.GetData())));
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkToFImageGrabber)
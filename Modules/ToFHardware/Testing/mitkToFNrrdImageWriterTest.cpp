@@ -29,6 +29,7 @@ class mitkToFNrrdImageWriterTestSuite : public mitk::TestFixture
   CPPUNIT_TEST_SUITE(mitkToFNrrdImageWriterTestSuite);
   MITK_TEST(GetExtension_DefaultValueIsNrrd);
   MITK_TEST(Add_WriteDistanceImage_OutputImageIsEqualToInput);
+  MITK_TEST(Add_WriteCompressedDistanceImage_OutputImageIsEqualToInput);
   //Work in progress:
 //  MITK_TEST(Add_WriteDistanceAndAmplitudeImage_OutputImagesAreEqualToInput);
 //  MITK_TEST(Add_WriteDistanceAndIntensityImage_OutputImagesAreEqualToInput);
@@ -113,6 +114,26 @@ public:
     remove( m_DistanceImageName.c_str() );
   }
 
+  void Add_WriteCompressedDistanceImage_OutputImageIsEqualToInput()
+  {
+    m_ToFNrrdImageWriter->SetDistanceImageFileName(m_DistanceImageName);
+    m_ToFNrrdImageWriter->CompressDistanceImageOn();
+
+    m_ToFNrrdImageWriter->Open(); //open file/stream
+    for(unsigned int i = 0; i < m_NumberOfFrames ; ++i)
+    {
+      mitk::ImageReadAccessor distAcc(m_GroundTruthDepthImage, m_GroundTruthDepthImage->GetSliceData(i, 0, 0));
+      m_ToFNrrdImageWriter->Add((float*)distAcc.GetData(), nullptr, nullptr);
+    }
+    m_ToFNrrdImageWriter->Close(); //close file
+
+    mitk::Image::Pointer writtenImage = mitk::IOUtil::Load<mitk::Image>( m_DistanceImageName );
+    MITK_ASSERT_EQUAL( m_GroundTruthDepthImage, writtenImage, "Compressed recording should be lossless.");
+
+    //clean up tmp written image
+    remove( m_DistanceImageName.c_str() );
+  }
+
   void Add_WriteDistanceAndAmplitudeImage_OutputImagesAreEqualToInput()
   {
     m_ToFNrrdImageWriter->SetDistanceImageFileName(m_DistanceImageName);
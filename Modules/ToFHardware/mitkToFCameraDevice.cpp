@@ -20,7 +20,7 @@ namespace mitk
 {
   ToFCameraDevice::ToFCameraDevice():m_BufferSize(1),m_MaxBufferSize(100),m_CurrentPos(-1),m_FreePos(0),
     m_CaptureWidth(204),m_CaptureHeight(204),m_PixelNumber(41616),m_SourceDataSize(0),
-    m_ThreadID(0),m_CameraActive(false),m_CameraConnected(false),m_ImageSequence(0)
+    m_ThreadID(0),m_CameraActive(false),m_CameraConnected(false),m_ImageSequence(0),m_SupportsFrameExchange(false)
   {
     this->m_AmplitudeArray = nullptr;
     this->m_IntensityArray = nullptr;
@@ -186,4 +186,32 @@ namespace mitk
   {
     return m_CameraConnected;
   }
+
+  bool ToFCameraDevice::SupportsFrameExchange() const
+  {
+    return m_SupportsFrameExchange;
+  }
+
+  bool ToFCameraDevice::AcquireFrame()
+  {
+    return m_FrameExchange.Acquire();
+  }
+
+  const ToFCameraDevice::ToFFrame& ToFCameraDevice::GetAcquiredFrame() const
+  {
+    return m_FrameExchange.GetReadBuffer();
+  }
+
+  void ToFCameraDevice::PublishFrame(const float* distances, const float* amplitudes, const float* intensities,
+                                     const unsigned char* rgbData, int imageSequence)
+  {
+    ToFFrame& frame = m_FrameExchange.GetWriteBuffer();
+    // assign() only reallocates if the image size changed, so the frames are reused in the steady state
+    frame.m_Distances.assign(distances, distances + (distances ? m_PixelNumber : 0));
+    frame.m_Amplitudes.assign(amplitudes, amplitudes + (amplitudes ? m_PixelNumber : 0));
+    frame.m_Intensities.assign(intensities, intensities + (intensities ? m_PixelNumber : 0));
+    frame.m_RGBData.assign(rgbData, rgbData + (rgbData ? m_RGBPixelNumber * 3 : 0));
+    frame.m_ImageSequence = imageSequence;
+    m_FrameExchange.Publish();
+  }
 }
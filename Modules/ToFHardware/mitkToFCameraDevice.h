@@ -21,12 +21,15 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkStringProperty.h"
 #include "mitkProperties.h"
 #include "mitkPropertyList.h"
+#include "mitkTripleBuffer.h"
 
 #include "itkObject.h"
 #include "itkObjectFactory.h"
 #include "itkMultiThreader.h"
 #include "itkFastMutexLock.h"
 
+#include <vector>
+
 // Microservices
 #include <mitkServiceInterface.h>
 
@@ -185,6 +188,36 @@ namespace mitk
 
     virtual int GetRGBCaptureHeight();
 
+    /*!
+    \brief one complete frame handed from the acquisition thread to the consumer by the frame exchange
+    */
+    struct ToFFrame
+    {
+      ToFFrame() : m_ImageSequence(-1) {}
+      std::vector<float> m_Distances; ///< distance image, empty if the frame was not filled yet
+      std::vector<float> m_Amplitudes; ///< amplitude image, empty if the device does not provide one
+      std::vector<float> m_Intensities; ///< intensity image, empty if the device does not provide one
+      std::vector<unsigned char> m_RGBData; ///< interleaved RGB image, empty if the device does not provide one
+      int m_ImageSequence; ///< image sequence number of the frame
+    };
+
+    /*!
+    \brief returns true if the acquisition thread of the device publishes its frames by the frame exchange.
+    Devices which do not support it only provide their images by GetAllImages().
+    */
+    bool SupportsFrameExchange() const;
+    /*!
+    \brief takes over the newest frame published by the acquisition thread without ever blocking it.
+    In contrast to GetAllImages() no image data is copied. The frame stays valid and unchanged until the
+    next call of AcquireFrame(). Only a single consumer may acquire frames of a device.
+    \return true if a frame newer than the previously acquired one is available
+    */
+    bool AcquireFrame();
+    /*!
+    \brief returns the frame taken over by the last successful call of AcquireFrame()
+    */
+    const ToFFrame& GetAcquiredFrame() const;
+
   protected:
 
     ToFCameraDevice();
@@ -199,6 +232,11 @@ namespace mitk
     \brief method for cleanup memory allocated for pixel arrays m_IntensityArray, m_DistanceArray and m_AmplitudeArray
     */
     virtual void CleanupPixelArrays();
+    /*!
+    \brief copies the given images into the free frame of the frame exchange and publishes it to the consumer.
+    Has to be called by the acquisition thread only. Images which the device does not provide are passed as nullptr.
+    */
+    void PublishFrame(const float* distances, const float* amplitudes, const float* intensities, const unsigned char* rgbData, int imageSequence);
 
     float* m_IntensityArray; ///< float array holding the intensity image
     float* m_DistanceArray; ///< float array holding the distance image
@@ -221,6 +259,8 @@ namespace mitk
     bool m_CameraActive; ///< flag indicating if the camera is currently active or not. Caution: thread safe access only!
     bool m_CameraConnected; ///< flag indicating if the camera is successfully connected or not. Caution: thread safe access only!
     int m_ImageSequence; ///<  counter for acquired images
+    bool m_SupportsFrameExchange; ///< flag indicating if the acquisition thread calls PublishFrame(). Has to be set by the device implementation.
+    TripleBuffer<ToFFrame> m_FrameExchange; ///< lock-free exchange of the newest frame between acquisition thread and consumer
 
     PropertyList::Pointer m_PropertyList; ///< a list of the corresponding properties
 
@@ -28,6 +28,7 @@ ToFCameraMITKPlayerDevice::ToFCameraMITKPlayerDevice() :
   m_DistanceDataBuffer(nullptr), m_AmplitudeDataBuffer(nullptr), m_IntensityDataBuffer(nullptr), m_RGBDataBuffer(nullptr)
 {
   m_Controller = ToFCameraMITKPlayerController::New();
+  m_SupportsFrameExchange = true;
 }
 
 ToFCameraMITKPlayerDevice::~ToFCameraMITKPlayerDevice()
@@ -85,6 +86,9 @@ void ToFCameraMITKPlayerDevice::StartCamera()
     this->m_FreePos = (this->m_FreePos+1) % this->m_BufferSize;
     this->m_CurrentPos = (this->m_CurrentPos+1) % this->m_BufferSize;
     this->m_ImageSequence++;
+    this->PublishFrame(this->m_DistanceDataBuffer[this->m_CurrentPos], this->m_AmplitudeDataBuffer[this->m_CurrentPos],
+                       this->m_IntensityDataBuffer[this->m_CurrentPos], this->m_RGBDataBuffer[this->m_CurrentPos],
+                       this->m_ImageSequence);
     this->m_ImageMutex->Unlock();
 
     this->m_CameraActiveMutex->Lock();
@@ -141,6 +145,9 @@ ITK_THREAD_RETURN_TYPE ToFCameraMITKPlayerDevice::Acquire(void* pInfoStruct)
       toFCameraDevice->m_FreePos = (toFCameraDevice->m_FreePos+1) % toFCameraDevice->m_BufferSize;
       toFCameraDevice->m_CurrentPos = (toFCameraDevice->m_CurrentPos+1) % toFCameraDevice->m_BufferSize;
       toFCameraDevice->m_ImageSequence++;
+      toFCameraDevice->PublishFrame(toFCameraDevice->m_DistanceDataBuffer[toFCameraDevice->m_CurrentPos], toFCameraDevice->m_AmplitudeDataBuffer[toFCameraDevice->m_CurrentPos],
+                                    toFCameraDevice->m_IntensityDataBuffer[toFCameraDevice->m_CurrentPos], toFCameraDevice->m_RGBDataBuffer[toFCameraDevice->m_CurrentPos],
+                                    toFCameraDevice->m_ImageSequence);
       if (toFCameraDevice->m_FreePos == toFCameraDevice->m_CurrentPos)
       {
         overflow = true;
@@ -35,7 +35,8 @@ ToFImageGrabber::ToFImageGrabber():
   m_AmplitudeArray(nullptr),
   m_SourceDataArray(nullptr),
   m_RgbDataArray(nullptr),
-  m_DeviceObserverTag()
+  m_DeviceObserverTag(),
+  m_OutputsReferenceFrame(false)
 {
   // Create the output. We use static_cast<> here because we know the default
   // output must be of type TOutputImage
@@ -52,6 +53,12 @@ ToFImageGrabber::ToFImageGrabber():
 
 ToFImageGrabber::~ToFImageGrabber()
 {
+  // the outputs may outlive the device whose frame they reference
+  if (m_OutputsReferenceFrame)
+  {
+    this->SetAcquiredFrameToOutputs(Image::CopyMemory);
+    m_OutputsReferenceFrame = false;
+  }
   if (m_IntensityArray||m_AmplitudeArray||m_DistanceArray||m_RgbDataArray)
   {
     if (m_ToFCameraDevice)
@@ -65,6 +72,22 @@ ToFImageGrabber::~ToFImageGrabber()
 
 void ToFImageGrabber::GenerateData()
 {
+  if (this->m_ToFCameraDevice->SupportsFrameExchange())
+  {
+    if (this->m_ToFCameraDevice->AcquireFrame())
+    {
+      this->m_ImageSequence = this->m_ToFCameraDevice->GetAcquiredFrame().m_ImageSequence;
+      this->SetAcquiredFrameToOutputs(Image::ReferenceMemory);
+      m_OutputsReferenceFrame = true;
+      return;
+    }
+    if (m_OutputsReferenceFrame)
+    {
+      // no newer frame yet, the outputs still hold the last one
+      return;
+    }
+  }
+
   int requiredImageSequence = 0;
   // acquire new image data
   this->m_ToFCameraDevice->GetAllImages(this->m_DistanceArray, this->m_AmplitudeArray, this->m_IntensityArray, this->m_SourceDataArray,
@@ -104,6 +127,37 @@ void ToFImageGrabber::GenerateData()
   }
 }
 
+void ToFImageGrabber::SetAcquiredFrameToOutputs(Image::ImportMemoryManagementType importMemoryManagement)
+{
+  const ToFCameraDevice::ToFFrame& frame = this->m_ToFCameraDevice->GetAcquiredFrame();
+  // the frame is only read by the outputs, it is not modified until the next call of AcquireFrame()
+  if (frame.m_Distances.size() == static_cast<size_t>(m_PixelNumber))
+  {
+    this->GetOutput(0)->SetImportVolume(const_cast<float*>(frame.m_Distances.data()), 0, 0, importMemoryManagement);
+  }
+
+  bool hasAmplitudeImage = false;
+  m_ToFCameraDevice->GetBoolProperty("HasAmplitudeImage", hasAmplitudeImage);
+  if (hasAmplitudeImage && frame.m_Amplitudes.size() == static_cast<size_t>(m_PixelNumber))
+  {
+    this->GetOutput(1)->SetImportVolume(const_cast<float*>(frame.m_Amplitudes.data()), 0, 0, importMemoryManagement);
+  }
+
+  bool hasIntensityImage = false;
+  m_ToFCameraDevice->GetBoolProperty("HasIntensityImage", hasIntensityImage);
+  if (hasIntensityImage && frame.m_Intensities.size() == static_cast<size_t>(m_PixelNumber))
+  {
+    this->GetOutput(2)->SetImportVolume(const_cast<float*>(frame.m_Intensities.data()), 0, 0, importMemoryManagement);
+  }
+
+  bool hasRGBImage = false;
+  m_ToFCameraDevice->GetBoolProperty("HasRGBImage", hasRGBImage);
+  if (hasRGBImage && frame.m_RGBData.size() == static_cast<size_t>(m_RGBPixelNumber) * 3)
+  {
+    this->GetOutput(3)->SetImportVolume(const_cast<unsigned char*>(frame.m_RGBData.data()), 0, 0, importMemoryManagement);
+  }
+}
+
 bool ToFImageGrabber::ConnectCamera()
 {
   bool ok = m_ToFCameraDevice->ConnectCamera();
@@ -120,6 +174,7 @@ bool ToFImageGrabber::ConnectCamera()
     this->m_SourceDataSize = m_ToFCameraDevice->GetSourceDataSize();
     this->AllocateImageArrays();
     this->InitializeImages();
+    m_OutputsReferenceFrame = false;
   }
   return ok;
 }
@@ -33,6 +33,11 @@ namespace mitk
   *
   * Provided images include: distance image (output 0), amplitude image (output 1), intensity image (output 2)
   *
+  * If the device supports the frame exchange (ToFCameraDevice::SupportsFrameExchange()), the newest complete
+  * frame is taken over from the acquisition thread without blocking it, and the outputs reference the image
+  * data of this frame instead of copying it. The referenced data stays valid until the next update of the
+  * grabber; in case the grabber is destroyed, the outputs receive their own copy of the last frame.
+  *
   * \ingroup ToFHardware
   */
   class MITKTOFHARDWARE_EXPORT ToFImageGrabber : public mitk::ToFImageSource
@@ -176,6 +181,12 @@ namespace mitk
      */
     void InitializeImages();
 
+    /*!
+    \brief Sets the data of the frame last acquired from the device to the outputs.
+    \param importMemoryManagement ReferenceMemory to let the outputs reference the frame, CopyMemory to detach them from it
+    */
+    void SetAcquiredFrameToOutputs(Image::ImportMemoryManagementType importMemoryManagement);
+
     ToFCameraDevice::Pointer m_ToFCameraDevice; ///< Device allowing access to ToF image data
     int m_CaptureWidth; ///< Width of the captured ToF image
     int m_CaptureHeight; ///< Height of the captured ToF image
@@ -191,6 +202,7 @@ namespace mitk
     char* m_SourceDataArray;///< member holding the current source data array
     unsigned char* m_RgbDataArray; ///< member holding the current rgb data array
     unsigned long m_DeviceObserverTag; ///< tag of the observer for the ToFCameraDevice
+    bool m_OutputsReferenceFrame; ///< true if the outputs reference the frame last acquired from the device
     ToFImageGrabber();
 
     ~ToFImageGrabber() override;
@@ -21,6 +21,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkEventObject.h>
 #pragma GCC visibility pop
 
+#include <algorithm>
+#include <chrono>
+
 namespace mitk
 {
 ToFImageRecorder::ToFImageRecorder()
@@ -56,10 +59,21 @@ ToFImageRecorder::ToFImageRecorder()
   this->m_IntensityArray = nullptr;
   this->m_RGBArray = nullptr;
   this->m_SourceDataArray = nullptr;
+  this->m_BufferSize = 30;
+  this->m_WriteBatchSize = 8;
+  this->m_CompressDistanceImage = false;
+  this->m_FirstBufferedFrame = 0;
+  this->m_NumberOfBufferedFrames = 0;
+  this->m_StopWriting = false;
+  this->m_NumberOfDroppedFrames = 0;
+  this->m_NumberOfWrittenFrames = 0;
+  this->m_WrittenBytes = 0.0;
+  this->m_WriteTime = 0.0;
 }
 
 ToFImageRecorder::~ToFImageRecorder()
 {
+  this->StopWriterThread();
   delete[] m_DistanceArray;
   delete[] m_AmplitudeArray;
   delete[] m_IntensityArray;
@@ -89,7 +103,9 @@ void ToFImageRecorder::StartRecording()
   }
   else if(this->m_FileFormat.compare(".nrrd") == 0)
   {
-    this->m_ToFImageWriter = ToFNrrdImageWriter::New();
+    ToFNrrdImageWriter::Pointer nrrdImageWriter = ToFNrrdImageWriter::New();
+    nrrdImageWriter->SetCompressDistanceImage(this->m_CompressDistanceImage);
+    this->m_ToFImageWriter = nrrdImageWriter;
     this->m_ToFImageWriter->SetExtension(m_FileFormat);
   }
   else
@@ -144,12 +160,116 @@ void ToFImageRecorder::StartRecording()
   this->m_ToFImageWriter->SetRGBImageSelected(this->m_RGBImageSelected);
   this->m_ToFImageWriter->Open();
 
+  this->StartWriterThread();
+
   this->m_AbortMutex->Lock();
   this->m_Abort = false;
   this->m_AbortMutex->Unlock();
   this->m_ThreadID = this->m_MultiThreader->SpawnThread(this->RecordData, this);
 }
 
+void ToFImageRecorder::StartWriterThread()
+{
+  this->StopWriterThread();
+
+  std::lock_guard<std::mutex> lock(m_BufferMutex);
+  m_NumberOfDroppedFrames = 0;
+  m_NumberOfWrittenFrames = 0;
+  m_WrittenBytes = 0.0;
+  m_WriteTime = 0.0;
+  m_FirstBufferedFrame = 0;
+  m_NumberOfBufferedFrames = 0;
+  m_StopWriting = false;
+
+  m_FrameBuffer.resize(std::max(m_BufferSize, 0));
+  for (FrameBufferSlot& slot : m_FrameBuffer)
+  {
+    slot.m_Distance.resize(m_DistanceImageSelected ? m_ToFPixelNumber : 0);
+    slot.m_Amplitude.resize(m_AmplitudeImageSelected ? m_ToFPixelNumber : 0);
+    slot.m_Intensity.resize(m_IntensityImageSelected ? m_ToFPixelNumber : 0);
+    slot.m_RGB.resize(m_RGBImageSelected ? m_RGBPixelNumber * 3 : 0);
+  }
+
+  if (!m_FrameBuffer.empty())
+  {
+    m_WriterThread = std::thread(&ToFImageRecorder::WriteBufferedFrames, this);
+  }
+}
+
+void ToFImageRecorder::StopWriterThread()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_BufferMutex);
+    m_StopWriting = true;
+  }
+  m_FrameBuffered.notify_one();
+  if (m_WriterThread.joinable())
+  {
+    m_WriterThread.join();
+  }
+}
+
+void ToFImageRecorder::WriteBufferedFrames()
+{
+  const int bufferSize = static_cast<int>(m_FrameBuffer.size());
+  std::unique_lock<std::mutex> lock(m_BufferMutex);
+  for (;;)
+  {
+    m_FrameBuffered.wait(lock, [this] { return m_NumberOfBufferedFrames > 0 || m_StopWriting; });
+    if (m_NumberOfBufferedFrames == 0)
+    {
+      return; // stopped and all frames are written
+    }
+
+    // the slots of the batch are not touched by the recording thread until they are released below
+    const int first = m_FirstBufferedFrame;
+    const int count = std::min(m_NumberOfBufferedFrames, std::max(m_WriteBatchSize, 1));
+    lock.unlock();
+    for (int i = 0; i < count; ++i)
+    {
+      FrameBufferSlot& slot = m_FrameBuffer[(first + i) % bufferSize];
+      this->WriteFrame(slot.m_Distance.data(), slot.m_Amplitude.data(), slot.m_Intensity.data(), slot.m_RGB.data());
+    }
+    lock.lock();
+    m_FirstBufferedFrame = (first + count) % bufferSize;
+    m_NumberOfBufferedFrames -= count;
+  }
+}
+
+void ToFImageRecorder::WriteFrame(float* distanceArray, float* amplitudeArray, float* intensityArray, unsigned char* rgbArray)
+{
+  const auto start = std::chrono::steady_clock::now();
+  this->m_ToFImageWriter->Add(distanceArray, amplitudeArray, intensityArray, rgbArray);
+  const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+  const int numberOfToFImages = m_DistanceImageSelected + m_AmplitudeImageSelected + m_IntensityImageSelected;
+  const double bytes = static_cast<double>(numberOfToFImages) * m_ToFPixelNumber * sizeof(float) +
+                       (m_RGBImageSelected ? m_RGBPixelNumber * 3.0 : 0.0);
+
+  std::lock_guard<std::mutex> lock(m_BufferMutex);
+  ++m_NumberOfWrittenFrames;
+  m_WrittenBytes += bytes;
+  m_WriteTime += duration.count();
+}
+
+unsigned long ToFImageRecorder::GetNumberOfDroppedFrames() const
+{
+  std::lock_guard<std::mutex> lock(m_BufferMutex);
+  return m_NumberOfDroppedFrames;
+}
+
+unsigned long ToFImageRecorder::GetNumberOfWrittenFrames() const
+{
+  std::lock_guard<std::mutex> lock(m_BufferMutex);
+  return m_NumberOfWrittenFrames;
+}
+
+double ToFImageRecorder::GetWriteThroughput() const
+{
+  std::lock_guard<std::mutex> lock(m_BufferMutex);
+  return m_WriteTime > 0.0 ? m_WrittenBytes / (1024.0 * 1024.0) / m_WriteTime : 0.0;
+}
+
 void ToFImageRecorder::WaitForThreadBeingTerminated()
 {
   this->m_MultiThreader->TerminateThread(this->m_ThreadID);
@@ -192,18 +312,56 @@ ITK_THREAD_RETURN_TYPE ToFImageRecorder::RecordData(void* pInfoStruct)
            (toFImageRecorder->m_RecordMode == ToFImageRecorder::Infinite) )
       {
 
-        toFCameraDevice->GetAllImages(toFImageRecorder->m_DistanceArray, toFImageRecorder->m_AmplitudeArray,
-                                      toFImageRecorder->m_IntensityArray, toFImageRecorder->m_SourceDataArray, requiredImageSequence, toFImageRecorder->m_ImageSequence, toFImageRecorder->m_RGBArray );
+        // acquire directly into the next free slot of the ring buffer, if there is one
+        ToFImageRecorder::FrameBufferSlot* slot = nullptr;
+        if (!toFImageRecorder->m_FrameBuffer.empty())
+        {
+          std::lock_guard<std::mutex> lock(toFImageRecorder->m_BufferMutex);
+          const int bufferSize = static_cast<int>(toFImageRecorder->m_FrameBuffer.size());
+          if (toFImageRecorder->m_NumberOfBufferedFrames < bufferSize)
+          {
+            slot = &toFImageRecorder->m_FrameBuffer[(toFImageRecorder->m_FirstBufferedFrame + toFImageRecorder->m_NumberOfBufferedFrames) % bufferSize];
+          }
+        }
+        // images which are not recorded are acquired into the arrays of the recorder
+        float* distanceArray = (slot && !slot->m_Distance.empty()) ? slot->m_Distance.data() : toFImageRecorder->m_DistanceArray;
+        float* amplitudeArray = (slot && !slot->m_Amplitude.empty()) ? slot->m_Amplitude.data() : toFImageRecorder->m_AmplitudeArray;
+        float* intensityArray = (slot && !slot->m_Intensity.empty()) ? slot->m_Intensity.data() : toFImageRecorder->m_IntensityArray;
+        unsigned char* rgbArray = (slot && !slot->m_RGB.empty()) ? slot->m_RGB.data() : toFImageRecorder->m_RGBArray;
+
+        toFCameraDevice->GetAllImages(distanceArray, amplitudeArray, intensityArray, toFImageRecorder->m_SourceDataArray,
+                                      requiredImageSequence, toFImageRecorder->m_ImageSequence, rgbArray );
 
         if (toFImageRecorder->m_ImageSequence >= requiredImageSequence)
         {
+          unsigned long droppedFrames = 0;
           if (toFImageRecorder->m_ImageSequence > requiredImageSequence)
           {
             MITK_INFO << "Problem! required: " << requiredImageSequence << " captured: " << toFImageRecorder->m_ImageSequence;
+            droppedFrames = numOfFramesRecorded > 0 ? toFImageRecorder->m_ImageSequence - requiredImageSequence : 0;
           }
           requiredImageSequence = toFImageRecorder->m_ImageSequence + 1;
-          toFImageRecorder->m_ToFImageWriter->Add( toFImageRecorder->m_DistanceArray,
-                                                   toFImageRecorder->m_AmplitudeArray, toFImageRecorder->m_IntensityArray, toFImageRecorder->m_RGBArray );
+          if (toFImageRecorder->m_FrameBuffer.empty())
+          {
+            toFImageRecorder->WriteFrame(distanceArray, amplitudeArray, intensityArray, rgbArray);
+          }
+          else if (slot)
+          {
+            {
+              std::lock_guard<std::mutex> lock(toFImageRecorder->m_BufferMutex);
+              ++toFImageRecorder->m_NumberOfBufferedFrames;
+            }
+            toFImageRecorder->m_FrameBuffered.notify_one();
+          }
+          else
+          {
+            ++droppedFrames; // the writer does not keep up, the buffer is full
+          }
+          if (droppedFrames > 0)
+          {
+            std::lock_guard<std::mutex> lock(toFImageRecorder->m_BufferMutex);
+            toFImageRecorder->m_NumberOfDroppedFrames += droppedFrames;
+          }
           numOfFramesRecorded++;
           if (numOfFramesRecorded % n == 0)
           {
@@ -227,6 +385,8 @@ ITK_THREAD_RETURN_TYPE ToFImageRecorder::RecordData(void* pInfoStruct)
       }
     }  // end of while loop
 
+    toFImageRecorder->StopWriterThread();
+
     toFImageRecorder->InvokeEvent(itk::AbortEvent());
 
     toFImageRecorder->m_ToFImageWriter->Close();
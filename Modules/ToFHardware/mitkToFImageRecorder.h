@@ -27,6 +27,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkFastMutexLock.h>
 #include <itkCommand.h>
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace mitk
 {
 /**
@@ -37,9 +42,16 @@ namespace mitk
   *
   * Recording can be performed either frame-based or continuously.
   *
+  * Acquisition and writing are decoupled by a ring buffer of BufferSize frames: the recording thread acquires
+  * the images directly into a free slot of the buffer, while a separate writer thread passes the buffered frames
+  * in batches of up to WriteBatchSize frames to the ToFImageWriter. A stalling disk therefore only fills the
+  * buffer instead of delaying the acquisition. If the buffer is full, the acquired frame is dropped.
+  * With a BufferSize of 0, the frames are written by the recording thread itself.
+  * The number of dropped and written frames and the write throughput can be queried during and after recording.
+  *
   * @warning It is currently not guaranteed that all acquired images are recorded, since the recording
   * is done in a newly spawned thread. However, in practise only very few images are lost. See bug #12997
-  * for more details.
+  * for more details. Lost frames are counted by GetNumberOfDroppedFrames().
   *
   * @ingroup ToFHardware
   */
@@ -82,6 +94,32 @@ public:
   itkSetMacro( NumOfFrames, int );
   itkSetMacro( FileFormat, std::string );
 
+  /** Number of frames the ring buffer between acquisition and writing can hold. 0 disables the buffer. Default: 30 */
+  itkSetMacro( BufferSize, int );
+  itkGetMacro( BufferSize, int );
+  /** Maximum number of frames the writer thread takes from the buffer at once. Default: 8 */
+  itkSetMacro( WriteBatchSize, int );
+  itkGetMacro( WriteBatchSize, int );
+  /** If true, distance images are losslessly compressed while recording (see ToFNrrdImageWriter). Default: false */
+  itkSetMacro( CompressDistanceImage, bool );
+  itkGetMacro( CompressDistanceImage, bool );
+  itkBooleanMacro( CompressDistanceImage );
+
+  /*!
+    \brief Returns the number of frames of the current/last recording that were not recorded, either because
+    the buffer was full or because the device delivered frames faster than they were acquired
+    */
+  unsigned long GetNumberOfDroppedFrames() const;
+  /*!
+    \brief Returns the number of frames of the current/last recording passed to the ToFImageWriter
+    */
+  unsigned long GetNumberOfWrittenFrames() const;
+  /*!
+    \brief Returns the average rate in MB/s at which the image data was passed to the ToFImageWriter, measured
+    over the time spent writing
+    */
+  double GetWriteThroughput() const;
+
   enum RecordMode{ PerFrames, Infinite };
   /*!
     \brief Returns the currently set RecordMode
@@ -133,6 +171,32 @@ protected:
     */
   static ITK_THREAD_RETURN_TYPE RecordData(void* pInfoStruct);
 
+  /** One frame of the ring buffer. Only the arrays of the selected images are allocated. */
+  struct FrameBufferSlot
+  {
+    std::vector<float> m_Distance;
+    std::vector<float> m_Amplitude;
+    std::vector<float> m_Intensity;
+    std::vector<unsigned char> m_RGB;
+  };
+
+  /*!
+    \brief Allocates the ring buffer and starts the writer thread
+    */
+  void StartWriterThread();
+  /*!
+    \brief Lets the writer thread write the remaining buffered frames and waits until it terminated
+    */
+  void StopWriterThread();
+  /*!
+    \brief Thread method writing the buffered frames via the ToFImageWriter
+    */
+  void WriteBufferedFrames();
+  /*!
+    \brief Passes the given frame to the ToFImageWriter and updates the statistics. Called with unlocked m_BufferMutex.
+    */
+  void WriteFrame(float* distanceArray, float* amplitudeArray, float* intensityArray, unsigned char* rgbArray);
+
   // data acquisition
   ToFCameraDevice::Pointer m_ToFCameraDevice; ///< ToFCameraDevice used for acquiring the images
   int m_ToFCaptureWidth; ///< width (x-dimension) of the images to record.
@@ -173,6 +237,22 @@ protected:
   itk::FastMutexLock::Pointer m_AbortMutex; ///< mutex for thread-safe data access of abort flag
   bool m_Abort; ///< flag controlling the abort mechanism of the recording procedure. For thread-safety only use in combination with m_AbortMutex
 
+  // buffered writing
+  int m_BufferSize; ///< number of frames of the ring buffer
+  int m_WriteBatchSize; ///< maximum number of frames written at once by the writer thread
+  bool m_CompressDistanceImage; ///< flag indicating if distance images are compressed while recording
+  std::vector<FrameBufferSlot> m_FrameBuffer; ///< ring buffer of acquired frames
+  int m_FirstBufferedFrame; ///< index of the oldest frame in m_FrameBuffer that was not written yet
+  int m_NumberOfBufferedFrames; ///< number of frames in m_FrameBuffer waiting to be written
+  bool m_StopWriting; ///< flag telling the writer thread to terminate once the buffer is empty
+  std::thread m_WriterThread; ///< thread writing the buffered frames
+  mutable std::mutex m_BufferMutex; ///< mutex for the ring buffer state and the statistics
+  std::condition_variable m_FrameBuffered; ///< signals the writer thread that frames were buffered or writing should stop
+  unsigned long m_NumberOfDroppedFrames; ///< number of frames that were not recorded. Only use in combination with m_BufferMutex
+  unsigned long m_NumberOfWrittenFrames; ///< number of frames passed to the writer. Only use in combination with m_BufferMutex
+  double m_WrittenBytes; ///< image data passed to the writer in bytes. Only use in combination with m_BufferMutex
+  double m_WriteTime; ///< time spent writing in seconds. Only use in combination with m_BufferMutex
+
 private:
 
 };
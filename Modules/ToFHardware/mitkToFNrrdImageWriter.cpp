@@ -19,11 +19,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 // itk includes
 #include "itksys/SystemTools.hxx"
 #include "itkNrrdImageIO.h"
+#include "itk_zlib.h"
+
+#include <cstring>
 
 namespace mitk
 {
   ToFNrrdImageWriter::ToFNrrdImageWriter(): ToFImageWriter(),
-    m_DistanceOutfile(), m_AmplitudeOutfile(), m_IntensityOutfile()
+    m_DistanceOutfile(), m_AmplitudeOutfile(), m_IntensityOutfile(), m_CompressDistanceImage(false)
   {
     m_Extension = std::string(".nrrd");
   }
@@ -62,6 +65,7 @@ namespace mitk
       this->OpenStreamFile(this->m_RGBOutfile, this->m_RGBImageFileName);
     }
     this->m_NumOfFrames = 0;
+    this->m_PreviousDistanceFrame.assign(this->m_CompressDistanceImage ? this->m_ToFPixelNumber : 0, 0);
   }
 
   void ToFNrrdImageWriter::Close()
@@ -88,7 +92,14 @@ namespace mitk
   {
     if (this->m_DistanceImageSelected)
     {
-      this->m_DistanceOutfile.write( (char*) distanceFloatData, this->m_ToFImageSizeInBytes);
+      if (this->m_CompressDistanceImage)
+      {
+        this->WriteCompressedDistanceFrame(distanceFloatData);
+      }
+      else
+      {
+        this->m_DistanceOutfile.write( (char*) distanceFloatData, this->m_ToFImageSizeInBytes);
+      }
     }
     if (this->m_AmplitudeImageSelected)
     {
@@ -105,6 +116,65 @@ namespace mitk
     this->m_NumOfFrames++;
   }
 
+  void ToFNrrdImageWriter::WriteCompressedDistanceFrame(const float* distanceFloatData)
+  {
+    const int pixelNumber = this->m_ToFPixelNumber;
+    this->m_DeltaBuffer.resize(this->m_ToFImageSizeInBytes);
+    unsigned char* delta = this->m_DeltaBuffer.data();
+    for (int i = 0; i < pixelNumber; ++i)
+    {
+      unsigned int bits;
+      std::memcpy(&bits, &distanceFloatData[i], sizeof(bits));
+      const unsigned int difference = bits ^ this->m_PreviousDistanceFrame[i];
+      this->m_PreviousDistanceFrame[i] = bits;
+      delta[i] = static_cast<unsigned char>(difference);
+      delta[pixelNumber + i] = static_cast<unsigned char>(difference >> 8);
+      delta[2 * pixelNumber + i] = static_cast<unsigned char>(difference >> 16);
+      delta[3 * pixelNumber + i] = static_cast<unsigned char>(difference >> 24);
+    }
+
+    uLongf compressedSize = compressBound(this->m_ToFImageSizeInBytes);
+    this->m_CompressedBuffer.resize(compressedSize);
+    if (compress2(this->m_CompressedBuffer.data(), &compressedSize, delta, this->m_ToFImageSizeInBytes, Z_BEST_SPEED) != Z_OK)
+    {
+      throw std::logic_error("Error compressing distance image.");
+    }
+    const unsigned int frameSize = static_cast<unsigned int>(compressedSize);
+    this->m_DistanceOutfile.write((char*)&frameSize, sizeof(frameSize));
+    this->m_DistanceOutfile.write((char*)this->m_CompressedBuffer.data(), frameSize);
+  }
+
+  bool ToFNrrdImageWriter::ReadCompressedDistanceFrames(std::ifstream& stream, float* data)
+  {
+    const int pixelNumber = this->m_ToFPixelNumber;
+    std::vector<unsigned int> previous(pixelNumber, 0);
+    this->m_DeltaBuffer.resize(this->m_ToFImageSizeInBytes);
+    const unsigned char* delta = this->m_DeltaBuffer.data();
+    for (int frame = 0; frame < this->m_NumOfFrames; ++frame)
+    {
+      unsigned int frameSize = 0;
+      stream.read((char*)&frameSize, sizeof(frameSize));
+      this->m_CompressedBuffer.resize(frameSize);
+      stream.read((char*)this->m_CompressedBuffer.data(), frameSize);
+      uLongf size = this->m_ToFImageSizeInBytes;
+      if (!stream || uncompress(this->m_DeltaBuffer.data(), &size, this->m_CompressedBuffer.data(), frameSize) != Z_OK ||
+          size != static_cast<uLongf>(this->m_ToFImageSizeInBytes))
+      {
+        return false;
+      }
+
+      float* frameData = data + static_cast<std::size_t>(frame) * pixelNumber;
+      for (int i = 0; i < pixelNumber; ++i)
+      {
+        const unsigned int difference = delta[i] | (delta[pixelNumber + i] << 8) |
+                                        (delta[2 * pixelNumber + i] << 16) | (static_cast<unsigned int>(delta[3 * pixelNumber + i]) << 24);
+        previous[i] ^= difference;
+        std::memcpy(&frameData[i], &previous[i], sizeof(float));
+      }
+    }
+    return true;
+  }
+
   void ToFNrrdImageWriter::OpenStreamFile( std::ofstream &outfile, std::string outfileName )
   {
     outfile.open(outfileName.c_str(), std::ofstream::binary);
@@ -251,7 +321,22 @@ namespace mitk
       unsigned int size = PixelNumber * this->m_NumOfFrames;
       unsigned int sizeInBytes = size * sizeof(float);
       float* data = new float[size];
-      stream.read((char*)data, sizeInBytes);
+      if (this->m_CompressDistanceImage && fileName == this->m_DistanceImageFileName)
+      {
+        if (!this->ReadCompressedDistanceFrames(stream, data))
+        {
+          MITK_ERROR << "Compressed distance data in " << fileName << " is corrupt.";
+          stream.close();
+          delete[] data;
+          delete[] dimensions;
+          delete[] floatData;
+          return;
+        }
+      }
+      else
+      {
+        stream.read((char*)data, sizeInBytes);
+      }
       try
       {
         nrrdWriter->Write(data);
@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkToFImageWriter.h"
 
 #include <fstream>
+#include <vector>
 
 namespace mitk
 {
@@ -30,6 +31,12 @@ namespace mitk
   * Writer can simultaneously save "distance", "intensity" and "amplitude" image.
   * Images can be written as 3D volume (ToFImageType::ToFImageType3D) or temporal image stack (ToFImageType::ToFImageType2DPlusT)
   *
+  * If CompressDistanceImage is enabled, the distance frames are streamed losslessly compressed to reduce the amount of
+  * data written while recording: every frame is delta coded against the previous one (XOR of the float bit patterns,
+  * which is zero for unchanged pixels), the bytes are regrouped by significance and the result is deflated with the
+  * fastest zlib level. The frames are decompressed when the nrrd file is completed in Close(), so the resulting
+  * file does not differ from an uncompressed recording.
+  *
   * @ingroup ToFHardware
   */
   class MITKTOFHARDWARE_EXPORT ToFNrrdImageWriter : public ToFImageWriter
@@ -39,6 +46,11 @@ namespace mitk
     itkFactorylessNewMacro(Self)
     itkCloneMacro(Self)
 
+    /** If true, distance frames are compressed while recording. Must be set before Open(). Default: false */
+    itkSetMacro( CompressDistanceImage, bool );
+    itkGetMacro( CompressDistanceImage, bool );
+    itkBooleanMacro( CompressDistanceImage );
+
     /*!
     \brief Open file(s) for writing
     */
@@ -59,6 +71,11 @@ namespace mitk
     std::ofstream m_IntensityOutfile; ///< file for intensity image
     std::ofstream m_RGBOutfile; ///< file for intensity image
 
+    bool m_CompressDistanceImage; ///< flag indicating if distance frames are compressed while recording
+    std::vector<unsigned int> m_PreviousDistanceFrame; ///< bit patterns of the last distance frame, reference of the delta coding
+    std::vector<unsigned char> m_DeltaBuffer; ///< delta coded frame with bytes grouped by significance
+    std::vector<unsigned char> m_CompressedBuffer; ///< deflated frame
+
   private:
 
     ToFNrrdImageWriter();
@@ -76,6 +93,15 @@ namespace mitk
     \brief Write image information to the NrrdFile.
     */
     void ConvertStreamToNrrdFormat( std::string fileName );
+    /*!
+    \brief Compresses a distance frame and writes it with its size to the distance stream.
+    */
+    void WriteCompressedDistanceFrame(const float* distanceFloatData);
+    /*!
+    \brief Reads and decompresses m_NumOfFrames distance frames from stream into data.
+    \return false if the stream is corrupt
+    */
+    bool ReadCompressedDistanceFrames(std::ifstream& stream, float* data);
   };
 } //END mitk namespace
 #endif // __mitkToFNrrdImageWriter_h
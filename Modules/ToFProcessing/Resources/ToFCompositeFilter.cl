@@ -0,0 +1,153 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#define MAX_TEMPORAL_WINDOW 32
+
+/* temporal modes */
+#define TEMPORAL_NONE 0
+#define TEMPORAL_MEDIAN 1
+#define TEMPORAL_AVERAGE 2
+
+/*
+  Threshold, mask segmentation and temporal filter of one pixel. The history holds windowSize frames, frame-major,
+  the new value is written at windowIndex. frameCount is the number of valid frames including the new one.
+*/
+__kernel void ckSegmentationAndTemporalFilter(
+  __global const float* dInput,
+  __global const char* dMask,
+  __global float* dHistory,
+  __global float* dOutput,
+  int width, int height,
+  int useMask, int applyThreshold, float thresholdMin, float thresholdMax,
+  int temporalMode, int windowIndex, int frameCount
+)
+{
+  const int x = get_global_id(0);
+  const int y = get_global_id(1);
+  if ( x >= width || y >= height )
+    return;
+
+  const int size = width * height;
+  const int i = y * width + x;
+
+  float value = dInput[i];
+  if ( applyThreshold && ( value <= thresholdMin || value >= thresholdMax ) )
+    value = 0.0f;
+  if ( useMask && dMask[i] == 0 )
+    value = 0.0f;
+
+  if ( temporalMode != TEMPORAL_NONE )
+  {
+    dHistory[windowIndex * size + i] = value;
+
+    if ( temporalMode == TEMPORAL_AVERAGE )
+    {
+      float sum = 0.0f;
+      for ( int k = 0; k < frameCount; ++k )
+        sum += dHistory[k * size + i];
+      value = sum / frameCount;
+    }
+    else
+    {
+      // insertion sort of the window, the lower median is returned like by the CPU implementation
+      float window[MAX_TEMPORAL_WINDOW];
+      for ( int k = 0; k < frameCount; ++k )
+      {
+        const float v = dHistory[k * size + i];
+        int p = k;
+        while ( p > 0 && window[p - 1] > v )
+        {
+          window[p] = window[p - 1];
+          --p;
+        }
+        window[p] = v;
+      }
+      value = window[(frameCount - 1) / 2];
+    }
+  }
+
+  dOutput[i] = value;
+}
+
+inline void sortPair(float* a, float* b)
+{
+  const float minimum = fmin(*a, *b);
+  *b = fmax(*a, *b);
+  *a = minimum;
+}
+
+/* 3x3 median filter with replicated borders */
+__kernel void ckMedianFilter(
+  __global const float* dSource,
+  __global float* dDest,
+  int width, int height
+)
+{
+  const int x = get_global_id(0);
+  const int y = get_global_id(1);
+  if ( x >= width || y >= height )
+    return;
+
+  float p[9];
+  for ( int r = -1; r <= 1; ++r )
+  {
+    const int row = clamp(y + r, 0, height - 1) * width;
+    for ( int c = -1; c <= 1; ++c )
+    {
+      p[3 * (r + 1) + c + 1] = dSource[row + clamp(x + c, 0, width - 1)];
+    }
+  }
+
+  sortPair(&p[1], &p[2]); sortPair(&p[4], &p[5]); sortPair(&p[7], &p[8]);
+  sortPair(&p[0], &p[1]); sortPair(&p[3], &p[4]); sortPair(&p[6], &p[7]);
+  sortPair(&p[1], &p[2]); sortPair(&p[4], &p[5]); sortPair(&p[7], &p[8]);
+  sortPair(&p[0], &p[3]); sortPair(&p[5], &p[8]); sortPair(&p[4], &p[7]);
+  sortPair(&p[3], &p[6]); sortPair(&p[1], &p[4]); sortPair(&p[2], &p[5]);
+  sortPair(&p[4], &p[7]); sortPair(&p[4], &p[2]); sortPair(&p[6], &p[4]);
+  sortPair(&p[4], &p[2]);
+
+  dDest[y * width + x] = p[4];
+}
+
+/* one direction of the separable bilateral filter, vertical != 0 filters along y */
+__kernel void ckBilateralFilter(
+  __global const float* dSource,
+  __global float* dDest,
+  int width, int height, int vertical, int radius,
+  float domainFactor, float rangeFactor // -0.5 / sigma^2
+)
+{
+  const int x = get_global_id(0);
+  const int y = get_global_id(1);
+  if ( x >= width || y >= height )
+    return;
+
+  const float centerValue = dSource[y * width + x];
+  float sum = 0.0f;
+  float weightSum = 0.0f;
+  for ( int k = -radius; k <= radius; ++k )
+  {
+    const int index = vertical ? clamp(y + k, 0, height - 1) * width + x
+                               : y * width + clamp(x + k, 0, width - 1);
+    const float value = dSource[index];
+    const float difference = value - centerValue;
+    const float weight = native_exp( domainFactor * k * k + rangeFactor * difference * difference );
+    sum += weight * value;
+    weightSum += weight;
+  }
+
+  dDest[y * width + x] = sum / weightSum;
+}
@@ -193,6 +193,59 @@ bool CreateRandomDistanceImageStack(unsigned int dimX, unsigned int dimY, unsign
 }
 
 
+/**
+* Compares the fused, multi-threaded pipeline with the default pipeline over a sequence of frames and checks
+* that the separable bilateral filter preserves a constant image.
+*/
+static void TestParallelProcessing()
+{
+  mitk::ToFCompositeFilter::Pointer referenceFilter = mitk::ToFCompositeFilter::New();
+  mitk::ToFCompositeFilter::Pointer parallelFilter = mitk::ToFCompositeFilter::New();
+  parallelFilter->UseParallelProcessingOn();
+  MITK_TEST_CONDITION_REQUIRED(parallelFilter->GetUseParallelProcessing(), "Get/Set UseParallelProcessing");
+
+  mitk::ToFCompositeFilter::Pointer filters[] = { referenceFilter, parallelFilter };
+  for (mitk::ToFCompositeFilter::Pointer filter : filters)
+  {
+    filter->SetThresholdFilterParameter(100, 900);
+    filter->SetTemporalMedianFilterParameter(5);
+    filter->SetApplyThresholdFilter(true);
+    filter->SetApplyTemporalMedianFilter(true);
+    filter->SetApplyMedianFilter(true);
+  }
+
+  bool equal = true;
+  for (unsigned int frame = 0; frame < 8; ++frame)
+  {
+    ItkImageType_2D::Pointer itkInputImage = ItkImageType_2D::New();
+    mitk::Image::Pointer mitkInputImage = mitk::Image::New();
+    CreateRandomDistanceImage(64,48,itkInputImage,mitkInputImage);
+    for (mitk::ToFCompositeFilter::Pointer filter : filters)
+    {
+      filter->SetInput(mitkInputImage);
+      filter->Update();
+    }
+    equal = equal && mitk::Equal(*referenceFilter->GetOutput(), *parallelFilter->GetOutput(), mitk::eps, true);
+  }
+  MITK_TEST_CONDITION_REQUIRED(equal, "Parallel threshold, temporal median and median filter equal the default pipeline");
+
+  // an edge preserving filter must not change a constant image
+  ItkImageType_2D::Pointer itkConstantImage = ItkImageType_2D::New();
+  mitk::Image::Pointer mitkConstantImage = mitk::Image::New();
+  CreateRandomDistanceImage(32,32,itkConstantImage,mitkConstantImage);
+  itkConstantImage->FillBuffer(500.0);
+  mitk::CastToMitkImage(itkConstantImage,mitkConstantImage);
+
+  parallelFilter = mitk::ToFCompositeFilter::New();
+  parallelFilter->UseParallelProcessingOn();
+  parallelFilter->SetApplyBilateralFilter(true);
+  parallelFilter->SetBilateralFilterParameter(2, 60, 0);
+  parallelFilter->SetInput(mitkConstantImage);
+  parallelFilter->Update();
+  MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*mitkConstantImage, *parallelFilter->GetOutput(), 1e-3, true),
+                               "Parallel bilateral filter preserves a constant image");
+}
+
 int mitkToFCompositeFilterTest(int /* argc */, char* /*argv*/[])
 {
   MITK_TEST_BEGIN("ToFCompositeFilter");
@@ -345,6 +398,8 @@ int mitkToFCompositeFilterTest(int /* argc */, char* /*argv*/[])
 
 //-------------------------------------------------------------------------------------------------------
 
+  TestParallelProcessing();
+
   MITK_TEST_END();
 
 }
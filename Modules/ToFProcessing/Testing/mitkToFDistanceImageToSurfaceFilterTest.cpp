@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mitkImage.h>
 #include <mitkImagePixelReadAccessor.h>
+#include <mitkImagePixelWriteAccessor.h>
 #include <mitkImageGenerator.h>
 #include <mitkSurface.h>
 #include <mitkToFProcessingCommon.h>
@@ -30,6 +31,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkPolyData.h>
 #include <vtkSmartPointer.h>
 
+#include <cmath>
+
 /**
  *  @brief Test for the class "ToFDistanceImageToSurfaceFilter".
  */
@@ -38,6 +41,41 @@ typedef mitk::ToFProcessingCommon::ToFPoint2D ToFPoint2D;
 typedef mitk::ToFProcessingCommon::ToFPoint3D ToFPoint3D;
 typedef mitk::ToFProcessingCommon::ToFScalarType ToFScalarType;
 
+/** compares the output of the incremental mesh update with the output of a new default filter */
+static bool IncrementalMeshEqualsDefaultMesh(mitk::ToFDistanceImageToSurfaceFilter* incrementalFilter, mitk::Image* image)
+{
+  mitk::ToFDistanceImageToSurfaceFilter::Pointer defaultFilter = mitk::ToFDistanceImageToSurfaceFilter::New();
+  defaultFilter->SetCameraIntrinsics(incrementalFilter->GetCameraIntrinsics());
+  defaultFilter->SetInterPixelDistance(incrementalFilter->GetInterPixelDistance());
+  defaultFilter->SetReconstructionMode(incrementalFilter->GetReconstructionMode());
+  defaultFilter->SetInput(image);
+  defaultFilter->Update();
+  incrementalFilter->Update();
+
+  vtkPolyData* expected = defaultFilter->GetOutput()->GetVtkPolyData();
+  vtkPolyData* result = incrementalFilter->GetOutput()->GetVtkPolyData();
+  if (expected->GetNumberOfPolys() != result->GetNumberOfPolys() || expected->GetNumberOfVerts() != result->GetNumberOfVerts())
+    return false;
+
+  //point IDs of the incremental mesh are the pixel IDs
+  vtkSmartPointer<vtkIdList> vertexIdList = defaultFilter->GetVertexIdList();
+  mitk::ImagePixelReadAccessor<float,2> readAccess(image, image->GetSliceData());
+  const float* distances = readAccess.GetData();
+  for (vtkIdType pixelID = 0; pixelID < vertexIdList->GetNumberOfIds(); ++pixelID)
+  {
+    if (distances[pixelID] <= mitk::eps)
+      continue;
+    double* expectedPoint = expected->GetPoint(vertexIdList->GetId(pixelID));
+    double* resultPoint = result->GetPoint(pixelID);
+    for (unsigned int k = 0; k < 3; ++k)
+    {
+      if (std::abs(expectedPoint[k] - resultPoint[k]) > 1e-6)
+        return false;
+    }
+  }
+  return true;
+}
+
 int mitkToFDistanceImageToSurfaceFilterTest(int /* argc */, char* /*argv*/[])
 {
   MITK_TEST_BEGIN("ToFDistanceImageToSurfaceFilter");
@@ -379,6 +417,32 @@ int mitkToFDistanceImageToSurfaceFilterTest(int /* argc */, char* /*argv*/[])
   }
   MITK_TEST_CONDITION_REQUIRED(compareToInput,"Testing backward transformation compared to original image with interpixeldistance");
 
+  // test incremental mesh update
+  mitk::ToFDistanceImageToSurfaceFilter::Pointer incrementalFilter = mitk::ToFDistanceImageToSurfaceFilter::New();
+  incrementalFilter->SetCameraIntrinsics(cameraIntrinsics);
+  incrementalFilter->SetInterPixelDistance(interPixelDistance);
+  incrementalFilter->SetReconstructionMode(mitk::ToFDistanceImageToSurfaceFilter::WithInterPixelDistance);
+  incrementalFilter->IncrementalMeshUpdateOn();
+  incrementalFilter->SetInput(image);
+  MITK_TEST_CONDITION_REQUIRED(IncrementalMeshEqualsDefaultMesh(incrementalFilter, image), "Testing incremental mesh update");
+  vtkPolyData* incrementalMesh = incrementalFilter->GetOutput()->GetVtkPolyData();
+
+  // invalidate some pixels, only their triangles have to be removed
+  {
+    mitk::ImagePixelWriteAccessor<float,2> writeAccess(image, image->GetSliceData());
+    for (unsigned int i = 10; i < 20; ++i)
+    {
+      itk::Index<2> index = { { static_cast<itk::IndexValueType>(i), static_cast<itk::IndexValueType>(2*i) } };
+      writeAccess.SetPixelByIndex(index, 0.0);
+    }
+  }
+  image->Modified();
+  MITK_TEST_CONDITION_REQUIRED(IncrementalMeshEqualsDefaultMesh(incrementalFilter, image), "Testing incremental mesh update with invalid pixels");
+  MITK_TEST_CONDITION(incrementalMesh == incrementalFilter->GetOutput()->GetVtkPolyData(), "Testing that the mesh is reused");
+
+  incrementalFilter->SetReconstructionMode(mitk::ToFDistanceImageToSurfaceFilter::Kinect);
+  MITK_TEST_CONDITION_REQUIRED(IncrementalMeshEqualsDefaultMesh(incrementalFilter, image), "Testing incremental mesh update after changing the reconstruction mode");
+
   //clean up
   delete[] point;
   //  expectedResult->Delete();
@@ -6,3 +6,13 @@ set(CPP_FILES
   mitkToFProcessingCommon.cpp
   mitkToFTestingCommon.cpp
 )
+
+if(MITK_USE_OpenCL)
+  list(APPEND CPP_FILES
+    mitkOclToFCompositeFilter.cpp
+  )
+endif(MITK_USE_OpenCL)
+
+set(RESOURCE_FILES
+  ToFCompositeFilter.cl
+)
@@ -0,0 +1,286 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+#include "mitkOclToFCompositeFilter.h"
+#include "mitkOclResourceService.h"
+
+#include <mitkExceptionMacro.h>
+
+#include "usServiceReference.h"
+#include <usGetModuleContext.h>
+#include <usModuleContext.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+  /** temporal modes of ckSegmentationAndTemporalFilter */
+  enum { TemporalNone = 0, TemporalMedian = 1, TemporalAverage = 2 };
+
+  void ReleaseBuffer(cl_mem& buffer)
+  {
+    if (buffer)
+    {
+      clReleaseMemObject(buffer);
+      buffer = nullptr;
+    }
+  }
+}
+
+const int mitk::OclToFCompositeFilter::MaximumTemporalWindowSize;
+
+mitk::OclToFCompositeFilter::OclToFCompositeFilter()
+: m_ckSegmentationAndTemporalFilter( nullptr ),
+  m_ckMedianFilter( nullptr ),
+  m_ckBilateralFilter( nullptr ),
+  m_InputBuffer( nullptr ),
+  m_MaskBuffer( nullptr ),
+  m_HistoryBuffer( nullptr ),
+  m_Width( 0 ),
+  m_Height( 0 ),
+  m_TemporalWindowSize( 0 ),
+  m_TemporalFrameCount( 0 ),
+  m_TemporalWindowIndex( 0 ),
+  m_ApplyThresholdFilter( false ),
+  m_ThresholdFilterMin( 1 ),
+  m_ThresholdFilterMax( 7000 ),
+  m_ApplyTemporalMedianFilter( false ),
+  m_ApplyAverageFilter( false ),
+  m_TemporalMedianFilterNumOfFrames( 10 ),
+  m_ApplyMedianFilter( false ),
+  m_ApplyBilateralFilter( false ),
+  m_BilateralFilterDomainSigma( 2 ),
+  m_BilateralFilterRangeSigma( 60 ),
+  m_BilateralFilterKernelRadius( 5 )
+{
+  m_OutputBuffers[0] = nullptr;
+  m_OutputBuffers[1] = nullptr;
+  this->AddSourceFile("ToFCompositeFilter.cl");
+  this->m_FilterID = "ToFCompositeFilter";
+}
+
+mitk::OclToFCompositeFilter::~OclToFCompositeFilter()
+{
+  this->ReleaseBuffers();
+  cl_kernel kernels[] = { m_ckSegmentationAndTemporalFilter, m_ckMedianFilter, m_ckBilateralFilter };
+  for (cl_kernel kernel : kernels)
+  {
+    if ( kernel )
+    {
+      clReleaseKernel( kernel );
+    }
+  }
+}
+
+void mitk::OclToFCompositeFilter::ReleaseBuffers()
+{
+  ReleaseBuffer(m_InputBuffer);
+  ReleaseBuffer(m_MaskBuffer);
+  ReleaseBuffer(m_HistoryBuffer);
+  ReleaseBuffer(m_OutputBuffers[0]);
+  ReleaseBuffer(m_OutputBuffers[1]);
+  m_Width = 0;
+  m_Height = 0;
+  m_TemporalWindowSize = 0;
+  this->ResetTemporalWindow();
+}
+
+void mitk::OclToFCompositeFilter::ResetTemporalWindow()
+{
+  m_TemporalFrameCount = 0;
+  m_TemporalWindowIndex = 0;
+}
+
+void mitk::OclToFCompositeFilter::InitializeBuffers(unsigned int width, unsigned int height, int windowSize)
+{
+  if (width == m_Width && height == m_Height && windowSize == m_TemporalWindowSize && m_InputBuffer)
+    return;
+
+  this->ReleaseBuffers();
+
+  us::ServiceReference<OclResourceService> ref = us::GetModuleContext()->GetServiceReference<OclResourceService>();
+  OclResourceService* resources = us::GetModuleContext()->GetService<OclResourceService>(ref);
+
+  const std::size_t numberOfPixels = static_cast<std::size_t>(width) * height;
+  cl_int clErr = 0;
+  auto create = [&](std::size_t numberOfBytes)
+  {
+    cl_mem buffer = clCreateBuffer(resources->GetContext(), CL_MEM_READ_WRITE, std::max<std::size_t>(numberOfBytes, 1), nullptr, &clErr);
+    if (!CHECK_OCL_ERR(clErr) || !buffer)
+    {
+      this->ReleaseBuffers();
+      mitkThrow() << "Could not allocate GPU buffer of " << numberOfBytes << " bytes: " << GetOclErrorAsString(clErr);
+    }
+    return buffer;
+  };
+
+  m_InputBuffer = create(numberOfPixels * sizeof(float));
+  m_MaskBuffer = create(numberOfPixels * sizeof(char));
+  m_HistoryBuffer = create(numberOfPixels * windowSize * sizeof(float));
+  m_OutputBuffers[0] = create(numberOfPixels * sizeof(float));
+  m_OutputBuffers[1] = create(numberOfPixels * sizeof(float));
+
+  m_Width = width;
+  m_Height = height;
+  m_TemporalWindowSize = windowSize;
+}
+
+void mitk::OclToFCompositeFilter::Process(const float* input, const char* segmentationMask, float* output, unsigned int width, unsigned int height)
+{
+  //Check if context & program available
+  if (!this->Initialize())
+  {
+    us::ServiceReference<OclResourceService> ref = us::GetModuleContext()->GetServiceReference<OclResourceService>();
+    OclResourceService* resources = us::GetModuleContext()->GetService<OclResourceService>(ref);
+
+    // clean-up also the resources
+    resources->InvalidateStorage();
+    mitkThrow() <<"Filter is not initialized. Cannot update.";
+  }
+
+  const bool applyTemporalFilter = (m_ApplyTemporalMedianFilter || m_ApplyAverageFilter) && m_TemporalMedianFilterNumOfFrames > 0;
+  if (applyTemporalFilter && m_TemporalMedianFilterNumOfFrames > MaximumTemporalWindowSize)
+  {
+    mitkThrow() << "The temporal filter supports at most " << MaximumTemporalWindowSize << " frames on the GPU.";
+  }
+  this->InitializeBuffers(width, height, std::max(m_TemporalMedianFilterNumOfFrames, 0));
+
+  const std::size_t numberOfBytes = static_cast<std::size_t>(width) * height * sizeof(float);
+  cl_int clErr = clEnqueueWriteBuffer( this->m_CommandQue, m_InputBuffer, CL_FALSE, 0, numberOfBytes, input, 0, nullptr, nullptr );
+  if ( segmentationMask )
+  {
+    clErr |= clEnqueueWriteBuffer( this->m_CommandQue, m_MaskBuffer, CL_FALSE, 0, numberOfBytes / sizeof(float), segmentationMask, 0, nullptr, nullptr );
+  }
+  CHECK_OCL_ERR( clErr );
+  if ( clErr != CL_SUCCESS )
+  {
+    mitkThrow() << "Could not upload distance image: " << GetOclErrorAsString(clErr);
+  }
+
+  const cl_int clWidth = width;
+  const cl_int clHeight = height;
+  this->SetWorkingSize( 16, width, 16, height );
+
+  // threshold, mask and temporal filter, always executed since it moves the input into the output buffers
+  const cl_int useMask = segmentationMask ? 1 : 0;
+  const cl_int applyThreshold = m_ApplyThresholdFilter ? 1 : 0;
+  const cl_float thresholdMin = static_cast<cl_float>(m_ThresholdFilterMin);
+  const cl_float thresholdMax = static_cast<cl_float>(m_ThresholdFilterMax);
+  const cl_int temporalMode = !applyTemporalFilter ? TemporalNone : (m_ApplyAverageFilter ? TemporalAverage : TemporalMedian);
+  const cl_int windowIndex = m_TemporalWindowIndex;
+  const cl_int frameCount = std::min(m_TemporalFrameCount + 1, std::max(m_TemporalWindowSize, 1));
+
+  clErr  = clSetKernelArg( m_ckSegmentationAndTemporalFilter, 0, sizeof(cl_mem), &m_InputBuffer );
+  clErr |= clSetKernelArg( m_ckSegmentationAndTemporalFilter, 1, sizeof(cl_mem), &m_MaskBuffer );
+  clErr |= clSetKernelArg( m_ckSegmentationAndTemporalFilter, 2, sizeof(cl_mem), &m_HistoryBuffer );
+  clErr |= clSetKernelArg( m_ckSegmentationAndTemporalFilter, 3, sizeof(cl_mem), &m_OutputBuffers[0] );
+  clErr |= clSetKernelArg( m_ckSegmentationAndTemporalFilter, 4, sizeof(cl_int), &clWidth );
+  clErr |= clSetKernelArg( m_ckSegmentationAndTemporalFilter, 5, sizeof(cl_int), &clHeight );
+  clErr |= clSetKernelArg( m_ckSegmentationAndTemporalFilter, 6, sizeof(cl_int), &useMask );
+  clErr |= clSetKernelArg( m_ckSegmentationAndTemporalFilter, 7, sizeof(cl_int), &applyThreshold );
+  clErr |= clSetKernelArg( m_ckSegmentationAndTemporalFilter, 8, sizeof(cl_float), &thresholdMin );
+  clErr |= clSetKernelArg( m_ckSegmentationAndTemporalFilter, 9, sizeof(cl_float), &thresholdMax );
+  clErr |= clSetKernelArg( m_ckSegmentationAndTemporalFilter, 10, sizeof(cl_int), &temporalMode );
+  clErr |= clSetKernelArg( m_ckSegmentationAndTemporalFilter, 11, sizeof(cl_int), &windowIndex );
+  clErr |= clSetKernelArg( m_ckSegmentationAndTemporalFilter, 12, sizeof(cl_int), &frameCount );
+  CHECK_OCL_ERR( clErr );
+  if ( clErr != CL_SUCCESS || !this->ExecuteKernel( m_ckSegmentationAndTemporalFilter, 2 ) )
+  {
+    mitkThrow() << "Could not apply segmentation and temporal filter: " << GetOclErrorAsString(clErr);
+  }
+  if ( applyTemporalFilter )
+  {
+    m_TemporalFrameCount = frameCount;
+    m_TemporalWindowIndex = (m_TemporalWindowIndex + 1) % m_TemporalWindowSize;
+  }
+
+  // the spatial filters alternate between the output buffers
+  int current = 0;
+  if ( m_ApplyMedianFilter )
+  {
+    clErr  = clSetKernelArg( m_ckMedianFilter, 0, sizeof(cl_mem), &m_OutputBuffers[current] );
+    clErr |= clSetKernelArg( m_ckMedianFilter, 1, sizeof(cl_mem), &m_OutputBuffers[1 - current] );
+    clErr |= clSetKernelArg( m_ckMedianFilter, 2, sizeof(cl_int), &clWidth );
+    clErr |= clSetKernelArg( m_ckMedianFilter, 3, sizeof(cl_int), &clHeight );
+    CHECK_OCL_ERR( clErr );
+    if ( clErr != CL_SUCCESS || !this->ExecuteKernel( m_ckMedianFilter, 2 ) )
+    {
+      mitkThrow() << "Could not apply median filter: " << GetOclErrorAsString(clErr);
+    }
+    current = 1 - current;
+  }
+
+  if ( m_ApplyBilateralFilter )
+  {
+    const cl_int radius = std::max(m_BilateralFilterKernelRadius, 0);
+    const double domainSigma = std::max(m_BilateralFilterDomainSigma, 1e-6);
+    const double rangeSigma = std::max(m_BilateralFilterRangeSigma, 1e-6);
+    const cl_float domainFactor = static_cast<cl_float>(-0.5 / (domainSigma * domainSigma));
+    const cl_float rangeFactor = static_cast<cl_float>(-0.5 / (rangeSigma * rangeSigma));
+    for (cl_int vertical = 0; vertical < 2; ++vertical)
+    {
+      clErr  = clSetKernelArg( m_ckBilateralFilter, 0, sizeof(cl_mem), &m_OutputBuffers[current] );
+      clErr |= clSetKernelArg( m_ckBilateralFilter, 1, sizeof(cl_mem), &m_OutputBuffers[1 - current] );
+      clErr |= clSetKernelArg( m_ckBilateralFilter, 2, sizeof(cl_int), &clWidth );
+      clErr |= clSetKernelArg( m_ckBilateralFilter, 3, sizeof(cl_int), &clHeight );
+      clErr |= clSetKernelArg( m_ckBilateralFilter, 4, sizeof(cl_int), &vertical );
+      clErr |= clSetKernelArg( m_ckBilateralFilter, 5, sizeof(cl_int), &radius );
+      clErr |= clSetKernelArg( m_ckBilateralFilter, 6, sizeof(cl_float), &domainFactor );
+      clErr |= clSetKernelArg( m_ckBilateralFilter, 7, sizeof(cl_float), &rangeFactor );
+      CHECK_OCL_ERR( clErr );
+      if ( clErr != CL_SUCCESS || !this->ExecuteKernel( m_ckBilateralFilter, 2 ) )
+      {
+        mitkThrow() << "Could not apply bilateral filter: " << GetOclErrorAsString(clErr);
+      }
+      current = 1 - current;
+    }
+  }
+
+  clErr = clEnqueueReadBuffer( this->m_CommandQue, m_OutputBuffers[current], CL_TRUE, 0, numberOfBytes, output, 0, nullptr, nullptr );
+  CHECK_OCL_ERR( clErr );
+  if ( clErr != CL_SUCCESS )
+  {
+    mitkThrow() << "Could not download filtered image: " << GetOclErrorAsString(clErr);
+  }
+}
+
+us::Module *mitk::OclToFCompositeFilter::GetModule()
+{
+  return us::GetModuleContext()->GetModule();
+}
+
+bool mitk::OclToFCompositeFilter::Initialize()
+{
+  bool buildErr = true;
+  cl_int clErr = 0;
+
+  if ( OclFilter::Initialize() )
+  {
+    const char* names[] = { "ckSegmentationAndTemporalFilter", "ckMedianFilter", "ckBilateralFilter" };
+    cl_kernel* kernels[] = { &m_ckSegmentationAndTemporalFilter, &m_ckMedianFilter, &m_ckBilateralFilter };
+
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      if ( !*(kernels[i]) )
+      {
+        *(kernels[i]) = clCreateKernel( this->m_ClProgram, names[i], &clErr);
+        buildErr &= CHECK_OCL_ERR( clErr );
+      }
+    }
+  }
+
+  return (OclFilter::IsInitialized() && buildErr );
+}
@@ -0,0 +1,130 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+#ifndef __mitkOclToFCompositeFilter_h
+#define __mitkOclToFCompositeFilter_h
+
+#if defined(TOFPROCESSING_USE_GPU) || DOXYGEN
+
+#include "mitkOclFilter.h"
+#include <MitkToFProcessingExports.h>
+
+#include <itkObject.h>
+
+namespace mitk
+{
+  /**
+  * @brief GPU implementation of the fused pipeline of the ToFCompositeFilter
+  *
+  * Threshold, mask segmentation and temporal median/average filter are computed by one kernel, followed by
+  * the 3x3 median filter and the separable bilateral filter. All device buffers, including the window of the
+  * temporal filter, are allocated once per image size and stay resident on the device; per frame only the
+  * distance image (and the mask, if given) is uploaded and the result is downloaded.
+  *
+  * The temporal filter supports at most MaximumTemporalWindowSize frames.
+  *
+  * @ingroup ToFProcessing
+  */
+  class MITKTOFPROCESSING_EXPORT OclToFCompositeFilter : public OclFilter, public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(OclToFCompositeFilter, itk::Object);
+    itkNewMacro(Self);
+
+    /** Maximum number of frames of the temporal filter, limited by the private memory of the kernel */
+    static const int MaximumTemporalWindowSize = 32;
+
+    itkSetMacro(ApplyThresholdFilter, bool);
+    itkGetConstMacro(ApplyThresholdFilter, bool);
+    itkSetMacro(ThresholdFilterMin, int);
+    itkGetConstMacro(ThresholdFilterMin, int);
+    itkSetMacro(ThresholdFilterMax, int);
+    itkGetConstMacro(ThresholdFilterMax, int);
+    itkSetMacro(ApplyTemporalMedianFilter, bool);
+    itkGetConstMacro(ApplyTemporalMedianFilter, bool);
+    itkSetMacro(ApplyAverageFilter, bool);
+    itkGetConstMacro(ApplyAverageFilter, bool);
+    itkSetMacro(TemporalMedianFilterNumOfFrames, int);
+    itkGetConstMacro(TemporalMedianFilterNumOfFrames, int);
+    itkSetMacro(ApplyMedianFilter, bool);
+    itkGetConstMacro(ApplyMedianFilter, bool);
+    itkSetMacro(ApplyBilateralFilter, bool);
+    itkGetConstMacro(ApplyBilateralFilter, bool);
+    itkSetMacro(BilateralFilterDomainSigma, double);
+    itkGetConstMacro(BilateralFilterDomainSigma, double);
+    itkSetMacro(BilateralFilterRangeSigma, double);
+    itkGetConstMacro(BilateralFilterRangeSigma, double);
+    /** Radius of the separable bilateral filter in pixels */
+    itkSetMacro(BilateralFilterKernelRadius, int);
+    itkGetConstMacro(BilateralFilterKernelRadius, int);
+
+    /**
+    * @brief Filters one distance image of width*height values.
+    * @param input distance image
+    * @param segmentationMask mask of width*height values, pixels with a mask value of 0 are set to 0. May be nullptr.
+    * @param output filtered image, may be equal to input
+    * @throw mitk::Exception if the filter could not be initialized or a GPU operation failed
+    */
+    void Process(const float* input, const char* segmentationMask, float* output, unsigned int width, unsigned int height);
+
+    /** Discards the frames of the temporal filter */
+    void ResetTemporalWindow();
+
+  protected:
+    OclToFCompositeFilter();
+    virtual ~OclToFCompositeFilter();
+
+    /** Initialize the filter */
+    bool Initialize();
+
+    virtual us::Module* GetModule();
+
+    /** (Re)allocates the device buffers if the image size or the temporal window size changed */
+    void InitializeBuffers(unsigned int width, unsigned int height, int windowSize);
+
+    void ReleaseBuffers();
+
+  private:
+    cl_kernel m_ckSegmentationAndTemporalFilter;
+    cl_kernel m_ckMedianFilter;
+    cl_kernel m_ckBilateralFilter;
+
+    cl_mem m_InputBuffer;
+    cl_mem m_MaskBuffer;
+    cl_mem m_HistoryBuffer;
+    cl_mem m_OutputBuffers[2];
+
+    unsigned int m_Width;
+    unsigned int m_Height;
+    int m_TemporalWindowSize;
+    int m_TemporalFrameCount;
+    int m_TemporalWindowIndex;
+
+    bool m_ApplyThresholdFilter;
+    int m_ThresholdFilterMin;
+    int m_ThresholdFilterMax;
+    bool m_ApplyTemporalMedianFilter;
+    bool m_ApplyAverageFilter;
+    int m_TemporalMedianFilterNumOfFrames;
+    bool m_ApplyMedianFilter;
+    bool m_ApplyBilateralFilter;
+    double m_BilateralFilterDomainSigma;
+    double m_BilateralFilterRangeSigma;
+    int m_BilateralFilterKernelRadius;
+  };
+} //END mitk namespace
+
+#endif
+#endif
@@ -21,12 +21,49 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkImage.h>
 
 #include "opencv2/imgproc.hpp"
+#include "opencv2/core/utility.hpp"
+
+#if defined(TOFPROCESSING_USE_GPU)
+#include "mitkOclToFCompositeFilter.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+namespace
+{
+  /** number of entries of the range weight lookup table of the separable bilateral filter, covering four range sigmas */
+  const int BilateralRangeWeightsSize = 1024;
+
+  inline void SortPair(float& a, float& b)
+  {
+    const float minimum = std::min(a, b);
+    b = std::max(a, b);
+    a = minimum;
+  }
+
+  /** median of nine values by a sorting network (see Devillard, "Fast median search: an ANSI C implementation") */
+  inline float MedianOfNine(float* p)
+  {
+    SortPair(p[1], p[2]); SortPair(p[4], p[5]); SortPair(p[7], p[8]);
+    SortPair(p[0], p[1]); SortPair(p[3], p[4]); SortPair(p[6], p[7]);
+    SortPair(p[1], p[2]); SortPair(p[4], p[5]); SortPair(p[7], p[8]);
+    SortPair(p[0], p[3]); SortPair(p[5], p[8]); SortPair(p[4], p[7]);
+    SortPair(p[3], p[6]); SortPair(p[1], p[4]); SortPair(p[2], p[5]);
+    SortPair(p[4], p[7]); SortPair(p[4], p[2]); SortPair(p[6], p[4]);
+    SortPair(p[4], p[2]);
+    return p[4];
+  }
+}
 
 mitk::ToFCompositeFilter::ToFCompositeFilter() : m_SegmentationMask(nullptr), m_ImageWidth(0), m_ImageHeight(0), m_ImageSize(0),
 m_IplDistanceImage(nullptr), m_IplOutputImage(nullptr), m_ItkInputImage(nullptr), m_ApplyTemporalMedianFilter(false), m_ApplyAverageFilter(false),
   m_ApplyMedianFilter(false), m_ApplyThresholdFilter(false), m_ApplyMaskSegmentation(false), m_ApplyBilateralFilter(false), m_DataBuffer(nullptr),
 m_DataBufferCurrentIndex(0), m_DataBufferMaxSize(0), m_TemporalMedianFilterNumOfFrames(10), m_ThresholdFilterMin(1),
-m_ThresholdFilterMax(7000), m_BilateralFilterDomainSigma(2), m_BilateralFilterRangeSigma(60), m_BilateralFilterKernelRadius(0)
+m_ThresholdFilterMax(7000), m_BilateralFilterDomainSigma(2), m_BilateralFilterRangeSigma(60), m_BilateralFilterKernelRadius(0),
+m_UseParallelProcessing(false), m_UseGPU(false), m_TemporalWindowSize(0), m_TemporalFrameCount(0), m_TemporalWindowIndex(0),
+m_BilateralRangeWeightsScale(0.0f), m_BilateralWeightsRadius(-1), m_BilateralWeightsDomainSigma(0.0), m_BilateralWeightsRangeSigma(0.0)
 {
 }
 
@@ -122,6 +159,12 @@ void mitk::ToFCompositeFilter::GenerateData()
   // copy initial distance image to ipl image
   float* distanceFloatData = (float*)inputAcc.GetData();
   memcpy(this->m_IplDistanceImage->imageData, (void*)distanceFloatData, this->m_ImageSize);
+  if (this->m_UseParallelProcessing)
+  {
+    ProcessParallel((float*)this->m_IplDistanceImage->imageData);
+    memcpy( outputDistanceFloatData, this->m_IplDistanceImage->imageData, this->m_ImageSize );
+    return;
+  }
   if (m_ApplyThresholdFilter||m_ApplyMaskSegmentation)
   {
     ProcessSegmentation(this->m_IplDistanceImage);
@@ -362,6 +405,263 @@ float mitk::ToFCompositeFilter::quick_select(float arr[], int n)
 }
 #undef ELEM_SWAP
 
+void mitk::ToFCompositeFilter::ProcessParallel(float* data)
+{
+  this->InitializeParallelProcessing();
+
+  std::unique_ptr<ImageReadAccessor> segMaskAcc;
+  const char* segmentationMask = nullptr;
+  if (m_ApplyMaskSegmentation && m_SegmentationMask.IsNotNull())
+  {
+    segMaskAcc.reset(new ImageReadAccessor(m_SegmentationMask, m_SegmentationMask->GetSliceData(0,0,0)));
+    segmentationMask = (const char*)segMaskAcc->GetData();
+  }
+
+#if defined(TOFPROCESSING_USE_GPU)
+  if (m_UseGPU)
+  {
+    try
+    {
+      if (m_OclFilter.IsNull())
+      {
+        m_OclFilter = mitk::OclToFCompositeFilter::New();
+      }
+      m_OclFilter->SetApplyThresholdFilter(m_ApplyThresholdFilter);
+      m_OclFilter->SetThresholdFilterMin(m_ThresholdFilterMin);
+      m_OclFilter->SetThresholdFilterMax(m_ThresholdFilterMax);
+      m_OclFilter->SetApplyTemporalMedianFilter(m_ApplyTemporalMedianFilter);
+      m_OclFilter->SetApplyAverageFilter(m_ApplyAverageFilter);
+      m_OclFilter->SetTemporalMedianFilterNumOfFrames(m_TemporalMedianFilterNumOfFrames);
+      m_OclFilter->SetApplyMedianFilter(m_ApplyMedianFilter);
+      m_OclFilter->SetApplyBilateralFilter(m_ApplyBilateralFilter);
+      m_OclFilter->SetBilateralFilterDomainSigma(m_BilateralFilterDomainSigma);
+      m_OclFilter->SetBilateralFilterRangeSigma(m_BilateralFilterRangeSigma);
+      m_OclFilter->SetBilateralFilterKernelRadius(m_BilateralWeightsRadius);
+      m_OclFilter->Process(data, segmentationMask, data, m_ImageWidth, m_ImageHeight);
+      return;
+    }
+    catch (const mitk::Exception& e)
+    {
+      MITK_WARN("ToFCompositeFilter") << "GPU processing failed, falling back to CPU: " << e.GetDescription();
+      m_UseGPU = false;
+    }
+  }
+#else
+  if (m_UseGPU)
+  {
+    MITK_WARN("ToFCompositeFilter") << "ToFProcessing was built without OpenCL, using the CPU implementation.";
+    m_UseGPU = false;
+  }
+#endif
+
+  const bool applyTemporalFilter = (m_ApplyTemporalMedianFilter || m_ApplyAverageFilter) && m_TemporalWindowSize > 0;
+  if (m_ApplyThresholdFilter || segmentationMask || applyTemporalFilter)
+  {
+    cv::parallel_for_(cv::Range(0, m_ImageHeight), [&](const cv::Range& rows)
+    {
+      this->ProcessSegmentationAndTemporalFilter(data, segmentationMask, rows.start, rows.end);
+    });
+    if (applyTemporalFilter)
+    {
+      m_TemporalFrameCount = std::min(m_TemporalFrameCount + 1, m_TemporalWindowSize);
+      m_TemporalWindowIndex = (m_TemporalWindowIndex + 1) % m_TemporalWindowSize;
+    }
+  }
+
+  // the spatial filters alternate between data and m_ParallelBuffer
+  float* current = data;
+  float* next = m_ParallelBuffer.data();
+  if (m_ApplyMedianFilter)
+  {
+    cv::parallel_for_(cv::Range(0, m_ImageHeight), [&](const cv::Range& rows)
+    {
+      this->ProcessMedianFilterRows(current, next, rows.start, rows.end);
+    });
+    std::swap(current, next);
+  }
+  if (m_ApplyBilateralFilter)
+  {
+    for (int pass = 0; pass < 2; ++pass)
+    {
+      cv::parallel_for_(cv::Range(0, m_ImageHeight), [&](const cv::Range& rows)
+      {
+        this->ProcessSeparableBilateralFilterRows(current, next, pass == 1, rows.start, rows.end);
+      });
+      std::swap(current, next);
+    }
+  }
+  if (current != data)
+  {
+    memcpy(data, current, this->m_ImageSize);
+  }
+}
+
+void mitk::ToFCompositeFilter::InitializeParallelProcessing()
+{
+  const std::size_t numberOfPixels = static_cast<std::size_t>(m_ImageWidth) * m_ImageHeight;
+  const int windowSize = std::max(m_TemporalMedianFilterNumOfFrames, 0);
+  if (windowSize != m_TemporalWindowSize || m_TemporalSum.size() != numberOfPixels)
+  {
+    m_TemporalWindowSize = windowSize;
+    m_TemporalHistory.assign(numberOfPixels * windowSize, 0.0f);
+    m_TemporalSortedWindow.assign(numberOfPixels * windowSize, 0.0f);
+    m_TemporalSum.assign(numberOfPixels, 0.0);
+    m_TemporalFrameCount = 0;
+    m_TemporalWindowIndex = 0;
+  }
+  m_ParallelBuffer.resize(numberOfPixels);
+
+  const int radius = m_BilateralFilterKernelRadius > 0 ? m_BilateralFilterKernelRadius
+                                                       : static_cast<int>(std::ceil(2.5 * m_BilateralFilterDomainSigma));
+  if (radius != m_BilateralWeightsRadius || m_BilateralFilterDomainSigma != m_BilateralWeightsDomainSigma ||
+      m_BilateralFilterRangeSigma != m_BilateralWeightsRangeSigma)
+  {
+    m_BilateralWeightsRadius = radius;
+    this->InitializeBilateralFilterWeights();
+  }
+}
+
+void mitk::ToFCompositeFilter::InitializeBilateralFilterWeights()
+{
+  m_BilateralWeightsDomainSigma = m_BilateralFilterDomainSigma;
+  m_BilateralWeightsRangeSigma = m_BilateralFilterRangeSigma;
+  const double domainSigma = std::max(m_BilateralFilterDomainSigma, 1e-6);
+  const double rangeSigma = std::max(m_BilateralFilterRangeSigma, 1e-6);
+
+  m_BilateralSpatialWeights.resize(2 * m_BilateralWeightsRadius + 1);
+  for (int k = -m_BilateralWeightsRadius; k <= m_BilateralWeightsRadius; ++k)
+  {
+    m_BilateralSpatialWeights[k + m_BilateralWeightsRadius] = static_cast<float>(std::exp(-0.5 * k * k / (domainSigma * domainSigma)));
+  }
+
+  m_BilateralRangeWeightsScale = static_cast<float>(BilateralRangeWeightsSize / (4.0 * rangeSigma));
+  m_BilateralRangeWeights.resize(BilateralRangeWeightsSize);
+  for (int j = 0; j < BilateralRangeWeightsSize; ++j)
+  {
+    const double difference = j / static_cast<double>(m_BilateralRangeWeightsScale);
+    m_BilateralRangeWeights[j] = static_cast<float>(std::exp(-0.5 * difference * difference / (rangeSigma * rangeSigma)));
+  }
+}
+
+void mitk::ToFCompositeFilter::ProcessSegmentationAndTemporalFilter(float* data, const char* segmentationMask, int startRow, int endRow)
+{
+  const int windowSize = m_TemporalWindowSize;
+  const bool applyTemporalFilter = (m_ApplyTemporalMedianFilter || m_ApplyAverageFilter) && windowSize > 0;
+  const int frameCount = m_TemporalFrameCount;
+  const int windowIndex = m_TemporalWindowIndex;
+  const float thresholdMin = static_cast<float>(m_ThresholdFilterMin);
+  const float thresholdMax = static_cast<float>(m_ThresholdFilterMax);
+
+  for (int i = startRow * m_ImageWidth; i < endRow * m_ImageWidth; ++i)
+  {
+    float value = data[i];
+    if (m_ApplyThresholdFilter && (value <= thresholdMin || value >= thresholdMax))
+    {
+      value = 0.0f;
+    }
+    if (segmentationMask && segmentationMask[i] == 0)
+    {
+      value = 0.0f;
+    }
+
+    if (applyTemporalFilter)
+    {
+      float* history = &m_TemporalHistory[static_cast<std::size_t>(i) * windowSize];
+      float* sorted = &m_TemporalSortedWindow[static_cast<std::size_t>(i) * windowSize];
+      int position = frameCount;
+      if (frameCount == windowSize)
+      {
+        // the oldest value leaves the window, its slot in the sorted window is reused for the new value
+        const float oldest = history[windowIndex];
+        position = static_cast<int>(std::lower_bound(sorted, sorted + windowSize, oldest) - sorted);
+        m_TemporalSum[i] -= oldest;
+        while (position < windowSize - 1 && sorted[position + 1] < value)
+        {
+          sorted[position] = sorted[position + 1];
+          ++position;
+        }
+      }
+      while (position > 0 && sorted[position - 1] > value)
+      {
+        sorted[position] = sorted[position - 1];
+        --position;
+      }
+      sorted[position] = value;
+      history[windowIndex] = value;
+      m_TemporalSum[i] += value;
+
+      const int count = std::min(frameCount + 1, windowSize);
+      if (m_ApplyAverageFilter)
+      {
+        value = static_cast<float>(m_TemporalSum[i] / count);
+      }
+      else
+      {
+        value = sorted[(count - 1) / 2];
+      }
+    }
+    data[i] = value;
+  }
+}
+
+void mitk::ToFCompositeFilter::ProcessMedianFilterRows(const float* input, float* output, int startRow, int endRow)
+{
+  const int width = m_ImageWidth;
+  float window[9];
+  for (int y = startRow; y < endRow; ++y)
+  {
+    const float* rows[3] = { input + std::max(y - 1, 0) * width, input + y * width, input + std::min(y + 1, m_ImageHeight - 1) * width };
+    for (int x = 0; x < width; ++x)
+    {
+      const int left = std::max(x - 1, 0);
+      const int right = std::min(x + 1, width - 1);
+      for (int r = 0; r < 3; ++r)
+      {
+        window[3 * r] = rows[r][left];
+        window[3 * r + 1] = rows[r][x];
+        window[3 * r + 2] = rows[r][right];
+      }
+      output[y * width + x] = MedianOfNine(window);
+    }
+  }
+}
+
+void mitk::ToFCompositeFilter::ProcessSeparableBilateralFilterRows(const float* input, float* output, bool vertical, int startRow, int endRow)
+{
+  const int width = m_ImageWidth;
+  const int radius = m_BilateralWeightsRadius;
+  const int extent = vertical ? m_ImageHeight : width;
+  const int stride = vertical ? width : 1;
+  const float* spatialWeights = m_BilateralSpatialWeights.data();
+  const float* rangeWeights = m_BilateralRangeWeights.data();
+  const float scale = m_BilateralRangeWeightsScale;
+
+  for (int y = startRow; y < endRow; ++y)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      const int center = vertical ? y : x;
+      const float* line = input + (vertical ? x : y * width);
+      const float centerValue = line[center * stride];
+      float sum = 0.0f;
+      float weightSum = 0.0f;
+      for (int k = -radius; k <= radius; ++k)
+      {
+        const float value = line[std::min(std::max(center + k, 0), extent - 1) * stride];
+        const int bin = static_cast<int>(std::abs(value - centerValue) * scale);
+        if (bin < BilateralRangeWeightsSize)
+        {
+          const float weight = spatialWeights[k + radius] * rangeWeights[bin];
+          sum += weight * value;
+          weightSum += weight;
+        }
+      }
+      // the center pixel always has weight one
+      output[y * width + x] = sum / weightSum;
+    }
+  }
+}
+
 void mitk::ToFCompositeFilter::SetTemporalMedianFilterParameter(int tmporalMedianFilterNumOfFrames)
 {
   this->m_TemporalMedianFilterNumOfFrames = tmporalMedianFilterNumOfFrames;
@@ -22,12 +22,18 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkBilateralImageFilter.h>
 #include "opencv2/core.hpp"
 
+#include <vector>
+
 typedef itk::Image<float, 2> ItkImageType2D;
 typedef itk::Image<float, 3> ItkImageType3D;
 typedef itk::BilateralImageFilter<ItkImageType2D,ItkImageType2D> BilateralFilterType;
 
 namespace mitk
 {
+#if defined(TOFPROCESSING_USE_GPU)
+  class OclToFCompositeFilter;
+#endif
+
   /**
   * @brief Applies a common filter-pipeline to the first input of this filter
   *
@@ -39,6 +45,14 @@ namespace mitk
   * - spatial median filter
   * - bilateral filter
   *
+  * If UseParallelProcessing is enabled, the filters are applied by a fused, multi-threaded pipeline working on
+  * buffers which are allocated once per image size: threshold, mask and temporal filter are applied in a single
+  * pass over the image, the temporal median is updated incrementally from a sorted window per pixel, and the
+  * bilateral filter is approximated by a separable (horizontal, then vertical) bilateral filter. The results of
+  * the segmentation, temporal and spatial median filters are identical to the default pipeline.
+  * If additionally UseGPU is enabled and the module was built with OpenCL (MITK_USE_OpenCL), the same pipeline is
+  * computed on the GPU by an OclToFCompositeFilter.
+  *
   * @ingroup ToFProcessing
   */
   class MITKTOFPROCESSING_EXPORT ToFCompositeFilter : public ImageToImageFilter
@@ -62,6 +76,15 @@ namespace mitk
     itkGetConstMacro(ApplyMaskSegmentation,bool);
     itkSetMacro(ApplyBilateralFilter,bool);
     itkGetConstMacro(ApplyBilateralFilter,bool);
+    /** If true, the fused multi-threaded pipeline is used instead of the OpenCV/ITK filters. Default: false */
+    itkSetMacro(UseParallelProcessing,bool);
+    itkGetConstMacro(UseParallelProcessing,bool);
+    itkBooleanMacro(UseParallelProcessing);
+    /** If true, the fused pipeline is computed on the GPU. Requires UseParallelProcessing and a module built
+    with OpenCL, otherwise the multi-threaded CPU implementation is used. Default: false */
+    itkSetMacro(UseGPU,bool);
+    itkGetConstMacro(UseGPU,bool);
+    itkBooleanMacro(UseGPU);
 
     using itk::ProcessObject::SetInput;
 
@@ -163,6 +186,31 @@ namespace mitk
     */
     float quick_select(float arr[], int n);
     /*!
+    \brief Applies all active filters to data (m_ImageWidth*m_ImageHeight values) with the fused, multi-threaded pipeline
+    */
+    void ProcessParallel(float* data);
+    /*!
+    \brief Allocates the buffers of the fused pipeline and resets the temporal window if the image size or the number of frames changed
+    */
+    void InitializeParallelProcessing();
+    /*!
+    \brief Applies threshold, mask segmentation and temporal filter to the rows [startRow, endRow) of data.
+    The temporal median is kept in a sorted window per pixel, in which the oldest value is replaced by the new one.
+    */
+    void ProcessSegmentationAndTemporalFilter(float* data, const char* segmentationMask, int startRow, int endRow);
+    /*!
+    \brief 3x3 median filter of the rows [startRow, endRow) with replicated borders, identical to the OpenCV median filter
+    */
+    void ProcessMedianFilterRows(const float* input, float* output, int startRow, int endRow);
+    /*!
+    \brief One direction (horizontal or vertical) of the separable bilateral filter for the rows [startRow, endRow)
+    */
+    void ProcessSeparableBilateralFilterRows(const float* input, float* output, bool vertical, int startRow, int endRow);
+    /*!
+    \brief Precomputes the spatial weights and the range weight lookup table of the separable bilateral filter
+    */
+    void InitializeBilateralFilterWeights();
+    /*!
     \brief Initialize and allocate a 2D ITK image of dimension m_ImageWidth*m_ImageHeight
     */
     void CreateItkImage(ItkImageType2D::Pointer &itkInputImage);
@@ -196,6 +244,28 @@ namespace mitk
     double m_BilateralFilterRangeSigma; ///< Parameter of the bilateral filter controlling the edge preserving effect of the filter. Default value: 60
     int m_BilateralFilterKernelRadius; ///< Kernel radius of the bilateral filter mask
 
+    bool m_UseParallelProcessing; ///< Flag indicating if the fused, multi-threaded pipeline is used
+    bool m_UseGPU; ///< Flag indicating if the fused pipeline is computed on the GPU
+
+    std::vector<float> m_TemporalHistory; ///< last m_TemporalWindowSize values of every pixel, pixel-major
+    std::vector<float> m_TemporalSortedWindow; ///< the same values sorted ascending per pixel
+    std::vector<double> m_TemporalSum; ///< sum of the values in the window of every pixel, used by the average filter
+    int m_TemporalWindowSize; ///< window size the temporal buffers were allocated for
+    int m_TemporalFrameCount; ///< number of frames in the temporal window, at most m_TemporalWindowSize
+    int m_TemporalWindowIndex; ///< position of the oldest value in the history of every pixel
+    std::vector<float> m_ParallelBuffer; ///< intermediate image of the spatial filters
+
+    std::vector<float> m_BilateralSpatialWeights; ///< domain weights for the offsets -radius...radius
+    std::vector<float> m_BilateralRangeWeights; ///< range weights, lookup table over the absolute intensity difference
+    float m_BilateralRangeWeightsScale; ///< lookup table entries per unit of intensity difference
+    int m_BilateralWeightsRadius; ///< radius the spatial weights were computed for
+    double m_BilateralWeightsDomainSigma; ///< domain sigma the weights were computed for
+    double m_BilateralWeightsRangeSigma; ///< range sigma the weights were computed for
+
+#if defined(TOFPROCESSING_USE_GPU)
+    itk::SmartPointer<OclToFCompositeFilter> m_OclFilter; ///< GPU implementation of the fused pipeline, created on first use
+#endif
+
   };
 } //END mitk namespace
 #endif
@@ -26,15 +26,18 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkPolyData.h>
 #include <vtkPointData.h>
 #include <vtkFloatArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkIdTypeArray.h>
 #include <vtkSmartPointer.h>
 #include <vtkIdList.h>
 
 #include <cmath>
+#include <cstring>
 #include <vtkMath.h>
 
 mitk::ToFDistanceImageToSurfaceFilter::ToFDistanceImageToSurfaceFilter() :
   m_IplScalarImage(nullptr), m_CameraIntrinsics(), m_TextureImageWidth(0), m_TextureImageHeight(0), m_InterPixelDistance(), m_TextureIndex(0),
-  m_GenerateTriangularMesh(true), m_TriangulationThreshold(0.0)
+  m_GenerateTriangularMesh(true), m_TriangulationThreshold(0.0), m_IncrementalMeshUpdate(false)
 {
   m_InterPixelDistance.Fill(0.045);
   m_CameraIntrinsics = mitk::CameraIntrinsics::New();
@@ -136,6 +139,13 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
 
   ImageReadAccessor inputAcc(input, input->GetSliceData(0,0,0));
   float* inputFloatData = (float*)inputAcc.GetData();
+
+  if (m_IncrementalMeshUpdate)
+  {
+    this->GenerateDataIncremental(output, input, inputFloatData, scalarFloatData);
+    return;
+  }
+  m_IncrementalMesh = nullptr;
   //calculate world coordinates
   mitk::ToFProcessingCommon::ToFPoint2D focalLengthInPixelUnits;
   mitk::ToFProcessingCommon::ToFScalarType focalLengthInMm;
@@ -311,6 +321,290 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
   output->SetVtkPolyData(mesh);
 }
 
+bool mitk::ToFDistanceImageToSurfaceFilter::InitializeIncrementalMesh(mitk::Image* input)
+{
+  int xDimension = input->GetDimension(0);
+  int yDimension = input->GetDimension(1);
+  mitk::Point3D origin = input->GetGeometry()->GetOrigin();
+  mitk::Vector3D spacing = input->GetGeometry()->GetSpacing();
+
+  std::vector<double> parameters = { (double)xDimension, (double)yDimension, (double)m_ReconstructionMode,
+    m_CameraIntrinsics->GetFocalLengthX(), m_CameraIntrinsics->GetFocalLengthY(),
+    m_CameraIntrinsics->GetPrincipalPointX(), m_CameraIntrinsics->GetPrincipalPointY(),
+    m_InterPixelDistance[0], m_InterPixelDistance[1], origin[0], origin[1], spacing[0], spacing[1],
+    m_TriangulationThreshold, (double)m_GenerateTriangularMesh };
+
+  if (m_IncrementalMesh != nullptr && parameters == m_IncrementalMeshParameters)
+    return false;
+  m_IncrementalMeshParameters = parameters;
+
+  unsigned int size = xDimension*yDimension;
+
+  mitk::ToFProcessingCommon::ToFPoint2D focalLengthInPixelUnits;
+  focalLengthInPixelUnits[0] = m_CameraIntrinsics->GetFocalLengthX();
+  focalLengthInPixelUnits[1] = m_CameraIntrinsics->GetFocalLengthY();
+  mitk::ToFProcessingCommon::ToFScalarType focalLengthInMm = (m_CameraIntrinsics->GetFocalLengthX()*m_InterPixelDistance[0]+m_CameraIntrinsics->GetFocalLengthY()*m_InterPixelDistance[1])/2.0;
+  mitk::ToFProcessingCommon::ToFPoint2D principalPoint;
+  principalPoint[0] = m_CameraIntrinsics->GetPrincipalPointX();
+  principalPoint[1] = m_CameraIntrinsics->GetPrincipalPointY();
+
+  //All reconstruction modes scale a ray direction with the measured distance, so the points of a
+  //frame are distance * (back-projection of the pixel for a distance of 1).
+  m_RayDirections.resize(3*size);
+  vtkSmartPointer<vtkFloatArray> textureCoords = vtkSmartPointer<vtkFloatArray>::New();
+  textureCoords->SetNumberOfComponents(2);
+  textureCoords->SetNumberOfTuples(size);
+  for (int j=0; j<yDimension; j++)
+  {
+    for (int i=0; i<xDimension; i++)
+    {
+      unsigned int pixelID = i+j*xDimension;
+      unsigned int completeIndexX = i*spacing[0]+origin[0];
+      unsigned int completeIndexY = j*spacing[1]+origin[1];
+
+      mitk::ToFProcessingCommon::ToFPoint3D ray;
+      ray.Fill(0.0);
+      switch (m_ReconstructionMode)
+      {
+      case WithOutInterPixelDistance:
+        ray = mitk::ToFProcessingCommon::IndexToCartesianCoordinates(completeIndexX,completeIndexY,1.0,focalLengthInPixelUnits,principalPoint);
+        break;
+      case WithInterPixelDistance:
+        ray = mitk::ToFProcessingCommon::IndexToCartesianCoordinatesWithInterpixdist(completeIndexX,completeIndexY,1.0,focalLengthInMm,m_InterPixelDistance,principalPoint);
+        break;
+      case Kinect:
+        ray = mitk::ToFProcessingCommon::KinectIndexToCartesianCoordinates(completeIndexX,completeIndexY,1.0,focalLengthInPixelUnits,principalPoint);
+        break;
+      default:
+        MITK_ERROR << "Incorrect reconstruction mode!";
+      }
+      m_RayDirections[3*pixelID] = ray[0];
+      m_RayDirections[3*pixelID+1] = ray[1];
+      m_RayDirections[3*pixelID+2] = ray[2];
+
+      textureCoords->SetTuple2(pixelID, ((float)i)/xDimension, ((float)j)/yDimension);
+    }
+  }
+
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetDataTypeToDouble();
+  points->SetNumberOfPoints(size);
+
+  m_IncrementalMesh = vtkSmartPointer<vtkPolyData>::New();
+  m_IncrementalMesh->SetPoints(points);
+  m_IncrementalMesh->SetPolys(vtkSmartPointer<vtkCellArray>::New());
+  m_IncrementalMesh->SetVerts(vtkSmartPointer<vtkCellArray>::New());
+  m_IncrementalMesh->GetPointData()->SetTCoords(textureCoords);
+
+  //point IDs are equal to the pixel IDs
+  m_VertexIdList = vtkSmartPointer<vtkIdList>::New();
+  m_VertexIdList->SetNumberOfIds(size);
+  for(unsigned int i = 0; i < size; ++i)
+  {
+    m_VertexIdList->SetId(i, i);
+  }
+
+  m_PixelValid.assign(size, 0);
+  m_QuadStates.assign(size, 0);
+  m_ChangedPixels.clear();
+  m_ChangedPixels.reserve(size);
+  return true;
+}
+
+unsigned char mitk::ToFDistanceImageToSurfaceFilter::ComputeQuadState(vtkIdType xy, int xDimension, const double* points) const
+{
+  //see GenerateData() for the naming of the vertices
+  vtkIdType x_1y = xy-1;
+  vtkIdType xy_1 = xy-xDimension;
+  vtkIdType x_1y_1 = xy_1-1;
+
+  if (!(m_PixelValid[xy]&&m_PixelValid[x_1y]&&m_PixelValid[x_1y_1]&&m_PixelValid[xy_1]))
+    return 0;
+
+  if( (mitk::Equal(m_TriangulationThreshold, 0.0)) || ((vtkMath::Distance2BetweenPoints(points+3*xy, points+3*x_1y) <= m_TriangulationThreshold)
+                                                       && (vtkMath::Distance2BetweenPoints(points+3*xy, points+3*xy_1) <= m_TriangulationThreshold)
+                                                       && (vtkMath::Distance2BetweenPoints(points+3*x_1y, points+3*x_1y_1) <= m_TriangulationThreshold)
+                                                       && (vtkMath::Distance2BetweenPoints(points+3*xy_1, points+3*x_1y_1) <= m_TriangulationThreshold)))
+    return 1;
+
+  return 2;
+}
+
+void mitk::ToFDistanceImageToSurfaceFilter::RebuildIncrementalMeshCells(int xDimension, int yDimension)
+{
+  unsigned int size = xDimension*yDimension;
+  unsigned int numberOfTriangles = 0;
+  unsigned int numberOfVertices = 0;
+  for (unsigned int pixelID = 0; pixelID < size; ++pixelID)
+  {
+    if (!m_GenerateTriangularMesh)
+      numberOfVertices += m_PixelValid[pixelID];
+    else if (m_QuadStates[pixelID] == 1)
+      numberOfTriangles += 2;
+    else if (m_QuadStates[pixelID] == 2)
+      ++numberOfVertices;
+  }
+
+  //legacy cell layout: number of points followed by the point IDs
+  vtkSmartPointer<vtkIdTypeArray> triangles = vtkSmartPointer<vtkIdTypeArray>::New();
+  triangles->SetNumberOfValues(4*numberOfTriangles);
+  vtkSmartPointer<vtkIdTypeArray> vertices = vtkSmartPointer<vtkIdTypeArray>::New();
+  vertices->SetNumberOfValues(2*numberOfVertices);
+  vtkIdType* t = triangles->GetPointer(0);
+  vtkIdType* v = vertices->GetPointer(0);
+
+  for (int j=0; j<yDimension; j++)
+  {
+    for (int i=0; i<xDimension; i++)
+    {
+      vtkIdType xy = i+j*xDimension;
+      if (!m_GenerateTriangularMesh)
+      {
+        if (m_PixelValid[xy])
+        {
+          *v++ = 1;
+          *v++ = xy;
+        }
+      }
+      else if (m_QuadStates[xy] == 1)
+      {
+        vtkIdType x_1y = xy-1;
+        vtkIdType xy_1 = xy-xDimension;
+        vtkIdType x_1y_1 = xy_1-1;
+        *t++ = 3; *t++ = x_1y; *t++ = xy; *t++ = x_1y_1;
+        *t++ = 3; *t++ = x_1y_1; *t++ = xy; *t++ = xy_1;
+      }
+      else if (m_QuadStates[xy] == 2)
+      {
+        *v++ = 1;
+        *v++ = xy;
+      }
+    }
+  }
+
+  m_IncrementalMesh->GetPolys()->SetCells(numberOfTriangles, triangles);
+  m_IncrementalMesh->GetVerts()->SetCells(numberOfVertices, vertices);
+}
+
+void mitk::ToFDistanceImageToSurfaceFilter::GenerateDataIncremental(mitk::Surface* output, mitk::Image* input, float* inputFloatData, float* scalarFloatData)
+{
+  int xDimension = input->GetDimension(0);
+  int yDimension = input->GetDimension(1);
+  unsigned int size = xDimension*yDimension;
+
+  bool topologyChanged = this->InitializeIncrementalMesh(input);
+
+  //back-projection, written without branches so that the compiler can vectorize it
+  vtkDoubleArray* pointData = static_cast<vtkDoubleArray*>(m_IncrementalMesh->GetPoints()->GetData());
+  double* points = pointData->GetPointer(0);
+  const double* rays = m_RayDirections.data();
+  const double epsilon = mitk::eps;
+  for (unsigned int pixelID = 0; pixelID < size; ++pixelID)
+  {
+    double distance = inputFloatData[pixelID];
+    distance = (distance > epsilon) ? distance : 0.0;
+    points[3*pixelID] = distance*rays[3*pixelID];
+    points[3*pixelID+1] = distance*rays[3*pixelID+1];
+    points[3*pixelID+2] = distance*rays[3*pixelID+2];
+  }
+  m_IncrementalMesh->GetPoints()->Modified();
+
+  //validity
+  m_ChangedPixels.clear();
+  for (unsigned int pixelID = 0; pixelID < size; ++pixelID)
+  {
+    //Epsilon here, because we may have small float values like 0.00000001 which in fact represents 0.
+    unsigned char valid = inputFloatData[pixelID] > mitk::eps ? 1 : 0;
+    if (valid != m_PixelValid[pixelID])
+    {
+      m_PixelValid[pixelID] = valid;
+      m_ChangedPixels.push_back(pixelID);
+    }
+  }
+
+  if (!m_GenerateTriangularMesh)
+  {
+    topologyChanged = topologyChanged || !m_ChangedPixels.empty();
+  }
+  else if (!mitk::Equal(m_TriangulationThreshold, 0.0) || topologyChanged)
+  {
+    //the triangulation depends on the distances, so every quad has to be checked
+    for (int j=1; j<yDimension; j++)
+    {
+      for (int i=1; i<xDimension; i++)
+      {
+        vtkIdType xy = i+j*xDimension;
+        unsigned char state = this->ComputeQuadState(xy, xDimension, points);
+        if (state != m_QuadStates[xy])
+        {
+          m_QuadStates[xy] = state;
+          topologyChanged = true;
+        }
+      }
+    }
+  }
+  else
+  {
+    //only the quads which contain a changed pixel
+    for (vtkIdType pixelID : m_ChangedPixels)
+    {
+      int i = pixelID % xDimension;
+      int j = pixelID / xDimension;
+      for (int quadY = j; quadY <= j+1 && quadY < yDimension; ++quadY)
+      {
+        for (int quadX = i; quadX <= i+1 && quadX < xDimension; ++quadX)
+        {
+          if (quadX < 1 || quadY < 1)
+            continue;
+          vtkIdType xy = quadX+quadY*xDimension;
+          unsigned char state = this->ComputeQuadState(xy, xDimension, points);
+          if (state != m_QuadStates[xy])
+          {
+            m_QuadStates[xy] = state;
+            topologyChanged = true;
+          }
+        }
+      }
+    }
+  }
+
+  if (topologyChanged)
+  {
+    this->RebuildIncrementalMeshCells(xDimension, yDimension);
+  }
+
+  //Scalar values are necessary for mapping colors/texture onto the surface
+  if (scalarFloatData)
+  {
+    vtkFloatArray* scalarArray = vtkFloatArray::SafeDownCast(m_IncrementalMesh->GetPointData()->GetScalars());
+    if (scalarArray == nullptr)
+    {
+      vtkSmartPointer<vtkFloatArray> newScalarArray = vtkSmartPointer<vtkFloatArray>::New();
+      newScalarArray->SetNumberOfTuples(size);
+      m_IncrementalMesh->GetPointData()->SetScalars(newScalarArray);
+      scalarArray = newScalarArray;
+    }
+    std::memcpy(scalarArray->GetPointer(0), scalarFloatData, size*sizeof(float));
+    scalarArray->Modified();
+  }
+  else
+  {
+    m_IncrementalMesh->GetPointData()->SetScalars(nullptr);
+  }
+
+  m_IncrementalMesh->Modified();
+  if (output->GetVtkPolyData() == m_IncrementalMesh.GetPointer())
+  {
+    //the same polydata is set again, so the surface has to be informed about the new content
+    output->CalculateBoundingBox();
+    output->Modified();
+  }
+  else
+  {
+    output->SetVtkPolyData(m_IncrementalMesh);
+  }
+}
+
 void mitk::ToFDistanceImageToSurfaceFilter::CreateOutputsForAllInputs()
 {
   this->SetNumberOfIndexedOutputs(this->GetNumberOfInputs());  // create outputs for all inputs
@@ -27,6 +27,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <vtkSmartPointer.h>
 #include <vtkIdList.h>
+#include <vtkPolyData.h>
+
+#include <vector>
 
 namespace mitk
 {
@@ -42,6 +45,16 @@ namespace mitk
   * The definition of the image plane and its coordinate systems (pixel and mm) is depicted in the following image
   * \image html ../Modules/ToFProcessing/Documentation/ImagePlane.png
   *
+  * By default, a new vtkPolyData is created for every frame. For continuous camera streams, the incremental
+  * mesh update (SetIncrementalMeshUpdate()) keeps one vtkPolyData with one point per pixel allocated across
+  * frames. The viewing ray of every pixel is computed only when the camera parameters or the image geometry
+  * change, so the back-projection of a frame is a multiplication of the distances with the ray directions.
+  * The triangles are only recomputed for pixels whose validity changed, and the cells are only rebuilt if
+  * the triangulation changed. If a triangulation threshold is set, all triangles depend on the distances and
+  * are checked again in every frame.
+  * In this mode, the point IDs are equal to the pixel IDs. Invalid pixels are kept as unused points at the
+  * pinhole, and the output polydata is overwritten by the next update.
+  *
   * @ingroup SurfaceFilters
   * @ingroup ToFProcessing
   */
@@ -81,6 +94,14 @@ namespace mitk
     itkSetMacro(GenerateTriangularMesh,bool);
     itkGetMacro(GenerateTriangularMesh,bool);
 
+    /**
+     * @brief SetIncrementalMeshUpdate If true, the output mesh is kept allocated across frames and only
+     * the changed parts are updated (see class description). Default is false.
+     */
+    itkSetMacro(IncrementalMeshUpdate,bool);
+    itkGetMacro(IncrementalMeshUpdate,bool);
+    itkBooleanMacro(IncrementalMeshUpdate);
+
 
     /**
      * @brief The ReconstructionModeType enum: Defines the reconstruction mode, if using no interpixeldistances and focal lenghts in pixel units  or interpixeldistances and focal length in mm. The Kinect option defines a special reconstruction mode for the kinect.
@@ -173,6 +194,28 @@ namespace mitk
     */
     void CreateOutputsForAllInputs();
 
+    /*!
+    \brief Generates the output in the incremental mesh update mode.
+    */
+    void GenerateDataIncremental(mitk::Surface* output, mitk::Image* input, float* inputFloatData, float* scalarFloatData);
+
+    /*!
+    \brief Allocates the mesh and computes the ray directions if the image size or the reconstruction
+    parameters changed. Returns true if the mesh was reset.
+    */
+    bool InitializeIncrementalMesh(mitk::Image* input);
+
+    /*!
+    \brief Computes the state of the quad of pixels whose lower right pixel is xy.
+    \return 0 if a pixel of the quad is invalid, 1 if the quad is triangulated, 2 if it exceeds the triangulation threshold
+    */
+    unsigned char ComputeQuadState(vtkIdType xy, int xDimension, const double* points) const;
+
+    /*!
+    \brief Rebuilds the triangle and vertex cells of the incremental mesh from the quad states.
+    */
+    void RebuildIncrementalMeshCells(int xDimension, int yDimension);
+
     IplImage* m_IplScalarImage; ///< Scalar image used for surface texturing
 
     mitk::CameraIntrinsics::Pointer m_CameraIntrinsics; ///< Specifies the intrinsic parameters
@@ -190,6 +233,14 @@ namespace mitk
 
     double m_TriangulationThreshold;
 
+    bool m_IncrementalMeshUpdate;
+    vtkSmartPointer<vtkPolyData> m_IncrementalMesh; ///< mesh which is kept across frames in the incremental mesh update
+    std::vector<double> m_IncrementalMeshParameters; ///< image size and reconstruction parameters m_IncrementalMesh was initialized for
+    std::vector<double> m_RayDirections; ///< back-projection of every pixel for a distance of 1, three components per pixel
+    std::vector<unsigned char> m_PixelValid; ///< validity of every pixel in the last frame
+    std::vector<unsigned char> m_QuadStates; ///< see ComputeQuadState(), indexed by the lower right pixel of the quad
+    std::vector<vtkIdType> m_ChangedPixels; ///< pixels whose validity changed in the current frame
+
   };
 } //END mitk namespace
 #endif
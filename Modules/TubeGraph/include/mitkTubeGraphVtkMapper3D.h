@@ -31,12 +31,17 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkPolyData.h>
 #include <vtkSmartPointer.h>
 
+#include <set>
+
 namespace mitk
 {
   /**
   * 3D Mapper for mitk::Graph< TubeGraphVertex, TubeGraphEdge >. This mapper creates tubes
   * around each tubular structure by using vtkTubeFilter.
   *
+  * The geometry of every tube and sphere is cached together with a key of the tube elements it was
+  * generated from. If the graph changes, only tubes and spheres with a different key are generated
+  * again. Changes of the TubeGraphProperty only update the color arrays and the visibility of the actors.
   */
 
   class MITKTUBEGRAPH_EXPORT TubeGraphVtkMapper3D : public VtkMapper
@@ -76,7 +81,8 @@ namespace mitk
     virtual void GenerateTubeGraphData(mitk::BaseRenderer *renderer);
 
     /**
-    * Render only the visual information like color or visibility new.
+    * Render only the visual information like color or visibility new. Only the color arrays of tubes
+    * whose color changed are rewritten, the geometry is kept.
     */
     virtual void RenderTubeGraphPropertyInformation(mitk::BaseRenderer *renderer);
 
@@ -85,15 +91,21 @@ namespace mitk
     * tube surface is labeled with the tube id.
     */
     void GeneratePolyDataForTube(TubeGraphEdge &edge,
+                                 const TubeGraph::TubeDescriptorType &tube,
                                  const TubeGraph::Pointer &graph,
-                                 const TubeGraphProperty::Pointer &graphProperty,
+                                 const Color &color,
                                  mitk::BaseRenderer *renderer);
-    void GeneratePolyDataForFurcation(TubeGraphVertex &vertex,
-                                      const TubeGraph::Pointer &graph,
+    void GeneratePolyDataForFurcation(const TubeGraphVertex &vertex,
+                                      const VertexDescriptorType &vertexDesc,
                                       mitk::BaseRenderer *renderer);
-    void ClipPolyData(TubeGraphVertex &vertex,
+    /**
+    * Clips the sphere of the vertex, if clipSphere is true, and all given tubes which end at the vertex
+    * with cylinders along the tubes of the vertex.
+    */
+    void ClipPolyData(const VertexDescriptorType &vertexDesc,
                       const TubeGraph::Pointer &graph,
-                      const TubeGraphProperty::Pointer &graphProperty,
+                      const std::set<TubeGraph::TubeDescriptorType> &tubesToClip,
+                      bool clipSphere,
                       mitk::BaseRenderer *renderer);
 
   private:
@@ -106,10 +118,19 @@ namespace mitk
       std::map<TubeGraph::TubeDescriptorType, vtkSmartPointer<vtkActor>> m_vtkTubesActorMap;
       std::map<TubeGraph::VertexDescriptorType, vtkSmartPointer<vtkActor>> m_vtkSpheresActorMap;
 
+      // keys of the geometry the actors were generated from
+      std::map<TubeGraph::TubeDescriptorType, std::size_t> m_TubeGeometryKeys;
+      std::map<TubeGraph::VertexDescriptorType, std::size_t> m_SphereGeometryKeys;
+      bool m_ClipStructures;
+
+      // the tubes ending at each vertex and the color currently shown by each tube
+      std::map<TubeGraph::VertexDescriptorType, std::vector<TubeGraph::TubeDescriptorType>> m_TubesOfVertex;
+      std::map<TubeGraph::TubeDescriptorType, Color> m_TubeColors;
+
       itk::TimeStamp m_lastGenerateDataTime;
       itk::TimeStamp m_lastRenderDataTime;
 
-      LocalStorage() { m_vtkTubeGraphAssembly = vtkSmartPointer<vtkAssembly>::New(); }
+      LocalStorage() : m_ClipStructures(false) { m_vtkTubeGraphAssembly = vtkSmartPointer<vtkAssembly>::New(); }
       ~LocalStorage() override {}
     };
 
@@ -29,14 +29,57 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkPlane.h>
 #include <vtkPointData.h>
 #include <vtkPoints.h>
+#include <vtkPolyDataAlgorithm.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkProperty.h>
 #include <vtkRenderer.h>
 #include <vtkSampleFunction.h>
 #include <vtkSphereSource.h>
 #include <vtkTubeFilter.h>
+#include <vtkUnsignedCharArray.h>
 #include <vtkUnsignedIntArray.h>
 
+#include <functional>
+
+namespace
+{
+  void HashCombine(std::size_t &key, double value)
+  {
+    key ^= std::hash<double>()(value) + 0x9e3779b9 + (key << 6) + (key >> 2);
+  }
+
+  void HashTubeElement(std::size_t &key, const mitk::TubeElement *element)
+  {
+    const mitk::Point3D &coordinates = element->GetCoordinates();
+    HashCombine(key, coordinates[0]);
+    HashCombine(key, coordinates[1]);
+    HashCombine(key, coordinates[2]);
+
+    auto circularElement = dynamic_cast<const mitk::CircularProfileTubeElement *>(element);
+    HashCombine(key, circularElement != nullptr ? circularElement->GetDiameter() : -1.0);
+  }
+
+  /** Keeps the output of a filter without the filter, so that the pipeline never overwrites changed colors. */
+  void SetOutputAsInput(vtkPolyDataAlgorithm *filter, vtkPolyDataMapper *mapper)
+  {
+    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->ShallowCopy(filter->GetOutput());
+    mapper->SetInputData(polyData);
+  }
+
+  void SetColorOfTube(vtkActor *tubeActor, const mitk::Color &color)
+  {
+    vtkPolyData *polyData = vtkPolyDataMapper::SafeDownCast(tubeActor->GetMapper())->GetInput();
+    auto colorScalars = vtkUnsignedCharArray::SafeDownCast(polyData->GetPointData()->GetArray("colorScalars"));
+    if (colorScalars == nullptr)
+      return;
+
+    for (vtkIdType i = 0; i < colorScalars->GetNumberOfTuples(); ++i)
+      colorScalars->SetTuple3(i, color[0], color[1], color[2]);
+    colorScalars->Modified();
+  }
+}
+
 mitk::TubeGraphVtkMapper3D::TubeGraphVtkMapper3D()
 {
 }
@@ -57,74 +100,33 @@ vtkProp *mitk::TubeGraphVtkMapper3D::GetVtkProp(mitk::BaseRenderer *renderer)
 
 void mitk::TubeGraphVtkMapper3D::GenerateDataForRenderer(mitk::BaseRenderer *renderer)
 {
-  bool renderTubeGraph(false);
   LocalStorage *ls = m_LSH.GetLocalStorage(renderer);
 
   TubeGraph::Pointer tubeGraph = const_cast<mitk::TubeGraph *>(this->GetInput());
+  if (tubeGraph.IsNull())
+  {
+    itkWarningMacro(<< "Input of tube graph mapper is nullptr!");
+    return;
+  }
   TubeGraphProperty::Pointer tubeGraphProperty =
     dynamic_cast<TubeGraphProperty *>(tubeGraph->GetProperty("Tube Graph.Visualization Information").GetPointer());
-
-  if (tubeGraph.IsNull() || tubeGraphProperty.IsNull())
+  if (tubeGraphProperty.IsNull())
   {
     itkWarningMacro(<< "Input of tube graph mapper is nullptr!");
     return;
   }
-  // Check if the tube graph has changed; if the data has changed, generate the spheres and tubes new;
-  if (tubeGraph->GetMTime() > ls->m_lastGenerateDataTime)
+
+  // Check if the tube graph has changed; if the data has changed, generate the changed spheres and tubes new;
+  if (tubeGraph->GetMTime() > ls->m_lastGenerateDataTime || this->ClipStructures() != ls->m_ClipStructures)
   {
     this->GenerateTubeGraphData(renderer);
-    renderTubeGraph = true;
+    this->RenderTubeGraphPropertyInformation(renderer);
   }
-  else
+  // Check if the tube graph property has changed; if the property has changed, render the visualization information
+  // new;
+  else if (tubeGraphProperty->GetMTime() > ls->m_lastRenderDataTime)
   {
-    // Check if the tube graph property has changed; if the property has changed, render the visualization information
-    // new;
-    if (tubeGraphProperty->GetMTime() > ls->m_lastRenderDataTime)
-    {
-      this->RenderTubeGraphPropertyInformation(renderer);
-      renderTubeGraph = true;
-    }
-  }
-
-  if (renderTubeGraph)
-  {
-    std::vector<TubeGraph::VertexDescriptorType> alreadyRenderedVertexList;
-    // don't render the sphere which is the root of the graph; so add it to the list before;
-    // TODO check both spheres
-    TubeGraph::VertexDescriptorType root = tubeGraph->GetRootVertex();
-    alreadyRenderedVertexList.push_back(root);
-
-    for (auto itTubes =
-           ls->m_vtkTubesActorMap.begin();
-         itTubes != ls->m_vtkTubesActorMap.end();
-         itTubes++)
-    {
-      if (tubeGraphProperty->IsTubeVisible(itTubes->first))
-      {
-        // add tube actor to assembly
-        ls->m_vtkTubeGraphAssembly->AddPart(itTubes->second);
-
-        // render the clipped spheres as end-cups of a tube and connections between tubes
-        if (std::find(alreadyRenderedVertexList.begin(), alreadyRenderedVertexList.end(), itTubes->first.first) ==
-            alreadyRenderedVertexList.end())
-        {
-          auto itSourceSphere =
-            ls->m_vtkSpheresActorMap.find(itTubes->first.first);
-          if (itSourceSphere != ls->m_vtkSpheresActorMap.end())
-            ls->m_vtkTubeGraphAssembly->AddPart(itSourceSphere->second);
-          alreadyRenderedVertexList.push_back(itSourceSphere->first);
-        }
-        if (std::find(alreadyRenderedVertexList.begin(), alreadyRenderedVertexList.end(), itTubes->first.second) ==
-            alreadyRenderedVertexList.end())
-        {
-          auto itTargetSphere =
-            ls->m_vtkSpheresActorMap.find(itTubes->first.second);
-          if (itTargetSphere != ls->m_vtkSpheresActorMap.end())
-            ls->m_vtkTubeGraphAssembly->AddPart(itTargetSphere->second);
-          alreadyRenderedVertexList.push_back(itTargetSphere->first);
-        }
-      }
-    }
+    this->RenderTubeGraphPropertyInformation(renderer);
   }
 
   //// Opacity TODO
@@ -137,9 +139,8 @@ void mitk::TubeGraphVtkMapper3D::GenerateDataForRenderer(mitk::BaseRenderer *ren
 
 void mitk::TubeGraphVtkMapper3D::RenderTubeGraphPropertyInformation(mitk::BaseRenderer *renderer)
 {
-  MITK_INFO << "Render tube graph property information!";
   LocalStorage *ls = m_LSH.GetLocalStorage(renderer);
-  TubeGraph::ConstPointer tubeGraph = this->GetInput();
+  TubeGraph::Pointer tubeGraph = const_cast<mitk::TubeGraph *>(this->GetInput());
   TubeGraphProperty::Pointer tubeGraphProperty =
     dynamic_cast<TubeGraphProperty *>(tubeGraph->GetProperty("Tube Graph.Visualization Information").GetPointer());
 
@@ -149,61 +150,44 @@ void mitk::TubeGraphVtkMapper3D::RenderTubeGraphPropertyInformation(mitk::BaseRe
     return;
   }
 
-  std::vector<TubeGraphVertex> allVertices = tubeGraph->GetVectorOfAllVertices();
-  for (auto vertex = allVertices.begin(); vertex != allVertices.end(); ++vertex)
+  for (auto itTubes = ls->m_vtkTubesActorMap.begin(); itTubes != ls->m_vtkTubesActorMap.end(); ++itTubes)
   {
-    TubeGraph::VertexDescriptorType vertexDesc = tubeGraph->GetVertexDescriptor(*vertex);
+    const bool visible = tubeGraphProperty->IsTubeVisible(itTubes->first);
+    itTubes->second->SetVisibility(visible);
+
+    // hidden tubes get their color when they are shown again
+    if (!visible)
+      continue;
 
+    const mitk::Color tubeColor = tubeGraphProperty->GetColorOfTube(itTubes->first);
+    mitk::Color &shownColor = ls->m_TubeColors[itTubes->first];
+    if (shownColor != tubeColor)
+    {
+      SetColorOfTube(itTubes->second, tubeColor);
+      shownColor = tubeColor;
+    }
+  }
+
+  // the spheres get the mean color of their visible tubes, the sphere at the root of the graph is not rendered
+  const TubeGraph::VertexDescriptorType root = tubeGraph->GetRootVertex();
+  for (auto itSpheres = ls->m_vtkSpheresActorMap.begin(); itSpheres != ls->m_vtkSpheresActorMap.end(); ++itSpheres)
+  {
     double sphereColorR = 0;
     double sphereColorG = 0;
     double sphereColorB = 0;
 
     int numberOfVisibleEdges = 0;
-    std::vector<TubeGraphEdge> allEdgesOfVertex = tubeGraph->GetAllEdgesOfAVertex(vertexDesc);
-    for (auto edge = allEdgesOfVertex.begin(); edge != allEdgesOfVertex.end(); ++edge)
+    const std::vector<TubeGraph::TubeDescriptorType> &tubes = ls->m_TubesOfVertex[itSpheres->first];
+    for (auto tube = tubes.begin(); tube != tubes.end(); ++tube)
     {
-      // get edge descriptor
-      EdgeDescriptorType edgeDesc = tubeGraph->GetEdgeDescriptor(*edge);
-
-      // get source and target vertex descriptor
-      std::pair<TubeGraphVertex, TubeGraphVertex> soureTargetPair = tubeGraph->GetVerticesOfAnEdge(edgeDesc);
-      TubeGraphVertex source = soureTargetPair.first;
-      TubeGraphVertex target = soureTargetPair.second;
-
-      // build tube descriptor [sourceId,targetId]
-      TubeGraph::TubeDescriptorType tube;
-      tube.first = tubeGraph->GetVertexDescriptor(source);
-      tube.second = tubeGraph->GetVertexDescriptor(target);
-
-      if (tubeGraphProperty->IsTubeVisible(tube))
-      {
-        mitk::Color tubeColor = tubeGraphProperty->GetColorOfTube(tube);
-
-        vtkSmartPointer<vtkDataArray> scalars =
-          ls->m_vtkTubesActorMap[tube]->GetMapper()->GetInput()->GetPointData()->GetScalars();
-        double color[3];
-        scalars->GetTuple(0, color);
-
-        if (color[0] != tubeColor[0] || color[1] != tubeColor[1] || color[2] != tubeColor[2])
-        {
-          int numberOfPoints = scalars->GetSize();
-
-          vtkSmartPointer<vtkUnsignedCharArray> colorScalars = vtkSmartPointer<vtkUnsignedCharArray>::New();
-          colorScalars->SetName("colorScalars");
-          colorScalars->SetNumberOfComponents(3);
-          colorScalars->SetNumberOfTuples(numberOfPoints);
-          for (int i = 0; i < numberOfPoints; i++)
-          {
-            scalars->InsertTuple3(i, tubeColor[0], tubeColor[1], tubeColor[2]);
-          }
-          ls->m_vtkTubesActorMap[tube]->GetMapper()->GetInput()->GetPointData()->SetActiveScalars("colorScalars");
-        }
-
-        sphereColorR += tubeColor[0];
-        sphereColorG += tubeColor[1];
-        sphereColorB += tubeColor[2];
-        numberOfVisibleEdges++;
-      }
+      if (!ls->m_vtkTubesActorMap[*tube]->GetVisibility())
+        continue;
+
+      const mitk::Color &tubeColor = ls->m_TubeColors[*tube];
+      sphereColorR += tubeColor[0];
+      sphereColorG += tubeColor[1];
+      sphereColorB += tubeColor[2];
+      numberOfVisibleEdges++;
     }
     if (numberOfVisibleEdges > 0)
     {
@@ -212,48 +196,172 @@ void mitk::TubeGraphVtkMapper3D::RenderTubeGraphPropertyInformation(mitk::BaseRe
       sphereColorB /= 255 * numberOfVisibleEdges;
     }
 
-    ls->m_vtkSpheresActorMap[vertexDesc]->GetProperty()->SetColor(sphereColorR, sphereColorG, sphereColorB);
+    itSpheres->second->SetVisibility(numberOfVisibleEdges > 0 && itSpheres->first != root);
+    itSpheres->second->GetProperty()->SetColor(sphereColorR, sphereColorG, sphereColorB);
   }
   ls->m_lastRenderDataTime.Modified();
 }
 
 void mitk::TubeGraphVtkMapper3D::GenerateTubeGraphData(mitk::BaseRenderer *renderer)
 {
-  MITK_INFO << "Render tube graph!";
   LocalStorage *ls = m_LSH.GetLocalStorage(renderer);
 
-  ls->m_vtkTubesActorMap.clear();
-  ls->m_vtkSpheresActorMap.clear();
-
   TubeGraph::Pointer tubeGraph = const_cast<mitk::TubeGraph *>(this->GetInput());
   TubeGraphProperty::Pointer tubeGraphProperty =
     dynamic_cast<TubeGraphProperty *>(tubeGraph->GetProperty("Tube Graph.Visualization Information").GetPointer());
   if (tubeGraphProperty.IsNull())
     MITK_INFO << "No tube graph property!! So no special render information...";
 
-  // render all edges as tubular structures using the vtkTubeFilter
-  std::vector<TubeGraphEdge> allEdges = tubeGraph->GetVectorOfAllEdges();
-  for (auto edge = allEdges.begin(); edge != allEdges.end(); ++edge)
+  const bool clipStructures = this->ClipStructures();
+  const TubeGraph::GraphType &graph = tubeGraph->GetGraph();
+  auto edgeProperties = boost::get(edge_properties, graph);
+  auto vertexProperties = boost::get(vertex_properties, graph);
+
+  // The key of a tube covers its elements including both vertices. The graph is walked by descriptors, looking
+  // descriptors up by the edge data would compare every edge of the graph.
+  std::map<TubeGraph::TubeDescriptorType, std::size_t> tubeKeys;
+  ls->m_TubesOfVertex.clear();
+
+  TubeGraph::EdgeIteratorType edgeIt, edgeEnd;
+  for (boost::tie(edgeIt, edgeEnd) = boost::edges(graph); edgeIt != edgeEnd; ++edgeIt)
+  {
+    const TubeGraph::TubeDescriptorType tube(boost::source(*edgeIt, graph), boost::target(*edgeIt, graph));
+
+    std::size_t key = 0;
+    HashTubeElement(key, vertexProperties[tube.first].GetTubeElement());
+    TubeGraphEdge edge = edgeProperties[*edgeIt];
+    std::vector<mitk::TubeElement *> allElements = edge.GetElementVector();
+    for (auto element = allElements.begin(); element != allElements.end(); ++element)
+      HashTubeElement(key, *element);
+    HashTubeElement(key, vertexProperties[tube.second].GetTubeElement());
+
+    tubeKeys[tube] = key;
+    ls->m_TubesOfVertex[tube.first].push_back(tube);
+    ls->m_TubesOfVertex[tube.second].push_back(tube);
+  }
+
+  // The key of a sphere covers its vertex. Clipped spheres and tubes also depend on all tubes of the vertex.
+  std::map<TubeGraph::VertexDescriptorType, std::size_t> sphereKeys;
+  TubeGraph::VertexIteratorType vertexIt, vertexEnd;
+  for (boost::tie(vertexIt, vertexEnd) = boost::vertices(graph); vertexIt != vertexEnd; ++vertexIt)
+  {
+    std::size_t key = 0;
+    HashTubeElement(key, vertexProperties[*vertexIt].GetTubeElement());
+    HashCombine(key, clipStructures ? 1.0 : 0.0);
+    if (clipStructures)
+    {
+      // independent of the order of the tubes
+      std::size_t tubesKey = 0;
+      const std::vector<TubeGraph::TubeDescriptorType> &tubes = ls->m_TubesOfVertex[*vertexIt];
+      for (auto tube = tubes.begin(); tube != tubes.end(); ++tube)
+        tubesKey += tubeKeys[*tube];
+      HashCombine(key, static_cast<double>(tubesKey));
+    }
+    sphereKeys[*vertexIt] = key;
+  }
+  for (auto tubeKey = tubeKeys.begin(); tubeKey != tubeKeys.end(); ++tubeKey)
+  {
+    HashCombine(tubeKey->second, static_cast<double>(sphereKeys[tubeKey->first.first]));
+    HashCombine(tubeKey->second, static_cast<double>(sphereKeys[tubeKey->first.second]));
+  }
+
+  // remove the actors of deleted or changed tubes and spheres
+  for (auto itTubes = ls->m_vtkTubesActorMap.begin(); itTubes != ls->m_vtkTubesActorMap.end();)
   {
-    this->GeneratePolyDataForTube(*edge, tubeGraph, tubeGraphProperty, renderer);
+    auto tubeKey = tubeKeys.find(itTubes->first);
+    if (tubeKey != tubeKeys.end() && tubeKey->second == ls->m_TubeGeometryKeys[itTubes->first])
+    {
+      ++itTubes;
+      continue;
+    }
+    ls->m_vtkTubeGraphAssembly->RemovePart(itTubes->second);
+    ls->m_TubeGeometryKeys.erase(itTubes->first);
+    ls->m_TubeColors.erase(itTubes->first);
+    itTubes = ls->m_vtkTubesActorMap.erase(itTubes);
+  }
+  for (auto itSpheres = ls->m_vtkSpheresActorMap.begin(); itSpheres != ls->m_vtkSpheresActorMap.end();)
+  {
+    auto sphereKey = sphereKeys.find(itSpheres->first);
+    if (sphereKey != sphereKeys.end() && sphereKey->second == ls->m_SphereGeometryKeys[itSpheres->first])
+    {
+      ++itSpheres;
+      continue;
+    }
+    ls->m_vtkTubeGraphAssembly->RemovePart(itSpheres->second);
+    ls->m_SphereGeometryKeys.erase(itSpheres->first);
+    itSpheres = ls->m_vtkSpheresActorMap.erase(itSpheres);
   }
 
-  // Generate all vertices as spheres
-  std::vector<TubeGraphVertex> allVertices = tubeGraph->GetVectorOfAllVertices();
-  for (auto vertex = allVertices.begin(); vertex != allVertices.end(); ++vertex)
+  // render the new edges as tubular structures using the vtkTubeFilter
+  std::set<TubeGraph::TubeDescriptorType> generatedTubes;
+  for (boost::tie(edgeIt, edgeEnd) = boost::edges(graph); edgeIt != edgeEnd; ++edgeIt)
   {
-    this->GeneratePolyDataForFurcation(*vertex, tubeGraph, renderer);
-    if (this->ClipStructures())
+    const TubeGraph::TubeDescriptorType tube(boost::source(*edgeIt, graph), boost::target(*edgeIt, graph));
+    if (ls->m_vtkTubesActorMap.find(tube) != ls->m_vtkTubesActorMap.end())
+      continue;
+
+    Color color;
+    if (tubeGraphProperty.IsNotNull())
+    {
+      color = tubeGraphProperty->GetColorOfTube(tube);
+    }
+    else
     {
-      this->ClipPolyData(*vertex, tubeGraph, tubeGraphProperty, renderer);
+      color[0] = 150;
+      color[1] = 150;
+      color[2] = 150;
     }
 
-    ls->m_lastGenerateDataTime.Modified();
+    TubeGraphEdge edge = edgeProperties[*edgeIt];
+    this->GeneratePolyDataForTube(edge, tube, tubeGraph, color, renderer);
+    ls->m_TubeGeometryKeys[tube] = tubeKeys[tube];
+    ls->m_TubeColors[tube] = color;
+    generatedTubes.insert(tube);
   }
+
+  // Generate the new vertices as spheres
+  std::set<TubeGraph::VertexDescriptorType> generatedSpheres;
+  for (boost::tie(vertexIt, vertexEnd) = boost::vertices(graph); vertexIt != vertexEnd; ++vertexIt)
+  {
+    if (ls->m_vtkSpheresActorMap.find(*vertexIt) != ls->m_vtkSpheresActorMap.end())
+      continue;
+
+    this->GeneratePolyDataForFurcation(vertexProperties[*vertexIt], *vertexIt, renderer);
+    ls->m_SphereGeometryKeys[*vertexIt] = sphereKeys[*vertexIt];
+    generatedSpheres.insert(*vertexIt);
+  }
+
+  // The new tubes are clipped at both of their vertices, the new spheres with all of their tubes
+  if (clipStructures)
+  {
+    std::set<TubeGraph::VertexDescriptorType> verticesToClip(generatedSpheres);
+    for (auto tube = generatedTubes.begin(); tube != generatedTubes.end(); ++tube)
+    {
+      verticesToClip.insert(tube->first);
+      verticesToClip.insert(tube->second);
+    }
+
+    for (auto vertex = verticesToClip.begin(); vertex != verticesToClip.end(); ++vertex)
+    {
+      this->ClipPolyData(
+        *vertex, tubeGraph, generatedTubes, generatedSpheres.find(*vertex) != generatedSpheres.end(), renderer);
+    }
+  }
+
+  for (auto tube = generatedTubes.begin(); tube != generatedTubes.end(); ++tube)
+    ls->m_vtkTubeGraphAssembly->AddPart(ls->m_vtkTubesActorMap[*tube]);
+  for (auto vertex = generatedSpheres.begin(); vertex != generatedSpheres.end(); ++vertex)
+    ls->m_vtkTubeGraphAssembly->AddPart(ls->m_vtkSpheresActorMap[*vertex]);
+
+  MITK_DEBUG << "Generated " << generatedTubes.size() << " of " << tubeKeys.size() << " tubes and "
+             << generatedSpheres.size() << " of " << sphereKeys.size() << " spheres.";
+
+  ls->m_ClipStructures = clipStructures;
+  ls->m_lastGenerateDataTime.Modified();
 }
 
-void mitk::TubeGraphVtkMapper3D::GeneratePolyDataForFurcation(mitk::TubeGraphVertex &vertex,
-                                                              const mitk::TubeGraph::Pointer &graph,
+void mitk::TubeGraphVtkMapper3D::GeneratePolyDataForFurcation(const mitk::TubeGraphVertex &vertex,
+                                                              const VertexDescriptorType &vertexDesc,
                                                               mitk::BaseRenderer *renderer)
 {
   LocalStorage *ls = this->m_LSH.GetLocalStorage(renderer);
@@ -277,43 +385,23 @@ void mitk::TubeGraphVtkMapper3D::GeneratePolyDataForFurcation(mitk::TubeGraphVer
   vtkSmartPointer<vtkPolyDataMapper> sphereMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
   vtkSmartPointer<vtkActor> sphereActor = vtkSmartPointer<vtkActor>::New();
 
-  sphereMapper->SetInputConnection(sphereSource->GetOutputPort());
+  SetOutputAsInput(sphereSource, sphereMapper);
   sphereActor->SetMapper(sphereMapper);
 
-  ls->m_vtkSpheresActorMap.insert(std::make_pair(graph->GetVertexDescriptor(vertex), sphereActor));
+  ls->m_vtkSpheresActorMap.insert(std::make_pair(vertexDesc, sphereActor));
 }
 
 void mitk::TubeGraphVtkMapper3D::GeneratePolyDataForTube(mitk::TubeGraphEdge &edge,
+                                                         const mitk::TubeGraph::TubeDescriptorType &tube,
                                                          const mitk::TubeGraph::Pointer &graph,
-                                                         const mitk::TubeGraphProperty::Pointer &graphProperty,
+                                                         const mitk::Color &color,
                                                          mitk::BaseRenderer *renderer)
 {
   LocalStorage *ls = this->m_LSH.GetLocalStorage(renderer);
 
-  // get edge descriptor
-  EdgeDescriptorType edgeDesc = graph->GetEdgeDescriptor(edge);
-
-  // get source and target vertex descriptor
-  std::pair<TubeGraphVertex, TubeGraphVertex> soureTargetPair = graph->GetVerticesOfAnEdge(edgeDesc);
-  TubeGraphVertex source = soureTargetPair.first;
-  TubeGraphVertex target = soureTargetPair.second;
-
-  // build tube descriptor [sourceId,targetId]
-  TubeGraph::TubeDescriptorType tube;
-  tube.first = graph->GetVertexDescriptor(source);
-  tube.second = graph->GetVertexDescriptor(target);
-
-  Color color;
-  if (graphProperty.IsNotNull())
-  {
-    color = graphProperty->GetColorOfTube(tube);
-  }
-  else
-  {
-    color[0] = 150;
-    color[1] = 150;
-    color[2] = 150;
-  }
+  // get source and target vertex
+  TubeGraphVertex source = graph->GetVertex(tube.first);
+  TubeGraphVertex target = graph->GetVertex(tube.second);
 
   // add 2 points for the source and target vertices.
   unsigned int numberOfPoints = edge.GetNumberOfElements() + 2;
@@ -419,20 +507,22 @@ void mitk::TubeGraphVtkMapper3D::GeneratePolyDataForTube(mitk::TubeGraphEdge &ed
   vtkSmartPointer<vtkPolyDataMapper> tubeMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
   vtkSmartPointer<vtkActor> tubeActor = vtkSmartPointer<vtkActor>::New();
 
-  tubeMapper->SetInputConnection(tubeFilter->GetOutputPort());
+  SetOutputAsInput(tubeFilter, tubeMapper);
   tubeActor->SetMapper(tubeMapper);
   tubeActor->GetProperty()->SetColor(color[0], color[1], color[2]);
 
   ls->m_vtkTubesActorMap.insert(std::pair<TubeGraph::TubeDescriptorType, vtkSmartPointer<vtkActor>>(tube, tubeActor));
 }
 
-void mitk::TubeGraphVtkMapper3D::ClipPolyData(mitk::TubeGraphVertex &vertex,
+void mitk::TubeGraphVtkMapper3D::ClipPolyData(const VertexDescriptorType &vertexDesc,
                                               const mitk::TubeGraph::Pointer &graph,
-                                              const mitk::TubeGraphProperty::Pointer &graphProperty,
+                                              const std::set<TubeGraph::TubeDescriptorType> &tubesToClip,
+                                              bool clipSphere,
                                               mitk::BaseRenderer *renderer)
 {
   LocalStorage *ls = this->m_LSH.GetLocalStorage(renderer);
 
+  TubeGraphVertex vertex = graph->GetVertex(vertexDesc);
   mitk::Point3D centerVertex = vertex.GetTubeElement()->GetCoordinates();
   float diameter = 2;
   if (dynamic_cast<const mitk::CircularProfileTubeElement *>(vertex.GetTubeElement()))
@@ -440,27 +530,17 @@ void mitk::TubeGraphVtkMapper3D::ClipPolyData(mitk::TubeGraphVertex &vertex,
     diameter = (dynamic_cast<const mitk::CircularProfileTubeElement *>(vertex.GetTubeElement()))->GetDiameter();
   }
 
-  TubeGraph::VertexDescriptorType vertexDesc = graph->GetVertexDescriptor(vertex);
-
   std::map<TubeGraph::TubeDescriptorType, vtkSmartPointer<vtkImplicitBoolean>> cylinderForClipping;
 
   // generate for all edges/tubes cylinders. With this structure you can clip the sphere and the other tubes, so that no
   // fragments are shown in the tube.
-  std::vector<TubeGraphEdge> allEdgesOfVertex = graph->GetAllEdgesOfAVertex(vertexDesc);
-  for (auto edge = allEdgesOfVertex.begin(); edge != allEdgesOfVertex.end(); ++edge)
+  const std::vector<TubeGraph::TubeDescriptorType> &tubesOfVertex = ls->m_TubesOfVertex[vertexDesc];
+  for (auto itTube = tubesOfVertex.begin(); itTube != tubesOfVertex.end(); ++itTube)
   {
-    // get edge descriptor
-    EdgeDescriptorType edgeDesc = graph->GetEdgeDescriptor(*edge);
-
-    // get source and target vertex descriptor
-    auto soureTargetPair = graph->GetVerticesOfAnEdge(edgeDesc);
-    TubeGraphVertex source = soureTargetPair.first;
-    TubeGraphVertex target = soureTargetPair.second;
-
-    // build tube descriptor [sourceId,targetId]
-    TubeGraph::TubeDescriptorType tube;
-    tube.first = graph->GetVertexDescriptor(source);
-    tube.second = graph->GetVertexDescriptor(target);
+    // the tube descriptor is [sourceId,targetId]
+    const TubeGraph::TubeDescriptorType &tube = *itTube;
+    TubeGraphEdge tubeEdge = graph->GetEdge(graph->GetEdgeDescriptorByVerices(tube.first, tube.second));
+    TubeGraphEdge *edge = &tubeEdge;
 
     // get reference point in the tube for the direction
     mitk::Point3D edgeDirectionPoint;
@@ -469,7 +549,7 @@ void mitk::TubeGraphVtkMapper3D::ClipPolyData(mitk::TubeGraphVertex &vertex,
     float radius = diameter / 2;
     // if the vertex is the source vertex of the edge get the first element of elementVector; otherwise get the last
     // element.
-    if (source == vertex)
+    if (tube.first == vertexDesc)
     {
       // if the edge has no element get the other vertex
       if ((*edge).GetNumberOfElements() != 0)
@@ -519,7 +599,7 @@ void mitk::TubeGraphVtkMapper3D::ClipPolyData(mitk::TubeGraphVertex &vertex,
       else
       {
         // Get the reference point, so the direction of the tube can be calculated
-        edgeDirectionPoint = target.GetTubeElement()->GetCoordinates();
+        edgeDirectionPoint = graph->GetVertex(tube.second).GetTubeElement()->GetCoordinates();
       }
     }
 
@@ -531,7 +611,7 @@ void mitk::TubeGraphVtkMapper3D::ClipPolyData(mitk::TubeGraphVertex &vertex,
       {
         double lastDistance = 0, distance = 0;
         // Get the first element behind the radius of the sphere; now backwards through the element list
-        int index = (*edge).GetNumberOfElements();
+        int index = (*edge).GetNumberOfElements() - 1;
         for ( ; index >= 0; --index)
         {
           mitk::Vector3D diffVec = (*edge).GetTubeElement(index)->GetCoordinates() - centerVertex;
@@ -575,7 +655,7 @@ void mitk::TubeGraphVtkMapper3D::ClipPolyData(mitk::TubeGraphVertex &vertex,
       else
       {
         // Get the reference point, so the direction of the tube can be calculated
-        edgeDirectionPoint = source.GetTubeElement()->GetCoordinates();
+        edgeDirectionPoint = graph->GetVertex(tube.first).GetTubeElement()->GetCoordinates();
       }
     }
 
@@ -672,45 +752,30 @@ void mitk::TubeGraphVtkMapper3D::ClipPolyData(mitk::TubeGraphVertex &vertex,
     // ls->m_vtkTubeGraphAssembly->AddPart(impActor);
   }
 
-  double sphereColorR = 0;
-  double sphereColorG = 0;
-  double sphereColorB = 0;
-
-  for (auto itClipStructure =
-         cylinderForClipping.begin();
-       itClipStructure != cylinderForClipping.end();
+  for (auto itClipStructure = cylinderForClipping.begin(); itClipStructure != cylinderForClipping.end();
        itClipStructure++)
   {
     vtkSmartPointer<vtkPolyDataMapper> sphereMapper =
       dynamic_cast<vtkPolyDataMapper *>(ls->m_vtkSpheresActorMap[vertexDesc]->GetMapper());
 
-    if (sphereMapper != nullptr)
+    if (clipSphere && sphereMapper != nullptr)
     {
       // first clip the sphere with the cylinder
       vtkSmartPointer<vtkClipPolyData> clipperSphere = vtkSmartPointer<vtkClipPolyData>::New();
       clipperSphere->SetInputData(sphereMapper->GetInput());
       clipperSphere->SetClipFunction(itClipStructure->second);
-      clipperSphere->GenerateClippedOutputOn();
       clipperSphere->Update();
 
-      sphereMapper->SetInputConnection(clipperSphere->GetOutputPort());
-      sphereMapper->Update();
+      SetOutputAsInput(clipperSphere, sphereMapper);
     }
 
-    mitk::Color tubeColor = graphProperty->GetColorOfTube(itClipStructure->first);
-    sphereColorR += tubeColor[0];
-    sphereColorG += tubeColor[1];
-    sphereColorB += tubeColor[2];
-
-    // than clip with all other tubes
-    for (auto itTobBeClipped =
-           cylinderForClipping.begin();
-         itTobBeClipped != cylinderForClipping.end();
+    // than clip the new tubes with all other tubes
+    for (auto itTobBeClipped = cylinderForClipping.begin(); itTobBeClipped != cylinderForClipping.end();
          itTobBeClipped++)
     {
       TubeGraph::TubeDescriptorType toBeClippedTube = itTobBeClipped->first;
 
-      if (itClipStructure->first != toBeClippedTube)
+      if (itClipStructure->first != toBeClippedTube && tubesToClip.find(toBeClippedTube) != tubesToClip.end())
       {
         vtkSmartPointer<vtkPolyDataMapper> tubeMapper =
           dynamic_cast<vtkPolyDataMapper *>(ls->m_vtkTubesActorMap[toBeClippedTube]->GetMapper());
@@ -719,26 +784,15 @@ void mitk::TubeGraphVtkMapper3D::ClipPolyData(mitk::TubeGraphVertex &vertex,
         {
           // first clip the sphere with the cylinder
           vtkSmartPointer<vtkClipPolyData> clipperTube = vtkSmartPointer<vtkClipPolyData>::New();
-          tubeMapper->Update();
           clipperTube->SetInputData(tubeMapper->GetInput());
           clipperTube->SetClipFunction(itClipStructure->second);
-          clipperTube->GenerateClippedOutputOn();
           clipperTube->Update();
 
-          tubeMapper->SetInputConnection(clipperTube->GetOutputPort());
-          tubeMapper->Update();
+          SetOutputAsInput(clipperTube, tubeMapper);
         }
       }
     }
   }
-  if (cylinderForClipping.size() != 0)
-  {
-    sphereColorR /= 255 * cylinderForClipping.size();
-    sphereColorG /= 255 * cylinderForClipping.size();
-    sphereColorB /= 255 * cylinderForClipping.size();
-  }
-
-  ls->m_vtkSpheresActorMap[vertexDesc]->GetProperty()->SetColor(sphereColorR, sphereColorG, sphereColorB);
 }
 
 bool mitk::TubeGraphVtkMapper3D::ClipStructures()
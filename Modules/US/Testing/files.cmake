@@ -1,6 +1,8 @@
 SET(MODULE_TESTS
    mitkUSDeviceTest.cpp
    mitkUSProbeTest.cpp
+   mitkUSImagePoolTest.cpp
+   mitkUSScanConverterTest.cpp
 
    # -----------------------------------------------------------------------
 
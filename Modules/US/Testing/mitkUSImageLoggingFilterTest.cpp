@@ -40,6 +40,8 @@ class mitkUSImageLoggingFilterTestSuite : public mitk::TestFixture
   MITK_TEST(TestSavingAfterMupltipleUpdateCalls);
   MITK_TEST(TestFilterWithEmptyImages);
   MITK_TEST(TestFilterWithInvalidPath);
+  MITK_TEST(TestStreaming);
+  MITK_TEST(TestStreamingIntoContainer);
   //MITK_TEST(TestJpgFileExtension); //bug 19614
   CPPUNIT_TEST_SUITE_END();
 
@@ -162,6 +164,73 @@ public:
                                mitk::Exception);
   }
 
+  void TestStreaming()
+  {
+  m_TestFilter->SetInput(m_RandomSingleSliceImage);
+  m_TestFilter->SetMaximumQueueSize(2);
+  m_TestFilter->StartStreaming(m_TemporaryTestDirectory);
+  CPPUNIT_ASSERT_MESSAGE("Testing if streaming is started", m_TestFilter->IsStreaming());
+
+  for(int i=0; i<5; i++)
+    {
+    m_TestFilter->Modified();
+    m_TestFilter->Update();
+    std::stringstream testmessage;
+    testmessage << "testmessage" << i;
+    m_TestFilter->AddMessageToCurrentImage(testmessage.str());
+    }
+
+  std::vector<std::string> filenames;
+  std::string csvFileName;
+  m_TestFilter->StopStreaming(filenames,csvFileName);
+  CPPUNIT_ASSERT_MESSAGE("Testing if streaming is stopped", !m_TestFilter->IsStreaming());
+  CPPUNIT_ASSERT_MESSAGE("Testing if every image was written",filenames.size() == 5);
+  CPPUNIT_ASSERT_MESSAGE("Testing statistics",m_TestFilter->GetStreamingStatistics().WrittenImages == 5);
+  CPPUNIT_ASSERT_MESSAGE("Testing if no image was dropped",m_TestFilter->GetStreamingStatistics().DroppedImages == 0);
+  CPPUNIT_ASSERT_MESSAGE("Testing if the queue size was respected",m_TestFilter->GetStreamingStatistics().MaximumQueueFill <= 2);
+  for(size_t i=0; i<filenames.size(); i++)
+    CPPUNIT_ASSERT_MESSAGE("Testing if image file exists",Poco::File(filenames.at(i).c_str()).exists());
+  CPPUNIT_ASSERT_MESSAGE("Testing if csv file exists",Poco::File(csvFileName.c_str()).exists());
+
+  //clean up
+  for(size_t i=0; i<filenames.size(); i++) std::remove(filenames.at(i).c_str());
+  std::remove(csvFileName.c_str());
+  }
+
+  void TestStreamingIntoContainer()
+  {
+  m_TestFilter->SetInput(m_RandomSingleSliceImage);
+  m_TestFilter->SetStreamIntoContainer(true);
+  m_TestFilter->StartStreaming(m_TemporaryTestDirectory);
+
+  for(int i=0; i<3; i++)
+    {
+    m_TestFilter->Modified();
+    m_TestFilter->Update();
+    }
+
+  //an image of a different size does not fit into the container
+  m_TestFilter->SetInput(m_RandomRestImage1);
+  m_TestFilter->Update();
+
+  std::vector<std::string> filenames;
+  std::string csvFileName;
+  m_TestFilter->StopStreaming(filenames,csvFileName);
+  CPPUNIT_ASSERT_MESSAGE("Testing if one container was written",filenames.size() == 1);
+  CPPUNIT_ASSERT_MESSAGE("Testing statistics",m_TestFilter->GetStreamingStatistics().WrittenImages == 3);
+  CPPUNIT_ASSERT_MESSAGE("Testing if the image of different size was dropped",m_TestFilter->GetStreamingStatistics().DroppedImages == 1);
+
+  mitk::Image::Pointer container = mitk::IOUtil::Load<mitk::Image>(filenames.at(0));
+  CPPUNIT_ASSERT_MESSAGE("Testing if the container can be read",container.IsNotNull());
+  CPPUNIT_ASSERT_MESSAGE("Testing number of images in the container",container->GetDimension(container->GetDimension()-1) == 3);
+
+  //clean up
+  std::string dataFileName = filenames.at(0).substr(0, filenames.at(0).size()-5) + ".raw";
+  std::remove(filenames.at(0).c_str());
+  std::remove(dataFileName.c_str());
+  std::remove(csvFileName.c_str());
+  }
+
   void TestJpgFileExtension()
   {
   CPPUNIT_ASSERT_MESSAGE("Testing setting of jpg extension.",m_TestFilter->SetImageFilesExtension(".jpg"));
@@ -0,0 +1,90 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkUSImagePool.h"
+#include "mitkTestingMacros.h"
+
+
+class mitkUSImagePoolTestClass
+{
+public:
+
+  static void TestRecyclesUnusedImages()
+  {
+    mitk::USImagePool::Pointer pool = mitk::USImagePool::New();
+    pool->SetPoolSize(2);
+
+    const unsigned int dimensions[2] = { 64, 32 };
+    const mitk::PixelType pixelType = mitk::MakeScalarPixelType<unsigned char>();
+
+    for (int frame = 0; frame < 10; ++frame)
+    {
+      mitk::Image::Pointer image = pool->AcquireImage(pixelType, 2, dimensions);
+      MITK_TEST_CONDITION_REQUIRED(image.IsNotNull() && image->GetDimension(0) == 64 && image->GetDimension(1) == 32,
+        "Acquired image should have the requested dimensions");
+    }
+
+    MITK_TEST_CONDITION_REQUIRED(pool->GetNumberOfAllocations() == 1, "Released images should be recycled");
+    MITK_TEST_CONDITION_REQUIRED(pool->GetNumberOfMisses() == 0, "No request should have missed the pool");
+  }
+
+  static void TestDoesNotHandOutImagesInUse()
+  {
+    mitk::USImagePool::Pointer pool = mitk::USImagePool::New();
+    pool->SetPoolSize(2);
+
+    const unsigned int dimensions[2] = { 16, 16 };
+    const mitk::PixelType pixelType = mitk::MakeScalarPixelType<unsigned char>();
+
+    mitk::Image::Pointer first = pool->AcquireImage(pixelType, 2, dimensions);
+    mitk::Image::Pointer second = pool->AcquireImage(pixelType, 2, dimensions);
+    mitk::Image::Pointer third = pool->AcquireImage(pixelType, 2, dimensions);
+
+    MITK_TEST_CONDITION_REQUIRED(first != second && second != third && first != third,
+      "Images that are still referenced should not be handed out again");
+    MITK_TEST_CONDITION_REQUIRED(pool->GetNumberOfMisses() == 1, "Third request should have missed the pool");
+  }
+
+  static void TestReallocatesOnGeometryChange()
+  {
+    mitk::USImagePool::Pointer pool = mitk::USImagePool::New();
+    pool->SetPoolSize(1);
+
+    const unsigned int smallDimensions[2] = { 16, 16 };
+    const unsigned int largeDimensions[2] = { 32, 32 };
+    const mitk::PixelType pixelType = mitk::MakeScalarPixelType<unsigned char>();
+
+    pool->AcquireImage(pixelType, 2, smallDimensions);
+    mitk::Image::Pointer image = pool->AcquireImage(pixelType, 2, largeDimensions);
+
+    MITK_TEST_CONDITION_REQUIRED(image->GetDimension(0) == 32, "Image should be reallocated with the new dimensions");
+    MITK_TEST_CONDITION_REQUIRED(pool->GetNumberOfAllocations() == 2, "Pool should have allocated twice");
+  }
+};
+
+/**
+* This function is testing methods of the class USImagePool.
+*/
+int mitkUSImagePoolTest(int /* argc */, char* /*argv*/[])
+{
+  MITK_TEST_BEGIN("mitkUSImagePoolTest");
+
+  mitkUSImagePoolTestClass::TestRecyclesUnusedImages();
+  mitkUSImagePoolTestClass::TestDoesNotHandOutImagesInUse();
+  mitkUSImagePoolTestClass::TestReallocatesOnGeometryChange();
+
+  MITK_TEST_END();
+}
@@ -0,0 +1,249 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkUSScanConverter.h"
+#include "mitkTestingMacros.h"
+#include "mitkImageReadAccessor.h"
+#include "mitkImageWriteAccessor.h"
+
+#include <cmath>
+
+class mitkUSScanConverterTestClass
+{
+public:
+
+  static mitk::USScanConverter::ScanGeometry CreateLinearGeometry()
+  {
+    mitk::USScanConverter::ScanGeometry geometry;
+    geometry.NumberOfLines = 4;
+    geometry.SamplesPerLine = 3;
+    geometry.Layout = mitk::USScanConverter::LinesAlongSamples;
+    geometry.LinePositionStep = 1;
+    geometry.SampleDepthStep = 1;
+    return geometry;
+  }
+
+  static mitk::USScanConverter::ScanGeometry CreateSectorGeometry()
+  {
+    mitk::USScanConverter::ScanGeometry geometry;
+    geometry.NumberOfLines = 3;
+    geometry.SamplesPerLine = 5;
+    geometry.Layout = mitk::USScanConverter::SamplesAlongLines;
+    geometry.FirstLineAngle = -0.2;
+    geometry.LineAngleStep = 0.2;
+    geometry.ProbeRadius = 10;
+    geometry.SampleDepthStep = 1;
+    return geometry;
+  }
+
+  static void TestLinearIdentity()
+  {
+    mitk::USScanConverter::Pointer converter = mitk::USScanConverter::New();
+    converter->SetScanGeometry(CreateLinearGeometry());
+    converter->SetOutputSpacing(1, 1);
+
+    unsigned int dimensions[2];
+    converter->GetOutputDimensions(dimensions);
+    MITK_TEST_CONDITION_REQUIRED(dimensions[0] == 4 && dimensions[1] == 3,
+      "Output of a linear scan with the spacing of the input should have the size of the input");
+
+    const unsigned char input[12] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+    unsigned char output[12];
+    converter->Convert(input, output);
+
+    bool equal = true;
+    for (int i = 0; i < 12; ++i)
+    {
+      equal = equal && input[i] == output[i];
+    }
+    MITK_TEST_CONDITION_REQUIRED(equal, "Linear scan with the spacing of the input should be copied");
+  }
+
+  static void TestLinearInterpolation()
+  {
+    mitk::USScanConverter::ScanGeometry geometry = CreateLinearGeometry();
+    geometry.Layout = mitk::USScanConverter::SamplesAlongLines;
+
+    mitk::USScanConverter::Pointer converter = mitk::USScanConverter::New();
+    converter->SetScanGeometry(geometry);
+    converter->SetOutputSpacing(0.5, 0.5);
+
+    unsigned int dimensions[2];
+    converter->GetOutputDimensions(dimensions);
+    MITK_TEST_CONDITION_REQUIRED(dimensions[0] == 7 && dimensions[1] == 5, "Output should have half the spacing");
+
+    // value = 10 * line + sample, samples of one line are contiguous
+    float input[12];
+    for (int line = 0; line < 4; ++line)
+    {
+      for (int sample = 0; sample < 3; ++sample)
+      {
+        input[line * 3 + sample] = 10.0f * line + sample;
+      }
+    }
+
+    float output[35];
+    converter->Convert(input, output);
+
+    bool interpolated = true;
+    for (unsigned int row = 0; row < dimensions[1]; ++row)
+    {
+      for (unsigned int column = 0; column < dimensions[0]; ++column)
+      {
+        const float expected = 10.0f * 0.5f * column + 0.5f * row;
+        interpolated = interpolated && std::abs(output[row * dimensions[0] + column] - expected) < 1e-4;
+      }
+    }
+    MITK_TEST_CONDITION_REQUIRED(interpolated, "Output should be interpolated bilinearly");
+  }
+
+  static void TestSector()
+  {
+    mitk::USScanConverter::Pointer converter = mitk::USScanConverter::New();
+    converter->SetScanGeometry(CreateSectorGeometry());
+    converter->SetOutputSpacing(0.25, 0.25);
+    converter->SetBackgroundValue(-1);
+
+    unsigned int dimensions[2];
+    converter->GetOutputDimensions(dimensions);
+    mitk::Point2D origin = converter->GetOutputOrigin();
+
+    MITK_TEST_CONDITION_REQUIRED(std::abs(origin[0] + 14 * std::sin(0.2)) < 1e-6 &&
+      std::abs(origin[1] - 10 * std::cos(0.2)) < 1e-6, "Output origin should be the corner of the bounding box");
+
+    // the value is the depth below the probe surface
+    float input[15];
+    for (int line = 0; line < 3; ++line)
+    {
+      for (int sample = 0; sample < 5; ++sample)
+      {
+        input[line * 5 + sample] = static_cast<float>(sample);
+      }
+    }
+
+    std::vector<float> output(dimensions[0] * dimensions[1]);
+    converter->Convert(input, output.data());
+
+    MITK_TEST_CONDITION_REQUIRED(output[0] == -1, "Corner outside of the fan should get the background value");
+
+    bool isDepth = true;
+    unsigned int inside = 0;
+    for (unsigned int row = 0; row < dimensions[1]; ++row)
+    {
+      for (unsigned int column = 0; column < dimensions[0]; ++column)
+      {
+        const double x = origin[0] + 0.25 * column;
+        const double y = origin[1] + 0.25 * row;
+        const double radius = std::sqrt(x * x + y * y);
+        const double angle = std::atan2(x, y);
+        if (radius < 10 + 1e-3 || radius > 14 - 1e-3 || std::abs(angle) > 0.2 - 1e-3)
+        {
+          continue;
+        }
+
+        ++inside;
+        isDepth = isDepth && std::abs(output[row * dimensions[0] + column] - (radius - 10)) < 1e-4;
+      }
+    }
+    MITK_TEST_CONDITION_REQUIRED(inside > 0 && isDepth, "Pixels inside of the fan should be interpolated");
+  }
+
+  static void TestTableIsOnlyRebuiltOnChanges()
+  {
+    mitk::USScanConverter::Pointer converter = mitk::USScanConverter::New();
+    converter->SetScanGeometry(CreateLinearGeometry());
+
+    const short input[12] = { 0 };
+    short output[12];
+    converter->Convert(input, output);
+    converter->SetScanGeometry(CreateLinearGeometry());
+    converter->SetOutputSpacing(1, 1);
+    converter->Convert(input, output);
+
+    MITK_TEST_CONDITION_REQUIRED(converter->GetNumberOfTableUpdates() == 1,
+      "Table should not be rebuilt for unchanged parameters");
+
+    converter->SetOutputSpacing(0.5, 1);
+    unsigned int dimensions[2];
+    converter->GetOutputDimensions(dimensions);
+
+    MITK_TEST_CONDITION_REQUIRED(converter->GetNumberOfTableUpdates() == 2 && dimensions[0] == 7,
+      "Table should be rebuilt for a new output spacing");
+  }
+
+  static void TestConvertImage()
+  {
+    mitk::USScanConverter::Pointer converter = mitk::USScanConverter::New();
+    converter->SetScanGeometry(CreateLinearGeometry());
+    converter->SetOutputSpacing(0.5, 1);
+
+    const unsigned int dimensions[3] = { 4, 3, 2 };
+    mitk::Image::Pointer input = mitk::Image::New();
+    input->Initialize(mitk::MakeScalarPixelType<float>(), 3, dimensions);
+    {
+      mitk::ImageWriteAccessor accessor(input);
+      float* data = static_cast<float*>(accessor.GetData());
+      for (int i = 0; i < 24; ++i)
+      {
+        data[i] = i < 12 ? 1.0f : 2.0f;
+      }
+    }
+
+    mitk::Image::Pointer output = converter->Convert(input);
+    MITK_TEST_CONDITION_REQUIRED(output->GetDimension(0) == 7 && output->GetDimension(1) == 3 &&
+      output->GetDimension(2) == 2, "Every slice of the image should be converted");
+    MITK_TEST_CONDITION_REQUIRED(output->GetGeometry()->GetSpacing()[0] == 0.5,
+      "Output should have the output spacing");
+
+    mitk::ImageReadAccessor accessor(output);
+    const float* data = static_cast<const float*>(accessor.GetData());
+    MITK_TEST_CONDITION_REQUIRED(data[0] == 1.0f && data[21] == 2.0f, "Slices should be converted separately");
+
+    mitk::Image::Pointer wrongInput = mitk::Image::New();
+    wrongInput->Initialize(mitk::MakeScalarPixelType<float>(), 2, dimensions + 1);
+    MITK_TEST_FOR_EXCEPTION_BEGIN(mitk::Exception)
+      converter->Convert(wrongInput);
+    MITK_TEST_FOR_EXCEPTION_END(mitk::Exception)
+  }
+
+  static void TestInvalidGeometry()
+  {
+    mitk::USScanConverter::Pointer converter = mitk::USScanConverter::New();
+    mitk::USScanConverter::ScanGeometry geometry = CreateLinearGeometry();
+    geometry.NumberOfLines = 1;
+
+    MITK_TEST_FOR_EXCEPTION_BEGIN(mitk::Exception)
+      converter->SetScanGeometry(geometry);
+    MITK_TEST_FOR_EXCEPTION_END(mitk::Exception)
+  }
+};
+
+/**
+* This function is testing methods of the class USScanConverter.
+*/
+int mitkUSScanConverterTest(int /* argc */, char* /*argv*/[])
+{
+  MITK_TEST_BEGIN("mitkUSScanConverterTest");
+
+  mitkUSScanConverterTestClass::TestLinearIdentity();
+  mitkUSScanConverterTestClass::TestLinearInterpolation();
+  mitkUSScanConverterTestClass::TestSector();
+  mitkUSScanConverterTestClass::TestTableIsOnlyRebuiltOnChanges();
+  mitkUSScanConverterTestClass::TestConvertImage();
+  mitkUSScanConverterTestClass::TestInvalidGeometry();
+
+  MITK_TEST_END();
+}
@@ -17,9 +17,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkIGTLMessageToUSImageFilter.h>
 #include <igtlImageMessage.h>
 #include <itkByteSwapper.h>
+#include <mitkImageWriteAccessor.h>
 
 #include <vtkSmartPointer.h>
 
+#include <algorithm>
+
 void mitk::IGTLMessageToUSImageFilter::GetNextRawImage(
   std::vector<mitk::Image::Pointer>& imgVector)
 {
@@ -37,6 +40,8 @@ void mitk::IGTLMessageToUSImageFilter::GetNextRawImage(
     return;
   }
 
+  this->ReleaseUnusedMessages();
+
   igtl::MessageBase::Pointer msgBase = msg->GetMessage();
   igtl::ImageMessage* imgMsg = (igtl::ImageMessage*)(msgBase.GetPointer());
 
@@ -84,22 +89,14 @@ void mitk::IGTLMessageToUSImageFilter::Initiate(mitk::Image::Pointer& img,
   igtl::ImageMessage* msg,
   bool big_endian)
 {
-  typedef itk::Image<TPixel, 3> ImageType;
-
-  typename ImageType::Pointer output = ImageType::New();
-  typename ImageType::RegionType region;
-  typename ImageType::RegionType::SizeType size;
-  typename ImageType::RegionType::IndexType index;
-  typename ImageType::SpacingType spacing;
-  typename ImageType::PointType origin;
-
   // Copy dimensions
   int dims[3];
   msg->GetDimensions(dims);
+  unsigned int dimensions[3];
   size_t num_pixel = 1;
   for (size_t i = 0; i < 3; i++)
   {
-    size[i] = dims[i];
+    dimensions[i] = dims[i];
     num_pixel *= dims[i];
   }
 
@@ -116,8 +113,6 @@ void mitk::IGTLMessageToUSImageFilter::Initiate(mitk::Image::Pointer& img,
     }
   }
 
-  index.Fill(0);
-
   float matF[4][4];
   msg->GetMatrix(matF);
   vtkSmartPointer<vtkMatrix4x4> vtkMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
@@ -127,50 +122,71 @@ void mitk::IGTLMessageToUSImageFilter::Initiate(mitk::Image::Pointer& img,
       vtkMatrix->SetElement(i, j, matF[i][j]);
 
   float spacingMsg[3];
-
   msg->GetSpacing(spacingMsg);
-
+  mitk::Vector3D spacing;
   for (int i = 0; i < 3; ++i)
     spacing[i] = spacingMsg[i];
 
-  region.SetSize(size);
-  region.SetIndex(index);
-  output->SetRegions(region);
-  output->SetSpacing(spacing);
-  output->Allocate();
+  float iorigin[3];
+  msg->GetOrigin(iorigin);
+  mitk::Point3D origin;
+  for (size_t i = 0; i < 3; i++)
+    origin[i] = iorigin[i];
 
+  const mitk::PixelType pixelType = mitk::MakeScalarPixelType<TPixel>();
   TPixel* in = (TPixel*)msg->GetScalarPointer();
-  TPixel* out = (TPixel*)output->GetBufferPointer();
-  memcpy(out, in, num_pixel * sizeof(TPixel));
-  if (big_endian)
+
+  // the byte order of the message only has to be changed if it differs from the system
+  const bool swap = big_endian != itk::ByteSwapper<TPixel>::SystemIsBigEndian();
+
+  if (m_ZeroCopy && !swap)
   {
-    // Even though this method is called "FromSystemToBigEndian", it also swaps
-    // "FromBigEndianToSystem".
-    // This makes sense, but might be confusing at first glance.
-    itk::ByteSwapper<TPixel>::SwapRangeFromSystemToBigEndian(out, num_pixel);
+    img = mitk::Image::New();
+    img->Initialize(pixelType, 3, dimensions);
+    img->SetImportVolume(in, 0, 0, mitk::Image::ReferenceMemory);
+    m_ReferencedMessages.push_back(ReferencedMessageType(img, msg));
   }
   else
   {
-    itk::ByteSwapper<TPixel>::SwapRangeFromSystemToLittleEndian(out, num_pixel);
+    img = m_ImagePool->AcquireImage(pixelType, 3, dimensions);
+    img->SetImportVolume(in, 0, 0, mitk::Image::CopyMemory);
+
+    if (swap)
+    {
+      mitk::ImageWriteAccessor accessor(img);
+      TPixel* out = (TPixel*)accessor.GetData();
+      // Even though this method is called "FromSystemToBigEndian", it also swaps
+      // "FromBigEndianToSystem".
+      // This makes sense, but might be confusing at first glance.
+      if (big_endian)
+        itk::ByteSwapper<TPixel>::SwapRangeFromSystemToBigEndian(out, num_pixel);
+      else
+        itk::ByteSwapper<TPixel>::SwapRangeFromSystemToLittleEndian(out, num_pixel);
+    }
   }
 
-  img = mitk::Image::New();
-  img->InitializeByItk(output.GetPointer());
-  img->SetVolume(output->GetBufferPointer());
+  img->GetGeometry()->SetSpacing(spacing);
+  img->GetGeometry()->SetOrigin(origin);
   //img->GetGeometry()->SetIndexToWorldTransformByVtkMatrix(vtkMatrix);
   m_previousImage = img;
+}
 
-  float iorigin[3];
-  msg->GetOrigin(iorigin);
-  for (size_t i = 0; i < 3; i++)
-  {
-    origin[i] = iorigin[i];
-  }
-  output->SetOrigin(origin);
+bool mitk::IGTLMessageToUSImageFilter::IsImageUnused(const mitk::Image* image) const
+{
+  // the previous image is handed out again if the next message is invalid
+  return image != m_previousImage.GetPointer() && image->GetReferenceCount() <= 1;
+}
+
+void mitk::IGTLMessageToUSImageFilter::ReleaseUnusedMessages()
+{
+  m_ReferencedMessages.erase(std::remove_if(m_ReferencedMessages.begin(), m_ReferencedMessages.end(),
+    [this](const ReferencedMessageType& entry) { return this->IsImageUnused(entry.first); }),
+    m_ReferencedMessages.end());
 }
 
 mitk::IGTLMessageToUSImageFilter::IGTLMessageToUSImageFilter()
-  : m_upstream(nullptr)
+  : m_upstream(nullptr),
+    m_ZeroCopy(false)
 {
   MITK_DEBUG << "Instantiated this (" << this << ") mitkIGTMessageToUSImageFilter\n";
 }
@@ -23,8 +23,23 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkIGTLMessageSource.h>
 #include <igtlImageMessage.h>
 
+#include <utility>
+
 namespace mitk
 {
+  /**
+  * \brief Converts the image messages of an IGTLMessageSource to mitk::Images.
+  *
+  * By default, the pixel data of each message is copied once into an output
+  * image that is recycled from the image pool of the source (see
+  * USImageSource::GetImagePool()) as soon as no consumer references it
+  * anymore, so no image memory has to be allocated per frame.
+  *
+  * If zero copy mode is enabled (see SetZeroCopy()), the output image wraps
+  * the pixel buffer of the message directly. The filter then keeps the message
+  * alive for as long as the image is referenced by anyone else. Messages whose
+  * byte order differs from the system byte order are always copied.
+  */
   class MITKUS_EXPORT IGTLMessageToUSImageFilter : public USImageSource
   {
   public:
@@ -51,6 +66,14 @@ namespace mitk
     */
     void ConnectTo(mitk::IGTLMessageSource* UpstreamFilter);
 
+    /**
+    *\brief If enabled, the output images reference the pixel buffer of the
+    * received messages instead of copying it.
+    */
+    itkSetMacro(ZeroCopy, bool);
+    itkGetConstMacro(ZeroCopy, bool);
+    itkBooleanMacro(ZeroCopy);
+
   protected:
     IGTLMessageToUSImageFilter();
 
@@ -64,8 +87,19 @@ namespace mitk
     void GetNextRawImage(std::vector<mitk::Image::Pointer>& imgVector) override;
 
   private:
+    typedef std::pair<mitk::Image::Pointer, igtl::MessageBase::Pointer> ReferencedMessageType;
+
     mitk::IGTLMessageSource* m_upstream;
     mitk::Image::Pointer m_previousImage;
+
+    bool m_ZeroCopy;
+
+    /**
+     * \brief Messages whose pixel buffer is referenced by an output image in
+     * zero copy mode, together with that image.
+     */
+    std::vector<ReferencedMessageType> m_ReferencedMessages;
+
     /**
      * \brief Templated method to copy the data of the OIGTL message to the image, depending
      * on the pixel type contained in the message.
@@ -76,6 +110,16 @@ namespace mitk
      */
     template <typename TPixel>
     void Initiate(mitk::Image::Pointer& img, igtl::ImageMessage* msg, bool big_endian);
+
+    /**
+     * \brief Returns true if nobody but this filter holds a reference to the given image.
+     */
+    bool IsImageUnused(const mitk::Image* image) const;
+
+    /**
+     * \brief Releases all messages whose wrapping image is no longer referenced.
+     */
+    void ReleaseUnusedMessages();
   };
 }  // namespace mitk
 
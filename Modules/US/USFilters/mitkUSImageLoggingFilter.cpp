@@ -20,18 +20,79 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <Poco/Path.h>
 
 #include <algorithm>
+#include <cstdio>
 #include <mitkIOMimeTypes.h>
 #include <mitkCoreServices.h>
 #include <mitkIMimeTypeProvider.h>
+#include <mitkImageReadAccessor.h>
+#include <itkImageIOBase.h>
+#include "itk_zlib.h"
+
+namespace
+{
+  /** Returns the nrrd name of the component type, or an empty string if it is not supported */
+  std::string GetNrrdComponentType(const mitk::PixelType& pixelType)
+  {
+    switch (pixelType.GetComponentType())
+    {
+    case itk::ImageIOBase::UCHAR: return "uchar";
+    case itk::ImageIOBase::CHAR: return "signed char";
+    case itk::ImageIOBase::USHORT: return "ushort";
+    case itk::ImageIOBase::SHORT: return "short";
+    case itk::ImageIOBase::UINT: return "uint";
+    case itk::ImageIOBase::INT: return "int";
+    case itk::ImageIOBase::ULONG: return sizeof(unsigned long) == 8 ? "uint64" : "uint";
+    case itk::ImageIOBase::LONG: return sizeof(long) == 8 ? "int64" : "int";
+    case itk::ImageIOBase::FLOAT: return "float";
+    case itk::ImageIOBase::DOUBLE: return "double";
+    default: return "";
+    }
+  }
+
+  /** Number of bytes of the first time step of the image */
+  size_t GetImageSizeInBytes(const mitk::Image* image)
+  {
+    size_t size = image->GetPixelType().GetSize();
+    for (unsigned int i = 0; i < image->GetDimension() && i < 3; ++i)
+    {
+      size *= image->GetDimension(i);
+    }
+    return size;
+  }
+}
 
 
 mitk::USImageLoggingFilter::USImageLoggingFilter() : m_SystemTimeClock(RealTimeClock::New()),
-                                                     m_ImageExtension(".nrrd")
+                                                     m_ImageExtension(".nrrd"),
+                                                     m_IsStreaming(false),
+                                                     m_StopStreaming(false),
+                                                     m_MaximumQueueSize(32),
+                                                     m_DropImagesIfQueueIsFull(false),
+                                                     m_MultiThreader(itk::MultiThreader::New()),
+                                                     m_WriterThreadID(-1),
+                                                     m_QueueNotEmpty(itk::ConditionVariable::New()),
+                                                     m_QueueNotFull(itk::ConditionVariable::New()),
+                                                     m_StreamIntoContainer(false),
+                                                     m_CompressContainer(false),
+                                                     m_CompressedContainerFile(nullptr),
+                                                     m_NumberOfContainerImages(0)
 {
+  m_StreamingStatistics = StreamingStatistics();
 }
 
 mitk::USImageLoggingFilter::~USImageLoggingFilter()
 {
+  if (m_IsStreaming)
+  {
+    try
+    {
+      this->StopStreaming();
+    }
+    catch (const std::exception& e)
+    {
+      MITK_ERROR << "Error while stopping the image logging: " << e.what();
+    }
+  }
 }
 
 void mitk::USImageLoggingFilter::GenerateData()
@@ -45,6 +106,18 @@ void mitk::USImageLoggingFilter::GenerateData()
     return;
     }
 
+  //if the writer cannot keep up, images are dropped before they are copied
+  if (m_IsStreaming && m_DropImagesIfQueueIsFull)
+  {
+    m_QueueMutex.Lock();
+    bool queueIsFull = m_ImageQueue.size() >= m_MaximumQueueSize;
+    if (queueIsFull)
+      m_StreamingStatistics.DroppedImages++;
+    m_QueueMutex.Unlock();
+    if (queueIsFull)
+      return;
+  }
+
   //a clone is needed for a output and to store it.
   mitk::Image::Pointer inputClone = inputImage->Clone();
 
@@ -76,14 +149,51 @@ void mitk::USImageLoggingFilter::GenerateData()
   */
 
 
-  m_LoggedImages.push_back(inputClone);
-  m_LoggedMITKSystemTimes.push_back(m_SystemTimeClock->GetCurrentStamp());
+  if (!m_IsStreaming)
+  {
+    m_LoggedImages.push_back(inputClone);
+    m_LoggedMITKSystemTimes.push_back(m_SystemTimeClock->GetCurrentStamp());
+    return;
+  }
+
+  //streaming: hand the clone over to the writer thread
+  double timestamp = m_SystemTimeClock->GetCurrentStamp();
+
+  m_QueueMutex.Lock();
+  if (m_StreamIntoContainer && !this->FitsIntoContainer(inputClone))
+  {
+    m_StreamingStatistics.DroppedImages++;
+    m_QueueMutex.Unlock();
+    MITK_WARN << "Image does not match the size and pixel type of the logging container. Image is dropped!";
+    return;
+  }
+
+  //backpressure: wait until the writer has taken an image from the queue
+  if (m_ImageQueue.size() >= m_MaximumQueueSize)
+  {
+    m_StreamingStatistics.BlockedUpdates++;
+    while (m_ImageQueue.size() >= m_MaximumQueueSize)
+    {
+      m_QueueNotFull->Wait(&m_QueueMutex);
+    }
+    m_StreamingStatistics.BlockedTime += m_SystemTimeClock->GetCurrentStamp() - timestamp;
+  }
 
+  QueuedImage queuedImage;
+  queuedImage.image = inputClone;
+  queuedImage.index = static_cast<unsigned int>(m_LoggedMITKSystemTimes.size());
+  m_ImageQueue.push_back(queuedImage);
+  m_LoggedMITKSystemTimes.push_back(timestamp);
+  m_StreamedFilenames.push_back(""); //set by the writer thread
+  m_StreamingStatistics.MaximumQueueFill = std::max(m_StreamingStatistics.MaximumQueueFill, static_cast<unsigned int>(m_ImageQueue.size()));
+  m_QueueMutex.Unlock();
+
+  m_QueueNotEmpty->Signal();
 }
 
 void mitk::USImageLoggingFilter::AddMessageToCurrentImage(std::string message)
 {
-  m_LoggedMessages.insert(std::make_pair(static_cast<int>(m_LoggedImages.size()-1),message));
+  m_LoggedMessages.insert(std::make_pair(static_cast<int>(m_LoggedMITKSystemTimes.size()-1),message));
 }
 
 void mitk::USImageLoggingFilter::SaveImages(std::string path)
@@ -95,6 +205,11 @@ this->SaveImages(path,dummy1,dummy2);
 
 void mitk::USImageLoggingFilter::SaveImages(std::string path, std::vector<std::string>& filenames, std::string& csvFileName)
 {
+  if (m_IsStreaming)
+  {
+    mitkThrow() << "Images are streamed to " << m_StreamingPath << ", call StopStreaming() instead of SaveImages(...)!";
+  }
+
   filenames = std::vector<std::string>();
 
   //test if path is valid
@@ -118,7 +233,11 @@ void mitk::USImageLoggingFilter::SaveImages(std::string path, std::vector<std::s
     }
 
   //then: write a csv file which contains comments to all the images
+  this->WriteCsvFile(path, uniqueID, filenames, csvFileName);
+}
 
+void mitk::USImageLoggingFilter::WriteCsvFile(const std::string& path, const std::string& uniqueID, const std::vector<std::string>& filenames, std::string& csvFileName)
+{
   //open file
   std::stringstream csvFilenameStream;
   csvFilenameStream << path << uniqueID << "_ImageMessages.csv";
@@ -132,7 +251,7 @@ void mitk::USImageLoggingFilter::SaveImages(std::string path, std::vector<std::s
   os << "image filename; MITK system timestamp; message\n";
 
   //write data
-  for(size_t i=0; i<m_LoggedImages.size(); i++)
+  for(size_t i=0; i<filenames.size() && i<m_LoggedMITKSystemTimes.size(); i++)
     {
     std::map<int, std::string>::iterator it = m_LoggedMessages.find(i);
     if (m_LoggedMessages.empty() || (it == m_LoggedMessages.end())) os << filenames.at(i) << ";" << m_LoggedMITKSystemTimes.at(i) << ";" << "" << "\n";
@@ -143,6 +262,340 @@ void mitk::USImageLoggingFilter::SaveImages(std::string path, std::vector<std::s
   fb.close();
 }
 
+void mitk::USImageLoggingFilter::StartStreaming(std::string path)
+{
+  if (m_IsStreaming)
+  {
+    mitkThrow() << "Images are already streamed to " << m_StreamingPath << "!";
+  }
+  if (!m_LoggedImages.empty())
+  {
+    mitkThrow() << "There are logged images in memory, call SaveImages(...) before starting to stream!";
+  }
+
+  //test if path is valid
+  Poco::Path testPath(path);
+  if(!testPath.isDirectory())
+    {
+    mitkThrow() << "Attemting to write to directory " << path << " which is not valid! Aborting!";
+    }
+
+  //generate a unique ID which is used as part of the filenames, so we avoid to overwrite old files by mistake.
+  mitk::UIDGenerator myGen = mitk::UIDGenerator("",5);
+  m_StreamingUID = myGen.GetUID();
+  m_StreamingPath = path;
+
+  m_ImageQueue.clear();
+  m_StreamedFilenames.clear();
+  m_LoggedMITKSystemTimes.clear();
+  m_LoggedMessages.clear();
+  m_StreamingStatistics = StreamingStatistics();
+  m_ContainerReferenceImage = nullptr;
+  m_NumberOfContainerImages = 0;
+
+  if (m_StreamIntoContainer)
+  {
+    m_ContainerHeaderFileName = path + m_StreamingUID + "_Images.nhdr";
+    m_ContainerDataFileName = path + m_StreamingUID + (m_CompressContainer ? "_Images.raw.gz" : "_Images.raw");
+
+    if (m_CompressContainer)
+    {
+      m_CompressedContainerFile = gzopen(m_ContainerDataFileName.c_str(), "wb");
+      if (m_CompressedContainerFile == nullptr)
+      {
+        mitkThrow() << "Cannot open " << m_ContainerDataFileName << " for writing!";
+      }
+    }
+    else
+    {
+      m_ContainerFile.open(m_ContainerDataFileName.c_str(), std::ios::out | std::ios::binary);
+      if (!m_ContainerFile.is_open())
+      {
+        mitkThrow() << "Cannot open " << m_ContainerDataFileName << " for writing!";
+      }
+    }
+  }
+
+  m_StopStreaming = false;
+  m_IsStreaming = true;
+  m_WriterThreadID = m_MultiThreader->SpawnThread(WriterThread, this);
+}
+
+void mitk::USImageLoggingFilter::StopStreaming()
+{
+  std::vector<std::string> dummy1;
+  std::string dummy2;
+  this->StopStreaming(dummy1, dummy2);
+}
+
+void mitk::USImageLoggingFilter::StopStreaming(std::vector<std::string>& filenames, std::string& csvFileName)
+{
+  filenames = std::vector<std::string>();
+  if (!m_IsStreaming)
+  {
+    MITK_WARN << "Images are not streamed, nothing to stop.";
+    return;
+  }
+
+  //let the writer empty the queue and wait for it
+  m_QueueMutex.Lock();
+  m_StopStreaming = true;
+  m_QueueMutex.Unlock();
+  m_QueueNotEmpty->Broadcast();
+  m_MultiThreader->TerminateThread(m_WriterThreadID);
+  m_WriterThreadID = -1;
+  m_IsStreaming = false;
+
+  if (m_StreamIntoContainer)
+  {
+    if (m_CompressedContainerFile != nullptr)
+    {
+      gzclose(static_cast<gzFile>(m_CompressedContainerFile));
+      m_CompressedContainerFile = nullptr;
+    }
+    if (m_ContainerFile.is_open())
+    {
+      m_ContainerFile.close();
+    }
+
+    if (m_NumberOfContainerImages > 0)
+    {
+      this->WriteContainerHeader();
+      filenames.push_back(m_ContainerHeaderFileName);
+    }
+    else
+    {
+      std::remove(m_ContainerDataFileName.c_str());
+    }
+  }
+  else
+  {
+    for (size_t i = 0; i < m_StreamedFilenames.size(); i++)
+    {
+      if (!m_StreamedFilenames.at(i).empty())
+        filenames.push_back(m_StreamedFilenames.at(i));
+    }
+  }
+
+  this->WriteCsvFile(m_StreamingPath, m_StreamingUID, m_StreamedFilenames, csvFileName);
+
+  MITK_INFO << "Streamed " << m_StreamingStatistics.WrittenImages << " images ("
+            << m_StreamingStatistics.DroppedImages << " dropped, "
+            << m_StreamingStatistics.BlockedUpdates << " updates waited " << m_StreamingStatistics.BlockedTime << " ms for the writer).";
+
+  //the streamed data is not kept in memory
+  m_StreamedFilenames.clear();
+  m_LoggedMITKSystemTimes.clear();
+  m_LoggedMessages.clear();
+  m_ContainerReferenceImage = nullptr;
+}
+
+bool mitk::USImageLoggingFilter::IsStreaming() const
+{
+  return m_IsStreaming;
+}
+
+mitk::USImageLoggingFilter::StreamingStatistics mitk::USImageLoggingFilter::GetStreamingStatistics()
+{
+  m_QueueMutex.Lock();
+  StreamingStatistics statistics = m_StreamingStatistics;
+  m_QueueMutex.Unlock();
+  return statistics;
+}
+
+void mitk::USImageLoggingFilter::SetMaximumQueueSize(unsigned int size)
+{
+  if (m_IsStreaming)
+  {
+    MITK_WARN << "Cannot change the queue size while streaming.";
+    return;
+  }
+  m_MaximumQueueSize = std::max(size, 1u);
+}
+
+void mitk::USImageLoggingFilter::SetStreamIntoContainer(bool container)
+{
+  if (m_IsStreaming)
+  {
+    MITK_WARN << "Cannot change the streaming mode while streaming.";
+    return;
+  }
+  m_StreamIntoContainer = container;
+}
+
+void mitk::USImageLoggingFilter::SetCompressContainer(bool compress)
+{
+  if (m_IsStreaming)
+  {
+    MITK_WARN << "Cannot change the compression while streaming.";
+    return;
+  }
+  m_CompressContainer = compress;
+}
+
+ITK_THREAD_RETURN_TYPE mitk::USImageLoggingFilter::WriterThread(void* pInfoStruct)
+{
+  /* extract this pointer from Thread Info structure */
+  struct itk::MultiThreader::ThreadInfoStruct* pInfo =
+    (struct itk::MultiThreader::ThreadInfoStruct*)pInfoStruct;
+  mitk::USImageLoggingFilter* filter = (mitk::USImageLoggingFilter*)pInfo->UserData;
+
+  filter->m_QueueMutex.Lock();
+  while (true)
+  {
+    while (filter->m_ImageQueue.empty() && !filter->m_StopStreaming)
+    {
+      filter->m_QueueNotEmpty->Wait(&filter->m_QueueMutex);
+    }
+    if (filter->m_ImageQueue.empty())
+    {
+      break; //stopped and all images are written
+    }
+
+    QueuedImage queuedImage = filter->m_ImageQueue.front();
+    filter->m_ImageQueue.pop_front();
+    filter->m_QueueMutex.Unlock();
+    filter->m_QueueNotFull->Signal();
+
+    filter->WriteQueuedImage(queuedImage);
+
+    filter->m_QueueMutex.Lock();
+  }
+  filter->m_QueueMutex.Unlock();
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+void mitk::USImageLoggingFilter::WriteQueuedImage(const QueuedImage& queuedImage)
+{
+  std::stringstream name;
+  bool success = true;
+
+  if (m_StreamIntoContainer)
+  {
+    //the container is only accessed by this thread while streaming
+    try
+    {
+      mitk::ImageReadAccessor accessor(queuedImage.image);
+      const size_t size = GetImageSizeInBytes(queuedImage.image);
+      if (m_CompressedContainerFile != nullptr)
+      {
+        success = gzwrite(static_cast<gzFile>(m_CompressedContainerFile), accessor.GetData(), static_cast<unsigned int>(size)) == static_cast<int>(size);
+      }
+      else
+      {
+        m_ContainerFile.write(static_cast<const char*>(accessor.GetData()), size);
+        success = m_ContainerFile.good();
+      }
+    }
+    catch (const mitk::Exception& e)
+    {
+      MITK_ERROR << "Cannot access logged image: " << e.GetDescription();
+      success = false;
+    }
+    name << m_ContainerHeaderFileName << "[" << m_NumberOfContainerImages << "]";
+    if (success)
+    {
+      m_NumberOfContainerImages++;
+    }
+  }
+  else
+  {
+    name << m_StreamingPath << m_StreamingUID << "_Image_" << queuedImage.index << m_ImageExtension;
+    try
+    {
+      mitk::IOUtil::Save(queuedImage.image, name.str());
+    }
+    catch (const std::exception& e)
+    {
+      MITK_ERROR << "Cannot write logged image " << name.str() << ": " << e.what();
+      success = false;
+    }
+  }
+
+  m_QueueMutex.Lock();
+  if (success)
+  {
+    m_StreamedFilenames.at(queuedImage.index) = name.str();
+    m_StreamingStatistics.WrittenImages++;
+  }
+  else
+  {
+    m_StreamingStatistics.WriteErrors++;
+  }
+  m_QueueMutex.Unlock();
+}
+
+bool mitk::USImageLoggingFilter::FitsIntoContainer(const mitk::Image* image)
+{
+  if (image->GetDimension() > 3 || GetNrrdComponentType(image->GetPixelType()).empty())
+  {
+    return false;
+  }
+
+  if (m_ContainerReferenceImage.IsNull())
+  {
+    m_ContainerReferenceImage = const_cast<mitk::Image*>(image);
+    return true;
+  }
+
+  if (image->GetDimension() != m_ContainerReferenceImage->GetDimension() ||
+      !(image->GetPixelType() == m_ContainerReferenceImage->GetPixelType()))
+  {
+    return false;
+  }
+  for (unsigned int i = 0; i < image->GetDimension(); ++i)
+  {
+    if (image->GetDimension(i) != m_ContainerReferenceImage->GetDimension(i))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void mitk::USImageLoggingFilter::WriteContainerHeader()
+{
+  const mitk::PixelType pixelType = m_ContainerReferenceImage->GetPixelType();
+  const unsigned int imageDimension = m_ContainerReferenceImage->GetDimension();
+  const unsigned int numberOfComponents = pixelType.GetNumberOfComponents();
+  const mitk::Vector3D spacing = m_ContainerReferenceImage->GetGeometry()->GetSpacing();
+
+  const unsigned short one = 1;
+  const bool littleEndian = *reinterpret_cast<const unsigned char*>(&one) == 1;
+
+  std::ofstream header(m_ContainerHeaderFileName.c_str());
+  if (!header.is_open())
+  {
+    mitkThrow() << "Cannot write container header " << m_ContainerHeaderFileName << "!";
+  }
+
+  header.precision(15);
+  header << "NRRD0004\n";
+  header << "# " << m_NumberOfContainerImages << " logged ultrasound images, the last axis is the image number\n";
+  header << "type: " << GetNrrdComponentType(pixelType) << "\n";
+  header << "dimension: " << (numberOfComponents > 1 ? 1 : 0) + imageDimension + 1 << "\n";
+
+  header << "sizes:";
+  if (numberOfComponents > 1)
+    header << " " << numberOfComponents;
+  for (unsigned int i = 0; i < imageDimension; ++i)
+    header << " " << m_ContainerReferenceImage->GetDimension(i);
+  header << " " << m_NumberOfContainerImages << "\n";
+
+  header << "spacings:";
+  if (numberOfComponents > 1)
+    header << " nan";
+  for (unsigned int i = 0; i < imageDimension; ++i)
+    header << " " << spacing[i];
+  header << " nan\n";
+
+  header << "endian: " << (littleEndian ? "little" : "big") << "\n";
+  header << "encoding: " << (m_CompressContainer ? "gzip" : "raw") << "\n";
+  header << "data file: " << Poco::Path(m_ContainerDataFileName).getFileName() << "\n";
+  header.close();
+}
+
 bool mitk::USImageLoggingFilter::SetImageFilesExtension(std::string extension)
  {
   if(extension.compare(0,1,".") == 0)
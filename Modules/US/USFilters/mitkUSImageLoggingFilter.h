@@ -22,6 +22,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkImageToImageFilter.h>
 #include <mitkRealTimeClock.h>
 
+// ITK
+#include <itkConditionVariable.h>
+#include <itkMultiThreader.h>
+#include <itkMutexLock.h>
+
+#include <deque>
+#include <fstream>
+
 
 namespace mitk {
   /** An object of this class is a filter which saves/logs a clone of the current image whenever
@@ -31,6 +39,12 @@ namespace mitk {
    *
    *  Caution: only supports logging of one input at the moment, multiple inputs are ignored!
    *
+   *  For long sessions the images can be streamed to the harddisc instead (see StartStreaming(...)). In this mode
+   *  every logged image is handed over to a background thread which writes it while the acquisition continues.
+   *  Only a fixed number of images is kept in memory. If the writer cannot keep up, Update() either waits for a
+   *  free slot or drops the image, depending on SetDropImagesIfQueueIsFull(...). GetStreamingStatistics() reports
+   *  how often this happened.
+   *
    *  \ingroup US
    */
   class MITKUS_EXPORT USImageLoggingFilter : public mitk::ImageToImageFilter
@@ -76,6 +90,60 @@ namespace mitk {
      */
     bool SetImageFilesExtension(std::string extension);
 
+    /** Statistics of the current (or last) streaming session. */
+    struct StreamingStatistics
+    {
+      unsigned long WrittenImages;     ///< images written to the harddisc
+      unsigned long DroppedImages;     ///< images not logged because the queue was full or the image did not fit into the container
+      unsigned long BlockedUpdates;    ///< calls of Update() which had to wait for a free slot in the queue
+      double        BlockedTime;       ///< total time in ms Update() was waiting for a free slot
+      unsigned int  MaximumQueueFill;  ///< maximum number of images waiting in the queue
+      unsigned long WriteErrors;       ///< images which could not be written
+    };
+
+    /** Starts streaming of all subsequently logged images to the given path. A background thread writes the images
+     *  while they arrive, either as one file per image with the extension set by SetImageFilesExtension(...) or into
+     *  a single multi-frame container (see SetStreamIntoContainer(...)). All files start with a unique number.
+     *  @throw mitk::Exception Throws an exception if the path is not valid, the container cannot be opened or
+     *                         streaming is already running.
+     */
+    void StartStreaming(std::string path);
+
+    /** Writes the remaining queued images, stops the background thread and writes the csv file with the timestamps
+     *  and messages of the streamed images.
+     *  @param[out] imageFilenames  Returns a list of all written image files. In container mode this is the header
+     *                              file of the container.
+     *  @param[out] csvFileName     Returns the filename of the csv list with the timestamps and the messages.
+     */
+    void StopStreaming(std::vector<std::string>& imageFilenames, std::string& csvFileName);
+
+    /** Same as above, without returning the filenames. */
+    void StopStreaming();
+
+    /** @return Returns true if images are streamed to the harddisc. */
+    bool IsStreaming() const;
+
+    /** @return Returns a copy of the statistics of the current (or last) streaming session. */
+    StreamingStatistics GetStreamingStatistics();
+
+    /** Sets the maximum number of images waiting for the writer, default is 32. Only changeable if not streaming. */
+    void SetMaximumQueueSize(unsigned int size);
+    itkGetConstMacro(MaximumQueueSize, unsigned int);
+
+    /** If true, images are dropped if the queue is full. Otherwise (default) Update() waits for the writer. */
+    itkSetMacro(DropImagesIfQueueIsFull, bool);
+    itkGetConstMacro(DropImagesIfQueueIsFull, bool);
+
+    /** If true, all streamed images are appended to one raw data file described by a detached multi-frame
+     *  nrrd header (.nhdr) instead of writing one file per image. All images must then have the same size and
+     *  pixel type as the first one, others are dropped. Default is false. Only changeable if not streaming. */
+    void SetStreamIntoContainer(bool container);
+    itkGetConstMacro(StreamIntoContainer, bool);
+
+    /** If true, the data of the container is gzip compressed. Default is false. Only changeable if not streaming. */
+    void SetCompressContainer(bool compress);
+    itkGetConstMacro(CompressContainer, bool);
+
 
   protected:
     USImageLoggingFilter();
@@ -89,6 +157,52 @@ namespace mitk {
     std::vector<double> m_LoggedMITKSystemTimes; ///< Logged system times for every logged image
     std::string m_ImageExtension; ///< stores the image extension, default is ".nrrd"
 
+    //members for streaming
+    struct QueuedImage
+    {
+      mitk::Image::Pointer image;
+      unsigned int index;
+    };
+
+    static ITK_THREAD_RETURN_TYPE WriterThread(void* pInfoStruct);
+
+    /** Writes one image of the queue, called by the writer thread. */
+    void WriteQueuedImage(const QueuedImage& queuedImage);
+
+    /** Checks if the image can be appended to the container, i.e. if it has the same layout as the first image. */
+    bool FitsIntoContainer(const mitk::Image* image);
+
+    /** Writes the detached nrrd header which describes all images of the container. */
+    void WriteContainerHeader();
+
+    /** Writes the csv file with filenames, timestamps and messages of all logged images. */
+    void WriteCsvFile(const std::string& path, const std::string& uniqueID, const std::vector<std::string>& filenames, std::string& csvFileName);
+
+    bool m_IsStreaming;
+    bool m_StopStreaming;
+    std::string m_StreamingPath;
+    std::string m_StreamingUID;
+    std::vector<std::string> m_StreamedFilenames;
+    std::deque<QueuedImage> m_ImageQueue;
+    unsigned int m_MaximumQueueSize;
+    bool m_DropImagesIfQueueIsFull;
+    StreamingStatistics m_StreamingStatistics;
+
+    itk::MultiThreader::Pointer m_MultiThreader;
+    int m_WriterThreadID;
+    itk::SimpleMutexLock m_QueueMutex;
+    itk::ConditionVariable::Pointer m_QueueNotEmpty;
+    itk::ConditionVariable::Pointer m_QueueNotFull;
+
+    bool m_StreamIntoContainer;
+    bool m_CompressContainer;
+    std::string m_ContainerHeaderFileName;
+    std::string m_ContainerDataFileName;
+    std::ofstream m_ContainerFile;
+    void* m_CompressedContainerFile; ///< gzFile if the container is compressed
+    mitk::Image::Pointer m_ContainerReferenceImage;
+    unsigned int m_NumberOfContainerImages;
+
   };
 } // namespace mitk
 #endif /* MITKUSImageSource_H_HEADER_INCLUDED_ */
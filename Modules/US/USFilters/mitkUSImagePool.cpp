@@ -0,0 +1,134 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkUSImagePool.h"
+
+mitk::USImagePool::USImagePool()
+  : m_PoolSize(4),
+  m_NextIndex(0),
+  m_NumberOfAllocations(0),
+  m_NumberOfMisses(0),
+  m_Mutex(itk::FastMutexLock::New())
+{
+}
+
+mitk::USImagePool::~USImagePool()
+{
+}
+
+void mitk::USImagePool::SetPoolSize(unsigned int poolSize)
+{
+  m_Mutex->Lock();
+  m_PoolSize = poolSize;
+  if (m_Images.size() > m_PoolSize)
+  {
+    m_Images.resize(m_PoolSize);
+  }
+  m_NextIndex = 0;
+  m_Mutex->Unlock();
+}
+
+unsigned int mitk::USImagePool::GetPoolSize() const
+{
+  return m_PoolSize;
+}
+
+mitk::Image::Pointer mitk::USImagePool::AcquireImage(const mitk::PixelType& pixelType,
+  unsigned int dimension, const unsigned int* dimensions)
+{
+  m_Mutex->Lock();
+
+  if (m_Images.size() < m_PoolSize)
+  {
+    m_Images.resize(m_PoolSize);
+  }
+
+  mitk::Image::Pointer result;
+  for (unsigned int i = 0; i < m_Images.size() && result.IsNull(); ++i)
+  {
+    unsigned int index = (m_NextIndex + i) % m_Images.size();
+    mitk::Image::Pointer& image = m_Images[index];
+
+    // the pool itself holds exactly one reference to an unused image
+    if (image.IsNotNull() && image->GetReferenceCount() > 1)
+    {
+      continue;
+    }
+
+    if (image.IsNull() || !IsMatchingImage(image, pixelType, dimension, dimensions))
+    {
+      image = this->CreateImage(pixelType, dimension, dimensions);
+    }
+
+    result = image;
+    m_NextIndex = (index + 1) % m_Images.size();
+  }
+
+  if (result.IsNull())
+  {
+    ++m_NumberOfMisses;
+    result = this->CreateImage(pixelType, dimension, dimensions);
+  }
+
+  m_Mutex->Unlock();
+  return result;
+}
+
+void mitk::USImagePool::Clear()
+{
+  m_Mutex->Lock();
+  m_Images.clear();
+  m_NextIndex = 0;
+  m_Mutex->Unlock();
+}
+
+unsigned long mitk::USImagePool::GetNumberOfAllocations() const
+{
+  return m_NumberOfAllocations;
+}
+
+unsigned long mitk::USImagePool::GetNumberOfMisses() const
+{
+  return m_NumberOfMisses;
+}
+
+bool mitk::USImagePool::IsMatchingImage(const mitk::Image* image, const mitk::PixelType& pixelType,
+  unsigned int dimension, const unsigned int* dimensions)
+{
+  if (!image->IsInitialized() || image->GetDimension() != dimension || image->GetPixelType() != pixelType)
+  {
+    return false;
+  }
+
+  for (unsigned int i = 0; i < dimension; ++i)
+  {
+    if (image->GetDimension(i) != dimensions[i])
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+mitk::Image::Pointer mitk::USImagePool::CreateImage(const mitk::PixelType& pixelType,
+  unsigned int dimension, const unsigned int* dimensions)
+{
+  ++m_NumberOfAllocations;
+
+  mitk::Image::Pointer image = mitk::Image::New();
+  image->Initialize(pixelType, dimension, dimensions);
+  return image;
+}
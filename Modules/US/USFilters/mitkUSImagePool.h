@@ -0,0 +1,100 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKUSImagePool_H_HEADER_INCLUDED_
+#define MITKUSImagePool_H_HEADER_INCLUDED_
+
+// ITK
+#include <itkObject.h>
+#include <itkFastMutexLock.h>
+
+// MITK
+#include <MitkUSExports.h>
+#include <mitkCommon.h>
+#include <mitkImage.h>
+
+namespace mitk {
+  /**
+  * \brief Fixed-size pool of preallocated images for the ultrasound grab path.
+  *
+  * The pool holds up to GetPoolSize() images which are handed out round-robin
+  * by AcquireImage(). An image is only handed out again once nobody but the
+  * pool references it anymore, so consumers can keep a frame as long as they
+  * need it. As long as the probe geometry does not change and the consumers
+  * release their frames in time, no image memory is allocated in the steady
+  * state. If all images are still in use, a new image outside of the pool is
+  * created instead of blocking the caller; these misses are counted.
+  *
+  * \ingroup US
+  */
+  class MITKUS_EXPORT USImagePool : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(USImagePool, itk::Object);
+    itkFactorylessNewMacro(Self);
+
+    /**
+    * \brief Sets the maximum number of images kept in the pool. Images that are
+    * currently in use stay valid, even if they are removed from the pool.
+    */
+    void SetPoolSize(unsigned int poolSize);
+    unsigned int GetPoolSize() const;
+
+    /**
+    * \brief Returns an image with the given pixel type and dimensions that is
+    * not referenced by anyone else. Its content is undefined.
+    */
+    mitk::Image::Pointer AcquireImage(const mitk::PixelType& pixelType, unsigned int dimension,
+      const unsigned int* dimensions);
+
+    /**
+    * \brief Removes all images from the pool.
+    */
+    void Clear();
+
+    /**
+    * \brief Number of images that had to be (re)allocated since the pool was created.
+    */
+    unsigned long GetNumberOfAllocations() const;
+
+    /**
+    * \brief Number of requests that could not be served by the pool because
+    * all of its images were in use.
+    */
+    unsigned long GetNumberOfMisses() const;
+
+  protected:
+    USImagePool();
+    ~USImagePool() override;
+
+    static bool IsMatchingImage(const mitk::Image* image, const mitk::PixelType& pixelType,
+      unsigned int dimension, const unsigned int* dimensions);
+
+    mitk::Image::Pointer CreateImage(const mitk::PixelType& pixelType, unsigned int dimension,
+      const unsigned int* dimensions);
+
+    std::vector<mitk::Image::Pointer> m_Images;
+    unsigned int m_PoolSize;
+    unsigned int m_NextIndex;
+
+    unsigned long m_NumberOfAllocations;
+    unsigned long m_NumberOfMisses;
+
+    itk::FastMutexLock::Pointer m_Mutex;
+  };
+} // namespace mitk
+
+#endif /* MITKUSImagePool_H_HEADER_INCLUDED_ */
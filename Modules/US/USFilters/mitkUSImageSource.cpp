@@ -16,12 +16,16 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkUSImageSource.h"
 #include "mitkProperties.h"
+#include "mitkImageWriteAccessor.h"
+
+#include <opencv2/imgproc.hpp>
 
 const char* mitk::USImageSource::IMAGE_PROPERTY_IDENTIFIER = "id_nummer";
 
 mitk::USImageSource::USImageSource()
   : m_OpenCVToMitkFilter(mitk::OpenCVToMitkImageFilter::New()),
   m_MitkToOpenCVFilter(nullptr),
+  m_ImagePool(mitk::USImagePool::New()),
   m_ImageFilter(mitk::BasicCombinationOpenCVImageFilter::New()),
   m_CurrentImageId(0),
   m_ImageFilterMutex(itk::FastMutexLock::New())
@@ -67,12 +71,16 @@ std::vector<mitk::Image::Pointer> mitk::USImageSource::GetNextImage()
         m_ImageFilter->FilterImage(imageVector[i], m_CurrentImageId);
         m_ImageFilterMutex->Unlock();
 
-        // convert to MITK image
-        this->m_OpenCVToMitkFilter->SetOpenCVMat(imageVector[i]);
-        this->m_OpenCVToMitkFilter->Update();
+        // convert to MITK image, the filter is only needed for unusual pixel types
+        result[i] = this->ConvertToPooledImage(imageVector[i]);
+        if (result[i].IsNull())
+        {
+          this->m_OpenCVToMitkFilter->SetOpenCVMat(imageVector[i]);
+          this->m_OpenCVToMitkFilter->Update();
 
-        // OpenCVToMitkImageFilter returns a standard mitk::image.
-        result[i] = this->m_OpenCVToMitkFilter->GetOutput();
+          // OpenCVToMitkImageFilter returns a standard mitk::image.
+          result[i] = this->m_OpenCVToMitkFilter->GetOutput();
+        }
       }
     }
   }
@@ -85,7 +93,12 @@ std::vector<mitk::Image::Pointer> mitk::USImageSource::GetNextImage()
   {
     if (result[i].IsNotNull())
     {
-      result[i]->SetProperty(IMAGE_PROPERTY_IDENTIFIER, mitk::IntProperty::New(m_CurrentImageId));
+      // pooled images already carry the property, so just update its value
+      auto idProperty = dynamic_cast<mitk::IntProperty*>(result[i]->GetProperty(IMAGE_PROPERTY_IDENTIFIER).GetPointer());
+      if (idProperty != nullptr)
+        idProperty->SetValue(m_CurrentImageId);
+      else
+        result[i]->SetProperty(IMAGE_PROPERTY_IDENTIFIER, mitk::IntProperty::New(m_CurrentImageId));
     }
     else
     {
@@ -124,3 +137,36 @@ void mitk::USImageSource::GetNextRawImage(std::vector<cv::Mat>& imageVector)
     }
   }
 }
+
+mitk::Image::Pointer mitk::USImageSource::ConvertToPooledImage(const cv::Mat& image)
+{
+  if (image.empty() || image.depth() != CV_8U || (image.channels() != 1 && image.channels() != 3))
+  {
+    return nullptr;
+  }
+
+  const unsigned int dimensions[2] = { static_cast<unsigned int>(image.cols), static_cast<unsigned int>(image.rows) };
+  const mitk::PixelType pixelType = image.channels() == 1
+    ? mitk::MakeScalarPixelType<unsigned char>()
+    : mitk::MakePixelType<unsigned char, itk::RGBPixel<unsigned char>, 3>();
+
+  mitk::Image::Pointer result = m_ImagePool->AcquireImage(pixelType, 2, dimensions);
+
+  {
+    mitk::ImageWriteAccessor accessor(result);
+
+    // wrap the image buffer, so that OpenCV writes directly into it
+    cv::Mat target(image.rows, image.cols, image.type(), accessor.GetData());
+    if (image.channels() == 3)
+    {
+      cv::cvtColor(image, target, cv::COLOR_BGR2RGB);
+    }
+    else
+    {
+      image.copyTo(target);
+    }
+  }
+
+  result->Modified();
+  return result;
+}
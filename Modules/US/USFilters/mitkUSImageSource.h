@@ -27,6 +27,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkBasicCombinationOpenCVImageFilter.h"
 #include "mitkOpenCVToMitkImageFilter.h"
 #include "mitkImageToOpenCVImageFilter.h"
+#include "mitkUSImagePool.h"
 
 namespace mitk {
   /**
@@ -60,6 +61,13 @@ namespace mitk {
     */
     std::vector<mitk::Image::Pointer> GetNextImage();
 
+    /**
+    * \brief Pool the images delivered by this source are taken from. It can be
+    * shared with other sources or filters of the same grab path.
+    */
+    itkGetMacro(ImagePool, mitk::USImagePool::Pointer);
+    itkSetObjectMacro(ImagePool, mitk::USImagePool);
+
   protected:
     USImageSource();
     ~USImageSource() override;
@@ -88,6 +96,20 @@ namespace mitk {
     */
     mitk::ImageToOpenCVImageFilter::Pointer m_MitkToOpenCVFilter;
 
+    /**
+    * \brief Converts the given OpenCV image into an image of the pool without
+    * allocating memory in the steady state. 8 bit grey value and BGR images
+    * are supported.
+    *
+    * \return the converted image or nullptr if the OpenCV image type is not supported
+    */
+    mitk::Image::Pointer ConvertToPooledImage(const cv::Mat& image);
+
+    /**
+    * \brief Pool the images delivered by GetNextImage() are taken from.
+    */
+    mitk::USImagePool::Pointer m_ImagePool;
+
   private:
     /**
 * \brief Filter is executed during mitk::USImageVideoSource::GetNextImage().
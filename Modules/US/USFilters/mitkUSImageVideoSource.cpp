@@ -204,14 +204,19 @@ void mitk::USImageVideoSource::GetNextRawImage(std::vector<mitk::Image::Pointer>
 
   this->GetNextRawImage(cv_img);
 
-  // convert to MITK-Image
-  IplImage ipl_img = cv_img[0];
+  // convert to MITK-Image, reusing the images of the pool where possible
+  image[0] = this->ConvertToPooledImage(cv_img[0]);
 
-  this->m_OpenCVToMitkFilter->SetOpenCVImage(&ipl_img);
-  this->m_OpenCVToMitkFilter->Update();
+  if (image[0].IsNull())
+  {
+    IplImage ipl_img = cv_img[0];
+
+    this->m_OpenCVToMitkFilter->SetOpenCVImage(&ipl_img);
+    this->m_OpenCVToMitkFilter->Update();
 
-  // OpenCVToMitkImageFilter returns a standard mitk::image. We then transform it into an USImage
-  image[0] = this->m_OpenCVToMitkFilter->GetOutput();
+    // OpenCVToMitkImageFilter returns a standard mitk::image. We then transform it into an USImage
+    image[0] = this->m_OpenCVToMitkFilter->GetOutput();
+  }
 
   // clean up
   cv_img[0].release();
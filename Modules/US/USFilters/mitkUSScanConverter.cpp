@@ -0,0 +1,463 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkUSScanConverter.h"
+
+#include <mitkException.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <type_traits>
+
+namespace
+{
+  // below this number of output pixels per thread, starting the threads costs more than it saves
+  const std::size_t MinimumPixelsPerThread = 16384;
+
+  template <typename TPixel>
+  TPixel ToPixel(float value)
+  {
+    if (std::is_integral<TPixel>::value)
+    {
+      value = std::floor(value + 0.5f);
+      value = std::max(value, static_cast<float>(std::numeric_limits<TPixel>::lowest()));
+      value = std::min(value, static_cast<float>(std::numeric_limits<TPixel>::max()));
+    }
+    return static_cast<TPixel>(value);
+  }
+
+  void AddToBounds(double x, double y, double bounds[4])
+  {
+    bounds[0] = std::min(bounds[0], x);
+    bounds[1] = std::max(bounds[1], x);
+    bounds[2] = std::min(bounds[2], y);
+    bounds[3] = std::max(bounds[3], y);
+  }
+
+  // continuous position of value in the range [0, count - 1], split into cell and weight
+  bool ToCell(double value, unsigned int count, int& cell, float& weight)
+  {
+    const double epsilon = 1e-6;
+    if (value < -epsilon || value > count - 1 + epsilon)
+    {
+      return false;
+    }
+
+    cell = std::min(std::max(static_cast<int>(std::floor(value)), 0), static_cast<int>(count) - 2);
+    weight = static_cast<float>(std::min(std::max(value - cell, 0.0), 1.0));
+    return true;
+  }
+}
+
+mitk::USScanConverter::ScanGeometry::ScanGeometry()
+  : NumberOfLines(0),
+  SamplesPerLine(0),
+  Layout(SamplesAlongLines),
+  FirstLineAngle(0),
+  LineAngleStep(0),
+  FirstLinePosition(0),
+  LinePositionStep(0),
+  ProbeRadius(0),
+  FirstSampleDepth(0),
+  SampleDepthStep(0)
+{
+}
+
+bool mitk::USScanConverter::ScanGeometry::operator==(const ScanGeometry& other) const
+{
+  return NumberOfLines == other.NumberOfLines && SamplesPerLine == other.SamplesPerLine &&
+    Layout == other.Layout && FirstLineAngle == other.FirstLineAngle && LineAngleStep == other.LineAngleStep &&
+    FirstLinePosition == other.FirstLinePosition && LinePositionStep == other.LinePositionStep &&
+    ProbeRadius == other.ProbeRadius && FirstSampleDepth == other.FirstSampleDepth &&
+    SampleDepthStep == other.SampleDepthStep;
+}
+
+bool mitk::USScanConverter::ScanGeometry::operator!=(const ScanGeometry& other) const
+{
+  return !(*this == other);
+}
+
+mitk::USScanConverter::USScanConverter()
+  : m_NumberOfThreads(0),
+  m_BackgroundValue(0),
+  m_ImagePool(mitk::USImagePool::New()),
+  m_TableModified(true),
+  m_LineOffset(0),
+  m_SampleOffset(0),
+  m_NumberOfTableUpdates(0),
+  m_Mutex(itk::FastMutexLock::New())
+{
+  m_OutputSpacing.Fill(1);
+  m_OutputOrigin.Fill(0);
+  m_OutputDimensions[0] = 0;
+  m_OutputDimensions[1] = 0;
+}
+
+mitk::USScanConverter::~USScanConverter()
+{
+}
+
+void mitk::USScanConverter::SetScanGeometry(const ScanGeometry& scanGeometry)
+{
+  if (scanGeometry.NumberOfLines < 2 || scanGeometry.SamplesPerLine < 2)
+  {
+    mitkThrow() << "Scan conversion needs at least two lines with two samples each.";
+  }
+  if (scanGeometry.SampleDepthStep == 0 || (scanGeometry.LineAngleStep == 0 && scanGeometry.LinePositionStep == 0))
+  {
+    mitkThrow() << "The sample depth step and either the line angle or the line position step must not be 0.";
+  }
+
+  m_Mutex->Lock();
+  if (scanGeometry != m_ScanGeometry)
+  {
+    m_ScanGeometry = scanGeometry;
+    m_TableModified = true;
+  }
+  m_Mutex->Unlock();
+}
+
+const mitk::USScanConverter::ScanGeometry& mitk::USScanConverter::GetScanGeometry() const
+{
+  return m_ScanGeometry;
+}
+
+void mitk::USScanConverter::SetOutputSpacing(double spacingX, double spacingY)
+{
+  if (spacingX <= 0 || spacingY <= 0)
+  {
+    mitkThrow() << "The output spacing must be positive.";
+  }
+
+  m_Mutex->Lock();
+  if (spacingX != m_OutputSpacing[0] || spacingY != m_OutputSpacing[1])
+  {
+    m_OutputSpacing[0] = spacingX;
+    m_OutputSpacing[1] = spacingY;
+    m_TableModified = true;
+  }
+  m_Mutex->Unlock();
+}
+
+mitk::Vector2D mitk::USScanConverter::GetOutputSpacing() const
+{
+  return m_OutputSpacing;
+}
+
+void mitk::USScanConverter::GetOutputDimensions(unsigned int dimensions[2])
+{
+  m_Mutex->Lock();
+  this->UpdateTable();
+  dimensions[0] = m_OutputDimensions[0];
+  dimensions[1] = m_OutputDimensions[1];
+  m_Mutex->Unlock();
+}
+
+mitk::Point2D mitk::USScanConverter::GetOutputOrigin()
+{
+  m_Mutex->Lock();
+  this->UpdateTable();
+  mitk::Point2D origin = m_OutputOrigin;
+  m_Mutex->Unlock();
+  return origin;
+}
+
+unsigned long mitk::USScanConverter::GetNumberOfTableUpdates() const
+{
+  return m_NumberOfTableUpdates;
+}
+
+void mitk::USScanConverter::UpdateTable()
+{
+  if (!m_TableModified)
+  {
+    return;
+  }
+
+  const ScanGeometry& scan = m_ScanGeometry;
+  if (scan.NumberOfLines < 2 || scan.SamplesPerLine < 2)
+  {
+    mitkThrow() << "No scan geometry was set for the scan conversion.";
+  }
+
+  const bool isLinear = scan.LineAngleStep == 0;
+  const double lastLine = scan.NumberOfLines - 1;
+  const double lastSample = scan.SamplesPerLine - 1;
+
+  // bounding box of the scan, xmin, xmax, ymin, ymax
+  double bounds[4] = { std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest(),
+    std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest() };
+
+  if (isLinear)
+  {
+    AddToBounds(scan.FirstLinePosition, scan.FirstSampleDepth, bounds);
+    AddToBounds(scan.FirstLinePosition + lastLine * scan.LinePositionStep,
+      scan.FirstSampleDepth + lastSample * scan.SampleDepthStep, bounds);
+  }
+  else
+  {
+    const double radii[2] = { scan.ProbeRadius + scan.FirstSampleDepth,
+      scan.ProbeRadius + scan.FirstSampleDepth + lastSample * scan.SampleDepthStep };
+    const double angles[2] = { scan.FirstLineAngle, scan.FirstLineAngle + lastLine * scan.LineAngleStep };
+
+    for (double radius : radii)
+    {
+      for (double angle : angles)
+      {
+        AddToBounds(radius * std::sin(angle), radius * std::cos(angle), bounds);
+      }
+
+      // the arcs reach their extremes in between the outer lines if the fan covers these directions
+      const double minAngle = std::min(angles[0], angles[1]);
+      const double maxAngle = std::max(angles[0], angles[1]);
+      const double halfPi = std::acos(0.0);
+      for (double angle : { -halfPi, 0.0, halfPi })
+      {
+        if (angle > minAngle && angle < maxAngle)
+        {
+          AddToBounds(radius * std::sin(angle), radius * std::cos(angle), bounds);
+        }
+      }
+    }
+  }
+
+  m_OutputOrigin[0] = bounds[0];
+  m_OutputOrigin[1] = bounds[2];
+  for (unsigned int i = 0; i < 2; ++i)
+  {
+    const double extent = bounds[2 * i + 1] - bounds[2 * i];
+    m_OutputDimensions[i] = static_cast<unsigned int>(std::floor(extent / m_OutputSpacing[i] + 1e-6)) + 1;
+  }
+
+  if (scan.Layout == SamplesAlongLines)
+  {
+    m_LineOffset = static_cast<int>(scan.SamplesPerLine);
+    m_SampleOffset = 1;
+  }
+  else
+  {
+    m_LineOffset = 1;
+    m_SampleOffset = static_cast<int>(scan.NumberOfLines);
+  }
+
+  const std::size_t numberOfPixels = static_cast<std::size_t>(m_OutputDimensions[0]) * m_OutputDimensions[1];
+  m_Indices.assign(numberOfPixels, -1);
+  m_LineWeights.assign(numberOfPixels, 0);
+  m_SampleWeights.assign(numberOfPixels, 0);
+
+  std::size_t pixel = 0;
+  for (unsigned int row = 0; row < m_OutputDimensions[1]; ++row)
+  {
+    const double y = m_OutputOrigin[1] + row * m_OutputSpacing[1];
+    for (unsigned int column = 0; column < m_OutputDimensions[0]; ++column, ++pixel)
+    {
+      const double x = m_OutputOrigin[0] + column * m_OutputSpacing[0];
+
+      double line;
+      double sample;
+      if (isLinear)
+      {
+        line = (x - scan.FirstLinePosition) / scan.LinePositionStep;
+        sample = (y - scan.FirstSampleDepth) / scan.SampleDepthStep;
+      }
+      else
+      {
+        line = (std::atan2(x, y) - scan.FirstLineAngle) / scan.LineAngleStep;
+        sample = (std::sqrt(x * x + y * y) - scan.ProbeRadius - scan.FirstSampleDepth) / scan.SampleDepthStep;
+      }
+
+      int lineCell;
+      int sampleCell;
+      if (ToCell(line, scan.NumberOfLines, lineCell, m_LineWeights[pixel]) &&
+        ToCell(sample, scan.SamplesPerLine, sampleCell, m_SampleWeights[pixel]))
+      {
+        m_Indices[pixel] = lineCell * m_LineOffset + sampleCell * m_SampleOffset;
+      }
+    }
+  }
+
+  m_TableModified = false;
+  ++m_NumberOfTableUpdates;
+}
+
+template <typename TPixel>
+void mitk::USScanConverter::ConvertFrame(const TPixel* input, TPixel* output)
+{
+  this->UpdateTable();
+
+  const std::size_t numberOfPixels = m_Indices.size();
+  const TPixel background = ToPixel<TPixel>(static_cast<float>(m_BackgroundValue));
+  const int lineOffset = m_LineOffset;
+  const int sampleOffset = m_SampleOffset;
+  const int* indices = m_Indices.data();
+  const float* lineWeights = m_LineWeights.data();
+  const float* sampleWeights = m_SampleWeights.data();
+
+  // the table is laid out as separate arrays, so this loop is a plain gather the compiler can vectorize
+  auto convert = [=](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      const int index = indices[i];
+      if (index < 0)
+      {
+        output[i] = background;
+        continue;
+      }
+
+      const float lineWeight = lineWeights[i];
+      const float sampleWeight = sampleWeights[i];
+      const float upper = input[index] + lineWeight * (input[index + lineOffset] - static_cast<float>(input[index]));
+      const float lower = input[index + sampleOffset] +
+        lineWeight * (input[index + sampleOffset + lineOffset] - static_cast<float>(input[index + sampleOffset]));
+      output[i] = ToPixel<TPixel>(upper + sampleWeight * (lower - upper));
+    }
+  };
+
+  unsigned int numberOfThreads = m_NumberOfThreads;
+  if (numberOfThreads == 0)
+  {
+    numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  numberOfThreads = static_cast<unsigned int>(
+    std::max<std::size_t>(1, std::min<std::size_t>(numberOfThreads, numberOfPixels / MinimumPixelsPerThread)));
+
+  if (numberOfThreads == 1)
+  {
+    convert(0, numberOfPixels);
+    return;
+  }
+
+  std::vector<std::thread> threads;
+  const std::size_t pixelsPerThread = (numberOfPixels + numberOfThreads - 1) / numberOfThreads;
+  for (unsigned int t = 0; t < numberOfThreads; ++t)
+  {
+    const std::size_t begin = std::min(numberOfPixels, t * pixelsPerThread);
+    const std::size_t end = std::min(numberOfPixels, begin + pixelsPerThread);
+    threads.emplace_back(convert, begin, end);
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+}
+
+void mitk::USScanConverter::Convert(const unsigned char* input, unsigned char* output)
+{
+  m_Mutex->Lock();
+  try
+  {
+    this->ConvertFrame(input, output);
+  }
+  catch (...)
+  {
+    m_Mutex->Unlock();
+    throw;
+  }
+  m_Mutex->Unlock();
+}
+
+void mitk::USScanConverter::Convert(const short* input, short* output)
+{
+  m_Mutex->Lock();
+  try
+  {
+    this->ConvertFrame(input, output);
+  }
+  catch (...)
+  {
+    m_Mutex->Unlock();
+    throw;
+  }
+  m_Mutex->Unlock();
+}
+
+void mitk::USScanConverter::Convert(const float* input, float* output)
+{
+  m_Mutex->Lock();
+  try
+  {
+    this->ConvertFrame(input, output);
+  }
+  catch (...)
+  {
+    m_Mutex->Unlock();
+    throw;
+  }
+  m_Mutex->Unlock();
+}
+
+mitk::Image::Pointer mitk::USScanConverter::Convert(const mitk::Image* input)
+{
+  if (input == nullptr || !input->IsInitialized() || input->GetDimension() < 2 || input->GetDimension() > 3)
+  {
+    mitkThrow() << "Scan conversion needs an initialized 2D or 3D image.";
+  }
+
+  const mitk::PixelType pixelType = input->GetPixelType();
+  const int componentType = pixelType.GetComponentType();
+  if (pixelType.GetNumberOfComponents() != 1 || (componentType != itk::ImageIOBase::UCHAR &&
+    componentType != itk::ImageIOBase::SHORT && componentType != itk::ImageIOBase::FLOAT))
+  {
+    mitkThrow() << "Scan conversion supports unsigned char, short and float images only.";
+  }
+
+  const std::size_t inputFrameSize = static_cast<std::size_t>(input->GetDimension(0)) * input->GetDimension(1);
+  if (inputFrameSize != static_cast<std::size_t>(m_ScanGeometry.NumberOfLines) * m_ScanGeometry.SamplesPerLine)
+  {
+    mitkThrow() << "The image slices do not hold one frame of the scan geometry.";
+  }
+
+  const unsigned int dimension = input->GetDimension();
+  unsigned int dimensions[3] = { 0, 0, dimension == 3 ? input->GetDimension(2) : 1 };
+  this->GetOutputDimensions(dimensions);
+
+  mitk::Image::Pointer output = m_ImagePool->AcquireImage(pixelType, dimension, dimensions);
+
+  mitk::Vector3D spacing = input->GetGeometry()->GetSpacing();
+  spacing[0] = m_OutputSpacing[0];
+  spacing[1] = m_OutputSpacing[1];
+  output->GetGeometry()->SetSpacing(spacing);
+  output->GetGeometry()->SetOrigin(input->GetGeometry()->GetOrigin());
+
+  mitk::ImageReadAccessor inputAccessor(input);
+  mitk::ImageWriteAccessor outputAccessor(output);
+
+  const std::size_t outputFrameSize = static_cast<std::size_t>(dimensions[0]) * dimensions[1];
+  for (unsigned int slice = 0; slice < dimensions[2]; ++slice)
+  {
+    switch (componentType)
+    {
+    case itk::ImageIOBase::UCHAR:
+      this->Convert(static_cast<const unsigned char*>(inputAccessor.GetData()) + slice * inputFrameSize,
+        static_cast<unsigned char*>(outputAccessor.GetData()) + slice * outputFrameSize);
+      break;
+    case itk::ImageIOBase::SHORT:
+      this->Convert(static_cast<const short*>(inputAccessor.GetData()) + slice * inputFrameSize,
+        static_cast<short*>(outputAccessor.GetData()) + slice * outputFrameSize);
+      break;
+    default:
+      this->Convert(static_cast<const float*>(inputAccessor.GetData()) + slice * inputFrameSize,
+        static_cast<float*>(outputAccessor.GetData()) + slice * outputFrameSize);
+      break;
+    }
+  }
+
+  return output;
+}
@@ -0,0 +1,186 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKUSScanConverter_H_HEADER_INCLUDED_
+#define MITKUSScanConverter_H_HEADER_INCLUDED_
+
+// ITK
+#include <itkObject.h>
+#include <itkFastMutexLock.h>
+
+// MITK
+#include <MitkUSExports.h>
+#include <mitkCommon.h>
+#include <mitkImage.h>
+#include "mitkUSImagePool.h"
+
+#include <vector>
+
+namespace mitk {
+  /**
+  * \brief Converts ultrasound data given per scan line (beam space) into a
+  * cartesian image by means of precomputed lookup tables.
+  *
+  * The geometry of the scan is described by a ScanGeometry. Its lines are
+  * either parallel (linear probes, LineAngleStep 0) or fan out from a common
+  * apex (curved and phased array probes, LineAngleStep != 0). For the latter
+  * the first sample of each line lies at ProbeRadius + FirstSampleDepth from
+  * the apex, LinePosition values are ignored then.
+  *
+  * For every output pixel the table holds the index of the upper left of the
+  * four surrounding input samples and the two bilinear weights. Output pixels
+  * outside of the scan get the background value. The table is only rebuilt if
+  * the scan geometry or the output spacing changed, so the per frame work is a
+  * plain gather that is split between NumberOfThreads threads (0, the default,
+  * uses one thread per hardware core).
+  *
+  * The output covers the bounding box of the scan, with x along the probe
+  * surface and y in depth. GetOutputOrigin() tells its upper left corner in mm,
+  * relative to the origin of the line positions on the probe surface for linear
+  * probes and relative
+  * to the apex otherwise.
+  *
+  * \ingroup US
+  */
+  class MITKUS_EXPORT USScanConverter : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(USScanConverter, itk::Object);
+    itkFactorylessNewMacro(Self);
+
+    enum DataLayout
+    {
+      /** samples of one line are contiguous, data[line * SamplesPerLine + sample] */
+      SamplesAlongLines,
+      /** one image row per sample depth, data[sample * NumberOfLines + line] */
+      LinesAlongSamples
+    };
+
+    struct MITKUS_EXPORT ScanGeometry
+    {
+      ScanGeometry();
+
+      bool operator==(const ScanGeometry& other) const;
+      bool operator!=(const ScanGeometry& other) const;
+
+      unsigned int NumberOfLines;
+      unsigned int SamplesPerLine;
+      DataLayout Layout;
+
+      /** angle of the first line and between two lines in radians, 0 is straight down */
+      double FirstLineAngle;
+      double LineAngleStep;
+
+      /** lateral position of the first line and between two lines in mm, linear probes only */
+      double FirstLinePosition;
+      double LinePositionStep;
+
+      /** distance of the probe surface from the apex in mm, curved and phased array probes only */
+      double ProbeRadius;
+
+      /** depth of the first sample and between two samples in mm, measured from the probe surface */
+      double FirstSampleDepth;
+      double SampleDepthStep;
+    };
+
+    /**
+    * \brief Sets the geometry of the input data. Throws an mitk::Exception if
+    * there are less than two lines or samples per line or a step is 0.
+    */
+    void SetScanGeometry(const ScanGeometry& scanGeometry);
+    const ScanGeometry& GetScanGeometry() const;
+
+    /**
+    * \brief Sets the pixel spacing of the output image in mm.
+    */
+    void SetOutputSpacing(double spacingX, double spacingY);
+    mitk::Vector2D GetOutputSpacing() const;
+
+    itkSetMacro(NumberOfThreads, unsigned int);
+    itkGetConstMacro(NumberOfThreads, unsigned int);
+
+    /**
+    * \brief Value of the output pixels outside of the scan, 0 by default.
+    */
+    itkSetMacro(BackgroundValue, double);
+    itkGetConstMacro(BackgroundValue, double);
+
+    /**
+    * \brief Pool the images returned by Convert(const mitk::Image*) are taken from.
+    */
+    itkGetMacro(ImagePool, mitk::USImagePool::Pointer);
+    itkSetObjectMacro(ImagePool, mitk::USImagePool);
+
+    /**
+    * \brief Output dimensions for the current scan geometry and spacing,
+    * rebuilds the lookup table if necessary.
+    */
+    void GetOutputDimensions(unsigned int dimensions[2]);
+    mitk::Point2D GetOutputOrigin();
+
+    /**
+    * \brief Number of times the lookup table was built, for diagnostic purposes.
+    */
+    unsigned long GetNumberOfTableUpdates() const;
+
+    /**
+    * \brief Converts one frame of NumberOfLines * SamplesPerLine input values
+    * into the output buffer of GetOutputDimensions() pixels.
+    */
+    void Convert(const unsigned char* input, unsigned char* output);
+    void Convert(const short* input, short* output);
+    void Convert(const float* input, float* output);
+
+    /**
+    * \brief Converts every slice of a 2D or 3D image of unsigned char, short
+    * or float pixels whose slices hold one frame each. The result is taken from
+    * the image pool, its spacing is the output spacing and its origin is the
+    * origin of the input. Throws an mitk::Exception on unsupported images.
+    */
+    mitk::Image::Pointer Convert(const mitk::Image* input);
+
+  protected:
+    USScanConverter();
+    ~USScanConverter() override;
+
+    void UpdateTable();
+
+    template <typename TPixel>
+    void ConvertFrame(const TPixel* input, TPixel* output);
+
+    ScanGeometry m_ScanGeometry;
+    mitk::Vector2D m_OutputSpacing;
+    unsigned int m_NumberOfThreads;
+    double m_BackgroundValue;
+
+    mitk::USImagePool::Pointer m_ImagePool;
+
+    // lookup table, one entry per output pixel; m_Indices holds -1 outside of the scan
+    bool m_TableModified;
+    unsigned int m_OutputDimensions[2];
+    mitk::Point2D m_OutputOrigin;
+    std::vector<int> m_Indices;
+    std::vector<float> m_LineWeights;
+    std::vector<float> m_SampleWeights;
+    int m_LineOffset;
+    int m_SampleOffset;
+    unsigned long m_NumberOfTableUpdates;
+
+    itk::FastMutexLock::Pointer m_Mutex;
+  };
+} // namespace mitk
+
+#endif /* MITKUSScanConverter_H_HEADER_INCLUDED_ */
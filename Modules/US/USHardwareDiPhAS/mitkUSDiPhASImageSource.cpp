@@ -61,7 +61,8 @@ mitk::USDiPhASImageSource::USDiPhASImageSource(mitk::USDiPhASDevice* device)
   m_CompensateForScattering(false),
   m_CompensateEnergy(false),
   m_CompensateEnergyNext(false),
-  m_CompensateEnergyModified(false)
+  m_CompensateEnergyModified(false),
+  m_VerticalResampler(mitk::USScanConverter::New())
 {
   m_BufferSize = 100;
   m_ImageTimestampBuffer.insert(m_ImageTimestampBuffer.begin(), m_BufferSize, 0);
@@ -341,30 +342,19 @@ mitk::Image::Pointer mitk::USDiPhASImageSource::CutOffTop(mitk::Image::Pointer i
 
 mitk::Image::Pointer mitk::USDiPhASImageSource::ResampleOutputVertical(mitk::Image::Pointer image, float verticalSpacing)
 {
-  typedef itk::ResampleImageFilter < itkFloatImageType, itkFloatImageType > ResampleImageFilter;
-  ResampleImageFilter::Pointer resampleImageFilter = ResampleImageFilter::New();
-
-  itkFloatImageType::Pointer itkImage;
-
-  mitk::CastToItkImage(image, itkImage);
-  itkFloatImageType::SpacingType outputSpacing;
-  itkFloatImageType::SizeType inputSize = itkImage->GetLargestPossibleRegion().GetSize();
-  itkFloatImageType::SizeType outputSize = inputSize;
-
-  outputSpacing[0] = itkImage->GetSpacing()[0] * (static_cast<double>(inputSize[0]) / static_cast<double>(outputSize[0]));
-  outputSpacing[1] = verticalSpacing;
-  outputSpacing[2] = itkImage->GetSpacing()[2];
-
-  outputSize[1] = inputSize[1] * itkImage->GetSpacing()[1] / outputSpacing[1];
-
-  typedef itk::IdentityTransform<double, 3> TransformType;
-  resampleImageFilter->SetInput(itkImage);
-  resampleImageFilter->SetSize(outputSize);
-  resampleImageFilter->SetOutputSpacing(outputSpacing);
-  resampleImageFilter->SetTransform(TransformType::New());
-
-  resampleImageFilter->UpdateLargestPossibleRegion();
-  return mitk::GrabItkImageMemory(resampleImageFilter->GetOutput());
+  // the beamformed lines are parallel, one image column per line and one image row per sample
+  mitk::Vector3D spacing = image->GetGeometry()->GetSpacing();
+
+  mitk::USScanConverter::ScanGeometry scanGeometry;
+  scanGeometry.NumberOfLines = image->GetDimension(0);
+  scanGeometry.SamplesPerLine = image->GetDimension(1);
+  scanGeometry.Layout = mitk::USScanConverter::LinesAlongSamples;
+  scanGeometry.LinePositionStep = spacing[0];
+  scanGeometry.SampleDepthStep = spacing[1];
+
+  m_VerticalResampler->SetScanGeometry(scanGeometry);
+  m_VerticalResampler->SetOutputSpacing(spacing[0], verticalSpacing);
+  return m_VerticalResampler->Convert(image);
 }
 
 mitk::Image::Pointer mitk::USDiPhASImageSource::ApplyScatteringCompensation(mitk::Image::Pointer inputImage, int scattering)
@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 
 #include "mitkUSImageSource.h"
+#include "mitkUSScanConverter.h"
 #include "mitkUSDiPhASCustomControls.h"
 
 #include "Framework.IBMT.US.CWrapper.h"
@@ -135,7 +136,10 @@ protected:
 
   mitk::Image::Pointer ApplyBmodeFilter(mitk::Image::Pointer image, bool useLogFilter = false);
   mitk::Image::Pointer CutOffTop(mitk::Image::Pointer image, int cutOffSize = 165);
+  /** Resamples the depth axis by the lookup table of m_VerticalResampler, which is only rebuilt if the frame
+    * size, the spacing or verticalSpacing change. */
   mitk::Image::Pointer ResampleOutputVertical(mitk::Image::Pointer image, float verticalSpacing = 0.1);
+  mitk::USScanConverter::Pointer        m_VerticalResampler;
 
   mitk::Image::Pointer ApplyScatteringCompensation(mitk::Image::Pointer inputImage, int scatteringCoefficient);
   mitk::Image::Pointer ApplyResampling(mitk::Image::Pointer inputImage, mitk::Vector3D outputSpacing, unsigned int outputSize[3]);
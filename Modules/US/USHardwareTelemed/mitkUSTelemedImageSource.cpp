@@ -28,7 +28,8 @@ mitk::USTelemedImageSource::USTelemedImageSource()
   m_ImageProperties(0),
   m_DepthProperties(0),
   m_OldnXPelsPerUnit(0),
-  m_OldnYPelsPerUnit(0)
+  m_OldnYPelsPerUnit(0),
+  m_ScanConverter(nullptr)
 
 {
 
@@ -65,8 +66,8 @@ void mitk::USTelemedImageSource::GetNextRawImage(std::vector<mitk::Image::Pointe
   {
     m_ImageMutex->Lock();
 
-    // copy contents of the given image into the member variable
-    imageVector.at(0)->Initialize(m_Image->GetPixelType(), m_Image->GetDimension(), m_Image->GetDimensions());
+    // copy contents of the given image into an image of the pool
+    imageVector.at(0) = this->GetImagePool()->AcquireImage(m_Image->GetPixelType(), m_Image->GetDimension(), m_Image->GetDimensions());
     mitk::ImageReadAccessor inputReadAccessor(m_Image, m_Image->GetSliceData(0,0,0));
     imageVector.at(0)->SetSlice(inputReadAccessor.GetData());
     imageVector.at(0)->SetGeometry(m_Image->GetGeometry());
@@ -87,6 +88,13 @@ void mitk::USTelemedImageSource::UpdateImageGeometry()
   spacing[1] = ((double)1 / resolutionInMeters.nXPelsPerUnit) * 1000; //conversion: meters to millimeters
   spacing[2] = 1;
 
+  // images converted by MITK have the spacing of the scan converter
+  if (m_ScanConverter.IsNotNull())
+  {
+    spacing[0] = m_ScanConverter->GetOutputSpacing()[0];
+    spacing[1] = m_ScanConverter->GetOutputSpacing()[1];
+  }
+
   m_ImageMutex->Lock();
   if(m_Image.IsNotNull() && (m_Image->GetGeometry()!=nullptr))
     {
@@ -102,6 +110,17 @@ void mitk::USTelemedImageSource::UpdateImageGeometry()
   MITK_DEBUG << "new spacing: " << spacing;
 }
 
+void mitk::USTelemedImageSource::SetScanConverter(mitk::USScanConverter::Pointer scanConverter)
+{
+  m_ScanConverter = scanConverter;
+  if (m_PluginCallback) { m_PluginCallback->SetScanConverter(m_ScanConverter); }
+}
+
+mitk::USScanConverter::Pointer mitk::USTelemedImageSource::GetScanConverter() const
+{
+  return m_ScanConverter;
+}
+
 bool mitk::USTelemedImageSource::CreateAndConnectConverterPlugin(Usgfw2Lib::IUsgDataView* usgDataView, Usgfw2Lib::tagScanMode scanMode)
 {
   IUnknown* tmp_obj = nullptr;
@@ -121,6 +140,7 @@ bool mitk::USTelemedImageSource::CreateAndConnectConverterPlugin(Usgfw2Lib::IUsg
 
     // current image buffer should be copied to m_Image at every callback
     m_PluginCallback->SetOutputImage(m_Image.GetPointer(), m_ImageMutex);
+    m_PluginCallback->SetScanConverter(m_ScanConverter);
   }
   else
   {
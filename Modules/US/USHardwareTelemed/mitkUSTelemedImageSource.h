@@ -59,6 +59,15 @@ public:
     */
   bool CreateAndConnectConverterPlugin( Usgfw2Lib::IUsgDataView*, Usgfw2Lib::tagScanMode );
 
+  /**
+    * \brief Lets MITK compute the images from the beam space data of the
+    * Telemed API (see USTelemedScanConverterPlugin::SetScanConverter()).
+    * The spacing of the images is the output spacing of the converter then.
+    * A nullptr switches back to the scan conversion of the Telemed API.
+    */
+  void SetScanConverter( mitk::USScanConverter::Pointer scanConverter );
+  mitk::USScanConverter::Pointer GetScanConverter( ) const;
+
 protected:
   USTelemedImageSource( );
   virtual ~USTelemedImageSource( );
@@ -77,6 +86,7 @@ protected:
 
   mitk::Image::Pointer                        m_Image;
   itk::FastMutexLock::Pointer                 m_ImageMutex;
+  mitk::USScanConverter::Pointer              m_ScanConverter;
 };
 } // namespace mitk
 
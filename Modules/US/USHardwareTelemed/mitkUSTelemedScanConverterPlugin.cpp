@@ -18,7 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkImageWriteAccessor.h"
 
 USTelemedScanConverterPlugin::USTelemedScanConverterPlugin( )
-  : m_Plugin(nullptr), m_OutputImage(nullptr), m_OutputImageMutex(nullptr)
+  : m_Plugin(nullptr), m_OutputImage(nullptr), m_OutputImageMutex(nullptr), m_ScanConverter(nullptr)
 {
 }
 
@@ -66,11 +66,17 @@ STDMETHODIMP USTelemedScanConverterPlugin::InterimOutBufferCB (
 
   if ( m_OutputImageMutex.IsNotNull() ) { m_OutputImageMutex->Lock(); }
 
-  // initialize mitk::Image with given image size on the first time
-  if ( ! m_OutputImage->IsInitialized() )
+  if ( this->ConvertInterimBuffer(pBufferInterim, nInterimBufferLen) )
   {
-    unsigned int dim[]={static_cast<unsigned int>(abs(nOutX2 - nOutX1)), static_cast<unsigned int>(abs(nOutY2 - nOutY1))}; // image dimensions
+    if ( m_OutputImageMutex.IsNotNull() ) { m_OutputImageMutex->Unlock(); }
+    return S_OK;
+  }
 
+  // initialize mitk::Image with given image size on the first time (or
+  // again if the image was last initialized by the scan converter)
+  unsigned int dim[]={static_cast<unsigned int>(abs(nOutX2 - nOutX1)), static_cast<unsigned int>(abs(nOutY2 - nOutY1))}; // image dimensions
+  if ( ! m_OutputImage->IsInitialized() || m_OutputImage->GetDimension(0) != dim[0] || m_OutputImage->GetDimension(1) != dim[1] )
+  {
     m_OutputImage->Initialize(mitk::MakeScalarPixelType<BYTE>(), 2, dim);
   }
 
@@ -82,6 +88,59 @@ STDMETHODIMP USTelemedScanConverterPlugin::InterimOutBufferCB (
   return S_OK;
 }
 
+bool USTelemedScanConverterPlugin::ConvertInterimBuffer(PBYTE pBufferInterim, int nInterimBufferLen)
+{
+  if ( m_ScanConverter.IsNull() || pBufferInterim == nullptr ) { return false; }
+
+  const mitk::USScanConverter::ScanGeometry& scanGeometry = m_ScanConverter->GetScanGeometry();
+  if ( static_cast<long long>(nInterimBufferLen) !=
+    static_cast<long long>(scanGeometry.NumberOfLines) * scanGeometry.SamplesPerLine )
+  {
+    return false;
+  }
+
+  try
+  {
+    unsigned int dim[2];
+    m_ScanConverter->GetOutputDimensions(dim);
+
+    // the table of the converter is kept as long as probe and depth do not change,
+    // so the image is only reinitialized on such changes as well
+    if ( ! m_OutputImage->IsInitialized() || m_OutputImage->GetDimension(0) != dim[0]
+      || m_OutputImage->GetDimension(1) != dim[1] )
+    {
+      m_OutputImage->Initialize(mitk::MakeScalarPixelType<BYTE>(), 2, dim);
+    }
+
+    mitk::Vector2D outputSpacing = m_ScanConverter->GetOutputSpacing();
+    mitk::Vector3D spacing = m_OutputImage->GetGeometry()->GetSpacing();
+    if ( spacing[0] != outputSpacing[0] || spacing[1] != outputSpacing[1] )
+    {
+      spacing[0] = outputSpacing[0];
+      spacing[1] = outputSpacing[1];
+      m_OutputImage->GetGeometry()->SetSpacing(spacing);
+    }
+
+    mitk::ImageWriteAccessor writeAccess(m_OutputImage);
+    m_ScanConverter->Convert(pBufferInterim, static_cast<unsigned char*>(writeAccess.GetData()));
+  }
+  catch ( const mitk::Exception& e )
+  {
+    MITK_WARN("IUsgfwScanConverterPluginCB")("ScanConverterPlugin")
+      << "Scan conversion of the interim buffer failed, using the Telemed output: " << e.GetDescription();
+    return false;
+  }
+
+  return true;
+}
+
+void USTelemedScanConverterPlugin::SetScanConverter(mitk::USScanConverter::Pointer scanConverter)
+{
+  if ( m_OutputImageMutex.IsNotNull() ) { m_OutputImageMutex->Lock(); }
+  m_ScanConverter = scanConverter;
+  if ( m_OutputImageMutex.IsNotNull() ) { m_OutputImageMutex->Unlock(); }
+}
+
 void USTelemedScanConverterPlugin::ReleasePlugin()
 {
   if (m_Plugin != nullptr)
@@ -25,6 +25,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkUSTelemedSDKHeader.h"
 #include "mitkImage.h"
+#include "mitkUSScanConverter.h"
 
 #include "itkFastMutexLock.h"
 
@@ -63,6 +64,16 @@ public:
     */
   void SetOutputImage(mitk::Image::Pointer outputImage, itk::FastMutexLock::Pointer outputImageMutex = 0);
 
+  /**
+    * Optional scan converter for the interim (beam space) buffer of the
+    * Telemed API. If it is set, the output image is computed from the interim
+    * buffer by the precomputed tables of the converter instead of being copied
+    * from the Telemed output buffer. Its scan geometry has to describe the
+    * interim buffer of the current probe and depth; frames whose interim buffer
+    * does not match in size are copied from the Telemed output as before.
+    */
+  void SetScanConverter(mitk::USScanConverter::Pointer scanConverter);
+
   // receives pointers to input and output media samples
   STDMETHOD(SampleCB) (
     IMediaSample *pSampleIn,
@@ -163,6 +174,17 @@ protected:
     */
   itk::FastMutexLock::Pointer m_OutputImageMutex;
 
+  /**
+    * Converts the interim buffer into the output image if it is set.
+    */
+  mitk::USScanConverter::Pointer m_ScanConverter;
+
+  /**
+    * Converts the interim buffer into m_OutputImage if m_ScanConverter is set
+    * and matches the buffer. Must be called with the output image mutex locked.
+    */
+  bool ConvertInterimBuffer(PBYTE pBufferInterim, int nInterimBufferLen);
+
 private:
   long m_cRef ;
 };
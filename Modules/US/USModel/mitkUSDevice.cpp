@@ -643,7 +643,10 @@ void mitk::USDevice::GenerateData()
       // copy contents of the given image into the member variable
       mitk::ImageReadAccessor inputReadAccessor(image);
       output->SetImportVolume(inputReadAccessor.GetData());
-      output->SetGeometry(image->GetGeometry());
+
+      // copy the geometry instead of sharing it, as the image may be
+      // recycled by the image pool of the source for one of the next frames
+      output->GetGeometry()->SetIndexToWorldTransformByVtkMatrix(image->GetGeometry()->GetVtkMatrix());
     }
   }  
   m_ImageMutex->Unlock();
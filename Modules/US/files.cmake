@@ -18,6 +18,8 @@ USModel/mitkUSDeviceWriterXML.cpp
 ## Filters and Sources
 USFilters/mitkUSImageLoggingFilter.cpp
 USFilters/mitkUSImageSource.cpp
+USFilters/mitkUSImagePool.cpp
+USFilters/mitkUSScanConverter.cpp
 USFilters/mitkUSImageVideoSource.cpp
 USFilters/mitkIGTLMessageToUSImageFilter.cpp
 
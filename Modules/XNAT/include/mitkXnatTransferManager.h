@@ -0,0 +1,127 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKXNATTRANSFERMANAGER_H
+#define MITKXNATTRANSFERMANAGER_H
+
+#include "MitkXNATExports.h"
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSharedPointer>
+#include <QString>
+#include <QUuid>
+
+class ctkXnatFile;
+class ctkXnatSession;
+class QNetworkAccessManager;
+class QNetworkRequest;
+class QUrlQuery;
+
+namespace mitk
+{
+  /**
+   * \brief Queues downloads and uploads of XNAT resources and runs a bounded number of them in parallel.
+   *
+   * The transfers use the HTTP session of the given ctkXnatSession. They run asynchronously in the event loop of
+   * the calling thread, one signal is emitted per finished or failed transfer and AllFinished() once the queue is
+   * empty. WaitForFinished() runs a local event loop for callers which need the results right away.
+   *
+   * Downloads are written to the file "<localFile>.part", which is only renamed to the local file when the transfer
+   * is complete. A partial file left behind by a failed or canceled transfer, also of an earlier session, is resumed
+   * with a range request. Failed transfers are retried a few times before Failed() is emitted.
+   *
+   * A download is skipped if the local file already exists and matches the MD5 checksum of the resource, or its size
+   * if the server provides no checksum, so data which was downloaded before is served from the download folder.
+   */
+  class MITKXNAT_EXPORT XnatTransferManager : public QObject
+  {
+    Q_OBJECT
+
+  public:
+    explicit XnatTransferManager(ctkXnatSession *session, QObject *parent = nullptr);
+    ~XnatTransferManager() override;
+
+    ctkXnatSession *GetSession() const;
+
+    /** \brief Number of transfers running at the same time, 4 by default */
+    void SetMaximumNumberOfTransfers(int maximumNumberOfTransfers);
+    int GetMaximumNumberOfTransfers() const;
+
+    /** \brief How often a failed transfer is started again (resumed for downloads), 3 by default */
+    void SetMaximumNumberOfRetries(int maximumNumberOfRetries);
+    int GetMaximumNumberOfRetries() const;
+
+    /**
+     * \brief Queues the download of a resource of the server, e.g. the resource URI of a ctkXnatFile.
+     *
+     * \param md5 hexadecimal MD5 checksum of the resource, if known it is used for the cache lookup and to verify
+     *        the download
+     * \param size size of the resource in bytes, -1 if unknown
+     * \return the id used in the signals; the id of the queued transfer if the file is being downloaded already
+     */
+    QUuid Download(const QString &resource, const QString &localFile, const QString &md5 = QString(), qint64 size = -1);
+
+    /** \brief Queues the download of the file, checksum and size are taken from its properties */
+    QUuid Download(const ctkXnatFile *file, const QString &localFile);
+
+    /** \brief Queues the upload of the local file to the resource, e.g. ".../resources/<label>/files/<name>" */
+    QUuid Upload(const QString &localFile, const QString &resource);
+
+    /** \brief Removes a queued transfer or aborts a running one, partial downloads are kept for resuming */
+    void Cancel(const QUuid &id);
+    void CancelAll();
+
+    bool IsIdle() const;
+
+    /** \brief Processes events until all queued transfers are finished or failed */
+    void WaitForFinished();
+
+    /** \brief Whether the local file exists and matches the checksum, or the size if there is no checksum */
+    static bool IsCached(const QString &localFile, const QString &md5, qint64 size);
+
+  signals:
+    /** \brief bytesTotal is -1 if unknown */
+    void Progress(QUuid id, qint64 bytesTransferred, qint64 bytesTotal);
+    void Finished(QUuid id, const QString &localFile);
+    void Failed(QUuid id, const QString &message);
+    void AllFinished();
+
+  private slots:
+    void StartPending();
+
+  private:
+    struct Transfer;
+    typedef QSharedPointer<Transfer> TransferPointer;
+
+    QUuid Enqueue(const TransferPointer &transfer);
+    bool Start(const TransferPointer &transfer);
+    void OnFinished(const TransferPointer &transfer);
+    QNetworkRequest CreateRequest(const QString &resource, const QUrlQuery &query) const;
+
+    ctkXnatSession *m_Session;
+    QNetworkAccessManager *m_Network;
+    int m_MaximumNumberOfTransfers;
+    int m_MaximumNumberOfRetries;
+    bool m_StartScheduled;
+
+    QList<TransferPointer> m_Pending;
+    QHash<QUuid, TransferPointer> m_Active;
+  };
+}
+
+#endif // MITKXNATTRANSFERMANAGER_H
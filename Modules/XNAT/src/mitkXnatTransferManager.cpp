@@ -0,0 +1,420 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkXnatTransferManager.h"
+
+#include <mitkLogMacros.h>
+
+#include <ctkXnatFile.h>
+#include <ctkXnatSession.h>
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QUrl>
+#include <QUrlQuery>
+
+#include <algorithm>
+
+namespace
+{
+  QString ComputeMD5(const QString &fileName)
+  {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+      return QString();
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(&file);
+    return QString::fromLatin1(hash.result().toHex());
+  }
+
+  /** Client errors other than timeouts will not go away by trying again, an unsatisfiable range restarts */
+  bool IsRetriable(int httpStatusCode)
+  {
+    return httpStatusCode < 400 || httpStatusCode >= 500 || httpStatusCode == 408 || httpStatusCode == 416;
+  }
+}
+
+struct mitk::XnatTransferManager::Transfer
+{
+  Transfer() : IsUpload(false), Size(-1), Offset(0), Retries(0), Canceled(false), Reply(nullptr) {}
+
+  QUuid Id;
+  bool IsUpload;
+  QString Resource;
+  QString LocalFile;
+  QString MD5;
+  qint64 Size;
+
+  /** Bytes of the partial download present before the current request */
+  qint64 Offset;
+  int Retries;
+  bool Canceled;
+
+  QFile File;
+  QNetworkReply *Reply;
+};
+
+mitk::XnatTransferManager::XnatTransferManager(ctkXnatSession *session, QObject *parent)
+  : QObject(parent),
+    m_Session(session),
+    m_Network(new QNetworkAccessManager(this)),
+    m_MaximumNumberOfTransfers(4),
+    m_MaximumNumberOfRetries(3),
+    m_StartScheduled(false)
+{
+}
+
+mitk::XnatTransferManager::~XnatTransferManager()
+{
+  m_Pending.clear();
+  for (const TransferPointer &transfer : m_Active)
+  {
+    QNetworkReply *reply = transfer->Reply;
+    transfer->Reply = nullptr;
+    reply->disconnect(this);
+    reply->abort();
+    reply->deleteLater();
+    transfer->File.close();
+  }
+  m_Active.clear();
+}
+
+ctkXnatSession *mitk::XnatTransferManager::GetSession() const
+{
+  return m_Session;
+}
+
+void mitk::XnatTransferManager::SetMaximumNumberOfTransfers(int maximumNumberOfTransfers)
+{
+  m_MaximumNumberOfTransfers = std::max(1, maximumNumberOfTransfers);
+}
+
+int mitk::XnatTransferManager::GetMaximumNumberOfTransfers() const
+{
+  return m_MaximumNumberOfTransfers;
+}
+
+void mitk::XnatTransferManager::SetMaximumNumberOfRetries(int maximumNumberOfRetries)
+{
+  m_MaximumNumberOfRetries = std::max(0, maximumNumberOfRetries);
+}
+
+int mitk::XnatTransferManager::GetMaximumNumberOfRetries() const
+{
+  return m_MaximumNumberOfRetries;
+}
+
+QUuid mitk::XnatTransferManager::Download(const QString &resource,
+                                          const QString &localFile,
+                                          const QString &md5,
+                                          qint64 size)
+{
+  // two transfers must not write to the same partial file
+  const QString absoluteFile = QFileInfo(localFile).absoluteFilePath();
+  for (const TransferPointer &transfer : m_Pending)
+  {
+    if (!transfer->IsUpload && transfer->LocalFile == absoluteFile)
+      return transfer->Id;
+  }
+  for (const TransferPointer &transfer : m_Active)
+  {
+    if (!transfer->IsUpload && transfer->LocalFile == absoluteFile)
+      return transfer->Id;
+  }
+
+  TransferPointer transfer(new Transfer);
+  transfer->Resource = resource;
+  transfer->LocalFile = absoluteFile;
+  transfer->MD5 = md5.toLower();
+  transfer->Size = size;
+  return this->Enqueue(transfer);
+}
+
+QUuid mitk::XnatTransferManager::Download(const ctkXnatFile *file, const QString &localFile)
+{
+  bool ok = false;
+  qint64 size = file->property("Size").toLongLong(&ok);
+  if (!ok)
+    size = -1;
+
+  return this->Download(file->resourceUri(), localFile, file->property("digest"), size);
+}
+
+QUuid mitk::XnatTransferManager::Upload(const QString &localFile, const QString &resource)
+{
+  TransferPointer transfer(new Transfer);
+  transfer->IsUpload = true;
+  transfer->Resource = resource;
+  transfer->LocalFile = QFileInfo(localFile).absoluteFilePath();
+  return this->Enqueue(transfer);
+}
+
+QUuid mitk::XnatTransferManager::Enqueue(const TransferPointer &transfer)
+{
+  transfer->Id = QUuid::createUuid();
+  m_Pending.append(transfer);
+
+  // started from the event loop, so the caller can match the id of signals emitted right away
+  if (!m_StartScheduled)
+  {
+    m_StartScheduled = true;
+    QMetaObject::invokeMethod(this, "StartPending", Qt::QueuedConnection);
+  }
+  return transfer->Id;
+}
+
+void mitk::XnatTransferManager::Cancel(const QUuid &id)
+{
+  for (int i = 0; i < m_Pending.size(); ++i)
+  {
+    if (m_Pending[i]->Id == id)
+    {
+      m_Pending.removeAt(i);
+      emit Failed(id, "Canceled");
+      if (this->IsIdle())
+        emit AllFinished();
+      return;
+    }
+  }
+
+  auto iter = m_Active.find(id);
+  if (iter != m_Active.end())
+  {
+    // the reply finishes with an error, which is handled in OnFinished()
+    iter.value()->Canceled = true;
+    iter.value()->Reply->abort();
+  }
+}
+
+void mitk::XnatTransferManager::CancelAll()
+{
+  while (!m_Pending.isEmpty())
+    this->Cancel(m_Pending.first()->Id);
+
+  const QList<QUuid> active = m_Active.keys();
+  for (const QUuid &id : active)
+    this->Cancel(id);
+}
+
+bool mitk::XnatTransferManager::IsIdle() const
+{
+  return m_Pending.isEmpty() && m_Active.isEmpty();
+}
+
+void mitk::XnatTransferManager::WaitForFinished()
+{
+  if (this->IsIdle())
+    return;
+
+  QEventLoop loop;
+  connect(this, SIGNAL(AllFinished()), &loop, SLOT(quit()));
+  loop.exec();
+}
+
+bool mitk::XnatTransferManager::IsCached(const QString &localFile, const QString &md5, qint64 size)
+{
+  const QFileInfo fileInfo(localFile);
+  if (!fileInfo.exists())
+    return false;
+
+  if (!md5.isEmpty())
+    return ComputeMD5(localFile).compare(md5, Qt::CaseInsensitive) == 0;
+
+  return size < 0 || fileInfo.size() == size;
+}
+
+void mitk::XnatTransferManager::StartPending()
+{
+  m_StartScheduled = false;
+
+  while (!m_Pending.isEmpty() && m_Active.size() < m_MaximumNumberOfTransfers)
+  {
+    const TransferPointer transfer = m_Pending.takeFirst();
+    if (this->Start(transfer))
+      m_Active.insert(transfer->Id, transfer);
+  }
+
+  if (this->IsIdle())
+    emit AllFinished();
+}
+
+bool mitk::XnatTransferManager::Start(const TransferPointer &transfer)
+{
+  if (transfer->IsUpload)
+  {
+    transfer->File.setFileName(transfer->LocalFile);
+    if (!transfer->File.open(QIODevice::ReadOnly))
+    {
+      emit Failed(transfer->Id, "Could not read " + transfer->LocalFile);
+      return false;
+    }
+
+    QUrlQuery query;
+    query.addQueryItem("inbody", "true");
+    query.addQueryItem("overwrite", "true");
+
+    // the file is streamed from disk as the request body
+    transfer->Reply = m_Network->put(this->CreateRequest(transfer->Resource, query), &transfer->File);
+    connect(transfer->Reply, &QNetworkReply::uploadProgress, this, [this, transfer](qint64 sent, qint64 total) {
+      emit Progress(transfer->Id, sent, total);
+    });
+  }
+  else
+  {
+    if (IsCached(transfer->LocalFile, transfer->MD5, transfer->Size))
+    {
+      MITK_INFO << "Using cached " << transfer->LocalFile.toStdString();
+      emit Finished(transfer->Id, transfer->LocalFile);
+      return false;
+    }
+
+    QDir().mkpath(QFileInfo(transfer->LocalFile).absolutePath());
+    transfer->File.setFileName(transfer->LocalFile + ".part");
+    transfer->Offset = transfer->File.exists() ? transfer->File.size() : 0;
+    if (transfer->Size >= 0 && transfer->Offset > transfer->Size)
+    {
+      transfer->File.remove();
+      transfer->Offset = 0;
+    }
+
+    if (!transfer->File.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+      emit Failed(transfer->Id, "Could not write " + transfer->File.fileName());
+      return false;
+    }
+
+    QNetworkRequest request = this->CreateRequest(transfer->Resource, QUrlQuery());
+    if (transfer->Offset > 0)
+    {
+      MITK_INFO << "Resuming download of " << transfer->LocalFile.toStdString() << " at byte " << transfer->Offset;
+      request.setRawHeader("Range", "bytes=" + QByteArray::number(transfer->Offset) + "-");
+    }
+
+    transfer->Reply = m_Network->get(request);
+    connect(transfer->Reply, &QNetworkReply::metaDataChanged, this, [transfer]() {
+      // the server ignored the range and sends the whole file
+      const int status = transfer->Reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+      if (transfer->Offset > 0 && status == 200)
+      {
+        transfer->File.resize(0);
+        transfer->Offset = 0;
+      }
+    });
+    // written while receiving, so not more than the buffer of the reply is held in memory
+    connect(transfer->Reply, &QNetworkReply::readyRead, this, [transfer]() {
+      transfer->File.write(transfer->Reply->readAll());
+    });
+    connect(transfer->Reply, &QNetworkReply::downloadProgress, this, [this, transfer](qint64 received, qint64 total) {
+      emit Progress(transfer->Id, transfer->Offset + received, total >= 0 ? transfer->Offset + total : transfer->Size);
+    });
+  }
+
+  connect(transfer->Reply, &QNetworkReply::finished, this, [this, transfer]() { this->OnFinished(transfer); });
+  return true;
+}
+
+void mitk::XnatTransferManager::OnFinished(const TransferPointer &transfer)
+{
+  QNetworkReply *reply = transfer->Reply;
+  transfer->Reply = nullptr;
+  reply->deleteLater();
+  m_Active.remove(transfer->Id);
+
+  const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+  QNetworkReply::NetworkError error = reply->error();
+  QString message = reply->errorString();
+
+  if (!transfer->IsUpload)
+  {
+    transfer->File.write(reply->readAll());
+    transfer->File.close();
+    const QString partFile = transfer->File.fileName();
+
+    // a partial file which is complete already
+    if (status == 416 && transfer->Size >= 0 && QFileInfo(partFile).size() == transfer->Size)
+      error = QNetworkReply::NoError;
+
+    if (error == QNetworkReply::NoError && !transfer->MD5.isEmpty() && ComputeMD5(partFile) != transfer->MD5)
+    {
+      QFile::remove(partFile);
+      error = QNetworkReply::UnknownContentError;
+      message = "Checksum mismatch";
+    }
+    else if (status == 416)
+    {
+      // the partial file does not belong to the resource
+      QFile::remove(partFile);
+    }
+
+    if (error == QNetworkReply::NoError)
+    {
+      QFile::remove(transfer->LocalFile);
+      if (!QFile::rename(partFile, transfer->LocalFile))
+      {
+        error = QNetworkReply::UnknownContentError;
+        message = "Could not write " + transfer->LocalFile;
+      }
+    }
+  }
+  else
+  {
+    transfer->File.close();
+  }
+
+  if (error == QNetworkReply::NoError)
+  {
+    MITK_INFO << (transfer->IsUpload ? "Upload of " : "Download of ") << transfer->LocalFile.toStdString()
+              << " completed!";
+    emit Finished(transfer->Id, transfer->LocalFile);
+  }
+  else if (!transfer->Canceled && transfer->Retries < m_MaximumNumberOfRetries && IsRetriable(status))
+  {
+    ++transfer->Retries;
+    MITK_WARN << "Transfer of " << transfer->LocalFile.toStdString() << " failed (" << message.toStdString()
+              << "), retrying.";
+    m_Pending.prepend(transfer);
+  }
+  else
+  {
+    MITK_WARN << "Transfer of " << transfer->LocalFile.toStdString() << " failed: " << message.toStdString();
+    emit Failed(transfer->Id, transfer->Canceled ? QString("Canceled") : message);
+  }
+
+  this->StartPending();
+}
+
+QNetworkRequest mitk::XnatTransferManager::CreateRequest(const QString &resource, const QUrlQuery &query) const
+{
+  QString base = m_Session->url().toString();
+  if (base.endsWith('/'))
+    base.chop(1);
+
+  QUrl url(base + resource);
+  if (!query.isEmpty())
+    url.setQuery(query);
+
+  QNetworkRequest request(url);
+  request.setRawHeader("Cookie", "JSESSIONID=" + m_Session->sessionId().toLatin1());
+  request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
+  return request;
+}
@@ -29,6 +29,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mitkVtkLoggingAdapter.h>
 #include <mitkItkLoggingAdapter.h>
+#include <mitkModuleActivationProfile.h>
+
+#include <cstdlib>
+#include <sstream>
 
 
 namespace mitk
@@ -106,6 +110,13 @@ void org_mitk_core_services_Activator::start(ctkPluginContext* context)
   }
 
   mitkContext->AddServiceListener(this, &org_mitk_core_services_Activator::MitkServiceChanged);
+
+  if (getenv("MITK_PRINT_MODULE_ACTIVATION_PROFILE"))
+  {
+    std::ostringstream profile;
+    mitk::ModuleActivationProfile::Print(profile);
+    MITK_INFO << "Module activation profile:\n" << profile.str();
+  }
 }
 
 void org_mitk_core_services_Activator::stop(ctkPluginContext* /*context*/)
@@ -223,30 +223,28 @@ void QmitkImageStatisticsCalculationThread::run()
   //calculator->SetHistogramBinSize( m_HistogramBinSize );
   //calculator->SetUseDefaultBinSize( m_UseDefaultBinSize );
 
-  for (unsigned int i = 0; i < m_StatisticsImage->GetTimeSteps(); i++)
+  try
   {
-    try
-    {
-      calculator->GetStatistics(i);
-    }
-    catch ( mitk::Exception& e)
-    {
-      //m_message = e.GetDescription();
-      MITK_ERROR<< "MITK Exception: " << e.what();
-      statisticCalculationSuccessful = false;
-    }
-    catch ( const std::runtime_error &e )
-    {
-      //m_message = "Failure: " + std::string(e.what());
-      MITK_ERROR<< "Runtime Exception: " << e.what();
-      statisticCalculationSuccessful = false;
-    }
-    catch ( const std::exception &e )
-    {
-      //m_message = "Failure: " + std::string(e.what());
-      MITK_ERROR<< "Standard Exception: " << e.what();
-      statisticCalculationSuccessful = false;
-    }
+    // computes all time steps in one pass, GetStatistics() below only returns the results
+    calculator->ComputeAllTimeSteps();
+  }
+  catch ( mitk::Exception& e)
+  {
+    //m_message = e.GetDescription();
+    MITK_ERROR<< "MITK Exception: " << e.what();
+    statisticCalculationSuccessful = false;
+  }
+  catch ( const std::runtime_error &e )
+  {
+    //m_message = "Failure: " + std::string(e.what());
+    MITK_ERROR<< "Runtime Exception: " << e.what();
+    statisticCalculationSuccessful = false;
+  }
+  catch ( const std::exception &e )
+  {
+    //m_message = "Failure: " + std::string(e.what());
+    MITK_ERROR<< "Standard Exception: " << e.what();
+    statisticCalculationSuccessful = false;
   }
 
   this->m_StatisticChanged = statisticChanged;
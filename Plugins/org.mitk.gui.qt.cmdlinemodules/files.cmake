@@ -14,6 +14,7 @@ set(INTERNAL_CPP_FILES
   CommandLineModulesPreferencesPage.cpp
   CommandLineModulesView.cpp
   QmitkCmdLineModuleRunner.cpp
+  QmitkCmdLineModuleInputCache.cpp
 )
 
 set(UI_FILES
@@ -28,6 +28,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "QmitkCmdLineModuleFactoryGui.h"
 #include "QmitkCmdLineModuleGui.h"
 #include "QmitkCmdLineModuleRunner.h"
+#include "QmitkCmdLineModuleInputCache.h"
 
 // Qt
 #include <QDebug>
@@ -37,6 +38,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <QLayoutItem>
 #include <QWidgetItem>
 #include <QMessageBox>
+#include <QInputDialog>
+#include <QFileInfo>
 #include <QtConcurrentMap>
 
 // CTK
@@ -140,6 +143,7 @@ void CommandLineModulesView::CreateQtPartControl( QWidget *parent )
 
     // Connect signals to slots after we have set up GUI.
     connect(this->m_Controls->m_RunButton, SIGNAL(pressed()), this, SLOT(OnRunButtonPressed()));
+    connect(this->m_Controls->m_RunBatchButton, SIGNAL(pressed()), this, SLOT(OnRunBatchButtonPressed()));
     connect(this->m_Controls->m_RestoreDefaults, SIGNAL(pressed()), this, SLOT(OnRestoreButtonPressed()));
     connect(this->m_Controls->m_ComboBox, SIGNAL(actionChanged(QAction*)), this, SLOT(OnActionChanged(QAction*)));
     connect(this->m_Controls->m_TabWidget, SIGNAL(tabCloseRequested(int)), this, SLOT(OnTabCloseRequested(int)));
@@ -277,6 +281,10 @@ void CommandLineModulesView::OnPreferencesChanged(const berry::IBerryPreferences
   this->RetrieveAndStoreTemporaryDirectoryPreferenceValues();
   this->RetrieveAndStoreValidationMode();
   this->RetrieveAndStorePreferenceValues();
+
+  // The maximum number of concurrent processes may have been raised.
+  this->StartQueuedRunners();
+  this->UpdateRunButtonEnabledStatus();
 }
 
 
@@ -414,36 +422,81 @@ void CommandLineModulesView::OnRestoreButtonPressed()
 
 
 //-----------------------------------------------------------------------------
-void CommandLineModulesView::OnRunButtonPressed()
+QmitkCmdLineModuleRunner* CommandLineModulesView::CreateRunner(int tabNumber,
+                                                               const QList<QPair<QString, QString> >& parameterValues,
+                                                               const QString& outputSuffix)
 {
-  int tabNumber = m_Controls->m_TabWidget->currentIndex();
-  if (tabNumber >= 0)
+  // 1. Create a new QmitkCmdLineModuleRunner to represent the running widget.
+  auto  widget = new QmitkCmdLineModuleRunner(m_Controls->m_RunningWidgets);
+  widget->SetDataStorage(this->GetDataStorage());
+  widget->SetManager(m_ModuleManager);
+  widget->SetOutputDirectory(m_OutputDirectoryName);
+
+  // 2. Create a new front end.
+  QmitkCmdLineModuleFactoryGui factory(this->GetDataStorage());
+
+  ctkCmdLineModuleFrontend *frontEndOnCurrentTab = m_ListOfModules[tabNumber];
+  QmitkCmdLineModuleGui *frontEndGuiOnCurrentTab = dynamic_cast<QmitkCmdLineModuleGui*>(frontEndOnCurrentTab);
+  ctkCmdLineModuleReference currentTabFrontendReferences = frontEndGuiOnCurrentTab->moduleReference();
+
+  ctkCmdLineModuleFrontend *newFrontEnd = factory.create(currentTabFrontendReferences);
+  QmitkCmdLineModuleGui *newFrontEndGui = dynamic_cast<QmitkCmdLineModuleGui*>(newFrontEnd);
+  widget->SetFrontend(newFrontEndGui);
+  m_Layout->insertWidget(0, widget);
+
+  // 3. Copy parameters. This MUST come after widget->SetFrontEnd
+  newFrontEndGui->copyParameters(*frontEndGuiOnCurrentTab);
+  newFrontEndGui->setParameterContainerEnabled(false);
+
+  QStringList assignedNames;
+  QPair<QString, QString> parameterValue;
+  foreach (parameterValue, parameterValues)
   {
-    // 1. Create a new QmitkCmdLineModuleRunner to represent the running widget.
-    auto  widget = new QmitkCmdLineModuleRunner(m_Controls->m_RunningWidgets);
-    widget->SetDataStorage(this->GetDataStorage());
-    widget->SetManager(m_ModuleManager);
-    widget->SetOutputDirectory(m_OutputDirectoryName);
+    newFrontEndGui->setValue(parameterValue.first, parameterValue.second, ctkCmdLineModuleFrontend::DisplayRole);
+    assignedNames.push_back(parameterValue.first);
+  }
 
-    // 2. Create a new front end.
-    QmitkCmdLineModuleFactoryGui factory(this->GetDataStorage());
+  // Keep the jobs of a batch from overwriting each others output.
+  if (!outputSuffix.isEmpty())
+  {
+    QList<ctkCmdLineModuleParameter> parameters;
+    parameters = newFrontEndGui->parameters("image", ctkCmdLineModuleFrontend::Output);
+    parameters << newFrontEndGui->parameters("file", ctkCmdLineModuleFrontend::Output);
+    parameters << newFrontEndGui->parameters("geometry", ctkCmdLineModuleFrontend::Output);
+    foreach (ctkCmdLineModuleParameter parameter, parameters)
+    {
+      QString parameterName = parameter.name();
+      QString outputFileName = newFrontEndGui->value(parameterName, ctkCmdLineModuleFrontend::DisplayRole).toString();
+      if (assignedNames.contains(parameterName) || outputFileName.isEmpty())
+      {
+        continue;
+      }
 
-    ctkCmdLineModuleFrontend *frontEndOnCurrentTab = m_ListOfModules[tabNumber];
-    QmitkCmdLineModuleGui *frontEndGuiOnCurrentTab = dynamic_cast<QmitkCmdLineModuleGui*>(frontEndOnCurrentTab);
-    ctkCmdLineModuleReference currentTabFrontendReferences = frontEndGuiOnCurrentTab->moduleReference();
+      QFileInfo outputFileInfo(outputFileName);
+      QString fileName = outputFileInfo.baseName() + outputSuffix;
+      if (!outputFileInfo.completeSuffix().isEmpty())
+      {
+        fileName += "." + outputFileInfo.completeSuffix();
+      }
+      newFrontEndGui->setValue(parameterName, outputFileInfo.dir().filePath(fileName), ctkCmdLineModuleFrontend::DisplayRole);
+    }
+  }
 
-    ctkCmdLineModuleFrontend *newFrontEnd = factory.create(currentTabFrontendReferences);
-    QmitkCmdLineModuleGui *newFrontEndGui = dynamic_cast<QmitkCmdLineModuleGui*>(newFrontEnd);
-    widget->SetFrontend(newFrontEndGui);
-    m_Layout->insertWidget(0, widget);
+  // 4. Connect widget signals to here, to count how many jobs running.
+  connect(widget, SIGNAL(started()), this, SLOT(OnJobStarted()));
+  connect(widget, SIGNAL(finished()), this, SLOT(OnJobFinished()));
 
-    // 3. Copy parameters. This MUST come after widget->SetFrontEnd
-    newFrontEndGui->copyParameters(*frontEndGuiOnCurrentTab);
-    newFrontEndGui->setParameterContainerEnabled(false);
+  return widget;
+}
 
-    // 4. Connect widget signals to here, to count how many jobs running.
-    connect(widget, SIGNAL(started()), this, SLOT(OnJobStarted()));
-    connect(widget, SIGNAL(finished()), this, SLOT(OnJobFinished()));
+
+//-----------------------------------------------------------------------------
+void CommandLineModulesView::OnRunButtonPressed()
+{
+  int tabNumber = m_Controls->m_TabWidget->currentIndex();
+  if (tabNumber >= 0)
+  {
+    QmitkCmdLineModuleRunner *widget = this->CreateRunner(tabNumber);
 
     // 5. GO.
     widget->Run();
@@ -455,6 +508,78 @@ void CommandLineModulesView::OnRunButtonPressed()
 }
 
 
+//-----------------------------------------------------------------------------
+void CommandLineModulesView::OnRunBatchButtonPressed()
+{
+  int tabNumber = m_Controls->m_TabWidget->currentIndex();
+  if (tabNumber < 0)
+  {
+    this->AskUserToSelectAModule();
+    return;
+  }
+
+  bool ok = false;
+  QString text = QInputDialog::getMultiLineText(m_Parent,
+    "Batch",
+    "Enter one parameter configuration per line, as name=value pairs separated by ';'.\n"
+    "Parameters which are not listed keep their current value, output file names get the number of the line appended.",
+    m_BatchConfigurations,
+    &ok);
+
+  if (!ok)
+  {
+    return;
+  }
+  m_BatchConfigurations = text;
+
+  ctkCmdLineModuleFrontend *frontEnd = m_ListOfModules[tabNumber];
+  ctkCmdLineModuleDescription description = frontEnd->moduleReference().description();
+
+  // Parse everything first, so that a typo does not leave a partially queued batch.
+  QList<QList<QPair<QString, QString> > > configurations;
+  QStringList lines = text.split("\n", QString::SkipEmptyParts);
+  foreach (QString line, lines)
+  {
+    line = line.trimmed();
+    if (line.isEmpty())
+    {
+      continue;
+    }
+
+    QList<QPair<QString, QString> > configuration;
+    foreach (QString assignment, line.split(";", QString::SkipEmptyParts))
+    {
+      int separator = assignment.indexOf('=');
+      QString name = assignment.left(separator).trimmed();
+      if (separator < 0 || !description.hasParameter(name))
+      {
+        QMessageBox::warning(m_Parent, "Batch", tr("Invalid parameter assignment \"%1\" in line:\n%2").arg(assignment.trimmed()).arg(line));
+        return;
+      }
+      configuration.push_back(qMakePair(name, assignment.mid(separator + 1).trimmed()));
+    }
+    configurations.push_back(configuration);
+  }
+
+  if (configurations.isEmpty())
+  {
+    return;
+  }
+
+  // All jobs of the batch use the same temporary input files.
+  QSharedPointer<QmitkCmdLineModuleInputCache> inputCache(new QmitkCmdLineModuleInputCache());
+
+  for (int i = 0; i < configurations.size(); i++)
+  {
+    QmitkCmdLineModuleRunner *widget = this->CreateRunner(tabNumber, configurations[i], QString("_%1").arg(i + 1));
+    widget->SetInputCache(inputCache);
+    m_QueuedRunners.push_back(widget);
+  }
+
+  this->StartQueuedRunners();
+}
+
+
 //-----------------------------------------------------------------------------
 void CommandLineModulesView::UpdateRunButtonEnabledStatus()
 {
@@ -469,9 +594,37 @@ void CommandLineModulesView::UpdateRunButtonEnabledStatus()
 }
 
 
+//-----------------------------------------------------------------------------
+void CommandLineModulesView::StartQueuedRunners()
+{
+  while (!m_QueuedRunners.isEmpty()
+         && m_CurrentlyRunningProcesses + m_StartingRunners.size() < m_MaximumConcurrentProcesses)
+  {
+    QPointer<QmitkCmdLineModuleRunner> runner = m_QueuedRunners.takeFirst();
+
+    // The user removed the widget while it was waiting.
+    if (runner.isNull())
+    {
+      continue;
+    }
+
+    if (runner->Run())
+    {
+      m_StartingRunners.insert(runner.data());
+    }
+    else
+    {
+      // Run() already told the user, the remaining jobs would most likely fail the same way.
+      m_QueuedRunners.clear();
+    }
+  }
+}
+
+
 //-----------------------------------------------------------------------------
 void CommandLineModulesView::OnJobStarted()
 {
+  m_StartingRunners.remove(this->sender());
   m_CurrentlyRunningProcesses++;
   this->UpdateRunButtonEnabledStatus();
 }
@@ -480,7 +633,9 @@ void CommandLineModulesView::OnJobStarted()
 //-----------------------------------------------------------------------------
 void CommandLineModulesView::OnJobFinished()
 {
+  m_StartingRunners.remove(this->sender());
   m_CurrentlyRunningProcesses--;
+  this->StartQueuedRunners();
   this->UpdateRunButtonEnabledStatus();
 }
 
@@ -23,11 +23,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <ctkCmdLineModuleReference.h>
 #include <ctkCmdLineModuleResult.h>
 #include <ctkCmdLineModuleManager.h>
+#include <QPointer>
+#include <QSet>
 
 class ctkCmdLineModuleBackendLocalProcess;
 class ctkCmdLineModuleDirectoryWatcher;
 class CommandLineModulesViewControls;
 class QmitkCmdLineModuleRunner;
+class QmitkCmdLineModuleInputCache;
 class QAction;
 class QVBoxLayout;
 
@@ -85,6 +88,12 @@ protected Q_SLOTS:
    */
   void OnRunButtonPressed();
 
+  /**
+   * \brief Slot that is called when the batch button is pressed, asks the user for a list of
+   * parameter configurations and queues one job per configuration of the current module.
+   */
+  void OnRunBatchButtonPressed();
+
   /**
    * \brief Alerts the user of any errors comming out of the directory watcher.
    */
@@ -166,6 +175,21 @@ private:
    */
   void UpdateRunButtonEnabledStatus();
 
+  /**
+   * \brief Creates a job widget for the module of the given tab, with a copy of its current parameters.
+   * \param tabNumber the tab of the module
+   * \param parameterValues values replacing the copied ones, by parameter name
+   * \param outputSuffix appended to the base name of the output files whose value is not replaced
+   */
+  QmitkCmdLineModuleRunner* CreateRunner(int tabNumber,
+                                         const QList<QPair<QString, QString> >& parameterValues = QList<QPair<QString, QString> >(),
+                                         const QString& outputSuffix = QString());
+
+  /**
+   * \brief Starts queued batch jobs until m_MaximumConcurrentProcesses jobs are running.
+   */
+  void StartQueuedRunners();
+
   /**
    * \brief The GUI controls contain a reset and run button, and a QWidget container, and the GUI component
    * for each command line module is added to the QWidget dynamically at run time.
@@ -250,6 +274,21 @@ private:
    * \brief We keep a list of front ends to match the m_TabWidget.
    */
   QList<ctkCmdLineModuleFrontend*> m_ListOfModules;
+
+  /**
+   * \brief Batch jobs waiting for a free process, null if the user removed them meanwhile.
+   */
+  QList<QPointer<QmitkCmdLineModuleRunner> > m_QueuedRunners;
+
+  /**
+   * \brief Batch jobs which were run, but did not report that they started yet.
+   */
+  QSet<QObject*> m_StartingRunners;
+
+  /**
+   * \brief The configurations last entered for a batch, offered again for the next one.
+   */
+  QString m_BatchConfigurations;
 };
 
 #endif // CommandLineModulesView_h
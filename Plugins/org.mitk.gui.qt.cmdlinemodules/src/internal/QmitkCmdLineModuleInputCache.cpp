@@ -0,0 +1,178 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) University College London (UCL).
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "QmitkCmdLineModuleInputCache.h"
+
+// Qt
+#include <QDir>
+#include <QObject>
+#include <QRegExp>
+#include <QTemporaryFile>
+
+// MITK
+#include <mitkExceptionMacro.h>
+#include <mitkImage.h>
+#include <mitkIOUtil.h>
+
+
+//-----------------------------------------------------------------------------
+QmitkCmdLineModuleInputCache::QmitkCmdLineModuleInputCache()
+{
+}
+
+
+//-----------------------------------------------------------------------------
+QmitkCmdLineModuleInputCache::~QmitkCmdLineModuleInputCache()
+{
+}
+
+
+//-----------------------------------------------------------------------------
+QString QmitkCmdLineModuleInputCache::GetValidNodeName(const QString& nodeName)
+{
+  QString outputName = nodeName;
+
+  // We will allow A-Z, a-z, 0-9, period, hyphen and underscore in the output file name.
+  // This method is parsing a node name, and other bits of code add on a file extension .nii.
+  // So, in the output string from this function, we should not allow period, so that
+  // the second recommendation on this page:
+  // http://www.boost.org/doc/libs/1_43_0/libs/filesystem/doc/portability_guide.htm
+  // is still true.
+
+  QRegExp rx("[A-Z|a-z|0-9|-|_]{1,1}");
+
+  QString singleLetter;
+
+  for (int i = 0; i < outputName.size(); i++)
+  {
+    if (i == 0 && outputName[i] == '-')
+    {
+      outputName[i] = '_';
+    }
+
+    singleLetter = outputName[i];
+
+    if (!rx.exactMatch(singleLetter))
+    {
+      outputName[i] = '-';
+    }
+  }
+  return outputName;
+}
+
+
+//-----------------------------------------------------------------------------
+QSharedPointer<QTemporaryFile> QmitkCmdLineModuleInputCache::GetTemporaryImage(const ctkCmdLineModuleParameter& parameter, mitk::DataNode::ConstPointer node, QString& errorMessage)
+{
+  // Don't call this if node is null or node is not an image.
+  assert(node.GetPointer());
+  const mitk::Image* image = dynamic_cast<const mitk::Image*>(node->GetData());
+  assert(image);
+
+  // If no file extensions are specified, we default to .nii
+  QStringList fileExts = parameter.fileExtensions();
+  if (fileExts.isEmpty())
+  {
+    fileExts.push_back(".nii");
+  }
+
+  QPair<const mitk::DataNode*, QString> key(node.GetPointer(), fileExts.join(";"));
+
+  QMap<QPair<const mitk::DataNode*, QString>, CachedFile>::iterator iter = m_Files.find(key);
+  if (iter != m_Files.end()
+      && iter->Image.GetPointer() == image
+      && iter->ImageMTime == image->GetMTime())
+  {
+    errorMessage.clear();
+    return iter->File;
+  }
+
+  QTemporaryFile* tempFile = this->SaveTemporaryImage(fileExts, node, errorMessage);
+  if (tempFile == nullptr)
+  {
+    return QSharedPointer<QTemporaryFile>();
+  }
+
+  // Jobs still using a previous version keep their own reference to its file.
+  CachedFile cachedFile;
+  cachedFile.Node = node;
+  cachedFile.Image = image;
+  cachedFile.ImageMTime = image->GetMTime();
+  cachedFile.File = QSharedPointer<QTemporaryFile>(tempFile);
+  m_Files.insert(key, cachedFile);
+
+  return cachedFile.File;
+}
+
+
+//-----------------------------------------------------------------------------
+QTemporaryFile* QmitkCmdLineModuleInputCache::SaveTemporaryImage(const QStringList& fileExtensions, mitk::DataNode::ConstPointer node, QString& errorMessage) const
+{
+  const mitk::Image* image = dynamic_cast<const mitk::Image*>(node->GetData());
+
+  QString intermediateError;
+  QString intermediateErrors;
+
+  QTemporaryFile *returnedFile = nullptr;
+  QString name = GetValidNodeName(QString::fromStdString(node->GetName()));
+
+  // Try each extension until we get a good one.
+  foreach (QString extension, fileExtensions)
+  {
+    // File extensions may or may not include the leading dot, so add one if necessary.
+    if (!extension.startsWith("."))
+    {
+      extension.prepend(".");
+    }
+    QString fileNameTemplate = name + "_XXXXXX" + extension;
+
+    try
+    {
+      QTemporaryFile *tempFile = new QTemporaryFile(QDir::tempPath() + QDir::separator() + fileNameTemplate);
+      if (tempFile->open())
+      {
+        tempFile->close();
+        try
+        {
+          mitk::IOUtil::Save( image, tempFile->fileName().toStdString() );
+          returnedFile = tempFile;
+          break;
+        }
+        catch(const mitk::Exception &)
+        {
+          intermediateError = QObject::tr("Tried %1, failed to save image:\n%2\n").arg(extension).arg(tempFile->fileName());
+        }
+      }
+      else
+      {
+        intermediateError = QObject::tr("Tried %1, failed to open file:\n%2\n").arg(extension).arg(tempFile->fileName());
+      }
+      delete tempFile;
+    }
+    catch(const mitk::Exception &e)
+    {
+      intermediateError = QObject::tr("Tried %1, caught MITK Exception:\nDescription: %2\nFilename: %3\nLine: %4\n")
+                          .arg(extension).arg(e.GetDescription()).arg(e.GetFile()).arg(e.GetLine());
+    }
+    catch(const std::exception& e)
+    {
+      intermediateError = QObject::tr("Tried %1, caught exception:\nDescription: %2\n")
+                          .arg(extension).arg(e.what());
+    }
+    intermediateErrors += intermediateError;
+  }
+  errorMessage = intermediateErrors;
+  return returnedFile;
+}
@@ -0,0 +1,91 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) University College London (UCL).
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef QMITKCMDLINEMODULEINPUTCACHE_H
+#define QMITKCMDLINEMODULEINPUTCACHE_H
+
+#include <QMap>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+
+#include <ctkCmdLineModuleParameter.h>
+#include <mitkDataNode.h>
+
+class QTemporaryFile;
+
+/**
+ * \class QmitkCmdLineModuleInputCache
+ * \brief Saves the input images of command line modules to temporary files, and hands out
+ * the same file to every job that uses the same image in the same file format.
+ *
+ * A batch of jobs shares one cache, so each input image is written once per batch rather than
+ * once per job. A file is written again if the image was modified in the meantime. The files
+ * are removed when the cache and all jobs still using them are deleted.
+ *
+ * \ingroup org_mitk_gui_qt_cmdlinemodules_internal
+ * \sa QmitkCmdLineModuleRunner
+ */
+class QmitkCmdLineModuleInputCache
+{
+
+public:
+
+  QmitkCmdLineModuleInputCache();
+  virtual ~QmitkCmdLineModuleInputCache();
+
+  /**
+   * \brief Returns a temporary file containing the image of node, saving it if necessary.
+   * \param[in] parameter the image parameter, which provides the accepted file extensions.
+   * \param[in] node non-nullptr pointer to node containing a non-nullptr mitk::Image.
+   * \param[out] errorMessage which if not empty means an error occurred.
+   * \return the shared temporary file, or a null pointer if saving failed.
+   *
+   * If the returned file is not null, there could still be data in the errorMessage,
+   * as the image may have been saved successfully only after trying several file extensions.
+   */
+  QSharedPointer<QTemporaryFile> GetTemporaryImage(const ctkCmdLineModuleParameter& parameter, mitk::DataNode::ConstPointer node, QString& errorMessage);
+
+  /**
+   * \brief Takes nodeName, and makes sure that it only contains A-Z, a-z, 0-9, hyphen and underscore,
+   * and does not use hyphen as the first character.
+   *
+   * Inspired by <a href="http://www.boost.org/doc/libs/1_43_0/libs/filesystem/doc/portability_guide.htm">boost recommendations</a>.
+   */
+  static QString GetValidNodeName(const QString& nodeName);
+
+private:
+
+  struct CachedFile
+  {
+    mitk::DataNode::ConstPointer Node; // keeps the address used as key valid
+    mitk::BaseData::ConstPointer Image;
+    unsigned long ImageMTime;
+    QSharedPointer<QTemporaryFile> File;
+  };
+
+  /**
+   * \brief Saves the image to a new temporary file, trying each of the given extensions.
+   */
+  QTemporaryFile* SaveTemporaryImage(const QStringList& fileExtensions, mitk::DataNode::ConstPointer node, QString& errorMessage) const;
+
+  /**
+   * \brief Files by node and accepted file extensions.
+   */
+  QMap<QPair<const mitk::DataNode*, QString>, CachedFile> m_Files;
+
+};
+
+#endif // QMITKCMDLINEMODULEINPUTCACHE_H
@@ -26,8 +26,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <QTextBrowser>
 #include <QByteArray>
 #include <QApplication>
-#include <QRegExp>
 #include <QStyle>
+#include <QTemporaryFile>
 
 // CTK
 #include <ctkCmdLineModuleFuture.h>
@@ -44,6 +44,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkFileReaderSelector.h>
 #include <QmitkCustomVariants.h>
 #include "QmitkCmdLineModuleGui.h"
+#include "QmitkCmdLineModuleInputCache.h"
 
 
 //-----------------------------------------------------------------------------
@@ -137,40 +138,6 @@ QString QmitkCmdLineModuleRunner::GetFullName() const
 }
 
 
-//-----------------------------------------------------------------------------
-QString QmitkCmdLineModuleRunner::GetValidNodeName(const QString& nodeName) const
-{
-  QString outputName = nodeName;
-
-  // We will allow A-Z, a-z, 0-9, period, hyphen and underscore in the output file name.
-  // This method is parsing a node name, and other bits of code add on a file extension .nii.
-  // So, in the output string from this function, we should not allow period, so that
-  // the second recommendation on this page:
-  // http://www.boost.org/doc/libs/1_43_0/libs/filesystem/doc/portability_guide.htm
-  // is still true.
-
-  QRegExp rx("[A-Z|a-z|0-9|-|_]{1,1}");
-
-  QString singleLetter;
-
-  for (int i = 0; i < outputName.size(); i++)
-  {
-    if (i == 0 && outputName[i] == '-')
-    {
-      outputName[i] = '_';
-    }
-
-    singleLetter = outputName[i];
-
-    if (!rx.exactMatch(singleLetter))
-    {
-      outputName[i] = '-';
-    }
-  }
-  return outputName;
-}
-
-
 //-----------------------------------------------------------------------------
 bool QmitkCmdLineModuleRunner::IsStarted() const
 {
@@ -375,18 +342,18 @@ void QmitkCmdLineModuleRunner::ClearUpTemporaryFiles()
   QString message;
   QString fileName;
 
-  foreach (QTemporaryFile* file, m_TemporaryFiles)
+  foreach (QSharedPointer<QTemporaryFile> file, m_TemporaryFiles)
   {
-    assert(file != nullptr);
+    assert(!file.isNull());
 
     fileName = file->fileName();
-    message = QObject::tr("removing %1").arg(fileName);
+    message = QObject::tr("releasing %1").arg(fileName);
     this->PublishMessage(message);
-
-    delete file;
   }
 
+  // The last job holding a file removes it.
   m_TemporaryFiles.clear();
+  m_InputCache.clear();
 }
 
 
@@ -395,6 +362,9 @@ void QmitkCmdLineModuleRunner::LoadOutputData()
 {
   assert(m_DataStorage);
 
+  std::vector<std::string> fileNames;
+  QStringList loadedFileNames;
+
   QString fileName;
   foreach (fileName, m_OutputDataToLoad)
   {
@@ -407,8 +377,9 @@ void QmitkCmdLineModuleRunner::LoadOutputData()
       std::vector<mitk::FileReaderSelector::Item> readers = info.m_ReaderSelector.Get();
       if (readers.size() > 0)
       {
-        mitk::IOUtil::Load(fileName.toStdString(), *(m_DataStorage));
-        message = QObject::tr("Loaded %1").arg(fileName);
+        fileNames.push_back(fileName.toStdString());
+        loadedFileNames.push_back(fileName);
+        continue;
       }
       else
       {
@@ -423,6 +394,26 @@ void QmitkCmdLineModuleRunner::LoadOutputData()
 
     this->PublishMessage(message);
   }
+
+  if (fileNames.empty())
+  {
+    return;
+  }
+
+  // Outputs of a module are typically several images, read them in parallel.
+  QString message;
+  try
+  {
+    mitk::IOUtil::LoadConcurrently(fileNames, *(m_DataStorage));
+    message = QObject::tr("Loaded %1").arg(loadedFileNames.join(", "));
+  }
+  catch (const mitk::Exception& e)
+  {
+    message = QObject::tr("Failed to load %1, due to %2\n").arg(loadedFileNames.join(", ")).arg(e.what());
+    MITK_ERROR << message.toStdString();
+  }
+
+  this->PublishMessage(message);
 }
 
 
@@ -450,7 +441,14 @@ void QmitkCmdLineModuleRunner::SetFrontend(QmitkCmdLineModuleGui* frontEnd)
 
 
 //-----------------------------------------------------------------------------
-void QmitkCmdLineModuleRunner::Run()
+void QmitkCmdLineModuleRunner::SetInputCache(QSharedPointer<QmitkCmdLineModuleInputCache> inputCache)
+{
+  this->m_InputCache = inputCache;
+}
+
+
+//-----------------------------------------------------------------------------
+bool QmitkCmdLineModuleRunner::Run()
 {
   assert(m_ModuleManager);
   assert(m_DataStorage);
@@ -528,6 +526,11 @@ void QmitkCmdLineModuleRunner::Run()
   message = "Saving image data to temporary storage...";
   this->PublishMessage(message);
 
+  if (m_InputCache.isNull())
+  {
+    m_InputCache = QSharedPointer<QmitkCmdLineModuleInputCache>(new QmitkCmdLineModuleInputCache());
+  }
+
   parameters = m_ModuleFrontEnd->parameters("image", ctkCmdLineModuleFrontend::Input);
   foreach (ctkCmdLineModuleParameter parameter, parameters)
   {
@@ -542,18 +545,18 @@ void QmitkCmdLineModuleRunner::Run()
       if (image != nullptr)
       {
         QString errorMessage;
-        QTemporaryFile* tempFile = this->SaveTemporaryImage(parameter, node.GetPointer(), errorMessage);
+        QSharedPointer<QTemporaryFile> tempFile = m_InputCache->GetTemporaryImage(parameter, node.GetPointer(), errorMessage);
 
-        if(tempFile == nullptr)
+        if(tempFile.isNull())
         {
           QMessageBox::warning(this, "Saving temporary file failed", errorMessage);
-          return;
+          return false;
         }
 
         m_TemporaryFiles.push_back(tempFile);
         m_ModuleFrontEnd->setValue(parameterName, tempFile->fileName());
 
-        message = "Saved " + tempFile->fileName();
+        message = "Using " + tempFile->fileName();
         this->PublishMessage(message);
 
       } // end if image
@@ -594,75 +597,7 @@ void QmitkCmdLineModuleRunner::Run()
 
   // Give some immediate indication that we are running.
   m_UI->m_ProgressTitle->setText(description.title() + ": running");
-}
-
-
-//-----------------------------------------------------------------------------
-QTemporaryFile* QmitkCmdLineModuleRunner::SaveTemporaryImage(const ctkCmdLineModuleParameter &parameter, mitk::DataNode::ConstPointer node, QString& errorMessage) const
-{
-  // Don't call this if node is null or node is not an image.
-  assert(node.GetPointer());
-  mitk::Image* image = dynamic_cast<mitk::Image*>(node->GetData());
-  assert(image);
-
-  QString intermediateError;
-  QString intermediateErrors;
 
-  QTemporaryFile *returnedFile = nullptr;
-  QString name = this->GetValidNodeName(QString::fromStdString(node->GetName()));
-  QString fileNameTemplate = name + "_XXXXXX";
-
-  // If no file extensions are specified, we default to .nii
-  QStringList fileExts = parameter.fileExtensions();
-  if (fileExts.isEmpty())
-  {
-    fileExts.push_back(".nii");
-  }
-
-  // Try each extension until we get a good one.
-  foreach (QString extension, fileExts)
-  {
-    // File extensions may or may not include the leading dot, so add one if necessary.
-    if (!extension.startsWith("."))
-    {
-      extension.prepend(".");
-    }
-    fileNameTemplate = fileNameTemplate + extension;
-
-    try
-    {
-      QTemporaryFile *tempFile = new QTemporaryFile(QDir::tempPath() + QDir::separator() + fileNameTemplate);
-      if (tempFile->open())
-      {
-        tempFile->close();
-        try
-        {
-          mitk::IOUtil::Save( image, tempFile->fileName().toStdString() );
-          returnedFile = tempFile;
-          break;
-        }
-        catch(const mitk::Exception &)
-        {
-          intermediateError = QObject::tr("Tried %1, failed to save image:\n%2\n").arg(extension).arg(tempFile->fileName());
-        }
-      }
-      else
-      {
-        intermediateError = QObject::tr("Tried %1, failed to open file:\n%2\n").arg(extension).arg(tempFile->fileName());
-      }
-    }
-    catch(const mitk::Exception &e)
-    {
-      intermediateError = QObject::tr("Tried %1, caught MITK Exception:\nDescription: %2\nFilename: %3\nLine: %4\n")
-                          .arg(extension).arg(e.GetDescription()).arg(e.GetFile()).arg(e.GetLine());
-    }
-    catch(const std::exception& e)
-    {
-      intermediateError = QObject::tr("Tried %1, caught exception:\nDescription: %2\n")
-                          .arg(extension).arg(e.what());
-    }
-    intermediateErrors += intermediateError;
-  }
-  errorMessage = intermediateErrors;
-  return returnedFile;
+  return true;
 }
+
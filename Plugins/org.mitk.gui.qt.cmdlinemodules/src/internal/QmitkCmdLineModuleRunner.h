@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <QWidget>
 #include <QTimer>
 #include <QList>
+#include <QSharedPointer>
 
 #include <ctkCmdLineModuleParameter.h>
 #include <mitkDataNode.h>
@@ -26,6 +27,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 class QVBoxLayout;
 class QTemporaryFile;
 class QmitkCmdLineModuleGui;
+class QmitkCmdLineModuleInputCache;
 class ctkCmdLineModuleManager;
 class ctkCmdLineModuleFutureWatcher;
 
@@ -78,10 +80,17 @@ public:
    */
   void SetFrontend(QmitkCmdLineModuleGui* frontEnd);
 
+  /**
+   * \brief Sets the cache used to write the input images, so that jobs of the same batch share
+   * their temporary input files. If not set, this widget writes its own files.
+   */
+  void SetInputCache(QSharedPointer<QmitkCmdLineModuleInputCache> inputCache);
+
   /**
    * \brief Runs the module that this widget is currently referring to.
+   * \return false if the module could not be started, in which case started() and finished() are not emitted.
    */
-  void Run();
+  bool Run();
 
 Q_SIGNALS:
 
@@ -126,28 +135,15 @@ private:
   void PublishByteArray(const QByteArray& array);
 
   /**
-   * \brief Destroys any images listed in m_TemporaryFileNames.
+   * \brief Releases the temporary files listed in m_TemporaryFiles, they are removed once no other job uses them.
    */
   void ClearUpTemporaryFiles();
 
   /**
-   * \brief Loads any data listed in m_OutputDataToLoad into the m_DataStorage.
+   * \brief Loads any data listed in m_OutputDataToLoad into the m_DataStorage, reading the files in parallel.
    */
   void LoadOutputData();
 
-  /**
-   * \brief Saves temporary image to file.
-   * \param[in] node non-nullptr pointer to node containing a non-nullptr mitk::Image.
-   * \param[out] errorMessage which if not empty means an error occurred.
-   * \return QTemporaryFile temporary file that the caller is responsible for deleting.
-   *
-   * If the returned QTemporaryFile is nullptr, check errorMessage.
-   * If the returned QTemporaryFile is not-nullptr, there could still be data in the errorMessage.
-   * It could be that this method tried n file extensions, before finding a successful one.
-   * In this case, the returned QTemporaryFile is the successful one, and the errorMessage contains error messages of all the failed attempts.
-   */
-  QTemporaryFile* SaveTemporaryImage(const ctkCmdLineModuleParameter& parameter, mitk::DataNode::ConstPointer node, QString& errorMessage) const;
-
   /**
    * \brief Utility method to look up the title from the description.
    */
@@ -159,14 +155,6 @@ private:
    */
   QString GetFullName() const;
 
-  /**
-   * \brief Takes nodeName, and makes sure that it only contains A-Z, a-z, 0-9, hyphen and underscore,
-   * and does not use hyphen as the first character.
-   *
-   * Inspired by <a href="http://www.boost.org/doc/libs/1_43_0/libs/filesystem/doc/portability_guide.htm">boost recommendations</a>.
-   */
-  QString GetValidNodeName(const QString& nodeName) const;
-
   /**
    * \brief This must be injected before the Widget is used.
    */
@@ -213,7 +201,12 @@ private:
    * launching a command line app, and then must be cleared up when the command line
    * app successfully finishes.
    */
-  QList<QTemporaryFile*> m_TemporaryFiles;
+  QList<QSharedPointer<QTemporaryFile> > m_TemporaryFiles;
+
+  /**
+   * \brief Writes the input images, shared with the other jobs of a batch.
+   */
+  QSharedPointer<QmitkCmdLineModuleInputCache> m_InputCache;
 
   /**
    * \brief We store a list of output images, so that on successful completion of
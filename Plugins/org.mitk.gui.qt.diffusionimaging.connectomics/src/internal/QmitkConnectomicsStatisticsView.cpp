@@ -153,10 +153,14 @@ void QmitkConnectomicsStatisticsView::UpdateGui()
 
     std::stringstream statisticsStream;
 
-    mitk::ConnectomicsStatisticsCalculator::Pointer calculator = mitk::ConnectomicsStatisticsCalculator::New();
-
-    calculator->SetNetwork( network );
-    calculator->Update();
+    // statistics and histograms are cached until the network is modified
+    mitk::ConnectomicsNetwork::Pointer connectomicsNetwork( network );
+    mitk::ConnectomicsHistogramsContainer *histogramContainer = histogramCache[ connectomicsNetwork ];
+    if( histogramContainer == nullptr || histogramContainer->GetStatisticsCalculator() == nullptr )
+    {
+      return;
+    }
+    mitk::ConnectomicsStatisticsCalculator* calculator = histogramContainer->GetStatisticsCalculator();
 
     statisticsStream << "# Vertices: " << calculator->GetNumberOfVertices() << "\n";
     statisticsStream << "# Edges: " << calculator->GetNumberOfEdges() << "\n";
@@ -181,8 +185,6 @@ void QmitkConnectomicsStatisticsView::UpdateGui()
     QString statisticsString( statisticsStream.str().c_str() );
     m_Controls-> networkStatisticsPlainTextEdit-> setPlainText( statisticsString );
 
-    mitk::ConnectomicsNetwork::Pointer connectomicsNetwork( network );
-    mitk::ConnectomicsHistogramsContainer *histogramContainer = histogramCache[ connectomicsNetwork ];
     if(histogramContainer)
     {
       m_Controls->betweennessNetworkHistogramCanvas->SetHistogram(  histogramContainer->GetBetweennessHistogram() );
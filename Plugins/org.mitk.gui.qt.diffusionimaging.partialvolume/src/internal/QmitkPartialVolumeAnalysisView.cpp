@@ -131,6 +131,9 @@ QmitkPartialVolumeAnalysisView::QmitkPartialVolumeAnalysisView(QObject * /*paren
       m_TexIsOn(true),
       m_Visible(false)
 {
+    m_Clusterer = ClusteringType::New();
+    m_Clusterer->SetStepsNumIntegration(200);
+    m_Clusterer->SetMaxIt(1000);
 
 }
 
@@ -964,7 +967,7 @@ void QmitkPartialVolumeAnalysisView::ShowClusteringResults()
     }
 
     mitk::Image::Pointer clusteredImage;
-    ClusteringType::Pointer clusterer = ClusteringType::New();
+    ClusteringType::Pointer clusterer = m_Clusterer;
 
     if(m_QuantifyClass==3)
     {
@@ -1432,9 +1435,7 @@ void QmitkPartialVolumeAnalysisView::UpdateStatistics()
 
                 if(histogram != nullptr)
                 {
-                    ClusteringType::Pointer clusterer = ClusteringType::New();
-                    clusterer->SetStepsNumIntegration(200);
-                    clusterer->SetMaxIt(1000);
+                    ClusteringType::Pointer clusterer = m_Clusterer;
 
                     mitk::Image::Pointer pFiberImg;
                     if(m_QuantifyClass==3)
@@ -258,6 +258,9 @@ protected:
   ClusteringType::HelperStructPerformRGBClusteringRetval* m_CurrentRGBClusteringResults;
   ClusteringType::HelperStructPerformClusteringRetval *m_CurrentPerformClusteringResults;
 
+  /** kept across updates, so that the mixture fit of an unchanged histogram is reused */
+  ClusteringType::Pointer m_Clusterer;
+
   QIcon* m_IconTexOFF;
   QIcon* m_IconTexON;
   bool m_TexIsOn;
@@ -9,6 +9,7 @@ set(INTERNAL_CPP_FILES
   QmitkNavigationDataPlayerView.cpp
   QmitkIGTFiducialRegistration.cpp
   QmitkIGTNavigationToolCalibration.cpp
+  QmitkIGTLatencyView.cpp
 )
 
 set(UI_FILES
@@ -17,6 +18,7 @@ set(UI_FILES
   src/internal/QmitkNavigationDataPlayerViewControls.ui
   src/internal/QmitkIGTNavigationToolCalibrationControls.ui
   src/internal/QmitkIGTFiducialRegistrationControls.ui
+  src/internal/QmitkIGTLatencyViewControls.ui
 )
 
 set(MOC_H_FILES
@@ -27,6 +29,7 @@ set(MOC_H_FILES
   src/internal/QmitkNavigationDataPlayerView.h
   src/internal/QmitkIGTNavigationToolCalibration.h
   src/internal/QmitkIGTFiducialRegistration.h
+  src/internal/QmitkIGTLatencyView.h
 )
 
 # list of resource files which can be used by the plug-in
@@ -0,0 +1,157 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+// Qmitk
+#include "QmitkIGTLatencyView.h"
+
+// QT
+#include <QTimer>
+
+//mitk
+#include <mitkNavigationDataLatencyMonitor.h>
+#include <mitkRenderingManager.h>
+
+// VTK
+#include <vtkCallbackCommand.h>
+#include <vtkRenderWindow.h>
+#include <vtkSmartPointer.h>
+
+const std::string QmitkIGTLatencyView::VIEW_ID = "org.mitk.views.igtlatency";
+
+QmitkIGTLatencyView::QmitkIGTLatencyView()
+  : m_Controls( 0 ), m_UpdateTimer( 0 )
+{
+}
+
+QmitkIGTLatencyView::~QmitkIGTLatencyView()
+{
+  this->RemoveRenderWindowObservers();
+  mitk::NavigationDataLatencyMonitor::GetInstance()->SetEnabled(false);
+  delete m_Controls;
+}
+
+void QmitkIGTLatencyView::CreateQtPartControl( QWidget *parent )
+{
+  // build up qt view, unless already done
+  if ( !m_Controls )
+  {
+    // create GUI widgets from the Qt Designer's .ui file
+    m_Controls = new Ui::QmitkIGTLatencyViewControls;
+    m_Controls->setupUi( parent );
+
+    m_UpdateTimer = new QTimer( parent );
+    m_UpdateTimer->setInterval( 500 );
+
+    connect( m_Controls->m_ChkEnable, SIGNAL(toggled(bool)), this, SLOT(OnEnableMonitoring(bool)) );
+    connect( m_Controls->m_BtnReset, SIGNAL(clicked()), this, SLOT(OnReset()) );
+    connect( m_UpdateTimer, SIGNAL(timeout()), this, SLOT(OnUpdateTable()) );
+
+    m_Controls->m_ChkEnable->setChecked(mitk::NavigationDataLatencyMonitor::GetInstance()->GetEnabled());
+  }
+}
+
+void QmitkIGTLatencyView::SetFocus()
+{
+  if ( m_Controls )
+  {
+    m_Controls->m_ChkEnable->setFocus();
+  }
+}
+
+void QmitkIGTLatencyView::OnEnableMonitoring(bool enabled)
+{
+  mitk::NavigationDataLatencyMonitor::GetInstance()->SetEnabled(enabled);
+
+  if (enabled)
+  {
+    this->AddRenderWindowObservers();
+    m_UpdateTimer->start();
+  }
+  else
+  {
+    this->RemoveRenderWindowObservers();
+    m_UpdateTimer->stop();
+  }
+  this->OnUpdateTable();
+}
+
+void QmitkIGTLatencyView::OnReset()
+{
+  mitk::NavigationDataLatencyMonitor::GetInstance()->Reset();
+  this->OnUpdateTable();
+}
+
+void QmitkIGTLatencyView::OnUpdateTable()
+{
+  // render windows may have been opened after monitoring was enabled
+  if (mitk::NavigationDataLatencyMonitor::GetInstance()->GetEnabled())
+  {
+    this->AddRenderWindowObservers();
+  }
+
+  const std::vector<mitk::NavigationDataLatencyMonitor::LatencyStatistics> statistics =
+    mitk::NavigationDataLatencyMonitor::GetInstance()->GetStatistics();
+
+  QTableWidget* table = m_Controls->m_TableStatistics;
+  table->setRowCount(static_cast<int>(statistics.size()));
+  for (std::size_t row = 0; row < statistics.size(); ++row)
+  {
+    const mitk::NavigationDataLatencyMonitor::LatencyStatistics& stage = statistics[row];
+    const double values[6] = { stage.m_Mean, stage.m_Median, stage.m_Percentile95, stage.m_Percentile99, stage.m_Minimum, stage.m_Maximum };
+
+    table->setItem(static_cast<int>(row), 0, new QTableWidgetItem(QString::fromStdString(stage.m_Stage)));
+    table->setItem(static_cast<int>(row), 1, new QTableWidgetItem(QString::number(stage.m_NumberOfSamples)));
+    for (int column = 0; column < 6; ++column)
+    {
+      table->setItem(static_cast<int>(row), column + 2, new QTableWidgetItem(QString::number(values[column], 'f', 2)));
+    }
+  }
+}
+
+void QmitkIGTLatencyView::AddRenderWindowObservers()
+{
+  const mitk::RenderingManager::RenderWindowVector& renderWindows = mitk::RenderingManager::GetInstance()->GetAllRegisteredRenderWindows();
+  for (vtkRenderWindow* renderWindow : renderWindows)
+  {
+    if (m_RenderWindowObservers.find(renderWindow) != m_RenderWindowObservers.end())
+      continue;
+
+    vtkSmartPointer<vtkCallbackCommand> command = vtkSmartPointer<vtkCallbackCommand>::New();
+    command->SetCallback(QmitkIGTLatencyView::RenderingEndCallback);
+    m_RenderWindowObservers[renderWindow] = renderWindow->AddObserver(vtkCommand::EndEvent, command);
+  }
+}
+
+void QmitkIGTLatencyView::RemoveRenderWindowObservers()
+{
+  // only remove observers of render windows that are still registered
+  const mitk::RenderingManager::RenderWindowVector& renderWindows = mitk::RenderingManager::GetInstance()->GetAllRegisteredRenderWindows();
+  for (vtkRenderWindow* renderWindow : renderWindows)
+  {
+    auto it = m_RenderWindowObservers.find(renderWindow);
+    if (it != m_RenderWindowObservers.end())
+    {
+      renderWindow->RemoveObserver(it->second);
+    }
+  }
+  m_RenderWindowObservers.clear();
+}
+
+void QmitkIGTLatencyView::RenderingEndCallback(vtkObject*, unsigned long, void*, void*)
+{
+  mitk::NavigationDataLatencyMonitor::GetInstance()->RecordRendering();
+}
@@ -0,0 +1,87 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#ifndef QmitkIGTLatencyView_h
+#define QmitkIGTLatencyView_h
+
+//Qmitk
+#include <QmitkAbstractView.h>
+
+// ui
+#include "ui_QmitkIGTLatencyViewControls.h"
+
+#include <map>
+
+class QTimer;
+class vtkObject;
+class vtkRenderWindow;
+
+/*!
+\brief QmitkIGTLatencyView shows the latency statistics of all navigation pipelines.
+
+While monitoring is enabled the mitk::NavigationDataLatencyMonitor records the age of the tracking data at every
+navigation data source and filter and, after every render pass of a registered render window, the age of the
+newest sample ("Render"). The table is refreshed periodically to check a latency budget during tracking.
+*/
+class QmitkIGTLatencyView : public QmitkAbstractView
+{
+  // this is needed for all Qt objects that should have a Qt meta-object
+  // (everything that derives from QObject and wants to have signal/slots)
+  Q_OBJECT
+
+public:
+
+  static const std::string VIEW_ID;
+
+  QmitkIGTLatencyView();
+  virtual ~QmitkIGTLatencyView();
+
+  virtual void CreateQtPartControl(QWidget *parent) override;
+  void SetFocus() override;
+
+protected slots:
+
+  /*!
+  \brief Enables or disables the monitor and the render window observers
+  */
+  void OnEnableMonitoring(bool enabled);
+
+  /*!
+  \brief Clears all statistics
+  */
+  void OnReset();
+
+  /*!
+  \brief Fills the table with the current statistics
+  */
+  void OnUpdateTable();
+
+protected:
+
+  void AddRenderWindowObservers();
+  void RemoveRenderWindowObservers();
+
+  static void RenderingEndCallback(vtkObject *caller, unsigned long eventId, void *clientData, void *callData);
+
+  Ui::QmitkIGTLatencyViewControls* m_Controls;
+  QTimer* m_UpdateTimer;
+
+  /** observer tags of the render windows */
+  std::map<vtkRenderWindow*, unsigned long> m_RenderWindowObservers;
+};
+
+#endif // QmitkIGTLatencyView_h
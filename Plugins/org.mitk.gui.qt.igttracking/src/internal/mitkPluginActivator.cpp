@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "QmitkNavigationDataPlayerView.h"
 #include "QmitkIGTNavigationToolCalibration.h"
 #include "QmitkIGTFiducialRegistration.h"
+#include "QmitkIGTLatencyView.h"
 
 //#include <mitkPersistenceService.h> //Workaround for bug in persistence module (see bug 16643 for details)
                                     //CAN BE REMOVED WHEN THE BUG IS FIXED
@@ -39,6 +40,7 @@ void PluginActivator::start(ctkPluginContext* context)
   BERRY_REGISTER_EXTENSION_CLASS(QmitkNavigationDataPlayerView , context)
   BERRY_REGISTER_EXTENSION_CLASS(QmitkIGTNavigationToolCalibration , context)
   BERRY_REGISTER_EXTENSION_CLASS(QmitkIGTFiducialRegistration, context)
+  BERRY_REGISTER_EXTENSION_CLASS(QmitkIGTLatencyView, context)
 
 
 }
@@ -210,40 +210,44 @@ void PASimulator::DoImageProcessing()
 
   auto tissueParameters = GetParametersFromUIInput();
 
-  for (int volumeIndex = 0; volumeIndex < numberOfVolumes; volumeIndex++)
+  if (m_Controls.checkBoxGenerateBatch->isChecked())
   {
-    mitk::pa::InSilicoTissueVolume::Pointer volume =
-      mitk::pa::InSilicoTissueGenerator::GenerateInSilicoData(tissueParameters);
-
-    mitk::Image::Pointer tissueVolume = volume->ConvertToMitkImage();
-
-    if (m_Controls.checkBoxGenerateBatch->isChecked())
+    std::string nrrdFilePath = m_Controls.label_NrrdFilePath->text().toStdString();
+    std::string tissueName = m_Controls.lineEditTissueName->text().toStdString();
+    std::string binaryPath = m_Controls.labelBinarypath->text().toStdString();
+    long numberOfPhotons = m_Controls.spinboxNumberPhotons->value() * 1000L;
+
+    auto batchParameters = mitk::pa::SimulationBatchGeneratorParameters::New();
+    batchParameters->SetBinaryPath(binaryPath);
+    batchParameters->SetNrrdFilePath(nrrdFilePath);
+    batchParameters->SetNumberOfPhotons(numberOfPhotons);
+    batchParameters->SetTissueName(tissueName);
+    batchParameters->SetVolumeIndex(0);
+    batchParameters->SetYOffsetLowerThresholdInCentimeters(m_Controls.spinboxFromValue->value());
+    batchParameters->SetYOffsetUpperThresholdInCentimeters(m_Controls.spinboxToValue->value());
+    batchParameters->SetYOffsetStepInCentimeters(m_Controls.spinboxStepValue->value());
+
+    try
     {
-      std::string nrrdFilePath = m_Controls.label_NrrdFilePath->text().toStdString();
-      std::string tissueName = m_Controls.lineEditTissueName->text().toStdString();
-      std::string binaryPath = m_Controls.labelBinarypath->text().toStdString();
-      long numberOfPhotons = m_Controls.spinboxNumberPhotons->value() * 1000L;
-
-      auto batchParameters = mitk::pa::SimulationBatchGeneratorParameters::New();
-      batchParameters->SetBinaryPath(binaryPath);
-      batchParameters->SetNrrdFilePath(nrrdFilePath);
-      batchParameters->SetNumberOfPhotons(numberOfPhotons);
-      batchParameters->SetTissueName(tissueName);
-      batchParameters->SetVolumeIndex(volumeIndex);
-      batchParameters->SetYOffsetLowerThresholdInCentimeters(m_Controls.spinboxFromValue->value());
-      batchParameters->SetYOffsetUpperThresholdInCentimeters(m_Controls.spinboxToValue->value());
-      batchParameters->SetYOffsetStepInCentimeters(m_Controls.spinboxStepValue->value());
-      mitk::pa::SimulationBatchGenerator::WriteBatchFileAndSaveTissueVolume(batchParameters, tissueVolume);
+      mitk::pa::SimulationBatchGenerator::GenerateBatch(tissueParameters, batchParameters, numberOfVolumes);
     }
-    else
+    catch (const mitk::Exception& e)
     {
-      mitk::DataNode::Pointer dataNode = mitk::DataNode::New();
-      dataNode->SetData(tissueVolume);
-      dataNode->SetName(m_Controls.lineEditTissueName->text().toStdString());
-      this->GetDataStorage()->Add(dataNode);
-      mitk::RenderingManager::GetInstance()->InitializeViewsByBoundingObjects(this->GetDataStorage());
+      QMessageBox::warning(nullptr, QString("Warning"), QString::fromStdString(e.GetDescription()));
     }
+    return;
   }
+
+  mitk::pa::InSilicoTissueVolume::Pointer volume =
+    mitk::pa::InSilicoTissueGenerator::GenerateInSilicoData(tissueParameters);
+
+  mitk::Image::Pointer tissueVolume = volume->ConvertToMitkImage();
+
+  mitk::DataNode::Pointer dataNode = mitk::DataNode::New();
+  dataNode->SetData(tissueVolume);
+  dataNode->SetName(m_Controls.lineEditTissueName->text().toStdString());
+  this->GetDataStorage()->Add(dataNode);
+  mitk::RenderingManager::GetInstance()->InitializeViewsByBoundingObjects(this->GetDataStorage());
 }
 
 void PASimulator::ClickedGaussBox()
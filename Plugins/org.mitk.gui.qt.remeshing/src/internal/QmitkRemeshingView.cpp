@@ -112,7 +112,11 @@ void QmitkRemeshingView::OnRemeshButtonClicked()
 
   bool boundaryFixing = m_Controls.preserveEdgesCheckBox->isChecked();
 
-  mitk::ACVD::RemeshFilter::Pointer remesher = mitk::ACVD::RemeshFilter::New();
+  // The filter is kept, so that remeshing the same surface again reuses its prepared input
+  if (m_Remesher.IsNull())
+    m_Remesher = mitk::ACVD::RemeshFilter::New();
+
+  mitk::ACVD::RemeshFilter::Pointer remesher = m_Remesher;
   remesher->SetInput(surface);
   remesher->SetTimeStep(0);
   remesher->SetNumVertices(numVertices);
@@ -134,6 +138,7 @@ void QmitkRemeshingView::OnRemeshButtonClicked()
   }
 
   mitk::Surface::Pointer remeshedSurface = remesher->GetOutput();
+  remeshedSurface->DisconnectPipeline();
 
   mitk::DataNode::Pointer newNode = mitk::DataNode::New();
   newNode->SetName(QString("%1 (%2%)").arg(selectedNode->GetName().c_str()).arg(density).toStdString());
@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define QmitkRemeshingView_h
 
 #include <QmitkAbstractView.h>
+#include <mitkACVD.h>
 #include <ui_QmitkRemeshingViewControls.h>
 
 class QmitkRemeshingView : public QmitkAbstractView
@@ -41,6 +42,7 @@ private:
 
   Ui::QmitkRemeshingViewControls m_Controls;
   int m_MaxNumberOfVertices;
+  mitk::ACVD::RemeshFilter::Pointer m_Remesher;
 };
 
 #endif
@@ -23,6 +23,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkIDataStorageService.h>
 #include <mitkIOUtil.h>
 #include <mitkNodePredicateProperty.h>
+#include <mitkXnatTransferManager.h>
 
 #include <ctkXnatDefaultSchemaTypes.h>
 #include <ctkXnatFile.h>
@@ -32,6 +33,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <ctkXnatSession.h>
 
 #include <QDir>
+#include <QFileInfo>
 #include <QMessageBox>
 #include <QString>
 
@@ -168,12 +170,23 @@ void QmitkUploadToXNATAction::Run( const QList<mitk::DataNode::Pointer> &selecte
     ctkXnatObject* uploadDestination = dialog.GetUploadDestination();
     if (uploadDestination != nullptr)
     {
-      ctkXnatFile* file = new ctkXnatFile(uploadDestination);
-      file->setLocalFilePath(fileName);
-      QFileInfo fileInfo (fileName);
-      file->setName(fileInfo.fileName());
-      file->save();
+      // retried on network errors, the temporary file is streamed instead of being read into memory
+      mitk::XnatTransferManager transferManager(session);
+      QString errorMessage;
+      QObject::connect(&transferManager, &mitk::XnatTransferManager::Failed,
+                       [&errorMessage](QUuid, const QString& message) { errorMessage = message; });
+      transferManager.Upload(fileName, uploadDestination->resourceUri() + "/files/" + QFileInfo(fileName).fileName());
+      transferManager.WaitForFinished();
+
+      if (!errorMessage.isEmpty())
+      {
+        QMessageBox msgbox;
+        msgbox.setText("Upload failed!\n" + errorMessage);
+        msgbox.setIcon(QMessageBox::Critical);
+        msgbox.exec();
+      }
     }
+    QFile::remove(fileName);
   }
   dataStorageServiceTracker.close();
 }
@@ -55,6 +55,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <QDialog>
 #include <QDir>
 #include <QDirIterator>
+#include <QFile>
 #include <QFileDialog>
 #include <QInputDialog>
 #include <QMenu>
@@ -98,6 +99,7 @@ QmitkXnatTreeBrowserView::QmitkXnatTreeBrowserView() :
   m_TreeModel(new QmitkXnatTreeModel()),
   m_Tracker(0),
   m_DownloadPath(berry::Platform::GetPreferencesService()->GetSystemPreferences()->Node(VIEW_ID)->Get("Download Path", "")),
+  m_TransferManager(nullptr),
   m_SilentMode(false)
 {
   m_DataStorageServiceTracker.open();
@@ -116,6 +118,7 @@ QmitkXnatTreeBrowserView::QmitkXnatTreeBrowserView() :
 QmitkXnatTreeBrowserView::~QmitkXnatTreeBrowserView()
 {
   m_DataStorageServiceTracker.close();
+  delete m_TransferManager;
   delete m_TreeModel;
   delete m_Tracker;
 }
@@ -419,6 +422,16 @@ void QmitkXnatTreeBrowserView::UpdateSession(ctkXnatSession* session)
     connect(session, SIGNAL(progress(QUuid,double)), this, SLOT(OnProgress(QUuid,double)));
     connect(session, SIGNAL(timedOut()), this, SLOT(SessionTimedOutMsg()));
     connect(session, SIGNAL(aboutToTimeOut()), this, SLOT(SessionTimesOutSoonMsg()));
+
+    if (m_TransferManager == nullptr || m_TransferManager->GetSession() != session)
+    {
+      delete m_TransferManager;
+      m_TransferManager = new mitk::XnatTransferManager(session);
+      connect(m_TransferManager, SIGNAL(Progress(QUuid,qint64,qint64)), this, SLOT(OnTransferProgress(QUuid,qint64,qint64)));
+      connect(m_TransferManager, SIGNAL(Finished(QUuid,const QString&)), this, SLOT(OnTransferFinished(QUuid,const QString&)));
+      connect(m_TransferManager, SIGNAL(Failed(QUuid,const QString&)), this, SLOT(OnTransferFailed(QUuid,const QString&)));
+      connect(m_TransferManager, SIGNAL(AllFinished()), this, SLOT(OnAllTransfersFinished()));
+    }
   }
 }
 
@@ -429,6 +442,14 @@ void QmitkXnatTreeBrowserView::CleanTreeModel(ctkXnatSession* session)
     m_TreeModel->removeDataModel(session->dataModel());
     m_Controls.treeView->reset();
   }
+
+  if (m_TransferManager != nullptr && m_TransferManager->GetSession() == session)
+  {
+    // partial downloads are kept and resumed in the next session
+    m_TransferManager->CancelAll();
+    m_TransferManager->deleteLater();
+    m_TransferManager = nullptr;
+  }
 }
 
 void QmitkXnatTreeBrowserView::OnProgress(QUuid /*queryID*/, double progress)
@@ -445,6 +466,132 @@ void QmitkXnatTreeBrowserView::OnProgress(QUuid /*queryID*/, double progress)
   }
 }
 
+void QmitkXnatTreeBrowserView::OnTransferProgress(QUuid id, qint64 bytesTransferred, qint64 bytesTotal)
+{
+  m_TransferProgress[id] = qMakePair(bytesTransferred, bytesTotal);
+
+  // the progress of all running transfers with a known size
+  qint64 transferred = 0;
+  qint64 total = 0;
+  for (const auto &progress : m_TransferProgress)
+  {
+    if (progress.second > 0)
+    {
+      transferred += progress.first;
+      total += progress.second;
+    }
+  }
+
+  if (total > 0)
+  {
+    if (m_Controls.groupBox->isHidden())
+    {
+      m_Controls.groupBox->show();
+    }
+    m_Controls.progressBar->setValue(static_cast<int>(100 * transferred / total));
+  }
+}
+
+void QmitkXnatTreeBrowserView::OnTransferFinished(QUuid id, const QString& localFile)
+{
+  m_TransferProgress.remove(id);
+
+  auto upload = m_PendingUploads.find(id);
+  if (upload != m_PendingUploads.end())
+  {
+    QFile::remove(localFile);
+    if (upload.value().RefreshIndex.isValid())
+    {
+      m_TreeModel->refresh(upload.value().RefreshIndex);
+    }
+    m_PendingUploads.erase(upload);
+    ++m_NumberOfFinishedUploads;
+    return;
+  }
+
+  auto download = m_PendingDownloads.find(id);
+  if (download == m_PendingDownloads.end())
+    return;
+
+  const PendingDownload pendingDownload = download.value();
+  m_PendingDownloads.erase(download);
+  ++m_NumberOfFinishedDownloads;
+
+  if (pendingDownload.LoadData)
+  {
+    mitk::StringProperty::Pointer xnatURL = mitk::StringProperty::New(pendingDownload.ServerURL.toStdString());
+    try
+    {
+      this->InternalOpenFiles(QFileInfoList() << QFileInfo(localFile), xnatURL);
+    }
+    catch(const ctkRuntimeException& exc)
+    {
+      QmitkHttpStatusCodeHandler::HandleErrorMessage(exc.what());
+    }
+  }
+}
+
+void QmitkXnatTreeBrowserView::OnTransferFailed(QUuid id, const QString& message)
+{
+  m_TransferProgress.remove(id);
+
+  QString fileName;
+  QString operation;
+  auto upload = m_PendingUploads.find(id);
+  if (upload != m_PendingUploads.end())
+  {
+    fileName = upload.value().FileName;
+    m_PendingUploads.erase(upload);
+    operation = "Upload";
+  }
+  else
+  {
+    auto download = m_PendingDownloads.find(id);
+    if (download == m_PendingDownloads.end())
+      return;
+
+    fileName = download.value().FileName;
+    m_PendingDownloads.erase(download);
+    operation = "Download";
+  }
+
+  MITK_INFO << operation.toStdString() << " of " << fileName.toStdString() << " failed! " << message.toStdString();
+  if (message != "Canceled")
+  {
+    QMessageBox::critical(m_Controls.treeView, operation + " failed!", operation + " of " + fileName + " failed!\n" + message);
+  }
+}
+
+void QmitkXnatTreeBrowserView::OnAllTransfersFinished()
+{
+  m_TransferProgress.clear();
+  m_Controls.groupBox->hide();
+
+  if (!m_SilentMode && (m_NumberOfFinishedDownloads > 0 || m_NumberOfFinishedUploads > 0))
+  {
+    QString text;
+    if (m_NumberOfFinishedDownloads == 1)
+      text = "Download completed!";
+    else if (m_NumberOfFinishedDownloads > 1)
+      text = QString("Download of %1 files completed!").arg(m_NumberOfFinishedDownloads);
+
+    if (m_NumberOfFinishedUploads > 0)
+    {
+      if (!text.isEmpty())
+        text += "\n";
+      text += m_NumberOfFinishedUploads == 1 ? QString("Upload completed!") : QString("Upload of %1 files completed!").arg(m_NumberOfFinishedUploads);
+    }
+
+    QMessageBox msgBox;
+    msgBox.setText(text);
+    msgBox.setIcon(QMessageBox::Information);
+    msgBox.exec();
+  }
+
+  m_NumberOfFinishedDownloads = 0;
+  m_NumberOfFinishedUploads = 0;
+}
+
 void QmitkXnatTreeBrowserView::OnPreferencesChanged(const berry::IBerryPreferences* prefs)
 {
   QString downloadPath = prefs->Get("Download Path", "");
@@ -546,88 +693,55 @@ void QmitkXnatTreeBrowserView::InternalFileDownload(const QModelIndex& index, bo
       filePathExists = doesDirExist(downloadPath);
       filePath = folderName + file->name();
 
-      // Checking if the file exists already
-      if (downloadPath.exists(file->name()))
+      if (file->property("collection") == QString("DICOM") && !downloadPath.exists(file->name()))
       {
-        MITK_INFO << "File '" << file->name().toStdString() << "' already exists!";
-        serverURL = file->parent()->resourceUri();
-      }
-      else
-      {
-        if (file->property("collection") == QString("DICOM"))
-        {
-          isDICOM = true;
-          ctkXnatObject* parent = file->parent();
+        isDICOM = true;
+        ctkXnatObject* parent = file->parent();
 
-          QString uriId = parent->resourceUri();
-          uriId.replace("/data/archive/projects/", "");
-          QString folderName = m_DownloadPath + uriId + "/";
-          downloadPath = folderName;
-          filePathExists = doesDirExist(downloadPath);
+        QString uriId = parent->resourceUri();
+        uriId.replace("/data/archive/projects/", "");
+        QString folderName = m_DownloadPath + uriId + "/";
+        downloadPath = folderName;
+        filePathExists = doesDirExist(downloadPath);
 
-          if(filePathExists)
+        if(filePathExists)
+        {
+          try
           {
-            try
-            {
-              this->InternalDICOMDownload(parent, downloadPath);
-            }
-            catch(const ctkRuntimeException& exc)
-            {
-              QmitkHttpStatusCodeHandler::HandleErrorMessage(exc.what());
-              return;
-            }
+            this->InternalDICOMDownload(parent, downloadPath);
           }
-          else
+          catch(const ctkRuntimeException& exc)
           {
-            FilePathNotAvailableWarning(parent->name());
+            QmitkHttpStatusCodeHandler::HandleErrorMessage(exc.what());
             return;
           }
-
-          serverURL = parent->resourceUri();
         }
-        //Normal file download, no DICOM download
         else
         {
-          if(filePathExists)
-          {
-            this->SetStatusInformation("Downloading file " + file->name());
-            file->download(filePath);
-          }
-          else
-          {
-            MITK_INFO << "File Download Failed.";
-          }
-          serverURL = file->parent()->resourceUri();
+          FilePathNotAvailableWarning(parent->name());
+          return;
+        }
 
-          // Checking if the file exists now
-          if (downloadPath.exists(file->name()))
-          {
-            MITK_INFO << "Download of " << file->name().toStdString() << " completed!";
-            if(!m_SilentMode)
-            {
-              QMessageBox msgBox;
-              msgBox.setText("Download of " + file->name() + " completed!");
-              msgBox.setIcon(QMessageBox::Information);
-              msgBox.exec();
-            }
-            m_Controls.groupBox->hide();
-          }
-          else
-          {
-            if(filePathExists)
-            {
-              MITK_INFO << "Download of " << file->name().toStdString() << " failed!";
-              QMessageBox::critical(m_Controls.treeView, "Download failed!", "Download of " + file->name() + " failed!");
-              m_Controls.groupBox->hide();
-              return;
-            }
-            else
-            {
-              FilePathNotAvailableWarning(file->name());
-              return;
-            }
-          }
+        serverURL = parent->resourceUri();
+      }
+      //Normal file download, no DICOM download
+      else
+      {
+        if (!filePathExists || m_TransferManager == nullptr)
+        {
+          FilePathNotAvailableWarning(file->name());
+          return;
         }
+
+        // Queued, the file is opened as soon as its download is finished. Files which were downloaded before
+        // and still match the checksum on the server are not transferred again.
+        this->SetStatusInformation("Downloading file " + file->name());
+        PendingDownload pendingDownload;
+        pendingDownload.FileName = file->name();
+        pendingDownload.ServerURL = file->parent()->resourceUri();
+        pendingDownload.LoadData = loadData;
+        m_PendingDownloads.insert(m_TransferManager->Download(file, filePath), pendingDownload);
+        return;
       }
     }
     if (loadData)
@@ -902,8 +1016,6 @@ void QmitkXnatTreeBrowserView::OnUploadResource(const QList<mitk::DataNode*>& dr
     //We have to replace special characters due to XNAT inability to get along with them (" " is replaced by "%20", what leads to nasty behaviour!)
     QString fileName(QString::fromStdString(ReplaceSpecialChars(node->GetName())));
 
-    ctkXnatFile* xnatFile = new ctkXnatFile(resource);
-
     if (dynamic_cast<mitk::Image*>(data))
     {
       fileName.append(".nrrd");
@@ -926,43 +1038,25 @@ void QmitkXnatTreeBrowserView::OnUploadResource(const QList<mitk::DataNode*>& dr
       return;
     }
 
-    xnatFile->setName(fileName);
-
     QString xnatFolder = "XNAT_UPLOADS";
     QDir dir(mitk::org_mitk_gui_qt_xnatinterface_Activator::GetContext()->getDataFile("").absoluteFilePath());
     dir.mkdir(xnatFolder);
 
-    fileName = dir.path().append("/" + fileName);
-    mitk::IOUtil::Save (data, fileName.toStdString());
+    QString localFileName = dir.path().append("/" + fileName);
+    mitk::IOUtil::Save (data, localFileName.toStdString());
 
-    // TODO Check if file exists
-    // AbstractFileReader::SetDefaultDataNodeProperties
-    // und in die andere SetDefaultDataNodeProperties
-    // PropertyName klein: mtime.initial + Kommentar
-    mitk::StringProperty::Pointer orignalFilePath = mitk::StringProperty::New();
-    node->GetProperty(orignalFilePath, "path");
-
-    xnatFile->setLocalFilePath(fileName);
-
-    try
-    {
-      this->InternalFileUpload(xnatFile);
-    }
-    catch(const ctkRuntimeException& exc)
+    if (m_TransferManager == nullptr)
     {
-      QmitkHttpStatusCodeHandler::HandleErrorMessage(exc.what());
+      QFile::remove(localFileName);
       return;
     }
-    QFile::remove(fileName);
 
-    if (originalResourceFolder == nullptr)
-    {
-      m_TreeModel->refresh(parentIndex);
-    }
-    else
-    {
-      m_TreeModel->refresh(parentIndex.parent());
-    }
+    // Uploads of all dropped nodes run in parallel, the temporary file is removed once it is uploaded
+    PendingUpload pendingUpload;
+    pendingUpload.FileName = fileName;
+    pendingUpload.RefreshIndex = originalResourceFolder == nullptr ? QPersistentModelIndex(parentIndex) : QPersistentModelIndex(parentIndex.parent());
+    m_PendingUploads.insert(m_TransferManager->Upload(localFileName, resource->resourceUri() + "/files/" + fileName), pendingUpload);
+    this->SetStatusInformation("Uploading file " + fileName);
 
     // The filename for uploading
     //    QFileInfo fileInfo;
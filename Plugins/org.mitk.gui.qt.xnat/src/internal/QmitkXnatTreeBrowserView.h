@@ -30,12 +30,17 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 // MitkXNAT Module
 #include "mitkXnatSessionTracker.h"
+#include "mitkXnatTransferManager.h"
 
 #include <mitkIDataStorageService.h>
 #include <ctkServiceTracker.h>
 
 #include <berryIBerryPreferences.h>
 
+#include <QHash>
+#include <QPair>
+#include <QPersistentModelIndex>
+
 class QMenu;
 
 
@@ -94,6 +99,11 @@ protected slots:
 
   void OnProgress(QUuid, double);
 
+  void OnTransferProgress(QUuid id, qint64 bytesTransferred, qint64 bytesTotal);
+  void OnTransferFinished(QUuid id, const QString& localFile);
+  void OnTransferFailed(QUuid id, const QString& message);
+  void OnAllTransfersFinished();
+
   void ItemSelected(const QModelIndex& index);
 
   void OnUploadFromDataStorage();
@@ -136,6 +146,26 @@ private:
   mitk::XnatSessionTracker* m_Tracker;
   QString m_DownloadPath;
 
+  struct PendingDownload
+  {
+    QString FileName;
+    QString ServerURL;
+    bool LoadData;
+  };
+
+  struct PendingUpload
+  {
+    QString FileName;
+    QPersistentModelIndex RefreshIndex;
+  };
+
+  mitk::XnatTransferManager* m_TransferManager;
+  QHash<QUuid, PendingDownload> m_PendingDownloads;
+  QHash<QUuid, PendingUpload> m_PendingUploads;
+  QHash<QUuid, QPair<qint64, qint64>> m_TransferProgress;
+  int m_NumberOfFinishedDownloads = 0;
+  int m_NumberOfFinishedUploads = 0;
+
   QMenu* m_ContextMenu;
 
   bool m_SilentMode;